@@ -44,6 +44,7 @@
 #include "deployment_admin.h"
 #include "celix_errno.h"
 #include "bundle_context.h"
+#include "celix_bundle_context.h"
 #include "celix_constants.h"
 #include "deployment_package.h"
 #include "bundle.h"
@@ -55,6 +56,7 @@
 
 #include "resource_processor.h"
 #include "miniunz.h"
+#include "zip_stream.h"
 
 #define IDENTIFICATION_ID "deployment_admin_identification"
 #define DEFAULT_IDENTIFICATION_ID "celix"
@@ -66,21 +68,51 @@
 #define DEPLOYMENT_TAGS "deployment_tags"
 // "http://localhost:8080/deployment/"
 
+#define POLL_INTERVAL "deployment_admin_poll_interval"
+#define DEFAULT_POLL_INTERVAL 5
+
+#define PARALLELISM "deployment_admin_parallelism"
+#define DEFAULT_PARALLELISM 4
+
+#define FIX_PACKAGES "deployment_admin_fix_packages"
+#define DEFAULT_FIX_PACKAGES true
+
 #define VERSIONS "/versions"
 
+typedef struct deployment_admin_download {
+	FILE *file;
+	zip_stream_pt zip; //NULL if streaming extraction failed
+} deployment_admin_download_t;
+
+typedef struct deployment_admin_bundle_task deployment_admin_bundle_task_t;
+
+/*
+ * Stops, updates or starts the bundles of a deployment package, spread over admin->parallelism threads.
+ */
+struct deployment_admin_bundle_task {
+	deployment_admin_pt admin;
+	deployment_package_pt source;
+	deployment_package_pt target;
+	array_list_pt infos;
+	void (*run)(deployment_admin_bundle_task_t *task, bundle_info_pt info);
+	int next; //atomic, index of the next info to handle
+};
+
 static void* deploymentAdmin_poll(void *deploymentAdmin);
-celix_status_t deploymentAdmin_download(deployment_admin_pt admin, char * url, char **inputFile);
-size_t deploymentAdmin_writeData(void *ptr, size_t size, size_t nmemb, FILE *stream);
+static celix_status_t deploymentAdmin_deploy(deployment_admin_pt admin, const char *request, const char *version);
+celix_status_t deploymentAdmin_download(deployment_admin_pt admin, char * url, const char *extractDir, char **inputFile, bool *extracted);
+size_t deploymentAdmin_writeData(void *ptr, size_t size, size_t nmemb, void *handle);
 static celix_status_t deploymentAdmin_deleteTree(char * directory);
 celix_status_t deploymentAdmin_readVersions(deployment_admin_pt admin, array_list_pt versions);
 
-celix_status_t deploymentAdmin_stopDeploymentPackageBundles(deployment_admin_pt admin, deployment_package_pt target);
+celix_status_t deploymentAdmin_stopDeploymentPackageBundles(deployment_admin_pt admin, deployment_package_pt source, deployment_package_pt target);
 celix_status_t deploymentAdmin_updateDeploymentPackageBundles(deployment_admin_pt admin, deployment_package_pt source);
 celix_status_t deploymentAdmin_startDeploymentPackageCustomizerBundles(deployment_admin_pt admin, deployment_package_pt source, deployment_package_pt target);
 celix_status_t deploymentAdmin_processDeploymentPackageResources(deployment_admin_pt admin, deployment_package_pt source);
 celix_status_t deploymentAdmin_dropDeploymentPackageResources(deployment_admin_pt admin, deployment_package_pt source, deployment_package_pt target);
 celix_status_t deploymentAdmin_dropDeploymentPackageBundles(deployment_admin_pt admin, deployment_package_pt source, deployment_package_pt target);
 celix_status_t deploymentAdmin_startDeploymentPackageBundles(deployment_admin_pt admin, deployment_package_pt source);
+static void deploymentAdmin_runBundleTask(deployment_admin_bundle_task_t *task);
 
 static celix_status_t deploymentAdmin_performRequest(deployment_admin_pt admin, char* entry);
 static celix_status_t deploymentAdmin_auditEventTargetPropertiesSet(deployment_admin_pt admin);
@@ -95,6 +127,11 @@ celix_status_t deploymentAdmin_create(bundle_context_pt context, deployment_admi
 	} else {
 		(*admin)->running = true;
 		(*admin)->context = context;
+		celixThreadMutex_create(&(*admin)->mutex, NULL);
+		celixThreadCondition_init(&(*admin)->stopCond, NULL);
+		(*admin)->pollInterval = celix_bundleContext_getPropertyAsLong(context, POLL_INTERVAL, DEFAULT_POLL_INTERVAL);
+		(*admin)->parallelism = (int) celix_bundleContext_getPropertyAsLong(context, PARALLELISM, DEFAULT_PARALLELISM);
+		(*admin)->fixPackages = celix_bundleContext_getPropertyAsBool(context, FIX_PACKAGES, DEFAULT_FIX_PACKAGES);
 		(*admin)->current = NULL;
 		(*admin)->packages = hashMap_create(utils_stringHash, NULL, utils_stringEquals, NULL);
 		(*admin)->targetIdentification = NULL;
@@ -158,10 +195,16 @@ celix_status_t deploymentAdmin_create(bundle_context_pt context, deployment_admi
 celix_status_t deploymentAdmin_destroy(deployment_admin_pt admin) {
 	celix_status_t status = CELIX_SUCCESS;
 
+    celixThreadMutex_lock(&admin->mutex);
     admin->running = false;
+    celixThreadCondition_broadcast(&admin->stopCond);
+    celixThreadMutex_unlock(&admin->mutex);
 
     celixThread_join(admin->poller, NULL);
 
+    celixThreadCondition_destroy(&admin->stopCond);
+    celixThreadMutex_destroy(&admin->mutex);
+
 	hash_map_iterator_pt iter = hashMapIterator_create(admin->packages);
 
 	while (hashMapIterator_hasNext(iter)) {
@@ -267,7 +310,11 @@ static void *deploymentAdmin_poll(void *deploymentAdmin) {
     deploymentAdmin_auditEventFrameworkStarted(admin);
     deploymentAdmin_auditEventTargetPropertiesSet(admin);
 
-	while (admin->running) {
+	celixThreadMutex_lock(&admin->mutex);
+	bool running = admin->running;
+	celixThreadMutex_unlock(&admin->mutex);
+
+	while (running) {
         int i;
 
 		//poll ace
@@ -280,101 +327,164 @@ static void *deploymentAdmin_poll(void *deploymentAdmin) {
 
 		if (last != NULL) {
 			if (admin->current == NULL || strcmp(last, admin->current) != 0) {
-				int length = strlen(admin->pollUrl) + strlen(last) + 2;
-				char request[length];
+				celix_status_t status = CELIX_ILLEGAL_STATE;
+
+				if (admin->current != NULL && admin->fixPackages) {
+					//fix package, only contains the bundles and resources changed since the current version
+					int length = strlen(admin->pollUrl) + strlen(last) + strlen(admin->current) + 11;
+					char request[length];
+					snprintf(request, length, "%s/%s?current=%s", admin->pollUrl, last, admin->current);
+					status = deploymentAdmin_deploy(admin, request, last);
+					if (status == CELIX_ILLEGAL_STATE) {
+						fw_log(logger, OSGI_FRAMEWORK_LOG_WARNING, "DEPLOYMENT_ADMIN: Cannot apply fix package %s, falling back to the complete package", last);
+					}
+				}
 
-				// TODO
-                //      We do not yet support fix packages
-                //		Check string length!
-                // snprintf(request, length, "%s/%s?current=%s", admin->pollUrl, last, admin->current);
-                snprintf(request, length, "%s/%s", admin->pollUrl, last);
+				if (status == CELIX_ILLEGAL_STATE) {
+					int length = strlen(admin->pollUrl) + strlen(last) + 2;
+					char request[length];
+					snprintf(request, length, "%s/%s", admin->pollUrl, last);
+					deploymentAdmin_deploy(admin, request, last);
+				}
+			}
+		}
 
-				char *inputFilename = NULL;
-				celix_status_t status = deploymentAdmin_download(admin ,request, &inputFilename);
-				if (status == CELIX_SUCCESS) {
-					bundle_pt bundle = NULL;
-					bundleContext_getBundle(admin->context, &bundle);
-					char *entry = NULL;
-					bundle_getEntry(bundle, "/", &entry);
+		for (i = arrayList_size(versions); i > 0; --i) {
+		    free(arrayList_remove(versions, 0));
+		}
 
-					// Handle file
-					char tmpDir[256];
-					char uuid[37];
-					uuid_t uid;
-					uuid_generate(uid);
-					uuid_unparse(uid, uuid);
-                    snprintf(tmpDir, 256, "%s%s", entry, uuid);
-                    if( mkdir(tmpDir, S_IRWXU) == -1){
-                        fw_log(logger, OSGI_FRAMEWORK_LOG_ERROR, "Failed creating directory %s",tmpDir);
-                    }
+		arrayList_destroy(versions);
 
-					// TODO: update to use bundle cache DataFile instead of module entries.
-					unzip_extractDeploymentPackage(inputFilename, tmpDir);
-					int length = strlen(tmpDir) + 22;
-					char manifest[length];
-					snprintf(manifest, length, "%s/META-INF/MANIFEST.MF", tmpDir);
-					manifest_pt mf = NULL;
-					manifest_createFromFile(manifest, &mf);
-					deployment_package_pt source = NULL;
-					deploymentPackage_create(admin->context, mf, &source);
-					const char *name = NULL;
-					deploymentPackage_getName(source, &name);
+		//wait for the next poll, destroy interrupts the wait
+		celixThreadMutex_lock(&admin->mutex);
+		if (admin->running) {
+			celixThreadCondition_timedwaitRelative(&admin->stopCond, &admin->mutex, admin->pollInterval, 0);
+		}
+		running = admin->running;
+		celixThreadMutex_unlock(&admin->mutex);
+	}
 
-					int repoDirLength = strlen(entry) + 5;
-					char repoDir[repoDirLength];
-					snprintf(repoDir, repoDirLength, "%srepo", entry);
-					if( mkdir(repoDir, S_IRWXU) == -1){
-						fw_log(logger, OSGI_FRAMEWORK_LOG_ERROR, "Failed creating directory %s",repoDir);
-					}
+	return NULL;
+}
 
-					int repoCacheLength = strlen(entry) + strlen(name) + 6;
-					char repoCache[repoCacheLength];
-					snprintf(repoCache, repoCacheLength, "%srepo/%s", entry, name);
-					deploymentAdmin_deleteTree(repoCache);
-					int stat = rename(tmpDir, repoCache);
-					if (stat != 0) {
-						fw_log(logger, OSGI_FRAMEWORK_LOG_ERROR, "No success");
-					}
+/**
+ * Downloads, extracts and installs a deployment package.
+ * Returns CELIX_ILLEGAL_STATE if the package could not be downloaded or is a fix package that does not apply
+ * to the installed package; in that case no bundle is touched.
+ */
+static celix_status_t deploymentAdmin_deploy(deployment_admin_pt admin, const char *request, const char *version) {
+	celix_status_t status = CELIX_SUCCESS;
 
-					deployment_package_pt target = hashMap_get(admin->packages, name);
-					if (target == NULL) {
-//						target = empty package
-					}
+	bundle_pt bundle = NULL;
+	bundleContext_getBundle(admin->context, &bundle);
+	char *entry = NULL;
+	bundle_getEntry(bundle, "/", &entry);
+	if (entry == NULL) {
+		return CELIX_BUNDLE_EXCEPTION;
+	}
 
-					deploymentAdmin_stopDeploymentPackageBundles(admin, target);
-					deploymentAdmin_updateDeploymentPackageBundles(admin, source);
-					deploymentAdmin_startDeploymentPackageCustomizerBundles(admin, source, target);
-					deploymentAdmin_processDeploymentPackageResources(admin, source);
-					deploymentAdmin_dropDeploymentPackageResources(admin, source, target);
-					deploymentAdmin_dropDeploymentPackageBundles(admin, source, target);
-					deploymentAdmin_startDeploymentPackageBundles(admin, source);
-
-					deploymentAdmin_deleteTree(repoCache);
-					deploymentAdmin_deleteTree(tmpDir);
-					if( remove(inputFilename) == -1){
-						fw_log(logger, OSGI_FRAMEWORK_LOG_ERROR, "Remove of %s failed",inputFilename);
-					}
-					admin->current = strdup(last);
-					hashMap_put(admin->packages, (char*)name, source);
+	// Handle file, extracted while downloading if possible
+	char tmpDir[256];
+	char uuid[37];
+	uuid_t uid;
+	uuid_generate(uid);
+	uuid_unparse(uid, uuid);
+	snprintf(tmpDir, 256, "%s%s", entry, uuid);
+	if( mkdir(tmpDir, S_IRWXU) == -1){
+		fw_log(logger, OSGI_FRAMEWORK_LOG_ERROR, "Failed creating directory %s",tmpDir);
+	}
 
-                    free(entry);
-				}
-				if (inputFilename != NULL) {
-					free(inputFilename);
-				}
-			}
+	char *inputFilename = NULL;
+	bool extracted = false;
+	status = deploymentAdmin_download(admin, (char*)request, tmpDir, &inputFilename, &extracted);
+
+	if (status == CELIX_SUCCESS && !extracted) {
+		// TODO: update to use bundle cache DataFile instead of module entries.
+		deploymentAdmin_deleteTree(tmpDir);
+		mkdir(tmpDir, S_IRWXU);
+		unzip_extractDeploymentPackage(inputFilename, tmpDir);
+	}
+
+	deployment_package_pt source = NULL;
+	const char *name = NULL;
+	if (status == CELIX_SUCCESS) {
+		int length = strlen(tmpDir) + 22;
+		char manifest[length];
+		snprintf(manifest, length, "%s/META-INF/MANIFEST.MF", tmpDir);
+		manifest_pt mf = NULL;
+		manifest_createFromFile(manifest, &mf);
+		status = mf == NULL ? CELIX_ILLEGAL_STATE : deploymentPackage_create(admin->context, mf, &source);
+		if (status == CELIX_SUCCESS) {
+			deploymentPackage_getName(source, &name);
+			status = name == NULL ? CELIX_ILLEGAL_STATE : CELIX_SUCCESS;
 		}
+	}
 
-		sleep(5);
+	deployment_package_pt target = NULL;
+	if (status == CELIX_SUCCESS) {
+		target = hashMap_get(admin->packages, name);
 
-		for (i = arrayList_size(versions); i > 0; --i) {
-		    free(arrayList_remove(versions, 0));
+		bool isFixPackage = false;
+		bool applicable = false;
+		deploymentPackage_isFixPackage(source, &isFixPackage);
+		deploymentPackage_canBeAppliedTo(source, target, &applicable);
+		if (isFixPackage && (target == NULL || !applicable)) {
+			status = CELIX_ILLEGAL_STATE;
 		}
+	}
 
-		arrayList_destroy(versions);
+	if (status == CELIX_SUCCESS) {
+		int repoDirLength = strlen(entry) + 5;
+		char repoDir[repoDirLength];
+		snprintf(repoDir, repoDirLength, "%srepo", entry);
+		if( mkdir(repoDir, S_IRWXU) == -1){
+			fw_log(logger, OSGI_FRAMEWORK_LOG_ERROR, "Failed creating directory %s",repoDir);
+		}
+
+		int repoCacheLength = strlen(entry) + strlen(name) + 6;
+		char repoCache[repoCacheLength];
+		snprintf(repoCache, repoCacheLength, "%srepo/%s", entry, name);
+		deploymentAdmin_deleteTree(repoCache);
+		int stat = rename(tmpDir, repoCache);
+		if (stat != 0) {
+			fw_log(logger, OSGI_FRAMEWORK_LOG_ERROR, "No success");
+		}
+
+		deploymentAdmin_stopDeploymentPackageBundles(admin, source, target);
+		deploymentAdmin_updateDeploymentPackageBundles(admin, source);
+		deploymentAdmin_startDeploymentPackageCustomizerBundles(admin, source, target);
+		deploymentAdmin_processDeploymentPackageResources(admin, source);
+		deploymentAdmin_dropDeploymentPackageResources(admin, source, target);
+		deploymentAdmin_dropDeploymentPackageBundles(admin, source, target);
+		deploymentAdmin_startDeploymentPackageBundles(admin, source);
+
+		deploymentAdmin_deleteTree(repoCache);
+
+		free(admin->current);
+		admin->current = strdup(version);
+
+		//note the key is owned by the manifest of the package
+		hashMap_remove(admin->packages, name);
+		hashMap_put(admin->packages, (char*)name, source);
+		if (target != NULL) {
+			deploymentPackage_destroy(target);
+		}
+	} else {
+		if (source != NULL) {
+			deploymentPackage_destroy(source);
+		}
+		deploymentAdmin_deleteTree(tmpDir);
 	}
 
-	return NULL;
+	if (inputFilename != NULL) {
+		if (inputFilename[0] != '\0' && remove(inputFilename) == -1) {
+			fw_log(logger, OSGI_FRAMEWORK_LOG_ERROR, "Remove of %s failed",inputFilename);
+		}
+		free(inputFilename);
+	}
+	free(entry);
+
+	return status;
 }
 
 struct MemoryStruct {
@@ -438,10 +548,14 @@ celix_status_t deploymentAdmin_readVersions(deployment_admin_pt admin, array_lis
 }
 
 
-celix_status_t deploymentAdmin_download(deployment_admin_pt admin, char * url, char **inputFile) {
+celix_status_t deploymentAdmin_download(deployment_admin_pt admin, char * url, const char *extractDir, char **inputFile, bool *extracted) {
 	celix_status_t status = CELIX_SUCCESS;
 	CURL *curl = NULL;
 	CURLcode res = 0;
+	deployment_admin_download_t download;
+	download.file = NULL;
+	download.zip = NULL;
+	*extracted = false;
 	curl = curl_easy_init();
 	if (curl) {
 		const char *dir = NULL;
@@ -456,44 +570,64 @@ celix_status_t deploymentAdmin_download(deployment_admin_pt admin, char * url, c
 		umask(0011);
         int fd = mkstemp(*inputFile);
         if (fd != -1) {
-            FILE *fp = fopen(*inputFile, "wb+");
-            if(fp!=NULL){
+            download.file = fdopen(fd, "wb+");
+            if(download.file!=NULL){
+            	//extract while downloading, the downloaded file is only used if streaming extraction fails
+            	if (zipStream_create(extractDir, &download.zip) != CELIX_SUCCESS) {
+            		download.zip = NULL;
+            	}
+
             	curl_easy_setopt(curl, CURLOPT_NOSIGNAL, 1);
             	curl_easy_setopt(curl, CURLOPT_URL, url);
             	curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, deploymentAdmin_writeData);
-            	curl_easy_setopt(curl, CURLOPT_WRITEDATA, fp);
+            	curl_easy_setopt(curl, CURLOPT_WRITEDATA, &download);
             	curl_easy_setopt(curl, CURLOPT_FAILONERROR, true);
             	//curl_easy_setopt(curl, CURLOPT_NOPROGRESS, 0);
             	//curl_easy_setopt(curl, CURLOPT_PROGRESSFUNCTION, updateCommand_downloadProgress);
             	res = curl_easy_perform(curl);
 
             	/* always cleanup */
-            	curl_easy_cleanup(curl);
-            	fclose(fp);
+            	fclose(download.file);
+
+            	if (res == CURLE_OK && download.zip != NULL && zipStream_finish(download.zip) == CELIX_SUCCESS) {
+            		*extracted = true;
+            	}
+            	zipStream_destroy(download.zip);
             }
             else{
+            	close(fd);
             	status = CELIX_FILE_IO_EXCEPTION;
             }
         }
         else{
         	status = CELIX_FILE_IO_EXCEPTION;
         }
+        curl_easy_cleanup(curl);
 	}
 	else{
 		res = CURLE_FAILED_INIT;
 	}
 
 	if (res != CURLE_OK) {
-		*inputFile[0] = '\0';
+		if (*inputFile != NULL) {
+			remove(*inputFile);
+			(*inputFile)[0] = '\0';
+		}
 		status = CELIX_ILLEGAL_STATE;
 	}
 
 	return status;
 }
 
-size_t deploymentAdmin_writeData(void *ptr, size_t size, size_t nmemb, FILE *stream) {
-    size_t written = fwrite(ptr, size, nmemb, stream);
-    return written;
+size_t deploymentAdmin_writeData(void *ptr, size_t size, size_t nmemb, void *handle) {
+	deployment_admin_download_t *download = handle;
+    size_t written = fwrite(ptr, size, nmemb, download->file);
+    if (download->zip != NULL && zipStream_write(download->zip, ptr, size * nmemb) != CELIX_SUCCESS) {
+    	fw_log(logger, OSGI_FRAMEWORK_LOG_INFO, "DEPLOYMENT_ADMIN: Cannot extract the deployment package while downloading, extracting afterwards");
+    	zipStream_destroy(download->zip);
+    	download->zip = NULL;
+    }
+    return written * size;
 }
 
 
@@ -542,67 +676,120 @@ static celix_status_t deploymentAdmin_deleteTree(char * directory) {
 	return status;
 }
 
-celix_status_t deploymentAdmin_stopDeploymentPackageBundles(deployment_admin_pt admin, deployment_package_pt target) {
-	celix_status_t status = CELIX_SUCCESS;
+static void* deploymentAdmin_bundleTaskWorker(void *data) {
+	deployment_admin_bundle_task_t *task = data;
+	int size = arrayList_size(task->infos);
+	int i = __atomic_fetch_add(&task->next, 1, __ATOMIC_RELAXED);
+	while (i < size) {
+		task->run(task, arrayList_get(task->infos, i));
+		i = __atomic_fetch_add(&task->next, 1, __ATOMIC_RELAXED);
+	}
+	return NULL;
+}
 
-	if (target != NULL) {
-		array_list_pt infos = NULL;
-		deploymentPackage_getBundleInfos(target, &infos);
-		int i;
-		for (i = 0; i < arrayList_size(infos); i++) {
-			bundle_pt bundle = NULL;
-			bundle_info_pt info = arrayList_get(infos, i);
-			deploymentPackage_getBundle(target, info->symbolicName, &bundle);
-			if (bundle != NULL) {
-				bundle_stop(bundle);
-			} else {
-				fw_log(logger, OSGI_FRAMEWORK_LOG_ERROR, "DEPLOYMENT_ADMIN: Bundle %s not found", info->symbolicName);
-			}
+/**
+ * Runs the task for all infos. The bundles of a deployment package are independent of each other, the framework
+ * resolves them when they are started, so they can be stopped, updated and started concurrently.
+ */
+static void deploymentAdmin_runBundleTask(deployment_admin_bundle_task_t *task) {
+	int size = arrayList_size(task->infos);
+	int nrOfThreads = task->admin->parallelism < size ? task->admin->parallelism : size;
+	nrOfThreads = nrOfThreads > 1 ? nrOfThreads - 1 : 0; //the calling thread also handles infos
+	celix_thread_t threads[nrOfThreads > 0 ? nrOfThreads : 1];
+	int started = 0;
+
+	task->next = 0;
+	for (int i = 0; i < nrOfThreads; ++i) {
+		if (celixThread_create(&threads[started], NULL, deploymentAdmin_bundleTaskWorker, task) == CELIX_SUCCESS) {
+			started += 1;
 		}
-		arrayList_destroy(infos);
 	}
+	deploymentAdmin_bundleTaskWorker(task);
+	for (int i = 0; i < started; ++i) {
+		celixThread_join(threads[i], NULL);
+	}
+}
 
-	return status;
+static void deploymentAdmin_stopBundle(deployment_admin_bundle_task_t *task, bundle_info_pt info) {
+	bundle_info_pt sourceInfo = NULL;
+	deploymentPackage_getBundleInfoByName(task->source, info->symbolicName, &sourceInfo);
+	if (sourceInfo != NULL && sourceInfo->missing) {
+		return; //unchanged in the fix package, keeps running
+	}
+
+	bundle_pt bundle = NULL;
+	deploymentPackage_getBundle(task->target, info->symbolicName, &bundle);
+	if (bundle != NULL) {
+		bundle_stop(bundle);
+	} else {
+		fw_log(logger, OSGI_FRAMEWORK_LOG_ERROR, "DEPLOYMENT_ADMIN: Bundle %s not found", info->symbolicName);
+	}
 }
 
-celix_status_t deploymentAdmin_updateDeploymentPackageBundles(deployment_admin_pt admin, deployment_package_pt source) {
+celix_status_t deploymentAdmin_stopDeploymentPackageBundles(deployment_admin_pt admin, deployment_package_pt source, deployment_package_pt target) {
 	celix_status_t status = CELIX_SUCCESS;
 
-	array_list_pt infos = NULL;
-	deploymentPackage_getBundleInfos(source, &infos);
-	int i;
-	for (i = 0; i < arrayList_size(infos); i++) {
-		bundle_pt bundle = NULL;
-		bundle_info_pt info = arrayList_get(infos, i);
+	if (target != NULL) {
+		deployment_admin_bundle_task_t task;
+		memset(&task, 0, sizeof(task));
+		task.admin = admin;
+		task.source = source;
+		task.target = target;
+		task.run = deploymentAdmin_stopBundle;
+		deploymentPackage_getBundleInfos(target, &task.infos);
+		deploymentAdmin_runBundleTask(&task);
+		arrayList_destroy(task.infos);
+	}
+
+	return status;
+}
 
-		bundleContext_getBundle(admin->context, &bundle);
-		char *entry = NULL;
-		bundle_getEntry(bundle, "/", &entry);
-		const char *name = NULL;
-		deploymentPackage_getName(source, &name);
+static void deploymentAdmin_updateBundle(deployment_admin_bundle_task_t *task, bundle_info_pt info) {
+	if (info->missing) {
+		return; //not in the fix package, the installed bundle is up to date
+	}
 
-		int bundlePathLength = strlen(entry) + strlen(name) + strlen(info->path) + 7;
-		int bsnLength = strlen(info->symbolicName) + 9;
+	bundle_pt bundle = NULL;
+	bundleContext_getBundle(task->admin->context, &bundle);
+	char *entry = NULL;
+	bundle_getEntry(bundle, "/", &entry);
+	const char *name = NULL;
+	deploymentPackage_getName(task->source, &name);
 
-		char bundlePath[bundlePathLength];
-		snprintf(bundlePath, bundlePathLength, "%srepo/%s/%s", entry, name, info->path);
+	int bundlePathLength = strlen(entry) + strlen(name) + strlen(info->path) + 7;
+	int bsnLength = strlen(info->symbolicName) + 9;
 
-		char bsn[bsnLength];
-		snprintf(bsn, bsnLength, "osgi-dp:%s", info->symbolicName);
+	char bundlePath[bundlePathLength];
+	snprintf(bundlePath, bundlePathLength, "%srepo/%s/%s", entry, name, info->path);
 
-		bundle_pt updateBundle = NULL;
-		deploymentPackage_getBundle(source, info->symbolicName, &updateBundle);
-		if (updateBundle != NULL) {
-			//printf("Update bundle from: %s\n", bundlePath);
-			bundle_update(updateBundle, bundlePath);
-		} else {
-			//printf("Install bundle from: %s\n", bundlePath);
-			bundleContext_installBundle2(admin->context, bsn, bundlePath, &updateBundle);
-		}
+	char bsn[bsnLength];
+	snprintf(bsn, bsnLength, "osgi-dp:%s", info->symbolicName);
 
-        free(entry);
+	bundle_pt updateBundle = NULL;
+	deploymentPackage_getBundle(task->source, info->symbolicName, &updateBundle);
+	if (updateBundle != NULL) {
+		//printf("Update bundle from: %s\n", bundlePath);
+		bundle_update(updateBundle, bundlePath);
+	} else {
+		//printf("Install bundle from: %s\n", bundlePath);
+		bundleContext_installBundle2(task->admin->context, bsn, bundlePath, &updateBundle);
 	}
-	arrayList_destroy(infos);
+
+	free(entry);
+}
+
+celix_status_t deploymentAdmin_updateDeploymentPackageBundles(deployment_admin_pt admin, deployment_package_pt source) {
+	celix_status_t status = CELIX_SUCCESS;
+
+	deployment_admin_bundle_task_t task;
+	memset(&task, 0, sizeof(task));
+	task.admin = admin;
+	task.source = source;
+	task.run = deploymentAdmin_updateBundle;
+	deploymentPackage_getBundleInfos(source, &task.infos);
+	deploymentAdmin_runBundleTask(&task);
+	arrayList_destroy(task.infos);
+
 	return status;
 }
 
@@ -662,6 +849,9 @@ celix_status_t deploymentAdmin_processDeploymentPackageResources(deployment_admi
 	int i;
 	for (i = 0; i < arrayList_size(infos); i++) {
 		resource_info_pt info = arrayList_get(infos, i);
+		if (info->missing) {
+			continue; //not in the fix package, already processed
+		}
 		array_list_pt services = NULL;
 		int length = strlen(OSGI_FRAMEWORK_SERVICE_PID) + strlen(info->resourceProcessor) + 4;
 		char filter[length];
@@ -785,25 +975,31 @@ celix_status_t deploymentAdmin_dropDeploymentPackageBundles(deployment_admin_pt
 	return status;
 }
 
+static void deploymentAdmin_startBundle(deployment_admin_bundle_task_t *task, bundle_info_pt info) {
+	if (info->customizer) {
+		return; //already started
+	}
+
+	bundle_pt bundle = NULL;
+	deploymentPackage_getBundle(task->source, info->symbolicName, &bundle);
+	if (bundle != NULL) {
+		bundle_start(bundle);
+	} else {
+		fw_log(logger, OSGI_FRAMEWORK_LOG_ERROR, "DEPLOYMENT_ADMIN: Could not start bundle %s", info->symbolicName);
+	}
+}
+
 celix_status_t deploymentAdmin_startDeploymentPackageBundles(deployment_admin_pt admin, deployment_package_pt source) {
 	celix_status_t status = CELIX_SUCCESS;
 
-	array_list_pt infos = NULL;
-	deploymentPackage_getBundleInfos(source, &infos);
-	int i;
-	for (i = 0; i < arrayList_size(infos); i++) {
-		bundle_pt bundle = NULL;
-		bundle_info_pt info = arrayList_get(infos, i);
-		if (!info->customizer) {
-			deploymentPackage_getBundle(source, info->symbolicName, &bundle);
-			if (bundle != NULL) {
-				bundle_start(bundle);
-			} else {
-				fw_log(logger, OSGI_FRAMEWORK_LOG_ERROR, "DEPLOYMENT_ADMIN: Could not start bundle %s", info->symbolicName);
-			}
-		}
-	}
-	arrayList_destroy(infos);
+	deployment_admin_bundle_task_t task;
+	memset(&task, 0, sizeof(task));
+	task.admin = admin;
+	task.source = source;
+	task.run = deploymentAdmin_startBundle;
+	deploymentPackage_getBundleInfos(source, &task.infos);
+	deploymentAdmin_runBundleTask(&task);
+	arrayList_destroy(task.infos);
 
 	return status;
 }
@@ -28,6 +28,7 @@
 #define DEPLOYMENT_ADMIN_H_
 
 #include "bundle_context.h"
+#include "celix_threads.h"
 
 typedef struct deployment_admin *deployment_admin_pt;
 
@@ -35,7 +36,12 @@ struct deployment_admin {
 	celix_thread_t poller;
 	bundle_context_pt context;
 
+	celix_thread_mutex_t mutex; //protects running
+	celix_thread_cond_t stopCond; //signals running became false, interrupts the poll interval
 	bool running;
+	long pollInterval; //seconds
+	int parallelism; //nr of bundles stopped, updated and started concurrently
+	bool fixPackages; //request fix packages (only the changed bundles) if a package is already installed
 	char *current;
 	hash_map_pt packages;
 	char *targetIdentification;
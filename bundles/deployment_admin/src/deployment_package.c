@@ -31,6 +31,7 @@
 
 #include "deployment_package.h"
 #include "celix_constants.h"
+#include "version_range.h"
 #include "utils.h"
 #include "bundle_context.h"
 #include "module.h"
@@ -38,6 +39,8 @@
 
 static const char * const RESOURCE_PROCESSOR = "Resource-Processor";
 static const char * const DEPLOYMENTPACKAGE_CUSTOMIZER = "DeploymentPackage-Customizer";
+static const char * const DEPLOYMENTPACKAGE_MISSING = "DeploymentPackage-Missing";
+static const char * const DEPLOYMENTPACKAGE_FIXPACK = "DeploymentPackage-FixPack";
 
 celix_status_t deploymentPackage_processEntries(deployment_package_pt package);
 static celix_status_t deploymentPackage_isBundleResource(properties_pt attributes, bool *isBundleResource);
@@ -161,6 +164,34 @@ celix_status_t deploymentPackage_getVersion(deployment_package_pt package, versi
 	return version_createVersionFromString(versionStr, version);
 }
 
+celix_status_t deploymentPackage_isFixPackage(deployment_package_pt package, bool *isFixPackage) {
+	*isFixPackage = manifest_getValue(package->manifest, DEPLOYMENTPACKAGE_FIXPACK) != NULL;
+	return CELIX_SUCCESS;
+}
+
+celix_status_t deploymentPackage_canBeAppliedTo(deployment_package_pt package, deployment_package_pt target, bool *applicable) {
+	celix_status_t status = CELIX_SUCCESS;
+	const char *fixPack = manifest_getValue(package->manifest, DEPLOYMENTPACKAGE_FIXPACK);
+
+	*applicable = fixPack == NULL;
+	if (fixPack != NULL && target != NULL) {
+		//a fix package only contains the changes relative to a (range of) installed version(s)
+		version_range_pt range = NULL;
+		version_pt version = NULL;
+		status = versionRange_parse(fixPack, &range);
+		status = CELIX_DO_IF(status, deploymentPackage_getVersion(target, &version));
+		status = CELIX_DO_IF(status, versionRange_isInRange(range, version, applicable));
+		if (range != NULL) {
+			versionRange_destroy(range);
+		}
+		if (version != NULL) {
+			version_destroy(version);
+		}
+	}
+
+	return status;
+}
+
 celix_status_t deploymentPackage_processEntries(deployment_package_pt package) {
 	celix_status_t status = CELIX_SUCCESS;
 
@@ -184,6 +215,7 @@ celix_status_t deploymentPackage_processEntries(deployment_package_pt package) {
 			status = version_createVersionFromString((char*)version, &info->version);
 			const char *customizer = properties_get(values, DEPLOYMENTPACKAGE_CUSTOMIZER);
 			deploymentPackage_parseBooleanHeader((char*)customizer, &info->customizer);
+			deploymentPackage_parseBooleanHeader(properties_get(values, DEPLOYMENTPACKAGE_MISSING), &info->missing);
 
 			arrayList_add(package->bundleInfos, info);
 		} else {
@@ -191,6 +223,7 @@ celix_status_t deploymentPackage_processEntries(deployment_package_pt package) {
 			info->path = name;
 			info->attributes = values;
 			info->resourceProcessor = (char*)properties_get(values,RESOURCE_PROCESSOR);
+			deploymentPackage_parseBooleanHeader(properties_get(values, DEPLOYMENTPACKAGE_MISSING), &info->missing);
 
 			arrayList_add(package->resourceInfos, info);
 		}
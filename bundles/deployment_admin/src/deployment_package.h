@@ -37,6 +37,7 @@ struct bundle_info {
 	version_pt version;
 	char *symbolicName;
 	bool customizer;
+	bool missing; //fix package only, the bundle is unchanged and not part of the package
 
 	properties_pt attributes;
 };
@@ -48,6 +49,7 @@ struct resource_info {
 	properties_pt attributes;
 
 	char *resourceProcessor;
+	bool missing; //fix package only, the resource is unchanged and not part of the package
 };
 
 typedef struct resource_info *resource_info_pt;
@@ -72,5 +74,7 @@ celix_status_t deploymentPackage_getResourceInfos(deployment_package_pt package,
 celix_status_t deploymentPackage_getResourceInfoByPath(deployment_package_pt package, const char* path, resource_info_pt *info);
 celix_status_t deploymentPackage_getBundle(deployment_package_pt package, const char* name, bundle_pt *bundle);
 celix_status_t deploymentPackage_getVersion(deployment_package_pt package, version_pt *version);
+celix_status_t deploymentPackage_isFixPackage(deployment_package_pt package, bool *isFixPackage);
+celix_status_t deploymentPackage_canBeAppliedTo(deployment_package_pt package, deployment_package_pt target, bool *applicable);
 
 #endif /* DEPLOYMENT_PACKAGE_H_ */
@@ -0,0 +1,404 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *  KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+/**
+ * zip_stream.c
+ *
+ *  \date       Oct 15, 2026
+ *  \author    	<a href="mailto:dev@celix.apache.org">Apache Celix Project Team</a>
+ *  \copyright	Apache License, Version 2.0
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <errno.h>
+#include <sys/stat.h>
+
+#include <zlib.h>
+
+#include "zip_stream.h"
+
+#define ZIP_LOCAL_HEADER_SIGNATURE		0x04034b50
+#define ZIP_CENTRAL_HEADER_SIGNATURE	0x02014b50
+#define ZIP_END_OF_CENTRAL_SIGNATURE	0x06054b50
+#define ZIP_DATA_DESCRIPTOR_SIGNATURE	0x08074b50
+
+#define ZIP_LOCAL_HEADER_SIZE			30
+#define ZIP_FLAG_ENCRYPTED				0x0001
+#define ZIP_FLAG_DATA_DESCRIPTOR		0x0008
+#define ZIP_METHOD_STORED				0
+#define ZIP_METHOD_DEFLATED				8
+
+#define ZIP_STREAM_BUFFER_SIZE			16384
+
+typedef enum {
+	ZIP_STREAM_HEADER,
+	ZIP_STREAM_NAME,
+	ZIP_STREAM_DATA,
+	ZIP_STREAM_DESCRIPTOR,
+	ZIP_STREAM_DONE,
+	ZIP_STREAM_ERROR
+} zip_stream_state_t;
+
+struct zip_stream {
+	char *destination;
+	zip_stream_state_t state;
+
+	//header (or data descriptor) bytes collected so far
+	unsigned char header[ZIP_LOCAL_HEADER_SIZE];
+	size_t headerSize;
+
+	//current entry
+	uint16_t flags;
+	uint16_t method;
+	uint32_t crc;
+	uint32_t compressedSize;
+	uint32_t uncompressedSize;
+	char *name; //name + extra field
+	size_t nameLength;
+	size_t extraLength;
+	size_t nameSize;
+
+	FILE *out;
+	uint32_t actualCrc;
+	size_t compressedRead;
+	size_t uncompressedWritten;
+	z_stream inflater;
+	bool inflaterInitialized;
+	unsigned char *buffer;
+};
+
+static celix_status_t zipStream_openEntry(zip_stream_pt stream);
+static celix_status_t zipStream_closeEntry(zip_stream_pt stream);
+static size_t zipStream_readData(zip_stream_pt stream, const unsigned char *data, size_t size, celix_status_t *status);
+static celix_status_t zipStream_writeOut(zip_stream_pt stream, const unsigned char *data, size_t size);
+static celix_status_t zipStream_makeParentDirs(char *path);
+
+static uint16_t zipStream_le16(const unsigned char *p) {
+	return (uint16_t) (p[0] | (p[1] << 8));
+}
+
+static uint32_t zipStream_le32(const unsigned char *p) {
+	return (uint32_t) p[0] | ((uint32_t) p[1] << 8) | ((uint32_t) p[2] << 16) | ((uint32_t) p[3] << 24);
+}
+
+celix_status_t zipStream_create(const char *destination, zip_stream_pt *stream) {
+	celix_status_t status = CELIX_SUCCESS;
+
+	*stream = calloc(1, sizeof(**stream));
+	if (*stream == NULL) {
+		status = CELIX_ENOMEM;
+	} else {
+		(*stream)->destination = strdup(destination);
+		(*stream)->buffer = malloc(ZIP_STREAM_BUFFER_SIZE);
+		(*stream)->state = ZIP_STREAM_HEADER;
+		if ((*stream)->destination == NULL || (*stream)->buffer == NULL) {
+			zipStream_destroy(*stream);
+			*stream = NULL;
+			status = CELIX_ENOMEM;
+		}
+	}
+
+	return status;
+}
+
+void zipStream_destroy(zip_stream_pt stream) {
+	if (stream != NULL) {
+		if (stream->out != NULL) {
+			fclose(stream->out);
+		}
+		if (stream->inflaterInitialized) {
+			inflateEnd(&stream->inflater);
+		}
+		free(stream->name);
+		free(stream->buffer);
+		free(stream->destination);
+		free(stream);
+	}
+}
+
+celix_status_t zipStream_write(zip_stream_pt stream, const void *input, size_t size) {
+	celix_status_t status = CELIX_SUCCESS;
+	const unsigned char *data = input;
+
+	while (status == CELIX_SUCCESS && size > 0 && stream->state != ZIP_STREAM_DONE) {
+		size_t used = 0;
+		switch (stream->state) {
+			case ZIP_STREAM_HEADER: {
+				used = ZIP_LOCAL_HEADER_SIZE - stream->headerSize;
+				used = used < size ? used : size;
+				memcpy(stream->header + stream->headerSize, data, used);
+				stream->headerSize += used;
+				if (stream->headerSize >= 4) {
+					uint32_t signature = zipStream_le32(stream->header);
+					if (signature == ZIP_CENTRAL_HEADER_SIGNATURE || signature == ZIP_END_OF_CENTRAL_SIGNATURE) {
+						//all entries are read, the central directory is not needed
+						stream->state = ZIP_STREAM_DONE;
+						break;
+					} else if (signature != ZIP_LOCAL_HEADER_SIGNATURE) {
+						status = CELIX_FILE_IO_EXCEPTION;
+						break;
+					}
+				}
+				if (stream->headerSize == ZIP_LOCAL_HEADER_SIZE) {
+					stream->flags = zipStream_le16(stream->header + 6);
+					stream->method = zipStream_le16(stream->header + 8);
+					stream->crc = zipStream_le32(stream->header + 14);
+					stream->compressedSize = zipStream_le32(stream->header + 18);
+					stream->uncompressedSize = zipStream_le32(stream->header + 22);
+					stream->nameLength = zipStream_le16(stream->header + 26);
+					stream->extraLength = zipStream_le16(stream->header + 28);
+					stream->nameSize = 0;
+					stream->headerSize = 0;
+					free(stream->name);
+					stream->name = calloc(1, stream->nameLength + stream->extraLength + 1);
+					if (stream->name == NULL) {
+						status = CELIX_ENOMEM;
+					} else if (stream->nameLength == 0) {
+						status = CELIX_FILE_IO_EXCEPTION;
+					} else {
+						stream->state = ZIP_STREAM_NAME;
+					}
+				}
+				break;
+			}
+			case ZIP_STREAM_NAME: {
+				size_t needed = stream->nameLength + stream->extraLength - stream->nameSize;
+				used = needed < size ? needed : size;
+				memcpy(stream->name + stream->nameSize, data, used);
+				stream->nameSize += used;
+				if (stream->nameSize == stream->nameLength + stream->extraLength) {
+					stream->name[stream->nameLength] = '\0'; //drop the extra field
+					status = zipStream_openEntry(stream);
+				}
+				break;
+			}
+			case ZIP_STREAM_DATA:
+				used = zipStream_readData(stream, data, size, &status);
+				break;
+			case ZIP_STREAM_DESCRIPTOR: {
+				//optional signature, crc, compressed size, uncompressed size. The first 4 bytes tell the size.
+				size_t needed = 4;
+				if (stream->headerSize >= 4) {
+					needed = zipStream_le32(stream->header) == ZIP_DATA_DESCRIPTOR_SIGNATURE ? 16 : 12;
+				}
+				used = needed - stream->headerSize;
+				used = used < size ? used : size;
+				memcpy(stream->header + stream->headerSize, data, used);
+				stream->headerSize += used;
+				if (stream->headerSize == needed && needed > 4) {
+					const unsigned char *descriptor = stream->header + (needed - 12);
+					stream->crc = zipStream_le32(descriptor);
+					stream->compressedSize = zipStream_le32(descriptor + 4);
+					stream->uncompressedSize = zipStream_le32(descriptor + 8);
+					stream->headerSize = 0;
+					status = zipStream_closeEntry(stream);
+				}
+				break;
+			}
+			default:
+				status = CELIX_ILLEGAL_STATE;
+				break;
+		}
+		data += used;
+		size -= used;
+	}
+
+	if (status != CELIX_SUCCESS) {
+		stream->state = ZIP_STREAM_ERROR;
+	}
+	return status;
+}
+
+celix_status_t zipStream_finish(zip_stream_pt stream) {
+	//note a zip file without central directory is also accepted, as long as no entry is incomplete
+	bool complete = stream->state == ZIP_STREAM_DONE || (stream->state == ZIP_STREAM_HEADER && stream->headerSize == 0);
+	return complete ? CELIX_SUCCESS : CELIX_FILE_IO_EXCEPTION;
+}
+
+static celix_status_t zipStream_openEntry(zip_stream_pt stream) {
+	celix_status_t status = CELIX_SUCCESS;
+
+	bool isDirectory = stream->name[stream->nameLength - 1] == '/';
+	if ((stream->flags & ZIP_FLAG_ENCRYPTED) != 0) {
+		status = CELIX_FILE_IO_EXCEPTION;
+	} else if (stream->compressedSize == 0xFFFFFFFF || stream->uncompressedSize == 0xFFFFFFFF) {
+		status = CELIX_FILE_IO_EXCEPTION; //zip64
+	} else if (stream->method != ZIP_METHOD_STORED && stream->method != ZIP_METHOD_DEFLATED) {
+		status = CELIX_FILE_IO_EXCEPTION;
+	} else if (stream->method == ZIP_METHOD_STORED && (stream->flags & ZIP_FLAG_DATA_DESCRIPTOR) != 0) {
+		status = CELIX_FILE_IO_EXCEPTION; //the end of the entry cannot be found without the central directory
+	} else if (stream->name[0] == '/' || strstr(stream->name, "..") != NULL) {
+		status = CELIX_FILE_IO_EXCEPTION; //entries must stay within the destination
+	}
+
+	size_t length = strlen(stream->destination) + stream->nameLength + 2;
+	char path[length];
+	snprintf(path, length, "%s/%s", stream->destination, stream->name);
+
+	if (status == CELIX_SUCCESS) {
+		status = zipStream_makeParentDirs(path);
+	}
+	if (status == CELIX_SUCCESS && isDirectory) {
+		if (mkdir(path, 0775) != 0 && errno != EEXIST) {
+			status = CELIX_FILE_IO_EXCEPTION;
+		}
+	} else if (status == CELIX_SUCCESS) {
+		stream->out = fopen(path, "wb");
+		if (stream->out == NULL) {
+			status = CELIX_FILE_IO_EXCEPTION;
+		}
+	}
+
+	if (status == CELIX_SUCCESS && stream->method == ZIP_METHOD_DEFLATED) {
+		memset(&stream->inflater, 0, sizeof(stream->inflater));
+		if (inflateInit2(&stream->inflater, -MAX_WBITS) != Z_OK) { //raw deflate
+			status = CELIX_ENOMEM;
+		} else {
+			stream->inflaterInitialized = true;
+		}
+	}
+
+	if (status == CELIX_SUCCESS) {
+		stream->actualCrc = crc32(0L, Z_NULL, 0);
+		stream->compressedRead = 0;
+		stream->uncompressedWritten = 0;
+		stream->state = ZIP_STREAM_DATA;
+		if (stream->method == ZIP_METHOD_STORED && stream->compressedSize == 0) {
+			status = zipStream_closeEntry(stream);
+		}
+	} else {
+		printf("DEPLOYMENT_ADMIN: Cannot stream extract entry %s\n", stream->name);
+	}
+
+	return status;
+}
+
+static celix_status_t zipStream_closeEntry(zip_stream_pt stream) {
+	celix_status_t status = CELIX_SUCCESS;
+
+	if (stream->out != NULL && fclose(stream->out) != 0) {
+		status = CELIX_FILE_IO_EXCEPTION;
+	}
+	stream->out = NULL;
+	if (stream->inflaterInitialized) {
+		inflateEnd(&stream->inflater);
+		stream->inflaterInitialized = false;
+	}
+
+	if (stream->crc != stream->actualCrc || stream->uncompressedSize != (uint32_t) stream->uncompressedWritten) {
+		printf("DEPLOYMENT_ADMIN: Corrupt zip entry %s\n", stream->name);
+		status = CELIX_FILE_IO_EXCEPTION;
+	}
+
+	stream->state = ZIP_STREAM_HEADER;
+	return status;
+}
+
+/**
+ * Returns the number of used input bytes.
+ */
+static size_t zipStream_readData(zip_stream_pt stream, const unsigned char *data, size_t size, celix_status_t *status) {
+	bool hasDescriptor = (stream->flags & ZIP_FLAG_DATA_DESCRIPTOR) != 0;
+	size_t available = size;
+	if (!hasDescriptor) {
+		size_t remaining = stream->compressedSize - stream->compressedRead;
+		available = remaining < size ? remaining : size;
+	}
+
+	size_t used = 0;
+	bool entryDone = false;
+	if (stream->method == ZIP_METHOD_STORED) {
+		*status = zipStream_writeOut(stream, data, available);
+		used = available;
+	} else {
+		int rc = Z_OK;
+		stream->inflater.next_in = (unsigned char *) data;
+		stream->inflater.avail_in = (uInt) available;
+		while (*status == CELIX_SUCCESS && rc != Z_STREAM_END && stream->inflater.avail_in > 0) {
+			stream->inflater.next_out = stream->buffer;
+			stream->inflater.avail_out = ZIP_STREAM_BUFFER_SIZE;
+			rc = inflate(&stream->inflater, Z_NO_FLUSH);
+			if (rc != Z_OK && rc != Z_STREAM_END) {
+				*status = CELIX_FILE_IO_EXCEPTION;
+			} else {
+				*status = zipStream_writeOut(stream, stream->buffer, ZIP_STREAM_BUFFER_SIZE - stream->inflater.avail_out);
+			}
+		}
+		//flush output still pending in the inflater
+		while (*status == CELIX_SUCCESS && rc == Z_OK && stream->inflater.avail_out == 0) {
+			stream->inflater.next_out = stream->buffer;
+			stream->inflater.avail_out = ZIP_STREAM_BUFFER_SIZE;
+			rc = inflate(&stream->inflater, Z_NO_FLUSH);
+			if (rc != Z_OK && rc != Z_STREAM_END && rc != Z_BUF_ERROR) {
+				*status = CELIX_FILE_IO_EXCEPTION;
+			} else {
+				*status = zipStream_writeOut(stream, stream->buffer, ZIP_STREAM_BUFFER_SIZE - stream->inflater.avail_out);
+			}
+		}
+		used = available - stream->inflater.avail_in;
+		entryDone = rc == Z_STREAM_END;
+	}
+	stream->compressedRead += used;
+
+	if (*status == CELIX_SUCCESS) {
+		if (hasDescriptor && entryDone) {
+			stream->state = ZIP_STREAM_DESCRIPTOR;
+			stream->headerSize = 0;
+		} else if (!hasDescriptor && stream->compressedRead == stream->compressedSize) {
+			if (stream->method == ZIP_METHOD_DEFLATED && !entryDone) {
+				*status = CELIX_FILE_IO_EXCEPTION;
+			} else {
+				*status = zipStream_closeEntry(stream);
+			}
+		} else if (!hasDescriptor && entryDone) {
+			*status = CELIX_FILE_IO_EXCEPTION; //deflate stream ended before the compressed size
+		}
+	}
+
+	return used;
+}
+
+static celix_status_t zipStream_writeOut(zip_stream_pt stream, const unsigned char *data, size_t size) {
+	if (size == 0) {
+		return CELIX_SUCCESS;
+	}
+	stream->actualCrc = crc32(stream->actualCrc, data, (uInt) size);
+	stream->uncompressedWritten += size;
+	if (stream->out == NULL || fwrite(data, 1, size, stream->out) != size) {
+		return CELIX_FILE_IO_EXCEPTION;
+	}
+	return CELIX_SUCCESS;
+}
+
+static celix_status_t zipStream_makeParentDirs(char *path) {
+	celix_status_t status = CELIX_SUCCESS;
+	char *slash = strchr(path + 1, '/');
+	while (status == CELIX_SUCCESS && slash != NULL) {
+		*slash = '\0';
+		if (mkdir(path, 0775) != 0 && errno != EEXIST) {
+			status = CELIX_FILE_IO_EXCEPTION;
+		}
+		*slash = '/';
+		slash = strchr(slash + 1, '/');
+	}
+	return status;
+}
@@ -0,0 +1,55 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *  KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+/**
+ * zip_stream.h
+ *
+ *  \date       Oct 15, 2026
+ *  \author    	<a href="mailto:dev@celix.apache.org">Apache Celix Project Team</a>
+ *  \copyright	Apache License, Version 2.0
+ */
+
+#ifndef ZIP_STREAM_H_
+#define ZIP_STREAM_H_
+
+#include <stddef.h>
+
+#include "celix_errno.h"
+
+/**
+ * Extracts a zip file while it is being received, using the local file headers instead of the central directory
+ * (which is only available at the end of the file). Supports stored and deflated entries, also with data
+ * descriptors (as written by jar). Zip64 and encrypted entries are not supported, for these zipStream_write fails
+ * and the caller should fall back to unzip_extractDeploymentPackage on the complete file.
+ */
+typedef struct zip_stream *zip_stream_pt;
+
+celix_status_t zipStream_create(const char *destination, zip_stream_pt *stream);
+void zipStream_destroy(zip_stream_pt stream);
+
+/**
+ * Extracts the next part of the zip file. After an error the stream stays failed.
+ */
+celix_status_t zipStream_write(zip_stream_pt stream, const void *data, size_t size);
+
+/**
+ * Returns CELIX_SUCCESS if all entries were extracted completely.
+ */
+celix_status_t zipStream_finish(zip_stream_pt stream);
+
+#endif /* ZIP_STREAM_H_ */
@@ -0,0 +1,100 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *  KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+#include <string>
+
+#include "celix_api.h"
+extern "C" {
+#include "manifest.h"
+#include "deployment_package.h"
+}
+
+#include <CppUTest/TestHarness.h>
+
+namespace {
+    deployment_package_pt createPackage(const char *manifestFile) {
+        manifest_pt manifest = nullptr;
+        std::string path = std::string{DEPLOYMENT_ADMIN_TEST_DIR} + "/" + manifestFile;
+        CHECK_EQUAL(CELIX_SUCCESS, manifest_createFromFile(path.c_str(), &manifest));
+        deployment_package_pt package = nullptr;
+        CHECK_EQUAL(CELIX_SUCCESS, deploymentPackage_create(nullptr, manifest, &package));
+        return package;
+    }
+}
+
+TEST_GROUP(DeploymentPackageTests) {
+};
+
+TEST(DeploymentPackageTests, fullPackage) {
+    deployment_package_pt full = createPackage("full.MF");
+    bool isFixPackage = true;
+    CHECK_EQUAL(CELIX_SUCCESS, deploymentPackage_isFixPackage(full, &isFixPackage));
+    CHECK_FALSE(isFixPackage);
+
+    bool applicable = false;
+    CHECK_EQUAL(CELIX_SUCCESS, deploymentPackage_canBeAppliedTo(full, nullptr, &applicable));
+    CHECK(applicable);
+
+    bundle_info_pt info = nullptr;
+    CHECK_EQUAL(CELIX_SUCCESS, deploymentPackage_getBundleInfoByName(full, "bundle1", &info));
+    CHECK(info != nullptr);
+    CHECK_FALSE(info->missing);
+    deploymentPackage_destroy(full);
+}
+
+TEST(DeploymentPackageTests, fixPackage) {
+    deployment_package_pt installed = createPackage("full.MF");
+    deployment_package_pt fix = createPackage("fix.MF");
+
+    bool isFixPackage = false;
+    CHECK_EQUAL(CELIX_SUCCESS, deploymentPackage_isFixPackage(fix, &isFixPackage));
+    CHECK(isFixPackage);
+
+    //unchanged bundles and resources are listed as missing
+    bundle_info_pt info = nullptr;
+    CHECK_EQUAL(CELIX_SUCCESS, deploymentPackage_getBundleInfoByName(fix, "bundle1", &info));
+    CHECK(info->missing);
+    CHECK_EQUAL(CELIX_SUCCESS, deploymentPackage_getBundleInfoByName(fix, "bundle2", &info));
+    CHECK_FALSE(info->missing);
+    resource_info_pt resource = nullptr;
+    CHECK_EQUAL(CELIX_SUCCESS, deploymentPackage_getResourceInfoByPath(fix, "res.txt", &resource));
+    CHECK(resource->missing);
+
+    //the installed version 1.0.0 is within the fix pack range [1.0,2.0)
+    bool applicable = false;
+    CHECK_EQUAL(CELIX_SUCCESS, deploymentPackage_canBeAppliedTo(fix, installed, &applicable));
+    CHECK(applicable);
+    //without an installed package a fix package cannot be applied
+    CHECK_EQUAL(CELIX_SUCCESS, deploymentPackage_canBeAppliedTo(fix, nullptr, &applicable));
+    CHECK_FALSE(applicable);
+
+    deploymentPackage_destroy(installed);
+    deploymentPackage_destroy(fix);
+}
+
+TEST(DeploymentPackageTests, fixPackageOutOfRange) {
+    deployment_package_pt installed = createPackage("fix.MF"); //version 1.1.0
+    deployment_package_pt fix = createPackage("fix2.MF"); //applies to [1.1.1,2.0)
+
+    bool applicable = true;
+    CHECK_EQUAL(CELIX_SUCCESS, deploymentPackage_canBeAppliedTo(fix, installed, &applicable));
+    CHECK_FALSE(applicable);
+
+    deploymentPackage_destroy(installed);
+    deploymentPackage_destroy(fix);
+}
@@ -0,0 +1,132 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *  KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <fstream>
+#include <sstream>
+
+extern "C" {
+#include "zip_stream.h"
+}
+
+#include <CppUTest/TestHarness.h>
+
+#define ZIP_STREAM_TEST_OUT "zip_stream_test_out"
+
+namespace {
+    std::string readFile(const std::string &path) {
+        std::ifstream in{path, std::ios::binary};
+        std::stringstream content{};
+        content << in.rdbuf();
+        return content.str();
+    }
+
+    std::string expectedBundle() {
+        std::string content{};
+        for (int i = 0; i < 5000; ++i) {
+            content += "line " + std::to_string(i) + "\n";
+        }
+        return content;
+    }
+}
+
+TEST_GROUP(ZipStreamTests) {
+    void setup() {
+        CHECK_EQUAL(0, system("rm -rf " ZIP_STREAM_TEST_OUT));
+    }
+
+    void teardown() {
+        CHECK_EQUAL(0, system("rm -rf " ZIP_STREAM_TEST_OUT));
+    }
+
+    /**
+     * Writes the zip in parts of chunkSize bytes and returns the status of the first failing call.
+     */
+    celix_status_t extract(const char *zip, size_t chunkSize) {
+        std::string data = readFile(std::string{DEPLOYMENT_ADMIN_TEST_DIR} + "/" + zip);
+        CHECK(!data.empty());
+        zip_stream_pt stream = nullptr;
+        CHECK_EQUAL(CELIX_SUCCESS, zipStream_create(ZIP_STREAM_TEST_OUT, &stream));
+        celix_status_t status = CELIX_SUCCESS;
+        for (size_t pos = 0; status == CELIX_SUCCESS && pos < data.size(); pos += chunkSize) {
+            status = zipStream_write(stream, data.data() + pos, std::min(chunkSize, data.size() - pos));
+        }
+        if (status == CELIX_SUCCESS) {
+            status = zipStream_finish(stream);
+        }
+        zipStream_destroy(stream);
+        return status;
+    }
+
+    void checkExtracted() {
+        std::string manifest = readFile(ZIP_STREAM_TEST_OUT "/META-INF/MANIFEST.MF");
+        CHECK(manifest.find("DeploymentPackage-SymbolicName: test") != std::string::npos);
+        CHECK(readFile(ZIP_STREAM_TEST_OUT "/bundle1.zip") == expectedBundle());
+        STRCMP_EQUAL("resource\n", readFile(ZIP_STREAM_TEST_OUT "/dir/sub/res.txt").c_str());
+    }
+};
+
+TEST(ZipStreamTests, deflated) {
+    //also in parts smaller than a local header
+    for (size_t chunkSize : {(size_t)1, (size_t)7, (size_t)4096, (size_t)1 << 20}) {
+        CHECK_EQUAL(CELIX_SUCCESS, extract("deflated.zip", chunkSize));
+        checkExtracted();
+    }
+}
+
+TEST(ZipStreamTests, stored) {
+    CHECK_EQUAL(CELIX_SUCCESS, extract("stored.zip", 13));
+    checkExtracted();
+}
+
+TEST(ZipStreamTests, dataDescriptors) {
+    //as written by jar, the sizes and crc follow the entry data
+    CHECK_EQUAL(CELIX_SUCCESS, extract("streamed.zip", 1));
+    checkExtracted();
+    CHECK_EQUAL(CELIX_SUCCESS, extract("streamed.zip", 4096));
+    checkExtracted();
+}
+
+TEST(ZipStreamTests, incompleteZip) {
+    std::string data = readFile(std::string{DEPLOYMENT_ADMIN_TEST_DIR} + "/deflated.zip");
+    zip_stream_pt stream = nullptr;
+    CHECK_EQUAL(CELIX_SUCCESS, zipStream_create(ZIP_STREAM_TEST_OUT, &stream));
+    CHECK_EQUAL(CELIX_SUCCESS, zipStream_write(stream, data.data(), data.size() / 2));
+    CHECK(zipStream_finish(stream) != CELIX_SUCCESS);
+    zipStream_destroy(stream);
+}
+
+TEST(ZipStreamTests, unsupportedZipsFail) {
+    //the caller falls back to extracting the complete file
+    CHECK(extract("zip64.zip", 4096) != CELIX_SUCCESS);
+    //entries outside the destination are rejected
+    CHECK(extract("escape.zip", 4096) != CELIX_SUCCESS);
+    CHECK(fopen("escape.txt", "r") == nullptr);
+
+    std::string garbage(100, 'x');
+    zip_stream_pt stream = nullptr;
+    CHECK_EQUAL(CELIX_SUCCESS, zipStream_create(ZIP_STREAM_TEST_OUT, &stream));
+    CHECK(zipStream_write(stream, garbage.data(), garbage.size()) != CELIX_SUCCESS);
+    //the stream stays failed
+    std::string zip = readFile(std::string{DEPLOYMENT_ADMIN_TEST_DIR} + "/deflated.zip");
+    CHECK(zipStream_write(stream, zip.data(), zip.size()) != CELIX_SUCCESS);
+    CHECK(zipStream_finish(stream) != CELIX_SUCCESS);
+    zipStream_destroy(stream);
+}
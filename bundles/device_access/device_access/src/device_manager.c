@@ -27,6 +27,8 @@
 #include <stdlib.h>
 #include "celix_constants.h"
 #include <string.h>
+#include "celix_threads.h"
+#include "celix_bundle_context.h"
 
 #include "device_manager.h"
 #include "driver_locator.h"
@@ -51,8 +53,23 @@ struct device_manager {
 	array_list_pt locators;
 	driver_selector_service_pt selector;
 	log_helper_t *loghelper;
+	long matchThreads; //max nr of threads used to evaluate driver matches, see DEVICE_MANAGER_MATCH_THREADS
 };
 
+#define DEVICE_MANAGER_MATCH_THREADS "DEVICE_MANAGER_MATCH_THREADS"
+#define DEVICE_MANAGER_MATCH_THREADS_DEFAULT 4
+//below this nr of drivers per thread, matches are evaluated on the calling thread
+#define DEVICE_MANAGER_MIN_DRIVERS_PER_MATCH_THREAD 4
+
+typedef struct device_manager_match_job {
+	array_list_pt drivers; //driver_attributes_pt
+	service_reference_pt reference;
+	int *matches;
+	celix_status_t *statuses;
+	int start;
+	int end;
+} device_manager_match_job_t;
+
 static celix_status_t deviceManager_attachAlgorithm(device_manager_pt manager, service_reference_pt ref, void *service);
 static celix_status_t deviceManager_getIdleDevices(device_manager_pt manager, array_list_pt *idleDevices);
 static celix_status_t deviceManager_isDriverBundle(device_manager_pt manager, bundle_pt bundle, bool *isDriver);
@@ -74,6 +91,7 @@ celix_status_t deviceManager_create(bundle_context_pt context, log_helper_t *log
 		(*manager)->drivers = hashMap_create(serviceReference_hashCode, NULL, serviceReference_equals2, NULL);
 
 		(*manager)->loghelper = logHelper;
+		(*manager)->matchThreads = celix_bundleContext_getPropertyAsLong(context, DEVICE_MANAGER_MATCH_THREADS, DEVICE_MANAGER_MATCH_THREADS_DEFAULT);
 
 		status = arrayList_create(&(*manager)->locators);
 
@@ -219,6 +237,51 @@ static celix_status_t deviceManager_attachAlgorithm(device_manager_pt manager, s
 	return status;
 }
 
+static void* deviceManager_matchJob(void *data) {
+	device_manager_match_job_t *job = data;
+	for (int i = job->start; i < job->end; i++) {
+		job->statuses[i] = driverAttributes_match(arrayList_get(job->drivers, i), job->reference, &job->matches[i]);
+	}
+	return NULL;
+}
+
+/**
+ * Evaluates the match of all drivers for the device. With many drivers, the (driver provided) match functions are
+ * called concurrently on up to matchThreads threads. The results are stored per driver index, so the outcome does not
+ * depend on the evaluation order.
+ */
+static void deviceManager_evaluateMatches(device_manager_pt manager, array_list_pt drivers, service_reference_pt reference, int *matches, celix_status_t *statuses) {
+	int size = arrayList_size(drivers);
+	int nrOfThreads = (int)manager->matchThreads;
+	if (nrOfThreads > size / DEVICE_MANAGER_MIN_DRIVERS_PER_MATCH_THREAD) {
+		nrOfThreads = size / DEVICE_MANAGER_MIN_DRIVERS_PER_MATCH_THREAD;
+	}
+	if (nrOfThreads <= 1) {
+		device_manager_match_job_t job = {drivers, reference, matches, statuses, 0, size};
+		deviceManager_matchJob(&job);
+		return;
+	}
+
+	device_manager_match_job_t jobs[nrOfThreads];
+	celix_thread_t threads[nrOfThreads];
+	bool started[nrOfThreads];
+	int chunk = (size + nrOfThreads - 1) / nrOfThreads;
+	for (int t = 0; t < nrOfThreads; t++) {
+		jobs[t] = (device_manager_match_job_t){drivers, reference, matches, statuses, t * chunk, (t + 1) * chunk < size ? (t + 1) * chunk : size};
+		//the first chunk is evaluated on the calling thread
+		started[t] = t > 0 && celixThread_create(&threads[t], NULL, deviceManager_matchJob, &jobs[t]) == CELIX_SUCCESS;
+		if (t > 0 && !started[t]) {
+			deviceManager_matchJob(&jobs[t]);
+		}
+	}
+	deviceManager_matchJob(&jobs[0]);
+	for (int t = 1; t < nrOfThreads; t++) {
+		if (started[t]) {
+			celixThread_join(threads[t], NULL);
+		}
+	}
+}
+
 celix_status_t deviceManager_matchAttachDriver(device_manager_pt manager, driver_loader_pt loader,
 		array_list_pt driverIds, array_list_pt included, array_list_pt excluded, void *service, service_reference_pt reference) {
 	celix_status_t status = CELIX_SUCCESS;
@@ -249,11 +312,15 @@ celix_status_t deviceManager_matchAttachDriver(device_manager_pt manager, driver
 		driver_matcher_pt matcher = NULL;
 		status = driverMatcher_create(manager->context, &matcher);
 		if (status == CELIX_SUCCESS) {
-			for (i = 0; i < arrayList_size(included); i++) {
+			int nrOfIncluded = arrayList_size(included);
+			int *matches = calloc(nrOfIncluded > 0 ? nrOfIncluded : 1, sizeof(*matches));
+			celix_status_t *statuses = calloc(nrOfIncluded > 0 ? nrOfIncluded : 1, sizeof(*statuses));
+			deviceManager_evaluateMatches(manager, included, reference, matches, statuses);
+			for (i = 0; i < nrOfIncluded; i++) {
 				driver_attributes_pt attributes = arrayList_get(included, i);
 
-				int match = 0;
-				celix_status_t substatus = driverAttributes_match(attributes, reference, &match);
+				int match = matches[i];
+				celix_status_t substatus = statuses[i];
 				if (substatus == CELIX_SUCCESS) {
 					logHelper_log(manager->loghelper, OSGI_LOGSERVICE_INFO, "DEVICE_MANAGER: Found match: %d", match);
 					if (match <= OSGI_DEVICEACCESS_DEVICE_MATCH_NONE) {
@@ -264,6 +331,8 @@ celix_status_t deviceManager_matchAttachDriver(device_manager_pt manager, driver
 					// Ignore
 				}
 			}
+			free(matches);
+			free(statuses);
 
 			match_pt match = NULL;
 			status = driverMatcher_getBestMatch(matcher, reference, &match);
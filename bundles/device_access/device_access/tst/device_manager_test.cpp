@@ -0,0 +1,177 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *  KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+#include <mutex>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "celix_api.h"
+#include "celix_framework_factory.h"
+extern "C" {
+#include "service_reference.h"
+#include "log_helper.h"
+#include "device.h"
+#include "driver.h"
+#include "device_manager.h"
+}
+
+#include <CppUTest/TestHarness.h>
+
+#define NR_OF_DRIVERS 12
+
+namespace {
+    struct test_driver {
+        int matchValue;
+        std::mutex *mutex;
+        std::set<std::thread::id> *matchThreads;
+        int *nrOfMatches;
+        std::vector<int> *attached;
+        driver_service svc;
+    };
+
+    celix_status_t matchDriver(void *handle, service_reference_pt /*reference*/, int *value) {
+        auto *driver = static_cast<test_driver*>(handle);
+        //slow enough for the match threads to overlap
+        std::this_thread::sleep_for(std::chrono::milliseconds{5});
+        std::lock_guard<std::mutex> lock{*driver->mutex};
+        driver->matchThreads->insert(std::this_thread::get_id());
+        *driver->nrOfMatches += 1;
+        *value = driver->matchValue;
+        return CELIX_SUCCESS;
+    }
+
+    celix_status_t attachDriver(void *handle, service_reference_pt /*reference*/, char **result) {
+        auto *driver = static_cast<test_driver*>(handle);
+        std::lock_guard<std::mutex> lock{*driver->mutex};
+        driver->attached->push_back(driver->matchValue);
+        *result = nullptr;
+        return CELIX_SUCCESS;
+    }
+
+    celix_status_t noDriverFound(device_pt /*device*/) {
+        return CELIX_SUCCESS;
+    }
+}
+
+TEST_GROUP(DeviceManagerTests) {
+    celix_framework_t *fw = nullptr;
+    celix_bundle_context_t *ctx = nullptr;
+    log_helper_t *logHelper = nullptr;
+    device_manager_pt manager = nullptr;
+
+    std::mutex mutex{};
+    std::set<std::thread::id> matchThreads{};
+    int nrOfMatches = 0;
+    std::vector<int> attached{};
+    test_driver drivers[NR_OF_DRIVERS];
+    device_service deviceSvc{};
+    std::vector<long> svcIds{};
+    std::vector<service_reference_pt> refs{};
+
+    void createManager(const char *matchThreads) {
+        celix_properties_t *properties = celix_properties_create();
+        celix_properties_set(properties, "LOGHELPER_ENABLE_STDOUT_FALLBACK", "true");
+        celix_properties_set(properties, "org.osgi.framework.storage.clean", "onFirstInit");
+        celix_properties_set(properties, "org.osgi.framework.storage", ".cacheDeviceManagerTestFramework");
+        celix_properties_set(properties, "DEVICE_MANAGER_MATCH_THREADS", matchThreads);
+        fw = celix_frameworkFactory_createFramework(properties);
+        ctx = celix_framework_getFrameworkContext(fw);
+        logHelper_create(ctx, &logHelper);
+        CHECK_EQUAL(CELIX_SUCCESS, deviceManager_create(ctx, logHelper, &manager));
+    }
+
+    void teardown() {
+        for (service_reference_pt ref : refs) {
+            bundleContext_ungetService(ctx, ref, nullptr);
+            bundleContext_ungetServiceReference(ctx, ref);
+        }
+        for (long svcId : svcIds) {
+            celix_bundleContext_unregisterService(ctx, svcId);
+        }
+        deviceManager_destroy(manager);
+        logHelper_destroy(&logHelper);
+        celix_frameworkFactory_destroyFramework(fw);
+    }
+
+    /**
+     * Registers a service and returns its reference, as the device manager trackers would.
+     */
+    service_reference_pt registerService(void *svc, const char *name, celix_properties_t *props, void **service) {
+        long svcId = celix_bundleContext_registerService(ctx, svc, name, props);
+        CHECK(svcId >= 0);
+        svcIds.push_back(svcId);
+        std::string filter = "(service.id=" + std::to_string(svcId) + ")";
+        array_list_pt list = nullptr;
+        CHECK_EQUAL(CELIX_SUCCESS, bundleContext_getServiceReferences(ctx, name, filter.c_str(), &list));
+        CHECK_EQUAL(1, arrayList_size(list));
+        auto *ref = static_cast<service_reference_pt>(arrayList_get(list, 0));
+        arrayList_destroy(list);
+        refs.push_back(ref);
+        CHECK_EQUAL(CELIX_SUCCESS, bundleContext_getService(ctx, ref, service));
+        return ref;
+    }
+
+    void addDriversAndDevice() {
+        //the match values are shuffled, driver 7 matches best
+        for (int i = 0; i < NR_OF_DRIVERS; ++i) {
+            drivers[i] = test_driver{(i * 5) % NR_OF_DRIVERS + 1, &mutex, &matchThreads, &nrOfMatches, &attached, {}};
+            drivers[i].svc.driver = &drivers[i];
+            drivers[i].svc.match = matchDriver;
+            drivers[i].svc.attach = attachDriver;
+            celix_properties_t *props = celix_properties_create();
+            celix_properties_set(props, OSGI_DEVICEACCESS_DRIVER_ID, ("driver" + std::to_string(i)).c_str());
+            void *svc = nullptr;
+            service_reference_pt ref = registerService(&drivers[i].svc, OSGI_DEVICEACCESS_DRIVER_SERVICE_NAME, props, &svc);
+            CHECK_EQUAL(CELIX_SUCCESS, deviceManager_driverAdded(manager, ref, svc));
+        }
+
+        deviceSvc.noDriverFound = noDriverFound;
+        celix_properties_t *props = celix_properties_create();
+        celix_properties_set(props, OSGI_DEVICEACCESS_DEVICE_CATEGORY, "test");
+        void *svc = nullptr;
+        service_reference_pt ref = registerService(&deviceSvc, OSGI_DEVICEACCESS_DEVICE_SERVICE_NAME, props, &svc);
+        CHECK_EQUAL(CELIX_SUCCESS, deviceManager_deviceAdded(manager, ref, svc));
+    }
+};
+
+TEST(DeviceManagerTests, parallelMatch) {
+    createManager("4");
+    addDriversAndDevice();
+
+    std::lock_guard<std::mutex> lock{mutex};
+    CHECK_EQUAL(NR_OF_DRIVERS, nrOfMatches);
+    CHECK(matchThreads.size() > 1);
+    CHECK(matchThreads.size() <= 3); //12 drivers, at least 4 drivers per thread
+    //the best match is attached, independent of the evaluation order
+    CHECK_EQUAL(1, (int)attached.size());
+    CHECK_EQUAL(NR_OF_DRIVERS, attached[0]);
+}
+
+TEST(DeviceManagerTests, sequentialMatch) {
+    createManager("1");
+    addDriversAndDevice();
+
+    std::lock_guard<std::mutex> lock{mutex};
+    CHECK_EQUAL(NR_OF_DRIVERS, nrOfMatches);
+    CHECK_EQUAL(1, (int)matchThreads.size());
+    CHECK(*matchThreads.begin() == std::this_thread::get_id());
+    CHECK_EQUAL(1, (int)attached.size());
+    CHECK_EQUAL(NR_OF_DRIVERS, attached[0]);
+}
@@ -53,24 +53,25 @@ celix_status_t bundleActivator_start(void * userData, bundle_context_pt context)
     celix_status_t status = CELIX_SUCCESS;
     bundle_instance_pt bi = (bundle_instance_pt)userData;
 
+    const char *path = NULL;
+    bundleContext_getProperty(context, "DRIVER_LOCATOR_PATH", &path);
+    if (path == NULL) {
+	path = DEFAULT_LOCATOR_PATH;
+    }
+
     bi->service = calloc(1, sizeof(*(bi->service)));
-    bi->locator = calloc(1, sizeof(*(bi->locator)));
+    bi->locator = NULL;
+    driverLocator_create(path, &bi->locator);
     if(bi->service != NULL && bi->locator != NULL){
 	bi->service->findDrivers = driverLocator_findDrivers;
 	bi->service->loadDriver = driverLocator_loadDriver;
 
 	bi->service->locator = bi->locator;
-	bi->locator->drivers = NULL;
-	arrayList_create(&bi->locator->drivers);
-	bundleContext_getProperty(context, "DRIVER_LOCATOR_PATH", (const char**)&bi->locator->path);
-	if (bi->locator->path == NULL ) {
-		bi->locator->path = (char *)DEFAULT_LOCATOR_PATH;
-	}
 	status = bundleContext_registerService(context, OSGI_DEVICEACCESS_DRIVER_LOCATOR_SERVICE_NAME, bi->service, NULL, &bi->locatorRegistration);
     }
     else{
 	if(bi->service!=NULL) free(bi->service);
-	if(bi->locator!=NULL) free(bi->locator);
+	driverLocator_destroy(bi->locator);
 	status = CELIX_ENOMEM;
     }
 
@@ -81,7 +82,10 @@ celix_status_t bundleActivator_stop(void * userData, bundle_context_pt context)
     celix_status_t status = CELIX_SUCCESS;
     bundle_instance_pt bi = (bundle_instance_pt)userData;
     serviceRegistration_unregister(bi->locatorRegistration);
-    arrayList_destroy(bi->locator->drivers);
+    driverLocator_destroy(bi->locator);
+    bi->locator = NULL;
+    free(bi->service);
+    bi->service = NULL;
     return status;
 }
 
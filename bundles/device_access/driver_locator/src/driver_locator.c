@@ -28,9 +28,102 @@
 #include <stdlib.h>
 #include <string.h>
 #include <dirent.h>
+#include <sys/stat.h>
 
 #include "driver_locator_private.h"
 #include "device.h"
+#include "utils.h"
+
+static void driverLocator_clearIndex(driver_locator_pt locator) {
+	hash_map_iterator_pt iter = hashMapIterator_create(locator->driversByCategory);
+	while (hashMapIterator_hasNext(iter)) {
+		hash_map_entry_pt entry = hashMapIterator_nextEntry(iter);
+		array_list_pt ids = hashMapEntry_getValue(entry);
+		for (int i = 0; i < arrayList_size(ids); i++) {
+			free(arrayList_get(ids, i));
+		}
+		arrayList_destroy(ids);
+		free(hashMapEntry_getKey(entry));
+	}
+	hashMapIterator_destroy(iter);
+	hashMap_clear(locator->driversByCategory, false, false);
+	hashMap_clear(locator->driverFiles, true, true);
+	locator->indexed = false;
+}
+
+/**
+ * Ensures the index reflects the driver dir. Should be called with the locator mutex locked.
+ */
+static celix_status_t driverLocator_updateIndex(driver_locator_pt locator) {
+	struct stat st;
+	if (stat(locator->path, &st) != 0) {
+		driverLocator_clearIndex(locator);
+		return CELIX_FILE_IO_EXCEPTION;
+	}
+	//note a change in the same second as the scan cannot be detected with the dir mtime, so rescan in that case
+	if (locator->indexed && st.st_mtime == locator->indexedDirTime && st.st_mtime < locator->indexedTime) {
+		return CELIX_SUCCESS;
+	}
+
+	driverLocator_clearIndex(locator);
+	time_t scanTime = time(NULL);
+	DIR *dir = opendir(locator->path);
+	if (!dir) {
+		return CELIX_FILE_IO_EXCEPTION;
+	}
+	struct dirent *dp;
+	while ((dp = readdir(dir)) != NULL) {
+		char str1[256], str2[256], str3[256];
+		if (sscanf(dp->d_name, "%255[^.].%255s", str1, str2) == 2 && strcmp(str2, "zip") == 0 && !hashMap_containsKey(locator->driverFiles, str1)) {
+			int length = strlen(locator->path) + strlen(dp->d_name) + 2;
+			char *file = malloc(length);
+			snprintf(file, length, "%s/%s", locator->path, dp->d_name);
+			hashMap_put(locator->driverFiles, strdup(str1), file);
+		}
+		if (sscanf(dp->d_name, "%255[^_]_%255[^.].%255s", str1, str2, str3) == 3 && strcmp(str3, "zip") == 0) {
+			array_list_pt ids = hashMap_get(locator->driversByCategory, str1);
+			if (ids == NULL) {
+				arrayList_create(&ids);
+				hashMap_put(locator->driversByCategory, strdup(str1), ids);
+			}
+			int length = strlen(str1) + strlen(str2) + 2;
+			char *driver = malloc(length);
+			snprintf(driver, length, "%s_%s", str1, str2);
+			arrayList_add(ids, driver);
+		}
+	}
+	closedir(dir);
+
+	locator->indexed = true;
+	locator->indexedDirTime = st.st_mtime;
+	locator->indexedTime = scanTime;
+	return CELIX_SUCCESS;
+}
+
+celix_status_t driverLocator_create(const char *path, driver_locator_pt *locator) {
+	*locator = calloc(1, sizeof(**locator));
+	if (*locator == NULL) {
+		return CELIX_ENOMEM;
+	}
+	(*locator)->path = (char*)path;
+	arrayList_create(&(*locator)->drivers);
+	celixThreadMutex_create(&(*locator)->mutex, NULL);
+	(*locator)->driversByCategory = hashMap_create(utils_stringHash, NULL, utils_stringEquals, NULL);
+	(*locator)->driverFiles = hashMap_create(utils_stringHash, NULL, utils_stringEquals, NULL);
+	return CELIX_SUCCESS;
+}
+
+celix_status_t driverLocator_destroy(driver_locator_pt locator) {
+	if (locator != NULL) {
+		driverLocator_clearIndex(locator);
+		hashMap_destroy(locator->driversByCategory, false, false);
+		hashMap_destroy(locator->driverFiles, false, false);
+		celixThreadMutex_destroy(&locator->mutex);
+		arrayList_destroy(locator->drivers);
+		free(locator);
+	}
+	return CELIX_SUCCESS;
+}
 
 celix_status_t driverLocator_findDrivers(driver_locator_pt locator, properties_pt props, array_list_pt *drivers) {
 	celix_status_t status = CELIX_SUCCESS;
@@ -39,25 +132,13 @@ celix_status_t driverLocator_findDrivers(driver_locator_pt locator, properties_p
 
 	status = arrayList_create(drivers);
 	if (status == CELIX_SUCCESS) {
-		DIR *dir;
-		dir = opendir(locator->path);
-		if (!dir) {
-			status = CELIX_FILE_IO_EXCEPTION;
-		} else {
-			struct dirent *dp;
-			while ((dp = readdir(dir)) != NULL) {
-				char str1[256], str2[256], str3[256];
-				if (sscanf(dp->d_name, "%[^_]_%[^.].%s", str1, str2, str3) == 3 &&
-					strcmp(str1, category) == 0 &&
-					strcmp(str3, "zip") == 0) {
-					int length = strlen(str1) + strlen(str2) + 2;
-					char driver[length];
-					snprintf(driver, length, "%s_%s", str1, str2);
-                    arrayList_add(*drivers, strdup(driver));
-				}
-			}
-			closedir(dir);
+		celixThreadMutex_lock(&locator->mutex);
+		status = driverLocator_updateIndex(locator);
+		array_list_pt ids = (status == CELIX_SUCCESS && category != NULL) ? hashMap_get(locator->driversByCategory, category) : NULL;
+		for (int i = 0; ids != NULL && i < arrayList_size(ids); i++) {
+			arrayList_add(*drivers, strdup(arrayList_get(ids, i)));
 		}
+		celixThreadMutex_unlock(&locator->mutex);
 	}
 	return status;
 }
@@ -66,27 +147,13 @@ celix_status_t driverLocator_loadDriver(driver_locator_pt locator, char *id, cha
 	celix_status_t status = CELIX_SUCCESS;
 	*stream = NULL;
 
-	DIR *dir;
-	dir = opendir(locator->path);
-	if (!dir) {
-		status = CELIX_FILE_IO_EXCEPTION;
-	} else {
-		struct dirent *dp;
-		while ((dp = readdir(dir)) != NULL) {
-			char str1[256], str2[256];
-			if (sscanf(dp->d_name, "%[^.].%s", str1, str2) == 2 &&
-				strcmp(str1, id) == 0 &&
-				strcmp(str2, "zip") == 0) {
-				int length = strlen(locator->path) + strlen(dp->d_name) + 2;
-				char stream_str[length];
-				snprintf(stream_str, length, "%s/%s", locator->path, dp->d_name);
-				*stream = strdup(stream_str);
-				break;
-			}
-		}
-		closedir(dir);
+	celixThreadMutex_lock(&locator->mutex);
+	status = driverLocator_updateIndex(locator);
+	const char *file = status == CELIX_SUCCESS ? hashMap_get(locator->driverFiles, id) : NULL;
+	if (file != NULL) {
+		*stream = strdup(file);
 	}
+	celixThreadMutex_unlock(&locator->mutex);
 
 	return status;
 }
-
@@ -27,13 +27,31 @@
 #ifndef DRIVER_LOCATOR_PRIVATE_H_
 #define DRIVER_LOCATOR_PRIVATE_H_
 
+#include <time.h>
+
 #include "driver_locator.h"
+#include "hash_map.h"
+#include "celix_threads.h"
 
 struct driver_locator {
     char *path;
     array_list_pt drivers;
+
+    celix_thread_mutex_t mutex; //protects the index fields
+    bool indexed;
+    time_t indexedDirTime; //modification time of the driver dir when the index was built
+    time_t indexedTime; //time the index was built
+    hash_map_pt driversByCategory; //key = category, value = array_list_pt of driver ids (char*)
+    hash_map_pt driverFiles; //key = driver id, value = path of the driver bundle (char*)
 };
 
+/**
+ * Creates a driver locator for the driver bundles (<category>_<name>.zip) in the provided dir.
+ * The driver dir is scanned once and indexed by category; the index is rebuilt when the dir is modified.
+ */
+celix_status_t driverLocator_create(const char *path, driver_locator_pt *locator);
+celix_status_t driverLocator_destroy(driver_locator_pt locator);
+
 celix_status_t driverLocator_findDrivers(driver_locator_pt locator, properties_pt props, array_list_pt *drivers);
 celix_status_t driverLocator_loadDriver(driver_locator_pt locator, char *id, char **driver);
 
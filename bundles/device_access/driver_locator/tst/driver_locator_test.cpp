@@ -0,0 +1,136 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *  KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+#include <algorithm>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <cstdlib>
+#include <unistd.h>
+
+extern "C" {
+#include "driver_locator_private.h"
+#include "device.h"
+}
+
+#include <CppUTest/TestHarness.h>
+
+TEST_GROUP(DriverLocatorTests) {
+    char dir[32] = "driver_locator_testXXXXXX";
+    std::vector<std::string> files{};
+    driver_locator_pt locator = nullptr;
+
+    void setup() {
+        CHECK(mkdtemp(dir) != nullptr);
+        addFile("cat1_a.zip");
+        addFile("cat1_b.zip");
+        addFile("cat2_c.zip");
+        addFile("other.txt");
+        CHECK_EQUAL(CELIX_SUCCESS, driverLocator_create(dir, &locator));
+    }
+
+    void teardown() {
+        driverLocator_destroy(locator);
+        for (auto &file : files) {
+            unlink(file.c_str());
+        }
+        rmdir(dir);
+    }
+
+    void addFile(const char *name) {
+        std::string file = std::string{dir} + "/" + name;
+        std::ofstream{file} << "dummy";
+        files.push_back(file);
+    }
+
+    std::vector<std::string> findDrivers(const char *category, celix_status_t expectedStatus = CELIX_SUCCESS) {
+        properties_pt props = properties_create();
+        properties_set(props, OSGI_DEVICEACCESS_DEVICE_CATEGORY, category);
+        array_list_pt drivers = nullptr;
+        CHECK_EQUAL(expectedStatus, driverLocator_findDrivers(locator, props, &drivers));
+        properties_destroy(props);
+
+        std::vector<std::string> result{};
+        for (int i = 0; i < arrayList_size(drivers); ++i) {
+            auto *id = static_cast<char*>(arrayList_get(drivers, i));
+            result.emplace_back(id);
+            free(id);
+        }
+        arrayList_destroy(drivers);
+        std::sort(result.begin(), result.end());
+        return result;
+    }
+};
+
+TEST(DriverLocatorTests, findDriversByCategory) {
+    std::vector<std::string> cat1 = findDrivers("cat1");
+    CHECK_EQUAL(2, (int)cat1.size());
+    STRCMP_EQUAL("cat1_a", cat1[0].c_str());
+    STRCMP_EQUAL("cat1_b", cat1[1].c_str());
+
+    std::vector<std::string> cat2 = findDrivers("cat2");
+    CHECK_EQUAL(1, (int)cat2.size());
+    STRCMP_EQUAL("cat2_c", cat2[0].c_str());
+
+    CHECK(findDrivers("other").empty());
+    CHECK(findDrivers("cat3").empty());
+}
+
+TEST(DriverLocatorTests, loadDriver) {
+    char id[] = "cat1_b";
+    char *path = nullptr;
+    CHECK_EQUAL(CELIX_SUCCESS, driverLocator_loadDriver(locator, id, &path));
+    CHECK(path != nullptr);
+    STRCMP_EQUAL((std::string{dir} + "/cat1_b.zip").c_str(), path);
+    free(path);
+
+    char unknown[] = "cat1_x";
+    CHECK_EQUAL(CELIX_SUCCESS, driverLocator_loadDriver(locator, unknown, &path));
+    CHECK(path == nullptr);
+}
+
+TEST(DriverLocatorTests, indexFollowsDriverDir) {
+    CHECK_EQUAL(2, (int)findDrivers("cat1").size());
+
+    //a driver added after the dir was indexed (possibly in the same second) is found
+    addFile("cat1_d.zip");
+    std::vector<std::string> cat1 = findDrivers("cat1");
+    CHECK_EQUAL(3, (int)cat1.size());
+    STRCMP_EQUAL("cat1_d", cat1[2].c_str());
+
+    char id[] = "cat1_d";
+    char *path = nullptr;
+    CHECK_EQUAL(CELIX_SUCCESS, driverLocator_loadDriver(locator, id, &path));
+    CHECK(path != nullptr);
+    free(path);
+}
+
+TEST(DriverLocatorTests, missingDriverDir) {
+    CHECK_EQUAL(2, (int)findDrivers("cat1").size());
+    for (auto &file : files) {
+        unlink(file.c_str());
+    }
+    files.clear();
+    rmdir(dir);
+
+    CHECK(findDrivers("cat1", CELIX_FILE_IO_EXCEPTION).empty());
+    char id[] = "cat1_a";
+    char *path = nullptr;
+    CHECK_EQUAL(CELIX_FILE_IO_EXCEPTION, driverLocator_loadDriver(locator, id, &path));
+    CHECK(path == nullptr);
+}
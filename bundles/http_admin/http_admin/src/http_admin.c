@@ -32,6 +32,9 @@
 #include "http_admin.h"
 #include "http_admin/api.h"
 #include "service_tree.h"
+#include "resource_cache.h"
+#include "http_async_request.h"
+#include "http_admin_constants.h"
 
 #include "civetweb.h"
 
@@ -50,6 +53,10 @@ struct http_admin_manager {
     long infoSvcId;
     celix_array_list_t *aliasList;      //Array list of http_alias_t
     service_tree_t http_svc_tree;
+    service_tree_t async_svc_tree;      //Tree of the celix_http_async_service_t services
+
+    long asyncTimeoutMs;
+    resource_cache_t *resourceCache;    //Cache of the alias resources, thread safe
 };
 
 
@@ -65,6 +72,8 @@ static int http_request_handle(struct mg_connection *connection);
 static void httpAdmin_updateInfoSvc(http_admin_manager_t *admin);
 static void createAliasesSymlink(const char *aliases, const char *admin_root, const char *bundle_root, long bundle_id, celix_array_list_t *alias_list);
 static bool aliasList_containsAlias(celix_array_list_t *alias_list, const char *alias);
+static int httpAdmin_serveResource(http_admin_manager_t *admin, struct mg_connection *connection, const char *req_uri);
+static int httpAdmin_handleAsync(http_admin_manager_t *admin, struct mg_connection *connection, celix_http_async_service_t *asyncSvc);
 
 
 http_admin_manager_t *httpAdmin_create(celix_bundle_context_t *context, char *root, const char **svr_opts) {
@@ -80,6 +89,11 @@ http_admin_manager_t *httpAdmin_create(celix_bundle_context_t *context, char *ro
     status = celixThreadMutex_create(&admin->admin_lock, NULL);
     admin->aliasList = celix_arrayList_create();
 
+    long maxFileSize = celix_bundleContext_getPropertyAsLong(context, HTTP_ADMIN_RESOURCE_CACHE_MAX_FILE_SIZE_KEY, HTTP_ADMIN_RESOURCE_CACHE_MAX_FILE_SIZE_DFT);
+    long maxSize = celix_bundleContext_getPropertyAsLong(context, HTTP_ADMIN_RESOURCE_CACHE_MAX_SIZE_KEY, HTTP_ADMIN_RESOURCE_CACHE_MAX_SIZE_DFT);
+    admin->resourceCache = resourceCache_create(maxFileSize > 0 ? (size_t) maxFileSize : 0, maxSize > 0 ? (size_t) maxSize : 0);
+    admin->asyncTimeoutMs = celix_bundleContext_getPropertyAsLong(context, HTTP_ADMIN_ASYNC_TIMEOUT_MS_KEY, HTTP_ADMIN_ASYNC_TIMEOUT_MS_DFT);
+
     if (status == CELIX_SUCCESS) {
         //Use only begin_request callback
         memset(&callbacks, 0, sizeof(callbacks));
@@ -101,6 +115,8 @@ http_admin_manager_t *httpAdmin_create(celix_bundle_context_t *context, char *ro
             mg_stop(admin->mgCtx);
         }
         celixThreadMutex_destroy(&admin->admin_lock);
+        resourceCache_destroy(admin->resourceCache);
+        arrayList_destroy(admin->aliasList);
 
         free(admin);
         admin = NULL;
@@ -118,6 +134,7 @@ void httpAdmin_destroy(http_admin_manager_t *admin) {
     celix_bundleContext_unregisterService(admin->context, admin->infoSvcId);
 
     destroyServiceTree(&admin->http_svc_tree);
+    destroyServiceTree(&admin->async_svc_tree);
 
     //Destroy alias map by removing symbolic links first.
     unsigned int size = arrayList_size(admin->aliasList);
@@ -134,6 +151,7 @@ void httpAdmin_destroy(http_admin_manager_t *admin) {
         celix_arrayList_removeAt(admin->aliasList, i);
     }
     arrayList_destroy(admin->aliasList);
+    resourceCache_destroy(admin->resourceCache);
 
     celixThreadMutex_unlock(&(admin->admin_lock));
     celixThreadMutex_destroy(&(admin->admin_lock));
@@ -182,6 +200,37 @@ void http_admin_removeHttpService(void *handle, void *svc __attribute__((unused)
     }
 }
 
+void http_admin_addAsyncHttpService(void *handle, void *svc, const celix_properties_t *props) {
+    http_admin_manager_t *admin = (http_admin_manager_t *) handle;
+
+    const char *uri = celix_properties_get(props, HTTP_ADMIN_URI, NULL);
+
+    if(uri != NULL) {
+        celixThreadMutex_lock(&(admin->admin_lock));
+        if(!addServiceNode(&admin->async_svc_tree, uri, svc)) {
+            printf("Async HTTP service with URI %s already exists!\n", uri);
+        }
+        celixThreadMutex_unlock(&(admin->admin_lock));
+    }
+}
+
+void http_admin_removeAsyncHttpService(void *handle, void *svc __attribute__((unused)), const celix_properties_t *props) {
+    http_admin_manager_t *admin = (http_admin_manager_t *) handle;
+
+    const char *uri = celix_properties_get(props, HTTP_ADMIN_URI, NULL);
+
+    if(uri != NULL) {
+        celixThreadMutex_lock(&(admin->admin_lock));
+        service_tree_node_t *node = findServiceNodeInTree(&admin->async_svc_tree, uri);
+        if(node != NULL){
+            destroyServiceNode(&admin->async_svc_tree, node, &admin->async_svc_tree.tree_node_count, &admin->async_svc_tree.tree_svc_count);
+        } else {
+            printf("Couldn't remove async HTTP service with URI: %s, it doesn't exist\n", uri);
+        }
+        celixThreadMutex_unlock(&(admin->admin_lock));
+    }
+}
+
 int http_request_handle(struct mg_connection *connection) {
     int ret_status = 400; //Default bad request
 
@@ -196,9 +245,12 @@ int http_request_handle(struct mg_connection *connection) {
         }
         else {
             const char *req_uri = ri->request_uri;
-            node = findServiceNodeInTree(&admin->http_svc_tree, req_uri);
+            service_tree_node_t *asyncNode = findServiceNodeInTree(&admin->async_svc_tree, req_uri);
+            node = asyncNode == NULL ? findServiceNodeInTree(&admin->http_svc_tree, req_uri) : NULL;
 
-            if(node != NULL) {
+            if(asyncNode != NULL) {
+                ret_status = httpAdmin_handleAsync(admin, connection, (celix_http_async_service_t *) asyncNode->svc_data->service);
+            } else if(node != NULL) {
                 //Requested URI with node exists, now obtain the http service and call the requested function.
                 celix_http_service_t *httpSvc = (celix_http_service_t *) node->svc_data->service;
 
@@ -341,6 +393,9 @@ int http_request_handle(struct mg_connection *connection) {
                     mg_send_http_error(connection, 501, "%s", "Not found");
                     ret_status = 501; //Not implemented...
                 }
+            } else if (strcmp("GET", ri->request_method) == 0 || strcmp("HEAD", ri->request_method) == 0) {
+                //Not a service, serve (cached) alias resources. If not an alias resource let civetweb handle it
+                ret_status = httpAdmin_serveResource(admin, connection, req_uri);
             } else {
                 ret_status = 0; //Not found requested URI, let civetweb handle this situation
             }
@@ -353,6 +408,33 @@ int http_request_handle(struct mg_connection *connection) {
     return ret_status;
 }
 
+/**
+ * Reads the request body and hands the request to the async service, see httpAsyncRequest_handle.
+ */
+static int httpAdmin_handleAsync(http_admin_manager_t *admin, struct mg_connection *connection, celix_http_async_service_t *asyncSvc) {
+    const struct mg_request_info *ri = mg_get_request_info(connection);
+    int ret_status;
+    int bytes_read = 0;
+    char *rcv_buf = NULL;
+
+    if (ri->content_length > 0) {
+        int content_size = (ri->content_length > INT_MAX ? INT_MAX : (int) ri->content_length);
+        rcv_buf = malloc((size_t) content_size);
+        bytes_read = rcv_buf != NULL ? mg_read(connection, rcv_buf, (size_t) content_size) : 0;
+    }
+
+    if (ri->content_length > 0 && bytes_read <= 0) {
+        mg_send_http_error(connection, 400, "%s", "Bad request");
+        ret_status = 400; //Bad Request, failed to read data
+    } else {
+        ret_status = httpAsyncRequest_handle(connection, asyncSvc, ri->request_method, ri->request_uri, rcv_buf,
+                                             (size_t) bytes_read, admin->asyncTimeoutMs);
+    }
+
+    free(rcv_buf);
+    return ret_status;
+}
+
 static void httpAdmin_updateInfoSvc(http_admin_manager_t *admin) {
     const char *ports = mg_get_option(admin->mgCtx, "listening_ports");
 
@@ -474,6 +556,39 @@ static bool aliasList_containsAlias(celix_array_list_t *alias_list, const char *
     return false;
 }
 
+/**
+ * Serves the requested URI from the resource cache if it is part of an alias.
+ *
+ * @return The HTTP status code or 0 if the URI should be handled by civetweb.
+ */
+static int httpAdmin_serveResource(http_admin_manager_t *admin, struct mg_connection *connection, const char *req_uri) {
+    char *path = NULL;
+    long bundle_id = -1L;
+
+    if(strstr(req_uri, "..") != NULL) {
+        return 0; //Let civetweb handle (and refuse) paths outside the document root
+    }
+
+    celixThreadMutex_lock(&admin->admin_lock);
+    unsigned int size = arrayList_size(admin->aliasList);
+    for(unsigned int i = 0; i < size && path == NULL; i++) {
+        http_alias_t *alias = arrayList_get(admin->aliasList, i);
+        size_t len = strlen(alias->url);
+        if(strncmp(alias->url, req_uri, len) == 0 && (req_uri[len] == '/' || req_uri[len] == '\0')) {
+            asprintf(&path, "%s%s", alias->alias_path, req_uri + len);
+            bundle_id = alias->bundle_id;
+        }
+    }
+    celixThreadMutex_unlock(&admin->admin_lock);
+
+    int ret_status = 0;
+    if(path != NULL) {
+        ret_status = resourceCache_handle(admin->resourceCache, connection, req_uri, path, bundle_id);
+        free(path);
+    }
+    return ret_status;
+}
+
 void http_admin_startBundle(void *data, const celix_bundle_t *bundle) {
     bundle_archive_pt archive = NULL;
     bundle_revision_pt revision = NULL;
@@ -500,7 +615,11 @@ void http_admin_startBundle(void *data, const celix_bundle_t *bundle) {
         aliases = manifest_getValue(manifest, "X-Web-Resource");
         bnd_id = celix_bundle_getId(bundle);
         bundleRevision_getRoot(revision, &revision_root);
+        //A (re)started bundle can have new resources
+        resourceCache_invalidate(admin->resourceCache, bnd_id);
+        celixThreadMutex_lock(&admin->admin_lock);
         createAliasesSymlink(aliases, admin->root, revision_root, bnd_id, admin->aliasList);
+        celixThreadMutex_unlock(&admin->admin_lock);
     }
     httpAdmin_updateInfoSvc(admin);
 }
@@ -510,6 +629,7 @@ void http_admin_stopBundle(void *data, const celix_bundle_t *bundle) {
     long bundle_id = celix_bundle_getId(bundle);
 
     //Remove all aliases which are connected to this bundle
+    celixThreadMutex_lock(&admin->admin_lock);
     unsigned int size = arrayList_size(admin->aliasList);
     for (unsigned int i = (size - 1); i < size; i--) {
         http_alias_t *alias = arrayList_get(admin->aliasList, i);
@@ -520,6 +640,8 @@ void http_admin_stopBundle(void *data, const celix_bundle_t *bundle) {
             celix_arrayList_removeAt(admin->aliasList, i);
         }
     }
+    celixThreadMutex_unlock(&admin->admin_lock);
+    resourceCache_invalidate(admin->resourceCache, bundle_id);
     httpAdmin_updateInfoSvc(admin);
 }
 
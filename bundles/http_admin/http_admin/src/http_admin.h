@@ -41,6 +41,9 @@ struct mg_context *httpAdmin_getServerContext(const http_admin_manager_t *admin)
 void http_admin_addHttpService(void *handle, void *svc, const celix_properties_t *props);
 void http_admin_removeHttpService(void *handle, void *svc, const celix_properties_t *props);
 
+void http_admin_addAsyncHttpService(void *handle, void *svc, const celix_properties_t *props);
+void http_admin_removeAsyncHttpService(void *handle, void *svc, const celix_properties_t *props);
+
 void http_admin_startBundle(void *data, const celix_bundle_t *bundle);
 void http_admin_stopBundle(void *data, const celix_bundle_t *bundle);
 
@@ -39,5 +39,25 @@
 #define HTTP_ADMIN_NUM_THREADS_KEY              "CELIX_HTTP_ADMIN_NUM_THREADS"
 #define HTTP_ADMIN_NUM_THREADS_DFT              1L
 
+//Max size of a single cached alias resource in bytes, 0 disables the resource cache
+#define HTTP_ADMIN_RESOURCE_CACHE_MAX_FILE_SIZE_KEY "CELIX_HTTP_ADMIN_RESOURCE_CACHE_MAX_FILE_SIZE"
+#define HTTP_ADMIN_RESOURCE_CACHE_MAX_FILE_SIZE_DFT 1048576L
+
+//Max total size of the cached alias resources (uncompressed and compressed) in bytes
+#define HTTP_ADMIN_RESOURCE_CACHE_MAX_SIZE_KEY  "CELIX_HTTP_ADMIN_RESOURCE_CACHE_MAX_SIZE"
+#define HTTP_ADMIN_RESOURCE_CACHE_MAX_SIZE_DFT  33554432L
+
+//Max nr of queued broadcast messages per websocket connection, newer messages are dropped for a connection with a full backlog
+#define HTTP_ADMIN_WEBSOCKET_BROADCAST_BACKLOG_KEY  "CELIX_HTTP_ADMIN_WEBSOCKET_BROADCAST_BACKLOG"
+#define HTTP_ADMIN_WEBSOCKET_BROADCAST_BACKLOG_DFT  64L
+
+//Nr of threads writing broadcast messages, a slow connection blocks at most one writer
+#define HTTP_ADMIN_WEBSOCKET_BROADCAST_WRITERS_KEY  "CELIX_HTTP_ADMIN_WEBSOCKET_BROADCAST_WRITERS"
+#define HTTP_ADMIN_WEBSOCKET_BROADCAST_WRITERS_DFT  2L
+
+//Max time a request of an async http service may take, after that the http admin responds with 504
+#define HTTP_ADMIN_ASYNC_TIMEOUT_MS_KEY         "CELIX_HTTP_ADMIN_ASYNC_TIMEOUT_MS"
+#define HTTP_ADMIN_ASYNC_TIMEOUT_MS_DFT         30000L
+
 
 #endif //CELIX_HTTP_ADMIN_CONSTANTS_H
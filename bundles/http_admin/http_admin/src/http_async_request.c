@@ -0,0 +1,170 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *  KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+#include <time.h>
+
+#include "http_async_request.h"
+#include "celix_threads.h"
+
+typedef struct http_async_request {
+    celix_http_async_response_t response; //handed to the service, handle is the request
+    struct mg_connection *connection;
+
+    celix_thread_mutex_t mutex;           //protects below, held while writing to the connection
+    celix_thread_cond_t cond;
+    int refCount;                         //the worker thread and the service
+    int status;                           //0 until a response is started
+    bool chunked;
+    bool completed;
+    bool abandoned;                       //timed out or failed, the connection is no longer usable by the service
+} http_async_request_t;
+
+static void httpAsyncRequest_release(http_async_request_t *request) {
+    celixThreadMutex_lock(&request->mutex);
+    bool last = --request->refCount == 0;
+    celixThreadMutex_unlock(&request->mutex);
+    if (last) {
+        celixThreadCondition_destroy(&request->cond);
+        celixThreadMutex_destroy(&request->mutex);
+        free(request);
+    }
+}
+
+static const char* httpAsyncRequest_getHeader(void *handle, const char *name) {
+    http_async_request_t *request = handle;
+    celixThreadMutex_lock(&request->mutex);
+    const char *value = request->abandoned ? NULL : mg_get_header(request->connection, name);
+    celixThreadMutex_unlock(&request->mutex);
+    return value;
+}
+
+static int httpAsyncRequest_send(void *handle, int status, const char *contentType, const char *body, size_t length) {
+    http_async_request_t *request = handle;
+    int rc = -1;
+    celixThreadMutex_lock(&request->mutex);
+    if (!request->abandoned && request->status == 0) {
+        request->status = status;
+        mg_printf(request->connection, "HTTP/1.1 %d %s\r\nContent-Type: %s\r\nContent-Length: %zu\r\n\r\n",
+                  status, mg_get_response_code_text(request->connection, status), contentType, length);
+        rc = length == 0 || mg_write(request->connection, body, length) == (int) length ? 0 : -1;
+        request->abandoned = rc != 0;
+    }
+    celixThreadMutex_unlock(&request->mutex);
+    return rc;
+}
+
+static int httpAsyncRequest_startChunked(void *handle, int status, const char *contentType) {
+    http_async_request_t *request = handle;
+    int rc = -1;
+    celixThreadMutex_lock(&request->mutex);
+    if (!request->abandoned && request->status == 0) {
+        request->status = status;
+        request->chunked = true;
+        rc = mg_printf(request->connection, "HTTP/1.1 %d %s\r\nContent-Type: %s\r\nTransfer-Encoding: chunked\r\n\r\n",
+                       status, mg_get_response_code_text(request->connection, status), contentType) > 0 ? 0 : -1;
+        request->abandoned = rc != 0;
+    }
+    celixThreadMutex_unlock(&request->mutex);
+    return rc;
+}
+
+static int httpAsyncRequest_sendChunk(void *handle, const char *data, size_t length) {
+    http_async_request_t *request = handle;
+    int rc = -1;
+    celixThreadMutex_lock(&request->mutex);
+    if (!request->abandoned && request->chunked) {
+        //an empty chunk would end the body
+        rc = length == 0 || mg_send_chunk(request->connection, data, (unsigned int) length) > 0 ? 0 : -1;
+        request->abandoned = rc != 0;
+    }
+    celixThreadMutex_unlock(&request->mutex);
+    return rc;
+}
+
+static void httpAsyncRequest_complete(void *handle) {
+    http_async_request_t *request = handle;
+    celixThreadMutex_lock(&request->mutex);
+    if (!request->abandoned) {
+        if (request->chunked) {
+            mg_send_chunk(request->connection, "", 0);
+        } else if (request->status == 0) {
+            request->status = 500;
+            mg_send_http_error(request->connection, 500, "%s", "No response");
+        }
+    }
+    request->completed = true;
+    celixThreadCondition_broadcast(&request->cond);
+    celixThreadMutex_unlock(&request->mutex);
+    httpAsyncRequest_release(request);
+}
+
+int httpAsyncRequest_handle(struct mg_connection *connection, celix_http_async_service_t *svc, const char *method,
+                            const char *uri, const char *data, size_t length, long timeoutInMs) {
+    http_async_request_t *request = calloc(1, sizeof(*request));
+    if (request == NULL) {
+        mg_send_http_error(connection, 503, "%s", "Service unavailable");
+        return 503;
+    }
+    request->connection = connection;
+    request->refCount = 2;
+    celixThreadMutex_create(&request->mutex, NULL);
+    celixThreadCondition_init(&request->cond, NULL);
+    request->response.handle = request;
+    request->response.getHeader = httpAsyncRequest_getHeader;
+    request->response.send = httpAsyncRequest_send;
+    request->response.startChunked = httpAsyncRequest_startChunked;
+    request->response.sendChunk = httpAsyncRequest_sendChunk;
+    request->response.complete = httpAsyncRequest_complete;
+
+    svc->handleRequest(svc->handle, method, uri, data, length, &request->response);
+
+    struct timespec deadline;
+    clock_gettime(CLOCK_MONOTONIC, &deadline);
+    deadline.tv_sec += timeoutInMs / 1000;
+    deadline.tv_nsec += (timeoutInMs % 1000) * 1000000L;
+    if (deadline.tv_nsec >= 1000000000L) {
+        deadline.tv_sec += 1;
+        deadline.tv_nsec -= 1000000000L;
+    }
+
+    celixThreadMutex_lock(&request->mutex);
+    while (!request->completed) {
+        struct timespec now;
+        clock_gettime(CLOCK_MONOTONIC, &now);
+        long remainingInNs = (deadline.tv_sec - now.tv_sec) * 1000000000L + (deadline.tv_nsec - now.tv_nsec);
+        if (remainingInNs <= 0) {
+            break;
+        }
+        celixThreadCondition_timedwaitRelative(&request->cond, &request->mutex, remainingInNs / 1000000000L, remainingInNs % 1000000000L);
+    }
+    if (!request->completed && !request->abandoned && request->status == 0) {
+        request->status = 504;
+        mg_send_http_error(connection, 504, "%s", "Gateway timeout");
+    }
+    //after return civetweb reuses or closes the connection
+    request->abandoned = true;
+    int status = request->status;
+    celixThreadMutex_unlock(&request->mutex);
+    httpAsyncRequest_release(request);
+
+    return status;
+}
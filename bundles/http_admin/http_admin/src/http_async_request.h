@@ -0,0 +1,40 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *  KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#ifndef CELIX_HTTP_ASYNC_REQUEST_H
+#define CELIX_HTTP_ASYNC_REQUEST_H
+
+#include <stddef.h>
+
+#include "civetweb.h"
+#include "http_admin/http_admin_async_service.h"
+
+/**
+ * Handles a request with an async http service, see celix_http_async_service_t.
+ * civetweb cannot release a connection before the request handler returns, so the calling worker thread waits
+ * (without doing any work) until the service completes the response or the timeout expires. The response can be
+ * written from any thread meanwhile, it is written to the connection directly. On timeout, 504 is sent if nothing is
+ * sent yet, later calls of the service on the response fail.
+ *
+ * Returns the HTTP status code of the response.
+ */
+int httpAsyncRequest_handle(struct mg_connection *connection, celix_http_async_service_t *svc, const char *method,
+                            const char *uri, const char *data, size_t length, long timeoutInMs);
+
+#endif //CELIX_HTTP_ASYNC_REQUEST_H
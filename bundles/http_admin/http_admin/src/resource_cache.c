@@ -0,0 +1,277 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *  KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <zlib.h>
+
+#include "resource_cache.h"
+#include "hash_map.h"
+#include "utils.h"
+#include "celix_threads.h"
+
+#define RESOURCE_CACHE_MIN_COMPRESS_SIZE    256
+
+typedef struct resource_cache_entry {
+    char *uri;
+    long bundleId;
+    int refCount;                       //protected by the cache mutex, the map holds a reference while cached
+
+    void *data;                         //mmapped file content
+    size_t size;
+    void *gzData;                       //gzip compressed content, NULL if not compressible
+    size_t gzSize;
+    time_t modified;
+    const char *mimeType;
+    char etag[64];
+    char lastModified[64];
+} resource_cache_entry_t;
+
+struct resource_cache {
+    size_t maxFileSize;
+    size_t maxTotalSize;
+
+    celix_thread_mutex_t mutex; //protects below
+    hash_map_t *entries;        //key = uri, value = resource_cache_entry_t*
+    size_t totalSize;
+};
+
+static resource_cache_entry_t *resourceCache_load(resource_cache_t *cache, const char *uri, const char *path, long bundleId);
+static void resourceCache_release(resource_cache_t *cache, resource_cache_entry_t *entry);
+static void resourceCache_freeEntry(resource_cache_entry_t *entry);
+static bool resourceCache_isCompressible(const char *mimeType);
+static void *resourceCache_gzip(const void *data, size_t size, size_t *gzSize);
+static bool resourceCache_isNotModified(struct mg_connection *connection, const resource_cache_entry_t *entry);
+
+resource_cache_t *resourceCache_create(size_t maxFileSize, size_t maxTotalSize) {
+    resource_cache_t *cache = calloc(1, sizeof(*cache));
+    cache->maxFileSize = maxFileSize;
+    cache->maxTotalSize = maxTotalSize;
+    celixThreadMutex_create(&cache->mutex, NULL);
+    cache->entries = hashMap_create(utils_stringHash, NULL, utils_stringEquals, NULL);
+    return cache;
+}
+
+void resourceCache_destroy(resource_cache_t *cache) {
+    if (cache != NULL) {
+        hash_map_iterator_t iter = hashMapIterator_construct(cache->entries);
+        while (hashMapIterator_hasNext(&iter)) {
+            resource_cache_entry_t *entry = hashMapIterator_nextValue(&iter);
+            resourceCache_freeEntry(entry);
+        }
+        hashMap_destroy(cache->entries, false, false);
+        celixThreadMutex_destroy(&cache->mutex);
+        free(cache);
+    }
+}
+
+int resourceCache_handle(resource_cache_t *cache, struct mg_connection *connection, const char *uri, const char *path, long bundleId) {
+    if (cache == NULL || cache->maxFileSize == 0) {
+        return 0;
+    }
+
+    celixThreadMutex_lock(&cache->mutex);
+    resource_cache_entry_t *entry = hashMap_get(cache->entries, uri);
+    if (entry != NULL) {
+        entry->refCount += 1;
+    }
+    celixThreadMutex_unlock(&cache->mutex);
+
+    if (entry == NULL) {
+        //Load outside the lock, another thread can load the same file concurrently
+        entry = resourceCache_load(cache, uri, path, bundleId);
+        if (entry == NULL) {
+            return 0;
+        }
+        celixThreadMutex_lock(&cache->mutex);
+        resource_cache_entry_t *existing = hashMap_get(cache->entries, uri);
+        if (existing != NULL) {
+            resourceCache_freeEntry(entry);
+            entry = existing;
+            entry->refCount += 1;
+        } else if (cache->totalSize + entry->size + entry->gzSize <= cache->maxTotalSize) {
+            hashMap_put(cache->entries, entry->uri, entry);
+            cache->totalSize += entry->size + entry->gzSize;
+            entry->refCount = 2;
+        } else {
+            entry->refCount = 1; //cache is full, only used for this request
+        }
+        celixThreadMutex_unlock(&cache->mutex);
+    }
+
+    int status;
+    const struct mg_request_info *ri = mg_get_request_info(connection);
+    if (resourceCache_isNotModified(connection, entry)) {
+        status = 304;
+        mg_printf(connection, "HTTP/1.1 304 Not Modified\r\nETag: %s\r\nLast-Modified: %s\r\n\r\n",
+                  entry->etag, entry->lastModified);
+    } else {
+        const char *acceptEncoding = mg_get_header(connection, "Accept-Encoding");
+        bool gzip = entry->gzData != NULL && acceptEncoding != NULL && strstr(acceptEncoding, "gzip") != NULL;
+        const void *body = gzip ? entry->gzData : entry->data;
+        size_t bodySize = gzip ? entry->gzSize : entry->size;
+        status = 200;
+        mg_printf(connection, "HTTP/1.1 200 OK\r\nContent-Type: %s\r\nContent-Length: %zu\r\nETag: %s\r\n"
+                              "Last-Modified: %s\r\nVary: Accept-Encoding\r\n%s\r\n",
+                  entry->mimeType, bodySize, entry->etag, entry->lastModified,
+                  gzip ? "Content-Encoding: gzip\r\n" : "");
+        if (strcmp("HEAD", ri->request_method) != 0 && bodySize > 0) {
+            mg_write(connection, body, bodySize);
+        }
+    }
+
+    resourceCache_release(cache, entry);
+    return status;
+}
+
+void resourceCache_invalidate(resource_cache_t *cache, long bundleId) {
+    if (cache == NULL) {
+        return;
+    }
+    celixThreadMutex_lock(&cache->mutex);
+    hash_map_iterator_t iter = hashMapIterator_construct(cache->entries);
+    while (hashMapIterator_hasNext(&iter)) {
+        resource_cache_entry_t *entry = hashMapIterator_nextValue(&iter);
+        if (entry->bundleId == bundleId) {
+            hashMapIterator_remove(&iter);
+            cache->totalSize -= entry->size + entry->gzSize;
+            if (--entry->refCount == 0) {
+                resourceCache_freeEntry(entry);
+            }
+        }
+    }
+    celixThreadMutex_unlock(&cache->mutex);
+}
+
+static resource_cache_entry_t *resourceCache_load(resource_cache_t *cache, const char *uri, const char *path, long bundleId) {
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        return NULL;
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0 || !S_ISREG(st.st_mode) || (size_t) st.st_size > cache->maxFileSize) {
+        close(fd);
+        return NULL;
+    }
+
+    void *data = NULL;
+    if (st.st_size > 0) {
+        data = mmap(NULL, (size_t) st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (data == MAP_FAILED) {
+            close(fd);
+            return NULL;
+        }
+    }
+    close(fd);
+
+    resource_cache_entry_t *entry = calloc(1, sizeof(*entry));
+    entry->uri = strdup(uri);
+    entry->bundleId = bundleId;
+    entry->data = data;
+    entry->size = (size_t) st.st_size;
+    entry->modified = st.st_mtime;
+    entry->mimeType = mg_get_builtin_mime_type(path);
+    snprintf(entry->etag, sizeof(entry->etag), "\"%lx.%zx\"", (unsigned long) st.st_mtime, entry->size);
+    struct tm tm;
+    gmtime_r(&st.st_mtime, &tm);
+    strftime(entry->lastModified, sizeof(entry->lastModified), "%a, %d %b %Y %H:%M:%S GMT", &tm);
+
+    if (entry->size >= RESOURCE_CACHE_MIN_COMPRESS_SIZE && resourceCache_isCompressible(entry->mimeType)) {
+        entry->gzData = resourceCache_gzip(entry->data, entry->size, &entry->gzSize);
+        if (entry->gzData != NULL && entry->gzSize >= entry->size) {
+            //Not worth it
+            free(entry->gzData);
+            entry->gzData = NULL;
+            entry->gzSize = 0;
+        }
+    }
+    return entry;
+}
+
+static void resourceCache_release(resource_cache_t *cache, resource_cache_entry_t *entry) {
+    celixThreadMutex_lock(&cache->mutex);
+    bool last = --entry->refCount == 0;
+    celixThreadMutex_unlock(&cache->mutex);
+    if (last) {
+        resourceCache_freeEntry(entry);
+    }
+}
+
+static void resourceCache_freeEntry(resource_cache_entry_t *entry) {
+    if (entry->data != NULL) {
+        munmap(entry->data, entry->size);
+    }
+    free(entry->gzData);
+    free(entry->uri);
+    free(entry);
+}
+
+static bool resourceCache_isCompressible(const char *mimeType) {
+    return strncmp(mimeType, "text/", 5) == 0 ||
+           strcmp(mimeType, "application/javascript") == 0 ||
+           strcmp(mimeType, "application/json") == 0 ||
+           strcmp(mimeType, "application/xml") == 0 ||
+           strcmp(mimeType, "image/svg+xml") == 0;
+}
+
+static void *resourceCache_gzip(const void *data, size_t size, size_t *gzSize) {
+    z_stream stream;
+    memset(&stream, 0, sizeof(stream));
+    //15 + 16 = max window size with a gzip header and trailer
+    if (deflateInit2(&stream, Z_BEST_COMPRESSION, Z_DEFLATED, 15 + 16, 8, Z_DEFAULT_STRATEGY) != Z_OK) {
+        return NULL;
+    }
+    size_t bound = deflateBound(&stream, (uLong) size);
+    unsigned char *out = malloc(bound);
+    stream.next_in = (Bytef *) data;
+    stream.avail_in = (uInt) size;
+    stream.next_out = out;
+    stream.avail_out = (uInt) bound;
+    int rc = deflate(&stream, Z_FINISH);
+    *gzSize = stream.total_out;
+    deflateEnd(&stream);
+    if (rc != Z_STREAM_END) {
+        free(out);
+        return NULL;
+    }
+    return out;
+}
+
+static bool resourceCache_isNotModified(struct mg_connection *connection, const resource_cache_entry_t *entry) {
+    //If-None-Match takes precedence over If-Modified-Since (RFC 7232)
+    const char *ifNoneMatch = mg_get_header(connection, "If-None-Match");
+    if (ifNoneMatch != NULL) {
+        return strcmp(ifNoneMatch, "*") == 0 || strstr(ifNoneMatch, entry->etag) != NULL;
+    }
+    const char *ifModifiedSince = mg_get_header(connection, "If-Modified-Since");
+    if (ifModifiedSince != NULL) {
+        struct tm tm;
+        memset(&tm, 0, sizeof(tm));
+        if (strptime(ifModifiedSince, "%a, %d %b %Y %H:%M:%S GMT", &tm) != NULL) {
+            return entry->modified <= timegm(&tm);
+        }
+    }
+    return false;
+}
@@ -0,0 +1,55 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *  KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#ifndef CELIX_HTTP_ADMIN_RESOURCE_CACHE_H
+#define CELIX_HTTP_ADMIN_RESOURCE_CACHE_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "civetweb.h"
+
+/**
+ * In-memory cache of the static (bundle) resources served by the http admin.
+ * Files are mapped in memory and, if this makes them smaller, also kept gzip compressed. Cached resources are served
+ * with an ETag and Last-Modified header and conditional requests (If-None-Match / If-Modified-Since) are answered
+ * with a 304 Not Modified.
+ */
+typedef struct resource_cache resource_cache_t;
+
+/**
+ * Creates a resource cache which caches files up to maxFileSize bytes until maxTotalSize bytes are cached.
+ */
+resource_cache_t *resourceCache_create(size_t maxFileSize, size_t maxTotalSize);
+void resourceCache_destroy(resource_cache_t *cache);
+
+/**
+ * Serves a GET or HEAD request for the file at path (requested as uri) from the cache, loading the file in the cache
+ * if needed. The entry is connected to the provided bundle, so it can be invalidated when the bundle stops.
+ *
+ * @return The HTTP status code of the response, or 0 if the file cannot be cached and should be served by civetweb.
+ */
+int resourceCache_handle(resource_cache_t *cache, struct mg_connection *connection, const char *uri, const char *path, long bundleId);
+
+/**
+ * Removes all cached entries of the provided bundle.
+ */
+void resourceCache_invalidate(resource_cache_t *cache, long bundleId);
+
+#endif //CELIX_HTTP_ADMIN_RESOURCE_CACHE_H
@@ -27,34 +27,61 @@
 #ifndef SERVICE_TREE_H
 #define SERVICE_TREE_H
 
+#include <stdbool.h>
+#include <stddef.h>
+
+/**
+ * The service tree is a compressed radix tree of the (normalized) URIs of the registered services.
+ * A URI is normalized by collapsing repeated slashes, removing a trailing slash and adding a leading slash, so that
+ * "/", "foo/bar/" and "/foo//bar" are stored as "", "/foo/bar" and "/foo/bar".
+ * Every node holds the part of the URI (sub_uri) which is not shared with its siblings. The children of a node are
+ * sorted on the first character of their sub_uri, so a lookup costs O(URI length) independent of the number of
+ * registered services.
+ */
+
 //Type declarations
 typedef struct service_tree_node service_tree_node_t;
 
 typedef struct service_node_data {
-    char *sub_uri;
-    void *service;
+    char *sub_uri;                  //Part of the URI matched by this node, "" for the root node
+    void *service;                  //Service registered for the URI of this node, can be NULL
 } service_node_data_t;
 
 
 struct service_tree_node {
     service_node_data_t *svc_data;
-    service_tree_node_t *next;
-    service_tree_node_t *prev;
     service_tree_node_t *parent;
-    service_tree_node_t *children;
+    service_tree_node_t **children; //Sorted on the first character of the sub_uri of the children
+    size_t children_count;
+    size_t children_cap;
 };
 
 typedef struct service_tree {
     int tree_svc_count;             //Count for number of services in the tree (not number of nodes)
     int tree_node_count;            //Count for number of nodes (tree_node_count != tree_svc_count)
-    service_tree_node_t *root_node; //Pointer to first item
+    service_tree_node_t *root_node; //Pointer to the root ("/") node
 } service_tree_t;
 
 //Global function prototypes
+
+/**
+ * Adds a service for the provided URI. Returns false if a service is already registered for the (normalized) URI.
+ */
 bool addServiceNode(service_tree_t *svc_tree, const char *uri, void *svc);
+/**
+ * Destroys all children (and their services) of the provided node.
+ */
 void destroyChildrenFromServiceNode(service_tree_node_t *parent, int *tree_item_count, int *tree_svc_count);
+/**
+ * Removes the service of the provided node. The node is destroyed (and the tree compacted) if it is no longer needed.
+ */
 void destroyServiceNode(service_tree_t *svc_tree, service_tree_node_t *node, int *tree_item_count, int *tree_svc_count);
 void destroyServiceTree(service_tree_t *svc_tree);
+
+/**
+ * Finds the node with the longest URI which is a prefix (on a path segment boundary) of the provided URI and has a
+ * service, as required by the OSGi Http Whiteboard specification. The URI is matched as is, without allocations.
+ */
 service_tree_node_t *findServiceNodeInTree(service_tree_t *svc_tree, const char *uri);
 
 #endif //SERVICE_TREE_H
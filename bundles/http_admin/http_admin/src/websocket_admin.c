@@ -31,6 +31,8 @@
 #include "http_admin/api.h"
 #include "http_admin.h"
 #include "service_tree.h"
+#include "websocket_broadcaster.h"
+#include "http_admin_constants.h"
 
 #include "civetweb.h"
 
@@ -47,6 +49,9 @@ struct websocket_admin_manager {
     service_tree_t sock_svc_tree;
     celix_thread_mutex_t admin_lock;
 
+    websocket_broadcaster_t *broadcaster;
+    celix_websocket_broadcast_service_t broadcastSvc;
+    long broadcastSvcId;
 };
 
 websocket_admin_manager_t *websocketAdmin_create(celix_bundle_context_t *context, struct mg_context *svr_ctx) {
@@ -65,12 +70,25 @@ websocket_admin_manager_t *websocketAdmin_create(celix_bundle_context_t *context
     if(status != CELIX_SUCCESS) {
         //No need to destroy other things
         free(admin);
+        return NULL;
     }
 
+    long backlog = celix_bundleContext_getPropertyAsLong(context, HTTP_ADMIN_WEBSOCKET_BROADCAST_BACKLOG_KEY, HTTP_ADMIN_WEBSOCKET_BROADCAST_BACKLOG_DFT);
+    long writers = celix_bundleContext_getPropertyAsLong(context, HTTP_ADMIN_WEBSOCKET_BROADCAST_WRITERS_KEY, HTTP_ADMIN_WEBSOCKET_BROADCAST_WRITERS_DFT);
+    admin->broadcaster = websocketBroadcaster_create(backlog > 0 ? (size_t) backlog : 1, writers > 0 ? (int) writers : 1);
+    admin->broadcastSvc.handle = admin->broadcaster;
+    admin->broadcastSvc.join = websocketBroadcaster_join;
+    admin->broadcastSvc.leave = websocketBroadcaster_leave;
+    admin->broadcastSvc.broadcast = websocketBroadcaster_broadcast;
+    admin->broadcastSvcId = celix_bundleContext_registerService(context, &admin->broadcastSvc, WEBSOCKET_BROADCAST_SERVICE_NAME, NULL);
+
     return admin;
 }
 
 void websocketAdmin_destroy(websocket_admin_manager_t *admin) {
+    celix_bundleContext_unregisterService(admin->context, admin->broadcastSvcId);
+    websocketBroadcaster_destroy(admin->broadcaster);
+
     celixThreadMutex_lock(&(admin->admin_lock));
 
     //Destroy tree with services
@@ -212,5 +230,8 @@ void websocket_close_handler(const struct mg_connection *connection, void *handl
                 sockSvc->close(connection, sockSvc->handle);
             }
         }
+
+        //The connection is freed after this handler, so it must leave all broadcast groups
+        websocketBroadcaster_removeConnection(admin->broadcaster, connection);
     }
 }
@@ -0,0 +1,382 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *  KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+#include <arpa/inet.h>
+
+#include "websocket_broadcaster.h"
+#include "celix_threads.h"
+#include "celix_array_list.h"
+#include "hash_map.h"
+#include "utils.h"
+
+#define WEBSOCKET_MAX_FRAME_HEADER_SIZE 10
+
+typedef struct websocket_message {
+    int refCount;                   //protected by the broadcaster mutex
+    size_t size;
+    unsigned char frame[];          //header + payload
+} websocket_message_t;
+
+typedef struct websocket_connection {
+    struct mg_connection *connection;
+    websocket_message_t **backlog;  //ring buffer of capacity (maxBacklog) entries
+    size_t capacity;
+    size_t head;
+    size_t count;
+    unsigned long dropped;
+    int nrOfGroups;
+    bool ready;                     //in the ready list of the writer
+    bool writing;                   //writer thread is writing to the connection
+    bool failed;                    //a write failed, the connection will be closed by civetweb
+    struct websocket_connection *nextReady;
+} websocket_connection_t;
+
+struct websocket_broadcaster {
+    size_t maxBacklog;
+    int nrOfWriters;
+    celix_thread_t *writerThreads;
+
+    celix_thread_mutex_t mutex;     //protects below
+    celix_thread_cond_t cond;
+    bool running;
+    hash_map_t *groups;             //key = group name, value = celix_array_list_t* of websocket_connection_t*
+    hash_map_t *connections;        //key = struct mg_connection*, value = websocket_connection_t*
+    websocket_connection_t *readyHead;
+    websocket_connection_t *readyTail;
+};
+
+static void *websocketBroadcaster_writerThread(void *data);
+static websocket_message_t *websocketBroadcaster_frame(int op_code, const char *data, size_t length);
+static void websocketBroadcaster_releaseMessage(websocket_message_t *msg);
+static void websocketBroadcaster_pushReady(websocket_broadcaster_t *broadcaster, websocket_connection_t *conn);
+static void websocketBroadcaster_clearBacklog(websocket_connection_t *conn);
+
+websocket_broadcaster_t *websocketBroadcaster_create(size_t maxBacklog, int nrOfWriters) {
+    websocket_broadcaster_t *broadcaster = calloc(1, sizeof(*broadcaster));
+    broadcaster->maxBacklog = maxBacklog > 0 ? maxBacklog : 1;
+    broadcaster->nrOfWriters = nrOfWriters > 0 ? nrOfWriters : 1;
+    celixThreadMutex_create(&broadcaster->mutex, NULL);
+    celixThreadCondition_init(&broadcaster->cond, NULL);
+    broadcaster->groups = hashMap_create(utils_stringHash, NULL, utils_stringEquals, NULL);
+    broadcaster->connections = hashMap_create(NULL, NULL, NULL, NULL);
+    broadcaster->running = true;
+    broadcaster->writerThreads = calloc(broadcaster->nrOfWriters, sizeof(celix_thread_t));
+    for (int i = 0; i < broadcaster->nrOfWriters; ++i) {
+        celixThread_create(&broadcaster->writerThreads[i], NULL, websocketBroadcaster_writerThread, broadcaster);
+        celixThread_setName(&broadcaster->writerThreads[i], "WebsocketWriter");
+    }
+    return broadcaster;
+}
+
+void websocketBroadcaster_destroy(websocket_broadcaster_t *broadcaster) {
+    if (broadcaster == NULL) {
+        return;
+    }
+    celixThreadMutex_lock(&broadcaster->mutex);
+    broadcaster->running = false;
+    celixThreadCondition_broadcast(&broadcaster->cond);
+    celixThreadMutex_unlock(&broadcaster->mutex);
+    for (int i = 0; i < broadcaster->nrOfWriters; ++i) {
+        celixThread_join(broadcaster->writerThreads[i], NULL);
+    }
+    free(broadcaster->writerThreads);
+
+    hash_map_iterator_t iter = hashMapIterator_construct(broadcaster->groups);
+    while (hashMapIterator_hasNext(&iter)) {
+        hash_map_entry_t *entry = hashMapIterator_nextEntry(&iter);
+        free(hashMapEntry_getKey(entry));
+        celix_arrayList_destroy(hashMapEntry_getValue(entry));
+    }
+    hashMap_destroy(broadcaster->groups, false, false);
+
+    iter = hashMapIterator_construct(broadcaster->connections);
+    while (hashMapIterator_hasNext(&iter)) {
+        websocket_connection_t *conn = hashMapIterator_nextValue(&iter);
+        websocketBroadcaster_clearBacklog(conn);
+        free(conn->backlog);
+        free(conn);
+    }
+    hashMap_destroy(broadcaster->connections, false, false);
+
+    celixThreadCondition_destroy(&broadcaster->cond);
+    celixThreadMutex_destroy(&broadcaster->mutex);
+    free(broadcaster);
+}
+
+int websocketBroadcaster_join(void *handle, const char *group, struct mg_connection *connection) {
+    websocket_broadcaster_t *broadcaster = handle;
+    if (group == NULL || connection == NULL) {
+        return 1;
+    }
+
+    celixThreadMutex_lock(&broadcaster->mutex);
+    websocket_connection_t *conn = hashMap_get(broadcaster->connections, connection);
+    if (conn == NULL) {
+        conn = calloc(1, sizeof(*conn));
+        conn->connection = connection;
+        conn->capacity = broadcaster->maxBacklog;
+        conn->backlog = calloc(conn->capacity, sizeof(websocket_message_t *));
+        hashMap_put(broadcaster->connections, connection, conn);
+    }
+    celix_array_list_t *members = hashMap_get(broadcaster->groups, group);
+    if (members == NULL) {
+        members = celix_arrayList_create();
+        hashMap_put(broadcaster->groups, strdup(group), members);
+    }
+    bool member = false;
+    for (int i = 0; i < celix_arrayList_size(members) && !member; ++i) {
+        member = celix_arrayList_get(members, i) == conn;
+    }
+    if (!member) {
+        celix_arrayList_add(members, conn);
+        conn->nrOfGroups += 1;
+    }
+    celixThreadMutex_unlock(&broadcaster->mutex);
+    return 0;
+}
+
+int websocketBroadcaster_leave(void *handle, const char *group, const struct mg_connection *connection) {
+    websocket_broadcaster_t *broadcaster = handle;
+    int result = 1;
+    if (group == NULL || connection == NULL) {
+        return result;
+    }
+
+    celixThreadMutex_lock(&broadcaster->mutex);
+    websocket_connection_t *conn = hashMap_get(broadcaster->connections, connection);
+    celix_array_list_t *members = hashMap_get(broadcaster->groups, group);
+    if (conn != NULL && members != NULL) {
+        for (int i = 0; i < celix_arrayList_size(members); ++i) {
+            if (celix_arrayList_get(members, i) == conn) {
+                celix_arrayList_removeAt(members, i);
+                conn->nrOfGroups -= 1;
+                result = 0;
+                break;
+            }
+        }
+        if (celix_arrayList_size(members) == 0) {
+            hash_map_entry_t *entry = hashMap_getEntry(broadcaster->groups, group);
+            char *key = hashMapEntry_getKey(entry);
+            hashMap_remove(broadcaster->groups, group);
+            free(key);
+            celix_arrayList_destroy(members);
+        }
+    }
+    celixThreadMutex_unlock(&broadcaster->mutex);
+    return result;
+}
+
+int websocketBroadcaster_broadcast(void *handle, const char *group, int op_code, const char *data, size_t length) {
+    websocket_broadcaster_t *broadcaster = handle;
+    int count = 0;
+    if (group == NULL || (data == NULL && length > 0)) {
+        return count;
+    }
+
+    //Frame once, outside the lock
+    websocket_message_t *msg = websocketBroadcaster_frame(op_code, data, length);
+
+    celixThreadMutex_lock(&broadcaster->mutex);
+    celix_array_list_t *members = hashMap_get(broadcaster->groups, group);
+    int size = members == NULL ? 0 : celix_arrayList_size(members);
+    for (int i = 0; i < size; ++i) {
+        websocket_connection_t *conn = celix_arrayList_get(members, i);
+        if (conn->failed) {
+            continue;
+        }
+        if (conn->count == conn->capacity) {
+            //Slow connection, drop the message for this connection instead of blocking the others
+            conn->dropped += 1;
+            continue;
+        }
+        conn->backlog[(conn->head + conn->count) % conn->capacity] = msg;
+        conn->count += 1;
+        msg->refCount += 1;
+        count += 1;
+        websocketBroadcaster_pushReady(broadcaster, conn);
+    }
+    if (count > 0) {
+        celixThreadCondition_broadcast(&broadcaster->cond);
+    }
+    bool unused = msg->refCount == 0;
+    celixThreadMutex_unlock(&broadcaster->mutex);
+
+    if (unused) {
+        free(msg);
+    }
+    return count;
+}
+
+void websocketBroadcaster_removeConnection(websocket_broadcaster_t *broadcaster, const struct mg_connection *connection) {
+    if (broadcaster == NULL || connection == NULL) {
+        return;
+    }
+
+    celixThreadMutex_lock(&broadcaster->mutex);
+    websocket_connection_t *conn = hashMap_remove(broadcaster->connections, connection);
+    if (conn != NULL) {
+        hash_map_iterator_t iter = hashMapIterator_construct(broadcaster->groups);
+        while (hashMapIterator_hasNext(&iter) && conn->nrOfGroups > 0) {
+            celix_array_list_t *members = hashMapIterator_nextValue(&iter);
+            for (int i = 0; i < celix_arrayList_size(members); ++i) {
+                if (celix_arrayList_get(members, i) == conn) {
+                    celix_arrayList_removeAt(members, i);
+                    conn->nrOfGroups -= 1;
+                    break;
+                }
+            }
+        }
+        //Note empty groups are kept, a new connection will probably join them again
+
+        while (conn->writing) {
+            celixThreadCondition_wait(&broadcaster->cond, &broadcaster->mutex);
+        }
+        if (conn->ready) {
+            websocket_connection_t *prev = NULL;
+            for (websocket_connection_t *cur = broadcaster->readyHead; cur != NULL; prev = cur, cur = cur->nextReady) {
+                if (cur == conn) {
+                    if (prev == NULL) {
+                        broadcaster->readyHead = cur->nextReady;
+                    } else {
+                        prev->nextReady = cur->nextReady;
+                    }
+                    if (broadcaster->readyTail == cur) {
+                        broadcaster->readyTail = prev;
+                    }
+                    break;
+                }
+            }
+        }
+        websocketBroadcaster_clearBacklog(conn);
+    }
+    celixThreadMutex_unlock(&broadcaster->mutex);
+
+    if (conn != NULL) {
+        free(conn->backlog);
+        free(conn);
+    }
+}
+
+static void *websocketBroadcaster_writerThread(void *data) {
+    websocket_broadcaster_t *broadcaster = data;
+
+    celixThreadMutex_lock(&broadcaster->mutex);
+    while (broadcaster->running) {
+        websocket_connection_t *conn = broadcaster->readyHead;
+        if (conn == NULL) {
+            celixThreadCondition_wait(&broadcaster->cond, &broadcaster->mutex);
+            continue;
+        }
+        broadcaster->readyHead = conn->nextReady;
+        if (broadcaster->readyHead == NULL) {
+            broadcaster->readyTail = NULL;
+        }
+        conn->nextReady = NULL;
+        conn->ready = false;
+
+        websocket_message_t *msg = conn->backlog[conn->head];
+        conn->backlog[conn->head] = NULL;
+        conn->head = (conn->head + 1) % conn->capacity;
+        conn->count -= 1;
+        conn->writing = true;
+        celixThreadMutex_unlock(&broadcaster->mutex);
+
+        //Same locking as mg_websocket_write, the connection can also be written by its own (civetweb) thread
+        mg_lock_connection(conn->connection);
+        int written = mg_write(conn->connection, msg->frame, msg->size);
+        mg_unlock_connection(conn->connection);
+
+        celixThreadMutex_lock(&broadcaster->mutex);
+        conn->writing = false;
+        if (written != (int) msg->size) {
+            conn->failed = true;
+            websocketBroadcaster_clearBacklog(conn);
+        } else if (conn->count > 0) {
+            //Back of the queue, so every connection gets its turn
+            websocketBroadcaster_pushReady(broadcaster, conn);
+        }
+        websocketBroadcaster_releaseMessage(msg);
+        celixThreadCondition_broadcast(&broadcaster->cond);
+    }
+    celixThreadMutex_unlock(&broadcaster->mutex);
+    return NULL;
+}
+
+/**
+ * Creates a (unmasked, server to client) websocket frame, see http://tools.ietf.org/html/rfc6455#section-5.2
+ */
+static websocket_message_t *websocketBroadcaster_frame(int op_code, const char *data, size_t length) {
+    websocket_message_t *msg = malloc(sizeof(*msg) + WEBSOCKET_MAX_FRAME_HEADER_SIZE + length);
+    size_t headerLen;
+    msg->refCount = 0;
+    msg->frame[0] = (unsigned char) (0x80u | ((unsigned) op_code & 0xfu));
+    if (length < 126) {
+        msg->frame[1] = (unsigned char) length;
+        headerLen = 2;
+    } else if (length <= 0xFFFF) {
+        uint16_t len = htons((uint16_t) length);
+        msg->frame[1] = 126;
+        memcpy(msg->frame + 2, &len, 2);
+        headerLen = 4;
+    } else {
+        uint32_t len1 = htonl((uint32_t) ((uint64_t) length >> 32));
+        uint32_t len2 = htonl((uint32_t) (length & 0xFFFFFFFFu));
+        msg->frame[1] = 127;
+        memcpy(msg->frame + 2, &len1, 4);
+        memcpy(msg->frame + 6, &len2, 4);
+        headerLen = 10;
+    }
+    if (length > 0) {
+        memcpy(msg->frame + headerLen, data, length);
+    }
+    msg->size = headerLen + length;
+    return msg;
+}
+
+static void websocketBroadcaster_releaseMessage(websocket_message_t *msg) {
+    if (--msg->refCount == 0) {
+        free(msg);
+    }
+}
+
+static void websocketBroadcaster_pushReady(websocket_broadcaster_t *broadcaster, websocket_connection_t *conn) {
+    if (conn->ready || conn->writing) {
+        return; //already queued, or will be queued again after the current write
+    }
+    conn->ready = true;
+    conn->nextReady = NULL;
+    if (broadcaster->readyTail == NULL) {
+        broadcaster->readyHead = conn;
+    } else {
+        broadcaster->readyTail->nextReady = conn;
+    }
+    broadcaster->readyTail = conn;
+}
+
+static void websocketBroadcaster_clearBacklog(websocket_connection_t *conn) {
+    while (conn->count > 0) {
+        websocketBroadcaster_releaseMessage(conn->backlog[conn->head]);
+        conn->backlog[conn->head] = NULL;
+        conn->head = (conn->head + 1) % conn->capacity;
+        conn->count -= 1;
+    }
+}
@@ -0,0 +1,48 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *  KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#ifndef CELIX_WEBSOCKET_BROADCASTER_H
+#define CELIX_WEBSOCKET_BROADCASTER_H
+
+#include <stddef.h>
+
+#include "civetweb.h"
+
+/**
+ * Fan-out of websocket messages to groups of connections, see celix_websocket_broadcast_service_t.
+ * Messages are framed once, reference counted and written by dedicated writer threads which round-robin over the
+ * connections with pending messages (one message per connection per turn). A connection is written by at most one
+ * writer at a time, so with more than one writer a blocking (slow) connection does not stall the other connections.
+ */
+typedef struct websocket_broadcaster websocket_broadcaster_t;
+
+websocket_broadcaster_t *websocketBroadcaster_create(size_t maxBacklog, int nrOfWriters);
+void websocketBroadcaster_destroy(websocket_broadcaster_t *broadcaster);
+
+int websocketBroadcaster_join(void *handle, const char *group, struct mg_connection *connection);
+int websocketBroadcaster_leave(void *handle, const char *group, const struct mg_connection *connection);
+int websocketBroadcaster_broadcast(void *handle, const char *group, int op_code, const char *data, size_t length);
+
+/**
+ * Removes the connection from all groups and drops its backlog. Waits until the writer thread is no longer writing to
+ * the connection, so the connection can be freed afterwards.
+ */
+void websocketBroadcaster_removeConnection(websocket_broadcaster_t *broadcaster, const struct mg_connection *connection);
+
+#endif //CELIX_WEBSOCKET_BROADCASTER_H
@@ -28,7 +28,9 @@
 #define HTTP_ADMIN_API_H
 
 #include "http_admin_service.h"
+#include "http_admin_async_service.h"
 #include "http_admin_info_service.h"
 #include "websocket_admin_service.h"
+#include "websocket_broadcast_service.h"
 
 #endif //HTTP_ADMIN_API_H
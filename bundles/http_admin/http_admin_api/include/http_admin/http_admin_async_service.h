@@ -0,0 +1,96 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *  KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+/**
+ * http_admin_async_service.h
+ *
+ *  \author     <a href="mailto:dev@celix.apache.org">Apache Celix Project Team</a>
+ *  \copyright  Apache License, Version 2.0
+ */
+
+#ifndef CELIX_HTTP_ADMIN_ASYNC_SERVICE_H
+#define CELIX_HTTP_ADMIN_ASYNC_SERVICE_H
+
+#include <stdlib.h>
+
+#define HTTP_ADMIN_ASYNC_SERVICE_NAME "http_admin_async_service"
+
+//Properties, the uri is the same property as for the http_admin_service (HTTP_ADMIN_URI)
+
+/*
+ * Response of a request handled by an async HTTP service. All functions can be called from any thread, until the
+ * response is completed. The calls of a single response should not be made concurrently.
+ */
+struct celix_http_async_response {
+    void *handle;
+
+    /*
+     * Returns the value of a request header or NULL. The value is valid until the response is completed.
+     */
+    const char* (*getHeader)(void *handle, const char *name);
+
+    /*
+     * Sends a complete response with the given status code, content type and body. The body is copied.
+     *
+     * Returns 0 in case of success.
+     */
+    int (*send)(void *handle, int status, const char *contentType, const char *body, size_t length);
+
+    /*
+     * Starts a chunked (streaming) response, the body is sent with sendChunk.
+     *
+     * Returns 0 in case of success.
+     */
+    int (*startChunked)(void *handle, int status, const char *contentType);
+
+    /*
+     * Sends a part of the body of a chunked response. Blocks until the data is written to the connection.
+     *
+     * Returns 0 in case of success, or a non-zero value if the connection is closed or the request timed out.
+     */
+    int (*sendChunk)(void *handle, const char *data, size_t length);
+
+    /*
+     * Completes the response: ends a chunked response, or responds with 500 if nothing is sent.
+     * Every response must be completed exactly once, the response cannot be used after this call.
+     */
+    void (*complete)(void *handle);
+};
+
+typedef struct celix_http_async_response celix_http_async_response_t;
+
+/*
+ * HTTP service handling requests asynchronously. The handler takes over the request and can respond later from
+ * any thread, e.g. when a remote call it started returns.
+ * Note that the connection stays reserved for the request until the response is completed, or until the
+ * CELIX_HTTP_ADMIN_ASYNC_TIMEOUT_MS of the HTTP admin expires and the HTTP admin responds with 504.
+ */
+struct celix_http_async_service {
+    void *handle;
+
+    /*
+     * Handles a request with any method. The (possibly NULL) data contains the request body and is only valid during
+     * the call. The response is owned by the service until it is completed.
+     */
+    void (*handleRequest)(void *handle, const char *method, const char *uri, const char *data, size_t length,
+                          celix_http_async_response_t *response);
+};
+
+typedef struct celix_http_async_service celix_http_async_service_t;
+
+#endif //CELIX_HTTP_ADMIN_ASYNC_SERVICE_H
@@ -0,0 +1,70 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *  KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+/**
+ * websocket_broadcast_service.h
+ *
+ *  \author     <a href="mailto:dev@celix.apache.org">Apache Celix Project Team</a>
+ *  \copyright  Apache License, Version 2.0
+ */
+
+#ifndef CELIX_WEBSOCKET_BROADCAST_SERVICE_H
+#define CELIX_WEBSOCKET_BROADCAST_SERVICE_H
+
+#include <stdlib.h>
+#include "civetweb.h"
+
+#define WEBSOCKET_BROADCAST_SERVICE_NAME "websocket_broadcast_service"
+
+/*
+ * Service provided by the websocket admin to send the same message to a group of websocket connections.
+ * A message is framed once and written to the connections of the group by a dedicated writer thread, so a broadcast
+ * does not block on the connections. Every connection has a limited backlog of messages; when the backlog of a (slow)
+ * connection is full, new messages for that connection are dropped instead of blocking the other connections.
+ * Connections are removed from all groups when they close.
+ */
+struct celix_websocket_broadcast_service {
+    void *handle;
+
+    /*
+     * Adds the connection to the group, the group is created if needed. Typically called from the ready callback of a
+     * websocket service.
+     *
+     * Returns 0 in case of success.
+     */
+    int (*join)(void *handle, const char *group, struct mg_connection *connection);
+
+    /*
+     * Removes the connection from the group.
+     *
+     * Returns 0 in case of success, or a non-zero value if the connection is not part of the group.
+     */
+    int (*leave)(void *handle, const char *group, const struct mg_connection *connection);
+
+    /*
+     * Queues a message with the provided websocket op code (e.g. MG_WEBSOCKET_OPCODE_TEXT) for all connections of the group.
+     * The data is copied.
+     *
+     * Returns the nr of connections the message is queued for.
+     */
+    int (*broadcast)(void *handle, const char *group, int op_code, const char *data, size_t length);
+};
+
+typedef struct celix_websocket_broadcast_service celix_websocket_broadcast_service_t;
+
+#endif //CELIX_WEBSOCKET_BROADCAST_SERVICE_H
@@ -0,0 +1,167 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *  KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <thread>
+#include <vector>
+#include <string.h>
+
+#include "celix_api.h"
+#include "http_admin/api.h"
+#include "civetweb.h"
+
+#include <CppUTest/TestHarness.h>
+
+#define HTTP_PORT 8000
+
+extern celix_framework_t *fw;
+
+namespace {
+    struct response {
+        int statusCode{-1};
+        std::string body{};
+    };
+
+    response sendRequest(const std::string &request, int timeoutInMs = 1000) {
+        char err_buf[100] = {0};
+        response result{};
+        struct mg_connection *connection = mg_connect_client("localhost", HTTP_PORT, 0, err_buf, sizeof(err_buf));
+        CHECK(connection != nullptr);
+
+        CHECK_EQUAL((int) request.size(), mg_write(connection, request.c_str(), request.size()));
+        CHECK(mg_get_response(connection, err_buf, sizeof(err_buf), timeoutInMs) > 0);
+
+        const struct mg_response_info *info = mg_get_response_info(connection);
+        CHECK(info != nullptr);
+        result.statusCode = info->status_code;
+        char buf[1024];
+        int read;
+        while ((info->content_length < 0 || (long long) result.body.size() < info->content_length) &&
+               (read = mg_read(connection, buf, sizeof(buf))) > 0) {
+            result.body.append(buf, (size_t) read);
+        }
+
+        mg_close_connection(connection);
+        return result;
+    }
+
+    enum class mode {
+        SEND,
+        CHUNKED,
+        NOTHING,
+        TOO_LATE
+    };
+
+    /**
+     * Async service which responds from a thread of its own, like a service waiting for a remote call.
+     */
+    struct async_handler {
+        mode m{mode::SEND};
+        std::vector<std::thread> threads{};
+        std::atomic<int> lateSendResult{0};
+
+        static void handleRequest(void *handle, const char *method, const char *uri, const char *data, size_t length,
+                                  celix_http_async_response_t *response) {
+            auto *h = static_cast<async_handler*>(handle);
+            //the request data is only valid during the call
+            std::string body = std::string{method} + " " + uri + " " + std::string{data == nullptr ? "" : data, length};
+            const char *header = response->getHeader(response->handle, "X-Test");
+            if (header != nullptr) {
+                body += std::string{" "} + header;
+            }
+            h->threads.emplace_back([h, response, body]{
+                std::this_thread::sleep_for(std::chrono::milliseconds{h->m == mode::TOO_LATE ? 1500 : 50});
+                switch (h->m) {
+                    case mode::SEND:
+                        response->send(response->handle, 200, "text/plain", body.c_str(), body.size());
+                        break;
+                    case mode::CHUNKED:
+                        response->startChunked(response->handle, 200, "text/plain");
+                        for (const char *chunk : {"a", "bb", "ccc"}) {
+                            response->sendChunk(response->handle, chunk, strlen(chunk));
+                        }
+                        break;
+                    case mode::NOTHING:
+                        break;
+                    case mode::TOO_LATE:
+                        h->lateSendResult = response->send(response->handle, 200, "text/plain", "late", 4);
+                        break;
+                }
+                response->complete(response->handle);
+            });
+        }
+    };
+}
+
+TEST_GROUP(HTTP_ADMIN_ASYNC_SERVICE_GROUP)
+{
+    celix_bundle_context_t *ctx = nullptr;
+    async_handler handler{};
+    celix_http_async_service_t svc{};
+    long svcId = -1L;
+
+    void setup() {
+        ctx = celix_framework_getFrameworkContext(fw);
+        svc.handle = &handler;
+        svc.handleRequest = async_handler::handleRequest;
+        celix_properties_t *props = celix_properties_create();
+        celix_properties_set(props, HTTP_ADMIN_URI, "/async");
+        svcId = celix_bundleContext_registerService(ctx, &svc, HTTP_ADMIN_ASYNC_SERVICE_NAME, props);
+    }
+
+    void teardown() {
+        for (auto &t : handler.threads) {
+            t.join();
+        }
+        celix_bundleContext_unregisterService(ctx, svcId);
+    }
+};
+
+TEST(HTTP_ADMIN_ASYNC_SERVICE_GROUP, respond_from_other_thread) {
+    response r = sendRequest("POST /async/call HTTP/1.1\r\nX-Test: header\r\nContent-Length: 4\r\n\r\nbody");
+    CHECK_EQUAL(200, r.statusCode);
+    STRCMP_EQUAL("POST /async/call body header", r.body.c_str());
+}
+
+TEST(HTTP_ADMIN_ASYNC_SERVICE_GROUP, chunked_response) {
+    handler.m = mode::CHUNKED;
+    response r = sendRequest("GET /async HTTP/1.1\r\n\r\n");
+    CHECK_EQUAL(200, r.statusCode);
+    STRCMP_EQUAL("abbccc", r.body.c_str());
+}
+
+TEST(HTTP_ADMIN_ASYNC_SERVICE_GROUP, completed_without_response) {
+    handler.m = mode::NOTHING;
+    response r = sendRequest("GET /async HTTP/1.1\r\n\r\n");
+    CHECK_EQUAL(500, r.statusCode);
+}
+
+TEST(HTTP_ADMIN_ASYNC_SERVICE_GROUP, timeout) {
+    //the async timeout of the test container is 1s
+    handler.m = mode::TOO_LATE;
+    response r = sendRequest("GET /async HTTP/1.1\r\n\r\n", 5000);
+    CHECK_EQUAL(504, r.statusCode);
+
+    //a response after the timeout fails, completing it is still allowed
+    handler.threads[0].join();
+    handler.threads.clear();
+    CHECK(handler.lateSendResult != 0);
+}
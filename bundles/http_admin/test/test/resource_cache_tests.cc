@@ -0,0 +1,130 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *  KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <string>
+#include <string.h>
+
+#include "civetweb.h"
+
+#include <CppUTest/TestHarness.h>
+
+#define HTTP_PORT 8000
+
+namespace {
+    struct response {
+        int statusCode{-1};
+        long long contentLength{-1};
+        std::string etag{};
+        std::string lastModified{};
+        std::string encoding{};
+        std::string body{};
+    };
+
+    response sendRequest(const std::string &request) {
+        char err_buf[100] = {0};
+        response result{};
+        struct mg_connection *connection = mg_connect_client("localhost", HTTP_PORT, 0, err_buf, sizeof(err_buf));
+        CHECK(connection != nullptr);
+
+        CHECK_EQUAL((int) request.size(), mg_write(connection, request.c_str(), request.size()));
+        CHECK(mg_get_response(connection, err_buf, sizeof(err_buf), 1000) > 0);
+
+        const struct mg_response_info *info = mg_get_response_info(connection);
+        CHECK(info != nullptr);
+        result.statusCode = info->status_code;
+        result.contentLength = info->content_length;
+        const char *etag = mg_get_header(connection, "ETag");
+        const char *lastModified = mg_get_header(connection, "Last-Modified");
+        const char *encoding = mg_get_header(connection, "Content-Encoding");
+        result.etag = etag == nullptr ? "" : etag;
+        result.lastModified = lastModified == nullptr ? "" : lastModified;
+        result.encoding = encoding == nullptr ? "" : encoding;
+
+        if (request.compare(0, 4, "HEAD") != 0 && result.statusCode == 200) {
+            char buf[1024];
+            int read;
+            while ((long long) result.body.size() < result.contentLength && (read = mg_read(connection, buf, sizeof(buf))) > 0) {
+                result.body.append(buf, (size_t) read);
+            }
+        }
+
+        mg_close_connection(connection);
+        return result;
+    }
+}
+
+TEST_GROUP(HTTP_ADMIN_RESOURCE_CACHE_GROUP)
+{
+};
+
+TEST(HTTP_ADMIN_RESOURCE_CACHE_GROUP, get_has_validators) {
+    response first = sendRequest("GET /alias/index.html HTTP/1.1\r\n\r\n");
+    CHECK_EQUAL(200, first.statusCode);
+    CHECK(!first.etag.empty());
+    CHECK(!first.lastModified.empty());
+    CHECK(first.body.find("Test header") != std::string::npos);
+
+    //the second request is served from the cache with the same validators and content
+    response second = sendRequest("GET /alias/index.html HTTP/1.1\r\n\r\n");
+    CHECK_EQUAL(200, second.statusCode);
+    STRCMP_EQUAL(first.etag.c_str(), second.etag.c_str());
+    STRCMP_EQUAL(first.body.c_str(), second.body.c_str());
+}
+
+TEST(HTTP_ADMIN_RESOURCE_CACHE_GROUP, conditional_requests_not_modified) {
+    response full = sendRequest("GET /alias/index.html HTTP/1.1\r\n\r\n");
+    CHECK_EQUAL(200, full.statusCode);
+
+    response byEtag = sendRequest("GET /alias/index.html HTTP/1.1\r\nIf-None-Match: " + full.etag + "\r\n\r\n");
+    CHECK_EQUAL(304, byEtag.statusCode);
+    STRCMP_EQUAL(full.etag.c_str(), byEtag.etag.c_str());
+
+    response byDate = sendRequest("GET /alias/index.html HTTP/1.1\r\nIf-Modified-Since: " + full.lastModified + "\r\n\r\n");
+    CHECK_EQUAL(304, byDate.statusCode);
+
+    //an outdated etag or date gets the full resource
+    response otherEtag = sendRequest("GET /alias/index.html HTTP/1.1\r\nIf-None-Match: \"0.0\"\r\n\r\n");
+    CHECK_EQUAL(200, otherEtag.statusCode);
+    response oldDate = sendRequest("GET /alias/index.html HTTP/1.1\r\nIf-Modified-Since: Thu, 01 Jan 1970 00:00:00 GMT\r\n\r\n");
+    CHECK_EQUAL(200, oldDate.statusCode);
+}
+
+TEST(HTTP_ADMIN_RESOURCE_CACHE_GROUP, head_has_no_body) {
+    response get = sendRequest("GET /alias/index.html HTTP/1.1\r\n\r\n");
+    response head = sendRequest("HEAD /alias/index.html HTTP/1.1\r\n\r\n");
+    CHECK_EQUAL(200, head.statusCode);
+    CHECK_EQUAL((long long) get.body.size(), head.contentLength);
+    STRCMP_EQUAL(get.etag.c_str(), head.etag.c_str());
+}
+
+TEST(HTTP_ADMIN_RESOURCE_CACHE_GROUP, gzip_when_accepted) {
+    response plain = sendRequest("GET /alias/large.html HTTP/1.1\r\n\r\n");
+    CHECK_EQUAL(200, plain.statusCode);
+    CHECK(plain.encoding.empty());
+    CHECK(plain.body.find("Large test page") != std::string::npos);
+
+    response gzip = sendRequest("GET /alias/large.html HTTP/1.1\r\nAccept-Encoding: gzip, deflate\r\n\r\n");
+    CHECK_EQUAL(200, gzip.statusCode);
+    STRCMP_EQUAL("gzip", gzip.encoding.c_str());
+    CHECK(gzip.body.size() < plain.body.size());
+    CHECK(gzip.body.size() > 2);
+    CHECK_EQUAL(0x1f, (unsigned char) gzip.body[0]);
+    CHECK_EQUAL(0x8b, (unsigned char) gzip.body[1]);
+    STRCMP_EQUAL(plain.etag.c_str(), gzip.etag.c_str());
+}
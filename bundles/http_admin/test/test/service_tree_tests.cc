@@ -0,0 +1,92 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *  KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <CppUTest/TestHarness.h>
+
+extern "C" {
+#include "service_tree.h"
+}
+
+TEST_GROUP(SERVICE_TREE_GROUP)
+{
+    service_tree_t tree{};
+    int svc1 = 1;
+    int svc2 = 2;
+    int svc3 = 3;
+    int rootSvc = 4;
+
+    void teardown() {
+        destroyServiceTree(&tree);
+    }
+
+    void* findService(const char *uri) {
+        service_tree_node_t *node = findServiceNodeInTree(&tree, uri);
+        return node == nullptr ? nullptr : node->svc_data->service;
+    }
+
+    void removeService(const char *uri) {
+        service_tree_node_t *node = findServiceNodeInTree(&tree, uri);
+        CHECK(node != nullptr);
+        destroyServiceNode(&tree, node, &tree.tree_node_count, &tree.tree_svc_count);
+    }
+};
+
+TEST(SERVICE_TREE_GROUP, add_normalizes_uri) {
+    CHECK(addServiceNode(&tree, "/foo/bar", &svc1));
+    CHECK_FALSE(addServiceNode(&tree, "foo//bar/", &svc2));
+    CHECK(addServiceNode(&tree, "/foo", &svc2));
+    CHECK_EQUAL(2, tree.tree_svc_count);
+}
+
+TEST(SERVICE_TREE_GROUP, find_longest_prefix_on_segment_boundary) {
+    CHECK(addServiceNode(&tree, "/foo/bar", &svc1));
+    CHECK(addServiceNode(&tree, "/foo/baz", &svc2));
+    CHECK(addServiceNode(&tree, "/foo", &svc3));
+
+    POINTERS_EQUAL(&svc1, findService("/foo/bar"));
+    POINTERS_EQUAL(&svc1, findService("/foo//bar/index.html"));
+    POINTERS_EQUAL(&svc2, findService("/foo/baz/"));
+    POINTERS_EQUAL(&svc3, findService("/foo/ba"));
+    POINTERS_EQUAL(&svc3, findService("/foo/barx"));
+    POINTERS_EQUAL(nullptr, findService("/fo"));
+    POINTERS_EQUAL(nullptr, findService("/"));
+
+    CHECK(addServiceNode(&tree, "/", &rootSvc));
+    POINTERS_EQUAL(&rootSvc, findService("/fo"));
+    POINTERS_EQUAL(&rootSvc, findService("/"));
+}
+
+TEST(SERVICE_TREE_GROUP, remove_compacts_tree) {
+    CHECK(addServiceNode(&tree, "/foo/bar", &svc1));
+    CHECK(addServiceNode(&tree, "/foo/baz", &svc2));
+    CHECK(addServiceNode(&tree, "/foo", &svc3));
+    int nodeCount = tree.tree_node_count;
+
+    removeService("/foo");
+    POINTERS_EQUAL(nullptr, findService("/foo/x"));
+    POINTERS_EQUAL(&svc2, findService("/foo/baz"));
+
+    removeService("/foo/baz");
+    POINTERS_EQUAL(&svc1, findService("/foo/bar"));
+    CHECK(tree.tree_node_count < nodeCount);
+
+    removeService("/foo/bar");
+    CHECK_EQUAL(0, tree.tree_svc_count);
+    CHECK_EQUAL(1, tree.tree_node_count); //only the root node
+}
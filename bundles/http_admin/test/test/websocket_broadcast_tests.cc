@@ -0,0 +1,176 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *  KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include <string.h>
+
+#include "celix_api.h"
+#include "http_admin/api.h"
+#include "civetweb.h"
+
+#include <CppUTest/TestHarness.h>
+
+#define HTTP_PORT 8000
+#define BROADCAST_GROUP "broadcast_test"
+
+extern celix_framework_t *fw;
+
+namespace {
+    struct server_side {
+        std::mutex mutex{};
+        std::condition_variable cond{};
+        std::vector<struct mg_connection*> connections{};
+        celix_websocket_broadcast_service_t *broadcastSvc{nullptr};
+
+        static void ready(struct mg_connection *connection, void *handle) {
+            auto *server = static_cast<server_side*>(handle);
+            std::lock_guard<std::mutex> lck{server->mutex};
+            server->broadcastSvc->join(server->broadcastSvc->handle, BROADCAST_GROUP, connection);
+            server->connections.push_back(connection);
+            server->cond.notify_all();
+        }
+
+        static int data(struct mg_connection */*connection*/, int /*op_code*/, char */*data*/, size_t /*length*/, void */*handle*/) {
+            return 1; //keep open
+        }
+
+        bool waitForConnections(size_t count) {
+            std::unique_lock<std::mutex> lck{mutex};
+            return cond.wait_for(lck, std::chrono::seconds{5}, [&]{ return connections.size() >= count; });
+        }
+    };
+
+    struct client {
+        std::mutex mutex{};
+        std::condition_variable cond{};
+        std::vector<std::string> received{};
+        struct mg_connection *connection{nullptr};
+
+        static int data(struct mg_connection */*connection*/, int flags, char *data, size_t length, void *handle) {
+            auto *c = static_cast<client*>(handle);
+            if ((flags & 0xf) == MG_WEBSOCKET_OPCODE_TEXT) {
+                std::lock_guard<std::mutex> lck{c->mutex};
+                c->received.emplace_back(data, length);
+                c->cond.notify_all();
+            }
+            return 1; //keep open
+        }
+
+        bool waitFor(size_t count) {
+            std::unique_lock<std::mutex> lck{mutex};
+            return cond.wait_for(lck, std::chrono::seconds{5}, [&]{ return received.size() >= count; });
+        }
+    };
+}
+
+TEST_GROUP(WEBSOCKET_BROADCAST_GROUP)
+{
+    celix_bundle_context_t *ctx = nullptr;
+    server_side server{};
+    celix_websocket_service_t sockSvc{};
+    long sockSvcId = -1L;
+
+    void setup() {
+        ctx = celix_framework_getFrameworkContext(fw);
+
+        celix_service_use_options_t opts{};
+        opts.filter.serviceName = WEBSOCKET_BROADCAST_SERVICE_NAME;
+        opts.waitTimeoutInSeconds = 2.0;
+        opts.callbackHandle = &server;
+        opts.use = [](void *handle, void *svc) {
+            static_cast<server_side*>(handle)->broadcastSvc = static_cast<celix_websocket_broadcast_service_t*>(svc);
+        };
+        CHECK(celix_bundleContext_useServiceWithOptions(ctx, &opts));
+
+        celix_properties_t *props = celix_properties_create();
+        celix_properties_set(props, WEBSOCKET_ADMIN_URI, "/broadcast");
+        sockSvc.handle = &server;
+        sockSvc.ready = server_side::ready;
+        sockSvc.data = server_side::data;
+        sockSvcId = celix_bundleContext_registerService(ctx, &sockSvc, WEBSOCKET_ADMIN_SERVICE_NAME, props);
+    }
+
+    void teardown() {
+        celix_bundleContext_unregisterService(ctx, sockSvcId);
+    }
+
+    void connect(client &c) {
+        char err_buf[100] = {0};
+        c.connection = mg_connect_websocket_client("127.0.0.1", HTTP_PORT, 0, err_buf, sizeof(err_buf),
+                "/broadcast", nullptr, client::data, nullptr, &c);
+        CHECK(c.connection != nullptr);
+    }
+
+    int broadcast(const char *msg) {
+        return server.broadcastSvc->broadcast(server.broadcastSvc->handle, BROADCAST_GROUP, MG_WEBSOCKET_OPCODE_TEXT, msg, strlen(msg));
+    }
+};
+
+TEST(WEBSOCKET_BROADCAST_GROUP, broadcast_to_group) {
+    client clients[3];
+    for (auto &c : clients) {
+        connect(c);
+    }
+    CHECK(server.waitForConnections(3));
+
+    CHECK_EQUAL(3, broadcast("first"));
+    CHECK_EQUAL(3, broadcast("second"));
+    for (auto &c : clients) {
+        CHECK(c.waitFor(2));
+        std::lock_guard<std::mutex> lck{c.mutex};
+        STRCMP_EQUAL("first", c.received[0].c_str());
+        STRCMP_EQUAL("second", c.received[1].c_str());
+    }
+
+    //no connections in an unknown group
+    CHECK_EQUAL(0, server.broadcastSvc->broadcast(server.broadcastSvc->handle, "unknown", MG_WEBSOCKET_OPCODE_TEXT, "x", 1));
+
+    for (auto &c : clients) {
+        mg_close_connection(c.connection);
+    }
+}
+
+TEST(WEBSOCKET_BROADCAST_GROUP, leave_and_close_remove_from_group) {
+    client clients[2];
+    for (auto &c : clients) {
+        connect(c);
+    }
+    CHECK(server.waitForConnections(2));
+
+    struct mg_connection *left = server.connections[0];
+    CHECK_EQUAL(0, server.broadcastSvc->leave(server.broadcastSvc->handle, BROADCAST_GROUP, left));
+    CHECK(server.broadcastSvc->leave(server.broadcastSvc->handle, BROADCAST_GROUP, left) != 0);
+    CHECK_EQUAL(1, broadcast("after leave"));
+
+    //a closed connection is removed from all groups by the websocket admin
+    for (auto &c : clients) {
+        mg_close_connection(c.connection);
+    }
+    int nrOfConnections = 1;
+    for (int i = 0; i < 50 && nrOfConnections > 0; ++i) {
+        std::this_thread::sleep_for(std::chrono::milliseconds{100});
+        nrOfConnections = broadcast("after close");
+    }
+    CHECK_EQUAL(0, nrOfConnections);
+}
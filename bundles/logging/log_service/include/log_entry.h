@@ -20,6 +20,8 @@
 #ifndef LOG_ENTRY_H_
 #define LOG_ENTRY_H_
 
+#include <time.h>
+
 #include "log_service.h"
 
 struct log_entry {
@@ -30,6 +32,9 @@ struct log_entry {
 
     long bundleId;
     char* bundleSymbolicName;
+
+    struct timespec monotonicTime; //CLOCK_MONOTONIC time of logging
+    long threadId; //id of the logging thread (the kernel thread id on linux)
 };
 
 typedef struct log_entry log_entry_t;
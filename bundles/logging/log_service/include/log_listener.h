@@ -26,6 +26,12 @@
 struct log_listener {
     void *handle;
     celix_status_t (*logged)(void *handle, log_entry_t *entry);
+
+    /**
+     * Optional (can be NULL). Called after a batch of entries is delivered, so that buffering listeners can write
+     * the batch at once.
+     */
+    celix_status_t (*flush)(void *handle);
 };
 
 typedef struct log_listener log_listener_t;
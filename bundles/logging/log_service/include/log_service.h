@@ -25,6 +25,12 @@
 
 static const char * const OSGI_LOGSERVICE_NAME = "log_service";
 
+/**
+ * Service property with the highest log level (as number) accepted by a log service. Entries with a higher level
+ * are discarded, so log helpers can skip them before formatting. If absent all levels are accepted.
+ */
+static const char * const OSGI_LOGSERVICE_LEVEL_PROPERTY = "log.level";
+
 typedef struct log_service_data log_service_data_t;
 
 enum log_level
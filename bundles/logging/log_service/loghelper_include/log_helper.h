@@ -35,6 +35,13 @@ celix_status_t logHelper_stop(log_helper_t *loghelper);
 celix_status_t logHelper_destroy(log_helper_t **loghelper);
 celix_status_t logHelper_log(log_helper_t *loghelper, log_level_t level, const char* message, ... );
 
+/**
+ * Returns whether an entry with the provided level would be logged by any log service (or the stdout fallback).
+ * Lock free, so it can be used to skip building expensive log arguments.
+ * logHelper_log already checks this before formatting the message.
+ */
+bool logHelper_isEnabled(log_helper_t *loghelper, log_level_t level);
+
 #ifdef __cplusplus
 }
 #endif
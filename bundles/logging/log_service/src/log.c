@@ -24,161 +24,206 @@
  *  \copyright  Apache License, Version 2.0
  */
 
+
 #include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
 
 #include "log.h"
-#include "linked_list_iterator.h"
 #include "array_list.h"
+#include "hash_map.h"
+#include "utils.h"
+#include "celix_ring_buffer.h"
+
+/**
+ * Log entry with inline storage for the message. Slots are preallocated, so logging does not allocate.
+ * Longer messages are truncated. The bundle symbolic name refers to an interned name.
+ */
+typedef struct log_slot {
+    log_entry_t entry; //note first member, a log_entry_t* of a slot is also a log_slot_t*
+    char message[LOG_SLOT_MAX_MESSAGE_LENGTH];
+} log_slot_t;
 
 struct log {
-    linked_list_pt entries;
-    celix_thread_mutex_t lock;
+    celix_ring_buffer_t *freeSlots;     //MPMC, preallocated slots available for new entries
+    celix_ring_buffer_t *deliverQueue;  //MPMC, entries to deliver to the listeners (and store)
+    long dropped;                       //atomic, nr of entries dropped because no slot was available
+    long totalDropped;                  //atomic, as dropped, but not reset when reported to the listeners
 
-    array_list_pt listeners;
-    array_list_pt listenerEntries;
+    celix_thread_t deliverThread;
+
+    celix_thread_mutex_t lock;          //protects the stored entries, not used when logging
+    log_slot_t **entries;               //ring of stored entries, oldest first starting at entriesHead
+    size_t entriesHead;
+    size_t entriesSize;
+    size_t entriesCap;
 
-    celix_thread_t listenerThread;
-    bool running;
+    celix_thread_mutex_t listenerLock;  //protects listeners
+    array_list_pt listeners;
 
-    celix_thread_cond_t entriesToDeliver;
-    celix_thread_mutex_t deliverLock;
-    celix_thread_mutex_t listenerLock;
+    celix_thread_mutex_t internLock;    //protects internedNames
+    hash_map_pt internedNames;          //bundle symbolic name -> interned name (same char*)
 
     int max_size;
     bool store_debug;
+    log_level_t max_level;
 };
 
-static celix_status_t log_startListenerThread(log_t *logger);
-static celix_status_t log_stopListenerThread(log_t *logger);
-
-
-static void *log_listenerThread(void *data);
-
-celix_status_t log_create(int max_size, bool store_debug, log_t **logger) {
-    celix_status_t status = CELIX_ENOMEM;
+static void *log_deliverThread(void *data);
+static void log_deliverBatch(log_t *logger, log_slot_t **batch, size_t size);
+static void log_storeOrRelease(log_t *logger, log_slot_t *slot);
+static void log_releaseSlot(log_t *logger, log_slot_t *slot);
 
+celix_status_t log_create(int max_size, bool store_debug, log_level_t max_level, log_t **logger) {
     *logger = calloc(1, sizeof(**logger));
+    if (*logger == NULL) {
+        return CELIX_ENOMEM;
+    }
+    log_t *log = *logger;
 
-    if (*logger != NULL) {
-        linkedList_create(&(*logger)->entries);
-
-        status = celixThreadMutex_create(&(*logger)->lock, NULL);
-
-        (*logger)->listeners = NULL;
-        (*logger)->listenerEntries = NULL;
-        (*logger)->listenerThread = celix_thread_default;
-        (*logger)->running = false;
-
-        (*logger)->max_size = max_size;
-        (*logger)->store_debug = store_debug;
-
-        arrayList_create(&(*logger)->listeners);
-        arrayList_create(&(*logger)->listenerEntries);
+    log->max_size = max_size;
+    log->store_debug = store_debug;
+    log->max_level = max_level;
+    //note for an unlimited store (-1) the deliver thread replaces stored slots with new slots
+    log->entriesCap = max_size > 0 ? (size_t) max_size : (max_size < 0 ? LOG_DELIVER_QUEUE_SIZE : 0);
+    size_t nrOfSlots = (max_size > 0 ? (size_t) max_size : 0) + LOG_DELIVER_QUEUE_SIZE + LOG_DELIVER_BATCH_SIZE;
 
-        if (celixThreadCondition_init(&(*logger)->entriesToDeliver, NULL) != CELIX_SUCCESS) {
-            status = CELIX_INVALID_SYNTAX;
-        }
-        else if (celixThreadMutex_create(&(*logger)->deliverLock, NULL) != CELIX_SUCCESS) {
-            status = CELIX_INVALID_SYNTAX;
-        }
-        else if (celixThreadMutex_create(&(*logger)->listenerLock, NULL) != CELIX_SUCCESS) {
-            status = CELIX_INVALID_SYNTAX;
-        }
-        else {
-            status = CELIX_SUCCESS;
+    celix_status_t status = celixThreadMutex_createNamed(&log->lock, NULL, "log");
+    if (status == CELIX_SUCCESS) {
+        status = celixThreadMutex_create(&log->listenerLock, NULL);
+    }
+    if (status == CELIX_SUCCESS) {
+        status = celixThreadMutex_create(&log->internLock, NULL);
+    }
+    arrayList_create(&log->listeners);
+    log->internedNames = hashMap_create(utils_stringHash, NULL, utils_stringEquals, NULL);
+    log->entries = log->entriesCap > 0 ? calloc(log->entriesCap, sizeof(*log->entries)) : NULL;
+    log->freeSlots = celix_ringBuffer_create(nrOfSlots, CELIX_RING_BUFFER_MPMC);
+    log->deliverQueue = celix_ringBuffer_create(nrOfSlots, CELIX_RING_BUFFER_MPMC);
+    if (log->freeSlots == NULL || log->deliverQueue == NULL || (log->entriesCap > 0 && log->entries == NULL)) {
+        status = CELIX_ENOMEM;
+    }
+    for (size_t i = 0; status == CELIX_SUCCESS && i < nrOfSlots; ++i) {
+        log_slot_t *slot = calloc(1, sizeof(*slot));
+        if (slot == NULL || !celix_ringBuffer_tryPush(log->freeSlots, slot)) {
+            free(slot);
+            status = CELIX_ENOMEM;
         }
     }
-
+    if (status == CELIX_SUCCESS) {
+        status = celixThread_create(&log->deliverThread, NULL, log_deliverThread, log);
+    }
+    if (status == CELIX_SUCCESS) {
+        celixThread_setName(&log->deliverThread, "LogDeliver");
+    } else {
+        log_destroy(log);
+        *logger = NULL;
+    }
     return status;
 }
 
 celix_status_t log_destroy(log_t *logger) {
-    celix_status_t status = CELIX_SUCCESS;
-
-    celixThreadMutex_destroy(&logger->listenerLock);
-    celixThreadMutex_destroy(&logger->deliverLock);
-    celixThreadCondition_destroy(&logger->entriesToDeliver);
-
-    arrayList_destroy(logger->listeners);
-    linked_list_iterator_pt iter = linkedListIterator_create(logger->entries, 0);
-    while (linkedListIterator_hasNext(iter)) {
-    log_entry_t *entry = linkedListIterator_next(iter);
-        if (arrayList_contains(logger->listenerEntries, entry)) {
-                arrayList_removeElement(logger->listenerEntries, entry);
+    if (logger->deliverQueue != NULL) {
+        celix_ringBuffer_close(logger->deliverQueue);
+        if (logger->deliverThread.threadInitialized) {
+            //note the deliver thread delivers the remaining entries before it stops
+            celixThread_join(logger->deliverThread, NULL);
+        }
+        void *slot = NULL;
+        while (celix_ringBuffer_tryPop(logger->deliverQueue, &slot)) {
+            free(slot);
         }
-        logEntry_destroy(&entry);
+        celix_ringBuffer_destroy(logger->deliverQueue);
     }
-    linkedListIterator_destroy(iter);
-
-    array_list_iterator_pt entryIter = arrayListIterator_create(logger->listenerEntries);
-
-    while (arrayListIterator_hasNext(entryIter)) {
-        log_entry_t *entry = arrayListIterator_next(entryIter);
-        logEntry_destroy(&entry);
+    if (logger->freeSlots != NULL) {
+        void *slot = NULL;
+        while (celix_ringBuffer_tryPop(logger->freeSlots, &slot)) {
+            free(slot);
+        }
+        celix_ringBuffer_destroy(logger->freeSlots);
     }
-    arrayListIterator_destroy(entryIter);
-
-    arrayList_destroy(logger->listenerEntries);
-    linkedList_destroy(logger->entries);
+    for (size_t i = 0; i < logger->entriesSize; ++i) {
+        free(logger->entries[(logger->entriesHead + i) % logger->entriesCap]);
+    }
+    free(logger->entries);
 
+    arrayList_destroy(logger->listeners);
+    celixThreadMutex_destroy(&logger->listenerLock);
+    hash_map_iterator_t iter = hashMapIterator_construct(logger->internedNames);
+    while (hashMapIterator_hasNext(&iter)) {
+        free(hashMapIterator_nextKey(&iter));
+    }
+    hashMap_destroy(logger->internedNames, false, false);
+    celixThreadMutex_destroy(&logger->internLock);
     celixThreadMutex_destroy(&logger->lock);
-
     free(logger);
-
-    return status;
+    return CELIX_SUCCESS;
 }
 
-celix_status_t log_addEntry(log_t *log, log_entry_t *entry) {
-    celixThreadMutex_lock(&log->lock);
-
-    if (log->max_size != 0) {
-        if (log->store_debug || entry->level != OSGI_LOGSERVICE_DEBUG) {
-            linkedList_addElement(log->entries, entry);
+const char* log_internName(log_t *log, const char *bundleSymbolicName) {
+    const char *name = bundleSymbolicName != NULL ? bundleSymbolicName : "";
+    celixThreadMutex_lock(&log->internLock);
+    char *interned = hashMap_get(log->internedNames, name);
+    if (interned == NULL) {
+        interned = strdup(name);
+        if (interned != NULL) {
+            hashMap_put(log->internedNames, interned, interned);
         }
     }
+    celixThreadMutex_unlock(&log->internLock);
+    return interned != NULL ? interned : "";
+}
 
-    celixThreadMutex_lock(&log->deliverLock);
-    arrayList_add(log->listenerEntries, entry);
-    celixThreadMutex_unlock(&log->deliverLock);
-
-    celixThreadCondition_signal(&log->entriesToDeliver);
-
-    if (log->max_size != 0) {
-        if (log->max_size != -1) {
-            if (linkedList_size(log->entries) > log->max_size) {
-                log_entry_t *rentry = linkedList_removeFirst(log->entries);
-                if (rentry) {
-                    celixThreadMutex_lock(&log->deliverLock);
-                    arrayList_removeElement(log->listenerEntries, rentry);
-                    logEntry_destroy(&rentry);
-                    celixThreadMutex_unlock(&log->deliverLock);
-                }
-            }
-        }
+celix_status_t log_log(log_t *log, long bundleId, const char *bundleSymbolicName, log_level_t level, const char *message, int errorCode) {
+    if (level > log->max_level) {
+        return CELIX_SUCCESS;
     }
 
-    celixThreadMutex_unlock(&log->lock);
+    void *element = NULL;
+    if (!celix_ringBuffer_tryPop(log->freeSlots, &element)) {
+        //Listeners cannot keep up, drop instead of blocking or allocating. Reported by the deliver thread.
+        __atomic_add_fetch(&log->dropped, 1, __ATOMIC_RELAXED);
+        __atomic_add_fetch(&log->totalDropped, 1, __ATOMIC_RELAXED);
+        return CELIX_ENOMEM;
+    }
 
+    log_slot_t *slot = element;
+    snprintf(slot->message, sizeof(slot->message), "%s", message != NULL ? message : "");
+    slot->entry.bundleSymbolicName = (char *) (bundleSymbolicName != NULL ? bundleSymbolicName : "");
+    slot->entry.message = slot->message;
+    slot->entry.bundleId = bundleId;
+    slot->entry.level = level;
+    slot->entry.errorCode = errorCode;
+    slot->entry.time = time(NULL);
+    clock_gettime(CLOCK_MONOTONIC, &slot->entry.monotonicTime);
+    slot->entry.threadId = logEntry_currentThreadId();
+
+    if (!celix_ringBuffer_tryPush(log->deliverQueue, slot)) {
+        //Closed (or full, which cannot happen because the queue can hold all slots)
+        celix_ringBuffer_tryPush(log->freeSlots, slot);
+        return CELIX_ILLEGAL_STATE;
+    }
     return CELIX_SUCCESS;
 }
 
+void log_collectMetrics(void *handle, const celix_metrics_writer_t *writer) {
+    log_t *log = handle;
+    writer->write(writer->handle, "celix_log_queue_depth", CELIX_METRIC_GAUGE, "Nr of log entries waiting for delivery to the log listeners", NULL, (double)celix_ringBuffer_size(log->deliverQueue));
+    writer->write(writer->handle, "celix_log_queue_capacity", CELIX_METRIC_GAUGE, "Nr of log entries which can wait for delivery", NULL, (double)LOG_DELIVER_QUEUE_SIZE);
+    writer->write(writer->handle, "celix_log_entries_dropped_total", CELIX_METRIC_COUNTER, "Nr of log entries dropped because the log listeners cannot keep up", NULL, (double)__atomic_load_n(&log->totalDropped, __ATOMIC_RELAXED));
+}
+
 celix_status_t log_getEntries(log_t *log, linked_list_pt *list) {
     linked_list_pt entries = NULL;
     if (linkedList_create(&entries) == CELIX_SUCCESS) {
-        linked_list_iterator_pt iter = NULL;
-
         celixThreadMutex_lock(&log->lock);
-
-        iter = linkedListIterator_create(log->entries, 0);
-        while (linkedListIterator_hasNext(iter)) {
-            linkedList_addElement(entries, linkedListIterator_next(iter));
+        for (size_t i = 0; i < log->entriesSize; ++i) {
+            log_slot_t *slot = log->entries[(log->entriesHead + i) % log->entriesCap];
+            linkedList_addElement(entries, &slot->entry);
         }
-        linkedListIterator_destroy(iter);
-
-        *list = entries;
-
         celixThreadMutex_unlock(&log->lock);
 
+        *list = entries;
         return CELIX_SUCCESS;
     } else {
         return CELIX_ENOMEM;
@@ -188,7 +233,6 @@ celix_status_t log_getEntries(log_t *log, linked_list_pt *list) {
 celix_status_t log_bundleChanged(void *listener, celix_bundle_event_t *event) {
     celix_status_t status = CELIX_SUCCESS;
     log_t *logger = ((bundle_listener_t *) listener)->handle;
-    log_entry_t *entry = NULL;
 
     int messagesLength = 10;
     char *messages[] = {
@@ -213,26 +257,15 @@ celix_status_t log_bundleChanged(void *listener, celix_bundle_event_t *event) {
     }
 
     if (message != NULL) {
-        status = logEntry_create(event->bundleId, event->bundleSymbolicName, NULL, OSGI_LOGSERVICE_INFO, message, 0, &entry);
-        if (status == CELIX_SUCCESS) {
-            status = log_addEntry(logger, entry);
-        }
+        status = log_log(logger, event->bundleId, log_internName(logger, event->bundleSymbolicName), OSGI_LOGSERVICE_INFO, message, 0);
     }
 
     return status;
 }
 
 celix_status_t log_frameworkEvent(void *listener, framework_event_pt event) {
-    celix_status_t status;
     log_t *logger = ((framework_listener_pt) listener)->handle;
-    log_entry_t *entry = NULL;
-
-    status = logEntry_create(event->bundleId, event->bundleSymbolicName, NULL, (event->type == OSGI_FRAMEWORK_EVENT_ERROR) ? OSGI_LOGSERVICE_ERROR : OSGI_LOGSERVICE_INFO, event->error, event->errorCode, &entry);
-    if (status == CELIX_SUCCESS) {
-        status = log_addEntry(logger, entry);
-    }
-
-    return status;
+    return log_log(logger, event->bundleId, log_internName(logger, event->bundleSymbolicName), (event->type == OSGI_FRAMEWORK_EVENT_ERROR) ? OSGI_LOGSERVICE_ERROR : OSGI_LOGSERVICE_INFO, event->error, event->errorCode);
 }
 
 celix_status_t log_addLogListener(log_t *logger, log_listener_t *listener) {
@@ -242,7 +275,6 @@ celix_status_t log_addLogListener(log_t *logger, log_listener_t *listener) {
 
     if (status == CELIX_SUCCESS) {
         arrayList_add(logger->listeners, listener);
-        log_startListenerThread(logger);
 
         status = celixThreadMutex_unlock(&logger->listenerLock);
     }
@@ -251,26 +283,15 @@ celix_status_t log_addLogListener(log_t *logger, log_listener_t *listener) {
 }
 
 celix_status_t log_removeLogListener(log_t *logger, log_listener_t *listener) {
-    celix_status_t status = CELIX_SUCCESS;
+    celix_status_t status;
 
-    status += celixThreadMutex_lock(&logger->deliverLock);
-    status += celixThreadMutex_lock(&logger->listenerLock);
+    //note the deliver thread holds the listener lock during delivery, so the listener is not used after this call
+    status = celixThreadMutex_lock(&logger->listenerLock);
 
     if (status == CELIX_SUCCESS) {
-        bool last = false;
-
         arrayList_removeElement(logger->listeners, listener);
-        if (arrayList_size(logger->listeners) == 0) {
-            status = log_stopListenerThread(logger);
-            last = true;
-        }
 
-        status += celixThreadMutex_unlock(&logger->listenerLock);
-        status += celixThreadMutex_unlock(&logger->deliverLock);
-
-        if (last) {
-            status += celixThread_join(logger->listenerThread, NULL);
-        }
+        status = celixThreadMutex_unlock(&logger->listenerLock);
     }
 
     if (status != CELIX_SUCCESS) {
@@ -294,83 +315,98 @@ celix_status_t log_removeAllLogListener(log_t *logger) {
     return status;
 }
 
-static celix_status_t log_startListenerThread(log_t *logger) {
-    celix_status_t status;
-
-    logger->running = true;
-    logger->running = true;
-    status = celixThread_create(&logger->listenerThread, NULL, log_listenerThread, logger);
-
-    return status;
-}
-
-static celix_status_t log_stopListenerThread(log_t *logger) {
-    celix_status_t status;
-
-    logger->running = false;
-
-    status = celixThreadCondition_signal(&logger->entriesToDeliver);
-
-    return status;
-}
-
-static void * log_listenerThread(void *data) {
-    celix_status_t status = CELIX_SUCCESS;
-
+static void *log_deliverThread(void *data) {
     log_t *logger = data;
+    log_slot_t *batch[LOG_DELIVER_BATCH_SIZE];
+
+    void *element = NULL;
+    while (celix_ringBuffer_pop(logger->deliverQueue, &element) == CELIX_SUCCESS) {
+        size_t size = 0;
+        batch[size++] = element;
+        while (size < LOG_DELIVER_BATCH_SIZE && celix_ringBuffer_tryPop(logger->deliverQueue, &element)) {
+            batch[size++] = element;
+        }
+        log_deliverBatch(logger, batch, size);
+    }
+    return NULL;
+}
 
-    while (logger->running) {
-
-        status = celixThreadMutex_lock(&logger->deliverLock);
-
-        if ( status != CELIX_SUCCESS) {
-            logger->running = false;
+static void log_deliverBatch(log_t *logger, log_slot_t **batch, size_t size) {
+    long dropped = __atomic_exchange_n(&logger->dropped, 0, __ATOMIC_RELAXED);
+
+    celixThreadMutex_lock(&logger->listenerLock);
+    unsigned int nrOfListeners = arrayList_size(logger->listeners);
+    for (unsigned int i = 0; i < nrOfListeners; ++i) {
+        log_listener_t *listener = arrayList_get(logger->listeners, i);
+        if (dropped > 0) {
+            log_slot_t report;
+            snprintf(report.message, sizeof(report.message), "%li log entries dropped, log listeners cannot keep up", dropped);
+            report.entry.message = report.message;
+            report.entry.bundleSymbolicName = "apache_celix_log_service";
+            report.entry.bundleId = -1;
+            report.entry.level = OSGI_LOGSERVICE_WARNING;
+            report.entry.errorCode = 0;
+            report.entry.time = time(NULL);
+            clock_gettime(CLOCK_MONOTONIC, &report.entry.monotonicTime);
+            report.entry.threadId = logEntry_currentThreadId();
+            listener->logged(listener->handle, &report.entry);
         }
-        else {
-            if (!arrayList_isEmpty(logger->listenerEntries)) {
-                log_entry_t *entry = (log_entry_t *) arrayList_remove(logger->listenerEntries, 0);
-
-                if (entry) {
-                    status = celixThreadMutex_lock(&logger->listenerLock);
-                    if (status != CELIX_SUCCESS) {
-                        logger->running = false;
-                        break;
-                    } else {
-                        array_list_iterator_pt it = arrayListIterator_create(logger->listeners);
-                        while (arrayListIterator_hasNext(it)) {
-                            log_listener_t *listener = arrayListIterator_next(it);
-                            listener->logged(listener, entry);
-                        }
-                        arrayListIterator_destroy(it);
-
-                        // destroy not-stored entries
-                        if (!(logger->store_debug || entry->level != OSGI_LOGSERVICE_DEBUG)) {
-                            logEntry_destroy(&entry);
-                        }
-
-                        status = celixThreadMutex_unlock(&logger->listenerLock);
-                        if (status != CELIX_SUCCESS) {
-                            logger->running = false;
-                            break;
-                        }
-                    }
-                }
-            }
+        for (size_t k = 0; k < size; ++k) {
+            listener->logged(listener->handle, &batch[k]->entry);
+        }
+        if (listener->flush != NULL) {
+            listener->flush(listener->handle);
+        }
+    }
+    celixThreadMutex_unlock(&logger->listenerLock);
 
-            if (arrayList_isEmpty(logger->listenerEntries) && logger->running) {
-                celixThreadCondition_wait(&logger->entriesToDeliver, &logger->deliverLock);
-            }
+    for (size_t k = 0; k < size; ++k) {
+        log_storeOrRelease(logger, batch[k]);
+    }
+}
 
-            status = celixThreadMutex_unlock(&logger->deliverLock);
+static void log_storeOrRelease(log_t *logger, log_slot_t *slot) {
+    bool store = logger->max_size != 0 && (logger->store_debug || slot->entry.level != OSGI_LOGSERVICE_DEBUG);
+    if (!store) {
+        log_releaseSlot(logger, slot);
+        return;
+    }
 
-            if (status != CELIX_SUCCESS) {
-                logger->running = false;
-                break;
+    log_slot_t *evicted = NULL;
+    celixThreadMutex_lock(&logger->lock);
+    if (logger->entriesSize == logger->entriesCap && logger->max_size < 0) {
+        //Unlimited, grow the store
+        size_t cap = logger->entriesCap * 2;
+        log_slot_t **entries = calloc(cap, sizeof(*entries));
+        if (entries != NULL) {
+            for (size_t i = 0; i < logger->entriesSize; ++i) {
+                entries[i] = logger->entries[(logger->entriesHead + i) % logger->entriesCap];
             }
+            free(logger->entries);
+            logger->entries = entries;
+            logger->entriesHead = 0;
+            logger->entriesCap = cap;
         }
-
     }
+    if (logger->entriesSize == logger->entriesCap) {
+        evicted = logger->entries[logger->entriesHead];
+        logger->entriesHead = (logger->entriesHead + 1) % logger->entriesCap;
+        logger->entriesSize -= 1;
+    }
+    logger->entries[(logger->entriesHead + logger->entriesSize) % logger->entriesCap] = slot;
+    logger->entriesSize += 1;
+    celixThreadMutex_unlock(&logger->lock);
+
+    if (evicted != NULL) {
+        log_releaseSlot(logger, evicted);
+    } else if (logger->max_size < 0) {
+        //Unlimited, the stored slot is replaced by a new slot (allocated here and not when logging)
+        log_releaseSlot(logger, calloc(1, sizeof(log_slot_t)));
+    }
+}
 
-    celixThread_exit(NULL);
-    return NULL;
+static void log_releaseSlot(log_t *logger, log_slot_t *slot) {
+    if (slot != NULL && !celix_ringBuffer_tryPush(logger->freeSlots, slot)) {
+        free(slot);
+    }
 }
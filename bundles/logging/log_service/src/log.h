@@ -30,12 +30,52 @@
 #include "linked_list.h"
 #include "log_entry.h"
 #include "log_listener.h"
+#include "celix_metrics_service.h"
+
+//Inline storage of a log entry message, longer messages are truncated
+#define LOG_SLOT_MAX_MESSAGE_LENGTH     1024
+
+//Nr of entries which can wait for delivery to the log listeners, when full new entries are dropped
+#define LOG_DELIVER_QUEUE_SIZE          1024
+//Max nr of entries delivered to the log listeners at once
+#define LOG_DELIVER_BATCH_SIZE          64
 
 typedef struct log log_t;
 
-celix_status_t log_create(int max_size, bool store_debug, log_t **logger);
+/**
+ * Creates the log. All log entries are preallocated: max_size stored entries and LOG_DELIVER_QUEUE_SIZE entries
+ * waiting for delivery. A max_size of 0 stores nothing, -1 stores all entries.
+ * Entries with a level above max_level are discarded.
+ */
+celix_status_t log_create(int max_size, bool store_debug, log_level_t max_level, log_t **logger);
 celix_status_t log_destroy(log_t *logger);
-celix_status_t log_addEntry(log_t *log, log_entry_t *entry);
+
+/**
+ * Returns the interned copy of a bundle symbolic name, which is valid until the log is destroyed.
+ * Locks, so intern once (e.g. per bundle) and not per log entry.
+ */
+const char* log_internName(log_t *log, const char *bundleSymbolicName);
+
+/**
+ * Logs an entry without locking or allocating. The entry is delivered to the log listeners (and stored) by the
+ * deliver thread of the log. Returns CELIX_ENOMEM if the entry is dropped because the listeners cannot keep up.
+ * The bundle symbolic name must be interned with log_internName, entries refer to it instead of copying it.
+ */
+celix_status_t log_log(log_t *log, long bundleId, const char *bundleSymbolicName, log_level_t level, const char *message, int errorCode);
+
+/**
+ * Returns the id of the calling thread, as stored in log entries.
+ */
+long logEntry_currentThreadId(void);
+
+/**
+ * Collect callback of the log metrics provider service (queue depth and dropped entries), handle is the log.
+ */
+void log_collectMetrics(void *handle, const celix_metrics_writer_t *writer);
+
+/**
+ * Returns the stored entries, oldest first. Note the entries are owned by the log and can be reused for new entries.
+ */
 celix_status_t log_getEntries(log_t *log, linked_list_pt *list);
 
 celix_status_t log_bundleChanged(void *listener, celix_bundle_event_t *event);
@@ -27,10 +27,29 @@
 #include <stddef.h>
 #include <stdlib.h>
 #include <string.h>
+#include <pthread.h>
+#ifdef __linux__
+#include <unistd.h>
+#include <sys/syscall.h>
+#endif
 
 #include "celix_errno.h"
 #include "log_service.h"
 #include "log_entry.h"
+#include "log.h"
+
+static __thread long logEntry_threadId = 0;
+
+long logEntry_currentThreadId(void) {
+    if (logEntry_threadId == 0) {
+#ifdef __linux__
+        logEntry_threadId = (long) syscall(SYS_gettid);
+#else
+        logEntry_threadId = (long) (uintptr_t) pthread_self();
+#endif
+    }
+    return logEntry_threadId;
+}
 
 celix_status_t logEntry_create(long bundleId, const char* bundleSymbolicName , service_reference_pt reference,
                                log_level_t level, char *message, int errorCode,
@@ -45,6 +64,8 @@ celix_status_t logEntry_create(long bundleId, const char* bundleSymbolicName , s
         (*entry)->message = strdup(message);
         (*entry)->errorCode = errorCode;
         (*entry)->time = time(NULL);
+        clock_gettime(CLOCK_MONOTONIC, &(*entry)->monotonicTime);
+        (*entry)->threadId = logEntry_currentThreadId();
 
         (*entry)->bundleSymbolicName = strdup(bundleSymbolicName);
         (*entry)->bundleId = bundleId;
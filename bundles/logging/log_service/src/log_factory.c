@@ -34,9 +34,11 @@
 
 struct log_service_factory {
     log_t *log;
+    long bundleRateLimit;
+    long bundleRateBurst;
 };
 
-celix_status_t logFactory_create(log_t *log, service_factory_pt *factory) {
+celix_status_t logFactory_create(log_t *log, long bundleRateLimit, long bundleRateBurst, service_factory_pt *factory) {
     celix_status_t status = CELIX_SUCCESS;
 
     *factory = calloc(1, sizeof(**factory));
@@ -48,6 +50,8 @@ celix_status_t logFactory_create(log_t *log, service_factory_pt *factory) {
             status = CELIX_ENOMEM;
         } else {
             factoryData->log = log;
+            factoryData->bundleRateLimit = bundleRateLimit;
+            factoryData->bundleRateBurst = bundleRateBurst;
 
             (*factory)->handle = factoryData;
             (*factory)->getService = logFactory_getService;
@@ -76,7 +80,7 @@ celix_status_t logFactory_getService(void *factory, bundle_pt bundle, service_re
     log_service_t *log_service = NULL;
     log_service_data_t *log_service_data = NULL;
 
-    logService_create(log_factory->log, bundle, &log_service_data);
+    logService_create(log_factory->log, bundle, log_factory->bundleRateLimit, log_factory->bundleRateBurst, &log_service_data);
 
     log_service = calloc(1, sizeof(*log_service));
     log_service->logger = log_service_data;
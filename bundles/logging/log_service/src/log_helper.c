@@ -26,6 +26,7 @@
 
 #include <stdlib.h>
 #include <stdarg.h>
+#include <string.h>
 
 #include "bundle_context.h"
 #include "service_tracker.h"
@@ -75,15 +76,26 @@ static char* logHelper_backtrace(void) {
 }
 #endif
 
+typedef struct log_helper_service_entry {
+	log_service_t *svc;
+	log_level_t level; //highest level accepted by the log service
+} log_helper_service_entry_t;
+
 struct log_helper {
 	celix_bundle_context_t *bundleContext;
 	celix_service_tracker_t *logServiceTracker;
 	celix_thread_mutex_t logListLock;
-	array_list_pt logServices;
+	array_list_pt logServices; //log_helper_service_entry_t*
 	bool stdOutFallback;
 	bool stdOutFallbackIncludeDebug;
+
+	//atomic, highest level logged by any log service (or the stdout fallback). 0 if nothing is logged.
+	//Used to return before formatting a message nobody will log.
+	int activeLevel;
 };
 
+static void logHelper_updateActiveLevel(log_helper_t *loghelper);
+
 celix_status_t logHelper_logServiceAdded(void *handle, service_reference_pt reference, void *service);
 celix_status_t logHelper_logServiceRemoved(void *handle, service_reference_pt reference, void *service);
 
@@ -109,6 +121,7 @@ celix_status_t logHelper_create(bundle_context_pt context, log_helper_t **loghel
 
 		pthread_mutex_init(&(*loghelper)->logListLock, NULL);
         arrayList_create(&(*loghelper)->logServices);
+		logHelper_updateActiveLevel(*loghelper);
 	}
 
 	return status;
@@ -135,12 +148,45 @@ celix_status_t logHelper_start(log_helper_t *loghelper)
 
 
 
+static void logHelper_updateActiveLevel(log_helper_t *loghelper) {
+	int level = 0;
+	if (arrayList_size(loghelper->logServices) > 0) {
+		for (int i = 0; i < arrayList_size(loghelper->logServices); i++) {
+			log_helper_service_entry_t *entry = arrayList_get(loghelper->logServices, i);
+			if ((int) entry->level > level) {
+				level = entry->level;
+			}
+		}
+	} else if (loghelper->stdOutFallback) {
+		level = loghelper->stdOutFallbackIncludeDebug ? OSGI_LOGSERVICE_DEBUG : OSGI_LOGSERVICE_INFO;
+	}
+	__atomic_store_n(&loghelper->activeLevel, level, __ATOMIC_RELEASE);
+}
+
 celix_status_t logHelper_logServiceAdded(void *handle, service_reference_pt reference, void *service)
 {
 	log_helper_t *loghelper = handle;
 
+	log_helper_service_entry_t *entry = calloc(1, sizeof(*entry));
+	if (entry == NULL) {
+		return CELIX_ENOMEM;
+	}
+	entry->svc = service;
+	entry->level = OSGI_LOGSERVICE_DEBUG;
+
+	const char *levelStr = NULL;
+	serviceReference_getProperty(reference, OSGI_LOGSERVICE_LEVEL_PROPERTY, &levelStr);
+	if (levelStr != NULL) {
+		char *end = NULL;
+		long level = strtol(levelStr, &end, 10);
+		if (end != levelStr && level >= OSGI_LOGSERVICE_ERROR && level <= OSGI_LOGSERVICE_DEBUG) {
+			entry->level = (log_level_t) level;
+		}
+	}
+
 	pthread_mutex_lock(&loghelper->logListLock);
-	arrayList_add(loghelper->logServices, service);
+	arrayList_add(loghelper->logServices, entry);
+	logHelper_updateActiveLevel(loghelper);
 	pthread_mutex_unlock(&loghelper->logListLock);
 
 	return CELIX_SUCCESS;
@@ -149,14 +195,28 @@ celix_status_t logHelper_logServiceAdded(void *handle, service_reference_pt refe
 celix_status_t logHelper_logServiceRemoved(void *handle, service_reference_pt reference, void *service)
 {
 	log_helper_t *loghelper = handle;
+	log_helper_service_entry_t *found = NULL;
 
 	pthread_mutex_lock(&loghelper->logListLock);
-	arrayList_removeElement(loghelper->logServices, service);
+	for (int i = 0; i < arrayList_size(loghelper->logServices); i++) {
+		log_helper_service_entry_t *entry = arrayList_get(loghelper->logServices, i);
+		if (entry->svc == service) {
+			found = arrayList_remove(loghelper->logServices, i);
+			break;
+		}
+	}
+	logHelper_updateActiveLevel(loghelper);
 	pthread_mutex_unlock(&loghelper->logListLock);
 
+	free(found);
+
 	return CELIX_SUCCESS;
 }
 
+bool logHelper_isEnabled(log_helper_t *loghelper, log_level_t level) {
+	return loghelper != NULL && (int) level <= __atomic_load_n(&loghelper->activeLevel, __ATOMIC_ACQUIRE);
+}
+
 
 celix_status_t logHelper_stop(log_helper_t *loghelper) {
 	celix_status_t status;
@@ -174,6 +234,9 @@ celix_status_t logHelper_destroy(log_helper_t **loghelper) {
         }
 
         pthread_mutex_lock(&(*loghelper)->logListLock);
+        for (int i = 0; i < arrayList_size((*loghelper)->logServices); i++) {
+            free(arrayList_get((*loghelper)->logServices, i));
+        }
         arrayList_destroy((*loghelper)->logServices);
     	pthread_mutex_unlock(&(*loghelper)->logListLock);
 
@@ -199,6 +262,11 @@ celix_status_t logHelper_log(log_helper_t *loghelper, log_level_t level, const c
 	return CELIX_ILLEGAL_ARGUMENT;
     }
 
+    if (!logHelper_isEnabled(loghelper, level)) {
+        //fast path, no log service (or stdout fallback) logs this level; skip the formatting
+        return status;
+    }
+
 	va_start(listPointer, message);
 	vsnprintf(msg, 1024, message, listPointer);
 
@@ -206,15 +274,16 @@ celix_status_t logHelper_log(log_helper_t *loghelper, log_level_t level, const c
 
 	int i = 0;
 	for (; i < arrayList_size(loghelper->logServices); i++) {
-		log_service_t *logService = arrayList_get(loghelper->logServices, i);
-		if (logService != NULL) {
+		log_helper_service_entry_t *entry = arrayList_get(loghelper->logServices, i);
+		log_service_t *logService = entry->svc;
+		logged = true; //a log service filtering the level is still a log service, so no stdout fallback
+		if (logService != NULL && level <= entry->level) {
 			(logService->log)(logService->logger, level, msg); //TODO add backtrace to msg if the level is ERROR
 			if (level == OSGI_LOGSERVICE_ERROR) {
 				char *backtrace = logHelper_backtrace();
 				logService->log(logService->logger, level, backtrace);
 				free(backtrace);
 			}
-			logged = true;
 		}
 	}
 
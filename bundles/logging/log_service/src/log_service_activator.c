@@ -38,9 +38,14 @@
 
 #define DEFAULT_MAX_SIZE 100
 #define DEFAULT_STORE_DEBUG false
+#define DEFAULT_LEVEL OSGI_LOGSERVICE_DEBUG
+#define DEFAULT_BUNDLE_RATE_LIMIT 1000
 
 #define MAX_SIZE_PROPERTY "CELIX_LOG_MAX_SIZE"
 #define STORE_DEBUG_PROPERTY "CELIX_LOG_STORE_DEBUG"
+#define LEVEL_PROPERTY "CELIX_LOG_LEVEL"
+#define BUNDLE_RATE_LIMIT_PROPERTY "CELIX_LOG_BUNDLE_RATE_LIMIT"
+#define BUNDLE_RATE_BURST_PROPERTY "CELIX_LOG_BUNDLE_RATE_BURST"
 
 struct logActivator {
     celix_bundle_context_t *bundleContext;
@@ -54,10 +59,14 @@ struct logActivator {
     service_factory_pt factory;
     log_reader_data_t *reader;
     log_reader_service_t *reader_service;
+
+    celix_metrics_provider_service_t metricsSvc;
+    long metricsSvcId;
 };
 
 static celix_status_t bundleActivator_getMaxSize(struct logActivator *activator, int *max_size);
 static celix_status_t bundleActivator_getStoreDebug(struct logActivator *activator, bool *store_debug);
+static celix_status_t bundleActivator_getLevel(struct logActivator *activator, log_level_t *level);
 
 celix_status_t bundleActivator_create(celix_bundle_context_t *context, void **userData) {
     celix_status_t status = CELIX_SUCCESS;
@@ -76,6 +85,7 @@ celix_status_t bundleActivator_create(celix_bundle_context_t *context, void **us
 		activator->factory = NULL;
 		activator->reader = NULL;
 		activator->reader_service = NULL;
+		activator->metricsSvcId = -1L;
 
         *userData = activator;
     }
@@ -89,11 +99,13 @@ celix_status_t bundleActivator_start(void * userData, celix_bundle_context_t *co
 
     int max_size = 0;
     bool store_debug = false;
+    log_level_t level = DEFAULT_LEVEL;
 
     bundleActivator_getMaxSize(activator, &max_size);
     bundleActivator_getStoreDebug(activator, &store_debug);
+    bundleActivator_getLevel(activator, &level);
 
-    log_create(max_size, store_debug, &activator->logger);
+    log_create(max_size, store_debug, level, &activator->logger);
 
     // Add logger as Bundle- and FrameworkEvent listener
     activator->bundleListener = calloc(1, sizeof(*activator->bundleListener));
@@ -106,11 +118,13 @@ celix_status_t bundleActivator_start(void * userData, celix_bundle_context_t *co
     activator->frameworkListener->frameworkEvent = log_frameworkEvent;
     bundleContext_addFrameworkListener(context, activator->frameworkListener);
 
-    logFactory_create(activator->logger, &activator->factory);
+    long rateLimit = celix_bundleContext_getPropertyAsLong(context, BUNDLE_RATE_LIMIT_PROPERTY, DEFAULT_BUNDLE_RATE_LIMIT);
+    long rateBurst = celix_bundleContext_getPropertyAsLong(context, BUNDLE_RATE_BURST_PROPERTY, rateLimit);
+    logFactory_create(activator->logger, rateLimit, rateBurst, &activator->factory);
 
 	celix_properties_t *props = celix_properties_create();
 	celix_properties_set(props, CELIX_FRAMEWORK_SERVICE_LANGUAGE, CELIX_FRAMEWORK_SERVICE_C_LANGUAGE);
-
+	celix_properties_setLong(props, OSGI_LOGSERVICE_LEVEL_PROPERTY, level);
 
 	bundleContext_registerServiceFactory(context, (char *) OSGI_LOGSERVICE_NAME, activator->factory, props, &activator->logServiceFactoryReg);
 
@@ -128,12 +142,18 @@ celix_status_t bundleActivator_start(void * userData, celix_bundle_context_t *co
 
     bundleContext_registerService(context, (char *) OSGI_LOGSERVICE_READER_SERVICE_NAME, activator->reader_service, props, &activator->logReaderServiceReg);
 
+    activator->metricsSvc.handle = activator->logger;
+    activator->metricsSvc.collect = log_collectMetrics;
+    activator->metricsSvcId = celix_bundleContext_registerService(context, &activator->metricsSvc, CELIX_METRICS_PROVIDER_SERVICE_NAME, NULL);
+
     return status;
 }
 
 celix_status_t bundleActivator_stop(void * userData, celix_bundle_context_t *context) {
 	struct logActivator * activator = (struct logActivator *) userData;
 
+	celix_bundleContext_unregisterService(context, activator->metricsSvcId);
+	activator->metricsSvcId = -1L;
 	serviceRegistration_unregister(activator->logReaderServiceReg);
 	activator->logReaderServiceReg = NULL;
 	serviceRegistration_unregister(activator->logServiceFactoryReg);
@@ -196,3 +216,26 @@ static celix_status_t bundleActivator_getStoreDebug(struct logActivator *activat
 
 	return status;
 }
+
+static celix_status_t bundleActivator_getLevel(struct logActivator *activator, log_level_t *level) {
+	celix_status_t status = CELIX_SUCCESS;
+
+	const char *level_str = NULL;
+
+	*level = DEFAULT_LEVEL;
+
+	bundleContext_getProperty(activator->bundleContext, LEVEL_PROPERTY, &level_str);
+	if (level_str) {
+		if (strcasecmp(level_str, "error") == 0) {
+			*level = OSGI_LOGSERVICE_ERROR;
+		} else if (strcasecmp(level_str, "warning") == 0) {
+			*level = OSGI_LOGSERVICE_WARNING;
+		} else if (strcasecmp(level_str, "info") == 0) {
+			*level = OSGI_LOGSERVICE_INFO;
+		} else if (strcasecmp(level_str, "debug") == 0) {
+			*level = OSGI_LOGSERVICE_DEBUG;
+		}
+	}
+
+	return status;
+}
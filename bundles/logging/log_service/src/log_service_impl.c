@@ -25,6 +25,8 @@
  */
 
 #include <stdlib.h>
+#include <stdio.h>
+#include <time.h>
 
 #include "log_service_impl.h"
 #include "module.h"
@@ -33,9 +35,36 @@
 struct log_service_data {
     log_t *log;
     celix_bundle_t *bundle;
+
+    //resolved once, not per log entry
+    long bundleId;
+    const char *bundleSymbolicName; //interned
+
+    //rate limit (GCRA, i.e. a token bucket with a single atomic state)
+    long rateIntervalInNs;  //0 if unlimited
+    long rateToleranceInNs; //burst
+    long tat;               //atomic, theoretical arrival time in ns
+    long dropped;           //atomic, nr of entries dropped by the rate limit
 };
 
-celix_status_t logService_create(log_t *log, celix_bundle_t *bundle, log_service_data_t **logger) {
+static celix_status_t logService_getBundleInfo(celix_bundle_t *bundle, long *bundleId, const char **symbolicName) {
+    bundle_archive_pt archive = NULL;
+    module_pt module = NULL;
+
+    celix_status_t status = bundle_getArchive(bundle, &archive);
+    if (status == CELIX_SUCCESS) {
+        status = bundleArchive_getId(archive, bundleId);
+    }
+    if (status == CELIX_SUCCESS) {
+        status = bundle_getCurrentModule(bundle, &module);
+    }
+    if (status == CELIX_SUCCESS) {
+        status = module_getSymbolicName(module, symbolicName);
+    }
+    return status;
+}
+
+celix_status_t logService_create(log_t *log, celix_bundle_t *bundle, long rateLimit, long rateBurst, log_service_data_t **logger) {
     celix_status_t status = CELIX_SUCCESS;
     *logger = calloc(1, sizeof(struct log_service_data));
     if (*logger == NULL) {
@@ -43,6 +72,17 @@ celix_status_t logService_create(log_t *log, celix_bundle_t *bundle, log_service
     } else {
         (*logger)->bundle = bundle;
         (*logger)->log = log;
+        (*logger)->bundleId = -1;
+
+        const char *symbolicName = NULL;
+        if (logService_getBundleInfo(bundle, &(*logger)->bundleId, &symbolicName) == CELIX_SUCCESS && symbolicName != NULL) {
+            (*logger)->bundleSymbolicName = log_internName(log, symbolicName);
+        }
+
+        if (rateLimit > 0) {
+            (*logger)->rateIntervalInNs = 1000000000L / rateLimit;
+            (*logger)->rateToleranceInNs = (*logger)->rateIntervalInNs * (rateBurst > 1 ? rateBurst - 1 : 0);
+        }
     }
 
     return status;
@@ -57,41 +97,64 @@ celix_status_t logService_destroy(log_service_data_t **logger) {
     return status;
 }
 
+/**
+ * Returns whether the bundle is within its log rate limit. Lock free.
+ */
+static bool logService_withinRateLimit(log_service_data_t *logger) {
+    if (logger->rateIntervalInNs == 0) {
+        return true;
+    }
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    long now = ts.tv_sec * 1000000000L + ts.tv_nsec;
+
+    long tat = __atomic_load_n(&logger->tat, __ATOMIC_RELAXED);
+    long newTat;
+    do {
+        long start = tat > now ? tat : now;
+        if (start - now > logger->rateToleranceInNs) {
+            return false;
+        }
+        newTat = start + logger->rateIntervalInNs;
+    } while (!__atomic_compare_exchange_n(&logger->tat, &tat, newTat, false, __ATOMIC_RELAXED, __ATOMIC_RELAXED));
+    return true;
+}
+
 celix_status_t logService_log(log_service_data_t *logger, log_level_t level, char * message) {
     return logService_logSr(logger, NULL, level, message);
 }
 
 celix_status_t logService_logSr(log_service_data_t *logger, service_reference_pt reference, log_level_t level, char * message) {
-    celix_status_t status;
-    log_entry_t *entry = NULL;
-    celix_bundle_t *bundle = logger->bundle;
-    bundle_archive_pt archive = NULL;
-    module_pt module = NULL;
-    const char *symbolicName = NULL;
-    long bundleId = -1;
+    celix_status_t status = CELIX_SUCCESS;
+    const char *symbolicName = logger->bundleSymbolicName;
+    long bundleId = logger->bundleId;
 
     if (reference != NULL) {
-        serviceReference_getBundle(reference, &bundle);
+        celix_bundle_t *bundle = NULL;
+        const char *name = NULL;
+        status = serviceReference_getBundle(reference, &bundle);
+        if (status == CELIX_SUCCESS) {
+            status = logService_getBundleInfo(bundle, &bundleId, &name);
+        }
+        symbolicName = status == CELIX_SUCCESS && name != NULL ? log_internName(logger->log, name) : NULL;
     }
 
-    status = bundle_getArchive(bundle, &archive);
-
-    if (status == CELIX_SUCCESS) {
-        status = bundleArchive_getId(archive, &bundleId);
+    if (status != CELIX_SUCCESS || symbolicName == NULL || message == NULL) {
+        return status;
     }
 
-    if (status == CELIX_SUCCESS) {
-        status = bundle_getCurrentModule(bundle, &module);
-
-        if (status == CELIX_SUCCESS) {
-            status = module_getSymbolicName(module, &symbolicName);
-        }
+    if (!logService_withinRateLimit(logger)) {
+        __atomic_add_fetch(&logger->dropped, 1, __ATOMIC_RELAXED);
+        return CELIX_SUCCESS;
     }
 
-    if(status == CELIX_SUCCESS && symbolicName != NULL && message != NULL){
-        status = logEntry_create(bundleId, symbolicName, reference, level, message, 0, &entry);
-        log_addEntry(logger->log, entry);
+    long dropped = __atomic_load_n(&logger->dropped, __ATOMIC_RELAXED) > 0 ? __atomic_exchange_n(&logger->dropped, 0, __ATOMIC_RELAXED) : 0;
+    if (dropped > 0) {
+        char report[128];
+        snprintf(report, sizeof(report), "%li log entries of this bundle dropped by the rate limit", dropped);
+        log_log(logger->log, bundleId, symbolicName, OSGI_LOGSERVICE_WARNING, report, 0);
     }
+    log_log(logger->log, bundleId, symbolicName, level, message, 0);
 
     return status;
 }
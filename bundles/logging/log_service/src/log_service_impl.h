@@ -30,7 +30,11 @@
 #include "log_service.h"
 #include "log.h"
 
-celix_status_t logService_create(log_t *log, celix_bundle_t *bundle, log_service_data_t **logger);
+/**
+ * Creates the log service data of a bundle. A rateLimit > 0 limits the nr of entries per second the bundle can log,
+ * with bursts up to rateBurst entries. Entries above the limit are dropped and reported.
+ */
+celix_status_t logService_create(log_t *log, celix_bundle_t *bundle, long rateLimit, long rateBurst, log_service_data_t **logger);
 celix_status_t logService_destroy(log_service_data_t **logger);
 celix_status_t logService_log(log_service_data_t *logger, log_level_t level, char * message);
 celix_status_t logService_logSr(log_service_data_t *logger, service_reference_pt reference, log_level_t level, char * message);
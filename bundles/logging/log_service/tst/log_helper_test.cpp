@@ -0,0 +1,119 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *  KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include "celix_api.h"
+#include "celix_framework_factory.h"
+#include "log_helper.h"
+#include "log_service.h"
+
+#include <CppUTest/TestHarness.h>
+
+namespace {
+    struct counting_log {
+        log_service_t svc{};
+        int count{0};
+
+        counting_log() {
+            svc.logger = reinterpret_cast<log_service_data_t*>(this);
+            svc.log = [](log_service_data_t *logger, log_level_t /*level*/, char */*message*/) -> celix_status_t {
+                reinterpret_cast<counting_log*>(logger)->count += 1;
+                return CELIX_SUCCESS;
+            };
+        }
+    };
+
+    int nrOfFormats = 0;
+
+    const char* countFormat() {
+        nrOfFormats += 1;
+        return "formatted";
+    }
+}
+
+TEST_GROUP(LogHelperTests) {
+    celix_framework_t *fw = nullptr;
+    celix_bundle_context_t *ctx = nullptr;
+    log_helper_t *helper = nullptr;
+
+    void setup() {
+        celix_properties_t *props = celix_properties_create();
+        celix_properties_set(props, "LOGHELPER_ENABLE_STDOUT_FALLBACK", "false");
+        celix_properties_set(props, "org.osgi.framework.storage.clean", "onFirstInit");
+        celix_properties_set(props, "org.osgi.framework.storage", ".cacheLogHelperTest");
+        fw = celix_frameworkFactory_createFramework(props);
+        ctx = celix_framework_getFrameworkContext(fw);
+        CHECK_EQUAL(CELIX_SUCCESS, logHelper_create(ctx, &helper));
+        CHECK_EQUAL(CELIX_SUCCESS, logHelper_start(helper));
+        nrOfFormats = 0;
+    }
+
+    void teardown() {
+        logHelper_stop(helper);
+        logHelper_destroy(&helper);
+        celix_frameworkFactory_destroyFramework(fw);
+    }
+
+    long registerLog(counting_log &log, const char *level) {
+        celix_properties_t *props = celix_properties_create();
+        if (level != nullptr) {
+            celix_properties_set(props, OSGI_LOGSERVICE_LEVEL_PROPERTY, level);
+        }
+        return celix_bundleContext_registerService(ctx, &log.svc, OSGI_LOGSERVICE_NAME, props);
+    }
+};
+
+TEST(LogHelperTests, disabledWithoutLogServices) {
+    CHECK(!logHelper_isEnabled(helper, OSGI_LOGSERVICE_ERROR));
+    logHelper_log(helper, OSGI_LOGSERVICE_ERROR, "%s", countFormat());
+    //the arguments are evaluated, but nothing is formatted or logged
+    CHECK_EQUAL(1, nrOfFormats);
+}
+
+TEST(LogHelperTests, levelOfLogServices) {
+    counting_log warningLog{};
+    long warningId = registerLog(warningLog, "2");
+    CHECK(logHelper_isEnabled(helper, OSGI_LOGSERVICE_ERROR));
+    CHECK(logHelper_isEnabled(helper, OSGI_LOGSERVICE_WARNING));
+    CHECK(!logHelper_isEnabled(helper, OSGI_LOGSERVICE_INFO));
+
+    logHelper_log(helper, OSGI_LOGSERVICE_INFO, "skipped");
+    CHECK_EQUAL(0, warningLog.count);
+    logHelper_log(helper, OSGI_LOGSERVICE_WARNING, "logged");
+    CHECK_EQUAL(1, warningLog.count);
+
+    //the highest level of all log services is enabled, but each log service only gets its own levels
+    counting_log debugLog{};
+    long debugId = registerLog(debugLog, nullptr);
+    CHECK(logHelper_isEnabled(helper, OSGI_LOGSERVICE_DEBUG));
+    logHelper_log(helper, OSGI_LOGSERVICE_DEBUG, "debug");
+    CHECK_EQUAL(1, warningLog.count);
+    CHECK_EQUAL(1, debugLog.count);
+
+    celix_bundleContext_unregisterService(ctx, debugId);
+    CHECK(!logHelper_isEnabled(helper, OSGI_LOGSERVICE_INFO));
+    celix_bundleContext_unregisterService(ctx, warningId);
+    CHECK(!logHelper_isEnabled(helper, OSGI_LOGSERVICE_ERROR));
+}
+
+TEST(LogHelperTests, invalidLevelAcceptsAll) {
+    counting_log log{};
+    long id = registerLog(log, "verbose");
+    CHECK(logHelper_isEnabled(helper, OSGI_LOGSERVICE_DEBUG));
+    celix_bundleContext_unregisterService(ctx, id);
+}
@@ -0,0 +1,158 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *  KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+#include <thread>
+#include <chrono>
+#include <mutex>
+#include <vector>
+#include <string>
+
+#include "celix_api.h"
+#include "celix_framework_factory.h"
+extern "C" {
+#include "log.h"
+#include "log_service_impl.h"
+}
+
+#include <CppUTest/TestHarness.h>
+
+namespace {
+    struct logged_entry {
+        long bundleId;
+        std::string bundleSymbolicName;
+        log_level_t level;
+        std::string message;
+        long threadId;
+        struct timespec monotonicTime;
+    };
+
+    struct collected_entries {
+        std::mutex mutex{};
+        std::vector<logged_entry> entries{};
+
+        static celix_status_t logged(void *handle, log_entry_t *entry) {
+            auto *collected = static_cast<collected_entries*>(handle);
+            std::lock_guard<std::mutex> lock{collected->mutex};
+            collected->entries.push_back(logged_entry{entry->bundleId, entry->bundleSymbolicName, entry->level,
+                                                      entry->message, entry->threadId, entry->monotonicTime});
+            return CELIX_SUCCESS;
+        }
+
+        std::vector<logged_entry> waitFor(size_t count) {
+            auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds{10};
+            for (;;) {
+                {
+                    std::lock_guard<std::mutex> lock{mutex};
+                    if (entries.size() >= count || std::chrono::steady_clock::now() > deadline) {
+                        return entries;
+                    }
+                }
+                std::this_thread::sleep_for(std::chrono::milliseconds{1});
+            }
+        }
+    };
+}
+
+TEST_GROUP(LogServiceImplTests) {
+    celix_framework_t *fw = nullptr;
+    celix_bundle_t *bundle = nullptr;
+    log_t *log = nullptr;
+    collected_entries collected{};
+    log_listener_t listener{};
+
+    void setup() {
+        celix_properties_t *properties = celix_properties_create();
+        celix_properties_set(properties, "LOGHELPER_ENABLE_STDOUT_FALLBACK", "true");
+        celix_properties_set(properties, "org.osgi.framework.storage.clean", "onFirstInit");
+        celix_properties_set(properties, "org.osgi.framework.storage", ".cacheLogServiceImplTestFramework");
+        fw = celix_frameworkFactory_createFramework(properties);
+        bundle = celix_bundleContext_getBundle(celix_framework_getFrameworkContext(fw));
+
+        CHECK_EQUAL(CELIX_SUCCESS, log_create(0, true, OSGI_LOGSERVICE_DEBUG, &log));
+        listener.handle = &collected;
+        listener.logged = collected_entries::logged;
+        log_addLogListener(log, &listener);
+    }
+
+    void teardown() {
+        log_removeLogListener(log, &listener);
+        log_destroy(log);
+        celix_frameworkFactory_destroyFramework(fw);
+    }
+};
+
+TEST(LogServiceImplTests, entriesCarryBundleAndThreadInfo) {
+    log_service_data_t *logger = nullptr;
+    CHECK_EQUAL(CELIX_SUCCESS, logService_create(log, bundle, 0, 0, &logger));
+    CHECK_EQUAL(CELIX_SUCCESS, logService_log(logger, OSGI_LOGSERVICE_INFO, (char*)"test"));
+
+    auto entries = collected.waitFor(1);
+    CHECK_EQUAL(1, (int)entries.size());
+    CHECK_EQUAL(celix_bundle_getId(bundle), entries[0].bundleId);
+    STRCMP_EQUAL(celix_bundle_getSymbolicName(bundle), entries[0].bundleSymbolicName.c_str());
+    CHECK_EQUAL(OSGI_LOGSERVICE_INFO, entries[0].level);
+    STRCMP_EQUAL("test", entries[0].message.c_str());
+    CHECK_EQUAL(logEntry_currentThreadId(), entries[0].threadId);
+    CHECK(entries[0].monotonicTime.tv_sec != 0 || entries[0].monotonicTime.tv_nsec != 0);
+
+    //names are interned once per log
+    const char *name = log_internName(log, celix_bundle_getSymbolicName(bundle));
+    POINTERS_EQUAL(name, log_internName(log, celix_bundle_getSymbolicName(bundle)));
+
+    logService_destroy(&logger);
+}
+
+TEST(LogServiceImplTests, rateLimitDropsAndReports) {
+    //10 entries per second (an interval of 100ms) with bursts of 3 entries
+    log_service_data_t *logger = nullptr;
+    CHECK_EQUAL(CELIX_SUCCESS, logService_create(log, bundle, 10, 3, &logger));
+    for (int i = 0; i < 10; ++i) {
+        std::string msg = "msg" + std::to_string(i);
+        CHECK_EQUAL(CELIX_SUCCESS, logService_log(logger, OSGI_LOGSERVICE_INFO, (char*)msg.c_str()));
+    }
+    auto entries = collected.waitFor(3);
+    std::this_thread::sleep_for(std::chrono::milliseconds{10});
+    {
+        std::lock_guard<std::mutex> lock{collected.mutex};
+        CHECK_EQUAL(3, (int)collected.entries.size());
+        STRCMP_EQUAL("msg0", collected.entries[0].message.c_str());
+        STRCMP_EQUAL("msg2", collected.entries[2].message.c_str());
+    }
+
+    //after an interval the next entry is accepted and preceded by the report of the dropped entries
+    std::this_thread::sleep_for(std::chrono::milliseconds{150});
+    CHECK_EQUAL(CELIX_SUCCESS, logService_log(logger, OSGI_LOGSERVICE_INFO, (char*)"after"));
+    entries = collected.waitFor(5);
+    CHECK_EQUAL(5, (int)entries.size());
+    CHECK_EQUAL(OSGI_LOGSERVICE_WARNING, entries[3].level);
+    STRCMP_EQUAL("7 log entries of this bundle dropped by the rate limit", entries[3].message.c_str());
+    STRCMP_EQUAL("after", entries[4].message.c_str());
+
+    logService_destroy(&logger);
+}
+
+TEST(LogServiceImplTests, unlimitedWithoutRateLimit) {
+    log_service_data_t *logger = nullptr;
+    CHECK_EQUAL(CELIX_SUCCESS, logService_create(log, bundle, 0, 0, &logger));
+    for (int i = 0; i < 100; ++i) {
+        CHECK_EQUAL(CELIX_SUCCESS, logService_log(logger, OSGI_LOGSERVICE_INFO, (char*)"msg"));
+    }
+    auto entries = collected.waitFor(100);
+    CHECK_EQUAL(100, (int)entries.size());
+    logService_destroy(&logger);
+}
@@ -0,0 +1,233 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *  KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <thread>
+#include <chrono>
+#include <mutex>
+#include <vector>
+#include <cstdio>
+
+extern "C" {
+#include "log.h"
+#include "linked_list_iterator.h"
+}
+
+#include <CppUTest/TestHarness.h>
+
+namespace {
+    constexpr int NR_OF_PRODUCERS = 8;
+    constexpr int NR_OF_ENTRIES_PER_PRODUCER = 5000;
+    constexpr int STORE_SIZE = 100;
+
+    struct received_entries {
+        std::mutex mutex{};
+        std::vector<std::vector<int>> sequences = std::vector<std::vector<int>>(NR_OF_PRODUCERS);
+        int total = 0;
+    };
+
+    celix_status_t logged(void *handle, log_entry_t *entry) {
+        auto *received = static_cast<received_entries*>(handle);
+        int producer = -1;
+        int seq = -1;
+        if (entry->bundleId < 0 || sscanf(entry->message, "%d:%d", &producer, &seq) != 2) {
+            return CELIX_SUCCESS; //e.g. the report of dropped entries
+        }
+        std::lock_guard<std::mutex> lock{received->mutex};
+        received->sequences.at(producer).push_back(seq);
+        received->total += 1;
+        return CELIX_SUCCESS;
+    }
+}
+
+TEST_GROUP(LogTests) {
+};
+
+TEST(LogTests, concurrentProducers) {
+    log_t *log = nullptr;
+    CHECK_EQUAL(CELIX_SUCCESS, log_create(STORE_SIZE, true, OSGI_LOGSERVICE_DEBUG, &log));
+
+    received_entries received{};
+    log_listener_t listener{};
+    listener.handle = &received;
+    listener.logged = logged;
+    log_addLogListener(log, &listener);
+
+    const char *name = log_internName(log, "producer");
+    std::vector<std::thread> producers{};
+    for (int p = 0; p < NR_OF_PRODUCERS; ++p) {
+        producers.emplace_back([log, name, p]{
+            char msg[32];
+            for (int i = 0; i < NR_OF_ENTRIES_PER_PRODUCER; ++i) {
+                snprintf(msg, sizeof(msg), "%d:%d", p, i);
+                //a dropped entry is reported with CELIX_ENOMEM, retry so that every entry is logged once
+                while (log_log(log, p, name, OSGI_LOGSERVICE_INFO, msg, 0) == CELIX_ENOMEM) {
+                    std::this_thread::yield();
+                }
+            }
+        });
+    }
+    for (auto &producer : producers) {
+        producer.join();
+    }
+
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds{10};
+    for (;;) {
+        {
+            std::lock_guard<std::mutex> lock{received.mutex};
+            if (received.total >= NR_OF_PRODUCERS * NR_OF_ENTRIES_PER_PRODUCER || std::chrono::steady_clock::now() > deadline) {
+                break;
+            }
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds{1});
+    }
+
+    //every entry is delivered once and in the order of its producer
+    {
+        std::lock_guard<std::mutex> lock{received.mutex};
+        CHECK_EQUAL(NR_OF_PRODUCERS * NR_OF_ENTRIES_PER_PRODUCER, received.total);
+        for (int p = 0; p < NR_OF_PRODUCERS; ++p) {
+            const auto &seqs = received.sequences[p];
+            CHECK_EQUAL(NR_OF_ENTRIES_PER_PRODUCER, (int)seqs.size());
+            for (int i = 0; i < (int)seqs.size(); ++i) {
+                CHECK_EQUAL(i, seqs[i]);
+            }
+        }
+    }
+
+    //the store keeps the last entries, also in producer order
+    linked_list_pt entries = nullptr;
+    log_getEntries(log, &entries);
+    CHECK_EQUAL(STORE_SIZE, linkedList_size(entries));
+    std::vector<int> lastSeq(NR_OF_PRODUCERS, -1);
+    linked_list_iterator_pt iter = linkedListIterator_create(entries, 0);
+    while (linkedListIterator_hasNext(iter)) {
+        auto *entry = static_cast<log_entry_t*>(linkedListIterator_next(iter));
+        int producer = -1;
+        int seq = -1;
+        CHECK_EQUAL(2, sscanf(entry->message, "%d:%d", &producer, &seq));
+        CHECK(seq > lastSeq.at(producer));
+        lastSeq[producer] = seq;
+    }
+    linkedListIterator_destroy(iter);
+    linkedList_destroy(entries);
+
+    log_removeLogListener(log, &listener);
+    log_destroy(log);
+}
+
+TEST(LogTests, entriesAboveMaxLevelDiscarded) {
+    log_t *log = nullptr;
+    CHECK_EQUAL(CELIX_SUCCESS, log_create(STORE_SIZE, true, OSGI_LOGSERVICE_WARNING, &log));
+
+    received_entries received{};
+    log_listener_t listener{};
+    listener.handle = &received;
+    listener.logged = logged;
+    log_addLogListener(log, &listener);
+
+    const char *name = log_internName(log, "producer");
+    CHECK_EQUAL(CELIX_SUCCESS, log_log(log, 0, name, OSGI_LOGSERVICE_DEBUG, "0:0", 0));
+    CHECK_EQUAL(CELIX_SUCCESS, log_log(log, 0, name, OSGI_LOGSERVICE_INFO, "0:1", 0));
+    CHECK_EQUAL(CELIX_SUCCESS, log_log(log, 0, name, OSGI_LOGSERVICE_WARNING, "0:2", 0));
+    CHECK_EQUAL(CELIX_SUCCESS, log_log(log, 0, name, OSGI_LOGSERVICE_ERROR, "0:3", 0));
+
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds{10};
+    for (;;) {
+        {
+            std::lock_guard<std::mutex> lock{received.mutex};
+            if (received.total >= 2 || std::chrono::steady_clock::now() > deadline) {
+                break;
+            }
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds{1});
+    }
+
+    {
+        std::lock_guard<std::mutex> lock{received.mutex};
+        CHECK_EQUAL(2, received.total);
+        CHECK_EQUAL(2, (int)received.sequences[0].size());
+        CHECK_EQUAL(2, received.sequences[0][0]);
+        CHECK_EQUAL(3, received.sequences[0][1]);
+    }
+
+    log_removeLogListener(log, &listener);
+    log_destroy(log);
+}
+
+namespace {
+    struct flushed_entries {
+        received_entries received{};
+        int nrOfFlushes = 0;
+        int totalAtLastFlush = 0;
+    };
+
+    celix_status_t flushed(void *handle) {
+        auto *flushes = static_cast<flushed_entries*>(handle);
+        std::lock_guard<std::mutex> lock{flushes->received.mutex};
+        flushes->nrOfFlushes += 1;
+        flushes->totalAtLastFlush = flushes->received.total;
+        return CELIX_SUCCESS;
+    }
+
+    celix_status_t loggedBeforeFlush(void *handle, log_entry_t *entry) {
+        return logged(&static_cast<flushed_entries*>(handle)->received, entry);
+    }
+}
+
+TEST(LogTests, listenerFlushedAfterBatch) {
+    log_t *log = nullptr;
+    CHECK_EQUAL(CELIX_SUCCESS, log_create(STORE_SIZE, true, OSGI_LOGSERVICE_DEBUG, &log));
+
+    flushed_entries flushes{};
+    log_listener_t listener{};
+    listener.handle = &flushes;
+    listener.logged = loggedBeforeFlush;
+    listener.flush = flushed;
+    log_addLogListener(log, &listener);
+
+    const char *name = log_internName(log, "producer");
+    for (int i = 0; i < 10; ++i) {
+        char msg[32];
+        snprintf(msg, sizeof(msg), "0:%d", i);
+        CHECK_EQUAL(CELIX_SUCCESS, log_log(log, 0, name, OSGI_LOGSERVICE_INFO, msg, 0));
+    }
+
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds{10};
+    for (;;) {
+        {
+            std::lock_guard<std::mutex> lock{flushes.received.mutex};
+            if (flushes.totalAtLastFlush >= 10 || std::chrono::steady_clock::now() > deadline) {
+                break;
+            }
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds{1});
+    }
+
+    //every delivered batch is followed by a flush, so the last flush comes after the last entry
+    {
+        std::lock_guard<std::mutex> lock{flushes.received.mutex};
+        CHECK_EQUAL(10, flushes.received.total);
+        CHECK_EQUAL(10, flushes.totalAtLastFlush);
+        CHECK(flushes.nrOfFlushes >= 1);
+        CHECK(flushes.nrOfFlushes <= 10);
+    }
+
+    log_removeLogListener(log, &listener);
+    log_destroy(log);
+}
@@ -30,4 +30,9 @@ celix_log_writer_t* celix_logWriter_create(celix_bundle_context_t *ctx);
 void celix_logWriter_destroy(celix_log_writer_t *writer);
 celix_status_t celix_logWriter_logged(celix_log_writer_t *writer, log_entry_t *entry);
 
+/**
+ * Called after a batch of entries is delivered to celix_logWriter_logged. Buffering writers write out the batch.
+ */
+celix_status_t celix_logWriter_flush(celix_log_writer_t *writer);
+
 #endif /* CELIX_LOG_WRITER_H_ */
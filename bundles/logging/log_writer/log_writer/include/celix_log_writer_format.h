@@ -0,0 +1,53 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *  KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#ifndef CELIX_LOG_WRITER_FORMAT_H_
+#define CELIX_LOG_WRITER_FORMAT_H_
+
+#include <stddef.h>
+
+#include "celix_api.h"
+#include "log_entry.h"
+
+#define CELIX_LOG_WRITER_FORMAT_NAME        "CELIX_LOG_WRITER_FORMAT"
+#define CELIX_LOG_WRITER_FORMAT_DEFAULT     "text"
+
+/**
+ * Formats log entries as:
+ *  - "text":   "LogWriter: <message> from <bundle symbolic name>" lines.
+ *  - "json":   JSON lines with the fields time, mono_ns, level, bundle_id, bundle, thread, error_code and message.
+ *  - "binary": length-prefixed little endian records. Every record starts with an uint32 length (of the remainder of
+ *              the record) and an uint8 type:
+ *              - 1 (name):  uint32 name id, name bytes. Written before the first entry referring to the name.
+ *              - 2 (entry): uint64 mono_ns, int64 time, int64 bundle_id, int64 thread, uint8 level, int32 error_code,
+ *                           uint32 name id, message bytes.
+ * Not thread safe, calls should be serialized by the log writer.
+ */
+typedef struct celix_log_writer_format celix_log_writer_format_t; //opaque pointer
+
+celix_log_writer_format_t* celix_logWriterFormat_create(celix_bundle_context_t *ctx);
+void celix_logWriterFormat_destroy(celix_log_writer_format_t *format);
+
+/**
+ * Formats the entry in buf and returns the nr of bytes written (not NUL terminated).
+ * Messages are truncated to fit in buf. Returns 0 if buf cannot hold the entry at all.
+ */
+size_t celix_logWriterFormat_format(celix_log_writer_format_t *format, const log_entry_t *entry, char *buf, size_t bufLen);
+
+#endif /* CELIX_LOG_WRITER_FORMAT_H_ */
@@ -0,0 +1,58 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *  KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#ifndef CELIX_LOG_WRITER_THROTTLE_H_
+#define CELIX_LOG_WRITER_THROTTLE_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "celix_api.h"
+#include "log_entry.h"
+
+#define CELIX_LOG_WRITER_RATE_LIMIT_NAME        "CELIX_LOG_WRITER_RATE_LIMIT"
+#define CELIX_LOG_WRITER_RATE_LIMIT_DEFAULT     1000 //entries per second, 0 is unlimited
+
+#define CELIX_LOG_WRITER_DEDUP_NAME             "CELIX_LOG_WRITER_DEDUP"
+#define CELIX_LOG_WRITER_DEDUP_DEFAULT          true
+
+/**
+ * Suppresses repeated log entries and limits the rate of written log entries, so that a log storm does not
+ * flood the output. Errors are never rate limited.
+ * Not thread safe, calls should be serialized by the log writer.
+ */
+typedef struct celix_log_writer_throttle celix_log_writer_throttle_t; //opaque pointer
+
+celix_log_writer_throttle_t* celix_logWriterThrottle_create(celix_bundle_context_t *ctx);
+void celix_logWriterThrottle_destroy(celix_log_writer_throttle_t *throttle);
+
+/**
+ * Returns whether the entry should be written.
+ * If entries were suppressed before this (accepted) entry, a line summarizing them is printed in summary
+ * and should be written before the entry. Otherwise summary is an empty string.
+ */
+bool celix_logWriterThrottle_accept(celix_log_writer_throttle_t *throttle, const log_entry_t *entry, char *summary, size_t summaryLen);
+
+/**
+ * Prints a line summarizing the entries suppressed since the last accepted entry in summary.
+ * Returns false (and an empty summary) if no entries were suppressed.
+ */
+bool celix_logWriterThrottle_summary(celix_log_writer_throttle_t *throttle, char *summary, size_t summaryLen);
+
+#endif /* CELIX_LOG_WRITER_THROTTLE_H_ */
@@ -44,6 +44,7 @@ static celix_status_t logWriterActivator_start(celix_logwriter_activator_t *act,
     act->writer = celix_logWriter_create(ctx);
 	act->listener.handle = act->writer;
 	act->listener.logged = (void*)celix_logWriter_logged;
+	act->listener.flush = (void*)celix_logWriter_flush;
 	act->svcTracker = -1L;
 	if (act->writer != NULL) {
 		celix_service_tracking_options_t opts = CELIX_EMPTY_SERVICE_TRACKING_OPTIONS;
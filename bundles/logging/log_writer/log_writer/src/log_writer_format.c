@@ -0,0 +1,212 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *  KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <strings.h>
+
+#include "celix_log_writer_format.h"
+#include "hash_map.h"
+#include "utils.h"
+
+#define FORMAT_BINARY_RECORD_NAME   1
+#define FORMAT_BINARY_RECORD_ENTRY  2
+
+typedef enum celix_log_writer_format_type {
+    CELIX_LOG_WRITER_FORMAT_TEXT,
+    CELIX_LOG_WRITER_FORMAT_JSON,
+    CELIX_LOG_WRITER_FORMAT_BINARY
+} celix_log_writer_format_type_e;
+
+struct celix_log_writer_format {
+    celix_log_writer_format_type_e type;
+    hash_map_pt nameIds; //binary only, bundle symbolic name -> name id (as pointer)
+    uint32_t nextNameId;
+};
+
+celix_log_writer_format_t* celix_logWriterFormat_create(celix_bundle_context_t *ctx) {
+    celix_log_writer_format_t *format = calloc(1, sizeof(*format));
+    if (format != NULL) {
+        const char *type = celix_bundleContext_getProperty(ctx, CELIX_LOG_WRITER_FORMAT_NAME, CELIX_LOG_WRITER_FORMAT_DEFAULT);
+        if (type != NULL && strcasecmp(type, "json") == 0) {
+            format->type = CELIX_LOG_WRITER_FORMAT_JSON;
+        } else if (type != NULL && strcasecmp(type, "binary") == 0) {
+            format->type = CELIX_LOG_WRITER_FORMAT_BINARY;
+        } else {
+            format->type = CELIX_LOG_WRITER_FORMAT_TEXT;
+        }
+        format->nameIds = hashMap_create(utils_stringHash, NULL, utils_stringEquals, NULL);
+        format->nextNameId = 1;
+    }
+    return format;
+}
+
+void celix_logWriterFormat_destroy(celix_log_writer_format_t *format) {
+    if (format != NULL) {
+        hashMap_destroy(format->nameIds, true, false);
+        free(format);
+    }
+}
+
+static const char* celix_logWriterFormat_levelName(log_level_t level) {
+    switch (level) {
+        case OSGI_LOGSERVICE_ERROR:
+            return "ERROR";
+        case OSGI_LOGSERVICE_WARNING:
+            return "WARNING";
+        case OSGI_LOGSERVICE_INFO:
+            return "INFO";
+        default:
+            return "DEBUG";
+    }
+}
+
+static size_t celix_logWriterFormat_text(const log_entry_t *entry, char *buf, size_t bufLen) {
+    int len = snprintf(buf, bufLen, "LogWriter: %s from %s\n", entry->message, entry->bundleSymbolicName);
+    if (len < 0 || bufLen < 2) {
+        return 0;
+    } else if ((size_t) len >= bufLen) {
+        buf[bufLen - 2] = '\n';
+        return bufLen - 1;
+    }
+    return (size_t) len;
+}
+
+/**
+ * Appends str as escaped JSON string content. Stops (without splitting an escape sequence) if buf is full.
+ */
+static size_t celix_logWriterFormat_jsonEscape(const char *str, char *buf, size_t bufLen) {
+    size_t pos = 0;
+    for (const unsigned char *c = (const unsigned char *) (str != NULL ? str : ""); *c != '\0'; ++c) {
+        char esc[8];
+        size_t escLen;
+        if (*c == '"' || *c == '\\') {
+            esc[0] = '\\';
+            esc[1] = (char) *c;
+            escLen = 2;
+        } else if (*c == '\n') {
+            memcpy(esc, "\\n", 2);
+            escLen = 2;
+        } else if (*c < 0x20) {
+            escLen = (size_t) snprintf(esc, sizeof(esc), "\\u%04x", *c);
+        } else {
+            esc[0] = (char) *c;
+            escLen = 1;
+        }
+        if (pos + escLen > bufLen) {
+            break;
+        }
+        memcpy(buf + pos, esc, escLen);
+        pos += escLen;
+    }
+    return pos;
+}
+
+static size_t celix_logWriterFormat_json(const log_entry_t *entry, char *buf, size_t bufLen) {
+    char name[256];
+    size_t nameLen = celix_logWriterFormat_jsonEscape(entry->bundleSymbolicName, name, sizeof(name));
+    int len = snprintf(buf, bufLen, "{\"time\":%li,\"mono_ns\":%lli,\"level\":\"%s\",\"bundle_id\":%li,\"bundle\":\"%.*s\",\"thread\":%li,\"error_code\":%i,\"message\":\"",
+                       (long) entry->time,
+                       (long long) entry->monotonicTime.tv_sec * 1000000000LL + entry->monotonicTime.tv_nsec,
+                       celix_logWriterFormat_levelName(entry->level),
+                       entry->bundleId,
+                       (int) nameLen, name,
+                       entry->threadId,
+                       entry->errorCode);
+    static const char end[] = "\"}\n";
+    if (len < 0 || (size_t) len + sizeof(end) - 1 > bufLen) {
+        return 0;
+    }
+    size_t pos = (size_t) len;
+    pos += celix_logWriterFormat_jsonEscape(entry->message, buf + pos, bufLen - pos - (sizeof(end) - 1));
+    memcpy(buf + pos, end, sizeof(end) - 1);
+    return pos + sizeof(end) - 1;
+}
+
+static void celix_logWriterFormat_putU32(char *buf, uint32_t val) {
+    for (int i = 0; i < 4; ++i) {
+        buf[i] = (char) ((val >> (8 * i)) & 0xFF);
+    }
+}
+
+static void celix_logWriterFormat_putU64(char *buf, uint64_t val) {
+    for (int i = 0; i < 8; ++i) {
+        buf[i] = (char) ((val >> (8 * i)) & 0xFF);
+    }
+}
+
+static size_t celix_logWriterFormat_binary(celix_log_writer_format_t *format, const log_entry_t *entry, char *buf, size_t bufLen) {
+    static const size_t entryHeaderLen = 4 + 1 + 8 + 8 + 8 + 8 + 1 + 4 + 4;
+    const char *name = entry->bundleSymbolicName != NULL ? entry->bundleSymbolicName : "";
+    const char *msg = entry->message != NULL ? entry->message : "";
+    size_t pos = 0;
+
+    uint32_t nameId = (uint32_t) (uintptr_t) hashMap_get(format->nameIds, name);
+    if (nameId == 0) {
+        size_t nameLen = strlen(name);
+        if (4 + 1 + 4 + nameLen + entryHeaderLen > bufLen) {
+            return 0;
+        }
+        char *key = strdup(name);
+        if (key == NULL) {
+            return 0;
+        }
+        nameId = format->nextNameId++;
+        hashMap_put(format->nameIds, key, (void *) (uintptr_t) nameId);
+
+        celix_logWriterFormat_putU32(buf, (uint32_t) (1 + 4 + nameLen));
+        buf[4] = FORMAT_BINARY_RECORD_NAME;
+        celix_logWriterFormat_putU32(buf + 5, nameId);
+        memcpy(buf + 9, name, nameLen);
+        pos = 9 + nameLen;
+    }
+
+    if (pos + entryHeaderLen > bufLen) {
+        return pos;
+    }
+    size_t msgLen = strlen(msg);
+    if (pos + entryHeaderLen + msgLen > bufLen) {
+        msgLen = bufLen - pos - entryHeaderLen;
+    }
+    char *rec = buf + pos;
+    celix_logWriterFormat_putU32(rec, (uint32_t) (entryHeaderLen - 4 + msgLen));
+    rec[4] = FORMAT_BINARY_RECORD_ENTRY;
+    celix_logWriterFormat_putU64(rec + 5, (uint64_t) entry->monotonicTime.tv_sec * 1000000000ULL + (uint64_t) entry->monotonicTime.tv_nsec);
+    celix_logWriterFormat_putU64(rec + 13, (uint64_t) (int64_t) entry->time);
+    celix_logWriterFormat_putU64(rec + 21, (uint64_t) (int64_t) entry->bundleId);
+    celix_logWriterFormat_putU64(rec + 29, (uint64_t) (int64_t) entry->threadId);
+    rec[37] = (char) entry->level;
+    celix_logWriterFormat_putU32(rec + 38, (uint32_t) entry->errorCode);
+    celix_logWriterFormat_putU32(rec + 42, nameId);
+    memcpy(rec + 46, msg, msgLen);
+    return pos + entryHeaderLen + msgLen;
+}
+
+size_t celix_logWriterFormat_format(celix_log_writer_format_t *format, const log_entry_t *entry, char *buf, size_t bufLen) {
+    switch (format->type) {
+        case CELIX_LOG_WRITER_FORMAT_JSON:
+            return celix_logWriterFormat_json(entry, buf, bufLen);
+        case CELIX_LOG_WRITER_FORMAT_BINARY:
+            return celix_logWriterFormat_binary(format, entry, buf, bufLen);
+        default:
+            return celix_logWriterFormat_text(entry, buf, bufLen);
+    }
+}
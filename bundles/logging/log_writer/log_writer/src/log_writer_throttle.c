@@ -0,0 +1,120 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *  KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+#include "celix_log_writer_throttle.h"
+#include "log_service.h"
+
+#define THROTTLE_MAX_NAME_LENGTH        128
+#define THROTTLE_MAX_MESSAGE_LENGTH     1024
+
+struct celix_log_writer_throttle {
+    long rateLimit;
+    bool dedup;
+
+    double tokens;
+    struct timespec lastRefill;
+    long dropped;
+
+    //last accepted entry, to detect repeats
+    bool hasLast;
+    log_level_t lastLevel;
+    char lastName[THROTTLE_MAX_NAME_LENGTH];
+    char lastMessage[THROTTLE_MAX_MESSAGE_LENGTH];
+    long repeated;
+};
+
+celix_log_writer_throttle_t* celix_logWriterThrottle_create(celix_bundle_context_t *ctx) {
+    celix_log_writer_throttle_t *throttle = calloc(1, sizeof(*throttle));
+    if (throttle != NULL) {
+        throttle->rateLimit = celix_bundleContext_getPropertyAsLong(ctx, CELIX_LOG_WRITER_RATE_LIMIT_NAME, CELIX_LOG_WRITER_RATE_LIMIT_DEFAULT);
+        throttle->dedup = celix_bundleContext_getPropertyAsBool(ctx, CELIX_LOG_WRITER_DEDUP_NAME, CELIX_LOG_WRITER_DEDUP_DEFAULT);
+        throttle->tokens = (double) throttle->rateLimit;
+        clock_gettime(CLOCK_MONOTONIC, &throttle->lastRefill);
+    }
+    return throttle;
+}
+
+void celix_logWriterThrottle_destroy(celix_log_writer_throttle_t *throttle) {
+    free(throttle);
+}
+
+static bool celix_logWriterThrottle_isRepeat(celix_log_writer_throttle_t *throttle, const log_entry_t *entry) {
+    const char *name = entry->bundleSymbolicName != NULL ? entry->bundleSymbolicName : "";
+    const char *msg = entry->message != NULL ? entry->message : "";
+    return throttle->hasLast &&
+           throttle->lastLevel == entry->level &&
+           strncmp(throttle->lastName, name, sizeof(throttle->lastName) - 1) == 0 &&
+           strncmp(throttle->lastMessage, msg, sizeof(throttle->lastMessage) - 1) == 0;
+}
+
+static bool celix_logWriterThrottle_takeToken(celix_log_writer_throttle_t *throttle) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    double elapsed = (double) (now.tv_sec - throttle->lastRefill.tv_sec) + (double) (now.tv_nsec - throttle->lastRefill.tv_nsec) / 1000000000.0;
+    throttle->lastRefill = now;
+    throttle->tokens += elapsed * (double) throttle->rateLimit;
+    if (throttle->tokens > (double) throttle->rateLimit) {
+        throttle->tokens = (double) throttle->rateLimit; //burst of at most one second
+    }
+    if (throttle->tokens < 1.0) {
+        return false;
+    }
+    throttle->tokens -= 1.0;
+    return true;
+}
+
+bool celix_logWriterThrottle_summary(celix_log_writer_throttle_t *throttle, char *summary, size_t summaryLen) {
+    summary[0] = '\0';
+    if (throttle->repeated > 0 && throttle->dropped > 0) {
+        snprintf(summary, summaryLen, "Last message repeated %li times, %li log entries dropped by rate limit", throttle->repeated, throttle->dropped);
+    } else if (throttle->repeated > 0) {
+        snprintf(summary, summaryLen, "Last message repeated %li times", throttle->repeated);
+    } else if (throttle->dropped > 0) {
+        snprintf(summary, summaryLen, "%li log entries dropped by rate limit", throttle->dropped);
+    } else {
+        return false;
+    }
+    throttle->repeated = 0;
+    throttle->dropped = 0;
+    return true;
+}
+
+bool celix_logWriterThrottle_accept(celix_log_writer_throttle_t *throttle, const log_entry_t *entry, char *summary, size_t summaryLen) {
+    summary[0] = '\0';
+    if (throttle->dedup && celix_logWriterThrottle_isRepeat(throttle, entry)) {
+        throttle->repeated += 1;
+        return false;
+    }
+    if (throttle->rateLimit > 0 && entry->level != OSGI_LOGSERVICE_ERROR && !celix_logWriterThrottle_takeToken(throttle)) {
+        throttle->dropped += 1;
+        return false;
+    }
+
+    celix_logWriterThrottle_summary(throttle, summary, summaryLen);
+    throttle->hasLast = true;
+    throttle->lastLevel = entry->level;
+    snprintf(throttle->lastName, sizeof(throttle->lastName), "%s", entry->bundleSymbolicName != NULL ? entry->bundleSymbolicName : "");
+    snprintf(throttle->lastMessage, sizeof(throttle->lastMessage), "%s", entry->message != NULL ? entry->message : "");
+    return true;
+}
@@ -0,0 +1,160 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *  KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+#include <cstdint>
+#include <cstring>
+#include <string>
+
+#include "celix_api.h"
+#include "celix_framework_factory.h"
+extern "C" {
+#include "celix_log_writer_format.h"
+}
+
+#include <CppUTest/TestHarness.h>
+
+namespace {
+    uint32_t getU32(const char *buf) {
+        uint32_t val = 0;
+        for (int i = 0; i < 4; ++i) {
+            val |= (uint32_t)(uint8_t)buf[i] << (8 * i);
+        }
+        return val;
+    }
+
+    uint64_t getU64(const char *buf) {
+        uint64_t val = 0;
+        for (int i = 0; i < 8; ++i) {
+            val |= (uint64_t)(uint8_t)buf[i] << (8 * i);
+        }
+        return val;
+    }
+}
+
+TEST_GROUP(LogWriterFormatTests) {
+    celix_framework_t *fw = nullptr;
+    celix_log_writer_format_t *format = nullptr;
+    log_entry_t entry{};
+    char buf[512];
+
+    void setup() {
+        entry.level = OSGI_LOGSERVICE_WARNING;
+        entry.message = const_cast<char*>("hello");
+        entry.time = 1000;
+        entry.bundleId = 3;
+        entry.bundleSymbolicName = const_cast<char*>("format_test");
+        entry.monotonicTime.tv_sec = 2;
+        entry.monotonicTime.tv_nsec = 5;
+        entry.threadId = 42;
+        entry.errorCode = 7;
+    }
+
+    void teardown() {
+        celix_logWriterFormat_destroy(format);
+        celix_frameworkFactory_destroyFramework(fw);
+    }
+
+    void createFormat(const char *type) {
+        celix_properties_t *properties = celix_properties_create();
+        celix_properties_set(properties, "LOGHELPER_ENABLE_STDOUT_FALLBACK", "true");
+        celix_properties_set(properties, "org.osgi.framework.storage.clean", "onFirstInit");
+        celix_properties_set(properties, "org.osgi.framework.storage", ".cacheLogWriterFormatTestFramework");
+        if (type != nullptr) {
+            celix_properties_set(properties, CELIX_LOG_WRITER_FORMAT_NAME, type);
+        }
+        fw = celix_frameworkFactory_createFramework(properties);
+        format = celix_logWriterFormat_create(celix_framework_getFrameworkContext(fw));
+        CHECK(format != nullptr);
+    }
+
+    std::string formatEntry(size_t bufLen) {
+        size_t len = celix_logWriterFormat_format(format, &entry, buf, bufLen);
+        CHECK(len <= bufLen);
+        return std::string{buf, len};
+    }
+};
+
+TEST(LogWriterFormatTests, text) {
+    createFormat(nullptr);
+    STRCMP_EQUAL("LogWriter: hello from format_test\n", formatEntry(sizeof(buf)).c_str());
+
+    //truncated messages still end with a newline
+    STRCMP_EQUAL("LogWriter: he\n", formatEntry(15).c_str());
+}
+
+TEST(LogWriterFormatTests, json) {
+    createFormat("json");
+    STRCMP_EQUAL("{\"time\":1000,\"mono_ns\":2000000005,\"level\":\"WARNING\",\"bundle_id\":3,\"bundle\":\"format_test\","
+                 "\"thread\":42,\"error_code\":7,\"message\":\"hello\"}\n", formatEntry(sizeof(buf)).c_str());
+
+    entry.message = const_cast<char*>("a \"quoted\"\\ line\n\x01");
+    std::string line = formatEntry(sizeof(buf));
+    CHECK(line.find("\"message\":\"a \\\"quoted\\\"\\\\ line\\n\\u0001\"}\n") != std::string::npos);
+
+    //truncation keeps the line valid json and does not split an escape sequence
+    std::string full = formatEntry(sizeof(buf));
+    size_t prefixLen = full.find("\"message\":\"") + strlen("\"message\":\"");
+    line = formatEntry(prefixLen + 4 + 3);
+    STRCMP_EQUAL("a \\\"\"}\n", line.substr(prefixLen).c_str());
+
+    CHECK_EQUAL(0, (int)celix_logWriterFormat_format(format, &entry, buf, 16));
+}
+
+TEST(LogWriterFormatTests, binary) {
+    createFormat("binary");
+    static const size_t entryLen = 46;
+
+    //the first entry of a bundle is preceded by a name record
+    std::string rec = formatEntry(sizeof(buf));
+    size_t nameRecLen = 9 + strlen("format_test");
+    CHECK_EQUAL(nameRecLen + entryLen + strlen("hello"), rec.size());
+    CHECK_EQUAL(nameRecLen - 4, getU32(rec.data()));
+    CHECK_EQUAL(1, rec[4]);
+    uint32_t nameId = getU32(rec.data() + 5);
+    STRCMP_EQUAL("format_test", rec.substr(9, nameRecLen - 9).c_str());
+
+    const char *e = rec.data() + nameRecLen;
+    CHECK_EQUAL(entryLen - 4 + strlen("hello"), getU32(e));
+    CHECK_EQUAL(2, e[4]);
+    CHECK(2000000005ULL == getU64(e + 5));
+    CHECK(1000ULL == getU64(e + 13));
+    CHECK(3ULL == getU64(e + 21));
+    CHECK(42ULL == getU64(e + 29));
+    CHECK_EQUAL(OSGI_LOGSERVICE_WARNING, e[37]);
+    CHECK_EQUAL(7u, getU32(e + 38));
+    CHECK_EQUAL(nameId, getU32(e + 42));
+    STRCMP_EQUAL("hello", std::string(e + 46, strlen("hello")).c_str());
+
+    //later entries refer to the name id
+    rec = formatEntry(sizeof(buf));
+    CHECK_EQUAL(entryLen + strlen("hello"), rec.size());
+    CHECK_EQUAL(2, rec[4]);
+    CHECK_EQUAL(nameId, getU32(rec.data() + 42));
+
+    //another bundle gets a new name id
+    entry.bundleSymbolicName = const_cast<char*>("other");
+    rec = formatEntry(sizeof(buf));
+    CHECK_EQUAL(1, rec[4]);
+    CHECK(getU32(rec.data() + 5) != nameId);
+
+    //messages are truncated to fit
+    entry.bundleSymbolicName = const_cast<char*>("format_test");
+    rec = formatEntry(entryLen + 2);
+    CHECK_EQUAL(entryLen + 2, rec.size());
+    CHECK_EQUAL(entryLen - 4 + 2, getU32(rec.data()));
+}
@@ -0,0 +1,126 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *  KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+#include <cstring>
+#include <string>
+
+#include "celix_api.h"
+#include "celix_framework_factory.h"
+extern "C" {
+#include "celix_log_writer_throttle.h"
+}
+
+#include <CppUTest/TestHarness.h>
+
+TEST_GROUP(LogWriterThrottleTests) {
+    celix_framework_t *fw = nullptr;
+    celix_bundle_context_t *ctx = nullptr;
+    celix_log_writer_throttle_t *throttle = nullptr;
+    char summary[256];
+
+    void setup() {
+        summary[0] = '\0';
+    }
+
+    void teardown() {
+        celix_logWriterThrottle_destroy(throttle);
+        celix_frameworkFactory_destroyFramework(fw);
+    }
+
+    void createThrottle(const char *rateLimit, const char *dedup) {
+        celix_properties_t *properties = celix_properties_create();
+        celix_properties_set(properties, "LOGHELPER_ENABLE_STDOUT_FALLBACK", "true");
+        celix_properties_set(properties, "org.osgi.framework.storage.clean", "onFirstInit");
+        celix_properties_set(properties, "org.osgi.framework.storage", ".cacheLogWriterThrottleTestFramework");
+        celix_properties_set(properties, CELIX_LOG_WRITER_RATE_LIMIT_NAME, rateLimit);
+        celix_properties_set(properties, CELIX_LOG_WRITER_DEDUP_NAME, dedup);
+        fw = celix_frameworkFactory_createFramework(properties);
+        ctx = celix_framework_getFrameworkContext(fw);
+        throttle = celix_logWriterThrottle_create(ctx);
+        CHECK(throttle != nullptr);
+    }
+
+    bool accept(log_level_t level, const char *msg) {
+        log_entry_t entry{};
+        entry.level = level;
+        entry.message = const_cast<char*>(msg);
+        entry.bundleId = 1;
+        entry.bundleSymbolicName = const_cast<char*>("throttle_test");
+        return celix_logWriterThrottle_accept(throttle, &entry, summary, sizeof(summary));
+    }
+};
+
+TEST(LogWriterThrottleTests, repeatsAreCollapsed) {
+    createThrottle("0", "true");
+    CHECK(accept(OSGI_LOGSERVICE_INFO, "msg1"));
+    STRCMP_EQUAL("", summary);
+    CHECK_FALSE(accept(OSGI_LOGSERVICE_INFO, "msg1"));
+    CHECK_FALSE(accept(OSGI_LOGSERVICE_INFO, "msg1"));
+
+    //the same message on another level is not a repeat
+    CHECK(accept(OSGI_LOGSERVICE_WARNING, "msg1"));
+    STRCMP_EQUAL("Last message repeated 2 times", summary);
+
+    CHECK(accept(OSGI_LOGSERVICE_WARNING, "msg2"));
+    STRCMP_EQUAL("", summary);
+    CHECK_FALSE(celix_logWriterThrottle_summary(throttle, summary, sizeof(summary)));
+    STRCMP_EQUAL("", summary);
+
+    //a pending summary can also be taken without a new entry
+    CHECK_FALSE(accept(OSGI_LOGSERVICE_WARNING, "msg2"));
+    CHECK(celix_logWriterThrottle_summary(throttle, summary, sizeof(summary)));
+    STRCMP_EQUAL("Last message repeated 1 times", summary);
+}
+
+TEST(LogWriterThrottleTests, dedupDisabled) {
+    createThrottle("0", "false");
+    for (int i = 0; i < 10; ++i) {
+        CHECK(accept(OSGI_LOGSERVICE_INFO, "msg"));
+        STRCMP_EQUAL("", summary);
+    }
+}
+
+TEST(LogWriterThrottleTests, rateLimitDropsEntries) {
+    createThrottle("5", "true");
+    int accepted = 0;
+    for (int i = 0; i < 20; ++i) {
+        std::string msg = "msg" + std::to_string(i);
+        if (accept(OSGI_LOGSERVICE_INFO, msg.c_str())) {
+            ++accepted;
+        }
+    }
+    //a burst of at most one second worth of tokens
+    CHECK(accepted >= 5);
+    CHECK(accepted < 20);
+
+    //errors are never rate limited and report the dropped entries
+    CHECK(accept(OSGI_LOGSERVICE_ERROR, "error"));
+    std::string expected = std::to_string(20 - accepted) + " log entries dropped by rate limit";
+    STRCMP_EQUAL(expected.c_str(), summary);
+    CHECK(accept(OSGI_LOGSERVICE_ERROR, "error2"));
+    STRCMP_EQUAL("", summary);
+}
+
+TEST(LogWriterThrottleTests, repeatsAndDropsInOneSummary) {
+    createThrottle("1", "true");
+    CHECK(accept(OSGI_LOGSERVICE_INFO, "msg1"));
+    CHECK_FALSE(accept(OSGI_LOGSERVICE_INFO, "msg1"));
+    CHECK_FALSE(accept(OSGI_LOGSERVICE_INFO, "msg2"));
+    CHECK(accept(OSGI_LOGSERVICE_ERROR, "error"));
+    STRCMP_EQUAL("Last message repeated 1 times, 1 log entries dropped by rate limit", summary);
+}
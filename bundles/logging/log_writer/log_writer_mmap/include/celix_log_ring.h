@@ -0,0 +1,77 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *  KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#ifndef CELIX_LOG_RING_H_
+#define CELIX_LOG_RING_H_
+
+#include <stdint.h>
+
+/**
+ * Layout of the memory-mapped log ring file written by the log_writer_mmap bundle and read by celix_log_ring_reader.
+ *
+ * The file is a header of CELIX_LOG_RING_HEADER_SIZE bytes followed by dataSize bytes of ring data. Records are
+ * written in native byte order at 8 byte aligned offsets and never wrap: if a record does not fit in the remainder of
+ * the ring, the remainder is filled with a pad record and the record is written at the start of the ring.
+ *
+ * head and tail are running byte offsets (the ring offset is offset % dataSize). tail is the oldest complete record
+ * and is advanced before a record is overwritten, head is advanced after a record is completely written. A reader
+ * can therefore copy the ring of a live process and keep the records at or after the tail read after the copy.
+ */
+
+#define CELIX_LOG_RING_MAGIC            "CELIXLR1"
+#define CELIX_LOG_RING_VERSION          1
+#define CELIX_LOG_RING_HEADER_SIZE      4096
+#define CELIX_LOG_RING_ALIGNMENT        8
+
+#define CELIX_LOG_RING_RECORD_ENTRY     1
+#define CELIX_LOG_RING_RECORD_PAD       2
+
+typedef struct celix_log_ring_header {
+    char magic[8];
+    uint32_t version;
+    uint32_t headerSize;
+    uint64_t dataSize;
+    uint64_t head;
+    uint64_t tail;
+    uint64_t nrOfRecords; //nr of entries written since the ring was created
+    int64_t pid; //pid of the last process that opened the ring for writing
+} celix_log_ring_header_t;
+
+/**
+ * Entry record, followed by nameLength bytes of bundle symbolic name and length - sizeof(record) - nameLength bytes
+ * of message (both not NUL terminated). A pad record only has a valid length and type.
+ */
+typedef struct celix_log_ring_record {
+    uint32_t length; //excluding the alignment padding
+    uint16_t type;
+    uint16_t nameLength;
+    uint64_t seq;
+    uint64_t monoNs;
+    int64_t time;
+    int64_t bundleId;
+    int64_t threadId;
+    int32_t level;
+    int32_t errorCode;
+} celix_log_ring_record_t;
+
+static inline uint64_t celix_logRing_alignedLength(uint64_t length) {
+    return (length + CELIX_LOG_RING_ALIGNMENT - 1) & ~((uint64_t) CELIX_LOG_RING_ALIGNMENT - 1);
+}
+
+#endif /* CELIX_LOG_RING_H_ */
@@ -0,0 +1,258 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *  KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <time.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "celix_errno.h"
+#include "celixbool.h"
+#include "celix_threads.h"
+
+#include "celix_log_writer.h"
+#include "celix_log_writer_throttle.h"
+#include "celix_log_ring.h"
+#include "log_listener.h"
+
+#define LOG_WRITER_MMAP_FILE_NAME           "CELIX_LOG_WRITER_MMAP_FILE"
+#define LOG_WRITER_MMAP_FILE_DEFAULT        "celix_log.ring"
+#define LOG_WRITER_MMAP_SIZE_NAME           "CELIX_LOG_WRITER_MMAP_SIZE"
+#define LOG_WRITER_MMAP_SIZE_DEFAULT        (1024 * 1024) //in bytes
+#define LOG_WRITER_MMAP_SIZE_MIN            (64 * 1024)
+
+#define LOG_WRITER_MMAP_MAX_NAME_LENGTH     255
+
+struct celix_log_writer {
+    int fd;
+    char *map;
+    size_t mapSize;
+    celix_log_ring_header_t *header;
+    char *data;
+    uint64_t dataSize;
+
+    celix_thread_mutex_t mutex; //protects below and the ring
+    celix_log_writer_throttle_t *throttle;
+};
+
+/**
+ * Returns whether the mapped file contains a ring that can be appended to, so that entries logged before a crash are
+ * kept after a restart.
+ */
+static bool celix_logWriter_isValidRing(celix_log_writer_t *writer) {
+    celix_log_ring_header_t *header = writer->header;
+    return memcmp(header->magic, CELIX_LOG_RING_MAGIC, sizeof(header->magic)) == 0 &&
+           header->version == CELIX_LOG_RING_VERSION &&
+           header->headerSize == CELIX_LOG_RING_HEADER_SIZE &&
+           header->dataSize == writer->dataSize &&
+           header->tail <= header->head &&
+           header->head - header->tail <= writer->dataSize &&
+           header->tail % CELIX_LOG_RING_ALIGNMENT == 0 &&
+           header->head % CELIX_LOG_RING_ALIGNMENT == 0;
+}
+
+static celix_status_t celix_logWriter_openRing(celix_log_writer_t *writer, const char *path) {
+    writer->fd = open(path, O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+    if (writer->fd < 0) {
+        fprintf(stderr, "[LogWriter] Cannot open log ring file %s: %s\n", path, strerror(errno));
+        return CELIX_FILE_IO_EXCEPTION;
+    }
+    struct stat st;
+    if (fstat(writer->fd, &st) != 0) {
+        return CELIX_FILE_IO_EXCEPTION;
+    }
+    bool resized = (size_t) st.st_size != writer->mapSize;
+    if (resized && ftruncate(writer->fd, (off_t) writer->mapSize) != 0) {
+        fprintf(stderr, "[LogWriter] Cannot resize log ring file %s: %s\n", path, strerror(errno));
+        return CELIX_FILE_IO_EXCEPTION;
+    }
+    void *map = mmap(NULL, writer->mapSize, PROT_READ | PROT_WRITE, MAP_SHARED, writer->fd, 0);
+    if (map == MAP_FAILED) {
+        fprintf(stderr, "[LogWriter] Cannot map log ring file %s: %s\n", path, strerror(errno));
+        return CELIX_FILE_IO_EXCEPTION;
+    }
+    writer->map = map;
+    writer->header = map;
+    writer->data = writer->map + CELIX_LOG_RING_HEADER_SIZE;
+
+    if (resized || !celix_logWriter_isValidRing(writer)) {
+        memset(writer->header, 0, sizeof(*writer->header));
+        writer->header->version = CELIX_LOG_RING_VERSION;
+        writer->header->headerSize = CELIX_LOG_RING_HEADER_SIZE;
+        writer->header->dataSize = writer->dataSize;
+        __atomic_store_n(&writer->header->tail, 0, __ATOMIC_RELEASE);
+        __atomic_store_n(&writer->header->head, 0, __ATOMIC_RELEASE);
+        memcpy(writer->header->magic, CELIX_LOG_RING_MAGIC, sizeof(writer->header->magic)); //last, marks the ring valid
+    }
+    writer->header->pid = (int64_t) getpid();
+    return CELIX_SUCCESS;
+}
+
+celix_log_writer_t* celix_logWriter_create(celix_bundle_context_t *ctx) {
+    celix_log_writer_t *writer = calloc(1, sizeof(*writer));
+    if (writer == NULL) {
+        return NULL;
+    }
+    writer->fd = -1;
+    celixThreadMutex_create(&writer->mutex, NULL);
+    writer->throttle = celix_logWriterThrottle_create(ctx);
+
+    const char *path = celix_bundleContext_getProperty(ctx, LOG_WRITER_MMAP_FILE_NAME, LOG_WRITER_MMAP_FILE_DEFAULT);
+    long size = celix_bundleContext_getPropertyAsLong(ctx, LOG_WRITER_MMAP_SIZE_NAME, LOG_WRITER_MMAP_SIZE_DEFAULT);
+    if (size < LOG_WRITER_MMAP_SIZE_MIN) {
+        size = LOG_WRITER_MMAP_SIZE_MIN;
+    }
+    writer->dataSize = celix_logRing_alignedLength((uint64_t) size);
+    writer->mapSize = CELIX_LOG_RING_HEADER_SIZE + (size_t) writer->dataSize;
+
+    if (writer->throttle == NULL || celix_logWriter_openRing(writer, path) != CELIX_SUCCESS) {
+        celix_logWriter_destroy(writer);
+        return NULL;
+    }
+    return writer;
+}
+
+/**
+ * Advances the tail over the records which would be overwritten by writing up to end. Called with the mutex locked.
+ */
+static void celix_logWriter_reserve(celix_log_writer_t *writer, uint64_t end) {
+    uint64_t tail = writer->header->tail;
+    while (end - tail > writer->dataSize) {
+        const celix_log_ring_record_t *rec = (const celix_log_ring_record_t *) (writer->data + tail % writer->dataSize);
+        uint64_t len = celix_logRing_alignedLength(rec->length);
+        if (len == 0 || len > writer->dataSize - tail % writer->dataSize) {
+            tail = writer->header->head; //corrupt record, drop the remainder of the ring
+            break;
+        }
+        tail += len;
+    }
+    __atomic_store_n(&writer->header->tail, tail, __ATOMIC_RELEASE);
+}
+
+/**
+ * Copies the entry in the ring. Called with the mutex locked.
+ */
+static void celix_logWriter_append(celix_log_writer_t *writer, const log_entry_t *entry) {
+    const char *name = entry->bundleSymbolicName != NULL ? entry->bundleSymbolicName : "";
+    const char *msg = entry->message != NULL ? entry->message : "";
+    size_t nameLen = strnlen(name, LOG_WRITER_MMAP_MAX_NAME_LENGTH);
+    size_t maxMsgLen = writer->dataSize / 4 - sizeof(celix_log_ring_record_t) - nameLen;
+    size_t msgLen = strnlen(msg, maxMsgLen);
+
+    celix_log_ring_record_t rec;
+    rec.length = (uint32_t) (sizeof(rec) + nameLen + msgLen);
+    rec.type = CELIX_LOG_RING_RECORD_ENTRY;
+    rec.nameLength = (uint16_t) nameLen;
+    rec.seq = writer->header->nrOfRecords;
+    rec.monoNs = (uint64_t) entry->monotonicTime.tv_sec * 1000000000ULL + (uint64_t) entry->monotonicTime.tv_nsec;
+    rec.time = (int64_t) entry->time;
+    rec.bundleId = (int64_t) entry->bundleId;
+    rec.threadId = (int64_t) entry->threadId;
+    rec.level = (int32_t) entry->level;
+    rec.errorCode = (int32_t) entry->errorCode;
+    uint64_t len = celix_logRing_alignedLength(rec.length);
+
+    uint64_t head = writer->header->head;
+    uint64_t pos = head % writer->dataSize;
+    if (pos + len > writer->dataSize) {
+        uint64_t padLen = writer->dataSize - pos;
+        celix_logWriter_reserve(writer, head + padLen);
+        celix_log_ring_record_t *pad = (celix_log_ring_record_t *) (writer->data + pos);
+        pad->length = (uint32_t) padLen;
+        pad->type = CELIX_LOG_RING_RECORD_PAD;
+        head += padLen;
+        __atomic_store_n(&writer->header->head, head, __ATOMIC_RELEASE);
+        pos = 0;
+    }
+    celix_logWriter_reserve(writer, head + len);
+    char *dst = writer->data + pos;
+    memcpy(dst, &rec, sizeof(rec));
+    memcpy(dst + sizeof(rec), name, nameLen);
+    memcpy(dst + sizeof(rec) + nameLen, msg, msgLen);
+    writer->header->nrOfRecords += 1;
+    __atomic_store_n(&writer->header->head, head + len, __ATOMIC_RELEASE);
+}
+
+/**
+ * Appends a summary of the entries suppressed by the throttle, as an entry of the log writer itself.
+ */
+static void celix_logWriter_appendSummary(celix_log_writer_t *writer, char *summary) {
+    log_entry_t entry;
+    memset(&entry, 0, sizeof(entry));
+    entry.level = OSGI_LOGSERVICE_WARNING;
+    entry.message = summary;
+    entry.time = time(NULL);
+    clock_gettime(CLOCK_MONOTONIC, &entry.monotonicTime);
+    entry.bundleId = -1;
+    entry.bundleSymbolicName = "apache_celix_log_writer_mmap";
+    celix_logWriter_append(writer, &entry);
+}
+
+void celix_logWriter_destroy(celix_log_writer_t *writer) {
+    if (writer == NULL) {
+        return;
+    }
+    if (writer->throttle != NULL && writer->map != NULL) {
+        char summary[256];
+        if (celix_logWriterThrottle_summary(writer->throttle, summary, sizeof(summary))) {
+            celix_logWriter_appendSummary(writer, summary);
+        }
+    }
+    if (writer->map != NULL) {
+        msync(writer->map, writer->mapSize, MS_SYNC);
+        munmap(writer->map, writer->mapSize);
+    }
+    if (writer->fd >= 0) {
+        close(writer->fd);
+    }
+    celix_logWriterThrottle_destroy(writer->throttle);
+    celixThreadMutex_destroy(&writer->mutex);
+    free(writer);
+}
+
+celix_status_t celix_logWriter_logged(celix_log_writer_t *writer, log_entry_t *entry) {
+    if (writer == NULL || entry == NULL) {
+        return CELIX_ILLEGAL_ARGUMENT;
+    }
+
+    char summary[256];
+    celixThreadMutex_lock(&writer->mutex);
+    if (celix_logWriterThrottle_accept(writer->throttle, entry, summary, sizeof(summary))) {
+        if (summary[0] != '\0') {
+            celix_logWriter_appendSummary(writer, summary);
+        }
+        celix_logWriter_append(writer, entry);
+    }
+    celixThreadMutex_unlock(&writer->mutex);
+
+    return CELIX_SUCCESS;
+}
+
+celix_status_t celix_logWriter_flush(celix_log_writer_t *writer) {
+    if (writer == NULL) {
+        return CELIX_ILLEGAL_ARGUMENT;
+    }
+    //nothing to do, the kernel writes back the dirty pages of the shared mapping, also if the process crashes
+    return CELIX_SUCCESS;
+}
@@ -0,0 +1,213 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *  KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/**
+ * celix_log_ring_reader prints the entries of a log ring file written by the log_writer_mmap bundle, see
+ * celix_log_ring.h. The file can be read after a crash or while the process is running; the ring is only read, so
+ * the writing process is not disturbed.
+ *
+ * usage: celix_log_ring_reader [-n <nr of entries>] <log ring file>
+ * Without -n all entries in the ring are printed, oldest first.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <errno.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <time.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "celix_log_ring.h"
+
+#define LOG_RING_READER_MAX_ATTEMPTS 10
+
+static const char* logRingReader_levelName(int32_t level) {
+    switch (level) {
+        case 1:
+            return "ERROR";
+        case 2:
+            return "WARNING";
+        case 3:
+            return "INFO";
+        default:
+            return "DEBUG";
+    }
+}
+
+/**
+ * Returns whether a record at offset pos of the ring copy is complete and within the ring.
+ */
+static bool logRingReader_isValidRecord(const char *data, uint64_t dataSize, uint64_t pos) {
+    if (dataSize - pos < sizeof(uint32_t) * 2) {
+        return false;
+    }
+    const celix_log_ring_record_t *rec = (const celix_log_ring_record_t *) (data + pos);
+    if (rec->length > dataSize - pos || rec->length < sizeof(uint32_t) * 2) {
+        return false;
+    }
+    if (rec->type == CELIX_LOG_RING_RECORD_ENTRY) {
+        return rec->length >= sizeof(*rec) && rec->nameLength <= rec->length - sizeof(*rec);
+    }
+    return rec->type == CELIX_LOG_RING_RECORD_PAD;
+}
+
+static void logRingReader_print(const celix_log_ring_record_t *rec) {
+    const char *name = (const char *) (rec + 1);
+    const char *msg = name + rec->nameLength;
+    int msgLen = (int) (rec->length - sizeof(*rec) - rec->nameLength);
+    time_t t = (time_t) rec->time;
+    struct tm tm;
+    char timeStr[32];
+    if (localtime_r(&t, &tm) == NULL || strftime(timeStr, sizeof(timeStr), "%Y-%m-%dT%H:%M:%S", &tm) == 0) {
+        snprintf(timeStr, sizeof(timeStr), "%lli", (long long) rec->time);
+    }
+    printf("%s [%llu.%09llu] %-7s %.*s (bundle %lli, thread %lli): %.*s",
+           timeStr,
+           (unsigned long long) (rec->monoNs / 1000000000ULL),
+           (unsigned long long) (rec->monoNs % 1000000000ULL),
+           logRingReader_levelName(rec->level),
+           (int) rec->nameLength, name,
+           (long long) rec->bundleId,
+           (long long) rec->threadId,
+           msgLen, msg);
+    if (rec->errorCode != 0) {
+        printf(" (error code %i)", rec->errorCode);
+    }
+    printf("\n");
+}
+
+/**
+ * Copies the ring and returns the range [*tail, *head) of records which were not overwritten during the copy.
+ */
+static bool logRingReader_snapshot(const celix_log_ring_header_t *header, const char *data, char *copy, uint64_t *tail, uint64_t *head) {
+    for (int attempt = 0; attempt < LOG_RING_READER_MAX_ATTEMPTS; ++attempt) {
+        uint64_t h = __atomic_load_n(&header->head, __ATOMIC_ACQUIRE);
+        memcpy(copy, data, header->dataSize);
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+        uint64_t t = __atomic_load_n(&header->tail, __ATOMIC_ACQUIRE);
+        if (t <= h) {
+            *tail = t;
+            *head = h;
+            return true;
+        }
+        //the writer wrapped past the copied head, retry
+    }
+    return false;
+}
+
+int main(int argc, char **argv) {
+    long maxEntries = -1;
+    int opt;
+    while ((opt = getopt(argc, argv, "n:h")) != -1) {
+        if (opt == 'n') {
+            maxEntries = strtol(optarg, NULL, 10);
+        } else {
+            fprintf(stderr, "usage: %s [-n <nr of entries>] <log ring file>\n", argv[0]);
+            return opt == 'h' ? 0 : 1;
+        }
+    }
+    if (optind != argc - 1) {
+        fprintf(stderr, "usage: %s [-n <nr of entries>] <log ring file>\n", argv[0]);
+        return 1;
+    }
+    const char *path = argv[optind];
+
+    int fd = open(path, O_RDONLY | O_CLOEXEC);
+    struct stat st;
+    if (fd < 0 || fstat(fd, &st) != 0) {
+        fprintf(stderr, "Cannot open %s: %s\n", path, strerror(errno));
+        return 1;
+    }
+    if ((size_t) st.st_size < CELIX_LOG_RING_HEADER_SIZE) {
+        fprintf(stderr, "%s is not a log ring file\n", path);
+        close(fd);
+        return 1;
+    }
+    void *map = mmap(NULL, (size_t) st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED) {
+        fprintf(stderr, "Cannot map %s: %s\n", path, strerror(errno));
+        return 1;
+    }
+    const celix_log_ring_header_t *header = map;
+    if (memcmp(header->magic, CELIX_LOG_RING_MAGIC, sizeof(header->magic)) != 0 ||
+        header->version != CELIX_LOG_RING_VERSION ||
+        header->headerSize != CELIX_LOG_RING_HEADER_SIZE ||
+        header->dataSize == 0 ||
+        header->dataSize > (uint64_t) st.st_size - CELIX_LOG_RING_HEADER_SIZE) {
+        fprintf(stderr, "%s is not a log ring file (or has an unsupported version)\n", path);
+        munmap(map, (size_t) st.st_size);
+        return 1;
+    }
+
+    uint64_t dataSize = header->dataSize;
+    char *copy = malloc(dataSize);
+    uint64_t tail = 0;
+    uint64_t head = 0;
+    if (copy == NULL || !logRingReader_snapshot(header, (const char *) map + CELIX_LOG_RING_HEADER_SIZE, copy, &tail, &head)) {
+        fprintf(stderr, "Cannot read a consistent snapshot of %s\n", path);
+        free(copy);
+        munmap(map, (size_t) st.st_size);
+        return 1;
+    }
+    fprintf(stderr, "Log ring %s: pid %lli, %llu entries written, %llu bytes in use\n",
+            path, (long long) header->pid, (unsigned long long) header->nrOfRecords, (unsigned long long) (head - tail));
+    munmap(map, (size_t) st.st_size);
+
+    //collect the record offsets, to be able to print only the latest entries
+    size_t nrOfEntries = 0;
+    size_t cap = 1024;
+    uint64_t *offsets = malloc(cap * sizeof(*offsets));
+    for (uint64_t off = tail; offsets != NULL && off < head;) {
+        uint64_t pos = off % dataSize;
+        if (!logRingReader_isValidRecord(copy, dataSize, pos)) {
+            fprintf(stderr, "Corrupt record at offset %llu, stopped reading\n", (unsigned long long) off);
+            break;
+        }
+        const celix_log_ring_record_t *rec = (const celix_log_ring_record_t *) (copy + pos);
+        if (rec->type == CELIX_LOG_RING_RECORD_ENTRY) {
+            if (nrOfEntries == cap) {
+                cap *= 2;
+                uint64_t *grown = realloc(offsets, cap * sizeof(*offsets));
+                if (grown == NULL) {
+                    break;
+                }
+                offsets = grown;
+            }
+            offsets[nrOfEntries++] = pos;
+        }
+        off += celix_logRing_alignedLength(rec->length);
+    }
+
+    size_t start = 0;
+    if (maxEntries >= 0 && (size_t) maxEntries < nrOfEntries) {
+        start = nrOfEntries - (size_t) maxEntries;
+    }
+    for (size_t i = start; offsets != NULL && i < nrOfEntries; ++i) {
+        logRingReader_print((const celix_log_ring_record_t *) (copy + offsets[i]));
+    }
+
+    free(offsets);
+    free(copy);
+    return 0;
+}
@@ -0,0 +1,224 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *  KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+
+#include "celix_api.h"
+#include "celix_framework_factory.h"
+extern "C" {
+#include "celix_log_writer.h"
+#include "celix_log_ring.h"
+}
+
+#include <CppUTest/TestHarness.h>
+
+#define LOG_RING_TEST_FILE "log_ring_test.ring"
+
+TEST_GROUP(LogRingTests) {
+    celix_framework_t *fw = nullptr;
+    celix_bundle_context_t *ctx = nullptr;
+    celix_log_writer_t *writer = nullptr;
+
+    void setup() {
+        unlink(LOG_RING_TEST_FILE);
+        celix_properties_t *properties = celix_properties_create();
+        celix_properties_set(properties, "LOGHELPER_ENABLE_STDOUT_FALLBACK", "true");
+        celix_properties_set(properties, "org.osgi.framework.storage.clean", "onFirstInit");
+        celix_properties_set(properties, "org.osgi.framework.storage", ".cacheLogRingTestFramework");
+        celix_properties_set(properties, "CELIX_LOG_WRITER_MMAP_FILE", LOG_RING_TEST_FILE);
+        celix_properties_set(properties, "CELIX_LOG_WRITER_MMAP_SIZE", "65536");
+        celix_properties_set(properties, "CELIX_LOG_WRITER_RATE_LIMIT", "0");
+        celix_properties_set(properties, "CELIX_LOG_WRITER_DEDUP", "false");
+        fw = celix_frameworkFactory_createFramework(properties);
+        ctx = celix_framework_getFrameworkContext(fw);
+        writer = celix_logWriter_create(ctx);
+        CHECK(writer != nullptr);
+    }
+
+    void teardown() {
+        celix_logWriter_destroy(writer);
+        celix_frameworkFactory_destroyFramework(fw);
+        unlink(LOG_RING_TEST_FILE);
+    }
+
+    void logEntries(int from, int to) {
+        //about 250 bytes per record, so a 64KiB ring wraps after a few hundred entries
+        std::string padding(200, '.');
+        for (int i = from; i < to; ++i) {
+            std::string msg = "entry " + std::to_string(i) + " " + padding;
+            log_entry_t entry{};
+            entry.level = OSGI_LOGSERVICE_INFO;
+            entry.message = (char*)msg.c_str();
+            entry.bundleSymbolicName = (char*)"log_ring_test";
+            entry.bundleId = 1;
+            entry.time = time(nullptr);
+            clock_gettime(CLOCK_MONOTONIC, &entry.monotonicTime);
+            celix_logWriter_logged(writer, &entry);
+        }
+    }
+
+    /**
+     * Runs the log ring reader and returns its exit code, the logged entry numbers and the other output lines.
+     */
+    static int readRing(const char *options, std::vector<int> &entries, std::string &other) {
+        std::string cmd = std::string{LOG_RING_READER} + " " + options + " " LOG_RING_TEST_FILE " 2>&1";
+        FILE *out = popen(cmd.c_str(), "r");
+        CHECK(out != nullptr);
+        char line[1024];
+        while (fgets(line, sizeof(line), out) != nullptr) {
+            const char *msg = strstr(line, ": entry ");
+            int nr = -1;
+            if (msg != nullptr && sscanf(msg, ": entry %d", &nr) == 1) {
+                entries.push_back(nr);
+            } else {
+                other += line;
+            }
+        }
+        int status = pclose(out);
+        return WIFEXITED(status) ? WEXITSTATUS(status) : -1;
+    }
+
+    static void checkConsecutive(const std::vector<int> &entries, int last) {
+        CHECK(!entries.empty());
+        for (size_t i = 0; i < entries.size(); ++i) {
+            CHECK_EQUAL(last - (int)(entries.size() - 1 - i), entries[i]);
+        }
+    }
+
+    static celix_log_ring_header_t readHeader(int fd) {
+        celix_log_ring_header_t header{};
+        CHECK_EQUAL((ssize_t)sizeof(header), pread(fd, &header, sizeof(header), 0));
+        return header;
+    }
+};
+
+TEST(LogRingTests, wrapAround) {
+    logEntries(0, 2000);
+
+    //read while the writer has the ring mapped, the oldest entries are overwritten
+    std::vector<int> entries{};
+    std::string other{};
+    CHECK_EQUAL(0, readRing("", entries, other));
+    checkConsecutive(entries, 1999);
+    CHECK(entries.front() > 0);
+    CHECK(entries.size() > 100);
+    CHECK(other.find("Corrupt") == std::string::npos);
+
+    entries.clear();
+    CHECK_EQUAL(0, readRing("-n 10", entries, other));
+    CHECK_EQUAL(10, (int)entries.size());
+    checkConsecutive(entries, 1999);
+}
+
+TEST(LogRingTests, reopenAfterWrapAround) {
+    logEntries(0, 1000);
+    celix_logWriter_destroy(writer);
+
+    //a new writer appends to the wrapped ring, entries logged before the restart are kept
+    writer = celix_logWriter_create(ctx);
+    CHECK(writer != nullptr);
+    logEntries(1000, 1050);
+
+    std::vector<int> entries{};
+    std::string other{};
+    CHECK_EQUAL(0, readRing("", entries, other));
+    checkConsecutive(entries, 1049);
+    CHECK(entries.front() < 1000);
+}
+
+TEST(LogRingTests, corruptRecord) {
+    logEntries(0, 20);
+    celix_logWriter_destroy(writer);
+    writer = nullptr;
+
+    //break the length of the 10th record, the reader prints the records before it
+    int fd = open(LOG_RING_TEST_FILE, O_RDWR);
+    CHECK(fd >= 0);
+    celix_log_ring_header_t header = readHeader(fd);
+    CHECK_EQUAL(0, (int)header.tail);
+    uint64_t off = header.tail;
+    for (int i = 0; i < 9; ++i) {
+        celix_log_ring_record_t rec{};
+        CHECK_EQUAL((ssize_t)sizeof(rec), pread(fd, &rec, sizeof(rec), CELIX_LOG_RING_HEADER_SIZE + off));
+        off += celix_logRing_alignedLength(rec.length);
+    }
+    uint32_t badLength = 3;
+    CHECK_EQUAL((ssize_t)sizeof(badLength), pwrite(fd, &badLength, sizeof(badLength), CELIX_LOG_RING_HEADER_SIZE + off));
+    close(fd);
+
+    std::vector<int> entries{};
+    std::string other{};
+    CHECK_EQUAL(0, readRing("", entries, other));
+    checkConsecutive(entries, 8);
+    CHECK_EQUAL(9, (int)entries.size());
+    CHECK(other.find("Corrupt record") != std::string::npos);
+}
+
+TEST(LogRingTests, truncatedFile) {
+    logEntries(0, 20);
+    celix_logWriter_destroy(writer);
+    writer = nullptr;
+
+    //the header claims more ring data than the file contains
+    CHECK_EQUAL(0, truncate(LOG_RING_TEST_FILE, CELIX_LOG_RING_HEADER_SIZE + 1024));
+    std::vector<int> entries{};
+    std::string other{};
+    CHECK(readRing("", entries, other) != 0);
+    CHECK(entries.empty());
+    CHECK(other.find("not a log ring file") != std::string::npos);
+
+    //not even a header
+    CHECK_EQUAL(0, truncate(LOG_RING_TEST_FILE, 16));
+    other.clear();
+    CHECK(readRing("", entries, other) != 0);
+    CHECK(entries.empty());
+    CHECK(other.find("not a log ring file") != std::string::npos);
+}
+
+TEST(LogRingTests, invalidHeader) {
+    logEntries(0, 20);
+    celix_logWriter_destroy(writer);
+    writer = nullptr;
+
+    int fd = open(LOG_RING_TEST_FILE, O_RDWR);
+    CHECK(fd >= 0);
+    CHECK_EQUAL(4, pwrite(fd, "XXXX", 4, 0));
+    close(fd);
+
+    std::vector<int> entries{};
+    std::string other{};
+    CHECK(readRing("", entries, other) != 0);
+    CHECK(entries.empty());
+
+    //a writer does not append to a ring with an invalid header, but starts a new ring
+    writer = celix_logWriter_create(ctx);
+    CHECK(writer != nullptr);
+    logEntries(100, 105);
+    other.clear();
+    CHECK_EQUAL(0, readRing("", entries, other));
+    CHECK_EQUAL(5, (int)entries.size());
+    checkConsecutive(entries, 104);
+}
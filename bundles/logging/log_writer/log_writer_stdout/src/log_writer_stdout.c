@@ -19,32 +19,180 @@
 
 #include <stdlib.h>
 #include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <time.h>
 
 #include "celix_errno.h"
 #include "celixbool.h"
+#include "celix_threads.h"
 
 #include "celix_log_writer.h"
+#include "celix_log_writer_throttle.h"
+#include "celix_log_writer_format.h"
 #include "log_listener.h"
 
 #include "module.h"
 #include "bundle.h"
 
+#define LOG_WRITER_STDOUT_FLUSH_INTERVAL_NAME       "CELIX_LOG_WRITER_FLUSH_INTERVAL"
+#define LOG_WRITER_STDOUT_FLUSH_INTERVAL_DEFAULT    0 //in ms, 0 flushes after every delivered batch
+
+#define LOG_WRITER_STDOUT_BUFFER_SIZE               (64 * 1024)
+#define LOG_WRITER_STDOUT_MAX_LINE_LENGTH           4096
+
 struct celix_log_writer {
-    //empty
+    celix_log_writer_throttle_t *throttle;
+    celix_log_writer_format_t *format;
+    long flushIntervalInMs;
+    celix_thread_t flushThread;
+
+    celix_thread_mutex_t mutex; //protects below
+    celix_thread_cond_t cond;
+    bool running;
+    size_t bufferSize;
+    char buffer[LOG_WRITER_STDOUT_BUFFER_SIZE];
 };
 
-celix_log_writer_t* celix_logWriter_create(celix_bundle_context_t *ctx __attribute__((unused))) { return NULL; }
-void celix_logWriter_destroy(celix_log_writer_t *writer __attribute__((unused))) {/*nop*/}
-celix_status_t celix_logWriter_logged(celix_log_writer_t *writer __attribute__((unused)), log_entry_t *entry) {
+static void* celix_logWriter_flushThread(void *data);
 
-	celix_status_t status = CELIX_SUCCESS;
+celix_log_writer_t* celix_logWriter_create(celix_bundle_context_t *ctx) {
+    celix_log_writer_t *writer = calloc(1, sizeof(*writer));
+    if (writer == NULL) {
+        return NULL;
+    }
+    writer->throttle = celix_logWriterThrottle_create(ctx);
+    writer->format = celix_logWriterFormat_create(ctx);
+    writer->flushIntervalInMs = celix_bundleContext_getPropertyAsLong(ctx, LOG_WRITER_STDOUT_FLUSH_INTERVAL_NAME, LOG_WRITER_STDOUT_FLUSH_INTERVAL_DEFAULT);
+    celixThreadMutex_create(&writer->mutex, NULL);
+    celixThreadCondition_init(&writer->cond, NULL);
+    writer->running = true;
+    if (writer->throttle == NULL || writer->format == NULL) {
+        celix_logWriter_destroy(writer);
+        return NULL;
+    }
+    if (writer->flushIntervalInMs > 0) {
+        if (celixThread_create(&writer->flushThread, NULL, celix_logWriter_flushThread, writer) != CELIX_SUCCESS) {
+            writer->flushIntervalInMs = 0; //fallback to a flush after every batch
+        } else {
+            celixThread_setName(&writer->flushThread, "LogWriterFlush");
+        }
+    }
+    return writer;
+}
 
-    if (!entry) {
-        status = CELIX_ILLEGAL_ARGUMENT;
-    } else {
-		printf("LogWriter: %s from %s\n", entry->message, entry->bundleSymbolicName);
+/**
+ * Writes the buffered lines with a single write call (more if interrupted or partially written).
+ * Called with the mutex locked.
+ */
+static void celix_logWriter_writeBuffer(celix_log_writer_t *writer) {
+    if (writer->bufferSize == 0) {
+        return;
+    }
+    fflush(stdout); //keep the order with printf output of others
+    size_t written = 0;
+    while (written < writer->bufferSize) {
+        ssize_t rc = write(STDOUT_FILENO, writer->buffer + written, writer->bufferSize - written);
+        if (rc < 0 && errno == EINTR) {
+            continue;
+        } else if (rc <= 0) {
+            break; //stdout closed or broken, drop the buffer
+        }
+        written += (size_t) rc;
     }
+    writer->bufferSize = 0;
+}
+
+/**
+ * Formats the entry in the buffer. Called with the mutex locked.
+ */
+static void celix_logWriter_append(celix_log_writer_t *writer, const log_entry_t *entry) {
+    if (writer->bufferSize + LOG_WRITER_STDOUT_MAX_LINE_LENGTH > sizeof(writer->buffer)) {
+        celix_logWriter_writeBuffer(writer);
+    }
+    writer->bufferSize += celix_logWriterFormat_format(writer->format, entry, writer->buffer + writer->bufferSize, LOG_WRITER_STDOUT_MAX_LINE_LENGTH);
+}
 
-    return status;
+/**
+ * Appends a summary of the entries suppressed by the throttle, as an entry of the log writer itself.
+ */
+static void celix_logWriter_appendSummary(celix_log_writer_t *writer, char *summary) {
+    log_entry_t entry;
+    memset(&entry, 0, sizeof(entry));
+    entry.level = OSGI_LOGSERVICE_WARNING;
+    entry.message = summary;
+    entry.time = time(NULL);
+    clock_gettime(CLOCK_MONOTONIC, &entry.monotonicTime);
+    entry.bundleId = -1;
+    entry.bundleSymbolicName = "apache_celix_log_writer";
+    celix_logWriter_append(writer, &entry);
 }
 
+void celix_logWriter_destroy(celix_log_writer_t *writer) {
+    if (writer == NULL) {
+        return;
+    }
+    celixThreadMutex_lock(&writer->mutex);
+    writer->running = false;
+    celixThreadCondition_signal(&writer->cond);
+    celixThreadMutex_unlock(&writer->mutex);
+    if (writer->flushIntervalInMs > 0) {
+        celixThread_join(writer->flushThread, NULL);
+    }
+
+    if (writer->throttle != NULL && writer->format != NULL) {
+        char summary[256];
+        if (celix_logWriterThrottle_summary(writer->throttle, summary, sizeof(summary))) {
+            celix_logWriter_appendSummary(writer, summary);
+        }
+    }
+    celix_logWriter_writeBuffer(writer);
+    celix_logWriterThrottle_destroy(writer->throttle);
+    celix_logWriterFormat_destroy(writer->format);
+
+    celixThreadCondition_destroy(&writer->cond);
+    celixThreadMutex_destroy(&writer->mutex);
+    free(writer);
+}
+
+celix_status_t celix_logWriter_logged(celix_log_writer_t *writer, log_entry_t *entry) {
+    if (writer == NULL || entry == NULL) {
+        return CELIX_ILLEGAL_ARGUMENT;
+    }
+
+    char summary[256];
+    celixThreadMutex_lock(&writer->mutex);
+    if (celix_logWriterThrottle_accept(writer->throttle, entry, summary, sizeof(summary))) {
+        if (summary[0] != '\0') {
+            celix_logWriter_appendSummary(writer, summary);
+        }
+        celix_logWriter_append(writer, entry);
+    }
+    celixThreadMutex_unlock(&writer->mutex);
+
+    return CELIX_SUCCESS;
+}
+
+celix_status_t celix_logWriter_flush(celix_log_writer_t *writer) {
+    if (writer == NULL) {
+        return CELIX_ILLEGAL_ARGUMENT;
+    }
+    if (writer->flushIntervalInMs <= 0) {
+        celixThreadMutex_lock(&writer->mutex);
+        celix_logWriter_writeBuffer(writer);
+        celixThreadMutex_unlock(&writer->mutex);
+    } //else written by the flush thread
+    return CELIX_SUCCESS;
+}
+
+static void* celix_logWriter_flushThread(void *data) {
+    celix_log_writer_t *writer = data;
+    celixThreadMutex_lock(&writer->mutex);
+    while (writer->running) {
+        celixThreadCondition_timedwaitRelative(&writer->cond, &writer->mutex, writer->flushIntervalInMs / 1000, (writer->flushIntervalInMs % 1000) * 1000000);
+        celix_logWriter_writeBuffer(writer);
+    }
+    celixThreadMutex_unlock(&writer->mutex);
+    return NULL;
+}
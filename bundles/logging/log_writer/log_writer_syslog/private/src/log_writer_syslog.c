@@ -22,8 +22,10 @@
 
 #include "celix_errno.h"
 #include "celixbool.h"
+#include "celix_threads.h"
 
 #include "celix_log_writer.h"
+#include "celix_log_writer_throttle.h"
 #include "log_listener.h"
 
 #include "module.h"
@@ -32,15 +34,53 @@
 #include <syslog.h>
 
 struct celix_log_writer {
-	//empty
+	celix_thread_mutex_t mutex; //protects throttle
+	celix_log_writer_throttle_t *throttle;
 };
 
-celix_log_writer_t* celix_logWriter_create(celix_bundle_context_t *ctx __attribute__((unused))) { return NULL; }
-void celix_logWriter_destroy(celix_log_writer_t *writer __attribute__((unused))) {/*nop*/}
+celix_log_writer_t* celix_logWriter_create(celix_bundle_context_t *ctx) {
+	celix_log_writer_t *writer = calloc(1, sizeof(*writer));
+	if (writer != NULL) {
+		writer->throttle = celix_logWriterThrottle_create(ctx);
+		if (writer->throttle == NULL) {
+			free(writer);
+			return NULL;
+		}
+		celixThreadMutex_create(&writer->mutex, NULL);
+		//connect now and keep the connection, instead of (re)connecting while logging
+		openlog(NULL, LOG_NDELAY, LOG_USER);
+	}
+	return writer;
+}
+
+void celix_logWriter_destroy(celix_log_writer_t *writer) {
+	if (writer != NULL) {
+		char summary[256];
+		if (celix_logWriterThrottle_summary(writer->throttle, summary, sizeof(summary))) {
+			syslog(LOG_MAKEPRI(LOG_FAC(LOG_USER), LOG_WARNING), "[apache_celix_log_writer_syslog]: %s", summary);
+		}
+		closelog();
+		celix_logWriterThrottle_destroy(writer->throttle);
+		celixThreadMutex_destroy(&writer->mutex);
+		free(writer);
+	}
+}
 
-celix_status_t celix_logWriter_logged(celix_log_writer_t *writer __attribute__((unused)), log_entry_t *entry) {
+celix_status_t celix_logWriter_logged(celix_log_writer_t *writer, log_entry_t *entry) {
 	celix_status_t status = CELIX_SUCCESS;
 
+	if (writer == NULL || entry == NULL) {
+		return CELIX_ILLEGAL_ARGUMENT;
+	}
+
+	char summary[256];
+	celixThreadMutex_lock(&writer->mutex);
+	bool accepted = celix_logWriterThrottle_accept(writer->throttle, entry, summary, sizeof(summary));
+	celixThreadMutex_unlock(&writer->mutex);
+	if (!accepted) {
+		return status;
+	}
+
 	int sysLogLvl = -1;
 
 	switch(entry->level)
@@ -62,7 +102,15 @@ celix_status_t celix_logWriter_logged(celix_log_writer_t *writer __attribute__((
 			break;
 	}
 
+	if (summary[0] != '\0') {
+		syslog(LOG_MAKEPRI(LOG_FAC(LOG_USER), LOG_WARNING), "[apache_celix_log_writer_syslog]: %s", summary);
+	}
 	syslog(sysLogLvl, "[%s]: %s", entry->bundleSymbolicName, entry->message);
 
     return status;
 }
+
+celix_status_t celix_logWriter_flush(celix_log_writer_t *writer __attribute__((unused))) {
+	//nop, syslog entries are written directly over the (kept open) syslog connection
+	return CELIX_SUCCESS;
+}
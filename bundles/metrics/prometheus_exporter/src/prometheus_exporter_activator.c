@@ -0,0 +1,186 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *  KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+
+#include <celix_api.h>
+#include <civetweb.h>
+
+#include "celix_metrics_service.h"
+#include "http_admin/api.h"
+
+#define PROMETHEUS_EXPORTER_URI_NAME        "CELIX_PROMETHEUS_EXPORTER_URI"
+#define PROMETHEUS_EXPORTER_URI_DEFAULT     "/metrics"
+
+typedef struct prometheus_exporter_activator_data {
+    celix_bundle_context_t *ctx;
+
+    celix_thread_mutex_t mutex; //protects providers
+    celix_array_list_t *providers; //value = celix_metrics_provider_service_t*
+    long trackerId;
+
+    celix_http_service_t httpSvc;
+    long httpSvcId;
+} prometheus_exporter_activator_data_t;
+
+typedef struct prometheus_sample {
+    size_t index; //collect order, keeps the order of samples with the same name
+    char *name;
+    celix_metric_type_e type;
+    char *help;
+    char *labels;
+    double value;
+} prometheus_sample_t;
+
+static void prometheusExporter_write(void *handle, const char *name, celix_metric_type_e type, const char *help, const char *labels, double value) {
+    celix_array_list_t *samples = handle;
+    prometheus_sample_t *sample = calloc(1, sizeof(*sample));
+    sample->index = (size_t)celix_arrayList_size(samples);
+    sample->name = strdup(name);
+    sample->type = type;
+    sample->help = help == NULL ? NULL : strdup(help);
+    sample->labels = labels == NULL || labels[0] == '\0' ? NULL : strdup(labels);
+    sample->value = value;
+    celix_arrayList_add(samples, sample);
+}
+
+static int prometheusExporter_compareSamples(const void *a, const void *b) {
+    const prometheus_sample_t *s1 = *(prometheus_sample_t * const *)a;
+    const prometheus_sample_t *s2 = *(prometheus_sample_t * const *)b;
+    int cmp = strcmp(s1->name, s2->name);
+    if (cmp == 0) {
+        cmp = s1->index < s2->index ? -1 : (s1->index > s2->index ? 1 : 0);
+    }
+    return cmp;
+}
+
+/**
+ * Renders the samples in the prometheus text format (version 0.0.4). Samples are grouped by name, with a single
+ * HELP and TYPE line per metric.
+ */
+static void prometheusExporter_render(FILE *out, prometheus_sample_t **samples, size_t size) {
+    qsort(samples, size, sizeof(*samples), prometheusExporter_compareSamples);
+    const char *current = NULL;
+    for (size_t i = 0; i < size; ++i) {
+        prometheus_sample_t *sample = samples[i];
+        if (current == NULL || strcmp(current, sample->name) != 0) {
+            current = sample->name;
+            if (sample->help != NULL) {
+                fprintf(out, "# HELP %s %s\n", sample->name, sample->help);
+            }
+            fprintf(out, "# TYPE %s %s\n", sample->name, sample->type == CELIX_METRIC_COUNTER ? "counter" : "gauge");
+        }
+        if (sample->labels != NULL) {
+            fprintf(out, "%s{%s} %.17g\n", sample->name, sample->labels, sample->value);
+        } else {
+            fprintf(out, "%s %.17g\n", sample->name, sample->value);
+        }
+    }
+}
+
+static int prometheusExporter_doGet(void *handle, struct mg_connection *connection, const char *path __attribute__((unused))) {
+    prometheus_exporter_activator_data_t *act = handle;
+
+    celix_array_list_t *samples = celix_arrayList_create();
+    celix_metrics_writer_t writer;
+    writer.handle = samples;
+    writer.write = prometheusExporter_write;
+
+    celixThreadMutex_lock(&act->mutex);
+    for (int i = 0; i < celix_arrayList_size(act->providers); ++i) {
+        celix_metrics_provider_service_t *provider = celix_arrayList_get(act->providers, i);
+        provider->collect(provider->handle, &writer);
+    }
+    celixThreadMutex_unlock(&act->mutex);
+
+    size_t size = (size_t)celix_arrayList_size(samples);
+    prometheus_sample_t **sorted = calloc(size == 0 ? 1 : size, sizeof(*sorted));
+    for (size_t i = 0; i < size; ++i) {
+        sorted[i] = celix_arrayList_get(samples, (int)i);
+    }
+
+    char *buf = NULL;
+    size_t len = 0;
+    FILE *out = open_memstream(&buf, &len);
+    prometheusExporter_render(out, sorted, size);
+    fclose(out);
+
+    mg_printf(connection, "HTTP/1.1 200 OK\r\nContent-Type: text/plain; version=0.0.4; charset=utf-8\r\nContent-Length: %zu\r\nConnection: close\r\n\r\n", len);
+    mg_write(connection, buf, len);
+    free(buf);
+
+    for (size_t i = 0; i < size; ++i) {
+        free(sorted[i]->name);
+        free(sorted[i]->help);
+        free(sorted[i]->labels);
+        free(sorted[i]);
+    }
+    free(sorted);
+    celix_arrayList_destroy(samples);
+    return 200;
+}
+
+static void prometheusExporter_addProvider(void *handle, void *svc) {
+    prometheus_exporter_activator_data_t *act = handle;
+    celixThreadMutex_lock(&act->mutex);
+    celix_arrayList_add(act->providers, svc);
+    celixThreadMutex_unlock(&act->mutex);
+}
+
+static void prometheusExporter_removeProvider(void *handle, void *svc) {
+    prometheus_exporter_activator_data_t *act = handle;
+    //note waits for a running collect, so that the provider can be removed after this call
+    celixThreadMutex_lock(&act->mutex);
+    celix_arrayList_remove(act->providers, svc);
+    celixThreadMutex_unlock(&act->mutex);
+}
+
+static celix_status_t prometheusExporter_start(prometheus_exporter_activator_data_t *act, celix_bundle_context_t *ctx) {
+    act->ctx = ctx;
+    celixThreadMutex_create(&act->mutex, NULL);
+    act->providers = celix_arrayList_create();
+
+    celix_service_tracking_options_t opts = CELIX_EMPTY_SERVICE_TRACKING_OPTIONS;
+    opts.filter.serviceName = CELIX_METRICS_PROVIDER_SERVICE_NAME;
+    opts.filter.ignoreServiceLanguage = true;
+    opts.callbackHandle = act;
+    opts.add = prometheusExporter_addProvider;
+    opts.remove = prometheusExporter_removeProvider;
+    act->trackerId = celix_bundleContext_trackServicesWithOptions(ctx, &opts);
+
+    celix_properties_t *props = celix_properties_create();
+    celix_properties_set(props, HTTP_ADMIN_URI, celix_bundleContext_getProperty(ctx, PROMETHEUS_EXPORTER_URI_NAME, PROMETHEUS_EXPORTER_URI_DEFAULT));
+    act->httpSvc.handle = act;
+    act->httpSvc.doGet = prometheusExporter_doGet;
+    act->httpSvcId = celix_bundleContext_registerService(ctx, &act->httpSvc, HTTP_ADMIN_SERVICE_NAME, props);
+
+    return CELIX_SUCCESS;
+}
+
+static celix_status_t prometheusExporter_stop(prometheus_exporter_activator_data_t *act, celix_bundle_context_t *ctx) {
+    celix_bundleContext_unregisterService(ctx, act->httpSvcId);
+    celix_bundleContext_stopTracker(ctx, act->trackerId);
+    celix_arrayList_destroy(act->providers);
+    celixThreadMutex_destroy(&act->mutex);
+    return CELIX_SUCCESS;
+}
+
+CELIX_GEN_BUNDLE_ACTIVATOR(prometheus_exporter_activator_data_t, prometheusExporter_start, prometheusExporter_stop)
@@ -0,0 +1,399 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *  KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <time.h>
+
+#include "celix_api.h"
+#include "celix_hash_map.h"
+#include "dyn_interface.h"
+#include "dyn_function.h"
+#include "utils.h"
+#include "log_helper.h"
+
+#include "service_profiler.h"
+
+/**
+ * Nr of call duration buckets, bucket i counts the calls which took less than 2^i ns (and at least 2^(i-1) ns).
+ * The last bucket also counts all longer calls (>= ~275 sec).
+ */
+#define SERVICE_PROFILER_NR_OF_BUCKETS 39
+
+typedef struct service_profiler_method_stats {
+    char *name; //method name
+    uint64_t nrOfCalls; //atomic
+    uint64_t sumInNs; //atomic
+    uint64_t maxInNs; //atomic
+    uint64_t buckets[SERVICE_PROFILER_NR_OF_BUCKETS]; //atomic
+} service_profiler_method_stats_t;
+
+/**
+ * The call statistics of a service (svc id), shared by all wrappers of the service. Kept after the wrappers are
+ * released, so that the statistics stay available.
+ */
+typedef struct service_profiler_stats {
+    long svcId;
+    char *serviceName;
+    long providerId;
+    int nrOfMethods;
+    service_profiler_method_stats_t *methods; //index is the method index of the interface
+} service_profiler_stats_t;
+
+struct generic_service_layout {
+    void *handle;
+    void (*methods[])(void);
+};
+
+/**
+ * Wrapper handed out to a consumer. Every wrapper has its own interface instance, because a libffi closure is
+ * bound to a dyn function.
+ */
+typedef struct service_profiler_wrapper {
+    void **service; //handed out service: the wrapper (as handle) followed by a closure per method
+    const struct generic_service_layout *svc; //the intercepted service
+    dyn_interface_type *intf;
+    service_profiler_stats_t *stats;
+} service_profiler_wrapper_t;
+
+struct service_profiler {
+    celix_bundle_context_t *ctx;
+    log_helper_t *loghelper;
+
+    celix_thread_mutex_t mutex; //protects below
+    celix_string_hash_map_t *enabled; //key = service name
+    celix_long_hash_map_t *stats; //key = svc id, value = service_profiler_stats_t*
+};
+
+static void serviceProfiler_destroyStats(service_profiler_stats_t *stats) {
+    for (int i = 0; i < stats->nrOfMethods; ++i) {
+        free(stats->methods[i].name);
+    }
+    free(stats->methods);
+    free(stats->serviceName);
+    free(stats);
+}
+
+service_profiler_t* serviceProfiler_create(celix_bundle_context_t *ctx) {
+    service_profiler_t *profiler = calloc(1, sizeof(*profiler));
+    profiler->ctx = ctx;
+    logHelper_create(ctx, &profiler->loghelper);
+    logHelper_start(profiler->loghelper);
+    celixThreadMutex_create(&profiler->mutex, NULL);
+    profiler->enabled = celix_stringHashMap_create();
+    profiler->stats = celix_longHashMap_create();
+
+    const char *services = celix_bundleContext_getProperty(ctx, SERVICE_PROFILER_SERVICES_NAME, NULL);
+    if (services != NULL) {
+        char *copy = strdup(services);
+        char *savePtr = NULL;
+        for (char *name = strtok_r(copy, ",", &savePtr); name != NULL; name = strtok_r(NULL, ",", &savePtr)) {
+            name = utils_stringTrim(name);
+            if (name[0] != '\0') {
+                serviceProfiler_enable(profiler, name);
+            }
+        }
+        free(copy);
+    }
+
+    return profiler;
+}
+
+void serviceProfiler_destroy(service_profiler_t *profiler) {
+    if (profiler != NULL) {
+        //note the service interceptor hook is unregistered, so all wrappers are released.
+        celix_long_hash_map_iterator_t iter;
+        for (iter = celix_longHashMap_begin(profiler->stats); !celix_longHashMapIterator_isEnd(&iter); celix_longHashMapIterator_next(&iter)) {
+            serviceProfiler_destroyStats(iter.value);
+        }
+        celix_longHashMap_destroy(profiler->stats);
+        celix_stringHashMap_destroy(profiler->enabled);
+        celixThreadMutex_destroy(&profiler->mutex);
+        logHelper_stop(profiler->loghelper);
+        logHelper_destroy(&profiler->loghelper);
+        free(profiler);
+    }
+}
+
+void serviceProfiler_enable(service_profiler_t *profiler, const char *serviceName) {
+    celixThreadMutex_lock(&profiler->mutex);
+    celix_stringHashMap_put(profiler->enabled, serviceName, (void*)0x1);
+    celixThreadMutex_unlock(&profiler->mutex);
+}
+
+void serviceProfiler_disable(service_profiler_t *profiler, const char *serviceName) {
+    celixThreadMutex_lock(&profiler->mutex);
+    celix_stringHashMap_remove(profiler->enabled, serviceName);
+    celixThreadMutex_unlock(&profiler->mutex);
+}
+
+static void serviceProfiler_record(service_profiler_method_stats_t *stats, const struct timespec *start) {
+    struct timespec end;
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    uint64_t elapsed = (uint64_t)((end.tv_sec - start->tv_sec) * 1000000000LL + (end.tv_nsec - start->tv_nsec));
+    int bucket = elapsed == 0 ? 0 : 64 - __builtin_clzll(elapsed);
+    if (bucket >= SERVICE_PROFILER_NR_OF_BUCKETS) {
+        bucket = SERVICE_PROFILER_NR_OF_BUCKETS - 1;
+    }
+    __atomic_fetch_add(&stats->nrOfCalls, 1, __ATOMIC_RELAXED);
+    __atomic_fetch_add(&stats->sumInNs, elapsed, __ATOMIC_RELAXED);
+    __atomic_fetch_add(&stats->buckets[bucket], 1, __ATOMIC_RELAXED);
+    uint64_t max = __atomic_load_n(&stats->maxInNs, __ATOMIC_RELAXED);
+    while (elapsed > max && !__atomic_compare_exchange_n(&stats->maxInNs, &max, elapsed, false, __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+        //retry with the updated max
+    }
+}
+
+/**
+ * The closure function of the wrapper methods. Forwards the call to the intercepted service, with the handle of
+ * the intercepted service as first argument.
+ */
+static void serviceProfiler_callProxy(void *userData, void *args[], void *returnVal) {
+    struct method_entry *entry = userData;
+    service_profiler_wrapper_t *wrapper = *((void **)args[0]);
+
+    int nrOfArgs = dynFunction_nrOfArguments(entry->dynFunc);
+    void *forwardArgs[nrOfArgs > 0 ? nrOfArgs : 1];
+    memcpy(forwardArgs, args, sizeof(void*) * nrOfArgs);
+    void *handle = wrapper->svc->handle;
+    forwardArgs[0] = &handle;
+
+    struct timespec start;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    dynFunction_call(entry->dynFunc, wrapper->svc->methods[entry->index], returnVal, forwardArgs);
+    serviceProfiler_record(&wrapper->stats->methods[entry->index], &start);
+}
+
+static FILE* serviceProfiler_openDescriptor(const celix_bundle_t *provider, const char *serviceName) {
+    static const char * const dirs[] = {"", "META-INF/descriptors/", "META-INF/descriptors/services/"};
+    FILE *descriptor = NULL;
+    char entryName[512];
+    for (size_t i = 0; descriptor == NULL && i < sizeof(dirs) / sizeof(dirs[0]); ++i) {
+        snprintf(entryName, sizeof(entryName), "%s%s.descriptor", dirs[i], serviceName);
+        char *path = celix_bundle_getEntry(provider, entryName);
+        if (path != NULL) {
+            descriptor = fopen(path, "r");
+        }
+        free(path);
+    }
+    return descriptor;
+}
+
+static service_profiler_stats_t* serviceProfiler_getOrCreateStats(service_profiler_t *profiler, long svcId, const char *serviceName, const celix_bundle_t *provider, dyn_interface_type *intf) {
+    service_profiler_stats_t *stats = celix_longHashMap_get(profiler->stats, svcId);
+    if (stats == NULL) {
+        stats = calloc(1, sizeof(*stats));
+        stats->svcId = svcId;
+        stats->serviceName = strdup(serviceName);
+        stats->providerId = celix_bundle_getId(provider);
+        stats->nrOfMethods = dynInterface_nrOfMethods(intf);
+        stats->methods = calloc(stats->nrOfMethods > 0 ? stats->nrOfMethods : 1, sizeof(*stats->methods));
+        struct methods_head *list = NULL;
+        dynInterface_methods(intf, &list);
+        struct method_entry *entry = NULL;
+        TAILQ_FOREACH(entry, list, entries) {
+            if (entry->index < stats->nrOfMethods) {
+                stats->methods[entry->index].name = strdup(entry->name);
+            }
+        }
+        celix_longHashMap_put(profiler->stats, svcId, stats);
+    }
+    return stats;
+}
+
+static void serviceProfiler_destroyWrapper(service_profiler_wrapper_t *wrapper) {
+    if (wrapper != NULL) {
+        if (wrapper->intf != NULL) {
+            dynInterface_destroy(wrapper->intf); //note also releases the closures
+        }
+        free(wrapper->service);
+        free(wrapper);
+    }
+}
+
+void* serviceProfiler_intercept(void *handle, const celix_bundle_t *consumer, const celix_bundle_t *provider, const celix_properties_t *svcProperties, const void *svc) {
+    service_profiler_t *profiler = handle;
+
+    const char *serviceName = celix_properties_get(svcProperties, OSGI_FRAMEWORK_OBJECTCLASS, NULL);
+    const char *lang = celix_properties_get(svcProperties, CELIX_FRAMEWORK_SERVICE_LANGUAGE, CELIX_FRAMEWORK_SERVICE_C_LANGUAGE);
+    if (serviceName == NULL || strcmp(lang, CELIX_FRAMEWORK_SERVICE_C_LANGUAGE) != 0 || celix_bundle_getId(provider) == 0 ||
+        celix_bundle_getId(consumer) == celix_bundle_getId(celix_bundleContext_getBundle(profiler->ctx))) {
+        return NULL;
+    }
+
+    celixThreadMutex_lock(&profiler->mutex);
+    bool enabled = celix_stringHashMap_hasKey(profiler->enabled, serviceName);
+    celixThreadMutex_unlock(&profiler->mutex);
+    if (!enabled) {
+        return NULL;
+    }
+
+    FILE *descriptor = serviceProfiler_openDescriptor(provider, serviceName);
+    if (descriptor == NULL) {
+        logHelper_log(profiler->loghelper, OSGI_LOGSERVICE_WARNING, "Cannot profile service '%s', no descriptor found in bundle %li", serviceName, celix_bundle_getId(provider));
+        return NULL;
+    }
+    service_profiler_wrapper_t *wrapper = calloc(1, sizeof(*wrapper));
+    int rc = dynInterface_parse(descriptor, &wrapper->intf);
+    fclose(descriptor);
+
+    if (rc == 0) {
+        wrapper->svc = svc;
+        wrapper->service = calloc(1 + dynInterface_nrOfMethods(wrapper->intf), sizeof(void*));
+        wrapper->service[0] = wrapper;
+        struct methods_head *list = NULL;
+        dynInterface_methods(wrapper->intf, &list);
+        struct method_entry *entry = NULL;
+        TAILQ_FOREACH(entry, list, entries) {
+            void (*fn)(void) = NULL;
+            rc = dynFunction_createClosure(entry->dynFunc, serviceProfiler_callProxy, entry, &fn);
+            if (rc != 0) {
+                break;
+            }
+            wrapper->service[entry->index + 1] = fn;
+        }
+    }
+
+    if (rc != 0) {
+        logHelper_log(profiler->loghelper, OSGI_LOGSERVICE_WARNING, "Cannot profile service '%s', cannot create wrapper from descriptor", serviceName);
+        serviceProfiler_destroyWrapper(wrapper);
+        return NULL;
+    }
+
+    long svcId = celix_properties_getAsLong(svcProperties, OSGI_FRAMEWORK_SERVICE_ID, -1L);
+    celixThreadMutex_lock(&profiler->mutex);
+    wrapper->stats = serviceProfiler_getOrCreateStats(profiler, svcId, serviceName, provider, wrapper->intf);
+    celixThreadMutex_unlock(&profiler->mutex);
+    return wrapper->service;
+}
+
+void serviceProfiler_release(void *handle __attribute__((unused)), void *service) {
+    void **svc = service;
+    serviceProfiler_destroyWrapper(svc[0]);
+}
+
+static uint64_t serviceProfiler_percentile(const service_profiler_method_stats_t *stats, uint64_t nrOfCalls, double percentile) {
+    uint64_t threshold = (uint64_t)((double)nrOfCalls * percentile / 100.0);
+    uint64_t max = __atomic_load_n(&stats->maxInNs, __ATOMIC_RELAXED);
+    uint64_t count = 0;
+    for (int i = 0; i < SERVICE_PROFILER_NR_OF_BUCKETS; ++i) {
+        count += __atomic_load_n(&stats->buckets[i], __ATOMIC_RELAXED);
+        if (count >= threshold) {
+            uint64_t upper = 1ULL << i; //upper bound of the bucket
+            return upper < max ? upper : max;
+        }
+    }
+    return max;
+}
+
+void serviceProfiler_collectMetrics(void *handle, const celix_metrics_writer_t *writer) {
+    service_profiler_t *profiler = handle;
+    char labels[512];
+    char statLabels[560];
+    celixThreadMutex_lock(&profiler->mutex);
+    celix_long_hash_map_iterator_t iter;
+    for (iter = celix_longHashMap_begin(profiler->stats); !celix_longHashMapIterator_isEnd(&iter); celix_longHashMapIterator_next(&iter)) {
+        service_profiler_stats_t *stats = iter.value;
+        for (int i = 0; i < stats->nrOfMethods; ++i) {
+            service_profiler_method_stats_t *method = &stats->methods[i];
+            uint64_t nrOfCalls = __atomic_load_n(&method->nrOfCalls, __ATOMIC_RELAXED);
+            snprintf(labels, sizeof(labels), "service=\"%s\",svc_id=\"%li\",bnd=\"%li\",method=\"%s\"",
+                     stats->serviceName, stats->svcId, stats->providerId, method->name == NULL ? "unknown" : method->name);
+            writer->write(writer->handle, "celix_service_calls_total", CELIX_METRIC_COUNTER, "Nr of calls of a profiled service method", labels, (double)nrOfCalls);
+            if (nrOfCalls > 0) {
+                uint64_t sum = __atomic_load_n(&method->sumInNs, __ATOMIC_RELAXED);
+                snprintf(statLabels, sizeof(statLabels), "%s,stat=\"mean\"", labels);
+                writer->write(writer->handle, "celix_service_call_seconds", CELIX_METRIC_GAUGE, "Call duration of a profiled service method", statLabels, (double)(sum / nrOfCalls) / 1e9);
+                snprintf(statLabels, sizeof(statLabels), "%s,stat=\"p99\"", labels);
+                writer->write(writer->handle, "celix_service_call_seconds", CELIX_METRIC_GAUGE, "Call duration of a profiled service method", statLabels, (double)serviceProfiler_percentile(method, nrOfCalls, 99.0) / 1e9);
+                snprintf(statLabels, sizeof(statLabels), "%s,stat=\"max\"", labels);
+                writer->write(writer->handle, "celix_service_call_seconds", CELIX_METRIC_GAUGE, "Call duration of a profiled service method", statLabels, (double)__atomic_load_n(&method->maxInNs, __ATOMIC_RELAXED) / 1e9);
+            }
+        }
+    }
+    celixThreadMutex_unlock(&profiler->mutex);
+}
+
+static void serviceProfiler_printStats(service_profiler_t *profiler, FILE *out) {
+    celixThreadMutex_lock(&profiler->mutex);
+    fprintf(out, "Profiled service names:\n");
+    celix_string_hash_map_iterator_t nameIter;
+    for (nameIter = celix_stringHashMap_begin(profiler->enabled); !celix_stringHashMapIterator_isEnd(&nameIter); celix_stringHashMapIterator_next(&nameIter)) {
+        fprintf(out, "   %s\n", nameIter.key);
+    }
+    celix_long_hash_map_iterator_t iter;
+    for (iter = celix_longHashMap_begin(profiler->stats); !celix_longHashMapIterator_isEnd(&iter); celix_longHashMapIterator_next(&iter)) {
+        service_profiler_stats_t *stats = iter.value;
+        fprintf(out, "\nService %s (svc id %li, bundle %li):\n", stats->serviceName, stats->svcId, stats->providerId);
+        fprintf(out, "   %-32s %12s %12s %12s %12s\n", "method", "calls", "mean (us)", "p99 (us)", "max (us)");
+        for (int i = 0; i < stats->nrOfMethods; ++i) {
+            service_profiler_method_stats_t *method = &stats->methods[i];
+            uint64_t nrOfCalls = __atomic_load_n(&method->nrOfCalls, __ATOMIC_RELAXED);
+            uint64_t sum = __atomic_load_n(&method->sumInNs, __ATOMIC_RELAXED);
+            fprintf(out, "   %-32s %12llu %12.3f %12.3f %12.3f\n", method->name == NULL ? "unknown" : method->name,
+                    (unsigned long long)nrOfCalls,
+                    nrOfCalls == 0 ? 0.0 : (double)(sum / nrOfCalls) / 1e3,
+                    nrOfCalls == 0 ? 0.0 : (double)serviceProfiler_percentile(method, nrOfCalls, 99.0) / 1e3,
+                    (double)__atomic_load_n(&method->maxInNs, __ATOMIC_RELAXED) / 1e3);
+        }
+    }
+    celixThreadMutex_unlock(&profiler->mutex);
+}
+
+static void serviceProfiler_reset(service_profiler_t *profiler) {
+    celixThreadMutex_lock(&profiler->mutex);
+    celix_long_hash_map_iterator_t iter;
+    for (iter = celix_longHashMap_begin(profiler->stats); !celix_longHashMapIterator_isEnd(&iter); celix_longHashMapIterator_next(&iter)) {
+        service_profiler_stats_t *stats = iter.value;
+        for (int i = 0; i < stats->nrOfMethods; ++i) {
+            service_profiler_method_stats_t *method = &stats->methods[i];
+            __atomic_store_n(&method->nrOfCalls, 0, __ATOMIC_RELAXED);
+            __atomic_store_n(&method->sumInNs, 0, __ATOMIC_RELAXED);
+            __atomic_store_n(&method->maxInNs, 0, __ATOMIC_RELAXED);
+            for (int k = 0; k < SERVICE_PROFILER_NR_OF_BUCKETS; ++k) {
+                __atomic_store_n(&method->buckets[k], 0, __ATOMIC_RELAXED);
+            }
+        }
+    }
+    celixThreadMutex_unlock(&profiler->mutex);
+}
+
+celix_status_t serviceProfiler_executeCommand(void *handle, char *commandLine, FILE *out, FILE *err) {
+    service_profiler_t *profiler = handle;
+    char *savePtr = NULL;
+    strtok_r(commandLine, " ", &savePtr); //skip command name
+    char *subCmd = strtok_r(NULL, " ", &savePtr);
+    char *serviceName = strtok_r(NULL, " ", &savePtr);
+
+    if (subCmd == NULL || strcmp(subCmd, "list") == 0) {
+        serviceProfiler_printStats(profiler, out);
+    } else if (strcmp(subCmd, "enable") == 0 && serviceName != NULL) {
+        serviceProfiler_enable(profiler, serviceName);
+        fprintf(out, "Enabled profiling for '%s'. Only affects consumers getting the service from now on.\n", serviceName);
+    } else if (strcmp(subCmd, "disable") == 0 && serviceName != NULL) {
+        serviceProfiler_disable(profiler, serviceName);
+        fprintf(out, "Disabled profiling for '%s'.\n", serviceName);
+    } else if (strcmp(subCmd, "reset") == 0) {
+        serviceProfiler_reset(profiler);
+    } else {
+        fprintf(err, "Usage: profile [list | enable <service name> | disable <service name> | reset]\n");
+    }
+    return CELIX_SUCCESS;
+}
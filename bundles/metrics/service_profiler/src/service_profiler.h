@@ -0,0 +1,63 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *  KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#ifndef SERVICE_PROFILER_H_
+#define SERVICE_PROFILER_H_
+
+#include <stdio.h>
+
+#include "celix_bundle_context.h"
+#include "celix_metrics_service.h"
+
+#define SERVICE_PROFILER_SERVICES_NAME      "CELIX_SERVICE_PROFILER_SERVICES"
+
+typedef struct service_profiler service_profiler_t;
+
+/**
+ * Creates the profiler. The services names of the (comma separated) CELIX_SERVICE_PROFILER_SERVICES config property
+ * are enabled.
+ */
+service_profiler_t* serviceProfiler_create(celix_bundle_context_t *ctx);
+void serviceProfiler_destroy(service_profiler_t *profiler);
+
+/**
+ * Enables profiling for the service name. Only affects consumers getting the service after this call.
+ */
+void serviceProfiler_enable(service_profiler_t *profiler, const char *serviceName);
+
+/**
+ * Disables profiling for the service name. Consumers already using a wrapper keep using it (and are still profiled)
+ * until they release the service.
+ */
+void serviceProfiler_disable(service_profiler_t *profiler, const char *serviceName);
+
+/**
+ * Service interceptor hook functions, see celix_service_interceptor_hook.h
+ */
+void* serviceProfiler_intercept(void *handle, const celix_bundle_t *consumer, const celix_bundle_t *provider, const celix_properties_t *svcProperties, const void *svc);
+void serviceProfiler_release(void *handle, void *wrapper);
+
+/**
+ * Metrics provider collect function, see celix_metrics_service.h
+ */
+void serviceProfiler_collectMetrics(void *handle, const celix_metrics_writer_t *writer);
+
+celix_status_t serviceProfiler_executeCommand(void *handle, char *commandLine, FILE *out, FILE *err);
+
+#endif /* SERVICE_PROFILER_H_ */
@@ -0,0 +1,74 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *  KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <stdlib.h>
+
+#include <celix_api.h>
+
+#include "celix_service_interceptor_hook.h"
+#include "celix_metrics_service.h"
+#include "command.h"
+#include "service_profiler.h"
+
+typedef struct service_profiler_activator_data {
+    service_profiler_t *profiler;
+
+    celix_service_interceptor_hook_t hookSvc;
+    long hookSvcId;
+
+    celix_metrics_provider_service_t metricsSvc;
+    long metricsSvcId;
+
+    command_service_t cmdSvc;
+    long cmdSvcId;
+} service_profiler_activator_data_t;
+
+static celix_status_t serviceProfilerActivator_start(service_profiler_activator_data_t *act, celix_bundle_context_t *ctx) {
+    act->profiler = serviceProfiler_create(ctx);
+
+    act->hookSvc.handle = act->profiler;
+    act->hookSvc.intercept = serviceProfiler_intercept;
+    act->hookSvc.release = serviceProfiler_release;
+    act->hookSvcId = celix_bundleContext_registerService(ctx, &act->hookSvc, CELIX_SERVICE_INTERCEPTOR_HOOK_SERVICE_NAME, NULL);
+
+    act->metricsSvc.handle = act->profiler;
+    act->metricsSvc.collect = serviceProfiler_collectMetrics;
+    act->metricsSvcId = celix_bundleContext_registerService(ctx, &act->metricsSvc, CELIX_METRICS_PROVIDER_SERVICE_NAME, NULL);
+
+    act->cmdSvc.handle = act->profiler;
+    act->cmdSvc.executeCommand = serviceProfiler_executeCommand;
+    celix_properties_t *props = celix_properties_create();
+    celix_properties_set(props, OSGI_SHELL_COMMAND_NAME, "profile");
+    celix_properties_set(props, OSGI_SHELL_COMMAND_USAGE, "profile [list | enable <service name> | disable <service name> | reset]");
+    celix_properties_set(props, OSGI_SHELL_COMMAND_DESCRIPTION, "Profiles the calls of services with a dfi descriptor: call counts and latencies per method.");
+    act->cmdSvcId = celix_bundleContext_registerService(ctx, &act->cmdSvc, OSGI_SHELL_COMMAND_SERVICE_NAME, props);
+
+    return CELIX_SUCCESS;
+}
+
+static celix_status_t serviceProfilerActivator_stop(service_profiler_activator_data_t *act, celix_bundle_context_t *ctx) {
+    celix_bundleContext_unregisterService(ctx, act->cmdSvcId);
+    celix_bundleContext_unregisterService(ctx, act->metricsSvcId);
+    //note blocks until all wrappers are released by their consumers
+    celix_bundleContext_unregisterService(ctx, act->hookSvcId);
+    serviceProfiler_destroy(act->profiler);
+    return CELIX_SUCCESS;
+}
+
+CELIX_GEN_BUNDLE_ACTIVATOR(service_profiler_activator_data_t, serviceProfilerActivator_start, serviceProfilerActivator_stop)
@@ -0,0 +1,39 @@
+#!/bin/bash
+# Licensed to the Apache Software Foundation (ASF) under one
+# or more contributor license agreements.  See the NOTICE file
+# distributed with this work for additional information
+# regarding copyright ownership.  The ASF licenses this file
+# to you under the Apache License, Version 2.0 (the
+# "License"); you may not use this file except in compliance
+# with the License.  You may obtain a copy of the License at
+#
+#   http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing,
+# software distributed under the License is distributed on an
+# "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+#  KIND, either express or implied.  See the License for the
+# specific language governing permissions and limitations
+# under the License.
+
+# Smoke test of the benchmark: runs a short benchmark with every msg type for the given containers and checks that
+# every container reports a run in which msgs were received.
+# Usage: benchmark_smoke_test.sh <deploy dir> <container>...
+
+BENCHMARK_DIR=$1
+shift
+export BENCHMARK_DURATION=1
+export BENCHMARK_IDLE_TIMEOUT=1
+export BENCHMARK_RATE=1000
+
+for MSG_TYPE in bytes doubles struct; do
+    for CONTAINER in "$@"; do
+        BENCHMARK_MSG_TYPE=${MSG_TYPE} "${BENCHMARK_DIR}/run_benchmarks.sh" "${CONTAINER}" > /dev/null
+        RESULT=$(grep "\"msgType\":\"benchmark_${MSG_TYPE}\"" "${BENCHMARK_DIR}/benchmark_results.json")
+        if [ -z "${RESULT}" ] || echo "${RESULT}" | grep -q "\"nrOfMsgs\":0,"; then
+            echo "No benchmark_${MSG_TYPE} msgs received by ${CONTAINER}"
+            exit 1
+        fi
+    done
+done
+echo "Benchmark smoke test succeeded"
@@ -0,0 +1,71 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *  KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#ifndef BENCHMARK_MSG_H_
+#define BENCHMARK_MSG_H_
+
+#include <stdint.h>
+
+/**
+ * Config properties of the benchmark publisher and subscriber.
+ */
+#define BENCHMARK_TOPIC_KEY                     "BENCHMARK_TOPIC"
+#define BENCHMARK_TOPIC_DEFAULT                 "benchmark"
+#define BENCHMARK_MSG_TYPE_KEY                  "BENCHMARK_MSG_TYPE" //bytes, doubles or struct
+#define BENCHMARK_MSG_TYPE_DEFAULT              "bytes"
+#define BENCHMARK_MSG_SIZE_KEY                  "BENCHMARK_MSG_SIZE" //payload size in bytes
+#define BENCHMARK_MSG_SIZE_DEFAULT              64
+#define BENCHMARK_RATE_KEY                      "BENCHMARK_RATE" //msgs per second, 0 is as fast as possible
+#define BENCHMARK_RATE_DEFAULT                  0
+#define BENCHMARK_DURATION_KEY                  "BENCHMARK_DURATION" //seconds
+#define BENCHMARK_DURATION_DEFAULT              10
+#define BENCHMARK_LABEL_KEY                     "BENCHMARK_LABEL" //e.g. the PSA and serializer, added to the results
+#define BENCHMARK_LABEL_DEFAULT                 "benchmark"
+#define BENCHMARK_RESULT_FILE_KEY               "BENCHMARK_RESULT_FILE" //a json object per run is appended
+#define BENCHMARK_RESULT_FILE_DEFAULT           "benchmark_results.json"
+#define BENCHMARK_IDLE_TIMEOUT_KEY              "BENCHMARK_IDLE_TIMEOUT" //seconds without msgs which ends a run
+#define BENCHMARK_IDLE_TIMEOUT_DEFAULT          2
+
+#define BENCHMARK_BYTES_MSG_NAME                "benchmark_bytes"
+#define BENCHMARK_DOUBLES_MSG_NAME              "benchmark_doubles"
+#define BENCHMARK_STRUCT_MSG_NAME               "benchmark_struct"
+
+typedef struct benchmark_sample {
+    double x;
+    double y;
+    double z;
+    int32_t id;
+    char *name;
+} benchmark_sample_t;
+
+/**
+ * The layout of all benchmark msgs, only the element type of the payload sequence differs:
+ * int8_t (benchmark_bytes), double (benchmark_doubles) or benchmark_sample_t (benchmark_struct).
+ */
+typedef struct benchmark_msg {
+    uint32_t seqNr;
+    uint64_t sendTime; //ns since epoch
+    struct {
+        uint32_t cap;
+        uint32_t len;
+        void *buf;
+    } payload;
+} benchmark_msg_t;
+
+#endif /* BENCHMARK_MSG_H_ */
@@ -0,0 +1,40 @@
+#!/bin/bash
+# Licensed to the Apache Software Foundation (ASF) under one
+# or more contributor license agreements.  See the NOTICE file
+# distributed with this work for additional information
+# regarding copyright ownership.  The ASF licenses this file
+# to you under the Apache License, Version 2.0 (the
+# "License"); you may not use this file except in compliance
+# with the License.  You may obtain a copy of the License at
+#
+#   http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing,
+# software distributed under the License is distributed on an
+# "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+#  KIND, either express or implied.  See the License for the
+# specific language governing permissions and limitations
+# under the License.
+
+# Runs all (or the provided) pubsub benchmark containers and collects the results in benchmark_results.json, a json
+# object per line. The benchmark can be configured with the BENCHMARK_* environment variables, e.g.
+#   BENCHMARK_MSG_TYPE=struct BENCHMARK_MSG_SIZE=4096 BENCHMARK_RATE=10000 ./run_benchmarks.sh pubsub_benchmark_tcp_json
+
+BENCHMARK_DIR=$(cd "$(dirname "$0")" && pwd)
+RESULTS=${BENCHMARK_DIR}/benchmark_results.json
+export BENCHMARK_DURATION=${BENCHMARK_DURATION:-10}
+export BENCHMARK_IDLE_TIMEOUT=${BENCHMARK_IDLE_TIMEOUT:-2}
+export BENCHMARK_RESULT_FILE=${RESULTS}
+
+CONTAINERS="$*"
+if [ -z "${CONTAINERS}" ]; then
+    CONTAINERS=$(cd "${BENCHMARK_DIR}" && ls -d pubsub_benchmark_*/ | tr -d /)
+fi
+
+rm -f "${RESULTS}"
+for CONTAINER in ${CONTAINERS}; do
+    echo "Running ${CONTAINER}"
+    #note SIGINT stops the framework, so that the subscriber reports a run which did not go idle
+    (cd "${BENCHMARK_DIR}/${CONTAINER}" && timeout -s INT $((BENCHMARK_DURATION + BENCHMARK_IDLE_TIMEOUT + 10)) ./${CONTAINER})
+done
+echo "Results written to ${RESULTS}"
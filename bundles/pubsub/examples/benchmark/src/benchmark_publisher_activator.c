@@ -0,0 +1,192 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *  KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+#include "celix_api.h"
+#include "pubsub/publisher.h"
+
+#include "benchmark_msg.h"
+
+typedef struct benchmark_publisher {
+    celix_bundle_context_t *ctx;
+    char topic[128];
+    const char *msgName;
+    size_t elementSize;
+    long msgSize;
+    long rate;
+    long duration;
+
+    long trackerId;
+    celix_thread_t thread;
+
+    celix_thread_mutex_t mutex; //protects below
+    celix_thread_cond_t cond;
+    bool running;
+    pubsub_publisher_t *publisher;
+} benchmark_publisher_t;
+
+static uint64_t benchmark_now(clockid_t clock) {
+    struct timespec now;
+    clock_gettime(clock, &now);
+    return (uint64_t) now.tv_sec * 1000000000UL + (uint64_t) now.tv_nsec;
+}
+
+static void benchmark_publisher_setPublisher(void *handle, void *svc) {
+    benchmark_publisher_t *bench = handle;
+    celixThreadMutex_lock(&bench->mutex);
+    bench->publisher = svc;
+    celixThreadCondition_broadcast(&bench->cond);
+    celixThreadMutex_unlock(&bench->mutex);
+}
+
+static void benchmark_publisher_fillPayload(benchmark_publisher_t *bench, benchmark_msg_t *msg) {
+    uint32_t len = (uint32_t) (bench->msgSize / (long) bench->elementSize);
+    if (len == 0) {
+        len = 1;
+    }
+    msg->payload.cap = len;
+    msg->payload.len = len;
+    msg->payload.buf = calloc(len, bench->elementSize);
+    if (bench->elementSize == sizeof(benchmark_sample_t)) {
+        benchmark_sample_t *samples = msg->payload.buf;
+        for (uint32_t i = 0; i < len; ++i) {
+            samples[i].x = i * 1.5;
+            samples[i].y = i * 2.5;
+            samples[i].z = i * 3.5;
+            samples[i].id = (int32_t) i;
+            samples[i].name = "sample";
+        }
+    } else if (bench->elementSize == sizeof(double)) {
+        double *values = msg->payload.buf;
+        for (uint32_t i = 0; i < len; ++i) {
+            values[i] = i * 0.5;
+        }
+    } else {
+        memset(msg->payload.buf, 'x', len);
+    }
+}
+
+static void* benchmark_publisher_run(void *data) {
+    benchmark_publisher_t *bench = data;
+
+    //wait for the publisher
+    celixThreadMutex_lock(&bench->mutex);
+    while (bench->running && bench->publisher == NULL) {
+        celixThreadCondition_timedwaitRelative(&bench->cond, &bench->mutex, 1, 0);
+    }
+    unsigned int msgTypeId = 0;
+    if (bench->publisher != NULL) {
+        bench->publisher->localMsgTypeIdForMsgType(bench->publisher->handle, bench->msgName, &msgTypeId);
+    }
+    bool running = bench->running;
+    celixThreadMutex_unlock(&bench->mutex);
+
+    benchmark_msg_t msg;
+    memset(&msg, 0, sizeof(msg));
+    benchmark_publisher_fillPayload(bench, &msg);
+
+    unsigned long nrOfSent = 0;
+    unsigned long nrOfFailed = 0;
+    uint64_t start = benchmark_now(CLOCK_MONOTONIC);
+    uint64_t end = start + (uint64_t) bench->duration * 1000000000UL;
+    uint64_t now = start;
+    for (uint32_t i = 0; running && now < end; ++i) {
+        if (bench->rate > 0) {
+            uint64_t due = start + (uint64_t) i * 1000000000UL / (uint64_t) bench->rate;
+            if (due > now) {
+                struct timespec sleep = {(time_t) ((due - now) / 1000000000UL), (long) ((due - now) % 1000000000UL)};
+                nanosleep(&sleep, NULL);
+            }
+        }
+        msg.seqNr = i;
+        msg.sendTime = benchmark_now(CLOCK_REALTIME);
+
+        celixThreadMutex_lock(&bench->mutex);
+        int rc = bench->publisher != NULL ? bench->publisher->send(bench->publisher->handle, msgTypeId, &msg) : -1;
+        running = bench->running;
+        celixThreadMutex_unlock(&bench->mutex);
+        if (rc == 0) {
+            nrOfSent += 1;
+        } else {
+            nrOfFailed += 1;
+        }
+        now = benchmark_now(CLOCK_MONOTONIC);
+    }
+    free(msg.payload.buf);
+
+    double elapsed = (double) (now - start) / 1e9;
+    printf("[BENCHMARK] Published %lu %s msgs (%lu failed) on topic %s in %.3f s: %.0f msgs/s\n", nrOfSent,
+           bench->msgName, nrOfFailed, bench->topic, elapsed, elapsed > 0 ? (double) nrOfSent / elapsed : 0.0);
+    return NULL;
+}
+
+static int benchmark_publisher_start(benchmark_publisher_t *bench, celix_bundle_context_t *ctx) {
+    bench->ctx = ctx;
+    snprintf(bench->topic, sizeof(bench->topic), "%s", celix_bundleContext_getProperty(ctx, BENCHMARK_TOPIC_KEY, BENCHMARK_TOPIC_DEFAULT));
+    bench->msgSize = celix_bundleContext_getPropertyAsLong(ctx, BENCHMARK_MSG_SIZE_KEY, BENCHMARK_MSG_SIZE_DEFAULT);
+    bench->rate = celix_bundleContext_getPropertyAsLong(ctx, BENCHMARK_RATE_KEY, BENCHMARK_RATE_DEFAULT);
+    bench->duration = celix_bundleContext_getPropertyAsLong(ctx, BENCHMARK_DURATION_KEY, BENCHMARK_DURATION_DEFAULT);
+    const char *type = celix_bundleContext_getProperty(ctx, BENCHMARK_MSG_TYPE_KEY, BENCHMARK_MSG_TYPE_DEFAULT);
+    if (strcmp(type, "doubles") == 0) {
+        bench->msgName = BENCHMARK_DOUBLES_MSG_NAME;
+        bench->elementSize = sizeof(double);
+    } else if (strcmp(type, "struct") == 0) {
+        bench->msgName = BENCHMARK_STRUCT_MSG_NAME;
+        bench->elementSize = sizeof(benchmark_sample_t);
+    } else {
+        bench->msgName = BENCHMARK_BYTES_MSG_NAME;
+        bench->elementSize = sizeof(int8_t);
+    }
+    celixThreadMutex_create(&bench->mutex, NULL);
+    celixThreadCondition_init(&bench->cond, NULL);
+    bench->running = true;
+
+    char filter[256];
+    snprintf(filter, sizeof(filter), "(%s=%s)", PUBSUB_PUBLISHER_TOPIC, bench->topic);
+    celix_service_tracking_options_t opts = CELIX_EMPTY_SERVICE_TRACKING_OPTIONS;
+    opts.filter.serviceName = PUBSUB_PUBLISHER_SERVICE_NAME;
+    opts.filter.filter = filter;
+    opts.filter.ignoreServiceLanguage = true;
+    opts.callbackHandle = bench;
+    opts.set = benchmark_publisher_setPublisher;
+    bench->trackerId = celix_bundleContext_trackServicesWithOptions(ctx, &opts);
+
+    celixThread_create(&bench->thread, NULL, benchmark_publisher_run, bench);
+    celixThread_setName(&bench->thread, "BenchmarkPub");
+    return CELIX_SUCCESS;
+}
+
+static int benchmark_publisher_stop(benchmark_publisher_t *bench, celix_bundle_context_t *ctx) {
+    celixThreadMutex_lock(&bench->mutex);
+    bench->running = false;
+    celixThreadCondition_broadcast(&bench->cond);
+    celixThreadMutex_unlock(&bench->mutex);
+    celixThread_join(bench->thread, NULL);
+
+    celix_bundleContext_stopTracker(ctx, bench->trackerId);
+    celixThreadCondition_destroy(&bench->cond);
+    celixThreadMutex_destroy(&bench->mutex);
+    return CELIX_SUCCESS;
+}
+
+CELIX_GEN_BUNDLE_ACTIVATOR(benchmark_publisher_t, benchmark_publisher_start, benchmark_publisher_stop)
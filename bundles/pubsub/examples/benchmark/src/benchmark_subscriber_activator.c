@@ -0,0 +1,180 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *  KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+#include "celix_api.h"
+#include "pubsub/subscriber.h"
+#include "pubsub_admin_metrics.h"
+
+#include "benchmark_msg.h"
+
+typedef struct benchmark_subscriber {
+    celix_bundle_context_t *ctx;
+    const char *label;
+    const char *resultFile;
+    uint64_t idleTimeout; //ns
+
+    pubsub_subscriber_t subscriberSvc;
+    long subscriberSvcId;
+    celix_thread_t thread;
+
+    celix_thread_mutex_t mutex; //protects below
+    celix_thread_cond_t cond;
+    bool running;
+    char msgName[64];
+    unsigned long nrOfMsgs;
+    unsigned long nrOfMissingMsgs;
+    uint64_t nrOfPayloadBytes;
+    uint32_t lastSeqNr;
+    uint64_t firstReceiveTime; //monotonic ns
+    uint64_t lastReceiveTime; //monotonic ns
+    pubsub_metrics_histogram_t latency;
+} benchmark_subscriber_t;
+
+static uint64_t benchmark_now(clockid_t clock) {
+    struct timespec now;
+    clock_gettime(clock, &now);
+    return (uint64_t) now.tv_sec * 1000000000UL + (uint64_t) now.tv_nsec;
+}
+
+static size_t benchmark_subscriber_elementSize(const char *msgType) {
+    if (strcmp(msgType, BENCHMARK_DOUBLES_MSG_NAME) == 0) {
+        return sizeof(double);
+    } else if (strcmp(msgType, BENCHMARK_STRUCT_MSG_NAME) == 0) {
+        return sizeof(benchmark_sample_t);
+    }
+    return sizeof(int8_t);
+}
+
+static int benchmark_subscriber_receive(void *handle, const char *msgType, unsigned int msgTypeId __attribute__((unused)), void *msg, bool *release __attribute__((unused))) {
+    benchmark_subscriber_t *bench = handle;
+    const benchmark_msg_t *benchMsg = msg;
+    uint64_t receiveTime = benchmark_now(CLOCK_REALTIME);
+    uint64_t now = benchmark_now(CLOCK_MONOTONIC);
+    //note the publisher and subscriber run in the same process (or on hosts with synchronized clocks)
+    uint64_t latency = receiveTime > benchMsg->sendTime ? receiveTime - benchMsg->sendTime : 0;
+    uint64_t payloadSize = (uint64_t) benchMsg->payload.len * benchmark_subscriber_elementSize(msgType);
+
+    celixThreadMutex_lock(&bench->mutex);
+    if (bench->nrOfMsgs == 0) {
+        snprintf(bench->msgName, sizeof(bench->msgName), "%s", msgType);
+        bench->firstReceiveTime = now;
+    } else if (benchMsg->seqNr > bench->lastSeqNr + 1) {
+        bench->nrOfMissingMsgs += benchMsg->seqNr - bench->lastSeqNr - 1;
+    }
+    bench->lastSeqNr = benchMsg->seqNr;
+    bench->lastReceiveTime = now;
+    bench->nrOfMsgs += 1;
+    bench->nrOfPayloadBytes += payloadSize;
+    pubsub_metricsHistogram_record(&bench->latency, latency);
+    celixThreadMutex_unlock(&bench->mutex);
+    return 0;
+}
+
+/**
+ * Writes the results of the current run and resets the statistics for a next run.
+ */
+static void benchmark_subscriber_report(benchmark_subscriber_t *bench) {
+    //note mutex locked
+    double duration = (double) (bench->lastReceiveTime - bench->firstReceiveTime) / 1e9;
+    double msgsPerSecond = duration > 0 ? (double) bench->nrOfMsgs / duration : 0.0;
+    double mbPerSecond = duration > 0 ? (double) bench->nrOfPayloadBytes / duration / (1024.0 * 1024.0) : 0.0;
+    uint64_t p50 = pubsub_metricsHistogram_valueAtPercentile(&bench->latency, 50.0);
+    uint64_t p99 = pubsub_metricsHistogram_valueAtPercentile(&bench->latency, 99.0);
+    uint64_t p999 = pubsub_metricsHistogram_valueAtPercentile(&bench->latency, 99.9);
+    uint64_t max = bench->latency.maxInNs;
+    unsigned long msgSize = bench->nrOfMsgs > 0 ? (unsigned long) (bench->nrOfPayloadBytes / bench->nrOfMsgs) : 0;
+
+    printf("[BENCHMARK] %s: %lu %s msgs of %lu bytes (%lu missing) in %.3f s: %.0f msgs/s, %.2f MB/s, latency p50 %.1f us, p99 %.1f us, p99.9 %.1f us\n",
+           bench->label, bench->nrOfMsgs, bench->msgName, msgSize, bench->nrOfMissingMsgs, duration, msgsPerSecond,
+           mbPerSecond, (double) p50 / 1e3, (double) p99 / 1e3, (double) p999 / 1e3);
+
+    FILE *file = fopen(bench->resultFile, "a");
+    if (file != NULL) {
+        fprintf(file, "{\"label\":\"%s\",\"msgType\":\"%s\",\"msgSize\":%lu,\"nrOfMsgs\":%lu,\"nrOfMissingMsgs\":%lu,"
+                      "\"duration\":%f,\"msgsPerSecond\":%f,\"mbPerSecond\":%f,"
+                      "\"latencyNs\":{\"p50\":%lu,\"p99\":%lu,\"p999\":%lu,\"max\":%lu}}\n",
+                bench->label, bench->msgName, msgSize, bench->nrOfMsgs, bench->nrOfMissingMsgs,
+                duration, msgsPerSecond, mbPerSecond,
+                (unsigned long) p50, (unsigned long) p99, (unsigned long) p999, (unsigned long) max);
+        fclose(file);
+    } else {
+        fprintf(stderr, "[BENCHMARK] Cannot open result file %s\n", bench->resultFile);
+    }
+
+    bench->nrOfMsgs = 0;
+    bench->nrOfMissingMsgs = 0;
+    bench->nrOfPayloadBytes = 0;
+    memset(&bench->latency, 0, sizeof(bench->latency));
+}
+
+static void* benchmark_subscriber_run(void *data) {
+    benchmark_subscriber_t *bench = data;
+    celixThreadMutex_lock(&bench->mutex);
+    while (bench->running) {
+        celixThreadCondition_timedwaitRelative(&bench->cond, &bench->mutex, 0, 100 * 1000 * 1000);
+        if (bench->nrOfMsgs > 0 && benchmark_now(CLOCK_MONOTONIC) - bench->lastReceiveTime > bench->idleTimeout) {
+            benchmark_subscriber_report(bench);
+        }
+    }
+    if (bench->nrOfMsgs > 0) {
+        benchmark_subscriber_report(bench);
+    }
+    celixThreadMutex_unlock(&bench->mutex);
+    return NULL;
+}
+
+static int benchmark_subscriber_start(benchmark_subscriber_t *bench, celix_bundle_context_t *ctx) {
+    bench->ctx = ctx;
+    bench->label = celix_bundleContext_getProperty(ctx, BENCHMARK_LABEL_KEY, BENCHMARK_LABEL_DEFAULT);
+    bench->resultFile = celix_bundleContext_getProperty(ctx, BENCHMARK_RESULT_FILE_KEY, BENCHMARK_RESULT_FILE_DEFAULT);
+    bench->idleTimeout = (uint64_t) celix_bundleContext_getPropertyAsLong(ctx, BENCHMARK_IDLE_TIMEOUT_KEY, BENCHMARK_IDLE_TIMEOUT_DEFAULT) * 1000000000UL;
+    celixThreadMutex_create(&bench->mutex, NULL);
+    celixThreadCondition_init(&bench->cond, NULL);
+    bench->running = true;
+    celixThread_create(&bench->thread, NULL, benchmark_subscriber_run, bench);
+    celixThread_setName(&bench->thread, "BenchmarkSub");
+
+    bench->subscriberSvc.handle = bench;
+    bench->subscriberSvc.receive = benchmark_subscriber_receive;
+    celix_properties_t *props = celix_properties_create();
+    celix_properties_set(props, PUBSUB_SUBSCRIBER_TOPIC, celix_bundleContext_getProperty(ctx, BENCHMARK_TOPIC_KEY, BENCHMARK_TOPIC_DEFAULT));
+    bench->subscriberSvcId = celix_bundleContext_registerService(ctx, &bench->subscriberSvc, PUBSUB_SUBSCRIBER_SERVICE_NAME, props);
+    return CELIX_SUCCESS;
+}
+
+static int benchmark_subscriber_stop(benchmark_subscriber_t *bench, celix_bundle_context_t *ctx) {
+    celix_bundleContext_unregisterService(ctx, bench->subscriberSvcId);
+
+    celixThreadMutex_lock(&bench->mutex);
+    bench->running = false;
+    celixThreadCondition_broadcast(&bench->cond);
+    celixThreadMutex_unlock(&bench->mutex);
+    celixThread_join(bench->thread, NULL);
+
+    celixThreadCondition_destroy(&bench->cond);
+    celixThreadMutex_destroy(&bench->mutex);
+    return CELIX_SUCCESS;
+}
+
+CELIX_GEN_BUNDLE_ACTIVATOR(benchmark_subscriber_t, benchmark_subscriber_start, benchmark_subscriber_stop)
@@ -45,6 +45,19 @@ static int pubsub__publisherMock_send(void *handle, unsigned int msgTypeId, cons
         .returnIntValue();
 }
 
+/*============================================================================
+  MOCK - mock function for pubsub_publisher->sendMany
+  ============================================================================*/
+static int pubsub__publisherMock_sendMany(void *handle, unsigned int msgTypeId, const void **msgs, size_t n) {
+    return mock(PUBSUB_PUBLISHERMOCK_SCOPE)
+        .actualCall(PUBSUB_PUBLISHERMOCK_SEND_MANY_METHOD)
+        .withPointerParameter("handle", handle)
+        .withParameter("msgTypeId", msgTypeId)
+        .withPointerParameter("msgs", (void*)msgs)
+        .withUnsignedLongIntParameter("n", n)
+        .returnIntValue();
+}
+
 /*============================================================================
   MOCK - mock setup for publisher service
   ============================================================================*/
@@ -52,4 +65,5 @@ void pubsub_publisherMock_init(pubsub_publisher_t* srv, void* handle) {
     srv->handle = handle;
     srv->localMsgTypeIdForMsgType = pubsub__publisherMock_localMsgTypeIdForMsgType;
     srv->send = pubsub__publisherMock_send;
+    srv->sendMany = pubsub__publisherMock_sendMany;
 }
@@ -75,3 +75,17 @@ TEST(pubsubmock, publishermock) {
 
 }
 
+
+TEST(pubsubmock, publishermockSendMany) {
+    unsigned int msgId = 11;
+    void *dummyMsgs[2] = {(void*)0x43, (void*)0x44};
+
+    mock(PUBSUB_PUBLISHERMOCK_SCOPE).expectOneCall(PUBSUB_PUBLISHERMOCK_SEND_MANY_METHOD)
+        .withParameter("handle", mockHandle)
+        .withParameter("msgTypeId", msgId)
+        .withParameter("n", 2UL)
+        .ignoreOtherParameters();
+
+    pubsub_publisher_t* srv = &mockSrv;
+    srv->sendMany(srv->handle, msgId, (const void**)dummyMsgs, 2);
+}
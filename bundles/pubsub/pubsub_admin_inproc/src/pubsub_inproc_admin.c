@@ -0,0 +1,491 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *  KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <memory.h>
+#include <pubsub_endpoint.h>
+#include <pubsub_serializer.h>
+
+#include "pubsub_utils.h"
+#include "pubsub_admin.h"
+#include "pubsub_inproc_admin.h"
+#include "pubsub_psa_inproc_constants.h"
+#include "pubsub_inproc_topic_sender.h"
+#include "pubsub_inproc_topic_receiver.h"
+
+#define L_DEBUG(...) \
+    logHelper_log(psa->log, OSGI_LOGSERVICE_DEBUG, __VA_ARGS__)
+#define L_INFO(...) \
+    logHelper_log(psa->log, OSGI_LOGSERVICE_INFO, __VA_ARGS__)
+#define L_WARN(...) \
+    logHelper_log(psa->log, OSGI_LOGSERVICE_WARNING, __VA_ARGS__)
+#define L_ERROR(...) \
+    logHelper_log(psa->log, OSGI_LOGSERVICE_ERROR, __VA_ARGS__)
+
+struct pubsub_inproc_admin {
+    celix_bundle_context_t *ctx;
+    log_helper_t *log;
+    double localScore;
+    double defaultScore;
+    long queueSize;
+    bool verbose;
+    const char *fwUUID;
+
+    struct {
+        celix_thread_mutex_t mutex;
+        hash_map_t *map; //key = svcId, value = psa_inproc_serializer_entry_t*
+    } serializers;
+
+    struct {
+        celix_thread_mutex_t mutex;
+        hash_map_t *map; //key = scope:topic key, value = pubsub_inproc_topic_sender_t*
+    } topicSenders;
+
+    struct {
+        celix_thread_mutex_t mutex;
+        hash_map_t *map; //key = scope:topic key, value = pubsub_inproc_topic_receiver_t*
+    } topicReceivers;
+};
+
+typedef struct psa_inproc_serializer_entry {
+    const char *serType;
+    long svcId;
+    pubsub_serializer_service_t *svc;
+} psa_inproc_serializer_entry_t;
+
+pubsub_inproc_admin_t* pubsub_inprocAdmin_create(celix_bundle_context_t *ctx, log_helper_t *logHelper) {
+    pubsub_inproc_admin_t *psa = calloc(1, sizeof(*psa));
+    psa->ctx = ctx;
+    psa->log = logHelper;
+    psa->verbose = celix_bundleContext_getPropertyAsBool(ctx, PUBSUB_INPROC_VERBOSE_KEY, PUBSUB_INPROC_VERBOSE_DEFAULT);
+    psa->fwUUID = celix_bundleContext_getProperty(ctx, OSGI_FRAMEWORK_FRAMEWORK_UUID, NULL);
+
+    psa->localScore = celix_bundleContext_getPropertyAsDouble(ctx, PSA_INPROC_LOCAL_SCORE_KEY, PSA_INPROC_DEFAULT_LOCAL_SCORE);
+    psa->defaultScore = celix_bundleContext_getPropertyAsDouble(ctx, PSA_INPROC_DEFAULT_SCORE_KEY, PSA_INPROC_DEFAULT_SCORE);
+    psa->queueSize = celix_bundleContext_getPropertyAsLong(ctx, PUBSUB_INPROC_QUEUE_SIZE_KEY, PUBSUB_INPROC_QUEUE_SIZE_DEFAULT);
+    if (psa->verbose) {
+        L_INFO("[PSA_INPROC] Using a default queue size of %li messages", psa->queueSize);
+    }
+
+    celixThreadMutex_create(&psa->serializers.mutex, NULL);
+    psa->serializers.map = hashMap_create(NULL, NULL, NULL, NULL);
+
+    celixThreadMutex_create(&psa->topicSenders.mutex, NULL);
+    psa->topicSenders.map = hashMap_create(utils_stringHash, NULL, utils_stringEquals, NULL);
+
+    celixThreadMutex_create(&psa->topicReceivers.mutex, NULL);
+    psa->topicReceivers.map = hashMap_create(utils_stringHash, NULL, utils_stringEquals, NULL);
+
+    return psa;
+}
+
+void pubsub_inprocAdmin_destroy(pubsub_inproc_admin_t *psa) {
+    if (psa == NULL) {
+        return;
+    }
+
+    //note assuming al psa register services and service tracker are removed.
+    //note destroying the topic senders first, a topic sender flushes its topic receiver
+
+    celixThreadMutex_lock(&psa->topicSenders.mutex);
+    hash_map_iterator_t iter = hashMapIterator_construct(psa->topicSenders.map);
+    while (hashMapIterator_hasNext(&iter)) {
+        pubsub_inproc_topic_sender_t *sender = hashMapIterator_nextValue(&iter);
+        pubsub_inprocTopicSender_destroy(sender);
+    }
+    celixThreadMutex_unlock(&psa->topicSenders.mutex);
+
+    celixThreadMutex_lock(&psa->topicReceivers.mutex);
+    iter = hashMapIterator_construct(psa->topicReceivers.map);
+    while (hashMapIterator_hasNext(&iter)) {
+        pubsub_inproc_topic_receiver_t *recv = hashMapIterator_nextValue(&iter);
+        pubsub_inprocTopicReceiver_destroy(recv);
+    }
+    celixThreadMutex_unlock(&psa->topicReceivers.mutex);
+
+    celixThreadMutex_lock(&psa->serializers.mutex);
+    iter = hashMapIterator_construct(psa->serializers.map);
+    while (hashMapIterator_hasNext(&iter)) {
+        psa_inproc_serializer_entry_t *entry = hashMapIterator_nextValue(&iter);
+        free(entry);
+    }
+    celixThreadMutex_unlock(&psa->serializers.mutex);
+
+    celixThreadMutex_destroy(&psa->topicSenders.mutex);
+    hashMap_destroy(psa->topicSenders.map, true, false);
+
+    celixThreadMutex_destroy(&psa->topicReceivers.mutex);
+    hashMap_destroy(psa->topicReceivers.map, true, false);
+
+    celixThreadMutex_destroy(&psa->serializers.mutex);
+    hashMap_destroy(psa->serializers.map, false, false);
+
+    pubsub_utils_clearTopicPropertiesCache();
+    free(psa);
+}
+
+/**
+ * Raises the score for topics configured with a local visibility. An explicitly requested (full match) or rejected
+ * (no match) psa type is left as is.
+ */
+static double pubsub_inprocAdmin_scoreForVisibility(pubsub_inproc_admin_t *psa, double score, const celix_properties_t *topicProperties) {
+    if (score <= PUBSUB_ADMIN_NO_MATCH_SCORE || score >= PUBSUB_ADMIN_FULL_MATCH_SCORE || topicProperties == NULL) {
+        return score;
+    }
+    const char *visibility = celix_properties_get(topicProperties, PUBSUB_ENDPOINT_VISIBILITY, PUBSUB_ENDPOINT_VISIBILITY_DEFAULT);
+    if (strncmp(visibility, PUBSUB_ENDPOINT_LOCAL_VISIBILITY, strlen(PUBSUB_ENDPOINT_LOCAL_VISIBILITY)) == 0) {
+        score = psa->localScore;
+    }
+    return score;
+}
+
+static size_t pubsub_inprocAdmin_queueSize(pubsub_inproc_admin_t *psa, const celix_properties_t *topicProperties) {
+    long size = celix_properties_getAsLong(topicProperties, PUBSUB_INPROC_TOPIC_QUEUE_SIZE, psa->queueSize);
+    return size > 0 ? (size_t)size : PUBSUB_INPROC_QUEUE_SIZE_DEFAULT;
+}
+
+celix_status_t pubsub_inprocAdmin_matchPublisher(void *handle, long svcRequesterBndId, const celix_filter_t *svcFilter, celix_properties_t **topicProperties, double *outScore, long *outSerializerSvcId) {
+    pubsub_inproc_admin_t *psa = handle;
+    L_DEBUG("[PSA_INPROC] pubsub_inprocAdmin_matchPublisher");
+    celix_status_t  status = CELIX_SUCCESS;
+    celix_properties_t *topicProps = NULL;
+    double score = pubsub_utils_matchPublisher(psa->ctx, svcRequesterBndId, svcFilter->filterStr, PUBSUB_INPROC_ADMIN_TYPE,
+                                               psa->defaultScore, psa->defaultScore, psa->defaultScore, &topicProps, outSerializerSvcId);
+    score = pubsub_inprocAdmin_scoreForVisibility(psa, score, topicProps);
+    *outScore = score;
+
+    if (topicProperties != NULL) {
+        *topicProperties = topicProps;
+    } else if (topicProps != NULL) {
+        celix_properties_destroy(topicProps);
+    }
+    return status;
+}
+
+celix_status_t pubsub_inprocAdmin_matchSubscriber(void *handle, long svcProviderBndId, const celix_properties_t *svcProperties, celix_properties_t **topicProperties, double *outScore, long *outSerializerSvcId) {
+    pubsub_inproc_admin_t *psa = handle;
+    L_DEBUG("[PSA_INPROC] pubsub_inprocAdmin_matchSubscriber");
+    celix_status_t  status = CELIX_SUCCESS;
+    celix_properties_t *topicProps = NULL;
+    double score = pubsub_utils_matchSubscriber(psa->ctx, svcProviderBndId, svcProperties, PUBSUB_INPROC_ADMIN_TYPE,
+                                                psa->defaultScore, psa->defaultScore, psa->defaultScore, &topicProps, outSerializerSvcId);
+    score = pubsub_inprocAdmin_scoreForVisibility(psa, score, topicProps);
+    if (outScore != NULL) {
+        *outScore = score;
+    }
+
+    if (topicProperties != NULL) {
+        *topicProperties = topicProps;
+    } else if (topicProps != NULL) {
+        celix_properties_destroy(topicProps);
+    }
+    return status;
+}
+
+celix_status_t pubsub_inprocAdmin_matchEndpoint(void *handle, const celix_properties_t *endpoint, bool *outMatch) {
+    pubsub_inproc_admin_t *psa = handle;
+    L_DEBUG("[PSA_INPROC] pubsub_inprocAdmin_matchEndpoint");
+    celix_status_t  status = CELIX_SUCCESS;
+    bool match = pubsub_utils_matchEndpoint(psa->ctx, endpoint, PUBSUB_INPROC_ADMIN_TYPE, NULL);
+    if (outMatch != NULL) {
+        *outMatch = match;
+    }
+    return status;
+}
+
+static celix_properties_t* pubsub_inprocAdmin_createEndpoint(pubsub_inproc_admin_t *psa, const char *scope, const char *topic, const char *endpointType, const char *serType) {
+    celix_properties_t *endpoint = pubsubEndpoint_create(psa->fwUUID, scope, topic, endpointType, PUBSUB_INPROC_ADMIN_TYPE, serType, NULL);
+    //topic senders and receivers are only connected within this framework, so do not announce the endpoint
+    celix_properties_set(endpoint, PUBSUB_ENDPOINT_VISIBILITY, PUBSUB_ENDPOINT_LOCAL_VISIBILITY);
+    //if available also set container name
+    const char *cn = celix_bundleContext_getProperty(psa->ctx, "CELIX_CONTAINER_NAME", NULL);
+    if (cn != NULL) {
+        celix_properties_set(endpoint, "container_name", cn);
+    }
+    return endpoint;
+}
+
+celix_status_t pubsub_inprocAdmin_setupTopicSender(void *handle, const char *scope, const char *topic, const celix_properties_t *topicProperties, long serializerSvcId, celix_properties_t **outPublisherEndpoint) {
+    pubsub_inproc_admin_t *psa = handle;
+    celix_status_t  status = CELIX_SUCCESS;
+
+    //1) Create TopicSender
+    //2) Store TopicSender
+    //3) Connect TopicSender to the TopicReceiver of the same scope/topic, if available
+    //4) set outPublisherEndpoint
+
+    celix_properties_t *newEndpoint = NULL;
+
+    char *key = pubsubEndpoint_createScopeTopicKey(scope, topic);
+    celixThreadMutex_lock(&psa->serializers.mutex);
+    celixThreadMutex_lock(&psa->topicSenders.mutex);
+    pubsub_inproc_topic_sender_t *sender = hashMap_get(psa->topicSenders.map, key);
+    if (sender == NULL) {
+        psa_inproc_serializer_entry_t *serEntry = hashMap_get(psa->serializers.map, (void*)serializerSvcId);
+        if (serEntry != NULL) {
+            sender = pubsub_inprocTopicSender_create(psa->ctx, psa->log, scope, topic, serializerSvcId, serEntry->svc);
+        }
+        if (sender != NULL) {
+            newEndpoint = pubsub_inprocAdmin_createEndpoint(psa, scope, topic, PUBSUB_PUBLISHER_ENDPOINT_TYPE, serEntry->serType);
+            hashMap_put(psa->topicSenders.map, key, sender);
+
+            celixThreadMutex_lock(&psa->topicReceivers.mutex);
+            pubsub_inproc_topic_receiver_t *receiver = hashMap_get(psa->topicReceivers.map, key);
+            if (receiver != NULL && pubsub_inprocTopicReceiver_serializerSvcId(receiver) == serializerSvcId) {
+                pubsub_inprocTopicSender_setReceiver(sender, receiver);
+            }
+            celixThreadMutex_unlock(&psa->topicReceivers.mutex);
+        } else {
+            L_ERROR("[PSA_INPROC] Error creating a TopicSender");
+            free(key);
+        }
+    } else {
+        free(key);
+        L_ERROR("[PSA_INPROC] Cannot setup already existing TopicSender for scope/topic %s/%s!", scope, topic);
+    }
+    celixThreadMutex_unlock(&psa->topicSenders.mutex);
+    celixThreadMutex_unlock(&psa->serializers.mutex);
+
+    if (newEndpoint != NULL && outPublisherEndpoint != NULL) {
+        *outPublisherEndpoint = newEndpoint;
+    } else if (newEndpoint != NULL) {
+        celix_properties_destroy(newEndpoint);
+    }
+
+    return status;
+}
+
+celix_status_t pubsub_inprocAdmin_teardownTopicSender(void *handle, const char *scope, const char *topic) {
+    pubsub_inproc_admin_t *psa = handle;
+    celix_status_t  status = CELIX_SUCCESS;
+
+    char *key = pubsubEndpoint_createScopeTopicKey(scope, topic);
+    celixThreadMutex_lock(&psa->topicSenders.mutex);
+    hash_map_entry_t *entry = hashMap_getEntry(psa->topicSenders.map, key);
+    if (entry != NULL) {
+        char *mapKey = hashMapEntry_getKey(entry);
+        pubsub_inproc_topic_sender_t *sender = hashMap_remove(psa->topicSenders.map, key);
+        free(mapKey);
+        pubsub_inprocTopicSender_destroy(sender);
+    } else {
+        L_ERROR("[PSA_INPROC] Cannot teardown TopicSender with scope/topic %s/%s. Does not exists", scope, topic);
+    }
+    celixThreadMutex_unlock(&psa->topicSenders.mutex);
+    free(key);
+
+    return status;
+}
+
+celix_status_t pubsub_inprocAdmin_setupTopicReceiver(void *handle, const char *scope, const char *topic, const celix_properties_t *topicProperties, long serializerSvcId, celix_properties_t **outSubscriberEndpoint) {
+    pubsub_inproc_admin_t *psa = handle;
+    celix_status_t  status = CELIX_SUCCESS;
+
+    //note no need to connect to discovered publisher endpoints, only the TopicSender of the
+    //same scope/topic in this framework is connected to the TopicReceiver.
+
+    celix_properties_t *newEndpoint = NULL;
+
+    char *key = pubsubEndpoint_createScopeTopicKey(scope, topic);
+    celixThreadMutex_lock(&psa->serializers.mutex);
+    celixThreadMutex_lock(&psa->topicSenders.mutex);
+    celixThreadMutex_lock(&psa->topicReceivers.mutex);
+    pubsub_inproc_topic_receiver_t *receiver = hashMap_get(psa->topicReceivers.map, key);
+    if (receiver == NULL) {
+        psa_inproc_serializer_entry_t *serEntry = hashMap_get(psa->serializers.map, (void*)serializerSvcId);
+        if (serEntry != NULL) {
+            receiver = pubsub_inprocTopicReceiver_create(psa->ctx, psa->log, scope, topic, serializerSvcId, serEntry->svc,
+                                                         pubsub_inprocAdmin_queueSize(psa, topicProperties), topicProperties);
+        }
+        if (receiver != NULL) {
+            newEndpoint = pubsub_inprocAdmin_createEndpoint(psa, scope, topic, PUBSUB_SUBSCRIBER_ENDPOINT_TYPE, serEntry->serType);
+            hashMap_put(psa->topicReceivers.map, key, receiver);
+
+            pubsub_inproc_topic_sender_t *sender = hashMap_get(psa->topicSenders.map, key);
+            if (sender != NULL && pubsub_inprocTopicSender_serializerSvcId(sender) == serializerSvcId) {
+                pubsub_inprocTopicSender_setReceiver(sender, receiver);
+            }
+        } else {
+            L_ERROR("[PSA_INPROC] Error creating a TopicReceiver");
+            free(key);
+        }
+    } else {
+        free(key);
+        L_ERROR("[PSA_INPROC] Cannot setup already existing TopicReceiver for scope/topic %s/%s!", scope, topic);
+    }
+    celixThreadMutex_unlock(&psa->topicReceivers.mutex);
+    celixThreadMutex_unlock(&psa->topicSenders.mutex);
+    celixThreadMutex_unlock(&psa->serializers.mutex);
+
+    if (newEndpoint != NULL && outSubscriberEndpoint != NULL) {
+        *outSubscriberEndpoint = newEndpoint;
+    } else if (newEndpoint != NULL) {
+        celix_properties_destroy(newEndpoint);
+    }
+
+    return status;
+}
+
+celix_status_t pubsub_inprocAdmin_teardownTopicReceiver(void *handle, const char *scope, const char *topic) {
+    pubsub_inproc_admin_t *psa = handle;
+
+    char *key = pubsubEndpoint_createScopeTopicKey(scope, topic);
+    celixThreadMutex_lock(&psa->topicSenders.mutex);
+    celixThreadMutex_lock(&psa->topicReceivers.mutex);
+    hash_map_entry_t *entry = hashMap_getEntry(psa->topicReceivers.map, key);
+    if (entry != NULL) {
+        char *receiverKey = hashMapEntry_getKey(entry);
+        pubsub_inproc_topic_receiver_t *receiver = hashMapEntry_getValue(entry);
+        hashMap_remove(psa->topicReceivers.map, receiverKey);
+
+        pubsub_inproc_topic_sender_t *sender = hashMap_get(psa->topicSenders.map, key);
+        if (sender != NULL) {
+            pubsub_inprocTopicSender_setReceiver(sender, NULL);
+        }
+
+        free(receiverKey);
+        pubsub_inprocTopicReceiver_destroy(receiver);
+    }
+    celixThreadMutex_unlock(&psa->topicReceivers.mutex);
+    celixThreadMutex_unlock(&psa->topicSenders.mutex);
+    free(key);
+
+    celix_status_t  status = CELIX_SUCCESS;
+    return status;
+}
+
+celix_status_t pubsub_inprocAdmin_addEndpoint(void *handle __attribute__((unused)), const celix_properties_t *endpoint __attribute__((unused))) {
+    //note nothing to connect, endpoints of other frameworks are not reachable
+    return CELIX_SUCCESS;
+}
+
+celix_status_t pubsub_inprocAdmin_removeEndpoint(void *handle __attribute__((unused)), const celix_properties_t *endpoint __attribute__((unused))) {
+    return CELIX_SUCCESS;
+}
+
+celix_status_t pubsub_inprocAdmin_executeCommand(void *handle, char *commandLine __attribute__((unused)), FILE *out, FILE *errStream __attribute__((unused))) {
+    pubsub_inproc_admin_t *psa = handle;
+    celix_status_t  status = CELIX_SUCCESS;
+
+    fprintf(out, "\n");
+    fprintf(out, "Topic Senders:\n");
+    celixThreadMutex_lock(&psa->serializers.mutex);
+    celixThreadMutex_lock(&psa->topicSenders.mutex);
+    hash_map_iterator_t iter = hashMapIterator_construct(psa->topicSenders.map);
+    while (hashMapIterator_hasNext(&iter)) {
+        pubsub_inproc_topic_sender_t *sender = hashMapIterator_nextValue(&iter);
+        long serSvcId = pubsub_inprocTopicSender_serializerSvcId(sender);
+        psa_inproc_serializer_entry_t *serEntry = hashMap_get(psa->serializers.map, (void*)serSvcId);
+        const char *serType = serEntry == NULL ? "!Error!" : serEntry->serType;
+        fprintf(out, "|- Topic Sender %s/%s\n", pubsub_inprocTopicSender_scope(sender), pubsub_inprocTopicSender_topic(sender));
+        fprintf(out, "   |- serializer type = %s\n", serType);
+        fprintf(out, "   |- connected       = %s\n", pubsub_inprocTopicSender_isConnected(sender) ? "true" : "false");
+    }
+    celixThreadMutex_unlock(&psa->topicSenders.mutex);
+    celixThreadMutex_unlock(&psa->serializers.mutex);
+
+    fprintf(out, "\n");
+    fprintf(out, "\nTopic Receivers:\n");
+    celixThreadMutex_lock(&psa->serializers.mutex);
+    celixThreadMutex_lock(&psa->topicReceivers.mutex);
+    iter = hashMapIterator_construct(psa->topicReceivers.map);
+    while (hashMapIterator_hasNext(&iter)) {
+        pubsub_inproc_topic_receiver_t *receiver = hashMapIterator_nextValue(&iter);
+        long serSvcId = pubsub_inprocTopicReceiver_serializerSvcId(receiver);
+        psa_inproc_serializer_entry_t *serEntry = hashMap_get(psa->serializers.map, (void*)serSvcId);
+        const char *serType = serEntry == NULL ? "!Error!" : serEntry->serType;
+        fprintf(out, "|- Topic Receiver %s/%s\n", pubsub_inprocTopicReceiver_scope(receiver), pubsub_inprocTopicReceiver_topic(receiver));
+        fprintf(out, "   |- serializer type = %s\n", serType);
+        fprintf(out, "   |- queued msgs     = %zu (max %zu)\n", pubsub_inprocTopicReceiver_queueSize(receiver), pubsub_inprocTopicReceiver_queueCapacity(receiver));
+        fprintf(out, "   |- dropped msgs    = %lu\n", pubsub_inprocTopicReceiver_nrOfDroppedMessages(receiver));
+    }
+    celixThreadMutex_unlock(&psa->topicReceivers.mutex);
+    celixThreadMutex_unlock(&psa->serializers.mutex);
+    fprintf(out, "\n");
+
+    return status;
+}
+
+void pubsub_inprocAdmin_addSerializerSvc(void *handle, void *svc, const celix_properties_t *props) {
+    pubsub_inproc_admin_t *psa = handle;
+
+    const char *serType = celix_properties_get(props, PUBSUB_SERIALIZER_TYPE_KEY, NULL);
+    long svcId = celix_properties_getAsLong(props, OSGI_FRAMEWORK_SERVICE_ID, -1L);
+
+    if (serType == NULL) {
+        L_INFO("[PSA_INPROC] Ignoring serializer service without %s property", PUBSUB_SERIALIZER_TYPE_KEY);
+        return;
+    }
+
+    celixThreadMutex_lock(&psa->serializers.mutex);
+    psa_inproc_serializer_entry_t *entry = hashMap_get(psa->serializers.map, (void*)svcId);
+    if (entry == NULL) {
+        entry = calloc(1, sizeof(*entry));
+        entry->serType = serType;
+        entry->svcId = svcId;
+        entry->svc = svc;
+        hashMap_put(psa->serializers.map, (void*)svcId, entry);
+    }
+    celixThreadMutex_unlock(&psa->serializers.mutex);
+}
+
+void pubsub_inprocAdmin_removeSerializerSvc(void *handle, void *svc __attribute__((unused)), const celix_properties_t *props) {
+    pubsub_inproc_admin_t *psa = handle;
+    long svcId = celix_properties_getAsLong(props, OSGI_FRAMEWORK_SERVICE_ID, -1L);
+
+    //remove serializer
+    // 1) First find entry and
+    // 2) loop and destroy all topic sender using the serializer and
+    // 3) loop and destroy all topic receivers using the serializer
+    // Note that it is the responsibility of the topology manager to create new topic senders/receivers
+
+    celixThreadMutex_lock(&psa->serializers.mutex);
+    psa_inproc_serializer_entry_t *entry = hashMap_remove(psa->serializers.map, (void*)svcId);
+    if (entry != NULL) {
+        celixThreadMutex_lock(&psa->topicSenders.mutex);
+        hash_map_iterator_t iter = hashMapIterator_construct(psa->topicSenders.map);
+        while (hashMapIterator_hasNext(&iter)) {
+            hash_map_entry_t *senderEntry = hashMapIterator_nextEntry(&iter);
+            pubsub_inproc_topic_sender_t *sender = hashMapEntry_getValue(senderEntry);
+            if (sender != NULL && entry->svcId == pubsub_inprocTopicSender_serializerSvcId(sender)) {
+                char *key = hashMapEntry_getKey(senderEntry);
+                hashMapIterator_remove(&iter);
+                pubsub_inprocTopicSender_destroy(sender);
+                free(key);
+            }
+        }
+        celixThreadMutex_unlock(&psa->topicSenders.mutex);
+
+        celixThreadMutex_lock(&psa->topicReceivers.mutex);
+        iter = hashMapIterator_construct(psa->topicReceivers.map);
+        while (hashMapIterator_hasNext(&iter)) {
+            hash_map_entry_t *receiverEntry = hashMapIterator_nextEntry(&iter);
+            pubsub_inproc_topic_receiver_t *receiver = hashMapEntry_getValue(receiverEntry);
+            if (receiver != NULL && entry->svcId == pubsub_inprocTopicReceiver_serializerSvcId(receiver)) {
+                char *key = hashMapEntry_getKey(receiverEntry);
+                //note the topic senders using the serializer are already destroyed
+                hashMapIterator_remove(&iter);
+                pubsub_inprocTopicReceiver_destroy(receiver);
+                free(key);
+            }
+        }
+        celixThreadMutex_unlock(&psa->topicReceivers.mutex);
+
+        free(entry);
+    }
+    celixThreadMutex_unlock(&psa->serializers.mutex);
+}
@@ -0,0 +1,458 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *  KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <stdlib.h>
+#include <memory.h>
+#include <pubsub/subscriber.h>
+#include <pubsub_constants.h>
+#include <pubsub_utils.h>
+
+#include "pubsub_inproc_topic_receiver.h"
+#include "pubsub_psa_inproc_constants.h"
+#include "celix_probes.h"
+
+#define DISPATCH_THREAD_TIMEOUT_IN_S    1
+
+#define L_DEBUG(...) \
+    logHelper_log(receiver->logHelper, OSGI_LOGSERVICE_DEBUG, __VA_ARGS__)
+#define L_INFO(...) \
+    logHelper_log(receiver->logHelper, OSGI_LOGSERVICE_INFO, __VA_ARGS__)
+#define L_WARN(...) \
+    logHelper_log(receiver->logHelper, OSGI_LOGSERVICE_WARNING, __VA_ARGS__)
+#define L_ERROR(...) \
+    logHelper_log(receiver->logHelper, OSGI_LOGSERVICE_ERROR, __VA_ARGS__)
+
+typedef struct psa_inproc_queue_entry {
+    pubsub_msg_serializer_t *msgSer; //the msg serializer of the publisher
+    void *msg; //msg instance if msgSer->copyMsg != NULL, otherwise the serialized msg
+    size_t msgLen;
+} psa_inproc_queue_entry_t;
+
+struct pubsub_inproc_topic_receiver {
+    celix_bundle_context_t *ctx;
+    log_helper_t *logHelper;
+    long serializerSvcId;
+    pubsub_serializer_service_t *serializer;
+    char *scope;
+    char *topic;
+
+    struct {
+        celix_thread_t thread;
+        celix_thread_mutex_t mutex;
+        celix_thread_cond_t cond; //signaled on enqueue, dispatch done and stop
+        bool running;
+        bool dispatching;
+        psa_inproc_queue_entry_t *entries; //circular buffer
+        size_t capacity;
+        size_t head;
+        size_t size;
+        unsigned long nrOfDroppedMessages;
+    } queue;
+
+    long subscriberTrackerId;
+    struct {
+        celix_thread_mutex_t mutex;
+        hash_map_t *map; //key = bnd id, value = psa_inproc_subscriber_entry_t
+        bool allInitialized;
+    } subscribers;
+};
+
+typedef struct psa_inproc_subscriber_entry {
+    int usageCount;
+    hash_map_t *msgTypes; //map from serializer svc
+    pubsub_subscriber_t *svc;
+
+    bool initialized; //true if the init function is called through the dispatch thread
+} psa_inproc_subscriber_entry_t;
+
+static void pubsub_inprocTopicReceiver_addSubscriber(void *handle, void *svc, const celix_properties_t *props, const celix_bundle_t *owner);
+static void pubsub_inprocTopicReceiver_removeSubscriber(void *handle, void *svc, const celix_properties_t *props, const celix_bundle_t *owner);
+static void psa_inproc_releaseEntry(psa_inproc_queue_entry_t *entry);
+static void psa_inproc_processMsg(pubsub_inproc_topic_receiver_t *receiver, psa_inproc_queue_entry_t *queueEntry);
+static void* psa_inproc_dispatchThread(void *data);
+static void psa_inproc_initializeAllSubscribers(pubsub_inproc_topic_receiver_t *receiver);
+
+pubsub_inproc_topic_receiver_t* pubsub_inprocTopicReceiver_create(
+        celix_bundle_context_t *ctx,
+        log_helper_t *logHelper,
+        const char *scope,
+        const char *topic,
+        long serializerSvcId,
+        pubsub_serializer_service_t *serializer,
+        size_t queueSize,
+        const celix_properties_t *topicProperties) {
+    pubsub_inproc_topic_receiver_t *receiver = calloc(1, sizeof(*receiver));
+    receiver->ctx = ctx;
+    receiver->logHelper = logHelper;
+    receiver->serializerSvcId = serializerSvcId;
+    receiver->serializer = serializer;
+    receiver->scope = strndup(scope, 1024 * 1024);
+    receiver->topic = strndup(topic, 1024 * 1024);
+
+    receiver->queue.capacity = queueSize > 0 ? queueSize : PUBSUB_INPROC_QUEUE_SIZE_DEFAULT;
+    receiver->queue.entries = calloc(receiver->queue.capacity, sizeof(*receiver->queue.entries));
+    receiver->queue.running = true;
+
+    celixThreadMutex_create(&receiver->subscribers.mutex, NULL);
+    celixThreadMutex_create(&receiver->queue.mutex, NULL);
+    celixThreadCondition_init(&receiver->queue.cond, NULL);
+
+    receiver->subscribers.map = hashMap_create(NULL, NULL, NULL, NULL);
+    receiver->subscribers.allInitialized = false;
+
+    //track subscribers
+    {
+        int size = snprintf(NULL, 0, "(%s=%s)", PUBSUB_SUBSCRIBER_TOPIC, topic);
+        char buf[size+1];
+        snprintf(buf, (size_t)size+1, "(%s=%s)", PUBSUB_SUBSCRIBER_TOPIC, topic);
+        celix_service_tracking_options_t opts = CELIX_EMPTY_SERVICE_TRACKING_OPTIONS;
+        opts.filter.ignoreServiceLanguage = true;
+        opts.filter.serviceName = PUBSUB_SUBSCRIBER_SERVICE_NAME;
+        opts.filter.filter = buf;
+        opts.callbackHandle = receiver;
+        opts.addWithOwner = pubsub_inprocTopicReceiver_addSubscriber;
+        opts.removeWithOwner = pubsub_inprocTopicReceiver_removeSubscriber;
+
+        receiver->subscriberTrackerId = celix_bundleContext_trackServicesWithOptions(ctx, &opts);
+    }
+
+    celixThread_create(&receiver->queue.thread, NULL, psa_inproc_dispatchThread, receiver);
+    char name[64];
+    snprintf(name, 64, "INPROC TR %s/%s", scope, topic);
+    celixThread_setName(&receiver->queue.thread, name);
+    celix_status_t threadStatus = pubsub_utils_setupThread(&receiver->queue.thread, topicProperties);
+    if (threadStatus != CELIX_SUCCESS) {
+        L_WARN("[PSA_INPROC] Cannot configure the scheduling/cpu affinity of the dispatch thread of %s/%s. Error %i", scope, topic, threadStatus);
+    }
+
+    return receiver;
+}
+
+void pubsub_inprocTopicReceiver_destroy(pubsub_inproc_topic_receiver_t *receiver) {
+    if (receiver != NULL) {
+        celix_bundleContext_stopTracker(receiver->ctx, receiver->subscriberTrackerId);
+
+        celixThreadMutex_lock(&receiver->queue.mutex);
+        receiver->queue.running = false;
+        celixThreadCondition_broadcast(&receiver->queue.cond);
+        celixThreadMutex_unlock(&receiver->queue.mutex);
+        celixThread_join(receiver->queue.thread, NULL);
+
+        //note no subscribers left, dropping the not yet dispatched messages
+        for (size_t i = 0; i < receiver->queue.size; ++i) {
+            psa_inproc_releaseEntry(&receiver->queue.entries[(receiver->queue.head + i) % receiver->queue.capacity]);
+        }
+
+        celixThreadMutex_lock(&receiver->subscribers.mutex);
+        hash_map_iterator_t iter = hashMapIterator_construct(receiver->subscribers.map);
+        while (hashMapIterator_hasNext(&iter)) {
+            psa_inproc_subscriber_entry_t *entry = hashMapIterator_nextValue(&iter);
+            if (entry != NULL) {
+                if (receiver->serializer != NULL && entry->msgTypes != NULL) {
+                    receiver->serializer->destroySerializerMap(receiver->serializer->handle, entry->msgTypes);
+                }
+                free(entry);
+            }
+        }
+        celixThreadMutex_unlock(&receiver->subscribers.mutex);
+        hashMap_destroy(receiver->subscribers.map, false, false);
+
+        celixThreadMutex_destroy(&receiver->subscribers.mutex);
+        celixThreadMutex_destroy(&receiver->queue.mutex);
+        celixThreadCondition_destroy(&receiver->queue.cond);
+
+        free(receiver->queue.entries);
+        free(receiver->scope);
+        free(receiver->topic);
+        free(receiver);
+    }
+}
+
+const char* pubsub_inprocTopicReceiver_scope(pubsub_inproc_topic_receiver_t *receiver) {
+    return receiver->scope;
+}
+
+const char* pubsub_inprocTopicReceiver_topic(pubsub_inproc_topic_receiver_t *receiver) {
+    return receiver->topic;
+}
+
+long pubsub_inprocTopicReceiver_serializerSvcId(pubsub_inproc_topic_receiver_t *receiver) {
+    return receiver->serializerSvcId;
+}
+
+size_t pubsub_inprocTopicReceiver_queueSize(pubsub_inproc_topic_receiver_t *receiver) {
+    celixThreadMutex_lock(&receiver->queue.mutex);
+    size_t result = receiver->queue.size;
+    celixThreadMutex_unlock(&receiver->queue.mutex);
+    return result;
+}
+
+size_t pubsub_inprocTopicReceiver_queueCapacity(pubsub_inproc_topic_receiver_t *receiver) {
+    return receiver->queue.capacity;
+}
+
+unsigned long pubsub_inprocTopicReceiver_nrOfDroppedMessages(pubsub_inproc_topic_receiver_t *receiver) {
+    celixThreadMutex_lock(&receiver->queue.mutex);
+    unsigned long result = receiver->queue.nrOfDroppedMessages;
+    celixThreadMutex_unlock(&receiver->queue.mutex);
+    return result;
+}
+
+celix_status_t pubsub_inprocTopicReceiver_enqueue(pubsub_inproc_topic_receiver_t *receiver, pubsub_msg_serializer_t *msgSer, void *msg, size_t msgLen) {
+    return pubsub_inprocTopicReceiver_enqueueMany(receiver, msgSer, &msg, &msgLen, 1);
+}
+
+celix_status_t pubsub_inprocTopicReceiver_enqueueMany(pubsub_inproc_topic_receiver_t *receiver, pubsub_msg_serializer_t *msgSer, void **msgs, const size_t *msgLens, size_t n) {
+    celix_status_t status = CELIX_SUCCESS;
+    size_t nrOfQueued = 0;
+
+    celixThreadMutex_lock(&receiver->queue.mutex);
+    while (nrOfQueued < n && receiver->queue.size < receiver->queue.capacity) {
+        psa_inproc_queue_entry_t *entry = &receiver->queue.entries[(receiver->queue.head + receiver->queue.size) % receiver->queue.capacity];
+        entry->msgSer = msgSer;
+        entry->msg = msgs[nrOfQueued];
+        entry->msgLen = msgLens[nrOfQueued];
+        receiver->queue.size += 1;
+        nrOfQueued += 1;
+    }
+    if (nrOfQueued < n) {
+        receiver->queue.nrOfDroppedMessages += n - nrOfQueued;
+        status = CELIX_ILLEGAL_STATE;
+    }
+    if (nrOfQueued > 0) {
+        celixThreadCondition_broadcast(&receiver->queue.cond);
+    }
+    celixThreadMutex_unlock(&receiver->queue.mutex);
+
+    for (size_t i = nrOfQueued; i < n; ++i) {
+        psa_inproc_queue_entry_t entry;
+        entry.msgSer = msgSer;
+        entry.msg = msgs[i];
+        entry.msgLen = msgLens[i];
+        psa_inproc_releaseEntry(&entry);
+    }
+    return status;
+}
+
+void pubsub_inprocTopicReceiver_flush(pubsub_inproc_topic_receiver_t *receiver) {
+    if (celixThread_equals(celixThread_self(), receiver->queue.thread)) {
+        //called from a subscriber callback, waiting would deadlock
+        return;
+    }
+    celixThreadMutex_lock(&receiver->queue.mutex);
+    while (receiver->queue.running && (receiver->queue.size > 0 || receiver->queue.dispatching)) {
+        celixThreadCondition_wait(&receiver->queue.cond, &receiver->queue.mutex);
+    }
+    celixThreadMutex_unlock(&receiver->queue.mutex);
+}
+
+static void psa_inproc_releaseEntry(psa_inproc_queue_entry_t *entry) {
+    if (entry->msg == NULL) {
+        return;
+    }
+    if (entry->msgSer->copyMsg != NULL) {
+        entry->msgSer->freeMsg(entry->msgSer->handle, entry->msg);
+    } else {
+        free(entry->msg);
+    }
+    entry->msg = NULL;
+}
+
+static void pubsub_inprocTopicReceiver_addSubscriber(void *handle, void *svc, const celix_properties_t *props, const celix_bundle_t *bnd) {
+    pubsub_inproc_topic_receiver_t *receiver = handle;
+
+    long bndId = celix_bundle_getId(bnd);
+    const char *subScope = celix_properties_get(props, PUBSUB_SUBSCRIBER_SCOPE, "default");
+    if (strncmp(subScope, receiver->scope, strlen(receiver->scope)) != 0) {
+        //not the same scope. ignore
+        return;
+    }
+
+    celixThreadMutex_lock(&receiver->subscribers.mutex);
+    psa_inproc_subscriber_entry_t *entry = hashMap_get(receiver->subscribers.map, (void*)bndId);
+    if (entry != NULL) {
+        entry->usageCount += 1;
+    } else {
+        //new create entry
+        entry = calloc(1, sizeof(*entry));
+        entry->usageCount = 1;
+        entry->svc = svc;
+        entry->initialized = false;
+        receiver->subscribers.allInitialized = false;
+
+        int rc = receiver->serializer->createSerializerMap(receiver->serializer->handle, (celix_bundle_t*)bnd, &entry->msgTypes);
+        if (rc == 0) {
+            hashMap_put(receiver->subscribers.map, (void*)bndId, entry);
+        } else {
+            L_ERROR("[PSA_INPROC] Cannot create msg serializer map for TopicReceiver %s/%s", receiver->scope, receiver->topic);
+            free(entry);
+        }
+    }
+    celixThreadMutex_unlock(&receiver->subscribers.mutex);
+}
+
+static void pubsub_inprocTopicReceiver_removeSubscriber(void *handle, void *svc __attribute__((unused)), const celix_properties_t *props __attribute__((unused)), const celix_bundle_t *bnd) {
+    pubsub_inproc_topic_receiver_t *receiver = handle;
+
+    long bndId = celix_bundle_getId(bnd);
+
+    celixThreadMutex_lock(&receiver->subscribers.mutex);
+    psa_inproc_subscriber_entry_t *entry = hashMap_get(receiver->subscribers.map, (void*)bndId);
+    if (entry != NULL) {
+        entry->usageCount -= 1;
+    }
+    if (entry != NULL && entry->usageCount <= 0) {
+        //remove entry
+        hashMap_remove(receiver->subscribers.map, (void*)bndId);
+        int rc = receiver->serializer->destroySerializerMap(receiver->serializer->handle, entry->msgTypes);
+        if (rc != 0) {
+            L_ERROR("[PSA_INPROC] Cannot destroy msg serializer map for TopicReceiver %s/%s", receiver->scope, receiver->topic);
+        }
+        free(entry);
+    }
+    celixThreadMutex_unlock(&receiver->subscribers.mutex);
+}
+
+static void* psa_inproc_dispatchThread(void *data) {
+    pubsub_inproc_topic_receiver_t *receiver = data;
+
+    celixThreadMutex_lock(&receiver->queue.mutex);
+    while (receiver->queue.running) {
+        celixThreadMutex_lock(&receiver->subscribers.mutex);
+        bool allInitialized = receiver->subscribers.allInitialized;
+        celixThreadMutex_unlock(&receiver->subscribers.mutex);
+        if (!allInitialized) {
+            celixThreadMutex_unlock(&receiver->queue.mutex);
+            psa_inproc_initializeAllSubscribers(receiver);
+            celixThreadMutex_lock(&receiver->queue.mutex);
+        }
+
+        if (receiver->queue.size > 0) {
+            psa_inproc_queue_entry_t entry = receiver->queue.entries[receiver->queue.head];
+            receiver->queue.head = (receiver->queue.head + 1) % receiver->queue.capacity;
+            receiver->queue.size -= 1;
+            receiver->queue.dispatching = true;
+            celixThreadMutex_unlock(&receiver->queue.mutex);
+
+            psa_inproc_processMsg(receiver, &entry);
+            psa_inproc_releaseEntry(&entry);
+
+            celixThreadMutex_lock(&receiver->queue.mutex);
+            receiver->queue.dispatching = false;
+            celixThreadCondition_broadcast(&receiver->queue.cond);
+        } else {
+            celixThreadCondition_timedwaitRelative(&receiver->queue.cond, &receiver->queue.mutex, DISPATCH_THREAD_TIMEOUT_IN_S, 0);
+        }
+    }
+    celixThreadMutex_unlock(&receiver->queue.mutex);
+
+    return NULL;
+}
+
+static bool psa_inproc_checkVersion(pubsub_msg_serializer_t *subMsgSer, pubsub_msg_serializer_t *pubMsgSer, bool exactMatch) {
+    bool check = false;
+
+    if (subMsgSer->msgVersion != NULL && pubMsgSer->msgVersion != NULL) {
+        int subMajor = 0, subMinor = 0, pubMajor = 0, pubMinor = 0;
+        version_getMajor(subMsgSer->msgVersion, &subMajor);
+        version_getMinor(subMsgSer->msgVersion, &subMinor);
+        version_getMajor(pubMsgSer->msgVersion, &pubMajor);
+        version_getMinor(pubMsgSer->msgVersion, &pubMinor);
+
+        if (pubMajor == subMajor) { /* Different major means incompatible */
+            /* A message instance is only usable by the subscriber if the memory layout is identical */
+            check = exactMatch ? pubMinor == subMinor : pubMinor >= subMinor;
+        }
+    }
+
+    return check;
+}
+
+static void psa_inproc_processMsg(pubsub_inproc_topic_receiver_t *receiver, psa_inproc_queue_entry_t *queueEntry) {
+    pubsub_msg_serializer_t *pubMsgSer = queueEntry->msgSer;
+    CELIX_PROBE4(psa_receive, PUBSUB_INPROC_ADMIN_TYPE, receiver->topic, pubMsgSer->msgId, queueEntry->msgLen);
+    bool copyMode = pubMsgSer->copyMsg != NULL;
+
+    celixThreadMutex_lock(&receiver->subscribers.mutex);
+    int remaining = hashMap_size(receiver->subscribers.map);
+    hash_map_iterator_t iter = hashMapIterator_construct(receiver->subscribers.map);
+    while (hashMapIterator_hasNext(&iter)) {
+        psa_inproc_subscriber_entry_t *entry = hashMapIterator_nextValue(&iter);
+        remaining -= 1;
+
+        pubsub_msg_serializer_t *msgSer = NULL;
+        if (entry->msgTypes != NULL) {
+            msgSer = hashMap_get(entry->msgTypes, (void *) (uintptr_t) pubMsgSer->msgId);
+        }
+        if (msgSer == NULL) {
+            L_WARN("[PSA_INPROC] Serializer not available for message %u.", pubMsgSer->msgId);
+        } else if (psa_inproc_checkVersion(msgSer, pubMsgSer, copyMode)) {
+            void *msgInst = NULL;
+            celix_status_t status;
+            if (!copyMode) {
+                status = msgSer->deserialize(msgSer->handle, queueEntry->msg, queueEntry->msgLen, &msgInst);
+            } else if (remaining == 0) {
+                //last subscriber, handing over the queued copy
+                msgInst = queueEntry->msg;
+                queueEntry->msg = NULL;
+                status = CELIX_SUCCESS;
+            } else {
+                status = pubMsgSer->copyMsg(pubMsgSer->handle, queueEntry->msg, &msgInst);
+            }
+            if (status == CELIX_SUCCESS) {
+                bool release = true;
+                pubsub_subscriber_t *svc = entry->svc;
+                svc->receive(svc->handle, msgSer->msgName, msgSer->msgId, msgInst, &release);
+                if (release) {
+                    msgSer->freeMsg(msgSer->handle, msgInst);
+                }
+            } else {
+                L_WARN("[PSA_INPROC] Cannot %s msg type %s.", copyMode ? "copy" : "deserialize", msgSer->msgName);
+            }
+        } else {
+            L_WARN("[PSA_INPROC] Version mismatch for primary message '%s'. NOT sending any part of the whole message.", msgSer->msgName);
+        }
+    }
+    celixThreadMutex_unlock(&receiver->subscribers.mutex);
+}
+
+static void psa_inproc_initializeAllSubscribers(pubsub_inproc_topic_receiver_t *receiver) {
+    celixThreadMutex_lock(&receiver->subscribers.mutex);
+    if (!receiver->subscribers.allInitialized) {
+        bool allInitialized = true;
+        hash_map_iterator_t iter = hashMapIterator_construct(receiver->subscribers.map);
+        while (hashMapIterator_hasNext(&iter)) {
+            psa_inproc_subscriber_entry_t *entry = hashMapIterator_nextValue(&iter);
+            if (!entry->initialized) {
+                int rc = 0;
+                if (entry->svc != NULL && entry->svc->init != NULL) {
+                    rc = entry->svc->init(entry->svc->handle);
+                }
+                if (rc == 0) {
+                    entry->initialized = true;
+                } else {
+                    L_WARN("[PSA_INPROC] Cannot initialize subscriber svc. Got rc %i", rc);
+                    allInitialized = false;
+                }
+            }
+        }
+        receiver->subscribers.allInitialized = allInitialized;
+    }
+    celixThreadMutex_unlock(&receiver->subscribers.mutex);
+}
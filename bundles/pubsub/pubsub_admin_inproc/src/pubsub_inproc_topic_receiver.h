@@ -0,0 +1,69 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *  KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#ifndef CELIX_PUBSUB_INPROC_TOPIC_RECEIVER_H
+#define CELIX_PUBSUB_INPROC_TOPIC_RECEIVER_H
+
+#include "celix_bundle_context.h"
+#include "pubsub_serializer.h"
+#include "log_helper.h"
+
+typedef struct pubsub_inproc_topic_receiver pubsub_inproc_topic_receiver_t;
+
+pubsub_inproc_topic_receiver_t* pubsub_inprocTopicReceiver_create(
+        celix_bundle_context_t *ctx,
+        log_helper_t *logHelper,
+        const char *scope,
+        const char *topic,
+        long serializerSvcId,
+        pubsub_serializer_service_t *serializer,
+        size_t queueSize,
+        const celix_properties_t *topicProperties);
+void pubsub_inprocTopicReceiver_destroy(pubsub_inproc_topic_receiver_t *receiver);
+
+const char* pubsub_inprocTopicReceiver_scope(pubsub_inproc_topic_receiver_t *receiver);
+const char* pubsub_inprocTopicReceiver_topic(pubsub_inproc_topic_receiver_t *receiver);
+long pubsub_inprocTopicReceiver_serializerSvcId(pubsub_inproc_topic_receiver_t *receiver);
+size_t pubsub_inprocTopicReceiver_queueSize(pubsub_inproc_topic_receiver_t *receiver);
+size_t pubsub_inprocTopicReceiver_queueCapacity(pubsub_inproc_topic_receiver_t *receiver);
+unsigned long pubsub_inprocTopicReceiver_nrOfDroppedMessages(pubsub_inproc_topic_receiver_t *receiver);
+
+/**
+ * Queues a message for the subscribers of the topic receiver. The receiver becomes owner of msg and frees it
+ * with msgSer when it is dispatched.
+ * If msgSer has a copyMsg function, msg is a message instance (a copy of the published message), otherwise
+ * msg is the serialized message with msgLen bytes.
+ * Note that msgSer must stay valid until the message is dispatched, see pubsub_inprocTopicReceiver_flush.
+ *
+ * Returns CELIX_ILLEGAL_STATE (and frees the message) if the queue is full.
+ */
+celix_status_t pubsub_inprocTopicReceiver_enqueue(pubsub_inproc_topic_receiver_t *receiver, pubsub_msg_serializer_t *msgSer, void *msg, size_t msgLen);
+
+/**
+ * Queues n messages, as pubsub_inprocTopicReceiver_enqueue, with a single lock of the queue.
+ * Returns CELIX_ILLEGAL_STATE if not all messages fit in the queue, the messages that do not fit are freed.
+ */
+celix_status_t pubsub_inprocTopicReceiver_enqueueMany(pubsub_inproc_topic_receiver_t *receiver, pubsub_msg_serializer_t *msgSer, void **msgs, const size_t *msgLens, size_t n);
+
+/**
+ * Waits until all queued messages are dispatched.
+ */
+void pubsub_inprocTopicReceiver_flush(pubsub_inproc_topic_receiver_t *receiver);
+
+#endif //CELIX_PUBSUB_INPROC_TOPIC_RECEIVER_H
@@ -0,0 +1,334 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *  KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <memory.h>
+#include <pubsub_constants.h>
+#include <pubsub/publisher.h>
+#include <utils.h>
+
+#include "pubsub_inproc_topic_sender.h"
+#include "pubsub_psa_inproc_constants.h"
+#include "celix_probes.h"
+
+#define L_DEBUG(...) \
+    logHelper_log(sender->logHelper, OSGI_LOGSERVICE_DEBUG, __VA_ARGS__)
+#define L_INFO(...) \
+    logHelper_log(sender->logHelper, OSGI_LOGSERVICE_INFO, __VA_ARGS__)
+#define L_WARN(...) \
+    logHelper_log(sender->logHelper, OSGI_LOGSERVICE_WARNING, __VA_ARGS__)
+#define L_ERROR(...) \
+    logHelper_log(sender->logHelper, OSGI_LOGSERVICE_ERROR, __VA_ARGS__)
+
+struct pubsub_inproc_topic_sender {
+    celix_bundle_context_t *ctx;
+    log_helper_t *logHelper;
+    long serializerSvcId;
+    pubsub_serializer_service_t *serializer;
+    char *scope;
+    char *topic;
+
+    struct {
+        celix_thread_mutex_t mutex;
+        celix_thread_cond_t cond; //signaled when a flush is done
+        pubsub_inproc_topic_receiver_t *receiver;
+        int flushCount; //nr of ongoing flushes, the receiver cannot be changed during a flush
+    } receiver;
+
+    struct {
+        long svcId;
+        celix_service_factory_t factory;
+    } publisher;
+
+    struct {
+        celix_thread_mutex_t mutex;
+        hash_map_t *map;  //key = bndId, value = psa_inproc_bounded_service_entry_t
+    } boundedServices;
+};
+
+typedef struct psa_inproc_bounded_service_entry {
+    pubsub_inproc_topic_sender_t *parent;
+    pubsub_publisher_t service;
+    long bndId;
+    hash_map_t *msgTypes;
+    hash_map_t *msgTypeIds;
+    int getCount;
+} psa_inproc_bounded_service_entry_t;
+
+static int psa_inproc_localMsgTypeIdForMsgType(void* handle, const char* msgType, unsigned int* msgTypeId);
+static void* psa_inproc_getPublisherService(void *handle, const celix_bundle_t *requestingBundle, const celix_properties_t *svcProperties);
+static void psa_inproc_ungetPublisherService(void *handle, const celix_bundle_t *requestingBundle, const celix_properties_t *svcProperties);
+static int psa_inproc_topicPublicationSend(void* handle, unsigned int msgTypeId, const void *inMsg);
+static int psa_inproc_topicPublicationSendMany(void* handle, unsigned int msgTypeId, const void **inMsgs, size_t n);
+static void psa_inproc_flushReceiver(pubsub_inproc_topic_sender_t *sender);
+
+pubsub_inproc_topic_sender_t* pubsub_inprocTopicSender_create(
+        celix_bundle_context_t *ctx,
+        log_helper_t *logHelper,
+        const char *scope,
+        const char *topic,
+        long serializerSvcId,
+        pubsub_serializer_service_t *serializer) {
+    pubsub_inproc_topic_sender_t *sender = calloc(1, sizeof(*sender));
+    sender->ctx = ctx;
+    sender->logHelper = logHelper;
+    sender->serializerSvcId = serializerSvcId;
+    sender->serializer = serializer;
+    sender->scope = strndup(scope, 1024 * 1024);
+    sender->topic = strndup(topic, 1024 * 1024);
+
+    celixThreadMutex_create(&sender->receiver.mutex, NULL);
+    celixThreadCondition_init(&sender->receiver.cond, NULL);
+    celixThreadMutex_create(&sender->boundedServices.mutex, NULL);
+    sender->boundedServices.map = hashMap_create(NULL, NULL, NULL, NULL);
+
+    //register publisher services using a service factory
+    {
+        sender->publisher.factory.handle = sender;
+        sender->publisher.factory.getService = psa_inproc_getPublisherService;
+        sender->publisher.factory.ungetService = psa_inproc_ungetPublisherService;
+
+        celix_properties_t *props = celix_properties_create();
+        celix_properties_set(props, PUBSUB_PUBLISHER_TOPIC, sender->topic);
+        celix_properties_set(props, PUBSUB_PUBLISHER_SCOPE, sender->scope);
+
+        celix_service_registration_options_t opts = CELIX_EMPTY_SERVICE_REGISTRATION_OPTIONS;
+        opts.factory = &sender->publisher.factory;
+        opts.serviceName = PUBSUB_PUBLISHER_SERVICE_NAME;
+        opts.serviceVersion = PUBSUB_PUBLISHER_SERVICE_VERSION;
+        opts.properties = props;
+
+        sender->publisher.svcId = celix_bundleContext_registerServiceWithOptions(ctx, &opts);
+    }
+
+    return sender;
+}
+
+void pubsub_inprocTopicSender_destroy(pubsub_inproc_topic_sender_t *sender) {
+    if (sender != NULL) {
+        celix_bundleContext_unregisterService(sender->ctx, sender->publisher.svcId);
+
+        //queued messages refer to the msg serializers of the publishers
+        psa_inproc_flushReceiver(sender);
+        pubsub_inprocTopicSender_setReceiver(sender, NULL);
+
+        celixThreadMutex_lock(&sender->boundedServices.mutex);
+        hash_map_iterator_t iter = hashMapIterator_construct(sender->boundedServices.map);
+        while (hashMapIterator_hasNext(&iter)) {
+            psa_inproc_bounded_service_entry_t *entry = hashMapIterator_nextValue(&iter);
+            if (entry != NULL) {
+                sender->serializer->destroySerializerMap(sender->serializer->handle, entry->msgTypes);
+                hashMap_destroy(entry->msgTypeIds, true, false);
+                free(entry);
+            }
+        }
+        hashMap_destroy(sender->boundedServices.map, false, false);
+        celixThreadMutex_unlock(&sender->boundedServices.mutex);
+        celixThreadMutex_destroy(&sender->boundedServices.mutex);
+
+        celixThreadMutex_destroy(&sender->receiver.mutex);
+        celixThreadCondition_destroy(&sender->receiver.cond);
+
+        free(sender->scope);
+        free(sender->topic);
+        free(sender);
+    }
+}
+
+const char* pubsub_inprocTopicSender_scope(pubsub_inproc_topic_sender_t *sender) {
+    return sender->scope;
+}
+
+const char* pubsub_inprocTopicSender_topic(pubsub_inproc_topic_sender_t *sender) {
+    return sender->topic;
+}
+
+long pubsub_inprocTopicSender_serializerSvcId(pubsub_inproc_topic_sender_t *sender) {
+    return sender->serializerSvcId;
+}
+
+bool pubsub_inprocTopicSender_isConnected(pubsub_inproc_topic_sender_t *sender) {
+    celixThreadMutex_lock(&sender->receiver.mutex);
+    bool connected = sender->receiver.receiver != NULL;
+    celixThreadMutex_unlock(&sender->receiver.mutex);
+    return connected;
+}
+
+void pubsub_inprocTopicSender_setReceiver(pubsub_inproc_topic_sender_t *sender, pubsub_inproc_topic_receiver_t *receiver) {
+    celixThreadMutex_lock(&sender->receiver.mutex);
+    while (sender->receiver.flushCount > 0) {
+        celixThreadCondition_wait(&sender->receiver.cond, &sender->receiver.mutex);
+    }
+    sender->receiver.receiver = receiver;
+    celixThreadMutex_unlock(&sender->receiver.mutex);
+}
+
+static void psa_inproc_flushReceiver(pubsub_inproc_topic_sender_t *sender) {
+    //note not flushing with the mutex locked, subscribers can publish on the same topic during the flush
+    celixThreadMutex_lock(&sender->receiver.mutex);
+    pubsub_inproc_topic_receiver_t *receiver = sender->receiver.receiver;
+    if (receiver != NULL) {
+        sender->receiver.flushCount += 1;
+    }
+    celixThreadMutex_unlock(&sender->receiver.mutex);
+
+    if (receiver != NULL) {
+        pubsub_inprocTopicReceiver_flush(receiver);
+        celixThreadMutex_lock(&sender->receiver.mutex);
+        sender->receiver.flushCount -= 1;
+        celixThreadCondition_broadcast(&sender->receiver.cond);
+        celixThreadMutex_unlock(&sender->receiver.mutex);
+    }
+}
+
+static int psa_inproc_localMsgTypeIdForMsgType(void *handle, const char *msgType, unsigned int *msgTypeId) {
+    psa_inproc_bounded_service_entry_t *entry = (psa_inproc_bounded_service_entry_t *) handle;
+    *msgTypeId = (unsigned int)(uintptr_t) hashMap_get(entry->msgTypeIds, msgType);
+    return 0;
+}
+
+static void* psa_inproc_getPublisherService(void *handle, const celix_bundle_t *requestingBundle, const celix_properties_t *svcProperties __attribute__((unused))) {
+    pubsub_inproc_topic_sender_t *sender = handle;
+    long bndId = celix_bundle_getId(requestingBundle);
+
+    pubsub_publisher_t *svc = NULL;
+
+    celixThreadMutex_lock(&sender->boundedServices.mutex);
+    psa_inproc_bounded_service_entry_t *entry = hashMap_get(sender->boundedServices.map, (void*)bndId);
+    if (entry != NULL) {
+        entry->getCount += 1;
+        svc = &entry->service;
+    } else {
+        entry = calloc(1, sizeof(*entry));
+        entry->getCount = 1;
+        entry->parent = sender;
+        entry->bndId = bndId;
+
+        int rc = sender->serializer->createSerializerMap(sender->serializer->handle, (celix_bundle_t*)requestingBundle, &entry->msgTypes);
+        if (rc == 0) {
+            entry->msgTypeIds = hashMap_create(utils_stringHash, NULL, utils_stringEquals, NULL);
+            hash_map_iterator_t iter = hashMapIterator_construct(entry->msgTypes);
+            while (hashMapIterator_hasNext(&iter)) {
+                pubsub_msg_serializer_t *msgSer = hashMapIterator_nextValue(&iter);
+                hashMap_put(entry->msgTypeIds, strndup(msgSer->msgName, 1024), (void *)(uintptr_t) msgSer->msgId);
+            }
+
+            entry->service.handle = entry;
+            entry->service.localMsgTypeIdForMsgType = psa_inproc_localMsgTypeIdForMsgType;
+            entry->service.send = psa_inproc_topicPublicationSend;
+            entry->service.sendMany = psa_inproc_topicPublicationSendMany;
+            hashMap_put(sender->boundedServices.map, (void*)bndId, entry);
+            svc = &entry->service;
+        } else {
+            L_ERROR("[PSA_INPROC] Error creating publisher service, serializer not available / cannot get msg serializer map");
+            free(entry);
+        }
+    }
+    celixThreadMutex_unlock(&sender->boundedServices.mutex);
+
+    return svc;
+}
+
+static void psa_inproc_ungetPublisherService(void *handle, const celix_bundle_t *requestingBundle, const celix_properties_t *svcProperties __attribute__((unused))) {
+    pubsub_inproc_topic_sender_t *sender = handle;
+    long bndId = celix_bundle_getId(requestingBundle);
+
+    celixThreadMutex_lock(&sender->boundedServices.mutex);
+    psa_inproc_bounded_service_entry_t *entry = hashMap_get(sender->boundedServices.map, (void*)bndId);
+    if (entry != NULL) {
+        entry->getCount -= 1;
+    }
+    if (entry != NULL && entry->getCount == 0) {
+        //free entry
+        hashMap_remove(sender->boundedServices.map, (void*)bndId);
+    } else {
+        entry = NULL;
+    }
+    celixThreadMutex_unlock(&sender->boundedServices.mutex);
+
+    if (entry != NULL) {
+        //queued messages of this publisher still refer to its msg serializers
+        psa_inproc_flushReceiver(sender);
+
+        int rc = sender->serializer->destroySerializerMap(sender->serializer->handle, entry->msgTypes);
+        if (rc != 0) {
+            L_ERROR("[PSA_INPROC] Error destroying publisher service, serializer not available / cannot get msg serializer map");
+        }
+
+        hashMap_destroy(entry->msgTypeIds, true, false);
+        free(entry);
+    }
+}
+
+static int psa_inproc_topicPublicationSend(void* handle, unsigned int msgTypeId, const void *inMsg) {
+    return psa_inproc_topicPublicationSendMany(handle, msgTypeId, &inMsg, 1);
+}
+
+static int psa_inproc_topicPublicationSendMany(void* handle, unsigned int msgTypeId, const void **inMsgs, size_t n) {
+    psa_inproc_bounded_service_entry_t *entry = handle;
+    pubsub_inproc_topic_sender_t *sender = entry->parent;
+    CELIX_PROBE4(psa_send, PUBSUB_INPROC_ADMIN_TYPE, sender->topic, msgTypeId, n);
+    int status = 0;
+
+    pubsub_msg_serializer_t* msgSer = NULL;
+    if (entry->msgTypes != NULL) {
+        msgSer = hashMap_get(entry->msgTypes, (void*)(intptr_t)(msgTypeId));
+    }
+
+    if (msgSer == NULL) {
+        L_WARN("[PSA_INPROC] No msg serializer available for msg type id %d", msgTypeId);
+        return -1;
+    }
+
+    celixThreadMutex_lock(&sender->receiver.mutex);
+    pubsub_inproc_topic_receiver_t *receiver = sender->receiver.receiver;
+    if (receiver != NULL) {
+        void **msgs = calloc(n, sizeof(*msgs));
+        size_t *msgLens = calloc(n, sizeof(*msgLens));
+        size_t nrOfMsgs = 0;
+        for (size_t i = 0; i < n; ++i) {
+            celix_status_t rc;
+            if (msgSer->copyMsg != NULL) {
+                //note the caller keeps ownership of the msg, so a copy is queued instead of the msg itself
+                rc = msgSer->copyMsg(msgSer->handle, inMsgs[i], &msgs[nrOfMsgs]);
+            } else {
+                rc = msgSer->serialize(msgSer->handle, inMsgs[i], &msgs[nrOfMsgs], &msgLens[nrOfMsgs]);
+            }
+            if (rc == CELIX_SUCCESS) {
+                nrOfMsgs += 1;
+            } else {
+                L_WARN("[PSA_INPROC] %s of msg type id %d failed", msgSer->copyMsg != NULL ? "Copy" : "Serialization", msgTypeId);
+                status = -1;
+            }
+        }
+        if (nrOfMsgs > 0) {
+            celix_status_t rc = pubsub_inprocTopicReceiver_enqueueMany(receiver, msgSer, msgs, msgLens, nrOfMsgs);
+            if (rc != CELIX_SUCCESS) {
+                L_WARN("[PSA_INPROC] Queue of TopicReceiver %s/%s is full (%zu), dropping msg(s) of type %s", sender->scope,
+                       sender->topic, pubsub_inprocTopicReceiver_queueCapacity(receiver), msgSer->msgName);
+                status = -1;
+            }
+        }
+        free(msgs);
+        free(msgLens);
+    }
+    celixThreadMutex_unlock(&sender->receiver.mutex);
+    return status;
+}
@@ -0,0 +1,50 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *  KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#ifndef CELIX_PUBSUB_INPROC_TOPIC_SENDER_H
+#define CELIX_PUBSUB_INPROC_TOPIC_SENDER_H
+
+#include "celix_bundle_context.h"
+#include "pubsub_serializer.h"
+#include "log_helper.h"
+#include "pubsub_inproc_topic_receiver.h"
+
+typedef struct pubsub_inproc_topic_sender pubsub_inproc_topic_sender_t;
+
+pubsub_inproc_topic_sender_t* pubsub_inprocTopicSender_create(
+        celix_bundle_context_t *ctx,
+        log_helper_t *logHelper,
+        const char *scope,
+        const char *topic,
+        long serializerSvcId,
+        pubsub_serializer_service_t *serializer);
+void pubsub_inprocTopicSender_destroy(pubsub_inproc_topic_sender_t *sender);
+
+const char* pubsub_inprocTopicSender_scope(pubsub_inproc_topic_sender_t *sender);
+const char* pubsub_inprocTopicSender_topic(pubsub_inproc_topic_sender_t *sender);
+long pubsub_inprocTopicSender_serializerSvcId(pubsub_inproc_topic_sender_t *sender);
+bool pubsub_inprocTopicSender_isConnected(pubsub_inproc_topic_sender_t *sender);
+
+/**
+ * Connects the sender to the topic receiver of the same scope/topic, or disconnects it if receiver is NULL.
+ * Messages published while the sender is not connected are dropped.
+ */
+void pubsub_inprocTopicSender_setReceiver(pubsub_inproc_topic_sender_t *sender, pubsub_inproc_topic_receiver_t *receiver);
+
+#endif //CELIX_PUBSUB_INPROC_TOPIC_SENDER_H
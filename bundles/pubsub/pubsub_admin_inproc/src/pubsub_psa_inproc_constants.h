@@ -0,0 +1,53 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *  KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#ifndef PUBSUB_PSA_INPROC_CONSTANTS_H_
+#define PUBSUB_PSA_INPROC_CONSTANTS_H_
+
+#define PUBSUB_INPROC_ADMIN_TYPE                "inproc"
+
+/**
+ * Score for topics with a local visibility (pubsub.endpoint.visibility=local), for those topics the inproc PSA is
+ * preferred above the other PSAs.
+ */
+#define PSA_INPROC_DEFAULT_LOCAL_SCORE          100
+/**
+ * Score for the other topics. The inproc PSA does not reach subscribers in other frameworks, so it is only selected
+ * for these topics if no other PSA is available.
+ */
+#define PSA_INPROC_DEFAULT_SCORE                5
+
+#define PSA_INPROC_LOCAL_SCORE_KEY              "PSA_INPROC_LOCAL_SCORE"
+#define PSA_INPROC_DEFAULT_SCORE_KEY            "PSA_INPROC_DEFAULT_SCORE"
+
+#define PUBSUB_INPROC_VERBOSE_KEY               "PSA_INPROC_VERBOSE"
+#define PUBSUB_INPROC_VERBOSE_DEFAULT           false
+
+/**
+ * The default max number of queued messages per topic. Publishing on a topic with a full queue fails.
+ */
+#define PUBSUB_INPROC_QUEUE_SIZE_KEY            "PSA_INPROC_QUEUE_SIZE"
+#define PUBSUB_INPROC_QUEUE_SIZE_DEFAULT        1024
+
+/**
+ * Can be set in the topic properties to configure the max number of queued messages for a topic.
+ */
+#define PUBSUB_INPROC_TOPIC_QUEUE_SIZE          "inproc.queue.size"
+
+#endif /* PUBSUB_PSA_INPROC_CONSTANTS_H_ */
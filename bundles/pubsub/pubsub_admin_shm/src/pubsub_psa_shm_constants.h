@@ -0,0 +1,59 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *  KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#ifndef PUBSUB_PSA_SHM_CONSTANTS_H_
+#define PUBSUB_PSA_SHM_CONSTANTS_H_
+
+#define PUBSUB_SHM_ADMIN_TYPE                   "shm"
+
+/**
+ * Score for topics with a host visibility (pubsub.endpoint.visibility=host), for those topics the shm PSA is
+ * preferred above the socket based PSAs.
+ */
+#define PSA_SHM_DEFAULT_HOST_SCORE              100
+/**
+ * Score for the other topics. Shared memory does not reach subscribers on other hosts, so the shm PSA is only
+ * selected for these topics if no other PSA is available.
+ */
+#define PSA_SHM_DEFAULT_SCORE                   5
+
+#define PSA_SHM_HOST_SCORE_KEY                  "PSA_SHM_HOST_SCORE"
+#define PSA_SHM_DEFAULT_SCORE_KEY               "PSA_SHM_DEFAULT_SCORE"
+
+#define PUBSUB_SHM_VERBOSE_KEY                  "PSA_SHM_VERBOSE"
+#define PUBSUB_SHM_VERBOSE_DEFAULT              false
+
+/**
+ * The default size in bytes of a topic ring in shared memory. A single message can use up to a quarter of the ring.
+ */
+#define PUBSUB_SHM_RING_SIZE_KEY                "PSA_SHM_RING_SIZE"
+#define PUBSUB_SHM_RING_SIZE_DEFAULT            (1024 * 1024)
+
+/**
+ * The shared memory name of the topic ring, set on the publisher and subscriber endpoints.
+ */
+#define PUBSUB_SHM_NAME_KEY                     "shm.name"
+
+/**
+ * Can be set in the topic properties to configure the ring size (in bytes) for a topic.
+ * Note that the first process opening the ring determines the ring size.
+ */
+#define PUBSUB_SHM_TOPIC_RING_SIZE              "shm.ring.size"
+
+#endif /* PUBSUB_PSA_SHM_CONSTANTS_H_ */
@@ -0,0 +1,478 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *  KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <memory.h>
+#include <pubsub_endpoint.h>
+#include <pubsub_serializer.h>
+
+#include "pubsub_utils.h"
+#include "pubsub_admin.h"
+#include "pubsub_shm_admin.h"
+#include "pubsub_psa_shm_constants.h"
+#include "pubsub_shm_common.h"
+#include "pubsub_shm_topic_sender.h"
+#include "pubsub_shm_topic_receiver.h"
+
+#define L_DEBUG(...) \
+    logHelper_log(psa->log, OSGI_LOGSERVICE_DEBUG, __VA_ARGS__)
+#define L_INFO(...) \
+    logHelper_log(psa->log, OSGI_LOGSERVICE_INFO, __VA_ARGS__)
+#define L_WARN(...) \
+    logHelper_log(psa->log, OSGI_LOGSERVICE_WARNING, __VA_ARGS__)
+#define L_ERROR(...) \
+    logHelper_log(psa->log, OSGI_LOGSERVICE_ERROR, __VA_ARGS__)
+
+struct pubsub_shm_admin {
+    celix_bundle_context_t *ctx;
+    log_helper_t *log;
+    double hostScore;
+    double defaultScore;
+    long ringSize;
+    bool verbose;
+    const char *fwUUID;
+
+    struct {
+        celix_thread_mutex_t mutex;
+        hash_map_t *map; //key = svcId, value = psa_shm_serializer_entry_t*
+    } serializers;
+
+    struct {
+        celix_thread_mutex_t mutex;
+        hash_map_t *map; //key = scope:topic key, value = pubsub_shm_topic_sender_t*
+    } topicSenders;
+
+    struct {
+        celix_thread_mutex_t mutex;
+        hash_map_t *map; //key = scope:topic key, value = pubsub_shm_topic_receiver_t*
+    } topicReceivers;
+};
+
+typedef struct psa_shm_serializer_entry {
+    const char *serType;
+    long svcId;
+    pubsub_serializer_service_t *svc;
+} psa_shm_serializer_entry_t;
+
+pubsub_shm_admin_t* pubsub_shmAdmin_create(celix_bundle_context_t *ctx, log_helper_t *logHelper) {
+    pubsub_shm_admin_t *psa = calloc(1, sizeof(*psa));
+    psa->ctx = ctx;
+    psa->log = logHelper;
+    psa->verbose = celix_bundleContext_getPropertyAsBool(ctx, PUBSUB_SHM_VERBOSE_KEY, PUBSUB_SHM_VERBOSE_DEFAULT);
+    psa->fwUUID = celix_bundleContext_getProperty(ctx, OSGI_FRAMEWORK_FRAMEWORK_UUID, NULL);
+
+    psa->hostScore = celix_bundleContext_getPropertyAsDouble(ctx, PSA_SHM_HOST_SCORE_KEY, PSA_SHM_DEFAULT_HOST_SCORE);
+    psa->defaultScore = celix_bundleContext_getPropertyAsDouble(ctx, PSA_SHM_DEFAULT_SCORE_KEY, PSA_SHM_DEFAULT_SCORE);
+    psa->ringSize = celix_bundleContext_getPropertyAsLong(ctx, PUBSUB_SHM_RING_SIZE_KEY, PUBSUB_SHM_RING_SIZE_DEFAULT);
+    if (psa->verbose) {
+        L_INFO("[PSA_SHM] Using a default ring size of %li bytes", psa->ringSize);
+    }
+
+    celixThreadMutex_create(&psa->serializers.mutex, NULL);
+    psa->serializers.map = hashMap_create(NULL, NULL, NULL, NULL);
+
+    celixThreadMutex_create(&psa->topicSenders.mutex, NULL);
+    psa->topicSenders.map = hashMap_create(utils_stringHash, NULL, utils_stringEquals, NULL);
+
+    celixThreadMutex_create(&psa->topicReceivers.mutex, NULL);
+    psa->topicReceivers.map = hashMap_create(utils_stringHash, NULL, utils_stringEquals, NULL);
+
+    return psa;
+}
+
+void pubsub_shmAdmin_destroy(pubsub_shm_admin_t *psa) {
+    if (psa == NULL) {
+        return;
+    }
+
+    //note assuming al psa register services and service tracker are removed.
+
+    celixThreadMutex_lock(&psa->topicSenders.mutex);
+    hash_map_iterator_t iter = hashMapIterator_construct(psa->topicSenders.map);
+    while (hashMapIterator_hasNext(&iter)) {
+        pubsub_shm_topic_sender_t *sender = hashMapIterator_nextValue(&iter);
+        pubsub_shmTopicSender_destroy(sender);
+    }
+    celixThreadMutex_unlock(&psa->topicSenders.mutex);
+
+    celixThreadMutex_lock(&psa->topicReceivers.mutex);
+    iter = hashMapIterator_construct(psa->topicReceivers.map);
+    while (hashMapIterator_hasNext(&iter)) {
+        pubsub_shm_topic_receiver_t *recv = hashMapIterator_nextValue(&iter);
+        pubsub_shmTopicReceiver_destroy(recv);
+    }
+    celixThreadMutex_unlock(&psa->topicReceivers.mutex);
+
+    celixThreadMutex_lock(&psa->serializers.mutex);
+    iter = hashMapIterator_construct(psa->serializers.map);
+    while (hashMapIterator_hasNext(&iter)) {
+        psa_shm_serializer_entry_t *entry = hashMapIterator_nextValue(&iter);
+        free(entry);
+    }
+    celixThreadMutex_unlock(&psa->serializers.mutex);
+
+    celixThreadMutex_destroy(&psa->topicSenders.mutex);
+    hashMap_destroy(psa->topicSenders.map, true, false);
+
+    celixThreadMutex_destroy(&psa->topicReceivers.mutex);
+    hashMap_destroy(psa->topicReceivers.map, true, false);
+
+    celixThreadMutex_destroy(&psa->serializers.mutex);
+    hashMap_destroy(psa->serializers.map, false, false);
+
+    pubsub_utils_clearTopicPropertiesCache();
+    free(psa);
+}
+
+/**
+ * Raises the score for topics configured with a host visibility. An explicitly requested (full match) or rejected
+ * (no match) psa type is left as is.
+ */
+static double pubsub_shmAdmin_scoreForVisibility(pubsub_shm_admin_t *psa, double score, const celix_properties_t *topicProperties) {
+    if (score <= PUBSUB_ADMIN_NO_MATCH_SCORE || score >= PUBSUB_ADMIN_FULL_MATCH_SCORE || topicProperties == NULL) {
+        return score;
+    }
+    const char *visibility = celix_properties_get(topicProperties, PUBSUB_ENDPOINT_VISIBILITY, PUBSUB_ENDPOINT_VISIBILITY_DEFAULT);
+    if (strncmp(visibility, PUBSUB_ENDPOINT_HOST_VISIBILITY, strlen(PUBSUB_ENDPOINT_HOST_VISIBILITY)) == 0) {
+        score = psa->hostScore;
+    }
+    return score;
+}
+
+static size_t pubsub_shmAdmin_ringSize(pubsub_shm_admin_t *psa, const celix_properties_t *topicProperties) {
+    long size = celix_properties_getAsLong(topicProperties, PUBSUB_SHM_TOPIC_RING_SIZE, psa->ringSize);
+    return size > 0 ? (size_t)size : PUBSUB_SHM_RING_SIZE_DEFAULT;
+}
+
+celix_status_t pubsub_shmAdmin_matchPublisher(void *handle, long svcRequesterBndId, const celix_filter_t *svcFilter, celix_properties_t **topicProperties, double *outScore, long *outSerializerSvcId) {
+    pubsub_shm_admin_t *psa = handle;
+    L_DEBUG("[PSA_SHM] pubsub_shmAdmin_matchPublisher");
+    celix_status_t  status = CELIX_SUCCESS;
+    celix_properties_t *topicProps = NULL;
+    double score = pubsub_utils_matchPublisher(psa->ctx, svcRequesterBndId, svcFilter->filterStr, PUBSUB_SHM_ADMIN_TYPE,
+                                               psa->defaultScore, psa->defaultScore, psa->defaultScore, &topicProps, outSerializerSvcId);
+    score = pubsub_shmAdmin_scoreForVisibility(psa, score, topicProps);
+    *outScore = score;
+
+    if (topicProperties != NULL) {
+        *topicProperties = topicProps;
+    } else if (topicProps != NULL) {
+        celix_properties_destroy(topicProps);
+    }
+    return status;
+}
+
+celix_status_t pubsub_shmAdmin_matchSubscriber(void *handle, long svcProviderBndId, const celix_properties_t *svcProperties, celix_properties_t **topicProperties, double *outScore, long *outSerializerSvcId) {
+    pubsub_shm_admin_t *psa = handle;
+    L_DEBUG("[PSA_SHM] pubsub_shmAdmin_matchSubscriber");
+    celix_status_t  status = CELIX_SUCCESS;
+    celix_properties_t *topicProps = NULL;
+    double score = pubsub_utils_matchSubscriber(psa->ctx, svcProviderBndId, svcProperties, PUBSUB_SHM_ADMIN_TYPE,
+                                                psa->defaultScore, psa->defaultScore, psa->defaultScore, &topicProps, outSerializerSvcId);
+    score = pubsub_shmAdmin_scoreForVisibility(psa, score, topicProps);
+    if (outScore != NULL) {
+        *outScore = score;
+    }
+
+    if (topicProperties != NULL) {
+        *topicProperties = topicProps;
+    } else if (topicProps != NULL) {
+        celix_properties_destroy(topicProps);
+    }
+    return status;
+}
+
+celix_status_t pubsub_shmAdmin_matchEndpoint(void *handle, const celix_properties_t *endpoint, bool *outMatch) {
+    pubsub_shm_admin_t *psa = handle;
+    L_DEBUG("[PSA_SHM] pubsub_shmAdmin_matchEndpoint");
+    celix_status_t  status = CELIX_SUCCESS;
+    bool match = pubsub_utils_matchEndpoint(psa->ctx, endpoint, PUBSUB_SHM_ADMIN_TYPE, NULL);
+    if (outMatch != NULL) {
+        *outMatch = match;
+    }
+    return status;
+}
+
+static celix_properties_t* pubsub_shmAdmin_createEndpoint(pubsub_shm_admin_t *psa, const char *scope, const char *topic, const char *endpointType, const char *serType, const char *ringName) {
+    celix_properties_t *endpoint = pubsubEndpoint_create(psa->fwUUID, scope, topic, endpointType, PUBSUB_SHM_ADMIN_TYPE, serType, NULL);
+    celix_properties_set(endpoint, PUBSUB_SHM_NAME_KEY, ringName);
+    //shared memory is only reachable on this host, so do not announce the endpoint outside of the host
+    celix_properties_set(endpoint, PUBSUB_ENDPOINT_VISIBILITY, PUBSUB_ENDPOINT_HOST_VISIBILITY);
+    //if available also set container name
+    const char *cn = celix_bundleContext_getProperty(psa->ctx, "CELIX_CONTAINER_NAME", NULL);
+    if (cn != NULL) {
+        celix_properties_set(endpoint, "container_name", cn);
+    }
+    return endpoint;
+}
+
+celix_status_t pubsub_shmAdmin_setupTopicSender(void *handle, const char *scope, const char *topic, const celix_properties_t *topicProperties, long serializerSvcId, celix_properties_t **outPublisherEndpoint) {
+    pubsub_shm_admin_t *psa = handle;
+    celix_status_t  status = CELIX_SUCCESS;
+
+    //1) Create TopicSender, which opens (or creates) the topic ring
+    //2) Store TopicSender
+    //3) set outPublisherEndpoint
+
+    celix_properties_t *newEndpoint = NULL;
+
+    char *key = pubsubEndpoint_createScopeTopicKey(scope, topic);
+    celixThreadMutex_lock(&psa->serializers.mutex);
+    celixThreadMutex_lock(&psa->topicSenders.mutex);
+    pubsub_shm_topic_sender_t *sender = hashMap_get(psa->topicSenders.map, key);
+    if (sender == NULL) {
+        psa_shm_serializer_entry_t *serEntry = hashMap_get(psa->serializers.map, (void*)serializerSvcId);
+        char *ringName = NULL;
+        if (serEntry != NULL) {
+            ringName = psa_shm_createRingName(scope, topic, serEntry->serType);
+            sender = pubsub_shmTopicSender_create(psa->ctx, psa->log, scope, topic, serializerSvcId, serEntry->svc,
+                                                  ringName, pubsub_shmAdmin_ringSize(psa, topicProperties));
+        }
+        if (sender != NULL) {
+            newEndpoint = pubsub_shmAdmin_createEndpoint(psa, scope, topic, PUBSUB_PUBLISHER_ENDPOINT_TYPE, serEntry->serType, ringName);
+            hashMap_put(psa->topicSenders.map, key, sender);
+        } else {
+            L_ERROR("[PSA_SHM] Error creating a TopicSender");
+            free(key);
+        }
+        free(ringName);
+    } else {
+        free(key);
+        L_ERROR("[PSA_SHM] Cannot setup already existing TopicSender for scope/topic %s/%s!", scope, topic);
+    }
+    celixThreadMutex_unlock(&psa->topicSenders.mutex);
+    celixThreadMutex_unlock(&psa->serializers.mutex);
+
+    if (newEndpoint != NULL && outPublisherEndpoint != NULL) {
+        *outPublisherEndpoint = newEndpoint;
+    } else if (newEndpoint != NULL) {
+        celix_properties_destroy(newEndpoint);
+    }
+
+    return status;
+}
+
+celix_status_t pubsub_shmAdmin_teardownTopicSender(void *handle, const char *scope, const char *topic) {
+    pubsub_shm_admin_t *psa = handle;
+    celix_status_t  status = CELIX_SUCCESS;
+
+    char *key = pubsubEndpoint_createScopeTopicKey(scope, topic);
+    celixThreadMutex_lock(&psa->topicSenders.mutex);
+    hash_map_entry_t *entry = hashMap_getEntry(psa->topicSenders.map, key);
+    if (entry != NULL) {
+        char *mapKey = hashMapEntry_getKey(entry);
+        pubsub_shm_topic_sender_t *sender = hashMap_remove(psa->topicSenders.map, key);
+        free(mapKey);
+        pubsub_shmTopicSender_destroy(sender);
+    } else {
+        L_ERROR("[PSA_SHM] Cannot teardown TopicSender with scope/topic %s/%s. Does not exists", scope, topic);
+    }
+    celixThreadMutex_unlock(&psa->topicSenders.mutex);
+    free(key);
+
+    return status;
+}
+
+celix_status_t pubsub_shmAdmin_setupTopicReceiver(void *handle, const char *scope, const char *topic, const celix_properties_t *topicProperties, long serializerSvcId, celix_properties_t **outSubscriberEndpoint) {
+    pubsub_shm_admin_t *psa = handle;
+    celix_status_t  status = CELIX_SUCCESS;
+
+    //note no need to connect to discovered publisher endpoints, the publishers of the
+    //scope/topic/serializer combination on this host all write to the same named ring.
+
+    celix_properties_t *newEndpoint = NULL;
+
+    char *key = pubsubEndpoint_createScopeTopicKey(scope, topic);
+    celixThreadMutex_lock(&psa->serializers.mutex);
+    celixThreadMutex_lock(&psa->topicReceivers.mutex);
+    pubsub_shm_topic_receiver_t *receiver = hashMap_get(psa->topicReceivers.map, key);
+    if (receiver == NULL) {
+        psa_shm_serializer_entry_t *serEntry = hashMap_get(psa->serializers.map, (void*)serializerSvcId);
+        char *ringName = NULL;
+        if (serEntry != NULL) {
+            ringName = psa_shm_createRingName(scope, topic, serEntry->serType);
+            receiver = pubsub_shmTopicReceiver_create(psa->ctx, psa->log, scope, topic, serializerSvcId, serEntry->svc,
+                                                      ringName, pubsub_shmAdmin_ringSize(psa, topicProperties), topicProperties);
+        }
+        if (receiver != NULL) {
+            newEndpoint = pubsub_shmAdmin_createEndpoint(psa, scope, topic, PUBSUB_SUBSCRIBER_ENDPOINT_TYPE, serEntry->serType, ringName);
+            hashMap_put(psa->topicReceivers.map, key, receiver);
+        } else {
+            L_ERROR("[PSA_SHM] Error creating a TopicReceiver");
+            free(key);
+        }
+        free(ringName);
+    } else {
+        free(key);
+        L_ERROR("[PSA_SHM] Cannot setup already existing TopicReceiver for scope/topic %s/%s!", scope, topic);
+    }
+    celixThreadMutex_unlock(&psa->topicReceivers.mutex);
+    celixThreadMutex_unlock(&psa->serializers.mutex);
+
+    if (newEndpoint != NULL && outSubscriberEndpoint != NULL) {
+        *outSubscriberEndpoint = newEndpoint;
+    } else if (newEndpoint != NULL) {
+        celix_properties_destroy(newEndpoint);
+    }
+
+    return status;
+}
+
+celix_status_t pubsub_shmAdmin_teardownTopicReceiver(void *handle, const char *scope, const char *topic) {
+    pubsub_shm_admin_t *psa = handle;
+
+    char *key = pubsubEndpoint_createScopeTopicKey(scope, topic);
+    celixThreadMutex_lock(&psa->topicReceivers.mutex);
+    hash_map_entry_t *entry = hashMap_getEntry(psa->topicReceivers.map, key);
+    free(key);
+    if (entry != NULL) {
+        char *receiverKey = hashMapEntry_getKey(entry);
+        pubsub_shm_topic_receiver_t *receiver = hashMapEntry_getValue(entry);
+        hashMap_remove(psa->topicReceivers.map, receiverKey);
+
+        free(receiverKey);
+        pubsub_shmTopicReceiver_destroy(receiver);
+    }
+    celixThreadMutex_unlock(&psa->topicReceivers.mutex);
+
+    celix_status_t  status = CELIX_SUCCESS;
+    return status;
+}
+
+celix_status_t pubsub_shmAdmin_addEndpoint(void *handle __attribute__((unused)), const celix_properties_t *endpoint __attribute__((unused))) {
+    //note nothing to connect, topic receivers directly open the ring of their scope/topic
+    return CELIX_SUCCESS;
+}
+
+celix_status_t pubsub_shmAdmin_removeEndpoint(void *handle __attribute__((unused)), const celix_properties_t *endpoint __attribute__((unused))) {
+    return CELIX_SUCCESS;
+}
+
+celix_status_t pubsub_shmAdmin_executeCommand(void *handle, char *commandLine __attribute__((unused)), FILE *out, FILE *errStream __attribute__((unused))) {
+    pubsub_shm_admin_t *psa = handle;
+    celix_status_t  status = CELIX_SUCCESS;
+
+    fprintf(out, "\n");
+    fprintf(out, "Topic Senders:\n");
+    celixThreadMutex_lock(&psa->serializers.mutex);
+    celixThreadMutex_lock(&psa->topicSenders.mutex);
+    hash_map_iterator_t iter = hashMapIterator_construct(psa->topicSenders.map);
+    while (hashMapIterator_hasNext(&iter)) {
+        pubsub_shm_topic_sender_t *sender = hashMapIterator_nextValue(&iter);
+        long serSvcId = pubsub_shmTopicSender_serializerSvcId(sender);
+        psa_shm_serializer_entry_t *serEntry = hashMap_get(psa->serializers.map, (void*)serSvcId);
+        const char *serType = serEntry == NULL ? "!Error!" : serEntry->serType;
+        fprintf(out, "|- Topic Sender %s/%s\n", pubsub_shmTopicSender_scope(sender), pubsub_shmTopicSender_topic(sender));
+        fprintf(out, "   |- serializer type = %s\n", serType);
+        fprintf(out, "   |- shm ring        = %s (%zu bytes)\n", pubsub_shmTopicSender_ringName(sender), pubsub_shmTopicSender_ringSize(sender));
+        fprintf(out, "   |- ring users      = %u\n", pubsub_shmTopicSender_ringUsers(sender));
+    }
+    celixThreadMutex_unlock(&psa->topicSenders.mutex);
+    celixThreadMutex_unlock(&psa->serializers.mutex);
+
+    fprintf(out, "\n");
+    fprintf(out, "\nTopic Receivers:\n");
+    celixThreadMutex_lock(&psa->serializers.mutex);
+    celixThreadMutex_lock(&psa->topicReceivers.mutex);
+    iter = hashMapIterator_construct(psa->topicReceivers.map);
+    while (hashMapIterator_hasNext(&iter)) {
+        pubsub_shm_topic_receiver_t *receiver = hashMapIterator_nextValue(&iter);
+        long serSvcId = pubsub_shmTopicReceiver_serializerSvcId(receiver);
+        psa_shm_serializer_entry_t *serEntry = hashMap_get(psa->serializers.map, (void*)serSvcId);
+        const char *serType = serEntry == NULL ? "!Error!" : serEntry->serType;
+        fprintf(out, "|- Topic Receiver %s/%s\n", pubsub_shmTopicReceiver_scope(receiver), pubsub_shmTopicReceiver_topic(receiver));
+        fprintf(out, "   |- serializer type = %s\n", serType);
+        fprintf(out, "   |- shm ring        = %s (%zu bytes)\n", pubsub_shmTopicReceiver_ringName(receiver), pubsub_shmTopicReceiver_ringSize(receiver));
+        fprintf(out, "   |- ring users      = %u\n", pubsub_shmTopicReceiver_ringUsers(receiver));
+        fprintf(out, "   |- overruns        = %lu\n", pubsub_shmTopicReceiver_nrOfOverruns(receiver));
+    }
+    celixThreadMutex_unlock(&psa->topicReceivers.mutex);
+    celixThreadMutex_unlock(&psa->serializers.mutex);
+    fprintf(out, "\n");
+
+    return status;
+}
+
+void pubsub_shmAdmin_addSerializerSvc(void *handle, void *svc, const celix_properties_t *props) {
+    pubsub_shm_admin_t *psa = handle;
+
+    const char *serType = celix_properties_get(props, PUBSUB_SERIALIZER_TYPE_KEY, NULL);
+    long svcId = celix_properties_getAsLong(props, OSGI_FRAMEWORK_SERVICE_ID, -1L);
+
+    if (serType == NULL) {
+        L_INFO("[PSA_SHM] Ignoring serializer service without %s property", PUBSUB_SERIALIZER_TYPE_KEY);
+        return;
+    }
+
+    celixThreadMutex_lock(&psa->serializers.mutex);
+    psa_shm_serializer_entry_t *entry = hashMap_get(psa->serializers.map, (void*)svcId);
+    if (entry == NULL) {
+        entry = calloc(1, sizeof(*entry));
+        entry->serType = serType;
+        entry->svcId = svcId;
+        entry->svc = svc;
+        hashMap_put(psa->serializers.map, (void*)svcId, entry);
+    }
+    celixThreadMutex_unlock(&psa->serializers.mutex);
+}
+
+void pubsub_shmAdmin_removeSerializerSvc(void *handle, void *svc __attribute__((unused)), const celix_properties_t *props) {
+    pubsub_shm_admin_t *psa = handle;
+    long svcId = celix_properties_getAsLong(props, OSGI_FRAMEWORK_SERVICE_ID, -1L);
+
+    //remove serializer
+    // 1) First find entry and
+    // 2) loop and destroy all topic sender using the serializer and
+    // 3) loop and destroy all topic receivers using the serializer
+    // Note that it is the responsibility of the topology manager to create new topic senders/receivers
+
+    celixThreadMutex_lock(&psa->serializers.mutex);
+    psa_shm_serializer_entry_t *entry = hashMap_remove(psa->serializers.map, (void*)svcId);
+    if (entry != NULL) {
+        celixThreadMutex_lock(&psa->topicSenders.mutex);
+        hash_map_iterator_t iter = hashMapIterator_construct(psa->topicSenders.map);
+        while (hashMapIterator_hasNext(&iter)) {
+            hash_map_entry_t *senderEntry = hashMapIterator_nextEntry(&iter);
+            pubsub_shm_topic_sender_t *sender = hashMapEntry_getValue(senderEntry);
+            if (sender != NULL && entry->svcId == pubsub_shmTopicSender_serializerSvcId(sender)) {
+                char *key = hashMapEntry_getKey(senderEntry);
+                hashMapIterator_remove(&iter);
+                pubsub_shmTopicSender_destroy(sender);
+                free(key);
+            }
+        }
+        celixThreadMutex_unlock(&psa->topicSenders.mutex);
+
+        celixThreadMutex_lock(&psa->topicReceivers.mutex);
+        iter = hashMapIterator_construct(psa->topicReceivers.map);
+        while (hashMapIterator_hasNext(&iter)) {
+            hash_map_entry_t *receiverEntry = hashMapIterator_nextEntry(&iter);
+            pubsub_shm_topic_receiver_t *receiver = hashMapEntry_getValue(receiverEntry);
+            if (receiver != NULL && entry->svcId == pubsub_shmTopicReceiver_serializerSvcId(receiver)) {
+                char *key = hashMapEntry_getKey(receiverEntry);
+                hashMapIterator_remove(&iter);
+                pubsub_shmTopicReceiver_destroy(receiver);
+                free(key);
+            }
+        }
+        celixThreadMutex_unlock(&psa->topicReceivers.mutex);
+
+        free(entry);
+    }
+    celixThreadMutex_unlock(&psa->serializers.mutex);
+}
@@ -0,0 +1,39 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *  KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#ifndef CELIX_PUBSUB_SHM_COMMON_H
+#define CELIX_PUBSUB_SHM_COMMON_H
+
+#include <utils.h>
+
+#include "version.h"
+#include "pubsub_shm_ring.h"
+
+#define PSA_SHM_MSG_FLAG_POD  0x01 //payload is an unserialized plain old data msg (see pubsub_publisher_t loanMsg)
+
+bool psa_shm_checkVersion(version_pt msgVersion, const pubsub_shm_ring_msg_header_t *hdr);
+
+/**
+ * Creates the shared memory name for the ring of the scope/topic/serializer type combination.
+ * Characters which are not allowed in a shared memory name are replaced with '_'.
+ * Caller is owner of the returned string.
+ */
+char* psa_shm_createRingName(const char *scope, const char *topic, const char *serType);
+
+#endif //CELIX_PUBSUB_SHM_COMMON_H
@@ -0,0 +1,366 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *  KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <sched.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#ifdef __linux__
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#endif
+
+#include "pubsub_shm_ring.h"
+
+#define PUBSUB_SHM_RING_MAGIC           0x52485343 //"CSHR"
+#define PUBSUB_SHM_RING_VERSION         1
+#define PUBSUB_SHM_RING_MIN_SIZE        4096
+#define PUBSUB_SHM_RING_OPEN_ATTEMPTS   10
+#define PUBSUB_SHM_RING_SPIN_COUNT      128
+
+/**
+ * Control block at the start of the shared memory, followed by the ring data.
+ * The positions are absolute byte offsets (never wrapped), the ring offset is position & (ringSize - 1).
+ */
+typedef struct pubsub_shm_ring_control {
+    uint32_t magic;
+    uint32_t version;
+    uint64_t ringSize;
+    uint32_t users; //protected by a flock on the shared memory fd
+    uint32_t removed; //protected by a flock on the shared memory fd, 1 if the shared memory is unlinked
+
+    uint64_t reservePos __attribute__((aligned(64)));
+    uint64_t commitPos __attribute__((aligned(64)));
+    uint32_t wakeupSeq __attribute__((aligned(64))); //futex word
+    uint32_t waiters;
+} __attribute__((aligned(64))) pubsub_shm_ring_control_t;
+
+/**
+ * Every message in the ring is prefixed with the record size (header + payload + padding to 8 bytes) and header.
+ */
+typedef struct pubsub_shm_ring_record {
+    uint32_t recordSize;
+    pubsub_shm_ring_msg_header_t header;
+} pubsub_shm_ring_record_t;
+
+struct pubsub_shm_ring {
+    char *name;
+    int fd;
+    size_t mappedSize;
+    pubsub_shm_ring_control_t *control;
+    char *data;
+    uint64_t mask;
+};
+
+static size_t pubsub_shmRing_roundUpToPowerOf2(size_t size) {
+    size_t result = PUBSUB_SHM_RING_MIN_SIZE;
+    while (result < size) {
+        result <<= 1;
+    }
+    return result;
+}
+
+static void pubsub_shmRing_copyIn(pubsub_shm_ring_t *ring, uint64_t pos, const void *src, size_t len) {
+    size_t offset = (size_t)(pos & ring->mask);
+    size_t first = ring->control->ringSize - offset;
+    if (len <= first) {
+        memcpy(ring->data + offset, src, len);
+    } else {
+        memcpy(ring->data + offset, src, first);
+        memcpy(ring->data, (const char*)src + first, len - first);
+    }
+}
+
+static void pubsub_shmRing_copyOut(const pubsub_shm_ring_t *ring, uint64_t pos, void *dst, size_t len) {
+    size_t offset = (size_t)(pos & ring->mask);
+    size_t first = ring->control->ringSize - offset;
+    if (len <= first) {
+        memcpy(dst, ring->data + offset, len);
+    } else {
+        memcpy(dst, ring->data + offset, first);
+        memcpy((char*)dst + first, ring->data, len - first);
+    }
+}
+
+static void pubsub_shmRing_futexWait(uint32_t *addr, uint32_t val, unsigned int timeoutInMs) {
+#ifdef __linux__
+    struct timespec ts;
+    ts.tv_sec = timeoutInMs / 1000;
+    ts.tv_nsec = (long)(timeoutInMs % 1000) * 1000000L;
+    //note no FUTEX_PRIVATE_FLAG, the futex word is shared between processes
+    syscall(SYS_futex, addr, FUTEX_WAIT, val, &ts, NULL, 0);
+#else
+    (void)addr;
+    (void)val;
+    struct timespec ts = {0, 1000000L};
+    nanosleep(&ts, NULL);
+#endif
+}
+
+static void pubsub_shmRing_futexWakeAll(uint32_t *addr) {
+#ifdef __linux__
+    syscall(SYS_futex, addr, FUTEX_WAKE, INT_MAX, NULL, NULL, 0);
+#else
+    (void)addr;
+#endif
+}
+
+pubsub_shm_ring_t* pubsub_shmRing_open(const char *name, size_t ringSize) {
+    size_t size = pubsub_shmRing_roundUpToPowerOf2(ringSize);
+    pubsub_shm_ring_t *ring = NULL;
+
+    //note the flock serializes open and close, a ring removed by its last user between our shm_open and flock
+    //is detected with the removed flag and retried.
+    for (int attempt = 0; ring == NULL && attempt < PUBSUB_SHM_RING_OPEN_ATTEMPTS; ++attempt) {
+        int fd = shm_open(name, O_RDWR | O_CREAT, 0666);
+        if (fd < 0) {
+            return NULL;
+        }
+        if (flock(fd, LOCK_EX) != 0) {
+            close(fd);
+            return NULL;
+        }
+
+        struct stat st;
+        bool ok = fstat(fd, &st) == 0;
+        bool create = ok && st.st_size == 0;
+        size_t mappedSize = create ? sizeof(pubsub_shm_ring_control_t) + size : (size_t)st.st_size;
+        if (create) {
+            ok = ftruncate(fd, (off_t)mappedSize) == 0;
+        }
+        void *mem = MAP_FAILED;
+        if (ok && mappedSize > sizeof(pubsub_shm_ring_control_t)) {
+            mem = mmap(NULL, mappedSize, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        }
+        if (mem == MAP_FAILED) {
+            flock(fd, LOCK_UN);
+            close(fd);
+            return NULL;
+        }
+
+        pubsub_shm_ring_control_t *control = mem;
+        if (create) {
+            control->version = PUBSUB_SHM_RING_VERSION;
+            control->ringSize = size;
+            __atomic_store_n(&control->magic, PUBSUB_SHM_RING_MAGIC, __ATOMIC_RELEASE);
+        }
+
+        bool valid = control->magic == PUBSUB_SHM_RING_MAGIC &&
+                     control->version == PUBSUB_SHM_RING_VERSION &&
+                     control->ringSize + sizeof(*control) <= mappedSize &&
+                     (control->ringSize & (control->ringSize - 1)) == 0;
+        if (valid && control->removed == 0) {
+            control->users += 1;
+            ring = calloc(1, sizeof(*ring));
+            ring->name = strdup(name);
+            ring->fd = fd;
+            ring->mappedSize = mappedSize;
+            ring->control = control;
+            ring->data = (char*)mem + sizeof(*control);
+            ring->mask = control->ringSize - 1;
+            flock(fd, LOCK_UN);
+        } else {
+            flock(fd, LOCK_UN);
+            munmap(mem, mappedSize);
+            close(fd);
+            if (!valid) {
+                return NULL;
+            }
+        }
+    }
+
+    return ring;
+}
+
+void pubsub_shmRing_close(pubsub_shm_ring_t *ring) {
+    if (ring != NULL) {
+        flock(ring->fd, LOCK_EX);
+        ring->control->users -= 1;
+        if (ring->control->users == 0) {
+            ring->control->removed = 1;
+            shm_unlink(ring->name);
+        }
+        flock(ring->fd, LOCK_UN);
+
+        munmap(ring->control, ring->mappedSize);
+        close(ring->fd);
+        free(ring->name);
+        free(ring);
+    }
+}
+
+const char* pubsub_shmRing_name(const pubsub_shm_ring_t *ring) {
+    return ring->name;
+}
+
+size_t pubsub_shmRing_size(const pubsub_shm_ring_t *ring) {
+    return ring->control->ringSize;
+}
+
+size_t pubsub_shmRing_maxPayloadSize(const pubsub_shm_ring_t *ring) {
+    return ring->control->ringSize / 4 - sizeof(pubsub_shm_ring_record_t);
+}
+
+uint32_t pubsub_shmRing_users(const pubsub_shm_ring_t *ring) {
+    return __atomic_load_n(&ring->control->users, __ATOMIC_RELAXED);
+}
+
+celix_status_t pubsub_shmRing_write(pubsub_shm_ring_t *ring, const pubsub_shm_ring_msg_header_t *header, const void *payload, size_t payloadSize) {
+    return pubsub_shmRing_writeMany(ring, header, &payload, &payloadSize, 1);
+}
+
+static uint32_t pubsub_shmRing_recordSize(size_t payloadSize) {
+    return (uint32_t)((sizeof(pubsub_shm_ring_record_t) + payloadSize + 7) & ~(size_t)7);
+}
+
+/**
+ * Reserves space for the records of payloads [first, last), copies them in and commits them as a whole.
+ */
+static void pubsub_shmRing_writeRecords(pubsub_shm_ring_t *ring, const pubsub_shm_ring_msg_header_t *header, const void **payloads, const size_t *payloadSizes, size_t first, size_t last, uint64_t reserveSize) {
+    pubsub_shm_ring_control_t *control = ring->control;
+
+    uint64_t start = __atomic_fetch_add(&control->reservePos, reserveSize, __ATOMIC_ACQ_REL);
+    uint64_t pos = start;
+    for (size_t i = first; i < last; ++i) {
+        pubsub_shm_ring_record_t record;
+        record.recordSize = pubsub_shmRing_recordSize(payloadSizes[i]);
+        record.header = *header;
+        record.header.payloadSize = (uint32_t)payloadSizes[i];
+        pubsub_shmRing_copyIn(ring, pos, &record, sizeof(record));
+        pubsub_shmRing_copyIn(ring, pos + sizeof(record), payloads[i], payloadSizes[i]);
+        pos += record.recordSize;
+    }
+
+    //commit in reservation order, writers which reserved earlier must commit first.
+    //note that a writer process crashing between reserve and commit stalls the writers of the ring.
+    int spin = 0;
+    while (__atomic_load_n(&control->commitPos, __ATOMIC_ACQUIRE) != start) {
+        if (++spin >= PUBSUB_SHM_RING_SPIN_COUNT) {
+            sched_yield();
+            spin = 0;
+        }
+    }
+    __atomic_store_n(&control->commitPos, start + reserveSize, __ATOMIC_RELEASE);
+}
+
+celix_status_t pubsub_shmRing_writeMany(pubsub_shm_ring_t *ring, const pubsub_shm_ring_msg_header_t *header, const void **payloads, const size_t *payloadSizes, size_t n) {
+    size_t maxPayloadSize = pubsub_shmRing_maxPayloadSize(ring);
+    for (size_t i = 0; i < n; ++i) {
+        if (payloadSizes[i] > maxPayloadSize) {
+            return CELIX_ILLEGAL_ARGUMENT;
+        }
+    }
+    if (n == 0) {
+        return CELIX_SUCCESS;
+    }
+    pubsub_shm_ring_control_t *control = ring->control;
+
+    //note a single reservation is limited to the max record size, so that a batch cannot overrun readers on its own
+    uint64_t maxReserveSize = pubsub_shmRing_recordSize(maxPayloadSize);
+    size_t first = 0;
+    uint64_t reserveSize = 0;
+    for (size_t i = 0; i < n; ++i) {
+        uint32_t recordSize = pubsub_shmRing_recordSize(payloadSizes[i]);
+        if (i > first && reserveSize + recordSize > maxReserveSize) {
+            pubsub_shmRing_writeRecords(ring, header, payloads, payloadSizes, first, i, reserveSize);
+            first = i;
+            reserveSize = 0;
+        }
+        reserveSize += recordSize;
+    }
+    if (first < n) {
+        pubsub_shmRing_writeRecords(ring, header, payloads, payloadSizes, first, n, reserveSize);
+    }
+
+    __atomic_add_fetch(&control->wakeupSeq, 1, __ATOMIC_SEQ_CST);
+    if (__atomic_load_n(&control->waiters, __ATOMIC_SEQ_CST) > 0) {
+        pubsub_shmRing_futexWakeAll(&control->wakeupSeq);
+    }
+    return CELIX_SUCCESS;
+}
+
+uint64_t pubsub_shmRing_writePosition(const pubsub_shm_ring_t *ring) {
+    return __atomic_load_n(&ring->control->commitPos, __ATOMIC_ACQUIRE);
+}
+
+bool pubsub_shmRing_read(const pubsub_shm_ring_t *ring, uint64_t *readPos, pubsub_shm_ring_msg_header_t *header, void *payloadBuffer, bool *lost) {
+    pubsub_shm_ring_control_t *control = ring->control;
+    uint64_t ringSize = control->ringSize;
+    uint64_t pos = *readPos;
+    uint64_t commit = __atomic_load_n(&control->commitPos, __ATOMIC_ACQUIRE);
+    if (lost != NULL) {
+        *lost = false;
+    }
+
+    if (pos == commit) {
+        return false;
+    }
+
+    bool valid = commit - pos <= ringSize;
+    pubsub_shm_ring_record_t record;
+    if (valid) {
+        pubsub_shmRing_copyOut(ring, pos, &record, sizeof(record));
+        valid = record.recordSize >= sizeof(record) &&
+                record.recordSize <= commit - pos &&
+                record.header.payloadSize <= record.recordSize - sizeof(record) &&
+                record.header.payloadSize <= pubsub_shmRing_maxPayloadSize(ring);
+    }
+    if (valid) {
+        pubsub_shmRing_copyOut(ring, pos + sizeof(record), payloadBuffer, record.header.payloadSize);
+        //seqlock like check: if writers reserved beyond a ring size after pos, the copied data can be overwritten
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+        uint64_t reserve = __atomic_load_n(&control->reservePos, __ATOMIC_RELAXED);
+        valid = reserve - pos <= ringSize;
+    }
+
+    if (!valid) {
+        //overtaken by the writers, continue with the latest message
+        *readPos = __atomic_load_n(&control->commitPos, __ATOMIC_ACQUIRE);
+        if (lost != NULL) {
+            *lost = true;
+        }
+        return false;
+    }
+
+    *header = record.header;
+    *readPos = pos + record.recordSize;
+    return true;
+}
+
+void pubsub_shmRing_wait(pubsub_shm_ring_t *ring, uint64_t readPos, unsigned int timeoutInMs) {
+    pubsub_shm_ring_control_t *control = ring->control;
+    __atomic_add_fetch(&control->waiters, 1, __ATOMIC_SEQ_CST);
+    uint32_t seq = __atomic_load_n(&control->wakeupSeq, __ATOMIC_SEQ_CST);
+    if (__atomic_load_n(&control->commitPos, __ATOMIC_SEQ_CST) == readPos) {
+        pubsub_shmRing_futexWait(&control->wakeupSeq, seq, timeoutInMs);
+    }
+    __atomic_sub_fetch(&control->waiters, 1, __ATOMIC_SEQ_CST);
+}
+
+void pubsub_shmRing_wakeup(pubsub_shm_ring_t *ring) {
+    __atomic_add_fetch(&ring->control->wakeupSeq, 1, __ATOMIC_SEQ_CST);
+    pubsub_shmRing_futexWakeAll(&ring->control->wakeupSeq);
+}
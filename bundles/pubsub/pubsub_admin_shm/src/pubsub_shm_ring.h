@@ -0,0 +1,112 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *  KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#ifndef CELIX_PUBSUB_SHM_RING_H
+#define CELIX_PUBSUB_SHM_RING_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "celix_errno.h"
+
+/**
+ * Broadcast ring buffer of messages in POSIX shared memory, shared by all publishers and subscribers of a topic on
+ * a single host.
+ *
+ * Writers reserve space with an atomic add and commit in reservation order, readers keep their own read position
+ * and never block writers. A reader which is overtaken by the writers (more than the ring size behind) loses the
+ * overwritten messages and continues with the latest message.
+ * Readers waiting for messages are woken up with a futex in the shared memory, writers only wake when there are
+ * waiters.
+ */
+typedef struct pubsub_shm_ring pubsub_shm_ring_t;
+
+typedef struct pubsub_shm_ring_msg_header {
+    uint32_t msgTypeId;
+    uint8_t major;
+    uint8_t minor;
+    uint16_t flags;
+    uint32_t payloadSize;
+} pubsub_shm_ring_msg_header_t;
+
+/**
+ * Opens the ring with the provided shared memory name (e.g. "/celix_shm_scope_topic_json"), creates it with
+ * ringSize bytes (rounded up to a power of 2) if it does not exist yet.
+ * Returns NULL if the shared memory cannot be created/opened.
+ */
+pubsub_shm_ring_t* pubsub_shmRing_open(const char *name, size_t ringSize);
+
+/**
+ * Closes the ring, the shared memory is removed when the last user (in any process) closes the ring.
+ */
+void pubsub_shmRing_close(pubsub_shm_ring_t *ring);
+
+const char* pubsub_shmRing_name(const pubsub_shm_ring_t *ring);
+size_t pubsub_shmRing_size(const pubsub_shm_ring_t *ring);
+
+/**
+ * The max payload size of a single message (a quarter of the ring size).
+ */
+size_t pubsub_shmRing_maxPayloadSize(const pubsub_shm_ring_t *ring);
+
+/**
+ * Number of processes/users that have the ring open.
+ */
+uint32_t pubsub_shmRing_users(const pubsub_shm_ring_t *ring);
+
+/**
+ * Writes a message to the ring. Never blocks on readers, only waits (spins) for concurrent writers that reserved
+ * earlier to commit.
+ * Returns CELIX_ILLEGAL_ARGUMENT if the payload does not fit.
+ */
+celix_status_t pubsub_shmRing_write(pubsub_shm_ring_t *ring, const pubsub_shm_ring_msg_header_t *header, const void *payload, size_t payloadSize);
+
+/**
+ * Writes n messages with the same header (except the payload size) to the ring. The messages are reserved and
+ * committed in chunks of up to the max payload size and readers are woken once for the whole batch.
+ * Returns CELIX_ILLEGAL_ARGUMENT, without writing any message, if one of the payloads does not fit.
+ */
+celix_status_t pubsub_shmRing_writeMany(pubsub_shm_ring_t *ring, const pubsub_shm_ring_msg_header_t *header, const void **payloads, const size_t *payloadSizes, size_t n);
+
+/**
+ * Returns the current write position, a reader starting at this position only reads newer messages.
+ */
+uint64_t pubsub_shmRing_writePosition(const pubsub_shm_ring_t *ring);
+
+/**
+ * Reads the message at *readPos into payloadBuffer (which must be at least pubsub_shmRing_maxPayloadSize) and
+ * advances *readPos.
+ * Returns true if a message was read. If lost is not NULL it is set to true when the reader was overtaken by
+ * the writers; *readPos then skips to the latest message.
+ */
+bool pubsub_shmRing_read(const pubsub_shm_ring_t *ring, uint64_t *readPos, pubsub_shm_ring_msg_header_t *header, void *payloadBuffer, bool *lost);
+
+/**
+ * Waits until a message is available for readPos, the ring is woken with pubsub_shmRing_wakeup or the timeout
+ * expired.
+ */
+void pubsub_shmRing_wait(pubsub_shm_ring_t *ring, uint64_t readPos, unsigned int timeoutInMs);
+
+/**
+ * Wakes up all readers waiting on the ring, e.g. to stop a receive thread.
+ */
+void pubsub_shmRing_wakeup(pubsub_shm_ring_t *ring);
+
+#endif //CELIX_PUBSUB_SHM_RING_H
@@ -0,0 +1,376 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *  KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <stdlib.h>
+#include <errno.h>
+#include <memory.h>
+#include <pubsub/subscriber.h>
+#include <pubsub_constants.h>
+#include <pubsub_utils.h>
+#include <pubsub_msg_loan_pool.h>
+
+#include "pubsub_shm_topic_receiver.h"
+#include "pubsub_psa_shm_constants.h"
+#include "pubsub_shm_common.h"
+#include "pubsub_shm_ring.h"
+#include "celix_probes.h"
+
+#define RECV_THREAD_TIMEOUT_IN_MS   1000
+
+#define L_DEBUG(...) \
+    logHelper_log(receiver->logHelper, OSGI_LOGSERVICE_DEBUG, __VA_ARGS__)
+#define L_INFO(...) \
+    logHelper_log(receiver->logHelper, OSGI_LOGSERVICE_INFO, __VA_ARGS__)
+#define L_WARN(...) \
+    logHelper_log(receiver->logHelper, OSGI_LOGSERVICE_WARNING, __VA_ARGS__)
+#define L_ERROR(...) \
+    logHelper_log(receiver->logHelper, OSGI_LOGSERVICE_ERROR, __VA_ARGS__)
+
+struct pubsub_shm_topic_receiver {
+    celix_bundle_context_t *ctx;
+    log_helper_t *logHelper;
+    long serializerSvcId;
+    pubsub_serializer_service_t *serializer;
+    char *scope;
+    char *topic;
+    pubsub_shm_ring_t *ring;
+    uint64_t readPos; //only used by the receive thread
+    void *payloadBuffer; //only used by the receive thread
+
+    struct {
+        celix_thread_t thread;
+        celix_thread_mutex_t mutex;
+        bool running;
+        unsigned long nrOfOverruns;
+    } recvThread;
+
+    long subscriberTrackerId;
+    struct {
+        celix_thread_mutex_t mutex;
+        hash_map_t *map; //key = bnd id, value = psa_shm_subscriber_entry_t
+        bool allInitialized;
+    } subscribers;
+};
+
+typedef struct psa_shm_subscriber_entry {
+    int usageCount;
+    hash_map_t *msgTypes; //map from serializer svc
+    pubsub_subscriber_t *svc;
+
+    bool initialized; //true if the init function is called through the receive thread
+} psa_shm_subscriber_entry_t;
+
+static void pubsub_shmTopicReceiver_addSubscriber(void *handle, void *svc, const celix_properties_t *props, const celix_bundle_t *owner);
+static void pubsub_shmTopicReceiver_removeSubscriber(void *handle, void *svc, const celix_properties_t *props, const celix_bundle_t *owner);
+static void psa_shm_processMsg(pubsub_shm_topic_receiver_t *receiver, const pubsub_shm_ring_msg_header_t *header, const void *payload);
+static void* psa_shm_recvThread(void *data);
+static void psa_shm_initializeAllSubscribers(pubsub_shm_topic_receiver_t *receiver);
+
+pubsub_shm_topic_receiver_t* pubsub_shmTopicReceiver_create(
+        celix_bundle_context_t *ctx,
+        log_helper_t *logHelper,
+        const char *scope,
+        const char *topic,
+        long serializerSvcId,
+        pubsub_serializer_service_t *serializer,
+        const char *ringName,
+        size_t ringSize,
+        const celix_properties_t *topicProperties) {
+    pubsub_shm_topic_receiver_t *receiver = calloc(1, sizeof(*receiver));
+    receiver->ctx = ctx;
+    receiver->logHelper = logHelper;
+    receiver->serializerSvcId = serializerSvcId;
+    receiver->serializer = serializer;
+
+    receiver->ring = pubsub_shmRing_open(ringName, ringSize);
+    if (receiver->ring == NULL) {
+        L_ERROR("[PSA_SHM] Cannot open shared memory ring %s for TopicReceiver %s/%s (%s)", ringName, scope, topic, strerror(errno));
+        free(receiver);
+        return NULL;
+    }
+    //note only receiving messages published after the receiver is created
+    receiver->readPos = pubsub_shmRing_writePosition(receiver->ring);
+    receiver->payloadBuffer = malloc(pubsub_shmRing_maxPayloadSize(receiver->ring));
+
+    receiver->scope = strndup(scope, 1024 * 1024);
+    receiver->topic = strndup(topic, 1024 * 1024);
+    receiver->recvThread.running = true;
+
+    celixThreadMutex_create(&receiver->subscribers.mutex, NULL);
+    celixThreadMutex_create(&receiver->recvThread.mutex, NULL);
+
+    receiver->subscribers.map = hashMap_create(NULL, NULL, NULL, NULL);
+    receiver->subscribers.allInitialized = false;
+
+    //track subscribers
+    {
+        int size = snprintf(NULL, 0, "(%s=%s)", PUBSUB_SUBSCRIBER_TOPIC, topic);
+        char buf[size+1];
+        snprintf(buf, (size_t)size+1, "(%s=%s)", PUBSUB_SUBSCRIBER_TOPIC, topic);
+        celix_service_tracking_options_t opts = CELIX_EMPTY_SERVICE_TRACKING_OPTIONS;
+        opts.filter.ignoreServiceLanguage = true;
+        opts.filter.serviceName = PUBSUB_SUBSCRIBER_SERVICE_NAME;
+        opts.filter.filter = buf;
+        opts.callbackHandle = receiver;
+        opts.addWithOwner = pubsub_shmTopicReceiver_addSubscriber;
+        opts.removeWithOwner = pubsub_shmTopicReceiver_removeSubscriber;
+
+        receiver->subscriberTrackerId = celix_bundleContext_trackServicesWithOptions(ctx, &opts);
+    }
+
+    celixThread_create(&receiver->recvThread.thread, NULL, psa_shm_recvThread, receiver);
+    char name[64];
+    snprintf(name, 64, "SHM TR %s/%s", scope, topic);
+    celixThread_setName(&receiver->recvThread.thread, name);
+    celix_status_t threadStatus = pubsub_utils_setupThread(&receiver->recvThread.thread, topicProperties);
+    if (threadStatus != CELIX_SUCCESS) {
+        L_WARN("[PSA_SHM] Cannot configure the scheduling/cpu affinity of the receive thread of %s/%s. Error %i", scope, topic, threadStatus);
+    }
+
+    return receiver;
+}
+
+void pubsub_shmTopicReceiver_destroy(pubsub_shm_topic_receiver_t *receiver) {
+    if (receiver != NULL) {
+        celix_bundleContext_stopTracker(receiver->ctx, receiver->subscriberTrackerId);
+
+        celixThreadMutex_lock(&receiver->recvThread.mutex);
+        receiver->recvThread.running = false;
+        celixThreadMutex_unlock(&receiver->recvThread.mutex);
+        pubsub_shmRing_wakeup(receiver->ring);
+        celixThread_join(receiver->recvThread.thread, NULL);
+
+        celixThreadMutex_lock(&receiver->subscribers.mutex);
+        hash_map_iterator_t iter = hashMapIterator_construct(receiver->subscribers.map);
+        while (hashMapIterator_hasNext(&iter)) {
+            psa_shm_subscriber_entry_t *entry = hashMapIterator_nextValue(&iter);
+            if (entry != NULL) {
+                if (receiver->serializer != NULL && entry->msgTypes != NULL) {
+                    receiver->serializer->destroySerializerMap(receiver->serializer->handle, entry->msgTypes);
+                }
+                free(entry);
+            }
+        }
+        celixThreadMutex_unlock(&receiver->subscribers.mutex);
+        hashMap_destroy(receiver->subscribers.map, false, false);
+
+        celixThreadMutex_destroy(&receiver->subscribers.mutex);
+        celixThreadMutex_destroy(&receiver->recvThread.mutex);
+
+        pubsub_shmRing_close(receiver->ring);
+        free(receiver->payloadBuffer);
+        free(receiver->scope);
+        free(receiver->topic);
+        free(receiver);
+    }
+}
+
+const char* pubsub_shmTopicReceiver_scope(pubsub_shm_topic_receiver_t *receiver) {
+    return receiver->scope;
+}
+
+const char* pubsub_shmTopicReceiver_topic(pubsub_shm_topic_receiver_t *receiver) {
+    return receiver->topic;
+}
+
+const char* pubsub_shmTopicReceiver_ringName(pubsub_shm_topic_receiver_t *receiver) {
+    return pubsub_shmRing_name(receiver->ring);
+}
+
+size_t pubsub_shmTopicReceiver_ringSize(pubsub_shm_topic_receiver_t *receiver) {
+    return pubsub_shmRing_size(receiver->ring);
+}
+
+unsigned int pubsub_shmTopicReceiver_ringUsers(pubsub_shm_topic_receiver_t *receiver) {
+    return pubsub_shmRing_users(receiver->ring);
+}
+
+unsigned long pubsub_shmTopicReceiver_nrOfOverruns(pubsub_shm_topic_receiver_t *receiver) {
+    celixThreadMutex_lock(&receiver->recvThread.mutex);
+    unsigned long result = receiver->recvThread.nrOfOverruns;
+    celixThreadMutex_unlock(&receiver->recvThread.mutex);
+    return result;
+}
+
+long pubsub_shmTopicReceiver_serializerSvcId(pubsub_shm_topic_receiver_t *receiver) {
+    return receiver->serializerSvcId;
+}
+
+static void pubsub_shmTopicReceiver_addSubscriber(void *handle, void *svc, const celix_properties_t *props, const celix_bundle_t *bnd) {
+    pubsub_shm_topic_receiver_t *receiver = handle;
+
+    long bndId = celix_bundle_getId(bnd);
+    const char *subScope = celix_properties_get(props, PUBSUB_SUBSCRIBER_SCOPE, "default");
+    if (strncmp(subScope, receiver->scope, strlen(receiver->scope)) != 0) {
+        //not the same scope. ignore
+        return;
+    }
+
+    celixThreadMutex_lock(&receiver->subscribers.mutex);
+    psa_shm_subscriber_entry_t *entry = hashMap_get(receiver->subscribers.map, (void*)bndId);
+    if (entry != NULL) {
+        entry->usageCount += 1;
+    } else {
+        //new create entry
+        entry = calloc(1, sizeof(*entry));
+        entry->usageCount = 1;
+        entry->svc = svc;
+        entry->initialized = false;
+        receiver->subscribers.allInitialized = false;
+
+        int rc = receiver->serializer->createSerializerMap(receiver->serializer->handle, (celix_bundle_t*)bnd, &entry->msgTypes);
+        if (rc == 0) {
+            hashMap_put(receiver->subscribers.map, (void*)bndId, entry);
+        } else {
+            L_ERROR("[PSA_SHM] Cannot create msg serializer map for TopicReceiver %s/%s", receiver->scope, receiver->topic);
+            free(entry);
+        }
+    }
+    celixThreadMutex_unlock(&receiver->subscribers.mutex);
+}
+
+static void pubsub_shmTopicReceiver_removeSubscriber(void *handle, void *svc __attribute__((unused)), const celix_properties_t *props __attribute__((unused)), const celix_bundle_t *bnd) {
+    pubsub_shm_topic_receiver_t *receiver = handle;
+
+    long bndId = celix_bundle_getId(bnd);
+
+    celixThreadMutex_lock(&receiver->subscribers.mutex);
+    psa_shm_subscriber_entry_t *entry = hashMap_get(receiver->subscribers.map, (void*)bndId);
+    if (entry != NULL) {
+        entry->usageCount -= 1;
+    }
+    if (entry != NULL && entry->usageCount <= 0) {
+        //remove entry
+        hashMap_remove(receiver->subscribers.map, (void*)bndId);
+        int rc = receiver->serializer->destroySerializerMap(receiver->serializer->handle, entry->msgTypes);
+        if (rc != 0) {
+            L_ERROR("[PSA_SHM] Cannot destroy msg serializer map for TopicReceiver %s/%s", receiver->scope, receiver->topic);
+        }
+        free(entry);
+    }
+    celixThreadMutex_unlock(&receiver->subscribers.mutex);
+}
+
+static void* psa_shm_recvThread(void *data) {
+    pubsub_shm_topic_receiver_t *receiver = data;
+
+    celixThreadMutex_lock(&receiver->recvThread.mutex);
+    bool running = receiver->recvThread.running;
+    celixThreadMutex_unlock(&receiver->recvThread.mutex);
+
+    celixThreadMutex_lock(&receiver->subscribers.mutex);
+    bool allInitialized = receiver->subscribers.allInitialized;
+    celixThreadMutex_unlock(&receiver->subscribers.mutex);
+
+    while (running) {
+        if (!allInitialized) {
+            psa_shm_initializeAllSubscribers(receiver);
+        }
+
+        pubsub_shm_ring_msg_header_t header;
+        bool lost = false;
+        if (pubsub_shmRing_read(receiver->ring, &receiver->readPos, &header, receiver->payloadBuffer, &lost)) {
+            psa_shm_processMsg(receiver, &header, receiver->payloadBuffer);
+        } else if (lost) {
+            L_WARN("[PSA_SHM] TopicReceiver %s/%s is overtaken by the publishers, messages are lost", receiver->scope, receiver->topic);
+            celixThreadMutex_lock(&receiver->recvThread.mutex);
+            receiver->recvThread.nrOfOverruns += 1;
+            celixThreadMutex_unlock(&receiver->recvThread.mutex);
+        } else {
+            pubsub_shmRing_wait(receiver->ring, receiver->readPos, RECV_THREAD_TIMEOUT_IN_MS);
+        }
+
+        celixThreadMutex_lock(&receiver->recvThread.mutex);
+        running = receiver->recvThread.running;
+        celixThreadMutex_unlock(&receiver->recvThread.mutex);
+
+        celixThreadMutex_lock(&receiver->subscribers.mutex);
+        allInitialized = receiver->subscribers.allInitialized;
+        celixThreadMutex_unlock(&receiver->subscribers.mutex);
+    }
+
+    return NULL;
+}
+
+static void psa_shm_processMsg(pubsub_shm_topic_receiver_t *receiver, const pubsub_shm_ring_msg_header_t *header, const void *payload) {
+    CELIX_PROBE4(psa_receive, PUBSUB_SHM_ADMIN_TYPE, receiver->topic, header->msgTypeId, header->payloadSize);
+    celixThreadMutex_lock(&receiver->subscribers.mutex);
+    hash_map_iterator_t iter = hashMapIterator_construct(receiver->subscribers.map);
+    while (hashMapIterator_hasNext(&iter)) {
+        psa_shm_subscriber_entry_t *entry = hashMapIterator_nextValue(&iter);
+
+        pubsub_msg_serializer_t *msgSer = NULL;
+        if (entry->msgTypes != NULL) {
+            msgSer = hashMap_get(entry->msgTypes, (void *) (uintptr_t) header->msgTypeId);
+        }
+        if (msgSer == NULL) {
+            L_WARN("[PSA_SHM] Serializer not available for message %u.", header->msgTypeId);
+        } else if (psa_shm_checkVersion(msgSer->msgVersion, header)) {
+            void *msgInst = NULL;
+            celix_status_t status;
+            if ((header->flags & PSA_SHM_MSG_FLAG_POD) != 0) {
+                status = pubsub_createPodMsg(msgSer, payload, header->payloadSize, &msgInst);
+            } else {
+                status = msgSer->deserialize(msgSer->handle, payload, header->payloadSize, &msgInst);
+            }
+            if (status == CELIX_SUCCESS) {
+                bool release = true;
+                pubsub_subscriber_t *svc = entry->svc;
+                svc->receive(svc->handle, msgSer->msgName, header->msgTypeId, msgInst, &release);
+                if (release) {
+                    msgSer->freeMsg(msgSer->handle, msgInst);
+                }
+            } else {
+                L_WARN("[PSA_SHM] Cannot deserialize msg type %s.", msgSer->msgName);
+            }
+        } else {
+            int major = 0, minor = 0;
+            version_getMajor(msgSer->msgVersion, &major);
+            version_getMinor(msgSer->msgVersion, &minor);
+            L_WARN("[PSA_SHM] Version mismatch for primary message '%s' (have %d.%d, received %u.%u). NOT sending any part of the whole message.",
+                   msgSer->msgName, major, minor, header->major, header->minor);
+        }
+    }
+    celixThreadMutex_unlock(&receiver->subscribers.mutex);
+}
+
+static void psa_shm_initializeAllSubscribers(pubsub_shm_topic_receiver_t *receiver) {
+    celixThreadMutex_lock(&receiver->subscribers.mutex);
+    if (!receiver->subscribers.allInitialized) {
+        bool allInitialized = true;
+        hash_map_iterator_t iter = hashMapIterator_construct(receiver->subscribers.map);
+        while (hashMapIterator_hasNext(&iter)) {
+            psa_shm_subscriber_entry_t *entry = hashMapIterator_nextValue(&iter);
+            if (!entry->initialized) {
+                int rc = 0;
+                if (entry->svc != NULL && entry->svc->init != NULL) {
+                    rc = entry->svc->init(entry->svc->handle);
+                }
+                if (rc == 0) {
+                    entry->initialized = true;
+                } else {
+                    L_WARN("[PSA_SHM] Cannot initialize subscriber svc. Got rc %i", rc);
+                    allInitialized = false;
+                }
+            }
+        }
+        receiver->subscribers.allInitialized = allInitialized;
+    }
+    celixThreadMutex_unlock(&receiver->subscribers.mutex);
+}
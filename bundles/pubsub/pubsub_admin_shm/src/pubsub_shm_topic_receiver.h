@@ -0,0 +1,49 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *  KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#ifndef CELIX_PUBSUB_SHM_TOPIC_RECEIVER_H
+#define CELIX_PUBSUB_SHM_TOPIC_RECEIVER_H
+
+#include "celix_bundle_context.h"
+#include "pubsub_serializer.h"
+#include "log_helper.h"
+
+typedef struct pubsub_shm_topic_receiver pubsub_shm_topic_receiver_t;
+
+pubsub_shm_topic_receiver_t* pubsub_shmTopicReceiver_create(
+        celix_bundle_context_t *ctx,
+        log_helper_t *logHelper,
+        const char *scope,
+        const char *topic,
+        long serializerSvcId,
+        pubsub_serializer_service_t *serializer,
+        const char *ringName,
+        size_t ringSize,
+        const celix_properties_t *topicProperties);
+void pubsub_shmTopicReceiver_destroy(pubsub_shm_topic_receiver_t *receiver);
+
+const char* pubsub_shmTopicReceiver_scope(pubsub_shm_topic_receiver_t *receiver);
+const char* pubsub_shmTopicReceiver_topic(pubsub_shm_topic_receiver_t *receiver);
+const char* pubsub_shmTopicReceiver_ringName(pubsub_shm_topic_receiver_t *receiver);
+size_t pubsub_shmTopicReceiver_ringSize(pubsub_shm_topic_receiver_t *receiver);
+unsigned int pubsub_shmTopicReceiver_ringUsers(pubsub_shm_topic_receiver_t *receiver);
+unsigned long pubsub_shmTopicReceiver_nrOfOverruns(pubsub_shm_topic_receiver_t *receiver);
+long pubsub_shmTopicReceiver_serializerSvcId(pubsub_shm_topic_receiver_t *receiver);
+
+#endif //CELIX_PUBSUB_SHM_TOPIC_RECEIVER_H
@@ -0,0 +1,422 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *  KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <errno.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <memory.h>
+#include <pubsub_constants.h>
+#include <pubsub/publisher.h>
+#include <utils.h>
+#include <pubsub_msg_loan_pool.h>
+
+#include "pubsub_shm_topic_sender.h"
+#include "pubsub_psa_shm_constants.h"
+#include "pubsub_shm_ring.h"
+#include "pubsub_shm_common.h"
+#include "celix_probes.h"
+
+#define PSA_SHM_MAX_POOLED_LOANS    16
+
+#define L_DEBUG(...) \
+    logHelper_log(sender->logHelper, OSGI_LOGSERVICE_DEBUG, __VA_ARGS__)
+#define L_INFO(...) \
+    logHelper_log(sender->logHelper, OSGI_LOGSERVICE_INFO, __VA_ARGS__)
+#define L_WARN(...) \
+    logHelper_log(sender->logHelper, OSGI_LOGSERVICE_WARNING, __VA_ARGS__)
+#define L_ERROR(...) \
+    logHelper_log(sender->logHelper, OSGI_LOGSERVICE_ERROR, __VA_ARGS__)
+
+struct pubsub_shm_topic_sender {
+    celix_bundle_context_t *ctx;
+    log_helper_t *logHelper;
+    long serializerSvcId;
+    pubsub_serializer_service_t *serializer;
+    char *scope;
+    char *topic;
+    pubsub_shm_ring_t *ring;
+    pubsub_msg_loan_pool_t *loanPool;
+
+    struct {
+        long svcId;
+        celix_service_factory_t factory;
+    } publisher;
+
+    struct {
+        celix_thread_mutex_t mutex;
+        hash_map_t *map;  //key = bndId, value = psa_shm_bounded_service_entry_t
+    } boundedServices;
+};
+
+typedef struct psa_shm_bounded_service_entry {
+    pubsub_shm_topic_sender_t *parent;
+    pubsub_publisher_t service;
+    long bndId;
+    hash_map_t *msgTypes;
+    hash_map_t *msgTypeIds;
+    int getCount;
+} psa_shm_bounded_service_entry_t;
+
+static int psa_shm_localMsgTypeIdForMsgType(void* handle, const char* msgType, unsigned int* msgTypeId);
+static void* psa_shm_getPublisherService(void *handle, const celix_bundle_t *requestingBundle, const celix_properties_t *svcProperties);
+static void psa_shm_ungetPublisherService(void *handle, const celix_bundle_t *requestingBundle, const celix_properties_t *svcProperties);
+static int psa_shm_topicPublicationSend(void* handle, unsigned int msgTypeId, const void *inMsg);
+static int psa_shm_topicPublicationSendMany(void* handle, unsigned int msgTypeId, const void **inMsgs, size_t n);
+static void* psa_shm_topicPublicationLoanMsg(void* handle, unsigned int msgTypeId);
+static int psa_shm_topicPublicationSendLoanedMsg(void* handle, unsigned int msgTypeId, void *loanedMsg);
+static void psa_shm_topicPublicationReturnLoanedMsg(void* handle, unsigned int msgTypeId, void *loanedMsg);
+
+pubsub_shm_topic_sender_t* pubsub_shmTopicSender_create(
+        celix_bundle_context_t *ctx,
+        log_helper_t *logHelper,
+        const char *scope,
+        const char *topic,
+        long serializerSvcId,
+        pubsub_serializer_service_t *serializer,
+        const char *ringName,
+        size_t ringSize) {
+    pubsub_shm_topic_sender_t *sender = calloc(1, sizeof(*sender));
+    sender->ctx = ctx;
+    sender->logHelper = logHelper;
+    sender->serializerSvcId = serializerSvcId;
+    sender->serializer = serializer;
+
+    sender->ring = pubsub_shmRing_open(ringName, ringSize);
+    if (sender->ring == NULL) {
+        L_ERROR("[PSA_SHM] Cannot open shared memory ring %s for TopicSender %s/%s (%s)", ringName, scope, topic, strerror(errno));
+        free(sender);
+        return NULL;
+    }
+
+    sender->scope = strndup(scope, 1024 * 1024);
+    sender->topic = strndup(topic, 1024 * 1024);
+    sender->loanPool = pubsub_msgLoanPool_create(PSA_SHM_MAX_POOLED_LOANS);
+
+    celixThreadMutex_create(&sender->boundedServices.mutex, NULL);
+    sender->boundedServices.map = hashMap_create(NULL, NULL, NULL, NULL);
+
+    //register publisher services using a service factory
+    {
+        sender->publisher.factory.handle = sender;
+        sender->publisher.factory.getService = psa_shm_getPublisherService;
+        sender->publisher.factory.ungetService = psa_shm_ungetPublisherService;
+
+        celix_properties_t *props = celix_properties_create();
+        celix_properties_set(props, PUBSUB_PUBLISHER_TOPIC, sender->topic);
+        celix_properties_set(props, PUBSUB_PUBLISHER_SCOPE, sender->scope);
+
+        celix_service_registration_options_t opts = CELIX_EMPTY_SERVICE_REGISTRATION_OPTIONS;
+        opts.factory = &sender->publisher.factory;
+        opts.serviceName = PUBSUB_PUBLISHER_SERVICE_NAME;
+        opts.serviceVersion = PUBSUB_PUBLISHER_SERVICE_VERSION;
+        opts.properties = props;
+
+        sender->publisher.svcId = celix_bundleContext_registerServiceWithOptions(ctx, &opts);
+    }
+
+    return sender;
+}
+
+void pubsub_shmTopicSender_destroy(pubsub_shm_topic_sender_t *sender) {
+    if (sender != NULL) {
+        celix_bundleContext_unregisterService(sender->ctx, sender->publisher.svcId);
+
+        celixThreadMutex_lock(&sender->boundedServices.mutex);
+        hash_map_iterator_t iter = hashMapIterator_construct(sender->boundedServices.map);
+        while (hashMapIterator_hasNext(&iter)) {
+            psa_shm_bounded_service_entry_t *entry = hashMapIterator_nextValue(&iter);
+            if (entry != NULL) {
+                sender->serializer->destroySerializerMap(sender->serializer->handle, entry->msgTypes);
+                hashMap_destroy(entry->msgTypeIds, true, false);
+                free(entry);
+            }
+        }
+        hashMap_destroy(sender->boundedServices.map, false, false);
+        celixThreadMutex_unlock(&sender->boundedServices.mutex);
+        celixThreadMutex_destroy(&sender->boundedServices.mutex);
+
+        pubsub_shmRing_close(sender->ring);
+        pubsub_msgLoanPool_destroy(sender->loanPool);
+
+        free(sender->scope);
+        free(sender->topic);
+        free(sender);
+    }
+}
+
+const char* pubsub_shmTopicSender_scope(pubsub_shm_topic_sender_t *sender) {
+    return sender->scope;
+}
+
+const char* pubsub_shmTopicSender_topic(pubsub_shm_topic_sender_t *sender) {
+    return sender->topic;
+}
+
+const char* pubsub_shmTopicSender_ringName(pubsub_shm_topic_sender_t *sender) {
+    return pubsub_shmRing_name(sender->ring);
+}
+
+size_t pubsub_shmTopicSender_ringSize(pubsub_shm_topic_sender_t *sender) {
+    return pubsub_shmRing_size(sender->ring);
+}
+
+unsigned int pubsub_shmTopicSender_ringUsers(pubsub_shm_topic_sender_t *sender) {
+    return pubsub_shmRing_users(sender->ring);
+}
+
+long pubsub_shmTopicSender_serializerSvcId(pubsub_shm_topic_sender_t *sender) {
+    return sender->serializerSvcId;
+}
+
+static int psa_shm_localMsgTypeIdForMsgType(void *handle, const char *msgType, unsigned int *msgTypeId) {
+    psa_shm_bounded_service_entry_t *entry = (psa_shm_bounded_service_entry_t *) handle;
+    *msgTypeId = (unsigned int)(uintptr_t) hashMap_get(entry->msgTypeIds, msgType);
+    return 0;
+}
+
+static void* psa_shm_getPublisherService(void *handle, const celix_bundle_t *requestingBundle, const celix_properties_t *svcProperties __attribute__((unused))) {
+    pubsub_shm_topic_sender_t *sender = handle;
+    long bndId = celix_bundle_getId(requestingBundle);
+
+    pubsub_publisher_t *svc = NULL;
+
+    celixThreadMutex_lock(&sender->boundedServices.mutex);
+    psa_shm_bounded_service_entry_t *entry = hashMap_get(sender->boundedServices.map, (void*)bndId);
+    if (entry != NULL) {
+        entry->getCount += 1;
+        svc = &entry->service;
+    } else {
+        entry = calloc(1, sizeof(*entry));
+        entry->getCount = 1;
+        entry->parent = sender;
+        entry->bndId = bndId;
+
+        int rc = sender->serializer->createSerializerMap(sender->serializer->handle, (celix_bundle_t*)requestingBundle, &entry->msgTypes);
+        if (rc == 0) {
+            entry->msgTypeIds = hashMap_create(utils_stringHash, NULL, utils_stringEquals, NULL);
+            hash_map_iterator_t iter = hashMapIterator_construct(entry->msgTypes);
+            while (hashMapIterator_hasNext(&iter)) {
+                pubsub_msg_serializer_t *msgSer = hashMapIterator_nextValue(&iter);
+                hashMap_put(entry->msgTypeIds, strndup(msgSer->msgName, 1024), (void *)(uintptr_t) msgSer->msgId);
+            }
+
+            entry->service.handle = entry;
+            entry->service.localMsgTypeIdForMsgType = psa_shm_localMsgTypeIdForMsgType;
+            entry->service.send = psa_shm_topicPublicationSend;
+            entry->service.sendMany = psa_shm_topicPublicationSendMany;
+            entry->service.loanMsg = psa_shm_topicPublicationLoanMsg;
+            entry->service.sendLoanedMsg = psa_shm_topicPublicationSendLoanedMsg;
+            entry->service.returnLoanedMsg = psa_shm_topicPublicationReturnLoanedMsg;
+            hashMap_put(sender->boundedServices.map, (void*)bndId, entry);
+            svc = &entry->service;
+        } else {
+            L_ERROR("[PSA_SHM] Error creating publisher service, serializer not available / cannot get msg serializer map");
+            free(entry);
+        }
+    }
+    celixThreadMutex_unlock(&sender->boundedServices.mutex);
+
+    return svc;
+}
+
+static void psa_shm_ungetPublisherService(void *handle, const celix_bundle_t *requestingBundle, const celix_properties_t *svcProperties __attribute__((unused))) {
+    pubsub_shm_topic_sender_t *sender = handle;
+    long bndId = celix_bundle_getId(requestingBundle);
+
+    celixThreadMutex_lock(&sender->boundedServices.mutex);
+    psa_shm_bounded_service_entry_t *entry = hashMap_get(sender->boundedServices.map, (void*)bndId);
+    if (entry != NULL) {
+        entry->getCount -= 1;
+    }
+    if (entry != NULL && entry->getCount == 0) {
+        //free entry
+        hashMap_remove(sender->boundedServices.map, (void*)bndId);
+
+        int rc = sender->serializer->destroySerializerMap(sender->serializer->handle, entry->msgTypes);
+        if (rc != 0) {
+            L_ERROR("[PSA_SHM] Error destroying publisher service, serializer not available / cannot get msg serializer map");
+        }
+
+        hashMap_destroy(entry->msgTypeIds, true, false);
+        free(entry);
+    }
+    celixThreadMutex_unlock(&sender->boundedServices.mutex);
+}
+
+static int psa_shm_topicPublicationSend(void* handle, unsigned int msgTypeId, const void *inMsg) {
+    psa_shm_bounded_service_entry_t *entry = handle;
+    pubsub_shm_topic_sender_t *sender = entry->parent;
+    CELIX_PROBE4(psa_send, PUBSUB_SHM_ADMIN_TYPE, sender->topic, msgTypeId, 1);
+    int status = 0;
+
+    pubsub_msg_serializer_t* msgSer = NULL;
+    if (entry->msgTypes != NULL) {
+        msgSer = hashMap_get(entry->msgTypes, (void*)(intptr_t)(msgTypeId));
+    }
+
+    if (msgSer != NULL) {
+        void* serializedOutput = NULL;
+        size_t serializedOutputLen = 0;
+
+        if (msgSer->serialize(msgSer->handle, inMsg, &serializedOutput, &serializedOutputLen) == CELIX_SUCCESS) {
+            pubsub_shm_ring_msg_header_t header;
+            memset(&header, 0, sizeof(header));
+            header.msgTypeId = msgTypeId;
+            if (msgSer->msgVersion != NULL) {
+                int major = 0, minor = 0;
+                version_getMajor(msgSer->msgVersion, &major);
+                version_getMinor(msgSer->msgVersion, &minor);
+                header.major = (uint8_t) major;
+                header.minor = (uint8_t) minor;
+            }
+
+            celix_status_t rc = pubsub_shmRing_write(sender->ring, &header, serializedOutput, serializedOutputLen);
+            if (rc != CELIX_SUCCESS) {
+                L_WARN("[PSA_SHM] Msg type %s with size %zu does not fit in ring %s (max %zu)", msgSer->msgName,
+                       serializedOutputLen, pubsub_shmRing_name(sender->ring), pubsub_shmRing_maxPayloadSize(sender->ring));
+                status = -1;
+            }
+            free(serializedOutput);
+        } else {
+            L_WARN("[PSA_SHM] Serialization of msg type id %d failed", msgTypeId);
+            status = -1;
+        }
+    } else {
+        L_WARN("[PSA_SHM] No msg serializer available for msg type id %d", msgTypeId);
+        status = -1;
+    }
+    return status;
+}
+
+static int psa_shm_topicPublicationSendMany(void* handle, unsigned int msgTypeId, const void **inMsgs, size_t n) {
+    psa_shm_bounded_service_entry_t *entry = handle;
+    pubsub_shm_topic_sender_t *sender = entry->parent;
+    CELIX_PROBE4(psa_send, PUBSUB_SHM_ADMIN_TYPE, sender->topic, msgTypeId, n);
+    int status = 0;
+
+    pubsub_msg_serializer_t* msgSer = NULL;
+    if (entry->msgTypes != NULL) {
+        msgSer = hashMap_get(entry->msgTypes, (void*)(intptr_t)(msgTypeId));
+    }
+    if (msgSer == NULL) {
+        L_WARN("[PSA_SHM] No msg serializer available for msg type id %d", msgTypeId);
+        return -1;
+    }
+
+    pubsub_shm_ring_msg_header_t header;
+    memset(&header, 0, sizeof(header));
+    header.msgTypeId = msgTypeId;
+    if (msgSer->msgVersion != NULL) {
+        int major = 0, minor = 0;
+        version_getMajor(msgSer->msgVersion, &major);
+        version_getMinor(msgSer->msgVersion, &minor);
+        header.major = (uint8_t) major;
+        header.minor = (uint8_t) minor;
+    }
+
+    void **serializedOutputs = calloc(n, sizeof(*serializedOutputs));
+    size_t *serializedOutputLens = calloc(n, sizeof(*serializedOutputLens));
+    size_t nrOfMsgs = 0;
+    for (size_t i = 0; i < n; ++i) {
+        if (msgSer->serialize(msgSer->handle, inMsgs[i], &serializedOutputs[nrOfMsgs], &serializedOutputLens[nrOfMsgs]) == CELIX_SUCCESS) {
+            nrOfMsgs += 1;
+        } else {
+            L_WARN("[PSA_SHM] Serialization of msg type id %d failed", msgTypeId);
+            status = -1;
+        }
+    }
+
+    if (nrOfMsgs > 0) {
+        celix_status_t rc = pubsub_shmRing_writeMany(sender->ring, &header, (const void**)serializedOutputs, serializedOutputLens, nrOfMsgs);
+        if (rc != CELIX_SUCCESS) {
+            L_WARN("[PSA_SHM] Batch of msg type %s does not fit in ring %s (max %zu bytes per msg)", msgSer->msgName,
+                   pubsub_shmRing_name(sender->ring), pubsub_shmRing_maxPayloadSize(sender->ring));
+            status = -1;
+        }
+    }
+    for (size_t i = 0; i < nrOfMsgs; ++i) {
+        free(serializedOutputs[i]);
+    }
+    free(serializedOutputs);
+    free(serializedOutputLens);
+    return status;
+}
+
+static void* psa_shm_topicPublicationLoanMsg(void* handle, unsigned int msgTypeId) {
+    psa_shm_bounded_service_entry_t *entry = handle;
+    pubsub_shm_topic_sender_t *sender = entry->parent;
+
+    pubsub_msg_serializer_t* msgSer = NULL;
+    if (entry->msgTypes != NULL) {
+        msgSer = hashMap_get(entry->msgTypes, (void*)(intptr_t)(msgTypeId));
+    }
+    if (msgSer == NULL) {
+        L_WARN("[PSA_SHM] No msg serializer available for msg type id %d", msgTypeId);
+        return NULL;
+    } else if (msgSer->podSize == 0) {
+        L_WARN("[PSA_SHM] Cannot loan msg type %s, not a plain old data msg type", msgSer->msgName);
+        return NULL;
+    }
+    return pubsub_msgLoanPool_loan(sender->loanPool, msgSer->podSize);
+}
+
+static int psa_shm_topicPublicationSendLoanedMsg(void* handle, unsigned int msgTypeId, void *loanedMsg) {
+    psa_shm_bounded_service_entry_t *entry = handle;
+    pubsub_shm_topic_sender_t *sender = entry->parent;
+    CELIX_PROBE4(psa_send, PUBSUB_SHM_ADMIN_TYPE, sender->topic, msgTypeId, 1);
+    int status = 0;
+
+    pubsub_msg_serializer_t* msgSer = NULL;
+    if (entry->msgTypes != NULL) {
+        msgSer = hashMap_get(entry->msgTypes, (void*)(intptr_t)(msgTypeId));
+    }
+
+    if (msgSer != NULL && msgSer->podSize > 0) {
+        pubsub_shm_ring_msg_header_t header;
+        memset(&header, 0, sizeof(header));
+        header.msgTypeId = msgTypeId;
+        header.flags = PSA_SHM_MSG_FLAG_POD;
+        if (msgSer->msgVersion != NULL) {
+            int major = 0, minor = 0;
+            version_getMajor(msgSer->msgVersion, &major);
+            version_getMinor(msgSer->msgVersion, &minor);
+            header.major = (uint8_t) major;
+            header.minor = (uint8_t) minor;
+        }
+
+        //note the loaned msg is the payload, no serialization needed
+        celix_status_t rc = pubsub_shmRing_write(sender->ring, &header, loanedMsg, msgSer->podSize);
+        if (rc != CELIX_SUCCESS) {
+            L_WARN("[PSA_SHM] Msg type %s with size %zu does not fit in ring %s (max %zu)", msgSer->msgName,
+                   msgSer->podSize, pubsub_shmRing_name(sender->ring), pubsub_shmRing_maxPayloadSize(sender->ring));
+            status = -1;
+        }
+    } else {
+        L_WARN("[PSA_SHM] No plain old data msg serializer available for msg type id %d", msgTypeId);
+        status = -1;
+    }
+
+    pubsub_msgLoanPool_return(sender->loanPool, loanedMsg);
+    return status;
+}
+
+static void psa_shm_topicPublicationReturnLoanedMsg(void* handle, unsigned int msgTypeId __attribute__((unused)), void *loanedMsg) {
+    psa_shm_bounded_service_entry_t *entry = handle;
+    pubsub_msgLoanPool_return(entry->parent->loanPool, loanedMsg);
+}
@@ -20,6 +20,8 @@
 #ifndef PUBSUB_PSA_TCP_CONSTANTS_H_
 #define PUBSUB_PSA_TCP_CONSTANTS_H_
 
+#include "pubsub_constants.h"
+
 #define PSA_TCP_BASE_PORT                       "PSA_TCP_BASE_PORT"
 #define PSA_TCP_MAX_PORT                        "PSA_TCP_MAX_PORT"
 
@@ -27,6 +29,13 @@
 #define PSA_TCP_RECV_BUFFER_SIZE                "PSA_TCP_RECV_BUFFER_SIZE"
 #define PSA_TCP_TIMEOUT                         "PSA_TCP_TIMEOUT"
 
+/**
+ * Back the receive buffer pool (PSA_TCP_MAX_RECV_SESSIONS buffers per size class, starting at PSA_TCP_RECV_BUFFER_SIZE)
+ * with huge pages. Falls back to normal pages if no huge pages are reserved (vm.nr_hugepages).
+ */
+#define PSA_TCP_RECV_BUFFER_HUGE_PAGES          "PSA_TCP_RECV_BUFFER_HUGE_PAGES"
+#define PSA_TCP_DEFAULT_RECV_BUFFER_HUGE_PAGES  false
+
 #define PSA_TCP_DEFAULT_BASE_PORT               5501
 #define PSA_TCP_DEFAULT_MAX_PORT                6000
 
@@ -47,6 +56,40 @@
 #define PSA_TCP_METRICS_ENABLED                 "PSA_TCP_METRICS_ENABLED"
 #define PSA_TCP_DEFAULT_METRICS_ENABLED         true
 
+/**
+ * Use io_uring (multishot recv with provided buffers, zero copy send for large msgs) instead of epoll.
+ * Falls back to epoll when io_uring is not available (needs a Linux 6.1+ kernel).
+ */
+#define PSA_TCP_IO_URING                        "PSA_TCP_IO_URING"
+#define PSA_TCP_DEFAULT_IO_URING                false
+
+/**
+ * The nr of handler threads (each with its own epoll fd and a part of the connections) of a topic sender or receiver.
+ * Not used with io_uring.
+ */
+#define PSA_TCP_HANDLER_THREADS                 "PSA_TCP_HANDLER_THREADS"
+#define PSA_TCP_DEFAULT_HANDLER_THREADS         1
+
+/**
+ * Give every handler thread its own SO_REUSEPORT listener, instead of dividing the accepted connections round robin.
+ * Only use this with a static bind url or a port range used by a single process, another socket with SO_REUSEPORT
+ * can bind the same port.
+ */
+#define PSA_TCP_REUSE_PORT                      "PSA_TCP_REUSE_PORT"
+#define PSA_TCP_DEFAULT_REUSE_PORT              false
+
+/**
+ * Multiplex the topics over one connection per peer framework. All topic senders of the admin share a single
+ * listener (one port in the base/max port range) and tag their msgs with a topic id, the topic receivers connecting to
+ * the same peer share a single connection over which they subscribe their topic. The msgs of the topics for the same
+ * peer are written through the same send queue and are coalesced when the socket is not directly writable.
+ * Must be enabled on all frameworks exchanging tcp topics. Topics with a static endpoint or without header are not
+ * multiplexed, the (per topic) send queue, blocking and last value cache settings are not used for multiplexed topics.
+ */
+#define PSA_TCP_MULTIPLEX                       "PSA_TCP_MULTIPLEX"
+#define PSA_TCP_DEFAULT_MULTIPLEX               false
+#define PSA_TCP_MUX_BIND_MAX_RETRY              10
+
 #define PUBSUB_TCP_VERBOSE_KEY                  "PSA_TCP_VERBOSE"
 #define PUBSUB_TCP_VERBOSE_DEFAULT              true
 
@@ -117,11 +160,11 @@
 
 /**
  * Realtime thread prio and scheduling information. This is used to setup the thread prio/sched of the
- * internal TCP threads.
+ * internal TCP threads. See also PUBSUB_THREAD_CPU_AFFINITY_KEY.
  * Can be set in the topic properties.
  */
-#define PUBSUB_TCP_THREAD_REALTIME_PRIO         "thread.realtime.prio"
-#define PUBSUB_TCP_THREAD_REALTIME_SCHED        "thread.realtime.sched"
+#define PUBSUB_TCP_THREAD_REALTIME_PRIO         PUBSUB_THREAD_REALTIME_PRIO_KEY
+#define PUBSUB_TCP_THREAD_REALTIME_SCHED        PUBSUB_THREAD_REALTIME_SCHED_KEY
 
 
 #endif /* PUBSUB_PSA_TCP_CONSTANTS_H_ */
@@ -18,12 +18,15 @@
  */
 
 #include <memory.h>
+#include <stdlib.h>
+#include <errno.h>
 #include <sys/socket.h>
 #include <netinet/in.h>
 #include <arpa/inet.h>
 #include <netdb.h>
 #include <ifaddrs.h>
 #include <pubsub_endpoint.h>
+#include <pubsub/subscriber.h>
 #include <pubsub_serializer.h>
 #include <ip_utils.h>
 
@@ -80,6 +83,13 @@ struct pubsub_tcp_admin {
     } discoveredEndpoints;
 
   pubsub_tcp_endPointStore_t endpointStore;
+
+    struct {
+        pubsub_tcpHandler_t *handler; //shared by the multiplexed topic senders and receivers, NULL if not multiplexed
+        celix_thread_t thread;
+        celix_thread_mutex_t mutex;
+        bool running;
+    } mux;
 };
 
 typedef struct psa_tcp_serializer_entry {
@@ -89,10 +99,33 @@ typedef struct psa_tcp_serializer_entry {
 } psa_tcp_serializer_entry_t;
 
 static celix_status_t tcp_getIpAddress(const char* interface, char** ip);
+static void pubsub_tcpAdmin_createMux(pubsub_tcp_admin_t *psa);
+static void pubsub_tcpAdmin_destroyMux(pubsub_tcp_admin_t *psa);
 static celix_status_t pubsub_tcpAdmin_connectEndpointToReceiver(pubsub_tcp_admin_t* psa, pubsub_tcp_topic_receiver_t *receiver, const celix_properties_t *endpoint);
 static celix_status_t pubsub_tcpAdmin_disconnectEndpointFromReceiver(pubsub_tcp_admin_t* psa, pubsub_tcp_topic_receiver_t *receiver, const celix_properties_t *endpoint);
 
 
+static bool pubsub_tcpAdmin_endpointIsSubscriber(const celix_properties_t *endpoint) {
+    const char *type = celix_properties_get(endpoint, PUBSUB_ENDPOINT_TYPE, NULL);
+    return type != NULL && strncmp(PUBSUB_SUBSCRIBER_ENDPOINT_TYPE, type, strlen(PUBSUB_SUBSCRIBER_ENDPOINT_TYPE)) == 0;
+}
+
+/**
+ * Returns the topic sender with the scope/topic of the endpoint or NULL.
+ * Note should be called with the topicSenders mutex locked.
+ */
+static pubsub_tcp_topic_sender_t* pubsub_tcpAdmin_senderForEndpoint(pubsub_tcp_admin_t *psa, const celix_properties_t *endpoint) {
+    const char *scope = celix_properties_get(endpoint, PUBSUB_ENDPOINT_TOPIC_SCOPE, NULL);
+    const char *topic = celix_properties_get(endpoint, PUBSUB_ENDPOINT_TOPIC_NAME, NULL);
+    if (scope == NULL || topic == NULL) {
+        return NULL;
+    }
+    char *key = pubsubEndpoint_createScopeTopicKey(scope, topic);
+    pubsub_tcp_topic_sender_t *sender = hashMap_get(psa->topicSenders.map, key);
+    free(key);
+    return sender;
+}
+
 pubsub_tcp_admin_t* pubsub_tcpAdmin_create(celix_bundle_context_t *ctx, log_helper_t *logHelper) {
     pubsub_tcp_admin_t *psa = calloc(1, sizeof(*psa));
     psa->ctx = ctx;
@@ -159,6 +192,10 @@ pubsub_tcp_admin_t* pubsub_tcpAdmin_create(celix_bundle_context_t *ctx, log_help
     celixThreadMutex_create(&psa->endpointStore.mutex, NULL);
     psa->endpointStore.map = hashMap_create(utils_stringHash, NULL, utils_stringEquals, NULL);
 
+    if (celix_bundleContext_getPropertyAsBool(ctx, PSA_TCP_MULTIPLEX, PSA_TCP_DEFAULT_MULTIPLEX)) {
+        pubsub_tcpAdmin_createMux(psa);
+    }
+
     return psa;
 }
 
@@ -191,6 +228,8 @@ void pubsub_tcpAdmin_destroy(pubsub_tcp_admin_t *psa) {
     }
     celixThreadMutex_unlock(&psa->topicReceivers.mutex);
 
+    pubsub_tcpAdmin_destroyMux(psa);
+
     celixThreadMutex_lock(&psa->discoveredEndpoints.mutex);
     iter = hashMapIterator_construct(psa->discoveredEndpoints.map);
     while (hashMapIterator_hasNext(&iter)) {
@@ -225,6 +264,7 @@ void pubsub_tcpAdmin_destroy(pubsub_tcp_admin_t *psa) {
 
     free(psa->ipAddress);
 
+    pubsub_utils_clearTopicPropertiesCache();
     free(psa);
 }
 
@@ -362,7 +402,7 @@ celix_status_t pubsub_tcpAdmin_setupTopicSender(void *handle, const char *scope,
     if (sender == NULL) {
         psa_tcp_serializer_entry_t *serEntry = hashMap_get(psa->serializers.map, (void*)serializerSvcId);
         if (serEntry != NULL) {
-            sender = pubsub_tcpTopicSender_create(psa->ctx, psa->log, scope, topic, topicProperties, &psa->endpointStore, serializerSvcId, serEntry->svc,
+            sender = pubsub_tcpTopicSender_create(psa->ctx, psa->log, scope, topic, topicProperties, &psa->endpointStore, psa->mux.handler, serializerSvcId, serEntry->svc,
                      psa->ipAddress, staticBindUrl, psa->basePort, psa->maxPort);
         }
         if (sender != NULL) {
@@ -397,7 +437,29 @@ celix_status_t pubsub_tcpAdmin_setupTopicSender(void *handle, const char *scope,
     celixThreadMutex_unlock(&psa->serializers.mutex);
 
     if (sender != NULL && newEndpoint != NULL) {
-        //TODO connect endpoints to sender, NOTE is this needed for a tcp topic sender?
+        //apply the msg filters of the already discovered subscribers
+        celixThreadMutex_lock(&psa->discoveredEndpoints.mutex);
+        hash_map_iterator_t iter = hashMapIterator_construct(psa->discoveredEndpoints.map);
+        while (hashMapIterator_hasNext(&iter)) {
+            celix_properties_t *endpoint = hashMapIterator_nextValue(&iter);
+            const char *eScope = celix_properties_get(endpoint, PUBSUB_ENDPOINT_TOPIC_SCOPE, "");
+            const char *eTopic = celix_properties_get(endpoint, PUBSUB_ENDPOINT_TOPIC_NAME, "");
+            if (pubsub_tcpAdmin_endpointIsSubscriber(endpoint) && strcmp(eScope, scope) == 0 && strcmp(eTopic, topic) == 0) {
+                pubsub_tcpTopicSender_addMsgFilter(sender, celix_properties_get(endpoint, PUBSUB_ENDPOINT_UUID, NULL),
+                                                   celix_properties_get(endpoint, PUBSUB_ENDPOINT_MSG_FILTER, NULL));
+            }
+        }
+        celixThreadMutex_unlock(&psa->discoveredEndpoints.mutex);
+
+        //the local topic receiver is keyed by the framework uuid
+        char *receiverKey = pubsubEndpoint_createScopeTopicKey(scope, topic);
+        celixThreadMutex_lock(&psa->topicReceivers.mutex);
+        pubsub_tcp_topic_receiver_t *receiver = hashMap_get(psa->topicReceivers.map, receiverKey);
+        if (receiver != NULL) {
+            pubsub_tcpTopicSender_addMsgFilter(sender, psa->fwUUID, pubsub_tcpTopicReceiver_msgFilter(receiver));
+        }
+        celixThreadMutex_unlock(&psa->topicReceivers.mutex);
+        free(receiverKey);
     }
 
     if (newEndpoint != NULL && outPublisherEndpoint != NULL) {
@@ -445,7 +507,7 @@ celix_status_t pubsub_tcpAdmin_setupTopicReceiver(void *handle, const char *scop
         psa_tcp_serializer_entry_t *serEntry = hashMap_get(psa->serializers.map, (void*)serializerSvcId);
         if (serEntry != NULL) {
             receiver = pubsub_tcpTopicReceiver_create(psa->ctx, psa->log, scope, topic, topicProperties, &psa->endpointStore,
-                    serializerSvcId, serEntry->svc);
+                    psa->mux.handler, serializerSvcId, serEntry->svc);
         } else {
             L_ERROR("[PSA_TCP] Cannot find serializer for TopicSender %s/%s", scope, topic);
         }
@@ -454,6 +516,10 @@ celix_status_t pubsub_tcpAdmin_setupTopicReceiver(void *handle, const char *scop
             const char *serType = serEntry->serType;
             newEndpoint = pubsubEndpoint_create(psa->fwUUID, scope, topic,
                                                 PUBSUB_SUBSCRIBER_ENDPOINT_TYPE, psaType, serType, NULL);
+            const char *msgFilter = pubsub_tcpTopicReceiver_msgFilter(receiver);
+            if (msgFilter != NULL) {
+                celix_properties_set(newEndpoint, PUBSUB_ENDPOINT_MSG_FILTER, msgFilter);
+            }
             //if available also set container name
             const char *cn = celix_bundleContext_getProperty(psa->ctx, "CELIX_CONTAINER_NAME", NULL);
             if (cn != NULL) {
@@ -482,6 +548,13 @@ celix_status_t pubsub_tcpAdmin_setupTopicReceiver(void *handle, const char *scop
             }
         }
         celixThreadMutex_unlock(&psa->discoveredEndpoints.mutex);
+
+        celixThreadMutex_lock(&psa->topicSenders.mutex);
+        pubsub_tcp_topic_sender_t *sender = pubsub_tcpAdmin_senderForEndpoint(psa, newEndpoint);
+        if (sender != NULL) {
+            pubsub_tcpTopicSender_addMsgFilter(sender, psa->fwUUID, pubsub_tcpTopicReceiver_msgFilter(receiver));
+        }
+        celixThreadMutex_unlock(&psa->topicSenders.mutex);
     }
 
     if (newEndpoint != NULL && outSubscriberEndpoint != NULL) {
@@ -509,6 +582,15 @@ celix_status_t pubsub_tcpAdmin_teardownTopicReceiver(void *handle, const char *s
     }
     celixThreadMutex_unlock(&psa->topicReceivers.mutex);
 
+    celixThreadMutex_lock(&psa->topicSenders.mutex);
+    key = pubsubEndpoint_createScopeTopicKey(scope, topic);
+    pubsub_tcp_topic_sender_t *sender = hashMap_get(psa->topicSenders.map, key);
+    if (sender != NULL) {
+        pubsub_tcpTopicSender_removeMsgFilter(sender, psa->fwUUID);
+    }
+    free(key);
+    celixThreadMutex_unlock(&psa->topicSenders.mutex);
+
     celix_status_t  status = CELIX_SUCCESS;
     return status;
 }
@@ -553,6 +635,15 @@ celix_status_t pubsub_tcpAdmin_addDiscoveredEndpoint(void *handle, const celix_p
             pubsub_tcpAdmin_connectEndpointToReceiver(psa, receiver, endpoint);
         }
         celixThreadMutex_unlock(&psa->topicReceivers.mutex);
+    } else if (pubsub_tcpAdmin_endpointIsSubscriber(endpoint)) {
+        //the topic sender for the scope/topic only sends the msgs needed by the msg filter of the subscriber
+        celixThreadMutex_lock(&psa->topicSenders.mutex);
+        pubsub_tcp_topic_sender_t *sender = pubsub_tcpAdmin_senderForEndpoint(psa, endpoint);
+        if (sender != NULL) {
+            pubsub_tcpTopicSender_addMsgFilter(sender, celix_properties_get(endpoint, PUBSUB_ENDPOINT_UUID, NULL),
+                                               celix_properties_get(endpoint, PUBSUB_ENDPOINT_MSG_FILTER, NULL));
+        }
+        celixThreadMutex_unlock(&psa->topicSenders.mutex);
     }
 
     celixThreadMutex_lock(&psa->discoveredEndpoints.mutex);
@@ -604,6 +695,13 @@ celix_status_t pubsub_tcpAdmin_removeDiscoveredEndpoint(void *handle, const celi
             pubsub_tcpAdmin_disconnectEndpointFromReceiver(psa, receiver, endpoint);
         }
         celixThreadMutex_unlock(&psa->topicReceivers.mutex);
+    } else if (pubsub_tcpAdmin_endpointIsSubscriber(endpoint)) {
+        celixThreadMutex_lock(&psa->topicSenders.mutex);
+        pubsub_tcp_topic_sender_t *sender = pubsub_tcpAdmin_senderForEndpoint(psa, endpoint);
+        if (sender != NULL) {
+            pubsub_tcpTopicSender_removeMsgFilter(sender, celix_properties_get(endpoint, PUBSUB_ENDPOINT_UUID, NULL));
+        }
+        celixThreadMutex_unlock(&psa->topicSenders.mutex);
     }
 
     celixThreadMutex_lock(&psa->discoveredEndpoints.mutex);
@@ -683,19 +781,15 @@ celix_status_t pubsub_tcpAdmin_executeCommand(void *handle, char *commandLine __
     return status;
 }
 
-pubsub_admin_metrics_t* pubsub_tcpAdmin_metrics(void *handle) {
+void pubsub_tcpAdmin_visitMetrics(void *handle, const struct timespec *changedSince, void *callbackHandle,
+                                  pubsub_metrics_visit_fp callback) {
     pubsub_tcp_admin_t *psa = handle;
-    pubsub_admin_metrics_t *result = calloc(1, sizeof(*result));
-    snprintf(result->psaType, PUBSUB_AMDIN_METRICS_NAME_MAX, "%s", PUBSUB_TCP_ADMIN_TYPE);
-    result->senders = celix_arrayList_create();
-    result->receivers = celix_arrayList_create();
 
     celixThreadMutex_lock(&psa->topicSenders.mutex);
     hash_map_iterator_t iter = hashMapIterator_construct(psa->topicSenders.map);
     while (hashMapIterator_hasNext(&iter)) {
         pubsub_tcp_topic_sender_t *sender = hashMapIterator_nextValue(&iter);
-        pubsub_admin_sender_metrics_t *metrics = pubsub_tcpTopicSender_metrics(sender);
-        celix_arrayList_add(result->senders, metrics);
+        pubsub_tcpTopicSender_visitMetrics(sender, changedSince, callbackHandle, callback);
     }
     celixThreadMutex_unlock(&psa->topicSenders.mutex);
 
@@ -703,12 +797,81 @@ pubsub_admin_metrics_t* pubsub_tcpAdmin_metrics(void *handle) {
     iter = hashMapIterator_construct(psa->topicReceivers.map);
     while (hashMapIterator_hasNext(&iter)) {
         pubsub_tcp_topic_receiver_t *receiver = hashMapIterator_nextValue(&iter);
-        pubsub_admin_receiver_metrics_t *metrics = pubsub_tcpTopicReceiver_metrics(receiver);
-        celix_arrayList_add(result->receivers, metrics);
+        pubsub_tcpTopicReceiver_visitMetrics(receiver, changedSince, callbackHandle, callback);
     }
     celixThreadMutex_unlock(&psa->topicReceivers.mutex);
+}
+
+static void *pubsub_tcpAdmin_muxThread(void *data) {
+    pubsub_tcp_admin_t *psa = data;
+    celixThreadMutex_lock(&psa->mux.mutex);
+    bool running = psa->mux.running;
+    celixThreadMutex_unlock(&psa->mux.mutex);
+    while (running) {
+        pubsub_tcpHandler_handler(psa->mux.handler);
+        celixThreadMutex_lock(&psa->mux.mutex);
+        running = psa->mux.running;
+        celixThreadMutex_unlock(&psa->mux.mutex);
+    }
+    return NULL;
+}
 
-    return result;
+/**
+ * Creates the socket handler shared by the multiplexed topic senders and receivers, with a single listener for all
+ * topic senders and run by a single (admin) thread.
+ */
+static void pubsub_tcpAdmin_createMux(pubsub_tcp_admin_t *psa) {
+    celix_bundle_context_t *ctx = psa->ctx;
+    pubsub_tcpHandler_t *handler = pubsub_tcpHandler_create(psa->log);
+    pubsub_tcpHandler_setMultiplexed(handler, true);
+    pubsub_tcpHandler_setIoUring(handler, celix_bundleContext_getPropertyAsBool(ctx, PSA_TCP_IO_URING, PSA_TCP_DEFAULT_IO_URING));
+    pubsub_tcpHandler_setThreads(handler,
+                                 (unsigned int) celix_bundleContext_getPropertyAsLong(ctx, PSA_TCP_HANDLER_THREADS, PSA_TCP_DEFAULT_HANDLER_THREADS),
+                                 celix_bundleContext_getPropertyAsBool(ctx, PSA_TCP_REUSE_PORT, PSA_TCP_DEFAULT_REUSE_PORT));
+    pubsub_tcpHandler_setReceiveBufferHugePages(handler, celix_bundleContext_getPropertyAsBool(ctx, PSA_TCP_RECV_BUFFER_HUGE_PAGES, PSA_TCP_DEFAULT_RECV_BUFFER_HUGE_PAGES));
+    pubsub_tcpHandler_createReceiveBufferStore(handler,
+                                               (unsigned int) celix_bundleContext_getPropertyAsLong(ctx, PSA_TCP_MAX_RECV_SESSIONS, PSA_TCP_DEFAULT_MAX_RECV_SESSIONS),
+                                               (unsigned int) celix_bundleContext_getPropertyAsLong(ctx, PSA_TCP_RECV_BUFFER_SIZE, PSA_TCP_DEFAULT_RECV_BUFFER_SIZE));
+    pubsub_tcpHandler_setTimeout(handler, (unsigned int) celix_bundleContext_getPropertyAsLong(ctx, PSA_TCP_TIMEOUT, PSA_TCP_DEFAULT_TIMEOUT));
+
+    bool listening = false;
+    for (int retry = 0; !listening && retry < PSA_TCP_MUX_BIND_MAX_RETRY; ++retry) {
+        unsigned int port = psa->basePort + (unsigned int) random() % (psa->maxPort - psa->basePort + 1);
+        char *url = NULL;
+        asprintf(&url, "tcp://%s:%u", psa->ipAddress, port);
+        listening = pubsub_tcpHandler_listen(handler, url) >= 0;
+        if (!listening) {
+            L_WARN("[PSA_TCP] Error for tcp_bind using multiplexed bind url '%s'. %s", url, strerror(errno));
+        }
+        free(url);
+    }
+    if (!listening) {
+        L_ERROR("[PSA_TCP] Cannot create multiplexed listener, topics are not multiplexed");
+        pubsub_tcpHandler_destroy(handler);
+        return;
+    }
+
+    psa->mux.handler = handler;
+    psa->mux.running = true;
+    celixThreadMutex_create(&psa->mux.mutex, NULL);
+    celixThread_create(&psa->mux.thread, NULL, pubsub_tcpAdmin_muxThread, psa);
+    celixThread_setName(&psa->mux.thread, "TCP MUX");
+    if (psa->verbose) {
+        L_INFO("[PSA_TCP] Multiplexing topics using %s", pubsub_tcpHandler_url(handler));
+    }
+}
+
+static void pubsub_tcpAdmin_destroyMux(pubsub_tcp_admin_t *psa) {
+    //note the multiplexed topic senders and receivers are already destroyed
+    if (psa->mux.handler != NULL) {
+        celixThreadMutex_lock(&psa->mux.mutex);
+        psa->mux.running = false;
+        celixThreadMutex_unlock(&psa->mux.mutex);
+        celixThread_join(psa->mux.thread, NULL);
+        celixThreadMutex_destroy(&psa->mux.mutex);
+        pubsub_tcpHandler_destroy(psa->mux.handler);
+        psa->mux.handler = NULL;
+    }
 }
 
 #ifndef ANDROID
@@ -48,7 +48,7 @@ void pubsub_tcpAdmin_removeSerializerSvc(void *handle, void *svc, const celix_pr
 
 celix_status_t pubsub_tcpAdmin_executeCommand(void *handle, char *commandLine, FILE *outStream, FILE *errStream);
 
-pubsub_admin_metrics_t* pubsub_tcpAdmin_metrics(void *handle);
+void pubsub_tcpAdmin_visitMetrics(void *handle, const struct timespec *changedSince, void *callbackHandle, pubsub_metrics_visit_fp callback);
 
 #endif //CELIX_PUBSUB_TCP_ADMIN_H
 
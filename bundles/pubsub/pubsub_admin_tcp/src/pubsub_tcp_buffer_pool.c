@@ -0,0 +1,156 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *  KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+
+#include <stdlib.h>
+#include <stdint.h>
+#include <sys/mman.h>
+#include "celix_threads.h"
+#include "pubsub_tcp_buffer_pool.h"
+
+#define PSA_TCP_BUFFER_POOL_SIZE_CLASSES 8 //largest size class is 128 times the min buffer size
+#define PSA_TCP_HUGE_PAGE_SIZE           (2u * 1024u * 1024u)
+
+#ifndef MAP_HUGETLB
+#define MAP_HUGETLB 0
+#endif
+
+typedef struct pubsub_tcp_size_class {
+    size_t bufferSize;
+    char *slab; //NULL till the size class is first used
+    size_t slabSize;
+    char **freeBuffers; //stack of the free buffers of the slab
+    unsigned int nrOfFreeBuffers;
+} pubsub_tcp_size_class_t;
+
+struct pubsub_tcp_buffer_pool {
+    celix_thread_mutex_t mutex;
+    unsigned int maxNofBuffers;
+    bool useHugePages;
+    pubsub_tcp_size_class_t classes[PSA_TCP_BUFFER_POOL_SIZE_CLASSES];
+};
+
+pubsub_tcp_buffer_pool_t* pubsub_tcpBufferPool_create(unsigned int minBufferSize, unsigned int maxNofBuffers, bool useHugePages) {
+    pubsub_tcp_buffer_pool_t *pool = calloc(1, sizeof(*pool));
+    pool->maxNofBuffers = maxNofBuffers > 0 ? maxNofBuffers : 1;
+    pool->useHugePages = useHugePages;
+    for (int i = 0; i < PSA_TCP_BUFFER_POOL_SIZE_CLASSES; ++i) {
+        pool->classes[i].bufferSize = (size_t) (minBufferSize > 0 ? minBufferSize : 1) << i;
+    }
+    celixThreadMutex_create(&pool->mutex, NULL);
+    return pool;
+}
+
+void pubsub_tcpBufferPool_destroy(pubsub_tcp_buffer_pool_t *pool) {
+    if (pool != NULL) {
+        for (int i = 0; i < PSA_TCP_BUFFER_POOL_SIZE_CLASSES; ++i) {
+            if (pool->classes[i].slab != NULL) {
+                munmap(pool->classes[i].slab, pool->classes[i].slabSize);
+            }
+            free(pool->classes[i].freeBuffers);
+        }
+        celixThreadMutex_destroy(&pool->mutex);
+        free(pool);
+    }
+}
+
+static pubsub_tcp_size_class_t* pubsub_tcpBufferPool_sizeClass(pubsub_tcp_buffer_pool_t *pool, size_t size) {
+    for (int i = 0; i < PSA_TCP_BUFFER_POOL_SIZE_CLASSES; ++i) {
+        if (size <= pool->classes[i].bufferSize) {
+            return &pool->classes[i];
+        }
+    }
+    return NULL;
+}
+
+//
+// Maps the slab of the size class and fills its stack of free buffers. Falls back to normal pages when no huge pages
+// are available.
+//
+static void pubsub_tcpBufferPool_createSlab(pubsub_tcp_buffer_pool_t *pool, pubsub_tcp_size_class_t *sizeClass) {
+    //note pool->mutex locked
+    size_t slabSize = sizeClass->bufferSize * pool->maxNofBuffers;
+    void *slab = MAP_FAILED;
+    if (pool->useHugePages && MAP_HUGETLB != 0) {
+        size_t hugeSlabSize = (slabSize + PSA_TCP_HUGE_PAGE_SIZE - 1) & ~((size_t) PSA_TCP_HUGE_PAGE_SIZE - 1);
+        slab = mmap(NULL, hugeSlabSize, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+        if (slab != MAP_FAILED) {
+            slabSize = hugeSlabSize;
+        }
+    }
+    if (slab == MAP_FAILED) {
+        slab = mmap(NULL, slabSize, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    }
+    if (slab == MAP_FAILED) {
+        return;
+    }
+    sizeClass->freeBuffers = malloc(pool->maxNofBuffers * sizeof(*sizeClass->freeBuffers));
+    if (sizeClass->freeBuffers == NULL) {
+        munmap(slab, slabSize);
+        return;
+    }
+    sizeClass->slab = slab;
+    sizeClass->slabSize = slabSize;
+    for (unsigned int i = 0; i < pool->maxNofBuffers; ++i) {
+        sizeClass->freeBuffers[i] = sizeClass->slab + (pool->maxNofBuffers - 1 - i) * sizeClass->bufferSize;
+    }
+    sizeClass->nrOfFreeBuffers = pool->maxNofBuffers;
+}
+
+char* pubsub_tcpBufferPool_acquire(pubsub_tcp_buffer_pool_t *pool, unsigned int size, unsigned int *bufferSize) {
+    pubsub_tcp_size_class_t *sizeClass = pubsub_tcpBufferPool_sizeClass(pool, size);
+    if (sizeClass == NULL || sizeClass->bufferSize > UINT32_MAX) {
+        *bufferSize = size;
+        return malloc(size > 0 ? size : 1);
+    }
+    char *buffer = NULL;
+    celixThreadMutex_lock(&pool->mutex);
+    if (sizeClass->slab == NULL) {
+        pubsub_tcpBufferPool_createSlab(pool, sizeClass);
+    }
+    if (sizeClass->nrOfFreeBuffers > 0) {
+        buffer = sizeClass->freeBuffers[--sizeClass->nrOfFreeBuffers];
+    }
+    celixThreadMutex_unlock(&pool->mutex);
+    if (buffer == NULL) {
+        // slab exhausted, a size class buffer is allocated so it can still grow without reallocation
+        buffer = malloc(sizeClass->bufferSize);
+    }
+    *bufferSize = buffer != NULL ? (unsigned int) sizeClass->bufferSize : 0;
+    return buffer;
+}
+
+void pubsub_tcpBufferPool_release(pubsub_tcp_buffer_pool_t *pool, char *buffer, unsigned int bufferSize) {
+    if (buffer == NULL) {
+        return;
+    }
+    pubsub_tcp_size_class_t *sizeClass = pubsub_tcpBufferPool_sizeClass(pool, bufferSize);
+    bool pooled = false;
+    if (sizeClass != NULL) {
+        celixThreadMutex_lock(&pool->mutex);
+        if (sizeClass->slab != NULL && buffer >= sizeClass->slab && buffer < sizeClass->slab + sizeClass->bufferSize * pool->maxNofBuffers) {
+            sizeClass->freeBuffers[sizeClass->nrOfFreeBuffers++] = buffer;
+            pooled = true;
+        }
+        celixThreadMutex_unlock(&pool->mutex);
+    }
+    if (!pooled) {
+        free(buffer);
+    }
+}
@@ -0,0 +1,50 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *  KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+
+#ifndef CELIX_PUBSUB_TCP_BUFFER_POOL_H
+#define CELIX_PUBSUB_TCP_BUFFER_POOL_H
+
+#include <stdbool.h>
+
+/**
+ * Pool of receive buffers shared by the connections of a tcp handler.
+ * The buffers are divided in size classes (the min buffer size times a power of 2). The buffers of a size class are
+ * carved from a single slab of maxNofBuffers buffers, which is mapped when the size class is first used (optionally
+ * backed by huge pages). When the slab of a size class is exhausted, or for buffers larger than the largest size
+ * class, the buffers are allocated and freed per use, so the pooled memory stays bounded.
+ * The pool is thread safe.
+ */
+typedef struct pubsub_tcp_buffer_pool pubsub_tcp_buffer_pool_t;
+
+pubsub_tcp_buffer_pool_t* pubsub_tcpBufferPool_create(unsigned int minBufferSize, unsigned int maxNofBuffers, bool useHugePages);
+void pubsub_tcpBufferPool_destroy(pubsub_tcp_buffer_pool_t *pool);
+
+/**
+ * Loans a buffer of at least size bytes. The actual size of the buffer is returned in bufferSize.
+ * Returns NULL if no memory is available.
+ */
+char* pubsub_tcpBufferPool_acquire(pubsub_tcp_buffer_pool_t *pool, unsigned int size, unsigned int *bufferSize);
+
+/**
+ * Returns a loaned buffer with its actual size. A buffer not loaned from the pool (malloc'd) is freed.
+ */
+void pubsub_tcpBufferPool_release(pubsub_tcp_buffer_pool_t *pool, char *buffer, unsigned int bufferSize);
+
+#endif //CELIX_PUBSUB_TCP_BUFFER_POOL_H
@@ -24,9 +24,12 @@
 #include <string.h>
 #include <stdio.h>
 #include <stdint.h>
+#include <stdlib.h>
 #include <unistd.h>
 
 #include "pubsub_psa_tcp_constants.h"
+#include "pubsub_constants.h"
+#include "pubsub_utils.h"
 
 bool psa_tcp_checkVersion(version_pt msgVersion, const pubsub_tcp_msg_header_t *hdr) {
     bool check=false;
@@ -48,6 +51,25 @@ bool psa_tcp_checkVersion(version_pt msgVersion, const pubsub_tcp_msg_header_t *
     return check;
 }
 
+bool psa_tcp_isOlderMinorVersion(version_pt msgVersion, const pubsub_tcp_msg_header_t *hdr) {
+    int major = 0;
+    int minor = 0;
+    if (msgVersion == NULL || (hdr->major == 0 && hdr->minor == 0)) {
+        return false;
+    }
+    version_getMajor(msgVersion, &major);
+    version_getMinor(msgVersion, &minor);
+    return hdr->major == (unsigned char)major && hdr->minor < (unsigned char)minor;
+}
+
+uint32_t psa_tcp_topicId(const char *scope, const char *topic) {
+    char *scopeAndTopic = NULL;
+    asprintf(&scopeAndTopic, "%s/%s", scope == NULL ? "" : scope, topic);
+    uint32_t topicId = scopeAndTopic != NULL ? utils_stringHash(scopeAndTopic) : 0;
+    free(scopeAndTopic);
+    return topicId != 0 ? topicId : 1; //note 0 is used for not multiplexed msgs
+}
+
 void psa_tcp_setScopeAndTopicFilter(const char* scope, const char *topic, char *filter) {
     for (int i = 0; i < 5; ++i) {
         filter[i] = '\0';
@@ -105,38 +127,10 @@ static int writeLong(unsigned char *data, int offset, int64_t val) {
 #endif
 
 void psa_tcp_setupTcpContext(log_helper_t *logHelper, celix_thread_t *thread, const celix_properties_t *topicProperties) {
-  //NOTE. TCP will abort when performing a sched_setscheduler without permission.
-  //As result permission has to be checked first.
-  //TODO update this to use cap_get_pid and cap-get_flag instead of check user is root (note adds dep to -lcap)
-  bool gotPermission = false;
-  if (getuid() == 0) {
-      gotPermission = true;
-  }
-
-  long prio = celix_properties_getAsLong(topicProperties, PUBSUB_TCP_THREAD_REALTIME_PRIO, -1L);
-  const char *sched = celix_properties_get(topicProperties, PUBSUB_TCP_THREAD_REALTIME_SCHED, NULL);
-  if (sched != NULL) {
-      int policy = SCHED_OTHER;
-      if (strncmp("SCHED_OTHER", sched, 16) == 0) {
-          policy = SCHED_OTHER;
-      } else if (strncmp("SCHED_BATCH", sched, 16) == 0) {
-          policy = SCHED_BATCH;
-      } else if (strncmp("SCHED_IDLE", sched, 16) == 0) {
-          policy = SCHED_IDLE;
-      } else if (strncmp("SCHED_FIFO", sched, 16) == 0) {
-          policy = SCHED_FIFO;
-      } else if (strncmp("SCHED_RR", sched, 16) == 0) {
-          policy = SCHED_RR;
-      }
-      if (gotPermission) {
-          if (prio > 0 && prio < 100) {
-              struct sched_param sch;
-              bzero(&sch, sizeof(struct sched_param));
-              sch.sched_priority = prio;
-              pthread_setschedparam(thread->thread, policy, &sch);
-          } else {
-              logHelper_log(logHelper, OSGI_LOGSERVICE_INFO, "Skipping configuration of thread prio to %i and thread scheduling to %s. No permission\n", (int) prio, sched);
-          }
-      }
-  }
+    celix_status_t status = pubsub_utils_setupThread(thread, topicProperties);
+    if (status != CELIX_SUCCESS) {
+        logHelper_log(logHelper, OSGI_LOGSERVICE_WARNING, "Cannot configure the thread scheduling (%s) and cpu affinity (%s) of the topic. Error %i",
+                      celix_properties_get(topicProperties, PUBSUB_THREAD_REALTIME_SCHED_KEY, "default"),
+                      celix_properties_get(topicProperties, PUBSUB_THREAD_CPU_AFFINITY_KEY, "all"), status);
+    }
 }
@@ -47,7 +47,17 @@ typedef struct pubsub_tcp_endPointStore{
 
 
 void psa_tcp_setScopeAndTopicFilter(const char* scope, const char *topic, char *filter);
+/**
+ * Returns the (non zero) id of the scope/topic used on multiplexed connections.
+ */
+uint32_t psa_tcp_topicId(const char *scope, const char *topic);
 bool psa_tcp_checkVersion(version_pt msgVersion, const pubsub_tcp_msg_header_t *hdr);
+
+/**
+ * Returns true if the msg is written with an older minor version of the same major version, which the
+ * deserializeVersion of a msg serializer can convert to msgVersion.
+ */
+bool psa_tcp_isOlderMinorVersion(version_pt msgVersion, const pubsub_tcp_msg_header_t *hdr);
 void psa_tcp_setupTcpContext(log_helper_t *logHelper, celix_thread_t *thread, const celix_properties_t *topicProperties);
 
 #endif //CELIX_PUBSUB_TCP_COMMON_H
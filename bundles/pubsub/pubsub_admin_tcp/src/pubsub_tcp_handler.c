@@ -39,22 +39,26 @@
 #include <fcntl.h>
 #include <arpa/inet.h>
 #include <netinet/tcp.h>
+#include <poll.h>
 #include "hash_map.h"
+#include "celix_hash_map.h"
 #include "utils.h"
 #include "pubsub_tcp_handler.h"
+#include "pubsub_tcp_uring.h"
+#include "pubsub_tcp_buffer_pool.h"
 
 #define IP_HEADER_SIZE  20
 #define TCP_HEADER_SIZE 20
 #define MAX_EPOLL_EVENTS   64
 #define MAX_MSG_VECTOR_LEN 64
 #define MAX_DEFAULT_BUFFER_SIZE 4u
-
-
-#define READ_STATE_INIT   0u
-#define READ_STATE_HEADER 1u
-#define READ_STATE_DATA   2u
-#define READ_STATE_READY  3u
-#define READ_STATE_FIND_HEADER 4u
+#define MAX_DEFAULT_SEND_QUEUE_SIZE (4u * 1024u * 1024u)
+#define URING_ENTRIES 256
+#define URING_NOF_BUFFERS 128
+#define URING_BUFFER_SIZE (16u * 1024u)
+#define URING_ZERO_COPY_MIN_SIZE (64u * 1024u)
+#define URING_EPOLL_USER_DATA UINT64_MAX
+#define URING_GENERATION_MASK 0xFFFFFFu
 
 #define L_DEBUG(...) \
     logHelper_log(handle->logHelper, OSGI_LOGSERVICE_DEBUG, __VA_ARGS__)
@@ -66,21 +70,76 @@
     logHelper_log(handle->logHelper, OSGI_LOGSERVICE_ERROR, __VA_ARGS__)
 
 
+//
+// Small set of topic ids, only changed on (un)subscribe.
+//
+typedef struct psa_tcp_topic_ids {
+    uint32_t *ids;
+    size_t size;
+} psa_tcp_topic_ids_t;
+
 typedef struct psa_tcp_connection_entry {
     char *url;
     int fd;
+    int efd; //epoll fd of the handler thread which owns the connection
     struct sockaddr_in addr;
     socklen_t len;
     bool connected;
     unsigned int bufferSize;
     char *buffer;
-    int bufferReadSize;
-    int expectedReadSize;
-    int readState;
+    unsigned int bufferReadSize; //nr of received bytes in the buffer, can be multiple and partial messages
+    bool markerError; //true while looking for a valid header after a header marker error
     pubsub_tcp_msg_header_t header;
 
+    //send queue, the bytes which could not be written without blocking. Written when the socket is writable (EPOLLOUT)
+    char *sendBuffer;
+    size_t sendBufferSize;
+    size_t sendStart;
+    size_t sendEnd;
+    size_t *sendMsgSizes; //circular buffer with the sizes of the queued msgs, needed to drop complete msgs
+    size_t sendMsgCapacity;
+    size_t sendMsgFirst;
+    size_t sendMsgCount;
+    bool sendHeadPartial; //true if the first queued msg is partially written
+    bool lastValuesSent; //true if the last value cache is written (or queued) to the connection
+
+    //io_uring receive, only used by the handler thread
+    bool recvArmed; //true while a multishot recv is pending for the connection
+    unsigned int recvGeneration; //distinguishes the recv completions of a reused fd
+
+    //multiplexed connections, protected by writeMutex
+    psa_tcp_topic_ids_t peerTopicIds; //topics subscribed by the peer, only the msgs of these topics are written
+    psa_tcp_topic_ids_t localTopicIds; //topics subscribed through this (connected) connection
 } psa_tcp_connection_entry_t;
 
+//
+// Receiver of the msgs of a topic on a multiplexed handler.
+//
+typedef struct psa_tcp_topic_handler {
+    void *payload;
+    pubsub_tcpHandler_processMessage_callback_t processMessageCallback;
+    pubsub_tcpHandler_connectMessage_callback_t connectMessageCallback;
+    pubsub_tcpHandler_connectMessage_callback_t disconnectMessageCallback;
+} psa_tcp_topic_handler_t;
+
+//
+// Additional handler thread, with its own epoll fd and (when SO_REUSEPORT is used) its own listener.
+// The first handler thread is the thread calling pubsub_tcpHandler_handler.
+//
+typedef struct psa_tcp_handler_worker {
+    pubsub_tcpHandler_t *handle;
+    int efd;
+    int listenFd; //SO_REUSEPORT listener of the worker, -1 if not used
+    celix_thread_t thread;
+} psa_tcp_handler_worker_t;
+
+typedef struct psa_tcp_last_value {
+    pubsub_tcp_msg_header_t header;
+    uint32_t key; //hash of the key field of the msg, 0 if the cache is not keyed
+    char *buffer;
+    unsigned int size;
+} psa_tcp_last_value_t;
+
 struct pubsub_tcpHandler {
   unsigned int readSeqNr;
   unsigned int msgIdOffset;
@@ -89,6 +148,16 @@ struct pubsub_tcpHandler {
   bool useBlockingWrite;
   bool useBlockingRead;
   celix_thread_rwlock_t dbLock;
+  celix_thread_mutex_t writeMutex; //protects the send queues of the connections
+  celix_thread_mutex_t readMutex; //protects the receive buffers of the connections and serializes the msg callbacks
+  size_t maxSendQueueSize;
+  pubsub_send_queue_policy_e sendQueuePolicy;
+  size_t maxQueuedBytes; //highest nr of queued bytes of a single connection
+  psa_tcp_last_value_t *lastValues; //last written msg per (msg type, key), protected by writeMutex
+  celix_long_hash_map_t *lastValueIndex; //key = msg type << 32 | key, value = index + 1 in lastValues. Protected by writeMutex
+  size_t nrOfLastValues;
+  size_t maxLastValues;
+  unsigned long nrOfDroppedMsgs;
   unsigned int timeout;
   hash_map_t *url_map;
   hash_map_t *fd_map;
@@ -101,7 +170,21 @@ struct pubsub_tcpHandler {
   log_helper_t *logHelper;
   unsigned int bufferSize;
   unsigned int maxNofBuffer;
+  bool useHugePages; //back the receive buffer pool with huge pages
+  pubsub_tcp_buffer_pool_t *bufferPool; //receive buffers loaned by the connections with unprocessed data, NULL if no receive buffer store is created
   psa_tcp_connection_entry_t own;
+  pubsub_tcp_uring_t *ring; //io_uring for receiving, NULL when epoll is used
+  pubsub_tcp_uring_t *sendRing; //io_uring for zero copy sends, NULL when not used
+  bool pollArmed; //true while a poll for the epoll fd is pending on the ring
+  bool armRecv; //true if there are connections without a pending recv
+  unsigned int recvGeneration;
+  psa_tcp_handler_worker_t *workers; //additional handler threads
+  unsigned int nrOfWorkers;
+  unsigned int nextWorker; //round robin index for new connections, 0 is the efd of the handle
+  bool reusePort;
+  bool workersRunning;
+  bool multiplexed; //msgs are tagged with a topic id and only written to the connections which subscribed the topic
+  celix_long_hash_map_t *topicHandlers; //key = topic id, value = psa_tcp_topic_handler_t*. Protected by dbLock
 };
 
 
@@ -110,7 +193,18 @@ static inline int pubsub_tcpHandler_closeConnectionEntry(pubsub_tcpHandler_t *ha
 static inline int pubsub_tcpHandler_closeConnection(pubsub_tcpHandler_t *handle, int fd);
 static inline int pubsub_tcpHandler_makeNonBlocking(pubsub_tcpHandler_t *handle, int fd);
 static inline void pubsub_tcpHandler_setupEntry(psa_tcp_connection_entry_t* entry, int fd, char *url, unsigned int bufferSize);
-static inline void pubsub_tcpHandler_freeEntry(psa_tcp_connection_entry_t* entry);
+static inline void pubsub_tcpHandler_freeEntry(pubsub_tcpHandler_t *handle, psa_tcp_connection_entry_t* entry);
+static inline int pubsub_tcpHandler_readAvailable(pubsub_tcpHandler_t *handle, int fd);
+static inline void pubsub_tcpHandler_writeAvailable(pubsub_tcpHandler_t *handle, int fd);
+static inline int pubsub_tcpHandler_flushQueue(pubsub_tcpHandler_t *handle, psa_tcp_connection_entry_t *entry);
+static inline int pubsub_tcpHandler_processEpollEvents(pubsub_tcpHandler_t *handle, int efd, int listenFd, struct epoll_event *events, int nof_events);
+static void pubsub_tcpHandler_stopWorkers(pubsub_tcpHandler_t *handle);
+static void pubsub_tcpHandler_notifyTopicHandlers(pubsub_tcpHandler_t *handle, psa_tcp_connection_entry_t *entry, bool connected, bool lock);
+static void pubsub_tcpHandler_processControlMsg(pubsub_tcpHandler_t *handle, psa_tcp_connection_entry_t *entry, const pubsub_tcp_msg_header_t *header);
+
+static inline long pubsub_tcpHandler_lastValueKey(const pubsub_tcp_msg_header_t *header, uint32_t key) {
+    return (long) (((uint64_t) (uint32_t) header->type << 32u) | key);
+}
 
 
 //
@@ -122,16 +216,22 @@ pubsub_tcpHandler_t *pubsub_tcpHandler_create(log_helper_t *logHelper) {
         handle->efd = epoll_create1(0);
         handle->url_map = hashMap_create(utils_stringHash, NULL, utils_stringEquals, NULL);
         handle->fd_map = hashMap_create(NULL, NULL, NULL, NULL);
+        handle->topicHandlers = celix_longHashMap_create();
+        handle->lastValueIndex = celix_longHashMap_create();
         handle->timeout = 2000; // default 2 sec
         handle->logHelper = logHelper;
         handle->msgIdOffset = 0;
         handle->msgIdSize = 4;
         handle->bypassHeader = false;
         handle->bufferSize = MAX_DEFAULT_BUFFER_SIZE;
-        handle->maxNofBuffer = 1; // Reserved for future Use;
+        handle->maxNofBuffer = 1;
         handle->useBlockingWrite = true;
+        handle->maxSendQueueSize = MAX_DEFAULT_SEND_QUEUE_SIZE;
+        handle->sendQueuePolicy = PUBSUB_SEND_QUEUE_POLICY_DROP_NEWEST_TYPE;
         pubsub_tcpHandler_setupEntry(&handle->own, -1, NULL, MAX_DEFAULT_BUFFER_SIZE);
-        celixThreadRwlock_create(&handle->dbLock, 0);
+        celixThreadRwlock_createNamed(&handle->dbLock, 0, "tcp handler db");
+        celixThreadMutex_create(&handle->writeMutex, NULL);
+        celixThreadMutex_create(&handle->readMutex, NULL);
         //signal(SIGPIPE, SIG_IGN);
     }
     return handle;
@@ -144,6 +244,7 @@ pubsub_tcpHandler_t *pubsub_tcpHandler_create(log_helper_t *logHelper) {
 void pubsub_tcpHandler_destroy(pubsub_tcpHandler_t *handle) {
     printf("### Destroying BufferHandler TCP\n");
     if (handle != NULL) {
+        pubsub_tcpHandler_stopWorkers(handle);
         celixThreadRwlock_writeLock(&handle->dbLock);
         pubsub_tcpHandler_close(handle);
         hash_map_iterator_t iter = hashMapIterator_construct(handle->url_map);
@@ -155,11 +256,29 @@ void pubsub_tcpHandler_destroy(pubsub_tcpHandler_t *handle) {
         }
 
         if (handle->efd >= 0) close(handle->efd);
-        pubsub_tcpHandler_freeEntry(&handle->own);
+        for (unsigned int i = 0; i < handle->nrOfWorkers; i++) {
+            if (handle->workers[i].efd >= 0) close(handle->workers[i].efd);
+        }
+        free(handle->workers);
+        pubsub_tcpHandler_freeEntry(handle, &handle->own);
+        pubsub_tcpBufferPool_destroy(handle->bufferPool);
+        pubsub_tcpUring_destroy(handle->ring);
+        pubsub_tcpUring_destroy(handle->sendRing);
         hashMap_destroy(handle->url_map, false, false);
         hashMap_destroy(handle->fd_map, false, false);
+        for (celix_long_hash_map_iterator_t iter2 = celix_longHashMap_begin(handle->topicHandlers); !celix_longHashMapIterator_isEnd(&iter2); celix_longHashMapIterator_next(&iter2)) {
+            free(iter2.value);
+        }
+        celix_longHashMap_destroy(handle->topicHandlers);
         celixThreadRwlock_unlock(&handle->dbLock);
         celixThreadRwlock_destroy(&handle->dbLock);
+        celixThreadMutex_destroy(&handle->writeMutex);
+        celixThreadMutex_destroy(&handle->readMutex);
+        for (size_t i = 0; i < handle->nrOfLastValues; i++) {
+            free(handle->lastValues[i].buffer);
+        }
+        free(handle->lastValues);
+        celix_longHashMap_destroy(handle->lastValueIndex);
         free(handle);
     }
 }
@@ -179,6 +298,13 @@ int pubsub_tcpHandler_open(pubsub_tcpHandler_t *handle, char *url) {
                 L_ERROR("[TCP Socket] Error setsockopt(SO_REUSEADDR): %s\n", strerror(errno));
             }
         }
+        if ((rc == 0) && (url != NULL) && handle->reusePort) {
+            rc = setsockopt(fd, SOL_SOCKET, SO_REUSEPORT, &setting, sizeof(setting));
+            if (rc != 0) {
+                close(fd);
+                L_ERROR("[TCP Socket] Error setsockopt(SO_REUSEPORT): %s\n", strerror(errno));
+            }
+        }
         if (rc == 0) {
             rc = setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &setting, sizeof(setting));
             if (rc != 0) {
@@ -220,7 +346,15 @@ int pubsub_tcpHandler_close(pubsub_tcpHandler_t *handle) {
                 L_ERROR("[PSA TCP] Error disconnecting %s\n", strerror(errno));
             }
         }
-        pubsub_tcpHandler_freeEntry(&handle->own);
+        for (unsigned int i = 0; i < handle->nrOfWorkers; i++) {
+            psa_tcp_handler_worker_t *worker = &handle->workers[i];
+            if (worker->listenFd >= 0) {
+                epoll_ctl(worker->efd, EPOLL_CTL_DEL, worker->listenFd, NULL);
+                close(worker->listenFd);
+                worker->listenFd = -1;
+            }
+        }
+        pubsub_tcpHandler_freeEntry(handle, &handle->own);
         celixThreadRwlock_unlock(&handle->dbLock);
     }
     return rc;
@@ -239,7 +373,7 @@ void pubsub_tcpHandler_setupEntry(psa_tcp_connection_entry_t* entry, int fd, cha
 }
 
 static inline
-void pubsub_tcpHandler_freeEntry(psa_tcp_connection_entry_t* entry) {
+void pubsub_tcpHandler_freeEntry(pubsub_tcpHandler_t *handle, psa_tcp_connection_entry_t* entry) {
     if (entry->url) {
         free(entry->url);
         entry->url = NULL;
@@ -249,13 +383,45 @@ void pubsub_tcpHandler_freeEntry(psa_tcp_connection_entry_t* entry) {
         entry->fd = -1;
     }
     if (entry->buffer) {
-        free(entry->buffer);
+        if (handle->bufferPool != NULL) pubsub_tcpBufferPool_release(handle->bufferPool, entry->buffer, entry->bufferSize);
+        else free(entry->buffer);
         entry->buffer = NULL;
         entry->bufferSize = 0;
     }
+    entry->bufferReadSize = 0;
+    if (entry->sendBuffer) {
+        free(entry->sendBuffer);
+        entry->sendBuffer = NULL;
+        entry->sendBufferSize = 0;
+    }
+    entry->sendStart = 0;
+    entry->sendEnd = 0;
+    free(entry->sendMsgSizes);
+    entry->sendMsgSizes = NULL;
+    entry->sendMsgCapacity = 0;
+    entry->sendMsgFirst = 0;
+    entry->sendMsgCount = 0;
+    entry->sendHeadPartial = false;
+    entry->lastValuesSent = false;
+    free(entry->peerTopicIds.ids);
+    free(entry->localTopicIds.ids);
+    memset(&entry->peerTopicIds, 0, sizeof(entry->peerTopicIds));
+    memset(&entry->localTopicIds, 0, sizeof(entry->localTopicIds));
     entry->connected = false;
 }
 
+//
+// Returns the epoll fd of the handler thread for a new connection, the connections are divided round robin.
+//
+static inline int pubsub_tcpHandler_nextEpollFd(pubsub_tcpHandler_t *handle) {
+    int efd = handle->efd;
+    if (handle->nrOfWorkers > 0) {
+        unsigned int index = __atomic_fetch_add(&handle->nextWorker, 1, __ATOMIC_RELAXED) % (handle->nrOfWorkers + 1);
+        if (index > 0) efd = handle->workers[index - 1].efd;
+    }
+    return efd;
+}
+
 int pubsub_tcpHandler_connect(pubsub_tcpHandler_t *handle, char *url) {
     int rc = 0;
     psa_tcp_connection_entry_t *entry = hashMap_get(handle->url_map, (void *) (intptr_t) url);
@@ -289,7 +455,7 @@ int pubsub_tcpHandler_connect(pubsub_tcpHandler_t *handle, char *url) {
                 struct sockaddr_in sin;
                 socklen_t len = sizeof(sin);
                 entry = calloc(1, sizeof(*entry));
-                pubsub_tcpHandler_setupEntry(entry, fd, url, handle->bufferSize);
+                pubsub_tcpHandler_setupEntry(entry, fd, url, 0); //note the receive buffer is loaned on the first read
                 entry->connected = false; // Wait till epoll event, to report connected.
                 rc = getsockname(fd, (struct sockaddr *) &sin, &len);
                 if (rc < 0) {
@@ -306,11 +472,13 @@ int pubsub_tcpHandler_connect(pubsub_tcpHandler_t *handle, char *url) {
         if ((rc >= 0) && (entry)) {
             struct epoll_event event;
             bzero(&event, sizeof(struct epoll_event)); // zero the struct
-            event.events = EPOLLIN | EPOLLRDHUP | EPOLLERR | EPOLLOUT;
+            event.events = EPOLLRDHUP | EPOLLERR | EPOLLOUT;
+            if (handle->ring == NULL) event.events |= EPOLLIN;
             event.data.fd = entry->fd;
-            rc = epoll_ctl(handle->efd, EPOLL_CTL_ADD, entry->fd, &event);
+            entry->efd = pubsub_tcpHandler_nextEpollFd(handle);
+            rc = epoll_ctl(entry->efd, EPOLL_CTL_ADD, entry->fd, &event);
             if (rc < 0) {
-                pubsub_tcpHandler_freeEntry(entry);
+                pubsub_tcpHandler_freeEntry(handle, entry);
                 free(entry);
                 L_ERROR("[TCP Socket] Cannot create epoll %s\n", strerror(errno));
                 errno = 0;
@@ -321,6 +489,7 @@ int pubsub_tcpHandler_connect(pubsub_tcpHandler_t *handle, char *url) {
             celixThreadRwlock_writeLock(&handle->dbLock);
             hashMap_put(handle->url_map, entry->url, entry);
             hashMap_put(handle->fd_map, (void *) (intptr_t) entry->fd, entry);
+            handle->armRecv = true;
             celixThreadRwlock_unlock(&handle->dbLock);
         }
         pubsub_tcpHandler_free_setUrlInfo(&url_info);
@@ -349,19 +518,23 @@ static inline int pubsub_tcpHandler_closeConnectionEntry(pubsub_tcpHandler_t *ha
     if (handle != NULL && entry != NULL) {
         fprintf(stdout, "[TCP Socket] Close connection to url: %s: \n", entry->url);
         hashMap_remove(handle->fd_map, (void *) (intptr_t) entry->fd);
-        if ((handle->efd >= 0)) {
+        if ((entry->efd >= 0)) {
             struct epoll_event event;
             bzero(&event, sizeof(struct epoll_event)); // zero the struct
-            rc = epoll_ctl(handle->efd, EPOLL_CTL_DEL, entry->fd, &event);
+            rc = epoll_ctl(entry->efd, EPOLL_CTL_DEL, entry->fd, &event);
             if (rc < 0) {
                 L_ERROR("[PSA TCP] Error disconnecting %s\n", strerror(errno));
                 errno = 0;
             }
         }
         if (entry->fd >= 0) {
-            if (handle->disconnectMessageCallback)
+            // A pending io_uring recv keeps the socket open, the shutdown completes the recv
+            if (handle->ring != NULL) shutdown(entry->fd, SHUT_RDWR);
+            if (handle->multiplexed)
+                pubsub_tcpHandler_notifyTopicHandlers(handle, entry, false, lock);
+            else if (handle->disconnectMessageCallback)
                 handle->disconnectMessageCallback(handle->connectPayload, entry->url, lock);
-            pubsub_tcpHandler_freeEntry(entry);
+            pubsub_tcpHandler_freeEntry(handle, entry);
             free(entry);
         }
     }
@@ -378,6 +551,7 @@ static inline int pubsub_tcpHandler_closeConnection(pubsub_tcpHandler_t *handle,
         psa_tcp_connection_entry_t *entry = NULL;
         celixThreadRwlock_readLock(&handle->dbLock);
         if (fd != handle->own.fd) {
+            // note a SO_REUSEPORT listener of a worker is never in the fd_map
             entry = hashMap_get(handle->fd_map, (void *) (intptr_t) fd);
         } else {
             use_handle_fd = true;
@@ -410,6 +584,40 @@ int pubsub_tcpHandler_makeNonBlocking(pubsub_tcpHandler_t *handle, int fd) {
   return rc;
 }
 
+//
+// Creates a SO_REUSEPORT listener for every worker, so the kernel divides the new connections over the
+// handler threads. A worker without a listener only handles the connections made by pubsub_tcpHandler_connect.
+//
+static void pubsub_tcpHandler_listenWorkers(pubsub_tcpHandler_t *handle, char *url) {
+    for (unsigned int i = 0; i < handle->nrOfWorkers; i++) {
+        int fd = pubsub_tcpHandler_open(handle, url);
+        int rc = fd;
+        if (rc >= 0) {
+            rc = listen(fd, SOMAXCONN);
+        }
+        if (rc >= 0) {
+            rc = pubsub_tcpHandler_makeNonBlocking(handle, fd);
+        }
+        celixThreadRwlock_writeLock(&handle->dbLock);
+        psa_tcp_handler_worker_t *worker = &handle->workers[i];
+        if (rc >= 0) {
+            struct epoll_event event;
+            bzero(&event, sizeof(event)); // zero the struct
+            event.events = EPOLLIN | EPOLLRDHUP | EPOLLERR;
+            event.data.fd = fd;
+            rc = epoll_ctl(worker->efd, EPOLL_CTL_ADD, fd, &event);
+        }
+        if (rc >= 0) {
+            worker->listenFd = fd;
+        } else {
+            L_WARN("[TCP Socket] Cannot create SO_REUSEPORT listener for handler thread %u: %s\n", i + 1, strerror(errno));
+            errno = 0;
+            if (fd >= 0) close(fd);
+        }
+        celixThreadRwlock_unlock(&handle->dbLock);
+    }
+}
+
 int pubsub_tcpHandler_listen(pubsub_tcpHandler_t *handle, char *url) {
     int fd = pubsub_tcpHandler_open(handle, url);
     // Make handler fd entry
@@ -420,14 +628,14 @@ int pubsub_tcpHandler_listen(pubsub_tcpHandler_t *handle, char *url) {
         rc = listen(fd, SOMAXCONN);
         if (rc != 0) {
             L_ERROR("[TCP Socket] Error listen: %s\n", strerror(errno));
-            pubsub_tcpHandler_freeEntry(&handle->own);
+            pubsub_tcpHandler_freeEntry(handle, &handle->own);
             errno = 0;
         }
     }
     if (rc >= 0) {
         rc = pubsub_tcpHandler_makeNonBlocking(handle, fd);
         if (rc < 0) {
-            pubsub_tcpHandler_freeEntry(&handle->own);
+            pubsub_tcpHandler_freeEntry(handle, &handle->own);
         }
     }
 
@@ -443,6 +651,9 @@ int pubsub_tcpHandler_listen(pubsub_tcpHandler_t *handle, char *url) {
         }
     }
     celixThreadRwlock_unlock(&handle->dbLock);
+    if ((rc >= 0) && handle->reusePort) {
+        pubsub_tcpHandler_listenWorkers(handle, url);
+    }
     return rc;
 }
 
@@ -511,15 +722,73 @@ void pubsub_tcpHandler_free_setUrlInfo(pubsub_tcpHandler_url_t *url_info) {
 
 
 int pubsub_tcpHandler_createReceiveBufferStore(pubsub_tcpHandler_t *handle,
-                                               unsigned int maxNofBuffers __attribute__ ((__unused__)),
+                                               unsigned int maxNofBuffers,
                                                unsigned int bufferSize) {
+    int rc = 0;
     if (handle != NULL) {
         celixThreadRwlock_writeLock(&handle->dbLock);
-        handle->bufferSize = bufferSize;
-        handle->maxNofBuffer = maxNofBuffers;
+        // The buffers of an existing pool can be loaned by the connections, so the pool is only created once
+        if (handle->bufferPool == NULL) {
+            handle->bufferSize = bufferSize;
+            handle->maxNofBuffer = maxNofBuffers;
+            handle->bufferPool = pubsub_tcpBufferPool_create(bufferSize, maxNofBuffers, handle->useHugePages);
+        } else {
+            rc = -1;
+        }
         celixThreadRwlock_unlock(&handle->dbLock);
     }
-    return 0;
+    return rc;
+}
+
+void pubsub_tcpHandler_setReceiveBufferHugePages(pubsub_tcpHandler_t *handle, bool useHugePages) {
+    if (handle != NULL) {
+        celixThreadRwlock_writeLock(&handle->dbLock);
+        handle->useHugePages = useHugePages;
+        celixThreadRwlock_unlock(&handle->dbLock);
+    }
+}
+
+//
+// Ensures the receive buffer of the connection can hold size bytes. With a buffer pool a larger buffer is loaned and
+// the received data is moved to it, otherwise the buffer is reallocated.
+//
+static bool pubsub_tcpHandler_reserveReceiveBuffer(pubsub_tcpHandler_t *handle, psa_tcp_connection_entry_t *entry, unsigned int size) {
+    if (size <= entry->bufferSize && entry->buffer != NULL) {
+        return true;
+    }
+    if (handle->bufferPool == NULL) {
+        char *buffer = realloc(entry->buffer, (size_t) size);
+        if (buffer == NULL) {
+            return false;
+        }
+        entry->buffer = buffer;
+        entry->bufferSize = size;
+        return true;
+    }
+    unsigned int bufferSize = 0;
+    char *buffer = pubsub_tcpBufferPool_acquire(handle->bufferPool, size, &bufferSize);
+    if (buffer == NULL) {
+        return false;
+    }
+    if (entry->buffer != NULL) {
+        memcpy(buffer, entry->buffer, entry->bufferReadSize);
+        pubsub_tcpBufferPool_release(handle->bufferPool, entry->buffer, entry->bufferSize);
+    }
+    entry->buffer = buffer;
+    entry->bufferSize = bufferSize;
+    return true;
+}
+
+//
+// Returns the receive buffer of the connection to the pool when all received data is processed, so idle connections
+// do not hold a buffer.
+//
+static inline void pubsub_tcpHandler_returnReceiveBuffer(pubsub_tcpHandler_t *handle, psa_tcp_connection_entry_t *entry) {
+    if (handle->bufferPool != NULL && entry->buffer != NULL && entry->bufferReadSize == 0) {
+        pubsub_tcpBufferPool_release(handle->bufferPool, entry->buffer, entry->bufferSize);
+        entry->buffer = NULL;
+        entry->bufferSize = 0;
+    }
 }
 
 
@@ -557,167 +826,223 @@ void pubsub_tcpHandler_setBlockingRead(pubsub_tcpHandler_t *handle, bool blockin
     }
 }
 
-//
-// Reads data from the filedescriptor which has date (determined by epoll()) and stores it in the internal structure
-// If the message is completely reassembled true is returned and the index and size have valid values
-//
-int pubsub_tcpHandler_dataAvailable(pubsub_tcpHandler_t *handle, int fd, unsigned int *index, unsigned int *size) {
-    celixThreadRwlock_writeLock(&handle->dbLock);
-    *index = 0;
-    *size = 0;
-    psa_tcp_connection_entry_t *entry = NULL;
-    if (fd == handle->own.fd) entry = &handle->own;
-    else entry = hashMap_get(handle->fd_map, (void *) (intptr_t) fd);
-    // Find FD entry
-    if (entry == NULL) {
+void pubsub_tcpHandler_setSendQueue(pubsub_tcpHandler_t *handle, pubsub_send_queue_policy_e policy, size_t maxSize) {
+    if (handle != NULL) {
+        celixThreadRwlock_writeLock(&handle->dbLock);
+        handle->sendQueuePolicy = policy;
+        handle->maxSendQueueSize = maxSize;
         celixThreadRwlock_unlock(&handle->dbLock);
-        return -1;
     }
-    // If it's not connected return from function
-    if (!entry->connected) {
+}
+
+void pubsub_tcpHandler_setLastValueCache(pubsub_tcpHandler_t *handle, size_t maxMsgTypes) {
+    if (handle != NULL) {
+        celixThreadRwlock_writeLock(&handle->dbLock);
+        celixThreadMutex_lock(&handle->writeMutex);
+        for (size_t i = maxMsgTypes; i < handle->nrOfLastValues; i++) {
+            free(handle->lastValues[i].buffer);
+            celix_longHashMap_remove(handle->lastValueIndex, pubsub_tcpHandler_lastValueKey(&handle->lastValues[i].header, handle->lastValues[i].key));
+        }
+        if (handle->nrOfLastValues > maxMsgTypes) {
+            handle->nrOfLastValues = maxMsgTypes;
+        }
+        handle->lastValues = realloc(handle->lastValues, maxMsgTypes * sizeof(*handle->lastValues));
+        handle->maxLastValues = maxMsgTypes;
+        celixThreadMutex_unlock(&handle->writeMutex);
         celixThreadRwlock_unlock(&handle->dbLock);
-        return -1;
     }
+}
 
-    // In init state
-    if (!entry->readState) {
-        entry->bufferReadSize = 0;
-        if (!handle->bypassHeader) {
-            // First start looking for header
-            entry->readState = READ_STATE_HEADER;
-            entry->expectedReadSize = sizeof(pubsub_tcp_msg_header_t);
-            if (entry->expectedReadSize > entry->bufferSize) {
-                char* buffer = realloc(entry->buffer, (size_t )entry->expectedReadSize);
-                if (buffer) {
-                    entry->buffer = buffer;
-                    entry->bufferSize = entry->expectedReadSize;
-                    L_WARN("[TCP Socket: %d, url: %s,  realloc read buffer: (%d, %d) \n", entry->fd, entry->url,
-                           entry->bufferSize, entry->expectedReadSize);
-                }
+void pubsub_tcpHandler_sendQueueMetrics(pubsub_tcpHandler_t *handle, unsigned long *queuedBytes,
+                                        unsigned long *maxQueuedBytes, unsigned long *droppedMsgs) {
+    unsigned long queued = 0;
+    celixThreadRwlock_readLock(&handle->dbLock);
+    celixThreadMutex_lock(&handle->writeMutex);
+    hash_map_iterator_t iter = hashMapIterator_construct(handle->fd_map);
+    while (hashMapIterator_hasNext(&iter)) {
+        psa_tcp_connection_entry_t *entry = hashMapIterator_nextValue(&iter);
+        queued += entry->sendEnd - entry->sendStart;
+    }
+    *queuedBytes = queued;
+    *maxQueuedBytes = handle->maxQueuedBytes;
+    *droppedMsgs = handle->nrOfDroppedMsgs;
+    celixThreadMutex_unlock(&handle->writeMutex);
+    celixThreadRwlock_unlock(&handle->dbLock);
+}
+
+void pubsub_tcpHandler_setIoUring(pubsub_tcpHandler_t *handle, bool useIoUring) {
+    if (handle != NULL) {
+        celixThreadRwlock_writeLock(&handle->dbLock);
+        if (useIoUring && handle->ring == NULL) {
+            handle->ring = pubsub_tcpUring_create(URING_ENTRIES, URING_NOF_BUFFERS, URING_BUFFER_SIZE);
+            if (handle->ring != NULL) {
+                handle->sendRing = pubsub_tcpUring_create(8, 0, 0);
+            } else {
+                L_WARN("[TCP Socket] io_uring not available, using epoll\n");
             }
-        } else {
-            // When no header use Max buffer size
-            entry->readState = READ_STATE_READY;
-            entry->expectedReadSize = entry->bufferSize;
+        } else if (!useIoUring && handle->ring != NULL) {
+            pubsub_tcpUring_destroy(handle->ring);
+            pubsub_tcpUring_destroy(handle->sendRing);
+            handle->ring = NULL;
+            handle->sendRing = NULL;
+            handle->pollArmed = false;
         }
+        celixThreadRwlock_unlock(&handle->dbLock);
     }
-    // Read the message
-    int nbytes = recv(fd, &entry->buffer[entry->bufferReadSize], entry->expectedReadSize, 0);
-    if (nbytes < 0) {
-        // Handle Socket error, when nbytes == 0 => Connection is lost
-        if ((errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR)) {}
-        else L_ERROR("[TCP Socket] read error %s\n", strerror(errno));
-        errno = 0;
+}
+
+static inline bool pubsub_tcpHandler_containsTopicId(const psa_tcp_topic_ids_t *topicIds, uint32_t topicId) {
+    for (size_t i = 0; i < topicIds->size; i++) {
+        if (topicIds->ids[i] == topicId) {
+            return true;
+        }
     }
-    if ((!handle->bypassHeader) && (nbytes > 0)) {
-        // Update buffer administration
-        entry->bufferReadSize += nbytes;
-        entry->expectedReadSize -= nbytes;
-        // When expected data is read then update states
-        if (entry->expectedReadSize <= 0) {
-            pubsub_tcp_msg_header_t *pHeader = (pubsub_tcp_msg_header_t *) entry->buffer;
-            if (entry->readState == READ_STATE_FIND_HEADER) {
-                // When header marker is not found, start finding header
-                if (pHeader->marker_start == MARKER_START_PATTERN) {
-                    // header marker is found, then read the remaining data of the header and update to HEADER State
-                    entry->expectedReadSize = sizeof(pubsub_tcp_msg_header_t) - sizeof(unsigned int);
-                    entry->readState = READ_STATE_HEADER;
-                } else {
-                    // keep looking for the header marker
-                    entry->bufferReadSize = 0;
-                    entry->expectedReadSize = sizeof(unsigned int);
-                }
-                // Check if the header contains the correct markers
-            } else if ((pHeader->marker_start != MARKER_START_PATTERN) || (pHeader->marker_end != MARKER_END_PATTERN)) {
-                // When markers are not correct, find a new marker and update state to FIND Header
-                L_ERROR(
-                    "[TCP Socket] Read Header: Marker (%d)  start: 0x%08X != 0x%08X stop: 0x%08X != 0x%08X errno: %s",
-                    handle->readSeqNr, pHeader->marker_start, MARKER_START_PATTERN, pHeader->marker_end,
-                    MARKER_END_PATTERN, strerror(errno));
-                entry->bufferReadSize = 0;
-                entry->expectedReadSize = sizeof(unsigned int);
-                entry->readState = READ_STATE_FIND_HEADER;
-            } else if (entry->readState == READ_STATE_HEADER) {
-                // Header is found, read the data from the socket, update state to READ_STATE_DATA
-                int buffer_size = pHeader->bufferSize + entry->bufferReadSize;
-                // When buffer is not big enough, reallocate buffer
-                if ((buffer_size > entry->bufferSize) && (buffer_size)) {
-                    char* buffer = realloc(entry->buffer, (size_t )buffer_size);
-                    if (buffer) {
-                        entry->buffer = buffer;
-                        entry->bufferSize = buffer_size;
-                        L_WARN("[TCP Socket: %d, url: %s,  realloc read buffer: (%d, %d) \n", entry->fd, entry->url,
-                               entry->bufferSize, buffer_size);
-                    }
-                }
-                // Set data read size
-                entry->expectedReadSize = pHeader->bufferSize;
-                entry->readState++;
-                // The data is read, update administation and set state to READ_STATE_READY
-            } else if (entry->readState == READ_STATE_DATA) {
-                handle->readSeqNr = pHeader->seqNr;
-                //fprintf(stdout, "ReadSeqNr: Count: %d\n", handle->readSeqNr);
-                nbytes = entry->bufferReadSize - sizeof(pubsub_tcp_msg_header_t);
-                if (nbytes == 0) {
-                    errno = 0;
-                }
-                // if buffer does not contain header, reset buffer
-                if (nbytes < 0) {
-                    L_ERROR("[TCP Socket] incomplete message\n");
-                    entry->readState = READ_STATE_INIT;
-                } else {
-                    entry->readState++;
-                }
+    return false;
+}
+
+// Returns false if the topic id is already in the set
+static inline bool pubsub_tcpHandler_addTopicId(psa_tcp_topic_ids_t *topicIds, uint32_t topicId) {
+    if (pubsub_tcpHandler_containsTopicId(topicIds, topicId)) {
+        return false;
+    }
+    uint32_t *ids = realloc(topicIds->ids, (topicIds->size + 1) * sizeof(*ids));
+    if (ids == NULL) {
+        return false;
+    }
+    ids[topicIds->size++] = topicId;
+    topicIds->ids = ids;
+    return true;
+}
+
+// Returns false if the topic id is not in the set
+static inline bool pubsub_tcpHandler_removeTopicId(psa_tcp_topic_ids_t *topicIds, uint32_t topicId) {
+    for (size_t i = 0; i < topicIds->size; i++) {
+        if (topicIds->ids[i] == topicId) {
+            topicIds->ids[i] = topicIds->ids[--topicIds->size];
+            return true;
+        }
+    }
+    return false;
+}
+
+//
+// Moves the complete messages in the receive buffer of the connection to the message callback.
+// An incomplete message is moved to the front of the buffer, till the remaining data is received.
+//
+static inline void pubsub_tcpHandler_processReceiveBuffer(pubsub_tcpHandler_t *handle, psa_tcp_connection_entry_t *entry, struct timespec *receiveTime) {
+    unsigned int offset = 0;
+    unsigned int neededSize = 0;
+    while (entry->bufferReadSize - offset >= sizeof(pubsub_tcp_msg_header_t)) {
+        pubsub_tcp_msg_header_t header;
+        memcpy(&header, entry->buffer + offset, sizeof(header)); // messages in the buffer are not aligned
+        if ((header.marker_start != MARKER_START_PATTERN) || (header.marker_end != MARKER_END_PATTERN)) {
+            // When markers are not correct, look for the next header
+            if (!entry->markerError) {
+                L_ERROR("[TCP Socket] Read Header: Marker (%d)  start: 0x%08X != 0x%08X stop: 0x%08X != 0x%08X",
+                        handle->readSeqNr, header.marker_start, MARKER_START_PATTERN, header.marker_end, MARKER_END_PATTERN);
+                entry->markerError = true;
+            }
+            offset += 1;
+            continue;
+        }
+        entry->markerError = false;
+        unsigned int msgSize = sizeof(pubsub_tcp_msg_header_t) + header.bufferSize;
+        if (entry->bufferReadSize - offset < msgSize) {
+            neededSize = msgSize;
+            break;
+        }
+        handle->readSeqNr = header.seqNr;
+        if ((header.flags & (PSA_TCP_MSG_FLAG_SUBSCRIBE | PSA_TCP_MSG_FLAG_UNSUBSCRIBE)) != 0) {
+            pubsub_tcpHandler_processControlMsg(handle, entry, &header);
+        } else if (handle->multiplexed) {
+            psa_tcp_topic_handler_t *topicHandler = celix_longHashMap_get(handle->topicHandlers, (long) header.topicId);
+            if (topicHandler != NULL) {
+                topicHandler->processMessageCallback(topicHandler->payload, &header,
+                                                     (unsigned char *) entry->buffer + offset + sizeof(pubsub_tcp_msg_header_t),
+                                                     header.bufferSize, receiveTime);
             }
+        } else if (handle->processMessageCallback) {
+            handle->processMessageCallback(handle->processMessagePayload, &header,
+                                           (unsigned char *) entry->buffer + offset + sizeof(pubsub_tcp_msg_header_t),
+                                           header.bufferSize, receiveTime);
         }
+        offset += msgSize;
     }
-    if (nbytes > 0 && entry->readState == READ_STATE_READY) {
-        // if read state is not ready, don't process buffer
-        // Check if buffer size is correct
-        pubsub_tcp_msg_header_t *pHeader = (pubsub_tcp_msg_header_t *) entry->buffer;
-        if (nbytes != pHeader->bufferSize) {
-            L_ERROR( "[TCP Socket] Buffer size is not correct %d: %d!=%d  errno: %s",
-                handle->readSeqNr, nbytes, pHeader->bufferSize, strerror(errno));
-            entry->readState = READ_STATE_INIT;
-        } else {
-            *size = nbytes;
+
+    if (offset > 0) {
+        memmove(entry->buffer, entry->buffer + offset, entry->bufferReadSize - offset);
+        entry->bufferReadSize -= offset;
+    }
+    // When buffer is not big enough for the next message, use a larger buffer
+    if (neededSize > entry->bufferSize) {
+        if (!pubsub_tcpHandler_reserveReceiveBuffer(handle, entry, neededSize)) {
+            L_WARN("[TCP Socket: %d, url: %s,  cannot enlarge read buffer: (%d, %d) \n", entry->fd, entry->url,
+                   entry->bufferSize, neededSize);
         }
     }
-    celixThreadRwlock_unlock(&handle->dbLock);
-    return nbytes;
 }
 
 //
-// Read out the message which is indicated available by the largeUdp_dataAvailable function
+// Processes the newly received data in the receive buffer of the connection.
 //
-int pubsub_tcpHandler_read(pubsub_tcpHandler_t *handle, int fd, unsigned int index __attribute__ ((__unused__)),
-                           pubsub_tcp_msg_header_t **header, void **buffer, unsigned int size) {
-    int result = 0;
-    celixThreadRwlock_readLock(&handle->dbLock);
-    psa_tcp_connection_entry_t *entry = hashMap_get(handle->fd_map, (void *) (intptr_t)fd);
-    if (entry == NULL) result = -1;
-    if (entry) {
-        result = (!entry->connected) ? -1 : result;
-        result = (entry->readState != READ_STATE_READY) ? -1 : result;
-    }
-    if (!result) {
-        if (handle->bypassHeader) {
-            *header = &entry->header;
-            *buffer = entry->buffer;
-            entry->header.type = (unsigned int) entry->buffer[handle->msgIdOffset];
-            entry->header.seqNr = handle->readSeqNr++;
-            entry->header.sendTimeNanoseconds = 0;
-            entry->header.sendTimeNanoseconds = 0;
-            entry->readState = READ_STATE_INIT;
-        } else {
-            *header = (pubsub_tcp_msg_header_t *) entry->buffer;
-            *buffer = entry->buffer + sizeof(pubsub_tcp_msg_header_t);
-            entry->readState = READ_STATE_INIT;
+static inline void pubsub_tcpHandler_processReceivedData(pubsub_tcpHandler_t *handle, psa_tcp_connection_entry_t *entry) {
+    //note handle->readMutex locked
+    struct timespec receiveTime;
+    clock_gettime(CLOCK_REALTIME, &receiveTime);
+    if (handle->bypassHeader) {
+        // When no header, the read data is a single message
+        entry->header.type = (unsigned int) entry->buffer[handle->msgIdOffset];
+        entry->header.seqNr = handle->readSeqNr++;
+        entry->header.sendtimeSeconds = 0;
+        entry->header.sendTimeNanoseconds = 0;
+        if (handle->processMessageCallback) {
+            handle->processMessageCallback(handle->processMessagePayload, &entry->header,
+                                           (unsigned char *) entry->buffer, entry->bufferReadSize, &receiveTime);
         }
-        entry->readState = READ_STATE_INIT;
+        entry->bufferReadSize = 0;
+    } else {
+        pubsub_tcpHandler_processReceiveBuffer(handle, entry, &receiveTime);
+    }
+    pubsub_tcpHandler_returnReceiveBuffer(handle, entry);
+}
+
+//
+// Reads the available data of the filedescriptor (determined by epoll()) with a single recv call in the receive buffer
+// of the connection and processes all complete messages in the buffer.
+// The receive buffer is only used by the handler thread owning the connection, the readMutex only serializes the
+// message callbacks of the handler threads.
+// Returns the number of read bytes, 0 if the connection is closed by the peer or -1 on an error.
+//
+static inline int pubsub_tcpHandler_readAvailable(pubsub_tcpHandler_t *handle, int fd) {
+    celixThreadRwlock_readLock(&handle->dbLock);
+    psa_tcp_connection_entry_t *entry = hashMap_get(handle->fd_map, (void *) (intptr_t) fd);
+    // If it's not connected return from function
+    if (entry == NULL || !entry->connected) {
+        celixThreadRwlock_unlock(&handle->dbLock);
+        return -1;
+    }
+
+    if (entry->buffer == NULL || entry->bufferReadSize >= entry->bufferSize) {
+        unsigned int bufferSize = entry->bufferSize > 0 ? entry->bufferSize * 2 : handle->bufferSize;
+        pubsub_tcpHandler_reserveReceiveBuffer(handle, entry, bufferSize);
+    }
+    int nbytes = -1;
+    if (entry->bufferReadSize < entry->bufferSize) {
+        nbytes = recv(fd, &entry->buffer[entry->bufferReadSize], entry->bufferSize - entry->bufferReadSize, 0);
+    }
+    if (nbytes < 0) {
+        // Handle Socket error, when nbytes == 0 => Connection is lost
+        if ((errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR)) {}
+        else L_ERROR("[TCP Socket] read error %s\n", strerror(errno));
+        errno = 0;
+    } else if (nbytes > 0) {
+        entry->bufferReadSize += nbytes;
+        celixThreadMutex_lock(&handle->readMutex);
+        pubsub_tcpHandler_processReceivedData(handle, entry);
+        celixThreadMutex_unlock(&handle->readMutex);
     }
     celixThreadRwlock_unlock(&handle->dbLock);
-    return result;
+    return nbytes;
 }
 
 int pubsub_tcpHandler_addMessageHandler(pubsub_tcpHandler_t *handle, void *payload,
@@ -743,194 +1068,741 @@ int pubsub_tcpHandler_addConnectionCallback(pubsub_tcpHandler_t *handle, void *p
 }
 
 
+static inline size_t pubsub_tcpHandler_queueMsgs(pubsub_tcpHandler_t *handle, psa_tcp_connection_entry_t *entry,
+                                                 struct msghdr *msg, const size_t *iovecsPerMsg, size_t nbytes);
+static inline int pubsub_tcpHandler_flushQueue(pubsub_tcpHandler_t *handle, psa_tcp_connection_entry_t *entry);
+static inline void pubsub_tcpHandler_updateEpoll(pubsub_tcpHandler_t *handle, psa_tcp_connection_entry_t *entry);
+
+void pubsub_tcpHandler_setMultiplexed(pubsub_tcpHandler_t *handle, bool multiplexed) {
+    if (handle != NULL) {
+        celixThreadRwlock_writeLock(&handle->dbLock);
+        handle->multiplexed = multiplexed;
+        celixThreadRwlock_unlock(&handle->dbLock);
+    }
+}
+
+int pubsub_tcpHandler_addTopicHandler(pubsub_tcpHandler_t *handle, uint32_t topicId, void *payload,
+                                      pubsub_tcpHandler_processMessage_callback_t processMessageCallback,
+                                      pubsub_tcpHandler_connectMessage_callback_t connectMessageCallback,
+                                      pubsub_tcpHandler_connectMessage_callback_t disconnectMessageCallback) {
+    int result = 0;
+    celixThreadRwlock_writeLock(&handle->dbLock);
+    if (celix_longHashMap_hasKey(handle->topicHandlers, (long) topicId)) {
+        L_ERROR("[TCP Socket] Topic id 0x%X already has a msg handler\n", topicId);
+        result = -1;
+    } else {
+        psa_tcp_topic_handler_t *topicHandler = calloc(1, sizeof(*topicHandler));
+        topicHandler->payload = payload;
+        topicHandler->processMessageCallback = processMessageCallback;
+        topicHandler->connectMessageCallback = connectMessageCallback;
+        topicHandler->disconnectMessageCallback = disconnectMessageCallback;
+        celix_longHashMap_put(handle->topicHandlers, (long) topicId, topicHandler);
+    }
+    celixThreadRwlock_unlock(&handle->dbLock);
+    return result;
+}
+
+int pubsub_tcpHandler_removeTopicHandler(pubsub_tcpHandler_t *handle, uint32_t topicId) {
+    celixThreadRwlock_writeLock(&handle->dbLock);
+    psa_tcp_topic_handler_t *topicHandler = celix_longHashMap_get(handle->topicHandlers, (long) topicId);
+    celix_longHashMap_remove(handle->topicHandlers, (long) topicId);
+    celixThreadRwlock_unlock(&handle->dbLock);
+    free(topicHandler);
+    return topicHandler != NULL ? 0 : -1;
+}
+
+//
+// Reports a (dis)connected connection to the topic handlers of the topics subscribed through the connection.
+//
+static void pubsub_tcpHandler_notifyTopicHandlers(pubsub_tcpHandler_t *handle, psa_tcp_connection_entry_t *entry, bool connected, bool lock) {
+    //note handle->dbLock locked
+    celixThreadMutex_lock(&handle->writeMutex);
+    size_t size = entry->localTopicIds.size;
+    uint32_t topicIds[size > 0 ? size : 1];
+    if (size > 0) {
+        memcpy(topicIds, entry->localTopicIds.ids, size * sizeof(uint32_t));
+    }
+    celixThreadMutex_unlock(&handle->writeMutex);
+    for (size_t i = 0; i < size; i++) {
+        psa_tcp_topic_handler_t *topicHandler = celix_longHashMap_get(handle->topicHandlers, (long) topicIds[i]);
+        pubsub_tcpHandler_connectMessage_callback_t callback = topicHandler == NULL ? NULL :
+                connected ? topicHandler->connectMessageCallback : topicHandler->disconnectMessageCallback;
+        if (callback != NULL) {
+            callback(topicHandler->payload, entry->url, lock);
+        }
+    }
+}
+
+//
+// Queues a (un)subscribe control msg for the connection. Control msgs are always queued, so they are written in
+// order with the msgs and also when the connection is not yet connected.
+//
+static void pubsub_tcpHandler_writeControlMsg(pubsub_tcpHandler_t *handle, psa_tcp_connection_entry_t *entry, uint16_t flags, uint32_t topicId) {
+    //note handle->writeMutex locked
+    pubsub_tcp_msg_header_t header;
+    memset(&header, 0, sizeof(header));
+    header.marker_start = MARKER_START_PATTERN;
+    header.marker_end = MARKER_END_PATTERN;
+    header.flags = flags;
+    header.topicId = topicId;
+    struct iovec msg_iovec;
+    msg_iovec.iov_base = &header;
+    msg_iovec.iov_len = sizeof(header);
+    struct msghdr msg;
+    memset(&msg, 0, sizeof(msg));
+    msg.msg_iov = &msg_iovec;
+    msg.msg_iovlen = 1;
+    bool hadQueuedData = entry->sendEnd > entry->sendStart;
+    size_t iovecsPerMsg = 1;
+    pubsub_tcpHandler_queueMsgs(handle, entry, &msg, &iovecsPerMsg, 0);
+    if (entry->connected) {
+        pubsub_tcpHandler_flushQueue(handle, entry);
+    }
+    if ((entry->sendEnd > entry->sendStart) != hadQueuedData) {
+        pubsub_tcpHandler_updateEpoll(handle, entry);
+    }
+}
+
+//
+// Handles a (un)subscribe control msg of the peer of the connection.
+//
+static void pubsub_tcpHandler_processControlMsg(pubsub_tcpHandler_t *handle, psa_tcp_connection_entry_t *entry, const pubsub_tcp_msg_header_t *header) {
+    //note handle->readMutex locked
+    celixThreadMutex_lock(&handle->writeMutex);
+    if ((header->flags & PSA_TCP_MSG_FLAG_SUBSCRIBE) != 0) {
+        pubsub_tcpHandler_addTopicId(&entry->peerTopicIds, header->topicId);
+    } else {
+        pubsub_tcpHandler_removeTopicId(&entry->peerTopicIds, header->topicId);
+    }
+    celixThreadMutex_unlock(&handle->writeMutex);
+}
+
+int pubsub_tcpHandler_subscribe(pubsub_tcpHandler_t *handle, char *url, uint32_t topicId) {
+    int rc = pubsub_tcpHandler_connect(handle, url); //note does nothing if already connected
+    if (rc < 0) {
+        return rc;
+    }
+    celixThreadRwlock_readLock(&handle->dbLock);
+    psa_tcp_connection_entry_t *entry = hashMap_get(handle->url_map, url);
+    if (entry != NULL) {
+        celixThreadMutex_lock(&handle->writeMutex);
+        bool added = pubsub_tcpHandler_addTopicId(&entry->localTopicIds, topicId);
+        if (added) {
+            pubsub_tcpHandler_writeControlMsg(handle, entry, PSA_TCP_MSG_FLAG_SUBSCRIBE, topicId);
+        }
+        bool connected = entry->connected;
+        celixThreadMutex_unlock(&handle->writeMutex);
+        // A new connection is reported when it is writable, an existing one is reported directly
+        psa_tcp_topic_handler_t *topicHandler = celix_longHashMap_get(handle->topicHandlers, (long) topicId);
+        if (added && connected && topicHandler != NULL && topicHandler->connectMessageCallback != NULL) {
+            topicHandler->connectMessageCallback(topicHandler->payload, entry->url, false);
+        }
+        rc = entry->fd;
+    } else {
+        rc = -1;
+    }
+    celixThreadRwlock_unlock(&handle->dbLock);
+    return rc;
+}
+
+int pubsub_tcpHandler_unsubscribe(pubsub_tcpHandler_t *handle, char *url, uint32_t topicId) {
+    size_t remaining = 1;
+    celixThreadRwlock_readLock(&handle->dbLock);
+    psa_tcp_connection_entry_t *entry = hashMap_get(handle->url_map, url);
+    if (entry != NULL) {
+        celixThreadMutex_lock(&handle->writeMutex);
+        if (pubsub_tcpHandler_removeTopicId(&entry->localTopicIds, topicId)) {
+            pubsub_tcpHandler_writeControlMsg(handle, entry, PSA_TCP_MSG_FLAG_UNSUBSCRIBE, topicId);
+        }
+        remaining = entry->localTopicIds.size;
+        celixThreadMutex_unlock(&handle->writeMutex);
+    }
+    celixThreadRwlock_unlock(&handle->dbLock);
+    // The connection is closed when no topic is subscribed through it anymore
+    return remaining == 0 ? pubsub_tcpHandler_disconnect(handle, url) : 0;
+}
+
+static inline void pubsub_tcpHandler_updateEpoll(pubsub_tcpHandler_t *handle, psa_tcp_connection_entry_t *entry) {
+    //note handle->writeMutex locked
+    struct epoll_event event;
+    bzero(&event, sizeof(event)); // zero the struct
+    event.events = EPOLLRDHUP | EPOLLERR;
+    if (handle->ring == NULL) {
+        event.events |= EPOLLIN;
+    }
+    if (!entry->connected || entry->sendEnd > entry->sendStart) {
+        event.events |= EPOLLOUT;
+    }
+    event.data.fd = entry->fd;
+    int rc = epoll_ctl(entry->efd, EPOLL_CTL_MOD, entry->fd, &event);
+    if (rc < 0) {
+        L_ERROR("[TCP Socket] Cannot modify epoll %s\n", strerror(errno));
+        errno = 0;
+    }
+}
+
+static inline void pubsub_tcpHandler_queueBytes(psa_tcp_connection_entry_t *entry, const char *bytes, size_t size) {
+    //note handle->writeMutex locked
+    if (entry->sendEnd + size > entry->sendBufferSize) {
+        size_t queued = entry->sendEnd - entry->sendStart;
+        if (queued > 0) {
+            memmove(entry->sendBuffer, entry->sendBuffer + entry->sendStart, queued);
+        }
+        entry->sendStart = 0;
+        entry->sendEnd = queued;
+        if (queued + size > entry->sendBufferSize) {
+            size_t newSize = entry->sendBufferSize * 2 > queued + size ? entry->sendBufferSize * 2 : queued + size;
+            entry->sendBuffer = realloc(entry->sendBuffer, newSize);
+            entry->sendBufferSize = newSize;
+        }
+    }
+    memcpy(entry->sendBuffer + entry->sendEnd, bytes, size);
+    entry->sendEnd += size;
+}
+
+static inline void pubsub_tcpHandler_pushQueuedMsg(psa_tcp_connection_entry_t *entry, size_t size) {
+    //note handle->writeMutex locked
+    if (entry->sendMsgCount == entry->sendMsgCapacity) {
+        size_t capacity = entry->sendMsgCapacity > 0 ? entry->sendMsgCapacity * 2 : 64;
+        size_t *sizes = malloc(capacity * sizeof(*sizes));
+        for (size_t i = 0; i < entry->sendMsgCount; i++) {
+            sizes[i] = entry->sendMsgSizes[(entry->sendMsgFirst + i) % entry->sendMsgCapacity];
+        }
+        free(entry->sendMsgSizes);
+        entry->sendMsgSizes = sizes;
+        entry->sendMsgCapacity = capacity;
+        entry->sendMsgFirst = 0;
+    }
+    entry->sendMsgSizes[(entry->sendMsgFirst + entry->sendMsgCount) % entry->sendMsgCapacity] = size;
+    entry->sendMsgCount++;
+}
+
+//
+// Removes nbytes written bytes from the front of the send queue of the connection.
+//
+static inline void pubsub_tcpHandler_dequeueBytes(psa_tcp_connection_entry_t *entry, size_t nbytes) {
+    //note handle->writeMutex locked
+    entry->sendStart += nbytes;
+    while (nbytes > 0 && entry->sendMsgCount > 0) {
+        size_t *size = &entry->sendMsgSizes[entry->sendMsgFirst];
+        if (nbytes < *size) {
+            *size -= nbytes;
+            entry->sendHeadPartial = true;
+            nbytes = 0;
+        } else {
+            nbytes -= *size;
+            entry->sendMsgFirst = (entry->sendMsgFirst + 1) % entry->sendMsgCapacity;
+            entry->sendMsgCount--;
+            entry->sendHeadPartial = false;
+        }
+    }
+    if (entry->sendStart == entry->sendEnd) {
+        entry->sendStart = 0;
+        entry->sendEnd = 0;
+    }
+}
+
+//
+// Drops the oldest complete msg of the send queue of the connection. A partially written msg is never dropped,
+// because the receiver would lose the msg boundaries. Returns false if there is no msg which can be dropped.
+//
+static inline bool pubsub_tcpHandler_dropOldestMsg(psa_tcp_connection_entry_t *entry) {
+    //note handle->writeMutex locked
+    size_t index = entry->sendHeadPartial ? 1 : 0;
+    if (entry->sendMsgCount <= index) {
+        return false;
+    }
+    size_t dropIndex = (entry->sendMsgFirst + index) % entry->sendMsgCapacity;
+    size_t size = entry->sendMsgSizes[dropIndex];
+    if (entry->sendHeadPartial) {
+        // move the remaining part of the partially written msg over the dropped msg
+        size_t partial = entry->sendMsgSizes[entry->sendMsgFirst];
+        memmove(entry->sendBuffer + entry->sendStart + size, entry->sendBuffer + entry->sendStart, partial);
+        entry->sendMsgSizes[dropIndex] = partial;
+    }
+    entry->sendStart += size;
+    entry->sendMsgFirst = (entry->sendMsgFirst + 1) % entry->sendMsgCapacity;
+    entry->sendMsgCount--;
+    if (entry->sendStart == entry->sendEnd) {
+        entry->sendStart = 0;
+        entry->sendEnd = 0;
+    }
+    return true;
+}
+
+//
+// Waits till the send queue of the connection has room for size bytes (or is empty), by writing the queued data
+// when the socket is writable. Waits at most the timeout of the handler.
+//
+static inline void pubsub_tcpHandler_waitForQueueSpace(pubsub_tcpHandler_t *handle, psa_tcp_connection_entry_t *entry,
+                                                       size_t size) {
+    //note handle->writeMutex locked
+    struct timespec start;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    while (entry->sendEnd > entry->sendStart && (entry->sendEnd - entry->sendStart) + size > handle->maxSendQueueSize) {
+        struct timespec now;
+        clock_gettime(CLOCK_MONOTONIC, &now);
+        long elapsed = (now.tv_sec - start.tv_sec) * 1000L + (now.tv_nsec - start.tv_nsec) / 1000000L;
+        if (elapsed >= (long) handle->timeout) {
+            break;
+        }
+        struct pollfd pfd;
+        pfd.fd = entry->fd;
+        pfd.events = POLLOUT;
+        pfd.revents = 0;
+        int rc = poll(&pfd, 1, (int) (handle->timeout - elapsed));
+        if (rc < 0 && errno != EINTR) {
+            errno = 0;
+            break;
+        }
+        if (rc > 0 && pubsub_tcpHandler_flushQueue(handle, entry) != 0) {
+            break;
+        }
+    }
+}
+
+//
+// Makes room for a msg of size bytes in the send queue of the connection, according to the send queue policy.
+// Returns false if the msg should be dropped.
+//
+static inline bool pubsub_tcpHandler_makeQueueSpace(pubsub_tcpHandler_t *handle, psa_tcp_connection_entry_t *entry,
+                                                    size_t size) {
+    //note handle->writeMutex locked
+    if (handle->sendQueuePolicy == PUBSUB_SEND_QUEUE_POLICY_DROP_OLDEST_TYPE) {
+        while ((entry->sendEnd - entry->sendStart) + size > handle->maxSendQueueSize && pubsub_tcpHandler_dropOldestMsg(entry)) {
+            handle->nrOfDroppedMsgs++;
+        }
+    } else if (handle->sendQueuePolicy == PUBSUB_SEND_QUEUE_POLICY_BLOCK_TYPE) {
+        pubsub_tcpHandler_waitForQueueSpace(handle, entry, size);
+        if (entry->sendEnd == entry->sendStart) {
+            return true; // a msg larger than the max queue size is queued when the queue is empty
+        }
+    }
+    if ((entry->sendEnd - entry->sendStart) + size > handle->maxSendQueueSize) {
+        handle->nrOfDroppedMsgs++;
+        return false;
+    }
+    return true;
+}
+
+//
+// Queues the unwritten part of the messages in msg, nbytes is the number of already written bytes. iovecsPerMsg
+// contains the number of io vectors of every message in msg.
+// The remaining part of a partially written message is always queued, for complete messages the send queue
+// policy decides what happens when the send queue is full. Returns the number of dropped messages of msg.
+//
+static inline size_t pubsub_tcpHandler_queueMsgs(pubsub_tcpHandler_t *handle, psa_tcp_connection_entry_t *entry,
+                                                 struct msghdr *msg, const size_t *iovecsPerMsg, size_t nbytes) {
+    //note handle->writeMutex locked
+    size_t dropped = 0;
+    for (size_t i = 0, m = 0; i < msg->msg_iovlen; i += iovecsPerMsg[m++]) {
+        size_t msgSize = 0;
+        for (size_t j = i; j < i + iovecsPerMsg[m]; j++) {
+            msgSize += msg->msg_iov[j].iov_len;
+        }
+        if (nbytes >= msgSize) {
+            // already written
+            nbytes -= msgSize;
+            continue;
+        }
+        if (nbytes == 0 && !pubsub_tcpHandler_makeQueueSpace(handle, entry, msgSize)) {
+            dropped++;
+            continue;
+        }
+        if (nbytes > 0) {
+            entry->sendHeadPartial = true;
+        }
+        pubsub_tcpHandler_pushQueuedMsg(entry, msgSize - nbytes);
+        for (size_t j = i; j < i + iovecsPerMsg[m]; j++) {
+            size_t len = msg->msg_iov[j].iov_len;
+            if (nbytes >= len) {
+                nbytes -= len;
+                continue;
+            }
+            pubsub_tcpHandler_queueBytes(entry, (char *) msg->msg_iov[j].iov_base + nbytes, len - nbytes);
+            nbytes = 0;
+        }
+        if (entry->sendEnd - entry->sendStart > handle->maxQueuedBytes) {
+            handle->maxQueuedBytes = entry->sendEnd - entry->sendStart;
+        }
+    }
+    return dropped;
+}
+
+//
+// Writes the send queue of the connection with a single send call per iteration, as far as possible without blocking.
+// Returns -1 on a socket error.
+//
+static inline int pubsub_tcpHandler_flushQueue(pubsub_tcpHandler_t *handle, psa_tcp_connection_entry_t *entry) {
+    //note handle->writeMutex locked
+    int rc = 0;
+    while (entry->sendEnd > entry->sendStart) {
+        ssize_t nbytes = send(entry->fd, entry->sendBuffer + entry->sendStart, entry->sendEnd - entry->sendStart,
+                              MSG_NOSIGNAL | MSG_DONTWAIT);
+        if (nbytes < 0) {
+            if (!(errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR)) {
+                L_ERROR("[TCP Socket] Cannot send queued data to %s: %s\n", entry->url, strerror(errno));
+                rc = -1;
+            }
+            errno = 0;
+            break;
+        }
+        pubsub_tcpHandler_dequeueBytes(entry, (size_t) nbytes);
+    }
+    return rc;
+}
+
+//
+// Sends the msg, with a zero copy send when io_uring is used and the msg is large enough.
+// Returns like sendmsg the number of sent bytes or -1 with errno set.
+//
+static inline ssize_t pubsub_tcpHandler_sendMsg(pubsub_tcpHandler_t *handle, psa_tcp_connection_entry_t *entry,
+                                                const struct msghdr *msg, size_t msgSize) {
+    //note handle->writeMutex locked
+    if ((handle->sendRing != NULL) && (msgSize >= URING_ZERO_COPY_MIN_SIZE)) {
+        ssize_t rc = pubsub_tcpUring_sendMsgZeroCopy(handle->sendRing, entry->fd, msg, MSG_NOSIGNAL | MSG_WAITALL);
+        if (rc >= 0) {
+            return rc;
+        } else if (rc != -EOPNOTSUPP && rc != -EINVAL) {
+            errno = (int) -rc;
+            return -1;
+        }
+        L_WARN("[TCP Socket] Zero copy send not supported, using sendmsg\n");
+        pubsub_tcpUring_destroy(handle->sendRing);
+        handle->sendRing = NULL;
+    }
+    return sendmsg(entry->fd, msg, MSG_NOSIGNAL);
+}
+
+//
+// Queues the last value cache for a new connection, before any other msg is written to it.
+//
+static inline void pubsub_tcpHandler_queueLastValues(pubsub_tcpHandler_t *handle, psa_tcp_connection_entry_t *entry) {
+    //note handle->writeMutex locked
+    if (entry->lastValuesSent) {
+        return;
+    }
+    entry->lastValuesSent = true;
+    size_t iovecsPerMsg = handle->bypassHeader ? 1 : 2;
+    for (size_t i = 0; i < handle->nrOfLastValues; i++) {
+        psa_tcp_last_value_t *value = &handle->lastValues[i];
+        struct iovec msg_iovec[2];
+        struct msghdr msg;
+        memset(&msg, 0, sizeof(msg));
+        msg.msg_iov = msg_iovec;
+        if (!handle->bypassHeader) {
+            msg.msg_iov[msg.msg_iovlen].iov_base = &value->header;
+            msg.msg_iov[msg.msg_iovlen].iov_len = sizeof(pubsub_tcp_msg_header_t);
+            msg.msg_iovlen++;
+        }
+        msg.msg_iov[msg.msg_iovlen].iov_base = value->buffer;
+        msg.msg_iov[msg.msg_iovlen].iov_len = value->size;
+        msg.msg_iovlen++;
+        pubsub_tcpHandler_queueMsgs(handle, entry, &msg, &iovecsPerMsg, 0);
+    }
+}
+
+//
+// Stores a copy of the written msg as last value of its (msg type, key). When the cache is full, msgs of new
+// (msg type, key) combinations are not cached.
+//
+static inline void pubsub_tcpHandler_storeLastValue(pubsub_tcpHandler_t *handle, pubsub_tcp_msg_header_t *header,
+                                                    uint32_t key, const struct iovec *payload, size_t nrOfVectors) {
+    //note handle->writeMutex locked
+    psa_tcp_last_value_t *value = NULL;
+    long indexKey = pubsub_tcpHandler_lastValueKey(header, key);
+    size_t index = (size_t) (uintptr_t) celix_longHashMap_get(handle->lastValueIndex, indexKey);
+    if (index > 0) {
+        value = &handle->lastValues[index - 1];
+    } else {
+        if (handle->nrOfLastValues >= handle->maxLastValues) {
+            return;
+        }
+        value = &handle->lastValues[handle->nrOfLastValues++];
+        value->buffer = NULL;
+        value->size = 0;
+        value->key = key;
+        celix_longHashMap_put(handle->lastValueIndex, indexKey, (void *) (uintptr_t) handle->nrOfLastValues);
+    }
+    unsigned int size = header->bufferSize;
+    if (size > value->size || value->buffer == NULL) {
+        char *newBuffer = realloc(value->buffer, size > 0 ? size : 1);
+        if (newBuffer == NULL) {
+            return;
+        }
+        value->buffer = newBuffer;
+    }
+    size_t offset = 0;
+    for (size_t i = 0; i < nrOfVectors; i++) {
+        memcpy((char *) value->buffer + offset, payload[i].iov_base, payload[i].iov_len);
+        offset += payload[i].iov_len;
+    }
+    value->size = size;
+    value->header = *header;
+}
+
 //
 // Write large data to TCP. .
 //
 int pubsub_tcpHandler_write(pubsub_tcpHandler_t *handle, pubsub_tcp_msg_header_t *header, void *buffer,
                             unsigned int size, int flags) {
+    return pubsub_tcpHandler_writeMany(handle, header, &buffer, &size, 1, flags);
+}
+
+//
+// Writes n messages to all connections. Per connection the messages are combined in as few sendmsg calls as
+// possible, limited by MAX_MSG_VECTOR_LEN io vectors per call.
+// The data which cannot be written without blocking is queued per connection and written when the socket is
+// writable (EPOLLOUT). Messages written while data is queued are appended to the queue, to keep the message order,
+// and are written together with the other queued data with a single send call.
+//
+int pubsub_tcpHandler_writeMany(pubsub_tcpHandler_t *handle, pubsub_tcp_msg_header_t *headers, void **buffers,
+                                unsigned int *sizes, size_t n, int flags) {
+    return pubsub_tcpHandler_writeManyKeyed(handle, headers, buffers, sizes, NULL, n, flags);
+}
+
+int pubsub_tcpHandler_writeManyKeyed(pubsub_tcpHandler_t *handle, pubsub_tcp_msg_header_t *headers, void **buffers,
+                                     unsigned int *sizes, const uint32_t *keys, size_t n, int flags) {
+    struct iovec stackPayloads[MAX_MSG_VECTOR_LEN];
+    struct iovec *payloads = n <= MAX_MSG_VECTOR_LEN ? stackPayloads : malloc(n * sizeof(*payloads));
+    if (payloads == NULL) {
+        return -1;
+    }
+    for (size_t i = 0; i < n; i++) {
+        payloads[i].iov_base = buffers[i];
+        payloads[i].iov_len = sizes[i];
+    }
+    int rc = pubsub_tcpHandler_writeVectorsKeyed(handle, headers, payloads, NULL, keys, n, flags);
+    if (payloads != stackPayloads) {
+        free(payloads);
+    }
+    return rc;
+}
+
+int pubsub_tcpHandler_writeVectorsKeyed(pubsub_tcpHandler_t *handle, pubsub_tcp_msg_header_t *headers,
+                                        const struct iovec *payloads, const size_t *nrOfPayloadVectors,
+                                        const uint32_t *keys, size_t n, int flags) {
+    size_t headerVectors = handle->bypassHeader ? 0 : 1;
+    for (size_t i = 0, v = 0; i < n; i++) {
+        size_t nrOfVectors = nrOfPayloadVectors != NULL ? nrOfPayloadVectors[i] : 1;
+        if (nrOfVectors + headerVectors > MAX_MSG_VECTOR_LEN) {
+            L_ERROR("[TCP Socket] Cannot send msg with %zu io vectors, max is %i\n", nrOfVectors, MAX_MSG_VECTOR_LEN - (int) headerVectors);
+            errno = EMSGSIZE;
+            return -1;
+        }
+        size_t size = 0;
+        for (size_t j = 0; j < nrOfVectors; j++) {
+            size += payloads[v++].iov_len;
+        }
+        headers[i].marker_start = MARKER_START_PATTERN;
+        headers[i].marker_end   = MARKER_END_PATTERN;
+        headers[i].bufferSize   = (uint32_t) size;
+    }
+
     celixThreadRwlock_readLock(&handle->dbLock);
     int result = 0;
     int written = 0;
-    header->marker_start = MARKER_START_PATTERN;
-    header->marker_end   = MARKER_END_PATTERN;
-    header->bufferSize   = size;
+    size_t dropped = 0;
     hash_map_iterator_t iter = hashMapIterator_construct(handle->fd_map);
 
+    celixThreadMutex_lock(&handle->writeMutex);
     while (hashMapIterator_hasNext(&iter)) {
         psa_tcp_connection_entry_t *entry = hashMapIterator_nextValue(&iter);
+        if (entry->fd < 0) {
+            continue;
+        }
+        if (handle->multiplexed && !pubsub_tcpHandler_containsTopicId(&entry->peerTopicIds, headers[0].topicId)) {
+            continue; // note the msgs of a single writeMany call are of the same topic
+        }
 
-        // struct iovec *largeMsg_iovec, int len, ,
-        struct iovec msg_iovec[MAX_MSG_VECTOR_LEN];
-        struct msghdr msg;
-        msg.msg_name = &entry->addr;
-        msg.msg_namelen = entry->len;
-        msg.msg_flags = flags;
-        msg.msg_iov = msg_iovec;
-
-        msg.msg_control = NULL;
-        msg.msg_controllen = 0;
-        if (!handle->bypassHeader) {
-            msg.msg_iov[0].iov_base = header;
-            msg.msg_iov[0].iov_len = sizeof(pubsub_tcp_msg_header_t);
-            msg.msg_iov[1].iov_base = buffer;
-            msg.msg_iov[1].iov_len = size;
-            msg.msg_iovlen = 2;
-        } else {
-            msg.msg_iov[0].iov_base = buffer;
-            msg.msg_iov[0].iov_len = size;
-            msg.msg_iovlen = 1;
-        }
-
-        int nbytes = 0;
-        if (entry->fd >= 0) nbytes = sendmsg(entry->fd, &msg, MSG_NOSIGNAL);
-        //  Several errors are OK. When speculative write is being done we may not
-        //  be able to write a single byte to the socket buffer. (socket buffer full)
-        //  In this case when socket is not blocking, exit write function.
-        //  Btw, also, SIGSTOP issued by a debugging tool can result in EINTR error.
-        if (nbytes == -1) {
-            result = ((errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR)) ? 0 : -1;
-            L_ERROR("[TCP Socket] Seq_Id: %d Cannot send msg %s\n", header->seqNr, strerror(errno));
-            errno = 0;
+        bool hadQueuedData = entry->sendEnd > entry->sendStart;
+        pubsub_tcpHandler_queueLastValues(handle, entry);
+        if (pubsub_tcpHandler_flushQueue(handle, entry) != 0) {
+            result = -1;
         }
-        int msgSize = 0;
-        for (int i = 0; i < msg.msg_iovlen; i++) {
-            msgSize+=msg.msg_iov[i].iov_len;
+        bool queueing = entry->sendEnd > entry->sendStart;
+        size_t next = 0;
+        size_t nextVector = 0;
+        while (next < n) {
+            size_t first = next;
+            struct iovec msg_iovec[MAX_MSG_VECTOR_LEN];
+            size_t iovecsPerMsg[MAX_MSG_VECTOR_LEN];
+            size_t nrOfMsgs = 0;
+            struct msghdr msg;
+            msg.msg_name = &entry->addr;
+            msg.msg_namelen = entry->len;
+            msg.msg_flags = flags;
+            msg.msg_iov = msg_iovec;
+            msg.msg_iovlen = 0;
+            msg.msg_control = NULL;
+            msg.msg_controllen = 0;
+            //as many msgs as fit in MAX_MSG_VECTOR_LEN io vectors, at least one
+            while (next < n) {
+                size_t nrOfVectors = nrOfPayloadVectors != NULL ? nrOfPayloadVectors[next] : 1;
+                if (msg.msg_iovlen + headerVectors + nrOfVectors > MAX_MSG_VECTOR_LEN) {
+                    break;
+                }
+                if (!handle->bypassHeader) {
+                    msg.msg_iov[msg.msg_iovlen].iov_base = &headers[next];
+                    msg.msg_iov[msg.msg_iovlen].iov_len = sizeof(pubsub_tcp_msg_header_t);
+                    msg.msg_iovlen++;
+                }
+                for (size_t j = 0; j < nrOfVectors; j++) {
+                    msg.msg_iov[msg.msg_iovlen++] = payloads[nextVector++];
+                }
+                iovecsPerMsg[nrOfMsgs++] = headerVectors + nrOfVectors;
+                next++;
+            }
+            size_t msgSize = 0;
+            for (size_t i = 0; i < msg.msg_iovlen; i++) {
+                msgSize += msg.msg_iov[i].iov_len;
+            }
+
+            size_t nbytes = 0;
+            if (!queueing) {
+                ssize_t rc = pubsub_tcpHandler_sendMsg(handle, entry, &msg, msgSize);
+                //  Several errors are OK. When speculative write is being done we may not
+                //  be able to write a single byte to the socket buffer. (socket buffer full)
+                //  In this case the data is queued and written when the socket is writable.
+                //  Btw, also, SIGSTOP issued by a debugging tool can result in EINTR error.
+                if (rc == -1) {
+                    if (!(errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR)) {
+                        result = -1;
+                        L_ERROR("[TCP Socket] Seq_Id: %d Cannot send msg %s\n", headers[first].seqNr, strerror(errno));
+                        errno = 0;
+                        break;
+                    }
+                    errno = 0;
+                } else {
+                    nbytes = (size_t) rc;
+                    written += rc;
+                }
+                queueing = nbytes < msgSize;
+            }
+            if (queueing) {
+                dropped += pubsub_tcpHandler_queueMsgs(handle, entry, &msg, iovecsPerMsg, nbytes);
+            }
         }
-        if (nbytes != msgSize) {
-            L_ERROR("[TCP Socket] Seq; %d, MsgSize not correct: %d != %d (BufferSize: %d \n", header->seqNr, msgSize, nbytes, header->bufferSize);
+        if ((entry->sendEnd > entry->sendStart) != hadQueuedData) {
+            pubsub_tcpHandler_updateEpoll(handle, entry);
         }
-        written = (result == 0) ? written + nbytes : written;
     }
+    for (size_t i = 0, v = 0; handle->maxLastValues > 0 && i < n; i++) {
+        size_t nrOfVectors = nrOfPayloadVectors != NULL ? nrOfPayloadVectors[i] : 1;
+        pubsub_tcpHandler_storeLastValue(handle, &headers[i], keys != NULL ? keys[i] : 0, &payloads[v], nrOfVectors);
+        v += nrOfVectors;
+    }
+    celixThreadMutex_unlock(&handle->writeMutex);
     celixThreadRwlock_unlock(&handle->dbLock);
+
+    if (dropped > 0) {
+        L_ERROR("[TCP Socket] Send queue full, dropped %zu msg(s)\n", dropped);
+        result = -1;
+    }
     return (result == 0 ? written : result);
 }
 
+//
+// Handles a writable filedescriptor (determined by epoll()). Reports a new connection and writes the queued data.
+//
+static inline void pubsub_tcpHandler_writeAvailable(pubsub_tcpHandler_t *handle, int fd) {
+    int err = 0;
+    socklen_t len = sizeof(int);
+    int rc = getsockopt(fd, SOL_SOCKET, SO_ERROR, &err, &len);
+    if (rc != 0) {
+        L_ERROR("[TCP Socket]:EPOLLOUT ERROR read from socket %s\n", strerror(errno));
+        errno = 0;
+        return;
+    }
+    celixThreadRwlock_readLock(&handle->dbLock);
+    psa_tcp_connection_entry_t *entry = hashMap_get(handle->fd_map, (void *) (intptr_t) fd);
+    if (entry) {
+        if (!entry->connected) {
+            // tell sender that an receiver is connected
+            if (handle->multiplexed) pubsub_tcpHandler_notifyTopicHandlers(handle, entry, true, false);
+            else if (handle->connectMessageCallback) handle->connectMessageCallback(handle->connectPayload, entry->url, false);
+        }
+        celixThreadMutex_lock(&handle->writeMutex);
+        entry->connected = true;
+        pubsub_tcpHandler_queueLastValues(handle, entry);
+        pubsub_tcpHandler_flushQueue(handle, entry);
+        pubsub_tcpHandler_updateEpoll(handle, entry);
+        celixThreadMutex_unlock(&handle->writeMutex);
+    }
+    celixThreadRwlock_unlock(&handle->dbLock);
+}
+
 const char *pubsub_tcpHandler_url(pubsub_tcpHandler_t *handle) {
     return handle->own.url;
 }
 
-int pubsub_tcpHandler_handler(pubsub_tcpHandler_t *handle) {
+//
+// Handles the events of the epoll fd of a handler thread: new connections on the listener of the thread,
+// writable connections and (when io_uring is not used) readable connections.
+//
+static inline int pubsub_tcpHandler_processEpollEvents(pubsub_tcpHandler_t *handle, int efd, int listenFd, struct epoll_event *events, int nof_events) {
     int rc = 0;
-    if (handle->efd >= 0) {
-        struct epoll_event events[MAX_EPOLL_EVENTS];
-        int nof_events = 0;
-        nof_events = epoll_wait(handle->efd, events, MAX_EPOLL_EVENTS, handle->timeout);
-        if (nof_events < 0) {
-            if ((errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR)) {}
-            else L_ERROR("[TCP Socket] Cannot create epoll wait (%d) %s\n", nof_events, strerror(errno));
-            errno = 0;
-        }
-        for (int i = 0; i < nof_events; i++) {
-            if ((handle->own.fd >= 0) && (events[i].data.fd == handle->own.fd)) {
-                celixThreadRwlock_writeLock(&handle->dbLock);
-                // new connection available
-                struct sockaddr_in their_addr;
-                socklen_t len = sizeof(struct sockaddr_in);
-                int fd = accept(handle->own.fd, &their_addr, &len);
-                rc = fd;
-                if (rc == -1) {
-                  L_ERROR("[TCP Socket] accept failed: %s\n", strerror(errno));
-                  errno = 0;
-                }
-                // Make file descriptor NonBlocking
-                if ((!handle->useBlockingWrite) && (rc >= 0)) {
-                    rc = pubsub_tcpHandler_makeNonBlocking(handle, fd);
-                    if (rc < 0) pubsub_tcpHandler_freeEntry(&handle->own);
-                }
-                if (rc >= 0){
-                    // handle new connection:
-                    // add it to reactor, etc
-                    struct epoll_event event;
-                    bzero(&event, sizeof(event)); // zero the struct
-                    char *address = inet_ntoa(their_addr.sin_addr);
-                    unsigned int port = ntohs(their_addr.sin_port);
-                    char *url = NULL;
-                    asprintf(&url, "tcp://%s:%u", address, port);
-                    psa_tcp_connection_entry_t *entry = calloc(1, sizeof(*entry));
-                    pubsub_tcpHandler_setupEntry(entry, fd, url, MAX_DEFAULT_BUFFER_SIZE);
-                    entry->addr = their_addr;
-                    entry->len  = len;
-                    entry->connected = false;
-                    event.events = EPOLLIN | EPOLLRDHUP | EPOLLERR | EPOLLOUT;
-                    event.data.fd = entry->fd;
-                    // Register Read to epoll
-                    rc = epoll_ctl(handle->efd, EPOLL_CTL_ADD, entry->fd, &event);
-                    if (rc < 0) {
-                        pubsub_tcpHandler_freeEntry(entry);
-                        free(entry);
-                        L_ERROR("[TCP Socket] Cannot create epoll\n");
-                    } else {
-                        hashMap_put(handle->fd_map, (void *) (intptr_t) entry->fd, entry);
-                        hashMap_put(handle->url_map, entry->url, entry);
-                        L_INFO("[TCP Socket] New connection to url: %s: \n", url);
-                    }
-                    free(url);
-                }
-                celixThreadRwlock_unlock(&handle->dbLock);
-            } else if (events[i].events & EPOLLIN) {
-                int count = 0;
-                bool isReading = true;
-                while(isReading) {
-                    unsigned int index = 0;
-                    unsigned int size = 0;
-                    isReading = (handle->useBlockingRead) ? false : isReading;
-                    count++;
-                    rc = pubsub_tcpHandler_dataAvailable(handle, events[i].data.fd, &index, &size);
-                    if (rc <= 0) {
-                        // close connection.
-                        if (rc == 0) {
-                            pubsub_tcpHandler_closeConnection(handle, events[i].data.fd);
-                        }
-                        isReading = false;
-                        continue;
-                    }
-                    if (size) {
-                        // Handle data
-                        void *buffer = NULL;
-                        pubsub_tcp_msg_header_t *msgHeader = NULL;
-                        rc = pubsub_tcpHandler_read(handle, events[i].data.fd, index, &msgHeader, &buffer, size);
-                        if (rc < 0) {
-                            isReading = false;
-                            continue;
-                        }
-                        celixThreadRwlock_readLock(&handle->dbLock);
-                        if (handle->processMessageCallback) {
-                            struct timespec receiveTime;
-                            clock_gettime(CLOCK_REALTIME, &receiveTime);
-                            handle->processMessageCallback(handle->processMessagePayload, msgHeader, buffer, size,
-                                                           &receiveTime);
-                            isReading = false;
-                        }
-                        celixThreadRwlock_unlock(&handle->dbLock);
-                    }
+    for (int i = 0; i < nof_events; i++) {
+        if ((listenFd >= 0) && (events[i].data.fd == listenFd)) {
+            celixThreadRwlock_writeLock(&handle->dbLock);
+            // new connection available
+            struct sockaddr_in their_addr;
+            socklen_t len = sizeof(struct sockaddr_in);
+            int fd = accept(listenFd, &their_addr, &len);
+            rc = fd;
+            if (rc == -1) {
+              L_ERROR("[TCP Socket] accept failed: %s\n", strerror(errno));
+              errno = 0;
+            }
+            // Make file descriptor NonBlocking
+            if ((!handle->useBlockingWrite) && (rc >= 0)) {
+                rc = pubsub_tcpHandler_makeNonBlocking(handle, fd);
+                if (rc < 0) pubsub_tcpHandler_freeEntry(handle, &handle->own);
+            }
+            if (rc >= 0){
+                // handle new connection:
+                // add it to reactor, etc
+                struct epoll_event event;
+                bzero(&event, sizeof(event)); // zero the struct
+                char *address = inet_ntoa(their_addr.sin_addr);
+                unsigned int port = ntohs(their_addr.sin_port);
+                char *url = NULL;
+                asprintf(&url, "tcp://%s:%u", address, port);
+                psa_tcp_connection_entry_t *entry = calloc(1, sizeof(*entry));
+                pubsub_tcpHandler_setupEntry(entry, fd, url, 0); //note the receive buffer is loaned on the first read
+                entry->addr = their_addr;
+                entry->len  = len;
+                entry->connected = false;
+                event.events = EPOLLRDHUP | EPOLLERR | EPOLLOUT;
+                if (handle->ring == NULL) event.events |= EPOLLIN;
+                event.data.fd = entry->fd;
+                // A SO_REUSEPORT listener keeps its connections on its own thread, otherwise they are divided
+                entry->efd = handle->reusePort ? efd : pubsub_tcpHandler_nextEpollFd(handle);
+                // Register Read to epoll
+                rc = epoll_ctl(entry->efd, EPOLL_CTL_ADD, entry->fd, &event);
+                if (rc < 0) {
+                    pubsub_tcpHandler_freeEntry(handle, entry);
+                    free(entry);
+                    L_ERROR("[TCP Socket] Cannot create epoll\n");
+                } else {
+                    hashMap_put(handle->fd_map, (void *) (intptr_t) entry->fd, entry);
+                    hashMap_put(handle->url_map, entry->url, entry);
+                    handle->armRecv = true;
+                    L_INFO("[TCP Socket] New connection to url: %s: \n", url);
                 }
-            } else if (events[i].events & EPOLLOUT) {
-                int err = 0;
-                socklen_t len = sizeof(int);
-                rc = getsockopt(events[i].data.fd, SOL_SOCKET, SO_ERROR, &err, &len);
-                if (rc != 0) {
-                    L_ERROR("[TCP Socket]:EPOLLOUT ERROR read from socket %s\n", strerror(errno));
-                    errno = 0;
-                    continue;
+                free(url);
+            }
+            celixThreadRwlock_unlock(&handle->dbLock);
+        } else {
+            if (events[i].events & EPOLLOUT) {
+                pubsub_tcpHandler_writeAvailable(handle, events[i].data.fd);
+            }
+            if (events[i].events & EPOLLIN) {
+                rc = pubsub_tcpHandler_readAvailable(handle, events[i].data.fd);
+                if (rc == 0) {
+                    // close connection.
+                    pubsub_tcpHandler_closeConnection(handle, events[i].data.fd);
                 }
-                celixThreadRwlock_readLock(&handle->dbLock);
-                psa_tcp_connection_entry_t *entry = hashMap_get(handle->fd_map, (void *) (intptr_t) events[i].data.fd);
-                if (entry)
-                  if ((!entry->connected)) {
-                      // tell sender that an receiver is connected
-                      if (handle->connectMessageCallback) handle->connectMessageCallback(handle->connectPayload, entry->url, false);
-                      entry->connected = true;
-                      struct epoll_event event;
-                      bzero(&event, sizeof(event)); // zero the struct
-                      event.events = EPOLLIN | EPOLLRDHUP | EPOLLERR;
-                      event.data.fd = events[i].data.fd;
-                      // Register Modify epoll
-                      rc = epoll_ctl(handle->efd, EPOLL_CTL_MOD, events[i].data.fd, &event);
-                      if (rc < 0) {
-                          L_ERROR("[TCP Socket] Cannot create epoll\n");
-                      }
-                  }
-                celixThreadRwlock_unlock(&handle->dbLock);
             } else if (events[i].events & EPOLLRDHUP) {
                 int err = 0;
                 socklen_t len = sizeof(int);
@@ -950,3 +1822,179 @@ int pubsub_tcpHandler_handler(pubsub_tcpHandler_t *handle) {
     }
     return rc;
 }
+
+//
+// Handles a recv completion of the io_uring. Stale completions of closed connections are ignored.
+//
+static inline void pubsub_tcpHandler_uringReceived(pubsub_tcpHandler_t *handle, pubsub_tcp_uring_completion_t *completion) {
+    int fd = (int) (completion->userData & 0xFFFFFFFFu);
+    unsigned int generation = (unsigned int) (completion->userData >> 32u);
+    bool close = false;
+    celixThreadRwlock_readLock(&handle->dbLock);
+    psa_tcp_connection_entry_t *entry = hashMap_get(handle->fd_map, (void *) (intptr_t) fd);
+    if (entry != NULL && entry->recvArmed && entry->recvGeneration == generation) {
+        if (!completion->more) {
+            // multishot recv ended (e.g. no provided buffers available), rearm
+            entry->recvArmed = false;
+            handle->armRecv = true;
+        }
+        if (completion->result > 0 && completion->hasBuffer) {
+            celixThreadMutex_lock(&handle->readMutex);
+            unsigned int neededSize = entry->bufferReadSize + (unsigned int) completion->result;
+            pubsub_tcpHandler_reserveReceiveBuffer(handle, entry, neededSize < handle->bufferSize ? handle->bufferSize : neededSize);
+            if (neededSize <= entry->bufferSize) {
+                memcpy(&entry->buffer[entry->bufferReadSize], pubsub_tcpUring_buffer(handle->ring, completion->bufferId),
+                       (size_t) completion->result);
+                entry->bufferReadSize = neededSize;
+                pubsub_tcpHandler_processReceivedData(handle, entry);
+            }
+            celixThreadMutex_unlock(&handle->readMutex);
+        } else if (completion->result == 0) {
+            close = true;
+        } else if (completion->result < 0 && completion->result != -ENOBUFS && completion->result != -EINTR) {
+            L_ERROR("[TCP Socket] read error %s\n", strerror(-completion->result));
+            close = completion->result != -EAGAIN;
+        }
+    }
+    if (completion->hasBuffer) {
+        pubsub_tcpUring_recycleBuffer(handle->ring, completion->bufferId);
+    }
+    celixThreadRwlock_unlock(&handle->dbLock);
+    if (close) {
+        pubsub_tcpHandler_closeConnection(handle, fd);
+    }
+}
+
+//
+// io_uring variant of the handler. The connections are read with multishot recv operations, using the provided
+// buffers of the ring. The epoll fd is polled by the ring, for new and writable connections.
+//
+static inline int pubsub_tcpHandler_uringHandler(pubsub_tcpHandler_t *handle) {
+    int rc = 0;
+    if (!handle->pollArmed) {
+        handle->pollArmed = pubsub_tcpUring_poll(handle->ring, handle->efd, URING_EPOLL_USER_DATA);
+    }
+    if (handle->armRecv) {
+        celixThreadRwlock_readLock(&handle->dbLock);
+        handle->armRecv = false;
+        hash_map_iterator_t iter = hashMapIterator_construct(handle->fd_map);
+        while (hashMapIterator_hasNext(&iter)) {
+            psa_tcp_connection_entry_t *entry = hashMapIterator_nextValue(&iter);
+            if (entry->fd >= 0 && !entry->recvArmed) {
+                handle->recvGeneration = (handle->recvGeneration + 1) & URING_GENERATION_MASK;
+                uint64_t userData = ((uint64_t) handle->recvGeneration << 32u) | (uint32_t) entry->fd;
+                if (pubsub_tcpUring_recvMultishot(handle->ring, entry->fd, userData)) {
+                    entry->recvArmed = true;
+                    entry->recvGeneration = handle->recvGeneration;
+                } else {
+                    handle->armRecv = true; // submission queue full, retry next call
+                }
+            }
+        }
+        celixThreadRwlock_unlock(&handle->dbLock);
+    }
+    pubsub_tcpUring_submitAndWait(handle->ring, handle->timeout);
+    pubsub_tcp_uring_completion_t completion;
+    while (pubsub_tcpUring_nextCompletion(handle->ring, &completion)) {
+        if (completion.userData == URING_EPOLL_USER_DATA) {
+            handle->pollArmed = false;
+            struct epoll_event events[MAX_EPOLL_EVENTS];
+            int nof_events = epoll_wait(handle->efd, events, MAX_EPOLL_EVENTS, 0);
+            if (nof_events > 0) {
+                rc = pubsub_tcpHandler_processEpollEvents(handle, handle->efd, handle->own.fd, events, nof_events);
+            }
+        } else {
+            pubsub_tcpHandler_uringReceived(handle, &completion);
+        }
+    }
+    return rc;
+}
+
+int pubsub_tcpHandler_handler(pubsub_tcpHandler_t *handle) {
+    int rc = 0;
+    if (handle->efd >= 0 && handle->ring != NULL) {
+        rc = pubsub_tcpHandler_uringHandler(handle);
+    } else if (handle->efd >= 0) {
+        struct epoll_event events[MAX_EPOLL_EVENTS];
+        int nof_events = 0;
+        nof_events = epoll_wait(handle->efd, events, MAX_EPOLL_EVENTS, handle->timeout);
+        if (nof_events < 0) {
+            if ((errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR)) {}
+            else L_ERROR("[TCP Socket] Cannot create epoll wait (%d) %s\n", nof_events, strerror(errno));
+            errno = 0;
+        }
+        rc = pubsub_tcpHandler_processEpollEvents(handle, handle->efd, handle->own.fd, events, nof_events);
+    }
+    return rc;
+}
+
+//
+// Handler loop of an additional handler thread, the events are handled like the events of the epoll fd of the handle.
+//
+static void *pubsub_tcpHandler_workerThread(void *data) {
+    psa_tcp_handler_worker_t *worker = data;
+    pubsub_tcpHandler_t *handle = worker->handle;
+    celixThreadRwlock_readLock(&handle->dbLock);
+    bool running = handle->workersRunning;
+    int listenFd = worker->listenFd;
+    celixThreadRwlock_unlock(&handle->dbLock);
+    while (running) {
+        struct epoll_event events[MAX_EPOLL_EVENTS];
+        int nof_events = epoll_wait(worker->efd, events, MAX_EPOLL_EVENTS, handle->timeout);
+        if (nof_events < 0) {
+            if ((errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR)) {}
+            else L_ERROR("[TCP Socket] Cannot create epoll wait (%d) %s\n", nof_events, strerror(errno));
+            errno = 0;
+        } else if (nof_events > 0) {
+            pubsub_tcpHandler_processEpollEvents(handle, worker->efd, listenFd, events, nof_events);
+        }
+        celixThreadRwlock_readLock(&handle->dbLock);
+        running = handle->workersRunning;
+        listenFd = worker->listenFd;
+        celixThreadRwlock_unlock(&handle->dbLock);
+    }
+    return NULL;
+}
+
+void pubsub_tcpHandler_setThreads(pubsub_tcpHandler_t *handle, unsigned int nrOfThreads, bool reusePort) {
+    if (handle == NULL || handle->workers != NULL || nrOfThreads <= 1) {
+        return;
+    }
+    if (handle->ring != NULL) {
+        L_WARN("[TCP Socket] The io_uring handler uses a single thread, ignoring %u handler threads\n", nrOfThreads);
+        return;
+    }
+    celixThreadRwlock_writeLock(&handle->dbLock);
+    handle->reusePort = reusePort;
+    handle->workers = calloc(nrOfThreads - 1, sizeof(*handle->workers));
+    for (unsigned int i = 0; i < nrOfThreads - 1; i++) {
+        psa_tcp_handler_worker_t *worker = &handle->workers[i];
+        worker->handle = handle;
+        worker->listenFd = -1;
+        worker->efd = epoll_create1(0);
+        if (worker->efd < 0) {
+            L_ERROR("[TCP Socket] Cannot create epoll for handler thread: %s\n", strerror(errno));
+            errno = 0;
+            break;
+        }
+        handle->nrOfWorkers++;
+    }
+    handle->workersRunning = true;
+    celixThreadRwlock_unlock(&handle->dbLock);
+    for (unsigned int i = 0; i < handle->nrOfWorkers; i++) {
+        celixThread_create(&handle->workers[i].thread, NULL, pubsub_tcpHandler_workerThread, &handle->workers[i]);
+        celixThread_setName(&handle->workers[i].thread, "TCPHandler");
+    }
+}
+
+static void pubsub_tcpHandler_stopWorkers(pubsub_tcpHandler_t *handle) {
+    celixThreadRwlock_writeLock(&handle->dbLock);
+    bool running = handle->workersRunning;
+    handle->workersRunning = false;
+    celixThreadRwlock_unlock(&handle->dbLock);
+    if (running) {
+        for (unsigned int i = 0; i < handle->nrOfWorkers; i++) {
+            celixThread_join(handle->workers[i].thread, NULL);
+        }
+    }
+}
@@ -31,10 +31,12 @@
 #include <stdlib.h>
 #include <sys/types.h>
 #include <sys/socket.h>
+#include <sys/uio.h>
 #include <netinet/in.h>
 #include <log_helper.h>
 #include "celix_threads.h"
 #include "pubsub_tcp_msg_header.h"
+#include "pubsub_utils.h"
 
 typedef struct pubsub_tcpHandler_url {
     char *url;
@@ -55,16 +57,51 @@ int pubsub_tcpHandler_connect(pubsub_tcpHandler_t *handle, char* url);
 int pubsub_tcpHandler_disconnect(pubsub_tcpHandler_t *handle, char* url);
 int pubsub_tcpHandler_listen(pubsub_tcpHandler_t *handle, char* url);
 
+// Creates the receive buffer pool of the handle, with maxNofBuffers pooled buffers per size class (bufferSize times a
+// power of 2). The receive buffers are loaned by the connections with unprocessed data. Returns -1 if already created.
 int pubsub_tcpHandler_createReceiveBufferStore(pubsub_tcpHandler_t *handle, unsigned int maxNofBuffers, unsigned int bufferSize);
+// Backs the receive buffer pool with huge pages (if available). Set before creating the receive buffer store.
+void pubsub_tcpHandler_setReceiveBufferHugePages(pubsub_tcpHandler_t *handle, bool useHugePages);
 void pubsub_tcpHandler_setTimeout(pubsub_tcpHandler_t *handle, unsigned int timeout);
 void pubsub_tcpHandler_setBypassHeader(pubsub_tcpHandler_t *handle, bool bypassHeader, unsigned int msgIdOffset, unsigned int msgIdSize);
 void pubsub_tcpHandler_setBlockingWrite(pubsub_tcpHandler_t *handle, bool blocking);
 void pubsub_tcpHandler_setBlockingRead(pubsub_tcpHandler_t *handle, bool blocking);
+// Uses io_uring instead of epoll for receiving, falls back to epoll when io_uring is not available. Set before connecting.
+void pubsub_tcpHandler_setIoUring(pubsub_tcpHandler_t *handle, bool useIoUring);
+// Divides the connections over nrOfThreads handler threads, each with its own epoll fd. The first thread is the thread
+// calling pubsub_tcpHandler_handler. With reusePort every thread gets its own SO_REUSEPORT listener, otherwise the
+// accepted connections are divided round robin. Not supported with io_uring. Set before listening or connecting.
+void pubsub_tcpHandler_setThreads(pubsub_tcpHandler_t *handle, unsigned int nrOfThreads, bool reusePort);
+// Sets the policy used when the send queue (max maxSize bytes) of a non blocking connection is full.
+void pubsub_tcpHandler_setSendQueue(pubsub_tcpHandler_t *handle, pubsub_send_queue_policy_e policy, size_t maxSize);
+// Keeps the last written msg of at most maxMsgTypes msg types, which are written to every new connection before any
+// other msg. Msgs written with a key (see pubsub_tcpHandler_writeManyKeyed) are cached per (msg type, key), each
+// counting as a msg type. 0 disables the last value cache.
+void pubsub_tcpHandler_setLastValueCache(pubsub_tcpHandler_t *handle, size_t maxMsgTypes);
+// Multiplexes the msgs of multiple topics over the connections of the handler. The msgs are tagged with the topic id
+// of the header and are only written to the connections of which the peer subscribed the topic. Received msgs are
+// delivered to the topic handler of their topic instead of the message handler. Set before listening or connecting.
+void pubsub_tcpHandler_setMultiplexed(pubsub_tcpHandler_t *handle, bool multiplexed);
+int pubsub_tcpHandler_addTopicHandler(pubsub_tcpHandler_t *handle, uint32_t topicId, void *payload,
+                                      pubsub_tcpHandler_processMessage_callback_t processMessageCallback,
+                                      pubsub_tcpHandler_connectMessage_callback_t connectMessageCallback,
+                                      pubsub_tcpHandler_connectMessage_callback_t disconnectMessageCallback);
+int pubsub_tcpHandler_removeTopicHandler(pubsub_tcpHandler_t *handle, uint32_t topicId);
+// Subscribes the topic at the peer of the url, connects to the url if there is no connection yet. Returns < 0 on error.
+int pubsub_tcpHandler_subscribe(pubsub_tcpHandler_t *handle, char *url, uint32_t topicId);
+// Unsubscribes the topic, the connection is closed when it is the last topic subscribed through the connection.
+int pubsub_tcpHandler_unsubscribe(pubsub_tcpHandler_t *handle, char *url, uint32_t topicId);
+void pubsub_tcpHandler_sendQueueMetrics(pubsub_tcpHandler_t *handle, unsigned long *queuedBytes, unsigned long *maxQueuedBytes, unsigned long *droppedMsgs);
 
-int pubsub_tcpHandler_dataAvailable(pubsub_tcpHandler_t *handle, int fd, unsigned int *index, unsigned int *size);
-int pubsub_tcpHandler_read(pubsub_tcpHandler_t *handle, int fd, unsigned int index, pubsub_tcp_msg_header_t** header, void ** buffer, unsigned int size);
 int pubsub_tcpHandler_handler(pubsub_tcpHandler_t *handle);
 int pubsub_tcpHandler_write(pubsub_tcpHandler_t *handle, pubsub_tcp_msg_header_t* header, void* buffer, unsigned int size, int flags);
+int pubsub_tcpHandler_writeMany(pubsub_tcpHandler_t *handle, pubsub_tcp_msg_header_t* headers, void** buffers, unsigned int* sizes, size_t n, int flags);
+// writeMany with per msg last value cache keys (see pubsub_tcpHandler_setLastValueCache), keys can be NULL.
+int pubsub_tcpHandler_writeManyKeyed(pubsub_tcpHandler_t *handle, pubsub_tcp_msg_header_t* headers, void** buffers, unsigned int* sizes, const uint32_t *keys, size_t n, int flags);
+// writeManyKeyed with scatter/gather payloads: payloads contains the io vectors of all msgs, nrOfPayloadVectors the
+// number of io vectors per msg (NULL for a single io vector per msg). The payload of a msg is written without copying
+// it into a contiguous buffer, so a msg can reference (parts of) the msg struct.
+int pubsub_tcpHandler_writeVectorsKeyed(pubsub_tcpHandler_t *handle, pubsub_tcp_msg_header_t* headers, const struct iovec *payloads, const size_t *nrOfPayloadVectors, const uint32_t *keys, size_t n, int flags);
 int pubsub_tcpHandler_addMessageHandler(pubsub_tcpHandler_t *handle, void* payload, pubsub_tcpHandler_processMessage_callback_t processMessageCallback);
 int pubsub_tcpHandler_addConnectionCallback(pubsub_tcpHandler_t *handle, void* payload, pubsub_tcpHandler_connectMessage_callback_t connectMessageCallback, pubsub_tcpHandler_connectMessage_callback_t disconnectMessageCallback);
 
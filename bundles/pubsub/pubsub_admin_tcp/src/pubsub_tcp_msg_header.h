@@ -23,17 +23,24 @@
 #define MARKER_START_PATTERN       (0x56781234)
 #define MARKER_END_PATTERN         (0x67812345)
 
+#define PSA_TCP_MSG_FLAG_POD       (0x01) //payload is an unserialized plain old data msg (see pubsub_publisher_t loanMsg)
+#define PSA_TCP_MSG_FLAG_COMPRESSED (0x02) //payload is compressed (see pubsub_compression.h)
+#define PSA_TCP_MSG_FLAG_TRACE      (0x04) //payload is prefixed with a pubsub_trace_context_t, which is not compressed (see pubsub_trace.h)
+#define PSA_TCP_MSG_FLAG_SUBSCRIBE   (0x08) //control msg without payload, the peer subscribes to the msgs of topicId (multiplexed connections)
+#define PSA_TCP_MSG_FLAG_UNSUBSCRIBE (0x10) //control msg without payload, the peer unsubscribes from the msgs of topicId (multiplexed connections)
+
 typedef struct pubsub_tcp_msg_header {
   uint32_t marker_start;
   uint32_t type; //msg type id (hash of fqn)
   uint32_t seqNr;
   uint8_t  major;
   uint8_t  minor;
-  uint16_t padding;
+  uint16_t flags;
   unsigned char originUUID[16];
   uint64_t sendtimeSeconds; //seconds since epoch
   uint64_t sendTimeNanoseconds; //ns since epoch
   uint32_t bufferSize; //Size of the buffer
+  uint32_t topicId; //hash of scope/topic on multiplexed connections (see PSA_TCP_MULTIPLEX), 0 otherwise
   uint32_t marker_end;
 } pubsub_tcp_msg_header_t;
 
@@ -28,18 +28,27 @@
 #include <arpa/inet.h>
 #include <log_helper.h>
 #include <math.h>
+#include <unistd.h>
 #include "pubsub_tcp_handler.h"
 #include "pubsub_tcp_topic_receiver.h"
 #include "pubsub_psa_tcp_constants.h"
 #include "pubsub_tcp_common.h"
+#include "celix_hash_map.h"
 
 #include <uuid/uuid.h>
 #include <pubsub_admin_metrics.h>
+#include <pubsub_msg_loan_pool.h>
+#include <pubsub_dispatcher.h>
+#include <pubsub_compression.h>
+#include <pubsub_msg_batch.h>
+#include <pubsub_trace.h>
+#include <pubsub_interceptors_handler.h>
+#include "celix_probes.h"
 
 #define MAX_EPOLL_EVENTS     16
-#ifndef UUID_STR_LEN
-#define UUID_STR_LEN  37
-#endif
+#define METRICS_TABLE_SIZE   256 //max nr of (msg type, origin) metrics entries per subscriber, power of 2
+#define MAX_BATCH_SIZE       256 //max nr of msgs delivered in a single receiveBatch call
+#define MUX_CONNECT_INTERVAL 10000 //usec between (re)subscribe attempts of a multiplexed topic receiver
 
 
 #define L_DEBUG(...) \
@@ -58,10 +67,15 @@ struct pubsub_tcp_topic_receiver {
     pubsub_serializer_service_t *serializer;
     char *scope;
     char *topic;
+    char *msgFilter; //combined msg filter of the subscribers, NULL if all msgs are needed
     char scopeAndTopicFilter[5];
     bool metricsEnabled;
     pubsub_tcpHandler_t *socketHandler;
     pubsub_tcpHandler_t *sharedSocketHandler;
+    uint32_t topicId; //0 if the topic is not multiplexed over the shared admin socket handler
+    pubsub_compressor_t *decompressor;
+    pubsub_tracer_t *tracer; //NULL if tracing is disabled
+    pubsub_interceptors_handler_t *interceptors;
 
     struct {
         celix_thread_t thread;
@@ -81,6 +95,9 @@ struct pubsub_tcp_topic_receiver {
         hash_map_t *map; //key = bnd id, value = psa_tcp_subscriber_entry_t
         bool allInitialized;
     } subscribers;
+
+    pubsub_dispatcher_t *dispatcher; //NULL if msgs are dispatched on the receive thread
+    bool batchDelivery; //true if the receive thread runs the socket handler, so batches are flushed after every handler cycle
 };
 
 typedef struct psa_tcp_requested_connection_entry {
@@ -92,30 +109,47 @@ typedef struct psa_tcp_requested_connection_entry {
     bool statically; //true if the connection is statically configured through the topic properties.
 } psa_tcp_requested_connection_entry_t;
 
+/**
+ * Metrics for a msg type from an origin. Only updated by the thread processing the msgs of the subscriber entry
+ * and read lock-free (relaxed atomic loads) by the metrics visitor.
+ */
 typedef struct psa_tcp_subscriber_metrics_entry_t {
     unsigned int msgTypeId;
     uuid_t origin;
 
     unsigned long nrOfMessagesReceived;
     unsigned long nrOfSerializationErrors;
-    struct timespec lastMessageReceived;
-    double averageTimeBetweenMessagesInSeconds;
-    double averageSerializationTimeInSeconds;
-    double averageDelayInSeconds;
-    double maxDelayInSeconds;
-    double minDelayInSeconds;
-    unsigned int lastSeqNr;
     unsigned long nrOfMissingSeqNumbers;
+    unsigned long nrOfMessagesConflated;
+    struct timespec lastMessageReceived;
+    pubsub_metrics_histogram_t serializationTime;
+    pubsub_metrics_histogram_t delay;
+    unsigned int lastSeqNr; //only used by the updating thread
 } psa_tcp_subscriber_metrics_entry_t;
 
 typedef struct psa_tcp_subscriber_entry {
     int usageCount;
     hash_map_t *msgTypes; //map from serializer svc
-    hash_map_t *metrics; //key = msg type id, value = hash_map (key = origin uuid, value = psa_tcp_subscriber_metrics_entry_t*
+    celix_long_hash_map_t *msgSerializers; //key = msg type id, value = pubsub_msg_serializer_t*. Same content as msgTypes, used for the per message lookup
+    //open addressing table with key (msg type id, binary origin uuid). Slots are filled once by the thread processing
+    //the msgs of the entry (receive thread or dispatch queue) and are only freed when the entry is destroyed.
+    psa_tcp_subscriber_metrics_entry_t *metrics[METRICS_TABLE_SIZE];
+    bool metricsTableFull; //true if a metrics entry could not be added (logged once)
     pubsub_subscriber_t *svc;
     bool initialized; //true if the init function is called through the receive thread
+    pubsub_tcp_topic_receiver_t *receiver;
+    pubsub_dispatch_queue_t *queue; //NULL if msgs are dispatched on the receive thread
+    pubsub_msg_batch_t *batch; //NULL if the subscriber has no receiveBatch or msgs are not batched by the receive thread
 } psa_tcp_subscriber_entry_t;
 
+/**
+ * The header of a traced msg with the trace context split off from the payload, as queued for the dispatch queues.
+ */
+typedef struct psa_tcp_traced_msg_header {
+    pubsub_tcp_msg_header_t hdr;
+    pubsub_trace_context_t trace;
+} psa_tcp_traced_msg_header_t;
+
 
 static void pubsub_tcpTopicReceiver_addSubscriber(void *handle, void *svc, const celix_properties_t *props,
                                                   const celix_bundle_t *owner);
@@ -132,6 +166,8 @@ static void psa_tcp_initializeAllSubscribers(pubsub_tcp_topic_receiver_t *receiv
 static void processMsg(void *handle, const pubsub_tcp_msg_header_t *hdr, const unsigned char *payload, size_t payloadSize, struct timespec *receiveTime);
 static void psa_tcp_connectHandler(void *handle, const char *url, bool lock);
 static void psa_tcp_disConnectHandler(void *handle, const char *url, bool lock);
+static void psa_tcp_destroySubscriberEntry(pubsub_tcp_topic_receiver_t *receiver, psa_tcp_subscriber_entry_t *entry);
+static void psa_tcp_dispatchMsg(void *handle, const void *header, const void *payload, size_t payloadSize, const struct timespec *receiveTime, unsigned int nrOfConflatedMsgs);
 
 
 pubsub_tcp_topic_receiver_t *pubsub_tcpTopicReceiver_create(celix_bundle_context_t *ctx,
@@ -140,6 +176,7 @@ pubsub_tcp_topic_receiver_t *pubsub_tcpTopicReceiver_create(celix_bundle_context
                                                             const char *topic,
                                                             const celix_properties_t *topicProperties,
                                                             pubsub_tcp_endPointStore_t *endPointStore,
+                                                            pubsub_tcpHandler_t *muxHandler,
                                                             long serializerSvcId,
                                                             pubsub_serializer_service_t *serializer) {
     pubsub_tcp_topic_receiver_t *receiver = calloc(1, sizeof(*receiver));
@@ -149,6 +186,8 @@ pubsub_tcp_topic_receiver_t *pubsub_tcpTopicReceiver_create(celix_bundle_context
     receiver->serializer = serializer;
     receiver->scope = strndup(scope, 1024 * 1024);
     receiver->topic = strndup(topic, 1024 * 1024);
+    const char *msgFilter = celix_properties_get(topicProperties, PUBSUB_SUBSCRIBER_MSG_FILTER, NULL);
+    receiver->msgFilter = msgFilter == NULL ? NULL : strndup(msgFilter, 1024 * 1024);
 
     long sessions = celix_bundleContext_getPropertyAsLong(ctx, PSA_TCP_MAX_RECV_SESSIONS, PSA_TCP_DEFAULT_MAX_RECV_SESSIONS);
     long buffer_size = celix_bundleContext_getPropertyAsLong(ctx, PSA_TCP_RECV_BUFFER_SIZE, PSA_TCP_DEFAULT_RECV_BUFFER_SIZE);
@@ -182,18 +221,39 @@ pubsub_tcp_topic_receiver_t *pubsub_tcpTopicReceiver_create(celix_bundle_context
         celixThreadMutex_unlock(&receiver->thread.mutex);
     }
 
-    if (receiver->socketHandler == NULL) {
+    //note static and header less topics are never multiplexed, their peers expect a dedicated connection
+    bool multiplexed = muxHandler != NULL && endPointType == NULL && staticConnectUrls == NULL &&
+                       (topicProperties == NULL || !celix_properties_getAsBool((celix_properties_t *) topicProperties, PUBSUB_TCP_BYPASS_HEADER, PUBSUB_TCP_DEFAULT_BYPASS_HEADER));
+    if (multiplexed) {
+        uint32_t topicId = psa_tcp_topicId(scope, topic);
+        if (pubsub_tcpHandler_addTopicHandler(muxHandler, topicId, receiver, processMsg, psa_tcp_connectHandler, psa_tcp_disConnectHandler) == 0) {
+            receiver->socketHandler = muxHandler;
+            receiver->sharedSocketHandler = muxHandler;
+            receiver->topicId = topicId;
+        } else {
+            L_ERROR("[PSA_TCP] Topic id of %s/%s is already multiplexed", scope, topic);
+        }
+    } else if (receiver->socketHandler == NULL) {
         receiver->socketHandler = pubsub_tcpHandler_create(receiver->logHelper);
+        pubsub_tcpHandler_setIoUring(receiver->socketHandler, celix_bundleContext_getPropertyAsBool(ctx, PSA_TCP_IO_URING, PSA_TCP_DEFAULT_IO_URING));
+        //note a handler thread per partition, the connections (partitions) are divided round robin over the threads
+        long nrOfThreads = celix_bundleContext_getPropertyAsLong(ctx, PSA_TCP_HANDLER_THREADS, PSA_TCP_DEFAULT_HANDLER_THREADS);
+        long nrOfPartitions = topicProperties == NULL ? PUBSUB_PARTITIONS_DEFAULT :
+                              celix_properties_getAsLong(topicProperties, PUBSUB_PARTITIONS_KEY, PUBSUB_PARTITIONS_DEFAULT);
+        pubsub_tcpHandler_setThreads(receiver->socketHandler,
+                                     (unsigned int) (nrOfPartitions > nrOfThreads ? nrOfPartitions : nrOfThreads),
+                                     celix_bundleContext_getPropertyAsBool(ctx, PSA_TCP_REUSE_PORT, PSA_TCP_DEFAULT_REUSE_PORT));
     }
 
-    if (receiver->socketHandler != NULL) {
+    if (receiver->socketHandler != NULL && !multiplexed) {
+        pubsub_tcpHandler_setReceiveBufferHugePages(receiver->socketHandler, celix_bundleContext_getPropertyAsBool(ctx, PSA_TCP_RECV_BUFFER_HUGE_PAGES, PSA_TCP_DEFAULT_RECV_BUFFER_HUGE_PAGES));
         pubsub_tcpHandler_createReceiveBufferStore(receiver->socketHandler, (unsigned int) sessions, (unsigned int) buffer_size);
         pubsub_tcpHandler_setTimeout(receiver->socketHandler, (unsigned int) timeout);
         pubsub_tcpHandler_addMessageHandler(receiver->socketHandler, receiver, processMsg);
         pubsub_tcpHandler_addConnectionCallback(receiver->socketHandler, receiver, psa_tcp_connectHandler, psa_tcp_disConnectHandler);
     }
 
-    if (topicProperties != NULL) {
+    if (topicProperties != NULL && receiver->socketHandler != NULL && !multiplexed) {
         bool blocking     = celix_properties_getAsBool((celix_properties_t *) topicProperties, PUBSUB_TCP_SUBSCRIBER_BLOCKING_KEY, PUBSUB_TCP_SUBSCRIBER_BLOCKING_DEFAULT);
         bool bypassHeader = celix_properties_getAsBool((celix_properties_t *) topicProperties, PUBSUB_TCP_BYPASS_HEADER, PUBSUB_TCP_DEFAULT_BYPASS_HEADER);
         long msgIdOffset  = celix_properties_getAsLong(topicProperties, PUBSUB_TCP_MESSAGE_ID_OFFSET, PUBSUB_TCP_DEFAULT_MESSAGE_ID_OFFSET);
@@ -214,6 +274,13 @@ pubsub_tcp_topic_receiver_t *pubsub_tcpTopicReceiver_create(celix_bundle_context
     receiver->requestedConnections.map = hashMap_create(utils_stringHash, NULL, utils_stringEquals, NULL);
     receiver->requestedConnections.allConnected = false;
 
+    char dispatcherName[64];
+    snprintf(dispatcherName, 64, "TCP TD %s/%s", scope, topic);
+    receiver->dispatcher = pubsub_dispatcher_create(topicProperties, dispatcherName);
+    receiver->decompressor = pubsub_decompressor_create(topicProperties);
+    receiver->tracer = pubsub_tracer_create(ctx, PUBSUB_TCP_ADMIN_TYPE, scope, topic);
+    receiver->interceptors = pubsub_interceptorsHandler_create(ctx, PUBSUB_TCP_ADMIN_TYPE, scope, topic);
+
     if ((staticConnectUrls != NULL) && (receiver->socketHandler != NULL) && (staticBindUrl == NULL)) {
       char *urlsCopy = strndup(staticConnectUrls, 1024 * 1024);
       char *url;
@@ -232,6 +299,8 @@ pubsub_tcp_topic_receiver_t *pubsub_tcpTopicReceiver_create(celix_bundle_context
     if ((receiver->socketHandler != NULL) && (staticBindUrl == NULL)) {
         // Configure Receiver thread
         receiver->thread.running = true;
+        //note msgs of a multiplexed topic are processed by the admin thread, batches are never flushed
+        receiver->batchDelivery = receiver->dispatcher == NULL && !multiplexed;
         celixThread_create(&receiver->thread.thread, NULL, psa_tcp_recvThread, receiver);
         char name[64];
         snprintf(name, 64, "TCP TR %s/%s", scope, topic);
@@ -255,8 +324,13 @@ pubsub_tcp_topic_receiver_t *pubsub_tcpTopicReceiver_create(celix_bundle_context
     }
 
     if (receiver->socketHandler == NULL) {
+        pubsub_dispatcher_destroy(receiver->dispatcher);
+        pubsub_compressor_destroy(receiver->decompressor);
+        pubsub_tracer_destroy(receiver->tracer);
+        pubsub_interceptorsHandler_destroy(receiver->interceptors);
         free(receiver->scope);
         free(receiver->topic);
+        free(receiver->msgFilter);
         free(receiver);
         receiver = NULL;
         L_ERROR("[PSA_TCP] Cannot create TopicReceiver for %s/%s", scope, topic);
@@ -273,6 +347,19 @@ void pubsub_tcpTopicReceiver_destroy(pubsub_tcp_topic_receiver_t *receiver) {
             receiver->thread.running = false;
             celixThreadMutex_unlock(&receiver->thread.mutex);
             celixThread_join(receiver->thread.thread, NULL);
+        } else {
+            celixThreadMutex_unlock(&receiver->thread.mutex);
+        }
+
+        if (receiver->topicId != 0) {
+            celixThreadMutex_lock(&receiver->requestedConnections.mutex);
+            hash_map_iterator_t connIter = hashMapIterator_construct(receiver->requestedConnections.map);
+            while (hashMapIterator_hasNext(&connIter)) {
+                psa_tcp_requested_connection_entry_t *entry = hashMapIterator_nextValue(&connIter);
+                pubsub_tcpHandler_unsubscribe(receiver->socketHandler, entry->url, receiver->topicId);
+            }
+            celixThreadMutex_unlock(&receiver->requestedConnections.mutex);
+            pubsub_tcpHandler_removeTopicHandler(receiver->socketHandler, receiver->topicId);
         }
 
         celix_bundleContext_stopTracker(receiver->ctx, receiver->subscriberTrackerId);
@@ -282,22 +369,19 @@ void pubsub_tcpTopicReceiver_destroy(pubsub_tcp_topic_receiver_t *receiver) {
         while (hashMapIterator_hasNext(&iter)) {
             psa_tcp_subscriber_entry_t *entry = hashMapIterator_nextValue(&iter);
             if (entry != NULL) {
-                receiver->serializer->destroySerializerMap(receiver->serializer->handle, entry->msgTypes);
-                free(entry);
-            }
-
-            hash_map_iterator_t iter2 = hashMapIterator_construct(entry->metrics);
-            while (hashMapIterator_hasNext(&iter2)) {
-                hash_map_t *origins = hashMapIterator_nextValue(&iter2);
-                hashMap_destroy(origins, true, true);
+                psa_tcp_destroySubscriberEntry(receiver, entry);
             }
-            hashMap_destroy(entry->metrics, false, false);
         }
         hashMap_destroy(receiver->subscribers.map, false, false);
 
 
         celixThreadMutex_unlock(&receiver->subscribers.mutex);
 
+        pubsub_dispatcher_destroy(receiver->dispatcher);
+        pubsub_compressor_destroy(receiver->decompressor);
+        pubsub_tracer_destroy(receiver->tracer);
+        pubsub_interceptorsHandler_destroy(receiver->interceptors);
+
         celixThreadMutex_lock(&receiver->requestedConnections.mutex);
         iter = hashMapIterator_construct(receiver->requestedConnections.map);
         while (hashMapIterator_hasNext(&iter)) {
@@ -314,8 +398,10 @@ void pubsub_tcpTopicReceiver_destroy(pubsub_tcp_topic_receiver_t *receiver) {
         celixThreadMutex_destroy(&receiver->requestedConnections.mutex);
         celixThreadMutex_destroy(&receiver->thread.mutex);
 
-        pubsub_tcpHandler_addMessageHandler(receiver->socketHandler, NULL, NULL);
-        pubsub_tcpHandler_addConnectionCallback(receiver->socketHandler, NULL, NULL, NULL);
+        if (receiver->topicId == 0) {
+            pubsub_tcpHandler_addMessageHandler(receiver->socketHandler, NULL, NULL);
+            pubsub_tcpHandler_addConnectionCallback(receiver->socketHandler, NULL, NULL, NULL);
+        }
         if ((receiver->socketHandler) && (receiver->sharedSocketHandler == NULL)) {
             pubsub_tcpHandler_destroy(receiver->socketHandler);
             receiver->socketHandler = NULL;
@@ -323,6 +409,7 @@ void pubsub_tcpTopicReceiver_destroy(pubsub_tcp_topic_receiver_t *receiver) {
 
         free(receiver->scope);
         free(receiver->topic);
+        free(receiver->msgFilter);
     }
     free(receiver);
 }
@@ -335,6 +422,10 @@ const char *pubsub_tcpTopicReceiver_topic(pubsub_tcp_topic_receiver_t *receiver)
     return receiver->topic;
 }
 
+const char *pubsub_tcpTopicReceiver_msgFilter(pubsub_tcp_topic_receiver_t *receiver) {
+    return receiver->msgFilter;
+}
+
 long pubsub_tcpTopicReceiver_serializerSvcId(pubsub_tcp_topic_receiver_t *receiver) {
     return receiver->serializerSvcId;
 }
@@ -359,39 +450,52 @@ void pubsub_tcpTopicReceiver_listConnections(pubsub_tcp_topic_receiver_t *receiv
 
 void pubsub_tcpTopicReceiver_connectTo(
         pubsub_tcp_topic_receiver_t *receiver,
-        const char *url) {
-    L_DEBUG("[PSA_TCP] TopicReceiver %s/%s connecting to tcp url %s", receiver->scope, receiver->topic, url);
+        const char *urls) {
+    L_DEBUG("[PSA_TCP] TopicReceiver %s/%s connecting to tcp url %s", receiver->scope, receiver->topic, urls);
 
+    //note the url of a partitioned topic is the space separated list of the urls of its partitions
+    char *urlsCopy = strndup(urls, 1024 * 1024);
+    char *save = urlsCopy;
+    char *url;
     celixThreadMutex_lock(&receiver->requestedConnections.mutex);
-    psa_tcp_requested_connection_entry_t *entry = hashMap_get(receiver->requestedConnections.map, url);
-    if (entry == NULL) {
-        entry = calloc(1, sizeof(*entry));
-        entry->url = strndup(url, 1024 * 1024);
-        entry->connected = false;
-        entry->statically = false;
-        entry->parent = receiver;
-        hashMap_put(receiver->requestedConnections.map, (void *) entry->url, entry);
-        receiver->requestedConnections.allConnected = false;
+    while ((url = strtok_r(save, " ", &save))) {
+        psa_tcp_requested_connection_entry_t *entry = hashMap_get(receiver->requestedConnections.map, url);
+        if (entry == NULL) {
+            entry = calloc(1, sizeof(*entry));
+            entry->url = strndup(url, 1024 * 1024);
+            entry->connected = false;
+            entry->statically = false;
+            entry->parent = receiver;
+            hashMap_put(receiver->requestedConnections.map, (void *) entry->url, entry);
+            receiver->requestedConnections.allConnected = false;
+        }
     }
     celixThreadMutex_unlock(&receiver->requestedConnections.mutex);
+    free(urlsCopy);
 
     psa_tcp_connectToAllRequestedConnections(receiver);
 }
 
-void pubsub_tcpTopicReceiver_disconnectFrom(pubsub_tcp_topic_receiver_t *receiver, const char *url) {
-    L_DEBUG("[PSA TCP] TopicReceiver %s/%s disconnect from tcp url %s", receiver->scope, receiver->topic, url);
+void pubsub_tcpTopicReceiver_disconnectFrom(pubsub_tcp_topic_receiver_t *receiver, const char *urls) {
+    L_DEBUG("[PSA TCP] TopicReceiver %s/%s disconnect from tcp url %s", receiver->scope, receiver->topic, urls);
 
+    char *urlsCopy = strndup(urls, 1024 * 1024);
+    char *save = urlsCopy;
+    char *url;
     celixThreadMutex_lock(&receiver->requestedConnections.mutex);
-    psa_tcp_requested_connection_entry_t *entry = hashMap_remove(receiver->requestedConnections.map, url);
-    if (entry != NULL) {
-        int rc = pubsub_tcpHandler_disconnect(receiver->socketHandler, entry->url);
-        if (rc < 0) L_WARN("[PSA_TCP] Error disconnecting from tcp url %s. (%s)", url, strerror(errno));
-    }
-    if (entry != NULL) {
-        free(entry->url);
-        free(entry);
+    while ((url = strtok_r(save, " ", &save))) {
+        psa_tcp_requested_connection_entry_t *entry = hashMap_remove(receiver->requestedConnections.map, url);
+        if (entry != NULL) {
+            int rc = receiver->topicId != 0 ?
+                     pubsub_tcpHandler_unsubscribe(receiver->socketHandler, entry->url, receiver->topicId) :
+                     pubsub_tcpHandler_disconnect(receiver->socketHandler, entry->url);
+            if (rc < 0) L_WARN("[PSA_TCP] Error disconnecting from tcp url %s. (%s)", url, strerror(errno));
+            free(entry->url);
+            free(entry);
+        }
     }
     celixThreadMutex_unlock(&receiver->requestedConnections.mutex);
+    free(urlsCopy);
 }
 
 
@@ -416,22 +520,27 @@ static void pubsub_tcpTopicReceiver_addSubscriber(void *handle, void *svc, const
         entry->usageCount = 1;
         entry->svc = svc;
         entry->initialized = false;
+        entry->receiver = receiver;
         receiver->subscribers.allInitialized = false;
 
         int rc = receiver->serializer->createSerializerMap(receiver->serializer->handle, (celix_bundle_t *) bnd,
                                                            &entry->msgTypes);
 
         if (rc == 0) {
-            entry->metrics = hashMap_create(NULL, NULL, NULL, NULL);
+            entry->msgSerializers = celix_longHashMap_create();
             hash_map_iterator_t iter = hashMapIterator_construct(entry->msgTypes);
             while (hashMapIterator_hasNext(&iter)) {
                 pubsub_msg_serializer_t *msgSer = hashMapIterator_nextValue(&iter);
-                hash_map_t *origins = hashMap_create(utils_stringHash, NULL, utils_stringEquals, NULL);
-                hashMap_put(entry->metrics, (void *) (uintptr_t) msgSer->msgId, origins);
+                celix_longHashMap_put(entry->msgSerializers, (long)msgSer->msgId, msgSer);
             }
         }
 
         if (rc == 0) {
+            if (receiver->dispatcher != NULL) {
+                entry->queue = pubsub_dispatcher_createQueue(receiver->dispatcher, entry, psa_tcp_dispatchMsg);
+            } else if (receiver->batchDelivery) {
+                entry->batch = pubsub_msgBatch_create(entry->svc, MAX_BATCH_SIZE);
+            }
             hashMap_put(receiver->subscribers.map, (void *) bndId, entry);
         } else {
             L_ERROR("[PSA_TCP] Cannot create msg serializer map for TopicReceiver %s/%s", receiver->scope, receiver->topic);
@@ -455,27 +564,65 @@ static void pubsub_tcpTopicReceiver_removeSubscriber(void *handle, void *svc, co
     if (entry != NULL && entry->usageCount <= 0) {
         //remove entry
         hashMap_remove(receiver->subscribers.map, (void *) bndId);
-        int rc = receiver->serializer->destroySerializerMap(receiver->serializer->handle, entry->msgTypes);
-        if (rc != 0) {
-            L_ERROR("[PSA_TCP] Cannot destroy msg serializers map for TopicReceiver %s/%s", receiver->scope, receiver->topic);
-        }
-        hash_map_iterator_t iter = hashMapIterator_construct(entry->metrics);
-        while (hashMapIterator_hasNext(&iter)) {
-            hash_map_t *origins = hashMapIterator_nextValue(&iter);
-            hashMap_destroy(origins, true, true);
-        }
-        hashMap_destroy(entry->metrics, false, false);
-        free(entry);
+        psa_tcp_destroySubscriberEntry(receiver, entry);
     }
     celixThreadMutex_unlock(&receiver->subscribers.mutex);
 }
 
+static void psa_tcp_destroySubscriberEntry(pubsub_tcp_topic_receiver_t *receiver, psa_tcp_subscriber_entry_t *entry) {
+    //note the dispatch threads never lock the subscribers mutex, so the queue can be destroyed with that mutex locked
+    pubsub_dispatchQueue_destroy(entry->queue);
+    pubsub_msgBatch_destroy(entry->batch);
+    int rc = receiver->serializer->destroySerializerMap(receiver->serializer->handle, entry->msgTypes);
+    if (rc != 0) {
+        L_ERROR("[PSA_TCP] Cannot destroy msg serializers map for TopicReceiver %s/%s", receiver->scope, receiver->topic);
+    }
+    celix_longHashMap_destroy(entry->msgSerializers);
+    for (int i = 0; i < METRICS_TABLE_SIZE; ++i) {
+        free(entry->metrics[i]);
+    }
+    free(entry);
+}
+
+/**
+ * Returns the metrics entry for the msg type and origin of the header, creating it when first seen.
+ * Only called by the thread processing the msgs of the subscriber entry, so the table has a single writer.
+ * Returns NULL if the metrics table is full.
+ */
+static psa_tcp_subscriber_metrics_entry_t* psa_tcp_getMetricsEntry(pubsub_tcp_topic_receiver_t *receiver, psa_tcp_subscriber_entry_t *entry, const pubsub_tcp_msg_header_t *hdr) {
+    uint64_t high;
+    uint64_t low;
+    memcpy(&high, hdr->originUUID, sizeof(high));
+    memcpy(&low, hdr->originUUID + sizeof(high), sizeof(low));
+    uint64_t hash = (high ^ (low * 0x9E3779B97F4A7C15ULL) ^ hdr->type) * 0xBF58476D1CE4E5B9ULL;
+    hash ^= hash >> 31;
+
+    for (unsigned int i = 0; i < METRICS_TABLE_SIZE; ++i) {
+        unsigned int index = (unsigned int) (hash + i) & (METRICS_TABLE_SIZE - 1);
+        psa_tcp_subscriber_metrics_entry_t *metrics = entry->metrics[index];
+        if (metrics == NULL) {
+            metrics = calloc(1, sizeof(*metrics));
+            metrics->msgTypeId = hdr->type;
+            memcpy(metrics->origin, hdr->originUUID, sizeof(metrics->origin));
+            __atomic_store_n(&entry->metrics[index], metrics, __ATOMIC_RELEASE); //publish to the metrics visitor
+            return metrics;
+        } else if (metrics->msgTypeId == hdr->type && memcmp(metrics->origin, hdr->originUUID, sizeof(metrics->origin)) == 0) {
+            return metrics;
+        }
+    }
+    if (!entry->metricsTableFull) {
+        entry->metricsTableFull = true;
+        L_WARN("[PSA_TCP_TR] Metrics table full for scope/topic %s/%s, msgs from new origins are not monitored", receiver->scope, receiver->topic);
+    }
+    return NULL;
+}
+
 static inline void
 processMsgForSubscriberEntry(pubsub_tcp_topic_receiver_t *receiver, psa_tcp_subscriber_entry_t *entry,
                              const pubsub_tcp_msg_header_t *hdr, const unsigned char *payload, size_t payloadSize,
-                             struct timespec *receiveTime) {
-    //NOTE receiver->subscribers.mutex locked
-    pubsub_msg_serializer_t *msgSer = hashMap_get(entry->msgTypes, (void *) (uintptr_t)(hdr->type));
+                             const struct timespec *receiveTime, const pubsub_trace_context_t *trace, unsigned int nrOfConflatedMsgs) {
+    //NOTE receiver->subscribers.mutex locked or called from the dispatch queue of the entry
+    pubsub_msg_serializer_t *msgSer = celix_longHashMap_get(entry->msgSerializers, (long)hdr->type);
     pubsub_subscriber_t *svc = entry->svc;
     bool monitor = receiver->metricsEnabled;
 
@@ -485,20 +632,53 @@ processMsgForSubscriberEntry(pubsub_tcp_topic_receiver_t *receiver, psa_tcp_subs
     int updateReceiveCount = 0;
     int updateSerError = 0;
 
+    //tracing
+    pubsub_trace_receive_span_t span;
+    bool traceSpan = trace != NULL && receiver->tracer != NULL && msgSer != NULL;
+    if (traceSpan) {
+        pubsub_tracer_beginReceiveSpan(receiver->tracer, trace, receiveTime, &span);
+    }
+
     if (msgSer != NULL) {
         void *deserializedMsg = NULL;
         bool validVersion = psa_tcp_checkVersion(msgSer->msgVersion, hdr);
-        if (validVersion) {
+        bool olderVersion = !validVersion && msgSer->deserializeVersion != NULL && psa_tcp_isOlderMinorVersion(msgSer->msgVersion, hdr);
+        if (validVersion || olderVersion) {
             if (monitor) {
                 clock_gettime(CLOCK_REALTIME, &beginSer);
             }
-            celix_status_t status = msgSer->deserialize(msgSer->handle, payload, payloadSize, &deserializedMsg);
+            if (traceSpan) {
+                span.deserializeStart = pubsub_trace_now();
+            }
+            celix_status_t status;
+            if ((hdr->flags & PSA_TCP_MSG_FLAG_POD) != 0) {
+                status = pubsub_createPodMsg(msgSer, payload, payloadSize, &deserializedMsg);
+            } else if (olderVersion) {
+                status = msgSer->deserializeVersion(msgSer->handle, hdr->major, hdr->minor, payload, payloadSize, &deserializedMsg);
+            } else {
+                status = msgSer->deserialize(msgSer->handle, payload, payloadSize, &deserializedMsg);
+            }
             if (monitor) {
                 clock_gettime(CLOCK_REALTIME, &endSer);
             }
+            if (traceSpan) {
+                span.deserializeEnd = pubsub_trace_now();
+            }
             if (status == CELIX_SUCCESS) {
                 bool release = true;
-                svc->receive(svc->handle, msgSer->msgName, msgSer->msgId, deserializedMsg, &release);
+                if (entry->batch != NULL) {
+                    //note the span of a batched msg ends when the msg is added to the batch
+                    pubsub_msgBatch_add(entry->batch, msgSer, deserializedMsg);
+                    release = false;
+                } else {
+                    if (traceSpan) {
+                        span.callbackStart = pubsub_trace_now();
+                    }
+                    svc->receive(svc->handle, msgSer->msgName, msgSer->msgId, deserializedMsg, &release);
+                    if (traceSpan) {
+                        span.callbackEnd = pubsub_trace_now();
+                    }
+                }
                 if (release) {
                     msgSer->freeMsg(msgSer->handle, deserializedMsg);
                 }
@@ -512,39 +692,22 @@ processMsgForSubscriberEntry(pubsub_tcp_topic_receiver_t *receiver, psa_tcp_subs
     } else {
         L_WARN("[PSA_TCP_TR] Cannot find serializer for type id 0x%X", hdr->type);
     }
+    if (traceSpan) {
+        pubsub_tracer_endReceiveSpan(receiver->tracer, msgSer->msgName, &span);
+    }
 
-    if (msgSer != NULL && monitor) {
-        hash_map_t *origins = hashMap_get(entry->metrics, (void *) (uintptr_t) hdr->type);
-        char uuidStr[UUID_STR_LEN + 1];
-        uuid_unparse(hdr->originUUID, uuidStr);
-        psa_tcp_subscriber_metrics_entry_t *metrics = hashMap_get(origins, uuidStr);
-
-        if (metrics == NULL) {
-            metrics = calloc(1, sizeof(*metrics));
-            hashMap_put(origins, strndup(uuidStr, UUID_STR_LEN + 1), metrics);
-            uuid_copy(metrics->origin, hdr->originUUID);
-            metrics->msgTypeId = hdr->type;
-            metrics->maxDelayInSeconds = -INFINITY;
-            metrics->minDelayInSeconds = INFINITY;
-            metrics->lastSeqNr = 0;
-        }
-
+    psa_tcp_subscriber_metrics_entry_t *metrics = msgSer != NULL && monitor ? psa_tcp_getMetricsEntry(receiver, entry, hdr) : NULL;
+    if (metrics != NULL) {
+        //note single writer, so relaxed load/stores are enough to make the counters safe to read by the visitor
         double diff = celix_difftime(&beginSer, &endSer);
-        long n = metrics->nrOfMessagesReceived;
-        metrics->averageSerializationTimeInSeconds = (metrics->averageSerializationTimeInSeconds * n + diff) / (n + 1);
-
-        diff = celix_difftime(&metrics->lastMessageReceived, receiveTime);
-        n = metrics->nrOfMessagesReceived;
-        if (metrics->nrOfMessagesReceived >= 1) {
-            metrics->averageTimeBetweenMessagesInSeconds =
-                    (metrics->averageTimeBetweenMessagesInSeconds * n + diff) / (n + 1);
-        }
-        metrics->lastMessageReceived = *receiveTime;
+        pubsub_metricsHistogram_record(&metrics->serializationTime, diff > 0 ? (uint64_t) (diff * 1e9) : 0);
+        __atomic_store_n(&metrics->lastMessageReceived.tv_sec, receiveTime->tv_sec, __ATOMIC_RELAXED);
+        __atomic_store_n(&metrics->lastMessageReceived.tv_nsec, receiveTime->tv_nsec, __ATOMIC_RELAXED);
 
-
-        int incr = hdr->seqNr - metrics->lastSeqNr;
+        //conflated msgs are not missing
+        int incr = hdr->seqNr - metrics->lastSeqNr - (int) nrOfConflatedMsgs;
         if (metrics->lastSeqNr > 0 && incr > 1) {
-            metrics->nrOfMissingSeqNumbers += (incr - 1);
+            __atomic_store_n(&metrics->nrOfMissingSeqNumbers, metrics->nrOfMissingSeqNumbers + (incr - 1), __ATOMIC_RELAXED);
             L_WARN("Missing message seq nr went from %i to %i", metrics->lastSeqNr, hdr->seqNr);
         }
         metrics->lastSeqNr = hdr->seqNr;
@@ -553,30 +716,113 @@ processMsgForSubscriberEntry(pubsub_tcp_topic_receiver_t *receiver, psa_tcp_subs
         sendTime.tv_sec = (time_t) hdr->sendtimeSeconds;
         sendTime.tv_nsec = (long) hdr->sendTimeNanoseconds; //TODO FIXME the tv_nsec is not correct
         diff = celix_difftime(&sendTime, receiveTime);
-        metrics->averageDelayInSeconds = (metrics->averageDelayInSeconds * n + diff) / (n + 1);
-        if (diff < metrics->minDelayInSeconds) {
-            metrics->minDelayInSeconds = diff;
-        }
-        if (diff > metrics->maxDelayInSeconds) {
-            metrics->maxDelayInSeconds = diff;
-        }
+        pubsub_metricsHistogram_record(&metrics->delay, diff > 0 ? (uint64_t) (diff * 1e9) : 0); //clock skew can make the delay negative
+
+        __atomic_store_n(&metrics->nrOfMessagesReceived, metrics->nrOfMessagesReceived + updateReceiveCount, __ATOMIC_RELAXED);
+        __atomic_store_n(&metrics->nrOfSerializationErrors, metrics->nrOfSerializationErrors + updateSerError, __ATOMIC_RELAXED);
+        __atomic_store_n(&metrics->nrOfMessagesConflated, metrics->nrOfMessagesConflated + nrOfConflatedMsgs, __ATOMIC_RELAXED);
+    }
+}
 
-        metrics->nrOfMessagesReceived += updateReceiveCount;
-        metrics->nrOfSerializationErrors += updateSerError;
+static void psa_tcp_dispatchMsg(void *handle, const void *header, const void *payload, size_t payloadSize, const struct timespec *receiveTime, unsigned int nrOfConflatedMsgs) {
+    psa_tcp_subscriber_entry_t *entry = handle;
+    const pubsub_tcp_msg_header_t *hdr = header;
+    const pubsub_trace_context_t *trace = NULL;
+    if ((hdr->flags & PSA_TCP_MSG_FLAG_TRACE) != 0) {
+        trace = &((const psa_tcp_traced_msg_header_t *) header)->trace;
     }
+    processMsgForSubscriberEntry(entry->receiver, entry, hdr, payload, payloadSize, receiveTime, trace, nrOfConflatedMsgs);
 }
 
 static void processMsg(void *handle, const pubsub_tcp_msg_header_t *hdr, const unsigned char *payload, size_t payloadSize, struct timespec *receiveTime) {
     pubsub_tcp_topic_receiver_t *receiver = handle;
+    CELIX_PROBE4(psa_receive, PUBSUB_TCP_ADMIN_TYPE, receiver->topic, hdr->type, payloadSize);
+
+    //the trace context is split off from the payload, the header keeps the trace flag
+    psa_tcp_traced_msg_header_t tracedHdr;
+    const pubsub_trace_context_t *trace = NULL;
+    if ((hdr->flags & PSA_TCP_MSG_FLAG_TRACE) != 0) {
+        if (payloadSize < sizeof(tracedHdr.trace)) {
+            L_WARN("[PSA_TCP_TR] Invalid traced msg with type id 0x%X for scope/topic %s/%s", hdr->type, receiver->scope, receiver->topic);
+            return;
+        }
+        tracedHdr.hdr = *hdr;
+        memcpy(&tracedHdr.trace, payload, sizeof(tracedHdr.trace));
+        hdr = &tracedHdr.hdr;
+        trace = &tracedHdr.trace;
+        payload += sizeof(tracedHdr.trace);
+        payloadSize -= sizeof(tracedHdr.trace);
+    }
+
+    //a compressed payload is decompressed once for all subscribers
+    pubsub_tcp_msg_header_t decompressedHdr;
+    void *decompressed = NULL;
+    if ((hdr->flags & PSA_TCP_MSG_FLAG_COMPRESSED) != 0) {
+        size_t decompressedSize = 0;
+        if (pubsub_compressor_decompress(receiver->decompressor, payload, payloadSize, &decompressed, &decompressedSize) != CELIX_SUCCESS) {
+            L_WARN("[PSA_TCP_TR] Cannot decompress msg with type id 0x%X for scope/topic %s/%s", hdr->type, receiver->scope, receiver->topic);
+            return;
+        }
+        if (trace != NULL) {
+            tracedHdr.hdr.flags &= (uint16_t) ~PSA_TCP_MSG_FLAG_COMPRESSED;
+        } else {
+            decompressedHdr = *hdr;
+            decompressedHdr.flags &= (uint16_t) ~PSA_TCP_MSG_FLAG_COMPRESSED;
+            hdr = &decompressedHdr;
+        }
+        payload = decompressed;
+        payloadSize = decompressedSize;
+    }
+
+    //note the msg fqn is only known by the serializers of the subscribers
+    pubsub_interceptor_msg_header_t interceptorHeader = {hdr->type, NULL, hdr->major, hdr->minor};
+    if (!pubsub_interceptorsHandler_preReceive(receiver->interceptors, &interceptorHeader, payload, payloadSize)) {
+        //dropped by an interceptor
+        free(decompressed);
+        return;
+    }
+
+    //the raw msg is copied once and shared between the dispatch queues of all subscribers
+    pubsub_dispatch_msg_t *msg = NULL;
+    if (receiver->dispatcher != NULL) {
+        msg = pubsub_dispatchMsg_create(hdr, trace != NULL ? sizeof(tracedHdr) : sizeof(*hdr), payload, payloadSize, receiveTime);
+        //conflated per msg type and origin (only used if conflation is configured)
+        unsigned char conflationKey[sizeof(hdr->type) + sizeof(hdr->originUUID)];
+        memcpy(conflationKey, &hdr->type, sizeof(hdr->type));
+        memcpy(conflationKey + sizeof(hdr->type), hdr->originUUID, sizeof(hdr->originUUID));
+        pubsub_dispatchMsg_setConflationKey(msg, conflationKey, sizeof(conflationKey));
+    }
+
     celixThreadMutex_lock(&receiver->subscribers.mutex);
     hash_map_iterator_t iter = hashMapIterator_construct(receiver->subscribers.map);
     while (hashMapIterator_hasNext(&iter)) {
         psa_tcp_subscriber_entry_t *entry = hashMapIterator_nextValue(&iter);
-        if (entry != NULL) {
-            processMsgForSubscriberEntry(receiver, entry, hdr, payload, payloadSize, receiveTime);
+        if (entry != NULL && entry->queue != NULL) {
+            if (!pubsub_dispatchQueue_enqueue(entry->queue, msg)) {
+                L_WARN("[PSA_TCP_TR] Dispatch queue full for scope/topic %s/%s, dropping msg with type id 0x%X", receiver->scope, receiver->topic, hdr->type);
+            }
+        } else if (entry != NULL) {
+            processMsgForSubscriberEntry(receiver, entry, hdr, payload, payloadSize, receiveTime, trace, 0);
         }
     }
     celixThreadMutex_unlock(&receiver->subscribers.mutex);
+
+    pubsub_dispatchMsg_release(msg);
+    pubsub_interceptorsHandler_postReceive(receiver->interceptors, &interceptorHeader, payload, payloadSize);
+    free(decompressed);
+}
+
+/**
+ * Delivers the msgs collected for the subscribers with a batch, called after every socket handler cycle.
+ */
+static void psa_tcp_flushBatches(pubsub_tcp_topic_receiver_t *receiver) {
+    celixThreadMutex_lock(&receiver->subscribers.mutex);
+    hash_map_iterator_t iter = hashMapIterator_construct(receiver->subscribers.map);
+    while (hashMapIterator_hasNext(&iter)) {
+        psa_tcp_subscriber_entry_t *entry = hashMapIterator_nextValue(&iter);
+        pubsub_msgBatch_flush(entry->batch);
+    }
+    celixThreadMutex_unlock(&receiver->subscribers.mutex);
 }
 
 static void *psa_tcp_recvThread(void *data) {
@@ -601,7 +847,13 @@ static void *psa_tcp_recvThread(void *data) {
         if (!allInitialized) {
             psa_tcp_initializeAllSubscribers(receiver);
         }
-        pubsub_tcpHandler_handler(receiver->socketHandler);
+        if (receiver->topicId != 0) {
+            //note the shared socket handler is run by the admin thread
+            usleep(MUX_CONNECT_INTERVAL);
+        } else {
+            pubsub_tcpHandler_handler(receiver->socketHandler);
+            psa_tcp_flushBatches(receiver);
+        }
 
         celixThreadMutex_lock(&receiver->thread.mutex);
         running = receiver->thread.running;
@@ -618,63 +870,48 @@ static void *psa_tcp_recvThread(void *data) {
     return NULL;
 }
 
-pubsub_admin_receiver_metrics_t *pubsub_tcpTopicReceiver_metrics(pubsub_tcp_topic_receiver_t *receiver) {
-    pubsub_admin_receiver_metrics_t *result = calloc(1, sizeof(*result));
-    snprintf(result->scope, PUBSUB_AMDIN_METRICS_NAME_MAX, "%s", receiver->scope);
-    snprintf(result->topic, PUBSUB_AMDIN_METRICS_NAME_MAX, "%s", receiver->topic);
+void pubsub_tcpTopicReceiver_visitMetrics(pubsub_tcp_topic_receiver_t *receiver, const struct timespec *changedSince,
+                                          void *callbackHandle, pubsub_metrics_visit_fp callback) {
+    pubsub_metrics_entry_t metrics;
+    memset(&metrics, 0, sizeof(metrics));
+    metrics.type = PUBSUB_METRICS_RECEIVE_MSG;
+    metrics.psaType = PUBSUB_TCP_ADMIN_TYPE;
+    metrics.scope = receiver->scope;
+    metrics.topic = receiver->topic;
+    pubsub_metrics_histogram_t serializationTime; //copies, the histograms can be updated concurrently
+    pubsub_metrics_histogram_t delay;
+    metrics.serializationTime = &serializationTime;
+    metrics.delay = &delay;
 
-    int msgTypesCount = 0;
     celixThreadMutex_lock(&receiver->subscribers.mutex);
     hash_map_iterator_t iter = hashMapIterator_construct(receiver->subscribers.map);
     while (hashMapIterator_hasNext(&iter)) {
-        psa_tcp_subscriber_entry_t *entry = hashMapIterator_nextValue(&iter);
-        hash_map_iterator_t iter2 = hashMapIterator_construct(entry->metrics);
-        while (hashMapIterator_hasNext(&iter2)) {
-            hashMapIterator_nextValue(&iter2);
-            msgTypesCount += 1;
-        }
-    }
-
-    result->nrOfMsgTypes = (unsigned long) msgTypesCount;
-    result->msgTypes = calloc(msgTypesCount, sizeof(*result->msgTypes));
-    int i = 0;
-    iter = hashMapIterator_construct(receiver->subscribers.map);
-    while (hashMapIterator_hasNext(&iter)) {
-        psa_tcp_subscriber_entry_t *entry = hashMapIterator_nextValue(&iter);
-        hash_map_iterator_t iter2 = hashMapIterator_construct(entry->metrics);
-        while (hashMapIterator_hasNext(&iter2)) {
-            hash_map_t *origins = hashMapIterator_nextValue(&iter2);
-            result->msgTypes[i].origins = calloc((size_t) hashMap_size(origins), sizeof(*(result->msgTypes[i].origins)));
-            result->msgTypes[i].nrOfOrigins = hashMap_size(origins);
-            int k = 0;
-            hash_map_iterator_t iter3 = hashMapIterator_construct(origins);
-            while (hashMapIterator_hasNext(&iter3)) {
-                psa_tcp_subscriber_metrics_entry_t *metrics = hashMapIterator_nextValue(&iter3);
-                result->msgTypes[i].typeId = metrics->msgTypeId;
-                pubsub_msg_serializer_t *msgSer = hashMap_get(entry->msgTypes, (void *) (uintptr_t) metrics->msgTypeId);
-                if (msgSer) {
-                    snprintf(result->msgTypes[i].typeFqn, PUBSUB_AMDIN_METRICS_NAME_MAX, "%s", msgSer->msgName);
-                    uuid_copy(result->msgTypes[i].origins[k].originUUID, metrics->origin);
-                    result->msgTypes[i].origins[k].nrOfMessagesReceived = metrics->nrOfMessagesReceived;
-                    result->msgTypes[i].origins[k].nrOfSerializationErrors = metrics->nrOfSerializationErrors;
-                    result->msgTypes[i].origins[k].averageDelayInSeconds = metrics->averageDelayInSeconds;
-                    result->msgTypes[i].origins[k].maxDelayInSeconds = metrics->maxDelayInSeconds;
-                    result->msgTypes[i].origins[k].minDelayInSeconds = metrics->minDelayInSeconds;
-                    result->msgTypes[i].origins[k].averageTimeBetweenMessagesInSeconds = metrics->averageTimeBetweenMessagesInSeconds;
-                    result->msgTypes[i].origins[k].averageSerializationTimeInSeconds = metrics->averageSerializationTimeInSeconds;
-                    result->msgTypes[i].origins[k].lastMessageReceived = metrics->lastMessageReceived;
-                    result->msgTypes[i].origins[k].nrOfMissingSeqNumbers = metrics->nrOfMissingSeqNumbers;
-
-                    k += 1;
-                } else {
-                    L_WARN("[PSA_TCP]: Error cannot find key 0x%X in msg map during metrics collection!\n", metrics->msgTypeId);
-                }
+        hash_map_entry_t *mapEntry = hashMapIterator_nextEntry(&iter);
+        psa_tcp_subscriber_entry_t *entry = hashMapEntry_getValue(mapEntry);
+        metrics.bndId = (long) (uintptr_t) hashMapEntry_getKey(mapEntry);
+        for (int i = 0; i < METRICS_TABLE_SIZE; ++i) {
+            psa_tcp_subscriber_metrics_entry_t *mEntry = __atomic_load_n(&entry->metrics[i], __ATOMIC_ACQUIRE);
+            if (mEntry == NULL) {
+                continue;
+            }
+            pubsub_msg_serializer_t *msgSer = hashMap_get(entry->msgTypes, (void *) (uintptr_t) mEntry->msgTypeId);
+            metrics.msgFqn = msgSer != NULL ? msgSer->msgName : NULL;
+            metrics.msgTypeId = mEntry->msgTypeId;
+            uuid_copy(metrics.originUUID, mEntry->origin);
+            metrics.nrOfMessages = __atomic_load_n(&mEntry->nrOfMessagesReceived, __ATOMIC_RELAXED);
+            metrics.nrOfSerializationErrors = __atomic_load_n(&mEntry->nrOfSerializationErrors, __ATOMIC_RELAXED);
+            metrics.nrOfMissingSeqNumbers = __atomic_load_n(&mEntry->nrOfMissingSeqNumbers, __ATOMIC_RELAXED);
+            metrics.nrOfMessagesDropped = __atomic_load_n(&mEntry->nrOfMessagesConflated, __ATOMIC_RELAXED);
+            metrics.lastMessage.tv_sec = __atomic_load_n(&mEntry->lastMessageReceived.tv_sec, __ATOMIC_RELAXED);
+            metrics.lastMessage.tv_nsec = __atomic_load_n(&mEntry->lastMessageReceived.tv_nsec, __ATOMIC_RELAXED);
+            if (pubsub_metrics_changedSince(&metrics, changedSince)) {
+                pubsub_metricsHistogram_copy(&serializationTime, &mEntry->serializationTime);
+                pubsub_metricsHistogram_copy(&delay, &mEntry->delay);
+                callback(callbackHandle, &metrics);
             }
-            i += 1;
         }
     }
     celixThreadMutex_unlock(&receiver->subscribers.mutex);
-    return result;
 }
 
 
@@ -686,7 +923,9 @@ static void psa_tcp_connectToAllRequestedConnections(pubsub_tcp_topic_receiver_t
         while (hashMapIterator_hasNext(&iter)) {
             psa_tcp_requested_connection_entry_t *entry = hashMapIterator_nextValue(&iter);
             if (!entry->connected) {
-                entry->fd = pubsub_tcpHandler_connect(entry->parent->socketHandler, entry->url);
+                entry->fd = receiver->topicId != 0 ?
+                            pubsub_tcpHandler_subscribe(receiver->socketHandler, entry->url, receiver->topicId) :
+                            pubsub_tcpHandler_connect(receiver->socketHandler, entry->url);
                 if (entry->fd < 0) {
                     //L_WARN("[PSA_TCP] Error connecting to tcp url %s\n", entry->url);
                     allConnected = false;
@@ -23,6 +23,7 @@
 #include <pubsub_admin_metrics.h>
 #include "celix_bundle_context.h"
 #include "pubsub_tcp_common.h"
+#include "pubsub_tcp_handler.h"
 
 typedef struct pubsub_tcp_topic_receiver pubsub_tcp_topic_receiver_t;
 
@@ -32,12 +33,14 @@ pubsub_tcp_topic_receiver_t* pubsub_tcpTopicReceiver_create(celix_bundle_context
                                                             const char *topic,
                                                             const celix_properties_t *topicProperties,
                                                             pubsub_tcp_endPointStore_t* endPointStore,
+                                                            pubsub_tcpHandler_t *muxHandler,
                                                             long serializerSvcId,
                                                             pubsub_serializer_service_t *serializer);
 void pubsub_tcpTopicReceiver_destroy(pubsub_tcp_topic_receiver_t *receiver);
 
 const char* pubsub_tcpTopicReceiver_scope(pubsub_tcp_topic_receiver_t *receiver);
 const char* pubsub_tcpTopicReceiver_topic(pubsub_tcp_topic_receiver_t *receiver);
+const char* pubsub_tcpTopicReceiver_msgFilter(pubsub_tcp_topic_receiver_t *receiver);
 
 long pubsub_tcpTopicReceiver_serializerSvcId(pubsub_tcp_topic_receiver_t *receiver);
 void pubsub_tcpTopicReceiver_listConnections(pubsub_tcp_topic_receiver_t *receiver, celix_array_list_t *connectedUrls, celix_array_list_t *unconnectedUrls);
@@ -46,7 +49,7 @@ void pubsub_tcpTopicReceiver_connectTo(pubsub_tcp_topic_receiver_t *receiver, co
 void pubsub_tcpTopicReceiver_disconnectFrom(pubsub_tcp_topic_receiver_t *receiver, const char *url);
 
 
-pubsub_admin_receiver_metrics_t* pubsub_tcpTopicReceiver_metrics(pubsub_tcp_topic_receiver_t *receiver);
+void pubsub_tcpTopicReceiver_visitMetrics(pubsub_tcp_topic_receiver_t *receiver, const struct timespec *changedSince, void *callbackHandle, pubsub_metrics_visit_fp callback);
 
 
 #endif //CELIX_PUBSUB_TCP_TOPIC_RECEIVER_H
@@ -26,6 +26,11 @@
 #include <zconf.h>
 #include <arpa/inet.h>
 #include <log_helper.h>
+#include <pubsub_msg_loan_pool.h>
+#include <pubsub_compression.h>
+#include <pubsub_msg_filters.h>
+#include <pubsub_trace.h>
+#include <pubsub_interceptors_handler.h>
 #include "pubsub_tcp_topic_sender.h"
 #include "pubsub_tcp_handler.h"
 #include "pubsub_psa_tcp_constants.h"
@@ -33,10 +38,12 @@
 #include "pubsub_endpoint.h"
 #include <uuid/uuid.h>
 #include "celix_constants.h"
+#include "celix_hash_map.h"
 #include <signal.h>
+#include "celix_probes.h"
 
-#define FIRST_SEND_DELAY_IN_SECONDS             2
 #define TCP_BIND_MAX_RETRY                      10
+#define PSA_TCP_MAX_POOLED_LOANS                16
 
 #define L_DEBUG(...) \
     logHelper_log(sender->logHelper, OSGI_LOGSERVICE_DEBUG, __VA_ARGS__)
@@ -62,6 +69,18 @@ struct pubsub_tcp_topic_sender {
     char scopeAndTopicFilter[5];
     char *url;
     bool isStatic;
+    uint32_t topicId; //0 if the topic is not multiplexed over the shared admin socket handler
+    char *lastValueKeyField; //msg field keying the last value cache, NULL if only the last msg per msg type is cached
+    pubsub_msg_loan_pool_t *loanPool;
+    pubsub_compressor_t *compressor; //NULL if the msgs are not compressed
+    pubsub_msg_filters_t *msgFilters; //NULL for static senders, the subscribers of a static sender are unknown
+    pubsub_tracer_t *tracer; //NULL if tracing is disabled
+    pubsub_interceptors_handler_t *interceptors;
+
+    unsigned int nrOfPartitions; //1 if the topic is not partitioned
+    struct psa_tcp_partition *partitions; //partitions 1..nrOfPartitions-1, partition 0 is the socketHandler
+    char *partitionKeyField; //msg field keying the partition, NULL if all msgs are sent over the first partition
+    char *partitionUrls; //urls of all partitions, NULL if the topic is not partitioned
 
     struct {
         celix_thread_t thread;
@@ -80,6 +99,12 @@ struct pubsub_tcp_topic_sender {
     } boundedServices;
 };
 
+typedef struct psa_tcp_partition {
+    pubsub_tcp_topic_sender_t *sender;
+    pubsub_tcpHandler_t *handler;
+    celix_thread_t thread; //runs the handler of the partition
+} psa_tcp_partition_t;
+
 typedef struct psa_tcp_send_msg_entry {
     pubsub_tcp_msg_header_t header; //partially filled header (only seqnr and time needs to be updated per send)
     pubsub_msg_serializer_t *msgSer;
@@ -87,12 +112,11 @@ typedef struct psa_tcp_send_msg_entry {
     int seqNr;
     struct {
         celix_thread_mutex_t mutex; //protects entries in struct
-        long nrOfMessagesSend;
-        long nrOfMessagesSendFailed;
-        long nrOfSerializationErrors;
+        unsigned long nrOfMessagesSend;
+        unsigned long nrOfMessagesSendFailed;
+        unsigned long nrOfSerializationErrors;
         struct timespec lastMessageSend;
-        double averageTimeBetweenMessagesInSeconds;
-        double averageSerializationTimeInSeconds;
+        pubsub_metrics_histogram_t serializationTime;
     } metrics;
 } psa_tcp_send_msg_entry_t;
 
@@ -102,7 +126,7 @@ typedef struct psa_tcp_bounded_service_entry {
     long bndId;
     hash_map_t *msgTypes; //key = msg type id, value = pubsub_msg_serializer_t
     hash_map_t *msgTypeIds; // key = msg name, value = msg type id
-    hash_map_t *msgEntries; //key = msg type id, value = psa_tcp_send_msg_entry_t
+    celix_long_hash_map_t *msgEntries; //key = msg type id, value = psa_tcp_send_msg_entry_t*
     int getCount;
 } psa_tcp_bounded_service_entry_t;
 
@@ -110,9 +134,21 @@ static int psa_tcp_localMsgTypeIdForMsgType(void *handle, const char *msgType, u
 static void *psa_tcp_getPublisherService(void *handle, const celix_bundle_t *requestingBundle, const celix_properties_t *svcProperties);
 static void psa_tcp_ungetPublisherService(void *handle, const celix_bundle_t *requestingBundle, const celix_properties_t *svcProperties);
 static unsigned int rand_range(unsigned int min, unsigned int max);
-static void delay_first_send_for_late_joiners(pubsub_tcp_topic_sender_t *sender);
+static uint32_t psa_tcp_fieldKey(const pubsub_msg_serializer_t *msgSer, const char *field, const void *msg);
+static char *psa_tcp_listen(pubsub_tcp_topic_sender_t *sender, pubsub_tcpHandler_t *handler, const char *bindIP, unsigned int basePort, unsigned int maxPort);
+static void psa_tcp_createPartitions(pubsub_tcp_topic_sender_t *sender, const celix_properties_t *topicProperties, unsigned int nrOfPartitions,
+                                     const char *bindIP, unsigned int basePort, unsigned int maxPort);
 static void *psa_tcp_sendThread(void *data);
+static void *psa_tcp_partitionThread(void *data);
+static unsigned int psa_tcp_partitionOf(pubsub_tcp_topic_sender_t *sender, const pubsub_msg_serializer_t *msgSer, const void *msg);
+static pubsub_tcpHandler_t *psa_tcp_partitionHandler(pubsub_tcp_topic_sender_t *sender, unsigned int partition);
+static celix_status_t psa_tcp_sortByPartition(pubsub_tcp_topic_sender_t *sender, const pubsub_msg_serializer_t *msgSer, const void **msgs, size_t n,
+                                              const void **sortedMsgs, unsigned int *partitions);
 static int psa_tcp_topicPublicationSend(void *handle, unsigned int msgTypeId, const void *msg);
+static int psa_tcp_topicPublicationSendMany(void *handle, unsigned int msgTypeId, const void **msgs, size_t n);
+static void *psa_tcp_topicPublicationLoanMsg(void *handle, unsigned int msgTypeId);
+static int psa_tcp_topicPublicationSendLoanedMsg(void *handle, unsigned int msgTypeId, void *loanedMsg);
+static void psa_tcp_topicPublicationReturnLoanedMsg(void *handle, unsigned int msgTypeId, void *loanedMsg);
 
 pubsub_tcp_topic_sender_t *pubsub_tcpTopicSender_create(
         celix_bundle_context_t *ctx,
@@ -121,6 +157,7 @@ pubsub_tcp_topic_sender_t *pubsub_tcpTopicSender_create(
         const char *topic,
         const celix_properties_t *topicProperties,
         pubsub_tcp_endPointStore_t *endPointStore,
+        pubsub_tcpHandler_t *muxHandler,
         long serializerSvcId,
         pubsub_serializer_service_t *ser,
         const char *bindIP,
@@ -132,20 +169,52 @@ pubsub_tcp_topic_sender_t *pubsub_tcpTopicSender_create(
     sender->logHelper = logHelper;
     sender->serializerSvcId = serializerSvcId;
     sender->serializer = ser;
-    sender->socketHandler = pubsub_tcpHandler_create(sender->logHelper);
+    sender->nrOfPartitions = 1;
+    //note static and header less topics are never multiplexed, their peers expect a dedicated connection
+    bool multiplexed = muxHandler != NULL && staticBindUrl == NULL &&
+                       celix_properties_get(topicProperties, PUBSUB_TCP_STATIC_ENDPOINT_TYPE, NULL) == NULL &&
+                       (topicProperties == NULL || !celix_properties_getAsBool((celix_properties_t *) topicProperties, PUBSUB_TCP_BYPASS_HEADER, PUBSUB_TCP_DEFAULT_BYPASS_HEADER));
+    if (multiplexed) {
+        sender->socketHandler = muxHandler;
+        sender->sharedSocketHandler = muxHandler;
+        sender->topicId = psa_tcp_topicId(scope, topic);
+    } else {
+        sender->socketHandler = pubsub_tcpHandler_create(sender->logHelper);
+        pubsub_tcpHandler_setIoUring(sender->socketHandler, celix_bundleContext_getPropertyAsBool(ctx, PSA_TCP_IO_URING, PSA_TCP_DEFAULT_IO_URING));
+        pubsub_tcpHandler_setThreads(sender->socketHandler,
+                                     (unsigned int) celix_bundleContext_getPropertyAsLong(ctx, PSA_TCP_HANDLER_THREADS, PSA_TCP_DEFAULT_HANDLER_THREADS),
+                                     celix_bundleContext_getPropertyAsBool(ctx, PSA_TCP_REUSE_PORT, PSA_TCP_DEFAULT_REUSE_PORT));
+    }
     psa_tcp_setScopeAndTopicFilter(scope, topic, sender->scopeAndTopicFilter);
     const char *uuid = celix_bundleContext_getProperty(ctx, OSGI_FRAMEWORK_FRAMEWORK_UUID, NULL);
     if (uuid != NULL) {
         uuid_parse(uuid, sender->fwUUID);
     }
     sender->metricsEnabled   = celix_bundleContext_getPropertyAsBool(ctx, PSA_TCP_METRICS_ENABLED, PSA_TCP_DEFAULT_METRICS_ENABLED);
-    if (topicProperties != NULL) {
+    if (topicProperties != NULL && !multiplexed) {
         bool blocking     = celix_properties_getAsBool((celix_properties_t *) topicProperties, PUBSUB_TCP_PUBLISHER_BLOCKING_KEY, PUBSUB_TCP_PUBLISHER_BLOCKING_DEFAULT);
         bool bypassHeader = celix_properties_getAsBool((celix_properties_t *) topicProperties, PUBSUB_TCP_BYPASS_HEADER, PUBSUB_TCP_DEFAULT_BYPASS_HEADER);
         long msgIdOffset  = celix_properties_getAsLong(topicProperties, PUBSUB_TCP_MESSAGE_ID_OFFSET, PUBSUB_TCP_DEFAULT_MESSAGE_ID_OFFSET);
         long msgIdSize    = celix_properties_getAsLong(topicProperties, PUBSUB_TCP_MESSAGE_ID_SIZE,   PUBSUB_TCP_DEFAULT_MESSAGE_ID_SIZE);
         pubsub_tcpHandler_setBypassHeader(sender->socketHandler, bypassHeader, (unsigned int)msgIdOffset, (unsigned int)msgIdSize);
         pubsub_tcpHandler_setBlockingWrite(sender->socketHandler, blocking);
+        //note without header a compressed payload cannot be flagged
+        sender->compressor = bypassHeader ? NULL : pubsub_compressor_create(topicProperties);
+        long sendQueueSize = celix_properties_getAsLong(topicProperties, PUBSUB_SEND_QUEUE_SIZE_KEY, PUBSUB_SEND_QUEUE_SIZE_DEFAULT);
+        pubsub_tcpHandler_setSendQueue(sender->socketHandler, pubsub_utils_getSendQueuePolicy(topicProperties), (size_t) sendQueueSize);
+        long lastValueCacheSize = celix_properties_getAsLong(topicProperties, PUBSUB_LAST_VALUE_CACHE_SIZE_KEY, PUBSUB_LAST_VALUE_CACHE_SIZE_DEFAULT);
+        if (lastValueCacheSize > 0) {
+            pubsub_tcpHandler_setLastValueCache(sender->socketHandler, (size_t) lastValueCacheSize);
+            const char *keyField = celix_properties_get(topicProperties, PUBSUB_LAST_VALUE_CACHE_KEY, NULL);
+            sender->lastValueKeyField = keyField == NULL ? NULL : strndup(keyField, 1024);
+        }
+    }
+    if (multiplexed) {
+        sender->compressor = pubsub_compressor_create(topicProperties);
+    }
+    //note without header a traced msg cannot be flagged
+    if (topicProperties == NULL || !celix_properties_getAsBool((celix_properties_t *) topicProperties, PUBSUB_TCP_BYPASS_HEADER, PUBSUB_TCP_DEFAULT_BYPASS_HEADER)) {
+        sender->tracer = pubsub_tracer_create(ctx, PUBSUB_TCP_ADMIN_TYPE, scope, topic);
     }
     /* Check if it's a static endpoint */
     bool isEndPointTypeClient = false;
@@ -177,7 +246,10 @@ pubsub_tcp_topic_sender_t *pubsub_tcpTopicSender_create(
 
     //setting up tcp socket for TCP TopicSender
     {
-        if (staticConnectUrls != NULL) {
+        if (multiplexed) {
+            //note the admin listens for all multiplexed topics
+            sender->url = strndup(pubsub_tcpHandler_url(muxHandler), 1024 * 1024);
+        } else if (staticConnectUrls != NULL) {
             // Store url for client static endpoint
             sender->url = strndup(staticConnectUrls, 1024 * 1024);
             sender->isStatic = true;
@@ -190,21 +262,11 @@ pubsub_tcp_topic_sender_t *pubsub_tcpTopicSender_create(
                 sender->isStatic = true;
             }
         } else {
-            int retry = 0;
-            while (sender->url == NULL && retry < TCP_BIND_MAX_RETRY) {
-                /* Randomized part due to same bundle publishing on different topics */
-                unsigned int port = rand_range(basePort, maxPort);
-                char *url = NULL;
-                if (bindIP == NULL) asprintf(&url, "tcp://0.0.0.0:%u", port);
-                else asprintf(&url, "tcp://%s:%u", bindIP, port);
-                int rv = pubsub_tcpHandler_listen(sender->socketHandler, url);
-                if (rv == -1) {
-                    L_WARN("Error for tcp_bind using dynamic bind url '%s'. %s", url, strerror(errno));
-                    free(url);
-                } else {
-                    sender->url = url;
-                }
-                retry++;
+            sender->url = psa_tcp_listen(sender, sender->socketHandler, bindIP, basePort, maxPort);
+            long nrOfPartitions = topicProperties == NULL ? PUBSUB_PARTITIONS_DEFAULT :
+                                  celix_properties_getAsLong(topicProperties, PUBSUB_PARTITIONS_KEY, PUBSUB_PARTITIONS_DEFAULT);
+            if (sender->url != NULL && nrOfPartitions > 1) {
+                psa_tcp_createPartitions(sender, topicProperties, (unsigned int) nrOfPartitions, bindIP, basePort, maxPort);
             }
         }
     }
@@ -212,19 +274,29 @@ pubsub_tcp_topic_sender_t *pubsub_tcpTopicSender_create(
     if (sender->url != NULL) {
         sender->scope = strndup(scope, 1024 * 1024);
         sender->topic = strndup(topic, 1024 * 1024);
+        sender->loanPool = pubsub_msgLoanPool_create(PSA_TCP_MAX_POOLED_LOANS);
+        sender->msgFilters = sender->isStatic ? NULL : pubsub_msgFilters_create();
+        sender->interceptors = pubsub_interceptorsHandler_create(ctx, PUBSUB_TCP_ADMIN_TYPE, scope, topic);
 
         celixThreadMutex_create(&sender->boundedServices.mutex, NULL);
         celixThreadMutex_create(&sender->thread.mutex, NULL);
         sender->boundedServices.map = hashMap_create(NULL, NULL, NULL, NULL);
     }
 
-    if (sender->socketHandler != NULL) {
+    if (sender->socketHandler != NULL && !multiplexed) {
         sender->thread.running = true;
         celixThread_create(&sender->thread.thread, NULL, psa_tcp_sendThread, sender);
         char name[64];
         snprintf(name, 64, "TCP TS %s/%s", scope, topic);
         celixThread_setName(&sender->thread.thread, name);
         psa_tcp_setupTcpContext(sender->logHelper, &sender->thread.thread, topicProperties);
+        for (unsigned int i = 1; i < sender->nrOfPartitions; ++i) {
+            psa_tcp_partition_t *partition = &sender->partitions[i - 1];
+            celixThread_create(&partition->thread, NULL, psa_tcp_partitionThread, partition);
+            snprintf(name, 64, "TCP TS %s/%s #%u", scope, topic, i);
+            celixThread_setName(&partition->thread, name);
+            psa_tcp_setupTcpContext(sender->logHelper, &partition->thread, topicProperties);
+        }
     }
 
 
@@ -248,6 +320,8 @@ pubsub_tcp_topic_sender_t *pubsub_tcpTopicSender_create(
     }
 
     if (sender->url == NULL) {
+        pubsub_compressor_destroy(sender->compressor);
+        pubsub_tracer_destroy(sender->tracer);
         free(sender);
         sender = NULL;
     }
@@ -262,6 +336,12 @@ void pubsub_tcpTopicSender_destroy(pubsub_tcp_topic_sender_t *sender) {
             sender->thread.running = false;
             celixThreadMutex_unlock(&sender->thread.mutex);
             celixThread_join(sender->thread.thread, NULL);
+            for (unsigned int i = 1; i < sender->nrOfPartitions; ++i) {
+                celixThread_join(sender->partitions[i - 1].thread, NULL);
+            }
+        } else {
+            //note multiplexed senders have no send thread
+            celixThreadMutex_unlock(&sender->thread.mutex);
         }
         celix_bundleContext_unregisterService(sender->ctx, sender->publisher.svcId);
 
@@ -271,13 +351,12 @@ void pubsub_tcpTopicSender_destroy(pubsub_tcp_topic_sender_t *sender) {
             psa_tcp_bounded_service_entry_t *entry = hashMapIterator_nextValue(&iter);
             if (entry != NULL) {
                 sender->serializer->destroySerializerMap(sender->serializer->handle, entry->msgTypes);
-                hash_map_iterator_t iter2 = hashMapIterator_construct(entry->msgEntries);
-                while (hashMapIterator_hasNext(&iter2)) {
-                    psa_tcp_send_msg_entry_t *msgEntry = hashMapIterator_nextValue(&iter2);
+                for (celix_long_hash_map_iterator_t iter2 = celix_longHashMap_begin(entry->msgEntries); !celix_longHashMapIterator_isEnd(&iter2); celix_longHashMapIterator_next(&iter2)) {
+                    psa_tcp_send_msg_entry_t *msgEntry = iter2.value;
                     celixThreadMutex_destroy(&msgEntry->metrics.mutex);
                     free(msgEntry);
                 }
-                hashMap_destroy(entry->msgEntries, false, false);
+                celix_longHashMap_destroy(entry->msgEntries);
                 free(entry);
             }
         }
@@ -290,10 +369,22 @@ void pubsub_tcpTopicSender_destroy(pubsub_tcp_topic_sender_t *sender) {
             pubsub_tcpHandler_destroy(sender->socketHandler);
             sender->socketHandler = NULL;
         }
+        for (unsigned int i = 1; i < sender->nrOfPartitions; ++i) {
+            pubsub_tcpHandler_destroy(sender->partitions[i - 1].handler);
+        }
 
+        pubsub_msgLoanPool_destroy(sender->loanPool);
+        pubsub_compressor_destroy(sender->compressor);
+        pubsub_msgFilters_destroy(sender->msgFilters);
+        pubsub_tracer_destroy(sender->tracer);
+        pubsub_interceptorsHandler_destroy(sender->interceptors);
         free(sender->scope);
         free(sender->topic);
         free(sender->url);
+        free(sender->lastValueKeyField);
+        free(sender->partitions);
+        free(sender->partitionKeyField);
+        free(sender->partitionUrls);
         free(sender);
     }
 }
@@ -311,7 +402,8 @@ const char *pubsub_tcpTopicSender_topic(pubsub_tcp_topic_sender_t *sender) {
 }
 
 const char *pubsub_tcpTopicSender_url(pubsub_tcp_topic_sender_t *sender) {
-    return pubsub_tcpHandler_url(sender->socketHandler);
+    //note the url of a partitioned topic is the space separated list of the urls of its partitions
+    return sender->partitionUrls != NULL ? sender->partitionUrls : pubsub_tcpHandler_url(sender->socketHandler);
 }
 
 bool pubsub_tcpTopicSender_isStatic(pubsub_tcp_topic_sender_t *sender) {
@@ -326,6 +418,18 @@ void pubsub_tcpTopicSender_disconnectFrom(pubsub_tcp_topic_sender_t *sender, con
     //TODO
 }
 
+void pubsub_tcpTopicSender_addMsgFilter(pubsub_tcp_topic_sender_t *sender, const char *endpointUUID, const char *msgFilter) {
+    if (sender->msgFilters != NULL) {
+        pubsub_msgFilters_add(sender->msgFilters, endpointUUID, msgFilter);
+    }
+}
+
+void pubsub_tcpTopicSender_removeMsgFilter(pubsub_tcp_topic_sender_t *sender, const char *endpointUUID) {
+    if (sender->msgFilters != NULL) {
+        pubsub_msgFilters_remove(sender->msgFilters, endpointUUID);
+    }
+}
+
 static int psa_tcp_localMsgTypeIdForMsgType(void *handle, const char *msgType, unsigned int *msgTypeId) {
     psa_tcp_bounded_service_entry_t *entry = (psa_tcp_bounded_service_entry_t *) handle;
     *msgTypeId = (unsigned int)(uintptr_t) hashMap_get(entry->msgTypeIds, msgType);
@@ -346,7 +450,7 @@ static void *psa_tcp_getPublisherService(void *handle, const celix_bundle_t *req
         entry->getCount = 1;
         entry->parent = sender;
         entry->bndId = bndId;
-        entry->msgEntries = hashMap_create(NULL, NULL, NULL, NULL);
+        entry->msgEntries = celix_longHashMap_create();
         entry->msgTypeIds = hashMap_create(utils_stringHash, NULL, utils_stringEquals, NULL);
 
         int rc = sender->serializer->createSerializerMap(sender->serializer->handle, (celix_bundle_t *) requestingBundle, &entry->msgTypes);
@@ -365,13 +469,18 @@ static void *psa_tcp_getPublisherService(void *handle, const celix_bundle_t *req
                 sendEntry->header.major = (int8_t) major;
                 sendEntry->header.minor = (int8_t) minor;
                 uuid_copy(sendEntry->header.originUUID, sender->fwUUID);
+                sendEntry->header.topicId = sender->topicId;
                 celixThreadMutex_create(&sendEntry->metrics.mutex, NULL);
-                hashMap_put(entry->msgEntries, key, sendEntry);
+                celix_longHashMap_put(entry->msgEntries, (long)(uintptr_t)key, sendEntry);
                 hashMap_put(entry->msgTypeIds, strndup(sendEntry->msgSer->msgName, 1024), (void *)(uintptr_t) sendEntry->msgSer->msgId);
             }
             entry->service.handle = entry;
             entry->service.localMsgTypeIdForMsgType = psa_tcp_localMsgTypeIdForMsgType;
             entry->service.send = psa_tcp_topicPublicationSend;
+            entry->service.sendMany = psa_tcp_topicPublicationSendMany;
+            entry->service.loanMsg = psa_tcp_topicPublicationLoanMsg;
+            entry->service.sendLoanedMsg = psa_tcp_topicPublicationSendLoanedMsg;
+            entry->service.returnLoanedMsg = psa_tcp_topicPublicationReturnLoanedMsg;
             hashMap_put(sender->boundedServices.map, (void *) bndId, entry);
         } else {
             L_ERROR("Error creating serializer map for TCP TopicSender %s/%s", sender->scope, sender->topic);
@@ -400,13 +509,12 @@ static void psa_tcp_ungetPublisherService(void *handle, const celix_bundle_t *re
             L_ERROR("Error destroying publisher service, serializer not available / cannot get msg serializer map\n");
         }
 
-        hash_map_iterator_t iter = hashMapIterator_construct(entry->msgEntries);
-        while (hashMapIterator_hasNext(&iter)) {
-            psa_tcp_send_msg_entry_t *msgEntry = hashMapIterator_nextValue(&iter);
+        for (celix_long_hash_map_iterator_t iter = celix_longHashMap_begin(entry->msgEntries); !celix_longHashMapIterator_isEnd(&iter); celix_longHashMapIterator_next(&iter)) {
+            psa_tcp_send_msg_entry_t *msgEntry = iter.value;
             celixThreadMutex_destroy(&msgEntry->metrics.mutex);
             free(msgEntry);
         }
-        hashMap_destroy(entry->msgEntries, false, false);
+        celix_longHashMap_destroy(entry->msgEntries);
 
         hashMap_destroy(entry->msgTypeIds, true, false);
         free(entry);
@@ -432,139 +540,304 @@ static void *psa_tcp_sendThread(void *data) {
     return NULL;
 }
 
-pubsub_admin_sender_metrics_t *pubsub_tcpTopicSender_metrics(pubsub_tcp_topic_sender_t *sender) {
-    pubsub_admin_sender_metrics_t *result = calloc(1, sizeof(*result));
-    snprintf(result->scope, PUBSUB_AMDIN_METRICS_NAME_MAX, "%s", sender->scope);
-    snprintf(result->topic, PUBSUB_AMDIN_METRICS_NAME_MAX, "%s", sender->topic);
-    celixThreadMutex_lock(&sender->boundedServices.mutex);
-    size_t count = 0;
-    hash_map_iterator_t iter = hashMapIterator_construct(sender->boundedServices.map);
-    while (hashMapIterator_hasNext(&iter)) {
-        psa_tcp_bounded_service_entry_t *entry = hashMapIterator_nextValue(&iter);
-        hash_map_iterator_t iter2 = hashMapIterator_construct(entry->msgEntries);
-        while (hashMapIterator_hasNext(&iter2)) {
-            hashMapIterator_nextValue(&iter2);
-            count += 1;
-        }
-    }
+static void *psa_tcp_partitionThread(void *data) {
+    psa_tcp_partition_t *partition = data;
+    pubsub_tcp_topic_sender_t *sender = partition->sender;
 
-    result->msgMetrics = calloc(count, sizeof(*result));
+    celixThreadMutex_lock(&sender->thread.mutex);
+    bool running = sender->thread.running;
+    celixThreadMutex_unlock(&sender->thread.mutex);
 
-    iter = hashMapIterator_construct(sender->boundedServices.map);
-    int i = 0;
+    while (running) {
+        pubsub_tcpHandler_handler(partition->handler);
+
+        celixThreadMutex_lock(&sender->thread.mutex);
+        running = sender->thread.running;
+        celixThreadMutex_unlock(&sender->thread.mutex);
+    }
+    return NULL;
+}
+
+void pubsub_tcpTopicSender_visitMetrics(pubsub_tcp_topic_sender_t *sender, const struct timespec *changedSince,
+                                        void *callbackHandle, pubsub_metrics_visit_fp callback) {
+    pubsub_metrics_entry_t metrics;
+    memset(&metrics, 0, sizeof(metrics));
+    metrics.type = PUBSUB_METRICS_TOPIC_SENDER;
+    metrics.psaType = PUBSUB_TCP_ADMIN_TYPE;
+    metrics.scope = sender->scope;
+    metrics.topic = sender->topic;
+    metrics.bndId = -1L;
+    pubsub_tcpHandler_sendQueueMetrics(sender->socketHandler, &metrics.sendQueueSize, &metrics.maxSendQueueSize,
+                                       &metrics.nrOfMessagesDropped);
+    callback(callbackHandle, &metrics);
+
+    metrics.type = PUBSUB_METRICS_SEND_MSG;
+    metrics.sendQueueSize = 0;
+    metrics.maxSendQueueSize = 0;
+    metrics.nrOfMessagesDropped = 0;
+    celixThreadMutex_lock(&sender->boundedServices.mutex);
+    hash_map_iterator_t iter = hashMapIterator_construct(sender->boundedServices.map);
     while (hashMapIterator_hasNext(&iter)) {
         psa_tcp_bounded_service_entry_t *entry = hashMapIterator_nextValue(&iter);
-        hash_map_iterator_t iter2 = hashMapIterator_construct(entry->msgEntries);
-        while (hashMapIterator_hasNext(&iter2)) {
-            psa_tcp_send_msg_entry_t *mEntry = hashMapIterator_nextValue(&iter2);
+        for (celix_long_hash_map_iterator_t iter2 = celix_longHashMap_begin(entry->msgEntries); !celix_longHashMapIterator_isEnd(&iter2); celix_longHashMapIterator_next(&iter2)) {
+            psa_tcp_send_msg_entry_t *mEntry = iter2.value;
             celixThreadMutex_lock(&mEntry->metrics.mutex);
-            result->msgMetrics[i].nrOfMessagesSend = mEntry->metrics.nrOfMessagesSend;
-            result->msgMetrics[i].nrOfMessagesSendFailed = mEntry->metrics.nrOfMessagesSendFailed;
-            result->msgMetrics[i].nrOfSerializationErrors = mEntry->metrics.nrOfSerializationErrors;
-            result->msgMetrics[i].averageSerializationTimeInSeconds = mEntry->metrics.averageSerializationTimeInSeconds;
-            result->msgMetrics[i].averageTimeBetweenMessagesInSeconds = mEntry->metrics.averageTimeBetweenMessagesInSeconds;
-            result->msgMetrics[i].lastMessageSend = mEntry->metrics.lastMessageSend;
-            result->msgMetrics[i].bndId = entry->bndId;
-            result->msgMetrics[i].typeId = mEntry->header.type;
-            snprintf(result->msgMetrics[i].typeFqn, PUBSUB_AMDIN_METRICS_NAME_MAX, "%s", mEntry->msgSer->msgName);
-            i += 1;
+            metrics.msgFqn = mEntry->msgSer->msgName;
+            metrics.msgTypeId = mEntry->header.type;
+            metrics.bndId = entry->bndId;
+            metrics.nrOfMessages = mEntry->metrics.nrOfMessagesSend;
+            metrics.nrOfMessagesFailed = mEntry->metrics.nrOfMessagesSendFailed;
+            metrics.nrOfSerializationErrors = mEntry->metrics.nrOfSerializationErrors;
+            metrics.lastMessage = mEntry->metrics.lastMessageSend;
+            metrics.serializationTime = &mEntry->metrics.serializationTime;
+            if (pubsub_metrics_changedSince(&metrics, changedSince)) {
+                callback(callbackHandle, &metrics);
+            }
             celixThreadMutex_unlock(&mEntry->metrics.mutex);
         }
     }
-
     celixThreadMutex_unlock(&sender->boundedServices.mutex);
-    result->nrOfmsgMetrics = (int) count;
-    return result;
 }
 
 static int psa_tcp_topicPublicationSend(void *handle, unsigned int msgTypeId, const void *inMsg) {
+    return psa_tcp_topicPublicationSendMany(handle, msgTypeId, &inMsg, 1);
+}
+
+//
+// Serializes msg as io vectors, appended to the vectors after the used ones. The vectors grow when needed.
+//
+static celix_status_t psa_tcp_serializeVec(pubsub_msg_serializer_t *msgSer, const void *msg, struct iovec **vectors,
+                                           size_t *capacity, size_t used, size_t *nrOfVectors, void **owned) {
+    *nrOfVectors = *capacity - used;
+    celix_status_t rc = msgSer->serializeVec(msgSer->handle, msg, *vectors + used, nrOfVectors, owned);
+    if (rc == CELIX_ILLEGAL_ARGUMENT && *nrOfVectors > *capacity - used) {
+        size_t newCapacity = 2 * (used + *nrOfVectors);
+        struct iovec *newVectors = realloc(*vectors, newCapacity * sizeof(*newVectors));
+        if (newVectors == NULL) {
+            return CELIX_ENOMEM;
+        }
+        *vectors = newVectors;
+        *capacity = newCapacity;
+        *nrOfVectors = *capacity - used;
+        rc = msgSer->serializeVec(msgSer->handle, msg, *vectors + used, nrOfVectors, owned);
+    }
+    return rc;
+}
+
+static int psa_tcp_topicPublicationSendMany(void *handle, unsigned int msgTypeId, const void **inMsgs, size_t n) {
     int status = CELIX_SUCCESS;
     psa_tcp_bounded_service_entry_t *bound = handle;
     pubsub_tcp_topic_sender_t *sender = bound->parent;
+    CELIX_PROBE4(psa_send, PUBSUB_TCP_ADMIN_TYPE, sender->topic, msgTypeId, n);
     bool monitor = sender->metricsEnabled;
 
-    psa_tcp_send_msg_entry_t *entry = hashMap_get(bound->msgEntries, (void *) (uintptr_t)(msgTypeId));
+    psa_tcp_send_msg_entry_t *entry = celix_longHashMap_get(bound->msgEntries, (long)msgTypeId);
+    if (entry == NULL) {
+        //unknownMessageCountUpdate = 1;
+        L_WARN("[PSA_TCP_TS] Error cannot serialize message with msg type id %i for scope/topic %s/%s", msgTypeId,
+               sender->scope, sender->topic);
+        return CELIX_SERVICE_EXCEPTION;
+    }
 
     //metrics updates
-    struct timespec sendTime;
+    struct timespec sendTime = {0, 0};
     struct timespec serializationStart;
     struct timespec serializationEnd;
-    //int unknownMessageCountUpdate = 0;
     int sendErrorUpdate = 0;
     int serializationErrorUpdate = 0;
     int sendCountUpdate = 0;
 
-    if (entry != NULL) {
-        delay_first_send_for_late_joiners(sender);
-        if (monitor) {
-            clock_gettime(CLOCK_REALTIME, &serializationStart);
+    pubsub_tcp_msg_header_t *headers = calloc(n, sizeof(*headers));
+    void **serializedOutputs = calloc(n, sizeof(*serializedOutputs));
+    unsigned int *serializedOutputLens = calloc(n, sizeof(*serializedOutputLens));
+    bool *compressed = calloc(n, sizeof(*compressed));
+    pubsub_trace_context_t *traces = sender->tracer != NULL ? calloc(n, sizeof(*traces)) : NULL;
+    bool *traced = sender->tracer != NULL ? calloc(n, sizeof(*traced)) : NULL;
+    uint32_t *keys = sender->lastValueKeyField != NULL ? calloc(n, sizeof(*keys)) : NULL;
+    //note the serialized sizes are kept for the postSend interceptors, the outputs can be compressed and traced
+    bool intercept = pubsub_interceptorsHandler_isActive(sender->interceptors);
+    size_t *serializedMsgLens = intercept ? calloc(n, sizeof(*serializedMsgLens)) : NULL;
+    pubsub_interceptor_msg_header_t interceptorHeader = {entry->header.type, entry->msgSer->msgName, entry->header.major, entry->header.minor};
+    //note scatter/gather serialization writes the msgs without copying them into a buffer, only possible if the
+    //serialized msgs are not compressed, traced or handed to interceptors
+    bool vectored = entry->msgSer->serializeVec != NULL && sender->compressor == NULL && sender->tracer == NULL && !intercept;
+    size_t vectorCapacity = vectored ? 2 * n : 0;
+    struct iovec *vectors = vectored ? malloc(vectorCapacity * sizeof(*vectors)) : NULL;
+    size_t *nrOfVectors = vectored ? calloc(n, sizeof(*nrOfVectors)) : NULL;
+    vectored = vectored && vectors != NULL && nrOfVectors != NULL;
+    size_t nrOfUsedVectors = 0;
+    size_t nrOfSerializedMsgs = 0;
+    size_t nrOfFilteredMsgs = 0;
+    //note the msgs of a partitioned topic are sorted by partition, so the msgs of a partition are written with a
+    //single call
+    const void **msgs = inMsgs;
+    unsigned int *partitions = NULL; //partition of every serialized msg, NULL if the topic is not partitioned
+    if (sender->nrOfPartitions > 1 && n > 0) {
+        msgs = malloc(n * sizeof(*msgs));
+        partitions = malloc(n * sizeof(*partitions));
+        if (msgs == NULL || partitions == NULL || psa_tcp_sortByPartition(sender, entry->msgSer, inMsgs, n, msgs, partitions) != CELIX_SUCCESS) {
+            //note send unsorted over the first partition
+            free(msgs);
+            free(partitions);
+            msgs = inMsgs;
+            partitions = NULL;
         }
+    }
 
+    if (monitor) {
+        clock_gettime(CLOCK_REALTIME, &serializationStart);
+    }
+    for (size_t i = 0; i < n; ++i) {
+        if (!pubsub_msgFilters_match(sender->msgFilters, entry->msgSer, msgs[i])) {
+            //not needed by any subscriber
+            nrOfFilteredMsgs += 1;
+            continue;
+        }
+        bool trace = pubsub_tracer_sample(sender->tracer);
+        if (trace) {
+            pubsub_tracer_initContext(sender->tracer, &traces[nrOfSerializedMsgs]);
+            traces[nrOfSerializedMsgs].serializeStart = pubsub_trace_now();
+        }
         void *serializedOutput = NULL;
         size_t serializedOutputLen = 0;
-        status = entry->msgSer->serialize(entry->msgSer->handle, inMsg, &serializedOutput, &serializedOutputLen);
-
-        if (monitor) {
-            clock_gettime(CLOCK_REALTIME, &serializationEnd);
+        celix_status_t rc;
+        if (vectored) {
+            //note serializedOutput is the memory owned by the io vectors of the msg
+            rc = psa_tcp_serializeVec(entry->msgSer, msgs[i], &vectors, &vectorCapacity, nrOfUsedVectors,
+                                      &nrOfVectors[nrOfSerializedMsgs], &serializedOutput);
+            nrOfUsedVectors += rc == CELIX_SUCCESS ? nrOfVectors[nrOfSerializedMsgs] : 0;
+        } else {
+            rc = entry->msgSer->serialize(entry->msgSer->handle, msgs[i], &serializedOutput, &serializedOutputLen);
         }
-
-        if (status == CELIX_SUCCESS /*ser ok*/) {
-            //celixThreadMutex_lock(&entry->sendLock);
-            pubsub_tcp_msg_header_t msg_hdr = entry->header;
-            msg_hdr.seqNr = -1;
-            msg_hdr.sendtimeSeconds = 0;
-            msg_hdr.sendTimeNanoseconds = 0;
-            if (monitor) {
-                clock_gettime(CLOCK_REALTIME, &sendTime);
-                msg_hdr.sendtimeSeconds = (int64_t) sendTime.tv_sec;
-                msg_hdr.sendTimeNanoseconds = (int64_t) sendTime.tv_nsec;
-                msg_hdr.seqNr = entry->seqNr++;
+        if (rc == CELIX_SUCCESS && intercept && !pubsub_interceptorsHandler_invokePreSend(sender->interceptors, &interceptorHeader, serializedOutput, serializedOutputLen)) {
+            //dropped by an interceptor
+            free(serializedOutput);
+            nrOfFilteredMsgs += 1;
+        } else if (rc == CELIX_SUCCESS /*ser ok*/) {
+            if (serializedMsgLens != NULL) {
+                serializedMsgLens[nrOfSerializedMsgs] = serializedOutputLen;
             }
-
-            errno = 0;
-            bool sendOk = true;
-            {
-                int rc = pubsub_tcpHandler_write(sender->socketHandler, &msg_hdr, serializedOutput, serializedOutputLen, 0);
-                if (rc < 0) {
-                    status = -1;
-                    sendOk = false;
-                }
+            void *compressedOutput = NULL;
+            size_t compressedOutputLen = 0;
+            if (pubsub_compressor_compress(sender->compressor, serializedOutput, serializedOutputLen, &compressedOutput, &compressedOutputLen)) {
                 free(serializedOutput);
+                serializedOutput = compressedOutput;
+                serializedOutputLen = compressedOutputLen;
+                compressed[nrOfSerializedMsgs] = true;
             }
-
-            //celixThreadMutex_unlock(&entry->sendLock);
-            if (sendOk) {
-                sendCountUpdate = 1;
-            } else {
-                sendErrorUpdate = 1;
-                L_WARN("[PSA_TCP_TS] Error sending tcp. %s", strerror(errno));
+            if (trace) {
+                traces[nrOfSerializedMsgs].serializeEnd = pubsub_trace_now();
+                traced[nrOfSerializedMsgs] = true;
+            }
+            serializedOutputs[nrOfSerializedMsgs] = serializedOutput;
+            serializedOutputLens[nrOfSerializedMsgs] = (unsigned int) serializedOutputLen;
+            if (keys != NULL) {
+                keys[nrOfSerializedMsgs] = psa_tcp_fieldKey(entry->msgSer, sender->lastValueKeyField, msgs[i]);
+            }
+            if (partitions != NULL) {
+                partitions[nrOfSerializedMsgs] = partitions[i];
             }
+            nrOfSerializedMsgs += 1;
         } else {
-            serializationErrorUpdate = 1;
+            status = rc;
+            serializationErrorUpdate += 1;
             L_WARN("[PSA_TCP_TS] Error serialize message of type %s for scope/topic %s/%s", entry->msgSer->msgName,
                    sender->scope, sender->topic);
         }
-    } else {
-        //unknownMessageCountUpdate = 1;
-        status = CELIX_SERVICE_EXCEPTION;
-        L_WARN("[PSA_TCP_TS] Error cannot serialize message with msg type id %i for scope/topic %s/%s", msgTypeId,
-               sender->scope, sender->topic);
+    }
+    if (monitor) {
+        clock_gettime(CLOCK_REALTIME, &serializationEnd);
+        clock_gettime(CLOCK_REALTIME, &sendTime);
     }
 
+    if (nrOfSerializedMsgs > 0) {
+        uint64_t enqueueTime = traces != NULL ? pubsub_trace_now() : 0;
+        for (size_t i = 0; i < nrOfSerializedMsgs; ++i) {
+            headers[i] = entry->header;
+            if (compressed[i]) {
+                headers[i].flags |= PSA_TCP_MSG_FLAG_COMPRESSED;
+            }
+            headers[i].seqNr = -1;
+            headers[i].sendtimeSeconds = 0;
+            headers[i].sendTimeNanoseconds = 0;
+            if (monitor) {
+                headers[i].sendtimeSeconds = (int64_t) sendTime.tv_sec;
+                headers[i].sendTimeNanoseconds = (int64_t) sendTime.tv_nsec;
+                headers[i].seqNr = entry->seqNr++;
+            }
+            if (traced != NULL && traced[i]) {
+                //the trace context is prefixed to the (compressed) payload
+                traces[i].enqueueTime = enqueueTime;
+                char *tracedOutput = malloc(sizeof(traces[i]) + serializedOutputLens[i]);
+                memcpy(tracedOutput, &traces[i], sizeof(traces[i]));
+                memcpy(tracedOutput + sizeof(traces[i]), serializedOutputs[i], serializedOutputLens[i]);
+                free(serializedOutputs[i]);
+                serializedOutputs[i] = tracedOutput;
+                serializedOutputLens[i] += (unsigned int) sizeof(traces[i]);
+                headers[i].flags |= PSA_TCP_MSG_FLAG_TRACE;
+                headers[i].sendtimeSeconds = enqueueTime / 1000000000UL;
+                headers[i].sendTimeNanoseconds = enqueueTime % 1000000000UL;
+            }
+        }
 
-    if (monitor && entry != NULL) {
+        errno = 0;
+        int rc = 0;
+        size_t firstVector = 0;
+        for (size_t first = 0, last = 0; first < nrOfSerializedMsgs && rc >= 0; first = last) {
+            unsigned int partition = partitions != NULL ? partitions[first] : 0;
+            size_t nrOfPartitionVectors = vectored ? nrOfVectors[first] : 0;
+            for (last = first + 1; last < nrOfSerializedMsgs && (partitions == NULL || partitions[last] == partition); ++last) {
+                nrOfPartitionVectors += vectored ? nrOfVectors[last] : 0;
+            }
+            pubsub_tcpHandler_t *handler = psa_tcp_partitionHandler(sender, partition);
+            uint32_t *partitionKeys = keys != NULL ? &keys[first] : NULL;
+            rc = vectored ?
+                 pubsub_tcpHandler_writeVectorsKeyed(handler, &headers[first], &vectors[firstVector], &nrOfVectors[first], partitionKeys, last - first, 0) :
+                 pubsub_tcpHandler_writeManyKeyed(handler, &headers[first], &serializedOutputs[first], &serializedOutputLens[first], partitionKeys, last - first, 0);
+            firstVector += nrOfPartitionVectors;
+        }
+        if (rc < 0) {
+            status = -1;
+            sendErrorUpdate = (int) nrOfSerializedMsgs;
+            L_WARN("[PSA_TCP_TS] Error sending tcp. %s", strerror(errno));
+        } else {
+            sendCountUpdate = (int) nrOfSerializedMsgs;
+        }
+        uint64_t sendEnd = traces != NULL ? pubsub_trace_now() : 0;
+        for (size_t i = 0; i < nrOfSerializedMsgs; ++i) {
+            if (rc >= 0 && traced != NULL && traced[i]) {
+                pubsub_tracer_exportSendSpan(sender->tracer, entry->msgSer->msgName, &traces[i], sendEnd);
+            }
+            if (serializedMsgLens != NULL) {
+                pubsub_interceptorsHandler_invokePostSend(sender->interceptors, &interceptorHeader, serializedMsgLens[i], rc < 0 ? CELIX_ILLEGAL_STATE : CELIX_SUCCESS);
+            }
+            free(serializedOutputs[i]);
+        }
+    }
+    free(headers);
+    free(serializedOutputs);
+    free(serializedOutputLens);
+    free(compressed);
+    free(keys);
+    free(traces);
+    free(traced);
+    free(serializedMsgLens);
+    free(vectors);
+    free(nrOfVectors);
+    if (msgs != inMsgs) {
+        free(msgs);
+    }
+    free(partitions);
+
+    if (monitor && nrOfFilteredMsgs < n) {
         celixThreadMutex_lock(&entry->metrics.mutex);
 
-        long n = entry->metrics.nrOfMessagesSend + entry->metrics.nrOfMessagesSendFailed;
+        //note the serialization time of a batch is averaged over the (not filtered) msgs of the batch
+        size_t nrOfMsgs = n - nrOfFilteredMsgs;
         double diff = celix_difftime(&serializationStart, &serializationEnd);
-        double average = (entry->metrics.averageSerializationTimeInSeconds * n + diff) / (n + 1);
-        entry->metrics.averageSerializationTimeInSeconds = average;
-
-        if (entry->metrics.nrOfMessagesSend > 2) {
-            diff = celix_difftime(&entry->metrics.lastMessageSend, &sendTime);
-            n = entry->metrics.nrOfMessagesSend;
-            average = (entry->metrics.averageTimeBetweenMessagesInSeconds * n + diff) / (n + 1);
-            entry->metrics.averageTimeBetweenMessagesInSeconds = average;
+        uint64_t serializationTimeInNs = diff > 0 ? (uint64_t) (diff * 1e9 / (double) nrOfMsgs) : 0;
+        for (size_t i = 0; i < nrOfMsgs; ++i) {
+            pubsub_metricsHistogram_record(&entry->metrics.serializationTime, serializationTimeInNs);
         }
 
         entry->metrics.lastMessageSend = sendTime;
@@ -578,15 +851,220 @@ static int psa_tcp_topicPublicationSend(void *handle, unsigned int msgTypeId, co
     return status;
 }
 
-static void delay_first_send_for_late_joiners(pubsub_tcp_topic_sender_t *sender) {
+static void *psa_tcp_topicPublicationLoanMsg(void *handle, unsigned int msgTypeId) {
+    psa_tcp_bounded_service_entry_t *bound = handle;
+    pubsub_tcp_topic_sender_t *sender = bound->parent;
+
+    psa_tcp_send_msg_entry_t *entry = celix_longHashMap_get(bound->msgEntries, (long)msgTypeId);
+    if (entry == NULL || entry->msgSer->podSize == 0) {
+        L_WARN("[PSA_TCP_TS] Cannot loan message with msg type id %i for scope/topic %s/%s, not a plain old data msg type",
+               msgTypeId, sender->scope, sender->topic);
+        return NULL;
+    }
+    return pubsub_msgLoanPool_loan(sender->loanPool, entry->msgSer->podSize);
+}
+
+static int psa_tcp_topicPublicationSendLoanedMsg(void *handle, unsigned int msgTypeId, void *loanedMsg) {
+    int status = CELIX_SUCCESS;
+    psa_tcp_bounded_service_entry_t *bound = handle;
+    pubsub_tcp_topic_sender_t *sender = bound->parent;
+    CELIX_PROBE4(psa_send, PUBSUB_TCP_ADMIN_TYPE, sender->topic, msgTypeId, 1);
+    bool monitor = sender->metricsEnabled;
+
+    psa_tcp_send_msg_entry_t *entry = celix_longHashMap_get(bound->msgEntries, (long)msgTypeId);
+    if (entry == NULL || entry->msgSer->podSize == 0) {
+        L_WARN("[PSA_TCP_TS] Error cannot send loaned message with msg type id %i for scope/topic %s/%s", msgTypeId,
+               sender->scope, sender->topic);
+        pubsub_msgLoanPool_return(sender->loanPool, loanedMsg);
+        return CELIX_SERVICE_EXCEPTION;
+    }
+
+    if (!pubsub_msgFilters_match(sender->msgFilters, entry->msgSer, loanedMsg)) {
+        //not needed by any subscriber
+        pubsub_msgLoanPool_return(sender->loanPool, loanedMsg);
+        return CELIX_SUCCESS;
+    }
 
-    static bool firstSend = true;
+    //note the loaned msg is the payload, no serialization needed
+    unsigned int payloadSize = (unsigned int) entry->msgSer->podSize;
+    pubsub_interceptor_msg_header_t interceptorHeader = {entry->header.type, entry->msgSer->msgName, entry->header.major, entry->header.minor};
+    if (!pubsub_interceptorsHandler_preSend(sender->interceptors, &interceptorHeader, loanedMsg, payloadSize)) {
+        //dropped by an interceptor
+        pubsub_msgLoanPool_return(sender->loanPool, loanedMsg);
+        return CELIX_SUCCESS;
+    }
+
+    struct timespec sendTime = {0, 0};
+    pubsub_tcp_msg_header_t header = entry->header;
+    header.flags = PSA_TCP_MSG_FLAG_POD;
+    header.seqNr = -1;
+    header.sendtimeSeconds = 0;
+    header.sendTimeNanoseconds = 0;
+    if (monitor) {
+        clock_gettime(CLOCK_REALTIME, &sendTime);
+        header.sendtimeSeconds = (int64_t) sendTime.tv_sec;
+        header.sendTimeNanoseconds = (int64_t) sendTime.tv_nsec;
+        header.seqNr = entry->seqNr++;
+    }
+
+    uint32_t key = sender->lastValueKeyField != NULL ? psa_tcp_fieldKey(entry->msgSer, sender->lastValueKeyField, loanedMsg) : 0;
+    errno = 0;
+    pubsub_tcpHandler_t *handler = psa_tcp_partitionHandler(sender, psa_tcp_partitionOf(sender, entry->msgSer, loanedMsg));
+    int rc = pubsub_tcpHandler_writeManyKeyed(handler, &header, &loanedMsg, &payloadSize, &key, 1, 0);
+    if (rc < 0) {
+        status = -1;
+        L_WARN("[PSA_TCP_TS] Error sending tcp. %s", strerror(errno));
+    }
+    pubsub_interceptorsHandler_postSend(sender->interceptors, &interceptorHeader, payloadSize, rc < 0 ? CELIX_ILLEGAL_STATE : CELIX_SUCCESS);
+    pubsub_msgLoanPool_return(sender->loanPool, loanedMsg);
+
+    if (monitor) {
+        celixThreadMutex_lock(&entry->metrics.mutex);
+        entry->metrics.lastMessageSend = sendTime;
+        if (rc < 0) {
+            entry->metrics.nrOfMessagesSendFailed += 1;
+        } else {
+            entry->metrics.nrOfMessagesSend += 1;
+        }
+        celixThreadMutex_unlock(&entry->metrics.mutex);
+    }
 
-    if (firstSend) {
-        L_INFO("PSA_TCP_TP: Delaying first send for late joiners...\n");
-        sleep(FIRST_SEND_DELAY_IN_SECONDS);
-        firstSend = false;
+    return status;
+}
+
+static void psa_tcp_topicPublicationReturnLoanedMsg(void *handle, unsigned int msgTypeId __attribute__((unused)), void *loanedMsg) {
+    psa_tcp_bounded_service_entry_t *bound = handle;
+    pubsub_msgLoanPool_return(bound->parent->loanPool, loanedMsg);
+}
+
+/**
+ * Returns the hash of the value of the (last value cache or partition) key field of msg, 0 if the msg has no such
+ * field or the msg serializer does not support msgToProperties.
+ */
+static uint32_t psa_tcp_fieldKey(const pubsub_msg_serializer_t *msgSer, const char *field, const void *msg) {
+    uint32_t key = 0;
+    if (msgSer->msgToProperties != NULL) {
+        celix_properties_t *props = celix_properties_create();
+        if (msgSer->msgToProperties(msgSer->handle, msg, props) == CELIX_SUCCESS) {
+            const char *value = celix_properties_get(props, field, NULL);
+            key = value != NULL ? (uint32_t) utils_stringHash(value) : 0;
+        }
+        celix_properties_destroy(props);
+    }
+    return key;
+}
+
+/**
+ * Returns the partition of msg, the first partition for msgs without the partition key field.
+ */
+static unsigned int psa_tcp_partitionOf(pubsub_tcp_topic_sender_t *sender, const pubsub_msg_serializer_t *msgSer, const void *msg) {
+    if (sender->partitionKeyField == NULL) {
+        return 0;
+    }
+    return psa_tcp_fieldKey(msgSer, sender->partitionKeyField, msg) % sender->nrOfPartitions;
+}
+
+static pubsub_tcpHandler_t *psa_tcp_partitionHandler(pubsub_tcp_topic_sender_t *sender, unsigned int partition) {
+    return partition == 0 ? sender->socketHandler : sender->partitions[partition - 1].handler;
+}
+
+/**
+ * Sorts the msgs by partition (stable, so the msgs of a partition keep their order) into sortedMsgs and stores the
+ * partition of every sorted msg in partitions.
+ */
+static celix_status_t psa_tcp_sortByPartition(pubsub_tcp_topic_sender_t *sender, const pubsub_msg_serializer_t *msgSer, const void **msgs, size_t n,
+                                              const void **sortedMsgs, unsigned int *partitions) {
+    unsigned int *unsortedPartitions = malloc(n * sizeof(*unsortedPartitions));
+    if (unsortedPartitions == NULL) {
+        return CELIX_ENOMEM;
+    }
+    size_t counts[sender->nrOfPartitions + 1];
+    memset(counts, 0, sizeof(counts));
+    for (size_t i = 0; i < n; ++i) {
+        unsortedPartitions[i] = psa_tcp_partitionOf(sender, msgSer, msgs[i]);
+        counts[unsortedPartitions[i] + 1] += 1;
+    }
+    for (unsigned int p = 1; p <= sender->nrOfPartitions; ++p) {
+        counts[p] += counts[p - 1]; //note counts[p] is now the first index of partition p
+    }
+    for (size_t i = 0; i < n; ++i) {
+        size_t index = counts[unsortedPartitions[i]]++;
+        sortedMsgs[index] = msgs[i];
+        partitions[index] = unsortedPartitions[i];
+    }
+    free(unsortedPartitions);
+    return CELIX_SUCCESS;
+}
+
+/**
+ * Listens on a random port in [basePort, maxPort]. Returns the url or NULL.
+ */
+static char *psa_tcp_listen(pubsub_tcp_topic_sender_t *sender, pubsub_tcpHandler_t *handler, const char *bindIP, unsigned int basePort, unsigned int maxPort) {
+    char *result = NULL;
+    int retry = 0;
+    while (result == NULL && retry < TCP_BIND_MAX_RETRY) {
+        /* Randomized part due to same bundle publishing on different topics */
+        unsigned int port = rand_range(basePort, maxPort);
+        char *url = NULL;
+        if (bindIP == NULL) asprintf(&url, "tcp://0.0.0.0:%u", port);
+        else asprintf(&url, "tcp://%s:%u", bindIP, port);
+        int rv = pubsub_tcpHandler_listen(handler, url);
+        if (rv == -1) {
+            L_WARN("Error for tcp_bind using dynamic bind url '%s'. %s", url, strerror(errno));
+            free(url);
+        } else {
+            result = url;
+        }
+        retry++;
+    }
+    return result;
+}
+
+/**
+ * Creates the partitions 1..nrOfPartitions-1 of a partitioned topic, each with its own (listening) socket handler
+ * configured as the socket handler of partition 0. If a partition cannot listen, the topic gets fewer partitions.
+ */
+static void psa_tcp_createPartitions(pubsub_tcp_topic_sender_t *sender, const celix_properties_t *topicProperties, unsigned int nrOfPartitions,
+                                     const char *bindIP, unsigned int basePort, unsigned int maxPort) {
+    sender->partitions = calloc(nrOfPartitions - 1, sizeof(*sender->partitions));
+    const char *keyField = celix_properties_get(topicProperties, PUBSUB_PARTITION_KEY, NULL);
+    sender->partitionKeyField = keyField == NULL ? NULL : strndup(keyField, 1024);
+    if (keyField == NULL) {
+        L_WARN("[PSA_TCP_TS] No %s for partitioned topic on %s, all msgs are sent over the first partition", PUBSUB_PARTITION_KEY, sender->url);
+    }
+
+    bool blocking = celix_properties_getAsBool((celix_properties_t *) topicProperties, PUBSUB_TCP_PUBLISHER_BLOCKING_KEY, PUBSUB_TCP_PUBLISHER_BLOCKING_DEFAULT);
+    bool bypassHeader = celix_properties_getAsBool((celix_properties_t *) topicProperties, PUBSUB_TCP_BYPASS_HEADER, PUBSUB_TCP_DEFAULT_BYPASS_HEADER);
+    long msgIdOffset = celix_properties_getAsLong(topicProperties, PUBSUB_TCP_MESSAGE_ID_OFFSET, PUBSUB_TCP_DEFAULT_MESSAGE_ID_OFFSET);
+    long msgIdSize = celix_properties_getAsLong(topicProperties, PUBSUB_TCP_MESSAGE_ID_SIZE, PUBSUB_TCP_DEFAULT_MESSAGE_ID_SIZE);
+    long sendQueueSize = celix_properties_getAsLong(topicProperties, PUBSUB_SEND_QUEUE_SIZE_KEY, PUBSUB_SEND_QUEUE_SIZE_DEFAULT);
+    long lastValueCacheSize = celix_properties_getAsLong(topicProperties, PUBSUB_LAST_VALUE_CACHE_SIZE_KEY, PUBSUB_LAST_VALUE_CACHE_SIZE_DEFAULT);
+    char *urls = strndup(pubsub_tcpHandler_url(sender->socketHandler), 1024 * 1024);
+    for (unsigned int i = 1; i < nrOfPartitions; ++i) {
+        psa_tcp_partition_t *partition = &sender->partitions[i - 1];
+        partition->sender = sender;
+        partition->handler = pubsub_tcpHandler_create(sender->logHelper);
+        pubsub_tcpHandler_setIoUring(partition->handler, celix_bundleContext_getPropertyAsBool(sender->ctx, PSA_TCP_IO_URING, PSA_TCP_DEFAULT_IO_URING));
+        pubsub_tcpHandler_setBypassHeader(partition->handler, bypassHeader, (unsigned int) msgIdOffset, (unsigned int) msgIdSize);
+        pubsub_tcpHandler_setBlockingWrite(partition->handler, blocking);
+        pubsub_tcpHandler_setSendQueue(partition->handler, pubsub_utils_getSendQueuePolicy(topicProperties), (size_t) sendQueueSize);
+        if (lastValueCacheSize > 0) {
+            pubsub_tcpHandler_setLastValueCache(partition->handler, (size_t) lastValueCacheSize);
+        }
+        char *url = psa_tcp_listen(sender, partition->handler, bindIP, basePort, maxPort);
+        if (url == NULL) {
+            L_WARN("[PSA_TCP_TS] Cannot listen for partition %u of the topic on %s, using %u partitions", i, sender->url, i);
+            pubsub_tcpHandler_destroy(partition->handler);
+            break;
+        }
+        free(url);
+        char *joined = NULL;
+        asprintf(&joined, "%s %s", urls, pubsub_tcpHandler_url(partition->handler));
+        free(urls);
+        urls = joined;
+        sender->nrOfPartitions += 1;
     }
+    sender->partitionUrls = urls;
 }
 
 static unsigned int rand_range(unsigned int min, unsigned int max) {
@@ -23,6 +23,7 @@
 #include "celix_bundle_context.h"
 #include "pubsub_admin_metrics.h"
 #include "pubsub_tcp_common.h"
+#include "pubsub_tcp_handler.h"
 
 typedef struct pubsub_tcp_topic_sender pubsub_tcp_topic_sender_t;
 
@@ -33,6 +34,7 @@ pubsub_tcp_topic_sender_t* pubsub_tcpTopicSender_create(
         const char *topic,
         const celix_properties_t *topicProperties,
         pubsub_tcp_endPointStore_t* endPointStore,
+        pubsub_tcpHandler_t *muxHandler,
         long serializerSvcId,
         pubsub_serializer_service_t *ser,
         const char *bindIP,
@@ -51,9 +53,16 @@ long pubsub_tcpTopicSender_serializerSvcId(pubsub_tcp_topic_sender_t *sender);
 void pubsub_tcpTopicSender_connectTo(pubsub_tcp_topic_sender_t *sender, const celix_properties_t *endpoint);
 void pubsub_tcpTopicSender_disconnectFrom(pubsub_tcp_topic_sender_t *sender, const celix_properties_t *endpoint);
 
+/**
+ * Adds (or replaces) the msg filter of a subscriber endpoint (NULL if the subscriber needs all msgs).
+ * Msgs not matching the msg filter of any known subscriber are not send. Ignored for static topic senders.
+ */
+void pubsub_tcpTopicSender_addMsgFilter(pubsub_tcp_topic_sender_t *sender, const char *endpointUUID, const char *msgFilter);
+void pubsub_tcpTopicSender_removeMsgFilter(pubsub_tcp_topic_sender_t *sender, const char *endpointUUID);
+
 /**
  * Returns a array of pubsub_admin_sender_msg_type_metrics_t entries for every msg_type/bundle send with the topic sender.
  */
-pubsub_admin_sender_metrics_t* pubsub_tcpTopicSender_metrics(pubsub_tcp_topic_sender_t *sender);
+void pubsub_tcpTopicSender_visitMetrics(pubsub_tcp_topic_sender_t *sender, const struct timespec *changedSince, void *callbackHandle, pubsub_metrics_visit_fp callback);
 
 #endif //CELIX_PUBSUB_TCP_TOPIC_SENDER_H
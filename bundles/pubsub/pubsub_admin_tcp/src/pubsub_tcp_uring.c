@@ -0,0 +1,345 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *  KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include "pubsub_tcp_uring.h"
+
+#ifdef PSA_TCP_HAVE_IO_URING
+
+#include <poll.h>
+#include <time.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <linux/io_uring.h>
+
+#define PSA_TCP_URING_BUFFER_GROUP 0
+
+struct pubsub_tcp_uring {
+    int fd;
+    void *sqRing;
+    size_t sqRingSize;
+    void *cqRing;
+    size_t cqRingSize;
+    struct io_uring_sqe *sqes;
+    size_t sqesSize;
+
+    unsigned int *sqHead;
+    unsigned int *sqTail;
+    unsigned int sqMask;
+    unsigned int sqEntries;
+    unsigned int *sqArray;
+    unsigned int sqLocalTail; //tail including the not yet published sqes
+
+    unsigned int *cqHead;
+    unsigned int *cqTail;
+    unsigned int cqMask;
+    struct io_uring_cqe *cqes;
+
+    //provided buffers used by the multishot recv
+    struct io_uring_buf_ring *bufRing;
+    size_t bufRingSize;
+    char *buffers;
+    unsigned int nrOfBuffers;
+    unsigned int bufferSize;
+};
+
+static int pubsub_tcpUring_enter(int fd, unsigned int toSubmit, unsigned int minComplete, unsigned int flags, void *arg, size_t argSize) {
+    int rc = (int) syscall(SYS_io_uring_enter, fd, toSubmit, minComplete, flags, arg, argSize);
+    return rc < 0 ? -errno : rc;
+}
+
+static struct io_uring_sqe* pubsub_tcpUring_getSqe(pubsub_tcp_uring_t *ring) {
+    unsigned int head = __atomic_load_n(ring->sqHead, __ATOMIC_ACQUIRE);
+    if (ring->sqLocalTail - head >= ring->sqEntries) {
+        return NULL;
+    }
+    unsigned int index = ring->sqLocalTail & ring->sqMask;
+    struct io_uring_sqe *sqe = &ring->sqes[index];
+    memset(sqe, 0, sizeof(*sqe));
+    ring->sqArray[index] = index;
+    ring->sqLocalTail++;
+    return sqe;
+}
+
+static unsigned int pubsub_tcpUring_flush(pubsub_tcp_uring_t *ring) {
+    __atomic_store_n(ring->sqTail, ring->sqLocalTail, __ATOMIC_RELEASE);
+    return ring->sqLocalTail - __atomic_load_n(ring->sqHead, __ATOMIC_ACQUIRE);
+}
+
+static void pubsub_tcpUring_addBuffer(pubsub_tcp_uring_t *ring, unsigned short bufferId, unsigned int offset) {
+    unsigned short tail = ring->bufRing->tail;
+    struct io_uring_buf *buf = &ring->bufRing->bufs[(tail + offset) & (ring->nrOfBuffers - 1)];
+    buf->addr = (unsigned long) (ring->buffers + (size_t) bufferId * ring->bufferSize);
+    buf->len = ring->bufferSize;
+    buf->bid = bufferId;
+}
+
+static int pubsub_tcpUring_setupBufferRing(pubsub_tcp_uring_t *ring, unsigned int nrOfBuffers, unsigned int bufferSize) {
+    ring->nrOfBuffers = nrOfBuffers;
+    ring->bufferSize = bufferSize;
+    ring->bufRingSize = nrOfBuffers * sizeof(struct io_uring_buf);
+    void *mem = mmap(NULL, ring->bufRingSize, PROT_READ | PROT_WRITE, MAP_ANONYMOUS | MAP_PRIVATE, -1, 0);
+    if (mem == MAP_FAILED) {
+        return -errno;
+    }
+    ring->bufRing = mem;
+    ring->buffers = malloc((size_t) nrOfBuffers * bufferSize);
+    if (ring->buffers == NULL) {
+        return -ENOMEM;
+    }
+    struct io_uring_buf_reg reg;
+    memset(&reg, 0, sizeof(reg));
+    reg.ring_addr = (unsigned long) ring->bufRing;
+    reg.ring_entries = nrOfBuffers;
+    reg.bgid = PSA_TCP_URING_BUFFER_GROUP;
+    if (syscall(SYS_io_uring_register, ring->fd, IORING_REGISTER_PBUF_RING, &reg, 1) < 0) {
+        return -errno;
+    }
+    for (unsigned int i = 0; i < nrOfBuffers; i++) {
+        pubsub_tcpUring_addBuffer(ring, (unsigned short) i, i);
+    }
+    __atomic_store_n(&ring->bufRing->tail, (unsigned short) nrOfBuffers, __ATOMIC_RELEASE);
+    return 0;
+}
+
+pubsub_tcp_uring_t* pubsub_tcpUring_create(unsigned int entries, unsigned int nrOfBuffers, unsigned int bufferSize) {
+    if (nrOfBuffers > 0 && ((nrOfBuffers & (nrOfBuffers - 1)) != 0 || nrOfBuffers > 32768 || bufferSize == 0)) {
+        return NULL;
+    }
+    struct io_uring_params params;
+    memset(&params, 0, sizeof(params));
+    int fd = (int) syscall(SYS_io_uring_setup, entries, &params);
+    if (fd < 0) {
+        return NULL;
+    }
+    // EXT_ARG is needed for the wait timeout and also guarantees the single mmap and nodrop features
+    if ((params.features & IORING_FEAT_EXT_ARG) == 0 || (params.features & IORING_FEAT_SINGLE_MMAP) == 0) {
+        close(fd);
+        return NULL;
+    }
+
+    pubsub_tcp_uring_t *ring = calloc(1, sizeof(*ring));
+    ring->fd = fd;
+    ring->sqRingSize = params.sq_off.array + params.sq_entries * sizeof(unsigned int);
+    ring->cqRingSize = params.cq_off.cqes + params.cq_entries * sizeof(struct io_uring_cqe);
+    if (ring->cqRingSize > ring->sqRingSize) {
+        ring->sqRingSize = ring->cqRingSize;
+    }
+    ring->sqesSize = params.sq_entries * sizeof(struct io_uring_sqe);
+    void *sqRing = mmap(NULL, ring->sqRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQ_RING);
+    void *sqes = sqRing == MAP_FAILED ? MAP_FAILED :
+                 mmap(NULL, ring->sqesSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQES);
+    if (sqRing == MAP_FAILED || sqes == MAP_FAILED) {
+        if (sqRing != MAP_FAILED) {
+            munmap(sqRing, ring->sqRingSize);
+        }
+        close(fd);
+        free(ring);
+        return NULL;
+    }
+    ring->sqRing = sqRing;
+    ring->cqRing = sqRing; //single mmap
+    ring->sqes = sqes;
+
+    char *sq = sqRing;
+    ring->sqHead = (unsigned int *) (sq + params.sq_off.head);
+    ring->sqTail = (unsigned int *) (sq + params.sq_off.tail);
+    ring->sqMask = *(unsigned int *) (sq + params.sq_off.ring_mask);
+    ring->sqEntries = *(unsigned int *) (sq + params.sq_off.ring_entries);
+    ring->sqArray = (unsigned int *) (sq + params.sq_off.array);
+    ring->sqLocalTail = *ring->sqTail;
+
+    char *cq = ring->cqRing;
+    ring->cqHead = (unsigned int *) (cq + params.cq_off.head);
+    ring->cqTail = (unsigned int *) (cq + params.cq_off.tail);
+    ring->cqMask = *(unsigned int *) (cq + params.cq_off.ring_mask);
+    ring->cqes = (struct io_uring_cqe *) (cq + params.cq_off.cqes);
+
+    if (nrOfBuffers > 0 && pubsub_tcpUring_setupBufferRing(ring, nrOfBuffers, bufferSize) != 0) {
+        pubsub_tcpUring_destroy(ring);
+        return NULL;
+    }
+    return ring;
+}
+
+void pubsub_tcpUring_destroy(pubsub_tcp_uring_t *ring) {
+    if (ring != NULL) {
+        // closing the ring fd cancels all pending operations, before the buffers are freed
+        munmap(ring->sqes, ring->sqesSize);
+        munmap(ring->sqRing, ring->sqRingSize);
+        close(ring->fd);
+        if (ring->bufRing != NULL) {
+            munmap(ring->bufRing, ring->bufRingSize);
+        }
+        free(ring->buffers);
+        free(ring);
+    }
+}
+
+bool pubsub_tcpUring_recvMultishot(pubsub_tcp_uring_t *ring, int fd, uint64_t userData) {
+    struct io_uring_sqe *sqe = ring->bufRing != NULL ? pubsub_tcpUring_getSqe(ring) : NULL;
+    if (sqe == NULL) {
+        return false;
+    }
+    sqe->opcode = IORING_OP_RECV;
+    sqe->fd = fd;
+    sqe->ioprio = IORING_RECV_MULTISHOT;
+    sqe->flags = IOSQE_BUFFER_SELECT;
+    sqe->buf_group = PSA_TCP_URING_BUFFER_GROUP;
+    sqe->user_data = userData;
+    return true;
+}
+
+bool pubsub_tcpUring_poll(pubsub_tcp_uring_t *ring, int fd, uint64_t userData) {
+    struct io_uring_sqe *sqe = pubsub_tcpUring_getSqe(ring);
+    if (sqe == NULL) {
+        return false;
+    }
+    sqe->opcode = IORING_OP_POLL_ADD;
+    sqe->fd = fd;
+    sqe->poll32_events = POLLIN;
+    sqe->user_data = userData;
+    return true;
+}
+
+void pubsub_tcpUring_submitAndWait(pubsub_tcp_uring_t *ring, unsigned int timeoutInMs) {
+    struct __kernel_timespec ts;
+    ts.tv_sec = timeoutInMs / 1000;
+    ts.tv_nsec = (timeoutInMs % 1000) * 1000000L;
+    struct io_uring_getevents_arg arg;
+    memset(&arg, 0, sizeof(arg));
+    arg.ts = (unsigned long) &ts;
+    unsigned int toSubmit = pubsub_tcpUring_flush(ring);
+    // -ETIME and -EINTR are expected, the completions are taken with pubsub_tcpUring_nextCompletion
+    pubsub_tcpUring_enter(ring->fd, toSubmit, 1, IORING_ENTER_GETEVENTS | IORING_ENTER_EXT_ARG, &arg, sizeof(arg));
+}
+
+bool pubsub_tcpUring_nextCompletion(pubsub_tcp_uring_t *ring, pubsub_tcp_uring_completion_t *completion) {
+    unsigned int head = *ring->cqHead;
+    if (head == __atomic_load_n(ring->cqTail, __ATOMIC_ACQUIRE)) {
+        return false;
+    }
+    struct io_uring_cqe *cqe = &ring->cqes[head & ring->cqMask];
+    completion->userData = cqe->user_data;
+    completion->result = cqe->res;
+    completion->more = (cqe->flags & IORING_CQE_F_MORE) != 0;
+    completion->hasBuffer = (cqe->flags & IORING_CQE_F_BUFFER) != 0;
+    completion->bufferId = (unsigned short) (cqe->flags >> IORING_CQE_BUFFER_SHIFT);
+    __atomic_store_n(ring->cqHead, head + 1, __ATOMIC_RELEASE);
+    return true;
+}
+
+void* pubsub_tcpUring_buffer(pubsub_tcp_uring_t *ring, unsigned short bufferId) {
+    return ring->buffers + (size_t) bufferId * ring->bufferSize;
+}
+
+void pubsub_tcpUring_recycleBuffer(pubsub_tcp_uring_t *ring, unsigned short bufferId) {
+    pubsub_tcpUring_addBuffer(ring, bufferId, 0);
+    __atomic_store_n(&ring->bufRing->tail, (unsigned short) (ring->bufRing->tail + 1), __ATOMIC_RELEASE);
+}
+
+ssize_t pubsub_tcpUring_sendMsgZeroCopy(pubsub_tcp_uring_t *ring, int fd, const struct msghdr *msg, int flags) {
+    struct io_uring_sqe *sqe = pubsub_tcpUring_getSqe(ring);
+    if (sqe == NULL) {
+        return -EBUSY;
+    }
+    sqe->opcode = IORING_OP_SENDMSG_ZC;
+    sqe->fd = fd;
+    sqe->addr = (unsigned long) msg;
+    sqe->len = 1;
+    sqe->msg_flags = (unsigned int) flags;
+    sqe->user_data = 1;
+
+    ssize_t result = 0;
+    bool done = false;
+    bool notified = true;
+    unsigned int toSubmit = pubsub_tcpUring_flush(ring);
+    // The data buffers can only be reused by the caller after the notification, that the kernel released them.
+    while (!done || !notified) {
+        int rc = pubsub_tcpUring_enter(ring->fd, toSubmit, 1, IORING_ENTER_GETEVENTS, NULL, 0);
+        if (rc < 0 && rc != -EINTR) {
+            return rc;
+        }
+        toSubmit = pubsub_tcpUring_flush(ring);
+        unsigned int head = *ring->cqHead;
+        while (head != __atomic_load_n(ring->cqTail, __ATOMIC_ACQUIRE)) {
+            struct io_uring_cqe *cqe = &ring->cqes[head & ring->cqMask];
+            if (cqe->flags & IORING_CQE_F_NOTIF) {
+                notified = true;
+            } else {
+                done = true;
+                result = cqe->res;
+                notified = (cqe->flags & IORING_CQE_F_MORE) == 0;
+            }
+            head++;
+        }
+        __atomic_store_n(ring->cqHead, head, __ATOMIC_RELEASE);
+    }
+    return result;
+}
+
+#else
+
+pubsub_tcp_uring_t* pubsub_tcpUring_create(unsigned int entries __attribute__((unused)),
+                                           unsigned int nrOfBuffers __attribute__((unused)),
+                                           unsigned int bufferSize __attribute__((unused))) {
+    return NULL;
+}
+
+void pubsub_tcpUring_destroy(pubsub_tcp_uring_t *ring __attribute__((unused))) {
+}
+
+bool pubsub_tcpUring_recvMultishot(pubsub_tcp_uring_t *ring __attribute__((unused)), int fd __attribute__((unused)),
+                                   uint64_t userData __attribute__((unused))) {
+    return false;
+}
+
+bool pubsub_tcpUring_poll(pubsub_tcp_uring_t *ring __attribute__((unused)), int fd __attribute__((unused)),
+                          uint64_t userData __attribute__((unused))) {
+    return false;
+}
+
+void pubsub_tcpUring_submitAndWait(pubsub_tcp_uring_t *ring __attribute__((unused)),
+                                   unsigned int timeoutInMs __attribute__((unused))) {
+}
+
+bool pubsub_tcpUring_nextCompletion(pubsub_tcp_uring_t *ring __attribute__((unused)),
+                                    pubsub_tcp_uring_completion_t *completion __attribute__((unused))) {
+    return false;
+}
+
+void* pubsub_tcpUring_buffer(pubsub_tcp_uring_t *ring __attribute__((unused)), unsigned short bufferId __attribute__((unused))) {
+    return NULL;
+}
+
+void pubsub_tcpUring_recycleBuffer(pubsub_tcp_uring_t *ring __attribute__((unused)),
+                                   unsigned short bufferId __attribute__((unused))) {
+}
+
+ssize_t pubsub_tcpUring_sendMsgZeroCopy(pubsub_tcp_uring_t *ring __attribute__((unused)), int fd __attribute__((unused)),
+                                        const struct msghdr *msg __attribute__((unused)),
+                                        int flags __attribute__((unused))) {
+    return -EOPNOTSUPP;
+}
+
+#endif
@@ -0,0 +1,81 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *  KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+
+#ifndef CELIX_PUBSUB_TCP_URING_H
+#define CELIX_PUBSUB_TCP_URING_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <sys/types.h>
+#include <sys/socket.h>
+
+/**
+ * Minimal io_uring wrapper used by the tcp handler, built on the kernel io_uring interface (no liburing dependency).
+ * Only available if built with PSA_TCP_HAVE_IO_URING, otherwise pubsub_tcpUring_create returns NULL.
+ * A ring is not thread safe.
+ */
+typedef struct pubsub_tcp_uring pubsub_tcp_uring_t;
+
+typedef struct pubsub_tcp_uring_completion {
+    uint64_t userData;
+    int result; //result of the operation, -errno on error
+    bool more; //true if the (multishot) operation will produce more completions
+    bool hasBuffer; //true if a buffer of the buffer ring is used, the buffer must be recycled
+    unsigned short bufferId;
+} pubsub_tcp_uring_completion_t;
+
+/**
+ * Creates an io_uring with a registered ring of nrOfBuffers (power of 2) provided buffers of bufferSize for receiving.
+ * Returns NULL if io_uring or the needed features (multishot, buffer rings) are not supported.
+ */
+pubsub_tcp_uring_t* pubsub_tcpUring_create(unsigned int entries, unsigned int nrOfBuffers, unsigned int bufferSize);
+void pubsub_tcpUring_destroy(pubsub_tcp_uring_t *ring);
+
+/**
+ * Queues a multishot recv for fd using the buffer ring. Returns false if the submission queue is full.
+ */
+bool pubsub_tcpUring_recvMultishot(pubsub_tcp_uring_t *ring, int fd, uint64_t userData);
+
+/**
+ * Queues a (single shot) poll for POLLIN on fd. Returns false if the submission queue is full.
+ */
+bool pubsub_tcpUring_poll(pubsub_tcp_uring_t *ring, int fd, uint64_t userData);
+
+/**
+ * Submits the queued operations and waits at most timeoutInMs for a completion.
+ */
+void pubsub_tcpUring_submitAndWait(pubsub_tcp_uring_t *ring, unsigned int timeoutInMs);
+
+/**
+ * Takes the next completion. Returns false if there are no completions.
+ */
+bool pubsub_tcpUring_nextCompletion(pubsub_tcp_uring_t *ring, pubsub_tcp_uring_completion_t *completion);
+
+void* pubsub_tcpUring_buffer(pubsub_tcp_uring_t *ring, unsigned short bufferId);
+void pubsub_tcpUring_recycleBuffer(pubsub_tcp_uring_t *ring, unsigned short bufferId);
+
+/**
+ * Sends msg with a zero copy sendmsg and waits till the kernel does not use the buffers anymore.
+ * Should only be used on a ring without other pending operations.
+ * Returns the number of sent bytes or -errno (-EOPNOTSUPP if zero copy send is not supported).
+ */
+ssize_t pubsub_tcpUring_sendMsgZeroCopy(pubsub_tcp_uring_t *ring, int fd, const struct msghdr *msg, int flags);
+
+#endif //CELIX_PUBSUB_TCP_URING_H
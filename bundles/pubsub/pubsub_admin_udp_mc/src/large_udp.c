@@ -30,9 +30,14 @@
 #include <string.h>
 #include <unistd.h>
 #include <stdlib.h>
+#include <stdint.h>
 #include <errno.h>
+#include <time.h>
 #include <array_list.h>
+#include <hash_map.h>
 #include <pthread.h>
+#include <linux/net_tstamp.h>
+#include <linux/errqueue.h>
 
 #define MAX_UDP_MSG_SIZE        65535 /* 2^16 -1 */
 #define IP_HEADER_SIZE          20
@@ -40,19 +45,50 @@
 //#define MTU_SIZE                1500
 #define MTU_SIZE                8000
 #define MAX_MSG_VECTOR_LEN      64
+#define MAX_MMSG_BATCH_LEN      32
+#define MAX_PACED_BURST_SIZE    (256 * 1024) // max nr of bytes sent in one sendmmsg call when the send rate is limited
+#define DEFAULT_REASSEMBLY_TIMEOUT_MS 1000
+#define DEFAULT_RECV_BATCH_SIZE 16
+#define MAX_RECV_BATCH_SIZE     256
+#define RECV_CONTROL_SIZE       CMSG_SPACE(sizeof(struct scm_timestamping))
 
 //#define NO_IP_FRAGMENTATION
 
 struct largeUdp {
     unsigned int maxNrLists;
-    array_list_pt udpPartLists;
+    hash_map_pt udpPartLists; //key is the udpPartListKey_t of the udpPartList_t
+    array_list_pt completedLists; //reassembled msgs, not yet read
+    unsigned int reassemblyTimeoutMs;
+    struct timespec nextPurgeTime;
+    unsigned long sendRate; //max nr of bytes per second, 0 is not paced
+    struct timespec nextSendTime;
     pthread_mutex_t dbLock;
+
+    //preallocated (on first use) buffer ring for largeUdp_receive, only used by the receiving thread
+    struct {
+        unsigned int size; //max nr of datagrams per recvmmsg call
+        char *buffers; //size * MAX_UDP_MSG_SIZE
+        char *control; //size * RECV_CONTROL_SIZE
+        struct mmsghdr *msgs;
+        struct iovec *iovecs;
+        struct sockaddr_in *origins;
+    } recvRing;
 };
 
-typedef struct udpPartList {
+typedef struct udpPartListKey {
+    uint32_t addr;
+    uint16_t port;
     unsigned int msg_ident;
+} udpPartListKey_t;
+
+typedef struct udpPartList {
+    udpPartListKey_t key;
     unsigned int msg_size;
+    unsigned int nrParts;
     unsigned int nrPartsRemaining;
+    uint8_t *receivedParts; //bitmap, detects duplicated parts
+    struct timespec lastUpdate;
+    struct timespec receiveTime; //realtime (kernel timestamp if available) of the last received part
     char *data;
 } udpPartList_t;
 
@@ -70,6 +106,33 @@ typedef struct msg_part_header {
 #define MAX_PART_SIZE   (MAX_UDP_MSG_SIZE - (IP_HEADER_SIZE + UDP_HEADER_SIZE + sizeof(struct msg_part_header) ))
 #endif
 
+static unsigned int largeUdp_keyHash(const void *key) {
+    const udpPartListKey_t *k = key;
+    uint64_t h = ((uint64_t) k->addr << 32) ^ ((uint64_t) k->port << 16) ^ k->msg_ident;
+    h ^= h >> 33;
+    h *= 0xff51afd7ed558ccdULL;
+    h ^= h >> 33;
+    return (unsigned int) h;
+}
+
+static int largeUdp_keyEquals(const void *key1, const void *key2) {
+    const udpPartListKey_t *k1 = key1;
+    const udpPartListKey_t *k2 = key2;
+    return k1->addr == k2->addr && k1->port == k2->port && k1->msg_ident == k2->msg_ident;
+}
+
+static void largeUdp_freePartList(udpPartList_t *udpPartList) {
+    if (udpPartList) {
+        free(udpPartList->data);
+        free(udpPartList->receivedParts);
+        free(udpPartList);
+    }
+}
+
+static long largeUdp_elapsedMs(const struct timespec *from, const struct timespec *to) {
+    return (to->tv_sec - from->tv_sec) * 1000L + (to->tv_nsec - from->tv_nsec) / 1000000L;
+}
+
 //
 // Create a handle
 //
@@ -79,9 +142,13 @@ largeUdp_t *largeUdp_create(unsigned int maxNrUdpReceptions)
     largeUdp_t *handle = calloc(sizeof(*handle), 1);
     if (handle != NULL) {
         handle->maxNrLists = maxNrUdpReceptions;
-        if (arrayList_create(&handle->udpPartLists) != CELIX_SUCCESS) {
+        handle->reassemblyTimeoutMs = DEFAULT_REASSEMBLY_TIMEOUT_MS;
+        handle->recvRing.size = DEFAULT_RECV_BATCH_SIZE;
+        handle->udpPartLists = hashMap_create(largeUdp_keyHash, NULL, largeUdp_keyEquals, NULL);
+        if (arrayList_create(&handle->completedLists) != CELIX_SUCCESS) {
+            hashMap_destroy(handle->udpPartLists, false, false);
             free(handle);
-            handle = NULL;
+            return NULL;
         }
         pthread_mutex_init(&handle->dbLock, 0);
     }
@@ -97,87 +164,212 @@ void largeUdp_destroy(largeUdp_t *handle)
     printf("### Destroying large UDP\n");
     if (handle != NULL) {
         pthread_mutex_lock(&handle->dbLock);
-        int nrUdpLists = arrayList_size(handle->udpPartLists);
-        int i;
-        for (i=0; i < nrUdpLists; i++) {
-            udpPartList_t *udpPartList = arrayList_remove(handle->udpPartLists, i);
-            if (udpPartList) {
-                if (udpPartList->data) {
-                    free(udpPartList->data);
-                    udpPartList->data = NULL;
-                }
-                free(udpPartList);
-            }
+        hash_map_iterator_t iter = hashMapIterator_construct(handle->udpPartLists);
+        while (hashMapIterator_hasNext(&iter)) {
+            largeUdp_freePartList(hashMapIterator_nextValue(&iter));
         }
-        arrayList_destroy(handle->udpPartLists);
+        hashMap_destroy(handle->udpPartLists, false, false);
         handle->udpPartLists = NULL;
+        int nrCompleted = arrayList_size(handle->completedLists);
+        for (int i = 0; i < nrCompleted; i++) {
+            largeUdp_freePartList(arrayList_get(handle->completedLists, i));
+        }
+        arrayList_destroy(handle->completedLists);
+        handle->completedLists = NULL;
         pthread_mutex_unlock(&handle->dbLock);
         pthread_mutex_destroy(&handle->dbLock);
+        free(handle->recvRing.buffers);
+        free(handle->recvRing.control);
+        free(handle->recvRing.msgs);
+        free(handle->recvRing.iovecs);
+        free(handle->recvRing.origins);
         free(handle);
     }
 }
 
+void largeUdp_setReceiveBatchSize(largeUdp_t *handle, unsigned int batchSize) {
+    //note the ring is allocated on first use by the receiving thread, so the size can only be changed before that
+    if (handle->recvRing.buffers == NULL) {
+        handle->recvRing.size = batchSize == 0 ? 1 : batchSize > MAX_RECV_BATCH_SIZE ? MAX_RECV_BATCH_SIZE : batchSize;
+    }
+}
+
+int largeUdp_enableKernelTimestamps(int fd) {
+    int flags = SOF_TIMESTAMPING_RX_SOFTWARE | SOF_TIMESTAMPING_SOFTWARE;
+    return setsockopt(fd, SOL_SOCKET, SO_TIMESTAMPING, &flags, sizeof(flags));
+}
+
+void largeUdp_setSendRate(largeUdp_t *handle, unsigned long bytesPerSecond) {
+    pthread_mutex_lock(&handle->dbLock);
+    handle->sendRate = bytesPerSecond;
+    handle->nextSendTime.tv_sec = 0;
+    handle->nextSendTime.tv_nsec = 0;
+    pthread_mutex_unlock(&handle->dbLock);
+}
+
+void largeUdp_setReassemblyTimeout(largeUdp_t *handle, unsigned int timeoutMs) {
+    pthread_mutex_lock(&handle->dbLock);
+    handle->reassemblyTimeoutMs = timeoutMs;
+    pthread_mutex_unlock(&handle->dbLock);
+}
+
+//
+// Waits till size bytes can be sent without exceeding the send rate. The bytes are accounted for the next send.
+//
+static void largeUdp_pace(largeUdp_t *handle, size_t size) {
+    if (handle->sendRate == 0) {
+        return;
+    }
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    if (handle->nextSendTime.tv_sec > now.tv_sec ||
+        (handle->nextSendTime.tv_sec == now.tv_sec && handle->nextSendTime.tv_nsec > now.tv_nsec)) {
+        while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &handle->nextSendTime, NULL) == EINTR) {
+        }
+    } else {
+        handle->nextSendTime = now;
+    }
+    unsigned long long ns = ((unsigned long long) size * 1000000000ULL) / handle->sendRate;
+    handle->nextSendTime.tv_sec += (time_t) (ns / 1000000000ULL);
+    handle->nextSendTime.tv_nsec += (long) (ns % 1000000000ULL);
+    if (handle->nextSendTime.tv_nsec >= 1000000000L) {
+        handle->nextSendTime.tv_sec++;
+        handle->nextSendTime.tv_nsec -= 1000000000L;
+    }
+}
+
+#ifdef __linux__
+static int largeUdp_sendBatch(largeUdp_t *handle, int fd, struct mmsghdr *msgs, unsigned int *batchLen, int *written)
+{
+    if (handle->sendRate > 0) {
+        size_t batchSize = 0;
+        for (unsigned int n = 0; n < *batchLen; n++) {
+            for (size_t i = 0; i < msgs[n].msg_hdr.msg_iovlen; i++) {
+                batchSize += msgs[n].msg_hdr.msg_iov[i].iov_len;
+            }
+        }
+        largeUdp_pace(handle, batchSize);
+    }
+    unsigned int sent = 0;
+    while (sent < *batchLen) {
+        int w = sendmmsg(fd, &msgs[sent], *batchLen - sent, 0);
+        if (w == -1) {
+            perror("sendmmsg()");
+            *batchLen = 0;
+            return -1;
+        }
+        for (int n = 0; n < w; n++) {
+            *written += msgs[sent + n].msg_len;
+        }
+        sent += w;
+    }
+    *batchLen = 0;
+    return 0;
+}
+#endif
+
+//
+// Fills the iovec msg_iov (after the header iovec) with the part of the data of largeMsg_iovec starting at offset.
+// Returns the number of used iovecs, including the header.
+//
+static size_t largeUdp_fillPart(struct iovec *msg_iov, struct iovec *largeMsg_iovec, unsigned int offset, unsigned int partSize)
+{
+    unsigned int remainingOffset = offset;
+    int recvPart = 0;
+    // find the start of the part
+    while (remainingOffset > 0 && remainingOffset >= largeMsg_iovec[recvPart].iov_len) {
+        remainingOffset -= largeMsg_iovec[recvPart].iov_len;
+        recvPart++;
+    }
+    unsigned int remainingData = partSize;
+    size_t iovlen = 1;
+
+    // fill in the output iovec from the input iovec in such a way that all UDP frames are filled maximal.
+    while (remainingData > 0 && iovlen < MAX_MSG_VECTOR_LEN) {
+        unsigned int available = largeMsg_iovec[recvPart].iov_len - remainingOffset;
+        unsigned int partLen = available <= remainingData ? available : remainingData;
+        msg_iov[iovlen].iov_base = (char *) largeMsg_iovec[recvPart].iov_base + remainingOffset;
+        msg_iov[iovlen].iov_len = partLen;
+        remainingData -= partLen;
+        remainingOffset = 0;
+        recvPart++;
+        iovlen++;
+    }
+    return iovlen;
+}
+
 //
 // Write large data to UDP. This function splits the data in chunks and sends these chunks with a header over UDP.
+// The chunks are sent with as few sendmmsg calls as possible (where available). When a send rate is set, the
+// chunks are paced, so that the socket buffers of the receivers do not overflow.
 //
 int largeUdp_sendmsg(largeUdp_t *handle, int fd, struct iovec *largeMsg_iovec, int len, int flags, struct sockaddr_in *dest_addr, size_t addrlen)
 {
     int n;
     int result = 0;
-    msg_part_header_t header;
-
     int written = 0;
-    header.msg_ident = (unsigned int)random();
-    header.total_msg_size = 0;
+    unsigned int msg_ident = (unsigned int)random();
+    unsigned int total_msg_size = 0;
     for (n = 0; n < len ;n++) {
-        header.total_msg_size += largeMsg_iovec[n].iov_len;
+        total_msg_size += largeMsg_iovec[n].iov_len;
     }
-    int nr_buffers = (header.total_msg_size / MAX_PART_SIZE) + 1;
+    int nr_buffers = (total_msg_size / MAX_PART_SIZE) + 1;
 
+    pthread_mutex_lock(&handle->dbLock);
+#ifdef __linux__
+    unsigned int maxBatchLen = MAX_MMSG_BATCH_LEN;
+    if (handle->sendRate > 0 && MAX_PACED_BURST_SIZE / MAX_PART_SIZE < maxBatchLen) {
+        maxBatchLen = MAX_PACED_BURST_SIZE / MAX_PART_SIZE > 0 ? MAX_PACED_BURST_SIZE / MAX_PART_SIZE : 1;
+    }
+    msg_part_header_t headers[MAX_MMSG_BATCH_LEN];
+    struct mmsghdr msgs[MAX_MMSG_BATCH_LEN];
+    struct iovec *msg_iovecs = calloc(MAX_MMSG_BATCH_LEN * MAX_MSG_VECTOR_LEN, sizeof(*msg_iovecs));
+    unsigned int batchLen = 0;
+
+    for (n = 0; n < nr_buffers && result == 0; n++) {
+        msg_part_header_t *header = &headers[batchLen];
+        header->msg_ident = msg_ident;
+        header->total_msg_size = total_msg_size;
+        header->offset = n * MAX_PART_SIZE;
+        header->part_msg_size = (((total_msg_size - header->offset) > MAX_PART_SIZE) ? MAX_PART_SIZE : (total_msg_size - header->offset));
+
+        struct iovec *msg_iovec = &msg_iovecs[batchLen * MAX_MSG_VECTOR_LEN];
+        msg_iovec[0].iov_base = header;
+        msg_iovec[0].iov_len = sizeof(*header);
+
+        memset(&msgs[batchLen], 0, sizeof(msgs[batchLen]));
+        msgs[batchLen].msg_hdr.msg_name = dest_addr;
+        msgs[batchLen].msg_hdr.msg_namelen = addrlen;
+        msgs[batchLen].msg_hdr.msg_iov = msg_iovec;
+        msgs[batchLen].msg_hdr.msg_iovlen = largeUdp_fillPart(msg_iovec, largeMsg_iovec, header->offset, header->part_msg_size);
+        batchLen++;
+
+        if (batchLen == maxBatchLen || n + 1 == nr_buffers) {
+            result = largeUdp_sendBatch(handle, fd, msgs, &batchLen, &written);
+        }
+    }
+    free(msg_iovecs);
+#else
+    msg_part_header_t header;
     struct iovec msg_iovec[MAX_MSG_VECTOR_LEN];
     struct msghdr msg;
     msg.msg_name = dest_addr;
     msg.msg_namelen = addrlen;
     msg.msg_flags = 0;
     msg.msg_iov = msg_iovec;
-    msg.msg_iovlen = 2; // header and payload;
     msg.msg_control = NULL;
     msg.msg_controllen = 0;
 
     msg.msg_iov[0].iov_base = &header;
     msg.msg_iov[0].iov_len = sizeof(header);
+    header.msg_ident = msg_ident;
+    header.total_msg_size = total_msg_size;
 
     for (n = 0; n < nr_buffers; n++) {
-
-        header.part_msg_size = (((header.total_msg_size - n * MAX_PART_SIZE) >  MAX_PART_SIZE) ?  MAX_PART_SIZE  : (header.total_msg_size - n * MAX_PART_SIZE));
         header.offset = n * MAX_PART_SIZE;
-        int remainingOffset = header.offset;
-        int recvPart = 0;
-        // find the start of the part
-        while (remainingOffset > largeMsg_iovec[recvPart].iov_len) {
-            remainingOffset -= largeMsg_iovec[recvPart].iov_len;
-            recvPart++;
-        }
-        int remainingData = header.part_msg_size;
-        int sendPart = 1;
-        msg.msg_iovlen = 1;
-
-        // fill in the output iovec from the input iovec in such a way that all UDP frames are filled maximal.
-        while (remainingData > 0) {
-            int partLen = ( (largeMsg_iovec[recvPart].iov_len - remainingOffset) <= remainingData ? (largeMsg_iovec[recvPart].iov_len -remainingOffset) : remainingData);
-            msg.msg_iov[sendPart].iov_base = largeMsg_iovec[recvPart].iov_base + remainingOffset;
-            msg.msg_iov[sendPart].iov_len = partLen;
-            remainingData -= partLen;
-            remainingOffset = 0;
-            sendPart++;
-            recvPart++;
-            msg.msg_iovlen++;
-        }
-        int tmp, tmptot;
-        for (tmp = 0, tmptot=0; tmp < msg.msg_iovlen; tmp++) {
-            tmptot += msg.msg_iov[tmp].iov_len;
-        }
-
+        header.part_msg_size = (((total_msg_size - header.offset) > MAX_PART_SIZE) ? MAX_PART_SIZE : (total_msg_size - header.offset));
+        msg.msg_iovlen = largeUdp_fillPart(msg.msg_iov, largeMsg_iovec, header.offset, header.part_msg_size);
+        largeUdp_pace(handle, sizeof(header) + header.part_msg_size);
         int w = sendmsg(fd, &msg, 0);
         if (w == -1) {
             perror("send()");
@@ -186,69 +378,230 @@ int largeUdp_sendmsg(largeUdp_t *handle, int fd, struct iovec *largeMsg_iovec, i
         }
         written += w;
     }
+#endif
+    pthread_mutex_unlock(&handle->dbLock);
 
     return (result == 0 ? written : result);
 }
 
 //
-// Write large data to UDP. This function splits the data in chunks and sends these chunks with a header over UDP.
+// Write a batch of messages to UDP. The iovecs of message i are largeMsg_iovecs[i * lenPerMsg] up to
+// largeMsg_iovecs[(i + 1) * lenPerMsg]. Messages fitting in a single part are combined in sendmmsg calls (where
+// available), larger messages are split in chunks as done by largeUdp_sendmsg.
 //
-int largeUdp_sendto(largeUdp_t *handle, int fd, void *buf, size_t count, int flags, struct sockaddr_in *dest_addr, size_t addrlen)
+int largeUdp_sendmmsg(largeUdp_t *handle, int fd, struct iovec *largeMsg_iovecs, int lenPerMsg, unsigned int nrOfMsgs, int flags, struct sockaddr_in *dest_addr, size_t addrlen)
 {
-    int n;
-    int nr_buffers = (count / MAX_PART_SIZE) + 1;
     int result = 0;
-    msg_part_header_t header;
-
     int written = 0;
-    header.msg_ident = (unsigned int)random();
-    header.total_msg_size = count;
-    char *databuf = buf;
-
-    struct iovec msg_iovec[2];
-    struct msghdr msg;
-    msg.msg_name = dest_addr;
-    msg.msg_namelen = addrlen;
-    msg.msg_flags = 0;
-    msg.msg_iov = msg_iovec;
-    msg.msg_iovlen = 2; // header and payload;
-    msg.msg_control = NULL;
-    msg.msg_controllen = 0;
-
-    msg.msg_iov[0].iov_base = &header;
-    msg.msg_iov[0].iov_len = sizeof(header);
+#ifdef __linux__
+    msg_part_header_t headers[MAX_MMSG_BATCH_LEN];
+    struct mmsghdr msgs[MAX_MMSG_BATCH_LEN];
+    struct iovec *msg_iovecs = calloc(MAX_MMSG_BATCH_LEN * (lenPerMsg + 1), sizeof(*msg_iovecs));
+    unsigned int batchLen = 0;
+
+    for (unsigned int i = 0; i < nrOfMsgs && result == 0; i++) {
+        struct iovec *largeMsg_iovec = &largeMsg_iovecs[i * lenPerMsg];
+        unsigned int total_msg_size = 0;
+        for (int n = 0; n < lenPerMsg; n++) {
+            total_msg_size += largeMsg_iovec[n].iov_len;
+        }
 
-    for (n = 0; n < nr_buffers; n++) {
+        if (total_msg_size < MAX_PART_SIZE) {
+            msg_part_header_t *header = &headers[batchLen];
+            header->msg_ident = (unsigned int)random();
+            header->total_msg_size = total_msg_size;
+            header->part_msg_size = total_msg_size;
+            header->offset = 0;
+
+            struct iovec *msg_iovec = &msg_iovecs[batchLen * (lenPerMsg + 1)];
+            msg_iovec[0].iov_base = header;
+            msg_iovec[0].iov_len = sizeof(*header);
+            memcpy(&msg_iovec[1], largeMsg_iovec, lenPerMsg * sizeof(*msg_iovec));
+
+            memset(&msgs[batchLen], 0, sizeof(msgs[batchLen]));
+            msgs[batchLen].msg_hdr.msg_name = dest_addr;
+            msgs[batchLen].msg_hdr.msg_namelen = addrlen;
+            msgs[batchLen].msg_hdr.msg_iov = msg_iovec;
+            msgs[batchLen].msg_hdr.msg_iovlen = lenPerMsg + 1;
+            batchLen++;
+        } else {
+            //note first sending the already batched messages to keep the message order
+            if (batchLen > 0) {
+                pthread_mutex_lock(&handle->dbLock);
+                result = largeUdp_sendBatch(handle, fd, msgs, &batchLen, &written);
+                pthread_mutex_unlock(&handle->dbLock);
+            }
+            int w = result == 0 ? largeUdp_sendmsg(handle, fd, largeMsg_iovec, lenPerMsg, flags, dest_addr, addrlen) : -1;
+            if (w == -1) {
+                result = -1;
+            } else {
+                written += w;
+            }
+        }
 
-        header.part_msg_size = (((header.total_msg_size - n * MAX_PART_SIZE) >  MAX_PART_SIZE) ?  MAX_PART_SIZE  : (header.total_msg_size - n * MAX_PART_SIZE));
-        header.offset = n * MAX_PART_SIZE;
-        msg.msg_iov[1].iov_base = &databuf[header.offset];
-        msg.msg_iov[1].iov_len = header.part_msg_size;
-        int w = sendmsg(fd, &msg, 0);
+        if (result == 0 && batchLen > 0 && (batchLen == MAX_MMSG_BATCH_LEN || i + 1 == nrOfMsgs)) {
+            pthread_mutex_lock(&handle->dbLock);
+            result = largeUdp_sendBatch(handle, fd, msgs, &batchLen, &written);
+            pthread_mutex_unlock(&handle->dbLock);
+        }
+    }
+    free(msg_iovecs);
+#else
+    for (unsigned int i = 0; i < nrOfMsgs; i++) {
+        int w = largeUdp_sendmsg(handle, fd, &largeMsg_iovecs[i * lenPerMsg], lenPerMsg, flags, dest_addr, addrlen);
         if (w == -1) {
-            perror("send()");
-            result =  -1;
+            result = -1;
             break;
         }
         written += w;
-        //usleep(1000); // TODO: If not slept a UDP buffer overflow occurs and parts are missing at the reception side (at least via localhost)
     }
-
+#endif
     return (result == 0 ? written : result);
 }
 
+//
+// Write large data to UDP. This function splits the data in chunks and sends these chunks with a header over UDP.
+//
+int largeUdp_sendto(largeUdp_t *handle, int fd, void *buf, size_t count, int flags, struct sockaddr_in *dest_addr, size_t addrlen)
+{
+    struct iovec largeMsg_iovec;
+    largeMsg_iovec.iov_base = buf;
+    largeMsg_iovec.iov_len = count;
+    return largeUdp_sendmsg(handle, fd, &largeMsg_iovec, 1, flags, dest_addr, addrlen);
+}
+
+//
+// Removes the part lists of which no part is received within the reassembly timeout.
+//
+static void largeUdp_purgeExpired(largeUdp_t *handle, const struct timespec *now) {
+    //note handle->dbLock locked
+    if (largeUdp_elapsedMs(&handle->nextPurgeTime, now) < 0) {
+        return;
+    }
+    hash_map_iterator_t iter = hashMapIterator_construct(handle->udpPartLists);
+    while (hashMapIterator_hasNext(&iter)) {
+        udpPartList_t *udpPartList = hashMapIterator_nextValue(&iter);
+        if (largeUdp_elapsedMs(&udpPartList->lastUpdate, now) >= (long) handle->reassemblyTimeoutMs) {
+            fprintf(stderr, "ERROR: Removing entry for id %u: %u parts not received within %u ms\n",
+                    udpPartList->key.msg_ident, udpPartList->nrPartsRemaining, handle->reassemblyTimeoutMs);
+            hashMapIterator_remove(&iter);
+            largeUdp_freePartList(udpPartList);
+        }
+    }
+    handle->nextPurgeTime = *now;
+    handle->nextPurgeTime.tv_sec += handle->reassemblyTimeoutMs / 2000;
+    handle->nextPurgeTime.tv_nsec += (long) (handle->reassemblyTimeoutMs / 2 % 1000) * 1000000L;
+    if (handle->nextPurgeTime.tv_nsec >= 1000000000L) {
+        handle->nextPurgeTime.tv_sec++;
+        handle->nextPurgeTime.tv_nsec -= 1000000000L;
+    }
+}
+
+//
+// Removes the part list which did not receive a part for the longest time, to make room for a new msg.
+//
+static void largeUdp_removeOldest(largeUdp_t *handle) {
+    //note handle->dbLock locked
+    udpPartList_t *oldest = NULL;
+    hash_map_iterator_t iter = hashMapIterator_construct(handle->udpPartLists);
+    while (hashMapIterator_hasNext(&iter)) {
+        udpPartList_t *udpPartList = hashMapIterator_nextValue(&iter);
+        if (oldest == NULL || largeUdp_elapsedMs(&udpPartList->lastUpdate, &oldest->lastUpdate) > 0) {
+            oldest = udpPartList;
+        }
+    }
+    if (oldest != NULL) {
+        fprintf(stderr, "ERROR: Removing entry for id %u: %u parts not received\n", oldest->key.msg_ident, oldest->nrPartsRemaining);
+        hashMap_remove(handle->udpPartLists, &oldest->key);
+        largeUdp_freePartList(oldest);
+    }
+}
+
+//
+// Returns the part list for the part, creates it if needed. Returns NULL if the part list cannot be created.
+//
+static udpPartList_t* largeUdp_getPartList(largeUdp_t *handle, const udpPartListKey_t *key, const msg_part_header_t *header) {
+    //note handle->dbLock locked
+    udpPartList_t *udpPartList = hashMap_get(handle->udpPartLists, key);
+    if (udpPartList != NULL && udpPartList->msg_size != header->total_msg_size) {
+        // Corruption occurred. Remove the existing administration and build up a new one.
+        hashMap_remove(handle->udpPartLists, key);
+        largeUdp_freePartList(udpPartList);
+        udpPartList = NULL;
+    }
+
+    if (udpPartList == NULL) {
+        if (hashMap_size(handle->udpPartLists) >= (int) handle->maxNrLists) {
+            largeUdp_removeOldest(handle);
+        }
+        udpPartList = calloc(sizeof(*udpPartList), 1);
+        udpPartList->key = *key;
+        udpPartList->msg_size = header->total_msg_size;
+        udpPartList->nrParts = header->total_msg_size / MAX_PART_SIZE + 1;
+        udpPartList->nrPartsRemaining = udpPartList->nrParts;
+        udpPartList->receivedParts = calloc((udpPartList->nrParts + 7) / 8, 1);
+        udpPartList->data = calloc(sizeof(char), header->total_msg_size > 0 ? header->total_msg_size : 1);
+        if (udpPartList->receivedParts == NULL || udpPartList->data == NULL) {
+            largeUdp_freePartList(udpPartList);
+            return NULL;
+        }
+        hashMap_put(handle->udpPartLists, &udpPartList->key, udpPartList);
+    }
+    return udpPartList;
+}
+
+//
+// Registers the received part (of which the payload is stored in the part list). Returns true if the msg is complete,
+// the msg is then moved to the completed lists.
+//
+static bool largeUdp_partReceived(largeUdp_t *handle, udpPartList_t *udpPartList, const msg_part_header_t *header, const struct timespec *now, const struct timespec *receiveTime) {
+    //note handle->dbLock locked
+    unsigned int part = header->offset / MAX_PART_SIZE;
+    if ((udpPartList->receivedParts[part / 8] & (1u << (part % 8))) != 0) {
+        return false; // duplicate
+    }
+    udpPartList->receivedParts[part / 8] |= (uint8_t) (1u << (part % 8));
+    udpPartList->nrPartsRemaining--;
+    udpPartList->lastUpdate = *now;
+    if (receiveTime != NULL) {
+        udpPartList->receiveTime = *receiveTime;
+    }
+    if (udpPartList->nrPartsRemaining == 0) {
+        hashMap_remove(handle->udpPartLists, &udpPartList->key);
+        arrayList_add(handle->completedLists, udpPartList);
+        return true;
+    }
+    return false;
+}
+
+static bool largeUdp_isValidPart(const msg_part_header_t *header) {
+    return header->part_msg_size <= MAX_PART_SIZE && header->offset % MAX_PART_SIZE == 0 &&
+           header->offset <= header->total_msg_size && header->part_msg_size <= header->total_msg_size - header->offset;
+}
+
 //
 // Reads data from the filedescriptor which has date (determined by epoll()) and stores it in the internal structure
+// The parts are reassembled per (origin address, msg id). Duplicated parts are ignored and msgs of which not all
+// parts are received within the reassembly timeout are removed.
 // If the message is completely reassembled true is returned and the index and size have valid values
 //
 bool largeUdp_dataAvailable(largeUdp_t *handle, int fd, unsigned int *index, unsigned int *size) {
     msg_part_header_t header;
-    int result = false;
+    bool result = false;
+    struct sockaddr_in origin;
+    socklen_t originLen = sizeof(origin);
+    memset(&origin, 0, sizeof(origin));
     // Only read the header, we don't know yet where to store the payload
-    if (recv(fd, &header, sizeof(header), MSG_PEEK) < 0) {
+    ssize_t peeked = recvfrom(fd, &header, sizeof(header), MSG_PEEK, (struct sockaddr *) &origin, &originLen);
+    if (peeked < 0) {
         perror("read()");
         return false;
     }
+    if (peeked < (ssize_t) sizeof(header) || !largeUdp_isValidPart(&header)) {
+        // Not a valid part, discard it.
+        recv(fd, &header, sizeof(header), 0);
+        return false;
+    }
 
     struct iovec msg_vec[2];
     struct msghdr msg;
@@ -263,86 +616,178 @@ bool largeUdp_dataAvailable(largeUdp_t *handle, int fd, unsigned int *index, uns
     msg.msg_iov[0].iov_base = &header;
     msg.msg_iov[0].iov_len = sizeof(header);
 
+    udpPartListKey_t key;
+    memset(&key, 0, sizeof(key));
+    key.addr = origin.sin_addr.s_addr;
+    key.port = origin.sin_port;
+    key.msg_ident = header.msg_ident;
+
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
     pthread_mutex_lock(&handle->dbLock);
+    largeUdp_purgeExpired(handle, &now);
 
-    int nrUdpLists = arrayList_size(handle->udpPartLists);
-    int i;
-    bool found = false;
-    for (i = 0; i < nrUdpLists; i++) {
-        udpPartList_t *udpPartList = arrayList_get(handle->udpPartLists, i);
-        if (udpPartList->msg_ident == header.msg_ident) {
-            found = true;
-
-            //sanity check
-            if (udpPartList->msg_size != header.total_msg_size) {
-                // Corruption occurred. Remove the existing administration and build up a new one.
-                arrayList_remove(handle->udpPartLists, i);
-                free(udpPartList->data);
-                free(udpPartList);
-                found = false;
-                break;
-            }
+    udpPartList_t *udpPartList = largeUdp_getPartList(handle, &key, &header);
+    if (udpPartList == NULL) {
+        recv(fd, &header, sizeof(header), 0);
+        pthread_mutex_unlock(&handle->dbLock);
+        return false;
+    }
 
-            msg.msg_iov[1].iov_base = &udpPartList->data[header.offset];
-            msg.msg_iov[1].iov_len = header.part_msg_size;
-            if (recvmsg(fd, &msg, 0)<0) {
-                found=true;
-                result=false;
-                break;
-            }
+    msg.msg_iov[1].iov_base = &udpPartList->data[header.offset];
+    msg.msg_iov[1].iov_len = header.part_msg_size;
+    if (recvmsg(fd, &msg, 0) >= 0) {
+        struct timespec receiveTime;
+        clock_gettime(CLOCK_REALTIME, &receiveTime);
+        if (largeUdp_partReceived(handle, udpPartList, &header, &now, &receiveTime)) {
+            *index = arrayList_size(handle->completedLists) - 1;
+            *size = udpPartList->msg_size;
+            result = true;
+        }
+    }
 
-            udpPartList->nrPartsRemaining--;
-            if (udpPartList->nrPartsRemaining == 0) {
-                *index = i;
-                *size = udpPartList->msg_size;
-                result = true;
-                break;
-            } else {
-                result = false; // not complete
-                break;
+    pthread_mutex_unlock(&handle->dbLock);
+
+    return result;
+}
+
+static bool largeUdp_allocRecvRing(largeUdp_t *handle) {
+    unsigned int n = handle->recvRing.size;
+    handle->recvRing.buffers = malloc((size_t) n * MAX_UDP_MSG_SIZE);
+    handle->recvRing.control = calloc(n, RECV_CONTROL_SIZE);
+    handle->recvRing.msgs = calloc(n, sizeof(*handle->recvRing.msgs));
+    handle->recvRing.iovecs = calloc(n, sizeof(*handle->recvRing.iovecs));
+    handle->recvRing.origins = calloc(n, sizeof(*handle->recvRing.origins));
+    if (handle->recvRing.buffers == NULL || handle->recvRing.control == NULL || handle->recvRing.msgs == NULL ||
+            handle->recvRing.iovecs == NULL || handle->recvRing.origins == NULL) {
+        free(handle->recvRing.buffers);
+        free(handle->recvRing.control);
+        free(handle->recvRing.msgs);
+        free(handle->recvRing.iovecs);
+        free(handle->recvRing.origins);
+        memset(&handle->recvRing, 0, sizeof(handle->recvRing));
+        handle->recvRing.size = n;
+        return false;
+    }
+    for (unsigned int i = 0; i < n; ++i) {
+        handle->recvRing.iovecs[i].iov_base = &handle->recvRing.buffers[(size_t) i * MAX_UDP_MSG_SIZE];
+        handle->recvRing.iovecs[i].iov_len = MAX_UDP_MSG_SIZE;
+    }
+    return true;
+}
+
+//
+// Returns the kernel receive timestamp (SO_TIMESTAMPING) of the received datagram, if present.
+//
+static bool largeUdp_kernelTimestamp(struct msghdr *msg, struct timespec *receiveTime) {
+    for (struct cmsghdr *cmsg = CMSG_FIRSTHDR(msg); cmsg != NULL; cmsg = CMSG_NXTHDR(msg, cmsg)) {
+        if (cmsg->cmsg_level == SOL_SOCKET && cmsg->cmsg_type == SCM_TIMESTAMPING) {
+            struct scm_timestamping ts;
+            memcpy(&ts, CMSG_DATA(cmsg), sizeof(ts));
+            if (ts.ts[0].tv_sec != 0 || ts.ts[0].tv_nsec != 0) {
+                *receiveTime = ts.ts[0];
+                return true;
             }
         }
     }
+    return false;
+}
+
+//
+// Reads the datagrams available on the (readable, determined by epoll()) filedescriptor with a single recvmmsg call,
+// up to the receive batch size, into the preallocated buffer ring and reassembles them as largeUdp_dataAvailable does.
+// Only the payload of the parts of large msgs is copied once more, into the reassembled msg.
+// Returns the nr of msgs completed by this call (read them with largeUdp_readNext), or -1 on error.
+//
+int largeUdp_receive(largeUdp_t *handle, int fd) {
+    if (handle->recvRing.buffers == NULL && !largeUdp_allocRecvRing(handle)) {
+        return -1;
+    }
+
+    unsigned int n = handle->recvRing.size;
+    for (unsigned int i = 0; i < n; ++i) {
+        struct msghdr *hdr = &handle->recvRing.msgs[i].msg_hdr;
+        hdr->msg_name = &handle->recvRing.origins[i];
+        hdr->msg_namelen = sizeof(handle->recvRing.origins[i]);
+        hdr->msg_iov = &handle->recvRing.iovecs[i];
+        hdr->msg_iovlen = 1;
+        hdr->msg_control = &handle->recvRing.control[(size_t) i * RECV_CONTROL_SIZE];
+        hdr->msg_controllen = RECV_CONTROL_SIZE;
+        hdr->msg_flags = 0;
+    }
+
+    int received = recvmmsg(fd, handle->recvRing.msgs, n, MSG_DONTWAIT, NULL);
+    if (received < 0) {
+        if (errno != EAGAIN && errno != EWOULDBLOCK) {
+            perror("recvmmsg()");
+            return -1;
+        }
+        return 0;
+    }
+
+    // One clock read per call, the kernel timestamps (if enabled) are used as receive time instead
+    struct timespec now;
+    struct timespec batchTime;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    clock_gettime(CLOCK_REALTIME, &batchTime);
 
-    if (found == false) {
-        udpPartList_t *udpPartList = NULL;
-        if (nrUdpLists == handle->maxNrLists) {
-            // remove list at index 0
-            udpPartList = arrayList_remove(handle->udpPartLists, 0);
-            fprintf(stderr, "ERROR: Removing entry for id %d: %d parts not received\n",udpPartList->msg_ident, udpPartList->nrPartsRemaining );
-            free(udpPartList->data);
-            free(udpPartList);
-            nrUdpLists--;
+    int completed = 0;
+    pthread_mutex_lock(&handle->dbLock);
+    largeUdp_purgeExpired(handle, &now);
+    for (int i = 0; i < received; ++i) {
+        struct mmsghdr *mmsg = &handle->recvRing.msgs[i];
+        const char *datagram = handle->recvRing.iovecs[i].iov_base;
+        msg_part_header_t header;
+        if (mmsg->msg_len < sizeof(header) || (mmsg->msg_hdr.msg_flags & MSG_TRUNC) != 0) {
+            continue; // Not a valid part, discard it.
+        }
+        memcpy(&header, datagram, sizeof(header));
+        if (!largeUdp_isValidPart(&header) || mmsg->msg_len != sizeof(header) + header.part_msg_size) {
+            continue;
         }
-        udpPartList = calloc(sizeof(*udpPartList), 1);
-        udpPartList->msg_ident =  header.msg_ident;
-        udpPartList->msg_size =  header.total_msg_size;
-        udpPartList->nrPartsRemaining = header.total_msg_size / MAX_PART_SIZE;
-        udpPartList->data = calloc(sizeof(char), header.total_msg_size);
-
-        msg.msg_iov[1].iov_base = &udpPartList->data[header.offset];
-        msg.msg_iov[1].iov_len = header.part_msg_size;
-        if (recvmsg(fd, &msg, 0)<0) {
-            free(udpPartList->data);
-            free(udpPartList);
-            result=false;
-        } else {
-            arrayList_add(handle->udpPartLists, udpPartList);
 
-            if (udpPartList->nrPartsRemaining == 0) {
-                *index = nrUdpLists;
-                *size = udpPartList->msg_size;
-                result = true;
-            } else {
-                result = false;
+        udpPartListKey_t key;
+        memset(&key, 0, sizeof(key));
+        key.addr = handle->recvRing.origins[i].sin_addr.s_addr;
+        key.port = handle->recvRing.origins[i].sin_port;
+        key.msg_ident = header.msg_ident;
+
+        udpPartList_t *udpPartList = largeUdp_getPartList(handle, &key, &header);
+        if (udpPartList != NULL) {
+            struct timespec receiveTime;
+            if (!largeUdp_kernelTimestamp(&mmsg->msg_hdr, &receiveTime)) {
+                receiveTime = batchTime;
+            }
+            memcpy(&udpPartList->data[header.offset], datagram + sizeof(header), header.part_msg_size);
+            if (largeUdp_partReceived(handle, udpPartList, &header, &now, &receiveTime)) {
+                completed++;
             }
         }
-
     }
+    pthread_mutex_unlock(&handle->dbLock);
+
+    return completed;
+}
 
+//
+// Reads out the oldest completed msg. Returns false if there is none.
+//
+bool largeUdp_readNext(largeUdp_t *handle, void **buffer, unsigned int *size, struct timespec *receiveTime) {
+    pthread_mutex_lock(&handle->dbLock);
+    udpPartList_t *udpPartList = arrayList_size(handle->completedLists) > 0 ? arrayList_remove(handle->completedLists, 0) : NULL;
     pthread_mutex_unlock(&handle->dbLock);
 
-    return result;
+    if (udpPartList != NULL) {
+        *buffer = udpPartList->data;
+        *size = udpPartList->msg_size;
+        if (receiveTime != NULL) {
+            *receiveTime = udpPartList->receiveTime;
+        }
+        udpPartList->data = NULL;
+        largeUdp_freePartList(udpPartList);
+    }
+    return udpPartList != NULL;
 }
 
 //
@@ -353,10 +798,11 @@ int largeUdp_read(largeUdp_t *handle, unsigned int index, void ** buffer, unsign
     int result = 0;
     pthread_mutex_lock(&handle->dbLock);
 
-    udpPartList_t *udpPartList = arrayList_remove(handle->udpPartLists, index);
+    udpPartList_t *udpPartList = index < (unsigned int) arrayList_size(handle->completedLists) ? arrayList_remove(handle->completedLists, index) : NULL;
     if (udpPartList) {
         *buffer = udpPartList->data;
-        free(udpPartList);
+        udpPartList->data = NULL;
+        largeUdp_freePartList(udpPartList);
     } else {
         result = -1;
     }
@@ -32,15 +32,32 @@
 #include <sys/types.h>
 #include <sys/socket.h>
 #include <netinet/in.h>
+#include <time.h>
 
 typedef struct largeUdp largeUdp_t;
 
 largeUdp_t *largeUdp_create(unsigned int maxNrUdpReceptions);
 void largeUdp_destroy(largeUdp_t *handle);
 
+// Limits the send rate of the parts of large msgs to bytesPerSecond, 0 (default) sends without pacing.
+void largeUdp_setSendRate(largeUdp_t *handle, unsigned long bytesPerSecond);
+// Sets the time after which a partially received msg is removed, when no new part is received.
+void largeUdp_setReassemblyTimeout(largeUdp_t *handle, unsigned int timeoutMs);
+
 int largeUdp_sendto(largeUdp_t *handle, int fd, void *buf, size_t count, int flags, struct sockaddr_in *dest_addr, size_t addrlen);
 int largeUdp_sendmsg(largeUdp_t *handle, int fd, struct iovec *largeMsg_iovec, int len, int flags, struct sockaddr_in *dest_addr, size_t addrlen);
+int largeUdp_sendmmsg(largeUdp_t *handle, int fd, struct iovec *largeMsg_iovecs, int lenPerMsg, unsigned int nrOfMsgs, int flags, struct sockaddr_in *dest_addr, size_t addrlen);
 bool largeUdp_dataAvailable(largeUdp_t *handle, int fd, unsigned int *index, unsigned int *size);
 int largeUdp_read(largeUdp_t *handle, unsigned int index, void ** buffer, unsigned int size);
 
+// Sets the max nr of datagrams read by a single largeUdp_receive call (default 16), must be called before the first
+// largeUdp_receive call. Every datagram of the batch uses a preallocated 64KB buffer.
+void largeUdp_setReceiveBatchSize(largeUdp_t *handle, unsigned int batchSize);
+// Enables the kernel receive timestamps (SO_TIMESTAMPING) for the socket, these are then used as receive time.
+int largeUdp_enableKernelTimestamps(int fd);
+// Reads the available datagrams with a single recvmmsg call and reassembles them, returns the nr of completed msgs.
+int largeUdp_receive(largeUdp_t *handle, int fd);
+// Reads out the oldest completed msg with the (realtime) receive time of its last part, the buffer must be freed.
+bool largeUdp_readNext(largeUdp_t *handle, void **buffer, unsigned int *size, struct timespec *receiveTime);
+
 #endif /* _LARGE_UDP_H_ */
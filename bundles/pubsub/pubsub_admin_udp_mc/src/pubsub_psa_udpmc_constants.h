@@ -45,6 +45,61 @@
 #define PUBSUB_UDPMC_MULTICAST_IP_DEFAULT           "224.100.1.1"
 #define PUBSUB_UDPMC_VERBOSE_DEFAULT                true
 
+/**
+ * Max nr of bytes per second used to send the udp parts of a large msg. 0 sends the parts without pacing, which can
+ * overflow the socket buffers of the receivers for large (e.g. > 1MB) msgs.
+ */
+#define PUBSUB_UDPMC_SEND_RATE_KEY                  "PSA_UDPMC_SEND_RATE"
+#define PUBSUB_UDPMC_SEND_RATE_DEFAULT              0
+
+/**
+ * Time in ms after which a partially received large msg is removed, when no new part of the msg is received.
+ */
+#define PUBSUB_UDPMC_REASSEMBLY_TIMEOUT_KEY         "PSA_UDPMC_REASSEMBLY_TIMEOUT"
+#define PUBSUB_UDPMC_REASSEMBLY_TIMEOUT_DEFAULT     1000
+
+/**
+ * Max nr of udp datagrams read by the TopicReceiver with a single recvmmsg call. Every datagram of the batch uses a
+ * preallocated 64KB receive buffer.
+ */
+#define PUBSUB_UDPMC_RECV_BATCH_SIZE_KEY            "PSA_UDPMC_RECV_BATCH_SIZE"
+#define PUBSUB_UDPMC_RECV_BATCH_SIZE_DEFAULT        16
+
+/**
+ * If true the TopicReceiver sockets are bound with SO_REUSEPORT, so that multiple receivers (e.g. processes) on the
+ * same host can share the multicast group and port, with the kernel load balancing the datagrams between them.
+ */
+#define PUBSUB_UDPMC_REUSE_PORT_KEY                 "PSA_UDPMC_REUSE_PORT"
+#define PUBSUB_UDPMC_REUSE_PORT_DEFAULT             false
+
+/**
+ * If true the kernel receive timestamps (SO_TIMESTAMPING) of the udp datagrams are used as receive time of the msgs,
+ * instead of the time the msgs are read by the TopicReceiver.
+ */
+#define PUBSUB_UDPMC_KERNEL_TIMESTAMPS_KEY          "PSA_UDPMC_KERNEL_TIMESTAMPS"
+#define PUBSUB_UDPMC_KERNEL_TIMESTAMPS_DEFAULT      false
+
+/**
+ * Comma separated list of interfaces (names or IP addresses, e.g. "eth2,10.1.1.5") for which the TopicReceivers use
+ * busy polling. When the interface used by the admin is listed, the receive thread spins on non blocking reads of its
+ * sockets (with SO_BUSY_POLL, so the kernel polls the NIC queue) instead of sleeping in epoll_wait.
+ * Note that this keeps a core busy per TopicReceiver, so combine it with PSA_UDPMC_BUSY_POLL_CPU.
+ */
+#define PUBSUB_UDPMC_BUSY_POLL_INTERFACES_KEY       "PSA_UDPMC_BUSY_POLL_INTERFACES"
+
+/**
+ * SO_BUSY_POLL time in usec for the sockets of busy polling TopicReceivers. Values above the net.core.busy_read
+ * sysctl require CAP_NET_ADMIN.
+ */
+#define PUBSUB_UDPMC_BUSY_POLL_USEC_KEY             "PSA_UDPMC_BUSY_POLL_USEC"
+#define PUBSUB_UDPMC_BUSY_POLL_USEC_DEFAULT         50
+
+/**
+ * Cpu to pin the receive threads of busy polling TopicReceivers to, -1 is not pinned.
+ */
+#define PUBSUB_UDPMC_BUSY_POLL_CPU_KEY              "PSA_UDPMC_BUSY_POLL_CPU"
+#define PUBSUB_UDPMC_BUSY_POLL_CPU_DEFAULT          -1
+
 /**
  * If set true on the endpoint, the udp mc TopicSender bind and/or discovery url is statically configured.
  */
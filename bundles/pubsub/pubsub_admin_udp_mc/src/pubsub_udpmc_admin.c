@@ -30,6 +30,7 @@
 #include "pubsub_utils.h"
 #include "pubsub_udpmc_admin.h"
 #include "pubsub_psa_udpmc_constants.h"
+#include "pubsub_udpmc_common.h"
 #include "pubsub_udpmc_topic_sender.h"
 #include "pubsub_udpmc_topic_receiver.h"
 
@@ -48,6 +49,7 @@ struct pubsub_udpmc_admin {
     log_helper_t *log;
     char *ifIpAddress; // The local interface which is used for multicast communication
     char *mcIpAddress; // The multicast IP address
+    bool busyPoll; // Whether the TopicReceivers busy poll the interface
     int sendSocket;
     double qosSampleScore;
     double qosControlScore;
@@ -169,6 +171,12 @@ pubsub_udpmc_admin_t* pubsub_udpmcAdmin_create(celix_bundle_context_t *ctx, log_
         L_INFO("[PSA_UDPMC] Using %s as interface for multicast communication", psa->ifIpAddress);
     }
 
+    const char *busyPollItfs = celix_bundleContext_getProperty(ctx, PUBSUB_UDPMC_BUSY_POLL_INTERFACES_KEY, NULL);
+    psa->busyPoll = busyPollItfs != NULL && psa_udpmc_isListedInterface(busyPollItfs, interface, psa->ifIpAddress);
+    if (psa->busyPoll && psa->verbose) {
+        L_INFO("[PSA_UDPMC] Using busy polling for the topic receivers on interface %s", psa->ifIpAddress);
+    }
+
 
     if (mc_ip != NULL) {
         psa->mcIpAddress = mc_ip;
@@ -251,6 +259,7 @@ void pubsub_udpmcAdmin_destroy(pubsub_udpmc_admin_t *psa) {
 
     free(psa->mcIpAddress);
     free(psa->ifIpAddress);
+    pubsub_utils_clearTopicPropertiesCache();
     free(psa);
 }
 
@@ -381,7 +390,7 @@ celix_status_t pubsub_udpmcAdmin_setupTopicReceiver(void *handle, const char *sc
     if (receiver == NULL) {
         psa_udpmc_serializer_entry_t *serEntry = hashMap_get(psa->serializers.map, (void*)serializerSvcId);
         if (serEntry != NULL) {
-            receiver = pubsub_udpmcTopicReceiver_create(psa->ctx, psa->log, scope, topic, psa->ifIpAddress, topicProps, serializerSvcId, serEntry->svc);
+            receiver = pubsub_udpmcTopicReceiver_create(psa->ctx, psa->log, scope, topic, psa->ifIpAddress, psa->busyPoll, topicProps, serializerSvcId, serEntry->svc);
         }
         if (receiver != NULL) {
             const char *psaType = PSA_UDPMC_PUBSUB_ADMIN_TYPE;
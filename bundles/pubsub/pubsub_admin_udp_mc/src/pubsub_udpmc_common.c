@@ -17,9 +17,12 @@
  * under the License.
  */
 
+#include <stdlib.h>
+#include <string.h>
+
 #include "pubsub_udpmc_common.h"
 
-bool psa_udpmc_checkVersion(version_pt msgVersion, pubsub_udp_msg_header_t *hdr) {
+bool psa_udpmc_checkVersion(version_pt msgVersion, const pubsub_udp_msg_header_t *hdr) {
     bool check = false;
 
     if (msgVersion != NULL) {
@@ -34,3 +37,14 @@ bool psa_udpmc_checkVersion(version_pt msgVersion, pubsub_udp_msg_header_t *hdr)
 
     return check;
 }
+
+bool psa_udpmc_isListedInterface(const char *interfaces, const char *interface, const char *ip) {
+    bool listed = false;
+    char *cpy = strndup(interfaces, 1024);
+    char *save = NULL;
+    for (char *itf = strtok_r(cpy, ", ", &save); itf != NULL && !listed; itf = strtok_r(NULL, ", ", &save)) {
+        listed = (interface != NULL && strcmp(itf, interface) == 0) || (ip != NULL && strcmp(itf, ip) == 0);
+    }
+    free(cpy);
+    return listed;
+}
@@ -31,7 +31,12 @@ typedef struct pubsub_udp_msg_header {
 } pubsub_udp_msg_header_t;
 
 
-bool psa_udpmc_checkVersion(version_pt msgVersion, pubsub_udp_msg_header_t *hdr);
+bool psa_udpmc_checkVersion(version_pt msgVersion, const pubsub_udp_msg_header_t *hdr);
+
+/**
+ * Returns whether the interface (by name) or its ip is listed in the comma and/or space separated interfaces.
+ */
+bool psa_udpmc_isListedInterface(const char *interfaces, const char *interface, const char *ip);
 
 
 #endif //CELIX_PUBSUB_UDPMC_COMMON_H
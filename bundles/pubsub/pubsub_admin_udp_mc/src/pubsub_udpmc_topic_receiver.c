@@ -22,7 +22,11 @@
 #include <pubsub/subscriber.h>
 #include <memory.h>
 #include <pubsub_constants.h>
+#include <pubsub_utils.h>
 #include <sys/epoll.h>
+#include <pthread.h>
+#include <sched.h>
+#include <unistd.h>
 #include <assert.h>
 #include <pubsub_endpoint.h>
 #include <arpa/inet.h>
@@ -31,11 +35,15 @@
 #include "pubsub_psa_udpmc_constants.h"
 #include "large_udp.h"
 #include "pubsub_udpmc_common.h"
+#include "pubsub_dispatcher.h"
+#include "pubsub_msg_batch.h"
+#include "celix_probes.h"
 
 #define MAX_EPOLL_EVENTS        10
 #define RECV_THREAD_TIMEOUT     5
 #define UDP_BUFFER_SIZE         65535
 #define MAX_UDP_SESSIONS        16
+#define MAX_BATCH_SIZE          256
 
 #define L_DEBUG(...) \
     logHelper_log(receiver->logHelper, OSGI_LOGSERVICE_DEBUG, __VA_ARGS__)
@@ -55,8 +63,16 @@ struct pubsub_udpmc_topic_receiver {
     char *topic;
     char* ifIpAddress;
     largeUdp_t *largeUdpHandle;
+    bool reusePort;
+    bool kernelTimestamps;
     int topicEpollFd; // EPOLL filedescriptor where the sockets are registered.
 
+    struct {
+        bool enabled; //if true the receive thread spins on the sockets instead of waiting in epoll_wait
+        int usec; //SO_BUSY_POLL of the sockets
+        int cpu; //-1 is not pinned
+    } busyPoll;
+
     struct {
         celix_thread_t thread;
         celix_thread_mutex_t mutex;
@@ -75,6 +91,8 @@ struct pubsub_udpmc_topic_receiver {
         hash_map_t *map; //key = bnd id, value = psa_udpmc_subscriber_entry_t
         bool allInitialized;
     } subscribers;
+
+    pubsub_dispatcher_t *dispatcher; //NULL if msgs are dispatched on the receive thread
 };
 
 typedef struct psa_udpmc_requested_connection_entry {
@@ -93,6 +111,9 @@ typedef struct psa_udpmc_subscriber_entry {
     pubsub_subscriber_t *svc;
 
     bool initialized; //true if the init function is called through the receive thread
+    pubsub_udpmc_topic_receiver_t *receiver;
+    pubsub_dispatch_queue_t *queue; //NULL if msgs are dispatched on the receive thread
+    pubsub_msg_batch_t *batch; //NULL if the subscriber has no receiveBatch or msgs are dispatched through the queue
 } psa_udpmc_subscriber_entry_t;
 
 typedef struct pubsub_udp_msg {
@@ -103,8 +124,12 @@ typedef struct pubsub_udp_msg {
 
 static void pubsub_udpmcTopicReceiver_addSubscriber(void *handle, void *svc, const celix_properties_t *props, const celix_bundle_t *owner);
 static void pubsub_udpmcTopicReceiver_removeSubscriber(void *handle, void *svc, const celix_properties_t *props, const celix_bundle_t *owner);
-static void psa_udpmc_processMsg(pubsub_udpmc_topic_receiver_t *receiver, pubsub_udp_msg_t *msg);
+static void psa_udpmc_processMsg(pubsub_udpmc_topic_receiver_t *receiver, pubsub_udp_msg_t *msg, const struct timespec *receiveTime);
+static void psa_udpmc_dispatchMsg(void *handle, const void *header, const void *payload, size_t payloadSize, const struct timespec *receiveTime, unsigned int nrOfConflatedMsgs);
 static void* psa_udpmc_recvThread(void * data);
+static void psa_udpmc_flushBatches(pubsub_udpmc_topic_receiver_t *receiver);
+static int psa_udpmc_receive(pubsub_udpmc_topic_receiver_t *receiver, int fd);
+static int psa_udpmc_busyPollReceive(pubsub_udpmc_topic_receiver_t *receiver);
 static void psa_udpmc_connectToAllRequestedConnections(pubsub_udpmc_topic_receiver_t *receiver);
 static void psa_udpmc_initializeAllSubscribers(pubsub_udpmc_topic_receiver_t *receiver);
 
@@ -113,6 +138,7 @@ pubsub_udpmc_topic_receiver_t* pubsub_udpmcTopicReceiver_create(celix_bundle_con
                                                                 const char *scope,
                                                                 const char *topic,
                                                                 const char *ifIP,
+                                                                bool busyPoll,
                                                                 const celix_properties_t *topicProperties,
                                                                 long serializerSvcId,
                                                                 pubsub_serializer_service_t *serializer) {
@@ -126,6 +152,13 @@ pubsub_udpmc_topic_receiver_t* pubsub_udpmcTopicReceiver_create(celix_bundle_con
     receiver->ifIpAddress = strndup(ifIP, 1024 * 1024);
     receiver->recvThread.running = true;
     receiver->largeUdpHandle = largeUdp_create(MAX_UDP_SESSIONS);
+    largeUdp_setReassemblyTimeout(receiver->largeUdpHandle, (unsigned int) celix_bundleContext_getPropertyAsLong(ctx, PUBSUB_UDPMC_REASSEMBLY_TIMEOUT_KEY, PUBSUB_UDPMC_REASSEMBLY_TIMEOUT_DEFAULT));
+    largeUdp_setReceiveBatchSize(receiver->largeUdpHandle, (unsigned int) celix_bundleContext_getPropertyAsLong(ctx, PUBSUB_UDPMC_RECV_BATCH_SIZE_KEY, PUBSUB_UDPMC_RECV_BATCH_SIZE_DEFAULT));
+    receiver->reusePort = celix_bundleContext_getPropertyAsBool(ctx, PUBSUB_UDPMC_REUSE_PORT_KEY, PUBSUB_UDPMC_REUSE_PORT_DEFAULT);
+    receiver->kernelTimestamps = celix_bundleContext_getPropertyAsBool(ctx, PUBSUB_UDPMC_KERNEL_TIMESTAMPS_KEY, PUBSUB_UDPMC_KERNEL_TIMESTAMPS_DEFAULT);
+    receiver->busyPoll.enabled = busyPoll;
+    receiver->busyPoll.usec = (int) celix_bundleContext_getPropertyAsLong(ctx, PUBSUB_UDPMC_BUSY_POLL_USEC_KEY, PUBSUB_UDPMC_BUSY_POLL_USEC_DEFAULT);
+    receiver->busyPoll.cpu = (int) celix_bundleContext_getPropertyAsLong(ctx, PUBSUB_UDPMC_BUSY_POLL_CPU_KEY, PUBSUB_UDPMC_BUSY_POLL_CPU_DEFAULT);
     receiver->topicEpollFd = epoll_create1(0);
 
 
@@ -138,6 +171,10 @@ pubsub_udpmc_topic_receiver_t* pubsub_udpmcTopicReceiver_create(celix_bundle_con
     receiver->requestedConnections.map = hashMap_create(utils_stringHash, NULL, utils_stringEquals, NULL);
     receiver->requestedConnections.allConnected = false;
 
+    char dispatcherName[64];
+    snprintf(dispatcherName, 64, "UDPMC TD %s/%s", scope, topic);
+    receiver->dispatcher = pubsub_dispatcher_create(topicProperties, dispatcherName);
+
     //track subscribers
     {
         int size = snprintf(NULL, 0, "(%s=%s)", PUBSUB_SUBSCRIBER_TOPIC, topic);
@@ -193,6 +230,13 @@ pubsub_udpmc_topic_receiver_t* pubsub_udpmcTopicReceiver_create(celix_bundle_con
     }
 
     celixThread_create(&receiver->recvThread.thread, NULL, psa_udpmc_recvThread, receiver);
+    char name[64];
+    snprintf(name, 64, "UDPMC TR %s/%s", scope, topic);
+    celixThread_setName(&receiver->recvThread.thread, name);
+    celix_status_t threadStatus = pubsub_utils_setupThread(&receiver->recvThread.thread, topicProperties);
+    if (threadStatus != CELIX_SUCCESS) {
+        L_WARN("[PSA_UDPMC_TR] Cannot configure the scheduling/cpu affinity of the receive thread of %s/%s. Error %i", scope, topic, threadStatus);
+    }
 
     return receiver;
 }
@@ -224,6 +268,8 @@ void pubsub_udpmcTopicReceiver_destroy(pubsub_udpmc_topic_receiver_t *receiver)
         while (hashMapIterator_hasNext(&iter)) {
             psa_udpmc_subscriber_entry_t *entry = hashMapIterator_nextValue(&iter);
             if (entry != NULL) {
+                pubsub_dispatchQueue_destroy(entry->queue);
+                pubsub_msgBatch_destroy(entry->batch);
                 if (receiver->serializer != NULL && entry->msgTypes != NULL) {
                     receiver->serializer->destroySerializerMap(receiver->serializer->handle, entry->msgTypes);
                 }
@@ -233,6 +279,8 @@ void pubsub_udpmcTopicReceiver_destroy(pubsub_udpmc_topic_receiver_t *receiver)
         celixThreadMutex_unlock(&receiver->subscribers.mutex);
         hashMap_destroy(receiver->subscribers.map, false, false);
 
+        pubsub_dispatcher_destroy(receiver->dispatcher);
+
 
 
         celixThreadMutex_destroy(&receiver->subscribers.mutex);
@@ -330,10 +378,16 @@ static void pubsub_udpmcTopicReceiver_addSubscriber(void *handle, void *svc, con
         entry->usageCount = 1;
         entry->svc = svc;
         entry->initialized = false;
+        entry->receiver = receiver;
         receiver->subscribers.allInitialized = false;
 
         int rc = receiver->serializer->createSerializerMap(receiver->serializer->handle, (celix_bundle_t*)bnd, &entry->msgTypes);
         if (rc == 0) {
+            if (receiver->dispatcher != NULL) {
+                entry->queue = pubsub_dispatcher_createQueue(receiver->dispatcher, entry, psa_udpmc_dispatchMsg);
+            } else {
+                entry->batch = pubsub_msgBatch_create(entry->svc, MAX_BATCH_SIZE);
+            }
             hashMap_put(receiver->subscribers.map, (void*)bndId, entry);
         } else {
             free(entry);
@@ -356,6 +410,9 @@ static void pubsub_udpmcTopicReceiver_removeSubscriber(void *handle, void *svc,
     if (entry != NULL && entry->usageCount <= 0) {
         //remove entry
         hashMap_remove(receiver->subscribers.map, (void*)bndId);
+        //note the dispatch threads never lock the subscribers mutex, so the queue can be destroyed with that mutex locked
+        pubsub_dispatchQueue_destroy(entry->queue);
+        pubsub_msgBatch_destroy(entry->batch);
         int rc =  receiver->serializer->destroySerializerMap(receiver->serializer->handle, entry->msgTypes);
         if (rc != 0) {
             fprintf(stderr, "Cannot find serializer for TopicReceiver %s/%s", receiver->scope, receiver->topic);
@@ -382,6 +439,16 @@ static void* psa_udpmc_recvThread(void * data) {
     bool allInitialized = receiver->subscribers.allInitialized;
     celixThreadMutex_unlock(&receiver->subscribers.mutex);
 
+    if (receiver->busyPoll.enabled && receiver->busyPoll.cpu >= 0) {
+        cpu_set_t cpus;
+        CPU_ZERO(&cpus);
+        CPU_SET(receiver->busyPoll.cpu, &cpus);
+        int rc = pthread_setaffinity_np(pthread_self(), sizeof(cpus), &cpus);
+        if (rc != 0) {
+            L_WARN("[PSA_UDPMC_TR] Cannot pin receive thread of %s/%s to cpu %i (%s)", receiver->scope, receiver->topic, receiver->busyPoll.cpu, strerror(rc));
+        }
+    }
+
     while (running) {
         if (!allConnected) {
             psa_udpmc_connectToAllRequestedConnections(receiver);
@@ -390,22 +457,18 @@ static void* psa_udpmc_recvThread(void * data) {
             psa_udpmc_initializeAllSubscribers(receiver);
         }
 
-        int nfds = epoll_wait(receiver->topicEpollFd, events, MAX_EPOLL_EVENTS, RECV_THREAD_TIMEOUT * 1000);
-        int i;
-        for (i = 0; i < nfds; i++ ) {
-            unsigned int index;
-            unsigned int size;
-            if (largeUdp_dataAvailable(receiver->largeUdpHandle, events[i].data.fd, &index, &size) == true) {
-                // Handle data
-                pubsub_udp_msg_t *udpMsg = NULL;
-                if (largeUdp_read(receiver->largeUdpHandle, index, (void**) &udpMsg, size) != 0) {
-                    printf("[PSA_UDPMC]: ERROR largeUdp_read with index %d\n", index);
-                    continue;
-                }
-
-                psa_udpmc_processMsg(receiver, udpMsg);
-
-                free(udpMsg);
+        if (receiver->busyPoll.enabled) {
+            if (psa_udpmc_busyPollReceive(receiver) > 0) {
+                psa_udpmc_flushBatches(receiver);
+            }
+        } else {
+            int nfds = epoll_wait(receiver->topicEpollFd, events, MAX_EPOLL_EVENTS, RECV_THREAD_TIMEOUT * 1000);
+            int i;
+            for (i = 0; i < nfds; i++ ) {
+                psa_udpmc_receive(receiver, events[i].data.fd);
+            }
+            if (nfds > 0) {
+                psa_udpmc_flushBatches(receiver);
             }
         }
 
@@ -425,48 +488,138 @@ static void* psa_udpmc_recvThread(void * data) {
     return NULL;
 }
 
-static void psa_udpmc_processMsg(pubsub_udpmc_topic_receiver_t *receiver, pubsub_udp_msg_t *msg) {
-    celixThreadMutex_lock(&receiver->subscribers.mutex);
-    hash_map_iterator_t iter = hashMapIterator_construct(receiver->subscribers.map);
-    while (hashMapIterator_hasNext(&iter)) {
-        psa_udpmc_subscriber_entry_t *entry = hashMapIterator_nextValue(&iter);
-
-        pubsub_msg_serializer_t *msgSer = NULL;
-        if (entry->msgTypes != NULL) {
-            msgSer = hashMap_get(entry->msgTypes, (void *) (uintptr_t) msg->header.type);
+/**
+ * Reads all datagrams available (up to the batch size) with one syscall, then handles the completed msgs.
+ * Returns the nr of handled msgs.
+ */
+static int psa_udpmc_receive(pubsub_udpmc_topic_receiver_t *receiver, int fd) {
+    int count = 0;
+    if (largeUdp_receive(receiver->largeUdpHandle, fd) > 0) {
+        pubsub_udp_msg_t *udpMsg = NULL;
+        unsigned int size;
+        struct timespec receiveTime;
+        while (largeUdp_readNext(receiver->largeUdpHandle, (void**) &udpMsg, &size, &receiveTime)) {
+            psa_udpmc_processMsg(receiver, udpMsg, &receiveTime);
+            free(udpMsg);
+            count++;
         }
-        if (msgSer == NULL) {
-            printf("[PSA_UDPMC] Serializer not available for message %d.\n", msg->header.type);
-        } else {
-            void *msgInst = NULL;
-            bool validVersion = psa_udpmc_checkVersion(msgSer->msgVersion, &msg->header);
+    }
+    return count;
+}
 
-            if (validVersion) {
-                celix_status_t status = msgSer->deserialize(msgSer->handle, (const void *)msg->payload, 0, &msgInst);
+/**
+ * Reads the connected sockets without waiting in epoll_wait. With SO_BUSY_POLL the kernel polls the NIC queue of an
+ * empty socket for a short time, instead of returning directly.
+ * Returns the nr of handled msgs.
+ */
+static int psa_udpmc_busyPollReceive(pubsub_udpmc_topic_receiver_t *receiver) {
+    int fds[MAX_EPOLL_EVENTS];
+    int nrFds = 0;
+    celixThreadMutex_lock(&receiver->requestedConnections.mutex);
+    hash_map_iterator_t iter = hashMapIterator_construct(receiver->requestedConnections.map);
+    while (hashMapIterator_hasNext(&iter) && nrFds < MAX_EPOLL_EVENTS) {
+        psa_udpmc_requested_connection_entry_t *entry = hashMapIterator_nextValue(&iter);
+        if (entry->connected) {
+            fds[nrFds++] = entry->recvSocket;
+        }
+    }
+    celixThreadMutex_unlock(&receiver->requestedConnections.mutex);
 
-                if (status == CELIX_SUCCESS) {
-                    bool release = true;
-                    pubsub_subscriber_t *svc = entry->svc;
-                    svc->receive(svc->handle, msgSer->msgName, msg->header.type, msgInst, &release);
+    int count = 0;
+    for (int i = 0; i < nrFds; ++i) {
+        count += psa_udpmc_receive(receiver, fds[i]);
+    }
+    if (nrFds == 0) {
+        //nothing connected yet, prevent spinning on the mutex
+        usleep(1000);
+    }
+    return count;
+}
 
-                    if (release) {
-                        msgSer->freeMsg(msgSer->handle, msgInst);
-                    }
+static void psa_udpmc_processMsgForSubscriberEntry(psa_udpmc_subscriber_entry_t *entry, const pubsub_udp_msg_header_t *hdr, const char *payload) {
+    //NOTE receiver->subscribers.mutex locked or called from the dispatch queue of the entry
+    pubsub_msg_serializer_t *msgSer = NULL;
+    if (entry->msgTypes != NULL) {
+        msgSer = hashMap_get(entry->msgTypes, (void *) (uintptr_t) hdr->type);
+    }
+    if (msgSer == NULL) {
+        printf("[PSA_UDPMC] Serializer not available for message %d.\n", hdr->type);
+    } else {
+        void *msgInst = NULL;
+        bool validVersion = psa_udpmc_checkVersion(msgSer->msgVersion, hdr);
+
+        if (validVersion) {
+            celix_status_t status = msgSer->deserialize(msgSer->handle, (const void *)payload, 0, &msgInst);
+
+            if (status == CELIX_SUCCESS) {
+                bool release = true;
+                pubsub_subscriber_t *svc = entry->svc;
+                if (entry->batch != NULL) {
+                    pubsub_msgBatch_add(entry->batch, msgSer, msgInst);
+                    release = false;
                 } else {
-                    printf("[PSA_UDPMC] Cannot deserialize msgType %s.\n",msgSer->msgName);
+                    svc->receive(svc->handle, msgSer->msgName, hdr->type, msgInst, &release);
                 }
 
+                if (release) {
+                    msgSer->freeMsg(msgSer->handle, msgInst);
+                }
             } else {
-                int major = 0, minor = 0;
-                version_getMajor(msgSer->msgVersion, &major);
-                version_getMinor(msgSer->msgVersion, &minor);
-                printf("[PSA_UDPMC] Version mismatch for primary message '%s' (have %d.%d, received %u.%u). NOT sending any part of the whole message.\n",
-                       msgSer->msgName,major,minor,msg->header.major,msg->header.minor);
+                printf("[PSA_UDPMC] Cannot deserialize msgType %s.\n",msgSer->msgName);
             }
 
+        } else {
+            int major = 0, minor = 0;
+            version_getMajor(msgSer->msgVersion, &major);
+            version_getMinor(msgSer->msgVersion, &minor);
+            printf("[PSA_UDPMC] Version mismatch for primary message '%s' (have %d.%d, received %u.%u). NOT sending any part of the whole message.\n",
+                   msgSer->msgName,major,minor,hdr->major,hdr->minor);
+        }
+    }
+}
+
+static void psa_udpmc_dispatchMsg(void *handle, const void *header, const void *payload, size_t payloadSize __attribute__((unused)), const struct timespec *receiveTime __attribute__((unused)), unsigned int nrOfConflatedMsgs __attribute__((unused))) {
+    psa_udpmc_processMsgForSubscriberEntry(handle, header, payload);
+}
+
+static void psa_udpmc_processMsg(pubsub_udpmc_topic_receiver_t *receiver, pubsub_udp_msg_t *msg, const struct timespec *receiveTime) {
+    CELIX_PROBE4(psa_receive, PUBSUB_UDPMC_ADMIN_TYPE, receiver->topic, msg->header.type, msg->payloadSize);
+    //the raw msg is copied once and shared between the dispatch queues of all subscribers
+    pubsub_dispatch_msg_t *dispatchMsg = NULL;
+    if (receiver->dispatcher != NULL) {
+        dispatchMsg = pubsub_dispatchMsg_create(&msg->header, sizeof(msg->header), msg->payload, msg->payloadSize, receiveTime);
+        //the udpmc header has no origin, conflated per msg type (only used if conflation is configured)
+        pubsub_dispatchMsg_setConflationKey(dispatchMsg, &msg->header.type, sizeof(msg->header.type));
+    }
+
+    celixThreadMutex_lock(&receiver->subscribers.mutex);
+    hash_map_iterator_t iter = hashMapIterator_construct(receiver->subscribers.map);
+    while (hashMapIterator_hasNext(&iter)) {
+        psa_udpmc_subscriber_entry_t *entry = hashMapIterator_nextValue(&iter);
+        if (entry->queue != NULL) {
+            if (!pubsub_dispatchQueue_enqueue(entry->queue, dispatchMsg)) {
+                L_WARN("[PSA_UDPMC_TR] Dispatch queue full for scope/topic %s/%s, dropping msg with type id 0x%X", receiver->scope, receiver->topic, msg->header.type);
+            }
+        } else {
+            psa_udpmc_processMsgForSubscriberEntry(entry, &msg->header, msg->payload);
         }
     }
     celixThreadMutex_unlock(&receiver->subscribers.mutex);
+
+    pubsub_dispatchMsg_release(dispatchMsg);
+}
+
+/**
+ * Delivers the msgs collected for the subscribers with a batch, called after the readable msgs of an epoll cycle are processed.
+ */
+static void psa_udpmc_flushBatches(pubsub_udpmc_topic_receiver_t *receiver) {
+    celixThreadMutex_lock(&receiver->subscribers.mutex);
+    hash_map_iterator_t iter = hashMapIterator_construct(receiver->subscribers.map);
+    while (hashMapIterator_hasNext(&iter)) {
+        psa_udpmc_subscriber_entry_t *entry = hashMapIterator_nextValue(&iter);
+        pubsub_msgBatch_flush(entry->batch);
+    }
+    celixThreadMutex_unlock(&receiver->subscribers.mutex);
 }
 
 void pubsub_udpmcTopicReceiver_listConnections(pubsub_udpmc_topic_receiver_t *receiver, celix_array_list_t *connections) {
@@ -489,6 +642,23 @@ static bool psa_udpmc_connectToEntry(pubsub_udpmc_topic_receiver_t *receiver, ps
     if (entry->recvSocket >= 0) {
         int reuse = 1;
         rc = setsockopt(entry->recvSocket, SOL_SOCKET, SO_REUSEADDR, (char*) &reuse, sizeof(reuse));
+        if (rc >= 0 && receiver->reusePort) {
+            rc = setsockopt(entry->recvSocket, SOL_SOCKET, SO_REUSEPORT, (char*) &reuse, sizeof(reuse));
+        }
+    }
+    if (entry->recvSocket >= 0 && rc >= 0 && receiver->kernelTimestamps) {
+        if (largeUdp_enableKernelTimestamps(entry->recvSocket) < 0) {
+            L_WARN("[PSA_UDPMC_TR] Cannot enable kernel timestamps for %s:%li (%s), using the read time as receive time", entry->socketAddress, entry->socketPort, strerror(errno));
+        }
+    }
+    if (entry->recvSocket >= 0 && rc >= 0 && receiver->busyPoll.enabled) {
+        if (setsockopt(entry->recvSocket, SOL_SOCKET, SO_BUSY_POLL, &receiver->busyPoll.usec, sizeof(receiver->busyPoll.usec)) < 0) {
+            L_WARN("[PSA_UDPMC_TR] Cannot set SO_BUSY_POLL for %s:%li (%s), polling the socket only", entry->socketAddress, entry->socketPort, strerror(errno));
+        }
+#ifdef SO_PREFER_BUSY_POLL
+        int prefer = 1;
+        setsockopt(entry->recvSocket, SOL_SOCKET, SO_PREFER_BUSY_POLL, &prefer, sizeof(prefer));
+#endif
     }
     if (entry->recvSocket >= 0 && rc >= 0) {
         struct ip_mreq mc_addr;
@@ -31,6 +31,7 @@ pubsub_udpmc_topic_receiver_t* pubsub_udpmcTopicReceiver_create(celix_bundle_con
         const char *scope, 
         const char *topic, 
         const char *ifIP,
+        bool busyPoll,
         const celix_properties_t *topicProperties,
         long serializerSvcId,
         pubsub_serializer_service_t *serializer);
@@ -30,8 +30,7 @@
 #include "pubsub_psa_udpmc_constants.h"
 #include "large_udp.h"
 #include "pubsub_udpmc_common.h"
-
-#define FIRST_SEND_DELAY_IN_SECONDS     2
+#include "celix_probes.h"
 
 //TODO make configurable
 #define UDP_BASE_PORT                   49152
@@ -50,6 +49,7 @@ struct pubsub_udpmc_topic_sender {
 
     int sendSocket;
     struct sockaddr_in destAddr;
+    unsigned long sendRate;
 
     struct {
         long svcId;
@@ -82,6 +82,7 @@ static int psa_udpmc_localMsgTypeIdForMsgType(void* handle, const char* msgType,
 static void* psa_udpmc_getPublisherService(void *handle, const celix_bundle_t *requestingBundle, const celix_properties_t *svcProperties);
 static void psa_udpmc_ungetPublisherService(void *handle, const celix_bundle_t *requestingBundle, const celix_properties_t *svcProperties);
 static int psa_udpmc_topicPublicationSend(void* handle, unsigned int msgTypeId, const void *inMsg);
+static int psa_udpmc_topicPublicationSendMany(void* handle, unsigned int msgTypeId, const void **inMsgs, size_t n);
 static bool psa_udpmc_sendMsg(psa_udpmc_bounded_service_entry_t *entry, pubsub_udp_msg_t* msg);
 static unsigned int rand_range(unsigned int min, unsigned int max);
 
@@ -98,6 +99,7 @@ pubsub_udpmc_topic_sender_t* pubsub_udpmcTopicSender_create(
     sender->ctx = ctx;
     sender->serializerSvcId = serializerSvcId;
     sender->serializer = serializer;
+    sender->sendRate = (unsigned long) celix_bundleContext_getPropertyAsLong(ctx, PUBSUB_UDPMC_SEND_RATE_KEY, PUBSUB_UDPMC_SEND_RATE_DEFAULT);
     sender->scope = strndup(scope, 1024 * 1024);
     sender->topic = strndup(topic, 1024 * 1024);
 
@@ -217,6 +219,7 @@ static void* psa_udpmc_getPublisherService(void *handle, const celix_bundle_t *r
         entry->parent = sender;
         entry->bndId = bndId;
         entry->largeUdpHandle = largeUdp_create(1);
+        largeUdp_setSendRate(entry->largeUdpHandle, sender->sendRate);
         entry->msgTypeIds = hashMap_create(utils_stringHash, NULL, utils_stringEquals, NULL);
 
         int rc = sender->serializer->createSerializerMap(sender->serializer->handle, (celix_bundle_t*)requestingBundle, &entry->msgTypes);
@@ -230,6 +233,7 @@ static void* psa_udpmc_getPublisherService(void *handle, const celix_bundle_t *r
             entry->service.handle = entry;
             entry->service.localMsgTypeIdForMsgType = psa_udpmc_localMsgTypeIdForMsgType;
             entry->service.send = psa_udpmc_topicPublicationSend;
+            entry->service.sendMany = psa_udpmc_topicPublicationSendMany;
             hashMap_put(sender->boundedServices.map, (void*)bndId, entry);
             svc = &entry->service;
         } else {
@@ -269,6 +273,7 @@ static void psa_udpmc_ungetPublisherService(void *handle, const celix_bundle_t *
 
 static int psa_udpmc_topicPublicationSend(void* handle, unsigned int msgTypeId, const void *inMsg) {
     psa_udpmc_bounded_service_entry_t *entry = handle;
+    CELIX_PROBE4(psa_send, PUBSUB_UDPMC_ADMIN_TYPE, entry->parent->topic, msgTypeId, 1);
     int status = 0;
 
     pubsub_msg_serializer_t* msgSer = NULL;
@@ -315,15 +320,68 @@ static int psa_udpmc_topicPublicationSend(void* handle, unsigned int msgTypeId,
     return status;
 }
 
-static void delay_first_send_for_late_joiners() {
+static int psa_udpmc_topicPublicationSendMany(void* handle, unsigned int msgTypeId, const void **inMsgs, size_t n) {
+    psa_udpmc_bounded_service_entry_t *entry = handle;
+    CELIX_PROBE4(psa_send, PUBSUB_UDPMC_ADMIN_TYPE, entry->parent->topic, msgTypeId, n);
+    int status = 0;
 
-    static bool firstSend = true;
+    pubsub_msg_serializer_t* msgSer = NULL;
+    if (entry->msgTypes != NULL) {
+        msgSer = hashMap_get(entry->msgTypes, (void*)(intptr_t)(msgTypeId));
+    }
+    if (msgSer == NULL) {
+        printf("[PSA_UDPMC/TopicSender] No msg serializer available for msg type id %d\n", msgTypeId);
+        return -1;
+    }
 
-    if (firstSend) {
-        printf("PSA_UDP_MC_TP: Delaying first send for late joiners...\n");
-        sleep(FIRST_SEND_DELAY_IN_SECONDS);
-        firstSend = false;
+    pubsub_udp_msg_header_t msg_hdr;
+    memset(&msg_hdr, 0, sizeof(msg_hdr));
+    msg_hdr.type = msgTypeId;
+    if (msgSer->msgVersion != NULL) {
+        int major = 0, minor = 0;
+        version_getMajor(msgSer->msgVersion, &major);
+        version_getMinor(msgSer->msgVersion, &minor);
+        msg_hdr.major = (unsigned char) major;
+        msg_hdr.minor = (unsigned char) minor;
     }
+
+    //note every msg is send as header + size + payload, see psa_udpmc_sendMsg
+    const int iovec_len = 3;
+    struct iovec *msg_iovecs = calloc(n * iovec_len, sizeof(*msg_iovecs));
+    unsigned int *payloadSizes = calloc(n, sizeof(*payloadSizes));
+    unsigned int nrOfMsgs = 0;
+    for (size_t i = 0; i < n; ++i) {
+        void* serializedOutput = NULL;
+        size_t serializedOutputLen = 0;
+        if (msgSer->serialize(msgSer->handle, inMsgs[i], &serializedOutput, &serializedOutputLen) == CELIX_SUCCESS) {
+            payloadSizes[nrOfMsgs] = (unsigned int) serializedOutputLen;
+            struct iovec *msg_iovec = &msg_iovecs[nrOfMsgs * iovec_len];
+            msg_iovec[0].iov_base = &msg_hdr;
+            msg_iovec[0].iov_len = sizeof(msg_hdr);
+            msg_iovec[1].iov_base = &payloadSizes[nrOfMsgs];
+            msg_iovec[1].iov_len = sizeof(payloadSizes[nrOfMsgs]);
+            msg_iovec[2].iov_base = serializedOutput;
+            msg_iovec[2].iov_len = serializedOutputLen;
+            nrOfMsgs += 1;
+        } else {
+            printf("[PSA_UDPMC/TopicSender] Serialization of msg type id %d failed\n", msgTypeId);
+            status = -1;
+        }
+    }
+
+    if (nrOfMsgs > 0) {
+        if (largeUdp_sendmmsg(entry->largeUdpHandle, entry->parent->sendSocket, msg_iovecs, iovec_len, nrOfMsgs, 0, &entry->parent->destAddr, sizeof(entry->parent->destAddr)) == -1) {
+            perror("send_pubsub_msgs:sendSocket");
+            status = -1;
+        }
+    }
+
+    for (unsigned int i = 0; i < nrOfMsgs; ++i) {
+        free(msg_iovecs[i * iovec_len + 2].iov_base);
+    }
+    free(msg_iovecs);
+    free(payloadSizes);
+    return status;
 }
 
 static bool psa_udpmc_sendMsg(psa_udpmc_bounded_service_entry_t *entry, pubsub_udp_msg_t* msg) {
@@ -338,8 +396,6 @@ static bool psa_udpmc_sendMsg(psa_udpmc_bounded_service_entry_t *entry, pubsub_u
     msg_iovec[2].iov_base = msg->payload;
     msg_iovec[2].iov_len = msg->payloadSize;
 
-    delay_first_send_for_late_joiners();
-
     if (largeUdp_sendmsg(entry->largeUdpHandle, entry->parent->sendSocket, msg_iovec, iovec_len, 0, &entry->parent->destAddr, sizeof(entry->parent->destAddr)) == -1) {
         perror("send_pubsub_msg:sendSocket");
         ret = false;
@@ -36,6 +36,12 @@
 #define PUBSUB_WEBSOCKET_VERBOSE_DEFAULT              true
 
 #define PUBSUB_WEBSOCKET_ADMIN_TYPE                   "websocket"
+
+/**
+ * Msgs of the serializer with this type are sent as text websocket frames with a JSON envelope (e.g. for browsers).
+ * Msgs of other serializers (e.g. avrobin) are sent as binary websocket frames, see psa_websocket_encodeBinaryFrame.
+ */
+#define PSA_WEBSOCKET_TEXT_SERIALIZER_TYPE            "json"
 #define PUBSUB_WEBSOCKET_ADDRESS_KEY                  "websocket.socket_address"
 #define PUBSUB_WEBSOCKET_PORT_KEY                     "websocket.socket_port"
 
@@ -20,7 +20,6 @@
 #ifndef CELIX_PUBSUB_WEBSOCKET_ADMIN_H
 #define CELIX_PUBSUB_WEBSOCKET_ADMIN_H
 
-#include <pubsub_admin_metrics.h>
 #include "celix_api.h"
 #include "log_helper.h"
 #include "pubsub_psa_websocket_constants.h"
@@ -48,7 +47,5 @@ void pubsub_websocketAdmin_removeSerializerSvc(void *handle, void *svc, const ce
 
 celix_status_t pubsub_websocketAdmin_executeCommand(void *handle, char *commandLine, FILE *outStream, FILE *errStream);
 
-pubsub_admin_metrics_t* pubsub_websocketAdmin_metrics(void *handle);
-
 #endif //CELIX_PUBSUB_WEBSOCKET_ADMIN_H
 
@@ -20,6 +20,8 @@
 #include <memory.h>
 #include <assert.h>
 #include <stdio.h>
+#include <stdlib.h>
+#include <arpa/inet.h>
 #include "pubsub_websocket_common.h"
 
 bool psa_websocket_checkVersion(version_pt msgVersion, const pubsub_websocket_msg_header_t *hdr) {
@@ -66,3 +68,45 @@ char *psa_websocket_createURI(const char *scope, const char *topic) {
     }
     return uri;
 }
+
+char* psa_websocket_encodeBinaryFrame(const pubsub_websocket_msg_header_t *hdr, const void *payload, size_t payloadSize, size_t *outFrameSize) {
+    size_t idSize = strlen(hdr->id) + 1;
+    if (idSize > UINT16_MAX) {
+        return NULL;
+    }
+    size_t frameSize = PSA_WEBSOCKET_BINARY_HEADER_SIZE + idSize + payloadSize;
+    char *frame = malloc(frameSize);
+    uint16_t netIdSize = htons((uint16_t) idSize);
+    uint32_t netSeqNr = htonl(hdr->seqNr);
+    frame[0] = (char) hdr->major;
+    frame[1] = (char) hdr->minor;
+    memcpy(frame + 2, &netIdSize, sizeof(netIdSize));
+    memcpy(frame + 4, &netSeqNr, sizeof(netSeqNr));
+    memcpy(frame + PSA_WEBSOCKET_BINARY_HEADER_SIZE, hdr->id, idSize);
+    if (payloadSize > 0) {
+        memcpy(frame + PSA_WEBSOCKET_BINARY_HEADER_SIZE + idSize, payload, payloadSize);
+    }
+    *outFrameSize = frameSize;
+    return frame;
+}
+
+bool psa_websocket_decodeBinaryFrame(const char *frame, size_t frameSize, pubsub_websocket_msg_header_t *outHdr, const char **outPayload, size_t *outPayloadSize) {
+    if (frameSize < PSA_WEBSOCKET_BINARY_HEADER_SIZE) {
+        return false;
+    }
+    uint16_t netIdSize;
+    uint32_t netSeqNr;
+    memcpy(&netIdSize, frame + 2, sizeof(netIdSize));
+    memcpy(&netSeqNr, frame + 4, sizeof(netSeqNr));
+    size_t idSize = ntohs(netIdSize);
+    if (idSize == 0 || frameSize < PSA_WEBSOCKET_BINARY_HEADER_SIZE + idSize || frame[PSA_WEBSOCKET_BINARY_HEADER_SIZE + idSize - 1] != '\0') {
+        return false;
+    }
+    outHdr->major = (uint8_t) frame[0];
+    outHdr->minor = (uint8_t) frame[1];
+    outHdr->seqNr = ntohl(netSeqNr);
+    outHdr->id = frame + PSA_WEBSOCKET_BINARY_HEADER_SIZE;
+    *outPayload = frame + PSA_WEBSOCKET_BINARY_HEADER_SIZE + idSize;
+    *outPayloadSize = frameSize - PSA_WEBSOCKET_BINARY_HEADER_SIZE - idSize;
+    return true;
+}
@@ -22,6 +22,7 @@
 
 #include <utils.h>
 #include <stdint.h>
+#include <stddef.h>
 
 #include "version.h"
 
@@ -35,9 +36,26 @@ struct pubsub_websocket_msg_header {
 
 typedef struct pubsub_websocket_msg_header pubsub_websocket_msg_header_t;
 
+/**
+ * Size of the fixed part of a binary frame: major (uint8), minor (uint8), id size (uint16) and seqNr (uint32),
+ * in network byte order. The fixed part is followed by the '\0' terminated msg FQN (id size bytes) and the payload.
+ */
+#define PSA_WEBSOCKET_BINARY_HEADER_SIZE 8
+
 void psa_websocket_setScopeAndTopicFilter(const char* scope, const char *topic, char *filter);
 char *psa_websocket_createURI(const char *scope, const char *topic);
 
 bool psa_websocket_checkVersion(version_pt msgVersion, const pubsub_websocket_msg_header_t *hdr);
 
+/**
+ * Creates a binary websocket frame for the header and serialized payload. The caller frees the frame.
+ */
+char* psa_websocket_encodeBinaryFrame(const pubsub_websocket_msg_header_t *hdr, const void *payload, size_t payloadSize, size_t *outFrameSize);
+
+/**
+ * Decodes a binary websocket frame. The id of the header and the payload point into the frame.
+ * Returns false if the frame is malformed.
+ */
+bool psa_websocket_decodeBinaryFrame(const char *frame, size_t frameSize, pubsub_websocket_msg_header_t *outHdr, const char **outPayload, size_t *outPayloadSize);
+
 #endif //CELIX_PUBSUB_WEBSOCKET_COMMON_H
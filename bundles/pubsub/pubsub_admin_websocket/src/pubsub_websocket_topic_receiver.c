@@ -22,6 +22,7 @@
 #include <pubsub/subscriber.h>
 #include <memory.h>
 #include <pubsub_constants.h>
+#include <pubsub_utils.h>
 #include <sys/epoll.h>
 #include <assert.h>
 #include <pubsub_endpoint.h>
@@ -35,6 +36,8 @@
 #include <uuid/uuid.h>
 #include <http_admin/api.h>
 #include <jansson.h>
+#include <civetweb.h>
+#include "celix_probes.h"
 
 #ifndef UUID_STR_LEN
 #define UUID_STR_LEN 37
@@ -56,6 +59,7 @@ typedef struct pubsub_websocket_rcv_buffer {
 } pubsub_websocket_rcv_buffer_t;
 
 typedef struct pubsub_websocket_msg_entry {
+    int opCode; //websocket frame opcode, text frames contain a JSON envelope and binary frames a binary header
     size_t msgSize;
     const char *msgData;
 } pubsub_websocket_msg_entry_t;
@@ -216,6 +220,10 @@ pubsub_websocket_topic_receiver_t* pubsub_websocketTopicReceiver_create(celix_bu
         char name[64];
         snprintf(name, 64, "WEBSOCKET TR %s/%s", scope, topic);
         celixThread_setName(&receiver->recvThread.thread, name);
+        celix_status_t threadStatus = pubsub_utils_setupThread(&receiver->recvThread.thread, topicProperties);
+        if (threadStatus != CELIX_SUCCESS) {
+            L_WARN("[PSA_WEBSOCKET_TR] Cannot configure the scheduling/cpu affinity of the receive thread of %s/%s. Error %i", scope, topic, threadStatus);
+        }
     }
 
     if (receiver->uri == NULL) {
@@ -462,6 +470,30 @@ static inline void processMsgForSubscriberEntry(pubsub_websocket_topic_receiver_
     }
 }
 
+static void psa_websocket_deliverMsg(pubsub_websocket_topic_receiver_t *receiver, pubsub_websocket_msg_header_t *hdr, const char *payload, size_t payloadSize) {
+    CELIX_PROBE4(psa_receive, PUBSUB_WEBSOCKET_ADMIN_TYPE, receiver->topic, 0, payloadSize); //note msgs are identified by fqn
+    celixThreadMutex_lock(&receiver->subscribers.mutex);
+    hash_map_iterator_t iter = hashMapIterator_construct(receiver->subscribers.map);
+    while (hashMapIterator_hasNext(&iter)) {
+        psa_websocket_subscriber_entry_t *entry = hashMapIterator_nextValue(&iter);
+        if (entry != NULL) {
+            processMsgForSubscriberEntry(receiver, entry, hdr, payload, payloadSize);
+        }
+    }
+    celixThreadMutex_unlock(&receiver->subscribers.mutex);
+}
+
+static inline void processBinaryMsg(pubsub_websocket_topic_receiver_t *receiver, const char *msg, size_t msgSize) {
+    pubsub_websocket_msg_header_t hdr;
+    const char *payload = NULL;
+    size_t payloadSize = 0;
+    if (psa_websocket_decodeBinaryFrame(msg, msgSize, &hdr, &payload, &payloadSize)) {
+        psa_websocket_deliverMsg(receiver, &hdr, payload, payloadSize);
+    } else {
+        L_WARN("[PSA_WEBSOCKET_TR] Received malformed binary websocket frame of %zu bytes", msgSize);
+    }
+}
+
 static inline void processMsg(pubsub_websocket_topic_receiver_t *receiver, const char *msg, size_t msgSize) {
     json_error_t error;
     json_t *jsMsg = json_loadb(msg, msgSize, 0, &error);
@@ -482,16 +514,7 @@ static inline void processMsg(pubsub_websocket_topic_receiver_t *receiver, const
             size_t payloadSize = strlen(payload);
             printf("Received msg: id %s\tmajor %u\tminor %u\tseqNr %u\tdata %s\n", hdr.id, hdr.major, hdr.minor, hdr.seqNr, payload);
 
-            celixThreadMutex_lock(&receiver->subscribers.mutex);
-            hash_map_iterator_t iter = hashMapIterator_construct(receiver->subscribers.map);
-            while (hashMapIterator_hasNext(&iter)) {
-                psa_websocket_subscriber_entry_t *entry = hashMapIterator_nextValue(&iter);
-                if (entry != NULL) {
-                    processMsgForSubscriberEntry(receiver, entry, &hdr, payload, payloadSize);
-                }
-            }
-            celixThreadMutex_unlock(&receiver->subscribers.mutex);
-            free((void *) hdr.id);
+            psa_websocket_deliverMsg(receiver, &hdr, payload, payloadSize);
             free((void *) payload);
         } else {
             L_WARN("[PSA_WEBSOCKET_TR] Received unsupported message: "
@@ -500,6 +523,7 @@ static inline void processMsg(pubsub_websocket_topic_receiver_t *receiver, const
                    json_integer_value(jsMajor), json_integer_value(jsMinor),
                    json_integer_value(jsSeqNr), (jsData ? "TRUE" : "FALSE"));
         }
+        json_decref(jsMsg); //note also frees the id string of the header
     } else {
         L_WARN("[PSA_WEBSOCKET_TR] Failed to load websocket JSON message, error line: %d, error message: %s", error.line, error.text);
         return;
@@ -537,7 +561,11 @@ static void* psa_websocket_recvThread(void * data) {
             celix_arrayList_removeAt(receiver->recvBuffer.list, 0);
             celixThreadMutex_unlock(&receiver->recvBuffer.mutex);
 
-            processMsg(receiver, msg->msgData, msg->msgSize);
+            if (msg->opCode == MG_WEBSOCKET_OPCODE_BINARY) {
+                processBinaryMsg(receiver, msg->msgData, msg->msgSize);
+            } else if (msg->opCode == MG_WEBSOCKET_OPCODE_TEXT) {
+                processMsg(receiver, msg->msgData, msg->msgSize);
+            }
             free((void *)msg->msgData);
             free(msg);
         }
@@ -559,7 +587,7 @@ static void* psa_websocket_recvThread(void * data) {
 }
 
 static int psa_websocketTopicReceiver_data(struct mg_connection *connection __attribute__((unused)),
-                                            int op_code __attribute__((unused)),
+                                            int op_code,
                                             char *data,
                                             size_t length,
                                             void *handle) {
@@ -571,6 +599,7 @@ static int psa_websocketTopicReceiver_data(struct mg_connection *connection __at
         pubsub_websocket_msg_entry_t *msg = malloc(sizeof(*msg));
         const char *rcvdMsgData = malloc(length);
         memcpy((void *) rcvdMsgData, data, length);
+        msg->opCode = op_code & 0xf; //note the high bits contain the FIN and RSV flags
         msg->msgData = rcvdMsgData;
         msg->msgSize = length;
         celix_arrayList_add(entry->recvBuffer->list, msg);
@@ -20,7 +20,6 @@
 #ifndef CELIX_PUBSUB_WEBSOCKET_TOPIC_RECEIVER_H
 #define CELIX_PUBSUB_WEBSOCKET_TOPIC_RECEIVER_H
 
-#include <pubsub_admin_metrics.h>
 #include "celix_bundle_context.h"
 
 typedef struct pubsub_websocket_topic_receiver pubsub_websocket_topic_receiver_t;
@@ -44,7 +43,4 @@ void pubsub_websocketTopicReceiver_connectTo(pubsub_websocket_topic_receiver_t *
 void pubsub_websocketTopicReceiver_disconnectFrom(pubsub_websocket_topic_receiver_t *receiver, const char *uri);
 
 
-pubsub_admin_receiver_metrics_t* pubsub_websocketTopicReceiver_metrics(pubsub_websocket_topic_receiver_t *receiver);
-
-
 #endif //CELIX_PUBSUB_WEBSOCKET_TOPIC_RECEIVER_H
@@ -31,10 +31,10 @@
 #include <uuid/uuid.h>
 #include <jansson.h>
 #include "celix_constants.h"
+#include "celix_hash_map.h"
 #include "http_admin/api.h"
 #include "civetweb.h"
-
-#define FIRST_SEND_DELAY_IN_SECONDS             2
+#include "celix_probes.h"
 
 #define L_DEBUG(...) \
     logHelper_log(sender->logHelper, OSGI_LOGSERVICE_DEBUG, __VA_ARGS__)
@@ -55,6 +55,7 @@ struct pubsub_websocket_topic_sender {
     char *topic;
     char scopeAndTopicFilter[5];
     char *uri;
+    bool binaryFrames; //true if msgs are sent as binary frames, false for text frames with a JSON envelope
 
     celix_websocket_service_t websockSvc;
     long websockSvcId;
@@ -83,16 +84,60 @@ typedef struct psa_websocket_bounded_service_entry {
     long bndId;
     hash_map_t *msgTypes; //key = msg type id, value = pubsub_msg_serializer_t
     hash_map_t *msgTypeIds; //key = msg name, value = msg type id
-    hash_map_t *msgEntries; //key = msg type id, value = psa_websocket_send_msg_entry_t
+    celix_long_hash_map_t *msgEntries; //key = msg type id, value = psa_websocket_send_msg_entry_t*
     int getCount;
 } psa_websocket_bounded_service_entry_t;
 
 static int psa_websocket_localMsgTypeIdForMsgType(void* handle __attribute__((unused)), const char* msgType, unsigned int* msgTypeId);
 static void* psa_websocket_getPublisherService(void *handle, const celix_bundle_t *requestingBundle, const celix_properties_t *svcProperties);
 static void psa_websocket_ungetPublisherService(void *handle, const celix_bundle_t *requestingBundle, const celix_properties_t *svcProperties);
-static void delay_first_send_for_late_joiners(pubsub_websocket_topic_sender_t *sender);
 
 static int psa_websocket_topicPublicationSend(void* handle, unsigned int msgTypeId, const void *msg);
+static void psa_websocket_sendTextFrame(pubsub_websocket_topic_sender_t *sender, psa_websocket_send_msg_entry_t *entry, const void *serialized, size_t serializedLen) {
+    //NOTE entry->sendLock locked
+    json_error_t jsError;
+    json_t *jsMsg = json_object();
+    json_object_set_new(jsMsg, "id", json_string(entry->header.id));
+    json_object_set_new(jsMsg, "major", json_integer(entry->header.major));
+    json_object_set_new(jsMsg, "minor", json_integer(entry->header.minor));
+    json_object_set_new(jsMsg, "seqNr", json_integer(entry->header.seqNr++));
+
+    json_t *jsData;
+    jsData = json_loadb((const char *)serialized, serializedLen - 1, 0, &jsError);
+    if(jsData != NULL) {
+        json_object_set_new(jsMsg, "data", jsData);
+        const char *msg = json_dumps(jsMsg, 0);
+        size_t bytes_to_write = strlen(msg);
+        int bytes_written = mg_websocket_client_write(sender->sockConnection, MG_WEBSOCKET_OPCODE_TEXT, msg,
+                                                      bytes_to_write);
+        free((void *) msg);
+        json_decref(jsData); //Decrease ref count means freeing the object
+        if (bytes_written != (int) bytes_to_write) {
+            L_WARN("[PSA_WEBSOCKET_TS] Error sending websocket, written %d of total %lu bytes", bytes_written, bytes_to_write);
+        }
+    } else {
+        L_WARN("[PSA_WEBSOCKET_TS] Error sending websocket, serialized data corrupt. Error(%d;%d;%d): %s", jsError.column, jsError.line, jsError.position, jsError.text);
+    }
+    json_decref(jsMsg); //Decrease ref count means freeing the object
+}
+
+static void psa_websocket_sendBinaryFrame(pubsub_websocket_topic_sender_t *sender, psa_websocket_send_msg_entry_t *entry, const void *serialized, size_t serializedLen) {
+    //NOTE entry->sendLock locked
+    size_t frameSize = 0;
+    char *frame = psa_websocket_encodeBinaryFrame(&entry->header, serialized, serializedLen, &frameSize);
+    entry->header.seqNr++;
+    if (frame != NULL) {
+        int bytes_written = mg_websocket_client_write(sender->sockConnection, MG_WEBSOCKET_OPCODE_BINARY, frame, frameSize);
+        if (bytes_written != (int) frameSize) {
+            L_WARN("[PSA_WEBSOCKET_TS] Error sending websocket, written %d of total %lu bytes", bytes_written, frameSize);
+        }
+        free(frame);
+    } else {
+        L_WARN("[PSA_WEBSOCKET_TS] Error sending websocket, cannot create binary frame for msg type %s", entry->msgSer->msgName);
+    }
+}
+
+static int psa_websocket_topicPublicationSendMany(void* handle, unsigned int msgTypeId, const void **msgs, size_t n);
 
 static void psa_websocketTopicSender_ready(struct mg_connection *connection, void *handle);
 static void psa_websocketTopicSender_close(const struct mg_connection *connection, void *handle);
@@ -103,12 +148,14 @@ pubsub_websocket_topic_sender_t* pubsub_websocketTopicSender_create(
         const char *scope,
         const char *topic,
         long serializerSvcId,
+        const char *serType,
         pubsub_serializer_service_t *ser) {
     pubsub_websocket_topic_sender_t *sender = calloc(1, sizeof(*sender));
     sender->ctx = ctx;
     sender->logHelper = logHelper;
     sender->serializerSvcId = serializerSvcId;
     sender->serializer = ser;
+    sender->binaryFrames = serType == NULL || strcmp(serType, PSA_WEBSOCKET_TEXT_SERIALIZER_TYPE) != 0;
     psa_websocket_setScopeAndTopicFilter(scope, topic, sender->scopeAndTopicFilter);
     sender->uri = psa_websocket_createURI(scope, topic);
 
@@ -171,13 +218,12 @@ void pubsub_websocketTopicSender_destroy(pubsub_websocket_topic_sender_t *sender
             if (entry != NULL) {
                 sender->serializer->destroySerializerMap(sender->serializer->handle, entry->msgTypes);
 
-                hash_map_iterator_t iter2 = hashMapIterator_construct(entry->msgEntries);
-                while (hashMapIterator_hasNext(&iter2)) {
-                    psa_websocket_send_msg_entry_t *msgEntry = hashMapIterator_nextValue(&iter2);
+                for (celix_long_hash_map_iterator_t iter2 = celix_longHashMap_begin(entry->msgEntries); !celix_longHashMapIterator_isEnd(&iter2); celix_longHashMapIterator_next(&iter2)) {
+                    psa_websocket_send_msg_entry_t *msgEntry = iter2.value;
                     free(msgEntry);
 
                 }
-                hashMap_destroy(entry->msgEntries, false, false);
+                celix_longHashMap_destroy(entry->msgEntries);
 
                 free(entry);
             }
@@ -231,7 +277,7 @@ static void* psa_websocket_getPublisherService(void *handle, const celix_bundle_
         entry->getCount = 1;
         entry->parent = sender;
         entry->bndId = bndId;
-        entry->msgEntries = hashMap_create(NULL, NULL, NULL, NULL);
+        entry->msgEntries = celix_longHashMap_create();
         entry->msgTypeIds = hashMap_create(utils_stringHash, NULL, utils_stringEquals, NULL);
 
         int rc = sender->serializer->createSerializerMap(sender->serializer->handle, (celix_bundle_t*)requestingBundle, &entry->msgTypes);
@@ -249,12 +295,13 @@ static void* psa_websocket_getPublisherService(void *handle, const celix_bundle_
                 version_getMinor(sendEntry->msgSer->msgVersion, &minor);
                 sendEntry->header.major = (uint8_t)major;
                 sendEntry->header.minor = (uint8_t)minor;
-                hashMap_put(entry->msgEntries, key, sendEntry);
+                celix_longHashMap_put(entry->msgEntries, (long)(uintptr_t)key, sendEntry);
                 hashMap_put(entry->msgTypeIds, strndup(sendEntry->msgSer->msgName, 1024), (void *)(uintptr_t) sendEntry->msgSer->msgId);
             }
             entry->service.handle = entry;
             entry->service.localMsgTypeIdForMsgType = psa_websocket_localMsgTypeIdForMsgType;
             entry->service.send = psa_websocket_topicPublicationSend;
+            entry->service.sendMany = psa_websocket_topicPublicationSendMany;
             hashMap_put(sender->boundedServices.map, (void*)bndId, entry);
         } else {
             L_ERROR("Error creating serializer map for websocket TopicSender %s/%s", sender->scope, sender->topic);
@@ -282,12 +329,11 @@ static void psa_websocket_ungetPublisherService(void *handle, const celix_bundle
             L_ERROR("Error destroying publisher service, serializer not available / cannot get msg serializer map\n");
         }
 
-        hash_map_iterator_t iter = hashMapIterator_construct(entry->msgEntries);
-        while (hashMapIterator_hasNext(&iter)) {
-            psa_websocket_send_msg_entry_t *msgEntry = hashMapIterator_nextValue(&iter);
+        for (celix_long_hash_map_iterator_t iter = celix_longHashMap_begin(entry->msgEntries); !celix_longHashMapIterator_isEnd(&iter); celix_longHashMapIterator_next(&iter)) {
+            psa_websocket_send_msg_entry_t *msgEntry = iter.value;
             free(msgEntry);
         }
-        hashMap_destroy(entry->msgEntries, false, false);
+        celix_longHashMap_destroy(entry->msgEntries);
 
         hashMap_destroy(entry->msgTypeIds, true, false);
         free(entry);
@@ -296,55 +342,47 @@ static void psa_websocket_ungetPublisherService(void *handle, const celix_bundle
 }
 
 static int psa_websocket_topicPublicationSend(void* handle, unsigned int msgTypeId, const void *inMsg) {
+    return psa_websocket_topicPublicationSendMany(handle, msgTypeId, &inMsg, 1);
+}
+
+static int psa_websocket_topicPublicationSendMany(void* handle, unsigned int msgTypeId, const void **inMsgs, size_t n) {
     int status = CELIX_SERVICE_EXCEPTION;
     psa_websocket_bounded_service_entry_t *bound = handle;
     pubsub_websocket_topic_sender_t *sender = bound->parent;
-    psa_websocket_send_msg_entry_t *entry = hashMap_get(bound->msgEntries, (void *) (uintptr_t) (msgTypeId));
+    CELIX_PROBE4(psa_send, PUBSUB_WEBSOCKET_ADMIN_TYPE, sender->topic, msgTypeId, n);
+    psa_websocket_send_msg_entry_t *entry = celix_longHashMap_get(bound->msgEntries, (long)msgTypeId);
 
     if (sender->sockConnection != NULL && entry != NULL) {
-        delay_first_send_for_late_joiners(sender);
-
-        void *serializedOutput = NULL;
-        size_t serializedOutputLen = 0;
-        status = entry->msgSer->serialize(entry->msgSer->handle, inMsg, &serializedOutput, &serializedOutputLen);
-
-        if (status == CELIX_SUCCESS /*ser ok*/) {
-            json_error_t jsError;
-            unsigned char *hdrEncoded = calloc(sizeof(pubsub_websocket_msg_header_t), sizeof(unsigned char));
-
-            celixThreadMutex_lock(&entry->sendLock);
-
-            json_t *jsMsg = json_object();
-            json_object_set_new(jsMsg, "id", json_string(entry->header.id));
-            json_object_set_new(jsMsg, "major", json_integer(entry->header.major));
-            json_object_set_new(jsMsg, "minor", json_integer(entry->header.minor));
-            json_object_set_new(jsMsg, "seqNr", json_integer(entry->header.seqNr++));
-
-            json_t *jsData;
-            jsData = json_loadb((const char *)serializedOutput, serializedOutputLen - 1, 0, &jsError);
-            if(jsData != NULL) {
-                json_object_set_new(jsMsg, "data", jsData);
-                const char *msg = json_dumps(jsMsg, 0);
-                size_t bytes_to_write = strlen(msg);
-                int bytes_written = mg_websocket_client_write(sender->sockConnection, MG_WEBSOCKET_OPCODE_TEXT, msg,
-                                                              bytes_to_write);
-                free((void *) msg);
-                json_decref(jsData); //Decrease ref count means freeing the object
-                if (bytes_written != (int) bytes_to_write) {
-                    L_WARN("[PSA_WEBSOCKET_TS] Error sending websocket, written %d of total %lu bytes", bytes_written, bytes_to_write);
-                }
-            } else {
-                L_WARN("[PSA_WEBSOCKET_TS] Error sending websocket, serialized data corrupt. Error(%d;%d;%d): %s", jsError.column, jsError.line, jsError.position, jsError.text);
+        //note serializing all msgs first, so that the send lock is only taken once for the whole batch
+        void **serializedOutputs = calloc(n, sizeof(*serializedOutputs));
+        size_t *serializedOutputLens = calloc(n, sizeof(*serializedOutputLens));
+        status = CELIX_SUCCESS;
+        for (size_t i = 0; i < n; ++i) {
+            celix_status_t rc = entry->msgSer->serialize(entry->msgSer->handle, inMsgs[i], &serializedOutputs[i], &serializedOutputLens[i]);
+            if (rc != CELIX_SUCCESS) {
+                serializedOutputs[i] = NULL;
+                status = rc;
+                L_WARN("[PSA_WEBSOCKET_TS] Error serialize message of type %s for scope/topic %s/%s",
+                       entry->msgSer->msgName, sender->scope, sender->topic);
             }
-            celixThreadMutex_unlock(&entry->sendLock);
+        }
 
-            json_decref(jsMsg); //Decrease ref count means freeing the object
-            free(hdrEncoded);
-            free(serializedOutput);
-        } else {
-            L_WARN("[PSA_WEBSOCKET_TS] Error serialize message of type %s for scope/topic %s/%s",
-                   entry->msgSer->msgName, sender->scope, sender->topic);
+        celixThreadMutex_lock(&entry->sendLock);
+        for (size_t i = 0; i < n; ++i) {
+            if (serializedOutputs[i] == NULL) {
+                continue;
+            }
+            if (sender->binaryFrames) {
+                psa_websocket_sendBinaryFrame(sender, entry, serializedOutputs[i], serializedOutputLens[i]);
+            } else {
+                psa_websocket_sendTextFrame(sender, entry, serializedOutputs[i], serializedOutputLens[i]);
+            }
+            free(serializedOutputs[i]);
         }
+        celixThreadMutex_unlock(&entry->sendLock);
+
+        free(serializedOutputs);
+        free(serializedOutputLens);
     } else if (entry == NULL){
         L_WARN("[PSA_WEBSOCKET_TS] Error sending message with msg type id %i for scope/topic %s/%s", msgTypeId, sender->scope, sender->topic);
     }
@@ -363,14 +401,3 @@ static void psa_websocketTopicSender_close(const struct mg_connection *connectio
     pubsub_websocket_topic_sender_t *sender = (pubsub_websocket_topic_sender_t *) handle;
     sender->sockConnection = NULL;
 }
-
-static void delay_first_send_for_late_joiners(pubsub_websocket_topic_sender_t *sender) {
-
-    static bool firstSend = true;
-
-    if (firstSend) {
-        L_INFO("PSA_WEBSOCKET_TP: Delaying first send for late joiners...\n");
-        sleep(FIRST_SEND_DELAY_IN_SECONDS);
-        firstSend = false;
-    }
-}
@@ -21,7 +21,6 @@
 #define CELIX_PUBSUB_WEBSOCKET_TOPIC_SENDER_H
 
 #include "celix_bundle_context.h"
-#include "pubsub_admin_metrics.h"
 
 typedef struct pubsub_websocket_topic_sender pubsub_websocket_topic_sender_t;
 
@@ -31,6 +30,7 @@ pubsub_websocket_topic_sender_t* pubsub_websocketTopicSender_create(
         const char *scope,
         const char *topic,
         long serializerSvcId,
+        const char *serType,
         pubsub_serializer_service_t *ser);
 void pubsub_websocketTopicSender_destroy(pubsub_websocket_topic_sender_t *sender);
 
@@ -40,9 +40,4 @@ const char* pubsub_websocketTopicSender_url(pubsub_websocket_topic_sender_t *sen
 
 long pubsub_websocketTopicSender_serializerSvcId(pubsub_websocket_topic_sender_t *sender);
 
-/**
- * Returns a array of pubsub_admin_sender_msg_type_metrics_t entries for every msg_type/bundle send with the topic sender.
- */
-pubsub_admin_sender_metrics_t* pubsub_websocketTopicSender_metrics(pubsub_websocket_topic_sender_t *sender);
-
 #endif //CELIX_PUBSUB_WEBSOCKET_TOPIC_SENDER_H
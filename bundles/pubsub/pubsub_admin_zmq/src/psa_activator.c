@@ -89,7 +89,7 @@ int psa_zmq_start(psa_zmq_activator_t *act, celix_bundle_context_t *ctx) {
 
     if (status == CELIX_SUCCESS) {
         act->adminMetricsService.handle = act->admin;
-        act->adminMetricsService.metrics = pubsub_zmqAdmin_metrics;
+        act->adminMetricsService.visitMetrics = pubsub_zmqAdmin_visitMetrics;
 
         celix_properties_t *props = celix_properties_create();
         celix_properties_set(props, PUBSUB_ADMIN_SERVICE_TYPE, PUBSUB_ZMQ_ADMIN_TYPE);
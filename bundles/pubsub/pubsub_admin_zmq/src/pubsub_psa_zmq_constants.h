@@ -39,9 +39,30 @@
 #define PSA_ZMQ_METRICS_ENABLED "PSA_ZMQ_METRICS_ENABLED"
 #define PSA_ZMQ_DEFAULT_METRICS_ENABLED true
 
+/**
+ * Only time the (de)serialization of 1 in N msgs for the metrics. The msg counters are always updated.
+ */
+#define PSA_ZMQ_METRICS_SAMPLE_INTERVAL "PSA_ZMQ_METRICS_SAMPLE_INTERVAL"
+#define PSA_ZMQ_DEFAULT_METRICS_SAMPLE_INTERVAL 1
+
+/**
+ * If true the send and receive time of msgs are taken with CLOCK_REALTIME_COARSE (resolution of a scheduler tick)
+ * instead of CLOCK_REALTIME. Note that this also lowers the resolution of the delay metrics.
+ */
+#define PSA_ZMQ_METRICS_COARSE_CLOCK "PSA_ZMQ_METRICS_COARSE_CLOCK"
+#define PSA_ZMQ_DEFAULT_METRICS_COARSE_CLOCK false
+
 #define PSA_ZMQ_ZEROCOPY_ENABLED "PSA_ZMQ_ZEROCOPY_ENABLED"
 #define PSA_ZMQ_DEFAULT_ZEROCOPY_ENABLED false
 
+/**
+ * If true the topic senders send the header and payload in a single frame (filter + header/payload), instead of
+ * a separate header and payload frame. The payload is then always copied (PSA_ZMQ_ZEROCOPY_ENABLED is ignored).
+ * Topic receivers accept both formats, but receivers of older versions only accept separate frames.
+ */
+#define PSA_ZMQ_COMBINED_FRAME_ENABLED "PSA_ZMQ_COMBINED_FRAME_ENABLED"
+#define PSA_ZMQ_DEFAULT_COMBINED_FRAME_ENABLED false
+
 
 #define PUBSUB_ZMQ_VERBOSE_KEY      "PSA_ZMQ_VERBOSE"
 #define PUBSUB_ZMQ_VERBOSE_DEFAULT  true
@@ -50,6 +71,21 @@
 #define PUBSUB_ZMQ_PSA_ITF_KEY      "PSA_INTERFACE"
 #define PUBSUB_ZMQ_NR_THREADS_KEY   "PSA_ZMQ_NR_THREADS"
 
+/**
+ * Whether the topic receivers share a single zmq context (and its IO threads) with the topic senders, instead of
+ * creating a zmq context per topic receiver. The nr of IO threads of the shared context is configured with
+ * PSA_ZMQ_NR_THREADS.
+ * Topic receivers with a configured thread.realtime.prio or thread.realtime.sched keep using their own zmq context.
+ */
+#define PSA_ZMQ_SHARED_CONTEXT          "PSA_ZMQ_SHARED_CONTEXT"
+#define PSA_ZMQ_DEFAULT_SHARED_CONTEXT  true
+
+/**
+ * Comma separated list of cpus (e.g. "2,3") to pin the IO threads of the shared zmq context to.
+ * Requires zmq 4.3 or newer (ZMQ_THREAD_AFFINITY_CPU_ADD).
+ */
+#define PSA_ZMQ_THREAD_AFFINITY         "PSA_ZMQ_THREAD_AFFINITY"
+
 #define PUBSUB_ZMQ_DEFAULT_IP       "127.0.0.1"
 
 #define PUBSUB_ZMQ_ADMIN_TYPE       "zmq"
@@ -24,6 +24,7 @@
 #include <netdb.h>
 #include <ifaddrs.h>
 #include <pubsub_endpoint.h>
+#include <pubsub/subscriber.h>
 #include <czmq.h>
 #include <pubsub_serializer.h>
 #include <ip_utils.h>
@@ -32,6 +33,9 @@
 #include "pubsub_zmq_admin.h"
 #include "pubsub_psa_zmq_constants.h"
 #include "pubsub_zmq_topic_sender.h"
+#ifdef BUILD_WITH_ZMQ_SECURITY
+#include "zmq_crypto.h"
+#endif
 #include "pubsub_zmq_topic_receiver.h"
 
 #define L_DEBUG(...) \
@@ -50,6 +54,7 @@ struct pubsub_zmq_admin {
 
     char *ipAddress;
     zactor_t *zmq_auth;
+    void *zmqCtx; //shared zmq context of the topic receivers (the czmq context), NULL if not shared
 
     unsigned int basePort;
     unsigned int maxPort;
@@ -89,6 +94,7 @@ typedef struct psa_zmq_serializer_entry {
 } psa_zmq_serializer_entry_t;
 
 static celix_status_t zmq_getIpAddress(const char* interface, char** ip);
+static void pubsub_zmqAdmin_setThreadAffinity(pubsub_zmq_admin_t *psa, void *zmqCtx, const char *cpus);
 static celix_status_t pubsub_zmqAdmin_connectEndpointToReceiver(pubsub_zmq_admin_t* psa, pubsub_zmq_topic_receiver_t *receiver, const celix_properties_t *endpoint);
 static celix_status_t pubsub_zmqAdmin_disconnectEndpointFromReceiver(pubsub_zmq_admin_t* psa, pubsub_zmq_topic_receiver_t *receiver, const celix_properties_t *endpoint);
 
@@ -97,6 +103,22 @@ static bool pubsub_zmqAdmin_endpointIsPublisher(const celix_properties_t *endpoi
     return type != NULL && strncmp(PUBSUB_PUBLISHER_ENDPOINT_TYPE, type, strlen(PUBSUB_PUBLISHER_ENDPOINT_TYPE)) == 0;
 }
 
+/**
+ * Returns the topic sender with the scope/topic of the endpoint or NULL.
+ * Note should be called with the topicSenders mutex locked.
+ */
+static pubsub_zmq_topic_sender_t* pubsub_zmqAdmin_senderForEndpoint(pubsub_zmq_admin_t *psa, const celix_properties_t *endpoint) {
+    const char *scope = celix_properties_get(endpoint, PUBSUB_ENDPOINT_TOPIC_SCOPE, NULL);
+    const char *topic = celix_properties_get(endpoint, PUBSUB_ENDPOINT_TOPIC_NAME, NULL);
+    if (scope == NULL || topic == NULL) {
+        return NULL;
+    }
+    char *key = pubsubEndpoint_createScopeTopicKey(scope, topic);
+    pubsub_zmq_topic_sender_t *sender = hashMap_get(psa->topicSenders.map, key);
+    free(key);
+    return sender;
+}
+
 pubsub_zmq_admin_t* pubsub_zmqAdmin_create(celix_bundle_context_t *ctx, log_helper_t *logHelper) {
     pubsub_zmq_admin_t *psa = calloc(1, sizeof(*psa));
     psa->ctx = ctx;
@@ -153,6 +175,15 @@ pubsub_zmq_admin_t* pubsub_zmqAdmin_create(celix_bundle_context_t *ctx, log_help
         L_INFO("[PSA_ZMQ] Using %d threads for ZMQ", (size_t)nrThreads);
     }
 
+    //note the czmq context is used by the topic senders (zsock_new) and, if shared, also by the topic receivers
+    const char *affinity = celix_bundleContext_getProperty(ctx, PSA_ZMQ_THREAD_AFFINITY, NULL);
+    if (affinity != NULL) {
+        pubsub_zmqAdmin_setThreadAffinity(psa, zsys_init(), affinity);
+    }
+    if (celix_bundleContext_getPropertyAsBool(ctx, PSA_ZMQ_SHARED_CONTEXT, PSA_ZMQ_DEFAULT_SHARED_CONTEXT)) {
+        psa->zmqCtx = zsys_init();
+    }
+
 
 #ifdef BUILD_WITH_ZMQ_SECURITY
     // Setup authenticator
@@ -243,9 +274,13 @@ void pubsub_zmqAdmin_destroy(pubsub_zmq_admin_t *psa) {
     if (psa->zmq_auth != NULL) {
         zactor_destroy(&psa->zmq_auth);
     }
+#ifdef BUILD_WITH_ZMQ_SECURITY
+    zmq_crypto_clearCache();
+#endif
 
     free(psa->ipAddress);
 
+    pubsub_utils_clearTopicPropertiesCache();
     free(psa);
 }
 
@@ -374,7 +409,7 @@ celix_status_t pubsub_zmqAdmin_setupTopicSender(void *handle, const char *scope,
     if (sender == NULL) {
         psa_zmq_serializer_entry_t *serEntry = hashMap_get(psa->serializers.map, (void*)serializerSvcId);
         if (serEntry != NULL) {
-            sender = pubsub_zmqTopicSender_create(psa->ctx, psa->log, scope, topic, serializerSvcId, serEntry->svc,
+            sender = pubsub_zmqTopicSender_create(psa->ctx, psa->log, scope, topic, topicProperties, serializerSvcId, serEntry->svc,
                     psa->ipAddress, staticBindUrl, psa->basePort, psa->maxPort);
         }
         if (sender != NULL) {
@@ -417,7 +452,29 @@ celix_status_t pubsub_zmqAdmin_setupTopicSender(void *handle, const char *scope,
     celixThreadMutex_unlock(&psa->serializers.mutex);
 
     if (sender != NULL && newEndpoint != NULL) {
-        //TODO connect endpoints to sender, NOTE is this needed for a zmq topic sender?
+        //note zmq subscribers connect to the sender, only the msg filters of the known subscribers are needed
+        celixThreadMutex_lock(&psa->discoveredEndpoints.mutex);
+        hash_map_iterator_t iter = hashMapIterator_construct(psa->discoveredEndpoints.map);
+        while (hashMapIterator_hasNext(&iter)) {
+            celix_properties_t *endpoint = hashMapIterator_nextValue(&iter);
+            const char *eScope = celix_properties_get(endpoint, PUBSUB_ENDPOINT_TOPIC_SCOPE, "");
+            const char *eTopic = celix_properties_get(endpoint, PUBSUB_ENDPOINT_TOPIC_NAME, "");
+            if (!pubsub_zmqAdmin_endpointIsPublisher(endpoint) && strcmp(eScope, scope) == 0 && strcmp(eTopic, topic) == 0) {
+                pubsub_zmqTopicSender_addMsgFilter(sender, celix_properties_get(endpoint, PUBSUB_ENDPOINT_UUID, NULL),
+                                                   celix_properties_get(endpoint, PUBSUB_ENDPOINT_MSG_FILTER, NULL));
+            }
+        }
+        celixThreadMutex_unlock(&psa->discoveredEndpoints.mutex);
+
+        //the local topic receiver is keyed by the framework uuid
+        char *receiverKey = pubsubEndpoint_createScopeTopicKey(scope, topic);
+        celixThreadMutex_lock(&psa->topicReceivers.mutex);
+        pubsub_zmq_topic_receiver_t *receiver = hashMap_get(psa->topicReceivers.map, receiverKey);
+        if (receiver != NULL) {
+            pubsub_zmqTopicSender_addMsgFilter(sender, psa->fwUUID, pubsub_zmqTopicReceiver_msgFilter(receiver));
+        }
+        celixThreadMutex_unlock(&psa->topicReceivers.mutex);
+        free(receiverKey);
     }
 
     if (newEndpoint != NULL && outPublisherEndpoint != NULL) {
@@ -464,7 +521,7 @@ celix_status_t pubsub_zmqAdmin_setupTopicReceiver(void *handle, const char *scop
     if (receiver == NULL) {
         psa_zmq_serializer_entry_t *serEntry = hashMap_get(psa->serializers.map, (void*)serializerSvcId);
         if (serEntry != NULL) {
-            receiver = pubsub_zmqTopicReceiver_create(psa->ctx, psa->log, scope, topic, topicProperties, serializerSvcId, serEntry->svc);
+            receiver = pubsub_zmqTopicReceiver_create(psa->ctx, psa->log, scope, topic, topicProperties, serializerSvcId, serEntry->svc, psa->zmqCtx);
         } else {
             L_ERROR("[PSA_ZMQ] Cannot find serializer for TopicSender %s/%s", scope, topic);
         }
@@ -473,6 +530,10 @@ celix_status_t pubsub_zmqAdmin_setupTopicReceiver(void *handle, const char *scop
             const char *serType = serEntry->serType;
             newEndpoint = pubsubEndpoint_create(psa->fwUUID, scope, topic,
                                                 PUBSUB_SUBSCRIBER_ENDPOINT_TYPE, psaType, serType, NULL);
+            const char *msgFilter = pubsub_zmqTopicReceiver_msgFilter(receiver);
+            if (msgFilter != NULL) {
+                celix_properties_set(newEndpoint, PUBSUB_ENDPOINT_MSG_FILTER, msgFilter);
+            }
             //if available also set container name
             const char *cn = celix_bundleContext_getProperty(psa->ctx, "CELIX_CONTAINER_NAME", NULL);
             if (cn != NULL) {
@@ -500,6 +561,13 @@ celix_status_t pubsub_zmqAdmin_setupTopicReceiver(void *handle, const char *scop
             }
         }
         celixThreadMutex_unlock(&psa->discoveredEndpoints.mutex);
+
+        celixThreadMutex_lock(&psa->topicSenders.mutex);
+        pubsub_zmq_topic_sender_t *sender = pubsub_zmqAdmin_senderForEndpoint(psa, newEndpoint);
+        if (sender != NULL) {
+            pubsub_zmqTopicSender_addMsgFilter(sender, psa->fwUUID, pubsub_zmqTopicReceiver_msgFilter(receiver));
+        }
+        celixThreadMutex_unlock(&psa->topicSenders.mutex);
     }
 
     if (newEndpoint != NULL && outSubscriberEndpoint != NULL) {
@@ -527,6 +595,15 @@ celix_status_t pubsub_zmqAdmin_teardownTopicReceiver(void *handle, const char *s
     }
     celixThreadMutex_unlock(&psa->topicReceivers.mutex);
 
+    celixThreadMutex_lock(&psa->topicSenders.mutex);
+    key = pubsubEndpoint_createScopeTopicKey(scope, topic);
+    pubsub_zmq_topic_sender_t *sender = hashMap_get(psa->topicSenders.map, key);
+    if (sender != NULL) {
+        pubsub_zmqTopicSender_removeMsgFilter(sender, psa->fwUUID);
+    }
+    free(key);
+    celixThreadMutex_unlock(&psa->topicSenders.mutex);
+
     celix_status_t  status = CELIX_SUCCESS;
     return status;
 }
@@ -579,6 +656,15 @@ celix_status_t pubsub_zmqAdmin_addDiscoveredEndpoint(void *handle, const celix_p
             pubsub_zmqAdmin_connectEndpointToReceiver(psa, receiver, endpoint);
         }
         celixThreadMutex_unlock(&psa->topicReceivers.mutex);
+    } else {
+        //subscriber endpoint, the topic sender for the scope/topic only sends the msgs needed by its msg filter
+        celixThreadMutex_lock(&psa->topicSenders.mutex);
+        pubsub_zmq_topic_sender_t *sender = pubsub_zmqAdmin_senderForEndpoint(psa, endpoint);
+        if (sender != NULL) {
+            pubsub_zmqTopicSender_addMsgFilter(sender, celix_properties_get(endpoint, PUBSUB_ENDPOINT_UUID, NULL),
+                                               celix_properties_get(endpoint, PUBSUB_ENDPOINT_MSG_FILTER, NULL));
+        }
+        celixThreadMutex_unlock(&psa->topicSenders.mutex);
     }
 
     celixThreadMutex_lock(&psa->discoveredEndpoints.mutex);
@@ -619,6 +705,13 @@ celix_status_t pubsub_zmqAdmin_removeDiscoveredEndpoint(void *handle, const celi
             pubsub_zmqAdmin_disconnectEndpointFromReceiver(psa, receiver, endpoint);
         }
         celixThreadMutex_unlock(&psa->topicReceivers.mutex);
+    } else {
+        celixThreadMutex_lock(&psa->topicSenders.mutex);
+        pubsub_zmq_topic_sender_t *sender = pubsub_zmqAdmin_senderForEndpoint(psa, endpoint);
+        if (sender != NULL) {
+            pubsub_zmqTopicSender_removeMsgFilter(sender, celix_properties_get(endpoint, PUBSUB_ENDPOINT_UUID, NULL));
+        }
+        celixThreadMutex_unlock(&psa->topicSenders.mutex);
     }
 
     celixThreadMutex_lock(&psa->discoveredEndpoints.mutex);
@@ -698,19 +791,15 @@ celix_status_t pubsub_zmqAdmin_executeCommand(void *handle, char *commandLine __
     return status;
 }
 
-pubsub_admin_metrics_t* pubsub_zmqAdmin_metrics(void *handle) {
+void pubsub_zmqAdmin_visitMetrics(void *handle, const struct timespec *changedSince, void *callbackHandle,
+                                  pubsub_metrics_visit_fp callback) {
     pubsub_zmq_admin_t *psa = handle;
-    pubsub_admin_metrics_t *result = calloc(1, sizeof(*result));
-    snprintf(result->psaType, PUBSUB_AMDIN_METRICS_NAME_MAX, "%s", PUBSUB_ZMQ_ADMIN_TYPE);
-    result->senders = celix_arrayList_create();
-    result->receivers = celix_arrayList_create();
 
     celixThreadMutex_lock(&psa->topicSenders.mutex);
     hash_map_iterator_t iter = hashMapIterator_construct(psa->topicSenders.map);
     while (hashMapIterator_hasNext(&iter)) {
         pubsub_zmq_topic_sender_t *sender = hashMapIterator_nextValue(&iter);
-        pubsub_admin_sender_metrics_t *metrics = pubsub_zmqTopicSender_metrics(sender);
-        celix_arrayList_add(result->senders, metrics);
+        pubsub_zmqTopicSender_visitMetrics(sender, changedSince, callbackHandle, callback);
     }
     celixThreadMutex_unlock(&psa->topicSenders.mutex);
 
@@ -718,15 +807,31 @@ pubsub_admin_metrics_t* pubsub_zmqAdmin_metrics(void *handle) {
     iter = hashMapIterator_construct(psa->topicReceivers.map);
     while (hashMapIterator_hasNext(&iter)) {
         pubsub_zmq_topic_receiver_t *receiver = hashMapIterator_nextValue(&iter);
-        pubsub_admin_receiver_metrics_t *metrics = pubsub_zmqTopicReceiver_metrics(receiver);
-        celix_arrayList_add(result->receivers, metrics);
+        pubsub_zmqTopicReceiver_visitMetrics(receiver, changedSince, callbackHandle, callback);
     }
     celixThreadMutex_unlock(&psa->topicReceivers.mutex);
-
-    return result;
 }
 
 #ifndef ANDROID
+static void pubsub_zmqAdmin_setThreadAffinity(pubsub_zmq_admin_t *psa, void *zmqCtx, const char *cpus) {
+#ifdef ZMQ_THREAD_AFFINITY_CPU_ADD
+    char *cpy = strndup(cpus, 1024);
+    char *save = NULL;
+    for (char *cpu = strtok_r(cpy, ", ", &save); cpu != NULL; cpu = strtok_r(NULL, ", ", &save)) {
+        char *end = NULL;
+        long nr = strtol(cpu, &end, 10);
+        if (end != cpu && *end == '\0' && nr >= 0) {
+            zmq_ctx_set(zmqCtx, ZMQ_THREAD_AFFINITY_CPU_ADD, (int)nr);
+        } else {
+            L_WARN("[PSA_ZMQ] Ignoring invalid cpu '%s' in %s", cpu, PSA_ZMQ_THREAD_AFFINITY);
+        }
+    }
+    free(cpy);
+#else
+    L_WARN("[PSA_ZMQ] Cannot set %s to '%s', not supported by this zmq version", PSA_ZMQ_THREAD_AFFINITY, cpus);
+#endif
+}
+
 static celix_status_t zmq_getIpAddress(const char* interface, char** ip) {
     celix_status_t status = CELIX_BUNDLE_EXCEPTION;
 
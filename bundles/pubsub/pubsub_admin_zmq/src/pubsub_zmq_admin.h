@@ -48,7 +48,7 @@ void pubsub_zmqAdmin_removeSerializerSvc(void *handle, void *svc, const celix_pr
 
 celix_status_t pubsub_zmqAdmin_executeCommand(void *handle, char *commandLine, FILE *outStream, FILE *errStream);
 
-pubsub_admin_metrics_t* pubsub_zmqAdmin_metrics(void *handle);
+void pubsub_zmqAdmin_visitMetrics(void *handle, const struct timespec *changedSince, void *callbackHandle, pubsub_metrics_visit_fp callback);
 
 #endif //CELIX_PUBSUB_ZMQ_ADMIN_H
 
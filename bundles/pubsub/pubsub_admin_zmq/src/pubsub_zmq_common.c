@@ -41,6 +41,17 @@ bool psa_zmq_checkVersion(version_pt msgVersion, const pubsub_zmq_msg_header_t *
     return check;
 }
 
+bool psa_zmq_isOlderMinorVersion(version_pt msgVersion, const pubsub_zmq_msg_header_t *hdr) {
+    int major = 0;
+    int minor = 0;
+    if (msgVersion == NULL || (hdr->major == 0 && hdr->minor == 0)) {
+        return false;
+    }
+    version_getMajor(msgVersion, &major);
+    version_getMinor(msgVersion, &minor);
+    return hdr->major == (unsigned char)major && hdr->minor < (unsigned char)minor;
+}
+
 void psa_zmq_setScopeAndTopicFilter(const char* scope, const char *topic, char *filter) {
     for (int i = 0; i < 5; ++i) {
         filter[i] = '\0';
@@ -88,7 +99,8 @@ celix_status_t psa_zmq_decodeHeader(const unsigned char *data, size_t dataLen, p
         }
         index += 16;
         index = readLong(data, index, &header->sendtimeSeconds);
-        readLong(data, index, &header->sendTimeNanoseconds);
+        index = readLong(data, index, &header->sendTimeNanoseconds);
+        header->flags = (unsigned char) data[index];
 
         status = CELIX_SUCCESS;
     }
@@ -128,5 +140,24 @@ void psa_zmq_encodeHeader(const pubsub_zmq_msg_header_t *msgHeader, unsigned cha
     }
     index += 16;
     index = writeLong(data, index, msgHeader->sendtimeSeconds);
-    writeLong(data, index, msgHeader->sendTimeNanoseconds);
+    index = writeLong(data, index, msgHeader->sendTimeNanoseconds);
+    data[index] = (unsigned char)msgHeader->flags;
+}
+
+static __thread unsigned int psa_zmq_metricsSampleCounter = 0;
+
+bool psa_zmq_sampleMetrics(unsigned int sampleInterval) {
+    if (sampleInterval <= 1) {
+        return true;
+    }
+    return (psa_zmq_metricsSampleCounter++ % sampleInterval) == 0;
+}
+
+clockid_t psa_zmq_metricsClock(bool coarse) {
+#ifdef CLOCK_REALTIME_COARSE
+    return coarse ? CLOCK_REALTIME_COARSE : CLOCK_REALTIME;
+#else
+    (void)coarse;
+    return CLOCK_REALTIME;
+#endif
 }
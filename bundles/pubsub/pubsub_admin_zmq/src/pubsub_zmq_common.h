@@ -22,6 +22,7 @@
 
 #include <utils.h>
 #include <stdint.h>
+#include <time.h>
 
 #include "version.h"
 
@@ -37,10 +38,14 @@
  */
 
 
+#define PSA_ZMQ_MSG_FLAG_POD    0x01 //payload is an unserialized plain old data msg (see pubsub_publisher_t loanMsg)
+#define PSA_ZMQ_MSG_FLAG_COMPRESSED 0x02 //payload is compressed (see pubsub_compression.h)
+
 struct pubsub_zmq_msg_header {
     uint32_t type; //msg type id (hash of fqn)
     uint8_t major;
     uint8_t minor;
+    uint8_t flags; //note encoded after the send time, so that the encoding of the other fields is unchanged
     uint32_t seqNr;
     unsigned char originUUID[16];
     uint64_t sendtimeSeconds; //seconds since epoch
@@ -54,6 +59,23 @@ void psa_zmq_setScopeAndTopicFilter(const char* scope, const char *topic, char *
 
 bool psa_zmq_checkVersion(version_pt msgVersion, const pubsub_zmq_msg_header_t *hdr);
 
+/**
+ * Returns true if the msg is written with an older minor version of the same major version, which the
+ * deserializeVersion of a msg serializer can convert to msgVersion.
+ */
+bool psa_zmq_isOlderMinorVersion(version_pt msgVersion, const pubsub_zmq_msg_header_t *hdr);
+
 celix_status_t psa_zmq_decodeHeader(const unsigned char *data, size_t dataLen, pubsub_zmq_msg_header_t *header);
 void psa_zmq_encodeHeader(const pubsub_zmq_msg_header_t *msgHeader, unsigned char *data, size_t dataLen);
+
+/**
+ * Returns true if the current msg should be timed for the metrics, i.e. for 1 in sampleInterval msgs.
+ * Uses a thread local counter, so no synchronization is needed.
+ */
+bool psa_zmq_sampleMetrics(unsigned int sampleInterval);
+
+/**
+ * Returns the clock to use for the send/receive time of msgs, based on PSA_ZMQ_METRICS_COARSE_CLOCK.
+ */
+clockid_t psa_zmq_metricsClock(bool coarse);
 #endif //CELIX_PUBSUB_ZMQ_COMMON_H
@@ -22,6 +22,7 @@
 #include <pubsub/subscriber.h>
 #include <memory.h>
 #include <pubsub_constants.h>
+#include <pubsub_utils.h>
 #include <sys/epoll.h>
 #include <assert.h>
 #include <pubsub_endpoint.h>
@@ -34,8 +35,15 @@
 
 #include <uuid/uuid.h>
 #include <pubsub_admin_metrics.h>
+#include <pubsub_msg_loan_pool.h>
+#include <pubsub_dispatcher.h>
+#include <pubsub_compression.h>
+#include <pubsub_interceptors_handler.h>
+#include <pubsub_msg_batch.h>
+#include "celix_probes.h"
 
 #define PSA_ZMQ_RECV_TIMEOUT 1000
+#define PSA_ZMQ_MAX_DRAINED_MSGS 256
 
 #ifndef UUID_STR_LEN
 #define UUID_STR_LEN 37
@@ -58,10 +66,14 @@ struct pubsub_zmq_topic_receiver {
     pubsub_serializer_service_t *serializer;
     char *scope;
     char *topic;
+    char *msgFilter; //combined msg filter of the subscribers, NULL if all msgs are needed
     char scopeAndTopicFilter[5];
     bool metricsEnabled;
+    unsigned int metricsSampleInterval;
+    clockid_t metricsClock;
 
     void *zmqCtx;
+    bool ownsZmqCtx; //false if the zmq context is shared by the pubsub admin
     void *zmqSock;
 
     struct {
@@ -82,6 +94,10 @@ struct pubsub_zmq_topic_receiver {
         hash_map_t *map; //key = bnd id, value = psa_zmq_subscriber_entry_t
         bool allInitialized;
     } subscribers;
+
+    pubsub_dispatcher_t *dispatcher; //NULL if msgs are dispatched on the receive thread
+    pubsub_compressor_t *decompressor;
+    pubsub_interceptors_handler_t *interceptors;
 };
 
 typedef struct psa_zmq_requested_connection_entry {
@@ -97,23 +113,30 @@ typedef struct psa_zmq_subscriber_metrics_entry_t {
     unsigned long nrOfMessagesReceived;
     unsigned long nrOfSerializationErrors;
     struct timespec lastMessageReceived;
-    double averageTimeBetweenMessagesInSeconds;
-    double averageSerializationTimeInSeconds;
-    double averageDelayInSeconds;
-    double maxDelayInSeconds;
-    double minDelayInSeconds;
+    pubsub_metrics_histogram_t serializationTime;
+    pubsub_metrics_histogram_t delay;
     unsigned int lastSeqNr;
     unsigned long nrOfMissingSeqNumbers;
+    unsigned long nrOfMessagesConflated;
 } psa_zmq_subscriber_metrics_entry_t;
 
 typedef struct psa_zmq_subscriber_entry {
     int usageCount;
     hash_map_t *msgTypes; //map from serializer svc
+    celix_thread_mutex_t metricsMutex; //protects metrics, needed because msgs can be dispatched on a dispatch thread
     hash_map_t *metrics; //key = msg type id, value = hash_map (key = origin uuid, value = psa_zmq_subscriber_metrics_entry_t*
     pubsub_subscriber_t *svc;
     bool initialized; //true if the init function is called through the receive thread
+    pubsub_zmq_topic_receiver_t *receiver;
+    pubsub_dispatch_queue_t *queue; //NULL if msgs are dispatched on the receive thread
+    pubsub_msg_batch_t *batch; //NULL if the subscriber has no receiveBatch or msgs are dispatched through the queue
 } psa_zmq_subscriber_entry_t;
 
+typedef struct psa_zmq_shared_msg {
+    pubsub_msg_serializer_t *msgSer; //serializer used to deserialize msg
+    void *msg; //deserialized msg shared between the subscribers, NULL if not yet deserialized or taken over by a subscriber
+} psa_zmq_shared_msg_t;
+
 
 static void pubsub_zmqTopicReceiver_addSubscriber(void *handle, void *svc, const celix_properties_t *props, const celix_bundle_t *owner);
 static void pubsub_zmqTopicReceiver_removeSubscriber(void *handle, void *svc, const celix_properties_t *props, const celix_bundle_t *owner);
@@ -122,6 +145,8 @@ static void psa_zmq_connectToAllRequestedConnections(pubsub_zmq_topic_receiver_t
 static void psa_zmq_initializeAllSubscribers(pubsub_zmq_topic_receiver_t *receiver);
 static void psa_zmq_setupZmqContext(pubsub_zmq_topic_receiver_t *receiver, const celix_properties_t *topicProperties);
 static void psa_zmq_setupZmqSocket(pubsub_zmq_topic_receiver_t *receiver, const celix_properties_t *topicProperties);
+static void psa_zmq_destroySubscriberEntry(pubsub_zmq_topic_receiver_t *receiver, psa_zmq_subscriber_entry_t *entry);
+static void psa_zmq_dispatchMsg(void *handle, const void *header, const void *payload, size_t payloadSize, const struct timespec *receiveTime, unsigned int nrOfConflatedMsgs);
 
 
 
@@ -131,7 +156,8 @@ pubsub_zmq_topic_receiver_t* pubsub_zmqTopicReceiver_create(celix_bundle_context
                                                               const char *topic,
                                                               const celix_properties_t *topicProperties,
                                                               long serializerSvcId,
-                                                              pubsub_serializer_service_t *serializer) {
+                                                              pubsub_serializer_service_t *serializer,
+                                                              void *sharedZmqCtx) {
     pubsub_zmq_topic_receiver_t *receiver = calloc(1, sizeof(*receiver));
     receiver->ctx = ctx;
     receiver->logHelper = logHelper;
@@ -139,8 +165,13 @@ pubsub_zmq_topic_receiver_t* pubsub_zmqTopicReceiver_create(celix_bundle_context
     receiver->serializer = serializer;
     receiver->scope = strndup(scope, 1024 * 1024);
     receiver->topic = strndup(topic, 1024 * 1024);
+    const char *msgFilter = celix_properties_get(topicProperties, PUBSUB_SUBSCRIBER_MSG_FILTER, NULL);
+    receiver->msgFilter = msgFilter == NULL ? NULL : strndup(msgFilter, 1024 * 1024);
     psa_zmq_setScopeAndTopicFilter(scope, topic, receiver->scopeAndTopicFilter);
     receiver->metricsEnabled = celix_bundleContext_getPropertyAsBool(ctx, PSA_ZMQ_METRICS_ENABLED, PSA_ZMQ_DEFAULT_METRICS_ENABLED);
+    long sampleInterval = celix_bundleContext_getPropertyAsLong(ctx, PSA_ZMQ_METRICS_SAMPLE_INTERVAL, PSA_ZMQ_DEFAULT_METRICS_SAMPLE_INTERVAL);
+    receiver->metricsSampleInterval = sampleInterval > 1 ? (unsigned int)sampleInterval : 1;
+    receiver->metricsClock = psa_zmq_metricsClock(celix_bundleContext_getPropertyAsBool(ctx, PSA_ZMQ_METRICS_COARSE_CLOCK, PSA_ZMQ_DEFAULT_METRICS_COARSE_CLOCK));
 
 
 #ifdef BUILD_WITH_ZMQ_SECURITY
@@ -180,9 +211,15 @@ pubsub_zmq_topic_receiver_t* pubsub_zmqTopicReceiver_create(celix_bundle_context
 
     const char* pub_key = zcert_public_txt(pub_cert);
 #endif
-    receiver->zmqCtx = zmq_ctx_new();
+    //note the realtime thread settings apply to the IO threads of a zmq context, so these topics need their own context
+    bool realtimeThreads = celix_properties_get(topicProperties, PUBSUB_ZMQ_THREAD_REALTIME_PRIO, NULL) != NULL ||
+                           celix_properties_get(topicProperties, PUBSUB_ZMQ_THREAD_REALTIME_SCHED, NULL) != NULL;
+    receiver->ownsZmqCtx = sharedZmqCtx == NULL || realtimeThreads;
+    receiver->zmqCtx = receiver->ownsZmqCtx ? zmq_ctx_new() : sharedZmqCtx;
     if (receiver->zmqCtx != NULL) {
-        psa_zmq_setupZmqContext(receiver, topicProperties);
+        if (receiver->ownsZmqCtx) {
+            psa_zmq_setupZmqContext(receiver, topicProperties);
+        }
         receiver->zmqSock = zmq_socket(receiver->zmqCtx, ZMQ_SUB);
     } else {
         //LOG ctx problem
@@ -208,6 +245,12 @@ pubsub_zmq_topic_receiver_t* pubsub_zmqTopicReceiver_create(celix_bundle_context
 
         receiver->subscribers.map = hashMap_create(NULL, NULL, NULL, NULL);
         receiver->requestedConnections.map = hashMap_create(utils_stringHash, NULL, utils_stringEquals, NULL);
+
+        char name[64];
+        snprintf(name, 64, "ZMQ TD %s/%s", scope, topic);
+        receiver->dispatcher = pubsub_dispatcher_create(topicProperties, name);
+        receiver->decompressor = pubsub_decompressor_create(topicProperties);
+        receiver->interceptors = pubsub_interceptorsHandler_create(ctx, PUBSUB_ZMQ_ADMIN_TYPE, scope, topic);
     }
 
     const char *staticConnectUrls = celix_properties_get(topicProperties, PUBSUB_ZMQ_STATIC_CONNECT_URLS, NULL);
@@ -249,11 +292,19 @@ pubsub_zmq_topic_receiver_t* pubsub_zmqTopicReceiver_create(celix_bundle_context
         char name[64];
         snprintf(name, 64, "ZMQ TR %s/%s", scope, topic);
         celixThread_setName(&receiver->recvThread.thread, name);
+        celix_status_t threadStatus = pubsub_utils_setupThread(&receiver->recvThread.thread, topicProperties);
+        if (threadStatus != CELIX_SUCCESS) {
+            L_WARN("[PSA_ZMQ_TR] Cannot configure the scheduling/cpu affinity of the receive thread of %s/%s. Error %i", scope, topic, threadStatus);
+        }
     }
 
     if (receiver->zmqSock == NULL) {
+        if (receiver->ownsZmqCtx && receiver->zmqCtx != NULL) {
+            zmq_ctx_term(receiver->zmqCtx);
+        }
         free(receiver->scope);
         free(receiver->topic);
+        free(receiver->msgFilter);
         free(receiver);
         receiver = NULL;
         L_ERROR("[PSA_ZMQ] Cannot create TopicReceiver for %s/%s", scope, topic);
@@ -277,22 +328,18 @@ void pubsub_zmqTopicReceiver_destroy(pubsub_zmq_topic_receiver_t *receiver) {
         while (hashMapIterator_hasNext(&iter)) {
             psa_zmq_subscriber_entry_t *entry = hashMapIterator_nextValue(&iter);
             if (entry != NULL)  {
-                receiver->serializer->destroySerializerMap(receiver->serializer->handle, entry->msgTypes);
-                free(entry);
-            }
-
-            hash_map_iterator_t iter2 = hashMapIterator_construct(entry->metrics);
-            while (hashMapIterator_hasNext(&iter2)) {
-                hash_map_t *origins = hashMapIterator_nextValue(&iter2);
-                hashMap_destroy(origins, true, true);
+                psa_zmq_destroySubscriberEntry(receiver, entry);
             }
-            hashMap_destroy(entry->metrics, false, false);
         }
         hashMap_destroy(receiver->subscribers.map, false, false);
 
 
         celixThreadMutex_unlock(&receiver->subscribers.mutex);
 
+        pubsub_dispatcher_destroy(receiver->dispatcher);
+        pubsub_compressor_destroy(receiver->decompressor);
+        pubsub_interceptorsHandler_destroy(receiver->interceptors);
+
         celixThreadMutex_lock(&receiver->requestedConnections.mutex);
         iter = hashMapIterator_construct(receiver->requestedConnections.map);
         while (hashMapIterator_hasNext(&iter)) {
@@ -310,10 +357,13 @@ void pubsub_zmqTopicReceiver_destroy(pubsub_zmq_topic_receiver_t *receiver) {
         celixThreadMutex_destroy(&receiver->recvThread.mutex);
 
         zmq_close(receiver->zmqSock);
-        zmq_ctx_term(receiver->zmqCtx);
+        if (receiver->ownsZmqCtx) {
+            zmq_ctx_term(receiver->zmqCtx);
+        }
 
         free(receiver->scope);
         free(receiver->topic);
+        free(receiver->msgFilter);
     }
     free(receiver);
 }
@@ -324,6 +374,9 @@ const char* pubsub_zmqTopicReceiver_scope(pubsub_zmq_topic_receiver_t *receiver)
 const char* pubsub_zmqTopicReceiver_topic(pubsub_zmq_topic_receiver_t *receiver) {
     return receiver->topic;
 }
+const char* pubsub_zmqTopicReceiver_msgFilter(pubsub_zmq_topic_receiver_t *receiver) {
+    return receiver->msgFilter;
+}
 
 long pubsub_zmqTopicReceiver_serializerSvcId(pubsub_zmq_topic_receiver_t *receiver) {
     return receiver->serializerSvcId;
@@ -405,6 +458,8 @@ static void pubsub_zmqTopicReceiver_addSubscriber(void *handle, void *svc, const
         entry->usageCount = 1;
         entry->svc = svc;
         entry->initialized = false;
+        entry->receiver = receiver;
+        celixThreadMutex_create(&entry->metricsMutex, NULL);
 
         int rc = receiver->serializer->createSerializerMap(receiver->serializer->handle, (celix_bundle_t*)bnd, &entry->msgTypes);
 
@@ -419,9 +474,15 @@ static void pubsub_zmqTopicReceiver_addSubscriber(void *handle, void *svc, const
         }
 
         if (rc == 0) {
+            if (receiver->dispatcher != NULL) {
+                entry->queue = pubsub_dispatcher_createQueue(receiver->dispatcher, entry, psa_zmq_dispatchMsg);
+            } else {
+                entry->batch = pubsub_msgBatch_create(entry->svc, PSA_ZMQ_MAX_DRAINED_MSGS);
+            }
             hashMap_put(receiver->subscribers.map, (void*)bndId, entry);
         } else {
             L_ERROR("[PSA_ZMQ] Cannot create msg serializer map for TopicReceiver %s/%s", receiver->scope, receiver->topic);
+            celixThreadMutex_destroy(&entry->metricsMutex);
             free(entry);
         }
     }
@@ -441,28 +502,54 @@ static void pubsub_zmqTopicReceiver_removeSubscriber(void *handle, void *svc, co
     if (entry != NULL && entry->usageCount <= 0) {
         //remove entry
         hashMap_remove(receiver->subscribers.map, (void*)bndId);
-        int rc = receiver->serializer->destroySerializerMap(receiver->serializer->handle, entry->msgTypes);
-        if (rc != 0) {
-            L_ERROR("[PSA_ZMQ] Cannot destroy msg serializers map for TopicReceiver %s/%s", receiver->scope, receiver->topic);
-        }
-        hash_map_iterator_t iter = hashMapIterator_construct(entry->metrics);
-        while (hashMapIterator_hasNext(&iter)) {
-            hash_map_t *origins = hashMapIterator_nextValue(&iter);
-            hashMap_destroy(origins, true, true);
-        }
-        hashMap_destroy(entry->metrics, false, false);
-        free(entry);
+        psa_zmq_destroySubscriberEntry(receiver, entry);
     }
     celixThreadMutex_unlock(&receiver->subscribers.mutex);
 }
 
-static inline void processMsgForSubscriberEntry(pubsub_zmq_topic_receiver_t *receiver, psa_zmq_subscriber_entry_t* entry, const pubsub_zmq_msg_header_t *hdr, const byte* payload, size_t payloadSize, struct timespec *receiveTime) {
-    //NOTE receiver->subscribers.mutex locked
+static void psa_zmq_destroySubscriberEntry(pubsub_zmq_topic_receiver_t *receiver, psa_zmq_subscriber_entry_t *entry) {
+    //note the dispatch threads never lock the subscribers mutex, so the queue can be destroyed with that mutex locked
+    pubsub_dispatchQueue_destroy(entry->queue);
+    pubsub_msgBatch_destroy(entry->batch);
+    int rc = receiver->serializer->destroySerializerMap(receiver->serializer->handle, entry->msgTypes);
+    if (rc != 0) {
+        L_ERROR("[PSA_ZMQ] Cannot destroy msg serializers map for TopicReceiver %s/%s", receiver->scope, receiver->topic);
+    }
+    hash_map_iterator_t iter = hashMapIterator_construct(entry->metrics);
+    while (hashMapIterator_hasNext(&iter)) {
+        hash_map_t *origins = hashMapIterator_nextValue(&iter);
+        hashMap_destroy(origins, true, true);
+    }
+    hashMap_destroy(entry->metrics, false, false);
+    celixThreadMutex_destroy(&entry->metricsMutex);
+    free(entry);
+}
+
+static inline bool psa_zmq_isSameMsgType(pubsub_msg_serializer_t *msgSer1, pubsub_msg_serializer_t *msgSer2) {
+    int cmp = -1;
+    if (msgSer1 == msgSer2) {
+        cmp = 0;
+    } else if (msgSer1->msgId == msgSer2->msgId) {
+        version_compareTo(msgSer1->msgVersion, msgSer2->msgVersion, &cmp);
+    }
+    return cmp == 0;
+}
+
+/**
+ * Deserializes the msg and delivers it to the subscriber of the entry.
+ * If shared is not NULL, the deserialized msg is shared with the other subscribers of the same msg type and version,
+ * so that a message is deserialized once. A subscriber taking over ownership (release == false) takes over the shared
+ * msg and a next subscriber will get a newly deserialized msg. The caller frees the remaining shared msg.
+ * Subscribers with a batch get their own deserialized msg, which is delivered when the batch is flushed.
+ */
+static inline void processMsgForSubscriberEntry(pubsub_zmq_topic_receiver_t *receiver, psa_zmq_subscriber_entry_t* entry, const pubsub_zmq_msg_header_t *hdr, const byte* payload, size_t payloadSize, const struct timespec *receiveTime, psa_zmq_shared_msg_t *shared, unsigned int nrOfConflatedMsgs) {
+    //NOTE receiver->subscribers.mutex locked or called from the dispatch queue of the entry
     pubsub_msg_serializer_t* msgSer = hashMap_get(entry->msgTypes, (void*)(uintptr_t)(hdr->type));
     pubsub_subscriber_t *svc = entry->svc;
     bool monitor = receiver->metricsEnabled;
 
     //monitoring
+    bool sampled = false; //only the deserialization time of sampled msgs is measured
     struct timespec beginSer;
     struct timespec endSer;
     int updateReceiveCount = 0;
@@ -471,18 +558,42 @@ static inline void processMsgForSubscriberEntry(pubsub_zmq_topic_receiver_t *rec
     if (msgSer!= NULL) {
         void *deserializedMsg = NULL;
         bool validVersion = psa_zmq_checkVersion(msgSer->msgVersion, hdr);
-        if (validVersion) {
-            if (monitor) {
-                clock_gettime(CLOCK_REALTIME, &beginSer);
+        bool olderVersion = !validVersion && msgSer->deserializeVersion != NULL && psa_zmq_isOlderMinorVersion(msgSer->msgVersion, hdr);
+        if (validVersion || olderVersion) {
+            bool share = shared != NULL && entry->batch == NULL && (shared->msg == NULL || psa_zmq_isSameMsgType(shared->msgSer, msgSer));
+            sampled = monitor && psa_zmq_sampleMetrics(receiver->metricsSampleInterval);
+            if (sampled) {
+                clock_gettime(CLOCK_MONOTONIC, &beginSer);
+            }
+            celix_status_t status;
+            if (share && shared->msg != NULL) {
+                deserializedMsg = shared->msg;
+                status = CELIX_SUCCESS;
+            } else if ((hdr->flags & PSA_ZMQ_MSG_FLAG_POD) != 0) {
+                status = pubsub_createPodMsg(msgSer, payload, payloadSize, &deserializedMsg);
+            } else if (olderVersion) {
+                status = msgSer->deserializeVersion(msgSer->handle, hdr->major, hdr->minor, payload, payloadSize, &deserializedMsg);
+            } else {
+                status = msgSer->deserialize(msgSer->handle, payload, payloadSize, &deserializedMsg);
             }
-            celix_status_t status = msgSer->deserialize(msgSer->handle, payload, payloadSize, &deserializedMsg);
-            if (monitor) {
-                clock_gettime(CLOCK_REALTIME, &endSer);
+            if (sampled) {
+                clock_gettime(CLOCK_MONOTONIC, &endSer);
             }
             if (status == CELIX_SUCCESS) {
+                if (share && shared->msg == NULL) {
+                    shared->msgSer = msgSer;
+                    shared->msg = deserializedMsg;
+                }
                 bool release = true;
-                svc->receive(svc->handle, msgSer->msgName, msgSer->msgId, deserializedMsg, &release);
-                if (release) {
+                if (entry->batch != NULL) {
+                    pubsub_msgBatch_add(entry->batch, msgSer, deserializedMsg);
+                } else {
+                    svc->receive(svc->handle, msgSer->msgName, msgSer->msgId, deserializedMsg, &release);
+                }
+                if (!release && share) {
+                    //subscriber took over ownership of the shared msg
+                    shared->msg = NULL;
+                } else if (release && !share && entry->batch == NULL) {
                     msgSer->freeMsg(msgSer->handle, deserializedMsg);
                 }
                 updateReceiveCount += 1;
@@ -496,6 +607,7 @@ static inline void processMsgForSubscriberEntry(pubsub_zmq_topic_receiver_t *rec
     }
 
     if (msgSer != NULL && monitor) {
+        celixThreadMutex_lock(&entry->metricsMutex);
         hash_map_t *origins = hashMap_get(entry->metrics, (void*)(uintptr_t )hdr->type);
         char uuidStr[UUID_STR_LEN+1];
         uuid_unparse(hdr->originUUID, uuidStr);
@@ -506,24 +618,19 @@ static inline void processMsgForSubscriberEntry(pubsub_zmq_topic_receiver_t *rec
             hashMap_put(origins, strndup(uuidStr, UUID_STR_LEN+1), metrics);
             uuid_copy(metrics->origin, hdr->originUUID);
             metrics->msgTypeId = hdr->type;
-            metrics->maxDelayInSeconds = -INFINITY;
-            metrics->minDelayInSeconds = INFINITY;
             metrics->lastSeqNr = 0;
         }
 
-        double diff = celix_difftime(&beginSer, &endSer);
-        long n = metrics->nrOfMessagesReceived;
-        metrics->averageSerializationTimeInSeconds = (metrics->averageSerializationTimeInSeconds * n + diff) / (n+1);
-
-        diff = celix_difftime(&metrics->lastMessageReceived, receiveTime);
-        n = metrics->nrOfMessagesReceived;
-        if (metrics->nrOfMessagesReceived >= 1) {
-            metrics->averageTimeBetweenMessagesInSeconds = (metrics->averageTimeBetweenMessagesInSeconds * n + diff) / (n + 1);
+        double diff;
+        if (sampled) {
+            diff = celix_difftime(&beginSer, &endSer);
+            pubsub_metricsHistogram_record(&metrics->serializationTime, diff > 0 ? (uint64_t) (diff * 1e9) : 0);
         }
         metrics->lastMessageReceived = *receiveTime;
 
 
-        int incr = hdr->seqNr - metrics->lastSeqNr;
+        //conflated msgs are not missing
+        int incr = hdr->seqNr - metrics->lastSeqNr - (int)nrOfConflatedMsgs;
         if (metrics->lastSeqNr >0 && incr > 1) {
             metrics->nrOfMissingSeqNumbers += (incr - 1);
             L_WARN("Missing message seq nr went from %i to %i", metrics->lastSeqNr, hdr->seqNr);
@@ -534,28 +641,133 @@ static inline void processMsgForSubscriberEntry(pubsub_zmq_topic_receiver_t *rec
         sendTime.tv_sec = (time_t)hdr->sendtimeSeconds;
         sendTime.tv_nsec = (long)hdr->sendTimeNanoseconds; //TODO FIXME the tv_nsec is not correct
         diff = celix_difftime(&sendTime, receiveTime);
-        metrics->averageDelayInSeconds = (metrics->averageDelayInSeconds * n + diff) / (n+1);
-        if (diff < metrics->minDelayInSeconds) {
-            metrics->minDelayInSeconds = diff;
-        }
-        if (diff > metrics->maxDelayInSeconds) {
-            metrics->maxDelayInSeconds = diff;
-        }
+        pubsub_metricsHistogram_record(&metrics->delay, diff > 0 ? (uint64_t) (diff * 1e9) : 0); //clock skew can make the delay negative
 
         metrics->nrOfMessagesReceived += updateReceiveCount;
         metrics->nrOfSerializationErrors += updateSerError;
+        metrics->nrOfMessagesConflated += nrOfConflatedMsgs;
+        celixThreadMutex_unlock(&entry->metricsMutex);
     }
 }
 
+static void psa_zmq_dispatchMsg(void *handle, const void *header, const void *payload, size_t payloadSize, const struct timespec *receiveTime, unsigned int nrOfConflatedMsgs) {
+    psa_zmq_subscriber_entry_t *entry = handle;
+    processMsgForSubscriberEntry(entry->receiver, entry, header, payload, payloadSize, receiveTime, NULL, nrOfConflatedMsgs);
+}
+
 static inline void processMsg(pubsub_zmq_topic_receiver_t *receiver, const pubsub_zmq_msg_header_t *hdr, const byte *payload, size_t payloadSize, struct timespec *receiveTime) {
+    CELIX_PROBE4(psa_receive, PUBSUB_ZMQ_ADMIN_TYPE, receiver->topic, hdr->type, payloadSize);
+    //a compressed payload is decompressed once for all subscribers
+    pubsub_zmq_msg_header_t decompressedHdr;
+    void *decompressed = NULL;
+    if ((hdr->flags & PSA_ZMQ_MSG_FLAG_COMPRESSED) != 0) {
+        size_t decompressedSize = 0;
+        if (pubsub_compressor_decompress(receiver->decompressor, payload, payloadSize, &decompressed, &decompressedSize) != CELIX_SUCCESS) {
+            L_WARN("[PSA_ZMQ_TR] Cannot decompress msg with type id 0x%X for scope/topic %s/%s", hdr->type, receiver->scope, receiver->topic);
+            return;
+        }
+        decompressedHdr = *hdr;
+        decompressedHdr.flags &= (uint8_t) ~PSA_ZMQ_MSG_FLAG_COMPRESSED;
+        hdr = &decompressedHdr;
+        payload = decompressed;
+        payloadSize = decompressedSize;
+    }
+
+    //note the msg fqn is only known by the serializers of the subscribers
+    pubsub_interceptor_msg_header_t interceptorHeader = {hdr->type, NULL, hdr->major, hdr->minor};
+    if (!pubsub_interceptorsHandler_preReceive(receiver->interceptors, &interceptorHeader, payload, payloadSize)) {
+        //dropped by an interceptor
+        free(decompressed);
+        return;
+    }
+
+    //the raw msg is copied once and shared between the dispatch queues of all subscribers
+    pubsub_dispatch_msg_t *msg = NULL;
+    if (receiver->dispatcher != NULL) {
+        msg = pubsub_dispatchMsg_create(hdr, sizeof(*hdr), payload, payloadSize, receiveTime);
+        //conflated per msg type and origin (only used if conflation is configured)
+        unsigned char conflationKey[sizeof(hdr->type) + sizeof(hdr->originUUID)];
+        memcpy(conflationKey, &hdr->type, sizeof(hdr->type));
+        memcpy(conflationKey + sizeof(hdr->type), hdr->originUUID, sizeof(hdr->originUUID));
+        pubsub_dispatchMsg_setConflationKey(msg, conflationKey, sizeof(conflationKey));
+    }
+
+    //subscribers dispatched on the receive thread share a single deserialized msg
+    psa_zmq_shared_msg_t shared = {.msgSer = NULL, .msg = NULL};
+
     celixThreadMutex_lock(&receiver->subscribers.mutex);
     hash_map_iterator_t iter = hashMapIterator_construct(receiver->subscribers.map);
     while (hashMapIterator_hasNext(&iter)) {
         psa_zmq_subscriber_entry_t *entry = hashMapIterator_nextValue(&iter);
-        if (entry != NULL) {
-            processMsgForSubscriberEntry(receiver, entry, hdr, payload, payloadSize, receiveTime);
+        if (entry != NULL && entry->queue != NULL) {
+            if (!pubsub_dispatchQueue_enqueue(entry->queue, msg)) {
+                L_WARN("[PSA_ZMQ_TR] Dispatch queue full for scope/topic %s/%s, dropping msg with type id 0x%X", receiver->scope, receiver->topic, hdr->type);
+            }
+        } else if (entry != NULL) {
+            processMsgForSubscriberEntry(receiver, entry, hdr, payload, payloadSize, receiveTime, &shared, 0);
         }
     }
+    if (shared.msg != NULL) {
+        shared.msgSer->freeMsg(shared.msgSer->handle, shared.msg);
+    }
+    celixThreadMutex_unlock(&receiver->subscribers.mutex);
+
+    pubsub_dispatchMsg_release(msg);
+    pubsub_interceptorsHandler_postReceive(receiver->interceptors, &interceptorHeader, payload, payloadSize);
+    free(decompressed);
+}
+
+static void psa_zmq_processZmsg(pubsub_zmq_topic_receiver_t *receiver, zmsg_t *zmsg) {
+    size_t nrOfFrames = zmsg_size(zmsg);
+    if (nrOfFrames != 3 && nrOfFrames != 2) {
+        L_WARN("[PSA_ZMQ_TR] Expecting 3 frames (filter + header + payload) or 2 frames (filter + header/payload) per zmsg, got %i frames", (int)nrOfFrames);
+    } else {
+        zframe_t *filter = zmsg_pop(zmsg); //char[5] filter
+        zframe_t *header = zmsg_pop(zmsg); //pubsub_zmq_msg_header_t, followed by the payload for 2 frames
+        zframe_t *payload = nrOfFrames == 3 ? zmsg_pop(zmsg) : NULL; //serialized payload
+        const unsigned char *payloadData = NULL;
+        size_t payloadSize = 0;
+        size_t headerSize = 0;
+        if (header != NULL && payload != NULL) {
+            headerSize = zframe_size(header);
+            payloadData = zframe_data(payload);
+            payloadSize = zframe_size(payload);
+        } else if (header != NULL && zframe_size(header) >= sizeof(pubsub_zmq_msg_header_t)) {
+            headerSize = sizeof(pubsub_zmq_msg_header_t);
+            payloadData = zframe_data(header) + headerSize;
+            payloadSize = zframe_size(header) - headerSize;
+        }
+        if (filter != NULL && strncmp(receiver->scopeAndTopicFilter, (char*)zframe_data(filter), zframe_size(filter)) != 0 ) {
+            L_ERROR("[PSA_ZMQ_TR] Invalid ZQM filter, Found '%4s'. Expected %s\n", (char*)zframe_data(filter), receiver->scopeAndTopicFilter);
+        } else if (payloadData != NULL) {
+            struct timespec receiveTime;
+            clock_gettime(receiver->metricsClock, &receiveTime);
+            pubsub_zmq_msg_header_t msgHeader;
+            psa_zmq_decodeHeader(zframe_data(header), headerSize, &msgHeader);
+            processMsg(receiver, &msgHeader, payloadData, payloadSize, &receiveTime);
+        }
+        zframe_destroy(&filter);
+        zframe_destroy(&header);
+        zframe_destroy(&payload);
+    }
+}
+
+static bool psa_zmq_isReadable(void *zmqSock) {
+    int events = 0;
+    size_t len = sizeof(events);
+    return zmq_getsockopt(zmqSock, ZMQ_EVENTS, &events, &len) == 0 && (events & ZMQ_POLLIN) != 0;
+}
+
+/**
+ * Delivers the msgs collected for the subscribers with a batch, called after the readable msgs are drained.
+ */
+static void psa_zmq_flushBatches(pubsub_zmq_topic_receiver_t *receiver) {
+    celixThreadMutex_lock(&receiver->subscribers.mutex);
+    hash_map_iterator_t iter = hashMapIterator_construct(receiver->subscribers.map);
+    while (hashMapIterator_hasNext(&iter)) {
+        psa_zmq_subscriber_entry_t *entry = hashMapIterator_nextValue(&iter);
+        pubsub_msgBatch_flush(entry->batch);
+    }
     celixThreadMutex_unlock(&receiver->subscribers.mutex);
 }
 
@@ -585,26 +797,17 @@ static void* psa_zmq_recvThread(void * data) {
 
         zmsg_t *zmsg = zmsg_recv(receiver->zmqSock);
         if (zmsg != NULL) {
-            if (zmsg_size(zmsg) != 3) {
-                L_WARN("[PSA_ZMQ_TR] Always expecting 3 frames per zmsg (filter + header + payload), got %i frames", (int)zmsg_size(zmsg));
-            } else {
-                zframe_t *filter = zmsg_pop(zmsg); //char[5] filter
-                zframe_t *header = zmsg_pop(zmsg); //pubsub_zmq_msg_header_t
-                zframe_t *payload = zmsg_pop(zmsg); //serialized payload
-                if (filter != NULL && strncmp(receiver->scopeAndTopicFilter, (char*)zframe_data(filter), zframe_size(filter)) != 0 ) {
-                    L_ERROR("[PSA_ZMQ_TR] Invalid ZQM filter, Found '%4s'. Expected %s\n", (char*)zframe_data(filter), receiver->scopeAndTopicFilter);
-                } else if (header != NULL && payload != NULL) {
-                    struct timespec receiveTime;
-                    clock_gettime(CLOCK_REALTIME, &receiveTime);
-                    pubsub_zmq_msg_header_t msgHeader;
-                    psa_zmq_decodeHeader(zframe_data(header), zframe_size(header), &msgHeader);
-                    processMsg(receiver, &msgHeader, zframe_data(payload), zframe_size(payload), &receiveTime);
+            //drain the msgs which are already readable, so that batch subscribers receive them in a single call
+            int nrOfMsgs = 0;
+            while (zmsg != NULL) {
+                psa_zmq_processZmsg(receiver, zmsg);
+                zmsg_destroy(&zmsg);
+                nrOfMsgs += 1;
+                if (nrOfMsgs < PSA_ZMQ_MAX_DRAINED_MSGS && psa_zmq_isReadable(receiver->zmqSock)) {
+                    zmsg = zmsg_recv(receiver->zmqSock);
                 }
-                zframe_destroy(&filter);
-                zframe_destroy(&header);
-                zframe_destroy(&payload);
             }
-            zmsg_destroy(&zmsg);
+            psa_zmq_flushBatches(receiver);
         } else {
             if (errno == EAGAIN) {
                 //nop
@@ -631,65 +834,47 @@ static void* psa_zmq_recvThread(void * data) {
     return NULL;
 }
 
-pubsub_admin_receiver_metrics_t* pubsub_zmqTopicReceiver_metrics(pubsub_zmq_topic_receiver_t *receiver) {
-    pubsub_admin_receiver_metrics_t *result = calloc(1, sizeof(*result));
-    snprintf(result->scope, PUBSUB_AMDIN_METRICS_NAME_MAX, "%s", receiver->scope);
-    snprintf(result->topic, PUBSUB_AMDIN_METRICS_NAME_MAX, "%s", receiver->topic);
+void pubsub_zmqTopicReceiver_visitMetrics(pubsub_zmq_topic_receiver_t *receiver, const struct timespec *changedSince,
+                                          void *callbackHandle, pubsub_metrics_visit_fp callback) {
+    pubsub_metrics_entry_t metrics;
+    memset(&metrics, 0, sizeof(metrics));
+    metrics.type = PUBSUB_METRICS_RECEIVE_MSG;
+    metrics.psaType = PUBSUB_ZMQ_ADMIN_TYPE;
+    metrics.scope = receiver->scope;
+    metrics.topic = receiver->topic;
 
-    int msgTypesCount = 0;
     celixThreadMutex_lock(&receiver->subscribers.mutex);
     hash_map_iterator_t iter = hashMapIterator_construct(receiver->subscribers.map);
     while (hashMapIterator_hasNext(&iter)) {
-        psa_zmq_subscriber_entry_t *entry = hashMapIterator_nextValue(&iter);
-        hash_map_iterator_t iter2 = hashMapIterator_construct(entry->metrics);
-        while (hashMapIterator_hasNext(&iter2)) {
-            hashMapIterator_nextValue(&iter2);
-            msgTypesCount += 1;
-        }
-    }
-
-    result->nrOfMsgTypes = (unsigned long)msgTypesCount;
-    result->msgTypes = calloc(msgTypesCount, sizeof(*result->msgTypes));
-    int i = 0;
-    iter = hashMapIterator_construct(receiver->subscribers.map);
-    while (hashMapIterator_hasNext(&iter)) {
-        psa_zmq_subscriber_entry_t *entry = hashMapIterator_nextValue(&iter);
+        hash_map_entry_t *mapEntry = hashMapIterator_nextEntry(&iter);
+        psa_zmq_subscriber_entry_t *entry = hashMapEntry_getValue(mapEntry);
+        metrics.bndId = (long) (uintptr_t) hashMapEntry_getKey(mapEntry);
+        celixThreadMutex_lock(&entry->metricsMutex);
         hash_map_iterator_t iter2 = hashMapIterator_construct(entry->metrics);
         while (hashMapIterator_hasNext(&iter2)) {
             hash_map_t *origins = hashMapIterator_nextValue(&iter2);
-            result->msgTypes[i].origins = calloc((size_t)hashMap_size(origins), sizeof(*(result->msgTypes[i].origins)));
-            result->msgTypes[i].nrOfOrigins = hashMap_size(origins);
-            int k = 0;
             hash_map_iterator_t iter3 = hashMapIterator_construct(origins);
             while (hashMapIterator_hasNext(&iter3)) {
-                psa_zmq_subscriber_metrics_entry_t *metrics = hashMapIterator_nextValue(&iter3);
-                result->msgTypes[i].typeId = metrics->msgTypeId;
-                pubsub_msg_serializer_t *msgSer = hashMap_get(entry->msgTypes, (void*)(uintptr_t)metrics->msgTypeId);
-                if (msgSer) {
-                    snprintf(result->msgTypes[i].typeFqn, PUBSUB_AMDIN_METRICS_NAME_MAX, "%s", msgSer->msgName);
-                    uuid_copy(result->msgTypes[i].origins[k].originUUID, metrics->origin);
-                    result->msgTypes[i].origins[k].nrOfMessagesReceived = metrics->nrOfMessagesReceived;
-                    result->msgTypes[i].origins[k].nrOfSerializationErrors = metrics->nrOfSerializationErrors;
-                    result->msgTypes[i].origins[k].averageDelayInSeconds = metrics->averageDelayInSeconds;
-                    result->msgTypes[i].origins[k].maxDelayInSeconds = metrics->maxDelayInSeconds;
-                    result->msgTypes[i].origins[k].minDelayInSeconds = metrics->minDelayInSeconds;
-                    result->msgTypes[i].origins[k].averageTimeBetweenMessagesInSeconds = metrics->averageTimeBetweenMessagesInSeconds;
-                    result->msgTypes[i].origins[k].averageSerializationTimeInSeconds = metrics->averageSerializationTimeInSeconds;
-                    result->msgTypes[i].origins[k].lastMessageReceived = metrics->lastMessageReceived;
-                    result->msgTypes[i].origins[k].nrOfMissingSeqNumbers = metrics->nrOfMissingSeqNumbers;
-
-                    k += 1;
-                } else {
-                    L_WARN("[PSA_ZMQ]: Error cannot find key 0x%X in msg map during metrics collection!\n", metrics->msgTypeId);
+                psa_zmq_subscriber_metrics_entry_t *mEntry = hashMapIterator_nextValue(&iter3);
+                pubsub_msg_serializer_t *msgSer = hashMap_get(entry->msgTypes, (void*)(uintptr_t)mEntry->msgTypeId);
+                metrics.msgFqn = msgSer != NULL ? msgSer->msgName : NULL;
+                metrics.msgTypeId = mEntry->msgTypeId;
+                uuid_copy(metrics.originUUID, mEntry->origin);
+                metrics.nrOfMessages = mEntry->nrOfMessagesReceived;
+                metrics.nrOfSerializationErrors = mEntry->nrOfSerializationErrors;
+                metrics.nrOfMissingSeqNumbers = mEntry->nrOfMissingSeqNumbers;
+                metrics.nrOfMessagesDropped = mEntry->nrOfMessagesConflated;
+                metrics.lastMessage = mEntry->lastMessageReceived;
+                metrics.serializationTime = &mEntry->serializationTime;
+                metrics.delay = &mEntry->delay;
+                if (pubsub_metrics_changedSince(&metrics, changedSince)) {
+                    callback(callbackHandle, &metrics);
                 }
             }
-            i +=1 ;
         }
+        celixThreadMutex_unlock(&entry->metricsMutex);
     }
-
     celixThreadMutex_unlock(&receiver->subscribers.mutex);
-
-    return result;
 }
 
 
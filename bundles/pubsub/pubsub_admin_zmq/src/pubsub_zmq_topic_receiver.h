@@ -31,11 +31,13 @@ pubsub_zmq_topic_receiver_t* pubsub_zmqTopicReceiver_create(celix_bundle_context
         const char *topic,
         const celix_properties_t *topicProperties,
         long serializerSvcId,
-        pubsub_serializer_service_t *serializer);
+        pubsub_serializer_service_t *serializer,
+        void *sharedZmqCtx);
 void pubsub_zmqTopicReceiver_destroy(pubsub_zmq_topic_receiver_t *receiver);
 
 const char* pubsub_zmqTopicReceiver_scope(pubsub_zmq_topic_receiver_t *receiver);
 const char* pubsub_zmqTopicReceiver_topic(pubsub_zmq_topic_receiver_t *receiver);
+const char* pubsub_zmqTopicReceiver_msgFilter(pubsub_zmq_topic_receiver_t *receiver);
 
 long pubsub_zmqTopicReceiver_serializerSvcId(pubsub_zmq_topic_receiver_t *receiver);
 void pubsub_zmqTopicReceiver_listConnections(pubsub_zmq_topic_receiver_t *receiver, celix_array_list_t *connectedUrls, celix_array_list_t *unconnectedUrls);
@@ -44,7 +46,7 @@ void pubsub_zmqTopicReceiver_connectTo(pubsub_zmq_topic_receiver_t *receiver, co
 void pubsub_zmqTopicReceiver_disconnectFrom(pubsub_zmq_topic_receiver_t *receiver, const char *url);
 
 
-pubsub_admin_receiver_metrics_t* pubsub_zmqTopicReceiver_metrics(pubsub_zmq_topic_receiver_t *receiver);
+void pubsub_zmqTopicReceiver_visitMetrics(pubsub_zmq_topic_receiver_t *receiver, const struct timespec *changedSince, void *callbackHandle, pubsub_metrics_visit_fp callback);
 
 
 #endif //CELIX_PUBSUB_ZMQ_TOPIC_RECEIVER_H
@@ -27,14 +27,21 @@
 #include <arpa/inet.h>
 #include <czmq.h>
 #include <log_helper.h>
+#include <pubsub_msg_loan_pool.h>
+#include <pubsub_compression.h>
+#include <pubsub_msg_filters.h>
+#include <pubsub_interceptors_handler.h>
 #include "pubsub_zmq_topic_sender.h"
 #include "pubsub_psa_zmq_constants.h"
 #include "pubsub_zmq_common.h"
 #include <uuid/uuid.h>
 #include "celix_constants.h"
+#include "celix_hash_map.h"
+#include "celix_probes.h"
 
-#define FIRST_SEND_DELAY_IN_SECONDS             2
 #define ZMQ_BIND_MAX_RETRY                      10
+#define PSA_ZMQ_MAX_POOLED_LOANS                16
+#define PSA_ZMQ_MAX_POOLED_HEADERS              64
 
 #define L_DEBUG(...) \
     logHelper_log(sender->logHelper, OSGI_LOGSERVICE_DEBUG, __VA_ARGS__)
@@ -45,6 +52,18 @@
 #define L_ERROR(...) \
     logHelper_log(sender->logHelper, OSGI_LOGSERVICE_ERROR, __VA_ARGS__)
 
+/**
+ * Pool of encoded header buffers, handed over to zmq as zero-copy frames and returned through the zmq free callback.
+ * Zmq can release a frame after the topic sender is destroyed, so the pool is reference counted and destroyed by
+ * the last release.
+ */
+typedef struct psa_zmq_header_pool {
+    celix_thread_mutex_t mutex; //protects the fields below
+    int usageCount; //1 for the topic sender + 1 for every header buffer owned by zmq
+    size_t nrOfPooled;
+    unsigned char *pooled[PSA_ZMQ_MAX_POOLED_HEADERS];
+} psa_zmq_header_pool_t;
+
 struct pubsub_zmq_topic_sender {
     celix_bundle_context_t *ctx;
     log_helper_t *logHelper;
@@ -52,13 +71,21 @@ struct pubsub_zmq_topic_sender {
     pubsub_serializer_service_t *serializer;
     uuid_t fwUUID;
     bool metricsEnabled;
+    unsigned int metricsSampleInterval;
+    clockid_t metricsClock;
     bool zeroCopyEnabled;
+    bool combinedFrameEnabled;
 
     char *scope;
     char *topic;
     char scopeAndTopicFilter[5];
     char *url;
     bool isStatic;
+    pubsub_msg_loan_pool_t *loanPool;
+    psa_zmq_header_pool_t *headerPool;
+    pubsub_compressor_t *compressor; //NULL if the msgs are not compressed
+    pubsub_msg_filters_t *msgFilters; //NULL for static senders, the subscribers of a static sender are unknown
+    pubsub_interceptors_handler_t *interceptors;
 
     struct {
         celix_thread_mutex_t mutex;
@@ -83,13 +110,12 @@ typedef struct psa_zmq_send_msg_entry {
     celix_thread_mutex_t sendLock; //protects send & Seqnr
     unsigned int seqNr;
     struct {
-        celix_thread_mutex_t mutex; //protects entries in struct
+        //note only updated with the sendLock taken (single writer), read lock-free by the metrics visitor
         unsigned long nrOfMessagesSend;
         unsigned long nrOfMessagesSendFailed;
         unsigned long nrOfSerializationErrors;
         struct timespec lastMessageSend;
-        double averageTimeBetweenMessagesInSeconds;
-        double averageSerializationTimeInSeconds;
+        pubsub_metrics_histogram_t serializationTime; //only for the sampled msgs
     } metrics;
 } psa_zmq_send_msg_entry_t;
 
@@ -99,22 +125,74 @@ typedef struct psa_zmq_bounded_service_entry {
     long bndId;
     hash_map_t *msgTypes; //key = msg type id, value = pubsub_msg_serializer_t
     hash_map_t *msgTypeIds; //key = msg name, value = msg type id
-    hash_map_t *msgEntries; //key = msg type id, value = psa_zmq_send_msg_entry_t
+    celix_long_hash_map_t *msgEntries; //key = msg type id, value = psa_zmq_send_msg_entry_t*
     int getCount;
 } psa_zmq_bounded_service_entry_t;
 
 static void* psa_zmq_getPublisherService(void *handle, const celix_bundle_t *requestingBundle, const celix_properties_t *svcProperties);
 static void psa_zmq_ungetPublisherService(void *handle, const celix_bundle_t *requestingBundle, const celix_properties_t *svcProperties);
 static unsigned int rand_range(unsigned int min, unsigned int max);
-static void delay_first_send_for_late_joiners(pubsub_zmq_topic_sender_t *sender);
 
 static int psa_zmq_topicPublicationSend(void* handle, unsigned int msgTypeId, const void *msg);
+static int psa_zmq_topicPublicationSendMany(void* handle, unsigned int msgTypeId, const void **msgs, size_t n);
+static void* psa_zmq_topicPublicationLoanMsg(void* handle, unsigned int msgTypeId);
+static int psa_zmq_topicPublicationSendLoanedMsg(void* handle, unsigned int msgTypeId, void *loanedMsg);
+static void psa_zmq_topicPublicationReturnLoanedMsg(void* handle, unsigned int msgTypeId, void *loanedMsg);
+
+static psa_zmq_header_pool_t* psa_zmq_headerPool_create(void) {
+    psa_zmq_header_pool_t *pool = calloc(1, sizeof(*pool));
+    celixThreadMutex_create(&pool->mutex, NULL);
+    pool->usageCount = 1;
+    return pool;
+}
+
+static void psa_zmq_headerPool_release(psa_zmq_header_pool_t *pool) {
+    celixThreadMutex_lock(&pool->mutex);
+    pool->usageCount -= 1;
+    bool destroy = pool->usageCount == 0;
+    celixThreadMutex_unlock(&pool->mutex);
+    if (destroy) {
+        for (size_t i = 0; i < pool->nrOfPooled; ++i) {
+            free(pool->pooled[i]);
+        }
+        celixThreadMutex_destroy(&pool->mutex);
+        free(pool);
+    }
+}
+
+static unsigned char* psa_zmq_headerPool_take(psa_zmq_header_pool_t *pool) {
+    unsigned char *hdr = NULL;
+    celixThreadMutex_lock(&pool->mutex);
+    pool->usageCount += 1;
+    if (pool->nrOfPooled > 0) {
+        pool->nrOfPooled -= 1;
+        hdr = pool->pooled[pool->nrOfPooled];
+    }
+    celixThreadMutex_unlock(&pool->mutex);
+    return hdr != NULL ? hdr : malloc(sizeof(pubsub_zmq_msg_header_t));
+}
+
+/**
+ * zmq free callback for header frames, can be called on a zmq io thread.
+ */
+static void psa_zmq_headerPool_return(void *data, void *hint) {
+    psa_zmq_header_pool_t *pool = hint;
+    celixThreadMutex_lock(&pool->mutex);
+    if (pool->nrOfPooled < PSA_ZMQ_MAX_POOLED_HEADERS) {
+        pool->pooled[pool->nrOfPooled++] = data;
+        data = NULL;
+    }
+    celixThreadMutex_unlock(&pool->mutex);
+    free(data); //pool full
+    psa_zmq_headerPool_release(pool);
+}
 
 pubsub_zmq_topic_sender_t* pubsub_zmqTopicSender_create(
         celix_bundle_context_t *ctx,
         log_helper_t *logHelper,
         const char *scope,
         const char *topic,
+        const celix_properties_t *topicProperties,
         long serializerSvcId,
         pubsub_serializer_service_t *ser,
         const char *bindIP,
@@ -132,7 +210,12 @@ pubsub_zmq_topic_sender_t* pubsub_zmqTopicSender_create(
         uuid_parse(uuid, sender->fwUUID);
     }
     sender->metricsEnabled = celix_bundleContext_getPropertyAsBool(ctx, PSA_ZMQ_METRICS_ENABLED, PSA_ZMQ_DEFAULT_METRICS_ENABLED);
+    long sampleInterval = celix_bundleContext_getPropertyAsLong(ctx, PSA_ZMQ_METRICS_SAMPLE_INTERVAL, PSA_ZMQ_DEFAULT_METRICS_SAMPLE_INTERVAL);
+    sender->metricsSampleInterval = sampleInterval > 1 ? (unsigned int)sampleInterval : 1;
+    sender->metricsClock = psa_zmq_metricsClock(celix_bundleContext_getPropertyAsBool(ctx, PSA_ZMQ_METRICS_COARSE_CLOCK, PSA_ZMQ_DEFAULT_METRICS_COARSE_CLOCK));
     sender->zeroCopyEnabled = celix_bundleContext_getPropertyAsBool(ctx, PSA_ZMQ_ZEROCOPY_ENABLED, PSA_ZMQ_DEFAULT_ZEROCOPY_ENABLED);
+    sender->combinedFrameEnabled = celix_bundleContext_getPropertyAsBool(ctx, PSA_ZMQ_COMBINED_FRAME_ENABLED, PSA_ZMQ_DEFAULT_COMBINED_FRAME_ENABLED);
+    sender->compressor = pubsub_compressor_create(topicProperties);
 
     //setting up zmq socket for ZMQ TopicSender
     {
@@ -246,6 +329,10 @@ pubsub_zmq_topic_sender_t* pubsub_zmqTopicSender_create(
     if (sender->url != NULL) {
         sender->scope = strndup(scope, 1024 * 1024);
         sender->topic = strndup(topic, 1024 * 1024);
+        sender->loanPool = pubsub_msgLoanPool_create(PSA_ZMQ_MAX_POOLED_LOANS);
+        sender->headerPool = psa_zmq_headerPool_create();
+        sender->msgFilters = sender->isStatic ? NULL : pubsub_msgFilters_create();
+        sender->interceptors = pubsub_interceptorsHandler_create(ctx, PUBSUB_ZMQ_ADMIN_TYPE, scope, topic);
 
         celixThreadMutex_create(&sender->boundedServices.mutex, NULL);
         celixThreadMutex_create(&sender->zmq.mutex, NULL);
@@ -272,6 +359,7 @@ pubsub_zmq_topic_sender_t* pubsub_zmqTopicSender_create(
     }
 
     if (sender->url == NULL) {
+        pubsub_compressor_destroy(sender->compressor);
         free(sender);
         sender = NULL;
     }
@@ -292,14 +380,12 @@ void pubsub_zmqTopicSender_destroy(pubsub_zmq_topic_sender_t *sender) {
             if (entry != NULL) {
                 sender->serializer->destroySerializerMap(sender->serializer->handle, entry->msgTypes);
 
-                hash_map_iterator_t iter2 = hashMapIterator_construct(entry->msgEntries);
-                while (hashMapIterator_hasNext(&iter2)) {
-                    psa_zmq_send_msg_entry_t *msgEntry = hashMapIterator_nextValue(&iter2);
-                    celixThreadMutex_destroy(&msgEntry->metrics.mutex);
+                for (celix_long_hash_map_iterator_t iter2 = celix_longHashMap_begin(entry->msgEntries); !celix_longHashMapIterator_isEnd(&iter2); celix_longHashMapIterator_next(&iter2)) {
+                    psa_zmq_send_msg_entry_t *msgEntry = iter2.value;
                     free(msgEntry);
 
                 }
-                hashMap_destroy(entry->msgEntries, false, false);
+                celix_longHashMap_destroy(entry->msgEntries);
 
                 free(entry);
             }
@@ -310,6 +396,11 @@ void pubsub_zmqTopicSender_destroy(pubsub_zmq_topic_sender_t *sender) {
         celixThreadMutex_destroy(&sender->boundedServices.mutex);
         celixThreadMutex_destroy(&sender->zmq.mutex);
 
+        pubsub_msgLoanPool_destroy(sender->loanPool);
+        pubsub_compressor_destroy(sender->compressor);
+        pubsub_msgFilters_destroy(sender->msgFilters);
+        pubsub_interceptorsHandler_destroy(sender->interceptors);
+        psa_zmq_headerPool_release(sender->headerPool);
         free(sender->scope);
         free(sender->topic);
         free(sender->url);
@@ -345,6 +436,18 @@ void pubsub_zmqTopicSender_disconnectFrom(pubsub_zmq_topic_sender_t *sender __at
     /*nop*/
 }
 
+void pubsub_zmqTopicSender_addMsgFilter(pubsub_zmq_topic_sender_t *sender, const char *endpointUUID, const char *msgFilter) {
+    if (sender->msgFilters != NULL) {
+        pubsub_msgFilters_add(sender->msgFilters, endpointUUID, msgFilter);
+    }
+}
+
+void pubsub_zmqTopicSender_removeMsgFilter(pubsub_zmq_topic_sender_t *sender, const char *endpointUUID) {
+    if (sender->msgFilters != NULL) {
+        pubsub_msgFilters_remove(sender->msgFilters, endpointUUID);
+    }
+}
+
 static int psa_zmq_localMsgTypeIdForMsgType(void* handle, const char* msgType, unsigned int* msgTypeId) {
     psa_zmq_bounded_service_entry_t *entry = (psa_zmq_bounded_service_entry_t *) handle;
     *msgTypeId = (unsigned int)(uintptr_t) hashMap_get(entry->msgTypeIds, msgType);
@@ -364,7 +467,7 @@ static void* psa_zmq_getPublisherService(void *handle, const celix_bundle_t *req
         entry->getCount = 1;
         entry->parent = sender;
         entry->bndId = bndId;
-        entry->msgEntries = hashMap_create(NULL, NULL, NULL, NULL);
+        entry->msgEntries = celix_longHashMap_create();
         entry->msgTypeIds = hashMap_create(utils_stringHash, NULL, utils_stringEquals, NULL);
 
         int rc = sender->serializer->createSerializerMap(sender->serializer->handle, (celix_bundle_t*)requestingBundle, &entry->msgTypes);
@@ -383,13 +486,16 @@ static void* psa_zmq_getPublisherService(void *handle, const celix_bundle_t *req
                 sendEntry->header.major = (uint8_t)major;
                 sendEntry->header.minor = (uint8_t)minor;
                 uuid_copy(sendEntry->header.originUUID, sender->fwUUID);
-                celixThreadMutex_create(&sendEntry->metrics.mutex, NULL);
-                hashMap_put(entry->msgEntries, key, sendEntry);
+                celix_longHashMap_put(entry->msgEntries, (long)(uintptr_t)key, sendEntry);
                 hashMap_put(entry->msgTypeIds, strndup(sendEntry->msgSer->msgName, 1024), (void *)(uintptr_t) sendEntry->msgSer->msgId);
             }
             entry->service.handle = entry;
             entry->service.localMsgTypeIdForMsgType = psa_zmq_localMsgTypeIdForMsgType;
             entry->service.send = psa_zmq_topicPublicationSend;
+            entry->service.sendMany = psa_zmq_topicPublicationSendMany;
+            entry->service.loanMsg = psa_zmq_topicPublicationLoanMsg;
+            entry->service.sendLoanedMsg = psa_zmq_topicPublicationSendLoanedMsg;
+            entry->service.returnLoanedMsg = psa_zmq_topicPublicationReturnLoanedMsg;
             hashMap_put(sender->boundedServices.map, (void*)bndId, entry);
         } else {
             L_ERROR("Error creating serializer map for ZMQ TopicSender %s/%s", sender->scope, sender->topic);
@@ -417,13 +523,11 @@ static void psa_zmq_ungetPublisherService(void *handle, const celix_bundle_t *re
             L_ERROR("Error destroying publisher service, serializer not available / cannot get msg serializer map\n");
         }
 
-        hash_map_iterator_t iter = hashMapIterator_construct(entry->msgEntries);
-        while (hashMapIterator_hasNext(&iter)) {
-            psa_zmq_send_msg_entry_t *msgEntry = hashMapIterator_nextValue(&iter);
-            celixThreadMutex_destroy(&msgEntry->metrics.mutex);
+        for (celix_long_hash_map_iterator_t iter = celix_longHashMap_begin(entry->msgEntries); !celix_longHashMapIterator_isEnd(&iter); celix_longHashMapIterator_next(&iter)) {
+            psa_zmq_send_msg_entry_t *msgEntry = iter.value;
             free(msgEntry);
         }
-        hashMap_destroy(entry->msgEntries, false, false);
+        celix_longHashMap_destroy(entry->msgEntries);
 
         hashMap_destroy(entry->msgTypeIds, true, false);
         free(entry);
@@ -431,211 +535,322 @@ static void psa_zmq_ungetPublisherService(void *handle, const celix_bundle_t *re
     celixThreadMutex_unlock(&sender->boundedServices.mutex);
 }
 
-pubsub_admin_sender_metrics_t* pubsub_zmqTopicSender_metrics(pubsub_zmq_topic_sender_t *sender) {
-    pubsub_admin_sender_metrics_t *result = calloc(1, sizeof(*result));
-    snprintf(result->scope, PUBSUB_AMDIN_METRICS_NAME_MAX, "%s", sender->scope);
-    snprintf(result->topic, PUBSUB_AMDIN_METRICS_NAME_MAX, "%s", sender->topic);
+void pubsub_zmqTopicSender_visitMetrics(pubsub_zmq_topic_sender_t *sender, const struct timespec *changedSince,
+                                        void *callbackHandle, pubsub_metrics_visit_fp callback) {
+    pubsub_metrics_entry_t metrics;
+    memset(&metrics, 0, sizeof(metrics));
+    metrics.type = PUBSUB_METRICS_SEND_MSG;
+    metrics.psaType = PUBSUB_ZMQ_ADMIN_TYPE;
+    metrics.scope = sender->scope;
+    metrics.topic = sender->topic;
+    pubsub_metrics_histogram_t serializationTime; //copy, the histogram can be updated concurrently
+    metrics.serializationTime = &serializationTime;
+
     celixThreadMutex_lock(&sender->boundedServices.mutex);
-    size_t count = 0;
     hash_map_iterator_t iter = hashMapIterator_construct(sender->boundedServices.map);
     while (hashMapIterator_hasNext(&iter)) {
         psa_zmq_bounded_service_entry_t *entry = hashMapIterator_nextValue(&iter);
-        hash_map_iterator_t iter2 = hashMapIterator_construct(entry->msgEntries);
-        while (hashMapIterator_hasNext(&iter2)) {
-            hashMapIterator_nextValue(&iter2);
-            count += 1;
-        }
-    }
-
-    result->msgMetrics = calloc(count, sizeof(*result));
-
-    iter = hashMapIterator_construct(sender->boundedServices.map);
-    int i = 0;
-    while (hashMapIterator_hasNext(&iter)) {
-        psa_zmq_bounded_service_entry_t *entry = hashMapIterator_nextValue(&iter);
-        hash_map_iterator_t iter2 = hashMapIterator_construct(entry->msgEntries);
-        while (hashMapIterator_hasNext(&iter2)) {
-            psa_zmq_send_msg_entry_t *mEntry = hashMapIterator_nextValue(&iter2);
-            celixThreadMutex_lock(&mEntry->metrics.mutex);
-            result->msgMetrics[i].nrOfMessagesSend = mEntry->metrics.nrOfMessagesSend;
-            result->msgMetrics[i].nrOfMessagesSendFailed = mEntry->metrics.nrOfMessagesSendFailed;
-            result->msgMetrics[i].nrOfSerializationErrors = mEntry->metrics.nrOfSerializationErrors;
-            result->msgMetrics[i].averageSerializationTimeInSeconds = mEntry->metrics.averageSerializationTimeInSeconds;
-            result->msgMetrics[i].averageTimeBetweenMessagesInSeconds = mEntry->metrics.averageTimeBetweenMessagesInSeconds;
-            result->msgMetrics[i].lastMessageSend = mEntry->metrics.lastMessageSend;
-            result->msgMetrics[i].bndId = entry->bndId;
-            result->msgMetrics[i].typeId = mEntry->header.type;
-            snprintf(result->msgMetrics[i].typeFqn, PUBSUB_AMDIN_METRICS_NAME_MAX, "%s", mEntry->msgSer->msgName);
-            i += 1;
-            celixThreadMutex_unlock(&mEntry->metrics.mutex);
+        for (celix_long_hash_map_iterator_t iter2 = celix_longHashMap_begin(entry->msgEntries); !celix_longHashMapIterator_isEnd(&iter2); celix_longHashMapIterator_next(&iter2)) {
+            psa_zmq_send_msg_entry_t *mEntry = iter2.value;
+            metrics.msgFqn = mEntry->msgSer->msgName;
+            metrics.msgTypeId = mEntry->header.type;
+            metrics.bndId = entry->bndId;
+            metrics.nrOfMessages = __atomic_load_n(&mEntry->metrics.nrOfMessagesSend, __ATOMIC_RELAXED);
+            metrics.nrOfMessagesFailed = __atomic_load_n(&mEntry->metrics.nrOfMessagesSendFailed, __ATOMIC_RELAXED);
+            metrics.nrOfSerializationErrors = __atomic_load_n(&mEntry->metrics.nrOfSerializationErrors, __ATOMIC_RELAXED);
+            metrics.lastMessage.tv_sec = __atomic_load_n(&mEntry->metrics.lastMessageSend.tv_sec, __ATOMIC_RELAXED);
+            metrics.lastMessage.tv_nsec = __atomic_load_n(&mEntry->metrics.lastMessageSend.tv_nsec, __ATOMIC_RELAXED);
+            if (pubsub_metrics_changedSince(&metrics, changedSince)) {
+                pubsub_metricsHistogram_copy(&serializationTime, &mEntry->metrics.serializationTime);
+                callback(callbackHandle, &metrics);
+            }
         }
     }
-
     celixThreadMutex_unlock(&sender->boundedServices.mutex);
-    result->nrOfmsgMetrics = (int)count;
-    return result;
 }
 
 static void psa_zmq_freeMsg(void *msg, void *hint __attribute__((unused))) {
     free(msg);
 }
 
-static int psa_zmq_topicPublicationSend(void* handle, unsigned int msgTypeId, const void *inMsg) {
-    int status = CELIX_SUCCESS;
-    psa_zmq_bounded_service_entry_t *bound = handle;
-    pubsub_zmq_topic_sender_t *sender = bound->parent;
-    bool monitor = sender->metricsEnabled;
+static void psa_zmq_freeLoanedMsg(void *msg, void *hint __attribute__((unused))) {
+    //note not returned to the loan pool, zmq can release the msg after the sender (and pool) is destroyed
+    pubsub_msgLoanPool_free(msg);
+}
 
-    psa_zmq_send_msg_entry_t *entry = hashMap_get(bound->msgEntries, (void*)(uintptr_t)(msgTypeId));
+static int psa_zmq_topicPublicationSend(void* handle, unsigned int msgTypeId, const void *inMsg) {
+    return psa_zmq_topicPublicationSendMany(handle, msgTypeId, &inMsg, 1);
+}
 
-    //metrics updates
-    struct timespec sendTime;
-    struct timespec serializationStart;
-    struct timespec serializationEnd;
-    //int unknownMessageCountUpdate = 0;
-    int sendErrorUpdate = 0;
-    int serializationErrorUpdate = 0;
-    int sendCountUpdate = 0;
+/**
+ * Sends the filter frame and the pooled header frame. Returns the zmq_msg_send result of the header frame.
+ */
+static int psa_zmq_sendFilterAndHeader(pubsub_zmq_topic_sender_t *sender, void *socket, const pubsub_zmq_msg_header_t *msgHeader) {
+    zmq_msg_t filter;
+    zmq_msg_init_data(&filter, sender->scopeAndTopicFilter, 4, NULL, NULL);
+    int rc = zmq_msg_send(&filter, socket, ZMQ_SNDMORE);
+    if (rc == -1) {
+        L_WARN("Error sending filter msg. %s", strerror(errno));
+        zmq_msg_close(&filter);
+        return rc;
+    }
 
-    if (entry != NULL) {
-        delay_first_send_for_late_joiners(sender);
+    zmq_msg_t header;
+    unsigned char *hdr = psa_zmq_headerPool_take(sender->headerPool);
+    psa_zmq_encodeHeader(msgHeader, hdr, sizeof(pubsub_zmq_msg_header_t));
+    zmq_msg_init_data(&header, hdr, sizeof(pubsub_zmq_msg_header_t), psa_zmq_headerPool_return, sender->headerPool);
+    rc = zmq_msg_send(&header, socket, ZMQ_SNDMORE);
+    if (rc == -1) {
+        L_WARN("Error sending header msg. %s", strerror(errno));
+        zmq_msg_close(&header);
+    }
+    return rc;
+}
 
+/**
+ * Sends a single serialized (and possibly compressed) msg or, if loaned is true, a loaned plain old data msg. The
+ * ownership of the msg is taken over. Note that the sendLock of the entry should be locked.
+ */
+static bool psa_zmq_sendSerializedMsg(psa_zmq_bounded_service_entry_t *bound, psa_zmq_send_msg_entry_t *entry, void *serializedOutput, size_t serializedOutputLen, bool loaned, bool compressed, struct timespec *sendTime) {
+    pubsub_zmq_topic_sender_t *sender = bound->parent;
+    bool monitor = sender->metricsEnabled;
 
+    pubsub_zmq_msg_header_t msg_hdr = entry->header;
+    msg_hdr.seqNr = 0;
+    msg_hdr.sendtimeSeconds = 0;
+    msg_hdr.sendTimeNanoseconds = 0;
+    msg_hdr.flags = loaned ? PSA_ZMQ_MSG_FLAG_POD : 0;
+    if (compressed) {
+        msg_hdr.flags |= PSA_ZMQ_MSG_FLAG_COMPRESSED;
+    }
+    if (monitor) {
+        clock_gettime(sender->metricsClock, sendTime);
+        msg_hdr.sendtimeSeconds = (uint64_t) sendTime->tv_sec;
+        msg_hdr.sendTimeNanoseconds = (uint64_t) sendTime->tv_nsec;
+        msg_hdr.seqNr = entry->seqNr++;
+    }
 
-        if (monitor) {
-            clock_gettime(CLOCK_REALTIME, &serializationStart);
+    errno = 0;
+    bool ownershipTransferred = false;
+    void *socket = zsock_resolve(sender->zmq.socket);
+    int rc;
+
+    if (sender->combinedFrameEnabled) {
+        //filter + a single header/payload frame, the header is encoded directly in the zmq msg
+        zmq_msg_t filter;
+        zmq_msg_init_data(&filter, sender->scopeAndTopicFilter, 4, NULL, NULL);
+        rc = zmq_msg_send(&filter, socket, ZMQ_SNDMORE);
+        if (rc == -1) {
+            L_WARN("Error sending filter msg. %s", strerror(errno));
+            zmq_msg_close(&filter);
+        } else {
+            zmq_msg_t msg;
+            zmq_msg_init_size(&msg, sizeof(pubsub_zmq_msg_header_t) + serializedOutputLen);
+            unsigned char *data = zmq_msg_data(&msg);
+            psa_zmq_encodeHeader(&msg_hdr, data, sizeof(pubsub_zmq_msg_header_t));
+            memcpy(data + sizeof(pubsub_zmq_msg_header_t), serializedOutput, serializedOutputLen);
+            rc = zmq_msg_send(&msg, socket, 0);
+            if (rc == -1) {
+                L_WARN("Error sending header/payload msg. %s", strerror(errno));
+                zmq_msg_close(&msg);
+            }
         }
-
-        void *serializedOutput = NULL;
-        size_t serializedOutputLen = 0;
-        status = entry->msgSer->serialize(entry->msgSer->handle, inMsg, &serializedOutput, &serializedOutputLen);
-
-        if (monitor) {
-            clock_gettime(CLOCK_REALTIME, &serializationEnd);
+    } else if (sender->zeroCopyEnabled) {
+        rc = psa_zmq_sendFilterAndHeader(sender, socket, &msg_hdr);
+        if (rc != -1) {
+            zmq_msg_t payload;
+            zmq_msg_init_data(&payload, serializedOutput, serializedOutputLen, loaned ? psa_zmq_freeLoanedMsg : psa_zmq_freeMsg, bound);
+            ownershipTransferred = true; //note also on failure, zmq_msg_close calls the free function
+            rc = zmq_msg_send(&payload, socket, 0);
+            if (rc == -1) {
+                L_WARN("Error sending payload msg. %s", strerror(errno));
+                zmq_msg_close(&payload);
+            }
         }
+    } else {
+        rc = psa_zmq_sendFilterAndHeader(sender, socket, &msg_hdr);
+        if (rc != -1) {
+            //note zmq_send copies the payload
+            rc = zmq_send(socket, serializedOutput, serializedOutputLen, 0);
+            if (rc == -1) {
+                L_WARN("Error sending payload msg. %s", strerror(errno));
+            }
+        }
+    }
 
-        if (status == CELIX_SUCCESS /*ser ok*/) {
-            unsigned char *hdr = calloc(sizeof(pubsub_zmq_msg_header_t), sizeof(unsigned char));
-
-            celixThreadMutex_lock(&entry->sendLock);
+    if (!ownershipTransferred) {
+        if (loaned) {
+            pubsub_msgLoanPool_return(sender->loanPool, serializedOutput);
+        } else {
+            free(serializedOutput);
+        }
+    }
 
-            pubsub_zmq_msg_header_t msg_hdr = entry->header;
-            msg_hdr.seqNr = 0;
-            msg_hdr.sendtimeSeconds = 0;
-            msg_hdr.sendTimeNanoseconds = 0;
-            if (monitor) {
-                clock_gettime(CLOCK_REALTIME, &sendTime);
-                msg_hdr.sendtimeSeconds = (uint64_t) sendTime.tv_sec;
-                msg_hdr.sendTimeNanoseconds = (uint64_t) sendTime.tv_nsec;
-                msg_hdr.seqNr = entry->seqNr++;
-            }
-            psa_zmq_encodeHeader(&msg_hdr, hdr, sizeof(pubsub_zmq_msg_header_t));
-
-            errno = 0;
-            bool sendOk;
-
-            if (bound->parent->zeroCopyEnabled) {
-                zmq_msg_t msg1; //filter
-                zmq_msg_t msg2; //header
-                zmq_msg_t msg3; //payload
-                void *socket = zsock_resolve(sender->zmq.socket);
-
-                zmq_msg_init_data(&msg1, sender->scopeAndTopicFilter, 4, NULL, bound);
-                //send filter
-                int rc = zmq_msg_send(&msg1, socket, ZMQ_SNDMORE);
-                if (rc == -1) {
-                    L_WARN("Error sending filter msg. %s", strerror(errno));
-                    zmq_msg_close(&msg1);
-                }
+    bool sendOk = rc != -1;
+    if (!sendOk) {
+        L_WARN("[PSA_ZMQ_TS] Error sending zmg. %s", strerror(errno));
+    }
+    return sendOk;
+}
 
-                //send header
-                if (rc > 0) {
-                    zmq_msg_init_data(&msg2, hdr, sizeof(pubsub_zmq_msg_header_t), psa_zmq_freeMsg, bound);
-                    rc = zmq_msg_send(&msg2, socket, ZMQ_SNDMORE);
-                    if (rc == -1) {
-                        L_WARN("Error sending header msg. %s", strerror(errno));
-                        zmq_msg_close(&msg2);
-                    }
-                }
+static void psa_zmq_updateMetrics(psa_zmq_send_msg_entry_t *entry, const struct timespec *serializationStart, const struct timespec *serializationEnd, const struct timespec *sendTime, int sendCountUpdate, int sendErrorUpdate, int serializationErrorUpdate) {
+    if (serializationStart != NULL && serializationEnd != NULL) {
+        double diff = celix_difftime(serializationStart, serializationEnd);
+        pubsub_metricsHistogram_record(&entry->metrics.serializationTime, diff > 0 ? (uint64_t) (diff * 1e9) : 0);
+    }
+    if (sendTime != NULL) {
+        __atomic_store_n(&entry->metrics.lastMessageSend.tv_sec, sendTime->tv_sec, __ATOMIC_RELAXED);
+        __atomic_store_n(&entry->metrics.lastMessageSend.tv_nsec, sendTime->tv_nsec, __ATOMIC_RELAXED);
+    }
+    __atomic_store_n(&entry->metrics.nrOfMessagesSend, entry->metrics.nrOfMessagesSend + sendCountUpdate, __ATOMIC_RELAXED);
+    __atomic_store_n(&entry->metrics.nrOfMessagesSendFailed, entry->metrics.nrOfMessagesSendFailed + sendErrorUpdate, __ATOMIC_RELAXED);
+    __atomic_store_n(&entry->metrics.nrOfSerializationErrors, entry->metrics.nrOfSerializationErrors + serializationErrorUpdate, __ATOMIC_RELAXED);
+}
 
+static int psa_zmq_topicPublicationSendMany(void* handle, unsigned int msgTypeId, const void **inMsgs, size_t n) {
+    int status = CELIX_SUCCESS;
+    psa_zmq_bounded_service_entry_t *bound = handle;
+    pubsub_zmq_topic_sender_t *sender = bound->parent;
+    CELIX_PROBE4(psa_send, PUBSUB_ZMQ_ADMIN_TYPE, sender->topic, msgTypeId, n);
+    bool monitor = sender->metricsEnabled;
 
-                if (rc > 0) {
-                    zmq_msg_init_data(&msg3, serializedOutput, serializedOutputLen, psa_zmq_freeMsg, bound);
-                    rc = zmq_msg_send(&msg3, socket, 0);
-                    if (rc == -1) {
-                        L_WARN("Error sending payload msg. %s", strerror(errno));
-                        zmq_msg_close(&msg3);
-                    }
-                }
+    psa_zmq_send_msg_entry_t *entry = celix_longHashMap_get(bound->msgEntries, (long)msgTypeId);
+    if (entry == NULL) {
+        L_WARN("[PSA_ZMQ_TS] Error cannot serialize message with msg type id %i for scope/topic %s/%s", msgTypeId, sender->scope, sender->topic);
+        return CELIX_SERVICE_EXCEPTION;
+    }
 
-                sendOk = rc > 0;
-            } else {
-                zmsg_t *msg = zmsg_new();
-                zmsg_addstr(msg, sender->scopeAndTopicFilter);
-                zmsg_addmem(msg, hdr, sizeof(pubsub_zmq_msg_header_t));
-                zmsg_addmem(msg, serializedOutput, serializedOutputLen);
-                int rc = zmsg_send(&msg, sender->zmq.socket);
-                sendOk = rc == 0;
-                free(serializedOutput);
-                free(hdr);
-                if (!sendOk) {
-                    zmsg_destroy(&msg); //if send was not ok, no owner change -> destroy msg
-                }
+    //note serializing all msgs first, so that the send lock is only taken once for the whole batch
+    struct {
+        void *output;
+        size_t outputLen;
+        size_t serializedLen; //note outputLen can be the compressed size
+        struct timespec serializationStart;
+        struct timespec serializationEnd;
+        struct timespec sendTime;
+        bool sampled;
+        bool compressed;
+        bool sendOk;
+        bool filtered;
+    } *msgs = calloc(n, sizeof(*msgs));
+    bool intercept = pubsub_interceptorsHandler_isActive(sender->interceptors);
+    pubsub_interceptor_msg_header_t interceptorHeader = {entry->header.type, entry->msgSer->msgName, entry->header.major, entry->header.minor};
+
+    for (size_t i = 0; i < n; ++i) {
+        if (!pubsub_msgFilters_match(sender->msgFilters, entry->msgSer, inMsgs[i])) {
+            //not needed by any subscriber
+            msgs[i].filtered = true;
+            continue;
+        }
+        //note only the serialization time of sampled msgs is measured, using the monotonic clock (only a duration is needed)
+        msgs[i].sampled = monitor && psa_zmq_sampleMetrics(sender->metricsSampleInterval);
+        if (msgs[i].sampled) {
+            clock_gettime(CLOCK_MONOTONIC, &msgs[i].serializationStart);
+        }
+        celix_status_t rc = entry->msgSer->serialize(entry->msgSer->handle, inMsgs[i], &msgs[i].output, &msgs[i].outputLen);
+        if (msgs[i].sampled) {
+            clock_gettime(CLOCK_MONOTONIC, &msgs[i].serializationEnd);
+        }
+        if (rc != CELIX_SUCCESS) {
+            msgs[i].output = NULL;
+            status = rc;
+            L_WARN("[PSA_ZMQ_TS] Error serialize message of type %s for scope/topic %s/%s", entry->msgSer->msgName, sender->scope, sender->topic);
+        } else if (intercept && !pubsub_interceptorsHandler_invokePreSend(sender->interceptors, &interceptorHeader, msgs[i].output, msgs[i].outputLen)) {
+            //dropped by an interceptor
+            free(msgs[i].output);
+            msgs[i].output = NULL;
+            msgs[i].filtered = true;
+        } else {
+            msgs[i].serializedLen = msgs[i].outputLen;
+            void *compressedOutput = NULL;
+            size_t compressedOutputLen = 0;
+            msgs[i].compressed = pubsub_compressor_compress(sender->compressor, msgs[i].output, msgs[i].outputLen, &compressedOutput, &compressedOutputLen);
+            if (msgs[i].compressed) {
+                free(msgs[i].output);
+                msgs[i].output = compressedOutput;
+                msgs[i].outputLen = compressedOutputLen;
             }
+        }
+    }
 
-            celixThreadMutex_unlock(&entry->sendLock);
-            if (sendOk) {
-                sendCountUpdate = 1;
-            } else {
-                sendErrorUpdate = 1;
-                L_WARN("[PSA_ZMQ_TS] Error sending zmg. %s", strerror(errno));
+    celixThreadMutex_lock(&entry->sendLock);
+    for (size_t i = 0; i < n; ++i) {
+        if (msgs[i].filtered) {
+            continue;
+        }
+        bool serOk = msgs[i].output != NULL;
+        if (serOk) {
+            msgs[i].sendOk = psa_zmq_sendSerializedMsg(bound, entry, msgs[i].output, msgs[i].outputLen, false, msgs[i].compressed, &msgs[i].sendTime);
+            if (intercept) {
+                pubsub_interceptorsHandler_invokePostSend(sender->interceptors, &interceptorHeader, msgs[i].serializedLen, msgs[i].sendOk ? CELIX_SUCCESS : CELIX_ILLEGAL_STATE);
             }
-        } else {
-            serializationErrorUpdate = 1;
-            L_WARN("[PSA_ZMQ_TS] Error serialize message of type %s for scope/topic %s/%s", entry->msgSer->msgName, sender->scope, sender->topic);
         }
-    } else {
-        //unknownMessageCountUpdate = 1;
-        status = CELIX_SERVICE_EXCEPTION;
-        L_WARN("[PSA_ZMQ_TS] Error cannot serialize message with msg type id %i for scope/topic %s/%s", msgTypeId, sender->scope, sender->topic);
+        if (monitor) {
+            psa_zmq_updateMetrics(entry,
+                                  msgs[i].sampled ? &msgs[i].serializationStart : NULL,
+                                  msgs[i].sampled ? &msgs[i].serializationEnd : NULL,
+                                  serOk ? &msgs[i].sendTime : NULL,
+                                  serOk && msgs[i].sendOk ? 1 : 0, serOk && !msgs[i].sendOk ? 1 : 0, serOk ? 0 : 1);
+        }
     }
+    celixThreadMutex_unlock(&entry->sendLock);
+    free(msgs);
 
+    return status;
+}
 
-    if (monitor && entry != NULL) {
-        celixThreadMutex_lock(&entry->metrics.mutex);
-
-        long n = entry->metrics.nrOfMessagesSend + entry->metrics.nrOfMessagesSendFailed;
-        double diff = celix_difftime(&serializationStart, &serializationEnd);
-        double average = (entry->metrics.averageSerializationTimeInSeconds * n + diff) / (n+1);
-        entry->metrics.averageSerializationTimeInSeconds = average;
+static void* psa_zmq_topicPublicationLoanMsg(void* handle, unsigned int msgTypeId) {
+    psa_zmq_bounded_service_entry_t *bound = handle;
+    pubsub_zmq_topic_sender_t *sender = bound->parent;
 
-        if (entry->metrics.nrOfMessagesSend > 2) {
-            diff = celix_difftime(&entry->metrics.lastMessageSend, &sendTime);
-            n = entry->metrics.nrOfMessagesSend;
-            average = (entry->metrics.averageTimeBetweenMessagesInSeconds * n + diff) / (n+1);
-            entry->metrics.averageTimeBetweenMessagesInSeconds = average;
-        }
+    psa_zmq_send_msg_entry_t *entry = celix_longHashMap_get(bound->msgEntries, (long)msgTypeId);
+    if (entry == NULL || entry->msgSer->podSize == 0) {
+        L_WARN("[PSA_ZMQ_TS] Cannot loan message with msg type id %i for scope/topic %s/%s, not a plain old data msg type", msgTypeId, sender->scope, sender->topic);
+        return NULL;
+    }
+    return pubsub_msgLoanPool_loan(sender->loanPool, entry->msgSer->podSize);
+}
 
-        entry->metrics.lastMessageSend = sendTime;
-        entry->metrics.nrOfMessagesSend += sendCountUpdate;
-        entry->metrics.nrOfMessagesSendFailed += sendErrorUpdate;
-        entry->metrics.nrOfSerializationErrors += serializationErrorUpdate;
+static int psa_zmq_topicPublicationSendLoanedMsg(void* handle, unsigned int msgTypeId, void *loanedMsg) {
+    psa_zmq_bounded_service_entry_t *bound = handle;
+    pubsub_zmq_topic_sender_t *sender = bound->parent;
+    CELIX_PROBE4(psa_send, PUBSUB_ZMQ_ADMIN_TYPE, sender->topic, msgTypeId, 1);
 
-        celixThreadMutex_unlock(&entry->metrics.mutex);
+    psa_zmq_send_msg_entry_t *entry = celix_longHashMap_get(bound->msgEntries, (long)msgTypeId);
+    if (entry == NULL || entry->msgSer->podSize == 0) {
+        L_WARN("[PSA_ZMQ_TS] Error cannot send loaned message with msg type id %i for scope/topic %s/%s", msgTypeId, sender->scope, sender->topic);
+        pubsub_msgLoanPool_return(sender->loanPool, loanedMsg);
+        return CELIX_SERVICE_EXCEPTION;
     }
 
-    return status;
-}
+    if (!pubsub_msgFilters_match(sender->msgFilters, entry->msgSer, loanedMsg)) {
+        //not needed by any subscriber
+        pubsub_msgLoanPool_return(sender->loanPool, loanedMsg);
+        return CELIX_SUCCESS;
+    }
 
-static void delay_first_send_for_late_joiners(pubsub_zmq_topic_sender_t *sender) {
+    //note the loaned msg is the payload, no serialization needed
+    pubsub_interceptor_msg_header_t interceptorHeader = {entry->header.type, entry->msgSer->msgName, entry->header.major, entry->header.minor};
+    if (!pubsub_interceptorsHandler_preSend(sender->interceptors, &interceptorHeader, loanedMsg, entry->msgSer->podSize)) {
+        //dropped by an interceptor
+        pubsub_msgLoanPool_return(sender->loanPool, loanedMsg);
+        return CELIX_SUCCESS;
+    }
+    struct timespec sendTime = {0, 0};
+    celixThreadMutex_lock(&entry->sendLock);
+    bool sendOk = psa_zmq_sendSerializedMsg(bound, entry, loanedMsg, entry->msgSer->podSize, true, false, &sendTime);
+    pubsub_interceptorsHandler_postSend(sender->interceptors, &interceptorHeader, entry->msgSer->podSize, sendOk ? CELIX_SUCCESS : CELIX_ILLEGAL_STATE);
+    if (sender->metricsEnabled) {
+        psa_zmq_updateMetrics(entry, NULL, NULL, &sendTime, sendOk ? 1 : 0, sendOk ? 0 : 1, 0);
+    }
+    celixThreadMutex_unlock(&entry->sendLock);
 
-    static bool firstSend = true;
+    return sendOk ? CELIX_SUCCESS : -1;
+}
 
-    if (firstSend) {
-        L_INFO("PSA_ZMQ_TP: Delaying first send for late joiners...\n");
-        sleep(FIRST_SEND_DELAY_IN_SECONDS);
-        firstSend = false;
-    }
+static void psa_zmq_topicPublicationReturnLoanedMsg(void* handle, unsigned int msgTypeId __attribute__((unused)), void *loanedMsg) {
+    psa_zmq_bounded_service_entry_t *bound = handle;
+    pubsub_msgLoanPool_return(bound->parent->loanPool, loanedMsg);
 }
 
 static unsigned int rand_range(unsigned int min, unsigned int max) {
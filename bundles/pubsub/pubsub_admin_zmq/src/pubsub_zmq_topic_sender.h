@@ -30,6 +30,7 @@ pubsub_zmq_topic_sender_t* pubsub_zmqTopicSender_create(
         log_helper_t *logHelper,
         const char *scope,
         const char *topic,
+        const celix_properties_t *topicProperties,
         long serializerSvcId,
         pubsub_serializer_service_t *ser,
         const char *bindIP,
@@ -49,8 +50,16 @@ void pubsub_zmqTopicSender_connectTo(pubsub_zmq_topic_sender_t *sender, const ce
 void pubsub_zmqTopicSender_disconnectFrom(pubsub_zmq_topic_sender_t *sender, const celix_properties_t *endpoint);
 
 /**
- * Returns a array of pubsub_admin_sender_msg_type_metrics_t entries for every msg_type/bundle send with the topic sender.
+ * Adds (or replaces) the msg filter of a subscriber endpoint (NULL if the subscriber needs all msgs).
+ * Msgs not matching the msg filter of any known subscriber are not send. Ignored for static topic senders.
  */
-pubsub_admin_sender_metrics_t* pubsub_zmqTopicSender_metrics(pubsub_zmq_topic_sender_t *sender);
+void pubsub_zmqTopicSender_addMsgFilter(pubsub_zmq_topic_sender_t *sender, const char *endpointUUID, const char *msgFilter);
+void pubsub_zmqTopicSender_removeMsgFilter(pubsub_zmq_topic_sender_t *sender, const char *endpointUUID);
+
+/**
+ * Calls the callback with a PUBSUB_METRICS_SEND_MSG entry for every msg_type/bundle send with the topic sender
+ * and changed since changedSince (NULL for all).
+ */
+void pubsub_zmqTopicSender_visitMetrics(pubsub_zmq_topic_sender_t *sender, const struct timespec *changedSince, void *callbackHandle, pubsub_metrics_visit_fp callback);
 
 #endif //CELIX_PUBSUB_ZMQ_TOPIC_SENDER_H
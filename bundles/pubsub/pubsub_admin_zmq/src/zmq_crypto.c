@@ -32,6 +32,11 @@
 #include <openssl/err.h>
 
 #include <string.h>
+#include <stdbool.h>
+#include <pthread.h>
+#include <sys/stat.h>
+
+#include "celix_hash_map.h"
 
 #define MAX_FILE_PATH_LENGTH 512
 #define ZMQ_KEY_LENGTH 40
@@ -46,23 +51,50 @@ static void parse_key_lines(char *keysBuffer, char **key, char **iv);
 static void parse_key_line(char *line, char **key, char **iv);
 static void extract_keys_from_buffer(unsigned char *input, int inputlen, char **publicKey, char **secretKey);
 
+typedef struct zmq_crypto_cert_entry {
+    zcert_t *cert;
+    struct timespec mtime; //modification time of the cert file when decrypted
+} zmq_crypto_cert_entry_t;
+
 /**
- * Return a valid zcert_t from an encoded file
- * Caller is responsible for freeing by calling zcert_destroy(zcert** cert);
+ * Cache of the AES key/iv digests of the keys file and of the certs decrypted with them.
+ * The keys file is read once and every cert file is decrypted once, shared by all topic senders and receivers.
+ * The digests are reloaded (and the certs dropped) when the keys file changes and a cert is decrypted again when
+ * its file changes.
  */
-zcert_t* get_zcert_from_encoded_file(char* keysFilePath, char* keysFileName, char* file_path) {
-
-    if (keysFilePath == NULL) {
-        keysFilePath = DEFAULT_KEYS_FILE_PATH;
-    }
+static struct {
+    pthread_mutex_t mutex;
+    char keysFile[MAX_FILE_PATH_LENGTH];
+    struct timespec keysFileMtime;
+    bool digestsLoaded;
+    unsigned char keyDigest[EVP_MAX_MD_SIZE];
+    unsigned char ivDigest[EVP_MAX_MD_SIZE];
+    celix_string_hash_map_t *certs; //key = cert file path, value = zmq_crypto_cert_entry_t*
+} zmq_crypto_cache = { .mutex = PTHREAD_MUTEX_INITIALIZER };
+
+static bool zmq_crypto_sameTime(const struct timespec *a, const struct timespec *b) {
+    return a->tv_sec == b->tv_sec && a->tv_nsec == b->tv_nsec;
+}
 
-    if (keysFileName == NULL) {
-        keysFileName = DEFAULT_KEYS_FILE_NAME;
+static void zmq_crypto_clearCerts(void) {
+    if (zmq_crypto_cache.certs != NULL) {
+        for (celix_string_hash_map_iterator_t iter = celix_stringHashMap_begin(zmq_crypto_cache.certs); !celix_stringHashMapIterator_isEnd(&iter); celix_stringHashMapIterator_next(&iter)) {
+            zmq_crypto_cert_entry_t *entry = iter.value;
+            zcert_destroy(&entry->cert);
+            free(entry);
+        }
+        celix_stringHashMap_destroy(zmq_crypto_cache.certs);
+        zmq_crypto_cache.certs = NULL;
     }
+}
 
+/**
+ * Reads the AES key and iv from the keys file and stores their sha256 digests.
+ */
+static bool zmq_crypto_loadDigests(char* keysFilePath, char* keysFileName, unsigned char *keyDigest, unsigned char *ivDigest) {
     char* keys_data = read_file_content(keysFilePath, keysFileName);
     if (keys_data == NULL) {
-        return NULL;
+        return false;
     }
 
     char *key = NULL;
@@ -75,22 +107,19 @@ zcert_t* get_zcert_from_encoded_file(char* keysFilePath, char* keysFileName, cha
         free(iv);
 
         printf("CRYPTO: Loading AES key and/or AES iv failed!\n");
-        return NULL;
+        return false;
     }
 
-    //At this point, we know an aes key and iv are stored and loaded
-
-    // generate sha256 hashes
-    unsigned char key_digest[EVP_MAX_MD_SIZE];
-    unsigned char iv_digest[EVP_MAX_MD_SIZE];
-    generate_sha256_hash((char*) key, key_digest);
-    generate_sha256_hash((char*) iv, iv_digest);
+    generate_sha256_hash((char*) key, keyDigest);
+    generate_sha256_hash((char*) iv, ivDigest);
+    free(key);
+    free(iv);
+    return true;
+}
 
+static zcert_t* zmq_crypto_decryptCert(const char* file_path, unsigned char *keyDigest, unsigned char *ivDigest) {
     zchunk_t *encoded_secret = zchunk_slurp(file_path, 0);
     if (encoded_secret == NULL) {
-        free(key);
-        free(iv);
-
         return NULL;
     }
 
@@ -100,21 +129,22 @@ zcert_t* get_zcert_from_encoded_file(char* keysFilePath, char* keysFileName, cha
 
     // Decryption of data
     int decryptedtext_len;
-    unsigned char decryptedtext[encoded_secret_size];
-    decryptedtext_len = decrypt((unsigned char *) encoded_secret_data, encoded_secret_size, key_digest, iv_digest, decryptedtext);
+    unsigned char decryptedtext[encoded_secret_size + AES_IV_LENGTH + 1];
+    decryptedtext_len = decrypt((unsigned char *) encoded_secret_data, encoded_secret_size, keyDigest, ivDigest, decryptedtext);
     decryptedtext[decryptedtext_len] = '\0';
 
-    EVP_cleanup();
-
     free(encoded_secret_data);
-    free(key);
-    free(iv);
 
     // The public and private keys are retrieved
     char *public_text = NULL;
     char *secret_text = NULL;
 
     extract_keys_from_buffer(decryptedtext, decryptedtext_len, &public_text, &secret_text);
+    if (public_text == NULL || secret_text == NULL) {
+        free(public_text);
+        free(secret_text);
+        return NULL;
+    }
 
     byte public_key [32] = { 0 };
     byte secret_key [32] = { 0 };
@@ -130,6 +160,79 @@ zcert_t* get_zcert_from_encoded_file(char* keysFilePath, char* keysFileName, cha
     return cert_loaded;
 }
 
+/**
+ * Return a valid zcert_t from an encoded file
+ * Caller is responsible for freeing by calling zcert_destroy(zcert** cert);
+ * Note the keys file and the decrypted cert are cached, the returned cert is a copy of the cached cert.
+ */
+zcert_t* get_zcert_from_encoded_file(char* keysFilePath, char* keysFileName, char* file_path) {
+
+    if (keysFilePath == NULL) {
+        keysFilePath = DEFAULT_KEYS_FILE_PATH;
+    }
+
+    if (keysFileName == NULL) {
+        keysFileName = DEFAULT_KEYS_FILE_NAME;
+    }
+
+    char keysFile[MAX_FILE_PATH_LENGTH];
+    snprintf(keysFile, MAX_FILE_PATH_LENGTH, "%s/%s", keysFilePath, keysFileName);
+    struct stat keysStat;
+    struct stat certStat;
+    if (stat(keysFile, &keysStat) != 0) {
+        printf("CRYPTO: Keys file '%s' doesn't exist!\n", keysFile);
+        return NULL;
+    } else if (stat(file_path, &certStat) != 0) {
+        return NULL;
+    }
+
+    zcert_t *result = NULL;
+    pthread_mutex_lock(&zmq_crypto_cache.mutex);
+    if (!zmq_crypto_cache.digestsLoaded || strcmp(keysFile, zmq_crypto_cache.keysFile) != 0 || !zmq_crypto_sameTime(&keysStat.st_mtim, &zmq_crypto_cache.keysFileMtime)) {
+        zmq_crypto_clearCerts();
+        zmq_crypto_cache.digestsLoaded = zmq_crypto_loadDigests(keysFilePath, keysFileName, zmq_crypto_cache.keyDigest, zmq_crypto_cache.ivDigest);
+        snprintf(zmq_crypto_cache.keysFile, MAX_FILE_PATH_LENGTH, "%s", keysFile);
+        zmq_crypto_cache.keysFileMtime = keysStat.st_mtim;
+    }
+
+    if (zmq_crypto_cache.digestsLoaded) {
+        if (zmq_crypto_cache.certs == NULL) {
+            zmq_crypto_cache.certs = celix_stringHashMap_create();
+        }
+        zmq_crypto_cert_entry_t *entry = celix_stringHashMap_get(zmq_crypto_cache.certs, file_path);
+        if (entry == NULL || !zmq_crypto_sameTime(&certStat.st_mtim, &entry->mtime)) {
+            zcert_t *cert = zmq_crypto_decryptCert(file_path, zmq_crypto_cache.keyDigest, zmq_crypto_cache.ivDigest);
+            if (entry != NULL) {
+                celix_stringHashMap_remove(zmq_crypto_cache.certs, file_path);
+                zcert_destroy(&entry->cert);
+                free(entry);
+                entry = NULL;
+            }
+            if (cert != NULL) {
+                entry = calloc(1, sizeof(*entry));
+                entry->cert = cert;
+                entry->mtime = certStat.st_mtim;
+                celix_stringHashMap_put(zmq_crypto_cache.certs, file_path, entry);
+            }
+        }
+        if (entry != NULL) {
+            result = zcert_dup(entry->cert);
+        }
+    }
+    pthread_mutex_unlock(&zmq_crypto_cache.mutex);
+
+    return result;
+}
+
+void zmq_crypto_clearCache(void) {
+    pthread_mutex_lock(&zmq_crypto_cache.mutex);
+    zmq_crypto_clearCerts();
+    zmq_crypto_cache.digestsLoaded = false;
+    memset(zmq_crypto_cache.keyDigest, 0, sizeof(zmq_crypto_cache.keyDigest));
+    memset(zmq_crypto_cache.ivDigest, 0, sizeof(zmq_crypto_cache.ivDigest));
+    pthread_mutex_unlock(&zmq_crypto_cache.mutex);
+}
+
 int generate_sha256_hash(char* text, unsigned char* digest) {
     unsigned int digest_len;
 
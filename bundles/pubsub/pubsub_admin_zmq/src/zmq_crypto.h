@@ -35,6 +35,11 @@
 #define DEFAULT_KEYS_FILE_NAME "pubsub.keys"
 
 zcert_t* get_zcert_from_encoded_file(char* keysFilePath, char* keysFileName, char* file_path);
+
+/**
+ * Drops the cached keys file digests and decrypted certs (see get_zcert_from_encoded_file).
+ */
+void zmq_crypto_clearCache(void);
 int generate_sha256_hash(char* text, unsigned char* digest);
 int decrypt(unsigned char *ciphertext, int ciphertext_len, unsigned char *key, unsigned char *iv, unsigned char *plaintext);
 
@@ -23,6 +23,7 @@
 
 #include "pubsub/publisher.h"
 #include "pubsub/subscriber.h"
+#include "pubsub/msg_type_id.h"
 
 
 #endif //  __PUBSUB_API_H_
@@ -0,0 +1,110 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *  KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#ifndef __PUBSUB_MSG_TYPE_ID_H_
+#define __PUBSUB_MSG_TYPE_ID_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * The msg type id of a msg type without a custom msg id (msgId annotation) is the hash of its fully qualified name,
+ * as computed by utils_stringHash (djb2). This header provides the same hash without a link dependency, so publishers
+ * and subscribers can use the msg type ids of their msg types without a localMsgTypeIdForMsgType lookup.
+ *
+ * In C++ PUBSUB_MSG_TYPE_ID (and celix::pubsub::msgTypeId) is a constant expression, e.g. usable as case label:
+ *
+ *     constexpr unsigned int POI_MSG_ID = PUBSUB_MSG_TYPE_ID("poi1");
+ *     publisher->send(publisher->handle, POI_MSG_ID, &poi);
+ *
+ * In C it is an inline function call, so it is not a constant expression (not usable as static initializer or case
+ * label). Initialize the id at runtime instead, e.g. in the activator start; an optimizing compiler folds the call
+ * to a constant for a literal fqn:
+ *
+ *     act->poiMsgId = PUBSUB_MSG_TYPE_ID("poi1");
+ *     publisher->send(publisher->handle, act->poiMsgId, &poi);
+ *
+ * Note the ids only equal the ids of the serializers for msg types without custom msg id. The serializers reject
+ * msg types with clashing msg ids when they are loaded.
+ */
+
+#ifdef __cplusplus
+
+namespace celix { namespace pubsub {
+
+namespace detail {
+    //note written as a single return statement, so that the hash is constexpr in C++11
+    constexpr unsigned int hash(const char *p, unsigned int hc) {
+        return *p == '\0' ? hc : hash(p + 1, (hc << 5) + hc + *p);
+    }
+}
+
+/**
+ * Returns the msg type id of a msg type without custom msg id, e.g. celix::pubsub::msgTypeId("poi1").
+ */
+constexpr unsigned int msgTypeId(const char *fqn) {
+    return detail::hash(fqn, 5381);
+}
+
+#if __cplusplus >= 202002L
+/**
+ * The fqn of a msg type as template argument.
+ */
+template<size_t N>
+struct MsgFqn {
+    char value[N]{};
+    constexpr MsgFqn(const char (&fqn)[N]) {
+        for (size_t i = 0; i < N; ++i) {
+            value[i] = fqn[i];
+        }
+    }
+};
+
+/**
+ * Returns the msg type id of a msg type without custom msg id, e.g. celix::pubsub::msgTypeId<"poi1">().
+ */
+template<MsgFqn Fqn>
+constexpr unsigned int msgTypeId() {
+    return detail::hash(Fqn.value, 5381);
+}
+#endif
+
+}}
+
+#define PUBSUB_MSG_TYPE_ID(fqn) (celix::pubsub::msgTypeId(fqn))
+
+#else
+
+/**
+ * Returns the msg type id of a msg type without custom msg id. Equals utils_stringHash(fqn) (see above).
+ */
+static inline unsigned int pubsub_msgTypeId(const char *fqn) {
+    unsigned int hc = 5381;
+    char ch;
+    while ((ch = *fqn++) != '\0') {
+        hc = (hc << 5) + hc + ch;
+    }
+    return hc;
+}
+
+#define PUBSUB_MSG_TYPE_ID(fqn) (pubsub_msgTypeId(fqn))
+
+#endif
+
+#endif //__PUBSUB_MSG_TYPE_ID_H_
@@ -30,7 +30,7 @@
 #include <stdlib.h>
 
 #define PUBSUB_PUBLISHER_SERVICE_NAME           "pubsub.publisher"
-#define PUBSUB_PUBLISHER_SERVICE_VERSION        "3.0.0"
+#define PUBSUB_PUBLISHER_SERVICE_VERSION        "4.0.0"
  
 //properties
 #define PUBSUB_PUBLISHER_TOPIC                  "topic"
@@ -50,6 +50,8 @@ struct pubsub_publisher {
      * with use of a distributed key/value store or communication between  participation parties.
      * this is called the local message type id. This local message type id can be requested with the localMsgIdForMsgType method.
      * When return is successful the msgTypeId is always greater than 0. (Note this can be used to specify/detect uninitialized msg type ids in the consumer code).
+     * For msg types without custom msg id, the msg type id can also be computed at compile time with PUBSUB_MSG_TYPE_ID
+     * (see pubsub/msg_type_id.h).
      *
      * Returns 0 on success.
      */
@@ -60,6 +62,38 @@ struct pubsub_publisher {
      * Returns 0 on success.
      */
     int (*send)(void *handle, unsigned int msgTypeId, const void *msg);
+
+    /**
+     * sendMany sends n msgs of the same msg type in one call. This is a async function, but the msgs can be safely deleted
+     * after sendMany returns.
+     * A PSA can publish the msgs as a batch, e.g. with a single lock acquisition and vectorized I/O, so this is preferred
+     * over calling send for every msg when publishing a lot of small msgs.
+     * Returns 0 if all msgs are sent.
+     */
+    int (*sendMany)(void *handle, unsigned int msgTypeId, const void **msgs, size_t n);
+
+    /**
+     * Optional (can be NULL if the PSA does not support loaning).
+     * loanMsg loans a PSA owned buffer for a msg of the provided msg type. The msg can be filled in place and then
+     * published with sendLoanedMsg, which sends the msg without serializing it.
+     * Loaning is only possible for plain old data msg types (no pointers, texts or sequences in the descriptor).
+     * Returns the loaned msg or NULL if the msg type cannot be loaned.
+     */
+    void* (*loanMsg)(void *handle, unsigned int msgTypeId);
+
+    /**
+     * Optional (can be NULL if the PSA does not support loaning).
+     * sendLoanedMsg sends a msg loaned with loanMsg. The ownership of the loaned msg always returns to the PSA, also
+     * if sending fails, so the loaned msg must not be used after this call.
+     * Returns 0 on success.
+     */
+    int (*sendLoanedMsg)(void *handle, unsigned int msgTypeId, void *loanedMsg);
+
+    /**
+     * Optional (can be NULL if the PSA does not support loaning).
+     * returnLoanedMsg returns a msg loaned with loanMsg to the PSA without sending it.
+     */
+    void (*returnLoanedMsg)(void *handle, unsigned int msgTypeId, void *loanedMsg);
  
 };
 typedef struct pubsub_publisher pubsub_publisher_t;
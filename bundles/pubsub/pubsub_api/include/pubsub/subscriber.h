@@ -28,14 +28,16 @@
 #define __PUBSUB_SUBSCRIBER_H_
 
 #include <stdbool.h>
+#include <stddef.h>
 
 #define PUBSUB_SUBSCRIBER_SERVICE_NAME          "pubsub.subscriber"
-#define PUBSUB_SUBSCRIBER_SERVICE_VERSION       "3.0.0"
+#define PUBSUB_SUBSCRIBER_SERVICE_VERSION       "4.0.0"
  
 //properties
 #define PUBSUB_SUBSCRIBER_TOPIC                "topic"
 #define PUBSUB_SUBSCRIBER_SCOPE                "scope"
 #define PUBSUB_SUBSCRIBER_CONFIG               "pubsub.config"
+#define PUBSUB_SUBSCRIBER_MSG_FILTER           "pubsub.msg.filter" //optional celix filter on the msg fields (e.g. "(temp>30)"), msgs not matching can be skipped at the sender
 
 #define PUBSUB_SUBSCRIBER_SCOPE_DEFAULT        "default"
 
@@ -54,6 +56,8 @@ struct pubsub_subscriber_struct {
      * msgType contains fully qualified name of the type and msgTypeId is a local id which presents the type for performance reasons.
      * Release can be used to instruct the pubsubadmin to release (free) the message when receive function returns. Set it to false to take
      * over ownership of the msg (e.g. take the responsibility to free it).
+     * A pubsubadmin can share a msg between the subscribers of a topic, so the msg should only be changed after taking over
+     * ownership.
      *
      * The callbacks argument is only valid inside the receive function, use the getMultipart callback, with retain=true, to keep multipart messages in memory.
      * results of the localMsgTypeIdForMsgType callback are valid during the complete lifecycle of the component, not just a single receive call.
@@ -64,6 +68,23 @@ struct pubsub_subscriber_struct {
      */
     int (*receive)(void *handle, const char *msgType, unsigned int msgTypeId, void *msg, bool *release);
 
+    /**
+     * Optional batch variant of receive (since version 4.0.0).
+     *
+     * If set, a pubsubadmin dispatching msgs on its receive thread can collect the msgs which are readable at once and
+     * deliver consecutive msgs of the same msg type in a single call, in receive order, instead of calling receive
+     * for every msg.
+     * The msgs are owned by the pubsubadmin and are released when receiveBatch returns. The msgs are not shared with
+     * other subscribers and can be changed.
+     * Pubsubadmins without batch support, or dispatching msgs through dispatch queues, keep calling receive, so receive
+     * should also be provided.
+     *
+     * Return 0 implies a successful handling.
+     *
+     * this method can be NULL.
+     */
+    int (*receiveBatch)(void *handle, unsigned int msgTypeId, void **msgs, size_t nrOfMsgs);
+
 };
 typedef struct pubsub_subscriber_struct pubsub_subscriber_t;
 
@@ -53,7 +53,12 @@
 static celix_properties_t* pubsub_discovery_parseEndpoint(pubsub_discovery_t *disc, const char *key, const char *value);
 static char* pubsub_discovery_createJsonEndpoint(const celix_properties_t *props);
 static void pubsub_discovery_addDiscoveredEndpoint(pubsub_discovery_t *disc, celix_properties_t *endpoint);
+static void pubsub_discovery_addDiscoveredEndpoints(pubsub_discovery_t *disc, celix_properties_t **endpoints, size_t nrOfEndpoints);
+static void pubsub_discovery_informListener(pubsub_discovered_endpoint_listener_t *listener, const celix_properties_t **endpoints, size_t nrOfEndpoints, bool added);
+static void pubsub_discovery_informListeners(pubsub_discovery_t *disc, const celix_properties_t **endpoints, size_t nrOfEndpoints, bool added);
+static size_t pubsub_discovery_takeAllDiscoveredEndpoints(pubsub_discovery_t *disc, celix_properties_t ***endpointsOut);
 static void pubsub_discovery_removeDiscoveredEndpoint(pubsub_discovery_t *disc, const char *uuid);
+static int pubsub_discovery_removeDiscoveredEndpointsOfFramework(pubsub_discovery_t *disc, const char *fwUUID);
 
 /* Discovery activator functions */
 pubsub_discovery_t* pubsub_discovery_create(celix_bundle_context_t *context, log_helper_t *logHelper) {
@@ -88,6 +93,7 @@ pubsub_discovery_t* pubsub_discovery_create(celix_bundle_context_t *context, log
     disc->sleepInsecBetweenTTLRefresh = (int)(((float)ttl)/2.0);
     disc->pubsubPath = celix_bundleContext_getProperty(context, PUBSUB_DISCOVERY_SERVER_PATH_KEY, PUBSUB_DISCOVERY_SERVER_PATH_DEFAULT);
     disc->fwUUID = celix_bundleContext_getProperty(context, OSGI_FRAMEWORK_FRAMEWORK_UUID, NULL);
+    asprintf(&disc->leaseKey, "/pubsub/%s", disc->fwUUID);
 
     return disc;
 }
@@ -126,6 +132,7 @@ celix_status_t pubsub_discovery_destroy(pubsub_discovery_t *ps_discovery) {
         etcdlib_destroy(ps_discovery->etcdlib);
         ps_discovery->etcdlib = NULL;
     }
+    free(ps_discovery->leaseKey);
 
     free(ps_discovery);
 
@@ -133,11 +140,16 @@ celix_status_t pubsub_discovery_destroy(pubsub_discovery_t *ps_discovery) {
 }
 
 
+typedef struct psd_directory_read {
+    pubsub_discovery_t *disc;
+    celix_array_list_t *endpoints; //<celix_properties_t*>
+} psd_directory_read_t;
+
 static void psd_etcdReadCallback(const char *key, const char *value, void* arg) {
-    pubsub_discovery_t *disc = arg;
-    celix_properties_t *props = pubsub_discovery_parseEndpoint(disc, key, value);
+    psd_directory_read_t *read = arg;
+    celix_properties_t *props = pubsub_discovery_parseEndpoint(read->disc, key, value);
     if (props != NULL) {
-        pubsub_discovery_addDiscoveredEndpoint(disc, props);
+        celix_arrayList_add(read->endpoints, props);
     }
 }
 
@@ -147,7 +159,20 @@ static void psd_watchSetupConnection(pubsub_discovery_t *disc, bool *connectedPt
         if (disc->verbose) {
             printf("[PSD] Reading etcd directory at %s\n", disc->pubsubPath);
         }
-        int rc = etcdlib_get_directory(disc->etcdlib, disc->pubsubPath, psd_etcdReadCallback, disc, mIndex);
+        //the endpoints of the directory are added as a single batch, so that listeners apply them as one update
+        psd_directory_read_t read;
+        read.disc = disc;
+        read.endpoints = celix_arrayList_create();
+        int rc = etcdlib_get_directory(disc->etcdlib, disc->pubsubPath, psd_etcdReadCallback, &read, mIndex);
+        int size = celix_arrayList_size(read.endpoints);
+        if (size > 0) {
+            celix_properties_t *endpoints[size];
+            for (int i = 0; i < size; ++i) {
+                endpoints[i] = celix_arrayList_get(read.endpoints, i);
+            }
+            pubsub_discovery_addDiscoveredEndpoints(disc, endpoints, (size_t) size);
+        }
+        celix_arrayList_destroy(read.endpoints);
         if (rc == ETCDLIB_RC_OK) {
             *connectedPtr = true;
         } else {
@@ -164,18 +189,18 @@ static void psd_watchForChange(pubsub_discovery_t *disc, bool *connectedPtr, lon
         char *action = NULL;
         char *value = NULL;
         char *readKey = NULL;
-        //TODO add interruptable etcdlib_wait -> which returns a handle to interrupt and a can be used for a wait call
+        //note interrupted by pubsub_discovery_stop
         int rc = etcdlib_watch(disc->etcdlib, disc->pubsubPath, watchIndex, &action, NULL, &value, &readKey, mIndex);
         if (rc == ETCDLIB_RC_ERROR) {
             L_ERROR("[PSD] Communicating with etcd. rc is %i, action value is %s\n", rc, action);
             *connectedPtr = false;
-        } else if (rc == ETCDLIB_RC_TIMEOUT || action == NULL) {
+        } else if (rc == ETCDLIB_RC_TIMEOUT || rc == ETCDLIB_RC_INTERRUPTED || action == NULL) {
             //nop
         } else {
             if (strncmp(ETCDLIB_ACTION_CREATE, action, strlen(ETCDLIB_ACTION_CREATE)) == 0 ||
                        strncmp(ETCDLIB_ACTION_SET, action, strlen(ETCDLIB_ACTION_SET)) == 0 ||
                        strncmp(ETCDLIB_ACTION_UPDATE, action, strlen(ETCDLIB_ACTION_UPDATE)) == 0) {
-                celix_properties_t *props = pubsub_discovery_parseEndpoint(disc, readKey, value);
+                celix_properties_t *props = value != NULL ? pubsub_discovery_parseEndpoint(disc, readKey, value) : NULL; //no value -> lease directory
                 if (props != NULL) {
                     pubsub_discovery_addDiscoveredEndpoint(disc, props);
                 }
@@ -183,6 +208,7 @@ static void psd_watchForChange(pubsub_discovery_t *disc, bool *connectedPtr, lon
                        strncmp(ETCDLIB_ACTION_EXPIRE, action, strlen(ETCDLIB_ACTION_EXPIRE)) == 0) {
                 char *uuid = strrchr(readKey, '/');
                 if (uuid != NULL) {
+                    //note the uuid is the framework uuid if the lease directory of a framework is deleted or expired
                     uuid = uuid + 1;
                     pubsub_discovery_removeDiscoveredEndpoint(disc, uuid);
                 }
@@ -206,27 +232,21 @@ static void psd_cleanupIfDisconnected(pubsub_discovery_t *disc, bool *connectedP
     if (!connected) {
 
         celixThreadMutex_lock(&disc->discoveredEndpointsMutex);
-        int size = hashMap_size(disc->discoveredEndpoints);
+        celix_properties_t **endpoints = NULL;
+        size_t size = pubsub_discovery_takeAllDiscoveredEndpoints(disc, &endpoints);
         if (disc->verbose) {
-            printf("[PSD] Removing all discovered entries (%i) -> not connected\n", size);
+            printf("[PSD] Removing all discovered entries (%zu) -> not connected\n", size);
         }
 
-        hash_map_iterator_t iter = hashMapIterator_construct(disc->discoveredEndpoints);
-        while (hashMapIterator_hasNext(&iter)) {
-            celix_properties_t *endpoint = hashMapIterator_nextValue(&iter);
-
-            celixThreadMutex_lock(&disc->discoveredEndpointsListenersMutex);
-            hash_map_iterator_t iter2 = hashMapIterator_construct(disc->discoveredEndpointsListeners);
-            while (hashMapIterator_hasNext(&iter2)) {
-                pubsub_discovered_endpoint_listener_t *listener = hashMapIterator_nextValue(&iter2);
-                listener->removeDiscoveredEndpoint(listener->handle, endpoint);
-            }
-            celixThreadMutex_unlock(&disc->discoveredEndpointsListenersMutex);
+        celixThreadMutex_lock(&disc->discoveredEndpointsListenersMutex);
+        pubsub_discovery_informListeners(disc, (const celix_properties_t **) endpoints, size, false);
+        celixThreadMutex_unlock(&disc->discoveredEndpointsListenersMutex);
+        celixThreadMutex_unlock(&disc->discoveredEndpointsMutex);
 
-            celix_properties_destroy(endpoint);
+        for (size_t i = 0; i < size; ++i) {
+            celix_properties_destroy(endpoints[i]);
         }
-        hashMap_clear(disc->discoveredEndpoints, false, false);
-        celixThreadMutex_unlock(&disc->discoveredEndpointsMutex);
+        free(endpoints);
     }
 }
 
@@ -246,7 +266,18 @@ void* psd_watch(void *data) {
         psd_cleanupIfDisconnected(disc, &connected);
 
         if (!connected) {
-            usleep(5000000); //if not connected wait a few seconds
+            //if not connected wait a few seconds, or till stopped
+            struct timespec waitTill;
+            clock_gettime(CLOCK_MONOTONIC, &waitTill);
+            waitTill.tv_sec += 5;
+            pthread_mutex_lock(&disc->waitMutex);
+            celixThreadMutex_lock(&disc->runningMutex);
+            running = disc->running;
+            celixThreadMutex_unlock(&disc->runningMutex);
+            if (running) {
+                pthread_cond_timedwait(&disc->waitCond, &disc->waitMutex, &waitTill);
+            }
+            pthread_mutex_unlock(&disc->waitMutex);
         }
 
         celixThreadMutex_lock(&disc->runningMutex);
@@ -269,32 +300,62 @@ void* psd_refresh(void *data) {
         clock_gettime(CLOCK_MONOTONIC, &start);
 
         celixThreadMutex_lock(&disc->announcedEndpointsMutex);
+        if (disc->leaseSet) {
+            //only refresh ttl of the lease directory -> no index update -> no watch trigger
+            int rc = etcdlib_set_dir(disc->etcdlib, disc->leaseKey, disc->ttlForEntries, true);
+            if (rc != ETCDLIB_RC_OK) {
+                L_WARN("[PSD] Warning: Cannot refresh etcd lease directory %s\n", disc->leaseKey);
+                disc->leaseSet = false;
+            }
+        }
+        if (!disc->leaseSet) {
+            //(re)create the lease directory, if it expired all announced endpoints have to be set again
+            int rc = etcdlib_set_dir(disc->etcdlib, disc->leaseKey, disc->ttlForEntries, false);
+            disc->leaseSet = rc == ETCDLIB_RC_OK;
+            if (!disc->leaseSet) {
+                L_WARN("[PSD] Warning: Cannot create etcd lease directory %s\n", disc->leaseKey);
+            }
+        }
+
+        //all entries to (re)announce are set with a single batch, which reuses the etcdlib connection
+        int size = hashMap_size(disc->announcedEndpoints);
+        pubsub_announce_entry_t *toSet[size > 0 ? size : 1];
+        const char *keys[size > 0 ? size : 1];
+        const char *values[size > 0 ? size : 1];
+        int results[size > 0 ? size : 1];
+        int nrToSet = 0;
+
         hash_map_iterator_t iter = hashMapIterator_construct(disc->announcedEndpoints);
         while (hashMapIterator_hasNext(&iter)) {
             pubsub_announce_entry_t *entry = hashMapIterator_nextValue(&iter);
-            if (entry->isSet) {
-                //only refresh ttl -> no index update -> no watch trigger
-                int rc = etcdlib_refresh(disc->etcdlib, entry->key, disc->ttlForEntries);
-                if (rc != ETCDLIB_RC_OK) {
-                    L_WARN("[PSD] Warning: Cannot refresh etcd key %s\n", entry->key);
-                    entry->isSet = false;
-                    entry->errorCount += 1;
-                } else {
-                    entry->refreshCount += 1;
-                }
+            if (!disc->leaseSet) {
+                entry->isSet = false;
+                entry->errorCount += 1;
+            } else if (entry->isSet) {
+                entry->refreshCount += 1;
             } else {
-                char *str = pubsub_discovery_createJsonEndpoint(entry->properties);
-                int rc = etcdlib_set(disc->etcdlib, entry->key, str, disc->ttlForEntries, false);
-                if (rc == ETCDLIB_RC_OK) {
-                    entry->isSet = true;
-                    entry->setCount += 1;
-                } else {
-                    L_WARN("[PSD] Warning: Cannot set endpoint in etcd for key %s\n", entry->key);
-                    entry->errorCount += 1;
-                }
-                free(str);
+                //no ttl for the entry -> expires with the lease directory
+                toSet[nrToSet] = entry;
+                keys[nrToSet] = entry->key;
+                values[nrToSet] = pubsub_discovery_createJsonEndpoint(entry->properties);
+                nrToSet += 1;
             }
         }
+
+        if (nrToSet > 0) {
+            etcdlib_setMany(disc->etcdlib, nrToSet, keys, values, 0, results);
+        }
+        for (int i = 0; i < nrToSet; ++i) {
+            pubsub_announce_entry_t *entry = toSet[i];
+            if (results[i] == ETCDLIB_RC_OK) {
+                entry->isSet = true;
+                entry->setCount += 1;
+            } else {
+                L_WARN("[PSD] Warning: Cannot set endpoint in etcd for key %s\n", entry->key);
+                entry->errorCount += 1;
+            }
+            free((char *) values[i]);
+        }
         celixThreadMutex_unlock(&disc->announcedEndpointsMutex);
 
         struct timespec waitTill = start;
@@ -332,34 +393,31 @@ celix_status_t pubsub_discovery_stop(pubsub_discovery_t *disc) {
     celixThreadCondition_broadcast(&disc->waitCond);
     celixThreadMutex_unlock(&disc->waitMutex);
 
+    etcdlib_interrupt(disc->etcdlib);
     celixThread_join(disc->watchThread, NULL);
     celixThread_join(disc->refreshTTLThread, NULL);
 
     celixThreadMutex_lock(&disc->discoveredEndpointsMutex);
-    hash_map_iterator_t iter = hashMapIterator_construct(disc->discoveredEndpoints);
-    while (hashMapIterator_hasNext(&iter)) {
-        celix_properties_t *props = hashMapIterator_nextValue(&iter);
-
-        celixThreadMutex_lock(&disc->discoveredEndpointsListenersMutex);
-        hash_map_iterator_t iter2 = hashMapIterator_construct(disc->discoveredEndpointsListeners);
-        while (hashMapIterator_hasNext(&iter2)) {
-            pubsub_discovered_endpoint_listener_t *listener = hashMapIterator_nextValue(&iter2);
-            listener->removeDiscoveredEndpoint(listener->handle, props);
-        }
-        celixThreadMutex_unlock(&disc->discoveredEndpointsListenersMutex);
-
-        celix_properties_destroy(props);
-    }
-    hashMap_clear(disc->discoveredEndpoints, false, false);
+    celix_properties_t **endpoints = NULL;
+    size_t size = pubsub_discovery_takeAllDiscoveredEndpoints(disc, &endpoints);
+    celixThreadMutex_lock(&disc->discoveredEndpointsListenersMutex);
+    pubsub_discovery_informListeners(disc, (const celix_properties_t **) endpoints, size, false);
+    celixThreadMutex_unlock(&disc->discoveredEndpointsListenersMutex);
     celixThreadMutex_unlock(&disc->discoveredEndpointsMutex);
+    for (size_t i = 0; i < size; ++i) {
+        celix_properties_destroy(endpoints[i]);
+    }
+    free(endpoints);
 
     celixThreadMutex_lock(&disc->announcedEndpointsMutex);
-    iter = hashMapIterator_construct(disc->announcedEndpoints);
+    if (disc->leaseSet) {
+        //deletes all announced endpoints with a single (recursive) delete
+        etcdlib_del(disc->etcdlib, disc->leaseKey);
+        disc->leaseSet = false;
+    }
+    hash_map_iterator_t iter = hashMapIterator_construct(disc->announcedEndpoints);
     while (hashMapIterator_hasNext(&iter)) {
         pubsub_announce_entry_t *entry = hashMapIterator_nextValue(&iter);
-        if (entry->isSet) {
-            etcdlib_del(disc->etcdlib, entry->key);
-        }
         free(entry->key);
         celix_properties_destroy(entry->properties);
         free(entry);
@@ -380,10 +438,15 @@ void pubsub_discovery_discoveredEndpointsListenerAdded(void *handle, void *svc,
     celixThreadMutex_unlock(&disc->discoveredEndpointsListenersMutex);
 
     celixThreadMutex_lock(&disc->discoveredEndpointsMutex);
-    hash_map_iterator_t iter = hashMapIterator_construct(disc->discoveredEndpoints);
-    while (hashMapIterator_hasNext(&iter)) {
-        celix_properties_t *props = hashMapIterator_nextValue(&iter);
-        listener->addDiscoveredEndpoint(listener->handle, props);
+    int size = hashMap_size(disc->discoveredEndpoints);
+    if (size > 0) {
+        const celix_properties_t *endpoints[size];
+        int i = 0;
+        hash_map_iterator_t iter = hashMapIterator_construct(disc->discoveredEndpoints);
+        while (hashMapIterator_hasNext(&iter)) {
+            endpoints[i++] = hashMapIterator_nextValue(&iter);
+        }
+        pubsub_discovery_informListener(listener, endpoints, (size_t) size, true);
     }
     celixThreadMutex_unlock(&disc->discoveredEndpointsMutex);
 }
@@ -414,7 +477,7 @@ celix_status_t pubsub_discovery_announceEndpoint(void *handle, const celix_prope
         clock_gettime(CLOCK_MONOTONIC, &entry->createTime);
         entry->isSet = false;
         entry->properties = celix_properties_copy(endpoint);
-        asprintf(&entry->key, "/pubsub/%s/%s/%s/%s", config, scope, topic, uuid);
+        asprintf(&entry->key, "%s/%s/%s/%s/%s", disc->leaseKey, config, scope, topic, uuid);
 
         const char *hashKey = celix_properties_get(entry->properties, PUBSUB_ENDPOINT_UUID, NULL);
         celixThreadMutex_lock(&disc->announcedEndpointsMutex);
@@ -462,38 +525,97 @@ celix_status_t pubsub_discovery_revokeEndpoint(void *handle, const celix_propert
 }
 
 
+/**
+ * Informs a listener about added or removed endpoints, with a single call if the listener supports batches.
+ */
+static void pubsub_discovery_informListener(pubsub_discovered_endpoint_listener_t *listener, const celix_properties_t **endpoints, size_t nrOfEndpoints, bool added) {
+    if (nrOfEndpoints == 0) {
+        return;
+    }
+    if (added && listener->addDiscoveredEndpoints != NULL) {
+        listener->addDiscoveredEndpoints(listener->handle, endpoints, nrOfEndpoints);
+    } else if (!added && listener->removeDiscoveredEndpoints != NULL) {
+        listener->removeDiscoveredEndpoints(listener->handle, endpoints, nrOfEndpoints);
+    } else {
+        for (size_t i = 0; i < nrOfEndpoints; ++i) {
+            if (added) {
+                listener->addDiscoveredEndpoint(listener->handle, endpoints[i]);
+            } else {
+                listener->removeDiscoveredEndpoint(listener->handle, endpoints[i]);
+            }
+        }
+    }
+}
+
+/**
+ * Informs all listeners about added or removed endpoints. Called with the discoveredEndpointsListenersMutex locked.
+ */
+static void pubsub_discovery_informListeners(pubsub_discovery_t *disc, const celix_properties_t **endpoints, size_t nrOfEndpoints, bool added) {
+    hash_map_iterator_t iter = hashMapIterator_construct(disc->discoveredEndpointsListeners);
+    while (hashMapIterator_hasNext(&iter)) {
+        pubsub_discovered_endpoint_listener_t *listener = hashMapIterator_nextValue(&iter);
+        pubsub_discovery_informListener(listener, endpoints, nrOfEndpoints, added);
+    }
+}
+
+/**
+ * Removes all discovered endpoints from the map and returns them (caller is owner of the endpoints and the array).
+ * Called with the discoveredEndpointsMutex locked.
+ */
+static size_t pubsub_discovery_takeAllDiscoveredEndpoints(pubsub_discovery_t *disc, celix_properties_t ***endpointsOut) {
+    size_t size = (size_t) hashMap_size(disc->discoveredEndpoints);
+    celix_properties_t **endpoints = calloc(size > 0 ? size : 1, sizeof(*endpoints));
+    size_t i = 0;
+    hash_map_iterator_t iter = hashMapIterator_construct(disc->discoveredEndpoints);
+    while (hashMapIterator_hasNext(&iter)) {
+        endpoints[i++] = hashMapIterator_nextValue(&iter);
+    }
+    hashMap_clear(disc->discoveredEndpoints, false, false);
+    *endpointsOut = endpoints;
+    return size;
+}
+
 static void pubsub_discovery_addDiscoveredEndpoint(pubsub_discovery_t *disc, celix_properties_t *endpoint) {
-    const char *uuid = celix_properties_get(endpoint, PUBSUB_ENDPOINT_UUID, NULL);
-    assert(uuid != NULL);
+    pubsub_discovery_addDiscoveredEndpoints(disc, &endpoint, 1);
+}
+
+/**
+ * Adds the endpoints (takes ownership) and informs the listeners about the new ones with a single (batch) call.
+ */
+static void pubsub_discovery_addDiscoveredEndpoints(pubsub_discovery_t *disc, celix_properties_t **endpoints, size_t nrOfEndpoints) {
+    const celix_properties_t *added[nrOfEndpoints > 0 ? nrOfEndpoints : 1];
+    size_t nrOfAdded = 0;
 
     celixThreadMutex_lock(&disc->discoveredEndpointsMutex);
-    bool exists = hashMap_containsKey(disc->discoveredEndpoints, (void*)uuid);
-    if (exists) {
-        //if exists -> keep old and free properties
-        celix_properties_destroy(endpoint);
-    } else {
-        hashMap_put(disc->discoveredEndpoints, (void*)uuid, endpoint);
+    for (size_t i = 0; i < nrOfEndpoints; ++i) {
+        celix_properties_t *endpoint = endpoints[i];
+        const char *uuid = celix_properties_get(endpoint, PUBSUB_ENDPOINT_UUID, NULL);
+        assert(uuid != NULL);
+        if (hashMap_containsKey(disc->discoveredEndpoints, (void*)uuid)) {
+            //if exists -> keep old and free properties (assuming this is the same endpoint)
+            celix_properties_destroy(endpoint);
+        } else {
+            hashMap_put(disc->discoveredEndpoints, (void*)uuid, endpoint);
+            added[nrOfAdded++] = endpoint;
+        }
     }
     celixThreadMutex_unlock(&disc->discoveredEndpointsMutex);
 
-    if (!exists) {
-        if (disc->verbose) {
-            const char *type = celix_properties_get(endpoint, PUBSUB_ENDPOINT_TYPE, "!Error!");
-            const char *admin = celix_properties_get(endpoint, PUBSUB_ENDPOINT_ADMIN_TYPE, "!Error!");
-            const char *ser = celix_properties_get(endpoint, PUBSUB_SERIALIZER_TYPE_KEY, "!Error!");
+    if (disc->verbose) {
+        for (size_t i = 0; i < nrOfAdded; ++i) {
+            const char *uuid = celix_properties_get(added[i], PUBSUB_ENDPOINT_UUID, "!Error!");
+            const char *type = celix_properties_get(added[i], PUBSUB_ENDPOINT_TYPE, "!Error!");
+            const char *admin = celix_properties_get(added[i], PUBSUB_ENDPOINT_ADMIN_TYPE, "!Error!");
+            const char *ser = celix_properties_get(added[i], PUBSUB_SERIALIZER_TYPE_KEY, "!Error!");
             L_INFO("[PSD] Adding discovered endpoint %s. type is %s, admin is %s, serializer is %s.\n",
                    uuid, type, admin, ser);
         }
+    }
 
+    if (nrOfAdded > 0) {
         celixThreadMutex_lock(&disc->discoveredEndpointsListenersMutex);
-        hash_map_iterator_t iter = hashMapIterator_construct(disc->discoveredEndpointsListeners);
-        while (hashMapIterator_hasNext(&iter)) {
-            pubsub_discovered_endpoint_listener_t *listener = hashMapIterator_nextValue(&iter);
-            listener->addDiscoveredEndpoint(listener->handle, endpoint);
-        }
+        pubsub_discovery_informListeners(disc, added, nrOfAdded, true);
         celixThreadMutex_unlock(&disc->discoveredEndpointsListenersMutex);
-    } else {
-        //assuming this is the same endpoint -> ignore
     }
 }
 
@@ -503,7 +625,10 @@ static void pubsub_discovery_removeDiscoveredEndpoint(pubsub_discovery_t *disc,
     celixThreadMutex_unlock(&disc->discoveredEndpointsMutex);
 
     if (endpoint == NULL) {
-        L_WARN("Cannot find endpoint with uuid %s\n", uuid);
+        //the uuid can also be the framework uuid of a deleted or expired lease directory
+        if (pubsub_discovery_removeDiscoveredEndpointsOfFramework(disc, uuid) == 0) {
+            L_WARN("Cannot find endpoint with uuid %s\n", uuid);
+        }
         return;
     }
 
@@ -516,12 +641,9 @@ static void pubsub_discovery_removeDiscoveredEndpoint(pubsub_discovery_t *disc,
     }
 
     if (endpoint != NULL) {
+        const celix_properties_t *removed = endpoint;
         celixThreadMutex_lock(&disc->discoveredEndpointsListenersMutex);
-        hash_map_iterator_t iter = hashMapIterator_construct(disc->discoveredEndpointsListeners);
-        while (hashMapIterator_hasNext(&iter)) {
-            pubsub_discovered_endpoint_listener_t *listener = hashMapIterator_nextValue(&iter);
-            listener->removeDiscoveredEndpoint(listener->handle, endpoint);
-        }
+        pubsub_discovery_informListeners(disc, &removed, 1, false);
         celixThreadMutex_unlock(&disc->discoveredEndpointsListenersMutex);
 
         celix_properties_destroy(endpoint);
@@ -530,6 +652,42 @@ static void pubsub_discovery_removeDiscoveredEndpoint(pubsub_discovery_t *disc,
     }
 }
 
+static int pubsub_discovery_removeDiscoveredEndpointsOfFramework(pubsub_discovery_t *disc, const char *fwUUID) {
+    celix_array_list_t *removed = celix_arrayList_create();
+    celixThreadMutex_lock(&disc->discoveredEndpointsMutex);
+    hash_map_iterator_t iter = hashMapIterator_construct(disc->discoveredEndpoints);
+    while (hashMapIterator_hasNext(&iter)) {
+        celix_properties_t *endpoint = hashMapIterator_nextValue(&iter);
+        const char *epFwUUID = celix_properties_get(endpoint, PUBSUB_ENDPOINT_FRAMEWORK_UUID, NULL);
+        if (epFwUUID != NULL && strcmp(epFwUUID, fwUUID) == 0) {
+            hashMapIterator_remove(&iter);
+            celix_arrayList_add(removed, endpoint);
+        }
+    }
+    celixThreadMutex_unlock(&disc->discoveredEndpointsMutex);
+
+    int size = celix_arrayList_size(removed);
+    if (disc->verbose && size > 0) {
+        L_INFO("[PSD] Removing %i discovered endpoints of framework %s.\n", size, fwUUID);
+    }
+
+    if (size > 0) {
+        const celix_properties_t *endpoints[size];
+        for (int i = 0; i < size; ++i) {
+            endpoints[i] = celix_arrayList_get(removed, i);
+        }
+        celixThreadMutex_lock(&disc->discoveredEndpointsListenersMutex);
+        pubsub_discovery_informListeners(disc, endpoints, (size_t) size, false);
+        celixThreadMutex_unlock(&disc->discoveredEndpointsListenersMutex);
+    }
+
+    for (int i = 0; i < size; ++i) {
+        celix_properties_destroy(celix_arrayList_get(removed, i));
+    }
+    celix_arrayList_destroy(removed);
+    return size;
+}
+
 celix_properties_t* pubsub_discovery_parseEndpoint(pubsub_discovery_t *disc, const char *key, const char* etcdValue) {
     celix_properties_t *props = celix_properties_create();
 
@@ -74,10 +74,14 @@ typedef struct pubsub_discovery {
     int ttlForEntries;
     int sleepInsecBetweenTTLRefresh;
     const char *fwUUID;
+
+    //all announced endpoints are set in a single etcd directory with a ttl, so that one refresh keeps them all alive
+    char *leaseKey; //etcd key of the directory, /pubsub/<framework uuid>
+    bool leaseSet; //only accessed by the refresh thread
 } pubsub_discovery_t;
 
 typedef struct pubsub_announce_entry {
-    char *key; //etcd key
+    char *key; //etcd key, inside the lease directory
     bool isSet; //whether the value is already set (in case of unavailable etcd server this can linger)
     int refreshCount;
     int setCount;
@@ -0,0 +1,194 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *  KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "pubsub_capture_file.h"
+
+#define PUBSUB_CAPTURE_FILE_INITIAL_SIZE        (4 * 1024 * 1024)
+
+#define PUBSUB_CAPTURE_ALIGN(size)              (((size) + 7u) & ~((size_t) 7u))
+
+struct pubsub_capture_writer {
+    int fd;
+    char *data;
+    size_t capacity;
+    size_t size;
+};
+
+struct pubsub_capture_reader {
+    int fd;
+    const char *data;
+    size_t size;
+    size_t offset;
+};
+
+static celix_status_t pubsub_captureWriter_map(pubsub_capture_writer_t *writer, size_t capacity) {
+    if (ftruncate(writer->fd, (off_t) capacity) != 0) {
+        return CELIX_FILE_IO_EXCEPTION;
+    }
+    void *data = mmap(NULL, capacity, PROT_READ | PROT_WRITE, MAP_SHARED, writer->fd, 0);
+    if (data == MAP_FAILED) {
+        return CELIX_FILE_IO_EXCEPTION;
+    }
+    writer->data = data;
+    writer->capacity = capacity;
+    return CELIX_SUCCESS;
+}
+
+pubsub_capture_writer_t* pubsub_captureWriter_create(const char *path, const char *serializer, const char *scope, const char *topic) {
+    int fd = open(path, O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) {
+        return NULL;
+    }
+    pubsub_capture_writer_t *writer = calloc(1, sizeof(*writer));
+    writer->fd = fd;
+    if (pubsub_captureWriter_map(writer, PUBSUB_CAPTURE_FILE_INITIAL_SIZE) != CELIX_SUCCESS) {
+        close(fd);
+        unlink(path);
+        free(writer);
+        return NULL;
+    }
+
+    pubsub_capture_file_header_t *header = (pubsub_capture_file_header_t *) writer->data;
+    memcpy(header->magic, PUBSUB_CAPTURE_FILE_MAGIC, sizeof(header->magic));
+    header->version = PUBSUB_CAPTURE_FILE_VERSION;
+    header->headerSize = (uint32_t) PUBSUB_CAPTURE_ALIGN(sizeof(*header));
+    strncpy(header->serializer, serializer, sizeof(header->serializer) - 1);
+    if (scope != NULL) {
+        strncpy(header->scope, scope, sizeof(header->scope) - 1);
+    }
+    strncpy(header->topic, topic, sizeof(header->topic) - 1);
+    writer->size = header->headerSize;
+    return writer;
+}
+
+celix_status_t pubsub_captureWriter_append(pubsub_capture_writer_t *writer, pubsub_capture_record_header_t *header, const void *buffer, uint32_t bufferSize) {
+    size_t recordSize = PUBSUB_CAPTURE_ALIGN(sizeof(*header) + bufferSize);
+    //keep room for an empty end record
+    if (writer->size + recordSize + sizeof(*header) > writer->capacity) {
+        size_t capacity = writer->capacity * 2;
+        while (writer->size + recordSize + sizeof(*header) > capacity) {
+            capacity *= 2;
+        }
+        munmap(writer->data, writer->capacity);
+        writer->data = NULL;
+        celix_status_t status = pubsub_captureWriter_map(writer, capacity);
+        if (status != CELIX_SUCCESS) {
+            //remap the written part, so that the writer can still be destroyed
+            pubsub_captureWriter_map(writer, writer->capacity);
+            return status;
+        }
+    }
+
+    header->marker_start = PUBSUB_CAPTURE_RECORD_MARKER_START;
+    header->marker_end = PUBSUB_CAPTURE_RECORD_MARKER_END;
+    header->bufferSize = bufferSize;
+    char *record = writer->data + writer->size;
+    memcpy(record + sizeof(*header), buffer, bufferSize);
+    memcpy(record, header, sizeof(*header));
+    writer->size += recordSize;
+    return CELIX_SUCCESS;
+}
+
+size_t pubsub_captureWriter_size(pubsub_capture_writer_t *writer) {
+    return writer->size;
+}
+
+void pubsub_captureWriter_destroy(pubsub_capture_writer_t *writer) {
+    if (writer != NULL) {
+        if (writer->data != NULL) {
+            msync(writer->data, writer->size, MS_SYNC);
+            munmap(writer->data, writer->capacity);
+        }
+        ftruncate(writer->fd, (off_t) writer->size);
+        close(writer->fd);
+        free(writer);
+    }
+}
+
+pubsub_capture_reader_t* pubsub_captureReader_open(const char *path) {
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        return NULL;
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0 || (size_t) st.st_size < sizeof(pubsub_capture_file_header_t)) {
+        close(fd);
+        return NULL;
+    }
+    void *data = mmap(NULL, (size_t) st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (data == MAP_FAILED) {
+        close(fd);
+        return NULL;
+    }
+    const pubsub_capture_file_header_t *header = data;
+    if (memcmp(header->magic, PUBSUB_CAPTURE_FILE_MAGIC, sizeof(header->magic)) != 0 ||
+        header->version != PUBSUB_CAPTURE_FILE_VERSION || header->headerSize > (size_t) st.st_size) {
+        munmap(data, (size_t) st.st_size);
+        close(fd);
+        return NULL;
+    }
+
+    pubsub_capture_reader_t *reader = calloc(1, sizeof(*reader));
+    reader->fd = fd;
+    reader->data = data;
+    reader->size = (size_t) st.st_size;
+    reader->offset = header->headerSize;
+    return reader;
+}
+
+const pubsub_capture_file_header_t* pubsub_captureReader_header(pubsub_capture_reader_t *reader) {
+    return (const pubsub_capture_file_header_t *) reader->data;
+}
+
+bool pubsub_captureReader_next(pubsub_capture_reader_t *reader, const pubsub_capture_record_header_t **header, const void **buffer) {
+    if (reader->offset + sizeof(pubsub_capture_record_header_t) > reader->size) {
+        return false;
+    }
+    const pubsub_capture_record_header_t *hdr = (const pubsub_capture_record_header_t *) (reader->data + reader->offset);
+    if (hdr->marker_start != PUBSUB_CAPTURE_RECORD_MARKER_START || hdr->marker_end != PUBSUB_CAPTURE_RECORD_MARKER_END) {
+        return false;
+    }
+    size_t recordSize = PUBSUB_CAPTURE_ALIGN(sizeof(*hdr) + hdr->bufferSize);
+    if (reader->offset + sizeof(*hdr) + hdr->bufferSize > reader->size) {
+        return false; //truncated record
+    }
+    *header = hdr;
+    *buffer = reader->data + reader->offset + sizeof(*hdr);
+    reader->offset += recordSize;
+    return true;
+}
+
+void pubsub_captureReader_rewind(pubsub_capture_reader_t *reader) {
+    reader->offset = pubsub_captureReader_header(reader)->headerSize;
+}
+
+void pubsub_captureReader_close(pubsub_capture_reader_t *reader) {
+    if (reader != NULL) {
+        munmap((void *) reader->data, reader->size);
+        close(reader->fd);
+        free(reader);
+    }
+}
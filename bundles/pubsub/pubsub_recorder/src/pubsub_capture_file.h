@@ -0,0 +1,103 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *  KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#ifndef PUBSUB_CAPTURE_FILE_H_
+#define PUBSUB_CAPTURE_FILE_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "celix_errno.h"
+
+/**
+ * A capture file starts with a pubsub_capture_file_header_t, followed by the recorded msgs.
+ * Every recorded msg is a pubsub_capture_record_header_t followed by bufferSize bytes of serialized msg, padded to
+ * 8 bytes. The record header has the same fields as the msg header of the TCP PSA (without the origin uuid), the
+ * time is the receive time of the msg.
+ * The file is written append-only through a memory mapping, a record with a start marker of 0 ends the file.
+ */
+#define PUBSUB_CAPTURE_FILE_MAGIC               "CLXPSCAP"
+#define PUBSUB_CAPTURE_FILE_VERSION             1
+#define PUBSUB_CAPTURE_RECORD_MARKER_START      0x2743A1F5
+#define PUBSUB_CAPTURE_RECORD_MARKER_END        0x5F1A3472
+
+typedef struct pubsub_capture_file_header {
+    char magic[8];
+    uint32_t version;
+    uint32_t headerSize;
+    char serializer[32];
+    char scope[64]; //empty if no scope
+    char topic[128];
+} pubsub_capture_file_header_t;
+
+typedef struct pubsub_capture_record_header {
+    uint32_t marker_start;
+    uint32_t type; //msg type id (hash of fqn)
+    uint32_t seqNr;
+    uint8_t  major;
+    uint8_t  minor;
+    uint16_t flags;
+    uint64_t timeSeconds; //seconds since epoch
+    uint64_t timeNanoseconds; //ns part of the time
+    uint32_t bufferSize; //size of the serialized msg
+    uint32_t marker_end;
+} pubsub_capture_record_header_t;
+
+typedef struct pubsub_capture_writer pubsub_capture_writer_t;
+typedef struct pubsub_capture_reader pubsub_capture_reader_t;
+
+/**
+ * Creates (or truncates) the capture file and maps it for writing.
+ * Returns NULL if the file cannot be created.
+ */
+pubsub_capture_writer_t* pubsub_captureWriter_create(const char *path, const char *serializer, const char *scope, const char *topic);
+
+/**
+ * Appends a record. The marker and bufferSize fields of the header are set by the writer.
+ * The mapping is grown (doubled) if the record does not fit.
+ */
+celix_status_t pubsub_captureWriter_append(pubsub_capture_writer_t *writer, pubsub_capture_record_header_t *header, const void *buffer, uint32_t bufferSize);
+
+size_t pubsub_captureWriter_size(pubsub_capture_writer_t *writer);
+
+/**
+ * Unmaps the capture file and truncates it to the written size.
+ */
+void pubsub_captureWriter_destroy(pubsub_capture_writer_t *writer);
+
+/**
+ * Opens and maps a capture file for reading.
+ * Returns NULL if the file cannot be opened or is not a capture file.
+ */
+pubsub_capture_reader_t* pubsub_captureReader_open(const char *path);
+
+const pubsub_capture_file_header_t* pubsub_captureReader_header(pubsub_capture_reader_t *reader);
+
+/**
+ * Returns the next record, the returned header and buffer point into the mapped file and are valid until the reader is
+ * closed. Returns false at the end of the file.
+ */
+bool pubsub_captureReader_next(pubsub_capture_reader_t *reader, const pubsub_capture_record_header_t **header, const void **buffer);
+
+void pubsub_captureReader_rewind(pubsub_capture_reader_t *reader);
+
+void pubsub_captureReader_close(pubsub_capture_reader_t *reader);
+
+#endif /* PUBSUB_CAPTURE_FILE_H_ */
@@ -0,0 +1,175 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *  KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+#include "celix_api.h"
+#include "pubsub/subscriber.h"
+#include "pubsub_serializer.h"
+#include "pubsub_constants.h"
+
+#include "pubsub_capture_file.h"
+#include "pubsub_recorder.h"
+
+#define L_INFO(...) \
+    logHelper_log(recorder->logHelper, OSGI_LOGSERVICE_INFO, __VA_ARGS__)
+#define L_WARN(...) \
+    logHelper_log(recorder->logHelper, OSGI_LOGSERVICE_WARNING, __VA_ARGS__)
+#define L_ERROR(...) \
+    logHelper_log(recorder->logHelper, OSGI_LOGSERVICE_ERROR, __VA_ARGS__)
+
+struct pubsub_recorder {
+    celix_bundle_context_t *ctx;
+    log_helper_t *logHelper;
+    char *path;
+
+    pubsub_subscriber_t subscriberSvc;
+    long subscriberSvcId;
+    long serializerTrackerId;
+
+    celix_thread_mutex_t mutex; //protects below
+    pubsub_serializer_service_t *serializer;
+    hash_map_t *msgSerializers; //key = msg type id, value = pubsub_msg_serializer_t*
+    pubsub_capture_writer_t *writer;
+    unsigned int seqNr;
+    size_t nrOfDroppedMsgs;
+};
+
+static int pubsub_recorder_receive(void *handle, const char *msgType, unsigned int msgTypeId, void *msg, bool *release);
+static void pubsub_recorder_setSerializer(void *handle, void *svc);
+
+pubsub_recorder_t* pubsub_recorder_create(celix_bundle_context_t *ctx, log_helper_t *logHelper, const char *path, const char *scope, const char *topic, const char *serializerType) {
+    pubsub_recorder_t *recorder = calloc(1, sizeof(*recorder));
+    recorder->ctx = ctx;
+    recorder->logHelper = logHelper;
+    recorder->path = strdup(path);
+    recorder->subscriberSvcId = -1L;
+    recorder->serializerTrackerId = -1L;
+    celixThreadMutex_create(&recorder->mutex, NULL);
+
+    recorder->writer = pubsub_captureWriter_create(path, serializerType, scope, topic);
+    if (recorder->writer == NULL) {
+        L_ERROR("[PUBSUB_RECORDER] Cannot create capture file %s", path);
+        pubsub_recorder_destroy(recorder);
+        return NULL;
+    }
+
+    char filter[128];
+    snprintf(filter, sizeof(filter), "(%s=%s)", PUBSUB_SERIALIZER_TYPE_KEY, serializerType);
+    celix_service_tracking_options_t opts = CELIX_EMPTY_SERVICE_TRACKING_OPTIONS;
+    opts.filter.serviceName = PUBSUB_SERIALIZER_SERVICE_NAME;
+    opts.filter.filter = filter;
+    opts.filter.ignoreServiceLanguage = true;
+    opts.callbackHandle = recorder;
+    opts.set = pubsub_recorder_setSerializer;
+    recorder->serializerTrackerId = celix_bundleContext_trackServicesWithOptions(ctx, &opts);
+
+    recorder->subscriberSvc.handle = recorder;
+    recorder->subscriberSvc.receive = pubsub_recorder_receive;
+    celix_properties_t *props = celix_properties_create();
+    celix_properties_set(props, PUBSUB_SUBSCRIBER_TOPIC, topic);
+    if (scope != NULL) {
+        celix_properties_set(props, PUBSUB_SUBSCRIBER_SCOPE, scope);
+    }
+    recorder->subscriberSvcId = celix_bundleContext_registerService(ctx, &recorder->subscriberSvc, PUBSUB_SUBSCRIBER_SERVICE_NAME, props);
+
+    L_INFO("[PUBSUB_RECORDER] Recording topic %s/%s to %s", scope == NULL ? "(null)" : scope, topic, path);
+    return recorder;
+}
+
+void pubsub_recorder_destroy(pubsub_recorder_t *recorder) {
+    if (recorder != NULL) {
+        celix_bundleContext_unregisterService(recorder->ctx, recorder->subscriberSvcId);
+        celix_bundleContext_stopTracker(recorder->ctx, recorder->serializerTrackerId);
+
+        celixThreadMutex_lock(&recorder->mutex);
+        if (recorder->writer != NULL) {
+            L_INFO("[PUBSUB_RECORDER] Recorded %u msgs (%zu bytes) to %s, dropped %zu msgs", recorder->seqNr,
+                   pubsub_captureWriter_size(recorder->writer), recorder->path, recorder->nrOfDroppedMsgs);
+            pubsub_captureWriter_destroy(recorder->writer);
+        }
+        celixThreadMutex_unlock(&recorder->mutex);
+
+        celixThreadMutex_destroy(&recorder->mutex);
+        free(recorder->path);
+        free(recorder);
+    }
+}
+
+static void pubsub_recorder_setSerializer(void *handle, void *svc) {
+    pubsub_recorder_t *recorder = handle;
+    celixThreadMutex_lock(&recorder->mutex);
+    if (recorder->msgSerializers != NULL) {
+        recorder->serializer->destroySerializerMap(recorder->serializer->handle, recorder->msgSerializers);
+        recorder->msgSerializers = NULL;
+    }
+    recorder->serializer = svc;
+    if (svc != NULL) {
+        celix_bundle_t *bnd = celix_bundleContext_getBundle(recorder->ctx);
+        recorder->serializer->createSerializerMap(recorder->serializer->handle, bnd, &recorder->msgSerializers);
+    }
+    celixThreadMutex_unlock(&recorder->mutex);
+}
+
+static int pubsub_recorder_receive(void *handle, const char *msgType, unsigned int msgTypeId, void *msg, bool *release __attribute__((unused))) {
+    pubsub_recorder_t *recorder = handle;
+    struct timespec now;
+    clock_gettime(CLOCK_REALTIME, &now);
+
+    celixThreadMutex_lock(&recorder->mutex);
+    pubsub_msg_serializer_t *msgSer = NULL;
+    if (recorder->msgSerializers != NULL) {
+        msgSer = hashMap_get(recorder->msgSerializers, (void *) (uintptr_t) msgTypeId);
+    }
+    void *buffer = NULL;
+    size_t bufferSize = 0;
+    celix_status_t status = CELIX_ILLEGAL_STATE;
+    if (msgSer != NULL) {
+        status = msgSer->serialize(msgSer->handle, msg, &buffer, &bufferSize);
+    }
+    if (status == CELIX_SUCCESS) {
+        int major = 0;
+        int minor = 0;
+        version_getMajor(msgSer->msgVersion, &major);
+        version_getMinor(msgSer->msgVersion, &minor);
+        pubsub_capture_record_header_t header;
+        memset(&header, 0, sizeof(header));
+        header.type = msgSer->msgId;
+        header.seqNr = recorder->seqNr;
+        header.major = (uint8_t) major;
+        header.minor = (uint8_t) minor;
+        header.timeSeconds = (uint64_t) now.tv_sec;
+        header.timeNanoseconds = (uint64_t) now.tv_nsec;
+        status = pubsub_captureWriter_append(recorder->writer, &header, buffer, (uint32_t) bufferSize);
+        free(buffer);
+    }
+    if (status == CELIX_SUCCESS) {
+        recorder->seqNr += 1;
+    } else {
+        if (recorder->nrOfDroppedMsgs == 0) {
+            L_WARN("[PUBSUB_RECORDER] Cannot record msg %s, no serializer for the msg or the capture file is full", msgType);
+        }
+        recorder->nrOfDroppedMsgs += 1;
+    }
+    celixThreadMutex_unlock(&recorder->mutex);
+    return 0;
+}
@@ -0,0 +1,37 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *  KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#ifndef PUBSUB_RECORDER_H_
+#define PUBSUB_RECORDER_H_
+
+#include "celix_api.h"
+#include "log_helper.h"
+
+typedef struct pubsub_recorder pubsub_recorder_t;
+
+/**
+ * Creates a recorder which subscribes to the scope/topic and appends every received msg, serialized with the
+ * serializer of the provided type, to the capture file.
+ * The msg descriptors of the recorded topic must be part of the recorder bundle (META-INF/descriptors).
+ */
+pubsub_recorder_t* pubsub_recorder_create(celix_bundle_context_t *ctx, log_helper_t *logHelper, const char *path, const char *scope, const char *topic, const char *serializerType);
+
+void pubsub_recorder_destroy(pubsub_recorder_t *recorder);
+
+#endif /* PUBSUB_RECORDER_H_ */
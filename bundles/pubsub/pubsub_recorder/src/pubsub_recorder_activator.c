@@ -0,0 +1,72 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *  KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <stdlib.h>
+
+#include "celix_api.h"
+#include "log_helper.h"
+
+#include "pubsub_recorder_constants.h"
+#include "pubsub_recorder.h"
+#include "pubsub_replayer.h"
+
+typedef struct pubsub_recorder_activator {
+    log_helper_t *logHelper;
+    pubsub_recorder_t *recorder;
+    pubsub_replayer_t *replayer;
+} pubsub_recorder_activator_t;
+
+static int pubsub_recorder_start(pubsub_recorder_activator_t *act, celix_bundle_context_t *ctx) {
+    logHelper_create(ctx, &act->logHelper);
+    logHelper_start(act->logHelper);
+
+    const char *recordFile = celix_bundleContext_getProperty(ctx, PUBSUB_RECORDER_FILE_KEY, NULL);
+    const char *recordTopic = celix_bundleContext_getProperty(ctx, PUBSUB_RECORDER_TOPIC_KEY, NULL);
+    if (recordFile != NULL && recordTopic != NULL) {
+        const char *scope = celix_bundleContext_getProperty(ctx, PUBSUB_RECORDER_SCOPE_KEY, NULL);
+        const char *serializer = celix_bundleContext_getProperty(ctx, PUBSUB_RECORDER_SERIALIZER_KEY, PUBSUB_RECORDER_SERIALIZER_DEFAULT);
+        act->recorder = pubsub_recorder_create(ctx, act->logHelper, recordFile, scope, recordTopic, serializer);
+    } else if (recordFile != NULL) {
+        logHelper_log(act->logHelper, OSGI_LOGSERVICE_ERROR, "[PUBSUB_RECORDER] %s is set, but %s is missing", PUBSUB_RECORDER_FILE_KEY, PUBSUB_RECORDER_TOPIC_KEY);
+    }
+
+    const char *replayFile = celix_bundleContext_getProperty(ctx, PUBSUB_REPLAYER_FILE_KEY, NULL);
+    if (replayFile != NULL) {
+        const char *topic = celix_bundleContext_getProperty(ctx, PUBSUB_REPLAYER_TOPIC_KEY, NULL);
+        const char *scope = celix_bundleContext_getProperty(ctx, PUBSUB_REPLAYER_SCOPE_KEY, NULL);
+        double speed = celix_bundleContext_getPropertyAsDouble(ctx, PUBSUB_REPLAYER_SPEED_KEY, PUBSUB_REPLAYER_SPEED_DEFAULT);
+        bool loop = celix_bundleContext_getPropertyAsBool(ctx, PUBSUB_REPLAYER_LOOP_KEY, PUBSUB_REPLAYER_LOOP_DEFAULT);
+        act->replayer = pubsub_replayer_create(ctx, act->logHelper, replayFile, scope, topic, speed, loop);
+    }
+
+    return CELIX_SUCCESS;
+}
+
+static int pubsub_recorder_stop(pubsub_recorder_activator_t *act, celix_bundle_context_t *ctx __attribute__((unused))) {
+    pubsub_replayer_destroy(act->replayer);
+    pubsub_recorder_destroy(act->recorder);
+    act->replayer = NULL;
+    act->recorder = NULL;
+
+    logHelper_stop(act->logHelper);
+    logHelper_destroy(&act->logHelper);
+    return CELIX_SUCCESS;
+}
+
+CELIX_GEN_BUNDLE_ACTIVATOR(pubsub_recorder_activator_t, pubsub_recorder_start, pubsub_recorder_stop)
@@ -0,0 +1,54 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *  KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#ifndef PUBSUB_RECORDER_CONSTANTS_H_
+#define PUBSUB_RECORDER_CONSTANTS_H_
+
+/**
+ * The capture file to record to. If set the recorder subscribes to PUBSUB_RECORDER_TOPIC and appends every received
+ * msg, serialized with the PUBSUB_RECORDER_SERIALIZER serializer, to the capture file.
+ */
+#define PUBSUB_RECORDER_FILE_KEY                "PUBSUB_RECORDER_FILE"
+#define PUBSUB_RECORDER_TOPIC_KEY               "PUBSUB_RECORDER_TOPIC"
+#define PUBSUB_RECORDER_SCOPE_KEY               "PUBSUB_RECORDER_SCOPE"
+#define PUBSUB_RECORDER_SERIALIZER_KEY          "PUBSUB_RECORDER_SERIALIZER"
+#define PUBSUB_RECORDER_SERIALIZER_DEFAULT      "json"
+
+/**
+ * The capture file to replay. If set the replayer publishes the recorded msgs on the recorded topic and scope, unless
+ * overridden with PUBSUB_REPLAYER_TOPIC/PUBSUB_REPLAYER_SCOPE.
+ */
+#define PUBSUB_REPLAYER_FILE_KEY                "PUBSUB_REPLAYER_FILE"
+#define PUBSUB_REPLAYER_TOPIC_KEY               "PUBSUB_REPLAYER_TOPIC"
+#define PUBSUB_REPLAYER_SCOPE_KEY               "PUBSUB_REPLAYER_SCOPE"
+
+/**
+ * The replay speed relative to the recorded rate, e.g. 10 replays the msgs 10 times faster than recorded.
+ * A speed of 0 (or less) publishes the msgs as fast as possible.
+ */
+#define PUBSUB_REPLAYER_SPEED_KEY               "PUBSUB_REPLAYER_SPEED"
+#define PUBSUB_REPLAYER_SPEED_DEFAULT           1.0
+
+/**
+ * Whether the replayer restarts at the begin of the capture file when all msgs are replayed.
+ */
+#define PUBSUB_REPLAYER_LOOP_KEY                "PUBSUB_REPLAYER_LOOP"
+#define PUBSUB_REPLAYER_LOOP_DEFAULT            false
+
+#endif /* PUBSUB_RECORDER_CONSTANTS_H_ */
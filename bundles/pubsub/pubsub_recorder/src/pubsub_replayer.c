@@ -0,0 +1,266 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *  KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+#include "celix_api.h"
+#include "pubsub/publisher.h"
+#include "pubsub_serializer.h"
+#include "pubsub_constants.h"
+
+#include "pubsub_capture_file.h"
+#include "pubsub_replayer.h"
+
+#define L_INFO(...) \
+    logHelper_log(replayer->logHelper, OSGI_LOGSERVICE_INFO, __VA_ARGS__)
+#define L_ERROR(...) \
+    logHelper_log(replayer->logHelper, OSGI_LOGSERVICE_ERROR, __VA_ARGS__)
+
+#define PUBSUB_REPLAYER_MAX_SLEEP_NS            (100 * 1000 * 1000L)
+
+struct pubsub_replayer {
+    celix_bundle_context_t *ctx;
+    log_helper_t *logHelper;
+    pubsub_capture_reader_t *reader;
+    double speed;
+    bool loop;
+
+    long publisherTrackerId;
+    long serializerTrackerId;
+    celix_thread_t thread;
+
+    celix_thread_mutex_t mutex; //protects below
+    celix_thread_cond_t cond;
+    bool running;
+    pubsub_publisher_t *publisher;
+    pubsub_serializer_service_t *serializer;
+    hash_map_t *msgSerializers; //key = msg type id, value = pubsub_msg_serializer_t*
+};
+
+static void pubsub_replayer_setPublisher(void *handle, void *svc);
+static void pubsub_replayer_setSerializer(void *handle, void *svc);
+static void* pubsub_replayer_run(void *data);
+
+pubsub_replayer_t* pubsub_replayer_create(celix_bundle_context_t *ctx, log_helper_t *logHelper, const char *path, const char *scope, const char *topic, double speed, bool loop) {
+    pubsub_replayer_t *replayer = calloc(1, sizeof(*replayer));
+    replayer->ctx = ctx;
+    replayer->logHelper = logHelper;
+    replayer->speed = speed;
+    replayer->loop = loop;
+    replayer->reader = pubsub_captureReader_open(path);
+    if (replayer->reader == NULL) {
+        L_ERROR("[PUBSUB_REPLAYER] Cannot open capture file %s", path);
+        free(replayer);
+        return NULL;
+    }
+    const pubsub_capture_file_header_t *header = pubsub_captureReader_header(replayer->reader);
+    if (topic == NULL) {
+        topic = header->topic;
+    }
+    if (scope == NULL && header->scope[0] != '\0') {
+        scope = header->scope;
+    }
+    celixThreadMutex_create(&replayer->mutex, NULL);
+    celixThreadCondition_init(&replayer->cond, NULL);
+    replayer->running = true;
+
+    char filter[256];
+    snprintf(filter, sizeof(filter), "(%s=%s)", PUBSUB_SERIALIZER_TYPE_KEY, header->serializer);
+    celix_service_tracking_options_t opts = CELIX_EMPTY_SERVICE_TRACKING_OPTIONS;
+    opts.filter.serviceName = PUBSUB_SERIALIZER_SERVICE_NAME;
+    opts.filter.filter = filter;
+    opts.filter.ignoreServiceLanguage = true;
+    opts.callbackHandle = replayer;
+    opts.set = pubsub_replayer_setSerializer;
+    replayer->serializerTrackerId = celix_bundleContext_trackServicesWithOptions(ctx, &opts);
+
+    if (scope != NULL) {
+        snprintf(filter, sizeof(filter), "(%s=%s)(%s=%s)", PUBSUB_PUBLISHER_TOPIC, topic, PUBSUB_PUBLISHER_SCOPE, scope);
+    } else {
+        snprintf(filter, sizeof(filter), "(%s=%s)", PUBSUB_PUBLISHER_TOPIC, topic);
+    }
+    opts.filter.serviceName = PUBSUB_PUBLISHER_SERVICE_NAME;
+    opts.set = pubsub_replayer_setPublisher;
+    replayer->publisherTrackerId = celix_bundleContext_trackServicesWithOptions(ctx, &opts);
+
+    L_INFO("[PUBSUB_REPLAYER] Replaying %s on topic %s/%s with speed %f", path, scope == NULL ? "(null)" : scope, topic, speed);
+    celixThread_create(&replayer->thread, NULL, pubsub_replayer_run, replayer);
+    celixThread_setName(&replayer->thread, "PubSubReplayer");
+    return replayer;
+}
+
+void pubsub_replayer_destroy(pubsub_replayer_t *replayer) {
+    if (replayer != NULL) {
+        celixThreadMutex_lock(&replayer->mutex);
+        replayer->running = false;
+        celixThreadCondition_broadcast(&replayer->cond);
+        celixThreadMutex_unlock(&replayer->mutex);
+        celixThread_join(replayer->thread, NULL);
+
+        celix_bundleContext_stopTracker(replayer->ctx, replayer->publisherTrackerId);
+        celix_bundleContext_stopTracker(replayer->ctx, replayer->serializerTrackerId);
+
+        pubsub_captureReader_close(replayer->reader);
+        celixThreadCondition_destroy(&replayer->cond);
+        celixThreadMutex_destroy(&replayer->mutex);
+        free(replayer);
+    }
+}
+
+static void pubsub_replayer_setPublisher(void *handle, void *svc) {
+    pubsub_replayer_t *replayer = handle;
+    celixThreadMutex_lock(&replayer->mutex);
+    replayer->publisher = svc;
+    celixThreadCondition_broadcast(&replayer->cond);
+    celixThreadMutex_unlock(&replayer->mutex);
+}
+
+static void pubsub_replayer_setSerializer(void *handle, void *svc) {
+    pubsub_replayer_t *replayer = handle;
+    celixThreadMutex_lock(&replayer->mutex);
+    if (replayer->msgSerializers != NULL) {
+        replayer->serializer->destroySerializerMap(replayer->serializer->handle, replayer->msgSerializers);
+        replayer->msgSerializers = NULL;
+    }
+    replayer->serializer = svc;
+    if (svc != NULL) {
+        celix_bundle_t *bnd = celix_bundleContext_getBundle(replayer->ctx);
+        replayer->serializer->createSerializerMap(replayer->serializer->handle, bnd, &replayer->msgSerializers);
+    }
+    celixThreadCondition_broadcast(&replayer->cond);
+    celixThreadMutex_unlock(&replayer->mutex);
+}
+
+static uint64_t pubsub_replayer_nanoseconds(const struct timespec *ts) {
+    return (uint64_t) ts->tv_sec * 1000000000UL + (uint64_t) ts->tv_nsec;
+}
+
+/**
+ * Waits until the due time (CLOCK_MONOTONIC, in ns). Returns false if the replayer is stopped.
+ */
+static bool pubsub_replayer_waitUntil(pubsub_replayer_t *replayer, uint64_t due) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    uint64_t nowNs = pubsub_replayer_nanoseconds(&now);
+    while (nowNs < due) {
+        uint64_t sleepNs = due - nowNs;
+        if (sleepNs > PUBSUB_REPLAYER_MAX_SLEEP_NS) {
+            sleepNs = PUBSUB_REPLAYER_MAX_SLEEP_NS;
+        }
+        struct timespec sleep = {0, (long) sleepNs};
+        nanosleep(&sleep, NULL);
+
+        celixThreadMutex_lock(&replayer->mutex);
+        bool running = replayer->running;
+        celixThreadMutex_unlock(&replayer->mutex);
+        if (!running) {
+            return false;
+        }
+        clock_gettime(CLOCK_MONOTONIC, &now);
+        nowNs = pubsub_replayer_nanoseconds(&now);
+    }
+    return true;
+}
+
+/**
+ * Waits until the publisher and msg serializers are available. Returns false if the replayer is stopped.
+ */
+static bool pubsub_replayer_waitUntilReady(pubsub_replayer_t *replayer) {
+    celixThreadMutex_lock(&replayer->mutex);
+    while (replayer->running && (replayer->publisher == NULL || replayer->msgSerializers == NULL)) {
+        celixThreadCondition_timedwaitRelative(&replayer->cond, &replayer->mutex, 1, 0);
+    }
+    bool running = replayer->running;
+    celixThreadMutex_unlock(&replayer->mutex);
+    return running;
+}
+
+/**
+ * Publishes a recorded msg. Returns false if the replayer is stopped.
+ */
+static bool pubsub_replayer_publish(pubsub_replayer_t *replayer, const pubsub_capture_record_header_t *header, const void *buffer, size_t *nrOfSkippedMsgs) {
+    celixThreadMutex_lock(&replayer->mutex);
+    pubsub_msg_serializer_t *msgSer = NULL;
+    if (replayer->publisher != NULL && replayer->msgSerializers != NULL) {
+        msgSer = hashMap_get(replayer->msgSerializers, (void *) (uintptr_t) header->type);
+    }
+    void *msg = NULL;
+    celix_status_t status = CELIX_ILLEGAL_STATE;
+    if (msgSer != NULL) {
+        int major = 0;
+        version_getMajor(msgSer->msgVersion, &major);
+        if (major == header->major) {
+            status = msgSer->deserialize(msgSer->handle, buffer, header->bufferSize, &msg);
+        }
+    }
+    if (status == CELIX_SUCCESS) {
+        unsigned int msgTypeId = 0;
+        replayer->publisher->localMsgTypeIdForMsgType(replayer->publisher->handle, msgSer->msgName, &msgTypeId);
+        replayer->publisher->send(replayer->publisher->handle, msgTypeId, msg);
+        msgSer->freeMsg(msgSer->handle, msg);
+    } else {
+        *nrOfSkippedMsgs += 1;
+    }
+    bool running = replayer->running;
+    celixThreadMutex_unlock(&replayer->mutex);
+    return running;
+}
+
+static void* pubsub_replayer_run(void *data) {
+    pubsub_replayer_t *replayer = data;
+    bool running = pubsub_replayer_waitUntilReady(replayer);
+    while (running) {
+        size_t nrOfMsgs = 0;
+        size_t nrOfSkippedMsgs = 0;
+        uint64_t firstRecordTime = 0;
+        struct timespec start;
+        clock_gettime(CLOCK_MONOTONIC, &start);
+        uint64_t startNs = pubsub_replayer_nanoseconds(&start);
+
+        const pubsub_capture_record_header_t *header = NULL;
+        const void *buffer = NULL;
+        pubsub_captureReader_rewind(replayer->reader);
+        while (running && pubsub_captureReader_next(replayer->reader, &header, &buffer)) {
+            uint64_t recordTime = header->timeSeconds * 1000000000UL + header->timeNanoseconds;
+            if (nrOfMsgs == 0) {
+                firstRecordTime = recordTime;
+            }
+            if (replayer->speed > 0 && recordTime > firstRecordTime) {
+                running = pubsub_replayer_waitUntil(replayer, startNs + (uint64_t) ((double) (recordTime - firstRecordTime) / replayer->speed));
+            }
+            if (running) {
+                running = pubsub_replayer_publish(replayer, header, buffer, &nrOfSkippedMsgs);
+                nrOfMsgs += 1;
+            }
+        }
+
+        struct timespec end;
+        clock_gettime(CLOCK_MONOTONIC, &end);
+        double elapsed = (double) (pubsub_replayer_nanoseconds(&end) - startNs) / 1000000000.0;
+        L_INFO("[PUBSUB_REPLAYER] Replayed %zu msgs in %f seconds, skipped %zu msgs", nrOfMsgs, elapsed, nrOfSkippedMsgs);
+
+        celixThreadMutex_lock(&replayer->mutex);
+        running = running && replayer->running && replayer->loop;
+        celixThreadMutex_unlock(&replayer->mutex);
+    }
+    return NULL;
+}
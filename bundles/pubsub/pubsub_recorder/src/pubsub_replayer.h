@@ -0,0 +1,39 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *  KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#ifndef PUBSUB_REPLAYER_H_
+#define PUBSUB_REPLAYER_H_
+
+#include <stdbool.h>
+
+#include "celix_api.h"
+#include "log_helper.h"
+
+typedef struct pubsub_replayer pubsub_replayer_t;
+
+/**
+ * Creates a replayer which publishes the msgs of the capture file on the scope/topic, with the recorded intervals
+ * divided by speed. If scope/topic are NULL the recorded scope/topic is used.
+ * The msg descriptors of the replayed topic must be part of the recorder bundle (META-INF/descriptors).
+ */
+pubsub_replayer_t* pubsub_replayer_create(celix_bundle_context_t *ctx, log_helper_t *logHelper, const char *path, const char *scope, const char *topic, double speed, bool loop);
+
+void pubsub_replayer_destroy(pubsub_replayer_t *replayer);
+
+#endif /* PUBSUB_REPLAYER_H_ */
@@ -24,16 +24,21 @@
 #include <unistd.h>
 #include <dirent.h>
 #include <inttypes.h>
+#include <pthread.h>
 
 #include "utils.h"
 #include "hash_map.h"
+#include "celix_hash_map.h"
 #include "bundle_context.h"
 
 #include "log_helper.h"
 
 #include "avrobin_serializer.h"
+#include "dyn_type_plan.h"
 
 #include "pubsub_avrobin_serializer_impl.h"
+#include "pubsub_serializer_cache.h"
+#include "celix_probes.h"
 
 #define SYSTEM_BUNDLE_ARCHIVE_PATH "CELIX_FRAMEWORK_EXTENDER_PATH"
 #define MAX_PATH_LEN 1024
@@ -47,13 +52,17 @@ typedef enum {
 struct pubsub_avrobin_serializer {
     celix_bundle_context_t *bundle_context;
     log_helper_t *loghelper;
+    pubsub_serializer_cache_t *cache; //msg serializers shared by the serializer maps of all bundles
 };
 
 static celix_status_t pubsubMsgAvrobinSerializer_serialize(void *handle, const void *msg, void **out, size_t *outLen);
 static celix_status_t pubsubMsgAvrobinSerializer_deserialize(void *handle, const void *input, size_t inputLen, void **out);
 static void pubsubMsgAvrobinSerializer_freeMsg(void *handle, void *msg);
+static celix_status_t pubsubMsgAvrobinSerializer_copyMsg(void *handle, const void *msg, void **out);
+static celix_status_t pubsubMsgAvrobinSerializer_deserializeVersion(void *handle, unsigned int writerMajor, unsigned int writerMinor, const void *input, size_t inputLen, void **out);
+static celix_status_t pubsubMsgAvrobinSerializer_msgToProperties(void *handle, const void *msg, celix_properties_t *props);
 
-static FILE* openFileStream(FILE_INPUT_TYPE file_input_type, const char* filename, const char* root, /*output*/ char* avpr_fqn, /*output*/ char* path);
+static FILE* openFileStream(FILE_INPUT_TYPE file_input_type, const char* filename, const char* root, /*output*/ char* avpr_fqn, /*output*/ char* path, /*output*/ const void** mapped, /*output*/ size_t* mappedLength);
 static FILE_INPUT_TYPE getFileInputType(const char* filename);
 static bool readPropertiesFile(const char* properties_file_name, const char* root, /*output*/ char* avpr_fqn, /*output*/ char* path);
 
@@ -62,11 +71,16 @@ typedef struct pubsub_avrobin_msg_serializer_impl {
     unsigned int msgId;
     const char *msgName;
     version_pt msgVersion;
+
+    pthread_mutex_t mutex; //protects resolvers
+    celix_long_hash_map_t *resolvers; //key = writer minor version, value = nr of values written by that version
 } pubsub_avrobin_msg_serializer_impl_t;
 
 static char *pubsubAvrobinSerializer_getMsgDescriptionDir(celix_bundle_t *bundle);
-static void pubsubAvrobinSerializer_addMsgSerializerFromBundle(const char *root, celix_bundle_t *bundle, hash_map_pt msgTypesMap);
-static void pubsubAvrobinSerializer_fillMsgSerializerMap(hash_map_pt msgTypesMap, celix_bundle_t *bundle);
+static void pubsubAvrobinSerializer_addMsgSerializerFromBundle(pubsub_avrobin_serializer_t *serializer, const char *root, celix_bundle_t *bundle, hash_map_pt msgTypesMap);
+static void pubsubAvrobinSerializer_fillMsgSerializerMap(pubsub_avrobin_serializer_t *serializer, hash_map_pt msgTypesMap, celix_bundle_t *bundle);
+static void pubsubAvrobinSerializer_destroyMsgSerializer(void *handle, pubsub_msg_serializer_t *msgSerializer);
+static void pubsubAvrobinSerializer_releaseMsgSerializer(pubsub_avrobin_serializer_t *serializer, pubsub_msg_serializer_t *msgSerializer);
 
 static int pubsubMsgAvrobinSerializer_convertDescriptor(FILE* file_ptr, pubsub_msg_serializer_t* serializer);
 static int pubsubMsgAvrobinSerializer_convertAvpr(FILE* file_ptr, pubsub_msg_serializer_t* serializer, const char* fqn);
@@ -92,6 +106,7 @@ celix_status_t pubsubAvrobinSerializer_create(celix_bundle_context_t *context, p
     } else {
 
         (*serializer)->bundle_context = context;
+        (*serializer)->cache = pubsub_serializerCache_create(*serializer, pubsubAvrobinSerializer_destroyMsgSerializer);
 
         if (logHelper_create(context, &(*serializer)->loghelper) == CELIX_SUCCESS) {
             logHelper_start((*serializer)->loghelper);
@@ -108,6 +123,8 @@ celix_status_t pubsubAvrobinSerializer_create(celix_bundle_context_t *context, p
 celix_status_t pubsubAvrobinSerializer_destroy(pubsub_avrobin_serializer_t *serializer) {
     celix_status_t status = CELIX_SUCCESS;
 
+    pubsub_serializerCache_destroy(serializer->cache);
+
     logHelper_stop(serializer->loghelper);
     logHelper_destroy(&serializer->loghelper);
 
@@ -123,7 +140,7 @@ celix_status_t pubsubAvrobinSerializer_createSerializerMap(void *handle, celix_b
     hash_map_pt map = hashMap_create(NULL, NULL, NULL, NULL);
 
     if (map != NULL) {
-        pubsubAvrobinSerializer_fillMsgSerializerMap(map, bundle);
+        pubsubAvrobinSerializer_fillMsgSerializerMap(serializer, map, bundle);
     } else {
         logHelper_log(serializer->loghelper, OSGI_LOGSERVICE_ERROR, "Cannot allocate memory for msg map");
         status = CELIX_ENOMEM;
@@ -138,6 +155,7 @@ celix_status_t pubsubAvrobinSerializer_createSerializerMap(void *handle, celix_b
 
 celix_status_t pubsubAvrobinSerializer_destroySerializerMap(void *handle, hash_map_pt serializerMap) {
     celix_status_t status = CELIX_SUCCESS;
+    pubsub_avrobin_serializer_t *serializer = handle;
 
     if (serializerMap == NULL) {
         return CELIX_ILLEGAL_ARGUMENT;
@@ -146,10 +164,7 @@ celix_status_t pubsubAvrobinSerializer_destroySerializerMap(void *handle, hash_m
     hash_map_iterator_t iter = hashMapIterator_construct(serializerMap);
     while (hashMapIterator_hasNext(&iter)) {
         pubsub_msg_serializer_t* msgSerializer = hashMapIterator_nextValue(&iter);
-        pubsub_avrobin_msg_serializer_impl_t *impl = msgSerializer->handle;
-        dynMessage_destroy(impl->msgType);
-        free(msgSerializer); //also contains the service struct.
-        free(impl);
+        pubsubAvrobinSerializer_releaseMsgSerializer(serializer, msgSerializer);
     }
 
     hashMap_destroy(serializerMap, false, false);
@@ -157,6 +172,20 @@ celix_status_t pubsubAvrobinSerializer_destroySerializerMap(void *handle, hash_m
     return status;
 }
 
+static void pubsubAvrobinSerializer_destroyMsgSerializer(void *handle __attribute__((unused)), pubsub_msg_serializer_t *msgSerializer) {
+    pubsub_avrobin_msg_serializer_impl_t *impl = msgSerializer->handle;
+    dynMessage_destroy(impl->msgType);
+    celix_longHashMap_destroy(impl->resolvers);
+    pthread_mutex_destroy(&impl->mutex);
+    free(msgSerializer); //also contains the service struct.
+    free(impl);
+}
+
+static void pubsubAvrobinSerializer_releaseMsgSerializer(pubsub_avrobin_serializer_t *serializer, pubsub_msg_serializer_t *msgSerializer) {
+    pubsub_avrobin_msg_serializer_impl_t *impl = msgSerializer->handle;
+    pubsub_serializerCache_release(serializer->cache, impl->msgType, msgSerializer);
+}
+
 static celix_status_t pubsubMsgAvrobinSerializer_serialize(void *handle, const void *msg, void **out, size_t *outLen) {
     celix_status_t status = CELIX_SUCCESS;
 
@@ -182,6 +211,7 @@ static celix_status_t pubsubMsgAvrobinSerializer_serialize(void *handle, const v
     if (status == CELIX_SUCCESS) {
         *out = (void*)avroData;
         *outLen = avroLen;
+        CELIX_PROBE3(serializer_serialize, PUBSUB_AVROBIN_SERIALIZER_TYPE, impl->msgId, *outLen);
     }
 
     return status;
@@ -200,6 +230,7 @@ static celix_status_t pubsubMsgAvrobinSerializer_deserialize(void *handle, const
         status = CELIX_BUNDLE_EXCEPTION;
     } else {
         *out = msg;
+        CELIX_PROBE3(serializer_deserialize, PUBSUB_AVROBIN_SERIALIZER_TYPE, impl->msgId, inputLen);
     }
 
     return status;
@@ -214,6 +245,69 @@ static void pubsubMsgAvrobinSerializer_freeMsg(void *handle, void *msg) {
     }
 }
 
+static celix_status_t pubsubMsgAvrobinSerializer_copyMsg(void *handle, const void *msg, void **out) {
+    celix_status_t status = CELIX_BUNDLE_EXCEPTION;
+    pubsub_avrobin_msg_serializer_impl_t *impl = handle;
+    if (impl->msgType != NULL) {
+        dyn_type *dynType = NULL;
+        dynMessage_getMessageType(impl->msgType, &dynType);
+        if (dynType_copy(dynType, msg, out) == 0) {
+            status = CELIX_SUCCESS;
+        }
+    }
+    return status;
+}
+
+static celix_status_t pubsubMsgAvrobinSerializer_msgToProperties(void *handle, const void *msg, celix_properties_t *props) {
+    celix_status_t status = CELIX_BUNDLE_EXCEPTION;
+    pubsub_avrobin_msg_serializer_impl_t *impl = handle;
+    if (impl->msgType != NULL) {
+        dyn_type *dynType = NULL;
+        dynMessage_getMessageType(impl->msgType, &dynType);
+        if (dynType_toProperties(dynType, msg, props) == 0) {
+            status = CELIX_SUCCESS;
+        }
+    }
+    return status;
+}
+
+static celix_status_t pubsubMsgAvrobinSerializer_deserializeVersion(void *handle, unsigned int writerMajor, unsigned int writerMinor, const void *input, size_t inputLen, void **out) {
+    pubsub_avrobin_msg_serializer_impl_t *impl = handle;
+
+    int major = 0;
+    int minor = 0;
+    version_getMajor(impl->msgVersion, &major);
+    version_getMinor(impl->msgVersion, &minor);
+    if (writerMajor != (unsigned int)major) {
+        return CELIX_ILLEGAL_ARGUMENT;
+    } else if (writerMinor >= (unsigned int)minor) {
+        //newer minor versions only append values, which are ignored by the reader
+        return pubsubMsgAvrobinSerializer_deserialize(handle, input, inputLen, out);
+    }
+
+    //older minor versions lack the appended values. The nr of values written by a writer version is resolved
+    //from the first msg of that version and cached, so that following msgs are checked against it.
+    pthread_mutex_lock(&impl->mutex);
+    size_t nrOfValues = (size_t)(uintptr_t)celix_longHashMap_get(impl->resolvers, (long)writerMinor);
+    pthread_mutex_unlock(&impl->mutex);
+    bool resolve = nrOfValues == 0;
+
+    dyn_type *dynType = NULL;
+    dynMessage_getMessageType(impl->msgType, &dynType);
+    void *msg = NULL;
+    if (avrobinSerializer_deserializeValues(dynType, (const uint8_t*)input, inputLen, &nrOfValues, &msg) != 0) {
+        return CELIX_BUNDLE_EXCEPTION;
+    }
+
+    if (resolve && nrOfValues > 0) {
+        pthread_mutex_lock(&impl->mutex);
+        celix_longHashMap_put(impl->resolvers, (long)writerMinor, (void*)(uintptr_t)nrOfValues);
+        pthread_mutex_unlock(&impl->mutex);
+    }
+    *out = msg;
+    return CELIX_SUCCESS;
+}
+
 static char *pubsubAvrobinSerializer_getMsgDescriptionDir(celix_bundle_t *bundle) {
     char *root = NULL;
 
@@ -240,12 +334,14 @@ static char *pubsubAvrobinSerializer_getMsgDescriptionDir(celix_bundle_t *bundle
     return root;
 }
 
-static void pubsubAvrobinSerializer_addMsgSerializerFromBundle(const char *root, celix_bundle_t *bundle, hash_map_pt msgTypesMap) {
+static void pubsubAvrobinSerializer_addMsgSerializerFromBundle(pubsub_avrobin_serializer_t *serializer, const char *root, celix_bundle_t *bundle, hash_map_pt msgTypesMap) {
     char fqn[MAX_PATH_LEN];
     char path[MAX_PATH_LEN];
     const char* entry_name = NULL;
     FILE_INPUT_TYPE fileInputType;
     FILE* stream = NULL;
+    const void* mapped = NULL;
+    size_t mappedLength = 0;
 
     const struct dirent *entry = NULL;
     DIR* dir = opendir(root);
@@ -257,7 +353,7 @@ static void pubsubAvrobinSerializer_addMsgSerializerFromBundle(const char *root,
         entry_name = entry->d_name;
         printf("DMU: Parsing entry '%s'\n", entry_name);
         fileInputType = getFileInputType(entry_name);
-        stream = openFileStream(fileInputType, entry_name, root, /*out*/fqn, /*out*/path);
+        stream = openFileStream(fileInputType, entry_name, root, /*out*/fqn, /*out*/path, &mapped, &mappedLength);
         if (!stream) {
             printf("DMU: Cannot open descriptor file: '%s'.\n", path);
             continue; // Go to next entry in directory
@@ -275,6 +371,7 @@ static void pubsubAvrobinSerializer_addMsgSerializerFromBundle(const char *root,
             translation_result = pubsubMsgAvrobinSerializer_convertAvpr(stream, msgSerializer, fqn);
         }
         fclose(stream);
+        utils_unmapFile(mapped, mappedLength);
 
         if (translation_result != 0) {
             printf("DMU: could not create serializer for '%s'\n", entry_name);
@@ -283,17 +380,25 @@ static void pubsubAvrobinSerializer_addMsgSerializerFromBundle(const char *root,
             continue;
         }
 
-        // serializer has been constructed, try to put in the map
+        // serializer has been constructed, share it with the maps of other bundles (the parsed msg type is shared
+        // per descriptor, so an equal msg type means an equal msg serializer)
+        pubsub_msg_serializer_t *shared = pubsub_serializerCache_acquire(serializer->cache, impl->msgType);
+        if (shared == NULL) {
+            shared = pubsub_serializerCache_add(serializer->cache, impl->msgType, msgSerializer);
+        }
+        if (shared != msgSerializer) {
+            pubsubAvrobinSerializer_destroyMsgSerializer(serializer, msgSerializer);
+            msgSerializer = shared;
+        }
+
+        // try to put in the map
         if (hashMap_containsKey(msgTypesMap, (void *) (uintptr_t) msgSerializer->msgId)) {
-            printf("Cannot add msg %s. clash in msg id %d!!\n", msgSerializer->msgName, msgSerializer->msgId);
-            dynMessage_destroy(impl->msgType);
-            free(msgSerializer);
-            free(impl);
+            pubsub_msg_serializer_t *clash = hashMap_get(msgTypesMap, (void *) (uintptr_t) msgSerializer->msgId);
+            printf("Cannot add msg %s. clash in msg id %u of msg %s!!\n", msgSerializer->msgName, msgSerializer->msgId, clash->msgName);
+            pubsubAvrobinSerializer_releaseMsgSerializer(serializer, msgSerializer);
         } else if (msgSerializer->msgId == 0) {
             printf("Cannot add msg %s. clash in msg id %d!!\n", msgSerializer->msgName, msgSerializer->msgId);
-            dynMessage_destroy(impl->msgType);
-            free(msgSerializer);
-            free(impl);
+            pubsubAvrobinSerializer_releaseMsgSerializer(serializer, msgSerializer);
         }
         else {
             hashMap_put(msgTypesMap, (void *) (uintptr_t) msgSerializer->msgId, msgSerializer);
@@ -305,7 +410,7 @@ static void pubsubAvrobinSerializer_addMsgSerializerFromBundle(const char *root,
     }
 }
 
-static void pubsubAvrobinSerializer_fillMsgSerializerMap(hash_map_pt msgTypesMap, celix_bundle_t *bundle) {
+static void pubsubAvrobinSerializer_fillMsgSerializerMap(pubsub_avrobin_serializer_t *serializer, hash_map_pt msgTypesMap, celix_bundle_t *bundle) {
     char *root = NULL;
     char *metaInfPath = NULL;
 
@@ -314,17 +419,38 @@ static void pubsubAvrobinSerializer_fillMsgSerializerMap(hash_map_pt msgTypesMap
     if (root != NULL) {
         asprintf(&metaInfPath, "%s/META-INF/descriptors", root);
 
-        pubsubAvrobinSerializer_addMsgSerializerFromBundle(root, bundle, msgTypesMap);
-        pubsubAvrobinSerializer_addMsgSerializerFromBundle(metaInfPath, bundle, msgTypesMap);
+        pubsubAvrobinSerializer_addMsgSerializerFromBundle(serializer, root, bundle, msgTypesMap);
+        pubsubAvrobinSerializer_addMsgSerializerFromBundle(serializer, metaInfPath, bundle, msgTypesMap);
 
         free(metaInfPath);
         free(root);
     }
 }
 
-static FILE* openFileStream(FILE_INPUT_TYPE file_input_type, const char* filename, const char* root, /*output*/ char* avpr_fqn, /*output*/ char* path) {
+/**
+ * Opens a descriptor as stream on a read-only mapping of the file, so the descriptor is parsed from the page cache
+ * instead of copied in a stdio buffer. Falls back to fopen if the file cannot be mapped (e.g. an empty file).
+ * The mapping must be released with utils_unmapFile after the stream is closed.
+ */
+static FILE* openMappedStream(const char* path, const void** mapped, size_t* mappedLength) {
+    FILE* result = NULL;
+    if (utils_mapFile(path, mapped, mappedLength) == CELIX_SUCCESS && *mappedLength > 0) {
+        result = fmemopen((void*)*mapped, *mappedLength, "r");
+    }
+    if (result == NULL) {
+        utils_unmapFile(*mapped, *mappedLength);
+        *mapped = NULL;
+        *mappedLength = 0;
+        result = fopen(path, "r");
+    }
+    return result;
+}
+
+static FILE* openFileStream(FILE_INPUT_TYPE file_input_type, const char* filename, const char* root, /*output*/ char* avpr_fqn, /*output*/ char* path, const void** mapped, size_t* mappedLength) {
     FILE* result = NULL;
     memset(path, 0, MAX_PATH_LEN);
+    *mapped = NULL;
+    *mappedLength = 0;
     switch (file_input_type) {
         case FIT_INVALID:
             snprintf(path, MAX_PATH_LEN, "Because %s is not a valid file", filename);
@@ -332,12 +458,12 @@ static FILE* openFileStream(FILE_INPUT_TYPE file_input_type, const char* filenam
 
         case FIT_DESCRIPTOR:
             snprintf(path, MAX_PATH_LEN, "%s/%s", root, filename);
-            result = fopen(path, "r");
+            result = openMappedStream(path, mapped, mappedLength);
             break;
 
         case FIT_AVPR:
             if (readPropertiesFile(filename, root, avpr_fqn, path)) {
-                result = fopen(path, "r");
+                result = openMappedStream(path, mapped, mappedLength);
             }
             break;
 
@@ -401,7 +527,7 @@ static bool readPropertiesFile(const char* properties_file_name, const char* roo
 
 static int pubsubMsgAvrobinSerializer_convertDescriptor(FILE* file_ptr, pubsub_msg_serializer_t* serializer) {
     dyn_message_type* msgType = NULL;
-    int rc = dynMessage_parse(file_ptr, &msgType);
+    int rc = dynMessage_parseShared(file_ptr, &msgType);
     if (rc != 0 || msgType == NULL) {
         printf("DMU: cannot parse message from descriptor.\n");
         return -1;
@@ -441,6 +567,8 @@ static int pubsubMsgAvrobinSerializer_convertDescriptor(FILE* file_ptr, pubsub_m
     handle->msgId = msgId;
     handle->msgName = msgName;
     handle->msgVersion = msgVersion;
+    pthread_mutex_init(&handle->mutex, NULL);
+    handle->resolvers = celix_longHashMap_create();
 
     serializer->msgId = handle->msgId;
     serializer->msgName = handle->msgName;
@@ -449,13 +577,17 @@ static int pubsubMsgAvrobinSerializer_convertDescriptor(FILE* file_ptr, pubsub_m
     serializer->serialize = (void*) pubsubMsgAvrobinSerializer_serialize;
     serializer->deserialize = (void*) pubsubMsgAvrobinSerializer_deserialize;
     serializer->freeMsg = (void*) pubsubMsgAvrobinSerializer_freeMsg;
+    serializer->copyMsg = (void*) pubsubMsgAvrobinSerializer_copyMsg;
+    serializer->podSize = dynType_isPod(type) ? dynType_size(type) : 0;
+    serializer->deserializeVersion = (void*) pubsubMsgAvrobinSerializer_deserializeVersion;
+    serializer->msgToProperties = (void*) pubsubMsgAvrobinSerializer_msgToProperties;
 
     return 0;
 }
 
 static int pubsubMsgAvrobinSerializer_convertAvpr(FILE* file_ptr, pubsub_msg_serializer_t* serializer, const char* fqn) {
     if (!file_ptr || !fqn || !serializer) return -2;
-    dyn_message_type* msgType = dynMessage_parseAvpr(file_ptr, fqn);
+    dyn_message_type* msgType = dynMessage_parseAvprShared(file_ptr, fqn);
 
     if (!msgType) {
         printf("DMU: cannot parse avpr file for '%s'\n", fqn);
@@ -497,6 +629,8 @@ static int pubsubMsgAvrobinSerializer_convertAvpr(FILE* file_ptr, pubsub_msg_ser
     handle->msgId = msgId;
     handle->msgName = msgName;
     handle->msgVersion = msgVersion;
+    pthread_mutex_init(&handle->mutex, NULL);
+    handle->resolvers = celix_longHashMap_create();
 
     serializer->msgId = handle->msgId;
     serializer->msgName = handle->msgName;
@@ -505,6 +639,10 @@ static int pubsubMsgAvrobinSerializer_convertAvpr(FILE* file_ptr, pubsub_msg_ser
     serializer->serialize = (void*) pubsubMsgAvrobinSerializer_serialize;
     serializer->deserialize = (void*) pubsubMsgAvrobinSerializer_deserialize;
     serializer->freeMsg = (void*) pubsubMsgAvrobinSerializer_freeMsg;
+    serializer->copyMsg = (void*) pubsubMsgAvrobinSerializer_copyMsg;
+    serializer->podSize = dynType_isPod(type) ? dynType_size(type) : 0;
+    serializer->deserializeVersion = (void*) pubsubMsgAvrobinSerializer_deserializeVersion;
+    serializer->msgToProperties = (void*) pubsubMsgAvrobinSerializer_msgToProperties;
 
     return 0;
 }
@@ -0,0 +1,672 @@
+/**
+ *Licensed to the Apache Software Foundation (ASF) under one
+ *or more contributor license agreements.  See the NOTICE file
+ *distributed with this work for additional information
+ *regarding copyright ownership.  The ASF licenses this file
+ *to you under the Apache License, Version 2.0 (the
+ *"License"); you may not use this file except in compliance
+ *with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *Unless required by applicable law or agreed to in writing,
+ *software distributed under the License is distributed on an
+ *"AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ *specific language governing permissions and limitations
+ *under the License.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdarg.h>
+#include <string.h>
+#include <unistd.h>
+#include <dirent.h>
+#include <inttypes.h>
+#include <byteswap.h>
+
+#include "utils.h"
+#include "hash_map.h"
+#include "bundle_context.h"
+
+#include "log_helper.h"
+
+#include "dfi_codec.h"
+#include "dyn_type_plan.h"
+
+#include "pubsub_flat_serializer_impl.h"
+#include "pubsub_serializer_cache.h"
+#include "celix_probes.h"
+
+#define SYSTEM_BUNDLE_ARCHIVE_PATH "CELIX_FRAMEWORK_EXTENDER_PATH"
+#define MAX_PATH_LEN 1024
+
+typedef enum {
+    FIT_INVALID = 0,
+    FIT_DESCRIPTOR = 1,
+    FIT_AVPR = 2
+} FILE_INPUT_TYPE;
+
+struct pubsub_flat_serializer {
+    celix_bundle_context_t *bundle_context;
+    log_helper_t *loghelper;
+    pubsub_serializer_cache_t *cache; //msg serializers shared by the serializer maps of all bundles
+};
+
+static celix_status_t pubsubMsgFlatSerializer_serialize(void *handle, const void *msg, void **out, size_t *outLen);
+static celix_status_t pubsubMsgFlatSerializer_deserialize(void *handle, const void *input, size_t inputLen, void **out);
+static void pubsubMsgFlatSerializer_freeMsg(void *handle, void *msg);
+static celix_status_t pubsubMsgFlatSerializer_copyMsg(void *handle, const void *msg, void **out);
+static celix_status_t pubsubMsgFlatSerializer_msgToProperties(void *handle, const void *msg, celix_properties_t *props);
+static celix_status_t pubsubMsgFlatSerializer_serializeVec(void *handle, const void *msg, struct iovec *out, size_t *n, void **owned);
+
+static FILE* openFileStream(FILE_INPUT_TYPE file_input_type, const char* filename, const char* root, /*output*/ char* avpr_fqn, /*output*/ char* path, /*output*/ const void** mapped, /*output*/ size_t* mappedLength);
+static FILE_INPUT_TYPE getFileInputType(const char* filename);
+static bool readPropertiesFile(const char* properties_file_name, const char* root, /*output*/ char* avpr_fqn, /*output*/ char* path);
+
+typedef struct pubsub_flat_msg_serializer_impl {
+    dyn_message_type *msgType;
+    unsigned int msgId;
+    const char *msgName;
+    version_pt msgVersion;
+
+    size_t msgSize;
+    uint32_t schemaHash;
+    pubsub_flat_msg_header_t header; //the (constant) header of every serialized msg, used by serializeVec
+} pubsub_flat_msg_serializer_impl_t;
+
+static char *pubsubFlatSerializer_getMsgDescriptionDir(celix_bundle_t *bundle);
+static void pubsubFlatSerializer_addMsgSerializerFromBundle(pubsub_flat_serializer_t *serializer, const char *root, celix_bundle_t *bundle, hash_map_pt msgTypesMap);
+static void pubsubFlatSerializer_fillMsgSerializerMap(pubsub_flat_serializer_t *serializer, hash_map_pt msgTypesMap, celix_bundle_t *bundle);
+static void pubsubFlatSerializer_destroyMsgSerializer(void *handle, pubsub_msg_serializer_t *msgSerializer);
+static void pubsubFlatSerializer_releaseMsgSerializer(pubsub_flat_serializer_t *serializer, pubsub_msg_serializer_t *msgSerializer);
+
+static int pubsubMsgFlatSerializer_convertDescriptor(FILE* file_ptr, pubsub_msg_serializer_t* serializer);
+static int pubsubMsgFlatSerializer_convertAvpr(FILE* file_ptr, pubsub_msg_serializer_t* serializer, const char* fqn);
+static int pubsubMsgFlatSerializer_setup(pubsub_msg_serializer_t* serializer, dyn_message_type *msgType, const char *msgName, version_pt msgVersion, unsigned int msgId);
+
+static void dfi_log(void *handle, int level, const char *file, int line, const char *msg, ...) {
+    va_list ap;
+    pubsub_flat_serializer_t *serializer = handle;
+    char *logStr = NULL;
+    va_start(ap, msg);
+    vasprintf(&logStr, msg, ap);
+    va_end(ap);
+    logHelper_log(serializer->loghelper, level, "FILE:%s, LINE:%i, MSG:%s", file, line, logStr);
+    free(logStr);
+}
+
+celix_status_t pubsubFlatSerializer_create(celix_bundle_context_t *context, pubsub_flat_serializer_t **serializer) {
+    celix_status_t status = CELIX_SUCCESS;
+
+    *serializer = calloc(1, sizeof(**serializer));
+
+    if (*serializer == NULL) {
+        status = CELIX_ENOMEM;
+    } else {
+
+        (*serializer)->bundle_context = context;
+        (*serializer)->cache = pubsub_serializerCache_create(*serializer, pubsubFlatSerializer_destroyMsgSerializer);
+
+        if (logHelper_create(context, &(*serializer)->loghelper) == CELIX_SUCCESS) {
+            logHelper_start((*serializer)->loghelper);
+            dynType_logSetup(dfi_log, (*serializer), 1);
+            dynCommon_logSetup(dfi_log, (*serializer), 1);
+            dfiCodec_logSetup(dfi_log, (*serializer), 1);
+        }
+    }
+
+    return status;
+}
+
+celix_status_t pubsubFlatSerializer_destroy(pubsub_flat_serializer_t *serializer) {
+    celix_status_t status = CELIX_SUCCESS;
+
+    pubsub_serializerCache_destroy(serializer->cache);
+
+    logHelper_stop(serializer->loghelper);
+    logHelper_destroy(&serializer->loghelper);
+
+    free(serializer);
+
+    return status;
+}
+
+celix_status_t pubsubFlatSerializer_createSerializerMap(void *handle, celix_bundle_t *bundle, hash_map_pt *serializerMap) {
+    celix_status_t status = CELIX_SUCCESS;
+    pubsub_flat_serializer_t *serializer = handle;
+
+    hash_map_pt map = hashMap_create(NULL, NULL, NULL, NULL);
+
+    if (map != NULL) {
+        pubsubFlatSerializer_fillMsgSerializerMap(serializer, map, bundle);
+    } else {
+        logHelper_log(serializer->loghelper, OSGI_LOGSERVICE_ERROR, "Cannot allocate memory for msg map");
+        status = CELIX_ENOMEM;
+    }
+
+    if (status == CELIX_SUCCESS) {
+        *serializerMap = map;
+    }
+
+    return status;
+}
+
+celix_status_t pubsubFlatSerializer_destroySerializerMap(void *handle, hash_map_pt serializerMap) {
+    celix_status_t status = CELIX_SUCCESS;
+    pubsub_flat_serializer_t *serializer = handle;
+
+    if (serializerMap == NULL) {
+        return CELIX_ILLEGAL_ARGUMENT;
+    }
+
+    hash_map_iterator_t iter = hashMapIterator_construct(serializerMap);
+    while (hashMapIterator_hasNext(&iter)) {
+        pubsub_msg_serializer_t* msgSerializer = hashMapIterator_nextValue(&iter);
+        pubsubFlatSerializer_releaseMsgSerializer(serializer, msgSerializer);
+    }
+
+    hashMap_destroy(serializerMap, false, false);
+
+    return status;
+}
+
+static void pubsubFlatSerializer_destroyMsgSerializer(void *handle __attribute__((unused)), pubsub_msg_serializer_t *msgSerializer) {
+    pubsub_flat_msg_serializer_impl_t *impl = msgSerializer->handle;
+    dynMessage_destroy(impl->msgType);
+    free(msgSerializer); //also contains the service struct.
+    free(impl);
+}
+
+static void pubsubFlatSerializer_releaseMsgSerializer(pubsub_flat_serializer_t *serializer, pubsub_msg_serializer_t *msgSerializer) {
+    pubsub_flat_msg_serializer_impl_t *impl = msgSerializer->handle;
+    pubsub_serializerCache_release(serializer->cache, impl->msgType, msgSerializer);
+}
+
+static int pubsubFlatSerializer_writeLayout(FILE *stream, dyn_type *type) {
+    int rc = 0;
+    fprintf(stream, "(%zu", dynType_size(type));
+    if (dynType_type(type) == DYN_TYPE_COMPLEX) {
+        void *inst = calloc(1, dynType_size(type));
+        size_t count = dynType_complex_nrOfEntries(type);
+        for (int i = 0; inst != NULL && rc == 0 && i < (int)count; ++i) {
+            void *loc = NULL;
+            dyn_type *subType = NULL;
+            rc = dynType_complex_valLocAt(type, i, inst, &loc);
+            if (rc == 0) {
+                rc = dynType_complex_dynTypeAt(type, i, &subType);
+            }
+            if (rc == 0) {
+                fprintf(stream, " %td", (char*)loc - (char*)inst);
+                rc = pubsubFlatSerializer_writeLayout(stream, subType);
+            }
+        }
+        rc = inst == NULL ? 1 : rc;
+        free(inst);
+    }
+    fputc(')', stream);
+    return rc;
+}
+
+celix_status_t pubsubFlatSerializer_schemaHash(dyn_type *type, uint32_t *hash) {
+    char *signature = NULL;
+    char *text = NULL;
+    size_t textLen = 0;
+    int rc = dfiCodec_typeSignature(type, &signature);
+    FILE *stream = rc == 0 ? open_memstream(&text, &textLen) : NULL;
+    if (stream != NULL) {
+        fputs(signature, stream);
+        rc = pubsubFlatSerializer_writeLayout(stream, type);
+        fclose(stream);
+        *hash = rc == 0 ? utils_hashBytes(text, textLen) : 0;
+    } else {
+        rc = 1;
+    }
+    free(signature);
+    free(text);
+    return rc == 0 ? CELIX_SUCCESS : CELIX_BUNDLE_EXCEPTION;
+}
+
+static celix_status_t pubsubMsgFlatSerializer_serialize(void *handle, const void *msg, void **out, size_t *outLen) {
+    pubsub_flat_msg_serializer_impl_t *impl = handle;
+
+    size_t len = sizeof(pubsub_flat_msg_header_t) + impl->msgSize;
+    pubsub_flat_msg_header_t *header = malloc(len);
+    if (header == NULL) {
+        return CELIX_ENOMEM;
+    }
+    header->magic = PUBSUB_FLAT_MAGIC;
+    header->schemaHash = impl->schemaHash;
+    header->size = (uint32_t)impl->msgSize;
+    header->reserved = 0;
+    memcpy(header + 1, msg, impl->msgSize);
+
+    *out = header;
+    *outLen = len;
+    CELIX_PROBE3(serializer_serialize, PUBSUB_FLAT_SERIALIZER_TYPE, impl->msgId, *outLen);
+    return CELIX_SUCCESS;
+}
+
+static celix_status_t pubsubMsgFlatSerializer_serializeVec(void *handle, const void *msg, struct iovec *out, size_t *n, void **owned) {
+    pubsub_flat_msg_serializer_impl_t *impl = handle;
+    *owned = NULL;
+    if (*n < 2) {
+        *n = 2;
+        return CELIX_ILLEGAL_ARGUMENT;
+    }
+    //note no copy, the header is shared and the msg itself is the payload
+    out[0].iov_base = &impl->header;
+    out[0].iov_len = sizeof(impl->header);
+    out[1].iov_base = (void*)msg;
+    out[1].iov_len = impl->msgSize;
+    *n = 2;
+    CELIX_PROBE3(serializer_serialize, PUBSUB_FLAT_SERIALIZER_TYPE, impl->msgId, sizeof(impl->header) + impl->msgSize);
+    return CELIX_SUCCESS;
+}
+
+static celix_status_t pubsubMsgFlatSerializer_deserialize(void *handle, const void *input, size_t inputLen, void **out) {
+    pubsub_flat_msg_serializer_impl_t *impl = handle;
+
+    pubsub_flat_msg_header_t header;
+    if (inputLen != sizeof(header) + impl->msgSize) {
+        printf("Flat serializer: invalid input size %zu for msg %s, expected %zu\n", inputLen, impl->msgName, sizeof(header) + impl->msgSize);
+        return CELIX_ILLEGAL_ARGUMENT;
+    }
+    memcpy(&header, input, sizeof(header)); //input is not guaranteed to be aligned
+    if (header.magic == bswap_32(PUBSUB_FLAT_MAGIC)) {
+        printf("Flat serializer: msg %s written with a different byte order\n", impl->msgName);
+        return CELIX_ILLEGAL_ARGUMENT;
+    } else if (header.magic != PUBSUB_FLAT_MAGIC) {
+        printf("Flat serializer: invalid magic for msg %s\n", impl->msgName);
+        return CELIX_ILLEGAL_ARGUMENT;
+    } else if (header.schemaHash != impl->schemaHash || header.size != impl->msgSize) {
+        printf("Flat serializer: layout of msg %s does not match (different descriptor, alignment or type sizes)\n", impl->msgName);
+        return CELIX_ILLEGAL_ARGUMENT;
+    }
+
+    //note a single copy instead of returning a pointer into the input: receivers can keep (take ownership of) the
+    //msg after the input buffer is reused.
+    void *msg = malloc(impl->msgSize > 0 ? impl->msgSize : 1);
+    if (msg == NULL) {
+        return CELIX_ENOMEM;
+    }
+    memcpy(msg, (const char*)input + sizeof(header), impl->msgSize);
+    *out = msg;
+    CELIX_PROBE3(serializer_deserialize, PUBSUB_FLAT_SERIALIZER_TYPE, impl->msgId, inputLen);
+    return CELIX_SUCCESS;
+}
+
+static void pubsubMsgFlatSerializer_freeMsg(void *handle __attribute__((unused)), void *msg) {
+    free(msg);
+}
+
+static celix_status_t pubsubMsgFlatSerializer_copyMsg(void *handle, const void *msg, void **out) {
+    pubsub_flat_msg_serializer_impl_t *impl = handle;
+    void *copy = malloc(impl->msgSize > 0 ? impl->msgSize : 1);
+    if (copy == NULL) {
+        return CELIX_ENOMEM;
+    }
+    memcpy(copy, msg, impl->msgSize);
+    *out = copy;
+    return CELIX_SUCCESS;
+}
+
+static celix_status_t pubsubMsgFlatSerializer_msgToProperties(void *handle, const void *msg, celix_properties_t *props) {
+    celix_status_t status = CELIX_BUNDLE_EXCEPTION;
+    pubsub_flat_msg_serializer_impl_t *impl = handle;
+    dyn_type *dynType = NULL;
+    dynMessage_getMessageType(impl->msgType, &dynType);
+    if (dynType_toProperties(dynType, msg, props) == 0) {
+        status = CELIX_SUCCESS;
+    }
+    return status;
+}
+
+static char *pubsubFlatSerializer_getMsgDescriptionDir(celix_bundle_t *bundle) {
+    char *root = NULL;
+
+    bool isSystemBundle = false;
+    bundle_isSystemBundle(bundle, &isSystemBundle);
+
+    if (isSystemBundle == true) {
+        celix_bundle_context_t *context;
+        bundle_getContext(bundle, &context);
+
+        const char *prop = NULL;
+
+        bundleContext_getProperty(context, SYSTEM_BUNDLE_ARCHIVE_PATH, &prop);
+
+        if (prop != NULL) {
+            root = strdup(prop);
+        } else {
+            root = getcwd(NULL, 0);
+        }
+    } else {
+        bundle_getEntry(bundle, ".", &root);
+    }
+
+    return root;
+}
+
+static void pubsubFlatSerializer_addMsgSerializerFromBundle(pubsub_flat_serializer_t *serializer, const char *root, celix_bundle_t *bundle, hash_map_pt msgTypesMap) {
+    char fqn[MAX_PATH_LEN];
+    char path[MAX_PATH_LEN];
+    const char* entry_name = NULL;
+    FILE_INPUT_TYPE fileInputType;
+    FILE* stream = NULL;
+    const void* mapped = NULL;
+    size_t mappedLength = 0;
+
+    const struct dirent *entry = NULL;
+    DIR* dir = opendir(root);
+    if (dir) {
+        entry = readdir(dir);
+    }
+
+    for (; entry != NULL; entry = readdir(dir)) {
+        entry_name = entry->d_name;
+        printf("DMU: Parsing entry '%s'\n", entry_name);
+        fileInputType = getFileInputType(entry_name);
+        stream = openFileStream(fileInputType, entry_name, root, /*out*/fqn, /*out*/path, &mapped, &mappedLength);
+        if (!stream) {
+            printf("DMU: Cannot open descriptor file: '%s'.\n", path);
+            continue; // Go to next entry in directory
+        }
+
+        pubsub_flat_msg_serializer_impl_t *impl = calloc(1, sizeof(*impl));
+        pubsub_msg_serializer_t *msgSerializer = calloc(1,sizeof(*msgSerializer));
+        msgSerializer->handle = impl;
+
+        int translation_result = -1;
+        if (fileInputType == FIT_DESCRIPTOR) {
+            translation_result = pubsubMsgFlatSerializer_convertDescriptor(stream, msgSerializer);
+        }
+        else if (fileInputType == FIT_AVPR) {
+            translation_result = pubsubMsgFlatSerializer_convertAvpr(stream, msgSerializer, fqn);
+        }
+        fclose(stream);
+        utils_unmapFile(mapped, mappedLength);
+
+        if (translation_result != 0) {
+            printf("DMU: could not create serializer for '%s'\n", entry_name);
+            free(impl);
+            free(msgSerializer);
+            continue;
+        }
+
+        // serializer has been constructed, share it with the maps of other bundles (the parsed msg type is shared
+        // per descriptor, so an equal msg type means an equal msg serializer)
+        pubsub_msg_serializer_t *shared = pubsub_serializerCache_acquire(serializer->cache, impl->msgType);
+        if (shared == NULL) {
+            shared = pubsub_serializerCache_add(serializer->cache, impl->msgType, msgSerializer);
+        }
+        if (shared != msgSerializer) {
+            pubsubFlatSerializer_destroyMsgSerializer(serializer, msgSerializer);
+            msgSerializer = shared;
+        }
+
+        // try to put in the map
+        if (hashMap_containsKey(msgTypesMap, (void *) (uintptr_t) msgSerializer->msgId)) {
+            pubsub_msg_serializer_t *clash = hashMap_get(msgTypesMap, (void *) (uintptr_t) msgSerializer->msgId);
+            printf("Cannot add msg %s. clash in msg id %u of msg %s!!\n", msgSerializer->msgName, msgSerializer->msgId, clash->msgName);
+            pubsubFlatSerializer_releaseMsgSerializer(serializer, msgSerializer);
+        } else if (msgSerializer->msgId == 0) {
+            printf("Cannot add msg %s. clash in msg id %d!!\n", msgSerializer->msgName, msgSerializer->msgId);
+            pubsubFlatSerializer_releaseMsgSerializer(serializer, msgSerializer);
+        }
+        else {
+            hashMap_put(msgTypesMap, (void *) (uintptr_t) msgSerializer->msgId, msgSerializer);
+        }
+    }
+
+    if (dir) {
+        closedir(dir);
+    }
+}
+
+static void pubsubFlatSerializer_fillMsgSerializerMap(pubsub_flat_serializer_t *serializer, hash_map_pt msgTypesMap, celix_bundle_t *bundle) {
+    char *root = NULL;
+    char *metaInfPath = NULL;
+
+    root = pubsubFlatSerializer_getMsgDescriptionDir(bundle);
+
+    if (root != NULL) {
+        asprintf(&metaInfPath, "%s/META-INF/descriptors", root);
+
+        pubsubFlatSerializer_addMsgSerializerFromBundle(serializer, root, bundle, msgTypesMap);
+        pubsubFlatSerializer_addMsgSerializerFromBundle(serializer, metaInfPath, bundle, msgTypesMap);
+
+        free(metaInfPath);
+        free(root);
+    }
+}
+
+/**
+ * Opens a descriptor as stream on a read-only mapping of the file, so the descriptor is parsed from the page cache
+ * instead of copied in a stdio buffer. Falls back to fopen if the file cannot be mapped (e.g. an empty file).
+ * The mapping must be released with utils_unmapFile after the stream is closed.
+ */
+static FILE* openMappedStream(const char* path, const void** mapped, size_t* mappedLength) {
+    FILE* result = NULL;
+    if (utils_mapFile(path, mapped, mappedLength) == CELIX_SUCCESS && *mappedLength > 0) {
+        result = fmemopen((void*)*mapped, *mappedLength, "r");
+    }
+    if (result == NULL) {
+        utils_unmapFile(*mapped, *mappedLength);
+        *mapped = NULL;
+        *mappedLength = 0;
+        result = fopen(path, "r");
+    }
+    return result;
+}
+
+static FILE* openFileStream(FILE_INPUT_TYPE file_input_type, const char* filename, const char* root, /*output*/ char* avpr_fqn, /*output*/ char* path, const void** mapped, size_t* mappedLength) {
+    FILE* result = NULL;
+    memset(path, 0, MAX_PATH_LEN);
+    *mapped = NULL;
+    *mappedLength = 0;
+    switch (file_input_type) {
+        case FIT_INVALID:
+            snprintf(path, MAX_PATH_LEN, "Because %s is not a valid file", filename);
+            break;
+
+        case FIT_DESCRIPTOR:
+            snprintf(path, MAX_PATH_LEN, "%s/%s", root, filename);
+            result = openMappedStream(path, mapped, mappedLength);
+            break;
+
+        case FIT_AVPR:
+            if (readPropertiesFile(filename, root, avpr_fqn, path)) {
+                result = openMappedStream(path, mapped, mappedLength);
+            }
+            break;
+
+        default:
+            printf("DMU: Unknown file input type, returning NULL!\n");
+            break;
+    }
+
+    return result;
+}
+
+static FILE_INPUT_TYPE getFileInputType(const char* filename) {
+    if (strstr(filename, ".descriptor")) {
+        return FIT_DESCRIPTOR;
+    }
+    else if (strstr(filename, ".properties")) {
+        return FIT_AVPR;
+    }
+    else {
+        return FIT_INVALID;
+    }
+}
+
+static bool readPropertiesFile(const char* properties_file_name, const char* root, /*output*/ char* avpr_fqn, /*output*/ char* path) {
+    snprintf(path, MAX_PATH_LEN, "%s/%s", root, properties_file_name); // use path to create path to properties file
+    FILE *properties = fopen(path, "r");
+    if (!properties) {
+        printf("DMU: Could not find or open %s as a properties file in %s\n", properties_file_name, root);
+        return false;
+    }
+
+    *avpr_fqn = '\0';
+    *path = '\0'; //re-use path to create path to avpr file
+    char *p_line = malloc(MAX_PATH_LEN);
+    size_t line_len = MAX_PATH_LEN;
+    while (getline(&p_line, &line_len, properties) >= 0) {
+        if (strncmp(p_line, "fqn=", strlen("fqn=")) == 0) {
+            snprintf(avpr_fqn, MAX_PATH_LEN, "%s", (p_line + strlen("fqn=")));
+            avpr_fqn[strcspn(avpr_fqn, "\n")] = 0;
+        }
+        else if (strncmp(p_line, "avpr=", strlen("avpr=")) == 0) {
+            snprintf(path, MAX_PATH_LEN, "%s/%s", root, (p_line + strlen("avpr=")));
+            path[strcspn(path, "\n")] = 0;
+        }
+    }
+    free(p_line);
+    fclose(properties);
+
+    if (*avpr_fqn == '\0') {
+        printf("CMU: File %s does not contain a fully qualified name for the parser\n", properties_file_name);
+        return false;
+    }
+
+    if (*path == '\0') {
+        printf("CMU: File %s does not contain a location for the avpr file\n", properties_file_name);
+        return false;
+    }
+
+    return true;
+}
+
+static int pubsubMsgFlatSerializer_convertDescriptor(FILE* file_ptr, pubsub_msg_serializer_t* serializer) {
+    dyn_message_type* msgType = NULL;
+    int rc = dynMessage_parseShared(file_ptr, &msgType);
+    if (rc != 0 || msgType == NULL) {
+        printf("DMU: cannot parse message from descriptor.\n");
+        return -1;
+    }
+
+    char* msgName = NULL;
+    rc += dynMessage_getName(msgType, &msgName);
+
+    version_pt msgVersion = NULL;
+    rc += dynMessage_getVersion(msgType, &msgVersion);
+
+    if (rc != 0 || msgName == NULL || msgVersion == NULL) {
+        printf("DMU: cannot retrieve name and/or version from msg\n");
+        dynMessage_destroy(msgType);
+        return -1;
+    }
+
+    unsigned int msgId = 0;
+
+    char *msgIdStr = NULL;
+    int rv = dynMessage_getAnnotationEntry(msgType, "msgId", &msgIdStr);
+    if (rv == CELIX_SUCCESS && msgIdStr != NULL) {
+        // custom msg id passed, use it
+        long customMsgId = strtol(msgIdStr, NULL, 10);
+        if (customMsgId > 0)
+            msgId = (unsigned int) customMsgId;
+    }
+
+    if (msgId == 0) {
+        msgId = utils_stringHash(msgName);
+    }
+
+    rc = pubsubMsgFlatSerializer_setup(serializer, msgType, msgName, msgVersion, msgId);
+    if (rc != 0) {
+        dynMessage_destroy(msgType);
+    }
+    return rc;
+}
+
+static int pubsubMsgFlatSerializer_convertAvpr(FILE* file_ptr, pubsub_msg_serializer_t* serializer, const char* fqn) {
+    if (!file_ptr || !fqn || !serializer) return -2;
+    dyn_message_type* msgType = dynMessage_parseAvprShared(file_ptr, fqn);
+
+    if (!msgType) {
+        printf("DMU: cannot parse avpr file for '%s'\n", fqn);
+        return -1;
+    }
+
+    dyn_type* type = NULL;
+    dynMessage_getMessageType(msgType, &type);
+
+    const char* msgName = dynType_getName(type);
+
+    version_pt msgVersion = NULL;
+    celix_status_t s = version_createVersionFromString(dynType_getMetaInfo(type, "version"), &msgVersion);
+
+    if (s != CELIX_SUCCESS || !msgName) {
+        printf("DMU: cannot retrieve name and/or version from msg\n");
+        if (s == CELIX_SUCCESS) {
+            version_destroy(msgVersion);
+        }
+        dynMessage_destroy(msgType);
+        return -1;
+    }
+
+    unsigned int msgId = 0;
+
+    const char *msgIdStr = dynType_getMetaInfo(type, "msgId");
+    if (msgIdStr != NULL) {
+        // custom msg id passed, use it
+        long customMsgId = strtol(msgIdStr, NULL, 10);
+        if (customMsgId > 0)
+            msgId = (unsigned int) customMsgId;
+    }
+
+    if (msgId == 0) {
+        msgId = utils_stringHash(msgName);
+    }
+
+    int rc = pubsubMsgFlatSerializer_setup(serializer, msgType, msgName, msgVersion, msgId);
+    if (rc != 0) {
+        dynMessage_destroy(msgType);
+    }
+    return rc;
+}
+
+/**
+ * Only plain old data msg types (no pointers, strings or sequences) can be sent flat.
+ */
+static int pubsubMsgFlatSerializer_setup(pubsub_msg_serializer_t* serializer, dyn_message_type *msgType, const char *msgName, version_pt msgVersion, unsigned int msgId) {
+    dyn_type *type = NULL;
+    dynMessage_getMessageType(msgType, &type);
+    if (!dynType_isPod(type)) {
+        printf("DMU: msg %s is not plain old data, skipping it for the flat serializer\n", msgName);
+        return -1;
+    }
+
+    pubsub_flat_msg_serializer_impl_t * handle = (pubsub_flat_msg_serializer_impl_t*) serializer->handle;
+    if (pubsubFlatSerializer_schemaHash(type, &handle->schemaHash) != CELIX_SUCCESS) {
+        printf("DMU: cannot create schema hash for msg %s\n", msgName);
+        return -1;
+    }
+    handle->msgType = msgType;
+    handle->msgId = msgId;
+    handle->msgName = msgName;
+    handle->msgVersion = msgVersion;
+    handle->msgSize = dynType_size(type);
+    handle->header.magic = PUBSUB_FLAT_MAGIC;
+    handle->header.schemaHash = handle->schemaHash;
+    handle->header.size = (uint32_t)handle->msgSize;
+    handle->header.reserved = 0;
+
+    serializer->msgId = handle->msgId;
+    serializer->msgName = handle->msgName;
+    serializer->msgVersion = handle->msgVersion;
+
+    serializer->serialize = (void*) pubsubMsgFlatSerializer_serialize;
+    serializer->deserialize = (void*) pubsubMsgFlatSerializer_deserialize;
+    serializer->freeMsg = (void*) pubsubMsgFlatSerializer_freeMsg;
+    serializer->copyMsg = (void*) pubsubMsgFlatSerializer_copyMsg;
+    serializer->podSize = handle->msgSize;
+    serializer->deserializeVersion = NULL; //the flat layout must match exactly, no version resolving
+    serializer->msgToProperties = (void*) pubsubMsgFlatSerializer_msgToProperties;
+    serializer->serializeVec = (void*) pubsubMsgFlatSerializer_serializeVec;
+
+    return 0;
+}
@@ -0,0 +1,62 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *  KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#ifndef PUBSUB_SERIALIZER_FLAT_H_
+#define PUBSUB_SERIALIZER_FLAT_H_
+
+#include <stdint.h>
+
+#include "dyn_common.h"
+#include "dyn_type.h"
+#include "dyn_message.h"
+#include "log_helper.h"
+
+#include "pubsub_serializer.h"
+
+#define PUBSUB_FLAT_SERIALIZER_TYPE "flat"
+
+#define PUBSUB_FLAT_MAGIC 0x43464c54u //"CFLT"
+
+/**
+ * Header of a flat serialized msg, followed by the raw bytes of the msg struct.
+ * The flat format is only valid between peers with the same byte order and the same struct layout (alignment and
+ * type sizes); the magic (written in the byte order of the publisher) and the schema hash are used to check this.
+ * Note the header size keeps the msg struct 16 byte aligned relative to the start of the serialized msg.
+ */
+typedef struct pubsub_flat_msg_header {
+    uint32_t magic;
+    uint32_t schemaHash; //hash of the signature and member offsets of the msg type
+    uint32_t size; //size of the msg struct
+    uint32_t reserved;
+} pubsub_flat_msg_header_t;
+
+typedef struct pubsub_flat_serializer pubsub_flat_serializer_t;
+
+celix_status_t pubsubFlatSerializer_create(celix_bundle_context_t *context, pubsub_flat_serializer_t **serializer);
+celix_status_t pubsubFlatSerializer_destroy(pubsub_flat_serializer_t *serializer);
+
+celix_status_t pubsubFlatSerializer_createSerializerMap(void *handle, celix_bundle_t *bundle, hash_map_pt *serializerMap);
+celix_status_t pubsubFlatSerializer_destroySerializerMap(void *handle, hash_map_pt serializerMap);
+
+/**
+ * Computes the schema hash of a plain old data msg type.
+ */
+celix_status_t pubsubFlatSerializer_schemaHash(dyn_type *type, uint32_t *hash);
+
+#endif /* PUBSUB_SERIALIZER_FLAT_H_ */
@@ -31,8 +31,11 @@
 #include "log_helper.h"
 
 #include "json_serializer.h"
+#include "dyn_type_plan.h"
 
 #include "pubsub_serializer_impl.h"
+#include "pubsub_serializer_cache.h"
+#include "celix_probes.h"
 
 #define SYSTEM_BUNDLE_ARCHIVE_PATH  "CELIX_FRAMEWORK_EXTENDER_PATH"
 #define MAX_PATH_LEN    1024
@@ -48,6 +51,7 @@ FILE_INPUT_TYPE;
 struct pubsub_json_serializer {
     celix_bundle_context_t *bundle_context;
     log_helper_t *log;
+    pubsub_serializer_cache_t *cache; //msg serializers shared by the serializer maps of all bundles
 };
 
 #define L_DEBUG(...) \
@@ -65,7 +69,9 @@ struct pubsub_json_serializer {
 static celix_status_t pubsubMsgSerializer_serialize(void* handle, const void* msg, void** out, size_t *outLen);
 static celix_status_t pubsubMsgSerializer_deserialize(void* handle, const void* input, size_t inputLen, void **out);
 static void pubsubMsgSerializer_freeMsg(void* handle, void *msg);
-static FILE* openFileStream(pubsub_json_serializer_t* serializer, FILE_INPUT_TYPE file_input_type, const char* filename, const char* root, /*output*/ char* avpr_fqn, /*output*/ char* path);
+static celix_status_t pubsubMsgSerializer_copyMsg(void *handle, const void *msg, void **out);
+static celix_status_t pubsubMsgSerializer_msgToProperties(void *handle, const void *msg, celix_properties_t *props);
+static FILE* openFileStream(pubsub_json_serializer_t* serializer, FILE_INPUT_TYPE file_input_type, const char* filename, const char* root, /*output*/ char* avpr_fqn, /*output*/ char* path, /*output*/ const void** mapped, /*output*/ size_t* mappedLength);
 static FILE_INPUT_TYPE getFileInputType(const char* filename);
 static bool readPropertiesFile(pubsub_json_serializer_t* serializer, const char* properties_file_name, const char* root, /*output*/ char* avpr_fqn, /*output*/ char* path);
 
@@ -83,6 +89,8 @@ static void pubsubSerializer_fillMsgSerializerMap(pubsub_json_serializer_t* seri
 
 static int pubsubMsgSerializer_convertDescriptor(pubsub_json_serializer_t* serializer, FILE* file_ptr, pubsub_msg_serializer_t* msgSerializer);
 static int pubsubMsgSerializer_convertAvpr(pubsub_json_serializer_t *serializer, FILE* file_ptr, pubsub_msg_serializer_t* msgSerializer, const char* fqn);
+static void pubsubSerializer_destroyMsgSerializer(void *handle, pubsub_msg_serializer_t *msgSerializer);
+static void pubsubSerializer_releaseMsgSerializer(pubsub_json_serializer_t *serializer, pubsub_msg_serializer_t *msgSerializer);
 
 static void dfi_log(void *handle, int level, const char *file, int line, const char *msg, ...) {
     va_list ap;
@@ -106,6 +114,7 @@ celix_status_t pubsubSerializer_create(celix_bundle_context_t *context, pubsub_j
     else{
 
         (*serializer)->bundle_context= context;
+        (*serializer)->cache = pubsub_serializerCache_create(*serializer, pubsubSerializer_destroyMsgSerializer);
 
         if (logHelper_create(context, &(*serializer)->log) == CELIX_SUCCESS) {
             logHelper_start((*serializer)->log);
@@ -123,6 +132,8 @@ celix_status_t pubsubSerializer_create(celix_bundle_context_t *context, pubsub_j
 celix_status_t pubsubSerializer_destroy(pubsub_json_serializer_t* serializer) {
     celix_status_t status = CELIX_SUCCESS;
 
+    pubsub_serializerCache_destroy(serializer->cache);
+
     logHelper_stop(serializer->log);
     logHelper_destroy(&serializer->log);
 
@@ -140,9 +151,9 @@ celix_status_t pubsubSerializer_createSerializerMap(void *handle, celix_bundle_t
     return CELIX_SUCCESS;
 }
 
-celix_status_t pubsubSerializer_destroySerializerMap(void* handle __attribute__((unused)), hash_map_pt serializerMap) {
+celix_status_t pubsubSerializer_destroySerializerMap(void* handle, hash_map_pt serializerMap) {
     celix_status_t status = CELIX_SUCCESS;
-    //pubsub_json_serializer_t *serializer = handle;
+    pubsub_json_serializer_t *serializer = handle;
     if (serializerMap == NULL) {
         return CELIX_ILLEGAL_ARGUMENT;
     }
@@ -150,10 +161,7 @@ celix_status_t pubsubSerializer_destroySerializerMap(void* handle __attribute__(
     hash_map_iterator_t iter = hashMapIterator_construct(serializerMap);
     while (hashMapIterator_hasNext(&iter)) {
         pubsub_msg_serializer_t* msgSerializer = hashMapIterator_nextValue(&iter);
-        pubsub_json_msg_serializer_impl_t *impl = msgSerializer->handle;
-        dynMessage_destroy(impl->msgType);
-        free(msgSerializer); //also contains the service struct.
-        free(impl);
+        pubsubSerializer_releaseMsgSerializer(serializer, msgSerializer);
     }
 
     hashMap_destroy(serializerMap, false, false);
@@ -161,6 +169,17 @@ celix_status_t pubsubSerializer_destroySerializerMap(void* handle __attribute__(
     return status;
 }
 
+static void pubsubSerializer_destroyMsgSerializer(void *handle __attribute__((unused)), pubsub_msg_serializer_t *msgSerializer) {
+    pubsub_json_msg_serializer_impl_t *impl = msgSerializer->handle;
+    dynMessage_destroy(impl->msgType);
+    free(msgSerializer); //also contains the service struct.
+    free(impl);
+}
+
+static void pubsubSerializer_releaseMsgSerializer(pubsub_json_serializer_t *serializer, pubsub_msg_serializer_t *msgSerializer) {
+    pubsub_json_msg_serializer_impl_t *impl = msgSerializer->handle;
+    pubsub_serializerCache_release(serializer->cache, impl->msgType, msgSerializer);
+}
 
 celix_status_t pubsubMsgSerializer_serialize(void *handle, const void* msg, void** out, size_t *outLen) {
     celix_status_t status = CELIX_SUCCESS;
@@ -178,6 +197,7 @@ celix_status_t pubsubMsgSerializer_serialize(void *handle, const void* msg, void
     if (status == CELIX_SUCCESS) {
         *out = jsonOutput;
         *outLen = strlen(jsonOutput) + 1;
+        CELIX_PROBE3(serializer_serialize, PUBSUB_JSON_SERIALIZER_TYPE, impl->msgId, *outLen);
     }
 
     return status;
@@ -195,6 +215,7 @@ celix_status_t pubsubMsgSerializer_deserialize(void* handle, const void* input,
     }
     else{
         *out = msg;
+        CELIX_PROBE3(serializer_deserialize, PUBSUB_JSON_SERIALIZER_TYPE, impl->msgId, inputLen);
     }
 
     return status;
@@ -209,6 +230,32 @@ void pubsubMsgSerializer_freeMsg(void* handle, void *msg) {
     }
 }
 
+celix_status_t pubsubMsgSerializer_copyMsg(void *handle, const void *msg, void **out) {
+    celix_status_t status = CELIX_BUNDLE_EXCEPTION;
+    pubsub_json_msg_serializer_impl_t *impl = handle;
+    if (impl->msgType != NULL) {
+        dyn_type *dynType = NULL;
+        dynMessage_getMessageType(impl->msgType, &dynType);
+        if (dynType_copy(dynType, msg, out) == 0) {
+            status = CELIX_SUCCESS;
+        }
+    }
+    return status;
+}
+
+celix_status_t pubsubMsgSerializer_msgToProperties(void *handle, const void *msg, celix_properties_t *props) {
+    celix_status_t status = CELIX_BUNDLE_EXCEPTION;
+    pubsub_json_msg_serializer_impl_t *impl = handle;
+    if (impl->msgType != NULL) {
+        dyn_type *dynType = NULL;
+        dynMessage_getMessageType(impl->msgType, &dynType);
+        if (dynType_toProperties(dynType, msg, props) == 0) {
+            status = CELIX_SUCCESS;
+        }
+    }
+    return status;
+}
+
 
 static void pubsubSerializer_fillMsgSerializerMap(pubsub_json_serializer_t* serializer, hash_map_pt msgSerializers, celix_bundle_t *bundle) {
     char* root = NULL;
@@ -267,11 +314,13 @@ static void pubsubSerializer_addMsgSerializerFromBundle(pubsub_json_serializer_t
 
     for (; entry != NULL; entry = readdir(dir)) {
         FILE* stream = NULL;
+        const void* mapped = NULL;
+        size_t mappedLength = 0;
         entry_name = entry->d_name;
         fileInputType = getFileInputType(entry_name);
         if (fileInputType != FIT_INVALID) {
             L_DEBUG("[json serializer] Parsing entry '%s'\n", entry_name);
-            stream = openFileStream(serializer, fileInputType, entry_name, root, /*out*/fqn, /*out*/pathOrError);
+            stream = openFileStream(serializer, fileInputType, entry_name, root, /*out*/fqn, /*out*/pathOrError, &mapped, &mappedLength);
             if (!stream) {
                 L_WARN("[json serializer] Cannot open descriptor file: '%s'\n", pathOrError);
             }
@@ -293,6 +342,7 @@ static void pubsubSerializer_addMsgSerializerFromBundle(pubsub_json_serializer_t
             translation_result = pubsubMsgSerializer_convertAvpr(serializer, stream, msgSerializer, fqn);
         }
         fclose(stream);
+        utils_unmapFile(mapped, mappedLength);
 
         if (translation_result != 0) {
             L_WARN("[json serializer] Could not craete serializer for '%s'\n", entry_name);
@@ -301,17 +351,25 @@ static void pubsubSerializer_addMsgSerializerFromBundle(pubsub_json_serializer_t
             continue;
         }
 
-        // serializer has been constructed, try to put in the map
+        // serializer has been constructed, share it with the maps of other bundles (the parsed msg type is shared
+        // per descriptor, so an equal msg type means an equal msg serializer)
+        pubsub_msg_serializer_t *shared = pubsub_serializerCache_acquire(serializer->cache, impl->msgType);
+        if (shared == NULL) {
+            shared = pubsub_serializerCache_add(serializer->cache, impl->msgType, msgSerializer);
+        }
+        if (shared != msgSerializer) {
+            pubsubSerializer_destroyMsgSerializer(serializer, msgSerializer);
+            msgSerializer = shared;
+        }
+
+        // try to put in the map
         if (hashMap_containsKey(msgSerializers, (void *) (uintptr_t) msgSerializer->msgId)) {
-            L_WARN("Cannot add msg %s. Clash is msg id %d!\n", msgSerializer->msgName, msgSerializer->msgId);
-            dynMessage_destroy(impl->msgType);
-            free(msgSerializer);
-            free(impl);
+            pubsub_msg_serializer_t *clash = hashMap_get(msgSerializers, (void *) (uintptr_t) msgSerializer->msgId);
+            L_WARN("Cannot add msg %s. Clash is msg id %u of msg %s!\n", msgSerializer->msgName, msgSerializer->msgId, clash->msgName);
+            pubsubSerializer_releaseMsgSerializer(serializer, msgSerializer);
         } else if (msgSerializer->msgId == 0) {
             L_WARN("Cannot add msg %s. Clash is msg id %d!\n", msgSerializer->msgName, msgSerializer->msgId);
-            dynMessage_destroy(impl->msgType);
-            free(msgSerializer);
-            free(impl);
+            pubsubSerializer_releaseMsgSerializer(serializer, msgSerializer);
         }
         else {
             hashMap_put(msgSerializers, (void *) (uintptr_t) msgSerializer->msgId, msgSerializer);
@@ -323,20 +381,41 @@ static void pubsubSerializer_addMsgSerializerFromBundle(pubsub_json_serializer_t
     }
 }
 
-static FILE* openFileStream(pubsub_json_serializer_t *serializer, FILE_INPUT_TYPE file_input_type, const char* filename, const char* root, char* avpr_fqn, char* pathOrError) {
+/**
+ * Opens a descriptor as stream on a read-only mapping of the file, so the descriptor is parsed from the page cache
+ * instead of copied in a stdio buffer. Falls back to fopen if the file cannot be mapped (e.g. an empty file).
+ * The mapping must be released with utils_unmapFile after the stream is closed.
+ */
+static FILE* openMappedStream(const char* path, const void** mapped, size_t* mappedLength) {
+    FILE* result = NULL;
+    if (utils_mapFile(path, mapped, mappedLength) == CELIX_SUCCESS && *mappedLength > 0) {
+        result = fmemopen((void*)*mapped, *mappedLength, "r");
+    }
+    if (result == NULL) {
+        utils_unmapFile(*mapped, *mappedLength);
+        *mapped = NULL;
+        *mappedLength = 0;
+        result = fopen(path, "r");
+    }
+    return result;
+}
+
+static FILE* openFileStream(pubsub_json_serializer_t *serializer, FILE_INPUT_TYPE file_input_type, const char* filename, const char* root, char* avpr_fqn, char* pathOrError, const void** mapped, size_t* mappedLength) {
     FILE* result = NULL;
     memset(pathOrError, 0, MAX_PATH_LEN);
+    *mapped = NULL;
+    *mappedLength = 0;
     switch (file_input_type) {
         case FIT_INVALID:
             snprintf(pathOrError, MAX_PATH_LEN, "Because %s is not a valid file", filename);
             break;
         case FIT_DESCRIPTOR:
             snprintf(pathOrError, MAX_PATH_LEN, "%s/%s", root, filename);
-            result = fopen(pathOrError, "r");
+            result = openMappedStream(pathOrError, mapped, mappedLength);
             break;
         case FIT_AVPR:
             if (readPropertiesFile(serializer, filename, root, avpr_fqn, pathOrError)) {
-                result = fopen(pathOrError, "r");
+                result = openMappedStream(pathOrError, mapped, mappedLength);
             }
             break;
         default:
@@ -399,7 +478,7 @@ static bool readPropertiesFile(pubsub_json_serializer_t* serializer, const char*
 
 static int pubsubMsgSerializer_convertDescriptor(pubsub_json_serializer_t* serializer, FILE* file_ptr, pubsub_msg_serializer_t* msgSerializer) {
     dyn_message_type *msgType = NULL;
-    int rc = dynMessage_parse(file_ptr, &msgType);
+    int rc = dynMessage_parseShared(file_ptr, &msgType);
     if (rc != 0 || msgType == NULL) {
         L_WARN("[json serializer] Cannot parse message from descriptor.\n");
         return -1;
@@ -447,13 +526,16 @@ static int pubsubMsgSerializer_convertDescriptor(pubsub_json_serializer_t* seria
     msgSerializer->serialize = (void*) pubsubMsgSerializer_serialize;
     msgSerializer->deserialize = (void*) pubsubMsgSerializer_deserialize;
     msgSerializer->freeMsg = (void*) pubsubMsgSerializer_freeMsg;
+    msgSerializer->copyMsg = (void*) pubsubMsgSerializer_copyMsg;
+    msgSerializer->msgToProperties = (void*) pubsubMsgSerializer_msgToProperties;
+    msgSerializer->podSize = dynType_isPod(type) ? dynType_size(type) : 0;
 
     return 0;
 }
 
 static int pubsubMsgSerializer_convertAvpr(pubsub_json_serializer_t *serializer, FILE* file_ptr, pubsub_msg_serializer_t* msgSerializer, const char* fqn) {
     if (!file_ptr || !fqn || !serializer) return -2;
-    dyn_message_type* msgType = dynMessage_parseAvpr(file_ptr, fqn);
+    dyn_message_type* msgType = dynMessage_parseAvprShared(file_ptr, fqn);
 
     if (!msgType) {
         L_WARN("[json serializer] Cannot parse avpr file '%s'\n", fqn);
@@ -502,6 +584,9 @@ static int pubsubMsgSerializer_convertAvpr(pubsub_json_serializer_t *serializer,
     msgSerializer->serialize = (void*) pubsubMsgSerializer_serialize;
     msgSerializer->deserialize = (void*) pubsubMsgSerializer_deserialize;
     msgSerializer->freeMsg = (void*) pubsubMsgSerializer_freeMsg;
+    msgSerializer->copyMsg = (void*) pubsubMsgSerializer_copyMsg;
+    msgSerializer->msgToProperties = (void*) pubsubMsgSerializer_msgToProperties;
+    msgSerializer->podSize = dynType_isPod(type) ? dynType_size(type) : 0;
 
     return 0;
 }
@@ -20,65 +20,66 @@
 #ifndef PUBSUB_ADMIN_METRICS_H_
 #define PUBSUB_ADMIN_METRICS_H_
 
+#include <stdbool.h>
+#include <stdint.h>
 #include <uuid/uuid.h>
 #include <sys/time.h>
-#include "celix_array_list.h"
 
 #define PUBSUB_ADMIN_METRICS_SERVICE_NAME   "pubsub_admin_metrics"
 
-#define PUBSUB_AMDIN_METRICS_NAME_MAX       1024
+/**
+ * Nr of buckets of a metrics histogram. Values below 4 ns have their own bucket, larger values are counted in
+ * 4 linear sub buckets per power of 2 (max 25% bucket width), up to 2^33 ns (~8.6 s). Larger values are counted
+ * in the last bucket.
+ */
+#define PUBSUB_METRICS_HISTOGRAM_SIZE       128
+
+/**
+ * Log-linear (HDR-style) histogram for durations in nanoseconds. All fields are cumulative.
+ */
+typedef struct pubsub_metrics_histogram {
+    uint64_t count;
+    uint64_t sumInNs;
+    uint64_t minInNs;
+    uint64_t maxInNs;
+    uint32_t buckets[PUBSUB_METRICS_HISTOGRAM_SIZE];
+} pubsub_metrics_histogram_t;
+
+typedef enum pubsub_metrics_entry_type {
+    PUBSUB_METRICS_TOPIC_SENDER = 0,    //a topic sender, only the send queue fields are used
+    PUBSUB_METRICS_SEND_MSG = 1,        //a msg type of a publishing bundle of a topic sender
+    PUBSUB_METRICS_RECEIVE_MSG = 2      //a msg type from an origin framework for a subscribing bundle of a topic receiver
+} pubsub_metrics_entry_type_e;
 
-typedef struct pubsub_admin_sender_msg_type_metrics {
-    long bndId;
-    char typeFqn[PUBSUB_AMDIN_METRICS_NAME_MAX];
-    unsigned int typeId;
-    unsigned long nrOfMessagesSend;
-    unsigned long nrOfMessagesSendFailed;
+/**
+ * A metrics entry of a PSA. All counters are cumulative, a consumer gets deltas by subtracting the previous values
+ * of the same entry (same type, scope, topic, msgTypeId, bndId and originUUID).
+ * The names and histograms are owned by the PSA and only valid during the visit callback.
+ */
+typedef struct pubsub_metrics_entry {
+    pubsub_metrics_entry_type_e type;
+    const char *psaType;
+    const char *scope; //can be NULL
+    const char *topic;
+    const char *msgFqn; //NULL for PUBSUB_METRICS_TOPIC_SENDER
+    unsigned int msgTypeId;
+    long bndId; //the publishing or subscribing bundle, -1 for PUBSUB_METRICS_TOPIC_SENDER
+    uuid_t originUUID; //the framework uuid of the sender for PUBSUB_METRICS_RECEIVE_MSG, otherwise cleared
+
+    unsigned long nrOfMessages; //nr of send or received msgs
+    unsigned long nrOfMessagesFailed; //nr of failed sends
     unsigned long nrOfSerializationErrors;
-    struct timespec lastMessageSend;
-    double averageTimeBetweenMessagesInSeconds;
-    double averageSerializationTimeInSeconds;
-} pubsub_admin_sender_msg_type_metrics_t;
-
-typedef struct pubsub_admin_sender_metrics {
-    char scope[PUBSUB_AMDIN_METRICS_NAME_MAX];
-    char topic[PUBSUB_AMDIN_METRICS_NAME_MAX];
-    unsigned long nrOfUnknownMessagesRetrieved;
-    unsigned int nrOfmsgMetrics;
-    pubsub_admin_sender_msg_type_metrics_t *msgMetrics; //size = nrOfMessageTypes
-} pubsub_admin_sender_metrics_t;
-
-typedef struct pubsub_admin_receiver_metrics {
-    char scope[PUBSUB_AMDIN_METRICS_NAME_MAX];
-    char topic[PUBSUB_AMDIN_METRICS_NAME_MAX];
-    unsigned long nrOfMsgTypes;
-    struct {
-        unsigned int typeId;
-        char typeFqn[PUBSUB_AMDIN_METRICS_NAME_MAX];
-        int nrOfOrigins;
-        struct {
-            uuid_t originUUID;
-            unsigned long nrOfMessagesReceived;
-            unsigned long nrOfSerializationErrors;
-            unsigned long nrOfMissingSeqNumbers;
-            struct timespec lastMessageReceived;
-            double averageTimeBetweenMessagesInSeconds;
-            double averageSerializationTimeInSeconds;
-            double averageDelayInSeconds;
-            double minDelayInSeconds;
-            double maxDelayInSeconds;
-        } *origins;
-    } *msgTypes;
-} pubsub_admin_receiver_metrics_t;
-
-
-typedef struct pubsub_admin_metrics {
-    char psaType[PUBSUB_AMDIN_METRICS_NAME_MAX];
-
-    celix_array_list_t *senders; //entry type = pubsub_admin_sender_metrics_t
-    celix_array_list_t *receivers;//entry type = pubsub_admin_receiver_metrics_t
-
-} pubsub_admin_metrics_t;
+    unsigned long nrOfMissingSeqNumbers; //only for PUBSUB_METRICS_RECEIVE_MSG
+    struct timespec lastMessage; //time (CLOCK_REALTIME) of the last send or received msg
+    const pubsub_metrics_histogram_t *serializationTime; //serialization (send) or deserialization (receive) time, can be NULL
+    const pubsub_metrics_histogram_t *delay; //delay between send and receive, only for PUBSUB_METRICS_RECEIVE_MSG
+
+    unsigned long sendQueueSize; //nr of bytes currently queued for all subscriber connections
+    unsigned long maxSendQueueSize; //highest nr of bytes queued for a single subscriber connection
+    unsigned long nrOfMessagesDropped; //nr of msgs dropped by the send queue policy or, for receive metrics, conflated by the dispatch queue
+} pubsub_metrics_entry_t;
+
+typedef void (*pubsub_metrics_visit_fp)(void *callbackHandle, const pubsub_metrics_entry_t *entry);
 
 /**
  * A metrics service for a PubSubAdmin. This is an optional service.
@@ -89,18 +90,42 @@ struct pubsub_admin_metrics_service {
     void *handle;
 
     /**
-     * Creates a metrics struct for the PSA. The caller is owner of the data and
-     * should use pubsub_freePubSubAdminMetrics (part of pubsub_spi) to release the data.
-     * @param handle
-     * @return The metrics or NULL if no metrics can be created.
+     * Streams the metrics entries of the PSA to the callback, without creating a snapshot.
+     * The callback is called with the metrics locks of the PSA taken and should therefore be short and not block.
+     *
+     * @param handle            The service handle.
+     * @param changedSince      If not NULL, only the msg entries with a msg send or received after changedSince are
+     *                          visited (i.e. the entries with deltas since a previous visit). Topic sender entries are
+     *                          always visited.
+     * @param callbackHandle    The handle for the callback.
+     * @param callback          Called for every visited metrics entry.
      */
-    pubsub_admin_metrics_t* (*metrics)(void *handle);
+    void (*visitMetrics)(void *handle, const struct timespec *changedSince, void *callbackHandle, pubsub_metrics_visit_fp callback);
 };
 
-void pubsub_freePubSubAdminMetrics(pubsub_admin_metrics_t *metrics);
-
 typedef struct pubsub_admin_metrics_service pubsub_admin_metrics_service_t;
 
-#endif /* PUBSUB_ADMIN_METRICS_H_ */
+/**
+ * Adds a value to the histogram.
+ * Only a single thread should record values to a histogram at the same time, but other threads can concurrently
+ * read the histogram with pubsub_metricsHistogram_copy.
+ */
+void pubsub_metricsHistogram_record(pubsub_metrics_histogram_t *histogram, uint64_t valueInNs);
 
+/**
+ * Copies a histogram which can concurrently be updated by a (single) recording thread.
+ * The copy can be slightly inconsistent (e.g. count vs buckets), but never contains torn values.
+ */
+void pubsub_metricsHistogram_copy(pubsub_metrics_histogram_t *copy, const pubsub_metrics_histogram_t *histogram);
 
+/**
+ * Returns the (upper bound of the bucket of the) value at the percentile (0.0 - 100.0), 0 for an empty histogram.
+ */
+uint64_t pubsub_metricsHistogram_valueAtPercentile(const pubsub_metrics_histogram_t *histogram, double percentile);
+
+/**
+ * Returns true if the msg entry has a msg send or received after changedSince, or if changedSince is NULL.
+ */
+bool pubsub_metrics_changedSince(const pubsub_metrics_entry_t *entry, const struct timespec *changedSince);
+
+#endif /* PUBSUB_ADMIN_METRICS_H_ */
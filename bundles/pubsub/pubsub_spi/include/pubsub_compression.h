@@ -0,0 +1,66 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *  KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#ifndef PUBSUB_COMPRESSION_H_
+#define PUBSUB_COMPRESSION_H_
+
+#include <stdbool.h>
+#include <stdlib.h>
+
+#include "celix_errno.h"
+#include "celix_properties.h"
+
+/**
+ * Optional compression stage between the serializer and the transport of a PSA, configured with the
+ * PUBSUB_COMPRESSION_* topic properties (see pubsub_constants.h).
+ * A compressed payload is prefixed with its uncompressed size (4 bytes, little endian), the PSA signals a compressed
+ * payload with a flag in its msg header.
+ * Thread safe; the (de)compression streams are reused and protected by a mutex.
+ */
+typedef struct pubsub_compressor pubsub_compressor_t;
+
+/**
+ * Creates a compressor for the topic properties. Returns NULL if compression is not configured, or the configured
+ * compression (dictionary) cannot be used.
+ */
+pubsub_compressor_t* pubsub_compressor_create(const celix_properties_t *topicProperties);
+
+/**
+ * Creates a decompressor for the topic properties. Only the dictionary of the topic properties is used, so the
+ * decompressor can also be created for topics without compression. Returns NULL if the dictionary cannot be read.
+ */
+pubsub_compressor_t* pubsub_decompressor_create(const celix_properties_t *topicProperties);
+
+void pubsub_compressor_destroy(pubsub_compressor_t *compressor);
+
+/**
+ * Compresses the payload into a newly allocated buffer (out), which should be freed by the caller.
+ * Returns false (and out is not set) if the payload is smaller than the configured min size or does not get
+ * smaller by compressing it; in that case the payload should be sent uncompressed.
+ */
+bool pubsub_compressor_compress(pubsub_compressor_t *compressor, const void *payload, size_t payloadSize, void **out, size_t *outSize);
+
+/**
+ * Decompresses a compressed payload into a newly allocated buffer (out), which should be freed by the caller.
+ * The decompressor can be NULL for payloads compressed without a dictionary.
+ * Returns CELIX_ILLEGAL_ARGUMENT if the payload is not a valid compressed payload.
+ */
+celix_status_t pubsub_compressor_decompress(pubsub_compressor_t *decompressor, const void *payload, size_t payloadSize, void **out, size_t *outSize);
+
+#endif /* PUBSUB_COMPRESSION_H_ */
@@ -38,4 +38,133 @@
  */
 #define PUBSUB_ENDPOINT_LOCAL_VISIBILITY     "local"
 
+/**
+ * Topic property to configure how a topic receiver dispatches received msgs to its subscribers:
+ *  - "single" (default): all subscribers are called on the receive thread of the topic.
+ *  - "subscriber": every subscriber has a msg queue and a dedicated dispatch thread.
+ *  - "pool": every subscriber has a msg queue, the queues are processed by a thread pool of the topic receiver.
+ * Msgs are dispatched to a subscriber in receive order in every mode.
+ */
+#define PUBSUB_DISPATCH_MODE_KEY                "pubsub.dispatch.mode"
+#define PUBSUB_DISPATCH_MODE_SINGLE             "single"
+#define PUBSUB_DISPATCH_MODE_SUBSCRIBER         "subscriber"
+#define PUBSUB_DISPATCH_MODE_POOL               "pool"
+
+/**
+ * Topic property for the max number of queued msgs per subscriber for the "subscriber" and "pool" dispatch modes.
+ * Msgs for a subscriber with a full queue are dropped.
+ */
+#define PUBSUB_DISPATCH_QUEUE_SIZE_KEY          "pubsub.dispatch.queue.size"
+#define PUBSUB_DISPATCH_QUEUE_SIZE_DEFAULT      1024
+
+/**
+ * Topic property for the number of threads of the "pool" dispatch mode. 0 means the number of online CPUs.
+ */
+#define PUBSUB_DISPATCH_POOL_SIZE_KEY           "pubsub.dispatch.pool.size"
+#define PUBSUB_DISPATCH_POOL_SIZE_DEFAULT       0
+
+/**
+ * Topic property to conflate the queued msgs of a subscriber, e.g. for sample topics where only the latest value is
+ * of interest. A received msg replaces a still queued msg with the same msg type and origin, so a slow subscriber only
+ * gets the latest msg instead of a growing backlog. The number of conflated msgs is reported as dropped msgs in the
+ * receive metrics.
+ * Conflation needs a dispatch queue, if no dispatch mode is configured the "subscriber" dispatch mode is used.
+ */
+#define PUBSUB_DISPATCH_CONFLATE_KEY            "pubsub.dispatch.conflate"
+#define PUBSUB_DISPATCH_CONFLATE_DEFAULT        false
+
+/**
+ * Topic properties for the scheduling of the receive (and dispatch) threads of a topic, so that e.g. control topics
+ * can be isolated from bulk sample topics (see pubsub_utils_setupThread):
+ *  - thread.realtime.sched: "SCHED_OTHER", "SCHED_BATCH", "SCHED_IDLE", "SCHED_FIFO" or "SCHED_RR".
+ *  - thread.realtime.prio: the realtime priority (1-99), only used with SCHED_FIFO and SCHED_RR.
+ *  - thread.cpu.affinity: the cpus the threads may run on, as a comma separated list of cpus or cpu ranges
+ *    (e.g. "2,4-5").
+ * Realtime scheduling needs CAP_SYS_NICE, without it the threads keep the default scheduling.
+ */
+#define PUBSUB_THREAD_REALTIME_SCHED_KEY        "thread.realtime.sched"
+#define PUBSUB_THREAD_REALTIME_PRIO_KEY         "thread.realtime.prio"
+#define PUBSUB_THREAD_CPU_AFFINITY_KEY          "thread.cpu.affinity"
+
+/**
+ * Topic property to configure what a topic sender does with a msg for a subscriber which cannot keep up, when the
+ * send queue of the connection to the subscriber is full:
+ *  - "drop_newest": the new msg is dropped. Default for topics without a qos.
+ *  - "drop_oldest": the oldest queued msgs are dropped, the latest value wins. Default for qos=sample topics.
+ *  - "block": the publisher waits (bounded by the timeout of the PSA) till the queue has room. Default for
+ *    qos=control topics.
+ */
+#define PUBSUB_SEND_QUEUE_POLICY_KEY            "pubsub.send.queue.policy"
+#define PUBSUB_SEND_QUEUE_POLICY_DROP_NEWEST    "drop_newest"
+#define PUBSUB_SEND_QUEUE_POLICY_DROP_OLDEST    "drop_oldest"
+#define PUBSUB_SEND_QUEUE_POLICY_BLOCK          "block"
+
+/**
+ * Topic property for the max size in bytes of the send queue of a single subscriber connection.
+ */
+#define PUBSUB_SEND_QUEUE_SIZE_KEY              "pubsub.send.queue.size"
+#define PUBSUB_SEND_QUEUE_SIZE_DEFAULT          (4 * 1024 * 1024)
+
+/**
+ * Topic property for the number of msg types of which a topic sender keeps the last sent msg. The cached msgs are
+ * sent to a subscriber as soon as its connection is established, so a late joining subscriber still receives the
+ * latest value. 0 disables the last value cache. Only supported by connection oriented PSAs.
+ */
+#define PUBSUB_LAST_VALUE_CACHE_SIZE_KEY        "pubsub.last.value.cache.size"
+#define PUBSUB_LAST_VALUE_CACHE_SIZE_DEFAULT    0
+
+/**
+ * Optional topic property with the (dotted) name of a msg field keying the last value cache, e.g. "id" for a topic
+ * with the state of multiple instances. The last msg is then cached per (msg type, key field value), each counting
+ * towards pubsub.last.value.cache.size, so a late joining subscriber receives the latest state of every instance.
+ * Needs a msg serializer supporting msgToProperties, otherwise only the last msg per msg type is cached.
+ */
+#define PUBSUB_LAST_VALUE_CACHE_KEY             "pubsub.last.value.cache.key"
+
+/**
+ * Topic property for the number of partitions of a topic, to scale a single hot topic over multiple cores.
+ * The msgs of a partitioned topic are divided over the partitions by the hash of the PUBSUB_PARTITION_KEY field,
+ * every partition has its own connection and is received by its own thread. Msgs with the same key value are sent
+ * over the same partition, so they are received in send order. Should be set for the publishers and subscribers of
+ * the topic. Only supported by the TCP PSA for topics with a dynamic (not static or multiplexed) endpoint.
+ */
+#define PUBSUB_PARTITIONS_KEY                   "pubsub.partitions"
+#define PUBSUB_PARTITIONS_DEFAULT               1
+
+/**
+ * Topic property with the (dotted) name of the msg field keying the partition of a msg, e.g. "id".
+ * Needs a msg serializer supporting msgToProperties. Msgs without the key field are sent over the first partition.
+ */
+#define PUBSUB_PARTITION_KEY                    "pubsub.partition.key"
+
+/**
+ * Topic property to compress the serialized msgs of a topic before they are sent (see pubsub_compression.h):
+ *  - "none": msgs are sent uncompressed. Default.
+ *  - "deflate": msgs are compressed with zlib deflate.
+ * Receivers decompress msgs flagged as compressed, independent of this property.
+ */
+#define PUBSUB_COMPRESSION_KEY                  "pubsub.compression"
+#define PUBSUB_COMPRESSION_NONE                 "none"
+#define PUBSUB_COMPRESSION_DEFLATE              "deflate"
+#define PUBSUB_COMPRESSION_DEFAULT              PUBSUB_COMPRESSION_NONE
+
+/**
+ * Topic property for the compression level, 1 (fastest) to 9 (smallest).
+ */
+#define PUBSUB_COMPRESSION_LEVEL_KEY            "pubsub.compression.level"
+#define PUBSUB_COMPRESSION_LEVEL_DEFAULT        1
+
+/**
+ * Topic property for the min size in bytes of a serialized msg to be compressed. Smaller msgs are sent uncompressed.
+ */
+#define PUBSUB_COMPRESSION_MIN_SIZE_KEY         "pubsub.compression.min.size"
+#define PUBSUB_COMPRESSION_MIN_SIZE_DEFAULT     256
+
+/**
+ * Topic property with the path of a file containing a preset compression dictionary, e.g. samples of typical msgs.
+ * A dictionary improves the compression of small msgs with repeating content. Publishers and subscribers of the
+ * topic should use the same dictionary.
+ */
+#define PUBSUB_COMPRESSION_DICTIONARY_KEY       "pubsub.compression.dictionary"
+
 #endif /* PUBSUB_CONSTANTS_H_ */
@@ -0,0 +1,106 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *  KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#ifndef PUBSUB_DISPATCHER_H_
+#define PUBSUB_DISPATCHER_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <time.h>
+
+#include "celix_errno.h"
+#include "celix_properties.h"
+
+/**
+ * Dispatcher for topic receivers which do not dispatch received msgs on their receive thread (see the
+ * PUBSUB_DISPATCH_MODE_KEY topic property).
+ *
+ * A received msg is copied once into a reference counted dispatch msg, which is shared by the dispatch queues of
+ * all subscribers. Every subscriber has its own dispatch queue, processed by a dedicated thread or by the thread pool
+ * of the dispatcher, so that a slow subscriber does not block the receive thread or the other subscribers.
+ * The msgs of a queue are dispatched one at the time in enqueue order.
+ * For a conflating dispatcher (see PUBSUB_DISPATCH_CONFLATE_KEY) a msg replaces a queued msg with the same conflation
+ * key, keeping the queue position of the replaced msg.
+ */
+typedef struct pubsub_dispatcher pubsub_dispatcher_t;
+typedef struct pubsub_dispatch_queue pubsub_dispatch_queue_t;
+typedef struct pubsub_dispatch_msg pubsub_dispatch_msg_t;
+
+/**
+ * Max size of the conflation key of a dispatch msg.
+ */
+#define PUBSUB_DISPATCH_MAX_CONFLATION_KEY_SIZE     32
+
+/**
+ * Dispatch callback, called on a dispatch thread for every msg of a queue.
+ * nrOfConflatedMsgs is the number of msgs replaced by this msg (always 0 for a non conflating dispatcher).
+ */
+typedef void (*pubsub_dispatch_fp)(void *handle, const void *header, const void *payload, size_t payloadSize, const struct timespec *receiveTime, unsigned int nrOfConflatedMsgs);
+
+/**
+ * Creates a dispatcher for the dispatch mode configured in the topic properties.
+ * Returns NULL for the "single" dispatch mode (or if no dispatch mode and no conflation is configured), in which case
+ * the topic receiver should dispatch msgs on its receive thread.
+ *
+ * @param topicProperties   The topic properties, can be NULL.
+ * @param name              Name used for the dispatch threads.
+ */
+pubsub_dispatcher_t* pubsub_dispatcher_create(const celix_properties_t *topicProperties, const char *name);
+
+/**
+ * Destroys the dispatcher. All queues of the dispatcher should be destroyed first.
+ */
+void pubsub_dispatcher_destroy(pubsub_dispatcher_t *dispatcher);
+
+/**
+ * Creates a dispatch queue (e.g. for a subscriber), which calls dispatch with the provided handle for every
+ * enqueued msg.
+ */
+pubsub_dispatch_queue_t* pubsub_dispatcher_createQueue(pubsub_dispatcher_t *dispatcher, void *handle, pubsub_dispatch_fp dispatch);
+
+/**
+ * Destroys the dispatch queue. Waits for the msg currently being dispatched, msgs still queued are dropped.
+ * After this call the dispatch callback of the queue is not called anymore.
+ */
+void pubsub_dispatchQueue_destroy(pubsub_dispatch_queue_t *queue);
+
+/**
+ * Enqueues a msg, the queue keeps a reference to the msg until it is dispatched (or conflated).
+ * Returns false if the queue is full.
+ */
+bool pubsub_dispatchQueue_enqueue(pubsub_dispatch_queue_t *queue, pubsub_dispatch_msg_t *msg);
+
+/**
+ * Creates a dispatch msg with a copy of the header and payload and a reference count of 1.
+ */
+pubsub_dispatch_msg_t* pubsub_dispatchMsg_create(const void *header, size_t headerSize, const void *payload, size_t payloadSize, const struct timespec *receiveTime);
+
+/**
+ * Sets the key used to conflate the msg, e.g. the msg type id and origin. Only used by a conflating dispatcher, msgs
+ * without a conflation key are never conflated. Should be called before the msg is enqueued.
+ * Returns CELIX_ILLEGAL_ARGUMENT if the key is larger than PUBSUB_DISPATCH_MAX_CONFLATION_KEY_SIZE.
+ */
+celix_status_t pubsub_dispatchMsg_setConflationKey(pubsub_dispatch_msg_t *msg, const void *key, size_t keySize);
+
+/**
+ * Releases a reference to the dispatch msg, the msg is freed when the last reference is released.
+ */
+void pubsub_dispatchMsg_release(pubsub_dispatch_msg_t *msg);
+
+#endif /* PUBSUB_DISPATCHER_H_ */
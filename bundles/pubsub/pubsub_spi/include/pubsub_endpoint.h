@@ -41,6 +41,7 @@ extern "C" {
 #define PUBSUB_ENDPOINT_VISIBILITY      "pubsub.endpoint.visibility" //local, host or system. e.g. for IPC host
 #define PUBSUB_ENDPOINT_ADMIN_TYPE       PUBSUB_ADMIN_TYPE_KEY
 #define PUBSUB_ENDPOINT_SERIALIZER       PUBSUB_SERIALIZER_TYPE_KEY
+#define PUBSUB_ENDPOINT_MSG_FILTER      "pubsub.msg.filter" //optional for subscriber endpoints, the combined msg filter of the subscribers
 
 
 #define PUBSUB_PUBLISHER_ENDPOINT_TYPE      "publisher"
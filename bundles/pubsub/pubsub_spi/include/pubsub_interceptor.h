@@ -0,0 +1,92 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *  KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#ifndef PUBSUB_INTERCEPTOR_H_
+#define PUBSUB_INTERCEPTOR_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "celix_errno.h"
+
+/**
+ * A pubsub interceptor is called by the PSAs for every sent and received msg of all topics, so per msg behavior
+ * (e.g. metrics, filtering or auditing) can be added once for all transports.
+ * The hooks are called with the serialized msg, i.e. the output of the serializer on send and the (decompressed)
+ * input of the deserializer on receive (postSend only gets its size). The hooks are called from the publishing and receiving threads, so an
+ * interceptor must be thread safe and should be fast.
+ *
+ * Interceptors are called in order of service ranking (highest first) for the pre hooks and in reverse order for the
+ * post hooks. All hooks are optional (can be NULL).
+ */
+
+#define PUBSUB_INTERCEPTOR_SERVICE_NAME     "pubsub_interceptor"
+#define PUBSUB_INTERCEPTOR_SERVICE_VERSION  "1.0.0"
+#define PUBSUB_INTERCEPTOR_SERVICE_RANGE    "[1,2)"
+
+/**
+ * The topic of the intercepted msg.
+ */
+typedef struct pubsub_interceptor_properties {
+    const char *psaType;
+    const char *scope; //can be NULL
+    const char *topic;
+} pubsub_interceptor_properties_t;
+
+/**
+ * The transport independent header of an intercepted msg.
+ */
+typedef struct pubsub_interceptor_msg_header {
+    uint32_t msgTypeId;
+    const char *msgFqn; //NULL if not known by the PSA (e.g. for a received msg without local subscriber serializer)
+    unsigned int msgMajorVersion;
+    unsigned int msgMinorVersion;
+} pubsub_interceptor_msg_header_t;
+
+typedef struct pubsub_interceptor {
+    void *handle;
+
+    /**
+     * Called before a serialized msg is sent. Returning false drops the msg, the remaining interceptors are then not
+     * called.
+     */
+    bool (*preSend)(void *handle, const pubsub_interceptor_properties_t *properties, const pubsub_interceptor_msg_header_t *header, const void *payload, size_t payloadSize);
+
+    /**
+     * Called after a msg is handed to the transport (or failed to), for the msgs which passed preSend.
+     * Note that the serialized msg itself is no longer available, it can be owned by the transport (e.g. for zero copy
+     * sends).
+     */
+    void (*postSend)(void *handle, const pubsub_interceptor_properties_t *properties, const pubsub_interceptor_msg_header_t *header, size_t payloadSize, celix_status_t status);
+
+    /**
+     * Called before a received serialized msg is delivered to the subscribers. Returning false drops the msg, the
+     * remaining interceptors are then not called.
+     */
+    bool (*preReceive)(void *handle, const pubsub_interceptor_properties_t *properties, const pubsub_interceptor_msg_header_t *header, const void *payload, size_t payloadSize);
+
+    /**
+     * Called after a received msg is delivered (or queued for delivery) to the subscribers, for the msgs which
+     * passed preReceive.
+     */
+    void (*postReceive)(void *handle, const pubsub_interceptor_properties_t *properties, const pubsub_interceptor_msg_header_t *header, const void *payload, size_t payloadSize);
+} pubsub_interceptor_t;
+
+#endif /* PUBSUB_INTERCEPTOR_H_ */
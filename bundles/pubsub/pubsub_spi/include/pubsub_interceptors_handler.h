@@ -0,0 +1,99 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *  KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#ifndef PUBSUB_INTERCEPTORS_HANDLER_H_
+#define PUBSUB_INTERCEPTORS_HANDLER_H_
+
+#include <stdbool.h>
+
+#include "celix_array_list.h"
+#include "celix_bundle_context.h"
+#include "celix_threads.h"
+
+#include "pubsub_interceptor.h"
+
+/**
+ * Tracks the pubsub interceptor services for a topic sender or receiver and calls their hooks.
+ * The hooks of the handler are inlined and only check an atomic counter when no interceptors are registered, so
+ * PSAs can call them for every msg.
+ * The handler is thread safe. A NULL handler has no interceptors.
+ */
+typedef struct pubsub_interceptors_handler pubsub_interceptors_handler_t;
+
+/**
+ * Note the struct is only part of the header to inline the hooks, the fields should not be used by PSAs.
+ */
+struct pubsub_interceptors_handler {
+    celix_bundle_context_t *ctx;
+    pubsub_interceptor_properties_t properties;
+    long trackerId;
+
+    celix_thread_rwlock_t lock; //protects the entries and interceptors, read locked while calling the hooks
+    celix_array_list_t *entries; //sorted on ranking (highest first)
+    pubsub_interceptor_t **interceptors; //cached array of the svcs of the entries
+    size_t nrOfInterceptors; //written under write lock, read lock free for the fast path
+};
+
+pubsub_interceptors_handler_t* pubsub_interceptorsHandler_create(celix_bundle_context_t *ctx, const char *psaType, const char *scope, const char *topic);
+
+/**
+ * Destroys the handler. Can be called with NULL.
+ */
+void pubsub_interceptorsHandler_destroy(pubsub_interceptors_handler_t *handler);
+
+bool pubsub_interceptorsHandler_invokePreSend(pubsub_interceptors_handler_t *handler, const pubsub_interceptor_msg_header_t *header, const void *payload, size_t payloadSize);
+void pubsub_interceptorsHandler_invokePostSend(pubsub_interceptors_handler_t *handler, const pubsub_interceptor_msg_header_t *header, size_t payloadSize, celix_status_t status);
+bool pubsub_interceptorsHandler_invokePreReceive(pubsub_interceptors_handler_t *handler, const pubsub_interceptor_msg_header_t *header, const void *payload, size_t payloadSize);
+void pubsub_interceptorsHandler_invokePostReceive(pubsub_interceptors_handler_t *handler, const pubsub_interceptor_msg_header_t *header, const void *payload, size_t payloadSize);
+
+/**
+ * Returns whether interceptors are registered, i.e. whether the hooks need to be called. PSAs can use this to skip
+ * the preparation of the header of a msg.
+ */
+static inline bool pubsub_interceptorsHandler_isActive(pubsub_interceptors_handler_t *handler) {
+    return handler != NULL && __atomic_load_n(&handler->nrOfInterceptors, __ATOMIC_ACQUIRE) > 0;
+}
+
+/**
+ * Calls the preSend hooks. Returns false if the msg should be dropped.
+ */
+static inline bool pubsub_interceptorsHandler_preSend(pubsub_interceptors_handler_t *handler, const pubsub_interceptor_msg_header_t *header, const void *payload, size_t payloadSize) {
+    return !pubsub_interceptorsHandler_isActive(handler) || pubsub_interceptorsHandler_invokePreSend(handler, header, payload, payloadSize);
+}
+
+static inline void pubsub_interceptorsHandler_postSend(pubsub_interceptors_handler_t *handler, const pubsub_interceptor_msg_header_t *header, size_t payloadSize, celix_status_t status) {
+    if (pubsub_interceptorsHandler_isActive(handler)) {
+        pubsub_interceptorsHandler_invokePostSend(handler, header, payloadSize, status);
+    }
+}
+
+/**
+ * Calls the preReceive hooks. Returns false if the msg should be dropped.
+ */
+static inline bool pubsub_interceptorsHandler_preReceive(pubsub_interceptors_handler_t *handler, const pubsub_interceptor_msg_header_t *header, const void *payload, size_t payloadSize) {
+    return !pubsub_interceptorsHandler_isActive(handler) || pubsub_interceptorsHandler_invokePreReceive(handler, header, payload, payloadSize);
+}
+
+static inline void pubsub_interceptorsHandler_postReceive(pubsub_interceptors_handler_t *handler, const pubsub_interceptor_msg_header_t *header, const void *payload, size_t payloadSize) {
+    if (pubsub_interceptorsHandler_isActive(handler)) {
+        pubsub_interceptorsHandler_invokePostReceive(handler, header, payload, payloadSize);
+    }
+}
+
+#endif /* PUBSUB_INTERCEPTORS_HANDLER_H_ */
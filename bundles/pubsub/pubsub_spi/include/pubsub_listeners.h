@@ -20,6 +20,8 @@
 #ifndef PUBSUB_LISTENERS_H_
 #define PUBSUB_LISTENERS_H_
 
+#include <stddef.h>
+
 #include "celix_properties.h"
 
 
@@ -31,6 +33,14 @@ struct pubsub_discovered_endpoint_listener {
 
     celix_status_t (*addDiscoveredEndpoint)(void *handle, const celix_properties_t *properties);
     celix_status_t (*removeDiscoveredEndpoint)(void *handle, const celix_properties_t *properties);
+
+    /**
+     * Optional (can be NULL). Adds/removes several endpoints as a single topology update, e.g. for a full read of the
+     * discovery directory or for all endpoints of a (dis)appearing framework.
+     * If NULL, the discovery calls addDiscoveredEndpoint/removeDiscoveredEndpoint per endpoint.
+     */
+    celix_status_t (*addDiscoveredEndpoints)(void *handle, const celix_properties_t *endpoints[], size_t nrOfEndpoints);
+    celix_status_t (*removeDiscoveredEndpoints)(void *handle, const celix_properties_t *endpoints[], size_t nrOfEndpoints);
 };
 typedef struct pubsub_discovered_endpoint_listener pubsub_discovered_endpoint_listener_t;
 
@@ -0,0 +1,58 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *  KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#ifndef PUBSUB_MSG_BATCH_H_
+#define PUBSUB_MSG_BATCH_H_
+
+#include <stddef.h>
+
+#include "pubsub/subscriber.h"
+#include "pubsub_serializer.h"
+
+#define PUBSUB_MSG_BATCH_DEFAULT_MAX_SIZE   256
+
+/**
+ * Collects the deserialized msgs for a subscriber with a receiveBatch callback (see pubsub_subscriber_t).
+ * Consecutive msgs of the same msg type are delivered in a single receiveBatch call when the batch is flushed, when
+ * a msg of another msg type is added or when the batch is full.
+ * A batch is used by a single (receive) thread and is not thread safe.
+ */
+typedef struct pubsub_msg_batch pubsub_msg_batch_t;
+
+/**
+ * Creates a batch for the subscriber, returns NULL if the subscriber has no receiveBatch callback.
+ */
+pubsub_msg_batch_t* pubsub_msgBatch_create(pubsub_subscriber_t *svc, size_t maxSize);
+
+/**
+ * Destroys the batch. Msgs still pending are freed without being delivered. Can be called with NULL.
+ */
+void pubsub_msgBatch_destroy(pubsub_msg_batch_t *batch);
+
+/**
+ * Adds a deserialized msg to the batch, the batch takes over ownership of the msg.
+ */
+void pubsub_msgBatch_add(pubsub_msg_batch_t *batch, pubsub_msg_serializer_t *msgSer, void *msg);
+
+/**
+ * Delivers the pending msgs with a single receiveBatch call and frees them. Can be called with NULL.
+ */
+void pubsub_msgBatch_flush(pubsub_msg_batch_t *batch);
+
+#endif /* PUBSUB_MSG_BATCH_H_ */
@@ -0,0 +1,60 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *  KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#ifndef PUBSUB_MSG_FILTERS_H_
+#define PUBSUB_MSG_FILTERS_H_
+
+#include <stdbool.h>
+
+#include "pubsub_serializer.h"
+
+/**
+ * The msg filters (see PUBSUB_ENDPOINT_MSG_FILTER) of the known subscriber endpoints of a topic sender, keyed by
+ * endpoint uuid. Used by a topic sender to skip msgs which are not needed by any known subscriber.
+ *
+ * Msgs are only skipped if at least one subscriber is known, all known subscribers have a msg filter and the msg
+ * serializer supports msgToProperties. Senders which can have subscribers unknown to the pubsubadmin (e.g. statically
+ * configured connections) should not use msg filters.
+ * Note that a msg filter is matched against every msg type of the topic.
+ *
+ * The msg filters are thread safe.
+ */
+typedef struct pubsub_msg_filters pubsub_msg_filters_t;
+
+pubsub_msg_filters_t* pubsub_msgFilters_create(void);
+
+/**
+ * Destroys the msg filters. Can be called with NULL.
+ */
+void pubsub_msgFilters_destroy(pubsub_msg_filters_t *filters);
+
+/**
+ * Adds (or replaces) the msg filter of a subscriber endpoint.
+ * A NULL or invalid filter means that the subscriber needs all msgs.
+ */
+void pubsub_msgFilters_add(pubsub_msg_filters_t *filters, const char *endpointUUID, const char *filter);
+
+void pubsub_msgFilters_remove(pubsub_msg_filters_t *filters, const char *endpointUUID);
+
+/**
+ * Returns whether msg is needed by at least one of the known subscribers. Returns true if filters is NULL.
+ */
+bool pubsub_msgFilters_match(pubsub_msg_filters_t *filters, const pubsub_msg_serializer_t *msgSer, const void *msg);
+
+#endif /* PUBSUB_MSG_FILTERS_H_ */
@@ -0,0 +1,64 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *  KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#ifndef PUBSUB_MSG_LOAN_POOL_H_
+#define PUBSUB_MSG_LOAN_POOL_H_
+
+#include <stdlib.h>
+
+#include "pubsub_serializer.h"
+
+/**
+ * Thread safe pool of msg buffers loaned to publishers (see pubsub_publisher_t loanMsg).
+ * Returned buffers are kept (up to maxPooledBuffers) and reused for loans of the same size, so that publishing
+ * loaned msgs of plain old data msg types does not allocate memory.
+ */
+typedef struct pubsub_msg_loan_pool pubsub_msg_loan_pool_t;
+
+pubsub_msg_loan_pool_t* pubsub_msgLoanPool_create(size_t maxPooledBuffers);
+
+/**
+ * Destroys the pool and frees the pooled buffers. Buffers still on loan must be returned before destroying the pool.
+ */
+void pubsub_msgLoanPool_destroy(pubsub_msg_loan_pool_t *pool);
+
+/**
+ * Loans a zeroed buffer of size bytes. Returns NULL if size is 0 or the buffer cannot be allocated.
+ */
+void* pubsub_msgLoanPool_loan(pubsub_msg_loan_pool_t *pool, size_t size);
+
+/**
+ * Returns a loaned buffer to the pool. Can be called with NULL.
+ */
+void pubsub_msgLoanPool_return(pubsub_msg_loan_pool_t *pool, void *buffer);
+
+/**
+ * Frees a loaned buffer without returning it to the pool, e.g. when the buffer is handed over to a transport which
+ * can release it after the pool is destroyed. Can be called with NULL.
+ */
+void pubsub_msgLoanPool_free(void *buffer);
+
+/**
+ * Creates a msg instance from the received payload of a loaned msg, i.e. the unserialized plain old data msg.
+ * The msg instance can be freed with the freeMsg of the msg serializer.
+ * Returns CELIX_ILLEGAL_ARGUMENT if the msg type is not plain old data or the payload size does not match.
+ */
+celix_status_t pubsub_createPodMsg(const pubsub_msg_serializer_t *msgSer, const void *payload, size_t payloadSize, void **out);
+
+#endif /* PUBSUB_MSG_LOAN_POOL_H_ */
@@ -20,9 +20,12 @@
 #ifndef PUBSUB_SERIALIZER_SERVICE_H_
 #define PUBSUB_SERIALIZER_SERVICE_H_
 
+#include <sys/uio.h>
+
 #include "hash_map.h"
 #include "version.h"
 #include "celix_bundle.h"
+#include "celix_properties.h"
 
 /**
  * There should be a pubsub_serializer_t
@@ -48,6 +51,43 @@ typedef struct pubsub_msg_serializer {
     celix_status_t (*deserialize)(void* handle, const void* input, size_t inputLen, void** out); //note inputLen can be 0 if predefined size is not needed
     void (*freeMsg)(void* handle, void* msg);
 
+    /**
+     * Optional (can be NULL). Creates a deep copy of msg, which can be freed with freeMsg.
+     * Used by pubsub admins which hand over messages without serializing them.
+     */
+    celix_status_t (*copyMsg)(void* handle, const void* msg, void** out);
+
+    /**
+     * Size of a msg instance if the msg type is plain old data (no pointers, texts or sequences), 0 otherwise.
+     * For plain old data msg types the podSize bytes of a msg are the complete msg, which pubsub admins can use
+     * to send loaned msgs without serializing them.
+     */
+    size_t podSize;
+
+    /**
+     * Optional (can be NULL). Deserializes a msg written with another minor version of the same major version
+     * of the msg type into the layout of msgVersion.
+     * Used by pubsub admins to accept msgs of older publishers, which would otherwise be rejected.
+     */
+    celix_status_t (*deserializeVersion)(void* handle, unsigned int writerMajor, unsigned int writerMinor, const void* input, size_t inputLen, void** out);
+
+    /**
+     * Optional (can be NULL). Adds the (non sequence) fields of msg to props, nested fields keyed by their dotted
+     * path (e.g. "pos.x"). Used by pubsub admins to match msgs against the msg filters of subscribers before sending.
+     */
+    celix_status_t (*msgToProperties)(void* handle, const void* msg, celix_properties_t* props);
+
+    /**
+     * Optional (can be NULL). Scatter/gather variant of serialize: describes the serialized msg as *n io vectors in
+     * out, which pubsub admins can write with a single writev/sendmsg instead of copying the msg into one buffer.
+     * On input *n is the capacity of out, on output the number of used io vectors. If out is too small
+     * CELIX_ILLEGAL_ARGUMENT is returned and *n is set to the needed number of io vectors.
+     * The io vectors can point into msg, so msg must stay unchanged till the io vectors are written. Memory allocated
+     * for the io vectors is returned in owned and must be freed (free()) after writing, owned is NULL if nothing is
+     * allocated.
+     */
+    celix_status_t (*serializeVec)(void* handle, const void* msg, struct iovec* out, size_t* n, void** owned);
+
 } pubsub_msg_serializer_t;
 
 typedef struct pubsub_serializer_service {
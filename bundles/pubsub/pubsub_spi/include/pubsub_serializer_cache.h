@@ -0,0 +1,64 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *  KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#ifndef PUBSUB_SERIALIZER_CACHE_H_
+#define PUBSUB_SERIALIZER_CACHE_H_
+
+#include <stdbool.h>
+
+#include "pubsub_serializer.h"
+
+/**
+ * Thread safe cache of msg serializers shared by the serializer maps of all bundles.
+ * The msg serializers are keyed by the shared parse result of their descriptor (e.g. the dyn_message_type of
+ * dynMessage_parseShared), which is unique per msg fqn, version and descriptor content. A bundle publishing or
+ * subscribing msg types already known through another bundle references the existing msg serializers, instead of
+ * creating its own.
+ * The cached msg serializers are reference counted and destroyed when the last serializer map is destroyed.
+ */
+typedef struct pubsub_serializer_cache pubsub_serializer_cache_t;
+
+/**
+ * Creates a cache. destroyMsgSerializer is called (with the handle) for msg serializers which are no longer referenced.
+ */
+pubsub_serializer_cache_t* pubsub_serializerCache_create(void *handle, void (*destroyMsgSerializer)(void *handle, pubsub_msg_serializer_t *msgSerializer));
+
+/**
+ * Destroys the cache and all msg serializers still in the cache.
+ */
+void pubsub_serializerCache_destroy(pubsub_serializer_cache_t *cache);
+
+/**
+ * Returns the cached msg serializer for key and increases its reference count, or NULL.
+ */
+pubsub_msg_serializer_t* pubsub_serializerCache_acquire(pubsub_serializer_cache_t *cache, const void *key);
+
+/**
+ * Adds a msg serializer to the cache with a reference count of 1. If a msg serializer for key was added meanwhile,
+ * that msg serializer is acquired and returned instead and the caller should destroy its own msg serializer.
+ * If the cache entry cannot be allocated, msgSerializer is returned uncached and destroyed when released.
+ */
+pubsub_msg_serializer_t* pubsub_serializerCache_add(pubsub_serializer_cache_t *cache, const void *key, pubsub_msg_serializer_t *msgSerializer);
+
+/**
+ * Releases a reference to the msg serializer for key, the msg serializer is destroyed on the last release.
+ */
+void pubsub_serializerCache_release(pubsub_serializer_cache_t *cache, const void *key, pubsub_msg_serializer_t *msgSerializer);
+
+#endif /* PUBSUB_SERIALIZER_CACHE_H_ */
@@ -0,0 +1,128 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *  KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#ifndef PUBSUB_TRACE_H_
+#define PUBSUB_TRACE_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <time.h>
+
+#include "celix_bundle_context.h"
+
+/**
+ * Optional end-to-end latency tracing of pubsub msgs.
+ * A PSA with tracing support sends a pubsub_trace_context_t with a (sampled) msg, and exports a send span for the
+ * msg and a receive span per subscriber as OpenTelemetry (OTLP/JSON) spans, one ExportTraceServiceRequest per line
+ * in the trace file (the format of the OpenTelemetry collector file exporter/receiver).
+ * The send span covers the serialize and enqueue stages, the receive span the deserialize and subscriber callback
+ * stages. The gap between the two is the wire latency (note that the clocks of different hosts can differ).
+ * A msg published from a subscriber callback continues the trace of the received msg, with the receive span as
+ * parent, so a trace follows a msg through a multi-hop pipeline.
+ */
+
+/**
+ * Framework property to enable tracing for the PSAs with tracing support. Default false.
+ */
+#define PUBSUB_TRACE_ENABLED_KEY                "PUBSUB_TRACE_ENABLED"
+#define PUBSUB_TRACE_ENABLED_DEFAULT            false
+
+/**
+ * Framework property for the file the spans are appended to. Default "pubsub_spans.json" in the working dir.
+ */
+#define PUBSUB_TRACE_FILE_KEY                   "PUBSUB_TRACE_FILE"
+#define PUBSUB_TRACE_FILE_DEFAULT               "pubsub_spans.json"
+
+/**
+ * Framework property to trace only 1 out of N msgs of a topic sender. Default 1 (every msg).
+ * Msgs continuing a received trace are always traced.
+ */
+#define PUBSUB_TRACE_SAMPLE_INTERVAL_KEY        "PUBSUB_TRACE_SAMPLE_INTERVAL"
+#define PUBSUB_TRACE_SAMPLE_INTERVAL_DEFAULT    1
+
+/**
+ * The trace context as sent with a msg. Times are ns since epoch (CLOCK_REALTIME).
+ */
+typedef struct pubsub_trace_context {
+    uint8_t traceId[16];
+    uint8_t spanId[8]; //the send span
+    uint8_t parentSpanId[8]; //all zero if the msg did not continue a received trace
+    uint64_t serializeStart;
+    uint64_t serializeEnd;
+    uint64_t enqueueTime; //time the msg was handed to the transport
+} pubsub_trace_context_t;
+
+/**
+ * A receive span of a msg for a single subscriber. Times are ns since epoch (CLOCK_REALTIME), 0 if not reached.
+ */
+typedef struct pubsub_trace_receive_span {
+    uint8_t traceId[16];
+    uint8_t spanId[8];
+    uint8_t parentSpanId[8]; //the send span
+    uint64_t receiveTime;
+    uint64_t deserializeStart;
+    uint64_t deserializeEnd;
+    uint64_t callbackStart;
+    uint64_t callbackEnd;
+} pubsub_trace_receive_span_t;
+
+typedef struct pubsub_tracer pubsub_tracer_t;
+
+/**
+ * Creates a tracer for a topic sender or receiver. Returns NULL if tracing is disabled or the trace file cannot be
+ * opened.
+ */
+pubsub_tracer_t* pubsub_tracer_create(celix_bundle_context_t *ctx, const char *psaType, const char *scope, const char *topic);
+
+void pubsub_tracer_destroy(pubsub_tracer_t *tracer);
+
+/**
+ * Returns the current time in ns since epoch (CLOCK_REALTIME).
+ */
+uint64_t pubsub_trace_now(void);
+
+/**
+ * Returns whether the next msg should be traced. Returns false if the tracer is NULL.
+ * Thread safe.
+ */
+bool pubsub_tracer_sample(pubsub_tracer_t *tracer);
+
+/**
+ * Initializes the trace and span id of a trace context for a msg to send. If called from a subscriber callback of a
+ * traced msg, the trace id and the receive span (as parent) of the received msg are used.
+ */
+void pubsub_tracer_initContext(pubsub_tracer_t *tracer, pubsub_trace_context_t *context);
+
+/**
+ * Exports the send span of a msg. The span ends at sendEnd, the time the transport accepted the msg.
+ */
+void pubsub_tracer_exportSendSpan(pubsub_tracer_t *tracer, const char *msgFqn, const pubsub_trace_context_t *context, uint64_t sendEnd);
+
+/**
+ * Starts a receive span for a received trace context and makes it the current span of the calling thread, until
+ * pubsub_tracer_endReceiveSpan is called.
+ */
+void pubsub_tracer_beginReceiveSpan(pubsub_tracer_t *tracer, const pubsub_trace_context_t *context, const struct timespec *receiveTime, pubsub_trace_receive_span_t *span);
+
+/**
+ * Exports the receive span and clears the current span of the calling thread.
+ */
+void pubsub_tracer_endReceiveSpan(pubsub_tracer_t *tracer, const char *msgFqn, pubsub_trace_receive_span_t *span);
+
+#endif /* PUBSUB_TRACE_H_ */
@@ -23,6 +23,7 @@
 #include "bundle_context.h"
 #include "celix_array_list.h"
 #include "celix_bundle_context.h"
+#include "celix_threads.h"
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -30,6 +31,12 @@ extern "C" {
 #define PUBSUB_UTILS_QOS_TYPE_SAMPLE        "sample"    /* A.k.a. unreliable connection */
 #define PUBSUB_UTILS_QOS_TYPE_CONTROL       "control"   /* A.k.a. reliable connection */
 
+typedef enum pubsub_send_queue_policy {
+    PUBSUB_SEND_QUEUE_POLICY_DROP_NEWEST_TYPE = 0,
+    PUBSUB_SEND_QUEUE_POLICY_DROP_OLDEST_TYPE = 1,
+    PUBSUB_SEND_QUEUE_POLICY_BLOCK_TYPE = 2
+} pubsub_send_queue_policy_e;
+
 
 /**
  * Returns the pubsub info from the provided filter. A pubsub filter should have a topic and can 
@@ -155,6 +162,10 @@ bool pubsub_utils_matchEndpoint(
  * Will look at  META-INF/topics/pub/<topic>.properties for publisher and
  * META-INF/topics/sub/<topic>.properties for subscribers.
  *
+ * The read topic properties (and missing topic properties files) are cached per bundle revision, so repeated
+ * matches for the same bundle and topic do not read the file again. An updated bundle has a new revision and
+ * therefore does not use the cached topic properties of the previous revision.
+ *
  * The caller is owner of the returned topic properties.
  *
  * @param bundle         The bundle where the properties reside.
@@ -164,6 +175,33 @@ bool pubsub_utils_matchEndpoint(
  */
 celix_properties_t* pubsub_utils_getTopicProperties(const celix_bundle_t *bundle, const char *topic, bool isPublisher);
 
+/**
+ * Clears the topic properties cache of pubsub_utils_getTopicProperties.
+ * Should be called when the pubsub admin using the pubsub utils is destroyed.
+ */
+void pubsub_utils_clearTopicPropertiesCache(void);
+
+/**
+ * Returns the send queue policy configured in the topic properties (see PUBSUB_SEND_QUEUE_POLICY_KEY).
+ * If no policy is configured, the default for the qos of the topic is returned.
+ *
+ * @param topicProperties   The topic properties, can be NULL.
+ * @return                  The send queue policy.
+ */
+pubsub_send_queue_policy_e pubsub_utils_getSendQueuePolicy(const celix_properties_t *topicProperties);
+
+/**
+ * Applies the thread scheduling policy, realtime priority and cpu affinity configured in the topic properties
+ * (see PUBSUB_THREAD_REALTIME_SCHED_KEY, PUBSUB_THREAD_REALTIME_PRIO_KEY and PUBSUB_THREAD_CPU_AFFINITY_KEY) to a
+ * (receive) thread of the topic. Nothing is changed for settings which are not configured.
+ *
+ * @param thread            The thread to configure.
+ * @param topicProperties   The topic properties, can be NULL.
+ * @return                  CELIX_SUCCESS, CELIX_ILLEGAL_ARGUMENT for an invalid setting or the error of
+ *                          pthread_setschedparam/pthread_setaffinity_np (e.g. EPERM without CAP_SYS_NICE).
+ */
+celix_status_t pubsub_utils_setupThread(celix_thread_t *thread, const celix_properties_t *topicProperties);
+
 #ifdef __cplusplus
 }
 #endif
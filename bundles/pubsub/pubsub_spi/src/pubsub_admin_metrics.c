@@ -17,35 +17,83 @@
  * under the License.
  */
 
-#if defined(__MACH__)
-#include <stdlib.h>
-#else
-#include <malloc.h>
-#endif
-#include <pubsub_admin_metrics.h>
 #include "pubsub_admin_metrics.h"
 
-void pubsub_freePubSubAdminMetrics(pubsub_admin_metrics_t *metrics) {
-    if (metrics != NULL) {
-        if (metrics->receivers != NULL) {
-            for (int i = 0; i < celix_arrayList_size(metrics->receivers); ++i) {
-                pubsub_admin_receiver_metrics_t *m = celix_arrayList_get(metrics->receivers, i);
-                for (int k = 0; k < m->nrOfMsgTypes; ++k) {
-                    free(m->msgTypes[k].origins);
-                }
-                free(m->msgTypes);
-                free(m);
-            }
-            celix_arrayList_destroy(metrics->receivers);
-        }
-        if (metrics->senders != NULL) {
-            for (int i = 0; i < celix_arrayList_size(metrics->senders); ++i) {
-                pubsub_admin_sender_metrics_t *m = celix_arrayList_get(metrics->senders, i);
-                free(m->msgMetrics);
-                free(m);
-            }
-            celix_arrayList_destroy(metrics->senders);
+static unsigned int pubsub_metricsHistogram_bucketIndex(uint64_t value) {
+    if (value < 4) {
+        return (unsigned int) value;
+    }
+    unsigned int msb = 63u - (unsigned int) __builtin_clzll(value);
+    if (msb > 32) {
+        return PUBSUB_METRICS_HISTOGRAM_SIZE - 1;
+    }
+    unsigned int sub = (unsigned int) (value >> (msb - 2u)) & 3u;
+    return (msb - 1u) * 4u + sub;
+}
+
+static uint64_t pubsub_metricsHistogram_bucketUpperBound(unsigned int index) {
+    if (index < 4) {
+        return index;
+    }
+    unsigned int msb = index / 4u + 1u;
+    uint64_t sub = index % 4u;
+    return ((4u + sub + 1u) << (msb - 2u)) - 1u;
+}
+
+/**
+ * Note the relaxed atomic loads/stores are plain moves on common platforms, they only make the (single writer)
+ * record safe to combine with a concurrent pubsub_metricsHistogram_copy.
+ */
+#define HISTOGRAM_LOAD(field) __atomic_load_n(&(field), __ATOMIC_RELAXED)
+#define HISTOGRAM_STORE(field, val) __atomic_store_n(&(field), (val), __ATOMIC_RELAXED)
+
+void pubsub_metricsHistogram_record(pubsub_metrics_histogram_t *histogram, uint64_t valueInNs) {
+    uint64_t count = HISTOGRAM_LOAD(histogram->count);
+    if (count == 0 || valueInNs < HISTOGRAM_LOAD(histogram->minInNs)) {
+        HISTOGRAM_STORE(histogram->minInNs, valueInNs);
+    }
+    if (valueInNs > HISTOGRAM_LOAD(histogram->maxInNs)) {
+        HISTOGRAM_STORE(histogram->maxInNs, valueInNs);
+    }
+    unsigned int index = pubsub_metricsHistogram_bucketIndex(valueInNs);
+    HISTOGRAM_STORE(histogram->buckets[index], HISTOGRAM_LOAD(histogram->buckets[index]) + 1);
+    HISTOGRAM_STORE(histogram->sumInNs, HISTOGRAM_LOAD(histogram->sumInNs) + valueInNs);
+    HISTOGRAM_STORE(histogram->count, count + 1);
+}
+
+void pubsub_metricsHistogram_copy(pubsub_metrics_histogram_t *copy, const pubsub_metrics_histogram_t *histogram) {
+    copy->count = HISTOGRAM_LOAD(histogram->count);
+    copy->sumInNs = HISTOGRAM_LOAD(histogram->sumInNs);
+    copy->minInNs = HISTOGRAM_LOAD(histogram->minInNs);
+    copy->maxInNs = HISTOGRAM_LOAD(histogram->maxInNs);
+    for (unsigned int i = 0; i < PUBSUB_METRICS_HISTOGRAM_SIZE; ++i) {
+        copy->buckets[i] = HISTOGRAM_LOAD(histogram->buckets[i]);
+    }
+}
+
+uint64_t pubsub_metricsHistogram_valueAtPercentile(const pubsub_metrics_histogram_t *histogram, double percentile) {
+    if (histogram->count == 0) {
+        return 0;
+    }
+    uint64_t rank = (uint64_t) ((percentile / 100.0) * (double) histogram->count + 0.5);
+    if (rank < 1) {
+        rank = 1;
+    }
+    uint64_t seen = 0;
+    for (unsigned int i = 0; i < PUBSUB_METRICS_HISTOGRAM_SIZE; ++i) {
+        seen += histogram->buckets[i];
+        if (seen >= rank) {
+            uint64_t upper = i < PUBSUB_METRICS_HISTOGRAM_SIZE - 1 ? pubsub_metricsHistogram_bucketUpperBound(i) : histogram->maxInNs;
+            return upper < histogram->maxInNs ? upper : histogram->maxInNs;
         }
-        free(metrics);
     }
-}
\ No newline at end of file
+    return histogram->maxInNs;
+}
+
+bool pubsub_metrics_changedSince(const pubsub_metrics_entry_t *entry, const struct timespec *changedSince) {
+    if (changedSince == NULL || entry->type == PUBSUB_METRICS_TOPIC_SENDER) {
+        return true;
+    }
+    return entry->lastMessage.tv_sec > changedSince->tv_sec ||
+           (entry->lastMessage.tv_sec == changedSince->tv_sec && entry->lastMessage.tv_nsec > changedSince->tv_nsec);
+}
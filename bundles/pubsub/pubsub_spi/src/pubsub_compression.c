@@ -0,0 +1,224 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *  KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <zlib.h>
+
+#include "celix_threads.h"
+#include "pubsub_constants.h"
+#include "pubsub_compression.h"
+
+#define PUBSUB_COMPRESSION_SIZE_PREFIX_LEN      4
+#define PUBSUB_COMPRESSION_MAX_DICTIONARY_SIZE  (32 * 1024) //note zlib only uses the last 32K of a dictionary
+#define PUBSUB_COMPRESSION_MAX_PAYLOAD_SIZE     UINT32_MAX
+
+struct pubsub_compressor {
+    celix_thread_mutex_t mutex; //protects the streams
+    bool compress;
+    size_t minSize;
+    unsigned char *dictionary;
+    size_t dictionarySize;
+    bool deflateInitialized;
+    z_stream deflateStream;
+    bool inflateInitialized;
+    z_stream inflateStream;
+};
+
+static bool pubsub_compressor_readDictionary(pubsub_compressor_t *compressor, const char *path) {
+    FILE *file = fopen(path, "rb");
+    if (file == NULL) {
+        fprintf(stderr, "[PSA] Cannot open compression dictionary %s\n", path);
+        return false;
+    }
+    compressor->dictionary = malloc(PUBSUB_COMPRESSION_MAX_DICTIONARY_SIZE);
+    compressor->dictionarySize = fread(compressor->dictionary, 1, PUBSUB_COMPRESSION_MAX_DICTIONARY_SIZE, file);
+    fclose(file);
+    if (compressor->dictionarySize == 0) {
+        fprintf(stderr, "[PSA] Empty compression dictionary %s\n", path);
+        return false;
+    }
+    return true;
+}
+
+static pubsub_compressor_t* pubsub_compressor_createInternal(const celix_properties_t *topicProperties, bool compress) {
+    pubsub_compressor_t *compressor = calloc(1, sizeof(*compressor));
+    compressor->compress = compress;
+    celixThreadMutex_create(&compressor->mutex, NULL);
+    const char *dictionary = celix_properties_get(topicProperties, PUBSUB_COMPRESSION_DICTIONARY_KEY, NULL);
+    bool ok = dictionary == NULL || pubsub_compressor_readDictionary(compressor, dictionary);
+    if (ok && compress) {
+        long level = celix_properties_getAsLong(topicProperties, PUBSUB_COMPRESSION_LEVEL_KEY, PUBSUB_COMPRESSION_LEVEL_DEFAULT);
+        long minSize = celix_properties_getAsLong(topicProperties, PUBSUB_COMPRESSION_MIN_SIZE_KEY, PUBSUB_COMPRESSION_MIN_SIZE_DEFAULT);
+        compressor->minSize = minSize > 0 ? (size_t) minSize : 0;
+        ok = deflateInit(&compressor->deflateStream, (int) level) == Z_OK;
+        compressor->deflateInitialized = ok;
+        if (!ok) {
+            fprintf(stderr, "[PSA] Invalid compression level %li\n", level);
+        }
+    }
+    if (ok) {
+        ok = inflateInit(&compressor->inflateStream) == Z_OK;
+        compressor->inflateInitialized = ok;
+    }
+    if (!ok) {
+        pubsub_compressor_destroy(compressor);
+        compressor = NULL;
+    }
+    return compressor;
+}
+
+pubsub_compressor_t* pubsub_compressor_create(const celix_properties_t *topicProperties) {
+    const char *compression = celix_properties_get(topicProperties, PUBSUB_COMPRESSION_KEY, PUBSUB_COMPRESSION_DEFAULT);
+    if (strcmp(compression, PUBSUB_COMPRESSION_DEFLATE) != 0) {
+        if (strcmp(compression, PUBSUB_COMPRESSION_NONE) != 0) {
+            fprintf(stderr, "[PSA] Unsupported compression '%s', sending uncompressed msgs\n", compression);
+        }
+        return NULL;
+    }
+    return pubsub_compressor_createInternal(topicProperties, true);
+}
+
+pubsub_compressor_t* pubsub_decompressor_create(const celix_properties_t *topicProperties) {
+    return pubsub_compressor_createInternal(topicProperties, false);
+}
+
+void pubsub_compressor_destroy(pubsub_compressor_t *compressor) {
+    if (compressor != NULL) {
+        if (compressor->deflateInitialized) {
+            deflateEnd(&compressor->deflateStream);
+        }
+        if (compressor->inflateInitialized) {
+            inflateEnd(&compressor->inflateStream);
+        }
+        free(compressor->dictionary);
+        celixThreadMutex_destroy(&compressor->mutex);
+        free(compressor);
+    }
+}
+
+bool pubsub_compressor_compress(pubsub_compressor_t *compressor, const void *payload, size_t payloadSize, void **out, size_t *outSize) {
+    if (compressor == NULL || !compressor->compress || payloadSize < compressor->minSize || payloadSize > PUBSUB_COMPRESSION_MAX_PAYLOAD_SIZE) {
+        return false;
+    }
+
+    //note only a compressed payload smaller than the uncompressed payload is useful
+    size_t maxSize = payloadSize - 1;
+    if (maxSize <= PUBSUB_COMPRESSION_SIZE_PREFIX_LEN) {
+        return false;
+    }
+    unsigned char *buffer = malloc(maxSize);
+    if (buffer == NULL) {
+        return false;
+    }
+    uint32_t size = (uint32_t) payloadSize;
+    for (int i = 0; i < PUBSUB_COMPRESSION_SIZE_PREFIX_LEN; ++i) {
+        buffer[i] = (unsigned char) (size >> (8 * i));
+    }
+
+    celixThreadMutex_lock(&compressor->mutex);
+    z_stream *stream = &compressor->deflateStream;
+    deflateReset(stream);
+    int rc = Z_OK;
+    if (compressor->dictionary != NULL) {
+        rc = deflateSetDictionary(stream, compressor->dictionary, (uInt) compressor->dictionarySize);
+    }
+    if (rc == Z_OK) {
+        stream->next_in = (Bytef *) payload;
+        stream->avail_in = (uInt) payloadSize;
+        stream->next_out = buffer + PUBSUB_COMPRESSION_SIZE_PREFIX_LEN;
+        stream->avail_out = (uInt) (maxSize - PUBSUB_COMPRESSION_SIZE_PREFIX_LEN);
+        rc = deflate(stream, Z_FINISH);
+    }
+    size_t compressedSize = maxSize - stream->avail_out;
+    celixThreadMutex_unlock(&compressor->mutex);
+
+    if (rc != Z_STREAM_END) {
+        //note also the case if the compressed payload does not fit in maxSize
+        free(buffer);
+        return false;
+    }
+    *out = buffer;
+    *outSize = compressedSize;
+    return true;
+}
+
+static int pubsub_compressor_inflate(z_stream *stream, const unsigned char *dictionary, size_t dictionarySize) {
+    int rc = inflate(stream, Z_FINISH);
+    if (rc == Z_NEED_DICT) {
+        if (dictionary == NULL) {
+            return Z_DATA_ERROR;
+        }
+        rc = inflateSetDictionary(stream, dictionary, (uInt) dictionarySize);
+        if (rc == Z_OK) {
+            rc = inflate(stream, Z_FINISH);
+        }
+    }
+    return rc;
+}
+
+celix_status_t pubsub_compressor_decompress(pubsub_compressor_t *decompressor, const void *payload, size_t payloadSize, void **out, size_t *outSize) {
+    const unsigned char *data = payload;
+    if (payloadSize <= PUBSUB_COMPRESSION_SIZE_PREFIX_LEN) {
+        return CELIX_ILLEGAL_ARGUMENT;
+    }
+    uint32_t size = 0;
+    for (int i = 0; i < PUBSUB_COMPRESSION_SIZE_PREFIX_LEN; ++i) {
+        size |= (uint32_t) data[i] << (8 * i);
+    }
+    unsigned char *buffer = malloc(size > 0 ? size : 1);
+    if (buffer == NULL) {
+        return CELIX_ENOMEM;
+    }
+
+    z_stream localStream;
+    z_stream *stream = &localStream;
+    if (decompressor != NULL) {
+        celixThreadMutex_lock(&decompressor->mutex);
+        stream = &decompressor->inflateStream;
+        inflateReset(stream);
+    } else {
+        memset(&localStream, 0, sizeof(localStream));
+        if (inflateInit(&localStream) != Z_OK) {
+            free(buffer);
+            return CELIX_ENOMEM;
+        }
+    }
+    stream->next_in = (Bytef *) data + PUBSUB_COMPRESSION_SIZE_PREFIX_LEN;
+    stream->avail_in = (uInt) (payloadSize - PUBSUB_COMPRESSION_SIZE_PREFIX_LEN);
+    stream->next_out = buffer;
+    stream->avail_out = (uInt) size;
+    int rc = pubsub_compressor_inflate(stream, decompressor != NULL ? decompressor->dictionary : NULL,
+                                       decompressor != NULL ? decompressor->dictionarySize : 0);
+    bool complete = rc == Z_STREAM_END && stream->avail_out == 0;
+    if (decompressor != NULL) {
+        celixThreadMutex_unlock(&decompressor->mutex);
+    } else {
+        inflateEnd(&localStream);
+    }
+
+    if (!complete) {
+        free(buffer);
+        return CELIX_ILLEGAL_ARGUMENT;
+    }
+    *out = buffer;
+    *outSize = size;
+    return CELIX_SUCCESS;
+}
@@ -0,0 +1,288 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *  KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "celix_threads.h"
+#include "celix_thread_pool.h"
+#include "pubsub_constants.h"
+#include "pubsub_dispatcher.h"
+
+#define PUBSUB_DISPATCH_MAX_BATCH   64 //max nr of msgs dispatched by a single pool job, so that queues are processed fairly
+
+struct pubsub_dispatcher {
+    char *name;
+    size_t queueSize;
+    bool conflate;
+    celix_thread_pool_t *pool; //NULL for the "subscriber" dispatch mode
+};
+
+struct pubsub_dispatch_queue {
+    pubsub_dispatcher_t *dispatcher;
+    void *handle;
+    pubsub_dispatch_fp dispatch;
+
+    celix_thread_mutex_t mutex; //protects below
+    celix_thread_cond_t cond;
+    pubsub_dispatch_msg_t **msgs; //circular buffer
+    unsigned int *nrOfConflatedMsgs; //per msgs slot, the nr of msgs replaced by the queued msg
+    size_t head;
+    size_t size;
+    bool running;
+    bool scheduled; //pool mode: true if a dispatch job for this queue is queued or running
+    bool hasThread;
+    celix_thread_t thread;
+};
+
+struct pubsub_dispatch_msg {
+    unsigned int refCount;
+    void *header;
+    void *payload;
+    size_t payloadSize;
+    struct timespec receiveTime;
+    size_t conflationKeySize; //0 if the msg is never conflated
+    unsigned char conflationKey[PUBSUB_DISPATCH_MAX_CONFLATION_KEY_SIZE];
+};
+
+pubsub_dispatcher_t* pubsub_dispatcher_create(const celix_properties_t *topicProperties, const char *name) {
+    const char *mode = topicProperties == NULL ? NULL : celix_properties_get(topicProperties, PUBSUB_DISPATCH_MODE_KEY, NULL);
+    bool subscriberMode = mode != NULL && strncmp(mode, PUBSUB_DISPATCH_MODE_SUBSCRIBER, strlen(PUBSUB_DISPATCH_MODE_SUBSCRIBER) + 1) == 0;
+    bool poolMode = mode != NULL && strncmp(mode, PUBSUB_DISPATCH_MODE_POOL, strlen(PUBSUB_DISPATCH_MODE_POOL) + 1) == 0;
+    bool conflate = topicProperties != NULL && celix_properties_getAsBool((celix_properties_t *) topicProperties, PUBSUB_DISPATCH_CONFLATE_KEY, PUBSUB_DISPATCH_CONFLATE_DEFAULT);
+    if (conflate && mode == NULL) {
+        subscriberMode = true;
+    }
+    if (!subscriberMode && !poolMode) {
+        return NULL;
+    }
+
+    pubsub_dispatcher_t *dispatcher = calloc(1, sizeof(*dispatcher));
+    dispatcher->name = strndup(name, 1024);
+    dispatcher->conflate = conflate;
+    long queueSize = celix_properties_getAsLong(topicProperties, PUBSUB_DISPATCH_QUEUE_SIZE_KEY, PUBSUB_DISPATCH_QUEUE_SIZE_DEFAULT);
+    dispatcher->queueSize = queueSize > 0 ? (size_t) queueSize : PUBSUB_DISPATCH_QUEUE_SIZE_DEFAULT;
+    if (poolMode) {
+        long poolSize = celix_properties_getAsLong(topicProperties, PUBSUB_DISPATCH_POOL_SIZE_KEY, PUBSUB_DISPATCH_POOL_SIZE_DEFAULT);
+        celix_thread_pool_options_t opts = CELIX_EMPTY_THREAD_POOL_OPTIONS;
+        opts.nrOfThreads = poolSize > 0 ? (size_t) poolSize : 0;
+        opts.name = dispatcher->name;
+        dispatcher->pool = celix_threadPool_create(&opts);
+        if (dispatcher->pool == NULL) {
+            free(dispatcher->name);
+            free(dispatcher);
+            dispatcher = NULL;
+        }
+    }
+    return dispatcher;
+}
+
+void pubsub_dispatcher_destroy(pubsub_dispatcher_t *dispatcher) {
+    if (dispatcher != NULL) {
+        if (dispatcher->pool != NULL) {
+            celix_threadPool_destroy(dispatcher->pool);
+        }
+        free(dispatcher->name);
+        free(dispatcher);
+    }
+}
+
+static pubsub_dispatch_msg_t* pubsub_dispatchQueue_pop(pubsub_dispatch_queue_t *queue, unsigned int *nrOfConflatedMsgs) {
+    //note queue->mutex locked and size > 0
+    pubsub_dispatch_msg_t *msg = queue->msgs[queue->head];
+    *nrOfConflatedMsgs = queue->nrOfConflatedMsgs[queue->head];
+    queue->msgs[queue->head] = NULL;
+    queue->nrOfConflatedMsgs[queue->head] = 0;
+    queue->head = (queue->head + 1) % queue->dispatcher->queueSize;
+    queue->size -= 1;
+    return msg;
+}
+
+static void pubsub_dispatchQueue_dispatch(pubsub_dispatch_queue_t *queue, pubsub_dispatch_msg_t *msg, unsigned int nrOfConflatedMsgs) {
+    queue->dispatch(queue->handle, msg->header, msg->payload, msg->payloadSize, &msg->receiveTime, nrOfConflatedMsgs);
+    pubsub_dispatchMsg_release(msg);
+}
+
+/**
+ * Replaces the queued msg with the same conflation key as msg, if any.
+ */
+static bool pubsub_dispatchQueue_conflate(pubsub_dispatch_queue_t *queue, pubsub_dispatch_msg_t *msg) {
+    //note queue->mutex locked
+    for (size_t i = 0; i < queue->size; ++i) {
+        size_t index = (queue->head + i) % queue->dispatcher->queueSize;
+        pubsub_dispatch_msg_t *queued = queue->msgs[index];
+        if (queued->conflationKeySize == msg->conflationKeySize && memcmp(queued->conflationKey, msg->conflationKey, msg->conflationKeySize) == 0) {
+            __atomic_fetch_add(&msg->refCount, 1, __ATOMIC_RELAXED);
+            queue->msgs[index] = msg;
+            queue->nrOfConflatedMsgs[index] += 1;
+            pubsub_dispatchMsg_release(queued);
+            return true;
+        }
+    }
+    return false;
+}
+
+static void* pubsub_dispatchQueue_thread(void *data) {
+    pubsub_dispatch_queue_t *queue = data;
+    celixThreadMutex_lock(&queue->mutex);
+    while (queue->running) {
+        if (queue->size == 0) {
+            celixThreadCondition_wait(&queue->cond, &queue->mutex);
+            continue;
+        }
+        unsigned int nrOfConflatedMsgs;
+        pubsub_dispatch_msg_t *msg = pubsub_dispatchQueue_pop(queue, &nrOfConflatedMsgs);
+        celixThreadMutex_unlock(&queue->mutex);
+        pubsub_dispatchQueue_dispatch(queue, msg, nrOfConflatedMsgs);
+        celixThreadMutex_lock(&queue->mutex);
+    }
+    celixThreadMutex_unlock(&queue->mutex);
+    return NULL;
+}
+
+static void* pubsub_dispatchQueue_poolJob(void *data) {
+    pubsub_dispatch_queue_t *queue = data;
+    for (int i = 0; i < PUBSUB_DISPATCH_MAX_BATCH; ++i) {
+        celixThreadMutex_lock(&queue->mutex);
+        if (!queue->running || queue->size == 0) {
+            queue->scheduled = false;
+            celixThreadCondition_broadcast(&queue->cond);
+            celixThreadMutex_unlock(&queue->mutex);
+            return NULL;
+        }
+        unsigned int nrOfConflatedMsgs;
+        pubsub_dispatch_msg_t *msg = pubsub_dispatchQueue_pop(queue, &nrOfConflatedMsgs);
+        celixThreadMutex_unlock(&queue->mutex);
+        pubsub_dispatchQueue_dispatch(queue, msg, nrOfConflatedMsgs);
+    }
+
+    //batch done, reschedule (at the end of the worker queue) if there are more msgs
+    celixThreadMutex_lock(&queue->mutex);
+    celix_status_t rc = CELIX_ILLEGAL_STATE;
+    if (queue->running && queue->size > 0) {
+        rc = celix_threadPool_execute(queue->dispatcher->pool, pubsub_dispatchQueue_poolJob, queue, NULL, NULL);
+    }
+    if (rc != CELIX_SUCCESS) {
+        queue->scheduled = false;
+        celixThreadCondition_broadcast(&queue->cond);
+    }
+    celixThreadMutex_unlock(&queue->mutex);
+    return NULL;
+}
+
+pubsub_dispatch_queue_t* pubsub_dispatcher_createQueue(pubsub_dispatcher_t *dispatcher, void *handle, pubsub_dispatch_fp dispatch) {
+    pubsub_dispatch_queue_t *queue = calloc(1, sizeof(*queue));
+    queue->dispatcher = dispatcher;
+    queue->handle = handle;
+    queue->dispatch = dispatch;
+    queue->msgs = calloc(dispatcher->queueSize, sizeof(*queue->msgs));
+    queue->nrOfConflatedMsgs = calloc(dispatcher->queueSize, sizeof(*queue->nrOfConflatedMsgs));
+    queue->running = true;
+    celixThreadMutex_create(&queue->mutex, NULL);
+    celixThreadCondition_init(&queue->cond, NULL);
+
+    if (dispatcher->pool == NULL) {
+        if (celixThread_create(&queue->thread, NULL, pubsub_dispatchQueue_thread, queue) == CELIX_SUCCESS) {
+            queue->hasThread = true;
+            celixThread_setName(&queue->thread, dispatcher->name);
+        } else {
+            queue->running = false;
+        }
+    }
+    return queue;
+}
+
+void pubsub_dispatchQueue_destroy(pubsub_dispatch_queue_t *queue) {
+    if (queue == NULL) {
+        return;
+    }
+
+    celixThreadMutex_lock(&queue->mutex);
+    queue->running = false;
+    celixThreadCondition_broadcast(&queue->cond);
+    if (queue->hasThread) {
+        celixThreadMutex_unlock(&queue->mutex);
+        celixThread_join(queue->thread, NULL);
+        celixThreadMutex_lock(&queue->mutex);
+    }
+    while (queue->scheduled) {
+        celixThreadCondition_wait(&queue->cond, &queue->mutex);
+    }
+    while (queue->size > 0) {
+        unsigned int nrOfConflatedMsgs;
+        pubsub_dispatchMsg_release(pubsub_dispatchQueue_pop(queue, &nrOfConflatedMsgs));
+    }
+    celixThreadMutex_unlock(&queue->mutex);
+
+    celixThreadMutex_destroy(&queue->mutex);
+    celixThreadCondition_destroy(&queue->cond);
+    free(queue->msgs);
+    free(queue->nrOfConflatedMsgs);
+    free(queue);
+}
+
+bool pubsub_dispatchQueue_enqueue(pubsub_dispatch_queue_t *queue, pubsub_dispatch_msg_t *msg) {
+    bool enqueued = false;
+    celixThreadMutex_lock(&queue->mutex);
+    if (queue->running && queue->dispatcher->conflate && msg->conflationKeySize > 0 && pubsub_dispatchQueue_conflate(queue, msg)) {
+        //replaced a queued msg, which is already signalled/scheduled
+        enqueued = true;
+    } else if (queue->running && queue->size < queue->dispatcher->queueSize) {
+        __atomic_fetch_add(&msg->refCount, 1, __ATOMIC_RELAXED);
+        queue->msgs[(queue->head + queue->size) % queue->dispatcher->queueSize] = msg;
+        queue->size += 1;
+        enqueued = true;
+        if (queue->hasThread) {
+            celixThreadCondition_signal(&queue->cond);
+        } else if (!queue->scheduled) {
+            //note the pool queue is unbounded, so this does not block
+            queue->scheduled = celix_threadPool_execute(queue->dispatcher->pool, pubsub_dispatchQueue_poolJob, queue, NULL, NULL) == CELIX_SUCCESS;
+        }
+    }
+    celixThreadMutex_unlock(&queue->mutex);
+    return enqueued;
+}
+
+pubsub_dispatch_msg_t* pubsub_dispatchMsg_create(const void *header, size_t headerSize, const void *payload, size_t payloadSize, const struct timespec *receiveTime) {
+    pubsub_dispatch_msg_t *msg = malloc(sizeof(*msg) + headerSize + payloadSize);
+    msg->refCount = 1;
+    msg->header = (char*)msg + sizeof(*msg);
+    msg->payload = (char*)msg->header + headerSize;
+    msg->payloadSize = payloadSize;
+    msg->receiveTime = *receiveTime;
+    msg->conflationKeySize = 0;
+    memcpy(msg->header, header, headerSize);
+    memcpy(msg->payload, payload, payloadSize);
+    return msg;
+}
+
+celix_status_t pubsub_dispatchMsg_setConflationKey(pubsub_dispatch_msg_t *msg, const void *key, size_t keySize) {
+    if (keySize > sizeof(msg->conflationKey)) {
+        return CELIX_ILLEGAL_ARGUMENT;
+    }
+    memcpy(msg->conflationKey, key, keySize);
+    msg->conflationKeySize = keySize;
+    return CELIX_SUCCESS;
+}
+
+void pubsub_dispatchMsg_release(pubsub_dispatch_msg_t *msg) {
+    if (msg != NULL && __atomic_sub_fetch(&msg->refCount, 1, __ATOMIC_ACQ_REL) == 0) {
+        free(msg);
+    }
+}
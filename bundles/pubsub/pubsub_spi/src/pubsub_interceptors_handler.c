@@ -0,0 +1,174 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *  KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "celix_constants.h"
+
+#include "pubsub_interceptors_handler.h"
+
+typedef struct pubsub_interceptor_entry {
+    long svcId;
+    long ranking;
+    pubsub_interceptor_t *svc;
+} pubsub_interceptor_entry_t;
+
+static int pubsub_interceptorsHandler_compareEntries(celix_array_list_entry_t a, celix_array_list_entry_t b) {
+    const pubsub_interceptor_entry_t *entryA = a.voidPtrVal;
+    const pubsub_interceptor_entry_t *entryB = b.voidPtrVal;
+    if (entryA->ranking != entryB->ranking) {
+        return entryA->ranking > entryB->ranking ? -1 : 1;
+    }
+    //same ranking, the oldest service first
+    return entryA->svcId < entryB->svcId ? -1 : (entryA->svcId > entryB->svcId ? 1 : 0);
+}
+
+/**
+ * Sorts the entries and rebuilds the cached array of interceptors.
+ */
+static void pubsub_interceptorsHandler_updateInterceptors(pubsub_interceptors_handler_t *handler) {
+    //note handler->lock write locked
+    celix_arrayList_sort(handler->entries, pubsub_interceptorsHandler_compareEntries);
+    int size = celix_arrayList_size(handler->entries);
+    pubsub_interceptor_t **interceptors = size > 0 ? realloc(handler->interceptors, size * sizeof(*interceptors)) : NULL;
+    if (size > 0 && interceptors == NULL) {
+        return; //keep the previous interceptors
+    }
+    if (size == 0) {
+        free(handler->interceptors);
+    }
+    for (int i = 0; i < size; ++i) {
+        pubsub_interceptor_entry_t *entry = celix_arrayList_get(handler->entries, i);
+        interceptors[i] = entry->svc;
+    }
+    handler->interceptors = interceptors;
+    __atomic_store_n(&handler->nrOfInterceptors, (size_t) size, __ATOMIC_RELEASE);
+}
+
+static void pubsub_interceptorsHandler_addInterceptor(void *handle, void *svc, const celix_properties_t *props) {
+    pubsub_interceptors_handler_t *handler = handle;
+    pubsub_interceptor_entry_t *entry = calloc(1, sizeof(*entry));
+    entry->svcId = celix_properties_getAsLong(props, OSGI_FRAMEWORK_SERVICE_ID, -1L);
+    entry->ranking = celix_properties_getAsLong(props, OSGI_FRAMEWORK_SERVICE_RANKING, 0L);
+    entry->svc = svc;
+    celixThreadRwlock_writeLock(&handler->lock);
+    celix_arrayList_add(handler->entries, entry);
+    pubsub_interceptorsHandler_updateInterceptors(handler);
+    celixThreadRwlock_unlock(&handler->lock);
+}
+
+static void pubsub_interceptorsHandler_removeInterceptor(void *handle, void *svc, const celix_properties_t *props) {
+    pubsub_interceptors_handler_t *handler = handle;
+    long svcId = celix_properties_getAsLong(props, OSGI_FRAMEWORK_SERVICE_ID, -1L);
+    celixThreadRwlock_writeLock(&handler->lock);
+    for (int i = 0; i < celix_arrayList_size(handler->entries); ++i) {
+        pubsub_interceptor_entry_t *entry = celix_arrayList_get(handler->entries, i);
+        if (entry->svcId == svcId && entry->svc == svc) {
+            celix_arrayList_removeAt(handler->entries, i);
+            free(entry);
+            break;
+        }
+    }
+    pubsub_interceptorsHandler_updateInterceptors(handler);
+    celixThreadRwlock_unlock(&handler->lock);
+}
+
+pubsub_interceptors_handler_t* pubsub_interceptorsHandler_create(celix_bundle_context_t *ctx, const char *psaType, const char *scope, const char *topic) {
+    pubsub_interceptors_handler_t *handler = calloc(1, sizeof(*handler));
+    handler->ctx = ctx;
+    handler->properties.psaType = strndup(psaType, 1024 * 1024);
+    handler->properties.scope = scope == NULL ? NULL : strndup(scope, 1024 * 1024);
+    handler->properties.topic = strndup(topic, 1024 * 1024);
+    handler->entries = celix_arrayList_create();
+    celixThreadRwlock_create(&handler->lock, NULL);
+
+    celix_service_tracking_options_t opts = CELIX_EMPTY_SERVICE_TRACKING_OPTIONS;
+    opts.filter.serviceName = PUBSUB_INTERCEPTOR_SERVICE_NAME;
+    opts.filter.versionRange = PUBSUB_INTERCEPTOR_SERVICE_RANGE;
+    opts.callbackHandle = handler;
+    opts.addWithProperties = pubsub_interceptorsHandler_addInterceptor;
+    opts.removeWithProperties = pubsub_interceptorsHandler_removeInterceptor;
+    handler->trackerId = celix_bundleContext_trackServicesWithOptions(ctx, &opts);
+    return handler;
+}
+
+void pubsub_interceptorsHandler_destroy(pubsub_interceptors_handler_t *handler) {
+    if (handler != NULL) {
+        celix_bundleContext_stopTracker(handler->ctx, handler->trackerId);
+        for (int i = 0; i < celix_arrayList_size(handler->entries); ++i) {
+            free(celix_arrayList_get(handler->entries, i));
+        }
+        celix_arrayList_destroy(handler->entries);
+        free(handler->interceptors);
+        celixThreadRwlock_destroy(&handler->lock);
+        free((char *) handler->properties.psaType);
+        free((char *) handler->properties.scope);
+        free((char *) handler->properties.topic);
+        free(handler);
+    }
+}
+
+bool pubsub_interceptorsHandler_invokePreSend(pubsub_interceptors_handler_t *handler, const pubsub_interceptor_msg_header_t *header, const void *payload, size_t payloadSize) {
+    bool cont = true;
+    celixThreadRwlock_readLock(&handler->lock);
+    for (size_t i = 0; cont && i < handler->nrOfInterceptors; ++i) {
+        pubsub_interceptor_t *interceptor = handler->interceptors[i];
+        if (interceptor->preSend != NULL) {
+            cont = interceptor->preSend(interceptor->handle, &handler->properties, header, payload, payloadSize);
+        }
+    }
+    celixThreadRwlock_unlock(&handler->lock);
+    return cont;
+}
+
+void pubsub_interceptorsHandler_invokePostSend(pubsub_interceptors_handler_t *handler, const pubsub_interceptor_msg_header_t *header, size_t payloadSize, celix_status_t status) {
+    celixThreadRwlock_readLock(&handler->lock);
+    for (size_t i = handler->nrOfInterceptors; i > 0; --i) {
+        pubsub_interceptor_t *interceptor = handler->interceptors[i - 1];
+        if (interceptor->postSend != NULL) {
+            interceptor->postSend(interceptor->handle, &handler->properties, header, payloadSize, status);
+        }
+    }
+    celixThreadRwlock_unlock(&handler->lock);
+}
+
+bool pubsub_interceptorsHandler_invokePreReceive(pubsub_interceptors_handler_t *handler, const pubsub_interceptor_msg_header_t *header, const void *payload, size_t payloadSize) {
+    bool cont = true;
+    celixThreadRwlock_readLock(&handler->lock);
+    for (size_t i = 0; cont && i < handler->nrOfInterceptors; ++i) {
+        pubsub_interceptor_t *interceptor = handler->interceptors[i];
+        if (interceptor->preReceive != NULL) {
+            cont = interceptor->preReceive(interceptor->handle, &handler->properties, header, payload, payloadSize);
+        }
+    }
+    celixThreadRwlock_unlock(&handler->lock);
+    return cont;
+}
+
+void pubsub_interceptorsHandler_invokePostReceive(pubsub_interceptors_handler_t *handler, const pubsub_interceptor_msg_header_t *header, const void *payload, size_t payloadSize) {
+    celixThreadRwlock_readLock(&handler->lock);
+    for (size_t i = handler->nrOfInterceptors; i > 0; --i) {
+        pubsub_interceptor_t *interceptor = handler->interceptors[i - 1];
+        if (interceptor->postReceive != NULL) {
+            interceptor->postReceive(interceptor->handle, &handler->properties, header, payload, payloadSize);
+        }
+    }
+    celixThreadRwlock_unlock(&handler->lock);
+}
@@ -0,0 +1,72 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *  KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <stdlib.h>
+
+#include "pubsub_msg_batch.h"
+
+struct pubsub_msg_batch {
+    pubsub_subscriber_t *svc;
+    pubsub_msg_serializer_t *msgSer; //serializer of the pending msgs, NULL if no msgs are pending
+    size_t maxSize;
+    size_t size;
+    void **msgs;
+};
+
+pubsub_msg_batch_t* pubsub_msgBatch_create(pubsub_subscriber_t *svc, size_t maxSize) {
+    if (svc == NULL || svc->receiveBatch == NULL) {
+        return NULL;
+    }
+    pubsub_msg_batch_t *batch = calloc(1, sizeof(*batch));
+    batch->svc = svc;
+    batch->maxSize = maxSize > 0 ? maxSize : PUBSUB_MSG_BATCH_DEFAULT_MAX_SIZE;
+    batch->msgs = calloc(batch->maxSize, sizeof(*batch->msgs));
+    return batch;
+}
+
+static void pubsub_msgBatch_freeMsgs(pubsub_msg_batch_t *batch) {
+    for (size_t i = 0; i < batch->size; ++i) {
+        batch->msgSer->freeMsg(batch->msgSer->handle, batch->msgs[i]);
+    }
+    batch->size = 0;
+    batch->msgSer = NULL;
+}
+
+void pubsub_msgBatch_destroy(pubsub_msg_batch_t *batch) {
+    if (batch != NULL) {
+        pubsub_msgBatch_freeMsgs(batch);
+        free(batch->msgs);
+        free(batch);
+    }
+}
+
+void pubsub_msgBatch_add(pubsub_msg_batch_t *batch, pubsub_msg_serializer_t *msgSer, void *msg) {
+    if (batch->msgSer != NULL && (batch->msgSer != msgSer || batch->size == batch->maxSize)) {
+        pubsub_msgBatch_flush(batch);
+    }
+    batch->msgSer = msgSer;
+    batch->msgs[batch->size++] = msg;
+}
+
+void pubsub_msgBatch_flush(pubsub_msg_batch_t *batch) {
+    if (batch != NULL && batch->size > 0) {
+        batch->svc->receiveBatch(batch->svc->handle, batch->msgSer->msgId, batch->msgs, batch->size);
+        pubsub_msgBatch_freeMsgs(batch);
+    }
+}
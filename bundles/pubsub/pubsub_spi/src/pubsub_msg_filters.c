@@ -0,0 +1,98 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *  KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <stdlib.h>
+
+#include "celix_filter.h"
+#include "celix_hash_map.h"
+#include "celix_threads.h"
+
+#include "pubsub_msg_filters.h"
+
+struct pubsub_msg_filters {
+    celix_thread_rwlock_t lock;
+    celix_string_hash_map_t *map; //key = endpoint uuid, value = celix_filter_t* or NULL (all msgs needed)
+    size_t nrOfUnfiltered; //nr of subscribers without (valid) msg filter
+};
+
+static void pubsub_msgFilters_removeLocked(pubsub_msg_filters_t *filters, const char *endpointUUID) {
+    if (celix_stringHashMap_hasKey(filters->map, endpointUUID)) {
+        celix_filter_t *old = celix_stringHashMap_remove(filters->map, endpointUUID);
+        if (old == NULL) {
+            filters->nrOfUnfiltered -= 1;
+        } else {
+            celix_filter_destroy(old);
+        }
+    }
+}
+
+pubsub_msg_filters_t* pubsub_msgFilters_create(void) {
+    pubsub_msg_filters_t *filters = calloc(1, sizeof(*filters));
+    celixThreadRwlock_create(&filters->lock, NULL);
+    filters->map = celix_stringHashMap_create();
+    return filters;
+}
+
+void pubsub_msgFilters_destroy(pubsub_msg_filters_t *filters) {
+    if (filters != NULL) {
+        for (celix_string_hash_map_iterator_t iter = celix_stringHashMap_begin(filters->map); !celix_stringHashMapIterator_isEnd(&iter); celix_stringHashMapIterator_next(&iter)) {
+            celix_filter_destroy(iter.value);
+        }
+        celix_stringHashMap_destroy(filters->map);
+        celixThreadRwlock_destroy(&filters->lock);
+        free(filters);
+    }
+}
+
+void pubsub_msgFilters_add(pubsub_msg_filters_t *filters, const char *endpointUUID, const char *filter) {
+    celix_filter_t *newFilter = filter == NULL ? NULL : celix_filter_create(filter);
+    celixThreadRwlock_writeLock(&filters->lock);
+    pubsub_msgFilters_removeLocked(filters, endpointUUID);
+    celix_stringHashMap_put(filters->map, endpointUUID, newFilter);
+    if (newFilter == NULL) {
+        filters->nrOfUnfiltered += 1;
+    }
+    celixThreadRwlock_unlock(&filters->lock);
+}
+
+void pubsub_msgFilters_remove(pubsub_msg_filters_t *filters, const char *endpointUUID) {
+    celixThreadRwlock_writeLock(&filters->lock);
+    pubsub_msgFilters_removeLocked(filters, endpointUUID);
+    celixThreadRwlock_unlock(&filters->lock);
+}
+
+bool pubsub_msgFilters_match(pubsub_msg_filters_t *filters, const pubsub_msg_serializer_t *msgSer, const void *msg) {
+    if (filters == NULL || msgSer->msgToProperties == NULL) {
+        return true;
+    }
+    bool match = true;
+    celixThreadRwlock_readLock(&filters->lock);
+    if (celix_stringHashMap_size(filters->map) > 0 && filters->nrOfUnfiltered == 0) {
+        celix_properties_t *props = celix_properties_create();
+        if (msgSer->msgToProperties(msgSer->handle, msg, props) == CELIX_SUCCESS) {
+            match = false;
+            for (celix_string_hash_map_iterator_t iter = celix_stringHashMap_begin(filters->map); !match && !celix_stringHashMapIterator_isEnd(&iter); celix_stringHashMapIterator_next(&iter)) {
+                match = celix_filter_match(iter.value, props);
+            }
+        }
+        celix_properties_destroy(props);
+    }
+    celixThreadRwlock_unlock(&filters->lock);
+    return match;
+}
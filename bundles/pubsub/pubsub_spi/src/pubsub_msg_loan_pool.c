@@ -0,0 +1,135 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *  KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <string.h>
+#include <stddef.h>
+
+#include "celix_threads.h"
+#include "pubsub_msg_loan_pool.h"
+
+typedef union pubsub_loan_align {
+    long long ll;
+    long double ld;
+    void *ptr;
+} pubsub_loan_align_t;
+
+typedef struct pubsub_loan_buffer {
+    struct pubsub_loan_buffer *next;
+    size_t size;
+    pubsub_loan_align_t data[]; //note union so that the loaned msg is aligned for every msg type
+} pubsub_loan_buffer_t;
+
+struct pubsub_msg_loan_pool {
+    celix_thread_mutex_t mutex;
+    size_t maxPooledBuffers;
+    size_t nrOfPooledBuffers;
+    pubsub_loan_buffer_t *pooled; //singly linked list of returned buffers
+};
+
+pubsub_msg_loan_pool_t* pubsub_msgLoanPool_create(size_t maxPooledBuffers) {
+    pubsub_msg_loan_pool_t *pool = calloc(1, sizeof(*pool));
+    pool->maxPooledBuffers = maxPooledBuffers;
+    celixThreadMutex_create(&pool->mutex, NULL);
+    return pool;
+}
+
+void pubsub_msgLoanPool_destroy(pubsub_msg_loan_pool_t *pool) {
+    if (pool != NULL) {
+        pubsub_loan_buffer_t *buf = pool->pooled;
+        while (buf != NULL) {
+            pubsub_loan_buffer_t *next = buf->next;
+            free(buf);
+            buf = next;
+        }
+        celixThreadMutex_destroy(&pool->mutex);
+        free(pool);
+    }
+}
+
+void* pubsub_msgLoanPool_loan(pubsub_msg_loan_pool_t *pool, size_t size) {
+    if (size == 0) {
+        return NULL;
+    }
+
+    pubsub_loan_buffer_t *buf = NULL;
+    celixThreadMutex_lock(&pool->mutex);
+    pubsub_loan_buffer_t **link = &pool->pooled;
+    while (*link != NULL) {
+        if ((*link)->size == size) {
+            buf = *link;
+            *link = buf->next;
+            pool->nrOfPooledBuffers -= 1;
+            break;
+        }
+        link = &(*link)->next;
+    }
+    celixThreadMutex_unlock(&pool->mutex);
+
+    if (buf == NULL) {
+        buf = malloc(sizeof(*buf) + size);
+        if (buf == NULL) {
+            return NULL;
+        }
+        buf->size = size;
+    }
+    buf->next = NULL;
+    memset(buf->data, 0, size);
+    return buf->data;
+}
+
+static pubsub_loan_buffer_t* pubsub_msgLoanPool_bufferFor(void *buffer) {
+    return (pubsub_loan_buffer_t*)((char*)buffer - offsetof(pubsub_loan_buffer_t, data));
+}
+
+void pubsub_msgLoanPool_return(pubsub_msg_loan_pool_t *pool, void *buffer) {
+    if (buffer == NULL) {
+        return;
+    }
+    pubsub_loan_buffer_t *buf = pubsub_msgLoanPool_bufferFor(buffer);
+
+    celixThreadMutex_lock(&pool->mutex);
+    if (pool->nrOfPooledBuffers < pool->maxPooledBuffers) {
+        buf->next = pool->pooled;
+        pool->pooled = buf;
+        pool->nrOfPooledBuffers += 1;
+        buf = NULL;
+    }
+    celixThreadMutex_unlock(&pool->mutex);
+
+    free(buf); //pool full
+}
+
+void pubsub_msgLoanPool_free(void *buffer) {
+    if (buffer != NULL) {
+        free(pubsub_msgLoanPool_bufferFor(buffer));
+    }
+}
+
+celix_status_t pubsub_createPodMsg(const pubsub_msg_serializer_t *msgSer, const void *payload, size_t payloadSize, void **out) {
+    if (msgSer->podSize == 0 || msgSer->podSize != payloadSize) {
+        return CELIX_ILLEGAL_ARGUMENT;
+    }
+    void *msg = malloc(payloadSize);
+    if (msg == NULL) {
+        return CELIX_ENOMEM;
+    }
+    memcpy(msg, payload, payloadSize);
+    *out = msg;
+    return CELIX_SUCCESS;
+}
@@ -0,0 +1,108 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *  KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <stdlib.h>
+
+#include "celix_threads.h"
+#include "hash_map.h"
+#include "pubsub_serializer_cache.h"
+
+typedef struct pubsub_serializer_cache_entry {
+    pubsub_msg_serializer_t *msgSerializer;
+    size_t refCount;
+} pubsub_serializer_cache_entry_t;
+
+struct pubsub_serializer_cache {
+    celix_thread_mutex_t mutex;
+    void *handle;
+    void (*destroyMsgSerializer)(void *handle, pubsub_msg_serializer_t *msgSerializer);
+    hash_map_t *entries; //key = shared parse result, value = pubsub_serializer_cache_entry_t*
+};
+
+pubsub_serializer_cache_t* pubsub_serializerCache_create(void *handle, void (*destroyMsgSerializer)(void *handle, pubsub_msg_serializer_t *msgSerializer)) {
+    pubsub_serializer_cache_t *cache = calloc(1, sizeof(*cache));
+    cache->handle = handle;
+    cache->destroyMsgSerializer = destroyMsgSerializer;
+    cache->entries = hashMap_create(NULL, NULL, NULL, NULL);
+    celixThreadMutex_create(&cache->mutex, NULL);
+    return cache;
+}
+
+void pubsub_serializerCache_destroy(pubsub_serializer_cache_t *cache) {
+    if (cache != NULL) {
+        hash_map_iterator_t iter = hashMapIterator_construct(cache->entries);
+        while (hashMapIterator_hasNext(&iter)) {
+            pubsub_serializer_cache_entry_t *entry = hashMapIterator_nextValue(&iter);
+            cache->destroyMsgSerializer(cache->handle, entry->msgSerializer);
+            free(entry);
+        }
+        hashMap_destroy(cache->entries, false, false);
+        celixThreadMutex_destroy(&cache->mutex);
+        free(cache);
+    }
+}
+
+pubsub_msg_serializer_t* pubsub_serializerCache_acquire(pubsub_serializer_cache_t *cache, const void *key) {
+    pubsub_msg_serializer_t *msgSerializer = NULL;
+    celixThreadMutex_lock(&cache->mutex);
+    pubsub_serializer_cache_entry_t *entry = hashMap_get(cache->entries, key);
+    if (entry != NULL) {
+        entry->refCount += 1;
+        msgSerializer = entry->msgSerializer;
+    }
+    celixThreadMutex_unlock(&cache->mutex);
+    return msgSerializer;
+}
+
+pubsub_msg_serializer_t* pubsub_serializerCache_add(pubsub_serializer_cache_t *cache, const void *key, pubsub_msg_serializer_t *msgSerializer) {
+    celixThreadMutex_lock(&cache->mutex);
+    pubsub_serializer_cache_entry_t *entry = hashMap_get(cache->entries, key);
+    if (entry != NULL) {
+        entry->refCount += 1;
+        msgSerializer = entry->msgSerializer;
+    } else {
+        entry = calloc(1, sizeof(*entry));
+        if (entry != NULL) {
+            entry->msgSerializer = msgSerializer;
+            entry->refCount = 1;
+            hashMap_put(cache->entries, (void*)key, entry);
+        }
+    }
+    celixThreadMutex_unlock(&cache->mutex);
+    return msgSerializer;
+}
+
+void pubsub_serializerCache_release(pubsub_serializer_cache_t *cache, const void *key, pubsub_msg_serializer_t *msgSerializer) {
+    bool destroy = true;
+    celixThreadMutex_lock(&cache->mutex);
+    pubsub_serializer_cache_entry_t *entry = hashMap_get(cache->entries, key);
+    if (entry != NULL && entry->msgSerializer == msgSerializer) {
+        entry->refCount -= 1;
+        destroy = entry->refCount == 0;
+        if (destroy) {
+            hashMap_remove(cache->entries, key);
+            free(entry);
+        }
+    }
+    celixThreadMutex_unlock(&cache->mutex);
+    if (destroy) {
+        //note outside the lock, destroying can release the shared parse result of the key
+        cache->destroyMsgSerializer(cache->handle, msgSerializer);
+    }
+}
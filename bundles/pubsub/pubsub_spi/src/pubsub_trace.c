@@ -0,0 +1,254 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *  KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <uuid/uuid.h>
+
+#include "celix_constants.h"
+#include "pubsub_trace.h"
+
+#define PUBSUB_TRACE_SPAN_KIND_PRODUCER         4
+#define PUBSUB_TRACE_SPAN_KIND_CONSUMER         5
+
+struct pubsub_tracer {
+    int fd;
+    char *serviceName;
+    char *psaType;
+    char *scope; //can be NULL
+    char *topic;
+    unsigned long sampleInterval;
+    unsigned long counter; //atomic
+};
+
+static __thread const pubsub_trace_receive_span_t *g_currentSpan = NULL; //set during a traced subscriber callback
+static __thread uint64_t g_randomState = 0;
+
+pubsub_tracer_t* pubsub_tracer_create(celix_bundle_context_t *ctx, const char *psaType, const char *scope, const char *topic) {
+    if (!celix_bundleContext_getPropertyAsBool(ctx, PUBSUB_TRACE_ENABLED_KEY, PUBSUB_TRACE_ENABLED_DEFAULT)) {
+        return NULL;
+    }
+    const char *path = celix_bundleContext_getProperty(ctx, PUBSUB_TRACE_FILE_KEY, PUBSUB_TRACE_FILE_DEFAULT);
+    //note O_APPEND, so that the spans (written with a single write call) of all tracers can share the file
+    int fd = open(path, O_WRONLY | O_CREAT | O_APPEND, 0644);
+    if (fd < 0) {
+        fprintf(stderr, "[PUBSUB_TRACE] Cannot open trace file %s\n", path);
+        return NULL;
+    }
+    long interval = celix_bundleContext_getPropertyAsLong(ctx, PUBSUB_TRACE_SAMPLE_INTERVAL_KEY, PUBSUB_TRACE_SAMPLE_INTERVAL_DEFAULT);
+
+    pubsub_tracer_t *tracer = calloc(1, sizeof(*tracer));
+    tracer->fd = fd;
+    tracer->serviceName = strdup(celix_bundleContext_getProperty(ctx, OSGI_FRAMEWORK_FRAMEWORK_UUID, "celix"));
+    tracer->psaType = strdup(psaType);
+    tracer->scope = scope == NULL ? NULL : strdup(scope);
+    tracer->topic = strdup(topic);
+    tracer->sampleInterval = interval > 0 ? (unsigned long) interval : 1;
+    return tracer;
+}
+
+void pubsub_tracer_destroy(pubsub_tracer_t *tracer) {
+    if (tracer != NULL) {
+        close(tracer->fd);
+        free(tracer->serviceName);
+        free(tracer->psaType);
+        free(tracer->scope);
+        free(tracer->topic);
+        free(tracer);
+    }
+}
+
+uint64_t pubsub_trace_now(void) {
+    struct timespec now;
+    clock_gettime(CLOCK_REALTIME, &now);
+    return (uint64_t) now.tv_sec * 1000000000UL + (uint64_t) now.tv_nsec;
+}
+
+static void pubsub_trace_randomId(uint8_t *id, size_t size) {
+    if (g_randomState == 0) {
+        uuid_t seed;
+        uuid_generate_random(seed);
+        memcpy(&g_randomState, seed, sizeof(g_randomState));
+        g_randomState |= 1; //xorshift state must be non zero
+    }
+    for (size_t i = 0; i < size; i += sizeof(uint64_t)) {
+        //xorshift64*
+        g_randomState ^= g_randomState >> 12;
+        g_randomState ^= g_randomState << 25;
+        g_randomState ^= g_randomState >> 27;
+        uint64_t value = g_randomState * 0x2545F4914F6CDD1DULL;
+        memcpy(id + i, &value, size - i < sizeof(value) ? size - i : sizeof(value));
+    }
+}
+
+bool pubsub_tracer_sample(pubsub_tracer_t *tracer) {
+    if (tracer == NULL) {
+        return false;
+    }
+    if (g_currentSpan != NULL) {
+        return true;
+    }
+    unsigned long count = __atomic_fetch_add(&tracer->counter, 1, __ATOMIC_RELAXED);
+    return count % tracer->sampleInterval == 0;
+}
+
+void pubsub_tracer_initContext(pubsub_tracer_t *tracer __attribute__((unused)), pubsub_trace_context_t *context) {
+    memset(context, 0, sizeof(*context));
+    if (g_currentSpan != NULL) {
+        memcpy(context->traceId, g_currentSpan->traceId, sizeof(context->traceId));
+        memcpy(context->parentSpanId, g_currentSpan->spanId, sizeof(context->parentSpanId));
+    } else {
+        pubsub_trace_randomId(context->traceId, sizeof(context->traceId));
+    }
+    pubsub_trace_randomId(context->spanId, sizeof(context->spanId));
+}
+
+static void pubsub_trace_writeHex(FILE *stream, const uint8_t *id, size_t size) {
+    for (size_t i = 0; i < size; ++i) {
+        fprintf(stream, "%02x", id[i]);
+    }
+}
+
+static bool pubsub_trace_isZero(const uint8_t *id, size_t size) {
+    for (size_t i = 0; i < size; ++i) {
+        if (id[i] != 0) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static void pubsub_trace_writeString(FILE *stream, const char *str) {
+    fputc('"', stream);
+    for (const char *c = str; *c != '\0'; ++c) {
+        if (*c == '"' || *c == '\\') {
+            fprintf(stream, "\\%c", *c);
+        } else if ((unsigned char) *c < 0x20) {
+            fprintf(stream, "\\u%04x", (unsigned char) *c);
+        } else {
+            fputc(*c, stream);
+        }
+    }
+    fputc('"', stream);
+}
+
+static void pubsub_trace_writeAttribute(FILE *stream, const char *key, const char *value, bool last) {
+    fprintf(stream, "{\"key\":\"%s\",\"value\":{\"stringValue\":", key);
+    pubsub_trace_writeString(stream, value);
+    fprintf(stream, "}}%s", last ? "" : ",");
+}
+
+static void pubsub_trace_writeEvent(FILE *stream, const char *name, uint64_t time, bool *first) {
+    if (time != 0) {
+        fprintf(stream, "%s{\"timeUnixNano\":\"%lu\",\"name\":\"%s\"}", *first ? "" : ",", (unsigned long) time, name);
+        *first = false;
+    }
+}
+
+/**
+ * Writes the begin of an OTLP/JSON ExportTraceServiceRequest with a single span, up to and including the span events
+ * array opening.
+ */
+static void pubsub_trace_writeSpanBegin(pubsub_tracer_t *tracer, FILE *stream, const char *name, int kind,
+                                        const uint8_t *traceId, const uint8_t *spanId, const uint8_t *parentSpanId,
+                                        uint64_t start, uint64_t end, const char *msgFqn) {
+    fprintf(stream, "{\"resourceSpans\":[{\"resource\":{\"attributes\":[");
+    pubsub_trace_writeAttribute(stream, "service.name", tracer->serviceName, true);
+    fprintf(stream, "]},\"scopeSpans\":[{\"scope\":{\"name\":\"celix.pubsub.%s\"},\"spans\":[{\"traceId\":\"", tracer->psaType);
+    pubsub_trace_writeHex(stream, traceId, 16);
+    fprintf(stream, "\",\"spanId\":\"");
+    pubsub_trace_writeHex(stream, spanId, 8);
+    fprintf(stream, "\",\"parentSpanId\":\"");
+    if (!pubsub_trace_isZero(parentSpanId, 8)) {
+        pubsub_trace_writeHex(stream, parentSpanId, 8);
+    }
+    fprintf(stream, "\",\"name\":");
+    pubsub_trace_writeString(stream, name);
+    fprintf(stream, ",\"kind\":%i,\"startTimeUnixNano\":\"%lu\",\"endTimeUnixNano\":\"%lu\",\"attributes\":[",
+            kind, (unsigned long) start, (unsigned long) end);
+    pubsub_trace_writeAttribute(stream, "messaging.system", "celix.pubsub", false);
+    pubsub_trace_writeAttribute(stream, "messaging.destination.name", tracer->topic, false);
+    if (tracer->scope != NULL) {
+        pubsub_trace_writeAttribute(stream, "pubsub.scope", tracer->scope, false);
+    }
+    pubsub_trace_writeAttribute(stream, "pubsub.admin", tracer->psaType, false);
+    pubsub_trace_writeAttribute(stream, "pubsub.msg.type", msgFqn, true);
+    fprintf(stream, "],\"events\":[");
+}
+
+static void pubsub_trace_writeSpanEnd(pubsub_tracer_t *tracer, FILE *stream, char **buf, size_t *size) {
+    fprintf(stream, "]}]}]}]}\n");
+    fclose(stream);
+    //a single write, so that the spans of different tracers are not interleaved in the file
+    if (write(tracer->fd, *buf, *size) != (ssize_t) *size) {
+        //note best effort, a lost span is not worth to disturb the msg flow
+    }
+    free(*buf);
+}
+
+void pubsub_tracer_exportSendSpan(pubsub_tracer_t *tracer, const char *msgFqn, const pubsub_trace_context_t *context, uint64_t sendEnd) {
+    if (tracer == NULL) {
+        return;
+    }
+    char *buf = NULL;
+    size_t size = 0;
+    FILE *stream = open_memstream(&buf, &size);
+    char name[256];
+    snprintf(name, sizeof(name), "%s send", tracer->topic);
+    pubsub_trace_writeSpanBegin(tracer, stream, name, PUBSUB_TRACE_SPAN_KIND_PRODUCER, context->traceId,
+                                context->spanId, context->parentSpanId, context->serializeStart, sendEnd, msgFqn);
+    bool first = true;
+    pubsub_trace_writeEvent(stream, "serialized", context->serializeEnd, &first);
+    pubsub_trace_writeEvent(stream, "enqueued", context->enqueueTime, &first);
+    pubsub_trace_writeSpanEnd(tracer, stream, &buf, &size);
+}
+
+void pubsub_tracer_beginReceiveSpan(pubsub_tracer_t *tracer __attribute__((unused)), const pubsub_trace_context_t *context, const struct timespec *receiveTime, pubsub_trace_receive_span_t *span) {
+    memset(span, 0, sizeof(*span));
+    memcpy(span->traceId, context->traceId, sizeof(span->traceId));
+    memcpy(span->parentSpanId, context->spanId, sizeof(span->parentSpanId));
+    pubsub_trace_randomId(span->spanId, sizeof(span->spanId));
+    span->receiveTime = (uint64_t) receiveTime->tv_sec * 1000000000UL + (uint64_t) receiveTime->tv_nsec;
+    g_currentSpan = span;
+}
+
+void pubsub_tracer_endReceiveSpan(pubsub_tracer_t *tracer, const char *msgFqn, pubsub_trace_receive_span_t *span) {
+    if (g_currentSpan == span) {
+        g_currentSpan = NULL;
+    }
+    if (tracer == NULL) {
+        return;
+    }
+    uint64_t end = span->callbackEnd != 0 ? span->callbackEnd : pubsub_trace_now();
+    char *buf = NULL;
+    size_t size = 0;
+    FILE *stream = open_memstream(&buf, &size);
+    char name[256];
+    snprintf(name, sizeof(name), "%s receive", tracer->topic);
+    pubsub_trace_writeSpanBegin(tracer, stream, name, PUBSUB_TRACE_SPAN_KIND_CONSUMER, span->traceId,
+                                span->spanId, span->parentSpanId, span->receiveTime, end, msgFqn);
+    bool first = true;
+    pubsub_trace_writeEvent(stream, "deserialize", span->deserializeStart, &first);
+    pubsub_trace_writeEvent(stream, "deserialized", span->deserializeEnd, &first);
+    pubsub_trace_writeEvent(stream, "callback", span->callbackStart, &first);
+    pubsub_trace_writeSpanEnd(tracer, stream, &buf, &size);
+}
@@ -17,6 +17,7 @@
  * under the License.
  */
 
+#include <stdio.h>
 #include <string.h>
 #include <stdlib.h>
 
@@ -26,16 +27,26 @@
 
 #include "pubsub/publisher.h"
 #include "pubsub_utils.h"
+#include "pubsub_constants.h"
 
 #include "array_list.h"
 #include "bundle.h"
+#include "celix_hash_map.h"
+#include "celix_threads.h"
 
 #include <unistd.h>
+#include <pthread.h>
+#include <sched.h>
 #include <sys/types.h>
 #include <sys/stat.h>
 
 #define MAX_KEYBUNDLE_LENGTH 256
 
+//key = topic properties path, value = celix_properties_t* or NULL if the topic properties file is missing.
+//note that the path contains the revision dir of the bundle, so an updated bundle uses new keys.
+static celix_thread_mutex_t topicPropertiesCacheMutex = PTHREAD_MUTEX_INITIALIZER;
+static celix_string_hash_map_t *topicPropertiesCache = NULL;
+
 
 celix_status_t pubsub_getPubSubInfoFromFilter(const char* filterstr, char **topicOut, char **scopeOut) {
     celix_status_t status = CELIX_SUCCESS;
@@ -144,9 +155,31 @@ celix_properties_t *pubsub_utils_getTopicProperties(const celix_bundle_t *bundle
 
         if (bundleRoot != NULL) {
             asprintf(&topicPropertiesPath, "%s/META-INF/topics/%s/%s.properties", bundleRoot, isPublisher? "pub":"sub", topic);
-            topic_props = celix_properties_load(topicPropertiesPath);
-            if (topic_props == NULL) {
-                printf("PubSub: Could not load properties for %s on topic %s. Searched location %s, bundleId=%ld\n", isPublisher? "publication":"subscription", topic, topicPropertiesPath, bundleId);
+
+            celixThreadMutex_lock(&topicPropertiesCacheMutex);
+            if (topicPropertiesCache == NULL) {
+                topicPropertiesCache = celix_stringHashMap_create();
+            }
+            bool cached = celix_stringHashMap_hasKey(topicPropertiesCache, topicPropertiesPath);
+            if (cached) {
+                const celix_properties_t *cachedProps = celix_stringHashMap_get(topicPropertiesCache, topicPropertiesPath);
+                topic_props = cachedProps != NULL ? celix_properties_copy(cachedProps) : NULL;
+            }
+            celixThreadMutex_unlock(&topicPropertiesCacheMutex);
+
+            if (!cached) {
+                topic_props = celix_properties_load(topicPropertiesPath);
+                if (topic_props == NULL) {
+                    printf("PubSub: Could not load properties for %s on topic %s. Searched location %s, bundleId=%ld\n", isPublisher? "publication":"subscription", topic, topicPropertiesPath, bundleId);
+                }
+                celix_properties_t *cachedProps = topic_props != NULL ? celix_properties_copy(topic_props) : NULL;
+                celixThreadMutex_lock(&topicPropertiesCacheMutex);
+                celix_properties_t *prev = celix_stringHashMap_put(topicPropertiesCache, topicPropertiesPath, cachedProps);
+                celixThreadMutex_unlock(&topicPropertiesCacheMutex);
+                if (prev != NULL) {
+                    //concurrently loaded by another thread
+                    celix_properties_destroy(prev);
+                }
             }
 
             free(topicPropertiesPath);
@@ -156,3 +189,122 @@ celix_properties_t *pubsub_utils_getTopicProperties(const celix_bundle_t *bundle
 
     return topic_props;
 }
+
+void pubsub_utils_clearTopicPropertiesCache(void) {
+    celixThreadMutex_lock(&topicPropertiesCacheMutex);
+    if (topicPropertiesCache != NULL) {
+        celix_string_hash_map_iterator_t iter = celix_stringHashMap_begin(topicPropertiesCache);
+        while (!celix_stringHashMapIterator_isEnd(&iter)) {
+            if (iter.value != NULL) {
+                celix_properties_destroy(iter.value);
+            }
+            celix_stringHashMapIterator_next(&iter);
+        }
+        celix_stringHashMap_destroy(topicPropertiesCache);
+        topicPropertiesCache = NULL;
+    }
+    celixThreadMutex_unlock(&topicPropertiesCacheMutex);
+}
+
+pubsub_send_queue_policy_e pubsub_utils_getSendQueuePolicy(const celix_properties_t *topicProperties) {
+    pubsub_send_queue_policy_e policy = PUBSUB_SEND_QUEUE_POLICY_DROP_NEWEST_TYPE;
+    const char *qos = celix_properties_get(topicProperties, PUBSUB_UTILS_QOS_ATTRIBUTE_KEY, NULL);
+    if (qos != NULL && strncmp(qos, PUBSUB_UTILS_QOS_TYPE_SAMPLE, strlen(PUBSUB_UTILS_QOS_TYPE_SAMPLE)) == 0) {
+        policy = PUBSUB_SEND_QUEUE_POLICY_DROP_OLDEST_TYPE;
+    } else if (qos != NULL && strncmp(qos, PUBSUB_UTILS_QOS_TYPE_CONTROL, strlen(PUBSUB_UTILS_QOS_TYPE_CONTROL)) == 0) {
+        policy = PUBSUB_SEND_QUEUE_POLICY_BLOCK_TYPE;
+    }
+
+    const char *configured = celix_properties_get(topicProperties, PUBSUB_SEND_QUEUE_POLICY_KEY, NULL);
+    if (configured == NULL) {
+        //use qos default
+    } else if (strcmp(configured, PUBSUB_SEND_QUEUE_POLICY_DROP_NEWEST) == 0) {
+        policy = PUBSUB_SEND_QUEUE_POLICY_DROP_NEWEST_TYPE;
+    } else if (strcmp(configured, PUBSUB_SEND_QUEUE_POLICY_DROP_OLDEST) == 0) {
+        policy = PUBSUB_SEND_QUEUE_POLICY_DROP_OLDEST_TYPE;
+    } else if (strcmp(configured, PUBSUB_SEND_QUEUE_POLICY_BLOCK) == 0) {
+        policy = PUBSUB_SEND_QUEUE_POLICY_BLOCK_TYPE;
+    } else {
+        fprintf(stderr, "PubSub: Unknown send queue policy '%s', using the default policy\n", configured);
+    }
+    return policy;
+}
+
+static bool pubsub_utils_parseCpuSet(const char *cpus, cpu_set_t *set) {
+    CPU_ZERO(set);
+    const char *pos = cpus;
+    while (*pos != '\0') {
+        char *end = NULL;
+        long first = strtol(pos, &end, 10);
+        long last = first;
+        if (end == pos) {
+            return false;
+        }
+        if (*end == '-') {
+            pos = end + 1;
+            last = strtol(pos, &end, 10);
+            if (end == pos) {
+                return false;
+            }
+        }
+        if (first < 0 || last < first || last >= CPU_SETSIZE) {
+            return false;
+        }
+        for (long cpu = first; cpu <= last; ++cpu) {
+            CPU_SET((int) cpu, set);
+        }
+        pos = end;
+        while (*pos == ',' || *pos == ' ') {
+            ++pos;
+        }
+    }
+    return CPU_COUNT(set) > 0;
+}
+
+celix_status_t pubsub_utils_setupThread(celix_thread_t *thread, const celix_properties_t *topicProperties) {
+    celix_status_t status = CELIX_SUCCESS;
+    const char *sched = celix_properties_get(topicProperties, PUBSUB_THREAD_REALTIME_SCHED_KEY, NULL);
+    long prio = celix_properties_getAsLong(topicProperties, PUBSUB_THREAD_REALTIME_PRIO_KEY, -1L);
+    if (sched != NULL || prio > 0) {
+        int policy = SCHED_OTHER;
+        struct sched_param param;
+        memset(&param, 0, sizeof(param));
+        pthread_getschedparam(thread->thread, &policy, &param);
+        if (sched == NULL) {
+            //keep the current policy, e.g. only the prio is changed
+        } else if (strcmp("SCHED_OTHER", sched) == 0) {
+            policy = SCHED_OTHER;
+        } else if (strcmp("SCHED_BATCH", sched) == 0) {
+            policy = SCHED_BATCH;
+        } else if (strcmp("SCHED_IDLE", sched) == 0) {
+            policy = SCHED_IDLE;
+        } else if (strcmp("SCHED_FIFO", sched) == 0) {
+            policy = SCHED_FIFO;
+        } else if (strcmp("SCHED_RR", sched) == 0) {
+            policy = SCHED_RR;
+        } else {
+            status = CELIX_ILLEGAL_ARGUMENT;
+        }
+        if (policy == SCHED_FIFO || policy == SCHED_RR) {
+            param.sched_priority = prio > 0 && prio < 100 ? (int) prio : sched_get_priority_min(policy);
+        } else {
+            param.sched_priority = 0;
+        }
+        if (status == CELIX_SUCCESS) {
+            status = pthread_setschedparam(thread->thread, policy, &param);
+        }
+    }
+
+    const char *cpus = celix_properties_get(topicProperties, PUBSUB_THREAD_CPU_AFFINITY_KEY, NULL);
+    if (cpus != NULL) {
+        cpu_set_t set;
+        celix_status_t affinityStatus = CELIX_ILLEGAL_ARGUMENT;
+        if (pubsub_utils_parseCpuSet(cpus, &set)) {
+            affinityStatus = pthread_setaffinity_np(thread->thread, sizeof(set), &set);
+        }
+        if (status == CELIX_SUCCESS) {
+            status = affinityStatus;
+        }
+    }
+    return status;
+}
@@ -47,6 +47,9 @@ typedef struct pstm_activator {
     command_service_t shellCmdSvc;
     long shellCmdSvcId;
 
+    celix_metrics_provider_service_t metricsSvc;
+    long metricsSvcId;
+
     log_helper_t *loghelper;
 } pstm_activator_t;
 
@@ -61,6 +64,7 @@ static int pstm_start(pstm_activator_t *act, celix_bundle_context_t *ctx) {
     act->pubsubPublishServiceTrackerId = -1L;
     act->pubsubPSAMetricsTrackerId = -1L;
     act->shellCmdSvcId = -1L;
+    act->metricsSvcId = -1L;
 
     logHelper_create(ctx, &act->loghelper);
     logHelper_start(act->loghelper);
@@ -123,6 +127,8 @@ static int pstm_start(pstm_activator_t *act, celix_bundle_context_t *ctx) {
         act->discListenerSvc.handle = act->manager;
         act->discListenerSvc.addDiscoveredEndpoint = pubsub_topologyManager_addDiscoveredEndpoint;
         act->discListenerSvc.removeDiscoveredEndpoint = pubsub_topologyManager_removeDiscoveredEndpoint;
+        act->discListenerSvc.addDiscoveredEndpoints = pubsub_topologyManager_addDiscoveredEndpoints;
+        act->discListenerSvc.removeDiscoveredEndpoints = pubsub_topologyManager_removeDiscoveredEndpoints;
         act->discListenerSvcId = celix_bundleContext_registerService(ctx, &act->discListenerSvc, PUBSUB_DISCOVERED_ENDPOINT_LISTENER_SERVICE, NULL);
     }
 
@@ -132,11 +138,18 @@ static int pstm_start(pstm_activator_t *act, celix_bundle_context_t *ctx) {
         act->shellCmdSvc.executeCommand = pubsub_topologyManager_shellCommand;
         celix_properties_t *props = celix_properties_create();
         celix_properties_set(props, OSGI_SHELL_COMMAND_NAME, "pstm");
-        celix_properties_set(props, OSGI_SHELL_COMMAND_USAGE, "pstm [topology|metrics]"); //TODO add search topic/scope option
+        celix_properties_set(props, OSGI_SHELL_COMMAND_USAGE, "pstm [topology|metrics [seconds]]"); //TODO add search topic/scope option
         celix_properties_set(props, OSGI_SHELL_COMMAND_DESCRIPTION, "pubsub_topology_info: Overview of Topology information for PubSub");
         act->shellCmdSvcId = celix_bundleContext_registerService(ctx, &act->shellCmdSvc, OSGI_SHELL_COMMAND_SERVICE_NAME, props);
     }
 
+    //register metrics provider, exposing the PSA metrics
+    if (status == CELIX_SUCCESS) {
+        act->metricsSvc.handle = act->manager;
+        act->metricsSvc.collect = pubsub_topologyManager_collectMetrics;
+        act->metricsSvcId = celix_bundleContext_registerService(ctx, &act->metricsSvc, CELIX_METRICS_PROVIDER_SERVICE_NAME, NULL);
+    }
+
     //TODO add tracker for pubsub_serializer and
     //1) on remove reset sender/receivers entries
     //2) on add indicate that topic/senders should be reevaluated.
@@ -158,6 +171,7 @@ static int pstm_stop(pstm_activator_t *act, celix_bundle_context_t *ctx) {
     celix_bundleContext_stopTracker(ctx, act->pubsubPSAMetricsTrackerId);
     celix_bundleContext_unregisterService(ctx, act->discListenerSvcId);
     celix_bundleContext_unregisterService(ctx, act->shellCmdSvcId);
+    celix_bundleContext_unregisterService(ctx, act->metricsSvcId);
 
     pubsub_topologyManager_destroy(act->manager);
 
@@ -21,6 +21,8 @@
 #include <stdlib.h>
 #include <string.h>
 #include <stdbool.h>
+#include <inttypes.h>
+#include <time.h>
 #include <celix_api.h>
 #include <pubsub_utils.h>
 #include <assert.h>
@@ -47,6 +49,31 @@
 #endif
 
 static void *pstm_psaHandlingThread(void *data);
+static void pstm_destroyMsgFilters(pstm_topic_receiver_or_sender_entry_t *entry);
+
+static void pstm_markDirty(celix_array_list_t *dirty, pstm_topic_receiver_or_sender_entry_t *entry) {
+    if (!entry->dirty) {
+        entry->dirty = true;
+        celix_arrayList_add(dirty, entry);
+    }
+}
+
+static void pstm_markEndpointDirty(celix_array_list_t *dirty, pstm_discovered_endpoint_entry_t *entry) {
+    if (!entry->dirty) {
+        entry->dirty = true;
+        celix_arrayList_add(dirty, entry);
+    }
+}
+
+/**
+ * Wakes up the psa handling thread, which only handles the dirty entries.
+ */
+static void pstm_triggerPsaHandling(pubsub_topology_manager_t *manager) {
+    celixThreadMutex_lock(&manager->psaHandling.mutex);
+    manager->psaHandling.triggered = true;
+    celixThreadCondition_broadcast(&manager->psaHandling.cond);
+    celixThreadMutex_unlock(&manager->psaHandling.mutex);
+}
 
 celix_status_t pubsub_topologyManager_create(celix_bundle_context_t *context, log_helper_t *logHelper, pubsub_topology_manager_t **out) {
     celix_status_t status = CELIX_SUCCESS;
@@ -82,6 +109,9 @@ celix_status_t pubsub_topologyManager_create(celix_bundle_context_t *context, lo
     manager->topicReceivers.map = hashMap_create(utils_stringHash, NULL, utils_stringEquals, NULL);
     manager->psaMetrics.map = hashMap_create(NULL, NULL, NULL, NULL);
     manager->topicSenders.map = hashMap_create(utils_stringHash, NULL, utils_stringEquals, NULL);
+    manager->discoveredEndpoints.dirty = celix_arrayList_create();
+    manager->topicReceivers.dirty = celix_arrayList_create();
+    manager->topicSenders.dirty = celix_arrayList_create();
 
     manager->loghelper = logHelper;
     manager->verbose = celix_bundleContext_getPropertyAsBool(context, PUBSUB_TOPOLOGY_MANAGER_VERBOSE_KEY, PUBSUB_TOPOLOGY_MANAGER_DEFAULT_VERBOSE);
@@ -117,6 +147,7 @@ celix_status_t pubsub_topologyManager_destroy(pubsub_topology_manager_t *manager
         }
     }
     hashMap_destroy(manager->discoveredEndpoints.map, false, false);
+    celix_arrayList_destroy(manager->discoveredEndpoints.dirty);
     celixThreadMutex_unlock(&manager->discoveredEndpoints.mutex);
     celixThreadMutex_destroy(&manager->discoveredEndpoints.mutex);
 
@@ -135,10 +166,12 @@ celix_status_t pubsub_topologyManager_destroy(pubsub_topology_manager_t *manager
                 celix_properties_destroy(entry->endpoint);
             }
             celix_properties_destroy(entry->subscriberProperties);
+            pstm_destroyMsgFilters(entry);
             free(entry);
         }
     }
     hashMap_destroy(manager->topicReceivers.map, false, false);
+    celix_arrayList_destroy(manager->topicReceivers.dirty);
     celixThreadMutex_unlock(&manager->topicReceivers.mutex);
     celixThreadMutex_destroy(&manager->topicReceivers.mutex);
 
@@ -161,6 +194,7 @@ celix_status_t pubsub_topologyManager_destroy(pubsub_topology_manager_t *manager
         }
     }
     hashMap_destroy(manager->topicSenders.map, false, false);
+    celix_arrayList_destroy(manager->topicSenders.dirty);
     celixThreadMutex_unlock(&manager->topicSenders.mutex);
     celixThreadMutex_destroy(&manager->topicSenders.mutex);
 
@@ -199,6 +233,7 @@ void pubsub_topologyManager_psaAdded(void *handle, void *svc, const celix_proper
     while (hashMapIterator_hasNext(&iter)) {
         pstm_topic_receiver_or_sender_entry_t *entry = hashMapIterator_nextValue(&iter);
         entry->needsMatch = true;
+        pstm_markDirty(manager->topicSenders.dirty, entry);
         ++needsRematchCount;
     }
     celixThreadMutex_unlock(&manager->topicSenders.mutex);
@@ -207,6 +242,7 @@ void pubsub_topologyManager_psaAdded(void *handle, void *svc, const celix_proper
     while (hashMapIterator_hasNext(&iter)) {
         pstm_topic_receiver_or_sender_entry_t *entry = hashMapIterator_nextValue(&iter);
         entry->needsMatch = true;
+        pstm_markDirty(manager->topicReceivers.dirty, entry);
         ++needsRematchCount;
     }
     celixThreadMutex_unlock(&manager->topicReceivers.mutex);
@@ -218,6 +254,9 @@ void pubsub_topologyManager_psaAdded(void *handle, void *svc, const celix_proper
                 Current topic/sender count is %i", needsRematchCount);
     }
 
+    //note also the discovered endpoints without a selected psa are retried
+    pstm_triggerPsaHandling(manager);
+
 }
 
 void pubsub_topologyManager_psaRemoved(void *handle, void *svc __attribute__((unused)), const celix_properties_t *props) {
@@ -237,6 +276,7 @@ void pubsub_topologyManager_psaRemoved(void *handle, void *svc __attribute__((un
         pstm_discovered_endpoint_entry_t *entry = hashMapIterator_nextValue(&iter_endpoint);
         if (entry != NULL && entry->selectedPsaSvcId > 0 && entry->selectedPsaSvcId == svcId) {
             entry->selectedPsaSvcId = -1L; //NOTE not selected a psa anymore
+            pstm_markEndpointDirty(manager->discoveredEndpoints.dirty, entry);
         }
     }
     celixThreadMutex_unlock(&manager->discoveredEndpoints.mutex);
@@ -268,6 +308,7 @@ void pubsub_topologyManager_psaRemoved(void *handle, void *svc __attribute__((un
                 celix_properties_destroy(entry->endpoint);
                 entry->endpoint = NULL;
             }
+            pstm_markDirty(manager->topicSenders.dirty, entry);
         }
     }
     celixThreadMutex_unlock(&manager->topicSenders.mutex);
@@ -295,14 +336,77 @@ void pubsub_topologyManager_psaRemoved(void *handle, void *svc __attribute__((un
                 celix_properties_destroy(entry->endpoint);
                 entry->endpoint = NULL;
             }
+            pstm_markDirty(manager->topicReceivers.dirty, entry);
         }
     }
     celixThreadMutex_unlock(&manager->topicReceivers.mutex);
 
+    pstm_triggerPsaHandling(manager);
 
     logHelper_log(manager->loghelper, OSGI_LOGSERVICE_DEBUG, "PSTM: Removed PSA");
 }
 
+/**
+ * Combines the msg filters of the subscribers of a topic receiver. Returns NULL if a subscriber has no msg filter.
+ */
+static char* pstm_combinedMsgFilter(const celix_long_hash_map_t *msgFilters) {
+    const char *first = NULL;
+    bool allEqual = true;
+    for (celix_long_hash_map_iterator_t iter = celix_longHashMap_begin(msgFilters); !celix_longHashMapIterator_isEnd(&iter); celix_longHashMapIterator_next(&iter)) {
+        const char *filter = iter.value;
+        if (filter == NULL) {
+            return NULL;
+        } else if (first == NULL) {
+            first = filter;
+        } else if (strcmp(first, filter) != 0) {
+            allEqual = false;
+        }
+    }
+    if (first == NULL || allEqual) {
+        return first == NULL ? NULL : strndup(first, 1024 * 1024);
+    }
+
+    char *combined = NULL;
+    size_t combinedLen = 0;
+    FILE *stream = open_memstream(&combined, &combinedLen);
+    fputs("(|", stream);
+    for (celix_long_hash_map_iterator_t iter = celix_longHashMap_begin(msgFilters); !celix_longHashMapIterator_isEnd(&iter); celix_longHashMapIterator_next(&iter)) {
+        fputs(iter.value, stream);
+    }
+    fputc(')', stream);
+    fclose(stream);
+    return combined;
+}
+
+/**
+ * Updates the combined msg filter of a topic receiver entry. If the msg filter changed for a matched entry, the
+ * entry is rematched so that the topic receiver endpoint is announced again with the new msg filter.
+ * Returns true if the psa handling thread should be triggered. Note should be called with the topicReceivers mutex
+ * locked.
+ */
+static bool pstm_updateMsgFilter(pubsub_topology_manager_t *manager, pstm_topic_receiver_or_sender_entry_t *entry) {
+    char *msgFilter = pstm_combinedMsgFilter(entry->msgFilters);
+    bool changed = msgFilter == NULL ? entry->msgFilter != NULL : entry->msgFilter == NULL || strcmp(msgFilter, entry->msgFilter) != 0;
+    free(entry->msgFilter);
+    entry->msgFilter = msgFilter;
+    if (changed && !entry->needsMatch) {
+        entry->needsMatch = true;
+        pstm_markDirty(manager->topicReceivers.dirty, entry);
+        return true;
+    }
+    return false;
+}
+
+static void pstm_destroyMsgFilters(pstm_topic_receiver_or_sender_entry_t *entry) {
+    if (entry->msgFilters != NULL) {
+        for (celix_long_hash_map_iterator_t iter = celix_longHashMap_begin(entry->msgFilters); !celix_longHashMapIterator_isEnd(&iter); celix_longHashMapIterator_next(&iter)) {
+            free(iter.value);
+        }
+        celix_longHashMap_destroy(entry->msgFilters);
+    }
+    free(entry->msgFilter);
+}
+
 void pubsub_topologyManager_subscriberAdded(void *handle, void *svc __attribute__((unused)), const celix_properties_t *props, const celix_bundle_t *bnd) {
     pubsub_topology_manager_t *manager = handle;
 
@@ -321,14 +425,19 @@ void pubsub_topologyManager_subscriberAdded(void *handle, void *svc __attribute_
     }
 
     long bndId = celix_bundle_getId(bnd);
+    long svcId = celix_properties_getAsLong(props, OSGI_FRAMEWORK_SERVICE_ID, -1L);
+    const char *msgFilter = celix_properties_get(props, PUBSUB_SUBSCRIBER_MSG_FILTER, NULL);
     char *scopeAndTopicKey = NULL;
     scopeAndTopicKey = pubsubEndpoint_createScopeTopicKey(scope, topic);
 
     celixThreadMutex_lock(&manager->topicReceivers.mutex);
     pstm_topic_receiver_or_sender_entry_t *entry = hashMap_get(manager->topicReceivers.map, scopeAndTopicKey);
+    bool msgFilterChanged = false;
     if (entry != NULL) {
         entry->usageCount += 1;
         free(scopeAndTopicKey);
+        celix_longHashMap_put(entry->msgFilters, svcId, msgFilter == NULL ? NULL : strndup(msgFilter, 1024 * 1024));
+        msgFilterChanged = pstm_updateMsgFilter(manager, entry);
     } else {
         entry = calloc(1, sizeof(*entry));
         entry->scopeAndTopicKey = scopeAndTopicKey; //note taking owner ship
@@ -340,16 +449,18 @@ void pubsub_topologyManager_subscriberAdded(void *handle, void *svc __attribute_
         entry->needsMatch = true;
         entry->bndId = bndId;
         entry->subscriberProperties = celix_properties_copy(props);
+        entry->msgFilters = celix_longHashMap_create();
+        celix_longHashMap_put(entry->msgFilters, svcId, msgFilter == NULL ? NULL : strndup(msgFilter, 1024 * 1024));
+        entry->msgFilter = pstm_combinedMsgFilter(entry->msgFilters);
         hashMap_put(manager->topicReceivers.map, entry->scopeAndTopicKey, entry);
+        pstm_markDirty(manager->topicReceivers.dirty, entry);
     }
     //signal psa handling thread
-    bool triggerCondition = (entry->usageCount == 1);
+    bool triggerCondition = (entry->usageCount == 1) || msgFilterChanged;
     celixThreadMutex_unlock(&manager->topicReceivers.mutex);
 
     if (triggerCondition) {
-        celixThreadMutex_lock(&manager->psaHandling.mutex);
-        celixThreadCondition_broadcast(&manager->psaHandling.cond);
-        celixThreadMutex_unlock(&manager->psaHandling.mutex);
+        pstm_triggerPsaHandling(manager);
     }
 }
 
@@ -369,13 +480,23 @@ void pubsub_topologyManager_subscriberRemoved(void *handle, void *svc __attribut
     char *scopeAndTopicKey = pubsubEndpoint_createScopeTopicKey(scope, topic);
     celixThreadMutex_lock(&manager->topicReceivers.mutex);
     pstm_topic_receiver_or_sender_entry_t *entry = hashMap_get(manager->topicReceivers.map, scopeAndTopicKey);
+    bool triggerCondition = false;
     if (entry != NULL) {
         entry->usageCount -= 1;
+        free(celix_longHashMap_remove(entry->msgFilters, celix_properties_getAsLong(props, OSGI_FRAMEWORK_SERVICE_ID, -1L)));
+        if (entry->usageCount <= 0) {
+            pstm_markDirty(manager->topicReceivers.dirty, entry);
+            triggerCondition = true;
+        } else {
+            triggerCondition = pstm_updateMsgFilter(manager, entry);
+        }
     }
     celixThreadMutex_unlock(&manager->topicReceivers.mutex);
     free(scopeAndTopicKey);
 
-    //NOTE not waking up psaHandling thread, topic receiver does not need to be removed immediately.
+    if (triggerCondition) {
+        pstm_triggerPsaHandling(manager);
+    }
 }
 
 void pubsub_topologyManager_pubsubAnnounceEndpointListenerAdded(void *handle, void *svc, const celix_properties_t *props __attribute__((unused))) {
@@ -466,6 +587,7 @@ void pubsub_topologyManager_publisherTrackerAdded(void *handle, const celix_serv
         entry->publisherFilter = celix_filter_create(info->filter->filterStr);
         entry->bndId = info->bundleId;
         hashMap_put(manager->topicSenders.map, entry->scopeAndTopicKey, entry);
+        pstm_markDirty(manager->topicSenders.dirty, entry);
     }
     //new entry -> wakeup psaHandling thread
     bool triggerCondition = (entry->usageCount == 1);
@@ -473,9 +595,7 @@ void pubsub_topologyManager_publisherTrackerAdded(void *handle, const celix_serv
     celixThreadMutex_unlock(&manager->topicSenders.mutex);
 
     if (triggerCondition) {
-        celixThreadMutex_lock(&manager->psaHandling.mutex);
-        celixThreadCondition_broadcast(&manager->psaHandling.cond);
-        celixThreadMutex_unlock(&manager->psaHandling.mutex);
+        pstm_triggerPsaHandling(manager);
     }
 }
 
@@ -499,65 +619,77 @@ void pubsub_topologyManager_publisherTrackerRemoved(void *handle, const celix_se
     char *scopeAndTopicKey = pubsubEndpoint_createScopeTopicKey(scope, topic);
     celixThreadMutex_lock(&manager->topicSenders.mutex);
     pstm_topic_receiver_or_sender_entry_t *entry = hashMap_get(manager->topicSenders.map, scopeAndTopicKey);
+    bool triggerCondition = false;
     if (entry != NULL) {
         entry->usageCount -= 1;
+        if (entry->usageCount <= 0) {
+            pstm_markDirty(manager->topicSenders.dirty, entry);
+            triggerCondition = true;
+        }
     }
     celixThreadMutex_unlock(&manager->topicSenders.mutex);
 
     free(scopeAndTopicKey);
     free(topic);
     free(scopeFromFilter);
+
+    if (triggerCondition) {
+        pstm_triggerPsaHandling(manager);
+    }
 }
 
 celix_status_t pubsub_topologyManager_addDiscoveredEndpoint(void *handle, const celix_properties_t *endpoint) {
-    celix_status_t status = CELIX_SUCCESS;
-    pubsub_topology_manager_t *manager = handle;
+    return pubsub_topologyManager_addDiscoveredEndpoints(handle, &endpoint, 1);
+}
 
-    const char *uuid = celix_properties_get(endpoint, PUBSUB_ENDPOINT_UUID, NULL);
-    assert(uuid != NULL); //discovery should check if endpoint is valid -> pubsubEndpoint_isValid.
+celix_status_t pubsub_topologyManager_addDiscoveredEndpoints(void *handle, const celix_properties_t *endpoints[], size_t nrOfEndpoints) {
+    pubsub_topology_manager_t *manager = handle;
 
     // 1) See if endpoint is already discovered, if so increase usage count.
-    // 1) If not, find matching psa using the matchEndpoint
-    // 2) if found call addEndpoint of the matching psa
+    // 1) If not, mark the new entry dirty so that the psa handling thread finds a matching psa
+    // 2) Wake up the psa handling thread once for the whole batch
     bool triggerCondition = false;
 
-    if (manager->verbose) {
-        logHelper_log(manager->loghelper, OSGI_LOGSERVICE_DEBUG,
-                      "PSTM: Discovered endpoint added for topic %s with scope %s [fwUUID=%s, epUUID=%s]\n",
-                      celix_properties_get(endpoint, PUBSUB_ENDPOINT_TOPIC_NAME, NULL),
-                      celix_properties_get(endpoint, PUBSUB_ENDPOINT_TOPIC_SCOPE, NULL),
-                      celix_properties_get(endpoint, PUBSUB_ENDPOINT_FRAMEWORK_UUID, NULL),
-                      uuid);
-    }
-
-
     celixThreadMutex_lock(&manager->discoveredEndpoints.mutex);
-    pstm_discovered_endpoint_entry_t *entry = hashMap_get(manager->discoveredEndpoints.map, uuid);
-    if (entry != NULL) {
-        //already existing endpoint -> increase usage
-        entry->usageCount += 1;
-    } else {
-        //new endpoint -> new entry
-        entry = calloc(1, sizeof(*entry));
-        entry->usageCount = 1;
-        entry->endpoint = celix_properties_copy(endpoint);
-        entry->uuid = celix_properties_get(entry->endpoint, PUBSUB_ENDPOINT_UUID, NULL);
-        entry->selectedPsaSvcId = -1L; //NOTE not selected a psa yet
-        hashMap_put(manager->discoveredEndpoints.map, (void *) entry->uuid, entry);
+    for (size_t i = 0; i < nrOfEndpoints; ++i) {
+        const celix_properties_t *endpoint = endpoints[i];
+        const char *uuid = celix_properties_get(endpoint, PUBSUB_ENDPOINT_UUID, NULL);
+        assert(uuid != NULL); //discovery should check if endpoint is valid -> pubsubEndpoint_isValid.
 
-        //waking up psa handling thread to select psa
-        triggerCondition = true;
+        if (manager->verbose) {
+            logHelper_log(manager->loghelper, OSGI_LOGSERVICE_DEBUG,
+                          "PSTM: Discovered endpoint added for topic %s with scope %s [fwUUID=%s, epUUID=%s]\n",
+                          celix_properties_get(endpoint, PUBSUB_ENDPOINT_TOPIC_NAME, NULL),
+                          celix_properties_get(endpoint, PUBSUB_ENDPOINT_TOPIC_SCOPE, NULL),
+                          celix_properties_get(endpoint, PUBSUB_ENDPOINT_FRAMEWORK_UUID, NULL),
+                          uuid);
+        }
 
+        pstm_discovered_endpoint_entry_t *entry = hashMap_get(manager->discoveredEndpoints.map, uuid);
+        if (entry != NULL) {
+            //already existing endpoint -> increase usage
+            entry->usageCount += 1;
+        } else {
+            //new endpoint -> new entry
+            entry = calloc(1, sizeof(*entry));
+            entry->usageCount = 1;
+            entry->endpoint = celix_properties_copy(endpoint);
+            entry->uuid = celix_properties_get(entry->endpoint, PUBSUB_ENDPOINT_UUID, NULL);
+            entry->selectedPsaSvcId = -1L; //NOTE not selected a psa yet
+            hashMap_put(manager->discoveredEndpoints.map, (void *) entry->uuid, entry);
+            pstm_markEndpointDirty(manager->discoveredEndpoints.dirty, entry);
+
+            //waking up psa handling thread to select psa
+            triggerCondition = true;
+        }
     }
     celixThreadMutex_unlock(&manager->discoveredEndpoints.mutex);
 
     if (triggerCondition) {
-        celixThreadMutex_lock(&manager->psaHandling.mutex);
-        celixThreadCondition_broadcast(&manager->psaHandling.cond);
-        celixThreadMutex_unlock(&manager->psaHandling.mutex);
+        pstm_triggerPsaHandling(manager);
     }
 
-    return status;
+    return CELIX_SUCCESS;
 }
 
 static void pstm_removeEndpointCallback(void *handle, void *svc) {
@@ -567,50 +699,61 @@ static void pstm_removeEndpointCallback(void *handle, void *svc) {
 }
 
 celix_status_t pubsub_topologyManager_removeDiscoveredEndpoint(void *handle, const celix_properties_t *endpoint) {
+    return pubsub_topologyManager_removeDiscoveredEndpoints(handle, &endpoint, 1);
+}
+
+celix_status_t pubsub_topologyManager_removeDiscoveredEndpoints(void *handle, const celix_properties_t *endpoints[], size_t nrOfEndpoints) {
     pubsub_topology_manager_t *manager = handle;
 
     // 1) See if endpoint is already discovered, if so decrease usage count.
-    // 1) If usage count becomes 0, find matching psa using the matchEndpoint
-    // 2) if found call disconnectEndpoint of the matching psa
-
-    const char *uuid = celix_properties_get(endpoint, PUBSUB_ENDPOINT_UUID, NULL);
-    assert(uuid != NULL); //discovery should check if endpoint is valid -> pubsubEndoint_isValid.
-
-    if (manager->verbose) {
-        logHelper_log(manager->loghelper, OSGI_LOGSERVICE_DEBUG,
-                      "PSTM: Discovered endpoint removed for topic %s with scope %s [fwUUID=%s, epUUID=%s]\n",
-                      celix_properties_get(endpoint, PUBSUB_ENDPOINT_TOPIC_NAME, NULL),
-                      celix_properties_get(endpoint, PUBSUB_ENDPOINT_TOPIC_SCOPE, NULL),
-                      celix_properties_get(endpoint, PUBSUB_ENDPOINT_FRAMEWORK_UUID, NULL),
-                      uuid);
-    }
+    // 1) If usage count becomes 0, remove the entry
+    // 2) Outside the lock, call removeDiscoveredEndpoint of the selected psa of the removed entries
 
+    celix_array_list_t *removed = celix_arrayList_create();
     celixThreadMutex_lock(&manager->discoveredEndpoints.mutex);
-    pstm_discovered_endpoint_entry_t *entry = hashMap_get(manager->discoveredEndpoints.map, uuid);
-    if (entry != NULL) {
-        //already existing endpoint -> decrease usage
-        entry->usageCount -= 1;
-        if (entry->usageCount <= 0) {
-            hashMap_remove(manager->discoveredEndpoints.map, entry->uuid);
-        } else {
-            entry = NULL; //still used (usage count > 0) -> do nothing
+    for (size_t i = 0; i < nrOfEndpoints; ++i) {
+        const celix_properties_t *endpoint = endpoints[i];
+        const char *uuid = celix_properties_get(endpoint, PUBSUB_ENDPOINT_UUID, NULL);
+        assert(uuid != NULL); //discovery should check if endpoint is valid -> pubsubEndoint_isValid.
+
+        if (manager->verbose) {
+            logHelper_log(manager->loghelper, OSGI_LOGSERVICE_DEBUG,
+                          "PSTM: Discovered endpoint removed for topic %s with scope %s [fwUUID=%s, epUUID=%s]\n",
+                          celix_properties_get(endpoint, PUBSUB_ENDPOINT_TOPIC_NAME, NULL),
+                          celix_properties_get(endpoint, PUBSUB_ENDPOINT_TOPIC_SCOPE, NULL),
+                          celix_properties_get(endpoint, PUBSUB_ENDPOINT_FRAMEWORK_UUID, NULL),
+                          uuid);
+        }
+
+        pstm_discovered_endpoint_entry_t *entry = hashMap_get(manager->discoveredEndpoints.map, uuid);
+        if (entry != NULL) {
+            //already existing endpoint -> decrease usage
+            entry->usageCount -= 1;
+            if (entry->usageCount <= 0) {
+                hashMap_remove(manager->discoveredEndpoints.map, entry->uuid);
+                if (entry->dirty) {
+                    celix_arrayList_remove(manager->discoveredEndpoints.dirty, entry);
+                }
+                celix_arrayList_add(removed, entry);
+            } //else still used (usage count > 0) -> do nothing
         }
     }
     celixThreadMutex_unlock(&manager->discoveredEndpoints.mutex);
 
-    if (entry != NULL) {
+    for (int i = 0; i < celix_arrayList_size(removed); ++i) {
+        pstm_discovered_endpoint_entry_t *entry = celix_arrayList_get(removed, i);
         //note entry is removed from manager->discoveredEndpoints, also inform used psa
         if (entry->selectedPsaSvcId >= 0) {
             //note that it is possible that the psa is already gone, in that case the call is also not needed anymore.
             celix_bundleContext_useServiceWithId(manager->context, entry->selectedPsaSvcId, PUBSUB_ADMIN_SERVICE_NAME,
-                                                 (void *) endpoint, pstm_removeEndpointCallback);
+                                                 entry->endpoint, pstm_removeEndpointCallback);
         } else {
             logHelper_log(manager->loghelper, OSGI_LOGSERVICE_DEBUG, "No selected psa for endpoint %s\n", entry->uuid);
         }
         celix_properties_destroy(entry->endpoint);
         free(entry);
     }
-
+    celix_arrayList_destroy(removed);
 
     return CELIX_SUCCESS;
 }
@@ -624,9 +767,8 @@ static void pstm_teardownTopicSenderCallback(void *handle, void *svc) {
 
 static void pstm_teardownTopicSenders(pubsub_topology_manager_t *manager) {
     celixThreadMutex_lock(&manager->topicSenders.mutex);
-    hash_map_iterator_t iter = hashMapIterator_construct(manager->topicSenders.map);
-    while (hashMapIterator_hasNext(&iter)) {
-        pstm_topic_receiver_or_sender_entry_t *entry = hashMapIterator_nextValue(&iter);
+    for (int i = 0; i < celix_arrayList_size(manager->topicSenders.dirty); ++i) {
+        pstm_topic_receiver_or_sender_entry_t *entry = celix_arrayList_get(manager->topicSenders.dirty, i);
 
         if (entry != NULL && (entry->usageCount <= 0 || entry->needsMatch)) {
             if (manager->verbose && entry->endpoint != NULL) {
@@ -651,7 +793,8 @@ static void pstm_teardownTopicSenders(pubsub_topology_manager_t *manager) {
             //cleanup entry
             if (entry->usageCount <= 0) {
                 //no usage -> remove
-                hashMapIterator_remove(&iter);
+                hashMap_remove(manager->topicSenders.map, entry->scopeAndTopicKey);
+                celix_arrayList_removeAt(manager->topicSenders.dirty, i--);
                 free(entry->scopeAndTopicKey);
                 free(entry->scope);
                 free(entry->topic);
@@ -687,9 +830,8 @@ static void pstm_teardownTopicReceiverCallback(void *handle, void *svc) {
 
 static void pstm_teardownTopicReceivers(pubsub_topology_manager_t *manager) {
     celixThreadMutex_lock(&manager->topicReceivers.mutex);
-    hash_map_iterator_t iter = hashMapIterator_construct(manager->topicReceivers.map);
-    while (hashMapIterator_hasNext(&iter)) {
-        pstm_topic_receiver_or_sender_entry_t *entry = hashMapIterator_nextValue(&iter);
+    for (int i = 0; i < celix_arrayList_size(manager->topicReceivers.dirty); ++i) {
+        pstm_topic_receiver_or_sender_entry_t *entry = celix_arrayList_get(manager->topicReceivers.dirty, i);
         if (entry != NULL && (entry->usageCount <= 0 || entry->needsMatch)) {
             if (manager->verbose && entry->endpoint != NULL) {
                 const char *adminType = celix_properties_get(entry->endpoint, PUBSUB_ENDPOINT_ADMIN_TYPE, "!Error!");
@@ -714,7 +856,8 @@ static void pstm_teardownTopicReceivers(pubsub_topology_manager_t *manager) {
 
             if (entry->usageCount <= 0) {
                 //no usage -> remove
-                hashMapIterator_remove(&iter);
+                hashMap_remove(manager->topicReceivers.map, entry->scopeAndTopicKey);
+                celix_arrayList_removeAt(manager->topicReceivers.dirty, i--);
                 //cleanup entry
                 free(entry->scopeAndTopicKey);
                 free(entry->scope);
@@ -728,13 +871,18 @@ static void pstm_teardownTopicReceivers(pubsub_topology_manager_t *manager) {
                 if (entry->endpoint != NULL) {
                     celix_properties_destroy(entry->endpoint);
                 }
+                pstm_destroyMsgFilters(entry);
                 free(entry);
             } else {
                 //still usage -> setup for rematch
                 if (entry->endpoint != NULL) {
                     celix_properties_destroy(entry->endpoint);
                 }
+                if (entry->topicProperties != NULL) {
+                    celix_properties_destroy(entry->topicProperties);
+                }
                 entry->endpoint = NULL;
+                entry->topicProperties = NULL;
                 entry->selectedPsaSvcId = -1L;
                 entry->selectedSerializerSvcId = -1L;
             }
@@ -751,10 +899,9 @@ static void pstm_addEndpointCallback(void *handle, void *svc) {
 
 static void pstm_findPsaForEndpoints(pubsub_topology_manager_t *manager) {
     celixThreadMutex_lock(&manager->discoveredEndpoints.mutex);
-    hash_map_iterator_t iter = hashMapIterator_construct(manager->discoveredEndpoints.map);
-    while (hashMapIterator_hasNext(&iter)) {
-        pstm_discovered_endpoint_entry_t *entry = hashMapIterator_nextValue(&iter);
-        if (entry != NULL && entry->selectedPsaSvcId < 0) {
+    for (int i = 0; i < celix_arrayList_size(manager->discoveredEndpoints.dirty); ++i) {
+        pstm_discovered_endpoint_entry_t *entry = celix_arrayList_get(manager->discoveredEndpoints.dirty, i);
+        if (entry->selectedPsaSvcId < 0) {
             long psaSvcId = -1L;
 
             celixThreadMutex_lock(&manager->pubsubadmins.mutex);
@@ -781,6 +928,11 @@ static void pstm_findPsaForEndpoints(pubsub_topology_manager_t *manager) {
 
             entry->selectedPsaSvcId = psaSvcId;
         }
+        if (entry->selectedPsaSvcId >= 0) {
+            //note entries without a matching psa stay dirty and are retried
+            entry->dirty = false;
+            celix_arrayList_removeAt(manager->discoveredEndpoints.dirty, i--);
+        }
     }
     celixThreadMutex_unlock(&manager->discoveredEndpoints.mutex);
 }
@@ -794,10 +946,9 @@ static void pstm_setupTopicSenderCallback(void *handle, void *svc) {
 
 static void pstm_setupTopicSenders(pubsub_topology_manager_t *manager) {
     celixThreadMutex_lock(&manager->topicSenders.mutex);
-    hash_map_iterator_t iter = hashMapIterator_construct(manager->topicSenders.map);
-    while (hashMapIterator_hasNext(&iter)) {
-        pstm_topic_receiver_or_sender_entry_t *entry = hashMapIterator_nextValue(&iter);
-        if (entry != NULL && entry->needsMatch && entry->usageCount > 0) {
+    for (int i = 0; i < celix_arrayList_size(manager->topicSenders.dirty); ++i) {
+        pstm_topic_receiver_or_sender_entry_t *entry = celix_arrayList_get(manager->topicSenders.dirty, i);
+        if (entry->needsMatch && entry->usageCount > 0) {
             //new topic sender needed, requesting match with current psa
             double highestScore = PUBSUB_ADMIN_NO_MATCH_SCORE;
             long serializerSvcId = -1L;
@@ -851,6 +1002,11 @@ static void pstm_setupTopicSenders(pubsub_topology_manager_t *manager) {
                 logHelper_log(manager->loghelper, OSGI_LOGSERVICE_WARNING, "Cannot setup TopicSender for %s/%s\n", entry->scope, entry->topic);
             }
         }
+        if (!entry->needsMatch) {
+            //note entries which could not be matched stay dirty and are retried
+            entry->dirty = false;
+            celix_arrayList_removeAt(manager->topicSenders.dirty, i--);
+        }
     }
     celixThreadMutex_unlock(&manager->topicSenders.mutex);
 }
@@ -863,10 +1019,9 @@ static void pstm_setupTopicReceiverCallback(void *handle, void *svc) {
 
 static void pstm_setupTopicReceivers(pubsub_topology_manager_t *manager) {
     celixThreadMutex_lock(&manager->topicReceivers.mutex);
-    hash_map_iterator_t iter = hashMapIterator_construct(manager->topicReceivers.map);
-    while (hashMapIterator_hasNext(&iter)) {
-        pstm_topic_receiver_or_sender_entry_t *entry = hashMapIterator_nextValue(&iter);
-        if (entry != NULL && entry->needsMatch && entry->usageCount > 0) {
+    for (int i = 0; i < celix_arrayList_size(manager->topicReceivers.dirty); ++i) {
+        pstm_topic_receiver_or_sender_entry_t *entry = celix_arrayList_get(manager->topicReceivers.dirty, i);
+        if (entry->needsMatch && entry->usageCount > 0) {
 
             double highestScore = PUBSUB_ADMIN_NO_MATCH_SCORE;
             long serializerSvcId = -1L;
@@ -902,6 +1057,13 @@ static void pstm_setupTopicReceivers(pubsub_topology_manager_t *manager) {
                 entry->selectedPsaSvcId = selectedPsaSvcId;
                 entry->selectedSerializerSvcId = serializerSvcId;
                 entry->topicProperties = highestMatchTopicProperties;
+                if (entry->msgFilter != NULL) {
+                    //note the combined msg filter of the subscribers is handed over to the psa as topic property
+                    if (entry->topicProperties == NULL) {
+                        entry->topicProperties = celix_properties_create();
+                    }
+                    celix_properties_set(entry->topicProperties, PUBSUB_SUBSCRIBER_MSG_FILTER, entry->msgFilter);
+                }
 
                 bool called = celix_bundleContext_useServiceWithId(manager->context, selectedPsaSvcId, PUBSUB_ADMIN_SERVICE_NAME,
                                                                    entry,
@@ -925,6 +1087,11 @@ static void pstm_setupTopicReceivers(pubsub_topology_manager_t *manager) {
                 logHelper_log(manager->loghelper, OSGI_LOGSERVICE_WARNING, "Cannot setup TopicReceiver for %s/%s\n", entry->scope, entry->topic);
             }
         }
+        if (!entry->needsMatch) {
+            //note entries which could not be matched stay dirty and are retried
+            entry->dirty = false;
+            celix_arrayList_removeAt(manager->topicReceivers.dirty, i--);
+        }
     }
     celixThreadMutex_unlock(&manager->topicReceivers.mutex);
 }
@@ -947,8 +1114,27 @@ static void *pstm_psaHandlingThread(void *data) {
 
         pstm_findPsaForEndpoints(manager); //trying to find psa and possible set for endpoints with no psa
 
+        //entries which are still dirty could not be matched and are retried periodically
+        int pending = 0;
+        celixThreadMutex_lock(&manager->topicSenders.mutex);
+        pending += celix_arrayList_size(manager->topicSenders.dirty);
+        celixThreadMutex_unlock(&manager->topicSenders.mutex);
+        celixThreadMutex_lock(&manager->topicReceivers.mutex);
+        pending += celix_arrayList_size(manager->topicReceivers.dirty);
+        celixThreadMutex_unlock(&manager->topicReceivers.mutex);
+        celixThreadMutex_lock(&manager->discoveredEndpoints.mutex);
+        pending += celix_arrayList_size(manager->discoveredEndpoints.dirty);
+        celixThreadMutex_unlock(&manager->discoveredEndpoints.mutex);
+
         celixThreadMutex_lock(&manager->psaHandling.mutex);
-        celixThreadCondition_timedwaitRelative(&manager->psaHandling.cond, &manager->psaHandling.mutex, PSTM_PSA_HANDLING_SLEEPTIME_IN_SECONDS, 0L);
+        if (!manager->psaHandling.triggered && manager->psaHandling.running) {
+            if (pending > 0) {
+                celixThreadCondition_timedwaitRelative(&manager->psaHandling.cond, &manager->psaHandling.mutex, PSTM_PSA_HANDLING_SLEEPTIME_IN_SECONDS, 0L);
+            } else {
+                celixThreadCondition_wait(&manager->psaHandling.cond, &manager->psaHandling.mutex);
+            }
+        }
+        manager->psaHandling.triggered = false;
         running = manager->psaHandling.running;
         celixThreadMutex_unlock(&manager->psaHandling.mutex);
     }
@@ -1108,73 +1294,137 @@ static celix_status_t pubsub_topologyManager_topology(pubsub_topology_manager_t
     return CELIX_SUCCESS;
 }
 
-static void fetchBundleName(void *handle, const bundle_t *bundle) {
-    const char **out = handle;
-    *out = celix_bundle_getSymbolicName(bundle);
+static void printHistogram(FILE *os, const char *name, const pubsub_metrics_histogram_t *histogram) {
+    if (histogram == NULL || histogram->count == 0) {
+        return;
+    }
+    fprintf(os, "      |- %s = avg %" PRIu64 " ns, p50 %" PRIu64 " ns, p99 %" PRIu64 " ns, max %" PRIu64 " ns\n",
+            name,
+            histogram->sumInNs / histogram->count,
+            pubsub_metricsHistogram_valueAtPercentile(histogram, 50.0),
+            pubsub_metricsHistogram_valueAtPercentile(histogram, 99.0),
+            histogram->maxInNs);
+}
+
+/**
+ * Prints a metrics entry. Called with the metrics locks of the PSA taken, so only formats the already interned data.
+ */
+static void printMetricsEntry(void *handle, const pubsub_metrics_entry_t *entry) {
+    FILE *os = handle;
+    if (entry->type == PUBSUB_METRICS_TOPIC_SENDER) {
+        fprintf(os, "|- Topic Sender %s/%s (%s)\n", entry->scope == NULL ? "default" : entry->scope, entry->topic, entry->psaType);
+        fprintf(os, "   |- send queue size = %lu bytes (max %lu bytes), dropped msgs = %lu\n",
+                entry->sendQueueSize, entry->maxSendQueueSize, entry->nrOfMessagesDropped);
+    } else if (entry->type == PUBSUB_METRICS_SEND_MSG) {
+        if (entry->nrOfMessages == 0 && entry->nrOfMessagesFailed == 0 && entry->nrOfSerializationErrors == 0) {
+            return;
+        }
+        fprintf(os, "   |- Message '%s' for %s/%s from bundle %li (%s):\n", entry->msgFqn,
+                entry->scope == NULL ? "default" : entry->scope, entry->topic, entry->bndId, entry->psaType);
+        fprintf(os, "      |- msg type = 0x%X\n", entry->msgTypeId);
+        fprintf(os, "      |- send count = %lu\n", entry->nrOfMessages);
+        fprintf(os, "      |- fail count = %lu\n", entry->nrOfMessagesFailed);
+        fprintf(os, "      |- serialization failed = %lu\n", entry->nrOfSerializationErrors);
+        printHistogram(os, "serialization time", entry->serializationTime);
+    } else {
+        if (entry->nrOfMessages == 0) {
+            return;
+        }
+        char uuidStr[UUID_STR_LEN+1];
+        uuid_unparse(entry->originUUID, uuidStr);
+        fprintf(os, "|- Topic Receiver %s/%s (%s), message '%s' for bundle %li from framework UUID %s:\n",
+                entry->scope == NULL ? "default" : entry->scope, entry->topic, entry->psaType,
+                entry->msgFqn == NULL ? "unknown" : entry->msgFqn, entry->bndId, uuidStr);
+        fprintf(os, "      |- msg type = 0x%X\n", entry->msgTypeId);
+        fprintf(os, "      |- receive count = %lu\n", entry->nrOfMessages);
+        fprintf(os, "      |- serialization error = %lu\n", entry->nrOfSerializationErrors);
+        fprintf(os, "      |- missing seq numbers = %lu\n", entry->nrOfMissingSeqNumbers);
+        printHistogram(os, "delay", entry->delay);
+        printHistogram(os, "serialization time", entry->serializationTime);
+    }
 }
 
-static celix_status_t pubsub_topologyManager_metrics(pubsub_topology_manager_t *manager, char *commandLine __attribute__((unused)), FILE *os, FILE *errorStream __attribute__((unused))) {
-    celix_array_list_t *psaMetrics = celix_arrayList_create();
+static celix_status_t pubsub_topologyManager_metrics(pubsub_topology_manager_t *manager, char *commandLine, FILE *os, FILE *errorStream __attribute__((unused))) {
+    //optional "pstm m <seconds>" only prints the msg entries with msgs send/received in the last <seconds> seconds
+    struct timespec changedSince;
+    bool filter = false;
+    char *sep = strchr(commandLine, ' ');
+    sep = sep == NULL ? NULL : strchr(sep + 1, ' ');
+    if (sep != NULL) {
+        long seconds = strtol(sep + 1, NULL, 10);
+        if (seconds > 0) {
+            clock_gettime(CLOCK_REALTIME, &changedSince);
+            changedSince.tv_sec -= seconds;
+            filter = true;
+        }
+    }
+
     celixThreadMutex_lock(&manager->psaMetrics.mutex);
     hash_map_iterator_t iter = hashMapIterator_construct(manager->psaMetrics.map);
     while (hashMapIterator_hasNext(&iter)) {
         pubsub_admin_metrics_service_t *svc = hashMapIterator_nextValue(&iter);
-        pubsub_admin_metrics_t *m = svc->metrics(svc->handle);
-        celix_arrayList_add(psaMetrics, m);
+        svc->visitMetrics(svc->handle, filter ? &changedSince : NULL, os, printMetricsEntry);
     }
     celixThreadMutex_unlock(&manager->psaMetrics.mutex);
+    return CELIX_SUCCESS;
+}
 
-    for (int i = 0; i < celix_arrayList_size(psaMetrics); ++i) {
-        pubsub_admin_metrics_t *metrics = celix_arrayList_get(psaMetrics, i);
-        fprintf(os, "Metric for PSA %s:\n", metrics->psaType);
-        for (int k = 0; k < celix_arrayList_size(metrics->senders); ++k) {
-            pubsub_admin_sender_metrics_t *sm = celix_arrayList_get(metrics->senders, k);
-            fprintf(os, "|- Topic Sender %s/%s\n", sm->scope, sm->topic);
-            for (int j = 0; j < sm->nrOfmsgMetrics; ++j) {
-                if (sm->msgMetrics[j].nrOfMessagesSend == 0 && sm->msgMetrics[j].nrOfMessagesSendFailed == 0 && sm->msgMetrics[j].nrOfSerializationErrors == 0) {
-                    continue;
-                }
-                const char *bndName = NULL;
-                celix_bundleContext_useBundle(manager->context, sm->msgMetrics->bndId, &bndName, fetchBundleName);
-                fprintf(os, "   |- Message '%s' from bundle '%s' (%li):\n", sm->msgMetrics[j].typeFqn, bndName, sm->msgMetrics->bndId);
-                fprintf(os, "      |- msg type = 0x%X\n", sm->msgMetrics[j].typeId);
-                fprintf(os, "      |- send count = %li\n", sm->msgMetrics[j].nrOfMessagesSend);
-                fprintf(os, "      |- fail count = %li\n", sm->msgMetrics[j].nrOfMessagesSendFailed);
-                fprintf(os, "      |- serialization failed = %li\n", sm->msgMetrics[j].nrOfSerializationErrors);
-                fprintf(os, "      |- average serialization time = %f s\n", sm->msgMetrics[j].averageSerializationTimeInSeconds);
-                fprintf(os, "      |- average time between messages = %f s\n", sm->msgMetrics[j].averageTimeBetweenMessagesInSeconds);
-                //TODO last msg send
-            }
-        }
-        for (int k = 0; k < celix_arrayList_size(metrics->receivers); ++k) {
-            pubsub_admin_receiver_metrics_t *rm = celix_arrayList_get(metrics->receivers, k);
-            fprintf(os, "|- Topic Receiver %s/%s:\n", rm->scope, rm->topic);
-            for (int j = 0; j < rm->nrOfMsgTypes; ++j) {
-                int nrOfOrigins = rm->msgTypes[j].nrOfOrigins;
-                for (int m = 0; m < nrOfOrigins; ++m) {
-                    long nrOfMessageReceived = rm->msgTypes[j].origins[m].nrOfMessagesReceived;
-                    if (nrOfMessageReceived == 0) {
-                        continue;
-                    }
-                    char uuidStr[UUID_STR_LEN+1];
-                    uuid_unparse(rm->msgTypes[j].origins[m].originUUID, uuidStr);
-                    fprintf(os, "   |- Message '%s' from framework UUID %s:\n", rm->msgTypes[j].typeFqn, uuidStr);
-                    fprintf(os, "      |- msg type = 0x%X\n", rm->msgTypes[j].typeId);
-                    fprintf(os, "      |- receive count = %li\n", rm->msgTypes[j].origins[m].nrOfMessagesReceived);
-                    fprintf(os, "      |- serialization error = %li\n", rm->msgTypes[j].origins[m].nrOfSerializationErrors);
-                    fprintf(os, "      |- missing seq numbers = %li\n", rm->msgTypes[j].origins[m].nrOfMissingSeqNumbers);
-                    fprintf(os, "      |- average delay = %fs\n", rm->msgTypes[j].origins[m].averageDelayInSeconds);
-                    fprintf(os, "      |- max delay = %fs\n", rm->msgTypes[j].origins[m].maxDelayInSeconds);
-                    fprintf(os, "      |- min delay = %fs\n", rm->msgTypes[j].origins[m].minDelayInSeconds);
-                    fprintf(os, "      |- average serialization time = %fs\n", rm->msgTypes[j].origins[m].averageSerializationTimeInSeconds);
-                    fprintf(os, "      |- average time between messages time = %fs\n", rm->msgTypes[j].origins[m].averageTimeBetweenMessagesInSeconds);
-                }
-            }
-        }
-        pubsub_freePubSubAdminMetrics(metrics);
+static void writeHistogramMetrics(const celix_metrics_writer_t *writer, const char *name, const char *help, const char *labels, const pubsub_metrics_histogram_t *histogram) {
+    if (histogram == NULL || histogram->count == 0) {
+        return;
     }
-    celix_arrayList_destroy(psaMetrics);
-    return CELIX_SUCCESS;
+    char statLabels[512];
+    snprintf(statLabels, sizeof(statLabels), "%s,stat=\"mean\"", labels);
+    writer->write(writer->handle, name, CELIX_METRIC_GAUGE, help, statLabels, (double)(histogram->sumInNs / histogram->count) / 1e9);
+    snprintf(statLabels, sizeof(statLabels), "%s,stat=\"p99\"", labels);
+    writer->write(writer->handle, name, CELIX_METRIC_GAUGE, help, statLabels, (double)pubsub_metricsHistogram_valueAtPercentile(histogram, 99.0) / 1e9);
+    snprintf(statLabels, sizeof(statLabels), "%s,stat=\"max\"", labels);
+    writer->write(writer->handle, name, CELIX_METRIC_GAUGE, help, statLabels, (double)histogram->maxInNs / 1e9);
+}
+
+/**
+ * Writes a metrics entry as metric samples. As printMetricsEntry, called with the metrics locks of the PSA taken.
+ */
+static void writeMetricsEntry(void *handle, const pubsub_metrics_entry_t *entry) {
+    const celix_metrics_writer_t *writer = handle;
+    void *h = writer->handle;
+    char labels[384];
+    if (entry->type == PUBSUB_METRICS_TOPIC_SENDER) {
+        snprintf(labels, sizeof(labels), "psa=\"%s\",scope=\"%s\",topic=\"%s\"",
+                 entry->psaType, entry->scope == NULL ? "default" : entry->scope, entry->topic);
+        writer->write(h, "celix_pubsub_send_queue_bytes", CELIX_METRIC_GAUGE, "Nr of bytes queued for all subscriber connections", labels, (double)entry->sendQueueSize);
+        writer->write(h, "celix_pubsub_send_queue_max_bytes", CELIX_METRIC_GAUGE, "Highest nr of bytes queued for a single subscriber connection", labels, (double)entry->maxSendQueueSize);
+        writer->write(h, "celix_pubsub_messages_dropped_total", CELIX_METRIC_COUNTER, "Nr of msgs dropped by the send queue policy", labels, (double)entry->nrOfMessagesDropped);
+    } else if (entry->type == PUBSUB_METRICS_SEND_MSG) {
+        snprintf(labels, sizeof(labels), "psa=\"%s\",scope=\"%s\",topic=\"%s\",msg=\"%s\",bnd=\"%li\"",
+                 entry->psaType, entry->scope == NULL ? "default" : entry->scope, entry->topic, entry->msgFqn, entry->bndId);
+        writer->write(h, "celix_pubsub_messages_sent_total", CELIX_METRIC_COUNTER, "Nr of send msgs", labels, (double)entry->nrOfMessages);
+        writer->write(h, "celix_pubsub_send_failures_total", CELIX_METRIC_COUNTER, "Nr of failed msg sends", labels, (double)entry->nrOfMessagesFailed);
+        writer->write(h, "celix_pubsub_send_serialization_errors_total", CELIX_METRIC_COUNTER, "Nr of msgs which could not be serialized", labels, (double)entry->nrOfSerializationErrors);
+        writeHistogramMetrics(writer, "celix_pubsub_serialization_seconds", "Msg serialization time", labels, entry->serializationTime);
+    } else {
+        char uuidStr[UUID_STR_LEN+1];
+        uuid_unparse(entry->originUUID, uuidStr);
+        snprintf(labels, sizeof(labels), "psa=\"%s\",scope=\"%s\",topic=\"%s\",msg=\"%s\",bnd=\"%li\",origin=\"%s\"",
+                 entry->psaType, entry->scope == NULL ? "default" : entry->scope, entry->topic,
+                 entry->msgFqn == NULL ? "unknown" : entry->msgFqn, entry->bndId, uuidStr);
+        writer->write(h, "celix_pubsub_messages_received_total", CELIX_METRIC_COUNTER, "Nr of received msgs", labels, (double)entry->nrOfMessages);
+        writer->write(h, "celix_pubsub_receive_serialization_errors_total", CELIX_METRIC_COUNTER, "Nr of received msgs which could not be deserialized", labels, (double)entry->nrOfSerializationErrors);
+        writer->write(h, "celix_pubsub_missing_seq_numbers_total", CELIX_METRIC_COUNTER, "Nr of missing msg sequence numbers", labels, (double)entry->nrOfMissingSeqNumbers);
+        writeHistogramMetrics(writer, "celix_pubsub_deserialization_seconds", "Msg deserialization time", labels, entry->serializationTime);
+        writeHistogramMetrics(writer, "celix_pubsub_delay_seconds", "Delay between sending and receiving a msg", labels, entry->delay);
+    }
+}
+
+void pubsub_topologyManager_collectMetrics(void *handle, const celix_metrics_writer_t *writer) {
+    pubsub_topology_manager_t *manager = handle;
+    celixThreadMutex_lock(&manager->psaMetrics.mutex);
+    hash_map_iterator_t iter = hashMapIterator_construct(manager->psaMetrics.map);
+    while (hashMapIterator_hasNext(&iter)) {
+        pubsub_admin_metrics_service_t *svc = hashMapIterator_nextValue(&iter);
+        svc->visitMetrics(svc->handle, NULL, (void *)writer, writeMetricsEntry);
+    }
+    celixThreadMutex_unlock(&manager->psaMetrics.mutex);
 }
 
 celix_status_t pubsub_topologyManager_shellCommand(void *handle, char *commandLine, FILE *os, FILE *errorStream) {
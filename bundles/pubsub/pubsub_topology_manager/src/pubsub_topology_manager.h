@@ -25,6 +25,8 @@
 #include "log_helper.h"
 #include "command.h"
 #include "celix_bundle_context.h"
+#include "celix_hash_map.h"
+#include "celix_metrics_service.h"
 
 #include "pubsub_endpoint.h"
 #include "pubsub/publisher.h"
@@ -45,16 +47,19 @@ typedef struct pubsub_topology_manager {
     struct {
         celix_thread_mutex_t mutex;
         hash_map_t *map; //key = uuid , value = pstm_discovered_endpoint_entry_t
+        celix_array_list_t *dirty; //<pstm_discovered_endpoint_entry_t*>, entries without a selected psa
     } discoveredEndpoints;
 
     struct {
         celix_thread_mutex_t mutex;
         hash_map_t *map; //key = scope/topic key, value = pstm_topic_receiver_or_sender_entry_t*
+        celix_array_list_t *dirty; //<pstm_topic_receiver_or_sender_entry_t*>, entries which need a teardown or (re)match
     } topicReceivers;
 
     struct {
         celix_thread_mutex_t mutex;
         hash_map_t *map; //key = scope/topic key, value = pstm_topic_receiver_or_sender_entry_t*
+        celix_array_list_t *dirty; //<pstm_topic_receiver_or_sender_entry_t*>, entries which need a teardown or (re)match
     } topicSenders;
 
     struct {
@@ -72,6 +77,7 @@ typedef struct pubsub_topology_manager {
         celix_thread_mutex_t mutex; //protect running and condition
         celix_thread_cond_t cond;
         bool running;
+        bool triggered; //true if an entry became dirty since the psa handling thread last checked
     } psaHandling;
 
     log_helper_t *loghelper;
@@ -83,11 +89,13 @@ typedef struct pstm_discovered_endpoint_entry {
     const char *uuid;
     long selectedPsaSvcId; // -1L, indicates no selected psa
     int usageCount; //note that discovered endpoints can be found multiple times by different pubsub discovery components
+    bool dirty; //true if the entry is in the discoveredEndpoints dirty list
     celix_properties_t *endpoint;
 } pstm_discovered_endpoint_entry_t;
 
 typedef struct pstm_topic_receiver_or_sender_entry {
     bool needsMatch; //true if a psa needs to be selected or if a new psa has to be considered.
+    bool dirty; //true if the entry is in the dirty list of the topicReceivers or topicSenders
 
     char *scopeAndTopicKey; //key of the combined value of the scope and topic
     celix_properties_t *endpoint;
@@ -104,6 +112,8 @@ typedef struct pstm_topic_receiver_or_sender_entry {
 
     //for receiver entry
     celix_properties_t *subscriberProperties;
+    celix_long_hash_map_t *msgFilters; //key = subscriber svc id, value = msg filter (char*) or NULL
+    char *msgFilter; //combined msg filter of the subscribers, NULL if a subscriber needs all msgs
 } pstm_topic_receiver_or_sender_entry_t;
 
 celix_status_t pubsub_topologyManager_create(celix_bundle_context_t *context, log_helper_t *logHelper, pubsub_topology_manager_t **manager);
@@ -123,10 +133,18 @@ void pubsub_topologyManager_publisherTrackerRemoved(void *handle, const celix_se
 
 celix_status_t pubsub_topologyManager_addDiscoveredEndpoint(void *handle, const celix_properties_t *properties);
 celix_status_t pubsub_topologyManager_removeDiscoveredEndpoint(void *handle, const celix_properties_t *properties);
+celix_status_t pubsub_topologyManager_addDiscoveredEndpoints(void *handle, const celix_properties_t *endpoints[], size_t nrOfEndpoints);
+celix_status_t pubsub_topologyManager_removeDiscoveredEndpoints(void *handle, const celix_properties_t *endpoints[], size_t nrOfEndpoints);
 
 celix_status_t pubsub_topologyManager_shellCommand(void *handle, char * commandLine, FILE *outStream, FILE *errorStream);
 
 void pubsub_topologyManager_addMetricsService(void * handle, void *svc, const celix_properties_t *props);
 void pubsub_topologyManager_removeMetricsService(void * handle, void *svc, const celix_properties_t *props);
 
+/**
+ * Collect callback of the metrics provider service of the topology manager, exports the metrics entries of all
+ * tracked PSA metrics services.
+ */
+void pubsub_topologyManager_collectMetrics(void *handle, const celix_metrics_writer_t *writer);
+
 #endif /* PUBSUB_TOPOLOGY_MANAGER_H_ */
@@ -0,0 +1,159 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *  KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <cstdio>
+#include <cstring>
+#include <vector>
+#include <sys/stat.h>
+#include <unistd.h>
+
+extern "C" {
+#include "pubsub_capture_file.h"
+}
+
+#include <CppUTest/TestHarness.h>
+
+namespace {
+    const char *CAPTURE_FILE = "capture_file_test.cap";
+
+    void append(pubsub_capture_writer_t *writer, uint32_t seqNr, const std::vector<char> &payload) {
+        pubsub_capture_record_header_t hdr{};
+        hdr.type = 42;
+        hdr.seqNr = seqNr;
+        hdr.major = 1;
+        hdr.minor = 2;
+        hdr.timeSeconds = 100 + seqNr;
+        hdr.timeNanoseconds = 500;
+        CHECK_EQUAL(CELIX_SUCCESS, pubsub_captureWriter_append(writer, &hdr, payload.data(), (uint32_t)payload.size()));
+    }
+
+    std::vector<char> payloadFor(uint32_t seqNr, size_t size) {
+        return std::vector<char>(size, (char)('a' + seqNr % 26));
+    }
+
+    size_t fileSize() {
+        struct stat st{};
+        CHECK_EQUAL(0, stat(CAPTURE_FILE, &st));
+        return (size_t)st.st_size;
+    }
+}
+
+TEST_GROUP(PubSubCaptureFileTestSuite) {
+    void teardown() {
+        unlink(CAPTURE_FILE);
+    }
+
+    //reads all records and checks them against the records written with append(seqNr, payloadFor(seqNr, sizes[seqNr]))
+    void checkRecords(pubsub_capture_reader_t *reader, const std::vector<size_t> &sizes) {
+        const pubsub_capture_record_header_t *hdr = nullptr;
+        const void *buffer = nullptr;
+        for (uint32_t seqNr = 0; seqNr < sizes.size(); ++seqNr) {
+            CHECK(pubsub_captureReader_next(reader, &hdr, &buffer));
+            CHECK_EQUAL(42u, hdr->type);
+            CHECK_EQUAL(seqNr, hdr->seqNr);
+            CHECK_EQUAL(1, hdr->major);
+            CHECK_EQUAL(2, hdr->minor);
+            CHECK_EQUAL(100u + seqNr, hdr->timeSeconds);
+            CHECK_EQUAL(500u, hdr->timeNanoseconds);
+            CHECK_EQUAL(sizes[seqNr], hdr->bufferSize);
+            std::vector<char> expected = payloadFor(seqNr, sizes[seqNr]);
+            CHECK(memcmp(expected.data(), buffer, expected.size()) == 0);
+        }
+        CHECK_FALSE(pubsub_captureReader_next(reader, &hdr, &buffer));
+    }
+};
+
+TEST(PubSubCaptureFileTestSuite, writeAndRead) {
+    pubsub_capture_writer_t *writer = pubsub_captureWriter_create(CAPTURE_FILE, "json", "scope", "topic");
+    CHECK(writer != nullptr);
+    //unaligned sizes, records are padded to 8 bytes
+    std::vector<size_t> sizes{0, 1, 7, 8, 13, 1000};
+    for (uint32_t seqNr = 0; seqNr < sizes.size(); ++seqNr) {
+        append(writer, seqNr, payloadFor(seqNr, sizes[seqNr]));
+    }
+    size_t written = pubsub_captureWriter_size(writer);
+    CHECK_EQUAL(0u, written % 8);
+    pubsub_captureWriter_destroy(writer);
+
+    //the file is truncated to the written size
+    CHECK_EQUAL(written, fileSize());
+
+    pubsub_capture_reader_t *reader = pubsub_captureReader_open(CAPTURE_FILE);
+    CHECK(reader != nullptr);
+    const pubsub_capture_file_header_t *fileHdr = pubsub_captureReader_header(reader);
+    STRCMP_EQUAL("json", fileHdr->serializer);
+    STRCMP_EQUAL("scope", fileHdr->scope);
+    STRCMP_EQUAL("topic", fileHdr->topic);
+    checkRecords(reader, sizes);
+
+    pubsub_captureReader_rewind(reader);
+    checkRecords(reader, sizes);
+    pubsub_captureReader_close(reader);
+}
+
+TEST(PubSubCaptureFileTestSuite, mappingGrows) {
+    pubsub_capture_writer_t *writer = pubsub_captureWriter_create(CAPTURE_FILE, "avrobin", nullptr, "topic");
+    CHECK(writer != nullptr);
+    //more than the initial mapping of 4MB, including a single record larger than the doubled mapping
+    std::vector<size_t> sizes(100, 64 * 1024);
+    sizes.push_back(10 * 1024 * 1024);
+    for (uint32_t seqNr = 0; seqNr < sizes.size(); ++seqNr) {
+        append(writer, seqNr, payloadFor(seqNr, sizes[seqNr]));
+    }
+    size_t written = pubsub_captureWriter_size(writer);
+    pubsub_captureWriter_destroy(writer);
+    CHECK_EQUAL(written, fileSize());
+
+    pubsub_capture_reader_t *reader = pubsub_captureReader_open(CAPTURE_FILE);
+    CHECK(reader != nullptr);
+    STRCMP_EQUAL("", pubsub_captureReader_header(reader)->scope);
+    checkRecords(reader, sizes);
+    pubsub_captureReader_close(reader);
+}
+
+TEST(PubSubCaptureFileTestSuite, truncatedRecordIsIgnored) {
+    pubsub_capture_writer_t *writer = pubsub_captureWriter_create(CAPTURE_FILE, "json", nullptr, "topic");
+    append(writer, 0, payloadFor(0, 16));
+    append(writer, 1, payloadFor(1, 16));
+    size_t written = pubsub_captureWriter_size(writer);
+    pubsub_captureWriter_destroy(writer);
+    CHECK_EQUAL(0, truncate(CAPTURE_FILE, (off_t)(written - 9)));
+
+    pubsub_capture_reader_t *reader = pubsub_captureReader_open(CAPTURE_FILE);
+    CHECK(reader != nullptr);
+    checkRecords(reader, {16});
+    pubsub_captureReader_close(reader);
+}
+
+TEST(PubSubCaptureFileTestSuite, invalidFilesRejected) {
+    CHECK(pubsub_captureReader_open("missing.cap") == nullptr);
+
+    FILE *f = fopen(CAPTURE_FILE, "w");
+    CHECK(f != nullptr);
+    fputs("not a capture file", f);
+    fclose(f);
+    CHECK(pubsub_captureReader_open(CAPTURE_FILE) == nullptr);
+
+    std::vector<char> data(sizeof(pubsub_capture_file_header_t), 0);
+    memcpy(data.data(), "NOTACAPT", 8);
+    f = fopen(CAPTURE_FILE, "w");
+    fwrite(data.data(), 1, data.size(), f);
+    fclose(f);
+    CHECK(pubsub_captureReader_open(CAPTURE_FILE) == nullptr);
+}
@@ -0,0 +1,161 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <string>
+#include <cstdio>
+#include <cstring>
+#include <random>
+
+#include "celix_properties.h"
+#include "pubsub_constants.h"
+extern "C" {
+#include "pubsub_compression.h"
+}
+
+#include <CppUTest/TestHarness.h>
+
+namespace {
+    std::string createPayload(size_t size) {
+        std::string payload{};
+        while (payload.size() < size) {
+            payload += "{\"name\":\"sensor\",\"value\":" + std::to_string(payload.size() % 100) + "},";
+        }
+        payload.resize(size);
+        return payload;
+    }
+}
+
+TEST_GROUP(PubSubCompressionTestSuite) {
+    celix_properties_t *props = nullptr;
+
+    void setup() {
+        props = celix_properties_create();
+    }
+
+    void teardown() {
+        celix_properties_destroy(props);
+    }
+
+    /**
+     * Compresses the payload and checks that it decompresses to the original payload.
+     */
+    void checkRoundTrip(pubsub_compressor_t *compressor, pubsub_compressor_t *decompressor, const std::string &payload) {
+        void *compressed = nullptr;
+        size_t compressedSize = 0;
+        CHECK(pubsub_compressor_compress(compressor, payload.data(), payload.size(), &compressed, &compressedSize));
+        CHECK(compressedSize < payload.size());
+
+        void *decompressed = nullptr;
+        size_t decompressedSize = 0;
+        CHECK_EQUAL(CELIX_SUCCESS, pubsub_compressor_decompress(decompressor, compressed, compressedSize, &decompressed, &decompressedSize));
+        CHECK_EQUAL(payload.size(), decompressedSize);
+        CHECK(memcmp(payload.data(), decompressed, decompressedSize) == 0);
+        free(compressed);
+        free(decompressed);
+    }
+};
+
+TEST(PubSubCompressionTestSuite, notConfigured) {
+    CHECK(pubsub_compressor_create(props) == nullptr);
+    celix_properties_set(props, PUBSUB_COMPRESSION_KEY, PUBSUB_COMPRESSION_NONE);
+    CHECK(pubsub_compressor_create(props) == nullptr);
+}
+
+TEST(PubSubCompressionTestSuite, compressAndDecompress) {
+    celix_properties_set(props, PUBSUB_COMPRESSION_KEY, PUBSUB_COMPRESSION_DEFLATE);
+    pubsub_compressor_t *compressor = pubsub_compressor_create(props);
+    CHECK(compressor != nullptr);
+
+    //the streams are reused for the next msgs
+    checkRoundTrip(compressor, nullptr, createPayload(4096));
+    checkRoundTrip(compressor, nullptr, createPayload(100000));
+    checkRoundTrip(compressor, nullptr, createPayload(300));
+    pubsub_compressor_destroy(compressor);
+}
+
+TEST(PubSubCompressionTestSuite, smallAndIncompressiblePayloadsNotCompressed) {
+    celix_properties_set(props, PUBSUB_COMPRESSION_KEY, PUBSUB_COMPRESSION_DEFLATE);
+    celix_properties_set(props, PUBSUB_COMPRESSION_MIN_SIZE_KEY, "1024");
+    pubsub_compressor_t *compressor = pubsub_compressor_create(props);
+    CHECK(compressor != nullptr);
+
+    void *out = nullptr;
+    size_t outSize = 0;
+    std::string small = createPayload(1000);
+    CHECK(!pubsub_compressor_compress(compressor, small.data(), small.size(), &out, &outSize));
+    CHECK(out == nullptr);
+
+    std::mt19937 gen{42};
+    std::string random(4096, '\0');
+    for (char &c : random) {
+        c = (char)gen();
+    }
+    CHECK(!pubsub_compressor_compress(compressor, random.data(), random.size(), &out, &outSize));
+    CHECK(out == nullptr);
+    pubsub_compressor_destroy(compressor);
+}
+
+TEST(PubSubCompressionTestSuite, invalidLevel) {
+    celix_properties_set(props, PUBSUB_COMPRESSION_KEY, PUBSUB_COMPRESSION_DEFLATE);
+    celix_properties_set(props, PUBSUB_COMPRESSION_LEVEL_KEY, "42");
+    CHECK(pubsub_compressor_create(props) == nullptr);
+}
+
+TEST(PubSubCompressionTestSuite, invalidCompressedPayload) {
+    const char garbage[] = "\x10\x00\x00\x00 this is not deflate data";
+    void *out = nullptr;
+    size_t outSize = 0;
+    CHECK_EQUAL(CELIX_ILLEGAL_ARGUMENT, pubsub_compressor_decompress(nullptr, garbage, sizeof(garbage), &out, &outSize));
+    CHECK_EQUAL(CELIX_ILLEGAL_ARGUMENT, pubsub_compressor_decompress(nullptr, garbage, 2, &out, &outSize));
+}
+
+TEST(PubSubCompressionTestSuite, dictionary) {
+    const char *path = "compression_test.dict";
+    std::string dictionary = createPayload(2048);
+    FILE *file = fopen(path, "wb");
+    CHECK(file != nullptr);
+    fwrite(dictionary.data(), 1, dictionary.size(), file);
+    fclose(file);
+
+    celix_properties_set(props, PUBSUB_COMPRESSION_KEY, PUBSUB_COMPRESSION_DEFLATE);
+    celix_properties_set(props, PUBSUB_COMPRESSION_DICTIONARY_KEY, path);
+    pubsub_compressor_t *compressor = pubsub_compressor_create(props);
+    pubsub_compressor_t *decompressor = pubsub_decompressor_create(props);
+    CHECK(compressor != nullptr);
+    CHECK(decompressor != nullptr);
+    checkRoundTrip(compressor, decompressor, createPayload(1000));
+
+    //a payload compressed with a dictionary cannot be decompressed without it
+    std::string payload = createPayload(1000);
+    void *compressed = nullptr;
+    size_t compressedSize = 0;
+    CHECK(pubsub_compressor_compress(compressor, payload.data(), payload.size(), &compressed, &compressedSize));
+    void *out = nullptr;
+    size_t outSize = 0;
+    CHECK_EQUAL(CELIX_ILLEGAL_ARGUMENT, pubsub_compressor_decompress(nullptr, compressed, compressedSize, &out, &outSize));
+    free(compressed);
+
+    pubsub_compressor_destroy(compressor);
+    pubsub_compressor_destroy(decompressor);
+    remove(path);
+
+    //a missing dictionary cannot be used
+    CHECK(pubsub_compressor_create(props) == nullptr);
+    CHECK(pubsub_decompressor_create(props) == nullptr);
+}
@@ -0,0 +1,292 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *  KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <thread>
+#include <chrono>
+#include <mutex>
+#include <condition_variable>
+#include <vector>
+#include <cstring>
+
+#include "celix_properties.h"
+#include "pubsub_constants.h"
+extern "C" {
+#include "pubsub_dispatcher.h"
+}
+
+#include <CppUTest/TestHarness.h>
+
+namespace {
+    struct header {
+        int origin;
+        int seqNr;
+    };
+
+    struct subscriber {
+        std::mutex mutex{};
+        std::condition_variable cond{};
+        std::vector<header> received{};
+        std::vector<unsigned int> conflated{};
+        bool block{false};
+
+        static void dispatch(void *handle, const void *hdr, const void *payload, size_t payloadSize, const struct timespec */*receiveTime*/, unsigned int nrOfConflatedMsgs) {
+            auto *sub = static_cast<subscriber*>(handle);
+            std::unique_lock<std::mutex> lck{sub->mutex};
+            sub->cond.wait(lck, [sub]{ return !sub->block; });
+            header h{};
+            memcpy(&h, hdr, sizeof(h));
+            CHECK_EQUAL(sizeof(int), payloadSize);
+            CHECK_EQUAL(h.seqNr, *static_cast<const int*>(payload));
+            sub->received.push_back(h);
+            sub->conflated.push_back(nrOfConflatedMsgs);
+            sub->cond.notify_all();
+        }
+
+        bool waitFor(size_t count) {
+            std::unique_lock<std::mutex> lck{mutex};
+            return cond.wait_for(lck, std::chrono::seconds{5}, [&]{ return received.size() >= count; });
+        }
+
+        void setBlock(bool b) {
+            std::lock_guard<std::mutex> lck{mutex};
+            block = b;
+            cond.notify_all();
+        }
+    };
+
+    pubsub_dispatch_msg_t* createMsg(int origin, int seqNr) {
+        header h{origin, seqNr};
+        struct timespec now{};
+        clock_gettime(CLOCK_MONOTONIC, &now);
+        return pubsub_dispatchMsg_create(&h, sizeof(h), &seqNr, sizeof(seqNr), &now);
+    }
+
+    pubsub_dispatch_msg_t* createConflatingMsg(int origin, int seqNr) {
+        pubsub_dispatch_msg_t *msg = createMsg(origin, seqNr);
+        CHECK_EQUAL(CELIX_SUCCESS, pubsub_dispatchMsg_setConflationKey(msg, &origin, sizeof(origin)));
+        return msg;
+    }
+}
+
+TEST_GROUP(PubSubDispatcherTestSuite) {
+    celix_properties_t *props = nullptr;
+
+    void setup() {
+        props = celix_properties_create();
+    }
+
+    void teardown() {
+        celix_properties_destroy(props);
+    }
+
+    void testInOrderPerSubscriber() {
+        //large enough for all msgs, so that none are dropped
+        celix_properties_set(props, PUBSUB_DISPATCH_QUEUE_SIZE_KEY, "2048");
+        pubsub_dispatcher_t *dispatcher = pubsub_dispatcher_create(props, "dispatcher_test");
+        CHECK(dispatcher != nullptr);
+
+        constexpr int NR_OF_SUBSCRIBERS = 4;
+        constexpr int NR_OF_ORIGINS = 3;
+        constexpr int NR_OF_MSGS = 500;
+        subscriber subs[NR_OF_SUBSCRIBERS];
+        pubsub_dispatch_queue_t *queues[NR_OF_SUBSCRIBERS];
+        for (int i = 0; i < NR_OF_SUBSCRIBERS; ++i) {
+            queues[i] = pubsub_dispatcher_createQueue(dispatcher, &subs[i], subscriber::dispatch);
+        }
+
+        //one msg instance is shared by the queues of all subscribers
+        for (int seqNr = 0; seqNr < NR_OF_MSGS; ++seqNr) {
+            for (int origin = 0; origin < NR_OF_ORIGINS; ++origin) {
+                pubsub_dispatch_msg_t *msg = createMsg(origin, seqNr);
+                for (auto *queue : queues) {
+                    CHECK(pubsub_dispatchQueue_enqueue(queue, msg));
+                }
+                pubsub_dispatchMsg_release(msg);
+            }
+        }
+
+        for (auto &sub : subs) {
+            CHECK(sub.waitFor(NR_OF_MSGS * NR_OF_ORIGINS));
+            std::lock_guard<std::mutex> lck{sub.mutex};
+            CHECK_EQUAL((size_t)(NR_OF_MSGS * NR_OF_ORIGINS), sub.received.size());
+            int expected[NR_OF_ORIGINS] = {};
+            for (const header &h : sub.received) {
+                CHECK_EQUAL(expected[h.origin], h.seqNr);
+                expected[h.origin] = h.seqNr + 1;
+            }
+        }
+
+        for (auto *queue : queues) {
+            pubsub_dispatchQueue_destroy(queue);
+        }
+        pubsub_dispatcher_destroy(dispatcher);
+    }
+};
+
+TEST(PubSubDispatcherTestSuite, singleModeHasNoDispatcher) {
+    CHECK(pubsub_dispatcher_create(nullptr, "dispatcher_test") == nullptr);
+    CHECK(pubsub_dispatcher_create(props, "dispatcher_test") == nullptr);
+    celix_properties_set(props, PUBSUB_DISPATCH_MODE_KEY, PUBSUB_DISPATCH_MODE_SINGLE);
+    CHECK(pubsub_dispatcher_create(props, "dispatcher_test") == nullptr);
+    celix_properties_set(props, PUBSUB_DISPATCH_MODE_KEY, "unknown");
+    CHECK(pubsub_dispatcher_create(props, "dispatcher_test") == nullptr);
+}
+
+TEST(PubSubDispatcherTestSuite, subscriberModeInOrder) {
+    celix_properties_set(props, PUBSUB_DISPATCH_MODE_KEY, PUBSUB_DISPATCH_MODE_SUBSCRIBER);
+    testInOrderPerSubscriber();
+}
+
+TEST(PubSubDispatcherTestSuite, poolModeInOrder) {
+    celix_properties_set(props, PUBSUB_DISPATCH_MODE_KEY, PUBSUB_DISPATCH_MODE_POOL);
+    celix_properties_set(props, PUBSUB_DISPATCH_POOL_SIZE_KEY, "3");
+    testInOrderPerSubscriber();
+}
+
+TEST(PubSubDispatcherTestSuite, slowSubscriberDoesNotBlockOthers) {
+    celix_properties_set(props, PUBSUB_DISPATCH_MODE_KEY, PUBSUB_DISPATCH_MODE_SUBSCRIBER);
+    celix_properties_set(props, PUBSUB_DISPATCH_QUEUE_SIZE_KEY, "4");
+    pubsub_dispatcher_t *dispatcher = pubsub_dispatcher_create(props, "dispatcher_test");
+    CHECK(dispatcher != nullptr);
+
+    subscriber slow{};
+    subscriber fast{};
+    slow.setBlock(true);
+    pubsub_dispatch_queue_t *slowQueue = pubsub_dispatcher_createQueue(dispatcher, &slow, subscriber::dispatch);
+    pubsub_dispatch_queue_t *fastQueue = pubsub_dispatcher_createQueue(dispatcher, &fast, subscriber::dispatch);
+
+    //the slow queue fills up (1 msg in dispatch + 4 queued), the fast subscriber still gets all msgs
+    int enqueuedInSlow = 0;
+    for (int seqNr = 0; seqNr < 10; ++seqNr) {
+        pubsub_dispatch_msg_t *msg = createMsg(0, seqNr);
+        if (pubsub_dispatchQueue_enqueue(slowQueue, msg)) {
+            ++enqueuedInSlow;
+        }
+        CHECK(pubsub_dispatchQueue_enqueue(fastQueue, msg));
+        pubsub_dispatchMsg_release(msg);
+        CHECK(fast.waitFor((size_t)seqNr + 1));
+    }
+    CHECK(enqueuedInSlow >= 4);
+    CHECK(enqueuedInSlow <= 5);
+
+    //dropped msgs are not dispatched, queued msgs are after the subscriber continues
+    slow.setBlock(false);
+    CHECK(slow.waitFor((size_t)enqueuedInSlow));
+    std::this_thread::sleep_for(std::chrono::milliseconds{10});
+    {
+        std::lock_guard<std::mutex> lck{slow.mutex};
+        CHECK_EQUAL((size_t)enqueuedInSlow, slow.received.size());
+    }
+
+    pubsub_dispatchQueue_destroy(slowQueue);
+    pubsub_dispatchQueue_destroy(fastQueue);
+    pubsub_dispatcher_destroy(dispatcher);
+}
+
+TEST(PubSubDispatcherTestSuite, destroyQueueWithQueuedMsgs) {
+    celix_properties_set(props, PUBSUB_DISPATCH_MODE_KEY, PUBSUB_DISPATCH_MODE_POOL);
+    pubsub_dispatcher_t *dispatcher = pubsub_dispatcher_create(props, "dispatcher_test");
+    CHECK(dispatcher != nullptr);
+
+    subscriber sub{};
+    sub.setBlock(true);
+    pubsub_dispatch_queue_t *queue = pubsub_dispatcher_createQueue(dispatcher, &sub, subscriber::dispatch);
+    for (int seqNr = 0; seqNr < 10; ++seqNr) {
+        pubsub_dispatch_msg_t *msg = createMsg(0, seqNr);
+        CHECK(pubsub_dispatchQueue_enqueue(queue, msg));
+        pubsub_dispatchMsg_release(msg);
+    }
+
+    //destroy waits for the msg being dispatched and drops the queued msgs
+    std::thread unblock{[&sub]{
+        std::this_thread::sleep_for(std::chrono::milliseconds{20});
+        sub.setBlock(false);
+    }};
+    pubsub_dispatchQueue_destroy(queue);
+    unblock.join();
+    {
+        std::lock_guard<std::mutex> lck{sub.mutex};
+        CHECK(sub.received.size() <= 1);
+    }
+    pubsub_dispatcher_destroy(dispatcher);
+}
+
+TEST(PubSubDispatcherTestSuite, conflateQueuedMsgs) {
+    //conflation implies the subscriber dispatch mode
+    celix_properties_setBool(props, PUBSUB_DISPATCH_CONFLATE_KEY, true);
+    pubsub_dispatcher_t *dispatcher = pubsub_dispatcher_create(props, "dispatcher_test");
+    CHECK(dispatcher != nullptr);
+
+    subscriber sub{};
+    sub.setBlock(true);
+    pubsub_dispatch_queue_t *queue = pubsub_dispatcher_createQueue(dispatcher, &sub, subscriber::dispatch);
+
+    //the first msg is never conflated, it blocks the dispatch thread (or is still queued)
+    std::vector<pubsub_dispatch_msg_t*> msgs{createMsg(9, 0)};
+    for (auto origin_seqNr : {std::make_pair(0, 1), {0, 2}, {1, 3}, {0, 4}, {1, 5}}) {
+        msgs.push_back(createConflatingMsg(origin_seqNr.first, origin_seqNr.second));
+    }
+    msgs.push_back(createMsg(0, 6)); //msgs without conflation key are not conflated
+    for (auto *msg : msgs) {
+        CHECK(pubsub_dispatchQueue_enqueue(queue, msg));
+        pubsub_dispatchMsg_release(msg);
+    }
+
+    //the latest msg of every key is dispatched at the queue position of the first queued msg of the key
+    sub.setBlock(false);
+    CHECK(sub.waitFor(4));
+    std::this_thread::sleep_for(std::chrono::milliseconds{10});
+    {
+        std::lock_guard<std::mutex> lck{sub.mutex};
+        CHECK_EQUAL(4, (int)sub.received.size());
+        const int expectedSeqNrs[] = {0, 4, 5, 6};
+        const unsigned int expectedConflated[] = {0, 2, 1, 0};
+        for (int i = 0; i < 4; ++i) {
+            CHECK_EQUAL(expectedSeqNrs[i], sub.received[i].seqNr);
+            CHECK_EQUAL(expectedConflated[i], sub.conflated[i]);
+        }
+    }
+    pubsub_dispatchQueue_destroy(queue);
+    pubsub_dispatcher_destroy(dispatcher);
+}
+
+TEST(PubSubDispatcherTestSuite, conflationKeyIgnoredWithoutConflation) {
+    celix_properties_set(props, PUBSUB_DISPATCH_MODE_KEY, PUBSUB_DISPATCH_MODE_SUBSCRIBER);
+    pubsub_dispatcher_t *dispatcher = pubsub_dispatcher_create(props, "dispatcher_test");
+    subscriber sub{};
+    sub.setBlock(true);
+    pubsub_dispatch_queue_t *queue = pubsub_dispatcher_createQueue(dispatcher, &sub, subscriber::dispatch);
+    for (int seqNr = 0; seqNr < 3; ++seqNr) {
+        pubsub_dispatch_msg_t *msg = createConflatingMsg(0, seqNr);
+        CHECK(pubsub_dispatchQueue_enqueue(queue, msg));
+        pubsub_dispatchMsg_release(msg);
+    }
+    sub.setBlock(false);
+    CHECK(sub.waitFor(3));
+
+    //the conflation key is limited in size
+    pubsub_dispatch_msg_t *msg = createMsg(0, 0);
+    char key[PUBSUB_DISPATCH_MAX_CONFLATION_KEY_SIZE + 1]{};
+    CHECK_EQUAL(CELIX_ILLEGAL_ARGUMENT, pubsub_dispatchMsg_setConflationKey(msg, key, sizeof(key)));
+    CHECK_EQUAL(CELIX_SUCCESS, pubsub_dispatchMsg_setConflationKey(msg, key, sizeof(key) - 1));
+    pubsub_dispatchMsg_release(msg);
+
+    pubsub_dispatchQueue_destroy(queue);
+    pubsub_dispatcher_destroy(dispatcher);
+}
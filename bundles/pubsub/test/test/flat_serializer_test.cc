@@ -0,0 +1,175 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *  KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <string>
+#include <fstream>
+#include <cstdlib>
+#include <cstring>
+#include <byteswap.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+#include "celix_api.h"
+#include "celix_framework_factory.h"
+extern "C" {
+#include "pubsub_flat_serializer_impl.h"
+}
+
+#include <CppUTest/TestHarness.h>
+
+namespace {
+    struct pod_msg {
+        double value;
+        uint32_t seqNr;
+    };
+
+    void writeFile(const std::string &path, const char *content) {
+        std::ofstream file{path};
+        file << content;
+    }
+}
+
+TEST_GROUP(PubSubFlatSerializerTestSuite) {
+    char dir[64]{};
+    celix_framework_t *fw = nullptr;
+    pubsub_flat_serializer_t *serializer = nullptr;
+    hash_map_pt map = nullptr;
+    pubsub_msg_serializer_t *podSer = nullptr;
+
+    void setup() {
+        //the descriptors of the framework bundle are read from the extender path
+        snprintf(dir, sizeof(dir), "%s", "/tmp/flat_serializer_test_XXXXXX");
+        CHECK(mkdtemp(dir) != nullptr);
+        writeFile(std::string{dir} + "/pod.descriptor",
+                  ":header\ntype=message\nname=pod\nversion=1.0.0\n:annotations\nmsgId=42\n:types\n:message\n{Di value seqNr}\n");
+        writeFile(std::string{dir} + "/text.descriptor",
+                  ":header\ntype=message\nname=text\nversion=1.0.0\n:annotations\nmsgId=43\n:types\n:message\n{t text}\n");
+
+        celix_properties_t *properties = celix_properties_create();
+        celix_properties_set(properties, "LOGHELPER_ENABLE_STDOUT_FALLBACK", "true");
+        celix_properties_set(properties, "org.osgi.framework.storage.clean", "onFirstInit");
+        celix_properties_set(properties, "org.osgi.framework.storage", ".cacheFlatSerializerTestFramework");
+        celix_properties_set(properties, "CELIX_FRAMEWORK_EXTENDER_PATH", dir);
+        fw = celix_frameworkFactory_createFramework(properties);
+        celix_bundle_context_t *ctx = celix_framework_getFrameworkContext(fw);
+
+        CHECK_EQUAL(CELIX_SUCCESS, pubsubFlatSerializer_create(ctx, &serializer));
+        CHECK_EQUAL(CELIX_SUCCESS, pubsubFlatSerializer_createSerializerMap(serializer, celix_framework_getFrameworkBundle(fw), &map));
+        podSer = static_cast<pubsub_msg_serializer_t*>(hashMap_get(map, (void*)(uintptr_t)42));
+        CHECK(podSer != nullptr);
+    }
+
+    void teardown() {
+        pubsubFlatSerializer_destroySerializerMap(serializer, map);
+        pubsubFlatSerializer_destroy(serializer);
+        celix_frameworkFactory_destroyFramework(fw);
+        remove((std::string{dir} + "/pod.descriptor").c_str());
+        remove((std::string{dir} + "/text.descriptor").c_str());
+        rmdir(dir);
+    }
+
+    pubsub_flat_msg_header_t* serialize(const pod_msg &msg, size_t *len) {
+        void *out = nullptr;
+        CHECK_EQUAL(CELIX_SUCCESS, podSer->serialize(podSer->handle, &msg, &out, len));
+        return static_cast<pubsub_flat_msg_header_t*>(out);
+    }
+};
+
+TEST(PubSubFlatSerializerTestSuite, onlyPlainOldDataMsgs) {
+    CHECK_EQUAL(1, hashMap_size(map));
+    CHECK(hashMap_get(map, (void*)(uintptr_t)43) == nullptr);
+    STRCMP_EQUAL("pod", podSer->msgName);
+    CHECK_EQUAL(sizeof(pod_msg), podSer->podSize);
+}
+
+TEST(PubSubFlatSerializerTestSuite, roundTrip) {
+    pod_msg msg{1.5, 7};
+    size_t len = 0;
+    pubsub_flat_msg_header_t *header = serialize(msg, &len);
+    CHECK_EQUAL(sizeof(pubsub_flat_msg_header_t) + sizeof(pod_msg), len);
+    CHECK_EQUAL(PUBSUB_FLAT_MAGIC, header->magic);
+    CHECK_EQUAL((uint32_t)sizeof(pod_msg), header->size);
+
+    void *out = nullptr;
+    CHECK_EQUAL(CELIX_SUCCESS, podSer->deserialize(podSer->handle, header, len, &out));
+    //the msg is a copy, so it stays valid after the input buffer is reused
+    CHECK(out != static_cast<void*>(header + 1));
+    auto *received = static_cast<pod_msg*>(out);
+    DOUBLES_EQUAL(1.5, received->value, 0.0);
+    CHECK_EQUAL(7u, received->seqNr);
+    podSer->freeMsg(podSer->handle, out);
+    free(header);
+}
+
+TEST(PubSubFlatSerializerTestSuite, serializeVecMatchesSerialize) {
+    pod_msg msg{2.5, 8};
+    size_t len = 0;
+    pubsub_flat_msg_header_t *header = serialize(msg, &len);
+
+    struct iovec vec[1];
+    size_t n = 1;
+    void *owned = nullptr;
+    CHECK_EQUAL(CELIX_ILLEGAL_ARGUMENT, podSer->serializeVec(podSer->handle, &msg, vec, &n, &owned));
+    CHECK_EQUAL(2u, n);
+
+    struct iovec vecs[2];
+    n = 2;
+    CHECK_EQUAL(CELIX_SUCCESS, podSer->serializeVec(podSer->handle, &msg, vecs, &n, &owned));
+    CHECK_EQUAL(2u, n);
+    CHECK(owned == nullptr);
+    CHECK(vecs[1].iov_base == &msg);
+    CHECK_EQUAL(len, vecs[0].iov_len + vecs[1].iov_len);
+    CHECK_EQUAL(0, memcmp(header, vecs[0].iov_base, vecs[0].iov_len));
+    CHECK_EQUAL(0, memcmp(header + 1, vecs[1].iov_base, vecs[1].iov_len));
+    free(header);
+}
+
+TEST(PubSubFlatSerializerTestSuite, rejectsMismatchingMsgs) {
+    pod_msg msg{3.5, 9};
+    size_t len = 0;
+    pubsub_flat_msg_header_t *header = serialize(msg, &len);
+    void *out = nullptr;
+
+    //different size
+    CHECK_EQUAL(CELIX_ILLEGAL_ARGUMENT, podSer->deserialize(podSer->handle, header, len - 1, &out));
+
+    //different byte order
+    header->magic = bswap_32(PUBSUB_FLAT_MAGIC);
+    CHECK_EQUAL(CELIX_ILLEGAL_ARGUMENT, podSer->deserialize(podSer->handle, header, len, &out));
+
+    //invalid magic
+    header->magic = 0;
+    CHECK_EQUAL(CELIX_ILLEGAL_ARGUMENT, podSer->deserialize(podSer->handle, header, len, &out));
+
+    //different layout
+    header->magic = PUBSUB_FLAT_MAGIC;
+    header->schemaHash += 1;
+    CHECK_EQUAL(CELIX_ILLEGAL_ARGUMENT, podSer->deserialize(podSer->handle, header, len, &out));
+    CHECK(out == nullptr);
+    free(header);
+}
+
+TEST(PubSubFlatSerializerTestSuite, copyMsg) {
+    pod_msg msg{4.5, 10};
+    void *copy = nullptr;
+    CHECK_EQUAL(CELIX_SUCCESS, podSer->copyMsg(podSer->handle, &msg, &copy));
+    CHECK(copy != &msg);
+    CHECK_EQUAL(0, memcmp(&msg, copy, sizeof(msg)));
+    podSer->freeMsg(podSer->handle, copy);
+}
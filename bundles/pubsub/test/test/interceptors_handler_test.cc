@@ -0,0 +1,180 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *  KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <string>
+#include <vector>
+
+#include "celix_api.h"
+#include "celix_framework_factory.h"
+extern "C" {
+#include "pubsub_interceptors_handler.h"
+}
+
+#include <CppUTest/TestHarness.h>
+
+namespace {
+    /**
+     * Interceptor which records its hook calls in a call log shared with the other interceptors.
+     */
+    struct recording_interceptor {
+        std::string name;
+        std::vector<std::string> *calls;
+        bool pass{true};
+        pubsub_interceptor_t svc{};
+
+        recording_interceptor(std::string n, std::vector<std::string> *log) : name{std::move(n)}, calls{log} {
+            svc.handle = this;
+            svc.preSend = preSend;
+            svc.postSend = postSend;
+            svc.preReceive = preReceive;
+            svc.postReceive = postReceive;
+        }
+
+        static bool preSend(void *handle, const pubsub_interceptor_properties_t *properties, const pubsub_interceptor_msg_header_t *header, const void */*payload*/, size_t payloadSize) {
+            auto *ic = static_cast<recording_interceptor*>(handle);
+            STRCMP_EQUAL("test", properties->psaType);
+            STRCMP_EQUAL("scope", properties->scope);
+            STRCMP_EQUAL("topic", properties->topic);
+            CHECK_EQUAL(7u, header->msgTypeId);
+            CHECK_EQUAL(3u, payloadSize);
+            ic->calls->push_back(ic->name + ".preSend");
+            return ic->pass;
+        }
+
+        static void postSend(void *handle, const pubsub_interceptor_properties_t */*properties*/, const pubsub_interceptor_msg_header_t */*header*/, size_t /*payloadSize*/, celix_status_t /*status*/) {
+            auto *ic = static_cast<recording_interceptor*>(handle);
+            ic->calls->push_back(ic->name + ".postSend");
+        }
+
+        static bool preReceive(void *handle, const pubsub_interceptor_properties_t */*properties*/, const pubsub_interceptor_msg_header_t */*header*/, const void */*payload*/, size_t /*payloadSize*/) {
+            auto *ic = static_cast<recording_interceptor*>(handle);
+            ic->calls->push_back(ic->name + ".preReceive");
+            return ic->pass;
+        }
+
+        static void postReceive(void *handle, const pubsub_interceptor_properties_t */*properties*/, const pubsub_interceptor_msg_header_t */*header*/, const void */*payload*/, size_t /*payloadSize*/) {
+            auto *ic = static_cast<recording_interceptor*>(handle);
+            ic->calls->push_back(ic->name + ".postReceive");
+        }
+    };
+}
+
+TEST_GROUP(PubSubInterceptorsHandlerTestSuite) {
+    celix_framework_t *fw = nullptr;
+    celix_bundle_context_t *ctx = nullptr;
+    pubsub_interceptors_handler_t *handler = nullptr;
+    std::vector<std::string> calls{};
+    pubsub_interceptor_msg_header_t header{7, "msg", 1, 0};
+    const char payload[3] = {1, 2, 3};
+
+    void setup() {
+        celix_properties_t *properties = celix_properties_create();
+        celix_properties_set(properties, "LOGHELPER_ENABLE_STDOUT_FALLBACK", "true");
+        celix_properties_set(properties, "org.osgi.framework.storage.clean", "onFirstInit");
+        celix_properties_set(properties, "org.osgi.framework.storage", ".cacheInterceptorsHandlerTestFramework");
+        fw = celix_frameworkFactory_createFramework(properties);
+        ctx = celix_framework_getFrameworkContext(fw);
+        handler = pubsub_interceptorsHandler_create(ctx, "test", "scope", "topic");
+    }
+
+    void teardown() {
+        pubsub_interceptorsHandler_destroy(handler);
+        celix_frameworkFactory_destroyFramework(fw);
+    }
+
+    long registerInterceptor(recording_interceptor &ic, long ranking) {
+        celix_properties_t *props = celix_properties_create();
+        celix_properties_setLong(props, OSGI_FRAMEWORK_SERVICE_RANKING, ranking);
+        celix_service_registration_options_t opts{};
+        opts.svc = &ic.svc;
+        opts.serviceName = PUBSUB_INTERCEPTOR_SERVICE_NAME;
+        opts.serviceVersion = PUBSUB_INTERCEPTOR_SERVICE_VERSION;
+        opts.properties = props;
+        return celix_bundleContext_registerServiceWithOptions(ctx, &opts);
+    }
+
+    void sendAndReceive(bool expectedSend, bool expectedReceive) {
+        bool send = pubsub_interceptorsHandler_preSend(handler, &header, payload, sizeof(payload));
+        CHECK_EQUAL(expectedSend, send);
+        if (send) {
+            pubsub_interceptorsHandler_postSend(handler, &header, sizeof(payload), CELIX_SUCCESS);
+        }
+        bool receive = pubsub_interceptorsHandler_preReceive(handler, &header, payload, sizeof(payload));
+        CHECK_EQUAL(expectedReceive, receive);
+        if (receive) {
+            pubsub_interceptorsHandler_postReceive(handler, &header, payload, sizeof(payload));
+        }
+    }
+};
+
+TEST(PubSubInterceptorsHandlerTestSuite, noInterceptors) {
+    CHECK(!pubsub_interceptorsHandler_isActive(nullptr));
+    CHECK(pubsub_interceptorsHandler_preSend(nullptr, &header, payload, sizeof(payload)));
+    CHECK(pubsub_interceptorsHandler_preReceive(nullptr, &header, payload, sizeof(payload)));
+    pubsub_interceptorsHandler_destroy(nullptr);
+
+    CHECK(!pubsub_interceptorsHandler_isActive(handler));
+    sendAndReceive(true, true);
+}
+
+TEST(PubSubInterceptorsHandlerTestSuite, calledInRankingOrder) {
+    recording_interceptor low{"low", &calls};
+    recording_interceptor high{"high", &calls};
+    long lowSvcId = registerInterceptor(low, 1);
+    long highSvcId = registerInterceptor(high, 10);
+    CHECK(pubsub_interceptorsHandler_isActive(handler));
+
+    //pre hooks highest ranking first, post hooks in reverse order
+    sendAndReceive(true, true);
+    const std::vector<std::string> expected{
+        "high.preSend", "low.preSend", "low.postSend", "high.postSend",
+        "high.preReceive", "low.preReceive", "low.postReceive", "high.postReceive"};
+    CHECK(expected == calls);
+
+    celix_bundleContext_unregisterService(ctx, highSvcId);
+    calls.clear();
+    sendAndReceive(true, true);
+    CHECK_EQUAL(4, (int)calls.size());
+    STRCMP_EQUAL("low.preSend", calls[0].c_str());
+
+    celix_bundleContext_unregisterService(ctx, lowSvcId);
+    CHECK(!pubsub_interceptorsHandler_isActive(handler));
+}
+
+TEST(PubSubInterceptorsHandlerTestSuite, droppedMsgSkipsRemainingInterceptors) {
+    recording_interceptor low{"low", &calls};
+    recording_interceptor high{"high", &calls};
+    long lowSvcId = registerInterceptor(low, 1);
+    long highSvcId = registerInterceptor(high, 10);
+
+    high.pass = false;
+    sendAndReceive(false, false);
+    const std::vector<std::string> expected{"high.preSend", "high.preReceive"};
+    CHECK(expected == calls);
+
+    high.pass = true;
+    low.pass = false;
+    calls.clear();
+    sendAndReceive(false, false);
+    const std::vector<std::string> expectedLow{"high.preSend", "low.preSend", "high.preReceive", "low.preReceive"};
+    CHECK(expectedLow == calls);
+
+    celix_bundleContext_unregisterService(ctx, lowSvcId);
+    celix_bundleContext_unregisterService(ctx, highSvcId);
+}
@@ -0,0 +1,302 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <thread>
+#include <chrono>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <vector>
+#include <cstring>
+#include <poll.h>
+#include <unistd.h>
+#include <arpa/inet.h>
+
+extern "C" {
+#include "large_udp.h"
+}
+
+#include <CppUTest/TestHarness.h>
+
+namespace {
+    /**
+     * The header in front of every part of a large udp msg, see large_udp.c.
+     */
+    struct part_header {
+        unsigned int msg_ident;
+        unsigned int total_msg_size;
+        unsigned int part_msg_size;
+        unsigned int offset;
+    };
+
+    constexpr unsigned int MAX_PART_SIZE = 65535 - (20 + 8 + sizeof(part_header));
+
+    std::vector<char> createMsg(unsigned int size, char seed) {
+        std::vector<char> msg(size);
+        for (unsigned int i = 0; i < size; ++i) {
+            msg[i] = (char)(seed + i * 7);
+        }
+        return msg;
+    }
+}
+
+TEST_GROUP(LargeUdpTestSuite) {
+    largeUdp_t *sendHandle = nullptr;
+    largeUdp_t *recvHandle = nullptr;
+    int sendFd = -1;
+    int recvFd = -1;
+    struct sockaddr_in dest{};
+
+    std::thread thread{};
+    std::atomic<bool> running{false};
+    std::mutex mutex{};
+    std::condition_variable cond{};
+    std::vector<std::vector<char>> received{};
+
+    void setup() {
+        sendHandle = largeUdp_create(1);
+        recvHandle = largeUdp_create(8);
+        sendFd = socket(AF_INET, SOCK_DGRAM, 0);
+        recvFd = socket(AF_INET, SOCK_DGRAM, 0);
+        int rcvBuf = 4 * 1024 * 1024;
+        setsockopt(recvFd, SOL_SOCKET, SO_RCVBUF, &rcvBuf, sizeof(rcvBuf));
+        dest.sin_family = AF_INET;
+        dest.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        dest.sin_port = 0;
+        CHECK_EQUAL(0, bind(recvFd, (struct sockaddr*)&dest, sizeof(dest)));
+        socklen_t len = sizeof(dest);
+        CHECK_EQUAL(0, getsockname(recvFd, (struct sockaddr*)&dest, &len));
+    }
+
+    void teardown() {
+        stopReceiving();
+        close(sendFd);
+        close(recvFd);
+        largeUdp_destroy(sendHandle);
+        largeUdp_destroy(recvHandle);
+    }
+
+    void startReceiving() {
+        running = true;
+        thread = std::thread{[this]{
+            while (running) {
+                struct pollfd pfd{recvFd, POLLIN, 0};
+                if (poll(&pfd, 1, 10) <= 0) {
+                    continue;
+                }
+                unsigned int index = 0;
+                unsigned int size = 0;
+                if (largeUdp_dataAvailable(recvHandle, recvFd, &index, &size)) {
+                    void *buffer = nullptr;
+                    CHECK_EQUAL(0, largeUdp_read(recvHandle, index, &buffer, size));
+                    std::lock_guard<std::mutex> lck{mutex};
+                    received.emplace_back((char*)buffer, (char*)buffer + size);
+                    free(buffer);
+                    cond.notify_all();
+                }
+            }
+        }};
+    }
+
+    void stopReceiving() {
+        running = false;
+        if (thread.joinable()) {
+            thread.join();
+        }
+    }
+
+    bool waitForMsgs(size_t count, std::chrono::milliseconds timeout = std::chrono::seconds{5}) {
+        std::unique_lock<std::mutex> lck{mutex};
+        return cond.wait_for(lck, timeout, [&]{ return received.size() >= count; });
+    }
+
+    /**
+     * Receives with the batched largeUdp_receive until count msgs are completed, returns the nr of receive calls.
+     */
+    int receiveBatched(size_t count, std::vector<struct timespec> *receiveTimes = nullptr) {
+        int nrOfCalls = 0;
+        auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds{5};
+        while (received.size() < count && std::chrono::steady_clock::now() < deadline) {
+            struct pollfd pfd{recvFd, POLLIN, 0};
+            if (poll(&pfd, 1, 10) <= 0) {
+                continue;
+            }
+            CHECK(largeUdp_receive(recvHandle, recvFd) >= 0);
+            ++nrOfCalls;
+            void *buffer = nullptr;
+            unsigned int size = 0;
+            struct timespec receiveTime{};
+            while (largeUdp_readNext(recvHandle, &buffer, &size, &receiveTime)) {
+                received.emplace_back((char*)buffer, (char*)buffer + size);
+                if (receiveTimes != nullptr) {
+                    receiveTimes->push_back(receiveTime);
+                }
+                free(buffer);
+            }
+        }
+        return nrOfCalls;
+    }
+
+    /**
+     * Sends a single part of a large msg as its own datagram.
+     */
+    void sendPart(unsigned int msgId, const std::vector<char> &msg, unsigned int offset, unsigned int partSize) {
+        part_header header{msgId, (unsigned int)msg.size(), partSize, offset};
+        struct iovec vec[2];
+        vec[0].iov_base = &header;
+        vec[0].iov_len = sizeof(header);
+        vec[1].iov_base = (void*)(msg.data() + offset);
+        vec[1].iov_len = partSize;
+        struct msghdr hdr{};
+        hdr.msg_name = &dest;
+        hdr.msg_namelen = sizeof(dest);
+        hdr.msg_iov = vec;
+        hdr.msg_iovlen = 2;
+        CHECK(sendmsg(sendFd, &hdr, 0) >= 0);
+    }
+};
+
+TEST(LargeUdpTestSuite, pacedLargeMsg) {
+    startReceiving();
+
+    //1MB in ~17 parts, paced so that the receiver socket buffer does not overflow
+    largeUdp_setSendRate(sendHandle, 50 * 1024 * 1024);
+    std::vector<char> msg = createMsg(1024 * 1024, 1);
+    auto start = std::chrono::steady_clock::now();
+    CHECK(largeUdp_sendto(sendHandle, sendFd, msg.data(), msg.size(), 0, &dest, sizeof(dest)) > 0);
+    auto elapsed = std::chrono::steady_clock::now() - start;
+    CHECK(elapsed >= std::chrono::milliseconds{10});
+
+    CHECK(waitForMsgs(1));
+    std::lock_guard<std::mutex> lck{mutex};
+    CHECK(msg == received[0]);
+}
+
+TEST(LargeUdpTestSuite, interleavedAndDuplicatedParts) {
+    startReceiving();
+
+    //2 msgs of 2 parts from the same origin, reassembled by msg id, a duplicate part is ignored
+    std::vector<char> msg1 = createMsg(MAX_PART_SIZE + 100, 1);
+    std::vector<char> msg2 = createMsg(MAX_PART_SIZE + 200, 2);
+    sendPart(1, msg1, 0, MAX_PART_SIZE);
+    sendPart(2, msg2, 0, MAX_PART_SIZE);
+    sendPart(1, msg1, 0, MAX_PART_SIZE);
+    sendPart(2, msg2, MAX_PART_SIZE, 200);
+    sendPart(1, msg1, MAX_PART_SIZE, 100);
+
+    CHECK(waitForMsgs(2));
+    std::this_thread::sleep_for(std::chrono::milliseconds{50});
+    std::lock_guard<std::mutex> lck{mutex};
+    CHECK_EQUAL(2, received.size());
+    CHECK(msg2 == received[0]);
+    CHECK(msg1 == received[1]);
+}
+
+TEST(LargeUdpTestSuite, invalidPartsDiscarded) {
+    startReceiving();
+
+    std::vector<char> msg = createMsg(MAX_PART_SIZE + 100, 3);
+    sendPart(1, msg, 10, 100); //offset not at a part boundary
+    part_header tooLarge{1, 100, 200, 0}; //part larger than the msg
+    CHECK(sendto(sendFd, &tooLarge, sizeof(tooLarge), 0, (struct sockaddr*)&dest, sizeof(dest)) >= 0);
+    CHECK(sendto(sendFd, "x", 1, 0, (struct sockaddr*)&dest, sizeof(dest)) >= 0); //shorter than a header
+    sendPart(1, msg, 0, MAX_PART_SIZE);
+    sendPart(1, msg, MAX_PART_SIZE, 100);
+
+    CHECK(waitForMsgs(1));
+    std::this_thread::sleep_for(std::chrono::milliseconds{50});
+    std::lock_guard<std::mutex> lck{mutex};
+    CHECK_EQUAL(1, received.size());
+    CHECK(msg == received[0]);
+}
+
+TEST(LargeUdpTestSuite, incompleteMsgRemovedAfterTimeout) {
+    largeUdp_setReassemblyTimeout(recvHandle, 50);
+    startReceiving();
+
+    //the first part of msg 1 expires before its second part arrives, so msg 1 is never completed
+    std::vector<char> msg1 = createMsg(MAX_PART_SIZE + 100, 4);
+    std::vector<char> msg2 = createMsg(MAX_PART_SIZE + 100, 5);
+    sendPart(1, msg1, 0, MAX_PART_SIZE);
+    std::this_thread::sleep_for(std::chrono::milliseconds{150});
+    sendPart(2, msg2, 0, MAX_PART_SIZE);
+    sendPart(1, msg1, MAX_PART_SIZE, 100);
+    sendPart(2, msg2, MAX_PART_SIZE, 100);
+
+    CHECK(waitForMsgs(1));
+    std::this_thread::sleep_for(std::chrono::milliseconds{50});
+    std::lock_guard<std::mutex> lck{mutex};
+    CHECK_EQUAL(1, received.size());
+    CHECK(msg2 == received[0]);
+}
+
+TEST(LargeUdpTestSuite, batchedReceive) {
+    largeUdp_setReceiveBatchSize(recvHandle, 4);
+
+    //all msgs are queued in the socket before receiving, so they are read 4 per call
+    std::vector<std::vector<char>> msgs{};
+    for (int i = 0; i < 10; ++i) {
+        msgs.push_back(createMsg(100 + i, (char)i));
+        CHECK(largeUdp_sendto(sendHandle, sendFd, msgs.back().data(), msgs.back().size(), 0, &dest, sizeof(dest)) > 0);
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds{20});
+
+    CHECK_EQUAL(3, receiveBatched(msgs.size()));
+    CHECK_EQUAL(msgs.size(), received.size());
+    for (size_t i = 0; i < msgs.size(); ++i) {
+        CHECK(msgs[i] == received[i]);
+    }
+}
+
+TEST(LargeUdpTestSuite, batchedReceiveOfLargeMsgAndInvalidParts) {
+    std::vector<char> msg = createMsg(MAX_PART_SIZE + 100, 6);
+    sendPart(1, msg, 10, 100); //offset not at a part boundary
+    CHECK(sendto(sendFd, "x", 1, 0, (struct sockaddr*)&dest, sizeof(dest)) >= 0); //shorter than a header
+    sendPart(1, msg, 0, MAX_PART_SIZE);
+    sendPart(1, msg, 0, MAX_PART_SIZE); //duplicate
+    sendPart(1, msg, MAX_PART_SIZE, 100);
+
+    receiveBatched(1);
+    std::this_thread::sleep_for(std::chrono::milliseconds{50});
+    receiveBatched(2); //nothing more is completed
+    CHECK_EQUAL(1, received.size());
+    CHECK(msg == received[0]);
+}
+
+TEST(LargeUdpTestSuite, kernelReceiveTimestamps) {
+    CHECK_EQUAL(0, largeUdp_enableKernelTimestamps(recvFd));
+    //note the kernel enables the rx timestamping asynchronously
+    std::this_thread::sleep_for(std::chrono::milliseconds{50});
+    struct timespec before{};
+    clock_gettime(CLOCK_REALTIME, &before);
+    std::vector<char> msg = createMsg(100, 7);
+    CHECK(largeUdp_sendto(sendHandle, sendFd, msg.data(), msg.size(), 0, &dest, sizeof(dest)) > 0);
+
+    //the receive time is the (realtime) kernel timestamp, so before the msg is read
+    std::this_thread::sleep_for(std::chrono::milliseconds{100});
+    std::vector<struct timespec> receiveTimes{};
+    receiveBatched(1, &receiveTimes);
+    struct timespec after{};
+    clock_gettime(CLOCK_REALTIME, &after);
+    CHECK_EQUAL(1, receiveTimes.size());
+    long fromBeforeMs = (receiveTimes[0].tv_sec - before.tv_sec) * 1000L + (receiveTimes[0].tv_nsec - before.tv_nsec) / 1000000L;
+    long toAfterMs = (after.tv_sec - receiveTimes[0].tv_sec) * 1000L + (after.tv_nsec - receiveTimes[0].tv_nsec) / 1000000L;
+    CHECK(fromBeforeMs >= 0);
+    CHECK(toAfterMs >= 90);
+}
@@ -0,0 +1,140 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <cstring>
+#include <thread>
+#include <atomic>
+
+extern "C" {
+#include "pubsub_admin_metrics.h"
+}
+
+#include <CppUTest/TestHarness.h>
+
+TEST_GROUP(PubSubMetricsTestSuite) {
+    pubsub_metrics_histogram_t histogram{};
+
+    void setup() {
+        memset(&histogram, 0, sizeof(histogram));
+    }
+};
+
+TEST(PubSubMetricsTestSuite, emptyHistogram) {
+    CHECK_EQUAL(0, pubsub_metricsHistogram_valueAtPercentile(&histogram, 50.0));
+    CHECK_EQUAL(0, pubsub_metricsHistogram_valueAtPercentile(&histogram, 100.0));
+}
+
+TEST(PubSubMetricsTestSuite, recordKeepsCountSumMinMax) {
+    pubsub_metricsHistogram_record(&histogram, 100);
+    pubsub_metricsHistogram_record(&histogram, 3);
+    pubsub_metricsHistogram_record(&histogram, 5000);
+    CHECK_EQUAL(3, histogram.count);
+    CHECK_EQUAL(5103, histogram.sumInNs);
+    CHECK_EQUAL(3, histogram.minInNs);
+    CHECK_EQUAL(5000, histogram.maxInNs);
+
+    uint64_t total = 0;
+    for (unsigned int i = 0; i < PUBSUB_METRICS_HISTOGRAM_SIZE; ++i) {
+        total += histogram.buckets[i];
+    }
+    CHECK_EQUAL(3, total);
+}
+
+TEST(PubSubMetricsTestSuite, percentilesWithinBucketWidth) {
+    //1..10000 ns, the value at a percentile is the upper bound of its bucket, which is at most 25% too high
+    for (uint64_t value = 1; value <= 10000; ++value) {
+        pubsub_metricsHistogram_record(&histogram, value);
+    }
+    const double percentiles[] = {1.0, 50.0, 90.0, 99.0, 99.9};
+    for (double percentile : percentiles) {
+        auto exact = (uint64_t)(percentile * 100.0);
+        uint64_t value = pubsub_metricsHistogram_valueAtPercentile(&histogram, percentile);
+        CHECK(value >= exact);
+        CHECK(value <= exact + exact / 4);
+    }
+    CHECK_EQUAL(10000, pubsub_metricsHistogram_valueAtPercentile(&histogram, 100.0));
+
+    //small values have an exact bucket
+    memset(&histogram, 0, sizeof(histogram));
+    pubsub_metricsHistogram_record(&histogram, 2);
+    CHECK_EQUAL(2, pubsub_metricsHistogram_valueAtPercentile(&histogram, 50.0));
+}
+
+TEST(PubSubMetricsTestSuite, valuesAboveRangeInLastBucket) {
+    uint64_t large = 100ULL * 1000 * 1000 * 1000; //100s, above the ~8.6s range of the buckets
+    pubsub_metricsHistogram_record(&histogram, 10);
+    pubsub_metricsHistogram_record(&histogram, large);
+    CHECK_EQUAL(1, histogram.buckets[PUBSUB_METRICS_HISTOGRAM_SIZE - 1]);
+    CHECK_EQUAL(large, pubsub_metricsHistogram_valueAtPercentile(&histogram, 100.0));
+    uint64_t median = pubsub_metricsHistogram_valueAtPercentile(&histogram, 50.0);
+    CHECK(median >= 10);
+    CHECK(median <= 12);
+}
+
+TEST(PubSubMetricsTestSuite, changedSince) {
+    pubsub_metrics_entry_t entry{};
+    entry.type = PUBSUB_METRICS_RECEIVE_MSG;
+    entry.lastMessage.tv_sec = 10;
+    entry.lastMessage.tv_nsec = 500;
+
+    struct timespec before = {10, 499};
+    struct timespec same = {10, 500};
+    struct timespec after = {11, 0};
+    CHECK(pubsub_metrics_changedSince(&entry, nullptr));
+    CHECK(pubsub_metrics_changedSince(&entry, &before));
+    CHECK(!pubsub_metrics_changedSince(&entry, &same));
+    CHECK(!pubsub_metrics_changedSince(&entry, &after));
+
+    //topic sender entries are always visited
+    entry.type = PUBSUB_METRICS_TOPIC_SENDER;
+    CHECK(pubsub_metrics_changedSince(&entry, &after));
+}
+
+TEST(PubSubMetricsTestSuite, copyWhileRecording) {
+    //a single thread records, the copies of another thread never go back and never have torn values
+    constexpr uint64_t NR_OF_VALUES = 200000;
+    std::atomic<bool> done{false};
+    std::thread recorder{[this, &done]{
+        for (uint64_t i = 1; i <= NR_OF_VALUES; ++i) {
+            pubsub_metricsHistogram_record(&histogram, i);
+        }
+        done = true;
+    }};
+
+    pubsub_metrics_histogram_t copy{};
+    uint64_t lastCount = 0;
+    uint64_t lastSum = 0;
+    while (!done) {
+        pubsub_metricsHistogram_copy(&copy, &histogram);
+        CHECK(copy.count >= lastCount);
+        CHECK(copy.sumInNs >= lastSum);
+        CHECK(copy.count <= NR_OF_VALUES);
+        CHECK(copy.maxInNs <= NR_OF_VALUES);
+        lastCount = copy.count;
+        lastSum = copy.sumInNs;
+    }
+    recorder.join();
+
+    pubsub_metricsHistogram_copy(&copy, &histogram);
+    CHECK_EQUAL(NR_OF_VALUES, copy.count);
+    CHECK_EQUAL(NR_OF_VALUES * (NR_OF_VALUES + 1) / 2, copy.sumInNs);
+    CHECK_EQUAL(1, copy.minInNs);
+    CHECK_EQUAL(NR_OF_VALUES, copy.maxInNs);
+    CHECK(memcmp(copy.buckets, histogram.buckets, sizeof(copy.buckets)) == 0);
+}
@@ -0,0 +1,155 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *  KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <vector>
+
+extern "C" {
+#include "pubsub_msg_batch.h"
+}
+
+#include <CppUTest/TestHarness.h>
+
+namespace {
+    struct batch {
+        unsigned int msgTypeId;
+        std::vector<int> values;
+    };
+
+    struct receiver {
+        std::vector<batch> batches{};
+        int nrOfFreedMsgs{0};
+
+        static int receiveBatch(void *handle, unsigned int msgTypeId, void **msgs, size_t nrOfMsgs) {
+            auto *rcv = static_cast<receiver*>(handle);
+            batch b{msgTypeId, {}};
+            for (size_t i = 0; i < nrOfMsgs; ++i) {
+                b.values.push_back(*static_cast<int*>(msgs[i]));
+            }
+            rcv->batches.push_back(b);
+            return 0;
+        }
+
+        static void freeMsg(void *handle, void *msg) {
+            auto *rcv = static_cast<receiver*>(handle);
+            ++rcv->nrOfFreedMsgs;
+            delete static_cast<int*>(msg);
+        }
+    };
+}
+
+TEST_GROUP(PubSubMsgBatchTestSuite) {
+    receiver rcv{};
+    pubsub_subscriber_t svc{};
+    pubsub_msg_serializer_t msgSer1{};
+    pubsub_msg_serializer_t msgSer2{};
+
+    void setup() {
+        svc.handle = &rcv;
+        svc.receiveBatch = receiver::receiveBatch;
+        msgSer1.handle = &rcv;
+        msgSer1.msgId = 1;
+        msgSer1.freeMsg = receiver::freeMsg;
+        msgSer2.handle = &rcv;
+        msgSer2.msgId = 2;
+        msgSer2.freeMsg = receiver::freeMsg;
+    }
+
+    void add(pubsub_msg_batch_t *b, pubsub_msg_serializer_t *msgSer, int value) {
+        pubsub_msgBatch_add(b, msgSer, new int{value});
+    }
+};
+
+TEST(PubSubMsgBatchTestSuite, noBatchWithoutReceiveBatch) {
+    svc.receiveBatch = nullptr;
+    CHECK(pubsub_msgBatch_create(&svc, 0) == nullptr);
+    CHECK(pubsub_msgBatch_create(nullptr, 0) == nullptr);
+
+    //flush and destroy accept a NULL batch, so that admins can use them unconditionally
+    pubsub_msgBatch_flush(nullptr);
+    pubsub_msgBatch_destroy(nullptr);
+}
+
+TEST(PubSubMsgBatchTestSuite, sameTypeDeliveredOnFlush) {
+    pubsub_msg_batch_t *b = pubsub_msgBatch_create(&svc, 0);
+    CHECK(b != nullptr);
+    for (int i = 0; i < 5; ++i) {
+        add(b, &msgSer1, i);
+    }
+    CHECK(rcv.batches.empty());
+
+    pubsub_msgBatch_flush(b);
+    CHECK_EQUAL(1, (int)rcv.batches.size());
+    CHECK_EQUAL(1u, rcv.batches[0].msgTypeId);
+    CHECK_EQUAL(5, (int)rcv.batches[0].values.size());
+    for (int i = 0; i < 5; ++i) {
+        CHECK_EQUAL(i, rcv.batches[0].values[i]);
+    }
+    CHECK_EQUAL(5, rcv.nrOfFreedMsgs);
+
+    //nothing pending, so no empty batch is delivered
+    pubsub_msgBatch_flush(b);
+    CHECK_EQUAL(1, (int)rcv.batches.size());
+    pubsub_msgBatch_destroy(b);
+}
+
+TEST(PubSubMsgBatchTestSuite, typeChangeDeliversPendingBatch) {
+    pubsub_msg_batch_t *b = pubsub_msgBatch_create(&svc, 0);
+    add(b, &msgSer1, 0);
+    add(b, &msgSer1, 1);
+    add(b, &msgSer2, 2);
+    add(b, &msgSer1, 3);
+    pubsub_msgBatch_flush(b);
+
+    //receive order is kept across types
+    CHECK_EQUAL(3, (int)rcv.batches.size());
+    CHECK_EQUAL(1u, rcv.batches[0].msgTypeId);
+    CHECK_EQUAL(2, (int)rcv.batches[0].values.size());
+    CHECK_EQUAL(2u, rcv.batches[1].msgTypeId);
+    CHECK_EQUAL(2, rcv.batches[1].values[0]);
+    CHECK_EQUAL(1u, rcv.batches[2].msgTypeId);
+    CHECK_EQUAL(3, rcv.batches[2].values[0]);
+    CHECK_EQUAL(4, rcv.nrOfFreedMsgs);
+    pubsub_msgBatch_destroy(b);
+}
+
+TEST(PubSubMsgBatchTestSuite, fullBatchIsDelivered) {
+    pubsub_msg_batch_t *b = pubsub_msgBatch_create(&svc, 3);
+    for (int i = 0; i < 7; ++i) {
+        add(b, &msgSer1, i);
+    }
+    CHECK_EQUAL(2, (int)rcv.batches.size());
+    CHECK_EQUAL(3, (int)rcv.batches[0].values.size());
+    CHECK_EQUAL(3, (int)rcv.batches[1].values.size());
+    CHECK_EQUAL(3, rcv.batches[1].values[0]);
+
+    pubsub_msgBatch_flush(b);
+    CHECK_EQUAL(3, (int)rcv.batches.size());
+    CHECK_EQUAL(1, (int)rcv.batches[2].values.size());
+    CHECK_EQUAL(6, rcv.batches[2].values[0]);
+    pubsub_msgBatch_destroy(b);
+}
+
+TEST(PubSubMsgBatchTestSuite, destroyFreesPendingMsgs) {
+    pubsub_msg_batch_t *b = pubsub_msgBatch_create(&svc, 0);
+    add(b, &msgSer1, 0);
+    add(b, &msgSer1, 1);
+    pubsub_msgBatch_destroy(b);
+    CHECK(rcv.batches.empty());
+    CHECK_EQUAL(2, rcv.nrOfFreedMsgs);
+}
@@ -0,0 +1,108 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *  KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include "celix_properties.h"
+extern "C" {
+#include "pubsub_msg_filters.h"
+}
+
+#include <CppUTest/TestHarness.h>
+
+namespace {
+    struct msg {
+        int id;
+        const char *name;
+    };
+
+    celix_status_t msgToProperties(void */*handle*/, const void *m, celix_properties_t *props) {
+        auto *input = static_cast<const msg*>(m);
+        celix_properties_setLong(props, "id", input->id);
+        celix_properties_set(props, "name", input->name);
+        return CELIX_SUCCESS;
+    }
+}
+
+TEST_GROUP(PubSubMsgFiltersTestSuite) {
+    pubsub_msg_filters_t *filters = nullptr;
+    pubsub_msg_serializer_t msgSer{};
+    msg msg1{1, "first"};
+    msg msg2{2, "second"};
+
+    void setup() {
+        filters = pubsub_msgFilters_create();
+        msgSer.msgToProperties = msgToProperties;
+    }
+
+    void teardown() {
+        pubsub_msgFilters_destroy(filters);
+    }
+};
+
+TEST(PubSubMsgFiltersTestSuite, noSubscribersMatchesAll) {
+    CHECK(pubsub_msgFilters_match(filters, &msgSer, &msg1));
+    CHECK(pubsub_msgFilters_match(nullptr, &msgSer, &msg1));
+    pubsub_msgFilters_destroy(nullptr);
+}
+
+TEST(PubSubMsgFiltersTestSuite, anyFilterMatches) {
+    pubsub_msgFilters_add(filters, "uuid1", "(id=1)");
+    CHECK(pubsub_msgFilters_match(filters, &msgSer, &msg1));
+    CHECK_FALSE(pubsub_msgFilters_match(filters, &msgSer, &msg2));
+
+    pubsub_msgFilters_add(filters, "uuid2", "(name=second)");
+    CHECK(pubsub_msgFilters_match(filters, &msgSer, &msg1));
+    CHECK(pubsub_msgFilters_match(filters, &msgSer, &msg2));
+
+    pubsub_msgFilters_remove(filters, "uuid1");
+    CHECK_FALSE(pubsub_msgFilters_match(filters, &msgSer, &msg1));
+    CHECK(pubsub_msgFilters_match(filters, &msgSer, &msg2));
+
+    //replacing the filter of an endpoint
+    pubsub_msgFilters_add(filters, "uuid2", "(name=first)");
+    CHECK(pubsub_msgFilters_match(filters, &msgSer, &msg1));
+    CHECK_FALSE(pubsub_msgFilters_match(filters, &msgSer, &msg2));
+}
+
+TEST(PubSubMsgFiltersTestSuite, unfilteredSubscriberDisablesFiltering) {
+    pubsub_msgFilters_add(filters, "uuid1", "(id=1)");
+    pubsub_msgFilters_add(filters, "uuid2", nullptr);
+    CHECK(pubsub_msgFilters_match(filters, &msgSer, &msg2));
+
+    //an invalid filter also means that all msgs are needed
+    pubsub_msgFilters_add(filters, "uuid2", "(invalid");
+    CHECK(pubsub_msgFilters_match(filters, &msgSer, &msg2));
+
+    //replacing the unfiltered endpoint enables filtering again
+    pubsub_msgFilters_add(filters, "uuid2", "(id=3)");
+    CHECK_FALSE(pubsub_msgFilters_match(filters, &msgSer, &msg2));
+
+    pubsub_msgFilters_add(filters, "uuid2", nullptr);
+    pubsub_msgFilters_remove(filters, "uuid2");
+    CHECK_FALSE(pubsub_msgFilters_match(filters, &msgSer, &msg2));
+
+    //removing an unknown endpoint is ignored
+    pubsub_msgFilters_remove(filters, "unknown");
+    CHECK_FALSE(pubsub_msgFilters_match(filters, &msgSer, &msg2));
+}
+
+TEST(PubSubMsgFiltersTestSuite, serializerWithoutMsgToPropertiesMatchesAll) {
+    pubsub_msgFilters_add(filters, "uuid1", "(id=1)");
+    msgSer.msgToProperties = nullptr;
+    CHECK(pubsub_msgFilters_match(filters, &msgSer, &msg2));
+}
@@ -0,0 +1,35 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *  KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include "msg_type_id_c_test.h"
+
+/**
+ * Compiled as C, so that the C variant of PUBSUB_MSG_TYPE_ID is used. The ids are compared with the C++ ids in
+ * msg_type_id_test.cc.
+ */
+
+unsigned int msgTypeIdCTest_msgTypeId(const char *fqn) {
+    return PUBSUB_MSG_TYPE_ID(fqn);
+}
+
+unsigned int msgTypeIdCTest_poiMsgId(void) {
+    //the documented C usage: initialized at runtime
+    unsigned int poiMsgId = PUBSUB_MSG_TYPE_ID("poi1");
+    return poiMsgId;
+}
@@ -0,0 +1,76 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *  KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <string>
+
+#include "utils.h"
+#include "pubsub/msg_type_id.h"
+#include "msg_type_id_c_test.h"
+
+#include <CppUTest/TestHarness.h>
+
+namespace {
+    constexpr unsigned int POI_MSG_ID = PUBSUB_MSG_TYPE_ID("poi1");
+    static_assert(POI_MSG_ID == celix::pubsub::msgTypeId("poi1"), "msg type id is a constant expression");
+
+    int msgTypeIndex(unsigned int msgTypeId) {
+        switch (msgTypeId) {
+            case PUBSUB_MSG_TYPE_ID("poi1"):
+                return 1;
+            case PUBSUB_MSG_TYPE_ID("poi2"):
+                return 2;
+            default:
+                return 0;
+        }
+    }
+}
+
+TEST_GROUP(PubSubMsgTypeIdTestSuite) {
+};
+
+TEST(PubSubMsgTypeIdTestSuite, equalsSerializerMsgTypeId) {
+    //the serializers use utils_stringHash of the fqn for msg types without custom msg id
+    std::string fqn{};
+    for (int i = 0; i < 150; ++i) {
+        CHECK_EQUAL(utils_stringHash(fqn.c_str()), celix::pubsub::msgTypeId(fqn.c_str()));
+        fqn += (char)('a' + i % 26);
+    }
+    CHECK_EQUAL(utils_stringHash("org.example.Poi"), PUBSUB_MSG_TYPE_ID("org.example.Poi"));
+    //non ASCII chars are hashed with the same (signed) char arithmetic
+    CHECK_EQUAL(utils_stringHash("caf\xc3\xa9"), PUBSUB_MSG_TYPE_ID("caf\xc3\xa9"));
+}
+
+TEST(PubSubMsgTypeIdTestSuite, usableAsCaseLabel) {
+    CHECK_EQUAL(1, msgTypeIndex(utils_stringHash("poi1")));
+    CHECK_EQUAL(2, msgTypeIndex(utils_stringHash("poi2")));
+    CHECK_EQUAL(0, msgTypeIndex(utils_stringHash("poi3")));
+#if __cplusplus >= 202002L
+    CHECK_EQUAL(POI_MSG_ID, celix::pubsub::msgTypeId<"poi1">());
+#endif
+}
+
+TEST(PubSubMsgTypeIdTestSuite, equalsCMsgTypeId) {
+    std::string fqn{};
+    for (int i = 0; i < 150; ++i) {
+        CHECK_EQUAL(celix::pubsub::msgTypeId(fqn.c_str()), msgTypeIdCTest_msgTypeId(fqn.c_str()));
+        fqn += (char)('a' + i % 26);
+    }
+    CHECK_EQUAL(PUBSUB_MSG_TYPE_ID("caf\xc3\xa9"), msgTypeIdCTest_msgTypeId("caf\xc3\xa9"));
+    CHECK_EQUAL(POI_MSG_ID, msgTypeIdCTest_poiMsgId());
+}
@@ -0,0 +1,136 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <atomic>
+#include <string>
+#include <unistd.h>
+#include <pthread.h>
+#include <sched.h>
+
+#include "celix_properties.h"
+#include "pubsub_constants.h"
+#include "pubsub_utils.h"
+
+#include <CppUTest/TestHarness.h>
+
+namespace {
+    /**
+     * A thread which runs till it is stopped, to configure with pubsub_utils_setupThread.
+     */
+    struct idle_thread {
+        celix_thread_t thread{};
+        std::atomic<bool> running{true};
+
+        idle_thread() {
+            celixThread_create(&thread, nullptr, run, this);
+        }
+
+        ~idle_thread() {
+            running = false;
+            celixThread_join(thread, nullptr);
+        }
+
+        static void* run(void *data) {
+            auto *t = static_cast<idle_thread*>(data);
+            while (t->running) {
+                usleep(1000);
+            }
+            return nullptr;
+        }
+    };
+}
+
+TEST_GROUP(PubSubUtilsTestSuite) {
+    celix_properties_t *props = nullptr;
+
+    void setup() {
+        props = celix_properties_create();
+    }
+
+    void teardown() {
+        celix_properties_destroy(props);
+    }
+};
+
+TEST(PubSubUtilsTestSuite, sendQueuePolicyDefaultsToQos) {
+    CHECK_EQUAL(PUBSUB_SEND_QUEUE_POLICY_DROP_NEWEST_TYPE, pubsub_utils_getSendQueuePolicy(props));
+    celix_properties_set(props, PUBSUB_UTILS_QOS_ATTRIBUTE_KEY, PUBSUB_UTILS_QOS_TYPE_SAMPLE);
+    CHECK_EQUAL(PUBSUB_SEND_QUEUE_POLICY_DROP_OLDEST_TYPE, pubsub_utils_getSendQueuePolicy(props));
+    celix_properties_set(props, PUBSUB_UTILS_QOS_ATTRIBUTE_KEY, PUBSUB_UTILS_QOS_TYPE_CONTROL);
+    CHECK_EQUAL(PUBSUB_SEND_QUEUE_POLICY_BLOCK_TYPE, pubsub_utils_getSendQueuePolicy(props));
+}
+
+TEST(PubSubUtilsTestSuite, configuredSendQueuePolicy) {
+    celix_properties_set(props, PUBSUB_UTILS_QOS_ATTRIBUTE_KEY, PUBSUB_UTILS_QOS_TYPE_CONTROL);
+    celix_properties_set(props, PUBSUB_SEND_QUEUE_POLICY_KEY, PUBSUB_SEND_QUEUE_POLICY_DROP_NEWEST);
+    CHECK_EQUAL(PUBSUB_SEND_QUEUE_POLICY_DROP_NEWEST_TYPE, pubsub_utils_getSendQueuePolicy(props));
+    celix_properties_set(props, PUBSUB_SEND_QUEUE_POLICY_KEY, PUBSUB_SEND_QUEUE_POLICY_DROP_OLDEST);
+    CHECK_EQUAL(PUBSUB_SEND_QUEUE_POLICY_DROP_OLDEST_TYPE, pubsub_utils_getSendQueuePolicy(props));
+    celix_properties_set(props, PUBSUB_SEND_QUEUE_POLICY_KEY, PUBSUB_SEND_QUEUE_POLICY_BLOCK);
+    CHECK_EQUAL(PUBSUB_SEND_QUEUE_POLICY_BLOCK_TYPE, pubsub_utils_getSendQueuePolicy(props));
+
+    //an unknown policy falls back to the qos default
+    celix_properties_set(props, PUBSUB_SEND_QUEUE_POLICY_KEY, "unknown");
+    CHECK_EQUAL(PUBSUB_SEND_QUEUE_POLICY_BLOCK_TYPE, pubsub_utils_getSendQueuePolicy(props));
+}
+
+TEST(PubSubUtilsTestSuite, setupThreadWithoutSettings) {
+    idle_thread t{};
+    CHECK_EQUAL(CELIX_SUCCESS, pubsub_utils_setupThread(&t.thread, nullptr));
+    CHECK_EQUAL(CELIX_SUCCESS, pubsub_utils_setupThread(&t.thread, props));
+}
+
+TEST(PubSubUtilsTestSuite, setupThreadRejectsInvalidSettings) {
+    idle_thread t{};
+    celix_properties_set(props, PUBSUB_THREAD_REALTIME_SCHED_KEY, "SCHED_UNKNOWN");
+    CHECK_EQUAL(CELIX_ILLEGAL_ARGUMENT, pubsub_utils_setupThread(&t.thread, props));
+
+    celix_properties_t *cpuProps = celix_properties_create();
+    for (const char *cpus : {"", "a", "1-", "3-1", "-1", "100000"}) {
+        celix_properties_set(cpuProps, PUBSUB_THREAD_CPU_AFFINITY_KEY, cpus);
+        CHECK_EQUAL(CELIX_ILLEGAL_ARGUMENT, pubsub_utils_setupThread(&t.thread, cpuProps));
+    }
+    celix_properties_destroy(cpuProps);
+}
+
+TEST(PubSubUtilsTestSuite, setupThreadSchedulingAndAffinity) {
+    idle_thread t{};
+    cpu_set_t allowed;
+    CPU_ZERO(&allowed);
+    CHECK_EQUAL(0, pthread_getaffinity_np(t.thread.thread, sizeof(allowed), &allowed));
+    int cpu = 0;
+    while (!CPU_ISSET(cpu, &allowed)) {
+        ++cpu;
+    }
+
+    //SCHED_BATCH does not need CAP_SYS_NICE
+    celix_properties_set(props, PUBSUB_THREAD_REALTIME_SCHED_KEY, "SCHED_BATCH");
+    celix_properties_set(props, PUBSUB_THREAD_CPU_AFFINITY_KEY, std::to_string(cpu).c_str());
+    CHECK_EQUAL(CELIX_SUCCESS, pubsub_utils_setupThread(&t.thread, props));
+
+    int policy = -1;
+    struct sched_param param{};
+    CHECK_EQUAL(0, pthread_getschedparam(t.thread.thread, &policy, &param));
+    CHECK_EQUAL(SCHED_BATCH, policy);
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CHECK_EQUAL(0, pthread_getaffinity_np(t.thread.thread, sizeof(set), &set));
+    CHECK_EQUAL(1, CPU_COUNT(&set));
+    CHECK(CPU_ISSET(cpu, &set));
+}
@@ -0,0 +1,100 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *  KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <vector>
+
+extern "C" {
+#include "pubsub_serializer_cache.h"
+}
+
+#include <CppUTest/TestHarness.h>
+
+namespace {
+    struct destroyed_log {
+        std::vector<pubsub_msg_serializer_t*> destroyed{};
+
+        static void destroy(void *handle, pubsub_msg_serializer_t *msgSerializer) {
+            static_cast<destroyed_log*>(handle)->destroyed.push_back(msgSerializer);
+        }
+    };
+}
+
+TEST_GROUP(PubSubSerializerCacheTestSuite) {
+    destroyed_log log{};
+    pubsub_serializer_cache_t *cache = nullptr;
+    //the keys are only compared by address, like the shared parse results of the serializers
+    int key1{1};
+    int key2{2};
+    pubsub_msg_serializer_t ser1{};
+    pubsub_msg_serializer_t ser2{};
+
+    void setup() {
+        cache = pubsub_serializerCache_create(&log, destroyed_log::destroy);
+    }
+
+    void teardown() {
+        pubsub_serializerCache_destroy(cache);
+    }
+};
+
+TEST(PubSubSerializerCacheTestSuite, sharedTillLastRelease) {
+    POINTERS_EQUAL(nullptr, pubsub_serializerCache_acquire(cache, &key1));
+    POINTERS_EQUAL(&ser1, pubsub_serializerCache_add(cache, &key1, &ser1));
+    POINTERS_EQUAL(&ser1, pubsub_serializerCache_acquire(cache, &key1));
+    POINTERS_EQUAL(nullptr, pubsub_serializerCache_acquire(cache, &key2));
+
+    pubsub_serializerCache_release(cache, &key1, &ser1);
+    CHECK(log.destroyed.empty());
+    pubsub_serializerCache_release(cache, &key1, &ser1);
+    CHECK_EQUAL(1, (int)log.destroyed.size());
+    POINTERS_EQUAL(&ser1, log.destroyed[0]);
+    POINTERS_EQUAL(nullptr, pubsub_serializerCache_acquire(cache, &key1));
+}
+
+TEST(PubSubSerializerCacheTestSuite, addOfCachedKeyReturnsCachedSerializer) {
+    POINTERS_EQUAL(&ser1, pubsub_serializerCache_add(cache, &key1, &ser1));
+    //another bundle created a msg serializer for the same key meanwhile, it gets the cached one
+    POINTERS_EQUAL(&ser1, pubsub_serializerCache_add(cache, &key1, &ser2));
+    CHECK(log.destroyed.empty());
+
+    pubsub_serializerCache_release(cache, &key1, &ser1);
+    pubsub_serializerCache_release(cache, &key1, &ser1);
+    CHECK_EQUAL(1, (int)log.destroyed.size());
+    POINTERS_EQUAL(&ser1, log.destroyed[0]);
+}
+
+TEST(PubSubSerializerCacheTestSuite, releaseOfUncachedSerializerDestroysIt) {
+    POINTERS_EQUAL(&ser1, pubsub_serializerCache_add(cache, &key1, &ser1));
+    pubsub_serializerCache_release(cache, &key1, &ser2);
+    pubsub_serializerCache_release(cache, &key2, &ser2);
+    CHECK_EQUAL(2, (int)log.destroyed.size());
+    POINTERS_EQUAL(&ser2, log.destroyed[0]);
+    POINTERS_EQUAL(&ser2, log.destroyed[1]);
+    POINTERS_EQUAL(&ser1, pubsub_serializerCache_acquire(cache, &key1));
+}
+
+TEST(PubSubSerializerCacheTestSuite, destroyDestroysRemainingSerializers) {
+    pubsub_serializerCache_add(cache, &key1, &ser1);
+    pubsub_serializerCache_add(cache, &key2, &ser2);
+    pubsub_serializerCache_acquire(cache, &key2);
+    pubsub_serializerCache_destroy(cache);
+    cache = nullptr;
+    CHECK_EQUAL(2, (int)log.destroyed.size());
+    pubsub_serializerCache_destroy(nullptr);
+}
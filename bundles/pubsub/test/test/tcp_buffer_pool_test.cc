@@ -0,0 +1,147 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *  KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <algorithm>
+#include <thread>
+#include <vector>
+#include <atomic>
+#include <cstring>
+
+extern "C" {
+#include "pubsub_tcp_buffer_pool.h"
+}
+
+#include <CppUTest/TestHarness.h>
+
+TEST_GROUP(PubSubTcpBufferPoolTestSuite) {
+    static constexpr unsigned int MIN_BUFFER_SIZE = 1024;
+    pubsub_tcp_buffer_pool_t *pool = nullptr;
+
+    void setup() {
+        pool = pubsub_tcpBufferPool_create(MIN_BUFFER_SIZE, 4, false);
+        CHECK(pool != nullptr);
+    }
+
+    void teardown() {
+        pubsub_tcpBufferPool_destroy(pool);
+    }
+};
+
+TEST(PubSubTcpBufferPoolTestSuite, sizeClasses) {
+    const unsigned int sizes[] = {0, 1, MIN_BUFFER_SIZE, MIN_BUFFER_SIZE + 1, 100 * MIN_BUFFER_SIZE, 128 * MIN_BUFFER_SIZE};
+    const unsigned int expected[] = {MIN_BUFFER_SIZE, MIN_BUFFER_SIZE, MIN_BUFFER_SIZE, 2 * MIN_BUFFER_SIZE, 128 * MIN_BUFFER_SIZE, 128 * MIN_BUFFER_SIZE};
+    for (size_t i = 0; i < sizeof(sizes) / sizeof(sizes[0]); ++i) {
+        unsigned int bufferSize = 0;
+        char *buffer = pubsub_tcpBufferPool_acquire(pool, sizes[i], &bufferSize);
+        CHECK(buffer != nullptr);
+        CHECK_EQUAL(expected[i], bufferSize);
+        memset(buffer, 0xAB, bufferSize);
+        pubsub_tcpBufferPool_release(pool, buffer, bufferSize);
+    }
+
+    //larger than the largest size class, allocated with the requested size
+    unsigned int bufferSize = 0;
+    char *buffer = pubsub_tcpBufferPool_acquire(pool, 128 * MIN_BUFFER_SIZE + 1, &bufferSize);
+    CHECK(buffer != nullptr);
+    CHECK_EQUAL(128 * MIN_BUFFER_SIZE + 1, bufferSize);
+    memset(buffer, 0xAB, bufferSize);
+    pubsub_tcpBufferPool_release(pool, buffer, bufferSize);
+}
+
+TEST(PubSubTcpBufferPoolTestSuite, releasedBufferIsReused) {
+    unsigned int bufferSize = 0;
+    char *first = pubsub_tcpBufferPool_acquire(pool, 10, &bufferSize);
+    pubsub_tcpBufferPool_release(pool, first, bufferSize);
+    char *second = pubsub_tcpBufferPool_acquire(pool, 20, &bufferSize);
+    POINTERS_EQUAL(first, second);
+    pubsub_tcpBufferPool_release(pool, second, bufferSize);
+}
+
+TEST(PubSubTcpBufferPoolTestSuite, exhaustedSlabFallsBackToMalloc) {
+    //4 buffers fit in the slab, the others are allocated with the size of the size class
+    std::vector<char*> buffers{};
+    for (int i = 0; i < 6; ++i) {
+        unsigned int bufferSize = 0;
+        char *buffer = pubsub_tcpBufferPool_acquire(pool, 100, &bufferSize);
+        CHECK(buffer != nullptr);
+        CHECK_EQUAL(MIN_BUFFER_SIZE, bufferSize);
+        memset(buffer, i, bufferSize);
+        buffers.push_back(buffer);
+    }
+    for (size_t i = 0; i < buffers.size(); ++i) {
+        for (size_t j = i + 1; j < buffers.size(); ++j) {
+            CHECK(buffers[i] != buffers[j]);
+        }
+        CHECK_EQUAL((char)i, buffers[i][MIN_BUFFER_SIZE - 1]);
+    }
+
+    //the allocated buffers are freed on release, the slab buffers are pooled again
+    for (char *buffer : buffers) {
+        pubsub_tcpBufferPool_release(pool, buffer, MIN_BUFFER_SIZE);
+    }
+    std::vector<char*> reused{};
+    for (int i = 0; i < 4; ++i) {
+        unsigned int bufferSize = 0;
+        char *buffer = pubsub_tcpBufferPool_acquire(pool, 100, &bufferSize);
+        CHECK(std::find(buffers.begin(), buffers.begin() + 4, buffer) != buffers.begin() + 4);
+        reused.push_back(buffer);
+    }
+    for (char *buffer : reused) {
+        pubsub_tcpBufferPool_release(pool, buffer, MIN_BUFFER_SIZE);
+    }
+}
+
+TEST(PubSubTcpBufferPoolTestSuite, hugePagesFallBack) {
+    //falls back to normal pages if no huge pages are available
+    pubsub_tcp_buffer_pool_t *hugePool = pubsub_tcpBufferPool_create(MIN_BUFFER_SIZE, 4, true);
+    unsigned int bufferSize = 0;
+    char *buffer = pubsub_tcpBufferPool_acquire(hugePool, MIN_BUFFER_SIZE, &bufferSize);
+    CHECK(buffer != nullptr);
+    CHECK_EQUAL(MIN_BUFFER_SIZE, bufferSize);
+    memset(buffer, 0xAB, bufferSize);
+    pubsub_tcpBufferPool_release(hugePool, buffer, bufferSize);
+    pubsub_tcpBufferPool_destroy(hugePool);
+}
+
+TEST(PubSubTcpBufferPoolTestSuite, concurrentUse) {
+    constexpr int NR_OF_THREADS = 4;
+    std::atomic<int> corrupted{0};
+    std::vector<std::thread> threads{};
+    for (int t = 0; t < NR_OF_THREADS; ++t) {
+        threads.emplace_back([this, t, &corrupted]{
+            for (int i = 0; i < 1000; ++i) {
+                unsigned int bufferSize = 0;
+                char *buffer = pubsub_tcpBufferPool_acquire(pool, (unsigned int)(i % 3000), &bufferSize);
+                memset(buffer, t, bufferSize);
+                std::this_thread::yield();
+                for (unsigned int j = 0; j < bufferSize; ++j) {
+                    if (buffer[j] != (char)t) {
+                        ++corrupted;
+                        break;
+                    }
+                }
+                pubsub_tcpBufferPool_release(pool, buffer, bufferSize);
+            }
+        });
+    }
+    for (auto &thread : threads) {
+        thread.join();
+    }
+    CHECK_EQUAL(0, corrupted);
+}
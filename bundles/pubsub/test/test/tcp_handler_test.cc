@@ -0,0 +1,678 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *  KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <thread>
+#include <chrono>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <vector>
+#include <memory>
+#include <string>
+#include <cstring>
+
+extern "C" {
+#include "pubsub_tcp_handler.h"
+}
+
+#include <CppUTest/TestHarness.h>
+
+namespace {
+    struct received_msg {
+        pubsub_tcp_msg_header_t header;
+        std::vector<unsigned char> payload;
+    };
+
+    /**
+     * A tcp handler with its handler thread, collecting the received msgs.
+     */
+    struct tcp_peer {
+        pubsub_tcpHandler_t *handler{nullptr};
+        std::thread thread{};
+        std::atomic<bool> running{false};
+
+        std::mutex mutex{};
+        std::condition_variable cond{};
+        std::vector<received_msg> msgs{};
+        int nrOfConnects{0};
+        bool block{false};
+
+        tcp_peer() {
+            handler = pubsub_tcpHandler_create(nullptr);
+            pubsub_tcpHandler_setTimeout(handler, 10);
+            pubsub_tcpHandler_addMessageHandler(handler, this, processMsg);
+            pubsub_tcpHandler_addConnectionCallback(handler, this, connected, nullptr);
+        }
+
+        ~tcp_peer() {
+            stop();
+            pubsub_tcpHandler_destroy(handler);
+        }
+
+        void start() {
+            running = true;
+            thread = std::thread{[this]{
+                while (running) {
+                    pubsub_tcpHandler_handler(handler);
+                }
+            }};
+        }
+
+        void stop() {
+            setBlock(false);
+            running = false;
+            if (thread.joinable()) {
+                thread.join();
+            }
+        }
+
+        static void processMsg(void *payload, const pubsub_tcp_msg_header_t *header, const unsigned char *buffer, size_t size, struct timespec */*receiveTime*/) {
+            auto *peer = static_cast<tcp_peer*>(payload);
+            std::unique_lock<std::mutex> lck{peer->mutex};
+            peer->cond.wait(lck, [peer]{ return !peer->block; });
+            received_msg msg{};
+            msg.header = *header;
+            msg.payload.assign(buffer, buffer + size);
+            peer->msgs.push_back(std::move(msg));
+            peer->cond.notify_all();
+        }
+
+        static void connected(void *payload, const char */*url*/, bool /*lock*/) {
+            auto *peer = static_cast<tcp_peer*>(payload);
+            std::lock_guard<std::mutex> lck{peer->mutex};
+            peer->nrOfConnects += 1;
+            peer->cond.notify_all();
+        }
+
+        void setBlock(bool b) {
+            std::lock_guard<std::mutex> lck{mutex};
+            block = b;
+            cond.notify_all();
+        }
+
+        bool waitForMsgs(size_t count, std::chrono::milliseconds timeout = std::chrono::seconds{10}) {
+            std::unique_lock<std::mutex> lck{mutex};
+            return cond.wait_for(lck, timeout, [&]{ return msgs.size() >= count; });
+        }
+
+        bool waitForConnects(int count) {
+            std::unique_lock<std::mutex> lck{mutex};
+            return cond.wait_for(lck, std::chrono::seconds{5}, [&]{ return nrOfConnects >= count; });
+        }
+    };
+
+    /**
+     * Receiver of the msgs of a single topic of a multiplexed tcp handler.
+     */
+    struct topic_sink {
+        std::mutex mutex{};
+        std::condition_variable cond{};
+        std::vector<received_msg> msgs{};
+        int nrOfConnects{0};
+
+        static void processMsg(void *payload, const pubsub_tcp_msg_header_t *header, const unsigned char *buffer, size_t size, struct timespec */*receiveTime*/) {
+            auto *sink = static_cast<topic_sink*>(payload);
+            std::lock_guard<std::mutex> lck{sink->mutex};
+            received_msg msg{};
+            msg.header = *header;
+            msg.payload.assign(buffer, buffer + size);
+            sink->msgs.push_back(std::move(msg));
+            sink->cond.notify_all();
+        }
+
+        static void connected(void *payload, const char */*url*/, bool /*lock*/) {
+            auto *sink = static_cast<topic_sink*>(payload);
+            std::lock_guard<std::mutex> lck{sink->mutex};
+            sink->nrOfConnects += 1;
+            sink->cond.notify_all();
+        }
+
+        bool waitForMsgs(size_t count) {
+            std::unique_lock<std::mutex> lck{mutex};
+            return cond.wait_for(lck, std::chrono::seconds{10}, [&]{ return msgs.size() >= count; });
+        }
+
+        bool waitForConnects(int count) {
+            std::unique_lock<std::mutex> lck{mutex};
+            return cond.wait_for(lck, std::chrono::seconds{5}, [&]{ return nrOfConnects >= count; });
+        }
+
+        size_t size() {
+            std::lock_guard<std::mutex> lck{mutex};
+            return msgs.size();
+        }
+    };
+
+    pubsub_tcp_msg_header_t createHeader(uint32_t seqNr) {
+        pubsub_tcp_msg_header_t header{};
+        header.type = 42;
+        header.seqNr = seqNr;
+        header.major = 1;
+        return header;
+    }
+
+    std::vector<unsigned char> createPayload(uint32_t seqNr, size_t size) {
+        std::vector<unsigned char> payload(size);
+        for (size_t i = 0; i < size; ++i) {
+            payload[i] = (unsigned char)(seqNr + i);
+        }
+        return payload;
+    }
+
+    /**
+     * Checks that the msgs are complete and that their seqNrs are increasing.
+     */
+    void checkMsgs(const std::vector<received_msg> &msgs, size_t payloadSize) {
+        for (size_t i = 0; i < msgs.size(); ++i) {
+            const received_msg &msg = msgs[i];
+            CHECK_EQUAL(payloadSize, msg.payload.size());
+            CHECK(createPayload(msg.header.seqNr, payloadSize) == msg.payload);
+            if (i > 0) {
+                CHECK(msgs[i - 1].header.seqNr < msg.header.seqNr);
+            }
+        }
+    }
+}
+
+TEST_GROUP(PubSubTcpHandlerTestSuite) {
+    tcp_peer *sender = nullptr;
+    tcp_peer *receiver = nullptr;
+    std::string url{};
+
+    void setup() {
+        sender = new tcp_peer{};
+        receiver = new tcp_peer{};
+    }
+
+    void teardown() {
+        delete receiver;
+        delete sender;
+    }
+
+    /**
+     * Listens with the sender on a free port and starts the handler threads.
+     */
+    void listen() {
+        for (int port = 38100; port < 38200 && url.empty(); ++port) {
+            std::string candidate = "tcp://127.0.0.1:" + std::to_string(port);
+            if (pubsub_tcpHandler_listen(sender->handler, (char*)candidate.c_str()) >= 0) {
+                url = candidate;
+            }
+        }
+        CHECK(!url.empty());
+        sender->start();
+        receiver->start();
+    }
+
+    /**
+     * Listens with the sender on a free port and connects the receiver to it.
+     */
+    void connect() {
+        listen();
+        CHECK(pubsub_tcpHandler_connect(receiver->handler, (char*)url.c_str()) >= 0);
+        CHECK(sender->waitForConnects(1));
+    }
+
+    /**
+     * Connects several clients to a sender with multiple handler threads and writes msgs in both directions.
+     */
+    void testHandlerThreads(bool reusePort) {
+        pubsub_tcpHandler_setThreads(sender->handler, 3, reusePort);
+        listen();
+        constexpr int NR_OF_CLIENTS = 4;
+        constexpr uint32_t NR_OF_MSGS = 100;
+        constexpr size_t PAYLOAD_SIZE = 1000;
+        std::vector<std::unique_ptr<tcp_peer>> clients{};
+        for (int i = 0; i < NR_OF_CLIENTS; ++i) {
+            clients.emplace_back(new tcp_peer{});
+            clients.back()->start();
+            CHECK(pubsub_tcpHandler_connect(clients.back()->handler, (char*)url.c_str()) >= 0);
+        }
+        CHECK(sender->waitForConnects(NR_OF_CLIENTS));
+
+        //msgs of every client are received by the handler thread owning the connection, the callbacks are serialized
+        for (uint32_t seqNr = 0; seqNr < NR_OF_MSGS; ++seqNr) {
+            for (int i = 0; i < NR_OF_CLIENTS; ++i) {
+                pubsub_tcp_msg_header_t header = createHeader(seqNr);
+                header.type = (uint32_t)i;
+                std::vector<unsigned char> payload = createPayload(seqNr, PAYLOAD_SIZE);
+                CHECK(pubsub_tcpHandler_write(clients[i]->handler, &header, payload.data(), (unsigned int)payload.size(), 0) >= 0);
+            }
+        }
+        CHECK(sender->waitForMsgs(NR_OF_CLIENTS * NR_OF_MSGS));
+        {
+            std::lock_guard<std::mutex> lck{sender->mutex};
+            CHECK_EQUAL(NR_OF_CLIENTS * NR_OF_MSGS, sender->msgs.size());
+            uint32_t expected[NR_OF_CLIENTS] = {};
+            for (const received_msg &msg : sender->msgs) {
+                CHECK(msg.header.type < (uint32_t)NR_OF_CLIENTS);
+                CHECK_EQUAL(expected[msg.header.type], msg.header.seqNr);
+                CHECK(createPayload(msg.header.seqNr, PAYLOAD_SIZE) == msg.payload);
+                expected[msg.header.type] += 1;
+            }
+        }
+
+        //msgs written by the sender reach the connections of all handler threads
+        for (uint32_t seqNr = 0; seqNr < NR_OF_MSGS; ++seqNr) {
+            pubsub_tcp_msg_header_t header = createHeader(seqNr);
+            std::vector<unsigned char> payload = createPayload(seqNr, PAYLOAD_SIZE);
+            CHECK(pubsub_tcpHandler_write(sender->handler, &header, payload.data(), (unsigned int)payload.size(), 0) >= 0);
+        }
+        for (auto &client : clients) {
+            CHECK(client->waitForMsgs(NR_OF_MSGS));
+            std::lock_guard<std::mutex> lck{client->mutex};
+            CHECK_EQUAL(NR_OF_MSGS, client->msgs.size());
+            checkMsgs(client->msgs, PAYLOAD_SIZE);
+        }
+    }
+};
+
+TEST(PubSubTcpHandlerTestSuite, sendQueueKeepsOrderForSlowReceiver) {
+    pubsub_tcpHandler_setBlockingWrite(sender->handler, false);
+    pubsub_tcpHandler_setSendQueue(sender->handler, PUBSUB_SEND_QUEUE_POLICY_DROP_NEWEST_TYPE, 64 * 1024 * 1024);
+    connect();
+
+    //the receiver does not read, so the socket buffers fill up and the remaining data is queued
+    constexpr size_t NR_OF_MSGS = 256;
+    constexpr size_t PAYLOAD_SIZE = 64 * 1024;
+    receiver->setBlock(true);
+    for (uint32_t seqNr = 0; seqNr < NR_OF_MSGS; ++seqNr) {
+        pubsub_tcp_msg_header_t header = createHeader(seqNr);
+        std::vector<unsigned char> payload = createPayload(seqNr, PAYLOAD_SIZE);
+        CHECK(pubsub_tcpHandler_write(sender->handler, &header, payload.data(), (unsigned int)payload.size(), 0) >= 0);
+    }
+    unsigned long queuedBytes = 0;
+    unsigned long maxQueuedBytes = 0;
+    unsigned long droppedMsgs = 0;
+    pubsub_tcpHandler_sendQueueMetrics(sender->handler, &queuedBytes, &maxQueuedBytes, &droppedMsgs);
+    CHECK(maxQueuedBytes > 0);
+    CHECK_EQUAL(0, droppedMsgs);
+
+    //the queue is written when the socket is writable again, nothing is lost
+    receiver->setBlock(false);
+    CHECK(receiver->waitForMsgs(NR_OF_MSGS));
+    std::lock_guard<std::mutex> lck{receiver->mutex};
+    CHECK_EQUAL(NR_OF_MSGS, receiver->msgs.size());
+    checkMsgs(receiver->msgs, PAYLOAD_SIZE);
+    for (size_t i = 0; i < receiver->msgs.size(); ++i) {
+        CHECK_EQUAL(i, receiver->msgs[i].header.seqNr);
+    }
+    pubsub_tcpHandler_sendQueueMetrics(sender->handler, &queuedBytes, &maxQueuedBytes, &droppedMsgs);
+    CHECK_EQUAL(0, queuedBytes);
+}
+
+TEST(PubSubTcpHandlerTestSuite, batchedReceiveOfSmallMsgs) {
+    connect();
+
+    //many small msgs written with a single call are received with as few reads as possible, but still one by one
+    constexpr size_t NR_OF_MSGS = 1000;
+    constexpr size_t PAYLOAD_SIZE = 13;
+    std::vector<pubsub_tcp_msg_header_t> headers{};
+    std::vector<std::vector<unsigned char>> payloads{};
+    std::vector<void*> buffers{};
+    std::vector<unsigned int> sizes{};
+    for (uint32_t seqNr = 0; seqNr < NR_OF_MSGS; ++seqNr) {
+        headers.push_back(createHeader(seqNr));
+        payloads.push_back(createPayload(seqNr, PAYLOAD_SIZE));
+    }
+    for (auto &payload : payloads) {
+        buffers.push_back(payload.data());
+        sizes.push_back((unsigned int)payload.size());
+    }
+    CHECK(pubsub_tcpHandler_writeMany(sender->handler, headers.data(), buffers.data(), sizes.data(), NR_OF_MSGS, 0) >= 0);
+
+    CHECK(receiver->waitForMsgs(NR_OF_MSGS));
+    std::lock_guard<std::mutex> lck{receiver->mutex};
+    CHECK_EQUAL(NR_OF_MSGS, receiver->msgs.size());
+    checkMsgs(receiver->msgs, PAYLOAD_SIZE);
+}
+
+TEST(PubSubTcpHandlerTestSuite, scatterGatherPayloads) {
+    pubsub_tcpHandler_setLastValueCache(sender->handler, 1);
+    listen();
+
+    //the payload of every msg is split over 1 to 4 io vectors (including an empty one), which are received as one payload
+    constexpr uint32_t NR_OF_MSGS = 100;
+    constexpr size_t PAYLOAD_SIZE = 1000;
+    auto writeMsgs = [&](uint32_t first, uint32_t count) {
+        std::vector<pubsub_tcp_msg_header_t> headers{};
+        std::vector<std::vector<unsigned char>> payloads{};
+        std::vector<struct iovec> vectors{};
+        std::vector<size_t> nrOfVectors{};
+        for (uint32_t seqNr = first; seqNr < first + count; ++seqNr) {
+            headers.push_back(createHeader(seqNr));
+            payloads.push_back(createPayload(seqNr, PAYLOAD_SIZE));
+        }
+        for (uint32_t i = 0; i < count; ++i) {
+            size_t parts = 1 + i % 4;
+            size_t offset = 0;
+            for (size_t part = 0; part < parts; ++part) {
+                size_t len = part + 1 == parts ? PAYLOAD_SIZE - offset : (part == 1 ? 0 : PAYLOAD_SIZE / 4);
+                vectors.push_back({payloads[i].data() + offset, len});
+                offset += len;
+            }
+            nrOfVectors.push_back(parts);
+        }
+        CHECK(pubsub_tcpHandler_writeVectorsKeyed(sender->handler, headers.data(), vectors.data(), nrOfVectors.data(), nullptr, count, 0) >= 0);
+    };
+
+    //the last value cache stores the gathered payload
+    writeMsgs(0, 4);
+    CHECK(pubsub_tcpHandler_connect(receiver->handler, (char*)url.c_str()) >= 0);
+    CHECK(sender->waitForConnects(1));
+    writeMsgs(4, NR_OF_MSGS - 4);
+
+    CHECK(receiver->waitForMsgs(NR_OF_MSGS - 3));
+    std::lock_guard<std::mutex> lck{receiver->mutex};
+    CHECK_EQUAL(NR_OF_MSGS - 3, receiver->msgs.size());
+    checkMsgs(receiver->msgs, PAYLOAD_SIZE);
+    CHECK_EQUAL(3, receiver->msgs.front().header.seqNr);
+    CHECK_EQUAL(NR_OF_MSGS - 1, receiver->msgs.back().header.seqNr);
+}
+
+TEST(PubSubTcpHandlerTestSuite, ioUringSendAndReceive) {
+    //falls back to epoll if io_uring is not available, the msgs are delivered the same way
+    pubsub_tcpHandler_setIoUring(sender->handler, true);
+    pubsub_tcpHandler_setIoUring(receiver->handler, true);
+    connect();
+
+    //msgs smaller and larger than the io_uring receive buffers, the larger ones are written with zero copy sends
+    constexpr size_t NR_OF_MSGS = 200;
+    const size_t payloadSizes[] = {13, 16 * 1024 - 10, 100 * 1024};
+    for (uint32_t seqNr = 0; seqNr < NR_OF_MSGS; ++seqNr) {
+        pubsub_tcp_msg_header_t header = createHeader(seqNr);
+        std::vector<unsigned char> payload = createPayload(seqNr, payloadSizes[seqNr % 3]);
+        CHECK(pubsub_tcpHandler_write(sender->handler, &header, payload.data(), (unsigned int)payload.size(), 0) >= 0);
+    }
+
+    CHECK(receiver->waitForMsgs(NR_OF_MSGS));
+    std::lock_guard<std::mutex> lck{receiver->mutex};
+    CHECK_EQUAL(NR_OF_MSGS, receiver->msgs.size());
+    for (size_t i = 0; i < receiver->msgs.size(); ++i) {
+        const received_msg &msg = receiver->msgs[i];
+        CHECK_EQUAL(i, msg.header.seqNr);
+        CHECK(createPayload((uint32_t)i, payloadSizes[i % 3]) == msg.payload);
+    }
+}
+
+TEST(PubSubTcpHandlerTestSuite, handlerThreads) {
+    testHandlerThreads(false);
+}
+
+TEST(PubSubTcpHandlerTestSuite, handlerThreadsWithReusePort) {
+    testHandlerThreads(true);
+}
+
+TEST(PubSubTcpHandlerTestSuite, lastValueCacheForNewConnection) {
+    pubsub_tcpHandler_setLastValueCache(sender->handler, 2);
+    listen();
+
+    //msgs written before the receiver connects, only the last msg of the first 2 msg types is cached
+    constexpr size_t PAYLOAD_SIZE = 100;
+    uint32_t seqNr = 0;
+    for (uint32_t type : {1u, 2u, 1u, 3u, 2u}) {
+        pubsub_tcp_msg_header_t header = createHeader(seqNr);
+        header.type = type;
+        std::vector<unsigned char> payload = createPayload(seqNr++, PAYLOAD_SIZE);
+        CHECK(pubsub_tcpHandler_write(sender->handler, &header, payload.data(), (unsigned int)payload.size(), 0) >= 0);
+    }
+
+    //the cached msgs are written to the new connection before any other msg
+    CHECK(pubsub_tcpHandler_connect(receiver->handler, (char*)url.c_str()) >= 0);
+    CHECK(sender->waitForConnects(1));
+    pubsub_tcp_msg_header_t header = createHeader(seqNr);
+    std::vector<unsigned char> payload = createPayload(seqNr, PAYLOAD_SIZE);
+    CHECK(pubsub_tcpHandler_write(sender->handler, &header, payload.data(), (unsigned int)payload.size(), 0) >= 0);
+
+    CHECK(receiver->waitForMsgs(3));
+    std::this_thread::sleep_for(std::chrono::milliseconds{50});
+    std::lock_guard<std::mutex> lck{receiver->mutex};
+    CHECK_EQUAL(3, receiver->msgs.size());
+    checkMsgs(receiver->msgs, PAYLOAD_SIZE);
+    CHECK_EQUAL(1, receiver->msgs[0].header.type);
+    CHECK_EQUAL(2, receiver->msgs[0].header.seqNr);
+    CHECK_EQUAL(2, receiver->msgs[1].header.type);
+    CHECK_EQUAL(4, receiver->msgs[1].header.seqNr);
+    CHECK_EQUAL(5, receiver->msgs[2].header.seqNr);
+}
+
+TEST(PubSubTcpHandlerTestSuite, keyedLastValueCacheForNewConnection) {
+    pubsub_tcpHandler_setLastValueCache(sender->handler, 4);
+    listen();
+
+    //the last msg per (msg type, key) is cached, till the cache is full
+    constexpr size_t PAYLOAD_SIZE = 100;
+    const uint32_t types[] = {1, 1, 1, 2, 1, 1};
+    const uint32_t keys[] = {11, 12, 11, 11, 13, 14};
+    for (uint32_t seqNr = 0; seqNr < 6; ++seqNr) {
+        pubsub_tcp_msg_header_t header = createHeader(seqNr);
+        header.type = types[seqNr];
+        std::vector<unsigned char> payload = createPayload(seqNr, PAYLOAD_SIZE);
+        void *buffer = payload.data();
+        auto size = (unsigned int)payload.size();
+        CHECK(pubsub_tcpHandler_writeManyKeyed(sender->handler, &header, &buffer, &size, &keys[seqNr], 1, 0) >= 0);
+    }
+
+    //the cached msgs are written to the new connection in the order their (msg type, key) was first cached
+    CHECK(pubsub_tcpHandler_connect(receiver->handler, (char*)url.c_str()) >= 0);
+    CHECK(receiver->waitForMsgs(4));
+    std::this_thread::sleep_for(std::chrono::milliseconds{50});
+    std::lock_guard<std::mutex> lck{receiver->mutex};
+    CHECK_EQUAL(4, receiver->msgs.size());
+    const uint32_t expected[] = {2, 1, 3, 4};
+    for (size_t i = 0; i < 4; ++i) {
+        const received_msg &msg = receiver->msgs[i];
+        CHECK_EQUAL(expected[i], msg.header.seqNr);
+        CHECK_EQUAL(types[expected[i]], msg.header.type);
+        CHECK(createPayload(msg.header.seqNr, PAYLOAD_SIZE) == msg.payload);
+    }
+}
+
+TEST(PubSubTcpHandlerTestSuite, multiplexedTopics) {
+    constexpr uint32_t TOPIC_A = 0x0A;
+    constexpr uint32_t TOPIC_B = 0x0B;
+    constexpr size_t PAYLOAD_SIZE = 100;
+    pubsub_tcpHandler_setMultiplexed(sender->handler, true);
+    pubsub_tcpHandler_setMultiplexed(receiver->handler, true);
+    topic_sink sinkA{};
+    topic_sink sinkB{};
+    CHECK_EQUAL(0, pubsub_tcpHandler_addTopicHandler(receiver->handler, TOPIC_A, &sinkA, topic_sink::processMsg, topic_sink::connected, nullptr));
+    CHECK_EQUAL(0, pubsub_tcpHandler_addTopicHandler(receiver->handler, TOPIC_B, &sinkB, topic_sink::processMsg, topic_sink::connected, nullptr));
+    CHECK(pubsub_tcpHandler_addTopicHandler(receiver->handler, TOPIC_A, &sinkB, topic_sink::processMsg, nullptr, nullptr) < 0);
+    listen();
+
+    uint32_t seqNr = 0;
+    auto writeMsgs = [&]{
+        //the sender only writes the msgs of the topics subscribed by the peer, the control msgs are handled async
+        std::this_thread::sleep_for(std::chrono::milliseconds{50});
+        for (int i = 0; i < 10; ++i) {
+            pubsub_tcp_msg_header_t header = createHeader(seqNr);
+            header.topicId = i % 2 == 0 ? TOPIC_A : TOPIC_B;
+            std::vector<unsigned char> payload = createPayload(seqNr++, PAYLOAD_SIZE);
+            CHECK(pubsub_tcpHandler_write(sender->handler, &header, payload.data(), (unsigned int)payload.size(), 0) >= 0);
+        }
+    };
+
+    int fd = pubsub_tcpHandler_subscribe(receiver->handler, (char*)url.c_str(), TOPIC_A);
+    CHECK(fd >= 0);
+    CHECK(sinkA.waitForConnects(1));
+    writeMsgs();
+    CHECK(sinkA.waitForMsgs(5));
+
+    //a second topic is subscribed through the same connection
+    CHECK_EQUAL(fd, pubsub_tcpHandler_subscribe(receiver->handler, (char*)url.c_str(), TOPIC_B));
+    CHECK(sinkB.waitForConnects(1));
+    writeMsgs();
+    CHECK(sinkA.waitForMsgs(10));
+    CHECK(sinkB.waitForMsgs(5));
+
+    //msgs of an unsubscribed topic are not written anymore, the connection stays open for the other topic
+    CHECK_EQUAL(0, pubsub_tcpHandler_unsubscribe(receiver->handler, (char*)url.c_str(), TOPIC_A));
+    writeMsgs();
+    CHECK(sinkB.waitForMsgs(10));
+    std::this_thread::sleep_for(std::chrono::milliseconds{50});
+    CHECK_EQUAL(10, sinkA.size());
+    CHECK_EQUAL(10, sinkB.size());
+    for (auto *sink : {&sinkA, &sinkB}) {
+        std::lock_guard<std::mutex> lck{sink->mutex};
+        CHECK_EQUAL(1, sink->nrOfConnects);
+        checkMsgs(sink->msgs, PAYLOAD_SIZE);
+        for (const received_msg &msg : sink->msgs) {
+            CHECK_EQUAL(sink == &sinkA ? TOPIC_A : TOPIC_B, msg.header.topicId);
+        }
+    }
+
+    CHECK(pubsub_tcpHandler_unsubscribe(receiver->handler, (char*)url.c_str(), TOPIC_B) >= 0);
+    receiver->stop();
+    CHECK_EQUAL(0, pubsub_tcpHandler_removeTopicHandler(receiver->handler, TOPIC_A));
+    CHECK_EQUAL(0, pubsub_tcpHandler_removeTopicHandler(receiver->handler, TOPIC_B));
+    CHECK(pubsub_tcpHandler_removeTopicHandler(receiver->handler, TOPIC_B) < 0);
+}
+
+TEST_GROUP(PubSubTcpHandlerSendQueueTestSuite) {
+    static constexpr size_t NR_OF_MSGS = 256;
+    static constexpr size_t PAYLOAD_SIZE = 64 * 1024;
+    static constexpr size_t MAX_QUEUE_SIZE = 1024 * 1024;
+
+    tcp_peer *sender = nullptr;
+    tcp_peer *receiver = nullptr;
+    std::string url{};
+
+    void setup() {
+        sender = new tcp_peer{};
+        receiver = new tcp_peer{};
+    }
+
+    void teardown() {
+        delete receiver;
+        delete sender;
+    }
+
+    /**
+     * Connects a blocked receiver to a sender with a small send queue using the provided policy.
+     */
+    void connect(pubsub_send_queue_policy_e policy) {
+        pubsub_tcpHandler_setBlockingWrite(sender->handler, false);
+        pubsub_tcpHandler_setSendQueue(sender->handler, policy, MAX_QUEUE_SIZE);
+        for (int port = 38200; port < 38300 && url.empty(); ++port) {
+            std::string candidate = "tcp://127.0.0.1:" + std::to_string(port);
+            if (pubsub_tcpHandler_listen(sender->handler, (char*)candidate.c_str()) >= 0) {
+                url = candidate;
+            }
+        }
+        CHECK(!url.empty());
+        sender->start();
+        receiver->start();
+        CHECK(pubsub_tcpHandler_connect(receiver->handler, (char*)url.c_str()) >= 0);
+        CHECK(sender->waitForConnects(1));
+        receiver->setBlock(true);
+    }
+
+    /**
+     * Writes NR_OF_MSGS msgs, far more than fit in the socket buffers and the send queue. Returns the nr of failed writes.
+     */
+    size_t writeMsgs() {
+        size_t failed = 0;
+        for (uint32_t seqNr = 0; seqNr < NR_OF_MSGS; ++seqNr) {
+            pubsub_tcp_msg_header_t header = createHeader(seqNr);
+            std::vector<unsigned char> payload = createPayload(seqNr, PAYLOAD_SIZE);
+            if (pubsub_tcpHandler_write(sender->handler, &header, payload.data(), (unsigned int)payload.size(), 0) < 0) {
+                ++failed;
+            }
+        }
+        return failed;
+    }
+
+    unsigned long droppedMsgs() {
+        unsigned long queuedBytes = 0;
+        unsigned long maxQueuedBytes = 0;
+        unsigned long dropped = 0;
+        pubsub_tcpHandler_sendQueueMetrics(sender->handler, &queuedBytes, &maxQueuedBytes, &dropped);
+        CHECK(maxQueuedBytes <= MAX_QUEUE_SIZE);
+        return dropped;
+    }
+
+    /**
+     * Unblocks the receiver and waits till it received all msgs which were not dropped.
+     */
+    void receiveRemaining(unsigned long dropped) {
+        receiver->setBlock(false);
+        CHECK(receiver->waitForMsgs(NR_OF_MSGS - dropped));
+        std::this_thread::sleep_for(std::chrono::milliseconds{50});
+    }
+};
+
+TEST(PubSubTcpHandlerSendQueueTestSuite, dropNewest) {
+    connect(PUBSUB_SEND_QUEUE_POLICY_DROP_NEWEST_TYPE);
+
+    //the msgs which do not fit in the queue anymore are dropped and their write fails
+    size_t failed = writeMsgs();
+    unsigned long dropped = droppedMsgs();
+    CHECK(dropped > 0);
+    CHECK_EQUAL(dropped, failed);
+
+    receiveRemaining(dropped);
+    std::lock_guard<std::mutex> lck{receiver->mutex};
+    CHECK_EQUAL(NR_OF_MSGS - dropped, receiver->msgs.size());
+    checkMsgs(receiver->msgs, PAYLOAD_SIZE);
+    CHECK_EQUAL(0, receiver->msgs.front().header.seqNr);
+    CHECK(receiver->msgs.back().header.seqNr < NR_OF_MSGS - 1);
+}
+
+TEST(PubSubTcpHandlerSendQueueTestSuite, dropOldest) {
+    connect(PUBSUB_SEND_QUEUE_POLICY_DROP_OLDEST_TYPE);
+
+    //queued msgs make room for the new msgs, so no write fails
+    CHECK_EQUAL(0, writeMsgs());
+    unsigned long dropped = droppedMsgs();
+    CHECK(dropped > 0);
+
+    //the partially written msg is not dropped, so every received msg is complete and the latest msg is received
+    receiveRemaining(dropped);
+    std::lock_guard<std::mutex> lck{receiver->mutex};
+    CHECK_EQUAL(NR_OF_MSGS - dropped, receiver->msgs.size());
+    checkMsgs(receiver->msgs, PAYLOAD_SIZE);
+    CHECK_EQUAL(NR_OF_MSGS - 1, receiver->msgs.back().header.seqNr);
+}
+
+TEST(PubSubTcpHandlerSendQueueTestSuite, block) {
+    connect(PUBSUB_SEND_QUEUE_POLICY_BLOCK_TYPE);
+    pubsub_tcpHandler_setTimeout(sender->handler, 2000);
+
+    //the writer waits for room in the queue, which is there once the receiver continues
+    std::thread unblock{[this]{
+        std::this_thread::sleep_for(std::chrono::milliseconds{100});
+        receiver->setBlock(false);
+    }};
+    auto start = std::chrono::steady_clock::now();
+    CHECK_EQUAL(0, writeMsgs());
+    auto elapsed = std::chrono::steady_clock::now() - start;
+    unblock.join();
+    pubsub_tcpHandler_setTimeout(sender->handler, 10);
+    CHECK(elapsed >= std::chrono::milliseconds{50});
+    CHECK_EQUAL(0, droppedMsgs());
+
+    receiveRemaining(0);
+    std::lock_guard<std::mutex> lck{receiver->mutex};
+    CHECK_EQUAL(NR_OF_MSGS, receiver->msgs.size());
+    for (size_t i = 0; i < receiver->msgs.size(); ++i) {
+        CHECK_EQUAL(i, receiver->msgs[i].header.seqNr);
+    }
+    checkMsgs(receiver->msgs, PAYLOAD_SIZE);
+}
@@ -19,7 +19,16 @@
 
 #include "celix_api.h"
 #include <unistd.h>
+#include <cstring>
+#include <cstdio>
+#include <ctime>
+#include <string>
+#include <uuid/uuid.h>
 #include "receive_count_service.h"
+#include "pubsub_admin_metrics.h"
+#include "pubsub_utils.h"
+#include "pubsub/publisher.h"
+#include "msg.h"
 
 #include <CppUTest/TestHarness.h>
 #include <CppUTest/CommandLineTestRunner.h>
@@ -68,4 +77,304 @@ TEST(PUBSUB_INT_GROUP, recvTest) {
         usleep(TIMEOUT);
     }
     CHECK(count >= MSG_COUNT);
-}
\ No newline at end of file
+}
+
+TEST(PUBSUB_INT_GROUP, recvTestAllSubscribers) {
+    //every subscriber bundle gets all msgs, also if another subscriber takes over ownership of a (shared) msg
+    constexpr int TRIES = 25;
+    constexpr int TIMEOUT = 250000;
+    constexpr int MSG_COUNT = 100;
+
+    struct counts {
+        size_t nrOfServices;
+        int min;
+    } c{};
+
+    for (int i = 0; i < TRIES; ++i) {
+        c.nrOfServices = 0;
+        c.min = -1;
+        celix_bundleContext_useServices(ctx, CELIX_RECEIVE_COUNT_SERVICE_NAME, &c, [](void *handle, void *svc) {
+            auto* c = static_cast<counts*>(handle);
+            auto* count = static_cast<celix_receive_count_service_t*>(svc);
+            int current = (int)count->receiveCount(count->handle);
+            c->nrOfServices += 1;
+            c->min = c->min < 0 || current < c->min ? current : c->min;
+        });
+        printf("Lowest msg count of %zu subscribers is %i, waiting for at least %i\n", c.nrOfServices, c.min, MSG_COUNT);
+        if (c.min >= MSG_COUNT) {
+            break;
+        }
+        usleep(TIMEOUT);
+    }
+    CHECK(c.nrOfServices >= 1);
+    CHECK(c.min >= MSG_COUNT);
+}
+
+TEST(PUBSUB_INT_GROUP, metricsTest) {
+    //the PSAs with a metrics service stream the send and receive metrics of the ping topic
+    constexpr int TRIES = 25;
+    constexpr int TIMEOUT = 250000;
+
+    struct visit_result {
+        size_t nrOfServices;
+        unsigned long send;
+        unsigned long received;
+        uint64_t timedSends;
+        size_t nrOfMsgEntries;
+    } result{};
+
+    auto visit = [](void *handle, void *svc) {
+        auto *metricsSvc = static_cast<pubsub_admin_metrics_service_t*>(svc);
+        auto *r = static_cast<visit_result*>(handle);
+        r->nrOfServices += 1;
+        metricsSvc->visitMetrics(metricsSvc->handle, nullptr, r, [](void *callbackHandle, const pubsub_metrics_entry_t *entry) {
+            auto *res = static_cast<visit_result*>(callbackHandle);
+            CHECK(entry->psaType != nullptr);
+            if (entry->type == PUBSUB_METRICS_TOPIC_SENDER || strcmp(entry->topic, "ping") != 0) {
+                return;
+            }
+            CHECK(entry->msgFqn != nullptr);
+            if (entry->type == PUBSUB_METRICS_SEND_MSG) {
+                res->send += entry->nrOfMessages;
+                res->timedSends += entry->serializationTime != nullptr ? entry->serializationTime->count : 0;
+            } else {
+                res->received += entry->nrOfMessages;
+            }
+        });
+    };
+
+    for (int i = 0; i < TRIES; ++i) {
+        result = visit_result{};
+        celix_bundleContext_useServices(ctx, PUBSUB_ADMIN_METRICS_SERVICE_NAME, &result, visit);
+        if (result.nrOfServices == 0 || (result.send > 0 && result.received > 0)) {
+            break;
+        }
+        usleep(TIMEOUT);
+    }
+    if (result.nrOfServices == 0) {
+        printf("No pubsub admin metrics service, skipping metrics test\n");
+        return;
+    }
+    printf("Metrics of topic ping: %lu msgs send, %lu msgs received\n", result.send, result.received);
+    CHECK(result.send > 0);
+    CHECK(result.received > 0);
+
+    //with a metrics sample interval (zmq PSA) only 1 in N msgs is timed, the msg counters are always updated
+    long sampleInterval = celix_bundleContext_getPropertyAsLong(ctx, "PSA_ZMQ_METRICS_SAMPLE_INTERVAL", 1);
+    if (sampleInterval > 1) {
+        printf("Metrics of topic ping: %lu of %lu send msgs timed\n", (unsigned long)result.timedSends, result.send);
+        CHECK(result.timedSends <= result.send / (unsigned long)sampleInterval + 2);
+    }
+
+    //with a changedSince in the future only the topic sender entries are visited
+    celix_bundleContext_useServices(ctx, PUBSUB_ADMIN_METRICS_SERVICE_NAME, &result, [](void *handle, void *svc) {
+        auto *metricsSvc = static_cast<pubsub_admin_metrics_service_t*>(svc);
+        struct timespec future{};
+        clock_gettime(CLOCK_REALTIME, &future);
+        future.tv_sec += 3600;
+        metricsSvc->visitMetrics(metricsSvc->handle, &future, handle, [](void *callbackHandle, const pubsub_metrics_entry_t *entry) {
+            auto *r = static_cast<visit_result*>(callbackHandle);
+            if (entry->type != PUBSUB_METRICS_TOPIC_SENDER) {
+                r->nrOfMsgEntries += 1;
+            }
+        });
+    });
+    CHECK_EQUAL(0, result.nrOfMsgEntries);
+}
+
+TEST(PUBSUB_INT_GROUP, receiveMetricsPerOrigin) {
+    //the receive metrics are kept per msg type and binary origin uuid, the ping msgs all come from this framework
+    constexpr int TRIES = 25;
+    constexpr int TIMEOUT = 250000;
+
+    struct origin_result {
+        uuid_t fwUUID;
+        size_t nrOfServices;
+        size_t nrOfEntries;
+        size_t nrOfOtherOrigins;
+        unsigned long received;
+    } result{};
+    const char *fwUUID = celix_bundleContext_getProperty(ctx, OSGI_FRAMEWORK_FRAMEWORK_UUID, nullptr);
+    CHECK(fwUUID != nullptr);
+    CHECK_EQUAL(0, uuid_parse(fwUUID, result.fwUUID));
+
+    for (int i = 0; i < TRIES; ++i) {
+        result.nrOfServices = 0;
+        result.nrOfEntries = 0;
+        result.nrOfOtherOrigins = 0;
+        result.received = 0;
+        celix_bundleContext_useServices(ctx, PUBSUB_ADMIN_METRICS_SERVICE_NAME, &result, [](void *handle, void *svc) {
+            auto *metricsSvc = static_cast<pubsub_admin_metrics_service_t*>(svc);
+            static_cast<origin_result*>(handle)->nrOfServices += 1;
+            metricsSvc->visitMetrics(metricsSvc->handle, nullptr, handle, [](void *callbackHandle, const pubsub_metrics_entry_t *entry) {
+                auto *res = static_cast<origin_result*>(callbackHandle);
+                if (entry->type != PUBSUB_METRICS_RECEIVE_MSG || strcmp(entry->topic, "ping") != 0) {
+                    return;
+                }
+                res->nrOfEntries += 1;
+                res->received += entry->nrOfMessages;
+                if (uuid_compare(entry->originUUID, res->fwUUID) != 0) {
+                    res->nrOfOtherOrigins += 1;
+                }
+            });
+        });
+        if (result.nrOfServices == 0 || result.received >= 100) {
+            break;
+        }
+        usleep(TIMEOUT);
+    }
+    if (result.nrOfServices == 0) {
+        printf("No pubsub admin metrics service, skipping receive metrics test\n");
+        return;
+    }
+    CHECK(result.received >= 100);
+    CHECK(result.nrOfEntries >= 1);
+    CHECK_EQUAL(0, result.nrOfOtherOrigins);
+}
+
+TEST(PUBSUB_INT_GROUP, resubscribeAfterRestart) {
+    //a restarted subscriber is matched again when its subscriber service is added, without waiting for the
+    //(30s) periodic retry of the topology manager
+    constexpr int TRIES = 40;
+    constexpr int TIMEOUT = 250000;
+    constexpr int MSG_COUNT = 10;
+
+    auto minCount = [this]() -> int {
+        int min = -1;
+        celix_bundleContext_useServices(ctx, CELIX_RECEIVE_COUNT_SERVICE_NAME, &min, [](void *handle, void *svc) {
+            auto* m = static_cast<int*>(handle);
+            auto* count = static_cast<celix_receive_count_service_t*>(svc);
+            int current = (int)count->receiveCount(count->handle);
+            *m = *m < 0 || current < *m ? current : *m;
+        });
+        return min;
+    };
+    auto waitForMsgs = [&]() -> bool {
+        for (int i = 0; i < TRIES; ++i) {
+            if (minCount() >= MSG_COUNT) {
+                return true;
+            }
+            usleep(TIMEOUT);
+        }
+        return false;
+    };
+
+    CHECK(waitForMsgs());
+    long tstBndId = -1L;
+    celix_bundleContext_useBundles(ctx, &tstBndId, [](void *handle, const celix_bundle_t *bnd) {
+        if (strcmp(celix_bundle_getSymbolicName(bnd), "pubsub_tst") == 0) {
+            *static_cast<long*>(handle) = celix_bundle_getId(bnd);
+        }
+    });
+    CHECK(tstBndId >= 0);
+
+    CHECK(celix_bundleContext_stopBundle(ctx, tstBndId));
+    CHECK(celix_bundleContext_startBundle(ctx, tstBndId));
+    CHECK(waitForMsgs());
+}
+
+TEST(PUBSUB_INT_GROUP, topicPropertiesCache) {
+    //loaded (and missing) topic properties files are cached, till the cache is cleared
+    long tstBndId = -1L;
+    celix_bundleContext_useBundles(ctx, &tstBndId, [](void *handle, const celix_bundle_t *bnd) {
+        if (strcmp(celix_bundle_getSymbolicName(bnd), "pubsub_tst") == 0) {
+            *static_cast<long*>(handle) = celix_bundle_getId(bnd);
+        }
+    });
+    CHECK(tstBndId >= 0);
+
+    bool called = celix_bundleContext_useBundle(ctx, tstBndId, nullptr, [](void *, const celix_bundle_t *bnd) {
+        char *root = celix_bundle_getEntry(bnd, ".");
+        CHECK(root != nullptr);
+        std::string path = std::string{root} + "/META-INF/topics/sub/cache_test.properties";
+        free(root);
+        auto writeProperties = [&path](const char *value) {
+            FILE *file = fopen(path.c_str(), "w");
+            CHECK(file != nullptr);
+            fprintf(file, "cache.test=%s\n", value);
+            fclose(file);
+        };
+
+        pubsub_utils_clearTopicPropertiesCache();
+        CHECK(pubsub_utils_getTopicProperties(bnd, "cache_test", false) == nullptr);
+        writeProperties("1");
+        CHECK(pubsub_utils_getTopicProperties(bnd, "cache_test", false) == nullptr); //missing file is cached
+
+        pubsub_utils_clearTopicPropertiesCache();
+        celix_properties_t *props = pubsub_utils_getTopicProperties(bnd, "cache_test", false);
+        CHECK(props != nullptr);
+        STRCMP_EQUAL("1", celix_properties_get(props, "cache.test", nullptr));
+        celix_properties_destroy(props);
+
+        //the caller gets its own copy of the cached properties
+        writeProperties("2");
+        props = pubsub_utils_getTopicProperties(bnd, "cache_test", false);
+        CHECK(props != nullptr);
+        STRCMP_EQUAL("1", celix_properties_get(props, "cache.test", nullptr));
+        celix_properties_set(props, "cache.test", "changed");
+        celix_properties_destroy(props);
+        props = pubsub_utils_getTopicProperties(bnd, "cache_test", false);
+        STRCMP_EQUAL("1", celix_properties_get(props, "cache.test", nullptr));
+        celix_properties_destroy(props);
+
+        pubsub_utils_clearTopicPropertiesCache();
+        props = pubsub_utils_getTopicProperties(bnd, "cache_test", false);
+        CHECK(props != nullptr);
+        STRCMP_EQUAL("2", celix_properties_get(props, "cache.test", nullptr));
+        celix_properties_destroy(props);
+
+        remove(path.c_str());
+        pubsub_utils_clearTopicPropertiesCache();
+    });
+    CHECK(called);
+}
+
+TEST(PUBSUB_INT_GROUP, publisherMsgTypeIdLookup) {
+    //the publisher looks up the msg entry of a send or loan by msg type id, unknown msg type ids are rejected
+    long sutBndId = -1L;
+    celix_bundleContext_useBundles(ctx, &sutBndId, [](void *handle, const celix_bundle_t *bnd) {
+        if (strcmp(celix_bundle_getSymbolicName(bnd), "pubsub_sut") == 0) {
+            *static_cast<long*>(handle) = celix_bundle_getId(bnd);
+        }
+    });
+    if (sutBndId < 0) {
+        printf("No pubsub_sut bundle, skipping publisher msg type id test\n");
+        return;
+    }
+
+    //note the msg serializers are created for the requesting bundle, so the publisher is used with the sut context
+    celix_bundle_context_t *sutCtx = nullptr;
+    celix_bundleContext_useBundle(ctx, sutBndId, &sutCtx, [](void *handle, const celix_bundle_t *bnd) {
+        bundle_getContext(const_cast<celix_bundle_t*>(bnd), static_cast<celix_bundle_context_t**>(handle));
+    });
+    CHECK(sutCtx != nullptr);
+
+    char filter[512];
+    snprintf(filter, sizeof(filter), "(%s=%s)", PUBSUB_PUBLISHER_TOPIC, "ping");
+    celix_service_use_options_t opts{};
+    opts.filter.serviceName = PUBSUB_PUBLISHER_SERVICE_NAME;
+    opts.filter.filter = filter;
+    opts.waitTimeoutInSeconds = 5.0;
+    opts.use = [](void *, void *svc) {
+        auto *pub = static_cast<pubsub_publisher_t*>(svc);
+        unsigned int msgId = 0;
+        CHECK_EQUAL(0, pub->localMsgTypeIdForMsgType(pub->handle, MSG_NAME, &msgId));
+        CHECK(msgId != 0);
+        unsigned int unknownId = 42;
+        CHECK_EQUAL(0, pub->localMsgTypeIdForMsgType(pub->handle, "unknown_msg", &unknownId));
+        CHECK_EQUAL(0, unknownId);
+
+        msg_t msg{};
+        const void *msgs[] = {&msg};
+        for (unsigned int id : {0u, msgId + 1u}) {
+            CHECK(pub->send(pub->handle, id, &msg) != CELIX_SUCCESS);
+            if (pub->sendMany != nullptr) {
+                CHECK(pub->sendMany(pub->handle, id, msgs, 1) != CELIX_SUCCESS);
+            }
+            if (pub->loanMsg != nullptr) {
+                CHECK(pub->loanMsg(pub->handle, id) == nullptr);
+            }
+        }
+    };
+    CHECK(celix_bundleContext_useServiceWithOptions(sutCtx, &opts));
+}
@@ -0,0 +1,173 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *  KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "celix_api.h"
+#include "celix_framework_factory.h"
+extern "C" {
+#include "pubsub_admin.h"
+#include "pubsub_topology_manager.h"
+}
+
+#include <CppUTest/TestHarness.h>
+
+namespace {
+    /**
+     * Fake psa which matches all discovered endpoints and records the added and removed endpoint uuids.
+     */
+    struct fake_psa {
+        std::mutex mutex{};
+        std::condition_variable cond{};
+        std::vector<std::string> added{};
+        std::vector<std::string> removed{};
+
+        static celix_status_t match(void */*handle*/, const celix_properties_t */*endpoint*/, bool *match) {
+            *match = true;
+            return CELIX_SUCCESS;
+        }
+
+        static celix_status_t add(void *handle, const celix_properties_t *endpoint) {
+            auto *psa = static_cast<fake_psa*>(handle);
+            std::lock_guard<std::mutex> lck{psa->mutex};
+            psa->added.emplace_back(celix_properties_get(endpoint, PUBSUB_ENDPOINT_UUID, ""));
+            psa->cond.notify_all();
+            return CELIX_SUCCESS;
+        }
+
+        static celix_status_t remove(void *handle, const celix_properties_t *endpoint) {
+            auto *psa = static_cast<fake_psa*>(handle);
+            std::lock_guard<std::mutex> lck{psa->mutex};
+            psa->removed.emplace_back(celix_properties_get(endpoint, PUBSUB_ENDPOINT_UUID, ""));
+            return CELIX_SUCCESS;
+        }
+
+        bool waitForAdded(size_t count) {
+            std::unique_lock<std::mutex> lck{mutex};
+            return cond.wait_for(lck, std::chrono::seconds{5}, [&]{ return added.size() >= count; });
+        }
+    };
+
+    celix_properties_t* createEndpoint(const char *uuid) {
+        celix_properties_t *endpoint = celix_properties_create();
+        celix_properties_set(endpoint, PUBSUB_ENDPOINT_UUID, uuid);
+        celix_properties_set(endpoint, PUBSUB_ENDPOINT_TOPIC_NAME, "topic");
+        celix_properties_set(endpoint, PUBSUB_ENDPOINT_TOPIC_SCOPE, "scope");
+        celix_properties_set(endpoint, PUBSUB_ENDPOINT_FRAMEWORK_UUID, "fw-uuid");
+        return endpoint;
+    }
+}
+
+TEST_GROUP(PubSubTopologyManagerTestSuite) {
+    celix_framework_t *fw = nullptr;
+    log_helper_t *logHelper = nullptr;
+    pubsub_topology_manager_t *manager = nullptr;
+    fake_psa psa{};
+    pubsub_admin_service_t psaSvc{};
+    celix_properties_t *psaProps = nullptr;
+    long psaSvcId = -1L;
+
+    void setup() {
+        celix_properties_t *properties = celix_properties_create();
+        celix_properties_set(properties, "LOGHELPER_ENABLE_STDOUT_FALLBACK", "true");
+        celix_properties_set(properties, "org.osgi.framework.storage.clean", "onFirstInit");
+        celix_properties_set(properties, "org.osgi.framework.storage", ".cacheTopologyManagerTestFramework");
+        fw = celix_frameworkFactory_createFramework(properties);
+        celix_bundle_context_t *ctx = celix_framework_getFrameworkContext(fw);
+        logHelper_create(ctx, &logHelper);
+        logHelper_start(logHelper);
+        CHECK_EQUAL(CELIX_SUCCESS, pubsub_topologyManager_create(ctx, logHelper, &manager));
+
+        psaSvc.handle = &psa;
+        psaSvc.matchDiscoveredEndpoint = fake_psa::match;
+        psaSvc.addDiscoveredEndpoint = fake_psa::add;
+        psaSvc.removeDiscoveredEndpoint = fake_psa::remove;
+        psaSvcId = celix_bundleContext_registerService(ctx, &psaSvc, PUBSUB_ADMIN_SERVICE_NAME, nullptr);
+        //note the psa tracker of the activator is not used, the psa is added directly
+        psaProps = celix_properties_create();
+        celix_properties_setLong(psaProps, OSGI_FRAMEWORK_SERVICE_ID, psaSvcId);
+        pubsub_topologyManager_psaAdded(manager, &psaSvc, psaProps);
+    }
+
+    void teardown() {
+        pubsub_topologyManager_psaRemoved(manager, &psaSvc, psaProps);
+        celix_properties_destroy(psaProps);
+        celix_bundleContext_unregisterService(celix_framework_getFrameworkContext(fw), psaSvcId);
+        pubsub_topologyManager_destroy(manager);
+        logHelper_stop(logHelper);
+        logHelper_destroy(&logHelper);
+        celix_frameworkFactory_destroyFramework(fw);
+    }
+};
+
+TEST(PubSubTopologyManagerTestSuite, addAndRemoveDiscoveredEndpoints) {
+    celix_properties_t *ep1 = createEndpoint("ep1");
+    celix_properties_t *ep2 = createEndpoint("ep2");
+    celix_properties_t *ep3 = createEndpoint("ep3");
+
+    //a batch can contain the same endpoint more than once (e.g. discovered through several frameworks)
+    const celix_properties_t *batch[] = {ep1, ep2, ep1, ep3};
+    CHECK_EQUAL(CELIX_SUCCESS, pubsub_topologyManager_addDiscoveredEndpoints(manager, batch, 4));
+    CHECK(psa.waitForAdded(3));
+    {
+        std::lock_guard<std::mutex> lck{psa.mutex};
+        CHECK_EQUAL(3, psa.added.size());
+        CHECK(std::find(psa.added.begin(), psa.added.end(), "ep1") != psa.added.end());
+        CHECK(std::find(psa.added.begin(), psa.added.end(), "ep2") != psa.added.end());
+        CHECK(std::find(psa.added.begin(), psa.added.end(), "ep3") != psa.added.end());
+    }
+
+    //ep1 is still used once, the others are removed from the psa
+    const celix_properties_t *removeBatch[] = {ep1, ep2, ep3};
+    CHECK_EQUAL(CELIX_SUCCESS, pubsub_topologyManager_removeDiscoveredEndpoints(manager, removeBatch, 3));
+    {
+        std::lock_guard<std::mutex> lck{psa.mutex};
+        CHECK_EQUAL(2, psa.removed.size());
+        CHECK(std::find(psa.removed.begin(), psa.removed.end(), "ep2") != psa.removed.end());
+        CHECK(std::find(psa.removed.begin(), psa.removed.end(), "ep3") != psa.removed.end());
+    }
+
+    //the single endpoint calls use the same usage count
+    CHECK_EQUAL(CELIX_SUCCESS, pubsub_topologyManager_removeDiscoveredEndpoint(manager, ep1));
+    CHECK_EQUAL(CELIX_SUCCESS, pubsub_topologyManager_removeDiscoveredEndpoint(manager, ep1)); //not discovered anymore
+    {
+        std::lock_guard<std::mutex> lck{psa.mutex};
+        CHECK_EQUAL(3, psa.removed.size());
+        STRCMP_EQUAL("ep1", psa.removed.back().c_str());
+    }
+    CHECK_EQUAL(CELIX_SUCCESS, pubsub_topologyManager_addDiscoveredEndpoint(manager, ep1));
+    CHECK(psa.waitForAdded(4));
+
+    celix_properties_destroy(ep1);
+    celix_properties_destroy(ep2);
+    celix_properties_destroy(ep3);
+}
+
+TEST(PubSubTopologyManagerTestSuite, emptyBatch) {
+    CHECK_EQUAL(CELIX_SUCCESS, pubsub_topologyManager_addDiscoveredEndpoints(manager, nullptr, 0));
+    CHECK_EQUAL(CELIX_SUCCESS, pubsub_topologyManager_removeDiscoveredEndpoints(manager, nullptr, 0));
+    std::lock_guard<std::mutex> lck{psa.mutex};
+    CHECK(psa.added.empty());
+    CHECK(psa.removed.empty());
+}
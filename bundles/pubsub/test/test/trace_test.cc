@@ -0,0 +1,165 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *  KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <unistd.h>
+
+#include "celix_api.h"
+#include "celix_framework_factory.h"
+extern "C" {
+#include "pubsub_trace.h"
+}
+
+#include <CppUTest/TestHarness.h>
+
+namespace {
+    const char *TRACE_FILE = "trace_test_spans.json";
+
+    std::vector<std::string> readSpans() {
+        std::vector<std::string> lines{};
+        std::ifstream in{TRACE_FILE};
+        std::string line;
+        while (std::getline(in, line)) {
+            lines.push_back(line);
+        }
+        return lines;
+    }
+
+    std::string hex(const uint8_t *id, size_t size) {
+        std::string result{};
+        char buf[3];
+        for (size_t i = 0; i < size; ++i) {
+            snprintf(buf, sizeof(buf), "%02x", id[i]);
+            result += buf;
+        }
+        return result;
+    }
+
+    bool isZero(const uint8_t *id, size_t size) {
+        for (size_t i = 0; i < size; ++i) {
+            if (id[i] != 0) {
+                return false;
+            }
+        }
+        return true;
+    }
+}
+
+TEST_GROUP(PubSubTraceTestSuite) {
+    celix_framework_t *fw = nullptr;
+    celix_bundle_context_t *ctx = nullptr;
+
+    void createFramework(const char *enabled, const char *sampleInterval) {
+        celix_properties_t *props = celix_properties_create();
+        celix_properties_set(props, "LOGHELPER_ENABLE_STDOUT_FALLBACK", "true");
+        celix_properties_set(props, "org.osgi.framework.storage.clean", "onFirstInit");
+        celix_properties_set(props, "org.osgi.framework.storage", ".cacheTraceTest");
+        celix_properties_set(props, PUBSUB_TRACE_ENABLED_KEY, enabled);
+        celix_properties_set(props, PUBSUB_TRACE_FILE_KEY, TRACE_FILE);
+        celix_properties_set(props, PUBSUB_TRACE_SAMPLE_INTERVAL_KEY, sampleInterval);
+        fw = celix_frameworkFactory_createFramework(props);
+        ctx = celix_framework_getFrameworkContext(fw);
+    }
+
+    void teardown() {
+        if (fw != nullptr) {
+            celix_frameworkFactory_destroyFramework(fw);
+        }
+        unlink(TRACE_FILE);
+    }
+};
+
+TEST(PubSubTraceTestSuite, disabledByDefault) {
+    createFramework("false", "1");
+    pubsub_tracer_t *tracer = pubsub_tracer_create(ctx, "tcp", nullptr, "topic");
+    CHECK(tracer == nullptr);
+    CHECK_FALSE(pubsub_tracer_sample(tracer));
+    pubsub_tracer_destroy(tracer);
+}
+
+TEST(PubSubTraceTestSuite, sampleInterval) {
+    createFramework("true", "3");
+    pubsub_tracer_t *tracer = pubsub_tracer_create(ctx, "tcp", nullptr, "topic");
+    CHECK(tracer != nullptr);
+    for (int i = 0; i < 9; ++i) {
+        CHECK_EQUAL(i % 3 == 0, pubsub_tracer_sample(tracer));
+    }
+    pubsub_tracer_destroy(tracer);
+}
+
+TEST(PubSubTraceTestSuite, sendAndReceiveSpans) {
+    createFramework("true", "1");
+    pubsub_tracer_t *sender = pubsub_tracer_create(ctx, "tcp", "scope", "topic");
+    pubsub_tracer_t *receiver = pubsub_tracer_create(ctx, "tcp", "scope", "topic");
+    CHECK(sender != nullptr);
+    CHECK(receiver != nullptr);
+
+    pubsub_trace_context_t sendCtx{};
+    pubsub_tracer_initContext(sender, &sendCtx);
+    CHECK_FALSE(isZero(sendCtx.traceId, sizeof(sendCtx.traceId)));
+    CHECK_FALSE(isZero(sendCtx.spanId, sizeof(sendCtx.spanId)));
+    CHECK(isZero(sendCtx.parentSpanId, sizeof(sendCtx.parentSpanId)));
+    sendCtx.serializeStart = pubsub_trace_now();
+    sendCtx.serializeEnd = sendCtx.serializeStart + 10;
+    sendCtx.enqueueTime = sendCtx.serializeStart + 20;
+    pubsub_tracer_exportSendSpan(sender, "msg", &sendCtx, sendCtx.serializeStart + 30);
+
+    struct timespec receiveTime{};
+    clock_gettime(CLOCK_REALTIME, &receiveTime);
+    pubsub_trace_receive_span_t span{};
+    pubsub_tracer_beginReceiveSpan(receiver, &sendCtx, &receiveTime, &span);
+    CHECK(memcmp(sendCtx.traceId, span.traceId, sizeof(span.traceId)) == 0);
+    CHECK(memcmp(sendCtx.spanId, span.parentSpanId, sizeof(span.parentSpanId)) == 0);
+
+    //a msg published from the subscriber callback continues the trace and is always sampled
+    CHECK(pubsub_tracer_sample(sender));
+    CHECK(pubsub_tracer_sample(sender));
+    pubsub_trace_context_t nextCtx{};
+    pubsub_tracer_initContext(sender, &nextCtx);
+    CHECK(memcmp(sendCtx.traceId, nextCtx.traceId, sizeof(nextCtx.traceId)) == 0);
+    CHECK(memcmp(span.spanId, nextCtx.parentSpanId, sizeof(nextCtx.parentSpanId)) == 0);
+    CHECK(memcmp(sendCtx.spanId, nextCtx.spanId, sizeof(nextCtx.spanId)) != 0);
+
+    span.callbackEnd = pubsub_trace_now();
+    pubsub_tracer_endReceiveSpan(receiver, "msg", &span);
+
+    //after the callback a new trace is started
+    pubsub_trace_context_t newCtx{};
+    pubsub_tracer_initContext(sender, &newCtx);
+    CHECK(memcmp(sendCtx.traceId, newCtx.traceId, sizeof(newCtx.traceId)) != 0);
+    CHECK(isZero(newCtx.parentSpanId, sizeof(newCtx.parentSpanId)));
+
+    std::vector<std::string> spans = readSpans();
+    CHECK_EQUAL(2, (int)spans.size());
+    std::string traceId = "\"traceId\":\"" + hex(sendCtx.traceId, sizeof(sendCtx.traceId)) + "\"";
+    CHECK(spans[0].find(traceId) != std::string::npos);
+    CHECK(spans[0].find("\"name\":\"topic send\"") != std::string::npos);
+    CHECK(spans[0].find("\"parentSpanId\":\"\"") != std::string::npos);
+    CHECK(spans[0].find("\"name\":\"enqueued\"") != std::string::npos);
+    CHECK(spans[1].find(traceId) != std::string::npos);
+    CHECK(spans[1].find("\"name\":\"topic receive\"") != std::string::npos);
+    CHECK(spans[1].find("\"parentSpanId\":\"" + hex(sendCtx.spanId, sizeof(sendCtx.spanId)) + "\"") != std::string::npos);
+    CHECK(spans[1].find("\"stringValue\":\"scope\"") != std::string::npos);
+
+    pubsub_tracer_destroy(sender);
+    pubsub_tracer_destroy(receiver);
+}
@@ -0,0 +1,83 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *  KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <chrono>
+#include <vector>
+#include <unistd.h>
+#include <arpa/inet.h>
+
+extern "C" {
+#include "large_udp.h"
+#include "pubsub_udpmc_common.h"
+}
+
+#include <CppUTest/TestHarness.h>
+
+TEST_GROUP(UdpmcBusyPollTestSuite) {
+};
+
+TEST(UdpmcBusyPollTestSuite, listedInterfaces) {
+    CHECK(psa_udpmc_isListedInterface("eth0", "eth0", "192.168.1.2"));
+    CHECK(psa_udpmc_isListedInterface("lo, eth0", "eth0", "192.168.1.2"));
+    CHECK(psa_udpmc_isListedInterface("lo,192.168.1.2", nullptr, "192.168.1.2"));
+    CHECK(psa_udpmc_isListedInterface("lo 192.168.1.2", "eth0", "192.168.1.2"));
+    CHECK(!psa_udpmc_isListedInterface("eth1", "eth0", "192.168.1.2"));
+    CHECK(!psa_udpmc_isListedInterface("eth", "eth0", "192.168.1.2")); //no prefix match
+    CHECK(!psa_udpmc_isListedInterface("", "eth0", "192.168.1.2"));
+    CHECK(!psa_udpmc_isListedInterface("eth0", nullptr, nullptr));
+}
+
+TEST(UdpmcBusyPollTestSuite, spinningReceive) {
+    largeUdp_t *sendHandle = largeUdp_create(1);
+    largeUdp_t *recvHandle = largeUdp_create(8);
+    int sendFd = socket(AF_INET, SOCK_DGRAM, 0);
+    int recvFd = socket(AF_INET, SOCK_DGRAM, 0);
+    struct sockaddr_in dest{};
+    dest.sin_family = AF_INET;
+    dest.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    CHECK_EQUAL(0, bind(recvFd, (struct sockaddr*)&dest, sizeof(dest)));
+    socklen_t len = sizeof(dest);
+    CHECK_EQUAL(0, getsockname(recvFd, (struct sockaddr*)&dest, &len));
+
+    //busy polling reads without waiting in epoll_wait, so a receive without data must return immediately
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < 1000; ++i) {
+        CHECK_EQUAL(0, largeUdp_receive(recvHandle, recvFd));
+    }
+    CHECK(std::chrono::steady_clock::now() - start < std::chrono::seconds{1});
+
+    std::vector<char> msg(1000, 'x');
+    CHECK(largeUdp_sendto(sendHandle, sendFd, msg.data(), msg.size(), 0, &dest, sizeof(dest)) > 0);
+    int completed = 0;
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds{5};
+    while (completed == 0 && std::chrono::steady_clock::now() < deadline) {
+        completed = largeUdp_receive(recvHandle, recvFd);
+    }
+    CHECK_EQUAL(1, completed);
+    void *buffer = nullptr;
+    unsigned int size = 0;
+    CHECK(largeUdp_readNext(recvHandle, &buffer, &size, nullptr));
+    CHECK_EQUAL(msg.size(), size);
+    free(buffer);
+
+    close(sendFd);
+    close(recvFd);
+    largeUdp_destroy(sendHandle);
+    largeUdp_destroy(recvHandle);
+}
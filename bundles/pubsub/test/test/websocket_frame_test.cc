@@ -0,0 +1,104 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *  KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <cstdlib>
+#include <cstring>
+
+extern "C" {
+#include "pubsub_websocket_common.h"
+}
+
+#include <CppUTest/TestHarness.h>
+
+TEST_GROUP(PubSubWebsocketFrameTestSuite) {
+    pubsub_websocket_msg_header_t hdr{};
+
+    void setup() {
+        hdr.id = "org.example.Msg";
+        hdr.major = 1;
+        hdr.minor = 2;
+        hdr.seqNr = 0x01020304;
+    }
+};
+
+TEST(PubSubWebsocketFrameTestSuite, encodeAndDecode) {
+    const char payload[] = {0, 1, 2, 3, (char)0xff};
+    size_t frameSize = 0;
+    char *frame = psa_websocket_encodeBinaryFrame(&hdr, payload, sizeof(payload), &frameSize);
+    CHECK(frame != nullptr);
+    CHECK_EQUAL(PSA_WEBSOCKET_BINARY_HEADER_SIZE + strlen(hdr.id) + 1 + sizeof(payload), frameSize);
+
+    //the seqNr is in network byte order
+    CHECK_EQUAL(1, frame[4]);
+    CHECK_EQUAL(4, frame[7]);
+
+    pubsub_websocket_msg_header_t decoded{};
+    const char *decodedPayload = nullptr;
+    size_t decodedPayloadSize = 0;
+    CHECK(psa_websocket_decodeBinaryFrame(frame, frameSize, &decoded, &decodedPayload, &decodedPayloadSize));
+    STRCMP_EQUAL(hdr.id, decoded.id);
+    CHECK_EQUAL(1, decoded.major);
+    CHECK_EQUAL(2, decoded.minor);
+    CHECK_EQUAL(hdr.seqNr, decoded.seqNr);
+    CHECK_EQUAL(sizeof(payload), decodedPayloadSize);
+    CHECK(memcmp(payload, decodedPayload, sizeof(payload)) == 0);
+    free(frame);
+}
+
+TEST(PubSubWebsocketFrameTestSuite, emptyPayload) {
+    size_t frameSize = 0;
+    char *frame = psa_websocket_encodeBinaryFrame(&hdr, nullptr, 0, &frameSize);
+    CHECK(frame != nullptr);
+
+    pubsub_websocket_msg_header_t decoded{};
+    const char *decodedPayload = nullptr;
+    size_t decodedPayloadSize = 1;
+    CHECK(psa_websocket_decodeBinaryFrame(frame, frameSize, &decoded, &decodedPayload, &decodedPayloadSize));
+    STRCMP_EQUAL(hdr.id, decoded.id);
+    CHECK_EQUAL(0, decodedPayloadSize);
+    free(frame);
+}
+
+TEST(PubSubWebsocketFrameTestSuite, malformedFramesRejected) {
+    const char payload[] = {1, 2, 3};
+    size_t frameSize = 0;
+    char *frame = psa_websocket_encodeBinaryFrame(&hdr, payload, sizeof(payload), &frameSize);
+    CHECK(frame != nullptr);
+
+    pubsub_websocket_msg_header_t decoded{};
+    const char *decodedPayload = nullptr;
+    size_t decodedPayloadSize = 0;
+
+    //shorter than the fixed header
+    CHECK_FALSE(psa_websocket_decodeBinaryFrame(frame, PSA_WEBSOCKET_BINARY_HEADER_SIZE - 1, &decoded, &decodedPayload, &decodedPayloadSize));
+    //truncated msg fqn
+    CHECK_FALSE(psa_websocket_decodeBinaryFrame(frame, PSA_WEBSOCKET_BINARY_HEADER_SIZE + 4, &decoded, &decodedPayload, &decodedPayloadSize));
+
+    //msg fqn not '\0' terminated
+    size_t idSize = strlen(hdr.id) + 1;
+    frame[PSA_WEBSOCKET_BINARY_HEADER_SIZE + idSize - 1] = 'x';
+    CHECK_FALSE(psa_websocket_decodeBinaryFrame(frame, frameSize, &decoded, &decodedPayload, &decodedPayloadSize));
+    frame[PSA_WEBSOCKET_BINARY_HEADER_SIZE + idSize - 1] = '\0';
+
+    //empty id size
+    frame[2] = 0;
+    frame[3] = 0;
+    CHECK_FALSE(psa_websocket_decodeBinaryFrame(frame, frameSize, &decoded, &decodedPayload, &decodedPayloadSize));
+    free(frame);
+}
@@ -0,0 +1,158 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *  KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <openssl/evp.h>
+
+extern "C" {
+#include "zmq_crypto.h"
+}
+
+#include <CppUTest/TestHarness.h>
+
+namespace {
+    const char *KEYS_DIR = ".";
+    const char *KEYS_FILE = "zmq_crypto_test.keys";
+    const char *CERT_FILE = "./zmq_crypto_test.cert";
+
+    void writeFile(const std::string &path, const std::string &content, time_t mtime) {
+        FILE *f = fopen(path.c_str(), "w");
+        CHECK(f != nullptr);
+        fwrite(content.data(), 1, content.size(), f);
+        fclose(f);
+        //explicit mtimes, so that rewrites are detected regardless of the timestamp granularity of the filesystem
+        struct timespec times[2] = {{mtime, 0}, {mtime, 0}};
+        CHECK_EQUAL(0, utimensat(AT_FDCWD, path.c_str(), times, 0));
+    }
+
+    void writeKeysFile(const char *key, const char *iv, time_t mtime) {
+        writeFile(std::string{KEYS_DIR} + "/" + KEYS_FILE, std::string{"aes_key:"} + key + "\naes_iv:" + iv + "\n", mtime);
+    }
+
+    //encrypts the cert the same way as the pubsub keygen (ed_file) does
+    void writeCertFile(zcert_t *cert, const char *key, const char *iv, time_t mtime) {
+        std::string text = std::string{"curve\n"} +
+                "    public-key = \"" + zcert_public_txt(cert) + "\"\n" +
+                "    secret-key = \"" + zcert_secret_txt(cert) + "\"\n";
+        unsigned char keyDigest[EVP_MAX_MD_SIZE];
+        unsigned char ivDigest[EVP_MAX_MD_SIZE];
+        generate_sha256_hash((char*)key, keyDigest);
+        generate_sha256_hash((char*)iv, ivDigest);
+
+        std::vector<unsigned char> encrypted(text.size() + EVP_MAX_BLOCK_LENGTH);
+        int len = 0;
+        int total = 0;
+        EVP_CIPHER_CTX *ctx = EVP_CIPHER_CTX_new();
+        EVP_EncryptInit_ex(ctx, EVP_aes_256_cbc(), nullptr, keyDigest, ivDigest);
+        EVP_EncryptUpdate(ctx, encrypted.data(), &len, (const unsigned char*)text.data(), (int)text.size());
+        total = len;
+        EVP_EncryptFinal_ex(ctx, encrypted.data() + total, &len);
+        total += len;
+        EVP_CIPHER_CTX_free(ctx);
+        writeFile(CERT_FILE, std::string{(const char*)encrypted.data(), (size_t)total}, mtime);
+    }
+
+    zcert_t* load() {
+        return get_zcert_from_encoded_file((char*)KEYS_DIR, (char*)KEYS_FILE, (char*)CERT_FILE);
+    }
+}
+
+TEST_GROUP(ZmqCryptoTestSuite) {
+    const char *key = "0123456789abcdef0123456789abcdef";
+    const char *iv = "0123456789abcdef";
+    zcert_t *cert = nullptr;
+
+    void setup() {
+        cert = zcert_new();
+        writeKeysFile(key, iv, 1000);
+        writeCertFile(cert, key, iv, 1000);
+    }
+
+    void teardown() {
+        zmq_crypto_clearCache();
+        zcert_destroy(&cert);
+        unlink((std::string{KEYS_DIR} + "/" + KEYS_FILE).c_str());
+        unlink(CERT_FILE);
+    }
+};
+
+TEST(ZmqCryptoTestSuite, missingFiles) {
+    CHECK(get_zcert_from_encoded_file((char*)KEYS_DIR, (char*)"missing.keys", (char*)CERT_FILE) == nullptr);
+    CHECK(get_zcert_from_encoded_file((char*)KEYS_DIR, (char*)KEYS_FILE, (char*)"./missing.cert") == nullptr);
+}
+
+TEST(ZmqCryptoTestSuite, cachedCertIsCopied) {
+    zcert_t *first = load();
+    CHECK(first != nullptr);
+    STRCMP_EQUAL(zcert_public_txt(cert), zcert_public_txt(first));
+    STRCMP_EQUAL(zcert_secret_txt(cert), zcert_secret_txt(first));
+
+    //the caller owns the returned cert, destroying it does not affect the cache
+    zcert_t *second = load();
+    CHECK(second != nullptr);
+    CHECK(first != second);
+    zcert_destroy(&first);
+    STRCMP_EQUAL(zcert_public_txt(cert), zcert_public_txt(second));
+    zcert_destroy(&second);
+
+    zcert_t *third = load();
+    CHECK(third != nullptr);
+    STRCMP_EQUAL(zcert_public_txt(cert), zcert_public_txt(third));
+    zcert_destroy(&third);
+}
+
+TEST(ZmqCryptoTestSuite, changedCertFileIsDecryptedAgain) {
+    zcert_t *first = load();
+    CHECK(first != nullptr);
+
+    zcert_t *newCert = zcert_new();
+    writeCertFile(newCert, key, iv, 2000);
+    zcert_t *second = load();
+    CHECK(second != nullptr);
+    STRCMP_EQUAL(zcert_public_txt(newCert), zcert_public_txt(second));
+
+    zcert_destroy(&first);
+    zcert_destroy(&second);
+    zcert_destroy(&newCert);
+}
+
+TEST(ZmqCryptoTestSuite, changedKeysFileDropsCachedCerts) {
+    zcert_t *first = load();
+    CHECK(first != nullptr);
+    zcert_destroy(&first);
+
+    //the cert file is unchanged, but is not decryptable with the new keys
+    const char *otherKey = "fedcba9876543210fedcba9876543210";
+    const char *otherIv = "fedcba9876543210";
+    writeKeysFile(otherKey, otherIv, 2000);
+    CHECK(load() == nullptr);
+
+    writeCertFile(cert, otherKey, otherIv, 2000);
+    zcert_t *second = load();
+    CHECK(second != nullptr);
+    STRCMP_EQUAL(zcert_public_txt(cert), zcert_public_txt(second));
+    zcert_destroy(&second);
+}
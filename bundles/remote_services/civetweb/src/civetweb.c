@@ -699,7 +699,7 @@ enum {
     GLOBAL_PASSWORDS_FILE, INDEX_FILES, ENABLE_KEEP_ALIVE, ACCESS_CONTROL_LIST,
     EXTRA_MIME_TYPES, LISTENING_PORTS, DOCUMENT_ROOT, SSL_CERTIFICATE,
     NUM_THREADS, RUN_AS_USER, REWRITE, HIDE_FILES, REQUEST_TIMEOUT,
-    DECODE_URL,
+    DECODE_URL, CONNECTION_QUEUE,
 
 #if defined(USE_LUA)
     LUA_PRELOAD_FILE, LUA_SCRIPT_EXTENSIONS, LUA_SERVER_PAGE_EXTENSIONS,
@@ -747,6 +747,7 @@ static struct mg_option config_options[] = {
     {"hide_files_patterns",         CONFIG_TYPE_EXT_PATTERN,   NULL},
     {"request_timeout_ms",          CONFIG_TYPE_NUMBER,        "30000"},
     {"decode_url",                  CONFIG_TYPE_BOOLEAN,       "yes"},
+    {"connection_queue",            CONFIG_TYPE_NUMBER,        "20"},
 
 #if defined(USE_LUA)
     {"lua_preload_file",            CONFIG_TYPE_FILE,          NULL},
@@ -790,7 +791,8 @@ struct mg_context {
     pthread_mutex_t thread_mutex;   /* Protects (max|num)_threads */
     pthread_cond_t thread_cond;     /* Condvar for tracking workers terminations */
 
-    struct socket queue[MGSQLEN];   /* Accepted sockets */
+    struct socket *queue;           /* Accepted sockets */
+    int sq_size;                    /* Capacity of the socket queue */
     volatile int sq_head;           /* Head of the socket queue */
     volatile int sq_tail;           /* Tail of the socket queue */
     pthread_cond_t sq_full;         /* Signaled when socket is produced */
@@ -7316,14 +7318,14 @@ static int consume_socket(struct mg_context *ctx, struct socket *sp)
     /* If we're stopping, sq_head may be equal to sq_tail. */
     if (ctx->sq_head > ctx->sq_tail) {
         /* Copy socket from the queue and increment tail */
-        *sp = ctx->queue[ctx->sq_tail % ARRAY_SIZE(ctx->queue)];
+        *sp = ctx->queue[ctx->sq_tail % ctx->sq_size];
         ctx->sq_tail++;
         DEBUG_TRACE("grabbed socket %d, going busy", sp->sock);
 
         /* Wrap pointers if needed */
-        while (ctx->sq_tail > (int) ARRAY_SIZE(ctx->queue)) {
-            ctx->sq_tail -= ARRAY_SIZE(ctx->queue);
-            ctx->sq_head -= ARRAY_SIZE(ctx->queue);
+        while (ctx->sq_tail > ctx->sq_size) {
+            ctx->sq_tail -= ctx->sq_size;
+            ctx->sq_head -= ctx->sq_size;
         }
     }
 
@@ -7430,13 +7432,13 @@ static void produce_socket(struct mg_context *ctx, const struct socket *sp)
 
     /* If the queue is full, wait */
     while (ctx->stop_flag == 0 &&
-           ctx->sq_head - ctx->sq_tail >= (int) ARRAY_SIZE(ctx->queue)) {
+           ctx->sq_head - ctx->sq_tail >= ctx->sq_size) {
         (void) pthread_cond_wait(&ctx->sq_empty, &ctx->thread_mutex);
     }
 
-    if (ctx->sq_head - ctx->sq_tail < (int) ARRAY_SIZE(ctx->queue)) {
+    if (ctx->sq_head - ctx->sq_tail < ctx->sq_size) {
         /* Copy socket to the queue and increment head */
-        ctx->queue[ctx->sq_head % ARRAY_SIZE(ctx->queue)] = *sp;
+        ctx->queue[ctx->sq_head % ctx->sq_size] = *sp;
         ctx->sq_head++;
         DEBUG_TRACE("queued socket %d", sp->sock);
     }
@@ -7631,6 +7633,8 @@ static void free_context(struct mg_context *ctx)
     /* Destroy other context global data structures mutex */
     (void) pthread_mutex_destroy(&ctx->nonce_mutex);
 
+    mg_free(ctx->queue);
+
 #if defined(USE_TIMERS)
     timers_exit(ctx);
 #endif
@@ -7846,6 +7850,18 @@ struct mg_context *mg_start(const struct mg_callbacks *callbacks,
     (void) signal(SIGPIPE, SIG_IGN);
 #endif /* !_WIN32 && !__SYMBIAN32__ */
 
+    /* Accepted sockets wait in this queue for a free worker thread, when it is full the master thread stops accepting */
+    ctx->sq_size = atoi(ctx->config[CONNECTION_QUEUE]);
+    if (ctx->sq_size <= 0) {
+        ctx->sq_size = MGSQLEN;
+    }
+    ctx->queue = (struct socket *)mg_calloc(ctx->sq_size, sizeof(struct socket));
+    if (ctx->queue == NULL) {
+        mg_cry(fc(ctx), "Not enough memory for socket queue");
+        free_context(ctx);
+        return NULL;
+    }
+
     workerthreadcount = atoi(ctx->config[NUM_THREADS]);
 
     if (workerthreadcount > MAX_WORKER_THREADS) {
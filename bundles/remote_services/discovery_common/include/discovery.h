@@ -45,6 +45,19 @@
 #define DISCOVERY_SERVER_PATH       "DISCOVERY_CFG_SERVER_PATH"
 #define DISCOVERY_POLL_ENDPOINTS    "DISCOVERY_CFG_POLL_ENDPOINTS"
 #define DISCOVERY_SERVER_MAX_EP     "DISCOVERY_CFG_SERVER_MAX_EP"
+#define DISCOVERY_SERVER_THREADS    "DISCOVERY_CFG_SERVER_THREADS"
+#define DISCOVERY_SERVER_COMPRESS   "DISCOVERY_CFG_SERVER_COMPRESS" // gzip the endpoint lists for pollers accepting it, default true
+
+/*
+ * Versioned endpoint lists. The discovery server reports the version of its endpoint list as ETag. A request with
+ * the since parameter set to a reported version is answered with only the changes since that version (a delta), or
+ * with 304 if nothing changed within the optional wait parameter (ms). The removed endpoint ids of a delta are
+ * listed in the removed header.
+ */
+#define DISCOVERY_SINCE_PARAM       "since"
+#define DISCOVERY_WAIT_PARAM        "wait"
+#define DISCOVERY_DELTA_HEADER      "X-Celix-Discovery-Delta"
+#define DISCOVERY_REMOVED_HEADER    "X-Celix-Discovery-Removed"
 
 struct discovery {
     celix_bundle_context_t *context;
@@ -0,0 +1,57 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *  KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+/**
+ * endpoint_descriptor_binary.h
+ *
+ *  \author     <a href="mailto:dev@celix.apache.org">Apache Celix Project Team</a>
+ *  \copyright  Apache License, Version 2.0
+ */
+
+#ifndef ENDPOINT_DESCRIPTOR_BINARY_H_
+#define ENDPOINT_DESCRIPTOR_BINARY_H_
+
+#include <stddef.h>
+
+#include "celix_errno.h"
+#include "array_list.h"
+
+/*
+ * Compact alternative for the XML endpoint descriptions, used between discovery pollers and servers that both support
+ * it (negotiated with the Accept and Content-Type headers). All properties are (string) key/value pairs:
+ *
+ *   document = "CEP1" u32:nrOfEndpoints endpoint*
+ *   endpoint = u32:nrOfProperties (string:key string:value)*
+ *   string   = u32:length bytes (not 0 terminated)
+ *
+ * All u32 values are in network byte order.
+ */
+#define ENDPOINT_DESCRIPTOR_BINARY_CONTENT_TYPE "application/x-celix-endpoints"
+
+/**
+ * Encodes the endpoints (endpoint_description_t *). The caller is owner of the returned document.
+ */
+celix_status_t endpointDescriptorBinary_write(array_list_pt endpoints, char **document, size_t *length);
+
+/**
+ * Decodes a document and adds the endpoints to the endpoints list. Endpoint descriptions which are incomplete are
+ * skipped. Returns CELIX_ILLEGAL_ARGUMENT if the document is malformed.
+ */
+celix_status_t endpointDescriptorBinary_read(const char *document, size_t length, array_list_pt endpoints);
+
+#endif /* ENDPOINT_DESCRIPTOR_BINARY_H_ */
@@ -27,6 +27,8 @@
 #ifndef ENDPOINT_DISCOVERY_POLLER_H_
 #define ENDPOINT_DISCOVERY_POLLER_H_
 
+#include <curl/curl.h>
+
 #include "celix_errno.h"
 #include "discovery_type.h"
 #include "log_helper.h"
@@ -35,14 +37,19 @@ typedef struct endpoint_discovery_poller endpoint_discovery_poller_t;
 
 struct endpoint_discovery_poller {
     discovery_t *discovery;
-    hash_map_pt entries;
+    hash_map_pt entries; //key = url, value = endpoint_discovery_poller_entry_t *
     log_helper_t **loghelper;
 
+    CURLM *multi; //all discovery urls are polled concurrently by the poller thread
+    array_list_pt retired; //removed entries with a request in flight, cleaned up by the poller thread
+    struct curl_slist *requestHeaders; //prefers the binary endpoint format, falls back to XML
+
     celix_thread_mutex_t pollerLock;
     celix_thread_t pollerThread;
 
     unsigned int poll_interval;
     unsigned int poll_timeout;
+    unsigned int poll_wait;
 
     volatile bool running;
 };
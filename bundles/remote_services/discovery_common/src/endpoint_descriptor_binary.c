@@ -0,0 +1,148 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *  KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+/**
+ * endpoint_descriptor_binary.c
+ *
+ *  \author     <a href="mailto:dev@celix.apache.org">Apache Celix Project Team</a>
+ *  \copyright  Apache License, Version 2.0
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <arpa/inet.h>
+
+#include "celix_constants.h"
+#include "celix_properties.h"
+#include "endpoint_description.h"
+#include "endpoint_descriptor_binary.h"
+
+#define ENDPOINT_DESCRIPTOR_BINARY_MAGIC "CEP1"
+#define ENDPOINT_DESCRIPTOR_BINARY_MAGIC_LENGTH 4
+
+static void endpointDescriptorBinary_writeU32(FILE *stream, uint32_t value) {
+    uint32_t netValue = htonl(value);
+    fwrite(&netValue, sizeof(netValue), 1, stream);
+}
+
+static void endpointDescriptorBinary_writeString(FILE *stream, const char *str) {
+    size_t length = strlen(str);
+    endpointDescriptorBinary_writeU32(stream, (uint32_t) length);
+    fwrite(str, 1, length, stream);
+}
+
+celix_status_t endpointDescriptorBinary_write(array_list_pt endpoints, char **document, size_t *length) {
+    char *buffer = NULL;
+    size_t size = 0;
+    FILE *stream = open_memstream(&buffer, &size);
+    if (stream == NULL) {
+        return CELIX_ENOMEM;
+    }
+
+    fwrite(ENDPOINT_DESCRIPTOR_BINARY_MAGIC, 1, ENDPOINT_DESCRIPTOR_BINARY_MAGIC_LENGTH, stream);
+    endpointDescriptorBinary_writeU32(stream, (uint32_t) arrayList_size(endpoints));
+    for (int i = 0; i < arrayList_size(endpoints); i++) {
+        endpoint_description_t *endpoint = arrayList_get(endpoints, i);
+
+        endpointDescriptorBinary_writeU32(stream, (uint32_t) hashMap_size(endpoint->properties));
+        hash_map_iterator_t iter = hashMapIterator_construct(endpoint->properties);
+        while (hashMapIterator_hasNext(&iter)) {
+            hash_map_entry_pt entry = hashMapIterator_nextEntry(&iter);
+            endpointDescriptorBinary_writeString(stream, hashMapEntry_getKey(entry));
+            endpointDescriptorBinary_writeString(stream, hashMapEntry_getValue(entry));
+        }
+    }
+
+    if (fclose(stream) != 0) {
+        free(buffer);
+        return CELIX_ENOMEM;
+    }
+
+    *document = buffer;
+    *length = size;
+    return CELIX_SUCCESS;
+}
+
+static bool endpointDescriptorBinary_readU32(const char **pos, const char *end, uint32_t *value) {
+    if ((size_t) (end - *pos) < sizeof(uint32_t)) {
+        return false;
+    }
+    uint32_t netValue;
+    memcpy(&netValue, *pos, sizeof(netValue));
+    *value = ntohl(netValue);
+    *pos += sizeof(netValue);
+    return true;
+}
+
+static char* endpointDescriptorBinary_readString(const char **pos, const char *end) {
+    uint32_t length = 0;
+    if (!endpointDescriptorBinary_readU32(pos, end, &length) || (size_t) (end - *pos) < length) {
+        return NULL;
+    }
+    char *str = strndup(*pos, length);
+    *pos += length;
+    return str;
+}
+
+celix_status_t endpointDescriptorBinary_read(const char *document, size_t length, array_list_pt endpoints) {
+    const char *pos = document;
+    const char *end = document + length;
+    uint32_t nrOfEndpoints = 0;
+
+    if (length < ENDPOINT_DESCRIPTOR_BINARY_MAGIC_LENGTH || memcmp(document, ENDPOINT_DESCRIPTOR_BINARY_MAGIC, ENDPOINT_DESCRIPTOR_BINARY_MAGIC_LENGTH) != 0) {
+        return CELIX_ILLEGAL_ARGUMENT;
+    }
+    pos += ENDPOINT_DESCRIPTOR_BINARY_MAGIC_LENGTH;
+    if (!endpointDescriptorBinary_readU32(&pos, end, &nrOfEndpoints)) {
+        return CELIX_ILLEGAL_ARGUMENT;
+    }
+
+    celix_status_t status = CELIX_SUCCESS;
+    for (uint32_t i = 0; i < nrOfEndpoints && status == CELIX_SUCCESS; i++) {
+        uint32_t nrOfProperties = 0;
+        if (!endpointDescriptorBinary_readU32(&pos, end, &nrOfProperties)) {
+            status = CELIX_ILLEGAL_ARGUMENT;
+            break;
+        }
+
+        celix_properties_t *properties = celix_properties_create();
+        for (uint32_t p = 0; p < nrOfProperties && status == CELIX_SUCCESS; p++) {
+            char *key = endpointDescriptorBinary_readString(&pos, end);
+            char *value = key != NULL ? endpointDescriptorBinary_readString(&pos, end) : NULL;
+            if (value != NULL) {
+                celix_properties_set(properties, key, value);
+            } else {
+                status = CELIX_ILLEGAL_ARGUMENT;
+            }
+            free(key);
+            free(value);
+        }
+
+        endpoint_description_t *endpoint = NULL;
+        if (status == CELIX_SUCCESS && celix_properties_get(properties, OSGI_FRAMEWORK_OBJECTCLASS, NULL) != NULL &&
+                endpointDescription_create(properties, &endpoint) == CELIX_SUCCESS) {
+            arrayList_add(endpoints, endpoint);
+        } else {
+            celix_properties_destroy(properties);
+        }
+    }
+
+    return status;
+}
@@ -28,6 +28,8 @@
 #include <stdlib.h>
 #include <stdio.h>
 #include <string.h>
+#include <strings.h>
+#include <time.h>
 #include <unistd.h>
 
 #include <curl/curl.h>
@@ -37,6 +39,7 @@
 #include "utils.h"
 
 #include "endpoint_descriptor_reader.h"
+#include "endpoint_descriptor_binary.h"
 #include "discovery.h"
 
 
@@ -46,11 +49,54 @@
 #define DISCOVERY_POLL_TIMEOUT "DISCOVERY_CFG_POLL_TIMEOUT"
 #define DEFAULT_POLL_TIMEOUT "10" // seconds
 
+/**
+ * How long a discovery server that supports it may hold a poll request until the endpoints change. 0 disables the
+ * long polling, the endpoints are then polled every poll interval (still as delta if the server supports it).
+ */
+#define DISCOVERY_POLL_WAIT "DISCOVERY_CFG_POLL_WAIT"
+#define DEFAULT_POLL_WAIT "30" // seconds
+
+struct MemoryStruct {
+	char *memory;
+	size_t size;
+};
+
+typedef struct endpoint_discovery_poller_entry {
+	char *url;
+	array_list_pt endpoints; //the endpoints discovered at url
+
+	char *etag; //version of the endpoints as reported by the discovery server, NULL if not known
+	bool push; //whether the discovery server supports delta and long poll requests
+	double nextPoll;
+
+	//the request in flight, only used by the poller thread
+	CURL *transfer;
+	struct MemoryStruct body;
+	char *responseEtag;
+	bool responseVersioned; //the server sent a delta header, i.e. it supports delta and long poll requests
+	bool responseDelta;
+	char *responseRemoved;
+	char *responseContentType;
+
+	bool removed;
+} endpoint_discovery_poller_entry_t;
+
 static void *endpointDiscoveryPoller_performPeriodicPoll(void *data);
-celix_status_t endpointDiscoveryPoller_poll(endpoint_discovery_poller_t *poller, char *url, array_list_pt currentEndpoints);
-static celix_status_t endpointDiscoveryPoller_getEndpoints(endpoint_discovery_poller_t *poller, char *url, array_list_pt *updatedEndpoints);
+static celix_status_t endpointDiscoveryPoller_startTransfer(endpoint_discovery_poller_t *poller, endpoint_discovery_poller_entry_t *entry);
+static void endpointDiscoveryPoller_completeTransfer(endpoint_discovery_poller_t *poller, endpoint_discovery_poller_entry_t *entry, CURLcode res);
+static void endpointDiscoveryPoller_resetResponse(endpoint_discovery_poller_entry_t *entry);
+static void endpointDiscoveryPoller_destroyEntry(endpoint_discovery_poller_entry_t *entry);
+static void endpointDiscoveryPoller_cleanupRetired(endpoint_discovery_poller_t *poller);
+static celix_status_t endpointDiscoveryPoller_update(endpoint_discovery_poller_t *poller, endpoint_discovery_poller_entry_t *entry, array_list_pt updatedEndpoints);
+static celix_status_t endpointDiscoveryPoller_applyDelta(endpoint_discovery_poller_t *poller, endpoint_discovery_poller_entry_t *entry, array_list_pt addedEndpoints, char *removedEndpointIds);
 static celix_status_t endpointDiscoveryPoller_endpointDescriptionEquals(const void *endpointPtr, const void *comparePtr, bool *equals);
 
+static double endpointDiscoveryPoller_now(void) {
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec / 1000000000.0;
+}
+
 /**
  * Allocates memory and initializes a new endpoint_discovery_poller instance.
  */
@@ -81,6 +127,12 @@ celix_status_t endpointDiscoveryPoller_create(discovery_t *discovery, celix_bund
 		timeout = DEFAULT_POLL_TIMEOUT;
 	}
 
+	const char* wait = NULL;
+	status = bundleContext_getProperty(context, DISCOVERY_POLL_WAIT, &wait);
+	if (!wait) {
+		wait = DEFAULT_POLL_WAIT;
+	}
+
 	const char* endpointsProp = NULL;
 	status = bundleContext_getProperty(context, DISCOVERY_POLL_ENDPOINTS, &endpointsProp);
 	if (!endpointsProp) {
@@ -91,9 +143,18 @@ celix_status_t endpointDiscoveryPoller_create(discovery_t *discovery, celix_bund
 
 	(*poller)->poll_interval = atoi(interval);
 	(*poller)->poll_timeout = atoi(timeout);
+	(*poller)->poll_wait = atoi(wait);
 	(*poller)->discovery = discovery;
 	(*poller)->running = false;
 	(*poller)->entries = hashMap_create(utils_stringHash, NULL, utils_stringEquals, NULL);
+	(*poller)->multi = curl_multi_init();
+	arrayList_create(&(*poller)->retired);
+	(*poller)->requestHeaders = curl_slist_append(NULL, "Accept: " ENDPOINT_DESCRIPTOR_BINARY_CONTENT_TYPE ", application/xml;q=0.5");
+
+	if ((*poller)->multi == NULL) {
+		free(endpoints);
+		return CELIX_ILLEGAL_STATE;
+	}
 
 	const char* sep = ",";
 	char *save_ptr = NULL;
@@ -113,6 +174,9 @@ celix_status_t endpointDiscoveryPoller_create(discovery_t *discovery, celix_bund
 	(*poller)->running = true;
 
 	status += celixThread_create(&(*poller)->pollerThread, NULL, endpointDiscoveryPoller_performPeriodicPoll, *poller);
+	if (status == CELIX_SUCCESS) {
+		celixThread_setName(&(*poller)->pollerThread, "DiscoveryPoller");
+	}
 	status += celixThreadMutex_unlock(&(*poller)->pollerLock);
 
 	if(status != CELIX_SUCCESS){
@@ -129,6 +193,7 @@ celix_status_t endpointDiscoveryPoller_destroy(endpoint_discovery_poller_t *poll
 	celix_status_t status;
 
 	poller->running = false;
+	curl_multi_wakeup(poller->multi);
 
 	celixThread_join(poller->pollerThread, NULL);
 
@@ -149,7 +214,12 @@ celix_status_t endpointDiscoveryPoller_destroy(endpoint_discovery_poller_t *poll
 		return CELIX_BUNDLE_EXCEPTION;
 	}
 
-	hashMap_destroy(poller->entries, true, false);
+	endpointDiscoveryPoller_cleanupRetired(poller);
+	arrayList_destroy(poller->retired);
+	curl_multi_cleanup(poller->multi);
+	curl_slist_free_all(poller->requestHeaders);
+
+	hashMap_destroy(poller->entries, false, false);
 
 	status = celixThreadMutex_unlock(&poller->pollerLock);
 
@@ -180,7 +250,7 @@ celix_status_t endpointDiscoveryPoller_getDiscoveryEndpoints(endpoint_discovery_
 }
 
 /**
- * Adds a new endpoint URL to the list of polled endpoints.
+ * Adds a new endpoint URL to the list of polled endpoints. The URL is polled right away by the poller thread.
  */
 celix_status_t endpointDiscoveryPoller_addDiscoveryEndpoint(endpoint_discovery_poller_t *poller, char *url) {
 	celix_status_t status;
@@ -191,18 +261,25 @@ celix_status_t endpointDiscoveryPoller_addDiscoveryEndpoint(endpoint_discovery_p
 	}
 
 	// Avoid memory leaks when adding an already existing URL...
-	array_list_pt endpoints = hashMap_get(poller->entries, url);
-	if (endpoints == NULL) {
-		status = arrayList_createWithEquals(endpointDiscoveryPoller_endpointDescriptionEquals, &endpoints);
+	if (hashMap_get(poller->entries, url) == NULL) {
+		endpoint_discovery_poller_entry_t *entry = calloc(1, sizeof(*entry));
+		if (entry == NULL) {
+			status = CELIX_ENOMEM;
+		} else {
+			status = arrayList_createWithEquals(endpointDiscoveryPoller_endpointDescriptionEquals, &entry->endpoints);
+		}
 
 		if (status == CELIX_SUCCESS) {
 			logHelper_log(*poller->loghelper, OSGI_LOGSERVICE_DEBUG, "ENDPOINT_POLLER: add new discovery endpoint with url %s", url);
-			hashMap_put(poller->entries, strdup(url), endpoints);
-			endpointDiscoveryPoller_poll(poller, url, endpoints);
+			entry->url = strdup(url);
+			hashMap_put(poller->entries, entry->url, entry);
+			curl_multi_wakeup(poller->multi);
+		} else {
+			free(entry);
 		}
 	}
 
-	status = celixThreadMutex_unlock(&poller->pollerLock);
+	celixThreadMutex_unlock(&poller->pollerLock);
 
 	return status;
 }
@@ -216,28 +293,28 @@ celix_status_t endpointDiscoveryPoller_removeDiscoveryEndpoint(endpoint_discover
 	if (celixThreadMutex_lock(&poller->pollerLock) != CELIX_SUCCESS) {
 		status = CELIX_BUNDLE_EXCEPTION;
 	} else {
-		hash_map_entry_pt entry = hashMap_getEntry(poller->entries, url);
+		endpoint_discovery_poller_entry_t *entry = hashMap_remove(poller->entries, url);
 
 		if (entry == NULL) {
 			logHelper_log(*poller->loghelper, OSGI_LOGSERVICE_DEBUG, "ENDPOINT_POLLER: There was no entry found belonging to url %s - maybe already removed?", url);
 		} else {
-			char* origKey = hashMapEntry_getKey(entry);
-
 			logHelper_log(*poller->loghelper, OSGI_LOGSERVICE_DEBUG, "ENDPOINT_POLLER: remove discovery endpoint with url %s", url);
 
-			array_list_pt entries = hashMap_remove(poller->entries, url);
-
-			if (entries != NULL) {
-				for (unsigned int i = arrayList_size(entries); i > 0; i--) {
-					endpoint_description_t *endpoint = arrayList_get(entries, i - 1);
-					discovery_removeDiscoveredEndpoint(poller->discovery, endpoint);
-					arrayList_remove(entries, i - 1);
-					endpointDescription_destroy(endpoint);
-				}
-				arrayList_destroy(entries);
+			for (unsigned int i = arrayList_size(entry->endpoints); i > 0; i--) {
+				endpoint_description_t *endpoint = arrayList_get(entry->endpoints, i - 1);
+				discovery_removeDiscoveredEndpoint(poller->discovery, endpoint);
+				arrayList_remove(entry->endpoints, i - 1);
+				endpointDescription_destroy(endpoint);
 			}
 
-			free(origKey);
+			if (entry->transfer != NULL) {
+				// the multi handle is only used by the poller thread, it cleans up the request in flight
+				entry->removed = true;
+				arrayList_add(poller->retired, entry);
+				curl_multi_wakeup(poller->multi);
+			} else {
+				endpointDiscoveryPoller_destroyEntry(entry);
+			}
 		}
 		status = celixThreadMutex_unlock(&poller->pollerLock);
 	}
@@ -245,45 +322,91 @@ celix_status_t endpointDiscoveryPoller_removeDiscoveryEndpoint(endpoint_discover
 	return status;
 }
 
+static void endpointDiscoveryPoller_destroyEntry(endpoint_discovery_poller_entry_t *entry) {
+	endpointDiscoveryPoller_resetResponse(entry);
+	arrayList_destroy(entry->endpoints);
+	free(entry->etag);
+	free(entry->url);
+	free(entry);
+}
+
+static void endpointDiscoveryPoller_cleanupRetired(endpoint_discovery_poller_t *poller) {
+	for (int i = 0; i < arrayList_size(poller->retired); i++) {
+		endpoint_discovery_poller_entry_t *entry = arrayList_get(poller->retired, i);
+		if (entry->transfer != NULL) {
+			curl_multi_remove_handle(poller->multi, entry->transfer);
+			curl_easy_cleanup(entry->transfer);
+			entry->transfer = NULL;
+		}
+		endpointDiscoveryPoller_destroyEntry(entry);
+	}
+	arrayList_clear(poller->retired);
+}
 
+/**
+ * Replaces the endpoints of the entry with the updated endpoints of a full endpoint list.
+ */
+static celix_status_t endpointDiscoveryPoller_update(endpoint_discovery_poller_t *poller, endpoint_discovery_poller_entry_t *entry, array_list_pt updatedEndpoints) {
+	celix_status_t status = CELIX_SUCCESS;
+	array_list_pt currentEndpoints = entry->endpoints;
 
+	for (unsigned int i = arrayList_size(currentEndpoints); i > 0; i--) {
+		endpoint_description_t *endpoint = arrayList_get(currentEndpoints, i - 1);
 
-celix_status_t endpointDiscoveryPoller_poll(endpoint_discovery_poller_t *poller, char *url, array_list_pt currentEndpoints) {
-	celix_status_t status;
-	array_list_pt updatedEndpoints = NULL;
+		if (!arrayList_contains(updatedEndpoints, endpoint)) {
+			status = discovery_removeDiscoveredEndpoint(poller->discovery, endpoint);
+			arrayList_remove(currentEndpoints, i - 1);
+			endpointDescription_destroy(endpoint);
+		}
+	}
 
-	// create an arraylist with a custom equality test to ensure we can find endpoints properly...
-	arrayList_createWithEquals(endpointDiscoveryPoller_endpointDescriptionEquals, &updatedEndpoints);
-	status = endpointDiscoveryPoller_getEndpoints(poller, url, &updatedEndpoints);
+	for (int i = arrayList_size(updatedEndpoints); i > 0; i--) {
+		endpoint_description_t *endpoint = arrayList_remove(updatedEndpoints, 0);
 
-	if (status == CELIX_SUCCESS) {
-		if (updatedEndpoints != NULL) {
-			for (unsigned int i = arrayList_size(currentEndpoints); i > 0; i--) {
-				endpoint_description_t *endpoint = arrayList_get(currentEndpoints, i - 1);
-
-				if (!arrayList_contains(updatedEndpoints, endpoint)) {
-					status = discovery_removeDiscoveredEndpoint(poller->discovery, endpoint);
-					arrayList_remove(currentEndpoints, i - 1);
-					endpointDescription_destroy(endpoint);
-				}
-			}
+		if (!arrayList_contains(currentEndpoints, endpoint)) {
+			arrayList_add(currentEndpoints, endpoint);
+			status = discovery_addDiscoveredEndpoint(poller->discovery, endpoint);
+		} else {
+			endpointDescription_destroy(endpoint);
 
-			for (int i = arrayList_size(updatedEndpoints); i > 0; i--) {
-				endpoint_description_t *endpoint = arrayList_remove(updatedEndpoints, 0);
+		}
+	}
 
-				if (!arrayList_contains(currentEndpoints, endpoint)) {
-					arrayList_add(currentEndpoints, endpoint);
-					status = discovery_addDiscoveredEndpoint(poller->discovery, endpoint);
-				} else {
-					endpointDescription_destroy(endpoint);
+	return status;
+}
 
-				}
-			}
+static void endpointDiscoveryPoller_removeEndpointWithId(endpoint_discovery_poller_t *poller, array_list_pt endpoints, const char *endpointId) {
+	for (unsigned int i = arrayList_size(endpoints); i > 0; i--) {
+		endpoint_description_t *endpoint = arrayList_get(endpoints, i - 1);
+		if (strcmp(endpoint->id, endpointId) == 0) {
+			discovery_removeDiscoveredEndpoint(poller->discovery, endpoint);
+			arrayList_remove(endpoints, i - 1);
+			endpointDescription_destroy(endpoint);
 		}
 	}
+}
 
-	if (updatedEndpoints != NULL) {
-		arrayList_destroy(updatedEndpoints);
+/**
+ * Applies a delta of the discovery server: the added (or changed) endpoints and the comma separated ids of the
+ * removed endpoints. Unchanged endpoints are not part of a delta.
+ */
+static celix_status_t endpointDiscoveryPoller_applyDelta(endpoint_discovery_poller_t *poller, endpoint_discovery_poller_entry_t *entry, array_list_pt addedEndpoints, char *removedEndpointIds) {
+	celix_status_t status = CELIX_SUCCESS;
+
+	if (removedEndpointIds != NULL) {
+		char *savePtr = NULL;
+		char *id = strtok_r(removedEndpointIds, ",", &savePtr);
+		while (id != NULL) {
+			endpointDiscoveryPoller_removeEndpointWithId(poller, entry->endpoints, utils_stringTrim(id));
+			id = strtok_r(NULL, ",", &savePtr);
+		}
+	}
+
+	for (int i = arrayList_size(addedEndpoints); i > 0; i--) {
+		endpoint_description_t *endpoint = arrayList_remove(addedEndpoints, 0);
+		endpointDiscoveryPoller_removeEndpointWithId(poller, entry->endpoints, endpoint->id);
+		arrayList_add(entry->endpoints, endpoint);
+		status = discovery_addDiscoveredEndpoint(poller->discovery, endpoint);
 	}
 
 	return status;
@@ -292,45 +415,59 @@ celix_status_t endpointDiscoveryPoller_poll(endpoint_discovery_poller_t *poller,
 static void *endpointDiscoveryPoller_performPeriodicPoll(void *data) {
 	endpoint_discovery_poller_t *poller = (endpoint_discovery_poller_t *) data;
 
-	useconds_t interval = (useconds_t) (poller->poll_interval * 1000000L);
-
 	while (poller->running) {
-		usleep(interval);
-		celix_status_t status = celixThreadMutex_lock(&poller->pollerLock);
+		double now = endpointDiscoveryPoller_now();
+		double nextPoll = now + poller->poll_interval;
 
+		celix_status_t status = celixThreadMutex_lock(&poller->pollerLock);
 		if (status != CELIX_SUCCESS) {
 			logHelper_log(*poller->loghelper, OSGI_LOGSERVICE_WARNING, "ENDPOINT_POLLER: failed to obtain lock; retrying...");
 		} else {
-			hash_map_iterator_pt iterator = hashMapIterator_create(poller->entries);
+			endpointDiscoveryPoller_cleanupRetired(poller);
 
+			hash_map_iterator_pt iterator = hashMapIterator_create(poller->entries);
 			while (hashMapIterator_hasNext(iterator)) {
-				hash_map_entry_pt entry = hashMapIterator_nextEntry(iterator);
-
-				char *url = hashMapEntry_getKey(entry);
-				array_list_pt currentEndpoints = hashMapEntry_getValue(entry);
+				endpoint_discovery_poller_entry_t *entry = hashMapIterator_nextValue(iterator);
 
-				endpointDiscoveryPoller_poll(poller, url, currentEndpoints);
+				if (entry->transfer == NULL && entry->nextPoll <= now && endpointDiscoveryPoller_startTransfer(poller, entry) != CELIX_SUCCESS) {
+					entry->nextPoll = now + poller->poll_interval;
+				}
+				if (entry->transfer == NULL && entry->nextPoll < nextPoll) {
+					nextPoll = entry->nextPoll;
+				}
 			}
-
 			hashMapIterator_destroy(iterator);
+
+			celixThreadMutex_unlock(&poller->pollerLock);
 		}
 
-		status = celixThreadMutex_unlock(&poller->pollerLock);
-		if (status != CELIX_SUCCESS) {
-			logHelper_log(*poller->loghelper, OSGI_LOGSERVICE_WARNING, "ENDPOINT_POLLER: failed to release lock; retrying...");
+		// wait until a request completes, the next poll is due or an url is added/removed
+		int timeoutInMs = (int) ((nextPoll - now) * 1000);
+		curl_multi_poll(poller->multi, NULL, 0, timeoutInMs > 0 ? timeoutInMs : 0, NULL);
+
+		int stillRunning = 0;
+		curl_multi_perform(poller->multi, &stillRunning);
+
+		CURLMsg *msg = NULL;
+		int msgsLeft = 0;
+		while ((msg = curl_multi_info_read(poller->multi, &msgsLeft)) != NULL) {
+			if (msg->msg == CURLMSG_DONE) {
+				CURLcode res = msg->data.result;
+				endpoint_discovery_poller_entry_t *entry = NULL;
+				curl_easy_getinfo(msg->easy_handle, CURLINFO_PRIVATE, (char **) &entry);
+
+				celixThreadMutex_lock(&poller->pollerLock);
+				if (!entry->removed) {
+					endpointDiscoveryPoller_completeTransfer(poller, entry, res);
+				}
+				celixThreadMutex_unlock(&poller->pollerLock);
+			}
 		}
 	}
 
 	return NULL;
 }
 
-
-
-struct MemoryStruct {
-	char *memory;
-	size_t size;
-};
-
 static size_t endpointDiscoveryPoller_writeMemory(void *contents, size_t size, size_t nmemb, void *memoryPtr) {
 	size_t realsize = size * nmemb;
 	struct MemoryStruct *mem = (struct MemoryStruct *)memoryPtr;
@@ -348,54 +485,179 @@ static size_t endpointDiscoveryPoller_writeMemory(void *contents, size_t size, s
 	return realsize;
 }
 
-static celix_status_t endpointDiscoveryPoller_getEndpoints(endpoint_discovery_poller_t *poller, char *url, array_list_pt *updatedEndpoints) {
-	celix_status_t status = CELIX_SUCCESS;
+/**
+ * Returns a copy of the value of the header line if it is the header with the given name, without surrounding
+ * whitespace and quotes. Otherwise NULL.
+ */
+static char* endpointDiscoveryPoller_headerValue(const char *line, size_t length, const char *name) {
+	size_t nameLength = strlen(name);
+	if (length <= nameLength || strncasecmp(line, name, nameLength) != 0 || line[nameLength] != ':') {
+		return NULL;
+	}
+
+	const char *start = line + nameLength + 1;
+	const char *end = line + length;
+	while (start < end && (*start == ' ' || *start == '\t' || *start == '"')) {
+		start++;
+	}
+	while (end > start && (end[-1] == '\r' || end[-1] == '\n' || end[-1] == ' ' || end[-1] == '"')) {
+		end--;
+	}
+	return strndup(start, end - start);
+}
+
+static size_t endpointDiscoveryPoller_readHeader(char *buffer, size_t size, size_t nitems, void *userdata) {
+	endpoint_discovery_poller_entry_t *entry = userdata;
+	size_t length = size * nitems;
+	char *value = NULL;
+
+	if ((value = endpointDiscoveryPoller_headerValue(buffer, length, "ETag")) != NULL) {
+		free(entry->responseEtag);
+		entry->responseEtag = value;
+	} else if ((value = endpointDiscoveryPoller_headerValue(buffer, length, DISCOVERY_DELTA_HEADER)) != NULL) {
+		entry->responseVersioned = true;
+		entry->responseDelta = strcmp(value, "true") == 0;
+		free(value);
+	} else if ((value = endpointDiscoveryPoller_headerValue(buffer, length, DISCOVERY_REMOVED_HEADER)) != NULL) {
+		free(entry->responseRemoved);
+		entry->responseRemoved = value;
+	} else if ((value = endpointDiscoveryPoller_headerValue(buffer, length, "Content-Type")) != NULL) {
+		free(entry->responseContentType);
+		entry->responseContentType = value;
+	}
 
+	return length;
+}
 
-	CURL *curl = NULL;
-	CURLcode res = CURLE_OK;
+static void endpointDiscoveryPoller_resetResponse(endpoint_discovery_poller_entry_t *entry) {
+	free(entry->body.memory);
+	entry->body.memory = NULL;
+	entry->body.size = 0;
+	free(entry->responseEtag);
+	entry->responseEtag = NULL;
+	free(entry->responseRemoved);
+	entry->responseRemoved = NULL;
+	free(entry->responseContentType);
+	entry->responseContentType = NULL;
+	entry->responseVersioned = false;
+	entry->responseDelta = false;
+}
 
-	struct MemoryStruct chunk;
-	chunk.memory = malloc(1);
-	chunk.size = 0;
+/**
+ * Starts a request for the endpoints of the entry. If the discovery server supports it, only the changes since the
+ * last known version are requested and the server holds the request until there are changes (long poll).
+ */
+static celix_status_t endpointDiscoveryPoller_startTransfer(endpoint_discovery_poller_t *poller, endpoint_discovery_poller_entry_t *entry) {
+	CURL *curl = curl_easy_init();
+	if (curl == NULL) {
+		return CELIX_ILLEGAL_STATE;
+	}
 
-	curl = curl_easy_init();
-	if (!curl) {
-		status = CELIX_ILLEGAL_STATE;
+	char *url = NULL;
+	long timeout = poller->poll_timeout;
+	if (entry->push && entry->etag != NULL) {
+		char *etag = curl_easy_escape(curl, entry->etag, 0);
+		unsigned int wait = poller->poll_wait;
+		if (asprintf(&url, "%s%c%s=%s&%s=%u", entry->url, strchr(entry->url, '?') == NULL ? '?' : '&', DISCOVERY_SINCE_PARAM, etag, DISCOVERY_WAIT_PARAM, wait * 1000) < 0) {
+			url = NULL;
+		}
+		curl_free(etag);
+		timeout += wait;
 	} else {
-		curl_easy_setopt(curl, CURLOPT_URL, url);
-		curl_easy_setopt(curl, CURLOPT_NOSIGNAL, 1);
-		curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, endpointDiscoveryPoller_writeMemory);
-		curl_easy_setopt(curl, CURLOPT_WRITEDATA, (void *)&chunk);
-		curl_easy_setopt(curl, CURLOPT_CONNECTTIMEOUT, 5L);
-		curl_easy_setopt(curl, CURLOPT_TIMEOUT, poller->poll_timeout);
-		res = curl_easy_perform(curl);
+		url = strdup(entry->url);
+	}
 
+	if (url == NULL) {
 		curl_easy_cleanup(curl);
+		return CELIX_ENOMEM;
+	}
+
+	endpointDiscoveryPoller_resetResponse(entry);
+	entry->body.memory = malloc(1);
+
+	curl_easy_setopt(curl, CURLOPT_URL, url);
+	curl_easy_setopt(curl, CURLOPT_NOSIGNAL, 1);
+	curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, endpointDiscoveryPoller_writeMemory);
+	curl_easy_setopt(curl, CURLOPT_WRITEDATA, (void *)&entry->body);
+	curl_easy_setopt(curl, CURLOPT_HEADERFUNCTION, endpointDiscoveryPoller_readHeader);
+	curl_easy_setopt(curl, CURLOPT_HEADERDATA, (void *)entry);
+	curl_easy_setopt(curl, CURLOPT_HTTPHEADER, poller->requestHeaders);
+	curl_easy_setopt(curl, CURLOPT_ACCEPT_ENCODING, "gzip");
+	curl_easy_setopt(curl, CURLOPT_CONNECTTIMEOUT, 5L);
+	curl_easy_setopt(curl, CURLOPT_TIMEOUT, timeout);
+	curl_easy_setopt(curl, CURLOPT_PRIVATE, (char *)entry);
+	free(url);
+
+	if (curl_multi_add_handle(poller->multi, curl) != CURLM_OK) {
+		curl_easy_cleanup(curl);
+		return CELIX_ILLEGAL_STATE;
 	}
+	entry->transfer = curl;
 
-	// process endpoints file
-	if (res == CURLE_OK) {
+	return CELIX_SUCCESS;
+}
+
+static void endpointDiscoveryPoller_completeTransfer(endpoint_discovery_poller_t *poller, endpoint_discovery_poller_entry_t *entry, CURLcode res) {
+	celix_status_t status = CELIX_SUCCESS;
+	long httpCode = 0;
+
+	curl_easy_getinfo(entry->transfer, CURLINFO_RESPONSE_CODE, &httpCode);
+	curl_multi_remove_handle(poller->multi, entry->transfer);
+	curl_easy_cleanup(entry->transfer);
+	entry->transfer = NULL;
+
+	if (res == CURLE_OK && httpCode == 200) {
+		array_list_pt updatedEndpoints = NULL;
 		endpoint_descriptor_reader_t *reader = NULL;
 
-		status = endpointDescriptorReader_create(poller, &reader);
-		if (status == CELIX_SUCCESS) {
-			status = endpointDescriptorReader_parseDocument(reader, chunk.memory, updatedEndpoints);
+		// create an arraylist with a custom equality test to ensure we can find endpoints properly...
+		arrayList_createWithEquals(endpointDiscoveryPoller_endpointDescriptionEquals, &updatedEndpoints);
+		if (entry->responseContentType != NULL && strncmp(entry->responseContentType, ENDPOINT_DESCRIPTOR_BINARY_CONTENT_TYPE, strlen(ENDPOINT_DESCRIPTOR_BINARY_CONTENT_TYPE)) == 0) {
+			status = endpointDescriptorBinary_read(entry->body.memory, entry->body.size, updatedEndpoints);
+		} else {
+			status = endpointDescriptorReader_create(poller, &reader);
+			if (status == CELIX_SUCCESS) {
+				status = endpointDescriptorReader_parseDocument(reader, entry->body.memory, &updatedEndpoints);
+			}
+			if (reader) {
+				endpointDescriptorReader_destroy(reader);
+			}
+		}
+
+		if (status == CELIX_SUCCESS && entry->responseDelta) {
+			status = endpointDiscoveryPoller_applyDelta(poller, entry, updatedEndpoints, entry->responseRemoved);
+		} else if (status == CELIX_SUCCESS) {
+			status = endpointDiscoveryPoller_update(poller, entry, updatedEndpoints);
 		}
 
-		if (reader) {
-			endpointDescriptorReader_destroy(reader);
+		for (int i = 0; i < arrayList_size(updatedEndpoints); i++) {
+			endpointDescription_destroy(arrayList_get(updatedEndpoints, i));
 		}
+		arrayList_destroy(updatedEndpoints);
+
+		free(entry->etag);
+		entry->etag = NULL;
+		if (status == CELIX_SUCCESS) {
+			entry->etag = entry->responseEtag;
+			entry->responseEtag = NULL;
+		}
+		// only discovery servers that support deltas send a delta header (also for a full endpoint list)
+		entry->push = entry->etag != NULL && entry->responseVersioned;
+	} else if (res == CURLE_OK && httpCode == 304) {
+		// not modified, the endpoints are up to date
 	} else {
-		logHelper_log(*poller->loghelper, OSGI_LOGSERVICE_WARNING, "ENDPOINT_POLLER: unable to read endpoints from %s, reason: %s", url, curl_easy_strerror(res));
+		logHelper_log(*poller->loghelper, OSGI_LOGSERVICE_WARNING, "ENDPOINT_POLLER: unable to read endpoints from %s, reason: %s (HTTP %li)", entry->url, curl_easy_strerror(res), httpCode);
+		status = CELIX_BUNDLE_EXCEPTION;
 	}
 
-	// clean up endpoints file
-	if (chunk.memory) {
-		free(chunk.memory);
+	double now = endpointDiscoveryPoller_now();
+	if (status == CELIX_SUCCESS && entry->push && poller->poll_wait > 0) {
+		entry->nextPoll = now;
+	} else {
+		entry->nextPoll = now + poller->poll_interval;
 	}
 
-	return status;
+	endpointDiscoveryPoller_resetResponse(entry);
 }
 
 static celix_status_t endpointDiscoveryPoller_endpointDescriptionEquals(const void *endpointPtr, const void *comparePtr, bool *equals) {
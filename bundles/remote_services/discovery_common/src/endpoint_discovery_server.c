@@ -25,9 +25,12 @@
  */
 
 #include <stdlib.h>
+#include <stdio.h>
 #include <string.h>
+#include <sys/time.h>
 #include <arpa/inet.h>
 #include <netdb.h>
+#include <zlib.h>
 #ifndef ANDROID
 #include <ifaddrs.h>
 #endif
@@ -37,25 +40,77 @@
 #include "log_helper.h"
 #include "discovery.h"
 #include "endpoint_descriptor_writer.h"
+#include "endpoint_descriptor_binary.h"
 
 // defines how often the webserver is restarted (with an increased port number)
 #define MAX_NUMBER_OF_RESTARTS     15
-#define DEFAULT_SERVER_THREADS "1"
+#define DEFAULT_SERVER_THREADS "8" // a waiting (long poll) request of a remote poller occupies a server thread
+
+// nr of endpoint changes kept to answer delta requests, pollers that are further behind get the full endpoint list
+#define CHANGE_LOG_SIZE 256
+#define MAX_WAIT_IN_MS 60000
 
 #define CIVETWEB_REQUEST_NOT_HANDLED 0
 #define CIVETWEB_REQUEST_HANDLED 1
 
-static const char *response_headers =
+static const char *xml_content_type = "application/xml;charset=utf-8";
+
+static const char *response_headers_format =
         "HTTP/1.1 200 OK\r\n"
         "Cache: no-cache\r\n"
-        "Content-Type: application/xml;charset=utf-8\r\n"
+        "Content-Type: %s\r\n"
+        "Content-Length: %zu\r\n"
+        "%s"
+        "%s"
+        "\r\n";
+
+static const char *gzip_headers = "Content-Encoding: gzip\r\nVary: Accept-Encoding\r\n";
+static const char *vary_headers = "Vary: Accept-Encoding\r\n";
+
+static const char *not_modified_plain_response_headers_format =
+        "HTTP/1.1 304 Not Modified\r\n"
+        "ETag: \"%s\"\r\n"
+        "\r\n";
+
+static const char *not_modified_response_headers_format =
+        "HTTP/1.1 304 Not Modified\r\n"
+        "ETag: \"%s\"\r\n"
+        DISCOVERY_DELTA_HEADER ": true\r\n"
         "\r\n";
 
+typedef struct endpoint_discovery_server_change {
+    unsigned long version; // the version of the endpoint list after this change
+    char *endpointId;
+} endpoint_discovery_server_change_t;
+
+/**
+ * A serialized (full) endpoint list, reused for every request till the endpoint list changes.
+ */
+typedef struct endpoint_discovery_server_body {
+    unsigned long version; // the version of the endpoint list of the body, 0 if there is no body
+    char *data;
+    size_t length;
+    void *gzData; // NULL if compression is disabled or failed
+    size_t gzLength;
+} endpoint_discovery_server_body_t;
+
 struct endpoint_discovery_server {
     log_helper_t **loghelper;
     hash_map_pt entries; // key = endpointId, value = endpoint_descriptor_pt
 
     celix_thread_mutex_t serverLock;
+    celix_thread_cond_t changedCond; // signaled on every change, for waiting (long poll) requests
+    bool stopping;
+
+    // the endpoint list is versioned as "<epoch>.<version>", the epoch distinguishes restarts of the server
+    unsigned long epoch;
+    unsigned long version;
+    unsigned long nrOfChanges;
+    endpoint_discovery_server_change_t changes[CHANGE_LOG_SIZE]; // ring buffer, change n is stored at n % CHANGE_LOG_SIZE
+
+    bool compress;
+    endpoint_discovery_server_body_t xmlBody;
+    endpoint_discovery_server_body_t binaryBody;
 
     const char *path;
     const char *port;
@@ -65,6 +120,8 @@ struct endpoint_discovery_server {
 
 // Forward declarations...
 static int endpointDiscoveryServer_callback(struct mg_connection *conn);
+static void endpointDiscoveryServer_addChange(endpoint_discovery_server_t *server, const char *endpointId);
+static void endpointDiscoveryServer_clearBody(endpoint_discovery_server_body_t *body);
 static char* format_path(const char* path);
 
 #ifndef ANDROID
@@ -87,11 +144,16 @@ celix_status_t endpointDiscoveryServer_create(discovery_t *discovery,
 
     int max_ep_num = MAX_NUMBER_OF_RESTARTS;
 
-    *server = malloc(sizeof(struct endpoint_discovery_server));
+    *server = calloc(1, sizeof(struct endpoint_discovery_server));
     if (!*server) {
         return CELIX_ENOMEM;
     }
 
+    struct timeval now;
+    gettimeofday(&now, NULL);
+    (*server)->epoch = (unsigned long) now.tv_sec * 1000000UL + now.tv_usec;
+    (*server)->version = 1;
+
     (*server)->loghelper = &discovery->loghelper;
     (*server)->entries = hashMap_create(&utils_stringHash, NULL, &utils_stringEquals, NULL);
     if (!(*server)->entries) {
@@ -102,6 +164,7 @@ celix_status_t endpointDiscoveryServer_create(discovery_t *discovery,
     if (status != CELIX_SUCCESS) {
         return CELIX_BUNDLE_EXCEPTION;
     }
+    celixThreadCondition_init(&(*server)->changedCond, NULL);
 
     bundleContext_getProperty(context, DISCOVERY_SERVER_IP, &ip);
 #ifndef ANDROID
@@ -155,6 +218,16 @@ celix_status_t endpointDiscoveryServer_create(discovery_t *discovery,
 
     (*server)->path = format_path(path);
 
+    const char *compress = NULL;
+    bundleContext_getProperty(context, DISCOVERY_SERVER_COMPRESS, &compress);
+    (*server)->compress = compress == NULL || strcmp(compress, "false") != 0;
+
+    const char *threads = NULL;
+    bundleContext_getProperty(context, DISCOVERY_SERVER_THREADS, &threads);
+    if (threads == NULL) {
+        threads = DEFAULT_SERVER_THREADS;
+    }
+
     const struct mg_callbacks callbacks = {
             .begin_request = endpointDiscoveryServer_callback,
     };
@@ -165,7 +238,7 @@ celix_status_t endpointDiscoveryServer_create(discovery_t *discovery,
     do {
         const char *options[] = {
                 "listening_ports", port,
-                "num_threads", DEFAULT_SERVER_THREADS,
+                "num_threads", threads,
                 NULL
         };
 
@@ -214,6 +287,12 @@ celix_status_t endpointDiscoveryServer_getUrl(endpoint_discovery_server_t *serve
 celix_status_t endpointDiscoveryServer_destroy(endpoint_discovery_server_t *server) {
     celix_status_t status;
 
+    // wake up waiting requests, so the server threads can stop
+    celixThreadMutex_lock(&server->serverLock);
+    server->stopping = true;
+    celixThreadCondition_broadcast(&server->changedCond);
+    celixThreadMutex_unlock(&server->serverLock);
+
     // stop & block until the actual server is shut down...
     if (server->ctx != NULL) {
         mg_stop(server->ctx);
@@ -223,9 +302,15 @@ celix_status_t endpointDiscoveryServer_destroy(endpoint_discovery_server_t *serv
     status = celixThreadMutex_lock(&server->serverLock);
 
     hashMap_destroy(server->entries, true /* freeKeys */, false /* freeValues */);
+    for (int i = 0; i < CHANGE_LOG_SIZE; i++) {
+        free(server->changes[i].endpointId);
+    }
+    endpointDiscoveryServer_clearBody(&server->xmlBody);
+    endpointDiscoveryServer_clearBody(&server->binaryBody);
 
     status = celixThreadMutex_unlock(&server->serverLock);
     status = celixThreadMutex_destroy(&server->serverLock);
+    celixThreadCondition_destroy(&server->changedCond);
 
     free((void*) server->path);
     free((void*) server->port);
@@ -251,6 +336,9 @@ celix_status_t endpointDiscoveryServer_addEndpoint(endpoint_discovery_server_t *
         logHelper_log(*server->loghelper, OSGI_LOGSERVICE_INFO, "exposing new endpoint \"%s\"...", endpointId);
 
         hashMap_put(server->entries, endpointId, endpoint);
+        endpointDiscoveryServer_addChange(server, endpointId);
+    } else {
+        free(endpointId);
     }
 
     status = celixThreadMutex_unlock(&server->serverLock);
@@ -276,6 +364,7 @@ celix_status_t endpointDiscoveryServer_removeEndpoint(endpoint_discovery_server_
         logHelper_log(*server->loghelper, OSGI_LOGSERVICE_INFO, "removing endpoint \"%s\"...\n", key);
 
         hashMap_remove(server->entries, key);
+        endpointDiscoveryServer_addChange(server, key);
 
         // we've made this key, see _addEndpoint above...
         free((void*) key);
@@ -289,6 +378,38 @@ celix_status_t endpointDiscoveryServer_removeEndpoint(endpoint_discovery_server_
     return status;
 }
 
+/**
+ * Records a change of the endpoint with the given id (added or removed), should be called with the serverLock taken.
+ */
+static void endpointDiscoveryServer_addChange(endpoint_discovery_server_t *server, const char *endpointId) {
+    endpoint_discovery_server_change_t *change = &server->changes[server->nrOfChanges % CHANGE_LOG_SIZE];
+    free(change->endpointId);
+    change->endpointId = strdup(endpointId);
+    change->version = ++server->version;
+    server->nrOfChanges += 1;
+
+    celixThreadCondition_broadcast(&server->changedCond);
+}
+
+/**
+ * Returns whether the changes since the given version (as "<epoch>.<version>") are still in the change log.
+ */
+static bool endpointDiscoveryServer_parseVersion(endpoint_discovery_server_t *server, const char *etag, unsigned long *version) {
+    unsigned long epoch = 0;
+    unsigned long since = 0;
+    if (etag == NULL || sscanf(etag, "%lu.%lu", &epoch, &since) != 2 || epoch != server->epoch) {
+        return false;
+    }
+
+    unsigned long retained = server->nrOfChanges < CHANGE_LOG_SIZE ? server->nrOfChanges : CHANGE_LOG_SIZE;
+    if (since > server->version || since < server->version - retained) {
+        return false;
+    }
+
+    *version = since;
+    return true;
+}
+
 static char* format_path(const char* path) {
     char* result = strdup(path);
     result = utils_stringTrim(result);
@@ -328,45 +449,262 @@ static celix_status_t endpointDiscoveryServer_getEndpoints(endpoint_discovery_se
     return status;
 }
 
-static int endpointDiscoveryServer_writeEndpoints(struct mg_connection* conn, array_list_pt endpoints) {
-    celix_status_t status;
-    int rv = CIVETWEB_REQUEST_NOT_HANDLED;
+static void endpointDiscoveryServer_clearBody(endpoint_discovery_server_body_t *body) {
+    free(body->data);
+    free(body->gzData);
+    memset(body, 0, sizeof(*body));
+}
+
+static void* endpointDiscoveryServer_gzip(const void *data, size_t size, size_t *gzSize) {
+    z_stream stream;
+    memset(&stream, 0, sizeof(stream));
+    // 15 + 16 = max window size with a gzip header and trailer
+    if (deflateInit2(&stream, Z_BEST_COMPRESSION, Z_DEFLATED, 15 + 16, 8, Z_DEFAULT_STRATEGY) != Z_OK) {
+        return NULL;
+    }
+    size_t bound = deflateBound(&stream, (uLong) size);
+    unsigned char *out = malloc(bound);
+    if (out == NULL) {
+        deflateEnd(&stream);
+        return NULL;
+    }
+    stream.next_in = (Bytef *) data;
+    stream.avail_in = (uInt) size;
+    stream.next_out = out;
+    stream.avail_out = (uInt) bound;
+    int rc = deflate(&stream, Z_FINISH);
+    *gzSize = stream.total_out;
+    deflateEnd(&stream);
+    if (rc != Z_STREAM_END) {
+        free(out);
+        return NULL;
+    }
+    return out;
+}
+
+static bool endpointDiscoveryServer_acceptsBinary(struct mg_connection* conn) {
+    const char *accept = mg_get_header(conn, "Accept");
+    return accept != NULL && strstr(accept, ENDPOINT_DESCRIPTOR_BINARY_CONTENT_TYPE) != NULL;
+}
+
+/**
+ * Serializes the endpoints in the compact binary format or as XML.
+ */
+static celix_status_t endpointDiscoveryServer_serialize(array_list_pt endpoints, bool binary, char **data, size_t *length) {
+    if (binary) {
+        return endpointDescriptorBinary_write(endpoints, data, length);
+    }
 
     endpoint_descriptor_writer_t *writer = NULL;
-    status = endpointDescriptorWriter_create(&writer);
+    char *buffer = NULL;
+    celix_status_t status = endpointDescriptorWriter_create(&writer);
     if (status == CELIX_SUCCESS) {
-
-        char *buffer = NULL;
         status = endpointDescriptorWriter_writeDocument(writer, endpoints, &buffer);
-        if (buffer) {
-            mg_write(conn, response_headers, strlen(response_headers));
-            mg_write(conn, buffer, strlen(buffer));
+        endpointDescriptorWriter_destroy(writer);
+    }
+    if (status == CELIX_SUCCESS && buffer != NULL) {
+        *data = buffer;
+        *length = strlen(buffer);
+    } else {
+        free(buffer);
+        status = status == CELIX_SUCCESS ? CELIX_BUNDLE_EXCEPTION : status;
+    }
+    return status;
+}
+
+/**
+ * Writes the serialized endpoints, gzip compressed if a compressed body is available and the client accepts it.
+ */
+static int endpointDiscoveryServer_writeBody(struct mg_connection* conn, bool binary, const char *data, size_t length, const void *gzData, size_t gzLength, const char *extraHeaders) {
+    const char *acceptEncoding = mg_get_header(conn, "Accept-Encoding");
+    bool gzip = gzData != NULL && acceptEncoding != NULL && strstr(acceptEncoding, "gzip") != NULL;
+    const char *contentType = binary ? ENDPOINT_DESCRIPTOR_BINARY_CONTENT_TYPE : xml_content_type;
+    const char *encodingHeaders = gzip ? gzip_headers : (gzData != NULL ? vary_headers : "");
+
+    mg_printf(conn, response_headers_format, contentType, gzip ? gzLength : length, extraHeaders, encodingHeaders);
+    mg_write(conn, gzip ? gzData : data, gzip ? gzLength : length);
+    return CIVETWEB_REQUEST_HANDLED;
+}
+
+/**
+ * Writes the endpoints in the compact binary format if the client accepts it, otherwise as XML.
+ */
+static int endpointDiscoveryServer_writeEndpoints(struct mg_connection* conn, array_list_pt endpoints, const char *extraHeaders) {
+    int rv = CIVETWEB_REQUEST_NOT_HANDLED;
+    bool binary = endpointDiscoveryServer_acceptsBinary(conn);
+
+    char *data = NULL;
+    size_t length = 0;
+    if (endpointDiscoveryServer_serialize(endpoints, binary, &data, &length) == CELIX_SUCCESS) {
+        rv = endpointDiscoveryServer_writeBody(conn, binary, data, length, NULL, 0, extraHeaders);
+        free(data);
+    }
+
+    return rv;
+}
+
+/**
+ * Writes all endpoints. The serialized (and compressed) endpoint list is cached per format and only recreated when
+ * the version of the endpoint list changed, so polls of many peers do not serialize the same list over and over.
+ * Should be called with the serverLock taken.
+ */
+static int endpointDiscoveryServer_writeAllEndpoints(endpoint_discovery_server_t *server, struct mg_connection* conn, const char *extraHeaders) {
+    int rv = CIVETWEB_REQUEST_NOT_HANDLED;
+    bool binary = endpointDiscoveryServer_acceptsBinary(conn);
+    endpoint_discovery_server_body_t *body = binary ? &server->binaryBody : &server->xmlBody;
+
+    if (body->data == NULL || body->version != server->version) {
+        endpointDiscoveryServer_clearBody(body);
+
+        array_list_pt endpoints = NULL;
+        endpointDiscoveryServer_getEndpoints(server, NULL, &endpoints);
+        if (endpoints != NULL && endpointDiscoveryServer_serialize(endpoints, binary, &body->data, &body->length) == CELIX_SUCCESS) {
+            body->version = server->version;
+            if (server->compress) {
+                body->gzData = endpointDiscoveryServer_gzip(body->data, body->length, &body->gzLength);
+            }
+        }
+        if (endpoints != NULL) {
+            arrayList_destroy(endpoints);
         }
+    }
 
-        rv = CIVETWEB_REQUEST_HANDLED;
+    if (body->data != NULL) {
+        rv = endpointDiscoveryServer_writeBody(conn, binary, body->data, body->length, body->gzData, body->gzLength, extraHeaders);
     }
 
-    if (writer != NULL) {
-        endpointDescriptorWriter_destroy(writer);
+    return rv;
+}
+
+/**
+ * Writes the endpoint list with its version. If delta is true, only the endpoints changed since the given version are
+ * written, endpoints removed since then are listed in the removed header. Should be called with the serverLock taken.
+ */
+static int endpointDiscoveryServer_writeVersionedEndpoints(endpoint_discovery_server_t *server, struct mg_connection* conn, bool delta, unsigned long since) {
+    int rv = CIVETWEB_REQUEST_NOT_HANDLED;
+
+    char etag[64];
+    snprintf(etag, sizeof(etag), "%lu.%lu", server->epoch, server->version);
+
+    array_list_pt endpoints = NULL;
+    char *removed = NULL;
+    size_t removedSize = 0;
+    FILE *removedStream = NULL;
+
+    if (delta) {
+        arrayList_create(&endpoints);
+        removedStream = open_memstream(&removed, &removedSize);
+        hash_map_pt seen = hashMap_create(utils_stringHash, NULL, utils_stringEquals, NULL);
+
+        // newest change first, the current state of an endpoint decides whether it is added (or changed) or removed
+        for (unsigned long version = server->version; version > since; version--) {
+            endpoint_discovery_server_change_t *change = &server->changes[(version - 2) % CHANGE_LOG_SIZE];
+            if (hashMap_containsKey(seen, change->endpointId)) {
+                continue;
+            }
+            hashMap_put(seen, change->endpointId, change);
+
+            endpoint_description_t *endpoint = hashMap_get(server->entries, change->endpointId);
+            if (endpoint != NULL) {
+                arrayList_add(endpoints, endpoint);
+            } else if (removedStream != NULL) {
+                fprintf(removedStream, "%s%s", ftell(removedStream) > 0 ? "," : "", change->endpointId);
+            }
+        }
+        hashMap_destroy(seen, false, false);
+        if (removedStream != NULL) {
+            fclose(removedStream);
+        }
+    }
+
+    char *headers = NULL;
+    bool hasRemoved = removed != NULL && removed[0] != '\0';
+    if (asprintf(&headers, "ETag: \"%s\"\r\n" DISCOVERY_DELTA_HEADER ": %s\r\n%s%s%s", etag, delta ? "true" : "false",
+                 hasRemoved ? DISCOVERY_REMOVED_HEADER ": " : "", hasRemoved ? removed : "", hasRemoved ? "\r\n" : "") >= 0) {
+        if (delta) {
+            rv = endpointDiscoveryServer_writeEndpoints(conn, endpoints, headers);
+        } else {
+            rv = endpointDiscoveryServer_writeAllEndpoints(server, conn, headers);
+        }
+        free(headers);
+    }
+
+    if (endpoints != NULL) {
+        arrayList_destroy(endpoints);
     }
+    free(removed);
 
     return rv;
 }
 
-// returns all endpoints as XML...
-static int endpointDiscoveryServer_returnAllEndpoints(endpoint_discovery_server_t *server, struct mg_connection* conn) {
+/**
+ * Returns the endpoints changed since the version in the since parameter, or all endpoints if that version is
+ * unknown. If nothing changed, the request waits up to the wait parameter (ms) for a change and returns 304 otherwise.
+ */
+static int endpointDiscoveryServer_returnVersionedEndpoints(endpoint_discovery_server_t *server, struct mg_connection* conn, const char *query) {
     int status = CIVETWEB_REQUEST_NOT_HANDLED;
 
-    array_list_pt endpoints = NULL;
+    char sinceParam[64];
+    char waitParam[16];
+    bool hasSince = mg_get_var(query, strlen(query), DISCOVERY_SINCE_PARAM, sinceParam, sizeof(sinceParam)) > 0;
+    long waitInMs = mg_get_var(query, strlen(query), DISCOVERY_WAIT_PARAM, waitParam, sizeof(waitParam)) > 0 ? atol(waitParam) : 0;
+    if (waitInMs > MAX_WAIT_IN_MS) {
+        waitInMs = MAX_WAIT_IN_MS;
+    }
 
     if (celixThreadMutex_lock(&server->serverLock) == CELIX_SUCCESS) {
-        endpointDiscoveryServer_getEndpoints(server, NULL, &endpoints);
-        if (endpoints) {
-            status = endpointDiscoveryServer_writeEndpoints(conn, endpoints);
+        unsigned long since = 0;
+        bool known = hasSince && endpointDiscoveryServer_parseVersion(server, sinceParam, &since);
+
+        if (known && waitInMs > 0) {
+            struct timespec deadline;
+            clock_gettime(CLOCK_MONOTONIC, &deadline);
+            deadline.tv_sec += waitInMs / 1000;
+            deadline.tv_nsec += (waitInMs % 1000) * 1000000L;
+
+            while (server->version == since && !server->stopping) {
+                struct timespec now;
+                clock_gettime(CLOCK_MONOTONIC, &now);
+                long remainingInMs = (deadline.tv_sec - now.tv_sec) * 1000 + (deadline.tv_nsec - now.tv_nsec) / 1000000L;
+                if (remainingInMs <= 0) {
+                    break;
+                }
+                celixThreadCondition_timedwaitRelative(&server->changedCond, &server->serverLock, remainingInMs / 1000, (remainingInMs % 1000) * 1000000L);
+            }
+        }
 
-            arrayList_destroy(endpoints);
+        if (known && server->version == since) {
+            char etag[64];
+            snprintf(etag, sizeof(etag), "%lu.%lu", server->epoch, server->version);
+            mg_printf(conn, not_modified_response_headers_format, etag);
+            status = CIVETWEB_REQUEST_HANDLED;
+        } else {
+            status = endpointDiscoveryServer_writeVersionedEndpoints(server, conn, known, since);
         }
 
+        celixThreadMutex_unlock(&server->serverLock);
+    }
+
+    return status;
+}
+
+// returns all endpoints, or 304 if the If-None-Match header has the current version...
+static int endpointDiscoveryServer_returnAllEndpoints(endpoint_discovery_server_t *server, struct mg_connection* conn) {
+    int status = CIVETWEB_REQUEST_NOT_HANDLED;
+
+    if (celixThreadMutex_lock(&server->serverLock) == CELIX_SUCCESS) {
+        char etag[64];
+        snprintf(etag, sizeof(etag), "%lu.%lu", server->epoch, server->version);
+        char headers[96];
+        snprintf(headers, sizeof(headers), "ETag: \"%s\"\r\n", etag);
+
+        const char *ifNoneMatch = mg_get_header(conn, "If-None-Match");
+        if (ifNoneMatch != NULL && strstr(ifNoneMatch, etag) != NULL) {
+            mg_printf(conn, not_modified_plain_response_headers_format, etag);
+            status = CIVETWEB_REQUEST_HANDLED;
+        } else {
+            status = endpointDiscoveryServer_writeAllEndpoints(server, conn, headers);
+        }
 
         celixThreadMutex_unlock(&server->serverLock);
     }
@@ -383,7 +721,7 @@ static int endpointDiscoveryServer_returnEndpoint(endpoint_discovery_server_t *s
     if (celixThreadMutex_lock(&server->serverLock) == CELIX_SUCCESS) {
         endpointDiscoveryServer_getEndpoints(server, endpoint_id, &endpoints);
         if (endpoints) {
-            status = endpointDiscoveryServer_writeEndpoints(conn, endpoints);
+            status = endpointDiscoveryServer_writeEndpoints(conn, endpoints, "");
 
             arrayList_destroy(endpoints);
         }
@@ -407,7 +745,9 @@ static int endpointDiscoveryServer_callback(struct mg_connection* conn) {
 
         if (strncmp(server->path, uri, strlen(server->path)) == 0) {
             // Be lenient when it comes to the trailing slash...
-            if (path_len == uri_len || (uri_len == (path_len + 1) && uri[path_len] == '/')) {
+            if ((path_len == uri_len || (uri_len == (path_len + 1) && uri[path_len] == '/')) && request_info->query_string != NULL) {
+                status = endpointDiscoveryServer_returnVersionedEndpoints(server, conn, request_info->query_string);
+            } else if (path_len == uri_len || (uri_len == (path_len + 1) && uri[path_len] == '/')) {
                 status = endpointDiscoveryServer_returnAllEndpoints(server, conn);
             } else {
                 const char* endpoint_id = uri + path_len + 1; // right after the slash...
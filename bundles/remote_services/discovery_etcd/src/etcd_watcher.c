@@ -32,6 +32,7 @@
 #include "log_helper.h"
 #include "log_service.h"
 #include "celix_constants.h"
+#include "celix_bundle_context.h"
 #include "utils.h"
 #include "discovery.h"
 #include "discovery_impl.h"
@@ -52,6 +53,10 @@ struct etcd_watcher {
     celix_thread_mutex_t watcherLock;
     celix_thread_t watcherThread;
 
+    int apiVersion;
+    int ttl;
+    long long leaseId; //lease of the own framework entry (etcd v3 only), 0 if no lease is granted
+
     volatile bool running;
 };
 
@@ -73,6 +78,10 @@ struct etcd_watcher {
 #define CFG_ETCD_TTL   				"DISCOVERY_ETCD_TTL"
 #define DEFAULT_ETCD_TTL 			30
 
+// 2 uses the etcd v2 API, 3 the etcd v3 API (a single watch stream and a lease for the own framework entry)
+#define CFG_ETCD_API_VERSION		"DISCOVERY_ETCD_API_VERSION"
+#define DEFAULT_ETCD_API_VERSION	2
+
 
 // note that the rootNode shouldn't have a leading slash
 static celix_status_t etcdWatcher_getRootPath(celix_bundle_context_t *context, char* rootNode) {
@@ -146,8 +155,7 @@ static celix_status_t etcdWatcher_addOwnFramework(etcd_watcher_t *watcher)
  	char url[MAX_VALUE_LENGTH];
     int modIndex;
     char* endpoints = NULL;
-    const char* ttlStr = NULL;
-    int ttl;
+    int ttl = watcher->ttl;
 
 	celix_bundle_context_t *context = watcher->discovery->context;
 	endpoint_discovery_server_t *server = watcher->discovery->server;
@@ -163,19 +171,6 @@ static celix_status_t etcdWatcher_addOwnFramework(etcd_watcher_t *watcher)
 
 	endpoints = url;
 
-    if ((bundleContext_getProperty(context, CFG_ETCD_TTL, &ttlStr) != CELIX_SUCCESS) || !ttlStr) {
-        ttl = DEFAULT_ETCD_TTL;
-    }
-    else
-    {
-        char* endptr = (char *) ttlStr;
-        errno = 0;
-        ttl = strtol(ttlStr, &endptr, 10);
-        if (*endptr || errno != 0) {
-            ttl = DEFAULT_ETCD_TTL;
-        }
-    }
-
 	if (etcdlib_get(watcher->etcdlib, localNodePath, &value, &modIndex) != ETCDLIB_RC_OK) {
 		etcdlib_set(watcher->etcdlib, localNodePath, endpoints, ttl, false);
 	}
@@ -244,6 +239,96 @@ static celix_status_t etcdWatcher_removeEntry(etcd_watcher_t *watcher, char* key
 }
 
 
+static celix_status_t etcdWatcher_v3_addOwnFramework(etcd_watcher_t *watcher) {
+	celix_status_t status;
+	char localNodePath[MAX_LOCALNODE_LENGTH];
+	char url[MAX_VALUE_LENGTH];
+
+	if ((status = etcdWatcher_getLocalNodePath(watcher->discovery->context, localNodePath)) != CELIX_SUCCESS) {
+		return status;
+	}
+
+	if (endpointDiscoveryServer_getUrl(watcher->discovery->server, url) != CELIX_SUCCESS) {
+		snprintf(url, MAX_VALUE_LENGTH, "http://%s:%s/%s", DEFAULT_SERVER_IP, DEFAULT_SERVER_PORT, DEFAULT_SERVER_PATH);
+	}
+
+	// the entry is attached to a lease, keeping the lease alive keeps the entry alive
+	if (watcher->leaseId == 0 && etcdlib_v3_lease_grant(watcher->etcdlib, watcher->ttl, &watcher->leaseId) != ETCDLIB_RC_OK) {
+		watcher->leaseId = 0;
+		status = CELIX_BUNDLE_EXCEPTION;
+	} else if (etcdlib_v3_put(watcher->etcdlib, localNodePath, url, watcher->leaseId) != ETCDLIB_RC_OK) {
+		status = CELIX_BUNDLE_EXCEPTION;
+	}
+
+	if (status != CELIX_SUCCESS) {
+		logHelper_log(*watcher->loghelper, OSGI_LOGSERVICE_WARNING, "Cannot register local discovery");
+	}
+
+	return status;
+}
+
+static void etcdWatcher_v3_addNode(const char *key, const char *value, void* arg) {
+	etcd_watcher_t *watcher = arg;
+	etcdWatcher_addEntry(watcher, (char *) key, (char *) value);
+}
+
+static void etcdWatcher_v3_onEvent(const char *action, const char *key, const char *value, long long revision, void *arg) {
+	etcd_watcher_t *watcher = arg;
+	if (strcmp(action, ETCDLIB_ACTION_SET) == 0) {
+		etcdWatcher_addEntry(watcher, (char *) key, (char *) value);
+	} else if (strcmp(action, ETCDLIB_ACTION_DELETE) == 0) {
+		// expired leases are reported as deletes
+		etcdWatcher_removeEntry(watcher, (char *) key, NULL);
+	}
+}
+
+/*
+ * retrieves the existing discovery endpoints with a single range request and then watches for
+ * changes with a single watch stream, which is interrupted every ttl/3 seconds to keep the lease
+ * of the own framework entry alive.
+ */
+static void* etcdWatcher_v3_run(void* data) {
+	etcd_watcher_t *watcher = (etcd_watcher_t *) data;
+	char rootPath[MAX_ROOTNODE_LENGTH];
+	char prefix[MAX_ROOTNODE_LENGTH + 1];
+	long long revision = 0;
+	int keepAliveInterval = watcher->ttl / 3 > 0 ? watcher->ttl / 3 : 1;
+
+	etcdWatcher_getRootPath(watcher->discovery->context, rootPath);
+	snprintf(prefix, sizeof(prefix), "%s%s", rootPath, rootPath[strlen(rootPath) - 1] == '/' ? "" : "/");
+
+	while (watcher->running && etcdlib_v3_get_range(watcher->etcdlib, prefix, etcdWatcher_v3_addNode, watcher, &revision) != ETCDLIB_RC_OK) {
+		sleep(1);
+	}
+
+	etcdlib_watch_stream_t *stream = etcdlib_v3_watch_stream_create(watcher->etcdlib);
+	if (stream == NULL || etcdlib_v3_watch_stream_add(stream, prefix, revision + 1, etcdWatcher_v3_onEvent, watcher) != ETCDLIB_RC_OK) {
+		logHelper_log(*watcher->loghelper, OSGI_LOGSERVICE_ERROR, "Cannot create etcd watch stream");
+		etcdlib_v3_watch_stream_destroy(stream);
+		return NULL;
+	}
+
+	time_t lastKeepAlive = time(NULL);
+	while (watcher->running) {
+		if (etcdlib_v3_watch_stream_run(stream, keepAliveInterval) == ETCDLIB_RC_ERROR && watcher->running) {
+			sleep(1);
+		}
+
+		if (watcher->running && time(NULL) - lastKeepAlive >= keepAliveInterval) {
+			if (watcher->leaseId == 0 || etcdlib_v3_lease_keepalive(watcher->etcdlib, watcher->leaseId) != ETCDLIB_RC_OK) {
+				// lease expired (or was never granted), register the own framework again
+				watcher->leaseId = 0;
+				etcdWatcher_v3_addOwnFramework(watcher);
+			}
+			lastKeepAlive = time(NULL);
+		}
+	}
+
+	etcdlib_v3_watch_stream_destroy(stream);
+
+	return NULL;
+}
+
 /*
  * performs (blocking) etcd_watch calls to check for
  * changing discovery endpoint information within etcd.
@@ -311,6 +396,7 @@ celix_status_t etcdWatcher_create(discovery_t *discovery, celix_bundle_context_t
 	const char* etcd_server = NULL;
 	const char* etcd_port_string = NULL;
 	int etcd_port = 0;
+	const char* ttlStr = NULL;
 
 	if (discovery == NULL) {
 		return CELIX_BUNDLE_EXCEPTION;
@@ -344,6 +430,21 @@ celix_status_t etcdWatcher_create(discovery_t *discovery, celix_bundle_context_t
 		}
 	}
 
+	if ((bundleContext_getProperty(context, CFG_ETCD_TTL, &ttlStr) != CELIX_SUCCESS) || !ttlStr) {
+		(*watcher)->ttl = DEFAULT_ETCD_TTL;
+	}
+	else
+	{
+		char* endptr = (char *) ttlStr;
+		errno = 0;
+		(*watcher)->ttl = strtol(ttlStr, &endptr, 10);
+		if (*endptr || errno != 0) {
+			(*watcher)->ttl = DEFAULT_ETCD_TTL;
+		}
+	}
+
+	(*watcher)->apiVersion = celix_bundleContext_getPropertyAsLong(context, CFG_ETCD_API_VERSION, DEFAULT_ETCD_API_VERSION) == 3 ? 3 : 2;
+
 	(*watcher)->etcdlib = etcdlib_create(etcd_server, etcd_port, CURL_GLOBAL_DEFAULT);
 	if ((*watcher)->etcdlib == NULL) {
 		status = CELIX_BUNDLE_EXCEPTION;
@@ -352,15 +453,23 @@ celix_status_t etcdWatcher_create(discovery_t *discovery, celix_bundle_context_t
 	}
 
     if (status == CELIX_SUCCESS) {
-        etcdWatcher_addOwnFramework(*watcher);
+        if ((*watcher)->apiVersion == 3) {
+            etcdWatcher_v3_addOwnFramework(*watcher);
+        } else {
+            etcdWatcher_addOwnFramework(*watcher);
+        }
         status = celixThreadMutex_create(&(*watcher)->watcherLock, NULL);
     }
 
     if (status == CELIX_SUCCESS) {
         if (celixThreadMutex_lock(&(*watcher)->watcherLock) == CELIX_SUCCESS) {
-            status = celixThread_create(&(*watcher)->watcherThread, NULL, etcdWatcher_run, *watcher);
+            // running is set before the thread starts, the v3 watcher thread checks it before the first watch
+            (*watcher)->running = true;
+            status = celixThread_create(&(*watcher)->watcherThread, NULL, (*watcher)->apiVersion == 3 ? etcdWatcher_v3_run : etcdWatcher_run, *watcher);
             if (status == CELIX_SUCCESS) {
-                (*watcher)->running = true;
+                celixThread_setName(&(*watcher)->watcherThread, "EtcdWatcher");
+            } else {
+                (*watcher)->running = false;
             }
             celixThreadMutex_unlock(&(*watcher)->watcherLock);
         }
@@ -378,12 +487,22 @@ celix_status_t etcdWatcher_destroy(etcd_watcher_t *watcher) {
 	watcher->running = false;
 	celixThreadMutex_unlock(&watcher->watcherLock);
 
+	if (watcher->apiVersion == 3) {
+		// stops the running watch stream right away
+		etcdlib_interrupt(watcher->etcdlib);
+	}
+
 	celixThread_join(watcher->watcherThread, NULL);
 
 	// register own framework
 	status = etcdWatcher_getLocalNodePath(watcher->discovery->context, localNodePath);
 
-	if (status != CELIX_SUCCESS || etcdlib_del(watcher->etcdlib, localNodePath) == false)
+	if (watcher->apiVersion == 3) {
+		// revoking the lease also deletes the own framework entry
+		if (watcher->leaseId != 0 && etcdlib_v3_lease_revoke(watcher->etcdlib, watcher->leaseId) != ETCDLIB_RC_OK) {
+			logHelper_log(*watcher->loghelper, OSGI_LOGSERVICE_WARNING, "Cannot remove local discovery registration.");
+		}
+	} else if (status != CELIX_SUCCESS || etcdlib_del(watcher->etcdlib, localNodePath) == false)
 	{
 		logHelper_log(*watcher->loghelper, OSGI_LOGSERVICE_WARNING, "Cannot remove local discovery registration.");
 	}
@@ -27,12 +27,21 @@
 #include <stdio.h>
 #include <pthread.h>
 #include <stdlib.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <limits.h>
 #include <string.h>
+#include <errno.h>
 #include <time.h>
+#include <unistd.h>
 
 #include <sys/types.h>
 #include <sys/sem.h>
 #include <sys/shm.h>
+#ifdef __linux__
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#endif
 
 #include <celix_errno.h>
 #include <celix_threads.h>
@@ -41,7 +50,8 @@
 
 #define DISCOVERY_SHM_MEMSIZE 262144
 #define DISCOVERY_SHM_FILENAME "/dev/null"
-#define DISCOVERY_SHM_FTOK_ID 50
+// bumped from 50 when the generation counter was added, so old layouts are never attached
+#define DISCOVERY_SHM_FTOK_ID 51
 #define DISCOVERY_SEM_FILENAME "/dev/null"
 #define DISCOVERY_SEM_FTOK_ID 54
 
@@ -50,6 +60,7 @@ struct shmEntry {
     char value[SHM_ENTRY_MAX_VALUE_LENGTH];
 
     time_t expires;
+    uint32_t generation; // generation in which the entry was added or its value last changed
 };
 
 typedef struct shmEntry shmEntry;
@@ -60,12 +71,61 @@ struct shmData {
     int shmId;
 
     celix_thread_mutex_t globalLock;
+
+    uint32_t generation; // futex word, bumped on every add, value change and removal
+    uint32_t waiters;
 };
 
 void* shmAddress;
 
 static celix_status_t discoveryShm_removeWithIndex(shmData_t *data, int index);
 
+static void discoveryShm_futexWait(uint32_t *addr, uint32_t val, unsigned int timeoutInMs) {
+#ifdef __linux__
+    struct timespec ts;
+    ts.tv_sec = timeoutInMs / 1000;
+    ts.tv_nsec = (long)(timeoutInMs % 1000) * 1000000L;
+    //note no FUTEX_PRIVATE_FLAG, the futex word is shared between processes
+    syscall(SYS_futex, addr, FUTEX_WAIT, val, &ts, NULL, 0);
+#else
+    (void)addr;
+    (void)val;
+    struct timespec ts = {0, 100000000L};
+    if (timeoutInMs < 100) {
+        ts.tv_nsec = (long)timeoutInMs * 1000000L;
+    }
+    nanosleep(&ts, NULL);
+#endif
+}
+
+static void discoveryShm_futexWake(uint32_t *addr) {
+#ifdef __linux__
+    syscall(SYS_futex, addr, FUTEX_WAKE, INT_MAX, NULL, NULL, 0);
+#else
+    (void)addr;
+#endif
+}
+
+/* bumps the generation and wakes all watchers, returns the new generation */
+static uint32_t discoveryShm_signal(shmData_t *data) {
+    uint32_t generation = __atomic_add_fetch(&data->generation, 1, __ATOMIC_SEQ_CST);
+    if (__atomic_load_n(&data->waiters, __ATOMIC_SEQ_CST) > 0) {
+        discoveryShm_futexWake(&data->generation);
+    }
+    return generation;
+}
+
+/* locks the global lock, recovering it when the previous owner died while holding it */
+static celix_status_t discoveryShm_lock(shmData_t *data) {
+    celix_status_t status = celixThreadMutex_lock(&data->globalLock);
+#ifdef LINUX
+    if (status == EOWNERDEAD) {
+        status = pthread_mutex_consistent(&data->globalLock);
+    }
+#endif
+    return status;
+}
+
 /* returns the ftok key to identify shared memory*/
 static key_t discoveryShm_getKey() {
     return ftok(DISCOVERY_SHM_FILENAME, DISCOVERY_SHM_FTOK_ID);
@@ -98,6 +158,11 @@ celix_status_t discoveryShm_create(shmData_t **data) {
         }
 #endif
 
+        if (status == CELIX_SUCCESS) {
+            // the lock lives in the segment and is shared by all attached frameworks
+            status = pthread_mutexattr_setpshared(&threadAttr, PTHREAD_PROCESS_SHARED);
+        }
+
         if (status == CELIX_SUCCESS) {
             status = celixThreadMutex_create(&shmData->globalLock, &threadAttr);
         }
@@ -137,22 +202,24 @@ celix_status_t discoveryShm_attach(shmData_t **data) {
 static celix_status_t discoveryShm_getwithIndex(shmData_t *data, char* key, char* value, int* index) {
     celix_status_t status = CELIX_BUNDLE_EXCEPTION;
     time_t currentTime = time(NULL);
-    unsigned int i;
+    int i = 0;
 
-    for (i = 0; i < data->numOfEntries && status != CELIX_SUCCESS; i++) {
-        shmEntry entry = data->entries[i];
-        // check if entry is still valid
-        if (data->entries[i].expires < currentTime) {
+    while (i < data->numOfEntries && status != CELIX_SUCCESS) {
+        shmEntry *entry = &data->entries[i];
+        // check if entry is still valid, removal shifts the next entry into this index
+        if (entry->expires < currentTime) {
             discoveryShm_removeWithIndex(data, i);
-        } else if (strcmp(entry.key, key) == 0) {
+            continue;
+        } else if (strcmp(entry->key, key) == 0) {
             if (value) {
-                strcpy(value, entry.value);
+                strcpy(value, entry->value);
             }
             if (index) {
                 (*index) = i;
             }
             status = CELIX_SUCCESS;
         }
+        i++;
     }
 
     return status;
@@ -161,7 +228,7 @@ static celix_status_t discoveryShm_getwithIndex(shmData_t *data, char* key, char
 celix_status_t discoveryShm_getKeys(shmData_t *data, char** keys, int* size) {
     celix_status_t status;
 
-    status = celixThreadMutex_lock(&data->globalLock);
+    status = discoveryShm_lock(data);
 
     if (status == CELIX_SUCCESS) {
     	unsigned int i = 0;
@@ -188,21 +255,29 @@ celix_status_t discoveryShm_set(shmData_t *data, char *key, char* value) {
     if (data->numOfEntries >= SHM_DATA_MAX_ENTRIES) {
         status = CELIX_ILLEGAL_STATE;
     } else {
-        status = celixThreadMutex_lock(&data->globalLock);
+        status = discoveryShm_lock(data);
 
         if (status == CELIX_SUCCESS) {
+            bool changed = false;
+
             // check if key already there
             status = discoveryShm_getwithIndex(data, key, NULL, &index);
             if (status != CELIX_SUCCESS) {
                 index = data->numOfEntries;
 
                 snprintf(data->entries[index].key, SHM_ENTRY_MAX_KEY_LENGTH, "%s", key);
+                data->entries[index].value[0] = '\0';
                 data->numOfEntries++;
+                changed = true;
 
                  status = CELIX_SUCCESS;
             }
 
-            snprintf(data->entries[index].value, SHM_ENTRY_MAX_VALUE_LENGTH, "%s", value);
+            // a plain ttl refresh does not wake the watchers
+            if (changed || strncmp(data->entries[index].value, value, SHM_ENTRY_MAX_VALUE_LENGTH - 1) != 0) {
+                snprintf(data->entries[index].value, SHM_ENTRY_MAX_VALUE_LENGTH, "%s", value);
+                data->entries[index].generation = discoveryShm_signal(data);
+            }
             data->entries[index].expires = (time(NULL) + SHM_ENTRY_DEFAULT_TTL);
 
             celixThreadMutex_unlock(&data->globalLock);
@@ -215,7 +290,7 @@ celix_status_t discoveryShm_set(shmData_t *data, char *key, char* value) {
 celix_status_t discoveryShm_get(shmData_t *data, char* key, char* value) {
     celix_status_t status;
 
-    status = celixThreadMutex_lock(&data->globalLock);
+    status = discoveryShm_lock(data);
 
     if (status == CELIX_SUCCESS) {
         status = discoveryShm_getwithIndex(data, key, value, NULL);
@@ -231,9 +306,11 @@ static celix_status_t discoveryShm_removeWithIndex(shmData_t *data, int index) {
 
     data->numOfEntries--;
     if (index < data->numOfEntries) {
-        memcpy((void*) &data->entries[index], (void*) &data->entries[index + 1], ((data->numOfEntries - index) * sizeof(struct shmEntry)));
+        memmove((void*) &data->entries[index], (void*) &data->entries[index + 1], ((data->numOfEntries - index) * sizeof(struct shmEntry)));
     }
 
+    discoveryShm_signal(data);
+
     return status;
 }
 
@@ -241,7 +318,7 @@ celix_status_t discoveryShm_remove(shmData_t *data, char* key) {
     celix_status_t status;
     int index = -1;
 
-    status = celixThreadMutex_lock(&data->globalLock);
+    status = discoveryShm_lock(data);
 
     if (status == CELIX_SUCCESS) {
         status = discoveryShm_getwithIndex(data, key, NULL, &index);
@@ -256,6 +333,64 @@ celix_status_t discoveryShm_remove(shmData_t *data, char* key) {
     return status;
 }
 
+celix_status_t discoveryShm_getEntries(shmData_t *data, uint32_t sinceGeneration, discoveryShm_entry_fp callback, void *handle, uint32_t *generation) {
+    celix_status_t status;
+
+    status = discoveryShm_lock(data);
+
+    if (status == CELIX_SUCCESS) {
+        time_t currentTime = time(NULL);
+        int i = 0;
+
+        // drop expired entries first, so the returned generation already covers their removal
+        while (i < data->numOfEntries) {
+            if (data->entries[i].expires < currentTime) {
+                discoveryShm_removeWithIndex(data, i);
+            } else {
+                i++;
+            }
+        }
+
+        for (i = 0; i < data->numOfEntries; i++) {
+            shmEntry *entry = &data->entries[i];
+            bool changed = (int32_t)(entry->generation - sinceGeneration) > 0;
+            callback(handle, entry->key, entry->value, changed);
+        }
+
+        if (generation) {
+            (*generation) = __atomic_load_n(&data->generation, __ATOMIC_SEQ_CST);
+        }
+
+        celixThreadMutex_unlock(&data->globalLock);
+    }
+
+    return status;
+}
+
+uint32_t discoveryShm_getGeneration(shmData_t *data) {
+    return __atomic_load_n(&data->generation, __ATOMIC_SEQ_CST);
+}
+
+celix_status_t discoveryShm_waitForChange(shmData_t *data, uint32_t knownGeneration, unsigned int timeoutInMs) {
+    celix_status_t status = CELIX_SUCCESS;
+
+    __atomic_add_fetch(&data->waiters, 1, __ATOMIC_SEQ_CST);
+    if (__atomic_load_n(&data->generation, __ATOMIC_SEQ_CST) == knownGeneration) {
+        discoveryShm_futexWait(&data->generation, knownGeneration, timeoutInMs);
+    }
+    __atomic_sub_fetch(&data->waiters, 1, __ATOMIC_SEQ_CST);
+
+    if (__atomic_load_n(&data->generation, __ATOMIC_SEQ_CST) == knownGeneration) {
+        status = CELIX_ILLEGAL_STATE;
+    }
+
+    return status;
+}
+
+void discoveryShm_notify(shmData_t *data) {
+    discoveryShm_signal(data);
+}
+
 celix_status_t discoveryShm_detach(shmData_t *data) {
     celix_status_t status = CELIX_BUNDLE_EXCEPTION;
 
@@ -27,6 +27,9 @@
 #ifndef _DISCOVERY_SHM_H_
 #define _DISCOVERY_SHM_H_
 
+#include <stdbool.h>
+#include <stdint.h>
+
 #include <celix_errno.h>
 
 #define SHM_ENTRY_MAX_KEY_LENGTH	256
@@ -40,6 +43,9 @@
 
 typedef struct shmData shmData_t;
 
+/* called for every valid entry, changed is true when the entry was added or its value changed after the given generation */
+typedef void (*discoveryShm_entry_fp)(void *handle, const char *key, const char *value, bool changed);
+
 /* creates a new shared memory block */
 celix_status_t discoveryShm_create(shmData_t **data);
 celix_status_t discoveryShm_attach(shmData_t **data);
@@ -47,6 +53,14 @@ celix_status_t discoveryShm_set(shmData_t *data, char *key, char* value);
 celix_status_t discoveryShm_get(shmData_t *data, char* key, char* value);
 celix_status_t discoveryShm_getKeys(shmData_t *data, char** keys, int* size);
 celix_status_t discoveryShm_remove(shmData_t *data, char* key);
+
+/* visits all valid entries under the lock and returns the generation they reflect */
+celix_status_t discoveryShm_getEntries(shmData_t *data, uint32_t sinceGeneration, discoveryShm_entry_fp callback, void *handle, uint32_t *generation);
+uint32_t discoveryShm_getGeneration(shmData_t *data);
+/* blocks until the generation differs from knownGeneration, returns CELIX_ILLEGAL_STATE on timeout */
+celix_status_t discoveryShm_waitForChange(shmData_t *data, uint32_t knownGeneration, unsigned int timeoutInMs);
+/* wakes all waiting watchers, e.g. to let a watcher thread stop */
+void discoveryShm_notify(shmData_t *data);
 celix_status_t discoveryShm_detach(shmData_t *data);
 celix_status_t discoveryShm_destroy(shmData_t *data);
 
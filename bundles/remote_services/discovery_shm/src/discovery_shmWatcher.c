@@ -29,7 +29,10 @@
 #include <unistd.h>
 #include <string.h>
 #include <stdio.h>
+#include <time.h>
 
+#include "hash_map.h"
+#include "utils.h"
 
 #include "celix_log.h"
 #include "celix_constants.h"
@@ -48,12 +51,18 @@
 #define MAX_ROOTNODE_LENGTH		 64
 #define MAX_LOCALNODE_LENGTH	256
 
+// seconds between refreshes of the own registration, changes of others are signalled immediately
+#define DISCOVERY_SHM_REFRESH_INTERVAL	(SHM_ENTRY_DEFAULT_TTL / 4)
+
 
 struct shm_watcher {
     shmData_t *shmData;
     celix_thread_t watcherThread;
     celix_thread_mutex_t watcherLock;
 
+    hash_map_pt entries; // shm key -> struct shm_watcher_entry, only used by the watcher thread
+    uint32_t generation; // shm generation of the last sync
+
     volatile bool running;
 };
 
@@ -88,68 +97,87 @@ static celix_status_t discoveryShmWatcher_getLocalNodePath(celix_bundle_context_
     return status;
 }
 
-/* retrieves all endpoints from shm and syncs them with the ones already available */
-static celix_status_t discoveryShmWatcher_syncEndpoints(discovery_t *discovery) {
-    celix_status_t status = CELIX_SUCCESS;
-    shm_watcher_t *watcher = discovery->pImpl->watcher;
-    char** shmKeyArr = calloc(SHM_DATA_MAX_ENTRIES, sizeof(*shmKeyArr));
-    array_list_pt registeredKeyArr = NULL;
+struct shm_watcher_entry {
+    char *url;
+    bool seen;
+};
 
-    int i, j, shmSize;
+struct shm_watcher_sync {
+    shm_watcher_t *watcher;
+    array_list_pt added;
+    array_list_pt removed;
+};
 
-    for (i = 0; i < SHM_DATA_MAX_ENTRIES; i++) {
-        shmKeyArr[i] = calloc(SHM_ENTRY_MAX_KEY_LENGTH, sizeof(*shmKeyArr[i]));
+/* called with the shm lock held, only records the differences */
+static void discoveryShmWatcher_visitEntry(void *handle, const char *key, const char *value, bool changed) {
+    struct shm_watcher_sync *sync = handle;
+    struct shm_watcher_entry *entry = hashMap_get(sync->watcher->entries, key);
+
+    if (entry == NULL) {
+        entry = calloc(1, sizeof(*entry));
+        entry->url = strdup(value);
+        hashMap_put(sync->watcher->entries, strdup(key), entry);
+        arrayList_add(sync->added, strdup(value));
+    } else if (changed && strcmp(entry->url, value) != 0) {
+        arrayList_add(sync->removed, entry->url);
+        entry->url = strdup(value);
+        arrayList_add(sync->added, strdup(value));
     }
 
-    arrayList_create(&registeredKeyArr);
-
-    // get all urls available in shm
-    discoveryShm_getKeys(watcher->shmData, shmKeyArr, &shmSize);
-
-    // get all locally registered endpoints
-    endpointDiscoveryPoller_getDiscoveryEndpoints(discovery->poller, registeredKeyArr);
-
-    // add discovery points which are in shm, but not local yet
-    for (i = 0; i < shmSize; i++) {
-        char url[SHM_ENTRY_MAX_VALUE_LENGTH];
+    entry->seen = true;
+}
 
-        if (discoveryShm_get(watcher->shmData, shmKeyArr[i], &url[0]) == CELIX_SUCCESS) {
-            bool elementFound = false;
+/* applies the entries changed since the last sync to the poller */
+static celix_status_t discoveryShmWatcher_syncEndpoints(discovery_t *discovery) {
+    celix_status_t status;
+    shm_watcher_t *watcher = discovery->pImpl->watcher;
+    struct shm_watcher_sync sync;
+    uint32_t generation = watcher->generation;
+    int i;
 
-            for (j = 0; j < arrayList_size(registeredKeyArr) && elementFound == false; j++) {
+    sync.watcher = watcher;
+    arrayList_create(&sync.added);
+    arrayList_create(&sync.removed);
 
-                if (strcmp(url, (char*) arrayList_get(registeredKeyArr, j)) == 0) {
-                    free(arrayList_remove(registeredKeyArr, j));
-                    elementFound = true;
-                }
-            }
+    status = discoveryShm_getEntries(watcher->shmData, watcher->generation, discoveryShmWatcher_visitEntry, &sync, &generation);
 
-            if (elementFound == false) {
-                endpointDiscoveryPoller_addDiscoveryEndpoint(discovery->poller, url);
+    if (status == CELIX_SUCCESS) {
+        hash_map_iterator_pt iter = hashMapIterator_create(watcher->entries);
+
+        // entries which were not visited are gone from shm
+        while (hashMapIterator_hasNext(iter)) {
+            hash_map_entry_pt mapEntry = hashMapIterator_nextEntry(iter);
+            struct shm_watcher_entry *entry = hashMapEntry_getValue(mapEntry);
+
+            if (entry->seen) {
+                entry->seen = false;
+            } else {
+                char *key = hashMapEntry_getKey(mapEntry);
+                hashMapIterator_remove(iter);
+                arrayList_add(sync.removed, entry->url);
+                free(entry);
+                free(key);
             }
         }
-    }
+        hashMapIterator_destroy(iter);
 
-    // remove those which are not in shm
-    for (i = 0; i < arrayList_size(registeredKeyArr); i++) {
-        char* regUrl = arrayList_get(registeredKeyArr, i);
-
-        if (regUrl != NULL) {
-            endpointDiscoveryPoller_removeDiscoveryEndpoint(discovery->poller, regUrl);
-        }
+        watcher->generation = generation;
     }
 
-    for (i = 0; i < SHM_DATA_MAX_ENTRIES; i++) {
-        free(shmKeyArr[i]);
+    for (i = 0; i < arrayList_size(sync.removed); i++) {
+        char *url = arrayList_get(sync.removed, i);
+        endpointDiscoveryPoller_removeDiscoveryEndpoint(discovery->poller, url);
+        free(url);
     }
 
-    free(shmKeyArr);
-
-    for (j = 0; j < arrayList_size(registeredKeyArr); j++) {
-        free(arrayList_get(registeredKeyArr, j));
+    for (i = 0; i < arrayList_size(sync.added); i++) {
+        char *url = arrayList_get(sync.added, i);
+        endpointDiscoveryPoller_addDiscoveryEndpoint(discovery->poller, url);
+        free(url);
     }
 
-    arrayList_destroy(registeredKeyArr);
+    arrayList_destroy(sync.added);
+    arrayList_destroy(sync.removed);
 
     return status;
 }
@@ -159,6 +187,7 @@ static void* discoveryShmWatcher_run(void* data) {
     shm_watcher_t *watcher = discovery->pImpl->watcher;
     char localNodePath[MAX_LOCALNODE_LENGTH];
     char url[MAX_LOCALNODE_LENGTH];
+    time_t nextRefresh = 0;
 
     if (discoveryShmWatcher_getLocalNodePath(discovery->context, &localNodePath[0]) != CELIX_SUCCESS) {
         logHelper_log(discovery->loghelper, OSGI_LOGSERVICE_WARNING, "Cannot retrieve local discovery path.");
@@ -169,13 +198,26 @@ static void* discoveryShmWatcher_run(void* data) {
     }
 
     while (watcher->running) {
-        // register own framework
-        if (discoveryShm_set(watcher->shmData, localNodePath, url) != CELIX_SUCCESS) {
-            logHelper_log(discovery->loghelper, OSGI_LOGSERVICE_WARNING, "Cannot set local discovery registration.");
+        time_t now = time(NULL);
+        bool refresh = now >= nextRefresh;
+
+        if (refresh) {
+            // register own framework, a refresh well within the ttl only extends the expiry
+            if (discoveryShm_set(watcher->shmData, localNodePath, url) != CELIX_SUCCESS) {
+                logHelper_log(discovery->loghelper, OSGI_LOGSERVICE_WARNING, "Cannot set local discovery registration.");
+            }
+            nextRefresh = now + DISCOVERY_SHM_REFRESH_INTERVAL;
         }
 
-        discoveryShmWatcher_syncEndpoints(discovery);
-        sleep(5);
+        // the periodic sync also purges entries of frameworks which died without removing them
+        if (refresh || discoveryShm_getGeneration(watcher->shmData) != watcher->generation) {
+            discoveryShmWatcher_syncEndpoints(discovery);
+        }
+
+        if (watcher->running) {
+            long timeout = (long)(nextRefresh - time(NULL)) * 1000L;
+            discoveryShm_waitForChange(watcher->shmData, watcher->generation, timeout > 0 ? (unsigned int)timeout : 0);
+        }
     }
 
     return NULL;
@@ -203,6 +245,7 @@ celix_status_t discoveryShmWatcher_create(discovery_t *discovery) {
         }
 
         if (status == CELIX_SUCCESS) {
+            watcher->entries = hashMap_create(utils_stringHash, NULL, utils_stringEquals, NULL);
             discovery->pImpl->watcher = watcher;
         }
         else{
@@ -217,6 +260,9 @@ celix_status_t discoveryShmWatcher_create(discovery_t *discovery) {
         status += celixThreadMutex_lock(&watcher->watcherLock);
         watcher->running = true;
         status += celixThread_create(&watcher->watcherThread, NULL, discoveryShmWatcher_run, discovery);
+        if (status == CELIX_SUCCESS) {
+            celixThread_setName(&watcher->watcherThread, "ShmWatcher");
+        }
         status += celixThreadMutex_unlock(&watcher->watcherLock);
     }
 
@@ -232,6 +278,7 @@ celix_status_t discoveryShmWatcher_destroy(discovery_t *discovery) {
     watcher->running = false;
     celixThreadMutex_unlock(&watcher->watcherLock);
 
+    discoveryShm_notify(watcher->shmData);
     celixThread_join(watcher->watcherThread, NULL);
 
     // remove own framework
@@ -242,6 +289,17 @@ celix_status_t discoveryShmWatcher_destroy(discovery_t *discovery) {
     }
 
     if (status == CELIX_SUCCESS) {
+        hash_map_iterator_pt iter = hashMapIterator_create(watcher->entries);
+        while (hashMapIterator_hasNext(iter)) {
+            hash_map_entry_pt mapEntry = hashMapIterator_nextEntry(iter);
+            struct shm_watcher_entry *entry = hashMapEntry_getValue(mapEntry);
+            free(hashMapEntry_getKey(mapEntry));
+            free(entry->url);
+            free(entry);
+        }
+        hashMapIterator_destroy(iter);
+        hashMap_destroy(watcher->entries, false, false);
+
         discoveryShm_detach(watcher->shmData);
         free(watcher);
     }
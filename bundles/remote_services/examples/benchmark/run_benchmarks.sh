@@ -0,0 +1,56 @@
+#!/bin/bash
+# Licensed to the Apache Software Foundation (ASF) under one
+# or more contributor license agreements.  See the NOTICE file
+# distributed with this work for additional information
+# regarding copyright ownership.  The ASF licenses this file
+# to you under the Apache License, Version 2.0 (the
+# "License"); you may not use this file except in compliance
+# with the License.  You may obtain a copy of the License at
+#
+#   http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing,
+# software distributed under the License is distributed on an
+# "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+#  KIND, either express or implied.  See the License for the
+# specific language governing permissions and limitations
+# under the License.
+
+
+# Starts the rsa benchmark server, runs all (or the provided) benchmark clients against it and collects the results in
+# benchmark_results.json, a json object per line. The benchmark can be configured with the BENCHMARK_* environment
+# variables, e.g.
+#   BENCHMARK_CONCURRENCY=1,8 BENCHMARK_PAYLOAD_SIZES=0,1024 ./run_benchmarks.sh rsa_benchmark_client_avrobin
+# For a soak test run a single client for a long duration with periodic reports, e.g.
+#   BENCHMARK_SOAK=3600 ./run_benchmarks.sh rsa_benchmark_client_avrobin
+
+BENCHMARK_DIR=$(cd "$(dirname "$0")" && pwd)
+RESULTS=${BENCHMARK_DIR}/benchmark_results.json
+export BENCHMARK_DURATION=${BENCHMARK_DURATION:-5}
+export BENCHMARK_CONCURRENCY=${BENCHMARK_CONCURRENCY:-1,4,16}
+export BENCHMARK_PAYLOAD_SIZES=${BENCHMARK_PAYLOAD_SIZES:-0,16,1024,16384}
+export BENCHMARK_RESULT_FILE=${RESULTS}
+if [ -n "${BENCHMARK_SOAK}" ]; then
+    export BENCHMARK_DURATION=${BENCHMARK_SOAK}
+    export BENCHMARK_REPORT_INTERVAL=${BENCHMARK_REPORT_INTERVAL:-60}
+fi
+
+CLIENTS="$*"
+if [ -z "${CLIENTS}" ]; then
+    CLIENTS=$(cd "${BENCHMARK_DIR}" && ls -d rsa_benchmark_client_*/ | tr -d /)
+fi
+
+rm -f "${RESULTS}"
+(cd "${BENCHMARK_DIR}/rsa_benchmark_server" && exec ./rsa_benchmark_server > server.log 2>&1) &
+SERVER_PID=$!
+trap 'kill -INT ${SERVER_PID} 2>/dev/null; wait ${SERVER_PID}' EXIT
+export BENCHMARK_SERVER_PID=${SERVER_PID}
+sleep 2
+
+NR_OF_RUNS=$(( $(echo "${BENCHMARK_CONCURRENCY}" | tr ',' '\n' | wc -l) * $(echo "${BENCHMARK_PAYLOAD_SIZES}" | tr ',' '\n' | wc -l) ))
+for CLIENT in ${CLIENTS}; do
+    echo "Running ${CLIENT}"
+    #note the clients need some time to discover the calculator, SIGINT stops the framework if the runs do not complete
+    (cd "${BENCHMARK_DIR}/${CLIENT}" && timeout -s INT $((NR_OF_RUNS * BENCHMARK_DURATION + 30)) ./${CLIENT})
+done
+echo "Results written to ${RESULTS}"
@@ -0,0 +1,452 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *  KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <sys/resource.h>
+#include <unistd.h>
+
+#include "celix_api.h"
+#include "calculator_service.h"
+
+/**
+ * Config properties of the calculator benchmark.
+ */
+#define BENCHMARK_LABEL_KEY                 "BENCHMARK_LABEL" //e.g. the RSA and protocol, added to the results
+#define BENCHMARK_LABEL_DEFAULT             "rsa"
+#define BENCHMARK_RESULT_FILE_KEY           "BENCHMARK_RESULT_FILE" //a json object per report is appended
+#define BENCHMARK_RESULT_FILE_DEFAULT       "benchmark_results.json"
+#define BENCHMARK_DURATION_KEY              "BENCHMARK_DURATION" //seconds per concurrency and payload size
+#define BENCHMARK_DURATION_DEFAULT          5
+#define BENCHMARK_REPORT_INTERVAL_KEY       "BENCHMARK_REPORT_INTERVAL" //seconds, 0 reports once per run. Use for soak tests
+#define BENCHMARK_REPORT_INTERVAL_DEFAULT   0
+#define BENCHMARK_CONCURRENCY_KEY           "BENCHMARK_CONCURRENCY" //comma separated nrs of calling threads
+#define BENCHMARK_CONCURRENCY_DEFAULT       "1,4,16"
+#define BENCHMARK_PAYLOAD_SIZES_KEY         "BENCHMARK_PAYLOAD_SIZES" //comma separated nrs of doubles, 0 calls add instead of sum
+#define BENCHMARK_PAYLOAD_SIZES_DEFAULT     "0,16,1024,16384"
+#define BENCHMARK_SERVER_PID_KEY            "BENCHMARK_SERVER_PID" //if set, the cpu time and memory of the server process are reported
+#define BENCHMARK_SERVER_PORT_KEY           "BENCHMARK_SERVER_PORT" //the open tcp connections to this port are reported
+#define BENCHMARK_SERVER_PORT_DEFAULT       18890
+
+#define BENCHMARK_MAX_VALUES                16
+
+typedef struct calculator_benchmark calculator_benchmark_t;
+
+typedef struct benchmark_worker {
+    calculator_benchmark_t *bench;
+    celix_thread_t thread;
+    uint32_t payloadSize;
+
+    celix_thread_mutex_t mutex; //protects below, only contended when the results are collected
+    uint64_t *latencies; //ns
+    size_t nrOfLatencies;
+    size_t capOfLatencies;
+    unsigned long nrOfErrors;
+} benchmark_worker_t;
+
+struct calculator_benchmark {
+    celix_bundle_context_t *ctx;
+    const char *label;
+    const char *resultFile;
+    long duration;
+    long reportInterval;
+    long concurrency[BENCHMARK_MAX_VALUES];
+    int nrOfConcurrency;
+    long payloadSizes[BENCHMARK_MAX_VALUES];
+    int nrOfPayloadSizes;
+    long serverPid;
+    long serverPort;
+
+    long trackerId;
+    celix_thread_t thread;
+
+    celix_thread_mutex_t mutex; //protects below
+    celix_thread_cond_t cond;
+    bool running;
+    bool runWorkers;
+    int nrOfActiveWorkers;
+    calculator_service_t *calculator;
+};
+
+static uint64_t benchmark_now(void) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint64_t) now.tv_sec * 1000000000UL + (uint64_t) now.tv_nsec;
+}
+
+static int benchmark_parseList(const char *str, long *values) {
+    int count = 0;
+    char *copy = strdup(str);
+    char *savePtr = NULL;
+    for (char *token = strtok_r(copy, ", ", &savePtr); token != NULL && count < BENCHMARK_MAX_VALUES; token = strtok_r(NULL, ", ", &savePtr)) {
+        values[count++] = strtol(token, NULL, 10);
+    }
+    free(copy);
+    return count;
+}
+
+/* the user + system cpu time of the process in us, -1 if unknown */
+static long long benchmark_processCpuInUs(long pid) {
+    if (pid <= 0) {
+        struct rusage usage;
+        getrusage(RUSAGE_SELF, &usage);
+        return (long long) (usage.ru_utime.tv_sec + usage.ru_stime.tv_sec) * 1000000LL + usage.ru_utime.tv_usec + usage.ru_stime.tv_usec;
+    }
+
+    char path[64];
+    snprintf(path, sizeof(path), "/proc/%li/stat", pid);
+    FILE *file = fopen(path, "r");
+    if (file == NULL) {
+        return -1;
+    }
+    unsigned long utime = 0;
+    unsigned long stime = 0;
+    //skip pid, comm (without spaces for celix containers) and the 11 fields before utime
+    int rc = fscanf(file, "%*d %*s %*c %*d %*d %*d %*d %*d %*u %*u %*u %*u %*u %lu %lu", &utime, &stime);
+    fclose(file);
+    return rc == 2 ? (long long) (utime + stime) * 1000000LL / sysconf(_SC_CLK_TCK) : -1;
+}
+
+/* the resident memory of the process in kB, -1 if unknown */
+static long benchmark_processRssInKb(long pid) {
+    char path[64];
+    if (pid <= 0) {
+        snprintf(path, sizeof(path), "/proc/self/statm");
+    } else {
+        snprintf(path, sizeof(path), "/proc/%li/statm", pid);
+    }
+    FILE *file = fopen(path, "r");
+    if (file == NULL) {
+        return -1;
+    }
+    long pages = -1;
+    if (fscanf(file, "%*d %li", &pages) != 1) {
+        pages = -1;
+    }
+    fclose(file);
+    return pages < 0 ? -1 : pages * (sysconf(_SC_PAGESIZE) / 1024);
+}
+
+/* the nr of established tcp connections to the provided (remote) port */
+static int benchmark_nrOfConnections(long port) {
+    const char *files[] = {"/proc/net/tcp", "/proc/net/tcp6"};
+    int count = 0;
+    for (size_t i = 0; i < sizeof(files) / sizeof(files[0]); ++i) {
+        FILE *file = fopen(files[i], "r");
+        if (file == NULL) {
+            continue;
+        }
+        char line[256];
+        while (fgets(line, sizeof(line), file) != NULL) {
+            char remote[64];
+            unsigned int state = 0;
+            if (sscanf(line, " %*d: %*s %63s %x", remote, &state) == 2 && state == 0x01 /*ESTABLISHED*/) {
+                char *portStr = strrchr(remote, ':');
+                if (portStr != NULL && strtol(portStr + 1, NULL, 16) == port) {
+                    count += 1;
+                }
+            }
+        }
+        fclose(file);
+    }
+    return count;
+}
+
+static int benchmark_compareLatency(const void *a, const void *b) {
+    uint64_t l = *(const uint64_t *) a;
+    uint64_t r = *(const uint64_t *) b;
+    return l < r ? -1 : (l > r ? 1 : 0);
+}
+
+static uint64_t benchmark_percentile(const uint64_t *sorted, size_t size, double percentile) {
+    if (size == 0) {
+        return 0;
+    }
+    size_t index = (size_t) (percentile / 100.0 * (double) (size - 1) + 0.5);
+    return sorted[index];
+}
+
+static void benchmark_worker_record(benchmark_worker_t *worker, uint64_t latency, bool error) {
+    celixThreadMutex_lock(&worker->mutex);
+    if (error) {
+        worker->nrOfErrors += 1;
+    } else {
+        if (worker->nrOfLatencies == worker->capOfLatencies) {
+            size_t cap = worker->capOfLatencies == 0 ? 1024 : worker->capOfLatencies * 2;
+            uint64_t *latencies = realloc(worker->latencies, cap * sizeof(*latencies));
+            if (latencies != NULL) {
+                worker->latencies = latencies;
+                worker->capOfLatencies = cap;
+            }
+        }
+        if (worker->nrOfLatencies < worker->capOfLatencies) {
+            worker->latencies[worker->nrOfLatencies++] = latency;
+        }
+    }
+    celixThreadMutex_unlock(&worker->mutex);
+}
+
+static void* benchmark_worker_run(void *data) {
+    benchmark_worker_t *worker = data;
+    calculator_benchmark_t *bench = worker->bench;
+
+    calculator_values_t values;
+    values.len = worker->payloadSize;
+    values.cap = worker->payloadSize;
+    values.buf = calloc(worker->payloadSize > 0 ? worker->payloadSize : 1, sizeof(double));
+    for (uint32_t i = 0; i < values.len; ++i) {
+        values.buf[i] = i * 0.5;
+    }
+
+    celixThreadMutex_lock(&bench->mutex);
+    calculator_service_t *calc = bench->calculator;
+    while (bench->runWorkers && calc != NULL) {
+        celixThreadMutex_unlock(&bench->mutex);
+
+        double result = 0.0;
+        uint64_t start = benchmark_now();
+        int rc;
+        if (worker->payloadSize == 0) {
+            rc = calc->add(calc->calculator, 1.0, 2.0, &result);
+        } else {
+            rc = calc->sum(calc->calculator, values, &result);
+        }
+        benchmark_worker_record(worker, benchmark_now() - start, rc != 0);
+
+        celixThreadMutex_lock(&bench->mutex);
+        calc = bench->calculator;
+    }
+    bench->nrOfActiveWorkers -= 1;
+    celixThreadCondition_broadcast(&bench->cond);
+    celixThreadMutex_unlock(&bench->mutex);
+
+    free(values.buf);
+    return NULL;
+}
+
+/**
+ * Collects (and resets) the latencies of the workers and appends a report to the result file.
+ */
+static void benchmark_report(calculator_benchmark_t *bench, benchmark_worker_t *workers, int nrOfWorkers, uint32_t payloadSize,
+                             double duration, long long clientCpu, long long serverCpu) {
+    size_t nrOfCalls = 0;
+    unsigned long nrOfErrors = 0;
+    for (int i = 0; i < nrOfWorkers; ++i) {
+        celixThreadMutex_lock(&workers[i].mutex);
+        nrOfCalls += workers[i].nrOfLatencies;
+        celixThreadMutex_unlock(&workers[i].mutex);
+    }
+
+    uint64_t *latencies = calloc(nrOfCalls > 0 ? nrOfCalls : 1, sizeof(*latencies));
+    size_t size = 0;
+    for (int i = 0; i < nrOfWorkers; ++i) {
+        celixThreadMutex_lock(&workers[i].mutex);
+        size_t n = workers[i].nrOfLatencies < nrOfCalls - size ? workers[i].nrOfLatencies : nrOfCalls - size;
+        memcpy(latencies + size, workers[i].latencies, n * sizeof(*latencies));
+        size += n;
+        nrOfErrors += workers[i].nrOfErrors;
+        workers[i].nrOfLatencies = 0;
+        workers[i].nrOfErrors = 0;
+        celixThreadMutex_unlock(&workers[i].mutex);
+    }
+    qsort(latencies, size, sizeof(*latencies), benchmark_compareLatency);
+
+    const char *method = payloadSize == 0 ? "add" : "sum";
+    unsigned long payloadBytes = payloadSize == 0 ? 2 * sizeof(double) : payloadSize * sizeof(double);
+    double callsPerSecond = duration > 0 ? (double) size / duration : 0.0;
+    double clientCpuPerCall = size > 0 && clientCpu >= 0 ? (double) clientCpu / (double) size : -1.0;
+    double serverCpuPerCall = size > 0 && serverCpu >= 0 ? (double) serverCpu / (double) size : -1.0;
+    uint64_t p50 = benchmark_percentile(latencies, size, 50.0);
+    uint64_t p90 = benchmark_percentile(latencies, size, 90.0);
+    uint64_t p99 = benchmark_percentile(latencies, size, 99.0);
+    uint64_t p999 = benchmark_percentile(latencies, size, 99.9);
+    uint64_t max = size > 0 ? latencies[size - 1] : 0;
+    int connections = benchmark_nrOfConnections(bench->serverPort);
+    long clientRss = benchmark_processRssInKb(0);
+    long serverRss = bench->serverPid > 0 ? benchmark_processRssInKb(bench->serverPid) : -1;
+    free(latencies);
+
+    printf("[BENCHMARK] %s: %s of %lu bytes with %i threads: %zu calls (%lu errors) in %.3f s: %.0f calls/s, "
+           "latency p50 %.1f us, p99 %.1f us, p99.9 %.1f us, cpu/call client %.1f us, server %.1f us, %i connections\n",
+           bench->label, method, payloadBytes, nrOfWorkers, size, nrOfErrors, duration, callsPerSecond,
+           (double) p50 / 1e3, (double) p99 / 1e3, (double) p999 / 1e3, clientCpuPerCall, serverCpuPerCall, connections);
+
+    FILE *file = fopen(bench->resultFile, "a");
+    if (file != NULL) {
+        fprintf(file, "{\"label\":\"%s\",\"method\":\"%s\",\"payloadSize\":%lu,\"concurrency\":%i,\"calls\":%zu,\"errors\":%lu,"
+                      "\"duration\":%f,\"callsPerSecond\":%f,"
+                      "\"latencyNs\":{\"p50\":%lu,\"p90\":%lu,\"p99\":%lu,\"p999\":%lu,\"max\":%lu},"
+                      "\"cpuUsPerCall\":{\"client\":%f,\"server\":%f},\"connections\":%i,\"rssKb\":{\"client\":%li,\"server\":%li}}\n",
+                bench->label, method, payloadBytes, nrOfWorkers, size, nrOfErrors, duration, callsPerSecond,
+                (unsigned long) p50, (unsigned long) p90, (unsigned long) p99, (unsigned long) p999, (unsigned long) max,
+                clientCpuPerCall, serverCpuPerCall, connections, clientRss, serverRss);
+        fclose(file);
+    } else {
+        fprintf(stderr, "[BENCHMARK] Cannot open result file %s\n", bench->resultFile);
+    }
+}
+
+/**
+ * Runs the calling threads for the configured duration, reporting every report interval (or once at the end).
+ * Returns false if the calculator went away.
+ */
+static bool benchmark_run(calculator_benchmark_t *bench, int nrOfWorkers, uint32_t payloadSize) {
+    benchmark_worker_t *workers = calloc(nrOfWorkers, sizeof(*workers));
+
+    celixThreadMutex_lock(&bench->mutex);
+    bench->runWorkers = true;
+    for (int i = 0; i < nrOfWorkers; ++i) {
+        workers[i].bench = bench;
+        workers[i].payloadSize = payloadSize;
+        celixThreadMutex_create(&workers[i].mutex, NULL);
+        if (celixThread_create(&workers[i].thread, NULL, benchmark_worker_run, &workers[i]) == CELIX_SUCCESS) {
+            bench->nrOfActiveWorkers += 1;
+        }
+    }
+    celixThreadMutex_unlock(&bench->mutex);
+
+    uint64_t start = benchmark_now();
+    uint64_t end = start + (uint64_t) bench->duration * 1000000000UL;
+    uint64_t interval = bench->reportInterval > 0 ? (uint64_t) bench->reportInterval * 1000000000UL : end - start;
+    uint64_t reportStart = start;
+    long long clientCpuStart = benchmark_processCpuInUs(0);
+    long long serverCpuStart = benchmark_processCpuInUs(bench->serverPid);
+
+    celixThreadMutex_lock(&bench->mutex);
+    while (bench->running && bench->calculator != NULL) {
+        uint64_t now = benchmark_now();
+        uint64_t reportEnd = reportStart + interval < end ? reportStart + interval : end;
+        if (now < reportEnd) {
+            uint64_t wait = reportEnd - now;
+            celixThreadCondition_timedwaitRelative(&bench->cond, &bench->mutex, (long) (wait / 1000000000UL), (long) (wait % 1000000000UL));
+            continue;
+        }
+        celixThreadMutex_unlock(&bench->mutex);
+
+        //note the connections are counted before the calling threads stop
+        long long clientCpu = benchmark_processCpuInUs(0);
+        long long serverCpu = benchmark_processCpuInUs(bench->serverPid);
+        benchmark_report(bench, workers, nrOfWorkers, payloadSize, (double) (now - reportStart) / 1e9,
+                         clientCpuStart >= 0 ? clientCpu - clientCpuStart : -1,
+                         serverCpuStart >= 0 && serverCpu >= 0 ? serverCpu - serverCpuStart : -1);
+        reportStart = now;
+        clientCpuStart = clientCpu;
+        serverCpuStart = serverCpu;
+
+        celixThreadMutex_lock(&bench->mutex);
+        if (now >= end) {
+            break;
+        }
+    }
+    bool completed = bench->calculator != NULL;
+    bench->runWorkers = false;
+    celixThreadMutex_unlock(&bench->mutex);
+
+    for (int i = 0; i < nrOfWorkers; ++i) {
+        celixThread_join(workers[i].thread, NULL);
+        celixThreadMutex_destroy(&workers[i].mutex);
+        free(workers[i].latencies);
+    }
+    free(workers);
+    return completed;
+}
+
+static void* benchmark_thread(void *data) {
+    calculator_benchmark_t *bench = data;
+
+    celixThreadMutex_lock(&bench->mutex);
+    while (bench->running && bench->calculator == NULL) {
+        celixThreadCondition_wait(&bench->cond, &bench->mutex);
+    }
+    celixThreadMutex_unlock(&bench->mutex);
+
+    bool completed = true;
+    for (int p = 0; p < bench->nrOfPayloadSizes && completed; ++p) {
+        for (int c = 0; c < bench->nrOfConcurrency && completed; ++c) {
+            celixThreadMutex_lock(&bench->mutex);
+            bool running = bench->running;
+            celixThreadMutex_unlock(&bench->mutex);
+            if (running && bench->concurrency[c] > 0) {
+                completed = benchmark_run(bench, (int) bench->concurrency[c], (uint32_t) bench->payloadSizes[p]);
+            }
+        }
+    }
+    if (!completed) {
+        fprintf(stderr, "[BENCHMARK] %s: calculator service removed, benchmark aborted\n", bench->label);
+    }
+    printf("[BENCHMARK] %s: done\n", bench->label);
+    return NULL;
+}
+
+static void benchmark_setCalculator(void *handle, void *svc) {
+    calculator_benchmark_t *bench = handle;
+    celixThreadMutex_lock(&bench->mutex);
+    bench->calculator = svc;
+    celixThreadCondition_broadcast(&bench->cond);
+    //a removed calculator can still be in use by the calling threads
+    while (svc == NULL && bench->nrOfActiveWorkers > 0) {
+        celixThreadCondition_wait(&bench->cond, &bench->mutex);
+    }
+    celixThreadMutex_unlock(&bench->mutex);
+}
+
+static int benchmark_start(calculator_benchmark_t *bench, celix_bundle_context_t *ctx) {
+    bench->ctx = ctx;
+    bench->label = celix_bundleContext_getProperty(ctx, BENCHMARK_LABEL_KEY, BENCHMARK_LABEL_DEFAULT);
+    bench->resultFile = celix_bundleContext_getProperty(ctx, BENCHMARK_RESULT_FILE_KEY, BENCHMARK_RESULT_FILE_DEFAULT);
+    bench->duration = celix_bundleContext_getPropertyAsLong(ctx, BENCHMARK_DURATION_KEY, BENCHMARK_DURATION_DEFAULT);
+    bench->reportInterval = celix_bundleContext_getPropertyAsLong(ctx, BENCHMARK_REPORT_INTERVAL_KEY, BENCHMARK_REPORT_INTERVAL_DEFAULT);
+    bench->nrOfConcurrency = benchmark_parseList(celix_bundleContext_getProperty(ctx, BENCHMARK_CONCURRENCY_KEY, BENCHMARK_CONCURRENCY_DEFAULT), bench->concurrency);
+    bench->nrOfPayloadSizes = benchmark_parseList(celix_bundleContext_getProperty(ctx, BENCHMARK_PAYLOAD_SIZES_KEY, BENCHMARK_PAYLOAD_SIZES_DEFAULT), bench->payloadSizes);
+    bench->serverPid = celix_bundleContext_getPropertyAsLong(ctx, BENCHMARK_SERVER_PID_KEY, 0);
+    bench->serverPort = celix_bundleContext_getPropertyAsLong(ctx, BENCHMARK_SERVER_PORT_KEY, BENCHMARK_SERVER_PORT_DEFAULT);
+
+    celixThreadMutex_create(&bench->mutex, NULL);
+    celixThreadCondition_init(&bench->cond, NULL);
+    bench->running = true;
+    celixThread_create(&bench->thread, NULL, benchmark_thread, bench);
+    celixThread_setName(&bench->thread, "RsaBenchmark");
+
+    //only the imported calculator, calls on a local calculator would not measure the remote services
+    celix_service_tracking_options_t opts = CELIX_EMPTY_SERVICE_TRACKING_OPTIONS;
+    opts.filter.serviceName = CALCULATOR_SERVICE;
+    opts.filter.filter = "(service.imported=*)";
+    opts.callbackHandle = bench;
+    opts.set = benchmark_setCalculator;
+    bench->trackerId = celix_bundleContext_trackServicesWithOptions(ctx, &opts);
+    return CELIX_SUCCESS;
+}
+
+static int benchmark_stop(calculator_benchmark_t *bench, celix_bundle_context_t *ctx) {
+    celixThreadMutex_lock(&bench->mutex);
+    bench->running = false;
+    celixThreadCondition_broadcast(&bench->cond);
+    celixThreadMutex_unlock(&bench->mutex);
+    celixThread_join(bench->thread, NULL);
+
+    celix_bundleContext_stopTracker(ctx, bench->trackerId);
+
+    celixThreadCondition_destroy(&bench->cond);
+    celixThreadMutex_destroy(&bench->mutex);
+    return CELIX_SUCCESS;
+}
+
+CELIX_GEN_BUNDLE_ACTIVATOR(calculator_benchmark_t, benchmark_start, benchmark_stop)
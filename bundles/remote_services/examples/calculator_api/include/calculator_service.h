@@ -30,10 +30,18 @@
 #define CALCULATOR_SERVICE              "org.apache.celix.calc.api.Calculator"
 #define CALCULATOR_CONFIGURATION_TYPE   "org.amdatu.remote.admin.http"
 
+#include <stdint.h>
+
 typedef struct calculator calculator_t;
 
 typedef struct calculator_service calculator_service_t;
 
+typedef struct calculator_values {
+    uint32_t cap;
+    uint32_t len;
+    double *buf;
+} calculator_values_t;
+
 /*
  * The calculator service definition corresponds to the following Java interface:
  *
@@ -41,6 +49,7 @@ typedef struct calculator_service calculator_service_t;
  *      double add(double a, double b);
  *      double sub(double a, double b);
  *      double sqrt(double a);
+ *      double sum(double[] values);
  * }
  */
 struct calculator_service {
@@ -48,6 +57,7 @@ struct calculator_service {
     int (*add)(calculator_t *calculator, double a, double b, double *result);
     int (*sub)(calculator_t *calculator, double a, double b, double *result);
     int (*sqrt)(calculator_t *calculator, double a, double *result);
+    int (*sum)(calculator_t *calculator, calculator_values_t values, double *result);
 };
 
 
@@ -29,10 +29,14 @@
 #include "bundle_activator.h"
 #include "bundle_context.h"
 #include "service_registration.h"
+#include "celix_bundle_context.h"
 
 #include "calculator_impl.h"
 #include "remote_constants.h"
 
+//set to false to not print every calculation, e.g. for benchmarks
+#define CALCULATOR_VERBOSE_KEY "CALCULATOR_VERBOSE"
+
 struct activator {
     calculator_t *calculator;
     calculator_service_t *service;
@@ -60,7 +64,8 @@ celix_status_t bundleActivator_start(void * userData, celix_bundle_context_t *co
     celix_status_t status = CELIX_SUCCESS;
     struct activator *activator = userData;
 
-    status = calculator_create(&activator->calculator);
+    bool verbose = celix_bundleContext_getPropertyAsBool(context, CALCULATOR_VERBOSE_KEY, true);
+    status = calculator_create(verbose, &activator->calculator);
     if (status == CELIX_SUCCESS) {
         activator->service = calloc(1, sizeof(*activator->service));
         if (!activator->service) {
@@ -70,10 +75,13 @@ celix_status_t bundleActivator_start(void * userData, celix_bundle_context_t *co
             activator->service->add = calculator_add;
             activator->service->sub = calculator_sub;
             activator->service->sqrt = calculator_sqrt;
+            activator->service->sum = calculator_sum;
 
             celix_properties_t *properties = celix_properties_create();
             celix_properties_set(properties, OSGI_RSA_SERVICE_EXPORTED_INTERFACES, CALCULATOR_SERVICE);
             celix_properties_set(properties, OSGI_RSA_SERVICE_EXPORTED_CONFIGS, CALCULATOR_CONFIGURATION_TYPE);
+            //executes the remote calls on a thread pool of the service when exported by the RSA DFI
+            celix_properties_set(properties, "org.apache.celix.rsa.dfi.export.threads", "2");
             bundleContext_registerService(context, CALCULATOR_SERVICE, activator->service, properties, &activator->calculatorReg);
         }
     }
@@ -31,12 +31,14 @@
 
 #include "calculator_impl.h"
 
-celix_status_t calculator_create(calculator_t **calculator) {
+celix_status_t calculator_create(bool verbose, calculator_t **calculator) {
     celix_status_t status = CELIX_SUCCESS;
 
     *calculator = calloc(1, sizeof(**calculator));
     if (!*calculator) {
         status = CELIX_ENOMEM;
+    } else {
+        (*calculator)->verbose = verbose;
     }
 
     return status;
@@ -51,7 +53,9 @@ celix_status_t calculator_add(calculator_t *calculator, double a, double b, doub
     celix_status_t status = CELIX_SUCCESS;
 
     *result = a + b;
-    printf("CALCULATOR: Add: %f + %f = %f\n", a, b, *result);
+    if (calculator->verbose) {
+        printf("CALCULATOR: Add: %f + %f = %f\n", a, b, *result);
+    }
 
     return status;
 }
@@ -60,7 +64,9 @@ celix_status_t calculator_sub(calculator_t *calculator, double a, double b, doub
     celix_status_t status = CELIX_SUCCESS;
 
     *result = a - b;
-    printf("CALCULATOR: Sub: %f + %f = %f\n", a, b, *result);
+    if (calculator->verbose) {
+        printf("CALCULATOR: Sub: %f + %f = %f\n", a, b, *result);
+    }
 
     return status;
 }
@@ -70,11 +76,30 @@ celix_status_t calculator_sqrt(calculator_t *calculator, double a, double *resul
 
     if (a > 0) {
         *result = sqrt(a);
-        printf("CALCULATOR: Sqrt: %f = %f\n", a, *result);
+        if (calculator->verbose) {
+            printf("CALCULATOR: Sqrt: %f = %f\n", a, *result);
+        }
     } else {
-        printf("CALCULATOR: Sqrt: %f = ERR\n", a);
+        if (calculator->verbose) {
+            printf("CALCULATOR: Sqrt: %f = ERR\n", a);
+        }
         status = CELIX_ILLEGAL_ARGUMENT;
     }
 
     return status;
 }
+
+celix_status_t calculator_sum(calculator_t *calculator, calculator_values_t values, double *result) {
+    celix_status_t status = CELIX_SUCCESS;
+
+    double sum = 0.0;
+    for (uint32_t i = 0; i < values.len; ++i) {
+        sum += values.buf[i];
+    }
+    *result = sum;
+    if (calculator->verbose) {
+        printf("CALCULATOR: Sum: %u values = %f\n", values.len, *result);
+    }
+
+    return status;
+}
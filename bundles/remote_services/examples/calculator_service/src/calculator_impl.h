@@ -27,17 +27,21 @@
 #ifndef CALCULATOR_IMPL_H_
 #define CALCULATOR_IMPL_H_
 
+#include <stdbool.h>
+
 #include "celix_errno.h"
 
 #include "calculator_service.h"
 
 struct calculator {
+    bool verbose; //print every calculation
 };
 
-celix_status_t calculator_create(calculator_t **calculator);
+celix_status_t calculator_create(bool verbose, calculator_t **calculator);
 celix_status_t calculator_destroy(calculator_t **calculator);
 celix_status_t calculator_add(calculator_t *calculator, double a, double b, double *result);
 celix_status_t calculator_sub(calculator_t *calculator, double a, double b, double *result);
 celix_status_t calculator_sqrt(calculator_t *calculator, double a, double *result);
+celix_status_t calculator_sum(calculator_t *calculator, calculator_values_t values, double *result);
 
 #endif /* CALCULATOR_IMPL_H_ */
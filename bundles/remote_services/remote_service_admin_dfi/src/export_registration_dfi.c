@@ -25,8 +25,12 @@
 #include <service_tracker_customizer.h>
 #include <service_tracker.h>
 #include <json_rpc.h>
+#include <avrobin_rpc.h>
+#include <errno.h>
 #include "celix_constants.h"
+#include "celix_thread_pool.h"
 #include "export_registration_dfi.h"
+#include "remote_service_admin_dfi_constants.h"
 #include "dfi_utils.h"
 
 struct export_reference {
@@ -41,8 +45,10 @@ struct export_registration {
     dyn_interface_type *intf; //owner
     service_tracker_t *tracker;
 
-    celix_thread_mutex_t mutex;
-    void *service; //protected by mutex
+    celix_thread_rwlock_t lock;
+    void *service; //protected by lock, calls hold a read lock
+
+    celix_thread_pool_t *executor; //optional, see RSA_DFI_EXPORT_THREADS
 
     //TODO add tracker and lock
     bool closed;
@@ -53,6 +59,25 @@ struct export_registration {
 static celix_status_t exportRegistration_findAndParseInterfaceDescriptor(log_helper_t *helper, celix_bundle_context_t * const context, celix_bundle_t * const bundle, char const * const name, dyn_interface_type **out);
 static void exportRegistration_addServ(export_registration_t *reg, service_reference_pt ref, void *service);
 static void exportRegistration_removeServ(export_registration_t *reg, service_reference_pt ref, void *service);
+static celix_status_t exportRegistration_execute(export_registration_t *export, bool binary, const void *data, size_t dataLength, void **response, size_t *responseLength);
+
+/**
+ * A call handed over to the executor of an export registration, the submitting (HTTP server) thread waits until
+ * the call is done.
+ */
+typedef struct export_registration_call {
+    export_registration_t *export;
+    bool binary;
+    const void *data;
+    size_t dataLength;
+    void *response;
+    size_t responseLength;
+    celix_status_t status;
+
+    celix_thread_mutex_t mutex;
+    celix_thread_cond_t cond;
+    bool done;
+} export_registration_call_t;
 
 celix_status_t exportRegistration_create(log_helper_t *helper, service_reference_pt reference, endpoint_description_t *endpoint, celix_bundle_context_t *context, FILE *logFile, export_registration_t **out) {
     celix_status_t status = CELIX_SUCCESS;
@@ -80,7 +105,21 @@ celix_status_t exportRegistration_create(log_helper_t *helper, service_reference
         reg->logFile = logFile;
         reg->servId = strndup(servId, 1024);
 
-        celixThreadMutex_create(&reg->mutex, NULL);
+        celixThreadRwlock_create(&reg->lock, NULL);
+    }
+
+    const char *threads = NULL;
+    if (status == CELIX_SUCCESS && serviceReference_getProperty(reference, RSA_DFI_EXPORT_THREADS, &threads) == CELIX_SUCCESS && threads != NULL && atoi(threads) > 0) {
+        const char *queueSize = NULL;
+        serviceReference_getProperty(reference, RSA_DFI_EXPORT_QUEUE_SIZE, &queueSize);
+        celix_thread_pool_options_t opts = CELIX_EMPTY_THREAD_POOL_OPTIONS;
+        opts.nrOfThreads = (size_t) atoi(threads);
+        opts.maxQueueSize = queueSize != NULL && atoi(queueSize) > 0 ? (size_t) atoi(queueSize) : RSA_DFI_EXPORT_QUEUE_SIZE_DEFAULT;
+        opts.name = "RSA export";
+        reg->executor = celix_threadPool_create(&opts);
+        if (reg->executor == NULL) {
+            logHelper_log(helper, OSGI_LOGSERVICE_WARNING, "Cannot create executor for service id %s, calls are executed on the HTTP server threads", servId);
+        }
     }
 
     const char *exports = NULL;
@@ -129,13 +168,79 @@ celix_status_t exportRegistration_create(log_helper_t *helper, service_reference
     return status;
 }
 
+static void* exportRegistration_callJob(void *data) {
+    export_registration_call_t *call = data;
+    call->status = exportRegistration_execute(call->export, call->binary, call->data, call->dataLength, &call->response, &call->responseLength);
+    return NULL;
+}
+
+static void exportRegistration_callDone(void *handle, void *result __attribute__((unused))) {
+    export_registration_call_t *call = handle;
+    celixThreadMutex_lock(&call->mutex);
+    call->done = true;
+    celixThreadCondition_signal(&call->cond);
+    celixThreadMutex_unlock(&call->mutex);
+}
+
+/**
+ * Executes the call on the calling thread or, if the export has an executor, on the executor and waits for the result.
+ * Returns EBUSY if the queue of the executor is full.
+ */
+static celix_status_t exportRegistration_invoke(export_registration_t *export, bool binary, const void *data, size_t dataLength, void **response, size_t *responseLength) {
+    if (export->executor == NULL) {
+        return exportRegistration_execute(export, binary, data, dataLength, response, responseLength);
+    }
+
+    export_registration_call_t call;
+    memset(&call, 0, sizeof(call));
+    call.export = export;
+    call.binary = binary;
+    call.data = data;
+    call.dataLength = dataLength;
+    celixThreadMutex_create(&call.mutex, NULL);
+    celixThreadCondition_init(&call.cond, NULL);
+
+    celix_status_t status = celix_threadPool_tryExecute(export->executor, exportRegistration_callJob, &call, &call, exportRegistration_callDone);
+    if (status == CELIX_SUCCESS) {
+        celixThreadMutex_lock(&call.mutex);
+        while (!call.done) {
+            celixThreadCondition_wait(&call.cond, &call.mutex);
+        }
+        celixThreadMutex_unlock(&call.mutex);
+        status = call.status;
+        *response = call.response;
+        *responseLength = call.responseLength;
+    } else if (status == CELIX_ENOMEM) {
+        status = EBUSY;
+    }
+
+    celixThreadCondition_destroy(&call.cond);
+    celixThreadMutex_destroy(&call.mutex);
+    return status;
+}
+
+static celix_status_t exportRegistration_execute(export_registration_t *export, bool binary, const void *data, size_t dataLength, void **response, size_t *responseLength) {
+    celix_status_t status;
+
+    celixThreadRwlock_readLock(&export->lock);
+    if (export->service == NULL) {
+        status = CELIX_ILLEGAL_STATE;
+    } else if (binary) {
+        status = avrobinRpc_call(export->intf, export->service, data, dataLength, (uint8_t **) response, responseLength);
+    } else {
+        status = jsonRpc_call(export->intf, export->service, (const char *) data, (char **) response);
+    }
+    celixThreadRwlock_unlock(&export->lock);
+
+    return status;
+}
+
 celix_status_t exportRegistration_call(export_registration_t *export, char *data, int datalength, char **responseOut, int *responseLength) {
     int status = CELIX_SUCCESS;
 
     *responseLength = -1;
-    celixThreadMutex_lock(&export->mutex);
-    status = jsonRpc_call(export->intf, export->service, data, responseOut);
-    celixThreadMutex_unlock(&export->mutex);
+    size_t ignored = 0;
+    status = exportRegistration_invoke(export, false, data, datalength >= 0 ? (size_t) datalength : strlen(data), (void **) responseOut, &ignored);
 
     //printf("calling for '%s'\n");
     if (export->logFile != NULL) {
@@ -150,12 +255,29 @@ celix_status_t exportRegistration_call(export_registration_t *export, char *data
     return status;
 }
 
+celix_status_t exportRegistration_callBinary(export_registration_t *export, const uint8_t *data, size_t dataLength, uint8_t **responseOut, size_t *responseLength) {
+    int status = CELIX_SUCCESS;
+
+    status = exportRegistration_invoke(export, true, data, dataLength, (void **) responseOut, responseLength);
+
+    if (export->logFile != NULL) {
+        static int callCount = 0;
+        char *name = NULL;
+        dynInterface_getName(export->intf, &name);
+        fprintf(export->logFile, "REMOTE BINARY CALL %i\n\tservice=%s\n\tservice_id=%s\n\trequest_size=%zu\n\tstatus=%i\n", callCount, name, export->servId, dataLength, status);
+        fflush(export->logFile);
+        callCount += 1;
+    }
+
+    return status;
+}
+
 static celix_status_t exportRegistration_findAndParseInterfaceDescriptor(log_helper_t *helper, celix_bundle_context_t * const context, celix_bundle_t * const bundle, char const * const name, dyn_interface_type **out) {
     FILE* descriptor = NULL;
 
     celix_status_t status = dfi_findDescriptor(context, bundle, name, &descriptor);
     if (status == CELIX_SUCCESS) {
-        int rc = dynInterface_parse(descriptor, out);
+        int rc = dynInterface_parseShared(descriptor, out);
         fclose(descriptor);
         if (rc != 0) {
             logHelper_log(helper, OSGI_LOGSERVICE_WARNING, "RSA_DFI: Error parsing service descriptor for \"%s\", return code is %d.", name, rc);
@@ -166,7 +288,7 @@ static celix_status_t exportRegistration_findAndParseInterfaceDescriptor(log_hel
 
     status = dfi_findAvprDescriptor(context, bundle, name, &descriptor);
     if (status == CELIX_SUCCESS) {
-        *out = dynInterface_parseAvpr(descriptor);
+        *out = dynInterface_parseAvprShared(descriptor);
         if (*out == NULL) {
             logHelper_log(helper, OSGI_LOGSERVICE_WARNING, "RSA_AVPR: Error parsing avpr service descriptor for '%s'", name);
             status = CELIX_BUNDLE_EXCEPTION;
@@ -180,6 +302,10 @@ static celix_status_t exportRegistration_findAndParseInterfaceDescriptor(log_hel
 
 void exportRegistration_destroy(export_registration_t *reg) {
     if (reg != NULL) {
+        if (reg->executor != NULL) {
+            celix_threadPool_destroy(reg->executor);
+        }
+
         if (reg->intf != NULL) {
             dyn_interface_type *intf = reg->intf;
             reg->intf = NULL;
@@ -197,7 +323,7 @@ void exportRegistration_destroy(export_registration_t *reg) {
         if (reg->servId != NULL) {
             free(reg->servId);
         }
-        celixThreadMutex_destroy(&reg->mutex);
+        celixThreadRwlock_destroy(&reg->lock);
 
         free(reg);
     }
@@ -221,17 +347,17 @@ celix_status_t exportRegistration_stop(export_registration_t *reg) {
 }
 
 static void exportRegistration_addServ(export_registration_t *reg, service_reference_pt ref, void *service) {
-    celixThreadMutex_lock(&reg->mutex);
+    celixThreadRwlock_writeLock(&reg->lock);
     reg->service = service;
-    celixThreadMutex_unlock(&reg->mutex);
+    celixThreadRwlock_unlock(&reg->lock);
 }
 
 static void exportRegistration_removeServ(export_registration_t *reg, service_reference_pt ref, void *service) {
-    celixThreadMutex_lock(&reg->mutex);
+    celixThreadRwlock_writeLock(&reg->lock);
     if (reg->service == service) {
         reg->service = NULL;
     }
-    celixThreadMutex_unlock(&reg->mutex);
+    celixThreadRwlock_unlock(&reg->lock);
 }
 
 
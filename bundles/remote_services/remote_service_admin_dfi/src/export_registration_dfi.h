@@ -25,6 +25,8 @@
 #include "log_helper.h"
 #include "endpoint_description.h"
 
+#include <stdint.h>
+
 celix_status_t exportRegistration_create(log_helper_t *helper, service_reference_pt reference, endpoint_description_t *endpoint, celix_bundle_context_t *context, FILE *logFile, export_registration_t **registration);
 celix_status_t exportRegistration_close(export_registration_t *registration);
 void exportRegistration_destroy(export_registration_t *registration);
@@ -32,7 +34,12 @@ void exportRegistration_destroy(export_registration_t *registration);
 celix_status_t exportRegistration_start(export_registration_t *registration);
 celix_status_t exportRegistration_stop(export_registration_t *registration);
 
+/**
+ * Calls the exported service. If the export has an executor (see RSA_DFI_EXPORT_THREADS) the call is executed by
+ * the executor and EBUSY is returned if its queue is full.
+ */
 celix_status_t exportRegistration_call(export_registration_t *export, char *data, int datalength, char **response, int *responseLength);
+celix_status_t exportRegistration_callBinary(export_registration_t *export, const uint8_t *data, size_t dataLength, uint8_t **response, size_t *responseLength);
 
 
 #endif //CELIX_EXPORT_REGISTRATION_DFI_H
@@ -20,14 +20,21 @@
 #include <stdlib.h>
 #include <jansson.h>
 #include <json_rpc.h>
+#include <avrobin_rpc.h>
 #include <assert.h>
+#include <errno.h>
+#include <time.h>
 #include "version.h"
+#include "utils.h"
 #include "json_serializer.h"
 #include "dyn_interface.h"
 #include "import_registration.h"
 #include "import_registration_dfi.h"
 #include "remote_service_admin_dfi.h"
 #include "remote_service_admin_dfi_constants.h"
+#include "remote_async_call.h"
+
+typedef struct import_cache_entry import_cache_entry_t;
 
 struct import_registration {
     celix_bundle_context_t *context;
@@ -35,56 +42,200 @@ struct import_registration {
     const char *classObject; //NOTE owned by endpoint
     version_pt version;
 
-    celix_thread_mutex_t mutex; //protects send & sendhandle
+    celix_thread_mutex_t mutex; //protects send, sendBinary & sendhandle
     send_func_type send;
+    send_binary_func_type sendBinary;
     void *sendHandle;
+    uint64_t callCounter; //atomic
+    bool binaryAsync;
+    send_async_func_type sendAsync;
+    void *sendAsyncHandle;
 
     service_factory_pt factory;
     service_registration_t *factoryReg;
-
-    hash_map_pt proxies; //key -> bundle, value -> service_proxy
-    celix_thread_mutex_t proxiesMutex; //protects proxies
+    service_factory_pt asyncFactory;
+    service_registration_t *asyncFactoryReg;
+
+    unsigned int coalescingWindowInUs; //0 -> calls are sent separately
+    unsigned int coalescingMaxBatchSize;
+    celix_thread_t coalescingThread;
+    celix_thread_mutex_t coalescingMutex; //protects coalescingRunning & pendingCalls
+    celix_thread_cond_t coalescingCond;
+    bool coalescingRunning;
+    array_list_pt pendingCalls; //import_pending_call_t entries, sent in batches by the coalescing thread
+
+    unsigned int callCacheSize; //max nr of cached replies, 0 -> no replies are cached
+    celix_thread_mutex_t cacheMutex; //protects cache, cacheHead & cacheTail
+    hash_map_pt cache; //key & value -> import_cache_entry_t
+    import_cache_entry_t *cacheHead; //most recently used
+    import_cache_entry_t *cacheTail; //least recently used
+
+    hash_map_pt proxies; //key -> bundle, value -> service_proxy_usage
+    hash_map_pt asyncProxies; //key -> bundle, value -> service_proxy_usage
+    hash_map_pt sharedProxies; //key -> consumer interface version, value -> service_proxy
+    hash_map_pt sharedAsyncProxies; //key -> consumer interface version, value -> service_proxy
+    celix_thread_mutex_t proxiesMutex; //protects the (shared) proxies maps
 
     FILE *logFile;
 };
 
+/**
+ * A proxy is shared by all bundles with the same consumer interface version, so the parsed interfaces and the method
+ * closures exist once per import and version.
+ */
 struct service_proxy {
+    const char *version; //NOTE owned by intf
     dyn_interface_type *intf;
+    dyn_interface_type *asyncIntf; //only for async proxies, the closures of the service are created for its methods
+    struct proxy_method *methods; //only for sync proxies, the user data of the closures
     void *service;
-    size_t count;
+    size_t count; //nr of bundles using the proxy
+};
+
+struct proxy_method {
+    struct method_entry *entry;
+    unsigned int cacheTtlInMs; //from the cacheTtlMs method annotation, 0 -> the replies are not cached
 };
 
+/**
+ * A cached reply of a cacheable method, keyed by its request. The reply is 0 terminated, so also usable as json.
+ */
+struct import_cache_entry {
+    uint8_t *request;
+    size_t requestLength;
+    uint8_t *reply;
+    size_t replyLength;
+    uint64_t expiresInMs;
+    import_cache_entry_t *prev;
+    import_cache_entry_t *next;
+};
+
+struct service_proxy_usage {
+    struct service_proxy *proxy;
+    size_t count; //nr of gets of the bundle
+};
+
+/**
+ * An in flight async call. Owned by the caller and the async send, the last one releasing it destroys it.
+ * The values of the (pre) output arguments are copied at call time, so that the reply can be handled in the wait.
+ */
+typedef struct import_async_call {
+    remote_async_call_t call;
+    struct method_entry *entry;
+    bool binary;
+    uint64_t callId;
+    void **args;
+    void **argValues;
+
+    celix_thread_mutex_t mutex; //protects below
+    celix_thread_cond_t cond;
+    int refCount;
+    bool completed;
+    bool handled;
+    int replyStatus;
+    uint8_t *reply;
+    size_t replyLength;
+} import_async_call_t;
+
+/**
+ * A call queued for the coalescing thread. The request is freed by the coalescing thread if ownsRequest is set,
+ * the (allocated) reply is handed over to complete.
+ */
+typedef struct import_pending_call {
+    uint8_t *request;
+    size_t requestLength;
+    bool ownsRequest;
+    send_async_complete_func_type complete;
+    void *completeHandle;
+} import_pending_call_t;
+
+/**
+ * A sync call waiting for the coalescing thread.
+ */
+typedef struct import_sync_call {
+    celix_thread_mutex_t mutex;
+    celix_thread_cond_t cond;
+    bool completed;
+    int replyStatus;
+    uint8_t *reply;
+    size_t replyLength;
+} import_sync_call_t;
+
 static celix_status_t importRegistration_findAndParseInterfaceDescriptor(celix_bundle_context_t * const context, celix_bundle_t * const bundle, char const * const name, dyn_interface_type **out);
 
-static celix_status_t importRegistration_createProxy(import_registration_t *import, celix_bundle_t *bundle,
-                                              struct service_proxy **proxy);
+static celix_status_t importRegistration_findAndParseAsyncInterfaceDescriptor(celix_bundle_context_t * const context, celix_bundle_t * const bundle, char const * const name, dyn_interface_type **out);
+
+static celix_status_t importRegistration_getProxy(import_registration_t *import, hash_map_pt proxies, hash_map_pt sharedProxies, celix_bundle_t *bundle, bool async, void **service);
+static celix_status_t importRegistration_createProxy(import_registration_t *import, celix_bundle_t *bundle, bool async,
+                                              hash_map_pt sharedProxies, struct service_proxy **proxy);
+static celix_status_t importRegistration_getAsyncService(import_registration_t *import, celix_bundle_t *bundle, service_registration_t *registration, void **service);
+static celix_status_t importRegistration_ungetAsyncService(import_registration_t *import, celix_bundle_t *bundle, service_registration_t *registration, void **service);
 static void importRegistration_proxyFunc(void *userData, void *args[], void *returnVal);
+static void importRegistration_proxyFuncAsync(void *userData, void *args[], void *returnVal);
+static void importRegistration_asyncCallCompleted(void *handle, int replyStatus, uint8_t *reply, size_t replyLength);
+static int importRegistration_asyncCallWait(void *handle, int timeoutInMs);
+static void importRegistration_asyncCallDestroy(void *handle);
+static void importRegistration_proxyFuncBinary(import_registration_t *import, struct proxy_method *method, void *args[], void *returnVal);
+static bool importRegistration_isCacheable(import_registration_t *import, struct proxy_method *method);
+static bool importRegistration_getCachedReply(import_registration_t *import, const uint8_t *request, size_t requestLength, uint8_t **reply, size_t *replyLength);
+static void importRegistration_cacheReply(import_registration_t *import, const uint8_t *request, size_t requestLength, const uint8_t *reply, size_t replyLength, unsigned int ttlInMs);
 static void importRegistration_destroyProxy(struct service_proxy *proxy);
-static void importRegistration_clearProxies(import_registration_t *import);
+static void importRegistration_clearProxies(import_registration_t *import, hash_map_pt proxies, hash_map_pt sharedProxies);
 static const char* importRegistration_getUrl(import_registration_t *reg);
+static void* importRegistration_coalescingLoop(void *data);
+static celix_status_t importRegistration_enqueueCall(import_registration_t *import, uint8_t *request, size_t requestLength, bool ownsRequest, send_async_complete_func_type complete, void *completeHandle);
+static void importRegistration_coalescedSend(import_registration_t *import, uint8_t *request, size_t requestLength, uint8_t **reply, size_t *replyLength, int *replyStatus);
 static const char* importRegistration_getServiceName(import_registration_t *reg);
 
+static unsigned int importRegistration_cacheKeyHash(const void *key) {
+    const import_cache_entry_t *entry = key;
+    unsigned int hash = 2166136261u; //FNV-1a
+    for (size_t i = 0; i < entry->requestLength; ++i) {
+        hash ^= entry->request[i];
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+static int importRegistration_cacheKeyEquals(const void *key1, const void *key2) {
+    const import_cache_entry_t *entry1 = key1;
+    const import_cache_entry_t *entry2 = key2;
+    return entry1->requestLength == entry2->requestLength && memcmp(entry1->request, entry2->request, entry1->requestLength) == 0;
+}
+
 celix_status_t importRegistration_create(celix_bundle_context_t *context, endpoint_description_t *endpoint, const char *classObject, const char* serviceVersion, FILE *logFile, import_registration_t **out) {
     celix_status_t status = CELIX_SUCCESS;
     import_registration_t *reg = calloc(1, sizeof(*reg));
 
     if (reg != NULL) {
         reg->factory = calloc(1, sizeof(*reg->factory));
+        reg->asyncFactory = calloc(1, sizeof(*reg->asyncFactory));
     }
 
-    if (reg != NULL && reg->factory != NULL) {
+    if (reg != NULL && reg->factory != NULL && reg->asyncFactory != NULL) {
         reg->context = context;
         reg->endpoint = endpoint;
         reg->classObject = classObject;
         reg->proxies = hashMap_create(NULL, NULL, NULL, NULL);
+        reg->asyncProxies = hashMap_create(NULL, NULL, NULL, NULL);
+        reg->sharedProxies = hashMap_create(utils_stringHash, NULL, utils_stringEquals, NULL);
+        reg->sharedAsyncProxies = hashMap_create(utils_stringHash, NULL, utils_stringEquals, NULL);
 
         celixThreadMutex_create(&reg->mutex, NULL);
         celixThreadMutex_create(&reg->proxiesMutex, NULL);
+        celixThreadMutex_create(&reg->coalescingMutex, NULL);
+        celixThreadCondition_init(&reg->coalescingCond, NULL);
+        arrayList_create(&reg->pendingCalls);
+        celixThreadMutex_create(&reg->cacheMutex, NULL);
+        reg->cache = hashMap_create(importRegistration_cacheKeyHash, NULL, importRegistration_cacheKeyEquals, NULL);
         status = version_createVersionFromString((char*)serviceVersion,&(reg->version));
 
         reg->factory->handle = reg;
         reg->factory->getService = (void *)importRegistration_getService;
         reg->factory->ungetService = (void *)importRegistration_ungetService;
+        reg->asyncFactory->handle = reg;
+        reg->asyncFactory->getService = (void *)importRegistration_getAsyncService;
+        reg->asyncFactory->ungetService = (void *)importRegistration_ungetAsyncService;
         reg->logFile = logFile;
     } else {
         status = CELIX_ENOMEM;
@@ -113,17 +264,193 @@ celix_status_t importRegistration_setSendFn(import_registration_t *reg,
     return CELIX_SUCCESS;
 }
 
-static void importRegistration_clearProxies(import_registration_t *import) {
+celix_status_t importRegistration_setSendBinaryFn(import_registration_t *reg,
+                                                  send_binary_func_type send,
+                                                  void *handle) {
+    celixThreadMutex_lock(&reg->mutex);
+    reg->sendBinary = send;
+    reg->sendHandle = handle;
+    celixThreadMutex_unlock(&reg->mutex);
+
+    return CELIX_SUCCESS;
+}
+
+celix_status_t importRegistration_setSendAsyncFn(import_registration_t *reg,
+                                                 send_async_func_type send,
+                                                 void *handle) {
+    celixThreadMutex_lock(&reg->mutex);
+    reg->sendAsync = send;
+    reg->sendAsyncHandle = handle;
+    celixThreadMutex_unlock(&reg->mutex);
+
+    return CELIX_SUCCESS;
+}
+
+celix_status_t importRegistration_setCoalescing(import_registration_t *reg, unsigned int windowInUs, unsigned int maxBatchSize) {
+    celix_status_t status = CELIX_SUCCESS;
+    celixThreadMutex_lock(&reg->coalescingMutex);
+    if (reg->coalescingRunning) {
+        status = CELIX_ILLEGAL_STATE;
+    } else {
+        reg->coalescingWindowInUs = windowInUs;
+        reg->coalescingMaxBatchSize = maxBatchSize > 0 ? maxBatchSize : 1;
+    }
+    celixThreadMutex_unlock(&reg->coalescingMutex);
+    return status;
+}
+
+celix_status_t importRegistration_setCallCache(import_registration_t *reg, unsigned int maxNrOfReplies) {
+    celix_status_t status = CELIX_SUCCESS;
+    if (reg->factoryReg != NULL) {
+        status = CELIX_ILLEGAL_STATE;
+    } else {
+        reg->callCacheSize = maxNrOfReplies;
+    }
+    return status;
+}
+
+static void importRegistration_unlinkCacheEntry(import_registration_t *import, import_cache_entry_t *entry) {
+    //note import->cacheMutex locked
+    if (entry->prev != NULL) {
+        entry->prev->next = entry->next;
+    } else {
+        import->cacheHead = entry->next;
+    }
+    if (entry->next != NULL) {
+        entry->next->prev = entry->prev;
+    } else {
+        import->cacheTail = entry->prev;
+    }
+    entry->prev = NULL;
+    entry->next = NULL;
+}
+
+static void importRegistration_linkCacheEntry(import_registration_t *import, import_cache_entry_t *entry) {
+    //note import->cacheMutex locked
+    entry->prev = NULL;
+    entry->next = import->cacheHead;
+    if (import->cacheHead != NULL) {
+        import->cacheHead->prev = entry;
+    } else {
+        import->cacheTail = entry;
+    }
+    import->cacheHead = entry;
+}
+
+static void importRegistration_destroyCacheEntry(import_cache_entry_t *entry) {
+    free(entry->request);
+    free(entry->reply);
+    free(entry);
+}
+
+void importRegistration_clearCallCache(import_registration_t *import) {
+    celixThreadMutex_lock(&import->cacheMutex);
+    import_cache_entry_t *entry = import->cacheHead;
+    while (entry != NULL) {
+        import_cache_entry_t *next = entry->next;
+        importRegistration_destroyCacheEntry(entry);
+        entry = next;
+    }
+    import->cacheHead = NULL;
+    import->cacheTail = NULL;
+    hashMap_clear(import->cache, false, false);
+    celixThreadMutex_unlock(&import->cacheMutex);
+}
+
+static uint64_t importRegistration_nowInMs(void) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint64_t)now.tv_sec * 1000u + (uint64_t)now.tv_nsec / 1000000u;
+}
+
+static bool importRegistration_isCacheable(import_registration_t *import, struct proxy_method *method) {
+    return method->cacheTtlInMs > 0 && import->callCacheSize > 0;
+}
+
+/**
+ * Returns a copy of the cached, not expired, reply of the request if present.
+ */
+static bool importRegistration_getCachedReply(import_registration_t *import, const uint8_t *request, size_t requestLength, uint8_t **reply, size_t *replyLength) {
+    import_cache_entry_t key;
+    memset(&key, 0, sizeof(key));
+    key.request = (uint8_t *)request;
+    key.requestLength = requestLength;
+
+    bool found = false;
+    celixThreadMutex_lock(&import->cacheMutex);
+    import_cache_entry_t *entry = hashMap_get(import->cache, &key);
+    if (entry != NULL && entry->expiresInMs <= importRegistration_nowInMs()) {
+        hashMap_remove(import->cache, entry);
+        importRegistration_unlinkCacheEntry(import, entry);
+        importRegistration_destroyCacheEntry(entry);
+        entry = NULL;
+    }
+    if (entry != NULL) {
+        *reply = malloc(entry->replyLength + 1);
+        if (*reply != NULL) {
+            memcpy(*reply, entry->reply, entry->replyLength + 1);
+            *replyLength = entry->replyLength;
+            found = true;
+            importRegistration_unlinkCacheEntry(import, entry);
+            importRegistration_linkCacheEntry(import, entry);
+        }
+    }
+    celixThreadMutex_unlock(&import->cacheMutex);
+    return found;
+}
+
+/**
+ * Caches a copy of the reply of the request, the least recently used reply is evicted if the cache is full.
+ */
+static void importRegistration_cacheReply(import_registration_t *import, const uint8_t *request, size_t requestLength, const uint8_t *reply, size_t replyLength, unsigned int ttlInMs) {
+    import_cache_entry_t *entry = calloc(1, sizeof(*entry));
+    if (entry == NULL) {
+        return;
+    }
+    entry->request = malloc(requestLength > 0 ? requestLength : 1);
+    entry->reply = malloc(replyLength + 1);
+    if (entry->request == NULL || entry->reply == NULL) {
+        importRegistration_destroyCacheEntry(entry);
+        return;
+    }
+    memcpy(entry->request, request, requestLength);
+    entry->requestLength = requestLength;
+    memcpy(entry->reply, reply, replyLength);
+    entry->reply[replyLength] = '\0';
+    entry->replyLength = replyLength;
+    entry->expiresInMs = importRegistration_nowInMs() + ttlInMs;
+
+    celixThreadMutex_lock(&import->cacheMutex);
+    import_cache_entry_t *old = hashMap_remove(import->cache, entry);
+    if (old != NULL) {
+        importRegistration_unlinkCacheEntry(import, old);
+        importRegistration_destroyCacheEntry(old);
+    }
+    while (import->cacheTail != NULL && hashMap_size(import->cache) >= (int)import->callCacheSize) {
+        import_cache_entry_t *lru = import->cacheTail;
+        hashMap_remove(import->cache, lru);
+        importRegistration_unlinkCacheEntry(import, lru);
+        importRegistration_destroyCacheEntry(lru);
+    }
+    hashMap_put(import->cache, entry, entry);
+    importRegistration_linkCacheEntry(import, entry);
+    celixThreadMutex_unlock(&import->cacheMutex);
+}
+
+static void importRegistration_clearProxies(import_registration_t *import, hash_map_pt proxies, hash_map_pt sharedProxies) {
     if (import != NULL) {
         pthread_mutex_lock(&import->proxiesMutex);
-        if (import->proxies != NULL) {
-            hash_map_iterator_pt iter = hashMapIterator_create(import->proxies);
+        if (proxies != NULL) {
+            hashMap_clear(proxies, false, true); //frees the usages
+        }
+        if (sharedProxies != NULL) {
+            hash_map_iterator_pt iter = hashMapIterator_create(sharedProxies);
             while (hashMapIterator_hasNext(iter)) {
-                hash_map_entry_pt  entry = hashMapIterator_nextEntry(iter);
-                struct service_proxy *proxy = hashMapEntry_getValue(entry);
+                struct service_proxy *proxy = hashMapIterator_nextValue(iter);
                 importRegistration_destroyProxy(proxy);
             }
             hashMapIterator_destroy(iter);
+            hashMap_clear(sharedProxies, false, false);
         }
         pthread_mutex_unlock(&import->proxiesMutex);
     }
@@ -135,13 +462,36 @@ void importRegistration_destroy(import_registration_t *import) {
             hashMap_destroy(import->proxies, false, false);
             import->proxies = NULL;
         }
+        if (import->asyncProxies != NULL) {
+            hashMap_destroy(import->asyncProxies, false, false);
+            import->asyncProxies = NULL;
+        }
+        if (import->sharedProxies != NULL) {
+            hashMap_destroy(import->sharedProxies, false, false);
+            import->sharedProxies = NULL;
+        }
+        if (import->sharedAsyncProxies != NULL) {
+            hashMap_destroy(import->sharedAsyncProxies, false, false);
+            import->sharedAsyncProxies = NULL;
+        }
 
         pthread_mutex_destroy(&import->mutex);
         pthread_mutex_destroy(&import->proxiesMutex);
+        celixThreadMutex_destroy(&import->coalescingMutex);
+        celixThreadCondition_destroy(&import->coalescingCond);
+        if (import->pendingCalls != NULL) {
+            arrayList_destroy(import->pendingCalls);
+        }
+        if (import->cache != NULL) {
+            importRegistration_clearCallCache(import);
+            hashMap_destroy(import->cache, false, false);
+        }
+        celixThreadMutex_destroy(&import->cacheMutex);
 
         if (import->factory != NULL) {
             free(import->factory);
         }
+        free(import->asyncFactory);
 
         if(import->version!=NULL){
         	version_destroy(import->version);
@@ -155,6 +505,26 @@ celix_status_t importRegistration_start(import_registration_t *import) {
     if (import->factoryReg == NULL && import->factory != NULL) {
         celix_properties_t *props =  celix_properties_copy(import->endpoint->properties);
         status = bundleContext_registerServiceFactory(import->context, (char *)import->classObject, import->factory, props, &import->factoryReg);
+        if (status == CELIX_SUCCESS && import->sendAsync != NULL) {
+            import->binaryAsync = import->sendBinary != NULL;
+            char *asyncName = NULL;
+            asprintf(&asyncName, "%s%s", import->classObject, REMOTE_ASYNC_SERVICE_NAME_SUFFIX);
+            celix_properties_t *asyncProps = celix_properties_copy(import->endpoint->properties);
+            status = bundleContext_registerServiceFactory(import->context, asyncName, import->asyncFactory, asyncProps, &import->asyncFactoryReg);
+            free(asyncName);
+        }
+        if (status == CELIX_SUCCESS && import->coalescingWindowInUs > 0) {
+            celixThreadMutex_lock(&import->coalescingMutex);
+            import->coalescingRunning = true;
+            if (celixThread_create(&import->coalescingThread, NULL, importRegistration_coalescingLoop, import) != CELIX_SUCCESS) {
+                fprintf(stderr, "RSA_DFI: Cannot start call coalescing thread for '%s', calls are sent separately", import->classObject);
+                import->coalescingRunning = false;
+                import->coalescingWindowInUs = 0;
+            } else {
+                celixThread_setName(&import->coalescingThread, "RSA coalesce");
+            }
+            celixThreadMutex_unlock(&import->coalescingMutex);
+        }
     } else {
         status = CELIX_ILLEGAL_STATE;
     }
@@ -168,37 +538,63 @@ celix_status_t importRegistration_stop(import_registration_t *import) {
         serviceRegistration_unregister(import->factoryReg);
         import->factoryReg = NULL;
     }
+    if (import->asyncFactoryReg != NULL) {
+        serviceRegistration_unregister(import->asyncFactoryReg);
+        import->asyncFactoryReg = NULL;
+    }
 
-    importRegistration_clearProxies(import);
+    celixThreadMutex_lock(&import->coalescingMutex);
+    bool coalescing = import->coalescingRunning;
+    import->coalescingRunning = false;
+    celixThreadCondition_broadcast(&import->coalescingCond);
+    celixThreadMutex_unlock(&import->coalescingMutex);
+    if (coalescing) {
+        celixThread_join(import->coalescingThread, NULL);
+    }
+
+    importRegistration_clearProxies(import, import->proxies, import->sharedProxies);
+    importRegistration_clearProxies(import, import->asyncProxies, import->sharedAsyncProxies);
+    importRegistration_clearCallCache(import);
 
     return status;
 }
 
 
 celix_status_t importRegistration_getService(import_registration_t *import, celix_bundle_t *bundle, service_registration_t *registration, void **out) {
-    celix_status_t  status = CELIX_SUCCESS;
+    return importRegistration_getProxy(import, import->proxies, import->sharedProxies, bundle, false, out);
+}
 
-    /*
-    module_pt module = NULL;
-    char *name = NULL;
-    bundle_getCurrentModule(bundle, &module);
-    module_getSymbolicName(module, &name);
-    printf("getting service for bundle '%s'\n", name);
-     */
+static celix_status_t importRegistration_getAsyncService(import_registration_t *import, celix_bundle_t *bundle, service_registration_t *registration, void **out) {
+    return importRegistration_getProxy(import, import->asyncProxies, import->sharedAsyncProxies, bundle, true, out);
+}
 
+static celix_status_t importRegistration_getProxy(import_registration_t *import, hash_map_pt proxies, hash_map_pt sharedProxies, celix_bundle_t *bundle, bool async, void **out) {
+    celix_status_t  status = CELIX_SUCCESS;
 
     pthread_mutex_lock(&import->proxiesMutex);
-    struct service_proxy *proxy = hashMap_get(import->proxies, bundle);
-    if (proxy == NULL) {
-        status = importRegistration_createProxy(import, bundle, &proxy);
+    struct service_proxy_usage *usage = hashMap_get(proxies, bundle);
+    if (usage == NULL) {
+        struct service_proxy *proxy = NULL;
+        status = importRegistration_createProxy(import, bundle, async, sharedProxies, &proxy);
         if (status == CELIX_SUCCESS) {
-            hashMap_put(import->proxies, bundle, proxy);
+            usage = calloc(1, sizeof(*usage));
+            if (usage != NULL) {
+                usage->proxy = proxy;
+                proxy->count += 1;
+                hashMap_put(proxies, bundle, usage);
+            } else {
+                status = CELIX_ENOMEM;
+                if (proxy->count == 0) {
+                    hashMap_remove(sharedProxies, proxy->version);
+                    importRegistration_destroyProxy(proxy);
+                }
+            }
         }
     }
 
     if (status == CELIX_SUCCESS) {
-        proxy->count += 1;
-        *out = proxy->service;
+        usage->count += 1;
+        *out = usage->proxy->service;
     }
     pthread_mutex_unlock(&import->proxiesMutex);
 
@@ -234,7 +630,59 @@ static celix_status_t importRegistration_findAndParseInterfaceDescriptor(celix_b
     return CELIX_BUNDLE_EXCEPTION;
 }
 
-static celix_status_t importRegistration_createProxy(import_registration_t *import, celix_bundle_t *bundle, struct service_proxy **out) {
+/**
+ * Parses the async variant of the (dfi) descriptor: every method gets an extra trailing pointer argument, the
+ * remote_async_call_t ** output argument. The method ids are unchanged.
+ */
+static celix_status_t importRegistration_findAndParseAsyncInterfaceDescriptor(celix_bundle_context_t * const context, celix_bundle_t * const bundle, char const * const name, dyn_interface_type **out) {
+    FILE* descriptor = NULL;
+    celix_status_t status = dfi_findDescriptor(context, bundle, name, &descriptor);
+    if (status != CELIX_SUCCESS) {
+        fprintf(stderr, "RSA_DFI: Cannot find dfi descriptor for async '%s', async proxies are not supported for avpr descriptors", name);
+        return status;
+    }
+
+    char *asyncDescriptor = NULL;
+    size_t asyncDescriptorSize = 0;
+    FILE *stream = open_memstream(&asyncDescriptor, &asyncDescriptorSize);
+    char *line = NULL;
+    size_t lineSize = 0;
+    bool inMethods = false;
+    while (getline(&line, &lineSize, descriptor) != -1) {
+        char *end = NULL;
+        if (line[0] == ':') {
+            inMethods = strncmp(line, ":methods", strlen(":methods")) == 0;
+        } else if (inMethods) {
+            end = strrchr(line, ')');
+        }
+        if (end != NULL) {
+            fprintf(stream, "%.*sP%s", (int)(end - line), line, end);
+        } else {
+            fputs(line, stream);
+        }
+    }
+    free(line);
+    fclose(stream);
+    fclose(descriptor);
+
+    stream = fmemopen(asyncDescriptor, asyncDescriptorSize, "r");
+    int rc = stream != NULL ? dynInterface_parse(stream, out) : 1;
+    if (stream != NULL) {
+        fclose(stream);
+    }
+    free(asyncDescriptor);
+    if (rc != 0) {
+        fprintf(stderr, "RSA_DFI: Cannot parse async dfi descriptor for '%s'", name);
+        status = CELIX_BUNDLE_EXCEPTION;
+    }
+    return status;
+}
+
+/**
+ * Returns the shared proxy for the consumer interface version of the bundle, creating (and adding) it if needed.
+ * The descriptor of the bundle is always parsed to find its version, but only kept for a new proxy.
+ */
+static celix_status_t importRegistration_createProxy(import_registration_t *import, celix_bundle_t *bundle, bool async, hash_map_pt sharedProxies, struct service_proxy **out) {
     dyn_interface_type* intf = NULL;
     celix_status_t  status = importRegistration_findAndParseInterfaceDescriptor(import->context, bundle, import->classObject, &intf);
 
@@ -242,6 +690,19 @@ static celix_status_t importRegistration_createProxy(import_registration_t *impo
         return status;
     }
 
+    char *version = NULL;
+    dynInterface_getVersionString(intf, &version);
+    if (version == NULL) {
+        version = "";
+    }
+    struct service_proxy *shared = hashMap_get(sharedProxies, version);
+    if (shared != NULL) {
+        //compatibility is already checked for the shared proxy
+        dynInterface_destroy(intf);
+        *out = shared;
+        return CELIX_SUCCESS;
+    }
+
     /* Check if the imported service version is compatible with the one in the consumer descriptor */
     version_pt consumerVersion = NULL;
     bool isCompatible = false;
@@ -260,6 +721,15 @@ static celix_status_t importRegistration_createProxy(import_registration_t *impo
     	status = CELIX_SERVICE_EXCEPTION;
     }
 
+    dyn_interface_type* asyncIntf = NULL;
+    if (status == CELIX_SUCCESS && async) {
+        status = importRegistration_findAndParseAsyncInterfaceDescriptor(import->context, bundle, import->classObject, &asyncIntf);
+        if (status != CELIX_SUCCESS) {
+            dynInterface_destroy(intf);
+            return status;
+        }
+    }
+
     struct service_proxy *proxy = NULL;
     if (status == CELIX_SUCCESS) {
         proxy = calloc(1, sizeof(*proxy));
@@ -270,9 +740,14 @@ static celix_status_t importRegistration_createProxy(import_registration_t *impo
 
     if (status == CELIX_SUCCESS) {
     	proxy->intf = intf;
+    	proxy->asyncIntf = asyncIntf;
+    	proxy->version = version;
         size_t count = dynInterface_nrOfMethods(proxy->intf);
         proxy->service = calloc(1 + count, sizeof(void *));
-        if (proxy->service == NULL) {
+        if (asyncIntf == NULL) {
+            proxy->methods = calloc(count > 0 ? count : 1, sizeof(*proxy->methods));
+        }
+        if (proxy->service == NULL || (asyncIntf == NULL && proxy->methods == NULL)) {
             status = CELIX_ENOMEM;
         }
     }
@@ -283,11 +758,28 @@ static celix_status_t importRegistration_createProxy(import_registration_t *impo
 
         struct methods_head *list = NULL;
         dynInterface_methods(proxy->intf, &list);
+        struct methods_head *asyncList = NULL;
+        struct method_entry *asyncEntry = NULL;
+        if (proxy->asyncIntf != NULL) {
+            dynInterface_methods(proxy->asyncIntf, &asyncList);
+            asyncEntry = TAILQ_FIRST(asyncList);
+        }
         struct method_entry *entry = NULL;
         void (*fn)(void) = NULL;
         int index = 0;
         TAILQ_FOREACH(entry, list, entries) {
-            int rc = dynFunction_createClosure(entry->dynFunc, importRegistration_proxyFunc, entry, &fn);
+            int rc;
+            if (asyncEntry != NULL) {
+                //the closure has the async signature, the call itself is prepared with the (sync) method entry
+                rc = dynFunction_createClosure(asyncEntry->dynFunc, importRegistration_proxyFuncAsync, entry, &fn);
+                asyncEntry = TAILQ_NEXT(asyncEntry, entries);
+            } else {
+                struct proxy_method *method = &proxy->methods[index];
+                method->entry = entry;
+                const char *ttl = dynInterface_getMethodAnnotation(proxy->intf, entry, "cacheTtlMs");
+                method->cacheTtlInMs = ttl != NULL ? (unsigned int)strtoul(ttl, NULL, 10) : 0;
+                rc = dynFunction_createClosure(entry->dynFunc, importRegistration_proxyFunc, method, &fn);
+            }
             serv[index + 1] = fn;
             index += 1;
 
@@ -299,12 +791,18 @@ static celix_status_t importRegistration_createProxy(import_registration_t *impo
     }
 
     if (status == CELIX_SUCCESS) {
+        hashMap_put(sharedProxies, (void *)proxy->version, proxy);
         *out = proxy;
     } else if (proxy != NULL) {
         if (proxy->intf != NULL) {
             dynInterface_destroy(proxy->intf);
             proxy->intf = NULL;
         }
+        if (proxy->asyncIntf != NULL) {
+            dynInterface_destroy(proxy->asyncIntf);
+            proxy->asyncIntf = NULL;
+        }
+        free(proxy->methods);
         free(proxy->service);
         free(proxy);
     }
@@ -314,11 +812,15 @@ static celix_status_t importRegistration_createProxy(import_registration_t *impo
 
 static void importRegistration_proxyFunc(void *userData, void *args[], void *returnVal) {
     int  status = CELIX_SUCCESS;
-    struct method_entry *entry = userData;
+    struct proxy_method *method = userData;
+    struct method_entry *entry = method->entry;
     import_registration_t *import = *((void **)args[0]);
 
-    if (import == NULL || import->send == NULL) {
+    if (import == NULL || (import->send == NULL && import->sendBinary == NULL)) {
         status = CELIX_ILLEGAL_ARGUMENT;
+    } else if (import->sendBinary != NULL) {
+        importRegistration_proxyFuncBinary(import, method, args, returnVal);
+        return;
     }
 
 
@@ -332,17 +834,29 @@ static void importRegistration_proxyFunc(void *userData, void *args[], void *ret
     if (status == CELIX_SUCCESS) {
         char *reply = NULL;
         int rc = 0;
+        size_t replyLength = 0;
+        bool cacheable = importRegistration_isCacheable(import, method);
+        bool cached = cacheable && importRegistration_getCachedReply(import, (uint8_t *)invokeRequest, strlen(invokeRequest), (uint8_t **)&reply, &replyLength);
         //printf("sending request\n");
-        celixThreadMutex_lock(&import->mutex);
-        if (import->send != NULL) {
-            import->send(import->sendHandle, import->endpoint, invokeRequest, &reply, &rc);
+        if (cached) {
+            cacheable = false; //already in the cache
+        } else if (import->coalescingWindowInUs > 0) {
+            importRegistration_coalescedSend(import, (uint8_t *)invokeRequest, strlen(invokeRequest), (uint8_t **)&reply, &replyLength, &rc);
+        } else {
+            celixThreadMutex_lock(&import->mutex);
+            if (import->send != NULL) {
+                import->send(import->sendHandle, import->endpoint, invokeRequest, &reply, &rc);
+            }
+            celixThreadMutex_unlock(&import->mutex);
         }
-        celixThreadMutex_unlock(&import->mutex);
         //printf("request sended. got reply '%s' with status %i\n", reply, rc);
 
         if (rc == 0) {
             //fjprintf("Handling reply '%s'\n", reply);
             status = jsonRpc_handleReply(entry->dynFunc, reply, args);
+            if (status == CELIX_SUCCESS && cacheable && reply != NULL) {
+                importRegistration_cacheReply(import, (uint8_t *)invokeRequest, strlen(invokeRequest), (uint8_t *)reply, strlen(reply), method->cacheTtlInMs);
+            }
         }
 
         *(int *) returnVal = rc;
@@ -365,25 +879,448 @@ static void importRegistration_proxyFunc(void *userData, void *args[], void *ret
     }
 }
 
-celix_status_t importRegistration_ungetService(import_registration_t *import, celix_bundle_t *bundle, service_registration_t *registration, void **out) {
+static void importRegistration_proxyFuncBinary(import_registration_t *import, struct proxy_method *method, void *args[], void *returnVal) {
+    struct method_entry *entry = method->entry;
+    bool cacheable = importRegistration_isCacheable(import, method);
+    //cacheable calls use call id 0, so calls with equal arguments have equal requests
+    uint64_t callId = cacheable ? 0 : __atomic_add_fetch(&import->callCounter, 1, __ATOMIC_RELAXED);
+    uint8_t *request = NULL;
+    size_t requestLength = 0;
+    int status = avrobinRpc_prepareInvokeRequest(entry->dynFunc, entry->id, callId, args, &request, &requestLength);
+
+    int rc = CELIX_ILLEGAL_STATE;
+    if (status == CELIX_SUCCESS) {
+        uint8_t *reply = NULL;
+        size_t replyLength = 0;
+        bool cached = cacheable && importRegistration_getCachedReply(import, request, requestLength, &reply, &replyLength);
+        if (cached) {
+            rc = 0;
+            cacheable = false; //already in the cache
+        } else if (import->coalescingWindowInUs > 0) {
+            importRegistration_coalescedSend(import, request, requestLength, &reply, &replyLength, &rc);
+        } else {
+            celixThreadMutex_lock(&import->mutex);
+            if (import->sendBinary != NULL) {
+                import->sendBinary(import->sendHandle, import->endpoint, request, requestLength, &reply, &replyLength, &rc);
+            }
+            celixThreadMutex_unlock(&import->mutex);
+        }
+
+        if (rc == 0) {
+            int replyStatus = 0;
+            status = avrobinRpc_handleReply(entry->dynFunc, callId, reply, replyLength, args, &replyStatus);
+            rc = status == CELIX_SUCCESS ? replyStatus : CELIX_ILLEGAL_STATE;
+            if (rc == 0 && cacheable) {
+                importRegistration_cacheReply(import, request, requestLength, reply, replyLength, method->cacheTtlInMs);
+            }
+        }
+
+        if (import->logFile != NULL) {
+            static int callCount = 0;
+            const char *url = importRegistration_getUrl(import);
+            const char *svcName = importRegistration_getServiceName(import);
+            fprintf(import->logFile, "REMOTE BINARY CALL NR %i\n\turl=%s\n\tservice=%s\n\tmethod=%s\n\trequest_size=%zu\n\treturn_code=%i\n\treply_size=%zu\n",
+                    callCount, url, svcName, entry->id, requestLength, rc, replyLength);
+            fflush(import->logFile);
+            callCount += 1;
+        }
+        free(reply);
+    }
+    free(request);
+
+    *(int *) returnVal = rc;
+}
+
+static void importRegistration_proxyFuncAsync(void *userData, void *args[], void *returnVal) {
+    struct method_entry *entry = userData;
+    import_registration_t *import = *((void **)args[0]);
+    int nrOfArgs = dynFunction_nrOfArguments(entry->dynFunc);
+    remote_async_call_t **callOut = *(remote_async_call_t ***)args[nrOfArgs];
+
+    int status = CELIX_SUCCESS;
+    import_async_call_t *call = NULL;
+    if (import == NULL || import->sendAsync == NULL || callOut == NULL) {
+        status = CELIX_ILLEGAL_ARGUMENT;
+    } else {
+        call = calloc(1, sizeof(*call));
+        if (call != NULL) {
+            call->refCount = 1; //caller
+            celixThreadMutex_create(&call->mutex, NULL);
+            celixThreadCondition_init(&call->cond, NULL);
+            call->args = calloc(nrOfArgs, sizeof(void *));
+            call->argValues = calloc(nrOfArgs, sizeof(void *));
+        }
+        if (call == NULL || call->args == NULL || call->argValues == NULL) {
+            status = CELIX_ENOMEM;
+        }
+    }
+
+    uint8_t *request = NULL;
+    size_t requestLength = 0;
+    if (status == CELIX_SUCCESS) {
+        call->call.handle = call;
+        call->call.wait = importRegistration_asyncCallWait;
+        call->call.destroy = importRegistration_asyncCallDestroy;
+        call->entry = entry;
+        call->binary = import->binaryAsync;
+        for (int i = 0; i < nrOfArgs; ++i) {
+            enum dyn_function_argument_meta meta = dynFunction_argumentMetaForIndex(entry->dynFunc, i);
+            if (meta == DYN_FUNCTION_ARGUMENT_META__PRE_ALLOCATED_OUTPUT || meta == DYN_FUNCTION_ARGUMENT_META__OUTPUT) {
+                call->argValues[i] = *(void **)args[i];
+                call->args[i] = &call->argValues[i];
+            }
+        }
+
+        if (call->binary) {
+            call->callId = __atomic_add_fetch(&import->callCounter, 1, __ATOMIC_RELAXED);
+            status = avrobinRpc_prepareInvokeRequest(entry->dynFunc, entry->id, call->callId, args, &request, &requestLength);
+        } else {
+            char *invokeRequest = NULL;
+            status = jsonRpc_prepareInvokeRequest(entry->dynFunc, entry->id, args, &invokeRequest);
+            request = (uint8_t *)invokeRequest;
+            requestLength = invokeRequest != NULL ? strlen(invokeRequest) : 0;
+        }
+    }
+
+    if (status == CELIX_SUCCESS) {
+        call->refCount = 2; //caller & async send
+        if (import->coalescingWindowInUs > 0) {
+            status = importRegistration_enqueueCall(import, request, requestLength, true, importRegistration_asyncCallCompleted, call);
+        } else {
+            celixThreadMutex_lock(&import->mutex);
+            status = import->sendAsync(import->sendAsyncHandle, import->endpoint, call->binary, request, requestLength, importRegistration_asyncCallCompleted, call);
+            celixThreadMutex_unlock(&import->mutex);
+        }
+        if (status == CELIX_SUCCESS) {
+            *callOut = &call->call;
+        } else {
+            call->refCount = 1; //no async send
+        }
+    } else {
+        free(request);
+    }
+
+    if (status != CELIX_SUCCESS && call != NULL) {
+        importRegistration_asyncCallDestroy(call);
+    }
+
+    *(int *) returnVal = status;
+}
+
+static void importRegistration_asyncCallRelease(import_async_call_t *call) {
+    celixThreadMutex_lock(&call->mutex);
+    call->refCount -= 1;
+    bool destroy = call->refCount == 0;
+    celixThreadMutex_unlock(&call->mutex);
+
+    if (destroy) {
+        celixThreadMutex_destroy(&call->mutex);
+        celixThreadCondition_destroy(&call->cond);
+        free(call->reply);
+        free(call->args);
+        free(call->argValues);
+        free(call);
+    }
+}
+
+static void importRegistration_asyncCallCompleted(void *handle, int replyStatus, uint8_t *reply, size_t replyLength) {
+    import_async_call_t *call = handle;
+    celixThreadMutex_lock(&call->mutex);
+    call->replyStatus = replyStatus;
+    call->reply = reply;
+    call->replyLength = replyLength;
+    call->completed = true;
+    celixThreadCondition_broadcast(&call->cond);
+    celixThreadMutex_unlock(&call->mutex);
+    importRegistration_asyncCallRelease(call);
+}
+
+/**
+ * Waits for the reply and handles it in the caller thread, the caller still holds the async proxy and with that
+ * the dyn function of the method.
+ */
+static int importRegistration_asyncCallWait(void *handle, int timeoutInMs) {
+    import_async_call_t *call = handle;
+    struct timespec deadline;
+    clock_gettime(CLOCK_MONOTONIC, &deadline);
+    deadline.tv_sec += timeoutInMs / 1000;
+    deadline.tv_nsec += (timeoutInMs % 1000) * 1000000L;
+
+    celixThreadMutex_lock(&call->mutex);
+    while (!call->completed) {
+        if (timeoutInMs < 0) {
+            celixThreadCondition_wait(&call->cond, &call->mutex);
+        } else {
+            struct timespec now;
+            clock_gettime(CLOCK_MONOTONIC, &now);
+            long remainingNs = (deadline.tv_sec - now.tv_sec) * 1000000000L + (deadline.tv_nsec - now.tv_nsec);
+            if (remainingNs <= 0) {
+                break;
+            }
+            celixThreadCondition_timedwaitRelative(&call->cond, &call->mutex, remainingNs / 1000000000L, remainingNs % 1000000000L);
+        }
+    }
+
+    int rc = ETIMEDOUT;
+    if (call->completed) {
+        if (!call->handled && call->replyStatus == 0) {
+            int status;
+            if (call->binary) {
+                int replyStatus = 0;
+                status = avrobinRpc_handleReply(call->entry->dynFunc, call->callId, call->reply, call->replyLength, call->args, &replyStatus);
+                call->replyStatus = status == CELIX_SUCCESS ? replyStatus : CELIX_ILLEGAL_STATE;
+            } else {
+                status = jsonRpc_handleReply(call->entry->dynFunc, (const char *)call->reply, call->args);
+                call->replyStatus = status == CELIX_SUCCESS ? 0 : CELIX_ILLEGAL_STATE;
+            }
+        }
+        call->handled = true;
+        rc = call->replyStatus;
+    }
+    celixThreadMutex_unlock(&call->mutex);
+    return rc;
+}
+
+static void importRegistration_asyncCallDestroy(void *handle) {
+    importRegistration_asyncCallRelease(handle);
+}
+
+static celix_status_t importRegistration_enqueueCall(import_registration_t *import, uint8_t *request, size_t requestLength, bool ownsRequest, send_async_complete_func_type complete, void *completeHandle) {
+    import_pending_call_t *pending = calloc(1, sizeof(*pending));
+    if (pending == NULL) {
+        return CELIX_ENOMEM;
+    }
+    pending->request = request;
+    pending->requestLength = requestLength;
+    pending->ownsRequest = ownsRequest;
+    pending->complete = complete;
+    pending->completeHandle = completeHandle;
+
+    celix_status_t status = CELIX_SUCCESS;
+    celixThreadMutex_lock(&import->coalescingMutex);
+    if (import->coalescingRunning) {
+        arrayList_add(import->pendingCalls, pending);
+        int size = arrayList_size(import->pendingCalls);
+        //wake the coalescing thread for the first call of a batch and when the batch is full
+        if (size == 1 || size >= (int)import->coalescingMaxBatchSize) {
+            celixThreadCondition_signal(&import->coalescingCond);
+        }
+    } else {
+        status = CELIX_ILLEGAL_STATE;
+    }
+    celixThreadMutex_unlock(&import->coalescingMutex);
+
+    if (status != CELIX_SUCCESS) {
+        free(pending);
+    }
+    return status;
+}
+
+static void importRegistration_syncCallCompleted(void *handle, int replyStatus, uint8_t *reply, size_t replyLength) {
+    import_sync_call_t *call = handle;
+    celixThreadMutex_lock(&call->mutex);
+    call->replyStatus = replyStatus;
+    call->reply = reply;
+    call->replyLength = replyLength;
+    call->completed = true;
+    celixThreadCondition_signal(&call->cond);
+    celixThreadMutex_unlock(&call->mutex);
+}
+
+/**
+ * Queues the request for the coalescing thread and waits for its reply. The request stays owned by the caller.
+ */
+static void importRegistration_coalescedSend(import_registration_t *import, uint8_t *request, size_t requestLength, uint8_t **reply, size_t *replyLength, int *replyStatus) {
+    import_sync_call_t call;
+    memset(&call, 0, sizeof(call));
+    celixThreadMutex_create(&call.mutex, NULL);
+    celixThreadCondition_init(&call.cond, NULL);
+
+    celix_status_t status = importRegistration_enqueueCall(import, request, requestLength, false, importRegistration_syncCallCompleted, &call);
+    if (status == CELIX_SUCCESS) {
+        celixThreadMutex_lock(&call.mutex);
+        while (!call.completed) {
+            celixThreadCondition_wait(&call.cond, &call.mutex);
+        }
+        celixThreadMutex_unlock(&call.mutex);
+        *reply = call.reply;
+        *replyLength = call.replyLength;
+        *replyStatus = call.replyStatus;
+    } else {
+        *replyStatus = status;
+    }
+
+    celixThreadMutex_destroy(&call.mutex);
+    celixThreadCondition_destroy(&call.cond);
+}
+
+/**
+ * Sends the calls as one batch request (or as a plain request for a single call) and completes every call with its
+ * part of the reply.
+ */
+static void importRegistration_sendBatch(import_registration_t *import, import_pending_call_t *calls[], int count) {
+    bool binary = import->sendBinary != NULL;
+    uint8_t *replies[count];
+    size_t replyLengths[count];
+    int replyStatus[count];
+    memset(replies, 0, sizeof(replies));
+    memset(replyLengths, 0, sizeof(replyLengths));
+
+    int rc = CELIX_ILLEGAL_STATE;
+    uint8_t *request = NULL;
+    size_t requestLength = 0;
+    if (count == 1) {
+        request = calls[0]->request;
+        requestLength = calls[0]->requestLength;
+        rc = CELIX_SUCCESS;
+    } else if (binary) {
+        const uint8_t *requests[count];
+        size_t requestLengths[count];
+        for (int i = 0; i < count; ++i) {
+            requests[i] = calls[i]->request;
+            requestLengths[i] = calls[i]->requestLength;
+        }
+        rc = avrobinRpc_prepareBatchRequest(requests, requestLengths, (size_t)count, &request, &requestLength);
+    } else {
+        char *requests[count];
+        for (int i = 0; i < count; ++i) {
+            requests[i] = (char *)calls[i]->request;
+        }
+        char *batch = NULL;
+        rc = jsonRpc_prepareBatchRequest(requests, (size_t)count, &batch);
+        request = (uint8_t *)batch;
+        requestLength = batch != NULL ? strlen(batch) : 0;
+    }
+
+    uint8_t *reply = NULL;
+    size_t replyLength = 0;
+    if (rc == CELIX_SUCCESS) {
+        rc = CELIX_ILLEGAL_STATE;
+        celixThreadMutex_lock(&import->mutex);
+        if (binary && import->sendBinary != NULL) {
+            import->sendBinary(import->sendHandle, import->endpoint, request, requestLength, &reply, &replyLength, &rc);
+        } else if (!binary && import->send != NULL) {
+            import->send(import->sendHandle, import->endpoint, (char *)request, (char **)&reply, &rc);
+            replyLength = reply != NULL ? strlen((char *)reply) : 0;
+        }
+        celixThreadMutex_unlock(&import->mutex);
+    }
+
+    for (int i = 0; i < count; ++i) {
+        replyStatus[i] = rc;
+    }
+    if (rc == CELIX_SUCCESS && count == 1) {
+        replies[0] = reply;
+        replyLengths[0] = replyLength;
+        reply = NULL;
+    } else if (rc == CELIX_SUCCESS && binary) {
+        const uint8_t *parts[count];
+        size_t partLengths[count];
+        if (avrobinRpc_splitBatchReply(reply, replyLength, (size_t)count, parts, partLengths) != 0) {
+            memset(partLengths, 0, sizeof(partLengths));
+        }
+        for (int i = 0; i < count; ++i) {
+            replies[i] = partLengths[i] > 0 ? malloc(partLengths[i]) : NULL;
+            if (replies[i] != NULL) {
+                memcpy(replies[i], parts[i], partLengths[i]);
+                replyLengths[i] = partLengths[i];
+            } else {
+                replyStatus[i] = CELIX_ILLEGAL_STATE;
+            }
+        }
+    } else if (rc == CELIX_SUCCESS) {
+        char *parts[count];
+        jsonRpc_splitBatchReply((const char *)reply, (size_t)count, parts);
+        for (int i = 0; i < count; ++i) {
+            replies[i] = (uint8_t *)parts[i];
+            if (parts[i] != NULL) {
+                replyLengths[i] = strlen(parts[i]);
+            } else {
+                replyStatus[i] = CELIX_ILLEGAL_STATE;
+            }
+        }
+    }
+    free(reply);
+    if (count > 1) {
+        free(request);
+    }
+
+    if (import->logFile != NULL && count > 1) {
+        fprintf(import->logFile, "REMOTE BATCH CALL\n\turl=%s\n\tservice=%s\n\tcalls=%i\n\trequest_size=%zu\n\treturn_code=%i\n",
+                importRegistration_getUrl(import), importRegistration_getServiceName(import), count, requestLength, rc);
+        fflush(import->logFile);
+    }
+
+    for (int i = 0; i < count; ++i) {
+        if (calls[i]->ownsRequest) {
+            free(calls[i]->request);
+        }
+        calls[i]->complete(calls[i]->completeHandle, replyStatus[i], replies[i], replyLengths[i]);
+        free(calls[i]);
+    }
+}
+
+/**
+ * Collects the calls issued within the coalescing window (or until the batch is full) and sends them as one request.
+ * Calls still queued when the import is stopped are sent before the thread ends.
+ */
+static void* importRegistration_coalescingLoop(void *data) {
+    import_registration_t *import = data;
+    long windowInS = (long)(import->coalescingWindowInUs / 1000000);
+    long windowInNs = (long)(import->coalescingWindowInUs % 1000000) * 1000L;
+
+    celixThreadMutex_lock(&import->coalescingMutex);
+    while (import->coalescingRunning || arrayList_size(import->pendingCalls) > 0) {
+        int size = arrayList_size(import->pendingCalls);
+        if (size == 0) {
+            celixThreadCondition_wait(&import->coalescingCond, &import->coalescingMutex);
+            continue;
+        }
+        if (import->coalescingRunning && size < (int)import->coalescingMaxBatchSize) {
+            celixThreadCondition_timedwaitRelative(&import->coalescingCond, &import->coalescingMutex, windowInS, windowInNs);
+            size = arrayList_size(import->pendingCalls);
+        }
+
+        int count = size < (int)import->coalescingMaxBatchSize ? size : (int)import->coalescingMaxBatchSize;
+        import_pending_call_t *calls[count];
+        for (int i = 0; i < count; ++i) {
+            calls[i] = arrayList_remove(import->pendingCalls, 0);
+        }
+        celixThreadMutex_unlock(&import->coalescingMutex);
+
+        importRegistration_sendBatch(import, calls, count);
+
+        celixThreadMutex_lock(&import->coalescingMutex);
+    }
+    celixThreadMutex_unlock(&import->coalescingMutex);
+    return NULL;
+}
+
+static celix_status_t importRegistration_ungetProxy(import_registration_t *import, hash_map_pt proxies, hash_map_pt sharedProxies, celix_bundle_t *bundle, void **out) {
     celix_status_t  status = CELIX_SUCCESS;
 
     assert(import != NULL);
-    assert(import->proxies != NULL);
+    assert(proxies != NULL);
 
     pthread_mutex_lock(&import->proxiesMutex);
 
-    struct service_proxy *proxy = hashMap_get(import->proxies, bundle);
-    if (proxy != NULL) {
+    struct service_proxy_usage *usage = hashMap_get(proxies, bundle);
+    if (usage != NULL) {
+        struct service_proxy *proxy = usage->proxy;
         if (*out == proxy->service) {
-            proxy->count -= 1;
+            usage->count -= 1;
         } else {
             status = CELIX_ILLEGAL_ARGUMENT;
         }
 
-        if (proxy->count == 0) {
-            hashMap_remove(import->proxies, bundle);
-            importRegistration_destroyProxy(proxy);
+        if (usage->count == 0) {
+            hashMap_remove(proxies, bundle);
+            free(usage);
+            proxy->count -= 1;
+            if (proxy->count == 0) {
+                hashMap_remove(sharedProxies, proxy->version);
+                importRegistration_destroyProxy(proxy);
+            }
         }
     }
 
@@ -392,14 +1329,26 @@ celix_status_t importRegistration_ungetService(import_registration_t *import, ce
     return status;
 }
 
+celix_status_t importRegistration_ungetService(import_registration_t *import, celix_bundle_t *bundle, service_registration_t *registration, void **out) {
+    return importRegistration_ungetProxy(import, import->proxies, import->sharedProxies, bundle, out);
+}
+
+static celix_status_t importRegistration_ungetAsyncService(import_registration_t *import, celix_bundle_t *bundle, service_registration_t *registration, void **out) {
+    return importRegistration_ungetProxy(import, import->asyncProxies, import->sharedAsyncProxies, bundle, out);
+}
+
 static void importRegistration_destroyProxy(struct service_proxy *proxy) {
     if (proxy != NULL) {
         if (proxy->intf != NULL) {
             dynInterface_destroy(proxy->intf);
         }
+        if (proxy->asyncIntf != NULL) {
+            dynInterface_destroy(proxy->asyncIntf);
+        }
         if (proxy->service != NULL) {
             free(proxy->service);
         }
+        free(proxy->methods);
         free(proxy);
     }
 }
@@ -23,9 +23,22 @@
 #include "import_registration.h"
 #include "dfi_utils.h"
 
+#include <stdint.h>
+#include <stdbool.h>
 #include <celix_errno.h>
 
 typedef void (*send_func_type)(void *handle, endpoint_description_t *endpointDescription, char *request, char **reply, int* replyStatus);
+typedef void (*send_binary_func_type)(void *handle, endpoint_description_t *endpointDescription, const uint8_t *request, size_t requestLength, uint8_t **reply, size_t *replyLength, int* replyStatus);
+
+/**
+ * Called (once) when an async send is completed, from the async send thread. The reply is owned by the callee.
+ */
+typedef void (*send_async_complete_func_type)(void *completeHandle, int replyStatus, uint8_t *reply, size_t replyLength);
+/**
+ * Sends the request without waiting for the reply. The request is owned by the async send, also on error.
+ * On success complete is called when the reply is received or the send failed.
+ */
+typedef celix_status_t (*send_async_func_type)(void *handle, endpoint_description_t *endpointDescription, bool binary, uint8_t *request, size_t requestLength, send_async_complete_func_type complete, void *completeHandle);
 
 celix_status_t importRegistration_create(celix_bundle_context_t *context, endpoint_description_t *description, const char *classObject, const char* serviceVersion, FILE *logFile,
                                          import_registration_t **import);
@@ -35,6 +48,34 @@ void importRegistration_destroy(import_registration_t *import);
 celix_status_t importRegistration_setSendFn(import_registration_t *reg,
                                             send_func_type,
                                             void *handle);
+/**
+ * Sets the send function for binary (avrobin rpc) calls. If set, the proxies use the binary encoding instead of json.
+ */
+celix_status_t importRegistration_setSendBinaryFn(import_registration_t *reg,
+                                                  send_binary_func_type,
+                                                  void *handle);
+/**
+ * Sets the async send function. If set, an async variant of the service is registered next to the imported service.
+ * Must be set before the import is started.
+ */
+celix_status_t importRegistration_setSendAsyncFn(import_registration_t *reg,
+                                                 send_async_func_type,
+                                                 void *handle);
+/**
+ * Enables coalescing of the calls of the imported service: calls issued within windowInUs of each other are sent
+ * as one batch request of at most maxBatchSize calls. Should be set before the import registration is started.
+ */
+celix_status_t importRegistration_setCoalescing(import_registration_t *reg, unsigned int windowInUs, unsigned int maxBatchSize);
+/**
+ * Enables caching of the replies of methods with the cacheTtlMs annotation (see dyn_interface.h): at most
+ * maxNrOfReplies replies are cached, the least recently used one is evicted first. Must be set before the import
+ * registration is started.
+ */
+celix_status_t importRegistration_setCallCache(import_registration_t *reg, unsigned int maxNrOfReplies);
+/**
+ * Drops the cached replies, e.g. because the endpoints of the import changed.
+ */
+void importRegistration_clearCallCache(import_registration_t *import);
 celix_status_t importRegistration_start(import_registration_t *import);
 celix_status_t importRegistration_stop(import_registration_t *import);
 
@@ -32,6 +32,9 @@ struct activator {
 	remote_service_admin_t *admin;
 	remote_service_admin_service_t *adminService;
 	service_registration_t *registration;
+
+	celix_metrics_provider_service_t metricsSvc;
+	long metricsSvcId;
 };
 
 celix_status_t bundleActivator_create(celix_bundle_context_t *context, void **userData) {
@@ -44,6 +47,7 @@ celix_status_t bundleActivator_create(celix_bundle_context_t *context, void **us
 	} else {
 		activator->admin = NULL;
 		activator->registration = NULL;
+		activator->metricsSvcId = -1L;
 
 		*userData = activator;
 	}
@@ -88,6 +92,12 @@ celix_status_t bundleActivator_start(void * userData, celix_bundle_context_t *co
 		}
 	}
 
+	if (status == CELIX_SUCCESS) {
+		activator->metricsSvc.handle = activator->admin;
+		activator->metricsSvc.collect = remoteServiceAdmin_collectMetrics;
+		activator->metricsSvcId = celix_bundleContext_registerService(context, &activator->metricsSvc, CELIX_METRICS_PROVIDER_SERVICE_NAME, NULL);
+	}
+
 	return status;
 }
 
@@ -95,6 +105,8 @@ celix_status_t bundleActivator_stop(void * userData, celix_bundle_context_t *con
     celix_status_t status = CELIX_SUCCESS;
     struct activator *activator = userData;
 
+    celix_bundleContext_unregisterService(context, activator->metricsSvcId);
+    activator->metricsSvcId = -1L;
     serviceRegistration_unregister(activator->registration);
     activator->registration = NULL;
 
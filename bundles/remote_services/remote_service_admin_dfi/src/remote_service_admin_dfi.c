@@ -24,6 +24,8 @@
 #include <netdb.h>
 #include <ifaddrs.h>
 #include <string.h>
+#include <errno.h>
+#include <pthread.h>
 #include <uuid/uuid.h>
 #include <curl/curl.h>
 
@@ -35,13 +37,20 @@
 #include "export_registration_dfi.h"
 #include "remote_service_admin_dfi.h"
 #include "json_rpc.h"
+#include "avrobin_rpc.h"
+#include "avrobin_serializer.h"
+#include "rsa_tcp_transport.h"
+#include "rsa_http_client.h"
+#include "rsa_replica_set.h"
 
 #include "remote_constants.h"
 #include "celix_constants.h"
 #include "civetweb.h"
+#include "http_admin/api.h"
 
 #include "remote_service_admin_dfi_constants.h"
 #include "celix_bundle_context.h"
+#include "celix_probes.h"
 
 // defines how often the webserver is restarted (with an increased port number)
 #define MAX_NUMBER_OF_RESTARTS 5
@@ -60,50 +69,150 @@ struct remote_service_admin {
     celix_bundle_context_t *context;
     log_helper_t *loghelper;
 
-    celix_thread_mutex_t exportedServicesLock;
+    celix_thread_rwlock_t exportedServicesLock;
     hash_map_pt exportedServices;
 
     celix_thread_mutex_t importedServicesLock;
     array_list_pt importedServices;
+    hash_map_pt replicaGroups; //key = replica group key, value = rsa_replica_group_t
+    hash_map_pt replicaImports; //key = import registration of a replicated endpoint, value = rsa_replica_group_t
 
     char *port;
     char *ip;
 
-    struct mg_context *ctx;
+    struct mg_context *ctx; //NULL if the http_admin is used
+
+    celix_thread_mutex_t portLock; //protects port, which changes when the http_admin info service is found
+    celix_http_service_t httpSvc;
+    long httpSvcId;
+    long httpInfoTrackerId;
 
     FILE *logFile;
-};
 
-struct post {
-    const char *readptr;
-    int size;
-};
+    bool binaryRpc;
+
+    bool loadBalancing;
+    rsa_balancing_mode_e balancingMode;
+    bool hedgeCalls;
+    long hedgeMinDelayInUs;
+
+    long coalescingWindowInUs;
+    long coalescingMaxBatchSize;
+
+    long callCacheSize;
+
+    rsa_http_client_t *httpClient; //sync calls, pools the keep-alive connections
+
+    CURLM *multi; //only used by the async thread, NULL if async imports are disabled
+    celix_thread_t asyncThread;
+    celix_thread_mutex_t asyncLock; //protects asyncRunning & asyncQueued
+    bool asyncRunning;
+    array_list_pt asyncQueued; //rsa_async_transfer_t entries, added to the multi handle by the async thread
 
-struct get {
-    char *writeptr;
-    int size;
+    rsa_tcp_server_t *tcpServer; //NULL if the socket transport is disabled or cannot listen
+    rsa_tcp_client_t *tcpClient; //NULL if the socket transport is disabled
+
+    struct {
+        long outgoingCalls; //atomic, calls of imported services (sync and async)
+        long outgoingFailures; //atomic, calls of imported services which failed on transport level
+        long incomingCalls; //atomic, calls of exported services
+        long incomingFailures; //atomic, calls of exported services which could not be invoked
+    } metrics;
 };
 
+typedef struct rsa_async_transfer {
+    CURL *curl;
+    struct curl_slist *headers;
+    uint8_t *request;
+    rsa_http_request_body_t post;
+    rsa_http_reply_body_t get;
+    send_async_complete_func_type complete;
+    void *completeHandle;
+} rsa_async_transfer_t;
+
+/**
+ * Equivalent endpoints imported as one service. The import registrations returned for the endpoints themselves are
+ * not started, they only identify the endpoints in the replica set.
+ */
+typedef struct rsa_replica_group {
+    char *key; //replica group/interface/version
+    endpoint_description_t *endpoint; //copy of the first endpoint, the properties of the imported service
+    rsa_replica_set_t *set;
+    import_registration_t *import;
+} rsa_replica_group_t;
+
+typedef struct rsa_tcp_async_call {
+    remote_service_admin_t *rsa;
+    send_async_complete_func_type complete;
+    void *completeHandle;
+} rsa_tcp_async_call_t;
+
 #define OSGI_RSA_REMOTE_PROXY_FACTORY   "remote_proxy_factory"
 #define OSGI_RSA_REMOTE_PROXY_TIMEOUT   "remote_proxy_timeout"
 
-static const char *data_response_headers =
+static const char *data_response_headers_format =
         "HTTP/1.1 200 OK\r\n"
                 "Cache: no-cache\r\n"
                 "Content-Type: application/json\r\n"
+                "Content-Length: %zu\r\n"
+                "\r\n";
+
+static const char *avrobin_response_headers_format =
+        "HTTP/1.1 200 OK\r\n"
+                "Cache: no-cache\r\n"
+                "Content-Type: " RSA_DFI_AVROBIN_CONTENT_TYPE "\r\n"
+                "Content-Length: %zu\r\n"
                 "\r\n";
 
 static const char *no_content_response_headers =
-        "HTTP/1.1 204 OK\r\n";
+        "HTTP/1.1 204 No Content\r\n"
+                "Content-Length: 0\r\n"
+                "\r\n";
+
+static const char *unavailable_response_headers =
+        "HTTP/1.1 503 Service Unavailable\r\n"
+                "Content-Length: 0\r\n"
+                "\r\n";
+
+/**
+ * Per (HTTP server) thread buffer for the request bodies, reused for every request handled by the thread.
+ */
+typedef struct rsa_request_buffer {
+    char *buf;
+    size_t size;
+} rsa_request_buffer_t;
+
+static pthread_key_t g_requestBufferKey;
+static pthread_once_t g_requestBufferKeyOnce = PTHREAD_ONCE_INIT;
 
 static const unsigned int DEFAULT_TIMEOUT = 0;
 
 static int remoteServiceAdmin_callback(struct mg_connection *conn);
-static celix_status_t remoteServiceAdmin_createEndpointDescription(remote_service_admin_t *admin, service_reference_pt reference, celix_properties_t *props, char *interface, endpoint_description_t **description);
+static int remoteServiceAdmin_httpPost(void *handle, struct mg_connection *conn, const char *data, size_t length);
+static int remoteServiceAdmin_handleCall(remote_service_admin_t *rsa, struct mg_connection *conn, const char *uri, const char *data, size_t length);
+static char* remoteServiceAdmin_readRequest(struct mg_connection *conn, long long contentLength, size_t *length);
+static char* remoteServiceAdmin_copyRequest(const char *data, size_t length, size_t *copied);
+static export_registration_t* remoteServiceAdmin_findExport(remote_service_admin_t *rsa, unsigned long serviceId);
+static celix_status_t remoteServiceAdmin_createEndpointDescription(remote_service_admin_t *admin, service_reference_pt reference, celix_properties_t *props, char *interface, bool http, bool tcp, endpoint_description_t **description);
 static celix_status_t remoteServiceAdmin_send(void *handle, endpoint_description_t *endpointDescription, char *request, char **reply, int* replyStatus);
+static celix_status_t remoteServiceAdmin_sendBinary(void *handle, endpoint_description_t *endpointDescription, const uint8_t *request, size_t requestLength, uint8_t **reply, size_t *replyLength, int* replyStatus);
+static celix_status_t remoteServiceAdmin_post(remote_service_admin_t *rsa, endpoint_description_t *endpointDescription, const char *contentTypeHeader, const void *request, size_t requestLength, char **reply, size_t *replyLength, int* replyStatus);
+static celix_status_t remoteServiceAdmin_sendAsync(void *handle, endpoint_description_t *endpointDescription, bool binary, uint8_t *request, size_t requestLength, send_async_complete_func_type complete, void *completeHandle);
+static celix_status_t remoteServiceAdmin_tcpCall(void *handle, unsigned long serviceId, bool binary, const uint8_t *request, size_t requestLength, uint8_t **reply, size_t *replyLength);
+static celix_status_t remoteServiceAdmin_sendTcp(void *handle, endpoint_description_t *endpointDescription, char *request, char **reply, int* replyStatus);
+static celix_status_t remoteServiceAdmin_sendBinaryTcp(void *handle, endpoint_description_t *endpointDescription, const uint8_t *request, size_t requestLength, uint8_t **reply, size_t *replyLength, int* replyStatus);
+static celix_status_t remoteServiceAdmin_sendAsyncTcp(void *handle, endpoint_description_t *endpointDescription, bool binary, uint8_t *request, size_t requestLength, send_async_complete_func_type complete, void *completeHandle);
+static int remoteServiceAdmin_proxyTimeout(remote_service_admin_t *rsa, endpoint_description_t *endpointDescription);
+static void* remoteServiceAdmin_asyncLoop(void *data);
+static void remoteServiceAdmin_stopAsync(remote_service_admin_t *rsa);
+static bool remoteServiceAdmin_endpointSupportsProtocol(endpoint_description_t *endpointDescription, const char *protocol);
+static bool remoteServiceAdmin_hasConfig(const char *configs, const char *config);
+static celix_status_t remoteServiceAdmin_addReplica(remote_service_admin_t *admin, import_registration_t *import, endpoint_description_t *endpointDescription, const char *objectClass, const char *serviceVersion, const char *replicaGroup, bool useTcp);
+static void remoteServiceAdmin_destroyReplicaGroup(rsa_replica_group_t *group);
 static celix_status_t remoteServiceAdmin_getIpAddress(char* interface, char** ip);
-static size_t remoteServiceAdmin_readCallback(void *ptr, size_t size, size_t nmemb, void *userp);
-static size_t remoteServiceAdmin_write(void *contents, size_t size, size_t nmemb, void *userp);
+static void remoteServiceAdmin_startWebserver(remote_service_admin_t *admin, long port);
+static void remoteServiceAdmin_useHttpAdmin(remote_service_admin_t *admin);
+static void remoteServiceAdmin_setHttpAdminInfo(void *handle, void *svc, const celix_properties_t *props);
 static void remoteServiceAdmin_log(remote_service_admin_t *admin, int level, const char *file, int line, const char *msg, ...);
 
 celix_status_t remoteServiceAdmin_create(celix_bundle_context_t *context, remote_service_admin_t **admin) {
@@ -117,9 +226,12 @@ celix_status_t remoteServiceAdmin_create(celix_bundle_context_t *context, remote
         (*admin)->context = context;
         (*admin)->exportedServices = hashMap_create(NULL, NULL, NULL, NULL);
          arrayList_create(&(*admin)->importedServices);
+        (*admin)->replicaGroups = hashMap_create(utils_stringHash, NULL, utils_stringEquals, NULL);
+        (*admin)->replicaImports = hashMap_create(NULL, NULL, NULL, NULL);
 
-        celixThreadMutex_create(&(*admin)->exportedServicesLock, NULL);
+        celixThreadRwlock_create(&(*admin)->exportedServicesLock, NULL);
         celixThreadMutex_create(&(*admin)->importedServicesLock, NULL);
+        (*admin)->httpClient = rsaHttpClient_create(celix_bundleContext_getPropertyAsLong(context, RSA_CONNECTION_POOL_SIZE_KEY, RSA_CONNECTION_POOL_SIZE_DEFAULT));
 
         if (logHelper_create(context, &(*admin)->loghelper) == CELIX_SUCCESS) {
             logHelper_start((*admin)->loghelper);
@@ -129,6 +241,8 @@ celix_status_t remoteServiceAdmin_create(celix_bundle_context_t *context, remote
             dynInterface_logSetup((void *)remoteServiceAdmin_log, *admin, 1);
             jsonSerializer_logSetup((void *)remoteServiceAdmin_log, *admin, 1);
             jsonRpc_logSetup((void *)remoteServiceAdmin_log, *admin, 1);
+            avrobinSerializer_logSetup((void *)remoteServiceAdmin_log, *admin, 1);
+            avrobinRpc_logSetup((void *)remoteServiceAdmin_log, *admin, 1);
         }
 
         long port = celix_bundleContext_getPropertyAsLong(context, RSA_PORT_KEY, RSA_PORT_DEFAULT);
@@ -152,31 +266,59 @@ celix_status_t remoteServiceAdmin_create(celix_bundle_context_t *context, remote
             free(detectedIp);
         }
 
-        // Prepare callbacks structure. We have only one callback, the rest are NULL.
-        struct mg_callbacks callbacks;
-        memset(&callbacks, 0, sizeof(callbacks));
-        callbacks.begin_request = remoteServiceAdmin_callback;
-
-        char newPort[10];
-        snprintf(newPort, 10, "%li", port);
-
-        unsigned int port_counter = 0;
-        do {
-
-            const char *options[] = { "listening_ports", newPort, "num_threads", "5", NULL};
-
-            (*admin)->ctx = mg_start(&callbacks, (*admin), options);
+        celixThreadMutex_create(&(*admin)->portLock, NULL);
+        (*admin)->httpSvcId = -1L;
+        (*admin)->httpInfoTrackerId = -1L;
+        if (celix_bundleContext_getPropertyAsBool(context, RSA_USE_HTTP_ADMIN_KEY, RSA_USE_HTTP_ADMIN_DEFAULT)) {
+            remoteServiceAdmin_useHttpAdmin(*admin);
+        } else {
+            remoteServiceAdmin_startWebserver(*admin, port);
+        }
 
-            if ((*admin)->ctx != NULL) {
-                logHelper_log((*admin)->loghelper, OSGI_LOGSERVICE_INFO, "RSA: Start webserver: %s", newPort);
-                (*admin)->port = strdup(newPort);
+    }
 
-            } else {
-                logHelper_log((*admin)->loghelper, OSGI_LOGSERVICE_ERROR, "Error while starting rsa server on port %s - retrying on port %li...", newPort, port + port_counter);
-                snprintf(newPort, 10,  "%li", port + port_counter++);
-            }
-        } while (((*admin)->ctx == NULL) && (port_counter < MAX_NUMBER_OF_RESTARTS));
+    (*admin)->binaryRpc = celix_bundleContext_getPropertyAsBool(context, RSA_BINARY_RPC_KEY, RSA_BINARY_RPC_DEFAULT);
+    (*admin)->coalescingWindowInUs = celix_bundleContext_getPropertyAsLong(context, RSA_CALL_COALESCING_WINDOW_KEY, RSA_CALL_COALESCING_WINDOW_DEFAULT);
+    (*admin)->coalescingMaxBatchSize = celix_bundleContext_getPropertyAsLong(context, RSA_CALL_COALESCING_MAX_BATCH_KEY, RSA_CALL_COALESCING_MAX_BATCH_DEFAULT);
+    (*admin)->callCacheSize = celix_bundleContext_getPropertyAsLong(context, RSA_CALL_CACHE_SIZE_KEY, RSA_CALL_CACHE_SIZE_DEFAULT);
+
+    const char *balancing = celix_bundleContext_getProperty(context, RSA_LOAD_BALANCING_KEY, RSA_LOAD_BALANCING_DEFAULT);
+    if (strcmp(balancing, RSA_LOAD_BALANCING_ROUND_ROBIN) == 0) {
+        (*admin)->loadBalancing = true;
+        (*admin)->balancingMode = RSA_BALANCING_ROUND_ROBIN;
+    } else if (strcmp(balancing, RSA_LOAD_BALANCING_LEAST_OUTSTANDING) == 0) {
+        (*admin)->loadBalancing = true;
+        (*admin)->balancingMode = RSA_BALANCING_LEAST_OUTSTANDING;
+    } else if (strcmp(balancing, RSA_LOAD_BALANCING_DEFAULT) != 0) {
+        logHelper_log((*admin)->loghelper, OSGI_LOGSERVICE_WARNING, "RSA: Unknown load balancing mode '%s', replicated services are imported separately", balancing);
+    }
+    (*admin)->hedgeCalls = celix_bundleContext_getPropertyAsBool(context, RSA_HEDGE_CALLS_KEY, RSA_HEDGE_CALLS_DEFAULT);
+    (*admin)->hedgeMinDelayInUs = celix_bundleContext_getPropertyAsLong(context, RSA_HEDGE_MIN_DELAY_US_KEY, RSA_HEDGE_MIN_DELAY_US_DEFAULT);
+
+    if (status == CELIX_SUCCESS && celix_bundleContext_getPropertyAsBool(context, RSA_ASYNC_IMPORT_KEY, RSA_ASYNC_IMPORT_DEFAULT)) {
+        (*admin)->multi = curl_multi_init();
+        celixThreadMutex_create(&(*admin)->asyncLock, NULL);
+        arrayList_create(&(*admin)->asyncQueued);
+        (*admin)->asyncRunning = true;
+        if ((*admin)->multi == NULL || celixThread_create(&(*admin)->asyncThread, NULL, remoteServiceAdmin_asyncLoop, *admin) != CELIX_SUCCESS) {
+            logHelper_log((*admin)->loghelper, OSGI_LOGSERVICE_ERROR, "RSA: Cannot start async call thread, async imports are disabled");
+            (*admin)->asyncRunning = false;
+        } else {
+            celixThread_setName(&(*admin)->asyncThread, "RSA async");
+        }
+    }
 
+    if (status == CELIX_SUCCESS && celix_bundleContext_getPropertyAsBool(context, RSA_TCP_TRANSPORT_KEY, RSA_TCP_TRANSPORT_DEFAULT)) {
+        long tcpPort = celix_bundleContext_getPropertyAsLong(context, RSA_TCP_PORT_KEY, RSA_TCP_PORT_DEFAULT);
+        const char *unixSocket = celix_bundleContext_getProperty(context, RSA_TCP_UNIX_SOCKET_KEY, NULL);
+        long tcpThreads = celix_bundleContext_getPropertyAsLong(context, RSA_TCP_SERVER_THREADS_KEY, RSA_TCP_SERVER_THREADS_DEFAULT);
+        (*admin)->tcpServer = rsaTcpServer_create((*admin)->loghelper, (*admin)->ip, tcpPort, unixSocket, tcpThreads > 0 ? (size_t)tcpThreads : 1, *admin, remoteServiceAdmin_tcpCall);
+        (*admin)->tcpClient = rsaTcpClient_create((*admin)->loghelper);
+        if ((*admin)->tcpServer != NULL) {
+            logHelper_log((*admin)->loghelper, OSGI_LOGSERVICE_INFO, "RSA: Start socket transport: %s", rsaTcpServer_getUrl((*admin)->tcpServer));
+        } else {
+            logHelper_log((*admin)->loghelper, OSGI_LOGSERVICE_ERROR, "RSA: Cannot start socket transport, services are only exported over HTTP");
+        }
     }
 
     bool logCalls = celix_bundleContext_getPropertyAsBool(context, RSA_LOG_CALLS_KEY, RSA_LOG_CALLS_DEFAULT);
@@ -196,6 +338,82 @@ celix_status_t remoteServiceAdmin_create(celix_bundle_context_t *context, remote
 }
 
 
+/**
+ * Starts the HTTP server of the RSA, on the next port if the port is in use.
+ */
+static void remoteServiceAdmin_startWebserver(remote_service_admin_t *admin, long port) {
+    // Prepare callbacks structure. We have only one callback, the rest are NULL.
+    struct mg_callbacks callbacks;
+    memset(&callbacks, 0, sizeof(callbacks));
+    callbacks.begin_request = remoteServiceAdmin_callback;
+
+    char newPort[10];
+    snprintf(newPort, 10, "%li", port);
+
+    // keep-alive lets remote callers reuse their (pooled) connections, this needs a content length in every response
+    char threads[16];
+    snprintf(threads, sizeof(threads), "%li", celix_bundleContext_getPropertyAsLong(admin->context, RSA_SERVER_THREADS_KEY, RSA_SERVER_THREADS_DEFAULT));
+    char queueSize[16];
+    snprintf(queueSize, sizeof(queueSize), "%li", celix_bundleContext_getPropertyAsLong(admin->context, RSA_SERVER_QUEUE_SIZE_KEY, RSA_SERVER_QUEUE_SIZE_DEFAULT));
+
+    unsigned int port_counter = 0;
+    do {
+
+        const char *options[] = { "listening_ports", newPort, "num_threads", threads, "connection_queue", queueSize, "enable_keep_alive", "yes", NULL};
+
+        admin->ctx = mg_start(&callbacks, admin, options);
+
+        if (admin->ctx != NULL) {
+            logHelper_log(admin->loghelper, OSGI_LOGSERVICE_INFO, "RSA: Start webserver: %s", newPort);
+            admin->port = strdup(newPort);
+
+        } else {
+            logHelper_log(admin->loghelper, OSGI_LOGSERVICE_ERROR, "Error while starting rsa server on port %s - retrying on port %li...", newPort, port + port_counter);
+            snprintf(newPort, 10,  "%li", port + port_counter++);
+        }
+    } while ((admin->ctx == NULL) && (port_counter < MAX_NUMBER_OF_RESTARTS));
+}
+
+/**
+ * Registers the endpoint handler as http_admin service and tracks the http_admin info service for its port.
+ */
+static void remoteServiceAdmin_useHttpAdmin(remote_service_admin_t *admin) {
+    char port[16];
+    snprintf(port, sizeof(port), "%li", celix_bundleContext_getPropertyAsLong(admin->context, RSA_HTTP_ADMIN_PORT_KEY, RSA_HTTP_ADMIN_PORT_DEFAULT));
+    admin->port = strdup(port);
+
+    celix_service_tracking_options_t opts = CELIX_EMPTY_SERVICE_TRACKING_OPTIONS;
+    opts.filter.serviceName = HTTP_ADMIN_INFO_SERVICE_NAME;
+    opts.callbackHandle = admin;
+    opts.setWithProperties = remoteServiceAdmin_setHttpAdminInfo;
+    admin->httpInfoTrackerId = celix_bundleContext_trackServicesWithOptions(admin->context, &opts);
+
+    celix_properties_t *props = celix_properties_create();
+    celix_properties_set(props, HTTP_ADMIN_URI, RSA_HTTP_ADMIN_URI);
+    admin->httpSvc.handle = admin;
+    admin->httpSvc.doPost = remoteServiceAdmin_httpPost;
+    admin->httpSvcId = celix_bundleContext_registerService(admin->context, &admin->httpSvc, HTTP_ADMIN_SERVICE_NAME, props);
+    logHelper_log(admin->loghelper, OSGI_LOGSERVICE_INFO, "RSA: Using http_admin on port %s", admin->port);
+}
+
+/**
+ * Takes the port of the endpoint urls from the http_admin info service. Endpoints exported before keep their url.
+ */
+static void remoteServiceAdmin_setHttpAdminInfo(void *handle, void *svc, const celix_properties_t *props) {
+    remote_service_admin_t *admin = handle;
+    long port = svc != NULL ? celix_properties_getAsLong(props, HTTP_ADMIN_INFO_PORT, -1L) : -1L;
+    if (port > 0) {
+        char *newPort = NULL;
+        if (asprintf(&newPort, "%li", port) >= 0) {
+            celixThreadMutex_lock(&admin->portLock);
+            free(admin->port);
+            admin->port = newPort;
+            celixThreadMutex_unlock(&admin->portLock);
+        }
+    }
+}
+
+
 celix_status_t remoteServiceAdmin_destroy(remote_service_admin_t **admin)
 {
     celix_status_t status = CELIX_SUCCESS;
@@ -204,8 +422,11 @@ celix_status_t remoteServiceAdmin_destroy(remote_service_admin_t **admin)
         fclose((*admin)->logFile);
     }
 
+    rsaHttpClient_destroy((*admin)->httpClient);
+
     free((*admin)->ip);
     free((*admin)->port);
+    celixThreadMutex_destroy(&(*admin)->portLock);
     free(*admin);
 
     *admin = NULL;
@@ -217,7 +438,15 @@ celix_status_t remoteServiceAdmin_destroy(remote_service_admin_t **admin)
 celix_status_t remoteServiceAdmin_stop(remote_service_admin_t *admin) {
     celix_status_t status = CELIX_SUCCESS;
 
-    celixThreadMutex_lock(&admin->exportedServicesLock);
+    //no new calls on the socket transport and the http_admin while the exports are destroyed
+    rsaTcpServer_destroy(admin->tcpServer);
+    admin->tcpServer = NULL;
+    celix_bundleContext_unregisterService(admin->context, admin->httpSvcId);
+    admin->httpSvcId = -1L;
+    celix_bundleContext_stopTracker(admin->context, admin->httpInfoTrackerId);
+    admin->httpInfoTrackerId = -1L;
+
+    celixThreadRwlock_writeLock(&admin->exportedServicesLock);
 
     hash_map_iterator_pt iter = hashMapIterator_create(admin->exportedServices);
     while (hashMapIterator_hasNext(iter)) {
@@ -233,7 +462,7 @@ celix_status_t remoteServiceAdmin_stop(remote_service_admin_t *admin) {
         arrayList_destroy(exports);
     }
     hashMapIterator_destroy(iter);
-    celixThreadMutex_unlock(&admin->exportedServicesLock);
+    celixThreadRwlock_unlock(&admin->exportedServicesLock);
 
     celixThreadMutex_lock(&admin->importedServicesLock);
     int i;
@@ -245,8 +474,16 @@ celix_status_t remoteServiceAdmin_stop(remote_service_admin_t *admin) {
             importRegistration_destroy(import);
         }
     }
+    hash_map_iterator_t groupIter = hashMapIterator_construct(admin->replicaGroups);
+    while (hashMapIterator_hasNext(&groupIter)) {
+        remoteServiceAdmin_destroyReplicaGroup(hashMapIterator_nextValue(&groupIter));
+    }
     celixThreadMutex_unlock(&admin->importedServicesLock);
 
+    remoteServiceAdmin_stopAsync(admin);
+    rsaTcpClient_destroy(admin->tcpClient);
+    admin->tcpClient = NULL;
+
     if (admin->ctx != NULL) {
         logHelper_log(admin->loghelper, OSGI_LOGSERVICE_INFO, "RSA: Stopping webserver...");
         mg_stop(admin->ctx);
@@ -255,6 +492,8 @@ celix_status_t remoteServiceAdmin_stop(remote_service_admin_t *admin) {
 
     hashMap_destroy(admin->exportedServices, false, false);
     arrayList_destroy(admin->importedServices);
+    hashMap_destroy(admin->replicaGroups, false, false);
+    hashMap_destroy(admin->replicaImports, false, false);
 
     logHelper_stop(admin->loghelper);
     logHelper_destroy(&admin->loghelper);
@@ -270,115 +509,263 @@ celix_status_t remoteServiceAdmin_stop(remote_service_admin_t *admin) {
 celix_status_t importRegistration_getFactory(import_registration_t *import, service_factory_pt *factory);
 
 static int remoteServiceAdmin_callback(struct mg_connection *conn) {
-    int result = 1; // zero means: let civetweb handle it further, any non-zero value means it is handled by us...
+    int result = 0; // zero means: let civetweb handle it further, any non-zero value means it is handled by us...
 
     const struct mg_request_info *request_info = mg_get_request_info(conn);
-    if (request_info->uri != NULL) {
+    if (request_info->local_uri != NULL && strcmp("POST", request_info->request_method) == 0) {
         remote_service_admin_t *rsa = request_info->user_data;
+        result = remoteServiceAdmin_handleCall(rsa, conn, request_info->local_uri, NULL, 0);
+    }
 
+    return result;
+}
 
-        if (strncmp(request_info->uri, "/service/", 9) == 0 && strcmp("POST", request_info->request_method) == 0) {
-
-            // uri = /services/myservice/call
-            const char *uri = request_info->uri;
-            // rest = myservice/call
-
-            const char *rest = uri+9;
-            char *interfaceStart = strchr(rest, '/');
-            int pos = interfaceStart - rest;
-            char service[pos+1];
-            strncpy(service, rest, pos);
-            service[pos] = '\0';
-            unsigned long serviceId = strtoul(service,NULL,10);
-
-            celixThreadMutex_lock(&rsa->exportedServicesLock);
-
-            //find endpoint
-            export_registration_t *export = NULL;
-            hash_map_iterator_pt iter = hashMapIterator_create(rsa->exportedServices);
-            while (hashMapIterator_hasNext(iter)) {
-                hash_map_entry_pt entry = hashMapIterator_nextEntry(iter);
-                array_list_pt exports = hashMapEntry_getValue(entry);
-                int expIt = 0;
-                for (expIt = 0; expIt < arrayList_size(exports); expIt++) {
-                    export_registration_t *check = arrayList_get(exports, expIt);
-                    export_reference_t * ref = NULL;
-                    exportRegistration_getExportReference(check, &ref);
-                    endpoint_description_t * checkEndpoint = NULL;
-                    exportReference_getExportedEndpoint(ref, &checkEndpoint);
-                    if (serviceId == checkEndpoint->serviceId) {
-                        export = check;
-                        free(ref);
-                        break;
-                    }
-                    free(ref);
-                }
-            }
-            hashMapIterator_destroy(iter);
+/**
+ * POST handler of the http_admin service, the body is already read by the http_admin.
+ * Returns the HTTP status code of the response, or 0 to let the http_admin return not found.
+ */
+static int remoteServiceAdmin_httpPost(void *handle, struct mg_connection *conn, const char *data, size_t length) {
+    remote_service_admin_t *rsa = handle;
+    const struct mg_request_info *request_info = mg_get_request_info(conn);
+    return request_info->local_uri != NULL ? remoteServiceAdmin_handleCall(rsa, conn, request_info->local_uri, data != NULL ? data : "", length) : 0;
+}
 
-            if (export != NULL) {
+/**
+ * Handles a call for an exported service.
+ * Request: http://host:port/service/{service id}/{interface}
+ * The body is read from the connection if data is NULL.
+ * Returns the HTTP status code of the response, or 0 if the uri is not a call of an exported service.
+ */
+static int remoteServiceAdmin_handleCall(remote_service_admin_t *rsa, struct mg_connection *conn, const char *uri, const char *data, size_t length) {
+    int result = 0;
+
+    if (strncmp(uri, "/service/", 9) == 0) {
+        // rest = myservice/call
+        const char *rest = uri+9;
+        unsigned long serviceId = strtoul(rest, NULL, 10);
+
+        celixThreadRwlock_readLock(&rsa->exportedServicesLock);
+
+        export_registration_t *export = remoteServiceAdmin_findExport(rsa, serviceId);
+        if (export != NULL) {
+            __atomic_add_fetch(&rsa->metrics.incomingCalls, 1, __ATOMIC_RELAXED);
+
+            size_t datalength = 0;
+            char *request = data == NULL ? remoteServiceAdmin_readRequest(conn, mg_get_request_info(conn)->content_length, &datalength)
+                                         : remoteServiceAdmin_copyRequest(data, length, &datalength);
+
+            const char *contentType = mg_get_header(conn, "Content-Type");
+            bool binary = contentType != NULL && strcmp(contentType, RSA_DFI_AVROBIN_CONTENT_TYPE) == 0;
+
+            char *response = NULL;
+            int responceLength = 0;
+            uint8_t *binaryResponse = NULL;
+            size_t binaryResponseLength = 0;
+            int rc;
+            if (request == NULL) {
+                rc = CELIX_ENOMEM;
+            } else if (binary) {
+                rc = exportRegistration_callBinary(export, (uint8_t *) request, datalength, &binaryResponse, &binaryResponseLength);
+            } else {
+                rc = exportRegistration_call(export, request, -1, &response, &responceLength);
+            }
+            if (rc != CELIX_SUCCESS) {
+                __atomic_add_fetch(&rsa->metrics.incomingFailures, 1, __ATOMIC_RELAXED);
+            }
+            if (rc == EBUSY) {
+                RSA_LOG_WARNING(rsa, "Call queue of service id %lu is full, rejecting call", serviceId);
+            } else if (rc != CELIX_SUCCESS) {
+                RSA_LOG_ERROR(rsa, "Error trying to invoke remove service, got error %i\n", rc);
+            }
 
-                uint64_t datalength = request_info->content_length;
-                char* data = malloc(datalength + 1);
-                mg_read(conn, data, datalength);
-                data[datalength] = '\0';
+            if (rc == CELIX_SUCCESS && binaryResponse != NULL) {
+                char headers[256];
+                int headersLength = snprintf(headers, sizeof(headers), avrobin_response_headers_format, binaryResponseLength);
+                mg_write(conn, headers, headersLength);
+                mg_write(conn, binaryResponse, binaryResponseLength);
+                free(binaryResponse);
+                result = 200;
+            } else if (rc == CELIX_SUCCESS && response != NULL) {
+                char headers[256];
+                size_t responseLength = strlen(response);
+                int headersLength = snprintf(headers, sizeof(headers), data_response_headers_format, responseLength);
+                mg_write(conn, headers, headersLength);
+                mg_write(conn, response, responseLength);
+                free(response);
+                result = 200;
+            } else if (rc == EBUSY) {
+                mg_write(conn, unavailable_response_headers, strlen(unavailable_response_headers));
+                result = 503;
+            } else {
+                mg_write(conn, no_content_response_headers, strlen(no_content_response_headers));
+                result = 204;
+            }
+        } else {
+            RSA_LOG_WARNING(rsa, "No export registration found for service id %lu", serviceId);
+        }
 
-                char *response = NULL;
-                int responceLength = 0;
-                int rc = exportRegistration_call(export, data, -1, &response, &responceLength);
-                if (rc != CELIX_SUCCESS) {
-                    RSA_LOG_ERROR(rsa, "Error trying to invoke remove service, got error %i\n", rc);
-                }
+        celixThreadRwlock_unlock(&rsa->exportedServicesLock);
+    }
 
-                if (rc == CELIX_SUCCESS && response != NULL) {
-                    mg_write(conn, data_response_headers, strlen(data_response_headers));
-                    mg_write(conn, response, strlen(response));
-                    free(response);
-                } else {
-                    mg_write(conn, no_content_response_headers, strlen(no_content_response_headers));
-                }
-                result = 1;
+    return result;
+}
 
-                free(data);
-            } else {
-                result = 0;
-                RSA_LOG_WARNING(rsa, "No export registration found for service id %lu", serviceId);
+/**
+ * Returns the export registration for the service id, or NULL. Note exportedServicesLock should be (read) locked.
+ */
+static export_registration_t* remoteServiceAdmin_findExport(remote_service_admin_t *rsa, unsigned long serviceId) {
+    export_registration_t *export = NULL;
+    hash_map_iterator_pt iter = hashMapIterator_create(rsa->exportedServices);
+    while (hashMapIterator_hasNext(iter) && export == NULL) {
+        hash_map_entry_pt entry = hashMapIterator_nextEntry(iter);
+        array_list_pt exports = hashMapEntry_getValue(entry);
+        int expIt = 0;
+        for (expIt = 0; expIt < arrayList_size(exports); expIt++) {
+            export_registration_t *check = arrayList_get(exports, expIt);
+            export_reference_t * ref = NULL;
+            exportRegistration_getExportReference(check, &ref);
+            endpoint_description_t * checkEndpoint = NULL;
+            exportReference_getExportedEndpoint(ref, &checkEndpoint);
+            if (serviceId == checkEndpoint->serviceId) {
+                export = check;
+                free(ref);
+                break;
             }
+            free(ref);
+        }
+    }
+    hashMapIterator_destroy(iter);
+    return export;
+}
 
-            celixThreadMutex_unlock(&rsa->exportedServicesLock);
+/**
+ * Handles a call received by the socket transport, on a worker thread of the transport.
+ */
+static celix_status_t remoteServiceAdmin_tcpCall(void *handle, unsigned long serviceId, bool binary, const uint8_t *request, size_t requestLength, uint8_t **reply, size_t *replyLength) {
+    remote_service_admin_t *rsa = handle;
+    celix_status_t status;
 
+    celixThreadRwlock_readLock(&rsa->exportedServicesLock);
+    export_registration_t *export = remoteServiceAdmin_findExport(rsa, serviceId);
+    if (export == NULL) {
+        status = ENOENT;
+        RSA_LOG_WARNING(rsa, "No export registration found for service id %lu", serviceId);
+    } else {
+        __atomic_add_fetch(&rsa->metrics.incomingCalls, 1, __ATOMIC_RELAXED);
+        if (binary) {
+            status = exportRegistration_callBinary(export, request, requestLength, reply, replyLength);
+        } else {
+            char *response = NULL;
+            int responseLength = 0;
+            status = exportRegistration_call(export, (char *) request, (int) requestLength, &response, &responseLength);
+            *reply = (uint8_t *) response;
+            *replyLength = response != NULL ? strlen(response) : 0;
+        }
+        if (status != CELIX_SUCCESS) {
+            __atomic_add_fetch(&rsa->metrics.incomingFailures, 1, __ATOMIC_RELAXED);
+        }
+        if (status == EBUSY) {
+            RSA_LOG_WARNING(rsa, "Call queue of service id %lu is full, rejecting call", serviceId);
+        } else if (status != CELIX_SUCCESS) {
+            RSA_LOG_ERROR(rsa, "Error trying to invoke remove service, got error %i\n", status);
         }
     }
+    celixThreadRwlock_unlock(&rsa->exportedServicesLock);
 
-    return result;
+    return status;
 }
 
-celix_status_t remoteServiceAdmin_exportService(remote_service_admin_t *admin, char *serviceId, celix_properties_t *properties, array_list_pt *registrations) {
-    celix_status_t status = CELIX_SUCCESS;
+static void remoteServiceAdmin_destroyRequestBuffer(void *data) {
+    rsa_request_buffer_t *buffer = data;
+    free(buffer->buf);
+    free(buffer);
+}
 
-    bool export = false;
-    const char *exportConfigs = celix_properties_get(properties, OSGI_RSA_SERVICE_EXPORTED_CONFIGS, RSA_DFI_CONFIGURATION_TYPE);
-    if (exportConfigs != NULL) {
-        // See if the EXPORT_CONFIGS matches this RSA. If so, try to export.
+static void remoteServiceAdmin_createRequestBufferKey(void) {
+    pthread_key_create(&g_requestBufferKey, remoteServiceAdmin_destroyRequestBuffer);
+}
 
-        char *ecCopy = strndup(exportConfigs, strlen(exportConfigs));
-        const char delimiter[2] = ",";
-        char *token, *savePtr;
+/**
+ * Returns the request buffer of the calling thread, grown to hold at least size bytes and a 0 terminator.
+ * Returns NULL if the buffer cannot be allocated.
+ */
+static rsa_request_buffer_t* remoteServiceAdmin_requestBuffer(size_t size) {
+    pthread_once(&g_requestBufferKeyOnce, remoteServiceAdmin_createRequestBufferKey);
+    rsa_request_buffer_t *buffer = pthread_getspecific(g_requestBufferKey);
+    if (buffer == NULL) {
+        buffer = calloc(1, sizeof(*buffer));
+        if (buffer == NULL || pthread_setspecific(g_requestBufferKey, buffer) != 0) {
+            free(buffer);
+            return NULL;
+        }
+    }
+    if (buffer->size < size + 1) {
+        char *buf = realloc(buffer->buf, size + 1);
+        if (buf == NULL) {
+            return NULL;
+        }
+        buffer->buf = buf;
+        buffer->size = size + 1;
+    }
+    return buffer;
+}
 
-        token = strtok_r(ecCopy, delimiter, &savePtr);
-        while (token != NULL) {
-            if (strncmp(utils_stringTrim(token), RSA_DFI_CONFIGURATION_TYPE, 1024) == 0) {
-                export = true;
-                break;
+/**
+ * Reads the request body into the (0 terminated) request buffer of the calling thread. The body is read in chunks
+ * until the content length is reached, or until the connection is closed if no content length is set.
+ * Returns NULL if the buffer cannot be allocated. The buffer stays owned by the thread.
+ */
+static char* remoteServiceAdmin_readRequest(struct mg_connection *conn, long long contentLength, size_t *length) {
+    rsa_request_buffer_t *buffer = NULL;
+    size_t read = 0;
+    size_t expected = contentLength >= 0 ? (size_t) contentLength : 4096;
+    bool done = false;
+    while (!done) {
+        buffer = remoteServiceAdmin_requestBuffer(expected);
+        if (buffer == NULL) {
+            return NULL;
+        }
+        int rc = read < expected ? mg_read(conn, buffer->buf + read, expected - read) : 0;
+        if (rc > 0) {
+            read += rc;
+            if (contentLength < 0 && read == expected) {
+                expected *= 2;
             }
-
-            token = strtok_r(NULL, delimiter, &savePtr);
         }
+        done = rc <= 0 || (contentLength >= 0 && read == expected);
+    }
 
-        free(ecCopy);
-    } else {
-        export = true;
+    buffer->buf[read] = '\0';
+    *length = read;
+    return buffer->buf;
+}
+
+/**
+ * Copies an already read request body into the (0 terminated) request buffer of the calling thread.
+ */
+static char* remoteServiceAdmin_copyRequest(const char *data, size_t length, size_t *copied) {
+    rsa_request_buffer_t *buffer = remoteServiceAdmin_requestBuffer(length);
+    if (buffer == NULL) {
+        return NULL;
+    }
+    memcpy(buffer->buf, data, length);
+    buffer->buf[length] = '\0';
+    *copied = length;
+    return buffer->buf;
+}
+
+celix_status_t remoteServiceAdmin_exportService(remote_service_admin_t *admin, char *serviceId, celix_properties_t *properties, array_list_pt *registrations) {
+    celix_status_t status = CELIX_SUCCESS;
+
+    bool exportHttp = true;
+    bool exportTcp = admin->tcpServer != NULL;
+    const char *exportConfigs = celix_properties_get(properties, OSGI_RSA_SERVICE_EXPORTED_CONFIGS, NULL);
+    if (exportConfigs != NULL) {
+        // See if the EXPORT_CONFIGS matches this RSA. If so, try to export.
+        exportHttp = remoteServiceAdmin_hasConfig(exportConfigs, RSA_DFI_CONFIGURATION_TYPE);
+        exportTcp = exportTcp && remoteServiceAdmin_hasConfig(exportConfigs, RSA_DFI_TCP_CONFIGURATION_TYPE);
     }
+    bool export = exportHttp || exportTcp;
 
     if (export) {
         arrayList_create(registrations);
@@ -428,7 +815,7 @@ celix_status_t remoteServiceAdmin_exportService(remote_service_admin_t *admin, c
             endpoint_description_t *endpoint = NULL;
             export_registration_t *registration = NULL;
 
-            remoteServiceAdmin_createEndpointDescription(admin, reference, properties, (char *) interface, &endpoint);
+            remoteServiceAdmin_createEndpointDescription(admin, reference, properties, (char *) interface, exportHttp, exportTcp, &endpoint);
             //TODO precheck if descriptor exists
             status = exportRegistration_create(admin->loghelper, reference, endpoint, admin->context, admin->logFile,
                                                &registration);
@@ -442,9 +829,9 @@ celix_status_t remoteServiceAdmin_exportService(remote_service_admin_t *admin, c
 
 
         if (status == CELIX_SUCCESS) {
-            celixThreadMutex_lock(&admin->exportedServicesLock);
+            celixThreadRwlock_writeLock(&admin->exportedServicesLock);
             hashMap_put(admin->exportedServices, reference, *registrations);
-            celixThreadMutex_unlock(&admin->exportedServicesLock);
+            celixThreadRwlock_unlock(&admin->exportedServicesLock);
         } else {
             arrayList_destroy(*registrations);
             *registrations = NULL;
@@ -464,7 +851,7 @@ celix_status_t remoteServiceAdmin_removeExportedService(remote_service_admin_t *
 
     if (status == CELIX_SUCCESS && ref != NULL) {
         service_reference_pt servRef;
-        celixThreadMutex_lock(&admin->exportedServicesLock);
+        celixThreadRwlock_writeLock(&admin->exportedServicesLock);
         exportReference_getExportedService(ref, &servRef);
 
         array_list_pt exports = (array_list_pt)hashMap_remove(admin->exportedServices, servRef);
@@ -475,7 +862,7 @@ celix_status_t remoteServiceAdmin_removeExportedService(remote_service_admin_t *
         exportRegistration_close(registration);
         exportRegistration_destroy(registration);
 
-        celixThreadMutex_unlock(&admin->exportedServicesLock);
+        celixThreadRwlock_unlock(&admin->exportedServicesLock);
 
         free(ref);
 
@@ -486,7 +873,7 @@ celix_status_t remoteServiceAdmin_removeExportedService(remote_service_admin_t *
     return status;
 }
 
-static celix_status_t remoteServiceAdmin_createEndpointDescription(remote_service_admin_t *admin, service_reference_pt reference, celix_properties_t *props, char *interface, endpoint_description_t **endpoint) {
+static celix_status_t remoteServiceAdmin_createEndpointDescription(remote_service_admin_t *admin, service_reference_pt reference, celix_properties_t *props, char *interface, bool http, bool tcp, endpoint_description_t **endpoint) {
 
     celix_status_t status = CELIX_SUCCESS;
     celix_properties_t *endpointProperties = celix_properties_create();
@@ -507,17 +894,17 @@ static celix_status_t remoteServiceAdmin_createEndpointDescription(remote_servic
         }
     }
 
-    hash_map_entry_pt entry = hashMap_getEntry(endpointProperties, (void *) OSGI_FRAMEWORK_SERVICE_ID);
-
-    char* key = hashMapEntry_getKey(entry);
-    char *serviceId = (char *) hashMap_remove(endpointProperties, (void *) OSGI_FRAMEWORK_SERVICE_ID);
+    char *serviceId = strndup(celix_properties_get(endpointProperties, OSGI_FRAMEWORK_SERVICE_ID, ""), 1024);
+    celix_properties_unset(endpointProperties, OSGI_FRAMEWORK_SERVICE_ID);
     const char *uuid = NULL;
 
     char buf[512];
     snprintf(buf, 512,  "/service/%s/%s", serviceId, interface);
 
     char url[1024];
+    celixThreadMutex_lock(&admin->portLock);
     snprintf(url, 1024, "http://%s:%s%s", admin->ip, admin->port, buf);
+    celixThreadMutex_unlock(&admin->portLock);
 
     uuid_t endpoint_uid;
     uuid_generate(endpoint_uid);
@@ -530,8 +917,17 @@ static celix_status_t remoteServiceAdmin_createEndpointDescription(remote_servic
     celix_properties_set(endpointProperties, OSGI_RSA_ENDPOINT_SERVICE_ID, serviceId);
     celix_properties_set(endpointProperties, OSGI_RSA_ENDPOINT_ID, endpoint_uuid);
     celix_properties_set(endpointProperties, OSGI_RSA_SERVICE_IMPORTED, "true");
-    celix_properties_set(endpointProperties, OSGI_RSA_SERVICE_IMPORTED_CONFIGS, (char*) RSA_DFI_CONFIGURATION_TYPE);
-    celix_properties_set(endpointProperties, RSA_DFI_ENDPOINT_URL, url);
+    char configs[128];
+    snprintf(configs, sizeof(configs), "%s%s%s", http ? RSA_DFI_CONFIGURATION_TYPE : "", http && tcp ? "," : "", tcp ? RSA_DFI_TCP_CONFIGURATION_TYPE : "");
+    celix_properties_set(endpointProperties, OSGI_RSA_SERVICE_IMPORTED_CONFIGS, configs);
+    if (http) {
+        celix_properties_set(endpointProperties, RSA_DFI_ENDPOINT_URL, url);
+    }
+    if (tcp) {
+        celix_properties_set(endpointProperties, RSA_DFI_TCP_ENDPOINT_URL, rsaTcpServer_getUrl(admin->tcpServer));
+    }
+    celix_properties_set(endpointProperties, RSA_DFI_ENDPOINT_PROTOCOLS, admin->binaryRpc ?
+            RSA_DFI_PROTOCOL_JSON "," RSA_DFI_PROTOCOL_AVROBIN "," RSA_DFI_PROTOCOL_BATCH : RSA_DFI_PROTOCOL_JSON "," RSA_DFI_PROTOCOL_BATCH);
 
     if (props != NULL) {
         hash_map_iterator_pt propIter = hashMapIterator_create(props);
@@ -555,7 +951,6 @@ static celix_status_t remoteServiceAdmin_createEndpointDescription(remote_servic
         (*endpoint)->properties = endpointProperties;
     }
 
-    free(key);
     free(serviceId);
     free(keys);
 
@@ -620,24 +1015,13 @@ celix_status_t remoteServiceAdmin_importService(remote_service_admin_t *admin, e
     celix_status_t status = CELIX_SUCCESS;
 
     bool importService = false;
+    bool useTcp = false;
     const char *importConfigs = celix_properties_get(endpointDescription->properties, OSGI_RSA_SERVICE_IMPORTED_CONFIGS, NULL);
     if (importConfigs != NULL) {
-        // Check whether this RSA must be imported
-        char *ecCopy = strndup(importConfigs, strlen(importConfigs));
-        const char delimiter[2] = ",";
-        char *token, *savePtr;
-
-        token = strtok_r(ecCopy, delimiter, &savePtr);
-        while (token != NULL) {
-            if (strncmp(utils_stringTrim(token), RSA_DFI_CONFIGURATION_TYPE, 1024) == 0) {
-                importService = true;
-                break;
-            }
-
-            token = strtok_r(NULL, delimiter, &savePtr);
-        }
-
-        free(ecCopy);
+        // Check whether this RSA must be imported, the socket transport is preferred over HTTP
+        useTcp = admin->tcpClient != NULL && remoteServiceAdmin_hasConfig(importConfigs, RSA_DFI_TCP_CONFIGURATION_TYPE) &&
+                 celix_properties_get(endpointDescription->properties, RSA_DFI_TCP_ENDPOINT_URL, NULL) != NULL;
+        importService = useTcp || remoteServiceAdmin_hasConfig(importConfigs, RSA_DFI_CONFIGURATION_TYPE);
     } else {
         logHelper_log(admin->loghelper, OSGI_LOGSERVICE_WARNING, "Mandatory %s element missing from endpoint description",
                 OSGI_RSA_SERVICE_IMPORTED_CONFIGS);
@@ -653,15 +1037,44 @@ celix_status_t remoteServiceAdmin_importService(remote_service_admin_t *admin, e
         logHelper_log(admin->loghelper, OSGI_LOGSERVICE_INFO, "Registering service factory (proxy) for service '%s'\n",
                       objectClass);
 
+        const char *replicaGroup = NULL;
+        if (admin->loadBalancing) {
+            replicaGroup = celix_properties_get(endpointDescription->properties, RSA_DFI_REPLICA_GROUP, NULL);
+        }
+
         if (objectClass != NULL) {
             status = importRegistration_create(admin->context, endpointDescription, objectClass, serviceVersion,
                                                admin->logFile, &import);
         }
-        if (status == CELIX_SUCCESS && import != NULL) {
+        if (status == CELIX_SUCCESS && import != NULL && replicaGroup != NULL) {
+            //the endpoint is added to the (shared) import of its replica group, its own import is not started
+            status = remoteServiceAdmin_addReplica(admin, import, endpointDescription, objectClass, serviceVersion, replicaGroup, useTcp);
+        } else if (status == CELIX_SUCCESS && import != NULL && useTcp) {
+            importRegistration_setSendFn(import, (send_func_type) remoteServiceAdmin_sendTcp, admin);
+            if (admin->binaryRpc && remoteServiceAdmin_endpointSupportsProtocol(endpointDescription, RSA_DFI_PROTOCOL_AVROBIN)) {
+                importRegistration_setSendBinaryFn(import, (send_binary_func_type) remoteServiceAdmin_sendBinaryTcp, admin);
+            }
+            if (admin->asyncRunning) {
+                importRegistration_setSendAsyncFn(import, remoteServiceAdmin_sendAsyncTcp, admin);
+            }
+            if (admin->coalescingWindowInUs > 0 && remoteServiceAdmin_endpointSupportsProtocol(endpointDescription, RSA_DFI_PROTOCOL_BATCH)) {
+                importRegistration_setCoalescing(import, (unsigned int)admin->coalescingWindowInUs, (unsigned int)admin->coalescingMaxBatchSize);
+            }
+        } else if (status == CELIX_SUCCESS && import != NULL) {
             importRegistration_setSendFn(import, (send_func_type) remoteServiceAdmin_send, admin);
+            if (admin->binaryRpc && remoteServiceAdmin_endpointSupportsProtocol(endpointDescription, RSA_DFI_PROTOCOL_AVROBIN)) {
+                importRegistration_setSendBinaryFn(import, (send_binary_func_type) remoteServiceAdmin_sendBinary, admin);
+            }
+            if (admin->asyncRunning) {
+                importRegistration_setSendAsyncFn(import, remoteServiceAdmin_sendAsync, admin);
+            }
+            if (admin->coalescingWindowInUs > 0 && remoteServiceAdmin_endpointSupportsProtocol(endpointDescription, RSA_DFI_PROTOCOL_BATCH)) {
+                importRegistration_setCoalescing(import, (unsigned int)admin->coalescingWindowInUs, (unsigned int)admin->coalescingMaxBatchSize);
+            }
         }
 
-        if (status == CELIX_SUCCESS && import != NULL) {
+        if (status == CELIX_SUCCESS && import != NULL && replicaGroup == NULL) {
+            importRegistration_setCallCache(import, admin->callCacheSize > 0 ? (unsigned int)admin->callCacheSize : 0);
             status = importRegistration_start(import);
         }
 
@@ -678,6 +1091,102 @@ celix_status_t remoteServiceAdmin_importService(remote_service_admin_t *admin, e
 }
 
 
+/**
+ * Adds the endpoint to the replica set of its replica group, the import of the group is created and started for
+ * the first endpoint.
+ */
+static celix_status_t remoteServiceAdmin_addReplica(remote_service_admin_t *admin, import_registration_t *import, endpoint_description_t *endpointDescription, const char *objectClass, const char *serviceVersion, const char *replicaGroup, bool useTcp) {
+    celix_status_t status = CELIX_SUCCESS;
+    bool binary = admin->binaryRpc && remoteServiceAdmin_endpointSupportsProtocol(endpointDescription, RSA_DFI_PROTOCOL_AVROBIN);
+    send_func_type send = (send_func_type) (useTcp ? remoteServiceAdmin_sendTcp : remoteServiceAdmin_send);
+    send_binary_func_type sendBinary = NULL;
+    if (binary) {
+        sendBinary = (send_binary_func_type) (useTcp ? remoteServiceAdmin_sendBinaryTcp : remoteServiceAdmin_sendBinary);
+    }
+    send_async_func_type sendAsync = NULL;
+    if (useTcp) {
+        sendAsync = remoteServiceAdmin_sendAsyncTcp;
+    } else if (admin->asyncRunning) {
+        sendAsync = remoteServiceAdmin_sendAsync;
+    }
+
+    char *key = NULL;
+    if (asprintf(&key, "%s/%s/%s", replicaGroup, objectClass, serviceVersion != NULL ? serviceVersion : "") < 0) {
+        return CELIX_ENOMEM;
+    }
+
+    celixThreadMutex_lock(&admin->importedServicesLock);
+    rsa_replica_group_t *group = hashMap_get(admin->replicaGroups, key);
+    bool created = false;
+    if (group == NULL) {
+        group = calloc(1, sizeof(*group));
+        celix_properties_t *props = celix_properties_copy(endpointDescription->properties);
+        status = group != NULL && props != NULL ? endpointDescription_create(props, &group->endpoint) : CELIX_ENOMEM;
+        if (status != CELIX_SUCCESS && props != NULL) {
+            celix_properties_destroy(props);
+        }
+        if (status == CELIX_SUCCESS) {
+            bool hedging = admin->hedgeCalls && celix_properties_getAsBool(group->endpoint->properties, RSA_DFI_IDEMPOTENT, false);
+            group->set = rsaReplicaSet_create(admin->balancingMode, hedging, admin->hedgeMinDelayInUs > 0 ? (unsigned int)admin->hedgeMinDelayInUs : 0);
+            status = group->set != NULL ? CELIX_SUCCESS : CELIX_ENOMEM;
+        }
+        if (status == CELIX_SUCCESS) {
+            //NOTE the object class of the import must outlive the endpoint which created the group
+            status = importRegistration_create(admin->context, group->endpoint, celix_properties_get(group->endpoint->properties, OSGI_FRAMEWORK_OBJECTCLASS, NULL),
+                                               serviceVersion, admin->logFile, &group->import);
+        }
+        if (status == CELIX_SUCCESS) {
+            importRegistration_setSendFn(group->import, rsaReplicaSet_send, group->set);
+            if (sendBinary != NULL) {
+                importRegistration_setSendBinaryFn(group->import, rsaReplicaSet_sendBinary, group->set);
+            }
+            if (admin->asyncRunning) {
+                importRegistration_setSendAsyncFn(group->import, rsaReplicaSet_sendAsync, group->set);
+            }
+            importRegistration_setCallCache(group->import, admin->callCacheSize > 0 ? (unsigned int)admin->callCacheSize : 0);
+            status = importRegistration_start(group->import);
+        }
+        if (status == CELIX_SUCCESS) {
+            group->key = key;
+            key = NULL;
+            hashMap_put(admin->replicaGroups, group->key, group);
+            created = true;
+            logHelper_log(admin->loghelper, OSGI_LOGSERVICE_INFO, "RSA: Import replica group %s", group->key);
+        } else if (group != NULL) {
+            remoteServiceAdmin_destroyReplicaGroup(group);
+            group = NULL;
+        }
+    }
+    free(key);
+
+    if (status == CELIX_SUCCESS) {
+        status = rsaReplicaSet_addMember(group->set, import, endpointDescription, send, sendBinary, sendAsync, admin);
+        if (status == CELIX_SUCCESS) {
+            hashMap_put(admin->replicaImports, import, group);
+            importRegistration_clearCallCache(group->import); //the cached replies can differ from those of the new endpoint
+        } else if (created) {
+            hashMap_remove(admin->replicaGroups, group->key);
+            remoteServiceAdmin_destroyReplicaGroup(group);
+        }
+    }
+    celixThreadMutex_unlock(&admin->importedServicesLock);
+
+    return status;
+}
+
+static void remoteServiceAdmin_destroyReplicaGroup(rsa_replica_group_t *group) {
+    if (group->import != NULL) {
+        importRegistration_stop(group->import);
+        importRegistration_destroy(group->import);
+    }
+    rsaReplicaSet_destroy(group->set);
+    if (group->endpoint != NULL) {
+        endpointDescription_destroy(group->endpoint);
+    }
+    free(group->key);
+    free(group);
+}
+
 celix_status_t remoteServiceAdmin_removeImportedService(remote_service_admin_t *admin, import_registration_t *registration) {
     celix_status_t status = CELIX_SUCCESS;
     logHelper_log(admin->loghelper, OSGI_LOGSERVICE_INFO, "RSA_DFI: Removing imported service");
@@ -690,6 +1199,13 @@ celix_status_t remoteServiceAdmin_removeImportedService(remote_service_admin_t *
         current = arrayList_get(admin->importedServices, i);
         if (current == registration) {
             arrayList_remove(admin->importedServices, i);
+            rsa_replica_group_t *group = hashMap_remove(admin->replicaImports, current);
+            if (group != NULL && rsaReplicaSet_removeMember(group->set, current) == 0) {
+                hashMap_remove(admin->replicaGroups, group->key);
+                remoteServiceAdmin_destroyReplicaGroup(group);
+            } else if (group != NULL) {
+                importRegistration_clearCallCache(group->import);
+            }
             importRegistration_close(current);
             importRegistration_destroy(current);
             break;
@@ -701,20 +1217,61 @@ celix_status_t remoteServiceAdmin_removeImportedService(remote_service_admin_t *
 }
 
 
+void remoteServiceAdmin_collectMetrics(void *handle, const celix_metrics_writer_t *writer) {
+    remote_service_admin_t *rsa = handle;
+    void *h = writer->handle;
+
+    size_t nrOfExports = 0;
+    celixThreadRwlock_readLock(&rsa->exportedServicesLock);
+    hash_map_iterator_t iter = hashMapIterator_construct(rsa->exportedServices);
+    while (hashMapIterator_hasNext(&iter)) {
+        array_list_pt exports = hashMapIterator_nextValue(&iter);
+        nrOfExports += (size_t)arrayList_size(exports);
+    }
+    celixThreadRwlock_unlock(&rsa->exportedServicesLock);
+
+    celixThreadMutex_lock(&rsa->importedServicesLock);
+    size_t nrOfImports = (size_t)arrayList_size(rsa->importedServices);
+    celixThreadMutex_unlock(&rsa->importedServicesLock);
+
+    writer->write(h, "celix_rsa_exported_services", CELIX_METRIC_GAUGE, "Nr of exported services", "rsa=\"dfi\"", (double)nrOfExports);
+    writer->write(h, "celix_rsa_imported_services", CELIX_METRIC_GAUGE, "Nr of imported services", "rsa=\"dfi\"", (double)nrOfImports);
+    writer->write(h, "celix_rsa_outgoing_calls_total", CELIX_METRIC_COUNTER, "Nr of calls of imported services", "rsa=\"dfi\"", (double)__atomic_load_n(&rsa->metrics.outgoingCalls, __ATOMIC_RELAXED));
+    writer->write(h, "celix_rsa_outgoing_failures_total", CELIX_METRIC_COUNTER, "Nr of calls of imported services which failed on transport level", "rsa=\"dfi\"", (double)__atomic_load_n(&rsa->metrics.outgoingFailures, __ATOMIC_RELAXED));
+    writer->write(h, "celix_rsa_incoming_calls_total", CELIX_METRIC_COUNTER, "Nr of calls of exported services", "rsa=\"dfi\"", (double)__atomic_load_n(&rsa->metrics.incomingCalls, __ATOMIC_RELAXED));
+    writer->write(h, "celix_rsa_incoming_failures_total", CELIX_METRIC_COUNTER, "Nr of calls of exported services which could not be invoked", "rsa=\"dfi\"", (double)__atomic_load_n(&rsa->metrics.incomingFailures, __ATOMIC_RELAXED));
+}
+
 static celix_status_t remoteServiceAdmin_send(void *handle, endpoint_description_t *endpointDescription, char *request, char **reply, int* replyStatus) {
-    remote_service_admin_t * rsa = handle;
-    struct post post;
-    post.readptr = request;
-    post.size = strlen(request);
+    size_t replyLength = 0;
+    return remoteServiceAdmin_post(handle, endpointDescription, NULL, request, strlen(request), reply, &replyLength, replyStatus);
+}
 
-    struct get get;
-    get.size = 0;
-    get.writeptr = malloc(1);
+static celix_status_t remoteServiceAdmin_sendBinary(void *handle, endpoint_description_t *endpointDescription, const uint8_t *request, size_t requestLength, uint8_t **reply, size_t *replyLength, int* replyStatus) {
+    char *data = NULL;
+    celix_status_t status = remoteServiceAdmin_post(handle, endpointDescription, "Content-Type: " RSA_DFI_AVROBIN_CONTENT_TYPE, request, requestLength, &data, replyLength, replyStatus);
+    *reply = (uint8_t *) data;
+    return status;
+}
 
+static celix_status_t remoteServiceAdmin_post(remote_service_admin_t *rsa, endpoint_description_t *endpointDescription, const char *contentTypeHeader, const void *request, size_t requestLength, char **reply, size_t *replyLength, int* replyStatus) {
     const char *serviceUrl = celix_properties_get(endpointDescription->properties, (char*) RSA_DFI_ENDPOINT_URL, NULL);
     char url[256];
     snprintf(url, 256, "%s", serviceUrl);
 
+    int timeout = remoteServiceAdmin_proxyTimeout(rsa, endpointDescription);
+
+    __atomic_add_fetch(&rsa->metrics.outgoingCalls, 1, __ATOMIC_RELAXED);
+    CELIX_PROBE2(rsa_send, url, requestLength);
+    logHelper_log(rsa->loghelper, OSGI_LOGSERVICE_DEBUG, "RSA: Performing curl post\n");
+    celix_status_t status = rsaHttpClient_post(rsa->httpClient, url, timeout, contentTypeHeader, request, requestLength, reply, replyLength, replyStatus);
+    if (status != CELIX_SUCCESS || *replyStatus != CURLE_OK) {
+        __atomic_add_fetch(&rsa->metrics.outgoingFailures, 1, __ATOMIC_RELAXED);
+    }
+    return status;
+}
+
+static int remoteServiceAdmin_proxyTimeout(remote_service_admin_t *rsa, endpoint_description_t *endpointDescription) {
     // assume the default timeout
     int timeout = DEFAULT_TIMEOUT;
 
@@ -730,65 +1287,253 @@ static celix_status_t remoteServiceAdmin_send(void *handle, endpoint_description
     if (timeoutStr != NULL) {
         timeout = atoi(timeoutStr);
     }
+    return timeout;
+}
+
+//
+// Queues the request for the async thread. The transfers of the async thread share the connection cache of the
+// multi handle, so keep-alive connections are reused across async calls.
+//
+static celix_status_t remoteServiceAdmin_sendAsync(void *handle, endpoint_description_t *endpointDescription, bool binary, uint8_t *request, size_t requestLength, send_async_complete_func_type complete, void *completeHandle) {
+    remote_service_admin_t *rsa = handle;
+    __atomic_add_fetch(&rsa->metrics.outgoingCalls, 1, __ATOMIC_RELAXED);
+    rsa_async_transfer_t *transfer = calloc(1, sizeof(*transfer));
+    CURL *curl = curl_easy_init();
+    char *reply = calloc(1, 1);
+    if (transfer == NULL || curl == NULL || reply == NULL) {
+        __atomic_add_fetch(&rsa->metrics.outgoingFailures, 1, __ATOMIC_RELAXED);
+        free(transfer);
+        curl_easy_cleanup(curl);
+        free(reply);
+        free(request);
+        return CELIX_ENOMEM;
+    }
 
-    celix_status_t status = CELIX_SUCCESS;
-    CURL *curl;
-    CURLcode res;
+    transfer->curl = curl;
+    transfer->request = request;
+    transfer->post.readptr = (const char *)request;
+    transfer->post.size = requestLength;
+    transfer->get.writeptr = reply;
+    transfer->get.size = 0;
+    transfer->complete = complete;
+    transfer->completeHandle = completeHandle;
+    if (binary) {
+        transfer->headers = curl_slist_append(NULL, "Content-Type: " RSA_DFI_AVROBIN_CONTENT_TYPE);
+    }
 
-    curl = curl_easy_init();
-    if(!curl) {
-        status = CELIX_ILLEGAL_STATE;
+    const char *serviceUrl = celix_properties_get(endpointDescription->properties, (char*) RSA_DFI_ENDPOINT_URL, NULL);
+    transfer->headers = rsaHttpClient_setupPost(curl, serviceUrl, remoteServiceAdmin_proxyTimeout(rsa, endpointDescription), &transfer->post, &transfer->get, transfer->headers);
+    curl_easy_setopt(curl, CURLOPT_PRIVATE, transfer);
+
+    celix_status_t status = CELIX_SUCCESS;
+    celixThreadMutex_lock(&rsa->asyncLock);
+    if (rsa->asyncRunning) {
+        arrayList_add(rsa->asyncQueued, transfer);
     } else {
-        curl_easy_setopt(curl, CURLOPT_NOSIGNAL, 1);
-        curl_easy_setopt(curl, CURLOPT_TIMEOUT, timeout);
-        curl_easy_setopt(curl, CURLOPT_URL, url);
-        curl_easy_setopt(curl, CURLOPT_POST, 1L);
-        curl_easy_setopt(curl, CURLOPT_READFUNCTION, remoteServiceAdmin_readCallback);
-        curl_easy_setopt(curl, CURLOPT_READDATA, &post);
-        curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, remoteServiceAdmin_write);
-        curl_easy_setopt(curl, CURLOPT_WRITEDATA, (void *)&get);
-        curl_easy_setopt(curl, CURLOPT_POSTFIELDSIZE, (curl_off_t)post.size);
-        logHelper_log(rsa->loghelper, OSGI_LOGSERVICE_DEBUG, "RSA: Performing curl post\n");
-        res = curl_easy_perform(curl);
-
-        *reply = get.writeptr;
-        *replyStatus = res;
+        status = CELIX_ILLEGAL_STATE;
+    }
+    celixThreadMutex_unlock(&rsa->asyncLock);
 
+    if (status == CELIX_SUCCESS) {
+        curl_multi_wakeup(rsa->multi);
+    } else {
+        __atomic_add_fetch(&rsa->metrics.outgoingFailures, 1, __ATOMIC_RELAXED);
         curl_easy_cleanup(curl);
+        curl_slist_free_all(transfer->headers);
+        free(transfer->get.writeptr);
+        free(transfer->request);
+        free(transfer);
+    }
+    return status;
+}
+
+//
+// Sends a call on the socket transport. Like a failed HTTP call, a call which failed on transport level has an empty
+// reply and the (errno) error as reply status.
+//
+static celix_status_t remoteServiceAdmin_callTcp(remote_service_admin_t *rsa, endpoint_description_t *endpointDescription, bool binary, const uint8_t *request, size_t requestLength, uint8_t **reply, size_t *replyLength, int *replyStatus) {
+    const char *url = celix_properties_get(endpointDescription->properties, RSA_DFI_TCP_ENDPOINT_URL, NULL);
+    __atomic_add_fetch(&rsa->metrics.outgoingCalls, 1, __ATOMIC_RELAXED);
+    CELIX_PROBE2(rsa_send, url, requestLength);
+    celix_status_t status = rsaTcpClient_call(rsa->tcpClient, url, endpointDescription->serviceId, binary, request, requestLength,
+                                              remoteServiceAdmin_proxyTimeout(rsa, endpointDescription), reply, replyLength, replyStatus);
+    if (status != CELIX_SUCCESS) {
+        __atomic_add_fetch(&rsa->metrics.outgoingFailures, 1, __ATOMIC_RELAXED);
+        *reply = calloc(1, 1);
+        *replyLength = 0;
+        status = *reply != NULL ? CELIX_SUCCESS : CELIX_ENOMEM;
+    }
+    return status;
+}
+
+static celix_status_t remoteServiceAdmin_sendTcp(void *handle, endpoint_description_t *endpointDescription, char *request, char **reply, int* replyStatus) {
+    uint8_t *data = NULL;
+    size_t replyLength = 0;
+    celix_status_t status = remoteServiceAdmin_callTcp(handle, endpointDescription, false, (const uint8_t *) request, strlen(request), &data, &replyLength, replyStatus);
+    *reply = (char *) data;
+    return status;
+}
+
+static celix_status_t remoteServiceAdmin_sendBinaryTcp(void *handle, endpoint_description_t *endpointDescription, const uint8_t *request, size_t requestLength, uint8_t **reply, size_t *replyLength, int* replyStatus) {
+    return remoteServiceAdmin_callTcp(handle, endpointDescription, true, request, requestLength, reply, replyLength, replyStatus);
+}
+
+static void remoteServiceAdmin_tcpAsyncCallCompleted(void *handle, int status, uint8_t *reply, size_t replyLength) {
+    rsa_tcp_async_call_t *call = handle;
+    if (status != 0) {
+        __atomic_add_fetch(&call->rsa->metrics.outgoingFailures, 1, __ATOMIC_RELAXED);
     }
+    call->complete(call->completeHandle, status, reply, replyLength);
+    free(call);
+}
 
+//
+// Sends the request on the shared connection of the socket transport, the reply is handled by the receive thread of
+// the connection. So no async thread is needed for async calls on the socket transport.
+//
+static celix_status_t remoteServiceAdmin_sendAsyncTcp(void *handle, endpoint_description_t *endpointDescription, bool binary, uint8_t *request, size_t requestLength, send_async_complete_func_type complete, void *completeHandle) {
+    remote_service_admin_t *rsa = handle;
+    __atomic_add_fetch(&rsa->metrics.outgoingCalls, 1, __ATOMIC_RELAXED);
+    rsa_tcp_async_call_t *call = calloc(1, sizeof(*call));
+    if (call == NULL) {
+        __atomic_add_fetch(&rsa->metrics.outgoingFailures, 1, __ATOMIC_RELAXED);
+        free(request);
+        return CELIX_ENOMEM;
+    }
+    call->rsa = rsa;
+    call->complete = complete;
+    call->completeHandle = completeHandle;
+    const char *url = celix_properties_get(endpointDescription->properties, RSA_DFI_TCP_ENDPOINT_URL, NULL);
+    CELIX_PROBE2(rsa_send, url, requestLength);
+    celix_status_t status = rsaTcpClient_callAsync(rsa->tcpClient, url, endpointDescription->serviceId, binary, request, requestLength, remoteServiceAdmin_tcpAsyncCallCompleted, call);
+    if (status != CELIX_SUCCESS) {
+        __atomic_add_fetch(&rsa->metrics.outgoingFailures, 1, __ATOMIC_RELAXED);
+        free(call);
+    }
     return status;
 }
 
-static size_t remoteServiceAdmin_readCallback(void *ptr, size_t size, size_t nmemb, void *userp) {
-    struct post *post = userp;
+static void remoteServiceAdmin_completeTransfer(rsa_async_transfer_t *transfer, int result) {
+    transfer->complete(transfer->completeHandle, result, (uint8_t *)transfer->get.writeptr, transfer->get.size);
+    curl_easy_cleanup(transfer->curl);
+    curl_slist_free_all(transfer->headers);
+    free(transfer->request);
+    free(transfer);
+}
+
+//
+// Drives all in flight async calls on the multi handle. Transfers are only added/removed by this thread, on stop the
+// in flight and queued transfers are completed as aborted.
+//
+static void* remoteServiceAdmin_asyncLoop(void *data) {
+    remote_service_admin_t *rsa = data;
+    array_list_pt active = NULL;
+    arrayList_create(&active);
+
+    bool running = true;
+    while (running) {
+        celixThreadMutex_lock(&rsa->asyncLock);
+        for (int i = 0; i < arrayList_size(rsa->asyncQueued); ++i) {
+            rsa_async_transfer_t *transfer = arrayList_get(rsa->asyncQueued, i);
+            curl_multi_add_handle(rsa->multi, transfer->curl);
+            arrayList_add(active, transfer);
+        }
+        arrayList_clear(rsa->asyncQueued);
+        running = rsa->asyncRunning;
+        celixThreadMutex_unlock(&rsa->asyncLock);
+
+        int stillRunning = 0;
+        curl_multi_perform(rsa->multi, &stillRunning);
+
+        CURLMsg *msg;
+        int msgsLeft = 0;
+        while ((msg = curl_multi_info_read(rsa->multi, &msgsLeft)) != NULL) {
+            if (msg->msg == CURLMSG_DONE) {
+                rsa_async_transfer_t *transfer = NULL;
+                int result = rsaHttpClient_replyStatus(msg->easy_handle, msg->data.result);
+                curl_easy_getinfo(msg->easy_handle, CURLINFO_PRIVATE, (char **)&transfer);
+                curl_multi_remove_handle(rsa->multi, transfer->curl);
+                arrayList_removeElement(active, transfer);
+                if (result != CURLE_OK) {
+                    __atomic_add_fetch(&rsa->metrics.outgoingFailures, 1, __ATOMIC_RELAXED);
+                }
+                remoteServiceAdmin_completeTransfer(transfer, result);
+            }
+        }
 
-    if (post->size) {
-        *(char *) ptr = post->readptr[0];
-        post->readptr++;
-        post->size--;
-        return 1;
+        if (running) {
+            curl_multi_poll(rsa->multi, NULL, 0, 1000, NULL);
+        }
     }
 
-    return 0;
+    for (int i = 0; i < arrayList_size(active); ++i) {
+        rsa_async_transfer_t *transfer = arrayList_get(active, i);
+        curl_multi_remove_handle(rsa->multi, transfer->curl);
+        remoteServiceAdmin_completeTransfer(transfer, CURLE_ABORTED_BY_CALLBACK);
+    }
+    arrayList_destroy(active);
+    return NULL;
 }
 
-static size_t remoteServiceAdmin_write(void *contents, size_t size, size_t nmemb, void *userp) {
-    size_t realsize = size * nmemb;
-    struct get *mem = (struct get *)userp;
+static void remoteServiceAdmin_stopAsync(remote_service_admin_t *rsa) {
+    if (rsa->multi == NULL) {
+        return;
+    }
+    celixThreadMutex_lock(&rsa->asyncLock);
+    bool running = rsa->asyncRunning;
+    rsa->asyncRunning = false;
+    celixThreadMutex_unlock(&rsa->asyncLock);
+
+    if (running) {
+        curl_multi_wakeup(rsa->multi);
+        celixThread_join(rsa->asyncThread, NULL);
+    }
+    for (int i = 0; i < arrayList_size(rsa->asyncQueued); ++i) {
+        remoteServiceAdmin_completeTransfer(arrayList_get(rsa->asyncQueued, i), CURLE_ABORTED_BY_CALLBACK);
+    }
+    arrayList_destroy(rsa->asyncQueued);
+    celixThreadMutex_destroy(&rsa->asyncLock);
+    curl_multi_cleanup(rsa->multi);
+    rsa->multi = NULL;
+}
 
-    mem->writeptr = realloc(mem->writeptr, mem->size + realsize + 1);
-    if (mem->writeptr == NULL) {
-        /* out of memory! */
-        printf("not enough memory (realloc returned NULL)");
-        exit(EXIT_FAILURE);
+static bool remoteServiceAdmin_endpointSupportsProtocol(endpoint_description_t *endpointDescription, const char *protocol) {
+    const char *protocols = celix_properties_get(endpointDescription->properties, RSA_DFI_ENDPOINT_PROTOCOLS, NULL);
+    size_t len = strlen(protocol);
+    while (protocols != NULL && *protocols != '\0') {
+        while (*protocols == ' ' || *protocols == ',') {
+            protocols++;
+        }
+        size_t tokenLen = strcspn(protocols, ", ");
+        if (tokenLen == len && strncmp(protocols, protocol, len) == 0) {
+            return true;
+        }
+        protocols += tokenLen;
     }
+    return false;
+}
 
-    memcpy(&(mem->writeptr[mem->size]), contents, realsize);
-    mem->size += realsize;
-    mem->writeptr[mem->size] = 0;
+//
+// Returns whether the comma separated configs (e.g. the exported or imported configs) contain config.
+//
+static bool remoteServiceAdmin_hasConfig(const char *configs, const char *config) {
+    bool found = false;
+    char *ecCopy = strndup(configs, strlen(configs));
+    const char delimiter[2] = ",";
+    char *token, *savePtr;
+
+    token = strtok_r(ecCopy, delimiter, &savePtr);
+    while (token != NULL) {
+        if (strncmp(utils_stringTrim(token), config, 1024) == 0) {
+            found = true;
+            break;
+        }
+
+        token = strtok_r(NULL, delimiter, &savePtr);
+    }
 
-    return realsize;
+    free(ecCopy);
+    return found;
 }
 
 
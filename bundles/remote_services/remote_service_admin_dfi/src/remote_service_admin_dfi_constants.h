@@ -33,12 +33,140 @@
 #define RSA_LOG_CALLS_FILE_KEY          "RSA_LOG_CALLS_FILE"
 #define RSA_LOG_CALLS_FILE_DEFAULT      "stdout"
 
+#define RSA_BINARY_RPC_KEY              "RSA_BINARY_RPC"
+#define RSA_BINARY_RPC_DEFAULT          true
+
+/**
+ * Max nr of idle (keep-alive) HTTP connections kept per remote host:port for remote calls. 0 disables the pooling,
+ * i.e. every remote call uses a new connection.
+ */
+#define RSA_CONNECTION_POOL_SIZE_KEY    "RSA_CONNECTION_POOL_SIZE"
+#define RSA_CONNECTION_POOL_SIZE_DEFAULT 4
+
+/**
+ * Nr of HTTP server threads. A keep-alive connection of a remote caller occupies a server thread while it is open,
+ * so this should be larger than the total nr of pooled connections of the callers.
+ */
+#define RSA_SERVER_THREADS_KEY          "RSA_SERVER_THREADS"
+#define RSA_SERVER_THREADS_DEFAULT      16
+
+/**
+ * Nr of accepted connections that can wait for a free HTTP server thread. When the queue is full new connections
+ * stay in the listen backlog of the socket.
+ */
+#define RSA_SERVER_QUEUE_SIZE_KEY       "RSA_SERVER_QUEUE_SIZE"
+#define RSA_SERVER_QUEUE_SIZE_DEFAULT   20
+
+/**
+ * If true, no HTTP server of its own is started, the calls are handled by an http_admin service (under the
+ * RSA_HTTP_ADMIN_URI) sharing the server, threads and port of the http_admin. The port of the endpoint urls is the
+ * port of the http_admin, RSA_PORT, RSA_SERVER_THREADS and RSA_SERVER_QUEUE_SIZE are not used.
+ */
+#define RSA_USE_HTTP_ADMIN_KEY          "RSA_USE_HTTP_ADMIN"
+#define RSA_USE_HTTP_ADMIN_DEFAULT      false
+#define RSA_HTTP_ADMIN_URI              "/service"
+#define RSA_HTTP_ADMIN_PORT_KEY         "CELIX_HTTP_ADMIN_LISTENING_PORTS" //used till the http_admin info service is found
+#define RSA_HTTP_ADMIN_PORT_DEFAULT     8080
+
+/**
+ * If true, an async variant (see remote_async_call.h) is registered for every imported service. The async calls are
+ * sent concurrently by a single thread on a curl multi handle.
+ */
+#define RSA_ASYNC_IMPORT_KEY            "RSA_ASYNC_IMPORT"
+#define RSA_ASYNC_IMPORT_DEFAULT        false
+
+#define RSA_CALL_COALESCING_WINDOW_KEY      "RSA_CALL_COALESCING_WINDOW_US"
+#define RSA_CALL_COALESCING_WINDOW_DEFAULT  0
+#define RSA_CALL_COALESCING_MAX_BATCH_KEY   "RSA_CALL_COALESCING_MAX_BATCH"
+#define RSA_CALL_COALESCING_MAX_BATCH_DEFAULT 32
+
+/**
+ * Max nr of cached replies per imported service, for the methods with a cacheTtlMs annotation in their descriptor.
+ * 0 disables the caching.
+ */
+#define RSA_CALL_CACHE_SIZE_KEY         "RSA_CALL_CACHE_SIZE"
+#define RSA_CALL_CACHE_SIZE_DEFAULT     256
+
+/**
+ * If true, services are also exported on, and imported through, the binary socket transport (see
+ * RSA_DFI_TCP_CONFIGURATION_TYPE): length prefixed json or avrobin calls over persistent TCP or Unix domain socket
+ * connections, with many concurrent calls sharing a connection.
+ */
+#define RSA_TCP_TRANSPORT_KEY           "RSA_TCP_TRANSPORT"
+#define RSA_TCP_TRANSPORT_DEFAULT       false
+#define RSA_TCP_PORT_KEY                "RSA_TCP_PORT"
+#define RSA_TCP_PORT_DEFAULT            8889
+/**
+ * If set, the socket transport listens on this Unix domain socket instead of on RSA_TCP_PORT. Only usable for
+ * importing frameworks on the same host.
+ */
+#define RSA_TCP_UNIX_SOCKET_KEY         "RSA_TCP_UNIX_SOCKET"
+/**
+ * Nr of threads executing the calls received by the socket transport.
+ */
+#define RSA_TCP_SERVER_THREADS_KEY      "RSA_TCP_SERVER_THREADS"
+#define RSA_TCP_SERVER_THREADS_DEFAULT  8
+
+/**
+ * Import mode for replicated services, i.e. endpoints with the same RSA_DFI_REPLICA_GROUP, interface and version.
+ * With "none" every endpoint is imported as a separate service. With "round_robin" or "least_outstanding" the
+ * equivalent endpoints are imported as one service, which spreads the calls over the endpoints.
+ */
+#define RSA_LOAD_BALANCING_KEY          "RSA_LOAD_BALANCING"
+#define RSA_LOAD_BALANCING_DEFAULT      "none"
+#define RSA_LOAD_BALANCING_ROUND_ROBIN  "round_robin"
+#define RSA_LOAD_BALANCING_LEAST_OUTSTANDING "least_outstanding"
+/**
+ * If true, a sync call of a load balanced service marked RSA_DFI_IDEMPOTENT is also sent to a second endpoint when no
+ * reply is received within the p95 latency of the first endpoint (at least RSA_HEDGE_MIN_DELAY_US), the first reply
+ * is used. Needs async sends, i.e. RSA_ASYNC_IMPORT or the socket transport.
+ */
+#define RSA_HEDGE_CALLS_KEY             "RSA_HEDGE_CALLS"
+#define RSA_HEDGE_CALLS_DEFAULT         false
+#define RSA_HEDGE_MIN_DELAY_US_KEY      "RSA_HEDGE_MIN_DELAY_US"
+#define RSA_HEDGE_MIN_DELAY_US_DEFAULT  1000
+
 
 
 
 #define RSA_DFI_CONFIGURATION_TYPE      "org.amdatu.remote.admin.http"
 #define RSA_DFI_ENDPOINT_URL            "org.amdatu.remote.admin.http.url"
 
+/**
+ * Config of endpoints exported on the socket transport. Services with this config in their service.exported.configs
+ * (or without exported configs) are exported on the socket transport if it is enabled, importers supporting it use
+ * the socket transport instead of HTTP.
+ */
+#define RSA_DFI_TCP_CONFIGURATION_TYPE  "org.amdatu.remote.admin.tcp"
+#define RSA_DFI_TCP_ENDPOINT_URL        "org.amdatu.remote.admin.tcp.url" //tcp://ip:port or unix://path
+
+/**
+ * Endpoint property with the comma separated list of call encodings supported by the exporting RSA.
+ * If the importing RSA also supports (and enables) avrobin, calls are made with the binary avrobin rpc encoding.
+ */
+#define RSA_DFI_ENDPOINT_PROTOCOLS      "org.apache.celix.rsa.dfi.protocols"
+#define RSA_DFI_PROTOCOL_JSON           "json"
+#define RSA_DFI_PROTOCOL_AVROBIN        "avrobin"
+#define RSA_DFI_PROTOCOL_BATCH          "batch" //the endpoint accepts batch requests of the other protocols
+#define RSA_DFI_AVROBIN_CONTENT_TYPE    "application/x-celix-avrobin"
+
+/**
+ * Optional properties of an exported service. If RSA_DFI_EXPORT_THREADS is > 0, calls for the service are executed
+ * by a thread pool of its own with a queue of RSA_DFI_EXPORT_QUEUE_SIZE calls. When the queue is full, calls are
+ * rejected with HTTP 503 instead of occupying more HTTP server threads, so a slow service cannot starve the others.
+ */
+#define RSA_DFI_EXPORT_THREADS          "org.apache.celix.rsa.dfi.export.threads"
+#define RSA_DFI_EXPORT_QUEUE_SIZE       "org.apache.celix.rsa.dfi.export.queue.size"
+#define RSA_DFI_EXPORT_QUEUE_SIZE_DEFAULT 16
+
+/**
+ * Optional properties of an exported service. Services exported with the same replica group (and the same interface
+ * and version) are equivalent, importers with RSA_LOAD_BALANCING enabled import them as one service.
+ * Calls of an idempotent service can be hedged (see RSA_HEDGE_CALLS).
+ */
+#define RSA_DFI_REPLICA_GROUP           "org.apache.celix.rsa.dfi.replica.group"
+#define RSA_DFI_IDEMPOTENT              "org.apache.celix.rsa.dfi.idempotent"
+
 
 
 #endif //CELIX_REMOTE_SERVICE_ADMIN_DFI_CONSTANTS_H
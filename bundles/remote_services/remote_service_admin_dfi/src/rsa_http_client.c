@@ -0,0 +1,223 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *  KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "array_list.h"
+#include "hash_map.h"
+#include "utils.h"
+#include "celix_threads.h"
+#include "rsa_http_client.h"
+
+struct rsa_http_client {
+    long connectionPoolSize;
+    celix_thread_mutex_t mutex; //protects pools
+    hash_map_pt pools; //key = scheme://host:port of the remote service url, value = array_list of idle CURL handles
+};
+
+static CURL* rsaHttpClient_takeConnection(rsa_http_client_t *client, const char *url);
+static void rsaHttpClient_releaseConnection(rsa_http_client_t *client, const char *url, CURL *curl, bool reusable);
+static void rsaHttpClient_urlOrigin(const char *url, char *origin, size_t originSize);
+static size_t rsaHttpClient_readCallback(void *ptr, size_t size, size_t nmemb, void *userp);
+static size_t rsaHttpClient_writeCallback(void *contents, size_t size, size_t nmemb, void *userp);
+
+rsa_http_client_t* rsaHttpClient_create(long connectionPoolSize) {
+    rsa_http_client_t *client = calloc(1, sizeof(*client));
+    if (client != NULL) {
+        client->connectionPoolSize = connectionPoolSize;
+        celixThreadMutex_create(&client->mutex, NULL);
+        client->pools = hashMap_create(utils_stringHash, NULL, utils_stringEquals, NULL);
+    }
+    return client;
+}
+
+void rsaHttpClient_destroy(rsa_http_client_t *client) {
+    if (client == NULL) {
+        return;
+    }
+    hash_map_iterator_t iter = hashMapIterator_construct(client->pools);
+    while (hashMapIterator_hasNext(&iter)) {
+        array_list_pt idle = hashMapIterator_nextValue(&iter);
+        for (unsigned int i = 0; i < arrayList_size(idle); i++) {
+            curl_easy_cleanup(arrayList_get(idle, i));
+        }
+        arrayList_destroy(idle);
+    }
+    hashMap_destroy(client->pools, true, false);
+    celixThreadMutex_destroy(&client->mutex);
+    free(client);
+}
+
+celix_status_t rsaHttpClient_post(rsa_http_client_t *client, const char *url, int timeoutInSec, const char *contentTypeHeader, const void *request, size_t requestLength, char **reply, size_t *replyLength, int *replyStatus) {
+    rsa_http_request_body_t post;
+    post.readptr = request;
+    post.size = requestLength;
+
+    rsa_http_reply_body_t get;
+    get.size = 0;
+    get.writeptr = malloc(1);
+
+    CURL *curl = rsaHttpClient_takeConnection(client, url);
+    if (curl == NULL || get.writeptr == NULL) {
+        rsaHttpClient_releaseConnection(client, url, curl, false);
+        free(get.writeptr);
+        return CELIX_ILLEGAL_STATE;
+    }
+    get.writeptr[0] = '\0';
+
+    struct curl_slist *headers = NULL;
+    if (contentTypeHeader != NULL) {
+        headers = curl_slist_append(headers, contentTypeHeader);
+    }
+    headers = rsaHttpClient_setupPost(curl, url, timeoutInSec, &post, &get, headers);
+    int status = rsaHttpClient_replyStatus(curl, curl_easy_perform(curl));
+
+    *reply = get.writeptr;
+    *replyLength = get.size;
+    *replyStatus = status;
+
+    rsaHttpClient_releaseConnection(client, url, curl, status == CURLE_OK);
+    curl_slist_free_all(headers);
+    return CELIX_SUCCESS;
+}
+
+struct curl_slist* rsaHttpClient_setupPost(CURL *curl, const char *url, int timeoutInSec, rsa_http_request_body_t *request, rsa_http_reply_body_t *reply, struct curl_slist *headers) {
+    curl_easy_setopt(curl, CURLOPT_NOSIGNAL, 1L);
+    curl_easy_setopt(curl, CURLOPT_TIMEOUT, (long)timeoutInSec);
+    curl_easy_setopt(curl, CURLOPT_URL, url);
+    curl_easy_setopt(curl, CURLOPT_POST, 1L);
+    curl_easy_setopt(curl, CURLOPT_READFUNCTION, rsaHttpClient_readCallback);
+    curl_easy_setopt(curl, CURLOPT_READDATA, request);
+    curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, rsaHttpClient_writeCallback);
+    curl_easy_setopt(curl, CURLOPT_WRITEDATA, (void *)reply);
+    curl_easy_setopt(curl, CURLOPT_POSTFIELDSIZE_LARGE, (curl_off_t)request->size);
+    curl_easy_setopt(curl, CURLOPT_TCP_NODELAY, 1L);
+    // no "Expect: 100-continue" round trip for larger requests
+    headers = curl_slist_append(headers, "Expect:");
+    curl_easy_setopt(curl, CURLOPT_HTTPHEADER, headers);
+    return headers;
+}
+
+int rsaHttpClient_replyStatus(CURL *curl, CURLcode result) {
+    if (result != CURLE_OK) {
+        return result;
+    }
+    long responseCode = 0;
+    curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &responseCode);
+    return responseCode >= 200 && responseCode < 300 ? CURLE_OK : CURLE_HTTP_RETURNED_ERROR;
+}
+
+size_t rsaHttpClient_nrOfIdleConnections(rsa_http_client_t *client, const char *url) {
+    char origin[256];
+    rsaHttpClient_urlOrigin(url, origin, sizeof(origin));
+    celixThreadMutex_lock(&client->mutex);
+    array_list_pt idle = hashMap_get(client->pools, origin);
+    size_t count = idle != NULL ? (size_t)arrayList_size(idle) : 0;
+    celixThreadMutex_unlock(&client->mutex);
+    return count;
+}
+
+//
+// Returns an idle (keep-alive) curl handle for the origin of the url, or a new handle if there is none.
+// curl_easy_reset clears the options of a pooled handle, but keeps its open connections.
+//
+static CURL* rsaHttpClient_takeConnection(rsa_http_client_t *client, const char *url) {
+    CURL *curl = NULL;
+    if (client->connectionPoolSize > 0) {
+        char origin[256];
+        rsaHttpClient_urlOrigin(url, origin, sizeof(origin));
+        celixThreadMutex_lock(&client->mutex);
+        array_list_pt idle = hashMap_get(client->pools, origin);
+        if (idle != NULL && arrayList_size(idle) > 0) {
+            curl = arrayList_remove(idle, arrayList_size(idle) - 1);
+        }
+        celixThreadMutex_unlock(&client->mutex);
+    }
+    if (curl != NULL) {
+        curl_easy_reset(curl);
+    } else {
+        curl = curl_easy_init();
+    }
+    return curl;
+}
+
+//
+// Returns the curl handle to the pool of the origin of the url, if the call succeeded and the pool is not full.
+//
+static void rsaHttpClient_releaseConnection(rsa_http_client_t *client, const char *url, CURL *curl, bool reusable) {
+    if (curl != NULL && reusable && client->connectionPoolSize > 0) {
+        char origin[256];
+        rsaHttpClient_urlOrigin(url, origin, sizeof(origin));
+        celixThreadMutex_lock(&client->mutex);
+        array_list_pt idle = hashMap_get(client->pools, origin);
+        if (idle == NULL) {
+            arrayList_create(&idle);
+            hashMap_put(client->pools, strdup(origin), idle);
+        }
+        if (arrayList_size(idle) < client->connectionPoolSize) {
+            arrayList_add(idle, curl);
+            curl = NULL;
+        }
+        celixThreadMutex_unlock(&client->mutex);
+    }
+    if (curl != NULL) {
+        curl_easy_cleanup(curl);
+    }
+}
+
+//
+// Copies the scheme://host:port part of the url to origin, used as key of the connection pools.
+//
+static void rsaHttpClient_urlOrigin(const char *url, char *origin, size_t originSize) {
+    const char *host = strstr(url, "://");
+    host = host != NULL ? host + 3 : url;
+    size_t len = (size_t) (host - url) + strcspn(host, "/");
+    snprintf(origin, originSize, "%.*s", (int) len, url);
+}
+
+static size_t rsaHttpClient_readCallback(void *ptr, size_t size, size_t nmemb, void *userp) {
+    rsa_http_request_body_t *post = userp;
+    size_t count = size * nmemb;
+    if (count > post->size) {
+        count = post->size;
+    }
+
+    memcpy(ptr, post->readptr, count);
+    post->readptr += count;
+    post->size -= count;
+    return count;
+}
+
+static size_t rsaHttpClient_writeCallback(void *contents, size_t size, size_t nmemb, void *userp) {
+    size_t realsize = size * nmemb;
+    rsa_http_reply_body_t *mem = userp;
+
+    char *writeptr = realloc(mem->writeptr, mem->size + realsize + 1);
+    if (writeptr == NULL) {
+        return 0; //aborts the transfer with CURLE_WRITE_ERROR
+    }
+    mem->writeptr = writeptr;
+    memcpy(&(mem->writeptr[mem->size]), contents, realsize);
+    mem->size += realsize;
+    mem->writeptr[mem->size] = 0;
+
+    return realsize;
+}
@@ -0,0 +1,85 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *  KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#ifndef CELIX_RSA_HTTP_CLIENT_H
+#define CELIX_RSA_HTTP_CLIENT_H
+
+#include <stddef.h>
+#include <curl/curl.h>
+
+#include "celix_errno.h"
+
+/**
+ * Client side of remote calls over HTTP. Sync calls use curl easy handles from a pool per remote scheme://host:port,
+ * so the keep-alive connection of a handle is reused by the next call to the same remote.
+ */
+typedef struct rsa_http_client rsa_http_client_t;
+
+/**
+ * Request body of a post, read by curl.
+ */
+typedef struct rsa_http_request_body {
+    const char *readptr;
+    size_t size;
+} rsa_http_request_body_t;
+
+/**
+ * Reply body of a post, written by curl. writeptr is 0 terminated and should be allocated (e.g. malloc(1)) before
+ * the transfer.
+ */
+typedef struct rsa_http_reply_body {
+    char *writeptr;
+    size_t size;
+} rsa_http_reply_body_t;
+
+/**
+ * Creates a client which keeps at most connectionPoolSize idle connections per remote, 0 disables pooling.
+ */
+rsa_http_client_t* rsaHttpClient_create(long connectionPoolSize);
+
+/**
+ * Closes the idle connections. Should not be called while posts are in progress.
+ */
+void rsaHttpClient_destroy(rsa_http_client_t *client);
+
+/**
+ * Posts the request to url and waits for the reply, at most timeoutInSec seconds if > 0. contentTypeHeader can be
+ * NULL for the (json) default.
+ * On success the (0 terminated, possibly empty) reply is owned by the caller and replyStatus is set as described
+ * for rsaHttpClient_replyStatus. Only the connection of a call with replyStatus CURLE_OK is returned to the pool.
+ */
+celix_status_t rsaHttpClient_post(rsa_http_client_t *client, const char *url, int timeoutInSec, const char *contentTypeHeader, const void *request, size_t requestLength, char **reply, size_t *replyLength, int *replyStatus);
+
+/**
+ * Sets up curl for a post of request to url and returns headers with the added post headers.
+ */
+struct curl_slist* rsaHttpClient_setupPost(CURL *curl, const char *url, int timeoutInSec, rsa_http_request_body_t *request, rsa_http_reply_body_t *reply, struct curl_slist *headers);
+
+/**
+ * Returns the reply status of a completed transfer: the curl result, or CURLE_HTTP_RETURNED_ERROR if the remote
+ * answered with a non 2xx status. A 204 (No Content) reply, e.g. of a void method, is a successful call.
+ */
+int rsaHttpClient_replyStatus(CURL *curl, CURLcode result);
+
+/**
+ * Returns the nr of pooled idle connections for the remote of url.
+ */
+size_t rsaHttpClient_nrOfIdleConnections(rsa_http_client_t *client, const char *url);
+
+#endif //CELIX_RSA_HTTP_CLIENT_H
@@ -0,0 +1,460 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *  KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "array_list.h"
+#include "celix_threads.h"
+#include "rsa_replica_set.h"
+
+#define RSA_REPLICA_LATENCY_SAMPLES     64 //nr of latest call latencies of a replica used for its p95 latency
+#define RSA_REPLICA_MIN_HEDGE_SAMPLES   16 //calls are only hedged once the p95 latency of the replica is known
+#define RSA_REPLICA_FAILURE_BACKOFF_US  1000000u //a replica is avoided this long after a failed call
+#define RSA_REPLICA_LATENCY_WEIGHT      0.2 //weight of the latest call in the average latency
+
+/**
+ * A replica, owned by the set and by the calls in flight on it. The last one releasing it destroys it.
+ */
+typedef struct rsa_replica {
+    const void *id;
+    endpoint_description_t *endpoint; //copy, so calls in flight can outlive the removal of the endpoint
+    send_func_type send;
+    send_binary_func_type sendBinary;
+    send_async_func_type sendAsync;
+    void *handle;
+    int refCount; //atomic
+    unsigned int outstanding; //atomic, nr of calls in flight
+
+    celix_thread_mutex_t mutex; //protects below
+    double avgLatencyInUs;
+    uint32_t latenciesInUs[RSA_REPLICA_LATENCY_SAMPLES]; //ring buffer of the latest latencies
+    size_t nrOfLatencies;
+    uint64_t failedUntilInUs;
+} rsa_replica_t;
+
+struct rsa_replica_set {
+    rsa_balancing_mode_e mode;
+    bool hedging;
+    unsigned int minHedgeDelayInUs;
+
+    celix_thread_mutex_t mutex; //protects replicas & next
+    array_list_pt replicas;
+    unsigned int next; //round robin position
+};
+
+/**
+ * A hedged sync call, owned by the caller and the attempts in flight. The last one releasing it destroys it.
+ */
+typedef struct rsa_hedged_call {
+    celix_thread_mutex_t mutex; //protects below
+    celix_thread_cond_t cond;
+    int refCount;
+    int pending; //nr of attempts in flight
+    bool completed;
+    int replyStatus; //of the first successful attempt, or of the last failed attempt
+    uint8_t *reply;
+    size_t replyLength;
+} rsa_hedged_call_t;
+
+/**
+ * An async send to a replica, tracks the latency of the call before completing it.
+ */
+typedef struct rsa_replica_attempt {
+    rsa_replica_t *replica;
+    uint64_t startInUs;
+    send_async_complete_func_type complete;
+    void *completeHandle;
+} rsa_replica_attempt_t;
+
+static uint64_t rsaReplicaSet_nowInUs(void) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint64_t)now.tv_sec * 1000000u + (uint64_t)now.tv_nsec / 1000u;
+}
+
+static void rsaReplicaSet_releaseReplica(rsa_replica_t *replica) {
+    if (__atomic_sub_fetch(&replica->refCount, 1, __ATOMIC_ACQ_REL) == 0) {
+        endpointDescription_destroy(replica->endpoint);
+        celixThreadMutex_destroy(&replica->mutex);
+        free(replica);
+    }
+}
+
+rsa_replica_set_t* rsaReplicaSet_create(rsa_balancing_mode_e mode, bool hedging, unsigned int minHedgeDelayInUs) {
+    rsa_replica_set_t *set = calloc(1, sizeof(*set));
+    if (set != NULL) {
+        set->mode = mode;
+        set->hedging = hedging;
+        set->minHedgeDelayInUs = minHedgeDelayInUs > 0 ? minHedgeDelayInUs : 1;
+        celixThreadMutex_create(&set->mutex, NULL);
+        arrayList_create(&set->replicas);
+    }
+    return set;
+}
+
+void rsaReplicaSet_destroy(rsa_replica_set_t *set) {
+    if (set != NULL) {
+        for (int i = 0; i < arrayList_size(set->replicas); ++i) {
+            rsaReplicaSet_releaseReplica(arrayList_get(set->replicas, i));
+        }
+        arrayList_destroy(set->replicas);
+        celixThreadMutex_destroy(&set->mutex);
+        free(set);
+    }
+}
+
+celix_status_t rsaReplicaSet_addMember(rsa_replica_set_t *set, const void *id, const endpoint_description_t *endpoint,
+                                       send_func_type send, send_binary_func_type sendBinary,
+                                       send_async_func_type sendAsync, void *handle) {
+    rsa_replica_t *replica = calloc(1, sizeof(*replica));
+    celix_properties_t *props = celix_properties_copy(endpoint->properties);
+    endpoint_description_t *copy = NULL;
+    celix_status_t status = replica != NULL && props != NULL ? endpointDescription_create(props, &copy) : CELIX_ENOMEM;
+    if (status != CELIX_SUCCESS) {
+        if (props != NULL) {
+            celix_properties_destroy(props);
+        }
+        free(replica);
+        return status;
+    }
+
+    replica->id = id;
+    replica->endpoint = copy;
+    replica->send = send;
+    replica->sendBinary = sendBinary;
+    replica->sendAsync = sendAsync;
+    replica->handle = handle;
+    replica->refCount = 1; //set
+    celixThreadMutex_create(&replica->mutex, NULL);
+
+    celixThreadMutex_lock(&set->mutex);
+    arrayList_add(set->replicas, replica);
+    celixThreadMutex_unlock(&set->mutex);
+    return CELIX_SUCCESS;
+}
+
+size_t rsaReplicaSet_removeMember(rsa_replica_set_t *set, const void *id) {
+    rsa_replica_t *removed = NULL;
+    celixThreadMutex_lock(&set->mutex);
+    for (int i = 0; i < arrayList_size(set->replicas); ++i) {
+        rsa_replica_t *replica = arrayList_get(set->replicas, i);
+        if (replica->id == id) {
+            removed = arrayList_remove(set->replicas, i);
+            break;
+        }
+    }
+    size_t size = (size_t)arrayList_size(set->replicas);
+    celixThreadMutex_unlock(&set->mutex);
+
+    if (removed != NULL) {
+        rsaReplicaSet_releaseReplica(removed);
+    }
+    return size;
+}
+
+static bool rsaReplicaSet_supports(const rsa_replica_t *replica, bool async, bool binary) {
+    if (async) {
+        //a replica without binary send fn does not support the binary encoding, also not for async calls
+        return replica->sendAsync != NULL && (!binary || replica->sendBinary != NULL);
+    }
+    return binary ? replica->sendBinary != NULL : replica->send != NULL;
+}
+
+/**
+ * Selects the replica for a call, replicas which recently failed are only selected if no other replica is
+ * available. Returns NULL if no replica supports the call, otherwise the caller must release the replica.
+ */
+static rsa_replica_t* rsaReplicaSet_select(rsa_replica_set_t *set, bool async, bool binary, const rsa_replica_t *exclude) {
+    uint64_t now = rsaReplicaSet_nowInUs();
+    rsa_replica_t *selected = NULL;
+    bool selectedAvailable = false;
+    double selectedScore = 0.0;
+
+    celixThreadMutex_lock(&set->mutex);
+    unsigned int size = (unsigned int)arrayList_size(set->replicas);
+    for (unsigned int i = 0; i < size; ++i) {
+        //starts at the round robin position, so equal scores are also spread over the replicas
+        rsa_replica_t *replica = arrayList_get(set->replicas, (int)((set->next + i) % size));
+        if (replica == exclude || !rsaReplicaSet_supports(replica, async, binary)) {
+            continue;
+        }
+        celixThreadMutex_lock(&replica->mutex);
+        bool available = replica->failedUntilInUs <= now;
+        double latency = replica->avgLatencyInUs > 1.0 ? replica->avgLatencyInUs : 1.0;
+        celixThreadMutex_unlock(&replica->mutex);
+        double score = (__atomic_load_n(&replica->outstanding, __ATOMIC_RELAXED) + 1) * latency;
+
+        bool better;
+        if (selected == NULL || available != selectedAvailable) {
+            better = selected == NULL || available;
+        } else {
+            better = set->mode == RSA_BALANCING_LEAST_OUTSTANDING && score < selectedScore;
+        }
+        if (better) {
+            selected = replica;
+            selectedAvailable = available;
+            selectedScore = score;
+        }
+    }
+    if (selected != NULL) {
+        set->next += 1;
+        __atomic_add_fetch(&selected->refCount, 1, __ATOMIC_ACQ_REL);
+    }
+    celixThreadMutex_unlock(&set->mutex);
+    return selected;
+}
+
+static void rsaReplicaSet_callDone(rsa_replica_t *replica, uint64_t startInUs, int replyStatus) {
+    uint64_t now = rsaReplicaSet_nowInUs();
+    __atomic_sub_fetch(&replica->outstanding, 1, __ATOMIC_RELAXED);
+
+    celixThreadMutex_lock(&replica->mutex);
+    if (replyStatus == 0) {
+        uint64_t latency = now - startInUs;
+        uint32_t latencyInUs = latency > UINT32_MAX ? UINT32_MAX : (uint32_t)latency;
+        if (replica->nrOfLatencies == 0) {
+            replica->avgLatencyInUs = latencyInUs;
+        } else {
+            replica->avgLatencyInUs += RSA_REPLICA_LATENCY_WEIGHT * (latencyInUs - replica->avgLatencyInUs);
+        }
+        replica->latenciesInUs[replica->nrOfLatencies % RSA_REPLICA_LATENCY_SAMPLES] = latencyInUs;
+        replica->nrOfLatencies += 1;
+    } else {
+        replica->failedUntilInUs = now + RSA_REPLICA_FAILURE_BACKOFF_US;
+    }
+    celixThreadMutex_unlock(&replica->mutex);
+}
+
+/**
+ * Returns the delay after which a call to the replica is hedged: its p95 latency, at least the min hedge delay.
+ * Returns 0 if the p95 latency of the replica is not known yet.
+ */
+static uint64_t rsaReplicaSet_hedgeDelay(rsa_replica_set_t *set, rsa_replica_t *replica) {
+    uint32_t samples[RSA_REPLICA_LATENCY_SAMPLES];
+    celixThreadMutex_lock(&replica->mutex);
+    size_t n = replica->nrOfLatencies < RSA_REPLICA_LATENCY_SAMPLES ? replica->nrOfLatencies : RSA_REPLICA_LATENCY_SAMPLES;
+    memcpy(samples, replica->latenciesInUs, n * sizeof(samples[0]));
+    celixThreadMutex_unlock(&replica->mutex);
+
+    if (n < RSA_REPLICA_MIN_HEDGE_SAMPLES) {
+        return 0;
+    }
+    for (size_t i = 1; i < n; ++i) {
+        uint32_t sample = samples[i];
+        size_t j = i;
+        for (; j > 0 && samples[j - 1] > sample; --j) {
+            samples[j] = samples[j - 1];
+        }
+        samples[j] = sample;
+    }
+    uint64_t p95 = samples[(n * 95 + 99) / 100 - 1];
+    return p95 > set->minHedgeDelayInUs ? p95 : set->minHedgeDelayInUs;
+}
+
+static void rsaReplicaSet_attemptCompleted(void *handle, int replyStatus, uint8_t *reply, size_t replyLength) {
+    rsa_replica_attempt_t *attempt = handle;
+    rsaReplicaSet_callDone(attempt->replica, attempt->startInUs, replyStatus);
+    rsaReplicaSet_releaseReplica(attempt->replica);
+    attempt->complete(attempt->completeHandle, replyStatus, reply, replyLength);
+    free(attempt);
+}
+
+/**
+ * Sends the request async to the replica. The request is owned by the send, also on error.
+ */
+static celix_status_t rsaReplicaSet_sendAttempt(rsa_replica_t *replica, bool binary, uint8_t *request, size_t requestLength, send_async_complete_func_type complete, void *completeHandle) {
+    rsa_replica_attempt_t *attempt = calloc(1, sizeof(*attempt));
+    if (attempt == NULL) {
+        free(request);
+        return CELIX_ENOMEM;
+    }
+    __atomic_add_fetch(&replica->refCount, 1, __ATOMIC_ACQ_REL);
+    __atomic_add_fetch(&replica->outstanding, 1, __ATOMIC_RELAXED);
+    attempt->replica = replica;
+    attempt->startInUs = rsaReplicaSet_nowInUs();
+    attempt->complete = complete;
+    attempt->completeHandle = completeHandle;
+
+    celix_status_t status = replica->sendAsync(replica->handle, replica->endpoint, binary, request, requestLength, rsaReplicaSet_attemptCompleted, attempt);
+    if (status != CELIX_SUCCESS) {
+        rsaReplicaSet_callDone(replica, attempt->startInUs, status);
+        rsaReplicaSet_releaseReplica(replica);
+        free(attempt);
+    }
+    return status;
+}
+
+static void rsaReplicaSet_releaseHedgedCall(rsa_hedged_call_t *call) {
+    celixThreadMutex_lock(&call->mutex);
+    call->refCount -= 1;
+    bool destroy = call->refCount == 0;
+    celixThreadMutex_unlock(&call->mutex);
+
+    if (destroy) {
+        free(call->reply);
+        celixThreadMutex_destroy(&call->mutex);
+        celixThreadCondition_destroy(&call->cond);
+        free(call);
+    }
+}
+
+static void rsaReplicaSet_hedgedAttemptCompleted(void *handle, int replyStatus, uint8_t *reply, size_t replyLength) {
+    rsa_hedged_call_t *call = handle;
+    celixThreadMutex_lock(&call->mutex);
+    call->pending -= 1;
+    if (!call->completed && replyStatus == 0) {
+        call->completed = true;
+        call->replyStatus = 0;
+        call->reply = reply;
+        call->replyLength = replyLength;
+        reply = NULL;
+    } else if (!call->completed) {
+        call->replyStatus = replyStatus;
+    }
+    celixThreadCondition_broadcast(&call->cond);
+    celixThreadMutex_unlock(&call->mutex);
+
+    free(reply); //of a failed attempt or of the attempt which lost the race
+    rsaReplicaSet_releaseHedgedCall(call);
+}
+
+static void rsaReplicaSet_hedgedAttempt(rsa_hedged_call_t *call, rsa_replica_t *replica, bool binary, const uint8_t *request, size_t requestLength) {
+    uint8_t *copy = malloc(requestLength + 1);
+    if (copy == NULL) {
+        return;
+    }
+    memcpy(copy, request, requestLength);
+    copy[requestLength] = '\0'; //json requests are strings
+
+    celixThreadMutex_lock(&call->mutex);
+    call->refCount += 1;
+    call->pending += 1;
+    celixThreadMutex_unlock(&call->mutex);
+
+    celix_status_t status = rsaReplicaSet_sendAttempt(replica, binary, copy, requestLength, rsaReplicaSet_hedgedAttemptCompleted, call);
+    if (status != CELIX_SUCCESS) {
+        celixThreadMutex_lock(&call->mutex);
+        call->refCount -= 1; //the caller still holds the call
+        call->pending -= 1;
+        call->replyStatus = status;
+        celixThreadMutex_unlock(&call->mutex);
+    }
+}
+
+/**
+ * Sends the call async to the replica and, if there is no reply within the hedge delay or the call failed, also
+ * to a second replica. Waits for the first successful reply, or till all attempts failed.
+ */
+static void rsaReplicaSet_hedgedCall(rsa_replica_set_t *set, rsa_replica_t *replica, bool binary, const uint8_t *request, size_t requestLength, uint64_t hedgeDelayInUs, uint8_t **reply, size_t *replyLength, int *replyStatus) {
+    rsa_hedged_call_t *call = calloc(1, sizeof(*call));
+    if (call == NULL) {
+        *replyStatus = CELIX_ENOMEM;
+        return;
+    }
+    celixThreadMutex_create(&call->mutex, NULL);
+    celixThreadCondition_init(&call->cond, NULL);
+    call->refCount = 1; //caller
+    call->replyStatus = CELIX_ENOMEM;
+
+    uint64_t deadline = rsaReplicaSet_nowInUs() + hedgeDelayInUs;
+    rsaReplicaSet_hedgedAttempt(call, replica, binary, request, requestLength);
+
+    celixThreadMutex_lock(&call->mutex);
+    while (!call->completed && call->pending > 0) {
+        uint64_t now = rsaReplicaSet_nowInUs();
+        if (now >= deadline) {
+            break;
+        }
+        uint64_t remaining = deadline - now;
+        celixThreadCondition_timedwaitRelative(&call->cond, &call->mutex, (long)(remaining / 1000000u), (long)(remaining % 1000000u) * 1000L);
+    }
+    bool hedge = !call->completed;
+    celixThreadMutex_unlock(&call->mutex);
+
+    if (hedge) {
+        rsa_replica_t *second = rsaReplicaSet_select(set, true, binary, replica);
+        if (second != NULL) {
+            rsaReplicaSet_hedgedAttempt(call, second, binary, request, requestLength);
+            rsaReplicaSet_releaseReplica(second);
+        }
+    }
+
+    celixThreadMutex_lock(&call->mutex);
+    while (!call->completed && call->pending > 0) {
+        celixThreadCondition_wait(&call->cond, &call->mutex);
+    }
+    *replyStatus = call->replyStatus;
+    *reply = call->reply;
+    *replyLength = call->replyLength;
+    call->reply = NULL;
+    celixThreadMutex_unlock(&call->mutex);
+
+    rsaReplicaSet_releaseHedgedCall(call);
+}
+
+static void rsaReplicaSet_call(rsa_replica_set_t *set, bool binary, const uint8_t *request, size_t requestLength, uint8_t **reply, size_t *replyLength, int *replyStatus) {
+    rsa_replica_t *replica = rsaReplicaSet_select(set, false, binary, NULL);
+    if (replica == NULL) {
+        *replyStatus = CELIX_ILLEGAL_STATE;
+        return;
+    }
+
+    uint64_t hedgeDelayInUs = 0;
+    if (set->hedging && rsaReplicaSet_supports(replica, true, binary)) {
+        hedgeDelayInUs = rsaReplicaSet_hedgeDelay(set, replica);
+    }
+
+    if (hedgeDelayInUs > 0) {
+        rsaReplicaSet_hedgedCall(set, replica, binary, request, requestLength, hedgeDelayInUs, reply, replyLength, replyStatus);
+    } else {
+        int rc = CELIX_ILLEGAL_STATE;
+        __atomic_add_fetch(&replica->outstanding, 1, __ATOMIC_RELAXED);
+        uint64_t start = rsaReplicaSet_nowInUs();
+        if (binary) {
+            replica->sendBinary(replica->handle, replica->endpoint, request, requestLength, reply, replyLength, &rc);
+        } else {
+            replica->send(replica->handle, replica->endpoint, (char *)request, (char **)reply, &rc);
+        }
+        rsaReplicaSet_callDone(replica, start, rc);
+        *replyStatus = rc;
+    }
+    rsaReplicaSet_releaseReplica(replica);
+}
+
+void rsaReplicaSet_send(void *handle, endpoint_description_t *endpoint, char *request, char **reply, int *replyStatus) {
+    size_t replyLength = 0;
+    rsaReplicaSet_call(handle, false, (const uint8_t *)request, strlen(request), (uint8_t **)reply, &replyLength, replyStatus);
+}
+
+void rsaReplicaSet_sendBinary(void *handle, endpoint_description_t *endpoint, const uint8_t *request, size_t requestLength, uint8_t **reply, size_t *replyLength, int *replyStatus) {
+    rsaReplicaSet_call(handle, true, request, requestLength, reply, replyLength, replyStatus);
+}
+
+celix_status_t rsaReplicaSet_sendAsync(void *handle, endpoint_description_t *endpoint, bool binary, uint8_t *request, size_t requestLength, send_async_complete_func_type complete, void *completeHandle) {
+    rsa_replica_t *replica = rsaReplicaSet_select(handle, true, binary, NULL);
+    if (replica == NULL) {
+        free(request);
+        return CELIX_ILLEGAL_STATE;
+    }
+    celix_status_t status = rsaReplicaSet_sendAttempt(replica, binary, request, requestLength, complete, completeHandle);
+    rsaReplicaSet_releaseReplica(replica);
+    return status;
+}
@@ -0,0 +1,77 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *  KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#ifndef CELIX_RSA_REPLICA_SET_H
+#define CELIX_RSA_REPLICA_SET_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "celix_errno.h"
+#include "endpoint_description.h"
+#include "import_registration_dfi.h"
+
+/**
+ * Set of equivalent endpoints (replicas) of a service, imported as one service. The set has the signature of the
+ * send functions of an import registration and spreads the calls over its replicas.
+ *
+ * The latency of the calls is tracked per replica and feeds the choice of the replica. A replica whose call failed
+ * is avoided for a while, as long as other replicas are available. With hedging, a sync call which got no reply
+ * within the p95 latency of its replica is also sent to a second replica and the first reply is used, so hedging is
+ * only usable for idempotent services.
+ */
+typedef struct rsa_replica_set rsa_replica_set_t;
+
+typedef enum rsa_balancing_mode {
+    RSA_BALANCING_ROUND_ROBIN,
+    RSA_BALANCING_LEAST_OUTSTANDING //the replica with the lowest (nr of outstanding calls + 1) * average latency
+} rsa_balancing_mode_e;
+
+/**
+ * Creates an empty replica set. minHedgeDelayInUs is the minimum delay before a call is hedged.
+ */
+rsa_replica_set_t* rsaReplicaSet_create(rsa_balancing_mode_e mode, bool hedging, unsigned int minHedgeDelayInUs);
+
+/**
+ * Destroys the set. Calls in flight keep the replica they were sent to alive until they are completed.
+ */
+void rsaReplicaSet_destroy(rsa_replica_set_t *set);
+
+/**
+ * Adds the endpoint as replica, identified by id. The endpoint is copied. The send functions are the functions for
+ * the transport of the endpoint, sendBinary and sendAsync can be NULL if not supported by the endpoint.
+ */
+celix_status_t rsaReplicaSet_addMember(rsa_replica_set_t *set, const void *id, const endpoint_description_t *endpoint,
+                                       send_func_type send, send_binary_func_type sendBinary,
+                                       send_async_func_type sendAsync, void *handle);
+
+/**
+ * Removes the replica identified by id. Returns the nr of remaining replicas.
+ */
+size_t rsaReplicaSet_removeMember(rsa_replica_set_t *set, const void *id);
+
+/**
+ * Send functions for the import registration of the set, handle is the set. The endpoint argument is ignored.
+ */
+void rsaReplicaSet_send(void *handle, endpoint_description_t *endpoint, char *request, char **reply, int *replyStatus);
+void rsaReplicaSet_sendBinary(void *handle, endpoint_description_t *endpoint, const uint8_t *request, size_t requestLength, uint8_t **reply, size_t *replyLength, int *replyStatus);
+celix_status_t rsaReplicaSet_sendAsync(void *handle, endpoint_description_t *endpoint, bool binary, uint8_t *request, size_t requestLength, send_async_complete_func_type complete, void *completeHandle);
+
+#endif //CELIX_RSA_REPLICA_SET_H
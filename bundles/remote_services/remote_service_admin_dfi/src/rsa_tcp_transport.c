@@ -0,0 +1,790 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *  KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <endian.h>
+#include <poll.h>
+#include <time.h>
+#include <unistd.h>
+#include <netdb.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <sys/un.h>
+
+#include "array_list.h"
+#include "celix_hash_map.h"
+#include "celix_threads.h"
+#include "celix_thread_pool.h"
+#include "rsa_tcp_transport.h"
+
+#define RSA_TCP_FLAG_BINARY             0x1u
+
+#define RSA_TCP_STATUS_OK               0u
+#define RSA_TCP_STATUS_FAILED           1u
+#define RSA_TCP_STATUS_NOT_FOUND        2u
+#define RSA_TCP_STATUS_UNAVAILABLE      3u
+
+#define RSA_TCP_MAX_FRAME_SIZE          (64u * 1024u * 1024u) //a larger frame is considered corrupt and closes the connection
+#define RSA_TCP_LISTEN_BACKLOG          64
+
+/**
+ * Header of a request or reply frame, all fields in network byte order.
+ */
+typedef struct rsa_tcp_frame_header {
+    uint32_t length; //nr of payload bytes following the header
+    uint32_t flags; //request: RSA_TCP_FLAG_*, reply: RSA_TCP_STATUS_*
+    uint64_t requestId;
+    uint64_t serviceId; //0 for a reply
+} rsa_tcp_frame_header_t;
+
+typedef struct rsa_tcp_server_connection {
+    rsa_tcp_server_t *server;
+    int fd;
+    unsigned int refCount; //atomic, the connection list of the server + the calls in progress
+    bool closed; //atomic, set when the receive thread is done
+    celix_thread_mutex_t writeLock;
+    celix_thread_t thread;
+} rsa_tcp_server_connection_t;
+
+typedef struct rsa_tcp_server_call {
+    rsa_tcp_server_connection_t *connection;
+    uint64_t requestId;
+    unsigned long serviceId;
+    bool binary;
+    size_t requestLength;
+    uint8_t request[]; //0 terminated
+} rsa_tcp_server_call_t;
+
+struct rsa_tcp_server {
+    log_helper_t *logHelper;
+    void *handle;
+    rsa_tcp_call_fp call;
+    int listenFd;
+    int wakeupPipe[2]; //wakes the accept thread on destroy
+    char *url;
+    char *unixSocketPath; //NULL for a tcp server
+    celix_thread_pool_t *pool;
+    celix_thread_t acceptThread;
+
+    celix_thread_mutex_t mutex; //protects connections
+    array_list_pt connections; //rsa_tcp_server_connection_t entries
+};
+
+typedef struct rsa_tcp_pending_call {
+    rsa_tcp_complete_fp complete; //NULL for a sync call
+    void *completeHandle;
+    bool done; //only used for a sync call
+    int status;
+    uint8_t *reply;
+    size_t replyLength;
+} rsa_tcp_pending_call_t;
+
+typedef struct rsa_tcp_client_connection {
+    int fd;
+    unsigned int refCount; //protected by the client mutex, the connection map of the client + the callers using it
+    bool broken; //atomic, set when the receive thread is done
+    bool closing; //atomic, set when the connection is closed by the client
+    celix_thread_t thread;
+    celix_thread_mutex_t writeLock; //serializes the writes of the request frames
+
+    celix_thread_mutex_t mutex; //protects below
+    celix_thread_cond_t cond; //broadcast when a sync call is done
+    uint64_t nextRequestId;
+    celix_long_hash_map_t *pending; //key = request id, value = rsa_tcp_pending_call_t*
+} rsa_tcp_client_connection_t;
+
+struct rsa_tcp_client {
+    log_helper_t *logHelper;
+    celix_thread_mutex_t mutex; //protects connections and the ref counts of the connections
+    celix_string_hash_map_t *connections; //key = url, value = rsa_tcp_client_connection_t*
+};
+
+static bool rsaTcp_read(int fd, void *buf, size_t size) {
+    char *ptr = buf;
+    while (size > 0) {
+        ssize_t n = recv(fd, ptr, size, 0);
+        if (n < 0 && errno == EINTR) {
+            continue;
+        } else if (n <= 0) {
+            return false;
+        }
+        ptr += n;
+        size -= (size_t) n;
+    }
+    return true;
+}
+
+static bool rsaTcp_readHeader(int fd, rsa_tcp_frame_header_t *header) {
+    if (!rsaTcp_read(fd, header, sizeof(*header))) {
+        return false;
+    }
+    header->length = ntohl(header->length);
+    header->flags = ntohl(header->flags);
+    header->requestId = be64toh(header->requestId);
+    header->serviceId = be64toh(header->serviceId);
+    return header->length <= RSA_TCP_MAX_FRAME_SIZE;
+}
+
+/**
+ * Writes the header and payload of a frame with a single sendmsg call (if the socket buffer has room).
+ * Note the caller serializes the writes on the fd.
+ */
+static bool rsaTcp_writeFrame(int fd, uint32_t flags, uint64_t requestId, unsigned long serviceId, const void *payload, size_t payloadLength) {
+    rsa_tcp_frame_header_t header;
+    header.length = htonl((uint32_t) payloadLength);
+    header.flags = htonl(flags);
+    header.requestId = htobe64(requestId);
+    header.serviceId = htobe64((uint64_t) serviceId);
+
+    struct iovec iov[2];
+    iov[0].iov_base = &header;
+    iov[0].iov_len = sizeof(header);
+    iov[1].iov_base = (void *) payload;
+    iov[1].iov_len = payloadLength;
+    struct msghdr msg;
+    memset(&msg, 0, sizeof(msg));
+    msg.msg_iov = iov;
+    msg.msg_iovlen = payloadLength > 0 ? 2 : 1;
+
+    while (msg.msg_iovlen > 0) {
+        ssize_t n = sendmsg(fd, &msg, MSG_NOSIGNAL);
+        if (n < 0 && errno == EINTR) {
+            continue;
+        } else if (n < 0) {
+            return false;
+        }
+        //skip the written (part of the) vectors
+        size_t written = (size_t) n;
+        while (msg.msg_iovlen > 0 && written >= msg.msg_iov->iov_len) {
+            written -= msg.msg_iov->iov_len;
+            msg.msg_iov += 1;
+            msg.msg_iovlen -= 1;
+        }
+        if (msg.msg_iovlen > 0) {
+            msg.msg_iov->iov_base = (char *) msg.msg_iov->iov_base + written;
+            msg.msg_iov->iov_len -= written;
+        }
+    }
+    return true;
+}
+
+static void rsaTcpServer_releaseConnection(rsa_tcp_server_connection_t *connection) {
+    if (__atomic_sub_fetch(&connection->refCount, 1, __ATOMIC_ACQ_REL) == 0) {
+        close(connection->fd);
+        celixThreadMutex_destroy(&connection->writeLock);
+        free(connection);
+    }
+}
+
+static void* rsaTcpServer_callJob(void *data) {
+    rsa_tcp_server_call_t *call = data;
+    rsa_tcp_server_connection_t *connection = call->connection;
+    rsa_tcp_server_t *server = connection->server;
+
+    uint8_t *reply = NULL;
+    size_t replyLength = 0;
+    celix_status_t status = server->call(server->handle, call->serviceId, call->binary, call->request, call->requestLength, &reply, &replyLength);
+    uint32_t replyStatus = RSA_TCP_STATUS_FAILED;
+    if (status == CELIX_SUCCESS && replyLength <= RSA_TCP_MAX_FRAME_SIZE) {
+        replyStatus = RSA_TCP_STATUS_OK;
+    } else if (status == ENOENT) {
+        replyStatus = RSA_TCP_STATUS_NOT_FOUND;
+    } else if (status == EBUSY) {
+        replyStatus = RSA_TCP_STATUS_UNAVAILABLE;
+    }
+
+    celixThreadMutex_lock(&connection->writeLock);
+    bool written = rsaTcp_writeFrame(connection->fd, replyStatus, call->requestId, 0, reply, replyStatus == RSA_TCP_STATUS_OK ? replyLength : 0);
+    celixThreadMutex_unlock(&connection->writeLock);
+    if (!written) {
+        shutdown(connection->fd, SHUT_RDWR); //ends the receive thread of the connection
+    }
+
+    free(reply);
+    free(call);
+    rsaTcpServer_releaseConnection(connection);
+    return NULL;
+}
+
+//
+// Reads the request frames of a connection and queues them on the thread pool, so the calls of a connection are
+// executed concurrently and their replies are written in completion order.
+//
+static void* rsaTcpServer_receiveLoop(void *data) {
+    rsa_tcp_server_connection_t *connection = data;
+    rsa_tcp_server_t *server = connection->server;
+
+    rsa_tcp_frame_header_t header;
+    while (rsaTcp_readHeader(connection->fd, &header)) {
+        rsa_tcp_server_call_t *call = malloc(sizeof(*call) + header.length + 1);
+        if (call == NULL || !rsaTcp_read(connection->fd, call->request, header.length)) {
+            free(call);
+            break;
+        }
+        call->connection = connection;
+        call->requestId = header.requestId;
+        call->serviceId = (unsigned long) header.serviceId;
+        call->binary = (header.flags & RSA_TCP_FLAG_BINARY) != 0;
+        call->requestLength = header.length;
+        call->request[header.length] = '\0';
+
+        __atomic_add_fetch(&connection->refCount, 1, __ATOMIC_RELAXED);
+        if (celix_threadPool_execute(server->pool, rsaTcpServer_callJob, call, NULL, NULL) != CELIX_SUCCESS) {
+            rsaTcpServer_releaseConnection(connection);
+            free(call);
+            break;
+        }
+    }
+
+    shutdown(connection->fd, SHUT_RDWR);
+    __atomic_store_n(&connection->closed, true, __ATOMIC_RELEASE);
+    return NULL;
+}
+
+/**
+ * Joins and releases the connections of which the receive thread is done.
+ */
+static void rsaTcpServer_reapConnections(rsa_tcp_server_t *server) {
+    celixThreadMutex_lock(&server->mutex);
+    for (int i = arrayList_size(server->connections) - 1; i >= 0; --i) {
+        rsa_tcp_server_connection_t *connection = arrayList_get(server->connections, i);
+        if (__atomic_load_n(&connection->closed, __ATOMIC_ACQUIRE)) {
+            arrayList_remove(server->connections, i);
+            celixThread_join(connection->thread, NULL);
+            rsaTcpServer_releaseConnection(connection);
+        }
+    }
+    celixThreadMutex_unlock(&server->mutex);
+}
+
+static void* rsaTcpServer_acceptLoop(void *data) {
+    rsa_tcp_server_t *server = data;
+    struct pollfd fds[2];
+    fds[0].fd = server->listenFd;
+    fds[0].events = POLLIN;
+    fds[1].fd = server->wakeupPipe[0];
+    fds[1].events = POLLIN;
+
+    while (true) {
+        fds[0].revents = 0;
+        fds[1].revents = 0;
+        if (poll(fds, 2, -1) < 0 && errno != EINTR) {
+            logHelper_log(server->logHelper, OSGI_LOGSERVICE_ERROR, "RSA: Socket transport poll error: %s", strerror(errno));
+            break;
+        }
+        if (fds[1].revents != 0) {
+            break; //destroy
+        }
+        if ((fds[0].revents & POLLIN) == 0) {
+            continue;
+        }
+
+        int fd = accept(server->listenFd, NULL, NULL);
+        if (fd < 0) {
+            continue;
+        }
+        if (server->unixSocketPath == NULL) {
+            int one = 1;
+            setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+        }
+
+        rsaTcpServer_reapConnections(server);
+
+        rsa_tcp_server_connection_t *connection = calloc(1, sizeof(*connection));
+        connection->server = server;
+        connection->fd = fd;
+        connection->refCount = 1;
+        celixThreadMutex_create(&connection->writeLock, NULL);
+        celixThreadMutex_lock(&server->mutex);
+        if (celixThread_create(&connection->thread, NULL, rsaTcpServer_receiveLoop, connection) == CELIX_SUCCESS) {
+            celixThread_setName(&connection->thread, "RSA TCP");
+            arrayList_add(server->connections, connection);
+        } else {
+            logHelper_log(server->logHelper, OSGI_LOGSERVICE_ERROR, "RSA: Cannot create a receive thread for a socket transport connection");
+            rsaTcpServer_releaseConnection(connection);
+        }
+        celixThreadMutex_unlock(&server->mutex);
+    }
+    return NULL;
+}
+
+static int rsaTcpServer_listen(rsa_tcp_server_t *server, const char *ip, long port, const char *unixSocketPath) {
+    char url[256];
+    int fd;
+    if (unixSocketPath != NULL) {
+        struct sockaddr_un addr;
+        memset(&addr, 0, sizeof(addr));
+        addr.sun_family = AF_UNIX;
+        if (strlen(unixSocketPath) >= sizeof(addr.sun_path)) {
+            logHelper_log(server->logHelper, OSGI_LOGSERVICE_ERROR, "RSA: Unix socket path %s is too long", unixSocketPath);
+            return -1;
+        }
+        strncpy(addr.sun_path, unixSocketPath, sizeof(addr.sun_path) - 1);
+        unlink(unixSocketPath); //stale socket of a previous run
+        fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+        if (fd >= 0 && (bind(fd, (struct sockaddr *) &addr, sizeof(addr)) != 0 || listen(fd, RSA_TCP_LISTEN_BACKLOG) != 0)) {
+            close(fd);
+            fd = -1;
+        }
+        server->unixSocketPath = strdup(unixSocketPath);
+        snprintf(url, sizeof(url), "unix://%s", unixSocketPath);
+    } else {
+        struct sockaddr_in addr;
+        memset(&addr, 0, sizeof(addr));
+        addr.sin_family = AF_INET;
+        addr.sin_addr.s_addr = htonl(INADDR_ANY); //like the HTTP server, ip is the address used for the announcement
+        addr.sin_port = htons((uint16_t) port);
+        fd = socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+        int one = 1;
+        if (fd >= 0 && (setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one)) != 0 ||
+                        bind(fd, (struct sockaddr *) &addr, sizeof(addr)) != 0 ||
+                        listen(fd, RSA_TCP_LISTEN_BACKLOG) != 0)) {
+            close(fd);
+            fd = -1;
+        }
+        //port 0 binds an ephemeral port
+        socklen_t len = sizeof(addr);
+        if (fd >= 0 && getsockname(fd, (struct sockaddr *) &addr, &len) == 0) {
+            port = ntohs(addr.sin_port);
+        }
+        snprintf(url, sizeof(url), "tcp://%s:%li", ip, port);
+    }
+    if (fd < 0) {
+        logHelper_log(server->logHelper, OSGI_LOGSERVICE_ERROR, "RSA: Cannot listen on %s: %s", url, strerror(errno));
+    } else {
+        server->url = strdup(url);
+    }
+    return fd;
+}
+
+rsa_tcp_server_t* rsaTcpServer_create(log_helper_t *logHelper, const char *ip, long port, const char *unixSocketPath, size_t nrOfThreads, void *handle, rsa_tcp_call_fp call) {
+    rsa_tcp_server_t *server = calloc(1, sizeof(*server));
+    server->logHelper = logHelper;
+    server->handle = handle;
+    server->call = call;
+    server->listenFd = rsaTcpServer_listen(server, ip, port, unixSocketPath);
+    if (server->listenFd < 0 || pipe(server->wakeupPipe) != 0) {
+        if (server->listenFd >= 0) {
+            close(server->listenFd);
+        }
+        free(server->unixSocketPath);
+        free(server->url);
+        free(server);
+        return NULL;
+    }
+
+    celix_thread_pool_options_t opts = CELIX_EMPTY_THREAD_POOL_OPTIONS;
+    opts.nrOfThreads = nrOfThreads;
+    opts.name = "RSA TCP";
+    server->pool = celix_threadPool_create(&opts);
+    celixThreadMutex_create(&server->mutex, NULL);
+    arrayList_create(&server->connections);
+    if (server->pool == NULL || celixThread_create(&server->acceptThread, NULL, rsaTcpServer_acceptLoop, server) != CELIX_SUCCESS) {
+        logHelper_log(logHelper, OSGI_LOGSERVICE_ERROR, "RSA: Cannot create the socket transport threads");
+        if (server->pool != NULL) {
+            celix_threadPool_destroy(server->pool);
+        }
+        arrayList_destroy(server->connections);
+        celixThreadMutex_destroy(&server->mutex);
+        close(server->wakeupPipe[0]);
+        close(server->wakeupPipe[1]);
+        close(server->listenFd);
+        free(server->unixSocketPath);
+        free(server->url);
+        free(server);
+        return NULL;
+    }
+    celixThread_setName(&server->acceptThread, "RSA TCP accept");
+    return server;
+}
+
+void rsaTcpServer_destroy(rsa_tcp_server_t *server) {
+    if (server == NULL) {
+        return;
+    }
+
+    char wakeup = 1;
+    if (write(server->wakeupPipe[1], &wakeup, 1) != 1) {
+        logHelper_log(server->logHelper, OSGI_LOGSERVICE_WARNING, "RSA: Cannot wake the socket transport accept thread");
+    }
+    celixThread_join(server->acceptThread, NULL);
+    close(server->listenFd);
+    close(server->wakeupPipe[0]);
+    close(server->wakeupPipe[1]);
+    if (server->unixSocketPath != NULL) {
+        unlink(server->unixSocketPath);
+    }
+
+    //ends the receive threads, the queued calls are still executed but their replies cannot be written anymore
+    celixThreadMutex_lock(&server->mutex);
+    for (int i = 0; i < arrayList_size(server->connections); ++i) {
+        rsa_tcp_server_connection_t *connection = arrayList_get(server->connections, i);
+        shutdown(connection->fd, SHUT_RDWR);
+    }
+    for (int i = 0; i < arrayList_size(server->connections); ++i) {
+        rsa_tcp_server_connection_t *connection = arrayList_get(server->connections, i);
+        celixThread_join(connection->thread, NULL);
+    }
+    celixThreadMutex_unlock(&server->mutex);
+    celix_threadPool_destroy(server->pool);
+    for (int i = 0; i < arrayList_size(server->connections); ++i) {
+        rsaTcpServer_releaseConnection(arrayList_get(server->connections, i));
+    }
+
+    arrayList_destroy(server->connections);
+    celixThreadMutex_destroy(&server->mutex);
+    free(server->unixSocketPath);
+    free(server->url);
+    free(server);
+}
+
+const char* rsaTcpServer_getUrl(const rsa_tcp_server_t *server) {
+    return server->url;
+}
+
+static int rsaTcpClient_connect(const char *url) {
+    int fd = -1;
+    if (strncmp(url, "unix://", strlen("unix://")) == 0) {
+        const char *path = url + strlen("unix://");
+        struct sockaddr_un addr;
+        memset(&addr, 0, sizeof(addr));
+        addr.sun_family = AF_UNIX;
+        if (strlen(path) >= sizeof(addr.sun_path)) {
+            return -1;
+        }
+        strncpy(addr.sun_path, path, sizeof(addr.sun_path) - 1);
+        fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+        if (fd >= 0 && connect(fd, (struct sockaddr *) &addr, sizeof(addr)) != 0) {
+            close(fd);
+            fd = -1;
+        }
+    } else if (strncmp(url, "tcp://", strlen("tcp://")) == 0) {
+        const char *host = url + strlen("tcp://");
+        const char *port = strrchr(host, ':');
+        if (port == NULL) {
+            return -1;
+        }
+        char hostname[256];
+        snprintf(hostname, sizeof(hostname), "%.*s", (int) (port - host), host);
+
+        struct addrinfo hints;
+        memset(&hints, 0, sizeof(hints));
+        hints.ai_family = AF_UNSPEC;
+        hints.ai_socktype = SOCK_STREAM;
+        struct addrinfo *result = NULL;
+        if (getaddrinfo(hostname, port + 1, &hints, &result) != 0) {
+            return -1;
+        }
+        for (struct addrinfo *addr = result; addr != NULL && fd < 0; addr = addr->ai_next) {
+            fd = socket(addr->ai_family, addr->ai_socktype | SOCK_CLOEXEC, addr->ai_protocol);
+            if (fd >= 0 && connect(fd, addr->ai_addr, addr->ai_addrlen) != 0) {
+                close(fd);
+                fd = -1;
+            }
+        }
+        freeaddrinfo(result);
+        if (fd >= 0) {
+            int one = 1;
+            setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+        }
+    }
+    return fd;
+}
+
+/**
+ * Completes the pending call with the request id, if it is still pending (i.e. a sync call did not time out).
+ */
+static void rsaTcpClient_complete(rsa_tcp_client_connection_t *connection, uint64_t requestId, int status, uint8_t *reply, size_t replyLength) {
+    celixThreadMutex_lock(&connection->mutex);
+    rsa_tcp_pending_call_t *call = celix_longHashMap_remove(connection->pending, (long) requestId);
+    if (call != NULL && call->complete == NULL) {
+        call->done = true;
+        call->status = status;
+        call->reply = reply;
+        call->replyLength = replyLength;
+        celixThreadCondition_broadcast(&connection->cond);
+        call = NULL;
+        reply = NULL;
+    }
+    celixThreadMutex_unlock(&connection->mutex);
+
+    if (call != NULL) {
+        call->complete(call->completeHandle, status, reply, replyLength);
+        free(call);
+    } else {
+        free(reply);
+    }
+}
+
+static void* rsaTcpClient_receiveLoop(void *data) {
+    rsa_tcp_client_connection_t *connection = data;
+
+    rsa_tcp_frame_header_t header;
+    while (rsaTcp_readHeader(connection->fd, &header)) {
+        uint8_t *reply = malloc(header.length + 1);
+        if (reply == NULL || !rsaTcp_read(connection->fd, reply, header.length)) {
+            free(reply);
+            break;
+        }
+        reply[header.length] = '\0';
+        //like a failed HTTP call, a call which failed on the remote side has an empty reply
+        rsaTcpClient_complete(connection, header.requestId, 0, reply, header.flags == RSA_TCP_STATUS_OK ? header.length : 0);
+    }
+
+    //connection lost or closed, fail the pending calls. New calls are refused from here on
+    int status = __atomic_load_n(&connection->closing, __ATOMIC_ACQUIRE) ? ECONNABORTED : ECONNRESET;
+    shutdown(connection->fd, SHUT_RDWR);
+    celixThreadMutex_lock(&connection->mutex);
+    __atomic_store_n(&connection->broken, true, __ATOMIC_RELEASE);
+    celixThreadMutex_unlock(&connection->mutex);
+    while (true) {
+        celixThreadMutex_lock(&connection->mutex);
+        celix_long_hash_map_iterator_t iter = celix_longHashMap_begin(connection->pending);
+        bool empty = celix_longHashMapIterator_isEnd(&iter);
+        long requestId = iter.key;
+        celixThreadMutex_unlock(&connection->mutex);
+        if (empty) {
+            break;
+        }
+        rsaTcpClient_complete(connection, (uint64_t) requestId, status, NULL, 0);
+    }
+    return NULL;
+}
+
+static rsa_tcp_client_connection_t* rsaTcpClient_createConnection(rsa_tcp_client_t *client, const char *url) {
+    int fd = rsaTcpClient_connect(url);
+    if (fd < 0) {
+        logHelper_log(client->logHelper, OSGI_LOGSERVICE_WARNING, "RSA: Cannot connect to %s", url);
+        return NULL;
+    }
+
+    rsa_tcp_client_connection_t *connection = calloc(1, sizeof(*connection));
+    connection->fd = fd;
+    connection->refCount = 1;
+    connection->nextRequestId = 1;
+    connection->pending = celix_longHashMap_create();
+    celixThreadMutex_create(&connection->writeLock, NULL);
+    celixThreadMutex_create(&connection->mutex, NULL);
+    celixThreadCondition_init(&connection->cond, NULL);
+    if (celixThread_create(&connection->thread, NULL, rsaTcpClient_receiveLoop, connection) != CELIX_SUCCESS) {
+        logHelper_log(client->logHelper, OSGI_LOGSERVICE_ERROR, "RSA: Cannot create a receive thread for %s", url);
+        close(fd);
+        celix_longHashMap_destroy(connection->pending);
+        celixThreadMutex_destroy(&connection->writeLock);
+        celixThreadMutex_destroy(&connection->mutex);
+        celixThreadCondition_destroy(&connection->cond);
+        free(connection);
+        return NULL;
+    }
+    celixThread_setName(&connection->thread, "RSA TCP");
+    return connection;
+}
+
+static void rsaTcpClient_destroyConnection(rsa_tcp_client_connection_t *connection) {
+    __atomic_store_n(&connection->closing, true, __ATOMIC_RELEASE);
+    shutdown(connection->fd, SHUT_RDWR);
+    celixThread_join(connection->thread, NULL);
+    close(connection->fd);
+    celix_longHashMap_destroy(connection->pending);
+    celixThreadMutex_destroy(&connection->writeLock);
+    celixThreadMutex_destroy(&connection->mutex);
+    celixThreadCondition_destroy(&connection->cond);
+    free(connection);
+}
+
+/**
+ * Returns the connection for the url with an extra reference, (re)connecting if there is no usable connection.
+ */
+static rsa_tcp_client_connection_t* rsaTcpClient_takeConnection(rsa_tcp_client_t *client, const char *url) {
+    rsa_tcp_client_connection_t *stale = NULL;
+    celixThreadMutex_lock(&client->mutex);
+    rsa_tcp_client_connection_t *connection = celix_stringHashMap_get(client->connections, url);
+    if (connection != NULL && __atomic_load_n(&connection->broken, __ATOMIC_ACQUIRE)) {
+        celix_stringHashMap_remove(client->connections, url);
+        stale = --connection->refCount == 0 ? connection : NULL;
+        connection = NULL;
+    }
+    if (connection == NULL) {
+        connection = rsaTcpClient_createConnection(client, url);
+        if (connection != NULL) {
+            celix_stringHashMap_put(client->connections, url, connection);
+        }
+    }
+    if (connection != NULL) {
+        connection->refCount += 1;
+    }
+    celixThreadMutex_unlock(&client->mutex);
+
+    if (stale != NULL) {
+        rsaTcpClient_destroyConnection(stale);
+    }
+    return connection;
+}
+
+static void rsaTcpClient_releaseConnection(rsa_tcp_client_t *client, rsa_tcp_client_connection_t *connection) {
+    celixThreadMutex_lock(&client->mutex);
+    bool last = --connection->refCount == 0;
+    celixThreadMutex_unlock(&client->mutex);
+    if (last) {
+        rsaTcpClient_destroyConnection(connection);
+    }
+}
+
+/**
+ * Registers the pending call and writes the request frame.
+ * If the write fails the connection is shut down, which fails the pending calls from the receive thread.
+ */
+static bool rsaTcpClient_send(rsa_tcp_client_connection_t *connection, rsa_tcp_pending_call_t *call, unsigned long serviceId, bool binary, const uint8_t *request, size_t requestLength, uint64_t *requestId) {
+    celixThreadMutex_lock(&connection->mutex);
+    bool broken = __atomic_load_n(&connection->broken, __ATOMIC_ACQUIRE);
+    *requestId = connection->nextRequestId++;
+    if (!broken) {
+        celix_longHashMap_put(connection->pending, (long) *requestId, call);
+    }
+    celixThreadMutex_unlock(&connection->mutex);
+    if (broken) {
+        return false;
+    }
+
+    celixThreadMutex_lock(&connection->writeLock);
+    bool written = rsaTcp_writeFrame(connection->fd, binary ? RSA_TCP_FLAG_BINARY : 0, *requestId, serviceId, request, requestLength);
+    celixThreadMutex_unlock(&connection->writeLock);
+    if (!written) {
+        shutdown(connection->fd, SHUT_RDWR);
+    }
+    return true;
+}
+
+rsa_tcp_client_t* rsaTcpClient_create(log_helper_t *logHelper) {
+    rsa_tcp_client_t *client = calloc(1, sizeof(*client));
+    client->logHelper = logHelper;
+    celixThreadMutex_create(&client->mutex, NULL);
+    client->connections = celix_stringHashMap_create();
+    return client;
+}
+
+void rsaTcpClient_destroy(rsa_tcp_client_t *client) {
+    if (client == NULL) {
+        return;
+    }
+    array_list_pt connections = NULL;
+    arrayList_create(&connections);
+    celixThreadMutex_lock(&client->mutex);
+    celix_string_hash_map_iterator_t iter = celix_stringHashMap_begin(client->connections);
+    for (; !celix_stringHashMapIterator_isEnd(&iter); celix_stringHashMapIterator_next(&iter)) {
+        rsa_tcp_client_connection_t *connection = iter.value;
+        //wakes the callers waiting for a reply, the connection is destroyed by the last caller
+        __atomic_store_n(&connection->closing, true, __ATOMIC_RELEASE);
+        shutdown(connection->fd, SHUT_RDWR);
+        if (--connection->refCount == 0) {
+            arrayList_add(connections, connection);
+        }
+    }
+    celix_stringHashMap_clear(client->connections);
+    celixThreadMutex_unlock(&client->mutex);
+
+    for (int i = 0; i < arrayList_size(connections); ++i) {
+        rsaTcpClient_destroyConnection(arrayList_get(connections, i));
+    }
+    arrayList_destroy(connections);
+    celix_stringHashMap_destroy(client->connections);
+    celixThreadMutex_destroy(&client->mutex);
+    free(client);
+}
+
+celix_status_t rsaTcpClient_call(rsa_tcp_client_t *client, const char *url, unsigned long serviceId, bool binary, const uint8_t *request, size_t requestLength, int timeoutInSec, uint8_t **reply, size_t *replyLength, int *replyStatus) {
+    if (url == NULL || requestLength > RSA_TCP_MAX_FRAME_SIZE) {
+        *replyStatus = EINVAL;
+        return CELIX_ILLEGAL_ARGUMENT;
+    }
+    rsa_tcp_client_connection_t *connection = rsaTcpClient_takeConnection(client, url);
+    if (connection == NULL) {
+        *replyStatus = ECONNREFUSED;
+        return CELIX_ILLEGAL_STATE;
+    }
+
+    rsa_tcp_pending_call_t call;
+    memset(&call, 0, sizeof(call));
+    uint64_t requestId = 0;
+    if (!rsaTcpClient_send(connection, &call, serviceId, binary, request, requestLength, &requestId)) {
+        rsaTcpClient_releaseConnection(client, connection);
+        *replyStatus = ECONNRESET;
+        return CELIX_ILLEGAL_STATE;
+    }
+
+    struct timespec start;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    celixThreadMutex_lock(&connection->mutex);
+    while (!call.done) {
+        if (timeoutInSec <= 0) {
+            celixThreadCondition_wait(&connection->cond, &connection->mutex);
+            continue;
+        }
+        struct timespec now;
+        clock_gettime(CLOCK_MONOTONIC, &now);
+        long long remainingNs = (long long) timeoutInSec * 1000000000LL - ((long long) (now.tv_sec - start.tv_sec) * 1000000000LL + (now.tv_nsec - start.tv_nsec));
+        if (remainingNs <= 0) {
+            //timed out, a late reply is dropped
+            celix_longHashMap_remove(connection->pending, (long) requestId);
+            break;
+        }
+        celixThreadCondition_timedwaitRelative(&connection->cond, &connection->mutex, (long) (remainingNs / 1000000000LL), (long) (remainingNs % 1000000000LL));
+    }
+    celixThreadMutex_unlock(&connection->mutex);
+    rsaTcpClient_releaseConnection(client, connection);
+
+    if (!call.done) {
+        *replyStatus = ETIMEDOUT;
+        return CELIX_ILLEGAL_STATE;
+    }
+    *replyStatus = call.status;
+    *reply = call.reply;
+    *replyLength = call.replyLength;
+    return call.status == 0 ? CELIX_SUCCESS : CELIX_ILLEGAL_STATE;
+}
+
+celix_status_t rsaTcpClient_callAsync(rsa_tcp_client_t *client, const char *url, unsigned long serviceId, bool binary, uint8_t *request, size_t requestLength, rsa_tcp_complete_fp complete, void *completeHandle) {
+    rsa_tcp_client_connection_t *connection = url != NULL && requestLength <= RSA_TCP_MAX_FRAME_SIZE ? rsaTcpClient_takeConnection(client, url) : NULL;
+    rsa_tcp_pending_call_t *call = calloc(1, sizeof(*call));
+    celix_status_t status = CELIX_SUCCESS;
+    uint64_t requestId = 0;
+    if (connection == NULL || call == NULL) {
+        status = CELIX_ILLEGAL_STATE;
+    } else {
+        call->complete = complete;
+        call->completeHandle = completeHandle;
+        if (!rsaTcpClient_send(connection, call, serviceId, binary, request, requestLength, &requestId)) {
+            status = CELIX_ILLEGAL_STATE;
+        } else {
+            call = NULL; //owned by the connection, freed when completed
+        }
+    }
+    if (connection != NULL) {
+        rsaTcpClient_releaseConnection(client, connection);
+    }
+    free(call);
+    free(request);
+    return status;
+}
@@ -0,0 +1,93 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *  KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#ifndef CELIX_RSA_TCP_TRANSPORT_H
+#define CELIX_RSA_TCP_TRANSPORT_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "celix_errno.h"
+#include "log_helper.h"
+
+/**
+ * Binary transport for remote calls over persistent TCP or Unix domain socket connections, the alternative to HTTP
+ * for endpoints with the RSA_DFI_TCP_CONFIGURATION_TYPE config.
+ *
+ * Every request and reply is a length prefixed frame with a small fixed size header followed by the json or avrobin
+ * encoded call. A reply carries the request id of its request, so many (sync and async) calls share a single
+ * connection and replies can arrive out of order.
+ */
+typedef struct rsa_tcp_server rsa_tcp_server_t;
+typedef struct rsa_tcp_client rsa_tcp_client_t;
+
+/**
+ * Called for every received request on a worker thread of the server. On success the reply is owned by the server.
+ * ENOENT (unknown service) and EBUSY (overloaded service) are reported to the caller, other errors as a failed call.
+ */
+typedef celix_status_t (*rsa_tcp_call_fp)(void *handle, unsigned long serviceId, bool binary, const uint8_t *request, size_t requestLength, uint8_t **reply, size_t *replyLength);
+
+/**
+ * Called once when an async call is completed, with the (0 terminated) reply owned by the callee.
+ * status is 0 if a reply is received, an empty reply if the call failed on the remote side. Otherwise it is an errno
+ * value, e.g. ECONNRESET if the connection is lost.
+ */
+typedef void (*rsa_tcp_complete_fp)(void *completeHandle, int status, uint8_t *reply, size_t replyLength);
+
+/**
+ * Creates a server listening on ip:port or, if unixSocketPath is not NULL, on the Unix domain socket unixSocketPath.
+ * The requests are handled by a thread pool of nrOfThreads threads.
+ * Returns NULL if the socket cannot be created.
+ */
+rsa_tcp_server_t* rsaTcpServer_create(log_helper_t *logHelper, const char *ip, long port, const char *unixSocketPath, size_t nrOfThreads, void *handle, rsa_tcp_call_fp call);
+
+/**
+ * Closes the listen socket and all connections, waits for the calls in progress.
+ */
+void rsaTcpServer_destroy(rsa_tcp_server_t *server);
+
+/**
+ * Returns the url of the server: "tcp://ip:port" or "unix://path".
+ */
+const char* rsaTcpServer_getUrl(const rsa_tcp_server_t *server);
+
+rsa_tcp_client_t* rsaTcpClient_create(log_helper_t *logHelper);
+
+/**
+ * Closes all connections, calls in flight are completed with ECONNABORTED.
+ */
+void rsaTcpClient_destroy(rsa_tcp_client_t *client);
+
+/**
+ * Sends a call for the service with serviceId to the server at url and waits for the reply, at most timeoutInSec
+ * seconds if > 0. The connection to a server is created on first use, shared by all calls and recreated by the next
+ * call if it is lost.
+ * On success the (0 terminated) reply is owned by the caller and replyStatus is set as described for
+ * rsa_tcp_complete_fp.
+ */
+celix_status_t rsaTcpClient_call(rsa_tcp_client_t *client, const char *url, unsigned long serviceId, bool binary, const uint8_t *request, size_t requestLength, int timeoutInSec, uint8_t **reply, size_t *replyLength, int *replyStatus);
+
+/**
+ * Sends a call without waiting for the reply, complete is called from the receive thread of the connection.
+ * The request is owned by the client, also on error. On error complete is not called.
+ */
+celix_status_t rsaTcpClient_callAsync(rsa_tcp_client_t *client, const char *url, unsigned long serviceId, bool binary, uint8_t *request, size_t requestLength, rsa_tcp_complete_fp complete, void *completeHandle);
+
+#endif //CELIX_RSA_TCP_TRANSPORT_H
@@ -0,0 +1,159 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *  KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <CppUTest/TestHarness.h>
+#include <cstring>
+#include <string>
+#include <arpa/inet.h>
+
+#include "celix_constants.h"
+#include "remote_constants.h"
+
+extern "C" {
+#include "celix_properties.h"
+#include "endpoint_description.h"
+#include "endpoint_descriptor_binary.h"
+}
+
+namespace {
+    endpoint_description_t* createEndpoint(const char *id, const char *service, long serviceId) {
+        celix_properties_t *props = celix_properties_create();
+        celix_properties_set(props, OSGI_RSA_ENDPOINT_FRAMEWORK_UUID, "fw-uuid");
+        celix_properties_set(props, OSGI_RSA_ENDPOINT_ID, id);
+        celix_properties_set(props, OSGI_FRAMEWORK_OBJECTCLASS, service);
+        celix_properties_setLong(props, OSGI_RSA_ENDPOINT_SERVICE_ID, serviceId);
+        celix_properties_set(props, "custom.key", "value with spaces and \xc3\xa9");
+        endpoint_description_t *endpoint = nullptr;
+        CHECK_EQUAL(CELIX_SUCCESS, endpointDescription_create(props, &endpoint));
+        return endpoint;
+    }
+
+    void destroyEndpoints(array_list_pt endpoints) {
+        for (int i = 0; i < arrayList_size(endpoints); i++) {
+            endpointDescription_destroy((endpoint_description_t *) arrayList_get(endpoints, i));
+        }
+        arrayList_destroy(endpoints);
+    }
+
+    std::string appendU32(std::string doc, uint32_t value) {
+        uint32_t netValue = htonl(value);
+        doc.append(reinterpret_cast<const char *>(&netValue), sizeof(netValue));
+        return doc;
+    }
+
+    std::string appendString(std::string doc, const std::string &str) {
+        return appendU32(std::move(doc), (uint32_t) str.size()) + str;
+    }
+}
+
+TEST_GROUP(EndpointDescriptorBinaryTests) {
+    array_list_pt written = nullptr;
+    array_list_pt read = nullptr;
+
+    void setup() {
+        arrayList_create(&written);
+        arrayList_create(&read);
+    }
+
+    void teardown() {
+        destroyEndpoints(written);
+        destroyEndpoints(read);
+    }
+};
+
+TEST(EndpointDescriptorBinaryTests, writeAndRead) {
+    arrayList_add(written, createEndpoint("ep1", "calculator", 1));
+    arrayList_add(written, createEndpoint("ep2", "tst_service", 2));
+
+    char *doc = nullptr;
+    size_t length = 0;
+    CHECK_EQUAL(CELIX_SUCCESS, endpointDescriptorBinary_write(written, &doc, &length));
+    CHECK(length > 4);
+    CHECK_EQUAL(0, memcmp(doc, "CEP1", 4));
+
+    CHECK_EQUAL(CELIX_SUCCESS, endpointDescriptorBinary_read(doc, length, read));
+    CHECK_EQUAL(2, arrayList_size(read));
+    for (int i = 0; i < 2; i++) {
+        auto *expected = (endpoint_description_t *) arrayList_get(written, i);
+        auto *actual = (endpoint_description_t *) arrayList_get(read, i);
+        STRCMP_EQUAL(expected->id, actual->id);
+        STRCMP_EQUAL(expected->service, actual->service);
+        STRCMP_EQUAL(expected->frameworkUUID, actual->frameworkUUID);
+        CHECK_EQUAL(expected->serviceId, actual->serviceId);
+        CHECK_EQUAL(celix_properties_size(expected->properties), celix_properties_size(actual->properties));
+        STRCMP_EQUAL(celix_properties_get(expected->properties, "custom.key", nullptr),
+                     celix_properties_get(actual->properties, "custom.key", nullptr));
+    }
+    free(doc);
+}
+
+TEST(EndpointDescriptorBinaryTests, emptyList) {
+    char *doc = nullptr;
+    size_t length = 0;
+    CHECK_EQUAL(CELIX_SUCCESS, endpointDescriptorBinary_write(written, &doc, &length));
+    CHECK_EQUAL(8u, length);
+    CHECK_EQUAL(CELIX_SUCCESS, endpointDescriptorBinary_read(doc, length, read));
+    CHECK_EQUAL(0, arrayList_size(read));
+    free(doc);
+}
+
+TEST(EndpointDescriptorBinaryTests, incompleteEndpointSkipped) {
+    //no objectClass, followed by a complete endpoint
+    std::string doc = appendU32("CEP1", 2);
+    doc = appendU32(doc, 1);
+    doc = appendString(doc, OSGI_RSA_ENDPOINT_ID);
+    doc = appendString(doc, "ep1");
+    doc = appendU32(doc, 3);
+    doc = appendString(doc, OSGI_RSA_ENDPOINT_FRAMEWORK_UUID);
+    doc = appendString(doc, "fw-uuid");
+    doc = appendString(doc, OSGI_RSA_ENDPOINT_ID);
+    doc = appendString(doc, "ep2");
+    doc = appendString(doc, OSGI_FRAMEWORK_OBJECTCLASS);
+    doc = appendString(doc, "calculator");
+
+    CHECK_EQUAL(CELIX_SUCCESS, endpointDescriptorBinary_read(doc.data(), doc.size(), read));
+    CHECK_EQUAL(1, arrayList_size(read));
+    STRCMP_EQUAL("ep2", ((endpoint_description_t *) arrayList_get(read, 0))->id);
+}
+
+TEST(EndpointDescriptorBinaryTests, malformedDocumentsRejected) {
+    arrayList_add(written, createEndpoint("ep1", "calculator", 1));
+    char *doc = nullptr;
+    size_t length = 0;
+    CHECK_EQUAL(CELIX_SUCCESS, endpointDescriptorBinary_write(written, &doc, &length));
+
+    //wrong magic
+    std::string wrongMagic{doc, length};
+    wrongMagic[3] = '2';
+    CHECK_EQUAL(CELIX_ILLEGAL_ARGUMENT, endpointDescriptorBinary_read(wrongMagic.data(), wrongMagic.size(), read));
+    CHECK_EQUAL(CELIX_ILLEGAL_ARGUMENT, endpointDescriptorBinary_read(doc, 2, read));
+
+    //every truncation is rejected without reading past the end
+    for (size_t truncated = 4; truncated < length; truncated++) {
+        std::string copy{doc, truncated};
+        CHECK_EQUAL(CELIX_ILLEGAL_ARGUMENT, endpointDescriptorBinary_read(copy.data(), copy.size(), read));
+    }
+    CHECK_EQUAL(0, arrayList_size(read));
+
+    //a string length beyond the document
+    std::string tooLong = appendU32(appendU32(appendU32("CEP1", 1), 1), 1000) + "key";
+    CHECK_EQUAL(CELIX_ILLEGAL_ARGUMENT, endpointDescriptorBinary_read(tooLong.data(), tooLong.size(), read));
+    CHECK_EQUAL(0, arrayList_size(read));
+    free(doc);
+}
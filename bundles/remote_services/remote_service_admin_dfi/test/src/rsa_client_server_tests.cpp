@@ -32,8 +32,11 @@ extern "C" {
 #include <string.h>
 #include <ctype.h>
 #include <unistd.h>
+#include <curl/curl.h>
 
 #include "celix_launcher.h"
+#include "celix_bundle.h"
+#include "celix_bundle_context.h"
 #include "framework.h"
 #include "remote_service_admin.h"
 #include "calculator_service.h"
@@ -44,12 +47,12 @@ extern "C" {
     static celix_framework_t *clientFramework = NULL;
     static celix_bundle_context_t *clientContext = NULL;
 
-    static void setupFm(void) {
+    static void setupFm(const char *serverConfig, const char *clientConfig) {
         int rc = 0;
         celix_bundle_t *bundle = NULL;
 
         //server
-        rc = celixLauncher_launch("server.properties", &serverFramework);
+        rc = celixLauncher_launch(serverConfig, &serverFramework);
         CHECK_EQUAL(CELIX_SUCCESS, rc);
 
         bundle = NULL;
@@ -61,7 +64,7 @@ extern "C" {
 
 
         //client
-        rc = celixLauncher_launch("client.properties", &clientFramework);
+        rc = celixLauncher_launch(clientConfig, &clientFramework);
         CHECK_EQUAL(CELIX_SUCCESS, rc);
 
         bundle = NULL;
@@ -110,17 +113,296 @@ extern "C" {
         rc = tst->test(tst->handle);
         CHECK_EQUAL(CELIX_SUCCESS, rc);
 
+        rc = tst->testAsync(tst->handle);
+        CHECK_EQUAL(CELIX_SUCCESS, rc);
+
+        rc = tst->testConcurrent(tst->handle);
+        CHECK_EQUAL(CELIX_SUCCESS, rc);
+
         bool result;
         bundleContext_ungetService(clientContext, ref, &result);
         bundleContext_ungetServiceReference(clientContext, ref);
     }
 
+    typedef struct bundle_context_lookup {
+        const char *symbolicName;
+        celix_bundle_context_t *ctx;
+    } bundle_context_lookup_t;
+
+    static void findBundleContext(void *handle, const celix_bundle_t *bnd) {
+        bundle_context_lookup_t *lookup = (bundle_context_lookup_t *) handle;
+        if (strcmp(lookup->symbolicName, celix_bundle_getSymbolicName(bnd)) == 0) {
+            bundle_getContext((celix_bundle_t *) bnd, &lookup->ctx);
+        }
+    }
+
+    static service_reference_pt waitForCalculatorReference(celix_bundle_context_t *ctx) {
+        service_reference_pt ref = NULL;
+        int retries = 4;
+        while (ref == NULL && retries > 0) {
+            bundleContext_getServiceReference(ctx, (char *) CALCULATOR_SERVICE, &ref);
+            if (ref == NULL) {
+                usleep(1000000);
+            }
+            --retries;
+        }
+        return ref;
+    }
+
+    static void testSharedImportProxy(void) {
+        //both bundles have the same calculator descriptor, so they use the same proxy
+        bundle_context_lookup_t shell = {"apache_celix_remoting_calculator_shell", NULL};
+        bundle_context_lookup_t tst = {"rsa_dfi_tst_bundle", NULL};
+        celix_bundleContext_useBundles(clientContext, &shell, findBundleContext);
+        celix_bundleContext_useBundles(clientContext, &tst, findBundleContext);
+        CHECK(shell.ctx != NULL);
+        CHECK(tst.ctx != NULL);
+
+        service_reference_pt shellRef = waitForCalculatorReference(shell.ctx);
+        service_reference_pt tstRef = waitForCalculatorReference(tst.ctx);
+        CHECK(shellRef != NULL);
+        CHECK(tstRef != NULL);
+
+        calculator_service_t *shellCalc = NULL;
+        calculator_service_t *tstCalc = NULL;
+        CHECK_EQUAL(CELIX_SUCCESS, bundleContext_getService(shell.ctx, shellRef, (void **) &shellCalc));
+        CHECK_EQUAL(CELIX_SUCCESS, bundleContext_getService(tst.ctx, tstRef, (void **) &tstCalc));
+        CHECK(shellCalc != NULL);
+        POINTERS_EQUAL(shellCalc, tstCalc);
+
+        //releasing the proxy in one bundle keeps it usable for the other
+        bool result;
+        bundleContext_ungetService(shell.ctx, shellRef, &result);
+        bundleContext_ungetServiceReference(shell.ctx, shellRef);
+
+        double sum = 0.0;
+        CHECK_EQUAL(CELIX_SUCCESS, tstCalc->add(tstCalc->calculator, 2.0, 3.0, &sum));
+        DOUBLES_EQUAL(5.0, sum, 0.001);
+
+        bundleContext_ungetService(tst.ctx, tstRef, &result);
+        bundleContext_ungetServiceReference(tst.ctx, tstRef);
+    }
+
+    typedef struct discovery_response {
+        long code;
+        char etag[64];
+        bool delta;
+        bool gzip;
+        char *body;
+        size_t bodySize;
+    } discovery_response_t;
+
+    static size_t discoveryHeaderCallback(char *buffer, size_t size, size_t nitems, void *userdata) {
+        discovery_response_t *response = (discovery_response_t *) userdata;
+        size_t len = size * nitems;
+        char line[256];
+        snprintf(line, sizeof(line), "%.*s", (int) len, buffer);
+        if (sscanf(line, "ETag: \"%63[^\"]\"", response->etag) == 1) {
+            return len;
+        }
+        if (strncmp(line, "X-Celix-Discovery-Delta: true", 29) == 0) {
+            response->delta = true;
+        }
+        if (strncmp(line, "Content-Encoding: gzip", 22) == 0) {
+            response->gzip = true;
+        }
+        return len;
+    }
+
+    static size_t discoveryWriteCallback(char *ptr, size_t size, size_t nmemb, void *userdata) {
+        discovery_response_t *response = (discovery_response_t *) userdata;
+        size_t len = size * nmemb;
+        char *body = (char *) realloc(response->body, response->bodySize + len + 1);
+        if (body == NULL) {
+            return 0;
+        }
+        memcpy(body + response->bodySize, ptr, len);
+        response->bodySize += len;
+        body[response->bodySize] = '\0';
+        response->body = body;
+        return len;
+    }
+
+    /**
+     * GETs the endpoint list, with an optional extra request header. If acceptGzip is set, a gzip body is decoded by
+     * curl, so the body can be compared with an uncompressed one.
+     */
+    static void discoveryGetWithHeader(int port, const char *query, const char *header, bool acceptGzip, discovery_response_t *response) {
+        char url[256];
+        snprintf(url, sizeof(url), "http://127.0.0.1:%i/org.apache.celix.discovery.configured%s", port, query);
+        memset(response, 0, sizeof(*response));
+
+        CURL *curl = curl_easy_init();
+        CHECK(curl != NULL);
+        curl_easy_setopt(curl, CURLOPT_URL, url);
+        curl_easy_setopt(curl, CURLOPT_TIMEOUT, 10L);
+        curl_easy_setopt(curl, CURLOPT_HEADERFUNCTION, discoveryHeaderCallback);
+        curl_easy_setopt(curl, CURLOPT_HEADERDATA, response);
+        curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, discoveryWriteCallback);
+        curl_easy_setopt(curl, CURLOPT_WRITEDATA, response);
+        struct curl_slist *headers = NULL;
+        if (header != NULL) {
+            headers = curl_slist_append(headers, header);
+            curl_easy_setopt(curl, CURLOPT_HTTPHEADER, headers);
+        }
+        if (acceptGzip) {
+            curl_easy_setopt(curl, CURLOPT_ACCEPT_ENCODING, "gzip");
+        }
+        CHECK_EQUAL(CURLE_OK, curl_easy_perform(curl));
+        curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &response->code);
+        curl_slist_free_all(headers);
+        curl_easy_cleanup(curl);
+    }
+
+    static void discoveryGet(const char *query, discovery_response_t *response) {
+        discoveryGetWithHeader(50992, query, NULL, false, response);
+    }
+
+    static void waitForDiscoveredEndpoints(int port, discovery_response_t *full) {
+        int retries = 10;
+        do {
+            if (retries < 10) {
+                free(full->body);
+                usleep(500000);
+            }
+            discoveryGetWithHeader(port, "", NULL, false, full);
+            --retries;
+        } while ((full->body == NULL || strstr(full->body, "endpoint-description") == NULL) && retries > 0);
+        CHECK(full->body != NULL && strstr(full->body, "endpoint-description") != NULL);
+    }
+
+    static void testDiscoveryDelta(void) {
+        discovery_response_t full;
+        waitForDiscoveredEndpoints(50992, &full);
+
+        //the full list is versioned, but not a delta
+        CHECK_EQUAL(200, full.code);
+        CHECK(full.body != NULL && strstr(full.body, "endpoint-description") != NULL);
+        CHECK(strlen(full.etag) > 0);
+        CHECK(!full.delta);
+
+        //nothing changed since the reported version, so the long poll times out with 304
+        char query[128];
+        snprintf(query, sizeof(query), "?since=%s&wait=200", full.etag);
+        struct timespec start;
+        struct timespec end;
+        clock_gettime(CLOCK_MONOTONIC, &start);
+        discovery_response_t unchanged;
+        discoveryGet(query, &unchanged);
+        clock_gettime(CLOCK_MONOTONIC, &end);
+        CHECK_EQUAL(304, unchanged.code);
+        CHECK(unchanged.delta);
+        STRCMP_EQUAL(full.etag, unchanged.etag);
+        long elapsedInMs = (end.tv_sec - start.tv_sec) * 1000 + (end.tv_nsec - start.tv_nsec) / 1000000L;
+        CHECK(elapsedInMs >= 150);
+        free(unchanged.body);
+
+        //the previous version gets the last change as delta
+        unsigned long epoch = 0;
+        unsigned long version = 0;
+        CHECK_EQUAL(2, sscanf(full.etag, "%lu.%lu", &epoch, &version));
+        if (version > 1) {
+            snprintf(query, sizeof(query), "?since=%lu.%lu", epoch, version - 1);
+            discovery_response_t delta;
+            discoveryGet(query, &delta);
+            CHECK_EQUAL(200, delta.code);
+            CHECK(delta.delta);
+            STRCMP_EQUAL(full.etag, delta.etag);
+            CHECK(delta.body != NULL && strstr(delta.body, "endpoint-description") != NULL);
+            free(delta.body);
+        }
+
+        //an unknown version (e.g. from before a restart) gets the full list
+        snprintf(query, sizeof(query), "?since=%lu.%lu", epoch + 1, version);
+        discovery_response_t unknown;
+        discoveryGet(query, &unknown);
+        CHECK_EQUAL(200, unknown.code);
+        CHECK(!unknown.delta);
+        STRCMP_EQUAL(full.etag, unknown.etag);
+        CHECK_EQUAL(full.bodySize, unknown.bodySize);
+        free(unknown.body);
+
+        free(full.body);
+    }
+
+    static void testDiscoveryCachedEndpointList(void) {
+        discovery_response_t full;
+        waitForDiscoveredEndpoints(50992, &full);
+        CHECK_EQUAL(200, full.code);
+        CHECK(!full.gzip);
+        CHECK(strlen(full.etag) > 0);
+
+        //the cached list is served again as long as the endpoints do not change
+        discovery_response_t again;
+        discoveryGet("", &again);
+        CHECK_EQUAL(200, again.code);
+        STRCMP_EQUAL(full.etag, again.etag);
+        CHECK_EQUAL(full.bodySize, again.bodySize);
+        CHECK(memcmp(full.body, again.body, full.bodySize) == 0);
+        free(again.body);
+
+        //a poller accepting gzip gets the compressed list, which decodes to the same list
+        discovery_response_t compressed;
+        discoveryGetWithHeader(50992, "", NULL, true, &compressed);
+        CHECK_EQUAL(200, compressed.code);
+        CHECK(compressed.gzip);
+        STRCMP_EQUAL(full.etag, compressed.etag);
+        CHECK_EQUAL(full.bodySize, compressed.bodySize);
+        CHECK(memcmp(full.body, compressed.body, full.bodySize) == 0);
+        free(compressed.body);
+
+        //the binary format is cached separately
+        discovery_response_t binary1;
+        discovery_response_t binary2;
+        discoveryGetWithHeader(50992, "", "Accept: application/x-celix-endpoints", true, &binary1);
+        discoveryGetWithHeader(50992, "", "Accept: application/x-celix-endpoints", false, &binary2);
+        CHECK_EQUAL(200, binary1.code);
+        CHECK_EQUAL(200, binary2.code);
+        CHECK(binary1.gzip);
+        CHECK(!binary2.gzip);
+        CHECK_EQUAL(binary1.bodySize, binary2.bodySize);
+        CHECK(memcmp(binary1.body, binary2.body, binary1.bodySize) == 0);
+        CHECK(binary1.bodySize != full.bodySize);
+        free(binary1.body);
+        free(binary2.body);
+
+        //a poller which has the current list gets 304 without a body
+        char ifNoneMatch[128];
+        snprintf(ifNoneMatch, sizeof(ifNoneMatch), "If-None-Match: \"%s\"", full.etag);
+        discovery_response_t notModified;
+        discoveryGetWithHeader(50992, "", ifNoneMatch, true, &notModified);
+        CHECK_EQUAL(304, notModified.code);
+        STRCMP_EQUAL(full.etag, notModified.etag);
+        CHECK_EQUAL(0, notModified.bodySize);
+        free(notModified.body);
+
+        //an outdated ETag gets the list
+        discovery_response_t modified;
+        discoveryGetWithHeader(50992, "", "If-None-Match: \"0.0\"", false, &modified);
+        CHECK_EQUAL(200, modified.code);
+        CHECK_EQUAL(full.bodySize, modified.bodySize);
+        free(modified.body);
+
+        free(full.body);
+    }
+
+    static void testHttpAdminEndpoints(void) {
+        //the endpoints are served by the http_admin, so the endpoint urls have its port
+        discovery_response_t full;
+        waitForDiscoveredEndpoints(50993, &full);
+        CHECK(strstr(full.body, ":50893/service/") != NULL);
+        free(full.body);
+
+        //and the calls of the client go through the http_admin
+        test1();
+    }
+
 }
 
 
 TEST_GROUP(RsaDfiClientServerTests) {
     void setup() {
-        setupFm();
+        setupFm("server.properties", "client.properties");
     }
 
     void teardown() {
@@ -131,3 +413,29 @@ TEST_GROUP(RsaDfiClientServerTests) {
 TEST(RsaDfiClientServerTests, Test1) {
     test1();
 }
+
+TEST(RsaDfiClientServerTests, DiscoveryDelta) {
+    testDiscoveryDelta();
+}
+
+TEST(RsaDfiClientServerTests, DiscoveryCachedEndpointList) {
+    testDiscoveryCachedEndpointList();
+}
+
+TEST(RsaDfiClientServerTests, SharedImportProxy) {
+    testSharedImportProxy();
+}
+
+TEST_GROUP(RsaDfiHttpAdminClientServerTests) {
+    void setup() {
+        setupFm("http_admin_server.properties", "http_admin_client.properties");
+    }
+
+    void teardown() {
+        teardownFm();
+    }
+};
+
+TEST(RsaDfiHttpAdminClientServerTests, CallsThroughHttpAdmin) {
+    testHttpAdminEndpoints();
+}
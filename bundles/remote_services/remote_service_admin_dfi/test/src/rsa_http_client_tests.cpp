@@ -0,0 +1,240 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *  KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <CppUTest/TestHarness.h>
+#include <atomic>
+#include <cstdlib>
+#include <cstring>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include <unistd.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+
+extern "C" {
+#include "rsa_http_client.h"
+}
+
+namespace {
+    /**
+     * Minimal keep-alive HTTP/1.1 server answering every request with the current reply, counts the accepted
+     * connections. The reply "drop" closes the connection without answering.
+     */
+    class TestHttpServer {
+    public:
+        TestHttpServer() {
+            listenFd = socket(AF_INET, SOCK_STREAM, 0);
+            sockaddr_in addr{};
+            addr.sin_family = AF_INET;
+            addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+            addr.sin_port = 0;
+            bind(listenFd, (sockaddr *) &addr, sizeof(addr));
+            listen(listenFd, 16);
+            socklen_t len = sizeof(addr);
+            getsockname(listenFd, (sockaddr *) &addr, &len);
+            url = "http://127.0.0.1:" + std::to_string(ntohs(addr.sin_port)) + "/services/1";
+            acceptThread = std::thread{[this]{ acceptLoop(); }};
+        }
+
+        ~TestHttpServer() {
+            shutdown(listenFd, SHUT_RDWR);
+            acceptThread.join();
+            close(listenFd);
+            {
+                std::lock_guard<std::mutex> lck{mutex};
+                for (int fd : connections) {
+                    shutdown(fd, SHUT_RDWR);
+                }
+            }
+            for (auto &t : connectionThreads) {
+                t.join();
+            }
+            for (int fd : connections) {
+                close(fd);
+            }
+        }
+
+        void setReply(std::string r) {
+            std::lock_guard<std::mutex> lck{mutex};
+            reply = std::move(r);
+        }
+
+        std::string url{};
+        std::atomic<int> nrOfAccepted{0};
+    private:
+        void acceptLoop() {
+            while (true) {
+                int fd = accept(listenFd, nullptr, nullptr);
+                if (fd < 0) {
+                    break;
+                }
+                nrOfAccepted++;
+                std::lock_guard<std::mutex> lck{mutex};
+                connections.push_back(fd);
+                connectionThreads.emplace_back([this, fd]{ connectionLoop(fd); });
+            }
+        }
+
+        void connectionLoop(int fd) {
+            std::string buf;
+            char data[4096];
+            ssize_t n;
+            while ((n = read(fd, data, sizeof(data))) > 0) {
+                buf.append(data, (size_t) n);
+                size_t headerEnd = buf.find("\r\n\r\n");
+                if (headerEnd == std::string::npos) {
+                    continue;
+                }
+                size_t contentLength = 0;
+                size_t pos = buf.find("Content-Length: ");
+                if (pos != std::string::npos && pos < headerEnd) {
+                    contentLength = strtoul(buf.c_str() + pos + strlen("Content-Length: "), nullptr, 10);
+                }
+                if (buf.size() < headerEnd + 4 + contentLength) {
+                    continue;
+                }
+                buf.erase(0, headerEnd + 4 + contentLength);
+
+                std::string r;
+                {
+                    std::lock_guard<std::mutex> lck{mutex};
+                    r = reply;
+                }
+                if (r == "drop") {
+                    break;
+                }
+                write(fd, r.data(), r.size());
+            }
+            shutdown(fd, SHUT_RDWR);
+        }
+
+        int listenFd;
+        std::thread acceptThread{};
+        std::mutex mutex{}; //protects reply, connections & connectionThreads
+        std::string reply{};
+        std::vector<int> connections{};
+        std::vector<std::thread> connectionThreads{};
+    };
+
+    const char *okReply = "HTTP/1.1 200 OK\r\nContent-Type: application/json\r\nContent-Length: 8\r\n\r\n{\"r\":42}";
+    const char *noContentReply = "HTTP/1.1 204 No Content\r\nContent-Length: 0\r\n\r\n";
+    const char *unavailableReply = "HTTP/1.1 503 Service Unavailable\r\nContent-Length: 0\r\n\r\n";
+}
+
+TEST_GROUP(RsaHttpClientTests) {
+    TestHttpServer *server = nullptr;
+    rsa_http_client_t *client = nullptr;
+
+    void setup() {
+        server = new TestHttpServer{};
+        server->setReply(okReply);
+    }
+
+    void teardown() {
+        rsaHttpClient_destroy(client);
+        delete server;
+    }
+
+    int post(std::string &reply) {
+        const char *request = "{\"m\":\"add\"}";
+        char *replyData = nullptr;
+        size_t replyLength = 0;
+        int replyStatus = -1;
+        celix_status_t status = rsaHttpClient_post(client, server->url.c_str(), 5, nullptr, request, strlen(request), &replyData, &replyLength, &replyStatus);
+        CHECK_EQUAL(CELIX_SUCCESS, status);
+        CHECK(replyData != nullptr);
+        CHECK_EQUAL(strlen(replyData), replyLength);
+        reply = std::string{replyData, replyLength};
+        free(replyData);
+        return replyStatus;
+    }
+};
+
+TEST(RsaHttpClientTests, consecutiveCallsReuseConnection) {
+    client = rsaHttpClient_create(4);
+    std::string reply;
+    for (int i = 0; i < 5; ++i) {
+        CHECK_EQUAL(CURLE_OK, post(reply));
+        STRCMP_EQUAL("{\"r\":42}", reply.c_str());
+        CHECK_EQUAL(1, (int) rsaHttpClient_nrOfIdleConnections(client, server->url.c_str()));
+    }
+    CHECK_EQUAL(1, server->nrOfAccepted.load());
+
+    //the pool is per scheme://host:port, not per service path
+    std::string otherService = server->url.substr(0, server->url.rfind('/')) + "/2";
+    CHECK_EQUAL(1, (int) rsaHttpClient_nrOfIdleConnections(client, otherService.c_str()));
+}
+
+TEST(RsaHttpClientTests, poolSizeZeroDisablesPooling) {
+    client = rsaHttpClient_create(0);
+    std::string reply;
+    for (int i = 0; i < 3; ++i) {
+        CHECK_EQUAL(CURLE_OK, post(reply));
+        STRCMP_EQUAL("{\"r\":42}", reply.c_str());
+        CHECK_EQUAL(0, (int) rsaHttpClient_nrOfIdleConnections(client, server->url.c_str()));
+    }
+    CHECK_EQUAL(3, server->nrOfAccepted.load());
+}
+
+TEST(RsaHttpClientTests, nonSuccessStatusIsNotPooled) {
+    client = rsaHttpClient_create(4);
+    std::string reply;
+    CHECK_EQUAL(CURLE_OK, post(reply));
+    CHECK_EQUAL(1, (int) rsaHttpClient_nrOfIdleConnections(client, server->url.c_str()));
+
+    server->setReply(unavailableReply);
+    CHECK_EQUAL(CURLE_HTTP_RETURNED_ERROR, post(reply));
+    CHECK(reply.empty());
+    CHECK_EQUAL(0, (int) rsaHttpClient_nrOfIdleConnections(client, server->url.c_str()));
+
+    //the next call needs a new connection
+    server->setReply(okReply);
+    CHECK_EQUAL(CURLE_OK, post(reply));
+    CHECK_EQUAL(2, server->nrOfAccepted.load());
+}
+
+TEST(RsaHttpClientTests, transportErrorIsNotPooled) {
+    client = rsaHttpClient_create(4);
+    std::string reply;
+    server->setReply("drop");
+    CHECK(post(reply) != CURLE_OK);
+    CHECK(reply.empty());
+    CHECK_EQUAL(0, (int) rsaHttpClient_nrOfIdleConnections(client, server->url.c_str()));
+
+    server->setReply(okReply);
+    CHECK_EQUAL(CURLE_OK, post(reply));
+    CHECK_EQUAL(1, (int) rsaHttpClient_nrOfIdleConnections(client, server->url.c_str()));
+    CHECK_EQUAL(2, server->nrOfAccepted.load());
+}
+
+TEST(RsaHttpClientTests, noContentReplyOfVoidMethod) {
+    client = rsaHttpClient_create(4);
+    std::string reply;
+    server->setReply(noContentReply);
+    for (int i = 0; i < 3; ++i) {
+        CHECK_EQUAL(CURLE_OK, post(reply));
+        CHECK(reply.empty());
+    }
+    //the 204 reply is complete without a body, so the connection stays usable
+    CHECK_EQUAL(1, (int) rsaHttpClient_nrOfIdleConnections(client, server->url.c_str()));
+    CHECK_EQUAL(1, server->nrOfAccepted.load());
+}
@@ -0,0 +1,311 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *  KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <CppUTest/TestHarness.h>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdlib>
+#include <cstring>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "celix_constants.h"
+#include "remote_constants.h"
+
+extern "C" {
+#include "celix_properties.h"
+#include "endpoint_description.h"
+#include "rsa_replica_set.h"
+}
+
+namespace {
+    /**
+     * Fake endpoint transport, replies with its name after delay. Async replies are completed from a separate thread.
+     */
+    struct replica {
+        std::string name;
+        std::atomic<int> nrOfCalls{0};
+        std::atomic<int> delayInMs{0};
+        std::atomic<bool> failing{false};
+        std::mutex mutex{};
+        std::vector<std::thread> threads{};
+        std::string completedEndpointId{};
+
+        explicit replica(std::string n) : name{std::move(n)} {}
+
+        ~replica() {
+            for (auto &t : threads) {
+                t.join();
+            }
+        }
+
+        int handle(uint8_t **reply, size_t *replyLength) {
+            ++nrOfCalls;
+            std::this_thread::sleep_for(std::chrono::milliseconds{delayInMs.load()});
+            if (failing) {
+                return CELIX_ILLEGAL_STATE;
+            }
+            *reply = (uint8_t *) strdup(name.c_str());
+            *replyLength = name.size();
+            return 0;
+        }
+
+        static void send(void *handle, endpoint_description_t */*endpoint*/, char */*request*/, char **reply, int *replyStatus) {
+            size_t replyLength = 0;
+            *replyStatus = static_cast<replica*>(handle)->handle((uint8_t **) reply, &replyLength);
+        }
+
+        static void sendBinary(void *handle, endpoint_description_t */*endpoint*/, const uint8_t */*request*/, size_t /*requestLength*/, uint8_t **reply, size_t *replyLength, int *replyStatus) {
+            *replyStatus = static_cast<replica*>(handle)->handle(reply, replyLength);
+        }
+
+        static celix_status_t sendAsync(void *handle, endpoint_description_t *endpoint, bool /*binary*/, uint8_t *request, size_t /*requestLength*/, send_async_complete_func_type complete, void *completeHandle) {
+            auto *r = static_cast<replica*>(handle);
+            free(request);
+            //the endpoint must stay valid till the call is completed, also if the replica is removed in the meantime
+            std::lock_guard<std::mutex> lck{r->mutex};
+            r->threads.emplace_back([r, endpoint, complete, completeHandle]{
+                uint8_t *reply = nullptr;
+                size_t replyLength = 0;
+                int status = r->handle(&reply, &replyLength);
+                {
+                    std::lock_guard<std::mutex> lck{r->mutex};
+                    r->completedEndpointId = endpoint->id;
+                }
+                complete(completeHandle, status, reply, replyLength);
+            });
+            return CELIX_SUCCESS;
+        }
+    };
+
+    struct async_result {
+        std::mutex mutex{};
+        std::condition_variable cond{};
+        bool done{false};
+        int status{-1};
+        std::string reply{};
+
+        static void complete(void *handle, int status, uint8_t *reply, size_t replyLength) {
+            auto *r = static_cast<async_result*>(handle);
+            std::lock_guard<std::mutex> lck{r->mutex};
+            r->done = true;
+            r->status = status;
+            r->reply = reply == nullptr ? "" : std::string{(char *) reply, replyLength};
+            free(reply);
+            r->cond.notify_all();
+        }
+
+        bool waitDone() {
+            std::unique_lock<std::mutex> lck{mutex};
+            return cond.wait_for(lck, std::chrono::seconds{5}, [&]{ return done; });
+        }
+    };
+}
+
+TEST_GROUP(RsaReplicaSetTests) {
+    endpoint_description_t *endpoint = nullptr;
+    rsa_replica_set_t *set = nullptr;
+    replica a{"a"};
+    replica b{"b"};
+    replica c{"c"};
+
+    void setup() {
+        celix_properties_t *props = celix_properties_create();
+        celix_properties_set(props, OSGI_RSA_ENDPOINT_FRAMEWORK_UUID, "fw-uuid");
+        celix_properties_set(props, OSGI_RSA_ENDPOINT_ID, "endpoint-id");
+        celix_properties_set(props, OSGI_FRAMEWORK_OBJECTCLASS, "calc");
+        celix_properties_setLong(props, OSGI_RSA_ENDPOINT_SERVICE_ID, 42);
+        CHECK_EQUAL(CELIX_SUCCESS, endpointDescription_create(props, &endpoint));
+    }
+
+    void teardown() {
+        if (set != nullptr) {
+            rsaReplicaSet_destroy(set);
+        }
+        endpointDescription_destroy(endpoint);
+    }
+
+    void add(replica &r, bool binary = true, bool async = true) {
+        CHECK_EQUAL(CELIX_SUCCESS, rsaReplicaSet_addMember(set, &r, endpoint, replica::send,
+                                                           binary ? replica::sendBinary : nullptr,
+                                                           async ? replica::sendAsync : nullptr, &r));
+    }
+
+    std::string call(int *replyStatus = nullptr) {
+        char *reply = nullptr;
+        int status = -1;
+        rsaReplicaSet_send(set, nullptr, (char *) "{}", &reply, &status);
+        if (replyStatus != nullptr) {
+            *replyStatus = status;
+        }
+        std::string result = reply == nullptr ? "" : reply;
+        free(reply);
+        return result;
+    }
+};
+
+TEST(RsaReplicaSetTests, noReplicas) {
+    set = rsaReplicaSet_create(RSA_BALANCING_ROUND_ROBIN, false, 0);
+    int status = 0;
+    call(&status);
+    CHECK_EQUAL(CELIX_ILLEGAL_STATE, status);
+
+    async_result result{};
+    CHECK_EQUAL(CELIX_ILLEGAL_STATE, rsaReplicaSet_sendAsync(set, nullptr, false, (uint8_t *) strdup("{}"), 2, async_result::complete, &result));
+    CHECK(!result.done);
+}
+
+TEST(RsaReplicaSetTests, roundRobinSpreadsCalls) {
+    set = rsaReplicaSet_create(RSA_BALANCING_ROUND_ROBIN, false, 0);
+    add(a);
+    add(b);
+    add(c);
+    for (int i = 0; i < 9; ++i) {
+        int status = -1;
+        call(&status);
+        CHECK_EQUAL(0, status);
+    }
+    CHECK_EQUAL(3, a.nrOfCalls.load());
+    CHECK_EQUAL(3, b.nrOfCalls.load());
+    CHECK_EQUAL(3, c.nrOfCalls.load());
+
+    CHECK_EQUAL(2, (int) rsaReplicaSet_removeMember(set, &b));
+    CHECK_EQUAL(2, (int) rsaReplicaSet_removeMember(set, &b)); //not a member anymore
+    for (int i = 0; i < 4; ++i) {
+        CHECK(call() != "b");
+    }
+    CHECK_EQUAL(3, b.nrOfCalls.load());
+}
+
+TEST(RsaReplicaSetTests, failedReplicaIsAvoided) {
+    set = rsaReplicaSet_create(RSA_BALANCING_ROUND_ROBIN, false, 0);
+    add(a);
+    add(b);
+    a.failing = true;
+    call();
+    call();
+    CHECK_EQUAL(1, a.nrOfCalls.load());
+
+    //a is only called again after the backoff
+    for (int i = 0; i < 6; ++i) {
+        STRCMP_EQUAL("b", call().c_str());
+    }
+    CHECK_EQUAL(1, a.nrOfCalls.load());
+
+    //a failed replica is still used if there is no other replica
+    rsaReplicaSet_removeMember(set, &b);
+    int status = 0;
+    call(&status);
+    CHECK_EQUAL(CELIX_ILLEGAL_STATE, status);
+    CHECK_EQUAL(2, a.nrOfCalls.load());
+}
+
+TEST(RsaReplicaSetTests, leastOutstandingPrefersFastReplica) {
+    set = rsaReplicaSet_create(RSA_BALANCING_LEAST_OUTSTANDING, false, 0);
+    add(a);
+    add(b);
+    a.delayInMs = 20;
+    //both replicas get a latency sample
+    call();
+    call();
+    CHECK_EQUAL(1, a.nrOfCalls.load());
+
+    for (int i = 0; i < 10; ++i) {
+        STRCMP_EQUAL("b", call().c_str());
+    }
+    CHECK_EQUAL(1, a.nrOfCalls.load());
+}
+
+TEST(RsaReplicaSetTests, binaryCallsOnlyToBinaryReplicas) {
+    set = rsaReplicaSet_create(RSA_BALANCING_ROUND_ROBIN, false, 0);
+    add(a, false);
+    add(b);
+    for (int i = 0; i < 4; ++i) {
+        uint8_t *reply = nullptr;
+        size_t replyLength = 0;
+        int status = -1;
+        rsaReplicaSet_sendBinary(set, nullptr, (const uint8_t *) "req", 3, &reply, &replyLength, &status);
+        CHECK_EQUAL(0, status);
+        CHECK_EQUAL(1, (int) replyLength);
+        CHECK_EQUAL('b', reply[0]);
+        free(reply);
+    }
+    CHECK_EQUAL(0, a.nrOfCalls.load());
+
+    //also not for async binary calls
+    async_result result{};
+    CHECK_EQUAL(CELIX_SUCCESS, rsaReplicaSet_sendAsync(set, nullptr, true, (uint8_t *) strdup("req"), 3, async_result::complete, &result));
+    CHECK(result.waitDone());
+    STRCMP_EQUAL("b", result.reply.c_str());
+}
+
+TEST(RsaReplicaSetTests, hedgedCallUsesFirstReply) {
+    set = rsaReplicaSet_create(RSA_BALANCING_ROUND_ROBIN, true, 1000);
+    add(a);
+    add(b);
+    //the p95 latency of both replicas is known after 16 calls each
+    for (int i = 0; i < 32; ++i) {
+        CHECK(!call().empty());
+    }
+
+    a.delayInMs = 300;
+    for (int i = 0; i < 2; ++i) {
+        auto start = std::chrono::steady_clock::now();
+        //a call sent to the slow replica is hedged to the other replica
+        STRCMP_EQUAL("b", call().c_str());
+        CHECK(std::chrono::steady_clock::now() - start < std::chrono::milliseconds{200});
+    }
+    CHECK(a.nrOfCalls.load() > 16);
+}
+
+TEST(RsaReplicaSetTests, hedgedCallFallsBackOnFailure) {
+    set = rsaReplicaSet_create(RSA_BALANCING_ROUND_ROBIN, true, 1000);
+    add(a);
+    add(b);
+    for (int i = 0; i < 32; ++i) {
+        call();
+    }
+
+    a.failing = true;
+    for (int i = 0; i < 2; ++i) {
+        int status = -1;
+        STRCMP_EQUAL("b", call(&status).c_str());
+        CHECK_EQUAL(0, status);
+    }
+}
+
+TEST(RsaReplicaSetTests, asyncCallOutlivesRemovedReplica) {
+    set = rsaReplicaSet_create(RSA_BALANCING_ROUND_ROBIN, false, 0);
+    add(a);
+    a.delayInMs = 50;
+    async_result result{};
+    CHECK_EQUAL(CELIX_SUCCESS, rsaReplicaSet_sendAsync(set, nullptr, false, (uint8_t *) strdup("{}"), 2, async_result::complete, &result));
+    CHECK_EQUAL(0, (int) rsaReplicaSet_removeMember(set, &a));
+    rsaReplicaSet_destroy(set);
+    set = nullptr;
+
+    CHECK(result.waitDone());
+    CHECK_EQUAL(0, result.status);
+    STRCMP_EQUAL("a", result.reply.c_str());
+    std::lock_guard<std::mutex> lck{a.mutex};
+    STRCMP_EQUAL("endpoint-id", a.completedEndpointId.c_str());
+}
@@ -0,0 +1,243 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *  KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <CppUTest/TestHarness.h>
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <condition_variable>
+#include <cstdlib>
+#include <cstring>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include <unistd.h>
+
+extern "C" {
+#include "rsa_tcp_transport.h"
+}
+
+namespace {
+    constexpr unsigned long ECHO_SVC_ID = 1;
+    constexpr unsigned long MISSING_SVC_ID = 2;
+    constexpr unsigned long BUSY_SVC_ID = 3;
+    constexpr unsigned long FAILING_SVC_ID = 4;
+    constexpr unsigned long BINARY_SVC_ID = 5;
+
+    /**
+     * Echoes the request for ECHO_SVC_ID. A request starting with "slow" is delayed, so the replies of concurrent
+     * calls are written out of order.
+     */
+    celix_status_t call(void */*handle*/, unsigned long serviceId, bool binary, const uint8_t *request, size_t requestLength, uint8_t **reply, size_t *replyLength) {
+        switch (serviceId) {
+            case ECHO_SVC_ID:
+                break;
+            case MISSING_SVC_ID:
+                return ENOENT;
+            case BUSY_SVC_ID:
+                return EBUSY;
+            case BINARY_SVC_ID:
+                *reply = (uint8_t *) strdup(binary ? "binary" : "json");
+                *replyLength = strlen((char *) *reply);
+                return CELIX_SUCCESS;
+            default:
+                return CELIX_ILLEGAL_STATE;
+        }
+        if (requestLength >= 4 && memcmp(request, "slow", 4) == 0) {
+            std::this_thread::sleep_for(std::chrono::milliseconds{100});
+        }
+        *reply = (uint8_t *) malloc(requestLength);
+        memcpy(*reply, request, requestLength);
+        *replyLength = requestLength;
+        return CELIX_SUCCESS;
+    }
+
+    struct completions {
+        std::mutex mutex{};
+        std::condition_variable cond{};
+        std::vector<std::string> replies{};
+        std::vector<int> statuses{};
+
+        static void complete(void *handle, int status, uint8_t *reply, size_t replyLength) {
+            auto *c = static_cast<completions*>(handle);
+            std::lock_guard<std::mutex> lck{c->mutex};
+            c->replies.emplace_back(reply == nullptr ? "" : std::string{(char *) reply, replyLength});
+            c->statuses.push_back(status);
+            free(reply);
+            c->cond.notify_all();
+        }
+
+        bool waitFor(size_t count) {
+            std::unique_lock<std::mutex> lck{mutex};
+            return cond.wait_for(lck, std::chrono::seconds{5}, [&]{ return replies.size() >= count; });
+        }
+    };
+}
+
+TEST_GROUP(RsaTcpTransportTests) {
+    rsa_tcp_server_t *server = nullptr;
+    rsa_tcp_client_t *client = nullptr;
+
+    void setup() {
+        server = rsaTcpServer_create(nullptr, "127.0.0.1", 0, nullptr, 4, nullptr, call);
+        CHECK(server != nullptr);
+        client = rsaTcpClient_create(nullptr);
+        CHECK(client != nullptr);
+    }
+
+    void teardown() {
+        rsaTcpClient_destroy(client);
+        if (server != nullptr) {
+            rsaTcpServer_destroy(server);
+        }
+    }
+
+    int syncCall(const char *url, unsigned long serviceId, const std::string &request, std::string &reply, bool binary = false) {
+        uint8_t *replyData = nullptr;
+        size_t replyLength = 0;
+        int replyStatus = -1;
+        celix_status_t status = rsaTcpClient_call(client, url, serviceId, binary, (const uint8_t *) request.data(), request.size(), 5, &replyData, &replyLength, &replyStatus);
+        CHECK_EQUAL(replyStatus == 0 ? CELIX_SUCCESS : CELIX_ILLEGAL_STATE, status);
+        reply = replyData == nullptr ? "" : std::string{(char *) replyData, replyLength};
+        free(replyData);
+        return replyStatus;
+    }
+};
+
+TEST(RsaTcpTransportTests, syncCallOverTcp) {
+    std::string url = rsaTcpServer_getUrl(server);
+    //port 0 binds an ephemeral port, which is part of the url
+    CHECK(url.rfind("tcp://127.0.0.1:", 0) == 0);
+    CHECK(url != "tcp://127.0.0.1:0");
+
+    std::string reply;
+    CHECK_EQUAL(0, syncCall(url.c_str(), ECHO_SVC_ID, "{\"m\":\"add\"}", reply));
+    STRCMP_EQUAL("{\"m\":\"add\"}", reply.c_str());
+
+    //calls share the connection
+    CHECK_EQUAL(0, syncCall(url.c_str(), ECHO_SVC_ID, std::string(100000, 'x'), reply));
+    CHECK_EQUAL(100000, (int) reply.size());
+    CHECK_EQUAL(0, syncCall(url.c_str(), ECHO_SVC_ID, "", reply));
+    CHECK(reply.empty());
+}
+
+TEST(RsaTcpTransportTests, syncCallOverUnixSocket) {
+    std::string path = "/tmp/rsa_tcp_transport_test_" + std::to_string(getpid());
+    rsa_tcp_server_t *unixServer = rsaTcpServer_create(nullptr, "127.0.0.1", 0, path.c_str(), 2, nullptr, call);
+    CHECK(unixServer != nullptr);
+    STRCMP_EQUAL(("unix://" + path).c_str(), rsaTcpServer_getUrl(unixServer));
+
+    std::string reply;
+    CHECK_EQUAL(0, syncCall(rsaTcpServer_getUrl(unixServer), ECHO_SVC_ID, "hello", reply));
+    STRCMP_EQUAL("hello", reply.c_str());
+    rsaTcpServer_destroy(unixServer);
+}
+
+TEST(RsaTcpTransportTests, remoteErrors) {
+    const char *url = rsaTcpServer_getUrl(server);
+    std::string reply = "not touched";
+    //like a failed HTTP call, a call which failed on the remote side has status 0 and an empty reply
+    CHECK_EQUAL(0, syncCall(url, MISSING_SVC_ID, "req", reply));
+    CHECK(reply.empty());
+    CHECK_EQUAL(0, syncCall(url, BUSY_SVC_ID, "req", reply));
+    CHECK(reply.empty());
+    CHECK_EQUAL(0, syncCall(url, FAILING_SVC_ID, "req", reply));
+    CHECK(reply.empty());
+
+    //the connection is still usable
+    CHECK_EQUAL(0, syncCall(url, ECHO_SVC_ID, "req", reply));
+    STRCMP_EQUAL("req", reply.c_str());
+}
+
+TEST(RsaTcpTransportTests, binaryFlag) {
+    const char *url = rsaTcpServer_getUrl(server);
+    std::string reply;
+    CHECK_EQUAL(0, syncCall(url, BINARY_SVC_ID, "req", reply, true));
+    STRCMP_EQUAL("binary", reply.c_str());
+    CHECK_EQUAL(0, syncCall(url, BINARY_SVC_ID, "req", reply, false));
+    STRCMP_EQUAL("json", reply.c_str());
+}
+
+TEST(RsaTcpTransportTests, asyncCallsOutOfOrder) {
+    const char *url = rsaTcpServer_getUrl(server);
+    completions done{};
+    const int nrOfCalls = 20;
+    for (int i = 0; i < nrOfCalls; ++i) {
+        std::string request = (i == 0 ? "slow" : "fast") + std::to_string(i);
+        CHECK_EQUAL(CELIX_SUCCESS, rsaTcpClient_callAsync(client, url, ECHO_SVC_ID, false, (uint8_t *) strdup(request.c_str()), request.size(), completions::complete, &done));
+    }
+    CHECK(done.waitFor(nrOfCalls));
+
+    std::lock_guard<std::mutex> lck{done.mutex};
+    for (int status : done.statuses) {
+        CHECK_EQUAL(0, status);
+    }
+    //the slow call does not hold back the other calls of the connection
+    STRCMP_EQUAL("slow0", done.replies.back().c_str());
+    for (int i = 1; i < nrOfCalls; ++i) {
+        CHECK(std::find(done.replies.begin(), done.replies.end(), "fast" + std::to_string(i)) != done.replies.end());
+    }
+}
+
+TEST(RsaTcpTransportTests, unknownServer) {
+    std::string url = rsaTcpServer_getUrl(server);
+    rsaTcpServer_destroy(server);
+    server = nullptr;
+
+    std::string reply;
+    CHECK_EQUAL(ECONNREFUSED, syncCall(url.c_str(), ECHO_SVC_ID, "req", reply));
+
+    //on error the async callback is not called and the request is freed
+    completions done{};
+    CHECK_EQUAL(CELIX_ILLEGAL_STATE, rsaTcpClient_callAsync(client, url.c_str(), ECHO_SVC_ID, false, (uint8_t *) strdup("req"), 3, completions::complete, &done));
+    CHECK(done.replies.empty());
+}
+
+TEST(RsaTcpTransportTests, reconnectAfterServerRestart) {
+    std::string path = "/tmp/rsa_tcp_transport_restart_test_" + std::to_string(getpid());
+    rsa_tcp_server_t *unixServer = rsaTcpServer_create(nullptr, "127.0.0.1", 0, path.c_str(), 2, nullptr, call);
+    std::string url = rsaTcpServer_getUrl(unixServer);
+    std::string reply;
+    CHECK_EQUAL(0, syncCall(url.c_str(), ECHO_SVC_ID, "first", reply));
+
+    //a call in flight when the server goes away is still completed
+    completions done{};
+    CHECK_EQUAL(CELIX_SUCCESS, rsaTcpClient_callAsync(client, url.c_str(), ECHO_SVC_ID, false, (uint8_t *) strdup("slow"), 4, completions::complete, &done));
+    rsaTcpServer_destroy(unixServer);
+    CHECK(done.waitFor(1));
+
+    //the lost connection is recreated by the next call
+    unixServer = rsaTcpServer_create(nullptr, "127.0.0.1", 0, path.c_str(), 2, nullptr, call);
+    CHECK(unixServer != nullptr);
+    CHECK_EQUAL(0, syncCall(url.c_str(), ECHO_SVC_ID, "second", reply));
+    STRCMP_EQUAL("second", reply.c_str());
+    rsaTcpServer_destroy(unixServer);
+}
+
+TEST(RsaTcpTransportTests, destroyClientAbortsCallsInFlight) {
+    completions done{};
+    CHECK_EQUAL(CELIX_SUCCESS, rsaTcpClient_callAsync(client, rsaTcpServer_getUrl(server), ECHO_SVC_ID, false, (uint8_t *) strdup("slow"), 4, completions::complete, &done));
+    rsaTcpClient_destroy(client);
+    client = rsaTcpClient_create(nullptr);
+
+    std::lock_guard<std::mutex> lck{done.mutex};
+    CHECK_EQUAL(1, (int) done.statuses.size());
+    CHECK_EQUAL(ECONNABORTED, done.statuses[0]);
+}
@@ -28,11 +28,22 @@
 #include "service_registration.h"
 #include "service_reference.h"
 #include "celix_errno.h"
+#include "celix_threads.h"
 
 #include "tst_service.h"
 #include "calculator_service.h"
+#include "remote_async_call.h"
 #include <unistd.h>
 
+#define CALCULATOR_ASYNC_SERVICE CALCULATOR_SERVICE REMOTE_ASYNC_SERVICE_NAME_SUFFIX
+
+typedef struct calculator_async_service {
+    calculator_t *calculator;
+    int (*add)(calculator_t *calculator, double a, double b, double *result, remote_async_call_t **call);
+    int (*sub)(calculator_t *calculator, double a, double b, double *result, remote_async_call_t **call);
+    int (*sqrt)(calculator_t *calculator, double a, double *result, remote_async_call_t **call);
+} calculator_async_service_t;
+
 
 struct activator {
 	celix_bundle_context_t *context;
@@ -42,11 +53,19 @@ struct activator {
 	service_tracker_customizer_t *cust;
 	service_tracker_t *tracker;
 	calculator_service_t *calc;
+
+	service_tracker_customizer_t *asyncCust;
+	service_tracker_t *asyncTracker;
+	calculator_async_service_t *asyncCalc;
 };
 
 static celix_status_t addCalc(void * handle, service_reference_pt reference, void * service);
 static celix_status_t removeCalc(void * handle, service_reference_pt reference, void * service);
+static celix_status_t addAsyncCalc(void * handle, service_reference_pt reference, void * service);
+static celix_status_t removeAsyncCalc(void * handle, service_reference_pt reference, void * service);
 static int test(void *handle);
+static int testAsync(void *handle);
+static int testConcurrent(void *handle);
 
 celix_status_t bundleActivator_create(celix_bundle_context_t *context, void **out) {
 	celix_status_t status = CELIX_SUCCESS;
@@ -55,9 +74,13 @@ celix_status_t bundleActivator_create(celix_bundle_context_t *context, void **ou
 		act->context = context;
 		act->serv.handle = act;
 		act->serv.test = test;
+		act->serv.testAsync = testAsync;
+		act->serv.testConcurrent = testConcurrent;
 
 		status = serviceTrackerCustomizer_create(act, NULL, addCalc, NULL, removeCalc, &act->cust);
 		status = CELIX_DO_IF(status, serviceTracker_create(context, CALCULATOR_SERVICE, act->cust, &act->tracker));
+		status = CELIX_DO_IF(status, serviceTrackerCustomizer_create(act, NULL, addAsyncCalc, NULL, removeAsyncCalc, &act->asyncCust));
+		status = CELIX_DO_IF(status, serviceTracker_create(context, CALCULATOR_ASYNC_SERVICE, act->asyncCust, &act->asyncTracker));
 
 	} else {
 		status = CELIX_ENOMEM;
@@ -74,6 +97,10 @@ celix_status_t bundleActivator_create(celix_bundle_context_t *context, void **ou
 			serviceTracker_destroy(act->tracker);
 			act->tracker = NULL;
 		}
+		if (act->asyncTracker != NULL) {
+			serviceTracker_destroy(act->asyncTracker);
+			act->asyncTracker = NULL;
+		}
 		free(act);
 	}
 
@@ -97,6 +124,20 @@ static celix_status_t removeCalc(void * handle, service_reference_pt reference,
 
 }
 
+static celix_status_t addAsyncCalc(void * handle, service_reference_pt reference, void * service) {
+	struct activator * act = handle;
+	act->asyncCalc = service;
+	return CELIX_SUCCESS;
+}
+
+static celix_status_t removeAsyncCalc(void * handle, service_reference_pt reference, void * service) {
+	struct activator * act = handle;
+	if (act->asyncCalc == service) {
+		act->asyncCalc = NULL;
+	}
+	return CELIX_SUCCESS;
+}
+
 celix_status_t bundleActivator_start(void * userData, celix_bundle_context_t *context) {
     celix_status_t status = CELIX_SUCCESS;
 	struct activator * act = userData;
@@ -105,6 +146,7 @@ celix_status_t bundleActivator_start(void * userData, celix_bundle_context_t *co
 	status = bundleContext_registerService(context, (char *)TST_SERVICE_NAME, &act->serv, NULL, &act->reg);
 
 	status = CELIX_DO_IF(status, serviceTracker_open(act->tracker));
+	status = CELIX_DO_IF(status, serviceTracker_open(act->asyncTracker));
 
 
 	return status;
@@ -117,6 +159,7 @@ celix_status_t bundleActivator_stop(void * userData, celix_bundle_context_t *con
 
 	status = serviceRegistration_unregister(act->reg);
 	status = CELIX_DO_IF(status, serviceTracker_close(act->tracker));
+	status = CELIX_DO_IF(status, serviceTracker_close(act->asyncTracker));
 
 	return status;
 }
@@ -128,6 +171,10 @@ celix_status_t bundleActivator_destroy(void * userData, celix_bundle_context_t *
 			serviceTracker_destroy(act->tracker);
 			act->tracker = NULL;
 		}
+		if (act->asyncTracker != NULL) {
+			serviceTracker_destroy(act->asyncTracker);
+			act->asyncTracker = NULL;
+		}
 		free(act);
 	}
 	return CELIX_SUCCESS;
@@ -160,3 +207,81 @@ static int test(void *handle) {
 	}
 	return status;
 }
+
+static int testAsync(void *handle) {
+	struct activator *act = handle;
+
+	int retries = 40;
+	while (act->asyncCalc == NULL && retries > 0) {
+		printf("Waiting for async calc service .. %d\n", retries);
+		usleep(100000);
+		--retries;
+	}
+	if (act->asyncCalc == NULL) {
+		printf("async calc not ready\n");
+		return 1;
+	}
+
+	//all calls are in flight before the first wait
+	double results[3] = {-1.0, -1.0, -1.0};
+	remote_async_call_t *calls[3] = {NULL, NULL, NULL};
+	int rc = act->asyncCalc->add(act->asyncCalc->calculator, 1.0, 2.0, &results[0], &calls[0]);
+	rc = rc != 0 ? rc : act->asyncCalc->sub(act->asyncCalc->calculator, 5.0, 3.0, &results[1], &calls[1]);
+	rc = rc != 0 ? rc : act->asyncCalc->sqrt(act->asyncCalc->calculator, 16.0, &results[2], &calls[2]);
+
+	for (int i = 0; i < 3; ++i) {
+		if (calls[i] != NULL) {
+			int callRc = calls[i]->wait(calls[i]->handle, 5000);
+			rc = rc != 0 ? rc : callRc;
+			calls[i]->destroy(calls[i]->handle);
+		}
+	}
+	printf("async calc results are %f, %f, %f\n", results[0], results[1], results[2]);
+
+	return rc != 0 || results[0] != 3.0 || results[1] != 2.0 || results[2] != 4.0;
+}
+
+#define CONCURRENT_THREADS  8
+#define CONCURRENT_CALLS    50
+
+static void* concurrentCalls(void *data) {
+	calculator_service_t *calc = data;
+	long failures = 0;
+	for (int i = 0; i < CONCURRENT_CALLS; ++i) {
+		double result = -1.0;
+		int rc = calc->add(calc->calculator, i, 1.0, &result);
+		if (rc != 0 || result != i + 1.0) {
+			failures += 1;
+		}
+	}
+	return (void*) failures;
+}
+
+static int testConcurrent(void *handle) {
+	struct activator *act = handle;
+
+	int retries = 40;
+	while (act->calc == NULL && retries > 0) {
+		printf("Waiting for calc service .. %d\n", retries);
+		usleep(100000);
+		--retries;
+	}
+	if (act->calc == NULL) {
+		printf("calc not ready\n");
+		return 1;
+	}
+
+	//the calls are handled concurrently by the HTTP server threads and the export thread pool of the calculator
+	celix_thread_t threads[CONCURRENT_THREADS];
+	for (int i = 0; i < CONCURRENT_THREADS; ++i) {
+		celixThread_create(&threads[i], NULL, concurrentCalls, act->calc);
+	}
+	long failures = 0;
+	for (int i = 0; i < CONCURRENT_THREADS; ++i) {
+		void *result = NULL;
+		celixThread_join(threads[i], &result);
+		failures += (long) result;
+	}
+	printf("%li of %i concurrent calc calls failed\n", failures, CONCURRENT_THREADS * CONCURRENT_CALLS);
+	return failures != 0;
+}
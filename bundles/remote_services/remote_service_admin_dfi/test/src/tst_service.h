@@ -25,6 +25,8 @@
 struct tst_service {
     void *handle;
     int (*test)(void *handle);
+    int (*testAsync)(void *handle);
+    int (*testConcurrent)(void *handle);
 };
 
 typedef struct tst_service tst_service_t;
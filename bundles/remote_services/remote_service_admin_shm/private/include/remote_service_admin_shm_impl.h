@@ -28,17 +28,26 @@
 #define REMOTE_SERVICE_ADMIN_SHM_IMPL_H_
 
 #include "remote_service_admin_impl.h"
+#include "remote_service_admin_shm_ring.h"
 #include "log_helper.h"
 
-#define RSA_SHM_MEMSIZE 1310720
 #define RSA_SHM_PATH_PROPERTYNAME "shmPath"
-#define RSA_SEM_PATH_PROPERTYNAME "semPath"
 #define RSA_SHM_FTOK_ID_PROPERTYNAME "shmFtokId"
-#define RSA_SEM_FTOK_ID_PROPERTYNAME "semFtokId"
 #define RSA_SHM_DEFAULTPATH "/dev/null"
-#define RSA_SEM_DEFAULTPATH "/dev/null"
 #define RSA_SHM_DEFAULT_FTOK_ID "52"
-#define RSA_SEM_DEFAULT_FTOK_ID "54"
+
+/** Nr of call slots in the shared memory of an exported service, i.e. the max nr of calls in flight */
+#define RSA_SHM_SLOTS_PROPERTYNAME "RSA_SHM_SLOTS"
+#define RSA_SHM_SLOTS_DEFAULT 16
+/** Max size of a request/reply of a call */
+#define RSA_SHM_SLOT_SIZE_PROPERTYNAME "RSA_SHM_SLOT_SIZE"
+#define RSA_SHM_SLOT_SIZE_DEFAULT 65536
+/** Nr of threads handling the calls of an exported service */
+#define RSA_SHM_RECEIVE_THREADS_PROPERTYNAME "RSA_SHM_RECEIVE_THREADS"
+#define RSA_SHM_RECEIVE_THREADS_DEFAULT 4
+/** Max time a call waits for a free slot and the reply */
+#define RSA_SHM_CALL_TIMEOUT_MS_PROPERTYNAME "RSA_SHM_CALL_TIMEOUT_MS"
+#define RSA_SHM_CALL_TIMEOUT_MS_DEFAULT 30000
 
 #define RSA_FILEPATH_LENGTH 255
 
@@ -47,22 +56,20 @@
 #define P_tmpdir "/tmp"
 #endif
 
-union semun {
-    int val; /* Value for SETVAL */
-    struct semid_ds *buf; /* Buffer for IPC_STAT, IPC_SET */
-    unsigned short *array; /* Array for GETALL, SETALL */
-    struct seminfo *__buf; /* Buffer for IPC_INFO */
-};
-
 struct recv_shm_thread {
     remote_service_admin_t *admin;
     endpoint_description_t *endpointDescription;
+    rsa_shm_ring_t *ring;
+    bool *running;
+
+    int nrOfThreads;
+    celix_thread_t *threads;
 };
 
 struct ipc_segment {
-    int semId;
     int shmId;
     void *shmBaseAddress;
+    rsa_shm_ring_t *ring;
 };
 
 struct remote_service_admin {
@@ -78,9 +85,14 @@ struct remote_service_admin {
     hash_map_pt exportedIpcSegment;
     hash_map_pt importedIpcSegment;
 
-    hash_map_pt pollThread;
+    hash_map_pt pollThread; //key = endpoint description, value = recv_shm_thread_pt
     hash_map_pt pollThreadRunning;
 
+    uint32_t nrOfSlots;
+    uint32_t slotSize;
+    int nrOfReceiveThreads;
+    unsigned int callTimeoutInMs;
+
     struct mg_context *ctx;
 };
 
@@ -0,0 +1,87 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *  KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#ifndef REMOTE_SERVICE_ADMIN_SHM_RING_H_
+#define REMOTE_SERVICE_ADMIN_SHM_RING_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "celix_errno.h"
+
+/**
+ * Ring of call slots in a shared memory segment of an exported endpoint.
+ *
+ * A caller claims a free slot (round robin, with a CAS on the slot state), writes the length-prefixed request in the
+ * slot and waits on the slot state futex for the reply. Receive threads of the exporter take requests from any slot,
+ * so every slot can have a call in flight, for one or more callers/processes.
+ * Waiters on free slots, requests and replies are woken with futexes in the shared memory.
+ */
+typedef struct rsa_shm_ring rsa_shm_ring_t;
+
+/**
+ * Handles a request, sets the (NUL terminated) reply, which is freed by the ring.
+ * The request is NUL terminated and only valid during the call.
+ */
+typedef celix_status_t (*rsa_shm_ring_handle_request_fp)(void *handle, const char *request, size_t requestLength, char **reply);
+
+/**
+ * The size of the shared memory segment needed for the ring.
+ */
+size_t rsaShmRing_segmentSize(uint32_t nrOfSlots, uint32_t slotSize);
+
+/**
+ * Initializes a ring in the (new) shared memory segment of at least rsaShmRing_segmentSize bytes and attaches to it.
+ */
+rsa_shm_ring_t* rsaShmRing_create(void *segment, size_t segmentSize, uint32_t nrOfSlots, uint32_t slotSize);
+
+/**
+ * Attaches to a ring initialized by rsaShmRing_create. Returns NULL if the segment does not contain a valid ring.
+ */
+rsa_shm_ring_t* rsaShmRing_attach(void *segment, size_t segmentSize);
+
+/**
+ * Detaches from the ring, the shared memory segment itself is not touched.
+ */
+void rsaShmRing_detach(rsa_shm_ring_t *ring);
+
+/**
+ * Max length of a request or reply (excluding the NUL terminator).
+ */
+size_t rsaShmRing_maxMessageLength(const rsa_shm_ring_t *ring);
+
+/**
+ * Calls the exporter: waits max timeoutInMs for a free slot and the reply.
+ * On success the reply (NUL terminated, owned by the caller) and the status of the handled request are returned.
+ * Returns CELIX_ILLEGAL_ARGUMENT if the request is too large, CELIX_ILLEGAL_STATE on a timeout.
+ */
+celix_status_t rsaShmRing_call(rsa_shm_ring_t *ring, const char *request, size_t requestLength, unsigned int timeoutInMs, char **reply, size_t *replyLength, celix_status_t *replyStatus);
+
+/**
+ * Waits max timeoutInMs for a request and handles it with the provided handler, in the calling thread.
+ * Returns CELIX_SUCCESS if a request was handled, CELIX_ILLEGAL_STATE on a timeout or wakeup.
+ */
+celix_status_t rsaShmRing_serve(rsa_shm_ring_t *ring, unsigned int timeoutInMs, rsa_shm_ring_handle_request_fp handleRequest, void *handle);
+
+/**
+ * Wakes up all threads waiting in rsaShmRing_serve, e.g. to stop the receive threads.
+ */
+void rsaShmRing_wakeup(rsa_shm_ring_t *ring);
+
+#endif /* REMOTE_SERVICE_ADMIN_SHM_RING_H_ */
@@ -30,7 +30,6 @@
 #include <dirent.h>
 #include <sys/stat.h>
 #include <sys/types.h>
-#include <sys/sem.h>
 #include <sys/ipc.h>
 #include <sys/shm.h>
 #include <unistd.h>
@@ -49,9 +48,7 @@
 #include "service_reference.h"
 #include "service_registration.h"
 
-static celix_status_t remoteServiceAdmin_lock(int semId, int semNr);
-static celix_status_t remoteServiceAdmin_unlock(int semId, int semNr);
-static int remoteServiceAdmin_getCount(int semId, int semNr);
+static celix_status_t remoteServiceAdmin_stopReceiveThreads(recv_shm_thread_pt recvThreadData);
 
 celix_status_t remoteServiceAdmin_installEndpoint(remote_service_admin_t *admin, export_registration_t *registration, service_reference_pt reference, char *interface);
 celix_status_t remoteServiceAdmin_createEndpointDescription(remote_service_admin_t *admin, service_reference_pt reference, celix_properties_t *endpointProperties, char *interface, endpoint_description_t **description);
@@ -80,6 +77,10 @@ celix_status_t remoteServiceAdmin_create(celix_bundle_context_t *context, remote
 		(*admin)->importedIpcSegment = hashMap_create(NULL, NULL, NULL, NULL);
 		(*admin)->pollThread = hashMap_create(NULL, NULL, NULL, NULL);
 		(*admin)->pollThreadRunning = hashMap_create(NULL, NULL, NULL, NULL);
+		(*admin)->nrOfSlots = celix_bundleContext_getPropertyAsLong(context, RSA_SHM_SLOTS_PROPERTYNAME, RSA_SHM_SLOTS_DEFAULT);
+		(*admin)->slotSize = celix_bundleContext_getPropertyAsLong(context, RSA_SHM_SLOT_SIZE_PROPERTYNAME, RSA_SHM_SLOT_SIZE_DEFAULT);
+		(*admin)->nrOfReceiveThreads = celix_bundleContext_getPropertyAsLong(context, RSA_SHM_RECEIVE_THREADS_PROPERTYNAME, RSA_SHM_RECEIVE_THREADS_DEFAULT);
+		(*admin)->callTimeoutInMs = celix_bundleContext_getPropertyAsLong(context, RSA_SHM_CALL_TIMEOUT_MS_PROPERTYNAME, RSA_SHM_CALL_TIMEOUT_MS_DEFAULT);
 
 		if (logHelper_create(context, &(*admin)->loghelper) == CELIX_SUCCESS) {
 			logHelper_start((*admin)->loghelper);
@@ -152,32 +153,21 @@ celix_status_t remoteServiceAdmin_stop(remote_service_admin_t *admin) {
 	hashMapIterator_destroy(iter);
 	celixThreadMutex_unlock(&admin->importedServicesLock);
 
-	// set stop-thread-variable
-	iter = hashMapIterator_create(admin->pollThreadRunning);
-	while (hashMapIterator_hasNext(iter)) {
-		bool *pollThreadRunning = hashMapIterator_nextValue(iter);
-		*pollThreadRunning = false;
-	}
-	hashMapIterator_destroy(iter);
-
-	// release lock
-	iter = hashMapIterator_create(admin->exportedIpcSegment);
-	while (hashMapIterator_hasNext(iter)) {
-		ipc_segment_pt ipc = hashMapIterator_nextValue(iter);
-		remoteServiceAdmin_unlock(ipc->semId, 1);
-	}
-	hashMapIterator_destroy(iter);
-
-	// wait till threads has stopped
+	// stop the receive threads
 	iter = hashMapIterator_create(admin->pollThread);
 	while (hashMapIterator_hasNext(iter)) {
-		celix_thread_t *pollThread = hashMapIterator_nextValue(iter);
+		recv_shm_thread_pt recvThreadData = hashMapIterator_nextValue(iter);
 
-		if (pollThread != NULL) {
-			status = celixThread_join(*pollThread, NULL);
+		if (recvThreadData != NULL) {
+			status = remoteServiceAdmin_stopReceiveThreads(recvThreadData);
+			free(recvThreadData->running);
+			free(recvThreadData->threads);
+			free(recvThreadData);
 		}
 	}
 	hashMapIterator_destroy(iter);
+	hashMap_clear(admin->pollThread, false, false);
+	hashMap_clear(admin->pollThreadRunning, false, false);
 
 	iter = hashMapIterator_create(admin->importedIpcSegment);
 	while (hashMapIterator_hasNext(iter)) {
@@ -202,96 +192,20 @@ celix_status_t remoteServiceAdmin_stop(remote_service_admin_t *admin) {
 	return status;
 }
 
-static int remoteServiceAdmin_getCount(int semId, int semNr) {
-	int token = -1;
-	unsigned short semVals[3];
-	union semun semArg;
-
-	semArg.array = semVals;
-
-	if (semctl(semId, 0, GETALL, semArg) == 0) {
-		token = semArg.array[semNr];
-	}
-
-	return token;
-}
-
-static celix_status_t remoteServiceAdmin_lock(int semId, int semNr) {
-	celix_status_t status = CELIX_SUCCESS;
-	int semOpStatus = 0;
-	struct sembuf semOperation;
-
-	semOperation.sem_num = semNr;
-	semOperation.sem_op = -1;
-	semOperation.sem_flg = 0;
-
-	do {
-		status = CELIX_SUCCESS;
-
-		if ((semOpStatus = semop(semId, &semOperation, 1)) != 0) {
-			status = CELIX_BUNDLE_EXCEPTION;
-		}
-	} while (semOpStatus == -1 && errno == EINTR);
-
-	return status;
-}
-
-static celix_status_t remoteServiceAdmin_unlock(int semId, int semNr) {
-	celix_status_t status = CELIX_SUCCESS;
-	int semOpStatus = 0;
-	struct sembuf semOperation;
-
-	semOperation.sem_num = semNr;
-	semOperation.sem_op = 1;
-	semOperation.sem_flg = 0;
-
-	do {
-		status = CELIX_SUCCESS;
-
-		if ((semOpStatus = semop(semId, &semOperation, 1)) != 0) {
-			status = CELIX_BUNDLE_EXCEPTION;
-		}
-	} while (semOpStatus == -1 && errno == EINTR);
-
-	return status;
-}
-
 celix_status_t remoteServiceAdmin_send(remote_service_admin_t *admin, endpoint_description_t *recpEndpoint, char *request, char **reply, int *replyStatus) {
 	celix_status_t status = CELIX_SUCCESS;
 	ipc_segment_pt ipc = NULL;
 
-	if ((ipc = hashMap_get(admin->importedIpcSegment, recpEndpoint->service)) != NULL) {
-		int semid = ipc->semId;
-
-		/* lock critical area */
-		remoteServiceAdmin_lock(semid, 0);
+	if ((ipc = hashMap_get(admin->importedIpcSegment, recpEndpoint->service)) != NULL && ipc->ring != NULL) {
+		size_t replyLength = 0;
+		celix_status_t handleStatus = CELIX_SUCCESS;
 
-		/* write method and data */
-		strcpy(ipc->shmBaseAddress, request);
-
-		/* Check the status of the send-receive semaphore and reset them if not correct */
-		if (remoteServiceAdmin_getCount(ipc->semId, 1) > 0) {
-			semctl(semid, 1, SETVAL, (int) 0);
-		}
-		if (remoteServiceAdmin_getCount(ipc->semId, 2) > 0) {
-			semctl(semid, 2, SETVAL, (int) 0);
+		status = rsaShmRing_call(ipc->ring, request, strlen(request), admin->callTimeoutInMs, reply, &replyLength, &handleStatus);
+		if (status == CELIX_SUCCESS) {
+			*replyStatus = handleStatus;
+		} else {
+			logHelper_log(admin->loghelper, OSGI_LOGSERVICE_ERROR, "send : call of %s failed (request too large or timeout).", recpEndpoint->service);
 		}
-
-		/* Inform receiver we are invoking the remote service */
-		remoteServiceAdmin_unlock(semid, 1);
-
-		/* Wait until the receiver finished his operations */
-		remoteServiceAdmin_lock(semid, 2);
-
-		/* read reply */
-		*reply = strdup(ipc->shmBaseAddress);
-
-		/* TODO: fix replyStatus */
-		*replyStatus = 0;
-
-		/* release critical area */
-		remoteServiceAdmin_unlock(semid, 0);
-
 	} else {
 		status = CELIX_ILLEGAL_STATE; /* could not find ipc segment */
 	}
@@ -299,65 +213,62 @@ celix_status_t remoteServiceAdmin_send(remote_service_admin_t *admin, endpoint_d
 	return status;
 }
 
-static void * remoteServiceAdmin_receiveFromSharedMemory(void *data) {
-	recv_shm_thread_pt thread_data = data;
-
+static celix_status_t remoteServiceAdmin_handleShmRequest(void *handle, const char *request, size_t requestLength, char **reply) {
+	recv_shm_thread_pt thread_data = handle;
 	remote_service_admin_t *admin = thread_data->admin;
 	endpoint_description_t *exportedEndpointDesc = thread_data->endpointDescription;
+	bool found = false;
+	celix_status_t status = CELIX_ILLEGAL_STATE;
 
-	ipc_segment_pt ipc;
-
-	if ((ipc = hashMap_get(admin->exportedIpcSegment, exportedEndpointDesc->service)) != NULL) {
-		bool *pollThreadRunning = hashMap_get(admin->pollThreadRunning, exportedEndpointDesc);
+	hash_map_iterator_pt iter = hashMapIterator_create(admin->exportedServices);
+	while (hashMapIterator_hasNext(iter) && !found) {
+		hash_map_entry_pt entry = hashMapIterator_nextEntry(iter);
+		array_list_pt exports = hashMapEntry_getValue(entry);
+		int expIt = 0;
 
-		while (*pollThreadRunning == true) {
-			if ((remoteServiceAdmin_lock(ipc->semId, 1) == CELIX_SUCCESS) && (*pollThreadRunning == true)) {
+		for (expIt = 0; expIt < arrayList_size(exports) && !found; expIt++) {
+			export_registration_t *export = arrayList_get(exports, expIt);
 
-				// TODO: align data size
-				char *data = calloc(1024, sizeof(*data));
-				strcpy(data, ipc->shmBaseAddress);
+			if ((strcmp(exportedEndpointDesc->service, export->endpointDescription->service) == 0) && (export->endpoint != NULL)) {
+				status = export->endpoint->handleRequest(export->endpoint->endpoint, (char*) request, reply);
+				found = true;
+			}
+		}
+	}
+	hashMapIterator_destroy(iter);
 
-				hash_map_iterator_pt iter = hashMapIterator_create(admin->exportedServices);
+	if (!found) {
+		logHelper_log(admin->loghelper, OSGI_LOGSERVICE_ERROR, "receiveFromSharedMemory : No endpoint set for %s.", exportedEndpointDesc->service);
+	}
 
-				while (hashMapIterator_hasNext(iter)) {
-					hash_map_entry_pt entry = hashMapIterator_nextEntry(iter);
-					array_list_pt exports = hashMapEntry_getValue(entry);
-					int expIt = 0;
+	return status;
+}
 
-					for (expIt = 0; expIt < arrayList_size(exports); expIt++) {
-						export_registration_t *export = arrayList_get(exports, expIt);
+static void * remoteServiceAdmin_receiveFromSharedMemory(void *data) {
+	recv_shm_thread_pt thread_data = data;
 
-						if ((strcmp(exportedEndpointDesc->service, export->endpointDescription->service) == 0) && (export->endpoint != NULL)) {
-							char *reply = NULL;
+	while (__atomic_load_n(thread_data->running, __ATOMIC_ACQUIRE)) {
+		rsaShmRing_serve(thread_data->ring, 1000, remoteServiceAdmin_handleShmRequest, thread_data);
+	}
 
-							/* TODO: fix handling of handleRequest return value*/
-									export->endpoint->handleRequest(export->endpoint->endpoint, data, &reply);
+	return NULL;
+}
 
-									if (reply != NULL) {
-										if ((strlen(reply) * sizeof(char)) >= RSA_SHM_MEMSIZE) {
-											logHelper_log(admin->loghelper, OSGI_LOGSERVICE_ERROR, "receiveFromSharedMemory : size of message bigger than shared memory message. NOT SENDING.");
-										} else {
-											strcpy(ipc->shmBaseAddress, reply);
-										}
-										free(reply);
-									}
-						} else {
-							logHelper_log(admin->loghelper, OSGI_LOGSERVICE_ERROR, "receiveFromSharedMemory : No endpoint set for %s.", export->endpointDescription->service);
-						}
-					}
-				}
-				hashMapIterator_destroy(iter);
-				free(data);
+static celix_status_t remoteServiceAdmin_stopReceiveThreads(recv_shm_thread_pt recvThreadData) {
+	celix_status_t status = CELIX_SUCCESS;
 
-				remoteServiceAdmin_unlock(ipc->semId, 2);
+	__atomic_store_n(recvThreadData->running, false, __ATOMIC_RELEASE);
+	rsaShmRing_wakeup(recvThreadData->ring);
 
-			}
+	for (int i = 0; i < recvThreadData->nrOfThreads; i++) {
+		celix_status_t joinStatus = celixThread_join(recvThreadData->threads[i], NULL);
+		if (joinStatus != CELIX_SUCCESS) {
+			status = joinStatus;
 		}
 	}
+	recvThreadData->nrOfThreads = 0;
 
-	free(data);
-
-	return NULL;
+	return status;
 }
 
 celix_status_t remoteServiceAdmin_getSharedIdentifierFile(remote_service_admin_t *admin, char *fwUuid, char* servicename, char* outFile) {
@@ -531,23 +442,32 @@ celix_status_t remoteServiceAdmin_exportService(remote_service_admin_t *admin, c
 
 				if (remoteServiceAdmin_createOrAttachShm(admin->exportedIpcSegment, admin, registration->endpointDescription, true) == CELIX_SUCCESS) {
 					recv_shm_thread_pt recvThreadData = NULL;
+					ipc_segment_pt ipc = hashMap_get(admin->exportedIpcSegment, registration->endpointDescription->service);
+					int nrOfThreads = admin->nrOfReceiveThreads > 0 ? admin->nrOfReceiveThreads : 1;
 
-					if ((recvThreadData = calloc(1, sizeof(*recvThreadData))) == NULL) {
+					if ((recvThreadData = calloc(1, sizeof(*recvThreadData))) == NULL || (recvThreadData->threads = calloc(nrOfThreads, sizeof(celix_thread_t))) == NULL) {
+						free(recvThreadData);
 						status = CELIX_ENOMEM;
 					} else {
 						recvThreadData->admin = admin;
 						recvThreadData->endpointDescription = registration->endpointDescription;
+						recvThreadData->ring = ipc->ring;
 
-						celix_thread_t* pollThread = calloc(1, sizeof(*pollThread));
 						bool *pollThreadRunningPtr = calloc(1, sizeof(*pollThreadRunningPtr));
 						*pollThreadRunningPtr = true;
+						recvThreadData->running = pollThreadRunningPtr;
 
 						hashMap_put(admin->pollThreadRunning, registration->endpointDescription, pollThreadRunningPtr);
 
-						// start receiving thread
-						status = celixThread_create(pollThread, NULL, remoteServiceAdmin_receiveFromSharedMemory, recvThreadData);
+						// start receiving threads, every thread handles calls from any slot
+						for (int i = 0; i < nrOfThreads && status == CELIX_SUCCESS; i++) {
+							status = celixThread_create(&recvThreadData->threads[i], NULL, remoteServiceAdmin_receiveFromSharedMemory, recvThreadData);
+							if (status == CELIX_SUCCESS) {
+								recvThreadData->nrOfThreads += 1;
+							}
+						}
 
-						hashMap_put(admin->pollThread, registration->endpointDescription, pollThread);
+						hashMap_put(admin->pollThread, registration->endpointDescription, recvThreadData);
 					}
 				}
 			}
@@ -588,19 +508,14 @@ celix_status_t remoteServiceAdmin_removeExportedService(remote_service_admin_t *
 		exportRegistration_close(registration);
 
 		if ((pollThreadRunning = hashMap_get(admin->pollThreadRunning, registration->endpointDescription)) != NULL) {
-			*pollThreadRunning = false;
-
 			if ((ipc = hashMap_get(admin->exportedIpcSegment, registration->endpointDescription->service)) != NULL) {
-				celix_thread_t* pollThread;
-
-				remoteServiceAdmin_unlock(ipc->semId, 1);
+				recv_shm_thread_pt pollThread;
 
 				if ((pollThread = hashMap_get(admin->pollThread, registration->endpointDescription)) != NULL) {
-					status = celixThread_join(*pollThread, NULL);
+					status = remoteServiceAdmin_stopReceiveThreads(pollThread);
 
 					if (status == CELIX_SUCCESS) {
-						semctl(ipc->semId, 1 , IPC_RMID);
-						shmctl(ipc->shmId, IPC_RMID, 0);
+						remoteServiceAdmin_deleteIpcSegment(ipc);
 
 						remoteServiceAdmin_removeSharedIdentityFile(admin, registration->endpointDescription->frameworkUUID, registration->endpointDescription->service);
 
@@ -609,6 +524,7 @@ celix_status_t remoteServiceAdmin_removeExportedService(remote_service_admin_t *
 						hashMap_remove(admin->pollThread, registration->endpointDescription);
 
 						free(pollThreadRunning);
+						free(pollThread->threads);
 						free(pollThread);
 						free(ipc);
 					}
@@ -634,11 +550,16 @@ celix_status_t remoteServiceAdmin_getIpcSegment(remote_service_admin_t *admin, e
 }
 
 celix_status_t remoteServiceAdmin_detachIpcSegment(ipc_segment_pt ipc) {
+	if (ipc->ring != NULL) {
+		rsaShmRing_detach(ipc->ring);
+		ipc->ring = NULL;
+	}
 	return (shmdt(ipc->shmBaseAddress) != -1) ? CELIX_SUCCESS : CELIX_BUNDLE_EXCEPTION;
 }
 
 celix_status_t remoteServiceAdmin_deleteIpcSegment(ipc_segment_pt ipc) {
-	return ((semctl(ipc->semId, 1 /*ignored*/, IPC_RMID) != -1) && (shmctl(ipc->shmId, IPC_RMID, 0) != -1)) ? CELIX_SUCCESS : CELIX_BUNDLE_EXCEPTION;
+	remoteServiceAdmin_detachIpcSegment(ipc);
+	return (shmctl(ipc->shmId, IPC_RMID, 0) != -1) ? CELIX_SUCCESS : CELIX_BUNDLE_EXCEPTION;
 }
 
 celix_status_t remoteServiceAdmin_createOrAttachShm(hash_map_pt ipcSegment, remote_service_admin_t *admin, endpoint_description_t *endpointDescription, bool createIfNotFound) {
@@ -652,21 +573,12 @@ celix_status_t remoteServiceAdmin_createOrAttachShm(hash_map_pt ipcSegment, remo
 	char *shmPath = NULL;
 	char *shmFtokId = NULL;
 
-	char *semPath = NULL;
-	char *semFtokId = NULL;
-
 	if ((shmPath = (char*)properties_get(endpointProperties, (char *) RSA_SHM_PATH_PROPERTYNAME)) == NULL) {
 		logHelper_log(admin->loghelper, OSGI_LOGSERVICE_DEBUG, "No value found for key %s in endpointProperties.", RSA_SHM_PATH_PROPERTYNAME);
 		status = CELIX_BUNDLE_EXCEPTION;
 	} else if ((shmFtokId = (char*)properties_get(endpointProperties, (char *) RSA_SHM_FTOK_ID_PROPERTYNAME)) == NULL) {
 		logHelper_log(admin->loghelper, OSGI_LOGSERVICE_DEBUG, "No value found for key %s in endpointProperties.", RSA_SHM_FTOK_ID_PROPERTYNAME);
 		status = CELIX_BUNDLE_EXCEPTION;
-	} else if ((semPath = (char*)properties_get(endpointProperties, (char *) RSA_SEM_PATH_PROPERTYNAME)) == NULL) {
-		logHelper_log(admin->loghelper, OSGI_LOGSERVICE_DEBUG, "No value found for key %s in endpointProperties.", RSA_SEM_PATH_PROPERTYNAME);
-		status = CELIX_BUNDLE_EXCEPTION;
-	} else if ((semFtokId = (char*)properties_get(endpointProperties, (char *) RSA_SEM_FTOK_ID_PROPERTYNAME)) == NULL) {
-		logHelper_log(admin->loghelper, OSGI_LOGSERVICE_DEBUG, "No value found for key %s in endpointProperties.", RSA_SEM_FTOK_ID_PROPERTYNAME);
-		status = CELIX_BUNDLE_EXCEPTION;
 	} else {
 		key_t shmKey = ftok(shmPath, atoi(shmFtokId));
 		ipc = calloc(1, sizeof(*ipc));
@@ -674,47 +586,50 @@ celix_status_t remoteServiceAdmin_createOrAttachShm(hash_map_pt ipcSegment, remo
 			return CELIX_ENOMEM;
 		}
 
-		if ((ipc->shmId = shmget(shmKey, RSA_SHM_MEMSIZE, 0666)) < 0) {
-			logHelper_log(admin->loghelper, OSGI_LOGSERVICE_WARNING, "Could not attach to shared memory");
+		size_t segmentSize = 0;
+		if (createIfNotFound == true) {
+			/* the exporter always creates a new ring, a stale segment (e.g. of a crashed framework) is removed first */
+			int staleShmId = shmget(shmKey, 0, 0666);
+			if (staleShmId >= 0) {
+				logHelper_log(admin->loghelper, OSGI_LOGSERVICE_WARNING, "Removing existing shared memory segment for %s.", endpointDescription->service);
+				shmctl(staleShmId, IPC_RMID, 0);
+			}
 
-			if (createIfNotFound == true) {
-				if ((ipc->shmId = shmget(shmKey, RSA_SHM_MEMSIZE, IPC_CREAT | 0666)) < 0) {
-					logHelper_log(admin->loghelper, OSGI_LOGSERVICE_ERROR, "Creation of shared memory segment failed.");
-					status = CELIX_BUNDLE_EXCEPTION;
-				} else if ((ipc->shmBaseAddress = shmat(ipc->shmId, 0, 0)) == (char *) -1) {
-					logHelper_log(admin->loghelper, OSGI_LOGSERVICE_ERROR, "Attaching of shared memory segment failed.");
-					status = CELIX_BUNDLE_EXCEPTION;
-				} else {
-					logHelper_log(admin->loghelper, OSGI_LOGSERVICE_INFO, "shared memory segment successfully created at %p.", ipc->shmBaseAddress);
-				}
+			segmentSize = rsaShmRing_segmentSize(admin->nrOfSlots, admin->slotSize);
+			if ((ipc->shmId = shmget(shmKey, segmentSize, IPC_CREAT | 0666)) < 0) {
+				logHelper_log(admin->loghelper, OSGI_LOGSERVICE_ERROR, "Creation of shared memory segment failed.");
+				status = CELIX_BUNDLE_EXCEPTION;
 			}
-		} else if ((ipc->shmBaseAddress = shmat(ipc->shmId, 0, 0)) == (char *) -1) {
-			logHelper_log(admin->loghelper, OSGI_LOGSERVICE_ERROR, "Attaching to shared memory segment failed.");
+		} else if ((ipc->shmId = shmget(shmKey, 0, 0666)) < 0) {
+			logHelper_log(admin->loghelper, OSGI_LOGSERVICE_WARNING, "Could not attach to shared memory");
 			status = CELIX_BUNDLE_EXCEPTION;
 		} else {
-			logHelper_log(admin->loghelper, OSGI_LOGSERVICE_INFO, "successfully attached to shared memory at %p.", ipc->shmBaseAddress);
+			struct shmid_ds shmInfo;
+			if (shmctl(ipc->shmId, IPC_STAT, &shmInfo) == 0) {
+				segmentSize = shmInfo.shm_segsz;
+			}
 		}
-	}
-
-	if(ipc != NULL && status == CELIX_SUCCESS){
 
-		key_t semkey = ftok(semPath, atoi(semFtokId));
-		int semflg = (createIfNotFound == true) ? (0666 | IPC_CREAT) : (0666);
-		int semid = semget(semkey, 3, semflg);
+		if (status == CELIX_SUCCESS && (ipc->shmBaseAddress = shmat(ipc->shmId, 0, 0)) == (char *) -1) {
+			logHelper_log(admin->loghelper, OSGI_LOGSERVICE_ERROR, "Attaching to shared memory segment failed.");
+			status = CELIX_BUNDLE_EXCEPTION;
+		}
 
-		if (semid != -1) {
-			// only reset semaphores if a create was supposed
-			if ((createIfNotFound == true) && ((semctl(semid, 0, SETVAL, (int) 1) == -1) || (semctl(semid, 1, SETVAL, (int) 0) == -1) || (semctl(semid, 2, SETVAL, (int) 0) == -1))) {
-				logHelper_log(admin->loghelper, OSGI_LOGSERVICE_ERROR, "error while initialize semaphores.");
+		if (status == CELIX_SUCCESS) {
+			if (createIfNotFound == true) {
+				ipc->ring = rsaShmRing_create(ipc->shmBaseAddress, segmentSize, admin->nrOfSlots, admin->slotSize);
+			} else {
+				ipc->ring = rsaShmRing_attach(ipc->shmBaseAddress, segmentSize);
 			}
 
-			logHelper_log(admin->loghelper, OSGI_LOGSERVICE_DEBUG, "semaphores w/ key %s and id %i added.", endpointDescription->service, semid);
-			ipc->semId = semid;
-
-			hashMap_put(ipcSegment, endpointDescription->service, ipc);
-		} else {
-			logHelper_log(admin->loghelper, OSGI_LOGSERVICE_ERROR, "error getting semaphores.");
-			status = CELIX_BUNDLE_EXCEPTION;
+			if (ipc->ring == NULL) {
+				logHelper_log(admin->loghelper, OSGI_LOGSERVICE_ERROR, "No valid call ring in shared memory segment for %s.", endpointDescription->service);
+				shmdt(ipc->shmBaseAddress);
+				status = CELIX_BUNDLE_EXCEPTION;
+			} else {
+				logHelper_log(admin->loghelper, OSGI_LOGSERVICE_INFO, "shared memory segment (%zu bytes) for %s successfully %s at %p.", segmentSize, endpointDescription->service, createIfNotFound ? "created" : "attached", ipc->shmBaseAddress);
+				hashMap_put(ipcSegment, endpointDescription->service, ipc);
+			}
 		}
 	}
 
@@ -742,10 +657,8 @@ celix_status_t remoteServiceAdmin_installEndpoint(remote_service_admin_t *admin,
 		}
 	}
 
-	hash_map_entry_pt entry = hashMap_getEntry(endpointProperties, (void *) OSGI_FRAMEWORK_SERVICE_ID);
-
-	char* key = hashMapEntry_getKey(entry);
-	char *serviceId = (char *) hashMap_remove(endpointProperties, (void *) OSGI_FRAMEWORK_SERVICE_ID);
+	char *serviceId = strndup(celix_properties_get(endpointProperties, OSGI_FRAMEWORK_SERVICE_ID, ""), 1024);
+	celix_properties_unset(endpointProperties, OSGI_FRAMEWORK_SERVICE_ID);
 	const char *uuid = NULL;
 
 	uuid_t endpoint_uid;
@@ -773,24 +686,11 @@ celix_status_t remoteServiceAdmin_installEndpoint(remote_service_admin_t *admin,
 	if (celix_properties_get(endpointProperties, (char *) RSA_SHM_FTOK_ID_PROPERTYNAME, NULL) == NULL) {
 		celix_properties_set(endpointProperties, (char *) RSA_SHM_FTOK_ID_PROPERTYNAME, (char *) RSA_SHM_DEFAULT_FTOK_ID);
 	}
-	if (celix_properties_get(endpointProperties, (char *) RSA_SEM_PATH_PROPERTYNAME, NULL) == NULL) {
-		char sharedIdentifierFile[RSA_FILEPATH_LENGTH];
-
-		if (remoteServiceAdmin_getSharedIdentifierFile(admin, (char*)uuid, interface, sharedIdentifierFile) == CELIX_SUCCESS) {
-			celix_properties_set(endpointProperties, (char *) RSA_SEM_PATH_PROPERTYNAME, sharedIdentifierFile);
-		} else {
-			celix_properties_set(endpointProperties, (char *) RSA_SEM_PATH_PROPERTYNAME, (char *) RSA_SEM_DEFAULTPATH);
-		}
-	}
-	if (celix_properties_get(endpointProperties, (char *) RSA_SEM_FTOK_ID_PROPERTYNAME, NULL) == NULL) {
-		celix_properties_set(endpointProperties, (char *) RSA_SEM_FTOK_ID_PROPERTYNAME, (char *) RSA_SEM_DEFAULT_FTOK_ID);
-	}
 
 	endpoint_description_t *endpointDescription = NULL;
 	remoteServiceAdmin_createEndpointDescription(admin, reference, endpointProperties, interface, &endpointDescription);
 	exportRegistration_setEndpointDescription(registration, endpointDescription);
 
-	free(key);
 	free(serviceId);
 	free(keys);
 
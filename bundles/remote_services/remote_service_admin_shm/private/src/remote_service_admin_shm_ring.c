@@ -0,0 +1,306 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *  KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+#include <time.h>
+#include <unistd.h>
+#ifdef __linux__
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#endif
+
+#include "remote_service_admin_shm_ring.h"
+
+#define RSA_SHM_RING_MAGIC      0x52534852 //"RHSR"
+#define RSA_SHM_RING_VERSION    1
+
+enum rsa_shm_ring_slot_state {
+    RSA_SHM_RING_SLOT_FREE = 0,
+    RSA_SHM_RING_SLOT_CLAIMED = 1,
+    RSA_SHM_RING_SLOT_REQUEST = 2,
+    RSA_SHM_RING_SLOT_PROCESSING = 3,
+    RSA_SHM_RING_SLOT_REPLY = 4,
+    RSA_SHM_RING_SLOT_ABANDONED = 5, //caller timed out during processing, the receiver frees the slot
+};
+
+/**
+ * Control block at the start of the segment, followed by the slots.
+ */
+typedef struct rsa_shm_ring_control {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t nrOfSlots;
+    uint32_t slotSize;
+
+    uint32_t nextSlot __attribute__((aligned(64))); //round robin start index for claiming a slot
+    uint32_t requestSeq __attribute__((aligned(64))); //futex word for the receive threads
+    uint32_t requestWaiters;
+    uint32_t freeSeq __attribute__((aligned(64))); //futex word for callers waiting on a free slot
+    uint32_t freeWaiters;
+} __attribute__((aligned(64))) rsa_shm_ring_control_t;
+
+/**
+ * Slot header, followed by slotSize bytes for the request/reply and its NUL terminator.
+ */
+typedef struct rsa_shm_ring_slot {
+    uint32_t state; //futex word for the caller waiting on the reply
+    int32_t status;
+    uint64_t length;
+} __attribute__((aligned(64))) rsa_shm_ring_slot_t;
+
+struct rsa_shm_ring {
+    rsa_shm_ring_control_t *control;
+    char *slots;
+    size_t slotStride;
+    uint32_t serveIndex; //scan start index of the receive threads, not shared
+};
+
+static size_t rsaShmRing_slotStride(uint32_t slotSize) {
+    size_t stride = sizeof(rsa_shm_ring_slot_t) + slotSize + 1;
+    return (stride + 63) & ~((size_t)63);
+}
+
+size_t rsaShmRing_segmentSize(uint32_t nrOfSlots, uint32_t slotSize) {
+    return sizeof(rsa_shm_ring_control_t) + nrOfSlots * rsaShmRing_slotStride(slotSize);
+}
+
+static rsa_shm_ring_slot_t* rsaShmRing_slot(rsa_shm_ring_t *ring, uint32_t index) {
+    return (rsa_shm_ring_slot_t*)(ring->slots + index * ring->slotStride);
+}
+
+static char* rsaShmRing_slotData(rsa_shm_ring_slot_t *slot) {
+    return (char*)(slot + 1);
+}
+
+static void rsaShmRing_futexWait(uint32_t *addr, uint32_t val, unsigned int timeoutInMs) {
+#ifdef __linux__
+    struct timespec ts;
+    ts.tv_sec = timeoutInMs / 1000;
+    ts.tv_nsec = (long)(timeoutInMs % 1000) * 1000000L;
+    //note no FUTEX_PRIVATE_FLAG, the futex word is shared between processes
+    syscall(SYS_futex, addr, FUTEX_WAIT, val, &ts, NULL, 0);
+#else
+    (void)addr;
+    (void)val;
+    (void)timeoutInMs;
+    struct timespec ts = {0, 100000L};
+    nanosleep(&ts, NULL);
+#endif
+}
+
+static void rsaShmRing_futexWake(uint32_t *addr, int nrOfWaiters) {
+#ifdef __linux__
+    syscall(SYS_futex, addr, FUTEX_WAKE, nrOfWaiters, NULL, NULL, 0);
+#else
+    (void)addr;
+    (void)nrOfWaiters;
+#endif
+}
+
+static void rsaShmRing_signal(uint32_t *seq, uint32_t *waiters, int nrOfWaiters) {
+    __atomic_add_fetch(seq, 1, __ATOMIC_SEQ_CST);
+    if (__atomic_load_n(waiters, __ATOMIC_SEQ_CST) > 0) {
+        rsaShmRing_futexWake(seq, nrOfWaiters);
+    }
+}
+
+static long rsaShmRing_remainingMs(const struct timespec *deadline) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (deadline->tv_sec - now.tv_sec) * 1000L + (deadline->tv_nsec - now.tv_nsec) / 1000000L;
+}
+
+rsa_shm_ring_t* rsaShmRing_create(void *segment, size_t segmentSize, uint32_t nrOfSlots, uint32_t slotSize) {
+    if (segment == NULL || nrOfSlots == 0 || slotSize == 0 || segmentSize < rsaShmRing_segmentSize(nrOfSlots, slotSize)) {
+        return NULL;
+    }
+    rsa_shm_ring_control_t *control = segment;
+    memset(control, 0, sizeof(*control));
+    control->version = RSA_SHM_RING_VERSION;
+    control->nrOfSlots = nrOfSlots;
+    control->slotSize = slotSize;
+    memset((char*)segment + sizeof(*control), 0, nrOfSlots * rsaShmRing_slotStride(slotSize));
+    __atomic_store_n(&control->magic, RSA_SHM_RING_MAGIC, __ATOMIC_RELEASE);
+    return rsaShmRing_attach(segment, segmentSize);
+}
+
+rsa_shm_ring_t* rsaShmRing_attach(void *segment, size_t segmentSize) {
+    rsa_shm_ring_control_t *control = segment;
+    if (control == NULL || segmentSize < sizeof(*control) ||
+            __atomic_load_n(&control->magic, __ATOMIC_ACQUIRE) != RSA_SHM_RING_MAGIC ||
+            control->version != RSA_SHM_RING_VERSION ||
+            segmentSize < rsaShmRing_segmentSize(control->nrOfSlots, control->slotSize)) {
+        return NULL;
+    }
+    rsa_shm_ring_t *ring = calloc(1, sizeof(*ring));
+    if (ring != NULL) {
+        ring->control = control;
+        ring->slots = (char*)segment + sizeof(*control);
+        ring->slotStride = rsaShmRing_slotStride(control->slotSize);
+    }
+    return ring;
+}
+
+void rsaShmRing_detach(rsa_shm_ring_t *ring) {
+    free(ring);
+}
+
+size_t rsaShmRing_maxMessageLength(const rsa_shm_ring_t *ring) {
+    return ring->control->slotSize;
+}
+
+static void rsaShmRing_releaseSlot(rsa_shm_ring_t *ring, rsa_shm_ring_slot_t *slot) {
+    __atomic_store_n(&slot->state, RSA_SHM_RING_SLOT_FREE, __ATOMIC_RELEASE);
+    rsaShmRing_signal(&ring->control->freeSeq, &ring->control->freeWaiters, 1);
+}
+
+static rsa_shm_ring_slot_t* rsaShmRing_claimSlot(rsa_shm_ring_t *ring, const struct timespec *deadline) {
+    rsa_shm_ring_control_t *control = ring->control;
+    while (true) {
+        uint32_t seq = __atomic_load_n(&control->freeSeq, __ATOMIC_SEQ_CST);
+        for (uint32_t i = 0; i < control->nrOfSlots; ++i) {
+            uint32_t index = __atomic_fetch_add(&control->nextSlot, 1, __ATOMIC_RELAXED) % control->nrOfSlots;
+            rsa_shm_ring_slot_t *slot = rsaShmRing_slot(ring, index);
+            uint32_t expected = RSA_SHM_RING_SLOT_FREE;
+            if (__atomic_compare_exchange_n(&slot->state, &expected, RSA_SHM_RING_SLOT_CLAIMED, false, __ATOMIC_ACQUIRE, __ATOMIC_RELAXED)) {
+                return slot;
+            }
+        }
+        long remaining = rsaShmRing_remainingMs(deadline);
+        if (remaining <= 0) {
+            return NULL;
+        }
+        __atomic_add_fetch(&control->freeWaiters, 1, __ATOMIC_SEQ_CST);
+        rsaShmRing_futexWait(&control->freeSeq, seq, (unsigned int)remaining);
+        __atomic_sub_fetch(&control->freeWaiters, 1, __ATOMIC_SEQ_CST);
+    }
+}
+
+celix_status_t rsaShmRing_call(rsa_shm_ring_t *ring, const char *request, size_t requestLength, unsigned int timeoutInMs, char **reply, size_t *replyLength, celix_status_t *replyStatus) {
+    if (requestLength > ring->control->slotSize) {
+        return CELIX_ILLEGAL_ARGUMENT;
+    }
+
+    struct timespec deadline;
+    clock_gettime(CLOCK_MONOTONIC, &deadline);
+    deadline.tv_sec += timeoutInMs / 1000;
+    deadline.tv_nsec += (long)(timeoutInMs % 1000) * 1000000L;
+    if (deadline.tv_nsec >= 1000000000L) {
+        deadline.tv_sec += 1;
+        deadline.tv_nsec -= 1000000000L;
+    }
+
+    rsa_shm_ring_slot_t *slot = rsaShmRing_claimSlot(ring, &deadline);
+    if (slot == NULL) {
+        return CELIX_ILLEGAL_STATE;
+    }
+
+    char *data = rsaShmRing_slotData(slot);
+    memcpy(data, request, requestLength);
+    data[requestLength] = '\0';
+    slot->length = requestLength;
+    __atomic_store_n(&slot->state, RSA_SHM_RING_SLOT_REQUEST, __ATOMIC_RELEASE);
+    rsaShmRing_signal(&ring->control->requestSeq, &ring->control->requestWaiters, 1);
+
+    uint32_t state;
+    while ((state = __atomic_load_n(&slot->state, __ATOMIC_ACQUIRE)) != RSA_SHM_RING_SLOT_REPLY) {
+        long remaining = rsaShmRing_remainingMs(&deadline);
+        if (remaining > 0) {
+            rsaShmRing_futexWait(&slot->state, state, (unsigned int)remaining);
+        } else if (state == RSA_SHM_RING_SLOT_REQUEST) {
+            //not taken yet, withdraw the request
+            if (__atomic_compare_exchange_n(&slot->state, &state, RSA_SHM_RING_SLOT_CLAIMED, false, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)) {
+                rsaShmRing_releaseSlot(ring, slot);
+                return CELIX_ILLEGAL_STATE;
+            }
+        } else if (state == RSA_SHM_RING_SLOT_PROCESSING) {
+            //in progress, the receiver releases the slot when done
+            if (__atomic_compare_exchange_n(&slot->state, &state, RSA_SHM_RING_SLOT_ABANDONED, false, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)) {
+                return CELIX_ILLEGAL_STATE;
+            }
+        }
+    }
+
+    *replyStatus = slot->status;
+    *replyLength = slot->length;
+    *reply = malloc(slot->length + 1);
+    celix_status_t status = CELIX_SUCCESS;
+    if (*reply != NULL) {
+        memcpy(*reply, data, slot->length + 1);
+    } else {
+        status = CELIX_ENOMEM;
+    }
+    rsaShmRing_releaseSlot(ring, slot);
+    return status;
+}
+
+static void rsaShmRing_handle(rsa_shm_ring_t *ring, rsa_shm_ring_slot_t *slot, rsa_shm_ring_handle_request_fp handleRequest, void *handle) {
+    char *data = rsaShmRing_slotData(slot);
+    char *reply = NULL;
+    celix_status_t status = handleRequest(handle, data, slot->length, &reply);
+
+    size_t length = reply != NULL ? strlen(reply) : 0;
+    if (length > ring->control->slotSize) {
+        status = CELIX_ILLEGAL_ARGUMENT;
+        length = 0;
+    }
+    if (length > 0) {
+        memcpy(data, reply, length);
+    }
+    data[length] = '\0';
+    slot->length = length;
+    slot->status = status;
+    free(reply);
+
+    uint32_t expected = RSA_SHM_RING_SLOT_PROCESSING;
+    if (__atomic_compare_exchange_n(&slot->state, &expected, RSA_SHM_RING_SLOT_REPLY, false, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)) {
+        rsaShmRing_futexWake(&slot->state, 1);
+    } else {
+        //abandoned by the caller
+        rsaShmRing_releaseSlot(ring, slot);
+    }
+}
+
+celix_status_t rsaShmRing_serve(rsa_shm_ring_t *ring, unsigned int timeoutInMs, rsa_shm_ring_handle_request_fp handleRequest, void *handle) {
+    rsa_shm_ring_control_t *control = ring->control;
+    uint32_t seq = __atomic_load_n(&control->requestSeq, __ATOMIC_SEQ_CST);
+    uint32_t start = __atomic_fetch_add(&ring->serveIndex, 1, __ATOMIC_RELAXED);
+    for (uint32_t i = 0; i < control->nrOfSlots; ++i) {
+        rsa_shm_ring_slot_t *slot = rsaShmRing_slot(ring, (start + i) % control->nrOfSlots);
+        uint32_t expected = RSA_SHM_RING_SLOT_REQUEST;
+        if (__atomic_load_n(&slot->state, __ATOMIC_RELAXED) == RSA_SHM_RING_SLOT_REQUEST &&
+                __atomic_compare_exchange_n(&slot->state, &expected, RSA_SHM_RING_SLOT_PROCESSING, false, __ATOMIC_ACQUIRE, __ATOMIC_RELAXED)) {
+            rsaShmRing_handle(ring, slot, handleRequest, handle);
+            return CELIX_SUCCESS;
+        }
+    }
+
+    __atomic_add_fetch(&control->requestWaiters, 1, __ATOMIC_SEQ_CST);
+    rsaShmRing_futexWait(&control->requestSeq, seq, timeoutInMs);
+    __atomic_sub_fetch(&control->requestWaiters, 1, __ATOMIC_SEQ_CST);
+    return CELIX_ILLEGAL_STATE;
+}
+
+void rsaShmRing_wakeup(rsa_shm_ring_t *ring) {
+    __atomic_add_fetch(&ring->control->requestSeq, 1, __ATOMIC_SEQ_CST);
+    rsaShmRing_futexWake(&ring->control->requestSeq, INT_MAX);
+}
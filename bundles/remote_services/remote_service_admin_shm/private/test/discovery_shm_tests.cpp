@@ -0,0 +1,165 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *  KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <chrono>
+#include <map>
+#include <string>
+#include <thread>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <CppUTest/TestHarness.h>
+
+extern "C" {
+#include "discovery_shm.h"
+}
+
+namespace {
+    using entries_t = std::map<std::string, std::pair<std::string, bool>>;
+
+    void addEntry(void *handle, const char *key, const char *value, bool changed) {
+        (*static_cast<entries_t*>(handle))[key] = {value, changed};
+    }
+
+    long elapsedInMs(std::chrono::steady_clock::time_point start) {
+        return (long)std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count();
+    }
+}
+
+TEST_GROUP(DiscoveryShmTests) {
+    shmData_t *data = nullptr;
+
+    void setup() {
+        CHECK_EQUAL(CELIX_SUCCESS, discoveryShm_create(&data));
+    }
+
+    void teardown() {
+        discoveryShm_destroy(data);
+    }
+
+    void set(const char *key, const char *value) {
+        CHECK_EQUAL(CELIX_SUCCESS, discoveryShm_set(data, (char *) key, (char *) value));
+    }
+};
+
+TEST(DiscoveryShmTests, changesBumpGeneration) {
+    uint32_t generation = discoveryShm_getGeneration(data);
+    set("fw1", "http://localhost:1");
+    CHECK(discoveryShm_getGeneration(data) != generation);
+
+    //a ttl refresh with the same value does not wake the watchers
+    generation = discoveryShm_getGeneration(data);
+    set("fw1", "http://localhost:1");
+    CHECK_EQUAL(generation, discoveryShm_getGeneration(data));
+
+    set("fw1", "http://localhost:2");
+    CHECK(discoveryShm_getGeneration(data) != generation);
+
+    generation = discoveryShm_getGeneration(data);
+    CHECK_EQUAL(CELIX_SUCCESS, discoveryShm_remove(data, (char *) "fw1"));
+    CHECK(discoveryShm_getGeneration(data) != generation);
+    CHECK(discoveryShm_remove(data, (char *) "fw1") != CELIX_SUCCESS);
+}
+
+TEST(DiscoveryShmTests, entriesReportChangesSinceGeneration) {
+    set("fw1", "http://localhost:1");
+    set("fw2", "http://localhost:2");
+
+    entries_t entries{};
+    uint32_t generation = 0;
+    CHECK_EQUAL(CELIX_SUCCESS, discoveryShm_getEntries(data, 0, addEntry, &entries, &generation));
+    CHECK_EQUAL(2, (int)entries.size());
+    CHECK(entries["fw1"].second);
+    CHECK(entries["fw2"].second);
+    CHECK_EQUAL(discoveryShm_getGeneration(data), generation);
+
+    set("fw2", "http://localhost:3");
+    entries.clear();
+    CHECK_EQUAL(CELIX_SUCCESS, discoveryShm_getEntries(data, generation, addEntry, &entries, &generation));
+    CHECK_EQUAL(2, (int)entries.size());
+    CHECK(!entries["fw1"].second);
+    CHECK(entries["fw2"].second);
+    STRCMP_EQUAL("http://localhost:3", entries["fw2"].first.c_str());
+
+    discoveryShm_remove(data, (char *) "fw1");
+    discoveryShm_remove(data, (char *) "fw2");
+}
+
+TEST(DiscoveryShmTests, waitForChangeTimesOut) {
+    auto start = std::chrono::steady_clock::now();
+    CHECK_EQUAL(CELIX_ILLEGAL_STATE, discoveryShm_waitForChange(data, discoveryShm_getGeneration(data), 50));
+    CHECK(elapsedInMs(start) >= 40);
+
+    //an already changed generation returns without waiting
+    start = std::chrono::steady_clock::now();
+    CHECK_EQUAL(CELIX_SUCCESS, discoveryShm_waitForChange(data, discoveryShm_getGeneration(data) - 1, 5000));
+    CHECK(elapsedInMs(start) < 1000);
+}
+
+TEST(DiscoveryShmTests, waitForChangeWokenBySet) {
+    uint32_t generation = discoveryShm_getGeneration(data);
+    std::thread setter{[this]{
+        std::this_thread::sleep_for(std::chrono::milliseconds{50});
+        set("fw1", "http://localhost:1");
+    }};
+    auto start = std::chrono::steady_clock::now();
+    CHECK_EQUAL(CELIX_SUCCESS, discoveryShm_waitForChange(data, generation, 5000));
+    CHECK(elapsedInMs(start) < 2000);
+    setter.join();
+
+    //notify wakes a watcher without changing an entry, e.g. to stop the watcher thread
+    generation = discoveryShm_getGeneration(data);
+    std::thread notifier{[this]{
+        std::this_thread::sleep_for(std::chrono::milliseconds{50});
+        discoveryShm_notify(data);
+    }};
+    start = std::chrono::steady_clock::now();
+    CHECK_EQUAL(CELIX_SUCCESS, discoveryShm_waitForChange(data, generation, 5000));
+    CHECK(elapsedInMs(start) < 2000);
+    notifier.join();
+
+    discoveryShm_remove(data, (char *) "fw1");
+}
+
+TEST(DiscoveryShmTests, waitForChangeWokenByOtherProcess) {
+    uint32_t generation = discoveryShm_getGeneration(data);
+    pid_t pid = fork();
+    if (pid == 0) {
+        shmData_t *other = nullptr;
+        usleep(50000);
+        int rc = discoveryShm_attach(&other) == CELIX_SUCCESS ? 0 : 1;
+        if (rc == 0) {
+            rc = discoveryShm_set(other, (char *) "fw2", (char *) "http://localhost:2") == CELIX_SUCCESS ? 0 : 1;
+        }
+        _exit(rc);
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    CHECK_EQUAL(CELIX_SUCCESS, discoveryShm_waitForChange(data, generation, 5000));
+    CHECK(elapsedInMs(start) < 2000);
+    int status = 0;
+    CHECK_EQUAL(pid, waitpid(pid, &status, 0));
+    CHECK(WIFEXITED(status));
+    CHECK_EQUAL(0, WEXITSTATUS(status));
+
+    char value[SHM_ENTRY_MAX_VALUE_LENGTH];
+    CHECK_EQUAL(CELIX_SUCCESS, discoveryShm_get(data, (char *) "fw2", value));
+    STRCMP_EQUAL("http://localhost:2", value);
+    discoveryShm_remove(data, (char *) "fw2");
+}
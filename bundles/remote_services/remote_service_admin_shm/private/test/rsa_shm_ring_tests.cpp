@@ -0,0 +1,226 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *  KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <thread>
+#include <vector>
+#include <cstdlib>
+#include <cstring>
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <CppUTest/TestHarness.h>
+
+extern "C" {
+#include "remote_service_admin_shm_ring.h"
+}
+
+namespace {
+    struct server {
+        rsa_shm_ring_t *ring;
+        std::atomic<bool> running{true};
+        std::atomic<int> nrOfHandled{0};
+        std::chrono::milliseconds delay{0};
+        std::vector<std::thread> threads{};
+
+        server(rsa_shm_ring_t *r, int nrOfThreads, std::chrono::milliseconds d = std::chrono::milliseconds{0}) : ring{r}, delay{d} {
+            for (int i = 0; i < nrOfThreads; ++i) {
+                threads.emplace_back([this]{
+                    while (running) {
+                        rsaShmRing_serve(ring, 1000, handleRequest, this);
+                    }
+                });
+            }
+        }
+
+        ~server() {
+            running = false;
+            rsaShmRing_wakeup(ring);
+            for (auto &t : threads) {
+                t.join();
+            }
+        }
+
+        //echoes the request with a "reply:" prefix, a request "large:<n>" gets a reply of n bytes
+        static celix_status_t handleRequest(void *handle, const char *request, size_t requestLength, char **reply) {
+            auto *srv = static_cast<server*>(handle);
+            if (srv->delay.count() > 0) {
+                std::this_thread::sleep_for(srv->delay);
+            }
+            srv->nrOfHandled += 1;
+            CHECK_EQUAL(strlen(request), requestLength);
+            std::string result{};
+            if (strncmp(request, "large:", 6) == 0) {
+                result.assign((size_t)atoi(request + 6), 'x');
+            } else {
+                result = std::string{"reply:"} + request;
+            }
+            *reply = strdup(result.c_str());
+            return CELIX_SUCCESS;
+        }
+    };
+
+    celix_status_t call(rsa_shm_ring_t *ring, const std::string &request, unsigned int timeoutInMs, std::string &reply) {
+        char *r = nullptr;
+        size_t length = 0;
+        celix_status_t replyStatus = CELIX_SUCCESS;
+        celix_status_t status = rsaShmRing_call(ring, request.c_str(), request.size(), timeoutInMs, &r, &length, &replyStatus);
+        if (status == CELIX_SUCCESS) {
+            CHECK_EQUAL(strlen(r), length);
+            reply = r;
+            free(r);
+            status = replyStatus;
+        }
+        return status;
+    }
+}
+
+TEST_GROUP(RsaShmRingTests) {
+    void *segment = nullptr;
+    size_t segmentSize = 0;
+    rsa_shm_ring_t *ring = nullptr; //detached after the receive threads of the test are stopped
+
+    void createSegment(uint32_t nrOfSlots, uint32_t slotSize) {
+        segmentSize = rsaShmRing_segmentSize(nrOfSlots, slotSize);
+        //shared, so that a forked process uses the same ring
+        segment = mmap(nullptr, segmentSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+        CHECK(segment != MAP_FAILED);
+    }
+
+    void teardown() {
+        rsaShmRing_detach(ring);
+        if (segment != nullptr) {
+            munmap(segment, segmentSize);
+        }
+    }
+};
+
+TEST(RsaShmRingTests, createAndAttach) {
+    createSegment(4, 128);
+    CHECK(rsaShmRing_create(segment, segmentSize - 1, 4, 128) == nullptr);
+    CHECK(rsaShmRing_create(segment, segmentSize, 0, 128) == nullptr);
+    CHECK(rsaShmRing_attach(segment, segmentSize) == nullptr);
+
+    ring = rsaShmRing_create(segment, segmentSize, 4, 128);
+    CHECK(ring != nullptr);
+    CHECK_EQUAL(128, rsaShmRing_maxMessageLength(ring));
+    rsa_shm_ring_t *attached = rsaShmRing_attach(segment, segmentSize);
+    CHECK(attached != nullptr);
+    CHECK_EQUAL(128, rsaShmRing_maxMessageLength(attached));
+    CHECK(rsaShmRing_attach(segment, segmentSize - 1) == nullptr);
+    rsaShmRing_detach(attached);
+}
+
+TEST(RsaShmRingTests, concurrentCalls) {
+    createSegment(4, 128);
+    ring = rsaShmRing_create(segment, segmentSize, 4, 128);
+    server srv{ring, 2};
+
+    //more callers than slots, callers wait for a free slot
+    constexpr int NR_OF_CALLERS = 8;
+    constexpr int NR_OF_CALLS = 200;
+    std::atomic<int> nrOfFailures{0};
+    std::vector<std::thread> callers{};
+    for (int c = 0; c < NR_OF_CALLERS; ++c) {
+        callers.emplace_back([&, c]{
+            for (int i = 0; i < NR_OF_CALLS; ++i) {
+                std::string request = std::to_string(c) + "/" + std::to_string(i);
+                std::string reply{};
+                if (call(ring, request, 5000, reply) != CELIX_SUCCESS || reply != "reply:" + request) {
+                    nrOfFailures += 1;
+                }
+            }
+        });
+    }
+    for (auto &t : callers) {
+        t.join();
+    }
+    CHECK_EQUAL(0, nrOfFailures.load());
+    CHECK_EQUAL(NR_OF_CALLERS * NR_OF_CALLS, srv.nrOfHandled.load());
+}
+
+TEST(RsaShmRingTests, messagesLargerThanSlotRejected) {
+    createSegment(2, 64);
+    ring = rsaShmRing_create(segment, segmentSize, 2, 64);
+    server srv{ring, 1};
+
+    std::string reply{};
+    CHECK_EQUAL(CELIX_ILLEGAL_ARGUMENT, call(ring, std::string(65, 'r'), 1000, reply));
+    CHECK_EQUAL(CELIX_SUCCESS, call(ring, "large:64", 1000, reply));
+    CHECK_EQUAL(64, reply.size());
+    CHECK_EQUAL(CELIX_ILLEGAL_ARGUMENT, call(ring, "large:65", 1000, reply));
+
+    //the slots are still usable
+    CHECK_EQUAL(CELIX_SUCCESS, call(ring, "next", 1000, reply));
+    STRCMP_EQUAL("reply:next", reply.c_str());
+}
+
+TEST(RsaShmRingTests, timeoutReleasesSlot) {
+    createSegment(1, 64);
+    ring = rsaShmRing_create(segment, segmentSize, 1, 64);
+
+    //no receive thread, the request is withdrawn
+    std::string reply{};
+    CHECK_EQUAL(CELIX_ILLEGAL_STATE, call(ring, "lost", 20, reply));
+
+    {
+        //a slow receive thread, the caller abandons the slot and the receive thread releases it
+        server srv{ring, 1, std::chrono::milliseconds{200}};
+        CHECK_EQUAL(CELIX_ILLEGAL_STATE, call(ring, "slow", 50, reply));
+        CHECK_EQUAL(CELIX_SUCCESS, call(ring, "next", 5000, reply));
+        STRCMP_EQUAL("reply:next", reply.c_str());
+        CHECK_EQUAL(2, srv.nrOfHandled.load());
+    }
+}
+
+TEST(RsaShmRingTests, wakeupServe) {
+    createSegment(1, 64);
+    ring = rsaShmRing_create(segment, segmentSize, 1, 64);
+    auto start = std::chrono::steady_clock::now();
+    std::thread waker{[this]{
+        std::this_thread::sleep_for(std::chrono::milliseconds{50});
+        rsaShmRing_wakeup(ring);
+    }};
+    CHECK_EQUAL(CELIX_ILLEGAL_STATE, rsaShmRing_serve(ring, 10000, server::handleRequest, nullptr));
+    waker.join();
+    CHECK(std::chrono::steady_clock::now() - start < std::chrono::seconds{5});
+}
+
+TEST(RsaShmRingTests, callFromOtherProcess) {
+    createSegment(2, 64);
+    ring = rsaShmRing_create(segment, segmentSize, 2, 64);
+    server srv{ring, 1};
+
+    pid_t pid = fork();
+    if (pid == 0) {
+        rsa_shm_ring_t *attached = rsaShmRing_attach(segment, segmentSize);
+        std::string reply{};
+        bool ok = attached != nullptr && call(attached, "child", 5000, reply) == CELIX_SUCCESS && reply == "reply:child";
+        _exit(ok ? 0 : 1);
+    }
+    CHECK(pid > 0);
+    int wstatus = 0;
+    CHECK_EQUAL(pid, waitpid(pid, &wstatus, 0));
+    CHECK(WIFEXITED(wstatus));
+    CHECK_EQUAL(0, WEXITSTATUS(wstatus));
+    CHECK_EQUAL(1, srv.nrOfHandled.load());
+}
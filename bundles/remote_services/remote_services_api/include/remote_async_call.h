@@ -0,0 +1,60 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *  KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#ifndef REMOTE_ASYNC_CALL_H_
+#define REMOTE_ASYNC_CALL_H_
+
+/**
+ * Imported (remote) services can also be used asynchronously. Next to the imported service, the remote service admin
+ * registers an async variant of the service under the service name with the REMOTE_ASYNC_SERVICE_NAME_SUFFIX.
+ *
+ * The methods of the async variant have the arguments of the methods of the service, with an extra trailing
+ * remote_async_call_t ** output argument. e.g. for a service method:
+ *     int (*add)(void *handle, double a, double b, double *result);
+ * the async variant is:
+ *     int (*add)(void *handle, double a, double b, double *result, remote_async_call_t **call);
+ *
+ * An async method returns directly after the call is sent; a return value of 0 means the call handle is set.
+ * The output arguments are set by the wait of the call handle, so they must stay valid till the wait returns
+ * or the call is destroyed. The async service must not be released before its calls are destroyed.
+ * Calls of the same or of different remote services are in flight concurrently, e.g. calling a service on N nodes and
+ * then waiting for all calls takes one round trip instead of N.
+ */
+#define REMOTE_ASYNC_SERVICE_NAME_SUFFIX    ".async"
+
+typedef struct remote_async_call remote_async_call_t;
+
+struct remote_async_call {
+    void *handle;
+
+    /**
+     * Waits for the completion of the call, max timeoutInMs ms (< 0 waits forever).
+     * On completion, sets the output arguments of the call and returns the status of the remote call
+     * (0 on success, same as the return of the synchronous method). Returns ETIMEDOUT if the call is not completed
+     * in time, the call can then be waited for again.
+     */
+    int (*wait)(void *handle, int timeoutInMs);
+
+    /**
+     * Destroys the call. If the call is still in flight its reply is discarded and the output arguments are not set.
+     */
+    void (*destroy)(void *handle);
+};
+
+#endif /* REMOTE_ASYNC_CALL_H_ */
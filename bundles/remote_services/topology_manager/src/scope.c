@@ -25,24 +25,43 @@
 #include "topology_manager.h"
 #include "utils.h"
 #include "filter.h"
+#include "celix_constants.h"
+#include "service_registration.h"
 
 struct scope_item {
     celix_properties_t *props;
+    filter_pt filter;                   // compiled once when the scope is added
+};
+
+/*
+ * Scopes are indexed by the objectClass their filter requires, so a service or endpoint is only matched against
+ * the scopes for its objectClass and the scopes that do not require a specific objectClass.
+ */
+struct scope_index {
+    hash_map_pt byObjectClass;          // key is objectClass, value is array list of scope values
+    array_list_pt wildcard;             // scope values without a required objectClass
 };
 
 struct scope {
     void *manager;	// owner of the scope datastructure
     celix_thread_mutex_t exportScopeLock;
     hash_map_pt exportScopes;           // key is filter, value is scope_item (properties set)
+    struct scope_index exportIndex;     // value is scope_item
 
     celix_thread_mutex_t importScopeLock;
     array_list_pt importScopes;			// list of filters
+    struct scope_index importIndex;     // value is filter
 
     celix_status_t (*exportScopeChangedHandler)(void* manager, char *filter);
     celix_status_t (*importScopeChangedHandler)(void* manager, char *filter);
 };
 
 static celix_status_t import_equal(const void *, const void *, bool *equals);
+static void scope_indexCreate(struct scope_index *index);
+static void scope_indexDestroy(struct scope_index *index);
+static void scope_indexAdd(struct scope_index *index, filter_pt filter, void *value);
+static void scope_indexRemove(struct scope_index *index, filter_pt filter, void *value);
+static array_list_pt scope_indexGet(struct scope_index *index, const char *objectClass);
 
 /*
  * SERVICES
@@ -67,9 +86,14 @@ celix_status_t tm_addExportScope(void *handle, char *filter, celix_properties_t
             struct scope_item *item = calloc(1, sizeof(*item));
             if (item == NULL) {
                 status = CELIX_ENOMEM;
+            } else if ((item->filter = filter_create(filter)) == NULL) {
+                free(item);
+                celix_properties_destroy(props);
+                status = CELIX_ILLEGAL_ARGUMENT; // filter not parsable
             } else {
                 item->props = props;
                 hashMap_put(scope->exportScopes, (void*) strdup(filter), (void*) item);
+                scope_indexAdd(&scope->exportIndex, item->filter, item);
             }
         } else {
             // don't allow the same filter twice
@@ -98,8 +122,14 @@ celix_status_t tm_removeExportScope(void *handle, char *filter) {
         if (present == NULL) {
             status = CELIX_ILLEGAL_ARGUMENT;
         } else {
+            scope_indexRemove(&scope->exportIndex, present->filter, present);
             celix_properties_destroy(present->props);
-            hashMap_remove(scope->exportScopes, filter); // frees also the item!
+            filter_destroy(present->filter);
+            hash_map_entry_pt entry = hashMap_getEntry(scope->exportScopes, filter);
+            char *key = hashMapEntry_getKey(entry);
+            hashMap_remove(scope->exportScopes, filter);
+            free(key);
+            free(present);
         }
         celixThreadMutex_unlock(&scope->exportScopeLock);
     }
@@ -126,6 +156,7 @@ celix_status_t tm_addImportScope(void *handle, char *filter) {
         filter_pt present = (filter_pt) arrayList_get(scope->importScopes, index);
         if (present == NULL) {
             arrayList_add(scope->importScopes, new);
+            scope_indexAdd(&scope->importIndex, new, new);
         } else {
             filter_destroy(new);
             status = CELIX_ILLEGAL_ARGUMENT;
@@ -159,6 +190,7 @@ celix_status_t tm_removeImportScope(void *handle, char *filter) {
             status = CELIX_ILLEGAL_ARGUMENT;
         else {
             arrayList_removeElement(scope->importScopes, present);
+            scope_indexRemove(&scope->importIndex, present, present);
             filter_destroy(present);
         }
         celixThreadMutex_unlock(&scope->importScopeLock);
@@ -197,6 +229,8 @@ celix_status_t scope_scopeCreate(void *handle, scope_pt *scope) {
 
     (*scope)->exportScopes = hashMap_create(utils_stringHash, NULL, utils_stringEquals, NULL);
     arrayList_createWithEquals(import_equal, &((*scope)->importScopes));
+    scope_indexCreate(&(*scope)->exportIndex);
+    scope_indexCreate(&(*scope)->importIndex);
     (*scope)->exportScopeChangedHandler = NULL;
 
     return status;
@@ -211,8 +245,10 @@ celix_status_t scope_scopeDestroy(scope_pt scope) {
             hash_map_entry_pt scopedEntry = hashMapIterator_nextEntry(iter);
             struct scope_item *item = (struct scope_item*) hashMapEntry_getValue(scopedEntry);
             celix_properties_destroy(item->props);
+            filter_destroy(item->filter);
         }
         hashMapIterator_destroy(iter);
+        scope_indexDestroy(&scope->exportIndex);
         hashMap_destroy(scope->exportScopes, true, true); // free keys, free values
         celixThreadMutex_unlock(&scope->exportScopeLock);
     }
@@ -226,6 +262,7 @@ celix_status_t scope_scopeDestroy(scope_pt scope) {
         }
         arrayListIterator_destroy(imp_iter);
         arrayList_destroy(scope->importScopes);
+        scope_indexDestroy(&scope->importIndex);
         celixThreadMutex_unlock(&scope->importScopeLock);
     }
 
@@ -247,20 +284,95 @@ static celix_status_t import_equal(const void *src, const void *dest, bool *equa
     return status;
 }
 
+/*
+ * Returns the objectClass a service or endpoint must have to match the filter or NULL if the filter does not require
+ * a specific objectClass. Only an objectClass equality at the top-level or nested in (top-level) AND operands is
+ * required, an objectClass in a OR or NOT operand is not.
+ */
+static const char* scope_findRequiredObjectClass(filter_pt filter) {
+    const char *result = NULL;
+    if (filter == NULL) {
+        //nop
+    } else if (filter->operand == CELIX_FILTER_OPERAND_EQUAL) {
+        if (filter->attribute != NULL && strcmp(filter->attribute, OSGI_FRAMEWORK_OBJECTCLASS) == 0) {
+            result = filter->value;
+        }
+    } else if (filter->operand == CELIX_FILTER_OPERAND_AND) {
+        for (int i = 0; i < arrayList_size(filter->children) && result == NULL; ++i) {
+            result = scope_findRequiredObjectClass(arrayList_get(filter->children, i));
+        }
+    }
+    return result;
+}
+
+static void scope_indexCreate(struct scope_index *index) {
+    index->byObjectClass = hashMap_create(utils_stringHash, NULL, utils_stringEquals, NULL);
+    arrayList_create(&index->wildcard);
+}
+
+static void scope_indexDestroy(struct scope_index *index) {
+    hash_map_iterator_pt iter = hashMapIterator_create(index->byObjectClass);
+    while (hashMapIterator_hasNext(iter)) {
+        array_list_pt bucket = hashMapIterator_nextValue(iter);
+        arrayList_destroy(bucket);
+    }
+    hashMapIterator_destroy(iter);
+    hashMap_destroy(index->byObjectClass, true, false); // free keys
+    arrayList_destroy(index->wildcard);
+}
+
+static void scope_indexAdd(struct scope_index *index, filter_pt filter, void *value) {
+    const char *objectClass = scope_findRequiredObjectClass(filter);
+    if (objectClass == NULL) {
+        arrayList_add(index->wildcard, value);
+    } else {
+        array_list_pt bucket = hashMap_get(index->byObjectClass, objectClass);
+        if (bucket == NULL) {
+            arrayList_create(&bucket);
+            hashMap_put(index->byObjectClass, strdup(objectClass), bucket);
+        }
+        arrayList_add(bucket, value);
+    }
+}
+
+static void scope_indexRemove(struct scope_index *index, filter_pt filter, void *value) {
+    const char *objectClass = scope_findRequiredObjectClass(filter);
+    if (objectClass == NULL) {
+        arrayList_removeElement(index->wildcard, value);
+    } else {
+        hash_map_entry_pt entry = hashMap_getEntry(index->byObjectClass, objectClass);
+        if (entry != NULL) {
+            array_list_pt bucket = hashMapEntry_getValue(entry);
+            arrayList_removeElement(bucket, value);
+            if (arrayList_isEmpty(bucket)) {
+                char *key = hashMapEntry_getKey(entry);
+                hashMap_remove(index->byObjectClass, objectClass);
+                free(key);
+                arrayList_destroy(bucket);
+            }
+        }
+    }
+}
+
+static array_list_pt scope_indexGet(struct scope_index *index, const char *objectClass) {
+    return objectClass == NULL ? NULL : hashMap_get(index->byObjectClass, objectClass);
+}
+
 bool scope_allowImport(scope_pt scope, endpoint_description_t *endpoint) {
     bool allowImport = false;
-    array_list_iterator_pt iter;
 
     if (celixThreadMutex_lock(&(scope->importScopeLock)) == CELIX_SUCCESS) {
         if (arrayList_size(scope->importScopes) == 0) {
             allowImport = true;
         } else {
-            iter = arrayListIterator_create(scope->importScopes);
-            while ((allowImport == false) && arrayListIterator_hasNext(iter)) {
-                filter_pt element = (filter_pt) arrayListIterator_next(iter);
-                filter_match(element, endpoint->properties, &allowImport);
+            const char *objectClass = celix_properties_get(endpoint->properties, OSGI_FRAMEWORK_OBJECTCLASS, endpoint->service);
+            array_list_pt candidates[] = { scope_indexGet(&scope->importIndex, objectClass), scope->importIndex.wildcard };
+            for (int c = 0; c < 2 && !allowImport; c++) {
+                for (int i = 0; candidates[c] != NULL && i < arrayList_size(candidates[c]) && !allowImport; i++) {
+                    filter_pt element = (filter_pt) arrayList_get(candidates[c], i);
+                    filter_match(element, endpoint->properties, &allowImport);
+                }
             }
-            arrayListIterator_destroy(iter);
         }
         celixThreadMutex_unlock(&scope->importScopeLock);
     }
@@ -269,50 +381,34 @@ bool scope_allowImport(scope_pt scope, endpoint_description_t *endpoint) {
 
 celix_status_t scope_getExportProperties(scope_pt scope, service_reference_pt reference, celix_properties_t **props) {
     celix_status_t status = CELIX_SUCCESS;
-    unsigned int size = 0;
-    char **keys;
+    service_registration_t *registration = NULL;
+    celix_properties_t *serviceProperties = NULL;
     bool found = false;
 
     *props = NULL;
-    celix_properties_t *serviceProperties = celix_properties_create();  // GB: not sure if a copy is needed
-                                                                        // or serviceReference_getProperties() is
-                                                                        // is acceptable
-
-    serviceReference_getPropertyKeys(reference, &keys, &size);
-    for (int i = 0; i < size; i++) {
-        char *key = keys[i];
-        const char* value = NULL;
-
-        if (serviceReference_getProperty(reference, key, &value) == CELIX_SUCCESS) {
-//        		&& strcmp(key, (char*) OSGI_RSA_SERVICE_EXPORTED_INTERFACES) != 0
-//        		&& strcmp(key, (char*) OSGI_FRAMEWORK_OBJECTCLASS) != 0) {
-            celix_properties_set(serviceProperties, key, value);
-        }
-
+    serviceReference_getServiceRegistration(reference, &registration);
+    if (registration != NULL) {
+        serviceRegistration_getProperties(registration, &serviceProperties);
+    }
+    if (serviceProperties == NULL) {
+        return status;
     }
-
-    free(keys);
 
     if (celixThreadMutex_lock(&(scope->exportScopeLock)) == CELIX_SUCCESS) {
-        hash_map_iterator_pt scopedPropIter = hashMapIterator_create(scope->exportScopes);
+        const char *objectClass = celix_properties_get(serviceProperties, OSGI_FRAMEWORK_OBJECTCLASS, NULL);
+        array_list_pt candidates[] = { scope_indexGet(&scope->exportIndex, objectClass), scope->exportIndex.wildcard };
         // TODO: now stopping if first filter matches, alternatively we could build up
         //       the additional output properties for each filter that matches?
-        while ((!found) && hashMapIterator_hasNext(scopedPropIter)) {
-            hash_map_entry_pt scopedEntry = hashMapIterator_nextEntry(scopedPropIter);
-            char *filterStr = (char *) hashMapEntry_getKey(scopedEntry);
-            filter_pt filter = filter_create(filterStr);
-            if (filter != NULL) {
+        for (int c = 0; c < 2 && !found; c++) {
+            for (int i = 0; candidates[c] != NULL && i < arrayList_size(candidates[c]) && !found; i++) {
+                struct scope_item *item = (struct scope_item *) arrayList_get(candidates[c], i);
                 // test if the scope filter matches the exported service properties
-                status = filter_match(filter, serviceProperties, &found);
+                status = filter_match(item->filter, serviceProperties, &found);
                 if (found) {
-                    struct scope_item *item = (struct scope_item *) hashMapEntry_getValue(scopedEntry);
                     *props = item->props;
                 }
             }
-            filter_destroy(filter);
         }
-        hashMapIterator_destroy(scopedPropIter);
-        celix_properties_destroy(serviceProperties);
 
         celixThreadMutex_unlock(&(scope->exportScopeLock));
     }
@@ -54,7 +54,7 @@ struct topology_manager {
 	array_list_pt rsaList;
 
 	celix_thread_mutex_t listenerListLock;
-	hash_map_pt listenerList;
+	hash_map_pt listenerList; // key = service reference, value = compiled endpoint listener scope filter
 
 	celix_thread_mutex_t exportedServicesLock;
 	hash_map_pt exportedServices;
@@ -69,7 +69,7 @@ struct topology_manager {
 };
 
 celix_status_t topologyManager_exportScopeChanged(void *handle, char *service_name);
-celix_status_t topologyManager_importScopeChanged(void *handle, char *service_name);
+celix_status_t topologyManager_importScopeChanged(void *handle, char *filterStr);
 celix_status_t topologyManager_notifyListenersEndpointAdded(topology_manager_pt manager, remote_service_admin_service_t *rsa, array_list_pt registrations);
 celix_status_t topologyManager_notifyListenersEndpointRemoved(topology_manager_pt manager, remote_service_admin_service_t *rsa, export_registration_t *export);
 
@@ -118,6 +118,11 @@ celix_status_t topologyManager_destroy(topology_manager_pt manager) {
 	celix_status_t status = CELIX_SUCCESS;
 
 	celixThreadMutex_lock(&manager->listenerListLock);
+	hash_map_iterator_pt listenerIter = hashMapIterator_create(manager->listenerList);
+	while (hashMapIterator_hasNext(listenerIter)) {
+		filter_destroy(hashMapIterator_nextValue(listenerIter));
+	}
+	hashMapIterator_destroy(listenerIter);
 	hashMap_destroy(manager->listenerList, false, false);
 
 	celixThreadMutex_unlock(&manager->listenerListLock);
@@ -488,39 +493,65 @@ celix_status_t topologyManager_exportScopeChanged(void *handle, char *filterStr)
 	return status;
 }
 
-celix_status_t topologyManager_importScopeChanged(void *handle, char *service_name) {
+/**
+ * Re-evaluates the import scope for the known endpoints. Only endpoints for which the import decision changed are
+ * imported or closed, the imports of the other endpoints are left untouched.
+ */
+celix_status_t topologyManager_importScopeChanged(void *handle, char *filterStr) {
 	celix_status_t status = CELIX_SUCCESS;
-	endpoint_description_t *endpoint;
 	topology_manager_pt manager = (topology_manager_pt) handle;
-	bool found = false;
 
-	// add already exported services to new rsa
 	if (celixThreadMutex_lock(&manager->importedServicesLock) == CELIX_SUCCESS) {
 		hash_map_iterator_pt importedServicesIterator = hashMapIterator_create(manager->importedServices);
-		while (!found && hashMapIterator_hasNext(importedServicesIterator)) {
+		while (hashMapIterator_hasNext(importedServicesIterator)) {
 			hash_map_entry_pt entry = hashMapIterator_nextEntry(importedServicesIterator);
-			endpoint = hashMapEntry_getKey(entry);
+			endpoint_description_t *endpoint = hashMapEntry_getKey(entry);
+			hash_map_pt imports = hashMapEntry_getValue(entry);
+			bool imported = imports != NULL && hashMap_size(imports) > 0;
+			bool allowed = scope_allowImport(manager->scope, endpoint);
 
-			entry = hashMap_getEntry(endpoint->properties, (void *) OSGI_FRAMEWORK_OBJECTCLASS);
-			char* name = (char *) hashMapEntry_getValue(entry);
-			// Test if a service with the same name is imported
-			if (strcmp(name, service_name) == 0) {
-				found = true;
+			if (allowed && !imported) {
+				if (imports == NULL) {
+					imports = hashMap_create(NULL, NULL, NULL, NULL);
+					hashMap_put(manager->importedServices, endpoint, imports);
+				}
+				if (celixThreadMutex_lock(&manager->rsaListLock) == CELIX_SUCCESS) {
+					for (int i = 0; i < arrayList_size(manager->rsaList); i++) {
+						import_registration_t *import = NULL;
+						remote_service_admin_service_t *rsa = arrayList_get(manager->rsaList, i);
+						celix_status_t substatus = rsa->importService(rsa->admin, endpoint, &import);
+						if (substatus == CELIX_SUCCESS) {
+							hashMap_put(imports, rsa, import);
+						} else {
+							status = substatus;
+						}
+					}
+					celixThreadMutex_unlock(&manager->rsaListLock);
+				}
+			} else if (!allowed && imported) {
+				hash_map_iterator_pt importsIter = hashMapIterator_create(imports);
+				while (hashMapIterator_hasNext(importsIter)) {
+					hash_map_entry_pt importEntry = hashMapIterator_nextEntry(importsIter);
+					remote_service_admin_service_t *rsa = hashMapEntry_getKey(importEntry);
+					import_registration_t *import = hashMapEntry_getValue(importEntry);
+					celix_status_t substatus = rsa->importRegistration_close(rsa->admin, import);
+					if (substatus == CELIX_SUCCESS) {
+						hashMapIterator_remove(importsIter);
+					} else {
+						status = substatus;
+					}
+				}
+				hashMapIterator_destroy(importsIter);
+			}
+
+			if (status != CELIX_SUCCESS) {
+				logHelper_log(manager->loghelper, OSGI_LOGSERVICE_ERROR, "TOPOLOGY_MANAGER: Updating import scope (%s) for imported service (%s; %s) failed.", filterStr, endpoint->service, endpoint->id);
 			}
 		}
 		hashMapIterator_destroy(importedServicesIterator);
 		celixThreadMutex_unlock(&manager->importedServicesLock);
 	}
 
-	if (found) {
-		status = topologyManager_removeImportedService(manager, endpoint, NULL);
-
-		if (status != CELIX_SUCCESS) {
-			logHelper_log(manager->loghelper, OSGI_LOGSERVICE_ERROR, "TOPOLOGY_MANAGER: Removal of imported service (%s; %s) failed.", endpoint->service, endpoint->id);
-		} else {
-			status = topologyManager_addImportedService(manager, endpoint, NULL);
-		}
-	}
 	return status;
 }
 
@@ -714,13 +745,14 @@ celix_status_t topologyManager_endpointListenerAdded(void* handle, service_refer
 
 	logHelper_log(manager->loghelper, OSGI_LOGSERVICE_INFO, "TOPOLOGY_MANAGER: Added ENDPOINT_LISTENER");
 
+	serviceReference_getProperty(reference, OSGI_ENDPOINT_LISTENER_SCOPE, &scope);
+	filter_pt filter = filter_create(scope);
+
 	if (celixThreadMutex_lock(&manager->listenerListLock) == CELIX_SUCCESS) {
-		hashMap_put(manager->listenerList, reference, NULL);
+		// the scope filter is compiled once and used for every endpoint notified to this listener
+		hashMap_put(manager->listenerList, reference, filter);
 		celixThreadMutex_unlock(&manager->listenerListLock);
 
-		serviceReference_getProperty(reference, OSGI_ENDPOINT_LISTENER_SCOPE, &scope);
-
-		filter_pt filter = filter_create(scope);
 		hash_map_iterator_pt refIter = hashMapIterator_create(manager->exportedServices);
 
 		while (hashMapIterator_hasNext(refIter)) {
@@ -753,8 +785,6 @@ celix_status_t topologyManager_endpointListenerAdded(void* handle, service_refer
 			hashMapIterator_destroy(rsaIter);
 		}
 		hashMapIterator_destroy(refIter);
-
-		filter_destroy(filter);
 	}
 
 	return status;
@@ -778,7 +808,8 @@ celix_status_t topologyManager_endpointListenerRemoved(void * handle, service_re
 
 	if (celixThreadMutex_lock(&manager->listenerListLock) == CELIX_SUCCESS) {
 
-		if (hashMap_remove(manager->listenerList, reference)) {
+		if (hashMap_containsKey(manager->listenerList, reference)) {
+			filter_destroy(hashMap_remove(manager->listenerList, reference));
 			logHelper_log(manager->loghelper, OSGI_LOGSERVICE_INFO, "EndpointListener Removed");
 		}
 
@@ -797,14 +828,14 @@ celix_status_t topologyManager_notifyListenersEndpointAdded(topology_manager_pt
 		while (hashMapIterator_hasNext(iter)) {
 			const char* scope = NULL;
 			endpoint_listener_t *epl = NULL;
-			service_reference_pt reference = hashMapIterator_nextKey(iter);
+			hash_map_entry_pt listenerEntry = hashMapIterator_nextEntry(iter);
+			service_reference_pt reference = hashMapEntry_getKey(listenerEntry);
+			filter_pt filter = hashMapEntry_getValue(listenerEntry);
 
 			serviceReference_getProperty(reference, OSGI_ENDPOINT_LISTENER_SCOPE, &scope);
 
 			status = bundleContext_getService(manager->context, reference, (void **) &epl);
 			if (status == CELIX_SUCCESS) {
-				filter_pt filter = filter_create(scope);
-
 				int regSize = arrayList_size(registrations);
 				for (int regIt = 0; regIt < regSize; regIt++) {
 					export_registration_t *export = arrayList_get(registrations, regIt);
@@ -820,7 +851,6 @@ celix_status_t topologyManager_notifyListenersEndpointAdded(topology_manager_pt
 						status = substatus;
 					}
 				}
-				filter_destroy(filter);
 			}
 		}
 		hashMapIterator_destroy(iter);
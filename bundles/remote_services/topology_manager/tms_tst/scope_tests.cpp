@@ -0,0 +1,194 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *  KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+/**
+ * scope_tests.cpp
+ *
+ *  \author     <a href="mailto:dev@celix.apache.org">Apache Celix Project Team</a>
+ *  \copyright  Apache License, Version 2.0
+ */
+
+#include <string.h>
+
+#include "CppUTest/TestHarness.h"
+#include "celix_api.h"
+#include "celix_framework_factory.h"
+#include "celix_constants.h"
+
+extern "C" {
+
+#include "endpoint_description.h"
+#include "remote_constants.h"
+#include "scope.h"
+
+    static int nrOfExportScopeChanges = 0;
+    static int nrOfImportScopeChanges = 0;
+
+    static celix_status_t exportScopeChanged(void *handle __attribute__((unused)), char *filter __attribute__((unused))) {
+        ++nrOfExportScopeChanges;
+        return CELIX_SUCCESS;
+    }
+
+    static celix_status_t importScopeChanged(void *handle __attribute__((unused)), char *filter __attribute__((unused))) {
+        ++nrOfImportScopeChanges;
+        return CELIX_SUCCESS;
+    }
+
+    static endpoint_description_t* createEndpoint(const char *service, const char *zone) {
+        celix_properties_t *props = celix_properties_create();
+        celix_properties_set(props, OSGI_RSA_ENDPOINT_FRAMEWORK_UUID, "fw-uuid");
+        celix_properties_set(props, OSGI_RSA_ENDPOINT_ID, "ep");
+        celix_properties_set(props, OSGI_FRAMEWORK_OBJECTCLASS, service);
+        if (zone != NULL) {
+            celix_properties_set(props, "zone", zone);
+        }
+        endpoint_description_t *endpoint = NULL;
+        endpointDescription_create(props, &endpoint);
+        return endpoint;
+    }
+
+    static celix_properties_t* createScopeProperties(const char *key) {
+        celix_properties_t *props = celix_properties_create();
+        celix_properties_set(props, "key", key);
+        return props;
+    }
+}
+
+TEST_GROUP(TmScopeTests) {
+    scope_pt scope = NULL;
+
+    void setup() {
+        nrOfExportScopeChanges = 0;
+        nrOfImportScopeChanges = 0;
+        CHECK_EQUAL(CELIX_SUCCESS, scope_scopeCreate(NULL, &scope));
+        scope_setExportScopeChangedCallback(scope, exportScopeChanged);
+        scope_setImportScopeChangedCallback(scope, importScopeChanged);
+    }
+
+    void teardown() {
+        scope_scopeDestroy(scope);
+    }
+};
+
+TEST(TmScopeTests, importAllowedWithoutScopes) {
+    endpoint_description_t *calc = createEndpoint("calc", NULL);
+    CHECK(scope_allowImport(scope, calc));
+    endpointDescription_destroy(calc);
+}
+
+TEST(TmScopeTests, importScopeForObjectClass) {
+    endpoint_description_t *calc = createEndpoint("calc", NULL);
+    endpoint_description_t *other = createEndpoint("other", NULL);
+
+    CHECK_EQUAL(CELIX_SUCCESS, tm_addImportScope(scope, (char *) "(&(objectClass=calc)(endpoint.id=ep))"));
+    CHECK_EQUAL(1, nrOfImportScopeChanges);
+    CHECK(scope_allowImport(scope, calc));
+    CHECK(!scope_allowImport(scope, other));
+
+    //the same scope twice and unparsable scopes are rejected
+    CHECK_EQUAL(CELIX_ILLEGAL_ARGUMENT, tm_addImportScope(scope, (char *) "(&(objectClass=calc)(endpoint.id=ep))"));
+    CHECK_EQUAL(CELIX_ILLEGAL_ARGUMENT, tm_addImportScope(scope, (char *) "(objectClass=calc"));
+
+    CHECK_EQUAL(CELIX_SUCCESS, tm_removeImportScope(scope, (char *) "(&(objectClass=calc)(endpoint.id=ep))"));
+    CHECK_EQUAL(CELIX_ILLEGAL_ARGUMENT, tm_removeImportScope(scope, (char *) "(&(objectClass=calc)(endpoint.id=ep))"));
+
+    //no scopes left, so everything is allowed again
+    CHECK(scope_allowImport(scope, other));
+
+    endpointDescription_destroy(calc);
+    endpointDescription_destroy(other);
+}
+
+TEST(TmScopeTests, importScopeWithoutRequiredObjectClass) {
+    endpoint_description_t *calcA = createEndpoint("calc", "a");
+    endpoint_description_t *otherA = createEndpoint("other", "a");
+    endpoint_description_t *otherB = createEndpoint("other", "b");
+    endpoint_description_t *thirdB = createEndpoint("third", "b");
+
+    //an objectClass in an OR operand does not restrict the scope to that objectClass
+    CHECK_EQUAL(CELIX_SUCCESS, tm_addImportScope(scope, (char *) "(|(objectClass=calc)(zone=b))"));
+    CHECK_EQUAL(CELIX_SUCCESS, tm_addImportScope(scope, (char *) "(&(objectClass=other)(zone=a))"));
+
+    CHECK(scope_allowImport(scope, calcA));
+    CHECK(scope_allowImport(scope, otherA));
+    CHECK(scope_allowImport(scope, otherB));
+    CHECK(scope_allowImport(scope, thirdB));
+
+    CHECK_EQUAL(CELIX_SUCCESS, tm_removeImportScope(scope, (char *) "(|(objectClass=calc)(zone=b))"));
+    CHECK(!scope_allowImport(scope, calcA));
+    CHECK(scope_allowImport(scope, otherA));
+    CHECK(!scope_allowImport(scope, otherB));
+    CHECK(!scope_allowImport(scope, thirdB));
+
+    endpointDescription_destroy(calcA);
+    endpointDescription_destroy(otherA);
+    endpointDescription_destroy(otherB);
+    endpointDescription_destroy(thirdB);
+}
+
+TEST(TmScopeTests, exportScopeProperties) {
+    celix_properties_t *fwProps = celix_properties_create();
+    celix_properties_set(fwProps, "org.osgi.framework.storage.clean", "onFirstInit");
+    celix_properties_set(fwProps, "org.osgi.framework.storage", ".cacheTmScopeTests");
+    celix_framework_t *fw = celix_frameworkFactory_createFramework(fwProps);
+    CHECK(fw != NULL);
+    celix_bundle_context_t *ctx = celix_framework_getFrameworkContext(fw);
+
+    int svc = 0;
+    celix_properties_t *calcProps = celix_properties_create();
+    celix_properties_set(calcProps, "zone", "a");
+    long calcId = celix_bundleContext_registerService(ctx, &svc, "calc", calcProps);
+    celix_properties_t *otherProps = celix_properties_create();
+    celix_properties_set(otherProps, "zone", "b");
+    long otherId = celix_bundleContext_registerService(ctx, &svc, "other", otherProps);
+
+    service_reference_pt calcRef = NULL;
+    service_reference_pt otherRef = NULL;
+    CHECK_EQUAL(CELIX_SUCCESS, bundleContext_getServiceReference(ctx, "calc", &calcRef));
+    CHECK_EQUAL(CELIX_SUCCESS, bundleContext_getServiceReference(ctx, "other", &otherRef));
+
+    celix_properties_t *props = NULL;
+    CHECK_EQUAL(CELIX_SUCCESS, scope_getExportProperties(scope, calcRef, &props));
+    CHECK(props == NULL);
+
+    CHECK_EQUAL(CELIX_SUCCESS, tm_addExportScope(scope, (char *) "(&(objectClass=calc)(zone=a))", createScopeProperties("calc")));
+    CHECK_EQUAL(CELIX_SUCCESS, tm_addExportScope(scope, (char *) "(zone=b)", createScopeProperties("zoneB")));
+    CHECK_EQUAL(2, nrOfExportScopeChanges);
+    CHECK_EQUAL(CELIX_ILLEGAL_ARGUMENT, tm_addExportScope(scope, (char *) "(zone=b)", createScopeProperties("again")));
+    CHECK_EQUAL(CELIX_ILLEGAL_ARGUMENT, tm_addExportScope(scope, (char *) "(zone=b", createScopeProperties("invalid")));
+
+    CHECK_EQUAL(CELIX_SUCCESS, scope_getExportProperties(scope, calcRef, &props));
+    CHECK(props != NULL);
+    STRCMP_EQUAL("calc", celix_properties_get(props, "key", NULL));
+    CHECK_EQUAL(CELIX_SUCCESS, scope_getExportProperties(scope, otherRef, &props));
+    CHECK(props != NULL);
+    STRCMP_EQUAL("zoneB", celix_properties_get(props, "key", NULL));
+
+    CHECK_EQUAL(CELIX_SUCCESS, tm_removeExportScope(scope, (char *) "(&(objectClass=calc)(zone=a))"));
+    CHECK_EQUAL(CELIX_ILLEGAL_ARGUMENT, tm_removeExportScope(scope, (char *) "(&(objectClass=calc)(zone=a))"));
+    CHECK_EQUAL(CELIX_SUCCESS, scope_getExportProperties(scope, calcRef, &props));
+    CHECK(props == NULL);
+    CHECK_EQUAL(CELIX_SUCCESS, scope_getExportProperties(scope, otherRef, &props));
+    CHECK(props != NULL);
+
+    bundleContext_ungetServiceReference(ctx, calcRef);
+    bundleContext_ungetServiceReference(ctx, otherRef);
+    celix_bundleContext_unregisterService(ctx, calcId);
+    celix_bundleContext_unregisterService(ctx, otherId);
+    celix_frameworkFactory_destroyFramework(fw);
+}
@@ -42,6 +42,12 @@
 #define REMOTE_SHELL_TELNET_MAXCONN_PROPERTY_NAME 	"remote.shell.telnet.maxconn"
 #define DEFAULT_REMOTE_SHELL_TELNET_MAXCONN 		2
 
+#define REMOTE_SHELL_TELNET_WORKERS_PROPERTY_NAME 	"remote.shell.telnet.workers"
+#define DEFAULT_REMOTE_SHELL_TELNET_WORKERS 		2
+
+#define REMOTE_SHELL_BATCH_PORT_PROPERTY_NAME 		"remote.shell.batch.port"
+#define DEFAULT_REMOTE_SHELL_BATCH_PORT 			-1
+
 struct bundle_instance {
 	log_helper_t *loghelper;
 	shell_mediator_pt shellMediator;
@@ -86,12 +92,14 @@ celix_status_t bundleActivator_start(void * userData, bundle_context_pt context)
 
 	int port = bundleActivator_getPort(bi, context);
 	int maxConn = bundleActivator_getMaximumConnections(bi, context);
+	int workers = bundleActivator_getProperty(bi, context, REMOTE_SHELL_TELNET_WORKERS_PROPERTY_NAME, DEFAULT_REMOTE_SHELL_TELNET_WORKERS);
+	int batchPort = bundleActivator_getProperty(bi, context, REMOTE_SHELL_BATCH_PORT_PROPERTY_NAME, DEFAULT_REMOTE_SHELL_BATCH_PORT);
 
 	status = logHelper_start(bi->loghelper);
 
 	status = CELIX_DO_IF(status, shellMediator_create(context, &bi->shellMediator));
-	status = CELIX_DO_IF(status, remoteShell_create(bi->shellMediator, maxConn, &bi->remoteShell));
-	status = CELIX_DO_IF(status, connectionListener_create(bi->remoteShell, port, &bi->connectionListener));
+	status = CELIX_DO_IF(status, remoteShell_create(bi->shellMediator, maxConn, workers, &bi->remoteShell));
+	status = CELIX_DO_IF(status, connectionListener_create(bi->remoteShell, port, batchPort, maxConn, &bi->connectionListener));
 	status = CELIX_DO_IF(status, connectionListener_start(bi->connectionListener));
 
 	return status;
@@ -101,11 +109,23 @@ celix_status_t bundleActivator_stop(void * userData, bundle_context_pt context)
 	celix_status_t status = CELIX_SUCCESS;
 	bundle_instance_pt bi = (bundle_instance_pt) userData;
 
-	connectionListener_stop(bi->connectionListener);
-	shellMediator_stop(bi->shellMediator);
-	shellMediator_destroy(bi->shellMediator);
-
-	remoteShell_stopConnections(bi->remoteShell);
+	if (bi->connectionListener != NULL) {
+		connectionListener_stop(bi->connectionListener);
+	}
+	//note executes the commands still queued, the connections are destroyed afterwards
+	if (bi->remoteShell != NULL) {
+		remoteShell_destroy(bi->remoteShell);
+		bi->remoteShell = NULL;
+	}
+	if (bi->connectionListener != NULL) {
+		connectionListener_destroy(bi->connectionListener);
+		bi->connectionListener = NULL;
+	}
+	if (bi->shellMediator != NULL) {
+		shellMediator_stop(bi->shellMediator);
+		shellMediator_destroy(bi->shellMediator);
+		bi->shellMediator = NULL;
+	}
 
 	status = logHelper_stop(bi->loghelper);
 
@@ -116,8 +136,8 @@ celix_status_t bundleActivator_destroy(void * userData, bundle_context_pt contex
 	celix_status_t status = CELIX_SUCCESS;
 	bundle_instance_pt bi = (bundle_instance_pt) userData;
 
-	connectionListener_destroy(bi->connectionListener);
 	status = logHelper_destroy(&bi->loghelper);
+	free(bi);
 
 	return status;
 }
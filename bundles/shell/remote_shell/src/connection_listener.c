@@ -24,6 +24,7 @@
  *  \copyright  Apache License, Version 2.0
  */
 
+
 #include <stdlib.h>
 #include <string.h>
 #include <celix_errno.h>
@@ -32,49 +33,110 @@
 #include <unistd.h>
 #include <sys/types.h>
 #include <sys/socket.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
 #include <netinet/in.h>
 #include <arpa/inet.h>
 #include <netdb.h>
 #include <fcntl.h>
+#include <utils.h>
 
 #include "log_service.h"
 #include "log_helper.h"
+#include "array_list.h"
+#include "celix_ring_buffer.h"
 
 #include "connection_listener.h"
 
 #include "shell_mediator.h"
 #include "remote_shell.h"
 
-#define CONNECTION_LISTENER_TIMEOUT_SEC        5
+#define RS_PROMPT ("-> ")
+#define RS_WELCOME ("\n---- Apache Celix Remote Shell ----\n---- Type exit to disconnect   ----\n\n-> ")
+#define RS_GOODBYE ("Goodbye!\n")
+#define RS_ERROR ("Error executing command!\n")
+#define RS_MAXIMUM_CONNECTIONS_REACHED ("Maximum number of connections  reached. Disconnecting ...\n")
+
+#define CONNECTION_LISTENER_MAX_EVENTS         64
+#define CONNECTION_LISTENER_LISTEN_BACKLOG     16
+
+typedef struct connection {
+    connection_listener_pt listener;
+    int fd;
+    bool interactive; //false for batch connections: no welcome/prompt, length-prefixed responses
+    uint32_t events;  //registered epoll events, 0 if not registered
+    bool closed;      //freed after the current batch of epoll events
+
+    //note while busy, the output buffer is owned by the worker executing the command
+    bool busy;
+    bool closing;     //close after the output is sent
+    bool inputClosed; //the peer will not send more commands, close after the received commands are executed
+    bool peerClosed;  //the peer is gone, close as soon as possible
+
+    char input[REMOTE_SHELL_COMMAND_BUFF_SIZE];
+    size_t inputSize;
+    remote_shell_buffer_t output; //reused for all commands of the connection
+    size_t outputSent;
+    remote_shell_command_t command;
+} connection_t;
 
 struct connection_listener {
     //constant
     int port;
+    int batchPort;
+    int maximumConnections;
     log_helper_t **loghelper;
     remote_shell_pt remoteShell;
-    celix_thread_mutex_t mutex;
 
-    //protected by mutex
-    bool running;
     celix_thread_t thread;
-    fd_set pollset;
+    bool running;                   //atomic
+    int epollFd;
+    int wakeupFd;                   //eventfd, signals completed commands and stop
+    celix_ring_buffer_t *completed; //MPMC, connection_t* of which the command is executed
+
+    //only used by the listener thread (and destroy)
+    int listenSocket;
+    int batchListenSocket;
+    array_list_pt connections;
+    array_list_pt closedConnections;
 };
 
 static void* connection_listener_thread(void *data);
 
-celix_status_t connectionListener_create(remote_shell_pt remoteShell, int port, connection_listener_pt *instance) {
+celix_status_t connectionListener_create(remote_shell_pt remoteShell, int port, int batchPort, int maximumConnections, connection_listener_pt *instance) {
     celix_status_t status = CELIX_SUCCESS;
     (*instance) = calloc(1, sizeof(**instance));
 
     if ((*instance) != NULL) {
         (*instance)->port = port;
+        (*instance)->batchPort = batchPort;
+        (*instance)->maximumConnections = maximumConnections > 0 ? maximumConnections : 1;
         (*instance)->remoteShell = remoteShell;
         (*instance)->running = false;
         (*instance)->loghelper = remoteShell->loghelper;
-
-        FD_ZERO(&(*instance)-> pollset);
-
-        status = celixThreadMutex_create(&(*instance)->mutex, NULL);
+        (*instance)->listenSocket = -1;
+        (*instance)->batchListenSocket = -1;
+
+        (*instance)->epollFd = epoll_create1(EPOLL_CLOEXEC);
+        (*instance)->wakeupFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+        (*instance)->completed = celix_ringBuffer_create((size_t) (*instance)->maximumConnections, CELIX_RING_BUFFER_MPMC);
+        arrayList_create(&(*instance)->connections);
+        arrayList_create(&(*instance)->closedConnections);
+        if ((*instance)->epollFd < 0 || (*instance)->wakeupFd < 0 || (*instance)->completed == NULL) {
+            status = CELIX_BUNDLE_EXCEPTION;
+        } else {
+            struct epoll_event event;
+            memset(&event, 0, sizeof(event));
+            event.events = EPOLLIN;
+            event.data.ptr = &(*instance)->wakeupFd;
+            if (epoll_ctl((*instance)->epollFd, EPOLL_CTL_ADD, (*instance)->wakeupFd, &event) != 0) {
+                status = CELIX_BUNDLE_EXCEPTION;
+            }
+        }
+        if (status != CELIX_SUCCESS) {
+            connectionListener_destroy(*instance);
+            *instance = NULL;
+        }
     } else {
         status = CELIX_ENOMEM;
     }
@@ -82,54 +144,77 @@ celix_status_t connectionListener_create(remote_shell_pt remoteShell, int port,
 }
 
 celix_status_t connectionListener_start(connection_listener_pt instance) {
-    celix_status_t status = CELIX_SUCCESS;
-    celixThreadMutex_lock(&instance->mutex);
-    celixThread_create(&instance->thread, NULL, connection_listener_thread, instance);
-    celixThreadMutex_unlock(&instance->mutex);
+    __atomic_store_n(&instance->running, true, __ATOMIC_RELEASE);
+    celix_status_t status = celixThread_create(&instance->thread, NULL, connection_listener_thread, instance);
+    if (status == CELIX_SUCCESS) {
+        celixThread_setName(&instance->thread, "RemoteShellIO");
+    } else {
+        __atomic_store_n(&instance->running, false, __ATOMIC_RELEASE);
+    }
     return status;
 }
 
+static void connectionListener_wakeup(connection_listener_pt instance) {
+    uint64_t one = 1;
+    ssize_t rc = write(instance->wakeupFd, &one, sizeof(one));
+    (void) rc; //note an EAGAIN means the counter is already non-zero, so the listener thread is woken anyway
+}
+
 celix_status_t connectionListener_stop(connection_listener_pt instance) {
     celix_status_t status = CELIX_SUCCESS;
-    celix_thread_t thread;
-    fd_set pollset;
-
-    instance->running = false;
-    FD_ZERO(&pollset);
 
     logHelper_log(*instance->loghelper, OSGI_LOGSERVICE_INFO, "CONNECTION_LISTENER: Stopping thread\n");
 
-    celixThreadMutex_lock(&instance->mutex);
-    thread = instance->thread;
-
-    pollset = instance->pollset;
-    celixThreadMutex_unlock(&instance->mutex);
-
-    celixThread_join(thread, NULL);
+    if (__atomic_exchange_n(&instance->running, false, __ATOMIC_ACQ_REL)) {
+        connectionListener_wakeup(instance);
+        celixThread_join(instance->thread, NULL);
+    }
     return status;
 }
 
+static void connectionListener_freeConnection(connection_t *connection) {
+    if (connection->fd >= 0) {
+        close(connection->fd);
+    }
+    remoteShell_bufferFree(&connection->output);
+    free(connection);
+}
+
 celix_status_t connectionListener_destroy(connection_listener_pt instance) {
+    //note the remote shell is destroyed first, so no command is executing anymore
+    for (unsigned int i = 0; i < arrayList_size(instance->connections); ++i) {
+        connectionListener_freeConnection(arrayList_get(instance->connections, i));
+    }
+    arrayList_destroy(instance->connections);
+    for (unsigned int i = 0; i < arrayList_size(instance->closedConnections); ++i) {
+        connectionListener_freeConnection(arrayList_get(instance->closedConnections, i));
+    }
+    arrayList_destroy(instance->closedConnections);
+    if (instance->completed != NULL) {
+        celix_ringBuffer_destroy(instance->completed);
+    }
+    if (instance->wakeupFd >= 0) {
+        close(instance->wakeupFd);
+    }
+    if (instance->epollFd >= 0) {
+        close(instance->epollFd);
+    }
     free(instance);
 
     return CELIX_SUCCESS;
 }
 
-static void* connection_listener_thread(void *data) {
+static int connectionListener_listen(connection_listener_pt instance, int port) {
     celix_status_t status = CELIX_BUNDLE_EXCEPTION;
-    connection_listener_pt instance = data;
-    struct timeval timeout; /* Timeout for select */
-    fd_set active_fd_set;
-    FD_ZERO(&active_fd_set);
-    int listenSocket = 0;
+    int listenSocket = -1;
     int on = 1;
 
-    struct addrinfo *result, *rp;
+    struct addrinfo *result = NULL, *rp;
     struct addrinfo hints;
 
     memset(&hints, 0, sizeof(struct addrinfo));
     hints.ai_family = AF_UNSPEC; /* Allow IPv4 or IPv6 */
-    hints.ai_socktype = SOCK_STREAM; /* Datagram socket */
+    hints.ai_socktype = SOCK_STREAM;
     hints.ai_flags = AI_PASSIVE; /* For wildcard IP address */
     hints.ai_protocol = 0; /* Any protocol */
     hints.ai_canonname = NULL;
@@ -137,16 +222,20 @@ static void* connection_listener_thread(void *data) {
     hints.ai_next = NULL;
 
     char portStr[10];
-    snprintf(&portStr[0], 10, "%d", instance->port);
+    snprintf(&portStr[0], 10, "%d", port);
 
-    getaddrinfo(NULL, portStr, &hints, &result);
+    if (getaddrinfo(NULL, portStr, &hints, &result) != 0) {
+        logHelper_log(*instance->loghelper, OSGI_LOGSERVICE_ERROR, "cannot resolve port %d", port);
+        return -1;
+    }
 
     for (rp = result; rp != NULL && status == CELIX_BUNDLE_EXCEPTION; rp = rp->ai_next) {
-
-        status = CELIX_BUNDLE_EXCEPTION;
+        if (listenSocket >= 0) {
+            close(listenSocket);
+        }
 
         /* Create socket */
-        listenSocket = socket(rp->ai_family, rp->ai_socktype, rp->ai_protocol);
+        listenSocket = socket(rp->ai_family, rp->ai_socktype | SOCK_NONBLOCK | SOCK_CLOEXEC, rp->ai_protocol);
         if (listenSocket < 0) {
             logHelper_log(*instance->loghelper, OSGI_LOGSERVICE_ERROR, "Error creating socket: %s", strerror(errno));
         }
@@ -156,66 +245,326 @@ static void* connection_listener_thread(void *data) {
         else if (bind(listenSocket, rp->ai_addr, rp->ai_addrlen) < 0) {
             logHelper_log(*instance->loghelper, OSGI_LOGSERVICE_ERROR, "cannot bind: %s", strerror(errno));
         }
-        else if (listen(listenSocket, 5) < 0) {
+        else if (listen(listenSocket, CONNECTION_LISTENER_LISTEN_BACKLOG) < 0) {
             logHelper_log(*instance->loghelper, OSGI_LOGSERVICE_ERROR, "listen failed: %s", strerror(errno));
         }
         else {
             status = CELIX_SUCCESS;
         }
     }
+    freeaddrinfo(result);
 
-    if (status == CELIX_SUCCESS) {
+    if (status != CELIX_SUCCESS && listenSocket >= 0) {
+        close(listenSocket);
+        listenSocket = -1;
+    }
+    return listenSocket;
+}
 
-        logHelper_log(*instance->loghelper, OSGI_LOGSERVICE_INFO, "Remote Shell accepting connections on port %d", instance->port);
+/**
+ * Registers the epoll events the connection is waiting for. Note a connection waiting only for the executing command
+ * is not registered, otherwise a hang up would be reported over and over.
+ */
+static void connectionListener_updateEvents(connection_listener_pt instance, connection_t *connection) {
+    uint32_t events = 0;
+    if (!connection->peerClosed) {
+        if (!connection->inputClosed && connection->inputSize < sizeof(connection->input)) {
+            events |= EPOLLIN | EPOLLRDHUP;
+        }
+        if (!connection->busy && connection->outputSent < connection->output.size) {
+            events |= EPOLLOUT;
+        }
+    }
+    if (events == connection->events) {
+        return;
+    }
 
-        celixThreadMutex_lock(&instance->mutex);
-        instance->pollset = active_fd_set;
-        celixThreadMutex_unlock(&instance->mutex);
+    struct epoll_event event;
+    memset(&event, 0, sizeof(event));
+    event.events = events;
+    event.data.ptr = connection;
+    if (events == 0) {
+        epoll_ctl(instance->epollFd, EPOLL_CTL_DEL, connection->fd, NULL);
+    } else if (connection->events == 0) {
+        epoll_ctl(instance->epollFd, EPOLL_CTL_ADD, connection->fd, &event);
+    } else {
+        epoll_ctl(instance->epollFd, EPOLL_CTL_MOD, connection->fd, &event);
+    }
+    connection->events = events;
+}
 
-        instance->running = true;
+static void connectionListener_append(connection_t *connection, const char *text) {
+    remoteShell_bufferAppend(&connection->output, text, strlen(text));
+}
 
-        while (status == CELIX_SUCCESS && instance->running) {
-            int selectRet = -1;
-            do {
-                timeout.tv_sec = CONNECTION_LISTENER_TIMEOUT_SEC;
-                timeout.tv_usec = 0;
+/**
+ * Appends a response which is not produced by a command: followed by a prompt or framed with its length.
+ */
+static void connectionListener_respond(connection_t *connection, const char *text) {
+    if (connection->interactive) {
+        connectionListener_append(connection, text);
+        connectionListener_append(connection, RS_PROMPT);
+    } else {
+        char header[32];
+        snprintf(header, sizeof(header), "%zu\n", strlen(text));
+        connectionListener_append(connection, header);
+        connectionListener_append(connection, text);
+    }
+}
 
-                FD_ZERO(&active_fd_set);
-                FD_SET(listenSocket, &active_fd_set);
+/**
+ * Sends the pending output without blocking.
+ */
+static void connectionListener_send(connection_t *connection) {
+    while (connection->outputSent < connection->output.size) {
+        ssize_t rc = send(connection->fd, connection->output.data + connection->outputSent, connection->output.size - connection->outputSent, MSG_NOSIGNAL);
+        if (rc < 0 && errno == EINTR) {
+            continue;
+        } else if (rc < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+            return; //wait for EPOLLOUT
+        } else if (rc <= 0) {
+            connection->peerClosed = true;
+            break;
+        }
+        connection->outputSent += (size_t) rc;
+    }
+    connection->output.size = 0;
+    connection->outputSent = 0;
+}
 
-                selectRet = select(listenSocket + 1, &active_fd_set, NULL, NULL, &timeout);
-            } while (selectRet == -1 && errno == EINTR && instance->running == true);
-            if (selectRet < 0) {
-                logHelper_log(*instance->loghelper, OSGI_LOGSERVICE_ERROR, "select on listenSocket failed: %s", strerror(errno));
-                status = CELIX_BUNDLE_EXCEPTION;
+static void connectionListener_close(connection_listener_pt instance, connection_t *connection) {
+    logHelper_log(*instance->loghelper, OSGI_LOGSERVICE_INFO, "REMOTE_SHELL: Closing socket");
+    if (connection->events != 0) {
+        epoll_ctl(instance->epollFd, EPOLL_CTL_DEL, connection->fd, NULL);
+        connection->events = 0;
+    }
+    arrayList_removeElement(instance->connections, connection);
+    //note freed after the current batch of events, which can still refer to the connection
+    connection->closed = true;
+    arrayList_add(instance->closedConnections, connection);
+}
+
+static void connectionListener_commandDone(void *handle, remote_shell_command_t *command) {
+    connection_t *connection = handle;
+    //note the ring buffer can hold all connections and a connection executes one command at a time
+    celix_ringBuffer_tryPush(connection->listener->completed, connection);
+    connectionListener_wakeup(connection->listener);
+}
+
+/**
+ * Executes the next received command, if the connection is not busy and the output of the previous command is sent.
+ * Closes the connection when done.
+ */
+static void connectionListener_process(connection_listener_pt instance, connection_t *connection) {
+    if (!connection->busy) {
+        connectionListener_send(connection);
+    }
+
+    while (!connection->busy && !connection->closing && !connection->peerClosed && connection->output.size == 0) {
+        char *newline = memchr(connection->input, '\n', connection->inputSize);
+        if (newline == NULL) {
+            if (connection->inputClosed) {
+                connection->closing = true;
+            } else if (connection->inputSize == sizeof(connection->input)) {
+                logHelper_log(*instance->loghelper, OSGI_LOGSERVICE_ERROR, "REMOTE_SHELL: Error while retrieving data, command too long");
+                connection->inputSize = 0;
+                connectionListener_respond(connection, RS_ERROR);
+                connectionListener_send(connection);
+                continue;
             }
-            else if (selectRet == 0) {
-                /* do nothing here */
+            break;
+        }
+
+        size_t lineLength = (size_t) (newline - connection->input);
+        memcpy(connection->command.line, connection->input, lineLength);
+        connection->command.line[lineLength] = '\0';
+        connection->inputSize -= lineLength + 1;
+        memmove(connection->input, newline + 1, connection->inputSize);
+        char *line = utils_stringTrim(connection->command.line);
+
+        if (strlen(line) == 0) {
+            connectionListener_respond(connection, "");
+            connectionListener_send(connection);
+        } else if (strcmp("exit", line) == 0) {
+            connectionListener_append(connection, connection->interactive ? RS_GOODBYE : "");
+            connectionListener_send(connection);
+            connection->closing = true;
+        } else {
+            connection->busy = true;
+            if (remoteShell_submit(instance->remoteShell, &connection->command) != CELIX_SUCCESS) {
+                connection->busy = false;
+                connection->closing = true; //stopping
             }
-            else if (FD_ISSET(listenSocket, &active_fd_set)) {
-                int acceptedSocket = accept(listenSocket, NULL, NULL);
+        }
+    }
 
-                if (acceptedSocket < 0) {
-                    logHelper_log(*instance->loghelper, OSGI_LOGSERVICE_ERROR, "REMOTE_SHELL: accept failed: %s.", strerror(errno));
-                    status = CELIX_BUNDLE_EXCEPTION;
-                }
-                else {
-                    logHelper_log(*instance->loghelper, OSGI_LOGSERVICE_INFO, "REMOTE_SHELL: connection established.");
-                    remoteShell_addConnection(instance->remoteShell, acceptedSocket);
-                }
+    if (!connection->busy && (connection->peerClosed || (connection->closing && connection->output.size == 0))) {
+        connectionListener_close(instance, connection);
+    } else {
+        connectionListener_updateEvents(instance, connection);
+    }
+}
+
+static void connectionListener_completed(connection_listener_pt instance, connection_t *connection) {
+    connection->busy = false;
+    if (connection->interactive) {
+        connectionListener_append(connection, RS_PROMPT);
+    } else {
+        //frame the output with its length, so that a persistent batch connection can execute many commands
+        char header[32];
+        size_t outputSize = connection->output.size;
+        int headerLength = snprintf(header, sizeof(header), "%zu\n", outputSize);
+        if (remoteShell_bufferAppend(&connection->output, header, (size_t) headerLength) == CELIX_SUCCESS) {
+            memmove(connection->output.data + headerLength, connection->output.data, outputSize);
+            memcpy(connection->output.data, header, (size_t) headerLength);
+        }
+    }
+    connectionListener_process(instance, connection);
+}
+
+static void connectionListener_accept(connection_listener_pt instance, int listenSocket, bool interactive) {
+    while (true) {
+        int acceptedSocket = accept4(listenSocket, NULL, NULL, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (acceptedSocket < 0) {
+            if (errno == EINTR) {
+                continue;
+            } else if (errno != EAGAIN && errno != EWOULDBLOCK) {
+                logHelper_log(*instance->loghelper, OSGI_LOGSERVICE_ERROR, "REMOTE_SHELL: accept failed: %s.", strerror(errno));
             }
-            else {
-                logHelper_log(*instance->loghelper, OSGI_LOGSERVICE_DEBUG, "REMOTE_SHELL: received data on a not-expected file-descriptor?");
+            return;
+        }
+
+        if (arrayList_size(instance->connections) >= instance->maximumConnections) {
+            if (interactive) {
+                send(acceptedSocket, RS_MAXIMUM_CONNECTIONS_REACHED, strlen(RS_MAXIMUM_CONNECTIONS_REACHED), MSG_NOSIGNAL);
             }
+            close(acceptedSocket);
+            continue;
         }
+
+        connection_t *connection = calloc(1, sizeof(*connection));
+        if (connection == NULL) {
+            close(acceptedSocket);
+            continue;
+        }
+        connection->listener = instance;
+        connection->fd = acceptedSocket;
+        connection->interactive = interactive;
+        connection->command.output = &connection->output;
+        connection->command.done = connectionListener_commandDone;
+        connection->command.handle = connection;
+        connection->events = EPOLLIN | EPOLLRDHUP;
+
+        struct epoll_event event;
+        memset(&event, 0, sizeof(event));
+        event.events = connection->events;
+        event.data.ptr = connection;
+        if (epoll_ctl(instance->epollFd, EPOLL_CTL_ADD, acceptedSocket, &event) != 0) {
+            logHelper_log(*instance->loghelper, OSGI_LOGSERVICE_ERROR, "REMOTE_SHELL: cannot add connection: %s.", strerror(errno));
+            connectionListener_freeConnection(connection);
+            continue;
+        }
+        arrayList_add(instance->connections, connection);
+        logHelper_log(*instance->loghelper, OSGI_LOGSERVICE_INFO, "REMOTE_SHELL: connection established.");
+
+        if (interactive) {
+            connectionListener_append(connection, RS_WELCOME);
+        }
+        connectionListener_process(instance, connection);
     }
+}
 
-    if (listenSocket >= 0) {
-        close(listenSocket);
+static void connectionListener_receive(connection_listener_pt instance, connection_t *connection) {
+    while (connection->inputSize < sizeof(connection->input)) {
+        ssize_t len = recv(connection->fd, connection->input + connection->inputSize, sizeof(connection->input) - connection->inputSize, 0);
+        if (len < 0 && errno == EINTR) {
+            continue;
+        } else if (len < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+            break;
+        } else if (len == 0) {
+            connection->inputClosed = true;
+            break;
+        } else if (len < 0) {
+            connection->peerClosed = true;
+            break;
+        }
+        connection->inputSize += (size_t) len;
     }
+}
 
-    freeaddrinfo(result);
+static void* connection_listener_thread(void *data) {
+    connection_listener_pt instance = data;
+    struct epoll_event events[CONNECTION_LISTENER_MAX_EVENTS];
+
+    instance->listenSocket = connectionListener_listen(instance, instance->port);
+    if (instance->batchPort > 0) {
+        instance->batchListenSocket = connectionListener_listen(instance, instance->batchPort);
+    }
+    if (instance->listenSocket < 0) {
+        return NULL;
+    }
+
+    struct epoll_event event;
+    memset(&event, 0, sizeof(event));
+    event.events = EPOLLIN;
+    event.data.ptr = &instance->listenSocket;
+    epoll_ctl(instance->epollFd, EPOLL_CTL_ADD, instance->listenSocket, &event);
+    logHelper_log(*instance->loghelper, OSGI_LOGSERVICE_INFO, "Remote Shell accepting connections on port %d", instance->port);
+    if (instance->batchListenSocket >= 0) {
+        event.data.ptr = &instance->batchListenSocket;
+        epoll_ctl(instance->epollFd, EPOLL_CTL_ADD, instance->batchListenSocket, &event);
+        logHelper_log(*instance->loghelper, OSGI_LOGSERVICE_INFO, "Remote Shell accepting batch connections on port %d", instance->batchPort);
+    }
+
+    while (__atomic_load_n(&instance->running, __ATOMIC_ACQUIRE)) {
+        int nrOfEvents = epoll_wait(instance->epollFd, events, CONNECTION_LISTENER_MAX_EVENTS, -1);
+        if (nrOfEvents < 0 && errno != EINTR) {
+            logHelper_log(*instance->loghelper, OSGI_LOGSERVICE_ERROR, "epoll_wait failed: %s", strerror(errno));
+            break;
+        }
+        for (int i = 0; i < nrOfEvents; ++i) {
+            void *ptr = events[i].data.ptr;
+            if (ptr == &instance->wakeupFd) {
+                uint64_t count;
+                ssize_t rc = read(instance->wakeupFd, &count, sizeof(count));
+                (void) rc;
+                void *element = NULL;
+                while (celix_ringBuffer_tryPop(instance->completed, &element)) {
+                    connectionListener_completed(instance, element);
+                }
+            } else if (ptr == &instance->listenSocket) {
+                connectionListener_accept(instance, instance->listenSocket, true);
+            } else if (ptr == &instance->batchListenSocket) {
+                connectionListener_accept(instance, instance->batchListenSocket, false);
+            } else {
+                connection_t *connection = ptr;
+                if (connection->closed) {
+                    continue; //closed while handling an earlier event of this batch
+                }
+                if (events[i].events & (EPOLLIN | EPOLLRDHUP | EPOLLHUP | EPOLLERR)) {
+                    connectionListener_receive(instance, connection);
+                }
+                connectionListener_process(instance, connection);
+            }
+        }
+
+        for (unsigned int i = 0; i < arrayList_size(instance->closedConnections); ++i) {
+            connectionListener_freeConnection(arrayList_get(instance->closedConnections, i));
+        }
+        arrayList_clear(instance->closedConnections);
+    }
+
+    //say goodbye, note connections still executing a command are closed when the listener is destroyed
+    for (unsigned int i = 0; i < arrayList_size(instance->connections); ++i) {
+        connection_t *connection = arrayList_get(instance->connections, i);
+        if (connection->interactive && !connection->busy) {
+            send(connection->fd, RS_GOODBYE, strlen(RS_GOODBYE), MSG_NOSIGNAL);
+        }
+    }
+    close(instance->listenSocket);
+    if (instance->batchListenSocket >= 0) {
+        close(instance->batchListenSocket);
+    }
 
     return NULL;
 }
-
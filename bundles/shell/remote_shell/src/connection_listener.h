@@ -34,7 +34,12 @@
 
 typedef struct connection_listener *connection_listener_pt;
 
-celix_status_t connectionListener_create(remote_shell_pt remoteShell, int port, connection_listener_pt *instance);
+/**
+ * Creates the connection listener. All connections are handled by a single epoll thread, the commands are executed by
+ * the workers of the remote shell. Connections on the batch port (if > 0) are non-interactive: no welcome and prompt,
+ * every response is prefixed with its length ("<nr of bytes>\n").
+ */
+celix_status_t connectionListener_create(remote_shell_pt remoteShell, int port, int batchPort, int maximumConnections, connection_listener_pt *instance);
 celix_status_t connectionListener_destroy(connection_listener_pt instance);
 celix_status_t connectionListener_start(connection_listener_pt instance);
 celix_status_t connectionListener_stop(connection_listener_pt instance);
@@ -24,219 +24,137 @@
  *  \copyright	Apache License, Version 2.0
  */
 
+
 #include <stdlib.h>
+#include <stdio.h>
 #include <string.h>
-#include <unistd.h>
-#include <utils.h>
-#include <array_list.h>
-#include <sys/socket.h>
 
 #include "log_helper.h"
 
 #include "log_service.h"
 #include "remote_shell.h"
 
-#define COMMAND_BUFF_SIZE (256)
-
-#define RS_PROMPT ("-> ")
-#define RS_WELCOME ("\n---- Apache Celix Remote Shell ----\n---- Type exit to disconnect   ----\n\n-> ")
-#define RS_GOODBYE ("Goodbye!\n")
-#define RS_ERROR ("Error executing command!\n")
-#define RS_MAXIMUM_CONNECTIONS_REACHED ("Maximum number of connections  reached. Disconnecting ...\n")
-
-#define CONNECTION_LISTENER_TIMEOUT_SEC		5
-
-
-
-struct connection {
+struct remote_shell_worker {
 	remote_shell_pt parent;
-	FILE *socketStream;
-	fd_set pollset;
-	bool threadRunning;
+	celix_thread_t thread;
+	FILE *out; //reused for every command, writes to the output buffer of the current command
+	remote_shell_buffer_t *current;
 };
 
-typedef struct connection *connection_pt;
-
-static celix_status_t remoteShell_connection_print(connection_pt connection, char * text);
-static celix_status_t remoteShell_connection_execute(connection_pt connection, char *command);
-static void* remoteShell_connection_run(void *data);
+static void* remoteShell_worker_run(void *data);
 
-celix_status_t remoteShell_create(shell_mediator_pt mediator, int maximumConnections, remote_shell_pt *instance) {
-	celix_status_t status = CELIX_SUCCESS;
-	(*instance) = calloc(1, sizeof(**instance));
-	if ((*instance) != NULL) {
-		(*instance)->mediator = mediator;
-		(*instance)->maximumConnections = maximumConnections;
-		(*instance)->connections = NULL;
-		(*instance)->loghelper = &mediator->loghelper;
-
-		status = celixThreadMutex_create(&(*instance)->mutex, NULL);
-
-		if (status == CELIX_SUCCESS) {
-			status = arrayList_create(&(*instance)->connections);
+celix_status_t remoteShell_bufferAppend(remote_shell_buffer_t *buffer, const char *data, size_t len) {
+	if (buffer->size + len > buffer->capacity) {
+		size_t capacity = buffer->capacity == 0 ? 1024 : buffer->capacity;
+		while (capacity < buffer->size + len) {
+			capacity *= 2;
 		}
-	} else {
-		status = CELIX_ENOMEM;
+		char *grown = realloc(buffer->data, capacity);
+		if (grown == NULL) {
+			return CELIX_ENOMEM;
+		}
+		buffer->data = grown;
+		buffer->capacity = capacity;
 	}
-	return status;
+	memcpy(buffer->data + buffer->size, data, len);
+	buffer->size += len;
+	return CELIX_SUCCESS;
 }
 
-celix_status_t remoteShell_destroy(remote_shell_pt instance) {
-	celix_status_t status = CELIX_SUCCESS;
-
-	remoteShell_stopConnections(instance);
-
-	celixThreadMutex_lock(&instance->mutex);
-	arrayList_destroy(instance->connections);
-	celixThreadMutex_unlock(&instance->mutex);
+void remoteShell_bufferFree(remote_shell_buffer_t *buffer) {
+	free(buffer->data);
+	buffer->data = NULL;
+	buffer->size = 0;
+	buffer->capacity = 0;
+}
 
-	return status;
+static ssize_t remoteShell_worker_write(void *cookie, const char *data, size_t len) {
+	remote_shell_worker_t *worker = cookie;
+	if (worker->current == NULL || remoteShell_bufferAppend(worker->current, data, len) != CELIX_SUCCESS) {
+		return 0;
+	}
+	return (ssize_t) len;
 }
 
-celix_status_t remoteShell_addConnection(remote_shell_pt instance, int socket) {
+celix_status_t remoteShell_create(shell_mediator_pt mediator, int maximumCommands, int nrOfWorkers, remote_shell_pt *instance) {
 	celix_status_t status = CELIX_SUCCESS;
-	connection_pt connection = calloc(1, sizeof(struct connection));
-
-	if (connection != NULL) {
-		connection->parent = instance;
-		connection->threadRunning = false;
-		connection->socketStream = fdopen(socket, "w");
-
-		if (connection->socketStream != NULL) {
-
-			celixThreadMutex_lock(&instance->mutex);
-
-			if (arrayList_size(instance->connections) < instance->maximumConnections) {
-				celix_thread_t connectionRunThread = celix_thread_default;
-				arrayList_add(instance->connections, connection);
-				status = celixThread_create(&connectionRunThread, NULL, &remoteShell_connection_run, connection);
-			} else {
-				status = CELIX_BUNDLE_EXCEPTION;
-				remoteShell_connection_print(connection, RS_MAXIMUM_CONNECTIONS_REACHED);
-			}
-			celixThreadMutex_unlock(&instance->mutex);
+	(*instance) = calloc(1, sizeof(**instance));
+	if ((*instance) == NULL) {
+		return CELIX_ENOMEM;
+	}
 
-		} else {
-			status = CELIX_BUNDLE_EXCEPTION;
-		}
-	} else {
+	(*instance)->mediator = mediator;
+	(*instance)->loghelper = &mediator->loghelper;
+	(*instance)->nrOfWorkers = nrOfWorkers > 0 ? nrOfWorkers : 1;
+	(*instance)->commands = celix_ringBuffer_create(maximumCommands > 0 ? (size_t) maximumCommands : 1, CELIX_RING_BUFFER_MPMC);
+	(*instance)->workers = calloc((size_t) (*instance)->nrOfWorkers, sizeof(*(*instance)->workers));
+	if ((*instance)->commands == NULL || (*instance)->workers == NULL) {
 		status = CELIX_ENOMEM;
 	}
 
-	if (status != CELIX_SUCCESS && connection != NULL) {
-		if (connection->socketStream != NULL) {
-			fclose(connection->socketStream);
+	cookie_io_functions_t functions = { .read = NULL, .write = remoteShell_worker_write, .seek = NULL, .close = NULL };
+	int started = 0;
+	for (; status == CELIX_SUCCESS && started < (*instance)->nrOfWorkers; ++started) {
+		remote_shell_worker_t *worker = &(*instance)->workers[started];
+		worker->parent = *instance;
+		worker->out = fopencookie(worker, "w", functions);
+		if (worker->out == NULL) {
+			status = CELIX_ENOMEM;
+			break;
+		}
+		status = celixThread_create(&worker->thread, NULL, remoteShell_worker_run, worker);
+		if (status != CELIX_SUCCESS) {
+			fclose(worker->out);
+			break;
 		}
-		free(connection);
+		celixThread_setName(&worker->thread, "RemoteShell");
 	}
 
-	return status;
-}
-
-celix_status_t remoteShell_stopConnections(remote_shell_pt instance) {
-	celix_status_t status = CELIX_SUCCESS;
-	int length = 0;
-	int i = 0;
-
-	celixThreadMutex_lock(&instance->mutex);
-	length = arrayList_size(instance->connections);
-
-	for (i = 0; i < length; i += 1) {
-		connection_pt connection = arrayList_get(instance->connections, i);
-		connection->threadRunning = false;
+	if (status != CELIX_SUCCESS) {
+		(*instance)->nrOfWorkers = started;
+		remoteShell_destroy(*instance);
+		*instance = NULL;
 	}
-
-	celixThreadMutex_unlock(&instance->mutex);
-
 	return status;
 }
 
-void *remoteShell_connection_run(void *data) {
-	celix_status_t status = CELIX_SUCCESS;
-	connection_pt connection = data;
-	size_t len;
-	int result;
-	struct timeval timeout; /* Timeout for select */
-
-	int fd = fileno(connection->socketStream);
-
-	connection->threadRunning = true;
-	status = remoteShell_connection_print(connection, RS_WELCOME);
-
-	while (status == CELIX_SUCCESS && connection->threadRunning == true) {
-		do {
-			timeout.tv_sec = CONNECTION_LISTENER_TIMEOUT_SEC;
-			timeout.tv_usec = 0;
-
-			FD_ZERO(&connection->pollset);
-			FD_SET(fd, &connection->pollset);
-			result = select(fd + 1, &connection->pollset, NULL, NULL, &timeout);
-		} while (result == -1 && errno == EINTR && connection->threadRunning == true);
-
-		/* The socket_fd has data available to be read */
-		if (result > 0 && FD_ISSET(fd, &connection->pollset)) {
-			char buff[COMMAND_BUFF_SIZE];
-
-			len = recv(fd, buff, COMMAND_BUFF_SIZE - 1, 0);
-			if (len < COMMAND_BUFF_SIZE) {
-				celix_status_t commandStatus = CELIX_SUCCESS;
-				buff[len] = '\0';
-
-				commandStatus = remoteShell_connection_execute(connection, buff);
-
-				if (commandStatus == CELIX_SUCCESS) {
-					remoteShell_connection_print(connection, RS_PROMPT);
-				} else if (commandStatus == CELIX_FILE_IO_EXCEPTION) {
-					//exit command
-					break;
-				} else { //error
-					remoteShell_connection_print(connection, RS_ERROR);
-					remoteShell_connection_print(connection, RS_PROMPT);
-				}
-
-			} else {
-				logHelper_log(*connection->parent->loghelper, OSGI_LOGSERVICE_ERROR, "REMOTE_SHELL: Error while retrieving data");
-			}
-		}
+celix_status_t remoteShell_destroy(remote_shell_pt instance) {
+	if (instance->commands != NULL) {
+		//note the workers execute the already queued commands before they stop
+		celix_ringBuffer_close(instance->commands);
 	}
-
-	remoteShell_connection_print(connection, RS_GOODBYE);
-
-	logHelper_log(*connection->parent->loghelper, OSGI_LOGSERVICE_INFO, "REMOTE_SHELL: Closing socket");
-	celixThreadMutex_lock(&connection->parent->mutex);
-	arrayList_removeElement(connection->parent->connections, connection);
-	celixThreadMutex_unlock(&connection->parent->mutex);
-
-	fclose(connection->socketStream);
-
-	return NULL;
+	for (int i = 0; instance->workers != NULL && i < instance->nrOfWorkers; ++i) {
+		celixThread_join(instance->workers[i].thread, NULL);
+		fclose(instance->workers[i].out);
+	}
+	free(instance->workers);
+	if (instance->commands != NULL) {
+		celix_ringBuffer_destroy(instance->commands);
+	}
+	free(instance);
+	return CELIX_SUCCESS;
 }
 
-static celix_status_t remoteShell_connection_execute(connection_pt connection, char *command) {
-	celix_status_t status = CELIX_SUCCESS;
+celix_status_t remoteShell_submit(remote_shell_pt instance, remote_shell_command_t *command) {
+	//note the queue can hold a command of every connection, so this only fails when stopping
+	return celix_ringBuffer_tryPush(instance->commands, command) ? CELIX_SUCCESS : CELIX_ILLEGAL_STATE;
+}
 
-	if (status == CELIX_SUCCESS) {
-		char *dline = strdup(command);
-		char *line = utils_stringTrim(dline);
-		int len = strlen(line);
-
-		if (len == 0) {
-			//ignore
-		} else if (len == 4 && strncmp("exit", line, 4) == 0) {
-			status = CELIX_FILE_IO_EXCEPTION;
-		} else {
-			status = shellMediator_executeCommand(connection->parent->mediator, line, connection->socketStream, connection->socketStream);
-            fflush(connection->socketStream);
+static void* remoteShell_worker_run(void *data) {
+	remote_shell_worker_t *worker = data;
+	void *element = NULL;
+
+	while (celix_ringBuffer_pop(worker->parent->commands, &element) == CELIX_SUCCESS) {
+		remote_shell_command_t *command = element;
+		worker->current = command->output;
+		celix_status_t status = shellMediator_executeCommand(worker->parent->mediator, command->line, worker->out, worker->out);
+		fflush(worker->out);
+		worker->current = NULL;
+		if (status != CELIX_SUCCESS) {
+			logHelper_log(*worker->parent->loghelper, OSGI_LOGSERVICE_WARNING, "REMOTE_SHELL: Error executing command '%s'", command->line);
 		}
-
-		free(dline);
+		command->done(command->handle, command);
 	}
 
-	return status;
-}
-
-celix_status_t remoteShell_connection_print(connection_pt connection, char *text) {
-	size_t len = strlen(text);
-    int fd = fileno(connection->socketStream);
-	return (send(fd, text, len, 0) > 0) ? CELIX_SUCCESS : CELIX_FILE_IO_EXCEPTION;
+	return NULL;
 }
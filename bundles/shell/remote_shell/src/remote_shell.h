@@ -30,21 +30,59 @@
 #include <bundle_context.h>
 #include <celix_errno.h>
 
+#include "celix_ring_buffer.h"
 #include "shell_mediator.h"
 
+#define REMOTE_SHELL_COMMAND_BUFF_SIZE (256)
+
+/**
+ * Growable output buffer. A connection reuses its buffer for all its commands.
+ */
+typedef struct remote_shell_buffer {
+	char *data;
+	size_t size;
+	size_t capacity;
+} remote_shell_buffer_t;
+
+typedef struct remote_shell_command remote_shell_command_t;
+
+struct remote_shell_command {
+	char line[REMOTE_SHELL_COMMAND_BUFF_SIZE];
+	remote_shell_buffer_t *output; //the command output is appended to this buffer
+	void (*done)(void *handle, remote_shell_command_t *command); //called on the worker thread
+	void *handle;
+};
+
+typedef struct remote_shell_worker remote_shell_worker_t;
+
+/**
+ * Executes shell commands on a fixed pool of worker threads.
+ */
 struct remote_shell {
 	log_helper_t **loghelper;
 	shell_mediator_pt mediator;
-	celix_thread_mutex_t mutex;
-	int maximumConnections;
-
-	array_list_pt connections;
+	celix_ring_buffer_t *commands; //MPMC, remote_shell_command_t*
+	int nrOfWorkers;
+	remote_shell_worker_t *workers;
 };
 typedef struct remote_shell *remote_shell_pt;
 
-celix_status_t remoteShell_create(shell_mediator_pt mediator, int maximumConnections, remote_shell_pt *instance);
+/**
+ * Creates the remote shell and starts nrOfWorkers worker threads. maximumCommands is the max nr of queued commands.
+ */
+celix_status_t remoteShell_create(shell_mediator_pt mediator, int maximumCommands, int nrOfWorkers, remote_shell_pt *instance);
+
+/**
+ * Executes the queued commands, stops the workers and destroys the remote shell.
+ */
 celix_status_t remoteShell_destroy(remote_shell_pt instance);
-celix_status_t remoteShell_addConnection(remote_shell_pt instance, int socket);
-celix_status_t remoteShell_stopConnections(remote_shell_pt instance);
+
+/**
+ * Queues a command for execution. The command must stay valid until its done callback is called.
+ */
+celix_status_t remoteShell_submit(remote_shell_pt instance, remote_shell_command_t *command);
+
+celix_status_t remoteShell_bufferAppend(remote_shell_buffer_t *buffer, const char *data, size_t len);
+void remoteShell_bufferFree(remote_shell_buffer_t *buffer);
 
 #endif /* REMOTE_SHELL_H_ */
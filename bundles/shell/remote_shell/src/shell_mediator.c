@@ -53,6 +53,7 @@ celix_status_t shellMediator_create(bundle_context_pt context, shell_mediator_pt
 		status = logHelper_create(context, &(*instance)->loghelper);
 
 		status = CELIX_DO_IF(status, celixThreadMutex_create(&(*instance)->mutex, NULL));
+		status = CELIX_DO_IF(status, celixThreadCondition_init(&(*instance)->cond, NULL));
 
 		status = CELIX_DO_IF(status, serviceTrackerCustomizer_create((*instance), NULL, shellMediator_addedService,
 				NULL, shellMediator_removedService, &customizer));
@@ -95,6 +96,7 @@ celix_status_t shellMediator_destroy(shell_mediator_pt instance) {
 	logHelper_stop(instance->loghelper);
 	status = logHelper_destroy(&instance->loghelper);
 	celixThreadMutex_destroy(&instance->mutex);
+	celixThreadCondition_destroy(&instance->cond);
 
 
 	free(instance);
@@ -106,15 +108,23 @@ celix_status_t shellMediator_destroy(shell_mediator_pt instance) {
 celix_status_t shellMediator_executeCommand(shell_mediator_pt instance, char *command, FILE *out, FILE *err) {
 	celix_status_t status = CELIX_SUCCESS;
 
+	//note the command is executed without holding the mutex, so that commands of different connections run concurrently
 	celixThreadMutex_lock(&instance->mutex);
+	shell_service_pt shellService = instance->shellService;
+	if (shellService != NULL) {
+		instance->shellServiceUsage += 1;
+	}
+	celixThreadMutex_unlock(&instance->mutex);
 
+	if (shellService != NULL) {
+		shellService->executeCommand(shellService->shell, command, out, err);
 
-	if (instance->shellService != NULL) {
-		instance->shellService->executeCommand(instance->shellService->shell, command, out, err);
+		celixThreadMutex_lock(&instance->mutex);
+		instance->shellServiceUsage -= 1;
+		celixThreadCondition_broadcast(&instance->cond);
+		celixThreadMutex_unlock(&instance->mutex);
 	}
 
-	celixThreadMutex_unlock(&instance->mutex);
-
 	return status;
 }
 
@@ -132,7 +142,12 @@ static celix_status_t shellMediator_removedService(void *handler, service_refere
 	celix_status_t status = CELIX_SUCCESS;
 	shell_mediator_pt instance = (shell_mediator_pt) handler;
 	celixThreadMutex_lock(&instance->mutex);
-	instance->shellService = NULL;
+	if (instance->shellService == service) {
+		instance->shellService = NULL;
+	}
+	while (instance->shellServiceUsage > 0) {
+		celixThreadCondition_wait(&instance->cond, &instance->mutex);
+	}
 	celixThreadMutex_unlock(&instance->mutex);
 	return status;
 }
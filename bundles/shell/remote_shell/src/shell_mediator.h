@@ -41,7 +41,9 @@ struct shell_mediator {
 	celix_thread_mutex_t mutex;
 
 	//protected by mutex
+	celix_thread_cond_t cond;
 	shell_service_pt shellService;
+	int shellServiceUsage; //nr of commands executing, the shell service is not removed while in use
 };
 typedef struct shell_mediator *shell_mediator_pt;
 
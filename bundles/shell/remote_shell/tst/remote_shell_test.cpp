@@ -0,0 +1,197 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *  KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+#include <thread>
+#include <chrono>
+#include <string>
+#include <cstring>
+#include <unistd.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+
+#include "celix_api.h"
+#include "celix_framework_factory.h"
+extern "C" {
+#include "shell.h"
+#include "log_helper.h"
+#include "shell_mediator.h"
+#include "remote_shell.h"
+#include "connection_listener.h"
+}
+
+#include <CppUTest/TestHarness.h>
+
+#define REMOTE_SHELL_TEST_PORT          46660
+#define REMOTE_SHELL_TEST_BATCH_PORT    46661
+
+namespace {
+    /**
+     * Shell which prints "out:<command>". The "slow" command takes 500ms.
+     */
+    celix_status_t executeCommand(shell_pt /*shell*/, char *commandLine, FILE *out, FILE */*err*/) {
+        if (strcmp("slow", commandLine) == 0) {
+            std::this_thread::sleep_for(std::chrono::milliseconds{500});
+        }
+        fprintf(out, "out:%s\n", commandLine);
+        return CELIX_SUCCESS;
+    }
+
+    int connectTo(int port) {
+        int fd = socket(AF_INET, SOCK_STREAM, 0);
+        sockaddr_in addr{};
+        addr.sin_family = AF_INET;
+        addr.sin_port = htons((uint16_t)port);
+        addr.sin_addr.s_addr = inet_addr("127.0.0.1");
+        for (int i = 0; i < 100; ++i) {
+            if (connect(fd, (sockaddr*)&addr, sizeof(addr)) == 0) {
+                return fd;
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds{10});
+        }
+        close(fd);
+        return -1;
+    }
+
+    /**
+     * Reads until the received data ends with end, or until EOF if end is empty. Times out after 5s.
+     */
+    std::string readUntil(int fd, const std::string &end) {
+        std::string received{};
+        auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds{5};
+        while (std::chrono::steady_clock::now() < deadline) {
+            if (!end.empty() && received.size() >= end.size() &&
+                received.compare(received.size() - end.size(), end.size(), end) == 0) {
+                break;
+            }
+            pollfd pfd{fd, POLLIN, 0};
+            if (poll(&pfd, 1, 100) <= 0) {
+                continue;
+            }
+            char buf[256];
+            ssize_t len = recv(fd, buf, sizeof(buf), 0);
+            if (len <= 0) {
+                break;
+            }
+            received.append(buf, (size_t)len);
+        }
+        return received;
+    }
+
+    void sendAll(int fd, const std::string &data) {
+        CHECK_EQUAL((ssize_t)data.size(), send(fd, data.c_str(), data.size(), MSG_NOSIGNAL));
+    }
+}
+
+TEST_GROUP(RemoteShellTests) {
+    celix_framework_t *fw = nullptr;
+    celix_bundle_context_t *ctx = nullptr;
+    shell_service_t shellSvc{};
+    long shellSvcId = -1;
+    shell_mediator_pt mediator = nullptr;
+    remote_shell_pt remoteShell = nullptr;
+    connection_listener_pt listener = nullptr;
+
+    void setup() {
+        celix_properties_t *properties = celix_properties_create();
+        celix_properties_set(properties, "LOGHELPER_ENABLE_STDOUT_FALLBACK", "true");
+        celix_properties_set(properties, "org.osgi.framework.storage.clean", "onFirstInit");
+        celix_properties_set(properties, "org.osgi.framework.storage", ".cacheRemoteShellTestFramework");
+        fw = celix_frameworkFactory_createFramework(properties);
+        ctx = celix_framework_getFrameworkContext(fw);
+
+        shellSvc.executeCommand = executeCommand;
+        shellSvcId = celix_bundleContext_registerService(ctx, &shellSvc, OSGI_SHELL_SERVICE_NAME, nullptr);
+
+        CHECK_EQUAL(CELIX_SUCCESS, shellMediator_create(ctx, &mediator));
+        CHECK_EQUAL(CELIX_SUCCESS, remoteShell_create(mediator, 2, 2, &remoteShell));
+        CHECK_EQUAL(CELIX_SUCCESS, connectionListener_create(remoteShell, REMOTE_SHELL_TEST_PORT, REMOTE_SHELL_TEST_BATCH_PORT, 2, &listener));
+        CHECK_EQUAL(CELIX_SUCCESS, connectionListener_start(listener));
+    }
+
+    void teardown() {
+        //same order as the activator
+        connectionListener_stop(listener);
+        remoteShell_destroy(remoteShell);
+        connectionListener_destroy(listener);
+        shellMediator_stop(mediator);
+        shellMediator_destroy(mediator);
+        celix_bundleContext_unregisterService(ctx, shellSvcId);
+        celix_frameworkFactory_destroyFramework(fw);
+    }
+};
+
+TEST(RemoteShellTests, interactive) {
+    int fd = connectTo(REMOTE_SHELL_TEST_PORT);
+    CHECK(fd >= 0);
+    std::string welcome = readUntil(fd, "-> ");
+    CHECK(welcome.find("Apache Celix Remote Shell") != std::string::npos);
+
+    sendAll(fd, "cmd1\n");
+    STRCMP_EQUAL("out:cmd1\n-> ", readUntil(fd, "-> ").c_str());
+
+    sendAll(fd, "exit\n");
+    STRCMP_EQUAL("Goodbye!\n", readUntil(fd, "").c_str());
+    close(fd);
+}
+
+TEST(RemoteShellTests, batchPipelinedCommandsInOrder) {
+    int fd = connectTo(REMOTE_SHELL_TEST_BATCH_PORT);
+    CHECK(fd >= 0);
+
+    //commands received in one read are run one after the other, responses are framed with their length
+    sendAll(fd, "a\nslow\nc\n");
+    //a half closed peer still gets the responses to the commands it sent
+    shutdown(fd, SHUT_WR);
+    STRCMP_EQUAL("6\nout:a\n9\nout:slow\n6\nout:c\n", readUntil(fd, "").c_str());
+    close(fd);
+}
+
+TEST(RemoteShellTests, slowCommandDoesNotBlockOtherConnections) {
+    int slowFd = connectTo(REMOTE_SHELL_TEST_BATCH_PORT);
+    int fastFd = connectTo(REMOTE_SHELL_TEST_BATCH_PORT);
+    CHECK(slowFd >= 0);
+    CHECK(fastFd >= 0);
+
+    sendAll(slowFd, "slow\n");
+    std::this_thread::sleep_for(std::chrono::milliseconds{50});
+    auto start = std::chrono::steady_clock::now();
+    sendAll(fastFd, "fast\n");
+    STRCMP_EQUAL("9\nout:fast\n", readUntil(fastFd, "out:fast\n").c_str());
+    CHECK(std::chrono::steady_clock::now() - start < std::chrono::milliseconds{400});
+
+    STRCMP_EQUAL("9\nout:slow\n", readUntil(slowFd, "out:slow\n").c_str());
+    close(slowFd);
+    close(fastFd);
+}
+
+TEST(RemoteShellTests, maximumConnections) {
+    int fd1 = connectTo(REMOTE_SHELL_TEST_PORT);
+    int fd2 = connectTo(REMOTE_SHELL_TEST_PORT);
+    readUntil(fd1, "-> ");
+    readUntil(fd2, "-> ");
+
+    int fd3 = connectTo(REMOTE_SHELL_TEST_PORT);
+    CHECK(fd3 >= 0);
+    CHECK(readUntil(fd3, "").find("Maximum number of connections") != std::string::npos);
+
+    close(fd1);
+    close(fd2);
+    close(fd3);
+}
@@ -33,7 +33,7 @@
 #include "service_tracker.h"
 #include "celix_constants.h"
 
-#define NUMBER_OF_COMMANDS 11
+#define NUMBER_OF_COMMANDS 15
 
 struct command {
     celix_status_t (*exec)(void *handle, char *commandLine, FILE *out, FILE *err);
@@ -149,6 +149,34 @@ celix_status_t bundleActivator_create(bundle_context_pt context_ptr, void **_ppt
                         .usage = "dm [wtf] [f|full] [<Bundle ID> [<Bundle ID> [...]]]"
                 };
         instance_ptr->std_commands[10] =
+                (struct command) {
+                        .exec = startupCommand_execute,
+                        .name = "startup",
+                        .description = "print the slowest bundles and components of the startup trace (see CELIX_STARTUP_TRACE_FILE).",
+                        .usage = "startup [<nr of entries>]"
+                };
+        instance_ptr->std_commands[11] =
+                (struct command) {
+                        .exec = memoryCommand_execute,
+                        .name = "memory",
+                        .description = "print the memory used by the framework on behalf of the bundles for services, references, listeners and trackers.",
+                        .usage = "memory"
+                };
+        instance_ptr->std_commands[12] =
+                (struct command) {
+                        .exec = locksCommand_execute,
+                        .name = "locks",
+                        .description = "print the most contended locks (requires a build with ENABLE_LOCK_PROFILING).",
+                        .usage = "locks [h|histograms] [reset] [<nr of entries>]"
+                };
+        instance_ptr->std_commands[13] =
+                (struct command) {
+                        .exec = threadsCommand_execute,
+                        .name = "threads",
+                        .description = "print the CPU time, context switches and allocated bytes of the threads created by Celix and their owning bundle.",
+                        .usage = "threads [<nr of entries>]"
+                };
+        instance_ptr->std_commands[14] =
                 (struct command) { NULL, NULL, NULL, NULL, NULL, NULL, -1L }; /*marker for last element*/
 
         unsigned int i = 0;
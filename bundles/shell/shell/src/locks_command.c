@@ -0,0 +1,102 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *  KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "celix_threads.h"
+#include "std_commands.h"
+
+#define LOCKS_COMMAND_DEFAULT_NR_OF_ENTRIES 10
+
+static void locksCommand_printHistogram(FILE *outStream, const char *title, const unsigned long *histogram) {
+    fprintf(outStream, "      %s:", title);
+    for (int b = 0; b < CELIX_THREAD_LOCK_PROFILE_NR_OF_BUCKETS; ++b) {
+        if (histogram[b] == 0) {
+            continue;
+        }
+        if (b == 0) {
+            fprintf(outStream, " <1us=%lu", histogram[b]);
+        } else if (b == CELIX_THREAD_LOCK_PROFILE_NR_OF_BUCKETS - 1) {
+            fprintf(outStream, " >=%luus=%lu", 1UL << (b - 1), histogram[b]);
+        } else {
+            fprintf(outStream, " <%luus=%lu", 1UL << b, histogram[b]);
+        }
+    }
+    fprintf(outStream, "\n");
+}
+
+celix_status_t locksCommand_execute(void *handle __attribute__((unused)), char *commandLine, FILE *outStream, FILE *errStream) {
+    long nrOfEntries = LOCKS_COMMAND_DEFAULT_NR_OF_ENTRIES;
+    bool reset = false;
+    bool histograms = false;
+    char *copy = strdup(commandLine);
+    char *savePtr = NULL;
+    strtok_r(copy, " ", &savePtr); //skip command name
+    char *arg = strtok_r(NULL, " ", &savePtr);
+    while (arg != NULL) {
+        if (strcmp(arg, "reset") == 0) {
+            reset = true;
+        } else if (strcmp(arg, "h") == 0 || strcmp(arg, "histograms") == 0) {
+            histograms = true;
+        } else {
+            char *end = NULL;
+            nrOfEntries = strtol(arg, &end, 10);
+            if (end == arg || nrOfEntries <= 0) {
+                fprintf(errStream, "Invalid argument '%s'\n", arg);
+                free(copy);
+                return CELIX_ILLEGAL_ARGUMENT;
+            }
+        }
+        arg = strtok_r(NULL, " ", &savePtr);
+    }
+    free(copy);
+
+    if (!celixThreadLockProfiler_isEnabled()) {
+        fprintf(outStream, "Lock profiler not enabled. Build Celix with ENABLE_LOCK_PROFILING to enable it.\n");
+        return CELIX_SUCCESS;
+    }
+    if (reset) {
+        celixThreadLockProfiler_reset();
+        fprintf(outStream, "Lock profiles reset.\n");
+        return CELIX_SUCCESS;
+    }
+
+    celix_array_list_t *profiles = celixThreadLockProfiler_getProfiles();
+    fprintf(outStream, "  %-50s %-6s %10s %10s %12s %10s %10s %10s\n", "Site", "Type", "Locks", "Contended",
+            "Wait (ms)", "Max wait", "Avg hold", "Max hold");
+    for (int i = 0; i < celix_arrayList_size(profiles) && i < nrOfEntries; ++i) {
+        celix_thread_lock_profile_t *profile = celix_arrayList_get(profiles, i);
+        //note show the end of long sites (file paths), the start is mostly the same
+        size_t len = strlen(profile->site);
+        const char *site = len > 50 ? profile->site + (len - 50) : profile->site;
+        fprintf(outStream, "  %-50s %-6s %10lu %10lu %12.3f %10.3f %10.3f %10.3f\n", site,
+                profile->rwlock ? "rwlock" : "mutex", profile->nrOfLocks, profile->nrOfContendedLocks,
+                profile->totalWaitTimeInNs / 1000000.0, profile->maxWaitTimeInNs / 1000000.0,
+                profile->nrOfLocks > 0 ? profile->totalHoldTimeInNs / (double)profile->nrOfLocks / 1000000.0 : 0.0,
+                profile->maxHoldTimeInNs / 1000000.0);
+        if (histograms) {
+            locksCommand_printHistogram(outStream, "wait", profile->waitHistogram);
+            locksCommand_printHistogram(outStream, "hold", profile->holdHistogram);
+        }
+    }
+    celixThreadLockProfiler_destroyProfiles(profiles);
+    return CELIX_SUCCESS;
+}
@@ -0,0 +1,69 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *  KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "celix_bundle_context.h"
+#include "celix_framework.h"
+#include "bundle_context.h"
+#include "std_commands.h"
+
+static int memoryCommand_compareStats(const void *a, const void *b) {
+    const celix_framework_bundle_memory_stats_t *sa = *(const celix_framework_bundle_memory_stats_t**)a;
+    const celix_framework_bundle_memory_stats_t *sb = *(const celix_framework_bundle_memory_stats_t**)b;
+    return sa->totalInBytes < sb->totalInBytes ? 1 : (sa->totalInBytes > sb->totalInBytes ? -1 : 0);
+}
+
+celix_status_t memoryCommand_execute(void *handle, char *commandLine, FILE *outStream, FILE *errStream) {
+    celix_bundle_context_t *ctx = handle;
+    celix_framework_t *fw = NULL;
+    bundleContext_getFramework(ctx, &fw);
+    if (fw == NULL) {
+        fprintf(errStream, "Cannot get framework\n");
+        return CELIX_ILLEGAL_STATE;
+    }
+
+    celix_array_list_t *stats = celix_framework_getMemoryStats(fw);
+    int size = celix_arrayList_size(stats);
+    celix_framework_bundle_memory_stats_t *entries[size > 0 ? size : 1];
+    for (int i = 0; i < size; ++i) {
+        entries[i] = celix_arrayList_get(stats, i);
+    }
+    qsort(entries, (size_t)size, sizeof(entries[0]), memoryCommand_compareStats);
+
+    size_t total = 0;
+    fprintf(outStream, "  %-5s %-40s %10s %12s %12s %12s %12s %12s\n", "ID", "Name", "Total (B)", "Services", "Properties", "References", "Listeners", "Trackers");
+    for (int i = 0; i < size; ++i) {
+        celix_framework_bundle_memory_stats_t *entry = entries[i];
+        fprintf(outStream, "  %-5li %-40s %10zu %6zu/%-5zu %12zu %6zu/%-5zu %6zu/%-5zu %6zu/%-5zu\n", entry->bndId, entry->symbolicName,
+                entry->totalInBytes,
+                entry->nrOfServiceRegistrations, entry->serviceRegistrationsInBytes,
+                entry->servicePropertiesInBytes,
+                entry->nrOfServiceReferences, entry->serviceReferencesInBytes,
+                entry->nrOfServiceListeners, entry->serviceListenersInBytes,
+                entry->nrOfServiceTrackers, entry->serviceTrackersInBytes);
+        total += entry->totalInBytes;
+    }
+    fprintf(outStream, "  Total: %zu bytes (counts shown as <nr>/<bytes>)\n", total);
+
+    celix_framework_destroyMemoryStats(stats);
+    return CELIX_SUCCESS;
+}
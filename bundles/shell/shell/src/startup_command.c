@@ -0,0 +1,207 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *  KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "celix_bundle_context.h"
+#include "celix_bundle.h"
+#include "celix_framework.h"
+#include "celix_constants.h"
+#include "bundle_context.h"
+#include "std_commands.h"
+
+#define STARTUP_COMMAND_DEFAULT_NR_OF_ENTRIES 10
+
+typedef struct startup_bundle_entry {
+    long bndId;
+    char *name;
+    long long installInUs; //incl. the bundle archive creation
+    long long loadLibrariesInUs;
+    long long activatorInUs; //activator create and start
+    long long totalInUs;
+} startup_bundle_entry_t;
+
+typedef struct startup_component_entry {
+    long bndId;
+    char *name;
+    size_t nrOfTransitions;
+    long long totalInUs;
+    long long slowestTransitionInUs;
+    char *slowestTransition;
+} startup_component_entry_t;
+
+typedef struct startup_command_data {
+    celix_array_list_t *bundles; //value = startup_bundle_entry_t*
+    celix_array_list_t *components; //value = startup_component_entry_t*
+} startup_command_data_t;
+
+static startup_bundle_entry_t* startupCommand_getBundleEntry(startup_command_data_t *data, long bndId, const char *subject) {
+    for (int i = 0; i < celix_arrayList_size(data->bundles); ++i) {
+        startup_bundle_entry_t *entry = celix_arrayList_get(data->bundles, i);
+        if (entry->bndId == bndId) {
+            return entry;
+        }
+    }
+    startup_bundle_entry_t *entry = calloc(1, sizeof(*entry));
+    entry->bndId = bndId;
+    entry->name = strdup(subject);
+    celix_arrayList_add(data->bundles, entry);
+    return entry;
+}
+
+static startup_component_entry_t* startupCommand_getComponentEntry(startup_command_data_t *data, long bndId, const char *name) {
+    for (int i = 0; i < celix_arrayList_size(data->components); ++i) {
+        startup_component_entry_t *entry = celix_arrayList_get(data->components, i);
+        if (entry->bndId == bndId && strcmp(entry->name, name) == 0) {
+            return entry;
+        }
+    }
+    startup_component_entry_t *entry = calloc(1, sizeof(*entry));
+    entry->bndId = bndId;
+    entry->name = strdup(name);
+    celix_arrayList_add(data->components, entry);
+    return entry;
+}
+
+static void startupCommand_collect(void *handle, const celix_framework_startup_trace_event_t *event) {
+    startup_command_data_t *data = handle;
+    if (strcmp(event->category, "component") == 0) {
+        startup_component_entry_t *entry = startupCommand_getComponentEntry(data, event->bndId, event->subject);
+        entry->nrOfTransitions += 1;
+        entry->totalInUs += event->durationInUs;
+        if (entry->slowestTransition == NULL || event->durationInUs > entry->slowestTransitionInUs) {
+            free(entry->slowestTransition);
+            entry->slowestTransition = strdup(event->name);
+            entry->slowestTransitionInUs = event->durationInUs;
+        }
+    } else if (event->bndId > 0) {
+        startup_bundle_entry_t *entry = startupCommand_getBundleEntry(data, event->bndId, event->subject);
+        if (strcmp(event->name, "loadLibrary") == 0) {
+            entry->loadLibrariesInUs += event->durationInUs;
+            entry->totalInUs += event->durationInUs;
+        } else if (strcmp(event->name, "create") == 0 || strcmp(event->name, "start") == 0) {
+            entry->activatorInUs += event->durationInUs;
+            entry->totalInUs += event->durationInUs;
+        } else if (strcmp(event->name, "install") == 0) {
+            //note install includes the bundle archive creation, the archive event itself is not counted
+            entry->installInUs += event->durationInUs;
+            entry->totalInUs += event->durationInUs;
+        }
+    }
+}
+
+static void startupCommand_setBundleName(void *handle, const celix_bundle_t *bnd) {
+    startup_bundle_entry_t *entry = handle;
+    const char *name = celix_bundle_getSymbolicName(bnd);
+    if (name != NULL) {
+        free(entry->name);
+        entry->name = strdup(name);
+    }
+}
+
+static int startupCommand_compareBundles(const void *a, const void *b) {
+    const startup_bundle_entry_t *ea = *(const startup_bundle_entry_t**)a;
+    const startup_bundle_entry_t *eb = *(const startup_bundle_entry_t**)b;
+    return ea->totalInUs < eb->totalInUs ? 1 : (ea->totalInUs > eb->totalInUs ? -1 : 0);
+}
+
+static int startupCommand_compareComponents(const void *a, const void *b) {
+    const startup_component_entry_t *ea = *(const startup_component_entry_t**)a;
+    const startup_component_entry_t *eb = *(const startup_component_entry_t**)b;
+    return ea->totalInUs < eb->totalInUs ? 1 : (ea->totalInUs > eb->totalInUs ? -1 : 0);
+}
+
+celix_status_t startupCommand_execute(void *handle, char *commandLine, FILE *outStream, FILE *errStream) {
+    celix_bundle_context_t *ctx = handle;
+    celix_framework_t *fw = NULL;
+    bundleContext_getFramework(ctx, &fw);
+
+    long nrOfEntries = STARTUP_COMMAND_DEFAULT_NR_OF_ENTRIES;
+    char *copy = strdup(commandLine);
+    char *savePtr = NULL;
+    strtok_r(copy, " ", &savePtr); //skip command name
+    char *arg = strtok_r(NULL, " ", &savePtr);
+    if (arg != NULL) {
+        char *end = NULL;
+        nrOfEntries = strtol(arg, &end, 10);
+        if (end == arg || nrOfEntries <= 0) {
+            fprintf(errStream, "Invalid number of entries '%s'\n", arg);
+            free(copy);
+            return CELIX_ILLEGAL_ARGUMENT;
+        }
+    }
+    free(copy);
+
+    startup_command_data_t data;
+    data.bundles = celix_arrayList_create();
+    data.components = celix_arrayList_create();
+    bool enabled = fw != NULL && celix_framework_useStartupTraceEvents(fw, &data, startupCommand_collect);
+    if (!enabled) {
+        fprintf(outStream, "Startup trace not enabled. Configure %s to enable it.\n", CELIX_STARTUP_TRACE_FILE_NAME);
+    } else {
+        int nrOfBundles = celix_arrayList_size(data.bundles);
+        startup_bundle_entry_t *bundles[nrOfBundles > 0 ? nrOfBundles : 1];
+        for (int i = 0; i < nrOfBundles; ++i) {
+            bundles[i] = celix_arrayList_get(data.bundles, i);
+            celix_framework_useBundle(fw, false, bundles[i]->bndId, bundles[i], startupCommand_setBundleName);
+        }
+        qsort(bundles, (size_t)nrOfBundles, sizeof(bundles[0]), startupCommand_compareBundles);
+
+        fprintf(outStream, "Slowest bundles:\n");
+        fprintf(outStream, "  %-5s %-40s %12s %12s %12s %12s\n", "ID", "Name", "Total (ms)", "Install", "Libraries", "Activator");
+        for (int i = 0; i < nrOfBundles && i < nrOfEntries; ++i) {
+            startup_bundle_entry_t *entry = bundles[i];
+            fprintf(outStream, "  %-5li %-40s %12.3f %12.3f %12.3f %12.3f\n", entry->bndId, entry->name,
+                    entry->totalInUs / 1000.0, entry->installInUs / 1000.0, entry->loadLibrariesInUs / 1000.0, entry->activatorInUs / 1000.0);
+        }
+
+        int nrOfComponents = celix_arrayList_size(data.components);
+        startup_component_entry_t *components[nrOfComponents > 0 ? nrOfComponents : 1];
+        for (int i = 0; i < nrOfComponents; ++i) {
+            components[i] = celix_arrayList_get(data.components, i);
+        }
+        qsort(components, (size_t)nrOfComponents, sizeof(components[0]), startupCommand_compareComponents);
+
+        fprintf(outStream, "\nSlowest components:\n");
+        fprintf(outStream, "  %-5s %-40s %12s %12s  %s\n", "Bnd", "Name", "Total (ms)", "Transitions", "Slowest transition");
+        for (int i = 0; i < nrOfComponents && i < nrOfEntries; ++i) {
+            startup_component_entry_t *entry = components[i];
+            fprintf(outStream, "  %-5li %-40s %12.3f %12zu  %s (%.3f ms)\n", entry->bndId, entry->name,
+                    entry->totalInUs / 1000.0, entry->nrOfTransitions, entry->slowestTransition,
+                    entry->slowestTransitionInUs / 1000.0);
+        }
+    }
+
+    for (int i = 0; i < celix_arrayList_size(data.bundles); ++i) {
+        startup_bundle_entry_t *entry = celix_arrayList_get(data.bundles, i);
+        free(entry->name);
+        free(entry);
+    }
+    for (int i = 0; i < celix_arrayList_size(data.components); ++i) {
+        startup_component_entry_t *entry = celix_arrayList_get(data.components, i);
+        free(entry->name);
+        free(entry->slowestTransition);
+        free(entry);
+    }
+    celix_arrayList_destroy(data.bundles);
+    celix_arrayList_destroy(data.components);
+
+    return CELIX_SUCCESS;
+}
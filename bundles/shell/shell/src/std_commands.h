@@ -41,6 +41,10 @@ celix_status_t logCommand_execute(void *handle, char * commandline, FILE *outStr
 celix_status_t inspectCommand_execute(void *handle, char * commandline, FILE *outStream, FILE *errStream);
 celix_status_t helpCommand_execute(void *handle, char * commandline, FILE *outStream, FILE *errStream);
 celix_status_t dmListCommand_execute(void* handle, char * line, FILE *out, FILE *err);
+celix_status_t startupCommand_execute(void *handle, char *commandLine, FILE *outStream, FILE *errStream);
+celix_status_t memoryCommand_execute(void *handle, char *commandLine, FILE *outStream, FILE *errStream);
+celix_status_t locksCommand_execute(void *handle, char *commandLine, FILE *outStream, FILE *errStream);
+celix_status_t threadsCommand_execute(void *handle, char *commandLine, FILE *outStream, FILE *errStream);
 
 
 #endif
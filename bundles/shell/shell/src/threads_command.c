@@ -0,0 +1,140 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *  KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "celix_bundle_context.h"
+#include "celix_bundle.h"
+#include "celix_framework.h"
+#include "celix_threads.h"
+#include "bundle_context.h"
+#include "std_commands.h"
+
+#define THREADS_COMMAND_DEFAULT_NR_OF_ENTRIES 20
+
+typedef struct threads_command_bundle_entry {
+    long bndId;
+    char name[64];
+    size_t nrOfThreads;
+    unsigned long long cpuTimeInNs;
+    unsigned long nrOfContextSwitches;
+    unsigned long long allocatedBytes;
+} threads_command_bundle_entry_t;
+
+static void threadsCommand_setBundleName(void *handle, const celix_bundle_t *bnd) {
+    threads_command_bundle_entry_t *entry = handle;
+    const char *name = celix_bundle_getSymbolicName(bnd);
+    snprintf(entry->name, sizeof(entry->name), "%s", name != NULL ? name : "");
+}
+
+static int threadsCommand_compareThreads(const void *a, const void *b) {
+    const celix_thread_info_t *ta = *(const celix_thread_info_t**)a;
+    const celix_thread_info_t *tb = *(const celix_thread_info_t**)b;
+    return ta->cpuTimeInNs < tb->cpuTimeInNs ? 1 : (ta->cpuTimeInNs > tb->cpuTimeInNs ? -1 : 0);
+}
+
+static int threadsCommand_compareBundles(const void *a, const void *b) {
+    const threads_command_bundle_entry_t *ea = a;
+    const threads_command_bundle_entry_t *eb = b;
+    return ea->cpuTimeInNs < eb->cpuTimeInNs ? 1 : (ea->cpuTimeInNs > eb->cpuTimeInNs ? -1 : 0);
+}
+
+celix_status_t threadsCommand_execute(void *handle, char *commandLine, FILE *outStream, FILE *errStream) {
+    celix_bundle_context_t *ctx = handle;
+    celix_framework_t *fw = NULL;
+    bundleContext_getFramework(ctx, &fw);
+
+    long nrOfEntries = THREADS_COMMAND_DEFAULT_NR_OF_ENTRIES;
+    char *copy = strdup(commandLine);
+    char *savePtr = NULL;
+    strtok_r(copy, " ", &savePtr); //skip command name
+    char *arg = strtok_r(NULL, " ", &savePtr);
+    if (arg != NULL) {
+        char *end = NULL;
+        nrOfEntries = strtol(arg, &end, 10);
+        if (end == arg || nrOfEntries <= 0) {
+            fprintf(errStream, "Invalid number of entries '%s'\n", arg);
+            free(copy);
+            return CELIX_ILLEGAL_ARGUMENT;
+        }
+    }
+    free(copy);
+
+    celix_array_list_t *infos = celixThread_getThreadInfos();
+    int size = celix_arrayList_size(infos);
+    celix_thread_info_t *threads[size > 0 ? size : 1];
+    threads_command_bundle_entry_t bundles[size > 0 ? size : 1];
+    int nrOfBundles = 0;
+    for (int i = 0; i < size; ++i) {
+        threads[i] = celix_arrayList_get(infos, i);
+        threads_command_bundle_entry_t *entry = NULL;
+        for (int k = 0; k < nrOfBundles; ++k) {
+            if (bundles[k].bndId == threads[i]->ownerId) {
+                entry = &bundles[k];
+                break;
+            }
+        }
+        if (entry == NULL) {
+            entry = &bundles[nrOfBundles++];
+            memset(entry, 0, sizeof(*entry));
+            entry->bndId = threads[i]->ownerId;
+            if (fw != NULL && entry->bndId >= 0) {
+                celix_framework_useBundle(fw, false, entry->bndId, entry, threadsCommand_setBundleName);
+            }
+        }
+        entry->nrOfThreads += 1;
+        entry->cpuTimeInNs += threads[i]->cpuTimeInNs;
+        entry->nrOfContextSwitches += threads[i]->nrOfVoluntaryContextSwitches + threads[i]->nrOfInvoluntaryContextSwitches;
+        entry->allocatedBytes += threads[i]->allocatedBytes;
+    }
+    qsort(threads, (size_t)size, sizeof(threads[0]), threadsCommand_compareThreads);
+    qsort(bundles, (size_t)nrOfBundles, sizeof(bundles[0]), threadsCommand_compareBundles);
+
+    bool allocAccounting = celixThread_isAllocationAccountingEnabled();
+    fprintf(outStream, "Threads:\n");
+    fprintf(outStream, "  %-8s %-16s %-5s %12s %10s %10s %14s\n", "TID", "Name", "Bnd", "CPU (ms)", "Vol CS", "Invol CS",
+            allocAccounting ? "Allocated (B)" : "");
+    for (int i = 0; i < size && i < nrOfEntries; ++i) {
+        celix_thread_info_t *info = threads[i];
+        fprintf(outStream, "  %-8li %-16s %-5li %12.3f %10lu %10lu", info->tid, info->name, info->ownerId,
+                info->cpuTimeInNs / 1e6, info->nrOfVoluntaryContextSwitches, info->nrOfInvoluntaryContextSwitches);
+        if (allocAccounting) {
+            fprintf(outStream, " %14llu", info->allocatedBytes);
+        }
+        fprintf(outStream, "\n");
+    }
+
+    fprintf(outStream, "\nPer bundle:\n");
+    fprintf(outStream, "  %-5s %-40s %8s %12s %10s %14s\n", "Bnd", "Name", "Threads", "CPU (ms)", "CS",
+            allocAccounting ? "Allocated (B)" : "");
+    for (int i = 0; i < nrOfBundles; ++i) {
+        threads_command_bundle_entry_t *entry = &bundles[i];
+        fprintf(outStream, "  %-5li %-40s %8zu %12.3f %10lu", entry->bndId, entry->bndId >= 0 ? entry->name : "<unknown>",
+                entry->nrOfThreads, entry->cpuTimeInNs / 1e6, entry->nrOfContextSwitches);
+        if (allocAccounting) {
+            fprintf(outStream, " %14llu", entry->allocatedBytes);
+        }
+        fprintf(outStream, "\n");
+    }
+
+    celixThread_destroyThreadInfos(infos);
+    return CELIX_SUCCESS;
+}
@@ -28,7 +28,8 @@ function docReady() {
         document.getElementById("console_output").innerHTML = html;
     };
     shellSocket.onopen = function (event) {
-        shellSocket.send("lb");
+        //the bundle list is pushed again when the bundles change
+        shellSocket.send("subscribe lb");
     };
 
     document.getElementById("command_button").onclick = function() {
@@ -25,59 +25,296 @@
 #include <civetweb.h>
 
 #include "http_admin/api.h"
+#include "hash_map.h"
+#include "utils.h"
+#include "celix_threads.h"
+
+#define SHELL_WUI_SUBSCRIBE         "subscribe "
+#define SHELL_WUI_UNSUBSCRIBE       "unsubscribe"
+#define SHELL_WUI_GROUP_PREFIX      "shell_wui/"
+#define SHELL_WUI_REFRESH_DELAY_MS  100 //bundle events within this delay result in a single refresh
+
+/**
+ * Output of a command followed by one or more websocket connections. The command is executed again when the bundles
+ * change and its output is broadcast to the followers (the broadcast group of the command) only if it changed.
+ */
+typedef struct shell_wui_subscription {
+    char *command;
+    char *group;
+    char *output;       //NULL till the command is executed
+    int nrOfFollowers;
+} shell_wui_subscription_t;
 
 typedef struct shell_wui_activator_data {
     celix_bundle_context_t *ctx;
 
     celix_websocket_service_t sockSvc;
     long sockSvcId;
+    long bundleTrackerId;
+
+    celix_thread_t refreshThread;
+    celix_thread_mutex_t mutex; //protects below
+    celix_thread_cond_t cond;
+    bool running;
+    bool dirty;
+    hash_map_pt subscriptions;  //key = command, value = shell_wui_subscription_t
+    hash_map_pt followers;      //key = connection, value = shell_wui_subscription_t followed by the connection
 } shell_wui_activator_data_t;
 
 struct use_shell_arg {
     char *command;
+    char *output;
+    size_t size;
+};
+
+struct use_broadcast_arg {
+    const char *group;
     struct mg_connection *conn;
+    const char *output;
+    bool join;
 };
 
 static void useShell(void *handle, void *svc) {
     shell_service_t *shell = svc;
     struct use_shell_arg *arg = handle;
-    char *buf = NULL;
-    size_t size;
-    FILE *out = open_memstream(&buf, &size);
+    FILE *out = open_memstream(&arg->output, &arg->size);
     shell->executeCommand(shell->shell, arg->command, out, out);
     fclose(out);
-    mg_websocket_write(arg->conn, MG_WEBSOCKET_OPCODE_TEXT, buf, size);
 };
 
-static int websocket_data_handler(struct mg_connection *conn, int bits, char *data, size_t data_len, void *handle) {
-    shell_wui_activator_data_t *act = handle;
+/**
+ * Returns the output of the command, or NULL if no shell is available. The caller owns the output.
+ */
+static char* shellWui_execute(shell_wui_activator_data_t *act, const char *command, size_t *size) {
     struct use_shell_arg arg;
-    arg.conn = conn;
+    memset(&arg, 0, sizeof(arg));
+    arg.command = (char *) command;
+    celix_bundleContext_useService(act->ctx, OSGI_SHELL_SERVICE_NAME, &arg, useShell);
+    *size = arg.size;
+    return arg.output;
+}
 
-    //NOTE data is a not null terminated string..
-    arg.command = calloc(data_len+1, sizeof(char));
-    memcpy(arg.command, data, data_len);
-    arg.command[data_len] = '\0';
+static void useBroadcast(void *handle, void *svc) {
+    celix_websocket_broadcast_service_t *broadcast = svc;
+    struct use_broadcast_arg *arg = handle;
+    if (arg->output != NULL) {
+        broadcast->broadcast(broadcast->handle, arg->group, MG_WEBSOCKET_OPCODE_TEXT, arg->output, strlen(arg->output));
+    } else if (arg->join) {
+        broadcast->join(broadcast->handle, arg->group, arg->conn);
+    } else {
+        broadcast->leave(broadcast->handle, arg->group, arg->conn);
+    }
+}
 
+static void shellWui_useBroadcast(shell_wui_activator_data_t *act, const char *group, struct mg_connection *conn, const char *output, bool join) {
+    struct use_broadcast_arg arg = {.group = group, .conn = conn, .output = output, .join = join};
+    celix_bundleContext_useService(act->ctx, WEBSOCKET_BROADCAST_SERVICE_NAME, &arg, useBroadcast);
+}
+
+static void shellWui_destroySubscription(shell_wui_subscription_t *sub) {
+    free(sub->command);
+    free(sub->group);
+    free(sub->output);
+    free(sub);
+}
+
+/**
+ * Stops following a command. Note act->mutex should be locked, the group is left by the caller.
+ * Returns the broadcast group to leave (owned by the caller) or NULL.
+ */
+static char* shellWui_unfollow(shell_wui_activator_data_t *act, const struct mg_connection *conn) {
+    shell_wui_subscription_t *sub = hashMap_remove(act->followers, conn);
+    char *group = NULL;
+    if (sub != NULL) {
+        group = strdup(sub->group);
+        if (--sub->nrOfFollowers == 0) {
+            hashMap_remove(act->subscriptions, sub->command);
+            shellWui_destroySubscription(sub);
+        }
+    }
+    return group;
+}
 
-    bool called = celix_bundleContext_useService(act->ctx, OSGI_SHELL_SERVICE_NAME, &arg, useShell);
-    if (!called) {
+static void shellWui_unsubscribe(shell_wui_activator_data_t *act, struct mg_connection *conn) {
+    celixThreadMutex_lock(&act->mutex);
+    char *group = shellWui_unfollow(act, conn);
+    celixThreadMutex_unlock(&act->mutex);
+    if (group != NULL) {
+        shellWui_useBroadcast(act, group, conn, NULL, false);
+        free(group);
+    }
+}
+
+/**
+ * Lets the connection follow the output of the command, the current output is sent right away. A connection follows
+ * at most one command.
+ */
+static void shellWui_subscribe(shell_wui_activator_data_t *act, struct mg_connection *conn, const char *command) {
+    shellWui_unsubscribe(act, conn);
+
+    celixThreadMutex_lock(&act->mutex);
+    shell_wui_subscription_t *sub = hashMap_get(act->subscriptions, command);
+    if (sub == NULL) {
+        sub = calloc(1, sizeof(*sub));
+        sub->command = strdup(command);
+        asprintf(&sub->group, "%s%s", SHELL_WUI_GROUP_PREFIX, command);
+        hashMap_put(act->subscriptions, sub->command, sub);
+    }
+    sub->nrOfFollowers += 1;
+    hashMap_put(act->followers, conn, sub);
+    char *group = strdup(sub->group);
+    char *output = sub->output != NULL ? strdup(sub->output) : NULL;
+    celixThreadMutex_unlock(&act->mutex);
+
+    //join before sending the current output, so no change is missed
+    shellWui_useBroadcast(act, group, conn, NULL, true);
+    size_t size = output != NULL ? strlen(output) : 0;
+    if (output == NULL) {
+        output = shellWui_execute(act, command, &size);
+        celixThreadMutex_lock(&act->mutex);
+        sub = hashMap_get(act->subscriptions, command);
+        if (sub != NULL && sub->output == NULL && output != NULL) {
+            sub->output = strdup(output);
+        }
+        celixThreadMutex_unlock(&act->mutex);
+    }
+    if (output != NULL) {
+        mg_websocket_write(conn, MG_WEBSOCKET_OPCODE_TEXT, output, size);
+    } else {
         const char *msg = "No shell available!";
         mg_websocket_write(conn, MG_WEBSOCKET_OPCODE_TEXT, msg , strlen(msg));
     }
 
-    free(arg.command);
+    free(output);
+    free(group);
+}
+
+static int websocket_data_handler(struct mg_connection *conn, int bits, char *data, size_t data_len, void *handle) {
+    shell_wui_activator_data_t *act = handle;
+
+    //NOTE data is a not null terminated string..
+    char *command = calloc(data_len+1, sizeof(char));
+    memcpy(command, data, data_len);
+    command[data_len] = '\0';
+
+    size_t subscribeLen = strlen(SHELL_WUI_SUBSCRIBE);
+    if (strncmp(command, SHELL_WUI_SUBSCRIBE, subscribeLen) == 0) {
+        shellWui_subscribe(act, conn, command + subscribeLen);
+    } else {
+        //the output of a one-off command is not overwritten by the followed command
+        shellWui_unsubscribe(act, conn);
+        if (strcmp(command, SHELL_WUI_UNSUBSCRIBE) != 0) {
+            size_t size = 0;
+            char *output = shellWui_execute(act, command, &size);
+            if (output != NULL) {
+                mg_websocket_write(conn, MG_WEBSOCKET_OPCODE_TEXT, output, size);
+                free(output);
+            } else {
+                const char *msg = "No shell available!";
+                mg_websocket_write(conn, MG_WEBSOCKET_OPCODE_TEXT, msg , strlen(msg));
+            }
+        }
+    }
+
+    free(command);
     return 1; //keep open
 }
 
+static void websocket_close_handler(const struct mg_connection *conn, void *handle) {
+    shell_wui_activator_data_t *act = handle;
+    //the websocket admin removes the connection from the broadcast groups
+    celixThreadMutex_lock(&act->mutex);
+    free(shellWui_unfollow(act, conn));
+    celixThreadMutex_unlock(&act->mutex);
+}
+
+static void shellWui_onBundleEvent(void *handle, const celix_bundle_event_t *event __attribute__((unused))) {
+    shell_wui_activator_data_t *act = handle;
+    celixThreadMutex_lock(&act->mutex);
+    act->dirty = true;
+    celixThreadCondition_signal(&act->cond);
+    celixThreadMutex_unlock(&act->mutex);
+}
+
+/**
+ * Executes the followed commands after bundle changes, the output of a command is broadcast once to all its
+ * followers if it changed. Commands are executed on this thread, not on the event thread of the framework.
+ */
+static void* shellWui_refreshThread(void *data) {
+    shell_wui_activator_data_t *act = data;
+
+    celixThreadMutex_lock(&act->mutex);
+    while (act->running) {
+        if (!act->dirty) {
+            celixThreadCondition_wait(&act->cond, &act->mutex);
+            continue;
+        }
+        celixThreadCondition_timedwaitRelative(&act->cond, &act->mutex, 0, SHELL_WUI_REFRESH_DELAY_MS * 1000000L);
+        if (!act->running) {
+            break;
+        }
+        act->dirty = false;
+
+        celix_array_list_t *commands = celix_arrayList_create();
+        hash_map_iterator_t iter = hashMapIterator_construct(act->subscriptions);
+        while (hashMapIterator_hasNext(&iter)) {
+            shell_wui_subscription_t *sub = hashMapIterator_nextValue(&iter);
+            celix_arrayList_add(commands, strdup(sub->command));
+        }
+        celixThreadMutex_unlock(&act->mutex);
+
+        for (int i = 0; i < celix_arrayList_size(commands); ++i) {
+            char *command = celix_arrayList_get(commands, i);
+            size_t size = 0;
+            char *output = shellWui_execute(act, command, &size);
+
+            char *group = NULL;
+            celixThreadMutex_lock(&act->mutex);
+            shell_wui_subscription_t *sub = hashMap_get(act->subscriptions, command);
+            if (sub != NULL && output != NULL && (sub->output == NULL || strcmp(sub->output, output) != 0)) {
+                free(sub->output);
+                sub->output = strdup(output);
+                group = strdup(sub->group);
+            }
+            celixThreadMutex_unlock(&act->mutex);
+
+            if (group != NULL) {
+                shellWui_useBroadcast(act, group, NULL, output, false);
+                free(group);
+            }
+            free(output);
+            free(command);
+        }
+        celix_arrayList_destroy(commands);
+
+        celixThreadMutex_lock(&act->mutex);
+    }
+    celixThreadMutex_unlock(&act->mutex);
+
+    return NULL;
+}
+
 
 static celix_status_t shellWui_activator_start(shell_wui_activator_data_t *data, celix_bundle_context_t *ctx) {
     data->ctx = ctx;
+    data->subscriptions = hashMap_create(utils_stringHash, NULL, utils_stringEquals, NULL);
+    data->followers = hashMap_create(NULL, NULL, NULL, NULL);
+    celixThreadMutex_create(&data->mutex, NULL);
+    celixThreadCondition_init(&data->cond, NULL);
+    data->running = true;
+    celixThread_create(&data->refreshThread, NULL, shellWui_refreshThread, data);
+    celixThread_setName(&data->refreshThread, "ShellWuiRefresh");
+
+    celix_bundle_tracking_options_t opts = CELIX_EMPTY_BUNDLE_TRACKING_OPTIONS;
+    opts.callbackHandle = data;
+    opts.onBundleEvent = shellWui_onBundleEvent;
+    data->bundleTrackerId = celix_bundleContext_trackBundlesWithOptions(ctx, &opts);
 
     celix_properties_t *props = celix_properties_create();
     celix_properties_set(props, WEBSOCKET_ADMIN_URI, "/shell/socket");
     data->sockSvc.handle = data;
     data->sockSvc.data = websocket_data_handler;
+    data->sockSvc.close = websocket_close_handler;
     data->sockSvcId = celix_bundleContext_registerService(ctx, &data->sockSvc, WEBSOCKET_ADMIN_SERVICE_NAME, props);
 
     return CELIX_SUCCESS;
@@ -86,8 +323,24 @@ static celix_status_t shellWui_activator_start(shell_wui_activator_data_t *data,
 static celix_status_t shellWui_activator_stop(shell_wui_activator_data_t *data, celix_bundle_context_t *ctx) {
 
     celix_bundleContext_unregisterService(ctx, data->sockSvcId);
+    celix_bundleContext_stopTracker(ctx, data->bundleTrackerId);
+
+    celixThreadMutex_lock(&data->mutex);
+    data->running = false;
+    celixThreadCondition_broadcast(&data->cond);
+    celixThreadMutex_unlock(&data->mutex);
+    celixThread_join(data->refreshThread, NULL);
+
+    hash_map_iterator_t iter = hashMapIterator_construct(data->subscriptions);
+    while (hashMapIterator_hasNext(&iter)) {
+        shellWui_destroySubscription(hashMapIterator_nextValue(&iter));
+    }
+    hashMap_destroy(data->subscriptions, false, false);
+    hashMap_destroy(data->followers, false, false);
+    celixThreadCondition_destroy(&data->cond);
+    celixThreadMutex_destroy(&data->mutex);
 
     return CELIX_SUCCESS;
 }
 
-CELIX_GEN_BUNDLE_ACTIVATOR(shell_wui_activator_data_t, shellWui_activator_start, shellWui_activator_stop)
\ No newline at end of file
+CELIX_GEN_BUNDLE_ACTIVATOR(shell_wui_activator_data_t, shellWui_activator_start, shellWui_activator_stop)
@@ -0,0 +1,181 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *  KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include <string.h>
+
+#include "celix_api.h"
+#include "civetweb.h"
+
+#include <CppUTest/TestHarness.h>
+
+#define HTTP_PORT 8010
+#define TST_BUNDLE_NAME "shell_wui_tst_bundle"
+
+extern celix_framework_t *fw;
+
+namespace {
+    struct client {
+        std::mutex mutex{};
+        std::condition_variable cond{};
+        std::vector<std::string> received{};
+        struct mg_connection *connection{nullptr};
+
+        static int data(struct mg_connection */*connection*/, int flags, char *data, size_t length, void *handle) {
+            auto *c = static_cast<client*>(handle);
+            if ((flags & 0xf) == MG_WEBSOCKET_OPCODE_TEXT) {
+                std::lock_guard<std::mutex> lck{c->mutex};
+                c->received.emplace_back(data, length);
+                c->cond.notify_all();
+            }
+            return 1; //keep open
+        }
+
+        void connect() {
+            char err_buf[100] = {0};
+            //the websocket service of the shell_wui is registered when the framework is started
+            for (int i = 0; i < 50 && connection == nullptr; ++i) {
+                connection = mg_connect_websocket_client("127.0.0.1", HTTP_PORT, 0, err_buf, sizeof(err_buf),
+                        "/shell/socket", nullptr, client::data, nullptr, this);
+                if (connection == nullptr) {
+                    std::this_thread::sleep_for(std::chrono::milliseconds{100});
+                }
+            }
+            CHECK(connection != nullptr);
+        }
+
+        void send(const char *command) {
+            CHECK(mg_websocket_client_write(connection, MG_WEBSOCKET_OPCODE_TEXT, command, strlen(command)) > 0);
+        }
+
+        size_t size() {
+            std::lock_guard<std::mutex> lck{mutex};
+            return received.size();
+        }
+
+        /**
+         * Waits till the last received output matches the predicate.
+         */
+        bool waitForLast(const std::function<bool(const std::string&)> &pred) {
+            std::unique_lock<std::mutex> lck{mutex};
+            return cond.wait_for(lck, std::chrono::seconds{5}, [&]{ return !received.empty() && pred(received.back()); });
+        }
+
+        ~client() {
+            if (connection != nullptr) {
+                mg_close_connection(connection);
+            }
+        }
+    };
+
+    bool hasTstBundle(const std::string &output) {
+        return output.find(TST_BUNDLE_NAME) != std::string::npos;
+    }
+
+    bool hasNoTstBundle(const std::string &output) {
+        return output.find("shell_wui") != std::string::npos && !hasTstBundle(output);
+    }
+}
+
+TEST_GROUP(SHELL_WUI_GROUP)
+{
+    celix_bundle_context_t *ctx = nullptr;
+
+    void setup() {
+        ctx = celix_framework_getFrameworkContext(fw);
+    }
+};
+
+TEST(SHELL_WUI_GROUP, one_off_command) {
+    client c{};
+    c.connect();
+    c.send("lb");
+    CHECK(c.waitForLast(hasNoTstBundle));
+    CHECK_EQUAL(1, (int) c.size());
+
+    //not followed, so no output is pushed when the bundles change
+    long bndId = celix_bundleContext_installBundle(ctx, TST_BUNDLE_LOC, true);
+    CHECK(bndId >= 0);
+    std::this_thread::sleep_for(std::chrono::milliseconds{500});
+    CHECK_EQUAL(1, (int) c.size());
+    CHECK(celix_bundleContext_uninstallBundle(ctx, bndId));
+}
+
+TEST(SHELL_WUI_GROUP, subscribed_output_is_pushed) {
+    client c{};
+    c.connect();
+    c.send("subscribe lb");
+    CHECK(c.waitForLast(hasNoTstBundle));
+
+    long bndId = celix_bundleContext_installBundle(ctx, TST_BUNDLE_LOC, true);
+    CHECK(bndId >= 0);
+    CHECK(c.waitForLast(hasTstBundle));
+
+    CHECK(celix_bundleContext_uninstallBundle(ctx, bndId));
+    CHECK(c.waitForLast(hasNoTstBundle));
+}
+
+TEST(SHELL_WUI_GROUP, followers_share_subscription) {
+    client first{};
+    client second{};
+    first.connect();
+    second.connect();
+    first.send("subscribe lb");
+    CHECK(first.waitForLast(hasNoTstBundle));
+    //a new follower gets the current output right away
+    second.send("subscribe lb");
+    CHECK(second.waitForLast(hasNoTstBundle));
+    {
+        std::lock_guard<std::mutex> lck1{first.mutex};
+        std::lock_guard<std::mutex> lck2{second.mutex};
+        STRCMP_EQUAL(first.received.back().c_str(), second.received.back().c_str());
+    }
+
+    long bndId = celix_bundleContext_installBundle(ctx, TST_BUNDLE_LOC, true);
+    CHECK(first.waitForLast(hasTstBundle));
+    CHECK(second.waitForLast(hasTstBundle));
+
+    //unsubscribe stops the pushes for that client only
+    second.send("unsubscribe");
+    std::this_thread::sleep_for(std::chrono::milliseconds{200});
+    size_t nrOfOutputs = second.size();
+    CHECK(celix_bundleContext_uninstallBundle(ctx, bndId));
+    CHECK(first.waitForLast(hasNoTstBundle));
+    std::this_thread::sleep_for(std::chrono::milliseconds{500});
+    CHECK_EQUAL(nrOfOutputs, second.size());
+}
+
+TEST(SHELL_WUI_GROUP, unchanged_output_is_not_pushed) {
+    client c{};
+    c.connect();
+    c.send("subscribe help");
+    CHECK(c.waitForLast([](const std::string &output) { return !output.empty(); }));
+
+    //the bundles change, but the output of help does not
+    long bndId = celix_bundleContext_installBundle(ctx, TST_BUNDLE_LOC, true);
+    CHECK(celix_bundleContext_uninstallBundle(ctx, bndId));
+    std::this_thread::sleep_for(std::chrono::milliseconds{500});
+    CHECK_EQUAL(1, (int) c.size());
+}
@@ -0,0 +1,64 @@
+# Licensed to the Apache Software Foundation (ASF) under one
+# or more contributor license agreements.  See the NOTICE file
+# distributed with this work for additional information
+# regarding copyright ownership.  The ASF licenses this file
+# to you under the Apache License, Version 2.0 (the
+# "License"); you may not use this file except in compliance
+# with the License.  You may obtain a copy of the License at
+# 
+#   http://www.apache.org/licenses/LICENSE-2.0
+# 
+# Unless required by applicable law or agreed to in writing,
+# software distributed under the License is distributed on an
+# "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+# KIND, either express or implied.  See the License for the
+# specific language governing permissions and limitations
+# under the License.
+
+#[[
+Generate dfi codecs (json/avrobin serialization and json rpc functions) ahead of time for dfi descriptors and add the
+generated code to a target. The generated codecs register themselves when the target is loaded and are used by dfi for
+descriptors with the same name, version and layout; see dfi_codec.h.
+
+The generated code must outlive the descriptors parsed by dfi, so the target should be an executable (or a library
+which is never unloaded) and not a bundle.
+
+celix_generate_dfi_codecs(<target>
+    [PREFIX prefix]
+    DESCRIPTORS descriptor1.descriptor interface.avpr ...
+)
+
+Optional Arguments:
+- PREFIX: The prefix of the generated C symbols. Default is <target>_dfi_codecs.
+]]
+function(celix_generate_dfi_codecs)
+    list(GET ARGN 0 TARGET_NAME)
+    list(REMOVE_AT ARGN 0)
+
+    set(OPTIONS )
+    set(ONE_VAL_ARGS PREFIX)
+    set(MULTI_VAL_ARGS DESCRIPTORS)
+    cmake_parse_arguments(CODECS "${OPTIONS}" "${ONE_VAL_ARGS}" "${MULTI_VAL_ARGS}" ${ARGN})
+
+    if (NOT DEFINED CODECS_PREFIX)
+        set(CODECS_PREFIX "${TARGET_NAME}_dfi_codecs")
+    endif ()
+    if (NOT TARGET Celix::dfi_codegen)
+        message(FATAL_ERROR "Cannot generate dfi codecs for ${TARGET_NAME}, Celix::dfi_codegen is not available")
+    endif ()
+
+    set(INPUTS "")
+    foreach (DESCRIPTOR IN LISTS CODECS_DESCRIPTORS)
+        get_filename_component(ABS_DESCRIPTOR ${DESCRIPTOR} ABSOLUTE)
+        list(APPEND INPUTS ${ABS_DESCRIPTOR})
+    endforeach ()
+
+    set(OUTPUT "${CMAKE_CURRENT_BINARY_DIR}/${CODECS_PREFIX}.c")
+    add_custom_command(OUTPUT "${OUTPUT}"
+        COMMAND $<TARGET_FILE:Celix::dfi_codegen> -o "${OUTPUT}" -p ${CODECS_PREFIX} ${INPUTS}
+        DEPENDS Celix::dfi_codegen ${INPUTS}
+        COMMENT "Generating dfi codecs for ${TARGET_NAME}" VERBATIM
+    )
+    target_sources(${TARGET_NAME} PRIVATE "${OUTPUT}")
+    target_link_libraries(${TARGET_NAME} PRIVATE Celix::dfi)
+endfunction()
@@ -28,6 +28,7 @@ include(${CELIX_CMAKE_DIRECTORY}/ContainerPackaging.cmake)
 include(${CELIX_CMAKE_DIRECTORY}/DockerPackaging.cmake)
 include(${CELIX_CMAKE_DIRECTORY}/Runtimes.cmake)
 include(${CELIX_CMAKE_DIRECTORY}/Generic.cmake)
+include(${CELIX_CMAKE_DIRECTORY}/DfiCodegen.cmake)
 
 #find required packages
 find_package(CURL REQUIRED) #framework, etcdlib
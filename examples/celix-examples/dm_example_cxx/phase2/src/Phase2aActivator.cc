@@ -37,15 +37,15 @@ Phase2Activator::Phase2Activator(std::shared_ptr<celix::dm::DependencyManager> m
 
     cmp.createServiceDependency<IPhase1>()
             .setRequired(true)
-            .setCallbacks(&Phase2Cmp::setPhase1);
+            .setCallbacks<&Phase2Cmp::setPhase1>();
 
     cmp.createServiceDependency<srv::info::IName>()
             .setVersionRange("[1.0.0,2)")
-            .setCallbacks(&Phase2Cmp::setName);
+            .setCallbacks<&Phase2Cmp::setName>();
 
     cmp.createCServiceDependency<log_service_t>(OSGI_LOGSERVICE_NAME)
             .setRequired(false)
-            .setCallbacks(&Phase2Cmp::setLogService);
+            .setCallbacks<&Phase2Cmp::setLogService>();
 }
 
 CELIX_GEN_CXX_BUNDLE_ACTIVATOR(Phase2Activator)
\ No newline at end of file
@@ -0,0 +1,60 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *  KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include "allocation_counter.h"
+
+#include <atomic>
+
+#ifdef __GLIBC__
+
+static std::atomic<size_t> allocationCount{0};
+
+extern "C" {
+extern void* __libc_malloc(size_t size);
+extern void* __libc_calloc(size_t nmemb, size_t size);
+extern void* __libc_realloc(void *ptr, size_t size);
+
+//note replaces the glibc allocation functions, so that the allocations of libraries (e.g. dfi, jansson) are counted
+void* malloc(size_t size) {
+    allocationCount.fetch_add(1, std::memory_order_relaxed);
+    return __libc_malloc(size);
+}
+
+void* calloc(size_t nmemb, size_t size) {
+    allocationCount.fetch_add(1, std::memory_order_relaxed);
+    return __libc_calloc(nmemb, size);
+}
+
+void* realloc(void *ptr, size_t size) {
+    allocationCount.fetch_add(1, std::memory_order_relaxed);
+    return __libc_realloc(ptr, size);
+}
+}
+
+size_t dfiBenchmark_allocationCount() {
+    return allocationCount.load(std::memory_order_relaxed);
+}
+
+#else
+
+size_t dfiBenchmark_allocationCount() {
+    return 0;
+}
+
+#endif
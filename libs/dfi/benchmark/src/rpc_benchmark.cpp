@@ -0,0 +1,179 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *  KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <benchmark/benchmark.h>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "allocation_counter.h"
+extern "C" {
+#include "dyn_interface.h"
+#include "dyn_function.h"
+#include "json_rpc.h"
+#include "avrobin_rpc.h"
+}
+
+static const char *CALCULATOR_DESCRIPTOR =
+    ":header\n"
+    "type=interface\n"
+    "name=calculator\n"
+    "version=1.0.0\n"
+    ":annotations\n"
+    "classname=org.example.Calculator\n"
+    ":types\n"
+    ":methods\n"
+    "add(DD)D=add(#am=handle;PDD#am=pre;*D)N\n"
+    "sum([D)D=sum(#am=handle;P[D#am=pre;*D)N\n";
+
+struct double_seq {
+    uint32_t cap;
+    uint32_t len;
+    double *buf;
+};
+
+struct calculator_service {
+    void *handle;
+    int (*add)(void *handle, double a, double b, double *result);
+    int (*sum)(void *handle, struct double_seq input, double *result);
+};
+
+static int calculator_add(void*, double a, double b, double *result) {
+    *result = a + b;
+    return 0;
+}
+
+static int calculator_sum(void*, struct double_seq input, double *result) {
+    double total = 0.0;
+    for (uint32_t i = 0; i < input.len; ++i) {
+        total += input.buf[i];
+    }
+    *result = total;
+    return 0;
+}
+
+/**
+ * Calculator interface and service; the args of the sum call use a sequence of state.range(0) doubles.
+ */
+class CalculatorFixture {
+public:
+    explicit CalculatorFixture(size_t sumInputSize) : input(sumInputSize, 1.5) {
+        FILE *stream = fmemopen((void*)CALCULATOR_DESCRIPTOR, strlen(CALCULATOR_DESCRIPTOR), "r");
+        if (stream == nullptr || dynInterface_parse(stream, &intf) != 0 ||
+                dynInterface_findMethod(intf, "add(DD)D", &add) != 0 ||
+                dynInterface_findMethod(intf, "sum([D)D", &sum) != 0) {
+            std::abort();
+        }
+        fclose(stream);
+        seq.cap = seq.len = (uint32_t)input.size();
+        seq.buf = input.data();
+    }
+
+    ~CalculatorFixture() {
+        dynInterface_destroy(intf);
+    }
+
+    CalculatorFixture(const CalculatorFixture&) = delete;
+    CalculatorFixture& operator=(const CalculatorFixture&) = delete;
+
+    std::vector<double> input;
+    double_seq seq{};
+    calculator_service service{nullptr, calculator_add, calculator_sum};
+    dyn_interface_type *intf{nullptr};
+    struct method_entry *add{nullptr};
+    struct method_entry *sum{nullptr};
+};
+
+static void reportCounters(benchmark::State& state, size_t wireSize, size_t allocations) {
+    state.SetItemsProcessed(state.iterations());
+    state.SetBytesProcessed(state.iterations() * wireSize);
+    state.counters["allocs/call"] = benchmark::Counter((double)allocations, benchmark::Counter::kAvgIterations);
+    state.counters["wireSize"] = (double)wireSize;
+}
+
+/**
+ * Request encoding, service invocation and reply decoding of a single call, i.e. a remote call without transport.
+ */
+static void JsonRpcRoundtrip(benchmark::State& state, bool useSum) {
+    CalculatorFixture calc{(size_t)state.range(0)};
+    struct method_entry *method = useSum ? calc.sum : calc.add;
+    double a = 1.0;
+    double b = 2.0;
+    double result = 0.0;
+    double *out = &result;
+    void *addArgs[] = {nullptr, &a, &b, &out};
+    void *sumArgs[] = {nullptr, &calc.seq, &out};
+    void **args = useSum ? sumArgs : addArgs;
+
+    size_t wireSize = 0;
+    size_t allocations = dfiBenchmark_allocationCount();
+    for (auto _ : state) {
+        char *request = nullptr;
+        char *reply = nullptr;
+        jsonRpc_prepareInvokeRequest(method->dynFunc, method->id, args, &request);
+        jsonRpc_call(calc.intf, &calc.service, request, &reply);
+        jsonRpc_handleReply(method->dynFunc, reply, args);
+        wireSize = strlen(request) + strlen(reply);
+        free(request);
+        free(reply);
+    }
+    benchmark::DoNotOptimize(result);
+    reportCounters(state, wireSize, dfiBenchmark_allocationCount() - allocations);
+}
+BENCHMARK_CAPTURE(JsonRpcRoundtrip, add, false)->Arg(0);
+BENCHMARK_CAPTURE(JsonRpcRoundtrip, sum, true)->Arg(16)->Arg(1024);
+
+/**
+ * Same as JsonRpcRoundtrip, but using the avrobin binary rpc encoding.
+ */
+static void AvrobinRpcRoundtrip(benchmark::State& state, bool useSum) {
+    CalculatorFixture calc{(size_t)state.range(0)};
+    struct method_entry *method = useSum ? calc.sum : calc.add;
+    double a = 1.0;
+    double b = 2.0;
+    double result = 0.0;
+    double *out = &result;
+    void *addArgs[] = {nullptr, &a, &b, &out};
+    void *sumArgs[] = {nullptr, &calc.seq, &out};
+    void **args = useSum ? sumArgs : addArgs;
+
+    uint64_t callId = 0;
+    size_t wireSize = 0;
+    size_t allocations = dfiBenchmark_allocationCount();
+    for (auto _ : state) {
+        uint8_t *request = nullptr;
+        size_t requestLen = 0;
+        uint8_t *reply = nullptr;
+        size_t replyLen = 0;
+        int replyStatus = 0;
+        ++callId;
+        avrobinRpc_prepareInvokeRequest(method->dynFunc, method->id, callId, args, &request, &requestLen);
+        avrobinRpc_call(calc.intf, &calc.service, request, requestLen, &reply, &replyLen);
+        avrobinRpc_handleReply(method->dynFunc, callId, reply, replyLen, args, &replyStatus);
+        wireSize = requestLen + replyLen;
+        free(request);
+        free(reply);
+    }
+    benchmark::DoNotOptimize(result);
+    reportCounters(state, wireSize, dfiBenchmark_allocationCount() - allocations);
+}
+BENCHMARK_CAPTURE(AvrobinRpcRoundtrip, add, false)->Arg(0);
+BENCHMARK_CAPTURE(AvrobinRpcRoundtrip, sum, true)->Arg(16)->Arg(1024);
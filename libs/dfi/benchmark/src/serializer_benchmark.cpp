@@ -0,0 +1,197 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *  KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <benchmark/benchmark.h>
+#include <string>
+#include <cstdlib>
+#include <cstring>
+
+#include "allocation_counter.h"
+extern "C" {
+#include "dyn_type.h"
+#include "json_serializer.h"
+#include "avrobin_serializer.h"
+#include "celix_arena.h"
+}
+
+/**
+ * A message shape: a dyn type descriptor with a (json) corpus message, the message instance is created from the json.
+ */
+struct MessageShape {
+    const char *name;
+    const char *descriptor;
+    std::string json;
+};
+
+static std::string numbersJson(int count, bool reals) {
+    std::string result = "[";
+    for (int i = 0; i < count; ++i) {
+        result += i == 0 ? "" : ",";
+        result += reals ? std::to_string(i * 0.37 - 500.0) : std::to_string(i * 7 - 1000);
+    }
+    return result + "]";
+}
+
+static std::string stringsJson(int count) {
+    std::string result = "[";
+    for (int i = 0; i < count; ++i) {
+        result += i == 0 ? "\"" : ",\"";
+        result += "tag/" + std::to_string(i) + "/sensor-location-building-a-floor-3";
+        result += "\"";
+    }
+    return result + "]";
+}
+
+static MessageShape& shape(int index) {
+    static MessageShape shapes[] = {
+        {"flatPod", "{DDJISZ x y ts id state valid}",
+            R"({"x":1.5,"y":-2.25,"ts":1571043200123,"id":42,"state":3,"valid":true})"},
+        {"nestedComplex", "{{DDD x y z}{DDD x y z}*{{DD lat lon}tt pos name frame}J position velocity info ts}",
+            R"({"position":{"x":1.0,"y":2.0,"z":3.0},"velocity":{"x":0.1,"y":0.2,"z":0.3},)"
+            R"("info":{"pos":{"lat":52.37,"lon":4.89},"name":"vehicle-12","frame":"wgs84"},"ts":1571043200123})"},
+        {"numericSequences", "{J[D[I ts samples counters}",
+            R"({"ts":1571043200123,"samples":)" + numbersJson(4096, true) + R"(,"counters":)" + numbersJson(256, false) + "}"},
+        {"stringHeavy", "{ttt[t source topic description tags}",
+            R"({"source":"org.example.telemetry.collector","topic":"telemetry/vehicle/position",)"
+            R"("description":"Position and velocity of the vehicle, sampled at the configured rate",)"
+            R"("tags":)" + stringsJson(16) + "}"},
+    };
+    return shapes[index];
+}
+
+class MessageFixture {
+public:
+    explicit MessageFixture(int index) : msgShape{shape(index)} {
+        if (dynType_parseWithStr(msgShape.descriptor, msgShape.name, nullptr, &type) != 0 ||
+                jsonSerializer_deserialize(type, msgShape.json.c_str(), &inst) != 0) {
+            std::abort();
+        }
+    }
+
+    ~MessageFixture() {
+        dynType_free(type, inst);
+        dynType_destroy(type);
+    }
+
+    MessageFixture(const MessageFixture&) = delete;
+    MessageFixture& operator=(const MessageFixture&) = delete;
+
+    const MessageShape& msgShape;
+    dyn_type *type{nullptr};
+    void *inst{nullptr};
+};
+
+static void reportCounters(benchmark::State& state, size_t msgSize, size_t allocations) {
+    state.SetItemsProcessed(state.iterations());
+    state.SetBytesProcessed(state.iterations() * msgSize);
+    state.counters["allocs/msg"] = benchmark::Counter((double)allocations, benchmark::Counter::kAvgIterations);
+    state.counters["msgSize"] = (double)msgSize;
+    state.SetLabel(shape((int)state.range(0)).name);
+}
+
+static void JsonSerialize(benchmark::State& state) {
+    MessageFixture msg{(int)state.range(0)};
+    size_t msgSize = 0;
+    size_t allocations = dfiBenchmark_allocationCount();
+    for (auto _ : state) {
+        char *out = nullptr;
+        jsonSerializer_serialize(msg.type, msg.inst, &out);
+        msgSize = strlen(out);
+        free(out);
+    }
+    reportCounters(state, msgSize, dfiBenchmark_allocationCount() - allocations);
+}
+BENCHMARK(JsonSerialize)->DenseRange(0, 3);
+
+static void JsonDeserialize(benchmark::State& state) {
+    MessageFixture msg{(int)state.range(0)};
+    char *input = nullptr;
+    jsonSerializer_serialize(msg.type, msg.inst, &input);
+    size_t allocations = dfiBenchmark_allocationCount();
+    for (auto _ : state) {
+        void *result = nullptr;
+        jsonSerializer_deserialize(msg.type, input, &result);
+        dynType_free(msg.type, result);
+    }
+    reportCounters(state, strlen(input), dfiBenchmark_allocationCount() - allocations);
+    free(input);
+}
+BENCHMARK(JsonDeserialize)->DenseRange(0, 3);
+
+static void AvrobinSerialize(benchmark::State& state) {
+    MessageFixture msg{(int)state.range(0)};
+    size_t msgSize = 0;
+    size_t allocations = dfiBenchmark_allocationCount();
+    for (auto _ : state) {
+        uint8_t *out = nullptr;
+        avrobinSerializer_serialize(msg.type, msg.inst, &out, &msgSize);
+        free(out);
+    }
+    reportCounters(state, msgSize, dfiBenchmark_allocationCount() - allocations);
+}
+BENCHMARK(AvrobinSerialize)->DenseRange(0, 3);
+
+static void AvrobinSerializeToBuffer(benchmark::State& state) {
+    MessageFixture msg{(int)state.range(0)};
+    uint8_t *buffer = nullptr;
+    size_t bufferSize = 0;
+    size_t msgSize = 0;
+    size_t allocations = dfiBenchmark_allocationCount();
+    for (auto _ : state) {
+        avrobinSerializer_serializeToBuffer(msg.type, msg.inst, &buffer, &bufferSize, &msgSize);
+    }
+    reportCounters(state, msgSize, dfiBenchmark_allocationCount() - allocations);
+    free(buffer);
+}
+BENCHMARK(AvrobinSerializeToBuffer)->DenseRange(0, 3);
+
+static void AvrobinDeserialize(benchmark::State& state) {
+    MessageFixture msg{(int)state.range(0)};
+    uint8_t *input = nullptr;
+    size_t inputLen = 0;
+    avrobinSerializer_serialize(msg.type, msg.inst, &input, &inputLen);
+    size_t allocations = dfiBenchmark_allocationCount();
+    for (auto _ : state) {
+        void *result = nullptr;
+        avrobinSerializer_deserialize(msg.type, input, inputLen, &result);
+        dynType_free(msg.type, result);
+    }
+    reportCounters(state, inputLen, dfiBenchmark_allocationCount() - allocations);
+    free(input);
+}
+BENCHMARK(AvrobinDeserialize)->DenseRange(0, 3);
+
+static void AvrobinDeserializeInArena(benchmark::State& state) {
+    MessageFixture msg{(int)state.range(0)};
+    uint8_t *input = nullptr;
+    size_t inputLen = 0;
+    avrobinSerializer_serialize(msg.type, msg.inst, &input, &inputLen);
+    celix_arena_t *arena = celix_arena_create(0);
+    size_t allocations = dfiBenchmark_allocationCount();
+    for (auto _ : state) {
+        void *result = nullptr;
+        avrobinSerializer_deserializeInArena(msg.type, input, inputLen, arena, &result);
+        benchmark::DoNotOptimize(result);
+        celix_arena_reset(arena);
+    }
+    reportCounters(state, inputLen, dfiBenchmark_allocationCount() - allocations);
+    celix_arena_destroy(arena);
+    free(input);
+}
+BENCHMARK(AvrobinDeserializeInArena)->DenseRange(0, 3);
@@ -0,0 +1,1288 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *  KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/**
+ * celix_dfi_codegen generates C code (structs, json and avrobin serialization functions and json rpc stubs and
+ * proxies) for dfi message and interface descriptors. The generated code registers itself as dfi codec, see
+ * dfi_codec.h.
+ *
+ * usage: celix_dfi_codegen -o <output.c> [-p <prefix>] <input>...
+ * An input is a message or interface descriptor (.descriptor) or an avpr protocol (.avpr, generates the interface).
+ *
+ * Types which cannot be generated (untyped pointers, pointers to text or pointers) make the message or method use
+ * the dynamic path; a warning is printed for those.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <ctype.h>
+#include <sys/queue.h>
+
+#include "dfi_codec.h"
+#include "dyn_type_common.h"
+#include "dyn_function_common.h"
+#include "dyn_interface_common.h"
+#include "dyn_message.h"
+
+#define CODEGEN_MAX_DEPTH 64
+
+typedef struct codegen_type {
+    dyn_type *type; //reference resolved complex, sequence or enum type
+    int id;
+    bool generated; //serialization functions written
+    bool defined; //struct definition written
+    TAILQ_ENTRY(codegen_type) entries;
+} codegen_type_t;
+
+typedef struct codegen {
+    const char *prefix;
+    int nrOfTypes;
+    int nrOfMessages;
+    int nrOfInterfaces;
+    TAILQ_HEAD(, codegen_type) types;
+
+    //sections of the output file, concatenated in this order
+    FILE *forwards; char *forwardsBuf; size_t forwardsSize;
+    FILE *structs; char *structsBuf; size_t structsSize;
+    FILE *protos; char *protosBuf; size_t protosSize;
+    FILE *funcs; char *funcsBuf; size_t funcsSize;
+    FILE *regs; char *regsBuf; size_t regsSize;
+    FILE *unregs; char *unregsBuf; size_t unregsSize;
+} codegen_t;
+
+static dyn_type* codegen_resolve(dyn_type *type) {
+    return type->type == DYN_TYPE_REF ? type->ref.ref : type;
+}
+
+static bool codegen_isNumberOrBool(char c) {
+    return strchr("BSIJbsijNFDZ", c) != NULL;
+}
+
+static bool codegen_isSupportedType(dyn_type *type, dyn_type **visiting, size_t depth) {
+    type = codegen_resolve(type);
+    char c = (char)type->descriptor;
+    struct complex_type_entry *entry = NULL;
+
+    if (depth >= CODEGEN_MAX_DEPTH) {
+        return false;
+    }
+    if (codegen_isNumberOrBool(c) || c == 't' || c == 'E') {
+        return true;
+    } else if (c == '{') {
+        for (size_t i = 0; i < depth; ++i) {
+            if (visiting[i] == type) {
+                return true;
+            }
+        }
+        visiting[depth] = type;
+        TAILQ_FOREACH(entry, &type->complex.entriesHead, entries) {
+            if (!codegen_isSupportedType(entry->type, visiting, depth + 1)) {
+                return false;
+            }
+        }
+        return true;
+    } else if (c == '[') {
+        return codegen_isSupportedType(type->sequence.itemType, visiting, depth + 1);
+    } else if (c == '*') {
+        dyn_type *sub = codegen_resolve(type->typedPointer.typedType);
+        //note pointers to text and pointers to pointers are not (consistently) supported by the dynamic serializers
+        return sub->descriptor != 't' && sub->descriptor != '*' && codegen_isSupportedType(sub, visiting, depth + 1);
+    }
+    return false;
+}
+
+static bool codegen_isSupported(dyn_type *type) {
+    dyn_type *visiting[CODEGEN_MAX_DEPTH];
+    return codegen_isSupportedType(type, visiting, 0);
+}
+
+/**
+ * Whether an instance of the type owns memory, i.e. must be freed with dynType_deepFree.
+ */
+static bool codegen_ownsMemory(dyn_type *type, int depth) {
+    type = codegen_resolve(type);
+    struct complex_type_entry *entry = NULL;
+    if (type->descriptor == 't' || type->descriptor == '[' || type->descriptor == '*' || depth >= CODEGEN_MAX_DEPTH) {
+        return true;
+    } else if (type->descriptor == '{') {
+        TAILQ_FOREACH(entry, &type->complex.entriesHead, entries) {
+            if (codegen_ownsMemory(entry->type, depth + 1)) {
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+static void codegen_writeCString(FILE *stream, const char *str) {
+    fputc('"', stream);
+    for (const char *p = str; *p != '\0'; ++p) {
+        if (*p == '"' || *p == '\\') {
+            fprintf(stream, "\\%c", *p);
+        } else if (isprint((unsigned char)*p)) {
+            fputc(*p, stream);
+        } else {
+            fprintf(stream, "\\%03o", (unsigned char)*p);
+        }
+    }
+    fputc('"', stream);
+}
+
+/**
+ * Writes str as C string literal of the json string of str (quoted and escaped), e.g. "\"name\"".
+ */
+static size_t codegen_writeJsonCString(FILE *stream, const char *prefix, const char *str, const char *postfix) {
+    char *buf = NULL;
+    size_t size = 0;
+    FILE *json = open_memstream(&buf, &size);
+    fputs(prefix, json);
+    fputc('"', json);
+    for (const char *p = str; *p != '\0'; ++p) {
+        if (*p == '"' || *p == '\\') {
+            fputc('\\', json);
+        }
+        fputc(*p, json);
+    }
+    fputc('"', json);
+    fputs(postfix, json);
+    fclose(json);
+    codegen_writeCString(stream, buf);
+    free(buf);
+    return size;
+}
+
+static const char* codegen_fieldName(const char *name, char *buf, size_t bufSize) {
+    static const char *keywords[] = {"auto", "break", "case", "char", "const", "continue", "default", "do", "double",
+            "else", "enum", "extern", "float", "for", "goto", "if", "inline", "int", "long", "register", "restrict",
+            "return", "short", "signed", "sizeof", "static", "struct", "switch", "typedef", "union", "unsigned",
+            "void", "volatile", "while", "bool", "true", "false", NULL};
+    for (int i = 0; keywords[i] != NULL; ++i) {
+        if (strcmp(keywords[i], name) == 0) {
+            snprintf(buf, bufSize, "%s_", name);
+            return buf;
+        }
+    }
+    return name;
+}
+
+static codegen_type_t* codegen_findType(codegen_t *cg, dyn_type *type) {
+    codegen_type_t *entry = NULL;
+    TAILQ_FOREACH(entry, &cg->types, entries) {
+        if (entry->type == type) {
+            return entry;
+        }
+    }
+    return NULL;
+}
+
+static codegen_type_t* codegen_addType(codegen_t *cg, dyn_type *type);
+
+/**
+ * Writes the C type of the (supported) dyn type, e.g. "int32_t", "char*" or "prefix_t3*".
+ */
+static void codegen_writeCType(codegen_t *cg, FILE *stream, dyn_type *type) {
+    type = codegen_resolve(type);
+    switch (type->descriptor) {
+        case 'B' : fputs("char", stream); break;
+        case 'S' : fputs("int16_t", stream); break;
+        case 'I' : fputs("int32_t", stream); break;
+        case 'J' : fputs("int64_t", stream); break;
+        case 'b' : fputs("uint8_t", stream); break;
+        case 's' : fputs("uint16_t", stream); break;
+        case 'i' : fputs("uint32_t", stream); break;
+        case 'j' : fputs("uint64_t", stream); break;
+        case 'N' : fputs("int", stream); break;
+        case 'F' : fputs("float", stream); break;
+        case 'D' : fputs("double", stream); break;
+        case 'Z' : fputs("bool", stream); break;
+        case 't' : fputs("char*", stream); break;
+        case 'E' : fputs("int32_t", stream); break;
+        case 'P' : fputs("void*", stream); break;
+        case '*' :
+            codegen_writeCType(cg, stream, type->typedPointer.typedType);
+            fputc('*', stream);
+            break;
+        default :
+            fprintf(stream, "%s_t%i", cg->prefix, codegen_addType(cg, type)->id);
+            break;
+    }
+}
+
+static char* codegen_cType(codegen_t *cg, dyn_type *type) {
+    char *buf = NULL;
+    size_t size = 0;
+    FILE *stream = open_memstream(&buf, &size);
+    codegen_writeCType(cg, stream, type);
+    fclose(stream);
+    return buf;
+}
+
+static void codegen_writeJsonWriteValue(codegen_t *cg, FILE *f, dyn_type *type, const char *expr, const char *written, const char *indent) {
+    type = codegen_resolve(type);
+    char c = (char)type->descriptor;
+    if (codegen_isNumberOrBool(c) || c == 't') {
+        fprintf(f, "%sstatus = dfiJson_writeValue(w, '%c', &%s, &%s);\n", indent, c, expr, written);
+    } else if (c == 'E') {
+        int id = codegen_addType(cg, type)->id;
+        fprintf(f, "%sstatus = dfiJson_writeEnum(w, %s_t%i_names, %s_t%i_values, %s_t%i_count, %s, &%s);\n", indent,
+                cg->prefix, id, cg->prefix, id, cg->prefix, id, expr, written);
+    } else if (c == '{' || c == '[') {
+        fprintf(f, "%sstatus = %s_t%i_jsonWrite(w, &%s, &%s);\n", indent, cg->prefix, codegen_addType(cg, type)->id, expr, written);
+    } else if (c == '*') {
+        char subExpr[256];
+        snprintf(subExpr, sizeof(subExpr), "(*%s)", expr);
+        fprintf(f, "%sif (%s == NULL) {\n", indent, expr);
+        fprintf(f, "%s    status = dfiJson_writeRaw(w, \"null\", 4);\n", indent);
+        fprintf(f, "%s    %s = true;\n", indent, written);
+        fprintf(f, "%s} else {\n", indent);
+        char subIndent[64];
+        snprintf(subIndent, sizeof(subIndent), "%s    ", indent);
+        codegen_writeJsonWriteValue(cg, f, type->typedPointer.typedType, subExpr, written, subIndent);
+        fprintf(f, "%s}\n", indent);
+    }
+}
+
+static void codegen_writeJsonReadValue(codegen_t *cg, FILE *f, dyn_type *type, const char *expr, const char *indent) {
+    type = codegen_resolve(type);
+    char c = (char)type->descriptor;
+    if (codegen_isNumberOrBool(c) || c == 't') {
+        fprintf(f, "%sstatus = dfiJson_readValue(r, '%c', &%s);\n", indent, c, expr);
+    } else if (c == 'E') {
+        int id = codegen_addType(cg, type)->id;
+        fprintf(f, "%sstatus = dfiJson_readEnum(r, %s_t%i_names, %s_t%i_values, %s_t%i_count, &%s);\n", indent,
+                cg->prefix, id, cg->prefix, id, cg->prefix, id, expr);
+    } else if (c == '[') {
+        fprintf(f, "%sstatus = %s_t%i_jsonRead(r, &%s);\n", indent, cg->prefix, codegen_addType(cg, type)->id, expr);
+    } else if (c == '{') {
+        fprintf(f, "%sif (!dfiJson_readNull(r)) {\n", indent);
+        fprintf(f, "%s    status = %s_t%i_jsonRead(r, &%s);\n", indent, cg->prefix, codegen_addType(cg, type)->id, expr);
+        fprintf(f, "%s}\n", indent);
+    } else if (c == '*') {
+        char subExpr[256];
+        char subIndent[64];
+        snprintf(subExpr, sizeof(subExpr), "(*%s)", expr);
+        snprintf(subIndent, sizeof(subIndent), "%s        ", indent);
+        fprintf(f, "%sif (!dfiJson_readNull(r)) {\n", indent);
+        fprintf(f, "%s    %s = calloc(1, sizeof(*%s));\n", indent, expr, expr);
+        fprintf(f, "%s    if (%s == NULL) {\n", indent, expr);
+        fprintf(f, "%s        status = DFI_CODEC_ERROR;\n", indent);
+        fprintf(f, "%s    } else {\n", indent);
+        codegen_writeJsonReadValue(cg, f, type->typedPointer.typedType, subExpr, subIndent);
+        fprintf(f, "%s    }\n", indent);
+        fprintf(f, "%s}\n", indent);
+    }
+}
+
+static void codegen_writeAvrobinWriteValue(codegen_t *cg, FILE *f, dyn_type *type, const char *expr, const char *indent) {
+    type = codegen_resolve(type);
+    char c = (char)type->descriptor;
+    if (codegen_isNumberOrBool(c) || c == 't') {
+        fprintf(f, "%sstatus = dfiAvrobin_writeValue(w, '%c', &%s);\n", indent, c, expr);
+    } else if (c == 'E') {
+        int id = codegen_addType(cg, type)->id;
+        fprintf(f, "%sstatus = dfiAvrobin_writeEnum(w, %s_t%i_values, %s_t%i_count, %s);\n", indent,
+                cg->prefix, id, cg->prefix, id, expr);
+    } else if (c == '{' || c == '[') {
+        fprintf(f, "%sstatus = %s_t%i_avrobinWrite(w, &%s);\n", indent, cg->prefix, codegen_addType(cg, type)->id, expr);
+    } else if (c == '*') {
+        char subExpr[256];
+        char subIndent[64];
+        snprintf(subExpr, sizeof(subExpr), "(*%s)", expr);
+        snprintf(subIndent, sizeof(subIndent), "%s    ", indent);
+        fprintf(f, "%sif (%s == NULL) {\n", indent, expr);
+        fprintf(f, "%s    status = DFI_CODEC_ERROR;\n", indent);
+        fprintf(f, "%s} else {\n", indent);
+        codegen_writeAvrobinWriteValue(cg, f, type->typedPointer.typedType, subExpr, subIndent);
+        fprintf(f, "%s}\n", indent);
+    }
+}
+
+static void codegen_writeAvrobinReadValue(codegen_t *cg, FILE *f, dyn_type *type, const char *expr, const char *indent) {
+    type = codegen_resolve(type);
+    char c = (char)type->descriptor;
+    if (codegen_isNumberOrBool(c) || c == 't') {
+        fprintf(f, "%sstatus = dfiAvrobin_readValue(r, '%c', &%s);\n", indent, c, expr);
+    } else if (c == 'E') {
+        int id = codegen_addType(cg, type)->id;
+        fprintf(f, "%sstatus = dfiAvrobin_readEnum(r, %s_t%i_values, %s_t%i_count, &%s);\n", indent,
+                cg->prefix, id, cg->prefix, id, expr);
+    } else if (c == '{' || c == '[') {
+        fprintf(f, "%sstatus = %s_t%i_avrobinRead(r, &%s);\n", indent, cg->prefix, codegen_addType(cg, type)->id, expr);
+    } else if (c == '*') {
+        char subExpr[256];
+        char subIndent[64];
+        snprintf(subExpr, sizeof(subExpr), "(*%s)", expr);
+        snprintf(subIndent, sizeof(subIndent), "%s    ", indent);
+        fprintf(f, "%sif (%s == NULL) {\n", indent, expr);
+        fprintf(f, "%s    %s = calloc(1, sizeof(*%s));\n", indent, expr, expr);
+        fprintf(f, "%s}\n", indent);
+        fprintf(f, "%sif (%s == NULL) {\n", indent, expr);
+        fprintf(f, "%s    status = DFI_CODEC_ERROR;\n", indent);
+        fprintf(f, "%s} else {\n", indent);
+        codegen_writeAvrobinReadValue(cg, f, type->typedPointer.typedType, subExpr, subIndent);
+        fprintf(f, "%s}\n", indent);
+    }
+}
+
+static void codegen_writeComplexFunctions(codegen_t *cg, codegen_type_t *ct) {
+    FILE *f = cg->funcs;
+    const char *p = cg->prefix;
+    int id = ct->id;
+    struct complex_type_entry *entry = NULL;
+    char expr[256];
+    char fieldBuf[128];
+
+    fprintf(f, "static int %s_t%i_jsonWrite(dfi_json_writer_t *w, const %s_t%i *v, bool *written) {\n", p, id, p, id);
+    fprintf(f, "    bool first = true;\n");
+    fprintf(f, "    bool memberWritten = false;\n");
+    fprintf(f, "    size_t mark = 0;\n");
+    fprintf(f, "    int status = dfiJson_writeRaw(w, \"{\", 1);\n");
+    TAILQ_FOREACH(entry, &ct->type->complex.entriesHead, entries) {
+        snprintf(expr, sizeof(expr), "v->%s", codegen_fieldName(entry->name, fieldBuf, sizeof(fieldBuf)));
+        fprintf(f, "    if (status == DFI_CODEC_OK) {\n");
+        fprintf(f, "        mark = w->len;\n");
+        fprintf(f, "        memberWritten = false;\n");
+        fprintf(f, "        status = first ? dfiJson_writeRaw(w, ");
+        size_t len = codegen_writeJsonCString(f, "", entry->name, ":");
+        fprintf(f, ", %zu) : dfiJson_writeRaw(w, ", len);
+        codegen_writeJsonCString(f, ",", entry->name, ":");
+        fprintf(f, ", %zu);\n", len + 1);
+        fprintf(f, "        if (status == DFI_CODEC_OK) {\n");
+        codegen_writeJsonWriteValue(cg, f, entry->type, expr, "memberWritten", "            ");
+        fprintf(f, "        }\n");
+        fprintf(f, "        if (status == DFI_CODEC_OK && !memberWritten) {\n");
+        fprintf(f, "            w->len = mark; //rollback member\n");
+        fprintf(f, "        } else {\n");
+        fprintf(f, "            first = false;\n");
+        fprintf(f, "        }\n");
+        fprintf(f, "    }\n");
+    }
+    fprintf(f, "    (void)first;\n");
+    fprintf(f, "    (void)memberWritten;\n");
+    fprintf(f, "    (void)mark;\n");
+    fprintf(f, "    if (status == DFI_CODEC_OK) {\n");
+    fprintf(f, "        status = dfiJson_writeRaw(w, \"}\", 1);\n");
+    fprintf(f, "    }\n");
+    fprintf(f, "    *written = status == DFI_CODEC_OK;\n");
+    fprintf(f, "    return status;\n");
+    fprintf(f, "}\n\n");
+
+    fprintf(f, "static int %s_t%i_jsonRead(dfi_json_reader_t *r, %s_t%i *v) {\n", p, id, p, id);
+    fprintf(f, "    bool more = false;\n");
+    fprintf(f, "    int status = dfiJson_readObjectBegin(r, &more);\n");
+    fprintf(f, "    while (status == DFI_CODEC_OK && more) {\n");
+    fprintf(f, "        char keyBuf[DFI_JSON_KEY_BUF_SIZE];\n");
+    fprintf(f, "        char *key = NULL;\n");
+    fprintf(f, "        status = dfiJson_readKey(r, keyBuf, sizeof(keyBuf), &key);\n");
+    fprintf(f, "        if (status != DFI_CODEC_OK) {\n");
+    fprintf(f, "            //nop\n");
+    TAILQ_FOREACH(entry, &ct->type->complex.entriesHead, entries) {
+        snprintf(expr, sizeof(expr), "v->%s", codegen_fieldName(entry->name, fieldBuf, sizeof(fieldBuf)));
+        fprintf(f, "        } else if (strcmp(key, ");
+        codegen_writeCString(f, entry->name);
+        fprintf(f, ") == 0) {\n");
+        codegen_writeJsonReadValue(cg, f, entry->type, expr, "            ");
+    }
+    fprintf(f, "        } else {\n");
+    fprintf(f, "            status = dfiJson_readUnknownKey(r, key);\n");
+    fprintf(f, "        }\n");
+    fprintf(f, "        if (key != keyBuf) {\n");
+    fprintf(f, "            free(key);\n");
+    fprintf(f, "        }\n");
+    fprintf(f, "        if (status == DFI_CODEC_OK) {\n");
+    fprintf(f, "            status = dfiJson_readObjectNext(r, &more);\n");
+    fprintf(f, "        }\n");
+    fprintf(f, "    }\n");
+    fprintf(f, "    return status;\n");
+    fprintf(f, "}\n\n");
+
+    fprintf(f, "static int %s_t%i_avrobinWrite(dfi_avrobin_writer_t *w, const %s_t%i *v) {\n", p, id, p, id);
+    fprintf(f, "    int status = DFI_CODEC_OK;\n");
+    TAILQ_FOREACH(entry, &ct->type->complex.entriesHead, entries) {
+        snprintf(expr, sizeof(expr), "v->%s", codegen_fieldName(entry->name, fieldBuf, sizeof(fieldBuf)));
+        fprintf(f, "    if (status == DFI_CODEC_OK) {\n");
+        codegen_writeAvrobinWriteValue(cg, f, entry->type, expr, "        ");
+        fprintf(f, "    }\n");
+    }
+    fprintf(f, "    (void)w;\n");
+    fprintf(f, "    (void)v;\n");
+    fprintf(f, "    return status;\n");
+    fprintf(f, "}\n\n");
+
+    fprintf(f, "static int %s_t%i_avrobinRead(dfi_avrobin_reader_t *r, %s_t%i *v) {\n", p, id, p, id);
+    fprintf(f, "    int status = DFI_CODEC_OK;\n");
+    TAILQ_FOREACH(entry, &ct->type->complex.entriesHead, entries) {
+        snprintf(expr, sizeof(expr), "v->%s", codegen_fieldName(entry->name, fieldBuf, sizeof(fieldBuf)));
+        fprintf(f, "    if (status == DFI_CODEC_OK) {\n");
+        codegen_writeAvrobinReadValue(cg, f, entry->type, expr, "        ");
+        fprintf(f, "    }\n");
+    }
+    fprintf(f, "    (void)r;\n");
+    fprintf(f, "    (void)v;\n");
+    fprintf(f, "    return status;\n");
+    fprintf(f, "}\n\n");
+}
+
+static void codegen_writeSequenceFunctions(codegen_t *cg, codegen_type_t *ct) {
+    FILE *f = cg->funcs;
+    const char *p = cg->prefix;
+    int id = ct->id;
+    dyn_type *itemType = ct->type->sequence.itemType;
+
+    fprintf(f, "static int %s_t%i_jsonWrite(dfi_json_writer_t *w, const %s_t%i *v, bool *written) {\n", p, id, p, id);
+    fprintf(f, "    bool first = true;\n");
+    fprintf(f, "    bool itemWritten = false;\n");
+    fprintf(f, "    size_t mark = 0;\n");
+    fprintf(f, "    int status = dfiJson_writeRaw(w, \"[\", 1);\n");
+    fprintf(f, "    for (uint32_t i = 0; status == DFI_CODEC_OK && i < v->len; ++i) {\n");
+    fprintf(f, "        mark = w->len;\n");
+    fprintf(f, "        itemWritten = false;\n");
+    fprintf(f, "        if (!first) {\n");
+    fprintf(f, "            status = dfiJson_writeRaw(w, \",\", 1);\n");
+    fprintf(f, "        }\n");
+    fprintf(f, "        if (status == DFI_CODEC_OK) {\n");
+    codegen_writeJsonWriteValue(cg, f, itemType, "v->buf[i]", "itemWritten", "            ");
+    fprintf(f, "        }\n");
+    fprintf(f, "        if (status == DFI_CODEC_OK && !itemWritten) {\n");
+    fprintf(f, "            w->len = mark;\n");
+    fprintf(f, "        } else {\n");
+    fprintf(f, "            first = false;\n");
+    fprintf(f, "        }\n");
+    fprintf(f, "    }\n");
+    fprintf(f, "    if (status == DFI_CODEC_OK) {\n");
+    fprintf(f, "        status = dfiJson_writeRaw(w, \"]\", 1);\n");
+    fprintf(f, "    }\n");
+    fprintf(f, "    *written = true;\n");
+    fprintf(f, "    return status;\n");
+    fprintf(f, "}\n\n");
+
+    fprintf(f, "static int %s_t%i_jsonRead(dfi_json_reader_t *r, %s_t%i *v) {\n", p, id, p, id);
+    fprintf(f, "    bool more = false;\n");
+    fprintf(f, "    int status = dfiJson_readArrayBegin(r, &more);\n");
+    fprintf(f, "    while (status == DFI_CODEC_OK && more) {\n");
+    fprintf(f, "        if (v->len == v->cap) {\n");
+    fprintf(f, "            status = dfiJson_growSequence(v, sizeof(*v->buf));\n");
+    fprintf(f, "        }\n");
+    fprintf(f, "        if (status == DFI_CODEC_OK) {\n");
+    fprintf(f, "            v->len += 1; //note the item is part of the sequence (and freed with it) also if parsing fails\n");
+    codegen_writeJsonReadValue(cg, f, itemType, "v->buf[v->len - 1]", "            ");
+    fprintf(f, "        }\n");
+    fprintf(f, "        if (status == DFI_CODEC_OK) {\n");
+    fprintf(f, "            status = dfiJson_readArrayNext(r, &more);\n");
+    fprintf(f, "        }\n");
+    fprintf(f, "    }\n");
+    fprintf(f, "    if (status == DFI_CODEC_OK) {\n");
+    fprintf(f, "        dfiJson_shrinkSequence(v, sizeof(*v->buf));\n");
+    fprintf(f, "    }\n");
+    fprintf(f, "    return status;\n");
+    fprintf(f, "}\n\n");
+
+    fprintf(f, "static int %s_t%i_avrobinWrite(dfi_avrobin_writer_t *w, const %s_t%i *v) {\n", p, id, p, id);
+    fprintf(f, "    int status = dfiAvrobin_writeLong(w, (int64_t)v->len);\n");
+    fprintf(f, "    for (uint32_t i = 0; status == DFI_CODEC_OK && i < v->len; ++i) {\n");
+    codegen_writeAvrobinWriteValue(cg, f, itemType, "v->buf[i]", "        ");
+    fprintf(f, "    }\n");
+    fprintf(f, "    if (status == DFI_CODEC_OK && v->len > 0) {\n");
+    fprintf(f, "        status = dfiAvrobin_writeLong(w, 0);\n");
+    fprintf(f, "    }\n");
+    fprintf(f, "    return status;\n");
+    fprintf(f, "}\n\n");
+
+    fprintf(f, "static int %s_t%i_avrobinRead(dfi_avrobin_reader_t *r, %s_t%i *v) {\n", p, id, p, id);
+    fprintf(f, "    uint32_t count = 0;\n");
+    fprintf(f, "    int status = dfiAvrobin_readBlock(r, v, sizeof(*v->buf), &count);\n");
+    fprintf(f, "    while (status == DFI_CODEC_OK && count > 0) {\n");
+    fprintf(f, "        for (uint32_t i = 0; status == DFI_CODEC_OK && i < count; ++i) {\n");
+    fprintf(f, "            v->len += 1; //note the item is part of the sequence (and freed with it) also if parsing fails\n");
+    codegen_writeAvrobinReadValue(cg, f, itemType, "v->buf[v->len - 1]", "            ");
+    fprintf(f, "        }\n");
+    fprintf(f, "        if (status == DFI_CODEC_OK) {\n");
+    fprintf(f, "            status = dfiAvrobin_readBlock(r, v, sizeof(*v->buf), &count);\n");
+    fprintf(f, "        }\n");
+    fprintf(f, "    }\n");
+    fprintf(f, "    return status;\n");
+    fprintf(f, "}\n\n");
+}
+
+static void codegen_writeEnumTables(codegen_t *cg, codegen_type_t *ct) {
+    FILE *f = cg->forwards;
+    struct meta_entry *entry = NULL;
+    size_t count = 0;
+
+    fprintf(f, "static const char * const %s_t%i_names[] = {", cg->prefix, ct->id);
+    TAILQ_FOREACH(entry, &ct->type->metaProperties, entries) {
+        codegen_writeCString(f, entry->name);
+        fputs(", ", f);
+        count += 1;
+    }
+    fprintf(f, "NULL};\n");
+    fprintf(f, "static const int32_t %s_t%i_values[] = {", cg->prefix, ct->id);
+    TAILQ_FOREACH(entry, &ct->type->metaProperties, entries) {
+        fprintf(f, "%i, ", atoi(entry->value));
+    }
+    fprintf(f, "0};\n");
+    fprintf(f, "static const size_t %s_t%i_count = %zu;\n", cg->prefix, ct->id, count);
+}
+
+static codegen_type_t* codegen_addType(codegen_t *cg, dyn_type *type) {
+    type = codegen_resolve(type);
+    codegen_type_t *ct = codegen_findType(cg, type);
+    if (ct != NULL) {
+        return ct;
+    }
+
+    ct = calloc(1, sizeof(*ct));
+    ct->type = type;
+    ct->id = cg->nrOfTypes++;
+    TAILQ_INSERT_TAIL(&cg->types, ct, entries);
+
+    const char *p = cg->prefix;
+    if (type->descriptor == 'E') {
+        codegen_writeEnumTables(cg, ct);
+        return ct;
+    }
+
+    fprintf(cg->forwards, "typedef struct %s_t%i %s_t%i; //%s\n", p, ct->id, p, ct->id, type->name != NULL ? type->name : "anonymous");
+    fprintf(cg->protos, "__attribute__((unused)) static int %s_t%i_jsonWrite(dfi_json_writer_t *w, const %s_t%i *v, bool *written);\n", p, ct->id, p, ct->id);
+    fprintf(cg->protos, "__attribute__((unused)) static int %s_t%i_jsonRead(dfi_json_reader_t *r, %s_t%i *v);\n", p, ct->id, p, ct->id);
+    fprintf(cg->protos, "__attribute__((unused)) static int %s_t%i_avrobinWrite(dfi_avrobin_writer_t *w, const %s_t%i *v);\n", p, ct->id, p, ct->id);
+    fprintf(cg->protos, "__attribute__((unused)) static int %s_t%i_avrobinRead(dfi_avrobin_reader_t *r, %s_t%i *v);\n", p, ct->id, p, ct->id);
+    return ct; //note the functions are written by codegen_finishInput, types are added while writing other functions
+
+}
+
+/**
+ * Writes the struct definition, after the definitions of the structs it contains by value.
+ */
+static void codegen_defineStruct(codegen_t *cg, codegen_type_t *ct) {
+    if (ct->defined || ct->type->descriptor == 'E') {
+        return;
+    }
+    ct->defined = true;
+    FILE *f = cg->structs;
+    struct complex_type_entry *entry = NULL;
+    char fieldBuf[128];
+
+    if (ct->type->descriptor == '[') {
+        char *itemType = codegen_cType(cg, ct->type->sequence.itemType);
+        fprintf(f, "struct %s_t%i {\n    uint32_t cap;\n    uint32_t len;\n    %s *buf;\n};\n\n", cg->prefix, ct->id, itemType);
+        free(itemType);
+        return;
+    }
+
+    TAILQ_FOREACH(entry, &ct->type->complex.entriesHead, entries) {
+        dyn_type *member = codegen_resolve(entry->type);
+        if (member->descriptor == '{' || member->descriptor == '[') {
+            codegen_defineStruct(cg, codegen_addType(cg, member));
+        }
+    }
+    fprintf(f, "struct %s_t%i {\n", cg->prefix, ct->id);
+    TAILQ_FOREACH(entry, &ct->type->complex.entriesHead, entries) {
+        char *memberType = codegen_cType(cg, entry->type);
+        fprintf(f, "    %s %s;\n", memberType, codegen_fieldName(entry->name, fieldBuf, sizeof(fieldBuf)));
+        free(memberType);
+    }
+    fprintf(f, "};\n\n");
+}
+
+static void codegen_writeSignature(FILE *f, const char *sig) {
+    codegen_writeCString(f, sig);
+}
+
+static int codegen_generateMessage(codegen_t *cg, const char *path, dyn_message_type *msg) {
+    char *name = NULL;
+    char *version = NULL;
+    dyn_type *type = NULL;
+    dynMessage_getName(msg, &name);
+    dynMessage_getVersionString(msg, &version);
+    dynMessage_getMessageType(msg, &type);
+    type = codegen_resolve(type);
+
+    if ((type->descriptor != '{' && type->descriptor != '[') || !codegen_isSupported(type)) {
+        fprintf(stderr, "Warning: message %s in %s contains types not supported by the generator, using dynamic serialization\n", name, path);
+        return 0;
+    }
+
+    char *sig = NULL;
+    if (dfiCodec_typeSignature(type, &sig) != 0) {
+        fprintf(stderr, "Error: cannot create signature for message %s in %s\n", name, path);
+        return 1;
+    }
+
+    FILE *f = cg->funcs;
+    const char *p = cg->prefix;
+    int m = cg->nrOfMessages++;
+    int id = codegen_addType(cg, type)->id;
+
+    fprintf(f, "static int %s_m%i_jsonWrite(dfi_json_writer_t *w, const void *inst, bool *written) {\n", p, m);
+    fprintf(f, "    return %s_t%i_jsonWrite(w, inst, written);\n", p, id);
+    fprintf(f, "}\n\n");
+    fprintf(f, "static int %s_m%i_jsonRead(dfi_json_reader_t *r, void *inst) {\n", p, m);
+    fprintf(f, "    int status = DFI_CODEC_OK;\n");
+    fprintf(f, "    %s_t%i *v = inst;\n", p, id);
+    codegen_writeJsonReadValue(cg, f, type, "(*v)", "    ");
+    fprintf(f, "    return status;\n");
+    fprintf(f, "}\n\n");
+    fprintf(f, "static int %s_m%i_avrobinWrite(dfi_avrobin_writer_t *w, const void *inst) {\n", p, m);
+    fprintf(f, "    return %s_t%i_avrobinWrite(w, inst);\n", p, id);
+    fprintf(f, "}\n\n");
+    fprintf(f, "static int %s_m%i_avrobinRead(dfi_avrobin_reader_t *r, void *inst) {\n", p, m);
+    fprintf(f, "    return %s_t%i_avrobinRead(r, inst);\n", p, id);
+    fprintf(f, "}\n\n");
+
+    fprintf(f, "static const dfi_message_codec_t %s_m%i_codec = {\n", p, m);
+    fprintf(f, "    .name = ");
+    codegen_writeCString(f, name);
+    fprintf(f, ",\n    .version = ");
+    codegen_writeCString(f, version);
+    fprintf(f, ",\n    .signature = ");
+    codegen_writeSignature(f, sig);
+    fprintf(f, ",\n    .size = sizeof(%s_t%i),\n", p, id);
+    fprintf(f, "    .jsonWrite = %s_m%i_jsonWrite,\n", p, m);
+    fprintf(f, "    .jsonRead = %s_m%i_jsonRead,\n", p, m);
+    fprintf(f, "    .avrobinWrite = %s_m%i_avrobinWrite,\n", p, m);
+    fprintf(f, "    .avrobinRead = %s_m%i_avrobinRead\n", p, m);
+    fprintf(f, "};\n\n");
+
+    fprintf(cg->regs, "    dfiCodec_registerMessageCodec(&%s_m%i_codec);\n", p, m);
+    fprintf(cg->unregs, "    dfiCodec_unregisterMessageCodec(&%s_m%i_codec);\n", p, m);
+    free(sig);
+    return 0;
+}
+
+/**
+ * Returns the type of the output value of the pre-allocated output or output argument, e.g. T for *T and **T.
+ * For text output arguments (*t) the text type is returned.
+ */
+static dyn_type* codegen_outputValueType(dyn_function_type *func, int index) {
+    dyn_type *argType = codegen_resolve(dynFunction_argumentTypeForIndex(func, index));
+    if (argType->descriptor != '*') {
+        return NULL;
+    }
+    dyn_type *sub = codegen_resolve(argType->typedPointer.typedType);
+    if (dynFunction_argumentMetaForIndex(func, index) == DYN_FUNCTION_ARGUMENT_META__PRE_ALLOCATED_OUTPUT || sub->descriptor == 't') {
+        return sub;
+    }
+    return sub->descriptor == '*' ? codegen_resolve(sub->typedPointer.typedType) : NULL;
+}
+
+static bool codegen_isSupportedMethod(dyn_function_type *func) {
+    if (codegen_resolve(dynFunction_returnType(func))->descriptor != 'N') {
+        return false;
+    }
+    int nrOfOutputs = 0;
+    int nrOfArgs = dynFunction_nrOfArguments(func);
+    for (int i = 0; i < nrOfArgs; ++i) {
+        dyn_type *argType = dynFunction_argumentTypeForIndex(func, i);
+        switch (dynFunction_argumentMetaForIndex(func, i)) {
+            case DYN_FUNCTION_ARGUMENT_META__HANDLE :
+                break;
+            case DYN_FUNCTION_ARGUMENT_META__STD :
+                if (!codegen_isSupported(argType)) {
+                    return false;
+                }
+                break;
+            default : {
+                dyn_type *valueType = codegen_outputValueType(func, i);
+                nrOfOutputs += 1;
+                if (valueType == NULL || (valueType->descriptor != 't' && (valueType->descriptor == '*' || !codegen_isSupported(valueType)))) {
+                    return false;
+                }
+                break;
+            }
+        }
+    }
+    return nrOfOutputs <= 1;
+}
+
+static void codegen_writeMethodFunctions(codegen_t *cg, int s, struct method_entry *method) {
+    FILE *f = cg->funcs;
+    const char *p = cg->prefix;
+    int m = method->index;
+    dyn_function_type *func = method->dynFunc;
+    int nrOfArgs = dynFunction_nrOfArguments(func);
+    char expr[256];
+    int outputIndex = -1;
+    bool lookupFunc = false;
+
+    for (int i = 0; i < nrOfArgs; ++i) {
+        enum dyn_function_argument_meta meta = dynFunction_argumentMetaForIndex(func, i);
+        if (meta == DYN_FUNCTION_ARGUMENT_META__PRE_ALLOCATED_OUTPUT || meta == DYN_FUNCTION_ARGUMENT_META__OUTPUT) {
+            outputIndex = i;
+        }
+        if (meta != DYN_FUNCTION_ARGUMENT_META__HANDLE) {
+            dyn_type *valueType = meta == DYN_FUNCTION_ARGUMENT_META__STD ? dynFunction_argumentTypeForIndex(func, i) : codegen_outputValueType(func, i);
+            lookupFunc = lookupFunc || codegen_ownsMemory(valueType, 0);
+        }
+    }
+    dyn_type *outputType = outputIndex >= 0 ? codegen_outputValueType(func, outputIndex) : NULL;
+    enum dyn_function_argument_meta outputMeta = outputIndex >= 0 ? dynFunction_argumentMetaForIndex(func, outputIndex) : DYN_FUNCTION_ARGUMENT_META__STD;
+    char *outputCType = outputType != NULL ? codegen_cType(cg, outputType) : NULL;
+
+    //proxy: request
+    fprintf(f, "static int %s_s%i_m%i_prepareRequest(dyn_function_type *func, const char *id, void *args[], char **out) {\n", p, s, m);
+    fprintf(f, "    dfi_json_writer_t writer;\n");
+    fprintf(f, "    dfi_json_writer_t *w = &writer;\n");
+    fprintf(f, "    bool first = true;\n");
+    fprintf(f, "    bool written = false;\n");
+    fprintf(f, "    size_t mark = 0;\n");
+    fprintf(f, "    int status = dfiJson_initWriter(w);\n");
+    fprintf(f, "    (void)func;\n");
+    fprintf(f, "    (void)args;\n");
+    fprintf(f, "    (void)id; //note equal to the id of the method, the codec is matched on method id\n");
+    fprintf(f, "    if (status == DFI_CODEC_OK) {\n");
+    fprintf(f, "        status = dfiJson_writeRaw(w, ");
+    size_t len = codegen_writeJsonCString(f, "{\"m\":", method->id, ",\"a\":[");
+    fprintf(f, ", %zu);\n", len);
+    fprintf(f, "    }\n");
+    for (int i = 0; i < nrOfArgs; ++i) {
+        if (dynFunction_argumentMetaForIndex(func, i) != DYN_FUNCTION_ARGUMENT_META__STD) {
+            continue;
+        }
+        char *ctype = codegen_cType(cg, dynFunction_argumentTypeForIndex(func, i));
+        snprintf(expr, sizeof(expr), "(*(%s*)args[%i])", ctype, i);
+        free(ctype);
+        fprintf(f, "    if (status == DFI_CODEC_OK) {\n");
+        fprintf(f, "        mark = w->len;\n");
+        fprintf(f, "        written = false;\n");
+        fprintf(f, "        if (!first) {\n");
+        fprintf(f, "            status = dfiJson_writeRaw(w, \",\", 1);\n");
+        fprintf(f, "        }\n");
+        fprintf(f, "        if (status == DFI_CODEC_OK) {\n");
+        codegen_writeJsonWriteValue(cg, f, dynFunction_argumentTypeForIndex(func, i), expr, "written", "            ");
+        fprintf(f, "        }\n");
+        fprintf(f, "        if (status == DFI_CODEC_OK && !written) {\n");
+        fprintf(f, "            w->len = mark;\n");
+        fprintf(f, "        } else {\n");
+        fprintf(f, "            first = false;\n");
+        fprintf(f, "        }\n");
+        fprintf(f, "    }\n");
+    }
+    fprintf(f, "    (void)first;\n");
+    fprintf(f, "    (void)written;\n");
+    fprintf(f, "    (void)mark;\n");
+    fprintf(f, "    if (status == DFI_CODEC_OK) {\n");
+    fprintf(f, "        status = dfiJson_writeRaw(w, \"]}\", 2);\n");
+    fprintf(f, "    }\n");
+    fprintf(f, "    return dfiJson_finishWriter(w, status, out);\n");
+    fprintf(f, "}\n\n");
+
+    //proxy: reply, note methods without output use the dynamic path (which checks the reply but ignores the result)
+    if (outputType != NULL) {
+        fprintf(f, "static int %s_s%i_m%i_handleReply(dyn_function_type *func, const char *reply, void *args[]) {\n", p, s, m);
+        fprintf(f, "    dfi_json_reader_t reader;\n");
+        fprintf(f, "    dfi_json_reader_t *r = &reader;\n");
+        fprintf(f, "    dfiJson_initReader(r, reply);\n");
+        fprintf(f, "    int status = dfiJson_readRpcResult(r);\n");
+        fprintf(f, "    (void)func;\n");
+        if (outputMeta == DYN_FUNCTION_ARGUMENT_META__PRE_ALLOCATED_OUTPUT) {
+            fprintf(f, "    %s *dst = *(%s**)args[%i];\n", outputCType, outputCType, outputIndex);
+            fprintf(f, "    if (status == DFI_CODEC_OK) {\n");
+            fprintf(f, "        memset(dst, 0, sizeof(*dst));\n");
+            codegen_writeJsonReadValue(cg, f, outputType, "(*dst)", "        ");
+            fprintf(f, "    }\n");
+        } else if (outputType->descriptor == 't') {
+            fprintf(f, "    char **dst = *(char***)args[%i];\n", outputIndex);
+            fprintf(f, "    if (status == DFI_CODEC_OK) {\n");
+            fprintf(f, "        *dst = NULL;\n");
+            codegen_writeJsonReadValue(cg, f, outputType, "(*dst)", "        ");
+            fprintf(f, "    }\n");
+        } else {
+            fprintf(f, "    %s **dst = *(%s***)args[%i];\n", outputCType, outputCType, outputIndex);
+            fprintf(f, "    if (status == DFI_CODEC_OK) {\n");
+            fprintf(f, "        *dst = NULL;\n");
+            fprintf(f, "        if (!dfiJson_readNull(r)) {\n");
+            fprintf(f, "            *dst = calloc(1, sizeof(**dst));\n");
+            fprintf(f, "            if (*dst == NULL) {\n");
+            fprintf(f, "                status = DFI_CODEC_ERROR;\n");
+            fprintf(f, "            } else {\n");
+            codegen_writeJsonReadValue(cg, f, outputType, "(**dst)", "                ");
+            fprintf(f, "            }\n");
+            fprintf(f, "        }\n");
+            fprintf(f, "        if (status != DFI_CODEC_OK) {\n");
+            fprintf(f, "            dfiCodec_freeArgument(func, %i, *dst);\n", outputIndex);
+            fprintf(f, "            *dst = NULL;\n");
+            fprintf(f, "        }\n");
+            fprintf(f, "    }\n");
+        }
+        fprintf(f, "    if (status == DFI_CODEC_OK && !dfiJson_readRpcEnd(r)) {\n");
+        fprintf(f, "        status = DFI_CODEC_ERROR;\n");
+        fprintf(f, "    }\n");
+        fprintf(f, "    return status;\n");
+        fprintf(f, "}\n\n");
+    }
+
+    //stub: invoke the service for the request
+    fprintf(f, "static int %s_s%i_m%i_invoke(dyn_interface_type *intf, %s_s%i *svc, dfi_json_reader_t *r, char **out) {\n", p, s, m, p, s);
+    fprintf(f, "    bool more = false;\n");
+    fprintf(f, "    dyn_function_type *func = NULL;\n");
+    for (int i = 0; i < nrOfArgs; ++i) {
+        enum dyn_function_argument_meta meta = dynFunction_argumentMetaForIndex(func, i);
+        if (meta == DYN_FUNCTION_ARGUMENT_META__STD) {
+            char *ctype = codegen_cType(cg, dynFunction_argumentTypeForIndex(func, i));
+            fprintf(f, "    %s a%i;\n", ctype, i);
+            fprintf(f, "    memset(&a%i, 0, sizeof(a%i));\n", i, i);
+            free(ctype);
+        } else if (meta != DYN_FUNCTION_ARGUMENT_META__HANDLE) {
+            //note a text output is a char*, other outputs point to the (pre) allocated value
+            fprintf(f, "    %s %sa%i = NULL;\n", outputCType, outputType->descriptor == 't' ? "" : "*", i);
+        }
+    }
+    if (lookupFunc) {
+        fprintf(f, "    struct method_entry *method = NULL;\n");
+        fprintf(f, "    if (dynInterface_findMethod(intf, ");
+        codegen_writeCString(f, method->id);
+        fprintf(f, ", &method) != DFI_CODEC_OK) {\n");
+        fprintf(f, "        return DFI_CODEC_UNSUPPORTED;\n");
+        fprintf(f, "    }\n");
+        fprintf(f, "    func = method->dynFunc;\n");
+    } else {
+        fprintf(f, "    (void)intf;\n");
+    }
+    fprintf(f, "    int status = dfiJson_readRpcArguments(r, &more);\n");
+    for (int i = 0; i < nrOfArgs; ++i) {
+        if (dynFunction_argumentMetaForIndex(func, i) != DYN_FUNCTION_ARGUMENT_META__STD) {
+            continue;
+        }
+        snprintf(expr, sizeof(expr), "a%i", i);
+        fprintf(f, "    if (status == DFI_CODEC_OK && !more) {\n");
+        fprintf(f, "        status = DFI_CODEC_UNSUPPORTED;\n");
+        fprintf(f, "    }\n");
+        fprintf(f, "    if (status == DFI_CODEC_OK) {\n");
+        codegen_writeJsonReadValue(cg, f, dynFunction_argumentTypeForIndex(func, i), expr, "        ");
+        fprintf(f, "    }\n");
+        fprintf(f, "    if (status == DFI_CODEC_OK) {\n");
+        fprintf(f, "        status = dfiJson_readArrayNext(r, &more);\n");
+        fprintf(f, "    }\n");
+    }
+    fprintf(f, "    if (status == DFI_CODEC_OK && (more || !dfiJson_readRpcEnd(r))) {\n");
+    fprintf(f, "        status = DFI_CODEC_UNSUPPORTED;\n");
+    fprintf(f, "    }\n");
+    if (outputMeta == DYN_FUNCTION_ARGUMENT_META__PRE_ALLOCATED_OUTPUT) {
+        fprintf(f, "    if (status == DFI_CODEC_OK) {\n");
+        fprintf(f, "        a%i = calloc(1, sizeof(*a%i));\n", outputIndex, outputIndex);
+        fprintf(f, "        status = a%i != NULL ? DFI_CODEC_OK : DFI_CODEC_ERROR;\n", outputIndex);
+        fprintf(f, "    }\n");
+    }
+
+    fprintf(f, "    int rc = 0;\n");
+    fprintf(f, "    if (status == DFI_CODEC_OK) {\n");
+    fprintf(f, "        rc = svc->m%i(", m);
+    for (int i = 0; i < nrOfArgs; ++i) {
+        enum dyn_function_argument_meta meta = dynFunction_argumentMetaForIndex(func, i);
+        fputs(i > 0 ? ", " : "", f);
+        if (meta == DYN_FUNCTION_ARGUMENT_META__HANDLE) {
+            fprintf(f, "svc->handle");
+        } else if (meta == DYN_FUNCTION_ARGUMENT_META__OUTPUT) {
+            fprintf(f, "&a%i", i);
+        } else {
+            fprintf(f, "a%i", i);
+        }
+    }
+    fprintf(f, ");\n");
+    fprintf(f, "    }\n");
+
+    fprintf(f, "    dfi_json_writer_t writer = {NULL, 0, 0};\n");
+    fprintf(f, "    dfi_json_writer_t *w = &writer;\n");
+    fprintf(f, "    bool written = false;\n");
+    fprintf(f, "    if (status == DFI_CODEC_OK) {\n");
+    fprintf(f, "        status = dfiJson_initWriter(w);\n");
+    fprintf(f, "    }\n");
+    fprintf(f, "    if (status == DFI_CODEC_OK && rc != 0) {\n");
+    fprintf(f, "        char error[32];\n");
+    fprintf(f, "        int errorLen = snprintf(error, sizeof(error), \"{\\\"e\\\":%%i}\", rc);\n");
+    fprintf(f, "        status = dfiJson_writeRaw(w, error, (size_t)errorLen);\n");
+    fprintf(f, "    } else if (status == DFI_CODEC_OK) {\n");
+    fprintf(f, "        status = dfiJson_writeRaw(w, \"{\\\"r\\\":\", 5);\n");
+    if (outputIndex >= 0) {
+        snprintf(expr, sizeof(expr), "a%i", outputIndex);
+        if (outputType->descriptor == 't') {
+            fprintf(f, "        if (status == DFI_CODEC_OK) {\n");
+            codegen_writeJsonWriteValue(cg, f, outputType, expr, "written", "            ");
+            fprintf(f, "        }\n");
+        } else {
+            snprintf(expr, sizeof(expr), "(*a%i)", outputIndex);
+            fprintf(f, "        if (status == DFI_CODEC_OK && a%i != NULL) {\n", outputIndex);
+            codegen_writeJsonWriteValue(cg, f, outputType, expr, "written", "            ");
+            fprintf(f, "        }\n");
+        }
+    }
+    fprintf(f, "        if (status == DFI_CODEC_OK && !written) {\n");
+    fprintf(f, "            w->len = 1; //no result\n");
+    fprintf(f, "        }\n");
+    fprintf(f, "        if (status == DFI_CODEC_OK) {\n");
+    fprintf(f, "            status = dfiJson_writeRaw(w, \"}\", 1);\n");
+    fprintf(f, "        }\n");
+    fprintf(f, "    }\n");
+
+    for (int i = 0; i < nrOfArgs; ++i) {
+        enum dyn_function_argument_meta meta = dynFunction_argumentMetaForIndex(func, i);
+        dyn_type *valueType = meta == DYN_FUNCTION_ARGUMENT_META__STD ? dynFunction_argumentTypeForIndex(func, i) : codegen_outputValueType(func, i);
+        if (meta == DYN_FUNCTION_ARGUMENT_META__HANDLE) {
+            continue;
+        } else if (codegen_ownsMemory(valueType, 0)) {
+            fprintf(f, "    dfiCodec_freeArgument(func, %i, %sa%i);\n", i, meta == DYN_FUNCTION_ARGUMENT_META__STD ? "&" : "", i);
+        } else if (meta != DYN_FUNCTION_ARGUMENT_META__STD) {
+            fprintf(f, "    free(a%i);\n", i);
+        }
+    }
+    fprintf(f, "    (void)func;\n");
+    fprintf(f, "    (void)written;\n");
+    fprintf(f, "    if (status == DFI_CODEC_UNSUPPORTED) {\n");
+    fprintf(f, "        free(writer.buf);\n");
+    fprintf(f, "        return status;\n");
+    fprintf(f, "    }\n");
+    fprintf(f, "    return dfiJson_finishWriter(w, status, out);\n");
+    fprintf(f, "}\n\n");
+
+    free(outputCType);
+}
+
+static int codegen_generateInterface(codegen_t *cg, const char *path, dyn_interface_type *intf) {
+    char *name = NULL;
+    char *version = NULL;
+    dynInterface_getName(intf, &name);
+    dynInterface_getVersionString(intf, &version);
+
+    const char *p = cg->prefix;
+    int s = cg->nrOfInterfaces++;
+    int nrOfMethods = dynInterface_nrOfMethods(intf);
+    struct method_entry *methods[nrOfMethods > 0 ? nrOfMethods : 1];
+    bool supported[nrOfMethods > 0 ? nrOfMethods : 1];
+    struct method_entry *method = NULL;
+    int nrOfSupported = 0;
+
+    memset(methods, 0, sizeof(methods));
+    TAILQ_FOREACH(method, &intf->methods, entries) {
+        if (method->index >= 0 && method->index < nrOfMethods) {
+            methods[method->index] = method;
+        }
+    }
+
+    //service layout, the methods in index order. Note written separately, the used types write their functions to funcs
+    char *stBuf = NULL;
+    size_t stSize = 0;
+    FILE *st = open_memstream(&stBuf, &stSize);
+    fprintf(st, "typedef struct %s_s%i { //%s\n", p, s, name);
+    fprintf(st, "    void *handle;\n");
+    for (int i = 0; i < nrOfMethods; ++i) {
+        supported[i] = methods[i] != NULL && codegen_isSupportedMethod(methods[i]->dynFunc);
+        if (!supported[i]) {
+            fprintf(stderr, "Warning: method %s of interface %s in %s is not supported by the generator, using dynamic json rpc\n",
+                    methods[i] != NULL ? methods[i]->id : "?", name, path);
+            fprintf(st, "    void (*m%i)(void);\n", i);
+            continue;
+        }
+        nrOfSupported += 1;
+        dyn_function_type *func = methods[i]->dynFunc;
+        fprintf(st, "    int (*m%i)(", i);
+        int nrOfArgs = dynFunction_nrOfArguments(func);
+        for (int j = 0; j < nrOfArgs; ++j) {
+            char *ctype = codegen_cType(cg, dynFunction_argumentTypeForIndex(func, j));
+            fprintf(st, "%s%s", j > 0 ? ", " : "", ctype);
+            free(ctype);
+        }
+        fprintf(st, "%s); //%s\n", nrOfArgs == 0 ? "void" : "", methods[i]->id);
+    }
+    fprintf(st, "} %s_s%i;\n\n", p, s);
+    fclose(st);
+    fputs(stBuf, cg->funcs);
+    free(stBuf);
+
+    for (int i = 0; i < nrOfMethods; ++i) {
+        if (supported[i]) {
+            codegen_writeMethodFunctions(cg, s, methods[i]);
+        }
+    }
+
+    FILE *f = cg->funcs;
+    fprintf(f, "static int %s_s%i_call(dyn_interface_type *intf, void *service, const char *request, char **out) {\n", p, s);
+    fprintf(f, "    dfi_json_reader_t reader;\n");
+    fprintf(f, "    char idBuf[DFI_JSON_KEY_BUF_SIZE];\n");
+    fprintf(f, "    char *id = NULL;\n");
+    fprintf(f, "    dfiJson_initReader(&reader, request);\n");
+    fprintf(f, "    int status = dfiJson_readRpcMethod(&reader, idBuf, sizeof(idBuf), &id);\n");
+    fprintf(f, "    if (status != DFI_CODEC_OK) {\n");
+    fprintf(f, "        status = DFI_CODEC_UNSUPPORTED;\n");
+    for (int i = 0; i < nrOfMethods; ++i) {
+        if (supported[i]) {
+            fprintf(f, "    } else if (strcmp(id, ");
+            codegen_writeCString(f, methods[i]->id);
+            fprintf(f, ") == 0) {\n");
+            fprintf(f, "        status = %s_s%i_m%i_invoke(intf, service, &reader, out);\n", p, s, i);
+        }
+    }
+    fprintf(f, "    } else {\n");
+    fprintf(f, "        status = DFI_CODEC_UNSUPPORTED;\n");
+    fprintf(f, "    }\n");
+    fprintf(f, "    if (id != idBuf) {\n");
+    fprintf(f, "        free(id);\n");
+    fprintf(f, "    }\n");
+    fprintf(f, "    return status;\n");
+    fprintf(f, "}\n\n");
+
+    fprintf(f, "static const dfi_rpc_method_codec_t %s_s%i_methods[] = {\n", p, s);
+    for (int i = 0; i < nrOfMethods; ++i) {
+        if (!supported[i]) {
+            continue;
+        }
+        char *sig = NULL;
+        if (dfiCodec_functionSignature(methods[i]->dynFunc, &sig) != 0) {
+            fprintf(stderr, "Error: cannot create signature for method %s in %s\n", methods[i]->id, path);
+            return 1;
+        }
+        fprintf(f, "    {\n        .id = ");
+        codegen_writeCString(f, methods[i]->id);
+        fprintf(f, ",\n        .signature = ");
+        codegen_writeSignature(f, sig);
+        fprintf(f, ",\n        .prepareRequest = %s_s%i_m%i_prepareRequest,\n", p, s, i);
+        bool hasOutput = false;
+        for (int j = 0; j < dynFunction_nrOfArguments(methods[i]->dynFunc); ++j) {
+            enum dyn_function_argument_meta meta = dynFunction_argumentMetaForIndex(methods[i]->dynFunc, j);
+            hasOutput = hasOutput || meta == DYN_FUNCTION_ARGUMENT_META__PRE_ALLOCATED_OUTPUT || meta == DYN_FUNCTION_ARGUMENT_META__OUTPUT;
+        }
+        if (hasOutput) {
+            fprintf(f, "        .handleReply = %s_s%i_m%i_handleReply\n", p, s, i);
+        } else {
+            fprintf(f, "        .handleReply = NULL\n");
+        }
+        fprintf(f, "    },\n");
+        free(sig);
+    }
+    if (nrOfSupported == 0) {
+        fprintf(f, "    {NULL, NULL, NULL, NULL}\n");
+    }
+    fprintf(f, "};\n\n");
+
+    fprintf(f, "static const dfi_rpc_codec_t %s_s%i_codec = {\n", p, s);
+    fprintf(f, "    .name = ");
+    codegen_writeCString(f, name);
+    fprintf(f, ",\n    .version = ");
+    codegen_writeCString(f, version);
+    fprintf(f, ",\n    .nrOfMethods = %i,\n", nrOfMethods);
+    fprintf(f, "    .nrOfCodecs = %i,\n", nrOfSupported);
+    fprintf(f, "    .methods = %s_s%i_methods,\n", p, s);
+    fprintf(f, "    .call = %s_s%i_call\n", p, s);
+    fprintf(f, "};\n\n");
+
+    fprintf(cg->regs, "    dfiCodec_registerRpcCodec(&%s_s%i_codec);\n", p, s);
+    fprintf(cg->unregs, "    dfiCodec_unregisterRpcCodec(&%s_s%i_codec);\n", p, s);
+    return 0;
+}
+
+/**
+ * Writes the functions and struct definitions of the types of the input and forgets the types; they are destroyed with the parsed
+ * input.
+ */
+static void codegen_finishInput(codegen_t *cg) {
+    codegen_type_t *ct = NULL;
+    TAILQ_FOREACH(ct, &cg->types, entries) {
+        //note types added while writing are appended and handled by this loop
+        if (!ct->generated && ct->type->descriptor == '{') {
+            codegen_writeComplexFunctions(cg, ct);
+        } else if (!ct->generated && ct->type->descriptor == '[') {
+            codegen_writeSequenceFunctions(cg, ct);
+        }
+        ct->generated = true;
+    }
+    TAILQ_FOREACH(ct, &cg->types, entries) {
+        codegen_defineStruct(cg, ct);
+    }
+    while (!TAILQ_EMPTY(&cg->types)) {
+        ct = TAILQ_FIRST(&cg->types);
+        TAILQ_REMOVE(&cg->types, ct, entries);
+        free(ct);
+    }
+}
+
+static int codegen_readFile(const char *path, char **content) {
+    FILE *file = fopen(path, "r");
+    if (file == NULL) {
+        fprintf(stderr, "Error: cannot open %s\n", path);
+        return 1;
+    }
+    size_t size = 0;
+    FILE *stream = open_memstream(content, &size);
+    char buf[4096];
+    size_t n;
+    while ((n = fread(buf, 1, sizeof(buf), file)) > 0) {
+        fwrite(buf, 1, n, stream);
+    }
+    fclose(stream);
+    fclose(file);
+    return 0;
+}
+
+static int codegen_generateInput(codegen_t *cg, const char *path) {
+    char *content = NULL;
+    int status = codegen_readFile(path, &content);
+    if (status != 0) {
+        return status;
+    }
+
+    size_t pathLen = strlen(path);
+    FILE *stream = fmemopen(content, strlen(content), "r");
+    if (pathLen > 5 && strcmp(path + pathLen - 5, ".avpr") == 0) {
+        dyn_interface_type *intf = dynInterface_parseAvpr(stream);
+        status = intf != NULL ? codegen_generateInterface(cg, path, intf) : 1;
+        if (intf != NULL) {
+            codegen_finishInput(cg);
+            dynInterface_destroy(intf);
+        }
+    } else if (strstr(content, "type=interface") != NULL) {
+        dyn_interface_type *intf = NULL;
+        status = dynInterface_parse(stream, &intf);
+        if (status == 0) {
+            status = codegen_generateInterface(cg, path, intf);
+            codegen_finishInput(cg);
+            dynInterface_destroy(intf);
+        }
+    } else {
+        dyn_message_type *msg = NULL;
+        status = dynMessage_parse(stream, &msg);
+        if (status == 0) {
+            status = codegen_generateMessage(cg, path, msg);
+            codegen_finishInput(cg);
+            dynMessage_destroy(msg);
+        }
+    }
+    fclose(stream);
+    free(content);
+
+    if (status != 0) {
+        fprintf(stderr, "Error: cannot generate code for %s\n", path);
+    }
+    return status;
+}
+
+static void codegen_writeOutput(codegen_t *cg, FILE *out) {
+    fclose(cg->forwards);
+    fclose(cg->structs);
+    fclose(cg->protos);
+    fclose(cg->funcs);
+    fclose(cg->regs);
+    fclose(cg->unregs);
+
+    fprintf(out, "/* Generated by celix_dfi_codegen, do not edit. */\n\n");
+    fprintf(out, "#include <stdbool.h>\n");
+    fprintf(out, "#include <stdint.h>\n");
+    fprintf(out, "#include <stdio.h>\n");
+    fprintf(out, "#include <stdlib.h>\n");
+    fprintf(out, "#include <string.h>\n\n");
+    fprintf(out, "#include \"dfi_codec.h\"\n\n");
+    fputs(cg->forwardsBuf, out);
+    fputs("\n", out);
+    fputs(cg->structsBuf, out);
+    fputs(cg->protosBuf, out);
+    fputs("\n", out);
+    fputs(cg->funcsBuf, out);
+    fprintf(out, "__attribute__((constructor)) static void %s_registerCodecs(void) {\n", cg->prefix);
+    fputs(cg->regsBuf, out);
+    fprintf(out, "}\n\n");
+    fprintf(out, "__attribute__((destructor)) static void %s_unregisterCodecs(void) {\n", cg->prefix);
+    fputs(cg->unregsBuf, out);
+    fprintf(out, "}\n");
+}
+
+static void codegen_usage(const char *prog) {
+    fprintf(stderr, "usage: %s -o <output.c> [-p <prefix>] <descriptor or avpr file>...\n", prog);
+}
+
+int main(int argc, char **argv) {
+    const char *output = NULL;
+    char prefix[128] = "";
+    int firstInput = argc;
+
+    for (int i = 1; i < argc; ++i) {
+        if (strcmp(argv[i], "-o") == 0 && i + 1 < argc) {
+            output = argv[++i];
+        } else if (strcmp(argv[i], "-p") == 0 && i + 1 < argc) {
+            snprintf(prefix, sizeof(prefix), "%s", argv[++i]);
+        } else {
+            firstInput = i;
+            break;
+        }
+    }
+    if (output == NULL) {
+        codegen_usage(argv[0]);
+        return 1;
+    }
+    if (prefix[0] == '\0') {
+        //default prefix based on the output file name
+        const char *base = strrchr(output, '/') != NULL ? strrchr(output, '/') + 1 : output;
+        snprintf(prefix, sizeof(prefix), "%s", base);
+        char *dot = strchr(prefix, '.');
+        if (dot != NULL) {
+            *dot = '\0';
+        }
+    }
+    for (char *c = prefix; *c != '\0'; ++c) {
+        if (!isalnum((unsigned char)*c)) {
+            *c = '_';
+        }
+    }
+
+    codegen_t cg;
+    memset(&cg, 0, sizeof(cg));
+    cg.prefix = prefix;
+    TAILQ_INIT(&cg.types);
+    cg.forwards = open_memstream(&cg.forwardsBuf, &cg.forwardsSize);
+    cg.structs = open_memstream(&cg.structsBuf, &cg.structsSize);
+    cg.protos = open_memstream(&cg.protosBuf, &cg.protosSize);
+    cg.funcs = open_memstream(&cg.funcsBuf, &cg.funcsSize);
+    cg.regs = open_memstream(&cg.regsBuf, &cg.regsSize);
+    cg.unregs = open_memstream(&cg.unregsBuf, &cg.unregsSize);
+
+    int status = 0;
+    for (int i = firstInput; status == 0 && i < argc; ++i) {
+        status = codegen_generateInput(&cg, argv[i]);
+    }
+
+    FILE *out = status == 0 ? fopen(output, "w") : NULL;
+    if (status == 0 && out == NULL) {
+        fprintf(stderr, "Error: cannot open %s for writing\n", output);
+        status = 1;
+    }
+    if (status == 0) {
+        codegen_writeOutput(&cg, out);
+        fclose(out);
+    } else {
+        fclose(cg.forwards);
+        fclose(cg.structs);
+        fclose(cg.protos);
+        fclose(cg.funcs);
+        fclose(cg.regs);
+        fclose(cg.unregs);
+    }
+
+    free(cg.forwardsBuf);
+    free(cg.structsBuf);
+    free(cg.protosBuf);
+    free(cg.funcsBuf);
+    free(cg.regsBuf);
+    free(cg.unregsBuf);
+    while (!TAILQ_EMPTY(&cg.types)) {
+        codegen_type_t *ct = TAILQ_FIRST(&cg.types);
+        TAILQ_REMOVE(&cg.types, ct, entries);
+        free(ct);
+    }
+    return status;
+}
@@ -0,0 +1,90 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *  KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#ifndef __AVROBIN_RPC_H_
+#define __AVROBIN_RPC_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "dfi_log_util.h"
+#include "dyn_type.h"
+#include "dyn_function.h"
+#include "dyn_interface.h"
+
+/**
+ * Binary alternative for json_rpc, using the avrobin encoding for the arguments and results.
+ *
+ * Message layout:
+ *  - magic "CRPC" and version (1 byte)
+ *  - kind (1 byte): AVROBIN_RPC_KIND_REQUEST or AVROBIN_RPC_KIND_REPLY
+ *  - call id (avro long), a reply carries the call id of the request
+ *  - request: method id (avro string), reply: status (avro int) returned by the remote function
+ *  - number of values (avro int), followed by every value as avro bytes (the avrobin serialization of the value).
+ *    A request contains the standard arguments, a reply contains the output argument (if any).
+ *
+ * A batch (AVROBIN_RPC_KIND_BATCH) carries call id 0, the number of messages (avro long) and every request or
+ * reply message as avro bytes. The replies are in the order of the requests, an empty message is a failed call.
+ */
+
+//logging
+DFI_SETUP_LOG_HEADER(avrobinRpc);
+
+#define AVROBIN_RPC_VERSION         1
+#define AVROBIN_RPC_KIND_REQUEST    0
+#define AVROBIN_RPC_KIND_REPLY      1
+#define AVROBIN_RPC_KIND_BATCH      2
+
+/**
+ * Returns whether data starts with an avrobin rpc header.
+ */
+bool avrobinRpc_isMessage(const uint8_t *data, size_t dataLen);
+
+/**
+ * Decodes the request (or batch of requests), calls the method on service and encodes the reply.
+ * On success out is an allocated buffer of outLen bytes, which is owned by the caller.
+ */
+int avrobinRpc_call(dyn_interface_type *intf, void *service, const uint8_t *request, size_t requestLen, uint8_t **out, size_t *outLen);
+
+/**
+ * Encodes a request for function func (with method id id) using the provided (libffi style) args.
+ * On success out is an allocated buffer of outLen bytes, which is owned by the caller.
+ */
+int avrobinRpc_prepareInvokeRequest(dyn_function_type *func, const char *id, uint64_t callId, void *args[], uint8_t **out, size_t *outLen);
+
+/**
+ * Decodes the reply for the request with callId into the output argument of args.
+ * replyStatus is set to the status returned by the remote function, the output argument is only set if that status
+ * is 0.
+ */
+int avrobinRpc_handleReply(dyn_function_type *func, uint64_t callId, const uint8_t *reply, size_t replyLen, void *args[], int *replyStatus);
+
+/**
+ * Combines count encoded requests into one batch request, avrobinRpc_call answers it with a batch of replies.
+ * On success out is an allocated buffer of outLen bytes, which is owned by the caller.
+ */
+int avrobinRpc_prepareBatchRequest(const uint8_t * const requests[], const size_t lengths[], size_t count, uint8_t **out, size_t *outLen);
+
+/**
+ * Splits a batch reply of count replies. The replies point into the reply buffer, a failed call has length 0.
+ */
+int avrobinRpc_splitBatchReply(const uint8_t *reply, size_t replyLen, size_t count, const uint8_t *replies[], size_t lengths[]);
+
+#endif
@@ -29,6 +29,31 @@ DFI_SETUP_LOG_HEADER(avrobinSerializer);
 
 int avrobinSerializer_deserialize(dyn_type *type, const uint8_t *input, size_t inlen, void **result);
 int avrobinSerializer_serialize(dyn_type *type, const void *input, uint8_t **output, size_t *outlen);
+
+/**
+ * Deserializes input into an instance allocated from the provided arena. All strings, sequence buffers and referenced
+ * types of the instance are also allocated from the arena, so a complete message is released with a single
+ * celix_arena_reset or celix_arena_destroy. The result must not be freed with dynType_free.
+ * Also on error memory can be allocated from the arena.
+ */
+int avrobinSerializer_deserializeInArena(dyn_type *type, const uint8_t *input, size_t inlen, celix_arena_t *arena, void **result);
+
+/**
+ * Deserializes input written with an older, compatible version of the type. A compatible older version only lacks
+ * fields at the end of the type, so the input contains the leading values of the type and the remaining values stay
+ * zero initialized.
+ * If *nrOfValues is 0, values are read until the input is exhausted and *nrOfValues is set to the number of read
+ * values, so that the caller can cache it for the writer version. Otherwise exactly *nrOfValues values are read.
+ */
+int avrobinSerializer_deserializeValues(dyn_type *type, const uint8_t *input, size_t inlen, size_t *nrOfValues, void **result);
+
+/**
+ * Serializes input into a caller owned buffer, so that a buffer can be reused for multiple messages.
+ * If *buffer is NULL or too small, it is (re)allocated and *bufferSize is updated. Also on error the buffer stays
+ * owned by the caller and must be freed by the caller.
+ * On success outlen contains the number of serialized bytes.
+ */
+int avrobinSerializer_serializeToBuffer(dyn_type *type, const void *input, uint8_t **buffer, size_t *bufferSize, size_t *outlen);
 int avrobinSerializer_generateSchema(dyn_type *type, char **output);
 int avrobinSerializer_saveFile(const char *filename, const char *schema, const uint8_t *serdata, size_t serdatalen);
 
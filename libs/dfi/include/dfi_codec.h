@@ -0,0 +1,237 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *  KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#ifndef _DFI_CODEC_H_
+#define _DFI_CODEC_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "celix_arena.h"
+#include "dfi_log_util.h"
+#include "dyn_type.h"
+#include "dyn_function.h"
+#include "dyn_interface.h"
+
+/**
+ * Codecs are serialization functions generated ahead of time (at build time) from dfi descriptors by the
+ * celix_dfi_codegen tool, see the celix_generate_dfi_codecs CMake function.
+ *
+ * Generated codecs register themselves (from a constructor function) when the library or executable containing
+ * them is loaded. When a descriptor is parsed (dynMessage_parse, dynInterface_parse and dynInterface_parseAvpr) a
+ * codec with the same name and version is looked up and, if the signature of the generated code matches the parsed
+ * types, attached to the parsed message type or interface. The json and avrobin serializers and the json rpc
+ * functions then use the generated code instead of walking the dyn types; everything else (and everything the
+ * generator does not support) keeps using the dynamic path.
+ *
+ * Attached codecs are not reference counted, so the generated code must outlive the descriptors parsed while it was
+ * registered. Link the generated code in the executable (or in a library which is never unloaded), not in a bundle.
+ */
+
+//logging
+DFI_SETUP_LOG_HEADER(dfiCodec);
+
+#define DFI_CODEC_OK 0
+#define DFI_CODEC_ERROR 1
+#define DFI_CODEC_UNSUPPORTED 2 //the generated code cannot handle the input, the caller should use the dynamic path
+
+#define DFI_JSON_KEY_BUF_SIZE 128
+
+/**
+ * Growable json output buffer, shared with jsonSerializer_serialize.
+ */
+typedef struct dfi_json_writer {
+    char *buf;
+    size_t len;
+    size_t cap;
+} dfi_json_writer_t;
+
+/**
+ * Pull reader over a NUL terminated json text, shared with jsonSerializer_deserialize.
+ */
+typedef struct dfi_json_reader {
+    const char *input;
+    const char *cur;
+    unsigned int depth;
+} dfi_json_reader_t;
+
+/**
+ * Growable avrobin output buffer, shared with avrobinSerializer_serialize.
+ */
+typedef struct dfi_avrobin_writer {
+    uint8_t *buf;
+    size_t len;
+    size_t cap;
+} dfi_avrobin_writer_t;
+
+/**
+ * Bounds checked avrobin input cursor, shared with avrobinSerializer_deserialize.
+ */
+typedef struct dfi_avrobin_reader {
+    const uint8_t *buf;
+    size_t len;
+    size_t pos;
+    celix_arena_t *arena; //if not NULL, the result is allocated from the arena instead of the heap
+} dfi_avrobin_reader_t;
+
+/**
+ * Generated serialization functions for a message type (the root type of a message descriptor).
+ */
+typedef struct dfi_message_codec {
+    const char *name;
+    const char *version;
+    const char *signature; //see dfiCodec_typeSignature
+    size_t size; //size of the message struct
+
+    /**
+     * Writes the message as json. Values which cannot be represented are not written (written is false).
+     */
+    int (*jsonWrite)(dfi_json_writer_t *writer, const void *inst, bool *written);
+
+    /**
+     * Reads the json value into the (zeroed) message instance. Allocated members are freed with dynType_free.
+     */
+    int (*jsonRead)(dfi_json_reader_t *reader, void *inst);
+
+    int (*avrobinWrite)(dfi_avrobin_writer_t *writer, const void *inst);
+    int (*avrobinRead)(dfi_avrobin_reader_t *reader, void *inst);
+} dfi_message_codec_t;
+
+/**
+ * Generated json rpc functions for a method of an interface. Functions may return DFI_CODEC_UNSUPPORTED, the json rpc
+ * function then uses the dynamic path.
+ */
+typedef struct dfi_rpc_method_codec {
+    const char *id;
+    const char *signature; //see dfiCodec_functionSignature
+    int (*prepareRequest)(dyn_function_type *func, const char *id, void *args[], char **out);
+    int (*handleReply)(dyn_function_type *func, const char *reply, void *args[]);
+} dfi_rpc_method_codec_t;
+
+/**
+ * Generated json rpc functions for an interface. The methods without generated code (not supported by the generator)
+ * are not part of the methods array.
+ */
+typedef struct dfi_rpc_codec {
+    const char *name;
+    const char *version;
+    size_t nrOfMethods; //total number of methods of the interface
+    size_t nrOfCodecs;
+    const dfi_rpc_method_codec_t *methods;
+
+    /**
+     * Calls the service for the request. Returns DFI_CODEC_UNSUPPORTED for requests (e.g. batches) or methods not
+     * handled by the generated code.
+     */
+    int (*call)(dyn_interface_type *intf, void *service, const char *request, char **out);
+} dfi_rpc_codec_t;
+
+/**
+ * Registers a generated codec. Codecs are only attached to descriptors parsed after the registration.
+ */
+int dfiCodec_registerMessageCodec(const dfi_message_codec_t *codec);
+void dfiCodec_unregisterMessageCodec(const dfi_message_codec_t *codec);
+int dfiCodec_registerRpcCodec(const dfi_rpc_codec_t *codec);
+void dfiCodec_unregisterRpcCodec(const dfi_rpc_codec_t *codec);
+
+const dfi_message_codec_t* dfiCodec_findMessageCodec(const char *name, const char *version);
+const dfi_rpc_codec_t* dfiCodec_findRpcCodec(const char *name, const char *version);
+
+/**
+ * Attaches the registered codec, if any and if its signature matches, to the parsed message type or interface.
+ * Called by the descriptor parse functions.
+ */
+void dfiCodec_attachMessageCodec(const char *name, const char *version, dyn_type *type);
+void dfiCodec_attachRpcCodec(dyn_interface_type *intf);
+
+/**
+ * Returns the message codec attached to the type, or NULL.
+ */
+const dfi_message_codec_t* dfiCodec_messageCodec(dyn_type *type);
+
+/**
+ * Creates the canonical signature of the type: the layout, member names and enum values. Generated code and parsed
+ * descriptor are only combined if their signatures are equal. On success out must be freed by the caller.
+ */
+int dfiCodec_typeSignature(dyn_type *type, char **out);
+
+/**
+ * Creates the canonical signature of the function: the argument metas and types and the return type.
+ */
+int dfiCodec_functionSignature(dyn_function_type *func, char **out);
+
+/**
+ * Frees the (deserialized) argument value of the function: the deep members of a standard argument, or the value
+ * of an output argument. NULL values are ignored.
+ */
+void dfiCodec_freeArgument(dyn_function_type *func, int index, void *value);
+
+/**
+ * Json primitives for the generated code, with the same output and input handling as the dynamic json serializer.
+ */
+int dfiJson_initWriter(dfi_json_writer_t *writer);
+int dfiJson_writeRaw(dfi_json_writer_t *writer, const char *data, size_t len);
+int dfiJson_writeValue(dfi_json_writer_t *writer, char descriptor, const void *loc, bool *written); //Z, t and numbers
+int dfiJson_writeEnum(dfi_json_writer_t *writer, const char * const names[], const int32_t values[], size_t count, int32_t value, bool *written);
+int dfiJson_finishWriter(dfi_json_writer_t *writer, int status, char **out);
+
+void dfiJson_initReader(dfi_json_reader_t *reader, const char *input);
+bool dfiJson_readNull(dfi_json_reader_t *reader);
+int dfiJson_readValue(dfi_json_reader_t *reader, char descriptor, void *loc); //Z, t and numbers
+int dfiJson_readEnum(dfi_json_reader_t *reader, const char * const names[], const int32_t values[], size_t count, int32_t *value);
+int dfiJson_readObjectBegin(dfi_json_reader_t *reader, bool *more);
+int dfiJson_readObjectNext(dfi_json_reader_t *reader, bool *more);
+int dfiJson_readKey(dfi_json_reader_t *reader, char *buf, size_t bufSize, char **key);
+int dfiJson_readUnknownKey(dfi_json_reader_t *reader, const char *key);
+int dfiJson_readArrayBegin(dfi_json_reader_t *reader, bool *more);
+int dfiJson_readArrayNext(dfi_json_reader_t *reader, bool *more);
+bool dfiJson_readEnd(dfi_json_reader_t *reader);
+
+/**
+ * Json rpc envelope primitives. A request is read as {"m":"<id>","a":[<args>]} and a reply as {"r":<result>}, other
+ * (valid) forms result in DFI_CODEC_UNSUPPORTED without logging, so that the dynamic path can handle them.
+ */
+int dfiJson_readRpcMethod(dfi_json_reader_t *reader, char *buf, size_t bufSize, char **id);
+int dfiJson_readRpcArguments(dfi_json_reader_t *reader, bool *more);
+int dfiJson_readRpcResult(dfi_json_reader_t *reader);
+bool dfiJson_readRpcEnd(dfi_json_reader_t *reader);
+
+/**
+ * Grows the sequence buffer (zero filled) for the json reader: doubling, starting at 8 items.
+ */
+int dfiJson_growSequence(void *seqLoc, size_t itemSize);
+void dfiJson_shrinkSequence(void *seqLoc, size_t itemSize);
+
+/**
+ * Avrobin primitives for the generated code, with the same output and input handling as the dynamic avrobin serializer.
+ */
+int dfiAvrobin_writeValue(dfi_avrobin_writer_t *writer, char descriptor, const void *loc); //Z, t and numbers
+int dfiAvrobin_writeEnum(dfi_avrobin_writer_t *writer, const int32_t values[], size_t count, int32_t value);
+int dfiAvrobin_writeLong(dfi_avrobin_writer_t *writer, int64_t value);
+int dfiAvrobin_readValue(dfi_avrobin_reader_t *reader, char descriptor, void *loc); //Z, t and numbers
+int dfiAvrobin_readEnum(dfi_avrobin_reader_t *reader, const int32_t values[], size_t count, int32_t *value);
+
+/**
+ * Reads the item count of the next array block (0 for the end of the array) and makes room for the items in the
+ * sequence.
+ */
+int dfiAvrobin_readBlock(dfi_avrobin_reader_t *reader, void *seqLoc, size_t itemSize, uint32_t *count);
+
+#endif
@@ -28,13 +28,20 @@
 
 #include "dyn_common.h"
 
+typedef struct _dyn_function_argument_type dyn_function_argument_type;
+typedef struct dyn_function_argument_index dyn_function_argument_index;
+typedef void (*dyn_function_invoker)(void (*fn)(void), void *returnValue, void **argValues);
+
 struct _dyn_function_type {
     char *name;
     struct types_head *refTypes; //NOTE not owned
     TAILQ_HEAD(,_dyn_function_argument_type) arguments;
+    dyn_function_argument_index *argumentIndex; //atomic, lazily created array of the arguments for O(1) lookup
     ffi_type **ffiArguments;
     dyn_type *funcReturn;
     ffi_cif cif;
+    dyn_function_invoker invoker; //statically generated invoker for common signatures, NULL if libffi is needed
+    const struct dfi_rpc_method_codec *codec; //optional, generated json rpc functions. See dfi_codec.h
 
     //closure part
     ffi_closure *ffiClosure;
@@ -43,7 +50,6 @@ struct _dyn_function_type {
     void (*bind)(void *userData, void *args[], void *ret);
 };
 
-typedef struct _dyn_function_argument_type dyn_function_argument_type;
 struct _dyn_function_argument_type {
     int index;
     char *name;
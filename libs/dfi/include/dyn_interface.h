@@ -40,6 +40,9 @@ DFI_SETUP_LOG_HEADER(dynAvprInterface);
  * ':types\n' [TypeIdValue]*
  * ':methods\n' [MethodIdValue]
  *
+ * Method annotations are annotations named '<method name>.<key>'. Supported method annotations:
+ * <method name>.cacheTtlMs=<ms>    The replies of the method only depend on its arguments, so remote service proxies
+ *                                  can cache them for ms milliseconds.
  */
 typedef struct _dyn_interface_type dyn_interface_type;
 
@@ -61,11 +64,29 @@ int dynInterface_getVersion(dyn_interface_type *intf, version_pt* version);
 int dynInterface_getVersionString(dyn_interface_type *intf, char **version);
 int dynInterface_getHeaderEntry(dyn_interface_type *intf, const char *name, char **value);
 int dynInterface_getAnnotationEntry(dyn_interface_type *intf, const char *name, char **value);
+/**
+ * Returns the value of the method annotation '<method name>.<key>' of the method, or NULL if not present.
+ */
+const char* dynInterface_getMethodAnnotation(dyn_interface_type *intf, const struct method_entry *method, const char *key);
 int dynInterface_methods(dyn_interface_type *intf, struct methods_head **list);
 int dynInterface_nrOfMethods(dyn_interface_type *intf);
 
+/**
+ * Finds the method with the provided id (signature) using a hash index, which is created on first use.
+ * Returns 0 and sets method if found.
+ */
+int dynInterface_findMethod(dyn_interface_type *intf, const char *id, struct method_entry **method);
+
 // Avpr parsing
 dyn_interface_type * dynInterface_parseAvprWithStr(const char * avpr);
 dyn_interface_type * dynInterface_parseAvpr(FILE * avprStream);
 
+/**
+ * Parses the (avpr) descriptor, or returns the shared parse result of an identical descriptor parsed before.
+ * The result is shared and must be treated as immutable, e.g. closures must not be created for its methods.
+ * dynInterface_destroy releases the caller's reference.
+ */
+int dynInterface_parseShared(FILE *descriptor, dyn_interface_type **out);
+dyn_interface_type * dynInterface_parseAvprShared(FILE * avprStream);
+
 #endif
@@ -28,12 +28,17 @@
 
 #include "dyn_common.h"
 
+typedef struct dyn_interface_method_index dyn_interface_method_index;
+
 struct _dyn_interface_type {
     struct namvals_head header;
     struct namvals_head annotations;
     struct types_head types;
     struct methods_head methods;
     version_pt version;
+    dyn_interface_method_index *methodIndex; //atomic, lazily created hash index of methods by id
+    bool shared; //parse result is owned by the parse cache
+    const struct dfi_rpc_codec *codec; //optional, generated json rpc functions. See dfi_codec.h
 };
 
 #endif
@@ -38,6 +38,10 @@ DFI_SETUP_LOG_HEADER(dynMessage);
  * ':types\n' [TypeIdValue]*
  * ':message\n' [MessageIdValue]
  *
+ * Supported annotations:
+ * instancePool=<n>                 Enables an instance pool of max n instances for the message type, for messages
+ *                                  received at high rates. See dynType_enablePool.
+ * instancePoolMaxSequenceCap=<n>   Max capacity of the pooled sequence buffers, default 1024.
  */
 typedef struct _dyn_message_type dyn_message_type;
 
@@ -45,6 +49,12 @@ typedef struct _dyn_message_type dyn_message_type;
 int dynMessage_parse(FILE *descriptor, dyn_message_type **out);
 void dynMessage_destroy(dyn_message_type *msg);
 
+/**
+ * Parses the descriptor, or returns the shared parse result of an identical descriptor parsed before.
+ * The result is shared and must be treated as immutable. dynMessage_destroy releases the caller's reference.
+ */
+int dynMessage_parseShared(FILE *descriptor, dyn_message_type **out);
+
 int dynMessage_getName(dyn_message_type *msg, char **name);
 int dynMessage_getVersion(dyn_message_type *msg, version_pt* version);
 int dynMessage_getVersionString(dyn_message_type *msg, char **version);
@@ -56,4 +66,11 @@ int dynMessage_getMessageType(dyn_message_type *msg, dyn_type **type);
 dyn_message_type * dynMessage_parseAvpr(FILE *avprDescriptorStream, const char *fqn);
 dyn_message_type * dynMessage_parseAvprWithStr(const char *avprDescriptor, const char *fqn);
 
+/**
+ * Parses the message with the fqn from the avpr, or returns the shared parse result of the same message of an
+ * identical avpr parsed before. The result is shared and must be treated as immutable. dynMessage_destroy releases
+ * the caller's reference.
+ */
+dyn_message_type * dynMessage_parseAvprShared(FILE *avprDescriptorStream, const char *fqn);
+
 #endif
@@ -0,0 +1,63 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *  KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#ifndef _DYN_PARSE_CACHE_H_
+#define _DYN_PARSE_CACHE_H_
+
+#include <stdio.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+/**
+ * Process wide cache of parsed descriptors, used by the dynMessage_parseShared and dynInterface_parseShared variants.
+ *
+ * Entries are keyed by the kind of descriptor, an optional name (e.g. the fqn for avpr) and the descriptor content
+ * (hash + full compare), so the same descriptor found through different bundles or paths is parsed only once.
+ * Entries are reference counted and are removed when the last user destroys the shared parse result.
+ */
+
+#define DYN_PARSE_CACHE_MESSAGE 0
+#define DYN_PARSE_CACHE_INTERFACE 1
+#define DYN_PARSE_CACHE_INTERFACE_AVPR 2
+#define DYN_PARSE_CACHE_MESSAGE_AVPR 3
+
+/**
+ * Reads the remaining content of the stream. On success content must be freed by the caller.
+ */
+int dynParseCache_readStream(FILE *stream, char **content, size_t *contentLen);
+
+/**
+ * Returns the cached parse result for the kind, name and content and increases its reference count, or NULL.
+ */
+void* dynParseCache_acquire(int kind, const char *name, const char *content, size_t contentLen);
+
+/**
+ * Adds a parse result to the cache with a reference count of 1. If a result for the same key was added meanwhile,
+ * that result is acquired and returned instead and the caller should destroy its own parse result.
+ * If the entry cannot be allocated, parsed is returned uncached (release will then report the last reference).
+ */
+void* dynParseCache_add(int kind, const char *name, const char *content, size_t contentLen, void *parsed);
+
+/**
+ * Releases a reference to a shared parse result.
+ * Returns true if this was the last reference, in which case the caller must destroy the parse result.
+ */
+bool dynParseCache_release(void *parsed);
+
+#endif
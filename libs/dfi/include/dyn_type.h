@@ -27,6 +27,7 @@
 #include <stdint.h>
 
 #include "dfi_log_util.h"
+#include "celix_arena.h"
 
 #if defined(BSD) || defined(__APPLE__) || defined(__ANDROID__)
 #include "memstream/open_memstream.h"
@@ -185,6 +186,66 @@ int dynType_alloc(dyn_type *type, void **instance);
  */
 void dynType_free(dyn_type *type, void *instance);
 
+/**
+ * Enables an instance pool for the dyn type, meant for fixed-shape types which are allocated and freed at high rates
+ * (e.g. received messages).
+ *
+ * Instances released with dynType_free are reset (zeroed) and kept for reuse by dynType_alloc instead of freed.
+ * The same goes for the nested allocations: instances behind typed pointers and sequence buffers with a capacity up to
+ * maxSequenceCap, which are reused by dynType_alloc and dynType_sequence_alloc. Note that a reused sequence buffer
+ * can have a larger capacity than requested.
+ * At most maxInstances instances (or sequence buffers) are kept per (nested) type, the pooled memory is freed when the
+ * dyn type is destroyed.
+ *
+ * The pools are thread safe. Enabling the pool is not and should be done before the dyn type is used.
+ * Enabling the pool for a type which already has a pool has no effect.
+ *
+ * @param type              The dyn type.
+ * @param maxInstances      The max nr of pooled instances or sequence buffers per type. 0 disables pooling.
+ * @param maxSequenceCap    Sequence buffers with a larger capacity (in items) are freed instead of pooled.
+ * @return                  0 on success.
+ */
+int dynType_enablePool(dyn_type *type, size_t maxInstances, uint32_t maxSequenceCap);
+
+/**
+ * Returns whether released instances (or for a sequence type, sequence buffers) of the dyn type are pooled.
+ */
+bool dynType_hasPool(dyn_type *type);
+
+/**
+ * free the memory referenced by a type instance described by a dyn type (texts, sequence buffers, typed pointers).
+ * This is a deep free.
+ *
+ * @param type          The dyn type of the instance.
+ * @param instance      The memory location of the type instance.
+ * @param alsoDeleteSelf Whether the instance memory itself should also be freed.
+ */
+void dynType_deepFree(dyn_type *type, void *instance, bool alsoDeleteSelf);
+
+/**
+ * Creates a deep copy of a type instance described by a dyn type (including texts, sequence buffers and
+ * typed pointers). The copy of a sequence gets a capacity equal to the sequence length.
+ * The copy is owned by the caller and can be freed with dynType_free.
+ *
+ * @param type      The dyn type of the instance.
+ * @param src       The memory location of the type instance to copy.
+ * @param out       The output argument for the copy.
+ * @return          0 on success.
+ */
+int dynType_copy(dyn_type *type, const void *src, void **out);
+
+/**
+ * Allocates a zero initialized type instance from an arena. Unlike dynType_alloc, typed pointers are not pre-allocated.
+ * The instance and the memory allocated with the other arena variants are released together with the arena
+ * and must not be freed with dynType_free.
+ *
+ * @param type      The dyn type for which structure to allocate.
+ * @param arena     The arena to allocate from.
+ * @param instance  The output argument for the allocated memory.
+ * @return          0 on success.
+ */
+int dynType_allocInArena(dyn_type *type, celix_arena_t *arena, void **instance);
+
 /**
  * Prints the dyn type information to the provided output stream.
  * @param type      The dyn type to print.
@@ -201,6 +262,15 @@ void dynType_print(dyn_type *type, FILE *stream);
  */
 size_t dynType_size(dyn_type *type);
 
+/**
+ * Returns whether the dyn type describes plain old data, i.e. a fixed layout of simple, enum and complex types without
+ * pointers, texts or sequences. The dynType_size bytes of a plain old data instance are the complete instance.
+ *
+ * @param type  The dyn type.
+ * @return      True if the dyn type is plain old data.
+ */
+bool dynType_isPod(dyn_type *type);
+
 /**
  * The type of the dyn type
  * E.g. DYN_TYPE_SIMPLE, DYN_TYPE_COMPLEX, etc
@@ -268,6 +338,7 @@ size_t dynType_complex_nrOfEntries(dyn_type *type);
 
 //sequence
 int dynType_sequence_alloc(dyn_type *type, void *inst, uint32_t cap);
+int dynType_sequence_allocInArena(dyn_type *type, void *inst, uint32_t cap, celix_arena_t *arena);
 int dynType_sequence_locForIndex(dyn_type *type, void *seqLoc, int index, void **valLoc);
 int dynType_sequence_increaseLengthAndReturnLastLoc(dyn_type *type, void *seqLoc, void **valLoc);
 dyn_type * dynType_sequence_itemType(dyn_type *type);
@@ -278,6 +349,10 @@ int dynType_typedPointer_getTypedType(dyn_type *type, dyn_type **typedType);
 
 //text
 int dynType_text_allocAndInit(dyn_type *type, void *textLoc, const char *value);
+/**
+ * Copies len chars of value (which does not need to be NUL terminated) as text into the arena.
+ */
+int dynType_text_initInArena(dyn_type *type, void *textLoc, const char *value, size_t len, celix_arena_t *arena);
 
 //simple
 void dynType_simple_setValue(dyn_type *type, void *inst, void *in);
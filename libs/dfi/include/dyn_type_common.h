@@ -29,11 +29,22 @@
 
 DFI_SETUP_LOG_HEADER(dynTypeCommon);
 
+struct generic_sequence {
+    uint32_t cap;
+    uint32_t len;
+    void *buf;
+};
+
+struct dyn_type_plan;
+
 struct _dyn_type {
     char *name;
     char descriptor;
     int type;
     ffi_type *ffiType;
+    struct dyn_type_plan *plan; //atomic, lazily compiled serialization plan. See dynType_plan
+    struct dyn_type_pool *pool; //optional, released instances or sequence buffers for reuse. See dynType_enablePool
+    const struct dfi_message_codec *codec; //optional, generated serialization functions for a message type. See dfi_codec.h
     dyn_type *parent;
     struct types_head *referenceTypes; //NOTE: not owned
     struct types_head nestedTypesHead;
@@ -60,5 +71,6 @@ struct _dyn_type {
 dyn_type * dynType_findType(dyn_type *type, char *name);
 ffi_type * dynType_ffiType(dyn_type * type);
 void dynType_prepCif(ffi_type *type);
+size_t dynType_complex_offsetAt(dyn_type *type, int index);
 
 #endif
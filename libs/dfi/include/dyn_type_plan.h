@@ -0,0 +1,100 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *  KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#ifndef _DYN_TYPE_PLAN_H_
+#define _DYN_TYPE_PLAN_H_
+
+#include <stddef.h>
+
+#include "dyn_type.h"
+#include "celix_properties.h"
+
+/**
+ * A dyn type plan is a dyn type flattened to a linear list of steps, so that serializers do not have to walk the dyn
+ * type tree, look up complex entries by name and calculate member offsets for every message.
+ *
+ * Nested complex types (struct members by value) are flattened into the plan, with the offsets of their members
+ * relative to the start of the root instance. The begin and end of a complex type are marked with
+ * DYN_TYPE_PLAN_BEGIN_COMPLEX and DYN_TYPE_PLAN_END_COMPLEX steps, so that structured formats (e.g. json)
+ * can still create the nesting.
+ * Sequences and typed pointers point to memory outside the instance and are therefore not flattened; the plans of
+ * their item or typed type can be retrieved with dynType_plan when needed.
+ *
+ * A plan is compiled once (on first use) and is owned by the dyn type.
+ */
+typedef struct dyn_type_plan dyn_type_plan;
+
+#define DYN_TYPE_PLAN_VALUE 0
+#define DYN_TYPE_PLAN_BEGIN_COMPLEX 1
+#define DYN_TYPE_PLAN_END_COMPLEX 2
+
+typedef struct dyn_type_plan_step {
+    int kind; //DYN_TYPE_PLAN_VALUE, DYN_TYPE_PLAN_BEGIN_COMPLEX or DYN_TYPE_PLAN_END_COMPLEX
+    int descriptor; //descriptor type of the (reference resolved) type, e.g. 'I', 't', '[', '*', '{'
+    size_t offset; //offset of the value relative to the start of the instance
+    const char *name; //name of complex member or NULL
+    dyn_type *type; //the reference resolved type of the value
+    dyn_type *subType; //item type for sequences, typed type for typed pointers, else NULL
+    size_t subTypeSize; //size of a sequence item
+    size_t end; //for DYN_TYPE_PLAN_BEGIN_COMPLEX steps: the index of the matching DYN_TYPE_PLAN_END_COMPLEX step
+} dyn_type_plan_step_t;
+
+/**
+ * Returns the plan for the dyn type, compiles the plan on first use.
+ * Thread safe. The plan is owned by the dyn type and valid as long as the dyn type.
+ *
+ * @param type  The dyn type.
+ * @return      The plan or NULL if the plan could not be compiled (out of memory).
+ */
+const dyn_type_plan* dynType_plan(dyn_type *type);
+
+/**
+ * Returns the number of steps of the plan.
+ */
+size_t dynTypePlan_nrOfSteps(const dyn_type_plan *plan);
+
+/**
+ * Returns the steps of the plan as array of dynTypePlan_nrOfSteps size.
+ */
+const dyn_type_plan_step_t* dynTypePlan_steps(const dyn_type_plan *plan);
+
+/**
+ * Returns the descriptor of the value if the type is a single primitive number (e.g. the item type of [D or [I),
+ * else 0. Used by the serializers for the bulk paths of numeric sequences.
+ */
+int dynType_primitiveNumber(dyn_type *type);
+
+/**
+ * Adds the primitive, enum and text values of a complex type instance to props, keyed by member name.
+ * Members of nested complex types are keyed by their dotted path (e.g. "pos.x") and enums by their enum name.
+ * Sequences and pointers are skipped. Can be used to match instances against a celix filter.
+ *
+ * @param type  The dyn type. Must be a complex type.
+ * @param inst  The instance of the dyn type.
+ * @param props The properties to add the values to.
+ * @return      0 if successful.
+ */
+int dynType_toProperties(dyn_type *type, const void *inst, celix_properties_t *props);
+
+/**
+ * Destroys a plan. Called by dynType_destroy.
+ */
+void dynTypePlan_destroy(dyn_type_plan *plan);
+
+#endif
@@ -35,4 +35,15 @@ int jsonRpc_call(dyn_interface_type *intf, void *service, const char *request, c
 int jsonRpc_prepareInvokeRequest(dyn_function_type *func, const char *id, void *args[], char **out);
 int jsonRpc_handleReply(dyn_function_type *func, const char *reply, void *args[]);
 
+/**
+ * Combines count invoke requests into one batch request (a json array), which jsonRpc_call answers with a json
+ * array holding the reply of every request at the same index.
+ */
+int jsonRpc_prepareBatchRequest(char * const requests[], size_t count, char **out);
+
+/**
+ * Splits a batch reply into count allocated reply strings, a request which could not be handled gets a NULL reply.
+ */
+int jsonRpc_splitBatchReply(const char *reply, size_t count, char *replies[]);
+
 #endif
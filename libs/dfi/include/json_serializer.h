@@ -32,6 +32,12 @@ DFI_SETUP_LOG_HEADER(jsonSerializer);
 int jsonSerializer_deserialize(dyn_type *type, const char *input, void **result);
 int jsonSerializer_deserializeJson(dyn_type *type, json_t *input, void **result);
 
+/**
+ * Deserializes input into the caller provided, zero initialized, instance memory of dynType_size(type) bytes.
+ * The content of inst (also on failure) must be freed with dynType_deepFree(type, inst, false).
+ */
+int jsonSerializer_deserializeJsonInto(dyn_type *type, json_t *input, void *inst);
+
 int jsonSerializer_serialize(dyn_type *type, const void* input, char **output);
 int jsonSerializer_serializeJson(dyn_type *type, const void* input, json_t **out);
 
@@ -0,0 +1,563 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *  KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include "avrobin_rpc.h"
+#include "avrobin_serializer.h"
+#include "dyn_type.h"
+#include "dyn_interface.h"
+
+#include <assert.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ffi.h>
+
+#define AVROBIN_RPC_HEADER_SIZE     6
+#define AVROBIN_RPC_INITIAL_SIZE    128
+#define AVROBIN_RPC_MAX_VARINT_SIZE 10
+
+static const int OK = 0;
+static const int ERROR = 1;
+
+static const uint8_t AVROBIN_RPC_MAGIC[4] = {'C', 'R', 'P', 'C'};
+
+DFI_SETUP_LOG(avrobinRpc);
+
+typedef void (*gen_func_type)(void);
+
+struct generic_service_layout {
+    void *handle;
+    gen_func_type methods[];
+};
+
+typedef struct avrobin_rpc_writer {
+    uint8_t *buf;
+    size_t len;
+    size_t cap;
+    uint8_t *valueBuf; //scratch buffer for serializing a single value
+    size_t valueBufSize;
+} avrobin_rpc_writer_t;
+
+typedef struct avrobin_rpc_reader {
+    const uint8_t *buf;
+    size_t len;
+    size_t pos;
+} avrobin_rpc_reader_t;
+
+static int avrobinRpc_writeRaw(avrobin_rpc_writer_t *writer, const void *data, size_t len);
+static int avrobinRpc_writeLong(avrobin_rpc_writer_t *writer, int64_t val);
+static int avrobinRpc_writeHeader(avrobin_rpc_writer_t *writer, uint8_t kind, uint64_t callId);
+static int avrobinRpc_writeValue(avrobin_rpc_writer_t *writer, dyn_type *type, const void *value);
+static void avrobinRpc_writerDestroy(avrobin_rpc_writer_t *writer);
+
+static int avrobinRpc_readLong(avrobin_rpc_reader_t *reader, int64_t *val);
+static int avrobinRpc_readBytes(avrobin_rpc_reader_t *reader, const uint8_t **data, size_t *len);
+static int avrobinRpc_readHeader(avrobin_rpc_reader_t *reader, uint8_t expectedKind, uint64_t *callId);
+
+bool avrobinRpc_isMessage(const uint8_t *data, size_t dataLen) {
+    return data != NULL && dataLen >= AVROBIN_RPC_HEADER_SIZE && memcmp(data, AVROBIN_RPC_MAGIC, sizeof(AVROBIN_RPC_MAGIC)) == 0;
+}
+
+static int avrobinRpc_writeBatch(avrobin_rpc_writer_t *writer, const uint8_t * const messages[], const size_t lengths[], size_t count);
+static int avrobinRpc_callBatch(dyn_interface_type *intf, void *service, const uint8_t *request, size_t requestLen, uint8_t **out, size_t *outLen);
+
+int avrobinRpc_call(dyn_interface_type *intf, void *service, const uint8_t *request, size_t requestLen, uint8_t **out, size_t *outLen) {
+    int status = OK;
+    if (avrobinRpc_isMessage(request, requestLen) && request[5] == AVROBIN_RPC_KIND_BATCH) {
+        return avrobinRpc_callBatch(intf, service, request, requestLen, out, outLen);
+    }
+    avrobin_rpc_reader_t reader = {.buf = request, .len = requestLen, .pos = 0};
+
+    uint64_t callId = 0;
+    const uint8_t *id = NULL;
+    size_t idLen = 0;
+    int64_t nrOfValues = 0;
+    status = avrobinRpc_readHeader(&reader, AVROBIN_RPC_KIND_REQUEST, &callId);
+    if (status == OK) {
+        status = avrobinRpc_readBytes(&reader, &id, &idLen);
+    }
+    if (status == OK) {
+        status = avrobinRpc_readLong(&reader, &nrOfValues);
+    }
+    if (status != OK) {
+        LOG_ERROR("Invalid avrobin rpc request");
+        return ERROR;
+    }
+
+    char sig[idLen + 1];
+    memcpy(sig, id, idLen);
+    sig[idLen] = '\0';
+
+    struct method_entry *method = NULL;
+    if (dynInterface_findMethod(intf, sig, &method) != OK) {
+        LOG_ERROR("Cannot find method with sig '%s'", sig);
+        return ERROR;
+    }
+
+    dyn_function_type *func = method->dynFunc;
+    dyn_type *returnType = dynFunction_returnType(func);
+    if (dynType_descriptorType(returnType) != 'N') {
+        //NOTE To be able to handle exception only N as returnType is supported
+        LOG_ERROR("Only interface methods with a native int are supported. Found type '%c'", (char)dynType_descriptorType(returnType));
+        return ERROR;
+    }
+
+    struct generic_service_layout *serv = service;
+    void *handle = serv->handle;
+    void (*fp)(void) = serv->methods[method->index];
+
+    int nrOfArgs = dynFunction_nrOfArguments(func);
+    void *args[nrOfArgs > 0 ? nrOfArgs : 1];
+    memset(args, 0, sizeof(args));
+
+    void *ptr = NULL;
+    void *ptrToPtr = &ptr;
+
+    int64_t valueIndex = 0;
+    for (int i = 0; i < nrOfArgs && status == OK; i += 1) {
+        dyn_type *argType = dynFunction_argumentTypeForIndex(func, i);
+        enum dyn_function_argument_meta meta = dynFunction_argumentMetaForIndex(func, i);
+        if (meta == DYN_FUNCTION_ARGUMENT_META__STD) {
+            const uint8_t *value = NULL;
+            size_t valueLen = 0;
+            if (valueIndex++ >= nrOfValues) {
+                LOG_ERROR("Missing argument %i for method '%s'", i, sig);
+                status = ERROR;
+            } else {
+                status = avrobinRpc_readBytes(&reader, &value, &valueLen);
+            }
+            if (status == OK) {
+                status = avrobinSerializer_deserialize(argType, value, valueLen, &args[i]);
+            }
+        } else if (meta == DYN_FUNCTION_ARGUMENT_META__PRE_ALLOCATED_OUTPUT) {
+            status = dynType_alloc(argType, &args[i]);
+        } else if (meta == DYN_FUNCTION_ARGUMENT_META__OUTPUT) {
+            args[i] = &ptrToPtr;
+        } else if (meta == DYN_FUNCTION_ARGUMENT_META__HANDLE) {
+            args[i] = &handle;
+        }
+    }
+
+    ffi_sarg returnVal = 1;
+    if (status == OK) {
+        status = dynFunction_call(func, fp, (void *) &returnVal, args);
+    }
+    int funcCallStatus = (int)returnVal;
+    if (status == OK && funcCallStatus != 0) {
+        LOG_WARNING("Error calling remote endpoint function, got error code %i", funcCallStatus);
+    }
+
+    avrobin_rpc_writer_t writer = {.buf = NULL, .len = 0, .cap = 0, .valueBuf = NULL, .valueBufSize = 0};
+    if (status == OK) {
+        status = avrobinRpc_writeHeader(&writer, AVROBIN_RPC_KIND_REPLY, callId);
+    }
+    if (status == OK) {
+        status = avrobinRpc_writeLong(&writer, funcCallStatus);
+    }
+
+    //encode the output argument (if any) and release the arguments
+    const void *result = NULL;
+    dyn_type *resultType = NULL;
+    for (int i = 0; i < nrOfArgs; i += 1) {
+        dyn_type *argType = dynFunction_argumentTypeForIndex(func, i);
+        enum dyn_function_argument_meta meta = dynFunction_argumentMetaForIndex(func, i);
+        if (meta == DYN_FUNCTION_ARGUMENT_META__PRE_ALLOCATED_OUTPUT && args[i] != NULL && resultType == NULL) {
+            resultType = argType;
+            result = args[i];
+        } else if (meta == DYN_FUNCTION_ARGUMENT_META__OUTPUT && ptr != NULL && resultType == NULL) {
+            dyn_type *typedType = NULL;
+            dynType_typedPointer_getTypedType(argType, &typedType);
+            if (dynType_descriptorType(typedType) == 't') {
+                resultType = typedType;
+                result = &ptr;
+            } else {
+                dynType_typedPointer_getTypedType(typedType, &resultType);
+                result = ptr;
+            }
+        }
+    }
+    if (status == OK) {
+        bool hasResult = funcCallStatus == 0 && resultType != NULL;
+        status = avrobinRpc_writeLong(&writer, hasResult ? 1 : 0);
+        if (status == OK && hasResult) {
+            status = avrobinRpc_writeValue(&writer, resultType, result);
+        }
+    }
+
+    for (int i = 0; i < nrOfArgs; i += 1) {
+        dyn_type *argType = dynFunction_argumentTypeForIndex(func, i);
+        enum dyn_function_argument_meta meta = dynFunction_argumentMetaForIndex(func, i);
+        if (meta == DYN_FUNCTION_ARGUMENT_META__STD || meta == DYN_FUNCTION_ARGUMENT_META__PRE_ALLOCATED_OUTPUT) {
+            dynType_free(argType, args[i]);
+        } else if (meta == DYN_FUNCTION_ARGUMENT_META__OUTPUT && ptr != NULL) {
+            dyn_type *typedType = NULL;
+            dynType_typedPointer_getTypedType(argType, &typedType);
+            if (dynType_descriptorType(typedType) == 't') {
+                free(ptr);
+            } else {
+                dyn_type *typedTypedType = NULL;
+                dynType_typedPointer_getTypedType(typedType, &typedTypedType);
+                dynType_free(typedTypedType, ptr);
+            }
+            ptr = NULL;
+        }
+    }
+
+    if (status == OK) {
+        *out = writer.buf;
+        *outLen = writer.len;
+        writer.buf = NULL;
+    }
+    avrobinRpc_writerDestroy(&writer);
+    return status;
+}
+
+int avrobinRpc_prepareInvokeRequest(dyn_function_type *func, const char *id, uint64_t callId, void *args[], uint8_t **out, size_t *outLen) {
+    avrobin_rpc_writer_t writer = {.buf = NULL, .len = 0, .cap = 0, .valueBuf = NULL, .valueBufSize = 0};
+    size_t idLen = strlen(id);
+
+    int nrOfArgs = dynFunction_nrOfArguments(func);
+    int nrOfValues = 0;
+    for (int i = 0; i < nrOfArgs; i += 1) {
+        if (dynFunction_argumentMetaForIndex(func, i) == DYN_FUNCTION_ARGUMENT_META__STD) {
+            nrOfValues += 1;
+        }
+    }
+
+    int status = avrobinRpc_writeHeader(&writer, AVROBIN_RPC_KIND_REQUEST, callId);
+    if (status == OK) {
+        status = avrobinRpc_writeLong(&writer, (int64_t)idLen);
+    }
+    if (status == OK) {
+        status = avrobinRpc_writeRaw(&writer, id, idLen);
+    }
+    if (status == OK) {
+        status = avrobinRpc_writeLong(&writer, nrOfValues);
+    }
+    for (int i = 0; i < nrOfArgs && status == OK; i += 1) {
+        if (dynFunction_argumentMetaForIndex(func, i) == DYN_FUNCTION_ARGUMENT_META__STD) {
+            status = avrobinRpc_writeValue(&writer, dynFunction_argumentTypeForIndex(func, i), args[i]);
+        }
+    }
+
+    if (status == OK) {
+        *out = writer.buf;
+        *outLen = writer.len;
+        writer.buf = NULL;
+    } else {
+        LOG_ERROR("Cannot create avrobin rpc request for '%s'", id);
+    }
+    avrobinRpc_writerDestroy(&writer);
+    return status;
+}
+
+int avrobinRpc_handleReply(dyn_function_type *func, uint64_t callId, const uint8_t *reply, size_t replyLen, void *args[], int *replyStatus) {
+    avrobin_rpc_reader_t reader = {.buf = reply, .len = replyLen, .pos = 0};
+
+    uint64_t replyCallId = 0;
+    int64_t remoteStatus = 0;
+    int64_t nrOfValues = 0;
+    int status = avrobinRpc_readHeader(&reader, AVROBIN_RPC_KIND_REPLY, &replyCallId);
+    if (status == OK) {
+        status = avrobinRpc_readLong(&reader, &remoteStatus);
+    }
+    if (status == OK) {
+        status = avrobinRpc_readLong(&reader, &nrOfValues);
+    }
+    if (status != OK) {
+        LOG_ERROR("Invalid avrobin rpc reply");
+        return ERROR;
+    }
+    if (replyCallId != callId) {
+        LOG_ERROR("Got avrobin rpc reply for call %llu, expected call %llu", (unsigned long long)replyCallId, (unsigned long long)callId);
+        return ERROR;
+    }
+
+    *replyStatus = (int)remoteStatus;
+    if (remoteStatus != 0 || nrOfValues == 0) {
+        return OK;
+    }
+
+    const uint8_t *value = NULL;
+    size_t valueLen = 0;
+    status = avrobinRpc_readBytes(&reader, &value, &valueLen);
+
+    int nrOfArgs = dynFunction_nrOfArguments(func);
+    for (int i = 0; i < nrOfArgs && status == OK; i += 1) {
+        dyn_type *argType = dynFunction_argumentTypeForIndex(func, i);
+        enum dyn_function_argument_meta meta = dynFunction_argumentMetaForIndex(func, i);
+        if (meta == DYN_FUNCTION_ARGUMENT_META__PRE_ALLOCATED_OUTPUT) {
+            //copy the result in the memory provided by the caller, the caller takes over the nested allocations
+            dyn_type *typedType = NULL;
+            void *tmp = NULL;
+            status = dynType_typedPointer_getTypedType(argType, &typedType);
+            if (status == OK) {
+                status = avrobinSerializer_deserialize(typedType, value, valueLen, &tmp);
+            }
+            if (status == OK) {
+                void **outLoc = args[i];
+                memcpy(*outLoc, tmp, dynType_size(typedType));
+                free(tmp);
+            }
+            break;
+        } else if (meta == DYN_FUNCTION_ARGUMENT_META__OUTPUT) {
+            dyn_type *subType = NULL;
+            void ***outLoc = args[i];
+            status = dynType_typedPointer_getTypedType(argType, &subType);
+            if (status == OK && dynType_descriptorType(subType) == 't') {
+                void *tmp = NULL;
+                status = avrobinSerializer_deserialize(subType, value, valueLen, &tmp);
+                if (status == OK) {
+                    **outLoc = *(char**)tmp;
+                    free(tmp);
+                }
+            } else if (status == OK) {
+                dyn_type *subSubType = NULL;
+                status = dynType_typedPointer_getTypedType(subType, &subSubType);
+                if (status == OK) {
+                    status = avrobinSerializer_deserialize(subSubType, value, valueLen, *outLoc);
+                }
+            }
+            break;
+        }
+    }
+
+    return status;
+}
+
+int avrobinRpc_prepareBatchRequest(const uint8_t * const requests[], const size_t lengths[], size_t count, uint8_t **out, size_t *outLen) {
+    avrobin_rpc_writer_t writer = {.buf = NULL, .len = 0, .cap = 0, .valueBuf = NULL, .valueBufSize = 0};
+    int status = avrobinRpc_writeBatch(&writer, requests, lengths, count);
+    if (status == OK) {
+        *out = writer.buf;
+        *outLen = writer.len;
+        writer.buf = NULL;
+    }
+    avrobinRpc_writerDestroy(&writer);
+    return status;
+}
+
+int avrobinRpc_splitBatchReply(const uint8_t *reply, size_t replyLen, size_t count, const uint8_t *replies[], size_t lengths[]) {
+    avrobin_rpc_reader_t reader = {.buf = reply, .len = replyLen, .pos = 0};
+    uint64_t callId = 0;
+    int64_t nrOfReplies = 0;
+    int status = avrobinRpc_readHeader(&reader, AVROBIN_RPC_KIND_BATCH, &callId);
+    if (status == OK) {
+        status = avrobinRpc_readLong(&reader, &nrOfReplies);
+    }
+    if (status == OK && (nrOfReplies < 0 || (uint64_t)nrOfReplies != count)) {
+        LOG_ERROR("Expected %zu replies in avrobin rpc batch, got %lli", count, (long long)nrOfReplies);
+        status = ERROR;
+    }
+    for (size_t i = 0; i < count; i += 1) {
+        replies[i] = NULL;
+        lengths[i] = 0;
+        if (status == OK) {
+            status = avrobinRpc_readBytes(&reader, &replies[i], &lengths[i]);
+        }
+    }
+    return status;
+}
+
+/**
+ * Handles every request of the batch in order. A request which cannot be handled gets an empty reply, so that the
+ * other requests of the batch still get theirs.
+ */
+static int avrobinRpc_callBatch(dyn_interface_type *intf, void *service, const uint8_t *request, size_t requestLen, uint8_t **out, size_t *outLen) {
+    avrobin_rpc_reader_t reader = {.buf = request, .len = requestLen, .pos = 0};
+    uint64_t callId = 0;
+    int64_t count = 0;
+    int status = avrobinRpc_readHeader(&reader, AVROBIN_RPC_KIND_BATCH, &callId);
+    if (status == OK) {
+        status = avrobinRpc_readLong(&reader, &count);
+    }
+    if (status != OK || count < 0 || (uint64_t)count > reader.len - reader.pos) {
+        LOG_ERROR("Invalid avrobin rpc batch request");
+        return ERROR;
+    }
+
+    const uint8_t **replies = calloc((size_t)count + 1, sizeof(*replies));
+    size_t *replyLengths = calloc((size_t)count + 1, sizeof(*replyLengths));
+    if (replies == NULL || replyLengths == NULL) {
+        status = ERROR;
+    }
+    for (int64_t i = 0; i < count && status == OK; i += 1) {
+        const uint8_t *callRequest = NULL;
+        size_t callRequestLen = 0;
+        status = avrobinRpc_readBytes(&reader, &callRequest, &callRequestLen);
+        //batches are not nested
+        if (status == OK && avrobinRpc_isMessage(callRequest, callRequestLen) && callRequest[5] != AVROBIN_RPC_KIND_BATCH) {
+            uint8_t *reply = NULL;
+            size_t replyLen = 0;
+            if (avrobinRpc_call(intf, service, callRequest, callRequestLen, &reply, &replyLen) == OK) {
+                replies[i] = reply;
+                replyLengths[i] = replyLen;
+            }
+        }
+    }
+
+    if (status == OK) {
+        avrobin_rpc_writer_t writer = {.buf = NULL, .len = 0, .cap = 0, .valueBuf = NULL, .valueBufSize = 0};
+        status = avrobinRpc_writeBatch(&writer, replies, replyLengths, (size_t)count);
+        if (status == OK) {
+            *out = writer.buf;
+            *outLen = writer.len;
+            writer.buf = NULL;
+        }
+        avrobinRpc_writerDestroy(&writer);
+    }
+
+    for (int64_t i = 0; i < count && replies != NULL; i += 1) {
+        free((void *)replies[i]);
+    }
+    free(replies);
+    free(replyLengths);
+    return status;
+}
+
+static int avrobinRpc_writeBatch(avrobin_rpc_writer_t *writer, const uint8_t * const messages[], const size_t lengths[], size_t count) {
+    int status = avrobinRpc_writeHeader(writer, AVROBIN_RPC_KIND_BATCH, 0);
+    if (status == OK) {
+        status = avrobinRpc_writeLong(writer, (int64_t)count);
+    }
+    for (size_t i = 0; i < count && status == OK; i += 1) {
+        status = avrobinRpc_writeLong(writer, (int64_t)lengths[i]);
+        if (status == OK && lengths[i] > 0) {
+            status = avrobinRpc_writeRaw(writer, messages[i], lengths[i]);
+        }
+    }
+    return status;
+}
+
+static int avrobinRpc_reserve(avrobin_rpc_writer_t *writer, size_t extra) {
+    if (writer->cap - writer->len >= extra) {
+        return OK;
+    }
+    size_t newCap = writer->cap == 0 ? AVROBIN_RPC_INITIAL_SIZE : writer->cap;
+    while (newCap - writer->len < extra) {
+        if (newCap > SIZE_MAX / 2) {
+            LOG_ERROR("Write error, buffer too large.");
+            return ERROR;
+        }
+        newCap *= 2;
+    }
+    uint8_t *newBuf = realloc(writer->buf, newCap);
+    if (newBuf == NULL) {
+        LOG_ERROR("Write error, cannot grow buffer.");
+        return ERROR;
+    }
+    writer->buf = newBuf;
+    writer->cap = newCap;
+    return OK;
+}
+
+static int avrobinRpc_writeRaw(avrobin_rpc_writer_t *writer, const void *data, size_t len) {
+    if (avrobinRpc_reserve(writer, len) != OK) {
+        return ERROR;
+    }
+    if (len > 0) {
+        memcpy(writer->buf + writer->len, data, len);
+        writer->len += len;
+    }
+    return OK;
+}
+
+static int avrobinRpc_writeLong(avrobin_rpc_writer_t *writer, int64_t val) {
+    if (avrobinRpc_reserve(writer, AVROBIN_RPC_MAX_VARINT_SIZE) != OK) {
+        return ERROR;
+    }
+    //zigzag varint, same as the avrobin serializer
+    uint64_t n = ((uint64_t)val << 1) ^ (uint64_t)(val >> 63);
+    while (n & ~0x7FULL) {
+        writer->buf[writer->len++] = (uint8_t)((n & 0x7F) | 0x80);
+        n >>= 7;
+    }
+    writer->buf[writer->len++] = (uint8_t)n;
+    return OK;
+}
+
+static int avrobinRpc_writeHeader(avrobin_rpc_writer_t *writer, uint8_t kind, uint64_t callId) {
+    uint8_t header[AVROBIN_RPC_HEADER_SIZE] = {AVROBIN_RPC_MAGIC[0], AVROBIN_RPC_MAGIC[1], AVROBIN_RPC_MAGIC[2], AVROBIN_RPC_MAGIC[3], AVROBIN_RPC_VERSION, kind};
+    int status = avrobinRpc_writeRaw(writer, header, sizeof(header));
+    if (status == OK) {
+        status = avrobinRpc_writeLong(writer, (int64_t)callId);
+    }
+    return status;
+}
+
+static int avrobinRpc_writeValue(avrobin_rpc_writer_t *writer, dyn_type *type, const void *value) {
+    size_t valueLen = 0;
+    int status = avrobinSerializer_serializeToBuffer(type, value, &writer->valueBuf, &writer->valueBufSize, &valueLen);
+    if (status == OK) {
+        status = avrobinRpc_writeLong(writer, (int64_t)valueLen);
+    }
+    if (status == OK) {
+        status = avrobinRpc_writeRaw(writer, writer->valueBuf, valueLen);
+    }
+    return status;
+}
+
+static void avrobinRpc_writerDestroy(avrobin_rpc_writer_t *writer) {
+    free(writer->buf);
+    free(writer->valueBuf);
+}
+
+static int avrobinRpc_readLong(avrobin_rpc_reader_t *reader, int64_t *val) {
+    uint64_t n = 0;
+    for (int shift = 0; shift < 64; shift += 7) {
+        if (reader->pos >= reader->len) {
+            return ERROR;
+        }
+        uint8_t b = reader->buf[reader->pos++];
+        n |= (uint64_t)(b & 0x7F) << shift;
+        if ((b & 0x80) == 0) {
+            *val = (int64_t)(n >> 1) ^ -(int64_t)(n & 1);
+            return OK;
+        }
+    }
+    return ERROR;
+}
+
+static int avrobinRpc_readBytes(avrobin_rpc_reader_t *reader, const uint8_t **data, size_t *len) {
+    int64_t n = 0;
+    if (avrobinRpc_readLong(reader, &n) != OK || n < 0 || (uint64_t)n > reader->len - reader->pos) {
+        return ERROR;
+    }
+    *data = reader->buf + reader->pos;
+    *len = (size_t)n;
+    reader->pos += (size_t)n;
+    return OK;
+}
+
+static int avrobinRpc_readHeader(avrobin_rpc_reader_t *reader, uint8_t expectedKind, uint64_t *callId) {
+    if (!avrobinRpc_isMessage(reader->buf, reader->len)) {
+        LOG_ERROR("Missing avrobin rpc header");
+        return ERROR;
+    }
+    if (reader->buf[4] != AVROBIN_RPC_VERSION || reader->buf[5] != expectedKind) {
+        LOG_ERROR("Unsupported avrobin rpc version %i or message kind %i", (int)reader->buf[4], (int)reader->buf[5]);
+        return ERROR;
+    }
+    reader->pos = AVROBIN_RPC_HEADER_SIZE;
+    int64_t id = 0;
+    if (avrobinRpc_readLong(reader, &id) != OK) {
+        return ERROR;
+    }
+    *callId = (uint64_t)id;
+    return OK;
+}
@@ -18,43 +18,63 @@
  */
 #include "avrobin_serializer.h"
 #include "dyn_type_common.h"
+#include "dyn_type_plan.h"
+#include "dfi_codec.h"
 
 #include <stdlib.h>
 #include <string.h>
 #include <assert.h>
+#include <stdint.h>
 #include <jansson.h>
 
 #define MAX_VARINT_BUF_SIZE 10
+#define AVROBIN_INITIAL_BUFFER_SIZE 64
+
+/**
+ * Growable output buffer. The serializer writes directly into the buffer instead of using a (locking) FILE* stream.
+ * Shared with the generated codecs, see dfi_codec.h.
+ */
+typedef dfi_avrobin_writer_t avrobin_writer_t;
+
+/**
+ * Bounds checked input cursor. Shared with the generated codecs, see dfi_codec.h.
+ */
+typedef dfi_avrobin_reader_t avrobin_reader_t;
 
 static int generate_sync(uint8_t **result);
 static int generate_record_name(char **result);
 
-static int avrobin_read_boolean(FILE *stream,bool *val);
-static int avrobin_read_int(FILE *stream,int32_t *val);
-static int avrobin_read_long(FILE *stream,int64_t *val);
-static int avrobin_read_float(FILE *stream,float *val);
-static int avrobin_read_double(FILE *stream,double *val);
-static int avrobin_read_string(FILE *stream,char **val);
-
-static int avrobin_write_boolean(FILE *stream,bool val);
-static int avrobin_write_int(FILE *stream,int32_t val);
-static int avrobin_write_long(FILE *stream,int64_t val);
-static int avrobin_write_float(FILE *stream,float val);
-static int avrobin_write_double(FILE *stream,double val);
-static int avrobin_write_string(FILE *stream,const char *val);
+static int avrobin_read_boolean(avrobin_reader_t *stream,bool *val);
+static int avrobin_read_int(avrobin_reader_t *stream,int32_t *val);
+static int avrobin_read_long(avrobin_reader_t *stream,int64_t *val);
+static int avrobin_read_float(avrobin_reader_t *stream,float *val);
+static int avrobin_read_double(avrobin_reader_t *stream,double *val);
+static int avrobin_read_string(avrobin_reader_t *stream,const char **val, size_t *len);
+static int avrobin_read_reals(avrobin_reader_t *stream, void *buf, size_t count, size_t size);
+
+static int avrobin_write_bytes(avrobin_writer_t *stream, const uint8_t *data, size_t len);
+static int avrobin_write_boolean(avrobin_writer_t *stream,bool val);
+static int avrobin_write_int(avrobin_writer_t *stream,int32_t val);
+static int avrobin_write_long(avrobin_writer_t *stream,int64_t val);
+static int avrobin_write_float(avrobin_writer_t *stream,float val);
+static int avrobin_write_double(avrobin_writer_t *stream,double val);
+static int avrobin_write_string(avrobin_writer_t *stream,const char *val);
+static int avrobin_write_reals(avrobin_writer_t *stream, const void *buf, size_t count, size_t size);
+static int avrobin_write_numbers(avrobin_writer_t *stream, const void *buf, size_t count, int descriptor);
 
 static int avrobin_schema_primitive(const char *tname, json_t **output);
 
-static int avrobinSerializer_createType(dyn_type *type, FILE *stream, void **result);
-static int avrobinSerializer_parseAny(dyn_type *type, void *loc, FILE *stream);
-static int avrobinSerializer_parseComplex(dyn_type *type, void *loc, FILE *stream);
-static int avrobinSerializer_parseSequence(dyn_type *type, void *loc, FILE *stream);
-static int avrobinSerializer_parseEnum(dyn_type *type, void *loc, FILE *stream);
+static int avrobinSerializer_createType(dyn_type *type, avrobin_reader_t *stream, void **result);
+static int avrobinSerializer_parseAny(dyn_type *type, void *loc, avrobin_reader_t *stream);
+static int avrobinSerializer_parseValues(dyn_type *type, void *loc, avrobin_reader_t *stream, size_t *nrOfValues);
+static int avrobinSerializer_parseValue(const dyn_type_plan_step_t *step, void *loc, avrobin_reader_t *stream);
+static int avrobinSerializer_parseSequence(const dyn_type_plan_step_t *step, void *loc, avrobin_reader_t *stream);
+static int avrobinSerializer_parseEnum(dyn_type *type, void *loc, avrobin_reader_t *stream);
 
-static int avrobinSerializer_writeAny(dyn_type *type, void *loc, FILE *stream);
-static int avrobinSerializer_writeComplex(dyn_type *type, void *loc, FILE *stream);
-static int avrobinSerializer_writeSequence(dyn_type *type, void *loc, FILE *stream);
-static int avrobinSerializer_writeEnum(dyn_type *type, void *loc, FILE *stream);
+static int avrobinSerializer_writeAny(dyn_type *type, void *loc, avrobin_writer_t *stream);
+static int avrobinSerializer_writeValue(const dyn_type_plan_step_t *step, void *loc, avrobin_writer_t *stream);
+static int avrobinSerializer_writeSequence(const dyn_type_plan_step_t *step, void *loc, avrobin_writer_t *stream);
+static int avrobinSerializer_writeEnum(dyn_type *type, void *loc, avrobin_writer_t *stream);
 
 static int avrobinSerializer_generateAny(dyn_type *type, json_t **output);
 static int avrobinSerializer_generateComplex(dyn_type *type, json_t **output);
@@ -71,44 +91,99 @@ DFI_SETUP_LOG(avrobinSerializer);
 int avrobinSerializer_deserialize(dyn_type *type, const uint8_t *input, size_t inlen, void **result) {
     int status = OK;
 
-    FILE *stream = fmemopen((void*)input, inlen, "rb");
-
-    if (stream != NULL) {
-        status = avrobinSerializer_createType(type, stream, result);
-
-        fclose(stream);
+    if (input != NULL || inlen == 0) {
+        avrobin_reader_t stream = {.buf = input, .len = inlen, .pos = 0};
+        status = avrobinSerializer_createType(type, &stream, result);
 
         if (status != OK) {
             LOG_ERROR("Error cannot deserialize avrobin.");
         }
     } else {
         status = ERROR;
-        LOG_ERROR("Error initializing memory stream for reading. Length was %d.", inlen);
+        LOG_ERROR("Error invalid input for reading. Length was %zu.", inlen);
     }
 
     return status;
 }
 
-int avrobinSerializer_serialize(dyn_type *type, const void *input, uint8_t **output, size_t *outlen) {
-    int status = OK;
+int avrobinSerializer_deserializeInArena(dyn_type *type, const uint8_t *input, size_t inlen, celix_arena_t *arena, void **result) {
+    if ((input == NULL && inlen != 0) || arena == NULL) {
+        LOG_ERROR("Error invalid input for reading. Length was %zu.", inlen);
+        return ERROR;
+    }
+
+    avrobin_reader_t stream = {.buf = input, .len = inlen, .pos = 0, .arena = arena};
+    int status = avrobinSerializer_createType(type, &stream, result);
+    if (status != OK) {
+        LOG_ERROR("Error cannot deserialize avrobin.");
+    }
+    return status;
+}
+
+int avrobinSerializer_deserializeValues(dyn_type *type, const uint8_t *input, size_t inlen, size_t *nrOfValues, void **result) {
+    if ((input == NULL && inlen != 0) || nrOfValues == NULL) {
+        LOG_ERROR("Error invalid input for reading. Length was %zu.", inlen);
+        return ERROR;
+    }
+
+    void *inst = NULL;
+    int status = dynType_alloc(type, &inst);
+    if (status == OK) {
+        avrobin_reader_t stream = {.buf = input, .len = inlen, .pos = 0};
+        status = avrobinSerializer_parseValues(type, inst, &stream, nrOfValues);
+        if (status == OK) {
+            *result = inst;
+        } else {
+            dynType_free(type, inst);
+            LOG_ERROR("Error cannot deserialize avrobin.");
+        }
+    }
+    return status;
+}
 
-    FILE *stream = open_memstream((char**)output, outlen);
+int avrobinSerializer_serialize(dyn_type *type, const void *input, uint8_t **output, size_t *outlen) {
+    uint8_t *buffer = NULL;
+    size_t bufferSize = 0;
+    int status = avrobinSerializer_serializeToBuffer(type, input, &buffer, &bufferSize, outlen);
+    if (status == OK) {
+        *output = buffer;
+    } else {
+        free(buffer);
+    }
+    return status;
+}
 
-    if (stream != NULL) {
-        status = avrobinSerializer_writeAny(type, (void*)input, stream);
+int avrobinSerializer_serializeToBuffer(dyn_type *type, const void *input, uint8_t **buffer, size_t *bufferSize, size_t *outlen) {
+    int status = OK;
 
-        fclose(stream);
+    avrobin_writer_t stream = {.buf = *buffer, .len = 0, .cap = *buffer == NULL ? 0 : *bufferSize};
+    if (stream.cap == 0) {
+        free(stream.buf);
+        stream.buf = malloc(AVROBIN_INITIAL_BUFFER_SIZE);
+        stream.cap = stream.buf == NULL ? 0 : AVROBIN_INITIAL_BUFFER_SIZE;
+    }
 
-        if (status != OK) {
-            free(*output);
+    if (stream.buf != NULL) {
+        if (type->codec != NULL) {
+            status = type->codec->avrobinWrite(&stream, input);
+        } else {
+            status = avrobinSerializer_writeAny(type, (void*)input, &stream);
+        }
 
+        if (status == OK) {
+            *outlen = stream.len;
+        } else {
             LOG_ERROR("Error cannot serialize avrobin.");
         }
     } else {
         status = ERROR;
-        LOG_ERROR("Error initializing memory stream for writing.");
+        LOG_ERROR("Error allocating buffer for writing.");
     }
 
+    //note also on error, the (possibly grown) buffer is still owned by the caller
+    *buffer = stream.buf;
+    *bufferSize = stream.cap;
+
     return status;
 }
 
@@ -135,105 +210,84 @@ int avrobinSerializer_generateSchema(dyn_type *type, char **output) {
 
 int avrobinSerializer_saveFile(const char *filename, const char *schema, const uint8_t *serdata, size_t serdatalen) {
     int status = OK;
+    static const uint8_t magic[4] = {'O', 'b', 'j', 1};
 
-    FILE *file = fopen(filename, "wb");
+    avrobin_writer_t stream = {.buf = NULL, .len = 0, .cap = 0};
+    uint8_t *sync = NULL;
 
-    if (file != NULL) {
-        if (status == OK) {
-            if (fputc('O', file) == EOF) {
-                status = ERROR;
-            }
-        }
-        if (status == OK) {
-            if (fputc('b', file) == EOF) {
-                status = ERROR;
-            }
-        }
-        if (status == OK) {
-            if (fputc('j', file) == EOF) {
+    status = avrobin_write_bytes(&stream, magic, sizeof(magic));
+    if (status == OK) {
+        status = avrobin_write_long(&stream, 1);
+    }
+    if (status == OK) {
+        status = avrobin_write_string(&stream, "avro.schema");
+    }
+    if (status == OK) {
+        status = avrobin_write_string(&stream, schema);
+    }
+    if (status == OK) {
+        status = avrobin_write_long(&stream, 0);
+    }
+    if (status == OK) {
+        status = generate_sync(&sync);
+    }
+    if (status == OK) {
+        status = avrobin_write_bytes(&stream, sync, 16);
+    }
+    if (status == OK) {
+        status = avrobin_write_long(&stream, 1);
+    }
+    if (status == OK) {
+        status = avrobin_write_long(&stream, (int64_t)serdatalen);
+    }
+    if (status == OK) {
+        status = avrobin_write_bytes(&stream, serdata, serdatalen);
+    }
+    if (status == OK) {
+        status = avrobin_write_bytes(&stream, sync, 16);
+    }
+    free(sync);
+
+    if (status == OK) {
+        FILE *file = fopen(filename, "wb");
+        if (file != NULL) {
+            if (fwrite(stream.buf, 1, stream.len, file) != stream.len) {
                 status = ERROR;
             }
-        }
-        if (status == OK) {
-            if (fputc(1, file) == EOF) {
+            if (fclose(file) != 0) {
                 status = ERROR;
             }
+        } else {
+            status = ERROR;
         }
-        if (status == OK) {
-            status = avrobin_write_long(file, 1);
-        }
-        if (status == OK) {
-            status = avrobin_write_string(file, "avro.schema");
-        }
-        if (status == OK) {
-            status = avrobin_write_string(file, schema);
-        }
-        if (status == OK) {
-            status = avrobin_write_long(file, 0);
-        }
-        if (status == OK) {
-            uint8_t *sync = NULL;
-            status = generate_sync(&sync);
-            if (status == OK) {
-                for (int i=0; i<16; i++) {
-                    if (status == OK) {
-                        if (fputc(sync[i], file) == EOF) {
-                            status = ERROR;
-                        }
-                    }
-                    if (status != OK) break;
-                }
-                if (status == OK) {
-                    status = avrobin_write_long(file, 1);
-                }
-                if (status == OK) {
-                    status = avrobin_write_long(file, serdatalen);
-                }
-                if (status == OK) {
-                    for (int i=0; i<serdatalen; i++) {
-                        if (status == OK) {
-                            if (fputc(serdata[i], file) == EOF) {
-                                status = ERROR;
-                            }
-                        }
-                        if (status != OK) break;
-                    }
-                }
-                for (int i=0; i<16; i++) {
-                    if (status == OK) {
-                        if (fputc(sync[i], file) == EOF) {
-                            status = ERROR;
-                        }
-                    }
-                    if (status != OK) break;
-                }
-
-                free(sync);
-            }
-        }
-
-        fclose(file);
-    } else {
-        status = ERROR;
     }
+    free(stream.buf);
 
     return status;
 }
 
-static int avrobinSerializer_createType(dyn_type *type, FILE *stream, void **result) {
+static int avrobinSerializer_createType(dyn_type *type, avrobin_reader_t *stream, void **result) {
     int status = OK;
     void *inst = NULL;
 
-    status = dynType_alloc(type, &inst);
+    if (stream->arena != NULL) {
+        status = dynType_allocInArena(type, stream->arena, &inst);
+    } else {
+        status = dynType_alloc(type, &inst);
+    }
 
     if (status == OK) {
         assert(inst != NULL);
-        status = avrobinSerializer_parseAny(type, inst, stream);
+        //note the generated code allocates from the heap, so arena based deserialization uses the dynamic path
+        if (type->codec != NULL && stream->arena == NULL) {
+            status = type->codec->avrobinRead(stream, inst);
+        } else {
+            status = avrobinSerializer_parseAny(type, inst, stream);
+        }
 
         if (status == OK) {
             *result = inst;
-        }
-        else {
+        } else if (stream->arena == NULL) {
             dynType_free(type, inst);
         }
     }
@@ -241,11 +295,61 @@ static int avrobinSerializer_createType(dyn_type *type, FILE *stream, void **res
     return status;
 }
 
-static int avrobinSerializer_parseAny(dyn_type *type, void *loc, FILE *stream) {
+static int avrobinSerializer_parseAny(dyn_type *type, void *loc, avrobin_reader_t *stream) {
+    const dyn_type_plan *plan = dynType_plan(type);
+    if (plan == NULL) {
+        LOG_ERROR("Error cannot create plan for type.");
+        return ERROR;
+    }
+
     int status = OK;
+    const dyn_type_plan_step_t *steps = dynTypePlan_steps(plan);
+    size_t nrOfSteps = dynTypePlan_nrOfSteps(plan);
+    for (size_t i = 0; status == OK && i < nrOfSteps; ++i) {
+        //note avro records are the concatenation of their fields, so the begin/end complex steps can be ignored
+        if (steps[i].kind == DYN_TYPE_PLAN_VALUE) {
+            status = avrobinSerializer_parseValue(&steps[i], (char*)loc + steps[i].offset, stream);
+        }
+    }
+    return status;
+}
 
-    dyn_type *subType = NULL;
-    char c = dynType_descriptorType(type);
+static int avrobinSerializer_parseValues(dyn_type *type, void *loc, avrobin_reader_t *stream, size_t *nrOfValues) {
+    const dyn_type_plan *plan = dynType_plan(type);
+    if (plan == NULL) {
+        LOG_ERROR("Error cannot create plan for type.");
+        return ERROR;
+    }
+
+    int status = OK;
+    bool resolve = *nrOfValues == 0;
+    size_t count = 0;
+    const dyn_type_plan_step_t *steps = dynTypePlan_steps(plan);
+    size_t nrOfSteps = dynTypePlan_nrOfSteps(plan);
+    for (size_t i = 0; status == OK && i < nrOfSteps; ++i) {
+        if (steps[i].kind != DYN_TYPE_PLAN_VALUE) {
+            continue;
+        }
+        if (resolve ? stream->pos >= stream->len : count == *nrOfValues) {
+            break;
+        }
+        status = avrobinSerializer_parseValue(&steps[i], (char*)loc + steps[i].offset, stream);
+        count += 1;
+    }
+
+    if (status == OK && !resolve && count != *nrOfValues) {
+        LOG_ERROR("Error expected %zu values, but type only has %zu values.", *nrOfValues, count);
+        status = ERROR;
+    } else if (status == OK) {
+        *nrOfValues = count;
+    }
+    return status;
+}
+
+static int avrobinSerializer_parseValue(const dyn_type_plan_step_t *step, void *loc, avrobin_reader_t *stream) {
+    int status = OK;
+
+    char c = (char)step->descriptor;
 
     bool *z;            //Z
     float *f;           //F
@@ -265,7 +369,9 @@ static int avrobinSerializer_parseAny(dyn_type *type, void *loc, FILE *stream) {
     int64_t avro_long;
     float avro_float;
     double avro_double;
-    char *avro_string;
+    const char *avro_string;
+    size_t avro_string_len;
+    char *text;
 
     switch (c) {
         case 'Z' :
@@ -353,32 +459,34 @@ static int avrobinSerializer_parseAny(dyn_type *type, void *loc, FILE *stream) {
             }
             break;
         case 't' :
-            status = avrobin_read_string(stream,&avro_string);
-            if (status == OK) {
-                status = dynType_text_allocAndInit(type, loc, avro_string);
-                free(avro_string);
+            status = avrobin_read_string(stream,&avro_string,&avro_string_len);
+            if (status == OK && stream->arena != NULL) {
+                status = dynType_text_initInArena(step->type, loc, avro_string, avro_string_len, stream->arena);
+            } else if (status == OK) {
+                text = malloc(avro_string_len + 1);
+                if (text != NULL) {
+                    memcpy(text, avro_string, avro_string_len);
+                    text[avro_string_len] = '\0';
+                    *(char**)loc = text;
+                } else {
+                    status = ERROR;
+                    LOG_ERROR("Failed to allocate memory for avro string.");
+                }
             }
             break;
         case '[' :
-            if (status == OK) {
-                status = avrobinSerializer_parseSequence(type, loc, stream);
-            }
-            break;
-        case '{' :
-            if (status == OK) {
-                status = avrobinSerializer_parseComplex(type, loc, stream);
-            }
+            status = avrobinSerializer_parseSequence(step, loc, stream);
             break;
         case '*' :
-            status = dynType_typedPointer_getTypedType(type, &subType);
-            if (status == OK) {
-                status = avrobinSerializer_createType(subType, stream, (void**)loc);
+            if (*(void**)loc != NULL) {
+                //note already allocated by dynType_alloc of the parent
+                status = avrobinSerializer_parseAny(step->subType, *(void**)loc, stream);
+            } else {
+                status = avrobinSerializer_createType(step->subType, stream, (void**)loc);
             }
             break;
         case 'E' :
-            if (status == OK) {
-                status = avrobinSerializer_parseEnum(type, loc, stream);
-            }
+            status = avrobinSerializer_parseEnum(step->type, loc, stream);
             break;
         case 'P' :
             status = ERROR;
@@ -386,149 +494,99 @@ static int avrobinSerializer_parseAny(dyn_type *type, void *loc, FILE *stream) {
             break;
         default :
             status = ERROR;
-            LOG_ERROR("Error provided type '%c' not supported for AVRO.", dynType_descriptorType(type));
+            LOG_ERROR("Error provided type '%c' not supported for AVRO.", c);
             break;
     }
 
     return status;
 }
 
-static int avrobinSerializer_parseComplex(dyn_type *type, void *loc, FILE *stream) {
-    int status = OK;
-
-    struct complex_type_entry *entry = NULL;
-    struct complex_type_entries_head *entries = NULL;
-    dyn_type *subType = NULL;
-    void *subLoc = NULL;
-    int index = -1;
-
-    status = dynType_complex_entries(type, &entries);
-
-    if (status == OK) {
-        TAILQ_FOREACH(entry, entries, entries) {
-            index = dynType_complex_indexForName(type, entry->name);
-
-            if (index < 0) {
-                status = ERROR;
-                LOG_ERROR("Cannot find index for member '%s'.", entry->name);
-            }
-
-            if (status == OK) {
-                status = dynType_complex_dynTypeAt(type, index, &subType);
-            }
-
-            if (status == OK) {
-                status = dynType_complex_valLocAt(type, index, loc, &subLoc);
-            }
-
-            if (status == OK) {
-                status = avrobinSerializer_parseAny(subType, subLoc, stream);
-            }
-
-            if (status != OK) {
-                break;
-            }
-        }
-    }
-
-    return status;
-}
-
-static int avrobinSerializer_parseSequence(dyn_type *type, void *loc, FILE *stream) {
+static int avrobinSerializer_parseSequence(const dyn_type_plan_step_t *step, void *loc, avrobin_reader_t *stream) {
+    struct generic_sequence *seq = loc;
     int64_t blockCount;
     int64_t blockSize;
-    int64_t totalCount = 0;
-
-    dyn_type *itemType = dynType_sequence_itemType(type);
-
-    void *itemLoc = NULL;
-    if (dynType_alloc(itemType, &itemLoc) != OK) {
-        return ERROR;
-    }
-
-    fpos_t streamPos;
-    if (fgetpos(stream, &streamPos) != 0) {
-        LOG_ERROR("Failed to get position of stream.");
-        return ERROR;
-    }
+    bool allocated = false;
+    int number = dynType_primitiveNumber(step->subType);
+    const dyn_type_plan_step_t *numberStep = number != 0 ? dynTypePlan_steps(dynType_plan(step->subType)) : NULL;
 
     if (avrobin_read_long(stream, &blockCount) != OK) {
         LOG_ERROR("Failed to read array block count.");
-        dynType_free(itemType, itemLoc);
         return ERROR;
     }
 
-    while (blockCount != 0) {
+    do {
         if (blockCount < 0) {
             if (avrobin_read_long(stream, &blockSize) != OK) {
                 LOG_ERROR("Failed to read array block size.");
-                dynType_free(itemType, itemLoc);
                 return ERROR;
             }
             blockCount *= -1;
         }
 
-        totalCount += blockCount;
-
-        for (int64_t i=0; i<blockCount; i++) {
-            if (avrobinSerializer_parseAny(itemType, itemLoc, stream) != OK) {
-                dynType_free(itemType, itemLoc);
-                return ERROR;
-            }
-        }
-
-        if (avrobin_read_long(stream, &blockCount) != OK) {
-            LOG_ERROR("Failed to read array block count.");
-            dynType_free(itemType, itemLoc);
+        //note every item uses at least one byte, so a larger count is invalid input
+        if (blockCount > (int64_t)(stream->len - stream->pos) || blockCount > (int64_t)(UINT32_MAX - seq->len)) {
+            LOG_ERROR("Invalid array block count %lli.", (long long)blockCount);
             return ERROR;
         }
-    }
-
-    dynType_free(itemType, itemLoc);
 
-    if (fsetpos(stream, &streamPos) != 0) {
-        LOG_ERROR("Failed to set position of stream.");
-        return ERROR;
-    }
-
-    if (dynType_sequence_alloc(type, loc, (uint32_t)totalCount) != OK) {
-        LOG_ERROR("Failed to allocate memory for array.");
-        return ERROR;
-    }
-
-    if (avrobin_read_long(stream, &blockCount) != OK) {
-        LOG_ERROR("Failed to read array block count.");
-        return ERROR;
-    }
-
-    while (blockCount != 0) {
-        if (blockCount < 0) {
-            if (avrobin_read_long(stream, &blockSize) != OK) {
-                LOG_ERROR("Failed to read array block size.");
+        if (!allocated) {
+            //first block, allocate exactly for the first block (normally the only block)
+            int rc = stream->arena != NULL ?
+                     dynType_sequence_allocInArena(step->type, loc, (uint32_t)blockCount, stream->arena) :
+                     dynType_sequence_alloc(step->type, loc, (uint32_t)blockCount);
+            if (rc != OK) {
+                LOG_ERROR("Failed to allocate memory for array.");
                 return ERROR;
             }
-            blockCount *= -1;
+            allocated = true;
+        } else if (seq->len + blockCount > seq->cap) {
+            uint32_t newCap = seq->len + (uint32_t)blockCount;
+            char *newBuf;
+            if (stream->arena != NULL) {
+                newBuf = celix_arena_malloc(stream->arena, newCap * step->subTypeSize);
+                if (newBuf != NULL) {
+                    memcpy(newBuf, seq->buf, seq->cap * step->subTypeSize);
+                }
+            } else {
+                newBuf = realloc(seq->buf, newCap * step->subTypeSize);
+            }
+            if (newBuf == NULL) {
+                LOG_ERROR("Failed to allocate memory for array.");
+                return ERROR;
+            }
+            memset(newBuf + seq->cap * step->subTypeSize, 0, (newCap - seq->cap) * step->subTypeSize);
+            seq->buf = newBuf;
+            seq->cap = newCap;
         }
 
-        for (int64_t i=0; i<blockCount; i++) {
-            if (dynType_sequence_increaseLengthAndReturnLastLoc(type, loc, &itemLoc) != OK) {
+        if (number == 'D' || number == 'F') {
+            if (avrobin_read_reals(stream, (char*)seq->buf + seq->len * step->subTypeSize, (size_t)blockCount, step->subTypeSize) != OK) {
                 return ERROR;
             }
-            if (avrobinSerializer_parseAny(itemType, itemLoc, stream) != OK) {
-                return ERROR;
+            seq->len += (uint32_t)blockCount;
+        } else {
+            for (int64_t i=0; i<blockCount; i++) {
+                void *itemLoc = (char*)seq->buf + seq->len * step->subTypeSize;
+                seq->len += 1; //note the item is part of the sequence (and freed with it) also if parsing fails
+                int rc = numberStep != NULL ?
+                         avrobinSerializer_parseValue(numberStep, itemLoc, stream) :
+                         avrobinSerializer_parseAny(step->subType, itemLoc, stream);
+                if (rc != OK) {
+                    return ERROR;
+                }
             }
         }
 
-        if (avrobin_read_long(stream, &blockCount) != OK) {
+        if (blockCount != 0 && avrobin_read_long(stream, &blockCount) != OK) {
             LOG_ERROR("Failed to read array block count.");
             return ERROR;
         }
-    }
+    } while (blockCount != 0);
 
     return OK;
 }
 
-static int avrobinSerializer_parseEnum(dyn_type *type, void *loc, FILE *stream) {
+static int avrobinSerializer_parseEnum(dyn_type *type, void *loc, avrobin_reader_t *stream) {
     int32_t index;
     if (avrobin_read_int(stream, &index) != OK) {
         return ERROR;
@@ -551,11 +609,29 @@ static int avrobinSerializer_parseEnum(dyn_type *type, void *loc, FILE *stream)
     return ERROR;
 }
 
-static int avrobinSerializer_writeAny(dyn_type *type, void *loc, FILE *stream) {
+static int avrobinSerializer_writeAny(dyn_type *type, void *loc, avrobin_writer_t *stream) {
+    const dyn_type_plan *plan = dynType_plan(type);
+    if (plan == NULL) {
+        LOG_ERROR("Error cannot create plan for type.");
+        return ERROR;
+    }
+
+    int status = OK;
+    const dyn_type_plan_step_t *steps = dynTypePlan_steps(plan);
+    size_t nrOfSteps = dynTypePlan_nrOfSteps(plan);
+    for (size_t i = 0; status == OK && i < nrOfSteps; ++i) {
+        //note avro records are the concatenation of their fields, so the begin/end complex steps can be ignored
+        if (steps[i].kind == DYN_TYPE_PLAN_VALUE) {
+            status = avrobinSerializer_writeValue(&steps[i], (char*)loc + steps[i].offset, stream);
+        }
+    }
+    return status;
+}
+
+static int avrobinSerializer_writeValue(const dyn_type_plan_step_t *step, void *loc, avrobin_writer_t *stream) {
     int status = OK;
 
-    int descriptor = dynType_descriptorType(type);
-    dyn_type *subType = NULL;
+    int descriptor = step->descriptor;
 
     bool *z;            //Z
     float *f;           //F
@@ -623,19 +699,13 @@ static int avrobinSerializer_writeAny(dyn_type *type, void *loc, FILE *stream) {
             status = avrobin_write_string(stream,*(const char**)loc);
             break;
         case '*' :
-            status = dynType_typedPointer_getTypedType(type, &subType);
-            if (status == OK) {
-                status = avrobinSerializer_writeAny(subType, *(void**)loc, stream);
-            }
-            break;
-        case '{' :
-            status = avrobinSerializer_writeComplex(type, loc, stream);
+            status = avrobinSerializer_writeAny(step->subType, *(void**)loc, stream);
             break;
         case '[' :
-            status = avrobinSerializer_writeSequence(type, loc, stream);
+            status = avrobinSerializer_writeSequence(step, loc, stream);
             break;
         case 'E' :
-            status = avrobinSerializer_writeEnum(type, loc, stream);
+            status = avrobinSerializer_writeEnum(step->type, loc, stream);
             break;
         case 'P' :
             status = ERROR;
@@ -650,68 +720,34 @@ static int avrobinSerializer_writeAny(dyn_type *type, void *loc, FILE *stream) {
     return status;
 }
 
-static int avrobinSerializer_writeComplex(dyn_type *type, void *loc, FILE *stream) {
-    int status = OK;
-
-    struct complex_type_entry *entry = NULL;
-    struct complex_type_entries_head *entries = NULL;
-    dyn_type *subType = NULL;
-    void *subLoc = NULL;
-    int index = -1;
-
-    status = dynType_complex_entries(type, &entries);
-
-    if (status == OK) {
-        TAILQ_FOREACH(entry, entries, entries) {
-            index = dynType_complex_indexForName(type, entry->name);
-
-            if (index < 0) {
-                status = ERROR;
-                LOG_ERROR("Cannot find index for member '%s'.", entry->name);
-            }
-
-            if (status == OK) {
-                status = dynType_complex_dynTypeAt(type, index, &subType);
-            }
-
-            if (status == OK) {
-                status = dynType_complex_valLocAt(type, index, loc, &subLoc);
-            }
-
-            if (status == OK) {
-                status = avrobinSerializer_writeAny(subType, subLoc, stream);
-            }
-
-            if (status != OK) {
-                break;
-            }
-        }
-    }
-
-    return status;
-}
-
-static int avrobinSerializer_writeSequence(dyn_type *type, void *loc, FILE *stream) {
-    uint32_t arrayLen = dynType_sequence_length(loc);
-
-    dyn_type *itemType = dynType_sequence_itemType(type);
-    void *itemLoc = NULL;
+static int avrobinSerializer_writeSequence(const dyn_type_plan_step_t *step, void *loc, avrobin_writer_t *stream) {
+    struct generic_sequence *seq = loc;
+    uint32_t arrayLen = seq->len;
 
     if (avrobin_write_long(stream, arrayLen) != OK) {
         LOG_ERROR("Failed to write array block count.");
         return ERROR;
     }
 
-    for (int i=0; i<arrayLen; i++) {
-        if (dynType_sequence_locForIndex(type, loc, i, &itemLoc)) {
+    int number = arrayLen > 0 ? dynType_primitiveNumber(step->subType) : 0;
+    if (number == 'D' || number == 'F') {
+        if (avrobin_write_reals(stream, seq->buf, arrayLen, step->subTypeSize) != OK) {
             return ERROR;
         }
-        if (avrobinSerializer_writeAny(itemType, itemLoc, stream) != OK) {
+    } else if (number != 0) {
+        if (avrobin_write_numbers(stream, seq->buf, arrayLen, number) != OK) {
             return ERROR;
         }
+    } else {
+        for (uint32_t i=0; i<arrayLen; i++) {
+            void *itemLoc = (char*)seq->buf + i * step->subTypeSize;
+            if (avrobinSerializer_writeAny(step->subType, itemLoc, stream) != OK) {
+                return ERROR;
+            }
+        }
     }
 
-    if (avrobin_write_long(stream, 0) != OK) {
+    if (arrayLen > 0 && avrobin_write_long(stream, 0) != OK) {
         LOG_ERROR("Failed to write array block count.");
         return ERROR;
     }
@@ -719,7 +755,7 @@ static int avrobinSerializer_writeSequence(dyn_type *type, void *loc, FILE *stre
     return OK;
 }
 
-static int avrobinSerializer_writeEnum(dyn_type *type, void *loc, FILE *stream) {
+static int avrobinSerializer_writeEnum(dyn_type *type, void *loc, avrobin_writer_t *stream) {
     char enum_value_str[16];
     if (sprintf(enum_value_str, "%d", *(int32_t*)loc) < 0) {
         return ERROR;
@@ -1146,25 +1182,21 @@ static int generate_record_name(char **result) {
     return OK;
 }
 
-static int avrobin_read_boolean(FILE *stream,bool *val) {
-    int c = fgetc(stream);
-    if (c == EOF) {
+static int avrobin_read_boolean(avrobin_reader_t *stream,bool *val) {
+    if (stream->pos >= stream->len) {
         LOG_ERROR("Unexpected end of file.");
         return ERROR;
     }
+    uint8_t c = stream->buf[stream->pos++];
     if (c!=0 && c!=1) {
         LOG_ERROR("Unexpected value for boolean.");
         return ERROR;
     }
-    if (c == 0) {
-        *val = false;
-    } else {
-        *val = true;
-    }
+    *val = c == 1;
     return OK;
 }
 
-static int avrobin_read_int(FILE *stream,int32_t *val) {
+static inline int avrobin_read_int(avrobin_reader_t *stream,int32_t *val) {
     int64_t lval;
     int status = avrobin_read_long(stream,&lval);
     //TODO Do range check.
@@ -1172,41 +1204,38 @@ static int avrobin_read_int(FILE *stream,int32_t *val) {
     return status;
 }
 
-static int avrobin_read_long(FILE *stream,int64_t *val) {
+static inline int avrobin_read_long(avrobin_reader_t *stream,int64_t *val) {
     uint64_t uval = 0;
     uint8_t b;
-    int c;
     int offset = 0;
+    const uint8_t *buf = stream->buf;
+    size_t pos = stream->pos;
     do {
         if (offset == MAX_VARINT_BUF_SIZE) {
             LOG_ERROR("Varint too long.");
             return ERROR;
         }
-        c = fgetc(stream);
-        if (c == EOF) {
+        if (pos >= stream->len) {
             LOG_ERROR("Unexpected end of file.");
             return ERROR;
         }
-        b = (uint8_t)c;
+        b = buf[pos++];
         uval |= (uint64_t) (b & 0x7F) << (7 * offset);
         ++offset;
     }
     while (b & 0x80);
+    stream->pos = pos;
     *val = ((uval >> 1) ^ -(uval & 1));
     return OK;
 }
 
-static int avrobin_read_float(FILE *stream,float *val) {
-    uint8_t b[4];
-    int c;
-    for (int i=0;i<4;i++) {
-        c = fgetc(stream);
-        if (c == EOF) {
-            LOG_ERROR("Unexpected end of file.");
-            return ERROR;
-        }
-        b[i] = (uint8_t)c;
+static int avrobin_read_float(avrobin_reader_t *stream,float *val) {
+    if (stream->len - stream->pos < 4) {
+        LOG_ERROR("Unexpected end of file.");
+        return ERROR;
     }
+    const uint8_t *b = stream->buf + stream->pos;
+    stream->pos += 4;
     union {
         float f;
         uint32_t i;
@@ -1220,17 +1249,13 @@ static int avrobin_read_float(FILE *stream,float *val) {
     return OK;
 }
 
-static int avrobin_read_double(FILE *stream,double *val) {
-    uint8_t b[8];
-    int c;
-    for (int i=0;i<8;i++) {
-        c = fgetc(stream);
-        if (c == EOF) {
-            LOG_ERROR("Unexpected end of file.");
-            return ERROR;
-        }
-        b[i] = (uint8_t)c;
+static int avrobin_read_double(avrobin_reader_t *stream,double *val) {
+    if (stream->len - stream->pos < 8) {
+        LOG_ERROR("Unexpected end of file.");
+        return ERROR;
     }
+    const uint8_t *b = stream->buf + stream->pos;
+    stream->pos += 8;
     union {
         double d;
         uint64_t i;
@@ -1248,7 +1273,35 @@ static int avrobin_read_double(FILE *stream,double *val) {
     return OK;
 }
 
-static int avrobin_read_string(FILE *stream,char **val) {
+/**
+ * Reads count doubles (size 8) or floats (size 4) into buf.
+ */
+static int avrobin_read_reals(avrobin_reader_t *stream, void *buf, size_t count, size_t size) {
+    if ((stream->len - stream->pos) / size < count) {
+        LOG_ERROR("Unexpected end of file.");
+        return ERROR;
+    }
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+    if (count > 0) {
+        memcpy(buf, stream->buf + stream->pos, count * size);
+        stream->pos += count * size;
+    }
+    return OK;
+#else
+    int status = OK;
+    for (size_t i = 0; status == OK && i < count; ++i) {
+        status = size == sizeof(double) ?
+                 avrobin_read_double(stream, &((double*)buf)[i]) :
+                 avrobin_read_float(stream, &((float*)buf)[i]);
+    }
+    return status;
+#endif
+}
+
+/**
+ * Reads a string without copying it; val points into the input and is not NUL terminated.
+ */
+static int avrobin_read_string(avrobin_reader_t *stream,const char **val, size_t *outLen) {
     int64_t len;
     if (avrobin_read_long(stream,&len) != OK) {
         LOG_ERROR("Failed to read string length.");
@@ -1258,64 +1311,141 @@ static int avrobin_read_string(FILE *stream,char **val) {
         LOG_ERROR("Negative string length.");
         return ERROR;
     }
-    *val = (char*)malloc(sizeof(char) * (len+1));
-    if (*val == NULL) {
-        LOG_ERROR("Failed to allocate memory for avro string.");
+    if ((uint64_t)len > stream->len - stream->pos) {
+        LOG_ERROR("Unexpected end of file.");
         return ERROR;
     }
-    int c;
-    for (int64_t i=0;i<len;i++) {
-        c = fgetc(stream);
-        if (c == EOF) {
-            LOG_ERROR("Unexpected end of file.");
-            free(*val);
+    *val = (const char*)stream->buf + stream->pos;
+    *outLen = (size_t)len;
+    stream->pos += (size_t)len;
+    return OK;
+}
+
+/**
+ * Ensures that at least extra bytes can be written to the buffer.
+ */
+static inline int avrobin_reserve(avrobin_writer_t *stream, size_t extra) {
+    if (stream->cap - stream->len >= extra) {
+        return OK;
+    }
+    size_t newCap = stream->cap == 0 ? AVROBIN_INITIAL_BUFFER_SIZE : stream->cap;
+    while (newCap - stream->len < extra) {
+        if (newCap > SIZE_MAX / 2) {
+            LOG_ERROR("Write error, buffer too large.");
             return ERROR;
         }
-        (*val)[i] = (char)c;
+        newCap *= 2;
+    }
+    uint8_t *newBuf = realloc(stream->buf, newCap);
+    if (newBuf == NULL) {
+        LOG_ERROR("Write error, cannot grow buffer.");
+        return ERROR;
     }
-    (*val)[len] = '\0';
+    stream->buf = newBuf;
+    stream->cap = newCap;
     return OK;
 }
 
-static int avrobin_write_boolean(FILE *stream,bool val) {
-    int r;
-    if (val) {
-        r = fputc(1, stream);
-    } else {
-        r = fputc(0, stream);
+static int avrobin_write_bytes(avrobin_writer_t *stream, const uint8_t *data, size_t len) {
+    if (avrobin_reserve(stream, len) != OK) {
+        return ERROR;
     }
-    if (r == EOF) {
-        LOG_ERROR("Write error.");
+    if (len > 0) {
+        memcpy(stream->buf + stream->len, data, len);
+        stream->len += len;
+    }
+    return OK;
+}
+
+static int avrobin_write_boolean(avrobin_writer_t *stream,bool val) {
+    if (avrobin_reserve(stream, 1) != OK) {
         return ERROR;
     }
+    stream->buf[stream->len++] = val ? 1 : 0;
     return OK;
 }
 
-static int avrobin_write_int(FILE *stream,int32_t val) {
+static inline int avrobin_write_int(avrobin_writer_t *stream,int32_t val) {
     int64_t lval = val;
     return avrobin_write_long(stream,lval);
 }
 
-static int avrobin_write_long(FILE *stream,int64_t val) {
-    uint64_t uval = (val << 1) ^ (val >> 63);
-    uint8_t b[MAX_VARINT_BUF_SIZE];
-    int bytes_written = 0;
-    while (uval & ~0x7F) {
+/**
+ * Writes the zigzag varint encoding of val to b, which must have room for MAX_VARINT_BUF_SIZE bytes.
+ */
+static inline size_t avrobin_encode_long(uint8_t *b, int64_t val) {
+    uint64_t uval = ((uint64_t)val << 1) ^ (uint64_t)(val >> 63);
+    size_t bytes_written = 0;
+    while (uval & ~0x7FULL) {
         b[bytes_written++] = (uint8_t)((uval & 0x7F) | 0x80);
         uval >>= 7;
     }
     b[bytes_written++] = (uint8_t)uval;
-    for (int i=0;i<bytes_written;i++) {
-        if (fputc(b[i],stream) == EOF) {
-            LOG_ERROR("Write error.");
+    return bytes_written;
+}
+
+static inline int avrobin_write_long(avrobin_writer_t *stream,int64_t val) {
+    if (avrobin_reserve(stream, MAX_VARINT_BUF_SIZE) != OK) {
+        return ERROR;
+    }
+    stream->len += avrobin_encode_long(stream->buf + stream->len, val);
+    return OK;
+}
+
+#define AVROBIN_ENCODE_NUMBERS(ctype, b, buf, count) \
+    for (size_t idx = 0; idx < (count); ++idx) { \
+        (b) += avrobin_encode_long((b), (int64_t)((const ctype*)(buf))[idx]); \
+    }
+
+/**
+ * Writes count integer numbers of the provided descriptor type, with a single buffer reservation.
+ */
+static int avrobin_write_numbers(avrobin_writer_t *stream, const void *buf, size_t count, int descriptor) {
+    if (avrobin_reserve(stream, count * MAX_VARINT_BUF_SIZE) != OK) {
+        return ERROR;
+    }
+    uint8_t *b = stream->buf + stream->len;
+    switch (descriptor) {
+        case 'B' : AVROBIN_ENCODE_NUMBERS(char, b, buf, count); break;
+        case 'S' : AVROBIN_ENCODE_NUMBERS(int16_t, b, buf, count); break;
+        case 'I' : AVROBIN_ENCODE_NUMBERS(int32_t, b, buf, count); break;
+        case 'J' : AVROBIN_ENCODE_NUMBERS(int64_t, b, buf, count); break;
+        case 'N' : AVROBIN_ENCODE_NUMBERS(int, b, buf, count); break;
+        case 'b' : AVROBIN_ENCODE_NUMBERS(uint8_t, b, buf, count); break;
+        case 's' : AVROBIN_ENCODE_NUMBERS(uint16_t, b, buf, count); break;
+        case 'i' : AVROBIN_ENCODE_NUMBERS(int32_t, b, buf, count); break; //note same as writeValue: written as avro int
+        case 'j' : AVROBIN_ENCODE_NUMBERS(int64_t, b, buf, count); break;
+        default :
+            LOG_ERROR("Unsupported number type '%c'.", descriptor);
             return ERROR;
-        }
     }
+    stream->len = (size_t)(b - stream->buf);
     return OK;
 }
 
-static int avrobin_write_float(FILE *stream,float val) {
-    uint8_t b[4];
+/**
+ * Writes count doubles (size 8) or floats (size 4).
+ */
+static int avrobin_write_reals(avrobin_writer_t *stream, const void *buf, size_t count, size_t size) {
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+    //note avro floats and doubles are little endian IEEE 754, which is the in memory representation
+    return avrobin_write_bytes(stream, buf, count * size);
+#else
+    int status = OK;
+    for (size_t i = 0; status == OK && i < count; ++i) {
+        status = size == sizeof(double) ?
+                 avrobin_write_double(stream, ((const double*)buf)[i]) :
+                 avrobin_write_float(stream, ((const float*)buf)[i]);
+    }
+    return status;
+#endif
+}
+
+static int avrobin_write_float(avrobin_writer_t *stream,float val) {
+    if (avrobin_reserve(stream, 4) != OK) {
+        return ERROR;
+    }
+    uint8_t *b = stream->buf + stream->len;
     union {
         float f;
         uint32_t i;
@@ -1325,17 +1455,15 @@ static int avrobin_write_float(FILE *stream,float val) {
     b[1] = (uint8_t)((v.i & 0x0000FF00) >> 8);
     b[2] = (uint8_t)((v.i & 0x00FF0000) >> 16);
     b[3] = (uint8_t)((v.i & 0xFF000000) >> 24);
-    for (int i=0;i<4;i++) {
-        if (fputc(b[i],stream) == EOF) {
-            LOG_ERROR("Write error.");
-            return ERROR;
-        }
-    }
+    stream->len += 4;
     return OK;
 }
 
-static int avrobin_write_double(FILE *stream,double val) {
-    uint8_t b[8];
+static int avrobin_write_double(avrobin_writer_t *stream,double val) {
+    if (avrobin_reserve(stream, 8) != OK) {
+        return ERROR;
+    }
+    uint8_t *b = stream->buf + stream->len;
     union {
         double d;
         uint64_t i;
@@ -1349,29 +1477,18 @@ static int avrobin_write_double(FILE *stream,double val) {
     b[5] = (uint8_t)((v.i & 0x0000FF0000000000) >> 40);
     b[6] = (uint8_t)((v.i & 0x00FF000000000000) >> 48);
     b[7] = (uint8_t)((v.i & 0xFF00000000000000) >> 56);
-    for (int i=0;i<8;i++) {
-        if (fputc(b[i],stream) == EOF) {
-            LOG_ERROR("Write error.");
-            return ERROR;
-        }
-    }
+    stream->len += 8;
     return OK;
 }
 
-static int avrobin_write_string(FILE *stream,const char *val) {
+static int avrobin_write_string(avrobin_writer_t *stream,const char *val) {
     assert(val != NULL);
     size_t len = strlen(val);
     if (avrobin_write_long(stream, (int64_t)len) != OK) {
         LOG_ERROR("Failed to write string length.");
         return ERROR;
     }
-    for (size_t i=0;i<len;i++) {
-        if (fputc((unsigned char)(val[i]),stream) == EOF) {
-            LOG_ERROR("Write error.");
-            return ERROR;
-        }
-    }
-    return OK;
+    return avrobin_write_bytes(stream, (const uint8_t*)val, len);
 }
 
 static int avrobin_schema_primitive(const char *tname, json_t **output) {
@@ -1392,3 +1509,77 @@ static int avrobin_schema_primitive(const char *tname, json_t **output) {
     *output = jo;
     return OK;
 }
+
+int dfiAvrobin_writeValue(dfi_avrobin_writer_t *writer, char descriptor, const void *loc) {
+    if (descriptor == 't' && *(const char**)loc == NULL) {
+        LOG_ERROR("Cannot write NULL string.");
+        return ERROR;
+    }
+    dyn_type_plan_step_t step = {.kind = DYN_TYPE_PLAN_VALUE, .descriptor = descriptor};
+    return avrobinSerializer_writeValue(&step, (void*)loc, writer);
+}
+
+int dfiAvrobin_writeEnum(dfi_avrobin_writer_t *writer, const int32_t values[], size_t count, int32_t value) {
+    for (size_t i = 0; i < count; ++i) {
+        if (values[i] == value) {
+            return avrobin_write_int(writer, (int32_t)i);
+        }
+    }
+    LOG_ERROR("Could not find Enum value %d in enum type.", value);
+    return ERROR;
+}
+
+int dfiAvrobin_writeLong(dfi_avrobin_writer_t *writer, int64_t value) {
+    return avrobin_write_long(writer, value);
+}
+
+int dfiAvrobin_readValue(dfi_avrobin_reader_t *reader, char descriptor, void *loc) {
+    dyn_type_plan_step_t step = {.kind = DYN_TYPE_PLAN_VALUE, .descriptor = descriptor};
+    return avrobinSerializer_parseValue(&step, loc, reader);
+}
+
+int dfiAvrobin_readEnum(dfi_avrobin_reader_t *reader, const int32_t values[], size_t count, int32_t *value) {
+    int32_t index;
+    if (avrobin_read_int(reader, &index) != OK || index < 0 || (size_t)index >= count) {
+        return ERROR;
+    }
+    *value = values[index];
+    return OK;
+}
+
+int dfiAvrobin_readBlock(dfi_avrobin_reader_t *reader, void *seqLoc, size_t itemSize, uint32_t *count) {
+    struct generic_sequence *seq = seqLoc;
+    int64_t blockCount;
+    int64_t blockSize;
+
+    if (avrobin_read_long(reader, &blockCount) != OK) {
+        LOG_ERROR("Failed to read array block count.");
+        return ERROR;
+    }
+    if (blockCount < 0) {
+        if (avrobin_read_long(reader, &blockSize) != OK) {
+            LOG_ERROR("Failed to read array block size.");
+            return ERROR;
+        }
+        blockCount *= -1;
+    }
+    //note every item uses at least one byte, so a larger count is invalid input
+    if (blockCount > (int64_t)(reader->len - reader->pos) || blockCount > (int64_t)(UINT32_MAX - seq->len)) {
+        LOG_ERROR("Invalid array block count %lli.", (long long)blockCount);
+        return ERROR;
+    }
+
+    if (seq->len + blockCount > seq->cap) {
+        uint32_t newCap = seq->len + (uint32_t)blockCount;
+        char *newBuf = realloc(seq->buf, newCap * itemSize);
+        if (newBuf == NULL) {
+            LOG_ERROR("Failed to allocate memory for array.");
+            return ERROR;
+        }
+        memset(newBuf + seq->cap * itemSize, 0, (newCap - seq->cap) * itemSize);
+        seq->buf = newBuf;
+        seq->cap = newCap;
+    }
+    *count = (uint32_t)blockCount;
+    return OK;
+}
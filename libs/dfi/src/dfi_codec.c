@@ -0,0 +1,326 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *  KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include "dfi_codec.h"
+#include "dyn_type_common.h"
+#include "dyn_function_common.h"
+#include "dyn_interface_common.h"
+#include "open_memstream.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+#include <pthread.h>
+#include <sys/queue.h>
+
+#define DFI_CODEC_MAX_SIGNATURE_DEPTH 64
+
+static const int OK = 0;
+static const int ERROR = 1;
+
+DFI_SETUP_LOG(dfiCodec);
+
+struct dfi_codec_entry {
+    const dfi_message_codec_t *msgCodec; //either msgCodec or rpcCodec is set
+    const dfi_rpc_codec_t *rpcCodec;
+    TAILQ_ENTRY(dfi_codec_entry) entries;
+};
+
+static TAILQ_HEAD(, dfi_codec_entry) g_codecs = TAILQ_HEAD_INITIALIZER(g_codecs);
+static pthread_mutex_t g_codecsMutex = PTHREAD_MUTEX_INITIALIZER; //protects g_codecs
+
+static int dfiCodec_register(const dfi_message_codec_t *msgCodec, const dfi_rpc_codec_t *rpcCodec) {
+    struct dfi_codec_entry *entry = calloc(1, sizeof(*entry));
+    if (entry == NULL) {
+        LOG_ERROR("Cannot allocate memory for codec entry");
+        return ERROR;
+    }
+    entry->msgCodec = msgCodec;
+    entry->rpcCodec = rpcCodec;
+    pthread_mutex_lock(&g_codecsMutex);
+    TAILQ_INSERT_TAIL(&g_codecs, entry, entries);
+    pthread_mutex_unlock(&g_codecsMutex);
+    return OK;
+}
+
+static void dfiCodec_unregister(const void *codec) {
+    struct dfi_codec_entry *entry = NULL;
+    pthread_mutex_lock(&g_codecsMutex);
+    TAILQ_FOREACH(entry, &g_codecs, entries) {
+        if ((const void*)entry->msgCodec == codec || (const void*)entry->rpcCodec == codec) {
+            TAILQ_REMOVE(&g_codecs, entry, entries);
+            break;
+        }
+    }
+    pthread_mutex_unlock(&g_codecsMutex);
+    free(entry);
+}
+
+int dfiCodec_registerMessageCodec(const dfi_message_codec_t *codec) {
+    return dfiCodec_register(codec, NULL);
+}
+
+void dfiCodec_unregisterMessageCodec(const dfi_message_codec_t *codec) {
+    dfiCodec_unregister(codec);
+}
+
+int dfiCodec_registerRpcCodec(const dfi_rpc_codec_t *codec) {
+    return dfiCodec_register(NULL, codec);
+}
+
+void dfiCodec_unregisterRpcCodec(const dfi_rpc_codec_t *codec) {
+    dfiCodec_unregister(codec);
+}
+
+const dfi_message_codec_t* dfiCodec_findMessageCodec(const char *name, const char *version) {
+    const dfi_message_codec_t *result = NULL;
+    struct dfi_codec_entry *entry = NULL;
+    pthread_mutex_lock(&g_codecsMutex);
+    TAILQ_FOREACH(entry, &g_codecs, entries) {
+        if (entry->msgCodec != NULL && strcmp(entry->msgCodec->name, name) == 0 && strcmp(entry->msgCodec->version, version) == 0) {
+            result = entry->msgCodec;
+            break;
+        }
+    }
+    pthread_mutex_unlock(&g_codecsMutex);
+    return result;
+}
+
+const dfi_rpc_codec_t* dfiCodec_findRpcCodec(const char *name, const char *version) {
+    const dfi_rpc_codec_t *result = NULL;
+    struct dfi_codec_entry *entry = NULL;
+    pthread_mutex_lock(&g_codecsMutex);
+    TAILQ_FOREACH(entry, &g_codecs, entries) {
+        if (entry->rpcCodec != NULL && strcmp(entry->rpcCodec->name, name) == 0 && strcmp(entry->rpcCodec->version, version) == 0) {
+            result = entry->rpcCodec;
+            break;
+        }
+    }
+    pthread_mutex_unlock(&g_codecsMutex);
+    return result;
+}
+
+void dfiCodec_attachMessageCodec(const char *name, const char *version, dyn_type *type) {
+    if (name == NULL || version == NULL || type == NULL) {
+        return;
+    }
+    const dfi_message_codec_t *codec = dfiCodec_findMessageCodec(name, version);
+    if (codec == NULL) {
+        return;
+    }
+
+    char *sig = NULL;
+    if (dfiCodec_typeSignature(type, &sig) == OK && strcmp(sig, codec->signature) == 0 && codec->size == dynType_size(type)) {
+        type->codec = codec;
+        LOG_DEBUG("Using generated codec for message %s %s", name, version);
+    } else {
+        LOG_WARNING("Generated codec for message %s %s does not match the descriptor, using dynamic serialization", name, version);
+    }
+    free(sig);
+}
+
+static const dfi_rpc_method_codec_t* dfiCodec_findMethodCodec(const dfi_rpc_codec_t *codec, struct method_entry *method) {
+    for (size_t i = 0; i < codec->nrOfCodecs; ++i) {
+        if (strcmp(codec->methods[i].id, method->id) == 0) {
+            return &codec->methods[i];
+        }
+    }
+    return NULL;
+}
+
+void dfiCodec_attachRpcCodec(dyn_interface_type *intf) {
+    char *name = NULL;
+    char *version = NULL;
+    dynInterface_getName(intf, &name);
+    dynInterface_getVersionString(intf, &version);
+    if (name == NULL || version == NULL) {
+        return;
+    }
+    const dfi_rpc_codec_t *codec = dfiCodec_findRpcCodec(name, version);
+    if (codec == NULL) {
+        return;
+    }
+
+    //note only attached if all methods match, the generated stub dispatches on method id
+    bool match = codec->nrOfMethods == (size_t)dynInterface_nrOfMethods(intf);
+    struct method_entry *method = NULL;
+    TAILQ_FOREACH(method, &intf->methods, entries) {
+        const dfi_rpc_method_codec_t *methodCodec = match ? dfiCodec_findMethodCodec(codec, method) : NULL;
+        if (methodCodec != NULL) {
+            char *sig = NULL;
+            match = dfiCodec_functionSignature(method->dynFunc, &sig) == OK && strcmp(sig, methodCodec->signature) == 0;
+            free(sig);
+        }
+    }
+    if (!match) {
+        LOG_WARNING("Generated codec for interface %s %s does not match the descriptor, using dynamic json rpc", name, version);
+        return;
+    }
+
+    TAILQ_FOREACH(method, &intf->methods, entries) {
+        method->dynFunc->codec = dfiCodec_findMethodCodec(codec, method);
+    }
+    intf->codec = codec;
+    LOG_DEBUG("Using generated codec for interface %s %s", name, version);
+}
+
+const dfi_message_codec_t* dfiCodec_messageCodec(dyn_type *type) {
+    return type->codec;
+}
+
+static dyn_type* dfiCodec_resolve(dyn_type *type) {
+    return type->type == DYN_TYPE_REF ? type->ref.ref : type;
+}
+
+static int dfiCodec_writeTypeSignature(FILE *stream, dyn_type *type, dyn_type **visiting, size_t depth) {
+    type = dfiCodec_resolve(type);
+    int status = OK;
+    struct complex_type_entry *entry = NULL;
+    struct meta_entry *meta = NULL;
+
+    if (depth >= DFI_CODEC_MAX_SIGNATURE_DEPTH) {
+        LOG_ERROR("Type too deeply nested for a signature");
+        return ERROR;
+    }
+
+    switch (type->descriptor) {
+        case '{' :
+            for (size_t i = 0; i < depth; ++i) {
+                if (visiting[i] == type) {
+                    //recursive type, e.g. a linked list
+                    fprintf(stream, "L%s;", type->name != NULL ? type->name : "");
+                    return OK;
+                }
+            }
+            visiting[depth] = type;
+            fputc('{', stream);
+            TAILQ_FOREACH(entry, &type->complex.entriesHead, entries) {
+                status = dfiCodec_writeTypeSignature(stream, entry->type, visiting, depth + 1);
+                if (status != OK) {
+                    break;
+                }
+                fprintf(stream, " %s;", entry->name != NULL ? entry->name : "");
+            }
+            fputc('}', stream);
+            break;
+        case '[' :
+            fputc('[', stream);
+            status = dfiCodec_writeTypeSignature(stream, type->sequence.itemType, visiting, depth);
+            break;
+        case '*' :
+            fputc('*', stream);
+            status = dfiCodec_writeTypeSignature(stream, type->typedPointer.typedType, visiting, depth);
+            break;
+        case 'E' :
+            fputs("E<", stream);
+            TAILQ_FOREACH(meta, &type->metaProperties, entries) {
+                fprintf(stream, "%s=%s,", meta->name, meta->value);
+            }
+            fputc('>', stream);
+            break;
+        default :
+            fputc(type->descriptor, stream);
+            break;
+    }
+    return status;
+}
+
+int dfiCodec_typeSignature(dyn_type *type, char **out) {
+    char *buf = NULL;
+    size_t size = 0;
+    dyn_type *visiting[DFI_CODEC_MAX_SIGNATURE_DEPTH];
+
+    FILE *stream = open_memstream(&buf, &size);
+    if (stream == NULL) {
+        return ERROR;
+    }
+    int status = dfiCodec_writeTypeSignature(stream, type, visiting, 0);
+    fclose(stream);
+    if (status == OK) {
+        *out = buf;
+    } else {
+        free(buf);
+    }
+    return status;
+}
+
+int dfiCodec_functionSignature(dyn_function_type *func, char **out) {
+    char *buf = NULL;
+    size_t size = 0;
+    dyn_type *visiting[DFI_CODEC_MAX_SIGNATURE_DEPTH];
+    static const char metas[] = {
+            [DYN_FUNCTION_ARGUMENT_META__STD] = 's',
+            [DYN_FUNCTION_ARGUMENT_META__HANDLE] = 'h',
+            [DYN_FUNCTION_ARGUMENT_META__PRE_ALLOCATED_OUTPUT] = 'p',
+            [DYN_FUNCTION_ARGUMENT_META__OUTPUT] = 'o'
+    };
+
+    FILE *stream = open_memstream(&buf, &size);
+    if (stream == NULL) {
+        return ERROR;
+    }
+    int status = OK;
+    fputc('(', stream);
+    int nrOfArgs = dynFunction_nrOfArguments(func);
+    for (int i = 0; status == OK && i < nrOfArgs; ++i) {
+        fputc(metas[dynFunction_argumentMetaForIndex(func, i)], stream);
+        status = dfiCodec_writeTypeSignature(stream, dynFunction_argumentTypeForIndex(func, i), visiting, 0);
+        fputc(';', stream);
+    }
+    fputc(')', stream);
+    if (status == OK) {
+        status = dfiCodec_writeTypeSignature(stream, dynFunction_returnType(func), visiting, 0);
+    }
+    fclose(stream);
+    if (status == OK) {
+        *out = buf;
+    } else {
+        free(buf);
+    }
+    return status;
+}
+
+void dfiCodec_freeArgument(dyn_function_type *func, int index, void *value) {
+    if (value == NULL) {
+        return;
+    }
+    dyn_type *argType = dynFunction_argumentTypeForIndex(func, index);
+    dyn_type *subType = NULL;
+    dyn_type *subSubType = NULL;
+    switch (dynFunction_argumentMetaForIndex(func, index)) {
+        case DYN_FUNCTION_ARGUMENT_META__STD :
+            dynType_deepFree(dfiCodec_resolve(argType), value, false);
+            break;
+        case DYN_FUNCTION_ARGUMENT_META__PRE_ALLOCATED_OUTPUT :
+            dynType_typedPointer_getTypedType(argType, &subType);
+            dynType_free(dfiCodec_resolve(subType), value);
+            break;
+        case DYN_FUNCTION_ARGUMENT_META__OUTPUT :
+            dynType_typedPointer_getTypedType(argType, &subType);
+            if (dynType_descriptorType(subType) == 't') {
+                free(value);
+            } else {
+                dynType_typedPointer_getTypedType(subType, &subSubType);
+                dynType_free(dfiCodec_resolve(subSubType), value);
+            }
+            break;
+        default :
+            break;
+    }
+}
@@ -33,12 +33,16 @@ DFI_SETUP_LOG(dynAvprFunction)
 #define FQN_SIZE 256
 #define ARG_SIZE 32
 
+// Section: extern type declarations
+typedef struct dyn_avpr_type_index dyn_avpr_type_index_t;
+
 // Section: static function declarations
 dyn_function_type * dynAvprFunction_parseFromJson(json_t * const root, const char * fqn);
+dyn_function_type * dynAvprFunction_parseFromEntry(dyn_avpr_type_index_t * const typeIndex, json_t const * const jsonFuncObject, const char * fqn, const char * parentNamespace);
 static json_t const * const dynAvprFunction_findFunc(const char * fqn, json_t * const messagesObject, const char * parentNamespace);
-static bool dynAvprFunction_parseFunc(dyn_function_type * func, json_t const * const jsonFuncObject, json_t * const root, const char * fqn, const char * parentNamespace);
-inline static bool dynAvprFunction_parseArgument(dyn_function_type * func, size_t index, json_t const * entry, json_t * const root, const char * namespace, char * argBuffer, char * typeBuffer);
-inline static bool dynAvprFunction_parseReturn(dyn_function_type * func, size_t index, json_t const * const response_type, json_t * const root, const char * namespace, char * typeBuffer);
+static bool dynAvprFunction_parseFunc(dyn_function_type * func, json_t const * const jsonFuncObject, dyn_avpr_type_index_t * const typeIndex, const char * fqn, const char * parentNamespace);
+inline static bool dynAvprFunction_parseArgument(dyn_function_type * func, size_t index, json_t const * entry, dyn_avpr_type_index_t * const typeIndex, const char * namespace, char * argBuffer, char * typeBuffer);
+inline static bool dynAvprFunction_parseReturn(dyn_function_type * func, size_t index, json_t const * const response_type, dyn_avpr_type_index_t * const typeIndex, const char * namespace, char * typeBuffer);
 inline static bool dynAvprFunction_createHandle(dyn_function_type * func);
 inline static dyn_function_argument_type * dynAvprFunction_prepareArgumentEntry(const char * name);
 inline static dyn_type * dynAvprFunction_createVoidType();
@@ -48,7 +52,9 @@ inline static bool dynAvprFunction_initCif(dyn_function_type * func, size_t nofA
 // Section: extern function definitions
 ffi_type * dynType_ffiType(dyn_type *type);
 dyn_type * dynAvprType_createNestedForFunction(dyn_type * store_type, const char* fqn);
-dyn_type * dynAvprType_parseFromTypedJson(json_t * const root, json_t const * const type_entry, const char * namespace);
+dyn_type * dynAvprType_parseFromTypedJson(dyn_avpr_type_index_t * const typeIndex, json_t const * const type_entry, const char * namespace);
+dyn_avpr_type_index_t * dynAvprType_createIndex(json_t * const root);
+void dynAvprType_destroyIndex(dyn_avpr_type_index_t * typeIndex);
 void dynAvprType_constructFqn(char *destination, size_t size, const char *possibleFqn, const char *ns);
 
 // Section: function definitions
@@ -80,7 +86,7 @@ dyn_function_type * dynFunction_parseAvprWithStr(const char * avpr, const char *
 
 dyn_function_type * dynAvprFunction_parseFromJson(json_t * const root, const char * fqn) {
     bool valid = true;
-    dyn_function_type *func = calloc(1, sizeof(*func));
+    dyn_function_type *func = NULL;
 
     if (!json_is_object(root)) {
         LOG_ERROR("ParseFunction: Error decoding json, root should be an object");
@@ -101,7 +107,19 @@ dyn_function_type * dynAvprFunction_parseFromJson(json_t * const root, const cha
         valid = false;
     }
 
-    if (valid && !dynAvprFunction_parseFunc(func, dynAvprFunction_findFunc(fqn, messagesObject, parentNamespace), root, fqn, parentNamespace)) {
+    dyn_avpr_type_index_t * typeIndex = valid ? dynAvprType_createIndex(root) : NULL;
+    if (typeIndex) {
+        func = dynAvprFunction_parseFromEntry(typeIndex, dynAvprFunction_findFunc(fqn, messagesObject, parentNamespace), fqn, parentNamespace);
+        dynAvprType_destroyIndex(typeIndex);
+    }
+
+    return func;
+}
+
+// Parses the function from its json entry, the type index is shared by all functions of an interface
+dyn_function_type * dynAvprFunction_parseFromEntry(dyn_avpr_type_index_t * const typeIndex, json_t const * const jsonFuncObject, const char * fqn, const char * parentNamespace) {
+    dyn_function_type *func = calloc(1, sizeof(*func));
+    if (func && !dynAvprFunction_parseFunc(func, jsonFuncObject, typeIndex, fqn, parentNamespace)) {
         LOG_ERROR("parseAvpr: Destroying incorrect result");
         dynFunction_destroy(func);
         func = NULL;
@@ -132,7 +150,7 @@ static json_t const * const dynAvprFunction_findFunc(const char * fqn, json_t *
     return NULL;
 }
 
-static bool dynAvprFunction_parseFunc(dyn_function_type * func, json_t const * const jsonFuncObject, json_t * const root, const char * fqn, const char * parentNamespace) {
+static bool dynAvprFunction_parseFunc(dyn_function_type * func, json_t const * const jsonFuncObject, dyn_avpr_type_index_t * const typeIndex, const char * fqn, const char * parentNamespace) {
     if (!jsonFuncObject) {
         LOG_WARNING("ParseFunc: Received NULL, function not found, nothing to parse");
         return false;
@@ -166,7 +184,7 @@ static bool dynAvprFunction_parseFunc(dyn_function_type * func, json_t const * c
     size_t index;
     json_t const * arg_entry;
     json_array_foreach(argument_list, index, arg_entry) {
-        if (!dynAvprFunction_parseArgument(func, index+1, arg_entry, root, function_namespace, argBuffer, typeBuffer)) { /* Offset index to account for the handle */
+        if (!dynAvprFunction_parseArgument(func, index+1, arg_entry, typeIndex, function_namespace, argBuffer, typeBuffer)) { /* Offset index to account for the handle */
             LOG_ERROR("ParseFunc: Could not parse argument %d for %s", index, fqn);
             return false;
         }
@@ -175,7 +193,7 @@ static bool dynAvprFunction_parseFunc(dyn_function_type * func, json_t const * c
     index++;
 
     json_t const * const response_type = json_object_get(jsonFuncObject, "response");
-    if (!dynAvprFunction_parseReturn(func, index, response_type, root, function_namespace, typeBuffer)) {
+    if (!dynAvprFunction_parseReturn(func, index, response_type, typeIndex, function_namespace, typeBuffer)) {
         LOG_ERROR("ParseFunc: Could not parse return type for %s", fqn);
         free(func->name);
         return false;
@@ -197,7 +215,7 @@ static bool dynAvprFunction_parseFunc(dyn_function_type * func, json_t const * c
     return true;
 }
 
-inline static bool dynAvprFunction_parseArgument(dyn_function_type * func, size_t index, json_t const * entry, json_t * const root, const char * namespace, char * argBuffer, char * typeBuffer) {
+inline static bool dynAvprFunction_parseArgument(dyn_function_type * func, size_t index, json_t const * entry, dyn_avpr_type_index_t * const typeIndex, const char * namespace, char * argBuffer, char * typeBuffer) {
     const char * entry_name = json_string_value(json_object_get(entry, "name"));
     if (!entry_name)  {
         LOG_INFO("ParseArgument: Could not find argument name for %d, using default", index);
@@ -205,7 +223,7 @@ inline static bool dynAvprFunction_parseArgument(dyn_function_type * func, size_
         entry_name = argBuffer;
     }
 
-    dyn_type * entry_dyn_type = dynAvprType_parseFromTypedJson(root, json_object_get(entry, "type"), namespace);
+    dyn_type * entry_dyn_type = dynAvprType_parseFromTypedJson(typeIndex, json_object_get(entry, "type"), namespace);
     if (!entry_dyn_type) {
         LOG_ERROR("ParseArgument: Could not parse type for argument");
         return false;
@@ -234,8 +252,8 @@ inline static bool dynAvprFunction_parseArgument(dyn_function_type * func, size_
     return true;
 }
 
-inline static bool dynAvprFunction_parseReturn(dyn_function_type * func, size_t index, json_t const * const response_type, json_t * const root, const char * namespace, char * typeBuffer) {
-    dyn_type * return_dyn_type = dynAvprType_parseFromTypedJson(root, response_type, namespace);
+inline static bool dynAvprFunction_parseReturn(dyn_function_type * func, size_t index, json_t const * const response_type, dyn_avpr_type_index_t * const typeIndex, const char * namespace, char * typeBuffer) {
+    dyn_type * return_dyn_type = dynAvprType_parseFromTypedJson(typeIndex, response_type, namespace);
     if (!return_dyn_type) {
         LOG_ERROR("ParseReturn: Could not parse return argument");
         return false;
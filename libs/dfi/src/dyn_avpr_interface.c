@@ -28,6 +28,7 @@
 #include "dyn_common.h"
 #include "dyn_type.h"
 #include "dyn_function.h"
+#include "dfi_codec.h"
 
 DFI_SETUP_LOG(dynAvprInterface)
 
@@ -35,19 +36,23 @@ DFI_SETUP_LOG(dynAvprInterface)
 #define FQN_SIZE 256
 #define ARG_SIZE 32
 
+typedef struct dyn_avpr_type_index dyn_avpr_type_index_t;
+
 // Section: function definitions
 inline static dyn_interface_type * dynAvprInterface_initializeInterface();
 inline static bool dynAvprInterface_createHeader(dyn_interface_type* intf, json_t * const root);
 inline static bool dynAvprInterface_createAnnotations(dyn_interface_type* intf, json_t * const root);
-inline static bool dynAvprInterface_createTypes(dyn_interface_type* intf, json_t * const root, const char* parent_ns);
-inline static bool dynAvprInterface_createMethods(dyn_interface_type* intf, json_t * const root, const char* parent_ns);
+inline static bool dynAvprInterface_createTypes(dyn_interface_type* intf, json_t * const root, dyn_avpr_type_index_t * const typeIndex, const char* parent_ns);
+inline static bool dynAvprInterface_createMethods(dyn_interface_type* intf, json_t * const root, dyn_avpr_type_index_t * const typeIndex, const char* parent_ns);
 static bool dynAvprInterface_insertNamValEntry(struct namvals_head *head, const char* name, const char* value);
 static struct namval_entry * dynAvprInterface_createNamValEntry(const char* name, const char* value);
 
 // Section: extern function definitions
 ffi_type * dynType_ffiType(dyn_type *type);
-dyn_type * dynAvprType_parseFromJson(json_t * const root, const char * fqn);
-dyn_function_type * dynAvprFunction_parseFromJson(json_t * const root, const char * fqn);
+dyn_avpr_type_index_t * dynAvprType_createIndex(json_t * const root);
+void dynAvprType_destroyIndex(dyn_avpr_type_index_t * typeIndex);
+dyn_type * dynAvprType_parseFromIndex(dyn_avpr_type_index_t * const typeIndex, const char * fqn);
+dyn_function_type * dynAvprFunction_parseFromEntry(dyn_avpr_type_index_t * const typeIndex, json_t const * const jsonFuncObject, const char * fqn, const char * parentNamespace);
 int dynInterface_checkInterface(dyn_interface_type *intf);
 void dynAvprType_constructFqn(char *destination, size_t size, const char *possibleFqn, const char *ns);
 
@@ -99,10 +104,17 @@ dyn_interface_type * dynInterface_parseAvpr(FILE * avprStream) {
 
     valid = valid && dynAvprInterface_createHeader(intf, root);
     valid = valid && dynAvprInterface_createAnnotations(intf, root);
-    valid = valid && dynAvprInterface_createTypes(intf, root, parent_ns);
-    valid = valid && dynAvprInterface_createMethods(intf, root, parent_ns);
+    // A single type index for all types and methods of the interface
+    dyn_avpr_type_index_t * typeIndex = valid ? dynAvprType_createIndex(root) : NULL;
+    valid = valid && typeIndex != NULL;
+    valid = valid && dynAvprInterface_createTypes(intf, root, typeIndex, parent_ns);
+    valid = valid && dynAvprInterface_createMethods(intf, root, typeIndex, parent_ns);
+    dynAvprType_destroyIndex(typeIndex);
 
     valid = valid && 0 == dynInterface_checkInterface(intf);
+    if (valid) {
+        dfiCodec_attachRpcCodec(intf);
+    }
 
     json_decref(root);
     if (valid) {
@@ -170,7 +182,7 @@ inline static bool dynAvprInterface_createAnnotations(dyn_interface_type* intf,
     return true;
 }
 
-inline static bool dynAvprInterface_createTypes(dyn_interface_type* intf, json_t * const root, const char* parent_ns) {
+inline static bool dynAvprInterface_createTypes(dyn_interface_type* intf, json_t * const root, dyn_avpr_type_index_t * const typeIndex, const char* parent_ns) {
     json_t const * const types_array = json_object_get(root, "types");
     if (!types_array || !json_is_array(types_array)) {
         LOG_ERROR("json: types is not an array or it does not exists!");
@@ -193,7 +205,7 @@ inline static bool dynAvprInterface_createTypes(dyn_interface_type* intf, json_t
         dynAvprType_constructFqn(name_buffer, FQN_SIZE, name, json_is_string(local_ns) ? json_string_value(local_ns) : parent_ns);
 
         t_entry = calloc(1, sizeof(*t_entry));
-        t_entry->type = dynAvprType_parseFromJson(root, name_buffer);
+        t_entry->type = dynAvprType_parseFromIndex(typeIndex, name_buffer);
         if (!t_entry->type) {
             free(t_entry);
             return false;
@@ -205,7 +217,7 @@ inline static bool dynAvprInterface_createTypes(dyn_interface_type* intf, json_t
     return true;
 }
 
-inline static bool dynAvprInterface_createMethods(dyn_interface_type* intf, json_t * const root, const char* parent_ns) {
+inline static bool dynAvprInterface_createMethods(dyn_interface_type* intf, json_t * const root, dyn_avpr_type_index_t * const typeIndex, const char* parent_ns) {
     json_t * const messages_object = json_object_get(root, "messages");
     if (!messages_object || !json_is_object(messages_object)) {
         LOG_ERROR("json: messages is not an object or it does not exist!");
@@ -223,7 +235,7 @@ inline static bool dynAvprInterface_createMethods(dyn_interface_type* intf, json
         dynAvprType_constructFqn(name_buffer, FQN_SIZE, func_name, json_is_string(local_ns) ? json_string_value(local_ns) : parent_ns);
 
         m_entry = calloc(1, sizeof(*m_entry));
-        m_entry->dynFunc = dynAvprFunction_parseFromJson(root, name_buffer);
+        m_entry->dynFunc = dynAvprFunction_parseFromEntry(typeIndex, func_entry, name_buffer, parent_ns);
         if (!m_entry->dynFunc) {
             free(m_entry);
             return false;
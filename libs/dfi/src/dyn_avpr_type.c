@@ -31,6 +31,7 @@
 #include "dyn_type.h"
 #include "dyn_type_common.h"
 #include "version.h"
+#include "celix_hash_map.h"
 
 DFI_SETUP_LOG(dynAvprType)
 
@@ -39,26 +40,38 @@ DFI_SETUP_LOG(dynAvprType)
 
 enum JsonTypeType {INVALID=0, SIMPLE=1, ARRAY=2, REFERENCE=3, SELF_REFERENCE=4};
 
+// Index of the types of a protocol, created once per parsed json root instead of searching the types array for every
+// lookup. Also memoizes the reference types already created in the root type currently being parsed.
+typedef struct dyn_avpr_type_index {
+    json_t *root;
+    const char *ns;
+    celix_string_hash_map_t *entries; // fqn -> json type entry
+    celix_string_hash_map_t *refs; // fqn -> reference type nested in the current root type
+} dyn_avpr_type_index_t;
+
+dyn_avpr_type_index_t * dynAvprType_createIndex(json_t * const root);
+void dynAvprType_destroyIndex(dyn_avpr_type_index_t * typeIndex);
 dyn_type * dynAvprType_parseFromJson(json_t * const root, const char * fqn);
+dyn_type * dynAvprType_parseFromIndex(dyn_avpr_type_index_t * const typeIndex, const char * fqn);
 dyn_type * dynAvprType_createNestedForFunction(dyn_type * store_type, const char* fqn);
-dyn_type * dynAvprType_parseFromTypedJson(json_t * const root, json_t const * const type_entry, const char * namespace);
+dyn_type * dynAvprType_parseFromTypedJson(dyn_avpr_type_index_t * const typeIndex, json_t const * const type_entry, const char * namespace);
 void dynAvprType_constructFqn(char *destination, size_t size, const char *possibleFqn, const char *ns);
 
 // Any
-static json_t const * dynAvprType_findType(char const * const fqn, json_t const * const array_object, const char * ns);
-static dyn_type * dynAvprType_parseAny(dyn_type * root, dyn_type * parent, json_t const * const jsonObject, json_t const * const array_object, const char * parent_ns);
+static json_t const * dynAvprType_findType(char const * const fqn, dyn_avpr_type_index_t * const typeIndex);
+static dyn_type * dynAvprType_parseAny(dyn_type * root, dyn_type * parent, json_t const * const jsonObject, dyn_avpr_type_index_t * const typeIndex, const char * parent_ns);
 static dyn_type * dynAvprType_initializeType(dyn_type * parent);
 
 // Record
-static dyn_type * dynAvprType_parseRecord(dyn_type * root, dyn_type * parent, json_t const * const record_obj, json_t const * const array_object, const char* parent_ns);
+static dyn_type * dynAvprType_parseRecord(dyn_type * root, dyn_type * parent, json_t const * const record_obj, dyn_avpr_type_index_t * const typeIndex, const char* parent_ns);
 static inline dyn_type * dynAvprType_prepareRecord(dyn_type * parent, json_t const ** fields, json_t const * const record_obj);
 static inline bool dynAvprType_finalizeRecord(dyn_type * type, const size_t size);
 static inline struct complex_type_entry *dynAvprType_prepareRecordEntry(json_t const *const entry_object);
-static inline struct complex_type_entry *dynAvprType_parseRecordEntry(dyn_type *root, dyn_type *parent, json_t const *const entry_object, json_t const *const array_object, const char *fqn_parent, const char *parent_ns, const char *record_ns);
+static inline struct complex_type_entry *dynAvprType_parseRecordEntry(dyn_type *root, dyn_type *parent, json_t const *const entry_object, dyn_avpr_type_index_t * const typeIndex, const char *fqn_parent, const char *parent_ns, const char *record_ns);
 static inline enum JsonTypeType dynAvprType_getRecordEntryType(json_t const * const entry_object, const char * fqn_parent, char * name_buffer, const char * namespace);
 
 // Reference
-static dyn_type * dynAvprType_parseReference(dyn_type * root, const char * name_buffer, json_t const * const array_object, const char * parent_ns);
+static dyn_type * dynAvprType_parseReference(dyn_type * root, const char * name_buffer, dyn_avpr_type_index_t * const typeIndex, const char * parent_ns);
 static dyn_type * dynAvprType_parseSelfReference(dyn_type * parent);
 static dyn_type * dynAvprType_initializeReferenceType(dyn_type * type_pointer);
 static inline struct type_entry * dynAvprType_prepareNestedEntry(dyn_type * const parent, const char * fqn, bool allocate);
@@ -70,7 +83,7 @@ static inline bool dynAvprType_metaEntrySetValue(struct meta_entry * meta_entry_
 static inline void dynAvprType_parseEnumValue(char** enumvalue);
 
 // Array
-static dyn_type * dynAvprType_parseArray(dyn_type * root, dyn_type * parent, json_t const * const array_entry_obj, json_t const * const array_object, char * name_buffer, const char * parent_ns, const char * record_ns);
+static dyn_type * dynAvprType_parseArray(dyn_type * root, dyn_type * parent, json_t const * const array_entry_obj, dyn_avpr_type_index_t * const typeIndex, char * name_buffer, const char * parent_ns, const char * record_ns);
 
 // Fixed
 static dyn_type * dynAvprType_parseFixed(dyn_type * parent, json_t const * const fixed_object, const char * parent_ns);
@@ -83,8 +96,8 @@ static dyn_type * dynAvprType_createSimpleType(dyn_type * parent, char kind, con
 // General
 static char * dynAvprType_createFqnFromJson(json_t const * const jsonObject, const char * namespace);
 static inline enum JsonTypeType dynAvprType_getType(json_t const * const json_type);
-static inline void dynAvprType_createVersionMetaEntry(dyn_type * type, json_t const * const root, json_t const * const array_object, const char* parent_ns);
-static inline void dynAvprType_createAnnotationEntries(dyn_type * type, json_t const * const array_object, const char* parent_ns);
+static inline void dynAvprType_createVersionMetaEntry(dyn_type * type, dyn_avpr_type_index_t * const typeIndex);
+static inline void dynAvprType_createAnnotationEntries(dyn_type * type, dyn_avpr_type_index_t * const typeIndex);
 
 // fqn = fully qualified name
 dyn_type * dynType_parseAvpr(FILE* avprStream, const char *fqn) {
@@ -113,67 +126,97 @@ dyn_type * dynType_parseAvprWithStr(const char* avpr, const char *fqn) {
     return returnValue;
 }
 
-// Based on the fqn passed in, try to find an entry in the array_object with that name, the current namespace is defined by the parameter ns
-static json_t const * dynAvprType_findType(char const * const fqn, json_t const * const array_object, const char * ns) {
+dyn_avpr_type_index_t * dynAvprType_createIndex(json_t * const root) {
+    if (!json_is_object(root)) {
+        LOG_ERROR("parseAvpr: Error decoding json, root should be an object");
+        return NULL;
+    }
+
+    // Get base namespace
+    const char *parent_ns = json_string_value(json_object_get(root, "namespace"));
+    if (!parent_ns) {
+        LOG_ERROR("parseAvpr: No namespace found in root, or it is null!");
+        return NULL;
+    }
+
+    dyn_avpr_type_index_t * typeIndex = calloc(1, sizeof(*typeIndex));
+    if (typeIndex) {
+        typeIndex->root = root;
+        typeIndex->ns = parent_ns;
+        typeIndex->entries = celix_stringHashMap_create();
+        typeIndex->refs = celix_stringHashMap_create();
+    }
+    if (!typeIndex || !typeIndex->entries || !typeIndex->refs) {
+        LOG_ERROR("parseAvpr: Error allocating memory for type index");
+        dynAvprType_destroyIndex(typeIndex);
+        return NULL;
+    }
+
+    // Index the types array, if any (functions with only simple types do not need one)
     char fqn_buffer[FQN_SIZE];
     size_t index;
     json_t const * type_entry;
-
-    json_array_foreach(array_object, index, type_entry) {
+    json_array_foreach(json_object_get(root, "types"), index, type_entry) {
         const char* entry_name = json_string_value(json_object_get(type_entry, "name"));
         if (entry_name) {
             const char* entry_ns = json_string_value(json_object_get(type_entry, "namespace"));
-            snprintf(fqn_buffer, FQN_SIZE, "%s.%s", entry_ns ? entry_ns : ns, entry_name);
-            if (strcmp(fqn, fqn_buffer) == 0) {
-                return type_entry; // Found
+            snprintf(fqn_buffer, FQN_SIZE, "%s.%s", entry_ns ? entry_ns : parent_ns, entry_name);
+            if (!celix_stringHashMap_hasKey(typeIndex->entries, fqn_buffer)) { // first definition wins
+                celix_stringHashMap_put(typeIndex->entries, fqn_buffer, (void*)type_entry);
             }
         }
         else {
             LOG_INFO("FindType: found a type with no name, check your json configuration, skipping this entry for now...");
         }
     }
-    return NULL; // Not found
+    return typeIndex;
 }
 
-dyn_type * dynAvprType_parseFromJson(json_t * const root, const char * fqn) {
-    // Initialize type
-    bool valid = true;
-    if (!json_is_object(root)) {
-        LOG_ERROR("parseAvpr: Error decoding json, root should be an object");
-        valid = false;
+void dynAvprType_destroyIndex(dyn_avpr_type_index_t * typeIndex) {
+    if (typeIndex) {
+        celix_stringHashMap_destroy(typeIndex->entries);
+        celix_stringHashMap_destroy(typeIndex->refs);
+        free(typeIndex);
     }
+}
 
-    // Get base namespace
-    const char *parent_ns = json_string_value(json_object_get(root, "namespace"));
-    if (valid && !parent_ns) {
-        LOG_ERROR("parseAvpr: No namespace found in root, or it is null!");
-        valid = false;
-    }
+// Based on the fqn passed in, try to find the type entry with that name
+static json_t const * dynAvprType_findType(char const * const fqn, dyn_avpr_type_index_t * const typeIndex) {
+    return celix_stringHashMap_get(typeIndex->entries, fqn);
+}
 
-    // Get types array
-    json_t* typesArrayObject = json_object_get(root, "types");
-    if (valid && !json_is_array(typesArrayObject)) {
+dyn_type * dynAvprType_parseFromJson(json_t * const root, const char * fqn) {
+    dyn_type * type = NULL;
+    dyn_avpr_type_index_t * typeIndex = NULL;
+    if (json_is_object(root) && !json_is_array(json_object_get(root, "types"))) {
         LOG_ERROR("parseAvpr: types should be an array!");
-        valid = false;
     }
+    else {
+        typeIndex = dynAvprType_createIndex(root);
+    }
+    if (typeIndex) {
+        type = dynAvprType_parseFromIndex(typeIndex, fqn);
+        dynAvprType_destroyIndex(typeIndex);
+    }
+    else {
+        LOG_ERROR("Not found %s", fqn);
+    }
+    return type;
+}
+
+dyn_type * dynAvprType_parseFromIndex(dyn_avpr_type_index_t * const typeIndex, const char * fqn) {
+    // Reference types are nested in (and memoized for) a single root type
+    celix_stringHashMap_clear(typeIndex->refs);
 
     // Try to find the fqn and parse if it is found, if any error occurs during parsing, return NULL
-    dyn_type * type = NULL;
-    if (valid) {
-        type = dynAvprType_parseAny(NULL, NULL, dynAvprType_findType(fqn, typesArrayObject, parent_ns), typesArrayObject, parent_ns);
-        valid = type != NULL;
-    }
+    dyn_type * type = dynAvprType_parseAny(NULL, NULL, dynAvprType_findType(fqn, typeIndex), typeIndex, typeIndex->ns);
 
     // Add version as a meta entry
-    if (valid) {
+    if (type) {
     	LOG_DEBUG("parseAvpr: Parsing successful, adding version entry and annotations");
-        dynAvprType_createVersionMetaEntry(type, root, typesArrayObject, parent_ns);
+        dynAvprType_createVersionMetaEntry(type, typeIndex);
         // Add any other annotation fields that are not in [type, name, fields, version, alias]
-        dynAvprType_createAnnotationEntries(type, typesArrayObject, parent_ns);
-
-    }
-
-    if (valid) {
+        dynAvprType_createAnnotationEntries(type, typeIndex);
         LOG_DEBUG("Found %s", fqn);
     }
     else {
@@ -225,7 +268,7 @@ dyn_type * dynAvprType_createNestedForFunction(dyn_type * store_type, const char
 }
 
 // To be used for dyn_function parsing of return and parameter arrays
-dyn_type * dynAvprType_parseFromTypedJson(json_t * const root, json_t const * const type_entry, const char * namespace) {
+dyn_type * dynAvprType_parseFromTypedJson(dyn_avpr_type_index_t * const typeIndex, json_t const * const type_entry, const char * namespace) {
     if (!type_entry) {
         LOG_ERROR("Need a type entry to parse, but got a NULL pointer");
         return NULL;
@@ -241,12 +284,13 @@ dyn_type * dynAvprType_parseFromTypedJson(json_t * const root, json_t const * co
             // Otherwise full parsing
             if (!ret_type) {
                 dynAvprType_constructFqn(name_buffer, FQN_SIZE, json_string_value(type_entry), namespace);
-                ret_type = dynAvprType_parseFromJson(root, name_buffer);
+                ret_type = dynAvprType_parseFromIndex(typeIndex, name_buffer);
             }
             break;
 
         case ARRAY:
-            ret_type = dynAvprType_parseArray(ret_type, NULL, type_entry, json_object_get(root, "types"), name_buffer, namespace, namespace);
+            celix_stringHashMap_clear(typeIndex->refs);
+            ret_type = dynAvprType_parseArray(ret_type, NULL, type_entry, typeIndex, name_buffer, namespace, namespace);
             if (!ret_type) {
                 LOG_ERROR("Error parsing array");
                 return NULL;
@@ -270,7 +314,7 @@ void dynAvprType_constructFqn(char *destination, size_t size, const char *possib
     snprintf(destination, size, "%s%s%s", isAlreadyFqn ? "" : ns, isAlreadyFqn ? "" : ".", possibleFqn);
 }
 
-static dyn_type * dynAvprType_parseAny(dyn_type * root, dyn_type * parent, json_t const * const jsonObject, json_t const * const array_object, const char * parent_ns) {
+static dyn_type * dynAvprType_parseAny(dyn_type * root, dyn_type * parent, json_t const * const jsonObject, dyn_avpr_type_index_t * const typeIndex, const char * parent_ns) {
     dyn_type * type = NULL;
 
     if (!jsonObject) {
@@ -290,7 +334,7 @@ static dyn_type * dynAvprType_parseAny(dyn_type * root, dyn_type * parent, json_
         LOG_DEBUG("Did not find alias under internal types, looking for custom types");
         char buffer[FQN_SIZE];
         dynAvprType_constructFqn(buffer, FQN_SIZE, alias, parent_ns);
-        type = dynAvprType_parseAny(root, parent, dynAvprType_findType(buffer, array_object, parent_ns), array_object, parent_ns);
+        type = dynAvprType_parseAny(root, parent, dynAvprType_findType(buffer, typeIndex), typeIndex, parent_ns);
         if (type) {
             return type;
         }
@@ -305,7 +349,7 @@ static dyn_type * dynAvprType_parseAny(dyn_type * root, dyn_type * parent, json_
 
     LOG_DEBUG("Any: Parsing a %s", type_name);
     if (strcmp(type_name, "record") == 0) {
-        type = dynAvprType_parseRecord(root, parent, jsonObject, array_object, parent_ns);
+        type = dynAvprType_parseRecord(root, parent, jsonObject, typeIndex, parent_ns);
     }
     else if (strcmp(type_name, "fixed") == 0) {
         type = dynAvprType_parseFixed(parent, jsonObject, parent_ns);
@@ -332,7 +376,7 @@ static dyn_type * dynAvprType_initializeType(dyn_type * parent) {
     return type;
 }
 
-static dyn_type * dynAvprType_parseRecord(dyn_type * root, dyn_type * parent, json_t const * const record_obj, json_t const * const array_object, const char * parent_ns) {
+static dyn_type * dynAvprType_parseRecord(dyn_type * root, dyn_type * parent, json_t const * const record_obj, dyn_avpr_type_index_t * const typeIndex, const char * parent_ns) {
     json_t const * fields = NULL;
     dyn_type * type = dynAvprType_prepareRecord(parent, &fields, record_obj); // also sets fields correctly
     if (!type) {
@@ -366,7 +410,7 @@ static dyn_type * dynAvprType_parseRecord(dyn_type * root, dyn_type * parent, js
     json_array_foreach(fields, counter, element) {
         LOG_DEBUG("Record: parsing field [%s](%s) at %d", json_string_value(json_object_get(element, "type")), json_string_value(json_object_get(element, "name")), counter);
 
-        struct complex_type_entry * entry = dynAvprType_parseRecordEntry(root, type, element, array_object, fqn_buffer, parent_ns, record_ns);
+        struct complex_type_entry * entry = dynAvprType_parseRecordEntry(root, type, element, typeIndex, fqn_buffer, parent_ns, record_ns);
         if (!entry) {
             LOG_ERROR("Record: Parsing record entry %d failed", counter);
             dynType_destroy(type);
@@ -427,7 +471,7 @@ static inline bool dynAvprType_finalizeRecord(dyn_type * type, const size_t size
     return true;
 }
 
-static inline struct complex_type_entry *dynAvprType_parseRecordEntry(dyn_type *root, dyn_type *parent, json_t const *const entry_object, json_t const *const array_object, const char *fqn_parent, const char *parent_ns, const char *record_ns) {
+static inline struct complex_type_entry *dynAvprType_parseRecordEntry(dyn_type *root, dyn_type *parent, json_t const *const entry_object, dyn_avpr_type_index_t * const typeIndex, const char *fqn_parent, const char *parent_ns, const char *record_ns) {
     struct complex_type_entry *entry = dynAvprType_prepareRecordEntry(entry_object);
     if (!entry) {
         return NULL;
@@ -441,12 +485,12 @@ static inline struct complex_type_entry *dynAvprType_parseRecordEntry(dyn_type *
         switch (dynAvprType_getRecordEntryType(entry_object, fqn_parent, name_buffer, record_ns)) {
             case SIMPLE:
                 LOG_DEBUG("RecordEntry: Looking for type: %s", name_buffer);
-                entry->type = dynAvprType_parseAny(root, parent, dynAvprType_findType(name_buffer, array_object, parent_ns), array_object, parent_ns);
+                entry->type = dynAvprType_parseAny(root, parent, dynAvprType_findType(name_buffer, typeIndex), typeIndex, parent_ns);
                 break;
 
             case REFERENCE:
                 LOG_DEBUG("RecordEntry: Found a ptr type, creating a reference %s", name_buffer);
-                entry->type = dynAvprType_parseReference(root, name_buffer, array_object, parent_ns);
+                entry->type = dynAvprType_parseReference(root, name_buffer, typeIndex, parent_ns);
                 break;
 
             case SELF_REFERENCE:
@@ -456,7 +500,7 @@ static inline struct complex_type_entry *dynAvprType_parseRecordEntry(dyn_type *
 
             case ARRAY:
                 LOG_DEBUG("RecordEntry: Parsing array: %s", name_buffer);
-                entry->type = dynAvprType_parseArray(root, parent, json_object_get(entry_object, "type"), array_object, name_buffer, parent_ns, record_ns);
+                entry->type = dynAvprType_parseArray(root, parent, json_object_get(entry_object, "type"), typeIndex, name_buffer, parent_ns, record_ns);
                 break;
 
             case INVALID:
@@ -514,7 +558,7 @@ static inline enum JsonTypeType dynAvprType_getRecordEntryType(json_t const * co
     return elType;
 }
 
-static dyn_type * dynAvprType_parseReference(dyn_type * root, const char * name_buffer, json_t const * const array_object, const char * parent_ns) {
+static dyn_type * dynAvprType_parseReference(dyn_type * root, const char * name_buffer, dyn_avpr_type_index_t * const typeIndex, const char * parent_ns) {
     dyn_type * type = dynAvprType_initializeType(NULL);
     if (!type) {
         return NULL;
@@ -528,7 +572,7 @@ static dyn_type * dynAvprType_parseReference(dyn_type * root, const char * name_
 
     // First try to find if it already exists
     LOG_DEBUG("Reference: looking for %s", name_buffer);
-    dyn_type *ref = dynType_findType(root, (char*) name_buffer);
+    dyn_type *ref = celix_stringHashMap_get(typeIndex->refs, name_buffer);
     if (ref) {
         if (ref->type == DYN_TYPE_INVALID) {
             LOG_ERROR("Reference: found incomplete type");
@@ -543,7 +587,7 @@ static dyn_type * dynAvprType_parseReference(dyn_type * root, const char * name_
 
     // if not found, Generate the reference type in root
     LOG_DEBUG("Reference: looking for %s in array", name_buffer);
-    json_t const * const refType = dynAvprType_findType(name_buffer, array_object, parent_ns);
+    json_t const * const refType = dynAvprType_findType(name_buffer, typeIndex);
     if (!refType) {
         LOG_ERROR("ParseReference: Could not find %s", name_buffer);
         free(subType);
@@ -555,11 +599,16 @@ static dyn_type * dynAvprType_parseReference(dyn_type * root, const char * name_
     struct type_entry *entry = dynAvprType_prepareNestedEntry(root, name_buffer, true);
     dyn_type * tmp = entry->type;
 
-    entry->type = dynAvprType_parseAny(root, NULL, refType, array_object, parent_ns);
+    celix_stringHashMap_put(typeIndex->refs, name_buffer, tmp); // incomplete until parsed
+    entry->type = dynAvprType_parseAny(root, NULL, refType, typeIndex, parent_ns);
     if (!entry->type) {
+        celix_stringHashMap_remove(typeIndex->refs, name_buffer);
         free(entry);
         success = false;
     }
+    else {
+        celix_stringHashMap_put(typeIndex->refs, name_buffer, entry->type);
+    }
 
     free(tmp->name);
     free(tmp);
@@ -750,7 +799,7 @@ static inline void dynAvprType_parseEnumValue(char** enumvalue) {
 
 static ffi_type* seq_types[] = {&ffi_type_uint32, &ffi_type_uint32, &ffi_type_pointer, NULL};
 
-static dyn_type* dynAvprType_parseArray(dyn_type * root, dyn_type * parent, json_t const * const array_entry_obj, json_t const * const array_object, char * name_buffer, const char * parent_ns, const char * record_ns) {
+static dyn_type* dynAvprType_parseArray(dyn_type * root, dyn_type * parent, json_t const * const array_entry_obj, dyn_avpr_type_index_t * const typeIndex, char * name_buffer, const char * parent_ns, const char * record_ns) {
     dyn_type * type = dynAvprType_initializeType(parent);
     if (!type) {
         return NULL;
@@ -769,7 +818,7 @@ static dyn_type* dynAvprType_parseArray(dyn_type * root, dyn_type * parent, json
     if (json_is_object(itemsEntry)) { // is nested?
         LOG_DEBUG("ParseArray: Found nested array");
         json_t const * const nested_array_object = json_object_get(array_entry_obj, "items");
-        type->sequence.itemType = dynAvprType_parseArray(root, type, nested_array_object, array_object, name_buffer, parent_ns, record_ns);
+        type->sequence.itemType = dynAvprType_parseArray(root, type, nested_array_object, typeIndex, name_buffer, parent_ns, record_ns);
     }
     else if (json_is_string(itemsEntry)) { // is a named item?
         LOG_DEBUG("ParseArray: Found type \"%s\", parsing", json_string_value(itemsEntry));
@@ -777,7 +826,7 @@ static dyn_type* dynAvprType_parseArray(dyn_type * root, dyn_type * parent, json
         if (!type->sequence.itemType) {
             LOG_DEBUG("ParseArray: Was not a simple type, doing full parse");
             dynAvprType_constructFqn(name_buffer, FQN_SIZE, json_string_value(itemsEntry), record_ns);
-            type->sequence.itemType = dynAvprType_parseAny(root, type, dynAvprType_findType(name_buffer, array_object, parent_ns), array_object, parent_ns);
+            type->sequence.itemType = dynAvprType_parseAny(root, type, dynAvprType_findType(name_buffer, typeIndex), typeIndex, parent_ns);
         }
 
     }
@@ -989,14 +1038,14 @@ static inline enum JsonTypeType dynAvprType_getType(json_t const * const json_ty
     }
 }
 
-static inline void dynAvprType_createVersionMetaEntry(dyn_type * type, json_t const * const root, json_t const * const array_object, const char* parent_ns) {
+static inline void dynAvprType_createVersionMetaEntry(dyn_type * type, dyn_avpr_type_index_t * const typeIndex) {
     struct meta_entry * m_entry = dynAvprType_createMetaEntry("version");
 
-    json_t const * json_type_version = json_object_get(dynAvprType_findType(dynType_getName(type), array_object, parent_ns), "version");
+    json_t const * json_type_version = json_object_get(dynAvprType_findType(dynType_getName(type), typeIndex), "version");
 
     // If version is not available check root version
     if (!json_is_string(json_type_version)) {
-        json_type_version = json_object_get(root, "version");
+        json_type_version = json_object_get(typeIndex->root, "version");
     }
 
     // If version is available use it (either from record or root)
@@ -1024,8 +1073,8 @@ static inline void dynAvprType_createVersionMetaEntry(dyn_type * type, json_t co
     TAILQ_INSERT_TAIL(&type->metaProperties, m_entry, entries);
 }
 
-static inline void dynAvprType_createAnnotationEntries(dyn_type * type, json_t const * const array_object, const char* parent_ns) {
-    json_t const * json_type = dynAvprType_findType(dynType_getName(type), array_object, parent_ns);
+static inline void dynAvprType_createAnnotationEntries(dyn_type * type, dyn_avpr_type_index_t * const typeIndex) {
+    json_t const * json_type = dynAvprType_findType(dynType_getName(type), typeIndex);
     const char* const not_of_interest[5] = {"type", "name", "fields", "version", "alias"};
     const char* key;
     json_t const * value;
@@ -23,6 +23,7 @@
 #include <strings.h>
 #include <stdlib.h>
 #include <ffi.h>
+#include <pthread.h>
 
 static const int OK = 0;
 static const int MEM_ERROR = 1;
@@ -34,9 +35,177 @@ DFI_SETUP_LOG(dynFunction)
 static int dynFunction_initCif(dyn_function_type *dynFunc);
 static int dynFunction_parseDescriptor(dyn_function_type *dynFunc, FILE *descriptor);
 static void dynFunction_ffiBind(ffi_cif *cif, void *ret, void *args[], void *userData);
+static dyn_function_argument_type* dynFunction_argumentForIndex(dyn_function_type *dynFunc, int argumentNr);
 
 ffi_type * dynType_ffiType(dyn_type *type);
 
+/*
+ * Statically generated invokers for common signatures: functions returning an int status ('N') with up to 4 pointer
+ * ('P': handles, texts, typed pointers and (pre) output arguments) or double ('D') arguments.
+ * These are selected when a function is parsed and called directly, without libffi.
+ */
+#define DYN_FUNCTION_ARG(ctype, i) (*(ctype*)argValues[i])
+#define DYN_FUNCTION_INVOKER_1(sig, t0) \
+    static void dynFunction_invoke_##sig(void (*fn)(void), void *returnValue, void **argValues) { \
+        *(int*)returnValue = ((int (*)(t0))fn)(DYN_FUNCTION_ARG(t0, 0)); \
+    }
+#define DYN_FUNCTION_INVOKER_2(sig, t0, t1) \
+    static void dynFunction_invoke_##sig(void (*fn)(void), void *returnValue, void **argValues) { \
+        *(int*)returnValue = ((int (*)(t0, t1))fn)(DYN_FUNCTION_ARG(t0, 0), DYN_FUNCTION_ARG(t1, 1)); \
+    }
+#define DYN_FUNCTION_INVOKER_3(sig, t0, t1, t2) \
+    static void dynFunction_invoke_##sig(void (*fn)(void), void *returnValue, void **argValues) { \
+        *(int*)returnValue = ((int (*)(t0, t1, t2))fn)(DYN_FUNCTION_ARG(t0, 0), DYN_FUNCTION_ARG(t1, 1), \
+                DYN_FUNCTION_ARG(t2, 2)); \
+    }
+#define DYN_FUNCTION_INVOKER_4(sig, t0, t1, t2, t3) \
+    static void dynFunction_invoke_##sig(void (*fn)(void), void *returnValue, void **argValues) { \
+        *(int*)returnValue = ((int (*)(t0, t1, t2, t3))fn)(DYN_FUNCTION_ARG(t0, 0), DYN_FUNCTION_ARG(t1, 1), \
+                DYN_FUNCTION_ARG(t2, 2), DYN_FUNCTION_ARG(t3, 3)); \
+    }
+
+DYN_FUNCTION_INVOKER_1(P, void*)
+DYN_FUNCTION_INVOKER_1(D, double)
+DYN_FUNCTION_INVOKER_2(PP, void*, void*)
+DYN_FUNCTION_INVOKER_2(PD, void*, double)
+DYN_FUNCTION_INVOKER_2(DP, double, void*)
+DYN_FUNCTION_INVOKER_2(DD, double, double)
+DYN_FUNCTION_INVOKER_3(PPP, void*, void*, void*)
+DYN_FUNCTION_INVOKER_3(PPD, void*, void*, double)
+DYN_FUNCTION_INVOKER_3(PDP, void*, double, void*)
+DYN_FUNCTION_INVOKER_3(PDD, void*, double, double)
+DYN_FUNCTION_INVOKER_3(DPP, double, void*, void*)
+DYN_FUNCTION_INVOKER_3(DPD, double, void*, double)
+DYN_FUNCTION_INVOKER_3(DDP, double, double, void*)
+DYN_FUNCTION_INVOKER_3(DDD, double, double, double)
+DYN_FUNCTION_INVOKER_4(PPPP, void*, void*, void*, void*)
+DYN_FUNCTION_INVOKER_4(PPPD, void*, void*, void*, double)
+DYN_FUNCTION_INVOKER_4(PPDP, void*, void*, double, void*)
+DYN_FUNCTION_INVOKER_4(PPDD, void*, void*, double, double)
+DYN_FUNCTION_INVOKER_4(PDPP, void*, double, void*, void*)
+DYN_FUNCTION_INVOKER_4(PDPD, void*, double, void*, double)
+DYN_FUNCTION_INVOKER_4(PDDP, void*, double, double, void*)
+DYN_FUNCTION_INVOKER_4(PDDD, void*, double, double, double)
+DYN_FUNCTION_INVOKER_4(DPPP, double, void*, void*, void*)
+DYN_FUNCTION_INVOKER_4(DPPD, double, void*, void*, double)
+DYN_FUNCTION_INVOKER_4(DPDP, double, void*, double, void*)
+DYN_FUNCTION_INVOKER_4(DPDD, double, void*, double, double)
+DYN_FUNCTION_INVOKER_4(DDPP, double, double, void*, void*)
+DYN_FUNCTION_INVOKER_4(DDPD, double, double, void*, double)
+DYN_FUNCTION_INVOKER_4(DDDP, double, double, double, void*)
+DYN_FUNCTION_INVOKER_4(DDDD, double, double, double, double)
+
+static const struct {
+    const char *signature;
+    dyn_function_invoker invoker;
+} dynFunction_invokers[] = {
+        {"P", dynFunction_invoke_P},
+        {"D", dynFunction_invoke_D},
+        {"PP", dynFunction_invoke_PP},
+        {"PD", dynFunction_invoke_PD},
+        {"DP", dynFunction_invoke_DP},
+        {"DD", dynFunction_invoke_DD},
+        {"PPP", dynFunction_invoke_PPP},
+        {"PPD", dynFunction_invoke_PPD},
+        {"PDP", dynFunction_invoke_PDP},
+        {"PDD", dynFunction_invoke_PDD},
+        {"DPP", dynFunction_invoke_DPP},
+        {"DPD", dynFunction_invoke_DPD},
+        {"DDP", dynFunction_invoke_DDP},
+        {"DDD", dynFunction_invoke_DDD},
+        {"PPPP", dynFunction_invoke_PPPP},
+        {"PPPD", dynFunction_invoke_PPPD},
+        {"PPDP", dynFunction_invoke_PPDP},
+        {"PPDD", dynFunction_invoke_PPDD},
+        {"PDPP", dynFunction_invoke_PDPP},
+        {"PDPD", dynFunction_invoke_PDPD},
+        {"PDDP", dynFunction_invoke_PDDP},
+        {"PDDD", dynFunction_invoke_PDDD},
+        {"DPPP", dynFunction_invoke_DPPP},
+        {"DPPD", dynFunction_invoke_DPPD},
+        {"DPDP", dynFunction_invoke_DPDP},
+        {"DPDD", dynFunction_invoke_DPDD},
+        {"DDPP", dynFunction_invoke_DDPP},
+        {"DDPD", dynFunction_invoke_DDPD},
+        {"DDDP", dynFunction_invoke_DDDP},
+        {"DDDD", dynFunction_invoke_DDDD},
+};
+
+#define DYN_FUNCTION_MAX_INVOKER_ARGS 4
+
+/**
+ * Selects a statically generated invoker for the signature of the function, if available.
+ */
+static dyn_function_invoker dynFunction_selectInvoker(dyn_function_type *dynFunc, int nrOfArguments) {
+    if (nrOfArguments < 1 || nrOfArguments > DYN_FUNCTION_MAX_INVOKER_ARGS || dynFunc->cif.rtype != &ffi_type_sint) {
+        return NULL;
+    }
+    char signature[DYN_FUNCTION_MAX_INVOKER_ARGS + 1];
+    for (int i = 0; i < nrOfArguments; ++i) {
+        if (dynFunc->ffiArguments[i] == &ffi_type_pointer) {
+            signature[i] = 'P';
+        } else if (dynFunc->ffiArguments[i] == &ffi_type_double) {
+            signature[i] = 'D';
+        } else {
+            return NULL;
+        }
+    }
+    signature[nrOfArguments] = '\0';
+    for (size_t i = 0; i < sizeof(dynFunction_invokers) / sizeof(dynFunction_invokers[0]); ++i) {
+        if (strcmp(dynFunction_invokers[i].signature, signature) == 0) {
+            return dynFunction_invokers[i].invoker;
+        }
+    }
+    return NULL;
+}
+
+/*
+ * Pool of released libffi closures. Imported proxies create a closure for every method, allocating a closure
+ * (an executable trampoline) is relatively expensive, so released closures are reused.
+ */
+#define DYN_FUNCTION_MAX_POOLED_CLOSURES 256
+
+typedef struct dyn_function_pooled_closure {
+    ffi_closure *closure;
+    void (*fn)(void);
+} dyn_function_pooled_closure_t;
+
+static pthread_mutex_t dynFunction_closurePoolMutex = PTHREAD_MUTEX_INITIALIZER;
+static dyn_function_pooled_closure_t dynFunction_closurePool[DYN_FUNCTION_MAX_POOLED_CLOSURES];
+static int dynFunction_closurePoolSize = 0; //protected by dynFunction_closurePoolMutex
+
+static ffi_closure* dynFunction_acquireClosure(void (**fn)(void)) {
+    ffi_closure *closure = NULL;
+    pthread_mutex_lock(&dynFunction_closurePoolMutex);
+    if (dynFunction_closurePoolSize > 0) {
+        dynFunction_closurePoolSize -= 1;
+        closure = dynFunction_closurePool[dynFunction_closurePoolSize].closure;
+        *fn = dynFunction_closurePool[dynFunction_closurePoolSize].fn;
+    }
+    pthread_mutex_unlock(&dynFunction_closurePoolMutex);
+
+    if (closure == NULL) {
+        closure = ffi_closure_alloc(sizeof(ffi_closure), (void **)fn);
+    }
+    return closure;
+}
+
+static void dynFunction_releaseClosure(ffi_closure *closure, void (*fn)(void)) {
+    bool pooled = false;
+    pthread_mutex_lock(&dynFunction_closurePoolMutex);
+    if (dynFunction_closurePoolSize < DYN_FUNCTION_MAX_POOLED_CLOSURES) {
+        dynFunction_closurePool[dynFunction_closurePoolSize].closure = closure;
+        dynFunction_closurePool[dynFunction_closurePoolSize].fn = fn;
+        dynFunction_closurePoolSize += 1;
+        pooled = true;
+    }
+    pthread_mutex_unlock(&dynFunction_closurePoolMutex);
+
+    if (!pooled) {
+        ffi_closure_free(closure);
+    }
+}
+
 int dynFunction_parse(FILE *descriptor, struct types_head *refTypes, dyn_function_type **out) {
     int status = OK;
     dyn_function_type *dynFunc = NULL;
@@ -163,17 +332,8 @@ static int dynFunction_parseDescriptor(dyn_function_type *dynFunc, FILE *descrip
 }
 
 enum dyn_function_argument_meta dynFunction_argumentMetaForIndex(dyn_function_type *dynFunc, int argumentNr) {
-    enum dyn_function_argument_meta result = 0;
-    dyn_function_argument_type *arg = NULL;
-    int index = 0;
-    TAILQ_FOREACH(arg, &dynFunc->arguments, entries) {
-        if (index == argumentNr) {
-            result = arg->argumentMeta;
-            break;
-        }
-        index += 1;
-    }
-    return result;
+    dyn_function_argument_type *arg = dynFunction_argumentForIndex(dynFunc, argumentNr);
+    return arg != NULL ? arg->argumentMeta : 0;
 }
 
 
@@ -198,6 +358,8 @@ static int dynFunction_initCif(dyn_function_type *dynFunc) {
     int ffiResult = ffi_prep_cif(&dynFunc->cif, FFI_DEFAULT_ABI, count, returnType, args);
     if (ffiResult != FFI_OK) {
         status = 1;
+    } else {
+        dynFunc->invoker = dynFunction_selectInvoker(dynFunc, count);
     }
 
     return status;
@@ -209,7 +371,7 @@ void dynFunction_destroy(dyn_function_type *dynFunc) {
             dynType_destroy(dynFunc->funcReturn);
         }
         if (dynFunc->ffiClosure != NULL) {
-            ffi_closure_free(dynFunc->ffiClosure);
+            dynFunction_releaseClosure(dynFunc->ffiClosure, dynFunc->fn);
         }
         if (dynFunc->name != NULL) {
             free(dynFunc->name);
@@ -217,6 +379,7 @@ void dynFunction_destroy(dyn_function_type *dynFunc) {
         if (dynFunc->ffiArguments != NULL) {
             free(dynFunc->ffiArguments);
         }
+        free(dynFunc->argumentIndex);
         
         dyn_function_argument_type *entry = NULL;
         dyn_function_argument_type *tmp = NULL;
@@ -236,7 +399,11 @@ void dynFunction_destroy(dyn_function_type *dynFunc) {
 }
 
 int dynFunction_call(dyn_function_type *dynFunc, void(*fn)(void), void *returnValue, void **argValues) {
-    ffi_call(&dynFunc->cif, fn, returnValue, argValues);
+    if (dynFunc->invoker != NULL) {
+        dynFunc->invoker(fn, returnValue, argValues);
+    } else {
+        ffi_call(&dynFunc->cif, fn, returnValue, argValues);
+    }
     return 0;
 }
 
@@ -247,9 +414,14 @@ static void dynFunction_ffiBind(ffi_cif *cif, void *ret, void *args[], void *use
 
 int dynFunction_createClosure(dyn_function_type *dynFunc, void (*bind)(void *, void **, void*), void *userData, void(**out)(void)) {
     int status = 0;
-    void (*fn)(void);
-    dynFunc->ffiClosure = ffi_closure_alloc(sizeof(ffi_closure), (void **)&fn);
+    void (*fn)(void) = NULL;
+    ffi_closure *closure = dynFunc->ffiClosure != NULL ? dynFunc->ffiClosure : dynFunction_acquireClosure(&fn);
     if (dynFunc->ffiClosure != NULL) {
+        fn = dynFunc->fn; //note closure created before, (re)bind the existing closure
+    }
+    dynFunc->ffiClosure = closure;
+    if (dynFunc->ffiClosure != NULL) {
+        dynFunc->fn = fn;
         int rc = ffi_prep_closure_loc(dynFunc->ffiClosure, &dynFunc->cif, dynFunction_ffiBind, dynFunc, fn);
         if (rc != FFI_OK) {
             status = 1;
@@ -278,7 +450,60 @@ int dynFunction_getFnPointer(dyn_function_type *dynFunc, void (**fn)(void)) {
     return status;
 }
 
+struct dyn_function_argument_index {
+    int nrOfArguments;
+    dyn_function_argument_type *arguments[];
+};
+
+/**
+ * Returns the argument index of the function, creating it on first use.
+ * Returns NULL if the index cannot be allocated, callers then fall back to the argument list.
+ */
+static const dyn_function_argument_index* dynFunction_argumentIndex(dyn_function_type *dynFunc) {
+    dyn_function_argument_index *index = __atomic_load_n(&dynFunc->argumentIndex, __ATOMIC_ACQUIRE);
+    if (index == NULL) {
+        int count = 0;
+        dyn_function_argument_type *entry = NULL;
+        TAILQ_FOREACH(entry, &dynFunc->arguments, entries) {
+            count += 1;
+        }
+        dyn_function_argument_index *created = malloc(sizeof(*created) + (size_t)count * sizeof(created->arguments[0]));
+        if (created != NULL) {
+            created->nrOfArguments = 0;
+            TAILQ_FOREACH(entry, &dynFunc->arguments, entries) {
+                created->arguments[created->nrOfArguments++] = entry;
+            }
+            //note if another thread created the index concurrently, that index is used
+            if (__atomic_compare_exchange_n(&dynFunc->argumentIndex, &index, created, false, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)) {
+                index = created;
+            } else {
+                free(created);
+            }
+        }
+    }
+    return index;
+}
+
+static dyn_function_argument_type* dynFunction_argumentForIndex(dyn_function_type *dynFunc, int argumentNr) {
+    const dyn_function_argument_index *index = dynFunction_argumentIndex(dynFunc);
+    if (index != NULL) {
+        return argumentNr >= 0 && argumentNr < index->nrOfArguments ? index->arguments[argumentNr] : NULL;
+    }
+    int i = 0;
+    dyn_function_argument_type *entry = NULL;
+    TAILQ_FOREACH(entry, &dynFunc->arguments, entries) {
+        if (i++ == argumentNr) {
+            break;
+        }
+    }
+    return entry;
+}
+
 int dynFunction_nrOfArguments(dyn_function_type *dynFunc) {
+    const dyn_function_argument_index *index = dynFunction_argumentIndex(dynFunc);
+    if (index != NULL) {
+        return index->nrOfArguments;
+    }
     int count = 0;
     dyn_function_argument_type *entry = NULL;
     TAILQ_FOREACH(entry, &dynFunc->arguments, entries) {
@@ -288,17 +513,8 @@ int dynFunction_nrOfArguments(dyn_function_type *dynFunc) {
 }
 
 dyn_type *dynFunction_argumentTypeForIndex(dyn_function_type *dynFunc, int argumentNr) {
-    dyn_type *result = NULL;
-    int index = 0;
-    dyn_function_argument_type *entry = NULL;
-    TAILQ_FOREACH(entry, &dynFunc->arguments, entries) {
-        if (index == argumentNr) {
-            result = entry->type;
-            break;
-        }
-        index +=1;
-    }
-    return result;
+    dyn_function_argument_type *entry = dynFunction_argumentForIndex(dynFunc, argumentNr);
+    return entry != NULL ? entry->type : NULL;
 }
 
 dyn_type * dynFunction_returnType(dyn_function_type *dynFunction) {
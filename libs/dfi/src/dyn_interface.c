@@ -25,6 +25,8 @@
 #include "dyn_common.h"
 #include "dyn_type.h"
 #include "dyn_interface_common.h"
+#include "dyn_parse_cache.h"
+#include "dfi_codec.h"
 
 DFI_SETUP_LOG(dynInterface);
 
@@ -81,6 +83,10 @@ int dynInterface_parse(FILE *descriptor, dyn_interface_type **out) {
             	LOG_ERROR("Invalid version (%s) in parsed descriptor\n",version);
             }
         }
+
+        if (status == OK) {
+            dfiCodec_attachRpcCodec(intf);
+        }
     } else {
         status = ERROR;
         LOG_ERROR("Error allocating memory for dynamic interface\n");
@@ -342,8 +348,59 @@ static int dynInterface_parseMethods(dyn_interface_type *intf, FILE *stream) {
     return status;
 }
 
+static int dynInterface_parseSharedKind(FILE *descriptor, int kind, dyn_interface_type **out) {
+    char *content = NULL;
+    size_t contentLen = 0;
+    int status = dynParseCache_readStream(descriptor, &content, &contentLen);
+    if (status != OK) {
+        LOG_ERROR("Error reading interface descriptor");
+        return status;
+    }
+
+    dyn_interface_type *intf = dynParseCache_acquire(kind, NULL, content, contentLen);
+    if (intf == NULL) {
+        FILE *stream = contentLen > 0 ? fmemopen(content, contentLen, "r") : NULL;
+        if (stream != NULL && kind == DYN_PARSE_CACHE_INTERFACE_AVPR) {
+            intf = dynInterface_parseAvpr(stream);
+            status = intf != NULL ? OK : ERROR;
+        } else if (stream != NULL) {
+            status = dynInterface_parse(stream, &intf);
+        } else {
+            status = ERROR;
+        }
+        if (stream != NULL) {
+            fclose(stream);
+        }
+        if (status == OK) {
+            intf->shared = true;
+            dyn_interface_type *cached = dynParseCache_add(kind, NULL, content, contentLen, intf);
+            if (cached != intf) {
+                intf->shared = false;
+                dynInterface_destroy(intf);
+                intf = cached;
+            }
+        }
+    }
+    free(content);
+
+    if (status == OK) {
+        *out = intf;
+    }
+    return status;
+}
+
+int dynInterface_parseShared(FILE *descriptor, dyn_interface_type **out) {
+    return dynInterface_parseSharedKind(descriptor, DYN_PARSE_CACHE_INTERFACE, out);
+}
+
+dyn_interface_type * dynInterface_parseAvprShared(FILE * avprStream) {
+    dyn_interface_type *intf = NULL;
+    dynInterface_parseSharedKind(avprStream, DYN_PARSE_CACHE_INTERFACE_AVPR, &intf);
+    return intf;
+}
+
 void dynInterface_destroy(dyn_interface_type *intf) {
-    if (intf != NULL) {
+    if (intf != NULL && (!intf->shared || dynParseCache_release(intf))) {
         dynCommon_clearNamValHead(&intf->header);
         dynCommon_clearNamValHead(&intf->annotations);
 
@@ -376,6 +433,7 @@ void dynInterface_destroy(dyn_interface_type *intf) {
         	version_destroy(intf->version);
         }
 
+        free(intf->methodIndex);
         free(intf);
     } 
 }
@@ -423,6 +481,18 @@ static int dynInterface_getEntryForHead(struct namvals_head *head, const char *n
     return status;
 }
 
+const char* dynInterface_getMethodAnnotation(dyn_interface_type *intf, const struct method_entry *method, const char *key) {
+    //note not using dynInterface_getEntryForHead, the method annotations are optional
+    size_t nameLen = strlen(method->name);
+    struct namval_entry *entry = NULL;
+    TAILQ_FOREACH(entry, &intf->annotations, entries) {
+        if (strncmp(entry->name, method->name, nameLen) == 0 && entry->name[nameLen] == '.' && strcmp(entry->name + nameLen + 1, key) == 0) {
+            return entry->value;
+        }
+    }
+    return NULL;
+}
+
 int dynInterface_methods(dyn_interface_type *intf, struct methods_head **list) {
     int status = OK;
     *list = &intf->methods;
@@ -437,3 +507,76 @@ int dynInterface_nrOfMethods(dyn_interface_type *intf) {
     }
     return count;
 }
+
+/**
+ * Open addressing hash table of the interface methods, keyed by method id.
+ */
+struct dyn_interface_method_index {
+    size_t mask;
+    struct method_entry *buckets[];
+};
+
+static size_t dynInterface_hashId(const char *id) {
+    //FNV-1a
+    size_t hash = 2166136261u;
+    for (const unsigned char *c = (const unsigned char*)id; *c != '\0'; ++c) {
+        hash = (hash ^ *c) * 16777619u;
+    }
+    return hash;
+}
+
+static const dyn_interface_method_index* dynInterface_methodIndex(dyn_interface_type *intf) {
+    dyn_interface_method_index *index = __atomic_load_n(&intf->methodIndex, __ATOMIC_ACQUIRE);
+    if (index == NULL) {
+        size_t size = 8;
+        while (size < (size_t)dynInterface_nrOfMethods(intf) * 2) {
+            size *= 2;
+        }
+        dyn_interface_method_index *created = calloc(1, sizeof(*created) + size * sizeof(created->buckets[0]));
+        if (created != NULL) {
+            created->mask = size - 1;
+            struct method_entry *entry = NULL;
+            TAILQ_FOREACH(entry, &intf->methods, entries) {
+                size_t i = dynInterface_hashId(entry->id) & created->mask;
+                while (created->buckets[i] != NULL) {
+                    i = (i + 1) & created->mask;
+                }
+                created->buckets[i] = entry;
+            }
+            //note if another thread created the index concurrently, that index is used
+            if (__atomic_compare_exchange_n(&intf->methodIndex, &index, created, false, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)) {
+                index = created;
+            } else {
+                free(created);
+            }
+        }
+    }
+    return index;
+}
+
+int dynInterface_findMethod(dyn_interface_type *intf, const char *id, struct method_entry **method) {
+    struct method_entry *found = NULL;
+    const dyn_interface_method_index *index = dynInterface_methodIndex(intf);
+    if (index != NULL) {
+        size_t i = dynInterface_hashId(id) & index->mask;
+        while (index->buckets[i] != NULL && found == NULL) {
+            if (strcmp(index->buckets[i]->id, id) == 0) {
+                found = index->buckets[i];
+            }
+            i = (i + 1) & index->mask;
+        }
+    } else {
+        struct method_entry *entry = NULL;
+        TAILQ_FOREACH(entry, &intf->methods, entries) {
+            if (strcmp(id, entry->id) == 0) {
+                found = entry;
+                break;
+            }
+        }
+    }
+    if (found == NULL) {
+        return ERROR;
+    }
+    *method = found;
+    return OK;
+}
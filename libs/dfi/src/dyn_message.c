@@ -24,6 +24,9 @@
 
 #include "dyn_common.h"
 #include "dyn_type.h"
+#include "dyn_type_common.h"
+#include "dyn_parse_cache.h"
+#include "dfi_codec.h"
 
 DFI_SETUP_LOG(dynMessage);
 
@@ -33,6 +36,7 @@ struct _dyn_message_type {
     struct types_head types;
     dyn_type *msgType;
     version_pt msgVersion;
+    bool shared; //parse result is owned by the parse cache
 };
 
 static const int OK = 0;
@@ -46,6 +50,10 @@ static int dynMessage_parseHeader(dyn_message_type *msg, FILE *stream);
 static int dynMessage_parseNameValueSection(dyn_message_type *msg, FILE *stream, struct namvals_head *head);
 static int dynMessage_checkMessage(dyn_message_type *msg);
 static int dynMessage_getEntryForHead(struct namvals_head *head, const char *name, char **value);
+static int dynMessage_enableInstancePool(dyn_message_type *msg);
+static int dynMessage_addNamVal(struct namvals_head *head, const char *name, const char *value);
+
+#define DYN_MESSAGE_DEFAULT_POOL_MAX_SEQUENCE_CAP 1024
 
 int dynMessage_parse(FILE *descriptor, dyn_message_type **out) {
     int status = OK;
@@ -86,6 +94,18 @@ int dynMessage_parse(FILE *descriptor, dyn_message_type **out) {
         	}
         }
 
+        if (status == OK) {
+            status = dynMessage_enableInstancePool(msg);
+        }
+
+        if (status == OK) {
+            char *name = NULL;
+            char *version = NULL;
+            dynMessage_getName(msg, &name);
+            dynMessage_getVersionString(msg, &version);
+            dfiCodec_attachMessageCodec(name, version, msg->msgType);
+        }
+
     } else {
         status = ERROR;
         LOG_ERROR("Error allocating memory for dynamic message\n");
@@ -100,6 +120,31 @@ int dynMessage_parse(FILE *descriptor, dyn_message_type **out) {
     return status;
 }
 
+static int dynMessage_enableInstancePool(dyn_message_type *msg) {
+    //note not using dynMessage_getAnnotationEntry, the annotations are optional
+    const char *poolSize = NULL;
+    const char *maxSeqCap = NULL;
+    struct namval_entry *entry = NULL;
+    TAILQ_FOREACH(entry, &msg->annotations, entries) {
+        if (strcmp(entry->name, "instancePool") == 0) {
+            poolSize = entry->value;
+        } else if (strcmp(entry->name, "instancePoolMaxSequenceCap") == 0) {
+            maxSeqCap = entry->value;
+        }
+    }
+    if (poolSize == NULL || msg->msgType == NULL) {
+        return OK;
+    }
+    char *end = NULL;
+    long size = strtol(poolSize, &end, 10);
+    long cap = maxSeqCap != NULL ? strtol(maxSeqCap, NULL, 10) : DYN_MESSAGE_DEFAULT_POOL_MAX_SEQUENCE_CAP;
+    if (end == poolSize || size < 0 || cap < 0 || cap > UINT32_MAX) {
+        LOG_ERROR("Invalid instancePool (%s) or instancePoolMaxSequenceCap (%s) annotation", poolSize, maxSeqCap);
+        return ERROR;
+    }
+    return dynType_enablePool(msg->msgType, (size_t)size, (uint32_t)cap) == 0 ? OK : ERROR;
+}
+
 static int dynMessage_checkMessage(dyn_message_type *msg) {
     int status = OK;
 
@@ -284,8 +329,150 @@ static int dynMessage_parseMessage(dyn_message_type *msg, FILE *stream) {
     return status;
 }
 
+int dynMessage_parseShared(FILE *descriptor, dyn_message_type **out) {
+    char *content = NULL;
+    size_t contentLen = 0;
+    int status = dynParseCache_readStream(descriptor, &content, &contentLen);
+    if (status != OK) {
+        LOG_ERROR("Error reading message descriptor");
+        return status;
+    }
+
+    dyn_message_type *msg = dynParseCache_acquire(DYN_PARSE_CACHE_MESSAGE, NULL, content, contentLen);
+    if (msg == NULL) {
+        FILE *stream = contentLen > 0 ? fmemopen(content, contentLen, "r") : NULL;
+        status = stream != NULL ? dynMessage_parse(stream, &msg) : ERROR;
+        if (stream != NULL) {
+            fclose(stream);
+        }
+        if (status == OK) {
+            msg->shared = true;
+            dyn_message_type *cached = dynParseCache_add(DYN_PARSE_CACHE_MESSAGE, NULL, content, contentLen, msg);
+            if (cached != msg) {
+                msg->shared = false;
+                dynMessage_destroy(msg);
+                msg = cached;
+            }
+        }
+    }
+    free(content);
+
+    if (status == OK) {
+        *out = msg;
+    }
+    return status;
+}
+
+dyn_message_type * dynMessage_parseAvpr(FILE *avprDescriptorStream, const char *fqn) {
+    dyn_type *type = dynType_parseAvpr(avprDescriptorStream, fqn);
+    if (type == NULL) {
+        return NULL;
+    }
+
+    dyn_message_type *msg = calloc(1, sizeof(*msg));
+    if (msg == NULL) {
+        LOG_ERROR("Error allocating memory for dynamic message\n");
+        dynType_destroy(type);
+        return NULL;
+    }
+    TAILQ_INIT(&msg->header);
+    TAILQ_INIT(&msg->annotations);
+    TAILQ_INIT(&msg->types);
+    msg->msgType = type;
+
+    //note the avpr parser adds the version and the other annotations of the record as meta info
+    const char *version = dynType_getMetaInfo(type, "version");
+    int status = dynMessage_addNamVal(&msg->header, "type", "message");
+    status = status == OK ? dynMessage_addNamVal(&msg->header, "name", dynType_getName(type)) : status;
+    status = status == OK ? dynMessage_addNamVal(&msg->header, "version", version) : status;
+    struct meta_entry *entry = NULL;
+    TAILQ_FOREACH(entry, &type->metaProperties, entries) {
+        if (status == OK && strcmp(entry->name, "version") != 0) {
+            status = dynMessage_addNamVal(&msg->annotations, entry->name, entry->value);
+        }
+    }
+
+    if (status == OK && version_createVersionFromString(version, &msg->msgVersion) != CELIX_SUCCESS) {
+        LOG_ERROR("Invalid version (%s) in parsed avpr\n", version);
+        status = ERROR;
+    }
+
+    if (status == OK) {
+        status = dynMessage_enableInstancePool(msg);
+    }
+
+    if (status == OK) {
+        dfiCodec_attachMessageCodec(dynType_getName(type), version, type);
+    } else {
+        LOG_ERROR("Error parsing avpr msg %s\n", fqn);
+        dynMessage_destroy(msg);
+        msg = NULL;
+    }
+    return msg;
+}
+
+dyn_message_type * dynMessage_parseAvprWithStr(const char *avprDescriptor, const char *fqn) {
+    FILE *stream = fmemopen((char*)avprDescriptor, strlen(avprDescriptor), "r");
+    if (stream == NULL) {
+        LOG_ERROR("Error creating mem stream for avpr descriptor string. %s", strerror(errno));
+        return NULL;
+    }
+    dyn_message_type *msg = dynMessage_parseAvpr(stream, fqn);
+    fclose(stream);
+    return msg;
+}
+
+dyn_message_type * dynMessage_parseAvprShared(FILE *avprDescriptorStream, const char *fqn) {
+    char *content = NULL;
+    size_t contentLen = 0;
+    if (dynParseCache_readStream(avprDescriptorStream, &content, &contentLen) != OK) {
+        LOG_ERROR("Error reading avpr descriptor");
+        return NULL;
+    }
+
+    //note the fqn is part of the key, every message of a protocol is cached separately
+    dyn_message_type *msg = dynParseCache_acquire(DYN_PARSE_CACHE_MESSAGE_AVPR, fqn, content, contentLen);
+    if (msg == NULL) {
+        FILE *stream = contentLen > 0 ? fmemopen(content, contentLen, "r") : NULL;
+        msg = stream != NULL ? dynMessage_parseAvpr(stream, fqn) : NULL;
+        if (stream != NULL) {
+            fclose(stream);
+        }
+        if (msg != NULL) {
+            msg->shared = true;
+            dyn_message_type *cached = dynParseCache_add(DYN_PARSE_CACHE_MESSAGE_AVPR, fqn, content, contentLen, msg);
+            if (cached != msg) {
+                msg->shared = false;
+                dynMessage_destroy(msg);
+                msg = cached;
+            }
+        }
+    }
+    free(content);
+    return msg;
+}
+
+static int dynMessage_addNamVal(struct namvals_head *head, const char *name, const char *value) {
+    struct namval_entry *entry = calloc(1, sizeof(*entry));
+    if (entry != NULL && name != NULL && value != NULL) {
+        entry->name = strdup(name);
+        entry->value = strdup(value);
+    }
+    if (entry == NULL || entry->name == NULL || entry->value == NULL) {
+        if (entry != NULL) {
+            free(entry->name);
+            free(entry->value);
+            free(entry);
+        }
+        LOG_ERROR("Error creating entry %s", name != NULL ? name : "(null)");
+        return ERROR;
+    }
+    TAILQ_INSERT_TAIL(head, entry, entries);
+    return OK;
+}
+
 void dynMessage_destroy(dyn_message_type *msg) {
-    if (msg != NULL) {
+    if (msg != NULL && (!msg->shared || dynParseCache_release(msg))) {
         dynCommon_clearNamValHead(&msg->header);
         dynCommon_clearNamValHead(&msg->annotations);
 
@@ -0,0 +1,181 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *  KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include "dyn_parse_cache.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <pthread.h>
+
+typedef struct dyn_parse_cache_entry {
+    int kind;
+    char *name;
+    uint64_t hash;
+    char *content;
+    size_t contentLen;
+    void *parsed;
+    unsigned int refCount;
+    struct dyn_parse_cache_entry *next;
+} dyn_parse_cache_entry_t;
+
+static const int OK = 0;
+static const int ERROR = 1;
+
+static pthread_mutex_t dynParseCache_mutex = PTHREAD_MUTEX_INITIALIZER;
+static dyn_parse_cache_entry_t *dynParseCache_entries = NULL; //protected by dynParseCache_mutex
+
+static uint64_t dynParseCache_hash(int kind, const char *name, const char *content, size_t contentLen) {
+    //FNV-1a
+    uint64_t hash = 14695981039346656037ULL ^ (uint64_t)kind;
+    for (const char *c = name; c != NULL && *c != '\0'; ++c) {
+        hash = (hash ^ (uint8_t)*c) * 1099511628211ULL;
+    }
+    for (size_t i = 0; i < contentLen; ++i) {
+        hash = (hash ^ (uint8_t)content[i]) * 1099511628211ULL;
+    }
+    return hash;
+}
+
+static bool dynParseCache_matches(dyn_parse_cache_entry_t *entry, int kind, const char *name, uint64_t hash, const char *content, size_t contentLen) {
+    if (entry->hash != hash || entry->kind != kind || entry->contentLen != contentLen) {
+        return false;
+    }
+    if ((entry->name == NULL) != (name == NULL) || (name != NULL && strcmp(entry->name, name) != 0)) {
+        return false;
+    }
+    return memcmp(entry->content, content, contentLen) == 0;
+}
+
+//note should be called with the mutex locked
+static dyn_parse_cache_entry_t* dynParseCache_find(int kind, const char *name, uint64_t hash, const char *content, size_t contentLen) {
+    for (dyn_parse_cache_entry_t *entry = dynParseCache_entries; entry != NULL; entry = entry->next) {
+        if (dynParseCache_matches(entry, kind, name, hash, content, contentLen)) {
+            return entry;
+        }
+    }
+    return NULL;
+}
+
+int dynParseCache_readStream(FILE *stream, char **content, size_t *contentLen) {
+    size_t cap = 1024;
+    size_t len = 0;
+    char *buf = malloc(cap);
+    while (buf != NULL) {
+        len += fread(buf + len, 1, cap - len, stream);
+        if (len < cap) {
+            break;
+        }
+        cap *= 2;
+        char *newBuf = realloc(buf, cap);
+        if (newBuf == NULL) {
+            free(buf);
+        }
+        buf = newBuf;
+    }
+    if (buf == NULL || ferror(stream)) {
+        free(buf);
+        return ERROR;
+    }
+    *content = buf;
+    *contentLen = len;
+    return OK;
+}
+
+void* dynParseCache_acquire(int kind, const char *name, const char *content, size_t contentLen) {
+    uint64_t hash = dynParseCache_hash(kind, name, content, contentLen);
+    void *result = NULL;
+    pthread_mutex_lock(&dynParseCache_mutex);
+    dyn_parse_cache_entry_t *entry = dynParseCache_find(kind, name, hash, content, contentLen);
+    if (entry != NULL) {
+        entry->refCount += 1;
+        result = entry->parsed;
+    }
+    pthread_mutex_unlock(&dynParseCache_mutex);
+    return result;
+}
+
+void* dynParseCache_add(int kind, const char *name, const char *content, size_t contentLen, void *parsed) {
+    uint64_t hash = dynParseCache_hash(kind, name, content, contentLen);
+    dyn_parse_cache_entry_t *entry = calloc(1, sizeof(*entry));
+    char *contentCopy = malloc(contentLen == 0 ? 1 : contentLen);
+    char *nameCopy = name != NULL ? strdup(name) : NULL;
+    if (entry == NULL || contentCopy == NULL || (name != NULL && nameCopy == NULL)) {
+        //note cannot cache, the caller will be the only user of the parse result
+        free(entry);
+        free(contentCopy);
+        free(nameCopy);
+        return parsed;
+    }
+    memcpy(contentCopy, content, contentLen);
+
+    void *result;
+    pthread_mutex_lock(&dynParseCache_mutex);
+    dyn_parse_cache_entry_t *existing = dynParseCache_find(kind, name, hash, content, contentLen);
+    if (existing != NULL) {
+        existing->refCount += 1;
+        result = existing->parsed;
+    } else {
+        entry->kind = kind;
+        entry->name = nameCopy;
+        entry->hash = hash;
+        entry->content = contentCopy;
+        entry->contentLen = contentLen;
+        entry->parsed = parsed;
+        entry->refCount = 1;
+        entry->next = dynParseCache_entries;
+        dynParseCache_entries = entry;
+        result = parsed;
+    }
+    pthread_mutex_unlock(&dynParseCache_mutex);
+
+    if (existing != NULL) {
+        free(entry);
+        free(contentCopy);
+        free(nameCopy);
+    }
+    return result;
+}
+
+bool dynParseCache_release(void *parsed) {
+    dyn_parse_cache_entry_t *removed = NULL;
+    bool last = true; //note also true for a result which could not be added to the cache
+    pthread_mutex_lock(&dynParseCache_mutex);
+    dyn_parse_cache_entry_t **loc = &dynParseCache_entries;
+    while (*loc != NULL) {
+        if ((*loc)->parsed == parsed) {
+            (*loc)->refCount -= 1;
+            last = (*loc)->refCount == 0;
+            if (last) {
+                removed = *loc;
+                *loc = removed->next;
+            }
+            break;
+        }
+        loc = &(*loc)->next;
+    }
+    pthread_mutex_unlock(&dynParseCache_mutex);
+
+    if (removed != NULL) {
+        free(removed->name);
+        free(removed->content);
+        free(removed);
+    }
+    return last;
+}
@@ -24,10 +24,12 @@
 #include <assert.h>
 #include <errno.h>
 #include <ffi.h>
+#include <pthread.h>
 #include <dyn_type_common.h>
 
 #include "dyn_type_common.h"
 #include "dyn_common.h"
+#include "dyn_type_plan.h"
 
 DFI_SETUP_LOG(dynType)
 
@@ -36,6 +38,19 @@ static const int ERROR = 1;
 static const int MEM_ERROR = 2;
 static const int PARSE_ERROR = 3;
 
+struct dyn_type_pool_entry {
+    void *mem;
+    uint32_t cap; //capacity of a pooled sequence buffer
+};
+
+struct dyn_type_pool {
+    pthread_mutex_t mutex;
+    size_t maxSize;
+    uint32_t maxSequenceCap;
+    size_t size; //protected by mutex
+    struct dyn_type_pool_entry *entries; //protected by mutex, zeroed instances or sequence buffers
+};
+
 static int dynType_parseWithStream(FILE *stream, const char *name, dyn_type *parent, struct types_head *refTypes, dyn_type **result);
 static void dynType_clear(dyn_type *type);
 static void dynType_clearComplex(dyn_type *type);
@@ -76,12 +91,6 @@ void dynType_freeSequenceType(dyn_type *type, void *seqLoc);
 
 static int dynType_parseMetaInfo(FILE *stream, dyn_type *type);
 
-struct generic_sequence {
-    uint32_t cap;
-    uint32_t len;
-    void *buf;
-};
-
 int dynType_parse(FILE *descriptorStream, const char *name, struct types_head *refTypes, dyn_type **type) {
     return dynType_parseWithStream(descriptorStream, name, NULL, refTypes, type);
 }
@@ -486,8 +495,21 @@ static int dynType_parseTypedPointer(FILE *stream, dyn_type *type) {
     return status;
 }
 
+static void dynType_destroyPool(struct dyn_type_pool *pool) {
+    if (pool != NULL) {
+        for (size_t i = 0; i < pool->size; ++i) {
+            free(pool->entries[i].mem);
+        }
+        free(pool->entries);
+        pthread_mutex_destroy(&pool->mutex);
+        free(pool);
+    }
+}
+
 void dynType_destroy(dyn_type *type) {
-    if (type != NULL) {          
+    if (type != NULL) {
+        dynTypePlan_destroy(type->plan);
+        dynType_destroyPool(type->pool);
         dynType_clear(type);
         free(type);
     }
@@ -570,12 +592,137 @@ static void dynType_clearTypedPointer(dyn_type *type) {
     }
 }
 
+static int dynType_createPool(dyn_type *type, size_t maxInstances, uint32_t maxSequenceCap) {
+    struct dyn_type_pool *pool = calloc(1, sizeof(*pool));
+    struct dyn_type_pool_entry *entries = calloc(maxInstances, sizeof(*entries));
+    if (pool == NULL || entries == NULL) {
+        free(pool);
+        free(entries);
+        LOG_ERROR("Error allocating memory for pool of type '%c'", type->descriptor);
+        return MEM_ERROR;
+    }
+    pthread_mutex_init(&pool->mutex, NULL);
+    pool->maxSize = maxInstances;
+    pool->maxSequenceCap = maxSequenceCap;
+    pool->entries = entries;
+    type->pool = pool;
+    return OK;
+}
+
+/**
+ * Enables the pools of the types which are allocated separately when a type instance is allocated or deserialized:
+ * the buffers of sequences and the instances behind typed pointers. Embedded complex members have no pool of their
+ * own, but their members are visited. A type which already has a pool is not visited again, which also ends the
+ * recursion for recursive types.
+ */
+static int dynType_enableNestedPools(dyn_type *type, size_t maxInstances, uint32_t maxSequenceCap) {
+    int status = OK;
+    dyn_type *sub = NULL;
+    struct complex_type_entry *entry = NULL;
+    if (type->type == DYN_TYPE_REF) {
+        type = type->ref.ref;
+    }
+    switch (type->type) {
+        case DYN_TYPE_COMPLEX :
+            TAILQ_FOREACH(entry, &type->complex.entriesHead, entries) {
+                status = dynType_enableNestedPools(entry->type, maxInstances, maxSequenceCap);
+                if (status != OK) {
+                    break;
+                }
+            }
+            break;
+        case DYN_TYPE_SEQUENCE :
+            if (type->pool == NULL) {
+                status = dynType_createPool(type, maxInstances, maxSequenceCap);
+                if (status == OK) {
+                    status = dynType_enableNestedPools(type->sequence.itemType, maxInstances, maxSequenceCap);
+                }
+            }
+            break;
+        case DYN_TYPE_TYPED_POINTER :
+            dynType_typedPointer_getTypedType(type, &sub);
+            if (sub->pool == NULL) {
+                status = dynType_createPool(sub, maxInstances, maxSequenceCap);
+                if (status == OK) {
+                    status = dynType_enableNestedPools(sub, maxInstances, maxSequenceCap);
+                }
+            }
+            break;
+    }
+    return status;
+}
+
+int dynType_enablePool(dyn_type *type, size_t maxInstances, uint32_t maxSequenceCap) {
+    if (type->type == DYN_TYPE_REF) {
+        type = type->ref.ref;
+    }
+    if (type->pool != NULL || maxInstances == 0) {
+        return OK;
+    }
+    int status = dynType_createPool(type, maxInstances, maxSequenceCap);
+    if (status == OK) {
+        status = dynType_enableNestedPools(type, maxInstances, maxSequenceCap);
+    }
+    return status;
+}
+
+bool dynType_hasPool(dyn_type *type) {
+    if (type->type == DYN_TYPE_REF) {
+        type = type->ref.ref;
+    }
+    return type->pool != NULL;
+}
+
+/**
+ * Takes a pooled instance or a pooled sequence buffer with at least minCap capacity. Returns NULL if the pool has none.
+ */
+static void* dynType_poolTake(struct dyn_type_pool *pool, uint32_t minCap, uint32_t *capOut) {
+    void *mem = NULL;
+    pthread_mutex_lock(&pool->mutex);
+    for (size_t i = pool->size; i > 0; --i) {
+        if (pool->entries[i - 1].cap >= minCap) {
+            mem = pool->entries[i - 1].mem;
+            if (capOut != NULL) {
+                *capOut = pool->entries[i - 1].cap;
+            }
+            pool->size -= 1;
+            pool->entries[i - 1] = pool->entries[pool->size];
+            break;
+        }
+    }
+    pthread_mutex_unlock(&pool->mutex);
+    return mem;
+}
+
+/**
+ * Resets and pools the instance or sequence buffer. Returns false if the memory is not pooled and should be freed.
+ */
+static bool dynType_poolRelease(struct dyn_type_pool *pool, void *mem, size_t memSize, uint32_t cap) {
+    if (pool == NULL || cap > pool->maxSequenceCap) {
+        return false;
+    }
+    bool pooled = false;
+    memset(mem, 0, memSize);
+    pthread_mutex_lock(&pool->mutex);
+    if (pool->size < pool->maxSize) {
+        pool->entries[pool->size].mem = mem;
+        pool->entries[pool->size].cap = cap;
+        pool->size += 1;
+        pooled = true;
+    }
+    pthread_mutex_unlock(&pool->mutex);
+    return pooled;
+}
+
 int dynType_alloc(dyn_type *type, void **bufLoc) {
     assert(type->type != DYN_TYPE_REF);
     assert(type->ffiType->size != 0);
     int status = OK;
 
-    void *inst = calloc(1, type->ffiType->size);
+    void *inst = type->pool != NULL ? dynType_poolTake(type->pool, 0, NULL) : NULL;
+    if (inst == NULL) {
+        inst = calloc(1, type->ffiType->size);
+    }
     if (inst != NULL) {
         if (type->type == DYN_TYPE_TYPED_POINTER) {
             void *ptr = NULL;
@@ -631,6 +778,11 @@ int dynType_complex_setValueAt(dyn_type *type, int index, void *start, void *in)
     return 0;
 }
 
+size_t dynType_complex_offsetAt(dyn_type *type, int index) {
+    assert(type->type == DYN_TYPE_COMPLEX);
+    return dynType_getOffset(type, index);
+}
+
 int dynType_complex_valLocAt(dyn_type *type, int index, void *inst, void **result) {
     assert(type->type == DYN_TYPE_COMPLEX);
     char *l = (char *)inst;
@@ -662,7 +814,14 @@ int dynType_sequence_alloc(dyn_type *type, void *inst, uint32_t cap) {
     struct generic_sequence *seq = inst;
     if (seq != NULL) {
         size_t size = dynType_size(type->sequence.itemType);
-        seq->buf = calloc(cap, size);
+        uint32_t pooledCap = 0;
+        seq->buf = type->pool != NULL && cap > 0 ? dynType_poolTake(type->pool, cap, &pooledCap) : NULL;
+        if (seq->buf != NULL) {
+            //note a pooled buffer can have a larger capacity than requested
+            cap = pooledCap;
+        } else {
+            seq->buf = calloc(cap, size);
+        }
         if (seq->buf != NULL) {
             seq->cap = cap;
             seq->len = 0;;
@@ -678,6 +837,32 @@ int dynType_sequence_alloc(dyn_type *type, void *inst, uint32_t cap) {
     return status;
 }
 
+int dynType_allocInArena(dyn_type *type, celix_arena_t *arena, void **bufLoc) {
+    assert(type->type != DYN_TYPE_REF);
+    assert(type->ffiType->size != 0);
+    void *inst = celix_arena_calloc(arena, 1, type->ffiType->size);
+    if (inst == NULL) {
+        LOG_ERROR("Error allocating memory for type '%c'", type->descriptor);
+        return MEM_ERROR;
+    }
+    *bufLoc = inst;
+    return OK;
+}
+
+int dynType_sequence_allocInArena(dyn_type *type, void *inst, uint32_t cap, celix_arena_t *arena) {
+    assert(type->type == DYN_TYPE_SEQUENCE);
+    struct generic_sequence *seq = inst;
+    seq->len = 0;
+    seq->cap = 0;
+    seq->buf = celix_arena_calloc(arena, cap, dynType_size(type->sequence.itemType));
+    if (seq->buf == NULL && cap > 0) {
+        LOG_ERROR("Error allocating memory for buf");
+        return MEM_ERROR;
+    }
+    seq->cap = cap;
+    return OK;
+}
+
 void dynType_free(dyn_type *type, void *loc) {
     dynType_deepFree(type, loc, true);
 }
@@ -703,12 +888,122 @@ void dynType_deepFree(dyn_type *type, void *loc, bool alsoDeleteSelf) {
                 break;
         }
 
-        if (alsoDeleteSelf) {
+        if (alsoDeleteSelf && !dynType_poolRelease(type->pool, loc, dynType_size(type), 0)) {
             free(loc);
         }
     }
 }
 
+bool dynType_isPod(dyn_type *type) {
+    if (type->type == DYN_TYPE_REF) {
+        type = type->ref.ref;
+    }
+    bool pod;
+    struct complex_type_entry *entry = NULL;
+    switch (type->type) {
+        case DYN_TYPE_SIMPLE :
+            pod = type->descriptor != 'P'; //note untyped pointers are simple types
+            break;
+        case DYN_TYPE_COMPLEX :
+            pod = true;
+            TAILQ_FOREACH(entry, &type->complex.entriesHead, entries) {
+                if (!dynType_isPod(entry->type)) {
+                    pod = false;
+                    break;
+                }
+            }
+            break;
+        default :
+            pod = false;
+            break;
+    }
+    return pod;
+}
+
+static int dynType_copyInto(dyn_type *type, const void *src, void *dst);
+
+int dynType_copy(dyn_type *type, const void *src, void **out) {
+    if (type->type == DYN_TYPE_REF) {
+        type = type->ref.ref;
+    }
+    void *inst = calloc(1, dynType_size(type));
+    if (inst == NULL) {
+        LOG_ERROR("Error allocating memory for type '%c'", type->descriptor);
+        return MEM_ERROR;
+    }
+    int status = dynType_copyInto(type, src, inst);
+    if (status == OK) {
+        *out = inst;
+    } else {
+        dynType_free(type, inst);
+    }
+    return status;
+}
+
+static int dynType_copyInto(dyn_type *type, const void *src, void *dst) {
+    if (type->type == DYN_TYPE_REF) {
+        type = type->ref.ref;
+    }
+    int status = OK;
+    int index = 0;
+    struct complex_type_entry *entry = NULL;
+    const struct generic_sequence *srcSeq = NULL;
+    struct generic_sequence *dstSeq = NULL;
+    dyn_type *subType = NULL;
+    const char *text = NULL;
+    switch (type->type) {
+        case DYN_TYPE_COMPLEX :
+            TAILQ_FOREACH(entry, &type->complex.entriesHead, entries) {
+                void *srcLoc = NULL;
+                void *dstLoc = NULL;
+                dynType_complex_valLocAt(type, index, (void*)src, &srcLoc);
+                dynType_complex_valLocAt(type, index, dst, &dstLoc);
+                index += 1;
+                status = dynType_copyInto(entry->type, srcLoc, dstLoc);
+                if (status != OK) {
+                    break;
+                }
+            }
+            break;
+        case DYN_TYPE_SEQUENCE :
+            //note the copy only gets the capacity needed for the used length
+            srcSeq = src;
+            dstSeq = dst;
+            subType = dynType_sequence_itemType(type);
+            if (srcSeq->len > 0) {
+                status = dynType_sequence_alloc(type, dstSeq, srcSeq->len);
+            }
+            for (uint32_t i = 0; status == OK && i < srcSeq->len; ++i) {
+                size_t itemSize = dynType_size(subType);
+                status = dynType_copyInto(subType, (const char*)srcSeq->buf + i * itemSize, (char*)dstSeq->buf + i * itemSize);
+                //note increasing len per item, so that a failed copy only frees the copied items
+                dstSeq->len = i + 1;
+            }
+            break;
+        case DYN_TYPE_TYPED_POINTER :
+            if (*(void * const *)src != NULL) {
+                dynType_typedPointer_getTypedType(type, &subType);
+                status = dynType_copy(subType, *(void * const *)src, (void **)dst);
+            }
+            break;
+        case DYN_TYPE_TEXT :
+            text = *(const char * const *)src;
+            if (text != NULL) {
+                *(char **)dst = strdup(text);
+                if (*(char **)dst == NULL) {
+                    status = MEM_ERROR;
+                    LOG_ERROR("Error allocating memory for text");
+                }
+            }
+            break;
+        default :
+            //simple and enum values
+            memcpy(dst, src, dynType_size(type));
+            break;
+    }
+    return status;
+}
+
 void dynType_freeSequenceType(dyn_type *type, void *seqLoc) {
     struct generic_sequence *seq = seqLoc;
     dyn_type *itemType = dynType_sequence_itemType(type);
@@ -718,7 +1013,10 @@ void dynType_freeSequenceType(dyn_type *type, void *seqLoc) {
         dynType_sequence_locForIndex(type, seqLoc, i, &itemLoc);
         dynType_deepFree(itemType, itemLoc, false);
     }
-    free(seq->buf);
+    if (seq->buf == NULL || seq->cap == 0 ||
+            !dynType_poolRelease(type->pool, seq->buf, seq->cap * dynType_size(itemType), seq->cap)) {
+        free(seq->buf);
+    }
 }
 
 void dynType_freeComplexType(dyn_type *type, void *loc) {
@@ -943,6 +1241,18 @@ int dynType_text_allocAndInit(dyn_type *type, void *textLoc, const char *value)
 
 
 
+int dynType_text_initInArena(dyn_type *type, void *textLoc, const char *value, size_t len, celix_arena_t *arena) {
+    assert(type->type == DYN_TYPE_TEXT);
+    char *str = celix_arena_malloc(arena, len + 1);
+    if (str == NULL) {
+        LOG_ERROR("Cannot allocate memory for string");
+        return ERROR;
+    }
+    memcpy(str, value, len);
+    str[len] = '\0';
+    *(char **)textLoc = str;
+    return OK;
+}
 
 
 void dynType_print(dyn_type *type, FILE *stream) {
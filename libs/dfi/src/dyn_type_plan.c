@@ -0,0 +1,264 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *  KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include "dyn_type_plan.h"
+#include "dyn_type_common.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+#include <stdio.h>
+
+struct dyn_type_plan {
+    size_t nrOfSteps;
+    size_t cap;
+    dyn_type_plan_step_t *steps;
+};
+
+static const int OK = 0;
+static const int ERROR = 1;
+
+static dyn_type* dynTypePlan_resolve(dyn_type *type) {
+    return type->type == DYN_TYPE_REF ? type->ref.ref : type;
+}
+
+static int dynTypePlan_addStep(dyn_type_plan *plan, const dyn_type_plan_step_t *step) {
+    if (plan->nrOfSteps == plan->cap) {
+        size_t newCap = plan->cap == 0 ? 8 : plan->cap * 2;
+        dyn_type_plan_step_t *newSteps = realloc(plan->steps, newCap * sizeof(*newSteps));
+        if (newSteps == NULL) {
+            return ERROR;
+        }
+        plan->steps = newSteps;
+        plan->cap = newCap;
+    }
+    plan->steps[plan->nrOfSteps++] = *step;
+    return OK;
+}
+
+static int dynTypePlan_compileAny(dyn_type_plan *plan, dyn_type *type, size_t offset, const char *name) {
+    int status = OK;
+    dyn_type *resolved = dynTypePlan_resolve(type);
+    dyn_type_plan_step_t step;
+    memset(&step, 0, sizeof(step));
+    step.descriptor = dynType_descriptorType(resolved);
+    step.offset = offset;
+    step.name = name;
+    step.type = resolved;
+
+    switch (resolved->type) {
+        case DYN_TYPE_COMPLEX : {
+            step.kind = DYN_TYPE_PLAN_BEGIN_COMPLEX;
+            size_t begin = plan->nrOfSteps;
+            status = dynTypePlan_addStep(plan, &step);
+            struct complex_type_entry *entry = NULL;
+            int index = 0;
+            TAILQ_FOREACH(entry, &resolved->complex.entriesHead, entries) {
+                if (status != OK) {
+                    break;
+                }
+                status = dynTypePlan_compileAny(plan, resolved->complex.types[index], offset + dynType_complex_offsetAt(resolved, index), entry->name);
+                index += 1;
+            }
+            if (status == OK) {
+                step.kind = DYN_TYPE_PLAN_END_COMPLEX;
+                status = dynTypePlan_addStep(plan, &step);
+            }
+            if (status == OK) {
+                plan->steps[begin].end = plan->nrOfSteps - 1;
+            }
+            break;
+        }
+        case DYN_TYPE_SEQUENCE :
+            step.kind = DYN_TYPE_PLAN_VALUE;
+            step.subType = dynType_sequence_itemType(resolved);
+            step.subTypeSize = dynType_size(step.subType);
+            status = dynTypePlan_addStep(plan, &step);
+            break;
+        case DYN_TYPE_TYPED_POINTER :
+            step.kind = DYN_TYPE_PLAN_VALUE;
+            dynType_typedPointer_getTypedType(resolved, &step.subType);
+            status = dynTypePlan_addStep(plan, &step);
+            break;
+        default :
+            step.kind = DYN_TYPE_PLAN_VALUE;
+            status = dynTypePlan_addStep(plan, &step);
+            break;
+    }
+    return status;
+}
+
+static dyn_type_plan* dynTypePlan_compile(dyn_type *type) {
+    dyn_type_plan *plan = calloc(1, sizeof(*plan));
+    if (plan != NULL && dynTypePlan_compileAny(plan, type, 0, NULL) != OK) {
+        dynTypePlan_destroy(plan);
+        plan = NULL;
+    }
+    return plan;
+}
+
+const dyn_type_plan* dynType_plan(dyn_type *type) {
+    dyn_type_plan *plan = __atomic_load_n(&type->plan, __ATOMIC_ACQUIRE);
+    if (plan == NULL) {
+        dyn_type_plan *compiled = dynTypePlan_compile(type);
+        if (compiled != NULL) {
+            //note if another thread compiled the plan concurrently, that plan is used
+            if (__atomic_compare_exchange_n(&type->plan, &plan, compiled, false, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)) {
+                plan = compiled;
+            } else {
+                dynTypePlan_destroy(compiled);
+            }
+        }
+    }
+    return plan;
+}
+
+size_t dynTypePlan_nrOfSteps(const dyn_type_plan *plan) {
+    return plan->nrOfSteps;
+}
+
+const dyn_type_plan_step_t* dynTypePlan_steps(const dyn_type_plan *plan) {
+    return plan->steps;
+}
+
+int dynType_primitiveNumber(dyn_type *type) {
+    const dyn_type_plan *plan = dynType_plan(type);
+    if (plan == NULL || plan->nrOfSteps != 1 || plan->steps[0].kind != DYN_TYPE_PLAN_VALUE) {
+        return 0;
+    }
+    int descriptor = plan->steps[0].descriptor;
+    return descriptor != '\0' && strchr("BSIJbsijNFD", descriptor) != NULL ? descriptor : 0;
+}
+
+static const char* dynTypePlan_enumName(dyn_type *type, int32_t value) {
+    char valueStr[32];
+    snprintf(valueStr, sizeof(valueStr), "%d", value);
+    struct meta_entry *entry = NULL;
+    TAILQ_FOREACH(entry, &type->metaProperties, entries) {
+        if (strcmp(valueStr, entry->value) == 0) {
+            return entry->name;
+        }
+    }
+    return NULL;
+}
+
+static void dynTypePlan_setProperty(const dyn_type_plan_step_t *step, const char *loc, const char *key, celix_properties_t *props) {
+    switch (step->descriptor) {
+        case 'Z' :
+            celix_properties_setBool(props, key, *(const bool*)loc);
+            break;
+        case 'B' :
+            celix_properties_setLong(props, key, *(const char*)loc);
+            break;
+        case 'S' :
+            celix_properties_setLong(props, key, *(const int16_t*)loc);
+            break;
+        case 'I' :
+            celix_properties_setLong(props, key, *(const int32_t*)loc);
+            break;
+        case 'J' :
+            celix_properties_setLong(props, key, (long)*(const int64_t*)loc);
+            break;
+        case 'b' :
+            celix_properties_setLong(props, key, *(const uint8_t*)loc);
+            break;
+        case 's' :
+            celix_properties_setLong(props, key, *(const uint16_t*)loc);
+            break;
+        case 'i' :
+            celix_properties_setLong(props, key, (long)*(const uint32_t*)loc);
+            break;
+        case 'j' :
+            celix_properties_setLong(props, key, (long)*(const uint64_t*)loc);
+            break;
+        case 'N' :
+            celix_properties_setLong(props, key, *(const int*)loc);
+            break;
+        case 'F' :
+            celix_properties_setDouble(props, key, *(const float*)loc);
+            break;
+        case 'D' :
+            celix_properties_setDouble(props, key, *(const double*)loc);
+            break;
+        case 't' : {
+            const char *text = *(const char**)loc;
+            if (text != NULL) {
+                celix_properties_set(props, key, text);
+            }
+            break;
+        }
+        case 'E' : {
+            const char *name = dynTypePlan_enumName(step->type, *(const int32_t*)loc);
+            if (name != NULL) {
+                celix_properties_set(props, key, name);
+            } else {
+                celix_properties_setLong(props, key, *(const int32_t*)loc);
+            }
+            break;
+        }
+        default :
+            //sequences and pointers are not added
+            break;
+    }
+}
+
+int dynType_toProperties(dyn_type *type, const void *inst, celix_properties_t *props) {
+    const dyn_type_plan *plan = dynType_plan(type);
+    if (plan == NULL || inst == NULL) {
+        return ERROR;
+    }
+
+    //note the plan flattens nested complex types, prefix holds the dotted path of the current complex type
+    char prefix[256];
+    size_t prefixLens[32];
+    size_t depth = 0;
+    prefix[0] = '\0';
+    int status = OK;
+    for (size_t i = 0; i < plan->nrOfSteps && status == OK; ++i) {
+        const dyn_type_plan_step_t *step = &plan->steps[i];
+        if (step->kind == DYN_TYPE_PLAN_BEGIN_COMPLEX) {
+            size_t len = depth == 0 ? 0 : prefixLens[depth - 1];
+            if (depth == sizeof(prefixLens) / sizeof(prefixLens[0])) {
+                status = ERROR;
+            } else if (step->name != NULL) {
+                int n = snprintf(prefix + len, sizeof(prefix) - len, "%s.", step->name);
+                status = n > 0 && (size_t)n < sizeof(prefix) - len ? OK : ERROR;
+                len += n > 0 ? (size_t)n : 0;
+            }
+            if (status == OK) {
+                prefixLens[depth++] = len;
+            }
+        } else if (step->kind == DYN_TYPE_PLAN_END_COMPLEX) {
+            depth -= 1;
+            prefix[depth == 0 ? 0 : prefixLens[depth - 1]] = '\0';
+        } else if (step->name != NULL) {
+            char key[512];
+            snprintf(key, sizeof(key), "%s%s", prefix, step->name);
+            dynTypePlan_setProperty(step, (const char*)inst + step->offset, key, props);
+        }
+    }
+    return status;
+}
+
+void dynTypePlan_destroy(dyn_type_plan *plan) {
+    if (plan != NULL) {
+        free(plan->steps);
+        free(plan);
+    }
+}
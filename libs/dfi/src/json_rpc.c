@@ -21,12 +21,20 @@
 #include "json_serializer.h"
 #include "dyn_type.h"
 #include "dyn_interface.h"
+#include "dyn_interface_common.h"
+#include "dyn_function_common.h"
+#include "dfi_codec.h"
+#include "celix_probes.h"
 #include <jansson.h>
 #include <assert.h>
 #include <stdint.h>
+#include <stdlib.h>
 #include <string.h>
+#include <pthread.h>
 #include <ffi.h>
 
+#define JSON_RPC_ARG_ALIGNMENT 16
+
 static int OK = 0;
 static int ERROR = 1;
 
@@ -39,45 +47,147 @@ struct generic_service_layout {
 	gen_func_type methods[];
 };
 
+/**
+ * Per thread storage for the (top level) call arguments of jsonRpc_call, reused for every call on a thread.
+ */
+typedef struct json_rpc_arg_buffer {
+	void *buf;
+	size_t size;
+	bool inUse;
+} json_rpc_arg_buffer_t;
+
+static pthread_key_t g_argBufferKey;
+static pthread_once_t g_argBufferKeyOnce = PTHREAD_ONCE_INIT;
+
+static void jsonRpc_destroyArgBuffer(void *data) {
+	json_rpc_arg_buffer_t *argBuffer = data;
+	free(argBuffer->buf);
+	free(argBuffer);
+}
+
+static void jsonRpc_createArgBufferKey(void) {
+	pthread_key_create(&g_argBufferKey, jsonRpc_destroyArgBuffer);
+}
+
+/**
+ * Returns zeroed memory of at least size bytes. Uses the thread's argument buffer, unless that buffer is already in
+ * use (a nested call on the same thread), then memory is allocated for the call.
+ */
+static void* jsonRpc_acquireArgBuffer(size_t size) {
+	pthread_once(&g_argBufferKeyOnce, jsonRpc_createArgBufferKey);
+	json_rpc_arg_buffer_t *argBuffer = pthread_getspecific(g_argBufferKey);
+	if (argBuffer == NULL) {
+		argBuffer = calloc(1, sizeof(*argBuffer));
+		if (argBuffer != NULL && pthread_setspecific(g_argBufferKey, argBuffer) != 0) {
+			free(argBuffer);
+			argBuffer = NULL;
+		}
+	}
+	if (argBuffer == NULL || argBuffer->inUse) {
+		return calloc(1, size);
+	}
+	if (argBuffer->size < size) {
+		void *buf = realloc(argBuffer->buf, size);
+		if (buf == NULL) {
+			return calloc(1, size);
+		}
+		argBuffer->buf = buf;
+		argBuffer->size = size;
+	}
+	memset(argBuffer->buf, 0, size);
+	argBuffer->inUse = true;
+	return argBuffer->buf;
+}
+
+static inline size_t jsonRpc_alignedSize(size_t size) {
+	return (size + JSON_RPC_ARG_ALIGNMENT - 1) & ~((size_t)JSON_RPC_ARG_ALIGNMENT - 1);
+}
+
+static void jsonRpc_releaseArgBuffer(void *buf) {
+	json_rpc_arg_buffer_t *argBuffer = pthread_getspecific(g_argBufferKey);
+	if (argBuffer != NULL && argBuffer->buf == buf && argBuffer->inUse) {
+		argBuffer->inUse = false;
+	} else {
+		free(buf);
+	}
+}
+
+static int jsonRpc_callJson(dyn_interface_type *intf, void *service, const char *request, json_t *js_request, json_t **out);
+
 int jsonRpc_call(dyn_interface_type *intf, void *service, const char *request, char **out) {
 	int status = OK;
 
-	dyn_type* returnType = NULL;
+	if (intf->codec != NULL) {
+		status = intf->codec->call(intf, service, request, out);
+		if (status != DFI_CODEC_UNSUPPORTED) {
+			return status;
+		}
+		status = OK;
+	}
 
 	LOG_DEBUG("Parsing data: %s\n", request);
 	json_error_t error;
 	json_t *js_request = json_loads(request, 0, &error);
-	json_t *arguments = NULL;
-	const char *sig;
-	if (js_request) {
-		if (json_unpack(js_request, "{s:s}", "m", &sig) != 0) {
-			LOG_ERROR("Got json error '%s'\n", error.text);
-		} else {
-			arguments = json_object_get(js_request, "a");
-		}
-	} else {
+	if (js_request == NULL) {
 		LOG_ERROR("Got json error '%s' for '%s'\n", error.text, request);
 		return 0;
 	}
 
-	LOG_DEBUG("Looking for method %s\n", sig);
-	struct methods_head *methods = NULL;
-	dynInterface_methods(intf, &methods);
-	struct method_entry *entry = NULL;
-	struct method_entry *method = NULL;
-	TAILQ_FOREACH(entry, methods, entries) {
-		if (strcmp(sig, entry->id) == 0) {
-			method = entry;
-			break;
+	json_t *payload = NULL;
+	if (json_is_array(js_request)) {
+		//batch request, every call gets its reply at the same index. A failed call gets a null reply
+		payload = json_array();
+		size_t i;
+		json_t *call;
+		json_array_foreach(js_request, i, call) {
+			json_t *callPayload = NULL;
+			if (jsonRpc_callJson(intf, service, request, call, &callPayload) != OK) {
+				callPayload = json_null();
+			}
+			json_array_append_new(payload, callPayload);
 		}
+	} else {
+		status = jsonRpc_callJson(intf, service, request, js_request, &payload);
+	}
+	json_decref(js_request);
+
+	char *response = NULL;
+	if (status == OK) {
+		response = json_dumps(payload, JSON_DECODE_ANY);
+		LOG_DEBUG("response is '%s'\n", response);
+		json_decref(payload);
+	}
+
+	if (status == OK) {
+		*out = response;
+	}
+
+	return status;
+}
+
+static int jsonRpc_callJson(dyn_interface_type *intf, void *service, const char *request __attribute__((unused)), json_t *js_request, json_t **out) {
+	int status = OK;
+
+	dyn_type* returnType = NULL;
+
+	json_t *arguments = NULL;
+	const char *sig = NULL;
+	if (json_unpack(js_request, "{s:s}", "m", &sig) != 0) {
+		LOG_ERROR("Missing method in json request\n");
+		return ERROR;
+	} else {
+		arguments = json_object_get(js_request, "a");
 	}
+	CELIX_PROBE2(json_rpc_call, sig, strlen(request));
 
-	if (method == NULL) {
+	LOG_DEBUG("Looking for method %s\n", sig);
+	struct method_entry *method = NULL;
+	if (dynInterface_findMethod(intf, sig, &method) != OK) {
 		status = ERROR;
 		LOG_ERROR("Cannot find method with sig '%s'", sig);
 	}
 	else if (status == OK) {
-		LOG_DEBUG("RSA: found method '%s'\n", entry->id);
+		LOG_DEBUG("RSA: found method '%s'\n", method->id);
 		returnType = dynFunction_returnType(method->dynFunc);
 	}
 
@@ -92,26 +202,46 @@ int jsonRpc_call(dyn_interface_type *intf, void *service, const char *request, c
 	dyn_function_type *func = NULL;
 	int nrOfArgs = 0;
 	if (status == OK) {
-		nrOfArgs = dynFunction_nrOfArguments(entry->dynFunc);
-		func = entry->dynFunc;
+		nrOfArgs = dynFunction_nrOfArguments(method->dynFunc);
+		func = method->dynFunc;
 	}
 
-	void *args[nrOfArgs];
+	void *args[nrOfArgs > 0 ? nrOfArgs : 1];
+	memset(args, 0, sizeof(args));
+
+	//the standard arguments are deserialized in a (reused) argument buffer instead of separately allocated
+	size_t argBufferSize = 0;
+	char *argBuffer = NULL;
+	int i;
+	for (i = 0; i < nrOfArgs; i += 1) {
+		if (dynFunction_argumentMetaForIndex(func, i) == DYN_FUNCTION_ARGUMENT_META__STD) {
+			argBufferSize += jsonRpc_alignedSize(dynType_size(dynFunction_argumentTypeForIndex(func, i)));
+		}
+	}
+	if (argBufferSize > 0) {
+		argBuffer = jsonRpc_acquireArgBuffer(argBufferSize);
+		if (argBuffer == NULL) {
+			LOG_ERROR("Cannot allocate memory for arguments");
+			status = ERROR;
+		}
+	}
 
 	json_t *value = NULL;
 
-	int i;
 	int index = 0;
+	size_t argOffset = 0;
 
 	void *ptr = NULL;
 	void *ptrToPtr = &ptr;
 
-	for (i = 0; i < nrOfArgs; i += 1) {
+	for (i = 0; i < nrOfArgs && status == OK; i += 1) {
 		dyn_type *argType = dynFunction_argumentTypeForIndex(func, i);
 		enum dyn_function_argument_meta  meta = dynFunction_argumentMetaForIndex(func, i);
 		if (meta == DYN_FUNCTION_ARGUMENT_META__STD) {
 			value = json_array_get(arguments, index++);
-			status = jsonSerializer_deserializeJson(argType, value, &(args[i]));
+			args[i] = argBuffer + argOffset;
+			argOffset += jsonRpc_alignedSize(dynType_size(argType));
+			status = jsonSerializer_deserializeJsonInto(argType, value, args[i]);
 		} else if (meta == DYN_FUNCTION_ARGUMENT_META__PRE_ALLOCATED_OUTPUT) {
 			dynType_alloc(argType, &args[i]);
 		} else if (meta == DYN_FUNCTION_ARGUMENT_META__OUTPUT) {
@@ -124,7 +254,6 @@ int jsonRpc_call(dyn_interface_type *intf, void *service, const char *request, c
 			break;
 		}
 	}
-	json_decref(js_request);
 
 	if (status == OK) {
 		if (dynType_descriptorType(returnType) != 'N') {
@@ -150,9 +279,12 @@ int jsonRpc_call(dyn_interface_type *intf, void *service, const char *request, c
 		dyn_type *argType = dynFunction_argumentTypeForIndex(func, i);
 		enum dyn_function_argument_meta  meta = dynFunction_argumentMetaForIndex(func, i);
 		if (meta == DYN_FUNCTION_ARGUMENT_META__STD) {
-			dynType_free(argType, args[i]);
+			dynType_deepFree(argType, args[i], false);
 		}
 	}
+	if (argBuffer != NULL) {
+		jsonRpc_releaseArgBuffer(argBuffer);
+	}
 
 	if (funcCallStatus == 0 && status == OK) {
 		for (i = 0; i < nrOfArgs; i += 1) {
@@ -198,7 +330,6 @@ int jsonRpc_call(dyn_interface_type *intf, void *service, const char *request, c
 		}
 	}
 
-	char *response = NULL;
 	if (status == OK) {
 		LOG_DEBUG("creating payload\n");
 		json_t *payload = json_object();
@@ -213,15 +344,9 @@ int jsonRpc_call(dyn_interface_type *intf, void *service, const char *request, c
 			LOG_DEBUG("Setting error payload");
 			json_object_set_new(payload, "e", json_integer(funcCallStatus));
 		}
-		response = json_dumps(payload, JSON_DECODE_ANY);
-		json_decref(payload);
-		LOG_DEBUG("status ptr is %p. response is '%s'\n", status, response);
-	}
-
-	if (status == OK) {
-		*out = response;
-	} else {
-		free(response);
+		*out = payload;
+	} else if (jsonResult != NULL) {
+		json_decref(jsonResult);
 	}
 
 	return status;
@@ -230,6 +355,13 @@ int jsonRpc_call(dyn_interface_type *intf, void *service, const char *request, c
 int jsonRpc_prepareInvokeRequest(dyn_function_type *func, const char *id, void *args[], char **out) {
 	int status = OK;
 
+	if (func->codec != NULL) {
+		status = func->codec->prepareRequest(func, id, args, out);
+		if (status != DFI_CODEC_UNSUPPORTED) {
+			return status;
+		}
+		status = OK;
+	}
 
 	LOG_DEBUG("Calling remote function '%s'\n", id);
 	json_t *invoke = json_object();
@@ -271,6 +403,14 @@ int jsonRpc_prepareInvokeRequest(dyn_function_type *func, const char *id, void *
 int jsonRpc_handleReply(dyn_function_type *func, const char *reply, void *args[]) {
 	int status = OK;
 
+	if (func->codec != NULL && func->codec->handleReply != NULL) {
+		status = func->codec->handleReply(func, reply, args);
+		if (status != DFI_CODEC_UNSUPPORTED) {
+			return status;
+		}
+		status = OK;
+	}
+
 	json_error_t error;
 	json_t *replyJson = json_loads(reply, JSON_DECODE_ANY, &error);
 	if (replyJson == NULL) {
@@ -339,3 +479,52 @@ int jsonRpc_handleReply(dyn_function_type *func, const char *reply, void *args[]
 
 	return status;
 }
+
+int jsonRpc_prepareBatchRequest(char * const requests[], size_t count, char **out) {
+	size_t len = 2; //[]
+	size_t i;
+	for (i = 0; i < count; i += 1) {
+		len += strlen(requests[i]) + 1;
+	}
+
+	char *batch = malloc(len + 1);
+	if (batch == NULL) {
+		return ERROR;
+	}
+
+	char *pos = batch;
+	*pos++ = '[';
+	for (i = 0; i < count; i += 1) {
+		size_t reqLen = strlen(requests[i]);
+		if (i > 0) {
+			*pos++ = ',';
+		}
+		memcpy(pos, requests[i], reqLen);
+		pos += reqLen;
+	}
+	*pos++ = ']';
+	*pos = '\0';
+
+	*out = batch;
+	return OK;
+}
+
+int jsonRpc_splitBatchReply(const char *reply, size_t count, char *replies[]) {
+	int status = OK;
+
+	json_error_t error;
+	json_t *replyJson = json_loads(reply, JSON_DECODE_ANY, &error);
+	if (replyJson == NULL || !json_is_array(replyJson) || json_array_size(replyJson) != count) {
+		LOG_ERROR("Invalid json batch reply, expected %zu replies", count);
+		status = ERROR;
+	}
+
+	size_t i;
+	for (i = 0; i < count; i += 1) {
+		json_t *element = status == OK ? json_array_get(replyJson, i) : NULL;
+		replies[i] = element != NULL && !json_is_null(element) ? json_dumps(element, JSON_DECODE_ANY) : NULL;
+	}
+
+	json_decref(replyJson);
+	return status;
+}
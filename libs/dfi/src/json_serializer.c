@@ -21,11 +21,34 @@
 #include "dyn_type.h"
 #include "dyn_type_common.h"
 #include "dyn_interface.h"
+#include "dyn_type_plan.h"
+#include "dfi_codec.h"
 
 #include <jansson.h>
 #include <assert.h>
 #include <stdint.h>
+#include <stdlib.h>
 #include <string.h>
+#include <errno.h>
+#include <limits.h>
+#include <math.h>
+
+#define JSON_WRITER_INITIAL_BUFFER_SIZE 256
+#define JSON_READER_INITIAL_SEQUENCE_CAP 8
+#define JSON_READER_MAX_DEPTH 2048
+#define JSON_READER_KEY_BUF_SIZE 128
+
+/**
+ * Growable output buffer. jsonSerializer_serialize writes the json text directly into the buffer instead of building
+ * a jansson tree first. Shared with the generated codecs, see dfi_codec.h.
+ */
+typedef dfi_json_writer_t json_writer_t;
+
+/**
+ * Pull reader over a NUL terminated json text. jsonSerializer_deserialize fills the dyn_type instance while reading,
+ * without building a jansson tree first. Shared with the generated codecs, see dfi_codec.h.
+ */
+typedef dfi_json_reader_t json_reader_t;
 
 static int jsonSerializer_createType(dyn_type *type, json_t *object, void **result);
 static int jsonSerializer_parseObject(dyn_type *type, json_t *object, void *inst);
@@ -35,9 +58,31 @@ static int jsonSerializer_parseAny(dyn_type *type, void *input, json_t *val);
 static int jsonSerializer_parseEnum(dyn_type *type, const char* enum_name, int32_t *out);
 
 static int jsonSerializer_writeAny(dyn_type *type, void *input, json_t **val);
-static int jsonSerializer_writeComplex(dyn_type *type, void *input, json_t **val);
-static int jsonSerializer_writeSequence(dyn_type *type, void *input, json_t **out);
+static int jsonSerializer_writeStep(const dyn_type_plan_step_t *steps, size_t *index, void *inst, json_t **out);
+static int jsonSerializer_writeValue(const dyn_type_plan_step_t *step, void *input, json_t **out);
+static int jsonSerializer_writeSequence(const dyn_type_plan_step_t *step, void *input, json_t **out);
 static int jsonSerializer_writeEnum(dyn_type *type, int32_t enum_value, json_t **out);
+static const char* jsonSerializer_enumName(dyn_type *type, int32_t enum_value);
+
+static int jsonSerializer_streamAny(json_writer_t *writer, dyn_type *type, void *inst, bool *written);
+static int jsonSerializer_streamStep(json_writer_t *writer, const dyn_type_plan_step_t *steps, size_t *index, void *inst, bool *written);
+static int jsonSerializer_streamValue(json_writer_t *writer, const dyn_type_plan_step_t *step, void *loc, bool *written);
+static int jsonSerializer_streamSequence(json_writer_t *writer, const dyn_type_plan_step_t *step, void *loc);
+
+static int jsonSerializer_readCreateType(json_reader_t *reader, dyn_type *type, void **result);
+static int jsonSerializer_readAny(json_reader_t *reader, dyn_type *type, void *loc);
+static int jsonSerializer_readObject(json_reader_t *reader, dyn_type *type, void *inst);
+static int jsonSerializer_readSequence(json_reader_t *reader, dyn_type *type, void *loc);
+
+static int jsonWriter_reserve(json_writer_t *writer, size_t extra);
+static int jsonWriter_append(json_writer_t *writer, const char *data, size_t len);
+static int jsonWriter_appendString(json_writer_t *writer, const char *str, bool *valid);
+
+static void jsonReader_skipWhitespace(json_reader_t *reader);
+static bool jsonReader_consume(json_reader_t *reader, char c);
+static bool jsonReader_consumeLiteral(json_reader_t *reader, const char *literal);
+static int jsonReader_readString(json_reader_t *reader, char *buf, size_t bufSize, char **out);
+static int jsonReader_readNumber(json_reader_t *reader, char descriptor, void *loc);
 
 
 static int OK = 0;
@@ -47,20 +92,29 @@ DFI_SETUP_LOG(jsonSerializer);
 
 int jsonSerializer_deserialize(dyn_type *type, const char *input, void **result) {
     assert(dynType_type(type) == DYN_TYPE_COMPLEX || dynType_type(type) == DYN_TYPE_SEQUENCE);
-    int status = 0;
+    int status = OK;
 
-    json_error_t error;
-    json_t *root = json_loads(input, JSON_DECODE_ANY, &error);
+    if (input == NULL) {
+        LOG_ERROR("Error cannot deserialize json. Input is NULL\n");
+        return ERROR;
+    }
 
-    if (root != NULL) {
-        status = jsonSerializer_deserializeJson(type, root, result);
-        json_decref(root);
-    } else {
-        status = ERROR;
-        LOG_ERROR("Error parsing json input '%s'. Error is: %s\n", input, error.text);
+    json_reader_t reader = {.input = input, .cur = input, .depth = 0};
+    void *inst = NULL;
+    status = jsonSerializer_readCreateType(&reader, type, &inst);
+
+    if (status == OK) {
+        jsonReader_skipWhitespace(&reader);
+        if (*reader.cur != '\0') {
+            LOG_ERROR("Error parsing json input '%s'. Unexpected content at offset %zu\n", input, (size_t)(reader.cur - input));
+            dynType_free(type, inst);
+            status = ERROR;
+        }
     }
 
-    if (status != OK) {
+    if (status == OK) {
+        *result = inst;
+    } else {
         LOG_ERROR("Error cannot deserialize json. Input is '%s'\n", input);
     }
     return status;
@@ -70,6 +124,14 @@ int jsonSerializer_deserializeJson(dyn_type *type, json_t *input, void **out) {
     return jsonSerializer_createType(type, input, out);
 }
 
+int jsonSerializer_deserializeJsonInto(dyn_type *type, json_t *input, void *inst) {
+    if (input == NULL) {
+        LOG_ERROR("Error cannot deserialize json. Input is NULL");
+        return ERROR;
+    }
+    return jsonSerializer_parseAny(type, inst, input);
+}
+
 static int jsonSerializer_createType(dyn_type *type, json_t *val, void **result) {
     assert(val != NULL);
     int status = OK;
@@ -303,12 +365,30 @@ static int jsonSerializer_parseSequence(dyn_type *seq, json_t *array, void *seqL
 int jsonSerializer_serialize(dyn_type *type, const void* input, char **output) {
     int status = OK;
 
-    json_t *root = NULL;
-    status = jsonSerializer_serializeJson(type, input, &root);
+    json_writer_t writer = {.buf = malloc(JSON_WRITER_INITIAL_BUFFER_SIZE), .len = 0, .cap = JSON_WRITER_INITIAL_BUFFER_SIZE};
+    if (writer.buf == NULL) {
+        LOG_ERROR("Cannot allocate memory for json output");
+        return ERROR;
+    }
+
+    bool written = false;
+    if (type->codec != NULL) {
+        status = type->codec->jsonWrite(&writer, input, &written);
+    } else {
+        status = jsonSerializer_streamAny(&writer, type, (void*)input, &written);
+    }
+    if (status == OK && !written) {
+        LOG_ERROR("Cannot serialize json, no value written for type");
+        status = ERROR;
+    }
+    if (status == OK) {
+        status = jsonWriter_append(&writer, "", 1); //NUL terminator
+    }
 
     if (status == OK) {
-        *output = json_dumps(root, JSON_COMPACT);
-        json_decref(root);
+        *output = writer.buf;
+    } else {
+        free(writer.buf);
     }
 
     return status;
@@ -333,11 +413,55 @@ int jsonSerializer_serializeJson(dyn_type *type, const void* input, json_t **out
 }
 
 static int jsonSerializer_writeAny(dyn_type *type, void* input, json_t **out) {
+    const dyn_type_plan *plan = dynType_plan(type);
+    if (plan == NULL) {
+        LOG_ERROR("Cannot create plan for type");
+        return ERROR;
+    }
+    size_t index = 0;
+    return jsonSerializer_writeStep(dynTypePlan_steps(plan), &index, input, out);
+}
+
+/**
+ * Writes the value or complex type at steps[*index] and updates index to the next step.
+ */
+static int jsonSerializer_writeStep(const dyn_type_plan_step_t *steps, size_t *index, void *inst, json_t **out) {
     int status = OK;
+    const dyn_type_plan_step_t *step = &steps[*index];
 
-    int descriptor = dynType_descriptorType(type);
+    if (step->kind == DYN_TYPE_PLAN_BEGIN_COMPLEX) {
+        json_t *val = json_object();
+        size_t i = *index + 1;
+        while (status == OK && val != NULL && i < step->end) {
+            const char *name = steps[i].name;
+            json_t *subVal = NULL;
+            status = jsonSerializer_writeStep(steps, &i, inst, &subVal);
+            if (status == OK && subVal != NULL) {
+                json_object_set_new(val, name, subVal);
+            }
+        }
+        if (val == NULL) {
+            status = ERROR;
+        }
+        if (status == OK) {
+            *out = val;
+        } else {
+            json_decref(val);
+        }
+        *index = step->end + 1;
+    } else {
+        status = jsonSerializer_writeValue(step, (char*)inst + step->offset, out);
+        *index += 1;
+    }
+
+    return status;
+}
+
+static int jsonSerializer_writeValue(const dyn_type_plan_step_t *step, void* input, json_t **out) {
+    int status = OK;
+
+    int descriptor = step->descriptor;
     json_t *val = NULL;
-    dyn_type *subType = NULL;
 
     bool *z;            //Z
     float *f;           //F
@@ -407,19 +531,13 @@ static int jsonSerializer_writeAny(dyn_type *type, void* input, json_t **out) {
             break;
         case 'E':
             e = input;
-            jsonSerializer_writeEnum(type, *e, &val);
+            jsonSerializer_writeEnum(step->type, *e, &val);
             break;
         case '*' :
-            status = dynType_typedPointer_getTypedType(type, &subType);
-            if (status == OK) {
-                status = jsonSerializer_writeAny(subType, *(void **)input, &val);
-            }
-            break;
-        case '{' :
-            status = jsonSerializer_writeComplex(type, input, &val);
+            status = jsonSerializer_writeAny(step->subType, *(void **)input, &val);
             break;
         case '[' :
-            status = jsonSerializer_writeSequence(type, input, &val);
+            status = jsonSerializer_writeSequence(step, input, &val);
             break;
         case 'P' :
             LOG_WARNING("Untyped pointer not supported for serialization. ignoring");
@@ -437,102 +555,1090 @@ static int jsonSerializer_writeAny(dyn_type *type, void* input, json_t **out) {
     return status;
 }
 
-static int jsonSerializer_writeSequence(dyn_type *type, void *input, json_t **out) {
-    assert(dynType_type(type) == DYN_TYPE_SEQUENCE);
+static int jsonSerializer_writeSequence(const dyn_type_plan_step_t *step, void *input, json_t **out) {
     int status = OK;
 
     json_t *array = json_array();
-    dyn_type *itemType = dynType_sequence_itemType(type);
-    uint32_t len = dynType_sequence_length(input);
+    struct generic_sequence *seq = input;
 
-    int i = 0;
-    void *itemLoc = NULL;
     json_t *item = NULL;
-    for (i = 0; i < len; i += 1) {
+    for (uint32_t i = 0; array != NULL && i < seq->len; i += 1) {
         item = NULL;
-        status = dynType_sequence_locForIndex(type, input, i, &itemLoc);
+        void *itemLoc = (char*)seq->buf + i * step->subTypeSize;
+        status = jsonSerializer_writeAny(step->subType, itemLoc, &item);
         if (status == OK) {
-            status = jsonSerializer_writeAny(itemType, itemLoc, &item);
+            json_array_append_new(array, item);
+        } else {
+            break;
+        }
+    }
+
+    if (status == OK && array != NULL) {
+        *out = array;
+    } else {
+        json_decref(array);
+    }
+
+    return status;
+}
+
+static int jsonSerializer_writeEnum(dyn_type *type, int32_t enum_value, json_t **out) {
+    const char *name = jsonSerializer_enumName(type, enum_value);
+    if (name == NULL) {
+        return ERROR;
+    }
+    *out = json_string(name);
+    return OK;
+}
+
+static const char* jsonSerializer_enumName(dyn_type *type, int32_t enum_value) {
+    struct meta_entry * entry;
+
+    // Convert to string
+    char enum_value_str[32];
+    snprintf(enum_value_str, 32, "%d", enum_value);
+
+    // Lookup in meta-information
+    TAILQ_FOREACH(entry, &type->metaProperties, entries) {
+        if (0 == strcmp(enum_value_str, entry->value)) {
+            return entry->name;
+        }
+    }
+
+    LOG_ERROR("Could not find Enum value %s in enum type", enum_value_str);
+    return NULL;
+}
+
+static int jsonSerializer_streamAny(json_writer_t *writer, dyn_type *type, void *inst, bool *written) {
+    const dyn_type_plan *plan = dynType_plan(type);
+    if (plan == NULL) {
+        LOG_ERROR("Cannot create plan for type");
+        return ERROR;
+    }
+    size_t index = 0;
+    return jsonSerializer_streamStep(writer, dynTypePlan_steps(plan), &index, inst, written);
+}
+
+/**
+ * Streams the value or complex type at steps[*index] and updates index to the next step.
+ * Values which cannot be represented (NULL text, unknown enum value, untyped pointer, etc) are not written, this
+ * matches the behaviour of the jansson based jsonSerializer_serializeJson.
+ */
+static int jsonSerializer_streamStep(json_writer_t *writer, const dyn_type_plan_step_t *steps, size_t *index, void *inst, bool *written) {
+    int status = OK;
+    const dyn_type_plan_step_t *step = &steps[*index];
+
+    if (step->kind == DYN_TYPE_PLAN_BEGIN_COMPLEX) {
+        bool first = true;
+        status = jsonWriter_append(writer, "{", 1);
+        size_t i = *index + 1;
+        while (status == OK && i < step->end) {
+            size_t mark = writer->len;
+            bool valid = true;
+            bool memberWritten = false;
+            if (!first) {
+                status = jsonWriter_append(writer, ",", 1);
+            }
+            if (status == OK) {
+                status = jsonWriter_appendString(writer, steps[i].name, &valid);
+            }
+            if (status == OK) {
+                status = jsonWriter_append(writer, ":", 1);
+            }
             if (status == OK) {
-                json_array_append(array, item);
-                json_decref(item);
+                status = jsonSerializer_streamStep(writer, steps, &i, inst, &memberWritten);
             }
+            if (status == OK && (!valid || !memberWritten)) {
+                writer->len = mark; //rollback member
+            } else {
+                first = false;
+            }
+        }
+        if (status == OK) {
+            status = jsonWriter_append(writer, "}", 1);
         }
+        *index = step->end + 1;
+        *written = status == OK;
+    } else {
+        status = jsonSerializer_streamValue(writer, step, (char*)inst + step->offset, written);
+        *index += 1;
+    }
 
-        if (status != OK) {
+    return status;
+}
+
+//2^53, up to which all integers can be represented exactly by a double
+#define JSON_SERIALIZER_MAX_EXACT_INTEGER 9007199254740992.0
+
+/**
+ * Writes the decimal representation of val to buf, which must have room for at least 21 chars. Returns the length.
+ */
+static int jsonSerializer_formatInteger(char *buf, int64_t val) {
+    char digits[20];
+    int nrOfDigits = 0;
+    uint64_t uval = val < 0 ? 0 - (uint64_t)val : (uint64_t)val;
+    do {
+        digits[nrOfDigits++] = (char)('0' + uval % 10);
+        uval /= 10;
+    } while (uval != 0);
+
+    int len = 0;
+    if (val < 0) {
+        buf[len++] = '-';
+    }
+    while (nrOfDigits > 0) {
+        buf[len++] = digits[--nrOfDigits];
+    }
+    buf[len] = '\0';
+    return len;
+}
+
+static int jsonSerializer_streamValue(json_writer_t *writer, const dyn_type_plan_step_t *step, void *loc, bool *written) {
+    int status = OK;
+    char num[32];
+    int numLen = -1;
+    const char *str;
+
+    *written = false;
+    switch (step->descriptor) {
+        case 'Z' :
+            if (*(bool*)loc) {
+                status = jsonWriter_append(writer, "true", 4);
+            } else {
+                status = jsonWriter_append(writer, "false", 5);
+            }
+            *written = true;
+            break;
+        case 'B' :
+            numLen = jsonSerializer_formatInteger(num, (int64_t)*(char*)loc);
+            break;
+        case 'S' :
+            numLen = jsonSerializer_formatInteger(num, (int64_t)*(int16_t*)loc);
+            break;
+        case 'I' :
+            numLen = jsonSerializer_formatInteger(num, (int64_t)*(int32_t*)loc);
+            break;
+        case 'J' :
+            numLen = jsonSerializer_formatInteger(num, *(int64_t*)loc);
+            break;
+        case 'b' :
+            numLen = jsonSerializer_formatInteger(num, (int64_t)*(uint8_t*)loc);
+            break;
+        case 's' :
+            numLen = jsonSerializer_formatInteger(num, (int64_t)*(uint16_t*)loc);
+            break;
+        case 'i' :
+            numLen = jsonSerializer_formatInteger(num, (int64_t)*(uint32_t*)loc);
+            break;
+        case 'j' :
+            //note json_int_t is signed, same representation as jsonSerializer_serializeJson
+            numLen = jsonSerializer_formatInteger(num, (int64_t)*(uint64_t*)loc);
+            break;
+        case 'N' :
+            numLen = jsonSerializer_formatInteger(num, (int64_t)*(int*)loc);
+            break;
+        case 'F' :
+        case 'D' : {
+            double d = step->descriptor == 'F' ? (double)*(float*)loc : *(double*)loc;
+            if (d >= -JSON_SERIALIZER_MAX_EXACT_INTEGER && d <= JSON_SERIALIZER_MAX_EXACT_INTEGER && d == (double)(int64_t)d
+                    && !(d == 0.0 && signbit(d))) {
+                //fast path for integral values, same output as the %.17g format below
+                numLen = jsonSerializer_formatInteger(num, (int64_t)d);
+                num[numLen++] = '.';
+                num[numLen++] = '0';
+                num[numLen] = '\0';
+            } else if (isfinite(d)) {
+                //same format as jansson: 17 significant digits and always recognizable as real
+                numLen = snprintf(num, sizeof(num), "%.17g", d);
+                if (numLen > 0 && strpbrk(num, ".eE") == NULL) {
+                    num[numLen++] = '.';
+                    num[numLen++] = '0';
+                    num[numLen] = '\0';
+                }
+            }
             break;
         }
+        case 't' :
+            str = *(const char**)loc;
+            if (str != NULL) {
+                bool valid = true;
+                size_t mark = writer->len;
+                status = jsonWriter_appendString(writer, str, &valid);
+                if (!valid) {
+                    writer->len = mark;
+                }
+                *written = valid;
+            }
+            break;
+        case 'E' :
+            str = jsonSerializer_enumName(step->type, *(int32_t*)loc);
+            if (str != NULL) {
+                status = jsonWriter_appendString(writer, str, written);
+            }
+            break;
+        case '*' :
+            if (*(void**)loc == NULL) {
+                status = jsonWriter_append(writer, "null", 4);
+                *written = true;
+            } else {
+                status = jsonSerializer_streamAny(writer, step->subType, *(void**)loc, written);
+            }
+            break;
+        case '[' :
+            status = jsonSerializer_streamSequence(writer, step, loc);
+            *written = true;
+            break;
+        case 'P' :
+            LOG_WARNING("Untyped pointer not supported for serialization. ignoring");
+            break;
+        default :
+            LOG_ERROR("Unsupported descriptor '%c'", step->descriptor);
+            status = ERROR;
+            break;
     }
 
-    if (status == OK && array != NULL) {
-        *out = array;
+    if (numLen > 0) {
+        status = jsonWriter_append(writer, num, (size_t)numLen);
+        *written = true;
     }
 
     return status;
 }
 
-static int jsonSerializer_writeComplex(dyn_type *type, void *input, json_t **out) {
-    assert(dynType_type(type) == DYN_TYPE_COMPLEX);
+static int jsonSerializer_streamSequence(json_writer_t *writer, const dyn_type_plan_step_t *step, void *loc) {
+    struct generic_sequence *seq = loc;
+    bool first = true;
+
+    //note for sequences of numbers the item values are written directly, with a single reservation for the common case
+    int number = seq->len > 0 ? dynType_primitiveNumber(step->subType) : 0;
+    const dyn_type_plan_step_t *numberStep = number != 0 ? dynTypePlan_steps(dynType_plan(step->subType)) : NULL;
+
+    int status = jsonWriter_append(writer, "[", 1);
+    if (status == OK && numberStep != NULL) {
+        status = jsonWriter_reserve(writer, (size_t)seq->len * (number == 'D' || number == 'F' ? 25 : 12));
+    }
+    for (uint32_t i = 0; status == OK && i < seq->len; i += 1) {
+        size_t mark = writer->len;
+        bool itemWritten = false;
+        if (!first) {
+            status = jsonWriter_append(writer, ",", 1);
+        }
+        if (status == OK) {
+            void *itemLoc = (char*)seq->buf + i * step->subTypeSize;
+            status = numberStep != NULL ?
+                     jsonSerializer_streamValue(writer, numberStep, itemLoc, &itemWritten) :
+                     jsonSerializer_streamAny(writer, step->subType, itemLoc, &itemWritten);
+        }
+        if (status == OK && !itemWritten) {
+            writer->len = mark;
+        } else {
+            first = false;
+        }
+    }
+    if (status == OK) {
+        status = jsonWriter_append(writer, "]", 1);
+    }
+    return status;
+}
+
+static int jsonSerializer_readCreateType(json_reader_t *reader, dyn_type *type, void **result) {
     int status = OK;
+    void *inst = NULL;
 
-    json_t *val = json_object();
-    struct complex_type_entry *entry = NULL;
-    struct complex_type_entries_head *entries = NULL;
-    int index = -1;
+    jsonReader_skipWhitespace(reader);
+    if (dynType_descriptorType(type) == 't') {
+        status = jsonReader_readString(reader, NULL, 0, (char**)&inst);
+    } else {
+        status = dynType_alloc(type, &inst);
+        if (status == OK) {
+            assert(inst != NULL);
+            status = type->codec != NULL ? type->codec->jsonRead(reader, inst) : jsonSerializer_readAny(reader, type, inst);
+        }
+    }
 
-    status = dynType_complex_entries(type, &entries);
     if (status == OK) {
-        TAILQ_FOREACH(entry, entries, entries) {
-            void *subLoc = NULL;
-            json_t *subVal = NULL;
-            dyn_type *subType = NULL;
-            index = dynType_complex_indexForName(type, entry->name);
-            if (index < 0) {
-                LOG_ERROR("Cannot find index for member '%s'", entry->name);
+        *result = inst;
+    } else {
+        dynType_free(type, inst);
+    }
+
+    return status;
+}
+
+static int jsonSerializer_readAny(json_reader_t *reader, dyn_type *type, void *loc) {
+    int status = OK;
+    char *str = NULL;
+    dyn_type *subType = NULL;
+    char c = dynType_descriptorType(type);
+
+    jsonReader_skipWhitespace(reader);
+    switch (c) {
+        case 'Z' :
+            if (jsonReader_consumeLiteral(reader, "true")) {
+                *(bool*)loc = true;
+            } else if (jsonReader_consumeLiteral(reader, "false") || jsonReader_consumeLiteral(reader, "null")) {
+                *(bool*)loc = false;
+            } else {
+                status = ERROR;
+                LOG_ERROR("Expected json boolean at offset %zu", (size_t)(reader->cur - reader->input));
+            }
+            break;
+        case 'F' :
+        case 'D' :
+        case 'N' :
+        case 'B' :
+        case 'S' :
+        case 'I' :
+        case 'J' :
+        case 'b' :
+        case 's' :
+        case 'i' :
+        case 'j' :
+            status = jsonReader_readNumber(reader, c, loc);
+            break;
+        case 'E' :
+            if (!jsonReader_consumeLiteral(reader, "null")) {
+                status = jsonReader_readString(reader, NULL, 0, &str);
+                if (status == OK) {
+                    status = jsonSerializer_parseEnum(type, str, loc);
+                    free(str);
+                }
+            }
+            break;
+        case 't' :
+            if (!jsonReader_consumeLiteral(reader, "null")) {
+                status = jsonReader_readString(reader, NULL, 0, &str);
+                if (status == OK) {
+                    *(char**)loc = str;
+                }
+            }
+            break;
+        case '[' :
+            status = jsonSerializer_readSequence(reader, type, loc);
+            break;
+        case '{' :
+            if (!jsonReader_consumeLiteral(reader, "null")) {
+                status = jsonSerializer_readObject(reader, type, loc);
+            }
+            break;
+        case '*' :
+            if (!jsonReader_consumeLiteral(reader, "null")) {
+                status = dynType_typedPointer_getTypedType(type, &subType);
+                if (status == OK) {
+                    status = jsonSerializer_readCreateType(reader, subType, (void **) loc);
+                }
+            }
+            break;
+        case 'P' :
+            status = ERROR;
+            LOG_WARNING("Untyped pointer are not supported for serialization");
+            break;
+        default :
+            status = ERROR;
+            LOG_ERROR("Error provided type '%c' not supported for JSON\n", c);
+            break;
+    }
+
+    return status;
+}
+
+static int jsonSerializer_readObject(json_reader_t *reader, dyn_type *type, void *inst) {
+    int status = OK;
+
+    if (!jsonReader_consume(reader, '{')) {
+        LOG_ERROR("Expected json object at offset %zu", (size_t)(reader->cur - reader->input));
+        return ERROR;
+    }
+    if (++reader->depth > JSON_READER_MAX_DEPTH) {
+        LOG_ERROR("Maximum json nesting depth exceeded");
+        return ERROR;
+    }
+
+    if (!jsonReader_consume(reader, '}')) {
+        do {
+            char keyBuf[JSON_READER_KEY_BUF_SIZE];
+            char *key = NULL;
+            void *valp = NULL;
+            dyn_type *valType = NULL;
+
+            jsonReader_skipWhitespace(reader);
+            status = jsonReader_readString(reader, keyBuf, sizeof(keyBuf), &key);
+            if (status == OK && !jsonReader_consume(reader, ':')) {
+                LOG_ERROR("Expected ':' at offset %zu", (size_t)(reader->cur - reader->input));
                 status = ERROR;
             }
-            if(status == OK){
-                status = dynType_complex_valLocAt(type, index, input, &subLoc);
+
+            int index = -1;
+            if (status == OK) {
+                index = dynType_complex_indexForName(type, key);
+                if (index < 0) {
+                    LOG_ERROR("Cannot find index for member '%s'", key);
+                    status = ERROR;
+                }
+            }
+            if (key != keyBuf) {
+                free(key);
             }
+
             if (status == OK) {
-                status = dynType_complex_dynTypeAt(type, index, &subType);
+                status = dynType_complex_valLocAt(type, index, inst, &valp);
             }
             if (status == OK) {
-                status = jsonSerializer_writeAny(subType, subLoc, &subVal);
+                status = dynType_complex_dynTypeAt(type, index, &valType);
             }
             if (status == OK) {
-                json_object_set(val, entry->name, subVal);
-                json_decref(subVal);
+                status = jsonSerializer_readAny(reader, valType, valp);
+            }
+        } while (status == OK && jsonReader_consume(reader, ','));
+
+        if (status == OK && !jsonReader_consume(reader, '}')) {
+            LOG_ERROR("Expected ',' or '}' at offset %zu", (size_t)(reader->cur - reader->input));
+            status = ERROR;
+        }
+    }
+
+    reader->depth -= 1;
+    return status;
+}
+
+static int jsonSerializer_readSequence(json_reader_t *reader, dyn_type *type, void *loc) {
+    assert(dynType_type(type) == DYN_TYPE_SEQUENCE);
+    int status = OK;
+    struct generic_sequence *seq = loc;
+
+    if (!jsonReader_consume(reader, '[')) {
+        LOG_ERROR("Expected json array at offset %zu", (size_t)(reader->cur - reader->input));
+        return ERROR;
+    }
+    if (++reader->depth > JSON_READER_MAX_DEPTH) {
+        LOG_ERROR("Maximum json nesting depth exceeded");
+        return ERROR;
+    }
+
+    bool empty = jsonReader_consume(reader, ']');
+    status = dynType_sequence_alloc(type, loc, empty ? 0 : JSON_READER_INITIAL_SEQUENCE_CAP);
+
+    if (status == OK && !empty) {
+        dyn_type *itemType = dynType_sequence_itemType(type);
+        size_t itemSize = dynType_size(itemType);
+        do {
+            if (seq->len == seq->cap) {
+                uint32_t newCap = seq->cap * 2;
+                char *newBuf = newCap > seq->cap ? realloc(seq->buf, newCap * itemSize) : NULL;
+                if (newBuf == NULL) {
+                    LOG_ERROR("Error allocating memory for sequence");
+                    status = ERROR;
+                    break;
+                }
+                memset(newBuf + seq->cap * itemSize, 0, (newCap - seq->cap) * itemSize);
+                seq->buf = newBuf;
+                seq->cap = newCap;
             }
+            void *itemLoc = (char*)seq->buf + seq->len * itemSize;
+            seq->len += 1; //note the item is part of the sequence (and freed with it) also if parsing fails
+            status = jsonSerializer_readAny(reader, itemType, itemLoc);
+        } while (status == OK && jsonReader_consume(reader, ','));
 
-            if (status != OK) {
+        if (status == OK && !jsonReader_consume(reader, ']')) {
+            LOG_ERROR("Expected ',' or ']' at offset %zu", (size_t)(reader->cur - reader->input));
+            status = ERROR;
+        }
+        if (status == OK && seq->cap > seq->len && !dynType_hasPool(type)) {
+            //shrink to fit, same capacity as when the size is known upfront. Pooled buffers keep their capacity for reuse
+            char *newBuf = realloc(seq->buf, seq->len * itemSize);
+            if (newBuf != NULL) {
+                seq->buf = newBuf;
+                seq->cap = seq->len;
+            }
+        }
+    }
+
+    reader->depth -= 1;
+    return status;
+}
+
+static int jsonWriter_reserve(json_writer_t *writer, size_t extra) {
+    if (writer->cap - writer->len >= extra) {
+        return OK;
+    }
+    size_t newCap = writer->cap == 0 ? JSON_WRITER_INITIAL_BUFFER_SIZE : writer->cap;
+    while (newCap - writer->len < extra) {
+        if (newCap > SIZE_MAX / 2) {
+            LOG_ERROR("Write error, buffer too large.");
+            return ERROR;
+        }
+        newCap *= 2;
+    }
+    char *newBuf = realloc(writer->buf, newCap);
+    if (newBuf == NULL) {
+        LOG_ERROR("Write error, cannot grow buffer.");
+        return ERROR;
+    }
+    writer->buf = newBuf;
+    writer->cap = newCap;
+    return OK;
+}
+
+static int jsonWriter_append(json_writer_t *writer, const char *data, size_t len) {
+    if (jsonWriter_reserve(writer, len) != OK) {
+        return ERROR;
+    }
+    memcpy(writer->buf + writer->len, data, len);
+    writer->len += len;
+    return OK;
+}
+
+/**
+ * Appends str as quoted and escaped json string. valid is set to false (and the output is garbage) if str is not
+ * valid UTF-8, jansson refuses such strings as well.
+ */
+static int jsonWriter_appendString(json_writer_t *writer, const char *str, bool *valid) {
+    static const char hex[] = "0123456789abcdef";
+    const unsigned char *p = (const unsigned char*)str;
+    *valid = true;
+
+    if (jsonWriter_append(writer, "\"", 1) != OK) {
+        return ERROR;
+    }
+    while (*p != '\0') {
+        //copy runs which need no escaping at once
+        const unsigned char *run = p;
+        while (*p >= 0x20 && *p < 0x80 && *p != '"' && *p != '\\') {
+            p += 1;
+        }
+        if (p != run && jsonWriter_append(writer, (const char*)run, (size_t)(p - run)) != OK) {
+            return ERROR;
+        }
+        if (*p == '\0') {
+            break;
+        }
+
+        if (*p >= 0x80) {
+            size_t n = *p >= 0xF0 ? 4 : *p >= 0xE0 ? 3 : 2;
+            if (*p < 0xC2 || *p > 0xF4) {
+                *valid = false;
+                return OK;
+            }
+            for (size_t k = 1; k < n; ++k) {
+                if ((p[k] & 0xC0) != 0x80) {
+                    *valid = false;
+                    return OK;
+                }
+            }
+            if (jsonWriter_append(writer, (const char*)p, n) != OK) {
+                return ERROR;
+            }
+            p += n;
+            continue;
+        }
+
+        char esc[6] = {'\\', 'u', '0', '0', hex[*p >> 4], hex[*p & 0xF]};
+        size_t escLen = 2;
+        switch (*p) {
+            case '"': esc[1] = '"'; break;
+            case '\\': esc[1] = '\\'; break;
+            case '\b': esc[1] = 'b'; break;
+            case '\f': esc[1] = 'f'; break;
+            case '\n': esc[1] = 'n'; break;
+            case '\r': esc[1] = 'r'; break;
+            case '\t': esc[1] = 't'; break;
+            default: escLen = 6; break;
+        }
+        if (jsonWriter_append(writer, esc, escLen) != OK) {
+            return ERROR;
+        }
+        p += 1;
+    }
+    return jsonWriter_append(writer, "\"", 1);
+}
+
+static void jsonReader_skipWhitespace(json_reader_t *reader) {
+    while (*reader->cur == ' ' || *reader->cur == '\t' || *reader->cur == '\n' || *reader->cur == '\r') {
+        reader->cur += 1;
+    }
+}
+
+static bool jsonReader_consume(json_reader_t *reader, char c) {
+    jsonReader_skipWhitespace(reader);
+    if (*reader->cur == c) {
+        reader->cur += 1;
+        return true;
+    }
+    return false;
+}
+
+static bool jsonReader_consumeLiteral(json_reader_t *reader, const char *literal) {
+    size_t len = strlen(literal);
+    if (strncmp(reader->cur, literal, len) == 0) {
+        reader->cur += len;
+        return true;
+    }
+    return false;
+}
+
+static int jsonReader_hex4(const char *p, uint32_t *out) {
+    uint32_t val = 0;
+    for (int i = 0; i < 4; ++i) {
+        char c = p[i];
+        val <<= 4;
+        if (c >= '0' && c <= '9') {
+            val |= (uint32_t)(c - '0');
+        } else if (c >= 'a' && c <= 'f') {
+            val |= (uint32_t)(c - 'a' + 10);
+        } else if (c >= 'A' && c <= 'F') {
+            val |= (uint32_t)(c - 'A' + 10);
+        } else {
+            return ERROR;
+        }
+    }
+    *out = val;
+    return OK;
+}
+
+/**
+ * Reads a json string. If the decoded string fits in buf (when provided) buf is used, otherwise the string is
+ * allocated and must be freed by the caller.
+ */
+static int jsonReader_readString(json_reader_t *reader, char *buf, size_t bufSize, char **out) {
+    if (*reader->cur != '"') {
+        LOG_ERROR("Expected json string at offset %zu", (size_t)(reader->cur - reader->input));
+        return ERROR;
+    }
+    const char *start = reader->cur + 1;
+
+    //first pass: find the end, decoded length is always <= encoded length
+    const char *p = start;
+    bool escaped = false;
+    while (*p != '"') {
+        if ((unsigned char)*p < 0x20) {
+            LOG_ERROR("Invalid character in json string at offset %zu", (size_t)(p - reader->input));
+            return ERROR;
+        }
+        if (*p == '\\') {
+            escaped = true;
+            p += 1;
+            if (*p == '\0') {
                 break;
             }
         }
+        p += 1;
     }
+    if (*p != '"') {
+        LOG_ERROR("Unterminated json string at offset %zu", (size_t)(start - 1 - reader->input));
+        return ERROR;
+    }
+    size_t encodedLen = (size_t)(p - start);
 
-    if (status == OK && val != NULL) {
-        *out = val;
+    char *str = encodedLen < bufSize ? buf : malloc(encodedLen + 1);
+    if (str == NULL) {
+        LOG_ERROR("Cannot allocate memory for string");
+        return ERROR;
     }
 
+    if (!escaped) {
+        memcpy(str, start, encodedLen);
+        str[encodedLen] = '\0';
+    } else {
+        char *o = str;
+        for (const char *s = start; s < p; ++s) {
+            if (*s != '\\') {
+                *o++ = *s;
+                continue;
+            }
+            s += 1;
+            uint32_t cp = 0;
+            switch (*s) {
+                case '"': *o++ = '"'; break;
+                case '\\': *o++ = '\\'; break;
+                case '/': *o++ = '/'; break;
+                case 'b': *o++ = '\b'; break;
+                case 'f': *o++ = '\f'; break;
+                case 'n': *o++ = '\n'; break;
+                case 'r': *o++ = '\r'; break;
+                case 't': *o++ = '\t'; break;
+                case 'u':
+                    if (p - s < 5 || jsonReader_hex4(s + 1, &cp) != OK) {
+                        cp = 0;
+                    } else {
+                        s += 4;
+                        if (cp >= 0xD800 && cp <= 0xDBFF) {
+                            uint32_t low = 0;
+                            if (p - s >= 7 && s[1] == '\\' && s[2] == 'u' && jsonReader_hex4(s + 3, &low) == OK && low >= 0xDC00 && low <= 0xDFFF) {
+                                cp = 0x10000 + ((cp - 0xD800) << 10) + (low - 0xDC00);
+                                s += 6;
+                            } else {
+                                cp = 0;
+                            }
+                        } else if (cp >= 0xDC00 && cp <= 0xDFFF) {
+                            cp = 0;
+                        }
+                    }
+                    if (cp == 0) {
+                        //note \u0000 is also refused, same as jansson without JSON_ALLOW_NUL
+                        LOG_ERROR("Invalid \\u escape in json string at offset %zu", (size_t)(s - reader->input));
+                        if (str != buf) {
+                            free(str);
+                        }
+                        return ERROR;
+                    }
+                    //encode as UTF-8, never longer than the 6 (or 12) char escape
+                    if (cp < 0x80) {
+                        *o++ = (char)cp;
+                    } else if (cp < 0x800) {
+                        *o++ = (char)(0xC0 | (cp >> 6));
+                        *o++ = (char)(0x80 | (cp & 0x3F));
+                    } else if (cp < 0x10000) {
+                        *o++ = (char)(0xE0 | (cp >> 12));
+                        *o++ = (char)(0x80 | ((cp >> 6) & 0x3F));
+                        *o++ = (char)(0x80 | (cp & 0x3F));
+                    } else {
+                        *o++ = (char)(0xF0 | (cp >> 18));
+                        *o++ = (char)(0x80 | ((cp >> 12) & 0x3F));
+                        *o++ = (char)(0x80 | ((cp >> 6) & 0x3F));
+                        *o++ = (char)(0x80 | (cp & 0x3F));
+                    }
+                    break;
+                default:
+                    LOG_ERROR("Invalid escape in json string at offset %zu", (size_t)(s - reader->input));
+                    if (str != buf) {
+                        free(str);
+                    }
+                    return ERROR;
+            }
+        }
+        *o = '\0';
+    }
+
+    reader->cur = p + 1;
+    *out = str;
+    return OK;
+}
+
+/**
+ * Reads a json number into loc. Integers are accepted for real types and real values are truncated for integer types.
+ */
+static int jsonReader_readNumber(json_reader_t *reader, char descriptor, void *loc) {
+    //validate json number grammar, strtod/strtoll accept more (hex, inf, leading whitespace)
+    const char *p = reader->cur;
+    bool isReal = false;
+    if (*p == '-') {
+        p += 1;
+    }
+    if (*p < '0' || *p > '9') {
+        LOG_ERROR("Expected json number at offset %zu", (size_t)(reader->cur - reader->input));
+        return ERROR;
+    }
+    while (*p >= '0' && *p <= '9') {
+        p += 1;
+    }
+    if (*p == '.') {
+        isReal = true;
+        p += 1;
+        while (*p >= '0' && *p <= '9') {
+            p += 1;
+        }
+    }
+    if (*p == 'e' || *p == 'E') {
+        isReal = true;
+        p += 1;
+        if (*p == '+' || *p == '-') {
+            p += 1;
+        }
+        while (*p >= '0' && *p <= '9') {
+            p += 1;
+        }
+    }
+
+    char *end = NULL;
+    double d = 0.0;
+    long long ll = 0;
+    unsigned long long ull = 0;
+    errno = 0;
+    if (descriptor == 'F' || descriptor == 'D') {
+        d = strtod(reader->cur, &end);
+    } else if (isReal) {
+        d = strtod(reader->cur, &end);
+        if (!(d > (double)LLONG_MIN && d < (double)LLONG_MAX)) {
+            errno = ERANGE;
+        } else {
+            ll = (long long)d;
+            ull = (unsigned long long)ll;
+        }
+    } else if (descriptor == 'j' && *reader->cur != '-') {
+        ull = strtoull(reader->cur, &end, 10);
+        ll = (long long)ull;
+    } else {
+        ll = strtoll(reader->cur, &end, 10);
+        ull = (unsigned long long)ll;
+    }
+    bool isInteger = descriptor != 'F' && descriptor != 'D';
+    if (end != p || (errno == ERANGE && isInteger)) {
+        LOG_ERROR("Invalid json number at offset %zu", (size_t)(reader->cur - reader->input));
+        return ERROR;
+    }
+    reader->cur = p;
+
+    switch (descriptor) {
+        case 'F' : *(float*)loc = (float)d; break;
+        case 'D' : *(double*)loc = d; break;
+        case 'N' : *(int*)loc = (int)ll; break;
+        case 'B' : *(char*)loc = (char)ll; break;
+        case 'S' : *(int16_t*)loc = (int16_t)ll; break;
+        case 'I' : *(int32_t*)loc = (int32_t)ll; break;
+        case 'J' : *(int64_t*)loc = (int64_t)ll; break;
+        case 'b' : *(uint8_t*)loc = (uint8_t)ull; break;
+        case 's' : *(uint16_t*)loc = (uint16_t)ull; break;
+        case 'i' : *(uint32_t*)loc = (uint32_t)ull; break;
+        case 'j' : *(uint64_t*)loc = (uint64_t)ull; break;
+        default: break;
+    }
+    return OK;
+}
+
+int dfiJson_initWriter(dfi_json_writer_t *writer) {
+    writer->len = 0;
+    writer->buf = malloc(JSON_WRITER_INITIAL_BUFFER_SIZE);
+    writer->cap = writer->buf != NULL ? JSON_WRITER_INITIAL_BUFFER_SIZE : 0;
+    if (writer->buf == NULL) {
+        LOG_ERROR("Cannot allocate memory for json output");
+        return ERROR;
+    }
+    return OK;
+}
+
+int dfiJson_writeRaw(dfi_json_writer_t *writer, const char *data, size_t len) {
+    return jsonWriter_append(writer, data, len);
+}
+
+int dfiJson_writeValue(dfi_json_writer_t *writer, char descriptor, const void *loc, bool *written) {
+    dyn_type_plan_step_t step = {.kind = DYN_TYPE_PLAN_VALUE, .descriptor = descriptor};
+    return jsonSerializer_streamValue(writer, &step, (void*)loc, written);
+}
+
+int dfiJson_writeEnum(dfi_json_writer_t *writer, const char * const names[], const int32_t values[], size_t count, int32_t value, bool *written) {
+    for (size_t i = 0; i < count; ++i) {
+        if (values[i] == value) {
+            return jsonWriter_appendString(writer, names[i], written);
+        }
+    }
+    LOG_ERROR("Could not find Enum value %d in enum type", value);
+    *written = false;
+    return OK;
+}
+
+int dfiJson_finishWriter(dfi_json_writer_t *writer, int status, char **out) {
+    if (status == OK) {
+        status = jsonWriter_append(writer, "", 1); //NUL terminator
+    }
+    if (status == OK) {
+        *out = writer->buf;
+    } else {
+        free(writer->buf);
+    }
+    writer->buf = NULL;
+    writer->len = writer->cap = 0;
     return status;
 }
 
-static int jsonSerializer_writeEnum(dyn_type *type, int32_t enum_value, json_t **out) {
-    struct meta_entry * entry;
+void dfiJson_initReader(dfi_json_reader_t *reader, const char *input) {
+    reader->input = input;
+    reader->cur = input;
+    reader->depth = 0;
+}
 
-    // Convert to string
-    char enum_value_str[32];
-    snprintf(enum_value_str, 32, "%d", enum_value);
+bool dfiJson_readNull(dfi_json_reader_t *reader) {
+    jsonReader_skipWhitespace(reader);
+    return jsonReader_consumeLiteral(reader, "null");
+}
 
-    // Lookup in meta-information
-    TAILQ_FOREACH(entry, &type->metaProperties, entries) {
-        if (0 == strcmp(enum_value_str, entry->value)) {
-            *out = json_string((const char*)entry->name);
-            return OK;
+int dfiJson_readValue(dfi_json_reader_t *reader, char descriptor, void *loc) {
+    int status = OK;
+    char *str = NULL;
+
+    jsonReader_skipWhitespace(reader);
+    if (descriptor == 'Z') {
+        if (jsonReader_consumeLiteral(reader, "true")) {
+            *(bool*)loc = true;
+        } else if (jsonReader_consumeLiteral(reader, "false") || jsonReader_consumeLiteral(reader, "null")) {
+            *(bool*)loc = false;
+        } else {
+            status = ERROR;
+            LOG_ERROR("Expected json boolean at offset %zu", (size_t)(reader->cur - reader->input));
         }
+    } else if (descriptor == 't') {
+        if (!jsonReader_consumeLiteral(reader, "null")) {
+            status = jsonReader_readString(reader, NULL, 0, &str);
+            if (status == OK) {
+                *(char**)loc = str;
+            }
+        }
+    } else {
+        status = jsonReader_readNumber(reader, descriptor, loc);
     }
+    return status;
+}
 
-    LOG_ERROR("Could not find Enum value %s in enum type", enum_value_str);
+int dfiJson_readEnum(dfi_json_reader_t *reader, const char * const names[], const int32_t values[], size_t count, int32_t *value) {
+    char buf[JSON_READER_KEY_BUF_SIZE];
+    char *name = NULL;
+
+    if (dfiJson_readNull(reader)) {
+        return OK;
+    }
+    int status = jsonReader_readString(reader, buf, sizeof(buf), &name);
+    if (status == OK) {
+        status = ERROR;
+        for (size_t i = 0; i < count; ++i) {
+            if (strcmp(names[i], name) == 0) {
+                *value = values[i];
+                status = OK;
+                break;
+            }
+        }
+        if (status != OK) {
+            LOG_ERROR("Could not find Enum value %s in enum type", name);
+        }
+    }
+    if (name != buf) {
+        free(name);
+    }
+    return status;
+}
+
+static int jsonReader_begin(json_reader_t *reader, char open, char close, bool *more) {
+    if (!jsonReader_consume(reader, open)) {
+        LOG_ERROR("Expected json %s at offset %zu", open == '{' ? "object" : "array", (size_t)(reader->cur - reader->input));
+        return ERROR;
+    }
+    if (++reader->depth > JSON_READER_MAX_DEPTH) {
+        LOG_ERROR("Maximum json nesting depth exceeded");
+        return ERROR;
+    }
+    *more = !jsonReader_consume(reader, close);
+    if (!*more) {
+        reader->depth -= 1;
+    }
+    return OK;
+}
+
+static int jsonReader_next(json_reader_t *reader, char close, bool *more) {
+    if (jsonReader_consume(reader, ',')) {
+        *more = true;
+    } else if (jsonReader_consume(reader, close)) {
+        *more = false;
+        reader->depth -= 1;
+    } else {
+        LOG_ERROR("Expected ',' or '%c' at offset %zu", close, (size_t)(reader->cur - reader->input));
+        return ERROR;
+    }
+    return OK;
+}
+
+int dfiJson_readObjectBegin(dfi_json_reader_t *reader, bool *more) {
+    return jsonReader_begin(reader, '{', '}', more);
+}
+
+int dfiJson_readObjectNext(dfi_json_reader_t *reader, bool *more) {
+    return jsonReader_next(reader, '}', more);
+}
+
+int dfiJson_readKey(dfi_json_reader_t *reader, char *buf, size_t bufSize, char **key) {
+    jsonReader_skipWhitespace(reader);
+    int status = jsonReader_readString(reader, buf, bufSize, key);
+    if (status == OK && !jsonReader_consume(reader, ':')) {
+        LOG_ERROR("Expected ':' at offset %zu", (size_t)(reader->cur - reader->input));
+        status = ERROR;
+    }
+    return status;
+}
+
+int dfiJson_readUnknownKey(dfi_json_reader_t *reader __attribute__((unused)), const char *key) {
+    LOG_ERROR("Cannot find index for member '%s'", key);
     return ERROR;
 }
+
+int dfiJson_readArrayBegin(dfi_json_reader_t *reader, bool *more) {
+    return jsonReader_begin(reader, '[', ']', more);
+}
+
+int dfiJson_readArrayNext(dfi_json_reader_t *reader, bool *more) {
+    return jsonReader_next(reader, ']', more);
+}
+
+bool dfiJson_readEnd(dfi_json_reader_t *reader) {
+    jsonReader_skipWhitespace(reader);
+    return *reader->cur == '\0';
+}
+
+int dfiJson_growSequence(void *seqLoc, size_t itemSize) {
+    struct generic_sequence *seq = seqLoc;
+    uint32_t newCap = seq->cap == 0 ? JSON_READER_INITIAL_SEQUENCE_CAP : seq->cap * 2;
+    char *newBuf = newCap > seq->cap ? realloc(seq->buf, newCap * itemSize) : NULL;
+    if (newBuf == NULL) {
+        LOG_ERROR("Error allocating memory for sequence");
+        return ERROR;
+    }
+    memset(newBuf + seq->cap * itemSize, 0, (newCap - seq->cap) * itemSize);
+    seq->buf = newBuf;
+    seq->cap = newCap;
+    return OK;
+}
+
+void dfiJson_shrinkSequence(void *seqLoc, size_t itemSize) {
+    struct generic_sequence *seq = seqLoc;
+    if (seq->cap > seq->len) {
+        char *newBuf = realloc(seq->buf, seq->len * itemSize);
+        if (newBuf != NULL || seq->len == 0) {
+            seq->buf = newBuf;
+            seq->cap = seq->len;
+        }
+    }
+}
+
+/**
+ * Checks (silently) that the next tokens are the json object key, i.e. "key":.
+ */
+static bool jsonReader_consumeKey(json_reader_t *reader, const char *key) {
+    const char *mark = reader->cur;
+    jsonReader_skipWhitespace(reader);
+    if (jsonReader_consume(reader, '"') && jsonReader_consumeLiteral(reader, key) && jsonReader_consume(reader, '"') && jsonReader_consume(reader, ':')) {
+        return true;
+    }
+    reader->cur = mark;
+    return false;
+}
+
+int dfiJson_readRpcMethod(dfi_json_reader_t *reader, char *buf, size_t bufSize, char **id) {
+    if (!jsonReader_consume(reader, '{') || !jsonReader_consumeKey(reader, "m")) {
+        return DFI_CODEC_UNSUPPORTED;
+    }
+    jsonReader_skipWhitespace(reader);
+    if (*reader->cur != '"') {
+        return DFI_CODEC_UNSUPPORTED;
+    }
+    reader->depth = 1;
+    return jsonReader_readString(reader, buf, bufSize, id) == OK ? DFI_CODEC_OK : DFI_CODEC_UNSUPPORTED;
+}
+
+int dfiJson_readRpcArguments(dfi_json_reader_t *reader, bool *more) {
+    if (!jsonReader_consume(reader, ',') || !jsonReader_consumeKey(reader, "a")) {
+        return DFI_CODEC_UNSUPPORTED;
+    }
+    jsonReader_skipWhitespace(reader);
+    if (*reader->cur != '[') {
+        return DFI_CODEC_UNSUPPORTED;
+    }
+    return jsonReader_begin(reader, '[', ']', more) == OK ? DFI_CODEC_OK : DFI_CODEC_UNSUPPORTED;
+}
+
+int dfiJson_readRpcResult(dfi_json_reader_t *reader) {
+    if (!jsonReader_consume(reader, '{') || !jsonReader_consumeKey(reader, "r")) {
+        return DFI_CODEC_UNSUPPORTED;
+    }
+    reader->depth = 1;
+    return DFI_CODEC_OK;
+}
+
+bool dfiJson_readRpcEnd(dfi_json_reader_t *reader) {
+    return jsonReader_consume(reader, '}') && dfiJson_readEnd(reader);
+}
@@ -0,0 +1,355 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *  KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <CppUTest/TestHarness.h>
+#include "CppUTest/CommandLineTestRunner.h"
+
+extern "C" {
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "dyn_common.h"
+#include "dyn_type.h"
+#include "dyn_function.h"
+#include "dyn_interface.h"
+#include "avrobin_serializer.h"
+#include "avrobin_rpc.h"
+
+static void stdLog(void*, int level, const char *file, int line, const char *msg, ...) {
+    va_list ap;
+    const char *levels[5] = {"NIL", "ERROR", "WARNING", "INFO", "DEBUG"};
+    fprintf(stderr, "%s: FILE:%s, LINE:%i, MSG:",levels[level], file, line);
+    va_start(ap, msg);
+    vfprintf(stderr, msg, ap);
+    fprintf(stderr, "\n");
+    va_end(ap);
+}
+
+struct rpc_seq {
+    uint32_t cap;
+    uint32_t len;
+    double *buf;
+};
+
+//StatsResult={DDD[D average min max input}
+struct rpc_stats_result {
+    double average;
+    double min;
+    double max;
+    struct rpc_seq input;
+};
+
+struct rpc_calculator {
+    void *handle;
+    int (*add)(void *, double, double, double *);
+    int (*sub)(void *, double, double, double *);
+    int (*sqrt)(void *, double, double *);
+    int (*stats)(void *, struct rpc_seq, struct rpc_stats_result **);
+};
+
+struct rpc_example4 {
+    void *handle;
+    int (*getName)(void *, char** name);
+};
+
+static int rpc_add(void*, double a, double b, double *result) {
+    *result = a + b;
+    return 0;
+}
+
+static int rpc_sub(void*, double, double, double *) {
+    return 42; //error
+}
+
+static int rpc_stats(void*, struct rpc_seq input, struct rpc_stats_result **out) {
+    auto result = static_cast<rpc_stats_result *>(calloc(1, sizeof(rpc_stats_result)));
+    double total = 0.0;
+    result->min = input.len > 0 ? input.buf[0] : 0.0;
+    result->max = result->min;
+    for (uint32_t i = 0; i < input.len; ++i) {
+        total += input.buf[i];
+        result->min = input.buf[i] < result->min ? input.buf[i] : result->min;
+        result->max = input.buf[i] > result->max ? input.buf[i] : result->max;
+    }
+    result->average = input.len > 0 ? total / input.len : 0.0;
+    result->input.buf = static_cast<double *>(calloc(input.len, sizeof(double)));
+    memcpy(result->input.buf, input.buf, input.len * sizeof(double));
+    result->input.len = input.len;
+    result->input.cap = input.len;
+    *out = result;
+    return 0;
+}
+
+static int rpc_getName(void*, char** result) {
+    *result = strdup("allocatedInFunction");
+    return 0;
+}
+
+static dyn_interface_type* rpc_parseInterface(const char *file) {
+    dyn_interface_type *intf = nullptr;
+    FILE *desc = fopen(file, "r");
+    CHECK(desc != nullptr);
+    int rc = dynInterface_parse(desc, &intf);
+    CHECK_EQUAL(0, rc);
+    fclose(desc);
+    return intf;
+}
+
+/**
+ * Encodes a request, invokes it on the service and decodes the reply, like a remote call would.
+ */
+static int rpc_roundtrip(dyn_interface_type *intf, void *service, const char *id, void *args[], int *replyStatus) {
+    struct method_entry *method = nullptr;
+    int rc = dynInterface_findMethod(intf, id, &method);
+    CHECK_EQUAL(0, rc);
+
+    uint8_t *request = nullptr;
+    size_t requestLen = 0;
+    rc = avrobinRpc_prepareInvokeRequest(method->dynFunc, id, 7, args, &request, &requestLen);
+    CHECK_EQUAL(0, rc);
+    CHECK_TRUE(avrobinRpc_isMessage(request, requestLen));
+
+    uint8_t *reply = nullptr;
+    size_t replyLen = 0;
+    rc = avrobinRpc_call(intf, service, request, requestLen, &reply, &replyLen);
+    free(request);
+    if (rc == 0) {
+        rc = avrobinRpc_handleReply(method->dynFunc, 7, reply, replyLen, args, replyStatus);
+        free(reply);
+    }
+    return rc;
+}
+
+static void rpcPreAllocatedTest(void) {
+    dyn_interface_type *intf = rpc_parseInterface("descriptors/example1.descriptor");
+    rpc_calculator calc {nullptr, rpc_add, rpc_sub, nullptr, rpc_stats};
+    void *handle = nullptr;
+
+    double a = 1.5;
+    double b = 2.0;
+    double result = 0.0;
+    double *resultPtr = &result;
+    void *args[4] = {&handle, &a, &b, &resultPtr};
+    int replyStatus = -1;
+    int rc = rpc_roundtrip(intf, &calc, "add(DD)D", args, &replyStatus);
+    CHECK_EQUAL(0, rc);
+    CHECK_EQUAL(0, replyStatus);
+    CHECK_EQUAL(3.5, result);
+
+    //remote error status is forwarded, output is not touched
+    result = 0.0;
+    rc = rpc_roundtrip(intf, &calc, "sub(DD)D", args, &replyStatus);
+    CHECK_EQUAL(0, rc);
+    CHECK_EQUAL(42, replyStatus);
+    CHECK_EQUAL(0.0, result);
+
+    dynInterface_destroy(intf);
+}
+
+static void rpcOutputTest(void) {
+    dyn_interface_type *intf = rpc_parseInterface("descriptors/example1.descriptor");
+    rpc_calculator calc {nullptr, rpc_add, rpc_sub, nullptr, rpc_stats};
+    void *handle = nullptr;
+
+    double values[3] = {1.0, 2.0, 6.0};
+    rpc_seq input {3, 3, values};
+    rpc_stats_result *result = nullptr;
+    void *out = &result;
+    void *args[3] = {&handle, &input, &out};
+    int replyStatus = -1;
+    int rc = rpc_roundtrip(intf, &calc, "stats([D)LStatsResult;", args, &replyStatus);
+    CHECK_EQUAL(0, rc);
+    CHECK_EQUAL(0, replyStatus);
+    CHECK(result != nullptr);
+    CHECK_EQUAL(3.0, result->average);
+    CHECK_EQUAL(1.0, result->min);
+    CHECK_EQUAL(6.0, result->max);
+    CHECK_EQUAL(3, result->input.len);
+    CHECK_EQUAL(2.0, result->input.buf[1]);
+
+    free(result->input.buf);
+    free(result);
+    dynInterface_destroy(intf);
+}
+
+static void rpcOutputTextTest(void) {
+    dyn_interface_type *intf = rpc_parseInterface("descriptors/example4.descriptor");
+    rpc_example4 serv {nullptr, rpc_getName};
+    void *handle = nullptr;
+
+    char *result = nullptr;
+    void *out = &result;
+    void *args[2] = {&handle, &out};
+    int replyStatus = -1;
+    int rc = rpc_roundtrip(intf, &serv, "getName(V)t", args, &replyStatus);
+    CHECK_EQUAL(0, rc);
+    CHECK_EQUAL(0, replyStatus);
+    STRCMP_EQUAL("allocatedInFunction", result);
+
+    free(result);
+    dynInterface_destroy(intf);
+}
+
+static void rpcInvalidTest(void) {
+    dyn_interface_type *intf = rpc_parseInterface("descriptors/example1.descriptor");
+    rpc_calculator calc {nullptr, rpc_add, rpc_sub, nullptr, rpc_stats};
+    struct method_entry *method = nullptr;
+    dynInterface_findMethod(intf, "add(DD)D", &method);
+
+    void *handle = nullptr;
+    double a = 1.0;
+    double b = 2.0;
+    double result = 0.0;
+    double *resultPtr = &result;
+    void *args[4] = {&handle, &a, &b, &resultPtr};
+    uint8_t *request = nullptr;
+    size_t requestLen = 0;
+    int rc = avrobinRpc_prepareInvokeRequest(method->dynFunc, "add(DD)D", 1, args, &request, &requestLen);
+    CHECK_EQUAL(0, rc);
+
+    //truncated requests
+    for (size_t len = 0; len < requestLen; ++len) {
+        uint8_t *reply = nullptr;
+        size_t replyLen = 0;
+        rc = avrobinRpc_call(intf, &calc, request, len, &reply, &replyLen);
+        CHECK(rc != 0);
+        CHECK(reply == nullptr);
+    }
+
+    //reply for another call id
+    uint8_t *reply = nullptr;
+    size_t replyLen = 0;
+    rc = avrobinRpc_call(intf, &calc, request, requestLen, &reply, &replyLen);
+    CHECK_EQUAL(0, rc);
+    int replyStatus = -1;
+    rc = avrobinRpc_handleReply(method->dynFunc, 2, reply, replyLen, args, &replyStatus);
+    CHECK(rc != 0);
+
+    //a request is not a reply
+    rc = avrobinRpc_handleReply(method->dynFunc, 1, request, requestLen, args, &replyStatus);
+    CHECK(rc != 0);
+
+    //json is not an avrobin rpc message
+    const char *json = R"({"m":"add(DD)D", "a": [1.0,2.0]})";
+    CHECK_FALSE(avrobinRpc_isMessage((const uint8_t*)json, strlen(json)));
+
+    free(reply);
+    free(request);
+    dynInterface_destroy(intf);
+}
+
+static void rpcBatchTest(void) {
+    dyn_interface_type *intf = rpc_parseInterface("descriptors/example1.descriptor");
+    rpc_calculator calc {nullptr, rpc_add, rpc_sub, nullptr, rpc_stats};
+    struct method_entry *add = nullptr;
+    struct method_entry *sub = nullptr;
+    dynInterface_findMethod(intf, "add(DD)D", &add);
+    dynInterface_findMethod(intf, "sub(DD)D", &sub);
+
+    void *handle = nullptr;
+    double a = 1.0;
+    double b = 2.0;
+    double result = 0.0;
+    double *resultPtr = &result;
+    void *args[4] = {&handle, &a, &b, &resultPtr};
+
+    uint8_t *requests[3] = {nullptr, nullptr, nullptr};
+    size_t requestLengths[3] = {0, 0, 0};
+    int rc = avrobinRpc_prepareInvokeRequest(add->dynFunc, "add(DD)D", 1, args, &requests[0], &requestLengths[0]);
+    CHECK_EQUAL(0, rc);
+    rc = avrobinRpc_prepareInvokeRequest(sub->dynFunc, "sub(DD)D", 2, args, &requests[1], &requestLengths[1]);
+    CHECK_EQUAL(0, rc);
+    a = 3.0;
+    rc = avrobinRpc_prepareInvokeRequest(add->dynFunc, "add(DD)D", 3, args, &requests[2], &requestLengths[2]);
+    CHECK_EQUAL(0, rc);
+    //a call which cannot be handled does not fail the batch
+    requestLengths[1] = 3;
+
+    uint8_t *request = nullptr;
+    size_t requestLen = 0;
+    rc = avrobinRpc_prepareBatchRequest(requests, requestLengths, 3, &request, &requestLen);
+    CHECK_EQUAL(0, rc);
+    CHECK_TRUE(avrobinRpc_isMessage(request, requestLen));
+
+    uint8_t *reply = nullptr;
+    size_t replyLen = 0;
+    rc = avrobinRpc_call(intf, &calc, request, requestLen, &reply, &replyLen);
+    CHECK_EQUAL(0, rc);
+
+    const uint8_t *replies[3];
+    size_t replyLengths[3];
+    rc = avrobinRpc_splitBatchReply(reply, replyLen, 3, replies, replyLengths);
+    CHECK_EQUAL(0, rc);
+    CHECK_EQUAL(0, replyLengths[1]);
+
+    int replyStatus = -1;
+    rc = avrobinRpc_handleReply(add->dynFunc, 1, replies[0], replyLengths[0], args, &replyStatus);
+    CHECK_EQUAL(0, rc);
+    CHECK_EQUAL(0, replyStatus);
+    CHECK_EQUAL(3.0, result);
+    rc = avrobinRpc_handleReply(add->dynFunc, 3, replies[2], replyLengths[2], args, &replyStatus);
+    CHECK_EQUAL(0, rc);
+    CHECK_EQUAL(5.0, result);
+
+    //the reply count must match
+    rc = avrobinRpc_splitBatchReply(reply, replyLen, 2, replies, replyLengths);
+    CHECK(rc != 0);
+
+    for (auto req : requests) {
+        free(req);
+    }
+    free(request);
+    free(reply);
+    dynInterface_destroy(intf);
+}
+}
+
+TEST_GROUP(AvrobinRpcTests) {
+    void setup() override {
+        int lvl = 1;
+        dynCommon_logSetup(stdLog, nullptr, lvl);
+        dynType_logSetup(stdLog, nullptr,lvl);
+        dynFunction_logSetup(stdLog, nullptr,lvl);
+        dynInterface_logSetup(stdLog, nullptr,lvl);
+        avrobinSerializer_logSetup(stdLog, nullptr, lvl);
+        avrobinRpc_logSetup(stdLog, nullptr, lvl);
+    }
+};
+
+TEST(AvrobinRpcTests, preAllocated) {
+    rpcPreAllocatedTest();
+}
+
+TEST(AvrobinRpcTests, output) {
+    rpcOutputTest();
+}
+
+TEST(AvrobinRpcTests, outputText) {
+    rpcOutputTextTest();
+}
+
+TEST(AvrobinRpcTests, invalid) {
+    rpcInvalidTest();
+}
+
+TEST(AvrobinRpcTests, batch) {
+    rpcBatchTest();
+}
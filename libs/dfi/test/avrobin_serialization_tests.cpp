@@ -590,6 +590,267 @@ static void generalTests() {
     }
 }
 
+
+static void bufferTests() {
+    dyn_type *type = NULL;
+    int rc = dynType_parseWithStr(test8_descriptor, "test8", NULL, &type);
+    CHECK_EQUAL(0, rc);
+
+    struct test8_subtype items[100];
+    for (int i = 0; i < 100; ++i) {
+        items[i].one = i;
+        items[i].two = -i;
+    }
+    struct test8_type val;
+    val.cap = 100;
+    val.len = 0;
+    val.buf = items;
+
+    //note the buffer is reused and grown when needed
+    uint8_t *buffer = NULL;
+    size_t bufferSize = 0;
+    size_t serdatalen = 0;
+    for (uint32_t len = 0; len <= 100; len += 25) {
+        val.len = len;
+        rc = avrobinSerializer_serializeToBuffer(type, &val, &buffer, &bufferSize, &serdatalen);
+        CHECK_EQUAL(0, rc);
+        CHECK(buffer != NULL);
+        CHECK(serdatalen <= bufferSize);
+
+        uint8_t *serdata = NULL;
+        size_t len2 = 0;
+        rc = avrobinSerializer_serialize(type, &val, &serdata, &len2);
+        CHECK_EQUAL(0, rc);
+        CHECK_EQUAL(serdatalen, len2);
+        CHECK(memcmp(serdata, buffer, serdatalen) == 0);
+        free(serdata);
+
+        void *inst = NULL;
+        rc = avrobinSerializer_deserialize(type, buffer, serdatalen, &inst);
+        CHECK_EQUAL(0, rc);
+        struct test8_type *result = (struct test8_type*)inst;
+        CHECK_EQUAL(len, result->len);
+        for (uint32_t i = 0; i < result->len; ++i) {
+            DOUBLES_EQUAL((double)i, result->buf[i].one, 0.0001);
+            DOUBLES_EQUAL(-(double)i, result->buf[i].two, 0.0001);
+        }
+        dynType_free(type, inst);
+
+        //truncated input is rejected
+        if (len > 0) {
+            inst = NULL;
+            rc = avrobinSerializer_deserialize(type, buffer, serdatalen - 1, &inst);
+            CHECK(rc != 0);
+        }
+    }
+    free(buffer);
+    dynType_destroy(type);
+}
+
+static void numberSequenceTests() {
+    dyn_type *type = NULL;
+    int rc = dynType_parseWithStr("{[D[F[I[J[s doubles floats ints longs shorts}", "numbers", NULL, &type);
+    CHECK_EQUAL(0, rc);
+
+    struct number_sequences {
+        struct { uint32_t cap; uint32_t len; double *buf; } doubles;
+        struct { uint32_t cap; uint32_t len; float *buf; } floats;
+        struct { uint32_t cap; uint32_t len; int32_t *buf; } ints;
+        struct { uint32_t cap; uint32_t len; int64_t *buf; } longs;
+        struct { uint32_t cap; uint32_t len; uint16_t *buf; } shorts;
+    };
+
+    double doubles[] = {1.0};
+    float floats[] = {-2.0f};
+    int32_t ints[] = {-1, 64};
+    int64_t longs[] = {INT64_MIN};
+    uint16_t shorts[] = {65535};
+    struct number_sequences val = {{1, 1, doubles}, {1, 1, floats}, {2, 2, ints}, {1, 1, longs}, {1, 1, shorts}};
+
+    uint8_t *serdata = NULL;
+    size_t serdatalen = 0;
+    rc = avrobinSerializer_serialize(type, &val, &serdata, &serdatalen);
+    CHECK_EQUAL(0, rc);
+    const uint8_t expected[] = {
+        0x02, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xF0, 0x3F, 0x00, //[1.0]
+        0x02, 0x00, 0x00, 0x00, 0xC0, 0x00, //[-2.0f]
+        0x04, 0x01, 0x80, 0x01, 0x00, //[-1, 64]
+        0x02, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0x01, 0x00, //[INT64_MIN]
+        0x02, 0xFE, 0xFF, 0x07, 0x00 //[65535]
+    };
+    CHECK_EQUAL(sizeof(expected), serdatalen);
+    CHECK(memcmp(expected, serdata, serdatalen) == 0);
+
+    void *inst = NULL;
+    rc = avrobinSerializer_deserialize(type, serdata, serdatalen, &inst);
+    CHECK_EQUAL(0, rc);
+    struct number_sequences *result = (struct number_sequences*)inst;
+    DOUBLES_EQUAL(1.0, result->doubles.buf[0], 0.0);
+    DOUBLES_EQUAL(-2.0, result->floats.buf[0], 0.0);
+    CHECK_EQUAL(2, result->ints.len);
+    CHECK_EQUAL(-1, result->ints.buf[0]);
+    CHECK_EQUAL(64, result->ints.buf[1]);
+    CHECK(INT64_MIN == result->longs.buf[0]);
+    CHECK_EQUAL(65535, result->shorts.buf[0]);
+    dynType_free(type, inst);
+
+    //a truncated double sequence is rejected
+    inst = NULL;
+    rc = avrobinSerializer_deserialize(type, serdata, 5, &inst);
+    CHECK(rc != 0);
+    free(serdata);
+
+    //large sequence roundtrip
+    dynType_destroy(type);
+    rc = dynType_parseWithStr("[D", "samples", NULL, &type);
+    CHECK_EQUAL(0, rc);
+    double samples[4096];
+    for (int i = 0; i < 4096; ++i) {
+        samples[i] = i * 0.25 - 100.0;
+    }
+    struct { uint32_t cap; uint32_t len; double *buf; } seq = {4096, 4096, samples};
+    rc = avrobinSerializer_serialize(type, &seq, &serdata, &serdatalen);
+    CHECK_EQUAL(0, rc);
+    CHECK_EQUAL(2 + 4096 * 8 + 1, serdatalen);
+    rc = avrobinSerializer_deserialize(type, serdata, serdatalen, &inst);
+    CHECK_EQUAL(0, rc);
+    CHECK(memcmp(samples, ((decltype(seq)*)inst)->buf, sizeof(samples)) == 0);
+    dynType_free(type, inst);
+    free(serdata);
+    dynType_destroy(type);
+}
+
+static void arenaTests() {
+    dyn_type *type = NULL;
+    int rc = dynType_parseWithStr("{t[t*{DD a b} name names c}", "arena", NULL, &type);
+    CHECK_EQUAL(0, rc);
+
+    struct arena_names {
+        uint32_t cap;
+        uint32_t len;
+        char **buf;
+    };
+    struct arena_type {
+        char *name;
+        struct arena_names names;
+        struct test11_subtype *c;
+    };
+
+    char *names[] = {(char*)"first", (char*)"", (char*)"third"};
+    struct test11_subtype sub = {1.5, -2.5};
+    struct arena_type val = {(char*)"message", {3, 3, names}, &sub};
+    uint8_t *serdata = NULL;
+    size_t serdatalen = 0;
+    rc = avrobinSerializer_serialize(type, &val, &serdata, &serdatalen);
+    CHECK_EQUAL(0, rc);
+
+    celix_arena_t *arena = celix_arena_create(0);
+    for (int i = 0; i < 3; ++i) {
+        void *inst = NULL;
+        rc = avrobinSerializer_deserializeInArena(type, serdata, serdatalen, arena, &inst);
+        CHECK_EQUAL(0, rc);
+        struct arena_type *result = (struct arena_type*)inst;
+        STRCMP_EQUAL("message", result->name);
+        CHECK_EQUAL(3, result->names.len);
+        STRCMP_EQUAL("first", result->names.buf[0]);
+        STRCMP_EQUAL("", result->names.buf[1]);
+        STRCMP_EQUAL("third", result->names.buf[2]);
+        CHECK(result->c != NULL);
+        DOUBLES_EQUAL(1.5, result->c->a, 0.0001);
+        DOUBLES_EQUAL(-2.5, result->c->b, 0.0001);
+        CHECK(celix_arena_allocatedSize(arena) > 0);
+
+        //the complete message is released at once
+        celix_arena_reset(arena);
+        CHECK_EQUAL(0, celix_arena_allocatedSize(arena));
+    }
+
+    void *inst = NULL;
+    rc = avrobinSerializer_deserializeInArena(type, serdata, serdatalen - 1, arena, &inst);
+    CHECK(rc != 0);
+    rc = avrobinSerializer_deserializeInArena(type, serdata, serdatalen, NULL, &inst);
+    CHECK(rc != 0);
+    free(serdata);
+    dynType_destroy(type);
+
+    //multiple array blocks (incl. a block with byte size), grows the arena sequence
+    rc = dynType_parseWithStr("[I", "blocks", NULL, &type);
+    CHECK_EQUAL(0, rc);
+    const uint8_t blocks[] = {0x01, 0x04, 0x06, 0x04, 0x02, 0x04, 0x00};
+    celix_arena_reset(arena);
+    rc = avrobinSerializer_deserializeInArena(type, blocks, sizeof(blocks), arena, &inst);
+    CHECK_EQUAL(0, rc);
+    struct test6_type {
+        uint32_t cap;
+        uint32_t len;
+        int32_t *buf;
+    } *seq = (struct test6_type*)inst;
+    CHECK_EQUAL(3, seq->len);
+    CHECK_EQUAL(3, seq->buf[0]);
+    CHECK_EQUAL(1, seq->buf[1]);
+    CHECK_EQUAL(2, seq->buf[2]);
+
+    rc = avrobinSerializer_deserialize(type, blocks, sizeof(blocks), &inst);
+    CHECK_EQUAL(0, rc);
+    seq = (struct test6_type*)inst;
+    CHECK_EQUAL(3, seq->len);
+    CHECK_EQUAL(2, seq->buf[2]);
+    dynType_free(type, inst);
+
+    celix_arena_destroy(arena);
+    dynType_destroy(type);
+}
+
+static void olderVersionTests() {
+    //the older version of test2 only has the first 2 fields
+    dyn_type *writerType = NULL;
+    dyn_type *readerType = NULL;
+    int rc = dynType_parseWithStr("{II a b}", "test2_v1", NULL, &writerType);
+    CHECK_EQUAL(0, rc);
+    rc = dynType_parseWithStr(test2_descriptor, "test2", NULL, &readerType);
+    CHECK_EQUAL(0, rc);
+
+    struct test2_v1_type {
+        int32_t a;
+        int32_t b;
+    } val = {-3, 42};
+    uint8_t *serdata = NULL;
+    size_t serdatalen = 0;
+    rc = avrobinSerializer_serialize(writerType, &val, &serdata, &serdatalen);
+    CHECK_EQUAL(0, rc);
+
+    //the nr of values of the writer version is resolved from the input, the appended fields are zero
+    size_t nrOfValues = 0;
+    void *inst = NULL;
+    rc = avrobinSerializer_deserializeValues(readerType, serdata, serdatalen, &nrOfValues, &inst);
+    CHECK_EQUAL(0, rc);
+    CHECK_EQUAL(2, nrOfValues);
+    struct test2_type *result = (struct test2_type*)inst;
+    CHECK_EQUAL(-3, result->a);
+    CHECK_EQUAL(42, result->b);
+    CHECK_EQUAL(0, result->c);
+    CHECK_EQUAL(0, result->d);
+    dynType_free(readerType, inst);
+
+    //with a cached nr of values the input is checked against it
+    rc = avrobinSerializer_deserializeValues(readerType, serdata, serdatalen, &nrOfValues, &inst);
+    CHECK_EQUAL(0, rc);
+    CHECK_EQUAL(42, ((struct test2_type*)inst)->b);
+    dynType_free(readerType, inst);
+
+    nrOfValues = 3;
+    inst = NULL;
+    rc = avrobinSerializer_deserializeValues(readerType, serdata, serdatalen, &nrOfValues, &inst);
+    CHECK(rc != 0);
+    CHECK(inst == NULL);
+    nrOfValues = 5; //more than the reader type has
+    rc = avrobinSerializer_deserializeValues(readerType, serdata, serdatalen, &nrOfValues, &inst);
+    CHECK(rc != 0);
+
+    free(serdata);
+    dynType_destroy(writerType);
+    dynType_destroy(readerType);
+}
 }
 
 TEST_GROUP(AvrobinSerializerTests) {
@@ -602,3 +863,19 @@ TEST_GROUP(AvrobinSerializerTests) {
 TEST(AvrobinSerializerTests, GeneralTests) {
     generalTests();
 }
+
+TEST(AvrobinSerializerTests, BufferTests) {
+    bufferTests();
+}
+
+TEST(AvrobinSerializerTests, ArenaTests) {
+    arenaTests();
+}
+
+TEST(AvrobinSerializerTests, NumberSequenceTests) {
+    numberSequenceTests();
+}
+
+TEST(AvrobinSerializerTests, OlderVersionTests) {
+    olderVersionTests();
+}
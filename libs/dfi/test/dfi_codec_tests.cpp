@@ -0,0 +1,246 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *  KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+#include <CppUTest/TestHarness.h>
+#include "CppUTest/CommandLineTestRunner.h"
+
+extern "C" {
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdarg.h>
+
+#include "dfi_codec.h"
+#include "dyn_message.h"
+#include "dyn_interface.h"
+#include "dyn_type_common.h"
+#include "json_serializer.h"
+#include "json_rpc.h"
+#include "avrobin_serializer.h"
+
+//note the test executable contains codecs generated (see CMakeLists.txt) for msg_example1-3 and example1 descriptors
+
+static void stdLog(void*, int level, const char *file, int line, const char *msg, ...) {
+    va_list ap;
+    const char *levels[5] = {"NIL", "ERROR", "WARNING", "INFO", "DEBUG"};
+    fprintf(stderr, "%s: FILE:%s, LINE:%i, MSG:",levels[level], file, line);
+    va_start(ap, msg);
+    vfprintf(stderr, msg, ap);
+    fprintf(stderr, "\n");
+    va_end(ap);
+}
+
+static dyn_message_type* parseMessage(const char *path) {
+    dyn_message_type *msg = NULL;
+    FILE *desc = fopen(path, "r");
+    CHECK(desc != NULL);
+    int rc = dynMessage_parse(desc, &msg);
+    CHECK_EQUAL(0, rc);
+    fclose(desc);
+    return msg;
+}
+
+/**
+ * Checks that the generated codec gives the same results as the dynamic serializers.
+ */
+static void messageTest(const char *path, const char *input) {
+    dyn_message_type *msg = parseMessage(path);
+    dyn_type *type = NULL;
+    dynMessage_getMessageType(msg, &type);
+    const dfi_message_codec_t *codec = dfiCodec_messageCodec(type);
+    CHECK(codec != NULL);
+
+    void *dynInst = NULL;
+    void *genInst = NULL;
+    char *dynJson = NULL;
+    char *genJson = NULL;
+    uint8_t *dynAvro = NULL;
+    uint8_t *genAvro = NULL;
+    size_t dynAvroLen = 0;
+    size_t genAvroLen = 0;
+
+    type->codec = NULL; //dynamic path
+    CHECK_EQUAL(0, jsonSerializer_deserialize(type, input, &dynInst));
+    CHECK_EQUAL(0, jsonSerializer_serialize(type, dynInst, &dynJson));
+    CHECK_EQUAL(0, avrobinSerializer_serialize(type, dynInst, &dynAvro, &dynAvroLen));
+
+    type->codec = codec;
+    CHECK_EQUAL(0, jsonSerializer_deserialize(type, input, &genInst));
+    CHECK_EQUAL(0, jsonSerializer_serialize(type, genInst, &genJson));
+    STRCMP_EQUAL(dynJson, genJson);
+    CHECK_EQUAL(0, avrobinSerializer_serialize(type, genInst, &genAvro, &genAvroLen));
+    CHECK_EQUAL(dynAvroLen, genAvroLen);
+    CHECK(memcmp(dynAvro, genAvro, dynAvroLen) == 0);
+    dynType_free(type, genInst);
+    free(genJson);
+
+    genInst = NULL;
+    genJson = NULL;
+    CHECK_EQUAL(0, avrobinSerializer_deserialize(type, dynAvro, dynAvroLen, &genInst));
+    CHECK_EQUAL(0, jsonSerializer_serialize(type, genInst, &genJson));
+    STRCMP_EQUAL(dynJson, genJson);
+
+    void *invalid = NULL;
+    CHECK(jsonSerializer_deserialize(type, "{\"unknown\":1}", &invalid) != 0);
+
+    dynType_free(type, dynInst);
+    dynType_free(type, genInst);
+    free(dynJson);
+    free(genJson);
+    free(dynAvro);
+    free(genAvro);
+    dynMessage_destroy(msg);
+}
+
+static void messageTests(void) {
+    messageTest("descriptors/msg_example1.descriptor",
+            R"({"location":{"lat":1.5,"long":-2.25},"name":"né\"x","description":"a description"})");
+    messageTest("descriptors/msg_example2.descriptor",
+            R"({"trackid":3,"lastupdate":{"day":1,"month":2,"year":2020,"hour":1,"minute":2,"second":3,"microseconds":4},)"
+            R"("abspos":{"lat":1,"lon":2},"relpos":{"azimuth":1e10,"elevation":0.1,"range":3},"classification":-1,"identity":2})");
+    messageTest("descriptors/msg_example3.descriptor",
+            R"({"timestamp":{"day":1},"severity":2,"eventdescription":"x"})");
+}
+
+struct double_seq {
+    uint32_t cap;
+    uint32_t len;
+    double *buf;
+};
+
+struct stats_result {
+    double average;
+    double min;
+    double max;
+    struct double_seq input;
+};
+
+static int calc_add(void*, double a, double b, double *result) {
+    *result = a + b;
+    return 0;
+}
+
+static int calc_sub(void*, double a, double b, double *result) {
+    *result = a - b;
+    return 0;
+}
+
+static int calc_sqrt(void*, double a, double *result) {
+    *result = a;
+    return 0;
+}
+
+static int calc_stats(void*, struct double_seq input, struct stats_result **out) {
+    if (input.len == 0) {
+        return 1;
+    }
+    struct stats_result *result = (struct stats_result*)calloc(1, sizeof(*result));
+    double total = 0.0;
+    result->min = input.buf[0];
+    result->max = input.buf[0];
+    for (uint32_t i = 0; i < input.len; ++i) {
+        total += input.buf[i];
+        result->min = input.buf[i] < result->min ? input.buf[i] : result->min;
+        result->max = input.buf[i] > result->max ? input.buf[i] : result->max;
+    }
+    result->average = total / input.len;
+    *out = result;
+    return 0;
+}
+
+static void rpcTests(void) {
+    dyn_interface_type *intf = NULL;
+    FILE *desc = fopen("descriptors/example1.descriptor", "r");
+    CHECK(desc != NULL);
+    int rc = dynInterface_parse(desc, &intf);
+    CHECK_EQUAL(0, rc);
+    fclose(desc);
+
+    struct {
+        void *handle;
+        int (*add)(void*, double, double, double*);
+        int (*sub)(void*, double, double, double*);
+        int (*sqrt)(void*, double, double*);
+        int (*stats)(void*, struct double_seq, struct stats_result**);
+    } calc = {nullptr, calc_add, calc_sub, calc_sqrt, calc_stats};
+
+    char *out = NULL;
+    rc = jsonRpc_call(intf, &calc, R"({"m":"add(DD)D","a":[1.0,2.5]})", &out);
+    CHECK_EQUAL(0, rc);
+    STRCMP_EQUAL(R"({"r":3.5})", out);
+    free(out);
+
+    rc = jsonRpc_call(intf, &calc, R"({"m":"stats([D)LStatsResult;", "a":[[1,2,6]]})", &out);
+    CHECK_EQUAL(0, rc);
+    STRCMP_EQUAL(R"({"r":{"average":3.0,"min":1.0,"max":6.0,"input":[]}})", out);
+    free(out);
+
+    rc = jsonRpc_call(intf, &calc, R"({"m":"stats([D)LStatsResult;", "a":[[]]})", &out);
+    CHECK_EQUAL(0, rc);
+    STRCMP_EQUAL(R"({"e":1})", out);
+    free(out);
+
+    struct methods_head *methods = NULL;
+    dynInterface_methods(intf, &methods);
+    struct method_entry *method = NULL;
+    TAILQ_FOREACH(method, methods, entries) {
+        if (strcmp(method->id, "stats([D)LStatsResult;") == 0) {
+            double values[3] = {1.0, 2.0, 6.0};
+            struct double_seq input = {3, 3, values};
+            void *handle = NULL;
+            struct stats_result *result = NULL;
+            struct stats_result **resultLoc = &result;
+            void *args[3] = {&handle, &input, &resultLoc};
+
+            rc = jsonRpc_prepareInvokeRequest(method->dynFunc, method->id, args, &out);
+            CHECK_EQUAL(0, rc);
+            STRCMP_EQUAL(R"({"m":"stats([D)LStatsResult;","a":[[1.0,2.0,6.0]]})", out);
+            free(out);
+
+            rc = jsonRpc_handleReply(method->dynFunc, R"({"r":{"average":3,"min":1,"max":6,"input":[1,2]}})", args);
+            CHECK_EQUAL(0, rc);
+            CHECK(result != NULL);
+            DOUBLES_EQUAL(3.0, result->average, 0.0001);
+            CHECK_EQUAL(2, result->input.len);
+            free(result->input.buf);
+            free(result);
+        }
+    }
+
+    dynInterface_destroy(intf);
+}
+}
+
+TEST_GROUP(DfiCodecTests) {
+    void setup() {
+        int lvl = 1;
+        dfiCodec_logSetup(stdLog, NULL, lvl);
+        dynMessage_logSetup(stdLog, NULL, lvl);
+        dynInterface_logSetup(stdLog, NULL, lvl);
+        jsonSerializer_logSetup(stdLog, NULL, lvl);
+        jsonRpc_logSetup(stdLog, NULL, lvl);
+    }
+};
+
+TEST(DfiCodecTests, MessageTests) {
+    messageTests();
+}
+
+TEST(DfiCodecTests, RpcTests) {
+    rpcTests();
+}
@@ -30,6 +30,7 @@ extern "C" {
 
     #include "dyn_common.h"
     #include "dyn_function.h"
+    #include "dyn_function_common.h"
 
     static void stdLog(void*, int level, const char *file, int line, const char *msg, ...) {
         va_list ap;
@@ -238,6 +239,83 @@ extern "C" {
         int rc = dynFunction_parseWithStr(INVALID_FUNC_TYPE_DESCRIPTOR, NULL, &dynFunc);
         CHECK_EQUAL(3, rc); //Parse Error
     }
+
+    #define INVOKER_DESCRIPTOR "calc(#am=handle;PDD#am=pre;*D)N"
+    static int invokerCalc(void *handle, double a, double b, double *out) {
+        CHECK(handle != NULL);
+        *out = a * b;
+        return 3;
+    }
+
+    #define FFI_DESCRIPTOR "calc(#am=handle;PDDD#am=pre;*D)N"
+    static int ffiCalc(void *handle, double a, double b, double c, double *out) {
+        CHECK(handle != NULL);
+        *out = a * b * c;
+        return 4;
+    }
+
+    static void invokerBind(void *userData, void *args[], void *ret) {
+        *(int *)ret = *(int *)userData + **(int **)args[0];
+    }
+
+    static void test_invokers(void) {
+        dyn_function_type *dynFunc = NULL;
+        int rc = dynFunction_parseWithStr(INVOKER_DESCRIPTOR, NULL, &dynFunc);
+        CHECK_EQUAL(0, rc);
+        CHECK(dynFunc->invoker != NULL); //statically generated invoker, without libffi
+
+        int handleVal = 0;
+        void *handle = &handleVal;
+        double a = 2.0;
+        double b = 3.5;
+        double result = 0.0;
+        double *out = &result;
+        void *args[5] = {&handle, &a, &b, &out, NULL};
+        int rVal = 0;
+        rc = dynFunction_call(dynFunc, (void(*)(void))invokerCalc, &rVal, args);
+        CHECK_EQUAL(0, rc);
+        CHECK_EQUAL(3, rVal);
+        CHECK_EQUAL(7.0, result);
+        dynFunction_destroy(dynFunc);
+
+        //no invoker for 5 arguments, libffi fallback
+        rc = dynFunction_parseWithStr(FFI_DESCRIPTOR, NULL, &dynFunc);
+        CHECK_EQUAL(0, rc);
+        CHECK(dynFunc->invoker == NULL);
+        double c = 2.0;
+        args[3] = &c;
+        args[4] = &out;
+        rc = dynFunction_call(dynFunc, (void(*)(void))ffiCalc, &rVal, args);
+        CHECK_EQUAL(0, rc);
+        CHECK_EQUAL(4, rVal);
+        CHECK_EQUAL(14.0, result);
+        dynFunction_destroy(dynFunc);
+
+        //released closures are reused
+        void (*fn1)(void) = NULL;
+        void (*fn2)(void) = NULL;
+        int base1 = 10;
+        int base2 = 20;
+        int val = 1;
+        int *valPtr = &val;
+        void *closureArgs[1] = {&valPtr};
+        rc = dynFunction_parseWithStr("f(*I)N", NULL, &dynFunc);
+        CHECK_EQUAL(0, rc);
+        rc = dynFunction_createClosure(dynFunc, invokerBind, &base1, &fn1);
+        CHECK_EQUAL(0, rc);
+        rc = dynFunction_call(dynFunc, fn1, &rVal, closureArgs);
+        CHECK_EQUAL(11, rVal);
+        dynFunction_destroy(dynFunc);
+
+        rc = dynFunction_parseWithStr("f(*I)N", NULL, &dynFunc);
+        CHECK_EQUAL(0, rc);
+        rc = dynFunction_createClosure(dynFunc, invokerBind, &base2, &fn2);
+        CHECK_EQUAL(0, rc);
+        POINTERS_EQUAL((void*)fn1, (void*)fn2);
+        rc = dynFunction_call(dynFunc, fn2, &rVal, closureArgs);
+        CHECK_EQUAL(21, rVal);
+        dynFunction_destroy(dynFunc);
+    }
 }
 
 TEST_GROUP(DynFunctionTests) {
@@ -274,3 +352,7 @@ TEST(DynFunctionTests, InvalidDynFuncTest) {
     test_invalidDynFuncType();
 }
 
+
+TEST(DynFunctionTests, InvokerTest) {
+    test_invokers();
+}
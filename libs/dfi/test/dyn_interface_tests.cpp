@@ -97,6 +97,19 @@ extern "C" {
         int count = dynInterface_nrOfMethods(dynIntf);
         CHECK_EQUAL(4, count);
 
+        struct method_entry *method = NULL;
+        status = dynInterface_findMethod(dynIntf, "sqrt(D)D", &method);
+        CHECK_EQUAL(0, status);
+        STRCMP_EQUAL("sqrt(D)D", method->id);
+        STRCMP_EQUAL("1000", dynInterface_getMethodAnnotation(dynIntf, method, "cacheTtlMs"));
+        POINTERS_EQUAL(NULL, dynInterface_getMethodAnnotation(dynIntf, method, "nonExisting"));
+        status = dynInterface_findMethod(dynIntf, "stats([D)LStatsResult;", &method);
+        CHECK_EQUAL(0, status);
+        STRCMP_EQUAL("stats", method->name);
+        POINTERS_EQUAL(NULL, dynInterface_getMethodAnnotation(dynIntf, method, "cacheTtlMs"));
+        status = dynInterface_findMethod(dynIntf, "nonExisting(D)D", &method);
+        CHECK(status != 0);
+
         dynInterface_destroy(dynIntf);
     }
 
@@ -182,6 +195,26 @@ extern "C" {
         fclose(desc); desc=NULL;
 
     }
+
+    static void testShared(void) {
+        dyn_interface_type *intf1 = NULL;
+        dyn_interface_type *intf2 = NULL;
+        FILE *desc = fopen("descriptors/example1.descriptor", "r");
+        assert(desc != NULL);
+        CHECK_EQUAL(0, dynInterface_parseShared(desc, &intf1));
+        rewind(desc);
+        CHECK_EQUAL(0, dynInterface_parseShared(desc, &intf2));
+        fclose(desc);
+        POINTERS_EQUAL(intf1, intf2);
+        dynInterface_destroy(intf1);
+        CHECK_EQUAL(4, dynInterface_nrOfMethods(intf2));
+        dynInterface_destroy(intf2);
+
+        desc = fopen("descriptors/invalids/invalid.descriptor", "r");
+        assert(desc != NULL);
+        CHECK(dynInterface_parseShared(desc, &intf1) != 0);
+        fclose(desc);
+    }
 }
 
 
@@ -207,3 +240,7 @@ TEST(DynInterfaceTests, testInvalid) {
     testInvalid();
 }
 
+
+TEST(DynInterfaceTests, testShared) {
+    testShared();
+}
@@ -220,6 +220,98 @@ static void msg_invalid(void) {
 
 }
 
+static void msg_shared(void) {
+	dyn_message_type *msg1 = NULL;
+	dyn_message_type *msg2 = NULL;
+	dyn_message_type *own = NULL;
+	FILE *desc = fopen("descriptors/msg_example1.descriptor", "r");
+	assert(desc != NULL);
+	CHECK_EQUAL(0, dynMessage_parseShared(desc, &msg1));
+	fclose(desc);
+	desc = fopen("descriptors/msg_example1.descriptor", "r");
+	CHECK_EQUAL(0, dynMessage_parseShared(desc, &msg2));
+	rewind(desc);
+	CHECK_EQUAL(0, dynMessage_parse(desc, &own));
+	fclose(desc);
+	POINTERS_EQUAL(msg1, msg2);
+	CHECK(own != msg1);
+	dynMessage_destroy(own);
+
+	//still usable after releasing one reference
+	dynMessage_destroy(msg1);
+	char *name = NULL;
+	CHECK_EQUAL(0, dynMessage_getName(msg2, &name));
+	STRCMP_EQUAL("poi", name);
+	dynMessage_destroy(msg2);
+
+	//another descriptor content is another parse result
+	desc = fopen("descriptors/msg_example2.descriptor", "r");
+	CHECK_EQUAL(0, dynMessage_parseShared(desc, &msg1));
+	fclose(desc);
+	desc = fopen("descriptors/msg_example1.descriptor", "r");
+	CHECK_EQUAL(0, dynMessage_parseShared(desc, &msg2));
+	fclose(desc);
+	CHECK(msg1 != msg2);
+	dynMessage_destroy(msg1);
+	dynMessage_destroy(msg2);
+
+	desc = fopen("descriptors/invalids/invalidMsgHdr.descriptor", "r");
+	assert(desc != NULL);
+	CHECK_EQUAL(1, dynMessage_parseShared(desc, &msg1));
+	fclose(desc);
+}
+
+static const char *avprProtocol = R"({
+	"protocol" : "types", "namespace" : "test.dt", "version" : "1.0.0",
+	"types" : [
+		{ "type" : "record", "name" : "Point", "fields" : [ { "name" : "x", "type" : "double" }, { "name" : "y", "type" : "double" } ] },
+		{ "type" : "record", "name" : "Node", "version" : "2.1.0", "msgId" : 42,
+		  "fields" : [ { "name" : "pos", "type" : "Point" }, { "name" : "other", "type" : "Point", "ptr" : true }, { "name" : "third", "type" : "Point", "ptr" : true } ] }
+	],
+	"messages" : {}
+})";
+
+static void msg_avpr_shared(void) {
+	FILE *stream = fmemopen((char*)avprProtocol, strlen(avprProtocol), "r");
+	dyn_message_type *msg1 = dynMessage_parseAvprShared(stream, "test.dt.Node");
+	fclose(stream);
+	CHECK(msg1 != NULL);
+
+	char *name = NULL;
+	CHECK_EQUAL(0, dynMessage_getName(msg1, &name));
+	STRCMP_EQUAL("test.dt.Node", name);
+	checkMessageVersion(msg1, "2.1.0");
+	char *msgId = NULL;
+	CHECK_EQUAL(0, dynMessage_getAnnotationEntry(msg1, "msgId", &msgId));
+	STRCMP_EQUAL("42", msgId);
+
+	dyn_type *type = NULL;
+	dynMessage_getMessageType(msg1, &type);
+	CHECK_EQUAL(3, dynType_complex_nrOfEntries(type));
+	dyn_type *third = NULL;
+	dynType_complex_dynTypeAt(type, 2, &third);
+	CHECK_EQUAL(DYN_TYPE_TYPED_POINTER, dynType_type(third));
+
+	stream = fmemopen((char*)avprProtocol, strlen(avprProtocol), "r");
+	dyn_message_type *msg2 = dynMessage_parseAvprShared(stream, "test.dt.Node");
+	rewind(stream);
+	dyn_message_type *point = dynMessage_parseAvprShared(stream, "test.dt.Point");
+	rewind(stream);
+	dyn_message_type *own = dynMessage_parseAvpr(stream, "test.dt.Node");
+	fclose(stream);
+	POINTERS_EQUAL(msg1, msg2);
+	CHECK(point != NULL && point != msg1);
+	CHECK(own != NULL && own != msg1);
+	checkMessageVersion(point, "1.0.0");
+
+	dynMessage_destroy(msg1);
+	dynMessage_destroy(msg2);
+	dynMessage_destroy(point);
+	dynMessage_destroy(own);
+
+	CHECK(dynMessage_parseAvprWithStr(avprProtocol, "test.dt.Unknown") == NULL);
+}
+
 }
 
 
@@ -253,3 +345,11 @@ TEST(DynMessageTests, msg_invalid) {
 	msg_invalid();
 }
 
+
+TEST(DynMessageTests, msg_shared) {
+	msg_shared();
+}
+
+TEST(DynMessageTests, msg_avpr_shared) {
+	msg_avpr_shared();
+}
@@ -22,9 +22,11 @@
 
 extern "C" {
     #include <stdarg.h>
+    #include <string.h>
     
     #include "dyn_common.h"
     #include "dyn_type.h"
+    #include "dyn_type_plan.h"
 
 	static void stdLog(void*, int level, const char *file, int line, const char *msg, ...) {
 	    va_list ap;
@@ -298,6 +300,157 @@ TEST(DynTypeTests, SequenceWithPointerTest) {
     dynType_destroy(type);
 }
 
+TEST(DynTypeTests, CopyTest) {
+    struct val {
+        double a;
+        double b;
+    };
+
+    struct item {
+        int64_t a;
+        char *text;
+        struct val val;
+    };
+
+    struct item_sequence {
+        uint32_t cap;
+        uint32_t len;
+        struct item **buf;
+    };
+
+    dyn_type *type = NULL;
+    int rc = dynType_parseWithStr("Tval={DD a b};Titem={Jtlval; a text val};[*litem;", NULL, NULL, &type);
+    CHECK_EQUAL(0, rc);
+
+    struct item_sequence src;
+    src.cap = 4;
+    src.len = 2;
+    src.buf = (struct item **) calloc(4, sizeof(struct item *));
+    for (int i = 0; i < 2; ++i) {
+        src.buf[i] = (struct item *) calloc(1, sizeof(struct item));
+        src.buf[i]->a = 10 + i;
+        src.buf[i]->text = strdup(i == 0 ? "one" : "two");
+        src.buf[i]->val.b = 1.5 * i;
+    }
+
+    struct item_sequence *copy = NULL;
+    rc = dynType_copy(type, &src, (void **)&copy);
+    CHECK_EQUAL(0, rc);
+    CHECK_EQUAL(2, copy->len);
+    CHECK_EQUAL(2, copy->cap);
+    CHECK(copy->buf[0] != src.buf[0]);
+    CHECK(copy->buf[1]->text != src.buf[1]->text);
+    CHECK_EQUAL(11, copy->buf[1]->a);
+    STRCMP_EQUAL("two", copy->buf[1]->text);
+    DOUBLES_EQUAL(1.5, copy->buf[1]->val.b, 0.0001);
+
+    dynType_deepFree(type, &src, false);
+    STRCMP_EQUAL("one", copy->buf[0]->text); //copy is independent of the source
+    dynType_free(type, copy);
+    dynType_destroy(type);
+}
+
+TEST(DynTypeTests, PoolTest) {
+    struct item {
+        int64_t a;
+        char *text;
+    };
+
+    struct msg {
+        int32_t id;
+        struct {
+            uint32_t cap;
+            uint32_t len;
+            struct item *buf;
+        } items;
+        struct item *single;
+    };
+
+    dyn_type *type = NULL;
+    int rc = dynType_parseWithStr("Titem={Jt a text};{I[litem;*litem; id items single}", NULL, NULL, &type);
+    CHECK_EQUAL(0, rc);
+    CHECK_FALSE(dynType_hasPool(type));
+    rc = dynType_enablePool(type, 2, 8);
+    CHECK_EQUAL(0, rc);
+    CHECK_TRUE(dynType_hasPool(type));
+
+    dyn_type *itemsType = NULL;
+    dyn_type *singleType = NULL;
+    dyn_type *itemType = NULL;
+    dynType_complex_dynTypeAt(type, 1, &itemsType);
+    dynType_complex_dynTypeAt(type, 2, &singleType);
+    dynType_typedPointer_getTypedType(singleType, &itemType);
+    CHECK_TRUE(dynType_hasPool(itemsType));
+    CHECK_TRUE(dynType_hasPool(itemType));
+
+    struct msg *msg = NULL;
+    rc = dynType_alloc(type, (void **)&msg);
+    CHECK_EQUAL(0, rc);
+    rc = dynType_alloc(itemType, (void **)&msg->single);
+    CHECK_EQUAL(0, rc);
+    rc = dynType_sequence_alloc(itemsType, &msg->items, 4);
+    CHECK_EQUAL(0, rc);
+    msg->id = 42;
+    msg->items.len = 1;
+    msg->items.buf[0].text = strdup("item");
+    msg->single->text = strdup("single");
+    struct msg *released = msg;
+    struct item *releasedBuf = msg->items.buf;
+    struct item *releasedSingle = msg->single;
+    dynType_free(type, msg);
+
+    //the released instances and buffer are reused and reset
+    rc = dynType_alloc(type, (void **)&msg);
+    CHECK_EQUAL(0, rc);
+    POINTERS_EQUAL(released, msg);
+    CHECK_EQUAL(0, msg->id);
+    CHECK(msg->single == NULL);
+    CHECK(msg->items.buf == NULL);
+    rc = dynType_alloc(itemType, (void **)&msg->single);
+    CHECK_EQUAL(0, rc);
+    POINTERS_EQUAL(releasedSingle, msg->single);
+    CHECK(msg->single->text == NULL);
+    rc = dynType_sequence_alloc(itemsType, &msg->items, 2);
+    CHECK_EQUAL(0, rc);
+    POINTERS_EQUAL(releasedBuf, msg->items.buf);
+    CHECK_EQUAL(4, msg->items.cap); //note the capacity of the pooled buffer
+    CHECK(msg->items.buf[0].text == NULL);
+    dynType_free(type, msg);
+
+    //buffers larger than the max sequence cap are not pooled
+    rc = dynType_alloc(type, (void **)&msg);
+    CHECK_EQUAL(0, rc);
+    rc = dynType_sequence_alloc(itemsType, &msg->items, 16);
+    CHECK_EQUAL(0, rc);
+    CHECK(msg->items.buf != releasedBuf);
+    CHECK_EQUAL(16, msg->items.cap);
+    dynType_free(type, msg);
+
+    dynType_destroy(type); //note frees the pooled memory
+}
+
+TEST(DynTypeTests, IsPodTest) {
+    const char *podDescriptors[] = {"I", "{DD a b}", "Tval={DD a b};{Jlval; a val}", "{I#v1=0;#v2=1;E a b}"};
+    const char *nonPodDescriptors[] = {"t", "P", "*D", "[D", "{It a b}", "Tval={Dt a b};{Jlval; a val}"};
+
+    for (size_t i = 0; i < sizeof(podDescriptors) / sizeof(podDescriptors[0]); ++i) {
+        const char *descriptor = podDescriptors[i];
+        dyn_type *type = NULL;
+        int rc = dynType_parseWithStr(descriptor, NULL, NULL, &type);
+        CHECK_EQUAL(0, rc);
+        CHECK_TEXT(dynType_isPod(type), descriptor);
+        dynType_destroy(type);
+    }
+    for (size_t i = 0; i < sizeof(nonPodDescriptors) / sizeof(nonPodDescriptors[0]); ++i) {
+        const char *descriptor = nonPodDescriptors[i];
+        dyn_type *type = NULL;
+        int rc = dynType_parseWithStr(descriptor, NULL, NULL, &type);
+        CHECK_EQUAL(0, rc);
+        CHECK_FALSE_TEXT(dynType_isPod(type), descriptor);
+        dynType_destroy(type);
+    }
+}
+
 TEST(DynTypeTests, EnumTest) {
     dyn_type *type = NULL;
     int rc = 0;
@@ -320,4 +473,97 @@ TEST(DynTypeTests, NrOfEntriesTest) {
     CHECK_EQUAL(0, rc);
     CHECK_EQUAL(4, dynType_complex_nrOfEntries(type));
     dynType_destroy(type);
-}
\ No newline at end of file
+}
+TEST(DynTypeTests, PlanTest) {
+    struct example {
+        double a;
+        struct {
+            int32_t c1;
+            int64_t c2;
+        } b;
+        char *c;
+        struct {
+            uint32_t cap;
+            uint32_t len;
+            int32_t *buf;
+        } d;
+    };
+
+    dyn_type *type = NULL;
+    int rc = dynType_parseWithStr("{D{IJ c1 c2}t[I a b c d}", "example", NULL, &type);
+    CHECK_EQUAL(0, rc);
+
+    const dyn_type_plan *plan = dynType_plan(type);
+    CHECK(plan != NULL);
+    POINTERS_EQUAL(plan, dynType_plan(type)); //compiled once
+
+    //{ a { c1 c2 } c d }
+    CHECK_EQUAL(9, dynTypePlan_nrOfSteps(plan));
+    const dyn_type_plan_step_t *steps = dynTypePlan_steps(plan);
+    CHECK_EQUAL(DYN_TYPE_PLAN_BEGIN_COMPLEX, steps[0].kind);
+    CHECK_EQUAL(8, steps[0].end);
+    CHECK_EQUAL(DYN_TYPE_PLAN_VALUE, steps[1].kind);
+    STRCMP_EQUAL("a", steps[1].name);
+    CHECK_EQUAL('D', steps[1].descriptor);
+    CHECK_EQUAL(offsetof(struct example, a), steps[1].offset);
+    CHECK_EQUAL(DYN_TYPE_PLAN_BEGIN_COMPLEX, steps[2].kind);
+    STRCMP_EQUAL("b", steps[2].name);
+    CHECK_EQUAL(5, steps[2].end);
+    STRCMP_EQUAL("c1", steps[3].name);
+    CHECK_EQUAL(offsetof(struct example, b.c1), steps[3].offset);
+    STRCMP_EQUAL("c2", steps[4].name);
+    CHECK_EQUAL('J', steps[4].descriptor);
+    CHECK_EQUAL(offsetof(struct example, b.c2), steps[4].offset);
+    CHECK_EQUAL(DYN_TYPE_PLAN_END_COMPLEX, steps[5].kind);
+    CHECK_EQUAL('t', steps[6].descriptor);
+    CHECK_EQUAL(offsetof(struct example, c), steps[6].offset);
+    STRCMP_EQUAL("d", steps[7].name);
+    CHECK_EQUAL('[', steps[7].descriptor);
+    CHECK_EQUAL(offsetof(struct example, d), steps[7].offset);
+    CHECK_EQUAL('I', dynType_descriptorType(steps[7].subType));
+    CHECK_EQUAL(sizeof(int32_t), steps[7].subTypeSize);
+    CHECK_EQUAL(DYN_TYPE_PLAN_END_COMPLEX, steps[8].kind);
+
+    dynType_destroy(type);
+}
+
+TEST(DynTypeTests, ToPropertiesTest) {
+    struct example {
+        double a;
+        struct {
+            int32_t c1;
+            bool c2;
+        } b;
+        char *c;
+        struct {
+            uint32_t cap;
+            uint32_t len;
+            int32_t *buf;
+        } d;
+    };
+
+    dyn_type *type = NULL;
+    int rc = dynType_parseWithStr("{D{IZ c1 c2}t[I a b c d}", "example", NULL, &type);
+    CHECK_EQUAL(0, rc);
+
+    char text[] = "sensor";
+    struct example inst;
+    memset(&inst, 0, sizeof(inst));
+    inst.a = 1.5;
+    inst.b.c1 = 42;
+    inst.b.c2 = true;
+    inst.c = text;
+
+    celix_properties_t *props = celix_properties_create();
+    rc = dynType_toProperties(type, &inst, props);
+    CHECK_EQUAL(0, rc);
+    CHECK_EQUAL(4, celix_properties_size(props));
+    DOUBLES_EQUAL(1.5, celix_properties_getAsDouble(props, "a", 0.0), 0.001);
+    CHECK_EQUAL(42, celix_properties_getAsLong(props, "b.c1", 0));
+    CHECK_TRUE(celix_properties_getAsBool(props, "b.c2", false));
+    STRCMP_EQUAL("sensor", celix_properties_get(props, "c", NULL));
+    CHECK(celix_properties_get(props, "d", NULL) == NULL);
+
+    celix_properties_destroy(props);
+    dynType_destroy(type);
+}
@@ -193,7 +193,58 @@ static void stdLog(void*, int level, const char *file, int line, const char *msg
         rc = jsonRpc_call(intf, &serv, R"({"m":"add(DD)D", "a": [1.0,2.0]})", &result);
         CHECK_EQUAL(0, rc);
         STRCMP_CONTAINS("3.0", result);
+        free(result);
+
+        //second call reuses the argument buffer of the thread
+        rc = jsonRpc_call(intf, &serv, R"({"m":"add(DD)D", "a": [3.0,4.0]})", &result);
+        CHECK_EQUAL(0, rc);
+        STRCMP_CONTAINS("7.0", result);
+        free(result);
+
+        //missing argument
+        result = nullptr;
+        rc = jsonRpc_call(intf, &serv, R"({"m":"add(DD)D", "a": [3.0]})", &result);
+        CHECK(rc != 0);
+        CHECK(result == nullptr);
+
+        dynInterface_destroy(intf);
+    }
+
+    void callTestBatch(void) {
+        dyn_interface_type *intf = nullptr;
+        FILE *desc = fopen("descriptors/example1.descriptor", "r");
+        CHECK(desc != nullptr);
+        int rc = dynInterface_parse(desc, &intf);
+        CHECK_EQUAL(0, rc);
+        fclose(desc);
+
+        char *requests[3] = {
+                (char *)R"({"m":"add(DD)D", "a": [1.0,2.0]})",
+                (char *)R"({"m":"add(DD)D", "a": [3.0]})", //fails, without failing the batch
+                (char *)R"({"m":"add(DD)D", "a": [3.0,4.0]})"};
+        char *request = nullptr;
+        rc = jsonRpc_prepareBatchRequest(requests, 3, &request);
+        CHECK_EQUAL(0, rc);
 
+        char *result = nullptr;
+        tst_serv serv {nullptr, add, nullptr, nullptr, nullptr};
+        rc = jsonRpc_call(intf, &serv, request, &result);
+        CHECK_EQUAL(0, rc);
+
+        char *replies[3];
+        rc = jsonRpc_splitBatchReply(result, 3, replies);
+        CHECK_EQUAL(0, rc);
+        STRCMP_CONTAINS("3.0", replies[0]);
+        CHECK(replies[1] == nullptr);
+        STRCMP_CONTAINS("7.0", replies[2]);
+        free(replies[0]);
+        free(replies[2]);
+
+        //the reply count must match
+        rc = jsonRpc_splitBatchReply(result, 2, replies);
+        CHECK(rc != 0);
+
+        free(request);
         free(result);
         dynInterface_destroy(intf);
     }
@@ -401,6 +452,10 @@ TEST(JsonRpcTests, callPre) {
     callTestPreAllocated();
 }
 
+TEST(JsonRpcTests, callBatch) {
+    callTestBatch();
+}
+
 TEST(JsonRpcTests, callOut) {
     callTestOutput();
 }
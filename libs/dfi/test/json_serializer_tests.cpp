@@ -26,6 +26,7 @@ extern "C" {
 #include <stdlib.h>
 #include <string.h>
 #include <ctype.h>
+#include <math.h>
 
 #include <ffi.h>
 
@@ -1398,6 +1399,114 @@ void writeAvprTest3(void) {
 	free(result);
 }
 
+/*********** streaming tests ************************/
+const char *stream_example_descriptor = "{tJ*D name id next}";
+
+struct stream_example {
+	char *name;
+	int64_t id;
+	double *next;
+};
+
+void streamingTests(void) {
+	dyn_type *type = nullptr;
+	int rc = dynType_parseWithStr(stream_example_descriptor, "stream", nullptr, &type);
+	CHECK_EQUAL(0, rc);
+
+	//escapes on write, NULL pointer written as null
+	stream_example ex {(char*)"q\"b\\\n/\xc3\xa9\x01", -5, nullptr};
+	char *result = nullptr;
+	rc = jsonSerializer_serialize(type, &ex, &result);
+	CHECK_EQUAL(0, rc);
+	STRCMP_EQUAL("{\"name\":\"q\\\"b\\\\\\n/\xc3\xa9\\u0001\",\"id\":-5,\"next\":null}", result);
+
+	//roundtrip
+	stream_example *inst = nullptr;
+	rc = jsonSerializer_deserialize(type, result, (void **)&inst);
+	CHECK_EQUAL(0, rc);
+	STRCMP_EQUAL(ex.name, inst->name);
+	CHECK_EQUAL(-5, inst->id);
+	CHECK(inst->next == nullptr);
+	dynType_free(type, inst);
+	free(result);
+
+	//whitespace, unicode escapes (incl. surrogate pair) and an integer for a real type
+	rc = jsonSerializer_deserialize(type, " { \"name\" : \"\\u00e9\\ud83d\\ude00\" ,\n\t\"id\":7, \"next\" : 3 } ", (void **)&inst);
+	CHECK_EQUAL(0, rc);
+	STRCMP_EQUAL("\xc3\xa9\xf0\x9f\x98\x80", inst->name);
+	CHECK_EQUAL(7, inst->id);
+	CHECK(inst->next != nullptr);
+	CHECK_EQUAL(3.0, *inst->next);
+	dynType_free(type, inst);
+
+	//invalid input
+	const char *invalid[] = {
+		R"({"name":"x","id":1} x)",
+		R"({"name":"x",})",
+		R"({"name":"x)",
+		R"({"name":"x" "id":1})",
+		R"({"id":1.5e})",
+		R"({"id":0x10})",
+		R"({"name":"\u0000"})",
+		R"({"name":"\ud83d"})",
+		R"({"unknown":1})",
+		"",
+	};
+	for (const char *input : invalid) {
+		inst = nullptr;
+		rc = jsonSerializer_deserialize(type, input, (void **)&inst);
+		CHECK_TRUE_TEXT(rc != 0, input);
+		CHECK(inst == nullptr);
+	}
+
+	dynType_destroy(type);
+}
+
+
+/*********** number sequence tests ************************/
+const char *number_sequences_descriptor = "{[D[I[J[b doubles ints longs bytes}";
+
+struct number_sequences {
+	struct { uint32_t cap; uint32_t len; double *buf; } doubles;
+	struct { uint32_t cap; uint32_t len; int32_t *buf; } ints;
+	struct { uint32_t cap; uint32_t len; int64_t *buf; } longs;
+	struct { uint32_t cap; uint32_t len; uint8_t *buf; } bytes;
+};
+
+void numberSequenceTests(void) {
+	dyn_type *type = nullptr;
+	int rc = dynType_parseWithStr(number_sequences_descriptor, "numbers", nullptr, &type);
+	CHECK_EQUAL(0, rc);
+
+	double doubles[] = {1.0, -0.0, 0.5, 1e300, -3.0, 9007199254740992.0, 1e16, 0.1, NAN};
+	int32_t ints[] = {INT32_MIN, -1, 0, 7, INT32_MAX};
+	int64_t longs[] = {INT64_MIN, INT64_MAX};
+	uint8_t bytes[] = {0, 255};
+	number_sequences val {{9, 9, doubles}, {5, 5, ints}, {2, 2, longs}, {2, 2, bytes}};
+
+	char *result = nullptr;
+	rc = jsonSerializer_serialize(type, &val, &result);
+	CHECK_EQUAL(0, rc);
+	//note non finite reals cannot be represented in json and are omitted
+	STRCMP_EQUAL("{\"doubles\":[1.0,-0.0,0.5,1.0000000000000001e+300,-3.0,9007199254740992.0,10000000000000000.0,0.10000000000000001],"
+				 "\"ints\":[-2147483648,-1,0,7,2147483647],"
+				 "\"longs\":[-9223372036854775808,9223372036854775807],"
+				 "\"bytes\":[0,255]}", result);
+
+	number_sequences *inst = nullptr;
+	rc = jsonSerializer_deserialize(type, result, (void **)&inst);
+	CHECK_EQUAL(0, rc);
+	CHECK_EQUAL(8, inst->doubles.len);
+	DOUBLES_EQUAL(1e300, inst->doubles.buf[3], 1e285);
+	CHECK_EQUAL(INT32_MIN, inst->ints.buf[0]);
+	CHECK(INT64_MIN == inst->longs.buf[0]);
+	CHECK_EQUAL(255, inst->bytes.buf[1]);
+	dynType_free(type, inst);
+	free(result);
+
+	dynType_destroy(type);
+}
+
 } // extern "C"
 
 TEST_GROUP(JsonSerializerTests) {
@@ -1434,3 +1543,10 @@ TEST(JsonSerializerTests, WriteTest3) {
     writeAvprTest3();
 }
 
+TEST(JsonSerializerTests, StreamingTests) {
+	streamingTests();
+}
+
+TEST(JsonSerializerTests, NumberSequenceTests) {
+	numberSequenceTests();
+}
@@ -26,6 +26,7 @@ extern "C"
 #endif
 
 #include <stdbool.h>
+#include <stddef.h>
 
 /*
  * If set etcdlib will _not_ initialize curl
@@ -45,6 +46,7 @@ extern "C"
 #define ETCDLIB_RC_OK           0
 #define ETCDLIB_RC_ERROR        1
 #define ETCDLIB_RC_TIMEOUT      2
+#define ETCDLIB_RC_INTERRUPTED  3
 
 typedef struct etcdlib_struct etcdlib_t; //opaque struct
 
@@ -116,6 +118,19 @@ int etcdlib_set(const etcdlib_t *etcdlib, const char* key, const char* value, in
  */
 int etcdlib_refresh(const etcdlib_t *etcdlib, const char *key, int ttl);
 
+/**
+ * @desc Creates an Etcd-directory with a ttl or refreshes the ttl of an existing Etcd-directory.
+ * Keys in the directory can be set without a ttl, they expire together with the directory. So a single refresh of
+ * the directory keeps all its keys alive, comparable to an etcd v3 lease.
+ * @param const etcdlib_t* etcdlib. The ETCD-LIB instance (contains hostname and port info).
+ * @param const char* key. The Etcd-key of the directory (Note: a leading '/' should be avoided)
+ * @param int ttl. The ttl of the directory.
+ * @param bool refresh. If true only the ttl of the existing directory is refreshed (this does not trigger watches),
+ * if false the directory is created.
+ * @return 0 on success, non zero otherwise.
+ */
+int etcdlib_set_dir(const etcdlib_t *etcdlib, const char* key, int ttl, bool refresh);
+
 /**
  * @desc Setting an Etcd-key/value and checks if there is a different previous value
  * @param const etcdlib_t* etcdlib. The ETCD-LIB instance (contains hostname and port info).
@@ -127,6 +142,31 @@ int etcdlib_refresh(const etcdlib_t *etcdlib, const char *key, int ttl);
  */
 int etcdlib_set_with_check(const etcdlib_t *etcdlib, const char* key, const char* value, int ttl, bool always_write);
 
+/**
+ * @desc Setting many Etcd-key/values, e.g. to (re)announce all entries after a lease directory expired. The requests
+ * reuse the keep-alive connections of the ETCD-LIB instance, so no connection is opened per key.
+ * @param const etcdlib_t* etcdlib. The ETCD-LIB instance (contains hostname and port info).
+ * @param size_t count. The number of keys and values.
+ * @param const char* const keys[]. The Etcd-keys.
+ * @param const char* const values[]. The Etcd-values, values[i] is set for keys[i].
+ * @param int ttl. If non-zero this is used as the TTL value for all keys.
+ * @param int results[]. If not NULL, results[i] is set to the return code of setting keys[i] (see etcdlib_set).
+ * @return 0 if all keys are set, non zero otherwise
+ */
+int etcdlib_setMany(const etcdlib_t *etcdlib, size_t count, const char* const keys[], const char* const values[], int ttl, int results[]);
+
+/**
+ * @desc Refresh the ttl of many existing keys. The requests reuse the keep-alive connections of the ETCD-LIB instance,
+ * so no connection is opened per key.
+ * @param const etcdlib_t* etcdlib. The ETCD-LIB instance (contains hostname and port info).
+ * @param size_t count. The number of keys.
+ * @param const char* const keys[]. The etcd keys to refresh.
+ * @param int ttl. The ttl value to use.
+ * @param int results[]. If not NULL, results[i] is set to the return code of refreshing keys[i] (see etcdlib_refresh).
+ * @return 0 if all keys are refreshed, non zero otherwise
+ */
+int etcdlib_refreshMany(const etcdlib_t *etcdlib, size_t count, const char* const keys[], int ttl, int results[]);
+
 /**
  * @desc Deleting an Etcd-key
  * @param const etcdlib_t* etcdlib. The ETCD-LIB instance (contains hostname and port info).
@@ -145,10 +185,131 @@ int etcdlib_del(const etcdlib_t *etcdlib, const char* key);
  * @param char** value. If not NULL, memory is allocated and contains the new value. The caller is responsible of freeing the memory.
  * @param char** rkey. If not NULL, memory is allocated and contains the updated key. The caller is responsible of freeing the memory.
  * @param long long* modifiedIndex. If not NULL, the index of the modification is written.
- * @return ETCDLIB_RC_OK (0) on success, non zero otherwise. Note that a timeout is signified by a ETCDLIB_RC_TIMEOUT return code.
+ * @return ETCDLIB_RC_OK (0) on success, non zero otherwise. Note that a timeout is signified by a ETCDLIB_RC_TIMEOUT return code
+ * and an interrupted watch by a ETCDLIB_RC_INTERRUPTED return code.
  */
 int etcdlib_watch(const etcdlib_t *etcdlib, const char* key, long long index, char** action, char** prevValue, char** value, char** rkey, long long* modifiedIndex);
 
+/**
+ * @desc Interrupts the ongoing and future etcdlib_watch calls of the ETCD-LIB instance, so that a watch thread can be
+ * stopped without waiting for the watch timeout. Interrupted watches return ETCDLIB_RC_INTERRUPTED within a second.
+ * @param etcdlib_t* etcdlib. The ETCD-LIB instance.
+ */
+void etcdlib_interrupt(etcdlib_t *etcdlib);
+
+/*
+ * etcd v3 API
+ *
+ * The v3 functions use the JSON gateway of the etcd v3 gRPC API (etcd 3.4 or higher). Note that the etcd v2 and v3
+ * key spaces are separate, keys set with the v2 functions are not visible to the v3 functions and vice versa.
+ */
+
+typedef struct etcdlib_watch_stream etcdlib_watch_stream_t; //opaque struct
+
+/**
+ * Callback for etcd v3 watch events.
+ * @param action ETCDLIB_ACTION_SET for a put or ETCDLIB_ACTION_DELETE for a delete (or an expired lease).
+ * @param key The key of the event.
+ * @param value The new value or NULL for a delete.
+ * @param revision The etcd revision of the event.
+ * @param arg The argument given when the watch was added.
+ */
+typedef void (*etcdlib_watch_callback) (const char *action, const char *key, const char *value, long long revision, void *arg);
+
+/**
+ * @desc Retrieves all keys with the given prefix in a single range request. For every found key/value pair the given
+ * callback function is called.
+ * @param const etcdlib_t* etcdlib. The ETCD-LIB instance.
+ * @param const char* prefix. The key prefix.
+ * @param etcdlib_key_value_callback callback. Callback function which is called for every found key.
+ * @param void *arg. Argument is passed to the callback function.
+ * @param long long* revision. If not NULL the etcd revision of the range, i.e. a watch started at revision + 1 misses
+ * no changes.
+ * @return ETCDLIB_RC_OK (0) on success, non zero otherwise.
+ */
+int etcdlib_v3_get_range(const etcdlib_t *etcdlib, const char *prefix, etcdlib_key_value_callback callback, void *arg, long long *revision);
+
+/**
+ * @desc Sets an etcd key/value.
+ * @param const etcdlib_t* etcdlib. The ETCD-LIB instance.
+ * @param const char* key. The key.
+ * @param const char* value. The value.
+ * @param long long leaseId. If non-zero the key is attached to the lease and deleted when the lease expires or is revoked.
+ * @return ETCDLIB_RC_OK (0) on success, non zero otherwise.
+ */
+int etcdlib_v3_put(const etcdlib_t *etcdlib, const char *key, const char *value, long long leaseId);
+
+/**
+ * @desc Deletes an etcd key or all keys with the given prefix.
+ * @param const etcdlib_t* etcdlib. The ETCD-LIB instance.
+ * @param const char* key. The key or key prefix.
+ * @param bool prefix. If true all keys with the given prefix are deleted.
+ * @return ETCDLIB_RC_OK (0) on success, non zero otherwise.
+ */
+int etcdlib_v3_del(const etcdlib_t *etcdlib, const char *key, bool prefix);
+
+/**
+ * @desc Grants a lease. Keys attached to the lease are deleted when the lease is not kept alive within the ttl.
+ * @param const etcdlib_t* etcdlib. The ETCD-LIB instance.
+ * @param int ttl. The ttl of the lease in seconds.
+ * @param long long* leaseId. The id of the granted lease.
+ * @return ETCDLIB_RC_OK (0) on success, non zero otherwise.
+ */
+int etcdlib_v3_lease_grant(const etcdlib_t *etcdlib, int ttl, long long *leaseId);
+
+/**
+ * @desc Keeps a lease alive, i.e. resets the ttl of the lease. A single keep alive refreshes all keys attached
+ * to the lease.
+ * @param const etcdlib_t* etcdlib. The ETCD-LIB instance.
+ * @param long long leaseId. The id of the lease.
+ * @return ETCDLIB_RC_OK (0) on success, ETCDLIB_RC_TIMEOUT if the lease already expired (a new lease has to be
+ * granted) and ETCDLIB_RC_ERROR otherwise.
+ */
+int etcdlib_v3_lease_keepalive(const etcdlib_t *etcdlib, long long leaseId);
+
+/**
+ * @desc Revokes a lease, all keys attached to the lease are deleted.
+ * @param const etcdlib_t* etcdlib. The ETCD-LIB instance.
+ * @param long long leaseId. The id of the lease.
+ * @return ETCDLIB_RC_OK (0) on success, non zero otherwise.
+ */
+int etcdlib_v3_lease_revoke(const etcdlib_t *etcdlib, long long leaseId);
+
+/**
+ * @desc Creates a watch stream. All watches added to a stream share a single etcd watch request.
+ * @param etcdlib_t* etcdlib. The ETCD-LIB instance. Note that etcdlib_interrupt also interrupts the watch stream.
+ * @return The watch stream or NULL if no memory is available.
+ */
+etcdlib_watch_stream_t* etcdlib_v3_watch_stream_create(etcdlib_t *etcdlib);
+
+/**
+ * @desc Destroys a watch stream.
+ */
+void etcdlib_v3_watch_stream_destroy(etcdlib_watch_stream_t *stream);
+
+/**
+ * @desc Adds a watch for all keys with the given prefix to the watch stream. Should not be called while
+ * etcdlib_v3_watch_stream_run is running.
+ * @param etcdlib_watch_stream_t* stream. The watch stream.
+ * @param const char* prefix. The key prefix to watch.
+ * @param long long startRevision. The first revision to report events for, e.g. the revision of a range request + 1.
+ * @param etcdlib_watch_callback callback. Callback function which is called for every event.
+ * @param void *arg. Argument is passed to the callback function.
+ * @return ETCDLIB_RC_OK (0) on success, non zero otherwise.
+ */
+int etcdlib_v3_watch_stream_add(etcdlib_watch_stream_t *stream, const char *prefix, long long startRevision, etcdlib_watch_callback callback, void *arg);
+
+/**
+ * @desc Watches all keys of the watch stream and calls the watch callbacks for every event, until the timeout expires.
+ * The stream keeps track of the revision of every watch, so calling etcdlib_v3_watch_stream_run again continues
+ * without missing events.
+ * @param etcdlib_watch_stream_t* stream. The watch stream.
+ * @param int timeoutInSeconds. The time to watch, e.g. the interval for lease keep alives.
+ * @return ETCDLIB_RC_TIMEOUT when the timeout expired, ETCDLIB_RC_INTERRUPTED when interrupted with
+ * etcdlib_interrupt and ETCDLIB_RC_ERROR otherwise.
+ */
+int etcdlib_v3_watch_stream_run(etcdlib_watch_stream_t *stream, int timeoutInSeconds);
+
 #ifdef __cplusplus
 }
 #endif
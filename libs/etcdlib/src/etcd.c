@@ -18,12 +18,14 @@
  */
 
 #include <stdio.h>
+#include <stdlib.h>
 #include <stdbool.h>
 #include <string.h>
 #include <curl/curl.h>
 #include <jansson.h>
 
 #include "etcd.h"
+#include "etcd_private.h"
 
 #define ETCD_JSON_NODE                  "node"
 #define ETCD_JSON_PREVNODE              "prevNode"
@@ -42,18 +44,13 @@
 #define DEFAULT_CURL_TIMEOUT          10
 #define DEFAULT_CURL_CONNECT_TIMEOUT  10
 
-struct etcdlib_struct {
-	char *host;
-	int port;
-};
-
 typedef enum {
 	GET, PUT, DELETE
 } request_t;
 
 #define MAX_GLOBAL_HOSTNAME 128
 static char g_etcdlib_host[MAX_GLOBAL_HOSTNAME];
-static etcdlib_t g_etcdlib;
+static etcdlib_t g_etcdlib = {.poolLock = PTHREAD_MUTEX_INITIALIZER};
 
 struct MemoryStruct {
 	char *memory;
@@ -66,7 +63,7 @@ struct MemoryStruct {
 /**
  * Static function declarations
  */
-static int performRequest(char* url, request_t request, void* reqData, void* repData);
+static int performRequest(const etcdlib_t *etcdlib, char* url, request_t request, void* reqData, void* repData, const int *interrupted);
 static size_t WriteMemoryCallback(void *contents, size_t size, size_t nmemb, void *userp);
 /**
  * External function definition
@@ -105,12 +102,19 @@ etcdlib_t* etcdlib_create(const char* server, int port, int flags) {
 	etcdlib_t *lib = malloc(sizeof(*lib));
 	lib->host = strndup(server, 1024 * 1024 * 10);
 	lib->port = port;
+	lib->interrupted = 0;
+	pthread_mutex_init(&lib->poolLock, NULL);
+	lib->poolCount = 0;
 
 	return lib;
 }
 
 void etcdlib_destroy(etcdlib_t *etcdlib) {
     if (etcdlib != NULL) {
+        for (int i = 0; i < etcdlib->poolCount; ++i) {
+            curl_easy_cleanup(etcdlib->pool[i]);
+        }
+        pthread_mutex_destroy(&etcdlib->poolLock);
         free(etcdlib->host);
     }
     free(etcdlib);
@@ -145,7 +149,7 @@ int etcdlib_get(const etcdlib_t *etcdlib, const char* key, char** value, int* mo
 	int retVal = ETCDLIB_RC_ERROR;
 	char *url;
 	asprintf(&url, "http://%s:%d/v2/keys/%s", etcdlib->host, etcdlib->port, key);
-	res = performRequest(url, GET, NULL, (void *) &reply);
+	res = performRequest(etcdlib, url, GET, NULL, (void *) &reply, NULL);
 	free(url);
 
 	if (res == CURLE_OK) {
@@ -268,7 +272,7 @@ int etcdlib_get_directory(const etcdlib_t *etcdlib, const char* directory, etcdl
 
 	asprintf(&url, "http://%s:%d/v2/keys/%s?recursive=true", etcdlib->host, etcdlib->port, directory);
 
-	res = performRequest(url, GET, NULL, (void*) &reply);
+	res = performRequest(etcdlib, url, GET, NULL, (void*) &reply, NULL);
 	free(url);
 	if (res == CURLE_OK) {
 		js_root = json_loads(reply.memory, 0, &error);
@@ -359,7 +363,7 @@ int etcdlib_set(const etcdlib_t *etcdlib, const char* key, const char* value, in
 		requestPtr += snprintf(requestPtr, req_len-(requestPtr-request), ";prevExist=true");
 	}
 
-	res = performRequest(url, PUT, request, (void*) &reply);
+	res = performRequest(etcdlib, url, PUT, request, (void*) &reply, NULL);
 	if(url) {
 		free(url);
 	}
@@ -417,7 +421,7 @@ int etcdlib_refresh(const etcdlib_t *etcdlib, const char *key, int ttl) {
 	asprintf(&url, "http://%s:%d/v2/keys/%s", etcdlib->host, etcdlib->port, key);
 	snprintf(request, req_len, "ttl=%d;prevExists=true;refresh=true", ttl);
 
-	res = performRequest(url, PUT, request, (void*) &reply);
+	res = performRequest(etcdlib, url, PUT, request, (void*) &reply, NULL);
 	if(url) {
 		free(url);
 	}
@@ -447,6 +451,53 @@ int etcdlib_refresh(const etcdlib_t *etcdlib, const char *key, int ttl) {
 	return retVal;
 }
 
+int etcdlib_set_dir(const etcdlib_t *etcdlib, const char* key, int ttl, bool refresh) {
+	int retVal = ETCDLIB_RC_ERROR;
+	char *url;
+	size_t req_len = MAX_OVERHEAD_LENGTH;
+	char request[req_len];
+
+	int res;
+	struct MemoryStruct reply;
+
+	/* Skip leading '/', etcd cannot handle this. */
+	while(*key == '/') {
+		key++;
+	}
+
+	reply.memory = calloc(1, 1); /* will be grown as needed by the realloc above */
+	reply.memorySize = 0; /* no data at this point */
+	reply.header = NULL; /* will be grown as needed by the realloc above */
+	reply.headerSize = 0; /* no data at this point */
+
+	asprintf(&url, "http://%s:%d/v2/keys/%s", etcdlib->host, etcdlib->port, key);
+	if (refresh) {
+		snprintf(request, req_len, "dir=true;ttl=%d;prevExist=true;refresh=true", ttl);
+	} else {
+		snprintf(request, req_len, "dir=true;ttl=%d;prevExist=false", ttl);
+	}
+
+	res = performRequest(etcdlib, url, PUT, request, (void*) &reply, NULL);
+	free(url);
+
+	if (res == CURLE_OK && reply.memory != NULL) {
+		json_error_t error;
+		json_t *root = json_loads(reply.memory, 0, &error);
+		if (root != NULL) {
+			json_t *errorCode = json_object_get(root, ETCD_JSON_ERRORCODE);
+			//no curl error and no etcd errorcode reply -> OK
+			retVal = errorCode == NULL ? ETCDLIB_RC_OK : ETCDLIB_RC_ERROR;
+			json_decref(root);
+		} else {
+			fprintf(stderr, "[ETCDLIB] Error: %s is not json", reply.memory);
+		}
+	}
+
+	free(reply.memory);
+
+	return retVal;
+}
+
 int etcd_set_with_check(const char* key, const char* value, int ttl, bool always_write) {
 	return etcdlib_set_with_check(&g_etcdlib, key, value, ttl, always_write);
 }
@@ -474,6 +525,35 @@ int etcdlib_set_with_check(const etcdlib_t *etcdlib, const char* key, const char
 
 
 
+int etcdlib_setMany(const etcdlib_t *etcdlib, size_t count, const char* const keys[], const char* const values[], int ttl, int results[]) {
+	int retVal = ETCDLIB_RC_OK;
+	//the requests are performed one after another, so they all reuse the same pooled keep-alive connection
+	for (size_t i = 0; i < count; ++i) {
+		int rc = etcdlib_set(etcdlib, keys[i], values[i], ttl, false);
+		if (results != NULL) {
+			results[i] = rc;
+		}
+		if (rc != ETCDLIB_RC_OK) {
+			retVal = ETCDLIB_RC_ERROR;
+		}
+	}
+	return retVal;
+}
+
+int etcdlib_refreshMany(const etcdlib_t *etcdlib, size_t count, const char* const keys[], int ttl, int results[]) {
+	int retVal = ETCDLIB_RC_OK;
+	for (size_t i = 0; i < count; ++i) {
+		int rc = etcdlib_refresh(etcdlib, keys[i], ttl);
+		if (results != NULL) {
+			results[i] = rc;
+		}
+		if (rc != ETCDLIB_RC_OK) {
+			retVal = ETCDLIB_RC_ERROR;
+		}
+	}
+	return retVal;
+}
+
 int etcd_watch(const char* key, long long index, char** action, char** prevValue, char** value, char** rkey, long long* modifiedIndex) {
 	return etcdlib_watch(&g_etcdlib, key, index, action, prevValue, value, rkey, modifiedIndex);
 }
@@ -503,7 +583,7 @@ int etcdlib_watch(const etcdlib_t *etcdlib, const char* key, long long index, ch
 		asprintf(&url, "http://%s:%d/v2/keys/%s?wait=true&recursive=true&waitIndex=%lld", etcdlib->host, etcdlib->port, key, index);
 	else
 		asprintf(&url, "http://%s:%d/v2/keys/%s?wait=true&recursive=true", etcdlib->host, etcdlib->port, key);
-	res = performRequest(url, GET, NULL, (void*) &reply);
+	res = performRequest(etcdlib, url, GET, NULL, (void*) &reply, &etcdlib->interrupted);
 	if(url)
 		free(url);
 	if (res == CURLE_OK) {
@@ -554,6 +634,8 @@ int etcdlib_watch(const etcdlib_t *etcdlib, const char* key, long long index, ch
 	} else if (res == CURLE_OPERATION_TIMEDOUT) {
 		//ignore timeout
 		retVal = ETCDLIB_RC_TIMEOUT;
+	} else if (res == CURLE_ABORTED_BY_CALLBACK) {
+		retVal = ETCDLIB_RC_INTERRUPTED;
 	} else {
 		fprintf(stderr, "Got curl error: %s\n", curl_easy_strerror(res));
 		retVal = ETCDLIB_RC_ERROR;
@@ -585,7 +667,7 @@ int etcdlib_del(const etcdlib_t *etcdlib, const char* key) {
     reply.headerSize = 0; /* no data at this point */
 
 	asprintf(&url, "http://%s:%d/v2/keys/%s?recursive=true", etcdlib->host, etcdlib->port, key);
-	res = performRequest(url, DELETE, NULL, (void*) &reply);
+	res = performRequest(etcdlib, url, DELETE, NULL, (void*) &reply, NULL);
 	free(url);
 
 	if (res == CURLE_OK) {
@@ -609,6 +691,16 @@ int etcdlib_del(const etcdlib_t *etcdlib, const char* key) {
 }
 
 
+void etcdlib_interrupt(etcdlib_t *etcdlib) {
+	__atomic_store_n(&etcdlib->interrupted, 1, __ATOMIC_RELEASE);
+}
+
+static int InterruptCallback(void *clientp, curl_off_t dltotal, curl_off_t dlnow, curl_off_t ultotal, curl_off_t ulnow) {
+	const int *interrupted = clientp;
+	//note a non zero return value aborts the request with CURLE_ABORTED_BY_CALLBACK
+	return __atomic_load_n(interrupted, __ATOMIC_ACQUIRE);
+}
+
 static size_t WriteMemoryCallback(void *contents, size_t size, size_t nmemb, void *userp) {
 	size_t realsize = size * nmemb;
 	struct MemoryStruct *mem = (struct MemoryStruct *) userp;
@@ -647,10 +739,13 @@ static size_t WriteHeaderCallback(void *contents, size_t size, size_t nmemb, voi
 
 
 
-static int performRequest(char* url, request_t request, void* reqData, void* repData) {
+static int performRequest(const etcdlib_t *etcdlib, char* url, request_t request, void* reqData, void* repData, const int *interrupted) {
 	CURL *curl = NULL;
 	CURLcode res = 0;
-	curl = curl_easy_init();
+	curl = etcdlib_takeHandle(etcdlib);
+	if (curl == NULL) {
+		return CURLE_FAILED_INIT;
+	}
 	curl_easy_setopt(curl, CURLOPT_NOSIGNAL, 1);
 	curl_easy_setopt(curl, CURLOPT_TIMEOUT, DEFAULT_CURL_TIMEOUT);
 	curl_easy_setopt(curl, CURLOPT_CONNECTTIMEOUT, DEFAULT_CURL_CONNECT_TIMEOUT);
@@ -662,6 +757,12 @@ static int performRequest(char* url, request_t request, void* reqData, void* rep
         curl_easy_setopt(curl, CURLOPT_HEADERDATA, repData);
         curl_easy_setopt(curl, CURLOPT_HEADERFUNCTION, WriteHeaderCallback);
     }
+	if (interrupted != NULL) {
+		//the progress callback is also called (about once a second) while waiting for data
+		curl_easy_setopt(curl, CURLOPT_NOPROGRESS, 0L);
+		curl_easy_setopt(curl, CURLOPT_XFERINFOFUNCTION, InterruptCallback);
+		curl_easy_setopt(curl, CURLOPT_XFERINFODATA, (void*)interrupted);
+	}
 
 	if (request == PUT) {
 		curl_easy_setopt(curl, CURLOPT_CUSTOMREQUEST, "PUT");
@@ -681,6 +782,42 @@ static int performRequest(char* url, request_t request, void* reqData, void* rep
 	    fprintf(stderr, "[etclib] Curl error for %s @ %s: %s\n", url, m, curl_easy_strerror(res));
 	}
 
-    curl_easy_cleanup(curl);
+    etcdlib_releaseHandle(etcdlib, curl, res == CURLE_OK);
     return res;
 }
+
+CURL* etcdlib_takeHandle(const etcdlib_t *etcdlib) {
+	etcdlib_t *lib = (etcdlib_t *) etcdlib; //only the pool is updated
+	CURL *curl = NULL;
+
+	pthread_mutex_lock(&lib->poolLock);
+	if (lib->poolCount > 0) {
+		curl = lib->pool[--lib->poolCount];
+	}
+	pthread_mutex_unlock(&lib->poolLock);
+
+	if (curl != NULL) {
+		//resets the options of the previous request, the connection (and dns cache) is kept
+		curl_easy_reset(curl);
+	} else {
+		curl = curl_easy_init();
+	}
+	return curl;
+}
+
+void etcdlib_releaseHandle(const etcdlib_t *etcdlib, CURL *curl, bool reusable) {
+	etcdlib_t *lib = (etcdlib_t *) etcdlib; //only the pool is updated
+
+	if (reusable) {
+		pthread_mutex_lock(&lib->poolLock);
+		if (lib->poolCount < ETCDLIB_CONNECTION_POOL_SIZE) {
+			lib->pool[lib->poolCount++] = curl;
+			curl = NULL;
+		}
+		pthread_mutex_unlock(&lib->poolLock);
+	}
+
+	if (curl != NULL) {
+		curl_easy_cleanup(curl);
+	}
+}
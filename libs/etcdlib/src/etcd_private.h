@@ -0,0 +1,51 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *  KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#ifndef ETCDLIB_PRIVATE_H_
+#define ETCDLIB_PRIVATE_H_
+
+#include <pthread.h>
+#include <curl/curl.h>
+
+//max number of idle curl handles (and therefore keep-alive connections) kept per etcdlib instance
+#define ETCDLIB_CONNECTION_POOL_SIZE 4
+
+struct etcdlib_struct {
+	char *host;
+	int port;
+	int interrupted; //set by etcdlib_interrupt, read by the progress callback of watch requests
+
+	pthread_mutex_t poolLock;
+	CURL *pool[ETCDLIB_CONNECTION_POOL_SIZE]; //idle curl handles, their connections to etcd are kept alive
+	int poolCount;
+};
+
+/**
+ * Returns an idle curl handle of the etcdlib instance (reset to the default options, but with its connection kept
+ * alive) or a new curl handle if no idle handle is available.
+ */
+CURL* etcdlib_takeHandle(const etcdlib_t *etcdlib);
+
+/**
+ * Returns the curl handle to the idle handles of the etcdlib instance. Handles of failed requests are not reusable,
+ * because the state of their connection is unknown, and are cleaned up.
+ */
+void etcdlib_releaseHandle(const etcdlib_t *etcdlib, CURL *curl, bool reusable);
+
+#endif /*ETCDLIB_PRIVATE_H_ */
@@ -0,0 +1,567 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *  KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+#include <curl/curl.h>
+#include <jansson.h>
+
+#include "etcdlib.h"
+#include "etcd_private.h"
+
+#define ETCD_V3_PATH                    "v3"
+
+#define ETCD_V3_JSON_KEY                "key"
+#define ETCD_V3_JSON_VALUE              "value"
+#define ETCD_V3_JSON_RANGE_END          "range_end"
+#define ETCD_V3_JSON_LEASE              "lease"
+#define ETCD_V3_JSON_KVS                "kvs"
+#define ETCD_V3_JSON_HEADER             "header"
+#define ETCD_V3_JSON_REVISION           "revision"
+#define ETCD_V3_JSON_MOD_REVISION       "mod_revision"
+#define ETCD_V3_JSON_ID                 "ID"
+#define ETCD_V3_JSON_TTL                "TTL"
+#define ETCD_V3_JSON_RESULT             "result"
+#define ETCD_V3_JSON_CREATE_REQUEST     "create_request"
+#define ETCD_V3_JSON_START_REVISION     "start_revision"
+#define ETCD_V3_JSON_WATCH_ID           "watch_id"
+#define ETCD_V3_JSON_CREATED            "created"
+#define ETCD_V3_JSON_CANCELED           "canceled"
+#define ETCD_V3_JSON_COMPACT_REVISION   "compact_revision"
+#define ETCD_V3_JSON_EVENTS             "events"
+#define ETCD_V3_JSON_TYPE               "type"
+#define ETCD_V3_JSON_KV                 "kv"
+
+#define ETCD_V3_EVENT_DELETE            "DELETE"
+
+#define DEFAULT_CURL_TIMEOUT          10
+#define DEFAULT_CURL_CONNECT_TIMEOUT  10
+
+struct etcdlib_v3_watch {
+	char *prefix;
+	long long revision; //next revision to report
+	long long watchId; //id assigned by etcd for the running watch request, -1 if not (yet) created
+	etcdlib_watch_callback callback;
+	void *arg;
+};
+
+struct etcdlib_watch_stream {
+	etcdlib_t *etcdlib;
+
+	struct etcdlib_v3_watch *watches;
+	size_t size;
+
+	//state of the running watch request
+	size_t nrCreated; //etcd creates the watches in order of the create requests
+	char *buffer; //received data not yet parsed, i.e. an incomplete message
+	size_t bufferSize;
+	bool failed;
+};
+
+struct etcdlib_v3_reply {
+	char *memory;
+	size_t size;
+};
+
+static const char base64Chars[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+/**
+ * etcd v3 JSON encodes keys and values as base64
+ */
+static char* etcdlib_v3_encode(const char *data, size_t length) {
+	char *result = malloc(((length + 2) / 3) * 4 + 1);
+	char *out = result;
+	if (result == NULL) {
+		return NULL;
+	}
+	for (size_t i = 0; i < length; i += 3) {
+		unsigned int n = ((unsigned char)data[i]) << 16;
+		if (i + 1 < length) {
+			n |= ((unsigned char)data[i + 1]) << 8;
+		}
+		if (i + 2 < length) {
+			n |= (unsigned char)data[i + 2];
+		}
+		*out++ = base64Chars[(n >> 18) & 0x3F];
+		*out++ = base64Chars[(n >> 12) & 0x3F];
+		*out++ = i + 1 < length ? base64Chars[(n >> 6) & 0x3F] : '=';
+		*out++ = i + 2 < length ? base64Chars[n & 0x3F] : '=';
+	}
+	*out = '\0';
+	return result;
+}
+
+static char* etcdlib_v3_decode(const char *str) {
+	size_t length = str == NULL ? 0 : strlen(str);
+	char *result = malloc(length / 4 * 3 + 1);
+	size_t size = 0;
+	unsigned int n = 0;
+	int bits = 0;
+	if (result == NULL) {
+		return NULL;
+	}
+	for (size_t i = 0; i < length && str[i] != '='; ++i) {
+		const char *c = strchr(base64Chars, str[i]);
+		if (c == NULL || *c == '\0') {
+			free(result);
+			return NULL;
+		}
+		n = (n << 6) | (unsigned int)(c - base64Chars);
+		bits += 6;
+		if (bits >= 8) {
+			bits -= 8;
+			result[size++] = (char)((n >> bits) & 0xFF);
+		}
+	}
+	result[size] = '\0';
+	return result;
+}
+
+/**
+ * Returns the base64 encoded range end for all keys with the given prefix, i.e. the prefix with the last byte
+ * incremented.
+ */
+static char* etcdlib_v3_encodePrefixEnd(const char *prefix) {
+	size_t length = strlen(prefix);
+	char end[length + 1];
+	memcpy(end, prefix, length + 1);
+	while (length > 0 && (unsigned char)end[length - 1] == 0xFF) {
+		length--;
+	}
+	if (length == 0) {
+		//no upper bound, range end "\0" means all keys >= key
+		return etcdlib_v3_encode("", 1);
+	}
+	end[length - 1] = (char)((unsigned char)end[length - 1] + 1);
+	return etcdlib_v3_encode(end, length);
+}
+
+static void etcdlib_v3_setString(json_t *object, const char *name, const char *value, size_t length) {
+	char *encoded = etcdlib_v3_encode(value, length);
+	json_object_set_new(object, name, json_string(encoded));
+	free(encoded);
+}
+
+static void etcdlib_v3_setPrefix(json_t *object, const char *prefix) {
+	char *end = etcdlib_v3_encodePrefixEnd(prefix);
+	etcdlib_v3_setString(object, ETCD_V3_JSON_KEY, prefix, strlen(prefix));
+	json_object_set_new(object, ETCD_V3_JSON_RANGE_END, json_string(end));
+	free(end);
+}
+
+/**
+ * The JSON gateway encodes int64 values as strings, zero values are omitted
+ */
+static long long etcdlib_v3_int(json_t *js) {
+	long long result = 0;
+	if (json_is_string(js)) {
+		result = strtoll(json_string_value(js), NULL, 10);
+	} else if (json_is_integer(js)) {
+		result = json_integer_value(js);
+	}
+	return result;
+}
+
+static size_t etcdlib_v3_writeReply(void *contents, size_t size, size_t nmemb, void *userp) {
+	size_t realsize = size * nmemb;
+	struct etcdlib_v3_reply *reply = userp;
+
+	char *memory = realloc(reply->memory, reply->size + realsize + 1);
+	if (memory == NULL) {
+		fprintf(stderr, "[ETCDLIB] Error: not enough memory (realloc returned NULL)\n");
+		return 0;
+	}
+	reply->memory = memory;
+	memcpy(&(reply->memory[reply->size]), contents, realsize);
+	reply->size += realsize;
+	reply->memory[reply->size] = 0;
+
+	return realsize;
+}
+
+/**
+ * Posts the JSON request to the given path of the etcd v3 JSON gateway. On success the reply is set to the parsed
+ * JSON reply, which has to be released by the caller.
+ */
+static int etcdlib_v3_post(const etcdlib_t *etcdlib, const char *path, json_t *request, json_t **reply) {
+	int retVal = ETCDLIB_RC_ERROR;
+	struct etcdlib_v3_reply data = {.memory = NULL, .size = 0};
+	char *url = NULL;
+	char *body = json_dumps(request, JSON_COMPACT);
+	long httpCode = 0;
+
+	*reply = NULL;
+	if (body == NULL || asprintf(&url, "http://%s:%d/%s/%s", etcdlib->host, etcdlib->port, ETCD_V3_PATH, path) < 0) {
+		free(body);
+		return ETCDLIB_RC_ERROR;
+	}
+
+	CURL *curl = etcdlib_takeHandle(etcdlib);
+	if (curl != NULL) {
+		curl_easy_setopt(curl, CURLOPT_NOSIGNAL, 1);
+		curl_easy_setopt(curl, CURLOPT_TIMEOUT, DEFAULT_CURL_TIMEOUT);
+		curl_easy_setopt(curl, CURLOPT_CONNECTTIMEOUT, DEFAULT_CURL_CONNECT_TIMEOUT);
+		curl_easy_setopt(curl, CURLOPT_URL, url);
+		curl_easy_setopt(curl, CURLOPT_POST, 1L);
+		curl_easy_setopt(curl, CURLOPT_POSTFIELDS, body);
+		curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, etcdlib_v3_writeReply);
+		curl_easy_setopt(curl, CURLOPT_WRITEDATA, &data);
+
+		CURLcode res = curl_easy_perform(curl);
+		curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &httpCode);
+		if (res == CURLE_OPERATION_TIMEDOUT) {
+			retVal = ETCDLIB_RC_TIMEOUT;
+		} else if (res != CURLE_OK) {
+			fprintf(stderr, "[ETCDLIB] Curl error for %s: %s\n", url, curl_easy_strerror(res));
+		} else if (httpCode != 200) {
+			fprintf(stderr, "[ETCDLIB] Error: HTTP %li for %s: %s\n", httpCode, url, data.memory != NULL ? data.memory : "");
+		} else if (data.memory != NULL) {
+			json_error_t error;
+			*reply = json_loads(data.memory, 0, &error);
+			retVal = *reply != NULL ? ETCDLIB_RC_OK : ETCDLIB_RC_ERROR;
+		}
+		etcdlib_releaseHandle(etcdlib, curl, res == CURLE_OK);
+	}
+
+	free(data.memory);
+	free(body);
+	free(url);
+	return retVal;
+}
+
+int etcdlib_v3_get_range(const etcdlib_t *etcdlib, const char *prefix, etcdlib_key_value_callback callback, void *arg, long long *revision) {
+	json_t *request = json_object();
+	json_t *reply = NULL;
+
+	etcdlib_v3_setPrefix(request, prefix);
+	int retVal = etcdlib_v3_post(etcdlib, "kv/range", request, &reply);
+	json_decref(request);
+
+	if (retVal == ETCDLIB_RC_OK) {
+		json_t *kvs = json_object_get(reply, ETCD_V3_JSON_KVS);
+		for (size_t i = 0; i < json_array_size(kvs); ++i) {
+			json_t *kv = json_array_get(kvs, i);
+			char *key = etcdlib_v3_decode(json_string_value(json_object_get(kv, ETCD_V3_JSON_KEY)));
+			char *value = etcdlib_v3_decode(json_string_value(json_object_get(kv, ETCD_V3_JSON_VALUE)));
+			if (key != NULL && value != NULL) {
+				callback(key, value, arg);
+			}
+			free(key);
+			free(value);
+		}
+		if (revision != NULL) {
+			*revision = etcdlib_v3_int(json_object_get(json_object_get(reply, ETCD_V3_JSON_HEADER), ETCD_V3_JSON_REVISION));
+		}
+		json_decref(reply);
+	}
+
+	return retVal;
+}
+
+int etcdlib_v3_put(const etcdlib_t *etcdlib, const char *key, const char *value, long long leaseId) {
+	json_t *request = json_object();
+	json_t *reply = NULL;
+
+	etcdlib_v3_setString(request, ETCD_V3_JSON_KEY, key, strlen(key));
+	etcdlib_v3_setString(request, ETCD_V3_JSON_VALUE, value, strlen(value));
+	if (leaseId != 0) {
+		json_object_set_new(request, ETCD_V3_JSON_LEASE, json_integer(leaseId));
+	}
+	int retVal = etcdlib_v3_post(etcdlib, "kv/put", request, &reply);
+	json_decref(request);
+	json_decref(reply);
+
+	return retVal;
+}
+
+int etcdlib_v3_del(const etcdlib_t *etcdlib, const char *key, bool prefix) {
+	json_t *request = json_object();
+	json_t *reply = NULL;
+
+	if (prefix) {
+		etcdlib_v3_setPrefix(request, key);
+	} else {
+		etcdlib_v3_setString(request, ETCD_V3_JSON_KEY, key, strlen(key));
+	}
+	int retVal = etcdlib_v3_post(etcdlib, "kv/deleterange", request, &reply);
+	json_decref(request);
+	json_decref(reply);
+
+	return retVal;
+}
+
+int etcdlib_v3_lease_grant(const etcdlib_t *etcdlib, int ttl, long long *leaseId) {
+	json_t *request = json_object();
+	json_t *reply = NULL;
+
+	json_object_set_new(request, ETCD_V3_JSON_TTL, json_integer(ttl));
+	int retVal = etcdlib_v3_post(etcdlib, "lease/grant", request, &reply);
+	json_decref(request);
+
+	if (retVal == ETCDLIB_RC_OK) {
+		*leaseId = etcdlib_v3_int(json_object_get(reply, ETCD_V3_JSON_ID));
+		retVal = *leaseId != 0 ? ETCDLIB_RC_OK : ETCDLIB_RC_ERROR;
+		json_decref(reply);
+	}
+
+	return retVal;
+}
+
+int etcdlib_v3_lease_keepalive(const etcdlib_t *etcdlib, long long leaseId) {
+	json_t *request = json_object();
+	json_t *reply = NULL;
+
+	json_object_set_new(request, ETCD_V3_JSON_ID, json_integer(leaseId));
+	int retVal = etcdlib_v3_post(etcdlib, "lease/keepalive", request, &reply);
+	json_decref(request);
+
+	if (retVal == ETCDLIB_RC_OK) {
+		//an expired lease is reported with a TTL of 0 (i.e. no TTL)
+		json_t *result = json_object_get(reply, ETCD_V3_JSON_RESULT);
+		if (etcdlib_v3_int(json_object_get(result, ETCD_V3_JSON_TTL)) <= 0) {
+			retVal = ETCDLIB_RC_TIMEOUT;
+		}
+		json_decref(reply);
+	}
+
+	return retVal;
+}
+
+int etcdlib_v3_lease_revoke(const etcdlib_t *etcdlib, long long leaseId) {
+	json_t *request = json_object();
+	json_t *reply = NULL;
+
+	json_object_set_new(request, ETCD_V3_JSON_ID, json_integer(leaseId));
+	int retVal = etcdlib_v3_post(etcdlib, "lease/revoke", request, &reply);
+	json_decref(request);
+	json_decref(reply);
+
+	return retVal;
+}
+
+etcdlib_watch_stream_t* etcdlib_v3_watch_stream_create(etcdlib_t *etcdlib) {
+	etcdlib_watch_stream_t *stream = calloc(1, sizeof(*stream));
+	if (stream != NULL) {
+		stream->etcdlib = etcdlib;
+	}
+	return stream;
+}
+
+void etcdlib_v3_watch_stream_destroy(etcdlib_watch_stream_t *stream) {
+	if (stream != NULL) {
+		for (size_t i = 0; i < stream->size; ++i) {
+			free(stream->watches[i].prefix);
+		}
+		free(stream->watches);
+		free(stream->buffer);
+	}
+	free(stream);
+}
+
+int etcdlib_v3_watch_stream_add(etcdlib_watch_stream_t *stream, const char *prefix, long long startRevision, etcdlib_watch_callback callback, void *arg) {
+	struct etcdlib_v3_watch *watches = realloc(stream->watches, (stream->size + 1) * sizeof(*watches));
+	if (watches == NULL) {
+		return ETCDLIB_RC_ERROR;
+	}
+	stream->watches = watches;
+
+	struct etcdlib_v3_watch *watch = &stream->watches[stream->size];
+	watch->prefix = strdup(prefix);
+	watch->revision = startRevision;
+	watch->watchId = -1;
+	watch->callback = callback;
+	watch->arg = arg;
+	if (watch->prefix == NULL) {
+		return ETCDLIB_RC_ERROR;
+	}
+	stream->size += 1;
+
+	return ETCDLIB_RC_OK;
+}
+
+static void etcdlib_v3_handleEvents(struct etcdlib_v3_watch *watch, json_t *events) {
+	for (size_t i = 0; i < json_array_size(events); ++i) {
+		json_t *event = json_array_get(events, i);
+		json_t *kv = json_object_get(event, ETCD_V3_JSON_KV);
+		const char *type = json_string_value(json_object_get(event, ETCD_V3_JSON_TYPE));
+		//PUT is the default event type and therefore omitted
+		bool deleted = type != NULL && strcmp(type, ETCD_V3_EVENT_DELETE) == 0;
+		long long revision = etcdlib_v3_int(json_object_get(kv, ETCD_V3_JSON_MOD_REVISION));
+
+		char *key = etcdlib_v3_decode(json_string_value(json_object_get(kv, ETCD_V3_JSON_KEY)));
+		char *value = deleted ? NULL : etcdlib_v3_decode(json_string_value(json_object_get(kv, ETCD_V3_JSON_VALUE)));
+		if (key != NULL && (deleted || value != NULL)) {
+			watch->callback(deleted ? ETCDLIB_ACTION_DELETE : ETCDLIB_ACTION_SET, key, value, revision, watch->arg);
+		}
+		free(key);
+		free(value);
+
+		if (revision >= watch->revision) {
+			watch->revision = revision + 1;
+		}
+	}
+}
+
+/**
+ * Handles a single watch response message. Returns false if the watch request has to be restarted.
+ */
+static bool etcdlib_v3_handleWatchResponse(etcdlib_watch_stream_t *stream, json_t *message) {
+	json_t *result = json_object_get(message, ETCD_V3_JSON_RESULT);
+	if (result == NULL) {
+		fprintf(stderr, "[ETCDLIB] Error: watch failed\n");
+		return false;
+	}
+
+	long long watchId = etcdlib_v3_int(json_object_get(result, ETCD_V3_JSON_WATCH_ID));
+	if (json_is_true(json_object_get(result, ETCD_V3_JSON_CREATED)) && stream->nrCreated < stream->size) {
+		stream->watches[stream->nrCreated++].watchId = watchId;
+	}
+
+	struct etcdlib_v3_watch *watch = NULL;
+	for (size_t i = 0; i < stream->nrCreated && watch == NULL; ++i) {
+		if (stream->watches[i].watchId == watchId) {
+			watch = &stream->watches[i];
+		}
+	}
+
+	if (watch != NULL && json_is_true(json_object_get(result, ETCD_V3_JSON_CANCELED))) {
+		//the start revision is compacted, continue with the oldest available revision
+		long long compacted = etcdlib_v3_int(json_object_get(result, ETCD_V3_JSON_COMPACT_REVISION));
+		if (compacted > watch->revision) {
+			fprintf(stderr, "[ETCDLIB] Warning: revisions up to %lld of watch %s are compacted\n", compacted, watch->prefix);
+			watch->revision = compacted;
+		}
+		return false;
+	}
+
+	if (watch != NULL) {
+		etcdlib_v3_handleEvents(watch, json_object_get(result, ETCD_V3_JSON_EVENTS));
+	}
+	return true;
+}
+
+/**
+ * Receives the watch responses. The JSON gateway streams every response as a JSON object on a single line.
+ */
+static size_t etcdlib_v3_writeWatchResponse(void *contents, size_t size, size_t nmemb, void *userp) {
+	size_t realsize = size * nmemb;
+	etcdlib_watch_stream_t *stream = userp;
+
+	char *buffer = realloc(stream->buffer, stream->bufferSize + realsize + 1);
+	if (buffer == NULL) {
+		fprintf(stderr, "[ETCDLIB] Error: not enough memory (realloc returned NULL)\n");
+		return 0;
+	}
+	stream->buffer = buffer;
+	memcpy(&stream->buffer[stream->bufferSize], contents, realsize);
+	stream->bufferSize += realsize;
+	stream->buffer[stream->bufferSize] = '\0';
+
+	char *line = stream->buffer;
+	char *end = NULL;
+	while (!stream->failed && (end = memchr(line, '\n', stream->bufferSize - (line - stream->buffer))) != NULL) {
+		json_error_t error;
+		json_t *message = json_loadb(line, end - line, 0, &error);
+		if (message != NULL) {
+			stream->failed = !etcdlib_v3_handleWatchResponse(stream, message);
+			json_decref(message);
+		}
+		line = end + 1;
+	}
+	stream->bufferSize -= line - stream->buffer;
+	memmove(stream->buffer, line, stream->bufferSize + 1);
+
+	//returning less than realsize aborts the request
+	return stream->failed ? 0 : realsize;
+}
+
+static int etcdlib_v3_watchProgress(void *clientp, curl_off_t dltotal, curl_off_t dlnow, curl_off_t ultotal, curl_off_t ulnow) {
+	const etcdlib_watch_stream_t *stream = clientp;
+	//note a non zero return value aborts the request with CURLE_ABORTED_BY_CALLBACK
+	return __atomic_load_n(&stream->etcdlib->interrupted, __ATOMIC_ACQUIRE);
+}
+
+int etcdlib_v3_watch_stream_run(etcdlib_watch_stream_t *stream, int timeoutInSeconds) {
+	int retVal = ETCDLIB_RC_ERROR;
+	char *url = NULL;
+	char *body = NULL;
+	size_t bodySize = 0;
+
+	if (stream->size == 0 || asprintf(&url, "http://%s:%d/%s/watch", stream->etcdlib->host, stream->etcdlib->port, ETCD_V3_PATH) < 0) {
+		return ETCDLIB_RC_ERROR;
+	}
+
+	//all watches are created with a single request, the JSON gateway reads one create request per line
+	FILE *bodyStream = open_memstream(&body, &bodySize);
+	for (size_t i = 0; bodyStream != NULL && i < stream->size; ++i) {
+		struct etcdlib_v3_watch *watch = &stream->watches[i];
+		json_t *create = json_object();
+		etcdlib_v3_setPrefix(create, watch->prefix);
+		json_object_set_new(create, ETCD_V3_JSON_START_REVISION, json_integer(watch->revision));
+		json_t *request = json_pack("{s:o}", ETCD_V3_JSON_CREATE_REQUEST, create);
+		char *line = json_dumps(request, JSON_COMPACT);
+		if (line != NULL) {
+			fprintf(bodyStream, "%s\n", line);
+		}
+		free(line);
+		json_decref(request);
+		watch->watchId = -1;
+	}
+	if (bodyStream != NULL) {
+		fclose(bodyStream);
+	}
+
+	stream->nrCreated = 0;
+	stream->bufferSize = 0;
+	stream->failed = false;
+
+	CURL *curl = body != NULL ? etcdlib_takeHandle(stream->etcdlib) : NULL;
+	if (curl != NULL) {
+		curl_easy_setopt(curl, CURLOPT_NOSIGNAL, 1);
+		curl_easy_setopt(curl, CURLOPT_TIMEOUT, (long)timeoutInSeconds);
+		curl_easy_setopt(curl, CURLOPT_CONNECTTIMEOUT, DEFAULT_CURL_CONNECT_TIMEOUT);
+		curl_easy_setopt(curl, CURLOPT_URL, url);
+		curl_easy_setopt(curl, CURLOPT_POST, 1L);
+		curl_easy_setopt(curl, CURLOPT_POSTFIELDS, body);
+		curl_easy_setopt(curl, CURLOPT_POSTFIELDSIZE, (long)bodySize);
+		curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, etcdlib_v3_writeWatchResponse);
+		curl_easy_setopt(curl, CURLOPT_WRITEDATA, stream);
+		//the progress callback is also called (about once a second) while waiting for data
+		curl_easy_setopt(curl, CURLOPT_NOPROGRESS, 0L);
+		curl_easy_setopt(curl, CURLOPT_XFERINFOFUNCTION, etcdlib_v3_watchProgress);
+		curl_easy_setopt(curl, CURLOPT_XFERINFODATA, stream);
+
+		CURLcode res = curl_easy_perform(curl);
+		if (res == CURLE_OPERATION_TIMEDOUT) {
+			retVal = ETCDLIB_RC_TIMEOUT;
+		} else if (res == CURLE_ABORTED_BY_CALLBACK) {
+			retVal = ETCDLIB_RC_INTERRUPTED;
+		} else if (!stream->failed) {
+			fprintf(stderr, "[ETCDLIB] Error: watch stream closed: %s\n", curl_easy_strerror(res));
+		}
+		//an interrupted or timed out watch leaves the connection in an unknown state
+		etcdlib_releaseHandle(stream->etcdlib, curl, res == CURLE_OK);
+	}
+
+	free(body);
+	free(url);
+	return retVal;
+}
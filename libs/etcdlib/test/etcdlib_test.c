@@ -26,6 +26,7 @@
 #include <stdlib.h>
 #include <unistd.h>
 #include <string.h>
+#include <time.h>
 #include "etcd.h"
 
 #include <pthread.h>
@@ -107,6 +108,220 @@ int waitforchangetest() {
 	return res;
 }
 
+int setdirtest() {
+	int res = 0;
+	char *value = NULL;
+	etcdlib_t *lib = etcdlib_create("localhost", 2379, 0);
+
+	// keys without a ttl in a ttl directory expire together with the directory
+	if (etcdlib_set_dir(lib, "ttldir", 2, false) != 0 || etcdlib_set(lib, "ttldir/key", "testvalue", 0, false) != 0) {
+		printf("etcdtest::setdir cannot create ttl directory\n");
+		res = -1;
+	}
+	sleep(1);
+	if (res == 0 && etcdlib_set_dir(lib, "ttldir", 2, true) != 0) {
+		printf("etcdtest::setdir cannot refresh ttl directory\n");
+		res = -1;
+	}
+	sleep(1);
+	if (res == 0 && (etcdlib_get(lib, "ttldir/key", &value, NULL) != 0 || value == NULL || strcmp(value, "testvalue") != 0)) {
+		printf("etcdtest::setdir expected 'testvalue' in refreshed directory, got '%s'\n", value);
+		res = -1;
+	}
+	free(value);
+	value = NULL;
+	sleep(3);
+	if (res == 0 && etcdlib_get(lib, "ttldir/key", &value, NULL) == 0) {
+		printf("etcdtest::setdir expected key to be expired, got '%s'\n", value);
+		res = -1;
+	}
+	free(value);
+	etcdlib_destroy(lib);
+	return res;
+}
+
+static void* watchUntilInterrupted(void *arg) {
+	etcdlib_t *lib = arg;
+	char *action = NULL;
+	char *prevValue = NULL;
+	char *value = NULL;
+	char *rkey = NULL;
+	long long modifiedIndex;
+	int *rc = malloc(sizeof(*rc));
+	*rc = etcdlib_watch(lib, "hier/ar", 0, &action, &prevValue, &value, &rkey, &modifiedIndex);
+	free(action);
+	free(prevValue);
+	free(value);
+	free(rkey);
+	return rc;
+}
+
+int interrupttest() {
+	int res = 0;
+	etcdlib_t *lib = etcdlib_create("localhost", 2379, 0);
+	char *value = NULL;
+	int index = 0;
+	etcdlib_set(lib, "hier/ar/chi/cal", "testvalue1", 5, false);
+	etcdlib_get(lib, "hier/ar/chi/cal", &value, &index);
+	free(value);
+
+	// a watch without changes is aborted by the interrupt, without waiting for the watch timeout
+	pthread_t watchThread;
+	pthread_create(&watchThread, NULL, watchUntilInterrupted, lib);
+	sleep(1);
+	struct timespec start, end;
+	clock_gettime(CLOCK_MONOTONIC, &start);
+	etcdlib_interrupt(lib);
+	void *rc = NULL;
+	pthread_join(watchThread, &rc);
+	clock_gettime(CLOCK_MONOTONIC, &end);
+	if (rc == NULL || *(int*)rc != ETCDLIB_RC_INTERRUPTED) {
+		printf("etcdtest::interrupt expected ETCDLIB_RC_INTERRUPTED, got %i\n", rc == NULL ? -1 : *(int*)rc);
+		res = -1;
+	} else if (end.tv_sec - start.tv_sec > 2) {
+		printf("etcdtest::interrupt watch took %li seconds to stop\n", (long)(end.tv_sec - start.tv_sec));
+		res = -1;
+	}
+	free(rc);
+	etcdlib_destroy(lib);
+	return res;
+}
+
+static void countKeyValue(const char *key, const char *value, void *arg) {
+	int *count = arg;
+	if (strncmp(key, "v3test/", 7) == 0 && value != NULL) {
+		(*count)++;
+	}
+}
+
+struct v3_events {
+	int nrOfPuts;
+	int nrOfDeletes;
+	long long lastRevision;
+};
+
+static void countEvent(const char *action, const char *key, const char *value, long long revision, void *arg) {
+	struct v3_events *events = arg;
+	if (strcmp(action, ETCDLIB_ACTION_SET) == 0 && value != NULL) {
+		events->nrOfPuts++;
+	} else if (strcmp(action, ETCDLIB_ACTION_DELETE) == 0) {
+		events->nrOfDeletes++;
+	}
+	printf(" v3 watch event %s %s (revision %lli)\n", action, key, revision);
+	events->lastRevision = revision;
+}
+
+static void* interruptAfterSecond(void *arg) {
+	sleep(1);
+	etcdlib_interrupt(arg);
+	return NULL;
+}
+
+int v3test() {
+	int res = 0;
+	etcdlib_t *lib = etcdlib_create("localhost", 2379, 0);
+	etcdlib_v3_del(lib, "v3test/", true);
+
+	// a range get returns the keys and the revision to start watching from
+	long long revision = 0;
+	int count = 0;
+	if (etcdlib_v3_put(lib, "v3test/a", "1", 0) != ETCDLIB_RC_OK || etcdlib_v3_put(lib, "v3test/b", "2", 0) != ETCDLIB_RC_OK ||
+			etcdlib_v3_get_range(lib, "v3test/", countKeyValue, &count, &revision) != ETCDLIB_RC_OK || count != 2 || revision <= 0) {
+		printf("etcdtest::v3 expected 2 keys and a revision, got %i keys at revision %lli\n", count, revision);
+		res = -1;
+	}
+
+	// keys attached to a lease are deleted when the lease is revoked, keep alive fails for a revoked lease
+	long long leaseId = 0;
+	if (res == 0 && (etcdlib_v3_lease_grant(lib, 10, &leaseId) != ETCDLIB_RC_OK || leaseId == 0 ||
+			etcdlib_v3_put(lib, "v3test/leased", "3", leaseId) != ETCDLIB_RC_OK ||
+			etcdlib_v3_lease_keepalive(lib, leaseId) != ETCDLIB_RC_OK ||
+			etcdlib_v3_lease_revoke(lib, leaseId) != ETCDLIB_RC_OK)) {
+		printf("etcdtest::v3 cannot use lease %lli\n", leaseId);
+		res = -1;
+	}
+	if (res == 0 && etcdlib_v3_lease_keepalive(lib, leaseId) != ETCDLIB_RC_TIMEOUT) {
+		printf("etcdtest::v3 expected ETCDLIB_RC_TIMEOUT for keep alive of a revoked lease\n");
+		res = -1;
+	}
+	etcdlib_v3_del(lib, "v3test/b", false);
+
+	// the watch stream reports the put and delete of the leased key and the delete of b, starting after the range get
+	struct v3_events events = {0, 0, 0};
+	etcdlib_watch_stream_t *stream = etcdlib_v3_watch_stream_create(lib);
+	if (res == 0 && (stream == NULL || etcdlib_v3_watch_stream_add(stream, "v3test/", revision + 1, countEvent, &events) != ETCDLIB_RC_OK)) {
+		printf("etcdtest::v3 cannot create watch stream\n");
+		res = -1;
+	}
+	if (res == 0) {
+		int rc = etcdlib_v3_watch_stream_run(stream, 2);
+		if (rc != ETCDLIB_RC_TIMEOUT || events.nrOfPuts != 1 || events.nrOfDeletes != 2) {
+			printf("etcdtest::v3 expected 1 put and 2 deletes, got rc %i, %i puts and %i deletes\n", rc, events.nrOfPuts, events.nrOfDeletes);
+			res = -1;
+		}
+	}
+
+	// running the stream again continues after the last event and is interrupted by etcdlib_interrupt
+	if (res == 0) {
+		long long lastRevision = events.lastRevision;
+		etcdlib_v3_put(lib, "v3test/c", "4", 0);
+		pthread_t interruptThread;
+		pthread_create(&interruptThread, NULL, interruptAfterSecond, lib);
+		int rc = etcdlib_v3_watch_stream_run(stream, 10);
+		pthread_join(interruptThread, NULL);
+		if (rc != ETCDLIB_RC_INTERRUPTED || events.nrOfPuts != 2 || events.nrOfDeletes != 2 || events.lastRevision <= lastRevision) {
+			printf("etcdtest::v3 expected an interrupted stream with only the new put, got rc %i, %i puts and %i deletes\n", rc, events.nrOfPuts, events.nrOfDeletes);
+			res = -1;
+		}
+	}
+
+	if (stream != NULL) {
+		etcdlib_v3_watch_stream_destroy(stream);
+	}
+	etcdlib_destroy(lib);
+
+	// use a new instance, the interrupted instance stays interrupted
+	lib = etcdlib_create("localhost", 2379, 0);
+	etcdlib_v3_del(lib, "v3test/", true);
+	etcdlib_destroy(lib);
+	return res;
+}
+
+int setmanytest() {
+	int res = 0;
+	etcdlib_t *lib = etcdlib_create("localhost", 2379, 0);
+	const char *keys[] = {"many/a", "many/b", "many/c"};
+	const char *values[] = {"1", "2", "3"};
+	int results[3] = {-1, -1, -1};
+
+	if (etcdlib_setMany(lib, 3, keys, values, 5, results) != 0) {
+		printf("etcdtest::setmany cannot set keys\n");
+		res = -1;
+	}
+	for (int i = 0; i < 3 && res == 0; i++) {
+		char *value = NULL;
+		if (results[i] != ETCDLIB_RC_OK || etcdlib_get(lib, keys[i], &value, NULL) != 0 || value == NULL || strcmp(value, values[i]) != 0) {
+			printf("etcdtest::setmany expected '%s' for %s, got '%s'\n", values[i], keys[i], value);
+			res = -1;
+		}
+		free(value);
+	}
+
+	// a refresh of the existing keys succeeds, a missing key is reported in its result only
+	const char *refreshKeys[] = {"many/a", "many/missing", "many/c"};
+	if (res == 0 && (etcdlib_refreshMany(lib, 3, refreshKeys, 5, results) == 0 ||
+			results[0] != ETCDLIB_RC_OK || results[1] == ETCDLIB_RC_OK || results[2] != ETCDLIB_RC_OK)) {
+		printf("etcdtest::setmany expected only the refresh of the missing key to fail, got %i %i %i\n", results[0], results[1], results[2]);
+		res = -1;
+	}
+
+	for (int i = 0; i < 3; i++) {
+		etcdlib_del(lib, keys[i]);
+	}
+	etcdlib_destroy(lib);
+	return res;
+}
+
 int main (void) {
 	etcdlib = etcdlib_create("localhost", 2379, 0);
 
@@ -141,6 +356,10 @@ int main (void) {
 
 	int res = simplewritetest(); if(res) return res; else printf("simplewrite test success\n");
 	res = waitforchangetest(); if(res) return res;else printf("waitforchange1 test success\n");
+	res = setdirtest(); if(res) return res; else printf("setdir test success\n");
+	res = interrupttest(); if(res) return res; else printf("interrupt test success\n");
+	res = setmanytest(); if(res) return res; else printf("setmany test success\n");
+	res = v3test(); if(res) return res; else printf("v3 test success\n");
 
 	etcdlib_destroy(etcdlib);
 
@@ -0,0 +1,37 @@
+#!/bin/bash
+# Licensed to the Apache Software Foundation (ASF) under one
+# or more contributor license agreements.  See the NOTICE file
+# distributed with this work for additional information
+# regarding copyright ownership.  The ASF licenses this file
+# to you under the Apache License, Version 2.0 (the
+# "License"); you may not use this file except in compliance
+# with the License.  You may obtain a copy of the License at
+#
+#   http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing,
+# software distributed under the License is distributed on an
+# "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+#  KIND, either express or implied.  See the License for the
+# specific language governing permissions and limitations
+# under the License.
+
+# Smoke test of the boot benchmark: runs the celix_boot_benchmark container with a few small component and dependency
+# counts and checks that every run reports that all components became active.
+# Usage: boot_benchmark_smoke_test.sh <deploy dir>
+
+BENCHMARK_DIR=$1
+export NR_OF_COMPONENTS="1 5"
+export NR_OF_DEPENDENCIES="0 2"
+export RUNS=1
+export BOOT_BENCHMARK_TIMEOUT=30
+
+"${BENCHMARK_DIR}/run_boot_benchmark.sh" > /dev/null
+RESULTS=${BENCHMARK_DIR}/boot_benchmark_results.json
+NR_OF_RUNS=$(grep -c "\"allActive\":true" "${RESULTS}")
+if [ "${NR_OF_RUNS}" != "4" ]; then
+    echo "Expected 4 boot benchmark runs with all components active, got ${NR_OF_RUNS}:"
+    cat "${RESULTS}"
+    exit 1
+fi
+echo "Boot benchmark smoke test succeeded"
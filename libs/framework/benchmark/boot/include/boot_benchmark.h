@@ -0,0 +1,61 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *  KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#ifndef BOOT_BENCHMARK_H_
+#define BOOT_BENCHMARK_H_
+
+/**
+ * Config properties of the boot benchmark bundles.
+ */
+#define BOOT_BENCHMARK_NR_OF_BUNDLES_KEY            "BOOT_BENCHMARK_NR_OF_BUNDLES" //nr of synthetic bundles in the container
+#define BOOT_BENCHMARK_NR_OF_BUNDLES_DEFAULT        1
+#define BOOT_BENCHMARK_NR_OF_COMPONENTS_KEY         "BOOT_BENCHMARK_NR_OF_COMPONENTS" //components per synthetic bundle
+#define BOOT_BENCHMARK_NR_OF_COMPONENTS_DEFAULT     10
+#define BOOT_BENCHMARK_NR_OF_DEPENDENCIES_KEY       "BOOT_BENCHMARK_NR_OF_DEPENDENCIES" //required dependencies per component
+#define BOOT_BENCHMARK_NR_OF_DEPENDENCIES_DEFAULT   3
+#define BOOT_BENCHMARK_TIMEOUT_KEY                  "BOOT_BENCHMARK_TIMEOUT" //seconds to wait for all components
+#define BOOT_BENCHMARK_TIMEOUT_DEFAULT              60
+#define BOOT_BENCHMARK_STEADY_STATE_DELAY_KEY       "BOOT_BENCHMARK_STEADY_STATE_DELAY" //ms after all components are active
+#define BOOT_BENCHMARK_STEADY_STATE_DELAY_DEFAULT   1000
+#define BOOT_BENCHMARK_LABEL_KEY                    "BOOT_BENCHMARK_LABEL" //added to the results
+#define BOOT_BENCHMARK_LABEL_DEFAULT                "boot_benchmark"
+#define BOOT_BENCHMARK_RESULT_FILE_KEY              "BOOT_BENCHMARK_RESULT_FILE" //a json object per run is appended
+#define BOOT_BENCHMARK_RESULT_FILE_DEFAULT          "boot_benchmark_results.json"
+#define BOOT_BENCHMARK_EXIT_KEY                     "BOOT_BENCHMARK_EXIT" //stop the framework after reporting
+#define BOOT_BENCHMARK_EXIT_DEFAULT                 true
+
+/**
+ * Service provided by every synthetic component, with the global index of the component as service property.
+ * The components of synthetic bundle b (1..N) have the global indices (b-1)*M .. b*M-1.
+ */
+#define BOOT_BENCHMARK_SERVICE_NAME                 "boot_benchmark_service"
+#define BOOT_BENCHMARK_SERVICE_VERSION              "1.0.0"
+#define BOOT_BENCHMARK_SERVICE_INDEX                "boot.benchmark.index"
+
+/**
+ * The synthetic bundles have the symbolic name BOOT_BENCHMARK_BUNDLE_PREFIX<b>.
+ */
+#define BOOT_BENCHMARK_BUNDLE_PREFIX                "apache_celix_boot_benchmark_bundle_"
+
+typedef struct boot_benchmark_service {
+    void *handle;
+    long (*getIndex)(void *handle);
+} boot_benchmark_service_t;
+
+#endif /* BOOT_BENCHMARK_H_ */
@@ -0,0 +1,44 @@
+#!/bin/bash
+# Licensed to the Apache Software Foundation (ASF) under one
+# or more contributor license agreements.  See the NOTICE file
+# distributed with this work for additional information
+# regarding copyright ownership.  The ASF licenses this file
+# to you under the Apache License, Version 2.0 (the
+# "License"); you may not use this file except in compliance
+# with the License.  You may obtain a copy of the License at
+#
+#   http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing,
+# software distributed under the License is distributed on an
+# "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+#  KIND, either express or implied.  See the License for the
+# specific language governing permissions and limitations
+# under the License.
+
+# Runs the celix_boot_benchmark container for every combination of the provided nr of components and dependencies
+# (per synthetic bundle / component) and collects the results in boot_benchmark_results.json, a json object per line.
+# Additional framework config can be provided as environment variables, e.g.
+#   CELIX_STARTUP_TRACE_FILE=trace.json NR_OF_COMPONENTS="10 50" NR_OF_DEPENDENCIES="0 3" ./run_boot_benchmark.sh
+
+BENCHMARK_DIR=$(cd "$(dirname "$0")" && pwd)
+CONTAINER=celix_boot_benchmark
+RESULTS=${BENCHMARK_DIR}/boot_benchmark_results.json
+NR_OF_COMPONENTS=${NR_OF_COMPONENTS:-10}
+NR_OF_DEPENDENCIES=${NR_OF_DEPENDENCIES:-3}
+RUNS=${RUNS:-3}
+export BOOT_BENCHMARK_RESULT_FILE=${RESULTS}
+export BOOT_BENCHMARK_TIMEOUT=${BOOT_BENCHMARK_TIMEOUT:-60}
+
+rm -f "${RESULTS}"
+for COMPONENTS in ${NR_OF_COMPONENTS}; do
+    for DEPENDENCIES in ${NR_OF_DEPENDENCIES}; do
+        for RUN in $(seq 1 "${RUNS}"); do
+            echo "Running ${CONTAINER} with ${COMPONENTS} components and ${DEPENDENCIES} dependencies (run ${RUN})"
+            (cd "${BENCHMARK_DIR}/${CONTAINER}" && \
+                BOOT_BENCHMARK_NR_OF_COMPONENTS=${COMPONENTS} BOOT_BENCHMARK_NR_OF_DEPENDENCIES=${DEPENDENCIES} \
+                timeout -s INT $((BOOT_BENCHMARK_TIMEOUT + 30)) ./${CONTAINER})
+        done
+    done
+done
+echo "Results written to ${RESULTS}"
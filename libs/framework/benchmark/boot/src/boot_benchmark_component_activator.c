@@ -0,0 +1,155 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *  KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "celix_api.h"
+
+#include "boot_benchmark.h"
+
+/**
+ * A synthetic component. Provides a boot_benchmark_service and has required dependencies on the components with
+ * the same position in the previous bundles. The first component of every bundle also consumes all
+ * boot_benchmark_services with an optional dependency, so that there are trackers with a large fan out.
+ */
+typedef struct boot_benchmark_cmp {
+    long index;
+    boot_benchmark_service_t svc;
+    size_t nrOfDependenciesSet;
+    size_t nrOfTrackedServices;
+} boot_benchmark_cmp_t;
+
+typedef struct boot_benchmark_activator {
+    size_t nrOfComponents;
+    boot_benchmark_cmp_t *cmps;
+} boot_benchmark_activator_t;
+
+static long bootBenchmarkCmp_getIndex(void *handle) {
+    boot_benchmark_cmp_t *cmp = handle;
+    return cmp->index;
+}
+
+static int bootBenchmarkCmp_setDependency(void *handle, void *svc) {
+    boot_benchmark_cmp_t *cmp = handle;
+    if (svc != NULL) {
+        cmp->nrOfDependenciesSet += 1;
+    }
+    return CELIX_SUCCESS;
+}
+
+static int bootBenchmarkCmp_addService(void *handle, void *svc __attribute__((unused))) {
+    boot_benchmark_cmp_t *cmp = handle;
+    cmp->nrOfTrackedServices += 1;
+    return CELIX_SUCCESS;
+}
+
+static int bootBenchmarkCmp_removeService(void *handle, void *svc __attribute__((unused))) {
+    boot_benchmark_cmp_t *cmp = handle;
+    cmp->nrOfTrackedServices -= 1;
+    return CELIX_SUCCESS;
+}
+
+/**
+ * Returns the bundle index (1..N) based on the symbolic name of the bundle, or -1.
+ */
+static long bootBenchmark_bundleIndex(celix_bundle_context_t *ctx) {
+    const char *symName = celix_bundle_getSymbolicName(celix_bundleContext_getBundle(ctx));
+    size_t prefixLen = strlen(BOOT_BENCHMARK_BUNDLE_PREFIX);
+    if (symName == NULL || strncmp(symName, BOOT_BENCHMARK_BUNDLE_PREFIX, prefixLen) != 0) {
+        return -1;
+    }
+    char *end = NULL;
+    long index = strtol(symName + prefixLen, &end, 10);
+    return (end != NULL && *end == '\0' && index > 0) ? index : -1;
+}
+
+static celix_dm_component_t* bootBenchmark_createComponent(celix_bundle_context_t *ctx, boot_benchmark_cmp_t *cmp, long nrOfComponents, long nrOfDependencies, bool consumeAll) {
+    char name[64];
+    snprintf(name, sizeof(name), "BootBenchmarkComponent%li", cmp->index);
+    celix_dm_component_t *dmCmp = celix_dmComponent_create(ctx, name);
+    celix_dmComponent_setImplementation(dmCmp, cmp);
+
+    cmp->svc.handle = cmp;
+    cmp->svc.getIndex = bootBenchmarkCmp_getIndex;
+    celix_properties_t *props = celix_properties_create();
+    celix_properties_setLong(props, BOOT_BENCHMARK_SERVICE_INDEX, cmp->index);
+    celix_dmComponent_addInterface(dmCmp, BOOT_BENCHMARK_SERVICE_NAME, BOOT_BENCHMARK_SERVICE_VERSION, &cmp->svc, props);
+
+    for (long k = 1; k <= nrOfDependencies; ++k) {
+        long target = cmp->index - k * nrOfComponents;
+        if (target < 0) {
+            break;
+        }
+        char filter[64];
+        snprintf(filter, sizeof(filter), "(%s=%li)", BOOT_BENCHMARK_SERVICE_INDEX, target);
+        celix_dm_service_dependency_t *dep = celix_dmServiceDependency_create();
+        celix_dmServiceDependency_setService(dep, BOOT_BENCHMARK_SERVICE_NAME, NULL, filter);
+        celix_dmServiceDependency_setCallback(dep, bootBenchmarkCmp_setDependency);
+        celix_dmServiceDependency_setRequired(dep, true);
+        celix_dmComponent_addServiceDependency(dmCmp, dep);
+    }
+
+    if (consumeAll) {
+        celix_dm_service_dependency_t *dep = celix_dmServiceDependency_create();
+        celix_dmServiceDependency_setService(dep, BOOT_BENCHMARK_SERVICE_NAME, NULL, NULL);
+        celix_dm_service_dependency_callback_options_t opts = CELIX_EMPTY_DM_SERVICE_DEPENDENCY_CALLBACK_OPTIONS;
+        opts.add = bootBenchmarkCmp_addService;
+        opts.remove = bootBenchmarkCmp_removeService;
+        celix_dmServiceDependency_setCallbacksWithOptions(dep, &opts);
+        celix_dmServiceDependency_setRequired(dep, false);
+        celix_dmComponent_addServiceDependency(dmCmp, dep);
+    }
+    return dmCmp;
+}
+
+static celix_status_t bootBenchmarkActivator_start(boot_benchmark_activator_t *act, celix_bundle_context_t *ctx) {
+    long bundleIndex = bootBenchmark_bundleIndex(ctx);
+    long nrOfComponents = celix_bundleContext_getPropertyAsLong(ctx, BOOT_BENCHMARK_NR_OF_COMPONENTS_KEY, BOOT_BENCHMARK_NR_OF_COMPONENTS_DEFAULT);
+    long nrOfDependencies = celix_bundleContext_getPropertyAsLong(ctx, BOOT_BENCHMARK_NR_OF_DEPENDENCIES_KEY, BOOT_BENCHMARK_NR_OF_DEPENDENCIES_DEFAULT);
+    if (bundleIndex < 0 || nrOfComponents <= 0) {
+        fprintf(stderr, "[BOOT_BENCHMARK] Invalid synthetic bundle (index %li) or nr of components (%li)\n", bundleIndex, nrOfComponents);
+        return CELIX_ILLEGAL_ARGUMENT;
+    }
+
+    act->nrOfComponents = (size_t) nrOfComponents;
+    act->cmps = calloc(act->nrOfComponents, sizeof(*act->cmps));
+    if (act->cmps == NULL) {
+        return CELIX_ENOMEM;
+    }
+
+    celix_dependency_manager_t *mng = celix_bundleContext_getDependencyManager(ctx);
+    for (size_t i = 0; i < act->nrOfComponents; ++i) {
+        act->cmps[i].index = (bundleIndex - 1) * nrOfComponents + (long) i;
+        celix_dm_component_t *dmCmp = bootBenchmark_createComponent(ctx, &act->cmps[i], nrOfComponents, nrOfDependencies, i == 0);
+        celix_dependencyManager_add(mng, dmCmp);
+    }
+    return CELIX_SUCCESS;
+}
+
+static celix_status_t bootBenchmarkActivator_stop(boot_benchmark_activator_t *act, celix_bundle_context_t *ctx) {
+    celix_dependency_manager_t *mng = celix_bundleContext_getDependencyManager(ctx);
+    celix_dependencyManager_removeAllComponents(mng);
+    free(act->cmps);
+    act->cmps = NULL;
+    return CELIX_SUCCESS;
+}
+
+CELIX_GEN_BUNDLE_ACTIVATOR(boot_benchmark_activator_t, bootBenchmarkActivator_start, bootBenchmarkActivator_stop)
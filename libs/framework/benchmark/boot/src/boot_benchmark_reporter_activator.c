@@ -0,0 +1,208 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *  KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/resource.h>
+
+#include "celix_api.h"
+
+#include "boot_benchmark.h"
+
+/**
+ * Measures the time until all synthetic components are active (i.e. all boot_benchmark_services are registered),
+ * the peak RSS and the nr of threads at steady state. Should be the first bundle of the container.
+ */
+typedef struct boot_benchmark_reporter {
+    celix_bundle_context_t *ctx;
+    const char *label;
+    const char *resultFile;
+    long nrOfBundles;
+    long nrOfComponents;
+    long nrOfDependencies;
+    long expectedNrOfServices;
+    uint64_t timeout; //ns
+    uint64_t steadyStateDelay; //ns
+    bool exitAfterReport;
+    uint64_t startTime; //monotonic ns, start of the reporter bundle
+    long trackerId;
+    celix_thread_t thread;
+
+    celix_thread_mutex_t mutex; //protects below
+    celix_thread_cond_t cond;
+    bool running;
+    long nrOfServices;
+} boot_benchmark_reporter_t;
+
+static uint64_t bootBenchmark_now(clockid_t clock) {
+    struct timespec now;
+    clock_gettime(clock, &now);
+    return (uint64_t) now.tv_sec * 1000000000UL + (uint64_t) now.tv_nsec;
+}
+
+/**
+ * Returns the time since the start of the process in ns (with clock tick resolution), or 0 if unknown.
+ */
+static uint64_t bootBenchmark_processUptime(void) {
+    uint64_t uptime = 0;
+    char buf[1024];
+    FILE *file = fopen("/proc/self/stat", "r");
+    if (file != NULL) {
+        size_t len = fread(buf, 1, sizeof(buf) - 1, file);
+        fclose(file);
+        buf[len] = '\0';
+        char *p = strrchr(buf, ')'); //note the process name can contain spaces
+        unsigned long long startTicks = 0;
+        //starttime is field 22, after the ')' follow the fields 3 (state) ..
+        if (p != NULL && sscanf(p + 2, "%*c %*d %*d %*d %*d %*d %*u %*u %*u %*u %*u %*u %*u %*d %*d %*d %*d %*d %*d %llu", &startTicks) == 1) {
+            uint64_t startTime = (uint64_t) startTicks * 1000000000UL / (uint64_t) sysconf(_SC_CLK_TCK);
+            uint64_t now = bootBenchmark_now(CLOCK_BOOTTIME);
+            uptime = now > startTime ? now - startTime : 0;
+        }
+    }
+    return uptime;
+}
+
+static long bootBenchmark_nrOfThreads(void) {
+    long threads = -1;
+    char line[256];
+    FILE *file = fopen("/proc/self/status", "r");
+    if (file != NULL) {
+        while (fgets(line, sizeof(line), file) != NULL) {
+            if (sscanf(line, "Threads: %li", &threads) == 1) {
+                break;
+            }
+        }
+        fclose(file);
+    }
+    return threads;
+}
+
+static void bootBenchmarkReporter_addService(void *handle, void *svc __attribute__((unused))) {
+    boot_benchmark_reporter_t *reporter = handle;
+    celixThreadMutex_lock(&reporter->mutex);
+    reporter->nrOfServices += 1;
+    celixThreadCondition_broadcast(&reporter->cond);
+    celixThreadMutex_unlock(&reporter->mutex);
+}
+
+static void bootBenchmarkReporter_removeService(void *handle, void *svc __attribute__((unused))) {
+    boot_benchmark_reporter_t *reporter = handle;
+    celixThreadMutex_lock(&reporter->mutex);
+    reporter->nrOfServices -= 1;
+    celixThreadMutex_unlock(&reporter->mutex);
+}
+
+static void bootBenchmarkReporter_report(boot_benchmark_reporter_t *reporter, bool allActive, long nrOfServices, uint64_t allActiveTime, uint64_t processUptime) {
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    long peakRssKb = usage.ru_maxrss; //note kilobytes on Linux
+    long nrOfThreads = bootBenchmark_nrOfThreads();
+    double allActiveMs = (double) allActiveTime / 1e6;
+    double processUptimeMs = (double) processUptime / 1e6;
+
+    printf("[BOOT_BENCHMARK] %s: %li bundles x %li components (%li dependencies): %s in %.3f ms (%.3f ms since process start), peak RSS %li kB, %li threads\n",
+           reporter->label, reporter->nrOfBundles, reporter->nrOfComponents, reporter->nrOfDependencies,
+           allActive ? "all components active" : "TIMEOUT, not all components active", allActiveMs, processUptimeMs,
+           peakRssKb, nrOfThreads);
+
+    FILE *file = fopen(reporter->resultFile, "a");
+    if (file != NULL) {
+        fprintf(file, "{\"label\":\"%s\",\"nrOfBundles\":%li,\"nrOfComponents\":%li,\"nrOfDependencies\":%li,"
+                      "\"allActive\":%s,\"nrOfActiveComponents\":%li,\"allActiveMs\":%f,\"processUptimeMs\":%f,"
+                      "\"peakRssKb\":%li,\"nrOfThreads\":%li}\n",
+                reporter->label, reporter->nrOfBundles, reporter->nrOfComponents, reporter->nrOfDependencies,
+                allActive ? "true" : "false", nrOfServices, allActiveMs, processUptimeMs,
+                peakRssKb, nrOfThreads);
+        fclose(file);
+    } else {
+        fprintf(stderr, "[BOOT_BENCHMARK] Cannot open result file %s\n", reporter->resultFile);
+    }
+}
+
+static void* bootBenchmarkReporter_run(void *data) {
+    boot_benchmark_reporter_t *reporter = data;
+
+    celixThreadMutex_lock(&reporter->mutex);
+    while (reporter->running && reporter->nrOfServices < reporter->expectedNrOfServices &&
+           bootBenchmark_now(CLOCK_MONOTONIC) - reporter->startTime < reporter->timeout) {
+        celixThreadCondition_timedwaitRelative(&reporter->cond, &reporter->mutex, 0, 10 * 1000 * 1000);
+    }
+    uint64_t allActiveTime = bootBenchmark_now(CLOCK_MONOTONIC) - reporter->startTime;
+    uint64_t processUptime = bootBenchmark_processUptime();
+    bool allActive = reporter->nrOfServices >= reporter->expectedNrOfServices;
+    long nrOfServices = reporter->nrOfServices;
+
+    //wait for the steady state, i.e. give lazy and async framework activity time to settle
+    uint64_t steadyStart = bootBenchmark_now(CLOCK_MONOTONIC);
+    while (reporter->running && bootBenchmark_now(CLOCK_MONOTONIC) - steadyStart < reporter->steadyStateDelay) {
+        celixThreadCondition_timedwaitRelative(&reporter->cond, &reporter->mutex, 0, 10 * 1000 * 1000);
+    }
+    bool running = reporter->running;
+    celixThreadMutex_unlock(&reporter->mutex);
+
+    if (running) {
+        bootBenchmarkReporter_report(reporter, allActive, nrOfServices, allActiveTime, processUptime);
+        if (reporter->exitAfterReport) {
+            //note stopping the framework bundle is async (shutdown thread), so this thread can still be joined.
+            celix_bundleContext_stopBundle(reporter->ctx, 0L);
+        }
+    }
+    return NULL;
+}
+
+static celix_status_t bootBenchmarkReporter_start(boot_benchmark_reporter_t *reporter, celix_bundle_context_t *ctx) {
+    reporter->startTime = bootBenchmark_now(CLOCK_MONOTONIC);
+    reporter->ctx = ctx;
+    reporter->label = celix_bundleContext_getProperty(ctx, BOOT_BENCHMARK_LABEL_KEY, BOOT_BENCHMARK_LABEL_DEFAULT);
+    reporter->resultFile = celix_bundleContext_getProperty(ctx, BOOT_BENCHMARK_RESULT_FILE_KEY, BOOT_BENCHMARK_RESULT_FILE_DEFAULT);
+    reporter->nrOfBundles = celix_bundleContext_getPropertyAsLong(ctx, BOOT_BENCHMARK_NR_OF_BUNDLES_KEY, BOOT_BENCHMARK_NR_OF_BUNDLES_DEFAULT);
+    reporter->nrOfComponents = celix_bundleContext_getPropertyAsLong(ctx, BOOT_BENCHMARK_NR_OF_COMPONENTS_KEY, BOOT_BENCHMARK_NR_OF_COMPONENTS_DEFAULT);
+    reporter->nrOfDependencies = celix_bundleContext_getPropertyAsLong(ctx, BOOT_BENCHMARK_NR_OF_DEPENDENCIES_KEY, BOOT_BENCHMARK_NR_OF_DEPENDENCIES_DEFAULT);
+    reporter->expectedNrOfServices = reporter->nrOfBundles * reporter->nrOfComponents;
+    reporter->timeout = (uint64_t) celix_bundleContext_getPropertyAsLong(ctx, BOOT_BENCHMARK_TIMEOUT_KEY, BOOT_BENCHMARK_TIMEOUT_DEFAULT) * 1000000000UL;
+    reporter->steadyStateDelay = (uint64_t) celix_bundleContext_getPropertyAsLong(ctx, BOOT_BENCHMARK_STEADY_STATE_DELAY_KEY, BOOT_BENCHMARK_STEADY_STATE_DELAY_DEFAULT) * 1000000UL;
+    reporter->exitAfterReport = celix_bundleContext_getPropertyAsBool(ctx, BOOT_BENCHMARK_EXIT_KEY, BOOT_BENCHMARK_EXIT_DEFAULT);
+
+    celixThreadMutex_create(&reporter->mutex, NULL);
+    celixThreadCondition_init(&reporter->cond, NULL);
+    reporter->running = true;
+    reporter->trackerId = celix_bundleContext_trackServices(ctx, BOOT_BENCHMARK_SERVICE_NAME, reporter, bootBenchmarkReporter_addService, bootBenchmarkReporter_removeService);
+    celixThread_create(&reporter->thread, NULL, bootBenchmarkReporter_run, reporter);
+    celixThread_setName(&reporter->thread, "BootBenchmark");
+    return CELIX_SUCCESS;
+}
+
+static celix_status_t bootBenchmarkReporter_stop(boot_benchmark_reporter_t *reporter, celix_bundle_context_t *ctx) {
+    celixThreadMutex_lock(&reporter->mutex);
+    reporter->running = false;
+    celixThreadCondition_broadcast(&reporter->cond);
+    celixThreadMutex_unlock(&reporter->mutex);
+    celixThread_join(reporter->thread, NULL);
+
+    celix_bundleContext_stopTracker(ctx, reporter->trackerId);
+    celixThreadCondition_destroy(&reporter->cond);
+    celixThreadMutex_destroy(&reporter->mutex);
+    return CELIX_SUCCESS;
+}
+
+CELIX_GEN_BUNDLE_ACTIVATOR(boot_benchmark_reporter_t, bootBenchmarkReporter_start, bootBenchmarkReporter_stop)
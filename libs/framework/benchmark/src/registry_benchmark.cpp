@@ -0,0 +1,190 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *  KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <string>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+#include "celix_api.h"
+#include "celix_framework_factory.h"
+
+namespace {
+    class FrameworkFixture {
+    public:
+        FrameworkFixture() {
+            celix_properties_t *config = celix_properties_create();
+            celix_properties_set(config, "org.osgi.framework.storage.clean", "onFirstInit");
+            celix_properties_set(config, "org.osgi.framework.storage", ".cacheRegistryBenchmark");
+            celix_properties_set(config, "LOGHELPER_ENABLE_STDOUT_FALLBACK", "false");
+            fw = celix_frameworkFactory_createFramework(config);
+            ctx = celix_framework_getFrameworkContext(fw);
+        }
+
+        ~FrameworkFixture() {
+            celix_frameworkFactory_destroyFramework(fw);
+        }
+
+        FrameworkFixture(const FrameworkFixture&) = delete;
+        FrameworkFixture& operator=(const FrameworkFixture&) = delete;
+
+        celix_framework_t *fw = nullptr;
+        celix_bundle_context_t *ctx = nullptr;
+    };
+
+    struct dummy_service {
+        void *handle;
+    };
+}
+
+/**
+ * Register and unregister state.range(0) services.
+ */
+static void RegisterAndUnregisterServices(benchmark::State& state) {
+    FrameworkFixture fixture{};
+    dummy_service svc{nullptr};
+    const auto nrOfServices = static_cast<size_t>(state.range(0));
+    std::vector<long> svcIds(nrOfServices);
+
+    for (auto _ : state) {
+        for (size_t i = 0; i < nrOfServices; ++i) {
+            svcIds[i] = celix_bundleContext_registerService(fixture.ctx, &svc, "dummy_service", nullptr);
+        }
+        for (size_t i = 0; i < nrOfServices; ++i) {
+            celix_bundleContext_unregisterService(fixture.ctx, svcIds[i]);
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(nrOfServices));
+}
+BENCHMARK(RegisterAndUnregisterServices)->Arg(10)->Arg(100)->Arg(10000)->Unit(benchmark::kMicrosecond);
+
+/**
+ * Latency of a single useService call with state.range(0) registered services.
+ */
+static void UseService(benchmark::State& state) {
+    FrameworkFixture fixture{};
+    dummy_service svc{nullptr};
+    std::vector<long> svcIds{};
+    for (int64_t i = 0; i < state.range(0); ++i) {
+        svcIds.push_back(celix_bundleContext_registerService(fixture.ctx, &svc, "dummy_service", nullptr));
+    }
+
+    long count = 0;
+    for (auto _ : state) {
+        bool called = celix_bundleContext_useService(fixture.ctx, "dummy_service", &count, [](void *handle, void *) {
+            auto *c = static_cast<long*>(handle);
+            *c += 1;
+        });
+        benchmark::DoNotOptimize(called);
+    }
+    state.SetItemsProcessed(state.iterations());
+
+    for (auto svcId : svcIds) {
+        celix_bundleContext_unregisterService(fixture.ctx, svcId);
+    }
+}
+BENCHMARK(UseService)->Arg(1)->Arg(100)->Arg(1000)->Unit(benchmark::kMicrosecond);
+
+/**
+ * Number of tracker add callbacks per second, for a tracker started with state.range(0) registered services.
+ */
+static void TrackServices(benchmark::State& state) {
+    FrameworkFixture fixture{};
+    dummy_service svc{nullptr};
+    std::vector<long> svcIds{};
+    for (int64_t i = 0; i < state.range(0); ++i) {
+        svcIds.push_back(celix_bundleContext_registerService(fixture.ctx, &svc, "dummy_service", nullptr));
+    }
+
+    long count = 0;
+    for (auto _ : state) {
+        long trackerId = celix_bundleContext_trackServices(fixture.ctx, "dummy_service", &count, [](void *handle, void *) {
+            auto *c = static_cast<long*>(handle);
+            *c += 1;
+        }, nullptr);
+        state.PauseTiming();
+        celix_bundleContext_stopTracker(fixture.ctx, trackerId);
+        state.ResumeTiming();
+    }
+    state.SetItemsProcessed(count);
+
+    for (auto svcId : svcIds) {
+        celix_bundleContext_unregisterService(fixture.ctx, svcId);
+    }
+}
+BENCHMARK(TrackServices)->Arg(10)->Arg(100)->Arg(1000)->Unit(benchmark::kMicrosecond);
+
+/**
+ * Cost of the service events (fw_serviceChanged) of a register/unregister with state.range(0) service listeners.
+ * Half of the listeners use a objectClass filter matching the service, the other half a filter not requiring
+ * a objectClass.
+ */
+static void ServiceChangedWithListeners(benchmark::State& state) {
+    FrameworkFixture fixture{};
+    dummy_service svc{nullptr};
+
+    long count = 0;
+    std::vector<celix_service_listener_t> listeners(static_cast<size_t>(state.range(0)));
+    for (size_t i = 0; i < listeners.size(); ++i) {
+        listeners[i].handle = &count;
+        listeners[i].serviceChanged = [](void *handle, celix_service_event_t *) -> celix_status_t {
+            auto *c = static_cast<long*>(handle);
+            *c += 1;
+            return CELIX_SUCCESS;
+        };
+        const char *filter = i % 2 == 0 ? "(objectClass=dummy_service)" : "(name=dummy)";
+        bundleContext_addServiceListener(fixture.ctx, &listeners[i], filter);
+    }
+
+    for (auto _ : state) {
+        long svcId = celix_bundleContext_registerService(fixture.ctx, &svc, "dummy_service", nullptr);
+        celix_bundleContext_unregisterService(fixture.ctx, svcId);
+    }
+    state.SetItemsProcessed(state.iterations());
+
+    for (auto &listener : listeners) {
+        bundleContext_removeServiceListener(fixture.ctx, &listener);
+    }
+}
+BENCHMARK(ServiceChangedWithListeners)->Arg(0)->Arg(10)->Arg(100)->Arg(1000)->Unit(benchmark::kMicrosecond);
+
+/**
+ * Concurrent getService/ungetService calls, every benchmark thread uses its own service.
+ * Measures the contention on the registry for get/unget of different services.
+ */
+static void GetAndUngetServiceConcurrently(benchmark::State& state) {
+    static FrameworkFixture fixture{}; //note shared by the benchmark threads
+    dummy_service svc{nullptr};
+    std::string serviceName = std::string{"dummy_service_"} + std::to_string(state.thread_index());
+    long svcId = celix_bundleContext_registerService(fixture.ctx, &svc, serviceName.c_str(), nullptr);
+    service_reference_pt ref = nullptr;
+    bundleContext_getServiceReference(fixture.ctx, serviceName.c_str(), &ref);
+
+    for (auto _ : state) {
+        void *service = nullptr;
+        bundleContext_getService(fixture.ctx, ref, &service);
+        benchmark::DoNotOptimize(service);
+        bundleContext_ungetService(fixture.ctx, ref, nullptr);
+    }
+    state.SetItemsProcessed(state.iterations());
+
+    bundleContext_ungetServiceReference(fixture.ctx, ref);
+    celix_bundleContext_unregisterService(fixture.ctx, svcId);
+}
+BENCHMARK(GetAndUngetServiceConcurrently)->ThreadRange(1, 8)->UseRealTime();
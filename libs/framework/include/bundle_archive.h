@@ -49,6 +49,14 @@ celix_status_t bundleArchive_createSystemBundleArchive(bundle_archive_pt *bundle
 
 celix_status_t bundleArchive_recreate(const char *archiveRoot, bundle_archive_pt *bundle_archive);
 
+/**
+ * Creates a sealed archive for a bundle extracted in <archiveRoot>/version0.0 (e.g. from a bundle image).
+ * A sealed archive does not write any state to the archive root, cannot be revised and is not deleted when closed.
+ * The archive takes ownership of the manifest (also on failure).
+ */
+celix_status_t bundleArchive_createSealed(const char *archiveRoot, long id, const char *location, manifest_pt manifest,
+                                          bundle_archive_pt *bundle_archive);
+
 celix_status_t bundleArchive_destroy(bundle_archive_pt archive);
 
 FRAMEWORK_EXPORT celix_status_t bundleArchive_getId(bundle_archive_pt archive, long *id);
@@ -70,8 +70,35 @@ extern "C" {
 celix_status_t bundleRevision_create(const char *root, const char *location, long revisionNr, const char *inputFile,
                                      bundle_revision_pt *bundle_revision);
 
+/**
+ * Creates a revision as bundleRevision_create, but stores the parsed manifest headers (and later on the resolved
+ * wiring, see bundleRevision_setCachedWiring) in the revision root, keyed by the provided cache key (the last
+ * modified time of the bundle archive). If the key matches on a next create, the cached manifest headers are used
+ * instead of parsing the manifest file. A cache key of -1 disables caching.
+ */
+celix_status_t bundleRevision_createCached(const char *root, const char *location, long revisionNr, const char *inputFile,
+                                           long long cacheKey, bundle_revision_pt *bundle_revision);
+
+/**
+ * Creates a revision for an already extracted bundle, using the provided manifest instead of reading the manifest
+ * file. The revision takes ownership of the manifest (also on failure).
+ */
+celix_status_t bundleRevision_createWithManifest(const char *root, const char *location, long revisionNr,
+                                                 manifest_pt manifest, bundle_revision_pt *bundle_revision);
+
 celix_status_t bundleRevision_destroy(bundle_revision_pt revision);
 
+/**
+ * Returns (caller owns the result) the wiring stored with bundleRevision_setCachedWiring, or NULL if there is no
+ * wiring cached for the cache key of the revision.
+ */
+celix_status_t bundleRevision_getCachedWiring(bundle_revision_pt revision, char **wiring);
+
+/**
+ * Stores the (resolver_describeWiring) wiring of the revision in the revision root. No-op if caching is disabled.
+ */
+celix_status_t bundleRevision_setCachedWiring(bundle_revision_pt revision, const char *wiring);
+
 /**
  * Retrieves the revision number of the given revision.
  *
@@ -0,0 +1,98 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *  KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#ifndef CELIX_SERVICEHANDLE_H
+#define CELIX_SERVICEHANDLE_H
+
+#include <memory>
+
+namespace celix {
+
+    template<typename I>
+    class ServiceTracker; //forward declaration
+
+    namespace detail {
+        /**
+         * A service tracked by a celix::ServiceTracker.
+         * The tracker only returns from its remove callback when no handle or range refers to the entry anymore.
+         */
+        template<typename I>
+        struct TrackedService {
+            I *svc;
+            long svcId;
+            long ranking;
+        };
+    }
+
+    /**
+     * Move-only handle to a service retained by a celix::ServiceTracker.
+     *
+     * As long as the handle holds the service, the removal of the service from the tracker will block, so the service
+     * pointer stays valid. The service is released when the handle is destroyed, reset or moved from.
+     * Handles should therefore be short lived; keep the tracker, not the handle, around.
+     */
+    template<typename I>
+    class ServiceHandle {
+    public:
+        ServiceHandle() = default;
+        ~ServiceHandle() = default;
+
+        ServiceHandle(ServiceHandle&&) noexcept = default;
+        ServiceHandle& operator=(ServiceHandle&&) noexcept = default;
+
+        ServiceHandle(const ServiceHandle&) = delete;
+        ServiceHandle& operator=(const ServiceHandle&) = delete;
+
+        /**
+         * Returns the service pointer or nullptr if the handle is empty.
+         */
+        I* get() const noexcept { return entry ? entry->svc : nullptr; }
+
+        I* operator->() const noexcept { return get(); }
+        I& operator*() const noexcept { return *get(); }
+
+        /**
+         * Whether the handle holds a service.
+         */
+        explicit operator bool() const noexcept { return entry != nullptr; }
+
+        /**
+         * Returns the service id of the service or -1 if the handle is empty.
+         */
+        long serviceId() const noexcept { return entry ? entry->svcId : -1L; }
+
+        /**
+         * Returns the service ranking of the service or 0 if the handle is empty.
+         */
+        long serviceRanking() const noexcept { return entry ? entry->ranking : 0L; }
+
+        /**
+         * Releases the service.
+         */
+        void reset() noexcept { entry.reset(); }
+    private:
+        friend class ServiceTracker<I>;
+
+        explicit ServiceHandle(std::shared_ptr<const detail::TrackedService<I>> e) noexcept : entry{std::move(e)} {}
+
+        std::shared_ptr<const detail::TrackedService<I>> entry{};
+    };
+}
+
+#endif //CELIX_SERVICEHANDLE_H
@@ -0,0 +1,266 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *  KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#ifndef CELIX_SERVICETRACKER_H
+#define CELIX_SERVICETRACKER_H
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <functional>
+#include <future>
+#include <iostream>
+#include <iterator>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "celix_bundle_context.h"
+#include "celix_constants.h"
+#include "celix_properties.h"
+#include "celix/ServiceHandle.h"
+
+namespace celix {
+
+    /**
+     * Header-only C++ service tracker.
+     *
+     * The tracker keeps an immutable, ranking ordered snapshot of the tracked services. The tracker callbacks replace
+     * the snapshot under a lock, readers only (atomically) copy the shared pointer to the current snapshot and never
+     * wait on the tracker callbacks. A snapshot and its services stay valid as long as a Range or ServiceHandle refers
+     * to it: the remove callback of the tracker blocks until the removed service is released.
+     *
+     * Ranges and handles must be released before the tracker is destroyed.
+     */
+    template<typename I>
+    class ServiceTracker {
+        using Entry = detail::TrackedService<I>;
+        using EntryPtr = std::shared_ptr<const Entry>;
+        using Snapshot = std::vector<EntryPtr>;
+    public:
+        /**
+         * Read-only range on a snapshot of the tracked services, ordered from highest to lowest ranking.
+         */
+        class Range {
+        public:
+            class iterator {
+            public:
+                using iterator_category = std::forward_iterator_tag;
+                using value_type = I*;
+                using difference_type = std::ptrdiff_t;
+                using pointer = I* const*;
+                using reference = I*;
+
+                explicit iterator(typename Snapshot::const_iterator i) : it{i} {}
+
+                I* operator*() const { return (*it)->svc; }
+                iterator& operator++() { ++it; return *this; }
+                iterator operator++(int) { iterator tmp{*this}; ++it; return tmp; }
+                bool operator==(const iterator& rhs) const { return it == rhs.it; }
+                bool operator!=(const iterator& rhs) const { return it != rhs.it; }
+            private:
+                typename Snapshot::const_iterator it;
+            };
+
+            iterator begin() const { return iterator{snapshot->cbegin()}; }
+            iterator end() const { return iterator{snapshot->cend()}; }
+            std::size_t size() const noexcept { return snapshot->size(); }
+            bool empty() const noexcept { return snapshot->empty(); }
+        private:
+            friend class ServiceTracker<I>;
+
+            explicit Range(std::shared_ptr<const Snapshot> s) : snapshot{std::move(s)} {}
+
+            std::shared_ptr<const Snapshot> snapshot;
+        };
+
+        /**
+         * Creates and opens a service tracker.
+         *
+         * @param ctx The bundle context.
+         * @param serviceName The service name to track.
+         * @param filter The optional additional LDAP filter, e.g. "(location=front)".
+         * @param versionRange The optional service version range, e.g. "[1.0.0,2)".
+         * @param serviceLanguage The optional service language, default C.
+         */
+        ServiceTracker(celix_bundle_context_t *ctx, const std::string &serviceName, const std::string &filter = {},
+                       const std::string &versionRange = {}, const std::string &serviceLanguage = {}) :
+                context{ctx} {
+            celix_service_tracking_options_t opts{};
+            opts.filter.serviceName = serviceName.c_str();
+            opts.filter.filter = filter.empty() ? nullptr : filter.c_str();
+            opts.filter.versionRange = versionRange.empty() ? nullptr : versionRange.c_str();
+            opts.filter.serviceLanguage = serviceLanguage.empty() ? nullptr : serviceLanguage.c_str();
+            opts.callbackHandle = this;
+            opts.addWithProperties = &ServiceTracker<I>::addService;
+            opts.removeWithProperties = &ServiceTracker<I>::removeService;
+            trkId = celix_bundleContext_trackServicesWithOptions(context, &opts);
+        }
+
+        ~ServiceTracker() {
+            if (trkId >= 0) {
+                celix_bundleContext_stopTracker(context, trkId);
+            }
+        }
+
+        ServiceTracker(const ServiceTracker&) = delete;
+        ServiceTracker& operator=(const ServiceTracker&) = delete;
+        ServiceTracker(ServiceTracker&&) = delete;
+        ServiceTracker& operator=(ServiceTracker&&) = delete;
+
+        /**
+         * Whether the tracker is successfully opened.
+         */
+        bool isValid() const noexcept { return trkId >= 0; }
+
+        /**
+         * Returns the tracker id (< 0 if the tracker could not be created).
+         */
+        long trackerId() const noexcept { return trkId; }
+
+        /**
+         * Returns a range on the currently tracked services.
+         */
+        Range services() const {
+            return Range{std::atomic_load(&snapshot)};
+        }
+
+        /**
+         * Returns the number of currently tracked services.
+         */
+        std::size_t size() const {
+            return std::atomic_load(&snapshot)->size();
+        }
+
+        /**
+         * Returns a handle to the highest ranking service or an empty handle if no service is tracked.
+         */
+        ServiceHandle<I> highest() const {
+            std::shared_ptr<const Snapshot> current = std::atomic_load(&snapshot);
+            return current->empty() ? ServiceHandle<I>{} : ServiceHandle<I>{current->front()};
+        }
+
+        /**
+         * Returns a handle to the service with the provided service id or an empty handle if not tracked.
+         */
+        ServiceHandle<I> get(long svcId) const {
+            std::shared_ptr<const Snapshot> current = std::atomic_load(&snapshot);
+            for (const EntryPtr &entry : *current) {
+                if (entry->svcId == svcId) {
+                    return ServiceHandle<I>{entry};
+                }
+            }
+            return ServiceHandle<I>{};
+        }
+
+        /**
+         * Calls the callback once a service is tracked: directly (on the calling thread) if a service is already
+         * tracked, otherwise from the add callback of the next tracked service (on the framework event thread, so
+         * keep it short). Callbacks still waiting when the tracker is destroyed are dropped.
+         */
+        void whenAvailable(std::function<void()> callback) {
+            {
+                std::lock_guard<std::mutex> lck{mutex};
+                if (std::atomic_load(&snapshot)->empty()) {
+                    availableCallbacks.push_back(std::move(callback));
+                    return;
+                }
+            }
+            callback();
+        }
+    private:
+        static bool higherRanking(const EntryPtr &lhs, const EntryPtr &rhs) {
+            return lhs->ranking > rhs->ranking || (lhs->ranking == rhs->ranking && lhs->svcId < rhs->svcId);
+        }
+
+        static void addService(void *handle, void *svc, const celix_properties_t *props) {
+            auto *tracker = static_cast<ServiceTracker<I>*>(handle);
+            long svcId = celix_properties_getAsLong(props, OSGI_FRAMEWORK_SERVICE_ID, -1L);
+            long ranking = celix_properties_getAsLong(props, OSGI_FRAMEWORK_SERVICE_RANKING, 0L);
+
+            //the entry signals its release, so that the remove callback can wait until the service is not used anymore
+            auto released = std::make_shared<std::promise<void>>();
+            std::future<void> releasedFuture = released->get_future();
+            EntryPtr entry{new Entry{static_cast<I*>(svc), svcId, ranking}, [released](const Entry *e) {
+                delete e;
+                released->set_value();
+            }};
+
+            std::unique_lock<std::mutex> lck{tracker->mutex};
+            std::shared_ptr<const Snapshot> current = std::atomic_load(&tracker->snapshot);
+            auto next = std::make_shared<Snapshot>();
+            next->reserve(current->size() + 1);
+            *next = *current;
+            next->insert(std::upper_bound(next->begin(), next->end(), entry, &ServiceTracker<I>::higherRanking), entry);
+            std::atomic_store(&tracker->snapshot, std::shared_ptr<const Snapshot>{std::move(next)});
+            tracker->releasedFutures[svcId] = std::move(releasedFuture);
+
+            std::vector<std::function<void()>> callbacks{};
+            std::swap(callbacks, tracker->availableCallbacks);
+            lck.unlock();
+            for (auto &cb : callbacks) {
+                cb();
+            }
+        }
+
+        static void removeService(void *handle, void */*svc*/, const celix_properties_t *props) {
+            auto *tracker = static_cast<ServiceTracker<I>*>(handle);
+            long svcId = celix_properties_getAsLong(props, OSGI_FRAMEWORK_SERVICE_ID, -1L);
+
+            std::future<void> released{};
+            {
+                std::lock_guard<std::mutex> lck{tracker->mutex};
+                std::shared_ptr<const Snapshot> current = std::atomic_load(&tracker->snapshot);
+                auto next = std::make_shared<Snapshot>();
+                next->reserve(current->size());
+                for (const EntryPtr &entry : *current) {
+                    if (entry->svcId != svcId) {
+                        next->push_back(entry);
+                    }
+                }
+                std::atomic_store(&tracker->snapshot, std::shared_ptr<const Snapshot>{std::move(next)});
+                auto it = tracker->releasedFutures.find(svcId);
+                if (it != tracker->releasedFutures.end()) {
+                    released = std::move(it->second);
+                    tracker->releasedFutures.erase(it);
+                }
+            }
+
+            //wait until the last range or handle using the removed service is gone
+            if (released.valid()) {
+                int waitCount = 0;
+                while (released.wait_for(std::chrono::seconds{5}) != std::future_status::ready) {
+                    waitCount += 5;
+                    std::cerr << "Still waiting for the release of service with id " << svcId << ". Waiting for " << waitCount << " seconds.\n";
+                }
+            }
+        }
+
+        celix_bundle_context_t * const context;
+        std::mutex mutex{}; //protects the snapshot updates, releasedFutures and availableCallbacks
+        std::map<long, std::future<void>> releasedFutures{}; //key = service id
+        std::vector<std::function<void()>> availableCallbacks{};
+        std::shared_ptr<const Snapshot> snapshot{std::make_shared<const Snapshot>()}; //note only accessed with std::atomic_load/store
+        long trkId{-1};
+    };
+}
+
+#endif //CELIX_SERVICETRACKER_H
@@ -0,0 +1,195 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *  KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#ifndef CELIX_DM_COROUTINE_H
+#define CELIX_DM_COROUTINE_H
+
+/**
+ * C++20 coroutine support for components, so that waiting for a service or an asynchronous result does not block a
+ * thread. Coroutines are resumed on an executor, normally the thread pool of the dependency manager
+ * (celix::dm::DependencyManager::executor()):
+ *
+ *     celix::dm::Task Cmp::run(celix_thread_pool_t *executor) {
+ *         auto calc = co_await celix::dm::awaitService(calcTracker, executor);
+ *         celix::Promise<double> p = startCalculation(calc.get());
+ *         auto result = co_await celix::dm::awaitPromise(p, executor);
+ *         ...
+ *     }
+ *
+ * Asynchronous APIs can be awaited by completing a celix::Promise from their completion callback, e.g. an async
+ * HTTP handler (http_admin_async_service.h) can start a Task and complete the response after its co_awaits.
+ *
+ * Only available when compiled with coroutine support (C++20), for older standards this header is empty.
+ */
+#if defined(__cpp_impl_coroutine) && __cpp_impl_coroutine >= 201902L
+
+#include <coroutine>
+#include <exception>
+#include <utility>
+
+#include "celix_thread_pool.h"
+#include "celix_promise.h"
+#include "celix/Promise.h"
+#include "celix/ServiceTracker.h"
+
+namespace celix { namespace dm {
+
+    namespace detail {
+        inline void* resumeCoroutine(void *data) {
+            std::coroutine_handle<>::from_address(data).resume();
+            return nullptr;
+        }
+
+        /**
+         * Resumes the coroutine on a worker of the executor or directly if there is no executor (or it is being
+         * destroyed).
+         */
+        inline void resumeOn(celix_thread_pool_t *executor, std::coroutine_handle<> h) {
+            if (executor == nullptr || celix_threadPool_execute(executor, resumeCoroutine, h.address(), nullptr, nullptr) != CELIX_SUCCESS) {
+                h.resume();
+            }
+        }
+    }
+
+    /**
+     * Fire-and-forget coroutine. The coroutine starts directly and its frame is destroyed when it returns.
+     * An exception escaping the coroutine terminates the program.
+     */
+    struct Task {
+        struct promise_type {
+            Task get_return_object() noexcept { return Task{}; }
+            std::suspend_never initial_suspend() noexcept { return {}; }
+            std::suspend_never final_suspend() noexcept { return {}; }
+            void return_void() noexcept {}
+            void unhandled_exception() noexcept { std::terminate(); }
+        };
+    };
+
+    /**
+     * Awaitable continuing the coroutine on a worker of the executor.
+     */
+    class ResumeOn {
+    public:
+        explicit ResumeOn(celix_thread_pool_t *e) noexcept : executor{e} {}
+
+        bool await_ready() const noexcept { return false; }
+        void await_suspend(std::coroutine_handle<> h) const { detail::resumeOn(executor, h); }
+        void await_resume() const noexcept {}
+    private:
+        celix_thread_pool_t *executor;
+    };
+
+    inline ResumeOn resumeOn(celix_thread_pool_t *executor) noexcept {
+        return ResumeOn{executor};
+    }
+
+    /**
+     * Awaitable for a service of a celix::ServiceTracker, see awaitService.
+     */
+    template<typename I>
+    class ServiceAvailable {
+    public:
+        ServiceAvailable(celix::ServiceTracker<I> &t, celix_thread_pool_t *e) noexcept : tracker{t}, executor{e} {}
+
+        bool await_ready() {
+            handle = tracker.highest();
+            return static_cast<bool>(handle);
+        }
+
+        void await_suspend(std::coroutine_handle<> h) {
+            celix_thread_pool_t *e = executor;
+            tracker.whenAvailable([e, h]{ detail::resumeOn(e, h); });
+        }
+
+        celix::ServiceHandle<I> await_resume() {
+            if (!handle) {
+                handle = tracker.highest();
+            }
+            return std::move(handle);
+        }
+    private:
+        celix::ServiceTracker<I> &tracker;
+        celix_thread_pool_t *executor;
+        celix::ServiceHandle<I> handle{};
+    };
+
+    /**
+     * Awaits until the tracker tracks a service and returns a handle to the highest ranking service.
+     * The handle is empty if the service is removed again before the coroutine is resumed.
+     * A coroutine still waiting when the tracker is destroyed is never resumed (and its frame is leaked).
+     */
+    template<typename I>
+    ServiceAvailable<I> awaitService(celix::ServiceTracker<I> &tracker, celix_thread_pool_t *executor) noexcept {
+        return ServiceAvailable<I>{tracker, executor};
+    }
+
+    template<typename T>
+    struct PromiseResult {
+        celix_status_t status;
+        T value; //only set if status is CELIX_SUCCESS
+    };
+
+    /**
+     * Awaitable for a celix::Promise, see awaitPromise.
+     */
+    template<typename T>
+    class PromiseCompleted {
+    public:
+        PromiseCompleted(celix::Promise<T> &p, celix_thread_pool_t *e) noexcept : promise{p}, executor{e} {}
+
+        bool await_ready() const { return promise.isDone(); }
+
+        bool await_suspend(std::coroutine_handle<> h) {
+            //note the continuation can resume (and finish) the coroutine before celix_promise_then returns
+            celix_promise_t *derived = celix_promise_then(promise.cPromise(), executor, &PromiseCompleted::resume, h.address(), nullptr);
+            if (derived == nullptr) {
+                return false; //no memory, continue directly and block in await_resume
+            }
+            celix_promise_release(derived);
+            return true;
+        }
+
+        PromiseResult<T> await_resume() {
+            PromiseResult<T> result{};
+            result.status = promise.get(result.value);
+            return result;
+        }
+    private:
+        static celix_status_t resume(void *data, celix_status_t status, void */*value*/, void **/*result*/) {
+            std::coroutine_handle<>::from_address(data).resume();
+            return status;
+        }
+
+        celix::Promise<T> &promise;
+        celix_thread_pool_t *executor;
+    };
+
+    /**
+     * Awaits the completion of the promise and returns its status and (copied) value. The promise must outlive the
+     * co_await, T must be default constructible.
+     */
+    template<typename T>
+    PromiseCompleted<T> awaitPromise(celix::Promise<T> &promise, celix_thread_pool_t *executor) noexcept {
+        return PromiseCompleted<T>{promise, executor};
+    }
+}}
+
+#endif //__cpp_impl_coroutine
+
+#endif //CELIX_DM_COROUTINE_H
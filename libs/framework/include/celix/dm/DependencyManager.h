@@ -24,6 +24,7 @@
 #include "bundle_context.h"
 #include "celix_bundle_context.h"
 #include "celix_dependency_manager.h"
+#include "celix_thread_pool.h"
 
 #include <vector>
 #include <mutex>
@@ -41,6 +42,9 @@ namespace celix { namespace dm {
 
         virtual ~DependencyManager() {
                 this->cDepMan = nullptr;
+                if (this->threadPool != nullptr) {
+                        celix_threadPool_destroy(this->threadPool);
+                }
         }
 
         DependencyManager(DependencyManager&& mgr) : componentsMutex{} {
@@ -49,8 +53,10 @@ namespace celix { namespace dm {
                 mgr.queuedComponents = std::move(this->queuedComponents);
                 mgr.startedComponents = std::move(this->startedComponents);
                 mgr.cDepMan = this->cDepMan;
+                mgr.threadPool = this->threadPool;
                 this->cDepMan = nullptr;
                 this->context = nullptr;
+                this->threadPool = nullptr;
         }
         DependencyManager& operator=(DependencyManager&& rhs) {
             std::lock_guard<std::recursive_mutex> lock(rhs.componentsMutex);
@@ -60,6 +66,7 @@ namespace celix { namespace dm {
             cDepMan = rhs.cDepMan;
             rhs.cDepMan = nullptr;
             rhs.context = nullptr;
+            std::swap(threadPool, rhs.threadPool);
             return *this;
         };
 
@@ -69,6 +76,21 @@ namespace celix { namespace dm {
         celix_bundle_context_t* bundleContext() const { return context; }
         celix_dependency_manager_t *cDependencyManager() const { return cDepMan; }
 
+        /**
+         * Returns the executor of the dependency manager: a thread pool (a worker per CPU) created on first use and
+         * destroyed with the dependency manager. Used to resume the coroutines of components, see
+         * celix/dm/Coroutine.h. Returns nullptr if the pool could not be created.
+         */
+        celix_thread_pool_t* executor() {
+            std::lock_guard<std::recursive_mutex> lock(componentsMutex);
+            if (threadPool == nullptr) {
+                celix_thread_pool_options_t opts{};
+                opts.name = "dm";
+                threadPool = celix_threadPool_create(&opts);
+            }
+            return threadPool;
+        }
+
 
         /**
          * Creates and adds a new DM Component for a component of type T.
@@ -155,6 +177,7 @@ namespace celix { namespace dm {
         std::vector<std::unique_ptr<BaseComponent>> queuedComponents {};
         std::vector<std::unique_ptr<BaseComponent>> startedComponents {};
         celix_dependency_manager_t* cDepMan {nullptr};
+        celix_thread_pool_t* threadPool {nullptr};
         std::recursive_mutex componentsMutex{};
     };
 
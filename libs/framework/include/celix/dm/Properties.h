@@ -22,9 +22,102 @@
 
 #include <map>
 #include <string>
+#include <cstddef>
+
+#include "celix_properties.h"
 
 namespace celix { namespace dm {
     using Properties = std::map<std::string, std::string>;
+
+    /**
+     * Non-owning, read-only view on C service properties, used as argument for service dependency callbacks.
+     * Creating a view does not allocate, so callbacks only pay for the properties they read.
+     *
+     * The view (and the returned const char*) are only valid during the callback. Use toProperties to keep a copy.
+     */
+    class PropertiesView {
+    public:
+        explicit PropertiesView(const celix_properties_t *props) noexcept : cProps{props} {}
+
+        /**
+         * Returns the value of the property or defaultValue if the property is not present.
+         */
+        const char* get(const char *key, const char *defaultValue = nullptr) const noexcept {
+            return cProps == nullptr ? defaultValue : celix_properties_get(cProps, key, defaultValue);
+        }
+        const char* get(const std::string &key, const char *defaultValue = nullptr) const noexcept {
+            return get(key.c_str(), defaultValue);
+        }
+
+        long getAsLong(const char *key, long defaultValue) const noexcept {
+            return cProps == nullptr ? defaultValue : celix_properties_getAsLong(cProps, key, defaultValue);
+        }
+        long getAsLong(const std::string &key, long defaultValue) const noexcept {
+            return getAsLong(key.c_str(), defaultValue);
+        }
+
+        double getAsDouble(const char *key, double defaultValue) const noexcept {
+            return cProps == nullptr ? defaultValue : celix_properties_getAsDouble(cProps, key, defaultValue);
+        }
+        double getAsDouble(const std::string &key, double defaultValue) const noexcept {
+            return getAsDouble(key.c_str(), defaultValue);
+        }
+
+        bool getAsBool(const char *key, bool defaultValue) const noexcept {
+            //note celix_properties_getAsBool does not modify the properties
+            return cProps == nullptr ? defaultValue : celix_properties_getAsBool((celix_properties_t*)cProps, key, defaultValue);
+        }
+        bool getAsBool(const std::string &key, bool defaultValue) const noexcept {
+            return getAsBool(key.c_str(), defaultValue);
+        }
+
+        bool has(const char *key) const noexcept {
+            return get(key) != nullptr;
+        }
+        bool has(const std::string &key) const noexcept {
+            return has(key.c_str());
+        }
+
+        std::size_t size() const noexcept {
+            return cProps == nullptr ? 0 : (std::size_t)celix_properties_size(cProps);
+        }
+
+        bool empty() const noexcept {
+            return size() == 0;
+        }
+
+        /**
+         * Calls f(const char *key, const char *value) for every property.
+         */
+        template<typename F>
+        void forEach(F&& f) const {
+            if (cProps == nullptr) {
+                return;
+            }
+            celix_properties_iterator_t iter = celix_propertiesIterator_construct(cProps);
+            while (celix_propertiesIterator_hasNext(&iter)) {
+                const char *key = celix_propertiesIterator_nextKey(&iter);
+                f(key, celix_properties_get(cProps, key, ""));
+            }
+        }
+
+        /**
+         * Returns an owning copy of the properties.
+         */
+        Properties toProperties() const {
+            Properties result{};
+            forEach([&result](const char *key, const char *value) {
+                result[key] = value; //note. C++ does not allow nullptr entries for std::string
+            });
+            return result;
+        }
+
+        const celix_properties_t* cProperties() const noexcept {
+            return cProps;
+        }
+    private:
+        const celix_properties_t *cProps;
+    };
 }}
 
 #endif //CELIX_DM_PROPERTIES_H
@@ -153,6 +153,14 @@ namespace celix { namespace dm {
          */
         CServiceDependency<T,I>& setCallbacks(void (T::*set)(const I* service, Properties&& properties));
 
+        /**
+         * Set the set callback for when the service dependency becomes available.
+         * The properties view does not copy the service properties and is only valid during the callback.
+         *
+         * @return the C service dependency reference for chaining (fluent API)
+         */
+        CServiceDependency<T,I>& setCallbacks(void (T::*set)(const I* service, const PropertiesView& properties));
+
         /**
          * Set the set callback for when the service dependency becomes available
          *
@@ -160,6 +168,14 @@ namespace celix { namespace dm {
          */
         CServiceDependency<T,I>& setCallbacks(std::function<void(const I* service, Properties&& properties)> set);
 
+        /**
+         * Set the set callback for when the service dependency becomes available.
+         * The properties view does not copy the service properties and is only valid during the callback.
+         *
+         * @return the C service dependency reference for chaining (fluent API)
+         */
+        CServiceDependency<T,I>& setCallbacks(std::function<void(const I* service, const PropertiesView& properties)> set);
+
         /**
          * Set the add and remove callback for when the services of service dependency are added or removed.
          *
@@ -177,6 +193,17 @@ namespace celix { namespace dm {
                 void (T::*remove)(const I* service, Properties&& properties)
         );
 
+        /**
+         * Set the add and remove callback for when the services of service dependency are added or removed.
+         * The properties view does not copy the service properties and is only valid during the callback.
+         *
+         * @return the C service dependency reference for chaining (fluent API)
+         */
+        CServiceDependency<T,I>& setCallbacks(
+                void (T::*add)(const I* service, const PropertiesView& properties),
+                void (T::*remove)(const I* service, const PropertiesView& properties)
+        );
+
         /**
          * Set the add and remove callback for when the services of service dependency are added or removed.
          *
@@ -187,6 +214,55 @@ namespace celix { namespace dm {
 		std::function<void(const I* service, Properties&& properties)> remove
         );
 
+        /**
+         * Set the add and remove callback for when the services of service dependency are added or removed.
+         * The properties view does not copy the service properties and is only valid during the callback.
+         *
+         * @return the C service dependency reference for chaining (fluent API)
+         */
+        CServiceDependency<T,I>& setCallbacks(
+		std::function<void(const I* service, const PropertiesView& properties)> add,
+		std::function<void(const I* service, const PropertiesView& properties)> remove
+        );
+
+        /**
+         * Set the set callback for when the service dependency becomes available.
+         * The member function is resolved at compile time, e.g. setCallbacks<&Cmp::setService>(), and called
+         * from a static C callback; no std::function is involved.
+         *
+         * @return the C service dependency reference for chaining (fluent API)
+         */
+        template<void (T::*set)(const I* service)>
+        CServiceDependency<T,I>& setCallbacks();
+
+        /**
+         * Set the set callback for when the service dependency becomes available.
+         * The member function is resolved at compile time and called from a static C callback.
+         *
+         * @return the C service dependency reference for chaining (fluent API)
+         */
+        template<void (T::*set)(const I* service, const PropertiesView& properties)>
+        CServiceDependency<T,I>& setCallbacks();
+
+        /**
+         * Set the add and remove callback for when the services of service dependency are added or removed.
+         * The member functions are resolved at compile time, e.g. setCallbacks<&Cmp::addService, &Cmp::removeService>(),
+         * and called from static C callbacks; no std::function is involved.
+         *
+         * @return the C service dependency reference for chaining (fluent API)
+         */
+        template<void (T::*add)(const I* service), void (T::*remove)(const I* service)>
+        CServiceDependency<T,I>& setCallbacks();
+
+        /**
+         * Set the add and remove callback for when the services of service dependency are added or removed.
+         * The member functions are resolved at compile time and called from static C callbacks.
+         *
+         * @return the C service dependency reference for chaining (fluent API)
+         */
+        template<void (T::*add)(const I* service, const PropertiesView& properties), void (T::*remove)(const I* service, const PropertiesView& properties)>
+        CServiceDependency<T,I>& setCallbacks();
+
         /**
          * Specify if the service dependency should add a service.lang filter part if it is not already present
          * For C service dependencies 'service.lang=C' will be added.
@@ -197,12 +273,23 @@ namespace celix { namespace dm {
         std::string filter {};
         std::string versionRange {};
 
-        std::function<void(const I* service, Properties&& properties)> setFp{nullptr};
-        std::function<void(const I* service, Properties&& properties)> addFp{nullptr};
-        std::function<void(const I* service, Properties&& properties)> removeFp{nullptr};
+        //note the callbacks get a properties view, the properties are only copied for callbacks which need a copy
+        std::function<void(const I* service, const PropertiesView& properties)> setFp{nullptr};
+        std::function<void(const I* service, const PropertiesView& properties)> addFp{nullptr};
+        std::function<void(const I* service, const PropertiesView& properties)> removeFp{nullptr};
+
+        //compile time resolved callbacks, used when the corresponding std::function is not set
+        int(*setTrampoline)(void*, void *, const celix_properties_t*) {nullptr};
+        int(*addTrampoline)(void*, void *, const celix_properties_t*) {nullptr};
+        int(*removeTrampoline)(void*, void *, const celix_properties_t*) {nullptr};
+
+        template<void (T::*fp)(const I* service)>
+        static int memberTrampoline(void* handle, void* service, const celix_properties_t* props);
+        template<void (T::*fp)(const I* service, const PropertiesView& properties)>
+        static int memberTrampolineWithProperties(void* handle, void* service, const celix_properties_t* props);
 
         void setupCallbacks();
-        int invokeCallback(std::function<void(const I*, Properties&&)> fp, const celix_properties_t *props, const void* service);
+        int invokeCallback(const std::function<void(const I*, const PropertiesView&)>& fp, const celix_properties_t *props, const void* service);
 
         void setupService();
     };
@@ -249,6 +336,14 @@ namespace celix { namespace dm {
          */
         ServiceDependency<T,I>& setCallbacks(void (T::*set)(I* service, Properties&& properties));
 
+        /**
+         * Set the set callback for when the service dependency becomes available.
+         * The properties view does not copy the service properties and is only valid during the callback.
+         *
+         * @return the C++ service dependency reference for chaining (fluent API)
+         */
+        ServiceDependency<T,I>& setCallbacks(void (T::*set)(I* service, const PropertiesView& properties));
+
         /**
          * Set the set callback for when the service dependency becomes available
          *
@@ -256,6 +351,14 @@ namespace celix { namespace dm {
          */
         ServiceDependency<T,I>& setCallbacks(std::function<void(I* service, Properties&& properties)> set);
 
+        /**
+         * Set the set callback for when the service dependency becomes available.
+         * The properties view does not copy the service properties and is only valid during the callback.
+         *
+         * @return the C++ service dependency reference for chaining (fluent API)
+         */
+        ServiceDependency<T,I>& setCallbacks(std::function<void(I* service, const PropertiesView& properties)> set);
+
         /**
          * Set the add and remove callback for when the services of service dependency are added or removed.
          *
@@ -273,6 +376,17 @@ namespace celix { namespace dm {
                 void (T::*remove)(I* service, Properties&& properties)
         );
 
+        /**
+         * Set the add and remove callback for when the services of service dependency are added or removed.
+         * The properties view does not copy the service properties and is only valid during the callback.
+         *
+         * @return the C++ service dependency reference for chaining (fluent API)
+         */
+        ServiceDependency<T,I>& setCallbacks(
+                void (T::*add)(I* service, const PropertiesView& properties),
+                void (T::*remove)(I* service, const PropertiesView& properties)
+        );
+
         /**
          * Set the add and remove callback for when the services of service dependency are added or removed.
          *
@@ -283,6 +397,55 @@ namespace celix { namespace dm {
 		std::function<void(I* service, Properties&& properties)> remove
         );
 
+        /**
+         * Set the add and remove callback for when the services of service dependency are added or removed.
+         * The properties view does not copy the service properties and is only valid during the callback.
+         *
+         * @return the C++ service dependency reference for chaining (fluent API)
+         */
+        ServiceDependency<T,I>& setCallbacks(
+		std::function<void(I* service, const PropertiesView& properties)> add,
+		std::function<void(I* service, const PropertiesView& properties)> remove
+        );
+
+        /**
+         * Set the set callback for when the service dependency becomes available.
+         * The member function is resolved at compile time, e.g. setCallbacks<&Cmp::setService>(), and called
+         * from a static C callback; no std::function is involved.
+         *
+         * @return the C++ service dependency reference for chaining (fluent API)
+         */
+        template<void (T::*set)(I* service)>
+        ServiceDependency<T,I>& setCallbacks();
+
+        /**
+         * Set the set callback for when the service dependency becomes available.
+         * The member function is resolved at compile time and called from a static C callback.
+         *
+         * @return the C++ service dependency reference for chaining (fluent API)
+         */
+        template<void (T::*set)(I* service, const PropertiesView& properties)>
+        ServiceDependency<T,I>& setCallbacks();
+
+        /**
+         * Set the add and remove callback for when the services of service dependency are added or removed.
+         * The member functions are resolved at compile time, e.g. setCallbacks<&Cmp::addService, &Cmp::removeService>(),
+         * and called from static C callbacks; no std::function is involved.
+         *
+         * @return the C++ service dependency reference for chaining (fluent API)
+         */
+        template<void (T::*add)(I* service), void (T::*remove)(I* service)>
+        ServiceDependency<T,I>& setCallbacks();
+
+        /**
+         * Set the add and remove callback for when the services of service dependency are added or removed.
+         * The member functions are resolved at compile time and called from static C callbacks.
+         *
+         * @return the C++ service dependency reference for chaining (fluent API)
+         */
+        template<void (T::*add)(I* service, const PropertiesView& properties), void (T::*remove)(I* service, const PropertiesView& properties)>
+        ServiceDependency<T,I>& setCallbacks();
+
         /**
          * Specify if the service dependency is required. Default is false
          *
@@ -310,13 +473,24 @@ namespace celix { namespace dm {
         std::string versionRange {};
         std::string modifiedFilter {};
 
-        std::function<void(I* service, Properties&& properties)> setFp{nullptr};
-        std::function<void(I* service, Properties&& properties)> addFp{nullptr};
-        std::function<void(I* service, Properties&& properties)> removeFp{nullptr};
+        //note the callbacks get a properties view, the properties are only copied for callbacks which need a copy
+        std::function<void(I* service, const PropertiesView& properties)> setFp{nullptr};
+        std::function<void(I* service, const PropertiesView& properties)> addFp{nullptr};
+        std::function<void(I* service, const PropertiesView& properties)> removeFp{nullptr};
+
+        //compile time resolved callbacks, used when the corresponding std::function is not set
+        int(*setTrampoline)(void*, void *, const celix_properties_t*) {nullptr};
+        int(*addTrampoline)(void*, void *, const celix_properties_t*) {nullptr};
+        int(*removeTrampoline)(void*, void *, const celix_properties_t*) {nullptr};
+
+        template<void (T::*fp)(I* service)>
+        static int memberTrampoline(void* handle, void* service, const celix_properties_t* props);
+        template<void (T::*fp)(I* service, const PropertiesView& properties)>
+        static int memberTrampolineWithProperties(void* handle, void* service, const celix_properties_t* props);
 
         void setupService();
         void setupCallbacks();
-        int invokeCallback(std::function<void(I*, Properties&&)> fp, const celix_properties_t *props, const void* service);
+        int invokeCallback(const std::function<void(I*, const PropertiesView&)>& fp, const celix_properties_t *props, const void* service);
     };
 }}
 
@@ -86,7 +86,7 @@ CServiceDependency<T,I>& CServiceDependency<T,I>::setStrategy(DependencyUpdateSt
 //set callbacks
 template<class T, typename I>
 CServiceDependency<T,I>& CServiceDependency<T,I>::setCallbacks(void (T::*set)(const I* service)) {
-    this->setCallbacks([this, set](const I* service, [[gnu::unused]] Properties&& properties) {
+    this->setCallbacks([this, set](const I* service, [[gnu::unused]] const PropertiesView& properties) {
         T *cmp = this->componentInstance;
         (cmp->*set)(service);
     });
@@ -95,16 +95,37 @@ CServiceDependency<T,I>& CServiceDependency<T,I>::setCallbacks(void (T::*set)(co
 
 template<class T, typename I>
 CServiceDependency<T,I>& CServiceDependency<T,I>::setCallbacks(void (T::*set)(const I* service, Properties&& properties)) {
-    this->setCallbacks([this, set](const I* service, Properties&& properties) {
+    this->setCallbacks([this, set](const I* service, const PropertiesView& properties) {
         T *cmp = this->componentInstance;
-        (cmp->*set)(service, std::move(properties));
+        (cmp->*set)(service, properties.toProperties());
+    });
+    return *this;
+}
+
+template<class T, typename I>
+CServiceDependency<T,I>& CServiceDependency<T,I>::setCallbacks(void (T::*set)(const I* service, const PropertiesView& properties)) {
+    this->setCallbacks([this, set](const I* service, const PropertiesView& properties) {
+        T *cmp = this->componentInstance;
+        (cmp->*set)(service, properties);
     });
     return *this;
 }
 
 template<class T, typename I>
 CServiceDependency<T,I>& CServiceDependency<T,I>::setCallbacks(std::function<void(const I* service, Properties&& properties)> set) {
+    std::function<void(const I* service, const PropertiesView& properties)> setView{nullptr};
+    if (set) {
+        setView = [set](const I* service, const PropertiesView& properties) {
+            set(service, properties.toProperties());
+        };
+    }
+    return this->setCallbacks(setView);
+}
+
+template<class T, typename I>
+CServiceDependency<T,I>& CServiceDependency<T,I>::setCallbacks(std::function<void(const I* service, const PropertiesView& properties)> set) {
     this->setFp = set;
+    this->setTrampoline = nullptr;
     this->setupCallbacks();
     return *this;
 }
@@ -115,11 +136,11 @@ CServiceDependency<T,I>& CServiceDependency<T,I>::setCallbacks(
         void (T::*add)(const I* service),
         void (T::*remove)(const I* service)) {
     this->setCallbacks(
-		    [this, add](const I* service, [[gnu::unused]] Properties&& properties) {
+		    [this, add](const I* service, [[gnu::unused]] const PropertiesView& properties) {
 			    T *cmp = this->componentInstance;
 			    (cmp->*add)(service);
 		    },
-		    [this, remove](const I* service, [[gnu::unused]] Properties&& properties) {
+		    [this, remove](const I* service, [[gnu::unused]] const PropertiesView& properties) {
 			    T *cmp = this->componentInstance;
 			    (cmp->*remove)(service);
 		    }
@@ -133,13 +154,31 @@ CServiceDependency<T,I>& CServiceDependency<T,I>::setCallbacks(
         void (T::*remove)(const I* service, Properties&& properties)
 ) {
     this->setCallbacks(
-		    [this, add](const I* service, Properties&& properties) {
+		    [this, add](const I* service, const PropertiesView& properties) {
 			    T *cmp = this->componentInstance;
-			    (cmp->*add)(service, std::move(properties));
+			    (cmp->*add)(service, properties.toProperties());
 		    },
-		    [this, remove](const I* service, Properties&& properties) {
+		    [this, remove](const I* service, const PropertiesView& properties) {
 			    T *cmp = this->componentInstance;
-			    (cmp->*remove)(service, std::move(properties));
+			    (cmp->*remove)(service, properties.toProperties());
+		    }
+    );
+    return *this;
+}
+
+template<class T, typename I>
+CServiceDependency<T,I>& CServiceDependency<T,I>::setCallbacks(
+        void (T::*add)(const I* service, const PropertiesView& properties),
+        void (T::*remove)(const I* service, const PropertiesView& properties)
+) {
+    this->setCallbacks(
+		    [this, add](const I* service, const PropertiesView& properties) {
+			    T *cmp = this->componentInstance;
+			    (cmp->*add)(service, properties);
+		    },
+		    [this, remove](const I* service, const PropertiesView& properties) {
+			    T *cmp = this->componentInstance;
+			    (cmp->*remove)(service, properties);
 		    }
     );
     return *this;
@@ -147,8 +186,86 @@ CServiceDependency<T,I>& CServiceDependency<T,I>::setCallbacks(
 
 template<class T, typename I>
 CServiceDependency<T,I>& CServiceDependency<T,I>::setCallbacks(std::function<void(const I* service, Properties&& properties)> add, std::function<void(const I* service, Properties&& properties)> remove) {
-    this->addFp = add;;
+    std::function<void(const I* service, const PropertiesView& properties)> addView{nullptr};
+    std::function<void(const I* service, const PropertiesView& properties)> removeView{nullptr};
+    if (add) {
+        addView = [add](const I* service, const PropertiesView& properties) {
+            add(service, properties.toProperties());
+        };
+    }
+    if (remove) {
+        removeView = [remove](const I* service, const PropertiesView& properties) {
+            remove(service, properties.toProperties());
+        };
+    }
+    return this->setCallbacks(addView, removeView);
+}
+
+template<class T, typename I>
+CServiceDependency<T,I>& CServiceDependency<T,I>::setCallbacks(std::function<void(const I* service, const PropertiesView& properties)> add, std::function<void(const I* service, const PropertiesView& properties)> remove) {
+    this->addFp = add;
     this->removeFp = remove;
+    this->addTrampoline = nullptr;
+    this->removeTrampoline = nullptr;
+    this->setupCallbacks();
+    return *this;
+}
+
+//compile time resolved callbacks
+template<class T, typename I>
+template<void (T::*fp)(const I* service)>
+int CServiceDependency<T,I>::memberTrampoline(void* handle, void* service, const celix_properties_t* /*props*/) {
+    auto dep = (CServiceDependency<T,I>*) handle;
+    T *cmp = dep->componentInstance;
+    (cmp->*fp)((const I*) service);
+    return 0;
+}
+
+template<class T, typename I>
+template<void (T::*fp)(const I* service, const PropertiesView& properties)>
+int CServiceDependency<T,I>::memberTrampolineWithProperties(void* handle, void* service, const celix_properties_t* props) {
+    auto dep = (CServiceDependency<T,I>*) handle;
+    T *cmp = dep->componentInstance;
+    (cmp->*fp)((const I*) service, PropertiesView{props});
+    return 0;
+}
+
+template<class T, typename I>
+template<void (T::*set)(const I* service)>
+CServiceDependency<T,I>& CServiceDependency<T,I>::setCallbacks() {
+    this->setFp = nullptr;
+    this->setTrampoline = &CServiceDependency<T,I>::memberTrampoline<set>;
+    this->setupCallbacks();
+    return *this;
+}
+
+template<class T, typename I>
+template<void (T::*set)(const I* service, const PropertiesView& properties)>
+CServiceDependency<T,I>& CServiceDependency<T,I>::setCallbacks() {
+    this->setFp = nullptr;
+    this->setTrampoline = &CServiceDependency<T,I>::memberTrampolineWithProperties<set>;
+    this->setupCallbacks();
+    return *this;
+}
+
+template<class T, typename I>
+template<void (T::*add)(const I* service), void (T::*remove)(const I* service)>
+CServiceDependency<T,I>& CServiceDependency<T,I>::setCallbacks() {
+    this->addFp = nullptr;
+    this->removeFp = nullptr;
+    this->addTrampoline = &CServiceDependency<T,I>::memberTrampoline<add>;
+    this->removeTrampoline = &CServiceDependency<T,I>::memberTrampoline<remove>;
+    this->setupCallbacks();
+    return *this;
+}
+
+template<class T, typename I>
+template<void (T::*add)(const I* service, const PropertiesView& properties), void (T::*remove)(const I* service, const PropertiesView& properties)>
+CServiceDependency<T,I>& CServiceDependency<T,I>::setCallbacks() {
+    this->addFp = nullptr;
+    this->removeFp = nullptr;
+    this->addTrampoline = &CServiceDependency<T,I>::memberTrampolineWithProperties<add>;
+    this->removeTrampoline = &CServiceDependency<T,I>::memberTrampolineWithProperties<remove>;
     this->setupCallbacks();
     return *this;
 }
@@ -160,9 +277,9 @@ void CServiceDependency<T,I>::setupCallbacks() {
         return;
     }
 
-    int(*cset)(void*, void *, const celix_properties_t*) {nullptr};
-    int(*cadd)(void*, void *, const celix_properties_t*) {nullptr};
-    int(*crem)(void*, void *, const celix_properties_t*) {nullptr};
+    int(*cset)(void*, void *, const celix_properties_t*) {setTrampoline};
+    int(*cadd)(void*, void *, const celix_properties_t*) {addTrampoline};
+    int(*crem)(void*, void *, const celix_properties_t*) {removeTrampoline};
 
     if (setFp != nullptr) {
         cset = [](void* handle, void *service, const celix_properties_t *props) -> int {
@@ -192,24 +309,11 @@ void CServiceDependency<T,I>::setupCallbacks() {
 }
 
 template<class T, typename I>
-int CServiceDependency<T,I>::invokeCallback(std::function<void(const I*, Properties&&)> fp, const celix_properties_t *props, const void* service) {
-    Properties properties {};
-    const char* key {nullptr};
-    const char* value {nullptr};
-
-    if (props != nullptr) {
-        hash_map_iterator_t iter = hashMapIterator_construct((hash_map_pt)props);
-        while(hashMapIterator_hasNext(&iter)) {
-            key = (const char*) hashMapIterator_nextKey(&iter);
-            value = celix_properties_get(props, key, ""); //note. C++ does not allow nullptr entries for std::string
-            //std::cout << "got property " << key << "=" << value << "\n";
-            properties[key] = value;
-        }
-    }
-
+int CServiceDependency<T,I>::invokeCallback(const std::function<void(const I*, const PropertiesView&)>& fp, const celix_properties_t *props, const void* service) {
     const I* srv = (const I*) service;
+    PropertiesView properties{props}; //note no copy, callbacks needing a Properties copy convert themselves
 
-    fp(srv, std::move(properties));
+    fp(srv, properties);
     return 0;
 }
 
@@ -307,7 +411,7 @@ ServiceDependency<T,I>& ServiceDependency<T,I>::setAddLanguageFilter(bool addLan
 //set callbacks
 template<class T, class I>
 ServiceDependency<T,I>& ServiceDependency<T,I>::setCallbacks(void (T::*set)(I* service)) {
-    this->setCallbacks([this, set](I* srv, [[gnu::unused]] Properties&& props) {
+    this->setCallbacks([this, set](I* srv, [[gnu::unused]] const PropertiesView& props) {
         T *cmp = this->componentInstance;
         (cmp->*set)(srv);
     });
@@ -316,16 +420,37 @@ ServiceDependency<T,I>& ServiceDependency<T,I>::setCallbacks(void (T::*set)(I* s
 
 template<class T, class I>
 ServiceDependency<T,I>& ServiceDependency<T,I>::setCallbacks(void (T::*set)(I* service, Properties&& properties)) {
-    this->setCallbacks([this, set](I* srv, Properties&& props) {
+    this->setCallbacks([this, set](I* srv, const PropertiesView& props) {
         T *cmp = this->componentInstance;
-        (cmp->*set)(srv, std::move(props));
+        (cmp->*set)(srv, props.toProperties());
+    });
+    return *this;
+}
+
+template<class T, class I>
+ServiceDependency<T,I>& ServiceDependency<T,I>::setCallbacks(void (T::*set)(I* service, const PropertiesView& properties)) {
+    this->setCallbacks([this, set](I* srv, const PropertiesView& props) {
+        T *cmp = this->componentInstance;
+        (cmp->*set)(srv, props);
     });
     return *this;
 }
 
 template<class T, class I>
 ServiceDependency<T,I>& ServiceDependency<T,I>::setCallbacks(std::function<void(I* service, Properties&& properties)> set) {
+    std::function<void(I* service, const PropertiesView& properties)> setView{nullptr};
+    if (set) {
+        setView = [set](I* srv, const PropertiesView& props) {
+            set(srv, props.toProperties());
+        };
+    }
+    return this->setCallbacks(setView);
+}
+
+template<class T, class I>
+ServiceDependency<T,I>& ServiceDependency<T,I>::setCallbacks(std::function<void(I* service, const PropertiesView& properties)> set) {
     this->setFp = set;
+    this->setTrampoline = nullptr;
     this->setupCallbacks();
     return *this;
 }
@@ -336,11 +461,11 @@ ServiceDependency<T,I>& ServiceDependency<T,I>::setCallbacks(
         void (T::*add)(I* service),
         void (T::*remove)(I* service)) {
     this->setCallbacks(
-	    [this, add](I* srv, [[gnu::unused]] Properties&& props) {
+	    [this, add](I* srv, [[gnu::unused]] const PropertiesView& props) {
         	T *cmp = this->componentInstance;
         	(cmp->*add)(srv);
     	    },
-	    [this, remove](I* srv, [[gnu::unused]] Properties&& props) {
+	    [this, remove](I* srv, [[gnu::unused]] const PropertiesView& props) {
         	T *cmp = this->componentInstance;
         	(cmp->*remove)(srv);
     	    }
@@ -354,13 +479,31 @@ ServiceDependency<T,I>& ServiceDependency<T,I>::setCallbacks(
         void (T::*remove)(I* service, Properties&& properties)
         ) {
     this->setCallbacks(
-	    [this, add](I* srv, Properties&& props) {
+	    [this, add](I* srv, const PropertiesView& props) {
         	T *cmp = this->componentInstance;
-        	(cmp->*add)(srv, std::move(props));
+        	(cmp->*add)(srv, props.toProperties());
     	    },
-	    [this, remove](I* srv, Properties&& props) {
+	    [this, remove](I* srv, const PropertiesView& props) {
         	T *cmp = this->componentInstance;
-        	(cmp->*remove)(srv, std::move(props));
+        	(cmp->*remove)(srv, props.toProperties());
+    	    }
+    );
+    return *this;
+}
+
+template<class T, class I>
+ServiceDependency<T,I>& ServiceDependency<T,I>::setCallbacks(
+        void (T::*add)(I* service, const PropertiesView& properties),
+        void (T::*remove)(I* service, const PropertiesView& properties)
+        ) {
+    this->setCallbacks(
+	    [this, add](I* srv, const PropertiesView& props) {
+        	T *cmp = this->componentInstance;
+        	(cmp->*add)(srv, props);
+    	    },
+	    [this, remove](I* srv, const PropertiesView& props) {
+        	T *cmp = this->componentInstance;
+        	(cmp->*remove)(srv, props);
     	    }
     );
     return *this;
@@ -370,8 +513,88 @@ template<class T, class I>
 ServiceDependency<T,I>& ServiceDependency<T,I>::setCallbacks(
 		std::function<void(I* service, Properties&& properties)> add,
 		std::function<void(I* service, Properties&& properties)> remove) {
+    std::function<void(I* service, const PropertiesView& properties)> addView{nullptr};
+    std::function<void(I* service, const PropertiesView& properties)> removeView{nullptr};
+    if (add) {
+        addView = [add](I* srv, const PropertiesView& props) {
+            add(srv, props.toProperties());
+        };
+    }
+    if (remove) {
+        removeView = [remove](I* srv, const PropertiesView& props) {
+            remove(srv, props.toProperties());
+        };
+    }
+    return this->setCallbacks(addView, removeView);
+}
+
+template<class T, class I>
+ServiceDependency<T,I>& ServiceDependency<T,I>::setCallbacks(
+		std::function<void(I* service, const PropertiesView& properties)> add,
+		std::function<void(I* service, const PropertiesView& properties)> remove) {
     this->addFp = add;
     this->removeFp = remove;
+    this->addTrampoline = nullptr;
+    this->removeTrampoline = nullptr;
+    this->setupCallbacks();
+    return *this;
+}
+
+//compile time resolved callbacks
+template<class T, class I>
+template<void (T::*fp)(I* service)>
+int ServiceDependency<T,I>::memberTrampoline(void* handle, void* service, const celix_properties_t* /*props*/) {
+    auto dep = (ServiceDependency<T,I>*) handle;
+    T *cmp = dep->componentInstance;
+    (cmp->*fp)((I*) service);
+    return 0;
+}
+
+template<class T, class I>
+template<void (T::*fp)(I* service, const PropertiesView& properties)>
+int ServiceDependency<T,I>::memberTrampolineWithProperties(void* handle, void* service, const celix_properties_t* props) {
+    auto dep = (ServiceDependency<T,I>*) handle;
+    T *cmp = dep->componentInstance;
+    (cmp->*fp)((I*) service, PropertiesView{props});
+    return 0;
+}
+
+template<class T, class I>
+template<void (T::*set)(I* service)>
+ServiceDependency<T,I>& ServiceDependency<T,I>::setCallbacks() {
+    this->setFp = nullptr;
+    this->setTrampoline = &ServiceDependency<T,I>::memberTrampoline<set>;
+    this->setupCallbacks();
+    return *this;
+}
+
+template<class T, class I>
+template<void (T::*set)(I* service, const PropertiesView& properties)>
+ServiceDependency<T,I>& ServiceDependency<T,I>::setCallbacks() {
+    this->setFp = nullptr;
+    this->setTrampoline = &ServiceDependency<T,I>::memberTrampolineWithProperties<set>;
+    this->setupCallbacks();
+    return *this;
+}
+
+template<class T, class I>
+template<void (T::*add)(I* service), void (T::*remove)(I* service)>
+ServiceDependency<T,I>& ServiceDependency<T,I>::setCallbacks() {
+    this->addFp = nullptr;
+    this->removeFp = nullptr;
+    this->addTrampoline = &ServiceDependency<T,I>::memberTrampoline<add>;
+    this->removeTrampoline = &ServiceDependency<T,I>::memberTrampoline<remove>;
+    this->setupCallbacks();
+    return *this;
+}
+
+template<class T, class I>
+template<void (T::*add)(I* service, const PropertiesView& properties), void (T::*remove)(I* service, const PropertiesView& properties)>
+ServiceDependency<T,I>& ServiceDependency<T,I>::setCallbacks() {
+    this->addFp = nullptr;
+    this->removeFp = nullptr;
+    this->addTrampoline = &ServiceDependency<T,I>::memberTrampolineWithProperties<add>;
+    this->removeTrampoline = &ServiceDependency<T,I>::memberTrampolineWithProperties<remove>;
     this->setupCallbacks();
     return *this;
 }
@@ -389,24 +612,11 @@ ServiceDependency<T,I>& ServiceDependency<T,I>::setStrategy(DependencyUpdateStra
 };
 
 template<class T, class I>
-int ServiceDependency<T,I>::invokeCallback(std::function<void(I*, Properties&&)> fp, const celix_properties_t *props, const void* service) {
+int ServiceDependency<T,I>::invokeCallback(const std::function<void(I*, const PropertiesView&)>& fp, const celix_properties_t *props, const void* service) {
     I *svc = (I*)service;
+    PropertiesView properties{props}; //note no copy, callbacks needing a Properties copy convert themselves
 
-    Properties properties {};
-    const char* key {nullptr};
-    const char* value {nullptr};
-
-	if (props != nullptr) {
-            hash_map_iterator_t iter = hashMapIterator_construct((hash_map_pt)props);
-            while(hashMapIterator_hasNext(&iter)) {
-                key = (const char*) hashMapIterator_nextKey(&iter);
-                value = celix_properties_get(props, key, "");
-                //std::cout << "got property " << key << "=" << value << "\n";
-                properties[key] = value;
-            }
-	}
-
-    fp(svc, std::move(properties)); //explicit move of lvalue properties.
+    fp(svc, properties);
     return 0;
 }
 
@@ -416,9 +626,9 @@ void ServiceDependency<T,I>::setupCallbacks() {
         return;
     }
 
-    int(*cset)(void*, void *, const celix_properties_t*) {nullptr};
-    int(*cadd)(void*, void *, const celix_properties_t*) {nullptr};
-    int(*crem)(void*, void *, const celix_properties_t*) {nullptr};
+    int(*cset)(void*, void *, const celix_properties_t*) {setTrampoline};
+    int(*cadd)(void*, void *, const celix_properties_t*) {addTrampoline};
+    int(*crem)(void*, void *, const celix_properties_t*) {removeTrampoline};
 
     if (setFp != nullptr) {
         cset = [](void* handle, void *service, const celix_properties_t* props) -> int {
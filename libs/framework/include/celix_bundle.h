@@ -17,7 +17,10 @@
  * under the License.
  */
 
+#include <stddef.h>
+
 #include "celix_types.h"
+#include "celix_errno.h"
 #include "bundle_state.h"
 
 #ifndef CELIX_BUNDLE_H_
@@ -54,6 +57,29 @@ celix_bundle_state_e celix_bundle_getState(const celix_bundle_t *bnd);
  */
 char* celix_bundle_getEntry(const celix_bundle_t* bnd, const char *path);
 
+/**
+ * Maps a bundle resource read-only in memory, instead of reading it with fopen/fread on the path returned by
+ * celix_bundle_getEntry.
+ *
+ * The resource is mapped from the extracted bundle (in the bundle cache or the bundle image directory), so the pages
+ * are loaded lazily and shared with other processes using the same bundle cache/image. An empty resource results in
+ * a NULL data pointer and a length of 0.
+ *
+ * The mapping must be released with celix_bundle_unmapEntry.
+ * @param bnd The bundle
+ * @param path The relative path to a bundle resource
+ * @param data The mapped resource.
+ * @param length The length of the mapped resource.
+ * @return CELIX_SUCCESS, CELIX_ILLEGAL_ARGUMENT if the entry is not found or CELIX_FILE_IO_EXCEPTION if the entry
+ * cannot be mapped.
+ */
+celix_status_t celix_bundle_mapEntry(const celix_bundle_t* bnd, const char *path, const void **data, size_t *length);
+
+/**
+ * Releases a mapping created with celix_bundle_mapEntry.
+ */
+void celix_bundle_unmapEntry(const void *data, size_t length);
+
 const char* celix_bundle_getGroup(const celix_bundle_t *bnd);
 
 const char* celix_bundle_getSymbolicName(const celix_bundle_t *bnd);
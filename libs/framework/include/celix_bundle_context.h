@@ -162,6 +162,34 @@ long celix_bundleContext_registerServiceWithOptions(celix_bundle_context_t *ctx,
  */
 void celix_bundleContext_unregisterService(celix_bundle_context_t *ctx, long serviceId);
 
+/**
+ * Register multiple services to the Celix framework using the provided array of service registration options.
+ * The services are added to the service registry in a single pass and the REGISTERED service events are delivered
+ * as one batch, which is considerable cheaper than registering the services one by one.
+ *
+ * Listener hook services are registered using the single service registration.
+ *
+ * @param ctx The bundle context
+ * @param opts The array of registration options. The options are only in the during registration call.
+ * @param nrOfServices The number of registration options.
+ * @param serviceIds Output array (size nrOfServices) for the service ids. Failed registrations result in a service id < 0.
+ * @return The number of successfully registered services.
+ */
+size_t celix_bundleContext_registerServices(celix_bundle_context_t *ctx, const celix_service_registration_options_t *opts, size_t nrOfServices, long *serviceIds);
+
+/**
+ * Unregister multiple services or service factories with the provided service ids.
+ * The services are removed from the service registry in a single pass and the UNREGISTERING service events are
+ * delivered as one batch.
+ *
+ * Will log an error if a service id is unknown. Will silently ignore services ids < 0.
+ *
+ * @param ctx The bundle context
+ * @param serviceIds The array of service ids
+ * @param nrOfServices The number of service ids
+ */
+void celix_bundleContext_unregisterServices(celix_bundle_context_t *ctx, const long *serviceIds, size_t nrOfServices);
+
 
 
 
@@ -574,6 +602,70 @@ void celix_bundleContext_useServicesWithOptions(
         const celix_service_use_options_t *opts);
 
 
+/**
+ * Creates a service handle for the provided service filter options.
+ *
+ * A service handle keeps tracking the services conform the service filter options, so that the services can be used
+ * repeatedly (e.g. from a control loop) without the overhead of a service tracker creation per call as done by
+ * celix_bundleContext_useServiceWithOptions and celix_bundleContext_useServicesWithOptions.
+ *
+ * The service handle should be destroyed - using celix_serviceHandle_destroy - before the bundle of the bundle context
+ * is stopped.
+ *
+ * @param   ctx The bundle context.
+ * @param   opts The required options. Note that the serviceName is required.
+ * @return  The service handle or NULL if the handle could not be created.
+ */
+celix_service_handle_t* celix_bundleContext_createServiceHandle(
+        celix_bundle_context_t *ctx,
+        const celix_service_filter_options_t *opts);
+
+/**
+ * Destroys the service handle. Will block till all use calls on the service handle are finished.
+ */
+void celix_serviceHandle_destroy(celix_service_handle_t *handle);
+
+/**
+ * Use the highest ranking service tracked by the service handle using the provided callback.
+ * The Celix framework will ensure that the targeted service cannot be removed during the callback.
+ *
+ * @param   handle The service handle.
+ * @param   callbackHandle The data pointer, which will be used in the callback.
+ * @param   use The callback, which will be called when a service is found.
+ * @return  True if a service was found.
+ */
+bool celix_serviceHandle_use(celix_service_handle_t *handle, void *callbackHandle, void (*use)(void *handle, void *svc));
+
+/**
+ * Use the highest ranking service tracked by the service handle using the callbacks of the provided use options.
+ * The filter options of the use options are ignored, the filter options of the service handle are used.
+ *
+ * @param   handle The service handle.
+ * @param   opts The use options.
+ * @return  True if a service was found.
+ */
+bool celix_serviceHandle_useWithOptions(celix_service_handle_t *handle, const celix_service_use_options_t *opts);
+
+/**
+ * Use all the services tracked by the service handle using the provided callback.
+ * The Celix framework will ensure that the targeted services cannot be removed during the callback.
+ *
+ * @param   handle The service handle.
+ * @param   callbackHandle The data pointer, which will be used in the callback.
+ * @param   use The callback, which will be called for every service found.
+ */
+void celix_serviceHandle_useServices(celix_service_handle_t *handle, void *callbackHandle, void (*use)(void *handle, void *svc));
+
+/**
+ * Use all the services tracked by the service handle using the callbacks of the provided use options.
+ * The filter options and waitTimeoutInSeconds of the use options are ignored.
+ *
+ * @param   handle The service handle.
+ * @param   opts The use options.
+ */
+void celix_serviceHandle_useServicesWithOptions(celix_service_handle_t *handle, const celix_service_use_options_t *opts);
+
+
 
 
 /**
@@ -67,6 +67,13 @@ static const char *const OSGI_FRAMEWORK_BUNDLE_VERSION = "Bundle-Version";
 static const char *const OSGI_FRAMEWORK_PRIVATE_LIBRARY = "Private-Library";
 static const char *const OSGI_FRAMEWORK_EXPORT_LIBRARY = "Export-Library";
 static const char *const OSGI_FRAMEWORK_IMPORT_LIBRARY = "Import-Library";
+static const char *const OSGI_FRAMEWORK_BUNDLE_ACTIVATION_POLICY = "Bundle-ActivationPolicy";
+static const char *const OSGI_FRAMEWORK_BUNDLE_ACTIVATION_POLICY_LAZY = "lazy";
+/**
+ * Comma separated list of the service names a lazy bundle provides.
+ * A lazy bundle is loaded and activated when the first service listener/tracker for one of these services is added.
+ */
+static const char *const CELIX_FRAMEWORK_BUNDLE_LAZY_SERVICES = "Celix-Lazy-Services";
 
 static const char *const OSGI_FRAMEWORK_FRAMEWORK_STORAGE = "org.osgi.framework.storage";
 static const char *const OSGI_FRAMEWORK_STORAGE_USE_TMP_DIR = "org.osgi.framework.storage.use.tmp.dir";
@@ -79,6 +86,110 @@ static const char *const CELIX_BUNDLES_PATH_DEFAULT = "bundles";
 
 static const char *const CELIX_LOAD_BUNDLES_WITH_NODELETE = "CELIX_LOAD_BUNDLES_WITH_NODELETE";
 
+/**
+ * If true, bundle libraries are loaded with immediate binding (RTLD_NOW) instead of lazy binding (RTLD_LAZY).
+ * Immediate binding reports unresolved symbols at install time, but processes all relocations at load.
+ * Default is false.
+ */
+static const char *const CELIX_LOAD_BUNDLES_WITH_IMMEDIATE_BINDING = "CELIX_LOAD_BUNDLES_WITH_IMMEDIATE_BINDING";
+
+/**
+ * Comma separated list of shared libraries (e.g. "libstdc++.so.6,libjansson.so.4") loaded once, with global symbol
+ * visibility, when the framework is created and kept loaded till the framework is destroyed.
+ * Common dependencies of bundle libraries are then loaded and relocated once, and not again every time the last
+ * bundle using them is unloaded and a new one is loaded.
+ */
+static const char *const CELIX_PRELOAD_LIBRARIES_NAME = "CELIX_PRELOAD_LIBRARIES";
+
+/**
+ * If set, a host wide directory used as shared, read-only and content addressed store for bundle libraries.
+ * Before a bundle library is loaded it is published in the store (if not already present) and the store copy is
+ * loaded instead of the copy extracted in the bundle cache. Frameworks (processes) using the same store then load
+ * the same file for identical bundle libraries, so the text pages are shared in physical memory.
+ * The directory is created if it does not exist, the parent directory must exist and be writable.
+ */
+static const char *const CELIX_SHARED_LIBRARY_STORE_NAME = "CELIX_SHARED_LIBRARY_STORE";
+
+/**
+ * Comma separated list of service properties for which the service registry keeps an index (e.g. "service.id,topic").
+ * The objectClass property is always indexed.
+ */
+static const char *const CELIX_SERVICE_REGISTRY_INDEXED_PROPERTIES_NAME = "CELIX_SERVICE_REGISTRY_INDEXED_PROPERTIES";
+static const char *const CELIX_SERVICE_REGISTRY_INDEXED_PROPERTIES_DEFAULT = "service.id";
+
+/**
+ * If "true" service events are delivered asynchronously by a executor thread per bundle (of the service listener)
+ * instead of on the thread registering/unregistering the service. Unregistering events are still waited for, so that
+ * a service is not used anymore after it is unregistered.
+ * Default is "false".
+ */
+static const char *const CELIX_FRAMEWORK_SERVICE_EVENTS_ASYNC_NAME = "CELIX_FRAMEWORK_SERVICE_EVENTS_ASYNC";
+static const char *const CELIX_FRAMEWORK_SERVICE_EVENTS_ASYNC_DEFAULT = "false";
+
+/**
+ * Number of threads used to extract the bundles of a CELIX_AUTO_START_x list into the bundle cache.
+ * With more than 1 thread the bundles of a run level are extracted concurrently, after which they are installed and
+ * started in the configured order. Default is 1 (extract one after another).
+ */
+static const char *const CELIX_AUTO_START_INSTALL_THREADS_NAME = "CELIX_AUTO_START_INSTALL_THREADS";
+static const char *const CELIX_AUTO_START_INSTALL_THREADS_DEFAULT = "1";
+
+/**
+ * Number of threads used by celix_dependencyManager_addComponents to start independent dependency manager components.
+ * Default is 1 (start the components one after another on the calling thread).
+ */
+static const char *const CELIX_DM_COMPONENT_START_THREADS_NAME = "CELIX_DM_COMPONENT_START_THREADS";
+static const long CELIX_DM_COMPONENT_START_THREADS_DEFAULT = 1;
+
+/**
+ * Number of threads used to stop bundles when the framework shuts down.
+ * Bundles are stopped in waves: a wave contains the bundles whose services are not used by other (not yet stopped)
+ * bundles. With more than 1 thread the bundles of a wave are stopped concurrently.
+ * Default is 1 (stop the bundles one after another, latest installed first within a wave).
+ */
+static const char *const CELIX_FRAMEWORK_SHUTDOWN_THREADS_NAME = "CELIX_FRAMEWORK_SHUTDOWN_THREADS";
+static const long CELIX_FRAMEWORK_SHUTDOWN_THREADS_DEFAULT = 1;
+
+/**
+ * Number of worker threads of the framework scheduler (see celix_scheduler_service.h), which call the scheduled
+ * callbacks of all bundles. The scheduler threads are only created when the first event is scheduled.
+ * Default is 2.
+ */
+static const char *const CELIX_SCHEDULER_THREADS_NAME = "CELIX_SCHEDULER_THREADS";
+static const long CELIX_SCHEDULER_THREADS_DEFAULT = 2;
+
+/**
+ * Resolution in seconds of the framework scheduler. Deadlines are rounded up to a tick, so that events due within
+ * the same tick are handled in a single wakeup; a larger tick gives fewer wakeups.
+ * Default is 0.01 (10ms).
+ */
+static const char *const CELIX_SCHEDULER_TICK_NAME = "CELIX_SCHEDULER_TICK";
+static const double CELIX_SCHEDULER_TICK_DEFAULT = 0.01;
+
+/**
+ * Max time in seconds the framework shutdown waits for a single bundle to stop, before continuing with the next
+ * bundles. A bundle which did not stop in time is logged and still waited for before the framework bundle is stopped.
+ * Default is 0 (no timeout).
+ */
+static const char *const CELIX_FRAMEWORK_SHUTDOWN_BUNDLE_TIMEOUT_NAME = "CELIX_FRAMEWORK_SHUTDOWN_BUNDLE_TIMEOUT";
+static const double CELIX_FRAMEWORK_SHUTDOWN_BUNDLE_TIMEOUT_DEFAULT = 0.0;
+
+/**
+ * If set, the framework records the duration of bundle installs, library loads, bundle activator calls and
+ * dependency manager component state transitions and writes them as Chrome trace (Perfetto compatible) JSON to
+ * the configured file. The file is written when the framework is started (after the auto start bundles) and
+ * when the framework is destroyed.
+ */
+static const char *const CELIX_STARTUP_TRACE_FILE_NAME = "CELIX_STARTUP_TRACE_FILE";
+
+/**
+ * If set, the framework boots from the configured sealed bundle image (see `celix --create-image`) instead of the
+ * CELIX_AUTO_START_x lists: the pre-extracted bundles of the image are installed and started without extracting the
+ * bundle zips, reading the manifest files or scanning the bundle cache.
+ * Bundles of the image cannot be updated and are not persisted in the bundle cache.
+ */
+static const char *const CELIX_BUNDLE_IMAGE_NAME = "CELIX_BUNDLE_IMAGE";
+
 #define CELIX_AUTO_START_0 "CELIX_AUTO_START_0"
 #define CELIX_AUTO_START_1 "CELIX_AUTO_START_1"
 #define CELIX_AUTO_START_2 "CELIX_AUTO_START_2"
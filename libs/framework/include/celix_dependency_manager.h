@@ -36,6 +36,14 @@ extern "C" {
  */
 celix_status_t celix_dependencyManager_add(celix_dependency_manager_t *manager, celix_dm_component_t *component);
 
+/**
+ * Adds multiple DM components to the dependency manager.
+ * The components should be independent, i.e. have no service dependencies on each other. They are started
+ * concurrently when the framework property CELIX_DM_COMPONENT_START_THREADS is larger than 1.
+ * Returns after all components are started.
+ */
+celix_status_t celix_dependencyManager_addComponents(celix_dependency_manager_t *manager, celix_dm_component_t **components, size_t nrOfComponents);
+
 /**
  * Removes a DM component from the dependency manager and destroys it
  */
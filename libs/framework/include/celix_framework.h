@@ -23,6 +23,7 @@
 
 #include "celix_types.h"
 #include "celix_properties.h"
+#include "celix_array_list.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -76,6 +77,62 @@ void celix_framework_useBundles(celix_framework_t *fw, bool includeFrameworkBund
  */
 bool celix_framework_useBundle(celix_framework_t *fw, bool onlyActive, long bndId, void *callbackHandle, void(*use)(void *handle, const celix_bundle_t *bnd));
 
+typedef struct celix_framework_startup_trace_event {
+    const char *category;   //"bundle" or "component"
+    const char *name;       //e.g. "install", "loadLibrary", "create", "start" or the component state transition
+    const char *subject;    //the bundle symbolic name, library or component name
+    long bndId;             //the bundle id or -1 if not (yet) known
+    long long startInUs;    //start time relative to the creation of the framework
+    long long durationInUs;
+} celix_framework_startup_trace_event_t;
+
+/**
+ * Use the events recorded by the startup trace.
+ * The startup trace is enabled with the CELIX_STARTUP_TRACE_FILE config property.
+ *
+ * Note that the callback is called with the trace lock held and should not call framework functions.
+ *
+ * @param fw                The framework.
+ * @param callbackHandle    The data pointer, which will be used in the callbacks
+ * @param use               The callback which will be called for every recorded trace event.
+ *                          The event pointers are only guaranteed to be valid during the callback.
+ * @return                  Returns false if the startup trace is not enabled.
+ */
+bool celix_framework_useStartupTraceEvents(celix_framework_t *fw, void *callbackHandle, void (*use)(void *handle, const celix_framework_startup_trace_event_t *event));
+
+typedef struct celix_framework_bundle_memory_stats {
+    long bndId;
+    char *symbolicName;
+    size_t nrOfServiceRegistrations;    //services registered by the bundle
+    size_t nrOfServiceReferences;       //service references retrieved by the bundle
+    size_t nrOfServiceListeners;        //service listeners added by the bundle
+    size_t nrOfServiceTrackers;         //service trackers created with the bundle context of the bundle
+    size_t serviceRegistrationsInBytes; //excl. the service properties
+    size_t servicePropertiesInBytes;    //the properties of the services registered by the bundle
+    size_t serviceReferencesInBytes;
+    size_t serviceListenersInBytes;
+    size_t serviceTrackersInBytes;      //incl. the tracked entries
+    size_t totalInBytes;
+} celix_framework_bundle_memory_stats_t;
+
+/**
+ * Returns the memory used by the framework on behalf of the installed bundles (incl. the framework bundle) for
+ * service registrations, service properties, service references, service listeners and service trackers.
+ *
+ * Note that the sizes are calculated from the framework administration (struct sizes and string lengths) when this
+ * function is called and should be treated as an estimate, allocator overhead is not included.
+ *
+ * @param fw    The framework.
+ * @return      A list of celix_framework_bundle_memory_stats_t*, ordered by bundle id.
+ *              The caller is owner of the list and should destroy it with celix_framework_destroyMemoryStats.
+ */
+celix_array_list_t* celix_framework_getMemoryStats(celix_framework_t *fw);
+
+/**
+ * Destroys the list returned by celix_framework_getMemoryStats.
+ */
+void celix_framework_destroyMemoryStats(celix_array_list_t *stats);
+
 
 
 #ifdef __cplusplus
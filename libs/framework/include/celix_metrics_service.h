@@ -0,0 +1,77 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *  KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#ifndef CELIX_METRICS_SERVICE_H_
+#define CELIX_METRICS_SERVICE_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * A metrics provider service exposes runtime statistics of a bundle (or of the framework, which provides one for
+ * bundle 0). Metric exporters (e.g. the prometheus_exporter bundle) track all metrics provider services and call
+ * collect when the metrics are requested.
+ *
+ * Metrics are pulled: a provider updates its counters and gauges on the hot path (e.g. with plain atomic
+ * increments) and only reads them in the collect call. There is no per-sample registration or allocation.
+ */
+#define CELIX_METRICS_PROVIDER_SERVICE_NAME     "celix_metrics_provider"
+#define CELIX_METRICS_PROVIDER_SERVICE_VERSION  "1.0.0"
+
+typedef enum celix_metric_type {
+    CELIX_METRIC_COUNTER = 0, //monotonic increasing value, e.g. nr of calls or the total time spend in calls
+    CELIX_METRIC_GAUGE = 1 //value which can go up and down, e.g. a queue depth
+} celix_metric_type_e;
+
+/**
+ * Writer provided by the metrics exporter in the collect call. Only valid during the collect call.
+ */
+typedef struct celix_metrics_writer {
+    void *handle;
+
+    /**
+     * Writes a single sample.
+     *
+     * @param name      The metric name, following the prometheus naming convention (e.g. celix_framework_bundles or
+     *                  celix_rsa_outgoing_calls_total). Samples with the same name should have the same type and help.
+     * @param type      The metric type.
+     * @param help      Optional (can be NULL) one line description of the metric.
+     * @param labels    Optional (can be NULL) labels of the sample in the prometheus format without the braces,
+     *                  e.g. "topic=\"ping\",psa=\"zmq\"".
+     * @param value     The sample value.
+     */
+    void (*write)(void *handle, const char *name, celix_metric_type_e type, const char *help, const char *labels, double value);
+} celix_metrics_writer_t;
+
+typedef struct celix_metrics_provider_service {
+    void *handle;
+
+    /**
+     * Writes the current samples of the provider to the writer.
+     * Can be called concurrently from different exporters.
+     */
+    void (*collect)(void *handle, const celix_metrics_writer_t *writer);
+} celix_metrics_provider_service_t;
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* CELIX_METRICS_SERVICE_H_ */
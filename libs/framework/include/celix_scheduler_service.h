@@ -0,0 +1,71 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *  KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#ifndef CELIX_SCHEDULER_SERVICE_H_
+#define CELIX_SCHEDULER_SERVICE_H_
+
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * The scheduler service is provided by the framework (bundle 0) and runs one-shot and periodic callbacks on a small
+ * shared thread pool (see CELIX_SCHEDULER_THREADS), so that bundles do not need an own thread to sleep and poll.
+ *
+ * Deadlines are rounded up to the scheduler tick (see CELIX_SCHEDULER_TICK), so that events of different bundles
+ * which are due around the same time are handled in a single wakeup.
+ *
+ * Every bundle gets its own service instance. Events which are still scheduled when a bundle is stopped are
+ * cancelled by the framework after the bundle activator stop.
+ */
+#define CELIX_SCHEDULER_SERVICE_NAME        "celix_scheduler"
+#define CELIX_SCHEDULER_SERVICE_VERSION     "1.0.0"
+
+typedef struct celix_scheduler_service {
+    void *handle;
+
+    /**
+     * Schedules a callback which is called once after delayInSeconds.
+     * @return The event id (>= 0) or < 0 if the event could not be scheduled.
+     */
+    long (*scheduleOnce)(void *handle, double delayInSeconds, void *callbackData, void (*callback)(void *data));
+
+    /**
+     * Schedules a callback which is called after initialDelayInSeconds and then every intervalInSeconds, until
+     * the event is cancelled. Missed periods (e.g. because of a slow callback) are skipped, not called in a burst.
+     * @return The event id (>= 0) or < 0 if the event could not be scheduled.
+     */
+    long (*schedulePeriodic)(void *handle, double initialDelayInSeconds, double intervalInSeconds, void *callbackData, void (*callback)(void *data));
+
+    /**
+     * Cancels a scheduled event. If the callback of the event is running, this call waits till the callback
+     * is done, unless cancel is called from the callback itself.
+     * After this call the callback will not be called (again) and the callback data can be freed.
+     * @return True if the event was found (and cancelled).
+     */
+    bool (*cancel)(void *handle, long eventId);
+} celix_scheduler_service_t;
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* CELIX_SCHEDULER_SERVICE_H_ */
@@ -18,6 +18,7 @@
  */
 
 #include "celix_types.h"
+#include "celix_array_list.h"
 
 #ifndef CELIX_SERVICE_EVENT_H_
 #define CELIX_SERVICE_EVENT_H_
@@ -36,6 +37,13 @@ typedef enum celix_service_event_type {
 typedef struct celix_service_event {
 	service_reference_pt reference;
 	celix_service_event_type_t type;
+
+	/**
+	 * For MODIFIED and MODIFIED_ENDMATCH events the keys (const char*) of the service properties which are added,
+	 * changed or removed. NULL for the other events or if the changed keys are not known.
+	 * Only valid during the serviceChanged callback.
+	 */
+	const celix_array_list_t *changedKeys;
 } celix_service_event_t;
 
 #ifdef __cplusplus
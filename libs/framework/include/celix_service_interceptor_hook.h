@@ -0,0 +1,70 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *  KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#ifndef CELIX_SERVICE_INTERCEPTOR_HOOK_H_
+#define CELIX_SERVICE_INTERCEPTOR_HOOK_H_
+
+#include "celix_types.h"
+#include "celix_properties.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * A service interceptor hook can hand consumers a wrapper instead of the real service, e.g. to measure the latency
+ * of the service calls (see the service_profiler bundle).
+ *
+ * The hook is consulted by the service registry when a bundle gets a service it is not using yet (the first get
+ * for its service reference). Consumers which are already using the service keep using the service (or wrapper)
+ * they got. If multiple hooks are registered, the first hook returning a wrapper is used.
+ *
+ * A hook is used until all wrappers it handed out are released, as result unregistering the hook blocks until
+ * the consumers no longer use the wrappers. Bundles providing an interceptor hook should therefore be started before
+ * (and are stopped after) the bundles consuming the intercepted services.
+ */
+#define CELIX_SERVICE_INTERCEPTOR_HOOK_SERVICE_NAME     "celix_service_interceptor_hook"
+#define CELIX_SERVICE_INTERCEPTOR_HOOK_SERVICE_VERSION  "1.0.0"
+
+typedef struct celix_service_interceptor_hook {
+    void *handle;
+
+    /**
+     * Called when the consumer bundle gets the service.
+     *
+     * @param consumer      The bundle getting the service.
+     * @param provider      The bundle which registered the service.
+     * @param svcProperties The service properties.
+     * @param svc           The service.
+     * @return A wrapper for the service, which has the same interface as the service, or NULL if the service should
+     * not be intercepted.
+     */
+    void* (*intercept)(void *handle, const celix_bundle_t *consumer, const celix_bundle_t *provider, const celix_properties_t *svcProperties, const void *svc);
+
+    /**
+     * Called when the consumer no longer uses the wrapper (the last unget for its service reference).
+     */
+    void (*release)(void *handle, void *wrapper);
+} celix_service_interceptor_hook_t;
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* CELIX_SERVICE_INTERCEPTOR_HOOK_H_ */
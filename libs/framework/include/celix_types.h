@@ -41,6 +41,7 @@ typedef struct celix_bundle_context celix_bundle_context_t;
 typedef struct celix_dependency_manager celix_dependency_manager_t;
 typedef struct celix_dm_component_struct celix_dm_component_t;
 typedef struct celix_dm_service_dependency celix_dm_service_dependency_t;
+typedef struct celix_service_handle celix_service_handle_t;
 
 //deprecated
 typedef struct celix_dependency_manager dm_dependency_manager_t CELIX_DEPRECATED_ATTR;
@@ -60,6 +60,12 @@ FRAMEWORK_EXPORT void manifest_write(manifest_pt manifest, const char *filename)
 
 FRAMEWORK_EXPORT const char *manifest_getValue(manifest_pt manifest, const char *name);
 
+/**
+ * Returns true if the manifest has a lazy Bundle-ActivationPolicy and declares the provided services
+ * with Celix-Lazy-Services.
+ */
+FRAMEWORK_EXPORT bool manifest_isLazyActivation(manifest_pt manifest);
+
 #ifdef __cplusplus
 }
 #endif
@@ -37,6 +37,7 @@ typedef struct celix_serviceRegistry celix_service_registry_t;
 #include "array_list.h"
 #include "service_registration.h"
 #include "celix_service_factory.h"
+#include "celix_framework.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -55,6 +56,12 @@ serviceRegistry_getRegisteredServices(service_registry_pt registry, celix_bundle
 celix_status_t
 serviceRegistry_getServicesInUse(service_registry_pt registry, celix_bundle_t *bundle, celix_array_list_t **services);
 
+/**
+ * Adds the bundles (celix_bundle_t*) which registered the services the provided bundle has references to, to the
+ * provided list. Can contain duplicates.
+ */
+void serviceRegistry_getServiceOwnersUsedBy(service_registry_pt registry, celix_bundle_t *bundle, celix_array_list_t *owners);
+
 celix_status_t serviceRegistry_registerService(service_registry_pt registry, celix_bundle_t *bundle, const char *serviceName,
                                                const void *serviceObject, celix_properties_t *dictionary,
                                                service_registration_pt *registration);
@@ -95,6 +102,24 @@ celix_status_t serviceRegistry_clearReferencesFor(service_registry_pt registry,
 
 void serviceRegistry_callHooksForListenerFilter(service_registry_pt registry, celix_bundle_t *owner, const char *filter, bool removed);
 
+/**
+ * Starts collecting the listener hook calls for the listeners of the owner bundle, instead of calling the hooks for
+ * every added/removed listener. Used by the framework during bundle start and stop.
+ * Calls can be nested, the collected calls are delivered by the last serviceRegistry_endListenerHookBatch call.
+ */
+void serviceRegistry_beginListenerHookBatch(service_registry_pt registry, celix_bundle_t *owner);
+
+/**
+ * Ends a listener hook batch of the owner bundle. For the last end call, the hooks are called with all the collected
+ * listener infos, one call per sequence of added or removed listeners.
+ */
+void serviceRegistry_endListenerHookBatch(service_registry_pt registry, celix_bundle_t *owner);
+
+/**
+ * Returns the nr of registered services.
+ */
+size_t serviceRegistry_nrOfServices(service_registry_pt registry);
+
 size_t serviceRegistry_nrOfHooks(service_registry_pt registry);
 
 celix_status_t
@@ -110,6 +135,63 @@ celix_serviceRegistry_registerServiceFactory(
         celix_properties_t* props,
         service_registration_t **registration);
 
+/**
+ * Callback used to deliver the service events of a batch of registrations in a single pass.
+ */
+typedef void (*celix_serviceRegistry_serviceChangedForRegistrations_fp)(celix_framework_t *framework, celix_service_event_type_t eventType, service_registration_t **registrations, size_t nrOfRegistrations);
+
+/**
+ * Sets the callback used for the service events of bulk (un)registrations.
+ * If not set, the serviceChanged callback is called for every registration.
+ */
+void celix_serviceRegistry_setServiceChangedForRegistrationsCallback(celix_service_registry_t *reg, celix_serviceRegistry_serviceChangedForRegistrations_fp callback);
+
+/**
+ * Registers nrOfServices services, taking the registry write lock once and delivering the REGISTERED events as a
+ * single batch.
+ * For every entry either svcs[i] (plain service) or factories[i] (service factory) should be set; factories can be NULL.
+ * The ownership of the properties is transferred to the registrations.
+ */
+celix_status_t
+celix_serviceRegistry_registerServices(
+        celix_service_registry_t *reg,
+        const celix_bundle_t *bnd,
+        size_t nrOfServices,
+        const char * const *serviceNames,
+        const void * const *svcs,
+        celix_service_factory_t * const *factories,
+        celix_properties_t **props,
+        service_registration_t **registrations);
+
+/**
+ * Unregisters the provided registrations, taking the registry write lock once and delivering the UNREGISTERING
+ * events as a single batch.
+ * Registrations which are already invalid or unregistering are skipped.
+ */
+celix_status_t
+celix_serviceRegistry_unregisterServices(
+        celix_service_registry_t *reg,
+        const celix_bundle_t *bnd,
+        service_registration_t **registrations,
+        size_t nrOfRegistrations);
+
+/**
+ * Adds a secondary index on the provided service property.
+ * Service queries with a filter containing a top-level (or top-level AND) equality on an indexed property are
+ * resolved using the index instead of a scan of all service registrations.
+ * The objectClass property is always indexed.
+ *
+ * Property indexes should be added before services are registered, already registered services are indexed when
+ * the index is added.
+ */
+celix_status_t celix_serviceRegistry_addPropertyIndex(celix_service_registry_t *registry, const char *propertyName);
+
+/**
+ * Adds the memory used by the registry on behalf of the provided bundle to the stats, i.e. the service registrations
+ * (and their properties) owned by the bundle and the service references retrieved by the bundle.
+ */
+void celix_serviceRegistry_addBundleMemoryStats(celix_service_registry_t *registry, const celix_bundle_t *bnd, celix_framework_bundle_memory_stats_t *stats);
+
 #ifdef __cplusplus
 }
 #endif
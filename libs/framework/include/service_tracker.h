@@ -112,7 +112,7 @@ void celix_serviceTracker_destroy(celix_service_tracker_t *tracker);
  * No match -> no call to use.
  *
  * If waitForSvcTimeoutInSec is > 0. The call will block until a service is found or the timeout is expired.
- * (with a precision of roughly 1 microsecond)
+ * The waiting thread sleeps on a condition which is signalled when the tracker adds a service.
  *
  * @return bool     if the service if found and use has been called.
  */
@@ -127,6 +127,21 @@ bool celix_serviceTracker_useHighestRankingService(
 );
 
 
+/**
+ * Returns true if the tracker currently tracks a service. Does not block.
+ *
+ * Together with celix_serviceTracker_createWithOptions (which does not block) this can be used future-style:
+ * create the tracker, poll with celix_serviceTracker_hasService or block with celix_serviceTracker_waitForService
+ * and use the service with celix_serviceTracker_useHighestRankingService.
+ */
+bool celix_serviceTracker_hasService(celix_service_tracker_t *tracker);
+
+/**
+ * Blocks until the tracker tracks a service or the timeout expired.
+ * @return true if a service is tracked.
+ */
+bool celix_serviceTracker_waitForService(celix_service_tracker_t *tracker, double waitTimeoutInSeconds);
+
 /**
  * Calls the use callback for every services found by this tracker.
  */
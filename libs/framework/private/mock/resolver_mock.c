@@ -28,7 +28,7 @@
 
 #include "resolver.h"
 
-linked_list_pt resolver_resolve(module_pt root) {
+celix_ilist_t* resolver_resolve(module_pt root) {
 	mock_c()->actualCall("resolver_resolve")
 			->withPointerParameters("module", root);
 	return mock_c()->returnValue().value.pointerValue;
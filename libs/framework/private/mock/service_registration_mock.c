@@ -59,6 +59,12 @@ bool serviceRegistration_isValid(service_registration_pt registration) {
 	return mock_c()->returnValue().value.intValue;
 }
 
+bool serviceRegistration_markUnregistering(service_registration_pt registration) {
+	mock_c()->actualCall("serviceRegistration_markUnregistering")
+			->withPointerParameters("registration", registration);
+	return mock_c()->returnValue().value.intValue;
+}
+
 void serviceRegistration_invalidate(service_registration_pt registration) {
 	mock_c()->actualCall("serviceRegistration_invalidate")
 			->withPointerParameters("registration", registration);
@@ -95,6 +101,22 @@ celix_status_t serviceRegistration_getProperties(service_registration_pt registr
 	return mock_c()->returnValue().value.intValue;
 }
 
+celix_service_properties_snapshot_t* serviceRegistration_getPropertiesSnapshot(service_registration_pt registration) {
+	mock_c()->actualCall("serviceRegistration_getPropertiesSnapshot")
+			->withPointerParameters("registration", registration);
+	return mock_c()->returnValue().value.pointerValue;
+}
+
+void serviceRegistration_retainPropertiesSnapshot(celix_service_properties_snapshot_t *snapshot) {
+	mock_c()->actualCall("serviceRegistration_retainPropertiesSnapshot")
+			->withPointerParameters("snapshot", snapshot);
+}
+
+void serviceRegistration_releasePropertiesSnapshot(celix_service_properties_snapshot_t *snapshot) {
+	mock_c()->actualCall("serviceRegistration_releasePropertiesSnapshot")
+			->withPointerParameters("snapshot", snapshot);
+}
+
 celix_status_t serviceRegistration_getRegistry(service_registration_pt registration, service_registry_pt *registry) {
 	mock_c()->actualCall("serviceRegistration_getRegistry")
 			->withPointerParameters("registration", registration)
@@ -26,6 +26,7 @@
 
 #include <stdlib.h>
 #include <stdio.h>
+#include <unistd.h>
 
 #include "CppUTest/TestHarness.h"
 #include "CppUTest/TestHarness_c.h"
@@ -106,6 +107,53 @@ TEST(bundle_revision, createWithInput) {
 	LONGS_EQUAL(CELIX_SUCCESS, bundleRevision_destroy(revision));
 }
 
+TEST(bundle_revision, createWithAlreadyExtractedBundle) {
+	char root[] = "bundle_revision_extracted_test";
+	char location[] = "bundle_revision_test_bundle.zip";
+	long revisionNr = 1l;
+	manifest_pt manifest = (manifest_pt) 0x42;
+
+	FILE *zip = fopen(location, "w");
+	fputs("bundle content", zip);
+	fclose(zip);
+
+	//first create -> extract
+	mock().expectOneCall("extractBundle")
+			.withParameter("bundleName", location)
+			.withParameter("revisionRoot", root)
+			.andReturnValue(CELIX_SUCCESS);
+	mock().expectNCalls(3, "manifest_createFromFile")
+            .withParameter("filename", "bundle_revision_extracted_test/META-INF/MANIFEST.MF")
+            .withOutputParameterReturning("manifest", &manifest, sizeof(manifest))
+            .andReturnValue(CELIX_SUCCESS);
+	mock().expectNCalls(3, "manifest_destroy");
+
+	bundle_revision_pt revision = NULL;
+	LONGS_EQUAL(CELIX_SUCCESS, bundleRevision_create(root, location, revisionNr, NULL, &revision));
+	LONGS_EQUAL(CELIX_SUCCESS, bundleRevision_destroy(revision));
+
+	//second create with unchanged bundle -> no extract
+	revision = NULL;
+	LONGS_EQUAL(CELIX_SUCCESS, bundleRevision_create(root, location, revisionNr, NULL, &revision));
+	LONGS_EQUAL(CELIX_SUCCESS, bundleRevision_destroy(revision));
+
+	//third create with changed bundle -> extract
+	zip = fopen(location, "a");
+	fputs(" changed", zip);
+	fclose(zip);
+	mock().expectOneCall("extractBundle")
+			.withParameter("bundleName", location)
+			.withParameter("revisionRoot", root)
+			.andReturnValue(CELIX_SUCCESS);
+	revision = NULL;
+	LONGS_EQUAL(CELIX_SUCCESS, bundleRevision_create(root, location, revisionNr, NULL, &revision));
+	LONGS_EQUAL(CELIX_SUCCESS, bundleRevision_destroy(revision));
+
+	remove("bundle_revision_extracted_test/revision.stamp");
+	rmdir(root);
+	remove(location);
+}
+
 TEST(bundle_revision, getters) {
 	mock().expectNCalls(5, "framework_logCode").withParameter("code", CELIX_ILLEGAL_ARGUMENT);
 
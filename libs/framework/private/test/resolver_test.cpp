@@ -65,6 +65,11 @@ static char* my_strdup(const char* s) {
 	return d;
 }
 
+static importer_wires_pt popLastImporterWires(celix_ilist_t *wireMap) {
+	celix_ilist_node_t *node = celix_ilist_popBack(wireMap);
+	return node == NULL ? NULL : CELIX_ILIST_ENTRY(node, struct importer_wires, node);
+}
+
 TEST_GROUP(resolver) {
 	void setup(void){
 	}
@@ -100,8 +105,8 @@ TEST(resolver, resolve){
 	capability_pt cap2= (capability_pt) 0x09;
 
 	importer_wires_pt get_importer_wires;
-	linked_list_pt get_wire_list;
-	linked_list_pt get_wire_list2;
+	celix_ilist_t *get_wire_list;
+	celix_ilist_t *get_wire_list2;
 
 	//creating modules
 	linkedList_create(&capabilities);
@@ -196,21 +201,21 @@ TEST(resolver, resolve){
 
 
 	get_wire_list = resolver_resolve(module);
-	LONGS_EQUAL(2, linkedList_size(get_wire_list));
+	LONGS_EQUAL(2, celix_ilist_size(get_wire_list));
 	get_wire_list2 = resolver_resolve(module2);
-	LONGS_EQUAL(1, linkedList_size(get_wire_list2)); //creates one empty importer wires struct
+	LONGS_EQUAL(1, celix_ilist_size(get_wire_list2)); //creates one empty importer wires struct
 
-	get_importer_wires = (importer_wires_pt) linkedList_removeLast(get_wire_list2);
+	get_importer_wires = popLastImporterWires(get_wire_list2);
 	LONGS_EQUAL(0, linkedList_size(get_importer_wires->wires));
 	linkedList_destroy(get_importer_wires->wires);
 	free(get_importer_wires);
-	linkedList_destroy(get_wire_list2);
+	free(get_wire_list2);
 
-	get_importer_wires = (importer_wires_pt) linkedList_removeLast(get_wire_list);
+	get_importer_wires = popLastImporterWires(get_wire_list);
 	if ( get_importer_wires->importer == module ) {
 		module_setWires(module, get_importer_wires->wires);
 		free(get_importer_wires);
-		get_importer_wires = (importer_wires_pt) linkedList_removeLast(get_wire_list);
+		get_importer_wires = popLastImporterWires(get_wire_list);
 		POINTERS_EQUAL(get_importer_wires->importer, module2);
 		module_setWires(module2, get_importer_wires->wires);
 		free(get_importer_wires);
@@ -218,7 +223,7 @@ TEST(resolver, resolve){
 		POINTERS_EQUAL(get_importer_wires->importer, module2);
 		module_setWires(module2, get_importer_wires->wires);
 		free(get_importer_wires);
-		get_importer_wires = (importer_wires_pt) linkedList_removeLast(get_wire_list);
+		get_importer_wires = popLastImporterWires(get_wire_list);
 		POINTERS_EQUAL(get_importer_wires->importer, module);
 		module_setWires(module, get_importer_wires->wires);
 		free(get_importer_wires);
@@ -270,7 +275,7 @@ TEST(resolver, resolve){
 	module_destroy(module);
 	module_destroy(module2);
 
-	linkedList_destroy(get_wire_list);
+	free(get_wire_list);
 	free(id);
 	free(id2);
 	free(service_name);
@@ -291,7 +296,7 @@ TEST(resolver, resolve_fail){
 	char * service_name = my_strdup("test_service_foo");
 	requirement_pt req = (requirement_pt) 0x06;
 	requirement_pt req2= (requirement_pt) 0x07;
-	linked_list_pt get_wire_map;
+	celix_ilist_t *get_wire_map;
 
 	//creating modules
 	linkedList_create(&empty_capabilities);
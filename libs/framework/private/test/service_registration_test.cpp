@@ -363,8 +363,10 @@ TEST(service_registration, setProperties){
 	serviceRegistration_setProperties(registration, properties);
 
 	POINTERS_EQUAL(properties, registration->properties);
+	POINTERS_EQUAL(properties, registration->propertiesSnapshot->properties);
+	LONGS_EQUAL(1, registration->propertiesSnapshot->version);
 
-	properties_destroy(old_properties);
+	//note old properties are destroyed by the registration
 	serviceRegistration_release(registration);
 	free(name);
 }
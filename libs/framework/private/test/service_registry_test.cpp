@@ -117,7 +117,7 @@ TEST(service_registry, create) {
 	UNSIGNED_LONGS_EQUAL(1UL, registry->currentServiceId);
 	CHECK(registry->listenerHooks != NULL);
 	CHECK(registry->serviceReferences != NULL);
-	CHECK(registry->serviceRegistrations != NULL);
+	CHECK(registry->registrationShards[0].serviceRegistrations != NULL);
 
 	serviceRegistry_destroy(registry);
 }
@@ -132,7 +132,7 @@ TEST(service_registry, getRegisteredServices) {
 	reg->serviceId = 10UL;
 	arrayList_add(registrations, reg);
 	bundle_pt bundle = (bundle_pt) 0x20;
-	hashMap_put(registry->serviceRegistrations, bundle, registrations);
+	hashMap_put(serviceRegistry_getRegistrationShard(registry, NULL)->serviceRegistrations, bundle, registrations);
 
 	hash_map_pt usages = hashMap_create(NULL, NULL, NULL, NULL);
 	service_reference_pt ref = (service_reference_pt) 0x30;
@@ -154,7 +154,7 @@ TEST(service_registry, getRegisteredServices) {
 
 	arrayList_destroy(services);
 	arrayList_destroy(registrations);
-	hashMap_remove(registry->serviceRegistrations, bundle);
+	hashMap_remove(serviceRegistry_getRegistrationShard(registry, NULL)->serviceRegistrations, bundle);
 	serviceRegistry_destroy(registry);
 	free(reg);
 	hashMap_destroy(usages, false, false);
@@ -212,7 +212,7 @@ TEST(service_registry, registerServiceNoProps) {
 	serviceRegistry_registerService(registry, bundle, serviceName, service, NULL, &registration);
 	POINTERS_EQUAL(reg, registration);
 
-	array_list_pt destroy_this = (array_list_pt) hashMap_remove(registry->serviceRegistrations, bundle);
+	array_list_pt destroy_this = (array_list_pt) hashMap_remove(serviceRegistry_getRegistrationShard(registry, serviceName)->serviceRegistrations, bundle);
 	arrayList_destroy(destroy_this);
 	serviceRegistry_destroy(registry);
 	free(serviceName);
@@ -249,7 +249,7 @@ TEST(service_registry, registerServiceFactoryNoProps) {
 	serviceRegistry_registerServiceFactory(registry, bundle, serviceName, factory, NULL, &registration);
 	POINTERS_EQUAL(reg, registration);
 
-	array_list_pt destroy_this = (array_list_pt) hashMap_remove(registry->serviceRegistrations, bundle);
+	array_list_pt destroy_this = (array_list_pt) hashMap_remove(serviceRegistry_getRegistrationShard(registry, serviceName)->serviceRegistrations, bundle);
 	arrayList_destroy(destroy_this);
 	serviceRegistry_destroy(registry);
 	free(serviceName);
@@ -296,7 +296,7 @@ TEST(service_registry, registerServiceListenerHook) {
 	POINTERS_EQUAL(svcId, entry->svcId);
 
 	//cleanup
-	array_list_pt destroy_this = (array_list_pt) hashMap_remove(registry->serviceRegistrations, bundle);
+	array_list_pt destroy_this = (array_list_pt) hashMap_remove(serviceRegistry_getRegistrationShard(registry, serviceName)->serviceRegistrations, bundle);
 	arrayList_destroy(destroy_this);
 	arrayList_remove(registry->listenerHooks, 0);
 	serviceRegistry_destroy(registry);
@@ -314,7 +314,7 @@ TEST(service_registry, unregisterService) {
 	array_list_pt registrations = NULL;
 	arrayList_create(&registrations);
 	arrayList_add(registrations, registration);
-	hashMap_put(registry->serviceRegistrations, bundle, registrations);
+	hashMap_put(serviceRegistry_getRegistrationShard(registry, NULL)->serviceRegistrations, bundle, registrations);
 	service_reference_pt reference = (service_reference_pt) 0x30;
 	hash_map_pt references = hashMap_create(NULL, NULL, NULL, NULL);
 
@@ -372,50 +372,60 @@ TEST(service_registry, clearServiceRegistrations){
 	array_list_pt registrations = NULL;
 	arrayList_create(&registrations);
 	service_registration_pt reg = (service_registration_pt) 0x10;
+	service_registration_pt invalidReg = (service_registration_pt) 0x11;
 	arrayList_add(registrations, reg);
+	arrayList_add(registrations, invalidReg);
 	bundle_pt bundle = (bundle_pt) 0x20;
-	hashMap_put(registry->serviceRegistrations, bundle, registrations);
+	hashMap_put(serviceRegistry_getRegistrationShard(registry, NULL)->serviceRegistrations, bundle, registrations);
 
-	//removing the first registration
+	mock().expectOneCall("serviceRegistration_retain").withParameter("registration", reg);
+	mock().expectOneCall("serviceRegistration_retain").withParameter("registration", invalidReg);
+
+	//removing the last (invalid) registration
 	char *serviceName = (char *) "test_service";
 	mock()
 		.expectOneCall("serviceRegistration_getServiceName")
-		.withParameter("registration", reg)
+		.withParameter("registration", invalidReg)
 		.withOutputParameterReturning("serviceName", &serviceName, sizeof(serviceName))
 		.andReturnValue(CELIX_SUCCESS);
 
 	mock()
-		.expectOneCall("framework_log");
+		.expectNCalls(2, "framework_log");
 
 	mock()
 		.expectOneCall("serviceRegistration_isValid")
-		.withParameter("registration", reg)
-		.andReturnValue(true);
+		.withParameter("registration", invalidReg)
+		.andReturnValue(false);
 
-	//this call normally removes the registration from registry->serviceRegistrations
-	//but it remains since the mock does not call the callback->unregister therefore it acts like 2 separate registrations
-	mock().expectOneCall("serviceRegistration_unregister")
-			.withParameter("registration", reg);
+	mock().expectOneCall("serviceRegistration_release").withParameter("registration", invalidReg);
 
-	//removing the "second" registration
+	//removing the first registration
 	mock()
 		.expectOneCall("serviceRegistration_getServiceName")
 		.withParameter("registration", reg)
 		.withOutputParameterReturning("serviceName", &serviceName, sizeof(serviceName))
 		.andReturnValue(CELIX_SUCCESS);
 
-	mock()
-		.expectOneCall("framework_log");
-
 	mock()
 		.expectOneCall("serviceRegistration_isValid")
 		.withParameter("registration", reg)
-		.andReturnValue(false);
+		.andReturnValue(true);
+
+	//this call normally removes the registration from the registration shard
+	//but it remains since the mock does not call the callback->unregister
+	mock().expectOneCall("serviceRegistration_unregister")
+			.withParameter("registration", reg);
+
+	mock().expectOneCall("serviceRegistration_release").withParameter("registration", reg);
 
 	serviceRegistry_clearServiceRegistrations(registry, bundle);
 
+	//invalid registration is removed directly
+	LONGS_EQUAL(1, arrayList_size(registrations));
+	POINTERS_EQUAL(reg, arrayList_get(registrations, 0));
+
 	//clean up
-	hashMap_remove(registry->serviceRegistrations, bundle);
+	hashMap_remove(serviceRegistry_getRegistrationShard(registry, NULL)->serviceRegistrations, bundle);
 	arrayList_destroy(registrations);
 
 	serviceRegistry_destroy(registry);
@@ -490,14 +500,17 @@ TEST(service_registry, getServiceReferences) {
 	bundle_pt bundle = (bundle_pt) 0x10;
 	service_registration_pt registration = (service_registration_pt) calloc(1,sizeof(struct serviceRegistration));
 	registration->serviceId = 20UL;
+	registration->className = (char *) "test";
 
 	array_list_pt registrations = NULL;
 	arrayList_create(&registrations);
 	arrayList_add(registrations, registration);
-	hashMap_put(registry->serviceRegistrations, bundle, registrations);
+	hashMap_put(serviceRegistry_getRegistrationShard(registry, "test")->serviceRegistrations, bundle, registrations);
+	hashMap_put(serviceRegistry_getRegistrationShard(registry, "test")->serviceRegistrationsByName, (void *) "test", registrations);
 
 	properties_pt properties = (properties_pt) 0x30;
-	filter_pt filter = (filter_pt) 0x40;
+	filter_pt filter = (filter_pt) calloc(1, sizeof(*filter));
+	filter->operand = CELIX_FILTER_OPERAND_PRESENT;
 
 	hash_map_pt references = hashMap_create(NULL, NULL, NULL, NULL);
 	service_reference_pt reference = (service_reference_pt) 0x50;
@@ -514,7 +527,7 @@ TEST(service_registry, getServiceReferences) {
 		.withOutputParameterReturning("properties", &properties, sizeof(properties))
 		.andReturnValue(CELIX_SUCCESS);
 	bool matchResult = true;
-	mock().expectNCalls(2, "filter_match")
+	mock().expectOneCall("filter_match")
 		.withParameter("filter", filter)
 		.withParameter("properties", properties)
 		.withOutputParameterReturning("result", &matchResult, sizeof(matchResult));
@@ -546,8 +559,10 @@ TEST(service_registry, getServiceReferences) {
 	hashMap_destroy(references, false, false);
 	arrayList_destroy(actual);
 	arrayList_destroy(registrations);
-	hashMap_remove(registry->serviceRegistrations, bundle);
+	hashMap_remove(serviceRegistry_getRegistrationShard(registry, "test")->serviceRegistrations, bundle);
+	hashMap_remove(serviceRegistry_getRegistrationShard(registry, "test")->serviceRegistrationsByName, "test");
 	free(registration);
+	free(filter);
 	serviceRegistry_destroy(registry);
 }
 
@@ -563,7 +578,7 @@ TEST(service_registry, getServiceReferences_noFilterOrName) {
 	array_list_pt registrations = NULL;
 	arrayList_create(&registrations);
 	arrayList_add(registrations, registration);
-	hashMap_put(registry->serviceRegistrations, bundle, registrations);
+	hashMap_put(serviceRegistry_getRegistrationShard(registry, NULL)->serviceRegistrations, bundle, registrations);
 
 	properties_pt properties = (properties_pt) 0x30;
 
@@ -603,7 +618,7 @@ TEST(service_registry, getServiceReferences_noFilterOrName) {
 	hashMap_destroy(references, false, false);
 	arrayList_destroy(actual);
 	arrayList_destroy(registrations);
-	hashMap_remove(registry->serviceRegistrations, bundle);
+	hashMap_remove(serviceRegistry_getRegistrationShard(registry, NULL)->serviceRegistrations, bundle);
 	free(registration);
 	serviceRegistry_destroy(registry);
 }
@@ -617,7 +632,7 @@ TEST(service_registry, retainServiceReference){
 	bundle_pt bundle = (bundle_pt) 0x20;
 	bundle_pt bundle2 = (bundle_pt) 0x30;
 
-	//test unknown reference (reference not present in registry->deletedServiceReferences)
+	//test unknown reference (reference not present in the registry reference shards)
 	mock().expectOneCall("framework_log");
 
 	serviceRegistry_retainServiceReference(registry, bundle, reference);
@@ -634,7 +649,7 @@ TEST(service_registry, retainServiceReference){
 
 	registry->checkDeletedReferences = true;
 	//test known reference, with owner == bundle
-	hashMap_put(registry->deletedServiceReferences, reference, (void*) false);
+	hashMap_put(serviceRegistry_getReferenceShard(registry, reference)->deletedServiceReferences, reference, (void*) false);
 	mock().expectOneCall("serviceReference_getOwner")
 			.withParameter("reference", reference)
 			.withOutputParameterReturning("owner", &bundle, sizeof(bundle));
@@ -644,7 +659,7 @@ TEST(service_registry, retainServiceReference){
 	serviceRegistry_retainServiceReference(registry, bundle, reference);
 
 	//cleanup
-	hashMap_remove(registry->deletedServiceReferences, reference);
+	hashMap_remove(serviceRegistry_getReferenceShard(registry, reference)->deletedServiceReferences, reference);
 	serviceRegistry_destroy(registry);
 }
 
@@ -671,7 +686,7 @@ TEST(service_registry, ungetServiceReference){
 	hashMap_put(references2, registration3, reference3);
 	hashMap_put(registry->serviceReferences, bundle2, references2);
 
-	//test unknown reference (reference not present in registry->deletedServiceReferences)
+	//test unknown reference (reference not present in the registry reference shards)
 	mock().expectOneCall("framework_log");
 
 	serviceRegistry_ungetServiceReference(registry, bundle, reference);
@@ -679,7 +694,7 @@ TEST(service_registry, ungetServiceReference){
 	//test known reference, but destroyed == false
 	size_t count = 0;
 	bool destroyed = false;
-	hashMap_put(registry->deletedServiceReferences, reference, (void*) false);
+	hashMap_put(serviceRegistry_getReferenceShard(registry, reference)->deletedServiceReferences, reference, (void*) false);
 
 	mock().expectOneCall("serviceReference_getUsageCount")
 			.withParameter("reference", reference)
@@ -725,14 +740,14 @@ TEST(service_registry, ungetServiceReference){
 
 	serviceRegistry_ungetServiceReference(registry, bundle, reference);
 
-	CHECK((bool)hashMap_remove(registry->deletedServiceReferences, reference));
+	CHECK((bool)hashMap_remove(serviceRegistry_getReferenceShard(registry, reference)->deletedServiceReferences, reference));
 
 	//test known reference2, destroyed == true, and count == 0
 	references = hashMap_create(NULL, NULL, NULL, NULL);
 	hashMap_put(references, registration, reference);
 	hashMap_put(references, registration2, reference2);
 	hashMap_put(registry->serviceReferences, bundle, references);
-	hashMap_put(registry->deletedServiceReferences, reference2, (void*) false);
+	hashMap_put(serviceRegistry_getReferenceShard(registry, reference2)->deletedServiceReferences, reference2, (void*) false);
 	destroyed = true;
 	count = 0;
 
@@ -745,7 +760,7 @@ TEST(service_registry, ungetServiceReference){
 
 	serviceRegistry_ungetServiceReference(registry, bundle, reference2);
 
-	CHECK((bool)hashMap_remove(registry->deletedServiceReferences, reference2));//check that ref2 deleted == true
+	CHECK((bool)hashMap_remove(serviceRegistry_getReferenceShard(registry, reference2)->deletedServiceReferences, reference2));//check that ref2 deleted == true
 	POINTERS_EQUAL(reference, hashMap_remove(references, registration)); //check that ref1 is untouched
 
 	//cleanup
@@ -773,7 +788,7 @@ TEST(service_registry, clearReferencesFor_1){
 	size_t useCount = 0;
 	size_t refCount = 0;
 	bool destroyed = true;
-	hashMap_put(registry->deletedServiceReferences, reference, (void*) false);
+	hashMap_put(serviceRegistry_getReferenceShard(registry, reference)->deletedServiceReferences, reference, (void*) false);
 
 	//expected calls for removing reference1
 	mock().expectOneCall("serviceReference_getUsageCount")
@@ -860,7 +875,7 @@ TEST(service_registry, getService) {
 	arrayList_create(&registrations);
 	arrayList_add(registrations, registration);
 
-	hashMap_put(registry->serviceRegistrations, bundle, registrations);
+	hashMap_put(serviceRegistry_getRegistrationShard(registry, NULL)->serviceRegistrations, bundle, registrations);
 
 	service_reference_pt reference = (service_reference_pt) 0x40;
 
@@ -874,7 +889,7 @@ TEST(service_registry, getService) {
 	celix_status_t status = serviceRegistry_getService(registry, bundle, reference, &actual);
 	LONGS_EQUAL(CELIX_BUNDLE_EXCEPTION, status);
 	//test reference with invalid registration
-	hashMap_put(registry->deletedServiceReferences, reference, (void*) false);
+	hashMap_put(serviceRegistry_getReferenceShard(registry, reference)->deletedServiceReferences, reference, (void*) false);
 
 	mock()
 		.expectOneCall("serviceReference_getServiceRegistration")
@@ -933,7 +948,7 @@ TEST(service_registry, getService) {
 	serviceRegistry_getService(registry, bundle, reference, &actual);
 	POINTERS_EQUAL(service, actual);
 
-	hashMap_remove(registry->serviceRegistrations, bundle);
+	hashMap_remove(serviceRegistry_getRegistrationShard(registry, NULL)->serviceRegistrations, bundle);
 	arrayList_destroy(registrations);
 	serviceRegistry_destroy(registry);
 }
@@ -949,14 +964,14 @@ TEST(service_registry, ungetService) {
 	arrayList_create(&registrations);
 	arrayList_add(registrations, registration);
 
-	hashMap_put(registry->serviceRegistrations, bundle, registrations);
+	hashMap_put(serviceRegistry_getRegistrationShard(registry, NULL)->serviceRegistrations, bundle, registrations);
 
 	service_reference_pt reference = (service_reference_pt) 0x40;
 
 	array_list_pt usages = NULL;
 	arrayList_create(&usages);
 	hashMap_put(registry->serviceReferences, bundle, reference);
-	hashMap_put(registry->deletedServiceReferences, reference, (void*) false);
+	hashMap_put(serviceRegistry_getReferenceShard(registry, reference)->deletedServiceReferences, reference, (void*) false);
 	void * service = (void*) 0x50;
 
 	int count = 0;
@@ -987,8 +1002,8 @@ TEST(service_registry, ungetService) {
 	LONGS_EQUAL(CELIX_SUCCESS, status)
 	LONGS_EQUAL(true, result);
 
-	hashMap_remove(registry->deletedServiceReferences, reference);
-	hashMap_put(registry->deletedServiceReferences, reference, (void*) true);
+	hashMap_remove(serviceRegistry_getReferenceShard(registry, reference)->deletedServiceReferences, reference);
+	hashMap_put(serviceRegistry_getReferenceShard(registry, reference)->deletedServiceReferences, reference, (void*) true);
 
 	mock()
 		.expectOneCall("framework_log");
@@ -998,7 +1013,7 @@ TEST(service_registry, ungetService) {
 
 
 	arrayList_destroy(registrations);
-	hashMap_remove(registry->serviceRegistrations, bundle);
+	hashMap_remove(serviceRegistry_getRegistrationShard(registry, NULL)->serviceRegistrations, bundle);
 	serviceRegistry_destroy(registry);
 	arrayList_destroy(usages);
 }
@@ -615,6 +615,22 @@ char* celix_bundle_getEntry(const bundle_t* bnd, const char *path) {
 	return entry;
 }
 
+celix_status_t celix_bundle_mapEntry(const bundle_t* bnd, const char *path, const void **data, size_t *length) {
+	*data = NULL;
+	*length = 0;
+	char *entry = celix_bundle_getEntry(bnd, path);
+	if (entry == NULL) {
+		return CELIX_ILLEGAL_ARGUMENT;
+	}
+	celix_status_t status = utils_mapFile(entry, data, length);
+	free(entry);
+	return status;
+}
+
+void celix_bundle_unmapEntry(const void *data, size_t length) {
+	utils_unmapFile(data, length);
+}
+
 
 const char* celix_bundle_getGroup(const celix_bundle_t *bnd) {
 	const char *result = NULL;
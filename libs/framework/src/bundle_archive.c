@@ -41,6 +41,7 @@ struct bundleArchive {
 	time_t lastModified;
 
 	bundle_state_e persistentState;
+	bool sealed; //true if the archive is part of a read-only bundle image, state is only kept in memory
 };
 
 static celix_status_t bundleArchive_getRevisionLocation(bundle_archive_pt archive, long revNr, char **revision_location);
@@ -139,6 +140,51 @@ celix_status_t bundleArchive_create(const char *archiveRoot, long id, const char
 	return status;
 }
 
+celix_status_t bundleArchive_createSealed(const char *archiveRoot, long id, const char *location, manifest_pt manifest, bundle_archive_pt *bundle_archive) {
+	celix_status_t status = CELIX_SUCCESS;
+	bundle_archive_pt archive = calloc(1, sizeof(*archive));
+
+	if (archive == NULL) {
+		status = CELIX_ENOMEM;
+		manifest_destroy(manifest);
+	} else {
+		status = linkedList_create(&archive->revisions);
+		if (status == CELIX_SUCCESS) {
+			archive->id = id;
+			archive->location = strdup(location);
+			archive->archiveRoot = strdup(archiveRoot);
+			archive->refreshCount = 0;
+			archive->persistentState = OSGI_FRAMEWORK_BUNDLE_INSTALLED;
+			archive->sealed = true;
+			time(&archive->lastModified);
+
+			char *root = NULL;
+			bundle_revision_pt revision = NULL;
+			if (asprintf(&root, "%s/version0.0", archiveRoot) < 0) {
+				status = CELIX_ENOMEM;
+				manifest_destroy(manifest);
+			} else {
+				status = bundleRevision_createWithManifest(root, location, 0, manifest, &revision);
+				free(root);
+			}
+			if (status == CELIX_SUCCESS) {
+				linkedList_addElement(archive->revisions, revision);
+				*bundle_archive = archive;
+			}
+		} else {
+			manifest_destroy(manifest);
+		}
+	}
+
+	if (status != CELIX_SUCCESS && archive != NULL) {
+		bundleArchive_destroy(archive);
+	}
+
+	framework_logIfError(logger, status, NULL, "Could not create sealed archive");
+
+	return status;
+}
+
 celix_status_t bundleArchive_destroy(bundle_archive_pt archive) {
 	celix_status_t status = CELIX_SUCCESS;
 
@@ -369,6 +415,11 @@ celix_status_t bundleArchive_setPersistentState(bundle_archive_pt archive, bundl
 	char persistentStateLocation[512];
 	FILE *persistentStateLocationFile;
 
+	if (archive->sealed) {
+		archive->persistentState = state;
+		return status;
+	}
+
 	snprintf(persistentStateLocation, sizeof(persistentStateLocation), "%s/bundle.state", archive->archiveRoot);
 
 	persistentStateLocationFile = fopen(persistentStateLocation, "w");
@@ -438,6 +489,10 @@ celix_status_t bundleArchive_setRefreshCount(bundle_archive_pt archive) {
 	celix_status_t status = CELIX_SUCCESS;
 	char refreshCounter[512];
 
+	if (archive->sealed) {
+		return status;
+	}
+
 	snprintf(refreshCounter, sizeof(refreshCounter), "%s/refresh.counter", archive->archiveRoot);
 
 	refreshCounterFile = fopen(refreshCounter, "w");
@@ -474,7 +529,9 @@ celix_status_t bundleArchive_setLastModified(bundle_archive_pt archive, time_t l
 	celix_status_t status = CELIX_SUCCESS;
 
 	archive->lastModified = lastModifiedTime;
-	status = CELIX_DO_IF(status, bundleArchive_writeLastModified(archive));
+	if (!archive->sealed) {
+		status = bundleArchive_writeLastModified(archive);
+	}
 
 	framework_logIfError(logger, status, NULL, "Could not set last modified");
 
@@ -510,6 +567,7 @@ static celix_status_t bundleArchive_readLastModified(bundle_archive_pt archive,
 			tm_time.tm_hour = hours;
 			tm_time.tm_min = minutes;
 			tm_time.tm_sec = seconds;
+			tm_time.tm_isdst = -1; //written as local time, let mktime determine DST so the time survives a restart
 
 			*time = mktime(&tm_time);
 		}
@@ -544,6 +602,10 @@ static celix_status_t bundleArchive_writeLastModified(bundle_archive_pt archive)
 celix_status_t bundleArchive_revise(bundle_archive_pt archive, const char * location, const char *inputFile) {
 	celix_status_t status = CELIX_SUCCESS;
 	long revNr = 0l;
+	if (archive->sealed) {
+		fw_log(logger, OSGI_FRAMEWORK_LOG_ERROR, "Cannot revise bundle archive %s, it is part of a sealed bundle image", archive->archiveRoot);
+		return CELIX_ILLEGAL_STATE;
+	}
 	if (!linkedList_isEmpty(archive->revisions)) {
 		long revisionNr;
 		status = bundleRevision_getNumber(linkedList_getLast(archive->revisions), &revisionNr);
@@ -595,8 +657,12 @@ static celix_status_t bundleArchive_createRevisionFromLocation(bundle_archive_pt
 	if (status == CELIX_SUCCESS) {
 		bundle_revision_pt revision = NULL;
 
+		//note the last modified time changes on every (re)install/update, and is used as key for the manifest cache
+		time_t lastModified = 0;
+		long long cacheKey = bundleArchive_getLastModified(archive, &lastModified) == CELIX_SUCCESS ? (long long)lastModified : -1;
+
 		sprintf(root, "%s/version%ld.%ld", archive->archiveRoot, refreshCount, revNr);
-		status = bundleRevision_create(root, location, revNr, inputFile, &revision);
+		status = bundleRevision_createCached(root, location, revNr, inputFile, cacheKey, &revision);
 
 		if (status == CELIX_SUCCESS) {
 			*bundle_revision = revision;
@@ -676,7 +742,7 @@ celix_status_t bundleArchive_closeAndDelete(bundle_archive_pt archive) {
 	celix_status_t status = CELIX_SUCCESS;
 
 	status = bundleArchive_close(archive);
-	if (status == CELIX_SUCCESS) {
+	if (status == CELIX_SUCCESS && !archive->sealed) {
 		status = bundleArchive_deleteTree(archive, archive->archiveRoot);
 	}
 
@@ -186,6 +186,10 @@ celix_status_t bundleCache_createArchive(bundle_cache_pt cache, long id, const c
 	char archiveRoot[512];
 
 	if (cache && location) {
+		//note the cache dir is not created at boot when booting from a bundle image
+		if (mkdir(cache->cacheDir, S_IRWXU) != 0 && errno != EEXIST) {
+			fw_log(logger, OSGI_FRAMEWORK_LOG_ERROR, "Cannot create bundle cache dir %s", cache->cacheDir);
+		}
 		snprintf(archiveRoot, sizeof(archiveRoot), "%s/bundle%ld",  cache->cacheDir, id);
 		status = bundleArchive_create(archiveRoot, id, location, inputFile, bundle_archive);
 	}
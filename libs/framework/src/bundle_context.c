@@ -504,6 +504,116 @@ void celix_bundleContext_unregisterService(bundle_context_t *ctx, long serviceId
     }
 }
 
+size_t celix_bundleContext_registerServices(celix_bundle_context_t *ctx, const celix_service_registration_options_t *opts, size_t nrOfServices, long *serviceIds) {
+    size_t nrOfRegistered = 0;
+    if (ctx == NULL || nrOfServices == 0) {
+        return nrOfRegistered;
+    }
+
+    const char **names = calloc(nrOfServices, sizeof(*names));
+    const void **svcs = calloc(nrOfServices, sizeof(*svcs));
+    celix_service_factory_t **factories = calloc(nrOfServices, sizeof(*factories));
+    celix_properties_t **props = calloc(nrOfServices, sizeof(*props));
+    service_registration_t **regs = calloc(nrOfServices, sizeof(*regs));
+    size_t *optIndices = calloc(nrOfServices, sizeof(*optIndices));
+    size_t nrOfBulk = 0;
+
+    for (size_t i = 0; i < nrOfServices; ++i) {
+        serviceIds[i] = -1L;
+        const celix_service_registration_options_t *opt = &opts[i];
+        bool validName = opt->serviceName != NULL && strncmp("", opt->serviceName, 1) != 0;
+        if (!validName || (opt->svc == NULL && opt->factory == NULL)) {
+            framework_logIfError(logger, CELIX_ILLEGAL_ARGUMENT, NULL, "Required serviceName or svc/factory argument is NULL for service at index %zu", i);
+            if (opt->properties != NULL) {
+                properties_destroy(opt->properties);
+            }
+        } else if (strcmp(opt->serviceName, OSGI_FRAMEWORK_LISTENER_HOOK_SERVICE_NAME) == 0) {
+            //listener hooks need the current listeners on registration, use the single registration path
+            serviceIds[i] = celix_bundleContext_registerServiceWithOptions(ctx, opt);
+            nrOfRegistered += serviceIds[i] >= 0 ? 1 : 0;
+        } else {
+            celix_properties_t *p = opt->properties;
+            if (p == NULL) {
+                p = celix_properties_create();
+            }
+            if (opt->serviceVersion != NULL && strncmp("", opt->serviceVersion, 1) != 0) {
+                celix_properties_set(p, CELIX_FRAMEWORK_SERVICE_VERSION, opt->serviceVersion);
+            }
+            const char *lang = opt->serviceLanguage != NULL && strncmp("", opt->serviceLanguage, 1) != 0 ? opt->serviceLanguage : CELIX_FRAMEWORK_SERVICE_C_LANGUAGE;
+            celix_properties_set(p, CELIX_FRAMEWORK_SERVICE_LANGUAGE, lang);
+
+            names[nrOfBulk] = opt->serviceName;
+            svcs[nrOfBulk] = opt->svc;
+            factories[nrOfBulk] = opt->factory;
+            props[nrOfBulk] = p;
+            optIndices[nrOfBulk] = i;
+            ++nrOfBulk;
+        }
+    }
+
+    if (nrOfBulk > 0) {
+        celix_status_t status = celix_framework_registerServices(ctx->framework, ctx->bundle, nrOfBulk, names, svcs, factories, props, regs);
+        if (status == CELIX_SUCCESS) {
+            celixThreadMutex_lock(&ctx->mutex);
+            for (size_t i = 0; i < nrOfBulk; ++i) {
+                arrayList_add(ctx->svcRegistrations, regs[i]);
+                serviceIds[optIndices[i]] = serviceRegistration_getServiceId(regs[i]);
+            }
+            celixThreadMutex_unlock(&ctx->mutex);
+            nrOfRegistered += nrOfBulk;
+        } else {
+            for (size_t i = 0; i < nrOfBulk; ++i) {
+                properties_destroy(props[i]);
+            }
+        }
+    }
+
+    free(names);
+    free(svcs);
+    free(factories);
+    free(props);
+    free(regs);
+    free(optIndices);
+    return nrOfRegistered;
+}
+
+void celix_bundleContext_unregisterServices(celix_bundle_context_t *ctx, const long *serviceIds, size_t nrOfServices) {
+    if (ctx == NULL || nrOfServices == 0) {
+        return;
+    }
+
+    hash_map_t *ids = hashMap_create(NULL, NULL, NULL, NULL); //key = service id, value = service id (ids are > 0)
+    for (size_t i = 0; i < nrOfServices; ++i) {
+        if (serviceIds[i] >= 0) {
+            hashMap_put(ids, (void*)serviceIds[i], (void*)serviceIds[i]);
+        }
+    }
+
+    service_registration_t **found = calloc(nrOfServices, sizeof(*found));
+    size_t nrOfFound = 0;
+    celixThreadMutex_lock(&ctx->mutex);
+    for (int i = arrayList_size(ctx->svcRegistrations) - 1; i >= 0 && nrOfFound < nrOfServices; --i) {
+        service_registration_t *reg = arrayList_get(ctx->svcRegistrations, i);
+        if (reg != NULL && hashMap_remove(ids, (void*)serviceRegistration_getServiceId(reg)) != NULL) {
+            found[nrOfFound++] = reg;
+            arrayList_remove(ctx->svcRegistrations, i);
+        }
+    }
+    celixThreadMutex_unlock(&ctx->mutex);
+
+    hash_map_iterator_t iter = hashMapIterator_construct(ids);
+    while (hashMapIterator_hasNext(&iter)) {
+        long svcId = (long)hashMapIterator_nextKey(&iter);
+        framework_logIfError(logger, CELIX_ILLEGAL_ARGUMENT, NULL, "Provided service id (%li) is not used to registered using celix_bundleContext_registerService(s)", svcId);
+    }
+    hashMap_destroy(ids, false, false);
+
+    if (nrOfFound > 0) {
+        celix_framework_unregisterServices(ctx->framework, ctx->bundle, found, nrOfFound);
+    }
+    free(found);
+}
+
 celix_dependency_manager_t* celix_bundleContext_getDependencyManager(bundle_context_t *ctx) {
     celix_dependency_manager_t* result = NULL;
     if (ctx != NULL) {
@@ -865,6 +975,67 @@ void celix_bundleContext_useServicesWithOptions(
 }
 
 
+celix_service_handle_t* celix_bundleContext_createServiceHandle(
+        celix_bundle_context_t *ctx,
+        const celix_service_filter_options_t *opts) {
+    celix_service_handle_t *handle = NULL;
+    if (ctx != NULL && opts != NULL && opts->serviceName != NULL) {
+        celix_service_tracking_options_t trkOpts = CELIX_EMPTY_SERVICE_TRACKING_OPTIONS;
+        trkOpts.filter.serviceName = opts->serviceName;
+        trkOpts.filter.filter = opts->filter;
+        trkOpts.filter.versionRange = opts->versionRange;
+        trkOpts.filter.serviceLanguage = opts->serviceLanguage;
+        trkOpts.filter.ignoreServiceLanguage = opts->ignoreServiceLanguage;
+
+        service_tracker_t *trk = celix_serviceTracker_createWithOptions(ctx, &trkOpts);
+        if (trk != NULL) {
+            handle = calloc(1, sizeof(*handle));
+            handle->ctx = ctx;
+            handle->serviceName = strndup(opts->serviceName, 1024 * 1024);
+            handle->tracker = trk;
+        }
+    } else {
+        fw_log(logger, OSGI_FRAMEWORK_LOG_ERROR, "Cannot create service handle. Missing bundle context, options or service name");
+    }
+    return handle;
+}
+
+void celix_serviceHandle_destroy(celix_service_handle_t *handle) {
+    if (handle != NULL) {
+        celix_serviceTracker_destroy(handle->tracker);
+        free(handle->serviceName);
+        free(handle);
+    }
+}
+
+bool celix_serviceHandle_use(celix_service_handle_t *handle, void *callbackHandle, void (*use)(void *handle, void *svc)) {
+    bool called = false;
+    if (handle != NULL) {
+        called = celix_serviceTracker_useHighestRankingService(handle->tracker, handle->serviceName, 0, callbackHandle, use, NULL, NULL);
+    }
+    return called;
+}
+
+bool celix_serviceHandle_useWithOptions(celix_service_handle_t *handle, const celix_service_use_options_t *opts) {
+    bool called = false;
+    if (handle != NULL && opts != NULL) {
+        called = celix_serviceTracker_useHighestRankingService(handle->tracker, handle->serviceName, opts->waitTimeoutInSeconds, opts->callbackHandle, opts->use, opts->useWithProperties, opts->useWithOwner);
+    }
+    return called;
+}
+
+void celix_serviceHandle_useServices(celix_service_handle_t *handle, void *callbackHandle, void (*use)(void *handle, void *svc)) {
+    if (handle != NULL) {
+        celix_serviceTracker_useServices(handle->tracker, handle->serviceName, callbackHandle, use, NULL, NULL);
+    }
+}
+
+void celix_serviceHandle_useServicesWithOptions(celix_service_handle_t *handle, const celix_service_use_options_t *opts) {
+    if (handle != NULL && opts != NULL) {
+        celix_serviceTracker_useServices(handle->tracker, handle->serviceName, opts->callbackHandle, opts->use, opts->useWithProperties, opts->useWithOwner);
+    }
+}
+
 long celix_bundleContext_trackService(
         bundle_context_t* ctx,
         const char* serviceName,
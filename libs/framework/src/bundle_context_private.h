@@ -45,6 +45,12 @@ typedef struct celix_bundle_context_service_tracker_tracker_entry {
 	void (*remove)(void *handle, const celix_service_tracker_info_t *info);
 } celix_bundle_context_service_tracker_tracker_entry_t;
 
+struct celix_service_handle {
+	celix_bundle_context_t *ctx;
+	char *serviceName;
+	struct celix_serviceTracker *tracker;
+};
+
 struct celix_bundle_context {
 	celix_framework_t *framework;
 	celix_bundle_t *bundle;
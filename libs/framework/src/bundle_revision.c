@@ -34,7 +34,220 @@
 
 #include "bundle_revision_private.h"
 
+#define BUNDLE_REVISION_STAMP_FILE "revision.stamp"
+#define BUNDLE_REVISION_MANIFEST_CACHE_FILE "manifest.cache"
+#define BUNDLE_REVISION_WIRING_CACHE_FILE "wiring.cache"
+#define BUNDLE_REVISION_MANIFEST_CACHE_HEADER "celix-manifest-cache 1"
+#define BUNDLE_REVISION_WIRING_CACHE_HEADER "celix-wiring-cache 1"
+
+/**
+ * Calculates a FNV-1a hash of the content of the provided file.
+ */
+static celix_status_t bundleRevision_hashFile(const char *file, unsigned long long *hash) {
+    FILE *f = fopen(file, "rb");
+    if (f == NULL) {
+        return CELIX_FILE_IO_EXCEPTION;
+    }
+    unsigned long long h = 14695981039346656037ULL;
+    unsigned char buf[8192];
+    size_t read;
+    while ((read = fread(buf, 1, sizeof(buf), f)) > 0) {
+        for (size_t i = 0; i < read; ++i) {
+            h ^= buf[i];
+            h *= 1099511628211ULL;
+        }
+    }
+    celix_status_t status = ferror(f) ? CELIX_FILE_IO_EXCEPTION : CELIX_SUCCESS;
+    fclose(f);
+    *hash = h;
+    return status;
+}
+
+/**
+ * Returns whether the revision root contains a extraction of the provided bundle zip with the same size,
+ * modification time and content hash.
+ */
+static bool bundleRevision_isExtracted(const char *root, const char *bundleFile, const struct stat *st) {
+    char stampFile[512];
+    snprintf(stampFile, sizeof(stampFile), "%s/%s", root, BUNDLE_REVISION_STAMP_FILE);
+    FILE *f = fopen(stampFile, "r");
+    if (f == NULL) {
+        return false;
+    }
+    long long size = -1;
+    long long mtime = -1;
+    unsigned long long hash = 0;
+    int rc = fscanf(f, "%lld %lld %llx", &size, &mtime, &hash);
+    fclose(f);
+
+    bool extracted = false;
+    if (rc == 3 && size == (long long)st->st_size && mtime == (long long)st->st_mtime) {
+        //size and mtime match, check the content
+        unsigned long long currentHash = 0;
+        extracted = bundleRevision_hashFile(bundleFile, &currentHash) == CELIX_SUCCESS && currentHash == hash;
+    }
+    return extracted;
+}
+
+static void bundleRevision_writeStamp(const char *root, const char *bundleFile, const struct stat *st) {
+    unsigned long long hash = 0;
+    if (bundleRevision_hashFile(bundleFile, &hash) == CELIX_SUCCESS) {
+        char stampFile[512];
+        snprintf(stampFile, sizeof(stampFile), "%s/%s", root, BUNDLE_REVISION_STAMP_FILE);
+        FILE *f = fopen(stampFile, "w");
+        if (f != NULL) {
+            fprintf(f, "%lld %lld %llx\n", (long long)st->st_size, (long long)st->st_mtime, hash);
+            fclose(f);
+        }
+    }
+}
+
+/**
+ * Extracts the bundle zip into the revision root, unless the root already contains a extraction of the unchanged
+ * bundle zip (e.g. when a bundle cache is reused).
+ */
+static celix_status_t bundleRevision_extract(const char *bundleFile, const char *root) {
+    struct stat st;
+    bool canStamp = stat(bundleFile, &st) == 0 && S_ISREG(st.st_mode);
+    if (canStamp && bundleRevision_isExtracted(root, bundleFile, &st)) {
+        return CELIX_SUCCESS;
+    }
+
+    char stampFile[512];
+    snprintf(stampFile, sizeof(stampFile), "%s/%s", root, BUNDLE_REVISION_STAMP_FILE);
+    remove(stampFile); //extraction can be interrupted, only stamp a complete extraction
+
+    //the content can change, so the cached manifest and wiring are no longer valid
+    char cacheFile[512];
+    snprintf(cacheFile, sizeof(cacheFile), "%s/%s", root, BUNDLE_REVISION_MANIFEST_CACHE_FILE);
+    remove(cacheFile);
+    snprintf(cacheFile, sizeof(cacheFile), "%s/%s", root, BUNDLE_REVISION_WIRING_CACHE_FILE);
+    remove(cacheFile);
+
+    celix_status_t status = extractBundle(bundleFile, root);
+    if (status == CELIX_SUCCESS && canStamp) {
+        bundleRevision_writeStamp(root, bundleFile, &st);
+    }
+    return status;
+}
+
+/**
+ * Reads the provided file in a NUL terminated buffer. Returns NULL if the file cannot be read.
+ */
+static char* bundleRevision_readFile(const char *file, size_t *size) {
+    FILE *f = fopen(file, "rb");
+    if (f == NULL) {
+        return NULL;
+    }
+    char *buf = NULL;
+    long len = fseek(f, 0, SEEK_END) == 0 ? ftell(f) : -1;
+    if (len >= 0 && fseek(f, 0, SEEK_SET) == 0) {
+        buf = malloc((size_t)len + 1);
+        if (buf != NULL && fread(buf, 1, (size_t)len, f) == (size_t)len) {
+            buf[len] = '\0';
+            *size = (size_t)len;
+        } else {
+            free(buf);
+            buf = NULL;
+        }
+    }
+    fclose(f);
+    return buf;
+}
+
+/**
+ * Writes the content to the file using a temporary file, so that a interrupted write does not leave a partial cache.
+ */
+static celix_status_t bundleRevision_writeFile(const char *file, const char *content, size_t size) {
+    char tmpFile[512];
+    snprintf(tmpFile, sizeof(tmpFile), "%s~", file);
+    FILE *f = fopen(tmpFile, "wb");
+    if (f == NULL) {
+        return CELIX_FILE_IO_EXCEPTION;
+    }
+    bool written = fwrite(content, 1, size, f) == size;
+    written = fclose(f) == 0 && written;
+    if (!written || rename(tmpFile, file) != 0) {
+        remove(tmpFile);
+        return CELIX_FILE_IO_EXCEPTION;
+    }
+    return CELIX_SUCCESS;
+}
+
+/**
+ * Reads the manifest headers from the manifest cache, if the cache has the provided key.
+ * The cache contains a header line followed by NUL terminated key, value pairs.
+ */
+static manifest_pt bundleRevision_readManifestCache(const char *root, long long cacheKey) {
+    char cacheFile[512];
+    snprintf(cacheFile, sizeof(cacheFile), "%s/%s", root, BUNDLE_REVISION_MANIFEST_CACHE_FILE);
+    size_t size = 0;
+    char *buf = bundleRevision_readFile(cacheFile, &size);
+    if (buf == NULL) {
+        return NULL;
+    }
+
+    manifest_pt manifest = NULL;
+    long long key = -1;
+    size_t nrOfHeaders = 0;
+    int headerLen = 0;
+    if (sscanf(buf, BUNDLE_REVISION_MANIFEST_CACHE_HEADER " %lld %zu\n%n", &key, &nrOfHeaders, &headerLen) == 2 && headerLen > 0 && key == cacheKey && manifest_create(&manifest) == CELIX_SUCCESS) {
+        const char *end = buf + size;
+        const char *p = buf + headerLen;
+        size_t i;
+        for (i = 0; i < nrOfHeaders && p < end; ++i) {
+            const char *name = p;
+            p += strlen(p) + 1;
+            if (p >= end) {
+                break;
+            }
+            properties_set(manifest->mainAttributes, name, p);
+            p += strlen(p) + 1;
+        }
+        if (i != nrOfHeaders) {
+            //truncated or corrupt cache
+            manifest_destroy(manifest);
+            manifest = NULL;
+        }
+    }
+    free(buf);
+    return manifest;
+}
+
+static void bundleRevision_writeManifestCache(const char *root, long long cacheKey, manifest_pt manifest) {
+    if (hashMap_size(manifest->attributes) > 0) {
+        return; //note only the main attributes are cached
+    }
+
+    char *buf = NULL;
+    size_t size = 0;
+    FILE *stream = open_memstream(&buf, &size);
+    if (stream == NULL) {
+        return;
+    }
+    fprintf(stream, BUNDLE_REVISION_MANIFEST_CACHE_HEADER " %lld %zu\n", cacheKey, (size_t)celix_properties_size(manifest->mainAttributes));
+    const char *name = NULL;
+    CELIX_PROPERTIES_FOR_EACH(manifest->mainAttributes, name) {
+        fputs(name, stream);
+        fputc('\0', stream);
+        fputs(celix_properties_get(manifest->mainAttributes, name, ""), stream);
+        fputc('\0', stream);
+    }
+    fclose(stream);
+
+    char cacheFile[512];
+    snprintf(cacheFile, sizeof(cacheFile), "%s/%s", root, BUNDLE_REVISION_MANIFEST_CACHE_FILE);
+    if (bundleRevision_writeFile(cacheFile, buf, size) != CELIX_SUCCESS) {
+        fw_log(logger, OSGI_FRAMEWORK_LOG_DEBUG, "Cannot write manifest cache %s", cacheFile);
+    }
+    free(buf);
+}
+
 celix_status_t bundleRevision_create(const char *root, const char *location, long revisionNr, const char *inputFile, bundle_revision_pt *bundle_revision) {
+    return bundleRevision_createCached(root, location, revisionNr, inputFile, -1, bundle_revision);
+}
+
+celix_status_t bundleRevision_createCached(const char *root, const char *location, long revisionNr, const char *inputFile, long long cacheKey, bundle_revision_pt *bundle_revision) {
     celix_status_t status = CELIX_SUCCESS;
 	bundle_revision_pt revision = NULL;
 
@@ -48,10 +261,10 @@ celix_status_t bundleRevision_create(const char *root, const char *location, lon
             status = CELIX_FILE_IO_EXCEPTION;
         } else {
             if (inputFile != NULL) {
-                status = extractBundle(inputFile, root);
+                status = bundleRevision_extract(inputFile, root);
             } else if (strcmp(location, "inputstream:") != 0) {
-            	// If location != inputstream, extract it, else ignore it and assume this is a cache entry.
-                status = extractBundle(location, root);
+            	// If location != inputstream, extract it (if changed), else ignore it and assume this is a cache entry.
+                status = bundleRevision_extract(location, root);
             }
 
             status = CELIX_DO_IF(status, arrayList_create(&(revision->libraryHandles)));
@@ -59,12 +272,20 @@ celix_status_t bundleRevision_create(const char *root, const char *location, lon
                 revision->revisionNr = revisionNr;
                 revision->root = strdup(root);
                 revision->location = strdup(location);
+                revision->cacheKey = cacheKey;
 
                 *bundle_revision = revision;
 
-                char manifest[512];
-                snprintf(manifest, sizeof(manifest), "%s/META-INF/MANIFEST.MF", revision->root);
-				status = manifest_createFromFile(manifest, &revision->manifest);
+                revision->manifest = cacheKey >= 0 ? bundleRevision_readManifestCache(revision->root, cacheKey) : NULL;
+                if (revision->manifest == NULL) {
+                    char manifest[512];
+                    snprintf(manifest, sizeof(manifest), "%s/META-INF/MANIFEST.MF", revision->root);
+                    status = manifest_create(&revision->manifest);
+                    bool read = status == CELIX_SUCCESS && manifest_read(revision->manifest, manifest) == CELIX_SUCCESS;
+                    if (read && cacheKey >= 0) {
+                        bundleRevision_writeManifestCache(revision->root, cacheKey, revision->manifest);
+                    }
+                }
             }
             else {
             	free(revision);
@@ -78,6 +299,32 @@ celix_status_t bundleRevision_create(const char *root, const char *location, lon
 	return status;
 }
 
+celix_status_t bundleRevision_createWithManifest(const char *root, const char *location, long revisionNr, manifest_pt manifest, bundle_revision_pt *bundle_revision) {
+    celix_status_t status = CELIX_SUCCESS;
+    bundle_revision_pt revision = calloc(1, sizeof(*revision));
+    if (revision == NULL) {
+        status = CELIX_ENOMEM;
+    } else {
+        status = arrayList_create(&revision->libraryHandles);
+    }
+
+    if (status == CELIX_SUCCESS) {
+        revision->revisionNr = revisionNr;
+        revision->root = strdup(root);
+        revision->location = strdup(location);
+        revision->manifest = manifest;
+        revision->cacheKey = -1;
+        *bundle_revision = revision;
+    } else {
+        free(revision);
+        manifest_destroy(manifest);
+    }
+
+    framework_logIfError(logger, status, NULL, "Failed to create revision");
+
+    return status;
+}
+
 celix_status_t bundleRevision_destroy(bundle_revision_pt revision) {
     arrayList_destroy(revision->libraryHandles);
     manifest_destroy(revision->manifest);
@@ -87,6 +334,38 @@ celix_status_t bundleRevision_destroy(bundle_revision_pt revision) {
 	return CELIX_SUCCESS;
 }
 
+celix_status_t bundleRevision_getCachedWiring(bundle_revision_pt revision, char **wiring) {
+    *wiring = NULL;
+    if (revision == NULL || revision->cacheKey < 0) {
+        return CELIX_SUCCESS;
+    }
+
+    char cacheFile[512];
+    snprintf(cacheFile, sizeof(cacheFile), "%s/%s", revision->root, BUNDLE_REVISION_WIRING_CACHE_FILE);
+    size_t size = 0;
+    char *buf = bundleRevision_readFile(cacheFile, &size);
+    long long key = -1;
+    int headerLen = 0;
+    if (buf != NULL && sscanf(buf, BUNDLE_REVISION_WIRING_CACHE_HEADER " %lld\n%n", &key, &headerLen) == 1 && headerLen > 0 && key == revision->cacheKey) {
+        *wiring = strdup(buf + headerLen);
+    }
+    free(buf);
+    return CELIX_SUCCESS;
+}
+
+celix_status_t bundleRevision_setCachedWiring(bundle_revision_pt revision, const char *wiring) {
+    celix_status_t status = CELIX_SUCCESS;
+    if (revision != NULL && revision->cacheKey >= 0 && wiring != NULL) {
+        char cacheFile[512];
+        snprintf(cacheFile, sizeof(cacheFile), "%s/%s", revision->root, BUNDLE_REVISION_WIRING_CACHE_FILE);
+        char *content = NULL;
+        int len = asprintf(&content, BUNDLE_REVISION_WIRING_CACHE_HEADER " %lld\n%s", revision->cacheKey, wiring);
+        status = len < 0 ? CELIX_ENOMEM : bundleRevision_writeFile(cacheFile, content, (size_t)len);
+        free(content);
+    }
+    return status;
+}
+
 celix_status_t bundleRevision_getNumber(bundle_revision_pt revision, long *revisionNr) {
 	celix_status_t status = CELIX_SUCCESS;
     if (revision == NULL) {
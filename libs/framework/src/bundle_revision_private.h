@@ -34,6 +34,7 @@ struct bundleRevision {
 	char *root;
 	char *location;
 	manifest_pt manifest;
+	long long cacheKey; //key of the manifest and wiring cache (archive last modified time), -1 if not cached
 
 	array_list_pt libraryHandles;
 };
@@ -0,0 +1,399 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *  KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <libgen.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "celix_bundle_image.h"
+#include "celix_array_list.h"
+#include "celix_constants.h"
+#include "celix_log.h"
+#include "framework_private.h"
+#include "manifest.h"
+#include "archive.h"
+
+#define CELIX_BUNDLE_IMAGE_MAGIC "CELIXIMG"
+#define CELIX_BUNDLE_IMAGE_VERSION 1
+#define CELIX_BUNDLE_IMAGE_MAX_RUN_LEVEL 5
+
+/*
+ * Image layout (native endianness, the image is created on the target):
+ *  - header
+ *  - nrOfBundles entries
+ *  - per entry nrOfHeaders key/value pairs of string offsets
+ *  - string table (NUL terminated strings, the image ends with a NUL)
+ * All offsets are relative to the start of the image.
+ */
+typedef struct celix_bundle_image_header {
+    char magic[8];
+    uint32_t version;
+    uint32_t nrOfBundles;
+} celix_bundle_image_header_t;
+
+typedef struct celix_bundle_image_entry {
+    int64_t id;
+    int32_t runLevel;
+    uint32_t location;
+    uint32_t archiveRoot; //relative to the dir of the image file
+    uint32_t nrOfHeaders;
+    uint32_t headers;
+    uint32_t reserved;
+} celix_bundle_image_entry_t;
+
+typedef struct celix_bundle_image_pair {
+    uint32_t key;
+    uint32_t value;
+} celix_bundle_image_pair_t;
+
+struct celix_bundle_image {
+    char *imageDir;
+    void *data;
+    size_t size;
+    const celix_bundle_image_header_t *header;
+    const celix_bundle_image_entry_t *entries;
+};
+
+typedef struct celix_bundle_image_build_entry {
+    long id;
+    int runLevel;
+    char *location;
+    char *archiveRoot;
+    manifest_pt manifest;
+} celix_bundle_image_build_entry_t;
+
+static const char* celix_bundleImage_getConfig(const celix_properties_t *config, const char *name) {
+    const char *result = getenv(name); //note as for the framework, the environment overrides the config
+    return result != NULL ? result : celix_properties_get((celix_properties_t*)config, name, NULL);
+}
+
+static celix_status_t celix_bundleImage_mkdir(const char *dir) {
+    return mkdir(dir, S_IRWXU) == 0 || errno == EEXIST ? CELIX_SUCCESS : CELIX_FILE_IO_EXCEPTION;
+}
+
+static celix_status_t celix_bundleImage_extract(const char *imageFile, const char *bundlesDirName, celix_bundle_image_build_entry_t *entry) {
+    char *imageDir = strdup(imageFile);
+    char *archiveRoot = NULL;
+    char *revisionRoot = NULL;
+    char *manifestFile = NULL;
+    bool allocated = asprintf(&archiveRoot, "%s/%s/bundle%li", dirname(imageDir), bundlesDirName, entry->id) >= 0;
+    allocated = allocated && asprintf(&revisionRoot, "%s/version0.0", archiveRoot) >= 0;
+    allocated = allocated && asprintf(&manifestFile, "%s/META-INF/MANIFEST.MF", revisionRoot) >= 0;
+    allocated = allocated && asprintf(&entry->archiveRoot, "%s/bundle%li", bundlesDirName, entry->id) >= 0;
+    free(imageDir);
+
+    celix_status_t status = allocated ? CELIX_SUCCESS : CELIX_ENOMEM;
+    status = CELIX_DO_IF(status, celix_bundleImage_mkdir(archiveRoot));
+    status = CELIX_DO_IF(status, celix_bundleImage_mkdir(revisionRoot));
+    status = CELIX_DO_IF(status, extractBundle(entry->location, revisionRoot));
+    status = CELIX_DO_IF(status, manifest_create(&entry->manifest));
+    status = CELIX_DO_IF(status, manifest_read(entry->manifest, manifestFile));
+    free(manifestFile);
+    free(revisionRoot);
+    free(archiveRoot);
+    return status;
+}
+
+static uint32_t celix_bundleImage_addString(FILE *strings, long base, const char *str) {
+    uint32_t offset = (uint32_t)(base + ftell(strings));
+    fputs(str, strings);
+    fputc('\0', strings);
+    return offset;
+}
+
+static celix_status_t celix_bundleImage_write(const char *imageFile, celix_array_list_t *entries) {
+    size_t nrOfBundles = (size_t)celix_arrayList_size(entries);
+    size_t nrOfPairs = 0;
+    for (size_t i = 0; i < nrOfBundles; ++i) {
+        celix_bundle_image_build_entry_t *entry = celix_arrayList_get(entries, (int)i);
+        nrOfPairs += celix_properties_size(manifest_getMainAttributes(entry->manifest));
+    }
+
+    celix_bundle_image_header_t header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, CELIX_BUNDLE_IMAGE_MAGIC, sizeof(header.magic));
+    header.version = CELIX_BUNDLE_IMAGE_VERSION;
+    header.nrOfBundles = (uint32_t)nrOfBundles;
+
+    celix_bundle_image_entry_t *imageEntries = calloc(nrOfBundles + 1, sizeof(*imageEntries));
+    celix_bundle_image_pair_t *pairs = calloc(nrOfPairs + 1, sizeof(*pairs));
+    char *strBuf = NULL;
+    size_t strSize = 0;
+    FILE *strings = open_memstream(&strBuf, &strSize);
+    long pairsOffset = (long)(sizeof(header) + nrOfBundles * sizeof(*imageEntries));
+    long stringsOffset = (long)(pairsOffset + nrOfPairs * sizeof(*pairs));
+
+    size_t pairIndex = 0;
+    for (size_t i = 0; i < nrOfBundles; ++i) {
+        celix_bundle_image_build_entry_t *entry = celix_arrayList_get(entries, (int)i);
+        celix_properties_t *attributes = manifest_getMainAttributes(entry->manifest);
+        imageEntries[i].id = entry->id;
+        imageEntries[i].runLevel = entry->runLevel;
+        imageEntries[i].location = celix_bundleImage_addString(strings, stringsOffset, entry->location);
+        imageEntries[i].archiveRoot = celix_bundleImage_addString(strings, stringsOffset, entry->archiveRoot);
+        imageEntries[i].nrOfHeaders = (uint32_t)celix_properties_size(attributes);
+        imageEntries[i].headers = (uint32_t)(pairsOffset + pairIndex * sizeof(*pairs));
+        const char *key = NULL;
+        CELIX_PROPERTIES_FOR_EACH(attributes, key) {
+            pairs[pairIndex].key = celix_bundleImage_addString(strings, stringsOffset, key);
+            pairs[pairIndex].value = celix_bundleImage_addString(strings, stringsOffset, celix_properties_get(attributes, key, ""));
+            pairIndex += 1;
+        }
+    }
+    fputc('\0', strings); //the image always ends with a NUL, see celix_bundleImage_open
+    fclose(strings);
+
+    celix_status_t status = CELIX_SUCCESS;
+    char *tmpFile = NULL;
+    FILE *out = asprintf(&tmpFile, "%s~", imageFile) >= 0 ? fopen(tmpFile, "w") : NULL;
+    if (tmpFile == NULL) {
+        status = CELIX_ENOMEM;
+    } else if (out == NULL) {
+        status = CELIX_FILE_IO_EXCEPTION;
+    } else {
+        bool written = fwrite(&header, sizeof(header), 1, out) == 1;
+        written = written && fwrite(imageEntries, sizeof(*imageEntries), nrOfBundles, out) == nrOfBundles;
+        written = written && fwrite(pairs, sizeof(*pairs), nrOfPairs, out) == nrOfPairs;
+        written = written && fwrite(strBuf, 1, strSize, out) == strSize;
+        written = fclose(out) == 0 && written;
+        if (!written || rename(tmpFile, imageFile) != 0) {
+            remove(tmpFile);
+            status = CELIX_FILE_IO_EXCEPTION;
+        }
+    }
+
+    free(tmpFile);
+    free(strBuf);
+    free(pairs);
+    free(imageEntries);
+    return status;
+}
+
+celix_status_t celix_bundleImage_create(const char *imageFile, const celix_properties_t *config) {
+    const char* autoStartKeys[] = {CELIX_AUTO_START_0, CELIX_AUTO_START_1, CELIX_AUTO_START_2, CELIX_AUTO_START_3, CELIX_AUTO_START_4, CELIX_AUTO_START_5};
+    const char* cosgiKeys[] = {"cosgi.auto.start.0","cosgi.auto.start.1","cosgi.auto.start.2","cosgi.auto.start.3","cosgi.auto.start.4","cosgi.auto.start.5"};
+
+    const char *paths = celix_bundleImage_getConfig(config, CELIX_BUNDLES_PATH_NAME);
+    if (paths == NULL) {
+        paths = CELIX_BUNDLES_PATH_DEFAULT;
+    }
+
+    char *imageName = strdup(imageFile);
+    char *bundlesDirName = NULL;
+    char *bundlesDir = NULL;
+    bool allocated = asprintf(&bundlesDirName, "%s.bundles", basename(imageName)) >= 0;
+    allocated = allocated && asprintf(&bundlesDir, "%s.bundles", imageFile) >= 0;
+    free(imageName);
+    if (!allocated) {
+        free(bundlesDirName);
+        return CELIX_ENOMEM;
+    }
+
+    celix_status_t status = celix_bundleImage_mkdir(bundlesDir);
+    if (status != CELIX_SUCCESS) {
+        fw_log(logger, OSGI_FRAMEWORK_LOG_ERROR, "Cannot create bundle image dir %s", bundlesDir);
+    }
+
+    celix_array_list_t *entries = celix_arrayList_create();
+    long nextId = 1L; //note system bundle is 0, same ids as a sequential auto start install
+    for (int runLevel = 0; status == CELIX_SUCCESS && runLevel <= CELIX_BUNDLE_IMAGE_MAX_RUN_LEVEL; ++runLevel) {
+        const char *autoStart = celix_bundleImage_getConfig(config, autoStartKeys[runLevel]);
+        if (autoStart == NULL) {
+            autoStart = celix_bundleImage_getConfig(config, cosgiKeys[runLevel]);
+        }
+        if (autoStart == NULL) {
+            continue;
+        }
+        char *locations = strdup(autoStart);
+        char *savePtr = NULL;
+        for (char *location = strtok_r(locations, " ", &savePtr); status == CELIX_SUCCESS && location != NULL; location = strtok_r(NULL, " ", &savePtr)) {
+            char *resolved = fw_resolveBundleLocation(location, paths);
+            bool alreadyAdded = false;
+            for (int i = 0; resolved != NULL && i < celix_arrayList_size(entries); ++i) {
+                celix_bundle_image_build_entry_t *entry = celix_arrayList_get(entries, i);
+                alreadyAdded = alreadyAdded || strcmp(entry->location, resolved) == 0;
+            }
+            if (resolved == NULL) {
+                fw_log(logger, OSGI_FRAMEWORK_LOG_ERROR, "Cannot find bundle %s. Using %s=%s", location, CELIX_BUNDLES_PATH_NAME, paths);
+                status = CELIX_FILE_IO_EXCEPTION;
+            } else if (alreadyAdded) {
+                free(resolved);
+            } else {
+                celix_bundle_image_build_entry_t *entry = calloc(1, sizeof(*entry));
+                entry->id = nextId++;
+                entry->runLevel = runLevel;
+                entry->location = resolved;
+                celix_arrayList_add(entries, entry);
+                status = celix_bundleImage_extract(imageFile, bundlesDirName, entry);
+                if (status != CELIX_SUCCESS) {
+                    fw_log(logger, OSGI_FRAMEWORK_LOG_ERROR, "Cannot extract bundle %s into bundle image dir %s", resolved, bundlesDir);
+                }
+            }
+        }
+        free(locations);
+    }
+
+    if (status == CELIX_SUCCESS) {
+        status = celix_bundleImage_write(imageFile, entries);
+        framework_logIfError(logger, status, NULL, "Cannot write bundle image %s", imageFile);
+    }
+
+    for (int i = 0; i < celix_arrayList_size(entries); ++i) {
+        celix_bundle_image_build_entry_t *entry = celix_arrayList_get(entries, i);
+        manifest_destroy(entry->manifest);
+        free(entry->location);
+        free(entry->archiveRoot);
+        free(entry);
+    }
+    celix_arrayList_destroy(entries);
+    free(bundlesDir);
+    free(bundlesDirName);
+    return status;
+}
+
+static bool celix_bundleImage_isValidOffset(const celix_bundle_image_t *image, uint32_t offset) {
+    return offset < image->size;
+}
+
+static bool celix_bundleImage_validate(const celix_bundle_image_t *image) {
+    size_t size = image->size;
+    const celix_bundle_image_header_t *header = image->header;
+    if (size < sizeof(*header) + 1 || memcmp(header->magic, CELIX_BUNDLE_IMAGE_MAGIC, sizeof(header->magic)) != 0 ||
+            header->version != CELIX_BUNDLE_IMAGE_VERSION || ((const char*)image->data)[size - 1] != '\0') {
+        return false;
+    }
+    if (header->nrOfBundles > (size - sizeof(*header)) / sizeof(celix_bundle_image_entry_t)) {
+        return false;
+    }
+    for (size_t i = 0; i < header->nrOfBundles; ++i) {
+        const celix_bundle_image_entry_t *entry = &image->entries[i];
+        size_t pairsSize = (size_t)entry->nrOfHeaders * sizeof(celix_bundle_image_pair_t);
+        if (entry->runLevel < 0 || entry->runLevel > CELIX_BUNDLE_IMAGE_MAX_RUN_LEVEL || entry->id <= 0 ||
+                !celix_bundleImage_isValidOffset(image, entry->location) ||
+                !celix_bundleImage_isValidOffset(image, entry->archiveRoot) ||
+                entry->headers % sizeof(uint32_t) != 0 || entry->headers > size || pairsSize > size - entry->headers) {
+            return false;
+        }
+        const celix_bundle_image_pair_t *pairs = (const celix_bundle_image_pair_t*)((const char*)image->data + entry->headers);
+        for (size_t k = 0; k < entry->nrOfHeaders; ++k) {
+            if (!celix_bundleImage_isValidOffset(image, pairs[k].key) || !celix_bundleImage_isValidOffset(image, pairs[k].value)) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+celix_bundle_image_t* celix_bundleImage_open(const char *imageFile) {
+    int fd = open(imageFile, O_RDONLY);
+    if (fd < 0) {
+        fw_log(logger, OSGI_FRAMEWORK_LOG_ERROR, "Cannot open bundle image %s: %s", imageFile, strerror(errno));
+        return NULL;
+    }
+
+    celix_bundle_image_t *image = NULL;
+    struct stat st;
+    if (fstat(fd, &st) == 0 && st.st_size > 0) {
+        void *data = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (data != MAP_FAILED) {
+            image = calloc(1, sizeof(*image));
+            image->data = data;
+            image->size = (size_t)st.st_size;
+            image->header = data;
+            image->entries = (const celix_bundle_image_entry_t*)((const char*)data + sizeof(celix_bundle_image_header_t));
+            char *dir = strdup(imageFile);
+            image->imageDir = strdup(dirname(dir));
+            free(dir);
+        }
+    }
+    close(fd); //note the mapping stays valid
+
+    if (image != NULL && !celix_bundleImage_validate(image)) {
+        fw_log(logger, OSGI_FRAMEWORK_LOG_ERROR, "%s is not a valid bundle image", imageFile);
+        celix_bundleImage_close(image);
+        image = NULL;
+    } else if (image == NULL) {
+        fw_log(logger, OSGI_FRAMEWORK_LOG_ERROR, "Cannot map bundle image %s", imageFile);
+    }
+    return image;
+}
+
+void celix_bundleImage_close(celix_bundle_image_t *image) {
+    if (image != NULL) {
+        munmap(image->data, image->size);
+        free(image->imageDir);
+        free(image);
+    }
+}
+
+size_t celix_bundleImage_getNumberOfBundles(const celix_bundle_image_t *image) {
+    return image->header->nrOfBundles;
+}
+
+long celix_bundleImage_getBundleId(const celix_bundle_image_t *image, size_t index) {
+    return (long)image->entries[index].id;
+}
+
+int celix_bundleImage_getRunLevel(const celix_bundle_image_t *image, size_t index) {
+    return image->entries[index].runLevel;
+}
+
+const char* celix_bundleImage_getLocation(const celix_bundle_image_t *image, size_t index) {
+    return (const char*)image->data + image->entries[index].location;
+}
+
+long celix_bundleImage_getHighestBundleId(const celix_bundle_image_t *image) {
+    long highest = 0;
+    for (size_t i = 0; i < image->header->nrOfBundles; ++i) {
+        long id = celix_bundleImage_getBundleId(image, i);
+        highest = id > highest ? id : highest;
+    }
+    return highest;
+}
+
+celix_status_t celix_bundleImage_createArchive(const celix_bundle_image_t *image, size_t index, bundle_archive_pt *archive) {
+    const celix_bundle_image_entry_t *entry = &image->entries[index];
+    const char *data = image->data;
+
+    manifest_pt manifest = NULL;
+    celix_status_t status = manifest_create(&manifest);
+    if (status == CELIX_SUCCESS) {
+        const celix_bundle_image_pair_t *pairs = (const celix_bundle_image_pair_t*)(data + entry->headers);
+        celix_properties_t *attributes = manifest_getMainAttributes(manifest);
+        for (size_t i = 0; i < entry->nrOfHeaders; ++i) {
+            celix_properties_set(attributes, data + pairs[i].key, data + pairs[i].value);
+        }
+
+        char *archiveRoot = NULL;
+        if (asprintf(&archiveRoot, "%s/%s", image->imageDir, data + entry->archiveRoot) < 0) {
+            manifest_destroy(manifest);
+            return CELIX_ENOMEM;
+        }
+        status = bundleArchive_createSealed(archiveRoot, (long)entry->id, data + entry->location, manifest, archive);
+        free(archiveRoot);
+    }
+    return status;
+}
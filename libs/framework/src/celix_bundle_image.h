@@ -0,0 +1,75 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *  KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#ifndef CELIX_CELIX_BUNDLE_IMAGE_H
+#define CELIX_CELIX_BUNDLE_IMAGE_H
+
+#include <stddef.h>
+
+#include "celix_errno.h"
+#include "celix_properties.h"
+#include "bundle_archive.h"
+
+/**
+ * A sealed bundle image contains the bundles of the CELIX_AUTO_START_x lists of a configuration, pre-extracted in
+ * a directory next to the image file (<image>.bundles), and their bundle ids, run levels, locations and manifest
+ * headers in a single file which is mapped in memory at boot.
+ *
+ * Booting from an image (see CELIX_BUNDLE_IMAGE_NAME) skips the bundle zip extraction, the manifest file parsing and
+ * the bundle cache scan.
+ */
+typedef struct celix_bundle_image celix_bundle_image_t;
+
+/**
+ * Creates a bundle image for the CELIX_AUTO_START_x lists of the provided config (environment variables override
+ * config entries, as for the framework).
+ * The bundles are extracted in the <imageFile>.bundles directory, which should be empty or not exist.
+ */
+celix_status_t celix_bundleImage_create(const char *imageFile, const celix_properties_t *config);
+
+/**
+ * Maps the provided image file. Returns NULL if the file cannot be mapped or is not a valid bundle image.
+ */
+celix_bundle_image_t* celix_bundleImage_open(const char *imageFile);
+
+void celix_bundleImage_close(celix_bundle_image_t *image);
+
+size_t celix_bundleImage_getNumberOfBundles(const celix_bundle_image_t *image);
+
+long celix_bundleImage_getBundleId(const celix_bundle_image_t *image, size_t index);
+
+/**
+ * Returns the auto start run level (0 - 5) of the bundle.
+ */
+int celix_bundleImage_getRunLevel(const celix_bundle_image_t *image, size_t index);
+
+const char* celix_bundleImage_getLocation(const celix_bundle_image_t *image, size_t index);
+
+/**
+ * Returns the highest bundle id in the image, or 0 if the image is empty.
+ */
+long celix_bundleImage_getHighestBundleId(const celix_bundle_image_t *image);
+
+/**
+ * Creates a sealed bundle archive for the bundle, using the pre-extracted bundle and the manifest headers
+ * stored in the image.
+ */
+celix_status_t celix_bundleImage_createArchive(const celix_bundle_image_t *image, size_t index, bundle_archive_pt *archive);
+
+#endif //CELIX_CELIX_BUNDLE_IMAGE_H
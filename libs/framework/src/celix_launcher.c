@@ -44,6 +44,7 @@
 #include "celix_launcher.h"
 #include "framework.h"
 #include "linked_list_iterator.h"
+#include "celix_bundle_image.h"
 
 static void show_usage(char* prog_name);
 static void show_properties(celix_properties_t *embeddedProps, const char *configFile);
@@ -51,6 +52,7 @@ static void shutdown_framework(int signal);
 static void ignore(int signal);
 
 static int celixLauncher_launchWithConfigAndProps(const char *configFile, framework_pt *framework, properties_pt packedConfig);
+static int celixLauncher_createBundleImage(const char *configFile, const char *imageFile, properties_pt packedConfig);
 
 static void combine_properties(celix_properties_t *original, const celix_properties_t *append);
 
@@ -69,6 +71,7 @@ int celixLauncher_launchAndWaitForShutdown(int argc, char *argv[], properties_pt
 	}
 
 	char *config_file = NULL;
+	char *imageFile = NULL;
 	bool showProps = false;
 	for (int i = 1; i < argc; ++i) {
 		opt = argv[i];
@@ -79,6 +82,8 @@ int celixLauncher_launchAndWaitForShutdown(int argc, char *argv[], properties_pt
 			return 0;
 		} else if (strncmp("-p", opt, strlen("-p")) == 0 || strncmp("--props", opt, strlen("--props")) == 0) {
 			showProps = true;
+		} else if ((strcmp("-c", opt) == 0 || strcmp("--create-image", opt) == 0) && i + 1 < argc) {
+			imageFile = argv[++i];
 		} else {
 			config_file = opt;
 		}
@@ -98,6 +103,10 @@ int celixLauncher_launchAndWaitForShutdown(int argc, char *argv[], properties_pt
 		return 0;
 	}
 
+	if (imageFile != NULL) {
+		return celixLauncher_createBundleImage(config_file, imageFile, packedConfig);
+	}
+
 	struct sigaction sigact;
 	memset(&sigact, 0, sizeof(sigact));
 	sigact.sa_handler = shutdown_framework;
@@ -120,10 +129,11 @@ int celixLauncher_launchAndWaitForShutdown(int argc, char *argv[], properties_pt
 }
 
 static void show_usage(char* prog_name) {
-	printf("Usage:\n  %s [-h|-p] [path/to/runtime/config.properties]\n", basename(prog_name));
+	printf("Usage:\n  %s [-h|-p|-c <image>] [path/to/runtime/config.properties]\n", basename(prog_name));
 	printf("Options:\n");
 	printf("\t-h | --help: Show this message\n");
 	printf("\t-p | --props: Show the embedded and runtime properties for this celix container\n");
+	printf("\t-c | --create-image <image>: Extract the auto start bundles into a sealed bundle image, to boot from with CELIX_BUNDLE_IMAGE=<image>\n");
 	printf("\n");
 }
 
@@ -157,6 +167,24 @@ static int celixLauncher_launchWithConfigAndProps(const char *configFile, framew
 	return celixLauncher_launchWithProperties(packedConfig, framework);
 }
 
+static int celixLauncher_createBundleImage(const char *configFile, const char *imageFile, properties_pt packedConfig) {
+	FILE *config = fopen(configFile, "r");
+	if (config != NULL) {
+		celix_properties_t *configProps = celix_properties_loadWithStream(config);
+		fclose(config);
+		combine_properties(packedConfig, configProps);
+		celix_properties_destroy(configProps);
+	}
+
+	celix_status_t status = celix_bundleImage_create(imageFile, packedConfig);
+	if (status == CELIX_SUCCESS) {
+		printf("Created bundle image %s\n", imageFile);
+	} else {
+		printf("Could not create bundle image %s\n", imageFile);
+	}
+	celix_properties_destroy(packedConfig);
+	return status == CELIX_SUCCESS ? 0 : 1;
+}
 
 int celixLauncher_launchWithProperties(properties_pt config, framework_pt *framework) {
 	celix_status_t status;
@@ -17,9 +17,88 @@
  * under the License.
  */
 
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <errno.h>
+#include <sys/stat.h>
+#include <dlfcn.h>
+
 #include "celix_constants.h"
 #include "celix_library_loader.h"
-#include <dlfcn.h>
+#include "utils.h"
+
+static pthread_mutex_t g_sharedLibraryStoreMutex = PTHREAD_MUTEX_INITIALIZER;
+
+/**
+ * Publishes the library content in the shared library store. The content is written to a temporary file which is
+ * renamed to the store path, so other processes never see a partially written library.
+ */
+static bool celix_libloader_publishShared(const char *storeDir, const char *sharedPath, const void *data, size_t length) {
+    if (mkdir(storeDir, 0755) != 0 && errno != EEXIST) {
+        return false;
+    }
+    char *tmpPath = NULL;
+    asprintf(&tmpPath, "%s/.tmp-XXXXXX", storeDir);
+    int fd = mkstemp(tmpPath);
+    bool published = false;
+    if (fd >= 0) {
+        const char *c = data;
+        size_t written = 0;
+        while (written < length) {
+            ssize_t rc = write(fd, c + written, length - written);
+            if (rc <= 0) {
+                break;
+            }
+            written += (size_t)rc;
+        }
+        //note read-only, the stored libraries are shared by all processes
+        published = written == length && fchmod(fd, 0444) == 0;
+        close(fd);
+        published = published && rename(tmpPath, sharedPath) == 0;
+        if (!published) {
+            unlink(tmpPath);
+        }
+    }
+    free(tmpPath);
+    return published;
+}
+
+/**
+ * Returns the path of an identical copy of the library in the shared library store, publishing the library if needed.
+ * The store is content addressed: the file name is the hash and size of the content followed by the library name.
+ * Because the hash is not collision free, the content of an existing store entry is compared with the library.
+ * Returns NULL if the library cannot be shared.
+ */
+static char* celix_libloader_getSharedPath(const char *storeDir, const char *libPath) {
+    const void *data = NULL;
+    size_t length = 0;
+    if (utils_mapFile(libPath, &data, &length) != CELIX_SUCCESS || length == 0) {
+        return NULL;
+    }
+    const char *name = strrchr(libPath, '/');
+    name = name == NULL ? libPath : name + 1;
+    char *sharedPath = NULL;
+    asprintf(&sharedPath, "%s/%08x-%zu-%s", storeDir, utils_fastHashBytes(data, length), length, name);
+
+    bool shared = false;
+    const void *sharedData = NULL;
+    size_t sharedLength = 0;
+    if (utils_mapFile(sharedPath, &sharedData, &sharedLength) == CELIX_SUCCESS) {
+        shared = sharedLength == length && memcmp(sharedData, data, length) == 0;
+        utils_unmapFile(sharedData, sharedLength);
+    } else {
+        shared = celix_libloader_publishShared(storeDir, sharedPath, data, length);
+    }
+    utils_unmapFile(data, length);
+
+    if (!shared) {
+        free(sharedPath);
+        sharedPath = NULL;
+    }
+    return sharedPath;
+}
 
 celix_library_handle_t* celix_libloader_open(celix_bundle_context_t *ctx, const char *libPath) {
 #if defined(DEBUG) && !defined(ANDROID)
@@ -28,11 +107,39 @@ celix_library_handle_t* celix_libloader_open(celix_bundle_context_t *ctx, const
     bool def = false;
 #endif
     bool noDelete = celix_bundleContext_getPropertyAsBool(ctx, CELIX_LOAD_BUNDLES_WITH_NODELETE, def);
+    bool immediate = celix_bundleContext_getPropertyAsBool(ctx, CELIX_LOAD_BUNDLES_WITH_IMMEDIATE_BINDING, false);
+    int flags = (immediate ? RTLD_NOW : RTLD_LAZY) | RTLD_LOCAL;
     if (noDelete) {
-        return dlopen(libPath, RTLD_LAZY|RTLD_LOCAL|RTLD_NODELETE);
-    } else {
-        return dlopen(libPath, RTLD_LAZY|RTLD_LOCAL);
+        flags |= RTLD_NODELETE;
+    }
+
+    const char *storeDir = celix_bundleContext_getProperty(ctx, CELIX_SHARED_LIBRARY_STORE_NAME, NULL);
+    if (storeDir != NULL && strlen(storeDir) > 0) {
+        celix_library_handle_t *handle = NULL;
+        pthread_mutex_lock(&g_sharedLibraryStoreMutex);
+        char *sharedPath = celix_libloader_getSharedPath(storeDir, libPath);
+        if (sharedPath != NULL) {
+            celix_library_handle_t *loaded = dlopen(sharedPath, RTLD_LAZY | RTLD_NOLOAD);
+            if (loaded != NULL) {
+                //note already loaded in this process (e.g. the same bundle installed in another framework). The
+                //dynamic loader would return the same instance, so use the own (extracted) copy to keep the
+                //globals of the bundle library separated.
+                dlclose(loaded);
+            } else {
+                handle = dlopen(sharedPath, flags);
+            }
+            free(sharedPath);
+        }
+        pthread_mutex_unlock(&g_sharedLibraryStoreMutex);
+        if (handle != NULL) {
+            return handle;
+        }
     }
+    return dlopen(libPath, flags);
+}
+
+celix_library_handle_t* celix_libloader_openGlobal(const char *libPath) {
+    return dlopen(libPath, RTLD_LAZY|RTLD_GLOBAL);
 }
 
 
@@ -25,6 +25,11 @@
 typedef void celix_library_handle_t;
 
 celix_library_handle_t* celix_libloader_open(celix_bundle_context_t *ctx, const char *libPath);
+
+/**
+ * Opens a (dependency) library with global symbol visibility, see CELIX_PRELOAD_LIBRARIES_NAME.
+ */
+celix_library_handle_t* celix_libloader_openGlobal(const char *libPath);
 void celix_libloader_close(celix_library_handle_t *handle);
 void* celix_libloader_getSymbol(celix_library_handle_t *handle, const char *name);
 const char* celix_libloader_getLastError();
@@ -0,0 +1,486 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *  KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "celix_scheduler.h"
+#include "celix_array_list.h"
+#include "celix_bundle.h"
+#include "celix_threads.h"
+#include "hash_map.h"
+
+#define CELIX_SCHEDULER_WHEEL_SIZE 256 //must be a power of 2
+#define CELIX_SCHEDULER_WHEEL_MASK (CELIX_SCHEDULER_WHEEL_SIZE - 1)
+#define CELIX_SCHEDULER_NO_WAKEUP UINT64_MAX
+
+typedef enum celix_scheduler_event_state {
+    CELIX_SCHEDULER_EVENT_IN_WHEEL,
+    CELIX_SCHEDULER_EVENT_READY,
+    CELIX_SCHEDULER_EVENT_RUNNING
+} celix_scheduler_event_state_e;
+
+typedef struct celix_scheduler_event {
+    long id;
+    long bndId;
+    uint64_t deadlineTick;
+    uint64_t intervalTicks; //0 for one-shot events
+    void *callbackData;
+    void (*callback)(void *data);
+
+    celix_scheduler_event_state_e state;
+    celix_thread_t runningThread; //only valid if state is running
+    bool cancelled;
+    bool cancelWaiting; //true if a (not callback) thread waits for the running callback and will free the event
+
+    struct celix_scheduler_event *prev; //wheel slot list
+    struct celix_scheduler_event *next;
+} celix_scheduler_event_t;
+
+typedef struct celix_scheduler_bundle_service {
+    celix_scheduler_t *scheduler;
+    long bndId;
+    size_t useCount;
+    celix_scheduler_service_t service;
+} celix_scheduler_bundle_service_t;
+
+struct celix_scheduler {
+    framework_logger_pt logger;
+    long nrOfThreads;
+    uint64_t tickInNs;
+    celix_service_factory_t factory;
+
+    celix_thread_mutex_t mutex; //protects the fields below
+    celix_thread_cond_t timerCond; //signalled if the timer thread needs to wake up earlier
+    celix_thread_cond_t workCond; //signalled if an event is ready
+    celix_thread_cond_t doneCond; //broadcast if a callback is done
+    bool active;
+    bool started; //true if the timer and worker threads are created
+    celix_thread_t timerThread;
+    celix_array_list_t *workers; //value = celix_thread_t*
+    long nextEventId;
+    uint64_t currentTick; //all events with a deadline <= currentTick are handed to the workers
+    uint64_t wakeupTick; //tick the timer thread sleeps till
+    celix_scheduler_event_t *wheel[CELIX_SCHEDULER_WHEEL_SIZE];
+    size_t nrOfWheelEvents;
+    celix_array_list_t *ready; //value = celix_scheduler_event_t*, FIFO
+    hash_map_t *events; //key = event id, value = celix_scheduler_event_t*
+    hash_map_t *services; //key = bundle id, value = celix_scheduler_bundle_service_t*
+};
+
+static uint64_t celix_scheduler_nowInNs(void) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint64_t)now.tv_sec * 1000000000ULL + (uint64_t)now.tv_nsec;
+}
+
+static uint64_t celix_scheduler_nowTick(celix_scheduler_t *scheduler) {
+    return celix_scheduler_nowInNs() / scheduler->tickInNs;
+}
+
+static uint64_t celix_scheduler_secondsToTicks(celix_scheduler_t *scheduler, double seconds) {
+    if (seconds <= 0) {
+        return 0;
+    }
+    uint64_t ns = (uint64_t)(seconds * 1E9);
+    return (ns + scheduler->tickInNs - 1) / scheduler->tickInNs; //round up, an event is never called too early
+}
+
+/**
+ * Returns the first tick starting at or after now + delayInSeconds.
+ */
+static uint64_t celix_scheduler_deadlineTick(celix_scheduler_t *scheduler, double delayInSeconds) {
+    uint64_t deadlineInNs = celix_scheduler_nowInNs() + (delayInSeconds <= 0 ? 0 : (uint64_t)(delayInSeconds * 1E9));
+    return (deadlineInNs + scheduler->tickInNs - 1) / scheduler->tickInNs;
+}
+
+static void celix_scheduler_addToWheel(celix_scheduler_t *scheduler, celix_scheduler_event_t *event) {
+    if (event->deadlineTick <= scheduler->currentTick) {
+        event->deadlineTick = scheduler->currentTick + 1;
+    }
+    celix_scheduler_event_t **slot = &scheduler->wheel[event->deadlineTick & CELIX_SCHEDULER_WHEEL_MASK];
+    event->state = CELIX_SCHEDULER_EVENT_IN_WHEEL;
+    event->prev = NULL;
+    event->next = *slot;
+    if (*slot != NULL) {
+        (*slot)->prev = event;
+    }
+    *slot = event;
+    scheduler->nrOfWheelEvents += 1;
+    if (event->deadlineTick < scheduler->wakeupTick) {
+        scheduler->wakeupTick = event->deadlineTick;
+        celixThreadCondition_signal(&scheduler->timerCond);
+    }
+}
+
+static void celix_scheduler_removeFromWheel(celix_scheduler_t *scheduler, celix_scheduler_event_t *event) {
+    if (event->prev != NULL) {
+        event->prev->next = event->next;
+    } else {
+        scheduler->wheel[event->deadlineTick & CELIX_SCHEDULER_WHEEL_MASK] = event->next;
+    }
+    if (event->next != NULL) {
+        event->next->prev = event->prev;
+    }
+    event->prev = NULL;
+    event->next = NULL;
+    scheduler->nrOfWheelEvents -= 1;
+}
+
+/**
+ * Moves the events with a deadline <= nowTick from the wheel to the ready queue.
+ */
+static void celix_scheduler_advance(celix_scheduler_t *scheduler, uint64_t nowTick) {
+    if (nowTick <= scheduler->currentTick) {
+        return;
+    }
+    uint64_t span = nowTick - scheduler->currentTick;
+    span = span > CELIX_SCHEDULER_WHEEL_SIZE ? CELIX_SCHEDULER_WHEEL_SIZE : span;
+    size_t nrOfReady = 0;
+    for (uint64_t i = 1; i <= span && scheduler->nrOfWheelEvents > 0; ++i) {
+        celix_scheduler_event_t *event = scheduler->wheel[(scheduler->currentTick + i) & CELIX_SCHEDULER_WHEEL_MASK];
+        while (event != NULL) {
+            celix_scheduler_event_t *next = event->next;
+            if (event->deadlineTick <= nowTick) {
+                celix_scheduler_removeFromWheel(scheduler, event);
+                event->state = CELIX_SCHEDULER_EVENT_READY;
+                celix_arrayList_add(scheduler->ready, event);
+                nrOfReady += 1;
+            }
+            event = next;
+        }
+    }
+    scheduler->currentTick = nowTick;
+    if (nrOfReady == 1) {
+        celixThreadCondition_signal(&scheduler->workCond);
+    } else if (nrOfReady > 1) {
+        celixThreadCondition_broadcast(&scheduler->workCond);
+    }
+}
+
+/**
+ * Returns the earliest deadline in the wheel. The slots of the coming revolution are checked in order,
+ * only if there are no events due within a revolution all events are checked.
+ */
+static uint64_t celix_scheduler_earliestDeadline(celix_scheduler_t *scheduler) {
+    if (scheduler->nrOfWheelEvents == 0) {
+        return CELIX_SCHEDULER_NO_WAKEUP;
+    }
+    for (uint64_t tick = scheduler->currentTick + 1; tick <= scheduler->currentTick + CELIX_SCHEDULER_WHEEL_SIZE; ++tick) {
+        for (celix_scheduler_event_t *event = scheduler->wheel[tick & CELIX_SCHEDULER_WHEEL_MASK]; event != NULL; event = event->next) {
+            if (event->deadlineTick == tick) {
+                return tick;
+            }
+        }
+    }
+    uint64_t earliest = CELIX_SCHEDULER_NO_WAKEUP;
+    for (int i = 0; i < CELIX_SCHEDULER_WHEEL_SIZE; ++i) {
+        for (celix_scheduler_event_t *event = scheduler->wheel[i]; event != NULL; event = event->next) {
+            earliest = event->deadlineTick < earliest ? event->deadlineTick : earliest;
+        }
+    }
+    return earliest;
+}
+
+static void* celix_scheduler_timerThread(void *data) {
+    celix_scheduler_t *scheduler = data;
+    celixThreadMutex_lock(&scheduler->mutex);
+    while (scheduler->active) {
+        celix_scheduler_advance(scheduler, celix_scheduler_nowTick(scheduler));
+        scheduler->wakeupTick = celix_scheduler_earliestDeadline(scheduler);
+        if (scheduler->wakeupTick == CELIX_SCHEDULER_NO_WAKEUP) {
+            celixThreadCondition_wait(&scheduler->timerCond, &scheduler->mutex);
+        } else {
+            uint64_t wakeupInNs = scheduler->wakeupTick * scheduler->tickInNs;
+            uint64_t nowInNs = celix_scheduler_nowInNs();
+            if (wakeupInNs > nowInNs) {
+                uint64_t waitInNs = wakeupInNs - nowInNs;
+                celixThreadCondition_timedwaitRelative(&scheduler->timerCond, &scheduler->mutex, (long)(waitInNs / 1000000000ULL), (long)(waitInNs % 1000000000ULL));
+            }
+        }
+    }
+    celixThreadMutex_unlock(&scheduler->mutex);
+    return NULL;
+}
+
+static void* celix_scheduler_workerThread(void *data) {
+    celix_scheduler_t *scheduler = data;
+    celixThreadMutex_lock(&scheduler->mutex);
+    for (;;) {
+        while (scheduler->active && celix_arrayList_size(scheduler->ready) == 0) {
+            celixThreadCondition_wait(&scheduler->workCond, &scheduler->mutex);
+        }
+        if (!scheduler->active) {
+            break;
+        }
+        celix_scheduler_event_t *event = celix_arrayList_get(scheduler->ready, 0);
+        celix_arrayList_removeAt(scheduler->ready, 0);
+        event->state = CELIX_SCHEDULER_EVENT_RUNNING;
+        event->runningThread = celixThread_self();
+        celixThreadMutex_unlock(&scheduler->mutex);
+
+        event->callback(event->callbackData);
+
+        celixThreadMutex_lock(&scheduler->mutex);
+        if (event->cancelled) {
+            //note already removed from the events map by the cancel
+            if (event->cancelWaiting) {
+                event->state = CELIX_SCHEDULER_EVENT_READY; //i.e. not running anymore, freed by the waiting cancel
+                celixThreadCondition_broadcast(&scheduler->doneCond);
+            } else {
+                free(event);
+            }
+        } else if (event->intervalTicks > 0) {
+            //fixed rate, but missed periods are skipped
+            uint64_t nowTick = celix_scheduler_nowTick(scheduler);
+            event->deadlineTick += event->intervalTicks;
+            if (event->deadlineTick <= nowTick) {
+                event->deadlineTick += ((nowTick - event->deadlineTick) / event->intervalTicks + 1) * event->intervalTicks;
+            }
+            celix_scheduler_addToWheel(scheduler, event);
+        } else {
+            hashMap_remove(scheduler->events, (void*)event->id);
+            free(event);
+        }
+    }
+    celixThreadMutex_unlock(&scheduler->mutex);
+    return NULL;
+}
+
+/**
+ * Creates the timer and worker threads. Should be called with the mutex locked.
+ */
+static bool celix_scheduler_startThreads(celix_scheduler_t *scheduler) {
+    if (scheduler->started) {
+        return true;
+    }
+    scheduler->currentTick = celix_scheduler_nowTick(scheduler);
+    if (celixThread_create(&scheduler->timerThread, NULL, celix_scheduler_timerThread, scheduler) != CELIX_SUCCESS) {
+        fw_log(scheduler->logger, OSGI_FRAMEWORK_LOG_ERROR, "Cannot create scheduler timer thread");
+        return false;
+    }
+    celixThread_setName(&scheduler->timerThread, "CelixTimer");
+    scheduler->started = true;
+    for (long i = 0; i < scheduler->nrOfThreads; ++i) {
+        celix_thread_t *worker = malloc(sizeof(*worker));
+        if (celixThread_create(worker, NULL, celix_scheduler_workerThread, scheduler) == CELIX_SUCCESS) {
+            celixThread_setName(worker, "CelixScheduler");
+            celix_arrayList_add(scheduler->workers, worker);
+        } else {
+            fw_log(scheduler->logger, OSGI_FRAMEWORK_LOG_ERROR, "Cannot create scheduler worker thread");
+            free(worker);
+        }
+    }
+    return true;
+}
+
+long celix_scheduler_schedule(celix_scheduler_t *scheduler, long bndId, double delayInSeconds, double intervalInSeconds, void *callbackData, void (*callback)(void *data)) {
+    if (callback == NULL || intervalInSeconds < 0) {
+        return -1;
+    }
+    uint64_t intervalTicks = celix_scheduler_secondsToTicks(scheduler, intervalInSeconds);
+    if (intervalInSeconds > 0 && intervalTicks == 0) {
+        intervalTicks = 1;
+    }
+
+    long eventId = -1;
+    celixThreadMutex_lock(&scheduler->mutex);
+    if (scheduler->active && celix_scheduler_startThreads(scheduler)) {
+        celix_scheduler_event_t *event = calloc(1, sizeof(*event));
+        event->id = scheduler->nextEventId++;
+        event->bndId = bndId;
+        event->deadlineTick = celix_scheduler_deadlineTick(scheduler, delayInSeconds);
+        event->intervalTicks = intervalTicks;
+        event->callbackData = callbackData;
+        event->callback = callback;
+        hashMap_put(scheduler->events, (void*)event->id, event);
+        celix_scheduler_addToWheel(scheduler, event);
+        eventId = event->id;
+    }
+    celixThreadMutex_unlock(&scheduler->mutex);
+    return eventId;
+}
+
+bool celix_scheduler_cancel(celix_scheduler_t *scheduler, long bndId, long eventId) {
+    celixThreadMutex_lock(&scheduler->mutex);
+    celix_scheduler_event_t *event = hashMap_get(scheduler->events, (void*)eventId);
+    if (event == NULL || event->bndId != bndId) {
+        celixThreadMutex_unlock(&scheduler->mutex);
+        return false;
+    }
+    hashMap_remove(scheduler->events, (void*)eventId);
+    event->cancelled = true;
+    if (event->state == CELIX_SCHEDULER_EVENT_IN_WHEEL) {
+        celix_scheduler_removeFromWheel(scheduler, event);
+        free(event);
+    } else if (event->state == CELIX_SCHEDULER_EVENT_READY) {
+        celix_arrayList_remove(scheduler->ready, event);
+        free(event);
+    } else if (!celixThread_equals(event->runningThread, celixThread_self())) {
+        event->cancelWaiting = true;
+        while (event->state == CELIX_SCHEDULER_EVENT_RUNNING) {
+            celixThreadCondition_wait(&scheduler->doneCond, &scheduler->mutex);
+        }
+        free(event);
+    } //else cancelled from its own callback, the event is freed by the worker when the callback returns
+    celixThreadMutex_unlock(&scheduler->mutex);
+    return true;
+}
+
+size_t celix_scheduler_cancelAllFor(celix_scheduler_t *scheduler, long bndId) {
+    celix_array_list_t *ids = celix_arrayList_create();
+    celixThreadMutex_lock(&scheduler->mutex);
+    hash_map_iterator_t iter = hashMapIterator_construct(scheduler->events);
+    while (hashMapIterator_hasNext(&iter)) {
+        celix_scheduler_event_t *event = hashMapIterator_nextValue(&iter);
+        if (event->bndId == bndId) {
+            celix_arrayList_addLong(ids, event->id);
+        }
+    }
+    celixThreadMutex_unlock(&scheduler->mutex);
+
+    size_t count = 0;
+    for (int i = 0; i < celix_arrayList_size(ids); ++i) {
+        if (celix_scheduler_cancel(scheduler, bndId, celix_arrayList_getLong(ids, i))) {
+            count += 1;
+        }
+    }
+    celix_arrayList_destroy(ids);
+    if (count > 0) {
+        fw_log(scheduler->logger, OSGI_FRAMEWORK_LOG_DEBUG, "Cancelled %zu scheduled events of bundle %li", count, bndId);
+    }
+    return count;
+}
+
+static long celix_scheduler_scheduleOnceForBundle(void *handle, double delayInSeconds, void *callbackData, void (*callback)(void *data)) {
+    celix_scheduler_bundle_service_t *svc = handle;
+    return celix_scheduler_schedule(svc->scheduler, svc->bndId, delayInSeconds, 0, callbackData, callback);
+}
+
+static long celix_scheduler_schedulePeriodicForBundle(void *handle, double initialDelayInSeconds, double intervalInSeconds, void *callbackData, void (*callback)(void *data)) {
+    celix_scheduler_bundle_service_t *svc = handle;
+    if (intervalInSeconds <= 0) {
+        return -1;
+    }
+    return celix_scheduler_schedule(svc->scheduler, svc->bndId, initialDelayInSeconds, intervalInSeconds, callbackData, callback);
+}
+
+static bool celix_scheduler_cancelForBundle(void *handle, long eventId) {
+    celix_scheduler_bundle_service_t *svc = handle;
+    return celix_scheduler_cancel(svc->scheduler, svc->bndId, eventId);
+}
+
+static void* celix_scheduler_getService(void *handle, const celix_bundle_t *requestingBundle, const celix_properties_t *svcProperties __attribute__((unused))) {
+    celix_scheduler_t *scheduler = handle;
+    long bndId = celix_bundle_getId(requestingBundle);
+    celixThreadMutex_lock(&scheduler->mutex);
+    celix_scheduler_bundle_service_t *svc = hashMap_get(scheduler->services, (void*)bndId);
+    if (svc == NULL) {
+        svc = calloc(1, sizeof(*svc));
+        svc->scheduler = scheduler;
+        svc->bndId = bndId;
+        svc->service.handle = svc;
+        svc->service.scheduleOnce = celix_scheduler_scheduleOnceForBundle;
+        svc->service.schedulePeriodic = celix_scheduler_schedulePeriodicForBundle;
+        svc->service.cancel = celix_scheduler_cancelForBundle;
+        hashMap_put(scheduler->services, (void*)bndId, svc);
+    }
+    svc->useCount += 1;
+    celixThreadMutex_unlock(&scheduler->mutex);
+    return &svc->service;
+}
+
+static void celix_scheduler_ungetService(void *handle, const celix_bundle_t *requestingBundle, const celix_properties_t *svcProperties __attribute__((unused))) {
+    celix_scheduler_t *scheduler = handle;
+    long bndId = celix_bundle_getId(requestingBundle);
+    celixThreadMutex_lock(&scheduler->mutex);
+    celix_scheduler_bundle_service_t *svc = hashMap_get(scheduler->services, (void*)bndId);
+    if (svc != NULL) {
+        svc->useCount -= 1;
+        if (svc->useCount == 0) {
+            hashMap_remove(scheduler->services, (void*)bndId);
+            free(svc);
+        }
+    }
+    celixThreadMutex_unlock(&scheduler->mutex);
+}
+
+celix_scheduler_t* celix_scheduler_create(framework_logger_pt logger, long nrOfThreads, double tickInSeconds) {
+    celix_scheduler_t *scheduler = calloc(1, sizeof(*scheduler));
+    scheduler->logger = logger;
+    scheduler->nrOfThreads = nrOfThreads < 1 ? 1 : nrOfThreads;
+    scheduler->tickInNs = tickInSeconds <= 0 ? 1 : (uint64_t)(tickInSeconds * 1E9);
+    scheduler->tickInNs = scheduler->tickInNs == 0 ? 1 : scheduler->tickInNs;
+    scheduler->factory.handle = scheduler;
+    scheduler->factory.getService = celix_scheduler_getService;
+    scheduler->factory.ungetService = celix_scheduler_ungetService;
+    celixThreadMutex_create(&scheduler->mutex, NULL);
+    celixThreadCondition_init(&scheduler->timerCond, NULL);
+    celixThreadCondition_init(&scheduler->workCond, NULL);
+    celixThreadCondition_init(&scheduler->doneCond, NULL);
+    scheduler->active = true;
+    scheduler->started = false;
+    scheduler->workers = celix_arrayList_create();
+    scheduler->wakeupTick = CELIX_SCHEDULER_NO_WAKEUP;
+    scheduler->ready = celix_arrayList_create();
+    scheduler->events = hashMap_create(NULL, NULL, NULL, NULL);
+    scheduler->services = hashMap_create(NULL, NULL, NULL, NULL);
+    return scheduler;
+}
+
+void celix_scheduler_destroy(celix_scheduler_t *scheduler) {
+    if (scheduler == NULL) {
+        return;
+    }
+    celixThreadMutex_lock(&scheduler->mutex);
+    scheduler->active = false;
+    bool started = scheduler->started;
+    celixThreadCondition_broadcast(&scheduler->timerCond);
+    celixThreadCondition_broadcast(&scheduler->workCond);
+    celixThreadMutex_unlock(&scheduler->mutex);
+
+    if (started) {
+        celixThread_join(scheduler->timerThread, NULL);
+    }
+    for (int i = 0; i < celix_arrayList_size(scheduler->workers); ++i) {
+        celix_thread_t *worker = celix_arrayList_get(scheduler->workers, i);
+        celixThread_join(*worker, NULL);
+        free(worker);
+    }
+    celix_arrayList_destroy(scheduler->workers);
+
+    size_t remaining = (size_t)hashMap_size(scheduler->events);
+    if (remaining > 0) {
+        fw_log(scheduler->logger, OSGI_FRAMEWORK_LOG_WARNING, "Dropping %zu scheduled events at scheduler destroy", remaining);
+    }
+    hashMap_destroy(scheduler->events, false, true);
+    hashMap_destroy(scheduler->services, false, true);
+    celix_arrayList_destroy(scheduler->ready);
+    celixThreadMutex_destroy(&scheduler->mutex);
+    celixThreadCondition_destroy(&scheduler->timerCond);
+    celixThreadCondition_destroy(&scheduler->workCond);
+    celixThreadCondition_destroy(&scheduler->doneCond);
+    free(scheduler);
+}
+
+celix_service_factory_t* celix_scheduler_getServiceFactory(celix_scheduler_t *scheduler) {
+    return &scheduler->factory;
+}
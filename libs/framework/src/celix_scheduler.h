@@ -0,0 +1,67 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *  KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#ifndef CELIX_CELIX_SCHEDULER_H
+#define CELIX_CELIX_SCHEDULER_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "celix_log.h"
+#include "celix_service_factory.h"
+#include "celix_scheduler_service.h"
+
+/**
+ * The framework scheduler behind the celix_scheduler service.
+ *
+ * Scheduled events are kept in a hashed timer wheel with CELIX_SCHEDULER_TICK sized slots. A single timer thread
+ * sleeps till the earliest deadline and hands the due events to a pool of CELIX_SCHEDULER_THREADS workers, which
+ * call the event callbacks. The threads are only created when the first event is scheduled.
+ */
+typedef struct celix_scheduler celix_scheduler_t;
+
+celix_scheduler_t* celix_scheduler_create(framework_logger_pt logger, long nrOfThreads, double tickInSeconds);
+
+/**
+ * Stops the scheduler threads (running callbacks are finished first) and drops the remaining events.
+ */
+void celix_scheduler_destroy(celix_scheduler_t *scheduler);
+
+/**
+ * Returns the service factory which creates the bundle specific celix_scheduler_service_t instances.
+ */
+celix_service_factory_t* celix_scheduler_getServiceFactory(celix_scheduler_t *scheduler);
+
+/**
+ * Schedules an event for the provided bundle. A intervalInSeconds of 0 schedules a one-shot event.
+ * Returns the event id or -1 if the event could not be scheduled.
+ */
+long celix_scheduler_schedule(celix_scheduler_t *scheduler, long bndId, double delayInSeconds, double intervalInSeconds, void *callbackData, void (*callback)(void *data));
+
+/**
+ * Cancels the event, see celix_scheduler_service_t.cancel. Only events of the provided bundle are cancelled.
+ */
+bool celix_scheduler_cancel(celix_scheduler_t *scheduler, long bndId, long eventId);
+
+/**
+ * Cancels all the events of the provided bundle and returns the number of cancelled events.
+ */
+size_t celix_scheduler_cancelAllFor(celix_scheduler_t *scheduler, long bndId);
+
+#endif //CELIX_CELIX_SCHEDULER_H
@@ -0,0 +1,174 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *  KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#ifdef __linux__
+#include <sys/syscall.h>
+#endif
+
+#include "celix_startup_trace.h"
+#include "celix_array_list.h"
+#include "celix_threads.h"
+
+//note bounds the memory used when the trace is never written and events keep coming (e.g. components restarting)
+#define CELIX_STARTUP_TRACE_MAX_EVENTS 100000
+
+typedef struct celix_startup_trace_entry {
+    celix_framework_startup_trace_event_t event;
+    long tid;
+} celix_startup_trace_entry_t;
+
+struct celix_startup_trace {
+    char *traceFile;
+    struct timespec created; //ts of the trace events are relative to the creation of the trace
+
+    celix_thread_mutex_t mutex; //protects entries
+    celix_array_list_t *entries; //value = celix_startup_trace_entry_t*
+};
+
+static long celix_startupTrace_threadId(void) {
+#ifdef __linux__
+    return (long)syscall(SYS_gettid);
+#else
+    return (long)(uintptr_t)pthread_self();
+#endif
+}
+
+static long long celix_startupTrace_diffInUs(const struct timespec *from, const struct timespec *to) {
+    return (to->tv_sec - from->tv_sec) * 1000000LL + (to->tv_nsec - from->tv_nsec) / 1000LL;
+}
+
+celix_startup_trace_t* celix_startupTrace_create(const char *traceFile) {
+    celix_startup_trace_t *trace = calloc(1, sizeof(*trace));
+    trace->traceFile = strdup(traceFile);
+    trace->created = celix_startupTrace_now();
+    celixThreadMutex_create(&trace->mutex, NULL);
+    trace->entries = celix_arrayList_create();
+    return trace;
+}
+
+void celix_startupTrace_destroy(celix_startup_trace_t *trace) {
+    if (trace != NULL) {
+        for (int i = 0; i < celix_arrayList_size(trace->entries); ++i) {
+            celix_startup_trace_entry_t *entry = celix_arrayList_get(trace->entries, i);
+            free((char*)entry->event.name);
+            free((char*)entry->event.subject);
+            free(entry);
+        }
+        celix_arrayList_destroy(trace->entries);
+        celixThreadMutex_destroy(&trace->mutex);
+        free(trace->traceFile);
+        free(trace);
+    }
+}
+
+struct timespec celix_startupTrace_now(void) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now;
+}
+
+void celix_startupTrace_addEvent(celix_startup_trace_t *trace, const char *category, const char *name, const char *subject, long bndId, const struct timespec *start) {
+    if (trace == NULL) {
+        return;
+    }
+    struct timespec end = celix_startupTrace_now();
+
+    celix_startup_trace_entry_t *entry = calloc(1, sizeof(*entry));
+    entry->event.category = category; //note category is expected to be a string literal
+    entry->event.name = strdup(name);
+    entry->event.subject = strdup(subject == NULL ? "" : subject);
+    entry->event.bndId = bndId;
+    entry->event.startInUs = celix_startupTrace_diffInUs(&trace->created, start);
+    entry->event.durationInUs = celix_startupTrace_diffInUs(start, &end);
+    entry->tid = celix_startupTrace_threadId();
+
+    celixThreadMutex_lock(&trace->mutex);
+    if (celix_arrayList_size(trace->entries) < CELIX_STARTUP_TRACE_MAX_EVENTS) {
+        celix_arrayList_add(trace->entries, entry);
+        entry = NULL;
+    }
+    celixThreadMutex_unlock(&trace->mutex);
+
+    if (entry != NULL) {
+        free((char*)entry->event.name);
+        free((char*)entry->event.subject);
+        free(entry);
+    }
+}
+
+static void celix_startupTrace_writeJsonString(FILE *out, const char *str) {
+    fputc('"', out);
+    for (const char *c = str; *c != '\0'; ++c) {
+        if (*c == '"' || *c == '\\') {
+            fputc('\\', out);
+            fputc(*c, out);
+        } else if ((unsigned char)*c < 0x20) {
+            fprintf(out, "\\u%04x", (unsigned int)*c);
+        } else {
+            fputc(*c, out);
+        }
+    }
+    fputc('"', out);
+}
+
+celix_status_t celix_startupTrace_writeFile(celix_startup_trace_t *trace) {
+    if (trace == NULL) {
+        return CELIX_SUCCESS;
+    }
+    FILE *out = fopen(trace->traceFile, "w");
+    if (out == NULL) {
+        return CELIX_FILE_IO_EXCEPTION;
+    }
+
+    long pid = (long)getpid();
+    fprintf(out, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[");
+    celixThreadMutex_lock(&trace->mutex);
+    for (int i = 0; i < celix_arrayList_size(trace->entries); ++i) {
+        celix_startup_trace_entry_t *entry = celix_arrayList_get(trace->entries, i);
+        fprintf(out, "%s\n{\"ph\":\"X\",\"cat\":", i == 0 ? "" : ",");
+        celix_startupTrace_writeJsonString(out, entry->event.category);
+        fprintf(out, ",\"name\":");
+        celix_startupTrace_writeJsonString(out, entry->event.name);
+        fprintf(out, ",\"ts\":%lli,\"dur\":%lli,\"pid\":%li,\"tid\":%li,\"args\":{\"subject\":", entry->event.startInUs, entry->event.durationInUs, pid, entry->tid);
+        celix_startupTrace_writeJsonString(out, entry->event.subject);
+        fprintf(out, ",\"bundleId\":%li}}", entry->event.bndId);
+    }
+    celixThreadMutex_unlock(&trace->mutex);
+    fprintf(out, "\n]}\n");
+
+    return fclose(out) == 0 ? CELIX_SUCCESS : CELIX_FILE_IO_EXCEPTION;
+}
+
+bool celix_startupTrace_useEvents(celix_startup_trace_t *trace, void *callbackHandle, void (*use)(void *handle, const celix_framework_startup_trace_event_t *event)) {
+    if (trace == NULL) {
+        return false;
+    }
+    celixThreadMutex_lock(&trace->mutex);
+    for (int i = 0; i < celix_arrayList_size(trace->entries); ++i) {
+        celix_startup_trace_entry_t *entry = celix_arrayList_get(trace->entries, i);
+        use(callbackHandle, &entry->event);
+    }
+    celixThreadMutex_unlock(&trace->mutex);
+    return true;
+}
@@ -0,0 +1,60 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *  KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#ifndef CELIX_CELIX_STARTUP_TRACE_H
+#define CELIX_CELIX_STARTUP_TRACE_H
+
+#include <time.h>
+
+#include "celix_errno.h"
+#include "celix_framework.h"
+
+/**
+ * Records the duration of the bundle install, library load and activator calls and of the DM component state
+ * transitions, so that they can be written as a Chrome trace (Perfetto compatible) JSON timeline.
+ * Enabled with the CELIX_STARTUP_TRACE_FILE config property.
+ *
+ * All functions accept a NULL trace, in which case nothing is recorded.
+ */
+typedef struct celix_startup_trace celix_startup_trace_t;
+
+celix_startup_trace_t* celix_startupTrace_create(const char *traceFile);
+void celix_startupTrace_destroy(celix_startup_trace_t *trace);
+
+/**
+ * Returns the current (monotonic) time, to be used as start time of a trace event.
+ */
+struct timespec celix_startupTrace_now(void);
+
+/**
+ * Adds a trace event which started at the provided start time and ends now.
+ */
+void celix_startupTrace_addEvent(celix_startup_trace_t *trace, const char *category, const char *name, const char *subject, long bndId, const struct timespec *start);
+
+/**
+ * Writes the recorded trace events to the configured trace file (overwriting an existing file).
+ */
+celix_status_t celix_startupTrace_writeFile(celix_startup_trace_t *trace);
+
+/**
+ * Calls the provided callback for all recorded trace events. Returns false if trace is NULL.
+ */
+bool celix_startupTrace_useEvents(celix_startup_trace_t *trace, void *callbackHandle, void (*use)(void *handle, const celix_framework_startup_trace_event_t *event));
+
+#endif //CELIX_CELIX_STARTUP_TRACE_H
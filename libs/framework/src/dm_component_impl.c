@@ -31,6 +31,8 @@
 #include "celix_constants.h"
 #include "filter.h"
 #include "dm_component_impl.h"
+#include "framework_private.h"
+#include "celix_bundle.h"
 
 
 typedef struct dm_executor_struct * dm_executor_pt;
@@ -60,6 +62,8 @@ struct celix_dm_component_struct {
     hash_map_pt dependencyEvents; //protected by mutex
 
     dm_executor_pt executor;
+
+    bool changePending; //only accessed on the executor thread, see component_handleChangeCoalesced
 };
 
 typedef struct dm_interface_struct {
@@ -111,6 +115,9 @@ static celix_status_t component_allRequiredAvailable(celix_dm_component_t *compo
 static celix_status_t component_performTransition(celix_dm_component_t *component, celix_dm_component_state_t oldState, celix_dm_component_state_t newState, bool *transition);
 static celix_status_t component_calculateNewState(celix_dm_component_t *component, celix_dm_component_state_t currentState, celix_dm_component_state_t *newState);
 static celix_status_t component_handleChange(celix_dm_component_t *component);
+static celix_status_t component_handleChangeCoalesced(celix_dm_component_t *component);
+static bool executor_hasPendingTasks(dm_executor_pt executor);
+static bool executor_isAddedEventTask(dm_executor_task_t *task);
 static celix_status_t component_startDependencies(celix_dm_component_t *component __attribute__((unused)), array_list_pt dependencies);
 static celix_status_t component_getDependencyEvent(celix_dm_component_t *component, celix_dm_service_dependency_t *dependency, dm_event_pt *event_pptr);
 static celix_status_t component_updateInstance(celix_dm_component_t *component, celix_dm_service_dependency_t *dependency, dm_event_pt event, bool update, bool add);
@@ -157,6 +164,7 @@ celix_dm_component_t* celix_dmComponent_create(bundle_context_t *context, const
 
     component->executor = NULL;
     executor_create(component, &component->executor);
+    component->changePending = false;
     return component;
 }
 
@@ -539,7 +547,7 @@ static celix_status_t component_handleAdded(celix_dm_component_t *component, cel
             bool required = false;
             serviceDependency_isRequired(dependency, &required);
             if (required) {
-                component_handleChange(component);
+                component_handleChangeCoalesced(component);
             }
             break;
         }
@@ -800,19 +808,59 @@ static celix_status_t component_stopDependencies(celix_dm_component_t *component
     return status;
 }
 
+/**
+ * Handles a change for a component waiting for required dependencies.
+ * If more tasks are queued on the component executor (e.g. a burst of added events when the dependencies are started)
+ * the change is marked pending and handled once after the burst, instead of re-evaluating the component state for
+ * every added dependency.
+ */
+static celix_status_t component_handleChangeCoalesced(celix_dm_component_t *component) {
+    if (executor_hasPendingTasks(component->executor)) {
+        component->changePending = true;
+        return CELIX_SUCCESS;
+    }
+    return component_handleChange(component);
+}
+
+static const char* component_stateToString(celix_dm_component_state_t state) {
+    switch (state) {
+        case DM_CMP_STATE_INACTIVE:
+            return "INACTIVE";
+        case DM_CMP_STATE_WAITING_FOR_REQUIRED:
+            return "WAITING_FOR_REQUIRED";
+        case DM_CMP_STATE_INSTANTIATED_AND_WAITING_FOR_REQUIRED:
+            return "INSTANTIATED_AND_WAITING_FOR_REQUIRED";
+        case DM_CMP_STATE_TRACKING_OPTIONAL:
+            return "TRACKING_OPTIONAL";
+        default:
+            return "UNKNOWN";
+    }
+}
+
 static celix_status_t component_handleChange(celix_dm_component_t *component) {
+    component->changePending = false;
     celix_status_t status = CELIX_SUCCESS;
 
     celix_dm_component_state_t oldState;
     celix_dm_component_state_t newState;
 
+    celix_framework_t *fw = NULL;
+    bundleContext_getFramework(component->context, &fw);
+    celix_startup_trace_t *trace = fw != NULL ? fw_getStartupTrace(fw) : NULL;
+
     bool transition = false;
     do {
         oldState = component->state;
         status = component_calculateNewState(component, oldState, &newState);
         if (status == CELIX_SUCCESS) {
             component->state = newState;
+            struct timespec start = celix_startupTrace_now();
             status = component_performTransition(component, oldState, newState, &transition);
+            if (trace != NULL && transition) {
+                char name[128];
+                snprintf(name, sizeof(name), "%s -> %s", component_stateToString(oldState), component_stateToString(newState));
+                celix_startupTrace_addEvent(trace, "component", name, component->name, celix_bundle_getId(celix_bundleContext_getBundle(component->context)), &start);
+            }
         }
 
         if (status != CELIX_SUCCESS) {
@@ -1419,7 +1467,12 @@ static celix_status_t executor_runTasks(dm_executor_pt executor, pthread_t curre
     pthread_mutex_unlock(&executor->mutex);
 
     while (entry != NULL) {
+        if (entry->component->changePending && !executor_isAddedEventTask(entry)) {
+            //note only added events are coalesced, other tasks need the up to date component state
+            component_handleChange(entry->component);
+        }
 	    entry->command(entry->component, entry->data);
+        celix_dm_component_t *cmp = entry->component;
 	    free(entry);
 
 	    pthread_mutex_lock(&executor->mutex);
@@ -1430,6 +1483,17 @@ static celix_status_t executor_runTasks(dm_executor_pt executor, pthread_t curre
 		    entry = NULL;
 	    }
 	    pthread_mutex_unlock(&executor->mutex);
+
+        if (entry == NULL && cmp->changePending) {
+            //end of the burst, handle the coalesced change. Note this can queue new tasks
+            component_handleChange(cmp);
+            pthread_mutex_lock(&executor->mutex);
+            if (celix_arrayList_size(executor->workQueue) > 0) {
+                entry = celix_arrayList_get(executor->workQueue, 0);
+                celix_arrayList_removeAt(executor->workQueue, 0);
+            }
+            pthread_mutex_unlock(&executor->mutex);
+        }
     }
 
 
@@ -1440,6 +1504,21 @@ static celix_status_t executor_runTasks(dm_executor_pt executor, pthread_t curre
     return status;
 }
 
+static bool executor_hasPendingTasks(dm_executor_pt executor) {
+    pthread_mutex_lock(&executor->mutex);
+    bool pending = celix_arrayList_size(executor->workQueue) > 0;
+    pthread_mutex_unlock(&executor->mutex);
+    return pending;
+}
+
+static bool executor_isAddedEventTask(dm_executor_task_t *task) {
+    if (task->command == (void*)component_handleEventTask) {
+        dm_handle_event_type_pt data = task->data;
+        return data->event->event_type == DM_EVENT_ADDED;
+    }
+    return false;
+}
+
 celix_status_t component_getComponentInfo(celix_dm_component_t *component, dm_component_info_pt *out) {
     return celix_dmComponent_getComponentInfo(component, out);
 }
@@ -1461,24 +1540,8 @@ celix_status_t celix_dmComponent_getComponentInfo(celix_dm_component_t *componen
     memcpy(info->id, component->id, DM_COMPONENT_MAX_ID_LENGTH);
     memcpy(info->name, component->name, DM_COMPONENT_MAX_NAME_LENGTH);
 
-    switch (component->state) {
-        case DM_CMP_STATE_INACTIVE :
-            info->state = strdup("INACTIVE");
-            break;
-        case DM_CMP_STATE_WAITING_FOR_REQUIRED :
-            info->state = strdup("WAITING_FOR_REQUIRED");
-            break;
-        case DM_CMP_STATE_INSTANTIATED_AND_WAITING_FOR_REQUIRED :
-            info->state = strdup("INSTANTIATED_AND_WAITING_FOR_REQUIRED");
-            break;
-        case DM_CMP_STATE_TRACKING_OPTIONAL :
-            info->state = strdup("TRACKING_OPTIONAL");
-            info->active = true;
-            break;
-        default :
-            info->state = strdup("UNKNOWN");
-            break;
-    }
+    info->state = strdup(component_stateToString(component->state));
+    info->active = component->state == DM_CMP_STATE_TRACKING_OPTIONAL;
 
     celixThreadMutex_lock(&component->mutex);
     size = arrayList_size(component->dependencies);
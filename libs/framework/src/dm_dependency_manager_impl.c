@@ -27,6 +27,9 @@
 #include "dm_dependency_manager_impl.h"
 #include "celix_dependency_manager.h"
 #include "celix_bundle.h"
+#include "celix_bundle_context.h"
+#include "celix_constants.h"
+#include "celix_threads.h"
 
 
 celix_dependency_manager_t* celix_private_dependencyManager_create(celix_bundle_context_t *context) {
@@ -56,6 +59,70 @@ celix_status_t celix_dependencyManager_add(celix_dependency_manager_t *manager,
 }
 
 
+typedef struct celix_dm_start_pool {
+	celix_dm_component_t **components;
+	size_t nrOfComponents;
+	size_t next; //atomic
+	celix_status_t status; //protected by mutex
+	celix_thread_mutex_t mutex;
+} celix_dm_start_pool_t;
+
+static void* celix_dependencyManager_startWorker(void *data) {
+	celix_dm_start_pool_t *pool = data;
+	size_t index = __atomic_fetch_add(&pool->next, 1, __ATOMIC_ACQ_REL);
+	while (index < pool->nrOfComponents) {
+		celix_status_t status = celix_private_dmComponent_start(pool->components[index]);
+		if (status != CELIX_SUCCESS) {
+			celixThreadMutex_lock(&pool->mutex);
+			pool->status = status;
+			celixThreadMutex_unlock(&pool->mutex);
+		}
+		index = __atomic_fetch_add(&pool->next, 1, __ATOMIC_ACQ_REL);
+	}
+	return NULL;
+}
+
+celix_status_t celix_dependencyManager_addComponents(celix_dependency_manager_t *manager, celix_dm_component_t **components, size_t nrOfComponents) {
+	celixThreadMutex_lock(&manager->mutex);
+	for (size_t i = 0; i < nrOfComponents; ++i) {
+		celix_arrayList_add(manager->components, components[i]);
+	}
+	celixThreadMutex_unlock(&manager->mutex);
+
+	celix_dm_start_pool_t pool;
+	pool.components = components;
+	pool.nrOfComponents = nrOfComponents;
+	pool.next = 0;
+	pool.status = CELIX_SUCCESS;
+	celixThreadMutex_create(&pool.mutex, NULL);
+
+	long nrOfThreads = celix_bundleContext_getPropertyAsLong(manager->ctx, CELIX_DM_COMPONENT_START_THREADS_NAME, CELIX_DM_COMPONENT_START_THREADS_DEFAULT);
+	if (nrOfThreads > (long)nrOfComponents) {
+		nrOfThreads = (long)nrOfComponents;
+	}
+
+	//note the calling thread is also used as worker
+	size_t nrOfWorkers = nrOfThreads > 1 ? (size_t)nrOfThreads - 1 : 0;
+	celix_thread_t *workers = nrOfWorkers > 0 ? calloc(nrOfWorkers, sizeof(*workers)) : NULL;
+	size_t nrOfStarted = 0;
+	for (size_t i = 0; workers != NULL && i < nrOfWorkers; ++i) {
+		if (celixThread_create(&workers[i], NULL, celix_dependencyManager_startWorker, &pool) == CELIX_SUCCESS) {
+			celixThread_setName(&workers[i], "CelixDmStart");
+			nrOfStarted += 1;
+		} else {
+			break; //note remaining components are started by the started workers and the calling thread
+		}
+	}
+	celix_dependencyManager_startWorker(&pool);
+	for (size_t i = 0; i < nrOfStarted; ++i) {
+		celixThread_join(workers[i], NULL);
+	}
+	free(workers);
+
+	celixThreadMutex_destroy(&pool.mutex);
+	return pool.status;
+}
+
 celix_status_t celix_dependencyManager_remove(celix_dependency_manager_t *manager, celix_dm_component_t *component) {
 	celix_status_t status;
 
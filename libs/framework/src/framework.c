@@ -38,7 +38,9 @@
 #include "celix_bundle_context.h"
 #include "bundle_context_private.h"
 #include "service_tracker.h"
+#include "service_tracker_private.h"
 #include "celix_library_loader.h"
+#include "celix_probes.h"
 
 typedef celix_status_t (*create_function_fp)(bundle_context_t *context, void **userData);
 typedef celix_status_t (*start_function_fp)(void *userData, bundle_context_t *context);
@@ -58,11 +60,25 @@ typedef struct celix_framework_bundle_entry {
     celix_bundle_t *bnd;
     long bndId;
 
-    celix_thread_mutex_t useMutex; //protects useCount
+    celix_thread_mutex_t useMutex; //protects useCount and removed
     celix_thread_cond_t useCond;
     size_t useCount;
+    bool removed; //true if the bundle is uninstalled, after which the bundle cannot be used anymore
+
+    long refCount; //atomic, the installedBundles.entries list and the bundle tables referring to the entry
 } celix_framework_bundle_entry_t;
 
+/**
+ * Immutable snapshot of the installed bundles. A new table is published on every bundle install/uninstall, so that
+ * the bundles can be iterated and looked up by id without holding the installedBundles.mutex.
+ */
+typedef struct celix_framework_bundle_table {
+    long refCount; //atomic
+    int size;
+    celix_framework_bundle_entry_t **entries; //ordered by installed bundle time
+    celix_framework_bundle_entry_t **byId; //the same entries, ordered by bundle id
+} celix_framework_bundle_table_t;
+
 
 static inline celix_framework_bundle_entry_t* fw_bundleEntry_create(celix_bundle_t *bnd) {
     celix_framework_bundle_entry_t *entry = calloc(1, sizeof(*entry));
@@ -70,11 +86,134 @@ static inline celix_framework_bundle_entry_t* fw_bundleEntry_create(celix_bundle
 
     entry->bndId = celix_bundle_getId(bnd);
     entry->useCount = 0;
+    entry->removed = false;
+    entry->refCount = 1;
     celixThreadMutex_create(&entry->useMutex, NULL);
     celixThreadCondition_init(&entry->useCond, NULL);
     return entry;
 }
 
+static inline void fw_bundleEntry_retain(celix_framework_bundle_entry_t *entry) {
+    __atomic_add_fetch(&entry->refCount, 1, __ATOMIC_SEQ_CST);
+}
+
+static inline void fw_bundleEntry_release(celix_framework_bundle_entry_t *entry) {
+    if (__atomic_sub_fetch(&entry->refCount, 1, __ATOMIC_SEQ_CST) == 0) {
+        celixThreadMutex_destroy(&entry->useMutex);
+        celixThreadCondition_destroy(&entry->useCond);
+        free(entry);
+    }
+}
+
+/**
+ * Increases the use count of the entry, unless the bundle is uninstalled. Returns true if the use count is increased.
+ */
+static inline bool fw_bundleEntry_tryUse(celix_framework_bundle_entry_t *entry) {
+    celixThreadMutex_lock(&entry->useMutex);
+    bool inUse = !entry->removed;
+    if (inUse) {
+        entry->useCount += 1;
+    }
+    celixThreadMutex_unlock(&entry->useMutex);
+    return inUse;
+}
+
+static inline void fw_bundleEntry_unuse(celix_framework_bundle_entry_t *entry) {
+    celixThreadMutex_lock(&entry->useMutex);
+    assert(entry->useCount > 0);
+    entry->useCount -= 1;
+    if (entry->useCount == 0) {
+        celixThreadCondition_broadcast(&entry->useCond);
+    }
+    celixThreadMutex_unlock(&entry->useMutex);
+}
+
+static void fw_bundleTable_release(celix_framework_bundle_table_t *table) {
+    if (table != NULL && __atomic_sub_fetch(&table->refCount, 1, __ATOMIC_SEQ_CST) == 0) {
+        for (int i = 0; i < table->size; ++i) {
+            fw_bundleEntry_release(table->entries[i]);
+        }
+        free(table->entries);
+        free(table->byId);
+        free(table);
+    }
+}
+
+/**
+ * Returns the current bundle table, retained. Release with fw_bundleTable_release.
+ * Note this does not lock, the readers count only keeps the table updater from releasing the table which is
+ * being retained.
+ */
+static celix_framework_bundle_table_t* fw_bundleTable_acquire(celix_framework_t *fw) {
+    __atomic_add_fetch(&fw->installedBundles.tableReaders, 1, __ATOMIC_SEQ_CST);
+    celix_framework_bundle_table_t *table = __atomic_load_n(&fw->installedBundles.table, __ATOMIC_SEQ_CST);
+    if (table != NULL) {
+        __atomic_add_fetch(&table->refCount, 1, __ATOMIC_SEQ_CST);
+    }
+    if (__atomic_sub_fetch(&fw->installedBundles.tableReaders, 1, __ATOMIC_SEQ_CST) == 0 &&
+            __atomic_load_n(&fw->installedBundles.tableUpdating, __ATOMIC_SEQ_CST)) {
+        celixThreadMutex_lock(&fw->installedBundles.tableReadersMutex);
+        celixThreadCondition_broadcast(&fw->installedBundles.tableReadersCond);
+        celixThreadMutex_unlock(&fw->installedBundles.tableReadersMutex);
+    }
+    return table;
+}
+
+static inline celix_framework_bundle_entry_t* fw_bundleTable_get(const celix_framework_bundle_table_t *table, long bndId) {
+    int low = 0;
+    int high = table != NULL ? table->size - 1 : -1;
+    while (low <= high) {
+        int mid = low + (high - low) / 2;
+        long midId = table->byId[mid]->bndId;
+        if (midId == bndId) {
+            return table->byId[mid];
+        } else if (midId < bndId) {
+            low = mid + 1;
+        } else {
+            high = mid - 1;
+        }
+    }
+    return NULL;
+}
+
+static int fw_bundleTable_compareIds(const void *a, const void *b) {
+    long idA = (*(celix_framework_bundle_entry_t * const *)a)->bndId;
+    long idB = (*(celix_framework_bundle_entry_t * const *)b)->bndId;
+    return idA < idB ? -1 : (idA > idB ? 1 : 0);
+}
+
+/**
+ * Publishes a new bundle table for the installedBundles.entries. Should be called with installedBundles.mutex locked.
+ */
+static void fw_bundleTable_update(celix_framework_t *fw) {
+    celix_framework_bundle_table_t *table = calloc(1, sizeof(*table));
+    table->refCount = 1;
+    table->size = celix_arrayList_size(fw->installedBundles.entries);
+    table->entries = calloc(table->size == 0 ? 1 : (size_t)table->size, sizeof(*table->entries));
+    for (int i = 0; i < table->size; ++i) {
+        celix_framework_bundle_entry_t *entry = celix_arrayList_get(fw->installedBundles.entries, i);
+        fw_bundleEntry_retain(entry);
+        table->entries[i] = entry;
+    }
+    //note bundle ids mostly increase with the install time, but not for bundles reinstalled from the cache
+    table->byId = malloc((table->size == 0 ? 1 : (size_t)table->size) * sizeof(*table->byId));
+    memcpy(table->byId, table->entries, (size_t)table->size * sizeof(*table->byId));
+    qsort(table->byId, (size_t)table->size, sizeof(*table->byId), fw_bundleTable_compareIds);
+
+    celix_framework_bundle_table_t *old = __atomic_exchange_n(&fw->installedBundles.table, table, __ATOMIC_SEQ_CST);
+    //note wait till the threads which could have loaded the old table pointer have retained it.
+    //A reader which sees tableUpdating after leaving wakes this thread, a reader which does not has left before
+    //tableReaders is checked.
+    celixThreadMutex_lock(&fw->installedBundles.tableReadersMutex);
+    __atomic_store_n(&fw->installedBundles.tableUpdating, true, __ATOMIC_SEQ_CST);
+    while (__atomic_load_n(&fw->installedBundles.tableReaders, __ATOMIC_SEQ_CST) > 0) {
+        celixThreadCondition_wait(&fw->installedBundles.tableReadersCond, &fw->installedBundles.tableReadersMutex);
+    }
+    __atomic_store_n(&fw->installedBundles.tableUpdating, false, __ATOMIC_SEQ_CST);
+    celixThreadMutex_unlock(&fw->installedBundles.tableReadersMutex);
+    fw_bundleTable_release(old);
+}
+
 
 static inline void fw_bundleEntry_waitTillNotUsed(celix_framework_bundle_entry_t *entry) {
     celixThreadMutex_lock(&entry->useMutex);
@@ -84,34 +223,33 @@ static inline void fw_bundleEntry_waitTillNotUsed(celix_framework_bundle_entry_t
     celixThreadMutex_unlock(&entry->useMutex);
 }
 
+/**
+ * Marks the entry as removed and releases the installedBundles.entries reference. The entry is destroyed
+ * when the last bundle table referring to it is released.
+ */
 static inline void fw_bundleEntry_destroy(celix_framework_bundle_entry_t *entry, bool wait) {
     celixThreadMutex_lock(&entry->useMutex);
     while (wait && entry->useCount != 0) {
         celixThreadCondition_wait(&entry->useCond, &entry->useMutex);
     }
+    entry->removed = true;
     celixThreadMutex_unlock(&entry->useMutex);
 
-    //destroy
-    celixThreadMutex_destroy(&entry->useMutex);
-    celixThreadCondition_destroy(&entry->useCond);
-    free(entry);
+    fw_bundleEntry_release(entry);
 }
 
 
 static inline void fw_bundleEntry_increaseUseCount(framework_t *fw, long bndId) {
     assert(bndId >= 0);
     if (bndId > 0) { //note not in/decreasing framework bundle use count, to prevent that the framework is waiting on it self
-        celixThreadMutex_lock(&fw->installedBundles.mutex);
-        int size = celix_arrayList_size(fw->installedBundles.entries);
-        for (int i = 0; i < size; ++i) {
-            celix_framework_bundle_entry_t *entry = celix_arrayList_get(fw->installedBundles.entries, i);
-            if (entry != NULL && entry->bndId == bndId) {
-                celixThreadMutex_lock(&entry->useMutex);
-                entry->useCount += 1;
-                celixThreadMutex_unlock(&entry->useMutex);
-            }
+        celix_framework_bundle_table_t *table = fw_bundleTable_acquire(fw);
+        celix_framework_bundle_entry_t *entry = fw_bundleTable_get(table, bndId);
+        if (entry != NULL) {
+            celixThreadMutex_lock(&entry->useMutex);
+            entry->useCount += 1;
+            celixThreadMutex_unlock(&entry->useMutex);
         }
-        celixThreadMutex_unlock(&fw->installedBundles.mutex);
+        fw_bundleTable_release(table);
     }
 }
 
@@ -135,21 +273,12 @@ static inline size_t fw_bundleEntry_getUseCount(framework_t *fw, long bndId) {
 static inline void fw_bundleEntry_decreaseUseCount(framework_t *fw, long bndId) {
     assert(bndId >= 0);
     if (bndId > 0) { //note not in/decreasing framework bundle use count, to prevent that the framework is waiting on it self
-        celixThreadMutex_lock(&fw->installedBundles.mutex);
-        int size = celix_arrayList_size(fw->installedBundles.entries);
-        for (int i = 0; i < size; ++i) {
-            celix_framework_bundle_entry_t *entry = celix_arrayList_get(fw->installedBundles.entries, i);
-            if (entry != NULL && entry->bndId == bndId) {
-                celixThreadMutex_lock(&entry->useMutex);
-                assert(entry->useCount > 0);
-                entry->useCount -= 1;
-                if (entry->useCount == 0) {
-                    celixThreadCondition_broadcast(&entry->useCond);
-                }
-                celixThreadMutex_unlock(&entry->useMutex);
-            }
+        celix_framework_bundle_table_t *table = fw_bundleTable_acquire(fw);
+        celix_framework_bundle_entry_t *entry = fw_bundleTable_get(table, bndId);
+        if (entry != NULL) {
+            fw_bundleEntry_unuse(entry);
         }
-        celixThreadMutex_unlock(&fw->installedBundles.mutex);
+        fw_bundleTable_release(table);
     }
 }
 
@@ -168,6 +297,8 @@ celix_status_t fw_populateDependentGraph(framework_pt framework, bundle_pt expor
 celix_status_t fw_fireBundleEvent(framework_pt framework, bundle_event_type_e, bundle_pt bundle);
 celix_status_t fw_fireFrameworkEvent(framework_pt framework, framework_event_type_e eventType, bundle_pt bundle, celix_status_t errorCode);
 static void *fw_eventDispatcher(void *fw);
+static void fw_serviceEvents_stopExecutors(celix_framework_t *fw);
+static void fw_stopTrackerReaper(celix_framework_t *fw);
 
 celix_status_t fw_invokeBundleListener(framework_pt framework, bundle_listener_pt listener, bundle_event_pt event, bundle_pt bundle);
 celix_status_t fw_invokeFrameworkListener(framework_pt framework, framework_listener_pt listener, framework_event_pt event, bundle_pt bundle);
@@ -175,13 +306,18 @@ celix_status_t fw_invokeFrameworkListener(framework_pt framework, framework_list
 static celix_status_t framework_loadBundleLibraries(framework_pt framework, bundle_pt bundle);
 static celix_status_t framework_loadLibraries(framework_pt framework, const char* libraries, const char* activator, bundle_archive_pt archive, void **activatorHandle);
 static celix_status_t framework_loadLibrary(framework_pt framework, const char* library, bundle_archive_pt archive, void **handle);
+static void framework_preloadLibraries(framework_pt framework);
+static const char* framework_threadConfigLookup(void *handle, const char *key);
+static void* fw_getActivatorSymbol(bundle_pt bundle, const char *name, const char *deprecatedName);
 
 static celix_status_t frameworkActivator_start(void * userData, bundle_context_t *context);
 static celix_status_t frameworkActivator_stop(void * userData, bundle_context_t *context);
 static celix_status_t frameworkActivator_destroy(void * userData, bundle_context_t *context);
 
 static void framework_autoStartConfiguredBundles(bundle_context_t *fwCtx);
+static void framework_autoStartImageBundles(bundle_context_t *fwCtx);
 static void framework_autoStartConfiguredBundlesForList(bundle_context_t *fwCtx, const char *autoStart);
+static void framework_configureRegistryIndexes(framework_pt framework);
 
 struct fw_refreshHelper {
     framework_pt framework;
@@ -196,6 +332,12 @@ celix_status_t fw_refreshHelper_stop(struct fw_refreshHelper * refreshHelper);
 struct fw_bundleListener {
 	bundle_pt bundle;
 	bundle_listener_pt listener;
+
+	//protected by bundleListenerLock
+	celix_thread_cond_t useCond;
+	size_t useCount; //nr of event dispatches using the listener
+	bool removed;
+	bool freeOnRelease; //removed from the event dispatcher thread while in use
 };
 
 typedef struct fw_bundleListener * fw_bundle_listener_pt;
@@ -203,6 +345,12 @@ typedef struct fw_bundleListener * fw_bundle_listener_pt;
 struct fw_frameworkListener {
 	bundle_pt bundle;
 	framework_listener_pt listener;
+
+	//protected by frameworkListenersLock
+	celix_thread_cond_t useCond;
+	size_t useCount; //nr of event dispatches using the listener
+	bool removed;
+	bool freeOnRelease; //removed from the event dispatcher thread while in use
 };
 
 typedef struct fw_frameworkListener * fw_framework_listener_pt;
@@ -217,7 +365,7 @@ typedef enum event_type event_type_e;
 
 struct request {
 	event_type_e type;
-	array_list_pt listeners;
+	struct timespec enqueueTime;
 
 	int eventType;
 	long bundleId;
@@ -230,26 +378,85 @@ struct request {
 
 typedef struct request *request_pt;
 
+static void fw_enqueueRequest(celix_framework_t *framework, request_pt request);
+
 typedef struct celix_fw_service_listener_entry {
     //only set during creating
     celix_bundle_t *bundle;
 	celix_service_listener_t *listener;
 	celix_filter_t *filter;
+	char *objectClass; //objectClass required by the filter or NULL (wildcard listener)
+	celix_array_list_t *filterAttributes; //value = const char* (owned by filter), the property keys used in the filter
 
     celix_thread_mutex_t mutex; //protects retainedReferences and useCount
-	celix_array_list_t* retainedReferences;
+	hash_map_t *retainedReferences; //key = service id, value = service_reference_pt
 	celix_thread_cond_t useCond;
     size_t useCount;
 } celix_fw_service_listener_entry_t;
 
+/**
+ * Returns the objectClass a service must have to match the filter or NULL if the filter does not require a specific
+ * objectClass. Only an objectClass equality at the top-level or nested in (top-level) AND operands is
+ * required, an objectClass in a OR or NOT operand is not.
+ */
+static const char* fw_findRequiredObjectClass(const celix_filter_t *filter) {
+    const char *result = NULL;
+    if (filter == NULL) {
+        //nop
+    } else if (filter->operand == CELIX_FILTER_OPERAND_EQUAL) {
+        if (filter->attribute != NULL && strncmp(filter->attribute, OSGI_FRAMEWORK_OBJECTCLASS, 128) == 0) {
+            result = filter->value;
+        }
+    } else if (filter->operand == CELIX_FILTER_OPERAND_AND) {
+        for (int i = 0; i < celix_arrayList_size(filter->children) && result == NULL; ++i) {
+            const celix_filter_t *child = celix_arrayList_get(filter->children, i);
+            result = fw_findRequiredObjectClass(child);
+        }
+    }
+    return result;
+}
+
+static void fw_collectFilterAttributes(const celix_filter_t *filter, celix_array_list_t *attributes) {
+    if (filter == NULL) {
+        //nop
+    } else if (filter->operand == CELIX_FILTER_OPERAND_AND || filter->operand == CELIX_FILTER_OPERAND_OR || filter->operand == CELIX_FILTER_OPERAND_NOT) {
+        for (int i = 0; i < celix_arrayList_size(filter->children); ++i) {
+            fw_collectFilterAttributes(celix_arrayList_get(filter->children, i), attributes);
+        }
+    } else if (filter->attribute != NULL) {
+        celix_arrayList_add(attributes, (void*)filter->attribute);
+    }
+}
+
+/**
+ * Returns true if one of the changed keys is used in the filter of the listener.
+ */
+static bool listener_filterUsesKeys(const celix_fw_service_listener_entry_t *entry, const celix_array_list_t *changedKeys) {
+    for (int i = 0; i < celix_arrayList_size(entry->filterAttributes); ++i) {
+        const char *attribute = celix_arrayList_get(entry->filterAttributes, i);
+        for (int k = 0; k < celix_arrayList_size(changedKeys); ++k) {
+            if (strcmp(attribute, celix_arrayList_get(changedKeys, k)) == 0) {
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
 static inline celix_fw_service_listener_entry_t* listener_create(celix_bundle_t *bnd, const char *filter, celix_service_listener_t *listener) {
     celix_fw_service_listener_entry_t *entry = calloc(1, sizeof(*entry));
-    entry->retainedReferences = celix_arrayList_create();
+    entry->retainedReferences = hashMap_create(NULL, NULL, NULL, NULL);
     entry->listener = listener;
     entry->bundle = bnd;
     if (filter != NULL) {
         entry->filter = celix_filter_create(filter);
     }
+    entry->filterAttributes = celix_arrayList_create();
+    fw_collectFilterAttributes(entry->filter, entry->filterAttributes);
+    const char *objectClass = fw_findRequiredObjectClass(entry->filter);
+    if (objectClass != NULL) {
+        entry->objectClass = strndup(objectClass, 1024 * 1024);
+    }
 
     entry->useCount = 1;
     celixThreadMutex_create(&entry->mutex, NULL);
@@ -273,25 +480,123 @@ static inline void listener_release(celix_fw_service_listener_entry_t *entry) {
     celixThreadMutex_unlock(&entry->mutex);
 }
 
+typedef struct celix_fw_service_event_sync {
+    celix_thread_mutex_t mutex; //protects pending
+    celix_thread_cond_t cond;
+    size_t pending;
+} celix_fw_service_event_sync_t;
+
+/**
+ * The keys of the properties changed by a service properties update, shared by the (async) MODIFIED events of
+ * the update.
+ */
+typedef struct celix_fw_changed_keys {
+    long refCount; //atomic
+    celix_array_list_t *keys; //value = char*
+} celix_fw_changed_keys_t;
+
+/**
+ * Returns the keys which are added, changed or removed in newProps compared to oldProps, or NULL if oldProps is NULL.
+ */
+static celix_fw_changed_keys_t* fw_changedKeys_create(const celix_properties_t *oldProps, const celix_properties_t *newProps) {
+    if (oldProps == NULL || newProps == NULL) {
+        return NULL;
+    }
+    celix_fw_changed_keys_t *changed = calloc(1, sizeof(*changed));
+    changed->refCount = 1;
+    changed->keys = celix_arrayList_create();
+    const char *key = NULL;
+    CELIX_PROPERTIES_FOR_EACH(newProps, key) {
+        const char *oldVal = celix_properties_get(oldProps, key, NULL);
+        if (oldVal == NULL || strcmp(oldVal, celix_properties_get(newProps, key, "")) != 0) {
+            celix_arrayList_add(changed->keys, strdup(key));
+        }
+    }
+    CELIX_PROPERTIES_FOR_EACH(oldProps, key) {
+        if (celix_properties_get(newProps, key, NULL) == NULL) {
+            celix_arrayList_add(changed->keys, strdup(key));
+        }
+    }
+    return changed;
+}
+
+static void fw_changedKeys_retain(celix_fw_changed_keys_t *changed) {
+    if (changed != NULL) {
+        __atomic_add_fetch(&changed->refCount, 1, __ATOMIC_SEQ_CST);
+    }
+}
+
+static void fw_changedKeys_release(celix_fw_changed_keys_t *changed) {
+    if (changed != NULL && __atomic_sub_fetch(&changed->refCount, 1, __ATOMIC_SEQ_CST) == 0) {
+        for (int i = 0; i < celix_arrayList_size(changed->keys); ++i) {
+            free(celix_arrayList_get(changed->keys, i));
+        }
+        celix_arrayList_destroy(changed->keys);
+        free(changed);
+    }
+}
+
+typedef struct celix_fw_service_event {
+    celix_service_event_type_t type;
+    long serviceId;
+    service_reference_pt reference; //reference for the bundle of the service listener
+    celix_fw_changed_keys_t *changedKeys; //retained, NULL if not a MODIFIED(_ENDMATCH) event or not known
+    celix_fw_service_listener_entry_t *entry; //retained
+    celix_fw_service_event_sync_t *sync; //optional, set if the caller waits until the event is delivered
+    struct timespec queued; //CLOCK_MONOTONIC time the event is added to the executor queue
+} celix_fw_service_event_t;
+
+/**
+ * Executor delivering the service events for service listeners of a single bundle, in order.
+ */
+typedef struct celix_fw_service_event_executor {
+    celix_framework_t *fw;
+    celix_thread_t thread;
+    celix_thread_mutex_t mutex; //protects active and queue
+    celix_thread_cond_t cond;
+    bool active;
+    celix_array_list_t *queue; //value = celix_fw_service_event_t*
+
+    //only used by the executor thread
+    celix_array_list_t *batch; //value = celix_fw_service_event_t*, events taken from the queue
+    int batchIndex;
+} celix_fw_service_event_executor_t;
+
+static __thread celix_fw_service_event_executor_t *g_currentExecutor = NULL; //set for executor threads
+
+static void fw_serviceEvents_runPending(celix_fw_service_event_executor_t *executor);
+
 static inline void listener_waitAndDestroy(celix_framework_t *framework, celix_fw_service_listener_entry_t *entry) {
     celixThreadMutex_lock(&entry->mutex);
     while(entry->useCount != 0) {
-        celixThreadCondition_wait(&entry->useCond, &entry->mutex);
+        if (g_currentExecutor != NULL) {
+            //pending events for the listener can be queued on the executor of this thread, deliver them first
+            celixThreadMutex_unlock(&entry->mutex);
+            fw_serviceEvents_runPending(g_currentExecutor);
+            celixThreadMutex_lock(&entry->mutex);
+            if (entry->useCount != 0) {
+                celixThreadCondition_timedwaitRelative(&entry->useCond, &entry->mutex, 0, 1000000);
+            }
+        } else {
+            celixThreadCondition_wait(&entry->useCond, &entry->mutex);
+        }
     }
     celixThreadMutex_unlock(&entry->mutex);
 
 
     //use count == 0 -> safe to destroy.
     //destroy
-    int rSize = arrayList_size(entry->retainedReferences);
-    for (int i = 0; i < rSize; i += 1) {
-        service_reference_pt ref = arrayList_get(entry->retainedReferences, i);
+    hash_map_iterator_t iter = hashMapIterator_construct(entry->retainedReferences);
+    while (hashMapIterator_hasNext(&iter)) {
+        service_reference_pt ref = hashMapIterator_nextValue(&iter);
         if (ref != NULL) {
             serviceRegistry_ungetServiceReference(framework->registry, entry->bundle, ref); // decrease retain counter
         }
     }
+    celix_arrayList_destroy(entry->filterAttributes);
     celix_filter_destroy(entry->filter);
-    celix_arrayList_destroy(entry->retainedReferences);
+    free(entry->objectClass);
+    hashMap_destroy(entry->retainedReferences, false, false);
     celixThreadMutex_destroy(&entry->mutex);
     celixThreadCondition_destroy(&entry->useCond);
     free(entry);
@@ -307,6 +612,7 @@ static void framework_loggerInit(void) {
 
 celix_status_t framework_create(framework_pt *framework, properties_pt config) {
     celix_status_t status = CELIX_SUCCESS;
+    long prevThreadOwner = celixThread_setCreationOwner(0L); //threads created by the framework are owned by bundle 0
 
     logger = hashMap_get(config, "logger");
     if (logger == NULL) {
@@ -326,7 +632,13 @@ celix_status_t framework_create(framework_pt *framework, properties_pt config) {
         status = CELIX_DO_IF(status, celixThreadMutex_create(&(*framework)->frameworkListenersLock, &attr));
         status = CELIX_DO_IF(status, celixThreadMutex_create(&(*framework)->bundleListenerLock, NULL));
         status = CELIX_DO_IF(status, celixThreadMutex_create(&(*framework)->installedBundles.mutex, NULL));
+        status = CELIX_DO_IF(status, celixThreadMutex_create(&(*framework)->installedBundles.tableReadersMutex, NULL));
+        status = CELIX_DO_IF(status, celixThreadCondition_init(&(*framework)->installedBundles.tableReadersCond, NULL));
         status = CELIX_DO_IF(status, celixThreadCondition_init(&(*framework)->dispatcher.cond, NULL));
+        status = CELIX_DO_IF(status, celixThreadMutex_create(&(*framework)->serviceEvents.mutex, NULL));
+        status = CELIX_DO_IF(status, celixThreadMutex_create(&(*framework)->lazyBundles.mutex, NULL));
+        status = CELIX_DO_IF(status, celixThreadMutex_create(&(*framework)->trackerReaper.mutex, NULL));
+        status = CELIX_DO_IF(status, celixThreadCondition_init(&(*framework)->trackerReaper.cond, NULL));
         if (status == CELIX_SUCCESS) {
             (*framework)->bundle = NULL;
             (*framework)->registry = NULL;
@@ -337,12 +649,51 @@ celix_status_t framework_create(framework_pt *framework, properties_pt config) {
             (*framework)->cache = NULL;
             (*framework)->installRequestMap = hashMap_create(utils_stringHash, utils_stringHash, utils_stringEquals, utils_stringEquals);
             (*framework)->installedBundles.entries = celix_arrayList_create();
+            (*framework)->installedBundles.table = NULL;
+            (*framework)->installedBundles.tableReaders = 0;
+            (*framework)->installedBundles.tableUpdating = false;
             (*framework)->serviceListeners = NULL;
+            (*framework)->serviceListenersByObjectClass = NULL;
+            (*framework)->wildcardServiceListeners = NULL;
             (*framework)->bundleListeners = NULL;
             (*framework)->frameworkListeners = NULL;
             (*framework)->dispatcher.requests = NULL;
+            memset(&(*framework)->dispatcher.metrics, 0, sizeof((*framework)->dispatcher.metrics));
+            (*framework)->serviceEvents.async = false;
+            (*framework)->serviceEvents.active = true;
+            (*framework)->serviceEvents.executors = hashMap_create(NULL, NULL, NULL, NULL);
+            (*framework)->lazyBundles.byServiceName = hashMap_create(utils_fastStringHash, NULL, utils_stringEquals, NULL);
+            (*framework)->trackerReaper.active = true;
+            (*framework)->trackerReaper.started = false;
+            (*framework)->trackerReaper.jobs = celix_arrayList_create();
             (*framework)->configurationMap = config;
             (*framework)->logger = logger;
+            celixThread_setConfigLookup(framework_threadConfigLookup, *framework);
+
+            const char *traceFile = NULL;
+            fw_getProperty(*framework, CELIX_STARTUP_TRACE_FILE_NAME, NULL, &traceFile);
+            (*framework)->startupTrace = traceFile != NULL ? celix_startupTrace_create(traceFile) : NULL;
+
+            const char *imageFile = NULL;
+            fw_getProperty(*framework, CELIX_BUNDLE_IMAGE_NAME, NULL, &imageFile);
+            (*framework)->image = imageFile != NULL ? celix_bundleImage_open(imageFile) : NULL;
+            if (imageFile != NULL && (*framework)->image == NULL) {
+                fw_log((*framework)->logger, OSGI_FRAMEWORK_LOG_WARNING, "Cannot use bundle image %s, using the configured auto start bundles", imageFile);
+            }
+
+            (*framework)->preloadedLibraries = celix_arrayList_create();
+            framework_preloadLibraries(*framework);
+
+            const char *schedulerThreads = NULL;
+            const char *schedulerTick = NULL;
+            fw_getProperty(*framework, CELIX_SCHEDULER_THREADS_NAME, NULL, &schedulerThreads);
+            fw_getProperty(*framework, CELIX_SCHEDULER_TICK_NAME, NULL, &schedulerTick);
+            (*framework)->scheduler = celix_scheduler_create((*framework)->logger,
+                    schedulerThreads == NULL ? CELIX_SCHEDULER_THREADS_DEFAULT : strtol(schedulerThreads, NULL, 10),
+                    schedulerTick == NULL ? CELIX_SCHEDULER_TICK_DEFAULT : strtod(schedulerTick, NULL));
+            (*framework)->schedulerSvcId = -1L;
+            memset(&(*framework)->metrics, 0, sizeof((*framework)->metrics));
+            (*framework)->metrics.providerSvcId = -1L;
 
 
             status = CELIX_DO_IF(status, bundle_create(&(*framework)->bundle));
@@ -363,6 +714,7 @@ celix_status_t framework_create(framework_pt *framework, properties_pt config) {
         fw_logCode(logger, OSGI_FRAMEWORK_LOG_ERROR, CELIX_ENOMEM, "Could not create framework");
     }
 
+    celixThread_setCreationOwner(prevThreadOwner);
     return status;
 }
 
@@ -375,7 +727,10 @@ celix_status_t framework_destroy(framework_pt framework) {
     //has not been joined yet.
     celixThread_join(framework->shutdown.thread, NULL);
 
+    fw_serviceEvents_stopExecutors(framework);
+    fw_stopTrackerReaper(framework);
 
+    fw_bundleTable_release(__atomic_exchange_n(&framework->installedBundles.table, NULL, __ATOMIC_SEQ_CST));
     celixThreadMutex_lock(&framework->installedBundles.mutex);
     for (int i = 0; i < celix_arrayList_size(framework->installedBundles.entries); ++i) {
         celix_framework_bundle_entry_t *entry = celix_arrayList_get(framework->installedBundles.entries, i);
@@ -418,12 +773,15 @@ celix_status_t framework_destroy(framework_pt framework) {
     }
     celix_arrayList_destroy(framework->installedBundles.entries);
     celixThreadMutex_destroy(&framework->installedBundles.mutex);
+    celixThreadMutex_destroy(&framework->installedBundles.tableReadersMutex);
+    celixThreadCondition_destroy(&framework->installedBundles.tableReadersCond);
 
 
 
 	hashMap_destroy(framework->installRequestMap, false, false);
 
 	serviceRegistry_destroy(framework->registry);
+	celix_scheduler_destroy(framework->scheduler);
 
     if (framework->serviceListeners != NULL) {
         int size = celix_arrayList_size(framework->serviceListeners);
@@ -434,6 +792,25 @@ celix_status_t framework_destroy(framework_pt framework) {
         }
         arrayList_destroy(framework->serviceListeners);
     }
+    if (framework->serviceListenersByObjectClass != NULL) {
+        hash_map_iterator_t iter = hashMapIterator_construct(framework->serviceListenersByObjectClass);
+        while (hashMapIterator_hasNext(&iter)) {
+            celix_array_list_t *listeners = hashMapIterator_nextValue(&iter);
+            celix_arrayList_destroy(listeners);
+        }
+        hashMap_destroy(framework->serviceListenersByObjectClass, true, false);
+    }
+    if (framework->wildcardServiceListeners != NULL) {
+        celix_arrayList_destroy(framework->wildcardServiceListeners);
+    }
+    if (framework->lazyBundles.byServiceName != NULL) {
+        hash_map_iterator_t iter = hashMapIterator_construct(framework->lazyBundles.byServiceName);
+        while (hashMapIterator_hasNext(&iter)) {
+            celix_array_list_t *bndIds = hashMapIterator_nextValue(&iter);
+            celix_arrayList_destroy(bndIds);
+        }
+        hashMap_destroy(framework->lazyBundles.byServiceName, true, false);
+    }
     if (framework->bundleListeners) {
         arrayList_destroy(framework->bundleListeners);
     }
@@ -446,6 +823,7 @@ celix_status_t framework_destroy(framework_pt framework) {
 	    for (i = 0; i < arrayList_size(framework->dispatcher.requests); i++) {
 	        request_pt request = arrayList_get(framework->dispatcher.requests, i);
 	        free(request->bundleSymbolicName);
+	        free(request->error);
 	        free(request);
 	    }
 	    arrayList_destroy(framework->dispatcher.requests);
@@ -458,14 +836,30 @@ celix_status_t framework_destroy(framework_pt framework) {
     celixThreadMutex_destroy(&framework->frameworkListenersLock);
 	celixThreadMutex_destroy(&framework->bundleListenerLock);
 	celixThreadMutex_destroy(&framework->dispatcher.mutex);
+	celixThreadMutex_destroy(&framework->serviceEvents.mutex);
+	celixThreadMutex_destroy(&framework->lazyBundles.mutex);
+	celixThreadMutex_destroy(&framework->trackerReaper.mutex);
+	celixThreadCondition_destroy(&framework->trackerReaper.cond);
+	celix_arrayList_destroy(framework->trackerReaper.jobs);
 	celixThreadMutex_destroy(&framework->shutdown.mutex);
 	celixThreadCondition_destroy(&framework->shutdown.cond);
 
+    if (celix_startupTrace_writeFile(framework->startupTrace) != CELIX_SUCCESS) {
+        fw_log(framework->logger, OSGI_FRAMEWORK_LOG_WARNING, "Cannot write startup trace file");
+    }
+    celix_startupTrace_destroy(framework->startupTrace);
+    celix_bundleImage_close(framework->image);
+    for (int i = 0; i < celix_arrayList_size(framework->preloadedLibraries); ++i) {
+        celix_libloader_close(celix_arrayList_get(framework->preloadedLibraries, i));
+    }
+    celix_arrayList_destroy(framework->preloadedLibraries);
+
     logger = hashMap_get(framework->configurationMap, "logger");
     if (logger == NULL) {
         free(framework->logger);
     }
 
+    celixThread_setConfigLookup(NULL, NULL);
     properties_destroy(framework->configurationMap);
 
     free(framework);
@@ -477,7 +871,7 @@ celix_status_t fw_init(framework_pt framework) {
 	bundle_state_e state;
 	const char *location = NULL;
 	module_pt module = NULL;
-	linked_list_pt wires = NULL;
+	celix_ilist_t *wires = NULL;
 	array_list_pt archives = NULL;
 	bundle_archive_pt archive = NULL;
 
@@ -492,10 +886,17 @@ celix_status_t fw_init(framework_pt framework) {
 
 	celix_status_t status = CELIX_SUCCESS;
 	status = CELIX_DO_IF(status, arrayList_create(&framework->serviceListeners)); //entry is celix_fw_service_listener_entry_t
+	status = CELIX_DO_IF(status, arrayList_create(&framework->wildcardServiceListeners)); //entry is celix_fw_service_listener_entry_t
+    if (status == CELIX_SUCCESS) {
+        framework->serviceListenersByObjectClass = hashMap_create(utils_fastStringHash, NULL, utils_stringEquals, NULL);
+    }
 	status = CELIX_DO_IF(status, arrayList_create(&framework->bundleListeners));
 	status = CELIX_DO_IF(status, arrayList_create(&framework->frameworkListeners));
 	status = CELIX_DO_IF(status, arrayList_create(&framework->dispatcher.requests));
 	status = CELIX_DO_IF(status, celixThread_create(&framework->dispatcher.thread, NULL, fw_eventDispatcher, framework));
+	if (status == CELIX_SUCCESS) {
+	    celixThread_setName(&framework->dispatcher.thread, "CelixEvent");
+	}
 	status = CELIX_DO_IF(status, bundle_getState(framework->bundle, &state));
 	if (status == CELIX_SUCCESS) {
 	    if ((state == OSGI_FRAMEWORK_BUNDLE_INSTALLED) || (state == OSGI_FRAMEWORK_BUNDLE_RESOLVED)) {
@@ -522,6 +923,7 @@ celix_status_t fw_init(framework_pt framework) {
         celix_framework_bundle_entry_t *entry = fw_bundleEntry_create(framework->bundle);
         celixThreadMutex_lock(&framework->installedBundles.mutex);
         celix_arrayList_add(framework->installedBundles.entries, entry);
+        fw_bundleTable_update(framework);
         celixThreadMutex_unlock(&framework->installedBundles.mutex);
     }
     status = CELIX_DO_IF(status, bundle_getCurrentModule(framework->bundle, &module));
@@ -535,8 +937,14 @@ celix_status_t fw_init(framework_pt framework) {
         }
     }
 
-    status = CELIX_DO_IF(status, bundleCache_getArchives(framework->cache, &archives));
-    if (status == CELIX_SUCCESS) {
+    if (framework->image != NULL) {
+        //sealed deployment, the bundles are installed from the image (see framework_autoStartImageBundles) and
+        //not from the bundle cache. Reserve the ids of the image bundles.
+        framework->nextBundleId = celix_bundleImage_getHighestBundleId(framework->image) + 1;
+    } else {
+        status = CELIX_DO_IF(status, bundleCache_getArchives(framework->cache, &archives));
+    }
+    if (status == CELIX_SUCCESS && archives != NULL) {
         unsigned int arcIdx;
         for (arcIdx = 0; arcIdx < arrayList_size(archives); arcIdx++) {
             bundle_archive_pt archive1 = (bundle_archive_pt) arrayList_get(archives, arcIdx);
@@ -559,6 +967,16 @@ celix_status_t fw_init(framework_pt framework) {
     }
 
     status = CELIX_DO_IF(status, serviceRegistry_create(framework, fw_serviceChanged, &framework->registry));
+    if (status == CELIX_SUCCESS) {
+        celix_serviceRegistry_setServiceChangedForRegistrationsCallback(framework->registry, fw_serviceChangedForRegistrations);
+    }
+    if (status == CELIX_SUCCESS) {
+        framework_configureRegistryIndexes(framework);
+
+        const char *async = NULL;
+        fw_getProperty(framework, CELIX_FRAMEWORK_SERVICE_EVENTS_ASYNC_NAME, CELIX_FRAMEWORK_SERVICE_EVENTS_ASYNC_DEFAULT, &async);
+        framework->serviceEvents.async = async != NULL && strncasecmp(async, "true", 5) == 0;
+    }
     status = CELIX_DO_IF(status, framework_setBundleStateAndNotify(framework, framework->bundle, OSGI_FRAMEWORK_BUNDLE_STARTING));
 
     bundle_context_t *context = NULL;
@@ -612,6 +1030,7 @@ celix_status_t fw_init(framework_pt framework) {
 celix_status_t framework_start(framework_pt framework) {
 	celix_status_t status = CELIX_SUCCESS;
 	bundle_state_e state = OSGI_FRAMEWORK_BUNDLE_UNKNOWN;
+    long prevThreadOwner = celixThread_setCreationOwner(0L);
 
 	status = CELIX_DO_IF(status, bundle_getState(framework->bundle, &state));
 	if (status == CELIX_SUCCESS) {
@@ -637,10 +1056,17 @@ celix_status_t framework_start(framework_pt framework) {
     }
 
     bundle_context_t *fwCtx = framework_getContext(framework);
-	if (fwCtx != NULL) {
+	if (fwCtx != NULL && framework->image != NULL) {
+        framework_autoStartImageBundles(fwCtx);
+    } else if (fwCtx != NULL) {
         framework_autoStartConfiguredBundles(fwCtx);
     }
 
+    if (celix_startupTrace_writeFile(framework->startupTrace) != CELIX_SUCCESS) {
+        fw_log(framework->logger, OSGI_FRAMEWORK_LOG_WARNING, "Cannot write startup trace file");
+    }
+
+    celixThread_setCreationOwner(prevThreadOwner);
 	return status;
 }
 
@@ -660,6 +1086,163 @@ static void framework_autoStartConfiguredBundles(bundle_context_t *fwCtx) {
     }
 }
 
+/**
+ * Installs and starts the bundles of the bundle image per run level, using the pre-extracted bundles and manifest
+ * headers of the image. The CELIX_AUTO_START_x lists are ignored, the image is created from them.
+ */
+static void framework_autoStartImageBundles(bundle_context_t *fwCtx) {
+    celix_framework_t *fw = fwCtx->framework;
+    celix_bundle_image_t *image = fw->image;
+    size_t nrOfBundles = celix_bundleImage_getNumberOfBundles(image);
+    celix_array_list_t *installed = celix_arrayList_create();
+
+    for (int runLevel = 0; runLevel <= 5; ++runLevel) {
+        for (size_t i = 0; i < nrOfBundles; ++i) {
+            if (celix_bundleImage_getRunLevel(image, i) != runLevel) {
+                continue;
+            }
+            const char *location = celix_bundleImage_getLocation(image, i);
+            bundle_archive_pt archive = NULL;
+            bundle_t *bnd = NULL;
+            celix_status_t rc = celix_bundleImage_createArchive(image, i, &archive);
+            if (rc == CELIX_SUCCESS) {
+                rc = fw_installBundle2(fw, &bnd, celix_bundleImage_getBundleId(image, i), location, NULL, archive);
+            }
+            if (rc == CELIX_SUCCESS) {
+                celix_arrayList_add(installed, bnd);
+            } else {
+                printf("Could not install bundle '%s' from bundle image\n", location);
+            }
+        }
+
+        for (int i = 0; i < celix_arrayList_size(installed); ++i) {
+            bundle_t *bnd = celix_arrayList_get(installed, i);
+            if (bundle_startWithOptions(bnd, 0) != CELIX_SUCCESS) {
+                printf("Could not start bundle %li\n", celix_bundle_getId(bnd));
+            }
+        }
+        celix_arrayList_clear(installed);
+    }
+
+    celix_arrayList_destroy(installed);
+}
+
+typedef struct fw_autoInstallJob {
+    char *location; //resolved location
+    long id;
+    bundle_archive_pt archive;
+    celix_status_t status;
+} fw_auto_install_job_t;
+
+typedef struct fw_autoInstallPool {
+    celix_framework_t *fw;
+    celix_thread_mutex_t mutex; //protects next
+    size_t next;
+    size_t nrOfJobs;
+    fw_auto_install_job_t *jobs;
+} fw_auto_install_pool_t;
+
+static void* framework_autoInstallWorker(void *data) {
+    fw_auto_install_pool_t *pool = data;
+    for (;;) {
+        celixThreadMutex_lock(&pool->mutex);
+        size_t index = pool->next++;
+        celixThreadMutex_unlock(&pool->mutex);
+        if (index >= pool->nrOfJobs) {
+            break;
+        }
+        fw_auto_install_job_t *job = &pool->jobs[index];
+        struct timespec start = celix_startupTrace_now();
+        job->status = bundleCache_createArchive(pool->fw->cache, job->id, job->location, NULL, &job->archive);
+        celix_startupTrace_addEvent(pool->fw->startupTrace, "bundle", "bundleArchive_create", job->location, job->id, &start);
+    }
+    return NULL;
+}
+
+/**
+ * Extracts the bundles of the provided locations concurrently into the bundle cache and installs them using the
+ * created archives (in order). Bundles already installed or which cannot be found are installed the normal way.
+ */
+static void framework_autoInstallConcurrently(bundle_context_t *fwCtx, celix_array_list_t *locations, long nrOfThreads, celix_array_list_t *installed) {
+    celix_framework_t *fw = fwCtx->framework;
+    const char *paths = NULL;
+    fw_getProperty(fw, CELIX_BUNDLES_PATH_NAME, CELIX_BUNDLES_PATH_DEFAULT, &paths);
+
+    fw_auto_install_pool_t pool;
+    pool.fw = fw;
+    pool.next = 0;
+    pool.nrOfJobs = 0;
+    pool.jobs = calloc(celix_arrayList_size(locations), sizeof(*pool.jobs));
+    celixThreadMutex_create(&pool.mutex, NULL);
+
+    //note bundle ids are reserved in order, so that the ids are the same as for a sequential install
+    for (int i = 0; i < celix_arrayList_size(locations); ++i) {
+        const char *location = celix_arrayList_get(locations, i);
+        char *resolved = fw_resolveBundleLocation(location, paths);
+        bool alreadyAdded = false;
+        for (size_t k = 0; resolved != NULL && k < pool.nrOfJobs; ++k) {
+            alreadyAdded = alreadyAdded || strcmp(resolved, pool.jobs[k].location) == 0;
+        }
+        if (resolved != NULL && !alreadyAdded && framework_getBundle(fw, resolved) == NULL) {
+            fw_auto_install_job_t *job = &pool.jobs[pool.nrOfJobs++];
+            job->location = resolved;
+            job->id = framework_getNextBundleId(fw);
+            job->archive = NULL;
+            job->status = CELIX_SUCCESS;
+        } else {
+            free(resolved);
+        }
+    }
+
+    size_t nrOfWorkers = nrOfThreads < pool.nrOfJobs ? (size_t)nrOfThreads : pool.nrOfJobs;
+    celix_thread_t workers[nrOfWorkers > 0 ? nrOfWorkers : 1];
+    bool started[nrOfWorkers > 0 ? nrOfWorkers : 1];
+    for (size_t i = 0; i < nrOfWorkers; ++i) {
+        started[i] = celixThread_create(&workers[i], NULL, framework_autoInstallWorker, &pool) == CELIX_SUCCESS;
+        if (started[i]) {
+            celixThread_setName(&workers[i], "CelixInstall");
+        }
+    }
+    framework_autoInstallWorker(&pool); //also use the current thread
+    for (size_t i = 0; i < nrOfWorkers; ++i) {
+        if (started[i]) {
+            celixThread_join(workers[i], NULL);
+        }
+    }
+
+    size_t jobIndex = 0;
+    for (int i = 0; i < celix_arrayList_size(locations); ++i) {
+        const char *location = celix_arrayList_get(locations, i);
+        char *resolved = fw_resolveBundleLocation(location, paths);
+        fw_auto_install_job_t *job = NULL;
+        if (resolved != NULL && jobIndex < pool.nrOfJobs && strcmp(resolved, pool.jobs[jobIndex].location) == 0) {
+            job = &pool.jobs[jobIndex++];
+        }
+        free(resolved);
+
+        bundle_t *bnd = NULL;
+        celix_status_t rc;
+        if (job != NULL && job->status == CELIX_SUCCESS) {
+            rc = fw_installBundle2(fw, &bnd, job->id, job->location, NULL, job->archive);
+        } else if (job != NULL) {
+            rc = job->status;
+        } else {
+            rc = bundleContext_installBundle(fwCtx, location, &bnd);
+        }
+        if (rc == CELIX_SUCCESS) {
+            celix_arrayList_add(installed, bnd);
+        } else {
+            printf("Could not install bundle '%s'\n", location);
+        }
+    }
+
+    for (size_t i = 0; i < pool.nrOfJobs; ++i) {
+        free(pool.jobs[i].location);
+    }
+    free(pool.jobs);
+    celixThreadMutex_destroy(&pool.mutex);
+}
+
 static void framework_autoStartConfiguredBundlesForList(bundle_context_t *fwCtx, const char *autoStartIn)  {
     char delims[] = " ";
     char *save_ptr = NULL;
@@ -667,7 +1250,19 @@ static void framework_autoStartConfiguredBundlesForList(bundle_context_t *fwCtx,
     char *autoStart = strndup(autoStartIn, 1024*1024*10);
     arrayList_create(&installed);
 
-    if (autoStart != NULL) {
+    const char *threadsStr = NULL;
+    fw_getProperty(fwCtx->framework, CELIX_AUTO_START_INSTALL_THREADS_NAME, CELIX_AUTO_START_INSTALL_THREADS_DEFAULT, &threadsStr);
+    long nrOfThreads = threadsStr == NULL ? 1 : strtol(threadsStr, NULL, 10);
+
+    if (autoStart != NULL && nrOfThreads > 1) {
+        celix_array_list_t *locations = celix_arrayList_create();
+        for (char *location = strtok_r(autoStart, delims, &save_ptr); location != NULL; location = strtok_r(NULL, delims, &save_ptr)) {
+            celix_arrayList_add(locations, location);
+        }
+        //note the current thread is also used as worker
+        framework_autoInstallConcurrently(fwCtx, locations, nrOfThreads - 1, installed);
+        celix_arrayList_destroy(locations);
+    } else if (autoStart != NULL) {
         char *location = strtok_r(autoStart, delims, &save_ptr);
         while (location != NULL) {
             //first install
@@ -697,6 +1292,21 @@ static void framework_autoStartConfiguredBundlesForList(bundle_context_t *fwCtx,
     arrayList_destroy(installed);
 }
 
+static void framework_configureRegistryIndexes(framework_pt framework) {
+    const char *indexed = NULL;
+    fw_getProperty(framework, CELIX_SERVICE_REGISTRY_INDEXED_PROPERTIES_NAME, CELIX_SERVICE_REGISTRY_INDEXED_PROPERTIES_DEFAULT, &indexed);
+    if (indexed != NULL) {
+        char *names = strndup(indexed, 1024 * 1024);
+        char *savePtr = NULL;
+        for (char *name = strtok_r(names, ",", &savePtr); name != NULL; name = strtok_r(NULL, ",", &savePtr)) {
+            char *trimmed = utils_stringTrim(name);
+            if (strlen(trimmed) > 0) {
+                celix_serviceRegistry_addPropertyIndex(framework->registry, trimmed);
+            }
+        }
+        free(names);
+    }
+}
 
 celix_status_t framework_stop(framework_pt framework) {
 	return fw_stopBundle(framework, framework->bundle, true);
@@ -731,7 +1341,7 @@ celix_status_t fw_installBundle(framework_pt framework, bundle_pt * bundle, cons
 	return fw_installBundle2(framework, bundle, -1, location, inputFile, NULL);
 }
 
-static char* resolveBundleLocation(celix_framework_t *fw, const char *bndLoc, const char *p) {
+char* fw_resolveBundleLocation(const char *bndLoc, const char *p) {
     char *result = NULL;
     if (strnlen(bndLoc, 1) > 0) {
         if (bndLoc[0] == '/') {
@@ -764,11 +1374,13 @@ static char* resolveBundleLocation(celix_framework_t *fw, const char *bndLoc, co
 
 celix_status_t fw_installBundle2(framework_pt framework, bundle_pt * bundle, long id, const char *bndLoc, const char *inputFile, bundle_archive_pt archive) {
     celix_status_t status = CELIX_SUCCESS;
+    struct timespec installStart = celix_startupTrace_now();
     bundle_state_e state = OSGI_FRAMEWORK_BUNDLE_UNKNOWN;
 
     const char *paths = NULL;
     fw_getProperty(framework, CELIX_BUNDLES_PATH_NAME, CELIX_BUNDLES_PATH_DEFAULT, &paths);
-    char *location = resolveBundleLocation(framework, bndLoc, paths);
+    //note an existing archive (from the bundle cache or a bundle image) does not need the bundle file
+    char *location = archive != NULL ? strdup(bndLoc) : fw_resolveBundleLocation(bndLoc, paths);
     if (location == NULL) {
         fw_log(framework->logger, OSGI_FRAMEWORK_LOG_WARNING, "Cannot find bundle %s. Using %s=%s", bndLoc, CELIX_BUNDLES_PATH_NAME, paths);
         free(location);
@@ -797,7 +1409,9 @@ celix_status_t fw_installBundle2(framework_pt framework, bundle_pt * bundle, lon
         if (archive == NULL) {
             id = framework_getNextBundleId(framework);
 
+            struct timespec start = celix_startupTrace_now();
             status = CELIX_DO_IF(status, bundleCache_createArchive(framework->cache, id, location, inputFile, &archive));
+            celix_startupTrace_addEvent(framework->startupTrace, "bundle", "bundleArchive_create", location, id, &start);
 
             if (status != CELIX_SUCCESS) {
             	bundleArchive_destroy(archive);
@@ -817,7 +1431,9 @@ celix_status_t fw_installBundle2(framework_pt framework, bundle_pt * bundle, lon
             celix_framework_bundle_entry_t *entry = fw_bundleEntry_create(*bundle);
             celixThreadMutex_lock(&framework->installedBundles.mutex);
             celix_arrayList_add(framework->installedBundles.entries, entry);
+            fw_bundleTable_update(framework);
             celixThreadMutex_unlock(&framework->installedBundles.mutex);
+            celix_startupTrace_addEvent(framework->startupTrace, "bundle", "install", location, bndId, &installStart);
 
         } else {
             status = CELIX_BUNDLE_EXCEPTION;
@@ -868,10 +1484,168 @@ celix_status_t framework_getBundleEntry(framework_pt framework, bundle_pt bundle
 	return status;
 }
 
+static manifest_pt fw_getBundleManifest(bundle_pt bundle) {
+    bundle_archive_pt archive = NULL;
+    bundle_revision_pt revision = NULL;
+    manifest_pt manifest = NULL;
+    celix_status_t status = bundle_getArchive(bundle, &archive);
+    status = CELIX_DO_IF(status, bundleArchive_getCurrentRevision(archive, &revision));
+    status = CELIX_DO_IF(status, bundleRevision_getManifest(revision, &manifest));
+    return status == CELIX_SUCCESS ? manifest : NULL;
+}
+
+static bool fw_isLazyBundle(bundle_pt bundle) {
+    manifest_pt manifest = fw_getBundleManifest(bundle);
+    return manifest != NULL && manifest_isLazyActivation(manifest);
+}
+
+/**
+ * The libraries of a lazy bundle are loaded when the bundle is activated, unless the bundle exports libraries
+ * (other bundles can depend on those during resolving).
+ */
+static bool fw_isLibraryLoadingDeferred(bundle_pt bundle) {
+    manifest_pt manifest = fw_getBundleManifest(bundle);
+    return manifest != NULL && manifest_isLazyActivation(manifest) && manifest_getValue(manifest, OSGI_FRAMEWORK_EXPORT_LIBRARY) == NULL;
+}
+
+static bool fw_areBundleLibrariesLoaded(bundle_pt bundle) {
+    bundle_archive_pt archive = NULL;
+    bundle_revision_pt revision = NULL;
+    array_list_pt handles = NULL;
+    celix_status_t status = bundle_getArchive(bundle, &archive);
+    status = CELIX_DO_IF(status, bundleArchive_getCurrentRevision(archive, &revision));
+    status = CELIX_DO_IF(status, bundleRevision_getHandles(revision, &handles));
+    return status == CELIX_SUCCESS && handles != NULL && arrayList_size(handles) > 0;
+}
+
+/**
+ * Adds the lazy bundle to the pending lazy bundles, so that it is activated when a service listener for one of its
+ * lazy services is added.
+ * Returns false if such a service listener already exists; the bundle should then be activated directly.
+ */
+static bool fw_addPendingLazyBundle(framework_pt framework, bundle_pt bundle) {
+    long bndId = celix_bundle_getId(bundle);
+    manifest_pt manifest = fw_getBundleManifest(bundle);
+    const char *services = manifest != NULL ? manifest_getValue(manifest, CELIX_FRAMEWORK_BUNDLE_LAZY_SERVICES) : NULL;
+    if (services == NULL) {
+        return false;
+    }
+
+    celix_array_list_t *serviceNames = celix_arrayList_create();
+    char *copy = strndup(services, 1024 * 10);
+    char *savePtr = NULL;
+    for (char *token = strtok_r(copy, ",", &savePtr); token != NULL; token = strtok_r(NULL, ",", &savePtr)) {
+        char *serviceName = utils_stringTrim(token);
+        if (serviceName[0] != '\0') {
+            celix_arrayList_add(serviceNames, serviceName);
+        }
+    }
+
+    //note lazyBundles.mutex is kept during the check, so that a concurrently added service listener will see the pending bundle
+    celixThreadMutex_lock(&framework->lazyBundles.mutex);
+    bool tracked = false;
+    celixThreadMutex_lock(&framework->serviceListenersLock);
+    for (int i = 0; !tracked && i < celix_arrayList_size(serviceNames); ++i) {
+        tracked = hashMap_containsKey(framework->serviceListenersByObjectClass, celix_arrayList_get(serviceNames, i));
+    }
+    celixThreadMutex_unlock(&framework->serviceListenersLock);
+    for (int i = 0; !tracked && i < celix_arrayList_size(serviceNames); ++i) {
+        const char *serviceName = celix_arrayList_get(serviceNames, i);
+        celix_array_list_t *bndIds = hashMap_get(framework->lazyBundles.byServiceName, serviceName);
+        if (bndIds == NULL) {
+            bndIds = celix_arrayList_create();
+            hashMap_put(framework->lazyBundles.byServiceName, strndup(serviceName, 1024), bndIds);
+        }
+        bool found = false;
+        for (int k = 0; k < celix_arrayList_size(bndIds); ++k) {
+            if (celix_arrayList_getLong(bndIds, k) == bndId) {
+                found = true;
+                break;
+            }
+        }
+        if (!found) {
+            celix_arrayList_addLong(bndIds, bndId);
+        }
+    }
+    celixThreadMutex_unlock(&framework->lazyBundles.mutex);
+    celix_arrayList_destroy(serviceNames);
+    free(copy);
+
+    if (!tracked) {
+        fw_log(framework->logger, OSGI_FRAMEWORK_LOG_DEBUG, "Deferring activation of lazy bundle %s [%ld] till one of its services (%s) is tracked", celix_bundle_getSymbolicName(bundle), bndId, services);
+    }
+    return !tracked;
+}
+
+/**
+ * Removes the bundle from the pending lazy bundles. Returns true if the bundle was pending.
+ */
+static bool fw_removePendingLazyBundle(framework_pt framework, long bndId) {
+    bool removed = false;
+    celixThreadMutex_lock(&framework->lazyBundles.mutex);
+    hash_map_iterator_t iter = hashMapIterator_construct(framework->lazyBundles.byServiceName);
+    while (hashMapIterator_hasNext(&iter)) {
+        hash_map_entry_t *entry = hashMapIterator_nextEntry(&iter);
+        celix_array_list_t *bndIds = hashMapEntry_getValue(entry);
+        for (int i = 0; i < celix_arrayList_size(bndIds); ++i) {
+            if (celix_arrayList_getLong(bndIds, i) == bndId) {
+                celix_arrayList_removeAt(bndIds, i);
+                removed = true;
+                break;
+            }
+        }
+        if (celix_arrayList_size(bndIds) == 0) {
+            char *key = hashMapEntry_getKey(entry);
+            hashMapIterator_remove(&iter);
+            free(key);
+            celix_arrayList_destroy(bndIds);
+        }
+    }
+    celixThreadMutex_unlock(&framework->lazyBundles.mutex);
+    return removed;
+}
+
+static celix_status_t fw_startBundleInternal(framework_pt framework, bundle_pt bundle, bool honorLazyActivation);
+
+/**
+ * Activates the pending lazy bundles which declared the provided service name.
+ * Called when a service listener (tracker) for the service name is added.
+ */
+static void fw_activatePendingLazyBundles(framework_pt framework, const char *serviceName) {
+    celix_array_list_t *toActivate = NULL;
+    celixThreadMutex_lock(&framework->lazyBundles.mutex);
+    celix_array_list_t *bndIds = hashMap_get(framework->lazyBundles.byServiceName, serviceName);
+    if (bndIds != NULL) {
+        toActivate = celix_arrayList_create();
+        for (int i = 0; i < celix_arrayList_size(bndIds); ++i) {
+            celix_arrayList_addLong(toActivate, celix_arrayList_getLong(bndIds, i));
+        }
+    }
+    celixThreadMutex_unlock(&framework->lazyBundles.mutex);
+
+    if (toActivate != NULL) {
+        for (int i = 0; i < celix_arrayList_size(toActivate); ++i) {
+            long bndId = celix_arrayList_getLong(toActivate, i);
+            //note only the caller which removes the pending entry activates the bundle
+            if (fw_removePendingLazyBundle(framework, bndId)) {
+                bundle_t *bnd = framework_getBundleById(framework, bndId);
+                if (bnd != NULL) {
+                    fw_startBundleInternal(framework, bnd, false);
+                }
+            }
+        }
+        celix_arrayList_destroy(toActivate);
+    }
+}
+
 celix_status_t fw_startBundle(framework_pt framework, bundle_pt bundle, int options __attribute__((unused))) {
+    return fw_startBundleInternal(framework, bundle, true);
+}
+
+static celix_status_t fw_startBundleInternal(framework_pt framework, bundle_pt bundle, bool honorLazyActivation) {
 	celix_status_t status = CELIX_SUCCESS;
 
-	linked_list_pt wires = NULL;
+	celix_ilist_t *wires = NULL;
 	bundle_context_t *context = NULL;
 	bundle_state_e state;
 	module_pt module = NULL;
@@ -908,7 +1682,23 @@ celix_status_t fw_startBundle(framework_pt framework, bundle_pt bundle, int opti
                 bundle_getCurrentModule(bundle, &module);
                 module_getSymbolicName(module, &name);
                 if (!module_isResolved(module)) {
-                    wires = resolver_resolve(module);
+                    //try the wiring of a previous run, persisted in the bundle cache, before resolving
+                    bundle_archive_pt archive = NULL;
+                    bundle_revision_pt revision = NULL;
+                    char *cachedWiring = NULL;
+                    bundle_getArchive(bundle, &archive);
+                    if (archive != NULL) {
+                        bundleArchive_getCurrentRevision(archive, &revision);
+                    }
+                    if (revision != NULL) {
+                        bundleRevision_getCachedWiring(revision, &cachedWiring);
+                    }
+                    wires = resolver_resolveCached(module, cachedWiring);
+                    bool fromCache = wires != NULL;
+                    free(cachedWiring);
+                    if (wires == NULL) {
+                        wires = resolver_resolve(module);
+                    }
                     if (wires == NULL) {
                         return CELIX_BUNDLE_EXCEPTION;
                     }
@@ -916,6 +1706,13 @@ celix_status_t fw_startBundle(framework_pt framework, bundle_pt bundle, int opti
                     if (status != CELIX_SUCCESS) {
                         break;
                     }
+                    if (!fromCache && revision != NULL) {
+                        char *wiring = resolver_describeWiring(module);
+                        if (wiring != NULL) {
+                            bundleRevision_setCachedWiring(revision, wiring);
+                        }
+                        free(wiring);
+                    }
                 }
                 /* no break */
             case OSGI_FRAMEWORK_BUNDLE_RESOLVED:
@@ -923,6 +1720,13 @@ celix_status_t fw_startBundle(framework_pt framework, bundle_pt bundle, int opti
                 name = NULL;
                 bundle_getCurrentModule(bundle, &module);
                 module_getSymbolicName(module, &name);
+                if (honorLazyActivation && fw_isLazyBundle(bundle) && fw_addPendingLazyBundle(framework, bundle)) {
+                    //stays resolved till a service listener for one of the lazy services is added
+                    break;
+                }
+                if (fw_isLibraryLoadingDeferred(bundle) && !fw_areBundleLibrariesLoaded(bundle)) {
+                    status = framework_loadBundleLibraries(framework, bundle);
+                }
                 status = CELIX_DO_IF(status, bundleContext_create(framework, framework->logger, bundle, &context));
                 status = CELIX_DO_IF(status, bundle_setContext(bundle, context));
 
@@ -932,22 +1736,10 @@ celix_status_t fw_startBundle(framework_pt framework, bundle_pt bundle, int opti
                         status = CELIX_ENOMEM;
                     } else {
                         void * userData = NULL;
-                        create_function_fp create = (create_function_fp) celix_libloader_getSymbol((celix_library_handle_t*) bundle_getHandle(bundle), OSGI_FRAMEWORK_BUNDLE_ACTIVATOR_CREATE);
-                        if (create == NULL) {
-                            create = celix_libloader_getSymbol(bundle_getHandle(bundle), OSGI_FRAMEWORK_DEPRECATED_BUNDLE_ACTIVATOR_CREATE);
-                        }
-                        start_function_fp start = (start_function_fp) celix_libloader_getSymbol((celix_library_handle_t*) bundle_getHandle(bundle), OSGI_FRAMEWORK_BUNDLE_ACTIVATOR_START);
-                        if (start == NULL) {
-                            start = (start_function_fp) celix_libloader_getSymbol((celix_library_handle_t*) bundle_getHandle(bundle), OSGI_FRAMEWORK_DEPRECATED_BUNDLE_ACTIVATOR_START);
-                        }
-                        stop_function_fp stop = (stop_function_fp) celix_libloader_getSymbol((celix_library_handle_t*) bundle_getHandle(bundle), OSGI_FRAMEWORK_BUNDLE_ACTIVATOR_STOP);
-                        if (stop == NULL) {
-                            stop = (stop_function_fp) celix_libloader_getSymbol((celix_library_handle_t*) bundle_getHandle(bundle), OSGI_FRAMEWORK_DEPRECATED_BUNDLE_ACTIVATOR_STOP);
-                        }
-                        destroy_function_fp destroy = (destroy_function_fp) celix_libloader_getSymbol((celix_library_handle_t*) bundle_getHandle(bundle), OSGI_FRAMEWORK_BUNDLE_ACTIVATOR_DESTROY);
-                        if (destroy == NULL) {
-                            destroy = (destroy_function_fp) celix_libloader_getSymbol((celix_library_handle_t*) bundle_getHandle(bundle), OSGI_FRAMEWORK_DEPRECATED_BUNDLE_ACTIVATOR_DESTROY);
-                        }
+                        create_function_fp create = (create_function_fp) fw_getActivatorSymbol(bundle, OSGI_FRAMEWORK_BUNDLE_ACTIVATOR_CREATE, OSGI_FRAMEWORK_DEPRECATED_BUNDLE_ACTIVATOR_CREATE);
+                        start_function_fp start = (start_function_fp) fw_getActivatorSymbol(bundle, OSGI_FRAMEWORK_BUNDLE_ACTIVATOR_START, OSGI_FRAMEWORK_DEPRECATED_BUNDLE_ACTIVATOR_START);
+                        stop_function_fp stop = (stop_function_fp) fw_getActivatorSymbol(bundle, OSGI_FRAMEWORK_BUNDLE_ACTIVATOR_STOP, OSGI_FRAMEWORK_DEPRECATED_BUNDLE_ACTIVATOR_STOP);
+                        destroy_function_fp destroy = (destroy_function_fp) fw_getActivatorSymbol(bundle, OSGI_FRAMEWORK_BUNDLE_ACTIVATOR_DESTROY, OSGI_FRAMEWORK_DEPRECATED_BUNDLE_ACTIVATOR_DESTROY);
 
                         activator->create = create;
                         activator->start = start;
@@ -961,9 +1753,17 @@ celix_status_t fw_startBundle(framework_pt framework, bundle_pt bundle, int opti
 
                         status = CELIX_DO_IF(status, bundle_getContext(bundle, &context));
 
+                        CELIX_PROBE2(bundle_start, bndId, name);
+
+                        //listener hooks are called once for all the listeners added during the bundle create & start
+                        serviceRegistry_beginListenerHookBatch(framework->registry, bundle);
+                        //threads created in the activator create & start are owned by the bundle
+                        long prevThreadOwner = celixThread_setCreationOwner(bndId);
                         if (status == CELIX_SUCCESS) {
                             if (create != NULL) {
+                                struct timespec createStart = celix_startupTrace_now();
                                 status = CELIX_DO_IF(status, create(context, &userData));
+                                celix_startupTrace_addEvent(framework->startupTrace, "bundle", "create", name, bndId, &createStart);
                                 if (status == CELIX_SUCCESS) {
                                     activator->userData = userData;
                                 }
@@ -971,9 +1771,14 @@ celix_status_t fw_startBundle(framework_pt framework, bundle_pt bundle, int opti
                         }
                         if (status == CELIX_SUCCESS) {
                             if (start != NULL) {
+                                struct timespec startStart = celix_startupTrace_now();
                                 status = CELIX_DO_IF(status, start(userData, context));
+                                celix_startupTrace_addEvent(framework->startupTrace, "bundle", "start", name, bndId, &startStart);
                             }
                         }
+                        celixThread_setCreationOwner(prevThreadOwner);
+                        serviceRegistry_endListenerHookBatch(framework->registry, bundle);
+                        CELIX_PROBE2(bundle_started, bndId, status);
 
                         status = CELIX_DO_IF(status, framework_setBundleStateAndNotify(framework, bundle, OSGI_FRAMEWORK_BUNDLE_ACTIVE));
                         status = CELIX_DO_IF(status, fw_fireBundleEvent(framework, OSGI_FRAMEWORK_BUNDLE_EVENT_STARTED, bundle));
@@ -1091,6 +1896,8 @@ celix_status_t fw_stopBundle(framework_pt framework, bundle_pt bundle, bool reco
 	    status = CELIX_DO_IF(status, bundle_setPersistentStateInactive(bundle));
     }
 
+    fw_removePendingLazyBundle(framework, bndId);
+
 	status = CELIX_DO_IF(status, bundle_getState(bundle, &state));
 	if (status == CELIX_SUCCESS) {
 	    switch (state) {
@@ -1125,6 +1932,10 @@ celix_status_t fw_stopBundle(framework_pt framework, bundle_pt bundle, bool reco
 	if (status == CELIX_SUCCESS) {
 	    if (wasActive || (bndId == 0)) {
 	        activator = bundle_getActivator(bundle);
+            CELIX_PROBE1(bundle_stop, bndId);
+            if (bndId > 0) {
+                serviceRegistry_beginListenerHookBatch(framework->registry, bundle);
+            }
 
 	        status = CELIX_DO_IF(status, bundle_getContext(bundle, &context));
 	        if (status == CELIX_SUCCESS) {
@@ -1135,6 +1946,10 @@ celix_status_t fw_stopBundle(framework_pt framework, bundle_pt bundle, bool reco
                         celix_dependencyManager_removeAllComponents(mng);
                     }
                 }
+                if (bndId > 0) {
+                    //note after the activator stop, so that a bundle can cancel its own scheduled events
+                    celix_scheduler_cancelAllFor(framework->scheduler, bndId);
+                }
 	        }
             if (status == CELIX_SUCCESS) {
                 if (activator->destroy != NULL) {
@@ -1144,6 +1959,7 @@ celix_status_t fw_stopBundle(framework_pt framework, bundle_pt bundle, bool reco
 
             if (bndId > 0) {
 	            celix_serviceTracker_syncForContext(bundle->context);
+                serviceRegistry_endListenerHookBatch(framework->registry, bundle); //note before the context is destroyed
                 status = CELIX_DO_IF(status, serviceRegistry_clearServiceRegistrations(framework->registry, bundle));
                 if (status == CELIX_SUCCESS) {
                     module_pt module = NULL;
@@ -1166,6 +1982,7 @@ celix_status_t fw_stopBundle(framework_pt framework, bundle_pt bundle, bool reco
                 //framework bundle
                 celix_serviceTracker_syncForContext(framework->bundle->context);
             }
+            CELIX_PROBE2(bundle_stopped, bndId, status);
 	    }
 
 	    if (activator != NULL) {
@@ -1221,7 +2038,18 @@ celix_status_t fw_uninstallBundle(framework_pt framework, bundle_pt bundle) {
 
     if (entry != NULL) {
         //NOTE wait outside installedBundles.mutex
-        fw_bundleEntry_destroy(entry, true); //wait till use count is 0 -> e.g. not used
+        celixThreadMutex_lock(&entry->useMutex);
+        while (entry->useCount != 0) {
+            celixThreadCondition_wait(&entry->useCond, &entry->useMutex);
+        }
+        entry->removed = true;
+        celixThreadMutex_unlock(&entry->useMutex);
+
+        celixThreadMutex_lock(&framework->installedBundles.mutex);
+        celix_arrayList_remove(framework->installedBundles.entries, entry);
+        fw_bundleTable_update(framework);
+        celixThreadMutex_unlock(&framework->installedBundles.mutex);
+        fw_bundleEntry_destroy(entry, false);
     }
 
     status = CELIX_DO_IF(status, fw_stopBundle(framework, bundle, true));
@@ -1622,9 +2450,23 @@ void fw_addServiceListener(framework_pt framework, bundle_pt bundle, celix_servi
 
     celixThreadMutex_lock(&framework->serviceListenersLock);
 	arrayList_add(framework->serviceListeners, fwListener);
+    if (fwListener->objectClass != NULL) {
+        celix_array_list_t *listeners = hashMap_get(framework->serviceListenersByObjectClass, fwListener->objectClass);
+        if (listeners == NULL) {
+            listeners = celix_arrayList_create();
+            hashMap_put(framework->serviceListenersByObjectClass, strndup(fwListener->objectClass, 1024 * 1024), listeners);
+        }
+        celix_arrayList_add(listeners, fwListener);
+    } else {
+        celix_arrayList_add(framework->wildcardServiceListeners, fwListener);
+    }
     celixThreadMutex_unlock(&framework->serviceListenersLock);
 
     serviceRegistry_callHooksForListenerFilter(framework->registry, bundle, sfilter, false);
+
+    if (fwListener->objectClass != NULL) {
+        fw_activatePendingLazyBundles(framework, fwListener->objectClass);
+    }
 }
 
 void fw_removeServiceListener(framework_pt framework, bundle_pt bundle, celix_service_listener_t *listener) {
@@ -1643,6 +2485,21 @@ void fw_removeServiceListener(framework_pt framework, bundle_pt bundle, celix_se
             break;
         }
     }
+    if (match != NULL && match->objectClass != NULL) {
+        hash_map_entry_t *entry = hashMap_getEntry(framework->serviceListenersByObjectClass, match->objectClass);
+        celix_array_list_t *listeners = entry != NULL ? hashMapEntry_getValue(entry) : NULL;
+        if (listeners != NULL) {
+            celix_arrayList_remove(listeners, match);
+            if (celix_arrayList_size(listeners) == 0) {
+                char *key = hashMapEntry_getKey(entry);
+                hashMap_remove(framework->serviceListenersByObjectClass, match->objectClass);
+                free(key);
+                celix_arrayList_destroy(listeners);
+            }
+        }
+    } else if (match != NULL) {
+        celix_arrayList_remove(framework->wildcardServiceListeners, match);
+    }
     celixThreadMutex_unlock(&framework->serviceListenersLock);
 
 
@@ -1669,6 +2526,10 @@ celix_status_t fw_addBundleListener(framework_pt framework, bundle_pt bundle, bu
     } else {
         bundleListener->listener = listener;
         bundleListener->bundle = bundle;
+        bundleListener->useCount = 0;
+        bundleListener->removed = false;
+        bundleListener->freeOnRelease = false;
+        celixThreadCondition_init(&bundleListener->useCond, NULL);
 
         if (celixThreadMutex_lock(&framework->bundleListenerLock) != CELIX_SUCCESS) {
             status = CELIX_FRAMEWORK_EXCEPTION;
@@ -1700,10 +2561,20 @@ celix_status_t fw_removeBundleListener(framework_pt framework, bundle_pt bundle,
             bundleListener = (fw_bundle_listener_pt) arrayList_get(framework->bundleListeners, i);
             if (bundleListener->listener == listener && bundleListener->bundle == bundle) {
                 arrayList_remove(framework->bundleListeners, i);
-
-                bundleListener->bundle = NULL;
-                bundleListener->listener = NULL;
-                free(bundleListener);
+                bundleListener->removed = true;
+                if (celixThread_equals(celixThread_self(), framework->dispatcher.thread)) {
+                    //removed from a listener callback, cannot wait for the dispatcher
+                    bundleListener->freeOnRelease = bundleListener->useCount > 0;
+                } else {
+                    while (bundleListener->useCount > 0) {
+                        celixThreadCondition_wait(&bundleListener->useCond, &framework->bundleListenerLock);
+                    }
+                }
+                if (!bundleListener->freeOnRelease) {
+                    celixThreadCondition_destroy(&bundleListener->useCond);
+                    free(bundleListener);
+                }
+                break;
             }
         }
         if (celixThreadMutex_unlock(&framework->bundleListenerLock)) {
@@ -1726,6 +2597,10 @@ celix_status_t fw_addFrameworkListener(framework_pt framework, bundle_pt bundle,
     } else {
         frameworkListener->listener = listener;
         frameworkListener->bundle = bundle;
+        frameworkListener->useCount = 0;
+        frameworkListener->removed = false;
+        frameworkListener->freeOnRelease = false;
+        celixThreadCondition_init(&frameworkListener->useCond, NULL);
 
         celixThreadMutex_lock(&framework->frameworkListenersLock);
         arrayList_add(framework->frameworkListeners, frameworkListener);
@@ -1748,10 +2623,20 @@ celix_status_t fw_removeFrameworkListener(framework_pt framework, bundle_pt bund
         frameworkListener = (fw_framework_listener_pt) arrayList_get(framework->frameworkListeners, i);
         if (frameworkListener->listener == listener && frameworkListener->bundle == bundle) {
             arrayList_remove(framework->frameworkListeners, i);
-
-            frameworkListener->bundle = NULL;
-            frameworkListener->listener = NULL;
-            free(frameworkListener);
+            frameworkListener->removed = true;
+            if (celixThread_equals(celixThread_self(), framework->dispatcher.thread)) {
+                //removed from a listener callback, cannot wait for the dispatcher
+                frameworkListener->freeOnRelease = frameworkListener->useCount > 0;
+            } else {
+                while (frameworkListener->useCount > 0) {
+                    celixThreadCondition_wait(&frameworkListener->useCond, &framework->frameworkListenersLock);
+                }
+            }
+            if (!frameworkListener->freeOnRelease) {
+                celixThreadCondition_destroy(&frameworkListener->useCond);
+                free(frameworkListener);
+            }
+            break;
         }
     }
     celixThreadMutex_unlock(&framework->frameworkListenersLock);
@@ -1761,36 +2646,352 @@ celix_status_t fw_removeFrameworkListener(framework_pt framework, bundle_pt bund
     return status;
 }
 
+/**
+ * Delivers a service event to a service listener. The reference is released (unget) after the delivery.
+ */
+static void fw_deliverServiceEvent(celix_framework_t *framework, celix_service_event_type_t eventType, celix_fw_service_listener_entry_t *entry, long serviceId, service_reference_pt reference, const celix_fw_changed_keys_t *changedKeys) {
+    celix_service_event_t event;
+
+    //NOTE: that you are never sure that the UNREGISTERED event will by handle by an service_listener. listener could be gone
+    //Every reference retained is therefore stored and called when a service listener is removed from the framework.
+    if (eventType == OSGI_FRAMEWORK_SERVICE_EVENT_REGISTERED) {
+        serviceRegistry_retainServiceReference(framework->registry, entry->bundle, reference);
+        celixThreadMutex_lock(&entry->mutex);
+        hashMap_put(entry->retainedReferences, (void*)serviceId, reference);
+        celixThreadMutex_unlock(&entry->mutex);
+    }
+
+    event.type = eventType;
+    event.reference = reference;
+    event.changedKeys = changedKeys == NULL ? NULL : changedKeys->keys;
+
+    struct timespec start;
+    struct timespec end;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    entry->listener->serviceChanged(entry->listener, &event);
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    long long elapsed = (end.tv_sec - start.tv_sec) * 1000000000LL + (end.tv_nsec - start.tv_nsec);
+    __atomic_fetch_add(&framework->metrics.nrOfServiceEvents, 1, __ATOMIC_RELAXED);
+    __atomic_fetch_add(&framework->metrics.serviceEventDeliveryInNs, elapsed, __ATOMIC_RELAXED);
+
+    serviceRegistry_ungetServiceReference(framework->registry, entry->bundle, reference);
+
+    if (eventType == OSGI_FRAMEWORK_SERVICE_EVENT_UNREGISTERING) {
+        //if service listener was active when service was registered, release the retained reference
+        celixThreadMutex_lock(&entry->mutex);
+        bool removed = hashMap_remove(entry->retainedReferences, (void*)serviceId) != NULL;
+        celixThreadMutex_unlock(&entry->mutex);
+        if (removed) {
+            serviceRegistry_ungetServiceReference(framework->registry, entry->bundle,
+                                                  reference); // decrease retain counter
+        }
+
+    }
+}
+
+/**
+ * Delivers the pending events of the executor. Should only be called from the executor thread, can be called
+ * reentrant (e.g. from a service listener callback removing a service listener).
+ * Events are taken from the queue in batches, to minimize the locking of the queue.
+ */
+static void fw_serviceEvents_runPending(celix_fw_service_event_executor_t *executor) {
+    for (;;) {
+        if (executor->batchIndex >= celix_arrayList_size(executor->batch)) {
+            celix_arrayList_clear(executor->batch);
+            executor->batchIndex = 0;
+            celixThreadMutex_lock(&executor->mutex);
+            celix_array_list_t *tmp = executor->batch;
+            executor->batch = executor->queue;
+            executor->queue = tmp;
+            celixThreadMutex_unlock(&executor->mutex);
+            if (celix_arrayList_size(executor->batch) == 0) {
+                break;
+            }
+        }
+        celix_fw_service_event_t *event = celix_arrayList_get(executor->batch, executor->batchIndex++);
+        struct timespec now;
+        clock_gettime(CLOCK_MONOTONIC, &now);
+        long long queued = (now.tv_sec - event->queued.tv_sec) * 1000000000LL + (now.tv_nsec - event->queued.tv_nsec);
+        __atomic_fetch_add(&executor->fw->metrics.serviceEventQueueInNs, queued, __ATOMIC_RELAXED);
+        fw_deliverServiceEvent(executor->fw, event->type, event->entry, event->serviceId, event->reference, event->changedKeys);
+        fw_changedKeys_release(event->changedKeys);
+        listener_release(event->entry);
+        if (event->sync != NULL) {
+            celixThreadMutex_lock(&event->sync->mutex);
+            event->sync->pending -= 1;
+            celixThreadCondition_broadcast(&event->sync->cond);
+            celixThreadMutex_unlock(&event->sync->mutex);
+        }
+        free(event);
+    }
+}
+
+static void* fw_serviceEvents_executorThread(void *data) {
+    celix_fw_service_event_executor_t *executor = data;
+    g_currentExecutor = executor;
+    for (;;) {
+        fw_serviceEvents_runPending(executor);
+        celixThreadMutex_lock(&executor->mutex);
+        while (executor->active && celix_arrayList_size(executor->queue) == 0) {
+            celixThreadCondition_wait(&executor->cond, &executor->mutex);
+        }
+        bool stop = !executor->active && celix_arrayList_size(executor->queue) == 0;
+        celixThreadMutex_unlock(&executor->mutex);
+        if (stop) {
+            break;
+        }
+    }
+    g_currentExecutor = NULL;
+    return NULL;
+}
+
+/**
+ * Returns the executor for the service listeners of the provided bundle, the executor is created if needed.
+ * Returns NULL if the executors are stopped.
+ */
+static celix_fw_service_event_executor_t* fw_serviceEvents_getExecutor(celix_framework_t *fw, celix_bundle_t *bnd) {
+    long bndId = celix_bundle_getId(bnd);
+    celix_fw_service_event_executor_t *executor = NULL;
+    celixThreadMutex_lock(&fw->serviceEvents.mutex);
+    if (fw->serviceEvents.active) {
+        executor = hashMap_get(fw->serviceEvents.executors, (void*)bndId);
+        if (executor == NULL) {
+            executor = calloc(1, sizeof(*executor));
+            executor->fw = fw;
+            executor->active = true;
+            executor->queue = celix_arrayList_create();
+            executor->batch = celix_arrayList_create();
+            executor->batchIndex = 0;
+            celixThreadMutex_create(&executor->mutex, NULL);
+            celixThreadCondition_init(&executor->cond, NULL);
+            //note the executor thread runs the service listener callbacks of the bundle, so it is owned by the bundle
+            long prevThreadOwner = celixThread_setCreationOwner(bndId);
+            celix_status_t created = celixThread_create(&executor->thread, NULL, fw_serviceEvents_executorThread, executor);
+            celixThread_setCreationOwner(prevThreadOwner);
+            if (created == CELIX_SUCCESS) {
+                celixThread_setName(&executor->thread, "CelixSvcEvents");
+                hashMap_put(fw->serviceEvents.executors, (void*)bndId, executor);
+            } else {
+                fw_log(fw->logger, OSGI_FRAMEWORK_LOG_ERROR, "Cannot create service event executor thread for bundle %li", bndId);
+                celix_arrayList_destroy(executor->queue);
+                celix_arrayList_destroy(executor->batch);
+                celixThreadMutex_destroy(&executor->mutex);
+                celixThreadCondition_destroy(&executor->cond);
+                free(executor);
+                executor = NULL;
+            }
+        }
+    }
+    celixThreadMutex_unlock(&fw->serviceEvents.mutex);
+    return executor;
+}
+
+typedef struct celix_fw_tracker_cleanup {
+    void (*cleanup)(void *data);
+    void *data;
+} celix_fw_tracker_cleanup_t;
+
+static void fw_runTrackerCleanups(celix_array_list_t *jobs) {
+    for (int i = 0; i < celix_arrayList_size(jobs); ++i) {
+        celix_fw_tracker_cleanup_t *job = celix_arrayList_get(jobs, i);
+        job->cleanup(job->data);
+        free(job);
+    }
+}
+
+static void* fw_trackerReaperThread(void *data) {
+    celix_framework_t *fw = data;
+    celix_array_list_t *batch = celix_arrayList_create();
+    for (;;) {
+        celixThreadMutex_lock(&fw->trackerReaper.mutex);
+        while (fw->trackerReaper.active && celix_arrayList_size(fw->trackerReaper.jobs) == 0) {
+            celixThreadCondition_wait(&fw->trackerReaper.cond, &fw->trackerReaper.mutex);
+        }
+        //swap the pending jobs with the (empty) batch list
+        celix_array_list_t *pending = fw->trackerReaper.jobs;
+        fw->trackerReaper.jobs = batch;
+        batch = pending;
+        bool stop = !fw->trackerReaper.active;
+        celixThreadMutex_unlock(&fw->trackerReaper.mutex);
+
+        fw_runTrackerCleanups(batch);
+        celix_arrayList_clear(batch);
+        if (stop) {
+            break;
+        }
+    }
+    celix_arrayList_destroy(batch);
+    return NULL;
+}
+
+void fw_deferTrackerCleanup(celix_framework_t *fw, void (*cleanup)(void *data), void *data) {
+    celixThreadMutex_lock(&fw->trackerReaper.mutex);
+    bool deferred = false;
+    if (fw->trackerReaper.active && !fw->trackerReaper.started) {
+        long prevThreadOwner = celixThread_setCreationOwner(0L);
+        fw->trackerReaper.started = celixThread_create(&fw->trackerReaper.thread, NULL, fw_trackerReaperThread, fw) == CELIX_SUCCESS;
+        celixThread_setCreationOwner(prevThreadOwner);
+        if (fw->trackerReaper.started) {
+            celixThread_setName(&fw->trackerReaper.thread, "CelixTrkReaper");
+        } else {
+            fw_log(fw->logger, OSGI_FRAMEWORK_LOG_ERROR, "Cannot create tracker reaper thread");
+        }
+    }
+    if (fw->trackerReaper.active && fw->trackerReaper.started) {
+        celix_fw_tracker_cleanup_t *job = malloc(sizeof(*job));
+        job->cleanup = cleanup;
+        job->data = data;
+        celix_arrayList_add(fw->trackerReaper.jobs, job);
+        celixThreadCondition_signal(&fw->trackerReaper.cond);
+        deferred = true;
+    }
+    celixThreadMutex_unlock(&fw->trackerReaper.mutex);
+
+    if (!deferred) {
+        cleanup(data);
+    }
+}
+
+/**
+ * Stops the tracker reaper, pending cleanups are run first.
+ */
+static void fw_stopTrackerReaper(celix_framework_t *fw) {
+    celixThreadMutex_lock(&fw->trackerReaper.mutex);
+    fw->trackerReaper.active = false;
+    bool started = fw->trackerReaper.started;
+    celixThreadCondition_signal(&fw->trackerReaper.cond);
+    celixThreadMutex_unlock(&fw->trackerReaper.mutex);
+    if (started) {
+        celixThread_join(fw->trackerReaper.thread, NULL);
+    }
+    fw_runTrackerCleanups(fw->trackerReaper.jobs);
+    celix_arrayList_clear(fw->trackerReaper.jobs);
+}
+
+/**
+ * Stops the executors, pending events are delivered first.
+ */
+static void fw_serviceEvents_stopExecutors(celix_framework_t *fw) {
+    celixThreadMutex_lock(&fw->serviceEvents.mutex);
+    fw->serviceEvents.active = false;
+    celixThreadMutex_unlock(&fw->serviceEvents.mutex);
+
+    //note executors map is not updated anymore, because service events are not active anymore
+    hash_map_iterator_t iter = hashMapIterator_construct(fw->serviceEvents.executors);
+    while (hashMapIterator_hasNext(&iter)) {
+        celix_fw_service_event_executor_t *executor = hashMapIterator_nextValue(&iter);
+        celixThreadMutex_lock(&executor->mutex);
+        executor->active = false;
+        celixThreadCondition_broadcast(&executor->cond);
+        celixThreadMutex_unlock(&executor->mutex);
+        celixThread_join(executor->thread, NULL);
+
+        celix_arrayList_destroy(executor->queue);
+        celix_arrayList_destroy(executor->batch);
+        celixThreadMutex_destroy(&executor->mutex);
+        celixThreadCondition_destroy(&executor->cond);
+        free(executor);
+    }
+    hashMap_destroy(fw->serviceEvents.executors, false, false);
+    fw->serviceEvents.executors = NULL;
+}
+
+static void fw_serviceChangedInternal(celix_framework_t *framework, celix_service_event_type_t eventType, service_registration_t **registrations, size_t nrOfRegistrations, const celix_properties_t *oldProps);
+
 void fw_serviceChanged(framework_pt framework, celix_service_event_type_t eventType, service_registration_pt registration, properties_pt oldprops) {
+    CELIX_PROBE3(fw_service_changed_entry, (int)eventType, registration->serviceId, 1);
+    fw_serviceChangedInternal(framework, eventType, &registration, 1, oldprops);
+    CELIX_PROBE3(fw_service_changed_exit, (int)eventType, registration->serviceId, 1);
+}
+
+void fw_serviceChangedForRegistrations(celix_framework_t *framework, celix_service_event_type_t eventType, service_registration_t **registrations, size_t nrOfRegistrations) {
+    unsigned long firstSvcId __attribute__((unused)) = nrOfRegistrations > 0 ? registrations[0]->serviceId : 0;
+    CELIX_PROBE3(fw_service_changed_entry, (int)eventType, firstSvcId, nrOfRegistrations);
+    fw_serviceChangedInternal(framework, eventType, registrations, nrOfRegistrations, NULL);
+    CELIX_PROBE3(fw_service_changed_exit, (int)eventType, firstSvcId, nrOfRegistrations);
+}
+
+/**
+ * Delivers the service event for the registrations to the matching service listeners.
+ * For a MODIFIED event the old properties (of the single registration) are used to determine the changed keys,
+ * listeners with a filter which matched the old properties, but not the new properties get a MODIFIED_ENDMATCH event.
+ * The old properties are only matched if one of the changed keys is used in the filter.
+ */
+static void fw_serviceChangedInternal(celix_framework_t *framework, celix_service_event_type_t eventType, service_registration_t **registrations, size_t nrOfRegistrations, const celix_properties_t *oldProps) {
     unsigned int i;
     celix_fw_service_listener_entry_t *entry;
 
     celix_array_list_t* retainedEntries = celix_arrayList_create();
-    celix_array_list_t* matchedEntries = celix_arrayList_create();
 
+    //only listeners for the objectClass of the services and listeners without a required objectClass can match
+    //note the listeners are collected once for all registrations
     celixThreadMutex_lock(&framework->serviceListenersLock);
-    for (i = 0; i < celix_arrayList_size(framework->serviceListeners); i++) {
-        entry = (celix_fw_service_listener_entry_t *) celix_arrayList_get(framework->serviceListeners, i);
-        celix_arrayList_add(retainedEntries, entry);
-        listener_retain(entry); //ensure that use count > 0, so that the listener cannot be destroyed until all pending event are handled.
+    for (size_t r = 0; r < nrOfRegistrations; ++r) {
+        const char *serviceName = NULL;
+        serviceRegistration_getServiceName(registrations[r], &serviceName);
+        bool alreadyCollected = false;
+        for (size_t k = 0; serviceName != NULL && k < r; ++k) {
+            const char *otherName = NULL;
+            serviceRegistration_getServiceName(registrations[k], &otherName);
+            alreadyCollected = alreadyCollected || (otherName != NULL && strcmp(serviceName, otherName) == 0);
+        }
+        celix_array_list_t *listeners = serviceName == NULL || alreadyCollected ? NULL : hashMap_get(framework->serviceListenersByObjectClass, serviceName);
+        if (listeners != NULL) {
+            celix_arrayList_addAll(retainedEntries, listeners);
+        }
+    }
+    celix_arrayList_addAll(retainedEntries, framework->wildcardServiceListeners);
+    const celix_array_list_entry_t *retained = celix_arrayList_data(retainedEntries);
+    for (i = 0; i < celix_arrayList_size(retainedEntries); i++) {
+        //ensure that use count > 0, so that the listener cannot be destroyed until all pending event are handled.
+        listener_retain(retained[i].voidPtrVal);
     }
     celixThreadMutex_unlock(&framework->serviceListenersLock);
 
-    for (i = 0; i < celix_arrayList_size(retainedEntries); ++i) {
-        entry = (celix_fw_service_listener_entry_t *) celix_arrayList_get(retainedEntries, i);
-        int matched = 0;
+    //match the listeners for every registration, matched entries are retained (again) for the delivery
+    celix_array_list_t *matchedEntries = celix_arrayList_create(); //value = celix_fw_service_listener_entry_t*
+    celix_array_list_t *matchedRegistrations = celix_arrayList_create(); //value = service_registration_t*, same index as matchedEntries
+    celix_array_list_t *matchedTypes = celix_arrayList_create(); //value = celix_service_event_type_t (int), same index as matchedEntries
+    celix_fw_changed_keys_t *changedKeys = NULL;
+    for (size_t r = 0; r < nrOfRegistrations; ++r) {
+        const char *serviceName = NULL;
         properties_pt props = NULL;
-        bool matchResult = false;
-        serviceRegistration_getProperties(registration, &props);
-        if (entry->filter != NULL) {
-            filter_match(entry->filter, props, &matchResult);
-        }
-        matched = (entry->filter == NULL) || matchResult;
-        if (matched) {
-            celix_arrayList_add(matchedEntries, entry);
-        } else {
-            listener_release(entry); //Not a match -> release entry
+        serviceRegistration_getServiceName(registrations[r], &serviceName);
+        serviceRegistration_getProperties(registrations[r], &props);
+        if (eventType == OSGI_FRAMEWORK_SERVICE_EVENT_MODIFIED && nrOfRegistrations == 1) {
+            changedKeys = fw_changedKeys_create(oldProps, props);
         }
+
+        for (i = 0; i < celix_arrayList_size(retainedEntries); ++i) {
+            entry = (celix_fw_service_listener_entry_t *) celix_arrayList_get(retainedEntries, i);
+            if (entry->objectClass != NULL && (serviceName == NULL || strcmp(entry->objectClass, serviceName) != 0)) {
+                continue; //listener for an other objectClass
+            }
+            bool matchResult = false;
+            if (entry->filter != NULL) {
+                filter_match(entry->filter, props, &matchResult);
+            }
+            celix_service_event_type_t type = eventType;
+            if (entry->filter != NULL && !matchResult && changedKeys != NULL && listener_filterUsesKeys(entry, changedKeys->keys)) {
+                //note only a change of a key used in the filter can end the match
+                bool oldMatchResult = false;
+                filter_match(entry->filter, (celix_properties_t*)oldProps, &oldMatchResult);
+                if (oldMatchResult) {
+                    type = OSGI_FRAMEWORK_SERVICE_EVENT_MODIFIED_ENDMATCH;
+                    matchResult = true;
+                }
+            }
+            if (entry->filter == NULL || matchResult) {
+                listener_retain(entry);
+                celix_arrayList_add(matchedEntries, entry);
+                celix_arrayList_add(matchedRegistrations, registrations[r]);
+                celix_arrayList_addInt(matchedTypes, (int)type);
+            }
+        }
+    }
+    for (i = 0; i < celix_arrayList_size(retainedEntries); ++i) {
+        entry = (celix_fw_service_listener_entry_t *) celix_arrayList_get(retainedEntries, i);
+        listener_release(entry); //release the collected entry, matched entries are still retained
     }
     celix_arrayList_destroy(retainedEntries);
 
@@ -1801,49 +3002,74 @@ void fw_serviceChanged(framework_pt framework, celix_service_event_type_t eventT
      * usageCount on > 0.
      *
      * Not sure how to prevent/handle this.
+     * Note that this cannot happen when service events are delivered async, see CELIX_FRAMEWORK_SERVICE_EVENTS_ASYNC_NAME.
      */
+    celix_fw_service_event_sync_t sync;
+    bool waitForDelivery = false;
+    if (framework->serviceEvents.async && eventType == OSGI_FRAMEWORK_SERVICE_EVENT_UNREGISTERING) {
+        waitForDelivery = true;
+        sync.pending = 0;
+        celixThreadMutex_create(&sync.mutex, NULL);
+        celixThreadCondition_init(&sync.cond, NULL);
+    }
+
     for (i = 0; i < celix_arrayList_size(matchedEntries); ++i) {
         entry = (celix_fw_service_listener_entry_t *) celix_arrayList_get(matchedEntries, i);
+        service_registration_t *registration = celix_arrayList_get(matchedRegistrations, i);
+        celix_service_event_type_t type = (celix_service_event_type_t)celix_arrayList_getInt(matchedTypes, i);
 
         service_reference_pt reference = NULL;
-        celix_service_event_t event;
-
         serviceRegistry_getServiceReference(framework->registry, entry->bundle, registration, &reference);
 
-        //NOTE: that you are never sure that the UNREGISTERED event will by handle by an service_listener. listener could be gone
-        //Every reference retained is therefore stored and called when a service listener is removed from the framework.
-        if (eventType == OSGI_FRAMEWORK_SERVICE_EVENT_REGISTERED) {
-            serviceRegistry_retainServiceReference(framework->registry, entry->bundle, reference);
-            celixThreadMutex_lock(&entry->mutex);
-            arrayList_add(entry->retainedReferences, reference); //TODO improve by using set (or hashmap) instead of list
-            celixThreadMutex_unlock(&entry->mutex);
-        }
-
-        event.type = eventType;
-        event.reference = reference;
-
-        entry->listener->serviceChanged(entry->listener, &event);
-
-        serviceRegistry_ungetServiceReference(framework->registry, entry->bundle, reference);
-
-        if (eventType == OSGI_FRAMEWORK_SERVICE_EVENT_UNREGISTERING) {
-            //if service listener was active when service was registered, release the retained reference
-            celixThreadMutex_lock(&entry->mutex);
-            bool removed = arrayList_removeElement(entry->retainedReferences, reference);
-            celixThreadMutex_unlock(&entry->mutex);
-            if (removed) {
-                serviceRegistry_ungetServiceReference(framework->registry, entry->bundle,
-                                                      reference); // decrease retain counter
+        celix_fw_service_event_executor_t *executor = framework->serviceEvents.async ? fw_serviceEvents_getExecutor(framework, entry->bundle) : NULL;
+        if (executor != NULL) {
+            celix_fw_service_event_t *event = calloc(1, sizeof(*event));
+            event->type = type;
+            event->serviceId = (long)registration->serviceId;
+            event->reference = reference;
+            event->changedKeys = changedKeys;
+            fw_changedKeys_retain(changedKeys);
+            event->entry = entry;
+            if (waitForDelivery) {
+                event->sync = &sync;
+                celixThreadMutex_lock(&sync.mutex);
+                sync.pending += 1;
+                celixThreadMutex_unlock(&sync.mutex);
             }
-
-        }
-
-        if (eventType == OSGI_FRAMEWORK_SERVICE_EVENT_MODIFIED) {
-            entry->listener->serviceChanged(entry->listener, &event);
+            clock_gettime(CLOCK_MONOTONIC, &event->queued);
+            celixThreadMutex_lock(&executor->mutex);
+            celix_arrayList_add(executor->queue, event);
+            celixThreadCondition_signal(&executor->cond);
+            celixThreadMutex_unlock(&executor->mutex);
+        } else {
+            fw_deliverServiceEvent(framework, type, entry, (long)registration->serviceId, reference, changedKeys);
+            listener_release(entry); //decrease usage, so that the listener can be destroyed (if use count is now 0)
         }
-        listener_release(entry); //decrease usage, so that the listener can be destroyed (if use count is now 0)
     }
     celix_arrayList_destroy(matchedEntries);
+    celix_arrayList_destroy(matchedRegistrations);
+    celix_arrayList_destroy(matchedTypes);
+    fw_changedKeys_release(changedKeys);
+
+    if (waitForDelivery) {
+        celixThreadMutex_lock(&sync.mutex);
+        while (sync.pending > 0) {
+            if (g_currentExecutor != NULL) {
+                //called from a executor thread, keep delivering the events of this executor while waiting
+                celixThreadMutex_unlock(&sync.mutex);
+                fw_serviceEvents_runPending(g_currentExecutor);
+                celixThreadMutex_lock(&sync.mutex);
+                if (sync.pending > 0) {
+                    celixThreadCondition_timedwaitRelative(&sync.cond, &sync.mutex, 0, 1000000);
+                }
+            } else {
+                celixThreadCondition_wait(&sync.cond, &sync.mutex);
+            }
+        }
+        celixThreadMutex_unlock(&sync.mutex);
+        celixThreadMutex_destroy(&sync.mutex);
+        celixThreadCondition_destroy(&sync.cond);
+    }
 }
 
 //celix_status_t fw_isServiceAssignable(framework_pt fw, bundle_pt requester, service_reference_pt reference, bool *assignable) {
@@ -1868,13 +3094,12 @@ long framework_getNextBundleId(framework_pt framework) {
     return id;
 }
 
-celix_status_t framework_markResolvedModules(framework_pt framework, linked_list_pt resolvedModuleWireMap) {
+celix_status_t framework_markResolvedModules(framework_pt framework, celix_ilist_t *resolvedModuleWireMap) {
     celix_status_t status = CELIX_SUCCESS;
     if (resolvedModuleWireMap != NULL) {
-        // hash_map_iterator_pt iterator = hashMapIterator_create(resolvedModuleWireMap);
-        linked_list_iterator_pt iterator = linkedListIterator_create(resolvedModuleWireMap, linkedList_size(resolvedModuleWireMap));
-        while (linkedListIterator_hasPrevious(iterator)) {
-            importer_wires_pt iw = linkedListIterator_previous(iterator);
+        celix_ilist_node_t *node = NULL;
+        while ((node = celix_ilist_popBack(resolvedModuleWireMap)) != NULL) {
+            importer_wires_pt iw = CELIX_ILIST_ENTRY(node, struct importer_wires, node);
             // hash_map_entry_pt entry = hashMapIterator_nextEntry(iterator);
             module_pt module = iw->importer;
 
@@ -1936,11 +3161,9 @@ celix_status_t framework_markResolvedModules(framework_pt framework, linked_list
                     module_setResolved(module);
                 }
             }
-            linkedListIterator_remove(iterator);
             free(iw);
         }
-        linkedListIterator_destroy(iterator);
-        linkedList_destroy(resolvedModuleWireMap);
+        free(resolvedModuleWireMap);
     }
     return status;
 }
@@ -1964,7 +3187,7 @@ celix_status_t framework_markBundleResolved(framework_pt framework, module_pt mo
             // Load libraries of this module
             bool isSystemBundle = false;
             bundle_isSystemBundle(bundle, &isSystemBundle);
-            if (!isSystemBundle) {
+            if (!isSystemBundle && !fw_isLibraryLoadingDeferred(bundle)) {
                 status = CELIX_DO_IF(status, framework_loadBundleLibraries(framework, bundle));
             }
 
@@ -2032,19 +3255,10 @@ bundle_pt framework_getBundle(framework_pt framework, const char* location) {
 }
 
 bundle_pt framework_getBundleById(framework_pt framework, long id) {
-    bundle_t *bnd = NULL;
-
-    celixThreadMutex_lock(&framework->installedBundles.mutex);
-    int size = celix_arrayList_size(framework->installedBundles.entries);
-    for (int i = 0; i < size; ++i) {
-        celix_framework_bundle_entry_t *entry = celix_arrayList_get(framework->installedBundles.entries, i);
-        if (entry != NULL && entry->bndId == id) {
-            bnd = entry->bnd;
-            break;
-        }
-    }
-    celixThreadMutex_unlock(&framework->installedBundles.mutex);
-
+    celix_framework_bundle_table_t *table = fw_bundleTable_acquire(framework);
+    celix_framework_bundle_entry_t *entry = fw_bundleTable_get(table, id);
+    bundle_t *bnd = entry != NULL ? entry->bnd : NULL;
+    fw_bundleTable_release(table);
     return bnd;
 }
 
@@ -2065,20 +3279,194 @@ celix_status_t framework_waitForStop(framework_pt framework) {
     return CELIX_SUCCESS;
 }
 
+typedef struct fw_shutdown_job {
+    celix_framework_bundle_entry_t *entry;
+    char *name;
+    //protected by the pool mutex
+    bool started;
+    bool done;
+    bool abandoned; //true if the shutdown stopped waiting for the bundle (timeout)
+    struct timespec startTime;
+    double durationInSeconds;
+} fw_shutdown_job_t;
+
+typedef struct fw_shutdown_pool {
+    celix_framework_t *fw;
+    celix_thread_mutex_t mutex; //protects the fields below and the job state
+    celix_thread_cond_t cond; //broadcasted when a job is queued, started or done
+    celix_array_list_t *queue; //value = fw_shutdown_job_t*
+    bool active;
+    celix_array_list_t *workers; //value = celix_thread_t*, only used by the shutdown thread
+} fw_shutdown_pool_t;
+
+static double framework_secondsSince(const struct timespec *start) {
+    struct timespec now = celix_startupTrace_now();
+    return (double)(now.tv_sec - start->tv_sec) + (double)(now.tv_nsec - start->tv_nsec) / 1E9;
+}
+
+static void framework_shutdownStopBundle(celix_framework_t *fw, fw_shutdown_job_t *job) {
+    struct timespec start = celix_startupTrace_now();
+
+    //wait until entry use counts is 0
+    bundle_t *bnd = job->entry->bnd;
+    fw_bundleEntry_waitTillNotUsed(job->entry);
+
+    bundle_state_e state;
+    bundle_getState(bnd, &state);
+    if (state == OSGI_FRAMEWORK_BUNDLE_ACTIVE || state == OSGI_FRAMEWORK_BUNDLE_STARTING) {
+        fw_stopBundle(fw, bnd, 0);
+    }
+    bundle_close(bnd);
+
+    job->durationInSeconds = framework_secondsSince(&start);
+    celix_startupTrace_addEvent(fw->startupTrace, "bundle", "shutdownStop", job->name, job->entry->bndId, &start);
+}
+
+static void* framework_shutdownWorker(void *data) {
+    fw_shutdown_pool_t *pool = data;
+    for (;;) {
+        celixThreadMutex_lock(&pool->mutex);
+        while (pool->active && celix_arrayList_size(pool->queue) == 0) {
+            celixThreadCondition_wait(&pool->cond, &pool->mutex);
+        }
+        if (celix_arrayList_size(pool->queue) == 0) {
+            celixThreadMutex_unlock(&pool->mutex);
+            break;
+        }
+        fw_shutdown_job_t *job = celix_arrayList_get(pool->queue, 0);
+        celix_arrayList_removeAt(pool->queue, 0);
+        job->started = true;
+        job->startTime = celix_startupTrace_now();
+        celixThreadCondition_broadcast(&pool->cond);
+        celixThreadMutex_unlock(&pool->mutex);
+
+        framework_shutdownStopBundle(pool->fw, job);
+
+        celixThreadMutex_lock(&pool->mutex);
+        job->done = true;
+        celixThreadCondition_broadcast(&pool->cond);
+        celixThreadMutex_unlock(&pool->mutex);
+    }
+    return NULL;
+}
+
+static bool framework_shutdownAddWorker(fw_shutdown_pool_t *pool) {
+    celix_thread_t *worker = malloc(sizeof(*worker));
+    if (celixThread_create(worker, NULL, framework_shutdownWorker, pool) != CELIX_SUCCESS) {
+        free(worker);
+        return false;
+    }
+    celixThread_setName(worker, "CelixStop");
+    celix_arrayList_add(pool->workers, worker);
+    return true;
+}
+
+/**
+ * Waits till the jobs of a wave are done. If timeoutInSeconds > 0, jobs running longer than the timeout are logged
+ * and not waited for anymore; a worker is added to replace the worker still stopping the bundle.
+ */
+static void framework_shutdownWaitForWave(fw_shutdown_pool_t *pool, celix_array_list_t *wave, double timeoutInSeconds) {
+    celixThreadMutex_lock(&pool->mutex);
+    for (;;) {
+        bool waiting = false;
+        double minRemaining = -1.0;
+        for (int i = 0; i < celix_arrayList_size(wave); ++i) {
+            fw_shutdown_job_t *job = celix_arrayList_get(wave, i);
+            if (job->done || job->abandoned) {
+                continue;
+            }
+            if (job->started && timeoutInSeconds > 0) {
+                double remaining = timeoutInSeconds - framework_secondsSince(&job->startTime);
+                if (remaining <= 0) {
+                    job->abandoned = true;
+                    fw_log(pool->fw->logger, OSGI_FRAMEWORK_LOG_WARNING, "FRAMEWORK: Bundle %s [%li] did not stop within %.1f seconds, continuing shutdown", job->name, job->entry->bndId, timeoutInSeconds);
+                    framework_shutdownAddWorker(pool);
+                    continue;
+                }
+                if (minRemaining < 0 || remaining < minRemaining) {
+                    minRemaining = remaining;
+                }
+            }
+            waiting = true;
+        }
+        if (!waiting) {
+            break;
+        }
+        if (minRemaining > 0) {
+            long ns = (long)(minRemaining * 1E9) + 1;
+            celixThreadCondition_timedwaitRelative(&pool->cond, &pool->mutex, ns / 1000000000L, ns % 1000000000L);
+        } else {
+            celixThreadCondition_wait(&pool->cond, &pool->mutex);
+        }
+    }
+    celixThreadMutex_unlock(&pool->mutex);
+}
+
+/**
+ * Creates the next stop wave: the not yet stopped bundles which services are not used by other not yet stopped
+ * bundles, latest installed first. If every bundle is used (a usage cycle), the latest installed bundle is used.
+ */
+static void framework_shutdownNextWave(celix_framework_t *fw, celix_array_list_t *remaining, celix_array_list_t *wave) {
+    int size = celix_arrayList_size(remaining);
+    bool used[size > 0 ? size : 1];
+    memset(used, 0, sizeof(used));
+    celix_array_list_t *owners = celix_arrayList_create();
+    for (int i = 0; i < size; ++i) {
+        fw_shutdown_job_t *user = celix_arrayList_get(remaining, i);
+        celix_arrayList_clear(owners);
+        serviceRegistry_getServiceOwnersUsedBy(fw->registry, user->entry->bnd, owners);
+        for (int k = 0; k < celix_arrayList_size(owners); ++k) {
+            bundle_t *owner = celix_arrayList_get(owners, k);
+            for (int j = 0; j < size; ++j) {
+                fw_shutdown_job_t *candidate = celix_arrayList_get(remaining, j);
+                if (j != i && candidate->entry->bnd == owner) {
+                    used[j] = true;
+                }
+            }
+        }
+    }
+    celix_arrayList_destroy(owners);
+
+    for (int i = size - 1; i >= 0; --i) {
+        if (!used[i]) {
+            celix_arrayList_add(wave, celix_arrayList_get(remaining, i));
+        }
+    }
+    if (celix_arrayList_size(wave) == 0 && size > 0) {
+        celix_arrayList_add(wave, celix_arrayList_get(remaining, size - 1));
+    }
+    for (int i = 0; i < celix_arrayList_size(wave); ++i) {
+        celix_arrayList_remove(remaining, celix_arrayList_get(wave, i));
+    }
+}
+
 static void* framework_shutdown(void *framework) {
     framework_pt fw = (framework_pt) framework;
 
     fw_log(fw->logger, OSGI_FRAMEWORK_LOG_INFO, "FRAMEWORK: Shutdown");
+    struct timespec shutdownStart = celix_startupTrace_now();
+
+    const char *threadsStr = NULL;
+    const char *timeoutStr = NULL;
+    fw_getProperty(fw, CELIX_FRAMEWORK_SHUTDOWN_THREADS_NAME, NULL, &threadsStr);
+    fw_getProperty(fw, CELIX_FRAMEWORK_SHUTDOWN_BUNDLE_TIMEOUT_NAME, NULL, &timeoutStr);
+    long nrOfThreads = threadsStr == NULL ? CELIX_FRAMEWORK_SHUTDOWN_THREADS_DEFAULT : strtol(threadsStr, NULL, 10);
+    double timeout = timeoutStr == NULL ? CELIX_FRAMEWORK_SHUTDOWN_BUNDLE_TIMEOUT_DEFAULT : strtod(timeoutStr, NULL);
+    nrOfThreads = nrOfThreads < 1 ? 1 : nrOfThreads;
 
     //celix_framework_bundle_entry_t *fwEntry = NULL;
-    celix_array_list_t *stopEntries = celix_arrayList_create();
+    celix_array_list_t *stopJobs = celix_arrayList_create(); //value = fw_shutdown_job_t*, ordered on install time
     celix_framework_bundle_entry_t *fwEntry = NULL;
     celixThreadMutex_lock(&fw->installedBundles.mutex);
     int size = celix_arrayList_size(fw->installedBundles.entries);
     for (int i = 0; i < size; ++i) {
         celix_framework_bundle_entry_t *entry = celix_arrayList_get(fw->installedBundles.entries, i);
         if (entry->bndId != 0) { //i.e. not framework bundle
-            celix_arrayList_add(stopEntries, entry);
+            fw_shutdown_job_t *job = calloc(1, sizeof(*job));
+            job->entry = entry;
+            const char *name = celix_bundle_getSymbolicName(entry->bnd);
+            job->name = strdup(name == NULL ? "unknown" : name);
+            celix_arrayList_add(stopJobs, job);
         } else {
             fwEntry = entry;
         }
@@ -2086,25 +3474,88 @@ static void* framework_shutdown(void *framework) {
 //	celix_arrayList_clear(fw->installedBundles.entries);
     celixThreadMutex_unlock(&fw->installedBundles.mutex);
 
+    //note with a timeout a separate thread is needed to be able to continue the shutdown
+    fw_shutdown_pool_t pool;
+    pool.fw = fw;
+    pool.active = true;
+    pool.queue = celix_arrayList_create();
+    pool.workers = celix_arrayList_create();
+    celixThreadMutex_create(&pool.mutex, NULL);
+    celixThreadCondition_init(&pool.cond, NULL);
+    if (nrOfThreads > 1 || timeout > 0) {
+        celixThreadMutex_lock(&pool.mutex);
+        for (long i = 0; i < nrOfThreads; ++i) {
+            framework_shutdownAddWorker(&pool);
+        }
+        celixThreadMutex_unlock(&pool.mutex);
+    }
+    bool usePool = celix_arrayList_size(pool.workers) > 0;
 
-    size = celix_arrayList_size(stopEntries);
-    for (int i = size-1; i >= 0; --i) { //note loop in reverse order -> stop later installed bundle first
-        celix_framework_bundle_entry_t *entry = celix_arrayList_get(stopEntries, i);
-
-        //wait until entry use counts is 0
-        bundle_t *bnd = entry->bnd;
-        fw_bundleEntry_waitTillNotUsed(entry);
-
-        bundle_state_e state;
-        bundle_getState(bnd, &state);
-        if (state == OSGI_FRAMEWORK_BUNDLE_ACTIVE || state == OSGI_FRAMEWORK_BUNDLE_STARTING) {
-            fw_stopBundle(fw, bnd, 0);
+    int nrOfWaves = 0;
+    celix_array_list_t *remaining = celix_arrayList_create();
+    for (int i = 0; i < celix_arrayList_size(stopJobs); ++i) {
+        celix_arrayList_add(remaining, celix_arrayList_get(stopJobs, i));
+    }
+    celix_array_list_t *wave = celix_arrayList_create();
+    while (celix_arrayList_size(remaining) > 0) {
+        celix_arrayList_clear(wave);
+        framework_shutdownNextWave(fw, remaining, wave);
+        nrOfWaves += 1;
+        if (usePool) {
+            celixThreadMutex_lock(&pool.mutex);
+            for (int i = 0; i < celix_arrayList_size(wave); ++i) {
+                celix_arrayList_add(pool.queue, celix_arrayList_get(wave, i));
+            }
+            celixThreadCondition_broadcast(&pool.cond);
+            celixThreadMutex_unlock(&pool.mutex);
+            framework_shutdownWaitForWave(&pool, wave, timeout);
+        } else {
+            for (int i = 0; i < celix_arrayList_size(wave); ++i) {
+                fw_shutdown_job_t *job = celix_arrayList_get(wave, i);
+                framework_shutdownStopBundle(fw, job);
+                job->done = true;
+            }
         }
-        bundle_close(bnd);
     }
-    celix_arrayList_destroy(stopEntries);
+    celix_arrayList_destroy(wave);
+    celix_arrayList_destroy(remaining);
+
+    //stop the workers, this also waits for the bundles which did not stop in time
+    celixThreadMutex_lock(&pool.mutex);
+    pool.active = false;
+    celixThreadCondition_broadcast(&pool.cond);
+    celixThreadMutex_unlock(&pool.mutex);
+    for (int i = 0; i < celix_arrayList_size(pool.workers); ++i) {
+        celix_thread_t *worker = celix_arrayList_get(pool.workers, i);
+        celixThread_join(*worker, NULL);
+        free(worker);
+    }
+    celix_arrayList_destroy(pool.workers);
+    celix_arrayList_destroy(pool.queue);
+    celixThreadMutex_destroy(&pool.mutex);
+    celixThreadCondition_destroy(&pool.cond);
+
+    //timing report
+    for (int i = 0; i < celix_arrayList_size(stopJobs); ++i) {
+        fw_shutdown_job_t *job = celix_arrayList_get(stopJobs, i);
+        fw_log(fw->logger, OSGI_FRAMEWORK_LOG_DEBUG, "FRAMEWORK: Stopped bundle %s [%li] in %.3f seconds", job->name, job->entry->bndId, job->durationInSeconds);
+        free(job->name);
+        free(job);
+    }
+    fw_log(fw->logger, OSGI_FRAMEWORK_LOG_INFO, "FRAMEWORK: Stopped %i bundles in %i waves in %.3f seconds", celix_arrayList_size(stopJobs), nrOfWaves, framework_secondsSince(&shutdownStart));
+    celix_arrayList_destroy(stopJobs);
 
 
+    //note the scheduler service is used by all bundles, so it is unregistered after the bundles are stopped
+    if (fw->metrics.providerSvcId >= 0) {
+        celix_bundleContext_unregisterService(framework_getContext(fw), fw->metrics.providerSvcId);
+        fw->metrics.providerSvcId = -1L;
+    }
+    if (fw->schedulerSvcId >= 0) {
+        celix_bundleContext_unregisterService(framework_getContext(fw), fw->schedulerSvcId);
+        fw->schedulerSvcId = -1L;
+    }
+
     // 'stop' framework bundle
     if (fwEntry != NULL) {
         bundle_t *bnd = fwEntry->bnd;
@@ -2162,7 +3613,6 @@ celix_status_t fw_fireBundleEvent(framework_pt framework, bundle_event_type_e ev
 
             request->eventType = eventType;
             request->filter = NULL;
-            request->listeners = framework->bundleListeners;
             request->type = BUNDLE_EVENT_TYPE;
             request->error = NULL;
             request->bundleId = -1;
@@ -2191,10 +3641,7 @@ celix_status_t fw_fireBundleEvent(framework_pt framework, bundle_event_type_e ev
                 }
             }
 
-            celixThreadMutex_lock(&framework->dispatcher.mutex);
-            arrayList_add(framework->dispatcher.requests, request);
-            celixThreadCondition_broadcast(&framework->dispatcher.cond);
-            celixThreadMutex_unlock(&framework->dispatcher.mutex);
+            fw_enqueueRequest(framework, request);
 
         }
     }
@@ -2216,11 +3663,11 @@ celix_status_t fw_fireFrameworkEvent(framework_pt framework, framework_event_typ
 
         request->eventType = eventType;
         request->filter = NULL;
-        request->listeners = framework->frameworkListeners;
         request->type = FRAMEWORK_EVENT_TYPE;
         request->errorCode = errorCode;
-        request->error = "";
+        request->error = NULL;
         request->bundleId = -1;
+        request->bundleSymbolicName = NULL;
 
         status = bundle_getArchive(bundle, &archive);
 
@@ -2246,16 +3693,14 @@ celix_status_t fw_fireFrameworkEvent(framework_pt framework, framework_event_typ
             }
         }
 
+        char message[256];
+        message[0] = '\0';
         if (errorCode != CELIX_SUCCESS) {
-            char message[256];
             celix_strerror(errorCode, message, 256);
-            request->error = message;
         }
+        request->error = strndup(message, sizeof(message));
 
-        celixThreadMutex_lock(&framework->dispatcher.mutex);
-        arrayList_add(framework->dispatcher.requests, request);
-        celixThreadCondition_broadcast(&framework->dispatcher.cond);
-        celixThreadMutex_unlock(&framework->dispatcher.mutex);
+        fw_enqueueRequest(framework, request);
     }
 
     framework_logIfError(framework->logger, status, NULL, "Failed to fire framework event");
@@ -2263,6 +3708,98 @@ celix_status_t fw_fireFrameworkEvent(framework_pt framework, framework_event_typ
     return status;
 }
 
+static void fw_enqueueRequest(celix_framework_t *framework, request_pt request) {
+    clock_gettime(CLOCK_MONOTONIC, &request->enqueueTime);
+    celixThreadMutex_lock(&framework->dispatcher.mutex);
+    arrayList_add(framework->dispatcher.requests, request);
+    size_t depth = (size_t)celix_arrayList_size(framework->dispatcher.requests);
+    if (depth > framework->dispatcher.metrics.maxQueueDepth) {
+        framework->dispatcher.metrics.maxQueueDepth = depth;
+    }
+    celixThreadCondition_broadcast(&framework->dispatcher.cond);
+    celixThreadMutex_unlock(&framework->dispatcher.mutex);
+}
+
+static void fw_dispatchBundleEvent(celix_framework_t *framework, request_pt request, celix_array_list_t *snapshot) {
+    //snapshot the listeners, the listeners are retained so that they are not destroyed during the dispatch
+    celixThreadMutex_lock(&framework->bundleListenerLock);
+    for (int i = 0; i < arrayList_size(framework->bundleListeners); ++i) {
+        fw_bundle_listener_pt listener = arrayList_get(framework->bundleListeners, i);
+        listener->useCount += 1;
+        celix_arrayList_add(snapshot, listener);
+    }
+    celixThreadMutex_unlock(&framework->bundleListenerLock);
+
+    bundle_event_t event;
+    memset(&event, 0, sizeof(event));
+    event.bundleId = request->bundleId;
+    event.bundleSymbolicName = request->bundleSymbolicName;
+    event.type = request->eventType;
+
+    for (int i = 0; i < celix_arrayList_size(snapshot); ++i) {
+        fw_bundle_listener_pt listener = celix_arrayList_get(snapshot, i);
+        celixThreadMutex_lock(&framework->bundleListenerLock);
+        bool removed = listener->removed;
+        celixThreadMutex_unlock(&framework->bundleListenerLock);
+
+        if (!removed) {
+            fw_invokeBundleListener(framework, listener->listener, &event, listener->bundle);
+        }
+
+        celixThreadMutex_lock(&framework->bundleListenerLock);
+        listener->useCount -= 1;
+        bool destroy = listener->freeOnRelease && listener->useCount == 0;
+        celixThreadCondition_broadcast(&listener->useCond);
+        celixThreadMutex_unlock(&framework->bundleListenerLock);
+        if (destroy) {
+            celixThreadCondition_destroy(&listener->useCond);
+            free(listener);
+        }
+    }
+    celix_arrayList_clear(snapshot);
+}
+
+static void fw_dispatchFrameworkEvent(celix_framework_t *framework, request_pt request, celix_array_list_t *snapshot) {
+    //snapshot the listeners, the listeners are retained so that they are not destroyed during the dispatch
+    celixThreadMutex_lock(&framework->frameworkListenersLock);
+    for (int i = 0; i < arrayList_size(framework->frameworkListeners); ++i) {
+        fw_framework_listener_pt listener = arrayList_get(framework->frameworkListeners, i);
+        listener->useCount += 1;
+        celix_arrayList_add(snapshot, listener);
+    }
+    celixThreadMutex_unlock(&framework->frameworkListenersLock);
+
+    framework_event_t event;
+    memset(&event, 0, sizeof(event));
+    event.bundleId = request->bundleId;
+    event.bundleSymbolicName = request->bundleSymbolicName;
+    event.type = request->eventType;
+    event.error = request->error;
+    event.errorCode = request->errorCode;
+
+    for (int i = 0; i < celix_arrayList_size(snapshot); ++i) {
+        fw_framework_listener_pt listener = celix_arrayList_get(snapshot, i);
+        celixThreadMutex_lock(&framework->frameworkListenersLock);
+        bool removed = listener->removed;
+        celixThreadMutex_unlock(&framework->frameworkListenersLock);
+
+        if (!removed) {
+            fw_invokeFrameworkListener(framework, listener->listener, &event, listener->bundle);
+        }
+
+        celixThreadMutex_lock(&framework->frameworkListenersLock);
+        listener->useCount -= 1;
+        bool destroy = listener->freeOnRelease && listener->useCount == 0;
+        celixThreadCondition_broadcast(&listener->useCond);
+        celixThreadMutex_unlock(&framework->frameworkListenersLock);
+        if (destroy) {
+            celixThreadCondition_destroy(&listener->useCond);
+            free(listener);
+        }
+    }
+    celix_arrayList_clear(snapshot);
+}
+
 static void *fw_eventDispatcher(void *fw) {
     framework_pt framework = (framework_pt) fw;
 
@@ -2271,56 +3808,42 @@ static void *fw_eventDispatcher(void *fw) {
     celixThreadMutex_unlock(&framework->dispatcher.mutex);
 
     celix_array_list_t *localRequests = celix_arrayList_create();
+    celix_array_list_t *snapshot = celix_arrayList_create();
 
     while (active) {
         celixThreadMutex_lock(&framework->dispatcher.mutex);
         if (celix_arrayList_size(framework->dispatcher.requests) == 0) {
             celixThreadCondition_wait(&framework->dispatcher.cond, &framework->dispatcher.mutex);
         }
-        for (int i = 0; i < celix_arrayList_size(framework->dispatcher.requests); ++i) {
-            void *r = celix_arrayList_get(framework->dispatcher.requests, i);
-            celix_arrayList_add(localRequests, r);
-        }
-        celix_arrayList_clear(framework->dispatcher.requests);
+        //swap the request lists, so that the dispatcher lock is only shortly taken
+        celix_array_list_t *tmp = localRequests;
+        localRequests = framework->dispatcher.requests;
+        framework->dispatcher.requests = tmp;
         celixThreadMutex_unlock(&framework->dispatcher.mutex);
 
-        //FIXME strange locking  of bundleListenerLock and frameworkListenerLock inside a loop.
-        //Seems like a request depends on bundle listeners or framework listeners -> this should be protected with
-        //a use count!!
         for (int i = 0; i < celix_arrayList_size(localRequests); ++i) {
             request_pt request = celix_arrayList_get(localRequests, i);
-            int size = arrayList_size(request->listeners);
-            for (int k = 0; k < size; k++) {
-                if (request->type == BUNDLE_EVENT_TYPE) {
-                    celixThreadMutex_lock(&framework->bundleListenerLock);
-                    fw_bundle_listener_pt listener = (fw_bundle_listener_pt) arrayList_get(request->listeners, k);
-                    bundle_event_t event;
-                    memset(&event, 0, sizeof(event));
-                    event.bundleId = request->bundleId;
-                    event.bundleSymbolicName = request->bundleSymbolicName;
-                    event.type = request->eventType;
-
-                    fw_invokeBundleListener(framework, listener->listener, &event, listener->bundle);
-                    celixThreadMutex_unlock(&framework->bundleListenerLock);
-                } else if (request->type == FRAMEWORK_EVENT_TYPE) {
-                    celixThreadMutex_lock(&framework->frameworkListenersLock);
-                    fw_framework_listener_pt listener = (fw_framework_listener_pt) arrayList_get(request->listeners, k);
-                    framework_event_t event;
-                    memset(&event, 0, sizeof(event));
-                    event.bundleId = request->bundleId;
-                    event.bundleSymbolicName = request->bundleSymbolicName;
-                    event.type = request->eventType;
-                    event.error = request->error;
-                    event.errorCode = request->errorCode;
-
-                    fw_invokeFrameworkListener(framework, listener->listener, &event, listener->bundle);
-                    celixThreadMutex_unlock(&framework->frameworkListenersLock);
-                }
+            if (request->type == BUNDLE_EVENT_TYPE) {
+                fw_dispatchBundleEvent(framework, request, snapshot);
+            } else if (request->type == FRAMEWORK_EVENT_TYPE) {
+                fw_dispatchFrameworkEvent(framework, request, snapshot);
             }
+
+            struct timespec now;
+            clock_gettime(CLOCK_MONOTONIC, &now);
+            long long latency = (now.tv_sec - request->enqueueTime.tv_sec) * 1000000000LL + (now.tv_nsec - request->enqueueTime.tv_nsec);
+            celixThreadMutex_lock(&framework->dispatcher.mutex);
+            framework->dispatcher.metrics.nrOfDispatchedEvents += 1;
+            framework->dispatcher.metrics.totalLatencyInNs += latency;
+            if (latency > framework->dispatcher.metrics.maxLatencyInNs) {
+                framework->dispatcher.metrics.maxLatencyInNs = latency;
+            }
+            celixThreadMutex_unlock(&framework->dispatcher.mutex);
+
             free(request->bundleSymbolicName);
-            //NOTE next 2 free calls not needed? why it is a char* not a const char*
+            free(request->error);
+            //NOTE next free call not needed? why it is a char* not a const char*
             //free(request->filter);
-            //free(request->error);
             free(request);
         }
         celix_arrayList_clear(localRequests);
@@ -2331,11 +3854,183 @@ static void *fw_eventDispatcher(void *fw) {
     }
 
     celix_arrayList_destroy(localRequests);
+    celix_arrayList_destroy(snapshot);
     celixThread_exit(NULL);
     return NULL;
 
 }
 
+celix_startup_trace_t* fw_getStartupTrace(celix_framework_t *framework) {
+    return framework->startupTrace;
+}
+
+bool celix_framework_useStartupTraceEvents(celix_framework_t *fw, void *callbackHandle, void (*use)(void *handle, const celix_framework_startup_trace_event_t *event)) {
+    return celix_startupTrace_useEvents(fw->startupTrace, callbackHandle, use);
+}
+
+typedef struct fw_memory_stats_data {
+    celix_framework_t *fw;
+    celix_framework_bundle_memory_stats_t *stats;
+} fw_memory_stats_data_t;
+
+static void fw_addBundleMemoryStats(void *handle, const celix_bundle_t *bnd) {
+    fw_memory_stats_data_t *data = handle;
+    celix_framework_bundle_memory_stats_t *stats = data->stats;
+    const char *name = celix_bundle_getSymbolicName(bnd);
+    stats->symbolicName = strdup(name == NULL ? "" : name);
+
+    celix_serviceRegistry_addBundleMemoryStats(data->fw->registry, bnd, stats);
+
+    celixThreadMutex_lock(&data->fw->serviceListenersLock);
+    for (int i = 0; i < celix_arrayList_size(data->fw->serviceListeners); ++i) {
+        celix_fw_service_listener_entry_t *entry = celix_arrayList_get(data->fw->serviceListeners, i);
+        if (entry->bundle == bnd) {
+            stats->nrOfServiceListeners += 1;
+            stats->serviceListenersInBytes += sizeof(*entry) + sizeof(*entry->filter);
+            stats->serviceListenersInBytes += entry->objectClass == NULL ? 0 : strlen(entry->objectClass) + 1;
+            stats->serviceListenersInBytes += entry->filter == NULL || entry->filter->filterStr == NULL ? 0 : strlen(entry->filter->filterStr) + 1;
+        }
+    }
+    celixThreadMutex_unlock(&data->fw->serviceListenersLock);
+
+    bundle_context_t *ctx = NULL;
+    bundle_getContext((celix_bundle_t*)bnd, &ctx);
+    if (ctx != NULL) {
+        celixThreadMutex_lock(&ctx->mutex);
+        hash_map_iterator_t iter = hashMapIterator_construct(ctx->serviceTrackers);
+        while (hashMapIterator_hasNext(&iter)) {
+            celix_service_tracker_t *tracker = hashMapIterator_nextValue(&iter);
+            stats->nrOfServiceTrackers += 1;
+            stats->serviceTrackersInBytes += serviceTracker_getMemoryUsage(tracker);
+        }
+        celixThreadMutex_unlock(&ctx->mutex);
+    }
+
+    stats->totalInBytes = stats->serviceRegistrationsInBytes + stats->servicePropertiesInBytes +
+                          stats->serviceReferencesInBytes + stats->serviceListenersInBytes +
+                          stats->serviceTrackersInBytes;
+}
+
+celix_array_list_t* celix_framework_getMemoryStats(celix_framework_t *fw) {
+    celix_array_list_t *result = celix_arrayList_create();
+    celix_array_list_t *bundleIds = celix_arrayList_create();
+
+    celixThreadMutex_lock(&fw->installedBundles.mutex);
+    for (int i = 0; i < celix_arrayList_size(fw->installedBundles.entries); ++i) {
+        celix_framework_bundle_entry_t *entry = celix_arrayList_get(fw->installedBundles.entries, i);
+        celix_arrayList_addLong(bundleIds, entry->bndId);
+    }
+    celixThreadMutex_unlock(&fw->installedBundles.mutex);
+
+    for (int i = 0; i < celix_arrayList_size(bundleIds); ++i) {
+        fw_memory_stats_data_t data;
+        data.fw = fw;
+        data.stats = calloc(1, sizeof(*data.stats));
+        data.stats->bndId = celix_arrayList_getLong(bundleIds, i);
+        if (celix_framework_useBundle(fw, false, data.stats->bndId, &data, fw_addBundleMemoryStats)) {
+            celix_arrayList_add(result, data.stats);
+        } else {
+            //bundle uninstalled in the meantime
+            free(data.stats);
+        }
+    }
+
+    celix_arrayList_destroy(bundleIds);
+    return result;
+}
+
+void celix_framework_destroyMemoryStats(celix_array_list_t *stats) {
+    if (stats != NULL) {
+        for (int i = 0; i < celix_arrayList_size(stats); ++i) {
+            celix_framework_bundle_memory_stats_t *entry = celix_arrayList_get(stats, i);
+            free(entry->symbolicName);
+            free(entry);
+        }
+        celix_arrayList_destroy(stats);
+    }
+}
+
+void fw_getEventDispatcherMetrics(celix_framework_t *framework, celix_framework_event_dispatcher_metrics_t *metrics) {
+    celixThreadMutex_lock(&framework->dispatcher.mutex);
+    metrics->queueDepth = (size_t)celix_arrayList_size(framework->dispatcher.requests);
+    metrics->maxQueueDepth = framework->dispatcher.metrics.maxQueueDepth;
+    metrics->nrOfDispatchedEvents = framework->dispatcher.metrics.nrOfDispatchedEvents;
+    metrics->meanLatencyInNs = metrics->nrOfDispatchedEvents == 0 ? 0 : framework->dispatcher.metrics.totalLatencyInNs / (long long)metrics->nrOfDispatchedEvents;
+    metrics->maxLatencyInNs = framework->dispatcher.metrics.maxLatencyInNs;
+    celixThreadMutex_unlock(&framework->dispatcher.mutex);
+}
+
+void fw_recordTrackerCallback(celix_framework_t *framework, const struct timespec *start) {
+    struct timespec end;
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    long long elapsed = (end.tv_sec - start->tv_sec) * 1000000000LL + (end.tv_nsec - start->tv_nsec);
+    __atomic_fetch_add(&framework->metrics.nrOfTrackerCallbacks, 1, __ATOMIC_RELAXED);
+    __atomic_fetch_add(&framework->metrics.trackerCallbacksInNs, elapsed, __ATOMIC_RELAXED);
+    long long max = __atomic_load_n(&framework->metrics.maxTrackerCallbackInNs, __ATOMIC_RELAXED);
+    while (elapsed > max && !__atomic_compare_exchange_n(&framework->metrics.maxTrackerCallbackInNs, &max, elapsed, false, __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+        //retry with the updated max
+    }
+}
+
+static size_t fw_listSize(celix_thread_mutex_t *mutex, array_list_pt list) {
+    celixThreadMutex_lock(mutex);
+    size_t size = (size_t)arrayList_size(list);
+    celixThreadMutex_unlock(mutex);
+    return size;
+}
+
+/**
+ * Collect callback of the framework metrics provider service, see celix_metrics_service.h
+ */
+static void fw_collectMetrics(void *handle, const celix_metrics_writer_t *writer) {
+    celix_framework_t *fw = handle;
+    void *h = writer->handle;
+
+    celix_framework_bundle_table_t *table = fw_bundleTable_acquire(fw);
+    writer->write(h, "celix_framework_bundles", CELIX_METRIC_GAUGE, "Nr of installed bundles", NULL, (double)table->size);
+    fw_bundleTable_release(table);
+
+    writer->write(h, "celix_framework_services", CELIX_METRIC_GAUGE, "Nr of registered services", NULL, (double)serviceRegistry_nrOfServices(fw->registry));
+    writer->write(h, "celix_framework_listeners", CELIX_METRIC_GAUGE, "Nr of registered listeners", "type=\"service\"", (double)fw_listSize(&fw->serviceListenersLock, fw->serviceListeners));
+    writer->write(h, "celix_framework_listeners", CELIX_METRIC_GAUGE, "Nr of registered listeners", "type=\"bundle\"", (double)fw_listSize(&fw->bundleListenerLock, fw->bundleListeners));
+    writer->write(h, "celix_framework_listeners", CELIX_METRIC_GAUGE, "Nr of registered listeners", "type=\"framework\"", (double)fw_listSize(&fw->frameworkListenersLock, fw->frameworkListeners));
+    writer->write(h, "celix_framework_listeners", CELIX_METRIC_GAUGE, "Nr of registered listeners", "type=\"listener_hook\"", (double)serviceRegistry_nrOfHooks(fw->registry));
+
+    celix_framework_event_dispatcher_metrics_t dispatcher;
+    fw_getEventDispatcherMetrics(fw, &dispatcher);
+    writer->write(h, "celix_framework_event_queue_depth", CELIX_METRIC_GAUGE, "Nr of bundle and framework events waiting to be dispatched", NULL, (double)dispatcher.queueDepth);
+    writer->write(h, "celix_framework_events_dispatched_total", CELIX_METRIC_COUNTER, "Nr of dispatched bundle and framework events", NULL, (double)dispatcher.nrOfDispatchedEvents);
+    writer->write(h, "celix_framework_event_dispatch_latency_seconds", CELIX_METRIC_GAUGE, "Latency of dispatching bundle and framework events", "stat=\"mean\"", (double)dispatcher.meanLatencyInNs / 1e9);
+    writer->write(h, "celix_framework_event_dispatch_latency_seconds", CELIX_METRIC_GAUGE, "Latency of dispatching bundle and framework events", "stat=\"max\"", (double)dispatcher.maxLatencyInNs / 1e9);
+
+    writer->write(h, "celix_framework_service_events_total", CELIX_METRIC_COUNTER, "Nr of service events delivered to service listeners", NULL, (double)__atomic_load_n(&fw->metrics.nrOfServiceEvents, __ATOMIC_RELAXED));
+    writer->write(h, "celix_framework_service_event_delivery_seconds_total", CELIX_METRIC_COUNTER, "Time spend in service listener callbacks", NULL, (double)__atomic_load_n(&fw->metrics.serviceEventDeliveryInNs, __ATOMIC_RELAXED) / 1e9);
+    writer->write(h, "celix_framework_service_event_queue_seconds_total", CELIX_METRIC_COUNTER, "Time async service events waited for delivery", NULL, (double)__atomic_load_n(&fw->metrics.serviceEventQueueInNs, __ATOMIC_RELAXED) / 1e9);
+
+    writer->write(h, "celix_framework_tracker_callbacks_total", CELIX_METRIC_COUNTER, "Nr of service tracker callbacks", NULL, (double)__atomic_load_n(&fw->metrics.nrOfTrackerCallbacks, __ATOMIC_RELAXED));
+    writer->write(h, "celix_framework_tracker_callback_seconds_total", CELIX_METRIC_COUNTER, "Time spend in service tracker callbacks", NULL, (double)__atomic_load_n(&fw->metrics.trackerCallbacksInNs, __ATOMIC_RELAXED) / 1e9);
+    writer->write(h, "celix_framework_tracker_callback_max_seconds", CELIX_METRIC_GAUGE, "Longest service tracker callback", NULL, (double)__atomic_load_n(&fw->metrics.maxTrackerCallbackInNs, __ATOMIC_RELAXED) / 1e9);
+
+    //note the threads created with celixThread_create, owned by the bundle which created them
+    celix_array_list_t *threads = celixThread_getThreadInfos();
+    bool allocAccounting = celixThread_isAllocationAccountingEnabled();
+    for (int i = 0; i < celix_arrayList_size(threads); ++i) {
+        celix_thread_info_t *info = celix_arrayList_get(threads, i);
+        char labels[128];
+        snprintf(labels, sizeof(labels), "thread=\"%s\",tid=\"%li\",bundle=\"%li\"", info->name, info->tid, info->ownerId);
+        writer->write(h, "celix_thread_cpu_seconds_total", CELIX_METRIC_COUNTER, "CPU time of the threads created by Celix", labels, (double)info->cpuTimeInNs / 1e9);
+        snprintf(labels, sizeof(labels), "thread=\"%s\",tid=\"%li\",bundle=\"%li\",type=\"voluntary\"", info->name, info->tid, info->ownerId);
+        writer->write(h, "celix_thread_context_switches_total", CELIX_METRIC_COUNTER, "Context switches of the threads created by Celix", labels, (double)info->nrOfVoluntaryContextSwitches);
+        snprintf(labels, sizeof(labels), "thread=\"%s\",tid=\"%li\",bundle=\"%li\",type=\"involuntary\"", info->name, info->tid, info->ownerId);
+        writer->write(h, "celix_thread_context_switches_total", CELIX_METRIC_COUNTER, "Context switches of the threads created by Celix", labels, (double)info->nrOfInvoluntaryContextSwitches);
+        if (allocAccounting) {
+            snprintf(labels, sizeof(labels), "thread=\"%s\",tid=\"%li\",bundle=\"%li\"", info->name, info->tid, info->ownerId);
+            writer->write(h, "celix_thread_allocated_bytes_total", CELIX_METRIC_COUNTER, "Bytes allocated by the threads created by Celix", labels, (double)info->allocatedBytes);
+        }
+    }
+    celixThread_destroyThreadInfos(threads);
+}
+
 celix_status_t fw_invokeBundleListener(framework_pt framework, bundle_listener_pt listener, bundle_event_pt event, bundle_pt bundle) {
     // We only support async bundle listeners for now
     bundle_state_e state;
@@ -2359,7 +4054,18 @@ celix_status_t fw_invokeFrameworkListener(framework_pt framework, framework_list
 }
 
 static celix_status_t frameworkActivator_start(void * userData, bundle_context_t *context) {
-    // nothing to do
+    framework_pt framework = NULL;
+    if (bundleContext_getFramework(context, &framework) == CELIX_SUCCESS) {
+        celix_service_registration_options_t opts = CELIX_EMPTY_SERVICE_REGISTRATION_OPTIONS;
+        opts.factory = celix_scheduler_getServiceFactory(framework->scheduler);
+        opts.serviceName = CELIX_SCHEDULER_SERVICE_NAME;
+        opts.serviceVersion = CELIX_SCHEDULER_SERVICE_VERSION;
+        framework->schedulerSvcId = celix_bundleContext_registerServiceWithOptions(context, &opts);
+
+        framework->metrics.providerSvc.handle = framework;
+        framework->metrics.providerSvc.collect = fw_collectMetrics;
+        framework->metrics.providerSvcId = celix_bundleContext_registerService(context, &framework->metrics.providerSvc, CELIX_METRICS_PROVIDER_SERVICE_NAME, NULL);
+    }
     return CELIX_SUCCESS;
 }
 
@@ -2383,7 +4089,12 @@ static celix_status_t frameworkActivator_stop(void * userData, bundle_context_t
             celixThreadMutex_unlock(&framework->dispatcher.mutex);
             celixThread_join(framework->dispatcher.thread, NULL);
 
-            celixThread_create(&framework->shutdown.thread, NULL, &framework_shutdown, framework);
+            long prevThreadOwner = celixThread_setCreationOwner(0L);
+            celix_status_t created = celixThread_create(&framework->shutdown.thread, NULL, &framework_shutdown, framework);
+            celixThread_setCreationOwner(prevThreadOwner);
+            if (created == CELIX_SUCCESS) {
+                celixThread_setName(&framework->shutdown.thread, "CelixShutdown");
+            }
         }
     } else {
         status = CELIX_FRAMEWORK_EXCEPTION;
@@ -2488,6 +4199,54 @@ static celix_status_t framework_loadLibraries(framework_pt framework, const char
     return status;
 }
 
+/**
+ * Thread configuration (see celixThread_setConfigLookup) from the framework properties or environment.
+ */
+static const char* framework_threadConfigLookup(void *handle, const char *key) {
+    const char *value = NULL;
+    fw_getProperty(handle, key, NULL, &value);
+    return value;
+}
+
+static void framework_preloadLibraries(framework_pt framework) {
+    const char *libraries = NULL;
+    fw_getProperty(framework, CELIX_PRELOAD_LIBRARIES_NAME, NULL, &libraries);
+    if (libraries == NULL) {
+        return;
+    }
+    char *copy = strdup(libraries);
+    char *savePtr = NULL;
+    for (char *token = strtok_r(copy, ",", &savePtr); token != NULL; token = strtok_r(NULL, ",", &savePtr)) {
+        char *lib = utils_stringTrim(token);
+        if (strlen(lib) == 0) {
+            continue;
+        }
+        struct timespec start = celix_startupTrace_now();
+        celix_library_handle_t *handle = celix_libloader_openGlobal(lib);
+        if (framework->startupTrace != NULL) {
+            celix_startupTrace_addEvent(framework->startupTrace, "framework", "preloadLibrary", lib, 0L /*framework bundle*/, &start);
+        }
+        if (handle != NULL) {
+            celix_arrayList_add(framework->preloadedLibraries, handle);
+        } else {
+            fw_log(framework->logger, OSGI_FRAMEWORK_LOG_WARNING, "Cannot preload library %s: %s", lib, celix_libloader_getLastError());
+        }
+    }
+    free(copy);
+}
+
+/**
+ * Returns the activator symbol of the bundle, falling back to the deprecated symbol name.
+ */
+static void* fw_getActivatorSymbol(bundle_pt bundle, const char *name, const char *deprecatedName) {
+    celix_library_handle_t *handle = bundle_getHandle(bundle);
+    void *symbol = celix_libloader_getSymbol(handle, name);
+    if (symbol == NULL) {
+        symbol = celix_libloader_getSymbol(handle, deprecatedName);
+    }
+    return symbol;
+}
+
 static celix_status_t framework_loadLibrary(framework_pt framework, const char *library, bundle_archive_pt archive, void **handle) {
     celix_status_t status = CELIX_SUCCESS;
     const char *error = NULL;
@@ -2526,7 +4285,13 @@ static celix_status_t framework_loadLibrary(framework_pt framework, const char *
     } else {
         celix_bundle_context_t *fwCtx = NULL;
         bundle_getContext(framework->bundle, &fwCtx);
+        struct timespec start = celix_startupTrace_now();
         *handle = celix_libloader_open(fwCtx, libraryPath);
+        if (framework->startupTrace != NULL) {
+            long bndId = -1L;
+            bundleArchive_getId(archive, &bndId);
+            celix_startupTrace_addEvent(framework->startupTrace, "bundle", "loadLibrary", libraryPath, bndId, &start);
+        }
         if (*handle == NULL) {
             error = celix_libloader_getLastError();
             status =  CELIX_BUNDLE_EXCEPTION;
@@ -2560,50 +4325,49 @@ static celix_status_t framework_loadLibrary(framework_pt framework, const char *
  **********************************************************************************************************************/
 
 
-void celix_framework_useBundles(framework_t *fw, bool includeFrameworkBundle, void *callbackHandle, void(*use)(void *handle, const bundle_t *bnd)) {
-    celix_array_list_t *bundleIds = celix_arrayList_create();
-
-    celixThreadMutex_lock(&fw->installedBundles.mutex);
-    int size = celix_arrayList_size(fw->installedBundles.entries);
-    for (int i = 0; i < size; ++i) {
-        celix_framework_bundle_entry_t *entry = celix_arrayList_get(fw->installedBundles.entries, i);
-        if (entry->bndId > 0 || includeFrameworkBundle) {
-            //NOTE bundle state is checked in celix_framework_useBundles
-            celix_arrayList_addLong(bundleIds, entry->bndId);
+/**
+ * Calls use for the bundle of the entry, if the bundle is not uninstalled and - if onlyActive - is active.
+ * Note the use count of the framework bundle is not increased, see fw_bundleEntry_increaseUseCount.
+ */
+static bool fw_useBundleEntry(celix_framework_bundle_entry_t *entry, bool onlyActive, void *callbackHandle, void(*use)(void *handle, const bundle_t *bnd)) {
+    bool called = false;
+    if (entry->bndId == 0 || fw_bundleEntry_tryUse(entry)) {
+        celix_bundle_state_e bndState = celix_bundle_getState(entry->bnd);
+        if (!onlyActive || bndState == OSGI_FRAMEWORK_BUNDLE_ACTIVE || bndState == OSGI_FRAMEWORK_BUNDLE_STARTING) {
+            use(callbackHandle, entry->bnd);
+            called = true;
+        }
+        if (entry->bndId != 0) {
+            fw_bundleEntry_unuse(entry);
         }
     }
-    celixThreadMutex_unlock(&fw->installedBundles.mutex);
-
-    //note that stored bundle ids can now already be invalid (race cond),
-    //but the celix_framework_useBundle function should be able to handle this safely.
+    return called;
+}
 
-    size = celix_arrayList_size(bundleIds);
-    for (int i = 0; i < size; ++i) {
-        long bndId = celix_arrayList_getLong(bundleIds, i);
-        celix_framework_useBundle(fw, true, bndId, callbackHandle, use);
+void celix_framework_useBundles(framework_t *fw, bool includeFrameworkBundle, void *callbackHandle, void(*use)(void *handle, const bundle_t *bnd)) {
+    //note the table is an immutable snapshot, bundles installed or uninstalled during the iteration are not seen
+    //or are skipped by fw_useBundleEntry.
+    celix_framework_bundle_table_t *table = fw_bundleTable_acquire(fw);
+    for (int i = 0; table != NULL && i < table->size; ++i) {
+        celix_framework_bundle_entry_t *entry = table->entries[i];
+        if (entry->bndId > 0 || includeFrameworkBundle) {
+            fw_useBundleEntry(entry, true, callbackHandle, use);
+        }
     }
-
-    celix_arrayList_destroy(bundleIds);
+    fw_bundleTable_release(table);
 }
 
 bool celix_framework_useBundle(framework_t *fw, bool onlyActive, long bundleId, void *callbackHandle, void(*use)(void *handle, const bundle_t *bnd)) {
     bool called = false;
     if (bundleId >= 0) {
-        fw_bundleEntry_increaseUseCount(fw, bundleId);
-        bundle_t *bnd = framework_getBundleById(fw, bundleId);
-        if (bnd != NULL) {
-            celix_bundle_state_e bndState = celix_bundle_getState(bnd);
-            if (onlyActive && (bndState == OSGI_FRAMEWORK_BUNDLE_ACTIVE || bndState == OSGI_FRAMEWORK_BUNDLE_STARTING)) {
-                use(callbackHandle, bnd);
-                called = true;
-            } else if (!onlyActive) {
-                use(callbackHandle, bnd);
-                called = true;
-            }
+        celix_framework_bundle_table_t *table = fw_bundleTable_acquire(fw);
+        celix_framework_bundle_entry_t *entry = fw_bundleTable_get(table, bundleId);
+        if (entry != NULL) {
+            called = fw_useBundleEntry(entry, onlyActive, callbackHandle, use);
         } else {
             framework_logIfError(fw->logger, CELIX_FRAMEWORK_EXCEPTION, NULL, "Bundle with id %li is not installed", bundleId);
         }
-        fw_bundleEntry_decreaseUseCount(fw, bundleId);
+        fw_bundleTable_release(table);
     }
     return called;
 }
@@ -2627,6 +4391,37 @@ service_registration_t* celix_framework_registerServiceFactory(framework_t *fw ,
     return reg;
 }
 
+celix_status_t celix_framework_registerServices(framework_t *fw, const celix_bundle_t *bnd, size_t nrOfServices, const char * const *serviceNames, const void * const *svcs, celix_service_factory_t * const *factories, celix_properties_t **properties, service_registration_t **registrations) {
+    celix_status_t status = CELIX_SUCCESS;
+
+    long bndId = celix_bundle_getId(bnd);
+    fw_bundleEntry_increaseUseCount(fw, bndId);
+
+    for (size_t i = 0; i < nrOfServices; ++i) {
+        bool hasSvc = svcs[i] != NULL || (factories != NULL && factories[i] != NULL);
+        if (serviceNames[i] == NULL || !hasSvc || strcmp(serviceNames[i], OSGI_FRAMEWORK_LISTENER_HOOK_SERVICE_NAME) == 0) {
+            //note listener hooks need the current listeners on registration and are not supported in a bulk registration
+            status = CELIX_ILLEGAL_ARGUMENT;
+            break;
+        }
+    }
+    status = CELIX_DO_IF(status, celix_serviceRegistry_registerServices(fw->registry, bnd, nrOfServices, serviceNames, svcs, factories, properties, registrations));
+
+    fw_bundleEntry_decreaseUseCount(fw, bndId);
+
+    framework_logIfError(fw->logger, status, NULL, "Cannot register %zu services", nrOfServices);
+
+    return status;
+}
+
+celix_status_t celix_framework_unregisterServices(framework_t *fw, const celix_bundle_t *bnd, service_registration_t **registrations, size_t nrOfRegistrations) {
+    long bndId = celix_bundle_getId(bnd);
+    fw_bundleEntry_increaseUseCount(fw, bndId);
+    celix_status_t status = celix_serviceRegistry_unregisterServices(fw->registry, bnd, registrations, nrOfRegistrations);
+    fw_bundleEntry_decreaseUseCount(fw, bndId);
+    return status;
+}
+
 const char* celix_framework_getUUID(const celix_framework_t *fw) {
     if (fw != NULL) {
         return celix_properties_get(fw->configurationMap, OSGI_FRAMEWORK_FRAMEWORK_UUID, NULL);
@@ -39,7 +39,12 @@
 #include "celix_log.h"
 
 #include "celix_threads.h"
+#include "celix_intrusive_list.h"
 #include "service_registry.h"
+#include "celix_startup_trace.h"
+#include "celix_bundle_image.h"
+#include "celix_scheduler.h"
+#include "celix_metrics_service.h"
 
 struct celix_framework {
 #ifdef WITH_APR
@@ -51,6 +56,8 @@ struct celix_framework {
 
     celix_thread_mutex_t serviceListenersLock;
     array_list_pt serviceListeners;
+    hash_map_pt serviceListenersByObjectClass; //key = objectClass required by the listener filter, value = list (celix_fw_service_listener_entry_t*)
+    array_list_pt wildcardServiceListeners; //listeners without a required objectClass, value = celix_fw_service_listener_entry_t*
 
     array_list_pt frameworkListeners;
     celix_thread_mutex_t frameworkListenersLock;
@@ -73,7 +80,12 @@ struct celix_framework {
     struct {
         celix_array_list_t *entries; //value = celix_framework_bundle_entry_t*. Note ordered by installed bundle time
                                      //i.e. later installed bundle are last
-        celix_thread_mutex_t mutex;
+        celix_thread_mutex_t mutex; //protects entries and serializes the table updates
+        struct celix_framework_bundle_table *table; //atomic, immutable snapshot of entries, replaced on install/uninstall
+        long tableReaders; //atomic, nr of threads acquiring the table (see fw_bundleTable_acquire)
+        bool tableUpdating; //atomic, true while a table update waits till tableReaders is 0
+        celix_thread_mutex_t tableReadersMutex; //used with tableReadersCond to wait till tableReaders is 0
+        celix_thread_cond_t tableReadersCond;
     } installedBundles;
 
 
@@ -86,14 +98,96 @@ struct celix_framework {
         celix_thread_mutex_t mutex; //protect active and requests
         bool active;
         celix_array_list_t *requests;
+        struct {
+            size_t maxQueueDepth;
+            size_t nrOfDispatchedEvents;
+            long long totalLatencyInNs;
+            long long maxLatencyInNs;
+        } metrics; //protected by mutex
     } dispatcher;
 
+    struct {
+        bool async; //true if service events are delivered by executors, see CELIX_FRAMEWORK_SERVICE_EVENTS_ASYNC_NAME
+        celix_thread_mutex_t mutex; //protects active and executors
+        bool active;
+        hash_map_t *executors; //key = bundle id of the service listeners, value = celix_fw_service_event_executor_t*
+    } serviceEvents;
+
+    struct {
+        celix_thread_mutex_t mutex; //protects byServiceName
+        hash_map_t *byServiceName; //key = service name declared with Celix-Lazy-Services, value = celix_array_list_t* of the ids of the started, but not yet activated, lazy bundles
+    } lazyBundles;
+
+    struct {
+        celix_thread_mutex_t mutex; //protects the fields below
+        celix_thread_cond_t cond;
+        bool active;
+        bool started; //true if the reaper thread is created
+        celix_thread_t thread;
+        celix_array_list_t *jobs; //value = celix_fw_tracker_cleanup_t*
+    } trackerReaper;
+
+    celix_startup_trace_t *startupTrace; //NULL if not enabled, see CELIX_STARTUP_TRACE_FILE_NAME
+    celix_bundle_image_t *image; //NULL if not booting from a bundle image, see CELIX_BUNDLE_IMAGE_NAME
+    celix_array_list_t *preloadedLibraries; //value = celix_library_handle_t*, see CELIX_PRELOAD_LIBRARIES_NAME
+    celix_scheduler_t *scheduler; //provides the celix_scheduler service, see celix_scheduler_service.h
+    long schedulerSvcId;
+
+    struct {
+        size_t nrOfServiceEvents; //atomic, nr of service events delivered to service listeners
+        long long serviceEventDeliveryInNs; //atomic, total time spend in the service listener callbacks
+        long long serviceEventQueueInNs; //atomic, total time async service events waited in an executor queue
+        size_t nrOfTrackerCallbacks; //atomic, nr of service tracker add/remove/modified/set callbacks
+        long long trackerCallbacksInNs; //atomic, total time spend in service tracker callbacks
+        long long maxTrackerCallbackInNs; //atomic
+        celix_metrics_provider_service_t providerSvc; //provides the framework metrics, see celix_metrics_service.h
+        long providerSvcId;
+    } metrics;
+
     framework_logger_pt logger;
 };
 
+typedef struct celix_framework_event_dispatcher_metrics {
+    size_t queueDepth; //nr of bundle/framework events waiting to be dispatched
+    size_t maxQueueDepth;
+    size_t nrOfDispatchedEvents;
+    long long meanLatencyInNs; //mean time between firing a event and the event being delivered to all listeners
+    long long maxLatencyInNs;
+} celix_framework_event_dispatcher_metrics_t;
+
+/**
+ * Returns the metrics of the (bundle and framework) event dispatcher.
+ */
+FRAMEWORK_EXPORT void fw_getEventDispatcherMetrics(celix_framework_t *framework, celix_framework_event_dispatcher_metrics_t *metrics);
+
+/**
+ * Records a service tracker callback (add, remove, modified or set) which started at the provided (CLOCK_MONOTONIC)
+ * start time and is just finished.
+ */
+FRAMEWORK_EXPORT void fw_recordTrackerCallback(celix_framework_t *framework, const struct timespec *start);
+
+/**
+ * Returns the startup trace of the framework or NULL if startup tracing is not enabled.
+ */
+FRAMEWORK_EXPORT celix_startup_trace_t* fw_getStartupTrace(celix_framework_t *framework);
+
+/**
+ * Runs the cleanup on the framework tracker reaper thread. Used by closed service trackers to remove their
+ * service listener, which cannot be done on the closing thread because that can be a thread invoking that service
+ * listener. The reaper thread is created on first use and runs the pending cleanups in batches.
+ * If the reaper is stopped (framework destroy), the cleanup is run on the calling thread.
+ */
+FRAMEWORK_EXPORT void fw_deferTrackerCleanup(celix_framework_t *fw, void (*cleanup)(void *data), void *data);
+
 FRAMEWORK_EXPORT celix_status_t fw_getProperty(framework_pt framework, const char* name, const char* defaultValue, const char** value);
 
 FRAMEWORK_EXPORT celix_status_t fw_installBundle(framework_pt framework, bundle_pt * bundle, const char * location, const char *inputFile);
+
+/**
+ * Resolves a bundle location: absolute paths and paths relative to the working dir are used as-is, other paths are
+ * resolved using the provided (';' separated) bundle paths. Returns NULL (caller owns the result) if not found.
+ */
+char* fw_resolveBundleLocation(const char *bndLoc, const char *paths);
 FRAMEWORK_EXPORT celix_status_t fw_uninstallBundle(framework_pt framework, bundle_pt bundle);
 
 FRAMEWORK_EXPORT celix_status_t framework_getBundleEntry(framework_pt framework, bundle_pt bundle, const char* name, char** entry);
@@ -123,6 +217,11 @@ FRAMEWORK_EXPORT celix_status_t fw_addFrameworkListener(framework_pt framework,
 FRAMEWORK_EXPORT celix_status_t fw_removeFrameworkListener(framework_pt framework, bundle_pt bundle, framework_listener_pt listener);
 
 FRAMEWORK_EXPORT void fw_serviceChanged(framework_pt framework, celix_service_event_type_t eventType, service_registration_pt registration, properties_pt oldprops);
+/**
+ * Fires the service event for all provided registrations. The service listeners are collected once for all
+ * registrations.
+ */
+FRAMEWORK_EXPORT void fw_serviceChangedForRegistrations(celix_framework_t *framework, celix_service_event_type_t eventType, service_registration_t **registrations, size_t nrOfRegistrations);
 
 FRAMEWORK_EXPORT celix_status_t fw_isServiceAssignable(framework_pt fw, bundle_pt requester, service_reference_pt reference, bool* assignable);
 
@@ -134,7 +233,7 @@ FRAMEWORK_EXPORT bundle_pt findBundle(bundle_context_pt context);
 FRAMEWORK_EXPORT service_registration_pt findRegistration(service_reference_pt reference);
 
 FRAMEWORK_EXPORT service_reference_pt listToArray(array_list_pt list);
-FRAMEWORK_EXPORT celix_status_t framework_markResolvedModules(framework_pt framework, linked_list_pt wires);
+FRAMEWORK_EXPORT celix_status_t framework_markResolvedModules(framework_pt framework, celix_ilist_t *wires);
 
 FRAMEWORK_EXPORT array_list_pt framework_getBundles(framework_pt framework);
 FRAMEWORK_EXPORT bundle_pt framework_getBundle(framework_pt framework, const char* location);
@@ -155,4 +254,16 @@ FRAMEWORK_EXPORT bundle_pt framework_getBundleById(framework_pt framework, long
 
 service_registration_t* celix_framework_registerServiceFactory(framework_t *fw , const celix_bundle_t *bnd, const char* serviceName, celix_service_factory_t *factory, celix_properties_t *properties);
 
+/**
+ * Registers multiple services in a single registry pass. See celix_serviceRegistry_registerServices.
+ * Listener hook services cannot be registered in bulk; for these CELIX_ILLEGAL_ARGUMENT is returned and nothing is
+ * registered. On error the ownership of the properties stays with the caller.
+ */
+celix_status_t celix_framework_registerServices(framework_t *fw, const celix_bundle_t *bnd, size_t nrOfServices, const char * const *serviceNames, const void * const *svcs, celix_service_factory_t * const *factories, celix_properties_t **properties, service_registration_t **registrations);
+
+/**
+ * Unregisters multiple services in a single registry pass. See celix_serviceRegistry_unregisterServices.
+ */
+celix_status_t celix_framework_unregisterServices(framework_t *fw, const celix_bundle_t *bnd, service_registration_t **registrations, size_t nrOfRegistrations);
+
 #endif /* FRAMEWORK_PRIVATE_H_ */
@@ -32,6 +32,7 @@
 #include "manifest.h"
 #include "utils.h"
 #include "celix_log.h"
+#include "celix_constants.h"
 
 int fpeek(FILE *stream);
 celix_status_t manifest_readAttributes(manifest_pt manifest, properties_pt properties, FILE *file);
@@ -193,6 +194,12 @@ const char* manifest_getValue(manifest_pt manifest, const char* name) {
 	return isEmpty ? NULL : val;
 }
 
+bool manifest_isLazyActivation(manifest_pt manifest) {
+	const char* policy = manifest_getValue(manifest, OSGI_FRAMEWORK_BUNDLE_ACTIVATION_POLICY);
+	const char* services = manifest_getValue(manifest, CELIX_FRAMEWORK_BUNDLE_LAZY_SERVICES);
+	return policy != NULL && services != NULL && strncmp(policy, OSGI_FRAMEWORK_BUNDLE_ACTIVATION_POLICY_LAZY, 4) == 0;
+}
+
 int fpeek(FILE *stream) {
 	int c;
 	c = fgetc(stream);
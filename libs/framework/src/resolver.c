@@ -44,6 +44,7 @@ struct candidateSet {
     module_pt module;
     requirement_pt requirement;
     linked_list_pt candidates;
+    celix_ilist_node_t node; //entry in the candidate set list of the module
 };
 
 typedef struct candidateSet * candidate_set_pt;
@@ -58,13 +59,32 @@ linked_list_pt m_resolvedServices = NULL;
 int resolver_populateCandidatesMap(hash_map_pt candidatesMap, module_pt targetModule);
 capability_list_pt resolver_getCapabilityList(linked_list_pt list, const char* name);
 void resolver_removeInvalidCandidate(module_pt module, hash_map_pt candidates, linked_list_pt invalid);
-linked_list_pt resolver_populateWireMap(hash_map_pt candidates, module_pt importer, linked_list_pt wireMap);
+celix_ilist_t* resolver_populateWireMap(hash_map_pt candidates, module_pt importer, celix_ilist_t *wireMap);
+
+static void resolver_destroyCandidateSetList(celix_ilist_t *candSetList) {
+    if (candSetList != NULL) {
+        CELIX_ILIST_FOR_EACH_SAFE(candSetList, node) {
+            candidate_set_pt set = CELIX_ILIST_ENTRY(node, struct candidateSet, node);
+            linkedList_destroy(set->candidates);
+            free(set);
+        }
+        free(candSetList);
+    }
+}
 
-linked_list_pt resolver_resolve(module_pt root) {
+static void resolver_destroyCandidatesMap(hash_map_pt candidatesMap) {
+    hash_map_iterator_pt iter = hashMapIterator_create(candidatesMap);
+    while (hashMapIterator_hasNext(iter)) {
+        celix_ilist_t *candSetList = hashMapIterator_nextValue(iter);
+        resolver_destroyCandidateSetList(candSetList);
+    }
+    hashMapIterator_destroy(iter);
+    hashMap_destroy(candidatesMap, false, false);
+}
+
+celix_ilist_t* resolver_resolve(module_pt root) {
     hash_map_pt candidatesMap = NULL;
-    linked_list_pt wireMap = NULL;
-    linked_list_pt resolved = NULL;
-    hash_map_iterator_pt iter = NULL;
+    celix_ilist_t *wireMap = NULL;
 
     if (module_isResolved(root)) {
         return NULL;
@@ -73,54 +93,142 @@ linked_list_pt resolver_resolve(module_pt root) {
     candidatesMap = hashMap_create(NULL, NULL, NULL, NULL);
 
     if (resolver_populateCandidatesMap(candidatesMap, root) != 0) {
-        hash_map_iterator_pt iter = hashMapIterator_create(candidatesMap);
-        while (hashMapIterator_hasNext(iter)) {
-            hash_map_entry_pt entry = hashMapIterator_nextEntry(iter);
-            linked_list_pt value = hashMapEntry_getValue(entry);
-            hashMapIterator_remove(iter);
-            if (value != NULL) {
-                linked_list_iterator_pt candSetIter = linkedListIterator_create(value, 0);
-                while (linkedListIterator_hasNext(candSetIter)) {
-                    candidate_set_pt set = linkedListIterator_next(candSetIter);
-                    linkedList_destroy(set->candidates);
-                    free(set);
-                    linkedListIterator_remove(candSetIter);
-                }
-                linkedListIterator_destroy(candSetIter);
-                linkedList_destroy(value);
-            }
+        resolver_destroyCandidatesMap(candidatesMap);
+        return NULL;
+    }
+
+    wireMap = malloc(sizeof(*wireMap));
+    celix_ilist_init(wireMap);
+    wireMap = resolver_populateWireMap(candidatesMap, root, wireMap);
+    resolver_destroyCandidatesMap(candidatesMap);
+    return wireMap;
+}
+
+static bool resolver_hasNameAndVersion(module_pt module, const char *name, const char *version) {
+    const char *symbolicName = NULL;
+    char *versionStr = NULL;
+    module_getSymbolicName(module, &symbolicName);
+    version_pt moduleVersion = module_getVersion(module);
+    if (moduleVersion != NULL) {
+        version_toString(moduleVersion, &versionStr);
+    }
+    bool match = symbolicName != NULL && versionStr != NULL && strcmp(symbolicName, name) == 0 && strcmp(versionStr, version) == 0;
+    free(versionStr);
+    return match;
+}
+
+/**
+ * Finds the capability of a resolved module with the provided name and version, satisfying the requirement.
+ */
+static capability_pt resolver_findCachedCapability(requirement_pt req, const char *exporterName, const char *exporterVersion) {
+    const char *targetName = NULL;
+    requirement_getTargetName(req, &targetName);
+    capability_list_pt capList = resolver_getCapabilityList(m_resolvedServices, targetName);
+    for (int c = 0; capList != NULL && c < linkedList_size(capList->capabilities); c++) {
+        capability_pt cap = linkedList_get(capList->capabilities, c);
+        module_pt module = NULL;
+        bool satisfied = false;
+        capability_getModule(cap, &module);
+        requirement_isSatisfied(req, cap, &satisfied);
+        if (satisfied && module_isResolved(module) && resolver_hasNameAndVersion(module, exporterName, exporterVersion)) {
+            return cap;
         }
-        hashMapIterator_destroy(iter);
-        hashMap_destroy(candidatesMap, false, false);
+    }
+    return NULL;
+}
+
+celix_ilist_t* resolver_resolveCached(module_pt root, const char *wiring) {
+    if (module_isResolved(root) || wiring == NULL || m_resolvedServices == NULL) {
         return NULL;
     }
 
-    linkedList_create(&wireMap);
-    resolved = resolver_populateWireMap(candidatesMap, root, wireMap);
-    iter = hashMapIterator_create(candidatesMap);
-    while (hashMapIterator_hasNext(iter)) {
-        hash_map_entry_pt entry = hashMapIterator_nextEntry(iter);
-        linked_list_pt value = hashMapEntry_getValue(entry);
-        hashMapIterator_remove(iter);
-        if (value != NULL) {
-            linked_list_iterator_pt candSetIter = linkedListIterator_create(value, 0);
-            while (linkedListIterator_hasNext(candSetIter)) {
-                candidate_set_pt set = linkedListIterator_next(candSetIter);
-                linkedList_destroy(set->candidates);
-                free(set);
-                linkedListIterator_remove(candSetIter);
+    linked_list_pt wires = NULL;
+    linkedList_create(&wires);
+    bool resolved = true;
+    linked_list_pt requirements = module_getRequirements(root);
+    for (int i = 0; resolved && requirements != NULL && i < linkedList_size(requirements); i++) {
+        requirement_pt req = linkedList_get(requirements, i);
+        const char *targetName = NULL;
+        requirement_getTargetName(req, &targetName);
+
+        //find the "<target> <exporter symbolic name> <exporter version>" line of the requirement
+        capability_pt cap = NULL;
+        char *lines = strdup(wiring);
+        char *savePtr = NULL;
+        for (char *line = strtok_r(lines, "\n", &savePtr); cap == NULL && line != NULL; line = strtok_r(NULL, "\n", &savePtr)) {
+            char *lineSavePtr = NULL;
+            const char *target = strtok_r(line, " ", &lineSavePtr);
+            const char *exporterName = strtok_r(NULL, " ", &lineSavePtr);
+            const char *exporterVersion = strtok_r(NULL, " ", &lineSavePtr);
+            if (target != NULL && exporterName != NULL && exporterVersion != NULL && strcmp(target, targetName) == 0) {
+                cap = resolver_findCachedCapability(req, exporterName, exporterVersion);
             }
-            linkedListIterator_destroy(candSetIter);
-            linkedList_destroy(value);
+        }
+        free(lines);
+
+        module_pt exporter = NULL;
+        if (cap != NULL) {
+            capability_getModule(cap, &exporter);
+        }
+        if (cap == NULL) {
+            resolved = false;
+        } else if (exporter != root) {
+            wire_pt wire = NULL;
+            wire_create(root, req, exporter, cap, &wire);
+            linkedList_addElement(wires, wire);
         }
     }
-    hashMapIterator_destroy(iter);
-    hashMap_destroy(candidatesMap, false, false);
-    return resolved;
+
+    if (!resolved) {
+        for (int i = 0; i < linkedList_size(wires); i++) {
+            wire_destroy(linkedList_get(wires, i));
+        }
+        linkedList_destroy(wires);
+        return NULL;
+    }
+
+    celix_ilist_t *wireMap = malloc(sizeof(*wireMap));
+    celix_ilist_init(wireMap);
+    importer_wires_pt importerWires = malloc(sizeof(*importerWires));
+    importerWires->importer = root;
+    importerWires->wires = wires;
+    celix_ilist_pushBack(wireMap, &importerWires->node);
+    return wireMap;
+}
+
+char* resolver_describeWiring(module_pt module) {
+    char *result = NULL;
+    size_t size = 0;
+    FILE *stream = open_memstream(&result, &size);
+    if (stream == NULL) {
+        return NULL;
+    }
+    linked_list_pt wires = module_getWires(module);
+    for (int i = 0; wires != NULL && i < linkedList_size(wires); i++) {
+        wire_pt wire = linkedList_get(wires, i);
+        requirement_pt req = NULL;
+        module_pt exporter = NULL;
+        const char *targetName = NULL;
+        const char *exporterName = NULL;
+        char *exporterVersion = NULL;
+        wire_getRequirement(wire, &req);
+        wire_getExporter(wire, &exporter);
+        requirement_getTargetName(req, &targetName);
+        module_getSymbolicName(exporter, &exporterName);
+        if (module_getVersion(exporter) != NULL) {
+            version_toString(module_getVersion(exporter), &exporterVersion);
+        }
+        if (targetName != NULL && exporterName != NULL && exporterVersion != NULL) {
+            fprintf(stream, "%s %s %s\n", targetName, exporterName, exporterVersion);
+        }
+        free(exporterVersion);
+    }
+    fclose(stream);
+    return result;
 }
 
 int resolver_populateCandidatesMap(hash_map_pt candidatesMap, module_pt targetModule) {
-    linked_list_pt candSetList;
+    celix_ilist_t *candSetList;
     linked_list_pt candidates;
     linked_list_pt invalid;
 
@@ -130,8 +238,10 @@ int resolver_populateCandidatesMap(hash_map_pt candidatesMap, module_pt targetMo
 
     hashMap_put(candidatesMap, targetModule, NULL);
 
-    if (linkedList_create(&candSetList) == CELIX_SUCCESS) {
+    candSetList = malloc(sizeof(*candSetList));
+    if (candSetList != NULL) {
         int i;
+        celix_ilist_init(candSetList);
         for (i = 0; i < linkedList_size(module_getRequirements(targetModule)); i++) {
             capability_list_pt capList;
             requirement_pt req;
@@ -186,14 +296,14 @@ int resolver_populateCandidatesMap(hash_map_pt candidatesMap, module_pt targetMo
                         fw_log(logger, OSGI_FRAMEWORK_LOG_INFO, "Unable to resolve: %s, %s\n", name, targetName);
                     }
                     linkedList_destroy(candidates);
-                    linkedList_destroy(candSetList);
+                    resolver_destroyCandidateSetList(candSetList);
                     return -1;
                 } else if (linkedList_size(candidates) > 0) {
                     candidate_set_pt cs = (candidate_set_pt) malloc(sizeof(*cs));
                     cs->candidates = candidates;
                     cs->module = targetModule;
                     cs->requirement = req;
-                    linkedList_addElement(candSetList, cs);
+                    celix_ilist_pushBack(candSetList, &cs->node);
                 }
 
             }
@@ -209,11 +319,11 @@ void resolver_removeInvalidCandidate(module_pt invalidModule, hash_map_pt candid
 
     for (iterator = hashMapIterator_create(candidates); hashMapIterator_hasNext(iterator);) {
         hash_map_entry_pt entry = hashMapIterator_nextEntry(iterator);
-        linked_list_pt candSetList = (linked_list_pt) hashMapEntry_getValue(entry);
+        celix_ilist_t *candSetList = hashMapEntry_getValue(entry);
         if (candSetList != NULL) {
-            linked_list_iterator_pt itCandSetList;
-            for (itCandSetList = linkedListIterator_create(candSetList, 0); linkedListIterator_hasNext(itCandSetList);) {
-                candidate_set_pt set = (candidate_set_pt) linkedListIterator_next(itCandSetList);
+            CELIX_ILIST_FOR_EACH_SAFE(candSetList, candSetNode) {
+                candidate_set_pt set = CELIX_ILIST_ENTRY(candSetNode, struct candidateSet, node);
+                bool removeSet = false;
                 linked_list_iterator_pt candIter;
                 for (candIter = linkedListIterator_create(set->candidates, 0); linkedListIterator_hasNext(candIter);) {
                     capability_pt candCap = (capability_pt) linkedListIterator_next(candIter);
@@ -222,7 +332,7 @@ void resolver_removeInvalidCandidate(module_pt invalidModule, hash_map_pt candid
                     if (module == invalidModule) {
                         linkedListIterator_remove(candIter);
                         if (linkedList_size(set->candidates) == 0) {
-                            linkedListIterator_remove(itCandSetList);
+                            removeSet = true;
                             if (module != invalidModule && linkedList_contains(invalid, module)) {
                                 linkedList_addElement(invalid, module);
                             }
@@ -231,8 +341,12 @@ void resolver_removeInvalidCandidate(module_pt invalidModule, hash_map_pt candid
                     }
                 }
                 linkedListIterator_destroy(candIter);
+                if (removeSet) {
+                    celix_ilist_remove(&set->node);
+                    linkedList_destroy(set->candidates);
+                    free(set);
+                }
             }
-            linkedListIterator_destroy(itCandSetList);
         }
     }
     hashMapIterator_destroy(iterator);
@@ -429,11 +543,11 @@ capability_list_pt resolver_getCapabilityList(linked_list_pt list, const char *
     return capabilityList;
 }
 
-linked_list_pt resolver_populateWireMap(hash_map_pt candidates, module_pt importer, linked_list_pt wireMap) {
+celix_ilist_t* resolver_populateWireMap(hash_map_pt candidates, module_pt importer, celix_ilist_t *wireMap) {
     linked_list_pt serviceWires;
 
     if (candidates && importer && wireMap) {
-        linked_list_pt candSetList = NULL;
+        celix_ilist_t *candSetList = NULL;
         bool resolved = false;
 
         if (module_isResolved(importer)) {
@@ -442,23 +556,20 @@ linked_list_pt resolver_populateWireMap(hash_map_pt candidates, module_pt import
         }
         if (!resolved) {
             bool self = false;
-            linked_list_iterator_pt wit = linkedListIterator_create(wireMap, 0);
-            while (linkedListIterator_hasNext(wit)) {
-                importer_wires_pt iw = linkedListIterator_next(wit);
+            CELIX_ILIST_FOR_EACH(wireMap, node) {
+                importer_wires_pt iw = CELIX_ILIST_ENTRY(node, struct importer_wires, node);
                 if (iw->importer == importer) {
                     // Do not resolve yourself
                     self = true;
                     break;
                 }
             }
-            linkedListIterator_destroy(wit);
 
             if (!self) {
-                candSetList = (linked_list_pt) hashMap_get(candidates, importer);
+                candSetList = hashMap_get(candidates, importer);
 
                 if (linkedList_create(&serviceWires) == CELIX_SUCCESS) {
 //                    if (linkedList_create(&emptyWires) == CELIX_SUCCESS) {
-                    int candSetIdx = 0;
 
                     // hashMap_put(wireMap, importer, emptyWires);
 
@@ -468,10 +579,10 @@ linked_list_pt resolver_populateWireMap(hash_map_pt candidates, module_pt import
                     importer_wires_pt importerWires = malloc(sizeof(*importerWires));
                     importerWires->importer = importer;
                     importerWires->wires = NULL;
-                    linkedList_addElement(wireMap, importerWires);
+                    celix_ilist_pushBack(wireMap, &importerWires->node);
 
-                    for (candSetIdx = 0; candSetIdx < linkedList_size(candSetList); candSetIdx++) {
-                        candidate_set_pt cs = (candidate_set_pt) linkedList_get(candSetList, candSetIdx);
+                    CELIX_ILIST_FOR_EACH(candSetList, node) {
+                        candidate_set_pt cs = CELIX_ILIST_ENTRY(node, struct candidateSet, node);
 
                         module_pt module = NULL;
                         capability_getModule(((capability_pt) linkedList_get(cs->candidates, 0)), &module);
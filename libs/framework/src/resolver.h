@@ -30,14 +30,34 @@
 #include "module.h"
 #include "wire.h"
 #include "hash_map.h"
+#include "celix_intrusive_list.h"
 
 struct importer_wires {
     module_pt importer;
     linked_list_pt wires;
+    celix_ilist_node_t node; //entry in the wire map
 };
 typedef struct importer_wires *importer_wires_pt;
 
-linked_list_pt resolver_resolve(module_pt root);
+/**
+ * Resolves the root module. Returns (caller owns the result) the wire map, a list of importer_wires (use
+ * CELIX_ILIST_ENTRY(node, struct importer_wires, node)) with the importers resolved last at the front, or NULL if the
+ * module cannot be resolved.
+ */
+celix_ilist_t* resolver_resolve(module_pt root);
+
+/**
+ * Resolves the root module using a wiring description of a previous resolve (see resolver_describeWiring).
+ * Only succeeds if every requirement of the root module is satisfied by the cached exporter, and the cached exporters
+ * are already resolved. Returns NULL if the cached wiring cannot be used; use resolver_resolve in that case.
+ */
+celix_ilist_t* resolver_resolveCached(module_pt root, const char *wiring);
+
+/**
+ * Returns (caller owns the result) a description of the wires of the (resolved) module, which can be persisted
+ * and used with resolver_resolveCached.
+ */
+char* resolver_describeWiring(module_pt module);
 void resolver_moduleResolved(module_pt module);
 void resolver_addModule(module_pt module);
 void resolver_removeModule(module_pt module);
@@ -68,26 +68,22 @@ celix_status_t serviceReference_create(registry_callback_t callback, bundle_pt r
 }
 
 celix_status_t serviceReference_retain(service_reference_pt ref) {
-    celixThreadRwlock_writeLock(&ref->lock);
-    ref->refCount += 1;
-    celixThreadRwlock_unlock(&ref->lock);
+    __atomic_add_fetch(&ref->refCount, 1, __ATOMIC_ACQ_REL);
     return CELIX_SUCCESS;
 }
 
 celix_status_t serviceReference_release(service_reference_pt ref, bool *out) {
     bool destroyed = false;
-    celixThreadRwlock_writeLock(&ref->lock);
-    assert(ref->refCount > 0);
-    ref->refCount -= 1;
-    if (ref->refCount == 0) {
+    size_t count = __atomic_sub_fetch(&ref->refCount, 1, __ATOMIC_ACQ_REL);
+    assert(count != SIZE_MAX); //note released below zero
+    if (count == 0) {
+        celixThreadRwlock_writeLock(&ref->lock);
         if (ref->registration != NULL) {
             serviceRegistration_release(ref->registration);
         }
         celixThreadRwlock_unlock(&ref->lock);
         serviceReference_destroy(ref);
         destroyed = true;
-    } else {
-        celixThreadRwlock_unlock(&ref->lock);
     }
 
     if (out) {
@@ -98,11 +94,7 @@ celix_status_t serviceReference_release(service_reference_pt ref, bool *out) {
 
 celix_status_t serviceReference_increaseUsage(service_reference_pt ref, size_t *out) {
     //fw_log(logger, OSGI_FRAMEWORK_LOG_DEBUG, "Destroying service reference %p\n", ref);
-    size_t local = 0;
-    celixThreadRwlock_writeLock(&ref->lock);
-    ref->usageCount += 1;
-    local = ref->usageCount;
-    celixThreadRwlock_unlock(&ref->lock);
+    size_t local = __atomic_add_fetch(&ref->usageCount, 1, __ATOMIC_ACQ_REL);
     if (out) {
         *out = local;
     }
@@ -111,16 +103,18 @@ celix_status_t serviceReference_increaseUsage(service_reference_pt ref, size_t *
 
 celix_status_t serviceReference_decreaseUsage(service_reference_pt ref, size_t *out) {
     celix_status_t status = CELIX_SUCCESS;
-    size_t localCount = 0;
-    celixThreadRwlock_writeLock(&ref->lock);
-    if (ref->usageCount == 0) {
+    size_t localCount = __atomic_load_n(&ref->usageCount, __ATOMIC_ACQUIRE);
+    bool decreased = false;
+    while (localCount > 0 && !decreased) {
+        //note on failure localCount is updated with the current usage count
+        decreased = __atomic_compare_exchange_n(&ref->usageCount, &localCount, localCount - 1, false, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE);
+    }
+    if (decreased) {
+        localCount -= 1;
+    } else {
         serviceReference_logWarningUsageCountBelowZero(ref);
         status = CELIX_BUNDLE_EXCEPTION;
-    } else {
-        ref->usageCount -= 1;
     }
-    localCount = ref->usageCount;
-    celixThreadRwlock_unlock(&ref->lock);
 
     if (out) {
         *out = localCount;
@@ -135,17 +129,13 @@ static void serviceReference_logWarningUsageCountBelowZero(service_reference_pt
 
 celix_status_t serviceReference_getUsageCount(service_reference_pt ref, size_t *count) {
     celix_status_t status = CELIX_SUCCESS;
-    celixThreadRwlock_readLock(&ref->lock);
-    *count = ref->usageCount;
-    celixThreadRwlock_unlock(&ref->lock);
+    *count = __atomic_load_n(&ref->usageCount, __ATOMIC_ACQUIRE);
     return status;
 }
 
 celix_status_t serviceReference_getReferenceCount(service_reference_pt ref, size_t *count) {
     celix_status_t status = CELIX_SUCCESS;
-    celixThreadRwlock_readLock(&ref->lock);
-    *count = ref->refCount;
-    celixThreadRwlock_unlock(&ref->lock);
+    *count = __atomic_load_n(&ref->refCount, __ATOMIC_ACQUIRE);
     return status;
 }
 
@@ -155,11 +145,29 @@ celix_status_t serviceReference_getService(service_reference_pt ref, void **serv
     /*NOTE the service argument should be 'const void**'
       To ensure backwards compatibility a cast is made instead.
     */
-    *service = (const void**) ref->service;
+    *service = ref->interceptedService != NULL ? ref->interceptedService : (const void**) ref->service;
     celixThreadRwlock_unlock(&ref->lock);
     return status;
 }
 
+void serviceReference_setInterceptedService(service_reference_pt ref, void *wrapper, void *interceptor) {
+    celixThreadRwlock_writeLock(&ref->lock);
+    ref->interceptedService = wrapper;
+    ref->interceptor = interceptor;
+    celixThreadRwlock_unlock(&ref->lock);
+}
+
+bool serviceReference_takeInterceptedService(service_reference_pt ref, void **wrapper, void **interceptor) {
+    celixThreadRwlock_writeLock(&ref->lock);
+    bool intercepted = ref->interceptedService != NULL;
+    *wrapper = ref->interceptedService;
+    *interceptor = ref->interceptor;
+    ref->interceptedService = NULL;
+    ref->interceptor = NULL;
+    celixThreadRwlock_unlock(&ref->lock);
+    return intercepted;
+}
+
 celix_status_t serviceReference_setService(service_reference_pt ref, const void *service) {
     celix_status_t status = CELIX_SUCCESS;
     celixThreadRwlock_writeLock(&ref->lock);
@@ -37,9 +37,11 @@ struct serviceReference {
 	struct serviceRegistration * registration;
     bundle_pt registrationBundle;
     const void* service;
+    void *interceptedService; //wrapper handed out instead of service by an interceptor hook, NULL if not intercepted
+    void *interceptor; //the registry hook entry of the interceptor hook which created interceptedService
 
-	size_t refCount;
-    size_t usageCount;
+	size_t refCount; //atomic
+    size_t usageCount; //atomic
 
     celix_thread_rwlock_t lock;
 };
@@ -61,6 +63,13 @@ celix_status_t serviceReference_getReferenceCount(service_reference_pt reference
 celix_status_t serviceReference_setService(service_reference_pt ref, const void *service);
 celix_status_t serviceReference_getService(service_reference_pt reference, void **service);
 
+/**
+ * Sets the wrapper which is handed out instead of the service, see celix_service_interceptor_hook.h.
+ * serviceReference_getService will return the wrapper until it is taken with serviceReference_takeInterceptedService.
+ */
+void serviceReference_setInterceptedService(service_reference_pt ref, void *wrapper, void *interceptor);
+bool serviceReference_takeInterceptedService(service_reference_pt ref, void **wrapper, void **interceptor);
+
 celix_status_t serviceReference_getOwner(service_reference_pt reference, bundle_pt *owner);
 
 
@@ -31,6 +31,7 @@
 
 #include "service_registration_private.h"
 #include "celix_constants.h"
+#include "celix_string_pool.h"
 
 static celix_status_t serviceRegistration_initializeProperties(service_registration_pt registration, properties_pt properties);
 static celix_status_t serviceRegistration_createInternal(registry_callback_t callback, bundle_pt bundle, const char* serviceName, unsigned long serviceId,
@@ -59,7 +60,7 @@ static celix_status_t serviceRegistration_createInternal(registry_callback_t cal
         reg->services = NULL;
         reg->nrOfServices = 0;
 		reg->svcType = svcType;
-		reg->className = strndup(serviceName, 1024*10);
+		reg->className = celix_stringPool_intern(serviceName);
 		reg->bundle = bundle;
 		reg->refCount = 1;
 		reg->serviceId = serviceId;
@@ -75,6 +76,7 @@ static celix_status_t serviceRegistration_createInternal(registry_callback_t cal
 		celixThreadRwlock_create(&reg->lock, NULL);
 
 		celixThreadRwlock_writeLock(&reg->lock);
+		reg->propertiesSnapshot = NULL;
 		serviceRegistration_initializeProperties(reg, dictionary);
 		celixThreadRwlock_unlock(&reg->lock);
 
@@ -108,12 +110,12 @@ void serviceRegistration_release(service_registration_pt registration) {
 
 static celix_status_t serviceRegistration_destroy(service_registration_pt registration) {
 	//fw_log(logger, OSGI_FRAMEWORK_LOG_DEBUG, "Destroying service registration %p\n", registration);
-    free(registration->className);
+    celix_stringPool_release(registration->className);
 	registration->className = NULL;
 
     registration->callback.unregister = NULL;
 
-	properties_destroy(registration->properties);
+	serviceRegistration_releasePropertiesSnapshot(registration->propertiesSnapshot);
 	celixThreadRwlock_unlock(&registration->lock);
     celixThreadRwlock_destroy(&registration->lock);
 	free(registration);
@@ -136,11 +138,35 @@ static celix_status_t serviceRegistration_initializeProperties(service_registrat
 		properties_set(dictionary, (char *) OSGI_FRAMEWORK_OBJECTCLASS, registration->className);
 	}
 
+	celix_service_properties_snapshot_t *snapshot = malloc(sizeof(*snapshot));
+	snapshot->refCount = 1;
+	snapshot->version = registration->propertiesSnapshot == NULL ? 0 : registration->propertiesSnapshot->version + 1;
+	snapshot->properties = dictionary;
+	registration->propertiesSnapshot = snapshot;
 	registration->properties = dictionary;
 
 	return CELIX_SUCCESS;
 }
 
+celix_service_properties_snapshot_t* serviceRegistration_getPropertiesSnapshot(service_registration_pt registration) {
+	celixThreadRwlock_readLock(&registration->lock);
+	celix_service_properties_snapshot_t *snapshot = registration->propertiesSnapshot;
+	serviceRegistration_retainPropertiesSnapshot(snapshot);
+	celixThreadRwlock_unlock(&registration->lock);
+	return snapshot;
+}
+
+void serviceRegistration_retainPropertiesSnapshot(celix_service_properties_snapshot_t *snapshot) {
+	__atomic_add_fetch(&snapshot->refCount, 1, __ATOMIC_SEQ_CST);
+}
+
+void serviceRegistration_releasePropertiesSnapshot(celix_service_properties_snapshot_t *snapshot) {
+	if (snapshot != NULL && __atomic_sub_fetch(&snapshot->refCount, 1, __ATOMIC_SEQ_CST) == 0) {
+		properties_destroy(snapshot->properties);
+		free(snapshot);
+	}
+}
+
 void serviceRegistration_invalidate(service_registration_pt registration) {
     celixThreadRwlock_writeLock(&registration->lock);
     registration->svcObj = NULL;
@@ -159,6 +185,17 @@ bool serviceRegistration_isValid(service_registration_pt registration) {
     return isValid;
 }
 
+bool serviceRegistration_markUnregistering(service_registration_pt registration) {
+    bool marked = false;
+    celixThreadRwlock_writeLock(&registration->lock);
+    if (registration->svcObj != NULL && !registration->isUnregistering) {
+        registration->isUnregistering = true;
+        marked = true;
+    }
+    celixThreadRwlock_unlock(&registration->lock);
+    return marked;
+}
+
 celix_status_t serviceRegistration_unregister(service_registration_pt registration) {
 	celix_status_t status = CELIX_SUCCESS;
 
@@ -239,10 +276,12 @@ celix_status_t serviceRegistration_setProperties(service_registration_pt registr
     celix_status_t status;
 
     properties_pt oldProperties = NULL;
+    celix_service_properties_snapshot_t *oldSnapshot = NULL;
     registry_callback_t callback;
 
     celixThreadRwlock_writeLock(&registration->lock);
     oldProperties = registration->properties;
+    oldSnapshot = registration->propertiesSnapshot;
     status = serviceRegistration_initializeProperties(registration, properties);
     callback = registration->callback;
     celixThreadRwlock_unlock(&registration->lock);
@@ -251,6 +290,9 @@ celix_status_t serviceRegistration_setProperties(service_registration_pt registr
         callback.modified(callback.handle, registration, oldProperties);
     }
 
+    //note the old properties are destroyed when they are not used by service trackers anymore
+    serviceRegistration_releasePropertiesSnapshot(oldSnapshot);
+
 	return status;
 }
 
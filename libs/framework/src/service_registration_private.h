@@ -36,12 +36,24 @@ enum celix_service_type {
 	CELIX_DEPRECATED_FACTORY_SERVICE
 };
 
+/**
+ * Immutable, reference counted snapshot of the properties of a service registration.
+ * The snapshot is shared between the registration and the service trackers and is replaced (not updated) when the
+ * service properties are modified. The properties are destroyed when the last snapshot reference is released.
+ */
+typedef struct celix_service_properties_snapshot {
+	long refCount; //atomic
+	long version; //0 for the initial properties, increased for every modification
+	celix_properties_t *properties;
+} celix_service_properties_snapshot_t;
+
 struct serviceRegistration {
     registry_callback_t callback;
 
-	char * className;
+	const char * className; //interned in the celix string pool
 	bundle_pt bundle;
-	properties_pt properties;
+	properties_pt properties; //note same as propertiesSnapshot->properties
+	celix_service_properties_snapshot_t *propertiesSnapshot;
 	unsigned long serviceId;
 
 	bool isUnregistering;
@@ -68,6 +80,20 @@ void serviceRegistration_release(service_registration_pt registration);
 bool serviceRegistration_isValid(service_registration_pt registration);
 void serviceRegistration_invalidate(service_registration_pt registration);
 
+/**
+ * Marks a valid registration as unregistering without calling the unregister callback.
+ * Returns false if the registration is already invalid or unregistering.
+ */
+bool serviceRegistration_markUnregistering(service_registration_pt registration);
+
+/**
+ * Returns the current properties snapshot of the registration. The snapshot is retained and must be released with
+ * serviceRegistration_releasePropertiesSnapshot.
+ */
+celix_service_properties_snapshot_t* serviceRegistration_getPropertiesSnapshot(service_registration_pt registration);
+void serviceRegistration_retainPropertiesSnapshot(celix_service_properties_snapshot_t *snapshot);
+void serviceRegistration_releasePropertiesSnapshot(celix_service_properties_snapshot_t *snapshot);
+
 celix_status_t serviceRegistration_getService(service_registration_pt registration, bundle_pt bundle, const void **service);
 celix_status_t serviceRegistration_ungetService(service_registration_pt registration, bundle_pt bundle, const void **service);
 
@@ -28,6 +28,8 @@
 #include "celix_constants.h"
 #include "service_reference_private.h"
 #include "framework_private.h"
+#include "utils.h"
+#include "celix_string_pool.h"
 
 #ifdef DEBUG
 #define CHECK_DELETED_REFERENCES true
@@ -38,6 +40,9 @@
 static celix_status_t serviceRegistry_registerServiceInternal(service_registry_pt registry, bundle_pt bundle, const char* serviceName, const void * serviceObject, properties_pt dictionary, enum celix_service_type svcType, service_registration_pt *registration);
 static celix_status_t serviceRegistry_addHooks(service_registry_pt registry, const char* serviceName, const void *serviceObject, service_registration_pt registration);
 static celix_status_t serviceRegistry_removeHook(service_registry_pt registry, service_registration_pt registration);
+static void serviceRegistry_addRegistrations(service_registry_pt registry, bundle_pt bundle, service_registration_pt *registrations, size_t nrOfRegistrations);
+static void serviceRegistry_removeRegistrations(service_registry_pt registry, bundle_pt bundle, service_registration_pt *registrations, size_t nrOfRegistrations);
+static void serviceRegistry_fireServiceChanged(service_registry_pt registry, celix_service_event_type_t eventType, service_registration_pt *registrations, size_t nrOfRegistrations);
 static void serviceRegistry_logWarningServiceReferenceUsageCount(service_registry_pt registry, bundle_pt bundle, service_reference_pt ref, size_t usageCount, size_t refCount);
 static void serviceRegistry_logWarningServiceRegistration(service_registry_pt registry, service_registration_pt reg);
 static celix_status_t serviceRegistry_checkReference(service_registry_pt registry, service_reference_pt ref,
@@ -53,6 +58,15 @@ static celix_service_registry_listener_hook_entry_t* celix_createHookEntry(long
 static void celix_waitAndDestroyHookEntry(celix_service_registry_listener_hook_entry_t *entry);
 static void celix_increaseCountHook(celix_service_registry_listener_hook_entry_t *entry);
 static void celix_decreaseCountHook(celix_service_registry_listener_hook_entry_t *entry);
+static void serviceRegistry_interceptService(service_registry_pt registry, bundle_pt consumer, service_registration_pt registration, service_reference_pt reference, const void *svc);
+static void serviceRegistry_releaseInterceptedService(void *wrapper, void *interceptor);
+
+static void serviceRegistry_addToIndex(hash_map_pt index, const char *key, service_registration_pt registration);
+static void serviceRegistry_removeFromIndex(hash_map_pt index, const char *key, service_registration_pt registration);
+static void serviceRegistry_addToPropertyIndexes(celix_service_registry_registration_shard_t *shard, service_registration_pt registration, celix_properties_t *props);
+static void serviceRegistry_removeFromPropertyIndexes(celix_service_registry_registration_shard_t *shard, service_registration_pt registration, celix_properties_t *props);
+static array_list_pt serviceRegistry_findCandidates(celix_service_registry_registration_shard_t *shard, const char *serviceName, celix_filter_t *filter, bool *indexed);
+static bool serviceRegistry_matchRegistration(service_registration_pt registration, const char *pooledServiceName, celix_filter_t *filter);
 
 celix_status_t serviceRegistry_create(framework_pt framework, serviceChanged_function_pt serviceChanged, service_registry_pt *out) {
 	celix_status_t status;
@@ -68,17 +82,29 @@ celix_status_t serviceRegistry_create(framework_pt framework, serviceChanged_fun
         reg->callback.modified = (void *) serviceRegistry_servicePropertiesModified;
 
         reg->serviceChanged = serviceChanged;
-		reg->serviceRegistrations = hashMap_create(NULL, NULL, NULL, NULL);
 		reg->framework = framework;
 		reg->currentServiceId = 1UL;
 		reg->serviceReferences = hashMap_create(NULL, NULL, NULL, NULL);
+        for (int i = 0; i < CELIX_SERVICE_REGISTRY_NR_OF_REGISTRATION_SHARDS; ++i) {
+            celix_service_registry_registration_shard_t *shard = &reg->registrationShards[i];
+            celixThreadRwlock_createNamed(&shard->lock, NULL, "service registry shard");
+            shard->serviceRegistrations = hashMap_create(NULL, NULL, NULL, NULL);
+            shard->serviceRegistrationsByName = hashMap_create(utils_fastStringHash, NULL, utils_stringEquals, NULL);
+            shard->propertyIndexes = hashMap_create(utils_fastStringHash, NULL, utils_stringEquals, NULL);
+        }
 
         reg->checkDeletedReferences = CHECK_DELETED_REFERENCES;
-        reg->deletedServiceReferences = hashMap_create(NULL, NULL, NULL, NULL);
+        for (int i = 0; i < CELIX_SERVICE_REGISTRY_NR_OF_REFERENCE_SHARDS; ++i) {
+            celixThreadMutex_create(&reg->referenceShards[i].mutex, NULL);
+            reg->referenceShards[i].deletedServiceReferences = hashMap_create(NULL, NULL, NULL, NULL);
+        }
 
 		arrayList_create(&reg->listenerHooks);
+		celixThreadMutex_create(&reg->listenerHookBatchesLock, NULL);
+		reg->listenerHookBatches = hashMap_create(NULL, NULL, NULL, NULL);
+		reg->interceptorHooks = celix_arrayList_create();
 
-		status = celixThreadRwlock_create(&reg->lock, NULL);
+		status = celixThreadRwlock_createNamed(&reg->lock, NULL, "service registry");
 	}
 
 	if (status == CELIX_SUCCESS) {
@@ -90,14 +116,14 @@ celix_status_t serviceRegistry_create(framework_pt framework, serviceChanged_fun
 	return status;
 }
 
-celix_status_t serviceRegistry_destroy(service_registry_pt registry) {
-    celixThreadRwlock_writeLock(&registry->lock);
-
-    //destroy service registration map
-    int size = hashMap_size(registry->serviceRegistrations);
+/**
+ * Destroys the registration shard and returns the nr of bundles which still had registrations in the shard.
+ */
+static int serviceRegistry_destroyRegistrationShard(celix_service_registry_registration_shard_t *shard) {
+    int size = hashMap_size(shard->serviceRegistrations);
     if (size > 0) {
-        fw_log(logger, OSGI_FRAMEWORK_LOG_ERROR, "%i bundles with dangling service registration\n");
-        hash_map_iterator_t iter = hashMapIterator_construct(registry->serviceRegistrations);
+        fw_log(logger, OSGI_FRAMEWORK_LOG_ERROR, "%i bundles with dangling service registration\n", size);
+        hash_map_iterator_t iter = hashMapIterator_construct(shard->serviceRegistrations);
         while (hashMapIterator_hasNext(&iter)) {
             hash_map_entry_t *entry = hashMapIterator_nextEntry(&iter);
             bundle_t *bnd = hashMapEntry_getKey(entry);
@@ -116,8 +142,29 @@ celix_status_t serviceRegistry_destroy(service_registry_pt registry) {
             }
         }
     }
+    hashMap_destroy(shard->serviceRegistrations, false, false);
+
+    //destroy service name and property indexes. Note all registrations are gone, so only the (property) maps are left
+    hashMap_destroy(shard->serviceRegistrationsByName, true, false);
+    hash_map_iterator_t indexIter = hashMapIterator_construct(shard->propertyIndexes);
+    while (hashMapIterator_hasNext(&indexIter)) {
+        hash_map_pt index = hashMapIterator_nextValue(&indexIter);
+        hashMap_destroy(index, true, false);
+    }
+    hashMap_destroy(shard->propertyIndexes, true, false);
+    celixThreadRwlock_destroy(&shard->lock);
+    return size;
+}
+
+celix_status_t serviceRegistry_destroy(service_registry_pt registry) {
+    celixThreadRwlock_writeLock(&registry->lock);
+
+    //destroy service registration shards
+    int size = 0;
+    for (int i = 0; i < CELIX_SERVICE_REGISTRY_NR_OF_REGISTRATION_SHARDS; ++i) {
+        size += serviceRegistry_destroyRegistrationShard(&registry->registrationShards[i]);
+    }
     assert(size == 0);
-    hashMap_destroy(registry->serviceRegistrations, false, false);
 
     //destroy service references (double) map);
     //FIXME. The framework bundle does not (yet) call clearReferences, as result the size could be > 0 for test code.
@@ -132,26 +179,76 @@ celix_status_t serviceRegistry_destroy(service_registry_pt registry) {
         celix_waitAndDestroyHookEntry(entry);
     }
     celix_arrayList_destroy(registry->listenerHooks);
+    assert(hashMap_size(registry->listenerHookBatches) == 0);
+    hashMap_destroy(registry->listenerHookBatches, false, false);
+    celixThreadMutex_destroy(&registry->listenerHookBatchesLock);
+
+    //destroy interceptor hooks
+    for (int i = 0; i < celix_arrayList_size(registry->interceptorHooks); ++i) {
+        celix_service_registry_listener_hook_entry_t *entry = celix_arrayList_get(registry->interceptorHooks, i);
+        celix_waitAndDestroyHookEntry(entry);
+    }
+    celix_arrayList_destroy(registry->interceptorHooks);
 
-    hashMap_destroy(registry->deletedServiceReferences, false, false);
+    for (int i = 0; i < CELIX_SERVICE_REGISTRY_NR_OF_REFERENCE_SHARDS; ++i) {
+        hashMap_destroy(registry->referenceShards[i].deletedServiceReferences, false, false);
+        celixThreadMutex_destroy(&registry->referenceShards[i].mutex);
+    }
 
     free(registry);
 
     return CELIX_SUCCESS;
 }
 
+static int serviceRegistry_compareServiceId(celix_array_list_entry_t a, celix_array_list_entry_t b) {
+    service_registration_pt regA = a.voidPtrVal;
+    service_registration_pt regB = b.voidPtrVal;
+    return regA->serviceId < regB->serviceId ? -1 : (regA->serviceId > regB->serviceId ? 1 : 0);
+}
+
+/**
+ * Returns the (retained) registrations of the bundle over all registration shards, in registration (service id) order,
+ * or NULL if the bundle has no registrations.
+ */
+static celix_array_list_t* serviceRegistry_copyBundleRegistrations(service_registry_pt registry, bundle_pt bundle) {
+    celix_array_list_t *result = NULL;
+    for (int s = 0; s < CELIX_SERVICE_REGISTRY_NR_OF_REGISTRATION_SHARDS; ++s) {
+        celix_service_registry_registration_shard_t *shard = &registry->registrationShards[s];
+        celixThreadRwlock_readLock(&shard->lock);
+        array_list_pt regs = hashMap_get(shard->serviceRegistrations, bundle);
+        for (int i = 0; regs != NULL && i < arrayList_size(regs); ++i) {
+            service_registration_pt reg = arrayList_get(regs, i);
+            serviceRegistration_retain(reg);
+            if (result == NULL) {
+                result = celix_arrayList_create();
+            }
+            celix_arrayList_add(result, reg);
+        }
+        celixThreadRwlock_unlock(&shard->lock);
+    }
+    if (result != NULL) {
+        celix_arrayList_sort(result, serviceRegistry_compareServiceId);
+    }
+    return result;
+}
+
+static void serviceRegistry_releaseRegistrations(celix_array_list_t *registrations) {
+    for (int i = 0; registrations != NULL && i < celix_arrayList_size(registrations); ++i) {
+        serviceRegistration_release(celix_arrayList_get(registrations, i));
+    }
+    celix_arrayList_destroy(registrations);
+}
+
 celix_status_t serviceRegistry_getRegisteredServices(service_registry_pt registry, bundle_pt bundle, array_list_pt *services) {
 	celix_status_t status = CELIX_SUCCESS;
 
-	celixThreadRwlock_writeLock(&registry->lock);
-
-	array_list_pt regs = (array_list_pt) hashMap_get(registry->serviceRegistrations, bundle);
+	celix_array_list_t *regs = serviceRegistry_copyBundleRegistrations(registry, bundle);
 	if (regs != NULL) {
-		unsigned int i;
 		arrayList_create(services);
-		
-		for (i = 0; i < arrayList_size(regs); i++) {
-			service_registration_pt reg = arrayList_get(regs, i);
+
+		celixThreadRwlock_writeLock(&registry->lock);
+		for (int i = 0; i < celix_arrayList_size(regs); i++) {
+			service_registration_pt reg = celix_arrayList_get(regs, i);
 			if (serviceRegistration_isValid(reg)) {
 				service_reference_pt reference = NULL;
 				status = serviceRegistry_getServiceReference_internal(registry, bundle, reg, &reference);
@@ -160,10 +257,10 @@ celix_status_t serviceRegistry_getRegisteredServices(service_registry_pt registr
 				}
 			}
 		}
+		celixThreadRwlock_unlock(&registry->lock);
+		serviceRegistry_releaseRegistrations(regs);
 	}
 
-	celixThreadRwlock_unlock(&registry->lock);
-
 	framework_logIfError(logger, status, NULL, "Cannot get registered services");
 
 	return status;
@@ -178,16 +275,15 @@ celix_status_t serviceRegistry_registerServiceFactory(service_registry_pt regist
 }
 
 static celix_status_t serviceRegistry_registerServiceInternal(service_registry_pt registry, bundle_pt bundle, const char* serviceName, const void * serviceObject, properties_pt dictionary, enum celix_service_type svcType, service_registration_pt *registration) {
-	array_list_pt regs;
-
+    unsigned long svcId = __atomic_add_fetch(&registry->currentServiceId, 1, __ATOMIC_RELAXED);
 	if (svcType == CELIX_DEPRECATED_FACTORY_SERVICE) {
         *registration = serviceRegistration_createServiceFactory(registry->callback, bundle, serviceName,
-                                                                 ++registry->currentServiceId, serviceObject,
+                                                                 svcId, serviceObject,
                                                                  dictionary);
     } else if (svcType == CELIX_FACTORY_SERVICE) {
-        *registration = celix_serviceRegistration_createServiceFactory(registry->callback, bundle, serviceName, ++registry->currentServiceId, (celix_service_factory_t*)serviceObject, dictionary);
+        *registration = celix_serviceRegistration_createServiceFactory(registry->callback, bundle, serviceName, svcId, (celix_service_factory_t*)serviceObject, dictionary);
 	} else { //plain
-	    *registration = serviceRegistration_create(registry->callback, bundle, serviceName, ++registry->currentServiceId, serviceObject, dictionary);
+	    *registration = serviceRegistration_create(registry->callback, bundle, serviceName, svcId, serviceObject, dictionary);
 	}
 
     //long id;
@@ -197,15 +293,7 @@ static celix_status_t serviceRegistry_registerServiceInternal(service_registry_p
 
     serviceRegistry_addHooks(registry, serviceName, serviceObject, *registration);
 
-	celixThreadRwlock_writeLock(&registry->lock);
-	regs = (array_list_pt) hashMap_get(registry->serviceRegistrations, bundle);
-	if (regs == NULL) {
-		regs = NULL;
-		arrayList_create(&regs);
-        hashMap_put(registry->serviceRegistrations, bundle, regs);
-    }
-	arrayList_add(regs, *registration);
-	celixThreadRwlock_unlock(&registry->lock);
+	serviceRegistry_addRegistrations(registry, bundle, registration, 1);
 
 	if (registry->serviceChanged != NULL) {
 		registry->serviceChanged(registry->framework, OSGI_FRAMEWORK_SERVICE_EVENT_REGISTERED, *registration, NULL);
@@ -215,30 +303,15 @@ static celix_status_t serviceRegistry_registerServiceInternal(service_registry_p
 }
 
 celix_status_t serviceRegistry_unregisterService(service_registry_pt registry, bundle_pt bundle, service_registration_pt registration) {
-	// array_list_t clients;
-	array_list_pt regs;
-
     //fprintf(stderr, "REG: Unregistering service registration with pointer %p\n", registration);
 
 	serviceRegistry_removeHook(registry, registration);
-
-	celixThreadRwlock_writeLock(&registry->lock);
-	regs = (array_list_pt) hashMap_get(registry->serviceRegistrations, bundle);
-	if (regs != NULL) {
-		arrayList_removeElement(regs, registration);
-        int size = arrayList_size(regs);
-        if (size == 0) {
-            arrayList_destroy(regs);
-            hashMap_remove(registry->serviceRegistrations, bundle);
-        }
-	}
-	celixThreadRwlock_unlock(&registry->lock);
+	serviceRegistry_removeRegistrations(registry, bundle, &registration, 1);
 
 	if (registry->serviceChanged != NULL) {
 		registry->serviceChanged(registry->framework, OSGI_FRAMEWORK_SERVICE_EVENT_UNREGISTERING, registration, NULL);
 	}
 
-
 	celixThreadRwlock_readLock(&registry->lock);
     //invalidate service references
     hash_map_iterator_pt iter = hashMapIterator_create(registry->serviceReferences);
@@ -259,39 +332,209 @@ celix_status_t serviceRegistry_unregisterService(service_registry_pt registry, b
 	return CELIX_SUCCESS;
 }
 
-celix_status_t serviceRegistry_clearServiceRegistrations(service_registry_pt registry, bundle_pt bundle) {
+/**
+ * Locks the registration shards in the mask in ascending order, so that multiple shards can be locked without
+ * deadlocks and a lookup over multiple shards sees a consistent view.
+ */
+static void serviceRegistry_lockRegistrationShards(service_registry_pt registry, uint32_t mask, bool write) {
+    for (int i = 0; i < CELIX_SERVICE_REGISTRY_NR_OF_REGISTRATION_SHARDS; ++i) {
+        if (mask & (1U << i)) {
+            if (write) {
+                celixThreadRwlock_writeLock(&registry->registrationShards[i].lock);
+            } else {
+                celixThreadRwlock_readLock(&registry->registrationShards[i].lock);
+            }
+        }
+    }
+}
+
+static void serviceRegistry_unlockRegistrationShards(service_registry_pt registry, uint32_t mask) {
+    for (int i = CELIX_SERVICE_REGISTRY_NR_OF_REGISTRATION_SHARDS - 1; i >= 0; --i) {
+        if (mask & (1U << i)) {
+            celixThreadRwlock_unlock(&registry->registrationShards[i].lock);
+        }
+    }
+}
+
+static uint32_t serviceRegistry_registrationShardMask(service_registration_pt *registrations, size_t nrOfRegistrations) {
+    uint32_t mask = 0;
+    for (size_t i = 0; i < nrOfRegistrations; ++i) {
+        mask |= 1U << serviceRegistry_registrationShardIndex(registrations[i]->className);
+    }
+    return mask;
+}
+
+static void serviceRegistry_addRegistrations(service_registry_pt registry, bundle_pt bundle, service_registration_pt *registrations, size_t nrOfRegistrations) {
+    //note all shards involved are locked together, so that a batch of registrations becomes visible at once
+    uint32_t mask = serviceRegistry_registrationShardMask(registrations, nrOfRegistrations);
+    serviceRegistry_lockRegistrationShards(registry, mask, true);
+    for (size_t i = 0; i < nrOfRegistrations; ++i) {
+        service_registration_pt registration = registrations[i];
+        celix_service_registry_registration_shard_t *shard = serviceRegistry_getRegistrationShard(registry, registration->className);
+        array_list_pt regs = (array_list_pt) hashMap_get(shard->serviceRegistrations, bundle);
+        if (regs == NULL) {
+            arrayList_create(&regs);
+            hashMap_put(shard->serviceRegistrations, bundle, regs);
+        }
+        arrayList_add(regs, registration);
+        serviceRegistry_addToIndex(shard->serviceRegistrationsByName, registration->className, registration);
+        serviceRegistry_addToPropertyIndexes(shard, registration, registration->properties);
+    }
+    serviceRegistry_unlockRegistrationShards(registry, mask);
+}
+
+static void serviceRegistry_removeRegistrations(service_registry_pt registry, bundle_pt bundle, service_registration_pt *registrations, size_t nrOfRegistrations) {
+    uint32_t mask = serviceRegistry_registrationShardMask(registrations, nrOfRegistrations);
+    serviceRegistry_lockRegistrationShards(registry, mask, true);
+    for (size_t i = 0; i < nrOfRegistrations; ++i) {
+        service_registration_pt registration = registrations[i];
+        celix_service_registry_registration_shard_t *shard = serviceRegistry_getRegistrationShard(registry, registration->className);
+        array_list_pt regs = (array_list_pt) hashMap_get(shard->serviceRegistrations, bundle);
+        if (regs != NULL) {
+            arrayList_removeElement(regs, registration);
+            if (arrayList_size(regs) == 0) {
+                arrayList_destroy(regs);
+                hashMap_remove(shard->serviceRegistrations, bundle);
+            }
+        }
+        serviceRegistry_removeFromIndex(shard->serviceRegistrationsByName, registration->className, registration);
+        serviceRegistry_removeFromPropertyIndexes(shard, registration, registration->properties);
+    }
+    serviceRegistry_unlockRegistrationShards(registry, mask);
+}
+
+static void serviceRegistry_fireServiceChanged(service_registry_pt registry, celix_service_event_type_t eventType, service_registration_pt *registrations, size_t nrOfRegistrations) {
+    if (nrOfRegistrations == 0) {
+        return;
+    }
+    if (registry->serviceChangedForRegistrations != NULL) {
+        registry->serviceChangedForRegistrations(registry->framework, eventType, registrations, nrOfRegistrations);
+    } else if (registry->serviceChanged != NULL) {
+        for (size_t i = 0; i < nrOfRegistrations; ++i) {
+            registry->serviceChanged(registry->framework, eventType, registrations[i], NULL);
+        }
+    }
+}
+
+void celix_serviceRegistry_setServiceChangedForRegistrationsCallback(celix_service_registry_t *registry, celix_serviceRegistry_serviceChangedForRegistrations_fp callback) {
+    registry->serviceChangedForRegistrations = callback;
+}
+
+celix_status_t celix_serviceRegistry_registerServices(
+        celix_service_registry_t *registry,
+        const celix_bundle_t *bnd,
+        size_t nrOfServices,
+        const char * const *serviceNames,
+        const void * const *svcs,
+        celix_service_factory_t * const *factories,
+        celix_properties_t **props,
+        service_registration_t **registrations) {
+    bundle_pt bundle = (bundle_pt)bnd;
+
+    //reserve a consecutive block of service ids
+    unsigned long firstServiceId = __atomic_fetch_add(&registry->currentServiceId, nrOfServices, __ATOMIC_RELAXED) + 1;
+
+    for (size_t i = 0; i < nrOfServices; ++i) {
+        unsigned long svcId = firstServiceId + i;
+        celix_service_factory_t *factory = factories != NULL ? factories[i] : NULL;
+        if (factory != NULL) {
+            registrations[i] = celix_serviceRegistration_createServiceFactory(registry->callback, bundle, serviceNames[i], svcId, factory, props[i]);
+            serviceRegistry_addHooks(registry, serviceNames[i], factory, registrations[i]);
+        } else {
+            registrations[i] = serviceRegistration_create(registry->callback, bundle, serviceNames[i], svcId, svcs[i], props[i]);
+            serviceRegistry_addHooks(registry, serviceNames[i], svcs[i], registrations[i]);
+        }
+    }
+
+    serviceRegistry_addRegistrations(registry, bundle, registrations, nrOfServices);
+    serviceRegistry_fireServiceChanged(registry, OSGI_FRAMEWORK_SERVICE_EVENT_REGISTERED, registrations, nrOfServices);
+
+    return CELIX_SUCCESS;
+}
+
+celix_status_t celix_serviceRegistry_unregisterServices(
+        celix_service_registry_t *registry,
+        const celix_bundle_t *bnd,
+        service_registration_t **registrations,
+        size_t nrOfRegistrations) {
     celix_status_t status = CELIX_SUCCESS;
-    array_list_pt registrations = NULL;
-    bool registrationsLeft;
+    bundle_pt bundle = (bundle_pt)bnd;
 
-    celixThreadRwlock_writeLock(&registry->lock);
-    registrations = hashMap_get(registry->serviceRegistrations, bundle);
-    registrationsLeft = (registrations != NULL);
-    if (registrationsLeft) {
-        registrationsLeft = (arrayList_size(registrations) > 0);
+    service_registration_pt *marked = calloc(nrOfRegistrations, sizeof(*marked));
+    if (marked == NULL && nrOfRegistrations > 0) {
+        status = CELIX_ENOMEM;
+        framework_logIfError(logger, status, NULL, "Cannot unregister services");
+        return status;
+    }
+    size_t nrOfMarked = 0;
+    for (size_t i = 0; i < nrOfRegistrations; ++i) {
+        if (serviceRegistration_markUnregistering(registrations[i])) {
+            marked[nrOfMarked++] = registrations[i];
+        } else {
+            status = CELIX_ILLEGAL_STATE;
+        }
+    }
+
+    for (size_t i = 0; i < nrOfMarked; ++i) {
+        serviceRegistry_removeHook(registry, marked[i]);
+    }
+    serviceRegistry_removeRegistrations(registry, bundle, marked, nrOfMarked);
+    serviceRegistry_fireServiceChanged(registry, OSGI_FRAMEWORK_SERVICE_EVENT_UNREGISTERING, marked, nrOfMarked);
+
+    celixThreadRwlock_readLock(&registry->lock);
+    //invalidate service references
+    hash_map_iterator_t iter = hashMapIterator_construct(registry->serviceReferences);
+    while (hashMapIterator_hasNext(&iter)) {
+        hash_map_pt refsMap = hashMapIterator_nextValue(&iter);
+        for (size_t i = 0; refsMap != NULL && i < nrOfMarked; ++i) {
+            service_reference_pt ref = hashMap_get(refsMap, (void*)marked[i]->serviceId);
+            if (ref != NULL) {
+                serviceReference_invalidate(ref);
+            }
+        }
     }
     celixThreadRwlock_unlock(&registry->lock);
 
-    while (registrationsLeft) {
-        service_registration_pt reg = arrayList_get(registrations, 0);
+    for (size_t i = 0; i < nrOfMarked; ++i) {
+        serviceRegistration_invalidate(marked[i]);
+        serviceRegistration_release(marked[i]);
+    }
+    free(marked);
+
+    framework_logIfError(logger, status, NULL, "Cannot unregister all services, some registrations are already invalid or unregistering");
+    return status;
+}
+
+celix_status_t serviceRegistry_clearServiceRegistrations(service_registry_pt registry, bundle_pt bundle) {
+    celix_status_t status = CELIX_SUCCESS;
+
+    //copy the registrations of the bundle once, instead of looking them up for every unregister
+    celix_array_list_t *registrations = serviceRegistry_copyBundleRegistrations(registry, bundle);
+
+    //note unregister in reverse registration order, so that the registrations are removed from the end of the bundle registrations lists
+    for (int i = registrations == NULL ? -1 : celix_arrayList_size(registrations) - 1; i >= 0; --i) {
+        service_registration_pt reg = celix_arrayList_get(registrations, i);
 
         serviceRegistry_logWarningServiceRegistration(registry, reg);
 
         if (serviceRegistration_isValid(reg)) {
             serviceRegistration_unregister(reg);
+        } else {
+            celix_service_registry_registration_shard_t *shard = serviceRegistry_getRegistrationShard(registry, reg->className);
+            celixThreadRwlock_writeLock(&shard->lock);
+            array_list_pt regs = hashMap_get(shard->serviceRegistrations, bundle);
+            if (regs != NULL) {
+                arrayList_removeElement(regs, reg);
+                if (arrayList_size(regs) == 0) {
+                    arrayList_destroy(regs);
+                    hashMap_remove(shard->serviceRegistrations, bundle);
+                }
+            }
+            celixThreadRwlock_unlock(&shard->lock);
         }
-        else {
-            arrayList_remove(registrations, 0);
-        }
-
-        // not removed by last unregister call?
-        celixThreadRwlock_writeLock(&registry->lock);
-        registrations = hashMap_get(registry->serviceRegistrations, bundle);
-        registrationsLeft = (registrations != NULL);
-        if (registrationsLeft) {
-            registrationsLeft = (arrayList_size(registrations) > 0);
-        }
-        celixThreadRwlock_unlock(&registry->lock);
+    }
+    if (registrations != NULL) {
+        serviceRegistry_releaseRegistrations(registrations);
     }
 
     return status;
@@ -338,7 +581,10 @@ static celix_status_t serviceRegistry_getServiceReference_internal(service_regis
         }
         if (status == CELIX_SUCCESS) {
             hashMap_put(references, (void*)registration->serviceId, ref);
-            hashMap_put(registry->deletedServiceReferences, ref, (void *)false);
+            celix_service_registry_reference_shard_t *shard = serviceRegistry_getReferenceShard(registry, ref);
+            celixThreadMutex_lock(&shard->mutex);
+            hashMap_put(shard->deletedServiceReferences, ref, (void *)false);
+            celixThreadMutex_unlock(&shard->mutex);
         }
     } else {
         serviceReference_retain(ref);
@@ -354,56 +600,64 @@ static celix_status_t serviceRegistry_getServiceReference_internal(service_regis
 	return status;
 }
 
+/**
+ * Adds the (retained) registrations of the shard matching the service name and filter to matchingRegistrations.
+ */
+static void serviceRegistry_collectMatchingRegistrations(celix_service_registry_registration_shard_t *shard, const char *serviceName, const char *pooledServiceName, celix_filter_t *filter, array_list_pt matchingRegistrations) {
+    //only call after locked shard RWlock
+    bool indexed = false;
+    array_list_pt candidates = serviceRegistry_findCandidates(shard, serviceName, filter, &indexed);
+    if (indexed) {
+        //note candidates can be NULL, meaning no registrations are present for the indexed value
+        for (unsigned int regIdx = 0; candidates != NULL && regIdx < arrayList_size(candidates); regIdx++) {
+            service_registration_pt registration = (service_registration_pt) arrayList_get(candidates, regIdx);
+            if (serviceRegistry_matchRegistration(registration, pooledServiceName, filter)) {
+                serviceRegistration_retain(registration);
+                arrayList_add(matchingRegistrations, registration);
+            }
+        }
+    } else {
+        hash_map_iterator_t iterator = hashMapIterator_construct(shard->serviceRegistrations);
+        while (hashMapIterator_hasNext(&iterator)) {
+            array_list_pt regs = (array_list_pt) hashMapIterator_nextValue(&iterator);
+            for (unsigned int regIdx = 0; (regs != NULL) && regIdx < arrayList_size(regs); regIdx++) {
+                service_registration_pt registration = (service_registration_pt) arrayList_get(regs, regIdx);
+                if (serviceRegistry_matchRegistration(registration, pooledServiceName, filter)) {
+                    serviceRegistration_retain(registration);
+                    arrayList_add(matchingRegistrations, registration);
+                }
+            }
+        }
+    }
+}
+
 celix_status_t serviceRegistry_getServiceReferences(service_registry_pt registry, bundle_pt owner, const char *serviceName, filter_pt filter, array_list_pt *out) {
 	celix_status_t status;
-	hash_map_iterator_pt iterator;
     array_list_pt references = NULL;
 	array_list_pt matchingRegistrations = NULL;
-    bool matchResult;
 
     status = arrayList_create(&references);
     status = CELIX_DO_IF(status, arrayList_create(&matchingRegistrations));
 
-    celixThreadRwlock_readLock(&registry->lock);
-	iterator = hashMapIterator_create(registry->serviceRegistrations);
-	while (status == CELIX_SUCCESS && hashMapIterator_hasNext(iterator)) {
-		array_list_pt regs = (array_list_pt) hashMapIterator_nextValue(iterator);
-		unsigned int regIdx;
-		for (regIdx = 0; (regs != NULL) && regIdx < arrayList_size(regs); regIdx++) {
-			service_registration_pt registration = (service_registration_pt) arrayList_get(regs, regIdx);
-			properties_pt props = NULL;
-
-			status = serviceRegistration_getProperties(registration, &props);
-			if (status == CELIX_SUCCESS) {
-				bool matched = false;
-				matchResult = false;
-				if (filter != NULL) {
-					filter_match(filter, props, &matchResult);
-				}
-				if ((serviceName == NULL) && ((filter == NULL) || matchResult)) {
-					matched = true;
-				} else if (serviceName != NULL) {
-					const char *className = NULL;
-					matchResult = false;
-					serviceRegistration_getServiceName(registration, &className);
-					if (filter != NULL) {
-						filter_match(filter, props, &matchResult);
-					}
-					if ((strcmp(className, serviceName) == 0) && ((filter == NULL) || matchResult)) {
-						matched = true;
-					}
-				}
-				if (matched) {
-					if (serviceRegistration_isValid(registration)) {
-                        serviceRegistration_retain(registration);
-                        arrayList_add(matchingRegistrations, registration);
-					}
-				}
-			}
-		}
-	}
-    celixThreadRwlock_unlock(&registry->lock);
-	hashMapIterator_destroy(iterator);
+    //note with a service name only the shard of the service name is needed, otherwise all shards are locked together
+    //to get a consistent view.
+    uint32_t mask = serviceName != NULL ?
+            1U << serviceRegistry_registrationShardIndex(serviceName) :
+            (uint32_t)((1ULL << CELIX_SERVICE_REGISTRY_NR_OF_REGISTRATION_SHARDS) - 1);
+    serviceRegistry_lockRegistrationShards(registry, mask, false);
+    //note the registered service names are interned, so a service name can be matched with a pointer compare.
+    //If the service name is not in the string pool, no service with that name is registered.
+    const char *pooledServiceName = serviceName == NULL ? NULL : celix_stringPool_lookup(serviceName);
+    if (serviceName != NULL && pooledServiceName == NULL) {
+        //nothing to match
+    } else {
+        for (int i = 0; status == CELIX_SUCCESS && i < CELIX_SERVICE_REGISTRY_NR_OF_REGISTRATION_SHARDS; ++i) {
+            if (mask & (1U << i)) {
+                serviceRegistry_collectMatchingRegistrations(&registry->registrationShards[i], serviceName, pooledServiceName, filter, matchingRegistrations);
+            }
+        }
+    }
+    serviceRegistry_unlockRegistrationShards(registry, mask);
 
     if (status == CELIX_SUCCESS) {
         unsigned int i;
@@ -442,7 +696,7 @@ celix_status_t serviceRegistry_retainServiceReference(service_registry_pt regist
     reference_status_t refStatus;
     bundle_pt refBundle = NULL;
     
-    celixThreadRwlock_writeLock(&registry->lock);
+    //note the caller owns the reference, so retaining it (atomic ref count) does not need the registry lock
     serviceRegistry_checkReference(registry, reference, &refStatus);
     if (refStatus == REF_ACTIVE) {
         serviceReference_getOwner(reference, &refBundle);
@@ -455,7 +709,6 @@ celix_status_t serviceRegistry_retainServiceReference(service_registry_pt regist
     } else {
         serviceRegistry_logIllegalReference(registry, reference, refStatus);
     }
-    celixThreadRwlock_unlock(&registry->lock);
 
     return status;
 }
@@ -522,9 +775,11 @@ celix_status_t serviceRegistry_ungetServiceReference(service_registry_pt registr
 
 static celix_status_t serviceRegistry_setReferenceStatus(service_registry_pt registry, service_reference_pt reference,
                                                   bool deleted) {
-    //precondition write locked on registry->lock
     if (registry->checkDeletedReferences) {
-        hashMap_put(registry->deletedServiceReferences, reference, (void *) deleted);
+        celix_service_registry_reference_shard_t *shard = serviceRegistry_getReferenceShard(registry, reference);
+        celixThreadMutex_lock(&shard->mutex);
+        hashMap_put(shard->deletedServiceReferences, reference, (void *) deleted);
+        celixThreadMutex_unlock(&shard->mutex);
     }
     return CELIX_SUCCESS;
 }
@@ -537,16 +792,19 @@ static void serviceRegistry_logIllegalReference(service_registry_pt registry __a
 
 static celix_status_t serviceRegistry_checkReference(service_registry_pt registry, service_reference_pt ref,
                                               reference_status_t *out) {
-    //precondition read or write locked on registry->lock
+    //note no registry lock needed, the reference status is protected by the shard mutex
     celix_status_t status = CELIX_SUCCESS;
 
     if (registry->checkDeletedReferences) {
         reference_status_t refStatus = REF_UNKNOWN;
 
-        if (hashMap_containsKey(registry->deletedServiceReferences, ref)) {
-            bool deleted = (bool) hashMap_get(registry->deletedServiceReferences, ref);
+        celix_service_registry_reference_shard_t *shard = serviceRegistry_getReferenceShard(registry, ref);
+        celixThreadMutex_lock(&shard->mutex);
+        if (hashMap_containsKey(shard->deletedServiceReferences, ref)) {
+            bool deleted = (bool) hashMap_get(shard->deletedServiceReferences, ref);
             refStatus = deleted ? REF_DELETED : REF_ACTIVE;
         }
+        celixThreadMutex_unlock(&shard->mutex);
 
         *out = refStatus;
     } else {
@@ -590,6 +848,7 @@ static void serviceRegistry_logWarningServiceReferenceUsageCount(service_registr
 
 celix_status_t serviceRegistry_clearReferencesFor(service_registry_pt registry, bundle_pt bundle) {
     celix_status_t status = CELIX_SUCCESS;
+    celix_array_list_t *intercepted = NULL; //wrapper, interceptor pairs of references still in use
 
     celixThreadRwlock_writeLock(&registry->lock);
 
@@ -605,6 +864,16 @@ celix_status_t serviceRegistry_clearReferencesFor(service_registry_pt registry,
             serviceReference_getReferenceCount(ref, &refCount);
             serviceRegistry_logWarningServiceReferenceUsageCount(registry, bundle, ref, usageCount, refCount);
 
+            void *wrapper = NULL;
+            void *interceptor = NULL;
+            if (usageCount > 0 && serviceReference_takeInterceptedService(ref, &wrapper, &interceptor)) {
+                if (intercepted == NULL) {
+                    intercepted = celix_arrayList_create();
+                }
+                celix_arrayList_add(intercepted, wrapper);
+                celix_arrayList_add(intercepted, interceptor);
+            }
+
             while (usageCount > 0) {
                 serviceReference_decreaseUsage(ref, &usageCount);
             }
@@ -622,6 +891,14 @@ celix_status_t serviceRegistry_clearReferencesFor(service_registry_pt registry,
 
     celixThreadRwlock_unlock(&registry->lock);
 
+    //note releasing the wrappers outside the registry lock, the interceptor hooks are not called with the lock taken
+    if (intercepted != NULL) {
+        for (int i = 0; i + 1 < celix_arrayList_size(intercepted); i += 2) {
+            serviceRegistry_releaseInterceptedService(celix_arrayList_get(intercepted, i), celix_arrayList_get(intercepted, i + 1));
+        }
+        celix_arrayList_destroy(intercepted);
+    }
+
     return status;
 }
 
@@ -653,6 +930,20 @@ celix_status_t serviceRegistry_getServicesInUse(service_registry_pt registry, bu
 	return CELIX_SUCCESS;
 }
 
+void serviceRegistry_getServiceOwnersUsedBy(service_registry_pt registry, celix_bundle_t *bundle, celix_array_list_t *owners) {
+    celixThreadRwlock_readLock(&registry->lock);
+    hash_map_pt refsMap = hashMap_get(registry->serviceReferences, bundle);
+    if (refsMap != NULL) {
+        hash_map_iterator_t iter = hashMapIterator_construct(refsMap);
+        while (hashMapIterator_hasNext(&iter)) {
+            service_reference_pt ref = hashMapIterator_nextValue(&iter);
+            //note the registration bundle of a reference does not change, and the reference is kept alive by the map
+            celix_arrayList_add(owners, ref->registrationBundle);
+        }
+    }
+    celixThreadRwlock_unlock(&registry->lock);
+}
+
 celix_status_t serviceRegistry_getService(service_registry_pt registry, bundle_pt bundle, service_reference_pt reference, const void **out) {
 	celix_status_t status = CELIX_SUCCESS;
 	service_registration_pt registration = NULL;
@@ -662,7 +953,7 @@ celix_status_t serviceRegistry_getService(service_registry_pt registry, bundle_p
     reference_status_t refStatus;
 
 
-    celixThreadRwlock_readLock(&registry->lock);
+    //note no registry lock needed, the reference status is sharded and the usage count is atomic
     serviceRegistry_checkReference(registry, reference, &refStatus);
     if (refStatus == REF_ACTIVE) {
         serviceReference_getServiceRegistration(reference, &registration);
@@ -674,12 +965,12 @@ celix_status_t serviceRegistry_getService(service_registry_pt registry, bundle_p
             *out = NULL; //invalid service registration
         }
     }
-    celixThreadRwlock_unlock(&registry->lock);
 
     if (valid && refStatus == REF_ACTIVE) {
         if (count == 1) {
             serviceRegistration_getService(registration, bundle, &service);
             serviceReference_setService(reference, service);
+            serviceRegistry_interceptService(registry, bundle, registration, reference, service);
         }
         serviceRegistration_release(registration);
 
@@ -705,13 +996,17 @@ celix_status_t serviceRegistry_ungetService(service_registry_pt registry, bundle
     celix_status_t subStatus = CELIX_SUCCESS;
     reference_status_t refStatus;
 
-    celixThreadRwlock_readLock(&registry->lock);
     serviceRegistry_checkReference(registry, reference, &refStatus);
-    celixThreadRwlock_unlock(&registry->lock);
 
     if (refStatus == REF_ACTIVE) {
         subStatus = serviceReference_decreaseUsage(reference, &count);
         if (count == 0) {
+            void *wrapper = NULL;
+            void *interceptor = NULL;
+            if (serviceReference_takeInterceptedService(reference, &wrapper, &interceptor)) {
+                serviceRegistry_releaseInterceptedService(wrapper, interceptor);
+            }
+
             /*NOTE the argument service of sr_getService should be 'const void**'
               To ensure backwards compatibility a cast is made instead.
               */
@@ -734,7 +1029,7 @@ celix_status_t serviceRegistry_ungetService(service_registry_pt registry, bundle
 	return status;
 }
 
-static celix_status_t serviceRegistry_addHooks(service_registry_pt registry, const char* serviceName, const void* serviceObject __attribute__((unused)), service_registration_pt registration) {
+static celix_status_t serviceRegistry_addHooks(service_registry_pt registry, const char* serviceName, const void* serviceObject, service_registration_pt registration) {
 	celix_status_t status = CELIX_SUCCESS;
 
 	if (strcmp(OSGI_FRAMEWORK_LISTENER_HOOK_SERVICE_NAME, serviceName) == 0) {
@@ -743,6 +1038,14 @@ static celix_status_t serviceRegistry_addHooks(service_registry_pt registry, con
         celix_service_registry_listener_hook_entry_t *entry = celix_createHookEntry(svcId, (celix_listener_hook_service_t*)serviceObject);
 		arrayList_add(registry->listenerHooks, entry);
         celixThreadRwlock_unlock(&registry->lock);
+	} else if (strcmp(CELIX_SERVICE_INTERCEPTOR_HOOK_SERVICE_NAME, serviceName) == 0) {
+        celixThreadRwlock_writeLock(&registry->lock);
+        long svcId = serviceRegistration_getServiceId(registration);
+        celix_service_registry_listener_hook_entry_t *entry = celix_createHookEntry(svcId, NULL);
+        entry->interceptor = (celix_service_interceptor_hook_t*)serviceObject;
+        celix_arrayList_add(registry->interceptorHooks, entry);
+        __atomic_store_n(&registry->nrOfInterceptorHooks, (size_t)celix_arrayList_size(registry->interceptorHooks), __ATOMIC_RELEASE);
+        celixThreadRwlock_unlock(&registry->lock);
 	}
 
 	return status;
@@ -769,6 +1072,18 @@ static celix_status_t serviceRegistry_removeHook(service_registry_pt registry, s
             }
         }
         celixThreadRwlock_unlock(&registry->lock);
+	} else if (strcmp(CELIX_SERVICE_INTERCEPTOR_HOOK_SERVICE_NAME, serviceName) == 0) {
+        celixThreadRwlock_writeLock(&registry->lock);
+        for (int i = 0; i < celix_arrayList_size(registry->interceptorHooks); ++i) {
+            celix_service_registry_listener_hook_entry_t *visit = celix_arrayList_get(registry->interceptorHooks, i);
+            if (visit->svcId == svcId) {
+                removedEntry = visit;
+                celix_arrayList_removeAt(registry->interceptorHooks, i);
+                break;
+            }
+        }
+        __atomic_store_n(&registry->nrOfInterceptorHooks, (size_t)celix_arrayList_size(registry->interceptorHooks), __ATOMIC_RELEASE);
+        celixThreadRwlock_unlock(&registry->lock);
 	}
 
 	if (removedEntry != NULL) {
@@ -778,17 +1093,7 @@ static celix_status_t serviceRegistry_removeHook(service_registry_pt registry, s
 	return status;
 }
 
-void serviceRegistry_callHooksForListenerFilter(service_registry_pt registry, celix_bundle_t *owner, const char *filter, bool removed) {
-    celix_bundle_context_t *ctx;
-    bundle_getContext(owner, &ctx);
-
-    struct listener_hook_info info;
-    info.context = ctx;
-    info.removed = removed;
-    info.filter = filter;
-    celix_array_list_t *infos = celix_arrayList_create();
-    celix_arrayList_add(infos, &info);
-
+static void serviceRegistry_callHooks(service_registry_pt registry, celix_array_list_t *infos, bool removed) {
     celix_array_list_t *hookRegistrations = celix_arrayList_create();
 
     celixThreadRwlock_readLock(&registry->lock);
@@ -812,9 +1117,156 @@ void serviceRegistry_callHooksForListenerFilter(service_registry_pt registry, ce
         celix_decreaseCountHook(entry); //done using hook. decrease count
     }
     celix_arrayList_destroy(hookRegistrations);
+}
+
+/**
+ * Lets the interceptor hooks wrap the service for the consumer. Called for the first get of the reference, before
+ * the service is handed out. The hook entry of the used interceptor keeps its count increased until the wrapper is
+ * released.
+ */
+static void serviceRegistry_interceptService(service_registry_pt registry, bundle_pt consumer, service_registration_pt registration, service_reference_pt reference, const void *svc) {
+    if (svc == NULL || __atomic_load_n(&registry->nrOfInterceptorHooks, __ATOMIC_ACQUIRE) == 0) {
+        return;
+    }
+
+    celix_array_list_t *hooks = celix_arrayList_create();
+    celixThreadRwlock_readLock(&registry->lock);
+    for (int i = 0; i < celix_arrayList_size(registry->interceptorHooks); ++i) {
+        celix_service_registry_listener_hook_entry_t *entry = celix_arrayList_get(registry->interceptorHooks, i);
+        celix_increaseCountHook(entry);
+        celix_arrayList_add(hooks, entry);
+    }
+    celixThreadRwlock_unlock(&registry->lock);
+
+    bundle_pt provider = NULL;
+    properties_pt props = NULL;
+    serviceRegistration_getBundle(registration, &provider);
+    serviceRegistration_getProperties(registration, &props);
+
+    void *wrapper = NULL;
+    celix_service_registry_listener_hook_entry_t *used = NULL;
+    for (int i = 0; i < celix_arrayList_size(hooks); ++i) {
+        celix_service_registry_listener_hook_entry_t *entry = celix_arrayList_get(hooks, i);
+        if (used == NULL) {
+            wrapper = entry->interceptor->intercept(entry->interceptor->handle, consumer, provider, props, svc);
+            if (wrapper != NULL) {
+                used = entry; //note count stays increased while the wrapper is in use
+                continue;
+            }
+        }
+        celix_decreaseCountHook(entry);
+    }
+    celix_arrayList_destroy(hooks);
+
+    if (used != NULL) {
+        serviceReference_setInterceptedService(reference, wrapper, used);
+    }
+}
+
+static void serviceRegistry_releaseInterceptedService(void *wrapper, void *interceptor) {
+    celix_service_registry_listener_hook_entry_t *entry = interceptor;
+    entry->interceptor->release(entry->interceptor->handle, wrapper);
+    celix_decreaseCountHook(entry);
+}
+
+void serviceRegistry_callHooksForListenerFilter(service_registry_pt registry, celix_bundle_t *owner, const char *filter, bool removed) {
+    celix_bundle_context_t *ctx;
+    bundle_getContext(owner, &ctx);
+
+    bool batched = false;
+    celixThreadMutex_lock(&registry->listenerHookBatchesLock);
+    celix_service_registry_listener_hook_batch_t *batch = hashMap_get(registry->listenerHookBatches, owner);
+    if (batch != NULL) {
+        celix_service_registry_pending_hook_info_t *pending = calloc(1, sizeof(*pending));
+        pending->filter = filter == NULL ? NULL : strndup(filter, 1024 * 1024);
+        pending->info.context = ctx;
+        pending->info.removed = removed;
+        pending->info.filter = pending->filter;
+        celix_arrayList_add(batch->infos, pending);
+        batched = true;
+    }
+    celixThreadMutex_unlock(&registry->listenerHookBatchesLock);
+    if (batched) {
+        return;
+    }
+
+    struct listener_hook_info info;
+    info.context = ctx;
+    info.removed = removed;
+    info.filter = filter;
+    celix_array_list_t *infos = celix_arrayList_create();
+    celix_arrayList_add(infos, &info);
+    serviceRegistry_callHooks(registry, infos, removed);
     celix_arrayList_destroy(infos);
 }
 
+void serviceRegistry_beginListenerHookBatch(service_registry_pt registry, celix_bundle_t *owner) {
+    celixThreadMutex_lock(&registry->listenerHookBatchesLock);
+    celix_service_registry_listener_hook_batch_t *batch = hashMap_get(registry->listenerHookBatches, owner);
+    if (batch == NULL) {
+        batch = calloc(1, sizeof(*batch));
+        batch->infos = celix_arrayList_create();
+        hashMap_put(registry->listenerHookBatches, owner, batch);
+    }
+    batch->depth += 1;
+    celixThreadMutex_unlock(&registry->listenerHookBatchesLock);
+}
+
+void serviceRegistry_endListenerHookBatch(service_registry_pt registry, celix_bundle_t *owner) {
+    celix_service_registry_listener_hook_batch_t *ended = NULL;
+    celixThreadMutex_lock(&registry->listenerHookBatchesLock);
+    celix_service_registry_listener_hook_batch_t *batch = hashMap_get(registry->listenerHookBatches, owner);
+    if (batch != NULL) {
+        batch->depth -= 1;
+        if (batch->depth == 0) {
+            hashMap_remove(registry->listenerHookBatches, owner);
+            ended = batch;
+        }
+    }
+    celixThreadMutex_unlock(&registry->listenerHookBatchesLock);
+
+    if (ended == NULL) {
+        return;
+    }
+
+    //call the hooks per sequence of added or removed listeners, to keep the order of the listener changes
+    int size = celix_arrayList_size(ended->infos);
+    celix_array_list_t *infos = celix_arrayList_create();
+    for (int i = 0; i < size; ++i) {
+        celix_service_registry_pending_hook_info_t *pending = celix_arrayList_get(ended->infos, i);
+        celix_arrayList_add(infos, &pending->info);
+        celix_service_registry_pending_hook_info_t *next = i + 1 < size ? celix_arrayList_get(ended->infos, i + 1) : NULL;
+        if (next == NULL || next->info.removed != pending->info.removed) {
+            serviceRegistry_callHooks(registry, infos, pending->info.removed);
+            celix_arrayList_clear(infos);
+        }
+    }
+    celix_arrayList_destroy(infos);
+
+    for (int i = 0; i < size; ++i) {
+        celix_service_registry_pending_hook_info_t *pending = celix_arrayList_get(ended->infos, i);
+        free(pending->filter);
+        free(pending);
+    }
+    celix_arrayList_destroy(ended->infos);
+    free(ended);
+}
+
+size_t serviceRegistry_nrOfServices(service_registry_pt registry) {
+    size_t count = 0;
+    for (int i = 0; i < CELIX_SERVICE_REGISTRY_NR_OF_REGISTRATION_SHARDS; ++i) {
+        celix_service_registry_registration_shard_t *shard = &registry->registrationShards[i];
+        celixThreadRwlock_readLock(&shard->lock);
+        hash_map_iterator_t iter = hashMapIterator_construct(shard->serviceRegistrations);
+        while (hashMapIterator_hasNext(&iter)) {
+            array_list_pt regs = hashMapIterator_nextValue(&iter);
+            count += (size_t)arrayList_size(regs);
+        }
+        celixThreadRwlock_unlock(&shard->lock);
+    }
+    return count;
+}
+
 size_t serviceRegistry_nrOfHooks(service_registry_pt registry) {
     celixThreadRwlock_readLock(&registry->lock);
     unsigned size = arrayList_size(registry->listenerHooks);
@@ -823,6 +1275,12 @@ size_t serviceRegistry_nrOfHooks(service_registry_pt registry) {
 }
 
 celix_status_t serviceRegistry_servicePropertiesModified(service_registry_pt registry, service_registration_pt registration, properties_pt oldprops) {
+    celix_service_registry_registration_shard_t *shard = serviceRegistry_getRegistrationShard(registry, registration->className);
+    celixThreadRwlock_writeLock(&shard->lock);
+    serviceRegistry_removeFromPropertyIndexes(shard, registration, oldprops);
+    serviceRegistry_addToPropertyIndexes(shard, registration, registration->properties);
+    celixThreadRwlock_unlock(&shard->lock);
+
 	if (registry->serviceChanged != NULL) {
 		registry->serviceChanged(registry->framework, OSGI_FRAMEWORK_SERVICE_EVENT_MODIFIED, registration, oldprops);
 	}
@@ -890,7 +1348,7 @@ static void celix_waitAndDestroyHookEntry(celix_service_registry_listener_hook_e
             waitCount += 1;
             if (waitCount >= 5) {
                 fw_log(logger, OSGI_FRAMEWORK_LOG_WARNING,
-                        "Still waiting for service listener hook use count to become zero. Waiting for %i seconds. Use Count is %i, svc id is %li", waitCount, (int)entry->count, entry->svcId);
+                        "Still waiting for service %s hook use count to become zero. Waiting for %i seconds. Use Count is %i, svc id is %li", entry->interceptor != NULL ? "interceptor" : "listener", waitCount, (int)entry->count, entry->svcId);
             }
         }
         celixThreadMutex_unlock(&entry->mutex);
@@ -916,4 +1374,230 @@ static void celix_decreaseCountHook(celix_service_registry_listener_hook_entry_t
         celixThreadCondition_broadcast(&entry->cond);
         celixThreadMutex_unlock(&entry->mutex);
     }
-}
\ No newline at end of file
+}
+celix_status_t celix_serviceRegistry_addPropertyIndex(celix_service_registry_t *registry, const char *propertyName) {
+    if (registry == NULL || propertyName == NULL) {
+        return CELIX_ILLEGAL_ARGUMENT;
+    }
+    if (strncmp(propertyName, OSGI_FRAMEWORK_OBJECTCLASS, 1024) == 0) {
+        return CELIX_SUCCESS; //objectClass is always indexed through the service name index
+    }
+
+    //note all shards are locked together, so that all shards index the same properties
+    uint32_t mask = (uint32_t)((1ULL << CELIX_SERVICE_REGISTRY_NR_OF_REGISTRATION_SHARDS) - 1);
+    serviceRegistry_lockRegistrationShards(registry, mask, true);
+    for (int s = 0; s < CELIX_SERVICE_REGISTRY_NR_OF_REGISTRATION_SHARDS; ++s) {
+        celix_service_registry_registration_shard_t *shard = &registry->registrationShards[s];
+        if (hashMap_containsKey(shard->propertyIndexes, propertyName)) {
+            continue;
+        }
+        hash_map_pt index = hashMap_create(utils_fastStringHash, NULL, utils_stringEquals, NULL);
+        hashMap_put(shard->propertyIndexes, strndup(propertyName, 1024), index);
+
+        //index already registered services
+        hash_map_iterator_t iter = hashMapIterator_construct(shard->serviceRegistrations);
+        while (hashMapIterator_hasNext(&iter)) {
+            array_list_pt regs = hashMapIterator_nextValue(&iter);
+            for (int i = 0; i < arrayList_size(regs); ++i) {
+                service_registration_pt reg = arrayList_get(regs, i);
+                const char *val = reg->properties == NULL ? NULL : celix_properties_get(reg->properties, propertyName, NULL);
+                if (val != NULL) {
+                    serviceRegistry_addToIndex(index, val, reg);
+                }
+            }
+        }
+    }
+    serviceRegistry_unlockRegistrationShards(registry, mask);
+
+    return CELIX_SUCCESS;
+}
+
+static void serviceRegistry_addToIndex(hash_map_pt index, const char *key, service_registration_pt registration) {
+    //only call after locked shard RWlock
+    if (key == NULL) {
+        return;
+    }
+    array_list_pt regs = hashMap_get(index, key);
+    if (regs == NULL) {
+        regs = celix_arrayList_create();
+        hashMap_put(index, strndup(key, 1024 * 1024), regs);
+    }
+    arrayList_add(regs, registration);
+}
+
+static void serviceRegistry_removeFromIndex(hash_map_pt index, const char *key, service_registration_pt registration) {
+    //only call after locked shard RWlock
+    if (key == NULL) {
+        return;
+    }
+    hash_map_entry_pt entry = hashMap_getEntry(index, key);
+    if (entry != NULL) {
+        array_list_pt regs = hashMapEntry_getValue(entry);
+        arrayList_removeElement(regs, registration);
+        if (arrayList_size(regs) == 0) {
+            char *indexKey = hashMapEntry_getKey(entry);
+            hashMap_remove(index, key);
+            free(indexKey);
+            arrayList_destroy(regs);
+        }
+    }
+}
+
+static void serviceRegistry_addToPropertyIndexes(celix_service_registry_registration_shard_t *shard, service_registration_pt registration, celix_properties_t *props) {
+    //only call after locked shard RWlock
+    if (props == NULL || hashMap_size(shard->propertyIndexes) == 0) {
+        return;
+    }
+    hash_map_iterator_t iter = hashMapIterator_construct(shard->propertyIndexes);
+    while (hashMapIterator_hasNext(&iter)) {
+        hash_map_entry_pt entry = hashMapIterator_nextEntry(&iter);
+        const char *propertyName = hashMapEntry_getKey(entry);
+        hash_map_pt index = hashMapEntry_getValue(entry);
+        serviceRegistry_addToIndex(index, celix_properties_get(props, propertyName, NULL), registration);
+    }
+}
+
+static void serviceRegistry_removeFromPropertyIndexes(celix_service_registry_registration_shard_t *shard, service_registration_pt registration, celix_properties_t *props) {
+    //only call after locked shard RWlock
+    if (props == NULL || hashMap_size(shard->propertyIndexes) == 0) {
+        return;
+    }
+    hash_map_iterator_t iter = hashMapIterator_construct(shard->propertyIndexes);
+    while (hashMapIterator_hasNext(&iter)) {
+        hash_map_entry_pt entry = hashMapIterator_nextEntry(&iter);
+        const char *propertyName = hashMapEntry_getKey(entry);
+        hash_map_pt index = hashMapEntry_getValue(entry);
+        serviceRegistry_removeFromIndex(index, celix_properties_get(props, propertyName, NULL), registration);
+    }
+}
+
+/**
+ * Returns the index bucket for a attribute equality or NULL if no registrations exists for the value.
+ * If the attribute is not indexed, indexed is false.
+ */
+static array_list_pt serviceRegistry_lookupIndex(celix_service_registry_registration_shard_t *shard, const char *attribute, const char *value, bool *indexed) {
+    //only call after locked shard RWlock
+    array_list_pt bucket = NULL;
+    *indexed = false;
+    if (attribute == NULL || value == NULL) {
+        //nop
+    } else if (strncmp(attribute, OSGI_FRAMEWORK_OBJECTCLASS, 1024) == 0) {
+        *indexed = true;
+        bucket = hashMap_get(shard->serviceRegistrationsByName, value);
+    } else {
+        hash_map_pt index = hashMap_get(shard->propertyIndexes, attribute);
+        if (index != NULL) {
+            *indexed = true;
+            bucket = hashMap_get(index, value);
+        }
+    }
+    return bucket;
+}
+
+/**
+ * Tries to find the smallest index bucket for the provided service name and filter.
+ * This is possible for the service name and for a filter with a top-level equality or a top-level AND with equality
+ * children on indexed properties.
+ * If no index can be used, indexed is false and the caller should scan all registrations.
+ */
+static array_list_pt serviceRegistry_findCandidates(celix_service_registry_registration_shard_t *shard, const char *serviceName, celix_filter_t *filter, bool *indexed) {
+    //only call after locked shard RWlock
+    array_list_pt result = NULL;
+    *indexed = false;
+
+    if (serviceName != NULL) {
+        result = serviceRegistry_lookupIndex(shard, OSGI_FRAMEWORK_OBJECTCLASS, serviceName, indexed);
+    }
+
+    if (filter != NULL && (filter->operand == CELIX_FILTER_OPERAND_EQUAL || filter->operand == CELIX_FILTER_OPERAND_AND)) {
+        int size = filter->operand == CELIX_FILTER_OPERAND_AND ? celix_arrayList_size(filter->children) : 1;
+        for (int i = 0; i < size; ++i) {
+            if (*indexed && (result == NULL || arrayList_size(result) <= 1)) {
+                break; //cannot get smaller
+            }
+            celix_filter_t *eq = filter->operand == CELIX_FILTER_OPERAND_AND ? celix_arrayList_get(filter->children, i) : filter;
+            if (eq->operand != CELIX_FILTER_OPERAND_EQUAL) {
+                continue;
+            }
+            bool attrIndexed = false;
+            array_list_pt bucket = serviceRegistry_lookupIndex(shard, eq->attribute, eq->value, &attrIndexed);
+            if (attrIndexed && (!(*indexed) || bucket == NULL || arrayList_size(bucket) < arrayList_size(result))) {
+                result = bucket;
+                *indexed = true;
+            }
+        }
+    }
+
+    return result;
+}
+
+/**
+ * Matches the registration against the (interned) service name and filter.
+ * Should be called with the shard lock of the service name taken, so that the interned service name is kept alive by
+ * the registrations.
+ */
+static bool serviceRegistry_matchRegistration(service_registration_pt registration, const char *pooledServiceName, celix_filter_t *filter) {
+    bool matched = false;
+    properties_pt props = NULL;
+    celix_status_t status = serviceRegistration_getProperties(registration, &props);
+    if (status == CELIX_SUCCESS) {
+        bool matchResult = true;
+        if (filter != NULL) {
+            filter_match(filter, props, &matchResult);
+        }
+        if (matchResult && pooledServiceName != NULL) {
+            const char *className = NULL;
+            serviceRegistration_getServiceName(registration, &className);
+            matchResult = className == pooledServiceName;
+        }
+        matched = matchResult && serviceRegistration_isValid(registration);
+    }
+    return matched;
+}
+
+/**
+ * Estimated size of a (properties) hash map entry, i.e. the entry itself and the table slot.
+ */
+#define CELIX_SERVICE_REGISTRY_HASH_MAP_ENTRY_SIZE (5 * sizeof(void*))
+
+static size_t serviceRegistry_propertiesMemoryUsage(const celix_properties_t *props) {
+    size_t bytes = 0;
+    if (props != NULL) {
+        const char *key = NULL;
+        CELIX_PROPERTIES_FOR_EACH(props, key) {
+            const char *val = celix_properties_get(props, key, "");
+            bytes += CELIX_SERVICE_REGISTRY_HASH_MAP_ENTRY_SIZE + strlen(key) + 1 + strlen(val) + 1;
+        }
+    }
+    return bytes;
+}
+
+void celix_serviceRegistry_addBundleMemoryStats(celix_service_registry_t *registry, const celix_bundle_t *bnd, celix_framework_bundle_memory_stats_t *stats) {
+    celix_array_list_t *regs = serviceRegistry_copyBundleRegistrations(registry, (bundle_pt)bnd);
+    for (int i = 0; regs != NULL && i < celix_arrayList_size(regs); ++i) {
+        service_registration_pt reg = celix_arrayList_get(regs, i);
+        const char *serviceName = NULL;
+        serviceRegistration_getServiceName(reg, &serviceName);
+        stats->nrOfServiceRegistrations += 1;
+        stats->serviceRegistrationsInBytes += sizeof(*reg) + (serviceName == NULL ? 0 : strlen(serviceName) + 1);
+
+        celix_service_properties_snapshot_t *snapshot = serviceRegistration_getPropertiesSnapshot(reg);
+        if (snapshot != NULL) {
+            stats->servicePropertiesInBytes += sizeof(*snapshot) + serviceRegistry_propertiesMemoryUsage(snapshot->properties);
+            serviceRegistration_releasePropertiesSnapshot(snapshot);
+        }
+    }
+    if (regs != NULL) {
+        serviceRegistry_releaseRegistrations(regs);
+    }
+
+    celixThreadRwlock_readLock(&registry->lock);
+    hash_map_pt refs = hashMap_get(registry->serviceReferences, bnd);
+    if (refs != NULL) {
+        size_t nrOfRefs = (size_t)hashMap_size(refs);
+        stats->nrOfServiceReferences += nrOfRefs;
+        stats->serviceReferencesInBytes += nrOfRefs * (sizeof(struct serviceReference) + CELIX_SERVICE_REGISTRY_HASH_MAP_ENTRY_SIZE);
+    }
+
+    celixThreadRwlock_unlock(&registry->lock);
+}
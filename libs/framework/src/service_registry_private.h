@@ -27,37 +27,107 @@
 #ifndef SERVICE_REGISTRY_PRIVATE_H_
 #define SERVICE_REGISTRY_PRIVATE_H_
 
+#include <stdint.h>
+
 #include "registry_callback_private.h"
 #include "service_registry.h"
 #include "listener_hook_service.h"
+#include "celix_service_interceptor_hook.h"
 #include "service_reference.h"
+#include "utils.h"
+
+#define CELIX_SERVICE_REGISTRY_NR_OF_REFERENCE_SHARDS 16
+
+/**
+ * Shard of the service reference status administration.
+ * The status of a service reference is protected by the mutex of its shard instead of the registry lock, so that
+ * get/unget service calls on different references do not contend.
+ */
+typedef struct celix_service_registry_reference_shard {
+    celix_thread_mutex_t mutex; //protects below
+    hash_map_pt deletedServiceReferences; //key = ref pointer, value = bool
+} celix_service_registry_reference_shard_t;
+
+#define CELIX_SERVICE_REGISTRY_NR_OF_REGISTRATION_SHARDS 16 //max 32, the shards involved in a call are kept in a uint32_t mask
+
+/**
+ * Shard of the service registrations, a registration is stored in the shard of its service name.
+ * The registrations of a shard are protected by the rwlock of the shard instead of the registry lock, so that
+ * (un)registrations of services with different names do not contend.
+ *
+ * When multiple shards are locked, they are always locked in ascending order. A shard lock and the registry lock are
+ * never held at the same time.
+ */
+typedef struct celix_service_registry_registration_shard {
+	celix_thread_rwlock_t lock; //protects below
+	hash_map_pt serviceRegistrations; //key = bundle (reg owner), value = list ( registration )
+	hash_map_pt serviceRegistrationsByName; //key = service name (objectClass), value = list ( registration )
+	hash_map_pt propertyIndexes; //key = property name, value = map (key = property value, value = list ( registration )). Same property names for all shards
+} celix_service_registry_registration_shard_t;
 
 struct celix_serviceRegistry {
 	framework_pt framework;
 	registry_callback_t callback;
 
-	hash_map_pt serviceRegistrations; //key = bundle (reg owner), value = list ( registration )
+	celix_service_registry_registration_shard_t registrationShards[CELIX_SERVICE_REGISTRY_NR_OF_REGISTRATION_SHARDS];
 	hash_map_pt serviceReferences; //key = bundle, value = map (key = serviceId, value = reference)
 
 	bool checkDeletedReferences; //If enabled. check if provided service references are still valid
-	hash_map_pt deletedServiceReferences; //key = ref pointer, value = bool
+	celix_service_registry_reference_shard_t referenceShards[CELIX_SERVICE_REGISTRY_NR_OF_REFERENCE_SHARDS];
 
 	serviceChanged_function_pt serviceChanged;
-	unsigned long currentServiceId;
+	celix_serviceRegistry_serviceChangedForRegistrations_fp serviceChangedForRegistrations; //optional, used for bulk (un)registrations
+	unsigned long currentServiceId; //atomic
 
 	array_list_pt listenerHooks; //celix_service_registry_listener_hook_entry_t*
+	celix_thread_mutex_t listenerHookBatchesLock; //protects listenerHookBatches
+	hash_map_pt listenerHookBatches; //key = bundle, value = celix_service_registry_listener_hook_batch_t*
+
+	celix_array_list_t *interceptorHooks; //celix_service_registry_listener_hook_entry_t*, with interceptor set
+	size_t nrOfInterceptorHooks; //atomic, size of interceptorHooks. Used to skip the registry lock if there are no interceptor hooks
 
 	celix_thread_rwlock_t lock;
 };
 
+/**
+ * Entry for a listener hook or a service interceptor hook (only one of hook and interceptor is set).
+ * The count is the nr of ongoing hook calls, for interceptor hooks also the nr of wrappers in use.
+ */
 typedef struct celix_service_registry_listener_hook_entry {
     long svcId;
     celix_listener_hook_service_t *hook;
+    celix_service_interceptor_hook_t *interceptor;
     celix_thread_mutex_t mutex; //protects below
     celix_thread_cond_t cond;
     unsigned int count;
 } celix_service_registry_listener_hook_entry_t;
 
+/**
+ * The listener hook calls collected for a bundle during its start or stop, see serviceRegistry_beginListenerHookBatch.
+ */
+typedef struct celix_service_registry_listener_hook_batch {
+    int depth; //nr of begin calls without end call
+    celix_array_list_t *infos; //celix_service_registry_pending_hook_info_t*, in call order
+} celix_service_registry_listener_hook_batch_t;
+
+typedef struct celix_service_registry_pending_hook_info {
+    struct listener_hook_info info;
+    char *filter; //owned, info.filter points to it
+} celix_service_registry_pending_hook_info_t;
+
+static inline celix_service_registry_reference_shard_t* serviceRegistry_getReferenceShard(celix_service_registry_t *registry, const void *ref) {
+    uintptr_t key = (uintptr_t)ref;
+    return &registry->referenceShards[(key >> 4) % CELIX_SERVICE_REGISTRY_NR_OF_REFERENCE_SHARDS];
+}
+
+static inline size_t serviceRegistry_registrationShardIndex(const char *serviceName) {
+    return serviceName == NULL ? 0 : utils_fastStringHash(serviceName) % CELIX_SERVICE_REGISTRY_NR_OF_REGISTRATION_SHARDS;
+}
+
+static inline celix_service_registry_registration_shard_t* serviceRegistry_getRegistrationShard(celix_service_registry_t *registry, const char *serviceName) {
+    return &registry->registrationShards[serviceRegistry_registrationShardIndex(serviceName)];
+}
+
 typedef enum reference_status_enum {
 	REF_ACTIVE,
 	REF_DELETED,
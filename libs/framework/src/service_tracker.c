@@ -32,9 +32,12 @@
 #include "celix_log.h"
 #include "bundle_context_private.h"
 #include "celix_array_list.h"
+#include "celix_string_pool.h"
+#include "celix_probes.h"
 
 static celix_status_t serviceTracker_track(celix_service_tracker_instance_t *tracker, service_reference_pt reference, celix_service_event_t *event);
 static celix_status_t serviceTracker_untrack(celix_service_tracker_instance_t *tracker, service_reference_pt reference, celix_service_event_t *event);
+static bool serviceTracker_isInVersionRange(service_tracker_pt tracker, service_reference_pt reference);
 static void serviceTracker_untrackTracked(celix_service_tracker_instance_t *tracker, celix_tracked_entry_t *tracked);
 static celix_status_t serviceTracker_invokeAddingService(celix_service_tracker_instance_t *tracker, service_reference_pt ref, void **svcOut);
 static celix_status_t serviceTracker_invokeAddService(celix_service_tracker_instance_t *tracker, celix_tracked_entry_t *tracked);
@@ -43,11 +46,11 @@ static celix_status_t serviceTracker_invokeRemovingService(celix_service_tracker
 static void serviceTracker_checkAndInvokeSetService(void *handle, void *highestSvc, const properties_t *props, const bundle_t *bnd);
 static bool serviceTracker_useHighestRankingServiceInternal(celix_service_tracker_instance_t *instance,
                                                             const char *serviceName /*sanity*/,
-                                                            double waitTimeoutInSeconds,
                                                             void *callbackHandle,
                                                             void (*use)(void *handle, void *svc),
                                                             void (*useWithProperties)(void *handle, void *svc, const celix_properties_t *props),
                                                             void (*useWithOwner)(void *handle, void *svc, const celix_properties_t *props, const celix_bundle_t *owner));
+static void serviceTracker_updateHighestRankingService(celix_service_tracker_instance_t *instance, const char *serviceName);
 
 static void serviceTracker_addInstanceFromShutdownList(celix_service_tracker_instance_t *instance);
 static void serviceTracker_remInstanceFromShutdownList(celix_service_tracker_instance_t *instance);
@@ -57,18 +60,39 @@ static celix_thread_mutex_t g_mutex;
 static celix_thread_cond_t g_cond;
 static celix_array_list_t *g_shutdownInstances = NULL; //value = celix_service_tracker_instance -> used for syncing with shutdown threads
 
+//used to wait for the readers in a grace period. Note global, because a reader leaving its read section can be the
+//last access to a tracker before it is destroyed.
+static celix_thread_mutex_t g_graceMutex;
+static celix_thread_cond_t g_graceCond; //broadcasted when a reader leaves while g_graceWaiters > 0
+static long g_graceWaiters = 0; //atomic, nr of grace periods waiting for readers
+
+//read section of a thread, used to prevent that a thread waits on its own read sections (e.g. unregister in a use callback)
+typedef struct celix_tracker_read_frame {
+    celix_service_tracker_t *tracker;
+    int idx;
+    struct celix_tracker_read_frame *next;
+} celix_tracker_read_frame_t;
+
+static __thread celix_tracker_read_frame_t *g_readFrames = NULL;
+
 static void serviceTracker_once(void) {
     celixThreadMutex_create(&g_mutex, NULL);
     celixThreadCondition_init(&g_cond, NULL);
+    celixThreadMutex_create(&g_graceMutex, NULL);
+    celixThreadCondition_init(&g_graceCond, NULL);
 }
 
-static inline celix_tracked_entry_t* tracked_create(service_reference_pt ref, void *svc, celix_properties_t *props, celix_bundle_t *bnd) {
+static inline celix_tracked_entry_t* tracked_create(service_reference_pt ref, void *svc, celix_service_properties_snapshot_t *propertiesSnapshot, celix_bundle_t *bnd) {
     celix_tracked_entry_t *tracked = calloc(1, sizeof(*tracked));
     tracked->reference = ref;
     tracked->service = svc;
-    tracked->properties = props;
+    tracked->propertiesSnapshot = propertiesSnapshot;
     tracked->serviceOwner = bnd;
-    tracked->serviceName = celix_properties_get(props, OSGI_FRAMEWORK_OBJECTCLASS, "Error");
+    const char *serviceName = propertiesSnapshot == NULL ? NULL : celix_properties_get(propertiesSnapshot->properties, OSGI_FRAMEWORK_OBJECTCLASS, NULL);
+    tracked->serviceName = celix_stringPool_intern(serviceName == NULL ? "Error" : serviceName);
+    const celix_properties_t *props = propertiesSnapshot == NULL ? NULL : propertiesSnapshot->properties;
+    tracked->serviceId = celix_properties_getAsLong(props, OSGI_FRAMEWORK_SERVICE_ID, -1L);
+    tracked->serviceRanking = celix_properties_getAsLong(props, OSGI_FRAMEWORK_SERVICE_RANKING, 0L);
 
     tracked->useCount = 1;
     celixThreadMutex_create(&tracked->mutex, NULL);
@@ -92,19 +116,309 @@ static inline void tracked_release(celix_tracked_entry_t *tracked) {
     celixThreadMutex_unlock(&tracked->mutex);
 }
 
-static inline void tracked_waitAndDestroy(celix_tracked_entry_t *tracked) {
+static inline void tracked_wait(celix_tracked_entry_t *tracked) {
     celixThreadMutex_lock(&tracked->mutex);
     while (tracked->useCount != 0) {
         celixThreadCondition_wait(&tracked->useCond, &tracked->mutex);
     }
     celixThreadMutex_unlock(&tracked->mutex);
+}
 
-    //destroy
+static inline void tracked_destroy(celix_tracked_entry_t *tracked) {
+    serviceRegistration_releasePropertiesSnapshot(tracked->propertiesSnapshot);
+    celix_stringPool_release(tracked->serviceName);
     celixThreadMutex_destroy(&tracked->mutex);
     celixThreadCondition_destroy(&tracked->useCond);
     free(tracked);
 }
 
+static inline void tracked_waitAndDestroy(celix_tracked_entry_t *tracked) {
+    tracked_wait(tracked);
+    tracked_destroy(tracked);
+}
+
+/**
+ * Returns the current properties of the tracked entry.
+ * Should be called in a read section of the tracker, the properties are only guaranteed to be valid in that section.
+ */
+static inline const celix_properties_t* tracked_getProperties(celix_tracked_entry_t *tracked) {
+    celix_service_properties_snapshot_t *snapshot = __atomic_load_n(&tracked->propertiesSnapshot, __ATOMIC_SEQ_CST);
+    return snapshot == NULL ? NULL : snapshot->properties;
+}
+
+/**
+ * Leaves a read section (count) of the epoch parity idx and wakes up the waiting grace periods.
+ * Note a grace period increases g_graceWaiters before checking the readers, so either the grace period sees the
+ * decreased readers count or the reader sees the waiter. The tracker is not accessed after the decrease.
+ */
+static inline void serviceTracker_leaveReaders(celix_service_tracker_t *tracker, int idx) {
+    __atomic_sub_fetch(&tracker->readers[idx], 1, __ATOMIC_SEQ_CST);
+    if (__atomic_load_n(&g_graceWaiters, __ATOMIC_SEQ_CST) > 0) {
+        celixThreadMutex_lock(&g_graceMutex);
+        celixThreadCondition_broadcast(&g_graceCond);
+        celixThreadMutex_unlock(&g_graceMutex);
+    }
+}
+
+/**
+ * Enters a read section for the tracker. In a read section the tracker instance and instance snapshot can be used
+ * without locking, because they will only be free'd after a grace period in which all read sections are exited.
+ */
+static inline void serviceTracker_enterReadSection(celix_service_tracker_t *tracker, celix_tracker_read_frame_t *frame) {
+    for (;;) {
+        long epoch = __atomic_load_n(&tracker->epoch, __ATOMIC_SEQ_CST);
+        int idx = (int)(epoch & 1);
+        __atomic_add_fetch(&tracker->readers[idx], 1, __ATOMIC_SEQ_CST);
+        if (__atomic_load_n(&tracker->epoch, __ATOMIC_SEQ_CST) == epoch) {
+            frame->idx = idx;
+            break;
+        }
+        //epoch flipped in between, retry
+        serviceTracker_leaveReaders(tracker, idx);
+    }
+    frame->tracker = tracker;
+    frame->next = g_readFrames;
+    g_readFrames = frame;
+}
+
+static inline void serviceTracker_exitReadSection(celix_tracker_read_frame_t *frame) {
+    g_readFrames = frame->next;
+    serviceTracker_leaveReaders(frame->tracker, frame->idx);
+}
+
+/**
+ * Returns the current properties snapshot of the tracked entry, retained, so that it can be used outside a read
+ * section (e.g. in the add/modified/remove callbacks). Release with serviceRegistration_releasePropertiesSnapshot.
+ */
+static celix_service_properties_snapshot_t* tracked_acquireProperties(celix_service_tracker_t *tracker, celix_tracked_entry_t *tracked) {
+    celix_tracker_read_frame_t frame;
+    serviceTracker_enterReadSection(tracker, &frame);
+    celix_service_properties_snapshot_t *snapshot = __atomic_load_n(&tracked->propertiesSnapshot, __ATOMIC_SEQ_CST);
+    if (snapshot != NULL) {
+        serviceRegistration_retainPropertiesSnapshot(snapshot);
+    }
+    serviceTracker_exitReadSection(&frame);
+    return snapshot;
+}
+
+/**
+ * Returns the number of read sections of the current thread for the tracker and epoch parity (idx), idx -1 is any.
+ */
+static long serviceTracker_ownReadSections(celix_service_tracker_t *tracker, int idx) {
+    long count = 0;
+    for (celix_tracker_read_frame_t *frame = g_readFrames; frame != NULL; frame = frame->next) {
+        if (frame->tracker == tracker && (idx < 0 || frame->idx == idx)) {
+            count += 1;
+        }
+    }
+    return count;
+}
+
+/**
+ * Waits (if block is true) for a grace period: all read sections entered before this call are exited.
+ * The epoch is flipped twice, because a reader can still be in the read section of the epoch before the current one.
+ * Read sections of the current thread are not waited for, to prevent a deadlock when a tracked service is
+ * removed from a use callback.
+ *
+ * When the grace period has passed and the current thread has no read sections the retired snapshots and
+ * entries are free'd.
+ * Returns true if the grace period has passed.
+ */
+static bool serviceTracker_gracePeriod(celix_service_tracker_t *tracker, bool block) {
+    if (block) {
+        celixThreadMutex_lock(&tracker->syncLock);
+    } else if (celixThreadMutex_tryLock(&tracker->syncLock) != CELIX_SUCCESS) {
+        return false;
+    }
+
+    celixThreadMutex_lock(&tracker->retiredLock);
+    celix_array_list_t *retired = tracker->retiredSnapshots;
+    celix_array_list_t *retiredEntries = tracker->retiredEntries;
+    celix_array_list_t *retiredProperties = tracker->retiredProperties;
+    tracker->retiredSnapshots = celix_arrayList_create();
+    tracker->retiredEntries = celix_arrayList_create();
+    tracker->retiredProperties = celix_arrayList_create();
+    celixThreadMutex_unlock(&tracker->retiredLock);
+
+    bool passed = true;
+    for (int i = 0; passed && i < 2; ++i) {
+        long epoch = __atomic_fetch_add(&tracker->epoch, 1, __ATOMIC_SEQ_CST);
+        int idx = (int)(epoch & 1);
+        long own = serviceTracker_ownReadSections(tracker, idx);
+        if (__atomic_load_n(&tracker->readers[idx], __ATOMIC_SEQ_CST) > own) {
+            if (!block) {
+                passed = false;
+                break;
+            }
+            celixThreadMutex_lock(&g_graceMutex);
+            __atomic_add_fetch(&g_graceWaiters, 1, __ATOMIC_SEQ_CST);
+            while (__atomic_load_n(&tracker->readers[idx], __ATOMIC_SEQ_CST) > own) {
+                celixThreadCondition_wait(&g_graceCond, &g_graceMutex);
+            }
+            __atomic_sub_fetch(&g_graceWaiters, 1, __ATOMIC_SEQ_CST);
+            celixThreadMutex_unlock(&g_graceMutex);
+        }
+    }
+
+    if (passed && serviceTracker_ownReadSections(tracker, -1) == 0) {
+        for (int i = 0; i < celix_arrayList_size(retired); ++i) {
+            free(celix_arrayList_get(retired, i));
+        }
+        for (int i = 0; i < celix_arrayList_size(retiredEntries); ++i) {
+            tracked_destroy(celix_arrayList_get(retiredEntries, i));
+        }
+        for (int i = 0; i < celix_arrayList_size(retiredProperties); ++i) {
+            serviceRegistration_releasePropertiesSnapshot(celix_arrayList_get(retiredProperties, i));
+        }
+    } else {
+        celixThreadMutex_lock(&tracker->retiredLock);
+        for (int i = 0; i < celix_arrayList_size(retired); ++i) {
+            celix_arrayList_add(tracker->retiredSnapshots, celix_arrayList_get(retired, i));
+        }
+        for (int i = 0; i < celix_arrayList_size(retiredEntries); ++i) {
+            celix_arrayList_add(tracker->retiredEntries, celix_arrayList_get(retiredEntries, i));
+        }
+        for (int i = 0; i < celix_arrayList_size(retiredProperties); ++i) {
+            celix_arrayList_add(tracker->retiredProperties, celix_arrayList_get(retiredProperties, i));
+        }
+        celixThreadMutex_unlock(&tracker->retiredLock);
+    }
+    celix_arrayList_destroy(retired);
+    celix_arrayList_destroy(retiredEntries);
+    celix_arrayList_destroy(retiredProperties);
+
+    celixThreadMutex_unlock(&tracker->syncLock);
+    return passed;
+}
+
+/**
+ * Returns < 0 if a ranks before b, i.e. a has a higher ranking or has an equal ranking and a lower service id.
+ */
+static inline int tracked_compare(const celix_tracked_entry_t *a, const celix_tracked_entry_t *b) {
+    if (a->serviceRanking != b->serviceRanking) {
+        return a->serviceRanking > b->serviceRanking ? -1 : 1;
+    }
+    if (a->serviceId != b->serviceId) {
+        return a->serviceId < b->serviceId ? -1 : 1;
+    }
+    return 0;
+}
+
+/**
+ * Inserts the tracked entry in the ranking ordered trackedServices, using a binary search for the position.
+ * Should be called with the instance lock (write) taken.
+ */
+static void serviceTracker_insertTracked(celix_service_tracker_instance_t *instance, celix_tracked_entry_t *tracked) {
+    unsigned int low = 0;
+    unsigned int high = arrayList_size(instance->trackedServices);
+    while (low < high) {
+        unsigned int mid = low + (high - low) / 2;
+        celix_tracked_entry_t *visit = arrayList_get(instance->trackedServices, mid);
+        if (tracked_compare(visit, tracked) <= 0) {
+            low = mid + 1;
+        } else {
+            high = mid;
+        }
+    }
+    arrayList_addIndex(instance->trackedServices, low, tracked);
+}
+
+/**
+ * Publishes a new snapshot of the tracked services. The old snapshot is retired.
+ * Should be called with the instance lock (write) taken.
+ */
+static void serviceTracker_publishSnapshot(celix_service_tracker_instance_t *instance) {
+    size_t size = (size_t)celix_arrayList_size(instance->trackedServices);
+    celix_tracked_snapshot_t *snapshot = malloc(sizeof(*snapshot) + size * sizeof(snapshot->entries[0]));
+    snapshot->size = size;
+    for (int i = 0; i < size; ++i) {
+        snapshot->entries[i] = celix_arrayList_get(instance->trackedServices, i);
+    }
+    celix_tracked_snapshot_t *old = __atomic_exchange_n(&instance->snapshot, snapshot, __ATOMIC_SEQ_CST);
+    if (old != NULL) {
+        celixThreadMutex_lock(&instance->tracker->retiredLock);
+        celix_arrayList_add(instance->tracker->retiredSnapshots, old);
+        celixThreadMutex_unlock(&instance->tracker->retiredLock);
+    }
+
+    //wake up the threads waiting for a service
+    celixThreadMutex_lock(&instance->tracker->waitLock);
+    __atomic_add_fetch(&instance->tracker->snapshotGeneration, 1, __ATOMIC_SEQ_CST);
+    celixThreadCondition_broadcast(&instance->tracker->waitCond);
+    celixThreadMutex_unlock(&instance->tracker->waitLock);
+}
+
+/**
+ * Returns the CLOCK_MONOTONIC deadline for a timeout from now.
+ */
+static struct timespec serviceTracker_deadline(double timeoutInSeconds) {
+    struct timespec deadline = {0, 0};
+    long timeoutInNs = (long)(timeoutInSeconds * 1E9);
+    clock_gettime(CLOCK_MONOTONIC, &deadline);
+    deadline.tv_sec += timeoutInNs / 1000000000L;
+    deadline.tv_nsec += timeoutInNs % 1000000000L;
+    if (deadline.tv_nsec >= 1000000000L) {
+        deadline.tv_sec += 1;
+        deadline.tv_nsec -= 1000000000L;
+    }
+    return deadline;
+}
+
+/**
+ * Waits till a snapshot newer than the provided generation is published or the deadline (CLOCK_MONOTONIC) passed.
+ * Returns false if the deadline passed.
+ */
+static bool serviceTracker_waitForSnapshot(celix_service_tracker_t *tracker, long generation, const struct timespec *deadline) {
+    bool inTime = true;
+    celixThreadMutex_lock(&tracker->waitLock);
+    while (inTime && __atomic_load_n(&tracker->snapshotGeneration, __ATOMIC_SEQ_CST) == generation) {
+        struct timespec now;
+        clock_gettime(CLOCK_MONOTONIC, &now);
+        long remainingInNs = (deadline->tv_sec - now.tv_sec) * 1000000000L + (deadline->tv_nsec - now.tv_nsec);
+        if (remainingInNs <= 0) {
+            inTime = false;
+        } else {
+            celixThreadCondition_timedwaitRelative(&tracker->waitCond, &tracker->waitLock, remainingInNs / 1000000000L, remainingInNs % 1000000000L);
+        }
+    }
+    celixThreadMutex_unlock(&tracker->waitLock);
+    return inTime;
+}
+
+size_t serviceTracker_getMemoryUsage(celix_service_tracker_t *tracker) {
+    size_t bytes = sizeof(*tracker) + (tracker->filter == NULL ? 0 : strlen(tracker->filter) + 1);
+    celixThreadRwlock_readLock(&tracker->instanceLock);
+    celix_service_tracker_instance_t *instance = tracker->instance;
+    if (instance != NULL) {
+        bytes += sizeof(*instance) + (instance->filter == NULL ? 0 : strlen(instance->filter) + 1);
+        celixThreadRwlock_readLock(&instance->lock);
+        size_t size = (size_t)arrayList_size(instance->trackedServices);
+        bytes += sizeof(celix_tracked_snapshot_t) + size * sizeof(celix_tracked_entry_t*); //published snapshot
+        for (int i = 0; i < size; ++i) {
+            celix_tracked_entry_t *tracked = arrayList_get(instance->trackedServices, i);
+            bytes += sizeof(*tracked) + sizeof(tracked) + strlen(tracked->serviceName) + 1;
+        }
+        celixThreadRwlock_unlock(&instance->lock);
+    }
+    celixThreadRwlock_unlock(&tracker->instanceLock);
+    return bytes;
+}
+
+static void serviceTracker_initReadSections(celix_service_tracker_t *tracker) {
+    celixThread_once(&g_once, serviceTracker_once); //for g_graceMutex and g_graceCond
+    tracker->epoch = 0;
+    tracker->readers[0] = 0;
+    tracker->readers[1] = 0;
+    celixThreadMutex_create(&tracker->syncLock, NULL);
+    celixThreadMutex_create(&tracker->retiredLock, NULL);
+    tracker->retiredSnapshots = celix_arrayList_create();
+    tracker->retiredEntries = celix_arrayList_create();
+    tracker->retiredProperties = celix_arrayList_create();
+    celixThreadMutex_create(&tracker->waitLock, NULL);
+    celixThreadCondition_init(&tracker->waitCond, NULL);
+    tracker->snapshotGeneration = 0;
+}
+
 celix_status_t serviceTracker_create(bundle_context_pt context, const char * service, service_tracker_customizer_pt customizer, service_tracker_pt *tracker) {
 	celix_status_t status = CELIX_SUCCESS;
 
@@ -132,6 +446,7 @@ celix_status_t serviceTracker_createWithFilter(bundle_context_pt context, const
 		(*tracker)->context = context;
 		(*tracker)->filter = strdup(filter);
         (*tracker)->customizer = customizer;
+        serviceTracker_initReadSections(*tracker);
 	}
 
 	framework_logIfError(logger, status, NULL, "Cannot create service tracker [filter=%s]", filter);
@@ -144,6 +459,24 @@ celix_status_t serviceTracker_destroy(service_tracker_pt tracker) {
 	    serviceTrackerCustomizer_destroy(tracker->customizer);
 	}
 
+	//note tracker is closed, so no read sections are active anymore
+	for (int i = 0; i < celix_arrayList_size(tracker->retiredSnapshots); ++i) {
+		free(celix_arrayList_get(tracker->retiredSnapshots, i));
+	}
+	celix_arrayList_destroy(tracker->retiredSnapshots);
+	for (int i = 0; i < celix_arrayList_size(tracker->retiredEntries); ++i) {
+		tracked_destroy(celix_arrayList_get(tracker->retiredEntries, i));
+	}
+	celix_arrayList_destroy(tracker->retiredEntries);
+	for (int i = 0; i < celix_arrayList_size(tracker->retiredProperties); ++i) {
+		serviceRegistration_releasePropertiesSnapshot(celix_arrayList_get(tracker->retiredProperties, i));
+	}
+	celix_arrayList_destroy(tracker->retiredProperties);
+	celixThreadMutex_destroy(&tracker->syncLock);
+	celixThreadMutex_destroy(&tracker->retiredLock);
+	celixThreadMutex_destroy(&tracker->waitLock);
+	celixThreadCondition_destroy(&tracker->waitCond);
+
 	free(tracker->filter);
 	free(tracker);
 
@@ -159,6 +492,7 @@ celix_status_t serviceTracker_open(service_tracker_pt tracker) {
     celixThreadRwlock_writeLock(&tracker->instanceLock);
     if (tracker->instance == NULL) {
         instance = calloc(1, sizeof(*instance));
+        instance->tracker = tracker;
         instance->context = tracker->context;
 
         instance->closing = false;
@@ -167,8 +501,9 @@ celix_status_t serviceTracker_open(service_tracker_pt tracker) {
         celixThreadCondition_init(&instance->activeServiceChangeCallsCond, NULL);
 
 
-        celixThreadRwlock_create(&instance->lock, NULL);
+        celixThreadRwlock_createNamed(&instance->lock, NULL, "service tracker");
         instance->trackedServices = celix_arrayList_create();
+        serviceTracker_publishSnapshot(instance);
 
         celixThreadMutex_create(&instance->mutex, NULL);
         instance->currentHighestServiceId = -1;
@@ -194,7 +529,7 @@ celix_status_t serviceTracker_open(service_tracker_pt tracker) {
 
         status = bundleContext_getServiceReferences(tracker->context, NULL, tracker->filter, &initial); //REF COUNT to 1
 
-        tracker->instance = instance;
+        __atomic_store_n(&tracker->instance, instance, __ATOMIC_SEQ_CST);
     } else {
         //already open
     }
@@ -209,7 +544,9 @@ celix_status_t serviceTracker_open(service_tracker_pt tracker) {
         unsigned int i;
         for (i = 0; i < arrayList_size(initial); i++) {
             initial_reference = (service_reference_pt) arrayList_get(initial, i);
-            serviceTracker_track(instance, initial_reference, NULL); //REF COUNT to 2
+            if (serviceTracker_isInVersionRange(tracker, initial_reference)) {
+                serviceTracker_track(instance, initial_reference, NULL); //REF COUNT to 2
+            }
             bundleContext_ungetServiceReference(tracker->context, initial_reference); //REF COUNT to 1
         }
         arrayList_destroy(initial);
@@ -224,7 +561,7 @@ celix_status_t serviceTracker_open(service_tracker_pt tracker) {
 	return status;
 }
 
-static void* shutdownServiceTrackerInstanceHandler(void *data) {
+static void shutdownServiceTrackerInstanceHandler(void *data) {
     celix_service_tracker_instance_t *instance = data;
 
     fw_removeServiceListener(instance->context->framework, instance->context->bundle, &instance->listener);
@@ -234,12 +571,11 @@ static void* shutdownServiceTrackerInstanceHandler(void *data) {
     celixThreadMutex_destroy(&instance->mutex);
     celixThreadRwlock_destroy(&instance->lock);
     celix_arrayList_destroy(instance->trackedServices);
+    free(instance->snapshot);
     free(instance->filter);
 
     serviceTracker_remInstanceFromShutdownList(instance);
     free(instance);
-
-    return NULL;
 }
 
 celix_status_t serviceTracker_close(service_tracker_pt tracker) {
@@ -248,7 +584,7 @@ celix_status_t serviceTracker_close(service_tracker_pt tracker) {
 
     celixThreadRwlock_writeLock(&tracker->instanceLock);
     celix_service_tracker_instance_t *instance = tracker->instance;
-    tracker->instance = NULL;
+    __atomic_store_n(&tracker->instance, NULL, __ATOMIC_SEQ_CST);
     celixThreadRwlock_unlock(&tracker->instanceLock);
 
     if (instance != NULL) {
@@ -264,10 +600,15 @@ celix_status_t serviceTracker_close(service_tracker_pt tracker) {
         celix_tracked_entry_t *trackedEntries[size];
         for (i = 0; i < arrayList_size(instance->trackedServices); i++) {
             trackedEntries[i] = (celix_tracked_entry_t *) arrayList_get(instance->trackedServices, i);
+            __atomic_store_n(&trackedEntries[i]->removed, true, __ATOMIC_SEQ_CST);
         }
         arrayList_clear(instance->trackedServices);
+        serviceTracker_publishSnapshot(instance);
         celixThreadRwlock_unlock(&instance->lock);
 
+        //wait till the (lock free) use calls are done with the instance and tracked entries
+        serviceTracker_gracePeriod(tracker, true);
+
         //loop trough tracked entries an untrack
         for (i = 0; i < size; i++) {
             serviceTracker_untrackTracked(instance, trackedEntries[i]);
@@ -282,16 +623,15 @@ celix_status_t serviceTracker_close(service_tracker_pt tracker) {
 
 
 
-        //NOTE Separate thread is needed to prevent deadlock where closing is triggered from a serviceChange event and the
+        //NOTE Another thread is needed to prevent deadlock where closing is triggered from a serviceChange event and the
         // untrack -> removeServiceListener will try to remove a service listener which is being invoked and is the
         // actual thread calling the removeServiceListener.
         //
-        // This can be detached -> because service listener events are ignored (closing=true) and so no callbacks
-        //are made back to the celix framework / tracker owner.
+        // The listener removal is deferred to the (single) tracker reaper thread of the framework. This is safe,
+        // because service listener events are ignored (closing=true) and so no callbacks are made back to the celix
+        // framework / tracker owner. The sync functions wait till the instance is removed from the shutdown list.
         serviceTracker_addInstanceFromShutdownList(instance);
-        celix_thread_t localThread;
-        celixThread_create(&localThread, NULL, shutdownServiceTrackerInstanceHandler, instance);
-        celixThread_detach(localThread);
+        fw_deferTrackerCleanup(instance->context->framework, shutdownServiceTrackerInstanceHandler, instance);
     }
 
 	return CELIX_SUCCESS;
@@ -424,16 +764,24 @@ void serviceTracker_serviceChanged(celix_service_listener_t *listener, celix_ser
     if (!closing) {
         switch (event->type) {
             case OSGI_FRAMEWORK_SERVICE_EVENT_REGISTERED:
-                serviceTracker_track(instance, event->reference, event);
+                if (serviceTracker_isInVersionRange(instance->tracker, event->reference)) {
+                    serviceTracker_track(instance, event->reference, event);
+                }
                 break;
             case OSGI_FRAMEWORK_SERVICE_EVENT_MODIFIED:
-                serviceTracker_track(instance, event->reference, event);
+                if (serviceTracker_isInVersionRange(instance->tracker, event->reference)) {
+                    serviceTracker_track(instance, event->reference, event);
+                } else {
+                    //service.version modified to a version outside the range
+                    serviceTracker_untrack(instance, event->reference, event);
+                }
                 break;
             case OSGI_FRAMEWORK_SERVICE_EVENT_UNREGISTERING:
                 serviceTracker_untrack(instance, event->reference, event);
                 break;
             case OSGI_FRAMEWORK_SERVICE_EVENT_MODIFIED_ENDMATCH:
-                //TODO
+                //the modified service does not match the tracker filter anymore
+                serviceTracker_untrack(instance, event->reference, event);
                 break;
         }
         celixThreadMutex_lock(&instance->closingLock);
@@ -446,6 +794,35 @@ void serviceTracker_serviceChanged(celix_service_listener_t *listener, celix_ser
     }
 }
 
+/**
+ * Returns true if the key is changed according to the (MODIFIED) event, or if the changed keys are not known.
+ */
+static bool serviceTracker_isKeyChanged(const celix_service_event_t *event, const char *key) {
+    if (event == NULL || event->changedKeys == NULL) {
+        return true;
+    }
+    for (int i = 0; i < celix_arrayList_size(event->changedKeys); ++i) {
+        if (strcmp(celix_arrayList_get(event->changedKeys, i), key) == 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * Matches the service.version of the reference against the pre-parsed version range of the tracker.
+ * Services without (or with an invalid) service.version never match a version range.
+ */
+static bool serviceTracker_isInVersionRange(service_tracker_pt tracker, service_reference_pt reference) {
+    if (!tracker->hasVersionRange) {
+        return true;
+    }
+    const char *version = NULL;
+    celix_version_key_t key = 0;
+    serviceReference_getProperty(reference, CELIX_FRAMEWORK_SERVICE_VERSION, &version);
+    return version != NULL && celix_version_parseKey(version, &key) && celix_versionRangeKey_isInRange(&tracker->versionRange, key);
+}
+
 static celix_status_t serviceTracker_track(celix_service_tracker_instance_t *instance, service_reference_pt reference, celix_service_event_t *event) {
 	celix_status_t status = CELIX_SUCCESS;
 
@@ -468,8 +845,42 @@ static celix_status_t serviceTracker_track(celix_service_tracker_instance_t *ins
     celixThreadRwlock_unlock(&instance->lock);
 
     if (found != NULL) {
+        //MODIFIED, replace the properties snapshot of the tracked entry with the current one of the registration
+        service_registration_t *reg = NULL;
+        serviceReference_getServiceRegistration(reference, &reg);
+        celix_service_properties_snapshot_t *current = reg != NULL ? serviceRegistration_getPropertiesSnapshot(reg) : NULL;
+        celix_service_properties_snapshot_t *old = __atomic_exchange_n(&found->propertiesSnapshot, current, __ATOMIC_SEQ_CST);
+        if (old != NULL) {
+            //note can still be used in a read section
+            celixThreadMutex_lock(&instance->tracker->retiredLock);
+            celix_arrayList_add(instance->tracker->retiredProperties, old);
+            celixThreadMutex_unlock(&instance->tracker->retiredLock);
+        }
         status = serviceTracker_invokeModifiedService(instance, found);
-        tracked_retain(found);
+
+        //a modified ranking changes the order of the tracked services and possibly the highest ranking service
+        bool rankingChanged = false;
+        if (serviceTracker_isKeyChanged(event, OSGI_FRAMEWORK_SERVICE_RANKING)) {
+            long ranking = celix_properties_getAsLong(current == NULL ? NULL : current->properties, OSGI_FRAMEWORK_SERVICE_RANKING, 0L);
+            celixThreadRwlock_writeLock(&instance->lock);
+            if (ranking != found->serviceRanking) {
+                int index = arrayList_indexOf(instance->trackedServices, found);
+                if (index >= 0) {
+                    arrayList_remove(instance->trackedServices, index);
+                    found->serviceRanking = ranking;
+                    serviceTracker_insertTracked(instance, found);
+                    serviceTracker_publishSnapshot(instance);
+                    rankingChanged = true;
+                }
+            }
+            celixThreadRwlock_unlock(&instance->lock);
+        }
+        if (rankingChanged) {
+            serviceTracker_updateHighestRankingService(instance, found->serviceName);
+        }
+        tracked_release(found);
+        bundleContext_ungetServiceReference(instance->context, reference); //already retained by the tracked entry
+        serviceTracker_gracePeriod(instance->tracker, false);
     } else if (status == CELIX_SUCCESS && found == NULL) {
         //NEW entry
         void *service = NULL;
@@ -478,23 +889,27 @@ static celix_status_t serviceTracker_track(celix_service_tracker_instance_t *ins
             assert(reference != NULL);
 
             service_registration_t *reg = NULL;
-            properties_t *props = NULL;
+            celix_service_properties_snapshot_t *props = NULL;
             bundle_t *bnd = NULL;
 
             serviceReference_getBundle(reference, &bnd);
             serviceReference_getServiceRegistration(reference, &reg);
             if (reg != NULL) {
-                serviceRegistration_getProperties(reg, &props);
+                props = serviceRegistration_getPropertiesSnapshot(reg);
             }
 
             celix_tracked_entry_t *tracked = tracked_create(reference, service, props, bnd);
 
             celixThreadRwlock_writeLock(&instance->lock);
-            arrayList_add(instance->trackedServices, tracked);
+            serviceTracker_insertTracked(instance, tracked);
+            serviceTracker_publishSnapshot(instance);
             celixThreadRwlock_unlock(&instance->lock);
 
+            //try to free retired snapshots, but do not wait for read sections (can be the cause of this call)
+            serviceTracker_gracePeriod(instance->tracker, false);
+
             serviceTracker_invokeAddService(instance, tracked);
-            serviceTracker_useHighestRankingServiceInternal(instance, tracked->serviceName, 0, instance, NULL, NULL, serviceTracker_checkAndInvokeSetService);
+            serviceTracker_updateHighestRankingService(instance, tracked->serviceName);
         }
     }
 
@@ -522,7 +937,9 @@ static void serviceTracker_checkAndInvokeSetService(void *handle, void *highestS
         }
         celixThreadMutex_unlock(&instance->mutex);
     }
-    if (update) {
+    if (update && (instance->set != NULL || instance->setWithProperties != NULL || instance->setWithOwner != NULL)) {
+        struct timespec start;
+        clock_gettime(CLOCK_MONOTONIC, &start);
         void *h = instance->callbackHandle;
         if (instance->set != NULL) {
             instance->set(h, highestSvc);
@@ -533,6 +950,7 @@ static void serviceTracker_checkAndInvokeSetService(void *handle, void *highestS
         if (instance->setWithOwner != NULL) {
             instance->setWithOwner(h, highestSvc, props, bnd);
         }
+        fw_recordTrackerCallback(instance->context->framework, &start);
     }
 }
 
@@ -541,6 +959,8 @@ static celix_status_t serviceTracker_invokeModifiedService(celix_service_tracker
 
     void *customizerHandle = NULL;
     modified_callback_pt function = NULL;
+    struct timespec start;
+    clock_gettime(CLOCK_MONOTONIC, &start);
     serviceTrackerCustomizer_getHandle(&instance->customizer, &customizerHandle);
     serviceTrackerCustomizer_getModifiedFunction(&instance->customizer, &function);
     if (function != NULL) {
@@ -551,12 +971,18 @@ static celix_status_t serviceTracker_invokeModifiedService(celix_service_tracker
     if (instance->modified != NULL) {
         instance->modified(handle, tracked->service);
     }
-    if (instance->modifiedWithProperties != NULL) {
-        instance->modifiedWithProperties(handle, tracked->service, tracked->properties);
-    }
-    if (instance->modifiedWithOwner != NULL) {
-        instance->modifiedWithOwner(handle, tracked->service, tracked->properties, tracked->serviceOwner);
+    if (instance->modifiedWithProperties != NULL || instance->modifiedWithOwner != NULL) {
+        celix_service_properties_snapshot_t *snapshot = tracked_acquireProperties(instance->tracker, tracked);
+        const celix_properties_t *props = snapshot == NULL ? NULL : snapshot->properties;
+        if (instance->modifiedWithProperties != NULL) {
+            instance->modifiedWithProperties(handle, tracked->service, props);
+        }
+        if (instance->modifiedWithOwner != NULL) {
+            instance->modifiedWithOwner(handle, tracked->service, props, tracked->serviceOwner);
+        }
+        serviceRegistration_releasePropertiesSnapshot(snapshot);
     }
+    fw_recordTrackerCallback(instance->context->framework, &start);
     return status;
 }
 
@@ -566,6 +992,9 @@ static celix_status_t serviceTracker_invokeAddService(celix_service_tracker_inst
 
     void *customizerHandle = NULL;
     added_callback_pt function = NULL;
+    struct timespec start;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    CELIX_PROBE2(tracker_add, instance->filter, tracked->serviceId);
 
     serviceTrackerCustomizer_getHandle(&instance->customizer, &customizerHandle);
     serviceTrackerCustomizer_getAddedFunction(&instance->customizer, &function);
@@ -577,12 +1006,18 @@ static celix_status_t serviceTracker_invokeAddService(celix_service_tracker_inst
     if (instance->add != NULL) {
         instance->add(handle, tracked->service);
     }
-    if (instance->addWithProperties != NULL) {
-        instance->addWithProperties(handle, tracked->service, tracked->properties);
-    }
-    if (instance->addWithOwner != NULL) {
-        instance->addWithOwner(handle, tracked->service, tracked->properties, tracked->serviceOwner);
+    if (instance->addWithProperties != NULL || instance->addWithOwner != NULL) {
+        celix_service_properties_snapshot_t *snapshot = tracked_acquireProperties(instance->tracker, tracked);
+        const celix_properties_t *props = snapshot == NULL ? NULL : snapshot->properties;
+        if (instance->addWithProperties != NULL) {
+            instance->addWithProperties(handle, tracked->service, props);
+        }
+        if (instance->addWithOwner != NULL) {
+            instance->addWithOwner(handle, tracked->service, props, tracked->serviceOwner);
+        }
+        serviceRegistration_releasePropertiesSnapshot(snapshot);
     }
+    fw_recordTrackerCallback(instance->context->framework, &start);
     return status;
 }
 
@@ -627,6 +1062,8 @@ static celix_status_t serviceTracker_untrack(celix_service_tracker_instance_t* i
             remove = tracked;
             //remove from trackedServices to prevent getting this service, but don't destroy yet, can be in use
             arrayList_remove(instance->trackedServices, i);
+            __atomic_store_n(&remove->removed, true, __ATOMIC_SEQ_CST);
+            serviceTracker_publishSnapshot(instance);
             break;
         }
     }
@@ -636,9 +1073,13 @@ static celix_status_t serviceTracker_untrack(celix_service_tracker_instance_t* i
     if (size == 0) {
         serviceTracker_checkAndInvokeSetService(instance, NULL, NULL, NULL);
     } else {
-        serviceTracker_useHighestRankingServiceInternal(instance, serviceName, 0, instance, NULL, NULL, serviceTracker_checkAndInvokeSetService);
+        serviceTracker_updateHighestRankingService(instance, serviceName);
     }
 
+    if (remove != NULL) {
+        //wait till the removed entry is not used anymore by the lock free use calls
+        serviceTracker_gracePeriod(instance->tracker, true);
+    }
     serviceTracker_untrackTracked(instance, remove);
 
     framework_logIfError(logger, status, NULL, "Cannot untrack reference");
@@ -653,7 +1094,15 @@ static void serviceTracker_untrackTracked(celix_service_tracker_instance_t *inst
         tracked_release(tracked);
 
         //Wait till the useCount is 0, because the untrack should only return if the service is not used anymore.
-        tracked_waitAndDestroy(tracked);
+        if (serviceTracker_ownReadSections(instance->tracker, -1) > 0) {
+            //untracked from a use call, the entry can still be referenced by the snapshot used in that call.
+            tracked_wait(tracked);
+            celixThreadMutex_lock(&instance->tracker->retiredLock);
+            celix_arrayList_add(instance->tracker->retiredEntries, tracked);
+            celixThreadMutex_unlock(&instance->tracker->retiredLock);
+        } else {
+            tracked_waitAndDestroy(tracked);
+        }
     }
 }
 
@@ -663,6 +1112,9 @@ static celix_status_t serviceTracker_invokeRemovingService(celix_service_tracker
 
     void *customizerHandle = NULL;
     removed_callback_pt function = NULL;
+    struct timespec start;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    CELIX_PROBE2(tracker_remove, instance->filter, tracked->serviceId);
 
     serviceTrackerCustomizer_getHandle(&instance->customizer, &customizerHandle);
     serviceTrackerCustomizer_getRemovedFunction(&instance->customizer, &function);
@@ -675,12 +1127,18 @@ static celix_status_t serviceTracker_invokeRemovingService(celix_service_tracker
     if (instance->remove != NULL) {
         instance->remove(handle, tracked->service);
     }
-    if (instance->addWithProperties != NULL) {
-        instance->removeWithProperties(handle, tracked->service, tracked->properties);
-    }
-    if (instance->removeWithOwner != NULL) {
-        instance->removeWithOwner(handle, tracked->service, tracked->properties, tracked->serviceOwner);
+    if (instance->removeWithProperties != NULL || instance->removeWithOwner != NULL) {
+        celix_service_properties_snapshot_t *snapshot = tracked_acquireProperties(instance->tracker, tracked);
+        const celix_properties_t *props = snapshot == NULL ? NULL : snapshot->properties;
+        if (instance->removeWithProperties != NULL) {
+            instance->removeWithProperties(handle, tracked->service, props);
+        }
+        if (instance->removeWithOwner != NULL) {
+            instance->removeWithOwner(handle, tracked->service, props, tracked->serviceOwner);
+        }
+        serviceRegistration_releasePropertiesSnapshot(snapshot);
     }
+    fw_recordTrackerCallback(instance->context->framework, &start);
 
     if (status == CELIX_SUCCESS) {
         status = bundleContext_ungetService(instance->context, tracked->reference, &ungetSuccess);
@@ -737,6 +1195,7 @@ celix_service_tracker_t* celix_serviceTracker_createWithOptions(
             tracker->removeWithOwner = opts->removeWithOwner;
 
             celixThreadRwlock_create(&tracker->instanceLock, NULL);
+            serviceTracker_initReadSections(tracker);
 
             //setting lang
             const char *lang = opts->filter.serviceLanguage;
@@ -744,27 +1203,28 @@ celix_service_tracker_t* celix_serviceTracker_createWithOptions(
                 lang = CELIX_FRAMEWORK_SERVICE_C_LANGUAGE;
             }
 
+            //setting version range, matched on the service.version of a service during tracking.
+            if (opts->filter.versionRange != NULL) {
+                tracker->hasVersionRange = true;
+                if (!celix_versionRange_parseKey(opts->filter.versionRange, &tracker->versionRange)) {
+                    framework_log(logger, OSGI_FRAMEWORK_LOG_ERROR, __FUNCTION__, __BASE_FILE__, __LINE__,
+                                  "Invalid version range '%s', no services will be tracked.", opts->filter.versionRange);
+                    //empty range: low > high
+                    tracker->versionRange.low = 1;
+                    tracker->versionRange.high = 0;
+                    tracker->versionRange.isHighInfinite = false;
+                }
+            }
+
             //setting filter
             if (opts->filter.ignoreServiceLanguage) {
-                if (opts->filter.filter != NULL && opts->filter.versionRange != NULL) {
-                    //TODO version range
-                    asprintf(&tracker->filter, "&((%s=%s)%s)", OSGI_FRAMEWORK_OBJECTCLASS, opts->filter.serviceName, opts->filter.filter);
-                } else if (opts->filter.versionRange != NULL) {
-                    //TODO version range
-                    asprintf(&tracker->filter, "&((%s=%s))", OSGI_FRAMEWORK_OBJECTCLASS, opts->filter.serviceName);
-                } else if (opts->filter.filter != NULL) {
+                if (opts->filter.filter != NULL) {
                     asprintf(&tracker->filter, "(&(%s=%s)%s)", OSGI_FRAMEWORK_OBJECTCLASS, opts->filter.serviceName, opts->filter.filter);
                 } else {
                     asprintf(&tracker->filter, "(&(%s=%s))", OSGI_FRAMEWORK_OBJECTCLASS, opts->filter.serviceName);
                 }
             } else {
-                if (opts->filter.filter != NULL && opts->filter.versionRange != NULL) {
-                    //TODO version range
-                    asprintf(&tracker->filter, "&((%s=%s)(%s=%s)%s)", OSGI_FRAMEWORK_OBJECTCLASS, opts->filter.serviceName, CELIX_FRAMEWORK_SERVICE_LANGUAGE, lang, opts->filter.filter);
-                } else if (opts->filter.versionRange != NULL) {
-                    //TODO version range
-                    asprintf(&tracker->filter, "&((%s=%s)(%s=%s))", OSGI_FRAMEWORK_OBJECTCLASS, opts->filter.serviceName, CELIX_FRAMEWORK_SERVICE_LANGUAGE, lang);
-                } else if (opts->filter.filter != NULL) {
+                if (opts->filter.filter != NULL) {
                     asprintf(&tracker->filter, "(&(%s=%s)(%s=%s)%s)", OSGI_FRAMEWORK_OBJECTCLASS, opts->filter.serviceName, CELIX_FRAMEWORK_SERVICE_LANGUAGE, lang, opts->filter.filter);
                 } else {
                     asprintf(&tracker->filter, "(&(%s=%s)(%s=%s))", OSGI_FRAMEWORK_OBJECTCLASS, opts->filter.serviceName, CELIX_FRAMEWORK_SERVICE_LANGUAGE, lang);
@@ -792,9 +1252,12 @@ void celix_serviceTracker_destroy(celix_service_tracker_t *tracker) {
     }
 }
 
+/**
+ * Uses the highest ranking service of the instance snapshot.
+ * Should be called in a read section of the instance tracker.
+ */
 static bool serviceTracker_useHighestRankingServiceInternal(celix_service_tracker_instance_t *instance,
                                                             const char *serviceName /*sanity*/,
-                                                            double waitForSvcTimeoutInSec /*0 -> do not wait */,
                                                             void *callbackHandle,
                                                             void (*use)(void *handle, void *svc),
                                                             void (*useWithProperties)(void *handle, void *svc, const celix_properties_t *props),
@@ -802,71 +1265,43 @@ static bool serviceTracker_useHighestRankingServiceInternal(celix_service_tracke
     bool called = false;
     celix_tracked_entry_t *tracked = NULL;
     celix_tracked_entry_t *highest = NULL;
-    long highestRank = 0;
-    unsigned int i;
-
-    //first lock tracker and get highest tracked entry
-    celixThreadRwlock_readLock(&instance->lock);
-    unsigned int size = arrayList_size(instance->trackedServices);
-
-    if (waitForSvcTimeoutInSec > 0) {
-        struct timespec start;
-        struct timespec now;
-        clock_gettime(CLOCK_MONOTONIC, &start);
-
-        double billion = 1E9;
-        long waitFor = (long)(waitForSvcTimeoutInSec * billion);
-        long diffInNs = 0L;
-
-        while (size == 0 && diffInNs < waitFor) {
-            size = arrayList_size(instance->trackedServices);
-            if (size > 0) {
-                break;
-            } else {
-                celixThreadRwlock_unlock(&instance->lock);
-                usleep(1);
-                celixThreadRwlock_readLock(&instance->lock);
-            };
-            clock_gettime(CLOCK_MONOTONIC, &now);
-            diffInNs = ( now.tv_nsec - start.tv_nsec ) + ( now.tv_sec - start.tv_sec ) * (long)billion;
+    size_t i;
+
+    //note the snapshot is ordered on ranking, so the first matching entry is the highest ranking service
+    celix_tracked_snapshot_t *snapshot = __atomic_load_n(&instance->snapshot, __ATOMIC_SEQ_CST);
+    for (i = 0; i < snapshot->size; i++) {
+        tracked = snapshot->entries[i];
+        if (__atomic_load_n(&tracked->removed, __ATOMIC_SEQ_CST)) {
+            continue;
         }
-    }
-
-    for (i = 0; i < size; i++) {
-        tracked = (celix_tracked_entry_t *) arrayList_get(instance->trackedServices, i);
-        if (serviceName != NULL && tracked->serviceName != NULL && strncmp(tracked->serviceName, serviceName, 10*1024) == 0) {
-            const char *val = properties_getWithDefault(tracked->properties, OSGI_FRAMEWORK_SERVICE_RANKING, "0");
-            long rank = strtol(val, NULL, 10);
-            if (highest == NULL || rank > highestRank) {
-                highest = tracked;
-            }
+        if (serviceName != NULL && tracked->serviceName != NULL && (tracked->serviceName == serviceName || strncmp(tracked->serviceName, serviceName, 10*1024) == 0)) {
+            highest = tracked;
+            break;
         }
     }
-    if (highest != NULL) {
-        //highest found lock tracked entry and increase use count
-        tracked_retain(highest);
-    }
-    //unlock tracker so that the tracked entry can be removed from the trackedServices list if unregistered.
-    celixThreadRwlock_unlock(&instance->lock);
 
     if (highest != NULL) {
-        //got service, call, decrease use count an signal useCond after.
         if (use != NULL) {
             use(callbackHandle, highest->service);
         }
         if (useWithProperties != NULL) {
-            useWithProperties(callbackHandle, highest->service, highest->properties);
+            useWithProperties(callbackHandle, highest->service, tracked_getProperties(highest));
         }
         if (useWithOwner != NULL) {
-            useWithOwner(callbackHandle, highest->service, highest->properties, highest->serviceOwner);
+            useWithOwner(callbackHandle, highest->service, tracked_getProperties(highest), highest->serviceOwner);
         }
         called = true;
-        tracked_release(highest);
     }
 
     return called;
 }
 
+static void serviceTracker_updateHighestRankingService(celix_service_tracker_instance_t *instance, const char *serviceName) {
+    celix_tracker_read_frame_t frame;
+    serviceTracker_enterReadSection(instance->tracker, &frame);
+    serviceTracker_useHighestRankingServiceInternal(instance, serviceName, instance, NULL, NULL, serviceTracker_checkAndInvokeSetService);
+    serviceTracker_exitReadSection(&frame);
+}
 
 bool celix_serviceTracker_useHighestRankingService(
         celix_service_tracker_t *tracker,
@@ -876,17 +1311,66 @@ bool celix_serviceTracker_useHighestRankingService(
         void (*use)(void *handle, void *svc),
         void (*useWithProperties)(void *handle, void *svc, const celix_properties_t *props),
         void (*useWithOwner)(void *handle, void *svc, const celix_properties_t *props, const celix_bundle_t *owner)) {
-    celixThreadRwlock_readLock(&tracker->instanceLock);
-    celix_service_tracker_instance_t *instance = tracker->instance;
     bool called = false;
-    if (instance != NULL) {
-        called = serviceTracker_useHighestRankingServiceInternal(instance, serviceName, waitTimeoutInSeconds, callbackHandle, use,
-                                                                 useWithProperties, useWithOwner);
+    celix_tracker_read_frame_t frame;
+    bool mayWait = waitTimeoutInSeconds > 0;
+    struct timespec deadline = mayWait ? serviceTracker_deadline(waitTimeoutInSeconds) : (struct timespec){0, 0};
+
+    for (;;) {
+        bool wait = false;
+        //note read the generation before the snapshot, so that a snapshot published in between is not missed
+        long generation = __atomic_load_n(&tracker->snapshotGeneration, __ATOMIC_SEQ_CST);
+        serviceTracker_enterReadSection(tracker, &frame);
+        celix_service_tracker_instance_t *instance = __atomic_load_n(&tracker->instance, __ATOMIC_SEQ_CST);
+        if (instance != NULL) {
+            celix_tracked_snapshot_t *snapshot = __atomic_load_n(&instance->snapshot, __ATOMIC_SEQ_CST);
+            if (snapshot->size == 0 && mayWait) {
+                wait = true;
+            } else {
+                called = serviceTracker_useHighestRankingServiceInternal(instance, serviceName, callbackHandle, use,
+                                                                         useWithProperties, useWithOwner);
+            }
+        }
+        //note exit read section before waiting, so that the tracker can be updated
+        serviceTracker_exitReadSection(&frame);
+
+        if (!wait) {
+            break;
+        }
+        //note after the deadline, the snapshot is checked a last time
+        mayWait = serviceTracker_waitForSnapshot(tracker, generation, &deadline);
     }
-    celixThreadRwlock_unlock(&tracker->instanceLock);
     return called;
 }
 
+bool celix_serviceTracker_hasService(celix_service_tracker_t *tracker) {
+    bool found = false;
+    celix_tracker_read_frame_t frame;
+    serviceTracker_enterReadSection(tracker, &frame);
+    celix_service_tracker_instance_t *instance = __atomic_load_n(&tracker->instance, __ATOMIC_SEQ_CST);
+    if (instance != NULL) {
+        celix_tracked_snapshot_t *snapshot = __atomic_load_n(&instance->snapshot, __ATOMIC_SEQ_CST);
+        for (size_t i = 0; !found && i < snapshot->size; ++i) {
+            found = !__atomic_load_n(&snapshot->entries[i]->removed, __ATOMIC_SEQ_CST);
+        }
+    }
+    serviceTracker_exitReadSection(&frame);
+    return found;
+}
+
+bool celix_serviceTracker_waitForService(celix_service_tracker_t *tracker, double waitTimeoutInSeconds) {
+    bool mayWait = waitTimeoutInSeconds > 0;
+    struct timespec deadline = mayWait ? serviceTracker_deadline(waitTimeoutInSeconds) : (struct timespec){0, 0};
+    for (;;) {
+        long generation = __atomic_load_n(&tracker->snapshotGeneration, __ATOMIC_SEQ_CST);
+        bool found = celix_serviceTracker_hasService(tracker);
+        if (found || !mayWait) {
+            return found;
+        }
+        mayWait = serviceTracker_waitForSnapshot(tracker, generation, &deadline);
+    }
+}
+
 void celix_serviceTracker_useServices(
         service_tracker_t *tracker,
         const char* serviceName /*sanity*/,
@@ -894,41 +1378,31 @@ void celix_serviceTracker_useServices(
         void (*use)(void *handle, void *svc),
         void (*useWithProperties)(void *handle, void *svc, const celix_properties_t *props),
         void (*useWithOwner)(void *handle, void *svc, const celix_properties_t *props, const celix_bundle_t *owner)) {
-    int i;
+    size_t i;
 
-    celixThreadRwlock_readLock(&tracker->instanceLock);
-    celix_service_tracker_instance_t *instance = tracker->instance;
+    celix_tracker_read_frame_t frame;
+    serviceTracker_enterReadSection(tracker, &frame);
+    celix_service_tracker_instance_t *instance = __atomic_load_n(&tracker->instance, __ATOMIC_SEQ_CST);
     if (instance != NULL) {
-        //first lock tracker, get tracked entries and increase use count
-        celixThreadRwlock_readLock(&instance->lock);
-        size_t size = celix_arrayList_size(instance->trackedServices);
-        celix_tracked_entry_t *entries[size];
-        for (i = 0; i < size; i++) {
-            celix_tracked_entry_t *tracked = (celix_tracked_entry_t *) arrayList_get(instance->trackedServices, i);
-            tracked_retain(tracked);
-            entries[i] = tracked;
-        }
-        //unlock tracker so that the tracked entry can be removed from the trackedServices list if unregistered.
-        celixThreadRwlock_unlock(&instance->lock);
-
-        //then use entries and decrease use count
-        for (i = 0; i < size; i++) {
-            celix_tracked_entry_t *entry = entries[i];
-            //got service, call, decrease use count an signal useCond after.
+        //note the snapshot (and the tracked entries) stay valid until the read section is exited
+        celix_tracked_snapshot_t *snapshot = __atomic_load_n(&instance->snapshot, __ATOMIC_SEQ_CST);
+        for (i = 0; i < snapshot->size; i++) {
+            celix_tracked_entry_t *entry = snapshot->entries[i];
+            if (__atomic_load_n(&entry->removed, __ATOMIC_SEQ_CST)) {
+                continue;
+            }
             if (use != NULL) {
                 use(callbackHandle, entry->service);
             }
             if (useWithProperties != NULL) {
-                useWithProperties(callbackHandle, entry->service, entry->properties);
+                useWithProperties(callbackHandle, entry->service, tracked_getProperties(entry));
             }
             if (useWithOwner != NULL) {
-                useWithOwner(callbackHandle, entry->service, entry->properties, entry->serviceOwner);
+                useWithOwner(callbackHandle, entry->service, tracked_getProperties(entry), entry->serviceOwner);
             }
-
-            tracked_release(entry);
         }
     }
-    celixThreadRwlock_unlock(&tracker->instanceLock);
+    serviceTracker_exitReadSection(&frame);
 }
 
 void celix_serviceTracker_syncForFramework(void *fw) {
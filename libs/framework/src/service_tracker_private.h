@@ -29,9 +29,23 @@
 
 #include "service_tracker.h"
 #include "celix_types.h"
+#include "service_registration_private.h"
+#include "version_range.h"
+
+/**
+ * Immutable copy of the tracked services of a tracker instance. Used by the use calls without locking.
+ * A snapshot is replaced (not updated) when the tracked services change and free'd after a grace period
+ * (see serviceTracker_synchronize).
+ */
+typedef struct celix_tracked_snapshot {
+	size_t size;
+	struct celix_tracked_entry *entries[];
+} celix_tracked_snapshot_t;
 
 //instance for an active per open statement and removed per close statement
 typedef struct celix_service_tracker_instance {
+	struct celix_serviceTracker *tracker;
+
 	celix_thread_mutex_t closingLock; //projects closing and activeServiceChangeCalls
 	bool closing; //when true the service tracker instance is being closed and all calls from the service listener are ignored
 	size_t activeServiceChangeCalls;
@@ -61,7 +75,8 @@ typedef struct celix_service_tracker_instance {
 	void (*modifiedWithOwner)(void *handle, void *svc, const properties_t *props, const bundle_t *owner);
 
 	celix_thread_rwlock_t lock; //projects trackedServices
-	array_list_t *trackedServices;
+	array_list_t *trackedServices; //ordered on ranking (highest first) and service id (lowest first)
+	celix_tracked_snapshot_t *snapshot; //atomic, published copy of trackedServices
 
 	celix_thread_mutex_t mutex; //protect current highest service id
 	long currentHighestServiceId;
@@ -75,6 +90,9 @@ struct celix_serviceTracker {
 	char * filter;
 	service_tracker_customizer_t *customizer;
 
+	bool hasVersionRange; //if true, only services with a service.version in versionRange are tracked
+	celix_version_range_key_t versionRange; //pre-parsed, so matching a service version does not allocate
+
 	void *callbackHandle;
 
 	void (*set)(void *handle, void *svc); //highest ranking
@@ -95,19 +113,41 @@ struct celix_serviceTracker {
 	celix_thread_rwlock_t instanceLock;
 	celix_service_tracker_instance_t *instance; /*NULL -> close, !NULL->open*/
 
+	//read sections for the lock free use calls (instance and instance->snapshot)
+	long epoch; //atomic
+	long readers[2]; //atomic, active readers per epoch parity
+	celix_thread_mutex_t syncLock; //serializes grace periods
+	celix_thread_mutex_t retiredLock; //protects retiredSnapshots
+	celix_array_list_t *retiredSnapshots; //snapshots which can be free'd after the next grace period
+	celix_array_list_t *retiredEntries; //removed tracked entries which can be destroyed after the next grace period
+	celix_array_list_t *retiredProperties; //replaced properties snapshots (celix_service_properties_snapshot_t*) which can be released after the next grace period
+
+	celix_thread_mutex_t waitLock; //used with waitCond to wait for tracked services
+	celix_thread_cond_t waitCond; //broadcasted when a snapshot is published or the tracker is closed
+	long snapshotGeneration; //atomic, increased (with waitLock locked) for every published snapshot
+
 };
 
 typedef struct celix_tracked_entry {
 	service_reference_pt reference;
 	void *service;
-	const char *serviceName;
-	properties_t *properties;
+	const char *serviceName; //interned in the celix string pool
+	celix_service_properties_snapshot_t *propertiesSnapshot; //atomic, shared with the service registration. Replaced on a MODIFIED event
+	long serviceId;
+	long serviceRanking; //protected by the instance lock, used to keep the trackedServices ordered
 	bundle_t *serviceOwner;
 
     celix_thread_mutex_t mutex; //protects useCount
 	celix_thread_cond_t useCond;
     size_t useCount;
+
+    bool removed; //atomic, true if untracked. Removed entries are skipped by the use calls
 } celix_tracked_entry_t;
 
+/**
+ * Returns the memory used by the service tracker, incl. the open instance and the tracked entries.
+ */
+size_t serviceTracker_getMemoryUsage(celix_service_tracker_t *tracker);
+
 
 #endif /* SERVICE_TRACKER_PRIVATE_H_ */
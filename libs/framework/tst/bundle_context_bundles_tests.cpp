@@ -22,10 +22,15 @@
 #include <iostream>
 #include <mutex>
 #include <condition_variable>
+#include <atomic>
+#include <vector>
 
 #include <zconf.h>
 
 #include "celix_api.h"
+extern "C" {
+#include "framework_private.h"
+}
 
 #include <CppUTest/TestHarness.h>
 #include <CppUTest/CommandLineTestRunner.h>
@@ -43,6 +48,7 @@ TEST_GROUP(CelixBundleContextBundlesTests) {
     const char * const TEST_BND5_LOC = "simple_test_bundle5.zip";
     const char * const TEST_BND_WITH_EXCEPTION_LOC = "bundle_with_exception.zip";
     const char * const TEST_BND_UNRESOLVEABLE_LOC = "unresolveable_bundle.zip";
+    const char * const TEST_BND_LAZY_LOC = "lazy_test_bundle.zip";
 
     void setup() {
         properties = properties_create();
@@ -57,6 +63,16 @@ TEST_GROUP(CelixBundleContextBundlesTests) {
     void teardown() {
         celix_frameworkFactory_destroyFramework(fw);
     }
+
+    /**
+     * Uninstalls the bundle without using it, celix_bundleContext_uninstallBundle cannot be used because it
+     * uninstalls from a use bundle callback and uninstall waits till the bundle is not used anymore.
+     */
+    void uninstall(long bndId) {
+        bundle_t *bnd = framework_getBundleById(fw, bndId);
+        CHECK(bnd != nullptr);
+        CHECK_EQUAL(CELIX_SUCCESS, bundle_uninstall(bnd));
+    }
 };
 
 TEST(CelixBundleContextBundlesTests, installBundlesTest) {
@@ -138,6 +154,53 @@ TEST(CelixBundleContextBundlesTests, useBundleTest) {
     CHECK_EQUAL(1, count);
 };
 
+TEST(CelixBundleContextBundlesTests, useBundlesAfterUninstallTest) {
+    long bndId1 = celix_bundleContext_installBundle(ctx, TEST_BND1_LOC, true);
+    long bndId2 = celix_bundleContext_installBundle(ctx, TEST_BND2_LOC, true);
+    long bndId3 = celix_bundleContext_installBundle(ctx, TEST_BND3_LOC, true);
+    uninstall(bndId2);
+
+    //the uninstalled bundle is removed from the installed bundles (and the bundle table)
+    CHECK_EQUAL(3, celix_arrayList_size(fw->installedBundles.entries));
+    CHECK_FALSE(celix_bundleContext_useBundle(ctx, bndId2, nullptr, [](void *, const celix_bundle_t *) {}));
+
+    for (int i = 0; i < 2; ++i) {
+        std::vector<long> ids{};
+        celix_bundleContext_useBundles(ctx, &ids, [](void *handle, const celix_bundle_t *bnd) {
+            static_cast<std::vector<long>*>(handle)->push_back(celix_bundle_getId(bnd));
+        });
+        std::vector<long> expected{bndId1, bndId3}; //install order
+        CHECK(expected == ids);
+    }
+}
+
+TEST(CelixBundleContextBundlesTests, useBundlesWithConcurrentInstallTest) {
+    long bndId1 = celix_bundleContext_installBundle(ctx, TEST_BND1_LOC, true);
+    std::atomic<bool> stop{false};
+    std::thread churn{[&]{
+        while (!stop) {
+            long id = celix_bundleContext_installBundle(ctx, TEST_BND2_LOC, true);
+            uninstall(id);
+        }
+    }};
+
+    for (int i = 0; i < 500; ++i) {
+        long firstId = -1;
+        celix_bundleContext_useBundles(ctx, &firstId, [](void *handle, const celix_bundle_t *bnd) {
+            long *first = static_cast<long*>(handle);
+            if (*first < 0) {
+                *first = celix_bundle_getId(bnd);
+            }
+        });
+        CHECK_EQUAL(bndId1, firstId);
+        CHECK_TRUE(celix_bundleContext_useBundle(ctx, bndId1, nullptr, [](void *, const celix_bundle_t *bnd) {
+            CHECK_EQUAL(OSGI_FRAMEWORK_BUNDLE_ACTIVE, celix_bundle_getState(bnd));
+        }));
+    }
+    stop = true;
+    churn.join();
+}
+
 TEST(CelixBundleContextBundlesTests, StopStartTest) {
     long bndId1 = celix_bundleContext_installBundle(ctx, TEST_BND1_LOC, true);
     long bndId2 = celix_bundleContext_installBundle(ctx, TEST_BND2_LOC, true);
@@ -314,6 +377,37 @@ TEST(CelixBundleContextBundlesTests, trackBundlesTest) {
     celix_bundleContext_stopTracker(ctx, trackerId);
 };
 
+TEST(CelixBundleContextBundlesTests, trackBundlesWithSlowListenerTest) {
+    struct data {
+        std::atomic<int> count{0};
+    };
+    struct data data;
+
+    auto started = [](void *handle, const bundle_t *) {
+        struct data *d = static_cast<struct data*>(handle);
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        d->count += 1;
+    };
+
+    long trackerId = celix_bundleContext_trackBundles(ctx, static_cast<void*>(&data), started, nullptr);
+    long bundleId1 = celix_bundleContext_installBundle(ctx, TEST_BND1_LOC, true);
+    long bundleId2 = celix_bundleContext_installBundle(ctx, TEST_BND2_LOC, true);
+    CHECK(bundleId1 >= 0);
+    CHECK(bundleId2 >= 0);
+
+    //note stopping the tracker waits until the tracker is not used by the event dispatcher anymore
+    celix_bundleContext_stopTracker(ctx, trackerId);
+    int count = data.count;
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    CHECK_EQUAL(count, data.count.load()); //no callbacks after the stop
+
+    celix_framework_event_dispatcher_metrics_t metrics;
+    fw_getEventDispatcherMetrics(fw, &metrics);
+    CHECK(metrics.nrOfDispatchedEvents > 0);
+    CHECK(metrics.maxQueueDepth > 0);
+    CHECK(metrics.maxLatencyInNs >= metrics.meanLatencyInNs);
+}
+
 /* IGNORE TODO need to add locks
 TEST(CelixBundleContextBundlesTests, useBundlesConcurrentTest) {
 
@@ -378,4 +472,120 @@ TEST(CelixBundleContextBundlesTests, useBundlesConcurrentTest) {
     std::cout << "use thread joined" << std::endl;
     uninstallThread.join();
     std::cout << "uninstall thread joined" << std::endl;
-};*/
\ No newline at end of file
+};*/
+TEST(CelixBundleContextBundlesTests, autoStartWithConcurrentInstallTest) {
+    properties_t *config = properties_create();
+    properties_set(config, "org.osgi.framework.storage.clean", "onFirstInit");
+    properties_set(config, "org.osgi.framework.storage", ".cacheBundleContextAutoStartTestFramework");
+    properties_set(config, CELIX_AUTO_START_INSTALL_THREADS_NAME, "3");
+    properties_set(config, CELIX_AUTO_START_1, "simple_test_bundle1.zip simple_test_bundle2.zip non-existing.zip simple_test_bundle3.zip simple_test_bundle1.zip");
+    framework_t *autoStartFw = celix_frameworkFactory_createFramework(config);
+    bundle_context_t *autoStartCtx = framework_getContext(autoStartFw);
+
+    //note bundle ids are assigned in configured order
+    for (long bndId = 1; bndId <= 3; ++bndId) {
+        bool called = celix_bundleContext_useBundle(autoStartCtx, bndId, nullptr, [](void *, const celix_bundle_t *bnd) {
+            CHECK_EQUAL(OSGI_FRAMEWORK_BUNDLE_ACTIVE, celix_bundle_getState(bnd));
+        });
+        CHECK_TRUE(called);
+    }
+    bool called = celix_bundleContext_useBundle(autoStartCtx, 4, nullptr, [](void *, const celix_bundle_t *) {});
+    CHECK_FALSE(called);
+
+    celix_frameworkFactory_destroyFramework(autoStartFw);
+}
+
+TEST(CelixBundleContextBundlesTests, lazyActivationTest) {
+    long bndId = celix_bundleContext_installBundle(ctx, TEST_BND_LAZY_LOC, true);
+    CHECK(bndId >= 0);
+
+    //started, but not yet activated
+    bool called = celix_framework_useBundle(fw, false, bndId, nullptr, [](void *, const celix_bundle_t *bnd) {
+        CHECK_EQUAL(OSGI_FRAMEWORK_BUNDLE_RESOLVED, celix_bundle_getState(bnd));
+        CHECK(bundle_getHandle((celix_bundle_t*)bnd) == nullptr); //libraries not yet loaded
+    });
+    CHECK_TRUE(called);
+
+    //tracking a service not provided by the lazy bundle does not activate the bundle
+    long otherTrkId = celix_bundleContext_trackServices(ctx, "other_service", nullptr, nullptr, nullptr);
+    CHECK(otherTrkId >= 0);
+    celix_framework_useBundle(fw, false, bndId, nullptr, [](void *, const celix_bundle_t *bnd) {
+        CHECK_EQUAL(OSGI_FRAMEWORK_BUNDLE_RESOLVED, celix_bundle_getState(bnd));
+    });
+
+    //tracking the lazy service activates the bundle
+    std::atomic<int> count{0};
+    long trkId = celix_bundleContext_trackServices(ctx, "lazy_service", &count, [](void *handle, void *) {
+        auto *c = static_cast<std::atomic<int>*>(handle);
+        c->fetch_add(1);
+    }, nullptr);
+    CHECK(trkId >= 0);
+    CHECK_EQUAL(1, count.load());
+    called = celix_bundleContext_useBundle(ctx, bndId, nullptr, [](void *, const celix_bundle_t *bnd) {
+        CHECK_EQUAL(OSGI_FRAMEWORK_BUNDLE_ACTIVE, celix_bundle_getState(bnd));
+    });
+    CHECK_TRUE(called);
+
+    celix_bundleContext_stopTracker(ctx, trkId);
+    celix_bundleContext_stopTracker(ctx, otherTrkId);
+
+    //restart with an active tracker -> directly activated
+    trkId = celix_bundleContext_trackServices(ctx, "lazy_service", &count, [](void *handle, void *) {
+        auto *c = static_cast<std::atomic<int>*>(handle);
+        c->fetch_add(1);
+    }, nullptr);
+    CHECK_TRUE(celix_bundleContext_stopBundle(ctx, bndId));
+    CHECK_TRUE(celix_bundleContext_startBundle(ctx, bndId));
+    CHECK_EQUAL(3, count.load());
+    celix_bundleContext_stopTracker(ctx, trkId);
+}
+
+TEST(CelixBundleContextBundlesTests, startupTraceTest) {
+    const char *traceFile = ".startup_trace_test.json";
+    remove(traceFile);
+
+    properties_t *config = properties_create();
+    properties_set(config, "org.osgi.framework.storage.clean", "onFirstInit");
+    properties_set(config, "org.osgi.framework.storage", ".cacheBundleContextStartupTraceTestFramework");
+    properties_set(config, CELIX_STARTUP_TRACE_FILE_NAME, traceFile);
+    properties_set(config, CELIX_AUTO_START_1, "simple_test_bundle1.zip");
+    framework_t *traceFw = celix_frameworkFactory_createFramework(config);
+    bundle_context_t *traceCtx = framework_getContext(traceFw);
+
+    //the trace is written after the auto start bundles are started
+    FILE *f = fopen(traceFile, "r");
+    CHECK(f != nullptr);
+    char buf[32];
+    CHECK(fgets(buf, sizeof(buf), f) != nullptr);
+    CHECK_EQUAL(0, strncmp("{\"displayTimeUnit\"", buf, 18));
+    fclose(f);
+
+    celix_dependency_manager_t *mng = celix_bundleContext_getDependencyManager(traceCtx);
+    celix_dm_component_t *cmp = celix_dmComponent_create(traceCtx, "TraceTestComponent");
+    celix_dependencyManager_add(mng, cmp);
+
+    struct trace_counts {
+        int installs;
+        int componentTransitions;
+    } counts{0, 0};
+    bool enabled = celix_framework_useStartupTraceEvents(traceFw, &counts, [](void *handle, const celix_framework_startup_trace_event_t *event) {
+        auto *c = static_cast<struct trace_counts*>(handle);
+        CHECK(event->durationInUs >= 0);
+        if (strcmp(event->category, "bundle") == 0 && strcmp(event->name, "install") == 0) {
+            c->installs += 1;
+            CHECK_EQUAL(1L, event->bndId);
+        } else if (strcmp(event->category, "component") == 0) {
+            STRCMP_EQUAL("TraceTestComponent", event->subject);
+            c->componentTransitions += 1;
+        }
+    });
+    CHECK_TRUE(enabled);
+    CHECK_EQUAL(1, counts.installs);
+    CHECK_EQUAL(3, counts.componentTransitions); //INACTIVE -> WAITING_FOR_REQUIRED -> INSTANTIATED_AND_WAITING_FOR_REQUIRED -> TRACKING_OPTIONAL
+
+    celix_frameworkFactory_destroyFramework(traceFw);
+    remove(traceFile);
+
+    //not enabled for the default framework
+    CHECK_FALSE(celix_framework_useStartupTraceEvents(fw, nullptr, [](void *, const celix_framework_startup_trace_event_t *) {}));
+}
@@ -26,11 +26,17 @@
 #include <string.h>
 #include <map>
 #include <future>
+#include <atomic>
+#include <vector>
+#include <set>
 
 #include "celix_api.h"
 #include "celix_framework_factory.h"
 #include "celix_service_factory.h"
+#include "celix_metrics_service.h"
+#include "celix_service_interceptor_hook.h"
 #include "service_tracker_private.h"
+#include "celix/ServiceTracker.h"
 
 
 #include <CppUTest/TestHarness.h>
@@ -48,6 +54,7 @@ TEST_GROUP(CelixBundleContextServicesTests) {
         properties_set(properties, "LOGHELPER_ENABLE_STDOUT_FALLBACK", "true");
         properties_set(properties, "org.osgi.framework.storage.clean", "onFirstInit");
         properties_set(properties, "org.osgi.framework.storage", ".cacheBundleContextTestFramework");
+        properties_set(properties, "CELIX_SERVICE_REGISTRY_INDEXED_PROPERTIES", "service.id, topic");
 
         fw = celix_frameworkFactory_createFramework(properties);
         ctx = framework_getContext(fw);
@@ -128,6 +135,75 @@ TEST(CelixBundleContextServicesTests, registerMultipleAndUseServices) {
     celix_bundleContext_unregisterService(ctx, svcId2);
 };
 
+TEST(CelixBundleContextServicesTests, registerAndUnregisterServicesInBulkTest) {
+    struct calc {
+        int (*calc)(int);
+    };
+
+    const char *calcName = "calc";
+    struct calc svc;
+    svc.calc = [](int n) -> int {
+        return n * 42;
+    };
+
+    auto add = [](void *handle, void *) {
+        auto *count = static_cast<int*>(handle);
+        *count += 1;
+    };
+    auto remove = [](void *handle, void *) {
+        auto *count = static_cast<int*>(handle);
+        *count -= 1;
+    };
+
+    int count = 0;
+    celix_service_tracking_options_t trkOpts{};
+    trkOpts.filter.serviceName = calcName;
+    trkOpts.callbackHandle = &count;
+    trkOpts.add = add;
+    trkOpts.remove = remove;
+    long trackerId = celix_bundleContext_trackServicesWithOptions(ctx, &trkOpts);
+    CHECK(trackerId >= 0);
+
+    const size_t nrOfServices = 10;
+    celix_service_registration_options_t opts[nrOfServices + 1];
+    for (size_t i = 0; i < nrOfServices; ++i) {
+        opts[i] = {};
+        opts[i].svc = &svc;
+        opts[i].serviceName = calcName;
+        opts[i].serviceVersion = "1.0.0";
+    }
+    opts[nrOfServices] = {}; //invalid, no service name
+    opts[nrOfServices].svc = &svc;
+
+    long svcIds[nrOfServices + 1];
+    size_t registered = celix_bundleContext_registerServices(ctx, opts, nrOfServices + 1, svcIds);
+    CHECK_EQUAL(nrOfServices, registered);
+    CHECK_EQUAL(-1L, svcIds[nrOfServices]);
+    for (size_t i = 0; i < nrOfServices; ++i) {
+        CHECK(svcIds[i] >= 0);
+        if (i > 0) {
+            CHECK_EQUAL(svcIds[i - 1] + 1, svcIds[i]);
+        }
+    }
+    CHECK_EQUAL((int)nrOfServices, count);
+
+    celix_service_filter_options_t filterOpts{};
+    filterOpts.serviceName = calcName;
+    filterOpts.filter = "(service.version=1.0.0)";
+    celix_array_list_t *found = celix_bundleContext_findServicesWithOptions(ctx, &filterOpts);
+    CHECK_EQUAL(nrOfServices, celix_arrayList_size(found));
+    celix_arrayList_destroy(found);
+
+    celix_bundleContext_unregisterServices(ctx, svcIds, nrOfServices / 2);
+    CHECK_EQUAL((int)(nrOfServices - nrOfServices / 2), count);
+
+    celix_bundleContext_unregisterServices(ctx, svcIds + nrOfServices / 2, nrOfServices - nrOfServices / 2 + 1); //note includes -1
+    CHECK_EQUAL(0, count);
+    CHECK_EQUAL(-1L, celix_bundleContext_findService(ctx, calcName));
+
+    celix_bundleContext_stopTracker(ctx, trackerId);
+};
+
 TEST(CelixBundleContextServicesTests, registerAndUseService) {
     struct calc {
         int (*calc)(int);
@@ -292,6 +368,61 @@ TEST(CelixBundleContextServicesTests, registerAndUseWithForcedRaceCondition) {
 };
 
 
+TEST(CelixBundleContextServicesTests, serviceHandleTest) {
+    struct calc {
+        int (*calc)(int);
+    };
+    struct calc svc;
+    svc.calc = [](int n) -> int {
+        return n * 42;
+    };
+
+    celix_service_filter_options_t opts{};
+    opts.serviceName = "calc";
+    celix_service_handle_t *handle = celix_bundleContext_createServiceHandle(ctx, &opts);
+    CHECK(handle != nullptr);
+
+    int result = 0;
+    auto use = [](void *handle, void *svc) {
+        int *r = static_cast<int*>(handle);
+        struct calc *calc = static_cast<struct calc*>(svc);
+        *r += calc->calc(1);
+    };
+    bool called = celix_serviceHandle_use(handle, &result, use);
+    CHECK(!called);
+
+    long svcId1 = celix_bundleContext_registerService(ctx, &svc, "calc", nullptr);
+    long svcId2 = celix_bundleContext_registerService(ctx, &svc, "calc", nullptr);
+    for (int i = 0; i < 10; ++i) {
+        called = celix_serviceHandle_use(handle, &result, use);
+        CHECK(called);
+    }
+    CHECK_EQUAL(420, result);
+
+    result = 0;
+    celix_serviceHandle_useServices(handle, &result, use);
+    CHECK_EQUAL(84, result);
+
+    celix_bundleContext_unregisterService(ctx, svcId1);
+    result = 0;
+    celix_service_use_options_t useOpts{};
+    useOpts.callbackHandle = &result;
+    useOpts.use = use;
+    celix_serviceHandle_useServicesWithOptions(handle, &useOpts);
+    CHECK_EQUAL(42, result);
+
+    celix_bundleContext_unregisterService(ctx, svcId2);
+    called = celix_serviceHandle_useWithOptions(handle, &useOpts);
+    CHECK(!called);
+
+    celix_serviceHandle_destroy(handle);
+
+    //missing service name
+    opts.serviceName = nullptr;
+    handle = celix_bundleContext_createServiceHandle(ctx, &opts);
+    CHECK(handle == nullptr);
+}
+
 TEST(CelixBundleContextServicesTests, servicesTrackerTest) {
     int count = 0;
     auto add = [](void *handle, void *svc) {
@@ -424,6 +555,60 @@ TEST(CelixBundleContextServicesTests, servicesTrackerTestWithProperties) {
     celix_bundleContext_stopTracker(ctx, trackerId);
 }
 
+TEST(CelixBundleContextServicesTests, servicesTrackerTestWithVersionRange) {
+    int count = 0;
+    auto add = [](void *handle, void *) {
+        int *c = static_cast<int*>(handle);
+        *c += 1;
+    };
+    auto remove = [](void *handle, void *) {
+        int *c = static_cast<int*>(handle);
+        *c -= 1;
+    };
+    auto registerWithVersion = [&](const char *version) -> long {
+        celix_properties_t *props = celix_properties_create();
+        if (version != nullptr) {
+            celix_properties_set(props, CELIX_FRAMEWORK_SERVICE_VERSION, version);
+        }
+        return celix_bundleContext_registerService(ctx, (void*)0x100, "calc", props);
+    };
+
+    long svcId1 = registerWithVersion("1.0.0");
+    long svcId2 = registerWithVersion("2.0.0");
+
+    celix_service_tracking_options_t opts{};
+    opts.filter.serviceName = "calc";
+    opts.filter.versionRange = "[1.0.0,2.0.0)";
+    opts.callbackHandle = &count;
+    opts.add = add;
+    opts.remove = remove;
+    long trackerId = celix_bundleContext_trackServicesWithOptions(ctx, &opts);
+    CHECK(trackerId > 0);
+    CHECK_EQUAL(1, count); //only 1.0.0
+
+    long svcId3 = registerWithVersion("1.9.9.qualifier");
+    long svcId4 = registerWithVersion(nullptr); //no version, not in range
+    long svcId5 = registerWithVersion("2.0.0");
+    CHECK_EQUAL(2, count);
+
+    celix_bundleContext_unregisterService(ctx, svcId1);
+    celix_bundleContext_unregisterService(ctx, svcId2);
+    celix_bundleContext_unregisterService(ctx, svcId3);
+    celix_bundleContext_unregisterService(ctx, svcId4);
+    celix_bundleContext_unregisterService(ctx, svcId5);
+    CHECK_EQUAL(0, count);
+    celix_bundleContext_stopTracker(ctx, trackerId);
+
+    //invalid range tracks nothing
+    long svcId6 = registerWithVersion("1.0.0");
+    opts.filter.versionRange = "[1.0.0,2.0.0";
+    trackerId = celix_bundleContext_trackServicesWithOptions(ctx, &opts);
+    CHECK(trackerId > 0);
+    CHECK_EQUAL(0, count);
+    celix_bundleContext_stopTracker(ctx, trackerId);
+    celix_bundleContext_unregisterService(ctx, svcId6);
+}
+
 TEST(CelixBundleContextServicesTests, servicesTrackerTestWithOwner) {
     int count = 0;
     auto add = [](void *handle, void *svc, const properties_t *props, const bundle_t *svcOwner) {
@@ -566,6 +751,128 @@ TEST(CelixBundleContextServicesTests, serviceTrackerWithRaceConditionTest) {
     celix_bundleContext_stopTracker(ctx, trackerId);
 };
 
+TEST(CelixBundleContextServicesTests, useServicesWithConcurrentUpdatesTest) {
+    celix_service_tracker_t *tracker = celix_serviceTracker_create(ctx, "calc", nullptr, nullptr);
+    CHECK(tracker != nullptr);
+
+    std::atomic<bool> stop{false};
+    std::atomic<long> count{0};
+    auto use = [](void *handle, void *svc) {
+        CHECK(svc != nullptr);
+        auto *c = static_cast<std::atomic<long>*>(handle);
+        c->fetch_add(1);
+    };
+    auto useLoop = [&] {
+        while (!stop) {
+            celix_serviceTracker_useServices(tracker, "calc", &count, use, nullptr, nullptr);
+            celix_serviceTracker_useHighestRankingService(tracker, "calc", 0, &count, use, nullptr, nullptr);
+        }
+    };
+    std::thread useThread1{useLoop};
+    std::thread useThread2{useLoop};
+
+    long svcId1 = celix_bundleContext_registerService(ctx, (void*)0x100, "calc", nullptr);
+    for (int i = 0; i < 100; ++i) {
+        long svcId2 = celix_bundleContext_registerService(ctx, (void*)0x200, "calc", nullptr);
+        CHECK(svcId2 >= 0);
+        celix_bundleContext_unregisterService(ctx, svcId2);
+    }
+
+    while (count == 0) {
+        std::this_thread::yield();
+    }
+    stop = true;
+    useThread1.join();
+    useThread2.join();
+
+    celix_bundleContext_unregisterService(ctx, svcId1);
+    celix_serviceTracker_destroy(tracker);
+}
+
+TEST(CelixBundleContextServicesTests, modifyServicePropertiesWithConcurrentUsesTest) {
+    celix_service_tracker_t *tracker = celix_serviceTracker_create(ctx, "calc", nullptr, nullptr);
+    CHECK(tracker != nullptr);
+
+    celix_properties_t *props = celix_properties_create();
+    celix_properties_set(props, "version", "0");
+    celix_properties_set(props, CELIX_FRAMEWORK_SERVICE_LANGUAGE, CELIX_FRAMEWORK_SERVICE_C_LANGUAGE);
+    service_registration_t *reg = nullptr;
+    celix_status_t status = bundleContext_registerService(ctx, "calc", (void*)0x100, props, &reg);
+    CHECK_EQUAL(CELIX_SUCCESS, status);
+
+    std::atomic<bool> stop{false};
+    std::atomic<long> count{0};
+    auto useWithProps = [](void *handle, void *, const celix_properties_t *svcProps) {
+        CHECK(celix_properties_get(svcProps, "version", nullptr) != nullptr);
+        auto *c = static_cast<std::atomic<long>*>(handle);
+        c->fetch_add(1);
+    };
+    auto useLoop = [&] {
+        while (!stop) {
+            celix_serviceTracker_useServices(tracker, "calc", &count, nullptr, useWithProps, nullptr);
+            celix_serviceTracker_useHighestRankingService(tracker, "calc", 0, &count, nullptr, useWithProps, nullptr);
+        }
+    };
+    std::thread useThread{useLoop};
+    while (count == 0) {
+        std::this_thread::yield();
+    }
+
+    for (int i = 1; i <= 100; ++i) {
+        celix_properties_t *newProps = celix_properties_create();
+        celix_properties_setLong(newProps, "version", i);
+        celix_properties_set(newProps, CELIX_FRAMEWORK_SERVICE_LANGUAGE, CELIX_FRAMEWORK_SERVICE_C_LANGUAGE);
+        serviceRegistration_setProperties(reg, newProps); //note old properties are destroyed by the registration
+    }
+
+    stop = true;
+    useThread.join();
+
+    //the tracker uses the properties of the last modification
+    long version = -1;
+    celix_serviceTracker_useHighestRankingService(tracker, "calc", 0, &version, nullptr, [](void *handle, void *, const celix_properties_t *svcProps) {
+        auto *v = static_cast<long*>(handle);
+        *v = celix_properties_getAsLong(svcProps, "version", -1);
+    }, nullptr);
+    CHECK_EQUAL(100, version);
+
+    serviceRegistration_unregister(reg);
+    celix_serviceTracker_destroy(tracker);
+}
+
+TEST(CelixBundleContextServicesTests, unregisterServiceInUseServicesCallbackTest) {
+    celix_service_tracker_t *tracker = celix_serviceTracker_create(ctx, "calc", nullptr, nullptr);
+    CHECK(tracker != nullptr);
+
+    long svcId1 = celix_bundleContext_registerService(ctx, (void*)0x100, "calc", nullptr);
+    long svcId2 = celix_bundleContext_registerService(ctx, (void*)0x200, "calc", nullptr);
+
+    struct data {
+        celix_bundle_context_t *ctx;
+        long svcIdToUnregister;
+        int count;
+    };
+    struct data data{ctx, svcId2, 0};
+    auto use = [](void *handle, void *svc) {
+        auto *d = static_cast<struct data*>(handle);
+        d->count += 1;
+        if (svc == (void*)0x100 && d->svcIdToUnregister >= 0) {
+            //note should not block, the tracker should not wait on its own use call.
+            celix_bundleContext_unregisterService(d->ctx, d->svcIdToUnregister);
+            d->svcIdToUnregister = -1L;
+        }
+    };
+    celix_serviceTracker_useServices(tracker, "calc", &data, use, nullptr, nullptr);
+    CHECK_EQUAL(1, data.count); //svc 0x200 is removed during the use call and should be skipped
+
+    data.count = 0;
+    celix_serviceTracker_useServices(tracker, "calc", &data, use, nullptr, nullptr);
+    CHECK_EQUAL(1, data.count);
+
+    celix_bundleContext_unregisterService(ctx, svcId1);
+    celix_serviceTracker_destroy(tracker);
+}
+
 TEST(CelixBundleContextServicesTests, servicesTrackerSetTest) {
     int count = 0;
 
@@ -628,6 +935,107 @@ TEST(CelixBundleContextServicesTests, servicesTrackerSetTest) {
 //TODO test tracker with options for properties & service owners
 
 
+TEST(CelixBundleContextServicesTests, servicesTrackerRankingOrderTest) {
+    auto registerWithRanking = [&](long svc, const char *ranking) -> service_registration_t* {
+        celix_properties_t *props = celix_properties_create();
+        celix_properties_set(props, OSGI_FRAMEWORK_SERVICE_RANKING, ranking);
+        celix_properties_set(props, CELIX_FRAMEWORK_SERVICE_LANGUAGE, CELIX_FRAMEWORK_SERVICE_C_LANGUAGE);
+        service_registration_t *reg = nullptr;
+        bundleContext_registerService(ctx, "ranked", (void*)svc, props, &reg);
+        CHECK(reg != nullptr);
+        return reg;
+    };
+    service_registration_t *reg1 = registerWithRanking(0x100, "5");
+    service_registration_t *reg2 = registerWithRanking(0x200, "-1");
+    service_registration_t *reg3 = registerWithRanking(0x300, "20");
+    service_registration_t *reg4 = registerWithRanking(0x400, "20"); //equal ranking, higher service id
+    service_registration_t *reg5 = registerWithRanking(0x500, "3");
+
+    celix_service_tracker_t *tracker = celix_serviceTracker_create(ctx, "ranked", nullptr, nullptr);
+    CHECK(tracker != nullptr);
+
+    auto useHighest = [&]() -> long {
+        long svc = 0;
+        celix_serviceTracker_useHighestRankingService(tracker, "ranked", 0, &svc, [](void *handle, void *s) {
+            *static_cast<long*>(handle) = (long)s;
+        }, nullptr, nullptr);
+        return svc;
+    };
+    CHECK_EQUAL(0x300, useHighest());
+
+    //use services iterates over the services in ranking order
+    std::vector<long> order{};
+    celix_serviceTracker_useServices(tracker, "ranked", &order, [](void *handle, void *s) {
+        static_cast<std::vector<long>*>(handle)->push_back((long)s);
+    }, nullptr, nullptr);
+    std::vector<long> expected{0x300, 0x400, 0x100, 0x500, 0x200};
+    CHECK(expected == order);
+
+    //modifying the ranking reorders the tracked services
+    celix_properties_t *props = celix_properties_create();
+    celix_properties_set(props, OSGI_FRAMEWORK_SERVICE_RANKING, "100");
+    celix_properties_set(props, CELIX_FRAMEWORK_SERVICE_LANGUAGE, CELIX_FRAMEWORK_SERVICE_C_LANGUAGE);
+    serviceRegistration_setProperties(reg2, props);
+    CHECK_EQUAL(0x200, useHighest());
+
+    serviceRegistration_unregister(reg2);
+    CHECK_EQUAL(0x300, useHighest());
+    serviceRegistration_unregister(reg3);
+    CHECK_EQUAL(0x400, useHighest());
+
+    celix_serviceTracker_destroy(tracker);
+    serviceRegistration_unregister(reg1);
+    serviceRegistration_unregister(reg4);
+    serviceRegistration_unregister(reg5);
+}
+
+TEST(CelixBundleContextServicesTests, memoryStatsTest) {
+    auto getFrameworkStats = [&](celix_framework_bundle_memory_stats_t *out) {
+        celix_array_list_t *stats = celix_framework_getMemoryStats(fw);
+        CHECK(celix_arrayList_size(stats) >= 1);
+        bool found = false;
+        for (int i = 0; i < celix_arrayList_size(stats); ++i) {
+            auto *entry = static_cast<celix_framework_bundle_memory_stats_t*>(celix_arrayList_get(stats, i));
+            if (entry->bndId == celix_bundle_getId(celix_bundleContext_getBundle(ctx))) {
+                *out = *entry;
+                out->symbolicName = nullptr;
+                found = true;
+            }
+        }
+        celix_framework_destroyMemoryStats(stats);
+        CHECK(found);
+    };
+
+    celix_framework_bundle_memory_stats_t before{};
+    getFrameworkStats(&before);
+
+    celix_properties_t *props = celix_properties_create();
+    celix_properties_set(props, "key", "a somewhat longer value to account for");
+    long svcId1 = celix_bundleContext_registerService(ctx, (void*)0x100, "calc", props);
+    long svcId2 = celix_bundleContext_registerService(ctx, (void*)0x200, "calc", nullptr);
+    long trkId = celix_bundleContext_trackServices(ctx, "calc", nullptr, nullptr, nullptr);
+
+    celix_framework_bundle_memory_stats_t after{};
+    getFrameworkStats(&after);
+    CHECK_EQUAL(before.nrOfServiceRegistrations + 2, after.nrOfServiceRegistrations);
+    CHECK_EQUAL(before.nrOfServiceTrackers + 1, after.nrOfServiceTrackers);
+    CHECK(after.nrOfServiceListeners > before.nrOfServiceListeners); //the tracker service listener
+    CHECK(after.servicePropertiesInBytes > before.servicePropertiesInBytes + strlen("a somewhat longer value to account for"));
+    CHECK(after.serviceTrackersInBytes > before.serviceTrackersInBytes);
+    CHECK_EQUAL(after.serviceRegistrationsInBytes + after.servicePropertiesInBytes + after.serviceReferencesInBytes +
+                after.serviceListenersInBytes + after.serviceTrackersInBytes, after.totalInBytes);
+
+    celix_bundleContext_stopTracker(ctx, trkId);
+    celix_bundleContext_unregisterService(ctx, svcId1);
+    celix_bundleContext_unregisterService(ctx, svcId2);
+
+    celix_framework_bundle_memory_stats_t end{};
+    getFrameworkStats(&end);
+    CHECK_EQUAL(before.nrOfServiceRegistrations, end.nrOfServiceRegistrations);
+    CHECK_EQUAL(before.nrOfServiceTrackers, end.nrOfServiceTrackers);
+    CHECK_EQUAL(before.servicePropertiesInBytes, end.servicePropertiesInBytes);
+}
+
 TEST(CelixBundleContextServicesTests, serviceFactoryTest) {
     struct calc {
         int (*calc)(int);
@@ -696,6 +1104,100 @@ TEST(CelixBundleContextServicesTests, findServicesTest) {
     celix_bundleContext_unregisterService(ctx, svcId2);
 }
 
+TEST(CelixBundleContextServicesTests, findServicesWithIndexedPropertiesTest) {
+    celix_properties_t *props = celix_properties_create();
+    celix_properties_set(props, "topic", "a");
+    long svcId1 = celix_bundleContext_registerService(ctx, (void*)0x100, "example", props);
+    props = celix_properties_create();
+    celix_properties_set(props, "topic", "b");
+    long svcId2 = celix_bundleContext_registerService(ctx, (void*)0x100, "example", props);
+    props = celix_properties_create();
+    celix_properties_set(props, "topic", "a");
+    long svcId3 = celix_bundleContext_registerService(ctx, (void*)0x100, "other", props);
+
+    celix_service_filter_options_t opts{};
+    opts.serviceName = "example";
+    opts.filter = "(topic=a)";
+    array_list_t *list = celix_bundleContext_findServicesWithOptions(ctx, &opts);
+    CHECK_EQUAL(1, celix_arrayList_size(list));
+    CHECK_EQUAL(svcId1, celix_arrayList_getLong(list, 0));
+    arrayList_destroy(list);
+
+    opts.filter = "(&(topic=b)(objectClass=example))";
+    list = celix_bundleContext_findServicesWithOptions(ctx, &opts);
+    CHECK_EQUAL(1, celix_arrayList_size(list));
+    CHECK_EQUAL(svcId2, celix_arrayList_getLong(list, 0));
+    arrayList_destroy(list);
+
+    opts.filter = "(topic=c)";
+    list = celix_bundleContext_findServicesWithOptions(ctx, &opts);
+    CHECK_EQUAL(0, celix_arrayList_size(list));
+    arrayList_destroy(list);
+
+    opts.serviceName = "other";
+    opts.filter = "(|(topic=a)(topic=b))"; //not indexed, so a scan
+    list = celix_bundleContext_findServicesWithOptions(ctx, &opts);
+    CHECK_EQUAL(1, celix_arrayList_size(list));
+    CHECK_EQUAL(svcId3, celix_arrayList_getLong(list, 0));
+    arrayList_destroy(list);
+
+    celix_bundleContext_unregisterService(ctx, svcId1);
+    opts.serviceName = "example";
+    opts.filter = "(topic=a)";
+    list = celix_bundleContext_findServicesWithOptions(ctx, &opts);
+    CHECK_EQUAL(0, celix_arrayList_size(list));
+    arrayList_destroy(list);
+
+    celix_bundleContext_unregisterService(ctx, svcId2);
+    celix_bundleContext_unregisterService(ctx, svcId3);
+}
+
+TEST(CelixBundleContextServicesTests, serviceListenersWithObjectClassFiltersTest) {
+    struct listener_data {
+        celix_service_listener_t listener;
+        int count;
+    };
+    auto changed = [](void *handle, celix_service_event_t *event) -> celix_status_t {
+        auto *data = static_cast<listener_data*>(handle);
+        if (event->type == OSGI_FRAMEWORK_SERVICE_EVENT_REGISTERED) {
+            data->count += 1;
+        }
+        return CELIX_SUCCESS;
+    };
+
+    const char *filters[] = {
+            "(objectClass=A)",
+            "(&(objectClass=A)(topic=a))",
+            "(|(objectClass=A)(objectClass=B))",
+            "(!(objectClass=A))",
+            nullptr
+    };
+    listener_data data[5];
+    for (int i = 0; i < 5; ++i) {
+        data[i].listener.handle = &data[i];
+        data[i].listener.serviceChanged = changed;
+        data[i].count = 0;
+        bundleContext_addServiceListener(ctx, &data[i].listener, filters[i]);
+    }
+
+    celix_properties_t *props = celix_properties_create();
+    celix_properties_set(props, "topic", "a");
+    long svcId1 = celix_bundleContext_registerService(ctx, (void*)0x100, "A", props);
+    long svcId2 = celix_bundleContext_registerService(ctx, (void*)0x100, "B", nullptr);
+
+    CHECK_EQUAL(1, data[0].count);
+    CHECK_EQUAL(1, data[1].count);
+    CHECK_EQUAL(2, data[2].count);
+    CHECK_EQUAL(1, data[3].count);
+    CHECK_EQUAL(2, data[4].count);
+
+    celix_bundleContext_unregisterService(ctx, svcId1);
+    celix_bundleContext_unregisterService(ctx, svcId2);
+    for (int i = 0; i < 5; ++i) {
+        bundleContext_removeServiceListener(ctx, &data[i].listener);
+    }
+}
+
 TEST(CelixBundleContextServicesTests, trackServiceTrackerTest) {
 
     int count = 0;
@@ -739,3 +1241,333 @@ TEST(CelixBundleContextServicesTests, trackServiceTrackerTest) {
     celix_bundleContext_stopTracker(ctx, trackerId);
     celix_bundleContext_stopTracker(ctx, tracker4);
 }
+
+TEST(CelixBundleContextServicesTests, asyncServiceEventsTest) {
+    //note using a separate framework, configured to deliver the service events on a executor per bundle
+    properties_t *config = properties_create();
+    properties_set(config, "org.osgi.framework.storage.clean", "onFirstInit");
+    properties_set(config, "org.osgi.framework.storage", ".cacheBundleContextAsyncTestFramework");
+    properties_set(config, CELIX_FRAMEWORK_SERVICE_EVENTS_ASYNC_NAME, "true");
+    framework_t *asyncFw = celix_frameworkFactory_createFramework(config);
+    bundle_context_t *asyncCtx = framework_getContext(asyncFw);
+
+    struct tracker_data {
+        std::mutex mutex{};
+        std::condition_variable cond{};
+        int count{0};
+    } data{};
+
+    auto add = [](void *handle, void *) {
+        auto *d = static_cast<tracker_data*>(handle);
+        std::lock_guard<std::mutex> lck{d->mutex};
+        d->count += 1;
+        d->cond.notify_all();
+    };
+    auto remove = [](void *handle, void *) {
+        auto *d = static_cast<tracker_data*>(handle);
+        std::lock_guard<std::mutex> lck{d->mutex};
+        d->count -= 1;
+        d->cond.notify_all();
+    };
+
+    long trackerId = celix_bundleContext_trackServices(asyncCtx, "async", &data, add, remove);
+    CHECK_TRUE(trackerId >= 0);
+
+    long svcId1 = celix_bundleContext_registerService(asyncCtx, (void*)0x100, "async", nullptr);
+    long svcId2 = celix_bundleContext_registerService(asyncCtx, (void*)0x200, "async", nullptr);
+    {
+        std::unique_lock<std::mutex> lck{data.mutex};
+        data.cond.wait_for(lck, std::chrono::seconds{5}, [&]{ return data.count == 2; });
+        CHECK_EQUAL(2, data.count);
+    }
+
+    //unregister waits until the unregistering event is delivered
+    celix_bundleContext_unregisterService(asyncCtx, svcId1);
+    {
+        std::lock_guard<std::mutex> lck{data.mutex};
+        CHECK_EQUAL(1, data.count);
+    }
+
+    celix_bundleContext_unregisterService(asyncCtx, svcId2);
+    celix_bundleContext_stopTracker(asyncCtx, trackerId);
+    celix_frameworkFactory_destroyFramework(asyncFw);
+}
+
+TEST(CelixBundleContextServicesTests, cxxServiceTrackerTest) {
+    struct calc {
+        int value;
+    };
+    calc svc1{1};
+    calc svc2{2};
+
+    celix::ServiceTracker<calc> tracker{ctx, "calc"};
+    CHECK_TRUE(tracker.isValid());
+    CHECK_EQUAL(0, tracker.size());
+    CHECK_FALSE(tracker.highest());
+
+    long svcId1 = celix_bundleContext_registerService(ctx, &svc1, "calc", nullptr);
+    auto *props = celix_properties_create();
+    celix_properties_setLong(props, OSGI_FRAMEWORK_SERVICE_RANKING, 10);
+    long svcId2 = celix_bundleContext_registerService(ctx, &svc2, "calc", props);
+    CHECK_EQUAL(2, tracker.size());
+
+    //ordered on ranking
+    std::vector<int> values{};
+    for (calc *c : tracker.services()) {
+        values.push_back(c->value);
+    }
+    CHECK_EQUAL(2, values.size());
+    CHECK_EQUAL(2, values[0]);
+    CHECK_EQUAL(1, values[1]);
+
+    celix::ServiceHandle<calc> handle = tracker.highest();
+    CHECK_TRUE(handle);
+    CHECK_EQUAL(2, handle->value);
+    CHECK_EQUAL(svcId2, handle.serviceId());
+    CHECK_EQUAL(10, handle.serviceRanking());
+    CHECK_EQUAL(1, tracker.get(svcId1)->value);
+
+    //unregister blocks until the handle releases the service
+    std::atomic<bool> unregistered{false};
+    std::thread unregisterThread{[&]{
+        celix_bundleContext_unregisterService(ctx, svcId2);
+        unregistered = true;
+    }};
+    std::this_thread::sleep_for(std::chrono::milliseconds{10});
+    CHECK_FALSE(unregistered);
+    CHECK_EQUAL(2, handle->value);
+
+    celix::ServiceHandle<calc> moved = std::move(handle);
+    CHECK_FALSE(handle);
+    moved.reset();
+    unregisterThread.join();
+    CHECK_TRUE(unregistered);
+    CHECK_EQUAL(1, tracker.size());
+    CHECK_EQUAL(1, tracker.highest()->value);
+
+    celix_bundleContext_unregisterService(ctx, svcId1);
+    CHECK_EQUAL(0, tracker.size());
+}
+
+TEST(CelixBundleContextServicesTests, cxxServiceTrackerWhenAvailableTest) {
+    struct calc {
+        int value;
+    };
+    calc svc{42};
+
+    celix::ServiceTracker<calc> tracker{ctx, "calc"};
+    CHECK_TRUE(tracker.isValid());
+
+    //no service yet, callbacks wait for the next tracked service
+    std::atomic<int> calls{0};
+    std::atomic<int> seenValue{0};
+    tracker.whenAvailable([&]{
+        //the service is already tracked when the callback is called
+        seenValue = tracker.highest()->value;
+        calls++;
+    });
+    tracker.whenAvailable([&]{ calls++; });
+    CHECK_EQUAL(0, calls.load());
+
+    long svcId = celix_bundleContext_registerService(ctx, &svc, "calc", nullptr);
+    CHECK_EQUAL(2, calls.load());
+    CHECK_EQUAL(42, seenValue.load());
+
+    //service present, the callback is called directly
+    bool calledDirectly = false;
+    tracker.whenAvailable([&]{ calledDirectly = true; });
+    CHECK_TRUE(calledDirectly);
+
+    //callbacks are called once, not again for a next service
+    calc svc2{43};
+    long svcId2 = celix_bundleContext_registerService(ctx, &svc2, "calc", nullptr);
+    CHECK_EQUAL(2, calls.load());
+
+    celix_bundleContext_unregisterService(ctx, svcId);
+    celix_bundleContext_unregisterService(ctx, svcId2);
+
+    //removed again, back to waiting for the next registration
+    calledDirectly = false;
+    tracker.whenAvailable([&]{ calledDirectly = true; });
+    CHECK_FALSE(calledDirectly);
+    svcId = celix_bundleContext_registerService(ctx, &svc, "calc", nullptr);
+    CHECK_TRUE(calledDirectly);
+    celix_bundleContext_unregisterService(ctx, svcId);
+}
+
+TEST(CelixBundleContextServicesTests, frameworkMetricsTest) {
+    int dummy = 0;
+    long trkId = celix_bundleContext_trackServices(ctx, "metrics_test", nullptr, [](void *, void *) {}, nullptr);
+    long svcId = celix_bundleContext_registerService(ctx, &dummy, "metrics_test", nullptr);
+
+    std::map<std::string, double> samples{};
+    auto use = [](void *handle, void *svc) {
+        auto *provider = static_cast<celix_metrics_provider_service_t*>(svc);
+        celix_metrics_writer_t writer{};
+        writer.handle = handle;
+        writer.write = [](void *handle, const char *name, celix_metric_type_e, const char *, const char *labels, double value) {
+            auto *samples = static_cast<std::map<std::string, double>*>(handle);
+            (*samples)[std::string{name} + (labels == nullptr ? "" : std::string{"{"} + labels + "}")] = value;
+        };
+        provider->collect(provider->handle, &writer);
+    };
+    celix_service_use_options_t opts{};
+    opts.filter.serviceName = CELIX_METRICS_PROVIDER_SERVICE_NAME;
+    opts.callbackHandle = &samples;
+    opts.use = use;
+    CHECK_TRUE(celix_bundleContext_useServiceWithOptions(ctx, &opts));
+
+    CHECK_TRUE(samples["celix_framework_services"] >= 2); //metrics_test and framework services
+    CHECK_TRUE(samples["celix_framework_listeners{type=\"service\"}"] >= 1);
+    CHECK_TRUE(samples["celix_framework_service_events_total"] >= 1);
+    CHECK_TRUE(samples["celix_framework_tracker_callbacks_total"] >= 1);
+
+    celix_bundleContext_unregisterService(ctx, svcId);
+    celix_bundleContext_stopTracker(ctx, trkId);
+}
+
+TEST(CelixBundleContextServicesTests, serviceInterceptorHookTest) {
+    struct calc_svc {
+        void *handle;
+        int (*calc)(void *handle, int a);
+    };
+    struct hook_data {
+        calc_svc wrapper;
+        const calc_svc *intercepted;
+        std::atomic<int> intercepted_count;
+        std::atomic<int> released_count;
+    };
+    hook_data data{};
+    data.wrapper.handle = &data;
+    data.wrapper.calc = [](void *handle, int a) -> int {
+        auto *d = static_cast<hook_data*>(handle);
+        return d->intercepted->calc(d->intercepted->handle, a) + 100;
+    };
+
+    celix_service_interceptor_hook_t hook{};
+    hook.handle = &data;
+    hook.intercept = [](void *handle, const celix_bundle_t *, const celix_bundle_t *, const celix_properties_t *props, const void *svc) -> void* {
+        auto *d = static_cast<hook_data*>(handle);
+        if (strcmp(celix_properties_get(props, OSGI_FRAMEWORK_OBJECTCLASS, ""), "intercept_test") != 0) {
+            return nullptr;
+        }
+        d->intercepted = static_cast<const calc_svc*>(svc);
+        d->intercepted_count += 1;
+        return &d->wrapper;
+    };
+    hook.release = [](void *handle, void *wrapper) {
+        auto *d = static_cast<hook_data*>(handle);
+        CHECK_EQUAL(&d->wrapper, wrapper);
+        d->released_count += 1;
+    };
+
+    calc_svc svc{};
+    svc.calc = [](void *, int a) -> int {
+        return a * 2;
+    };
+    long svcId = celix_bundleContext_registerService(ctx, &svc, "intercept_test", nullptr);
+
+    auto use = [](void *handle, void *s) {
+        auto *result = static_cast<int*>(handle);
+        auto *calc = static_cast<calc_svc*>(s);
+        *result = calc->calc(calc->handle, 21);
+    };
+
+    //no hook -> real service
+    int result = 0;
+    CHECK_TRUE(celix_bundleContext_useServiceWithId(ctx, svcId, "intercept_test", &result, use));
+    CHECK_EQUAL(42, result);
+
+    long hookId = celix_bundleContext_registerService(ctx, &hook, CELIX_SERVICE_INTERCEPTOR_HOOK_SERVICE_NAME, nullptr);
+    CHECK_TRUE(celix_bundleContext_useServiceWithId(ctx, svcId, "intercept_test", &result, use));
+    CHECK_EQUAL(142, result);
+    CHECK_EQUAL(1, data.intercepted_count.load());
+    CHECK_EQUAL(1, data.released_count.load()); //released after use
+
+    //hook not intercepting other services
+    calc_svc other{};
+    other.calc = svc.calc;
+    long otherId = celix_bundleContext_registerService(ctx, &other, "other_test", nullptr);
+    CHECK_TRUE(celix_bundleContext_useServiceWithId(ctx, otherId, "other_test", &result, use));
+    CHECK_EQUAL(42, result);
+    CHECK_EQUAL(1, data.intercepted_count.load());
+
+    //tracked services keep the wrapper until the tracker is stopped
+    long trkId = celix_bundleContext_trackService(ctx, "intercept_test", &result, [](void *handle, void *s) {
+        auto *r = static_cast<int*>(handle);
+        auto *calc = static_cast<calc_svc*>(s);
+        *r = s == nullptr ? -1 : calc->calc(calc->handle, 1);
+    });
+    CHECK_EQUAL(102, result);
+    CHECK_EQUAL(2, data.intercepted_count.load());
+    CHECK_EQUAL(1, data.released_count.load());
+    celix_bundleContext_stopTracker(ctx, trkId);
+    CHECK_EQUAL(2, data.released_count.load());
+
+    celix_bundleContext_unregisterService(ctx, hookId);
+    CHECK_TRUE(celix_bundleContext_useServiceWithId(ctx, svcId, "intercept_test", &result, use));
+    CHECK_EQUAL(42, result);
+
+    celix_bundleContext_unregisterService(ctx, otherId);
+    celix_bundleContext_unregisterService(ctx, svcId);
+}
+
+TEST(CelixBundleContextServicesTests, concurrentRegistrationsTest) {
+    //note the service names are spread over the registry shards, so the registrations run concurrently
+    const int nrOfThreads = 8;
+    const int nrOfServicesPerThread = 100;
+    std::vector<std::vector<long>> svcIds(nrOfThreads);
+    std::vector<std::thread> threads{};
+    for (int t = 0; t < nrOfThreads; ++t) {
+        threads.emplace_back([this, t, &svcIds]{
+            std::string name = "concurrent_test_" + std::to_string(t);
+            for (int i = 0; i < nrOfServicesPerThread; ++i) {
+                svcIds[t].push_back(celix_bundleContext_registerService(ctx, (void*)0x42, name.c_str(), nullptr));
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    std::set<long> uniqueIds{};
+    for (int t = 0; t < nrOfThreads; ++t) {
+        std::string name = "concurrent_test_" + std::to_string(t);
+        celix_array_list_t *found = celix_bundleContext_findServices(ctx, name.c_str());
+        CHECK_EQUAL(nrOfServicesPerThread, celix_arrayList_size(found));
+        celix_arrayList_destroy(found);
+        for (long svcId : svcIds[t]) {
+            CHECK_TRUE(svcId >= 0);
+            uniqueIds.insert(svcId);
+        }
+    }
+    CHECK_EQUAL((size_t)(nrOfThreads * nrOfServicesPerThread), uniqueIds.size());
+
+    //a lookup without service name sees all shards
+    auto countAll = [this]() -> int {
+        array_list_pt refs = nullptr;
+        bundleContext_getServiceReferences(ctx, nullptr, "(objectClass=concurrent_test_*)", &refs);
+        int count = refs == nullptr ? 0 : celix_arrayList_size(refs);
+        for (int i = 0; i < count; ++i) {
+            bundleContext_ungetServiceReference(ctx, (service_reference_pt)celix_arrayList_get(refs, i));
+        }
+        if (refs != nullptr) {
+            celix_arrayList_destroy(refs);
+        }
+        return count;
+    };
+    CHECK_EQUAL(nrOfThreads * nrOfServicesPerThread, countAll());
+
+    threads.clear();
+    for (int t = 0; t < nrOfThreads; ++t) {
+        threads.emplace_back([this, t, &svcIds]{
+            for (long svcId : svcIds[t]) {
+                celix_bundleContext_unregisterService(ctx, svcId);
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    CHECK_EQUAL(0, countAll());
+}
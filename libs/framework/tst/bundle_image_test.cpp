@@ -0,0 +1,121 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *  KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+#include <cstdlib>
+#include <cstdio>
+#include <string>
+
+#include "celix_api.h"
+#include "celix_framework_factory.h"
+extern "C" {
+#include "celix_bundle_image.h"
+}
+
+#include <CppUTest/TestHarness.h>
+
+#define BUNDLE_IMAGE_TEST_FILE "bundle_image_test.img"
+
+TEST_GROUP(CelixBundleImageTests) {
+    celix_properties_t *config = nullptr;
+
+    void setup() {
+        CHECK_EQUAL(0, system("rm -rf " BUNDLE_IMAGE_TEST_FILE " " BUNDLE_IMAGE_TEST_FILE ".bundles"));
+        config = celix_properties_create();
+        celix_properties_set(config, CELIX_AUTO_START_1, "simple_test_bundle1.zip simple_test_bundle2.zip simple_test_bundle1.zip");
+        celix_properties_set(config, CELIX_AUTO_START_3, "simple_test_bundle3.zip");
+    }
+
+    void teardown() {
+        celix_properties_destroy(config);
+        CHECK_EQUAL(0, system("rm -rf " BUNDLE_IMAGE_TEST_FILE " " BUNDLE_IMAGE_TEST_FILE ".bundles"));
+    }
+
+    celix_framework_t* createFramework(const char *imageFile) {
+        celix_properties_t *properties = celix_properties_create();
+        celix_properties_set(properties, "LOGHELPER_ENABLE_STDOUT_FALLBACK", "true");
+        celix_properties_set(properties, "org.osgi.framework.storage.clean", "onFirstInit");
+        celix_properties_set(properties, "org.osgi.framework.storage", ".cacheBundleImageTestFramework");
+        celix_properties_set(properties, CELIX_AUTO_START_1, "simple_test_bundle1.zip");
+        celix_properties_set(properties, CELIX_BUNDLE_IMAGE_NAME, imageFile);
+        return celix_frameworkFactory_createFramework(properties);
+    }
+};
+
+TEST(CelixBundleImageTests, createAndOpen) {
+    CHECK_EQUAL(CELIX_SUCCESS, celix_bundleImage_create(BUNDLE_IMAGE_TEST_FILE, config));
+    celix_bundle_image_t *image = celix_bundleImage_open(BUNDLE_IMAGE_TEST_FILE);
+    CHECK(image != nullptr);
+
+    //duplicates are added once, ids are the ids of a sequential auto start install
+    CHECK_EQUAL(3, (int)celix_bundleImage_getNumberOfBundles(image));
+    CHECK_EQUAL(3L, celix_bundleImage_getHighestBundleId(image));
+    CHECK_EQUAL(1L, celix_bundleImage_getBundleId(image, 0));
+    CHECK_EQUAL(1, celix_bundleImage_getRunLevel(image, 0));
+    CHECK(std::string{celix_bundleImage_getLocation(image, 0)}.find("simple_test_bundle1.zip") != std::string::npos);
+    CHECK_EQUAL(2L, celix_bundleImage_getBundleId(image, 1));
+    CHECK(std::string{celix_bundleImage_getLocation(image, 1)}.find("simple_test_bundle2.zip") != std::string::npos);
+    CHECK_EQUAL(3L, celix_bundleImage_getBundleId(image, 2));
+    CHECK_EQUAL(3, celix_bundleImage_getRunLevel(image, 2));
+
+    celix_bundleImage_close(image);
+}
+
+TEST(CelixBundleImageTests, invalidImage) {
+    CHECK(celix_bundleImage_open("non-existing.img") == nullptr);
+
+    FILE *file = fopen(BUNDLE_IMAGE_TEST_FILE, "w");
+    fputs("not a bundle image", file);
+    fclose(file);
+    CHECK(celix_bundleImage_open(BUNDLE_IMAGE_TEST_FILE) == nullptr);
+
+    //the framework falls back to the auto start lists
+    celix_framework_t *fw = createFramework(BUNDLE_IMAGE_TEST_FILE);
+    CHECK(fw != nullptr);
+    celix_bundle_context_t *ctx = celix_framework_getFrameworkContext(fw);
+    celix_array_list_t *ids = celix_bundleContext_listBundles(ctx);
+    CHECK_EQUAL(1, celix_arrayList_size(ids));
+    celix_arrayList_destroy(ids);
+    celix_frameworkFactory_destroyFramework(fw);
+}
+
+TEST(CelixBundleImageTests, bootFromImage) {
+    CHECK_EQUAL(CELIX_SUCCESS, celix_bundleImage_create(BUNDLE_IMAGE_TEST_FILE, config));
+
+    celix_framework_t *fw = createFramework(BUNDLE_IMAGE_TEST_FILE);
+    CHECK(fw != nullptr);
+    celix_bundle_context_t *ctx = celix_framework_getFrameworkContext(fw);
+
+    //the bundles of the image are installed and started with their image ids, the auto start list is ignored
+    celix_array_list_t *ids = celix_bundleContext_listBundles(ctx);
+    CHECK_EQUAL(3, celix_arrayList_size(ids));
+    celix_arrayList_destroy(ids);
+    for (long bndId = 1; bndId <= 3; ++bndId) {
+        CHECK(celix_bundleContext_useBundle(ctx, bndId, nullptr, [](void *, const celix_bundle_t *bnd) {
+            CHECK_EQUAL(OSGI_FRAMEWORK_BUNDLE_ACTIVE, celix_bundle_getState(bnd));
+        }));
+    }
+    CHECK(celix_bundleContext_useBundle(ctx, 2, nullptr, [](void *, const celix_bundle_t *bnd) {
+        STRCMP_EQUAL("simple_test_bundle2", celix_bundle_getSymbolicName(bnd));
+    }));
+
+    //bundles installed later get ids after the image bundles
+    long bndId = celix_bundleContext_installBundle(ctx, "simple_test_bundle4.zip", false);
+    CHECK_EQUAL(4L, bndId);
+
+    celix_frameworkFactory_destroyFramework(fw);
+}
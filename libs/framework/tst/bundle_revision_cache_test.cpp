@@ -0,0 +1,143 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *  KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+#include <cstdlib>
+#include <cstdio>
+#include <string>
+#include <fstream>
+#include <sstream>
+#include <unistd.h>
+
+#include "celix_api.h"
+#include "celix_framework_factory.h"
+#include "bundle_revision.h"
+#include "manifest.h"
+
+#include <CppUTest/TestHarness.h>
+
+#define REVISION_CACHE_TEST_ROOT "bundle_revision_cache_test"
+
+namespace {
+    std::string readFile(const std::string &path) {
+        std::ifstream in{path};
+        std::stringstream content{};
+        content << in.rdbuf();
+        return content.str();
+    }
+
+    std::string symbolicName(bundle_revision_pt revision) {
+        manifest_pt manifest = nullptr;
+        CHECK_EQUAL(CELIX_SUCCESS, bundleRevision_getManifest(revision, &manifest));
+        const char *name = manifest_getValue(manifest, "Bundle-SymbolicName");
+        return name != nullptr ? name : "";
+    }
+}
+
+TEST_GROUP(CelixBundleRevisionCacheTests) {
+    void setup() {
+        CHECK_EQUAL(0, system("rm -rf " REVISION_CACHE_TEST_ROOT));
+    }
+
+    void teardown() {
+        CHECK_EQUAL(0, system("rm -rf " REVISION_CACHE_TEST_ROOT));
+    }
+
+    bundle_revision_pt createRevision(long long cacheKey) {
+        bundle_revision_pt revision = nullptr;
+        CHECK_EQUAL(CELIX_SUCCESS, bundleRevision_createCached(REVISION_CACHE_TEST_ROOT, "simple_test_bundle1.zip", 0,
+                                                               "simple_test_bundle1.zip", cacheKey, &revision));
+        CHECK(revision != nullptr);
+        return revision;
+    }
+};
+
+TEST(CelixBundleRevisionCacheTests, manifestCache) {
+    bundle_revision_pt revision = createRevision(42);
+    STRCMP_EQUAL("simple_test_bundle1", symbolicName(revision).c_str());
+    bundleRevision_destroy(revision);
+    CHECK(readFile(REVISION_CACHE_TEST_ROOT "/manifest.cache").find("celix-manifest-cache 1 42") == 0);
+
+    //the bundle zip is unchanged, so it is not extracted again. Change the extracted manifest to see which is used
+    std::ofstream{REVISION_CACHE_TEST_ROOT "/META-INF/MANIFEST.MF"} <<
+        "Manifest-Version: 1.0\nBundle-SymbolicName: changed\nBundle-Version: 1.0.0\n\n";
+
+    //same key, the cached headers are used
+    revision = createRevision(42);
+    STRCMP_EQUAL("simple_test_bundle1", symbolicName(revision).c_str());
+    bundleRevision_destroy(revision);
+
+    //other key, the manifest is parsed again and the cache is refreshed
+    revision = createRevision(43);
+    STRCMP_EQUAL("changed", symbolicName(revision).c_str());
+    bundleRevision_destroy(revision);
+    CHECK(readFile(REVISION_CACHE_TEST_ROOT "/manifest.cache").find("celix-manifest-cache 1 43") == 0);
+}
+
+TEST(CelixBundleRevisionCacheTests, cacheDisabled) {
+    bundle_revision_pt revision = createRevision(-1);
+    STRCMP_EQUAL("simple_test_bundle1", symbolicName(revision).c_str());
+    CHECK_EQUAL(CELIX_SUCCESS, bundleRevision_setCachedWiring(revision, "target exporter 1.0.0\n"));
+    char *wiring = nullptr;
+    CHECK_EQUAL(CELIX_SUCCESS, bundleRevision_getCachedWiring(revision, &wiring));
+    CHECK(wiring == nullptr);
+    bundleRevision_destroy(revision);
+
+    CHECK(access(REVISION_CACHE_TEST_ROOT "/manifest.cache", F_OK) != 0);
+    CHECK(access(REVISION_CACHE_TEST_ROOT "/wiring.cache", F_OK) != 0);
+}
+
+TEST(CelixBundleRevisionCacheTests, wiringCache) {
+    bundle_revision_pt revision = createRevision(42);
+    char *wiring = nullptr;
+    CHECK_EQUAL(CELIX_SUCCESS, bundleRevision_getCachedWiring(revision, &wiring));
+    CHECK(wiring == nullptr);
+
+    CHECK_EQUAL(CELIX_SUCCESS, bundleRevision_setCachedWiring(revision, "target exporter 1.0.0\n"));
+    CHECK_EQUAL(CELIX_SUCCESS, bundleRevision_getCachedWiring(revision, &wiring));
+    STRCMP_EQUAL("target exporter 1.0.0\n", wiring);
+    free(wiring);
+    bundleRevision_destroy(revision);
+
+    //the wiring is only valid for the same key
+    revision = createRevision(43);
+    CHECK_EQUAL(CELIX_SUCCESS, bundleRevision_getCachedWiring(revision, &wiring));
+    CHECK(wiring == nullptr);
+    bundleRevision_destroy(revision);
+}
+
+TEST(CelixBundleRevisionCacheTests, restartWithCache) {
+    for (int i = 0; i < 2; ++i) {
+        celix_properties_t *properties = celix_properties_create();
+        celix_properties_set(properties, "LOGHELPER_ENABLE_STDOUT_FALLBACK", "true");
+        celix_properties_set(properties, "org.osgi.framework.storage.clean", i == 0 ? "onFirstInit" : "none");
+        celix_properties_set(properties, "org.osgi.framework.storage", REVISION_CACHE_TEST_ROOT);
+        celix_properties_set(properties, CELIX_AUTO_START_1, "simple_test_bundle1.zip");
+        celix_framework_t *fw = celix_frameworkFactory_createFramework(properties);
+        CHECK(fw != nullptr);
+        celix_bundle_context_t *ctx = celix_framework_getFrameworkContext(fw);
+
+        //on the restart the bundle is installed from the cache, with the cached manifest and wiring
+        CHECK(celix_bundleContext_useBundle(ctx, 1, nullptr, [](void *, const celix_bundle_t *bnd) {
+            CHECK_EQUAL(OSGI_FRAMEWORK_BUNDLE_ACTIVE, celix_bundle_getState(bnd));
+            STRCMP_EQUAL("simple_test_bundle1", celix_bundle_getSymbolicName(bnd));
+        }));
+        celix_frameworkFactory_destroyFramework(fw);
+    }
+    CHECK_EQUAL(0, system("test -n \"$(find " REVISION_CACHE_TEST_ROOT " -name manifest.cache)\""));
+    CHECK_EQUAL(0, system("test -n \"$(find " REVISION_CACHE_TEST_ROOT " -name wiring.cache)\""));
+}
@@ -0,0 +1,168 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *  KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <thread>
+#include <chrono>
+#include <future>
+
+#include "celix_api.h"
+#include "celix_framework_factory.h"
+#include "celix_thread_pool.h"
+#include "celix/Promise.h"
+#include "celix/ServiceTracker.h"
+#include "celix/dm/Coroutine.h"
+
+#include <CppUTest/TestHarness.h>
+#include <CppUTest/CommandLineTestRunner.h>
+
+namespace {
+    struct calc {
+        int value;
+    };
+
+    struct coroutine_result {
+        std::promise<void> done{};
+        std::thread::id resumedOn{};
+        int value{-1};
+        celix_status_t status{CELIX_SUCCESS};
+    };
+
+    celix::dm::Task switchThread(celix_thread_pool_t *executor, coroutine_result &result) {
+        co_await celix::dm::resumeOn(executor);
+        result.resumedOn = std::this_thread::get_id();
+        result.done.set_value();
+    }
+
+    celix::dm::Task useCalc(celix::ServiceTracker<calc> &tracker, celix_thread_pool_t *executor, coroutine_result &result) {
+        celix::ServiceHandle<calc> handle = co_await celix::dm::awaitService(tracker, executor);
+        result.resumedOn = std::this_thread::get_id();
+        result.value = handle ? handle->value : -1;
+        result.done.set_value();
+    }
+
+    celix::dm::Task waitForPromise(celix::Promise<int> &promise, celix_thread_pool_t *executor, coroutine_result &result) {
+        auto r = co_await celix::dm::awaitPromise(promise, executor);
+        result.resumedOn = std::this_thread::get_id();
+        result.status = r.status;
+        result.value = r.status == CELIX_SUCCESS ? r.value : -1;
+        result.done.set_value();
+    }
+
+    bool waitDone(coroutine_result &result) {
+        return result.done.get_future().wait_for(std::chrono::seconds{5}) == std::future_status::ready;
+    }
+}
+
+TEST_GROUP(CelixCoroutineTests) {
+    celix_framework_t *fw = nullptr;
+    celix_bundle_context_t *ctx = nullptr;
+    celix_thread_pool_t *executor = nullptr;
+
+    void setup() {
+        properties_t *properties = properties_create();
+        properties_set(properties, "LOGHELPER_ENABLE_STDOUT_FALLBACK", "true");
+        properties_set(properties, "org.osgi.framework.storage.clean", "onFirstInit");
+        properties_set(properties, "org.osgi.framework.storage", ".cacheCoroutineTestFramework");
+
+        fw = celix_frameworkFactory_createFramework(properties);
+        ctx = framework_getContext(fw);
+
+        celix_thread_pool_options_t opts{};
+        opts.nrOfThreads = 2;
+        opts.name = "coroutine_test";
+        executor = celix_threadPool_create(&opts);
+        CHECK(executor != nullptr);
+    }
+
+    void teardown() {
+        celix_threadPool_destroy(executor);
+        celix_frameworkFactory_destroyFramework(fw);
+    }
+};
+
+TEST(CelixCoroutineTests, resumeOnExecutor) {
+    coroutine_result result{};
+    switchThread(executor, result);
+    CHECK(waitDone(result));
+    CHECK(result.resumedOn != std::this_thread::get_id());
+}
+
+TEST(CelixCoroutineTests, awaitServiceAlreadyPresent) {
+    calc svc{1};
+    long svcId = celix_bundleContext_registerService(ctx, &svc, "calc", nullptr);
+    celix::ServiceTracker<calc> tracker{ctx, "calc"};
+
+    //the service is tracked, so the coroutine does not suspend
+    coroutine_result result{};
+    useCalc(tracker, executor, result);
+    CHECK(waitDone(result));
+    CHECK(result.resumedOn == std::this_thread::get_id());
+    CHECK_EQUAL(1, result.value);
+
+    celix_bundleContext_unregisterService(ctx, svcId);
+}
+
+TEST(CelixCoroutineTests, awaitServiceRegisteredLater) {
+    celix::ServiceTracker<calc> tracker{ctx, "calc"};
+
+    coroutine_result result{};
+    std::future<void> done = result.done.get_future();
+    useCalc(tracker, executor, result);
+    CHECK(done.wait_for(std::chrono::milliseconds{10}) == std::future_status::timeout);
+
+    calc svc{2};
+    long svcId = celix_bundleContext_registerService(ctx, &svc, "calc", nullptr);
+    CHECK(done.wait_for(std::chrono::seconds{5}) == std::future_status::ready);
+    CHECK(result.resumedOn != std::this_thread::get_id());
+    CHECK_EQUAL(2, result.value);
+
+    celix_bundleContext_unregisterService(ctx, svcId);
+}
+
+TEST(CelixCoroutineTests, awaitPromise) {
+    celix::Promise<int> promise{};
+    coroutine_result result{};
+    std::future<void> done = result.done.get_future();
+    waitForPromise(promise, executor, result);
+    CHECK(done.wait_for(std::chrono::milliseconds{10}) == std::future_status::timeout);
+
+    CHECK(promise.resolve(42));
+    CHECK(done.wait_for(std::chrono::seconds{5}) == std::future_status::ready);
+    CHECK_EQUAL(CELIX_SUCCESS, result.status);
+    CHECK_EQUAL(42, result.value);
+
+    //already resolved, the coroutine does not suspend
+    coroutine_result direct{};
+    waitForPromise(promise, executor, direct);
+    CHECK(waitDone(direct));
+    CHECK(direct.resumedOn == std::this_thread::get_id());
+    CHECK_EQUAL(42, direct.value);
+}
+
+TEST(CelixCoroutineTests, awaitFailedPromise) {
+    celix::Promise<int> promise{};
+    coroutine_result result{};
+    std::future<void> done = result.done.get_future();
+    waitForPromise(promise, executor, result);
+
+    CHECK(promise.fail(CELIX_ILLEGAL_STATE));
+    CHECK(done.wait_for(std::chrono::seconds{5}) == std::future_status::ready);
+    CHECK_EQUAL(CELIX_ILLEGAL_STATE, result.status);
+    CHECK_EQUAL(-1, result.value);
+}
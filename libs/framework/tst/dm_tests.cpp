@@ -17,7 +17,12 @@
  * under the License.
  */
 
+#include <atomic>
+#include <string>
+#include <vector>
+
 #include "celix_api.h"
+#include "celix/dm/Properties.h"
 
 #include <CppUTest/TestHarness.h>
 #include <CppUTest/CommandLineTestRunner.h>
@@ -33,6 +38,7 @@ TEST_GROUP(DepenencyManagerTests) {
         properties_set(properties, "LOGHELPER_ENABLE_STDOUT_FALLBACK", "true");
         properties_set(properties, "org.osgi.framework.storage.clean", "onFirstInit");
         properties_set(properties, "org.osgi.framework.storage", ".cacheBundleContextTestFramework");
+        properties_set(properties, "CELIX_DM_COMPONENT_START_THREADS", "4");
 
         fw = celix_frameworkFactory_createFramework(properties);
         ctx = framework_getContext(fw);
@@ -71,3 +77,324 @@ TEST(DepenencyManagerTests, TestCheckActive) {
     celix_dependencyManager_add(mng, cmp);
     CHECK_FALSE(celix_dependencyManager_areComponentsActive(mng));
 }
+
+TEST(DepenencyManagerTests, ComponentWithManyRequiredDependencies) {
+    const int nrOfDeps = 20;
+    std::vector<long> svcIds{};
+    for (int i = 0; i < nrOfDeps; ++i) {
+        std::string name = std::string{"svc"} + std::to_string(i);
+        svcIds.push_back(celix_bundleContext_registerService(ctx, (void*)0x42, name.c_str(), nullptr));
+    }
+
+    struct cmp_data {
+        int startCount;
+        int setCount;
+    } data{0, 0};
+
+    auto *mng = celix_bundleContext_getDependencyManager(ctx);
+    auto *cmp = celix_dmComponent_create(ctx, "test1");
+    celix_dmComponent_setImplementation(cmp, &data);
+    celix_dmComponent_setCallbacks(cmp, nullptr, [](void *handle) -> int {
+        static_cast<cmp_data*>(handle)->startCount += 1;
+        return CELIX_SUCCESS;
+    }, nullptr, nullptr);
+    for (int i = 0; i < nrOfDeps; ++i) {
+        std::string name = std::string{"svc"} + std::to_string(i);
+        auto *dep = celix_dmServiceDependency_create();
+        celix_dmServiceDependency_setService(dep, name.c_str(), nullptr, nullptr);
+        celix_dmServiceDependency_setRequired(dep, true);
+        celix_dm_service_dependency_callback_options_t opts{};
+        opts.set = [](void *handle, void *svc) -> int {
+            if (svc != nullptr) {
+                static_cast<cmp_data*>(handle)->setCount += 1;
+            }
+            return CELIX_SUCCESS;
+        };
+        celix_dmServiceDependency_setCallbacksWithOptions(dep, &opts);
+        celix_dmComponent_addServiceDependency(cmp, dep);
+    }
+
+    //note all dependencies are available when the component is started, the added events come as a burst
+    celix_dependencyManager_add(mng, cmp);
+    CHECK_TRUE(celix_dependencyManager_areComponentsActive(mng));
+    CHECK_EQUAL(1, data.startCount);
+    CHECK(data.setCount >= nrOfDeps);
+
+    //removing a required dependency deactivates the component
+    celix_bundleContext_unregisterService(ctx, svcIds[0]);
+    CHECK_FALSE(celix_dependencyManager_areComponentsActive(mng));
+
+    celix_dependencyManager_removeAllComponents(mng);
+    for (size_t i = 1; i < svcIds.size(); ++i) {
+        celix_bundleContext_unregisterService(ctx, svcIds[i]);
+    }
+}
+
+TEST(DepenencyManagerTests, AddComponentsInParallel) {
+    const size_t nrOfComponents = 16;
+    std::atomic<int> startCount{0};
+    std::vector<celix_dm_component_t*> cmps{};
+    for (size_t i = 0; i < nrOfComponents; ++i) {
+        std::string name = std::string{"cmp"} + std::to_string(i);
+        auto *cmp = celix_dmComponent_create(ctx, name.c_str());
+        celix_dmComponent_setImplementation(cmp, &startCount);
+        celix_dmComponent_setCallbacks(cmp, nullptr, [](void *handle) -> int {
+            static_cast<std::atomic<int>*>(handle)->fetch_add(1);
+            return CELIX_SUCCESS;
+        }, nullptr, nullptr);
+        celix_dmComponent_setCLanguageProperty(cmp, true);
+        celix_dmComponent_addInterface(cmp, "provided", nullptr, (void*)0x42, nullptr);
+        cmps.push_back(cmp);
+    }
+
+    auto *mng = celix_bundleContext_getDependencyManager(ctx);
+    celix_status_t status = celix_dependencyManager_addComponents(mng, cmps.data(), cmps.size());
+    CHECK_EQUAL(CELIX_SUCCESS, status);
+    CHECK_EQUAL(nrOfComponents, celix_dependencyManager_nrOfComponents(mng));
+    CHECK_TRUE(celix_dependencyManager_areComponentsActive(mng));
+    CHECK_EQUAL((int)nrOfComponents, startCount.load());
+
+    celix_array_list_t *provided = celix_bundleContext_findServices(ctx, "provided");
+    CHECK_EQUAL(nrOfComponents, celix_arrayList_size(provided));
+    celix_arrayList_destroy(provided);
+}
+
+TEST(DepenencyManagerTests, PropertiesView) {
+    auto *props = celix_properties_create();
+    celix_properties_set(props, "name", "value");
+    celix_properties_setLong(props, "long", 42);
+    celix_properties_setDouble(props, "double", 1.5);
+    celix_properties_setBool(props, "bool", true);
+
+    celix::dm::PropertiesView view{props};
+    CHECK_EQUAL(4, view.size());
+    CHECK_FALSE(view.empty());
+    STRCMP_EQUAL("value", view.get("name"));
+    STRCMP_EQUAL("value", view.get(std::string{"name"}));
+    CHECK_TRUE(view.get("missing") == nullptr);
+    STRCMP_EQUAL("default", view.get("missing", "default"));
+    CHECK_EQUAL(42, view.getAsLong("long", -1));
+    CHECK_EQUAL(-1, view.getAsLong("missing", -1));
+    DOUBLES_EQUAL(1.5, view.getAsDouble("double", 0.0), 0.001);
+    CHECK_TRUE(view.getAsBool("bool", false));
+    CHECK_TRUE(view.has("name"));
+    CHECK_FALSE(view.has("missing"));
+
+    int count = 0;
+    view.forEach([&count](const char *, const char *) {
+        count++;
+    });
+    CHECK_EQUAL(4, count);
+
+    celix::dm::Properties copy = view.toProperties();
+    CHECK_EQUAL(4, copy.size());
+    CHECK_EQUAL(std::string{"value"}, copy["name"]);
+    CHECK_EQUAL(std::string{"42"}, copy["long"]);
+
+    celix::dm::PropertiesView emptyView{nullptr};
+    CHECK_TRUE(emptyView.empty());
+    STRCMP_EQUAL("default", emptyView.get("name", "default"));
+    CHECK_TRUE(emptyView.toProperties().empty());
+
+    celix_properties_destroy(props);
+}
+
+namespace {
+    struct test_svc {
+        int value;
+    };
+
+    class TestItf {
+    public:
+        virtual ~TestItf() = default;
+    };
+
+    class TestItfImpl : public TestItf {};
+
+    /**
+     * Component for the compile time resolved (trampoline) callbacks.
+     */
+    struct TrampolineCmp {
+        std::atomic<int> setCount{0};
+        std::atomic<int> addCount{0};
+        std::atomic<int> removeCount{0};
+        std::atomic<const void*> lastSet{nullptr};
+        std::atomic<long> lastRank{-1};
+
+        void set(const test_svc* svc) {
+            setCount++;
+            lastSet = svc;
+        }
+        void setWithProps(const test_svc* svc, const celix::dm::PropertiesView& props) {
+            setCount++;
+            lastSet = svc;
+            lastRank = props.getAsLong("test.rank", -1);
+        }
+        void add(const test_svc*) { addCount++; }
+        void remove(const test_svc*) { removeCount++; }
+        void addWithProps(const test_svc*, const celix::dm::PropertiesView& props) {
+            addCount++;
+            lastRank = props.getAsLong("test.rank", -1);
+        }
+        void removeWithProps(const test_svc*, const celix::dm::PropertiesView& props) {
+            removeCount++;
+            lastRank = props.getAsLong("test.rank", -1);
+        }
+
+        void setCxx(TestItf* svc) {
+            setCount++;
+            lastSet = svc;
+        }
+        void addCxx(TestItf*, const celix::dm::PropertiesView& props) {
+            addCount++;
+            lastRank = props.getAsLong("test.rank", -1);
+        }
+        void removeCxx(TestItf*, const celix::dm::PropertiesView&) { removeCount++; }
+    };
+}
+
+TEST_GROUP(DependencyManagerTrampolineTests) {
+    framework_t* fw = nullptr;
+    bundle_context_t *ctx = nullptr;
+    celix::dm::DependencyManager *mng = nullptr;
+    test_svc svc{42};
+
+    void setup() {
+        auto *properties = properties_create();
+        properties_set(properties, "LOGHELPER_ENABLE_STDOUT_FALLBACK", "true");
+        properties_set(properties, "org.osgi.framework.storage.clean", "onFirstInit");
+        properties_set(properties, "org.osgi.framework.storage", ".cacheBundleContextTestFramework");
+        fw = celix_frameworkFactory_createFramework(properties);
+        ctx = framework_getContext(fw);
+        mng = new celix::dm::DependencyManager{ctx};
+    }
+
+    void teardown() {
+        mng->stop();
+        delete mng;
+        celix_frameworkFactory_destroyFramework(fw);
+    }
+
+    long registerSvc(long rank, const char *lang = CELIX_FRAMEWORK_SERVICE_C_LANGUAGE, void *service = nullptr) {
+        auto *props = celix_properties_create();
+        celix_properties_setLong(props, "test.rank", rank);
+        celix_properties_setLong(props, OSGI_FRAMEWORK_SERVICE_RANKING, rank);
+        celix_service_registration_options_t opts{};
+        opts.svc = service == nullptr ? &svc : service;
+        opts.serviceName = "test_svc";
+        opts.serviceLanguage = lang;
+        opts.properties = props;
+        return celix_bundleContext_registerServiceWithOptions(ctx, &opts);
+    }
+};
+
+TEST(DependencyManagerTrampolineTests, SetCallback) {
+    auto &cmp = mng->createComponent<TrampolineCmp>();
+    cmp.createCServiceDependency<test_svc>("test_svc").setCallbacks<&TrampolineCmp::set>();
+    mng->start();
+    auto &instance = cmp.getInstance();
+
+    long svcId = registerSvc(1);
+    CHECK(instance.setCount.load() >= 1);
+    CHECK(instance.lastSet.load() == &svc);
+
+    celix_bundleContext_unregisterService(ctx, svcId);
+    CHECK(instance.lastSet.load() == nullptr);
+}
+
+TEST(DependencyManagerTrampolineTests, AddRemoveCallbacks) {
+    auto &cmp = mng->createComponent<TrampolineCmp>();
+    cmp.createCServiceDependency<test_svc>("test_svc").setCallbacks<&TrampolineCmp::add, &TrampolineCmp::remove>();
+    mng->start();
+    auto &instance = cmp.getInstance();
+
+    long svcId1 = registerSvc(1);
+    long svcId2 = registerSvc(2);
+    CHECK_EQUAL(2, instance.addCount.load());
+    CHECK_EQUAL(0, instance.removeCount.load());
+
+    celix_bundleContext_unregisterService(ctx, svcId1);
+    celix_bundleContext_unregisterService(ctx, svcId2);
+    CHECK_EQUAL(2, instance.addCount.load());
+    CHECK_EQUAL(2, instance.removeCount.load());
+}
+
+TEST(DependencyManagerTrampolineTests, PropertiesViewCallbacks) {
+    auto &setCmp = mng->createComponent<TrampolineCmp>();
+    setCmp.createCServiceDependency<test_svc>("test_svc").setCallbacks<&TrampolineCmp::setWithProps>();
+    auto &addCmp = mng->createComponent<TrampolineCmp>();
+    addCmp.createCServiceDependency<test_svc>("test_svc")
+            .setCallbacks<&TrampolineCmp::addWithProps, &TrampolineCmp::removeWithProps>();
+    mng->start();
+
+    long svcId = registerSvc(7);
+    CHECK(setCmp.getInstance().lastSet.load() == &svc);
+    CHECK_EQUAL(7, setCmp.getInstance().lastRank.load());
+    CHECK_EQUAL(1, addCmp.getInstance().addCount.load());
+    CHECK_EQUAL(7, addCmp.getInstance().lastRank.load());
+
+    //a higher ranking service is set, the properties are of that service
+    long svcId2 = registerSvc(8);
+    CHECK_EQUAL(8, setCmp.getInstance().lastRank.load());
+
+    addCmp.getInstance().lastRank = -1;
+    celix_bundleContext_unregisterService(ctx, svcId2);
+    CHECK_EQUAL(1, addCmp.getInstance().removeCount.load());
+    CHECK_EQUAL(8, addCmp.getInstance().lastRank.load());
+    CHECK_EQUAL(7, setCmp.getInstance().lastRank.load());
+    celix_bundleContext_unregisterService(ctx, svcId);
+}
+
+TEST(DependencyManagerTrampolineTests, CxxServiceDependencyCallbacks) {
+    TestItfImpl impl{};
+    auto &setCmp = mng->createComponent<TrampolineCmp>();
+    setCmp.createServiceDependency<TestItf>("test_svc").setCallbacks<&TrampolineCmp::setCxx>();
+    auto &addCmp = mng->createComponent<TrampolineCmp>();
+    addCmp.createServiceDependency<TestItf>("test_svc").setCallbacks<&TrampolineCmp::addCxx, &TrampolineCmp::removeCxx>();
+    mng->start();
+
+    TestItf *itf = &impl;
+    long svcId = registerSvc(3, CELIX_FRAMEWORK_SERVICE_CXX_LANGUAGE, itf);
+    CHECK(setCmp.getInstance().lastSet.load() == itf);
+    CHECK_EQUAL(1, addCmp.getInstance().addCount.load());
+    CHECK_EQUAL(3, addCmp.getInstance().lastRank.load());
+
+    celix_bundleContext_unregisterService(ctx, svcId);
+    CHECK(setCmp.getInstance().lastSet.load() == nullptr);
+    CHECK_EQUAL(1, addCmp.getInstance().removeCount.load());
+}
+
+TEST(DependencyManagerTrampolineTests, FunctionReplacesTrampoline) {
+    std::atomic<int> fnAddCount{0};
+    std::atomic<int> fnRemoveCount{0};
+    auto &cmp = mng->createComponent<TrampolineCmp>();
+    cmp.createCServiceDependency<test_svc>("test_svc")
+            .setCallbacks<&TrampolineCmp::add, &TrampolineCmp::remove>()
+            .setCallbacks(
+                    [&fnAddCount](const test_svc*, const celix::dm::PropertiesView&) { fnAddCount++; },
+                    [&fnRemoveCount](const test_svc*, const celix::dm::PropertiesView&) { fnRemoveCount++; });
+    mng->start();
+
+    long svcId = registerSvc(1);
+    celix_bundleContext_unregisterService(ctx, svcId);
+    CHECK_EQUAL(1, fnAddCount.load());
+    CHECK_EQUAL(1, fnRemoveCount.load());
+    CHECK_EQUAL(0, cmp.getInstance().addCount.load());
+    CHECK_EQUAL(0, cmp.getInstance().removeCount.load());
+}
+
+TEST(DependencyManagerTrampolineTests, TrampolineReplacesFunction) {
+    std::atomic<int> fnSetCount{0};
+    auto &cmp = mng->createComponent<TrampolineCmp>();
+    cmp.createCServiceDependency<test_svc>("test_svc")
+            .setCallbacks([&fnSetCount](const test_svc*, const celix::dm::PropertiesView&) { fnSetCount++; })
+            .setCallbacks<&TrampolineCmp::set>();
+    mng->start();
+    int setCountBefore = cmp.getInstance().setCount.load(); //note set(nullptr) can be called when the cmp starts
+
+    long svcId = registerSvc(1);
+    CHECK_EQUAL(setCountBefore + 1, cmp.getInstance().setCount.load());
+    CHECK(cmp.getInstance().lastSet.load() == &svc);
+    celix_bundleContext_unregisterService(ctx, svcId);
+    CHECK_EQUAL(0, fnSetCount.load());
+}
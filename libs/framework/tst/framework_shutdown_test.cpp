@@ -0,0 +1,141 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *  KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+#include <thread>
+#include <chrono>
+#include <mutex>
+#include <set>
+#include <vector>
+
+#include "celix_api.h"
+#include "celix_framework_factory.h"
+
+#include <CppUTest/TestHarness.h>
+
+namespace {
+    /**
+     * Records the order in which the bundles unregister their marker service, i.e. the order in which they are stopped.
+     */
+    struct stop_record {
+        std::mutex mutex{};
+        std::vector<long> stopped{};
+        std::set<std::thread::id> threads{};
+        long slowBndId{-1};
+        int slowStopInMs{0};
+
+        static celix_status_t serviceChanged(void *listener, celix_service_event_t *event) {
+            if (event->type != OSGI_FRAMEWORK_SERVICE_EVENT_UNREGISTERING) {
+                return CELIX_SUCCESS;
+            }
+            auto *rec = static_cast<stop_record*>(static_cast<celix_service_listener_t*>(listener)->handle);
+            celix_bundle_t *owner = nullptr;
+            serviceReference_getBundle(event->reference, &owner);
+            long bndId = celix_bundle_getId(owner);
+            int delayInMs = bndId == rec->slowBndId ? rec->slowStopInMs : 100;
+            std::this_thread::sleep_for(std::chrono::milliseconds{delayInMs});
+            std::lock_guard<std::mutex> lock{rec->mutex};
+            rec->stopped.push_back(bndId);
+            rec->threads.insert(std::this_thread::get_id());
+            return CELIX_SUCCESS;
+        }
+    };
+}
+
+TEST_GROUP(CelixFrameworkShutdownTests) {
+    celix_framework_t *fw = nullptr;
+    celix_bundle_context_t *ctx = nullptr;
+    stop_record rec{};
+    long bndIds[3] = {-1, -1, -1};
+    int marker = 0;
+    celix_service_listener_t listener{};
+
+    void createFramework(const char *threads, const char *timeout) {
+        celix_properties_t *properties = celix_properties_create();
+        celix_properties_set(properties, "LOGHELPER_ENABLE_STDOUT_FALLBACK", "true");
+        celix_properties_set(properties, "org.osgi.framework.storage.clean", "onFirstInit");
+        celix_properties_set(properties, "org.osgi.framework.storage", ".cacheFrameworkShutdownTestFramework");
+        celix_properties_set(properties, CELIX_FRAMEWORK_SHUTDOWN_THREADS_NAME, threads);
+        celix_properties_set(properties, CELIX_FRAMEWORK_SHUTDOWN_BUNDLE_TIMEOUT_NAME, timeout);
+        fw = celix_frameworkFactory_createFramework(properties);
+        ctx = celix_framework_getFrameworkContext(fw);
+
+        const char *locations[3] = {"simple_test_bundle1.zip", "simple_test_bundle2.zip", "simple_test_bundle3.zip"};
+        for (int i = 0; i < 3; ++i) {
+            bndIds[i] = celix_bundleContext_installBundle(ctx, locations[i], true);
+            CHECK(bndIds[i] >= 0);
+            celix_bundleContext_registerService(bundleContext(bndIds[i]), &marker, "marker", nullptr);
+        }
+
+        //note the service listener is called on the thread stopping the bundle
+        listener.handle = &rec;
+        listener.serviceChanged = stop_record::serviceChanged;
+        CHECK_EQUAL(CELIX_SUCCESS, bundleContext_addServiceListener(ctx, &listener, "(objectClass=marker)"));
+    }
+
+    celix_bundle_context_t* bundleContext(long bndId) {
+        celix_bundle_context_t *bndCtx = nullptr;
+        celix_framework_useBundle(fw, true, bndId, &bndCtx, [](void *handle, const celix_bundle_t *bnd) {
+            bundle_getContext((celix_bundle_t*)bnd, static_cast<celix_bundle_context_t**>(handle));
+        });
+        CHECK(bndCtx != nullptr);
+        return bndCtx;
+    }
+
+    double shutdown() {
+        auto start = std::chrono::steady_clock::now();
+        celix_frameworkFactory_destroyFramework(fw);
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    }
+};
+
+TEST(CelixFrameworkShutdownTests, usersStopBeforeProviders) {
+    createFramework("1", "0");
+    //the first installed bundle uses a service of the last installed bundle
+    celix_bundle_context_t *providerCtx = bundleContext(bndIds[2]);
+    celix_bundleContext_registerService(providerCtx, &marker, "provided", nullptr);
+    //the reference is released by the framework when the user bundle stops
+    service_reference_pt ref = nullptr;
+    bundleContext_getServiceReference(bundleContext(bndIds[0]), "provided", &ref);
+    CHECK(ref != nullptr);
+
+    shutdown();
+    std::vector<long> expected{bndIds[1], bndIds[0], bndIds[2]};
+    CHECK(expected == rec.stopped);
+    CHECK_EQUAL(1, (int)rec.threads.size());
+}
+
+TEST(CelixFrameworkShutdownTests, independentBundlesStopConcurrently) {
+    createFramework("4", "0");
+    double duration = shutdown();
+
+    CHECK_EQUAL(3, (int)rec.stopped.size());
+    CHECK_EQUAL(3, (int)rec.threads.size());
+    CHECK(duration < 0.25); //sequential takes at least 0.3 seconds
+}
+
+TEST(CelixFrameworkShutdownTests, slowBundleDoesNotBlockShutdown) {
+    createFramework("1", "0.2");
+    //the last installed bundle is stopped first and takes longer than the timeout
+    rec.slowBndId = bndIds[2];
+    rec.slowStopInMs = 1000;
+    shutdown();
+
+    //the other bundles are stopped while the slow bundle is still stopping, but the shutdown waits for all stops
+    std::vector<long> expected{bndIds[1], bndIds[0], bndIds[2]};
+    CHECK(expected == rec.stopped);
+}
@@ -0,0 +1,157 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *  KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+#include <dlfcn.h>
+#include <dirent.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <string>
+#include <vector>
+
+#include "celix_api.h"
+#include "celix_framework_factory.h"
+#include "framework_private.h"
+
+#include <CppUTest/TestHarness.h>
+
+TEST_GROUP(CelixLibraryPreloadTests) {
+    celix_framework_t* createFramework(const char *key, const char *value, const char *cacheDir = ".cacheLibraryPreloadTestFramework") {
+        celix_properties_t *properties = celix_properties_create();
+        celix_properties_set(properties, "LOGHELPER_ENABLE_STDOUT_FALLBACK", "true");
+        celix_properties_set(properties, "org.osgi.framework.storage.clean", "onFirstInit");
+        celix_properties_set(properties, "org.osgi.framework.storage", cacheDir);
+        celix_properties_set(properties, key, value);
+        celix_framework_t *fw = celix_frameworkFactory_createFramework(properties);
+        CHECK(fw != nullptr);
+        return fw;
+    }
+
+    /**
+     * Returns the paths of the libraries in the shared library store, skipping hidden (temporary) files.
+     */
+    std::vector<std::string> storeEntries(const char *storeDir) {
+        std::vector<std::string> entries{};
+        DIR *dir = opendir(storeDir);
+        if (dir != nullptr) {
+            struct dirent *entry;
+            while ((entry = readdir(dir)) != nullptr) {
+                if (entry->d_name[0] != '.') {
+                    entries.emplace_back(std::string{storeDir} + "/" + entry->d_name);
+                }
+            }
+            closedir(dir);
+        }
+        return entries;
+    }
+
+    void clearStore(const char *storeDir) {
+        for (auto &entry : storeEntries(storeDir)) {
+            unlink(entry.c_str());
+        }
+        rmdir(storeDir);
+    }
+
+    /**
+     * Installs and starts the bundle, the activator start of which fails. Returns whether the bundle library was loaded.
+     */
+    bool installBundleWithLibrary(celix_framework_t *fw) {
+        long bndId = celix_bundleContext_installBundle(celix_framework_getFrameworkContext(fw), "bundle_with_exception.zip", true);
+        CHECK(bndId > 0);
+        bool resolved = false;
+        celix_framework_useBundle(fw, false, bndId, &resolved, [](void *handle, const celix_bundle_t *bnd) {
+            *static_cast<bool*>(handle) = celix_bundle_getState(bnd) == OSGI_FRAMEWORK_BUNDLE_RESOLVED;
+        });
+        return resolved;
+    }
+};
+
+TEST(CelixLibraryPreloadTests, preloadLibraries) {
+    CHECK(dlopen(SUBLIB_PATH, RTLD_LAZY | RTLD_NOLOAD) == nullptr);
+
+    //libraries which cannot be loaded are skipped
+    celix_framework_t *fw = createFramework(CELIX_PRELOAD_LIBRARIES_NAME, SUBLIB_PATH ", non-existing.so, ");
+    CHECK_EQUAL(1, celix_arrayList_size(fw->preloadedLibraries));
+
+    //loaded with global symbol visibility
+    void *handle = dlopen(SUBLIB_PATH, RTLD_LAZY | RTLD_NOLOAD);
+    CHECK(handle != nullptr);
+    dlclose(handle);
+
+    //and unloaded when the framework is destroyed
+    celix_frameworkFactory_destroyFramework(fw);
+    CHECK(dlopen(SUBLIB_PATH, RTLD_LAZY | RTLD_NOLOAD) == nullptr);
+}
+
+TEST(CelixLibraryPreloadTests, immediateBinding) {
+    celix_framework_t *fw = createFramework(CELIX_LOAD_BUNDLES_WITH_IMMEDIATE_BINDING, "true");
+    celix_bundle_context_t *ctx = celix_framework_getFrameworkContext(fw);
+
+    //the activator is found and its start is called, which fails
+    long bndId = celix_bundleContext_installBundle(ctx, "bundle_with_exception.zip", true);
+    CHECK(bndId > 0);
+    bool called = celix_framework_useBundle(fw, false, bndId, nullptr, [](void *, const celix_bundle_t *bnd) {
+        CHECK_EQUAL(OSGI_FRAMEWORK_BUNDLE_RESOLVED, celix_bundle_getState(bnd));
+    });
+    CHECK_TRUE(called);
+
+    celix_frameworkFactory_destroyFramework(fw);
+}
+
+TEST(CelixLibraryPreloadTests, sharedLibraryStore) {
+    const char *storeDir = ".sharedLibraryStoreTest";
+    clearStore(storeDir);
+
+    //the library is published in the store and loaded from there
+    celix_framework_t *fw1 = createFramework(CELIX_SHARED_LIBRARY_STORE_NAME, storeDir);
+    CHECK_TRUE(installBundleWithLibrary(fw1));
+    std::vector<std::string> entries = storeEntries(storeDir);
+    CHECK_EQUAL(1, entries.size());
+    CHECK(entries[0].find("bundle_with_exception") != std::string::npos);
+    struct stat st{};
+    CHECK_EQUAL(0, stat(entries[0].c_str(), &st));
+    CHECK_EQUAL(0444, st.st_mode & 0777);
+    void *handle = dlopen(entries[0].c_str(), RTLD_LAZY | RTLD_NOLOAD);
+    CHECK(handle != nullptr);
+    dlclose(handle);
+
+    //a second framework in the same process uses its own copy, the store entry is reused
+    celix_framework_t *fw2 = createFramework(CELIX_SHARED_LIBRARY_STORE_NAME, storeDir, ".cacheSharedLibraryStoreTestFramework2");
+    CHECK_TRUE(installBundleWithLibrary(fw2));
+    CHECK_EQUAL(1, storeEntries(storeDir).size());
+    celix_frameworkFactory_destroyFramework(fw2);
+    celix_frameworkFactory_destroyFramework(fw1);
+
+    //a store entry with other content (a hash collision) is not used and not replaced
+    chmod(entries[0].c_str(), 0644);
+    int fd = open(entries[0].c_str(), O_WRONLY);
+    CHECK(fd >= 0);
+    CHECK_EQUAL(4, write(fd, "XXXX", 4));
+    close(fd);
+    celix_framework_t *fw3 = createFramework(CELIX_SHARED_LIBRARY_STORE_NAME, storeDir);
+    CHECK_TRUE(installBundleWithLibrary(fw3));
+    CHECK_EQUAL(1, storeEntries(storeDir).size());
+    char magic[4] = {0};
+    fd = open(entries[0].c_str(), O_RDONLY);
+    CHECK_EQUAL(4, read(fd, magic, 4));
+    close(fd);
+    CHECK_EQUAL(0, memcmp(magic, "XXXX", 4));
+    celix_frameworkFactory_destroyFramework(fw3);
+
+    clearStore(storeDir);
+}
@@ -0,0 +1,185 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *  KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <string>
+#include <vector>
+
+#include "celix_api.h"
+#include "celix_framework_factory.h"
+#include "listener_hook_service.h"
+#include "service_registry.h"
+extern "C" {
+#include "framework_private.h"
+}
+
+#include <CppUTest/TestHarness.h>
+
+namespace {
+    struct hook_call {
+        bool removed;
+        std::vector<std::string> filters;
+    };
+
+    struct hook_record {
+        std::vector<hook_call> calls{};
+
+        static void record(void *handle, celix_array_list_t *listeners, bool removed) {
+            auto *rec = static_cast<hook_record*>(handle);
+            hook_call call{removed, {}};
+            for (int i = 0; i < celix_arrayList_size(listeners); ++i) {
+                auto *info = static_cast<celix_listener_hook_info_t*>(celix_arrayList_get(listeners, i));
+                call.filters.emplace_back(info->filter == nullptr ? "" : info->filter);
+            }
+            rec->calls.push_back(call);
+        }
+
+        static celix_status_t added(void *handle, celix_array_list_t *listeners) {
+            record(handle, listeners, false);
+            return CELIX_SUCCESS;
+        }
+
+        static celix_status_t removed(void *handle, celix_array_list_t *listeners) {
+            record(handle, listeners, true);
+            return CELIX_SUCCESS;
+        }
+    };
+
+    celix_status_t serviceChanged(void */*listener*/, celix_service_event_t */*event*/) {
+        return CELIX_SUCCESS;
+    }
+}
+
+TEST_GROUP(CelixListenerHookBatchTests) {
+    celix_framework_t *fw = nullptr;
+    celix_bundle_context_t *ctx = nullptr;
+    celix_bundle_t *fwBundle = nullptr;
+    hook_record rec{};
+    celix_listener_hook_service_t hook{};
+    long hookSvcId = -1L;
+    celix_service_listener_t listeners[3]{};
+
+    void setup() {
+        celix_properties_t *properties = celix_properties_create();
+        celix_properties_set(properties, "LOGHELPER_ENABLE_STDOUT_FALLBACK", "true");
+        celix_properties_set(properties, "org.osgi.framework.storage.clean", "onFirstInit");
+        celix_properties_set(properties, "org.osgi.framework.storage", ".cacheListenerHookBatchTestFramework");
+        fw = celix_frameworkFactory_createFramework(properties);
+        ctx = celix_framework_getFrameworkContext(fw);
+        fwBundle = celix_framework_getFrameworkBundle(fw);
+
+        hook.handle = &rec;
+        hook.added = hook_record::added;
+        hook.removed = hook_record::removed;
+        hookSvcId = celix_bundleContext_registerService(ctx, &hook, OSGI_FRAMEWORK_LISTENER_HOOK_SERVICE_NAME, nullptr);
+        rec.calls.clear(); //ignore the initial call for the already present listeners
+
+        for (auto &listener : listeners) {
+            listener.handle = &rec;
+            listener.serviceChanged = serviceChanged;
+        }
+    }
+
+    void teardown() {
+        celix_bundleContext_unregisterService(ctx, hookSvcId);
+        celix_frameworkFactory_destroyFramework(fw);
+    }
+
+    void addListener(int i) {
+        std::string filter = "(objectClass=batch" + std::to_string(i) + ")";
+        CHECK_EQUAL(CELIX_SUCCESS, bundleContext_addServiceListener(ctx, &listeners[i], filter.c_str()));
+    }
+
+    void removeListener(int i) {
+        CHECK_EQUAL(CELIX_SUCCESS, bundleContext_removeServiceListener(ctx, &listeners[i]));
+    }
+};
+
+TEST(CelixListenerHookBatchTests, hooksCalledPerListenerOutsideBatch) {
+    addListener(0);
+    addListener(1);
+    CHECK_EQUAL(2, (int)rec.calls.size());
+    CHECK(!rec.calls[0].removed);
+    CHECK_EQUAL(1, (int)rec.calls[0].filters.size());
+    STRCMP_EQUAL("(objectClass=batch1)", rec.calls[1].filters[0].c_str());
+
+    removeListener(0);
+    removeListener(1);
+    CHECK_EQUAL(4, (int)rec.calls.size());
+    CHECK(rec.calls[3].removed);
+}
+
+TEST(CelixListenerHookBatchTests, batchDeliversAddedListenersOnce) {
+    serviceRegistry_beginListenerHookBatch(fw->registry, fwBundle);
+    addListener(0);
+    addListener(1);
+    addListener(2);
+    CHECK(rec.calls.empty());
+    serviceRegistry_endListenerHookBatch(fw->registry, fwBundle);
+
+    CHECK_EQUAL(1, (int)rec.calls.size());
+    CHECK(!rec.calls[0].removed);
+    CHECK_EQUAL(3, (int)rec.calls[0].filters.size());
+    for (int i = 0; i < 3; ++i) {
+        STRCMP_EQUAL(("(objectClass=batch" + std::to_string(i) + ")").c_str(), rec.calls[0].filters[i].c_str());
+    }
+
+    for (int i = 0; i < 3; ++i) {
+        removeListener(i);
+    }
+}
+
+TEST(CelixListenerHookBatchTests, batchKeepsOrderOfAddAndRemove) {
+    serviceRegistry_beginListenerHookBatch(fw->registry, fwBundle);
+    addListener(0);
+    addListener(1);
+    removeListener(0);
+    addListener(2);
+    serviceRegistry_endListenerHookBatch(fw->registry, fwBundle);
+
+    //one call per sequence of added or removed listeners
+    CHECK_EQUAL(3, (int)rec.calls.size());
+    CHECK(!rec.calls[0].removed);
+    CHECK_EQUAL(2, (int)rec.calls[0].filters.size());
+    CHECK(rec.calls[1].removed);
+    CHECK_EQUAL(1, (int)rec.calls[1].filters.size());
+    STRCMP_EQUAL("(objectClass=batch0)", rec.calls[1].filters[0].c_str());
+    CHECK(!rec.calls[2].removed);
+    STRCMP_EQUAL("(objectClass=batch2)", rec.calls[2].filters[0].c_str());
+
+    removeListener(1);
+    removeListener(2);
+}
+
+TEST(CelixListenerHookBatchTests, nestedBatchDeliversOnLastEnd) {
+    serviceRegistry_beginListenerHookBatch(fw->registry, fwBundle);
+    serviceRegistry_beginListenerHookBatch(fw->registry, fwBundle);
+    addListener(0);
+    serviceRegistry_endListenerHookBatch(fw->registry, fwBundle);
+    addListener(1);
+    CHECK(rec.calls.empty());
+    serviceRegistry_endListenerHookBatch(fw->registry, fwBundle);
+
+    CHECK_EQUAL(1, (int)rec.calls.size());
+    CHECK_EQUAL(2, (int)rec.calls[0].filters.size());
+
+    //after the batch, hooks are called per listener again
+    removeListener(0);
+    removeListener(1);
+    CHECK_EQUAL(3, (int)rec.calls.size());
+}
@@ -0,0 +1,201 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *  KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <thread>
+#include <chrono>
+#include <atomic>
+#include <future>
+#include <functional>
+
+#include "celix_api.h"
+#include "celix_framework_factory.h"
+#include "celix_scheduler_service.h"
+
+#include <CppUTest/TestHarness.h>
+#include <CppUTest/CommandLineTestRunner.h>
+
+TEST_GROUP(CelixSchedulerTests) {
+    framework_t* fw = nullptr;
+    bundle_context_t *ctx = nullptr;
+    service_reference_pt ref = nullptr;
+    celix_scheduler_service_t *scheduler = nullptr;
+
+    void setup() {
+        properties_t *properties = properties_create();
+        properties_set(properties, "LOGHELPER_ENABLE_STDOUT_FALLBACK", "true");
+        properties_set(properties, "org.osgi.framework.storage.clean", "onFirstInit");
+        properties_set(properties, "org.osgi.framework.storage", ".cacheSchedulerTestFramework");
+        properties_set(properties, "CELIX_SCHEDULER_TICK", "0.005");
+
+        fw = celix_frameworkFactory_createFramework(properties);
+        ctx = framework_getContext(fw);
+
+        bundleContext_getServiceReference(ctx, CELIX_SCHEDULER_SERVICE_NAME, &ref);
+        CHECK(ref != nullptr);
+        void *svc = nullptr;
+        bundleContext_getService(ctx, ref, &svc);
+        scheduler = static_cast<celix_scheduler_service_t*>(svc);
+        CHECK(scheduler != nullptr);
+    }
+
+    void releaseScheduler() {
+        if (ref != nullptr) {
+            bool result = false;
+            bundleContext_ungetService(ctx, ref, &result);
+            bundleContext_ungetServiceReference(ctx, ref);
+            ref = nullptr;
+            scheduler = nullptr;
+        }
+    }
+
+    void teardown() {
+        releaseScheduler();
+        if (fw != nullptr) {
+            celix_frameworkFactory_destroyFramework(fw);
+        }
+    }
+
+    static void count(void *data) {
+        static_cast<std::atomic<int>*>(data)->fetch_add(1);
+    }
+
+    static bool waitFor(const std::function<bool()>& predicate, std::chrono::milliseconds timeout = std::chrono::milliseconds{2000}) {
+        auto deadline = std::chrono::steady_clock::now() + timeout;
+        while (!predicate()) {
+            if (std::chrono::steady_clock::now() > deadline) {
+                return false;
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds{1});
+        }
+        return true;
+    }
+};
+
+TEST(CelixSchedulerTests, scheduleOnce) {
+    std::atomic<int> calls{0};
+    auto start = std::chrono::steady_clock::now();
+    long eventId = scheduler->scheduleOnce(scheduler->handle, 0.05, &calls, count);
+    CHECK(eventId >= 0);
+
+    CHECK(waitFor([&]{ return calls.load() == 1; }));
+    //never called too early
+    CHECK(std::chrono::steady_clock::now() - start >= std::chrono::milliseconds{50});
+
+    //a one-shot event is called once and is gone afterwards
+    std::this_thread::sleep_for(std::chrono::milliseconds{100});
+    CHECK_EQUAL(1, calls.load());
+    CHECK_FALSE(scheduler->cancel(scheduler->handle, eventId));
+}
+
+TEST(CelixSchedulerTests, cancelBeforeDeadline) {
+    std::atomic<int> calls{0};
+    long eventId = scheduler->scheduleOnce(scheduler->handle, 0.1, &calls, count);
+    CHECK(eventId >= 0);
+    CHECK(scheduler->cancel(scheduler->handle, eventId));
+    std::this_thread::sleep_for(std::chrono::milliseconds{200});
+    CHECK_EQUAL(0, calls.load());
+}
+
+TEST(CelixSchedulerTests, schedulePeriodic) {
+    std::atomic<int> calls{0};
+    long eventId = scheduler->schedulePeriodic(scheduler->handle, 0, 0.01, &calls, count);
+    CHECK(eventId >= 0);
+
+    CHECK(waitFor([&]{ return calls.load() >= 5; }));
+    CHECK(scheduler->cancel(scheduler->handle, eventId));
+
+    //no calls after the cancel returned
+    int callsAtCancel = calls.load();
+    std::this_thread::sleep_for(std::chrono::milliseconds{100});
+    CHECK_EQUAL(callsAtCancel, calls.load());
+
+    //a periodic event needs an interval
+    CHECK(scheduler->schedulePeriodic(scheduler->handle, 0, 0, &calls, count) < 0);
+}
+
+TEST(CelixSchedulerTests, cancelWhileRunning) {
+    struct blocking_data {
+        std::atomic<int> calls{0};
+        std::promise<void> started{};
+        std::shared_future<void> release{};
+    } data{};
+    std::promise<void> release{};
+    data.release = release.get_future().share();
+
+    long eventId = scheduler->schedulePeriodic(scheduler->handle, 0, 0.01, &data, [](void *handle) {
+        auto *d = static_cast<blocking_data*>(handle);
+        if (d->calls.fetch_add(1) == 0) {
+            d->started.set_value();
+        }
+        d->release.wait();
+    });
+    CHECK(eventId >= 0);
+    data.started.get_future().wait();
+
+    //cancel waits till the running callback is done
+    auto cancelled = std::async(std::launch::async, [this, eventId]{
+        return scheduler->cancel(scheduler->handle, eventId);
+    });
+    CHECK(cancelled.wait_for(std::chrono::milliseconds{100}) == std::future_status::timeout);
+    release.set_value();
+    CHECK(cancelled.get());
+
+    std::this_thread::sleep_for(std::chrono::milliseconds{100});
+    CHECK_EQUAL(1, data.calls.load());
+}
+
+TEST(CelixSchedulerTests, cancelFromCallback) {
+    struct self_cancel_data {
+        celix_scheduler_service_t *scheduler;
+        std::atomic<long> eventId{-1};
+        std::atomic<int> calls{0};
+    } data{};
+    data.scheduler = scheduler;
+
+    long eventId = scheduler->schedulePeriodic(scheduler->handle, 0.02, 0.01, &data, [](void *handle) {
+        auto *d = static_cast<self_cancel_data*>(handle);
+        d->calls.fetch_add(1);
+        d->scheduler->cancel(d->scheduler->handle, d->eventId.load());
+    });
+    data.eventId = eventId;
+
+    CHECK(waitFor([&]{ return data.calls.load() >= 1; }));
+    std::this_thread::sleep_for(std::chrono::milliseconds{100});
+    CHECK_EQUAL(1, data.calls.load());
+}
+
+TEST(CelixSchedulerTests, shutdownWithPendingEvents) {
+    std::atomic<int> onceCalls{0};
+    std::atomic<int> periodicCalls{0};
+    CHECK(scheduler->scheduleOnce(scheduler->handle, 60, &onceCalls, count) >= 0);
+    CHECK(scheduler->schedulePeriodic(scheduler->handle, 0, 0.01, &periodicCalls, count) >= 0);
+    CHECK(waitFor([&]{ return periodicCalls.load() >= 1; }));
+
+    //pending events are dropped, the framework does not wait for their deadlines
+    releaseScheduler();
+    auto start = std::chrono::steady_clock::now();
+    celix_frameworkFactory_destroyFramework(fw);
+    fw = nullptr;
+    CHECK(std::chrono::steady_clock::now() - start < std::chrono::seconds{10});
+
+    int periodicCallsAtShutdown = periodicCalls.load();
+    std::this_thread::sleep_for(std::chrono::milliseconds{100});
+    CHECK_EQUAL(0, onceCalls.load());
+    CHECK_EQUAL(periodicCallsAtShutdown, periodicCalls.load());
+}
@@ -0,0 +1,179 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *  KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+#include <string>
+#include <vector>
+#include <algorithm>
+
+#include "celix_api.h"
+#include "celix_framework_factory.h"
+#include "service_registration.h"
+
+#include <CppUTest/TestHarness.h>
+
+namespace {
+    struct received_event {
+        celix_service_event_type_t type;
+        bool changedKeysKnown;
+        std::vector<std::string> changedKeys;
+    };
+
+    struct event_record {
+        std::vector<received_event> events{};
+
+        static celix_status_t serviceChanged(void *listener, celix_service_event_t *event) {
+            auto *rec = static_cast<event_record*>(static_cast<celix_service_listener_t*>(listener)->handle);
+            received_event received{event->type, event->changedKeys != nullptr, {}};
+            for (int i = 0; event->changedKeys != nullptr && i < celix_arrayList_size(event->changedKeys); ++i) {
+                received.changedKeys.emplace_back(static_cast<const char*>(celix_arrayList_get(event->changedKeys, i)));
+            }
+            std::sort(received.changedKeys.begin(), received.changedKeys.end());
+            rec->events.push_back(received);
+            return CELIX_SUCCESS;
+        }
+    };
+
+    struct tracker_record {
+        int nrOfAdded{0};
+        int nrOfRemoved{0};
+        int nrOfSet{0};
+        void *highest{nullptr};
+    };
+}
+
+TEST_GROUP(CelixServiceModifiedEventTests) {
+    celix_framework_t *fw = nullptr;
+    celix_bundle_context_t *ctx = nullptr;
+    int svc1 = 1;
+    int svc2 = 2;
+
+    void setup() {
+        celix_properties_t *properties = celix_properties_create();
+        celix_properties_set(properties, "LOGHELPER_ENABLE_STDOUT_FALLBACK", "true");
+        celix_properties_set(properties, "org.osgi.framework.storage.clean", "onFirstInit");
+        celix_properties_set(properties, "org.osgi.framework.storage", ".cacheServiceModifiedEventTestFramework");
+        fw = celix_frameworkFactory_createFramework(properties);
+        ctx = celix_framework_getFrameworkContext(fw);
+    }
+
+    void teardown() {
+        celix_frameworkFactory_destroyFramework(fw);
+    }
+
+    service_registration_t* registerService(int *svc, const char *color, const char *ranking) {
+        celix_properties_t *props = celix_properties_create();
+        celix_properties_set(props, "color", color);
+        celix_properties_set(props, "size", "1");
+        celix_properties_set(props, OSGI_FRAMEWORK_SERVICE_RANKING, ranking);
+        celix_properties_set(props, CELIX_FRAMEWORK_SERVICE_LANGUAGE, CELIX_FRAMEWORK_SERVICE_C_LANGUAGE);
+        service_registration_t *reg = nullptr;
+        CHECK_EQUAL(CELIX_SUCCESS, bundleContext_registerService(ctx, "test_service", svc, props, &reg));
+        return reg;
+    }
+
+    static void update(service_registration_t *reg, const char *color, const char *size, const char *ranking) {
+        celix_properties_t *props = celix_properties_create();
+        celix_properties_set(props, "color", color);
+        celix_properties_set(props, "size", size);
+        celix_properties_set(props, OSGI_FRAMEWORK_SERVICE_RANKING, ranking);
+        celix_properties_set(props, CELIX_FRAMEWORK_SERVICE_LANGUAGE, CELIX_FRAMEWORK_SERVICE_C_LANGUAGE);
+        CHECK_EQUAL(CELIX_SUCCESS, serviceRegistration_setProperties(reg, props));
+    }
+};
+
+TEST(CelixServiceModifiedEventTests, modifiedEventCarriesChangedKeys) {
+    service_registration_t *reg = registerService(&svc1, "red", "0");
+
+    event_record rec{};
+    celix_service_listener_t listener{&rec, event_record::serviceChanged};
+    CHECK_EQUAL(CELIX_SUCCESS, bundleContext_addServiceListener(ctx, &listener, "(&(objectClass=test_service)(color=red))"));
+
+    //a single MODIFIED event with the changed key
+    update(reg, "red", "2", "0");
+    CHECK_EQUAL(1, (int)rec.events.size());
+    CHECK_EQUAL(OSGI_FRAMEWORK_SERVICE_EVENT_MODIFIED, rec.events[0].type);
+    CHECK(rec.events[0].changedKeysKnown);
+    CHECK(std::vector<std::string>{"size"} == rec.events[0].changedKeys);
+
+    //a changed filter key ends the match
+    update(reg, "blue", "3", "0");
+    CHECK_EQUAL(2, (int)rec.events.size());
+    CHECK_EQUAL(OSGI_FRAMEWORK_SERVICE_EVENT_MODIFIED_ENDMATCH, rec.events[1].type);
+    CHECK((std::vector<std::string>{"color", "size"}) == rec.events[1].changedKeys);
+
+    //no longer matching, no event
+    update(reg, "blue", "4", "0");
+    CHECK_EQUAL(2, (int)rec.events.size());
+
+    bundleContext_removeServiceListener(ctx, &listener);
+    serviceRegistration_unregister(reg);
+}
+
+TEST(CelixServiceModifiedEventTests, trackerUntracksOnEndMatch) {
+    service_registration_t *reg = registerService(&svc1, "red", "0");
+
+    tracker_record rec{};
+    celix_service_tracking_options_t opts{};
+    opts.filter.serviceName = "test_service";
+    opts.filter.filter = "(color=red)";
+    opts.callbackHandle = &rec;
+    opts.add = [](void *handle, void *) { static_cast<tracker_record*>(handle)->nrOfAdded += 1; };
+    opts.remove = [](void *handle, void *) { static_cast<tracker_record*>(handle)->nrOfRemoved += 1; };
+    long trkId = celix_bundleContext_trackServicesWithOptions(ctx, &opts);
+    CHECK_EQUAL(1, rec.nrOfAdded);
+
+    update(reg, "blue", "1", "0");
+    CHECK_EQUAL(1, rec.nrOfRemoved);
+
+    //matching again is a new add
+    update(reg, "red", "1", "0");
+    CHECK_EQUAL(2, rec.nrOfAdded);
+
+    celix_bundleContext_stopTracker(ctx, trkId);
+    serviceRegistration_unregister(reg);
+}
+
+TEST(CelixServiceModifiedEventTests, trackerReordersOnRankingChange) {
+    service_registration_t *reg1 = registerService(&svc1, "red", "1");
+    service_registration_t *reg2 = registerService(&svc2, "red", "2");
+
+    tracker_record rec{};
+    celix_service_tracking_options_t opts{};
+    opts.filter.serviceName = "test_service";
+    opts.callbackHandle = &rec;
+    opts.set = [](void *handle, void *svc) {
+        auto *r = static_cast<tracker_record*>(handle);
+        r->nrOfSet += 1;
+        r->highest = svc;
+    };
+    long trkId = celix_bundleContext_trackServicesWithOptions(ctx, &opts);
+    CHECK(rec.highest == &svc2);
+    int nrOfSet = rec.nrOfSet;
+
+    //no ranking change, no new highest ranking service
+    update(reg1, "red", "2", "1");
+    CHECK_EQUAL(nrOfSet, rec.nrOfSet);
+    CHECK(rec.highest == &svc2);
+
+    update(reg1, "red", "2", "10");
+    CHECK(rec.highest == &svc1);
+
+    celix_bundleContext_stopTracker(ctx, trkId);
+    serviceRegistration_unregister(reg1);
+    serviceRegistration_unregister(reg2);
+}
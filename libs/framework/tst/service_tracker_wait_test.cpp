@@ -0,0 +1,168 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *  KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+#include <atomic>
+#include <thread>
+#include <chrono>
+#include <ctime>
+#include <sys/resource.h>
+
+#include "celix_api.h"
+#include "celix_framework_factory.h"
+#include "service_tracker.h"
+
+#include <CppUTest/TestHarness.h>
+
+namespace {
+    double elapsed(clockid_t clock, const struct timespec &start) {
+        struct timespec now{};
+        clock_gettime(clock, &now);
+        return (double)(now.tv_sec - start.tv_sec) + (double)(now.tv_nsec - start.tv_nsec) / 1000000000.0;
+    }
+}
+
+TEST_GROUP(CelixServiceTrackerWaitTests) {
+    celix_framework_t *fw = nullptr;
+    celix_bundle_context_t *ctx = nullptr;
+    celix_service_tracker_t *tracker = nullptr;
+    int svc = 42;
+
+    void setup() {
+        celix_properties_t *properties = celix_properties_create();
+        celix_properties_set(properties, "LOGHELPER_ENABLE_STDOUT_FALLBACK", "true");
+        celix_properties_set(properties, "org.osgi.framework.storage.clean", "onFirstInit");
+        celix_properties_set(properties, "org.osgi.framework.storage", ".cacheServiceTrackerWaitTestFramework");
+        fw = celix_frameworkFactory_createFramework(properties);
+        ctx = celix_framework_getFrameworkContext(fw);
+        tracker = celix_serviceTracker_create(ctx, "test_service", nullptr, nullptr);
+        CHECK(tracker != nullptr);
+    }
+
+    void teardown() {
+        if (tracker != nullptr) {
+            celix_serviceTracker_destroy(tracker);
+        }
+        celix_frameworkFactory_destroyFramework(fw);
+    }
+
+    std::thread registerLater(long &svcId, int delayInMs) {
+        return std::thread{[this, &svcId, delayInMs]{
+            std::this_thread::sleep_for(std::chrono::milliseconds{delayInMs});
+            svcId = celix_bundleContext_registerService(ctx, &svc, "test_service", nullptr);
+        }};
+    }
+
+    static void use(void *handle, void *svc) {
+        *static_cast<int*>(handle) = *static_cast<int*>(svc);
+    }
+};
+
+TEST(CelixServiceTrackerWaitTests, hasService) {
+    CHECK_FALSE(celix_serviceTracker_hasService(tracker));
+    CHECK_FALSE(celix_serviceTracker_waitForService(tracker, 0));
+
+    long svcId = celix_bundleContext_registerService(ctx, &svc, "test_service", nullptr);
+    CHECK(celix_serviceTracker_hasService(tracker));
+    CHECK(celix_serviceTracker_waitForService(tracker, 0));
+
+    celix_bundleContext_unregisterService(ctx, svcId);
+    CHECK_FALSE(celix_serviceTracker_hasService(tracker));
+}
+
+TEST(CelixServiceTrackerWaitTests, waitForServiceRegisteredLater) {
+    long svcId = -1;
+    struct timespec start{};
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    std::thread registerThread = registerLater(svcId, 100);
+    CHECK(celix_serviceTracker_waitForService(tracker, 5));
+    double waited = elapsed(CLOCK_MONOTONIC, start);
+    registerThread.join();
+
+    //woken up by the tracker, not by the timeout
+    CHECK(waited >= 0.09);
+    CHECK(waited < 2);
+    celix_bundleContext_unregisterService(ctx, svcId);
+}
+
+TEST(CelixServiceTrackerWaitTests, waitForServiceTimeout) {
+    struct timespec start{};
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    CHECK_FALSE(celix_serviceTracker_waitForService(tracker, 0.1));
+    double waited = elapsed(CLOCK_MONOTONIC, start);
+    CHECK(waited >= 0.09);
+    CHECK(waited < 2);
+}
+
+TEST(CelixServiceTrackerWaitTests, useWaitsWithoutSpinning) {
+    long svcId = -1;
+    struct timespec wallStart{};
+    struct timespec cpuStart{};
+    clock_gettime(CLOCK_MONOTONIC, &wallStart);
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &cpuStart);
+    std::thread registerThread = registerLater(svcId, 300);
+
+    int value = 0;
+    CHECK(celix_serviceTracker_useHighestRankingService(tracker, "test_service", 5, &value, use, nullptr, nullptr));
+    double waited = elapsed(CLOCK_MONOTONIC, wallStart);
+    double cpu = elapsed(CLOCK_THREAD_CPUTIME_ID, cpuStart);
+    registerThread.join();
+
+    CHECK_EQUAL(42, value);
+    CHECK(waited >= 0.29);
+    CHECK(waited < 2);
+    //the waiting thread sleeps on the tracker condition, instead of polling
+    CHECK(cpu < 0.05);
+    celix_bundleContext_unregisterService(ctx, svcId);
+}
+
+TEST(CelixServiceTrackerWaitTests, closeWaitsForUseWithoutSpinning) {
+    long svcId = celix_bundleContext_registerService(ctx, &svc, "test_service", nullptr);
+    struct slow_use {
+        std::atomic<bool> inUse{false};
+        std::atomic<bool> done{false};
+    } state{};
+    std::thread useThread{[this, &state]{
+        celix_serviceTracker_useHighestRankingService(tracker, "test_service", 0, &state, [](void *handle, void *) {
+            auto *s = static_cast<slow_use*>(handle);
+            s->inUse = true;
+            std::this_thread::sleep_for(std::chrono::milliseconds{300});
+            s->done = true;
+        }, nullptr, nullptr);
+    }};
+    while (!state.inUse) {
+        std::this_thread::sleep_for(std::chrono::milliseconds{1});
+    }
+
+    struct timespec wallStart{};
+    struct rusage usageStart{};
+    clock_gettime(CLOCK_MONOTONIC, &wallStart);
+    getrusage(RUSAGE_THREAD, &usageStart);
+    //the close waits in a grace period till the use call has left the read section
+    celix_serviceTracker_destroy(tracker);
+    tracker = nullptr;
+    double waited = elapsed(CLOCK_MONOTONIC, wallStart);
+    struct rusage usage{};
+    getrusage(RUSAGE_THREAD, &usage);
+    CHECK_TRUE(state.done);
+    useThread.join();
+
+    CHECK(waited >= 0.2);
+    //the grace period sleeps on a condition till the reader leaves, instead of polling the readers
+    CHECK(usage.ru_nvcsw - usageStart.ru_nvcsw < 50);
+    celix_bundleContext_unregisterService(ctx, svcId);
+}
@@ -0,0 +1,163 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *  KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+#include <thread>
+#include <future>
+#include <mutex>
+#include <set>
+#include <dirent.h>
+
+#include "celix_api.h"
+#include "celix_framework_factory.h"
+extern "C" {
+#include "framework_private.h"
+#include "service_tracker.h"
+}
+
+#include <CppUTest/TestHarness.h>
+
+namespace {
+    int nrOfThreads() {
+        int count = 0;
+        DIR *dir = opendir("/proc/self/task");
+        if (dir != nullptr) {
+            struct dirent *entry;
+            while ((entry = readdir(dir)) != nullptr) {
+                if (entry->d_name[0] != '.') {
+                    ++count;
+                }
+            }
+            closedir(dir);
+        }
+        return count;
+    }
+
+    struct cleanup_record {
+        std::mutex mutex{};
+        std::set<std::thread::id> threads{};
+        int count{0};
+
+        static void cleanup(void *data) {
+            auto *rec = static_cast<cleanup_record*>(data);
+            std::lock_guard<std::mutex> lock{rec->mutex};
+            rec->threads.insert(std::this_thread::get_id());
+            ++rec->count;
+        }
+    };
+
+    struct blocking_cleanup {
+        std::promise<void> started{};
+        std::promise<void> release{};
+
+        static void cleanup(void *data) {
+            auto *blocking = static_cast<blocking_cleanup*>(data);
+            blocking->started.set_value();
+            blocking->release.get_future().wait();
+        }
+    };
+}
+
+TEST_GROUP(CelixTrackerReaperTests) {
+    celix_framework_t *fw = nullptr;
+    celix_bundle_context_t *ctx = nullptr;
+
+    void setup() {
+        celix_properties_t *properties = celix_properties_create();
+        celix_properties_set(properties, "LOGHELPER_ENABLE_STDOUT_FALLBACK", "true");
+        celix_properties_set(properties, "org.osgi.framework.storage.clean", "onFirstInit");
+        celix_properties_set(properties, "org.osgi.framework.storage", ".cacheTrackerReaperTestFramework");
+        fw = celix_frameworkFactory_createFramework(properties);
+        ctx = celix_framework_getFrameworkContext(fw);
+    }
+
+    void teardown() {
+        if (fw != nullptr) {
+            celix_frameworkFactory_destroyFramework(fw);
+        }
+    }
+
+    /**
+     * Creates the reaper thread and keeps it busy, so that deferred cleanups stay pending.
+     */
+    void blockReaper(blocking_cleanup &blocking) {
+        fw_deferTrackerCleanup(fw, blocking_cleanup::cleanup, &blocking);
+        blocking.started.get_future().wait();
+    }
+
+    int nrOfPendingCleanups() {
+        celixThreadMutex_lock(&fw->trackerReaper.mutex);
+        int size = celix_arrayList_size(fw->trackerReaper.jobs);
+        celixThreadMutex_unlock(&fw->trackerReaper.mutex);
+        return size;
+    }
+};
+
+TEST(CelixTrackerReaperTests, cleanupsRunOnSingleReaperThread) {
+    cleanup_record rec{};
+    for (int i = 0; i < 100; ++i) {
+        fw_deferTrackerCleanup(fw, cleanup_record::cleanup, &rec);
+    }
+    celix_frameworkFactory_destroyFramework(fw); //runs the pending cleanups
+    fw = nullptr;
+
+    CHECK_EQUAL(100, rec.count);
+    CHECK_EQUAL(1, (int)rec.threads.size());
+    CHECK(*rec.threads.begin() != std::this_thread::get_id());
+}
+
+TEST(CelixTrackerReaperTests, closedTrackersShareReaperThread) {
+    blocking_cleanup blocking{};
+    blockReaper(blocking);
+    int threadsBefore = nrOfThreads();
+
+    constexpr int NR_OF_TRACKERS = 50;
+    long trkIds[NR_OF_TRACKERS];
+    for (long &trkId : trkIds) {
+        trkId = celix_bundleContext_trackServices(ctx, "test_service", nullptr, nullptr, nullptr);
+        CHECK(trkId >= 0);
+    }
+    for (long trkId : trkIds) {
+        celix_bundleContext_stopTracker(ctx, trkId);
+    }
+
+    //closing the trackers did not create a thread per tracker
+    CHECK_EQUAL(NR_OF_TRACKERS, nrOfPendingCleanups());
+    CHECK(nrOfThreads() <= threadsBefore);
+
+    blocking.release.set_value();
+    celix_serviceTracker_syncForContext(ctx);
+    CHECK_EQUAL(0, nrOfPendingCleanups());
+}
+
+TEST(CelixTrackerReaperTests, pendingTrackerCleanupsRunOnDestroy) {
+    blocking_cleanup blocking{};
+    blockReaper(blocking);
+
+    long trkId = celix_bundleContext_trackServices(ctx, "test_service", nullptr, nullptr, nullptr);
+    celix_bundleContext_stopTracker(ctx, trkId);
+    CHECK_EQUAL(1, nrOfPendingCleanups());
+
+    std::thread unblock{[&blocking]{
+        std::this_thread::sleep_for(std::chrono::milliseconds{20});
+        blocking.release.set_value();
+    }};
+    //destroy waits for the reaper and the pending cleanup (which removes the service listener of the tracker)
+    celix_frameworkFactory_destroyFramework(fw);
+    fw = nullptr;
+    unblock.join();
+}
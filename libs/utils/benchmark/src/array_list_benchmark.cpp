@@ -0,0 +1,99 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *  KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <benchmark/benchmark.h>
+
+#include "celix_array_list.h"
+
+static int compareLong(celix_array_list_entry_t a, celix_array_list_entry_t b) {
+    return a.longVal < b.longVal ? -1 : (a.longVal > b.longVal ? 1 : 0);
+}
+
+/**
+ * Appending range(0) elements to an empty list, includes the growing of the backing array.
+ */
+static void ArrayListAdd(benchmark::State& state) {
+    const long size = state.range(0);
+    for (auto _ : state) {
+        celix_array_list_t *list = celix_arrayList_create();
+        for (long i = 0; i < size; ++i) {
+            celix_arrayList_addLong(list, i);
+        }
+        celix_arrayList_destroy(list);
+    }
+    state.SetItemsProcessed(state.iterations() * size);
+}
+BENCHMARK(ArrayListAdd)->RangeMultiplier(16)->Range(16, 65536);
+
+static void ArrayListGet(benchmark::State& state) {
+    const int size = (int)state.range(0);
+    celix_array_list_t *list = celix_arrayList_create();
+    for (int i = 0; i < size; ++i) {
+        celix_arrayList_addLong(list, i);
+    }
+    int i = 0;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(celix_arrayList_getLong(list, i));
+        i = (i + 1) % size;
+    }
+    state.SetItemsProcessed(state.iterations());
+    celix_arrayList_destroy(list);
+}
+BENCHMARK(ArrayListGet)->RangeMultiplier(16)->Range(16, 65536);
+
+/**
+ * Removing by value (linear search + shift) from the front, the worst case for the remove used by trackers.
+ */
+static void ArrayListRemove(benchmark::State& state) {
+    const long size = state.range(0);
+    for (auto _ : state) {
+        state.PauseTiming();
+        celix_array_list_t *list = celix_arrayList_create();
+        for (long i = 0; i < size; ++i) {
+            celix_arrayList_addLong(list, i);
+        }
+        state.ResumeTiming();
+        for (long i = 0; i < size; ++i) {
+            celix_arrayList_removeLong(list, i);
+        }
+        state.PauseTiming();
+        celix_arrayList_destroy(list);
+        state.ResumeTiming();
+    }
+    state.SetItemsProcessed(state.iterations() * size);
+}
+BENCHMARK(ArrayListRemove)->RangeMultiplier(16)->Range(16, 4096);
+
+static void ArrayListSort(benchmark::State& state) {
+    const long size = state.range(0);
+    for (auto _ : state) {
+        state.PauseTiming();
+        celix_array_list_t *list = celix_arrayList_create();
+        for (long i = 0; i < size; ++i) {
+            celix_arrayList_addLong(list, (i * 7919) % size);
+        }
+        state.ResumeTiming();
+        celix_arrayList_sort(list, compareLong);
+        state.PauseTiming();
+        celix_arrayList_destroy(list);
+        state.ResumeTiming();
+    }
+    state.SetItemsProcessed(state.iterations() * size);
+}
+BENCHMARK(ArrayListSort)->RangeMultiplier(16)->Range(16, 65536);
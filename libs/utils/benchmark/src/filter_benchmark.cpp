@@ -0,0 +1,73 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *  KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <benchmark/benchmark.h>
+
+#include "celix_filter.h"
+#include "celix_properties.h"
+
+static celix_properties_t* createServiceProperties() {
+    celix_properties_t *props = celix_properties_create();
+    celix_properties_set(props, "objectClass", "dummy_service");
+    celix_properties_set(props, "service.id", "42");
+    celix_properties_set(props, "service.ranking", "10");
+    celix_properties_set(props, "service.version", "1.2.0");
+    celix_properties_set(props, "topic", "benchmark");
+    celix_properties_set(props, "name", "dummy");
+    return props;
+}
+
+/**
+ * Match cost of a (pre created) filter against service properties.
+ */
+static void FilterMatch(benchmark::State& state, const char *filterStr) {
+    celix_properties_t *props = createServiceProperties();
+    celix_filter_t *filter = celix_filter_create(filterStr);
+
+    for (auto _ : state) {
+        bool match = celix_filter_match(filter, props);
+        benchmark::DoNotOptimize(match);
+    }
+    state.SetItemsProcessed(state.iterations());
+
+    celix_filter_destroy(filter);
+    celix_properties_destroy(props);
+}
+BENCHMARK_CAPTURE(FilterMatch, equal, "(objectClass=dummy_service)");
+BENCHMARK_CAPTURE(FilterMatch, and, "(&(objectClass=dummy_service)(topic=benchmark))");
+BENCHMARK_CAPTURE(FilterMatch, complex, "(&(objectClass=dummy_service)(|(topic=other)(topic=bench*))(!(service.ranking<=5))(name=*))");
+BENCHMARK_CAPTURE(FilterMatch, noMatch, "(&(objectClass=other_service)(topic=benchmark))");
+BENCHMARK_CAPTURE(FilterMatch, tracker, "(&(objectClass=dummy_service)(service.version>=1.0.0)(service.version<2.0.0))");
+BENCHMARK_CAPTURE(FilterMatch, present, "(&(objectClass=dummy_service)(name=*))");
+BENCHMARK_CAPTURE(FilterMatch, missingAttribute, "(&(objectClass=dummy_service)(missing.attribute=value))");
+
+/**
+ * Cost of creating (parsing) a filter.
+ */
+static void FilterCreate(benchmark::State& state, const char *filterStr) {
+    for (auto _ : state) {
+        celix_filter_t *filter = celix_filter_create(filterStr);
+        benchmark::DoNotOptimize(filter);
+        celix_filter_destroy(filter);
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK_CAPTURE(FilterCreate, equal, "(objectClass=dummy_service)");
+BENCHMARK_CAPTURE(FilterCreate, tracker, "(&(objectClass=dummy_service)(service.version>=1.0.0)(service.version<2.0.0))");
+BENCHMARK_CAPTURE(FilterCreate, complex, "(&(objectClass=dummy_service)(|(topic=other)(topic=bench*))(!(service.ranking<=5))(name=*))");
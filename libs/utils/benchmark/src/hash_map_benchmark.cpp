@@ -0,0 +1,182 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *  KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <benchmark/benchmark.h>
+#include <string>
+#include <vector>
+
+#include "hash_map.h"
+#include "celix_hash_map.h"
+#include "utils.h"
+
+static std::vector<std::string> createStringKeys(long size) {
+    std::vector<std::string> keys{};
+    keys.reserve(size);
+    for (long i = 0; i < size; ++i) {
+        keys.emplace_back("service.property." + std::to_string(i));
+    }
+    return keys;
+}
+
+static hash_map_pt createStringMap(const std::vector<std::string>& keys) {
+    hash_map_pt map = hashMap_create(utils_stringHash, NULL, utils_stringEquals, NULL);
+    for (auto& key : keys) {
+        hashMap_put(map, (void*)key.c_str(), (void*)0x42);
+    }
+    return map;
+}
+
+static hash_map_pt createLongMap(long size) {
+    hash_map_pt map = hashMap_create(NULL, NULL, NULL, NULL);
+    for (long i = 1; i <= size; ++i) {
+        hashMap_put(map, (void*)i, (void*)0x42);
+    }
+    return map;
+}
+
+/**
+ * hashMap_get of existing keys in a map with range(0) entries.
+ */
+static void HashMapGetString(benchmark::State& state) {
+    auto keys = createStringKeys(state.range(0));
+    hash_map_pt map = createStringMap(keys);
+    size_t i = 0;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(hashMap_get(map, keys[i].c_str()));
+        i = (i + 1) % keys.size();
+    }
+    state.SetItemsProcessed(state.iterations());
+    hashMap_destroy(map, false, false);
+}
+BENCHMARK(HashMapGetString)->RangeMultiplier(16)->Range(16, 65536);
+
+static void HashMapGetLong(benchmark::State& state) {
+    const long size = state.range(0);
+    hash_map_pt map = createLongMap(size);
+    long i = 0;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(hashMap_get(map, (void*)(i + 1)));
+        i = (i + 1) % size;
+    }
+    state.SetItemsProcessed(state.iterations());
+    hashMap_destroy(map, false, false);
+}
+BENCHMARK(HashMapGetLong)->RangeMultiplier(16)->Range(16, 65536);
+
+/**
+ * Filling an empty map with range(0) entries and removing them again, includes the rehashing while growing.
+ */
+static void HashMapPutRemoveString(benchmark::State& state) {
+    auto keys = createStringKeys(state.range(0));
+    for (auto _ : state) {
+        hash_map_pt map = hashMap_create(utils_stringHash, NULL, utils_stringEquals, NULL);
+        for (auto& key : keys) {
+            hashMap_put(map, (void*)key.c_str(), (void*)0x42);
+        }
+        for (auto& key : keys) {
+            hashMap_remove(map, key.c_str());
+        }
+        hashMap_destroy(map, false, false);
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(HashMapPutRemoveString)->RangeMultiplier(16)->Range(16, 65536);
+
+static void HashMapPutRemoveLong(benchmark::State& state) {
+    const long size = state.range(0);
+    for (auto _ : state) {
+        hash_map_pt map = hashMap_create(NULL, NULL, NULL, NULL);
+        for (long i = 1; i <= size; ++i) {
+            hashMap_put(map, (void*)i, (void*)0x42);
+        }
+        for (long i = 1; i <= size; ++i) {
+            hashMap_remove(map, (void*)i);
+        }
+        hashMap_destroy(map, false, false);
+    }
+    state.SetItemsProcessed(state.iterations() * size);
+}
+BENCHMARK(HashMapPutRemoveLong)->RangeMultiplier(16)->Range(16, 65536);
+
+/**
+ * The same operations on the open addressing celix_string_hash_map / celix_long_hash_map, as comparison.
+ */
+static void CelixStringHashMapGet(benchmark::State& state) {
+    auto keys = createStringKeys(state.range(0));
+    celix_string_hash_map_t *map = celix_stringHashMap_create();
+    for (auto& key : keys) {
+        celix_stringHashMap_put(map, key.c_str(), (void*)0x42);
+    }
+    size_t i = 0;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(celix_stringHashMap_get(map, keys[i].c_str()));
+        i = (i + 1) % keys.size();
+    }
+    state.SetItemsProcessed(state.iterations());
+    celix_stringHashMap_destroy(map);
+}
+BENCHMARK(CelixStringHashMapGet)->RangeMultiplier(16)->Range(16, 65536);
+
+static void CelixLongHashMapGet(benchmark::State& state) {
+    const long size = state.range(0);
+    celix_long_hash_map_t *map = celix_longHashMap_create();
+    for (long i = 1; i <= size; ++i) {
+        celix_longHashMap_put(map, i, (void*)0x42);
+    }
+    long i = 0;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(celix_longHashMap_get(map, i + 1));
+        i = (i + 1) % size;
+    }
+    state.SetItemsProcessed(state.iterations());
+    celix_longHashMap_destroy(map);
+}
+BENCHMARK(CelixLongHashMapGet)->RangeMultiplier(16)->Range(16, 65536);
+
+static void CelixStringHashMapPutRemove(benchmark::State& state) {
+    auto keys = createStringKeys(state.range(0));
+    for (auto _ : state) {
+        celix_string_hash_map_t *map = celix_stringHashMap_create();
+        for (auto& key : keys) {
+            celix_stringHashMap_put(map, key.c_str(), (void*)0x42);
+        }
+        for (auto& key : keys) {
+            celix_stringHashMap_remove(map, key.c_str());
+        }
+        celix_stringHashMap_destroy(map);
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(CelixStringHashMapPutRemove)->RangeMultiplier(16)->Range(16, 65536);
+
+static void CelixLongHashMapPutRemove(benchmark::State& state) {
+    const long size = state.range(0);
+    for (auto _ : state) {
+        celix_long_hash_map_t *map = celix_longHashMap_create();
+        for (long i = 1; i <= size; ++i) {
+            celix_longHashMap_put(map, i, (void*)0x42);
+        }
+        for (long i = 1; i <= size; ++i) {
+            celix_longHashMap_remove(map, i);
+        }
+        celix_longHashMap_destroy(map);
+    }
+    state.SetItemsProcessed(state.iterations() * size);
+}
+BENCHMARK(CelixLongHashMapPutRemove)->RangeMultiplier(16)->Range(16, 65536);
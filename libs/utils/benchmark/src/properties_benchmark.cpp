@@ -0,0 +1,121 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *  KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <benchmark/benchmark.h>
+#include <string>
+#include <vector>
+
+#include "celix_properties.h"
+
+static std::vector<std::string> createKeys(long size) {
+    std::vector<std::string> keys{};
+    keys.reserve(size);
+    for (long i = 0; i < size; ++i) {
+        keys.emplace_back("service.property." + std::to_string(i));
+    }
+    return keys;
+}
+
+/**
+ * Creating a properties set with range(0) entries, as done for every service registration.
+ */
+static void PropertiesSet(benchmark::State& state) {
+    auto keys = createKeys(state.range(0));
+    for (auto _ : state) {
+        celix_properties_t *props = celix_properties_create();
+        for (auto& key : keys) {
+            celix_properties_set(props, key.c_str(), "value");
+        }
+        celix_properties_destroy(props);
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(PropertiesSet)->Arg(4)->Arg(16)->Arg(64)->Arg(256);
+
+/**
+ * Overwriting an existing entry.
+ */
+static void PropertiesOverwrite(benchmark::State& state) {
+    celix_properties_t *props = celix_properties_create();
+    celix_properties_set(props, "service.ranking", "0");
+    for (auto _ : state) {
+        celix_properties_set(props, "service.ranking", "10");
+    }
+    state.SetItemsProcessed(state.iterations());
+    celix_properties_destroy(props);
+}
+BENCHMARK(PropertiesOverwrite);
+
+/**
+ * Lookup of existing and missing keys in properties with range(0) entries.
+ */
+static void PropertiesGetExisting(benchmark::State& state) {
+    auto keys = createKeys(state.range(0));
+    celix_properties_t *props = celix_properties_create();
+    for (auto& key : keys) {
+        celix_properties_set(props, key.c_str(), "value");
+    }
+    size_t i = 0;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(celix_properties_get(props, keys[i].c_str(), nullptr));
+        i = (i + 1) % keys.size();
+    }
+    state.SetItemsProcessed(state.iterations());
+    celix_properties_destroy(props);
+}
+BENCHMARK(PropertiesGetExisting)->Arg(4)->Arg(16)->Arg(64)->Arg(256);
+
+static void PropertiesGetMissing(benchmark::State& state) {
+    auto keys = createKeys(state.range(0));
+    celix_properties_t *props = celix_properties_create();
+    for (auto& key : keys) {
+        celix_properties_set(props, key.c_str(), "value");
+    }
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(celix_properties_get(props, "missing.property", nullptr));
+    }
+    state.SetItemsProcessed(state.iterations());
+    celix_properties_destroy(props);
+}
+BENCHMARK(PropertiesGetMissing)->Arg(4)->Arg(16)->Arg(64)->Arg(256);
+
+/**
+ * Typed access, includes the string to long conversion.
+ */
+static void PropertiesGetAsLong(benchmark::State& state) {
+    celix_properties_t *props = celix_properties_create();
+    celix_properties_setLong(props, "service.ranking", 1234567);
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(celix_properties_getAsLong(props, "service.ranking", 0));
+    }
+    state.SetItemsProcessed(state.iterations());
+    celix_properties_destroy(props);
+}
+BENCHMARK(PropertiesGetAsLong);
+
+static void PropertiesSetLong(benchmark::State& state) {
+    celix_properties_t *props = celix_properties_create();
+    long val = 0;
+    for (auto _ : state) {
+        celix_properties_setLong(props, "service.ranking", val++);
+    }
+    state.SetItemsProcessed(state.iterations());
+    celix_properties_destroy(props);
+}
+BENCHMARK(PropertiesSetLong);
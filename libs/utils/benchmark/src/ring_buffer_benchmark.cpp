@@ -0,0 +1,133 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *  KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <benchmark/benchmark.h>
+#include <thread>
+
+#include "celix_ring_buffer.h"
+#include "celix_threads.h"
+#include "linked_list.h"
+
+/**
+ * The ad-hoc queue (linked list + mutex + condition) as used by several bundles, as reference.
+ */
+typedef struct locked_queue {
+    linked_list_pt list;
+    celix_thread_mutex_t mutex;
+    celix_thread_cond_t cond;
+} locked_queue_t;
+
+static void lockedQueue_push(locked_queue_t *queue, void *element) {
+    celixThreadMutex_lock(&queue->mutex);
+    linkedList_addElement(queue->list, element);
+    celixThreadCondition_signal(&queue->cond);
+    celixThreadMutex_unlock(&queue->mutex);
+}
+
+static void* lockedQueue_pop(locked_queue_t *queue) {
+    celixThreadMutex_lock(&queue->mutex);
+    while (linkedList_isEmpty(queue->list)) {
+        celixThreadCondition_wait(&queue->cond, &queue->mutex);
+    }
+    void *element = linkedList_removeFirst(queue->list);
+    celixThreadMutex_unlock(&queue->mutex);
+    return element;
+}
+
+/**
+ * Single threaded push/pop cost.
+ */
+static void RingBufferPushPop(benchmark::State& state, celix_ring_buffer_mode_e mode) {
+    celix_ring_buffer_t *rb = celix_ringBuffer_create(1024, mode);
+    void *out = NULL;
+    for (auto _ : state) {
+        celix_ringBuffer_tryPush(rb, (void*)0x42);
+        celix_ringBuffer_tryPop(rb, &out);
+        benchmark::DoNotOptimize(out);
+    }
+    state.SetItemsProcessed(state.iterations());
+    celix_ringBuffer_destroy(rb);
+}
+BENCHMARK_CAPTURE(RingBufferPushPop, spsc, CELIX_RING_BUFFER_SPSC);
+BENCHMARK_CAPTURE(RingBufferPushPop, mpmc, CELIX_RING_BUFFER_MPMC);
+
+static void LockedQueuePushPop(benchmark::State& state) {
+    locked_queue_t queue;
+    linkedList_create(&queue.list);
+    celixThreadMutex_create(&queue.mutex, NULL);
+    celixThreadCondition_init(&queue.cond, NULL);
+    for (auto _ : state) {
+        lockedQueue_push(&queue, (void*)0x42);
+        void *out = lockedQueue_pop(&queue);
+        benchmark::DoNotOptimize(out);
+    }
+    state.SetItemsProcessed(state.iterations());
+    celixThreadCondition_destroy(&queue.cond);
+    celixThreadMutex_destroy(&queue.mutex);
+    linkedList_destroy(queue.list);
+}
+BENCHMARK(LockedQueuePushPop);
+
+/**
+ * Throughput of a producer thread and a (blocking) consumer thread.
+ */
+static void RingBufferProducerConsumer(benchmark::State& state, celix_ring_buffer_mode_e mode) {
+    const long count = state.range(0);
+    for (auto _ : state) {
+        celix_ring_buffer_t *rb = celix_ringBuffer_create(1024, mode);
+        std::thread consumer{[rb, count]{
+            void *out = NULL;
+            for (long i = 0; i < count; ++i) {
+                celix_ringBuffer_pop(rb, &out);
+            }
+        }};
+        for (long i = 0; i < count; ++i) {
+            celix_ringBuffer_push(rb, (void*)0x42);
+        }
+        consumer.join();
+        celix_ringBuffer_destroy(rb);
+    }
+    state.SetItemsProcessed(state.iterations() * count);
+}
+BENCHMARK_CAPTURE(RingBufferProducerConsumer, spsc, CELIX_RING_BUFFER_SPSC)->Arg(100000)->UseRealTime();
+BENCHMARK_CAPTURE(RingBufferProducerConsumer, mpmc, CELIX_RING_BUFFER_MPMC)->Arg(100000)->UseRealTime();
+
+static void LockedQueueProducerConsumer(benchmark::State& state) {
+    const long count = state.range(0);
+    for (auto _ : state) {
+        locked_queue_t queue;
+        linkedList_create(&queue.list);
+        celixThreadMutex_create(&queue.mutex, NULL);
+        celixThreadCondition_init(&queue.cond, NULL);
+        std::thread consumer{[&queue, count]{
+            for (long i = 0; i < count; ++i) {
+                lockedQueue_pop(&queue);
+            }
+        }};
+        for (long i = 0; i < count; ++i) {
+            lockedQueue_push(&queue, (void*)0x42);
+        }
+        consumer.join();
+        celixThreadCondition_destroy(&queue.cond);
+        celixThreadMutex_destroy(&queue.mutex);
+        linkedList_destroy(queue.list);
+    }
+    state.SetItemsProcessed(state.iterations() * count);
+}
+BENCHMARK(LockedQueueProducerConsumer)->Arg(100000)->UseRealTime();
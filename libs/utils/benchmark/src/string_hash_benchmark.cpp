@@ -0,0 +1,54 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *  KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <benchmark/benchmark.h>
+#include <string>
+
+#include "utils.h"
+#include "celix_properties.h"
+
+static void StringHash(benchmark::State& state) {
+    std::string key(state.range(0), 'k');
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(utils_stringHash(key.c_str()));
+    }
+    state.SetBytesProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(StringHash)->Arg(8)->Arg(16)->Arg(32)->Arg(64)->Arg(256)->Arg(1024);
+
+static void FastStringHash(benchmark::State& state) {
+    std::string key(state.range(0), 'k');
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(utils_fastStringHash(key.c_str()));
+    }
+    state.SetBytesProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(FastStringHash)->Arg(8)->Arg(16)->Arg(32)->Arg(64)->Arg(256)->Arg(1024);
+
+static void PropertiesGet(benchmark::State& state) {
+    celix_properties_t *props = celix_properties_create();
+    for (int i = 0; i < 16; ++i) {
+        celix_properties_set(props, ("service.property." + std::to_string(i)).c_str(), "value");
+    }
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(celix_properties_get(props, "service.property.7", nullptr));
+    }
+    celix_properties_destroy(props);
+}
+BENCHMARK(PropertiesGet);
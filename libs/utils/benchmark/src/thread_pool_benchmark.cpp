@@ -0,0 +1,68 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *  KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <benchmark/benchmark.h>
+#include <atomic>
+
+#include "thpool.h"
+#include "celix_thread_pool.h"
+
+static std::atomic<long> jobCount{0};
+
+static void* countJob(void *data) {
+    (void)data;
+    jobCount.fetch_add(1, std::memory_order_relaxed);
+    return NULL;
+}
+
+/**
+ * Throughput of range(1) small jobs on a thpool with range(0) threads, from submitting until all jobs are done.
+ */
+static void ThpoolJobThroughput(benchmark::State& state) {
+    const long nrOfJobs = state.range(1);
+    threadpool pool = thpool_init((int)state.range(0));
+    for (auto _ : state) {
+        for (long i = 0; i < nrOfJobs; ++i) {
+            thpool_add_work(pool, countJob, NULL);
+        }
+        thpool_wait(pool);
+    }
+    state.SetItemsProcessed(state.iterations() * nrOfJobs);
+    thpool_destroy(pool);
+}
+BENCHMARK(ThpoolJobThroughput)->Args({1, 10000})->Args({4, 10000})->UseRealTime();
+
+/**
+ * The same for the work stealing celix_thread_pool.
+ */
+static void CelixThreadPoolJobThroughput(benchmark::State& state) {
+    const long nrOfJobs = state.range(1);
+    celix_thread_pool_options_t opts = CELIX_EMPTY_THREAD_POOL_OPTIONS;
+    opts.nrOfThreads = (size_t)state.range(0);
+    celix_thread_pool_t *pool = celix_threadPool_create(&opts);
+    for (auto _ : state) {
+        for (long i = 0; i < nrOfJobs; ++i) {
+            celix_threadPool_execute(pool, countJob, NULL, NULL, NULL);
+        }
+        celix_threadPool_waitUntilIdle(pool);
+    }
+    state.SetItemsProcessed(state.iterations() * nrOfJobs);
+    celix_threadPool_destroy(pool);
+}
+BENCHMARK(CelixThreadPoolJobThroughput)->Args({1, 10000})->Args({4, 10000})->UseRealTime();
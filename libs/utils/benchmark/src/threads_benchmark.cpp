@@ -0,0 +1,113 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *  KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <benchmark/benchmark.h>
+
+#include "celix_threads.h"
+
+/**
+ * Locks shared by the benchmark threads, for the contended cases.
+ */
+static struct SharedLocks {
+    celix_thread_mutex_t mutex{};
+    celix_thread_rwlock_t rwlock{};
+    long counter = 0;
+
+    SharedLocks() {
+        celixThreadMutex_create(&mutex, NULL);
+        celixThreadRwlock_create(&rwlock, NULL);
+    }
+
+    ~SharedLocks() {
+        celixThreadRwlock_destroy(&rwlock);
+        celixThreadMutex_destroy(&mutex);
+    }
+} shared{};
+
+/**
+ * Uncontended lock/unlock cost of a thread local lock.
+ */
+static void MutexUncontended(benchmark::State& state) {
+    celix_thread_mutex_t mutex;
+    celixThreadMutex_create(&mutex, NULL);
+    for (auto _ : state) {
+        celixThreadMutex_lock(&mutex);
+        celixThreadMutex_unlock(&mutex);
+    }
+    state.SetItemsProcessed(state.iterations());
+    celixThreadMutex_destroy(&mutex);
+}
+BENCHMARK(MutexUncontended);
+
+static void RwlockReadUncontended(benchmark::State& state) {
+    celix_thread_rwlock_t lock;
+    celixThreadRwlock_create(&lock, NULL);
+    for (auto _ : state) {
+        celixThreadRwlock_readLock(&lock);
+        celixThreadRwlock_unlock(&lock);
+    }
+    state.SetItemsProcessed(state.iterations());
+    celixThreadRwlock_destroy(&lock);
+}
+BENCHMARK(RwlockReadUncontended);
+
+static void RwlockWriteUncontended(benchmark::State& state) {
+    celix_thread_rwlock_t lock;
+    celixThreadRwlock_create(&lock, NULL);
+    for (auto _ : state) {
+        celixThreadRwlock_writeLock(&lock);
+        celixThreadRwlock_unlock(&lock);
+    }
+    state.SetItemsProcessed(state.iterations());
+    celixThreadRwlock_destroy(&lock);
+}
+BENCHMARK(RwlockWriteUncontended);
+
+/**
+ * Contended cost, all benchmark threads lock the same lock around a small critical section.
+ */
+static void MutexContended(benchmark::State& state) {
+    for (auto _ : state) {
+        celixThreadMutex_lock(&shared.mutex);
+        benchmark::DoNotOptimize(++shared.counter);
+        celixThreadMutex_unlock(&shared.mutex);
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(MutexContended)->ThreadRange(1, 8)->UseRealTime();
+
+static void RwlockReadContended(benchmark::State& state) {
+    for (auto _ : state) {
+        celixThreadRwlock_readLock(&shared.rwlock);
+        benchmark::DoNotOptimize(shared.counter);
+        celixThreadRwlock_unlock(&shared.rwlock);
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(RwlockReadContended)->ThreadRange(1, 8)->UseRealTime();
+
+static void RwlockWriteContended(benchmark::State& state) {
+    for (auto _ : state) {
+        celixThreadRwlock_writeLock(&shared.rwlock);
+        benchmark::DoNotOptimize(++shared.counter);
+        celixThreadRwlock_unlock(&shared.rwlock);
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(RwlockWriteContended)->ThreadRange(1, 8)->UseRealTime();
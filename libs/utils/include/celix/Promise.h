@@ -0,0 +1,158 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *  KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#ifndef CELIX_PROMISE_H
+#define CELIX_PROMISE_H
+
+#include <utility>
+#include <memory>
+
+#include "celix_promise.h"
+
+namespace celix {
+
+    namespace detail {
+        template<typename T>
+        void destroyPromiseValue(void *value) {
+            delete static_cast<T*>(value);
+        }
+    }
+
+    /**
+     * Move-only C++ wrapper of a celix_promise_t holding a value of type T.
+     *
+     * The value is heap allocated when the promise is resolved and destroyed with the (last reference to the)
+     * promise. Continuations must not throw, they are called from C.
+     */
+    template<typename T>
+    class Promise {
+    public:
+        /**
+         * Creates a pending promise.
+         */
+        Promise() : promise{celix_promise_create(detail::destroyPromiseValue<T>)} {}
+
+        /**
+         * Takes over the reference to a C promise, which must have a value of type T (or no value).
+         */
+        explicit Promise(celix_promise_t *p) noexcept : promise{p} {}
+
+        ~Promise() { reset(); }
+
+        Promise(Promise&& rhs) noexcept : promise{rhs.promise} { rhs.promise = nullptr; }
+        Promise& operator=(Promise&& rhs) noexcept {
+            if (this != &rhs) {
+                reset();
+                promise = rhs.promise;
+                rhs.promise = nullptr;
+            }
+            return *this;
+        }
+
+        Promise(const Promise&) = delete;
+        Promise& operator=(const Promise&) = delete;
+
+        /**
+         * Whether the wrapper holds a promise.
+         */
+        explicit operator bool() const noexcept { return promise != nullptr; }
+
+        /**
+         * Returns the C promise, which stays owned by this wrapper.
+         */
+        celix_promise_t* cPromise() const noexcept { return promise; }
+
+        /**
+         * Resolves the promise with the value, returns false if it was already completed.
+         */
+        bool resolve(T value) {
+            std::unique_ptr<T> v{new T(std::move(value))};
+            bool resolved = celix_promise_resolve(promise, v.get());
+            if (resolved) {
+                v.release();
+            }
+            return resolved;
+        }
+
+        bool fail(celix_status_t status) { return celix_promise_fail(promise, status); }
+
+        bool isDone() const { return celix_promise_isDone(promise); }
+
+        /**
+         * Waits until the promise is completed and returns its status. If resolved, the value is copied into value.
+         */
+        celix_status_t get(T& value) const {
+            void *v = nullptr;
+            celix_status_t status = celix_promise_get(promise, &v);
+            if (status == CELIX_SUCCESS && v != nullptr) {
+                value = *static_cast<const T*>(v);
+            }
+            return status;
+        }
+
+        /**
+         * Chains fn, called with the value if the promise is resolved. If the promise fails, the derived promise
+         * fails with the same status and fn is not called.
+         * @param executor The pool to run fn on or nullptr to run it on the completing thread.
+         */
+        template<typename F>
+        auto then(F fn, celix_thread_pool_t *executor = nullptr) -> Promise<decltype(fn(std::declval<const T&>()))> {
+            using R = decltype(fn(std::declval<const T&>()));
+            auto *data = new F(std::move(fn));
+            celix_promise_t *derived = celix_promise_then(promise, executor, Promise::callContinuation<F, R>, data,
+                                                          detail::destroyPromiseValue<R>);
+            if (derived == nullptr) {
+                delete data;
+            }
+            return Promise<R>{derived};
+        }
+
+        /**
+         * Fails the promise with ETIMEDOUT if it is not completed within timeoutInSeconds, using the scheduler
+         * service functions. See celix_promise_timeout.
+         */
+        celix_status_t timeout(double timeoutInSeconds, void *schedulerHandle, celix_promise_schedule_once_fp scheduleOnce, celix_promise_cancel_fp cancel) {
+            return celix_promise_timeout(promise, timeoutInSeconds, schedulerHandle, scheduleOnce, cancel);
+        }
+
+        /**
+         * Releases the promise.
+         */
+        void reset() noexcept {
+            if (promise != nullptr) {
+                celix_promise_release(promise);
+                promise = nullptr;
+            }
+        }
+    private:
+        template<typename F, typename R>
+        static celix_status_t callContinuation(void *data, celix_status_t status, void *value, void **result) {
+            std::unique_ptr<F> fn{static_cast<F*>(data)}; //a continuation is called once
+            if (status != CELIX_SUCCESS) {
+                return status;
+            }
+            *result = new R((*fn)(*static_cast<const T*>(value)));
+            return CELIX_SUCCESS;
+        }
+
+        celix_promise_t *promise{nullptr};
+    };
+}
+
+#endif //CELIX_PROMISE_H
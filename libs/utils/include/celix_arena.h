@@ -0,0 +1,84 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *  KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+#ifndef CELIX_ARENA_H_
+#define CELIX_ARENA_H_
+
+#include <stddef.h>
+
+#include "exports.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Arena (bump) allocator for scratch memory with a bounded lifetime, e.g. per message or per remote call.
+ *
+ * Allocations are taken from larger blocks and cannot be freed individually; all memory is released at once with
+ * celix_arena_reset, which keeps the blocks for reuse, or with celix_arena_destroy.
+ * An arena is not thread safe.
+ */
+typedef struct celix_arena celix_arena_t;
+
+/**
+ * Creates an arena. If blockSize is 0 a default block size (4096 bytes) is used.
+ * Allocations larger than the block size get a dedicated block.
+ */
+UTILS_EXPORT celix_arena_t* celix_arena_create(size_t blockSize);
+
+/**
+ * Destroys the arena and all memory allocated from it.
+ */
+UTILS_EXPORT void celix_arena_destroy(celix_arena_t *arena);
+
+/**
+ * Allocates size bytes, aligned for any fundamental type. Returns NULL if memory cannot be allocated.
+ */
+UTILS_EXPORT void* celix_arena_malloc(celix_arena_t *arena, size_t size);
+
+/**
+ * Allocates zero initialized memory for an array of nmemb elements of size bytes.
+ */
+UTILS_EXPORT void* celix_arena_calloc(celix_arena_t *arena, size_t nmemb, size_t size);
+
+/**
+ * Copies str into the arena.
+ */
+UTILS_EXPORT char* celix_arena_strdup(celix_arena_t *arena, const char *str);
+
+/**
+ * Releases all allocations. The blocks are kept and reused for the next allocations.
+ */
+UTILS_EXPORT void celix_arena_reset(celix_arena_t *arena);
+
+/**
+ * Returns the number of bytes allocated from the arena since the creation or last reset (incl. alignment padding).
+ */
+UTILS_EXPORT size_t celix_arena_allocatedSize(const celix_arena_t *arena);
+
+/**
+ * Returns the total size of the blocks owned by the arena.
+ */
+UTILS_EXPORT size_t celix_arena_capacity(const celix_arena_t *arena);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* CELIX_ARENA_H_ */
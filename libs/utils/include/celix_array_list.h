@@ -45,6 +45,11 @@ typedef struct celix_array_list celix_array_list_t;
 
 typedef bool (*celix_arrayList_equals_fp)(celix_array_list_entry_t, celix_array_list_entry_t);
 
+/**
+ * Compare function for sorting and searching, returns < 0, 0 or > 0 if a is less than, equal to or greater than b.
+ */
+typedef int (*celix_arrayList_compare_fp)(celix_array_list_entry_t a, celix_array_list_entry_t b);
+
 
 celix_array_list_t* celix_arrayList_create();
 
@@ -99,6 +104,43 @@ void celix_arrayList_removeDouble(celix_array_list_t *list, double val);
 void celix_arrayList_removeBool(celix_array_list_t *list, bool val);
 void celix_arrayList_removeSize(celix_array_list_t *list, size_t val);
 
+/**
+ * Appends all entries of toAdd to the list with a single grow and copy.
+ */
+void celix_arrayList_addAll(celix_array_list_t *list, const celix_array_list_t *toAdd);
+
+/**
+ * Ensures the list has room for at least capacity entries.
+ */
+void celix_arrayList_reserve(celix_array_list_t *list, int capacity);
+
+/**
+ * Releases the unused capacity of the list.
+ */
+void celix_arrayList_shrinkToFit(celix_array_list_t *list);
+
+/**
+ * Returns the entries of the list as a contiguous array of celix_arrayList_size entries.
+ * The pointer is invalidated by any modification of the list.
+ */
+const celix_array_list_entry_t* celix_arrayList_data(const celix_array_list_t *list);
+
+/**
+ * Removes the entry at index in O(1) by moving the last entry to index. Does not preserve the order of the list.
+ */
+void celix_arrayList_swapRemoveAt(celix_array_list_t *list, int index);
+
+/**
+ * Sorts the list (stable) using the provided compare function.
+ */
+void celix_arrayList_sort(celix_array_list_t *list, celix_arrayList_compare_fp compare);
+
+/**
+ * Searches a list sorted on compare for entry.
+ * Returns the index of a matching entry or, if not found, -(insertion point + 1).
+ */
+int celix_arrayList_binarySearch(const celix_array_list_t *list, celix_array_list_entry_t entry, celix_arrayList_compare_fp compare);
+
 #ifdef __cplusplus
 }
 #endif
@@ -44,6 +44,8 @@ typedef enum celix_filter_operand_enum
 
 typedef struct celix_filter_struct celix_filter_t;
 
+typedef struct celix_filter_compiled celix_filter_compiled_t; //opaque
+
 struct celix_filter_struct {
     celix_filter_operand_t operand;
     const char *attribute; //NULL for operands AND, OR ot NOT
@@ -53,6 +55,9 @@ struct celix_filter_struct {
     //type is celix_filter_t* for AND, OR and NOT operator and char* for SUBSTRING
     //for other operands children is NULL
     celix_array_list_t *children;
+
+    //flat representation used for matching, created by celix_filter_create. NULL for child filters
+    celix_filter_compiled_t *compiled;
 };
 
 
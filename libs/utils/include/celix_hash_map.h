@@ -0,0 +1,121 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *  KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#ifndef CELIX_HASH_MAP_H_
+#define CELIX_HASH_MAP_H_
+
+#include <stddef.h>
+#include <stdbool.h>
+
+#include "exports.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Open addressing (Robin Hood) hash maps with the entries stored inline in a single slot array.
+ *
+ * Compared to the (chained) hash_map_t there is no allocation per entry and the key hash and equality are
+ * specialized for the key type, so no function pointer calls are needed for a lookup.
+ *
+ * The celix_long_hash_map_t uses long keys, the celix_string_hash_map_t uses string keys (copied by the map).
+ * A map is not thread safe and iterators are invalidated by a put, remove or clear call.
+ */
+typedef struct celix_long_hash_map celix_long_hash_map_t;
+typedef struct celix_string_hash_map celix_string_hash_map_t;
+
+typedef struct celix_long_hash_map_iterator {
+    const celix_long_hash_map_t *map;
+    size_t index; //slot index
+    long key;
+    void *value;
+} celix_long_hash_map_iterator_t;
+
+typedef struct celix_string_hash_map_iterator {
+    const celix_string_hash_map_t *map;
+    size_t index; //slot index
+    const char *key;
+    void *value;
+} celix_string_hash_map_iterator_t;
+
+UTILS_EXPORT celix_long_hash_map_t* celix_longHashMap_create(void);
+UTILS_EXPORT void celix_longHashMap_destroy(celix_long_hash_map_t *map);
+UTILS_EXPORT size_t celix_longHashMap_size(const celix_long_hash_map_t *map);
+
+/**
+ * Puts the value for the key. Returns the previous value for the key or NULL if the key was not present.
+ */
+UTILS_EXPORT void* celix_longHashMap_put(celix_long_hash_map_t *map, long key, void *value);
+
+/**
+ * Returns the value for the key or NULL if the key is not present.
+ */
+UTILS_EXPORT void* celix_longHashMap_get(const celix_long_hash_map_t *map, long key);
+UTILS_EXPORT bool celix_longHashMap_hasKey(const celix_long_hash_map_t *map, long key);
+
+/**
+ * Removes the key. Returns the removed value or NULL if the key was not present.
+ */
+UTILS_EXPORT void* celix_longHashMap_remove(celix_long_hash_map_t *map, long key);
+UTILS_EXPORT void celix_longHashMap_clear(celix_long_hash_map_t *map);
+
+/**
+ * Returns an iterator pointing to the first entry of the map or an end iterator if the map is empty.
+ * Usage: for (iter = celix_longHashMap_begin(map); !celix_longHashMapIterator_isEnd(&iter); celix_longHashMapIterator_next(&iter))
+ */
+UTILS_EXPORT celix_long_hash_map_iterator_t celix_longHashMap_begin(const celix_long_hash_map_t *map);
+UTILS_EXPORT bool celix_longHashMapIterator_isEnd(const celix_long_hash_map_iterator_t *iter);
+UTILS_EXPORT void celix_longHashMapIterator_next(celix_long_hash_map_iterator_t *iter);
+
+
+UTILS_EXPORT celix_string_hash_map_t* celix_stringHashMap_create(void);
+UTILS_EXPORT void celix_stringHashMap_destroy(celix_string_hash_map_t *map);
+UTILS_EXPORT size_t celix_stringHashMap_size(const celix_string_hash_map_t *map);
+
+/**
+ * Puts the value for the key, the key is copied. Returns the previous value for the key or NULL if the key was
+ * not present.
+ */
+UTILS_EXPORT void* celix_stringHashMap_put(celix_string_hash_map_t *map, const char *key, void *value);
+
+/**
+ * Returns the value for the key or NULL if the key is not present.
+ */
+UTILS_EXPORT void* celix_stringHashMap_get(const celix_string_hash_map_t *map, const char *key);
+UTILS_EXPORT bool celix_stringHashMap_hasKey(const celix_string_hash_map_t *map, const char *key);
+
+/**
+ * Removes the key. Returns the removed value or NULL if the key was not present.
+ */
+UTILS_EXPORT void* celix_stringHashMap_remove(celix_string_hash_map_t *map, const char *key);
+UTILS_EXPORT void celix_stringHashMap_clear(celix_string_hash_map_t *map);
+
+/**
+ * Returns an iterator pointing to the first entry of the map or an end iterator if the map is empty.
+ */
+UTILS_EXPORT celix_string_hash_map_iterator_t celix_stringHashMap_begin(const celix_string_hash_map_t *map);
+UTILS_EXPORT bool celix_stringHashMapIterator_isEnd(const celix_string_hash_map_iterator_t *iter);
+UTILS_EXPORT void celix_stringHashMapIterator_next(celix_string_hash_map_iterator_t *iter);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* CELIX_HASH_MAP_H_ */
@@ -0,0 +1,203 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *  KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+#ifndef CELIX_INTRUSIVE_LIST_H_
+#define CELIX_INTRUSIVE_LIST_H_
+
+#include <stddef.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Intrusive doubly linked list and singly linked queue.
+ *
+ * The node is embedded in the element struct, so adding and removing elements never allocates. An element can only
+ * be in one list per embedded node. The list does not own the elements. Use CELIX_ILIST_ENTRY to get the element
+ * from a node, e.g.:
+ *
+ *   typedef struct foo { int value; celix_ilist_node_t node; } foo_t;
+ *   CELIX_ILIST_FOR_EACH(&list, n) {
+ *       foo_t *foo = CELIX_ILIST_ENTRY(n, foo_t, node);
+ *   }
+ */
+typedef struct celix_ilist_node {
+    struct celix_ilist_node *next;
+    struct celix_ilist_node *prev;
+} celix_ilist_node_t;
+
+typedef struct celix_ilist {
+    celix_ilist_node_t head; //sentinel, head.next is the first and head.prev the last node
+} celix_ilist_t;
+
+/**
+ * Returns the element struct of type containing the node as field member.
+ */
+#define CELIX_ILIST_ENTRY(nodePtr, type, member) ((type*)((char*)(nodePtr) - offsetof(type, member)))
+
+#define CELIX_ILIST_FOR_EACH(list, n) \
+    for (celix_ilist_node_t *n = (list)->head.next; n != &(list)->head; n = n->next)
+
+#define CELIX_ILIST_FOR_EACH_REVERSE(list, n) \
+    for (celix_ilist_node_t *n = (list)->head.prev; n != &(list)->head; n = n->prev)
+
+/**
+ * Iterates over the list, the current node can be removed from the list during the iteration.
+ */
+#define CELIX_ILIST_FOR_EACH_SAFE(list, n) \
+    for (celix_ilist_node_t *n = (list)->head.next, *n##Next = n->next; n != &(list)->head; n = n##Next, n##Next = n->next)
+
+#define CELIX_ILIST_INIT(list) { { &(list).head, &(list).head } }
+
+static inline void celix_ilist_init(celix_ilist_t *list) {
+    list->head.next = &list->head;
+    list->head.prev = &list->head;
+}
+
+static inline bool celix_ilist_isEmpty(const celix_ilist_t *list) {
+    return list->head.next == &list->head;
+}
+
+/**
+ * Returns the number of nodes in the list. Note O(n).
+ */
+static inline size_t celix_ilist_size(const celix_ilist_t *list) {
+    size_t size = 0;
+    for (const celix_ilist_node_t *n = list->head.next; n != &list->head; n = n->next) {
+        ++size;
+    }
+    return size;
+}
+
+static inline void celix_ilist_insertAfter(celix_ilist_node_t *pos, celix_ilist_node_t *node) {
+    node->prev = pos;
+    node->next = pos->next;
+    pos->next->prev = node;
+    pos->next = node;
+}
+
+static inline void celix_ilist_pushFront(celix_ilist_t *list, celix_ilist_node_t *node) {
+    celix_ilist_insertAfter(&list->head, node);
+}
+
+static inline void celix_ilist_pushBack(celix_ilist_t *list, celix_ilist_node_t *node) {
+    celix_ilist_insertAfter(list->head.prev, node);
+}
+
+/**
+ * Removes the node from the list it is in.
+ */
+static inline void celix_ilist_remove(celix_ilist_node_t *node) {
+    node->prev->next = node->next;
+    node->next->prev = node->prev;
+    node->next = NULL;
+    node->prev = NULL;
+}
+
+/**
+ * Returns the first node or NULL if the list is empty.
+ */
+static inline celix_ilist_node_t* celix_ilist_front(const celix_ilist_t *list) {
+    return celix_ilist_isEmpty(list) ? NULL : list->head.next;
+}
+
+/**
+ * Returns the last node or NULL if the list is empty.
+ */
+static inline celix_ilist_node_t* celix_ilist_back(const celix_ilist_t *list) {
+    return celix_ilist_isEmpty(list) ? NULL : list->head.prev;
+}
+
+/**
+ * Removes and returns the first node or returns NULL if the list is empty.
+ */
+static inline celix_ilist_node_t* celix_ilist_popFront(celix_ilist_t *list) {
+    celix_ilist_node_t *node = celix_ilist_front(list);
+    if (node != NULL) {
+        celix_ilist_remove(node);
+    }
+    return node;
+}
+
+/**
+ * Removes and returns the last node or returns NULL if the list is empty.
+ */
+static inline celix_ilist_node_t* celix_ilist_popBack(celix_ilist_t *list) {
+    celix_ilist_node_t *node = celix_ilist_back(list);
+    if (node != NULL) {
+        celix_ilist_remove(node);
+    }
+    return node;
+}
+
+/**
+ * Intrusive FIFO queue, a singly linked list with a tail pointer. Cheaper than celix_ilist_t if elements are only
+ * pushed to the back and popped from the front. Use CELIX_ILIST_ENTRY to get the element from a node.
+ */
+typedef struct celix_iqueue_node {
+    struct celix_iqueue_node *next;
+} celix_iqueue_node_t;
+
+typedef struct celix_iqueue {
+    celix_iqueue_node_t *head;
+    celix_iqueue_node_t *tail;
+} celix_iqueue_t;
+
+#define CELIX_IQUEUE_INIT { NULL, NULL }
+
+static inline void celix_iqueue_init(celix_iqueue_t *queue) {
+    queue->head = NULL;
+    queue->tail = NULL;
+}
+
+static inline bool celix_iqueue_isEmpty(const celix_iqueue_t *queue) {
+    return queue->head == NULL;
+}
+
+static inline void celix_iqueue_push(celix_iqueue_t *queue, celix_iqueue_node_t *node) {
+    node->next = NULL;
+    if (queue->tail == NULL) {
+        queue->head = node;
+    } else {
+        queue->tail->next = node;
+    }
+    queue->tail = node;
+}
+
+/**
+ * Removes and returns the first node or returns NULL if the queue is empty.
+ */
+static inline celix_iqueue_node_t* celix_iqueue_pop(celix_iqueue_t *queue) {
+    celix_iqueue_node_t *node = queue->head;
+    if (node != NULL) {
+        queue->head = node->next;
+        if (queue->head == NULL) {
+            queue->tail = NULL;
+        }
+        node->next = NULL;
+    }
+    return node;
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* CELIX_INTRUSIVE_LIST_H_ */
@@ -0,0 +1,63 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *  KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+#ifndef CELIX_PROBES_H_
+#define CELIX_PROBES_H_
+
+/**
+ * USDT (user-level statically defined tracing) probes of the "celix" provider, for tracing with e.g. bpftrace,
+ * perf or SystemTap:
+ *
+ *     bpftrace -e 'usdt:/path/to/libcelix_framework.so:celix:bundle_start { printf("%s\n", str(arg1)); }'
+ *
+ * The probes are only compiled in if Celix is build with the ENABLE_USDT_PROBES CMake option (which defines
+ * CELIX_USDT_PROBES and requires sys/sdt.h). A probe is a single nop instruction, which is only replaced with a
+ * trap when a tracer attaches. Probe arguments are passed as asm operands, so only use values which are already at
+ * hand (no function calls) to keep the probes free when not attached.
+ * Without CELIX_USDT_PROBES the probe macros expand to nothing.
+ *
+ * Available probes (arguments in order):
+ *  - fw_service_changed_entry / fw_service_changed_exit:  event type, service id (of the first registration),
+ *                                                          nr of registrations
+ *  - bundle_start:                                         bundle id, bundle symbolic name
+ *  - bundle_stop:                                          bundle id
+ *  - bundle_started / bundle_stopped:                      bundle id, status
+ *  - tracker_add / tracker_remove:                         tracker filter, service id
+ *  - psa_send:                                             psa type, topic, msg type id, nr of msgs
+ *  - psa_receive:                                          psa type, topic, msg type id, payload size
+ *  - serializer_serialize / serializer_deserialize:        serialization type, msg type id, serialized size
+ *  - json_rpc_call:                                        function signature (json-rpc method), request size
+ *                                                          (of the whole batch for batch requests)
+ *  - rsa_send:                                             endpoint url, request size
+ */
+
+#ifdef CELIX_USDT_PROBES
+#include <sys/sdt.h>
+
+#define CELIX_PROBE1(name, a1)                  DTRACE_PROBE1(celix, name, a1)
+#define CELIX_PROBE2(name, a1, a2)              DTRACE_PROBE2(celix, name, a1, a2)
+#define CELIX_PROBE3(name, a1, a2, a3)          DTRACE_PROBE3(celix, name, a1, a2, a3)
+#define CELIX_PROBE4(name, a1, a2, a3, a4)      DTRACE_PROBE4(celix, name, a1, a2, a3, a4)
+#else
+#define CELIX_PROBE1(name, a1)                  do { } while (0)
+#define CELIX_PROBE2(name, a1, a2)              do { } while (0)
+#define CELIX_PROBE3(name, a1, a2, a3)          do { } while (0)
+#define CELIX_PROBE4(name, a1, a2, a3, a4)      do { } while (0)
+#endif
+
+#endif /* CELIX_PROBES_H_ */
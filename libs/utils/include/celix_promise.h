@@ -0,0 +1,121 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *  KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#ifndef CELIX_PROMISE_H_
+#define CELIX_PROMISE_H_
+
+#include <stdbool.h>
+
+#include "exports.h"
+#include "celix_errno.h"
+#include "celix_thread_pool.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Single-assignment promise, the common completion primitive for asynchronous APIs.
+ *
+ * A promise is completed once, either resolved with a value or failed with a status. Completing and chaining
+ * (celix_promise_then) are lock-free: the continuations are kept in a lock-free list which is taken over by the
+ * completing thread. Only celix_promise_get blocks, on a mutex and condition of the waiting thread.
+ *
+ * Promises and continuations are allocated from a small per-thread pool, so they are cheap enough to use per call.
+ *
+ * Promises are reference counted. celix_promise_create and celix_promise_then return a promise with a reference for
+ * the caller, every reference is released with celix_promise_release. A producer completing a promise on another
+ * thread should hold a reference of its own (celix_promise_retain).
+ */
+typedef struct celix_promise celix_promise_t;
+
+/**
+ * Continuation of celix_promise_then. Called with the status and value of the completed promise, returns the status
+ * for the derived promise and sets its value (if the status is CELIX_SUCCESS) in result.
+ * The value of the completed promise stays owned by that promise.
+ */
+typedef celix_status_t (*celix_promise_then_fp)(void *data, celix_status_t status, void *value, void **result);
+
+/**
+ * Scheduling functions of the celix_scheduler_service_t (see celix_scheduler_service.h), used for timeouts.
+ */
+typedef long (*celix_promise_schedule_once_fp)(void *handle, double delayInSeconds, void *callbackData, void (*callback)(void *data));
+typedef bool (*celix_promise_cancel_fp)(void *handle, long eventId);
+
+/**
+ * Creates a pending promise.
+ * @param destroyValue  Optional destructor of the value, called when the promise is destroyed.
+ */
+UTILS_EXPORT celix_promise_t* celix_promise_create(void (*destroyValue)(void *value));
+
+UTILS_EXPORT void celix_promise_retain(celix_promise_t *promise);
+
+/**
+ * Releases a reference, the last reference destroys the promise (and its value).
+ * Pending continuations keep their promises alive.
+ */
+UTILS_EXPORT void celix_promise_release(celix_promise_t *promise);
+
+/**
+ * Resolves the promise with the value and runs the continuations.
+ * @return True if resolved, false if the promise was already completed (the caller keeps ownership of the value).
+ */
+UTILS_EXPORT bool celix_promise_resolve(celix_promise_t *promise, void *value);
+
+/**
+ * Fails the promise with the (non CELIX_SUCCESS) status and runs the continuations.
+ * @return True if failed, false if the promise was already completed.
+ */
+UTILS_EXPORT bool celix_promise_fail(celix_promise_t *promise, celix_status_t status);
+
+UTILS_EXPORT bool celix_promise_isDone(const celix_promise_t *promise);
+
+/**
+ * Waits until the promise is completed and returns its status. If value is not NULL it is set to the value of the
+ * promise, which stays owned by the promise.
+ * Should not be called from a worker of an executor which has to run the completion (deadlock).
+ */
+UTILS_EXPORT celix_status_t celix_promise_get(celix_promise_t *promise, void **value);
+
+/**
+ * Chains a continuation and returns the derived promise, completed with the result of the continuation.
+ * @param executor      The pool to run the continuation on or NULL to run it on the completing thread (or the
+ *                      calling thread if the promise is already completed). Keep continuations without executor short.
+ * @param destroyResult Optional destructor of the value of the derived promise.
+ * @return The derived promise, owned by the caller.
+ */
+UTILS_EXPORT celix_promise_t* celix_promise_then(celix_promise_t *promise, celix_thread_pool_t *executor,
+                                                 celix_promise_then_fp continuation, void *data,
+                                                 void (*destroyResult)(void *value));
+
+/**
+ * Fails the promise with ETIMEDOUT if it is not completed within timeoutInSeconds, using the scheduler service
+ * functions (e.g. celix_promise_timeout(p, 1.0, svc->handle, svc->scheduleOnce, svc->cancel)).
+ * The timeout is cancelled when the promise is completed earlier. Note the scheduler service cancels the events of a
+ * stopped bundle, the promise of such a cancelled timeout is not released anymore.
+ * @return CELIX_SUCCESS or CELIX_ILLEGAL_STATE if the timeout could not be scheduled.
+ */
+UTILS_EXPORT celix_status_t celix_promise_timeout(celix_promise_t *promise, double timeoutInSeconds, void *schedulerHandle,
+                                                  celix_promise_schedule_once_fp scheduleOnce, celix_promise_cancel_fp cancel);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* CELIX_PROMISE_H_ */
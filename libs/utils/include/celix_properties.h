@@ -18,6 +18,7 @@
  */
 
 #include <stdio.h>
+#include <stdint.h>
 
 #include "hash_map.h"
 #include "exports.h"
@@ -44,6 +45,9 @@ celix_properties_t* celix_properties_create(void);
 
 void celix_properties_destroy(celix_properties_t *properties);
 
+/**
+ * Loads properties from a file. Regular files are memory mapped and parsed in a single pass.
+ */
 celix_properties_t* celix_properties_load(const char *filename);
 
 celix_properties_t* celix_properties_loadWithStream(FILE *stream);
@@ -72,6 +76,18 @@ double celix_properties_getAsDouble(const celix_properties_t *props, const char
 
 int celix_properties_size(const celix_properties_t *properties);
 
+/**
+ * Returns the bit of the key in the key bitmap of properties, see celix_properties_getKeyBits.
+ */
+uint64_t celix_properties_keyBit(const char *key);
+
+/**
+ * Returns a Bloom-style bitmap of the keys of the properties: a key can only be present if its bit
+ * (celix_properties_keyBit) is set. Bits of removed keys are not cleared.
+ * Returns all bits set for properties not created with celix_properties_create, for which no bitmap is maintained.
+ */
+uint64_t celix_properties_getKeyBits(const celix_properties_t *properties);
+
 celix_properties_iterator_t celix_propertiesIterator_construct(const celix_properties_t *properties);
 bool celix_propertiesIterator_hasNext(celix_properties_iterator_t *iter);
 const char* celix_propertiesIterator_nextKey(celix_properties_iterator_t *iter);
@@ -0,0 +1,103 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *  KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+#ifndef CELIX_RING_BUFFER_H_
+#define CELIX_RING_BUFFER_H_
+
+#include <stddef.h>
+#include <stdbool.h>
+
+#include "exports.h"
+#include "celix_errno.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Bounded lock-free ring buffer of pointers.
+ *
+ * The non-blocking push/pop never lock or allocate. The blocking push/pop only take a mutex when they need to wait,
+ * pushers and poppers only signal when there are waiters.
+ */
+typedef struct celix_ring_buffer celix_ring_buffer_t;
+
+typedef enum celix_ring_buffer_mode {
+    /**
+     * Single producer, single consumer. At most one thread pushes and at most one thread pops at the same time.
+     */
+    CELIX_RING_BUFFER_SPSC = 0,
+
+    /**
+     * Multiple producers, multiple consumers.
+     */
+    CELIX_RING_BUFFER_MPMC = 1
+} celix_ring_buffer_mode_e;
+
+/**
+ * Creates a ring buffer. The capacity is rounded up to a power of 2.
+ * Returns NULL if capacity is 0 or memory cannot be allocated.
+ */
+UTILS_EXPORT celix_ring_buffer_t* celix_ringBuffer_create(size_t capacity, celix_ring_buffer_mode_e mode);
+
+/**
+ * Destroys the ring buffer. Elements still in the ring buffer are not freed.
+ * Should not be called when threads are still using the ring buffer.
+ */
+UTILS_EXPORT void celix_ringBuffer_destroy(celix_ring_buffer_t *rb);
+
+UTILS_EXPORT size_t celix_ringBuffer_capacity(const celix_ring_buffer_t *rb);
+
+/**
+ * Returns the number of elements in the ring buffer. Only a snapshot if other threads are pushing or popping.
+ */
+UTILS_EXPORT size_t celix_ringBuffer_size(const celix_ring_buffer_t *rb);
+
+/**
+ * Pushes element to the ring buffer if there is room. Returns false if the ring buffer is full or closed.
+ */
+UTILS_EXPORT bool celix_ringBuffer_tryPush(celix_ring_buffer_t *rb, void *element);
+
+/**
+ * Pops an element from the ring buffer if available. Returns false if the ring buffer is empty.
+ */
+UTILS_EXPORT bool celix_ringBuffer_tryPop(celix_ring_buffer_t *rb, void **elementOut);
+
+/**
+ * Pushes element to the ring buffer, blocks until there is room.
+ * Returns CELIX_ILLEGAL_STATE if the ring buffer is (or gets) closed.
+ */
+UTILS_EXPORT celix_status_t celix_ringBuffer_push(celix_ring_buffer_t *rb, void *element);
+
+/**
+ * Pops an element from the ring buffer, blocks until an element is available.
+ * Returns CELIX_ILLEGAL_STATE if the ring buffer is closed and empty.
+ */
+UTILS_EXPORT celix_status_t celix_ringBuffer_pop(celix_ring_buffer_t *rb, void **elementOut);
+
+/**
+ * Closes the ring buffer: pushes fail from now on and blocked push/pop calls are woken up.
+ * Elements already in the ring buffer can still be popped.
+ */
+UTILS_EXPORT void celix_ringBuffer_close(celix_ring_buffer_t *rb);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* CELIX_RING_BUFFER_H_ */
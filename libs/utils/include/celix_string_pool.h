@@ -0,0 +1,74 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *  KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+#ifndef CELIX_STRING_POOL_H_
+#define CELIX_STRING_POOL_H_
+
+#include <stddef.h>
+#include <stdbool.h>
+
+#include "exports.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Process wide, thread safe pool of interned strings, for identifiers which are used over and over again,
+ * e.g. service names and property keys.
+ *
+ * Interning a string returns a stable pointer to a single copy of the string. Two strings interned in the pool are
+ * equal if, and only if, their pointers are equal, so comparisons of interned strings are pointer comparisons.
+ * Interned strings are reference counted; a string is kept in the pool till every celix_stringPool_intern call
+ * is matched with a celix_stringPool_release call.
+ */
+
+/**
+ * Interns str and returns the pooled copy. The returned pointer is valid till it is released.
+ * Returns NULL if str is NULL or memory cannot be allocated.
+ */
+UTILS_EXPORT const char* celix_stringPool_intern(const char *str);
+
+/**
+ * Interns an already interned string again, i.e. increases its reference count without a lookup.
+ * Returns pooled.
+ */
+UTILS_EXPORT const char* celix_stringPool_retain(const char *pooled);
+
+/**
+ * Releases a string returned by celix_stringPool_intern or celix_stringPool_retain. NULL is ignored.
+ */
+UTILS_EXPORT void celix_stringPool_release(const char *pooled);
+
+/**
+ * Returns the interned copy of str, without interning it. Returns NULL if str is not in the pool.
+ * Note that the returned pointer is not retained and is only valid as long as the caller holds another reference
+ * to the same string.
+ */
+UTILS_EXPORT const char* celix_stringPool_lookup(const char *str);
+
+/**
+ * Returns the number of distinct strings in the pool.
+ */
+UTILS_EXPORT size_t celix_stringPool_size(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* CELIX_STRING_POOL_H_ */
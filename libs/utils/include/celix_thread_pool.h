@@ -0,0 +1,141 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *  KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#ifndef CELIX_THREAD_POOL_H_
+#define CELIX_THREAD_POOL_H_
+
+#include <stddef.h>
+#include <stdbool.h>
+
+#include "exports.h"
+#include "celix_errno.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Thread pool with a job queue per worker thread and work stealing.
+ *
+ * Jobs submitted from a worker thread of the pool are queued on the queue of that worker, jobs submitted from other
+ * threads are distributed round-robin over the workers. A worker executes the jobs of its own queue in submit
+ * order and steals the newest jobs of the other workers when its own queue is empty.
+ *
+ * This is intended as shared facility to replace the thpool (see thpool.h), which uses a single job queue and
+ * polls with sleep(1) on hold and destroy.
+ */
+typedef struct celix_thread_pool celix_thread_pool_t;
+typedef struct celix_thread_pool_future celix_thread_pool_future_t;
+
+/**
+ * A job, the return value is provided to the done callback or future.
+ */
+typedef void* (*celix_thread_pool_job_fp)(void *data);
+
+/**
+ * Completion callback, called on the worker thread right after the job finished.
+ */
+typedef void (*celix_thread_pool_done_fp)(void *doneHandle, void *result);
+
+typedef struct celix_thread_pool_options {
+    /**
+     * The number of worker threads. If 0 the number of online CPUs is used.
+     */
+    size_t nrOfThreads;
+
+    /**
+     * The maximum number of queued (not yet started) jobs. If 0 the queue is unbounded.
+     * When the queue is full celix_threadPool_execute and celix_threadPool_submit block until there is room
+     * (backpressure) and celix_threadPool_tryExecute fails.
+     */
+    size_t maxQueueSize;
+
+    /**
+     * If true worker thread i is pinned to CPU (i % nr of online CPUs). Only supported on Linux, ignored otherwise.
+     */
+    bool pinThreads;
+
+    /**
+     * Optional name of the pool, used for the names of the worker threads (max 10 characters are used).
+     */
+    const char *name;
+} celix_thread_pool_options_t;
+
+#define CELIX_EMPTY_THREAD_POOL_OPTIONS { .nrOfThreads = 0, .maxQueueSize = 0, .pinThreads = false, .name = NULL }
+
+/**
+ * Creates a thread pool. If opts is NULL the default options are used.
+ * Returns NULL if no worker thread could be created.
+ */
+UTILS_EXPORT celix_thread_pool_t* celix_threadPool_create(const celix_thread_pool_options_t *opts);
+
+/**
+ * Destroys the thread pool. Already queued jobs are still executed, new jobs are refused.
+ * Should not be called from a worker thread of the pool.
+ */
+UTILS_EXPORT void celix_threadPool_destroy(celix_thread_pool_t *pool);
+
+/**
+ * Returns the number of worker threads.
+ */
+UTILS_EXPORT size_t celix_threadPool_nrOfThreads(const celix_thread_pool_t *pool);
+
+/**
+ * Queues a job. If the queue is full this call blocks until there is room, unless called from a worker thread
+ * of the pool (to prevent a deadlock between workers).
+ *
+ * @param done          Optional completion callback.
+ * @return CELIX_SUCCESS or CELIX_ILLEGAL_STATE if the pool is being destroyed.
+ */
+UTILS_EXPORT celix_status_t celix_threadPool_execute(celix_thread_pool_t *pool, celix_thread_pool_job_fp job, void *data, void *doneHandle, celix_thread_pool_done_fp done);
+
+/**
+ * Same as celix_threadPool_execute, but never blocks.
+ * @return CELIX_SUCCESS, CELIX_ILLEGAL_STATE if the pool is being destroyed or CELIX_ENOMEM if the queue is full.
+ */
+UTILS_EXPORT celix_status_t celix_threadPool_tryExecute(celix_thread_pool_t *pool, celix_thread_pool_job_fp job, void *data, void *doneHandle, celix_thread_pool_done_fp done);
+
+/**
+ * Queues a job and returns a future for the result of the job.
+ * The caller is owner of the future and should call celix_threadPoolFuture_get exactly once.
+ * Returns NULL if the pool is being destroyed.
+ */
+UTILS_EXPORT celix_thread_pool_future_t* celix_threadPool_submit(celix_thread_pool_t *pool, celix_thread_pool_job_fp job, void *data);
+
+/**
+ * Blocks until all queued and running jobs are done.
+ * Should not be called from a worker thread of the pool.
+ */
+UTILS_EXPORT void celix_threadPool_waitUntilIdle(celix_thread_pool_t *pool);
+
+/**
+ * Returns whether the job of the future is done.
+ */
+UTILS_EXPORT bool celix_threadPoolFuture_isDone(celix_thread_pool_future_t *future);
+
+/**
+ * Waits until the job of the future is done, destroys the future and returns the result of the job.
+ */
+UTILS_EXPORT void* celix_threadPoolFuture_get(celix_thread_pool_future_t *future);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* CELIX_THREAD_POOL_H_ */
@@ -31,6 +31,7 @@
 #include <stdbool.h>
 
 #include "celix_errno.h"
+#include "celix_array_list.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -55,10 +56,30 @@ celix_status_t
 celixThread_create(celix_thread_t *new_thread, celix_thread_attr_t *attr, celix_thread_start_t func, void *data);
 
 /**
- * If supported by the platform sets the name of the thread.
+ * If supported by the platform sets the name of the thread (truncated to 15 characters) and applies the configured
+ * affinity and priority of the thread name, see celixThread_setConfigLookup.
  */
 void celixThread_setName(celix_thread_t *thread, const char *threadName);
 
+#define CELIX_THREAD_CONFIG_PREFIX "CELIX_THREAD."
+
+/**
+ * Returns the value of a configuration key or NULL if not configured.
+ */
+typedef const char* (*celix_thread_config_lookup_fp)(void *handle, const char *key);
+
+/**
+ * Sets the process wide lookup of the thread configuration, used by celixThread_setName. The framework sets this to
+ * its configuration properties. Set a NULL lookup to clear the configuration.
+ *
+ * The following keys are looked up for a thread name, where <name> is the thread name with spaces replaced by
+ * underscores, the name without a trailing "-<nr>" (e.g. the workers of a thread pool) or '*' for all named threads:
+ *  - CELIX_THREAD.<name>.AFFINITY: the CPUs the thread may run on, e.g. "0,2-3". Linux only.
+ *  - CELIX_THREAD.<name>.PRIORITY: a real-time (SCHED_FIFO) priority between 1 and 99, or 0 for normal scheduling.
+ *    Setting a real-time priority requires the CAP_SYS_NICE capability.
+ */
+void celixThread_setConfigLookup(celix_thread_config_lookup_fp lookup, void *handle);
+
 void celixThread_exit(void *exitStatus);
 
 celix_status_t celixThread_detach(celix_thread_t thread);
@@ -73,6 +94,41 @@ int celixThread_equals(celix_thread_t thread1, celix_thread_t thread2);
 
 bool celixThread_initialized(celix_thread_t thread);
 
+/**
+ * Sets the owner (e.g. a bundle id) of the threads created with celixThread_create by the calling thread and returns
+ * the previous owner. A thread created with celixThread_create is owned by the creation owner of the creating thread
+ * and its own creation owner defaults to its owner, so threads created by a thread are owned by the same owner.
+ * For other threads (e.g. the main thread) the creation owner defaults to -1 (unknown).
+ */
+long celixThread_setCreationOwner(long ownerId);
+
+/**
+ * Runtime info of a thread created with celixThread_create.
+ */
+typedef struct celix_thread_info {
+    char name[16];
+    long ownerId; //see celixThread_setCreationOwner
+    long tid; //Linux thread id, -1 if not supported
+    unsigned long long cpuTimeInNs;
+    unsigned long nrOfVoluntaryContextSwitches; //Linux only
+    unsigned long nrOfInvoluntaryContextSwitches; //Linux only
+    unsigned long long allocatedBytes; //total nr of bytes allocated by the thread, see celixThread_isAllocationAccountingEnabled
+} celix_thread_info_t;
+
+/**
+ * Returns the info of the running threads created with celixThread_create. The array contains celix_thread_info_t
+ * entries and must be destroyed with celixThread_destroyThreadInfos.
+ */
+celix_array_list_t* celixThread_getThreadInfos(void);
+
+void celixThread_destroyThreadInfos(celix_array_list_t *infos);
+
+/**
+ * Returns true if the allocated bytes per thread are accounted. This requires a build with
+ * ENABLE_THREAD_ALLOC_ACCOUNTING (glibc only), which adds a malloc/calloc/realloc hook to the utils library.
+ */
+bool celixThread_isAllocationAccountingEnabled(void);
+
 
 typedef pthread_mutex_t celix_thread_mutex_t;
 typedef pthread_mutexattr_t celix_thread_mutexattr_t;
@@ -92,6 +148,11 @@ celix_status_t celixThreadMutex_destroy(celix_thread_mutex_t *mutex);
 
 celix_status_t celixThreadMutex_lock(celix_thread_mutex_t *mutex);
 
+/**
+ * Tries to lock the mutex, returns CELIX_SUCCESS if locked and EBUSY if the mutex is already locked.
+ */
+celix_status_t celixThreadMutex_tryLock(celix_thread_mutex_t *mutex);
+
 celix_status_t celixThreadMutex_unlock(celix_thread_mutex_t *mutex);
 
 celix_status_t celixThreadMutexAttr_create(celix_thread_mutexattr_t *attr);
@@ -118,6 +179,188 @@ celix_status_t celixThreadRwlockAttr_create(celix_thread_rwlockattr_t *attr);
 celix_status_t celixThreadRwlockAttr_destroy(celix_thread_rwlockattr_t *attr);
 //NOTE: No support yet for setting specific rw lock attributes
 
+/**
+ * Creates a mutex/rwlock with a name. If the lock profiler is enabled (see below) the name is used as creation site
+ * of the lock, otherwise the name is ignored.
+ */
+celix_status_t celixThreadMutex_createNamed(celix_thread_mutex_t *mutex, celix_thread_mutexattr_t *attr, const char *name);
+
+celix_status_t celixThreadRwlock_createNamed(celix_thread_rwlock_t *lock, celix_thread_rwlockattr_t *attr, const char *name);
+
+/**
+ * Lock profiler. If Celix is build with ENABLE_LOCK_PROFILING (CELIX_LOCK_PROFILING defined) the celix_thread_mutex_t
+ * and celix_thread_rwlock_t locks record the acquisitions, contention, wait time and hold time per creation site.
+ * The creation site is the name given to celixThread(Mutex|Rwlock)_createNamed or the <file>:<line> of the
+ * celixThread(Mutex|Rwlock)_create call. Locks not created with these functions (e.g. PTHREAD_MUTEX_INITIALIZER)
+ * are not profiled.
+ *
+ * The histograms have log2 buckets: bucket 0 is < 1us, bucket i is [2^(i-1), 2^i) us and the last bucket is the rest.
+ */
+#define CELIX_THREAD_LOCK_PROFILE_NR_OF_BUCKETS 16
+#define CELIX_THREAD_LOCK_PROFILE_MAX_SITE_LENGTH 128
+
+typedef struct celix_thread_lock_profile {
+    char site[CELIX_THREAD_LOCK_PROFILE_MAX_SITE_LENGTH];
+    bool rwlock;
+    unsigned long nrOfLocks; //nr of acquisitions (incl. read locks)
+    unsigned long nrOfContendedLocks; //nr of acquisitions which had to wait
+    unsigned long long totalWaitTimeInNs;
+    unsigned long long maxWaitTimeInNs;
+    unsigned long long totalHoldTimeInNs;
+    unsigned long long maxHoldTimeInNs;
+    unsigned long waitHistogram[CELIX_THREAD_LOCK_PROFILE_NR_OF_BUCKETS];
+    unsigned long holdHistogram[CELIX_THREAD_LOCK_PROFILE_NR_OF_BUCKETS];
+} celix_thread_lock_profile_t;
+
+/**
+ * Returns true if the lock profiler is compiled in.
+ */
+bool celixThreadLockProfiler_isEnabled(void);
+
+/**
+ * Returns a snapshot of the lock profiles, sorted on total wait time (most contended first).
+ * The array contains celix_thread_lock_profile_t entries and must be destroyed with
+ * celixThreadLockProfiler_destroyProfiles. Returns an empty array if the profiler is not enabled.
+ */
+celix_array_list_t* celixThreadLockProfiler_getProfiles(void);
+
+void celixThreadLockProfiler_destroyProfiles(celix_array_list_t *profiles);
+
+/**
+ * Resets the counters and histograms of all lock creation sites.
+ */
+void celixThreadLockProfiler_reset(void);
+
+#ifdef CELIX_LOCK_PROFILING
+#define CELIX_THREAD_LOCK_SITE_STR_(x) #x
+#define CELIX_THREAD_LOCK_SITE_STR(x) CELIX_THREAD_LOCK_SITE_STR_(x)
+#define CELIX_THREAD_LOCK_SITE __FILE__ ":" CELIX_THREAD_LOCK_SITE_STR(__LINE__)
+#define celixThreadMutex_create(mutex, attr) celixThreadMutex_createNamed((mutex), (attr), CELIX_THREAD_LOCK_SITE)
+#define celixThreadRwlock_create(lock, attr) celixThreadRwlock_createNamed((lock), (attr), CELIX_THREAD_LOCK_SITE)
+#endif
+
+/**
+ * Optional contention statistics for the sharded rwlock, spin mutex and seqlock.
+ */
+typedef struct celix_thread_lock_stats {
+    unsigned long nrOfReadLocks; //sharded rwlock only
+    unsigned long nrOfWriteLocks; //nr of write locks, for the spin mutex the nr of locks
+    unsigned long nrOfContendedLocks; //nr of (read/write) locks which had to wait
+    unsigned long nrOfReadRetries; //seqlock only, nr of read sections which had to be retried
+} celix_thread_lock_stats_t;
+
+#define CELIX_THREAD_CACHE_LINE_SIZE 64
+#define CELIX_THREAD_SHARDED_RWLOCK_NR_OF_SHARDS 16
+
+typedef struct celix_thread_sharded_rwlock_shard {
+    unsigned long readers; //atomic
+    unsigned long nrOfReadLocks; //atomic, only updated if stats are enabled
+    unsigned long nrOfContendedLocks; //atomic, only updated if stats are enabled
+} __attribute__((aligned(CELIX_THREAD_CACHE_LINE_SIZE))) celix_thread_sharded_rwlock_shard_t;
+
+/**
+ * Reader biased rwlock. Readers only update the reader count of their own shard (cache line), so concurrent readers
+ * do not contend. A writer waits until all shards are drained and is therefore more expensive than for a
+ * celix_thread_rwlock_t. Intended for read mostly data, e.g. connection tables or indices looked up for every call.
+ *
+ * Read locks are not reentrant and must be unlocked by the thread that locked them.
+ */
+typedef struct celix_thread_sharded_rwlock {
+    celix_thread_sharded_rwlock_shard_t shards[CELIX_THREAD_SHARDED_RWLOCK_NR_OF_SHARDS];
+    bool writer; //atomic
+    bool statsEnabled;
+    unsigned long nrOfWriteLocks; //protected by mutex
+    unsigned long nrOfContendedWriteLocks; //protected by mutex
+    pthread_mutex_t mutex; //serializes the writers
+    pthread_cond_t cond; //signaled when the writer is done
+} celix_thread_sharded_rwlock_t;
+
+celix_status_t celixThreadShardedRwlock_create(celix_thread_sharded_rwlock_t *lock, bool enableStats);
+
+celix_status_t celixThreadShardedRwlock_destroy(celix_thread_sharded_rwlock_t *lock);
+
+celix_status_t celixThreadShardedRwlock_readLock(celix_thread_sharded_rwlock_t *lock);
+
+celix_status_t celixThreadShardedRwlock_readUnlock(celix_thread_sharded_rwlock_t *lock);
+
+celix_status_t celixThreadShardedRwlock_writeLock(celix_thread_sharded_rwlock_t *lock);
+
+celix_status_t celixThreadShardedRwlock_writeUnlock(celix_thread_sharded_rwlock_t *lock);
+
+/**
+ * Returns the contention statistics. All counters are 0 if the lock is created without stats.
+ */
+void celixThreadShardedRwlock_getStats(celix_thread_sharded_rwlock_t *lock, celix_thread_lock_stats_t *stats);
+
+
+/**
+ * Adaptive spin mutex. A lock first spins (with trylock) for a while before parking the thread on a
+ * pthread mutex. The number of spins adapts to how long it took to acquire the lock before, so short critical
+ * sections avoid the cost of a sleep/wake up.
+ */
+typedef struct celix_thread_spin_mutex {
+    pthread_mutex_t mutex;
+    int maxSpins;
+    int spins; //adaptive spin estimate, only updated by the lock owner
+    bool statsEnabled;
+    unsigned long nrOfLocks; //only updated by the lock owner
+    unsigned long nrOfContendedLocks; //only updated by the lock owner
+} celix_thread_spin_mutex_t;
+
+/**
+ * Creates a spin mutex. If maxSpins is 0 a default (100) is used.
+ */
+celix_status_t celixThreadSpinMutex_create(celix_thread_spin_mutex_t *mutex, int maxSpins, bool enableStats);
+
+celix_status_t celixThreadSpinMutex_destroy(celix_thread_spin_mutex_t *mutex);
+
+celix_status_t celixThreadSpinMutex_lock(celix_thread_spin_mutex_t *mutex);
+
+celix_status_t celixThreadSpinMutex_unlock(celix_thread_spin_mutex_t *mutex);
+
+/**
+ * Returns the contention statistics. The counters are read without locking and are only a snapshot.
+ */
+void celixThreadSpinMutex_getStats(celix_thread_spin_mutex_t *mutex, celix_thread_lock_stats_t *stats);
+
+
+/**
+ * Sequence lock for small, rarely changing data. Readers never block a writer (and vice versa), but a reader has to
+ * retry if a write happened during the read:
+ *
+ *     unsigned int seq;
+ *     do {
+ *         seq = celixThreadSeqlock_readBegin(&lock);
+ *         copy = data; //only copy plain data (e.g. with relaxed atomic loads), do not dereference pointers
+ *     } while (celixThreadSeqlock_readRetry(&lock, seq));
+ *
+ * Writers are serialized with a mutex.
+ */
+typedef struct celix_thread_seqlock {
+    unsigned int seq; //atomic, odd when a write is in progress
+    bool statsEnabled;
+    unsigned long nrOfWriteLocks; //protected by mutex
+    unsigned long nrOfReadRetries; //atomic, only updated if stats are enabled
+    pthread_mutex_t mutex;
+} celix_thread_seqlock_t;
+
+celix_status_t celixThreadSeqlock_create(celix_thread_seqlock_t *lock, bool enableStats);
+
+celix_status_t celixThreadSeqlock_destroy(celix_thread_seqlock_t *lock);
+
+unsigned int celixThreadSeqlock_readBegin(celix_thread_seqlock_t *lock);
+
+/**
+ * Returns true if the read section started with seq must be retried.
+ */
+bool celixThreadSeqlock_readRetry(celix_thread_seqlock_t *lock, unsigned int seq);
+
+celix_status_t celixThreadSeqlock_writeLock(celix_thread_seqlock_t *lock);
+
+celix_status_t celixThreadSeqlock_writeUnlock(celix_thread_seqlock_t *lock);
+
+void celixThreadSeqlock_getStats(celix_thread_seqlock_t *lock, celix_thread_lock_stats_t *stats);
+
 
 typedef pthread_cond_t celix_thread_cond_t;
 typedef pthread_condattr_t celix_thread_condattr_t;
@@ -25,6 +25,13 @@
 #include "celix_threads.h"
 #include "array_list.h"
 #include "hash_map.h"
+#include "celix_hash_map.h"
+#include "celix_thread_pool.h"
+#include "celix_promise.h"
+#include "celix_arena.h"
+#include "celix_ring_buffer.h"
+#include "celix_string_pool.h"
+#include "celix_intrusive_list.h"
 #include "properties.h"
 #include "utils.h"
 #include "version.h"
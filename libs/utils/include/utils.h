@@ -38,8 +38,28 @@
 extern "C" {
 #endif
 
+/**
+ * djb2 hash of a string. The result is stable across versions and, for ASCII strings, across platforms. It is used for
+ * ids exchanged with other processes (e.g. pubsub msg type ids and topic ids), so it must not be changed.
+ */
 UTILS_EXPORT unsigned int utils_stringHash(const void *string);
 
+/**
+ * djb2 hash of length bytes of data. utils_stringHash(str) equals utils_hashBytes(str, strlen(str)).
+ */
+UTILS_EXPORT unsigned int utils_hashBytes(const void *data, size_t length);
+
+/**
+ * Fast (word at a time) hash of a string for in-process hash maps. The result differs between versions and between
+ * little and big endian platforms, so it must not be used for ids exchanged with other processes or stored.
+ */
+UTILS_EXPORT unsigned int utils_fastStringHash(const void *string);
+
+/**
+ * Fast hash of length bytes of data. utils_fastStringHash(str) equals utils_fastHashBytes(str, strlen(str)).
+ */
+UTILS_EXPORT unsigned int utils_fastHashBytes(const void *data, size_t length);
+
 UTILS_EXPORT int utils_stringEquals(const void *string, const void *toCompare);
 
 UTILS_EXPORT char *string_ndup(const char *s, size_t n);
@@ -57,6 +77,16 @@ UTILS_EXPORT celix_status_t utils_isNumeric(const char *number, bool *ret);
 
 UTILS_EXPORT double celix_difftime(const struct timespec *tBegin, const struct timespec *tEnd);
 
+/**
+ * Maps a file read-only in memory. The pages are loaded lazily and shared (through the page cache) with other
+ * processes mapping the same file. An empty file results in a NULL data pointer and a length of 0.
+ * The mapping must be released with utils_unmapFile.
+ * @return CELIX_SUCCESS or CELIX_FILE_IO_EXCEPTION if the file cannot be opened or mapped.
+ */
+UTILS_EXPORT celix_status_t utils_mapFile(const char *path, const void **data, size_t *length);
+
+UTILS_EXPORT void utils_unmapFile(const void *data, size_t length);
+
 #ifdef __cplusplus
 }
 #endif
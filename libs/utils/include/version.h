@@ -29,6 +29,7 @@
 
 #include "celix_errno.h"
 #include <stdbool.h>
+#include <stdint.h>
 
 #ifdef __cplusplus
 extern "C" {
@@ -179,6 +180,39 @@ celix_status_t version_toString(version_pt version, char **string);
  */
 celix_status_t version_isCompatible(version_pt user, version_pt provider, bool *isCompatible);
 
+/**
+ * Compact version key: major (16 bits), minor (24 bits) and micro (24 bits) encoded in a 64 bit value, so that
+ * versions can be compared with a single integer comparison and without allocating a version_pt.
+ * Note that the qualifier is not part of the key.
+ */
+typedef uint64_t celix_version_key_t;
+
+#define CELIX_VERSION_KEY_MAX_MAJOR 0xFFFFU
+#define CELIX_VERSION_KEY_MAX_MINOR 0xFFFFFFU
+#define CELIX_VERSION_KEY_MAX_MICRO 0xFFFFFFU
+#define CELIX_VERSION_KEY(major, minor, micro) ((((uint64_t)(major)) << 48) | (((uint64_t)(minor)) << 24) | ((uint64_t)(micro)))
+
+/**
+ * Parses a version string (major[.minor[.micro[.qualifier]]]) to a version key without allocating.
+ * The qualifier is validated, but not part of the key.
+ *
+ * @return true if the string is a valid version which fits in a version key.
+ */
+bool celix_version_parseKey(const char *versionStr, celix_version_key_t *key);
+
+/**
+ * Returns the version key of the version.
+ *
+ * @return Status code indication failure or success:
+ *         - CELIX_SUCCESS when no errors are encountered.
+ *         - CELIX_ILLEGAL_ARGUMENT If a numerical component does not fit in a version key.
+ */
+celix_status_t version_getKey(version_pt version, celix_version_key_t *key);
+
+static inline int celix_versionKey_compare(celix_version_key_t a, celix_version_key_t b) {
+    return a < b ? -1 : (a > b ? 1 : 0);
+}
+
 #ifdef __cplusplus
 }
 #endif
@@ -153,6 +153,30 @@ celix_status_t versionRange_getHighVersion(version_range_pt versionRange, versio
  */
 celix_status_t versionRange_parse(const char *rangeStr, version_range_pt *range);
 
+/**
+ * Version range on version keys (see celix_version_key_t), can be checked without allocations.
+ */
+typedef struct celix_version_range_key {
+    celix_version_key_t low;
+    celix_version_key_t high;
+    bool isLowInclusive;
+    bool isHighInclusive;
+    bool isHighInfinite;
+} celix_version_range_key_t;
+
+/**
+ * Parses a version range string (see versionRange_parse) to a version range key without allocating.
+ *
+ * @return true if the string is a valid version range and both versions fit in a version key.
+ */
+bool celix_versionRange_parseKey(const char *rangeStr, celix_version_range_key_t *range);
+
+static inline bool celix_versionRangeKey_isInRange(const celix_version_range_key_t *range, celix_version_key_t version) {
+    bool aboveLow = range->isLowInclusive ? version >= range->low : version > range->low;
+    bool belowHigh = range->isHighInfinite || (range->isHighInclusive ? version <= range->high : version < range->high);
+    return aboveLow && belowHigh;
+}
+
 #ifdef __cplusplus
 }
 #endif
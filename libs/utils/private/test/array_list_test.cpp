@@ -610,3 +610,66 @@ TEST(array_list_iterator, addAndRemovesTypes) {
     //testCelixArrayForType(celix_arrayList_addBool, celix_arrayList_removeBool, true, false, true);
     testCelixArrayForType(celix_arrayList_addSize, celix_arrayList_removeSize, (size_t)41, (size_t)42, (size_t)43);
 }
+
+static int compareLong(celix_array_list_entry_t a, celix_array_list_entry_t b) {
+    return a.longVal < b.longVal ? -1 : (a.longVal > b.longVal ? 1 : 0);
+}
+
+TEST(array_list_iterator, bulkOperations) {
+    celix_array_list_t *list = celix_arrayList_create();
+    celix_array_list_t *other = celix_arrayList_create();
+    for (long i = 0; i < 5; ++i) {
+        celix_arrayList_addLong(list, i);
+        celix_arrayList_addLong(other, 10 + i);
+    }
+
+    celix_arrayList_addAll(list, other);
+    CHECK_EQUAL(10, celix_arrayList_size(list));
+    CHECK_EQUAL(14L, celix_arrayList_getLong(list, 9));
+    celix_arrayList_addAll(list, list);
+    CHECK_EQUAL(20, celix_arrayList_size(list));
+    CHECK_EQUAL(4L, celix_arrayList_getLong(list, 14));
+
+    celix_arrayList_reserve(list, 100);
+    CHECK(list->capacity >= 100);
+    celix_arrayList_shrinkToFit(list);
+    CHECK_EQUAL(20, list->capacity);
+
+    const celix_array_list_entry_t *data = celix_arrayList_data(list);
+    CHECK_EQUAL(0L, data[0].longVal);
+    CHECK_EQUAL(14L, data[19].longVal);
+
+    celix_arrayList_swapRemoveAt(list, 0);
+    CHECK_EQUAL(19, celix_arrayList_size(list));
+    CHECK_EQUAL(14L, celix_arrayList_getLong(list, 0));
+
+    celix_arrayList_destroy(list);
+    celix_arrayList_destroy(other);
+}
+
+TEST(array_list_iterator, sortAndBinarySearch) {
+    celix_array_list_t *list = celix_arrayList_create();
+    long values[] = {5, 3, 9, 1, 3, 7, 0, 8, 2, 6, 4};
+    for (long val : values) {
+        celix_arrayList_addLong(list, val);
+    }
+    celix_arrayList_sort(list, compareLong);
+    CHECK_EQUAL(11, celix_arrayList_size(list));
+    for (int i = 1; i < celix_arrayList_size(list); ++i) {
+        CHECK(celix_arrayList_getLong(list, i - 1) <= celix_arrayList_getLong(list, i));
+    }
+
+    celix_array_list_entry_t entry;
+    memset(&entry, 0, sizeof(entry));
+    entry.longVal = 7;
+    int index = celix_arrayList_binarySearch(list, entry, compareLong);
+    CHECK(index >= 0);
+    CHECK_EQUAL(7L, celix_arrayList_getLong(list, index));
+
+    entry.longVal = 10;
+    CHECK_EQUAL(-12, celix_arrayList_binarySearch(list, entry, compareLong));
+    entry.longVal = -1;
+    CHECK_EQUAL(-1, celix_arrayList_binarySearch(list, entry, compareLong));
+
+    celix_arrayList_destroy(list);
+}
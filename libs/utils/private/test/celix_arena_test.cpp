@@ -0,0 +1,103 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *  KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <cstdint>
+
+#include "CppUTest/TestHarness.h"
+#include "CppUTest/TestHarness_c.h"
+#include "CppUTest/CommandLineTestRunner.h"
+
+extern "C"
+{
+#include "celix_arena.h"
+}
+
+int main(int argc, char** argv) {
+    return RUN_ALL_TESTS(argc, argv);
+}
+
+TEST_GROUP(celix_arena) {
+    void setup() {
+    }
+    void teardown() {
+    }
+};
+
+TEST(celix_arena, allocateAndReset) {
+    celix_arena_t *arena = celix_arena_create(256);
+    CHECK_EQUAL(0, celix_arena_capacity(arena));
+
+    void *ptrs[100];
+    for (int i = 0; i < 100; ++i) {
+        ptrs[i] = celix_arena_malloc(arena, (size_t)i + 1);
+        CHECK(ptrs[i] != NULL);
+        CHECK_EQUAL(0, (uintptr_t)ptrs[i] % 16);
+        memset(ptrs[i], i, (size_t)i + 1);
+    }
+    for (int i = 0; i < 100; ++i) {
+        auto *bytes = static_cast<unsigned char*>(ptrs[i]);
+        CHECK_EQUAL(i, bytes[0]);
+        CHECK_EQUAL(i, bytes[i]);
+    }
+    CHECK(celix_arena_allocatedSize(arena) >= 5050);
+    size_t capacity = celix_arena_capacity(arena);
+    CHECK(capacity >= celix_arena_allocatedSize(arena));
+
+    //after a reset the blocks are reused
+    celix_arena_reset(arena);
+    CHECK_EQUAL(0, celix_arena_allocatedSize(arena));
+    for (int i = 0; i < 100; ++i) {
+        CHECK(celix_arena_malloc(arena, (size_t)i + 1) != NULL);
+    }
+    CHECK_EQUAL(capacity, celix_arena_capacity(arena));
+
+    celix_arena_destroy(arena);
+}
+
+TEST(celix_arena, largeAllocation) {
+    celix_arena_t *arena = celix_arena_create(128);
+    char *small = static_cast<char*>(celix_arena_malloc(arena, 16));
+    char *large = static_cast<char*>(celix_arena_malloc(arena, 10000));
+    CHECK(small != NULL);
+    CHECK(large != NULL);
+    memset(large, 'a', 10000);
+    CHECK(celix_arena_capacity(arena) >= 10000 + 128);
+
+    //the remainder of the first block is still used for small allocations
+    char *small2 = static_cast<char*>(celix_arena_malloc(arena, 16));
+    POINTERS_EQUAL(small + 16, small2);
+
+    celix_arena_destroy(arena);
+}
+
+TEST(celix_arena, callocAndStrdup) {
+    celix_arena_t *arena = celix_arena_create(0);
+    auto *ints = static_cast<int*>(celix_arena_calloc(arena, 10, sizeof(int)));
+    for (int i = 0; i < 10; ++i) {
+        CHECK_EQUAL(0, ints[i]);
+    }
+    char *str = celix_arena_strdup(arena, "celix");
+    STRCMP_EQUAL("celix", str);
+    POINTERS_EQUAL(NULL, celix_arena_calloc(arena, SIZE_MAX, 2));
+    celix_arena_destroy(arena);
+}
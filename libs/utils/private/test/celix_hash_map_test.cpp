@@ -0,0 +1,148 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *  KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <map>
+
+#include "CppUTest/TestHarness.h"
+#include "CppUTest/TestHarness_c.h"
+#include "CppUTest/CommandLineTestRunner.h"
+
+extern "C"
+{
+#include "celix_hash_map.h"
+}
+
+int main(int argc, char** argv) {
+    return RUN_ALL_TESTS(argc, argv);
+}
+
+TEST_GROUP(celix_hash_map) {
+    void setup() {
+    }
+    void teardown() {
+    }
+};
+
+TEST(celix_hash_map, longPutGetRemove) {
+    celix_long_hash_map_t *map = celix_longHashMap_create();
+    CHECK_EQUAL(0, celix_longHashMap_size(map));
+    POINTERS_EQUAL(NULL, celix_longHashMap_get(map, 1));
+
+    POINTERS_EQUAL(NULL, celix_longHashMap_put(map, 1, (void*)0x10));
+    POINTERS_EQUAL(NULL, celix_longHashMap_put(map, -1, (void*)0x20));
+    POINTERS_EQUAL(NULL, celix_longHashMap_put(map, 0, NULL));
+    CHECK_EQUAL(3, celix_longHashMap_size(map));
+    POINTERS_EQUAL((void*)0x10, celix_longHashMap_get(map, 1));
+    POINTERS_EQUAL((void*)0x20, celix_longHashMap_get(map, -1));
+    CHECK(celix_longHashMap_hasKey(map, 0)); //NULL value
+    CHECK(!celix_longHashMap_hasKey(map, 2));
+
+    //replace
+    POINTERS_EQUAL((void*)0x10, celix_longHashMap_put(map, 1, (void*)0x11));
+    CHECK_EQUAL(3, celix_longHashMap_size(map));
+    POINTERS_EQUAL((void*)0x11, celix_longHashMap_get(map, 1));
+
+    POINTERS_EQUAL((void*)0x11, celix_longHashMap_remove(map, 1));
+    POINTERS_EQUAL(NULL, celix_longHashMap_remove(map, 1));
+    CHECK(!celix_longHashMap_hasKey(map, 1));
+    CHECK_EQUAL(2, celix_longHashMap_size(map));
+
+    celix_longHashMap_clear(map);
+    CHECK_EQUAL(0, celix_longHashMap_size(map));
+    CHECK(!celix_longHashMap_hasKey(map, -1));
+    celix_longHashMap_destroy(map);
+}
+
+TEST(celix_hash_map, longManyEntriesAgainstStdMap) {
+    //mixed puts and removes, including growing and backward shift deletion
+    celix_long_hash_map_t *map = celix_longHashMap_create();
+    std::map<long, long> expected{};
+    unsigned int seed = 42;
+    for (int i = 0; i < 20000; ++i) {
+        seed = seed * 1103515245U + 12345U;
+        long key = (long)(seed % 5000) - 2500;
+        if (seed % 3 == 0) {
+            void *removed = celix_longHashMap_remove(map, key);
+            auto it = expected.find(key);
+            if (it == expected.end()) {
+                POINTERS_EQUAL(NULL, removed);
+            } else {
+                CHECK_EQUAL(it->second, (long)removed);
+                expected.erase(it);
+            }
+        } else {
+            celix_longHashMap_put(map, key, (void*)(long)i);
+            expected[key] = i;
+        }
+    }
+    CHECK_EQUAL(expected.size(), celix_longHashMap_size(map));
+    for (auto &entry : expected) {
+        CHECK_EQUAL(entry.second, (long)celix_longHashMap_get(map, entry.first));
+    }
+
+    size_t count = 0;
+    celix_long_hash_map_iterator_t iter;
+    for (iter = celix_longHashMap_begin(map); !celix_longHashMapIterator_isEnd(&iter); celix_longHashMapIterator_next(&iter)) {
+        auto it = expected.find(iter.key);
+        CHECK(it != expected.end());
+        CHECK_EQUAL(it->second, (long)iter.value);
+        ++count;
+    }
+    CHECK_EQUAL(expected.size(), count);
+    celix_longHashMap_destroy(map);
+}
+
+TEST(celix_hash_map, stringPutGetRemove) {
+    celix_string_hash_map_t *map = celix_stringHashMap_create();
+    char key[32];
+    for (int i = 0; i < 1000; ++i) {
+        snprintf(key, sizeof(key), "key%i", i);
+        POINTERS_EQUAL(NULL, celix_stringHashMap_put(map, key, (void*)(long)(i + 1))); //note key is copied
+    }
+    CHECK_EQUAL(1000, celix_stringHashMap_size(map));
+    POINTERS_EQUAL((void*)1L, celix_stringHashMap_get(map, "key0"));
+    POINTERS_EQUAL((void*)1000L, celix_stringHashMap_get(map, "key999"));
+    CHECK(!celix_stringHashMap_hasKey(map, "key1000"));
+    CHECK(celix_stringHashMap_hasKey(map, "key500"));
+
+    POINTERS_EQUAL((void*)501L, celix_stringHashMap_put(map, "key500", (void*)0x1));
+    POINTERS_EQUAL((void*)0x1, celix_stringHashMap_remove(map, "key500"));
+    CHECK(!celix_stringHashMap_hasKey(map, "key500"));
+    CHECK_EQUAL(999, celix_stringHashMap_size(map));
+
+    size_t count = 0;
+    celix_string_hash_map_iterator_t iter;
+    for (iter = celix_stringHashMap_begin(map); !celix_stringHashMapIterator_isEnd(&iter); celix_stringHashMapIterator_next(&iter)) {
+        CHECK(strncmp("key", iter.key, 3) == 0);
+        CHECK_EQUAL(atol(iter.key + 3) + 1, (long)iter.value);
+        ++count;
+    }
+    CHECK_EQUAL(999, count);
+
+    celix_stringHashMap_clear(map);
+    CHECK_EQUAL(0, celix_stringHashMap_size(map));
+    celix_string_hash_map_iterator_t end = celix_stringHashMap_begin(map);
+    CHECK(celix_stringHashMapIterator_isEnd(&end));
+    celix_stringHashMap_put(map, "after clear", (void*)0x2);
+    celix_stringHashMap_destroy(map);
+}
@@ -0,0 +1,131 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *  KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include "CppUTest/TestHarness.h"
+#include "CppUTest/TestHarness_c.h"
+#include "CppUTest/CommandLineTestRunner.h"
+
+extern "C"
+{
+#include "celix_intrusive_list.h"
+}
+
+int main(int argc, char** argv) {
+    return RUN_ALL_TESTS(argc, argv);
+}
+
+typedef struct test_entry {
+    int value;
+    celix_ilist_node_t node;
+    celix_iqueue_node_t queueNode;
+} test_entry_t;
+
+TEST_GROUP(celix_intrusive_list) {
+    void setup() {
+    }
+    void teardown() {
+    }
+};
+
+TEST(celix_intrusive_list, pushAndPop) {
+    celix_ilist_t list;
+    celix_ilist_init(&list);
+    CHECK(celix_ilist_isEmpty(&list));
+    CHECK_EQUAL(0, celix_ilist_size(&list));
+    POINTERS_EQUAL(NULL, celix_ilist_popFront(&list));
+    POINTERS_EQUAL(NULL, celix_ilist_popBack(&list));
+
+    test_entry_t entries[3];
+    for (int i = 0; i < 3; ++i) {
+        entries[i].value = i;
+        celix_ilist_pushBack(&list, &entries[i].node);
+    }
+    CHECK(!celix_ilist_isEmpty(&list));
+    CHECK_EQUAL(3, celix_ilist_size(&list));
+    POINTERS_EQUAL(&entries[0], CELIX_ILIST_ENTRY(celix_ilist_front(&list), test_entry_t, node));
+    POINTERS_EQUAL(&entries[2], CELIX_ILIST_ENTRY(celix_ilist_back(&list), test_entry_t, node));
+
+    int expected = 0;
+    CELIX_ILIST_FOR_EACH(&list, node) {
+        CHECK_EQUAL(expected++, CELIX_ILIST_ENTRY(node, test_entry_t, node)->value);
+    }
+    CELIX_ILIST_FOR_EACH_REVERSE(&list, node) {
+        CHECK_EQUAL(--expected, CELIX_ILIST_ENTRY(node, test_entry_t, node)->value);
+    }
+
+    POINTERS_EQUAL(&entries[0].node, celix_ilist_popFront(&list));
+    POINTERS_EQUAL(&entries[2].node, celix_ilist_popBack(&list));
+    POINTERS_EQUAL(&entries[1].node, celix_ilist_popBack(&list));
+    CHECK(celix_ilist_isEmpty(&list));
+
+    celix_ilist_pushFront(&list, &entries[0].node);
+    celix_ilist_pushFront(&list, &entries[1].node);
+    POINTERS_EQUAL(&entries[1].node, celix_ilist_front(&list));
+}
+
+TEST(celix_intrusive_list, removeDuringIteration) {
+    celix_ilist_t list = CELIX_ILIST_INIT(list);
+    test_entry_t entries[10];
+    for (int i = 0; i < 10; ++i) {
+        entries[i].value = i;
+        celix_ilist_pushBack(&list, &entries[i].node);
+    }
+
+    //remove the odd entries
+    CELIX_ILIST_FOR_EACH_SAFE(&list, node) {
+        if (CELIX_ILIST_ENTRY(node, test_entry_t, node)->value % 2 != 0) {
+            celix_ilist_remove(node);
+        }
+    }
+    CHECK_EQUAL(5, celix_ilist_size(&list));
+    int expected = 0;
+    CELIX_ILIST_FOR_EACH(&list, node) {
+        CHECK_EQUAL(expected, CELIX_ILIST_ENTRY(node, test_entry_t, node)->value);
+        expected += 2;
+    }
+
+    //remove all
+    CELIX_ILIST_FOR_EACH_SAFE(&list, node) {
+        celix_ilist_remove(node);
+    }
+    CHECK(celix_ilist_isEmpty(&list));
+}
+
+TEST(celix_intrusive_list, queue) {
+    celix_iqueue_t queue = CELIX_IQUEUE_INIT;
+    CHECK(celix_iqueue_isEmpty(&queue));
+    POINTERS_EQUAL(NULL, celix_iqueue_pop(&queue));
+
+    test_entry_t entries[3];
+    for (int i = 0; i < 3; ++i) {
+        entries[i].value = i;
+        celix_iqueue_push(&queue, &entries[i].queueNode);
+    }
+    for (int i = 0; i < 2; ++i) {
+        celix_iqueue_node_t *node = celix_iqueue_pop(&queue);
+        CHECK_EQUAL(i, CELIX_ILIST_ENTRY(node, test_entry_t, queueNode)->value);
+    }
+
+    //push after partial pop keeps the FIFO order
+    celix_iqueue_push(&queue, &entries[0].queueNode);
+    POINTERS_EQUAL(&entries[2].queueNode, celix_iqueue_pop(&queue));
+    POINTERS_EQUAL(&entries[0].queueNode, celix_iqueue_pop(&queue));
+    CHECK(celix_iqueue_isEmpty(&queue));
+    POINTERS_EQUAL(NULL, celix_iqueue_pop(&queue));
+}
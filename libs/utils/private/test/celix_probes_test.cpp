@@ -0,0 +1,75 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *  KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include "CppUTest/TestHarness.h"
+#include "CppUTest/TestHarness_c.h"
+#include "CppUTest/CommandLineTestRunner.h"
+
+extern "C"
+{
+#include "celix_probes.h"
+}
+
+int main(int argc, char** argv) {
+    return RUN_ALL_TESTS(argc, argv);
+}
+
+static int nrOfCalls = 0;
+
+static int countCall(int value) {
+    ++nrOfCalls;
+    return value;
+}
+
+TEST_GROUP(celix_probes) {
+    void setup() {
+        nrOfCalls = 0;
+    }
+    void teardown() {
+    }
+};
+
+TEST(celix_probes, probeIsSingleStatement) {
+    //a probe can be used as the body of an if/else without braces
+    bool probed = false;
+    if (nrOfCalls == 0)
+        CELIX_PROBE1(test_probe1, 1);
+    else
+        probed = true;
+    CHECK(!probed);
+}
+
+TEST(celix_probes, probeArguments) {
+    const char *name = "probe";
+    long id = 42;
+    CELIX_PROBE1(test_probe1, countCall(1));
+    CELIX_PROBE2(test_probe2, id, countCall(2));
+    CELIX_PROBE3(test_probe3, id, name, countCall(3));
+    CELIX_PROBE4(test_probe4, id, name, countCall(4), sizeof(id));
+#ifdef CELIX_USDT_PROBES
+    //probe arguments are evaluated once, also when no tracer is attached
+    CHECK_EQUAL(4, nrOfCalls);
+#else
+    //without probes the arguments are not evaluated
+    CHECK_EQUAL(0, nrOfCalls);
+#endif
+    (void)name;
+    (void)id;
+    (void)countCall;
+}
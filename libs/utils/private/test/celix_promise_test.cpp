@@ -0,0 +1,181 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *  KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <stdlib.h>
+#include <errno.h>
+#include <atomic>
+#include <string>
+#include <thread>
+
+#include "CppUTest/TestHarness.h"
+#include "CppUTest/TestHarness_c.h"
+#include "CppUTest/CommandLineTestRunner.h"
+
+extern "C"
+{
+#include "celix_promise.h"
+}
+#include "celix/Promise.h"
+
+int main(int argc, char** argv) {
+    return RUN_ALL_TESTS(argc, argv);
+}
+
+TEST_GROUP(celix_promise) {
+    void setup() {
+    }
+    void teardown() {
+    }
+};
+
+static celix_status_t doubleValue(void *, celix_status_t status, void *value, void **result) {
+    if (status == CELIX_SUCCESS) {
+        long *r = (long*)malloc(sizeof(*r));
+        *r = *(long*)value * 2;
+        *result = r;
+    }
+    return status;
+}
+
+static long* newLong(long val) {
+    long *v = (long*)malloc(sizeof(*v));
+    *v = val;
+    return v;
+}
+
+TEST(celix_promise, resolveAndGet) {
+    celix_promise_t *p = celix_promise_create(free);
+    CHECK_FALSE(celix_promise_isDone(p));
+    CHECK_TRUE(celix_promise_resolve(p, newLong(21)));
+    CHECK_TRUE(celix_promise_isDone(p));
+
+    long *extra = newLong(1);
+    CHECK_FALSE(celix_promise_resolve(p, extra)); //single assignment
+    free(extra);
+    CHECK_FALSE(celix_promise_fail(p, CELIX_ILLEGAL_STATE));
+
+    void *value = NULL;
+    CHECK_EQUAL(CELIX_SUCCESS, celix_promise_get(p, &value));
+    CHECK_EQUAL(21, *(long*)value);
+    celix_promise_release(p);
+}
+
+TEST(celix_promise, thenBeforeAndAfterCompletion) {
+    celix_promise_t *p = celix_promise_create(free);
+    celix_promise_t *before = celix_promise_then(p, NULL, doubleValue, NULL, free);
+    CHECK_FALSE(celix_promise_isDone(before));
+    celix_promise_resolve(p, newLong(21));
+    celix_promise_t *after = celix_promise_then(before, NULL, doubleValue, NULL, free);
+
+    void *value = NULL;
+    CHECK_EQUAL(CELIX_SUCCESS, celix_promise_get(before, &value));
+    CHECK_EQUAL(42, *(long*)value);
+    CHECK_EQUAL(CELIX_SUCCESS, celix_promise_get(after, &value));
+    CHECK_EQUAL(84, *(long*)value);
+
+    celix_promise_release(after);
+    celix_promise_release(before);
+    celix_promise_release(p);
+}
+
+TEST(celix_promise, failurePropagates) {
+    celix_promise_t *p = celix_promise_create(free);
+    celix_promise_t *derived = celix_promise_then(p, NULL, doubleValue, NULL, free);
+    celix_promise_release(p); //the continuation keeps p alive
+    CHECK_TRUE(celix_promise_fail(p, ENOENT));
+
+    void *value = NULL;
+    CHECK_EQUAL(ENOENT, celix_promise_get(derived, &value));
+    POINTERS_EQUAL(NULL, value);
+    celix_promise_release(derived);
+}
+
+TEST(celix_promise, thenOnExecutorAndGetFromOtherThread) {
+    celix_thread_pool_options_t opts{};
+    opts.nrOfThreads = 2;
+    celix_thread_pool_t *pool = celix_threadPool_create(&opts);
+
+    for (int i = 0; i < 100; ++i) {
+        celix_promise_t *p = celix_promise_create(free);
+        celix_promise_t *derived = celix_promise_then(p, pool, doubleValue, NULL, free);
+        celix_promise_retain(p);
+        std::thread producer{[p, i]{
+            celix_promise_resolve(p, newLong(i));
+            celix_promise_release(p);
+        }};
+        void *value = NULL;
+        CHECK_EQUAL(CELIX_SUCCESS, celix_promise_get(derived, &value));
+        CHECK_EQUAL(i * 2, *(long*)value);
+        producer.join();
+        celix_promise_release(derived);
+        celix_promise_release(p);
+    }
+
+    celix_threadPool_destroy(pool);
+}
+
+static long scheduleNow(void *, double, void *data, void (*callback)(void *data)) {
+    callback(data); //fires the timeout directly
+    return 1;
+}
+
+static std::atomic<int> g_nrOfCancels{0};
+
+static bool cancelEvent(void *, long) {
+    g_nrOfCancels.fetch_add(1);
+    return true; //like the scheduler, also for the running (own) callback
+}
+
+static long scheduleNever(void *, double, void *, void (*)(void *)) {
+    return 2;
+}
+
+TEST(celix_promise, timeout) {
+    celix_promise_t *p = celix_promise_create(free);
+    CHECK_EQUAL(CELIX_SUCCESS, celix_promise_timeout(p, 0.1, NULL, scheduleNow, cancelEvent));
+    CHECK_EQUAL(ETIMEDOUT, celix_promise_get(p, NULL));
+    CHECK_EQUAL(1, g_nrOfCancels.load());
+    celix_promise_release(p);
+
+    p = celix_promise_create(free);
+    CHECK_EQUAL(CELIX_SUCCESS, celix_promise_timeout(p, 10.0, NULL, scheduleNever, cancelEvent));
+    celix_promise_resolve(p, newLong(1));
+    CHECK_EQUAL(2, g_nrOfCancels.load());
+    CHECK_EQUAL(CELIX_SUCCESS, celix_promise_get(p, NULL));
+    celix_promise_release(p);
+}
+
+TEST(celix_promise, cxxPromise) {
+    celix::Promise<std::string> p{};
+    auto length = p.then([](const std::string& s) { return (long)s.size(); });
+    auto doubled = length.then([](const long& l) { return l * 2; });
+    CHECK_TRUE(p.resolve("hello"));
+    CHECK_FALSE(p.resolve("world"));
+
+    long result = 0;
+    CHECK_EQUAL(CELIX_SUCCESS, doubled.get(result));
+    CHECK_EQUAL(10, result);
+
+    celix::Promise<std::string> failed{};
+    auto derived = failed.then([](const std::string& s) { return s + "!"; });
+    failed.fail(CELIX_ILLEGAL_STATE);
+    std::string str{};
+    CHECK_EQUAL(CELIX_ILLEGAL_STATE, derived.get(str));
+    CHECK_TRUE(str.empty());
+}
@@ -0,0 +1,146 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *  KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <thread>
+#include <vector>
+#include <atomic>
+
+#include "CppUTest/TestHarness.h"
+#include "CppUTest/TestHarness_c.h"
+#include "CppUTest/CommandLineTestRunner.h"
+
+extern "C"
+{
+#include "celix_ring_buffer.h"
+}
+
+int main(int argc, char** argv) {
+    return RUN_ALL_TESTS(argc, argv);
+}
+
+TEST_GROUP(celix_ring_buffer) {
+    void setup() {
+    }
+    void teardown() {
+    }
+};
+
+static void testTryPushPop(celix_ring_buffer_mode_e mode) {
+    celix_ring_buffer_t *rb = celix_ringBuffer_create(3, mode);
+    CHECK(rb != NULL);
+    CHECK_EQUAL(4, celix_ringBuffer_capacity(rb));
+    CHECK_EQUAL(0, celix_ringBuffer_size(rb));
+
+    void *out = NULL;
+    CHECK(!celix_ringBuffer_tryPop(rb, &out));
+    for (long i = 1; i <= 4; ++i) {
+        CHECK(celix_ringBuffer_tryPush(rb, (void*)i));
+    }
+    CHECK(!celix_ringBuffer_tryPush(rb, (void*)5L));
+    CHECK_EQUAL(4, celix_ringBuffer_size(rb));
+
+    //wrap around a few times, order is FIFO
+    for (long i = 1; i <= 20; ++i) {
+        CHECK(celix_ringBuffer_tryPop(rb, &out));
+        CHECK_EQUAL(i, (long)out);
+        CHECK(celix_ringBuffer_tryPush(rb, (void*)(i + 4)));
+    }
+
+    celix_ringBuffer_close(rb);
+    CHECK(!celix_ringBuffer_tryPush(rb, (void*)1L));
+    CHECK_EQUAL(CELIX_ILLEGAL_STATE, celix_ringBuffer_push(rb, (void*)1L));
+    for (long i = 21; i <= 24; ++i) {
+        CHECK_EQUAL(CELIX_SUCCESS, celix_ringBuffer_pop(rb, &out));
+        CHECK_EQUAL(i, (long)out);
+    }
+    CHECK_EQUAL(CELIX_ILLEGAL_STATE, celix_ringBuffer_pop(rb, &out));
+
+    celix_ringBuffer_destroy(rb);
+}
+
+TEST(celix_ring_buffer, tryPushPop) {
+    testTryPushPop(CELIX_RING_BUFFER_SPSC);
+    testTryPushPop(CELIX_RING_BUFFER_MPMC);
+    POINTERS_EQUAL(NULL, celix_ringBuffer_create(0, CELIX_RING_BUFFER_MPMC));
+}
+
+TEST(celix_ring_buffer, blockingSpsc) {
+    celix_ring_buffer_t *rb = celix_ringBuffer_create(8, CELIX_RING_BUFFER_SPSC);
+    const long count = 100000;
+
+    std::thread consumer{[rb, count]{
+        long expected = 1;
+        void *out = NULL;
+        while (celix_ringBuffer_pop(rb, &out) == CELIX_SUCCESS) {
+            CHECK_EQUAL(expected, (long)out);
+            expected += 1;
+        }
+        CHECK_EQUAL(count + 1, expected);
+    }};
+    for (long i = 1; i <= count; ++i) {
+        CHECK_EQUAL(CELIX_SUCCESS, celix_ringBuffer_push(rb, (void*)i));
+    }
+    celix_ringBuffer_close(rb);
+    consumer.join();
+
+    celix_ringBuffer_destroy(rb);
+}
+
+TEST(celix_ring_buffer, blockingMpmc) {
+    celix_ring_buffer_t *rb = celix_ringBuffer_create(16, CELIX_RING_BUFFER_MPMC);
+    const long countPerProducer = 20000;
+    const int nrOfProducers = 4;
+    const int nrOfConsumers = 3;
+
+    std::atomic<long> sum{0};
+    std::atomic<long> popped{0};
+    std::vector<std::thread> consumers;
+    for (int i = 0; i < nrOfConsumers; ++i) {
+        consumers.emplace_back([rb, &sum, &popped]{
+            void *out = NULL;
+            while (celix_ringBuffer_pop(rb, &out) == CELIX_SUCCESS) {
+                sum += (long)out;
+                popped += 1;
+            }
+        });
+    }
+    std::vector<std::thread> producers;
+    for (int i = 0; i < nrOfProducers; ++i) {
+        producers.emplace_back([rb, countPerProducer]{
+            for (long k = 1; k <= countPerProducer; ++k) {
+                celix_ringBuffer_push(rb, (void*)k);
+            }
+        });
+    }
+    for (auto &t : producers) {
+        t.join();
+    }
+    celix_ringBuffer_close(rb);
+    for (auto &t : consumers) {
+        t.join();
+    }
+
+    CHECK_EQUAL(nrOfProducers * countPerProducer, popped.load());
+    CHECK_EQUAL(nrOfProducers * (countPerProducer * (countPerProducer + 1) / 2), sum.load());
+    celix_ringBuffer_destroy(rb);
+}
@@ -0,0 +1,117 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *  KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "CppUTest/TestHarness.h"
+#include "CppUTest/TestHarness_c.h"
+#include "CppUTest/CommandLineTestRunner.h"
+
+extern "C"
+{
+#include "celix_string_pool.h"
+}
+
+int main(int argc, char** argv) {
+    return RUN_ALL_TESTS(argc, argv);
+}
+
+TEST_GROUP(celix_string_pool) {
+    void setup() {
+    }
+    void teardown() {
+    }
+};
+
+TEST(celix_string_pool, internAndRelease) {
+    size_t initialSize = celix_stringPool_size();
+    POINTERS_EQUAL(NULL, celix_stringPool_intern(NULL));
+
+    char buf1[32];
+    char buf2[32];
+    snprintf(buf1, sizeof(buf1), "%s", "calc");
+    snprintf(buf2, sizeof(buf2), "%s", "calc");
+    const char *s1 = celix_stringPool_intern(buf1);
+    const char *s2 = celix_stringPool_intern(buf2);
+    const char *s3 = celix_stringPool_intern("another");
+    STRCMP_EQUAL("calc", s1);
+    CHECK(s1 != buf1);
+    POINTERS_EQUAL(s1, s2);
+    CHECK(s1 != s3);
+    CHECK_EQUAL(initialSize + 2, celix_stringPool_size());
+    POINTERS_EQUAL(s1, celix_stringPool_lookup("calc"));
+    POINTERS_EQUAL(NULL, celix_stringPool_lookup("not interned"));
+
+    POINTERS_EQUAL(s1, celix_stringPool_retain(s1));
+    celix_stringPool_release(s1);
+    celix_stringPool_release(s2);
+    POINTERS_EQUAL(s1, celix_stringPool_lookup("calc")); //one reference left
+    celix_stringPool_release(s1);
+    POINTERS_EQUAL(NULL, celix_stringPool_lookup("calc"));
+    celix_stringPool_release(s3);
+    celix_stringPool_release(NULL);
+    CHECK_EQUAL(initialSize, celix_stringPool_size());
+}
+
+TEST(celix_string_pool, manyStrings) {
+    size_t initialSize = celix_stringPool_size();
+    std::vector<const char*> interned;
+    for (int i = 0; i < 10000; ++i) {
+        interned.push_back(celix_stringPool_intern(std::to_string(i).c_str()));
+    }
+    CHECK_EQUAL(initialSize + 10000, celix_stringPool_size());
+    for (int i = 0; i < 10000; ++i) {
+        std::string str = std::to_string(i);
+        STRCMP_EQUAL(str.c_str(), interned[i]);
+        POINTERS_EQUAL(interned[i], celix_stringPool_lookup(str.c_str()));
+    }
+    for (auto *str : interned) {
+        celix_stringPool_release(str);
+    }
+    CHECK_EQUAL(initialSize, celix_stringPool_size());
+}
+
+TEST(celix_string_pool, concurrentInternAndRelease) {
+    const char *shared = celix_stringPool_intern("shared");
+    auto loop = [shared] {
+        for (int i = 0; i < 10000; ++i) {
+            const char *s = celix_stringPool_intern("shared");
+            const char *t = celix_stringPool_intern("transient");
+            CHECK(s == shared);
+            STRCMP_EQUAL("transient", t);
+            celix_stringPool_release(t);
+            celix_stringPool_release(s);
+        }
+    };
+    std::vector<std::thread> threads;
+    for (int i = 0; i < 4; ++i) {
+        threads.emplace_back(loop);
+    }
+    for (auto &t : threads) {
+        t.join();
+    }
+    POINTERS_EQUAL(NULL, celix_stringPool_lookup("transient"));
+    celix_stringPool_release(shared);
+    POINTERS_EQUAL(NULL, celix_stringPool_lookup("shared"));
+}
@@ -0,0 +1,182 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *  KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <atomic>
+#include <unistd.h>
+
+#include "CppUTest/TestHarness.h"
+#include "CppUTest/TestHarness_c.h"
+#include "CppUTest/CommandLineTestRunner.h"
+
+extern "C"
+{
+#include "celix_thread_pool.h"
+}
+
+int main(int argc, char** argv) {
+    return RUN_ALL_TESTS(argc, argv);
+}
+
+TEST_GROUP(celix_thread_pool) {
+    void setup() {
+    }
+    void teardown() {
+    }
+};
+
+static void* incrementJob(void *data) {
+    auto *count = static_cast<std::atomic<int>*>(data);
+    count->fetch_add(1);
+    return NULL;
+}
+
+static void* squareJob(void *data) {
+    auto val = (long)data;
+    return (void*)(val * val);
+}
+
+static void doneCallback(void *handle, void *) {
+    auto *count = static_cast<std::atomic<int>*>(handle);
+    count->fetch_add(1);
+}
+
+TEST(celix_thread_pool, executeAndWaitUntilIdle) {
+    celix_thread_pool_options_t opts{};
+    opts.nrOfThreads = 4;
+    opts.name = "test";
+    celix_thread_pool_t *pool = celix_threadPool_create(&opts);
+    CHECK(pool != NULL);
+    CHECK_EQUAL(4, celix_threadPool_nrOfThreads(pool));
+
+    std::atomic<int> count{0};
+    std::atomic<int> doneCount{0};
+    for (int i = 0; i < 1000; ++i) {
+        CHECK_EQUAL(CELIX_SUCCESS, celix_threadPool_execute(pool, incrementJob, &count, &doneCount, doneCallback));
+    }
+    celix_threadPool_waitUntilIdle(pool);
+    CHECK_EQUAL(1000, count.load());
+    CHECK_EQUAL(1000, doneCount.load());
+
+    celix_threadPool_destroy(pool);
+}
+
+TEST(celix_thread_pool, submitAndGet) {
+    celix_thread_pool_t *pool = celix_threadPool_create(NULL);
+    CHECK(pool != NULL);
+    CHECK(celix_threadPool_nrOfThreads(pool) > 0);
+
+    celix_thread_pool_future_t *futures[100];
+    for (long i = 0; i < 100; ++i) {
+        futures[i] = celix_threadPool_submit(pool, squareJob, (void*)i);
+        CHECK(futures[i] != NULL);
+    }
+    for (long i = 0; i < 100; ++i) {
+        CHECK_EQUAL(i * i, (long)celix_threadPoolFuture_get(futures[i]));
+    }
+
+    celix_threadPool_destroy(pool);
+}
+
+struct nested_data {
+    celix_thread_pool_t *pool;
+    std::atomic<int> *count;
+};
+
+static void* nestedJob(void *data) {
+    auto *nested = static_cast<nested_data*>(data);
+    //submit from a worker and wait on the result, this should not deadlock a single threaded pool
+    celix_thread_pool_future_t *future = celix_threadPool_submit(nested->pool, incrementJob, nested->count);
+    celix_threadPoolFuture_get(future);
+    return NULL;
+}
+
+TEST(celix_thread_pool, submitFromWorker) {
+    celix_thread_pool_options_t opts{};
+    opts.nrOfThreads = 1;
+    celix_thread_pool_t *pool = celix_threadPool_create(&opts);
+
+    std::atomic<int> count{0};
+    nested_data data{pool, &count};
+    celix_thread_pool_future_t *futures[10];
+    for (int i = 0; i < 10; ++i) {
+        futures[i] = celix_threadPool_submit(pool, nestedJob, &data);
+    }
+    for (int i = 0; i < 10; ++i) {
+        celix_threadPoolFuture_get(futures[i]);
+    }
+    CHECK_EQUAL(10, count.load());
+
+    celix_threadPool_destroy(pool);
+}
+
+struct blocking_data {
+    std::atomic<bool> started{false};
+    std::atomic<bool> block{true};
+};
+
+static void* blockingJob(void *data) {
+    auto *blocking = static_cast<blocking_data*>(data);
+    blocking->started = true;
+    while (blocking->block.load()) {
+        usleep(1000);
+    }
+    return NULL;
+}
+
+TEST(celix_thread_pool, boundedQueue) {
+    celix_thread_pool_options_t opts{};
+    opts.nrOfThreads = 1;
+    opts.maxQueueSize = 2;
+    celix_thread_pool_t *pool = celix_threadPool_create(&opts);
+
+    blocking_data blocking{};
+    std::atomic<int> count{0};
+    CHECK_EQUAL(CELIX_SUCCESS, celix_threadPool_execute(pool, blockingJob, &blocking, NULL, NULL));
+    while (!blocking.started.load()) {
+        usleep(1000);
+    }
+    //the only worker is blocked, so the queue has room for 2 jobs
+    CHECK_EQUAL(CELIX_SUCCESS, celix_threadPool_tryExecute(pool, incrementJob, &count, NULL, NULL));
+    CHECK_EQUAL(CELIX_SUCCESS, celix_threadPool_tryExecute(pool, incrementJob, &count, NULL, NULL));
+    CHECK_EQUAL(CELIX_ENOMEM, celix_threadPool_tryExecute(pool, incrementJob, &count, NULL, NULL));
+
+    blocking.block = false;
+    celix_threadPool_waitUntilIdle(pool);
+    CHECK_EQUAL(2, count.load());
+
+    celix_threadPool_destroy(pool);
+}
+
+TEST(celix_thread_pool, destroyRunsQueuedJobs) {
+    celix_thread_pool_options_t opts{};
+    opts.nrOfThreads = 2;
+    opts.pinThreads = true;
+    celix_thread_pool_t *pool = celix_threadPool_create(&opts);
+
+    std::atomic<int> count{0};
+    for (int i = 0; i < 100; ++i) {
+        celix_threadPool_execute(pool, incrementJob, &count, NULL, NULL);
+    }
+    celix_threadPool_destroy(pool);
+    CHECK_EQUAL(100, count.load());
+}
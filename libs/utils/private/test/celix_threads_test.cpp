@@ -29,6 +29,11 @@
 #include <unistd.h>
 #include <string.h>
 #include <signal.h>
+#include <sched.h>
+#include <map>
+#include <string>
+#include <thread>
+#include <vector>
 
 #include "CppUTest/TestHarness.h"
 #include "CppUTest/TestHarness_c.h"
@@ -429,6 +434,358 @@ TEST(celix_thread_rwlock, attr){
     celixThreadRwlockAttr_destroy(&attr);
 }
 
+//----------------------CELIX SHARDED RWLOCK, SPIN MUTEX AND SEQLOCK TESTS----------------------
+
+TEST_GROUP(celix_thread_alt_locks) {
+    void setup(void) {
+    }
+
+    void teardown(void) {
+    }
+};
+
+TEST(celix_thread_alt_locks, shardedRwlock) {
+    celix_thread_sharded_rwlock_t lock;
+    LONGS_EQUAL(CELIX_SUCCESS, celixThreadShardedRwlock_create(&lock, true));
+
+    long values[2] = {0, 0}; //invariant values[0] == values[1]
+    bool invariantBroken = false;
+    std::vector<std::thread> readers;
+    for (int i = 0; i < 4; ++i) {
+        readers.emplace_back([&lock, &values, &invariantBroken]{
+            for (int k = 0; k < 10000; ++k) {
+                celixThreadShardedRwlock_readLock(&lock);
+                if (values[0] != values[1]) {
+                    invariantBroken = true;
+                }
+                celixThreadShardedRwlock_readUnlock(&lock);
+            }
+        });
+    }
+    for (int k = 0; k < 1000; ++k) {
+        celixThreadShardedRwlock_writeLock(&lock);
+        values[0] += 1;
+        values[1] += 1;
+        celixThreadShardedRwlock_writeUnlock(&lock);
+    }
+    for (auto &t : readers) {
+        t.join();
+    }
+    CHECK(!invariantBroken);
+    LONGS_EQUAL(1000, values[0]);
+
+    celix_thread_lock_stats_t stats;
+    celixThreadShardedRwlock_getStats(&lock, &stats);
+    LONGS_EQUAL(40000, stats.nrOfReadLocks);
+    LONGS_EQUAL(1000, stats.nrOfWriteLocks);
+
+    celixThreadShardedRwlock_destroy(&lock);
+}
+
+TEST(celix_thread_alt_locks, spinMutex) {
+    celix_thread_spin_mutex_t mutex;
+    LONGS_EQUAL(CELIX_SUCCESS, celixThreadSpinMutex_create(&mutex, 0, true));
+
+    long count = 0;
+    std::vector<std::thread> threads;
+    for (int i = 0; i < 4; ++i) {
+        threads.emplace_back([&mutex, &count]{
+            for (int k = 0; k < 10000; ++k) {
+                celixThreadSpinMutex_lock(&mutex);
+                count += 1;
+                celixThreadSpinMutex_unlock(&mutex);
+            }
+        });
+    }
+    for (auto &t : threads) {
+        t.join();
+    }
+    LONGS_EQUAL(40000, count);
+
+    celix_thread_lock_stats_t stats;
+    celixThreadSpinMutex_getStats(&mutex, &stats);
+    LONGS_EQUAL(40000, stats.nrOfWriteLocks);
+    CHECK(stats.nrOfContendedLocks <= stats.nrOfWriteLocks);
+
+    celixThreadSpinMutex_destroy(&mutex);
+}
+
+TEST(celix_thread_alt_locks, seqlock) {
+    celix_thread_seqlock_t lock;
+    LONGS_EQUAL(CELIX_SUCCESS, celixThreadSeqlock_create(&lock, true));
+
+    long values[2] = {0, 0}; //invariant values[0] == values[1], accessed with relaxed atomics to be data race free
+    bool invariantBroken = false;
+    std::thread reader{[&lock, &values, &invariantBroken]{
+        for (int k = 0; k < 10000; ++k) {
+            long v0;
+            long v1;
+            unsigned int seq;
+            do {
+                seq = celixThreadSeqlock_readBegin(&lock);
+                v0 = __atomic_load_n(&values[0], __ATOMIC_RELAXED);
+                v1 = __atomic_load_n(&values[1], __ATOMIC_RELAXED);
+            } while (celixThreadSeqlock_readRetry(&lock, seq));
+            if (v0 != v1) {
+                invariantBroken = true;
+            }
+        }
+    }};
+    for (int k = 0; k < 1000; ++k) {
+        celixThreadSeqlock_writeLock(&lock);
+        __atomic_store_n(&values[0], values[0] + 1, __ATOMIC_RELAXED);
+        __atomic_store_n(&values[1], values[1] + 1, __ATOMIC_RELAXED);
+        celixThreadSeqlock_writeUnlock(&lock);
+    }
+    reader.join();
+    CHECK(!invariantBroken);
+
+    celix_thread_lock_stats_t stats;
+    celixThreadSeqlock_getStats(&lock, &stats);
+    LONGS_EQUAL(1000, stats.nrOfWriteLocks);
+
+    celixThreadSeqlock_destroy(&lock);
+}
+
+//----------------------CELIX THREAD INFO TESTS----------------------
+
+TEST_GROUP(celix_thread_info) {
+    void setup(void) {
+    }
+
+    void teardown(void) {
+    }
+};
+
+extern "C" {
+static void* thread_test_func_busy(void *arg) {
+    bool *stop = static_cast<bool*>(arg);
+    while (!__atomic_load_n(stop, __ATOMIC_RELAXED)) {
+        free(malloc(64));
+    }
+    return NULL;
+}
+}
+
+TEST(celix_thread_info, infos) {
+    bool stop = false;
+    long prevOwner = celixThread_setCreationOwner(42);
+    celix_thread_t thread;
+    LONGS_EQUAL(CELIX_SUCCESS, celixThread_create(&thread, NULL, thread_test_func_busy, &stop));
+    celixThread_setCreationOwner(prevOwner);
+    celixThread_setName(&thread, "info test");
+    usleep(10000);
+
+    celix_array_list_t *infos = celixThread_getThreadInfos();
+    celix_thread_info_t *found = NULL;
+    for (int i = 0; i < celix_arrayList_size(infos); ++i) {
+        auto *info = static_cast<celix_thread_info_t*>(celix_arrayList_get(infos, i));
+        if (info->ownerId == 42) {
+            found = info;
+        }
+    }
+    CHECK(found != NULL);
+#ifdef __linux__
+    STRCMP_EQUAL("info test", found->name);
+    CHECK(found->tid > 0);
+    CHECK(found->cpuTimeInNs > 0);
+#endif
+    if (celixThread_isAllocationAccountingEnabled()) {
+        CHECK(found->allocatedBytes > 0);
+    }
+    celixThread_destroyThreadInfos(infos);
+
+    __atomic_store_n(&stop, true, __ATOMIC_RELAXED);
+    celixThread_join(thread, NULL);
+
+    infos = celixThread_getThreadInfos();
+    for (int i = 0; i < celix_arrayList_size(infos); ++i) {
+        auto *info = static_cast<celix_thread_info_t*>(celix_arrayList_get(infos, i));
+        CHECK(info->ownerId != 42);
+    }
+    celixThread_destroyThreadInfos(infos);
+}
+
+//----------------------CELIX THREAD CONFIG TESTS----------------------
+
+static const char* thread_test_config_lookup(void *handle, const char *key) {
+    auto *config = static_cast<std::map<std::string, std::string>*>(handle);
+    auto it = config->find(key);
+    return it == config->end() ? nullptr : it->second.c_str();
+}
+
+TEST_GROUP(celix_thread_config) {
+    std::map<std::string, std::string> config{};
+    bool stop = false;
+    celix_thread_t thread;
+    cpu_set_t allowed;
+    int firstCpu = -1;
+
+    void setup(void) {
+        CPU_ZERO(&allowed);
+        sched_getaffinity(0, sizeof(allowed), &allowed);
+        for (int cpu = 0; cpu < CPU_SETSIZE && firstCpu < 0; ++cpu) {
+            if (CPU_ISSET(cpu, &allowed)) {
+                firstCpu = cpu;
+            }
+        }
+        celixThread_setConfigLookup(thread_test_config_lookup, &config);
+        LONGS_EQUAL(CELIX_SUCCESS, celixThread_create(&thread, NULL, thread_test_func_busy, &stop));
+    }
+
+    void teardown(void) {
+        __atomic_store_n(&stop, true, __ATOMIC_RELAXED);
+        celixThread_join(thread, NULL);
+        celixThread_setConfigLookup(NULL, NULL);
+    }
+
+    bool runsOnlyOnFirstCpu() {
+        cpu_set_t cpus;
+        CPU_ZERO(&cpus);
+        pthread_getaffinity_np(thread.thread, sizeof(cpus), &cpus);
+        return CPU_COUNT(&cpus) == 1 && CPU_ISSET(firstCpu, &cpus);
+    }
+
+    bool runsOnAllowedCpus() {
+        cpu_set_t cpus;
+        CPU_ZERO(&cpus);
+        pthread_getaffinity_np(thread.thread, sizeof(cpus), &cpus);
+        return CPU_EQUAL(&cpus, &allowed);
+    }
+};
+
+#ifdef __linux__
+TEST(celix_thread_config, nameIsTruncated) {
+    celixThread_setName(&thread, "a thread name longer than 15 characters");
+    char name[32];
+    pthread_getname_np(thread.thread, name, sizeof(name));
+    STRCMP_EQUAL("a thread name l", name);
+}
+
+TEST(celix_thread_config, affinityByName) {
+    config["CELIX_THREAD.test_thread.AFFINITY"] = std::to_string(firstCpu);
+    celixThread_setName(&thread, "other thread");
+    CHECK(runsOnAllowedCpus());
+    celixThread_setName(&thread, "test thread");
+    CHECK(runsOnlyOnFirstCpu());
+}
+
+TEST(celix_thread_config, affinityByNameWithoutNr) {
+    config["CELIX_THREAD.worker.AFFINITY"] = std::to_string(firstCpu) + "-" + std::to_string(firstCpu);
+    celixThread_setName(&thread, "worker-3");
+    CHECK(runsOnlyOnFirstCpu());
+}
+
+TEST(celix_thread_config, affinityForAllThreads) {
+    config["CELIX_THREAD.*.AFFINITY"] = std::to_string(firstCpu);
+    celixThread_setName(&thread, "any thread");
+    CHECK(runsOnlyOnFirstCpu());
+}
+
+TEST(celix_thread_config, invalidAffinityIsIgnored) {
+    config["CELIX_THREAD.*.AFFINITY"] = "no cpus";
+    celixThread_setName(&thread, "test thread");
+    CHECK(runsOnAllowedCpus());
+    config["CELIX_THREAD.*.AFFINITY"] = "3-1";
+    celixThread_setName(&thread, "test thread");
+    CHECK(runsOnAllowedCpus());
+}
+
+TEST(celix_thread_config, normalPriority) {
+    config["CELIX_THREAD.*.PRIORITY"] = "0";
+    celixThread_setName(&thread, "test thread");
+    int policy = -1;
+    struct sched_param param;
+    pthread_getschedparam(thread.thread, &policy, &param);
+    LONGS_EQUAL(SCHED_OTHER, policy);
+
+    //an out of range priority is not applied
+    config["CELIX_THREAD.*.PRIORITY"] = "100";
+    celixThread_setName(&thread, "test thread");
+    pthread_getschedparam(thread.thread, &policy, &param);
+    LONGS_EQUAL(SCHED_OTHER, policy);
+}
+
+TEST(celix_thread_config, clearedLookup) {
+    config["CELIX_THREAD.*.AFFINITY"] = std::to_string(firstCpu);
+    celixThread_setConfigLookup(NULL, NULL);
+    celixThread_setName(&thread, "test thread");
+    CHECK(runsOnAllowedCpus());
+}
+#endif
+
+//----------------------CELIX LOCK PROFILER TESTS----------------------
+
+TEST_GROUP(celix_thread_lock_profiler) {
+    void setup(void) {
+        celixThreadLockProfiler_reset();
+    }
+
+    void teardown(void) {
+    }
+};
+
+TEST(celix_thread_lock_profiler, profiles) {
+    celix_thread_mutex_t mutex;
+    celix_thread_rwlock_t lock;
+    LONGS_EQUAL(CELIX_SUCCESS, celixThreadMutex_createNamed(&mutex, NULL, "test mutex"));
+    LONGS_EQUAL(CELIX_SUCCESS, celixThreadRwlock_createNamed(&lock, NULL, "test rwlock"));
+
+    long count = 0;
+    std::vector<std::thread> threads;
+    for (int i = 0; i < 4; ++i) {
+        threads.emplace_back([&mutex, &lock, &count]{
+            for (int k = 0; k < 1000; ++k) {
+                celixThreadMutex_lock(&mutex);
+                count += 1;
+                celixThreadMutex_unlock(&mutex);
+                celixThreadRwlock_readLock(&lock);
+                celixThreadRwlock_unlock(&lock);
+            }
+        });
+    }
+    for (auto &t : threads) {
+        t.join();
+    }
+    LONGS_EQUAL(4000, count);
+
+    celix_array_list_t *profiles = celixThreadLockProfiler_getProfiles();
+    if (celixThreadLockProfiler_isEnabled()) {
+        celix_thread_lock_profile_t *mutexProfile = NULL;
+        celix_thread_lock_profile_t *rwlockProfile = NULL;
+        for (int i = 0; i < celix_arrayList_size(profiles); ++i) {
+            auto *profile = static_cast<celix_thread_lock_profile_t*>(celix_arrayList_get(profiles, i));
+            if (strcmp(profile->site, "test mutex") == 0) {
+                mutexProfile = profile;
+            } else if (strcmp(profile->site, "test rwlock") == 0) {
+                rwlockProfile = profile;
+            }
+        }
+        CHECK(mutexProfile != NULL);
+        CHECK(rwlockProfile != NULL);
+        CHECK(!mutexProfile->rwlock);
+        CHECK(rwlockProfile->rwlock);
+        LONGS_EQUAL(4000, mutexProfile->nrOfLocks);
+        LONGS_EQUAL(4000, rwlockProfile->nrOfLocks);
+        CHECK(mutexProfile->nrOfContendedLocks <= mutexProfile->nrOfLocks);
+
+        unsigned long nrOfWaits = 0;
+        unsigned long nrOfHolds = 0;
+        for (int b = 0; b < CELIX_THREAD_LOCK_PROFILE_NR_OF_BUCKETS; ++b) {
+            nrOfWaits += mutexProfile->waitHistogram[b];
+            nrOfHolds += mutexProfile->holdHistogram[b];
+        }
+        LONGS_EQUAL(4000, nrOfWaits);
+        LONGS_EQUAL(4000, nrOfHolds);
+    } else {
+        LONGS_EQUAL(0, celix_arrayList_size(profiles));
+    }
+    celixThreadLockProfiler_destroyProfiles(profiles);
+
+    celixThreadRwlock_destroy(&lock);
+    celixThreadMutex_destroy(&mutex);
+}
+
 //----------------------TEST THREAD FUNCTION DEFINES----------------------
 extern "C" {
 static void * thread_test_func_create(void * arg) {
@@ -27,6 +27,7 @@
 
 #include "celix_filter.h"
 #include "filter.h"
+#include "utils.h"
 
 int main(int argc, char** argv) {
     return RUN_ALL_TESTS(argc, argv);
@@ -543,3 +544,124 @@ TEST(filter, getString){
 }
 
 
+
+TEST(filter, match_typed_comparators){
+    celix_properties_t *props = celix_properties_create();
+    celix_properties_set(props, "long", "10");
+    celix_properties_set(props, "double", "1.5");
+    celix_properties_set(props, "version", "1.10.0");
+    celix_properties_set(props, "str", "abc");
+
+    //numeric and version values are compared as numbers and versions, not as strings
+    celix_filter_t *filter = celix_filter_create("(long>9)");
+    CHECK(celix_filter_match(filter, props));
+    celix_filter_destroy(filter);
+
+    filter = celix_filter_create("(long<=10)");
+    CHECK(celix_filter_match(filter, props));
+    celix_filter_destroy(filter);
+
+    filter = celix_filter_create("(double<1.25)");
+    CHECK_FALSE(celix_filter_match(filter, props));
+    celix_filter_destroy(filter);
+
+    filter = celix_filter_create("(double>=1)");
+    CHECK(celix_filter_match(filter, props));
+    celix_filter_destroy(filter);
+
+    filter = celix_filter_create("(version>1.9.2)");
+    CHECK(celix_filter_match(filter, props));
+    celix_filter_destroy(filter);
+
+    filter = celix_filter_create("(&(version>=1.10.0)(version<1.10.0.qualifier))");
+    CHECK(celix_filter_match(filter, props));
+    celix_filter_destroy(filter);
+
+    //fallback to string compare for non numeric property values
+    filter = celix_filter_create("(str>9)");
+    CHECK(celix_filter_match(filter, props));
+    celix_filter_destroy(filter);
+
+    filter = celix_filter_create("(|(missing>1)(!(str=abc))(long=010))");
+    CHECK_FALSE(celix_filter_match(filter, props));
+    celix_filter_destroy(filter);
+
+    celix_properties_destroy(props);
+}
+
+TEST(filter, match_tree_and_compiled_equal){
+    celix_properties_t *props = celix_properties_create();
+    celix_properties_set(props, "x", "9");
+    celix_properties_set(props, "version", "1.10.0");
+    celix_properties_set(props, "str", "abc");
+
+    struct {
+        const char *filter;
+        bool expected;
+    } cases[] = {
+        {"(x>=10)", false},
+        {"(x<10)", true},
+        {"(x>8.5)", true},
+        {"(x<=9)", true},
+        {"(version<1.9.0)", false},
+        {"(version>=1.10.0)", true},
+        {"(str<abd)", true},
+        {"(str>=9)", true},
+        {"(missing<10)", false},
+    };
+
+    for (auto &c : cases) {
+        celix_filter_t *filter = celix_filter_create(c.filter);
+        CHECK(filter->compiled != NULL);
+        CHECK_TEXT(c.expected == celix_filter_match(filter, props), c.filter);
+
+        //without the compiled instructions the filter tree is matched
+        celix_filter_compiled_t *compiled = filter->compiled;
+        filter->compiled = NULL;
+        CHECK_TEXT(c.expected == celix_filter_match(filter, props), c.filter);
+        filter->compiled = compiled;
+        celix_filter_destroy(filter);
+    }
+
+    celix_properties_destroy(props);
+}
+
+TEST(filter, match_required_keys){
+    celix_properties_t *props = celix_properties_create();
+    celix_properties_set(props, "objectClass", "calc");
+    celix_properties_set(props, "topic", "ping");
+
+    //rejected on the key bitmap or the lookup, the result has to be the same as without bitmap
+    celix_filter_t *filter = celix_filter_create("(service.exported.interfaces=*)");
+    CHECK_FALSE(celix_filter_match(filter, props));
+    celix_filter_destroy(filter);
+
+    filter = celix_filter_create("(&(objectClass=calc)(topic=ping))");
+    CHECK(celix_filter_match(filter, props));
+    celix_filter_destroy(filter);
+
+    //NOT and OR do not require keys which are absent in a matching alternative
+    filter = celix_filter_create("(&(objectClass=calc)(!(service.exported.interfaces=*)))");
+    CHECK(celix_filter_match(filter, props));
+    celix_filter_destroy(filter);
+
+    filter = celix_filter_create("(|(missing=1)(topic=ping))");
+    CHECK(celix_filter_match(filter, props));
+    celix_filter_destroy(filter);
+
+    //a removed key can keep its bit, the lookup still rejects
+    celix_properties_unset(props, "topic");
+    filter = celix_filter_create("(topic=ping)");
+    CHECK_FALSE(celix_filter_match(filter, props));
+    celix_filter_destroy(filter);
+
+    //maps without key bitmap are matched as before
+    hash_map_t *map = hashMap_create(utils_stringHash, utils_stringHash, utils_stringEquals, utils_stringEquals);
+    hashMap_put(map, (void*)"topic", (void*)"ping");
+    filter = celix_filter_create("(topic=ping)");
+    CHECK(celix_filter_match(filter, map));
+    celix_filter_destroy(filter);
+    hashMap_destroy(map, false, false);
+
+    celix_properties_destroy(props);
+}
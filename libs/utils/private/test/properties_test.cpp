@@ -35,6 +35,7 @@
 extern "C" {
 #include "properties.h"
 #include "celix_properties.h"
+#include "utils.h"
 }
 
 int main(int argc, char** argv) {
@@ -238,4 +239,112 @@ TEST(properties, sizeAndIteratorTest) {
     CHECK_EQUAL(4, count);
 
     celix_properties_destroy(props);
-}
\ No newline at end of file
+}
+TEST(properties, internedKeysAndManyEntriesTest) {
+    celix_properties_t *props = celix_properties_create();
+    celix_properties_set(props, "objectClass", "example");
+    celix_properties_setLong(props, "service.ranking", 10L);
+    celix_properties_setDouble(props, "service.version", 1.5);
+
+    char key[32];
+    for (int i = 0; i < 40; ++i) {
+        snprintf(key, sizeof(key), "key%i", i);
+        celix_properties_setLong(props, key, i);
+    }
+    CHECK_EQUAL(43, celix_properties_size(props));
+
+    STRCMP_EQUAL("example", celix_properties_get(props, "objectClass", NULL));
+    CHECK_EQUAL(10L, celix_properties_getAsLong(props, "service.ranking", -1L));
+    DOUBLES_EQUAL(1.5, celix_properties_getAsDouble(props, "service.version", 0.0), 0.001);
+    for (int i = 0; i < 40; ++i) {
+        snprintf(key, sizeof(key), "key%i", i);
+        CHECK_EQUAL(i, celix_properties_getAsLong(props, key, -1L));
+    }
+
+    //raw hash map updates should also update the typed values
+    char *old = (char*)hashMap_put(props, (void*)"service.ranking", strdup("20"));
+    free(old);
+    CHECK_EQUAL(20L, celix_properties_getAsLong(props, "service.ranking", -1L));
+
+    celix_properties_unset(props, "objectClass");
+    celix_properties_unset(props, "key3");
+    CHECK_EQUAL(41, celix_properties_size(props));
+    POINTERS_EQUAL(NULL, celix_properties_get(props, "objectClass", NULL));
+    CHECK_EQUAL(-1L, celix_properties_getAsLong(props, "key3", -1L));
+
+    celix_properties_t *copy = celix_properties_copy(props);
+    CHECK_EQUAL(41, celix_properties_size(copy));
+    CHECK_EQUAL(20L, celix_properties_getAsLong(copy, "service.ranking", -1L));
+    celix_properties_destroy(copy);
+
+    celix_properties_destroy(props);
+}
+
+TEST(properties, loadEscapesAndCommentsTest) {
+    const char *input = "  key1 = value1  \n"
+                        "#comment\n"
+                        "   ! other comment\n"
+                        "\n"
+                        "   \t \n"
+                        "key2:value:with:separators\n"
+                        "key\\=3=a\\#b\\\\c\n"
+                        "key4\n"
+                        "key5=last line without newline";
+    celix_properties_t *props = celix_properties_loadFromString(input);
+    CHECK_EQUAL(5, celix_properties_size(props));
+    STRCMP_EQUAL("value1", celix_properties_get(props, "key1", NULL));
+    STRCMP_EQUAL("value:with:separators", celix_properties_get(props, "key2", NULL));
+    STRCMP_EQUAL("a#b\\c", celix_properties_get(props, "key=3", NULL));
+    STRCMP_EQUAL("", celix_properties_get(props, "key4", NULL));
+    STRCMP_EQUAL("last line without newline", celix_properties_get(props, "key5", NULL));
+    celix_properties_destroy(props);
+}
+
+TEST(properties, loadManyEntriesTest) {
+    char propertiesFile[] = "resources-test/properties_many.txt";
+    FILE *file = fopen(propertiesFile, "w");
+    CHECK(file != NULL);
+    for (int i = 0; i < 5000; ++i) {
+        fprintf(file, "psa.tuning.entry%i = value%i\n", i, i);
+    }
+    fclose(file);
+
+    properties = celix_properties_load(propertiesFile);
+    CHECK_EQUAL(5000, celix_properties_size(properties));
+    STRCMP_EQUAL("value0", celix_properties_get(properties, "psa.tuning.entry0", NULL));
+    STRCMP_EQUAL("value4999", celix_properties_get(properties, "psa.tuning.entry4999", NULL));
+    celix_properties_destroy(properties);
+
+    file = fopen(propertiesFile, "r");
+    properties = celix_properties_loadWithStream(file);
+    fclose(file);
+    CHECK_EQUAL(5000, celix_properties_size(properties));
+    STRCMP_EQUAL("value2500", celix_properties_get(properties, "psa.tuning.entry2500", NULL));
+    celix_properties_destroy(properties);
+}
+
+TEST(properties, keyBitsTest) {
+    properties = celix_properties_create();
+    CHECK_EQUAL(0, celix_properties_getKeyBits(properties));
+
+    celix_properties_set(properties, "service.exported.interfaces", "*");
+    celix_properties_set(properties, "topic", "ping");
+    uint64_t bits = celix_properties_getKeyBits(properties);
+    CHECK(bits & celix_properties_keyBit("service.exported.interfaces"));
+    CHECK(bits & celix_properties_keyBit("topic"));
+    CHECK((bits & ~(celix_properties_keyBit("service.exported.interfaces") | celix_properties_keyBit("topic"))) == 0);
+
+    //bits of removed keys are kept (a set bit only means the key may be present)
+    celix_properties_unset(properties, "topic");
+    CHECK(celix_properties_getKeyBits(properties) & celix_properties_keyBit("topic"));
+
+    celix_properties_t *copy = celix_properties_copy(properties);
+    CHECK(celix_properties_getKeyBits(copy) & celix_properties_keyBit("service.exported.interfaces"));
+    celix_properties_destroy(copy);
+    celix_properties_destroy(properties);
+
+    //no bitmap for maps not created as properties
+    hash_map_t *map = hashMap_create(utils_stringHash, utils_stringHash, utils_stringEquals, utils_stringEquals);
+    CHECK(celix_properties_getKeyBits(map) == ~0ULL);
+    hashMap_destroy(map, false, false);
+}
@@ -25,6 +25,7 @@
  */
 
 #include "string.h"
+#include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 
@@ -106,6 +107,29 @@ TEST(utils, stringHash) {
     free(toHash);
 }
 
+TEST(utils, hashBytes) {
+    const char *key = "abc123def456ghi789jkl012mno345pqr678stu901vwx234yz";
+    UNSIGNED_LONGS_EQUAL(utils_stringHash(key), utils_hashBytes(key, strlen(key)));
+    UNSIGNED_LONGS_EQUAL(5381, utils_hashBytes(key, 0));
+}
+
+TEST(utils, fastHashBytes) {
+    //all key lengths up to and over the 16 and 48 byte blocks
+    char key[128];
+    for (size_t len = 0; len < sizeof(key) - 1; ++len) {
+        memset(key, 'x', len);
+        key[len] = '\0';
+        unsigned int hash = utils_fastStringHash(key);
+        UNSIGNED_LONGS_EQUAL(hash, utils_fastHashBytes(key, len));
+        if (len > 0) {
+            key[len - 1] = 'y';
+            CHECK(hash != utils_fastStringHash(key));
+            key[0] = 'y';
+            CHECK(hash != utils_fastStringHash(key));
+        }
+    }
+}
+
 TEST(utils, stringEquals) {
     // Compare with equal strings
     char * org = my_strdup("abc");
@@ -299,3 +323,29 @@ TEST(utils, compareServiceIdsAndRanking){
 }
 
 
+
+TEST(utils, mapFile) {
+    const char *path = "utils_test_map_file.txt";
+    FILE *file = fopen(path, "w");
+    CHECK(file != NULL);
+    fputs("mapped content", file);
+    fclose(file);
+
+    const void *data = NULL;
+    size_t length = 0;
+    LONGS_EQUAL(CELIX_SUCCESS, utils_mapFile(path, &data, &length));
+    LONGS_EQUAL(strlen("mapped content"), length);
+    CHECK(memcmp("mapped content", data, length) == 0);
+    utils_unmapFile(data, length);
+
+    //empty file
+    file = fopen(path, "w");
+    fclose(file);
+    LONGS_EQUAL(CELIX_SUCCESS, utils_mapFile(path, &data, &length));
+    POINTERS_EQUAL(NULL, data);
+    LONGS_EQUAL(0, length);
+    utils_unmapFile(data, length);
+    remove(path);
+
+    LONGS_EQUAL(CELIX_FILE_IO_EXCEPTION, utils_mapFile("does/not/exist", &data, &length));
+}
@@ -252,3 +252,31 @@ TEST(version_range, parse) {
 
 
 
+
+TEST(version_range, parseKey) {
+    celix_version_range_key_t range;
+    celix_version_key_t v;
+
+    CHECK(celix_versionRange_parseKey("[1.0.0,2.0.0)", &range));
+    celix_version_parseKey("1.0.0", &v);
+    CHECK(celix_versionRangeKey_isInRange(&range, v));
+    celix_version_parseKey("1.9.9", &v);
+    CHECK(celix_versionRangeKey_isInRange(&range, v));
+    celix_version_parseKey("2.0.0", &v);
+    CHECK(!celix_versionRangeKey_isInRange(&range, v));
+
+    CHECK(celix_versionRange_parseKey("(1.0.0,2.0.0]", &range));
+    celix_version_parseKey("1.0.0", &v);
+    CHECK(!celix_versionRangeKey_isInRange(&range, v));
+    celix_version_parseKey("2.0.0", &v);
+    CHECK(celix_versionRangeKey_isInRange(&range, v));
+
+    CHECK(celix_versionRange_parseKey("1.5", &range)); //atleast
+    celix_version_parseKey("1.4.9", &v);
+    CHECK(!celix_versionRangeKey_isInRange(&range, v));
+    celix_version_parseKey("100.0.0", &v);
+    CHECK(celix_versionRangeKey_isInRange(&range, v));
+
+    CHECK(!celix_versionRange_parseKey("1.0.0,2.0.0", &range));
+    CHECK(!celix_versionRange_parseKey("[1.0.0,2.x)", &range));
+}
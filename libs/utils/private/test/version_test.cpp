@@ -387,3 +387,36 @@ TEST(version,semanticCompatibility) {
     version_destroy(incompatible_user_by_minor);
 }
 
+
+TEST(version, parseKey) {
+    celix_version_key_t key = 0;
+    CHECK(celix_version_parseKey("1.2.3", &key));
+    CHECK(CELIX_VERSION_KEY(1, 2, 3) == key);
+    CHECK(celix_version_parseKey("1", &key));
+    CHECK(CELIX_VERSION_KEY(1, 0, 0) == key);
+    CHECK(celix_version_parseKey("1.2.3.qualifier-1_a", &key));
+    CHECK(CELIX_VERSION_KEY(1, 2, 3) == key);
+    CHECK(celix_version_parseKey("", &key));
+    CHECK(0 == key);
+
+    CHECK(!celix_version_parseKey("1.a.3", &key));
+    CHECK(!celix_version_parseKey("1.2.3.q.x", &key));
+    CHECK(!celix_version_parseKey("-1.2", &key));
+    CHECK(!celix_version_parseKey("65536.0.0", &key)); //major does not fit in key
+    CHECK(!celix_version_parseKey(NULL, &key));
+
+    //ordering of keys is the same as version_compareTo, ignoring qualifiers
+    celix_version_key_t k1, k2, k3;
+    celix_version_parseKey("1.10.0", &k1);
+    celix_version_parseKey("1.9.100", &k2);
+    celix_version_parseKey("2.0.0", &k3);
+    LONGS_EQUAL(1, celix_versionKey_compare(k1, k2));
+    LONGS_EQUAL(-1, celix_versionKey_compare(k1, k3));
+    LONGS_EQUAL(0, celix_versionKey_compare(k1, k1));
+
+    version_pt version = NULL;
+    version_createVersion(1, 10, 0, NULL, &version);
+    LONGS_EQUAL(CELIX_SUCCESS, version_getKey(version, &key));
+    CHECK(k1 == key);
+    version_destroy(version);
+}
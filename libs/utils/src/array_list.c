@@ -79,7 +79,7 @@ void arrayList_trimToSize(array_list_pt list) {
     list->modCount++;
     size_t oldCapacity = list->capacity;
     if (list->size < oldCapacity) {
-        celix_array_list_entry_t * newList = realloc(list->elementData, sizeof(void *) * list->size);
+        celix_array_list_entry_t * newList = realloc(list->elementData, sizeof(celix_array_list_entry_t) * list->size);
         list->capacity = list->size;
         list->elementData = newList;
     }
@@ -94,7 +94,7 @@ void arrayList_ensureCapacity(array_list_pt list, int capacity) {
         if (newCapacity < capacity) {
             newCapacity = capacity;
         }
-        newList = realloc(list->elementData, sizeof(void *) * newCapacity);
+        newList = realloc(list->elementData, sizeof(celix_array_list_entry_t) * newCapacity);
         list->capacity = newCapacity;
         list->elementData = newList;
     }
@@ -195,7 +195,7 @@ int arrayList_addIndex(array_list_pt list, unsigned int index, void * element) {
     }
     arrayList_ensureCapacity(list, (int)list->size+1);
     numMoved = list->size - index;
-    memmove(list->elementData+(index+1), list->elementData+index, sizeof(void *) * numMoved);
+    memmove(list->elementData+(index+1), list->elementData+index, sizeof(celix_array_list_entry_t) * numMoved);
 
     list->elementData[index].voidPtrVal = element;
     list->size++;
@@ -212,7 +212,7 @@ void * arrayList_remove(array_list_pt list, unsigned int index) {
     list->modCount++;
     oldElement = list->elementData[index].voidPtrVal;
     numMoved = list->size - index - 1;
-    memmove(list->elementData+index, list->elementData+index+1, sizeof(void *) * numMoved);
+    memmove(list->elementData+index, list->elementData+index+1, sizeof(celix_array_list_entry_t) * numMoved);
     memset(&list->elementData[--list->size], 0, sizeof(celix_array_list_entry_t));
 
     return oldElement;
@@ -223,7 +223,7 @@ void arrayList_fastRemove(array_list_pt list, unsigned int index) {
     list->modCount++;
 
     numMoved = list->size - index - 1;
-    memmove(list->elementData+index, list->elementData+index+1, sizeof(void *) * numMoved);
+    memmove(list->elementData+index, list->elementData+index+1, sizeof(celix_array_list_entry_t) * numMoved);
     memset(&list->elementData[--list->size], 0, sizeof(celix_array_list_entry_t));
 }
 
@@ -257,14 +257,8 @@ void arrayList_clear(array_list_pt list) {
 }
 
 bool arrayList_addAll(array_list_pt list, array_list_pt toAdd) {
-    unsigned int i;
     unsigned int size = arrayList_size(toAdd);
-    arrayList_ensureCapacity(list, list->size + size);
-//    memcpy(list->elementData+list->size, *toAdd->elementData, size);
-//    list->size += size;
-    for (i = 0; i < arrayList_size(toAdd); i++) {
-        arrayList_add(list, arrayList_get(toAdd, i));
-    }
+    celix_arrayList_addAll(list, toAdd);
     return size != 0;
 }
 
@@ -365,7 +359,7 @@ celix_array_list_t* celix_arrayList_createWithEquals(celix_arrayList_equals_fp e
     array_list_t *list = calloc(1, sizeof(*list));
     if (list != NULL) {
         list->capacity = 10;
-        list->elementData = malloc(sizeof(void*) * list->capacity);
+        list->elementData = malloc(sizeof(celix_array_list_entry_t) * list->capacity);
         list->equals = equals;
     }
     return list;
@@ -480,7 +474,7 @@ void celix_arrayList_removeAt(celix_array_list_t *list, int index) {
     if (index >= 0 && index < list->size) {
         list->modCount++;
         size_t numMoved = list->size - index - 1;
-        memmove(list->elementData+index, list->elementData+index+1, sizeof(void *) * numMoved);
+        memmove(list->elementData+index, list->elementData+index+1, sizeof(celix_array_list_entry_t) * numMoved);
         memset(&list->elementData[--list->size], 0, sizeof(celix_array_list_entry_t));
     }
 }
@@ -564,3 +558,88 @@ void celix_arrayList_clear(celix_array_list_t *list) {
     }
     list->size = 0;
 }
+
+void celix_arrayList_addAll(celix_array_list_t *list, const celix_array_list_t *toAdd) {
+    if (toAdd->size > 0) {
+        arrayList_ensureCapacity(list, (int)(list->size + toAdd->size));
+        //note memmove, list and toAdd can be the same list
+        memmove(list->elementData + list->size, toAdd->elementData, sizeof(celix_array_list_entry_t) * toAdd->size);
+        list->size += toAdd->size;
+    }
+}
+
+void celix_arrayList_reserve(celix_array_list_t *list, int capacity) {
+    arrayList_ensureCapacity(list, capacity);
+}
+
+void celix_arrayList_shrinkToFit(celix_array_list_t *list) {
+    if (list->size > 0) { //note keep the allocated element data for an empty list, realloc(ptr, 0) may free it
+        arrayList_trimToSize(list);
+    }
+}
+
+const celix_array_list_entry_t* celix_arrayList_data(const celix_array_list_t *list) {
+    return list->elementData;
+}
+
+void celix_arrayList_swapRemoveAt(celix_array_list_t *list, int index) {
+    if (index >= 0 && index < list->size) {
+        list->modCount++;
+        list->elementData[index] = list->elementData[list->size - 1];
+        memset(&list->elementData[--list->size], 0, sizeof(celix_array_list_entry_t));
+    }
+}
+
+void celix_arrayList_sort(celix_array_list_t *list, celix_arrayList_compare_fp compare) {
+    //bottom up merge sort, stable and without the need for a qsort_r
+    size_t size = list->size;
+    if (size < 2) {
+        return;
+    }
+    list->modCount++;
+    celix_array_list_entry_t *src = list->elementData;
+    celix_array_list_entry_t *dst = malloc(sizeof(celix_array_list_entry_t) * size);
+    for (size_t width = 1; width < size; width *= 2) {
+        for (size_t left = 0; left < size; left += 2 * width) {
+            size_t mid = left + width < size ? left + width : size;
+            size_t right = left + 2 * width < size ? left + 2 * width : size;
+            size_t i = left;
+            size_t j = mid;
+            size_t k = left;
+            while (i < mid && j < right) {
+                dst[k++] = compare(src[j], src[i]) < 0 ? src[j++] : src[i++];
+            }
+            while (i < mid) {
+                dst[k++] = src[i++];
+            }
+            while (j < right) {
+                dst[k++] = src[j++];
+            }
+        }
+        celix_array_list_entry_t *tmp = src;
+        src = dst;
+        dst = tmp;
+    }
+    if (src != list->elementData) {
+        memcpy(list->elementData, src, sizeof(celix_array_list_entry_t) * size);
+        dst = src;
+    }
+    free(dst);
+}
+
+int celix_arrayList_binarySearch(const celix_array_list_t *list, celix_array_list_entry_t entry, celix_arrayList_compare_fp compare) {
+    int low = 0;
+    int high = (int)list->size - 1;
+    while (low <= high) {
+        int mid = low + (high - low) / 2;
+        int cmp = compare(list->elementData[mid], entry);
+        if (cmp < 0) {
+            low = mid + 1;
+        } else if (cmp > 0) {
+            high = mid - 1;
+        } else {
+            return mid;
+        }
+    }
+    return -(low + 1);
+}
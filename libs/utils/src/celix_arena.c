@@ -0,0 +1,161 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *  KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+
+#include "celix_arena.h"
+
+#define CELIX_ARENA_DEFAULT_BLOCK_SIZE 4096
+#define CELIX_ARENA_ALIGNMENT 16
+
+typedef struct celix_arena_block {
+    struct celix_arena_block *next;
+    size_t size;
+    size_t used;
+    unsigned char *data;
+} celix_arena_block_t;
+
+struct celix_arena {
+    size_t blockSize;
+    celix_arena_block_t *first;
+    celix_arena_block_t *current; //block used for the next allocation, blocks after it are unused
+    size_t allocated;
+    size_t capacity;
+};
+
+static size_t celix_arena_align(size_t size) {
+    return (size + (CELIX_ARENA_ALIGNMENT - 1)) & ~((size_t)CELIX_ARENA_ALIGNMENT - 1);
+}
+
+static celix_arena_block_t* celix_arena_createBlock(size_t size) {
+    //note block header and data in one allocation, data starts at an aligned offset
+    celix_arena_block_t *block = malloc(celix_arena_align(sizeof(*block)) + size);
+    if (block != NULL) {
+        block->next = NULL;
+        block->size = size;
+        block->used = 0;
+        block->data = (unsigned char*)block + celix_arena_align(sizeof(*block));
+    }
+    return block;
+}
+
+celix_arena_t* celix_arena_create(size_t blockSize) {
+    celix_arena_t *arena = calloc(1, sizeof(*arena));
+    arena->blockSize = celix_arena_align(blockSize == 0 ? CELIX_ARENA_DEFAULT_BLOCK_SIZE : blockSize);
+    return arena;
+}
+
+void celix_arena_destroy(celix_arena_t *arena) {
+    if (arena != NULL) {
+        celix_arena_block_t *block = arena->first;
+        while (block != NULL) {
+            celix_arena_block_t *next = block->next;
+            free(block);
+            block = next;
+        }
+        free(arena);
+    }
+}
+
+void* celix_arena_malloc(celix_arena_t *arena, size_t size) {
+    size_t aligned = celix_arena_align(size == 0 ? 1 : size);
+    if (aligned < size) {
+        return NULL; //overflow
+    }
+
+    //find a block with enough room, starting at the current block. Skipped blocks are reused after a reset.
+    celix_arena_block_t *last = arena->current;
+    celix_arena_block_t *block = arena->current;
+    while (block != NULL && block->size - block->used < aligned) {
+        last = block;
+        block = block->next;
+    }
+
+    if (block == NULL && aligned > arena->blockSize) {
+        //dedicated block, inserted at the front so that the current block is still used for the next allocations
+        block = celix_arena_createBlock(aligned);
+        if (block == NULL) {
+            return NULL;
+        }
+        arena->capacity += block->size;
+        block->next = arena->first;
+        arena->first = block;
+        block->used = aligned;
+        arena->allocated += aligned;
+        if (arena->current == NULL) {
+            arena->current = block;
+        }
+        return block->data;
+    } else if (block == NULL) {
+        block = celix_arena_createBlock(arena->blockSize);
+        if (block == NULL) {
+            return NULL;
+        }
+        arena->capacity += block->size;
+        if (last == NULL) {
+            arena->first = block;
+        } else {
+            last->next = block;
+        }
+    }
+
+    void *result = block->data + block->used;
+    block->used += aligned;
+    arena->allocated += aligned;
+    arena->current = block;
+    return result;
+}
+
+void* celix_arena_calloc(celix_arena_t *arena, size_t nmemb, size_t size) {
+    if (size != 0 && nmemb > SIZE_MAX / size) {
+        return NULL;
+    }
+    void *result = celix_arena_malloc(arena, nmemb * size);
+    if (result != NULL) {
+        memset(result, 0, nmemb * size);
+    }
+    return result;
+}
+
+char* celix_arena_strdup(celix_arena_t *arena, const char *str) {
+    size_t len = strlen(str) + 1;
+    char *result = celix_arena_malloc(arena, len);
+    if (result != NULL) {
+        memcpy(result, str, len);
+    }
+    return result;
+}
+
+void celix_arena_reset(celix_arena_t *arena) {
+    for (celix_arena_block_t *block = arena->first; block != NULL; block = block->next) {
+        block->used = 0;
+    }
+    arena->current = arena->first;
+    arena->allocated = 0;
+}
+
+size_t celix_arena_allocatedSize(const celix_arena_t *arena) {
+    return arena->allocated;
+}
+
+size_t celix_arena_capacity(const celix_arena_t *arena) {
+    return arena->capacity;
+}
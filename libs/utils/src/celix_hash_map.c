@@ -0,0 +1,355 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *  KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+
+#include "celix_hash_map.h"
+#include "utils.h"
+
+#define CELIX_HASH_MAP_INITIAL_CAPACITY 16
+#define CELIX_HASH_MAP_MAX_LOAD_NUMERATOR 4   //max load factor 0.8, Robin Hood probe lengths stay short up to that
+#define CELIX_HASH_MAP_MAX_LOAD_DENOMINATOR 5
+
+typedef union celix_hash_map_key {
+    long longKey;
+    char *strKey;
+} celix_hash_map_key_t;
+
+typedef struct celix_hash_map_slot {
+    celix_hash_map_key_t key;
+    void *value;
+    unsigned int hash;
+    unsigned int dist; //0 for an empty slot, otherwise 1 + the distance to the home slot of the hash
+} celix_hash_map_slot_t;
+
+typedef struct celix_hash_map {
+    celix_hash_map_slot_t *slots;
+    size_t capacity; //always a power of 2
+    size_t size;
+} celix_hash_map_t;
+
+struct celix_long_hash_map {
+    celix_hash_map_t map;
+};
+
+struct celix_string_hash_map {
+    celix_hash_map_t map;
+};
+
+/*
+ * Note that the generic functions below are static inline and called with a constant stringKeys argument,
+ * so the compiler generates a specialized version for the long and string key maps.
+ */
+
+static inline unsigned int celix_hashMap_hashLong(long key) {
+    //murmur3 finalizer, spreads sequential keys (e.g. service or msg ids) over the slots
+    uint64_t x = (uint64_t)key;
+    x ^= x >> 33;
+    x *= 0xff51afd7ed558ccdULL;
+    x ^= x >> 33;
+    x *= 0xc4ceb9fe1a85ec53ULL;
+    x ^= x >> 33;
+    return (unsigned int)x;
+}
+
+static inline unsigned int celix_hashMap_hashString(const char *key) {
+    return utils_fastStringHash(key);
+}
+
+static inline bool celix_hashMap_keyEquals(bool stringKeys, const celix_hash_map_slot_t *slot, celix_hash_map_key_t key, unsigned int hash) {
+    if (stringKeys) {
+        return slot->hash == hash && strcmp(slot->key.strKey, key.strKey) == 0;
+    }
+    return slot->key.longKey == key.longKey;
+}
+
+static void celix_hashMap_init(celix_hash_map_t *map) {
+    map->capacity = CELIX_HASH_MAP_INITIAL_CAPACITY;
+    map->size = 0;
+    map->slots = calloc(map->capacity, sizeof(*map->slots));
+}
+
+/**
+ * Returns the slot index of the key or map->capacity if the key is not present.
+ */
+static inline size_t celix_hashMap_find(const celix_hash_map_t *map, bool stringKeys, celix_hash_map_key_t key, unsigned int hash) {
+    size_t mask = map->capacity - 1;
+    size_t index = hash & mask;
+    for (unsigned int dist = 1; ; ++dist) {
+        const celix_hash_map_slot_t *slot = &map->slots[index];
+        if (slot->dist < dist) {
+            //empty slot or a slot "richer" than the key would be, so key is not present (Robin Hood invariant)
+            return map->capacity;
+        }
+        if (celix_hashMap_keyEquals(stringKeys, slot, key, hash)) {
+            return index;
+        }
+        index = (index + 1) & mask;
+    }
+}
+
+/**
+ * Places a new (not yet present) entry, displacing entries which are closer to their home slot.
+ */
+static inline void celix_hashMap_place(celix_hash_map_slot_t *slots, size_t capacity, celix_hash_map_slot_t entry) {
+    size_t mask = capacity - 1;
+    size_t index = entry.hash & mask;
+    entry.dist = 1;
+    for (;;) {
+        celix_hash_map_slot_t *slot = &slots[index];
+        if (slot->dist == 0) {
+            *slot = entry;
+            return;
+        }
+        if (slot->dist < entry.dist) {
+            celix_hash_map_slot_t tmp = *slot;
+            *slot = entry;
+            entry = tmp;
+        }
+        index = (index + 1) & mask;
+        entry.dist += 1;
+    }
+}
+
+static void celix_hashMap_grow(celix_hash_map_t *map) {
+    size_t newCapacity = map->capacity * 2;
+    celix_hash_map_slot_t *newSlots = calloc(newCapacity, sizeof(*newSlots));
+    for (size_t i = 0; i < map->capacity; ++i) {
+        if (map->slots[i].dist != 0) {
+            celix_hashMap_place(newSlots, newCapacity, map->slots[i]);
+        }
+    }
+    free(map->slots);
+    map->slots = newSlots;
+    map->capacity = newCapacity;
+}
+
+static inline void* celix_hashMap_put(celix_hash_map_t *map, bool stringKeys, celix_hash_map_key_t key, unsigned int hash, void *value) {
+    size_t index = celix_hashMap_find(map, stringKeys, key, hash);
+    if (index < map->capacity) {
+        void *old = map->slots[index].value;
+        map->slots[index].value = value;
+        return old;
+    }
+
+    if ((map->size + 1) * CELIX_HASH_MAP_MAX_LOAD_DENOMINATOR > map->capacity * CELIX_HASH_MAP_MAX_LOAD_NUMERATOR) {
+        celix_hashMap_grow(map);
+    }
+    celix_hash_map_slot_t entry;
+    entry.key = key;
+    if (stringKeys) {
+        entry.key.strKey = strdup(key.strKey);
+    }
+    entry.value = value;
+    entry.hash = hash;
+    entry.dist = 1;
+    celix_hashMap_place(map->slots, map->capacity, entry);
+    map->size += 1;
+    return NULL;
+}
+
+static inline void* celix_hashMap_get(const celix_hash_map_t *map, bool stringKeys, celix_hash_map_key_t key, unsigned int hash) {
+    size_t index = celix_hashMap_find(map, stringKeys, key, hash);
+    return index < map->capacity ? map->slots[index].value : NULL;
+}
+
+static inline void* celix_hashMap_remove(celix_hash_map_t *map, bool stringKeys, celix_hash_map_key_t key, unsigned int hash) {
+    size_t index = celix_hashMap_find(map, stringKeys, key, hash);
+    if (index >= map->capacity) {
+        return NULL;
+    }
+    void *value = map->slots[index].value;
+    if (stringKeys) {
+        free(map->slots[index].key.strKey);
+    }
+
+    //backward shift deletion, no tombstones needed
+    size_t mask = map->capacity - 1;
+    size_t next = (index + 1) & mask;
+    while (map->slots[next].dist > 1) {
+        map->slots[index] = map->slots[next];
+        map->slots[index].dist -= 1;
+        index = next;
+        next = (next + 1) & mask;
+    }
+    memset(&map->slots[index], 0, sizeof(map->slots[index]));
+    map->size -= 1;
+    return value;
+}
+
+static void celix_hashMap_clear(celix_hash_map_t *map, bool stringKeys) {
+    if (stringKeys) {
+        for (size_t i = 0; i < map->capacity; ++i) {
+            if (map->slots[i].dist != 0) {
+                free(map->slots[i].key.strKey);
+            }
+        }
+    }
+    memset(map->slots, 0, map->capacity * sizeof(*map->slots));
+    map->size = 0;
+}
+
+/**
+ * Returns the index of the first used slot at or after index, or map->capacity if there is none.
+ */
+static inline size_t celix_hashMap_nextUsedSlot(const celix_hash_map_t *map, size_t index) {
+    while (index < map->capacity && map->slots[index].dist == 0) {
+        ++index;
+    }
+    return index;
+}
+
+celix_long_hash_map_t* celix_longHashMap_create(void) {
+    celix_long_hash_map_t *map = calloc(1, sizeof(*map));
+    celix_hashMap_init(&map->map);
+    return map;
+}
+
+void celix_longHashMap_destroy(celix_long_hash_map_t *map) {
+    if (map != NULL) {
+        free(map->map.slots);
+        free(map);
+    }
+}
+
+size_t celix_longHashMap_size(const celix_long_hash_map_t *map) {
+    return map->map.size;
+}
+
+void* celix_longHashMap_put(celix_long_hash_map_t *map, long key, void *value) {
+    celix_hash_map_key_t k = {.longKey = key};
+    return celix_hashMap_put(&map->map, false, k, celix_hashMap_hashLong(key), value);
+}
+
+void* celix_longHashMap_get(const celix_long_hash_map_t *map, long key) {
+    celix_hash_map_key_t k = {.longKey = key};
+    return celix_hashMap_get(&map->map, false, k, celix_hashMap_hashLong(key));
+}
+
+bool celix_longHashMap_hasKey(const celix_long_hash_map_t *map, long key) {
+    celix_hash_map_key_t k = {.longKey = key};
+    return celix_hashMap_find(&map->map, false, k, celix_hashMap_hashLong(key)) < map->map.capacity;
+}
+
+void* celix_longHashMap_remove(celix_long_hash_map_t *map, long key) {
+    celix_hash_map_key_t k = {.longKey = key};
+    return celix_hashMap_remove(&map->map, false, k, celix_hashMap_hashLong(key));
+}
+
+void celix_longHashMap_clear(celix_long_hash_map_t *map) {
+    celix_hashMap_clear(&map->map, false);
+}
+
+static inline void celix_longHashMapIterator_update(celix_long_hash_map_iterator_t *iter) {
+    if (iter->index < iter->map->map.capacity) {
+        iter->key = iter->map->map.slots[iter->index].key.longKey;
+        iter->value = iter->map->map.slots[iter->index].value;
+    } else {
+        iter->key = 0;
+        iter->value = NULL;
+    }
+}
+
+celix_long_hash_map_iterator_t celix_longHashMap_begin(const celix_long_hash_map_t *map) {
+    celix_long_hash_map_iterator_t iter;
+    iter.map = map;
+    iter.index = celix_hashMap_nextUsedSlot(&map->map, 0);
+    celix_longHashMapIterator_update(&iter);
+    return iter;
+}
+
+bool celix_longHashMapIterator_isEnd(const celix_long_hash_map_iterator_t *iter) {
+    return iter->index >= iter->map->map.capacity;
+}
+
+void celix_longHashMapIterator_next(celix_long_hash_map_iterator_t *iter) {
+    iter->index = celix_hashMap_nextUsedSlot(&iter->map->map, iter->index + 1);
+    celix_longHashMapIterator_update(iter);
+}
+
+celix_string_hash_map_t* celix_stringHashMap_create(void) {
+    celix_string_hash_map_t *map = calloc(1, sizeof(*map));
+    celix_hashMap_init(&map->map);
+    return map;
+}
+
+void celix_stringHashMap_destroy(celix_string_hash_map_t *map) {
+    if (map != NULL) {
+        celix_hashMap_clear(&map->map, true);
+        free(map->map.slots);
+        free(map);
+    }
+}
+
+size_t celix_stringHashMap_size(const celix_string_hash_map_t *map) {
+    return map->map.size;
+}
+
+void* celix_stringHashMap_put(celix_string_hash_map_t *map, const char *key, void *value) {
+    celix_hash_map_key_t k = {.strKey = (char*)key};
+    return celix_hashMap_put(&map->map, true, k, celix_hashMap_hashString(key), value);
+}
+
+void* celix_stringHashMap_get(const celix_string_hash_map_t *map, const char *key) {
+    celix_hash_map_key_t k = {.strKey = (char*)key};
+    return celix_hashMap_get(&map->map, true, k, celix_hashMap_hashString(key));
+}
+
+bool celix_stringHashMap_hasKey(const celix_string_hash_map_t *map, const char *key) {
+    celix_hash_map_key_t k = {.strKey = (char*)key};
+    return celix_hashMap_find(&map->map, true, k, celix_hashMap_hashString(key)) < map->map.capacity;
+}
+
+void* celix_stringHashMap_remove(celix_string_hash_map_t *map, const char *key) {
+    celix_hash_map_key_t k = {.strKey = (char*)key};
+    return celix_hashMap_remove(&map->map, true, k, celix_hashMap_hashString(key));
+}
+
+void celix_stringHashMap_clear(celix_string_hash_map_t *map) {
+    celix_hashMap_clear(&map->map, true);
+}
+
+static inline void celix_stringHashMapIterator_update(celix_string_hash_map_iterator_t *iter) {
+    if (iter->index < iter->map->map.capacity) {
+        iter->key = iter->map->map.slots[iter->index].key.strKey;
+        iter->value = iter->map->map.slots[iter->index].value;
+    } else {
+        iter->key = NULL;
+        iter->value = NULL;
+    }
+}
+
+celix_string_hash_map_iterator_t celix_stringHashMap_begin(const celix_string_hash_map_t *map) {
+    celix_string_hash_map_iterator_t iter;
+    iter.map = map;
+    iter.index = celix_hashMap_nextUsedSlot(&map->map, 0);
+    celix_stringHashMapIterator_update(&iter);
+    return iter;
+}
+
+bool celix_stringHashMapIterator_isEnd(const celix_string_hash_map_iterator_t *iter) {
+    return iter->index >= iter->map->map.capacity;
+}
+
+void celix_stringHashMapIterator_next(celix_string_hash_map_iterator_t *iter) {
+    iter->index = celix_hashMap_nextUsedSlot(&iter->map->map, iter->index + 1);
+    celix_stringHashMapIterator_update(iter);
+}
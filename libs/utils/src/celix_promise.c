@@ -0,0 +1,388 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *  KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <stdlib.h>
+#include <errno.h>
+#include <pthread.h>
+
+#include "celix_promise.h"
+#include "celix_threads.h"
+
+#define CELIX_PROMISE_PENDING       0
+#define CELIX_PROMISE_COMPLETING    1
+#define CELIX_PROMISE_DONE          2
+
+#define CELIX_PROMISE_MAX_POOLED_CELLS 128 //per thread
+
+typedef enum celix_promise_continuation_kind {
+    CELIX_PROMISE_CONTINUATION_THEN,
+    CELIX_PROMISE_CONTINUATION_WAITER,
+    CELIX_PROMISE_CONTINUATION_TIMEOUT
+} celix_promise_continuation_kind_e;
+
+typedef struct celix_promise_waiter {
+    celix_thread_mutex_t mutex;
+    celix_thread_cond_t cond;
+    bool done;
+} celix_promise_waiter_t;
+
+/**
+ * Shared by a timeout callback and the continuation cancelling it, the last one releases the promise.
+ */
+typedef struct celix_promise_timer {
+    celix_promise_t *promise;   //retained by the timer
+    int refCount;               //atomic
+    bool fired;                 //atomic, set when the callback starts
+} celix_promise_timer_t;
+
+typedef struct celix_promise_continuation celix_promise_continuation_t;
+
+struct celix_promise_continuation {
+    celix_promise_continuation_t *next;
+    celix_promise_continuation_kind_e kind;
+    celix_promise_t *source;                //retained by the continuation
+    union {
+        struct {
+            celix_thread_pool_t *executor;
+            celix_promise_then_fp fn;
+            void *data;
+            celix_promise_t *derived;       //retained by the continuation
+        } then;
+        celix_promise_waiter_t *waiter;     //on the stack of the waiting thread
+        struct {
+            void *handle;
+            celix_promise_cancel_fp cancel;
+            long eventId;
+            celix_promise_timer_t *timer;
+        } timeout;
+    };
+};
+
+struct celix_promise {
+    int state;                                      //atomic
+    int refCount;                                   //atomic
+    celix_status_t status;                          //set before the state is DONE
+    void *value;
+    void (*destroyValue)(void *value);
+    celix_promise_continuation_t *continuations;    //atomic, lock-free stack or g_completed once completed
+};
+
+typedef union celix_promise_cell {
+    union celix_promise_cell *nextFree;
+    celix_promise_t promise;
+    celix_promise_continuation_t continuation;
+    celix_promise_timer_t timer;
+} celix_promise_cell_t;
+
+typedef struct celix_promise_cell_cache {
+    celix_promise_cell_t *head;
+    size_t size;
+} celix_promise_cell_cache_t;
+
+static celix_promise_continuation_t g_completed; //marker of the continuations of a completed promise
+
+static pthread_once_t g_cellCacheKeyOnce = PTHREAD_ONCE_INIT;
+static pthread_key_t g_cellCacheKey;
+
+static void celix_promise_destroyCellCache(void *data) {
+    celix_promise_cell_cache_t *cache = data;
+    while (cache->head != NULL) {
+        celix_promise_cell_t *cell = cache->head;
+        cache->head = cell->nextFree;
+        free(cell);
+    }
+    free(cache);
+}
+
+static void celix_promise_createCellCacheKey(void) {
+    pthread_key_create(&g_cellCacheKey, celix_promise_destroyCellCache);
+}
+
+static celix_promise_cell_cache_t* celix_promise_cellCache(void) {
+    pthread_once(&g_cellCacheKeyOnce, celix_promise_createCellCacheKey);
+    celix_promise_cell_cache_t *cache = pthread_getspecific(g_cellCacheKey);
+    if (cache == NULL) {
+        cache = calloc(1, sizeof(*cache));
+        if (cache != NULL && pthread_setspecific(g_cellCacheKey, cache) != 0) {
+            free(cache);
+            cache = NULL;
+        }
+    }
+    return cache;
+}
+
+/**
+ * Cells (promises and continuations) are taken from and returned to the cache of the calling thread, so no
+ * synchronization is needed. A cell freed on another thread than it was allocated on moves to the cache of that thread.
+ */
+static celix_promise_cell_t* celix_promise_allocCell(void) {
+    celix_promise_cell_cache_t *cache = celix_promise_cellCache();
+    celix_promise_cell_t *cell = NULL;
+    if (cache != NULL && cache->head != NULL) {
+        cell = cache->head;
+        cache->head = cell->nextFree;
+        cache->size -= 1;
+    } else {
+        cell = malloc(sizeof(*cell));
+    }
+    return cell;
+}
+
+static void celix_promise_freeCell(celix_promise_cell_t *cell) {
+    celix_promise_cell_cache_t *cache = celix_promise_cellCache();
+    if (cache != NULL && cache->size < CELIX_PROMISE_MAX_POOLED_CELLS) {
+        cell->nextFree = cache->head;
+        cache->head = cell;
+        cache->size += 1;
+    } else {
+        free(cell);
+    }
+}
+
+celix_promise_t* celix_promise_create(void (*destroyValue)(void *value)) {
+    celix_promise_cell_t *cell = celix_promise_allocCell();
+    if (cell == NULL) {
+        return NULL;
+    }
+    celix_promise_t *promise = &cell->promise;
+    promise->state = CELIX_PROMISE_PENDING;
+    promise->refCount = 1;
+    promise->status = CELIX_SUCCESS;
+    promise->value = NULL;
+    promise->destroyValue = destroyValue;
+    promise->continuations = NULL;
+    return promise;
+}
+
+void celix_promise_retain(celix_promise_t *promise) {
+    __atomic_add_fetch(&promise->refCount, 1, __ATOMIC_RELAXED);
+}
+
+void celix_promise_release(celix_promise_t *promise) {
+    if (promise != NULL && __atomic_sub_fetch(&promise->refCount, 1, __ATOMIC_ACQ_REL) == 0) {
+        if (promise->value != NULL && promise->destroyValue != NULL) {
+            promise->destroyValue(promise->value);
+        }
+        celix_promise_freeCell((celix_promise_cell_t *) promise);
+    }
+}
+
+static bool celix_promise_complete(celix_promise_t *promise, celix_status_t status, void *value);
+static void celix_promise_releaseTimer(celix_promise_timer_t *timer);
+
+static void* celix_promise_runContinuation(void *data) {
+    celix_promise_continuation_t *c = data;
+    celix_promise_t *source = c->source;
+
+    if (c->kind == CELIX_PROMISE_CONTINUATION_THEN) {
+        void *result = NULL;
+        celix_status_t status = c->then.fn(c->then.data, source->status, source->value, &result);
+        celix_promise_t *derived = c->then.derived;
+        if (!celix_promise_complete(derived, status, status == CELIX_SUCCESS ? result : NULL) &&
+                result != NULL && derived->destroyValue != NULL) {
+            derived->destroyValue(result); //derived already completed (e.g. timed out)
+        }
+        celix_promise_release(derived);
+    } else if (c->kind == CELIX_PROMISE_CONTINUATION_WAITER) {
+        celix_promise_waiter_t *waiter = c->waiter;
+        celixThreadMutex_lock(&waiter->mutex);
+        waiter->done = true;
+        celixThreadCondition_broadcast(&waiter->cond);
+        celixThreadMutex_unlock(&waiter->mutex);
+    } else {
+        //note cancel also returns true for a running callback, but then waits for it (or is called from it)
+        celix_promise_timer_t *timer = c->timeout.timer;
+        if (c->timeout.cancel(c->timeout.handle, c->timeout.eventId) && !__atomic_load_n(&timer->fired, __ATOMIC_ACQUIRE)) {
+            celix_promise_releaseTimer(timer); //the reference of the cancelled callback
+        }
+        celix_promise_releaseTimer(timer);
+    }
+
+    celix_promise_release(source);
+    celix_promise_freeCell((celix_promise_cell_t *) c);
+    return NULL;
+}
+
+static void celix_promise_dispatch(celix_promise_continuation_t *c) {
+    bool queued = c->kind == CELIX_PROMISE_CONTINUATION_THEN && c->then.executor != NULL &&
+                  celix_threadPool_execute(c->then.executor, celix_promise_runContinuation, c, NULL, NULL) == CELIX_SUCCESS;
+    if (!queued) {
+        celix_promise_runContinuation(c);
+    }
+}
+
+static bool celix_promise_complete(celix_promise_t *promise, celix_status_t status, void *value) {
+    int expected = CELIX_PROMISE_PENDING;
+    if (!__atomic_compare_exchange_n(&promise->state, &expected, CELIX_PROMISE_COMPLETING, false, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)) {
+        return false;
+    }
+    promise->status = status;
+    promise->value = value;
+    __atomic_store_n(&promise->state, CELIX_PROMISE_DONE, __ATOMIC_RELEASE);
+
+    //take over the continuations, continuations added from now on are dispatched directly
+    celix_promise_continuation_t *list = __atomic_exchange_n(&promise->continuations, &g_completed, __ATOMIC_ACQ_REL);
+
+    //the list is a stack, reverse it to dispatch in registration order
+    celix_promise_continuation_t *ordered = NULL;
+    while (list != NULL) {
+        celix_promise_continuation_t *next = list->next;
+        list->next = ordered;
+        ordered = list;
+        list = next;
+    }
+    while (ordered != NULL) {
+        celix_promise_continuation_t *next = ordered->next;
+        celix_promise_dispatch(ordered);
+        ordered = next;
+    }
+    return true;
+}
+
+static void celix_promise_addContinuation(celix_promise_t *promise, celix_promise_continuation_t *c) {
+    celix_promise_continuation_t *head = __atomic_load_n(&promise->continuations, __ATOMIC_ACQUIRE);
+    do {
+        if (head == &g_completed) {
+            celix_promise_dispatch(c);
+            return;
+        }
+        c->next = head;
+    } while (!__atomic_compare_exchange_n(&promise->continuations, &head, c, true, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE));
+}
+
+static celix_promise_continuation_t* celix_promise_createContinuation(celix_promise_t *source, celix_promise_continuation_kind_e kind) {
+    celix_promise_cell_t *cell = celix_promise_allocCell();
+    if (cell == NULL) {
+        return NULL;
+    }
+    celix_promise_continuation_t *c = &cell->continuation;
+    c->next = NULL;
+    c->kind = kind;
+    c->source = source;
+    celix_promise_retain(source);
+    return c;
+}
+
+bool celix_promise_resolve(celix_promise_t *promise, void *value) {
+    return celix_promise_complete(promise, CELIX_SUCCESS, value);
+}
+
+bool celix_promise_fail(celix_promise_t *promise, celix_status_t status) {
+    return celix_promise_complete(promise, status != CELIX_SUCCESS ? status : CELIX_ILLEGAL_STATE, NULL);
+}
+
+bool celix_promise_isDone(const celix_promise_t *promise) {
+    return __atomic_load_n(&promise->state, __ATOMIC_ACQUIRE) == CELIX_PROMISE_DONE;
+}
+
+celix_status_t celix_promise_get(celix_promise_t *promise, void **value) {
+    if (!celix_promise_isDone(promise)) {
+        celix_promise_waiter_t waiter;
+        waiter.done = false;
+        celixThreadMutex_create(&waiter.mutex, NULL);
+        celixThreadCondition_init(&waiter.cond, NULL);
+
+        celix_promise_continuation_t *c = celix_promise_createContinuation(promise, CELIX_PROMISE_CONTINUATION_WAITER);
+        if (c == NULL) {
+            celixThreadCondition_destroy(&waiter.cond);
+            celixThreadMutex_destroy(&waiter.mutex);
+            return CELIX_ENOMEM;
+        }
+        c->waiter = &waiter;
+        celix_promise_addContinuation(promise, c);
+
+        celixThreadMutex_lock(&waiter.mutex);
+        while (!waiter.done) {
+            celixThreadCondition_wait(&waiter.cond, &waiter.mutex);
+        }
+        celixThreadMutex_unlock(&waiter.mutex);
+        celixThreadCondition_destroy(&waiter.cond);
+        celixThreadMutex_destroy(&waiter.mutex);
+    }
+
+    if (value != NULL) {
+        *value = promise->value;
+    }
+    return promise->status;
+}
+
+celix_promise_t* celix_promise_then(celix_promise_t *promise, celix_thread_pool_t *executor,
+                                    celix_promise_then_fp continuation, void *data, void (*destroyResult)(void *value)) {
+    celix_promise_t *derived = celix_promise_create(destroyResult);
+    celix_promise_continuation_t *c = derived != NULL ? celix_promise_createContinuation(promise, CELIX_PROMISE_CONTINUATION_THEN) : NULL;
+    if (c == NULL) {
+        celix_promise_release(derived);
+        return NULL;
+    }
+    c->then.executor = executor;
+    c->then.fn = continuation;
+    c->then.data = data;
+    c->then.derived = derived;
+    celix_promise_retain(derived);
+    celix_promise_addContinuation(promise, c);
+    return derived;
+}
+
+static void celix_promise_releaseTimer(celix_promise_timer_t *timer) {
+    if (__atomic_sub_fetch(&timer->refCount, 1, __ATOMIC_ACQ_REL) == 0) {
+        celix_promise_release(timer->promise);
+        celix_promise_freeCell((celix_promise_cell_t *) timer);
+    }
+}
+
+static void celix_promise_timeoutCallback(void *data) {
+    celix_promise_timer_t *timer = data;
+    __atomic_store_n(&timer->fired, true, __ATOMIC_RELEASE);
+    celix_promise_fail(timer->promise, ETIMEDOUT);
+    celix_promise_releaseTimer(timer);
+}
+
+celix_status_t celix_promise_timeout(celix_promise_t *promise, double timeoutInSeconds, void *schedulerHandle,
+                                     celix_promise_schedule_once_fp scheduleOnce, celix_promise_cancel_fp cancel) {
+    celix_promise_cell_t *cell = celix_promise_allocCell();
+    celix_promise_continuation_t *c = cell != NULL ? celix_promise_createContinuation(promise, CELIX_PROMISE_CONTINUATION_TIMEOUT) : NULL;
+    if (c == NULL) {
+        if (cell != NULL) {
+            celix_promise_freeCell(cell);
+        }
+        return CELIX_ENOMEM;
+    }
+
+    celix_promise_timer_t *timer = &cell->timer;
+    timer->promise = promise;
+    timer->refCount = 2; //the callback and the continuation
+    timer->fired = false;
+    celix_promise_retain(promise);
+    long eventId = scheduleOnce(schedulerHandle, timeoutInSeconds, timer, celix_promise_timeoutCallback);
+    if (eventId < 0) {
+        celix_promise_release(promise); //of the timer
+        celix_promise_release(promise); //of the continuation
+        celix_promise_freeCell(cell);
+        celix_promise_freeCell((celix_promise_cell_t *) c);
+        return CELIX_ILLEGAL_STATE;
+    }
+
+    //cancels the timeout when the promise is completed before the timeout
+    c->timeout.handle = schedulerHandle;
+    c->timeout.cancel = cancel;
+    c->timeout.eventId = eventId;
+    c->timeout.timer = timer;
+    celix_promise_addContinuation(promise, c);
+    return CELIX_SUCCESS;
+}
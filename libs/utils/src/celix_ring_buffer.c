@@ -0,0 +1,255 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *  KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "celix_ring_buffer.h"
+#include "celix_threads.h"
+
+#define CELIX_RING_BUFFER_CACHE_LINE_SIZE 64
+#define CELIX_RING_BUFFER_CACHE_ALIGNED __attribute__((aligned(CELIX_RING_BUFFER_CACHE_LINE_SIZE)))
+
+/**
+ * Slot of a MPMC ring buffer (Vyukov bounded queue). The sequence nr tells whether the slot is ready for a push at
+ * position seq (seq == pos) or ready for a pop at position seq - 1 (seq == pos + 1).
+ */
+typedef struct celix_ring_buffer_slot {
+    size_t seq;
+    void *element;
+} celix_ring_buffer_slot_t;
+
+struct celix_ring_buffer {
+    //read mostly
+    celix_ring_buffer_mode_e mode;
+    size_t mask;
+    void **elements; //SPSC
+    celix_ring_buffer_slot_t *slots; //MPMC
+
+    //note producer and consumer positions on separate cache lines to prevent false sharing
+    size_t tail CELIX_RING_BUFFER_CACHE_ALIGNED; //atomic, next push position
+    size_t cachedHead; //SPSC, producer cached copy of head
+    size_t head CELIX_RING_BUFFER_CACHE_ALIGNED; //atomic, next pop position
+    size_t cachedTail; //SPSC, consumer cached copy of tail
+
+    size_t pushWaiters CELIX_RING_BUFFER_CACHE_ALIGNED; //atomic
+    size_t popWaiters; //atomic
+    bool closed; //atomic
+    celix_thread_mutex_t mutex; //used for the conditions
+    celix_thread_cond_t notFull;
+    celix_thread_cond_t notEmpty;
+};
+
+celix_ring_buffer_t* celix_ringBuffer_create(size_t capacity, celix_ring_buffer_mode_e mode) {
+    if (capacity == 0 || capacity > (SIZE_MAX / 2)) {
+        return NULL;
+    }
+    size_t size = 1;
+    while (size < capacity) {
+        size *= 2;
+    }
+
+    celix_ring_buffer_t *rb = NULL;
+    if (posix_memalign((void**)&rb, CELIX_RING_BUFFER_CACHE_LINE_SIZE, sizeof(*rb)) != 0) {
+        return NULL;
+    }
+    memset(rb, 0, sizeof(*rb));
+    rb->mode = mode;
+    rb->mask = size - 1;
+    if (mode == CELIX_RING_BUFFER_SPSC) {
+        rb->elements = calloc(size, sizeof(*rb->elements));
+    } else {
+        rb->slots = calloc(size, sizeof(*rb->slots));
+        for (size_t i = 0; rb->slots != NULL && i < size; ++i) {
+            rb->slots[i].seq = i;
+        }
+    }
+    if (rb->elements == NULL && rb->slots == NULL) {
+        free(rb);
+        return NULL;
+    }
+    celixThreadMutex_create(&rb->mutex, NULL);
+    celixThreadCondition_init(&rb->notFull, NULL);
+    celixThreadCondition_init(&rb->notEmpty, NULL);
+    return rb;
+}
+
+void celix_ringBuffer_destroy(celix_ring_buffer_t *rb) {
+    if (rb != NULL) {
+        celixThreadCondition_destroy(&rb->notEmpty);
+        celixThreadCondition_destroy(&rb->notFull);
+        celixThreadMutex_destroy(&rb->mutex);
+        free(rb->elements);
+        free(rb->slots);
+        free(rb);
+    }
+}
+
+size_t celix_ringBuffer_capacity(const celix_ring_buffer_t *rb) {
+    return rb->mask + 1;
+}
+
+size_t celix_ringBuffer_size(const celix_ring_buffer_t *rb) {
+    size_t head = __atomic_load_n(&rb->head, __ATOMIC_ACQUIRE);
+    size_t tail = __atomic_load_n(&rb->tail, __ATOMIC_ACQUIRE);
+    return tail >= head ? tail - head : 0;
+}
+
+static bool celix_ringBuffer_tryPushSpsc(celix_ring_buffer_t *rb, void *element) {
+    size_t tail = __atomic_load_n(&rb->tail, __ATOMIC_RELAXED);
+    if (tail - rb->cachedHead > rb->mask) {
+        rb->cachedHead = __atomic_load_n(&rb->head, __ATOMIC_ACQUIRE);
+        if (tail - rb->cachedHead > rb->mask) {
+            return false; //full
+        }
+    }
+    rb->elements[tail & rb->mask] = element;
+    __atomic_store_n(&rb->tail, tail + 1, __ATOMIC_RELEASE);
+    return true;
+}
+
+static bool celix_ringBuffer_tryPopSpsc(celix_ring_buffer_t *rb, void **elementOut) {
+    size_t head = __atomic_load_n(&rb->head, __ATOMIC_RELAXED);
+    if (head == rb->cachedTail) {
+        rb->cachedTail = __atomic_load_n(&rb->tail, __ATOMIC_ACQUIRE);
+        if (head == rb->cachedTail) {
+            return false; //empty
+        }
+    }
+    *elementOut = rb->elements[head & rb->mask];
+    __atomic_store_n(&rb->head, head + 1, __ATOMIC_RELEASE);
+    return true;
+}
+
+static bool celix_ringBuffer_tryPushMpmc(celix_ring_buffer_t *rb, void *element) {
+    size_t pos = __atomic_load_n(&rb->tail, __ATOMIC_RELAXED);
+    for (;;) {
+        celix_ring_buffer_slot_t *slot = &rb->slots[pos & rb->mask];
+        size_t seq = __atomic_load_n(&slot->seq, __ATOMIC_ACQUIRE);
+        intptr_t diff = (intptr_t)seq - (intptr_t)pos;
+        if (diff == 0) {
+            if (__atomic_compare_exchange_n(&rb->tail, &pos, pos + 1, true, __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+                slot->element = element;
+                __atomic_store_n(&slot->seq, pos + 1, __ATOMIC_RELEASE);
+                return true;
+            }
+            //note on failure pos is updated with the current tail
+        } else if (diff < 0) {
+            return false; //full
+        } else {
+            pos = __atomic_load_n(&rb->tail, __ATOMIC_RELAXED);
+        }
+    }
+}
+
+static bool celix_ringBuffer_tryPopMpmc(celix_ring_buffer_t *rb, void **elementOut) {
+    size_t pos = __atomic_load_n(&rb->head, __ATOMIC_RELAXED);
+    for (;;) {
+        celix_ring_buffer_slot_t *slot = &rb->slots[pos & rb->mask];
+        size_t seq = __atomic_load_n(&slot->seq, __ATOMIC_ACQUIRE);
+        intptr_t diff = (intptr_t)seq - (intptr_t)(pos + 1);
+        if (diff == 0) {
+            if (__atomic_compare_exchange_n(&rb->head, &pos, pos + 1, true, __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+                *elementOut = slot->element;
+                __atomic_store_n(&slot->seq, pos + rb->mask + 1, __ATOMIC_RELEASE);
+                return true;
+            }
+        } else if (diff < 0) {
+            return false; //empty
+        } else {
+            pos = __atomic_load_n(&rb->head, __ATOMIC_RELAXED);
+        }
+    }
+}
+
+static void celix_ringBuffer_signalWaiters(celix_ring_buffer_t *rb, size_t *waiters, celix_thread_cond_t *cond) {
+    //note full fence between the push/pop and reading the waiter count, see the wait loops
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+    if (__atomic_load_n(waiters, __ATOMIC_RELAXED) > 0) {
+        celixThreadMutex_lock(&rb->mutex);
+        celixThreadCondition_broadcast(cond);
+        celixThreadMutex_unlock(&rb->mutex);
+    }
+}
+
+bool celix_ringBuffer_tryPush(celix_ring_buffer_t *rb, void *element) {
+    if (__atomic_load_n(&rb->closed, __ATOMIC_ACQUIRE)) {
+        return false;
+    }
+    bool pushed = rb->mode == CELIX_RING_BUFFER_SPSC ? celix_ringBuffer_tryPushSpsc(rb, element) : celix_ringBuffer_tryPushMpmc(rb, element);
+    if (pushed) {
+        celix_ringBuffer_signalWaiters(rb, &rb->popWaiters, &rb->notEmpty);
+    }
+    return pushed;
+}
+
+bool celix_ringBuffer_tryPop(celix_ring_buffer_t *rb, void **elementOut) {
+    bool popped = rb->mode == CELIX_RING_BUFFER_SPSC ? celix_ringBuffer_tryPopSpsc(rb, elementOut) : celix_ringBuffer_tryPopMpmc(rb, elementOut);
+    if (popped) {
+        celix_ringBuffer_signalWaiters(rb, &rb->pushWaiters, &rb->notFull);
+    }
+    return popped;
+}
+
+celix_status_t celix_ringBuffer_push(celix_ring_buffer_t *rb, void *element) {
+    while (!celix_ringBuffer_tryPush(rb, element)) {
+        celixThreadMutex_lock(&rb->mutex);
+        __atomic_add_fetch(&rb->pushWaiters, 1, __ATOMIC_SEQ_CST);
+        __atomic_thread_fence(__ATOMIC_SEQ_CST);
+        //note recheck after registering as waiter, a pop in between will signal
+        while (!__atomic_load_n(&rb->closed, __ATOMIC_SEQ_CST) && celix_ringBuffer_size(rb) > rb->mask) {
+            celixThreadCondition_wait(&rb->notFull, &rb->mutex);
+        }
+        __atomic_sub_fetch(&rb->pushWaiters, 1, __ATOMIC_SEQ_CST);
+        bool closed = __atomic_load_n(&rb->closed, __ATOMIC_SEQ_CST);
+        celixThreadMutex_unlock(&rb->mutex);
+        if (closed) {
+            return CELIX_ILLEGAL_STATE;
+        }
+    }
+    return CELIX_SUCCESS;
+}
+
+celix_status_t celix_ringBuffer_pop(celix_ring_buffer_t *rb, void **elementOut) {
+    while (!celix_ringBuffer_tryPop(rb, elementOut)) {
+        celixThreadMutex_lock(&rb->mutex);
+        __atomic_add_fetch(&rb->popWaiters, 1, __ATOMIC_SEQ_CST);
+        __atomic_thread_fence(__ATOMIC_SEQ_CST);
+        //note recheck after registering as waiter, a push in between will signal
+        while (!__atomic_load_n(&rb->closed, __ATOMIC_SEQ_CST) && celix_ringBuffer_size(rb) == 0) {
+            celixThreadCondition_wait(&rb->notEmpty, &rb->mutex);
+        }
+        __atomic_sub_fetch(&rb->popWaiters, 1, __ATOMIC_SEQ_CST);
+        bool closedAndEmpty = __atomic_load_n(&rb->closed, __ATOMIC_SEQ_CST) && celix_ringBuffer_size(rb) == 0;
+        celixThreadMutex_unlock(&rb->mutex);
+        if (closedAndEmpty) {
+            return CELIX_ILLEGAL_STATE;
+        }
+    }
+    return CELIX_SUCCESS;
+}
+
+void celix_ringBuffer_close(celix_ring_buffer_t *rb) {
+    celixThreadMutex_lock(&rb->mutex);
+    __atomic_store_n(&rb->closed, true, __ATOMIC_SEQ_CST);
+    celixThreadCondition_broadcast(&rb->notFull);
+    celixThreadCondition_broadcast(&rb->notEmpty);
+    celixThreadMutex_unlock(&rb->mutex);
+}
@@ -0,0 +1,194 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *  KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <stddef.h>
+
+#include "celix_string_pool.h"
+#include "celix_threads.h"
+
+#define CELIX_STRING_POOL_NR_OF_SHARDS 16
+#define CELIX_STRING_POOL_INITIAL_CAPACITY 64
+
+typedef struct celix_string_pool_entry {
+    struct celix_string_pool_entry *next;
+    uint32_t hash;
+    long refCount; //atomic
+    char str[]; //the interned string
+} celix_string_pool_entry_t;
+
+typedef struct celix_string_pool_shard {
+    celix_thread_mutex_t mutex; //protects buckets, capacity and size
+    celix_string_pool_entry_t **buckets;
+    size_t capacity; //power of 2
+    size_t size;
+} __attribute__((aligned(64))) celix_string_pool_shard_t;
+
+static celix_thread_once_t celix_stringPool_onceControl = PTHREAD_ONCE_INIT;
+static celix_string_pool_shard_t celix_stringPool_shards[CELIX_STRING_POOL_NR_OF_SHARDS];
+
+static void celix_stringPool_init(void) {
+    for (int i = 0; i < CELIX_STRING_POOL_NR_OF_SHARDS; ++i) {
+        celixThreadMutex_create(&celix_stringPool_shards[i].mutex, NULL);
+    }
+}
+
+static uint32_t celix_stringPool_hash(const char *str) {
+    //FNV-1a
+    uint32_t hash = 2166136261u;
+    for (const unsigned char *c = (const unsigned char*)str; *c != '\0'; ++c) {
+        hash ^= *c;
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+static inline celix_string_pool_entry_t* celix_stringPool_entryFor(const char *pooled) {
+    return (celix_string_pool_entry_t*)(pooled - offsetof(celix_string_pool_entry_t, str));
+}
+
+static inline celix_string_pool_shard_t* celix_stringPool_shardFor(uint32_t hash) {
+    //note the high bits select the shard, the low bits the bucket
+    return &celix_stringPool_shards[hash >> 28];
+}
+
+static celix_string_pool_entry_t* celix_stringPool_find(celix_string_pool_shard_t *shard, uint32_t hash, const char *str) {
+    if (shard->capacity == 0) {
+        return NULL;
+    }
+    celix_string_pool_entry_t *entry = shard->buckets[hash & (shard->capacity - 1)];
+    while (entry != NULL && (entry->hash != hash || strcmp(entry->str, str) != 0)) {
+        entry = entry->next;
+    }
+    return entry;
+}
+
+static bool celix_stringPool_grow(celix_string_pool_shard_t *shard) {
+    size_t newCapacity = shard->capacity == 0 ? CELIX_STRING_POOL_INITIAL_CAPACITY : shard->capacity * 2;
+    celix_string_pool_entry_t **newBuckets = calloc(newCapacity, sizeof(*newBuckets));
+    if (newBuckets == NULL) {
+        return false;
+    }
+    for (size_t i = 0; i < shard->capacity; ++i) {
+        celix_string_pool_entry_t *entry = shard->buckets[i];
+        while (entry != NULL) {
+            celix_string_pool_entry_t *next = entry->next;
+            size_t index = entry->hash & (newCapacity - 1);
+            entry->next = newBuckets[index];
+            newBuckets[index] = entry;
+            entry = next;
+        }
+    }
+    free(shard->buckets);
+    shard->buckets = newBuckets;
+    shard->capacity = newCapacity;
+    return true;
+}
+
+const char* celix_stringPool_intern(const char *str) {
+    if (str == NULL) {
+        return NULL;
+    }
+    celixThread_once(&celix_stringPool_onceControl, celix_stringPool_init);
+
+    uint32_t hash = celix_stringPool_hash(str);
+    celix_string_pool_shard_t *shard = celix_stringPool_shardFor(hash);
+    celixThreadMutex_lock(&shard->mutex);
+    celix_string_pool_entry_t *entry = celix_stringPool_find(shard, hash, str);
+    if (entry != NULL) {
+        __atomic_add_fetch(&entry->refCount, 1, __ATOMIC_RELAXED);
+    } else if ((shard->size + 1) * 4 <= shard->capacity * 3 || celix_stringPool_grow(shard)) {
+        size_t len = strlen(str);
+        entry = malloc(sizeof(*entry) + len + 1);
+        if (entry != NULL) {
+            entry->hash = hash;
+            entry->refCount = 1;
+            memcpy(entry->str, str, len + 1);
+            size_t index = hash & (shard->capacity - 1);
+            entry->next = shard->buckets[index];
+            shard->buckets[index] = entry;
+            shard->size += 1;
+        }
+    }
+    celixThreadMutex_unlock(&shard->mutex);
+    return entry == NULL ? NULL : entry->str;
+}
+
+const char* celix_stringPool_retain(const char *pooled) {
+    if (pooled != NULL) {
+        //note the caller holds a reference, so the entry cannot be removed concurrently
+        __atomic_add_fetch(&celix_stringPool_entryFor(pooled)->refCount, 1, __ATOMIC_RELAXED);
+    }
+    return pooled;
+}
+
+void celix_stringPool_release(const char *pooled) {
+    if (pooled == NULL) {
+        return;
+    }
+    celix_string_pool_entry_t *entry = celix_stringPool_entryFor(pooled);
+    celix_string_pool_shard_t *shard = celix_stringPool_shardFor(entry->hash);
+
+    //note the refCount is only decreased to 0 with the shard lock taken, so a concurrent intern of the same string
+    //either sees the removed entry gone or revives it before it is removed
+    long refCount = __atomic_load_n(&entry->refCount, __ATOMIC_RELAXED);
+    while (refCount > 1) {
+        if (__atomic_compare_exchange_n(&entry->refCount, &refCount, refCount - 1, true, __ATOMIC_RELEASE, __ATOMIC_RELAXED)) {
+            return;
+        }
+    }
+
+    celixThreadMutex_lock(&shard->mutex);
+    if (__atomic_sub_fetch(&entry->refCount, 1, __ATOMIC_ACQ_REL) == 0) {
+        celix_string_pool_entry_t **link = &shard->buckets[entry->hash & (shard->capacity - 1)];
+        while (*link != entry) {
+            link = &(*link)->next;
+        }
+        *link = entry->next;
+        shard->size -= 1;
+        free(entry);
+    }
+    celixThreadMutex_unlock(&shard->mutex);
+}
+
+const char* celix_stringPool_lookup(const char *str) {
+    if (str == NULL) {
+        return NULL;
+    }
+    celixThread_once(&celix_stringPool_onceControl, celix_stringPool_init);
+    uint32_t hash = celix_stringPool_hash(str);
+    celix_string_pool_shard_t *shard = celix_stringPool_shardFor(hash);
+    celixThreadMutex_lock(&shard->mutex);
+    celix_string_pool_entry_t *entry = celix_stringPool_find(shard, hash, str);
+    celixThreadMutex_unlock(&shard->mutex);
+    return entry == NULL ? NULL : entry->str;
+}
+
+size_t celix_stringPool_size(void) {
+    celixThread_once(&celix_stringPool_onceControl, celix_stringPool_init);
+    size_t size = 0;
+    for (int i = 0; i < CELIX_STRING_POOL_NR_OF_SHARDS; ++i) {
+        celixThreadMutex_lock(&celix_stringPool_shards[i].mutex);
+        size += celix_stringPool_shards[i].size;
+        celixThreadMutex_unlock(&celix_stringPool_shards[i].mutex);
+    }
+    return size;
+}
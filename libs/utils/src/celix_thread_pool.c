@@ -0,0 +1,391 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *  KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <pthread.h>
+#if defined(__linux__)
+#include <sched.h>
+#endif
+
+#include "celix_thread_pool.h"
+#include "celix_threads.h"
+
+#define CELIX_THREAD_POOL_INITIAL_QUEUE_CAPACITY 16
+
+typedef struct celix_thread_pool_job {
+    celix_thread_pool_job_fp job;
+    void *data;
+    void *doneHandle;
+    celix_thread_pool_done_fp done;
+    celix_thread_pool_future_t *future;
+} celix_thread_pool_job_t;
+
+typedef struct celix_thread_pool_worker {
+    celix_thread_pool_t *pool;
+    size_t index;
+    celix_thread_t thread;
+
+    celix_thread_mutex_t mutex; //protects the job queue
+    celix_thread_pool_job_t *jobs; //circular buffer
+    size_t capacity;
+    size_t head; //oldest job
+    size_t size;
+} celix_thread_pool_worker_t;
+
+struct celix_thread_pool {
+    size_t nrOfWorkers;
+    size_t nrOfThreads; //nr of successfully started worker threads
+    celix_thread_pool_worker_t *workers;
+    size_t maxQueueSize;
+
+    size_t nextWorker; //atomic, round-robin index for submissions from non worker threads
+    size_t queued; //atomic, nr of jobs in the worker queues
+    size_t active; //atomic, nr of running jobs
+    size_t idleWorkers; //atomic, nr of workers waiting for work
+    size_t idleWaiters; //atomic, nr of threads in celix_threadPool_waitUntilIdle
+    bool stopping; //atomic
+
+    celix_thread_mutex_t mutex; //protects reserved and is used for the conditions below
+    celix_thread_cond_t workAvailable;
+    celix_thread_cond_t roomAvailable;
+    celix_thread_cond_t idle;
+    size_t reserved; //nr of queued jobs incl. the jobs being queued, only used for a bounded pool
+};
+
+struct celix_thread_pool_future {
+    celix_thread_pool_t *pool;
+    celix_thread_mutex_t mutex; //protects below
+    celix_thread_cond_t cond;
+    bool done;
+    void *result;
+};
+
+static __thread celix_thread_pool_worker_t *g_currentWorker = NULL; //set for worker threads
+
+static void celix_threadPoolWorker_push(celix_thread_pool_worker_t *worker, const celix_thread_pool_job_t *job) {
+    celixThreadMutex_lock(&worker->mutex);
+    if (worker->size == worker->capacity) {
+        size_t newCapacity = worker->capacity * 2;
+        celix_thread_pool_job_t *jobs = malloc(newCapacity * sizeof(*jobs));
+        for (size_t i = 0; i < worker->size; ++i) {
+            jobs[i] = worker->jobs[(worker->head + i) % worker->capacity];
+        }
+        free(worker->jobs);
+        worker->jobs = jobs;
+        worker->capacity = newCapacity;
+        worker->head = 0;
+    }
+    worker->jobs[(worker->head + worker->size) % worker->capacity] = *job;
+    worker->size += 1;
+    celixThreadMutex_unlock(&worker->mutex);
+}
+
+/**
+ * Takes the oldest job (own queue) or the newest job (steal) of the worker queue.
+ */
+static bool celix_threadPoolWorker_take(celix_thread_pool_worker_t *worker, bool steal, celix_thread_pool_job_t *out) {
+    bool taken = false;
+    celixThreadMutex_lock(&worker->mutex);
+    if (worker->size > 0) {
+        if (steal) {
+            *out = worker->jobs[(worker->head + worker->size - 1) % worker->capacity];
+        } else {
+            *out = worker->jobs[worker->head];
+            worker->head = (worker->head + 1) % worker->capacity;
+        }
+        worker->size -= 1;
+        taken = true;
+    }
+    celixThreadMutex_unlock(&worker->mutex);
+    return taken;
+}
+
+/**
+ * Takes a job from the own queue of the worker or steals one from the other workers.
+ * On success the job is accounted as active.
+ */
+static bool celix_threadPool_take(celix_thread_pool_t *pool, celix_thread_pool_worker_t *self, celix_thread_pool_job_t *out) {
+    if (__atomic_load_n(&pool->queued, __ATOMIC_SEQ_CST) == 0) {
+        return false;
+    }
+    bool taken = celix_threadPoolWorker_take(self, false, out);
+    for (size_t i = 1; !taken && i < pool->nrOfWorkers; ++i) {
+        taken = celix_threadPoolWorker_take(&pool->workers[(self->index + i) % pool->nrOfWorkers], true, out);
+    }
+    if (taken) {
+        __atomic_add_fetch(&pool->active, 1, __ATOMIC_SEQ_CST);
+        __atomic_sub_fetch(&pool->queued, 1, __ATOMIC_SEQ_CST);
+        if (pool->maxQueueSize > 0) {
+            celixThreadMutex_lock(&pool->mutex);
+            pool->reserved -= 1;
+            celixThreadCondition_signal(&pool->roomAvailable);
+            celixThreadMutex_unlock(&pool->mutex);
+        }
+    }
+    return taken;
+}
+
+static void celix_threadPool_run(celix_thread_pool_t *pool, celix_thread_pool_job_t *job) {
+    void *result = job->job(job->data);
+    if (job->done != NULL) {
+        job->done(job->doneHandle, result);
+    }
+    if (job->future != NULL) {
+        celixThreadMutex_lock(&job->future->mutex);
+        job->future->result = result;
+        job->future->done = true;
+        celixThreadCondition_broadcast(&job->future->cond);
+        celixThreadMutex_unlock(&job->future->mutex);
+    }
+    size_t active = __atomic_sub_fetch(&pool->active, 1, __ATOMIC_SEQ_CST);
+    if (active == 0 && __atomic_load_n(&pool->idleWaiters, __ATOMIC_SEQ_CST) > 0) {
+        celixThreadMutex_lock(&pool->mutex);
+        celixThreadCondition_broadcast(&pool->idle);
+        celixThreadMutex_unlock(&pool->mutex);
+    }
+}
+
+static void* celix_threadPool_workerThread(void *data) {
+    celix_thread_pool_worker_t *self = data;
+    celix_thread_pool_t *pool = self->pool;
+    g_currentWorker = self;
+    celix_thread_pool_job_t job;
+    for (;;) {
+        if (celix_threadPool_take(pool, self, &job)) {
+            celix_threadPool_run(pool, &job);
+            continue;
+        }
+        celixThreadMutex_lock(&pool->mutex);
+        bool stop = __atomic_load_n(&pool->stopping, __ATOMIC_SEQ_CST) && __atomic_load_n(&pool->queued, __ATOMIC_SEQ_CST) == 0;
+        if (!stop) {
+            //note idleWorkers is increased before checking queued, see celix_threadPool_queue
+            __atomic_add_fetch(&pool->idleWorkers, 1, __ATOMIC_SEQ_CST);
+            while (!__atomic_load_n(&pool->stopping, __ATOMIC_SEQ_CST) && __atomic_load_n(&pool->queued, __ATOMIC_SEQ_CST) == 0) {
+                celixThreadCondition_wait(&pool->workAvailable, &pool->mutex);
+            }
+            __atomic_sub_fetch(&pool->idleWorkers, 1, __ATOMIC_SEQ_CST);
+        }
+        celixThreadMutex_unlock(&pool->mutex);
+        if (stop) {
+            break;
+        }
+    }
+    g_currentWorker = NULL;
+    return NULL;
+}
+
+static celix_status_t celix_threadPool_queue(celix_thread_pool_t *pool, const celix_thread_pool_job_t *job, bool blocking) {
+    if (__atomic_load_n(&pool->stopping, __ATOMIC_SEQ_CST)) {
+        return CELIX_ILLEGAL_STATE;
+    }
+    bool fromWorker = g_currentWorker != NULL && g_currentWorker->pool == pool;
+
+    if (pool->maxQueueSize > 0) {
+        celixThreadMutex_lock(&pool->mutex);
+        //note a worker never blocks on a full queue, that could deadlock the pool
+        while (!fromWorker && pool->reserved >= pool->maxQueueSize && !__atomic_load_n(&pool->stopping, __ATOMIC_SEQ_CST)) {
+            if (!blocking) {
+                celixThreadMutex_unlock(&pool->mutex);
+                return CELIX_ENOMEM;
+            }
+            celixThreadCondition_wait(&pool->roomAvailable, &pool->mutex);
+        }
+        if (__atomic_load_n(&pool->stopping, __ATOMIC_SEQ_CST)) {
+            celixThreadMutex_unlock(&pool->mutex);
+            return CELIX_ILLEGAL_STATE;
+        }
+        pool->reserved += 1;
+        celixThreadMutex_unlock(&pool->mutex);
+    }
+
+    celix_thread_pool_worker_t *worker = fromWorker ? g_currentWorker :
+            &pool->workers[__atomic_fetch_add(&pool->nextWorker, 1, __ATOMIC_RELAXED) % pool->nrOfWorkers];
+    celix_threadPoolWorker_push(worker, job);
+    __atomic_add_fetch(&pool->queued, 1, __ATOMIC_SEQ_CST);
+
+    //only lock and signal if there are idle workers, a worker checks queued after increasing idleWorkers
+    if (__atomic_load_n(&pool->idleWorkers, __ATOMIC_SEQ_CST) > 0) {
+        celixThreadMutex_lock(&pool->mutex);
+        celixThreadCondition_signal(&pool->workAvailable);
+        celixThreadMutex_unlock(&pool->mutex);
+    }
+    return CELIX_SUCCESS;
+}
+
+celix_thread_pool_t* celix_threadPool_create(const celix_thread_pool_options_t *opts) {
+    celix_thread_pool_options_t defaultOpts = CELIX_EMPTY_THREAD_POOL_OPTIONS;
+    if (opts == NULL) {
+        opts = &defaultOpts;
+    }
+    long nrOfCpus = sysconf(_SC_NPROCESSORS_ONLN);
+    if (nrOfCpus <= 0) {
+        nrOfCpus = 1;
+    }
+
+    celix_thread_pool_t *pool = calloc(1, sizeof(*pool));
+    pool->nrOfWorkers = opts->nrOfThreads > 0 ? opts->nrOfThreads : (size_t)nrOfCpus;
+    pool->maxQueueSize = opts->maxQueueSize;
+    celixThreadMutex_create(&pool->mutex, NULL);
+    celixThreadCondition_init(&pool->workAvailable, NULL);
+    celixThreadCondition_init(&pool->roomAvailable, NULL);
+    celixThreadCondition_init(&pool->idle, NULL);
+
+    //note all workers are initialized before starting threads, because workers steal from each other
+    pool->workers = calloc(pool->nrOfWorkers, sizeof(*pool->workers));
+    for (size_t i = 0; i < pool->nrOfWorkers; ++i) {
+        celix_thread_pool_worker_t *worker = &pool->workers[i];
+        worker->pool = pool;
+        worker->index = i;
+        worker->capacity = CELIX_THREAD_POOL_INITIAL_QUEUE_CAPACITY;
+        worker->jobs = malloc(worker->capacity * sizeof(*worker->jobs));
+        celixThreadMutex_create(&worker->mutex, NULL);
+    }
+
+    for (size_t i = 0; i < pool->nrOfWorkers; ++i) {
+        celix_thread_pool_worker_t *worker = &pool->workers[i];
+        if (celixThread_create(&worker->thread, NULL, celix_threadPool_workerThread, worker) != CELIX_SUCCESS) {
+            break; //note jobs queued for workers without a thread are stolen by the other workers
+        }
+        pool->nrOfThreads += 1;
+
+        char name[16];
+        snprintf(name, sizeof(name), "%.10s-%u", opts->name == NULL ? "pool" : opts->name, (unsigned)(i % 1000));
+        celixThread_setName(&worker->thread, name);
+#if defined(__linux__)
+        if (opts->pinThreads) {
+            cpu_set_t cpus;
+            CPU_ZERO(&cpus);
+            CPU_SET((int)(i % (size_t)nrOfCpus), &cpus);
+            pthread_setaffinity_np(worker->thread.thread, sizeof(cpus), &cpus);
+        }
+#endif
+    }
+
+    if (pool->nrOfThreads == 0) {
+        celix_threadPool_destroy(pool);
+        pool = NULL;
+    }
+    return pool;
+}
+
+void celix_threadPool_destroy(celix_thread_pool_t *pool) {
+    if (pool == NULL) {
+        return;
+    }
+    celixThreadMutex_lock(&pool->mutex);
+    __atomic_store_n(&pool->stopping, true, __ATOMIC_SEQ_CST);
+    celixThreadCondition_broadcast(&pool->workAvailable);
+    celixThreadCondition_broadcast(&pool->roomAvailable);
+    celixThreadMutex_unlock(&pool->mutex);
+
+    for (size_t i = 0; i < pool->nrOfThreads; ++i) {
+        celixThread_join(pool->workers[i].thread, NULL);
+    }
+    for (size_t i = 0; i < pool->nrOfWorkers; ++i) {
+        celixThreadMutex_destroy(&pool->workers[i].mutex);
+        free(pool->workers[i].jobs);
+    }
+    free(pool->workers);
+    celixThreadCondition_destroy(&pool->idle);
+    celixThreadCondition_destroy(&pool->roomAvailable);
+    celixThreadCondition_destroy(&pool->workAvailable);
+    celixThreadMutex_destroy(&pool->mutex);
+    free(pool);
+}
+
+size_t celix_threadPool_nrOfThreads(const celix_thread_pool_t *pool) {
+    return pool->nrOfThreads;
+}
+
+celix_status_t celix_threadPool_execute(celix_thread_pool_t *pool, celix_thread_pool_job_fp job, void *data, void *doneHandle, celix_thread_pool_done_fp done) {
+    celix_thread_pool_job_t entry = {.job = job, .data = data, .doneHandle = doneHandle, .done = done, .future = NULL};
+    return celix_threadPool_queue(pool, &entry, true);
+}
+
+celix_status_t celix_threadPool_tryExecute(celix_thread_pool_t *pool, celix_thread_pool_job_fp job, void *data, void *doneHandle, celix_thread_pool_done_fp done) {
+    celix_thread_pool_job_t entry = {.job = job, .data = data, .doneHandle = doneHandle, .done = done, .future = NULL};
+    return celix_threadPool_queue(pool, &entry, false);
+}
+
+celix_thread_pool_future_t* celix_threadPool_submit(celix_thread_pool_t *pool, celix_thread_pool_job_fp job, void *data) {
+    celix_thread_pool_future_t *future = calloc(1, sizeof(*future));
+    future->pool = pool;
+    celixThreadMutex_create(&future->mutex, NULL);
+    celixThreadCondition_init(&future->cond, NULL);
+    celix_thread_pool_job_t entry = {.job = job, .data = data, .doneHandle = NULL, .done = NULL, .future = future};
+    if (celix_threadPool_queue(pool, &entry, true) != CELIX_SUCCESS) {
+        celixThreadCondition_destroy(&future->cond);
+        celixThreadMutex_destroy(&future->mutex);
+        free(future);
+        future = NULL;
+    }
+    return future;
+}
+
+void celix_threadPool_waitUntilIdle(celix_thread_pool_t *pool) {
+    celixThreadMutex_lock(&pool->mutex);
+    __atomic_add_fetch(&pool->idleWaiters, 1, __ATOMIC_SEQ_CST);
+    while (__atomic_load_n(&pool->queued, __ATOMIC_SEQ_CST) > 0 || __atomic_load_n(&pool->active, __ATOMIC_SEQ_CST) > 0) {
+        //note timed, because the last queued job can be taken and finished without an idle broadcast in between
+        celixThreadCondition_timedwaitRelative(&pool->idle, &pool->mutex, 0, 10 * 1000 * 1000);
+    }
+    __atomic_sub_fetch(&pool->idleWaiters, 1, __ATOMIC_SEQ_CST);
+    celixThreadMutex_unlock(&pool->mutex);
+}
+
+bool celix_threadPoolFuture_isDone(celix_thread_pool_future_t *future) {
+    celixThreadMutex_lock(&future->mutex);
+    bool done = future->done;
+    celixThreadMutex_unlock(&future->mutex);
+    return done;
+}
+
+void* celix_threadPoolFuture_get(celix_thread_pool_future_t *future) {
+    celix_thread_pool_worker_t *worker = g_currentWorker != NULL && g_currentWorker->pool == future->pool ? g_currentWorker : NULL;
+    if (worker != NULL) {
+        //called from a worker thread, help executing jobs to prevent a deadlock when all workers are waiting
+        celix_thread_pool_job_t job;
+        while (!celix_threadPoolFuture_isDone(future)) {
+            if (celix_threadPool_take(future->pool, worker, &job)) {
+                celix_threadPool_run(future->pool, &job);
+            } else {
+                celixThreadMutex_lock(&future->mutex);
+                if (!future->done) {
+                    celixThreadCondition_timedwaitRelative(&future->cond, &future->mutex, 0, 1000 * 1000);
+                }
+                celixThreadMutex_unlock(&future->mutex);
+            }
+        }
+    } else {
+        celixThreadMutex_lock(&future->mutex);
+        while (!future->done) {
+            celixThreadCondition_wait(&future->cond, &future->mutex);
+        }
+        celixThreadMutex_unlock(&future->mutex);
+    }
+
+    void *result = future->result;
+    celixThreadCondition_destroy(&future->cond);
+    celixThreadMutex_destroy(&future->mutex);
+    free(future);
+    return result;
+}
@@ -27,26 +27,337 @@
 #include <stdlib.h>
 #include <sys/time.h>
 #include <time.h>
+#include <string.h>
+#include <sched.h>
+#include <stdio.h>
+#include <errno.h>
+#include <stdint.h>
+#include <unistd.h>
+#ifdef __linux__
+#include <sys/syscall.h>
+#endif
 #include "signal.h"
 #include "celix_threads.h"
 
+#define CELIX_THREAD_MAX_NAME_LENGTH 15 //excluding the '\0', the limit of pthread_setname_np
+#define CELIX_THREAD_MAX_CONFIG_VALUE_LENGTH 256
+
+static pthread_mutex_t g_threadConfigMutex = PTHREAD_MUTEX_INITIALIZER;
+static celix_thread_config_lookup_fp g_threadConfigLookup = NULL; //protected by g_threadConfigMutex
+static void *g_threadConfigHandle = NULL; //protected by g_threadConfigMutex
+
+
+typedef struct celix_thread_entry {
+    pthread_t thread;
+    long ownerId;
+    long tid; //atomic, set by the thread itself
+    unsigned long long *allocatedBytes; //atomic, points to the thread local counter of the thread
+    struct celix_thread_entry *next;
+    struct celix_thread_entry *prev;
+} celix_thread_entry_t;
+
+typedef struct celix_thread_start_data {
+    celix_thread_start_t func;
+    void *data;
+    celix_thread_entry_t *entry;
+} celix_thread_start_data_t;
+
+static pthread_mutex_t g_threadEntriesMutex = PTHREAD_MUTEX_INITIALIZER;
+static celix_thread_entry_t *g_threadEntries = NULL; //protected by g_threadEntriesMutex
+static __thread long g_threadCreationOwner = -1;
+static __thread unsigned long long g_threadAllocatedBytes __attribute__((tls_model("initial-exec"))) = 0; //atomic
+
+#if defined(CELIX_THREAD_ALLOC_ACCOUNTING) && defined(__GLIBC__)
+extern void* __libc_malloc(size_t size);
+extern void* __libc_calloc(size_t nmemb, size_t size);
+extern void* __libc_realloc(void *ptr, size_t size);
+
+//note interposes the glibc malloc, calloc and realloc for the complete process. Only the allocated bytes are
+//counted (no frees), so the counter does not need the size of a freed block.
+static inline void celixThread_countAllocation(size_t size) {
+    __atomic_store_n(&g_threadAllocatedBytes, g_threadAllocatedBytes + size, __ATOMIC_RELAXED);
+}
+
+void* malloc(size_t size) {
+    void *ptr = __libc_malloc(size);
+    if (ptr != NULL) {
+        celixThread_countAllocation(size);
+    }
+    return ptr;
+}
+
+void* calloc(size_t nmemb, size_t size) {
+    void *ptr = __libc_calloc(nmemb, size);
+    if (ptr != NULL) {
+        celixThread_countAllocation(nmemb * size);
+    }
+    return ptr;
+}
+
+void* realloc(void *ptr, size_t size) {
+    void *result = __libc_realloc(ptr, size);
+    if (result != NULL) {
+        celixThread_countAllocation(size);
+    }
+    return result;
+}
+
+bool celixThread_isAllocationAccountingEnabled(void) {
+    return true;
+}
+#else
+bool celixThread_isAllocationAccountingEnabled(void) {
+    return false;
+}
+#endif
+
+static void celixThread_unregister(void *data) {
+    celix_thread_entry_t *entry = data;
+    pthread_mutex_lock(&g_threadEntriesMutex);
+    if (entry->prev != NULL) {
+        entry->prev->next = entry->next;
+    } else {
+        g_threadEntries = entry->next;
+    }
+    if (entry->next != NULL) {
+        entry->next->prev = entry->prev;
+    }
+    pthread_mutex_unlock(&g_threadEntriesMutex);
+    free(entry);
+}
+
+static void* celixThread_run(void *data) {
+    celix_thread_start_data_t startData = *(celix_thread_start_data_t*)data;
+    free(data);
+
+    celix_thread_entry_t *entry = startData.entry;
+    g_threadCreationOwner = entry->ownerId;
+#ifdef __linux__
+    __atomic_store_n(&entry->tid, (long)syscall(SYS_gettid), __ATOMIC_RELAXED);
+#endif
+    __atomic_store_n(&entry->allocatedBytes, &g_threadAllocatedBytes, __ATOMIC_RELEASE);
+
+    void *result = NULL;
+    //note the cleanup handler also unregisters the thread if it exits with celixThread_exit
+    pthread_cleanup_push(celixThread_unregister, entry);
+    result = startData.func(startData.data);
+    pthread_cleanup_pop(1);
+    return result;
+}
 
 celix_status_t celixThread_create(celix_thread_t *new_thread, celix_thread_attr_t *attr, celix_thread_start_t func, void *data) {
     celix_status_t status = CELIX_SUCCESS;
 
-    if (pthread_create(&(*new_thread).thread, attr, func, data) != 0) {
+    //note the thread is registered before it is started, so that it is always part of the thread infos
+    celix_thread_entry_t *entry = calloc(1, sizeof(*entry));
+    celix_thread_start_data_t *startData = calloc(1, sizeof(*startData));
+    if (entry == NULL || startData == NULL) {
+        free(entry);
+        free(startData);
+        return CELIX_ENOMEM;
+    }
+    entry->ownerId = g_threadCreationOwner;
+    entry->tid = -1;
+    startData->func = func;
+    startData->data = data;
+    startData->entry = entry;
+
+    pthread_mutex_lock(&g_threadEntriesMutex);
+    if (pthread_create(&(*new_thread).thread, attr, celixThread_run, startData) != 0) {
         status = CELIX_BUNDLE_EXCEPTION;
     }
     else {
         (*new_thread).threadInitialized = true;
+        entry->thread = new_thread->thread;
+        entry->next = g_threadEntries;
+        if (g_threadEntries != NULL) {
+            g_threadEntries->prev = entry;
+        }
+        g_threadEntries = entry;
     }
+    pthread_mutex_unlock(&g_threadEntriesMutex);
 
+    if (status != CELIX_SUCCESS) {
+        free(entry);
+        free(startData);
+    }
     return status;
 }
 
+long celixThread_setCreationOwner(long ownerId) {
+    long prev = g_threadCreationOwner;
+    g_threadCreationOwner = ownerId;
+    return prev;
+}
+
+#ifdef __linux__
+static void celixThread_readContextSwitches(celix_thread_info_t *info) {
+    char path[64];
+    snprintf(path, sizeof(path), "/proc/self/task/%li/status", info->tid);
+    FILE *file = fopen(path, "r");
+    if (file != NULL) {
+        char line[128];
+        while (fgets(line, sizeof(line), file) != NULL) {
+            if (strncmp(line, "voluntary_ctxt_switches:", 24) == 0) {
+                info->nrOfVoluntaryContextSwitches = strtoul(line + 24, NULL, 10);
+            } else if (strncmp(line, "nonvoluntary_ctxt_switches:", 27) == 0) {
+                info->nrOfInvoluntaryContextSwitches = strtoul(line + 27, NULL, 10);
+            }
+        }
+        fclose(file);
+    }
+}
+#endif
+
+celix_array_list_t* celixThread_getThreadInfos(void) {
+    celix_array_list_t *infos = celix_arrayList_create();
+    //note the entries mutex is kept while reading, a thread unregisters (with the same mutex) before it exits
+    pthread_mutex_lock(&g_threadEntriesMutex);
+    for (celix_thread_entry_t *entry = g_threadEntries; entry != NULL; entry = entry->next) {
+        celix_thread_info_t *info = calloc(1, sizeof(*info));
+        info->ownerId = entry->ownerId;
+        info->tid = __atomic_load_n(&entry->tid, __ATOMIC_RELAXED);
+        unsigned long long *allocatedBytes = __atomic_load_n(&entry->allocatedBytes, __ATOMIC_ACQUIRE);
+        info->allocatedBytes = allocatedBytes != NULL ? __atomic_load_n(allocatedBytes, __ATOMIC_RELAXED) : 0;
+#if defined(_GNU_SOURCE) && defined(__linux__)
+        pthread_getname_np(entry->thread, info->name, sizeof(info->name));
+        clockid_t clockId;
+        struct timespec ts;
+        if (pthread_getcpuclockid(entry->thread, &clockId) == 0 && clock_gettime(clockId, &ts) == 0) {
+            info->cpuTimeInNs = (unsigned long long)ts.tv_sec * 1000000000ULL + (unsigned long long)ts.tv_nsec;
+        }
+#endif
+#ifdef __linux__
+        if (info->tid >= 0) {
+            celixThread_readContextSwitches(info);
+        }
+#endif
+        celix_arrayList_add(infos, info);
+    }
+    pthread_mutex_unlock(&g_threadEntriesMutex);
+    return infos;
+}
+
+void celixThread_destroyThreadInfos(celix_array_list_t *infos) {
+    if (infos != NULL) {
+        for (int i = 0; i < celix_arrayList_size(infos); ++i) {
+            free(celix_arrayList_get(infos, i));
+        }
+        celix_arrayList_destroy(infos);
+    }
+}
+
+void celixThread_setConfigLookup(celix_thread_config_lookup_fp lookup, void *handle) {
+    pthread_mutex_lock(&g_threadConfigMutex);
+    g_threadConfigLookup = lookup;
+    g_threadConfigHandle = handle;
+    pthread_mutex_unlock(&g_threadConfigMutex);
+}
+
 #if defined(_GNU_SOURCE) && defined(__linux__)
+/**
+ * Looks up CELIX_THREAD.<name>.<attribute> for the name, the name without a "-<nr>" suffix and '*'.
+ * The value is copied to out, returns false if not configured.
+ */
+static bool celixThread_lookupConfig(const char *threadName, const char *attribute, char *out, size_t outSize) {
+    char name[64];
+    snprintf(name, sizeof(name), "%s", threadName);
+    for (char *c = name; *c != '\0'; ++c) {
+        if (*c == ' ') {
+            *c = '_';
+        }
+    }
+    char *dash = strrchr(name, '-');
+    size_t baseLength = dash != NULL && dash != name && dash[1] != '\0' && strspn(dash + 1, "0123456789") == strlen(dash + 1) ?
+                        (size_t)(dash - name) : strlen(name);
+
+    const char *value = NULL;
+    char key[128];
+    pthread_mutex_lock(&g_threadConfigMutex);
+    if (g_threadConfigLookup != NULL) {
+        snprintf(key, sizeof(key), CELIX_THREAD_CONFIG_PREFIX "%s.%s", name, attribute);
+        value = g_threadConfigLookup(g_threadConfigHandle, key);
+        if (value == NULL && baseLength < strlen(name)) {
+            snprintf(key, sizeof(key), CELIX_THREAD_CONFIG_PREFIX "%.*s.%s", (int)baseLength, name, attribute);
+            value = g_threadConfigLookup(g_threadConfigHandle, key);
+        }
+        if (value == NULL) {
+            snprintf(key, sizeof(key), CELIX_THREAD_CONFIG_PREFIX "*.%s", attribute);
+            value = g_threadConfigLookup(g_threadConfigHandle, key);
+        }
+        if (value != NULL) {
+            snprintf(out, outSize, "%s", value);
+        }
+    }
+    pthread_mutex_unlock(&g_threadConfigMutex);
+    return value != NULL;
+}
+
+/**
+ * Parses a cpu list, e.g. "0,2-3". Returns false if invalid.
+ */
+static bool celixThread_parseCpuList(const char *list, cpu_set_t *cpus) {
+    CPU_ZERO(cpus);
+    const char *c = list;
+    while (*c != '\0') {
+        char *end = NULL;
+        long first = strtol(c, &end, 10);
+        long last = first;
+        if (end == c) {
+            return false;
+        }
+        if (*end == '-') {
+            c = end + 1;
+            last = strtol(c, &end, 10);
+            if (end == c) {
+                return false;
+            }
+        }
+        if (first < 0 || last < first || last >= CPU_SETSIZE) {
+            return false;
+        }
+        for (long cpu = first; cpu <= last; ++cpu) {
+            CPU_SET((int)cpu, cpus);
+        }
+        c = end;
+        while (*c == ',' || *c == ' ') {
+            ++c;
+        }
+    }
+    return CPU_COUNT(cpus) > 0;
+}
+
+static void celixThread_applyConfig(celix_thread_t *thread, const char *threadName) {
+    char value[CELIX_THREAD_MAX_CONFIG_VALUE_LENGTH];
+    if (celixThread_lookupConfig(threadName, "AFFINITY", value, sizeof(value))) {
+        cpu_set_t cpus;
+        if (!celixThread_parseCpuList(value, &cpus)) {
+            fprintf(stderr, "Thread Error: Invalid affinity '%s' for thread '%s'.\n", value, threadName);
+        } else if (pthread_setaffinity_np(thread->thread, sizeof(cpus), &cpus) != 0) {
+            fprintf(stderr, "Thread Error: Cannot set affinity '%s' for thread '%s'.\n", value, threadName);
+        }
+    }
+    if (celixThread_lookupConfig(threadName, "PRIORITY", value, sizeof(value))) {
+        char *end = NULL;
+        long priority = strtol(value, &end, 10);
+        struct sched_param param;
+        memset(&param, 0, sizeof(param));
+        param.sched_priority = (int)priority;
+        int rc = EINVAL;
+        if (end != value && priority >= 0 && priority <= 99) {
+            rc = pthread_setschedparam(thread->thread, priority > 0 ? SCHED_FIFO : SCHED_OTHER, &param);
+        }
+        if (rc != 0) {
+            fprintf(stderr, "Thread Error: Cannot set priority '%s' for thread '%s': %s.\n", value, threadName, strerror(rc));
+        }
+    }
+}
+
 void celixThread_setName(celix_thread_t *thread, const char *threadName) {
-    pthread_setname_np(thread->thread, threadName);
+    char name[CELIX_THREAD_MAX_NAME_LENGTH + 1];
+    snprintf(name, sizeof(name), "%s", threadName);
+    pthread_setname_np(thread->thread, name);
+    celixThread_applyConfig(thread, threadName);
 }
 #else
 void celixThread_setName(celix_thread_t *thread __attribute__((unused)), const char *threadName  __attribute__((unused))) {
@@ -98,19 +409,357 @@ bool celixThread_initialized(celix_thread_t thread) {
 }
 
 
-celix_status_t celixThreadMutex_create(celix_thread_mutex_t *mutex, celix_thread_mutexattr_t *attr) {
+#ifdef CELIX_LOCK_PROFILING
+#define CELIX_THREAD_LOCK_PROFILER_MAX_SITES 512
+#define CELIX_THREAD_LOCK_PROFILER_TABLE_SIZE 8192 //power of 2
+#define CELIX_THREAD_LOCK_PROFILER_MAX_HELD_LOCKS 16
+#define CELIX_THREAD_LOCK_PROFILER_REMOVED_KEY ((void*)1)
+
+typedef struct celix_thread_lock_site {
+    char name[CELIX_THREAD_LOCK_PROFILE_MAX_SITE_LENGTH];
+    bool rwlock;
+    //note the counters are updated with relaxed atomics
+    unsigned long nrOfLocks;
+    unsigned long nrOfContendedLocks;
+    unsigned long long totalWaitTimeInNs;
+    unsigned long long maxWaitTimeInNs;
+    unsigned long long totalHoldTimeInNs;
+    unsigned long long maxHoldTimeInNs;
+    unsigned long waitHistogram[CELIX_THREAD_LOCK_PROFILE_NR_OF_BUCKETS];
+    unsigned long holdHistogram[CELIX_THREAD_LOCK_PROFILE_NR_OF_BUCKETS];
+} celix_thread_lock_site_t;
+
+typedef struct celix_thread_lock_entry {
+    void *lock; //atomic, NULL if never used, CELIX_THREAD_LOCK_PROFILER_REMOVED_KEY if removed
+    int site; //written before the lock is published
+} celix_thread_lock_entry_t;
+
+typedef struct celix_thread_held_lock {
+    void *lock;
+    int site;
+    unsigned long long lockedAt;
+} celix_thread_held_lock_t;
+
+static pthread_mutex_t g_lockProfilerMutex = PTHREAD_MUTEX_INITIALIZER; //serializes adding sites and (un)registering locks
+static celix_thread_lock_site_t g_lockSites[CELIX_THREAD_LOCK_PROFILER_MAX_SITES];
+static int g_nrOfLockSites = 0; //atomic
+static celix_thread_lock_entry_t g_lockTable[CELIX_THREAD_LOCK_PROFILER_TABLE_SIZE]; //open addressing, lock free lookup
+static __thread celix_thread_held_lock_t g_heldLocks[CELIX_THREAD_LOCK_PROFILER_MAX_HELD_LOCKS];
+static __thread int g_nrOfHeldLocks = 0;
+
+static unsigned long long celixThreadLockProfiler_now(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (unsigned long long)ts.tv_sec * 1000000000ULL + (unsigned long long)ts.tv_nsec;
+}
+
+static size_t celixThreadLockProfiler_hash(const void *lock) {
+    uintptr_t h = (uintptr_t)lock;
+    h ^= h >> 17;
+    h *= 0x9E3779B97F4A7C15ULL;
+    return (size_t)(h >> 16) & (CELIX_THREAD_LOCK_PROFILER_TABLE_SIZE - 1);
+}
+
+static int celixThreadLockProfiler_bucket(unsigned long long ns) {
+    unsigned long long us = ns / 1000;
+    if (us == 0) {
+        return 0;
+    }
+    int bucket = 64 - __builtin_clzll(us);
+    return bucket < CELIX_THREAD_LOCK_PROFILE_NR_OF_BUCKETS ? bucket : CELIX_THREAD_LOCK_PROFILE_NR_OF_BUCKETS - 1;
+}
+
+static void celixThreadLockProfiler_max(unsigned long long *max, unsigned long long value) {
+    unsigned long long current = __atomic_load_n(max, __ATOMIC_RELAXED);
+    while (value > current && !__atomic_compare_exchange_n(max, &current, value, true, __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+        //retry, current is updated
+    }
+}
+
+/**
+ * Registers the lock for the site. If the site table or lock table is full, the lock is not profiled.
+ */
+static void celixThreadLockProfiler_register(void *lock, const char *name, bool rwlock) {
+    pthread_mutex_lock(&g_lockProfilerMutex);
+    int nrOfSites = __atomic_load_n(&g_nrOfLockSites, __ATOMIC_RELAXED);
+    int site = -1;
+    for (int i = 0; i < nrOfSites; ++i) {
+        if (g_lockSites[i].rwlock == rwlock && strncmp(g_lockSites[i].name, name, sizeof(g_lockSites[i].name) - 1) == 0) {
+            site = i;
+            break;
+        }
+    }
+    if (site < 0 && nrOfSites < CELIX_THREAD_LOCK_PROFILER_MAX_SITES) {
+        site = nrOfSites;
+        snprintf(g_lockSites[site].name, sizeof(g_lockSites[site].name), "%s", name);
+        g_lockSites[site].rwlock = rwlock;
+        __atomic_store_n(&g_nrOfLockSites, nrOfSites + 1, __ATOMIC_RELEASE);
+    }
+
+    //note a lock can be registered again if the memory is reused without a destroy, so look for the lock first
+    size_t start = celixThreadLockProfiler_hash(lock);
+    celix_thread_lock_entry_t *freeEntry = NULL;
+    celix_thread_lock_entry_t *entry = NULL;
+    for (size_t i = 0; i < CELIX_THREAD_LOCK_PROFILER_TABLE_SIZE; ++i) {
+        celix_thread_lock_entry_t *e = &g_lockTable[(start + i) & (CELIX_THREAD_LOCK_PROFILER_TABLE_SIZE - 1)];
+        void *key = __atomic_load_n(&e->lock, __ATOMIC_RELAXED);
+        if (key == lock) {
+            entry = e;
+            break;
+        } else if (key == CELIX_THREAD_LOCK_PROFILER_REMOVED_KEY && freeEntry == NULL) {
+            freeEntry = e;
+        } else if (key == NULL) {
+            if (freeEntry == NULL) {
+                freeEntry = e;
+            }
+            break;
+        }
+    }
+    if (entry != NULL) {
+        __atomic_store_n(&entry->site, site, __ATOMIC_RELAXED);
+    } else if (freeEntry != NULL && site >= 0) {
+        freeEntry->site = site;
+        __atomic_store_n(&freeEntry->lock, lock, __ATOMIC_RELEASE);
+    }
+    pthread_mutex_unlock(&g_lockProfilerMutex);
+}
+
+static celix_thread_lock_entry_t* celixThreadLockProfiler_find(const void *lock) {
+    size_t start = celixThreadLockProfiler_hash(lock);
+    for (size_t i = 0; i < CELIX_THREAD_LOCK_PROFILER_TABLE_SIZE; ++i) {
+        celix_thread_lock_entry_t *e = &g_lockTable[(start + i) & (CELIX_THREAD_LOCK_PROFILER_TABLE_SIZE - 1)];
+        void *key = __atomic_load_n(&e->lock, __ATOMIC_ACQUIRE);
+        if (key == lock) {
+            return e;
+        } else if (key == NULL) {
+            break;
+        }
+    }
+    return NULL;
+}
+
+static void celixThreadLockProfiler_unregister(void *lock) {
+    pthread_mutex_lock(&g_lockProfilerMutex);
+    celix_thread_lock_entry_t *entry = celixThreadLockProfiler_find(lock);
+    if (entry != NULL) {
+        __atomic_store_n(&entry->lock, CELIX_THREAD_LOCK_PROFILER_REMOVED_KEY, __ATOMIC_RELEASE);
+        //note removed entries followed by an unused entry end every probe sequence, so they can be marked unused.
+        //This keeps the probe sequences (also for not profiled locks) short.
+        size_t index = (size_t)(entry - g_lockTable);
+        while (__atomic_load_n(&g_lockTable[(index + 1) & (CELIX_THREAD_LOCK_PROFILER_TABLE_SIZE - 1)].lock, __ATOMIC_RELAXED) == NULL &&
+               __atomic_load_n(&g_lockTable[index].lock, __ATOMIC_RELAXED) == CELIX_THREAD_LOCK_PROFILER_REMOVED_KEY) {
+            __atomic_store_n(&g_lockTable[index].lock, NULL, __ATOMIC_RELEASE);
+            index = (index - 1) & (CELIX_THREAD_LOCK_PROFILER_TABLE_SIZE - 1);
+        }
+    }
+    pthread_mutex_unlock(&g_lockProfilerMutex);
+}
+
+/**
+ * Returns the site of the lock or -1 if the lock is not profiled.
+ */
+static int celixThreadLockProfiler_siteOf(const void *lock) {
+    celix_thread_lock_entry_t *entry = celixThreadLockProfiler_find(lock);
+    return entry != NULL ? __atomic_load_n(&entry->site, __ATOMIC_RELAXED) : -1;
+}
+
+static void celixThreadLockProfiler_acquired(void *lock, int site, bool countAcquisition, bool contended, unsigned long long waitTime) {
+    celix_thread_lock_site_t *s = &g_lockSites[site];
+    if (countAcquisition) {
+        __atomic_add_fetch(&s->nrOfLocks, 1, __ATOMIC_RELAXED);
+        __atomic_add_fetch(&s->waitHistogram[celixThreadLockProfiler_bucket(waitTime)], 1, __ATOMIC_RELAXED);
+        if (contended) {
+            __atomic_add_fetch(&s->nrOfContendedLocks, 1, __ATOMIC_RELAXED);
+            __atomic_add_fetch(&s->totalWaitTimeInNs, waitTime, __ATOMIC_RELAXED);
+            celixThreadLockProfiler_max(&s->maxWaitTimeInNs, waitTime);
+        }
+    }
+    if (g_nrOfHeldLocks < CELIX_THREAD_LOCK_PROFILER_MAX_HELD_LOCKS) {
+        celix_thread_held_lock_t *held = &g_heldLocks[g_nrOfHeldLocks++];
+        held->lock = lock;
+        held->site = site;
+        held->lockedAt = celixThreadLockProfiler_now();
+    }
+}
+
+static void celixThreadLockProfiler_released(void *lock) {
+    for (int i = g_nrOfHeldLocks - 1; i >= 0; --i) {
+        if (g_heldLocks[i].lock == lock) {
+            unsigned long long holdTime = celixThreadLockProfiler_now() - g_heldLocks[i].lockedAt;
+            celix_thread_lock_site_t *s = &g_lockSites[g_heldLocks[i].site];
+            __atomic_add_fetch(&s->totalHoldTimeInNs, holdTime, __ATOMIC_RELAXED);
+            __atomic_add_fetch(&s->holdHistogram[celixThreadLockProfiler_bucket(holdTime)], 1, __ATOMIC_RELAXED);
+            celixThreadLockProfiler_max(&s->maxHoldTimeInNs, holdTime);
+            for (int k = i + 1; k < g_nrOfHeldLocks; ++k) {
+                g_heldLocks[k - 1] = g_heldLocks[k];
+            }
+            g_nrOfHeldLocks -= 1;
+            break;
+        }
+    }
+}
+
+/**
+ * Acquires a lock using a try lock first, so that the wait time is only measured for contended locks.
+ */
+static celix_status_t celixThreadLockProfiler_lock(void *lock, int (*tryLock)(void*), int (*doLock)(void*)) {
+    int site = celixThreadLockProfiler_siteOf(lock);
+    if (site < 0) {
+        return doLock(lock);
+    }
+    unsigned long long waitTime = 0;
+    celix_status_t status = tryLock(lock);
+    bool contended = status == EBUSY;
+    if (contended) {
+        unsigned long long start = celixThreadLockProfiler_now();
+        status = doLock(lock);
+        waitTime = celixThreadLockProfiler_now() - start;
+    }
+    if (status == CELIX_SUCCESS) {
+        celixThreadLockProfiler_acquired(lock, site, true, contended, waitTime);
+    }
+    return status;
+}
+
+static int celixThreadLockProfiler_mutexTryLock(void *lock) { return pthread_mutex_trylock(lock); }
+static int celixThreadLockProfiler_mutexLock(void *lock) { return pthread_mutex_lock(lock); }
+static int celixThreadLockProfiler_rwlockTryReadLock(void *lock) { return pthread_rwlock_tryrdlock(lock); }
+static int celixThreadLockProfiler_rwlockReadLock(void *lock) { return pthread_rwlock_rdlock(lock); }
+static int celixThreadLockProfiler_rwlockTryWriteLock(void *lock) { return pthread_rwlock_trywrlock(lock); }
+static int celixThreadLockProfiler_rwlockWriteLock(void *lock) { return pthread_rwlock_wrlock(lock); }
+
+bool celixThreadLockProfiler_isEnabled(void) {
+    return true;
+}
+
+static int celixThreadLockProfiler_compareProfiles(const void *a, const void *b) {
+    const celix_thread_lock_profile_t *pa = *(const celix_thread_lock_profile_t**)a;
+    const celix_thread_lock_profile_t *pb = *(const celix_thread_lock_profile_t**)b;
+    if (pa->totalWaitTimeInNs != pb->totalWaitTimeInNs) {
+        return pa->totalWaitTimeInNs < pb->totalWaitTimeInNs ? 1 : -1;
+    }
+    return pa->nrOfContendedLocks < pb->nrOfContendedLocks ? 1 : (pa->nrOfContendedLocks > pb->nrOfContendedLocks ? -1 : 0);
+}
+
+celix_array_list_t* celixThreadLockProfiler_getProfiles(void) {
+    int nrOfSites = __atomic_load_n(&g_nrOfLockSites, __ATOMIC_ACQUIRE);
+    celix_thread_lock_profile_t **sorted = calloc(nrOfSites > 0 ? (size_t)nrOfSites : 1, sizeof(*sorted));
+    int size = 0;
+    for (int i = 0; i < nrOfSites; ++i) {
+        celix_thread_lock_site_t *s = &g_lockSites[i];
+        if (__atomic_load_n(&s->nrOfLocks, __ATOMIC_RELAXED) == 0) {
+            continue;
+        }
+        celix_thread_lock_profile_t *profile = calloc(1, sizeof(*profile));
+        snprintf(profile->site, sizeof(profile->site), "%s", s->name);
+        profile->rwlock = s->rwlock;
+        profile->nrOfLocks = __atomic_load_n(&s->nrOfLocks, __ATOMIC_RELAXED);
+        profile->nrOfContendedLocks = __atomic_load_n(&s->nrOfContendedLocks, __ATOMIC_RELAXED);
+        profile->totalWaitTimeInNs = __atomic_load_n(&s->totalWaitTimeInNs, __ATOMIC_RELAXED);
+        profile->maxWaitTimeInNs = __atomic_load_n(&s->maxWaitTimeInNs, __ATOMIC_RELAXED);
+        profile->totalHoldTimeInNs = __atomic_load_n(&s->totalHoldTimeInNs, __ATOMIC_RELAXED);
+        profile->maxHoldTimeInNs = __atomic_load_n(&s->maxHoldTimeInNs, __ATOMIC_RELAXED);
+        for (int b = 0; b < CELIX_THREAD_LOCK_PROFILE_NR_OF_BUCKETS; ++b) {
+            profile->waitHistogram[b] = __atomic_load_n(&s->waitHistogram[b], __ATOMIC_RELAXED);
+            profile->holdHistogram[b] = __atomic_load_n(&s->holdHistogram[b], __ATOMIC_RELAXED);
+        }
+        sorted[size++] = profile;
+    }
+    qsort(sorted, (size_t)size, sizeof(sorted[0]), celixThreadLockProfiler_compareProfiles);
+    celix_array_list_t *profiles = celix_arrayList_create();
+    for (int i = 0; i < size; ++i) {
+        celix_arrayList_add(profiles, sorted[i]);
+    }
+    free(sorted);
+    return profiles;
+}
+
+void celixThreadLockProfiler_reset(void) {
+    int nrOfSites = __atomic_load_n(&g_nrOfLockSites, __ATOMIC_ACQUIRE);
+    for (int i = 0; i < nrOfSites; ++i) {
+        celix_thread_lock_site_t *s = &g_lockSites[i];
+        __atomic_store_n(&s->nrOfLocks, 0, __ATOMIC_RELAXED);
+        __atomic_store_n(&s->nrOfContendedLocks, 0, __ATOMIC_RELAXED);
+        __atomic_store_n(&s->totalWaitTimeInNs, 0, __ATOMIC_RELAXED);
+        __atomic_store_n(&s->maxWaitTimeInNs, 0, __ATOMIC_RELAXED);
+        __atomic_store_n(&s->totalHoldTimeInNs, 0, __ATOMIC_RELAXED);
+        __atomic_store_n(&s->maxHoldTimeInNs, 0, __ATOMIC_RELAXED);
+        for (int b = 0; b < CELIX_THREAD_LOCK_PROFILE_NR_OF_BUCKETS; ++b) {
+            __atomic_store_n(&s->waitHistogram[b], 0, __ATOMIC_RELAXED);
+            __atomic_store_n(&s->holdHistogram[b], 0, __ATOMIC_RELAXED);
+        }
+    }
+}
+#else
+bool celixThreadLockProfiler_isEnabled(void) {
+    return false;
+}
+
+celix_array_list_t* celixThreadLockProfiler_getProfiles(void) {
+    return celix_arrayList_create();
+}
+
+void celixThreadLockProfiler_reset(void) {
+    //nop
+}
+#endif
+
+void celixThreadLockProfiler_destroyProfiles(celix_array_list_t *profiles) {
+    if (profiles != NULL) {
+        for (int i = 0; i < celix_arrayList_size(profiles); ++i) {
+            free(celix_arrayList_get(profiles, i));
+        }
+        celix_arrayList_destroy(profiles);
+    }
+}
+
+//note the create functions are in parentheses, because they can be defined as macro (see CELIX_LOCK_PROFILING)
+celix_status_t (celixThreadMutex_create)(celix_thread_mutex_t *mutex, celix_thread_mutexattr_t *attr) {
     return pthread_mutex_init(mutex, attr);
 }
 
+celix_status_t celixThreadMutex_createNamed(celix_thread_mutex_t *mutex, celix_thread_mutexattr_t *attr, const char *name) {
+    celix_status_t status = pthread_mutex_init(mutex, attr);
+#ifdef CELIX_LOCK_PROFILING
+    if (status == CELIX_SUCCESS && name != NULL) {
+        celixThreadLockProfiler_register(mutex, name, false);
+    }
+#else
+    (void)name;
+#endif
+    return status;
+}
+
 celix_status_t celixThreadMutex_destroy(celix_thread_mutex_t *mutex) {
+#ifdef CELIX_LOCK_PROFILING
+    celixThreadLockProfiler_unregister(mutex);
+#endif
     return pthread_mutex_destroy(mutex);
 }
 
 celix_status_t celixThreadMutex_lock(celix_thread_mutex_t *mutex) {
+#ifdef CELIX_LOCK_PROFILING
+    return celixThreadLockProfiler_lock(mutex, celixThreadLockProfiler_mutexTryLock, celixThreadLockProfiler_mutexLock);
+#else
     return pthread_mutex_lock(mutex);
+#endif
+}
+
+celix_status_t celixThreadMutex_tryLock(celix_thread_mutex_t *mutex) {
+    celix_status_t status = pthread_mutex_trylock(mutex);
+#ifdef CELIX_LOCK_PROFILING
+    int site = status == CELIX_SUCCESS ? celixThreadLockProfiler_siteOf(mutex) : -1;
+    if (site >= 0) {
+        celixThreadLockProfiler_acquired(mutex, site, true, false, 0);
+    }
+#endif
+    return status;
 }
 
 celix_status_t celixThreadMutex_unlock(celix_thread_mutex_t *mutex) {
+#ifdef CELIX_LOCK_PROFILING
+    celixThreadLockProfiler_released(mutex);
+#endif
     return pthread_mutex_unlock(mutex);
 }
 
@@ -152,8 +801,29 @@ celix_status_t celixThreadCondition_destroy(celix_thread_cond_t *condition) {
     return pthread_cond_destroy(condition);
 }
 
+#ifdef CELIX_LOCK_PROFILING
+/**
+ * The mutex is released during a condition wait, so stop the hold time measurement during the wait.
+ */
+static celix_status_t celixThreadCondition_profiledWait(celix_thread_cond_t *cond, celix_thread_mutex_t *mutex, const struct timespec *abstime) {
+    int site = celixThreadLockProfiler_siteOf(mutex);
+    if (site >= 0) {
+        celixThreadLockProfiler_released(mutex);
+    }
+    celix_status_t status = abstime == NULL ? pthread_cond_wait(cond, mutex) : pthread_cond_timedwait(cond, mutex, abstime);
+    if (site >= 0) {
+        celixThreadLockProfiler_acquired(mutex, site, false, false, 0);
+    }
+    return status;
+}
+#endif
+
 celix_status_t celixThreadCondition_wait(celix_thread_cond_t *cond, celix_thread_mutex_t *mutex) {
+#ifdef CELIX_LOCK_PROFILING
+    return celixThreadCondition_profiledWait(cond, mutex, NULL);
+#else
     return pthread_cond_wait(cond, mutex);
+#endif
 }
 
 #ifdef __APPLE__
@@ -164,7 +834,15 @@ celix_status_t celixThreadCondition_timedwaitRelative(celix_thread_cond_t *cond,
     TIMEVAL_TO_TIMESPEC(&tv, &time)
     time.tv_sec += seconds;
     time.tv_nsec += nanoseconds;
+    while (time.tv_nsec >= 1000000000L) {
+        time.tv_sec += 1;
+        time.tv_nsec -= 1000000000L;
+    }
+#ifdef CELIX_LOCK_PROFILING
+    return celixThreadCondition_profiledWait(cond, mutex, &time);
+#else
     return pthread_cond_timedwait(cond, mutex, &time);
+#endif
 }
 #else
 celix_status_t celixThreadCondition_timedwaitRelative(celix_thread_cond_t *cond, celix_thread_mutex_t *mutex, long seconds, long nanoseconds) {
@@ -172,7 +850,15 @@ celix_status_t celixThreadCondition_timedwaitRelative(celix_thread_cond_t *cond,
     clock_gettime(CLOCK_REALTIME, &time);
     time.tv_sec += seconds;
     time.tv_nsec += nanoseconds;
+    while (time.tv_nsec >= 1000000000L) {
+        time.tv_sec += 1;
+        time.tv_nsec -= 1000000000L;
+    }
+#ifdef CELIX_LOCK_PROFILING
+    return celixThreadCondition_profiledWait(cond, mutex, &time);
+#else
     return pthread_cond_timedwait(cond, mutex, &time);
+#endif
 }
 #endif
 
@@ -184,23 +870,49 @@ celix_status_t celixThreadCondition_signal(celix_thread_cond_t *cond) {
     return pthread_cond_signal(cond);
 }
 
-celix_status_t celixThreadRwlock_create(celix_thread_rwlock_t *lock, celix_thread_rwlockattr_t *attr) {
+celix_status_t (celixThreadRwlock_create)(celix_thread_rwlock_t *lock, celix_thread_rwlockattr_t *attr) {
     return pthread_rwlock_init(lock, attr);
 }
 
+celix_status_t celixThreadRwlock_createNamed(celix_thread_rwlock_t *lock, celix_thread_rwlockattr_t *attr, const char *name) {
+    celix_status_t status = pthread_rwlock_init(lock, attr);
+#ifdef CELIX_LOCK_PROFILING
+    if (status == CELIX_SUCCESS && name != NULL) {
+        celixThreadLockProfiler_register(lock, name, true);
+    }
+#else
+    (void)name;
+#endif
+    return status;
+}
+
 celix_status_t celixThreadRwlock_destroy(celix_thread_rwlock_t *lock) {
+#ifdef CELIX_LOCK_PROFILING
+    celixThreadLockProfiler_unregister(lock);
+#endif
     return pthread_rwlock_destroy(lock);
 }
 
 celix_status_t celixThreadRwlock_readLock(celix_thread_rwlock_t *lock) {
+#ifdef CELIX_LOCK_PROFILING
+    return celixThreadLockProfiler_lock(lock, celixThreadLockProfiler_rwlockTryReadLock, celixThreadLockProfiler_rwlockReadLock);
+#else
     return pthread_rwlock_rdlock(lock);
+#endif
 }
 
 celix_status_t celixThreadRwlock_writeLock(celix_thread_rwlock_t *lock) {
+#ifdef CELIX_LOCK_PROFILING
+    return celixThreadLockProfiler_lock(lock, celixThreadLockProfiler_rwlockTryWriteLock, celixThreadLockProfiler_rwlockWriteLock);
+#else
     return pthread_rwlock_wrlock(lock);
+#endif
 }
 
 celix_status_t celixThreadRwlock_unlock(celix_thread_rwlock_t *lock) {
+#ifdef CELIX_LOCK_PROFILING
+    celixThreadLockProfiler_released(lock);
+#endif
     return pthread_rwlock_unlock(lock);
 }
 
@@ -212,6 +924,225 @@ celix_status_t celixThreadRwlockAttr_destroy(celix_thread_rwlockattr_t *attr) {
     return pthread_rwlockattr_destroy(attr);
 }
 
+static __thread int g_rwlockShardIndex = -1;
+static unsigned int g_rwlockNextShardIndex = 0;
+
+static celix_thread_sharded_rwlock_shard_t* celixThreadShardedRwlock_shard(celix_thread_sharded_rwlock_t *lock) {
+    if (g_rwlockShardIndex < 0) {
+        //note threads are assigned to shards round-robin, the index is the same for all sharded rwlocks
+        unsigned int index = __atomic_fetch_add(&g_rwlockNextShardIndex, 1, __ATOMIC_RELAXED);
+        g_rwlockShardIndex = (int)(index % CELIX_THREAD_SHARDED_RWLOCK_NR_OF_SHARDS);
+    }
+    return &lock->shards[g_rwlockShardIndex];
+}
+
+static inline void celixThread_cpuRelax(void) {
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_ia32_pause();
+#elif defined(__aarch64__)
+    __asm__ __volatile__("yield");
+#endif
+}
+
+celix_status_t celixThreadShardedRwlock_create(celix_thread_sharded_rwlock_t *lock, bool enableStats) {
+    memset(lock, 0, sizeof(*lock));
+    lock->statsEnabled = enableStats;
+    celix_status_t status = pthread_mutex_init(&lock->mutex, NULL);
+    if (status == CELIX_SUCCESS) {
+        status = pthread_cond_init(&lock->cond, NULL);
+    }
+    return status;
+}
+
+celix_status_t celixThreadShardedRwlock_destroy(celix_thread_sharded_rwlock_t *lock) {
+    pthread_cond_destroy(&lock->cond);
+    return pthread_mutex_destroy(&lock->mutex);
+}
+
+celix_status_t celixThreadShardedRwlock_readLock(celix_thread_sharded_rwlock_t *lock) {
+    celix_thread_sharded_rwlock_shard_t *shard = celixThreadShardedRwlock_shard(lock);
+    bool contended = false;
+    for (;;) {
+        //note seq_cst, the reader count must be visible before the writer flag is read (and vice versa for writers)
+        __atomic_add_fetch(&shard->readers, 1, __ATOMIC_SEQ_CST);
+        if (!__atomic_load_n(&lock->writer, __ATOMIC_SEQ_CST)) {
+            break;
+        }
+        __atomic_sub_fetch(&shard->readers, 1, __ATOMIC_SEQ_CST);
+        contended = true;
+        pthread_mutex_lock(&lock->mutex);
+        while (__atomic_load_n(&lock->writer, __ATOMIC_SEQ_CST)) {
+            pthread_cond_wait(&lock->cond, &lock->mutex);
+        }
+        pthread_mutex_unlock(&lock->mutex);
+    }
+    if (lock->statsEnabled) {
+        __atomic_add_fetch(&shard->nrOfReadLocks, 1, __ATOMIC_RELAXED);
+        if (contended) {
+            __atomic_add_fetch(&shard->nrOfContendedLocks, 1, __ATOMIC_RELAXED);
+        }
+    }
+    return CELIX_SUCCESS;
+}
+
+celix_status_t celixThreadShardedRwlock_readUnlock(celix_thread_sharded_rwlock_t *lock) {
+    celix_thread_sharded_rwlock_shard_t *shard = celixThreadShardedRwlock_shard(lock);
+    __atomic_sub_fetch(&shard->readers, 1, __ATOMIC_RELEASE);
+    return CELIX_SUCCESS;
+}
+
+celix_status_t celixThreadShardedRwlock_writeLock(celix_thread_sharded_rwlock_t *lock) {
+    //note the mutex is kept during the write section, this serializes the writers and blocks the waiting readers
+    pthread_mutex_lock(&lock->mutex);
+    __atomic_store_n(&lock->writer, true, __ATOMIC_SEQ_CST);
+    bool contended = false;
+    for (int i = 0; i < CELIX_THREAD_SHARDED_RWLOCK_NR_OF_SHARDS; ++i) {
+        while (__atomic_load_n(&lock->shards[i].readers, __ATOMIC_SEQ_CST) > 0) {
+            //read sections are expected to be short, so yield instead of parking
+            contended = true;
+            sched_yield();
+        }
+    }
+    if (lock->statsEnabled) {
+        lock->nrOfWriteLocks += 1;
+        lock->nrOfContendedWriteLocks += contended ? 1 : 0;
+    }
+    return CELIX_SUCCESS;
+}
+
+celix_status_t celixThreadShardedRwlock_writeUnlock(celix_thread_sharded_rwlock_t *lock) {
+    __atomic_store_n(&lock->writer, false, __ATOMIC_SEQ_CST);
+    pthread_cond_broadcast(&lock->cond);
+    pthread_mutex_unlock(&lock->mutex);
+    return CELIX_SUCCESS;
+}
+
+void celixThreadShardedRwlock_getStats(celix_thread_sharded_rwlock_t *lock, celix_thread_lock_stats_t *stats) {
+    memset(stats, 0, sizeof(*stats));
+    for (int i = 0; i < CELIX_THREAD_SHARDED_RWLOCK_NR_OF_SHARDS; ++i) {
+        stats->nrOfReadLocks += __atomic_load_n(&lock->shards[i].nrOfReadLocks, __ATOMIC_RELAXED);
+        stats->nrOfContendedLocks += __atomic_load_n(&lock->shards[i].nrOfContendedLocks, __ATOMIC_RELAXED);
+    }
+    pthread_mutex_lock(&lock->mutex);
+    stats->nrOfWriteLocks = lock->nrOfWriteLocks;
+    stats->nrOfContendedLocks += lock->nrOfContendedWriteLocks;
+    pthread_mutex_unlock(&lock->mutex);
+}
+
+celix_status_t celixThreadSpinMutex_create(celix_thread_spin_mutex_t *mutex, int maxSpins, bool enableStats) {
+    memset(mutex, 0, sizeof(*mutex));
+    mutex->maxSpins = maxSpins > 0 ? maxSpins : 100;
+    mutex->spins = mutex->maxSpins / 10;
+    mutex->statsEnabled = enableStats;
+    return pthread_mutex_init(&mutex->mutex, NULL);
+}
+
+celix_status_t celixThreadSpinMutex_destroy(celix_thread_spin_mutex_t *mutex) {
+    return pthread_mutex_destroy(&mutex->mutex);
+}
+
+celix_status_t celixThreadSpinMutex_lock(celix_thread_spin_mutex_t *mutex) {
+    celix_status_t status = pthread_mutex_trylock(&mutex->mutex);
+    if (status == CELIX_SUCCESS) {
+        if (mutex->statsEnabled) {
+            mutex->nrOfLocks += 1;
+        }
+        return status;
+    }
+
+    //contended, spin up to twice the current estimate before parking (same heuristic as glibc adaptive mutexes)
+    int estimate = __atomic_load_n(&mutex->spins, __ATOMIC_RELAXED);
+    int limit = estimate * 2 + 10;
+    if (limit > mutex->maxSpins) {
+        limit = mutex->maxSpins;
+    }
+    int count = 0;
+    while (count < limit) {
+        ++count;
+        celixThread_cpuRelax();
+        status = pthread_mutex_trylock(&mutex->mutex);
+        if (status == CELIX_SUCCESS) {
+            break;
+        }
+    }
+    if (status != CELIX_SUCCESS) {
+        status = pthread_mutex_lock(&mutex->mutex);
+    }
+    if (status == CELIX_SUCCESS) {
+        __atomic_store_n(&mutex->spins, estimate + (count - estimate) / 8, __ATOMIC_RELAXED);
+        if (mutex->statsEnabled) {
+            mutex->nrOfLocks += 1;
+            mutex->nrOfContendedLocks += 1;
+        }
+    }
+    return status;
+}
+
+celix_status_t celixThreadSpinMutex_unlock(celix_thread_spin_mutex_t *mutex) {
+    return pthread_mutex_unlock(&mutex->mutex);
+}
+
+void celixThreadSpinMutex_getStats(celix_thread_spin_mutex_t *mutex, celix_thread_lock_stats_t *stats) {
+    memset(stats, 0, sizeof(*stats));
+    stats->nrOfWriteLocks = mutex->nrOfLocks;
+    stats->nrOfContendedLocks = mutex->nrOfContendedLocks;
+}
+
+celix_status_t celixThreadSeqlock_create(celix_thread_seqlock_t *lock, bool enableStats) {
+    memset(lock, 0, sizeof(*lock));
+    lock->statsEnabled = enableStats;
+    return pthread_mutex_init(&lock->mutex, NULL);
+}
+
+celix_status_t celixThreadSeqlock_destroy(celix_thread_seqlock_t *lock) {
+    return pthread_mutex_destroy(&lock->mutex);
+}
+
+unsigned int celixThreadSeqlock_readBegin(celix_thread_seqlock_t *lock) {
+    unsigned int seq = __atomic_load_n(&lock->seq, __ATOMIC_ACQUIRE);
+    while ((seq & 1U) != 0) {
+        celixThread_cpuRelax();
+        seq = __atomic_load_n(&lock->seq, __ATOMIC_ACQUIRE);
+    }
+    return seq;
+}
+
+bool celixThreadSeqlock_readRetry(celix_thread_seqlock_t *lock, unsigned int seq) {
+    //note the fence orders the reads of the read section before the reread of the sequence nr
+    __atomic_thread_fence(__ATOMIC_ACQUIRE);
+    bool retry = __atomic_load_n(&lock->seq, __ATOMIC_RELAXED) != seq;
+    if (retry && lock->statsEnabled) {
+        __atomic_add_fetch(&lock->nrOfReadRetries, 1, __ATOMIC_RELAXED);
+    }
+    return retry;
+}
+
+celix_status_t celixThreadSeqlock_writeLock(celix_thread_seqlock_t *lock) {
+    celix_status_t status = pthread_mutex_lock(&lock->mutex);
+    if (status == CELIX_SUCCESS) {
+        __atomic_store_n(&lock->seq, lock->seq + 1, __ATOMIC_RELAXED);
+        //note the fence orders the odd sequence nr before the writes of the write section
+        __atomic_thread_fence(__ATOMIC_RELEASE);
+        if (lock->statsEnabled) {
+            lock->nrOfWriteLocks += 1;
+        }
+    }
+    return status;
+}
+
+celix_status_t celixThreadSeqlock_writeUnlock(celix_thread_seqlock_t *lock) {
+    __atomic_store_n(&lock->seq, lock->seq + 1, __ATOMIC_RELEASE);
+    return pthread_mutex_unlock(&lock->mutex);
+}
+
+void celixThreadSeqlock_getStats(celix_thread_seqlock_t *lock, celix_thread_lock_stats_t *stats) {
+    memset(stats, 0, sizeof(*stats));
+    pthread_mutex_lock(&lock->mutex);
+    stats->nrOfWriteLocks = lock->nrOfWriteLocks;
+    pthread_mutex_unlock(&lock->mutex);
+    stats->nrOfReadRetries = __atomic_load_n(&lock->nrOfReadRetries, __ATOMIC_RELAXED);
+}
+
 celix_status_t celixThread_once(celix_thread_once_t *once_control, void (*init_routine)(void)) {
     return pthread_once(once_control, init_routine);
 }
@@ -22,11 +22,54 @@
 #include <stdlib.h>
 #include <ctype.h>
 #include <assert.h>
+#include <errno.h>
 #include <utils.h>
 
 #include "celix_filter.h"
 #include "filter.h"
 #include "celix_errno.h"
+#include "hash_map_private.h"
+
+/**
+ * A compiled filter is a flat array of instructions in pre-order (a instruction is directly followed by the
+ * instructions of its children). With the span of the instruction, children can be skipped, which keeps
+ * short-circuiting of AND and OR possible.
+ */
+typedef enum celix_filter_value_type {
+    CELIX_FILTER_VALUE_STRING,
+    CELIX_FILTER_VALUE_LONG,
+    CELIX_FILTER_VALUE_DOUBLE,
+    CELIX_FILTER_VALUE_VERSION
+} celix_filter_value_type_e;
+
+typedef struct celix_filter_version_key {
+    long major;
+    long minor;
+    long micro;
+    const char *qualifier;
+} celix_filter_version_key_t;
+
+typedef struct celix_filter_typed_value {
+    celix_filter_value_type_e valueType;
+    union {
+        long longValue;
+        double doubleValue;
+        celix_filter_version_key_t versionValue;
+    };
+} celix_filter_typed_value_t;
+
+typedef struct celix_filter_instruction {
+    const celix_filter_t *filter;
+    unsigned int span; //nr of instructions for this filter including its children
+    unsigned int attributeHash; //utils_fastStringHash of the attribute, the key hash of properties
+    celix_filter_typed_value_t value; //pre-parsed filter value, only used for ordering operands
+} celix_filter_instruction_t;
+
+struct celix_filter_compiled {
+    unsigned int size;
+    uint64_t requiredKeyBits; //key bits which have to be set in the properties to match, see celix_properties_getKeyBits
+    celix_filter_instruction_t instructions[];
+};
 
 static void filter_skipWhiteSpace(char* filterString, int* pos);
 static celix_filter_t * filter_parseFilter(char* filterString, int* pos);
@@ -39,6 +82,11 @@ static char * filter_parseValue(char* filterString, int* pos);
 static celix_array_list_t* filter_parseSubstring(char* filterString, int* pos);
 
 static celix_status_t filter_compare(const celix_filter_t* filter, const char *propertyValue, bool *result);
+static void filter_parseTypedValue(const char *str, celix_filter_typed_value_t *out);
+static bool filter_compareOrdering(const celix_filter_t *filter, const celix_filter_typed_value_t *filterValue, const char *propertyValue);
+static celix_filter_compiled_t* filter_compile(const celix_filter_t *filter);
+static bool filter_matchTree(const celix_filter_t *filter, const celix_properties_t* properties);
+static bool filter_matchCompiled(const celix_filter_instruction_t *instructions, unsigned int index, const celix_properties_t *properties);
 
 static void filter_skipWhiteSpace(char * filterString, int * pos) {
     int length;
@@ -482,20 +530,13 @@ static celix_status_t filter_compare(const celix_filter_t* filter, const char *p
             *out = (strcmp(propertyValue, filter->value) == 0);
             return CELIX_SUCCESS;
         }
-        case CELIX_FILTER_OPERAND_GREATER: {
-            *out = (strcmp(propertyValue, filter->value) > 0);
-            return CELIX_SUCCESS;
-        }
-        case CELIX_FILTER_OPERAND_GREATEREQUAL: {
-            *out = (strcmp(propertyValue, filter->value) >= 0);
-            return CELIX_SUCCESS;
-        }
-        case CELIX_FILTER_OPERAND_LESS: {
-            *out = (strcmp(propertyValue, filter->value) < 0);
-            return CELIX_SUCCESS;
-        }
+        case CELIX_FILTER_OPERAND_GREATER:
+        case CELIX_FILTER_OPERAND_GREATEREQUAL:
+        case CELIX_FILTER_OPERAND_LESS:
         case CELIX_FILTER_OPERAND_LESSEQUAL: {
-            *out = (strcmp(propertyValue, filter->value) <= 0);
+            celix_filter_typed_value_t filterValue;
+            filter_parseTypedValue(filter->value, &filterValue);
+            *out = filter_compareOrdering(filter, &filterValue, propertyValue);
             return CELIX_SUCCESS;
         }
         case CELIX_FILTER_OPERAND_AND:
@@ -552,6 +593,7 @@ celix_filter_t* celix_filter_create(const char *filterString) {
         free(filterStr);
     } else {
         filter->filterStr = filterStr;
+        filter->compiled = filter_compile(filter);
     }
 
     return filter;
@@ -588,11 +630,23 @@ void celix_filter_destroy(celix_filter_t *filter) {
         filter->attribute = NULL;
         free((char*)filter->filterStr);
         filter->filterStr = NULL;
+        free(filter->compiled);
+        filter->compiled = NULL;
         free(filter);
     }
 }
 
 bool celix_filter_match(const celix_filter_t *filter, const celix_properties_t* properties) {
+    if (filter->compiled != NULL) {
+        if (properties != NULL && (filter->compiled->requiredKeyBits & ~celix_properties_getKeyBits(properties)) != 0) {
+            return false; //a required key is absent, rejected without a lookup
+        }
+        return filter_matchCompiled(filter->compiled->instructions, 0, properties);
+    }
+    return filter_matchTree(filter, properties);
+}
+
+static bool filter_matchTree(const celix_filter_t *filter, const celix_properties_t* properties) {
     bool result = false;
     switch (filter->operand) {
         case CELIX_FILTER_OPERAND_AND: {
@@ -600,7 +654,7 @@ bool celix_filter_match(const celix_filter_t *filter, const celix_properties_t*
             unsigned int i;
             for (i = 0; i < celix_arrayList_size(children); i++) {
                 celix_filter_t * sfilter = (celix_filter_t *) celix_arrayList_get(children, i);
-                bool mresult = celix_filter_match(sfilter, properties);
+                bool mresult = filter_matchTree(sfilter, properties);
                 if (!mresult) {
                     return false;
                 }
@@ -612,7 +666,7 @@ bool celix_filter_match(const celix_filter_t *filter, const celix_properties_t*
             unsigned int i;
             for (i = 0; i < celix_arrayList_size(children); i++) {
                 celix_filter_t * sfilter = (celix_filter_t *) celix_arrayList_get(children, i);
-                bool mresult = celix_filter_match(sfilter, properties);
+                bool mresult = filter_matchTree(sfilter, properties);
                 if (mresult) {
                     return true;
                 }
@@ -621,7 +675,7 @@ bool celix_filter_match(const celix_filter_t *filter, const celix_properties_t*
         }
         case CELIX_FILTER_OPERAND_NOT: {
             celix_filter_t * sfilter = celix_arrayList_get(filter->children, 0);
-            bool mresult = celix_filter_match(sfilter, properties);
+            bool mresult = filter_matchTree(sfilter, properties);
             return !mresult;
         }
         case CELIX_FILTER_OPERAND_SUBSTRING :
@@ -718,4 +772,278 @@ const char* celix_filter_findAttribute(const celix_filter_t *filter, const char
         }
     }
     return result;
-}
\ No newline at end of file
+}
+/**
+ * Returns the nr of instructions needed for the filter or 0 if the filter cannot be compiled (e.g. missing children).
+ */
+static unsigned int filter_countInstructions(const celix_filter_t *filter) {
+    if (filter == NULL) {
+        return 0;
+    }
+    unsigned int count = 1;
+    if (filter->operand == CELIX_FILTER_OPERAND_AND || filter->operand == CELIX_FILTER_OPERAND_OR || filter->operand == CELIX_FILTER_OPERAND_NOT) {
+        if (filter->children == NULL) {
+            return 0;
+        }
+        for (int i = 0; i < celix_arrayList_size(filter->children); ++i) {
+            unsigned int childCount = filter_countInstructions(celix_arrayList_get(filter->children, i));
+            if (childCount == 0) {
+                return 0;
+            }
+            count += childCount;
+        }
+    } else if (filter->attribute == NULL) {
+        return 0;
+    }
+    return count;
+}
+
+static bool filter_parseLong(const char *str, long *out) {
+    char *end = NULL;
+    errno = 0;
+    long l = strtol(str, &end, 10);
+    if (end != str && *end == '\0' && errno == 0) {
+        *out = l;
+        return true;
+    }
+    return false;
+}
+
+static bool filter_parseDouble(const char *str, double *out) {
+    char *end = NULL;
+    errno = 0;
+    double d = strtod(str, &end);
+    if (end != str && *end == '\0' && errno == 0) {
+        *out = d;
+        return true;
+    }
+    return false;
+}
+
+/**
+ * Parses a version with at least a major, minor and micro part (e.g. 1.2.3 or 1.2.3.qualifier), without allocating.
+ * Versions with only a major and minor part are parsed as double.
+ */
+static bool filter_parseVersion(const char *str, celix_filter_version_key_t *out) {
+    int consumed = 0;
+    long major, minor, micro;
+    if (sscanf(str, "%ld.%ld.%ld%n", &major, &minor, &micro, &consumed) == 3 && major >= 0 && minor >= 0 && micro >= 0) {
+        const char *rest = str + consumed;
+        if (*rest == '\0' || (*rest == '.' && rest[1] != '\0')) {
+            out->major = major;
+            out->minor = minor;
+            out->micro = micro;
+            out->qualifier = *rest == '.' ? rest + 1 : "";
+            return true;
+        }
+    }
+    return false;
+}
+
+static void filter_parseTypedValue(const char *str, celix_filter_typed_value_t *out) {
+    if (filter_parseLong(str, &out->longValue)) {
+        out->valueType = CELIX_FILTER_VALUE_LONG;
+    } else if (filter_parseDouble(str, &out->doubleValue)) {
+        out->valueType = CELIX_FILTER_VALUE_DOUBLE;
+    } else if (filter_parseVersion(str, &out->versionValue)) {
+        out->valueType = CELIX_FILTER_VALUE_VERSION;
+    } else {
+        out->valueType = CELIX_FILTER_VALUE_STRING;
+    }
+}
+
+static unsigned int filter_compileInto(const celix_filter_t *filter, celix_filter_instruction_t *instructions, unsigned int index) {
+    celix_filter_instruction_t *instr = &instructions[index];
+    instr->filter = filter;
+    instr->value.valueType = CELIX_FILTER_VALUE_STRING;
+    instr->attributeHash = filter->attribute != NULL ? utils_fastStringHash(filter->attribute) : 0;
+
+    unsigned int next = index + 1;
+    switch (filter->operand) {
+        case CELIX_FILTER_OPERAND_AND:
+        case CELIX_FILTER_OPERAND_OR:
+        case CELIX_FILTER_OPERAND_NOT:
+            for (int i = 0; i < celix_arrayList_size(filter->children); ++i) {
+                next = filter_compileInto(celix_arrayList_get(filter->children, i), instructions, next);
+            }
+            break;
+        case CELIX_FILTER_OPERAND_GREATER:
+        case CELIX_FILTER_OPERAND_GREATEREQUAL:
+        case CELIX_FILTER_OPERAND_LESS:
+        case CELIX_FILTER_OPERAND_LESSEQUAL:
+            filter_parseTypedValue(filter->value, &instr->value);
+            break;
+        default:
+            break;
+    }
+    instr->span = next - index;
+    return next;
+}
+
+/**
+ * Returns the key bits of the attributes which have to be present for the filter (instruction) to match:
+ * the attribute of a comparison, all required keys of the children of AND and the required keys common to all
+ * children of OR. NOT can match on absent keys and requires none.
+ */
+static uint64_t filter_requiredKeyBits(const celix_filter_instruction_t *instructions, unsigned int index) {
+    const celix_filter_instruction_t *instr = &instructions[index];
+    unsigned int end = index + instr->span;
+    switch (instr->filter->operand) {
+        case CELIX_FILTER_OPERAND_AND: {
+            uint64_t bits = 0;
+            for (unsigned int i = index + 1; i < end; i += instructions[i].span) {
+                bits |= filter_requiredKeyBits(instructions, i);
+            }
+            return bits;
+        }
+        case CELIX_FILTER_OPERAND_OR: {
+            uint64_t bits = ~0ULL; //note a OR without children never matches
+            for (unsigned int i = index + 1; i < end; i += instructions[i].span) {
+                bits &= filter_requiredKeyBits(instructions, i);
+            }
+            return bits;
+        }
+        case CELIX_FILTER_OPERAND_NOT:
+            return 0;
+        default:
+            return celix_properties_keyBit(instr->filter->attribute);
+    }
+}
+
+static celix_filter_compiled_t* filter_compile(const celix_filter_t *filter) {
+    unsigned int size = filter_countInstructions(filter);
+    if (size == 0) {
+        return NULL; //not compilable, tree matching is used
+    }
+    celix_filter_compiled_t *compiled = calloc(1, sizeof(*compiled) + size * sizeof(celix_filter_instruction_t));
+    if (compiled != NULL) {
+        compiled->size = size;
+        filter_compileInto(filter, compiled->instructions, 0);
+        compiled->requiredKeyBits = filter_requiredKeyBits(compiled->instructions, 0);
+    }
+    return compiled;
+}
+
+static const char* filter_lookupAttribute(const celix_filter_instruction_t *instr, const celix_properties_t *properties) {
+    if (properties == NULL || instr->filter->attribute == NULL) {
+        return NULL;
+    }
+    hash_map_t *map = (hash_map_t*)properties;
+    if (map->hashKey == utils_fastStringHash) {
+        return hashMap_getWithHash(map, instr->filter->attribute, instr->attributeHash);
+    }
+    return celix_properties_get(properties, instr->filter->attribute, NULL);
+}
+
+static int filter_compareVersionKeys(const celix_filter_version_key_t *a, const celix_filter_version_key_t *b) {
+    if (a->major != b->major) {
+        return a->major < b->major ? -1 : 1;
+    } else if (a->minor != b->minor) {
+        return a->minor < b->minor ? -1 : 1;
+    } else if (a->micro != b->micro) {
+        return a->micro < b->micro ? -1 : 1;
+    }
+    return strcmp(a->qualifier, b->qualifier);
+}
+
+/**
+ * Compares the property value with a pre-parsed filter value.
+ * Returns false if the property value is not of the same type, result is then not set.
+ */
+static bool filter_compareTyped(const celix_filter_typed_value_t *filterValue, const char *propertyValue, int *result) {
+    switch (filterValue->valueType) {
+        case CELIX_FILTER_VALUE_LONG: {
+            long l;
+            if (filter_parseLong(propertyValue, &l)) {
+                *result = l < filterValue->longValue ? -1 : (l > filterValue->longValue ? 1 : 0);
+                return true;
+            }
+            double d;
+            if (filter_parseDouble(propertyValue, &d)) {
+                double fd = (double)filterValue->longValue;
+                *result = d < fd ? -1 : (d > fd ? 1 : 0);
+                return true;
+            }
+            return false;
+        }
+        case CELIX_FILTER_VALUE_DOUBLE: {
+            double d;
+            if (filter_parseDouble(propertyValue, &d)) {
+                *result = d < filterValue->doubleValue ? -1 : (d > filterValue->doubleValue ? 1 : 0);
+                return true;
+            }
+            return false;
+        }
+        case CELIX_FILTER_VALUE_VERSION: {
+            celix_filter_version_key_t v;
+            if (filter_parseVersion(propertyValue, &v)) {
+                *result = filter_compareVersionKeys(&v, &filterValue->versionValue);
+                return true;
+            }
+            return false;
+        }
+        default:
+            return false;
+    }
+}
+
+/**
+ * Evaluates a ordering operand (<, <=, >, >=) for the property value. Long, double and version filter values are
+ * compared by type if the property value is of the same type, otherwise the values are compared as strings.
+ * Used by both the tree and the compiled matching, so both give the same result.
+ */
+static bool filter_compareOrdering(const celix_filter_t *filter, const celix_filter_typed_value_t *filterValue, const char *propertyValue) {
+    if (propertyValue == NULL) {
+        return false;
+    }
+    int cmp;
+    if (!filter_compareTyped(filterValue, propertyValue, &cmp)) {
+        cmp = strcmp(propertyValue, filter->value);
+    }
+    switch (filter->operand) {
+        case CELIX_FILTER_OPERAND_GREATER:
+            return cmp > 0;
+        case CELIX_FILTER_OPERAND_GREATEREQUAL:
+            return cmp >= 0;
+        case CELIX_FILTER_OPERAND_LESS:
+            return cmp < 0;
+        default:
+            return cmp <= 0;
+    }
+}
+
+static bool filter_matchCompiled(const celix_filter_instruction_t *instructions, unsigned int index, const celix_properties_t *properties) {
+    const celix_filter_instruction_t *instr = &instructions[index];
+    const celix_filter_t *filter = instr->filter;
+    unsigned int end = index + instr->span;
+    switch (filter->operand) {
+        case CELIX_FILTER_OPERAND_AND:
+            for (unsigned int i = index + 1; i < end; i += instructions[i].span) {
+                if (!filter_matchCompiled(instructions, i, properties)) {
+                    return false;
+                }
+            }
+            return true;
+        case CELIX_FILTER_OPERAND_OR:
+            for (unsigned int i = index + 1; i < end; i += instructions[i].span) {
+                if (filter_matchCompiled(instructions, i, properties)) {
+                    return true;
+                }
+            }
+            return false;
+        case CELIX_FILTER_OPERAND_NOT:
+            return index + 1 < end ? !filter_matchCompiled(instructions, index + 1, properties) : false;
+        case CELIX_FILTER_OPERAND_PRESENT:
+            return filter_lookupAttribute(instr, properties) != NULL;
+        case CELIX_FILTER_OPERAND_GREATER:
+        case CELIX_FILTER_OPERAND_GREATEREQUAL:
+        case CELIX_FILTER_OPERAND_LESS:
+        case CELIX_FILTER_OPERAND_LESSEQUAL:
+            return filter_compareOrdering(filter, &instr->value, filter_lookupAttribute(instr, properties));
+        default: {
+            bool result = false;
+            filter_compare(filter, filter_lookupAttribute(instr, properties), &result);
+            return result;
+        }
+    }
+}
@@ -56,7 +56,7 @@ int hashMap_entryEquals(hash_map_pt map, hash_map_entry_pt entry, hash_map_entry
     return false;
 }
 
-static unsigned int hashMap_hash(unsigned int h) {
+unsigned int hashMap_hash(unsigned int h) {
     h += ~(h << 9);
     h ^=  ((h >> 14) | (h << 18)); /* >>> */
     h +=  (h << 4);
@@ -71,11 +71,27 @@ static unsigned int hashMap_indexFor(unsigned int h, unsigned int length) {
 hash_map_pt hashMap_create(unsigned int (*keyHash)(const void *), unsigned int (*valueHash)(const void *),
         int (*keyEquals)(const void *, const void *), int (*valueEquals)(const void *, const void *)) {
     hash_map_pt map = (hash_map_pt) malloc(sizeof(*map));
-    map->treshold = (unsigned int) (DEFAULT_INITIAL_CAPACITY * DEFAULT_LOAD_FACTOR);
-    map->table = (hash_map_entry_pt *) calloc(DEFAULT_INITIAL_CAPACITY, sizeof(hash_map_entry_pt));
+    hashMap_initialize(map, NULL, DEFAULT_INITIAL_CAPACITY, keyHash, valueHash, keyEquals, valueEquals);
+    return map;
+}
+
+void hashMap_initialize(hash_map_pt map, hash_map_entry_pt *inlineTable, unsigned int tableLength,
+        unsigned int (*keyHash)(const void *), unsigned int (*valueHash)(const void *),
+        int (*keyEquals)(const void *, const void *), int (*valueEquals)(const void *, const void *)) {
+    map->treshold = (unsigned int) (tableLength * DEFAULT_LOAD_FACTOR);
+    if (inlineTable != NULL) {
+        memset(inlineTable, 0, tableLength * sizeof(hash_map_entry_pt));
+        map->table = inlineTable;
+    } else {
+        map->table = (hash_map_entry_pt *) calloc(tableLength, sizeof(hash_map_entry_pt));
+    }
+    map->inlineTable = inlineTable;
+    map->allocEntry = NULL;
+    map->freeEntry = NULL;
+    map->entryUpdated = NULL;
     map->size = 0;
     map->modificationCount = 0;
-    map->tablelength = DEFAULT_INITIAL_CAPACITY;
+    map->tablelength = tableLength;
     map->hashKey = hashMap_hashCode;
     map->hashValue = hashMap_hashCode;
     map->equalsKey = hashMap_equals;
@@ -93,13 +109,23 @@ hash_map_pt hashMap_create(unsigned int (*keyHash)(const void *), unsigned int (
     if (valueEquals != NULL) {
         map->equalsValue = valueEquals;
     }
+}
 
-    return map;
+void hashMap_freeEntry(hash_map_pt map, hash_map_entry_pt entry) {
+    if (entry != NULL) {
+        if (map->freeEntry != NULL) {
+            map->freeEntry(map, entry);
+        } else {
+            free(entry);
+        }
+    }
 }
 
 void hashMap_destroy(hash_map_pt map, bool freeKeys, bool freeValues) {
     hashMap_clear(map, freeKeys, freeValues);
-    free(map->table);
+    if (map->table != map->inlineTable) {
+        free(map->table);
+    }
     free(map);
 }
 
@@ -133,6 +159,20 @@ void * hashMap_get(hash_map_pt map, const void* key) {
     return NULL;
 }
 
+void* hashMap_getWithHash(hash_map_pt map, const void* key, unsigned int keyHash) {
+    if (key == NULL) {
+        return hashMap_get(map, key);
+    }
+    unsigned int hash = hashMap_hash(keyHash);
+    hash_map_entry_pt entry = NULL;
+    for (entry = map->table[hashMap_indexFor(hash, map->tablelength)]; entry != NULL; entry = entry->next) {
+        if (entry->hash == hash && (entry->key == key || map->equalsKey(key, entry->key))) {
+            return entry->value;
+        }
+    }
+    return NULL;
+}
+
 bool hashMap_containsKey(hash_map_pt map, const void* key) {
     return hashMap_getEntry(map, key) != NULL;
 }
@@ -158,6 +198,9 @@ void * hashMap_put(hash_map_pt map, void * key, void * value) {
             if (entry->key == NULL) {
                 void * oldValue = entry->value;
                 entry->value = value;
+                if (map->entryUpdated != NULL) {
+                    map->entryUpdated(map, entry);
+                }
                 return oldValue;
             }
         }
@@ -173,6 +216,9 @@ void * hashMap_put(hash_map_pt map, void * key, void * value) {
         if (entry->hash == hash && (entry->key == key || map->equalsKey(key, entry->key))) {
             void * oldValue = entry->value;
             entry->value = value;
+            if (map->entryUpdated != NULL) {
+                map->entryUpdated(map, entry);
+            }
             return oldValue;
         }
     }
@@ -203,7 +249,9 @@ void hashMap_resize(hash_map_pt map, int newCapacity) {
             } while (entry != NULL);
         }
     }
-    free(map->table);
+    if (map->table != map->inlineTable) {
+        free(map->table);
+    }
     map->table = newTable;
     map->tablelength = newCapacity;
     map->treshold = (unsigned int) ceil(newCapacity * DEFAULT_LOAD_FACTOR);
@@ -215,7 +263,7 @@ void * hashMap_remove(hash_map_pt map, const void* key) {
     if (entry != NULL) {
         entry->key = NULL;
         entry->value = NULL;
-        free(entry);
+        hashMap_freeEntry(map, entry);
     }
     return value;
 }
@@ -292,7 +340,7 @@ void hashMap_clear(hash_map_pt map, bool freeKey, bool freeValue) {
                 free(f->key);
             if (freeValue && f->value != NULL)
                 free(f->value);
-            free(f);
+            hashMap_freeEntry(map, f);
         }
         table[i] = NULL;
     }
@@ -325,12 +373,15 @@ bool hashMap_containsValue(hash_map_pt map, const void* value) {
 
 void hashMap_addEntry(hash_map_pt map, int hash, void* key, void* value, int bucketIndex) {
     hash_map_entry_pt entry = map->table[bucketIndex];
-    hash_map_entry_pt new = (hash_map_entry_pt) malloc(sizeof(*new));
+    hash_map_entry_pt new = map->allocEntry != NULL ? map->allocEntry(map) : (hash_map_entry_pt) malloc(sizeof(*new));
     new->hash = hash;
     new->key = key;
     new->value = value;
     new->next = entry;
     map->table[bucketIndex] = new;
+    if (map->entryUpdated != NULL) {
+        map->entryUpdated(map, new);
+    }
     if (map->size++ >= map->treshold) {
         hashMap_resize(map, 2 * map->tablelength);
     }
@@ -398,7 +449,7 @@ void hashMapIterator_remove(hash_map_iterator_pt iterator) {
     key = iterator->current->key;
     iterator->current = NULL;
     entry = hashMap_removeEntryForKey(iterator->map, key);
-    free(entry);
+    hashMap_freeEntry(iterator->map, entry);
     iterator->expectedModCount = iterator->map->modificationCount;
 }
 
@@ -476,7 +527,7 @@ bool hashMapKeySet_contains(hash_map_key_set_pt keySet, const void* key) {
 bool hashMapKeySet_remove(hash_map_key_set_pt keySet, const void* key) {
     hash_map_entry_pt entry = hashMap_removeEntryForKey(keySet->map, key);
     bool removed = entry != NULL;
-    free(entry);
+    hashMap_freeEntry(keySet->map, entry);
     return removed;
 }
 
@@ -579,7 +630,7 @@ bool hashMapEntrySet_contains(hash_map_entry_set_pt entrySet, hash_map_entry_pt
 bool hashMapEntrySet_remove(hash_map_entry_set_pt entrySet, hash_map_entry_pt entry) {
     hash_map_entry_pt temp = hashMap_removeMapping(entrySet->map, entry);
     if (temp != NULL) {
-        free(temp);
+        hashMap_freeEntry(entrySet->map, temp);
         return true;
     } else {
         return false;
@@ -33,11 +33,32 @@
 UTILS_EXPORT unsigned int hashMap_hashCode(const void* toHash);
 UTILS_EXPORT int hashMap_equals(const void* toCompare, const void* compare);
 
+/**
+ * Spreads the bits of a key hash, the result is stored as hash of the map entries.
+ */
+unsigned int hashMap_hash(unsigned int h);
+
 void hashMap_resize(hash_map_pt map, int newCapacity);
 hash_map_entry_pt hashMap_removeEntryForKey(hash_map_pt map, const void* key);
 UTILS_EXPORT hash_map_entry_pt hashMap_removeMapping(hash_map_pt map, hash_map_entry_pt entry);
 void hashMap_addEntry(hash_map_pt map, int hash, void* key, void* value, int bucketIndex);
 
+/**
+ * Same as hashMap_get, but with a key hash already computed with the key hash function of the map (e.g. a
+ * pre-computed utils_stringHash of a string key).
+ */
+void* hashMap_getWithHash(hash_map_pt map, const void* key, unsigned int keyHash);
+
+/**
+ * Initializes a hash map in user provided memory, with a user provided (inline) table with a length of a power of 2.
+ * The map memory will be free'd by hashMap_destroy, the inline table not.
+ */
+void hashMap_initialize(hash_map_pt map, hash_map_entry_pt *inlineTable, unsigned int tableLength,
+        unsigned int (*keyHash)(const void *), unsigned int (*valueHash)(const void *),
+        int (*keyEquals)(const void *, const void *), int (*valueEquals)(const void *, const void *));
+
+void hashMap_freeEntry(hash_map_pt map, hash_map_entry_pt entry);
+
 struct hashMapEntry {
     void* key;
     void* value;
@@ -56,6 +77,13 @@ struct hashMap {
     unsigned int (*hashValue)(const void* value);
     int (*equalsKey)(const void* key1, const void* key2);
     int (*equalsValue)(const void* value1, const void* value2);
+
+    //optional entry allocation, if NULL entries are malloc'ed and free'd. Used by celix_properties to embed entries.
+    hash_map_entry_pt (*allocEntry)(hash_map_pt map);
+    void (*freeEntry)(hash_map_pt map, hash_map_entry_pt entry);
+    //optional callback called when a entry is added or the value of a entry is replaced
+    void (*entryUpdated)(hash_map_pt map, hash_map_entry_pt entry);
+    hash_map_entry_pt *inlineTable; //table not owned by the map (not free'd), can be NULL
 };
 
 struct hashMapKeySet {
@@ -28,16 +28,67 @@
 #include <string.h>
 #include <stdlib.h>
 #include <ctype.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
 #include "celixbool.h"
 #include "properties.h"
 #include "celix_properties.h"
 #include "utils.h"
+#include "hash_map_private.h"
 #include <errno.h>
 
 
-#define MALLOC_BLOCK_SIZE        5
+#define CELIX_PROPERTIES_INLINE_TABLE_SIZE      16
+#define CELIX_PROPERTIES_INLINE_ENTRIES_SIZE    12 //note resize threshold of the inline table (16 * 0.75)
+
+/**
+ * A properties entry extends the hash map entry with the typed (parsed) value of the string value.
+ * The typed values are updated every time the entry value is set (also for hashMap_put calls).
+ */
+typedef struct celix_properties_entry {
+    struct hashMapEntry entry; //note needs to be first
+    bool internedKey;
+    bool longValid;
+    bool doubleValid;
+    bool boolValid;
+    bool boolValue;
+    long longValue;
+    double doubleValue;
+} celix_properties_entry_t;
+
+/**
+ * Properties are allocated as a single block, containing the hash map, a inline table and a set of inline entries.
+ * Only when more entries are needed than fit in the inline table, additional memory is allocated.
+ */
+typedef struct celix_properties_block {
+    struct hashMap map; //note needs to be first, hashMap_destroy free's the map pointer
+    hash_map_entry_pt table[CELIX_PROPERTIES_INLINE_TABLE_SIZE];
+    celix_properties_entry_t entries[CELIX_PROPERTIES_INLINE_ENTRIES_SIZE];
+    unsigned int entriesUsed; //bitmask
+    uint64_t keyBits; //bit of every key ever set, see celix_properties_getKeyBits
+} celix_properties_block_t;
+
+/**
+ * Frequently used property keys. These are not copied (or free'd) when used as property key.
+ */
+static const char * const celix_properties_internedKeys[] = {
+        "objectClass",
+        "service.id",
+        "service.pid",
+        "service.ranking",
+        "service.version",
+        "service.lang",
+        "service.bundleid",
+        "service.scope",
+        "service.exported.interfaces",
+        "service.imported",
+        "service.imported.configs",
+        "endpoint.id",
+        NULL
+};
 
-static void parseLine(const char* line, celix_properties_t *props);
 
 properties_pt properties_create(void) {
     return celix_properties_create();
@@ -89,121 +140,89 @@ void properties_unset(properties_pt properties, const char* key) {
     celix_properties_unset(properties, key);
 }
 
-static void updateBuffers(char **key, char ** value, char **output, int outputPos, int *key_len, int *value_len) {
-    if (*output == *key) {
-        if (outputPos == (*key_len) - 1) {
-            (*key_len) += MALLOC_BLOCK_SIZE;
-            *key = realloc(*key, *key_len);
-            *output = *key;
-        }
-    }
-    else {
-        if (outputPos == (*value_len) - 1) {
-            (*value_len) += MALLOC_BLOCK_SIZE;
-            *value = realloc(*value, *value_len);
-            *output = *value;
+/**
+ * Parses a single line [line, end) and sets the resulting property.
+ * The line is unescaped into the scratch buffer as "key\0value\0". The unescaped key and value are never longer than
+ * the line, so the scratch buffer only grows (once) for lines longer than the lines parsed before.
+ */
+static void celix_properties_parseLine(celix_properties_t *props, const char *line, const char *end, char **scratch, size_t *scratchSize) {
+    size_t needed = (size_t)(end - line) + 2;
+    if (needed > *scratchSize) {
+        char *buf = realloc(*scratch, needed);
+        if (buf == NULL) {
+            return;
         }
+        *scratch = buf;
+        *scratchSize = needed;
     }
-}
 
-static void parseLine(const char* line, celix_properties_t *props) {
-    int linePos = 0;
+    char *buf = *scratch;
+    char *value = NULL; //start of the value in buf, NULL while parsing the key
+    size_t pos = 0;
+    bool started = false;
     bool precedingCharIsBackslash = false;
-    bool isComment = false;
-    int outputPos = 0;
-    char *output = NULL;
-    int key_len = MALLOC_BLOCK_SIZE;
-    int value_len = MALLOC_BLOCK_SIZE;
-    linePos = 0;
-    precedingCharIsBackslash = false;
-    isComment = false;
-    output = NULL;
-    outputPos = 0;
-
-    //Ignore empty lines
-    if (line[0] == '\n' && line[1] == '\0') {
-        return;
-    }
-
-    char *key = calloc(1, key_len);
-    char *value = calloc(1, value_len);
-    key[0] = '\0';
-    value[0] = '\0';
-
-    while (line[linePos] != '\0') {
-        if (line[linePos] == ' ' || line[linePos] == '\t') {
-            if (output == NULL) {
-                //ignore
-                linePos += 1;
-                continue;
-            }
+    for (const char *c = line; c < end; ++c) {
+        if (!started && (*c == ' ' || *c == '\t')) {
+            continue; //ignore leading whitespace
         }
-        else {
-            if (output == NULL) {
-                output = key;
-            }
-        }
-        if (line[linePos] == '=' || line[linePos] == ':' || line[linePos] == '#' || line[linePos] == '!') {
+        started = true;
+        size_t outputPos = value == NULL ? pos : pos - (size_t)(value - buf);
+        if (*c == '=' || *c == ':' || *c == '#' || *c == '!') {
             if (precedingCharIsBackslash) {
                 //escaped special character
-                output[outputPos++] = line[linePos];
-                updateBuffers(&key, &value, &output, outputPos, &key_len, &value_len);
+                buf[pos++] = *c;
                 precedingCharIsBackslash = false;
-            }
-            else {
-                if (line[linePos] == '#' || line[linePos] == '!') {
-                    if (outputPos == 0) {
-                        isComment = true;
-                        break;
-                    }
-                    else {
-                        output[outputPos++] = line[linePos];
-                        updateBuffers(&key, &value, &output, outputPos, &key_len, &value_len);
-                    }
-                }
-                else { // = or :
-                    if (output == value) { //already have a seperator
-                        output[outputPos++] = line[linePos];
-                        updateBuffers(&key, &value, &output, outputPos, &key_len, &value_len);
-                    }
-                    else {
-                        output[outputPos++] = '\0';
-                        updateBuffers(&key, &value, &output, outputPos, &key_len, &value_len);
-                        output = value;
-                        outputPos = 0;
-                    }
+            } else if (*c == '#' || *c == '!') {
+                if (outputPos == 0) {
+                    return; //comment
                 }
+                buf[pos++] = *c;
+            } else if (value != NULL) { //already have a separator
+                buf[pos++] = *c;
+            } else {
+                buf[pos++] = '\0';
+                value = buf + pos;
             }
-        }
-        else if (line[linePos] == '\\') {
+        } else if (*c == '\\') {
             if (precedingCharIsBackslash) { //double backslash -> backslash
-                output[outputPos++] = '\\';
-                updateBuffers(&key, &value, &output, outputPos, &key_len, &value_len);
+                buf[pos++] = '\\';
             }
             precedingCharIsBackslash = true;
-        }
-        else { //normal character
+        } else { //normal character
             precedingCharIsBackslash = false;
-            output[outputPos++] = line[linePos];
-            updateBuffers(&key, &value, &output, outputPos, &key_len, &value_len);
+            buf[pos++] = *c;
         }
-        linePos += 1;
-    }
-    if (output != NULL) {
-        output[outputPos] = '\0';
-    }
-
-    if (!isComment) {
-        //printf("putting 'key'/'value' '%s'/'%s' in properties\n", utils_stringTrim(key), utils_stringTrim(value));
-        celix_properties_set(props, utils_stringTrim(key), utils_stringTrim(value));
     }
-    if(key) {
-        free(key);
+    if (!started) {
+        return; //empty line
     }
-    if(value) {
-        free(value);
+    buf[pos] = '\0';
+    if (value == NULL) {
+        value = buf + pos + 1;
+        *value = '\0';
     }
+    celix_properties_set(props, utils_stringTrim(buf), utils_stringTrim(value));
+}
 
+/**
+ * Parses properties from data [data, data + size) in a single pass.
+ */
+static void celix_properties_parse(celix_properties_t *props, const char *data, size_t size) {
+    char *scratch = NULL;
+    size_t scratchSize = 0;
+    const char *end = data + size;
+    const char *line = data;
+    while (line < end) {
+        const char *eol = memchr(line, '\n', (size_t)(end - line));
+        if (eol == NULL) {
+            eol = end;
+        }
+        if (eol > line) {
+            celix_properties_parseLine(props, line, eol, &scratch, &scratchSize);
+        }
+        line = eol + 1;
+    }
+    free(scratch);
 }
 
 
@@ -216,26 +235,128 @@ static void parseLine(const char* line, celix_properties_t *props) {
 
 
 
+static hash_map_entry_pt celix_properties_allocEntry(hash_map_pt map) {
+    celix_properties_block_t *block = (celix_properties_block_t*)map;
+    celix_properties_entry_t *entry = NULL;
+    for (int i = 0; i < CELIX_PROPERTIES_INLINE_ENTRIES_SIZE; ++i) {
+        if ((block->entriesUsed & (1u << i)) == 0) {
+            block->entriesUsed |= (1u << i);
+            entry = &block->entries[i];
+            break;
+        }
+    }
+    if (entry == NULL) {
+        entry = malloc(sizeof(*entry));
+    }
+    memset(entry, 0, sizeof(*entry));
+    return &entry->entry;
+}
+
+static void celix_properties_freeEntry(hash_map_pt map, hash_map_entry_pt entry) {
+    celix_properties_block_t *block = (celix_properties_block_t*)map;
+    celix_properties_entry_t *propEntry = (celix_properties_entry_t*)entry;
+    if (propEntry >= block->entries && propEntry < block->entries + CELIX_PROPERTIES_INLINE_ENTRIES_SIZE) {
+        block->entriesUsed &= ~(1u << (propEntry - block->entries));
+    } else {
+        free(propEntry);
+    }
+}
+
+/**
+ * Returns the key bitmap bit of a entry hash (the spread utils_fastStringHash of the key).
+ */
+static inline uint64_t celix_properties_bitForHash(unsigned int entryHash) {
+    return 1ULL << ((entryHash >> 26) & 63);
+}
+
+static void celix_properties_updateEntry(hash_map_pt map, hash_map_entry_pt entry) {
+    celix_properties_entry_t *propEntry = (celix_properties_entry_t*)entry;
+    ((celix_properties_block_t*)map)->keyBits |= celix_properties_bitForHash(entry->hash);
+    const char *val = entry->value;
+    propEntry->longValid = false;
+    propEntry->doubleValid = false;
+    propEntry->boolValid = false;
+    if (val != NULL) {
+        char *enptr = NULL;
+        errno = 0;
+        long l = strtol(val, &enptr, 10);
+        if (enptr != val && errno == 0) {
+            propEntry->longValid = true;
+            propEntry->longValue = l;
+        }
+
+        enptr = NULL;
+        errno = 0;
+        double d = strtod(val, &enptr);
+        if (enptr != val && errno == 0) {
+            propEntry->doubleValid = true;
+            propEntry->doubleValue = d;
+        }
+
+        char buf[32];
+        snprintf(buf, 32, "%s", val);
+        char *trimmed = utils_stringTrim(buf);
+        if (strncasecmp("true", trimmed, strlen("true")) == 0) {
+            propEntry->boolValid = true;
+            propEntry->boolValue = true;
+        } else if (strncasecmp("false", trimmed, strlen("false")) == 0) {
+            propEntry->boolValid = true;
+            propEntry->boolValue = false;
+        }
+    }
+}
+
+/**
+ * Returns the properties entry if the properties is created with celix_properties_create, otherwise NULL
+ * (properties created directly with hashMap_create).
+ */
+static celix_properties_entry_t* celix_properties_getEntry(const celix_properties_t *properties, const char *key) {
+    if (properties != NULL && properties->allocEntry == celix_properties_allocEntry) {
+        return (celix_properties_entry_t*)hashMap_getEntry((hash_map_t*)properties, key);
+    }
+    return NULL;
+}
+
+static const char* celix_properties_internKey(const char *key) {
+    for (int i = 0; celix_properties_internedKeys[i] != NULL; ++i) {
+        const char *interned = celix_properties_internedKeys[i];
+        if (interned[0] == key[0] && strcmp(interned, key) == 0) {
+            return interned;
+        }
+    }
+    return NULL;
+}
+
 celix_properties_t* celix_properties_create(void) {
-    return hashMap_create(utils_stringHash, utils_stringHash, utils_stringEquals, utils_stringEquals);
+    celix_properties_block_t *block = malloc(sizeof(*block));
+    hashMap_initialize(&block->map, block->table, CELIX_PROPERTIES_INLINE_TABLE_SIZE, utils_fastStringHash, utils_fastStringHash, utils_stringEquals, utils_stringEquals);
+    block->map.allocEntry = celix_properties_allocEntry;
+    block->map.freeEntry = celix_properties_freeEntry;
+    block->map.entryUpdated = celix_properties_updateEntry;
+    block->entriesUsed = 0;
+    block->keyBits = 0;
+    return &block->map;
 }
 
 void celix_properties_destroy(celix_properties_t *properties) {
     if (properties != NULL) {
-        hash_map_iterator_pt iter = hashMapIterator_create(properties);
-        while (hashMapIterator_hasNext(iter)) {
-            hash_map_entry_pt entry = hashMapIterator_nextEntry(iter);
-            free(hashMapEntry_getKey(entry));
+        bool isPropertiesMap = properties->allocEntry == celix_properties_allocEntry;
+        hash_map_iterator_t iter = hashMapIterator_construct(properties);
+        while (hashMapIterator_hasNext(&iter)) {
+            hash_map_entry_pt entry = hashMapIterator_nextEntry(&iter);
+            if (!isPropertiesMap || !((celix_properties_entry_t*)entry)->internedKey) {
+                free(hashMapEntry_getKey(entry));
+            }
             free(hashMapEntry_getValue(entry));
         }
-        hashMapIterator_destroy(iter);
         hashMap_destroy(properties, false, false);
     }
 }
 
-celix_properties_t* celix_properties_load(const char *filename) {
-    FILE *file = fopen(filename, "r");
+static celix_properties_t* celix_properties_loadWithFd(int fd) {
+    FILE *file = fdopen(fd, "r");
     if (file == NULL) {
+        close(fd);
         return NULL;
     }
     celix_properties_t *props = celix_properties_loadWithStream(file);
@@ -243,36 +364,56 @@ celix_properties_t* celix_properties_load(const char *filename) {
     return props;
 }
 
+celix_properties_t* celix_properties_load(const char *filename) {
+    int fd = open(filename, O_RDONLY);
+    if (fd < 0) {
+        return NULL;
+    }
+
+    struct stat st;
+    void *data = MAP_FAILED;
+    if (fstat(fd, &st) == 0 && S_ISREG(st.st_mode) && st.st_size > 0) {
+        //note the file is mapped read only, the parser does not need a (writable) copy of the file content
+        data = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    }
+    if (data == MAP_FAILED) {
+        //empty file, not a regular file (e.g. a pipe) or mmap not possible, fallback to reading the stream
+        return celix_properties_loadWithFd(fd);
+    }
+
+    posix_madvise(data, (size_t)st.st_size, POSIX_MADV_SEQUENTIAL);
+    celix_properties_t *props = celix_properties_create();
+    celix_properties_parse(props, data, (size_t)st.st_size);
+    munmap(data, (size_t)st.st_size);
+    close(fd);
+    return props;
+}
+
 celix_properties_t* celix_properties_loadWithStream(FILE *file) {
     celix_properties_t *props = NULL;
 
     if (file != NULL ) {
-        char *saveptr;
-        char *filebuffer = NULL;
-        char *line = NULL;
-        size_t file_size = 0;
-
         props = celix_properties_create();
-        fseek(file, 0, SEEK_END);
-        file_size = ftell(file);
-        fseek(file, 0, SEEK_SET);
-
-        if (file_size > 0) {
-            filebuffer = calloc(file_size + 1, sizeof(char));
-            if (filebuffer) {
-                size_t rs = fread(filebuffer, sizeof(char), file_size, file);
-                if (rs != file_size) {
-                    fprintf(stderr,"fread read only %lu bytes out of %lu\n", rs, file_size);
-                }
-                filebuffer[file_size]='\0';
-                line = strtok_r(filebuffer, "\n", &saveptr);
-                while (line != NULL) {
-                    parseLine(line, props);
-                    line = strtok_r(NULL, "\n", &saveptr);
+        size_t capacity = 4096;
+        size_t size = 0;
+        char *buffer = malloc(capacity);
+        size_t rs;
+        while (buffer != NULL && (rs = fread(buffer + size, sizeof(char), capacity - size, file)) > 0) {
+            size += rs;
+            if (size == capacity) {
+                capacity *= 2;
+                char *newBuffer = realloc(buffer, capacity);
+                if (newBuffer == NULL) {
+                    fprintf(stderr, "Cannot allocate %zu bytes to load properties\n", capacity);
+                    free(buffer);
                 }
-                free(filebuffer);
+                buffer = newBuffer;
             }
         }
+        if (buffer != NULL) {
+            celix_properties_parse(props, buffer, size);
+            free(buffer);
+        }
     }
 
     return props;
@@ -280,29 +421,7 @@ celix_properties_t* celix_properties_loadWithStream(FILE *file) {
 
 celix_properties_t* celix_properties_loadFromString(const char *input) {
     celix_properties_t *props = celix_properties_create();
-
-    char *in = strdup(input);
-    char *line = NULL;
-    char *saveLinePointer = NULL;
-
-    bool firstTime = true;
-    do {
-        if (firstTime){
-            line = strtok_r(in, "\n", &saveLinePointer);
-            firstTime = false;
-        }else {
-            line = strtok_r(NULL, "\n", &saveLinePointer);
-        }
-
-        if (line == NULL){
-            break;
-        }
-
-        parseLine(line, props);
-    } while(line != NULL);
-
-    free(in);
-
+    celix_properties_parse(props, input, strlen(input));
     return props;
 }
 
@@ -375,6 +494,12 @@ void celix_properties_set(celix_properties_t *properties, const char *key, const
             char *oldKey = hashMapEntry_getKey(entry);
             oldVal = hashMapEntry_getValue(entry);
             hashMap_put(properties, oldKey, newVal);
+        } else if (properties->allocEntry == celix_properties_allocEntry) {
+            const char *interned = celix_properties_internKey(key);
+            hashMap_put(properties, interned != NULL ? (char*)interned : strndup(key, 1024 * 1024), newVal);
+            if (interned != NULL) {
+                ((celix_properties_entry_t*)hashMap_getEntry(properties, interned))->internedKey = true;
+            }
         } else {
             hashMap_put(properties, strndup(key, 1024 * 1024), newVal);
         }
@@ -383,19 +508,27 @@ void celix_properties_set(celix_properties_t *properties, const char *key, const
 }
 
 void celix_properties_unset(celix_properties_t *properties, const char *key) {
+    celix_properties_entry_t *entry = celix_properties_getEntry(properties, key);
+    char *oldKey = entry != NULL && !entry->internedKey ? entry->entry.key : NULL;
     char* oldValue = hashMap_remove(properties, key);
+    free(oldKey);
     free(oldValue);
 }
 
 long celix_properties_getAsLong(const celix_properties_t *props, const char *key, long defaultValue) {
     long result = defaultValue;
-    const char *val = celix_properties_get(props, key, NULL);
-    if (val != NULL) {
-        char *enptr = NULL;
-        errno = 0;
-        long r = strtol(val, &enptr, 10);
-        if (enptr != val && errno == 0) {
-            result = r;
+    celix_properties_entry_t *entry = celix_properties_getEntry(props, key);
+    if (entry != NULL) {
+        result = entry->longValid ? entry->longValue : defaultValue;
+    } else {
+        const char *val = celix_properties_get(props, key, NULL);
+        if (val != NULL) {
+            char *enptr = NULL;
+            errno = 0;
+            long r = strtol(val, &enptr, 10);
+            if (enptr != val && errno == 0) {
+                result = r;
+            }
         }
     }
     return result;
@@ -413,13 +546,18 @@ void celix_properties_setLong(celix_properties_t *props, const char *key, long v
 
 double celix_properties_getAsDouble(const celix_properties_t *props, const char *key, double defaultValue) {
     double result = defaultValue;
-    const char *val = celix_properties_get(props, key, NULL);
-    if (val != NULL) {
-        char *enptr = NULL;
-        errno = 0;
-        double r = strtod(val, &enptr);
-        if (enptr != val && errno == 0) {
-            result = r;
+    celix_properties_entry_t *entry = celix_properties_getEntry(props, key);
+    if (entry != NULL) {
+        result = entry->doubleValid ? entry->doubleValue : defaultValue;
+    } else {
+        const char *val = celix_properties_get(props, key, NULL);
+        if (val != NULL) {
+            char *enptr = NULL;
+            errno = 0;
+            double r = strtod(val, &enptr);
+            if (enptr != val && errno == 0) {
+                result = r;
+            }
         }
     }
     return result;
@@ -430,6 +568,12 @@ void celix_properties_setDouble(celix_properties_t *props, const char *key, doub
     int writen = snprintf(buf, 32, "%f", val);
     if (writen <= 31) {
         celix_properties_set(props, key, buf);
+        celix_properties_entry_t *entry = celix_properties_getEntry(props, key);
+        if (entry != NULL) {
+            //keep the precise value, the string value is rounded
+            entry->doubleValid = true;
+            entry->doubleValue = val;
+        }
     } else {
         fprintf(stderr,"buf to small for value '%f'\n", val);
     }
@@ -437,15 +581,20 @@ void celix_properties_setDouble(celix_properties_t *props, const char *key, doub
 
 bool celix_properties_getAsBool(celix_properties_t *props, const char *key, bool defaultValue) {
     bool result = defaultValue;
-    const char *val = celix_properties_get(props, key, NULL);
-    if (val != NULL) {
-        char buf[32];
-        snprintf(buf, 32, "%s", val);
-        char *trimmed = utils_stringTrim(buf);
-        if (strncasecmp("true", trimmed, strlen("true")) == 0) {
-            result = true;
-        } else if (strncasecmp("false", trimmed, strlen("false")) == 0) {
-            result = false;
+    celix_properties_entry_t *entry = celix_properties_getEntry(props, key);
+    if (entry != NULL) {
+        result = entry->boolValid ? entry->boolValue : defaultValue;
+    } else {
+        const char *val = celix_properties_get(props, key, NULL);
+        if (val != NULL) {
+            char buf[32];
+            snprintf(buf, 32, "%s", val);
+            char *trimmed = utils_stringTrim(buf);
+            if (strncasecmp("true", trimmed, strlen("true")) == 0) {
+                result = true;
+            } else if (strncasecmp("false", trimmed, strlen("false")) == 0) {
+                result = false;
+            }
         }
     }
     return result;
@@ -459,6 +608,17 @@ int celix_properties_size(const celix_properties_t *properties) {
     return hashMap_size((hash_map_t*)properties);
 }
 
+uint64_t celix_properties_keyBit(const char *key) {
+    return celix_properties_bitForHash(key == NULL ? 0 : hashMap_hash(utils_fastStringHash(key)));
+}
+
+uint64_t celix_properties_getKeyBits(const celix_properties_t *properties) {
+    if (properties != NULL && properties->allocEntry == celix_properties_allocEntry) {
+        return ((const celix_properties_block_t*)properties)->keyBits;
+    }
+    return ~0ULL;
+}
+
 celix_properties_iterator_t celix_propertiesIterator_construct(const celix_properties_t *properties) {
     return hashMapIterator_construct((hash_map_t*)properties);
 }
@@ -25,10 +25,24 @@
  */
 
 #include <stdlib.h>
+#include <stdint.h>
 #include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
 
 #include "utils.h"
 
+unsigned int utils_hashBytes(const void *data, size_t length) {
+    const char *bytes = data;
+    unsigned int hc = 5381;
+    for (size_t i = 0; i < length; ++i) {
+        hc = (hc << 5) + hc + bytes[i]; //note same char arithmetic as utils_stringHash
+    }
+    return hc;
+}
+
 unsigned int utils_stringHash(const void* strPtr) {
     const char* string = strPtr;
     unsigned int hc = 5381;
@@ -36,10 +50,82 @@ unsigned int utils_stringHash(const void* strPtr) {
     while((ch = *string++) != '\0'){
         hc = (hc << 5) + hc + ch;
     }
-
     return hc;
 }
 
+/*
+ * Word at a time hash, based on wyhash (public domain, https://github.com/wangyi-fudan/wyhash).
+ * Keys up to 16 bytes are hashed with two (overlapping) reads, longer keys are processed per 16 bytes and keys longer
+ * than 48 bytes in three independent lanes.
+ */
+#define UTILS_HASH_SECRET0 0xa0761d6478bd642fULL
+#define UTILS_HASH_SECRET1 0xe7037ed1a0b428dbULL
+#define UTILS_HASH_SECRET2 0x8ebc6af09c88c6e3ULL
+#define UTILS_HASH_SECRET3 0x589965cc75374cc3ULL
+
+static inline uint64_t utils_hashMix(uint64_t a, uint64_t b) {
+    __uint128_t r = (__uint128_t)a * b;
+    return (uint64_t)r ^ (uint64_t)(r >> 64);
+}
+
+static inline uint64_t utils_hashRead8(const uint8_t *p) {
+    uint64_t v;
+    memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+static inline uint64_t utils_hashRead4(const uint8_t *p) {
+    uint32_t v;
+    memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+unsigned int utils_fastHashBytes(const void *data, size_t length) {
+    const uint8_t *p = data;
+    uint64_t seed = utils_hashMix(UTILS_HASH_SECRET0, UTILS_HASH_SECRET1);
+    uint64_t a;
+    uint64_t b;
+    if (length <= 16) {
+        if (length >= 4) {
+            a = (utils_hashRead4(p) << 32) | utils_hashRead4(p + ((length >> 3) << 2));
+            b = (utils_hashRead4(p + length - 4) << 32) | utils_hashRead4(p + length - 4 - ((length >> 3) << 2));
+        } else if (length > 0) {
+            a = ((uint64_t)p[0] << 16) | ((uint64_t)p[length >> 1] << 8) | p[length - 1];
+            b = 0;
+        } else {
+            a = b = 0;
+        }
+    } else {
+        size_t i = length;
+        if (i > 48) {
+            uint64_t see1 = seed;
+            uint64_t see2 = seed;
+            do {
+                seed = utils_hashMix(utils_hashRead8(p) ^ UTILS_HASH_SECRET1, utils_hashRead8(p + 8) ^ seed);
+                see1 = utils_hashMix(utils_hashRead8(p + 16) ^ UTILS_HASH_SECRET2, utils_hashRead8(p + 24) ^ see1);
+                see2 = utils_hashMix(utils_hashRead8(p + 32) ^ UTILS_HASH_SECRET3, utils_hashRead8(p + 40) ^ see2);
+                p += 48;
+                i -= 48;
+            } while (i > 48);
+            seed ^= see1 ^ see2;
+        }
+        while (i > 16) {
+            seed = utils_hashMix(utils_hashRead8(p) ^ UTILS_HASH_SECRET1, utils_hashRead8(p + 8) ^ seed);
+            i -= 16;
+            p += 16;
+        }
+        a = utils_hashRead8(p + i - 16);
+        b = utils_hashRead8(p + i - 8);
+    }
+    uint64_t h = utils_hashMix(UTILS_HASH_SECRET1 ^ length, utils_hashMix(a ^ UTILS_HASH_SECRET1, b ^ seed));
+    return (unsigned int)(h ^ (h >> 32));
+}
+
+unsigned int utils_fastStringHash(const void* strPtr) {
+    const char* string = strPtr;
+    return utils_fastHashBytes(string, strlen(string)); //note strlen is vectorized by the libc
+}
+
 int utils_stringEquals(const void* string, const void* toCompare) {
     return strcmp((const char*)string, (const char*)toCompare) == 0;
 }
@@ -146,3 +232,34 @@ double celix_difftime(const struct timespec *tBegin, const struct timespec *tEnd
     float diff_ns = tEnd->tv_nsec - tBegin->tv_nsec;
     return diff_s + (diff_ns / 1000000000.0);
 }
+
+celix_status_t utils_mapFile(const char *path, const void **data, size_t *length) {
+    *data = NULL;
+    *length = 0;
+    int fd = open(path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        return CELIX_FILE_IO_EXCEPTION;
+    }
+    celix_status_t status = CELIX_SUCCESS;
+    struct stat st;
+    if (fstat(fd, &st) != 0 || !S_ISREG(st.st_mode)) {
+        status = CELIX_FILE_IO_EXCEPTION;
+    } else if (st.st_size > 0) {
+        void *mapped = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (mapped == MAP_FAILED) {
+            status = CELIX_FILE_IO_EXCEPTION;
+        } else {
+            *data = mapped;
+            *length = (size_t)st.st_size;
+        }
+    }
+    //note the mapping stays valid after the file is closed
+    close(fd);
+    return status;
+}
+
+void utils_unmapFile(const void *data, size_t length) {
+    if (data != NULL && length > 0) {
+        munmap((void*)data, length);
+    }
+}
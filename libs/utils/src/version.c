@@ -266,3 +266,60 @@ celix_status_t version_isCompatible(version_pt user, version_pt provider, bool*
 
     return status;
 }
+
+static bool celix_version_parseKeyComponent(const char **str, uint64_t max, uint64_t *out) {
+    const char *c = *str;
+    uint64_t val = 0;
+    if (*c < '0' || *c > '9') {
+        return false;
+    }
+    while (*c >= '0' && *c <= '9') {
+        val = val * 10 + (uint64_t)(*c - '0');
+        if (val > max) {
+            return false;
+        }
+        ++c;
+    }
+    *str = c;
+    *out = val;
+    return true;
+}
+
+bool celix_version_parseKey(const char *versionStr, celix_version_key_t *key) {
+    if (versionStr == NULL) {
+        return false;
+    }
+    const uint64_t max[3] = {CELIX_VERSION_KEY_MAX_MAJOR, CELIX_VERSION_KEY_MAX_MINOR, CELIX_VERSION_KEY_MAX_MICRO};
+    uint64_t parts[3] = {0, 0, 0};
+    const char *c = versionStr;
+    //note an empty string is a 0.0.0 version, same as version_createVersionFromString
+    for (int i = 0; i < 3 && *c != '\0'; ++i) {
+        if (!celix_version_parseKeyComponent(&c, max[i], &parts[i])) {
+            return false;
+        }
+        if (*c == '.') {
+            ++c;
+        } else if (*c != '\0') {
+            return false;
+        }
+    }
+    //remaining is the qualifier
+    for (; *c != '\0'; ++c) {
+        bool valid = (*c >= 'A' && *c <= 'Z') || (*c >= 'a' && *c <= 'z') || (*c >= '0' && *c <= '9') || *c == '_' || *c == '-';
+        if (!valid) {
+            return false;
+        }
+    }
+    *key = CELIX_VERSION_KEY(parts[0], parts[1], parts[2]);
+    return true;
+}
+
+celix_status_t version_getKey(version_pt version, celix_version_key_t *key) {
+    if (version->major < 0 || (unsigned int)version->major > CELIX_VERSION_KEY_MAX_MAJOR ||
+        version->minor < 0 || (unsigned int)version->minor > CELIX_VERSION_KEY_MAX_MINOR ||
+        version->micro < 0 || (unsigned int)version->micro > CELIX_VERSION_KEY_MAX_MICRO) {
+        return CELIX_ILLEGAL_ARGUMENT;
+    }
+    *key = CELIX_VERSION_KEY(version->major, version->minor, version->micro);
+    return CELIX_SUCCESS;
+}
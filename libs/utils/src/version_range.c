@@ -231,3 +231,42 @@ celix_status_t versionRange_parse(const char * rangeStr, version_range_pt *range
     return status;
 }
 
+
+bool celix_versionRange_parseKey(const char *rangeStr, celix_version_range_key_t *range) {
+    if (rangeStr == NULL) {
+        return false;
+    }
+    const char *comma = strchr(rangeStr, ',');
+    if (comma == NULL) {
+        //atleast
+        range->isLowInclusive = true;
+        range->isHighInclusive = false;
+        range->isHighInfinite = true;
+        range->high = 0;
+        return celix_version_parseKey(rangeStr, &range->low);
+    }
+
+    //note the range starts with a bracket, so the comma is not the first and (with the end bracket) not the last char
+    size_t len = strlen(rangeStr);
+    char start = rangeStr[0];
+    char end = rangeStr[len - 1];
+    if ((start != '[' && start != '(') || (end != ']' && end != ')')) {
+        return false;
+    }
+    char low[128];
+    char high[128];
+    size_t lowLen = (size_t)(comma - rangeStr) - 1;
+    size_t highLen = len - (size_t)(comma - rangeStr) - 2;
+    if (lowLen >= sizeof(low) || highLen >= sizeof(high)) {
+        return false;
+    }
+    memcpy(low, rangeStr + 1, lowLen);
+    low[lowLen] = '\0';
+    memcpy(high, comma + 1, highLen);
+    high[highLen] = '\0';
+
+    range->isLowInclusive = start == '[';
+    range->isHighInclusive = end == ']';
+    range->isHighInfinite = false;
+    return celix_version_parseKey(low, &range->low) && celix_version_parseKey(high, &range->high);
+}
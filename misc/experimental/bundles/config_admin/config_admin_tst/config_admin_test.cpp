@@ -287,6 +287,40 @@ tst2_service_pt test2Serv = NULL;
 			printf("end: %s\n", __func__);
 		 }
 
+	    static void testBulkUpdate(void) {
+			printf("begin: %s\n", __func__);
+			const char *pid = "base.device1";
+			const char *prop1 = "type";
+			char value[80];
+			properties_pt properties;
+			/* ------------------ get Configuration -------------------*/
+
+			configuration_pt configuration;
+			(*confAdminServ->getConfiguration)(confAdminServ->configAdmin, (char *)pid, &configuration);
+
+			/* ------------------ bulk update Configuration ----------------*/
+			CHECK_EQUAL(CELIX_SUCCESS, confAdminServ->beginBulkUpdate(confAdminServ->configAdmin));
+			properties = properties_create();
+			properties_set(properties, (char *)prop1, (char *)"printer");
+			// configuration_update transfers ownership of properties structure to the configuration object
+			configuration->configuration_update(configuration->handle , properties);
+			properties = properties_create();
+			properties_set(properties, (char *)prop1, (char *)"scanner");
+			configuration->configuration_update(configuration->handle , properties);
+
+			sleep(1);
+			/* not delivered before the commit */
+			testServ->get_type(testServ->handle, value);
+			CHECK_TEXT("default_value", value);
+
+			CHECK_EQUAL(CELIX_SUCCESS, confAdminServ->commitBulkUpdate(confAdminServ->configAdmin));
+			sleep(1);
+			/* only the latest configuration is delivered */
+			testServ->get_type(testServ->handle, value);
+			CHECK_TEXT("scanner", value);
+			printf("end: %s\n", __func__);
+		 }
+
 	    static void testManagedServiceRemoved(void) {
 			printf("begin: %s\n", __func__);
 			const char *pid = "base.device1";
@@ -400,6 +434,10 @@ TEST(managed_service, test_managed_service) {
     testManagedService();
 }
 
+TEST(managed_service, test_bulk_update) {
+    testBulkUpdate();
+}
+
 TEST(managed_service, test_bundles) {
     testBundles();
 }
@@ -59,6 +59,9 @@ celix_status_t configurationAdminFactory_dispatchEvent(configuration_admin_facto
 celix_status_t configurationAdminFactory_notifyConfigurationUpdated(configuration_admin_factory_pt factory, configuration_pt configuration, bool isFactory);
 celix_status_t configurationAdminFactory_notifyConfigurationDeleted(configuration_admin_factory_pt factory, configuration_pt configuration, bool isFactory);
 
+celix_status_t configurationAdminFactory_beginBulkUpdate(configuration_admin_factory_pt factory);
+celix_status_t configurationAdminFactory_commitBulkUpdate(configuration_admin_factory_pt factory);
+
 celix_status_t configurationAdminFactory_modifyConfiguration(configuration_admin_factory_pt factory, service_reference_pt reference, properties_pt properties);
 
 #endif /* CONFIGURATION_ADMIN_FACTORY_H_ */
@@ -63,6 +63,9 @@ celix_status_t configurationAdmin_getConfiguration2(configuration_admin_pt confi
 
 celix_status_t configurationAdmin_listConfigurations(configuration_admin_pt configAdmin, char *filter, array_list_pt *configurations);
 
+celix_status_t configurationAdmin_beginBulkUpdate(configuration_admin_pt configAdmin);
+celix_status_t configurationAdmin_commitBulkUpdate(configuration_admin_pt configAdmin);
+
 
 #endif /* CONFIGURATION_ADMIN_IMP_H_ */
 
@@ -48,6 +48,13 @@ celix_status_t configurationStore_destroy(configuration_store_pt store);
 celix_status_t configurationStore_lock(configuration_store_pt store);
 celix_status_t configurationStore_unlock(configuration_store_pt store);
 
+/*
+ * Batches group saves and removes; they are written to the store with a single write on the (outermost) commit.
+ * Saving a configuration multiple times within a batch only stores its latest properties.
+ */
+celix_status_t configurationStore_beginBatch(configuration_store_pt store);
+celix_status_t configurationStore_commitBatch(configuration_store_pt store);
+
 celix_status_t configurationStore_saveConfiguration(configuration_store_pt store, char *pid, configuration_pt configuration);
 celix_status_t configurationStore_removeConfiguration(configuration_store_pt store, char *pid);
 
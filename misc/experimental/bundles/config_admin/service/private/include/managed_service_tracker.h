@@ -50,6 +50,8 @@ celix_status_t managedServiceTracker_destroy(bundle_context_pt context, managed_
 
 celix_status_t managedServiceTracker_notifyDeleted(managed_service_tracker_pt tracker, configuration_pt configuration);
 celix_status_t managedServiceTracker_notifyUpdated(managed_service_tracker_pt tracker, configuration_pt configuration);
+celix_status_t managedServiceTracker_holdUpdates(managed_service_tracker_pt tracker);
+celix_status_t managedServiceTracker_releaseUpdates(managed_service_tracker_pt tracker);
 
 celix_status_t managedServiceTracker_addingService(void * handle, service_reference_pt reference, void **service);
 celix_status_t managedServiceTracker_addedService(void * handle, service_reference_pt reference, void * service);
@@ -42,7 +42,16 @@ typedef struct updated_thread_pool *updated_thread_pool_pt;
 
 celix_status_t updatedThreadPool_create( bundle_context_pt context, int maxTreads, updated_thread_pool_pt *updatedThreadPool);
 celix_status_t updatedThreadPool_destroy(updated_thread_pool_pt pool);
+/*
+ * Schedules an updated callback. Updates for a managed service are delivered in order and never concurrently;
+ * pushing while an update for the same service is still pending replaces it, so only the latest properties are delivered.
+ */
 celix_status_t updatedThreadPool_push(updated_thread_pool_pt updatedThreadPool, managed_service_service_pt service, properties_pt properties);
+/* Drops the pending update of a managed service, e.g. because the service is removed. */
+celix_status_t updatedThreadPool_remove(updated_thread_pool_pt updatedThreadPool, managed_service_service_pt service);
+/* While held (holds nest), pushed updates are only coalesced. The last release delivers them, once per managed service. */
+celix_status_t updatedThreadPool_hold(updated_thread_pool_pt updatedThreadPool);
+celix_status_t updatedThreadPool_release(updated_thread_pool_pt updatedThreadPool);
 
 
 #endif /* UPDATED_THREAD_POOL_H_ */
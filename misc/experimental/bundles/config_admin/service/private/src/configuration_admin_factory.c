@@ -180,6 +180,24 @@ celix_status_t configurationAdminFactory_stop(configuration_admin_factory_pt fac
 	return status;;
 }
 
+celix_status_t configurationAdminFactory_beginBulkUpdate(configuration_admin_factory_pt factory){
+
+	celix_status_t status = configurationStore_beginBatch(factory->configurationStore);
+	status = CELIX_DO_IF(status, managedServiceTracker_holdUpdates(factory->managedServiceTrackerHandle));
+	return status;
+}
+
+celix_status_t configurationAdminFactory_commitBulkUpdate(configuration_admin_factory_pt factory){
+
+	// (1) store first, so the managed services are only updated with persisted configurations
+	celix_status_t status = configurationStore_commitBatch(factory->configurationStore);
+
+	// (2) release the coalesced updates, also if storing failed (the configurations are updated in memory)
+	celix_status_t releaseStatus = managedServiceTracker_releaseUpdates(factory->managedServiceTrackerHandle);
+
+	return status != CELIX_SUCCESS ? status : releaseStatus;
+}
+
 celix_status_t configurationAdminFactory_checkConfigurationPermission(configuration_admin_factory_pt factory){
 	return CELIX_SUCCESS;
 }
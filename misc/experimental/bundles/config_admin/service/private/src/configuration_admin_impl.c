@@ -73,6 +73,8 @@ celix_status_t configurationAdmin_create(configuration_admin_factory_pt factory,
 	(*service)->getConfiguration = configurationAdmin_getConfiguration;
 	(*service)->getConfiguration2 = configurationAdmin_getConfiguration2;
 	(*service)->listConfigurations = configurationAdmin_listConfigurations;
+	(*service)->beginBulkUpdate = configurationAdmin_beginBulkUpdate;
+	(*service)->commitBulkUpdate = configurationAdmin_commitBulkUpdate;
 
 	return CELIX_SUCCESS;
 
@@ -195,6 +197,14 @@ celix_status_t configurationAdmin_listConfigurations(configuration_admin_pt conf
 	return CELIX_SUCCESS;
 }
 
+celix_status_t configurationAdmin_beginBulkUpdate(configuration_admin_pt configAdmin){
+	return configurationAdminFactory_beginBulkUpdate(configAdmin->configurationAdminFactory);
+}
+
+celix_status_t configurationAdmin_commitBulkUpdate(configuration_admin_pt configAdmin){
+	return configurationAdminFactory_commitBulkUpdate(configAdmin->configurationAdminFactory);
+}
+
 /* ---------- private ---------- */
 
 celix_status_t configurationAdmin_checkPid(char *pid){
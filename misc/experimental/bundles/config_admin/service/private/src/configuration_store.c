@@ -24,10 +24,12 @@
  *  \copyright	Apache License, Version 2.0
  */
 
+
 #include <stdbool.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <errno.h>
 #include <sys/types.h>
 #include <sys/stat.h>
 #include <fcntl.h>
@@ -43,6 +45,7 @@
 /* celix.framework */
 #include "properties.h"
 #include "utils.h"
+#include "celix_constants.h"
 /* celix.config_admin.private*/
 #include "configuration_admin_factory.h"
 #include "configuration.h"
@@ -50,7 +53,19 @@
 
 #define STORE_DIR "store"
 #define PID_EXT ".pid"
-#define MAX_CONFIG_PROPERTY_LEN		128
+#define STORE_LOG STORE_DIR "/configurations.log"
+#define STORE_LOG_TMP STORE_DIR "/configurations.log~" //note '~' files are skipped when reading legacy pid files
+
+/*
+ * All configurations are stored in a single append-only log (STORE_LOG). Every record is a header line
+ * "<type> <payload length> <pid>\n" followed by the payload:
+ *  - 'U': the payload contains the configuration properties as "key=value\n" lines.
+ *  - 'D': the configuration is removed, no payload.
+ * The last record of a pid wins. A record truncated by a crash is ignored. The log is compacted (rewritten with
+ * only the live configurations) at startup, which also migrates configurations from the older one-file-per-PID layout.
+ */
+#define RECORD_UPDATE 'U'
+#define RECORD_DELETE 'D'
 
 
 struct configuration_store {
@@ -64,12 +79,23 @@ struct configuration_store {
     hash_map_pt configurations;
 // int createdPidCount;
 
+    celix_thread_mutex_t logMutex; //protects logFd, batchCount and dirtyPids
+    int logFd;
+    int batchCount; //nr of open batches, while > 0 saves and removes are only marked dirty
+    hash_map_pt dirtyPids; //key = pid (owned), value = configuration_pt or NULL for a removed configuration
+
 };
 
 static celix_status_t configurationStore_createCache(configuration_store_pt store);
-static celix_status_t configurationStore_getConfigurationFile(char *pid, char* storePath, int *file);
-static celix_status_t configurationStore_writeConfigurationFile(int fd, properties_pt properties);
-static celix_status_t configurationStore_readCache(configuration_store_pt store);
+static celix_status_t configurationStore_writeRecord(FILE *stream, char type, const char *pid, properties_pt properties);
+static celix_status_t configurationStore_writeConfigurationRecord(FILE *stream, const char *pid, configuration_pt configuration);
+static celix_status_t configurationStore_appendLog(configuration_store_pt store, const char *data, size_t size);
+static celix_status_t configurationStore_readCache(configuration_store_pt store, bool *needsCompaction);
+static celix_status_t configurationStore_readLegacyFiles(hash_map_pt loaded, int *nrOfFiles);
+static celix_status_t configurationStore_replayLog(hash_map_pt loaded, bool *needsCompaction);
+static celix_status_t configurationStore_openLog(configuration_store_pt store, bool compact);
+static celix_status_t configurationStore_compactLog(configuration_store_pt store);
+static void configurationStore_removeLegacyFiles(void);
 static celix_status_t configurationStore_readConfigurationFile(const char *name, int size, properties_pt *dictionary);
 static celix_status_t configurationStore_parseDataConfigurationFile(char *data, properties_pt *dictionary);
 
@@ -90,6 +116,8 @@ celix_status_t configurationStore_create(bundle_context_pt context, configuratio
 
     (*store)->configurations = hashMap_create(utils_stringHash, NULL, utils_stringEquals, NULL);
 //	(*store)->createdPidCount = 0;
+    (*store)->dirtyPids = hashMap_create(utils_stringHash, NULL, utils_stringEquals, NULL);
+    (*store)->logFd = -1;
 
     if (configurationStore_createCache((*store)) != CELIX_SUCCESS) {
         printf("[ ERROR ]: ConfigStore - Not initialized (CACHE) \n");
@@ -97,17 +125,32 @@ celix_status_t configurationStore_create(bundle_context_pt context, configuratio
     }
 
     celix_status_t mutexStatus = celixThreadMutex_create(&(*store)->mutex, NULL);
+    mutexStatus = CELIX_DO_IF(mutexStatus, celixThreadMutex_create(&(*store)->logMutex, NULL));
     if (mutexStatus != CELIX_SUCCESS) {
         printf("[ ERROR ]: ConfigStore - Not initialized (MUTEX) \n");
         return CELIX_ILLEGAL_ARGUMENT;
     }
 
-    configurationStore_readCache((*store));
+    bool needsCompaction = false;
+    configurationStore_readCache((*store), &needsCompaction);
+
+    if (configurationStore_openLog((*store), needsCompaction) != CELIX_SUCCESS) {
+        printf("[ ERROR ]: ConfigStore - Not initialized (LOG) \n");
+        return CELIX_FILE_IO_EXCEPTION;
+    }
 
     return CELIX_SUCCESS;
 }
 
 celix_status_t configurationStore_destroy(configuration_store_pt store) {
+    if (store->batchCount > 0) {
+        printf("[ WARNING ]: ConfigStore - destroyed with an open batch, %i configuration(s) not stored \n", hashMap_size(store->dirtyPids));
+    }
+    if (store->logFd >= 0) {
+        close(store->logFd);
+    }
+    hashMap_destroy(store->dirtyPids, true, false);
+    celixThreadMutex_destroy(&store->logMutex);
     celixThreadMutex_destroy(&store->mutex);
     hashMap_destroy(store->configurations, false, true);
     free(store);
@@ -129,41 +172,126 @@ celix_status_t configurationStore_unlock(configuration_store_pt store) {
     return CELIX_SUCCESS;
 }
 
-celix_status_t configurationStore_saveConfiguration(configuration_store_pt store, char *pid, configuration_pt configuration) {
+celix_status_t configurationStore_beginBatch(configuration_store_pt store) {
+    celixThreadMutex_lock(&store->logMutex);
+    store->batchCount += 1;
+    celixThreadMutex_unlock(&store->logMutex);
+    return CELIX_SUCCESS;
+}
 
-    celix_status_t status;
+celix_status_t configurationStore_commitBatch(configuration_store_pt store) {
 
-    //(1) config.checkLocked
+    celix_status_t status = CELIX_SUCCESS;
 
-    //(2) configurationStore.getFile
-    int configFile;
-    status = configurationStore_getConfigurationFile(pid, (char *) STORE_DIR, &configFile);
-    if (status != CELIX_SUCCESS) {
-        return status;
+    celixThreadMutex_lock(&store->logMutex);
+
+    if (store->batchCount == 0) {
+        celixThreadMutex_unlock(&store->logMutex);
+        return CELIX_ILLEGAL_STATE;
+    } else if (store->batchCount > 1) {
+        store->batchCount -= 1;
+        celixThreadMutex_unlock(&store->logMutex);
+        return CELIX_SUCCESS;
     }
 
-    //(4) configProperties = config.getAllProperties
+    // The batch stays open while flushing, so saves done in the meantime are marked dirty and picked up by the next
+    // round. The log mutex is not held while reading the configurations, a save locks the configuration first.
+    while (hashMap_size(store->dirtyPids) > 0) {
+        hash_map_pt dirty = store->dirtyPids;
+        store->dirtyPids = hashMap_create(utils_stringHash, NULL, utils_stringEquals, NULL);
+        celixThreadMutex_unlock(&store->logMutex);
+
+        char *data = NULL;
+        size_t size = 0;
+        FILE *stream = open_memstream(&data, &size);
+        hash_map_iterator_t iter = hashMapIterator_construct(dirty);
+        while (hashMapIterator_hasNext(&iter)) {
+            hash_map_entry_pt entry = hashMapIterator_nextEntry(&iter);
+            const char *pid = hashMapEntry_getKey(entry);
+            configuration_pt configuration = hashMapEntry_getValue(entry);
+            celix_status_t sub;
+            if (configuration != NULL) {
+                sub = configurationStore_writeConfigurationRecord(stream, pid, configuration);
+            } else {
+                sub = configurationStore_writeRecord(stream, RECORD_DELETE, pid, NULL);
+            }
+            status = CELIX_DO_IF(status, sub);
+        }
+        fclose(stream);
+        hashMap_destroy(dirty, true, false);
 
-    properties_pt configProperties = NULL;
-    status = configuration_getAllProperties(configuration->handle, &configProperties);
-    if (status != CELIX_SUCCESS) {
-        printf("[ ERROR ]: ConfigStore - config{PID=%s}.getAllProperties \n", pid);
-        return status;
+        celixThreadMutex_lock(&store->logMutex);
+        // (one write for the complete batch)
+        status = CELIX_DO_IF(status, configurationStore_appendLog(store, data, size));
+        free(data);
     }
 
+    store->batchCount -= 1;
+    celixThreadMutex_unlock(&store->logMutex);
 
-    //(5) configStore.writeFile(file,properties)
-    status = configurationStore_writeConfigurationFile(configFile, configProperties);
+    return status;
+}
 
-    if (status != CELIX_SUCCESS) {
-        return status;
+celix_status_t configurationStore_saveConfiguration(configuration_store_pt store, char *pid, configuration_pt configuration) {
+
+    celix_status_t status;
+
+    //(1) config.checkLocked
+
+    //(2) batch open? only remember the pid, the latest properties are written on commit
+    celixThreadMutex_lock(&store->logMutex);
+    if (store->batchCount > 0) {
+        if (hashMap_containsKey(store->dirtyPids, pid)) {
+            hashMap_put(store->dirtyPids, pid, configuration);
+        } else {
+            hashMap_put(store->dirtyPids, strdup(pid), configuration);
+        }
+        celixThreadMutex_unlock(&store->logMutex);
+        return CELIX_SUCCESS;
+    }
+    celixThreadMutex_unlock(&store->logMutex);
+
+    //(3) configProperties = config.getAllProperties -> record
+    char *data = NULL;
+    size_t size = 0;
+    FILE *stream = open_memstream(&data, &size);
+    status = configurationStore_writeConfigurationRecord(stream, pid, configuration);
+    fclose(stream);
+
+    //(4) log.append(record)
+    if (status == CELIX_SUCCESS) {
+        celixThreadMutex_lock(&store->logMutex);
+        status = configurationStore_appendLog(store, data, size);
+        celixThreadMutex_unlock(&store->logMutex);
     }
 
-    return CELIX_SUCCESS;
+    free(data);
+    return status;
 }
 
 celix_status_t configurationStore_removeConfiguration(configuration_store_pt store, char *pid) {
-    return CELIX_SUCCESS;
+
+    celix_status_t status = CELIX_SUCCESS;
+
+    celixThreadMutex_lock(&store->logMutex);
+    if (store->batchCount > 0) {
+        if (hashMap_containsKey(store->dirtyPids, pid)) {
+            hashMap_put(store->dirtyPids, pid, NULL);
+        } else {
+            hashMap_put(store->dirtyPids, strdup(pid), NULL);
+        }
+    } else {
+        char *data = NULL;
+        size_t size = 0;
+        FILE *stream = open_memstream(&data, &size);
+        status = configurationStore_writeRecord(stream, RECORD_DELETE, pid, NULL);
+        fclose(stream);
+        status = CELIX_DO_IF(status, configurationStore_appendLog(store, data, size));
+        free(data);
+    }
+    celixThreadMutex_unlock(&store->logMutex);
+
+    return status;
 }
 
 celix_status_t configurationStore_getConfiguration(configuration_store_pt store, char *pid, char *location, configuration_pt *configuration) {
@@ -212,7 +340,6 @@ celix_status_t configurationStore_unbindConfigurations(configuration_store_pt st
 }
 
 /* ---------- private ---------- */
-
 celix_status_t configurationStore_createCache(configuration_store_pt store) {
 
     int result = mkdir((const char*) STORE_DIR, 0777);
@@ -226,64 +353,113 @@ celix_status_t configurationStore_createCache(configuration_store_pt store) {
 
 }
 
-celix_status_t configurationStore_getConfigurationFile(char *pid, char* storePath, int *file) {
+celix_status_t configurationStore_writeRecord(FILE *stream, char type, const char *pid, properties_pt properties) {
 
-    // (1) The full path to the file
-    char fname[PATH_MAX];
-    strcpy(fname, storePath);
-    strcat(fname, "/");
-    strcat(fname, (const char *) pid);
-    strcat(fname, (const char *) PID_EXT);
+    char *payload = NULL;
+    size_t payloadSize = 0;
 
-    // (2) configuration.getPool
-    // (3) file.open
-    if ((*file = open((const char*) fname, O_CREAT | O_RDWR, S_IRUSR | S_IWUSR)) < 0) {
-        printf("[ ERROR ]: ConfigStore - getFile(IO_EXCEPTION) \n");
-        return CELIX_FILE_IO_EXCEPTION;
+    if (properties != NULL && hashMap_size(properties) > 0) {
+        FILE *payloadStream = open_memstream(&payload, &payloadSize);
+        hash_map_iterator_t iter = hashMapIterator_construct(properties);
+        while (hashMapIterator_hasNext(&iter)) {
+            hash_map_entry_pt entry = hashMapIterator_nextEntry(&iter);
+            fprintf(payloadStream, "%s=%s\n", (char*) hashMapEntry_getKey(entry), (char*) hashMapEntry_getValue(entry));
+        }
+        fclose(payloadStream);
     }
-    return CELIX_SUCCESS;
-}
 
-celix_status_t configurationStore_writeConfigurationFile(int file, properties_pt properties) {
-
-    if (properties == NULL || hashMap_size(properties) <= 0) {
-        return CELIX_SUCCESS;
+    fprintf(stream, "%c %zu %s\n", type, payloadSize, pid);
+    if (payloadSize > 0) {
+        fwrite(payload, 1, payloadSize, stream);
     }
-    // size >0
+    free(payload);
 
-    char buffer[256];
+    return CELIX_SUCCESS;
+}
 
-    hash_map_iterator_pt iterator = hashMapIterator_create(properties);
-    while (hashMapIterator_hasNext(iterator)) {
+celix_status_t configurationStore_writeConfigurationRecord(FILE *stream, const char *pid, configuration_pt configuration) {
 
-        hash_map_entry_pt entry = hashMapIterator_nextEntry(iterator);
+    properties_pt configProperties = NULL;
+    celix_status_t status = configuration_getAllProperties(configuration->handle, &configProperties);
+    if (status != CELIX_SUCCESS) {
+        printf("[ ERROR ]: ConfigStore - config{PID=%s}.getAllProperties \n", pid);
+        return status;
+    }
 
-        char* key = hashMapEntry_getKey(entry);
-        char* val = hashMapEntry_getValue(entry);
+    if (configProperties == NULL) { //deleted
+        return configurationStore_writeRecord(stream, RECORD_DELETE, pid, NULL);
+    }
+    return configurationStore_writeRecord(stream, RECORD_UPDATE, pid, configProperties);
+}
 
-        snprintf(buffer, 256, "%s=%s\n", key, val);
+celix_status_t configurationStore_appendLog(configuration_store_pt store, const char *data, size_t size) {
 
-        int buffLength = strlen((const char *) buffer);
+    //note called with the logMutex locked
+    if (store->logFd < 0) {
+        return CELIX_ILLEGAL_STATE;
+    }
 
-    	if (write(file, (const void *) buffer, buffLength) != buffLength) {
+    size_t written = 0;
+    while (written < size) {
+        ssize_t n = write(store->logFd, data + written, size - written);
+        if (n < 0 && errno == EINTR) {
+            continue;
+        } else if (n <= 0) {
             printf("[ ERROR ]: ConfigStore - writing in Cache incomplete \n");
             return CELIX_FILE_IO_EXCEPTION;
         }
+        written += (size_t) n;
     }
-    hashMapIterator_destroy(iterator);
-    return CELIX_SUCCESS;
 
+    return CELIX_SUCCESS;
 }
 
-celix_status_t configurationStore_readCache(configuration_store_pt store) {
+celix_status_t configurationStore_readCache(configuration_store_pt store, bool *needsCompaction) {
 
     celix_status_t status;
 
+    // pid (owned) -> properties_pt, later configurations override earlier ones
+    hash_map_pt loaded = hashMap_create(utils_stringHash, NULL, utils_stringEquals, NULL);
+    int nrOfLegacyFiles = 0;
+
+    // (1) legacy one-file-per-PID store
+    status = configurationStore_readLegacyFiles(loaded, &nrOfLegacyFiles);
+
+    // (2) log replay
+    status = CELIX_DO_IF(status, configurationStore_replayLog(loaded, needsCompaction));
+    *needsCompaction = *needsCompaction || nrOfLegacyFiles > 0;
+
+    // (3) new configurations
+    hash_map_iterator_t iter = hashMapIterator_construct(loaded);
+    while (hashMapIterator_hasNext(&iter)) {
+        hash_map_entry_pt entry = hashMapIterator_nextEntry(&iter);
+        properties_pt properties = hashMapEntry_getValue(entry);
+        configuration_pt configuration = NULL;
+        char *pid = NULL;
+
+        if (status == CELIX_SUCCESS) {
+            status = configuration_create2(store->configurationAdminFactory, store, properties, &configuration);
+        }
+        if (status == CELIX_SUCCESS) {
+            // (3.1) configurations.put
+            configuration_getPid(configuration->handle, &pid);
+            hashMap_put(store->configurations, pid, configuration);
+        } else {
+            properties_destroy(properties);
+        }
+    }
+    hashMap_destroy(loaded, true, false);
+
+    return status;
+}
+
+celix_status_t configurationStore_readLegacyFiles(hash_map_pt loaded, int *nrOfFiles) {
+
+    celix_status_t status = CELIX_SUCCESS;
+
     DIR *cache;	// directory handle
 
-    properties_pt properties = NULL;
-    configuration_pt configuration = NULL;
-    char *pid;
+    *nrOfFiles = 0;
 
     // (1) cache.open
     cache = opendir((const char*) STORE_DIR);
@@ -294,47 +470,208 @@ celix_status_t configurationStore_readCache(configuration_store_pt store) {
 
     // (2) directory.read
     struct dirent *dp;
-    int res;
     struct stat st;
-    union {
-        struct dirent d;
-        char b[offsetof (struct dirent, d_name) + NAME_MAX + 1];
-    } u;
-    res = readdir_r(cache, (struct dirent*) &u, &dp);
-    while ((res == 0) && (dp != NULL)) {
-
-        if ((strcmp((dp->d_name), ".") != 0) && (strcmp((dp->d_name), "..") != 0) && (strpbrk(dp->d_name, "~") == NULL)) {
-	    char storeRoot[512];
-            snprintf(storeRoot, sizeof(storeRoot), "%s/%s", STORE_DIR, dp->d_name);
-            // (2.1) file.readData
-            if (stat(storeRoot, &st) == 0) {
-                status = configurationStore_readConfigurationFile(dp->d_name, st.st_size, &properties);
-                if (status != CELIX_SUCCESS) {
-                    closedir(cache);
-                    return status;
-                }
-            }
-            else
-                perror("stat");
-            // (2.2) new configuration
-            status = configuration_create2(store->configurationAdminFactory, store, properties, &configuration);
-            if (status != CELIX_SUCCESS) {
-                closedir(cache);
-                return status;
-            }
+    while ((dp = readdir(cache)) != NULL) {
+        size_t len = strlen(dp->d_name);
+        if (len <= strlen(PID_EXT) || strcmp(dp->d_name + len - strlen(PID_EXT), PID_EXT) != 0 || strpbrk(dp->d_name, "~") != NULL) {
+            continue;
+        }
 
-            // (2.3) configurations.put
-            configuration_getPid(configuration->handle, &pid);
-            hashMap_put(store->configurations, pid, configuration);
+        char storeRoot[512];
+        snprintf(storeRoot, sizeof(storeRoot), "%s/%s", STORE_DIR, dp->d_name);
+        if (stat(storeRoot, &st) != 0) {
+            perror("stat");
+            continue;
+        }
+
+        // (2.1) file.readData
+        properties_pt properties = NULL;
+        if (configurationStore_readConfigurationFile(dp->d_name, st.st_size, &properties) != CELIX_SUCCESS) {
+            properties = NULL;
+        }
+        const char *pid = properties != NULL ? properties_get(properties, (char *) OSGI_FRAMEWORK_SERVICE_PID) : NULL;
+        if (pid != NULL && !hashMap_containsKey(loaded, pid)) {
+            hashMap_put(loaded, strdup(pid), properties);
+            *nrOfFiles += 1;
+        } else if (properties != NULL) {
+            properties_destroy(properties);
         }
-        res = readdir_r(cache, (struct dirent*) &u, &dp);
     }
 
     closedir(cache);
 
+    return status;
+}
+
+celix_status_t configurationStore_replayLog(hash_map_pt loaded, bool *needsCompaction) {
+
+    celix_status_t status = CELIX_SUCCESS;
+    struct stat st;
+
+    *needsCompaction = false;
+
+    int fd = open(STORE_LOG, O_RDONLY);
+    if (fd < 0) {
+        return errno == ENOENT ? CELIX_SUCCESS : CELIX_FILE_IO_EXCEPTION;
+    }
+    if (fstat(fd, &st) != 0) {
+        close(fd);
+        return CELIX_FILE_IO_EXCEPTION;
+    }
+
+    size_t size = (size_t) st.st_size;
+    char *buffer = malloc(size + 1);
+    size_t nread = 0;
+    while (buffer != NULL && nread < size) {
+        ssize_t n = read(fd, buffer + nread, size - nread);
+        if (n <= 0) {
+            break;
+        }
+        nread += (size_t) n;
+    }
+    close(fd);
+    if (buffer == NULL) {
+        return CELIX_ENOMEM;
+    }
+    buffer[nread] = '\0';
+
+    int nrOfRecords = 0;
+    size_t offset = 0;
+    while (offset < nread) {
+        // (1) header "<type> <payload length> <pid>\n"
+        char *header = buffer + offset;
+        char *eol = memchr(header, '\n', nread - offset);
+        char type;
+        size_t payloadSize;
+        int pidOffset = 0;
+        if (eol == NULL) {
+            break; //truncated header
+        }
+        *eol = '\0';
+        if (sscanf(header, "%c %zu %n", &type, &payloadSize, &pidOffset) != 2 || pidOffset == 0 || header[pidOffset] == '\0') {
+            break; //corrupt
+        }
+        char *pid = header + pidOffset;
+        char *payload = eol + 1;
+        if (payloadSize > nread - (size_t) (payload - buffer)) {
+            break; //truncated payload
+        }
+
+        // (2) apply, the last record of a pid wins
+        properties_pt properties = NULL;
+        if (type == RECORD_UPDATE) {
+            char *data = strndup(payload, payloadSize);
+            if (data == NULL || configurationStore_parseDataConfigurationFile(data, &properties) != CELIX_SUCCESS) {
+                properties = NULL;
+            }
+            free(data);
+        } else if (type != RECORD_DELETE) {
+            break; //corrupt
+        }
+
+        hash_map_entry_pt entry = hashMap_getEntry(loaded, pid);
+        if (entry != NULL) {
+            char *key = hashMapEntry_getKey(entry);
+            properties_pt old = hashMap_remove(loaded, pid);
+            free(key);
+            if (old != NULL) {
+                properties_destroy(old);
+            }
+        }
+        if (properties != NULL) {
+            hashMap_put(loaded, strdup(pid), properties);
+        }
+
+        nrOfRecords += 1;
+        offset = (size_t) (payload - buffer) + payloadSize;
+    }
+
+    if (offset < nread) {
+        printf("[ WARNING ]: ConfigStore - ignoring %zu bytes of incomplete records in %s \n", nread - offset, STORE_LOG);
+    }
+    *needsCompaction = offset < nread || nrOfRecords > hashMap_size(loaded);
+
+    free(buffer);
+    return status;
+}
+
+celix_status_t configurationStore_openLog(configuration_store_pt store, bool compact) {
+
+    celix_status_t status = compact ? configurationStore_compactLog(store) : CELIX_SUCCESS;
+    if (status != CELIX_SUCCESS) {
+        //note the existing log stays usable
+        printf("[ ERROR ]: ConfigStore - compacting %s failed \n", STORE_LOG);
+    }
+
+    store->logFd = open(STORE_LOG, O_CREAT | O_WRONLY | O_APPEND, S_IRUSR | S_IWUSR);
+    if (store->logFd < 0) {
+        printf("[ ERROR ]: ConfigStore - open %s (IO_EXCEPTION) \n", STORE_LOG);
+        return CELIX_FILE_IO_EXCEPTION;
+    }
+
     return CELIX_SUCCESS;
 }
 
+celix_status_t configurationStore_compactLog(configuration_store_pt store) {
+
+    celix_status_t status = CELIX_SUCCESS;
+
+    // (1) write the live configurations to a temporary log
+    char *data = NULL;
+    size_t size = 0;
+    FILE *stream = open_memstream(&data, &size);
+    hash_map_iterator_t iter = hashMapIterator_construct(store->configurations);
+    while (hashMapIterator_hasNext(&iter)) {
+        hash_map_entry_pt entry = hashMapIterator_nextEntry(&iter);
+        status = CELIX_DO_IF(status, configurationStore_writeConfigurationRecord(stream, hashMapEntry_getKey(entry), hashMapEntry_getValue(entry)));
+    }
+    fclose(stream);
+
+    int fd = -1;
+    if (status == CELIX_SUCCESS) {
+        fd = open(STORE_LOG_TMP, O_CREAT | O_TRUNC | O_WRONLY, S_IRUSR | S_IWUSR);
+        status = fd < 0 ? CELIX_FILE_IO_EXCEPTION : CELIX_SUCCESS;
+    }
+    if (status == CELIX_SUCCESS) {
+        store->logFd = fd;
+        status = configurationStore_appendLog(store, data, size);
+        if (status == CELIX_SUCCESS && fsync(fd) != 0) {
+            status = CELIX_FILE_IO_EXCEPTION;
+        }
+        close(fd);
+        store->logFd = -1;
+    }
+    free(data);
+
+    // (2) atomically replace the log, only then the legacy files can go
+    if (status == CELIX_SUCCESS && rename(STORE_LOG_TMP, STORE_LOG) != 0) {
+        status = CELIX_FILE_IO_EXCEPTION;
+    }
+    if (status == CELIX_SUCCESS) {
+        configurationStore_removeLegacyFiles();
+    } else {
+        unlink(STORE_LOG_TMP);
+    }
+
+    return status;
+}
+
+void configurationStore_removeLegacyFiles(void) {
+    DIR *cache = opendir((const char*) STORE_DIR);
+    struct dirent *dp;
+    while (cache != NULL && (dp = readdir(cache)) != NULL) {
+        size_t len = strlen(dp->d_name);
+        if (len > strlen(PID_EXT) && strcmp(dp->d_name + len - strlen(PID_EXT), PID_EXT) == 0) {
+            char path[512];
+            snprintf(path, sizeof(path), "%s/%s", STORE_DIR, dp->d_name);
+            unlink(path);
+        }
+    }
+    if (cache != NULL) {
+        closedir(cache);
+    }
+}
+
 celix_status_t configurationStore_readConfigurationFile(const char *name, int size, properties_pt *dictionary) {
 
     char fname[256];		// file name
@@ -396,11 +733,11 @@ celix_status_t configurationStore_parseDataConfigurationFile(char *data, propert
     while (token != NULL) {
 
         if (isKey) {
-            key = strdup(token);
+            key = token;
             isKey = false;
 
         } else { // isValue
-            value = strdup(token);
+            value = token;
             properties_set(properties, key, value);
             isKey = true;
         }
@@ -409,6 +746,7 @@ celix_status_t configurationStore_parseDataConfigurationFile(char *data, propert
     }
 
     if (hashMap_isEmpty(properties)) {
+        properties_destroy(properties);
         return CELIX_ILLEGAL_ARGUMENT;
     }
 
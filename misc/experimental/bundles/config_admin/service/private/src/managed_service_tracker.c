@@ -401,6 +401,11 @@ celix_status_t managedServiceTracker_add(managed_service_tracker_pt tracker, ser
 celix_status_t managedServiceTracker_remove(managed_service_tracker_pt tracker, service_reference_pt reference, char * pid){
     configuration_pt configuration = NULL;
     bundle_pt bundle = NULL;
+    managed_service_service_pt service = NULL;
+
+    if (managedServiceTracker_getManagedService(tracker, pid, &service) == CELIX_SUCCESS) {
+        updatedThreadPool_remove(tracker->updatedThreadPool, service);
+    }
 
     configurationStore_findConfiguration(tracker->configurationStore, pid, &configuration);
     if (configuration != NULL) {
@@ -497,6 +502,14 @@ celix_status_t managedServiceTracker_asynchUpdated(managed_service_tracker_pt tr
 
 /* ---------- public ---------- */
 
+celix_status_t managedServiceTracker_holdUpdates(managed_service_tracker_pt tracker) {
+    return updatedThreadPool_hold(tracker->updatedThreadPool);
+}
+
+celix_status_t managedServiceTracker_releaseUpdates(managed_service_tracker_pt tracker) {
+    return updatedThreadPool_release(tracker->updatedThreadPool);
+}
+
 celix_status_t managedServiceTracker_notifyDeleted(managed_service_tracker_pt tracker, configuration_pt configuration) {
     return CELIX_SUCCESS;
 }
@@ -31,6 +31,8 @@
 
 /* celix.config_admin.UpdatedThreadPool */
 #include "thpool.h"
+#include "hash_map.h"
+#include "celix_threads.h"
 #include "updated_thread_pool.h"
 
 
@@ -41,23 +43,35 @@ struct updated_thread_pool{
 
 	int maxTreads;
 
-	//	apr_thread_mutex_t *mutex;
-	threadpool threadPool;	//protected by mutex
+	celix_thread_mutex_t mutex;
+	threadpool threadPool;
+
+	hash_map_pt pendingUpdates; //key = managed_service_service_pt, value = data_callback_t, protected by mutex
+	int holdCount; //nr of active holds, while > 0 updates are only coalesced. protected by mutex
 
 };
 
 typedef struct data_callback *data_callback_t;
 
+/*
+ * Pending update for a single managed service. Pushing a new update while one is still pending only replaces the
+ * properties, so a managed service is called once with its latest configuration and never concurrently.
+ */
 struct data_callback{
 
+	updated_thread_pool_pt updatedThreadPool;
 	managed_service_service_pt managedServiceService;
 	properties_pt properties;
+	bool hasUpdate; //properties not yet delivered
+	bool scheduled; //a job for this entry is queued or running
+	bool removed; //managed service is gone, drop the entry when the job is done
 
 };
 
 
 static void *updateThreadPool_updatedCallback(void *data);
-static celix_status_t updatedThreadPool_wrapDataCallback(managed_service_service_pt service, properties_pt properties, data_callback_t *data);
+static celix_status_t updatedThreadPool_wrapDataCallback(updated_thread_pool_pt updatedThreadPool, managed_service_service_pt service, data_callback_t *data);
+static celix_status_t updatedThreadPool_schedule(updated_thread_pool_pt updatedThreadPool, data_callback_t data);
 
 
 /* ========== CONSTRUCTOR ========== */
@@ -80,6 +94,9 @@ celix_status_t updatedThreadPool_create(bundle_context_pt context, int maxThread
 	}
 
 	(*updatedThreadPool)->context = context;
+	(*updatedThreadPool)->maxTreads = maxThreads;
+	(*updatedThreadPool)->pendingUpdates = hashMap_create(NULL, NULL, NULL, NULL);
+	celixThreadMutex_create(&(*updatedThreadPool)->mutex, NULL);
 
 	printf("[ SUCCESS ]: UpdatedThreadPool - initialized \n");
 	return CELIX_SUCCESS;
@@ -88,6 +105,10 @@ celix_status_t updatedThreadPool_create(bundle_context_pt context, int maxThread
 
 celix_status_t updatedThreadPool_destroy(updated_thread_pool_pt pool) {
 	thpool_destroy(pool->threadPool);
+
+	//note thpool_destroy drops queued jobs, so entries can still be in the map
+	hashMap_destroy(pool->pendingUpdates, false, true);
+	celixThreadMutex_destroy(&pool->mutex);
 	free(pool);
 	return CELIX_SUCCESS;
 }
@@ -97,38 +118,134 @@ celix_status_t updatedThreadPool_destroy(updated_thread_pool_pt pool) {
 
 celix_status_t updatedThreadPool_push(updated_thread_pool_pt updatedThreadPool, managed_service_service_pt service, properties_pt properties){
 
-	data_callback_t data = NULL;
+	celix_status_t status = CELIX_SUCCESS;
+
+	celixThreadMutex_lock(&updatedThreadPool->mutex);
+
+	data_callback_t data = hashMap_get(updatedThreadPool->pendingUpdates, service);
+	if (data == NULL) {
+		status = updatedThreadPool_wrapDataCallback(updatedThreadPool, service, &data);
+		if (status == CELIX_SUCCESS) {
+			hashMap_put(updatedThreadPool->pendingUpdates, service, data);
+		}
+	}
+
+	if (status == CELIX_SUCCESS) {
+		// (1) coalesce, an update not yet delivered is replaced by the latest properties
+		data->properties = properties;
+		data->hasUpdate = true;
+
+		// (2) only schedule if no job is queued or running for this service and no bulk update is in progress
+		if (!data->scheduled && updatedThreadPool->holdCount == 0) {
+			status = updatedThreadPool_schedule(updatedThreadPool, data);
+		}
+	}
+
+	celixThreadMutex_unlock(&updatedThreadPool->mutex);
+
+	return status;
+}
+
+celix_status_t updatedThreadPool_remove(updated_thread_pool_pt updatedThreadPool, managed_service_service_pt service){
+
+	celixThreadMutex_lock(&updatedThreadPool->mutex);
 
-	if ( updatedThreadPool_wrapDataCallback(service, properties, &data) != CELIX_SUCCESS ){
-		return CELIX_ILLEGAL_ARGUMENT;
+	data_callback_t data = hashMap_get(updatedThreadPool->pendingUpdates, service);
+	if (data != NULL) {
+		hashMap_remove(updatedThreadPool->pendingUpdates, service);
+		data->hasUpdate = false;
+		if (data->scheduled) {
+			data->removed = true; //freed by the job
+		} else {
+			free(data);
+		}
 	}
 
+	celixThreadMutex_unlock(&updatedThreadPool->mutex);
+
+	return CELIX_SUCCESS;
+}
+
+celix_status_t updatedThreadPool_hold(updated_thread_pool_pt updatedThreadPool){
+
+	celixThreadMutex_lock(&updatedThreadPool->mutex);
+	updatedThreadPool->holdCount += 1;
+	celixThreadMutex_unlock(&updatedThreadPool->mutex);
+
+	return CELIX_SUCCESS;
+}
+
+celix_status_t updatedThreadPool_release(updated_thread_pool_pt updatedThreadPool){
+
+	celix_status_t status = CELIX_SUCCESS;
+
+	celixThreadMutex_lock(&updatedThreadPool->mutex);
+
+	if (updatedThreadPool->holdCount == 0) {
+		status = CELIX_ILLEGAL_STATE;
+	} else if (--updatedThreadPool->holdCount == 0) {
+		// deliver everything that was coalesced during the hold, one job per managed service
+		hash_map_iterator_t iter = hashMapIterator_construct(updatedThreadPool->pendingUpdates);
+		while (hashMapIterator_hasNext(&iter)) {
+			data_callback_t data = hashMapIterator_nextValue(&iter);
+			if (data->hasUpdate && !data->scheduled) {
+				celix_status_t sub = updatedThreadPool_schedule(updatedThreadPool, data);
+				status = status == CELIX_SUCCESS ? sub : status;
+			}
+		}
+	}
+
+	celixThreadMutex_unlock(&updatedThreadPool->mutex);
+
+	return status;
+}
+
+/* ---------- private ---------- */
+
+celix_status_t updatedThreadPool_schedule(updated_thread_pool_pt updatedThreadPool, data_callback_t data) {
+
+	//note called with the mutex locked
+	data->scheduled = true;
 	if (thpool_add_work(updatedThreadPool->threadPool, updateThreadPool_updatedCallback, data) != 0) {
 		printf("[ ERROR ]: UpdatedThreadPool - add_work \n ");
+		data->scheduled = false;
 		return CELIX_ILLEGAL_STATE;
 	}
 
 	return CELIX_SUCCESS;
 }
 
-/* ---------- private ---------- */
-
-void *updateThreadPool_updatedCallback(void *data) {
+void *updateThreadPool_updatedCallback(void *handle) {
 
-	data_callback_t params = data;
+	data_callback_t data = handle;
+	updated_thread_pool_pt updatedThreadPool = data->updatedThreadPool;
+	managed_service_service_pt managedServiceService = data->managedServiceService;
 
-	managed_service_service_pt managedServiceService = params->managedServiceService;
-	properties_pt properties = params->properties;
+	celixThreadMutex_lock(&updatedThreadPool->mutex);
+	// keep delivering until no newer update arrived during the callback (or a hold started)
+	while (data->hasUpdate && updatedThreadPool->holdCount == 0) {
+		properties_pt properties = data->properties;
+		data->hasUpdate = false;
+		celixThreadMutex_unlock(&updatedThreadPool->mutex);
 
-	(*managedServiceService->updated)(managedServiceService->managedService, properties);
+		(*managedServiceService->updated)(managedServiceService->managedService, properties);
 
-	free(data);
+		celixThreadMutex_lock(&updatedThreadPool->mutex);
+	}
+	data->scheduled = false;
+	if (data->removed) {
+		free(data);
+	} else if (!data->hasUpdate) {
+		hashMap_remove(updatedThreadPool->pendingUpdates, managedServiceService);
+		free(data);
+	}
+	celixThreadMutex_unlock(&updatedThreadPool->mutex);
 
 	return NULL;
 
 }
 
-celix_status_t updatedThreadPool_wrapDataCallback(managed_service_service_pt service, properties_pt properties, data_callback_t *data){
+celix_status_t updatedThreadPool_wrapDataCallback(updated_thread_pool_pt updatedThreadPool, managed_service_service_pt service, data_callback_t *data){
 
 	*data = calloc(1, sizeof(**data));
 
@@ -137,8 +254,8 @@ celix_status_t updatedThreadPool_wrapDataCallback(managed_service_service_pt ser
 		return CELIX_ENOMEM;
 	}
 
+	(*data)->updatedThreadPool = updatedThreadPool;
 	(*data)->managedServiceService = service;
-	(*data)->properties = properties;
 
 	return CELIX_SUCCESS;
 }
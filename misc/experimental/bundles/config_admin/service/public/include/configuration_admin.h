@@ -57,6 +57,13 @@ struct configuration_admin_service {
 	celix_status_t (*getConfiguration)(configuration_admin_pt configAdmin, char *pid, configuration_pt *configuration);
 	celix_status_t (*getConfiguration2)(configuration_admin_pt configAdmin, char *pid, char *location, configuration_pt *configuration);
 	celix_status_t (*listConfigurations)(configuration_admin_pt configAdmin, char *filter, array_list_pt *configurations);
+
+	/*
+	 * Bulk update: configuration updates done between begin and commit are stored with a single write on commit
+	 * and each managed service is called once, with its latest properties, after the commit. Bulk updates can nest.
+	 */
+	celix_status_t (*beginBulkUpdate)(configuration_admin_pt configAdmin);
+	celix_status_t (*commitBulkUpdate)(configuration_admin_pt configAdmin);
 };
 
 #endif /* CONFIGURATION_ADMIN_H_ */
@@ -42,20 +42,37 @@
 #include "listener_hook_service.h"
 #include "event_admin.h"
 #include "log_helper.h"
+#include "celix_threads.h"
+#include "celix_filter.h"
+
+#define EVENT_ADMIN_NR_OF_WORKERS_NAME              "EVENT_ADMIN_NR_OF_WORKERS"
+#define EVENT_ADMIN_NR_OF_WORKERS_DEFAULT           2
+
+#define EVENT_ADMIN_HANDLER_QUEUE_SIZE_NAME         "EVENT_ADMIN_HANDLER_QUEUE_SIZE"
+#define EVENT_ADMIN_HANDLER_QUEUE_SIZE_DEFAULT      1024
+
+typedef struct event_admin_handler event_admin_handler_t; //tracked event handler incl. its async event queue
+typedef struct event_admin_topic_node event_admin_topic_node_t; //node in the topic tree, one per topic segment
 
 struct event_admin {
-    hash_map_pt channels;
-    array_list_pt event_handlers;
     bundle_context_pt context;
     log_helper_t **loghelper;
+
+    celix_thread_rwlock_t lock; //protects topicTree and handlers
+    event_admin_topic_node_t *topicTree; //root of the topic tree, the segments of a topic are the path in the tree
+    hash_map_pt handlers; //key = event_handler_service_pt, value = event_admin_handler_t*
+
+    celix_thread_mutex_t readyLock; //protects readyHead, readyTail and running
+    celix_thread_cond_t readyCond;
+    event_admin_handler_t *readyHead; //handlers with queued events, waiting for a worker
+    event_admin_handler_t *readyTail;
+    bool running;
+
+    long handlerQueueSize; //max nr of queued (posted) events per handler
+    int nrOfWorkers;
+    celix_thread_t *workers;
 };
 
-typedef struct channel {
-    char *topic;
-    hash_map_pt eventHandlers;///array list containing all listeners subscribed to the channel
-    // hash_map_pt channels;
-    // apr_thread_mutex_t *channelLock;
-} channel_t;
 /**
  * @desc Create event an event admin and put it in the event_admin parameter.
  * @param apr_pool_t *pool. Pointer to the apr pool
@@ -67,8 +84,21 @@ celix_status_t eventAdmin_create( bundle_context_pt context, event_admin_pt *eve
 
 celix_status_t eventAdmin_destroy(event_admin_pt *event_admin);
 
+/**
+ * @desc starts the worker threads delivering the posted events.
+ * @param event_admin_pt event_admin. the event admin instance
+ */
+celix_status_t eventAdmin_start(event_admin_pt event_admin);
+
+/**
+ * @desc stops and joins the worker threads. Events still queued are dropped.
+ * @param event_admin_pt event_admin. the event admin instance
+ */
+celix_status_t eventAdmin_stop(event_admin_pt event_admin);
+
 /**
  * @desc Post event. sends the event to the handlers in async.
+ * The event is copied; every handler has its own queue, so the events are delivered in post order per handler.
  * @param event_admin_pt event_admin. the event admin instance
  * @param event_pt event. the event to be send.
  *
@@ -96,30 +126,14 @@ celix_status_t eventAdmin_removedService(void * handle, service_reference_pt ref
  */
 
 /**
- * @desc finds the handlers interested in the topic.
- * @param hash_map_pt channels. hashmap contains the channels, key string based
+ * @desc finds the handlers interested in the topic, matching both the exact topics and the wildcard topics
+ * (topics with '*' as last segment) of the handlers.
+ * @param event_admin_pt event_admin. the event admin instance.
  * @param char *topic, the topic string.
- * @param array_list_pt event_handlers. The array list to contain the interested handlers.
+ * @param array_list_pt event_handlers. The array list to contain the interested handlers (event_handler_service_pt).
  */
 celix_status_t eventAdmin_findHandlersByTopic(event_admin_pt event_admin, const char *topic,
                                               array_list_pt event_handlers);
-/**
- * @desc create the needed event channels for an event handler.
- * @desc apr_pool_t *pool. a memory pool pointer.
- * @desc event_handler_service_pt event_handler_service. The handler
- * @desc char *topic the topic
- * @desc channel_t **channel. the top level channel.
- */
-celix_status_t eventAdmin_createEventChannelsByEventHandler(event_handler_service_pt event_handler_service,
-                                                            const char *topic, channel_t **channel);
-/**
- * @desc mutex functions for the channels
- * @param event_admin_pt event_admin. the event admin instance.
- * @param char *topic. the topic for which the channels need to be locked or unlocked
- */
-celix_status_t eventAdmin_lockHandlersList(event_admin_pt event_admin, const char *topic);
-
-celix_status_t eventAdmin_releaseHandersList(event_admin_pt event_admin, const char *topic);
 
 /**
  * @desc create an event
@@ -58,7 +58,7 @@ celix_status_t bundleActivator_create(bundle_context_pt context, void **userData
         status = eventAdmin_create(context, &event_admin);
         if(status == CELIX_SUCCESS){
             activator->event_admin = event_admin;
-            event_admin_service = calloc(1, sizeof(event_admin_service));
+            event_admin_service = calloc(1, sizeof(*event_admin_service));
             if(!event_admin_service){
                 status = CELIX_ENOMEM;
             } else {
@@ -102,12 +102,14 @@ celix_status_t bundleActivator_start(void * userData, bundle_context_pt context)
 
         data->tracker = tracker;
 
+        logHelper_start(activator->loghelper);
+        status = eventAdmin_start(data->event_admin);
+
         serviceTracker_open(tracker);
         properties_pt properties = NULL;
         properties = properties_create();
         event_admin_service = activator->event_admin_service;
         bundleContext_registerService(context, (char *) EVENT_ADMIN_NAME, event_admin_service, properties, &activator->registration);
-        logHelper_start(activator->loghelper);
     }
     return status;
 }
@@ -116,9 +118,12 @@ celix_status_t bundleActivator_stop(void * userData, bundle_context_pt context)
     celix_status_t status = CELIX_SUCCESS;
     struct activator * data =  userData;
     serviceRegistration_unregister(data->registration);
+    //note closing the tracker removes the handlers, which waits until the workers are done with them
     serviceTracker_close(data->tracker);
+    serviceTracker_destroy(data->tracker);
+    data->tracker = NULL;
+    eventAdmin_stop(data->event_admin);
     status = logHelper_stop(data->loghelper);
-    logHelper_destroy(&data->loghelper);
 
     return status;
 }
@@ -126,9 +131,12 @@ celix_status_t bundleActivator_stop(void * userData, bundle_context_pt context)
 
 celix_status_t bundleActivator_destroy(void * userData, bundle_context_pt context) {
     celix_status_t status = CELIX_SUCCESS;
-    //stop  struct activator *activator = userData;
+    struct activator *activator = userData;
 
-    // free(activator);
+    eventAdmin_destroy(&activator->event_admin);
+    free(activator->event_admin_service);
+    logHelper_destroy(&activator->loghelper);
+    free(activator);
 
     return status;
 }
@@ -25,14 +25,271 @@
  */
 
 #include <stdlib.h>
+#include <stdio.h>
 
 #include "event_admin.h"
 #include "event_admin_impl.h"
 #include "event_handler.h"
 #include "hash_map.h"
+#include "array_list.h"
 #include "utils.h"
 #include "celix_log.h"
+#include "celix_bundle_context.h"
 
+#define EVENT_ADMIN_MAX_TOPIC_STACK_LENGTH      256
+#define EVENT_ADMIN_MAX_MATCHED_STACK_SIZE      16
+#define EVENT_ADMIN_MAX_DELIVERIES_PER_TURN     16
+
+/**
+ * Copy of a posted event, shared by the queues of all the handlers receiving the event.
+ */
+typedef struct event_admin_event {
+    struct event event; //note topic points into the copied properties
+    int refCount; //atomic
+} event_admin_event_t;
+
+typedef struct event_admin_queued_event {
+    event_admin_event_t *event;
+    struct event_admin_queued_event *next;
+} event_admin_queued_event_t;
+
+struct event_admin_handler {
+    event_handler_service_pt service;
+    array_list_pt topics; //char*, the subscribed topics, can contain wildcard topics (a/b/*)
+    celix_filter_t *filter; //optional event.filter of the handler
+
+    celix_thread_mutex_t mutex; //protects the fields below
+    celix_thread_cond_t cond;
+    event_admin_queued_event_t *queueHead;
+    event_admin_queued_event_t *queueTail;
+    long queueSize;
+    long dropped;
+    bool scheduled; //true if the handler is in the ready list or its events are delivered by a worker
+    int usageCount; //nr of sendEvent calls using the handler
+    bool removed;
+
+    event_admin_handler_t *nextReady; //protected by the event admin readyLock
+};
+
+struct event_admin_topic_node {
+    hash_map_pt children; //key = topic segment, value = event_admin_topic_node_t*
+    array_list_pt handlers; //event_admin_handler_t*, handlers subscribed to the topic of this node
+    array_list_pt wildcardHandlers; //event_admin_handler_t*, handlers subscribed to <topic of this node>/* (or * for the root)
+};
+
+static void* eventAdmin_worker(void *data);
+
+static event_admin_topic_node_t* eventAdmin_createTopicNode(void) {
+    event_admin_topic_node_t *node = calloc(1, sizeof(*node));
+    if (node != NULL) {
+        node->children = hashMap_create(utils_stringHash, NULL, utils_stringEquals, NULL);
+        arrayList_create(&node->handlers);
+        arrayList_create(&node->wildcardHandlers);
+    }
+    return node;
+}
+
+static void eventAdmin_destroyTopicNode(event_admin_topic_node_t *node) {
+    if (node != NULL) {
+        hash_map_iterator_t iter = hashMapIterator_construct(node->children);
+        while (hashMapIterator_hasNext(&iter)) {
+            hash_map_entry_pt entry = hashMapIterator_nextEntry(&iter);
+            free(hashMapEntry_getKey(entry));
+            eventAdmin_destroyTopicNode(hashMapEntry_getValue(entry));
+        }
+        hashMap_destroy(node->children, false, false);
+        arrayList_destroy(node->handlers);
+        arrayList_destroy(node->wildcardHandlers);
+        free(node);
+    }
+}
+
+/**
+ * Adds the handler to the topic tree. Topics are a '/' separated path, a topic with '*' as last segment (e.g. "a/b/" + "*")
+ * subscribes to all topics starting with the part before the '*'. A topic "*" subscribes to all topics.
+ * Called with the write lock.
+ */
+static celix_status_t eventAdmin_addToTopicTree(event_admin_pt event_admin, const char *topic, event_admin_handler_t *handler) {
+    size_t len = strlen(topic);
+    bool wildcard = len > 0 && topic[len - 1] == '*' && (len == 1 || topic[len - 2] == '/');
+    if (wildcard) {
+        len = len == 1 ? 0 : len - 2;
+    }
+
+    event_admin_topic_node_t *node = event_admin->topicTree;
+    const char *segment = topic;
+    const char *topicEnd = topic + len;
+    while (segment < topicEnd) {
+        const char *segmentEnd = memchr(segment, '/', (size_t)(topicEnd - segment));
+        if (segmentEnd == NULL) {
+            segmentEnd = topicEnd;
+        }
+        char *key = strndup(segment, (size_t)(segmentEnd - segment));
+        if (key == NULL) {
+            return CELIX_ENOMEM;
+        }
+        event_admin_topic_node_t *child = hashMap_get(node->children, key);
+        if (child == NULL) {
+            child = eventAdmin_createTopicNode();
+            if (child == NULL) {
+                free(key);
+                return CELIX_ENOMEM;
+            }
+            hashMap_put(node->children, key, child);
+        } else {
+            free(key);
+        }
+        node = child;
+        segment = segmentEnd + 1;
+    }
+
+    array_list_pt list = wildcard ? node->wildcardHandlers : node->handlers;
+    if (!arrayList_contains(list, handler)) {
+        arrayList_add(list, handler);
+    }
+    return CELIX_SUCCESS;
+}
+
+/**
+ * Removes the handler from the (sub)tree and prunes the nodes without handlers and children.
+ * Returns true if the node is empty.
+ * Called with the write lock.
+ */
+static bool eventAdmin_removeFromTopicTree(event_admin_topic_node_t *node, event_admin_handler_t *handler) {
+    arrayList_removeElement(node->handlers, handler);
+    arrayList_removeElement(node->wildcardHandlers, handler);
+
+    hash_map_iterator_t iter = hashMapIterator_construct(node->children);
+    while (hashMapIterator_hasNext(&iter)) {
+        hash_map_entry_pt entry = hashMapIterator_nextEntry(&iter);
+        event_admin_topic_node_t *child = hashMapEntry_getValue(entry);
+        if (eventAdmin_removeFromTopicTree(child, handler)) {
+            char *key = hashMapEntry_getKey(entry);
+            hashMapIterator_remove(&iter);
+            free(key);
+            eventAdmin_destroyTopicNode(child);
+        }
+    }
+
+    return hashMap_isEmpty(node->children) && arrayList_isEmpty(node->handlers) && arrayList_isEmpty(node->wildcardHandlers);
+}
+
+typedef struct event_admin_matched {
+    event_admin_handler_t **handlers;
+    size_t size;
+    size_t cap;
+    event_admin_handler_t *stackHandlers[EVENT_ADMIN_MAX_MATCHED_STACK_SIZE];
+} event_admin_matched_t;
+
+static void eventAdmin_addMatched(event_admin_matched_t *matched, event_admin_handler_t *handler, const celix_properties_t *props) {
+    for (size_t i = 0; i < matched->size; ++i) {
+        if (matched->handlers[i] == handler) {
+            return; //already matched through another (wildcard) topic
+        }
+    }
+    if (handler->filter != NULL && props != NULL && !celix_filter_match(handler->filter, props)) {
+        return;
+    }
+    if (matched->size == matched->cap) {
+        size_t newCap = matched->cap * 2;
+        event_admin_handler_t **newHandlers = NULL;
+        if (matched->handlers == matched->stackHandlers) {
+            newHandlers = malloc(newCap * sizeof(*newHandlers));
+            if (newHandlers != NULL) {
+                memcpy(newHandlers, matched->handlers, matched->size * sizeof(*newHandlers));
+            }
+        } else {
+            newHandlers = realloc(matched->handlers, newCap * sizeof(*newHandlers));
+        }
+        if (newHandlers == NULL) {
+            return;
+        }
+        matched->handlers = newHandlers;
+        matched->cap = newCap;
+    }
+    matched->handlers[matched->size++] = handler;
+}
+
+static void eventAdmin_addAllMatched(event_admin_matched_t *matched, array_list_pt handlers, const celix_properties_t *props) {
+    for (int i = 0; i < arrayList_size(handlers); ++i) {
+        eventAdmin_addMatched(matched, arrayList_get(handlers, i), props);
+    }
+}
+
+/**
+ * Collects the handlers subscribed to the topic and accepting the event properties.
+ * Called with the read lock.
+ */
+static void eventAdmin_matchHandlers(event_admin_pt event_admin, const char *topic, const celix_properties_t *props, event_admin_matched_t *matched) {
+    matched->handlers = matched->stackHandlers;
+    matched->size = 0;
+    matched->cap = EVENT_ADMIN_MAX_MATCHED_STACK_SIZE;
+    if (topic == NULL) {
+        return;
+    }
+
+    //split the topic in place in a copy, so that the segments can be used as key without allocating
+    char stackTopic[EVENT_ADMIN_MAX_TOPIC_STACK_LENGTH];
+    size_t len = strlen(topic);
+    char *copy = len < sizeof(stackTopic) ? stackTopic : malloc(len + 1);
+    if (copy == NULL) {
+        return;
+    }
+    memcpy(copy, topic, len + 1);
+
+    event_admin_topic_node_t *node = event_admin->topicTree;
+    char *segment = copy;
+    while (node != NULL) {
+        if (segment == NULL) {
+            eventAdmin_addAllMatched(matched, node->handlers, props);
+            break;
+        }
+        //a wildcard subscription on this node matches every topic with at least one more segment
+        eventAdmin_addAllMatched(matched, node->wildcardHandlers, props);
+        char *next = strchr(segment, '/');
+        if (next != NULL) {
+            *next = '\0';
+            next += 1;
+        }
+        node = hashMap_get(node->children, segment);
+        segment = next;
+    }
+
+    if (copy != stackTopic) {
+        free(copy);
+    }
+}
+
+static void eventAdmin_releaseMatched(event_admin_matched_t *matched) {
+    if (matched->handlers != matched->stackHandlers) {
+        free(matched->handlers);
+    }
+}
+
+static event_admin_event_t* eventAdmin_copyEvent(event_pt event) {
+    event_admin_event_t *copy = calloc(1, sizeof(*copy));
+    if (copy != NULL) {
+        copy->event.properties = celix_properties_copy(event->properties);
+        if (copy->event.properties == NULL) {
+            free(copy);
+            return NULL;
+        }
+        copy->event.topic = properties_get(copy->event.properties, (char *) EVENT_TOPIC);
+        copy->refCount = 1;
+    }
+    return copy;
+}
+
+static void eventAdmin_retainEvent(event_admin_event_t *event) {
+    __atomic_add_fetch(&event->refCount, 1, __ATOMIC_RELAXED);
+}
+
+static void eventAdmin_releaseEvent(event_admin_event_t *event) {
+    if (__atomic_sub_fetch(&event->refCount, 1, __ATOMIC_ACQ_REL) == 0) {
+        properties_destroy(event->event.properties);
+        free(event);
+    }
+}
 
 celix_status_t eventAdmin_create(bundle_context_pt context, event_admin_pt *event_admin){
     celix_status_t status = CELIX_SUCCESS;
@@ -40,9 +297,23 @@ celix_status_t eventAdmin_create(bundle_context_pt context, event_admin_pt *even
     if (!*event_admin) {
         status = CELIX_ENOMEM;
     } else {
-        (*event_admin)->channels = hashMap_create(utils_stringHash, utils_stringHash, utils_stringEquals, utils_stringEquals);
-        (*event_admin)->context =context;
-        status = arrayList_create(&(*event_admin)->event_handlers);
+        (*event_admin)->context = context;
+        (*event_admin)->topicTree = eventAdmin_createTopicNode();
+        (*event_admin)->handlers = hashMap_create(NULL, NULL, NULL, NULL);
+        celixThreadRwlock_create(&(*event_admin)->lock, NULL);
+        celixThreadMutex_create(&(*event_admin)->readyLock, NULL);
+        celixThreadCondition_init(&(*event_admin)->readyCond, NULL);
+
+        long nrOfWorkers = celix_bundleContext_getPropertyAsLong(context, EVENT_ADMIN_NR_OF_WORKERS_NAME, EVENT_ADMIN_NR_OF_WORKERS_DEFAULT);
+        (*event_admin)->nrOfWorkers = nrOfWorkers < 1 ? 1 : (int) nrOfWorkers;
+        long queueSize = celix_bundleContext_getPropertyAsLong(context, EVENT_ADMIN_HANDLER_QUEUE_SIZE_NAME, EVENT_ADMIN_HANDLER_QUEUE_SIZE_DEFAULT);
+        (*event_admin)->handlerQueueSize = queueSize < 1 ? 1 : queueSize;
+        (*event_admin)->workers = calloc((size_t) (*event_admin)->nrOfWorkers, sizeof(celix_thread_t));
+
+        if ((*event_admin)->topicTree == NULL || (*event_admin)->workers == NULL) {
+            status = CELIX_ENOMEM;
+            eventAdmin_destroy(event_admin);
+        }
     }
     return status;
 }
@@ -50,35 +321,124 @@ celix_status_t eventAdmin_create(bundle_context_pt context, event_admin_pt *even
 celix_status_t eventAdmin_destroy(event_admin_pt *event_admin)
 {
     celix_status_t status = CELIX_SUCCESS;
-    //free(*event_admin);
+    event_admin_pt ea = *event_admin;
+    if (ea != NULL) {
+        //note handlers are removed by the service tracker before the event admin is destroyed
+        eventAdmin_destroyTopicNode(ea->topicTree);
+        hashMap_destroy(ea->handlers, false, false);
+        celixThreadRwlock_destroy(&ea->lock);
+        celixThreadMutex_destroy(&ea->readyLock);
+        celixThreadCondition_destroy(&ea->readyCond);
+        free(ea->workers);
+        free(ea);
+        *event_admin = NULL;
+    }
     return status;
 }
 
+celix_status_t eventAdmin_start(event_admin_pt event_admin) {
+    celix_status_t status = CELIX_SUCCESS;
+    celixThreadMutex_lock(&event_admin->readyLock);
+    event_admin->running = true;
+    celixThreadMutex_unlock(&event_admin->readyLock);
+
+    for (int i = 0; i < event_admin->nrOfWorkers && status == CELIX_SUCCESS; ++i) {
+        status = celixThread_create(&event_admin->workers[i], NULL, eventAdmin_worker, event_admin);
+        if (status == CELIX_SUCCESS) {
+            celixThread_setName(&event_admin->workers[i], "EventAdmin");
+        } else {
+            event_admin->nrOfWorkers = i;
+        }
+    }
+    return status;
+}
+
+celix_status_t eventAdmin_stop(event_admin_pt event_admin) {
+    celixThreadMutex_lock(&event_admin->readyLock);
+    event_admin->running = false;
+    celixThreadCondition_broadcast(&event_admin->readyCond);
+    celixThreadMutex_unlock(&event_admin->readyLock);
+
+    for (int i = 0; i < event_admin->nrOfWorkers; ++i) {
+        celixThread_join(event_admin->workers[i], NULL);
+    }
+    return CELIX_SUCCESS;
+}
+
 celix_status_t eventAdmin_getEventHandlersByChannel(bundle_context_pt context, const char * serviceName, array_list_pt *eventHandlers) {
     celix_status_t status = CELIX_SUCCESS;
     //celix_status_t status = bundleContext_getServiceReferences(context, serviceName, NULL, eventHandlers);
     return status;
 }
 
+static void eventAdmin_scheduleHandler(event_admin_pt event_admin, event_admin_handler_t *handler) {
+    celixThreadMutex_lock(&event_admin->readyLock);
+    handler->nextReady = NULL;
+    if (event_admin->readyTail == NULL) {
+        event_admin->readyHead = handler;
+    } else {
+        event_admin->readyTail->nextReady = handler;
+    }
+    event_admin->readyTail = handler;
+    celixThreadCondition_signal(&event_admin->readyCond);
+    celixThreadMutex_unlock(&event_admin->readyLock);
+}
+
 celix_status_t eventAdmin_postEvent(event_admin_pt event_admin, event_pt event) {
     celix_status_t status = CELIX_SUCCESS;
 
     const char *topic;
-
     eventAdmin_getTopic(&event, &topic);
 
-    array_list_pt event_handlers;
-    arrayList_create(&event_handlers);
-    eventAdmin_lockHandlersList(event_admin, topic);
-    eventAdmin_findHandlersByTopic(event_admin, topic, event_handlers);
-    // TODO make this async!
-    array_list_iterator_pt handlers_iterator = arrayListIterator_create(event_handlers);
-    while (arrayListIterator_hasNext(handlers_iterator)) {
-        event_handler_service_pt event_handler_service = (event_handler_service_pt) arrayListIterator_next(handlers_iterator);
-        logHelper_log(*event_admin->loghelper, OSGI_LOGSERVICE_INFO, "handler found (POST EVENT) for %s", topic);
-        event_handler_service->handle_event(&event_handler_service->event_handler, event);
-    }
-    eventAdmin_releaseHandersList(event_admin, topic);
+    event_admin_matched_t matched;
+    event_admin_event_t *copy = NULL;
+    long dropped = 0;
+
+    celixThreadRwlock_readLock(&event_admin->lock);
+    eventAdmin_matchHandlers(event_admin, topic, event->properties, &matched);
+    if (matched.size > 0) {
+        copy = eventAdmin_copyEvent(event);
+        if (copy == NULL) {
+            status = CELIX_ENOMEM;
+        }
+    }
+    for (size_t i = 0; copy != NULL && i < matched.size; ++i) {
+        event_admin_handler_t *handler = matched.handlers[i];
+        bool schedule = false;
+        celixThreadMutex_lock(&handler->mutex);
+        event_admin_queued_event_t *entry = handler->queueSize < event_admin->handlerQueueSize ? malloc(sizeof(*entry)) : NULL;
+        if (entry != NULL && !handler->removed) {
+            eventAdmin_retainEvent(copy);
+            entry->event = copy;
+            entry->next = NULL;
+            if (handler->queueTail == NULL) {
+                handler->queueHead = entry;
+            } else {
+                handler->queueTail->next = entry;
+            }
+            handler->queueTail = entry;
+            handler->queueSize += 1;
+            schedule = !handler->scheduled;
+            handler->scheduled = true;
+        } else {
+            free(entry);
+            handler->dropped += 1;
+            dropped += 1;
+        }
+        celixThreadMutex_unlock(&handler->mutex);
+        if (schedule) {
+            eventAdmin_scheduleHandler(event_admin, handler);
+        }
+    }
+    celixThreadRwlock_unlock(&event_admin->lock);
+    eventAdmin_releaseMatched(&matched);
+
+    if (copy != NULL) {
+        eventAdmin_releaseEvent(copy);
+    }
+    if (dropped > 0) {
+        logHelper_log(*event_admin->loghelper, OSGI_LOGSERVICE_WARNING, "Event queue full, dropped event %s for %li handler(s)", topic, dropped);
+    }
     return status;
 }
 
@@ -88,126 +448,236 @@ celix_status_t eventAdmin_sendEvent(event_admin_pt event_admin, event_pt event)
     const char *topic;
     eventAdmin_getTopic(&event, &topic);
 
-    array_list_pt event_handlers;
-    arrayList_create(&event_handlers);
-    eventAdmin_lockHandlersList(event_admin, topic);
-    eventAdmin_findHandlersByTopic(event_admin, topic, event_handlers);
-    array_list_iterator_pt handlers_iterator = arrayListIterator_create(event_handlers);
-    while (arrayListIterator_hasNext(handlers_iterator)) {
-        event_handler_service_pt event_handler_service = (event_handler_service_pt) arrayListIterator_next(handlers_iterator);
-        logHelper_log(*event_admin->loghelper, OSGI_LOGSERVICE_INFO, "handler found (SEND EVENT) for %s", topic);
-        event_handler_service->handle_event(&event_handler_service->event_handler, event);
-    }
-    eventAdmin_releaseHandersList(event_admin, topic);
+    event_admin_matched_t matched;
+    celixThreadRwlock_readLock(&event_admin->lock);
+    eventAdmin_matchHandlers(event_admin, topic, event->properties, &matched);
+    for (size_t i = 0; i < matched.size; ++i) {
+        event_admin_handler_t *handler = matched.handlers[i];
+        celixThreadMutex_lock(&handler->mutex);
+        handler->usageCount += 1;
+        celixThreadMutex_unlock(&handler->mutex);
+    }
+    celixThreadRwlock_unlock(&event_admin->lock);
+
+    //note delivered without lock, the handler is kept alive by the usage count
+    for (size_t i = 0; i < matched.size; ++i) {
+        event_admin_handler_t *handler = matched.handlers[i];
+        handler->service->handle_event(&handler->service->event_handler, event);
+        celixThreadMutex_lock(&handler->mutex);
+        handler->usageCount -= 1;
+        celixThreadCondition_broadcast(&handler->cond);
+        celixThreadMutex_unlock(&handler->mutex);
+    }
+    eventAdmin_releaseMatched(&matched);
     return status;
 }
 
-celix_status_t eventAdmin_findHandlersByTopic(event_admin_pt event_admin, const char *topic,
-                                              array_list_pt event_handlers) {
-    celix_status_t status = CELIX_SUCCESS;
-    hash_map_pt channels = event_admin->channels;
-    channel_t *channel = hashMap_get(channels, topic);
-    if (channel != NULL) {
-        logHelper_log(*event_admin->loghelper, OSGI_LOGSERVICE_INFO, "found channel: %s", topic);
-        if (channel->eventHandlers != NULL && !hashMap_isEmpty(channel->eventHandlers)) {
-            // iterate through the handlers and add them to the array list for result.
-            hash_map_iterator_pt hashmap_iterator =  hashMapIterator_create(channel->eventHandlers);
-            while (hashMapIterator_hasNext(hashmap_iterator)) {
-                arrayList_add(event_handlers, (event_handler_service_pt) hashMapIterator_nextValue(hashmap_iterator));
+static void* eventAdmin_worker(void *data) {
+    event_admin_pt event_admin = data;
+
+    celixThreadMutex_lock(&event_admin->readyLock);
+    while (event_admin->running) {
+        event_admin_handler_t *handler = event_admin->readyHead;
+        if (handler == NULL) {
+            celixThreadCondition_wait(&event_admin->readyCond, &event_admin->readyLock);
+            continue;
+        }
+        event_admin->readyHead = handler->nextReady;
+        if (event_admin->readyHead == NULL) {
+            event_admin->readyTail = NULL;
+        }
+        celixThreadMutex_unlock(&event_admin->readyLock);
+
+        //only one worker delivers the events of a handler, so the events are delivered in post order
+        bool reschedule = false;
+        for (int delivered = 0; ; ++delivered) {
+            celixThreadMutex_lock(&handler->mutex);
+            event_admin_queued_event_t *entry = handler->removed ? NULL : handler->queueHead;
+            if (entry == NULL || delivered >= EVENT_ADMIN_MAX_DELIVERIES_PER_TURN) {
+                //note reschedule (give other handlers a turn) if there are events left
+                reschedule = entry != NULL;
+                handler->scheduled = reschedule;
+                celixThreadCondition_broadcast(&handler->cond);
+                celixThreadMutex_unlock(&handler->mutex);
+                break;
             }
+            handler->queueHead = entry->next;
+            if (handler->queueHead == NULL) {
+                handler->queueTail = NULL;
+            }
+            handler->queueSize -= 1;
+            celixThreadMutex_unlock(&handler->mutex);
+
+            handler->service->handle_event(&handler->service->event_handler, &entry->event->event);
+            eventAdmin_releaseEvent(entry->event);
+            free(entry);
         }
-    } else {
-        logHelper_log(*event_admin->loghelper, OSGI_LOGSERVICE_WARNING, "no such channel: %s", topic);
+        if (reschedule) {
+            eventAdmin_scheduleHandler(event_admin, handler);
+        }
+
+        celixThreadMutex_lock(&event_admin->readyLock);
     }
-    return status;
+    celixThreadMutex_unlock(&event_admin->readyLock);
+
+    return NULL;
 }
 
-celix_status_t eventAdmin_createEventChannels(event_admin_pt *event_admin, const char *topic,
-                                              event_handler_service_pt event_handler_service) {
+celix_status_t eventAdmin_findHandlersByTopic(event_admin_pt event_admin, const char *topic,
+                                              array_list_pt event_handlers) {
     celix_status_t status = CELIX_SUCCESS;
-    channel_t *channel = hashMap_get((*event_admin)->channels, topic);
-    if (channel == NULL) {
-        //create channel
-        logHelper_log(*(*event_admin)->loghelper, OSGI_LOGSERVICE_ERROR, "Creating channel: %s", topic);
-
-
+    event_admin_matched_t matched;
+    celixThreadRwlock_readLock(&event_admin->lock);
+    eventAdmin_matchHandlers(event_admin, topic, NULL, &matched);
+    for (size_t i = 0; i < matched.size; ++i) {
+        arrayList_add(event_handlers, matched.handlers[i]->service);
+    }
+    celixThreadRwlock_unlock(&event_admin->lock);
+    eventAdmin_releaseMatched(&matched);
+    return status;
+}
 
-        channel = calloc(1, sizeof(*channel));
-        if (!channel) {
-            status = CELIX_ENOMEM;
-        } else {
-            char *channel_name = strdup(topic);
-            channel->topic = channel_name;
-            channel->eventHandlers = hashMap_create(NULL,NULL,NULL,NULL);
-            //channel->channelLock = NULL;
-          //  apr_thread_mutex_create(&channel->channelLock, APR_THREAD_MUTEX_NESTED, subPool);
-            hashMap_put((*event_admin)->channels, channel_name, channel);
+static void eventAdmin_destroyHandler(event_admin_handler_t *handler) {
+    if (handler != NULL) {
+        for (int i = 0; handler->topics != NULL && i < arrayList_size(handler->topics); ++i) {
+            free(arrayList_get(handler->topics, i));
+        }
+        if (handler->topics != NULL) {
+            arrayList_destroy(handler->topics);
+        }
+        if (handler->filter != NULL) {
+            celix_filter_destroy(handler->filter);
         }
+        celixThreadMutex_destroy(&handler->mutex);
+        celixThreadCondition_destroy(&handler->cond);
+        free(handler);
     }
-    if (channel) {
-        hashMap_put(channel->eventHandlers, &event_handler_service, event_handler_service);
+}
+
+static event_admin_handler_t* eventAdmin_createHandler(event_admin_pt event_admin, event_handler_service_pt service, const char *topics, const char *filter) {
+    event_admin_handler_t *handler = calloc(1, sizeof(*handler));
+    if (handler == NULL) {
+        return NULL;
     }
-    return status;
+    handler->service = service;
+    celixThreadMutex_create(&handler->mutex, NULL);
+    celixThreadCondition_init(&handler->cond, NULL);
+    arrayList_create(&handler->topics);
 
+    //event.topic can contain multiple comma separated topics
+    char *copy = topics != NULL ? strdup(topics) : NULL;
+    char *savePtr = NULL;
+    for (char *topic = copy != NULL ? strtok_r(copy, ",", &savePtr) : NULL; topic != NULL; topic = strtok_r(NULL, ",", &savePtr)) {
+        char *trimmed = utils_stringTrim(topic);
+        if (trimmed[0] != '\0') {
+            arrayList_add(handler->topics, strdup(trimmed));
+        }
+    }
+    free(copy);
 
+    if (filter != NULL && filter[0] != '\0') {
+        handler->filter = celix_filter_create(filter);
+        if (handler->filter == NULL) {
+            logHelper_log(*event_admin->loghelper, OSGI_LOGSERVICE_ERROR, "Invalid event filter '%s', handler ignored", filter);
+            eventAdmin_destroyHandler(handler);
+            return NULL;
+        }
+    }
+    return handler;
 }
 
-celix_status_t eventAdmin_lockHandlersList(event_admin_pt event_admin, const char *topic) {
+static celix_status_t eventAdmin_addHandler(event_admin_pt event_admin, service_reference_pt ref, event_handler_service_pt service) {
     celix_status_t status = CELIX_SUCCESS;
-    /*channel_t *channel = hashMap_get(event_admin->channels, topic);
-    if (channel != NULL) {
-        // TODO verify this will never deadlock...
-       // apr_status_t status;
-        do {
-         //   status = apr_thread_mutex_trylock(channel->channelLock);
-        } while (status != 0 && !APR_STATUS_IS_EBUSY(status));
-        logHelper_log(*event_admin->loghelper, OSGI_LOGSERVICE_DEBUG, "LOCK: %s!", topic);
-    }*/
+    const char *topics = NULL;
+    const char *filter = NULL;
+    serviceReference_getProperty(ref, (char*)EVENT_TOPIC, &topics);
+    serviceReference_getProperty(ref, (char*)EVENT_FILTER, &filter);
+
+    event_admin_handler_t *handler = eventAdmin_createHandler(event_admin, service, topics, filter);
+    if (handler == NULL) {
+        return CELIX_ILLEGAL_ARGUMENT;
+    }
+
+    celixThreadRwlock_writeLock(&event_admin->lock);
+    for (int i = 0; i < arrayList_size(handler->topics) && status == CELIX_SUCCESS; ++i) {
+        status = eventAdmin_addToTopicTree(event_admin, arrayList_get(handler->topics, i), handler);
+    }
+    if (status == CELIX_SUCCESS) {
+        hashMap_put(event_admin->handlers, service, handler);
+    } else {
+        eventAdmin_removeFromTopicTree(event_admin->topicTree, handler);
+    }
+    celixThreadRwlock_unlock(&event_admin->lock);
+
+    if (status != CELIX_SUCCESS) {
+        eventAdmin_destroyHandler(handler);
+    }
     return status;
 }
 
-celix_status_t eventAdmin_releaseHandersList(event_admin_pt event_admin, const char *topic) {
-    celix_status_t status = CELIX_SUCCESS;
-    channel_t *channel = hashMap_get(event_admin->channels, topic);
-    if (channel != NULL) {
-        // TODO check the result value...
-       // apr_thread_mutex_unlock(channel->channelLock);
-        logHelper_log(*event_admin->loghelper, OSGI_LOGSERVICE_ERROR, "UNLOCK: %s!", topic);
+/**
+ * Removes the handler and waits until the handler is not used anymore by a worker or a sendEvent call.
+ * Events still queued for the handler are dropped.
+ */
+static void eventAdmin_removeHandler(event_admin_pt event_admin, event_handler_service_pt service) {
+    celixThreadRwlock_writeLock(&event_admin->lock);
+    event_admin_handler_t *handler = hashMap_remove(event_admin->handlers, service);
+    if (handler != NULL) {
+        eventAdmin_removeFromTopicTree(event_admin->topicTree, handler);
     }
-    return status;
+    celixThreadRwlock_unlock(&event_admin->lock);
+
+    if (handler == NULL) {
+        return;
+    }
+
+    celixThreadMutex_lock(&handler->mutex);
+    handler->removed = true;
+    while (handler->usageCount > 0 || handler->scheduled) {
+        celixThreadCondition_wait(&handler->cond, &handler->mutex);
+    }
+    event_admin_queued_event_t *entry = handler->queueHead;
+    handler->queueHead = NULL;
+    handler->queueTail = NULL;
+    celixThreadMutex_unlock(&handler->mutex);
+
+    while (entry != NULL) {
+        event_admin_queued_event_t *next = entry->next;
+        eventAdmin_releaseEvent(entry->event);
+        free(entry);
+        entry = next;
+    }
+    if (handler->dropped > 0) {
+        logHelper_log(*event_admin->loghelper, OSGI_LOGSERVICE_WARNING, "Event handler dropped %li event(s) because its queue was full", handler->dropped);
+    }
+    eventAdmin_destroyHandler(handler);
 }
 
 celix_status_t eventAdmin_addingService(void * handle, service_reference_pt ref, void **service) {
-    celix_status_t status = CELIX_SUCCESS;
-    event_admin_pt  event_admin = handle;
-    status = bundleContext_getService(event_admin->context, ref, service);
-    logHelper_log(*event_admin->loghelper, OSGI_LOGSERVICE_ERROR, "test");
-    printf("eventadmin adding service \n");
-      return status;
+    event_admin_pt event_admin = handle;
+    return bundleContext_getService(event_admin->context, ref, service);
 }
 
 celix_status_t eventAdmin_addedService(void * handle, service_reference_pt ref, void * service) {
-    celix_status_t status = CELIX_SUCCESS;
     event_admin_pt event_admin = handle;
-    event_handler_service_pt event_handler_service = NULL;
-    event_handler_service = (event_handler_service_pt) service;
-    const char *topic = NULL;
-    serviceReference_getProperty(ref, (char*)EVENT_TOPIC, &topic);
-    logHelper_log(*event_admin->loghelper, OSGI_LOGSERVICE_ERROR, "Original TOPIC: %s", topic);
-    printf("original topic: %s\n", topic);
-    eventAdmin_createEventChannels(&event_admin,topic,event_handler_service);
+    event_handler_service_pt event_handler_service = (event_handler_service_pt) service;
+    celix_status_t status = eventAdmin_addHandler(event_admin, ref, event_handler_service);
+    if (status != CELIX_SUCCESS) {
+        logHelper_log(*event_admin->loghelper, OSGI_LOGSERVICE_ERROR, "Cannot add event handler %p", service);
+    }
     return status;
 }
 
 celix_status_t eventAdmin_modifiedService(void * handle, service_reference_pt ref, void * service) {
     event_admin_pt event_admin = (event_admin_pt) handle;
-    logHelper_log(*event_admin->loghelper, OSGI_LOGSERVICE_ERROR, "Event admin Modified");
-    return CELIX_SUCCESS;
+    //topics and/or filter can be changed
+    eventAdmin_removeHandler(event_admin, (event_handler_service_pt) service);
+    return eventAdmin_addHandler(event_admin, ref, (event_handler_service_pt) service);
 }
 
 celix_status_t eventAdmin_removedService(void * handle, service_reference_pt ref, void * service) {
     event_admin_pt event_admin = (event_admin_pt) handle;
-    logHelper_log(*event_admin->loghelper, OSGI_LOGSERVICE_ERROR, "Event admin Removed %p", service);
-    printf("Event admin Removed %p", service);
-    return CELIX_SUCCESS;
+    eventAdmin_removeHandler(event_admin, (event_handler_service_pt) service);
+    bool result = false;
+    return bundleContext_ungetService(event_admin->context, ref, &result);
 }
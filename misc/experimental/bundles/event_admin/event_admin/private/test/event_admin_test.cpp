@@ -0,0 +1,248 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *  KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <thread>
+#include <chrono>
+#include <mutex>
+#include <condition_variable>
+#include <vector>
+#include <string>
+#include <memory>
+
+#include "celix_api.h"
+#include "celix_framework_factory.h"
+
+extern "C" {
+#include "event_admin_impl.h"
+}
+
+#include <CppUTest/TestHarness.h>
+
+/**
+ * Event handler of the tests, records the topic and the "seq" property of the received events.
+ */
+struct event_handler {
+    std::mutex mutex{};
+    std::condition_variable cond{};
+    std::vector<std::string> topics{};
+    std::vector<long> seqs{};
+    std::vector<std::thread::id> threads{};
+    struct event_handler_service service{};
+
+    size_t waitFor(size_t count) {
+        std::unique_lock<std::mutex> lock{mutex};
+        cond.wait_for(lock, std::chrono::seconds{5}, [&]{ return topics.size() >= count; });
+        return topics.size();
+    }
+
+    size_t count() {
+        std::lock_guard<std::mutex> lock{mutex};
+        return topics.size();
+    }
+};
+
+static celix_status_t eventAdminTest_handleEvent(event_handler_pt *handle, event_pt event) {
+    event_handler *handler = *handle;
+    std::lock_guard<std::mutex> lock{handler->mutex};
+    handler->topics.emplace_back(event->topic);
+    handler->seqs.push_back(celix_properties_getAsLong(event->properties, "seq", -1));
+    handler->threads.push_back(std::this_thread::get_id());
+    handler->cond.notify_all();
+    return CELIX_SUCCESS;
+}
+
+TEST_GROUP(EventAdminTests) {
+    celix_framework_t *fw = nullptr;
+    celix_bundle_context_t *ctx = nullptr;
+    log_helper_t *logHelper = nullptr;
+    event_admin_pt eventAdmin = nullptr;
+    service_tracker_pt tracker = nullptr;
+    std::vector<std::unique_ptr<event_handler>> handlers{};
+    std::vector<long> svcIds{};
+
+    void setup() {
+        celix_properties_t *properties = celix_properties_create();
+        celix_properties_set(properties, "LOGHELPER_ENABLE_STDOUT_FALLBACK", "true");
+        celix_properties_set(properties, "org.osgi.framework.storage.clean", "onFirstInit");
+        celix_properties_set(properties, "org.osgi.framework.storage", ".cacheEventAdminTestFramework");
+        fw = celix_frameworkFactory_createFramework(properties);
+        ctx = celix_framework_getFrameworkContext(fw);
+
+        logHelper_create(ctx, &logHelper);
+        logHelper_start(logHelper);
+        CHECK_EQUAL(CELIX_SUCCESS, eventAdmin_create(ctx, &eventAdmin));
+        eventAdmin->loghelper = &logHelper;
+        CHECK_EQUAL(CELIX_SUCCESS, eventAdmin_start(eventAdmin));
+
+        service_tracker_customizer_pt cust = nullptr;
+        serviceTrackerCustomizer_create(eventAdmin, eventAdmin_addingService, eventAdmin_addedService, eventAdmin_modifiedService, eventAdmin_removedService, &cust);
+        serviceTracker_create(ctx, EVENT_HANDLER_SERVICE, cust, &tracker);
+        serviceTracker_open(tracker);
+    }
+
+    void teardown() {
+        serviceTracker_close(tracker);
+        serviceTracker_destroy(tracker);
+        for (long svcId : svcIds) {
+            celix_bundleContext_unregisterService(ctx, svcId);
+        }
+        eventAdmin_stop(eventAdmin);
+        eventAdmin_destroy(&eventAdmin);
+        logHelper_stop(logHelper);
+        logHelper_destroy(&logHelper);
+        celix_frameworkFactory_destroyFramework(fw);
+    }
+
+    event_handler* addHandler(const char *topics, const char *filter = nullptr) {
+        handlers.emplace_back(new event_handler{});
+        event_handler *handler = handlers.back().get();
+        handler->service.event_handler = handler;
+        handler->service.handle_event = eventAdminTest_handleEvent;
+        celix_properties_t *props = celix_properties_create();
+        celix_properties_set(props, EVENT_TOPIC, topics);
+        if (filter != nullptr) {
+            celix_properties_set(props, EVENT_FILTER, filter);
+        }
+        long svcId = celix_bundleContext_registerService(ctx, &handler->service, EVENT_HANDLER_SERVICE, props);
+        CHECK(svcId >= 0);
+        svcIds.push_back(svcId);
+        return handler;
+    }
+
+    /**
+     * Creates an event with a copy of the topic, the caller has to destroy the event with destroyEvent.
+     */
+    event_pt createEvent(const char *topic, long seq = 0) {
+        celix_properties_t *props = celix_properties_create();
+        celix_properties_setLong(props, "seq", seq);
+        event_pt event = nullptr;
+        CHECK_EQUAL(CELIX_SUCCESS, eventAdmin_createEvent(eventAdmin, topic, props, &event));
+        return event;
+    }
+
+    static void destroyEvent(event_pt event) {
+        celix_properties_destroy(event->properties);
+        free(event);
+    }
+
+    void send(const char *topic) {
+        event_pt event = createEvent(topic);
+        CHECK_EQUAL(CELIX_SUCCESS, eventAdmin_sendEvent(eventAdmin, event));
+        destroyEvent(event);
+    }
+};
+
+TEST(EventAdminTests, sendEventIsSync) {
+    event_handler *handler = addHandler("a/b");
+    send("a/b");
+
+    //delivered before sendEvent returns, on the caller thread
+    CHECK_EQUAL((size_t)1, handler->count());
+    CHECK(handler->threads[0] == std::this_thread::get_id());
+    CHECK_EQUAL(std::string{"a/b"}, handler->topics[0]);
+
+    send("a/c");
+    CHECK_EQUAL((size_t)1, handler->count());
+}
+
+TEST(EventAdminTests, postEventIsAsyncAndOrdered) {
+    event_handler *handler1 = addHandler("a/b");
+    event_handler *handler2 = addHandler("a/b");
+    const long nrOfEvents = 200;
+
+    for (long i = 0; i < nrOfEvents; ++i) {
+        //the event is copied, so it can be destroyed directly after the post
+        event_pt event = createEvent("a/b", i);
+        CHECK_EQUAL(CELIX_SUCCESS, eventAdmin_postEvent(eventAdmin, event));
+        destroyEvent(event);
+    }
+
+    for (event_handler *handler : {handler1, handler2}) {
+        CHECK_EQUAL((size_t)nrOfEvents, handler->waitFor(nrOfEvents));
+        std::lock_guard<std::mutex> lock{handler->mutex};
+        for (long i = 0; i < nrOfEvents; ++i) {
+            CHECK_EQUAL(i, handler->seqs[i]);
+            CHECK(handler->threads[i] != std::this_thread::get_id());
+        }
+    }
+}
+
+TEST(EventAdminTests, removeHandlerWithPostedEvents) {
+    event_handler *handler = addHandler("a/b");
+    for (long i = 0; i < 100; ++i) {
+        event_pt event = createEvent("a/b", i);
+        eventAdmin_postEvent(eventAdmin, event);
+        destroyEvent(event);
+    }
+
+    //after the remove the handler is not called anymore
+    celix_bundleContext_unregisterService(ctx, svcIds.back());
+    svcIds.pop_back();
+    size_t count = handler->count();
+    std::this_thread::sleep_for(std::chrono::milliseconds{50});
+    CHECK_EQUAL(count, handler->count());
+}
+
+TEST(EventAdminTests, wildcardTopics) {
+    event_handler *exact = addHandler("a/b");
+    event_handler *aWildcard = addHandler("a/*");
+    event_handler *abWildcard = addHandler("a/b/*");
+    event_handler *all = addHandler("*");
+    event_handler *multiple = addHandler("x/y, c");
+    event_handler *other = addHandler("x/z");
+
+    send("a/b");
+    send("a/b/c");
+    send("a");
+    send("c");
+    send("x/y");
+
+    //"a/*" matches all topics below a, but not a itself
+    CHECK_EQUAL((size_t)1, exact->count());
+    CHECK_EQUAL((size_t)2, aWildcard->count());
+    CHECK_EQUAL(std::string{"a/b/c"}, aWildcard->topics[1]);
+    CHECK_EQUAL((size_t)1, abWildcard->count());
+    CHECK_EQUAL(std::string{"a/b/c"}, abWildcard->topics[0]);
+    CHECK_EQUAL((size_t)5, all->count());
+    CHECK_EQUAL((size_t)2, multiple->count());
+    CHECK_EQUAL((size_t)0, other->count());
+
+    //a handler matching through several subscriptions gets the event once
+    event_handler *overlapping = addHandler("a/b,a/*,*");
+    send("a/b");
+    CHECK_EQUAL((size_t)1, overlapping->count());
+
+    array_list_pt found = nullptr;
+    arrayList_create(&found);
+    eventAdmin_findHandlersByTopic(eventAdmin, "a/b/c", found);
+    CHECK_EQUAL(4, arrayList_size(found)); //a/*, a/b/*, * and the overlapping handler
+    arrayList_destroy(found);
+}
+
+TEST(EventAdminTests, eventFilter) {
+    event_handler *filtered = addHandler("a/b", "(seq>5)");
+    for (long seq : {1, 6, 10}) {
+        event_pt event = createEvent("a/b", seq);
+        eventAdmin_sendEvent(eventAdmin, event);
+        destroyEvent(event);
+    }
+    CHECK_EQUAL((size_t)2, filtered->count());
+    CHECK_EQUAL(6, filtered->seqs[0]);
+    CHECK_EQUAL(10, filtered->seqs[1]);
+}
@@ -31,6 +31,7 @@
 #include <algorithm>
 
 #include "pubsub_utils.h"
+#include "ip_utils.h"
 #include "pubsub_nanomsg_admin.h"
 #include "pubsub_psa_nanomsg_constants.h"
 
@@ -50,7 +51,7 @@ pubsub_nanomsg_admin::pubsub_nanomsg_admin(celix_bundle_context_t *_ctx):
             // IP with subnet prefix specified
             ip = ipUtils_findIpBySubnet(confIp);
             if (ip == NULL) {
-                L_WARN("[PSA_NANOMSG] Could not find interface for requested subnet %s", confIp);
+                L.WARN("[PSA_NANOMSG] Could not find interface for requested subnet ", confIp);
             }
         } else {
             // IP address specified
@@ -88,6 +89,9 @@ pubsub_nanomsg_admin::pubsub_nanomsg_admin(celix_bundle_context_t *_ctx):
     }
 
 
+    ipcDir = celix_bundleContext_getProperty(ctx, PSA_NANOMSG_IPC_DIR, PSA_NANOMSG_DEFAULT_IPC_DIR);
+    metricsEnabled = celix_bundleContext_getPropertyAsBool(ctx, PSA_NANOMSG_METRICS_ENABLED, PSA_NANOMSG_DEFAULT_METRICS_ENABLED);
+
     defaultScore = celix_bundleContext_getPropertyAsDouble(ctx, PSA_NANOMSG_DEFAULT_SCORE_KEY, PSA_NANOMSG_DEFAULT_SCORE);
     qosSampleScore = celix_bundleContext_getPropertyAsDouble(ctx, PSA_NANOMSG_QOS_SAMPLE_SCORE_KEY, PSA_NANOMSG_DEFAULT_QOS_SAMPLE_SCORE);
     qosControlScore = celix_bundleContext_getPropertyAsDouble(ctx, PSA_NANOMSG_QOS_CONTROL_SCORE_KEY, PSA_NANOMSG_DEFAULT_QOS_CONTROL_SCORE);
@@ -172,6 +176,17 @@ void pubsub_nanomsg_admin::start() {
 
     adminSvcId = celix_bundleContext_registerService(ctx, static_cast<void*>(&adminService), PUBSUB_ADMIN_SERVICE_NAME, props);
 
+    if (metricsEnabled) {
+        metricsService.handle = this;
+        metricsService.visitMetrics = [](void *handle, const struct timespec *changedSince, void *callbackHandle, pubsub_metrics_visit_fp callback) {
+            auto me = static_cast<pubsub_nanomsg_admin*>(handle);
+            me->visitMetrics(changedSince, callbackHandle, callback);
+        };
+        celix_properties_t *metricsProps = celix_properties_create();
+        celix_properties_set(metricsProps, PUBSUB_ADMIN_SERVICE_TYPE, PUBSUB_NANOMSG_ADMIN_TYPE);
+        metricsSvcId = celix_bundleContext_registerService(ctx, static_cast<void*>(&metricsService), PUBSUB_ADMIN_METRICS_SERVICE_NAME, metricsProps);
+    }
+
 
     celix_service_tracking_options_t opts{};
     opts.filter.serviceName = PUBSUB_SERIALIZER_SERVICE_NAME;
@@ -204,6 +219,7 @@ void pubsub_nanomsg_admin::start() {
 
 void pubsub_nanomsg_admin::stop() {
     celix_bundleContext_unregisterService(ctx, adminSvcId);
+    celix_bundleContext_unregisterService(ctx, metricsSvcId);
     celix_bundleContext_unregisterService(ctx, cmdSvcId);
     celix_bundleContext_stopTracker(ctx, serializersTrackerId);
 }
@@ -310,7 +326,7 @@ celix_status_t pubsub_nanomsg_admin::matchEndpoint(const celix_properties_t *end
 }
 
 celix_status_t pubsub_nanomsg_admin::setupTopicSender(const char *scope, const char *topic,
-                                                    const celix_properties_t */*topicProperties*/,
+                                                    const celix_properties_t *topicProperties,
                                                     long serializerSvcId, celix_properties_t **outPublisherEndpoint) {
     celix_status_t status = CELIX_SUCCESS;
 
@@ -328,13 +344,21 @@ celix_status_t pubsub_nanomsg_admin::setupTopicSender(const char *scope, const c
         auto kv = serializers.map.find(serializerSvcId);
         if (kv != serializers.map.end()) {
             auto &serEntry = kv->second;
+            const char *visibility = celix_properties_get(topicProperties, PUBSUB_ENDPOINT_VISIBILITY, PUBSUB_ENDPOINT_VISIBILITY_DEFAULT);
             auto e = topicSenders.map.emplace(std::piecewise_construct,
                     std::forward_as_tuple(key),
                     std::forward_as_tuple(ctx, scope, topic, serializerSvcId, serEntry.svc, ipAddress,
-                                          basePort, maxPort));
+                                          basePort, maxPort, visibility, ipcDir.c_str(), metricsEnabled));
             celix_properties_t *newEndpoint = pubsubEndpoint_create(fwUUID, scope, topic, PUBSUB_PUBLISHER_ENDPOINT_TYPE,
                     PUBSUB_NANOMSG_ADMIN_TYPE, serEntry.serType, nullptr);
             celix_properties_set(newEndpoint, PUBSUB_NANOMSG_URL_KEY, e.first->second.getUrl().c_str());
+            //inproc:// and ipc:// urls are not reachable outside of the framework or host
+            const std::string &url = e.first->second.getUrl();
+            if (url.compare(0, strlen("inproc://"), "inproc://") == 0) {
+                celix_properties_set(newEndpoint, PUBSUB_ENDPOINT_VISIBILITY, PUBSUB_ENDPOINT_LOCAL_VISIBILITY);
+            } else if (url.compare(0, strlen("ipc://"), "ipc://") == 0) {
+                celix_properties_set(newEndpoint, PUBSUB_ENDPOINT_VISIBILITY, PUBSUB_ENDPOINT_HOST_VISIBILITY);
+            }
             //if available also set container name
             const char *cn = celix_bundleContext_getProperty(ctx, "CELIX_CONTAINER_NAME", nullptr);
             if (cn != nullptr) {
@@ -389,7 +413,7 @@ celix_status_t pubsub_nanomsg_admin::setupTopicReceiver(const std::string &scope
             auto kvs = serializers.map.find(serializerSvcId);
             if (kvs != serializers.map.end()) {
                 auto serEntry = kvs->second;
-                receiver = new pubsub::nanomsg::topic_receiver(ctx, scope, topic, serializerSvcId, serEntry.svc);
+                receiver = new pubsub::nanomsg::topic_receiver(ctx, scope, topic, serializerSvcId, serEntry.svc, metricsEnabled);
             } else {
                 L.ERROR("[PSA_NANOMSG] Cannot find serializer for TopicSender ", scope, "/", topic);
             }
@@ -462,6 +486,10 @@ celix_status_t pubsub_nanomsg_admin::connectEndpointToReceiver(pubsub::nanomsg::
     if (url == nullptr) {
 //        L_WARN("[PSA NANOMSG] Error got endpoint without a nanomsg url (admin: %s, type: %s)", admin , type);
         status = CELIX_BUNDLE_EXCEPTION;
+    } else if (strncmp(url, "inproc://", strlen("inproc://")) == 0 &&
+               strcmp(celix_properties_get(endpoint, PUBSUB_ENDPOINT_FRAMEWORK_UUID, ""), fwUUID) != 0) {
+        //an inproc:// url of another framework can not be reached
+        status = CELIX_BUNDLE_EXCEPTION;
     } else {
         if ((eScope == scope) && (eTopic == topic)) {
             receiver->connectTo(url);
@@ -535,6 +563,22 @@ celix_status_t pubsub_nanomsg_admin::removeEndpoint(const celix_properties_t *en
     return CELIX_SUCCESS;;
 }
 
+void pubsub_nanomsg_admin::visitMetrics(const struct timespec *changedSince, void *callbackHandle,
+                                        pubsub_metrics_visit_fp callback) {
+    {
+        std::lock_guard<std::mutex> topicSenderLock(topicSenders.mutex);
+        for (auto &kv : topicSenders.map) {
+            kv.second.visitMetrics(changedSince, callbackHandle, callback);
+        }
+    }
+    {
+        std::lock_guard<std::mutex> topicReceiverLock(topicReceivers.mutex);
+        for (auto &kv : topicReceivers.map) {
+            kv.second->visitMetrics(changedSince, callbackHandle, callback);
+        }
+    }
+}
+
 celix_status_t pubsub_nanomsg_admin::executeCommand(char *commandLine __attribute__((unused)), FILE *out,
                                                   FILE *errStream __attribute__((unused))) {
     celix_status_t  status = CELIX_SUCCESS;
@@ -26,12 +26,13 @@
 #include "celix_api.h"
 #include "pubsub_nanomsg_topic_receiver.h"
 #include <pubsub_serializer.h>
+#include <pubsub_admin_metrics.h>
 #include "LogHelper.h"
+#include "pubsub_psa_nanomsg_constants.h"
 #include "command.h"
 #include "pubsub_nanomsg_topic_sender.h"
 #include "pubsub_nanomsg_topic_receiver.h"
 
-#define PUBSUB_NANOMSG_ADMIN_TYPE       "nanomsg"
 #define PUBSUB_NANOMSG_URL_KEY          "nanomsg.url"
 
 #define PUBSUB_NANOMSG_VERBOSE_KEY      "PSA_NANOMSG_VERBOSE"
@@ -95,6 +96,8 @@ private:
     celix_status_t addEndpoint(const celix_properties_t *endpoint);
     celix_status_t removeEndpoint(const celix_properties_t *endpoint);
 
+    void visitMetrics(const struct timespec *changedSince, void *callbackHandle, pubsub_metrics_visit_fp callback);
+
     celix_status_t executeCommand(char *commandLine __attribute__((unused)), FILE *out,
                                                         FILE *errStream __attribute__((unused)));
 
@@ -107,6 +110,8 @@ private:
     celix::pubsub::nanomsg::LogHelper L;
     pubsub_admin_service_t adminService{};
     long adminSvcId = -1L;
+    pubsub_admin_metrics_service_t metricsService{};
+    long metricsSvcId = -1L;
     long cmdSvcId = -1L;
     command_service_t cmdSvc{};
     long serializersTrackerId = -1L;
@@ -117,12 +122,14 @@ private:
 
     unsigned int basePort{};
     unsigned int maxPort{};
+    std::string ipcDir{};
 
     double qosSampleScore{};
     double qosControlScore{};
     double defaultScore{};
 
     bool verbose{};
+    bool metricsEnabled{};
 
     class psa_nanomsg_serializer_entry {
     public:
@@ -18,6 +18,7 @@
  */
 
 #include <memory.h>
+#include <pubsub_constants.h>
 #include "pubsub_nanomsg_common.h"
 
 int celix::pubsub::nanomsg::localMsgTypeIdForMsgType(void *handle __attribute__((unused)), const char *msgType,
@@ -52,4 +53,17 @@ std::string celix::pubsub::nanomsg::setScopeAndTopicFilter(const std::string &sc
         result += topic[1];
     }
     return result;
-}
\ No newline at end of file
+}
+
+std::string celix::pubsub::nanomsg::transportUrl(const std::string &visibility, const std::string &ipcDir,
+                                                 const std::string &fwUUID, const std::string &scope,
+                                                 const std::string &topic) {
+    std::stringstream url{};
+    if (visibility == PUBSUB_ENDPOINT_LOCAL_VISIBILITY) {
+        //inproc names are per process, the framework uuid separates the frameworks in a single process
+        url << "inproc://celix-" << fwUUID << "-" << scope << "-" << topic;
+    } else if (visibility == PUBSUB_ENDPOINT_HOST_VISIBILITY) {
+        url << "ipc://" << ipcDir << "/celix-nanomsg-" << fwUUID << "-" << scope << "-" << topic << ".ipc";
+    }
+    return url.str();
+}
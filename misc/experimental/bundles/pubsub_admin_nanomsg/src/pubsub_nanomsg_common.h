@@ -22,19 +22,15 @@
 
 #include <string>
 #include <sstream>
+#include <cstdint>
 #include <utils.h>
 
 #include "version.h"
 #include "log_helper.h"
 
 /*
- * NOTE zmq is used by first sending three frames:
- * 1) A subscription filter.
- * This is a 5 char string of the first two chars of scope and topic combined and terminated with a '\0'.
- *
- * 2) The pubsub_zmq_msg_header_t is send containing the type id and major/minor version
- *
- * 3) The actual payload
+ * NOTE a nanomsg msg is a single nn_allocmsg chunk, containing the msg_header followed by the serialized payload.
+ * The chunk is handed over to nanomsg without copying, for the inproc transport it is also received without copying.
  */
 
 namespace celix { namespace pubsub { namespace nanomsg {
@@ -43,10 +39,21 @@ namespace celix { namespace pubsub { namespace nanomsg {
         unsigned int type;
         unsigned char major;
         unsigned char minor;
+        uint32_t seqNr;
+        unsigned char originUUID[16];
+        uint64_t sendTimeSeconds; //seconds since epoch
+        uint64_t sendTimeNanoseconds; //ns since epoch
     };
     int localMsgTypeIdForMsgType(void *handle, const char *msgType, unsigned int *msgTypeId);
     std::string setScopeAndTopicFilter(const std::string &scope, const std::string &topic);
 
+    /**
+     * Returns the nanomsg transport url of a topic sender for the endpoint visibility of the topic:
+     * inproc:// for local, ipc:// (in ipcDir) for host and an empty string for system visibility (i.e. use tcp://).
+     */
+    std::string transportUrl(const std::string &visibility, const std::string &ipcDir, const std::string &fwUUID,
+                             const std::string &scope, const std::string &topic);
+
     bool checkVersion(version_pt msgVersion, const celix::pubsub::nanomsg::msg_header *hdr);
 
 }}}
@@ -32,6 +32,7 @@
 
 #include <nanomsg/nn.h>
 #include <nanomsg/bus.h>
+#include <uuid/uuid.h>
 
 #include <pubsub_serializer.h>
 #include <pubsub/subscriber.h>
@@ -42,7 +43,6 @@
 #include "pubsub_nanomsg_topic_receiver.h"
 #include "pubsub_psa_nanomsg_constants.h"
 #include "pubsub_nanomsg_common.h"
-#include "pubsub_topology_manager.h"
 
 //TODO see if block and wakeup (reset) also works
 #define PSA_NANOMSG_RECV_TIMEOUT 100 //100 msec timeout
@@ -67,7 +67,8 @@ pubsub::nanomsg::topic_receiver::topic_receiver(celix_bundle_context_t *_ctx,
         const std::string &_scope,
         const std::string &_topic,
         long _serializerSvcId,
-        pubsub_serializer_service_t *_serializer) : L{_ctx, "NANOMSG_topic_receiver"}, m_serializerSvcId{_serializerSvcId}, m_scope{_scope}, m_topic{_topic} {
+        pubsub_serializer_service_t *_serializer,
+        bool _metricsEnabled) : L{_ctx, "NANOMSG_topic_receiver"}, m_serializerSvcId{_serializerSvcId}, m_scope{_scope}, m_topic{_topic}, m_metricsEnabled{_metricsEnabled} {
     ctx = _ctx;
     serializer = _serializer;
 
@@ -124,7 +125,7 @@ pubsub::nanomsg::topic_receiver::~topic_receiver() {
 
         {
             std::lock_guard<std::mutex> _lock(subscribers.mutex);
-            for (auto elem : subscribers.map) {
+            for (auto &elem : subscribers.map) {
                 serializer->destroySerializerMap(serializer->handle, elem.second.msgTypes);
             }
             subscribers.map.clear();
@@ -248,7 +249,8 @@ void pubsub::nanomsg::topic_receiver::removeSubscriber(void */*svc*/,
     }
 }
 
-void pubsub::nanomsg::topic_receiver::processMsgForSubscriberEntry(psa_nanomsg_subscriber_entry* entry, const celix::pubsub::nanomsg::msg_header *hdr, const char* payload, size_t payloadSize) {
+void pubsub::nanomsg::topic_receiver::processMsgForSubscriberEntry(psa_nanomsg_subscriber_entry* entry, const celix::pubsub::nanomsg::msg_header *hdr, const char* payload, size_t payloadSize, const struct timespec *receiveTime) {
+    //note subscribers.mutex locked
     pubsub_msg_serializer_t* msgSer = static_cast<pubsub_msg_serializer_t*>(hashMap_get(entry->msgTypes, (void*)(uintptr_t)(hdr->type)));
     pubsub_subscriber_t *svc = entry->svc;
 
@@ -256,7 +258,16 @@ void pubsub::nanomsg::topic_receiver::processMsgForSubscriberEntry(psa_nanomsg_s
         void *deserializedMsg = NULL;
         bool validVersion = celix::pubsub::nanomsg::checkVersion(msgSer->msgVersion, hdr);
         if (validVersion) {
-            celix_status_t status = msgSer->deserialize(msgSer, payload, payloadSize, &deserializedMsg);
+            struct timespec deserializationStart{};
+            struct timespec deserializationEnd{};
+            if (m_metricsEnabled) {
+                clock_gettime(CLOCK_REALTIME, &deserializationStart);
+            }
+            celix_status_t status = msgSer->deserialize(msgSer->handle, payload, payloadSize, &deserializedMsg);
+            if (m_metricsEnabled) {
+                clock_gettime(CLOCK_REALTIME, &deserializationEnd);
+                updateMetrics(entry, hdr, receiveTime, &deserializationStart, &deserializationEnd, status == CELIX_SUCCESS);
+            }
             if (status == CELIX_SUCCESS) {
                 bool release = false;
                 svc->receive(svc->handle, msgSer->msgName, msgSer->msgId, deserializedMsg, &release);
@@ -272,10 +283,73 @@ void pubsub::nanomsg::topic_receiver::processMsgForSubscriberEntry(psa_nanomsg_s
     }
 }
 
-void pubsub::nanomsg::topic_receiver::processMsg(const celix::pubsub::nanomsg::msg_header *hdr, const char *payload, size_t payloadSize) {
+void pubsub::nanomsg::topic_receiver::processMsg(const celix::pubsub::nanomsg::msg_header *hdr, const char *payload, size_t payloadSize, const struct timespec *receiveTime) {
     std::lock_guard<std::mutex> _lock(subscribers.mutex);
-    for (auto entry : subscribers.map) {
-        processMsgForSubscriberEntry(&entry.second, hdr, payload, payloadSize);
+    for (auto &entry : subscribers.map) {
+        processMsgForSubscriberEntry(&entry.second, hdr, payload, payloadSize, receiveTime);
+    }
+}
+
+void pubsub::nanomsg::topic_receiver::updateMetrics(psa_nanomsg_subscriber_entry *entry,
+                                                    const celix::pubsub::nanomsg::msg_header *hdr,
+                                                    const struct timespec *receiveTime,
+                                                    const struct timespec *deserializationStart,
+                                                    const struct timespec *deserializationEnd,
+                                                    bool deserialized) {
+    //note subscribers.mutex locked
+    char uuidStr[UUID_STR_LEN+1];
+    uuid_unparse(hdr->originUUID, uuidStr);
+    auto key = std::make_pair(hdr->type, std::string{uuidStr});
+    auto it = entry->metrics.find(key);
+    if (it == entry->metrics.end()) {
+        it = entry->metrics.emplace(key, psa_nanomsg_receive_msg_metrics{}).first;
+        memcpy(it->second.origin, hdr->originUUID, sizeof(it->second.origin));
+    }
+    auto &metrics = it->second;
+    if (deserialized) {
+        double diff = celix_difftime(deserializationStart, deserializationEnd);
+        pubsub_metricsHistogram_record(&metrics.serializationTime, diff > 0 ? (uint64_t) (diff * 1e9) : 0);
+        metrics.nrOfMessagesReceived += 1;
+    } else {
+        metrics.nrOfSerializationErrors += 1;
+    }
+    if (metrics.lastSeqNr > 0 && hdr->seqNr - metrics.lastSeqNr > 1) {
+        metrics.nrOfMissingSeqNumbers += hdr->seqNr - metrics.lastSeqNr - 1;
+    }
+    metrics.lastSeqNr = hdr->seqNr;
+    metrics.lastMessageReceived = *receiveTime;
+    struct timespec sendTime{};
+    sendTime.tv_sec = (time_t) hdr->sendTimeSeconds;
+    sendTime.tv_nsec = (long) hdr->sendTimeNanoseconds;
+    double delay = celix_difftime(&sendTime, receiveTime);
+    pubsub_metricsHistogram_record(&metrics.delay, delay > 0 ? (uint64_t) (delay * 1e9) : 0); //clock skew can make the delay negative
+}
+
+void pubsub::nanomsg::topic_receiver::visitMetrics(const struct timespec *changedSince, void *callbackHandle,
+                                                   pubsub_metrics_visit_fp callback) {
+    pubsub_metrics_entry_t metrics{};
+    metrics.type = PUBSUB_METRICS_RECEIVE_MSG;
+    metrics.psaType = PUBSUB_NANOMSG_ADMIN_TYPE;
+    metrics.scope = m_scope.c_str();
+    metrics.topic = m_topic.c_str();
+    std::lock_guard<std::mutex> _lock(subscribers.mutex);
+    for (auto &entry : subscribers.map) {
+        metrics.bndId = entry.first;
+        for (auto &kv : entry.second.metrics) {
+            auto *msgSer = static_cast<pubsub_msg_serializer_t*>(hashMap_get(entry.second.msgTypes, (void*)(uintptr_t)kv.first.first));
+            metrics.msgFqn = msgSer != nullptr ? msgSer->msgName : nullptr;
+            metrics.msgTypeId = kv.first.first;
+            uuid_copy(metrics.originUUID, kv.second.origin);
+            metrics.nrOfMessages = kv.second.nrOfMessagesReceived;
+            metrics.nrOfSerializationErrors = kv.second.nrOfSerializationErrors;
+            metrics.nrOfMissingSeqNumbers = kv.second.nrOfMissingSeqNumbers;
+            metrics.lastMessage = kv.second.lastMessageReceived;
+            metrics.serializationTime = &kv.second.serializationTime;
+            metrics.delay = &kv.second.delay;
+            if (pubsub_metrics_changedSince(&metrics, changedSince)) {
+                callback(callbackHandle, &metrics);
+            }
+        }
     }
 }
 
@@ -301,11 +375,17 @@ void pubsub::nanomsg::topic_receiver::recvThread_exec() {
         msgHdr.msg_controllen = 0;
 
         errno = 0;
+        //NN_MSG: nanomsg hands over its own chunk, the msg is not copied into a receive buffer
         int recvBytes = nn_recvmsg(m_nanoMsgSocket, &msgHdr, 0);
         if (msg && static_cast<unsigned long>(recvBytes) >= sizeof(celix::pubsub::nanomsg::msg_header)) {
-            processMsg(&msg->header, msg->payload, recvBytes-sizeof(msg->header));
+            struct timespec receiveTime{};
+            if (m_metricsEnabled) {
+                clock_gettime(CLOCK_REALTIME, &receiveTime);
+            }
+            processMsg(&msg->header, msg->payload, recvBytes-sizeof(msg->header), &receiveTime);
             nn_freemsg(msg);
         } else if (recvBytes >= 0) {
+            if (msg != nullptr) nn_freemsg(msg);
             L.ERROR("[PSA_NANOMSG_TR] Error receiving nanomsg msg, size (", recvBytes,") smaller than header\n");
         } else if (errno == EAGAIN || errno == ETIMEDOUT) {
             // no data: go to next cycle
@@ -24,12 +24,26 @@
 #include <thread>
 #include <mutex>
 #include <map>
+#include <utility>
+#include <ctime>
 #include "pubsub_serializer.h"
+#include "pubsub_admin_metrics.h"
 #include "LogHelper.h"
 #include "celix_bundle_context.h"
 #include "pubsub_nanomsg_common.h"
 #include "pubsub/subscriber.h"
 
+struct psa_nanomsg_receive_msg_metrics {
+    unsigned char origin[16]{};
+    unsigned long nrOfMessagesReceived{0};
+    unsigned long nrOfSerializationErrors{0};
+    unsigned long nrOfMissingSeqNumbers{0};
+    uint32_t lastSeqNr{0};
+    struct timespec lastMessageReceived{};
+    pubsub_metrics_histogram_t serializationTime{};
+    pubsub_metrics_histogram_t delay{};
+};
+
 struct psa_nanomsg_subscriber_entry {
     psa_nanomsg_subscriber_entry(pubsub_subscriber_t *_svc, int _usageCount) :
         svc{_svc}, usageCount{_usageCount} {
@@ -37,6 +51,7 @@ struct psa_nanomsg_subscriber_entry {
     pubsub_subscriber_t *svc{};
     int usageCount;
     hash_map_t *msgTypes{nullptr}; //map from serializer svc
+    std::map<std::pair<unsigned int, std::string>, psa_nanomsg_receive_msg_metrics> metrics{}; //key = msg type id and origin uuid
 };
 
 typedef struct psa_nanomsg_requested_connection_entry {
@@ -77,7 +92,7 @@ namespace pubsub {
                            const std::string &scope,
                            const std::string &topic,
                            long serializerSvcId, pubsub_serializer_service_t
-                           *serializer);
+                           *serializer, bool metricsEnabled);
             topic_receiver(const topic_receiver &) = delete;
             topic_receiver & operator=(const topic_receiver &) = delete;
             ~topic_receiver();
@@ -89,11 +104,15 @@ namespace pubsub {
             void connectTo(const char *url);
             void disconnectFrom(const char *url);
             void recvThread_exec();
-            void processMsg(const celix::pubsub::nanomsg::msg_header *hdr, const char *payload, size_t payloadSize);
-            void processMsgForSubscriberEntry(psa_nanomsg_subscriber_entry* entry, const celix::pubsub::nanomsg::msg_header *hdr, const char* payload, size_t payloadSize);
+            void processMsg(const celix::pubsub::nanomsg::msg_header *hdr, const char *payload, size_t payloadSize, const struct timespec *receiveTime);
+            void processMsgForSubscriberEntry(psa_nanomsg_subscriber_entry* entry, const celix::pubsub::nanomsg::msg_header *hdr, const char* payload, size_t payloadSize, const struct timespec *receiveTime);
+            void visitMetrics(const struct timespec *changedSince, void *callbackHandle, pubsub_metrics_visit_fp callback);
             void addSubscriber(void *svc, const celix_properties_t *props, const celix_bundle_t *bnd);
             void removeSubscriber(void */*svc*/, const celix_properties_t */*props*/, const celix_bundle_t *bnd);
             celix_service_tracking_options_t createOptions();
+            void updateMetrics(psa_nanomsg_subscriber_entry *entry, const celix::pubsub::nanomsg::msg_header *hdr,
+                               const struct timespec *receiveTime, const struct timespec *deserializationStart,
+                               const struct timespec *deserializationEnd, bool deserialized);
 
         private:
             celix_bundle_context_t *ctx{nullptr};
@@ -102,6 +121,7 @@ namespace pubsub {
             pubsub_serializer_service_t *serializer{nullptr};
             const std::string m_scope{};
             const std::string m_topic{};
+            bool m_metricsEnabled{true};
 
             int m_nanoMsgSocket{0};
 
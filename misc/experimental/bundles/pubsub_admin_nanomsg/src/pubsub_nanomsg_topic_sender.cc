@@ -27,9 +27,11 @@
 #include <LogHelper.h>
 #include <nanomsg/nn.h>
 #include <nanomsg/bus.h>
+#include <uuid/uuid.h>
 
 
 #include <pubsub_constants.h>
+#include <celix_constants.h>
 #include "pubsub_nanomsg_topic_sender.h"
 #include "pubsub_psa_nanomsg_constants.h"
 #include "pubsub_nanomsg_common.h"
@@ -47,15 +49,23 @@ pubsub::nanomsg::pubsub_nanomsg_topic_sender::pubsub_nanomsg_topic_sender(celix_
                                                          pubsub_serializer_service_t *_ser,
                                                          const char *_bindIp,
                                                          unsigned int _basePort,
-                                                         unsigned int _maxPort) :
+                                                         unsigned int _maxPort,
+                                                         const char *_visibility,
+                                                         const char *_ipcDir,
+                                                         bool _metricsEnabled) :
         ctx{_ctx},
         L{ctx, "PSA_NANOMSG_TS"},
         serializerSvcId {_serializerSvcId},
         serializer{_ser},
         scope{_scope},
-        topic{_topic}{
+        topic{_topic},
+        metricsEnabled{_metricsEnabled} {
 
     scopeAndTopicFilter = celix::pubsub::nanomsg::setScopeAndTopicFilter(_scope, _topic);
+    const char *fwUUID = celix_bundleContext_getProperty(_ctx, OSGI_FRAMEWORK_FRAMEWORK_UUID, "");
+    if (uuid_parse(fwUUID, originUUID) != 0) {
+        L.WARN("[PSA_NANOMSG_TS] Cannot parse framework uuid ", fwUUID);
+    }
 
     //setting up nanomsg socket for nanomsg TopicSender
     int nnSock = nn_socket(AF_SP, NN_BUS);
@@ -64,6 +74,18 @@ pubsub::nanomsg::pubsub_nanomsg_topic_sender::pubsub_nanomsg_topic_sender(celix_
     }
 
     int rv = -1, retry=0;
+    //local and host topics use the inproc:// and ipc:// transports instead of tcp://
+    std::string transportUrl = celix::pubsub::nanomsg::transportUrl(_visibility, _ipcDir, fwUUID, scope, topic);
+    if (!transportUrl.empty()) {
+        rv = nn_bind(nnSock, transportUrl.c_str());
+        if (rv == -1) {
+            L.ERROR("[PSA_NANOMSG_TS] Cannot bind to ", transportUrl, ": ", strerror(errno));
+        } else {
+            this->url = transportUrl;
+            nanomsg.socket = nnSock;
+        }
+        retry = NANOMSG_BIND_MAX_RETRY;
+    }
     while (rv == -1 && retry < NANOMSG_BIND_MAX_RETRY ) {
         /* Randomized part due to same bundle publishing on different topics */
         unsigned int port = rand_range(_basePort,_maxPort);
@@ -102,7 +124,7 @@ pubsub::nanomsg::pubsub_nanomsg_topic_sender::pubsub_nanomsg_topic_sender(celix_
         celix_properties_set(props, PUBSUB_PUBLISHER_TOPIC, topic.c_str());
         celix_properties_set(props, PUBSUB_PUBLISHER_SCOPE, scope.c_str());
 
-        celix_service_registration_options_t opts = CELIX_EMPTY_SERVICE_REGISTRATION_OPTIONS;
+        celix_service_registration_options_t opts{};
         opts.factory = &publisher.factory;
         opts.serviceName = PUBSUB_PUBLISHER_SERVICE_NAME;
         opts.serviceVersion = PUBSUB_PUBLISHER_SERVICE_VERSION;
@@ -117,6 +139,9 @@ pubsub::nanomsg::pubsub_nanomsg_topic_sender::~pubsub_nanomsg_topic_sender() {
     celix_bundleContext_unregisterService(ctx, publisher.svcId);
 
     nn_close(nanomsg.socket);
+    if (url.compare(0, strlen("ipc://"), "ipc://") == 0) {
+        unlink(url.c_str() + strlen("ipc://"));
+    }
     std::lock_guard<std::mutex> lock(boundedServices.mutex);
     for  (auto &it: boundedServices.map) {
             serializer->destroySerializerMap(serializer->handle, it.second.msgTypes);
@@ -154,7 +179,7 @@ void* pubsub::nanomsg::pubsub_nanomsg_topic_sender::getPublisherService(const ce
     } else {
         auto entry = boundedServices.map.emplace(std::piecewise_construct,
                                     std::forward_as_tuple(bndId),
-                                    std::forward_as_tuple(scope, topic, bndId, nanomsg.socket, ctx));
+                                    std::forward_as_tuple(scope, topic, bndId, nanomsg.socket, ctx, metricsEnabled, originUUID));
         int rc = serializer->createSerializerMap(serializer->handle, (celix_bundle_t*)requestingBundle, &entry.first->second.msgTypes);
 
         if (rc == 0) {
@@ -210,36 +235,55 @@ int pubsub::nanomsg::bounded_service_entry::topicPublicationSend(unsigned int ms
             msg_hdr.minor = (unsigned char) minor;
         }
 
+        struct timespec serializationStart{};
+        struct timespec serializationEnd{};
+        struct timespec sendTime{};
+        if (metricsEnabled) {
+            clock_gettime(CLOCK_REALTIME, &serializationStart);
+        }
         void *serializedOutput = nullptr;
         size_t serializedOutputLen = 0;
-        status = msgSer->serialize(msgSer, inMsg, &serializedOutput, &serializedOutputLen);
+        status = msgSer->serialize(msgSer->handle, inMsg, &serializedOutput, &serializedOutputLen);
+        if (metricsEnabled) {
+            clock_gettime(CLOCK_REALTIME, &serializationEnd);
+        }
+        bool send = false;
         if (status == CELIX_SUCCESS) {
-            nn_iovec data[2];
-
-            nn_msghdr msg{};
-            msg.msg_iov = data;
-            msg.msg_iovlen = 2;
-            msg.msg_iov[0].iov_base = static_cast<void*>(&msg_hdr);
-            msg.msg_iov[0].iov_len = sizeof(msg_hdr);
-            msg.msg_iov[1].iov_base = serializedOutput;
-            msg.msg_iov[1].iov_len = serializedOutputLen;
-            msg.msg_control = nullptr;
-            msg.msg_controllen = 0;
-            errno = 0;
-            int rc = nn_sendmsg(nanoMsgSocket, &msg, 0 );
-            free(serializedOutput);
-            if (rc < 0) {
-                L.WARN("[PSA_NANOMSG_TS] Error sending zmsg, rc: ", rc, ", error: ",  strerror(errno));
+            clock_gettime(CLOCK_REALTIME, &sendTime);
+            msg_hdr.seqNr = seqNr++;
+            memcpy(msg_hdr.originUUID, originUUID, sizeof(msg_hdr.originUUID));
+            msg_hdr.sendTimeSeconds = (uint64_t) sendTime.tv_sec;
+            msg_hdr.sendTimeNanoseconds = (uint64_t) sendTime.tv_nsec;
+
+            //the chunk is owned by nanomsg after a successful send, no further copies are made
+            auto *chunk = static_cast<char*>(nn_allocmsg(sizeof(msg_hdr) + serializedOutputLen, 0));
+            if (chunk != nullptr) {
+                memcpy(chunk, &msg_hdr, sizeof(msg_hdr));
+                memcpy(chunk + sizeof(msg_hdr), serializedOutput, serializedOutputLen);
+                errno = 0;
+                int rc = nn_send(nanoMsgSocket, &chunk, NN_MSG, 0);
+                if (rc < 0) {
+                    nn_freemsg(chunk);
+                    L.WARN("[PSA_NANOMSG_TS] Error sending msg, rc: ", rc, ", error: ",  strerror(errno));
+                } else {
+                    send = true;
+                    L.DBG("[PSA_NANOMSG_TS] Send message ID ", msg_hdr.type,
+                            " major: ", (int)msg_hdr.major,
+                            " minor: ",  (int)msg_hdr.minor,
+                            " size: ", rc);
+                }
             } else {
-                L.INFO("[PSA_NANOMSG_TS] Send message with size ",  rc, "\n");
-                L.INFO("[PSA_NANOMSG_TS] Send message ID ", msg_hdr.type,
-                        " major: ", (int)msg_hdr.major,
-                        " minor: ",  (int)msg_hdr.minor,"\n");
+                L.WARN("[PSA_NANOMSG_TS] Cannot allocate nanomsg msg of ", sizeof(msg_hdr) + serializedOutputLen, " bytes");
             }
+            free(serializedOutput);
         } else {
             L.WARN("[PSA_NANOMSG_TS] Error serialize message of type ", msgSer->msgName,
                     " for scope/topic ", scope.c_str(), "/", topic.c_str(),"\n");
         }
+        if (metricsEnabled) {
+            updateMetrics(msgTypeId, msgSer->msgName, serializationStart, serializationEnd, sendTime,
+                          status == CELIX_SUCCESS, send);
+        }
     } else {
         status = CELIX_SERVICE_EXCEPTION;
         L.WARN("[PSA_NANOMSG_TS] Error cannot serialize message with msg type id ", msgTypeId,
@@ -248,6 +292,60 @@ int pubsub::nanomsg::bounded_service_entry::topicPublicationSend(unsigned int ms
     return status;
 }
 
+void pubsub::nanomsg::bounded_service_entry::updateMetrics(unsigned int msgTypeId, const char *msgFqn,
+                                                           const struct timespec &serializationStart,
+                                                           const struct timespec &serializationEnd,
+                                                           const struct timespec &sendTime,
+                                                           bool serialized, bool send) {
+    std::lock_guard<std::mutex> lock(metricsMutex);
+    auto &entry = metrics[msgTypeId];
+    entry.msgFqn = msgFqn;
+    if (serialized) {
+        double diff = celix_difftime(&serializationStart, &serializationEnd);
+        pubsub_metricsHistogram_record(&entry.serializationTime, diff > 0 ? (uint64_t) (diff * 1e9) : 0);
+        entry.lastMessageSend = sendTime;
+    } else {
+        entry.nrOfSerializationErrors += 1;
+    }
+    if (send) {
+        entry.nrOfMessagesSend += 1;
+    } else if (serialized) {
+        entry.nrOfMessagesSendFailed += 1;
+    }
+}
+
+void pubsub::nanomsg::bounded_service_entry::visitMetrics(const struct timespec *changedSince, void *callbackHandle,
+                                                          pubsub_metrics_visit_fp callback) {
+    pubsub_metrics_entry_t entry{};
+    entry.type = PUBSUB_METRICS_SEND_MSG;
+    entry.psaType = PUBSUB_NANOMSG_ADMIN_TYPE;
+    entry.scope = scope.c_str();
+    entry.topic = topic.c_str();
+    entry.bndId = bndId;
+    std::lock_guard<std::mutex> lock(metricsMutex);
+    for (auto &kv : metrics) {
+        entry.msgFqn = kv.second.msgFqn;
+        entry.msgTypeId = kv.first;
+        entry.nrOfMessages = kv.second.nrOfMessagesSend;
+        entry.nrOfMessagesFailed = kv.second.nrOfMessagesSendFailed;
+        entry.nrOfSerializationErrors = kv.second.nrOfSerializationErrors;
+        entry.lastMessage = kv.second.lastMessageSend;
+        entry.serializationTime = &kv.second.serializationTime;
+        if (pubsub_metrics_changedSince(&entry, changedSince)) {
+            callback(callbackHandle, &entry);
+        }
+    }
+}
+
+void pubsub::nanomsg::pubsub_nanomsg_topic_sender::visitMetrics(const struct timespec *changedSince,
+                                                                void *callbackHandle,
+                                                                pubsub_metrics_visit_fp callback) {
+    std::lock_guard<std::mutex> lock(boundedServices.mutex);
+    for (auto &kv : boundedServices.map) {
+        kv.second.visitMetrics(changedSince, callbackHandle, callback);
+    }
+}
+
 static void delay_first_send_for_late_joiners(celix::pubsub::nanomsg::LogHelper& logHelper) {
 
     static bool firstSend = true;
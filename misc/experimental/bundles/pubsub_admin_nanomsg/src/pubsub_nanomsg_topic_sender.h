@@ -22,14 +22,29 @@
 
 #include <mutex>
 #include <map>
+#include <atomic>
+#include <string>
+#include <ctime>
+#include <cstring>
 #include "celix_bundle_context.h"
 #include <log_helper.h>
 #include <pubsub_serializer.h>
+#include <pubsub_admin_metrics.h>
 #include <pubsub/publisher.h>
+#include "LogHelper.h"
 
 namespace pubsub {
     namespace nanomsg {
 
+        struct send_msg_metrics {
+            const char *msgFqn{nullptr};
+            unsigned long nrOfMessagesSend{0};
+            unsigned long nrOfMessagesSendFailed{0};
+            unsigned long nrOfSerializationErrors{0};
+            struct timespec lastMessageSend{};
+            pubsub_metrics_histogram_t serializationTime{};
+        };
+
         class bounded_service_entry {
         public:
             bounded_service_entry(
@@ -37,12 +52,15 @@ namespace pubsub {
                     std::string &_topic,
                     long _bndId,
                     int _nanoMsgSocket,
-                    celix_bundle_context_t *_context) : scope{_scope}, topic{_topic}, bndId{_bndId}, nanoMsgSocket{_nanoMsgSocket}, L{_context, "nanomsg_bounded_service_entry"} {
-
+                    celix_bundle_context_t *_context,
+                    bool _metricsEnabled,
+                    const unsigned char *_originUUID) : scope{_scope}, topic{_topic}, bndId{_bndId}, nanoMsgSocket{_nanoMsgSocket}, L{_context, "nanomsg_bounded_service_entry"}, metricsEnabled{_metricsEnabled} {
+                memcpy(originUUID, _originUUID, sizeof(originUUID));
             }
             bounded_service_entry(const bounded_service_entry&) = delete;
             bounded_service_entry &operator=(const bounded_service_entry&) = delete;
             int topicPublicationSend(unsigned int msgTypeId, const void *inMsg);
+            void visitMetrics(const struct timespec *changedSince, void *callbackHandle, pubsub_metrics_visit_fp callback);
 
             pubsub_publisher_t service{};
             std::string scope;
@@ -52,6 +70,16 @@ namespace pubsub {
             int getCount{1};
             int nanoMsgSocket{};
             celix::pubsub::nanomsg::LogHelper L;
+        private:
+            void updateMetrics(unsigned int msgTypeId, const char *msgFqn, const struct timespec &serializationStart,
+                               const struct timespec &serializationEnd, const struct timespec &sendTime,
+                               bool serialized, bool send);
+
+            const bool metricsEnabled;
+            unsigned char originUUID[16]{};
+            std::atomic<uint32_t> seqNr{0};
+            std::mutex metricsMutex{}; //protects metrics, a publisher can send from multiple threads
+            std::map<unsigned int, send_msg_metrics> metrics{}; //key = msg type id
         } ;
 
 
@@ -60,7 +88,8 @@ namespace pubsub {
             pubsub_nanomsg_topic_sender(celix_bundle_context_t *_ctx,
                                         const char *_scope,
                                         const char *_topic, long _serializerSvcId, pubsub_serializer_service_t *_ser,
-                                        const char *_bindIp, unsigned int _basePort, unsigned int _maxPort);
+                                        const char *_bindIp, unsigned int _basePort, unsigned int _maxPort,
+                                        const char *_visibility, const char *_ipcDir, bool _metricsEnabled);
 
             ~pubsub_nanomsg_topic_sender();
 
@@ -79,6 +108,7 @@ namespace pubsub {
                                        const celix_properties_t *svcProperties __attribute__((unused)));
             int topicPublicationSend(unsigned int msgTypeId, const void *inMsg);
             void delay_first_send_for_late_joiners() ;
+            void visitMetrics(const struct timespec *changedSince, void *callbackHandle, pubsub_metrics_visit_fp callback);
 
             //private:
             celix_bundle_context_t *ctx;
@@ -90,6 +120,8 @@ namespace pubsub {
             std::string topic{};
             std::string scopeAndTopicFilter{};
             std::string url{};
+            bool metricsEnabled{};
+            unsigned char originUUID[16]{};
 
             struct {
                 std::mutex mutex;
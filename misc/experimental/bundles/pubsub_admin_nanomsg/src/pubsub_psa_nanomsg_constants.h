@@ -21,6 +21,8 @@
 #define PUBSUB_PSA_NANOMSG_CONSTANTS_H_
 
 
+#define PUBSUB_NANOMSG_ADMIN_TYPE                   "nanomsg"
+
 #define PSA_NANOMSG_BASE_PORT                       "PSA_NANOMSG_BASE_PORT"
 #define PSA_NANOMSG_MAX_PORT                        "PSA_NANOMSG_MAX_PORT"
 
@@ -35,5 +37,15 @@
 #define PSA_NANOMSG_QOS_CONTROL_SCORE_KEY           "PSA_NANOMSG_QOS_CONTROL_SCORE"
 #define PSA_NANOMSG_DEFAULT_SCORE_KEY               "PSA_NANOMSG_DEFAULT_SCORE"
 
+#define PSA_NANOMSG_METRICS_ENABLED                 "PSA_NANOMSG_METRICS_ENABLED"
+#define PSA_NANOMSG_DEFAULT_METRICS_ENABLED         true
+
+/**
+ * Directory of the ipc:// sockets, used for topics with a host endpoint visibility.
+ * Topics with a local visibility use inproc:// and topics with a system visibility tcp://.
+ */
+#define PSA_NANOMSG_IPC_DIR                         "PSA_NANOMSG_IPC_DIR"
+#define PSA_NANOMSG_DEFAULT_IPC_DIR                 "/tmp"
+
 
 #endif /* PUBSUB_PSA_NANOMSG_CONSTANTS_H_ */